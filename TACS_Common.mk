@@ -13,14 +13,14 @@ TACS_INCLUDE = -I${TACS_DIR}/src \
 	-I${TACS_DIR}/src/io
 
 # Set the command line flags to use for compilation
-TACS_OPT_CC_FLAGS = ${TACS_DEF} ${EXTRA_CC_FLAGS} ${METIS_INCLUDE} ${AMD_INCLUDE} ${TECIO_INCLUDE} ${TACS_INCLUDE}
-TACS_DEBUG_CC_FLAGS = ${TACS_DEF} ${EXTRA_DEBUG_CC_FLAGS} ${METIS_INCLUDE} ${AMD_INCLUDE} ${TECIO_INCLUDE} ${TACS_INCLUDE}
+TACS_OPT_CC_FLAGS = ${TACS_DEF} ${EXTRA_CC_FLAGS} ${METIS_INCLUDE} ${AMD_INCLUDE} ${PETSC_INCLUDE} ${TECIO_INCLUDE} ${TACS_INCLUDE}
+TACS_DEBUG_CC_FLAGS = ${TACS_DEF} ${EXTRA_DEBUG_CC_FLAGS} ${METIS_INCLUDE} ${AMD_INCLUDE} ${PETSC_INCLUDE} ${TECIO_INCLUDE} ${TACS_INCLUDE}
 
 # By default, use the optimized flags
 TACS_CC_FLAGS = ${TACS_OPT_CC_FLAGS}
 
 # Set the linking flags to use
-TACS_EXTERN_LIBS = ${AMD_LIBS} ${METIS_LIB} ${LAPACK_LIBS} ${TECIO_LIBS}
+TACS_EXTERN_LIBS = ${AMD_LIBS} ${METIS_LIB} ${PETSC_LIBS} ${LAPACK_LIBS} ${TECIO_LIBS} ${TACS_DEVICE_LIBS}
 TACS_LD_FLAGS = ${EXTRA_LD_FLAGS} ${TACS_LD_CMD} ${TACS_EXTERN_LIBS}
 
 # This is the one rule that is used to compile all the
@@ -30,3 +30,11 @@ TACS_LD_FLAGS = ${EXTRA_LD_FLAGS} ${TACS_LD_CMD} ${TACS_EXTERN_LIBS}
 	@echo
 	@echo "        --- Compiled $*.cpp successfully ---"
 	@echo
+
+# The device kernels are compiled with nvcc or hipcc when the GPU
+# backend is enabled in Makefile.in
+%.o: %.cu
+	${TACS_DEVICE_CXX} ${TACS_DEVICE_FLAGS} ${TACS_DEF} ${TACS_INCLUDE} -c $< -o $*.o
+	@echo
+	@echo "        --- Compiled $*.cu successfully ---"
+	@echo
@@ -0,0 +1,874 @@
+/*
+  Benchmark suite for the performance-critical kernels in TACS
+
+  The suite times the following kernels:
+
+  1. Residual and Jacobian assembly for shell, solid, beam and thermal
+  elements at orders 2-4 (orders 2-3 for the beam)
+  2. The BCSRMat matrix-vector product, ILU(0) factorization and
+  application and the complete factorization for block sizes 1-8
+  3. The TACSBVecDistribute exchange of the ghost values
+  4. GMRES with the Schur complement preconditioner, GMRES with the
+  algebraic multigrid preconditioner and the Lanczos linear buckling
+  analysis for a shell model
+
+  The size level n results in roughly n^2 elements for every element
+  type. For a strong scaling sweep the global problem is fixed, while
+  for a weak scaling sweep the problem is extended in one direction by
+  the number of processors so that the number of elements per
+  processor is fixed. The BCSRMat kernels are local, so each processor
+  factors and multiplies its own n^2 block-row matrix.
+
+  Each kernel is run once to warm up and then timed nreps times. The
+  fastest time on each processor is taken as the time for the kernel,
+  and the minimum, average and maximum of these times over all
+  processors are reported. The values are written as JSON lines, one
+  record per kernel, so that the results from different releases can
+  be compared with standard tools.
+
+  Usage:
+
+  mpirun -np 4 ./benchmark_suite sizes=16,32 reps=5 scaling=weak
+  threads=1 kernels=assembly,bcsr,distribute,solvers output=bench.json
+*/
+
+#include "KSM.h"
+#include "TACSAmg.h"
+#include "TACSAssembler.h"
+#include "TACSBenchmark.h"
+#include "TACSBuckling.h"
+#include "TACSCreator.h"
+#include "TACSElement2D.h"
+#include "TACSElement3D.h"
+#include "TACSHeatConduction.h"
+#include "TACSHexaBasis.h"
+#include "TACSIsoShellConstitutive.h"
+#include "TACSIsoTubeBeamConstitutive.h"
+#include "TACSLinearElasticity.h"
+#include "TACSQuadBasis.h"
+#include "TACSSchurMat.h"
+#include "TACSShellElementDefs.h"
+
+/*
+  The types of models in the suite
+*/
+enum BenchModelType {
+  BENCH_SHELL = 0,
+  BENCH_SOLID,
+  BENCH_BEAM,
+  BENCH_THERMAL,
+  BENCH_NUM_MODEL_TYPES
+};
+
+static const char *benchModelNames[] = {"shell", "solid", "beam", "thermal"};
+
+/*
+  The description of a single benchmark record
+*/
+struct BenchCase {
+  const char *kernel;
+  const char *model;
+  int order;
+  int bsize;
+  int size;
+  double nelems;
+  double ndof;
+};
+
+/*
+  The options that control the whole suite
+*/
+struct BenchOptions {
+  int weak;
+  int nreps;
+  int nthreads;
+  FILE *fp;
+};
+
+/*
+  Write the record for a kernel
+
+  This call is collective on comm. The time and the flops are the
+  values from this processor, and the minimum, average and maximum
+  over all processors are written by the root. The extra value is
+  kernel-specific, for instance the number of Krylov iterations.
+*/
+static void benchWriteRecord(MPI_Comm comm, BenchOptions *opts,
+                             BenchCase *bc, double time, double flops,
+                             double extra) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  double tmin, tmax, tsum, fsum;
+  MPI_Reduce(&time, &tmin, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
+  MPI_Reduce(&time, &tmax, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(&time, &tsum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+  MPI_Reduce(&flops, &fsum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+  if (rank == 0) {
+    double rate = (tmax > 0.0 ? fsum / tmax : 0.0);
+    fprintf(opts->fp,
+            "{\"type\": \"result\", \"kernel\": \"%s\", \"model\": \"%s\", "
+            "\"order\": %d, \"bsize\": %d, \"size\": %d, "
+            "\"scaling\": \"%s\", \"nranks\": %d, \"nthreads\": %d, "
+            "\"nelems\": %.0f, \"ndof\": %.0f, \"reps\": %d, "
+            "\"tmin\": %.6e, \"tavg\": %.6e, \"tmax\": %.6e, "
+            "\"flops\": %.6e, \"flop_rate\": %.6e, \"extra\": %.6e}\n",
+            bc->kernel, bc->model, bc->order, bc->bsize, bc->size,
+            (opts->weak ? "weak" : "strong"), size, opts->nthreads,
+            bc->nelems, bc->ndof, opts->nreps, tmin, tsum / size, tmax, fsum,
+            rate, extra);
+    fflush(opts->fp);
+  }
+}
+
+/*
+  Create the element for the given model type and order
+*/
+static TACSElement *benchCreateElement(BenchModelType type, int order) {
+  TacsScalar rho = 2700.0;
+  TacsScalar specific_heat = 921.096;
+  TacsScalar E = 70e9;
+  TacsScalar nu = 0.3;
+  TacsScalar ys = 270e6;
+  TacsScalar cte = 24.0e-6;
+  TacsScalar kappa = 230.0;
+  TACSMaterialProperties *props =
+      new TACSMaterialProperties(rho, specific_heat, E, nu, ys, cte, kappa);
+
+  TACSElement *elem = NULL;
+  if (type == BENCH_SHELL) {
+    TACSShellTransform *transform = new TACSShellNaturalTransform();
+    TACSShellConstitutive *con = new TACSIsoShellConstitutive(props, 0.01);
+    if (order == 2) {
+      elem = new TACSQuad4Shell(transform, con);
+    } else if (order == 3) {
+      elem = new TACSQuad9Shell(transform, con);
+    } else {
+      elem = new TACSQuad16Shell(transform, con);
+    }
+  } else if (type == BENCH_SOLID) {
+    TACSSolidConstitutive *con = new TACSSolidConstitutive(props);
+    TACSLinearElasticity3D *model =
+        new TACSLinearElasticity3D(con, TACS_LINEAR_STRAIN);
+    TACSElementBasis *basis = NULL;
+    if (order == 2) {
+      basis = new TACSLinearHexaBasis();
+    } else if (order == 3) {
+      basis = new TACSQuadraticHexaBasis();
+    } else {
+      basis = new TACSCubicHexaBasis();
+    }
+    elem = new TACSElement3D(model, basis);
+  } else if (type == BENCH_BEAM) {
+    TacsScalar axis[] = {0.0, 1.0, 0.0};
+    TACSBeamTransform *transform = new TACSBeamRefAxisTransform(axis);
+    TACSBeamConstitutive *con = new TACSIsoTubeBeamConstitutive(
+        props, 0.05, 0.005, -1, -1, 0.0, 1.0, 0.0, 1.0);
+    if (order == 2) {
+      elem = new TACSBeam2(transform, con);
+    } else {
+      elem = new TACSBeam3(transform, con);
+    }
+  } else {
+    TACSPlaneStressConstitutive *con = new TACSPlaneStressConstitutive(props);
+    TACSHeatConduction2D *model = new TACSHeatConduction2D(con);
+    TACSElementBasis *basis = NULL;
+    if (order == 2) {
+      basis = new TACSLinearQuadBasis();
+    } else if (order == 3) {
+      basis = new TACSQuadraticQuadBasis();
+    } else {
+      basis = new TACSCubicQuadBasis();
+    }
+    elem = new TACSElement2D(model, basis);
+  }
+
+  return elem;
+}
+
+/*
+  Compute the number of elements in each direction for the size level
+
+  Each model type has roughly size^2 elements over all processors for
+  a strong scaling study. For a weak scaling study, the last direction
+  is extended by the number of processors.
+*/
+static void benchGetMeshSize(BenchModelType type, int size, int weak,
+                             int nranks, int *dim, int nelems[]) {
+  nelems[0] = nelems[1] = nelems[2] = 1;
+  if (type == BENCH_SOLID) {
+    int m = (int)(pow(1.0 * size * size, 1.0 / 3.0) + 0.5);
+    if (m < 1) {
+      m = 1;
+    }
+    *dim = 3;
+    nelems[0] = nelems[1] = nelems[2] = m;
+  } else if (type == BENCH_BEAM) {
+    *dim = 1;
+    nelems[0] = size * size;
+  } else {
+    *dim = 2;
+    nelems[0] = nelems[1] = size;
+  }
+
+  if (weak) {
+    nelems[*dim - 1] *= nranks;
+  }
+}
+
+/*
+  Create a structured model of the given type and order
+
+  The mesh is created on the root processor and partitioned by
+  TACSCreator. All nodes on the x = 0 face are fixed. For the shell
+  model, the x = L edge is given a uniform axial displacement so that
+  the model can be used for the linear buckling analysis.
+*/
+static TACSAssembler *benchCreateModel(
+    MPI_Comm comm, BenchModelType type, int order, int size, int weak,
+    TACSAssembler::OrderingType order_type,
+    TACSAssembler::MatrixOrderingType mat_type) {
+  int rank, nranks;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nranks);
+
+  int vars_per_node = 6;
+  if (type == BENCH_SOLID) {
+    vars_per_node = 3;
+  } else if (type == BENCH_THERMAL) {
+    vars_per_node = 1;
+  }
+
+  TACSCreator *creator = new TACSCreator(comm, vars_per_node);
+  creator->incref();
+
+  if (rank == 0) {
+    int dim, ne[3];
+    benchGetMeshSize(type, size, weak, nranks, &dim, ne);
+
+    // The number of nodes in each direction
+    int nn[3] = {1, 1, 1};
+    for (int d = 0; d < dim; d++) {
+      nn[d] = (order - 1) * ne[d] + 1;
+    }
+    int num_nodes = nn[0] * nn[1] * nn[2];
+    int num_elements = ne[0] * ne[1] * ne[2];
+
+    int nodes_per_elem = order;
+    for (int d = 1; d < dim; d++) {
+      nodes_per_elem *= order;
+    }
+
+    int *ids = new int[num_elements];
+    int *ptr = new int[num_elements + 1];
+    int *conn = new int[nodes_per_elem * num_elements];
+    memset(ids, 0, num_elements * sizeof(int));
+
+    // Set the connectivity with the x-direction varying fastest
+    int *c = conn;
+    ptr[0] = 0;
+    for (int elem = 0; elem < num_elements; elem++) {
+      int i = elem % ne[0];
+      int j = (elem / ne[0]) % ne[1];
+      int k = elem / (ne[0] * ne[1]);
+
+      int nk = (dim == 3 ? order : 1);
+      int nj = (dim >= 2 ? order : 1);
+      for (int kk = 0; kk < nk; kk++) {
+        for (int jj = 0; jj < nj; jj++) {
+          for (int ii = 0; ii < order; ii++) {
+            c[0] = ((order - 1) * i + ii) + nn[0] * ((order - 1) * j + jj) +
+                   nn[0] * nn[1] * ((order - 1) * k + kk);
+            c++;
+          }
+        }
+      }
+      ptr[elem + 1] = c - conn;
+    }
+
+    creator->setGlobalConnectivity(num_nodes, num_elements, ptr, conn, ids);
+    delete[] ids;
+    delete[] ptr;
+    delete[] conn;
+
+    // Set the boundary conditions on the x = 0 face, and for the
+    // shell, the axial displacement on the x = L edge
+    int num_fixed = num_nodes / nn[0];
+    int num_bcs = num_fixed;
+    if (type == BENCH_SHELL) {
+      num_bcs += num_fixed;
+    }
+    int *bc_nodes = new int[num_bcs];
+    int *bc_ptr = new int[num_bcs + 1];
+    int *bc_vars = new int[vars_per_node * num_bcs];
+    TacsScalar *bc_vals = new TacsScalar[vars_per_node * num_bcs];
+
+    bc_ptr[0] = 0;
+    for (int n = 0; n < num_fixed; n++) {
+      bc_nodes[n] = n * nn[0];
+      for (int m = 0; m < vars_per_node; m++) {
+        bc_vars[bc_ptr[n] + m] = m;
+        bc_vals[bc_ptr[n] + m] = 0.0;
+      }
+      bc_ptr[n + 1] = bc_ptr[n] + vars_per_node;
+    }
+    if (type == BENCH_SHELL) {
+      for (int n = num_fixed; n < num_bcs; n++) {
+        bc_nodes[n] = (n - num_fixed) * nn[0] + nn[0] - 1;
+        bc_vars[bc_ptr[n]] = 0;
+        bc_vals[bc_ptr[n]] = -1e-3;
+        bc_vars[bc_ptr[n] + 1] = 2;
+        bc_vals[bc_ptr[n] + 1] = 0.0;
+        bc_ptr[n + 1] = bc_ptr[n] + 2;
+      }
+    }
+
+    creator->setBoundaryConditions(num_bcs, bc_nodes, bc_ptr, bc_vars,
+                                   bc_vals);
+    delete[] bc_nodes;
+    delete[] bc_ptr;
+    delete[] bc_vars;
+    delete[] bc_vals;
+
+    // Set the node locations with a unit element length
+    TacsScalar *Xpts = new TacsScalar[3 * num_nodes];
+    for (int node = 0; node < num_nodes; node++) {
+      int i = node % nn[0];
+      int j = (node / nn[0]) % nn[1];
+      int k = node / (nn[0] * nn[1]);
+      Xpts[3 * node] = (1.0 * i) / (order - 1);
+      Xpts[3 * node + 1] = (1.0 * j) / (order - 1);
+      Xpts[3 * node + 2] = (1.0 * k) / (order - 1);
+    }
+    creator->setNodes(Xpts);
+    delete[] Xpts;
+  }
+
+  TACSElement *elem = benchCreateElement(type, order);
+  creator->setElements(1, &elem);
+  creator->setReorderingType(order_type, mat_type);
+
+  TACSAssembler *assembler = creator->createTACS();
+  creator->decref();
+
+  return assembler;
+}
+
+/*
+  Get the total number of elements and degrees of freedom
+*/
+static void benchGetModelSize(TACSAssembler *assembler, double *nelems,
+                              double *ndof) {
+  MPI_Comm comm = assembler->getMPIComm();
+  double local[2];
+  local[0] = assembler->getNumElements();
+  local[1] = assembler->getNumOwnedNodes() * assembler->getVarsPerNode();
+
+  double global[2];
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_SUM, comm);
+  *nelems = global[0];
+  *ndof = global[1];
+}
+
+/*
+  The data and kernels for the assembly and exchange benchmarks
+*/
+struct BenchAssemblyData {
+  TACSAssembler *assembler;
+  TACSBVec *vec;
+  TACSParallelMat *mat;
+};
+
+static void benchAssembleRes(void *data) {
+  BenchAssemblyData *d = (BenchAssemblyData *)data;
+  d->assembler->assembleRes(d->vec);
+}
+
+static void benchAssembleJacobian(void *data) {
+  BenchAssemblyData *d = (BenchAssemblyData *)data;
+  d->assembler->assembleJacobian(1.0, 0.0, 0.0, d->vec, d->mat);
+}
+
+static void benchDistribute(void *data) {
+  BenchAssemblyData *d = (BenchAssemblyData *)data;
+  d->vec->beginDistributeValues();
+  d->vec->endDistributeValues();
+}
+
+/*
+  Benchmark the assembly operations and the exchange of the ghost
+  values for all model types and orders
+*/
+static void benchAssembly(MPI_Comm comm, BenchOptions *opts, int size,
+                          int run_assembly, int run_distribute) {
+  for (int t = 0; t < BENCH_NUM_MODEL_TYPES; t++) {
+    BenchModelType type = (BenchModelType)t;
+    int max_order = (type == BENCH_BEAM ? 3 : 4);
+
+    for (int order = 2; order <= max_order; order++) {
+      TACSAssembler *assembler = benchCreateModel(
+          comm, type, order, size, opts->weak, TACSAssembler::RCM_ORDER,
+          TACSAssembler::ADDITIVE_SCHWARZ);
+      assembler->incref();
+      assembler->setNumThreads(opts->nthreads);
+
+      BenchAssemblyData data;
+      data.assembler = assembler;
+      data.vec = assembler->createVec();
+      data.vec->incref();
+      data.mat = assembler->createMat();
+      data.mat->incref();
+
+      // Set small non-zero values of the state variables
+      data.vec->set(1e-4);
+      assembler->setBCs(data.vec);
+      assembler->setVariables(data.vec);
+
+      BenchCase bc;
+      bc.model = benchModelNames[t];
+      bc.order = order;
+      bc.bsize = assembler->getVarsPerNode();
+      bc.size = size;
+      benchGetModelSize(assembler, &bc.nelems, &bc.ndof);
+
+      double time, flops;
+      if (run_assembly) {
+        bc.kernel = "assembleRes";
+        time = TACSBenchmark::timeKernel(comm, opts->nreps, benchAssembleRes,
+                                         &data, &flops);
+        benchWriteRecord(comm, opts, &bc, time, flops, 0.0);
+
+        bc.kernel = "assembleJacobian";
+        time = TACSBenchmark::timeKernel(comm, opts->nreps,
+                                         benchAssembleJacobian, &data, &flops);
+        benchWriteRecord(comm, opts, &bc, time, flops, 0.0);
+      }
+
+      if (run_distribute) {
+        bc.kernel = "distribute";
+        time = TACSBenchmark::timeKernel(comm, opts->nreps, benchDistribute,
+                                         &data, &flops);
+        benchWriteRecord(comm, opts, &bc, time, flops, 0.0);
+      }
+
+      data.vec->decref();
+      data.mat->decref();
+      assembler->decref();
+    }
+  }
+}
+
+/*
+  The data and kernels for the BCSRMat benchmarks
+*/
+struct BenchBCSRData {
+  BCSRMat *A;
+  BCSRMat *ilu;
+  BCSRMat *lu;
+  TacsScalar *x;
+  TacsScalar *y;
+};
+
+static void benchBCSRMult(void *data) {
+  BenchBCSRData *d = (BenchBCSRData *)data;
+  d->A->mult(d->x, d->y);
+}
+
+static void benchBCSRFactorILU(void *data) {
+  BenchBCSRData *d = (BenchBCSRData *)data;
+  d->ilu->copyValues(d->A);
+  d->ilu->factor();
+}
+
+static void benchBCSRApplyILU(void *data) {
+  BenchBCSRData *d = (BenchBCSRData *)data;
+  d->ilu->applyFactor(d->x, d->y);
+}
+
+static void benchBCSRFactorLU(void *data) {
+  BenchBCSRData *d = (BenchBCSRData *)data;
+  d->lu->copyValues(d->A);
+  d->lu->factor();
+}
+
+static void benchBCSRApplyLU(void *data) {
+  BenchBCSRData *d = (BenchBCSRData *)data;
+  d->lu->applyFactor(d->x, d->y);
+}
+
+/*
+  Generate a reproducible pseudo-random number in [0, 1)
+*/
+static double benchRandom(unsigned int *seed) {
+  *seed = 1664525u * (*seed) + 1013904223u;
+  return (*seed >> 8) * (1.0 / 16777216.0);
+}
+
+/*
+  Benchmark the BCSRMat kernels for all block sizes
+
+  The matrix has the non-zero pattern of a 9-point stencil on a size x
+  size grid with diagonally dominant block values, so that no pivoting
+  is required during the factorization.
+*/
+static void benchBCSR(MPI_Comm comm, BenchOptions *opts, int size) {
+  int n = size;
+  int nrows = n * n;
+
+  for (int bsize = 1; bsize <= 8; bsize++) {
+    int *rowp = new int[nrows + 1];
+    int *cols = new int[9 * nrows];
+    rowp[0] = 0;
+    for (int j = 0, row = 0; j < n; j++) {
+      for (int i = 0; i < n; i++, row++) {
+        int nnz = rowp[row];
+        for (int jj = j - 1; jj <= j + 1; jj++) {
+          for (int ii = i - 1; ii <= i + 1; ii++) {
+            if (ii >= 0 && ii < n && jj >= 0 && jj < n) {
+              cols[nnz] = ii + n * jj;
+              nnz++;
+            }
+          }
+        }
+        rowp[row + 1] = nnz;
+      }
+    }
+
+    int b2 = bsize * bsize;
+    TacsScalar *Avals = new TacsScalar[b2 * rowp[nrows]];
+    unsigned int seed = 1234u + bsize;
+    for (int row = 0; row < nrows; row++) {
+      for (int jp = rowp[row]; jp < rowp[row + 1]; jp++) {
+        TacsScalar *a = &Avals[b2 * jp];
+        for (int k = 0; k < b2; k++) {
+          a[k] = -benchRandom(&seed) / (9.0 * bsize);
+        }
+        if (cols[jp] == row) {
+          for (int k = 0; k < bsize; k++) {
+            a[(bsize + 1) * k] = 2.0 + benchRandom(&seed);
+          }
+        }
+      }
+    }
+
+    TACSThreadInfo *thread_info = new TACSThreadInfo(opts->nthreads);
+    BenchBCSRData data;
+    data.A = new BCSRMat(comm, thread_info, bsize, nrows, nrows, &rowp, &cols,
+                         &Avals);
+    data.A->incref();
+
+    // Compute the ILU(0) and the complete factorization
+    data.ilu = new BCSRMat(comm, data.A, 0, 1.0);
+    data.ilu->incref();
+    data.lu = new BCSRMat(comm, data.A, 10 * n, 10.0);
+    data.lu->incref();
+
+    data.x = new TacsScalar[bsize * nrows];
+    data.y = new TacsScalar[bsize * nrows];
+    for (int k = 0; k < bsize * nrows; k++) {
+      data.x[k] = benchRandom(&seed);
+    }
+
+    BenchCase bc;
+    bc.model = "bcsr";
+    bc.order = 0;
+    bc.bsize = bsize;
+    bc.size = size;
+    bc.nelems = 0.0;
+    bc.ndof = 1.0 * bsize * nrows;
+
+    struct {
+      const char *name;
+      void (*kernel)(void *);
+    } kernels[] = {{"BCSRMat::mult", benchBCSRMult},
+                   {"BCSRMat::factorILU0", benchBCSRFactorILU},
+                   {"BCSRMat::applyILU0", benchBCSRApplyILU},
+                   {"BCSRMat::factor", benchBCSRFactorLU},
+                   {"BCSRMat::applyFactor", benchBCSRApplyLU}};
+    int nkernels = sizeof(kernels) / sizeof(kernels[0]);
+
+    for (int k = 0; k < nkernels; k++) {
+      double flops;
+      bc.kernel = kernels[k].name;
+      double time = TACSBenchmark::timeKernel(comm, opts->nreps,
+                                              kernels[k].kernel, &data, &flops);
+      benchWriteRecord(comm, opts, &bc, time, flops, 0.0);
+    }
+
+    data.A->decref();
+    data.ilu->decref();
+    data.lu->decref();
+    delete[] data.x;
+    delete[] data.y;
+  }
+}
+
+/*
+  The data and kernels for the solver benchmarks
+*/
+struct BenchSolverData {
+  TACSAssembler *assembler;
+  TACSPc *pc;
+  TACSKsm *ksm;
+  TACSBVec *rhs;
+  TACSBVec *ans;
+  TACSLinearBuckling *buckling;
+};
+
+static void benchFactor(void *data) {
+  BenchSolverData *d = (BenchSolverData *)data;
+  d->pc->factor();
+}
+
+static void benchSolve(void *data) {
+  BenchSolverData *d = (BenchSolverData *)data;
+  d->ksm->solve(d->rhs, d->ans);
+}
+
+static void benchBuckling(void *data) {
+  BenchSolverData *d = (BenchSolverData *)data;
+  d->buckling->solve();
+}
+
+/*
+  Benchmark the solvers for the order 2 shell model
+*/
+static void benchSolvers(MPI_Comm comm, BenchOptions *opts, int size) {
+  int order = 2;
+  int gmres_iters = 100;
+  int lev_fill = 1000;
+  double fill = 10.0;
+
+  BenchCase bc;
+  bc.model = benchModelNames[BENCH_SHELL];
+  bc.order = order;
+  bc.bsize = 6;
+  bc.size = size;
+
+  double time, flops;
+
+  // GMRES with the Schur complement preconditioner and the Lanczos
+  // linear buckling analysis
+  TACSAssembler *assembler =
+      benchCreateModel(comm, BENCH_SHELL, order, size, opts->weak,
+                       TACSAssembler::ND_ORDER, TACSAssembler::DIRECT_SCHUR);
+  assembler->incref();
+  assembler->setNumThreads(opts->nthreads);
+  benchGetModelSize(assembler, &bc.nelems, &bc.ndof);
+
+  BenchSolverData data;
+  data.assembler = assembler;
+  data.rhs = assembler->createVec();
+  data.rhs->incref();
+  data.ans = assembler->createVec();
+  data.ans->incref();
+
+  TACSSchurMat *mat = assembler->createSchurMat();
+  mat->incref();
+  data.pc = new TACSSchurPc(mat, lev_fill, fill, 1);
+  data.pc->incref();
+  data.ksm = new GMRES(mat, data.pc, gmres_iters, 2, 0);
+  data.ksm->incref();
+  data.ksm->setTolerances(1e-10, 1e-30);
+  data.buckling = NULL;
+
+  assembler->zeroVariables();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+  data.rhs->set(1.0);
+  assembler->applyBCs(data.rhs);
+
+  bc.kernel = "SchurPc::factor";
+  time = TACSBenchmark::timeKernel(comm, opts->nreps, benchFactor, &data,
+                                   &flops);
+  benchWriteRecord(comm, opts, &bc, time, flops, 0.0);
+
+  bc.kernel = "GMRES+SchurPc::solve";
+  time = TACSBenchmark::timeKernel(comm, opts->nreps, benchSolve, &data,
+                                   &flops);
+  benchWriteRecord(comm, opts, &bc, time, flops, data.ksm->getIterCount());
+
+  // Set up the linear buckling analysis with its own matrices
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  TACSSchurMat *gmat = assembler->createSchurMat();
+  int max_lanczos = 40;
+  int num_eigvals = 5;
+  double eig_tol = 1e-8;
+  TacsScalar sigma = 10.0;
+  data.buckling =
+      new TACSLinearBuckling(assembler, sigma, gmat, kmat, mat, data.ksm,
+                             max_lanczos, num_eigvals, eig_tol);
+  data.buckling->incref();
+
+  bc.kernel = "TACSLinearBuckling::solve";
+  time = TACSBenchmark::timeKernel(comm, opts->nreps, benchBuckling, &data,
+                                   &flops);
+  benchWriteRecord(comm, opts, &bc, time, flops, num_eigvals);
+
+  data.buckling->decref();
+  data.ksm->decref();
+  data.pc->decref();
+  mat->decref();
+  data.rhs->decref();
+  data.ans->decref();
+  assembler->decref();
+
+  // GMRES with the algebraic multigrid preconditioner
+  assembler = benchCreateModel(comm, BENCH_SHELL, order, size, opts->weak,
+                               TACSAssembler::RCM_ORDER,
+                               TACSAssembler::ADDITIVE_SCHWARZ);
+  assembler->incref();
+  assembler->setNumThreads(opts->nthreads);
+
+  data.assembler = assembler;
+  data.rhs = assembler->createVec();
+  data.rhs->incref();
+  data.ans = assembler->createVec();
+  data.ans->incref();
+
+  TACSParallelMat *pmat = assembler->createMat();
+  pmat->incref();
+  assembler->zeroVariables();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, pmat);
+  data.rhs->set(1.0);
+  assembler->applyBCs(data.rhs);
+
+  MPI_Barrier(comm);
+  double t0 = MPI_Wtime();
+  data.pc = new TACSAmg(assembler, pmat);
+  data.pc->incref();
+  time = MPI_Wtime() - t0;
+
+  bc.kernel = "Amg::setup";
+  benchWriteRecord(comm, opts, &bc, time, 0.0, 0.0);
+
+  data.ksm = new GMRES(pmat, data.pc, gmres_iters, 2, 1);
+  data.ksm->incref();
+  data.ksm->setTolerances(1e-10, 1e-30);
+
+  bc.kernel = "Amg::factor";
+  time = TACSBenchmark::timeKernel(comm, opts->nreps, benchFactor, &data,
+                                   &flops);
+  benchWriteRecord(comm, opts, &bc, time, flops, 0.0);
+
+  bc.kernel = "GMRES+Amg::solve";
+  time = TACSBenchmark::timeKernel(comm, opts->nreps, benchSolve, &data,
+                                   &flops);
+  benchWriteRecord(comm, opts, &bc, time, flops, data.ksm->getIterCount());
+
+  data.ksm->decref();
+  data.pc->decref();
+  pmat->decref();
+  data.rhs->decref();
+  data.ans->decref();
+  assembler->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int rank, nranks;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nranks);
+
+  // Set the default options
+  const int max_sizes = 16;
+  int nsizes = 2;
+  int sizes[max_sizes] = {16, 32};
+  const char *output = NULL;
+  int run_assembly = 1, run_bcsr = 1, run_distribute = 1, run_solvers = 1;
+
+  BenchOptions opts;
+  opts.weak = 0;
+  opts.nreps = 5;
+  opts.nthreads = 1;
+  opts.fp = stdout;
+
+  for (int k = 1; k < argc; k++) {
+    if (strncmp(argv[k], "sizes=", 6) == 0) {
+      nsizes = 0;
+      char *s = &argv[k][6];
+      while (*s && nsizes < max_sizes) {
+        char *end;
+        int n = strtol(s, &end, 10);
+        if (end == s) {
+          break;
+        }
+        if (n > 0) {
+          sizes[nsizes] = n;
+          nsizes++;
+        }
+        s = (*end == ',' ? end + 1 : end);
+      }
+    } else if (strcmp(argv[k], "scaling=weak") == 0) {
+      opts.weak = 1;
+    } else if (strcmp(argv[k], "scaling=strong") == 0) {
+      opts.weak = 0;
+    } else if (sscanf(argv[k], "reps=%d", &opts.nreps) == 1) {
+      if (opts.nreps < 1) {
+        opts.nreps = 1;
+      }
+    } else if (sscanf(argv[k], "threads=%d", &opts.nthreads) == 1) {
+      if (opts.nthreads < 1) {
+        opts.nthreads = 1;
+      }
+    } else if (strncmp(argv[k], "kernels=", 8) == 0) {
+      const char *s = &argv[k][8];
+      run_assembly = (strstr(s, "assembly") != NULL);
+      run_bcsr = (strstr(s, "bcsr") != NULL);
+      run_distribute = (strstr(s, "distribute") != NULL);
+      run_solvers = (strstr(s, "solvers") != NULL);
+    } else if (strncmp(argv[k], "output=", 7) == 0) {
+      output = &argv[k][7];
+    }
+  }
+
+  if (rank == 0 && output) {
+    opts.fp = fopen(output, "w");
+    if (!opts.fp) {
+      fprintf(stderr, "benchmark_suite: Could not open %s\n", output);
+      opts.fp = stdout;
+    }
+  }
+
+  // Write the configuration of the run
+  if (rank == 0) {
+#ifdef TACS_USE_COMPLEX
+    int use_complex = 1;
+#else
+    int use_complex = 0;
+#endif
+    fprintf(opts.fp,
+            "{\"type\": \"config\", \"nranks\": %d, \"nthreads\": %d, "
+            "\"scaling\": \"%s\", \"reps\": %d, \"complex\": %d}\n",
+            nranks, opts.nthreads, (opts.weak ? "weak" : "strong"),
+            opts.nreps, use_complex);
+    fflush(opts.fp);
+  }
+
+  for (int k = 0; k < nsizes; k++) {
+    if (run_assembly || run_distribute) {
+      benchAssembly(comm, &opts, sizes[k], run_assembly, run_distribute);
+    }
+    if (run_bcsr) {
+      benchBCSR(comm, &opts, sizes[k]);
+    }
+    if (run_solvers) {
+      benchSolvers(comm, &opts, sizes[k]);
+    }
+  }
+
+  if (rank == 0 && opts.fp != stdout) {
+    fclose(opts.fp);
+  }
+
+#ifdef TACS_KERNEL_PROFILE
+  // Report the achieved rates of the BCSRMat kernels
+  BCSRMat::printKernelStats(comm, stderr);
+#endif  // TACS_KERNEL_PROFILE
+
+  MPI_Finalize();
+  return (0);
+}
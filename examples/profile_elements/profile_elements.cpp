@@ -83,6 +83,11 @@ int main(int argc, char *argv[]) {
     ename = argv[1];
   }
 
+  // Test the batched small-matrix operations used by the elements
+  if (!ename) {
+    TacsTestElementAlgebraBatch();
+  }
+
   const int MAX_NODES = 64;
   const int MAX_VARS_PER_NODE = 8;
   const int MAX_VARS = MAX_NODES * MAX_VARS_PER_NODE;
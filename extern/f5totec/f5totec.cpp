@@ -160,7 +160,22 @@ int main( int argc, char * argv[] ){
     return (1);
   }
 
+  // Distribute the input files cyclically over the processors so
+  // that each processor converts a subset of the time steps
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  int file_index = -1;
   for ( int k = 1; k < argc; k++ ){
+    if (strcmp(argv[k], "--use_strands") == 0){
+      continue;
+    }
+    file_index++;
+    if (file_index % size != rank){
+      continue;
+    }
+
     char *infile = new char[ strlen(argv[k])+1 ];
     strcpy(infile, argv[k]);
 
@@ -15,6 +15,13 @@
 /*
   An FH5 to VTK converter. This only works for specially written FH5
   files. (This is designed primarily to work with TACS).
+
+  When run in parallel, the input files are distributed cyclically
+  over the processors, so that each processor converts a subset of the
+  time steps of a transient series. With the --series <file> option,
+  the root processor also writes a ParaView file series that lists the
+  output files in the order they were given, so that the series can be
+  opened without concatenating the outputs.
 */
 
 // Include FH5 header files
@@ -33,13 +40,73 @@ const int VTK_QUADRATIC_TETRA = 24;
 int main(int argc, char *argv[]) {
   MPI_Init(&argc, &argv);
 
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // Check if we're going to write out a file series
+  const char *series_file = NULL;
+  int num_files = 0;
+  for (int k = 1; k < argc; k++) {
+    if (strcmp(argv[k], "--series") == 0) {
+      if (k + 1 < argc) {
+        series_file = argv[k + 1];
+      }
+      k++;
+    } else {
+      num_files++;
+    }
+  }
+
   // Convert hdf5 file argv[1] to
-  if (argc == 1) {
+  if (num_files == 0) {
     fprintf(stderr, "Error, no input files\n");
     return (1);
   }
 
+  // Write out the series file that points to the converted files
+  if (series_file && rank == 0) {
+    FILE *fp = fopen(series_file, "w");
+    if (fp) {
+      fprintf(fp, "{\n  \"file-series-version\" : \"1.0\",\n");
+      fprintf(fp, "  \"files\" : [\n");
+      int index = 0;
+      for (int k = 1; k < argc; k++) {
+        if (strcmp(argv[k], "--series") == 0) {
+          k++;
+          continue;
+        }
+        int len = strlen(argv[k]);
+        int i = len - 1;
+        for (; i >= 0; i--) {
+          if (argv[k][i] == '.') {
+            break;
+          }
+        }
+        fprintf(fp, "    { \"name\" : \"%.*s.vtk\", \"time\" : %d }%s\n", i,
+                argv[k], index, (index < num_files - 1 ? "," : ""));
+        index++;
+      }
+      fprintf(fp, "  ]\n}\n");
+      fclose(fp);
+    } else {
+      fprintf(stderr, "Failed to open the series file %s\n", series_file);
+    }
+  }
+
+  int file_index = -1;
   for (int iter = 1; iter < argc; iter++) {
+    if (strcmp(argv[iter], "--series") == 0) {
+      iter++;
+      continue;
+    }
+
+    // Each processor converts every size-th input file
+    file_index++;
+    if (file_index % size != rank) {
+      continue;
+    }
+
     char *infile = new char[strlen(argv[iter]) + 1];
     strcpy(infile, argv[iter]);
 
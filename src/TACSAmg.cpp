@@ -0,0 +1,667 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSAmg.h"
+
+/*
+  Implementation of smoothed aggregation algebraic multigrid
+*/
+
+/**
+  Build the algebraic multigrid hierarchy for the given matrix.
+
+  The coarsening stops when the number of nodes is at most coarse_size,
+  when the number of levels reaches max_levels, or when the number of
+  nodes is not reduced significantly.
+
+  @param assembler The finite-element model on the finest level
+  @param mat The matrix on the finest level
+  @param max_levels The maximum number of levels
+  @param coarse_size The target number of nodes on the coarsest level
+  @param theta Drop the connections weaker than theta times the strongest
+  @param smoother_type The type of smoother to use on each level
+  @param smoother_iters The Chebyshev degree or the Gauss-Seidel iterations
+*/
+TACSAmg::TACSAmg(TACSAssembler *_assembler, TACSParallelMat *_mat,
+                 int _max_levels, int _coarse_size, double _theta,
+                 AmgSmootherType _smoother_type, int _smoother_iters) {
+  assembler = _assembler;
+  assembler->incref();
+  comm = assembler->getMPIComm();
+
+  max_levels = _max_levels;
+  if (max_levels < 1) {
+    max_levels = 1;
+  }
+  coarse_size = _coarse_size;
+  theta = _theta;
+  smoother_type = _smoother_type;
+  smoother_iters = 1;
+  if (_smoother_iters > 0) {
+    smoother_iters = _smoother_iters;
+  }
+
+  monitor = NULL;
+  root_pc = NULL;
+
+  mat = new TACSParallelMat *[max_levels];
+  pc = new TACSPc *[max_levels];
+  interp = new TACSBVecInterp *[max_levels];
+  x = new TACSBVec *[max_levels];
+  b = new TACSBVec *[max_levels];
+  r = new TACSBVec *[max_levels];
+  for (int i = 0; i < max_levels; i++) {
+    mat[i] = NULL;
+    pc[i] = NULL;
+    interp[i] = NULL;
+    x[i] = b[i] = r[i] = NULL;
+  }
+
+  mat[0] = _mat;
+  mat[0]->incref();
+
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  // Copy the coordinates of the nodes owned by this processor
+  int num_nodes = assembler->getNumOwnedNodes();
+  TACSBVec *Xvec = assembler->createNodeVec();
+  Xvec->incref();
+  assembler->getNodes(Xvec);
+  TacsScalar *Xvals;
+  Xvec->getArray(&Xvals);
+  TacsScalar *X = new TacsScalar[3 * num_nodes];
+  memcpy(X, Xvals, 3 * num_nodes * sizeof(TacsScalar));
+  Xvec->decref();
+
+  // Exclude the nodes with boundary conditions from the coarse spaces
+  const int *range;
+  assembler->getNodeMap()->getOwnerRange(&range);
+  int *excluded = new int[num_nodes];
+  memset(excluded, 0, num_nodes * sizeof(int));
+
+  const int *bc_nodes, *bc_vars;
+  int nbcs = assembler->getBcMap()->getBCs(&bc_nodes, &bc_vars, NULL);
+  for (int i = 0; i < nbcs; i++) {
+    if (bc_vars[i] && bc_nodes[i] >= range[mpi_rank] &&
+        bc_nodes[i] < range[mpi_rank + 1]) {
+      excluded[bc_nodes[i] - range[mpi_rank]] = 1;
+    }
+  }
+
+  // Build the coarse levels
+  nlevels = 1;
+  while (nlevels < max_levels) {
+    const int *fine_range;
+    mat[nlevels - 1]->getRowMap()->getOwnerRange(&fine_range);
+    int fine_size = fine_range[mpi_size];
+    if (fine_size <= coarse_size) {
+      break;
+    }
+
+    TACSNodeMap *coarse_map;
+    TacsScalar *coarse_X;
+    TACSBVecInterp *P =
+        coarsen(mat[nlevels - 1], excluded, X, &coarse_map, &coarse_X);
+    P->incref();
+
+    // Stop if the coarsening has stalled
+    const int *coarse_range;
+    coarse_map->getOwnerRange(&coarse_range);
+    int size = coarse_range[mpi_size];
+    if (size == 0 || size > 0.9 * fine_size) {
+      P->decref();
+      delete[] coarse_X;
+      break;
+    }
+
+    interp[nlevels - 1] = P;
+    P->computeGalerkinNonZeroPattern(mat[nlevels - 1], &mat[nlevels]);
+    mat[nlevels]->incref();
+
+    // Only the nodes on the finest level are excluded
+    if (excluded) {
+      delete[] excluded;
+      excluded = NULL;
+    }
+    delete[] X;
+    X = coarse_X;
+    nlevels++;
+  }
+
+  if (excluded) {
+    delete[] excluded;
+  }
+  delete[] X;
+
+  // Create the smoothers and the vectors on each level
+  int bsize = assembler->getVarsPerNode();
+  for (int i = 0; i < nlevels; i++) {
+    if (i < nlevels - 1) {
+      if (smoother_type == GAUSS_SEIDEL_SMOOTHER) {
+        int zero_guess = 0, symmetric = 1;
+        pc[i] = new TACSGaussSeidel(mat[i], zero_guess, 1.0, smoother_iters,
+                                    symmetric);
+      } else {
+        pc[i] = new TACSChebyshevSmoother(mat[i], smoother_iters);
+      }
+      pc[i]->incref();
+    }
+
+    if (i == 0) {
+      r[i] = assembler->createVec();
+    } else {
+      x[i] = new TACSBVec(mat[i]->getRowMap(), bsize);
+      x[i]->incref();
+      b[i] = new TACSBVec(mat[i]->getRowMap(), bsize);
+      b[i]->incref();
+      r[i] = new TACSBVec(mat[i]->getRowMap(), bsize);
+    }
+    r[i]->incref();
+  }
+
+  // Set up the direct solver for the coarsest level
+  root_pc = new TACSBlockCyclicPc(mat[nlevels - 1]);
+  root_pc->incref();
+}
+
+/**
+  Deallocate the data stored internally
+*/
+TACSAmg::~TACSAmg() {
+  for (int i = 0; i < nlevels; i++) {
+    if (mat[i]) {
+      mat[i]->decref();
+    }
+    if (pc[i]) {
+      pc[i]->decref();
+    }
+    if (interp[i]) {
+      interp[i]->decref();
+    }
+    if (x[i]) {
+      x[i]->decref();
+    }
+    if (b[i]) {
+      b[i]->decref();
+    }
+    if (r[i]) {
+      r[i]->decref();
+    }
+  }
+  if (root_pc) {
+    root_pc->decref();
+  }
+  if (monitor) {
+    monitor->decref();
+  }
+  assembler->decref();
+
+  delete[] mat;
+  delete[] pc;
+  delete[] interp;
+  delete[] x;
+  delete[] b;
+  delete[] r;
+}
+
+/*
+  Form the aggregates for the matrix and create the smoothed
+  prolongation operator from the next coarsest level.
+
+  The auxiliary graph has the non-zero pattern of the matrix with a
+  weight of 1/|x_i - x_j|^2 for each connection. A connection is
+  strong if its weight is at least theta times the largest weight in
+  the row. The aggregates are formed on each processor in three passes:
+
+  1. Each node whose strong neighbors are not aggregated forms a new
+  aggregate with them.
+
+  2. The remaining nodes join the aggregate of their strongest
+  aggregated neighbor from the first pass.
+
+  3. The nodes that are still not aggregated form new aggregates with
+  their neighbors that are not aggregated.
+
+  The prolongation operator is then smoothed with a damped Jacobi step
+  on the auxiliary graph. The weights in each row are non-negative and
+  sum to one.
+
+  @param A The matrix on the fine level
+  @param excluded Flags for the nodes to exclude (may be NULL)
+  @param X The coordinates of the fine nodes
+  @param coarse_map The node map for the coarse level
+  @param coarse_X The coordinates of the coarse nodes
+  @return The interpolation from the coarse level to the fine level
+*/
+TACSBVecInterp *TACSAmg::coarsen(TACSParallelMat *A, const int *excluded,
+                                 const TacsScalar *X, TACSNodeMap **coarse_map,
+                                 TacsScalar **coarse_X) {
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  TACSNodeMap *fine_map = A->getRowMap();
+  const int *range;
+  fine_map->getOwnerRange(&range);
+
+  // Get the non-zero pattern of the local and external parts
+  BCSRMat *Aloc, *Bext;
+  A->getBCSRMat(&Aloc, &Bext);
+  int bsize, N;
+  const int *rowp, *cols;
+  Aloc->getArrays(&bsize, &N, NULL, &rowp, &cols, NULL);
+  const int *brow, *bcols;
+  Bext->getArrays(NULL, NULL, NULL, &brow, &bcols, NULL);
+
+  int Nc;
+  A->getRowMap(NULL, NULL, &Nc);
+  int ext_offset = N - Nc;
+
+  // Get the coordinates of the external nodes
+  TACSBVecDistribute *ext_dist;
+  A->getExtColMap(&ext_dist);
+  int num_ext = ext_dist->getNumNodes();
+  TacsScalar *Xext = new TacsScalar[3 * num_ext];
+  TACSBVecDistCtx *ctx = ext_dist->createCtx(3);
+  ctx->incref();
+  ext_dist->beginForward(ctx, (TacsScalar *)X, Xext);
+  ext_dist->endForward(ctx, (TacsScalar *)X, Xext);
+  ctx->decref();
+
+  // Find the strong connections in the auxiliary graph. The local
+  // connections are stored first in each row, followed by the
+  // external connections.
+  int max_row_size = 0;
+  int *srowp = new int[N + 1];
+  int *next = new int[N];
+  srowp[0] = 0;
+  for (int i = 0; i < N; i++) {
+    int size = rowp[i + 1] - rowp[i];
+    if (i >= ext_offset) {
+      size += brow[i - ext_offset + 1] - brow[i - ext_offset];
+    }
+    srowp[i + 1] = srowp[i] + size;
+    if (size > max_row_size) {
+      max_row_size = size;
+    }
+  }
+
+  int *scols = new int[srowp[N]];
+  double *sweights = new double[srowp[N]];
+  for (int i = 0; i < N; i++) {
+    const TacsScalar *xi = &X[3 * i];
+
+    // Compute the squared distances to the neighbors
+    int n = srowp[i];
+    for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      int j = cols[jp];
+      if (j != i) {
+        const TacsScalar *xj = &X[3 * j];
+        double d0 = TacsRealPart(xi[0] - xj[0]);
+        double d1 = TacsRealPart(xi[1] - xj[1]);
+        double d2 = TacsRealPart(xi[2] - xj[2]);
+        scols[n] = j;
+        sweights[n] = d0 * d0 + d1 * d1 + d2 * d2;
+        n++;
+      }
+    }
+    next[i] = n - srowp[i];
+    if (i >= ext_offset) {
+      int row = i - ext_offset;
+      for (int jp = brow[row]; jp < brow[row + 1]; jp++) {
+        const TacsScalar *xj = &Xext[3 * bcols[jp]];
+        double d0 = TacsRealPart(xi[0] - xj[0]);
+        double d1 = TacsRealPart(xi[1] - xj[1]);
+        double d2 = TacsRealPart(xi[2] - xj[2]);
+        scols[n] = bcols[jp];
+        sweights[n] = d0 * d0 + d1 * d1 + d2 * d2;
+        n++;
+      }
+    }
+
+    // Coincident nodes are given the largest weight in the row
+    double dmin = 0.0;
+    for (int jp = srowp[i]; jp < n; jp++) {
+      if (sweights[jp] > 0.0 && (dmin == 0.0 || sweights[jp] < dmin)) {
+        dmin = sweights[jp];
+      }
+    }
+    if (dmin == 0.0) {
+      dmin = 1.0;
+    }
+
+    // Compute the weights and drop the weak connections
+    for (int jp = srowp[i]; jp < n; jp++) {
+      if (sweights[jp] > dmin) {
+        sweights[jp] = dmin / sweights[jp];
+      } else {
+        sweights[jp] = 1.0;
+      }
+      if (sweights[jp] < theta) {
+        sweights[jp] = 0.0;
+      }
+    }
+
+    // Record the number of local connections and pad the row
+    next[i] += srowp[i];
+    for (int jp = n; jp < srowp[i + 1]; jp++) {
+      scols[jp] = -1;
+      sweights[jp] = 0.0;
+    }
+  }
+  delete[] Xext;
+
+  // Form the aggregates from the strong local connections
+  int *agg = new int[N];
+  for (int i = 0; i < N; i++) {
+    agg[i] = -1;
+  }
+
+  int num_agg = 0;
+  for (int i = 0; i < N; i++) {
+    if ((excluded && excluded[i]) || agg[i] >= 0) {
+      continue;
+    }
+    int is_free = 1, count = 0;
+    for (int jp = srowp[i]; jp < next[i]; jp++) {
+      int j = scols[jp];
+      if (sweights[jp] > 0.0 && !(excluded && excluded[j])) {
+        if (agg[j] >= 0) {
+          is_free = 0;
+          break;
+        }
+        count++;
+      }
+    }
+    if (is_free && count > 0) {
+      agg[i] = num_agg;
+      for (int jp = srowp[i]; jp < next[i]; jp++) {
+        int j = scols[jp];
+        if (sweights[jp] > 0.0 && !(excluded && excluded[j])) {
+          agg[j] = num_agg;
+        }
+      }
+      num_agg++;
+    }
+  }
+
+  int *agg1 = new int[N];
+  memcpy(agg1, agg, N * sizeof(int));
+  for (int i = 0; i < N; i++) {
+    if ((excluded && excluded[i]) || agg[i] >= 0) {
+      continue;
+    }
+    double wmax = 0.0;
+    for (int jp = srowp[i]; jp < next[i]; jp++) {
+      int j = scols[jp];
+      if (agg1[j] >= 0 && sweights[jp] > wmax) {
+        wmax = sweights[jp];
+        agg[i] = agg1[j];
+      }
+    }
+  }
+  delete[] agg1;
+
+  for (int i = 0; i < N; i++) {
+    if ((excluded && excluded[i]) || agg[i] >= 0) {
+      continue;
+    }
+    agg[i] = num_agg;
+    for (int jp = srowp[i]; jp < next[i]; jp++) {
+      int j = scols[jp];
+      if (sweights[jp] > 0.0 && !(excluded && excluded[j]) && agg[j] < 0) {
+        agg[j] = num_agg;
+      }
+    }
+    num_agg++;
+  }
+
+  // Create the coarse node map and place the coarse nodes at the
+  // centroids of the aggregates
+  *coarse_map = new TACSNodeMap(comm, num_agg);
+  const int *coarse_range;
+  (*coarse_map)->getOwnerRange(&coarse_range);
+  int coarse_offset = coarse_range[mpi_rank];
+
+  TacsScalar *cX = new TacsScalar[3 * num_agg];
+  int *agg_count = new int[num_agg];
+  memset(cX, 0, 3 * num_agg * sizeof(TacsScalar));
+  memset(agg_count, 0, num_agg * sizeof(int));
+  for (int i = 0; i < N; i++) {
+    if (agg[i] >= 0) {
+      for (int k = 0; k < 3; k++) {
+        cX[3 * agg[i] + k] += X[3 * i + k];
+      }
+      agg_count[agg[i]]++;
+    }
+  }
+  for (int i = 0; i < num_agg; i++) {
+    for (int k = 0; k < 3; k++) {
+      cX[3 * i + k] *= 1.0 / agg_count[i];
+    }
+  }
+  delete[] agg_count;
+  *coarse_X = cX;
+
+  // Get the coarse node numbers of the external nodes
+  TacsScalar *gagg = new TacsScalar[N];
+  TacsScalar *gagg_ext = new TacsScalar[num_ext];
+  for (int i = 0; i < N; i++) {
+    gagg[i] = -1.0;
+    if (agg[i] >= 0) {
+      gagg[i] = coarse_offset + agg[i];
+    }
+  }
+  ctx = ext_dist->createCtx(1);
+  ctx->incref();
+  ext_dist->beginForward(ctx, gagg, gagg_ext);
+  ext_dist->endForward(ctx, gagg, gagg_ext);
+  ctx->decref();
+
+  // Create the smoothed prolongation operator. The eigenvalues of the
+  // normalized graph Laplacian lie in [0, 2], so the Jacobi damping
+  // factor is omega = 4/(3*2).
+  const double omega = 2.0 / 3.0;
+  TACSBVecInterp *P = new TACSBVecInterp(*coarse_map, fine_map, bsize);
+  P->setThreadInfo(Aloc->getThreadInfo());
+
+  int *vars = new int[max_row_size + 1];
+  TacsScalar *weights = new TacsScalar[max_row_size + 1];
+  for (int i = 0; i < N; i++) {
+    if (agg[i] < 0) {
+      continue;
+    }
+
+    // Add the strong connections to nodes in the coarse space
+    int n = 1;
+    double wsum = 0.0;
+    for (int jp = srowp[i]; jp < srowp[i + 1]; jp++) {
+      if (sweights[jp] > 0.0) {
+        int c = -1;
+        if (jp < next[i]) {
+          c = agg[scols[jp]];
+          if (c >= 0) {
+            c += coarse_offset;
+          }
+        } else {
+          c = (int)TacsRealPart(gagg_ext[scols[jp]]);
+        }
+        if (c >= 0) {
+          vars[n] = c;
+          weights[n] = sweights[jp];
+          wsum += sweights[jp];
+          n++;
+        }
+      }
+    }
+
+    vars[0] = coarse_offset + agg[i];
+    weights[0] = 1.0;
+    if (wsum > 0.0) {
+      weights[0] = 1.0 - omega;
+      for (int k = 1; k < n; k++) {
+        weights[k] *= omega / wsum;
+      }
+    } else {
+      n = 1;
+    }
+    P->addInterp(range[mpi_rank] + i, weights, vars, n);
+  }
+  P->initialize();
+
+  delete[] vars;
+  delete[] weights;
+  delete[] gagg;
+  delete[] gagg_ext;
+  delete[] agg;
+  delete[] srowp;
+  delete[] next;
+  delete[] scols;
+  delete[] sweights;
+
+  return P;
+}
+
+/**
+  Compute the coarse operators and factor the smoothers and the
+  direct solver for the coarsest level.
+*/
+void TACSAmg::factor() {
+  for (int i = 1; i < nlevels; i++) {
+    interp[i - 1]->computeGalerkin(mat[i - 1], mat[i]);
+  }
+  for (int i = 0; i < nlevels - 1; i++) {
+    pc[i]->factor();
+  }
+  root_pc->factor();
+
+  if (monitor) {
+    int mpi_size;
+    MPI_Comm_size(comm, &mpi_size);
+    for (int i = 0; i < nlevels; i++) {
+      const int *range;
+      mat[i]->getRowMap()->getOwnerRange(&range);
+      char descript[128];
+      snprintf(descript, sizeof(descript), "TACSAmg level %2d nodes %10d\n",
+               i, range[mpi_size]);
+      monitor->print(descript);
+    }
+  }
+}
+
+/**
+  Apply a V-cycle of the multigrid preconditioner with a zero initial
+  guess
+
+  @param bvec The input right-hand-side
+  @param xvec The output vector
+*/
+void TACSAmg::applyFactor(TACSVec *bvec, TACSVec *xvec) {
+  b[0] = dynamic_cast<TACSBVec *>(bvec);
+  x[0] = dynamic_cast<TACSBVec *>(xvec);
+
+  if (b[0] && x[0]) {
+    x[0]->zeroEntries();
+    applyMg(0);
+  } else {
+    fprintf(stderr, "TACSAmg type error: Input/output must be TACSBVec\n");
+  }
+
+  b[0] = NULL;
+  x[0] = NULL;
+}
+
+/*
+  Apply the multigrid cycle recursively, starting from the given level
+*/
+void TACSAmg::applyMg(int level) {
+  if (level == nlevels - 1) {
+    root_pc->applyFactor(b[level], x[level]);
+    return;
+  }
+
+  // Pre-smooth at the current level
+  pc[level]->applyFactor(b[level], x[level]);
+
+  // Compute r[level] = b[level] - A*x[level]
+  mat[level]->mult(x[level], r[level]);
+  r[level]->axpby(1.0, -1.0, b[level]);
+
+  // Restrict the residual and apply multigrid on the coarser level
+  interp[level]->multTranspose(r[level], b[level + 1]);
+  x[level + 1]->zeroEntries();
+  applyMg(level + 1);
+
+  // Interpolate the correction and post-smooth
+  interp[level]->multAdd(x[level + 1], x[level], x[level]);
+  pc[level]->applyFactor(b[level], x[level]);
+}
+
+/**
+  Get the matrix operator associated with the finest level
+
+  @param _mat A pointer to the matrix
+*/
+void TACSAmg::getMat(TACSMat **_mat) { *_mat = mat[0]; }
+
+/**
+  Get the number of levels in the hierarchy
+*/
+int TACSAmg::getNumLevels() { return nlevels; }
+
+/**
+  Retrieve the matrix at the specified level
+
+  @param level The multigrid level
+  @return The matrix at the specified level (NULL if invalid)
+*/
+TACSParallelMat *TACSAmg::getMat(int level) {
+  if (level >= 0 && level < nlevels) {
+    return mat[level];
+  }
+  return NULL;
+}
+
+/**
+  Retrieve the interpolation from the next coarsest level
+
+  @param level The multigrid level
+  @return The interpolation object (NULL if invalid)
+*/
+TACSBVecInterp *TACSAmg::getInterpolation(int level) {
+  if (level >= 0 && level < nlevels - 1) {
+    return interp[level];
+  }
+  return NULL;
+}
+
+/**
+  Set the monitor used to print the size of each level
+
+  @param monitor The print monitor object
+*/
+void TACSAmg::setMonitor(KSMPrint *_monitor) {
+  if (_monitor) {
+    _monitor->incref();
+  }
+  if (monitor) {
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
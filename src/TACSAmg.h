@@ -0,0 +1,127 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_AMG_H
+#define TACS_AMG_H
+
+/*
+  Algebraic multigrid preconditioner based on smoothed aggregation
+*/
+
+#include "TACSAssembler.h"
+#include "TACSBVec.h"
+#include "TACSBVecInterp.h"
+
+/*
+  This class implements a smoothed aggregation algebraic multigrid
+  preconditioner that only requires the finest TACSAssembler model.
+
+  The coarse levels are built automatically from the non-zero pattern
+  of the finest matrix and the nodal coordinates. At each level, an
+  auxiliary graph is formed with a weight of 1/|x_i - x_j|^2 for each
+  pair of connected nodes, and the weak connections are dropped. The
+  nodes are grouped into aggregates within each processor, and each
+  aggregate becomes a node on the next coarsest level, located at the
+  centroid of its nodes.
+
+  The tentative prolongation operator copies the values of each coarse
+  node to all the nodes in its aggregate. This is then smoothed with a
+  damped Jacobi step on the auxiliary graph. The prolongation operators
+  are stored as TACSBVecInterp objects, which apply the same weight to
+  every component of a node, so the coarse spaces contain the constant
+  modes of each component. These include the rigid translations, while
+  the smoothing step provides the linear variation of the translations
+  required by the rigid rotations. Nodes with boundary conditions on
+  the finest level are excluded from the coarse spaces.
+
+  The coarse operators are computed with the Galerkin projection in
+  TACSBVecInterp, and each level is smoothed with either a Chebyshev
+  or a Gauss-Seidel smoother. The coarsest level is solved with the
+  parallel direct solver.
+
+  The hierarchy is built in the constructor and only depends on the
+  non-zero pattern of the matrix. The call to factor() recomputes the
+  coarse operators from the current matrix values.
+*/
+class TACSAmg : public TACSPc {
+ public:
+  enum AmgSmootherType { CHEBYSHEV_SMOOTHER, GAUSS_SEIDEL_SMOOTHER };
+
+  TACSAmg(TACSAssembler *_assembler, TACSParallelMat *_mat,
+          int _max_levels = 10, int _coarse_size = 1000,
+          double _theta = 0.25,
+          AmgSmootherType _smoother_type = CHEBYSHEV_SMOOTHER,
+          int _smoother_iters = 3);
+  ~TACSAmg();
+
+  // Methods required by the TACSPc class
+  // ------------------------------------
+  void factor();
+  void applyFactor(TACSVec *x, TACSVec *y);
+  void getMat(TACSMat **_mat);
+
+  // Retrieve information about the hierarchy
+  // ----------------------------------------
+  int getNumLevels();
+  TACSParallelMat *getMat(int level);
+  TACSBVecInterp *getInterpolation(int level);
+
+  // Set the solution monitor context
+  // --------------------------------
+  void setMonitor(KSMPrint *_monitor);
+
+ private:
+  // Build the interpolation from the next coarsest level
+  TACSBVecInterp *coarsen(TACSParallelMat *A, const int *excluded,
+                          const TacsScalar *X, TACSNodeMap **coarse_map,
+                          TacsScalar **coarse_X);
+
+  // Recursive function to apply multigrid at each level
+  void applyMg(int level);
+
+  // The MPI communicator for this object
+  MPI_Comm comm;
+
+  // Monitor the solution
+  KSMPrint *monitor;
+
+  // The finest level model
+  TACSAssembler *assembler;
+
+  // Parameters for the coarsening and the smoothers
+  int max_levels, coarse_size;
+  double theta;
+  AmgSmootherType smoother_type;
+  int smoother_iters;
+
+  // The number of levels in the hierarchy
+  int nlevels;
+
+  // The matrices, smoothers and interpolation operators
+  TACSParallelMat **mat;
+  TACSPc **pc;
+  TACSBVecInterp **interp;
+
+  // The solution, right-hand-side and residual on each level
+  TACSBVec **x, **b, **r;
+
+  // The direct solver for the coarsest level
+  TACSPc *root_pc;
+};
+
+#endif  // TACS_AMG_H
@@ -0,0 +1,205 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSAndersonAcceleration.h"
+
+/*
+  Allocate the history for Anderson acceleration
+
+  @param assembler The finite-element model
+  @param _depth The maximum number of stored differences
+*/
+TACSAndersonAcceleration::TACSAndersonAcceleration(TACSAssembler *assembler,
+                                                   int _depth) {
+  depth = (_depth < 1 ? 1 : _depth);
+
+  dz = new TACSVec *[depth];
+  df = new TACSVec *[depth];
+  dzs = new TacsScalar[depth];
+  dfs = new TacsScalar[depth];
+  for (int i = 0; i < depth; i++) {
+    dz[i] = assembler->createVec();
+    dz[i]->incref();
+    df[i] = assembler->createVec();
+    df[i]->incref();
+    dzs[i] = dfs[i] = 0.0;
+  }
+
+  fprev = assembler->createVec();
+  fprev->incref();
+  sprev = assembler->createVec();
+  sprev->incref();
+  fprev_s = sprev_s = 0.0;
+
+  gram = new TacsScalar[depth * depth];
+  rhs = new TacsScalar[depth];
+  coef = new TacsScalar[depth];
+  work = new TacsScalar[depth * depth];
+
+  reset();
+}
+
+TACSAndersonAcceleration::~TACSAndersonAcceleration() {
+  for (int i = 0; i < depth; i++) {
+    dz[i]->decref();
+    df[i]->decref();
+  }
+  delete[] dz;
+  delete[] df;
+  delete[] dzs;
+  delete[] dfs;
+  fprev->decref();
+  sprev->decref();
+  delete[] gram;
+  delete[] rhs;
+  delete[] coef;
+  delete[] work;
+}
+
+/*
+  Discard the history. This must be called whenever the frozen Jacobian
+  changes, or when a new nonlinear problem is solved.
+*/
+void TACSAndersonAcceleration::reset() {
+  num_cols = 0;
+  next_col = 0;
+  has_prev = 0;
+}
+
+/*
+  Replace the update f (and the optional scalar component fs) with the
+  Anderson-accelerated update. The caller applies the update in the
+  same way as the unaccelerated update.
+
+  @param f The update from the frozen Jacobian, overwritten on exit
+  @param fs The optional scalar component of the update
+*/
+void TACSAndersonAcceleration::computeUpdate(TACSBVec *f, TacsScalar *fs) {
+  TacsScalar fsval = (fs ? *fs : 0.0);
+
+  if (has_prev) {
+    // Store the differences from the previous iteration
+    int col = next_col;
+    df[col]->copyValues(f);
+    df[col]->axpy(-1.0, fprev);
+    dfs[col] = fsval - fprev_s;
+    dz[col]->copyValues(sprev);
+    dzs[col] = sprev_s;
+
+    next_col = (next_col + 1) % depth;
+    if (num_cols < depth) {
+      num_cols++;
+    }
+
+    // Update the Gram matrix with the new column
+    df[col]->mdot(df, coef, num_cols);
+    for (int i = 0; i < num_cols; i++) {
+      coef[i] += dfs[col] * dfs[i];
+      gram[depth * col + i] = coef[i];
+      gram[depth * i + col] = coef[i];
+    }
+  }
+
+  // Save the unaccelerated update for the next iteration
+  fprev->copyValues(f);
+  fprev_s = fsval;
+  has_prev = 1;
+
+  if (num_cols > 0) {
+    // Find the combination of differences that minimizes the update
+    f->mdot(df, rhs, num_cols);
+    for (int i = 0; i < num_cols; i++) {
+      rhs[i] += dfs[i] * fsval;
+    }
+    solveLeastSquares(num_cols, coef);
+
+    // Compute s = f - (dZ + dF)*c
+    for (int i = 0; i < num_cols; i++) {
+      f->axpy(-coef[i], dz[i]);
+      f->axpy(-coef[i], df[i]);
+      fsval -= coef[i] * (dzs[i] + dfs[i]);
+    }
+  }
+
+  // Save the step for the next iteration
+  sprev->copyValues(f);
+  sprev_s = fsval;
+  if (fs) {
+    *fs = fsval;
+  }
+}
+
+/*
+  Solve the normal equations gram*c = rhs with Gaussian elimination.
+  A small regularization keeps the problem solvable when the stored
+  differences are nearly linearly dependent.
+*/
+void TACSAndersonAcceleration::solveLeastSquares(int n, TacsScalar *c) {
+  double max_diag = 0.0;
+  for (int i = 0; i < n; i++) {
+    if (TacsRealPart(gram[(depth + 1) * i]) > max_diag) {
+      max_diag = TacsRealPart(gram[(depth + 1) * i]);
+    }
+  }
+
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      work[n * i + j] = gram[depth * i + j];
+    }
+    work[(n + 1) * i] += 1e-12 * max_diag;
+    c[i] = rhs[i];
+  }
+
+  // Factor with partial pivoting and forward eliminate
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    for (int i = k + 1; i < n; i++) {
+      if (fabs(TacsRealPart(work[n * i + k])) >
+          fabs(TacsRealPart(work[n * p + k]))) {
+        p = i;
+      }
+    }
+    if (TacsRealPart(work[n * p + k]) == 0.0) {
+      for (int i = 0; i < n; i++) {
+        c[i] = 0.0;
+      }
+      return;
+    }
+    if (p != k) {
+      for (int j = 0; j < n; j++) {
+        TacsScalar t = work[n * k + j];
+        work[n * k + j] = work[n * p + j];
+        work[n * p + j] = t;
+      }
+      TacsScalar t = c[k];
+      c[k] = c[p];
+      c[p] = t;
+    }
+    for (int i = k + 1; i < n; i++) {
+      TacsScalar f = work[n * i + k] / work[n * k + k];
+      for (int j = k; j < n; j++) {
+        work[n * i + j] -= f * work[n * k + j];
+      }
+      c[i] -= f * c[k];
+    }
+  }
+
+  // Back substitution
+  for (int i = n - 1; i >= 0; i--) {
+    for (int j = i + 1; j < n; j++) {
+      c[i] -= work[n * i + j] * c[j];
+    }
+    c[i] /= work[n * i + i];
+  }
+}
@@ -0,0 +1,87 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_ANDERSON_ACCELERATION_H
+#define TACS_ANDERSON_ACCELERATION_H
+
+#include "TACSAssembler.h"
+
+/*
+  Anderson acceleration for Newton iterations with a frozen Jacobian
+
+  With a frozen factorization P, the Newton iteration is the fixed-point
+  iteration
+
+  z[k+1] = z[k] + f[k],   f[k] = P^{-1} R(z[k])
+
+  where the states are updated as u = u0 - z. This class replaces the
+  update f[k] with the Anderson-accelerated update
+
+  s[k] = f[k] - (dZ + dF) * c
+
+  where dZ and dF store the last depth differences of the iterates and
+  updates, and c minimizes ||f[k] - dF * c||. This is equivalent to
+  GMRES applied to the linearized problem, so a frozen Jacobian retains
+  close to Newton convergence for longer. The history must be reset
+  whenever P changes.
+
+  An optional scalar component can be appended to the update, for
+  instance the load factor update in an arc-length method.
+*/
+class TACSAndersonAcceleration : public TACSObject {
+ public:
+  TACSAndersonAcceleration(TACSAssembler *assembler, int _depth);
+  ~TACSAndersonAcceleration();
+
+  // Get the maximum number of stored differences
+  // --------------------------------------------
+  int getDepth() { return depth; }
+
+  // Discard the history
+  // -------------------
+  void reset();
+
+  // Replace the update with the accelerated update
+  // ----------------------------------------------
+  void computeUpdate(TACSBVec *f, TacsScalar *fs = NULL);
+
+ private:
+  // Solve the least-squares problem with the normal equations
+  void solveLeastSquares(int n, TacsScalar *c);
+
+  // The maximum number of stored differences
+  int depth;
+
+  // The number of stored differences and the next column to replace
+  int num_cols, next_col;
+
+  // Flag to indicate whether the previous update is stored
+  int has_prev;
+
+  // The differences in the iterates and the updates
+  TACSVec **dz, **df;
+  TacsScalar *dzs, *dfs;
+
+  // The previous unaccelerated update and the previous step
+  TACSBVec *fprev, *sprev;
+  TacsScalar fprev_s, sprev_s;
+
+  // The Gram matrix of the update differences
+  TacsScalar *gram;
+
+  // Temporary arrays for the least-squares problem
+  TacsScalar *rhs, *coef, *work;
+};
+
+#endif  // TACS_ANDERSON_ACCELERATION_H
@@ -19,8 +19,13 @@
 #include "TACSAssembler.h"
 
 #include "TACSElementVerification.h"
+#include "TACSMemory.h"
+#include "TACSProfiler.h"
+#include "TACSScratchArena.h"
 #include "TacsUtilities.h"
 
+#include <unordered_map>
+
 // Reordering implementation
 #include "AMDInterface.h"
 
@@ -67,7 +72,52 @@ TACSAssembler::TACSAssembler(MPI_Comm _tacs_comm, int _varsPerNode,
 
   // Create the class that is used to
   tacsPInfo = new TACSAssemblerPthreadInfo();
-  numCompletedElements = 0;
+  elemSchedule = NULL;
+  elementCosts = NULL;
+  useElementColoring = 0;
+  numElementColors = 0;
+  elementColorPtr = NULL;
+  elementColors = NULL;
+  colorSchedules = NULL;
+  elementBatchSize = 8;
+  elementRegistry = NULL;
+  elementKernels = NULL;
+  elementOrderType = NATURAL_ELEMENT_ORDER;
+  elementOrder = NULL;
+  useMatScatterPlan = 1;
+  useIncrementalJacobian = 0;
+  incrementalLinear = 0;
+  incrementalMaxMemory = -1.0;
+  incrementalStateTol = 0.0;
+  incrementalTimeIndependent = 0;
+  incrementalCount = 0;
+  incrementalMat = NULL;
+  incrementalPtr = NULL;
+  incrementalCache = NULL;
+  useElementMatCache = 0;
+  elementMatCacheMaxMemory = -1.0;
+  elementMatCacheTime = 0.0;
+  elementMatCachePtr = NULL;
+  elementMatCacheFlags = NULL;
+  elementMatCacheData = NULL;
+  elementMatCacheHits = 0;
+  elementMatCacheMisses = 0;
+  elementCacheMemory = 0;
+  useElementGeometryCache = 0;
+  useSymmetricElementMatrices = 0;
+  useAssemblyBCs = 0;
+  elementBCFlags = NULL;
+  numOwnedBCNodes = 0;
+  ownedBCNodes = ownedBCFlags = NULL;
+  elementTimes = NULL;
+  numXptSensNodes = 0;
+  xptSensNodes = NULL;
+  xptSensElemFlags = NULL;
+  designVersion = 0;
+  nodeVersion = 0;
+  auxElementsVersion = 0;
+  stateVersion = 0;
+  loadVersion = 0;
 
   // copy data to be used later in the program
   varsPerNode = _varsPerNode;
@@ -114,6 +164,11 @@ TACSAssembler::TACSAssembler(MPI_Comm _tacs_comm, int _varsPerNode,
   // Set the auxiliary element class to NULL
   auxElements = NULL;
 
+  // No body loads are set by default
+  bodyLoads = NULL;
+  numBodyLoadObjs = 0;
+  bodyLoadObjs = NULL;
+
   // Information for setting boundary conditions and distributing variables
   nodeMap = new TACSNodeMap(tacs_comm, numOwnedNodes);
   nodeMap->incref();
@@ -144,6 +199,18 @@ TACSAssembler::TACSAssembler(MPI_Comm _tacs_comm, int _varsPerNode,
   // parMat specific objects
   parMatIndices = NULL;
 
+  // The shared non-zero patterns
+  for (int i = 0; i < 2; i++) {
+    parMatPatterns[i] = NULL;
+  }
+  for (int i = 0; i < 4; i++) {
+    schurMatPatterns[i] = NULL;
+  }
+
+  // The stored node-to-node graph
+  nodeCSRRowp = NULL;
+  nodeCSRCols = NULL;
+
   // TACSSchurMat-specific objects
   schurBIndices = schurCIndices = NULL;
   schurBMap = schurCMap = NULL;
@@ -154,6 +221,7 @@ TACSAssembler::TACSAssembler(MPI_Comm _tacs_comm, int _varsPerNode,
 
   // Null out the dependent node data
   depNodes = NULL;
+  depNodeXptOffsets = NULL;
 
   // Design variable information
   designVarsPerNode = 1;
@@ -164,8 +232,12 @@ TACSAssembler::TACSAssembler(MPI_Comm _tacs_comm, int _varsPerNode,
   // Set the local element data to NULL
   elementData = NULL;
   elementIData = NULL;
+  depGatherPtr = depGatherVars = NULL;
+  depGatherWeights = NULL;
   elementSensData = NULL;
   elementSensIData = NULL;
+  elementDVPtr = elementDVNums = NULL;
+  elementDVVals = NULL;
 
   // Initial condition vectors
   vars0 = NULL;
@@ -179,8 +251,52 @@ TACSAssembler::TACSAssembler(MPI_Comm _tacs_comm, int _varsPerNode,
 TACSAssembler::~TACSAssembler() {
   TacsFinalize();
 
+  if (xptSensNodes) {
+    delete[] xptSensNodes;
+  }
+  if (xptSensElemFlags) {
+    delete[] xptSensElemFlags;
+  }
+  if (elementBCFlags) {
+    delete[] elementBCFlags;
+    delete[] ownedBCNodes;
+    delete[] ownedBCFlags;
+  }
+  if (elementTimes) {
+    delete[] elementTimes;
+  }
+
   pthread_mutex_destroy(&tacs_mutex);
   delete tacsPInfo;
+  if (elemSchedule) {
+    elemSchedule->decref();
+  }
+  if (elementCosts) {
+    delete[] elementCosts;
+  }
+  if (colorSchedules) {
+    for (int c = 0; c < numElementColors; c++) {
+      colorSchedules[c]->decref();
+    }
+    delete[] colorSchedules;
+  }
+  if (elementColorPtr) {
+    delete[] elementColorPtr;
+  }
+  if (elementColors) {
+    delete[] elementColors;
+  }
+  if (elementOrder) {
+    delete[] elementOrder;
+  }
+  if (elementRegistry) {
+    elementRegistry->decref();
+  }
+  if (elementKernels) {
+    delete[] elementKernels;
+  }
+  invalidateIncrementalJacobian();
+  setElementMatCache(0);
 
   // Go through and decref all the elements
   if (elements) {
@@ -221,12 +337,24 @@ TACSAssembler::~TACSAssembler() {
   if (depNodes) {
     depNodes->decref();
   }
+  if (depNodeXptOffsets) {
+    delete[] depNodeXptOffsets;
+  }
 
   // Decrease the reference count to the auxiliary elements
   if (auxElements) {
     auxElements->decref();
   }
 
+  // Decrease the reference count to the body loads
+  if (bodyLoads) {
+    for (int i = 0; i < numBodyLoadObjs; i++) {
+      bodyLoadObjs[i]->decref();
+    }
+    delete[] bodyLoads;
+    delete[] bodyLoadObjs;
+  }
+
   // Decrease the reference count to objects allocated in initialize
   if (nodeMap) {
     nodeMap->decref();
@@ -244,6 +372,18 @@ TACSAssembler::~TACSAssembler() {
     extDistIndices->decref();
   }
 
+  // Decrease the reference count to the design variable data, which
+  // may not have been created
+  if (designNodeMap) {
+    designNodeMap->decref();
+  }
+  if (designExtDist) {
+    designExtDist->decref();
+  }
+  if (designDepNodes) {
+    designDepNodes->decref();
+  }
+
   // Free the reordering if it has been used
   if (newNodeIndices) {
     newNodeIndices->decref();
@@ -254,6 +394,24 @@ TACSAssembler::~TACSAssembler() {
     parMatIndices->decref();
   }
 
+  // Free the shared non-zero patterns
+  for (int i = 0; i < 2; i++) {
+    if (parMatPatterns[i]) {
+      parMatPatterns[i]->decref();
+    }
+  }
+  for (int i = 0; i < 4; i++) {
+    if (schurMatPatterns[i]) {
+      schurMatPatterns[i]->decref();
+    }
+  }
+
+  // Free the stored node-to-node graph
+  if (nodeCSRRowp) {
+    delete[] nodeCSRRowp;
+    delete[] nodeCSRCols;
+  }
+
   // Decrease ref. count for the TACSSchurMat data if it is allocated
   if (schurBIndices) {
     schurBIndices->decref();
@@ -275,6 +433,16 @@ TACSAssembler::~TACSAssembler() {
   if (elementIData) {
     delete[] elementIData;
   }
+  if (depGatherPtr) {
+    delete[] depGatherPtr;
+    delete[] depGatherVars;
+    delete[] depGatherWeights;
+  }
+  if (elementDVPtr) {
+    delete[] elementDVPtr;
+    delete[] elementDVNums;
+    delete[] elementDVVals;
+  }
   if (elementSensData) {
     delete[] elementSensData;
   }
@@ -314,3955 +482,7041 @@ MPI_Comm TACSAssembler::getMPIComm() { return tacs_comm; }
 void TACSAssembler::setNumThreads(int t) { thread_info->setNumThreads(t); }
 
 /**
-   Return the thread information from the TACSAssembler object
-
-   @return the thread info object
+  Set the memory allocation policy for the vectors and matrices
+
+  With first-touch allocation, the owned entries of the vectors and
+  the values of the matrices are zeroed in parallel by the threads
+  that later operate on them, so that their pages are placed on the
+  NUMA domain of those threads. This only affects objects created
+  after this call, and should be set after the number of threads.
+  Huge-page allocation aligns the large arrays to 2 MB and requests
+  transparent huge pages for them where supported.
+
+  @param first_touch Flag to use parallel first-touch allocation
+  @param huge_pages Flag to use huge-page-backed allocation
 */
-TACSThreadInfo *TACSAssembler::getThreadInfo() { return thread_info; }
+void TACSAssembler::setMemoryPolicy(int first_touch, int huge_pages) {
+  thread_info->setMemoryPolicy(first_touch, huge_pages);
+}
 
 /**
-   Get the number of degrees of freedom per node
-
-   @return the number of degrees of freedom per node
-*/
-int TACSAssembler::getVarsPerNode() { return varsPerNode; }
+  Set the estimated relative cost of each element.
 
-/**
-   Get the number of design variables per "node"
+  The costs are used to split the elements into balanced blocks for
+  the threaded element loops. By default, the cost of each element is
+  estimated from the square of its number of variables. Passing NULL
+  restores the default estimate.
 
-   @return the number of design variables for each design "node"
+  @param costs The relative cost of each local element
 */
-int TACSAssembler::getDesignVarsPerNode() { return designVarsPerNode; }
-
-/**
-  Get the number of local nodes
+void TACSAssembler::setElementCosts(const double *costs) {
+  if (costs) {
+    if (!elementCosts) {
+      elementCosts = new double[numElements];
+    }
+    memcpy(elementCosts, costs, numElements * sizeof(double));
+  } else if (elementCosts) {
+    delete[] elementCosts;
+    elementCosts = NULL;
+  }
 
-  @return the number of local nodes defined on this processor
-*/
-int TACSAssembler::getNumNodes() { return numNodes; }
+  // Force the schedules to be re-computed with the new costs
+  if (elemSchedule) {
+    elemSchedule->decref();
+    elemSchedule = NULL;
+  }
+  if (colorSchedules) {
+    for (int c = 0; c < numElementColors; c++) {
+      colorSchedules[c]->decref();
+    }
+    delete[] colorSchedules;
+    colorSchedules = NULL;
+  }
+}
 
 /**
-  Get the number of dependent nodes
+  Set whether to use element coloring for the threaded assembly.
 
-  @return the number of dependent nodes defined on this processor
-*/
-int TACSAssembler::getNumDependentNodes() { return numDependentNodes; }
+  When coloring is used, the elements are split into groups (colors)
+  such that no two elements in the same group share an independent
+  node. The threads then assemble each color in turn and add the
+  element contributions to the residual and matrix without locking.
 
-/**
-  Get the number of owned local nodes
+  The coloring is computed with the same greedy algorithm used for
+  the MULTICOLOR_ORDER reordering the first time it is needed after
+  initialize() is called.
 
-  @return the number of locally owned nodes on this processor
+  @param flag Flag indicating whether to use element coloring
 */
-int TACSAssembler::getNumOwnedNodes() { return numOwnedNodes; }
+void TACSAssembler::setElementColoring(int flag) { useElementColoring = flag; }
 
 /**
-  Get the number of elements
+  Get the number of element colors used for threaded assembly
 
-  @return The number of elements defined on this processor
+  @return The number of colors or 0 if the coloring is not computed
 */
-int TACSAssembler::getNumElements() { return numElements; }
+int TACSAssembler::getNumElementColors() { return numElementColors; }
 
 /**
-  Get the node-processor assignment
-
-  @return The map that defines the nodal assignment to each processor
-*/
-TACSNodeMap *TACSAssembler::getNodeMap() { return nodeMap; }
+  Set the maximum number of elements evaluated in a single call to the
+  batched element kernels
 
-/**
-  Get the node-processor design variable assignment
+  Consecutive elements that share the same element object are passed
+  together to TACSElement::addResidualBatch() and
+  TACSElement::addJacobianBatch() during assembly. A batch size of 1
+  recovers the element-by-element assembly.
 
-  @return The map that defines the design variable assignment to each processor
+  @param size The maximum number of elements in a batch
 */
-TACSNodeMap *TACSAssembler::getDesignNodeMap() { return designNodeMap; }
+void TACSAssembler::setElementBatchSize(int size) {
+  if (size < 1) {
+    size = 1;
+  }
+  elementBatchSize = size;
+}
 
 /**
-  Get the boundary conditions
-
-  @return The boundary conditions (may be NULL)
-*/
-TACSBcMap *TACSAssembler::getBcMap() { return bcMap; }
+  Set the registry of element kernels specialized at compile time
 
-/**
-  Get the additional boundary conditions associated with the initial
-  conditions.
+  The kernel for each element is found from the exact type of its
+  element object. Consecutive elements whose element objects have the
+  same registered type are batched together, even if the element
+  objects differ, and are evaluated by the specialized kernel. The
+  other elements use TACSElement::addResidualBatch() and
+  TACSElement::addJacobianBatch(). Passing NULL removes the registry.
 
-  @return Initial boundary conditions (may be NULL)
+  @param registry The registry of element kernels
 */
-TACSBcMap *TACSAssembler::getInitBcMap() { return bcInitMap; }
+void TACSAssembler::setElementRegistry(TACSElementRegistry *registry) {
+  if (registry) {
+    registry->incref();
+  }
+  if (elementRegistry) {
+    elementRegistry->decref();
+  }
+  elementRegistry = registry;
+  if (elementKernels) {
+    delete[] elementKernels;
+    elementKernels = NULL;
+  }
+}
 
 /**
-  Get the vector distribution object
-
-  @return The object for distributing vector values
+  Set the order in which the residual and Jacobian loops visit the
+  elements
+
+  The input order of the elements, for instance from a BDF file, often
+  has little relation to the node numbering, so that consecutive
+  elements gather and scatter values that are far apart in memory.
+  NODE_ELEMENT_ORDER visits the elements in the order of their lowest
+  node number, which follows the node ordering computed by
+  computeReordering(). MORTON_ELEMENT_ORDER visits the elements in the
+  order of their centroids along a Morton (Z-order) space-filling
+  curve, computed from the nodes at the first assembly.
+
+  The element numbering seen by the user, the auxiliary elements and
+  the output is not changed: only the traversal order is permuted.
+  Elements that share the same element object are only batched when
+  they are adjacent in the traversal order.
+
+  @param order_type The element traversal order
 */
-TACSBVecDistribute *TACSAssembler::getBVecDistribute() { return extDist; }
-
-/**
-  Get the dependent node vectors
+void TACSAssembler::setElementOrder(ElementOrderType order_type) {
+  elementOrderType = order_type;
+  if (elementOrder) {
+    delete[] elementOrder;
+    elementOrder = NULL;
+  }
 
-  @return The object used to define the dependent node equations
-*/
-TACSBVecDepNodes *TACSAssembler::getBVecDepNodes() { return depNodes; }
+  // The schedule costs are stored in the traversal order
+  if (elemSchedule) {
+    elemSchedule->decref();
+    elemSchedule = NULL;
+  }
+}
 
 /**
-  Get the maximum number of nodes for an element
+  Set whether to compute an element scatter plan for new matrices
 
-  @return The maximum number of nodes for an element
-*/
-int TACSAssembler::getMaxElementNodes() { return maxElementNodes; }
+  When set, matrices created by createMat() store the location of
+  every block of each element matrix within the matrix data. This
+  removes all searches from the assembly of the element matrices at
+  the cost of nnodes^2 integers per element. The memory used can be
+  queried with TACSParallelMat::getElementScatterMemory(). The plan
+  is only used for meshes without dependent nodes.
 
-/**
-  Get the maximum number of element variables
+  @param flag Flag indicating whether to compute the scatter plan
+*/
+void TACSAssembler::setMatScatterPlan(int flag) { useMatScatterPlan = flag; }
 
-  @return The maximum number of variables for an element
+/*
+  Find the registered kernel for each element. The kernels are found
+  once the mesh is initialized, and are kept until the registry is
+  changed.
 */
-int TACSAssembler::getMaxElementVariables() { return maxElementSize; }
+void TACSAssembler::initElementKernels() {
+  if (elementKernels || !elementRegistry || !meshInitializedFlag) {
+    return;
+  }
 
-/**
-  Get the maximum number of design variables for an element
+  elementKernels = new int[numElements];
+  for (int i = 0; i < numElements; i++) {
+    // Elements often share element objects, so reuse the last result
+    if (i > 0 && elements[i] == elements[i - 1]) {
+      elementKernels[i] = elementKernels[i - 1];
+    } else {
+      elementKernels[i] = elementRegistry->findKernel(elements[i]);
+    }
+  }
+}
 
-  @return The maximum number of design variables for an element
-*/
-int TACSAssembler::getMaxElementDesignVars() { return maxElementDesignVars; }
+/*
+  Get the next batch of elements that share the same element object,
+  or the same registered kernel.
 
-/**
-  Get the array of elements from TACSAssembler
+  The elements are taken in order from the range [start, end) of the
+  element list, or from the natural element ordering if the list is
+  NULL. The batch is terminated when an element with a different
+  element object and kernel is found or the maximum batch size is
+  reached.
 
-  @return The array of element objects
-*/
-TACSElement **TACSAssembler::getElements() { return elements; }
+  input:
+  elemList:     the list of elements (may be NULL)
+  start, end:   the range of entries in the list
 
-/**
-  Get the element object and the corresponding element variables
+  output:
+  elemIndices:  the element indices in the batch
 
-  @param index The element index
-  @param Xpts The element nodes array (may be NULL)
-  @param vars The element variable array (may be NULL)
-  @param dvars The element variable time derivative array (may be NULL)
-  @param dvars The element variable time derivative array (may be NULL)
-  @return The element object (NULL if index is out of range)
+  returns:      the number of elements in the batch
 */
-TACSElement *TACSAssembler::getElement(int index, TacsScalar *Xpts,
-                                       TacsScalar *vars, TacsScalar *dvars,
-                                       TacsScalar *ddvars) {
-  if (elements && xptVec && (index >= 0 && index < numElements)) {
-    int ptr = elementNodeIndex[index];
-    int len = elementNodeIndex[index + 1] - ptr;
-    const int *nodes = &elementTacsNodes[ptr];
-    if (Xpts) {
-      xptVec->getValues(len, nodes, Xpts);
-    }
-    if (vars) {
-      varsVec->getValues(len, nodes, vars);
-    }
-    if (dvars) {
-      dvarsVec->getValues(len, nodes, dvars);
-    }
-    if (ddvars) {
-      ddvarsVec->getValues(len, nodes, ddvars);
+int TACSAssembler::getElementBatch(const int *elemList, int start, int end,
+                                   int *elemIndices) {
+  elemIndices[0] = (elemList ? elemList[start] : start);
+  TACSElement *element = elements[elemIndices[0]];
+  int kernel = (elementKernels ? elementKernels[elemIndices[0]] : -1);
+
+  int n = 1;
+  for (int k = start + 1; k < end && n < elementBatchSize; k++, n++) {
+    int elemIndex = (elemList ? elemList[k] : k);
+    if (elements[elemIndex] != element &&
+        (kernel < 0 || elementKernels[elemIndex] != kernel)) {
+      break;
     }
-
-    return elements[index];
+    elemIndices[n] = elemIndex;
   }
 
-  return NULL;
+  return n;
 }
 
-/**
-  Get the element object and the pointer to the node numbers
+/*
+  Compute the element coloring.
 
-  @param index The element index
-  @param nodes The global node numbers
-  @param len The number of nodes for this element
-  @return The element object (NULL if index is out of range)
+  Two elements are adjacent if they share an independent node (either
+  directly or through a dependent node). The greedy multicolor
+  algorithm is applied to the element adjacency graph and the
+  elements are sorted by color, in increasing order within each color.
 */
-TACSElement *TACSAssembler::getElement(int index, int *len, const int **nodes) {
-  if (elements && (index >= 0 && index < numElements)) {
-    int ptr = elementNodeIndex[index];
-    if (len) {
-      *len = elementNodeIndex[index + 1] - ptr;
-    }
-    if (nodes) {
-      *nodes = &elementTacsNodes[ptr];
-    }
-    return elements[index];
+void TACSAssembler::computeElementColoring() {
+  // Get the node to element connectivity, including the independent
+  // nodes for each dependent node
+  int *nodeElementPtr, *nodeToElements;
+  computeNodeToElementCSR(&nodeElementPtr, &nodeToElements);
+
+  const int *depNodePtr = NULL;
+  const int *depNodeConn = NULL;
+  if (depNodes) {
+    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
   }
 
-  if (len) {
-    *len = 0;
+  // Count up the size of the element to element graph
+  int *rowp = new int[numElements + 1];
+  rowp[0] = 0;
+  for (int i = 0; i < numElements; i++) {
+    int count = 0;
+    for (int jp = elementNodeIndex[i]; jp < elementNodeIndex[i + 1]; jp++) {
+      int node = elementTacsNodes[jp];
+      if (node >= 0) {
+        node = getLocalNodeNum(node);
+        count += nodeElementPtr[node + 1] - nodeElementPtr[node];
+      } else {
+        int dep = -node - 1;
+        for (int kp = depNodePtr[dep]; kp < depNodePtr[dep + 1]; kp++) {
+          node = getLocalNodeNum(depNodeConn[kp]);
+          count += nodeElementPtr[node + 1] - nodeElementPtr[node];
+        }
+      }
+    }
+    rowp[i + 1] = rowp[i] + count;
   }
-  if (nodes) {
-    *nodes = NULL;
+
+  // Fill in the element adjacency
+  int *cols = new int[rowp[numElements]];
+  for (int i = 0; i < numElements; i++) {
+    int *c = &cols[rowp[i]];
+    for (int jp = elementNodeIndex[i]; jp < elementNodeIndex[i + 1]; jp++) {
+      int node = elementTacsNodes[jp];
+      if (node >= 0) {
+        node = getLocalNodeNum(node);
+        for (int kp = nodeElementPtr[node]; kp < nodeElementPtr[node + 1];
+             kp++) {
+          c[0] = nodeToElements[kp];
+          c++;
+        }
+      } else {
+        int dep = -node - 1;
+        for (int kp = depNodePtr[dep]; kp < depNodePtr[dep + 1]; kp++) {
+          node = getLocalNodeNum(depNodeConn[kp]);
+          for (int lp = nodeElementPtr[node]; lp < nodeElementPtr[node + 1];
+               lp++) {
+            c[0] = nodeToElements[lp];
+            c++;
+          }
+        }
+      }
+    }
   }
-  return NULL;
-}
+  delete[] nodeElementPtr;
+  delete[] nodeToElements;
 
-/**
-  Set the element connectivity.
+  TacsSortAndUniquifyCSR(numElements, rowp, cols);
 
-  Note that the number of elements that are set at this stage must be
-  consistent with the number of elements passed in when TACSAssembler
-  is created.  (The connectivity arrays are copied and should be freed
-  by the caller.)
+  // Compute the coloring
+  int *colors = new int[numElements];
+  int *new_elems = new int[numElements];
+  numElementColors =
+      TacsComputeSerialMultiColor(numElements, rowp, cols, colors, new_elems);
+  delete[] rowp;
+  delete[] cols;
 
-  @param ptr Offset into the connectivity array for this processor
-  @param conn The connectivity from elements to global node index
-  @return Fail flag indicating if a failure occured
-*/
-int TACSAssembler::setElementConnectivity(const int *ptr, const int *conn) {
-  if (meshInitializedFlag) {
-    fprintf(stderr,
-            "[%d] Cannot call setElementConnectivity() after initialize()\n",
-            mpiRank);
-    return 1;
+  // Sort the elements by color
+  if (elementColorPtr) {
+    delete[] elementColorPtr;
   }
-  if (tacsExtNodeNums) {
-    fprintf(stderr,
-            "[%d] Cannot call setElementConnectivity() after reordering\n",
-            mpiRank);
-    return 1;
+  if (elementColors) {
+    delete[] elementColors;
   }
-
-  // Free the data if it has already been set before
-  if (elementTacsNodes) {
-    delete[] elementTacsNodes;
+  elementColorPtr = new int[numElementColors + 1];
+  elementColors = new int[numElements];
+  memset(elementColorPtr, 0, (numElementColors + 1) * sizeof(int));
+  for (int i = 0; i < numElements; i++) {
+    elementColorPtr[colors[i] + 1]++;
+    elementColors[new_elems[i]] = i;
   }
-  if (elementNodeIndex) {
-    delete[] elementNodeIndex;
+  for (int c = 0; c < numElementColors; c++) {
+    elementColorPtr[c + 1] += elementColorPtr[c];
   }
 
-  int size = ptr[numElements];
-  elementNodeIndex = new int[numElements + 1];
-  elementTacsNodes = new int[size];
-  memcpy(elementNodeIndex, ptr, (numElements + 1) * sizeof(int));
+  delete[] colors;
+  delete[] new_elems;
+}
 
-  // Copy the node numbers
-  memcpy(elementTacsNodes, conn, size * sizeof(int));
+/*
+  The key used to sort the elements into the traversal order
+*/
+struct TacsElementOrderKey {
+  uint64_t key;
+  int index;
+};
+
+static int TacsCompareElementOrderKeys(const void *a, const void *b) {
+  const TacsElementOrderKey *ka = static_cast<const TacsElementOrderKey *>(a);
+  const TacsElementOrderKey *kb = static_cast<const TacsElementOrderKey *>(b);
+  if (ka->key != kb->key) {
+    return (ka->key < kb->key ? -1 : 1);
+  }
+  return ka->index - kb->index;
+}
 
-  // If the elements are set, check the connectivity
-  if (elements) {
+/*
+  Spread the lower 21 bits of the input so that there are two zero
+  bits between each bit, for interleaving three coordinates
+*/
+static inline uint64_t TacsSpreadMortonBits(uint64_t x) {
+  x &= 0x1fffff;
+  x = (x | (x << 32)) & 0x1f00000000ffffULL;
+  x = (x | (x << 16)) & 0x1f0000ff0000ffULL;
+  x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+  x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+  x = (x | (x << 2)) & 0x1249249249249249ULL;
+  return x;
+}
+
+/*
+  Compute the element traversal order selected by setElementOrder().
+  The order is computed once the mesh is initialized, and is kept
+  until the order type is changed.
+*/
+void TACSAssembler::initElementOrder() {
+  if (elementOrder || elementOrderType == NATURAL_ELEMENT_ORDER ||
+      !meshInitializedFlag || numElements == 0) {
+    return;
+  }
+
+  TacsElementOrderKey *keys = new TacsElementOrderKey[numElements];
+  if (elementOrderType == NODE_ELEMENT_ORDER) {
     for (int i = 0; i < numElements; i++) {
-      int size = elementNodeIndex[i + 1] - elementNodeIndex[i];
-      if (size != elements[i]->getNumNodes()) {
-        fprintf(stderr,
-                "[%d] TACSAssembler: Element %s does not match "
-                " connectivity\n",
-                mpiRank, elements[i]->getObjectName());
-        return 1;
+      // Find the lowest independent node of the element
+      int node = -1;
+      for (int j = elementNodeIndex[i]; j < elementNodeIndex[i + 1]; j++) {
+        if (elementTacsNodes[j] >= 0 &&
+            (node < 0 || elementTacsNodes[j] < node)) {
+          node = elementTacsNodes[j];
+        }
       }
+      keys[i].key = (node >= 0 ? node : 0);
+      keys[i].index = i;
     }
-  }
-
-  // Check that the node numbers are all within range and that the
-  // dependent node numbers (if any) are in range
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+  } else {
+    // Compute the element centroids and their bounding box
+    double *centroids = new double[3 * numElements];
+    TacsScalar *elemXpts = new TacsScalar[3 * maxElementNodes];
+    double xmin[3], xmax[3];
+    for (int k = 0; k < 3; k++) {
+      xmin[k] = 1e300;
+      xmax[k] = -1e300;
+    }
+    for (int i = 0; i < numElements; i++) {
+      int ptr = elementNodeIndex[i];
+      int len = elementNodeIndex[i + 1] - ptr;
+      xptVec->getValues(len, &elementTacsNodes[ptr], elemXpts);
 
-  for (int i = 0; i < numElements; i++) {
-    int jend = elementNodeIndex[i + 1];
-    for (int j = elementNodeIndex[i]; j < jend; j++) {
-      if (elementTacsNodes[j] >= ownerRange[mpiSize]) {
-        fprintf(stderr,
-                "[%d] TACSAssembler: Element %d contains node number "
-                "out of range\n",
-                mpiRank, i);
-        return -1;
-      } else if (elementTacsNodes[j] < -numDependentNodes) {
-        fprintf(stderr,
-                "[%d] TACSAssembler: Element %d contains dependent "
-                "node number out of range\n",
-                mpiRank, i);
-        return -1;
+      double *c = &centroids[3 * i];
+      c[0] = c[1] = c[2] = 0.0;
+      for (int j = 0; j < len; j++) {
+        for (int k = 0; k < 3; k++) {
+          c[k] += TacsRealPart(elemXpts[3 * j + k]);
+        }
+      }
+      for (int k = 0; k < 3; k++) {
+        if (len > 0) {
+          c[k] /= len;
+        }
+        xmin[k] = (c[k] < xmin[k] ? c[k] : xmin[k]);
+        xmax[k] = (c[k] > xmax[k] ? c[k] : xmax[k]);
       }
     }
-  }
-  return 0;
-}
-
-/**
-  Get the element connectivity.
 
-  @param ptr Offset into the connectivity array for this processor
-  @param conn The connectivity from elements to global node index
-*/
-void TACSAssembler::getElementConnectivity(const int **ptr, const int **conn) {
-  if (!meshInitializedFlag) {
-    fprintf(stderr,
-            "[%d] Cannot call getElementConnectivity() before initialize()\n",
-            mpiRank);
-    if (ptr) {
-      *ptr = NULL;
-    }
-    if (conn) {
-      *conn = NULL;
+    // Quantize the centroids on a 2^21 grid and interleave the bits
+    const double nbins = 2097151.0;
+    for (int i = 0; i < numElements; i++) {
+      uint64_t key = 0;
+      for (int k = 0; k < 3; k++) {
+        uint64_t q = 0;
+        if (xmax[k] > xmin[k]) {
+          q = (uint64_t)(nbins * (centroids[3 * i + k] - xmin[k]) /
+                         (xmax[k] - xmin[k]));
+        }
+        key |= TacsSpreadMortonBits(q) << k;
+      }
+      keys[i].key = key;
+      keys[i].index = i;
     }
-    return;
-  }
 
-  // Free the data if it has already been set before
-  if (ptr) {
-    *ptr = elementNodeIndex;
-  }
-  if (conn) {
-    *conn = elementTacsNodes;
+    delete[] centroids;
+    delete[] elemXpts;
   }
-}
 
-/**
-  Set the element array within TACS.
+  qsort(keys, numElements, sizeof(TacsElementOrderKey),
+        TacsCompareElementOrderKeys);
 
-  The number of element pointers provided should be equal to the
-  number of elements specified in the TACSAssembler constructor.  Note
-  that the elements themselves are not copied, just the pointers to
-  them.
+  elementOrder = new int[numElements];
+  for (int i = 0; i < numElements; i++) {
+    elementOrder[i] = keys[i].index;
+  }
+  delete[] keys;
+}
 
-  @param elements The array of element pointers with length = numElements.
-  @return Fail flag indicating if a failure occured
+/*
+  Prepare the work-stealing element schedule for a threaded element
+  loop. The schedule is only re-computed when the number of threads
+  changes or the element costs are modified.
 */
-int TACSAssembler::setElements(TACSElement **_elements) {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call setElements() after initialize()\n",
-            mpiRank);
-    return 1;
+void TACSAssembler::initElementSchedule() {
+  int nthreads = thread_info->getNumThreads();
+  if (elemSchedule && (elemSchedule->getNumThreads() != nthreads ||
+                       elemSchedule->getSize() != numElements)) {
+    elemSchedule->decref();
+    elemSchedule = NULL;
+  }
+
+  if (!elemSchedule) {
+    // Set the cost of each element in the traversal order, estimating
+    // the cost from the size of the element matrix if it is not set
+    double *costs = new double[numElements];
+    for (int k = 0; k < numElements; k++) {
+      int i = (elementOrder ? elementOrder[k] : k);
+      if (elementCosts) {
+        costs[k] = elementCosts[i];
+      } else {
+        double nvars = 1.0;
+        if (elements && elements[i]) {
+          nvars += elements[i]->getNumVariables();
+        }
+        costs[k] = nvars * nvars;
+      }
+    }
+    elemSchedule = new TACSThreadSchedule(numElements, nthreads, costs);
+    elemSchedule->incref();
+    delete[] costs;
   }
 
-  // Check if the number of variables per node matches
-  for (int i = 0; i < numElements; i++) {
-    if (_elements[i]->getVarsPerNode() != varsPerNode) {
-      fprintf(stderr,
-              "[%d] TACSAssembler: Element %s, num displacements %d "
-              "does not match variables per node %d\n",
-              mpiRank, _elements[i]->getObjectName(),
-              _elements[i]->getVarsPerNode(), varsPerNode);
-      return 1;
+  elemSchedule->reset();
+
+  // Set up the schedules for each element color
+  if (useElementColoring && meshInitializedFlag) {
+    if (!elementColors) {
+      computeElementColoring();
     }
-  }
 
-  // Copy over the element pointers into a local array
-  if (elements) {
-    for (int i = 0; i < numElements; i++) {
-      _elements[i]->incref();
-      if (elements[i]) {
-        elements[i]->decref();
+    if (colorSchedules &&
+        colorSchedules[0]->getNumThreads() != nthreads) {
+      for (int c = 0; c < numElementColors; c++) {
+        colorSchedules[c]->decref();
       }
-      elements[i] = _elements[i];
+      delete[] colorSchedules;
+      colorSchedules = NULL;
+    }
+
+    if (!colorSchedules) {
+      colorSchedules = new TACSThreadSchedule *[numElementColors];
+      double *costs = new double[numElements];
+      for (int c = 0; c < numElementColors; c++) {
+        int size = elementColorPtr[c + 1] - elementColorPtr[c];
+        const int *elems = &elementColors[elementColorPtr[c]];
+        for (int k = 0; k < size; k++) {
+          if (elementCosts) {
+            costs[k] = elementCosts[elems[k]];
+          } else {
+            double nvars = 1.0 + elements[elems[k]]->getNumVariables();
+            costs[k] = nvars * nvars;
+          }
+        }
+        colorSchedules[c] = new TACSThreadSchedule(size, nthreads, costs);
+        colorSchedules[c]->incref();
+      }
+      delete[] costs;
     }
+  }
+}
+
+/*
+  Execute a threaded element loop.
+
+  When element coloring is active, the threads are run once for each
+  color and the color is passed to the thread function through the
+  thread info object. Otherwise, the threads are run once over all of
+  the elements.
+*/
+void TACSAssembler::runElementThreads(void *(*func)(void *)) {
+  if (useElementColoring && colorSchedules) {
+    for (int c = 0; c < numElementColors; c++) {
+      tacsPInfo->color = c;
+      colorSchedules[c]->reset();
+      thread_info->runThreads(func, (void *)tacsPInfo);
+    }
+    tacsPInfo->color = -1;
   } else {
-    elements = new TACSElement *[numElements];
-    memset(elements, 0, numElements * sizeof(TACSElement *));
-    for (int i = 0; i < numElements; i++) {
-      _elements[i]->incref();
-      elements[i] = _elements[i];
-    }
+    tacsPInfo->color = -1;
+    thread_info->runThreads(func, (void *)tacsPInfo);
   }
+}
 
-  // Keep track of the number of multiplier nodes
-  numMultiplierNodes = 0;
+/*
+  Create the schedule for a threaded loop over the function domain.
 
-  // Determine the maximum number of nodes per element
-  maxElementDesignVars = 0;
-  maxElementSize = 0;
-  maxElementNodes = 0;
+  For functions defined over the entire domain, this returns the
+  element schedule. For functions defined on a sub-domain, a new
+  schedule is created for the list of elements in the domain. The
+  returned schedule must be decref'd by the caller.
 
-  for (int i = 0; i < numElements; i++) {
-    // Determine if the maximum number of variables and nodes needs to
-    // be changed
-    int elemSize = elements[i]->getNumVariables();
-    if (elemSize > maxElementSize) {
-      maxElementSize = elemSize;
-    }
+  @param func The function
+  @param elemNums The element numbers in the domain (NULL for all)
+  @return The schedule for the function domain
+*/
+TACSThreadSchedule *TACSAssembler::createFunctionSchedule(
+    TACSFunction *func, const int **elemNums) {
+  TACSThreadSchedule *sched = NULL;
+  *elemNums = NULL;
+  if (func->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
+    initElementSchedule();
+    sched = elemSchedule;
+  } else if (func->getDomainType() == TACSFunction::SUB_DOMAIN) {
+    int size = func->getElementNums(elemNums);
+    sched = new TACSThreadSchedule(size, thread_info->getNumThreads());
+  }
+
+  if (sched) {
+    sched->incref();
+  }
+  return sched;
+}
 
-    elemSize = elements[i]->getNumNodes();
-    if (elemSize > maxElementNodes) {
-      maxElementNodes = elemSize;
-    }
+/*
+  Create the list of functions whose domain includes each element.
 
-    // Count up the multiplier nodes
-    int multiplier = elements[i]->getMultiplierIndex();
-    if (multiplier > 0) {
-      numMultiplierNodes++;
-    }
+  The functions for element i are stored in
+  elemFuncs[elemFuncPtr[i]:elemFuncPtr[i+1]] as indices into the funcs
+  array, in ascending order. A function appears once for each time the
+  element occurs in its domain. NULL entries and functions without a
+  domain are skipped. This allows all the functions to be evaluated in
+  a single pass over the elements, with the element data retrieved
+  only once for each element.
 
-    // Keep track of the maximum number of element design variables
-    int numDVs = elements[i]->getDesignVarNums(i, 0, NULL);
-    if (numDVs > maxElementDesignVars) {
-      maxElementDesignVars = numDVs;
+  @param numFuncs The number of functions
+  @param funcs The array of functions (entries may be NULL)
+  @param elemFuncs The function indices for each element (output)
+  @return The pointer into elemFuncs for each element
+*/
+int *TACSAssembler::createElementFunctionList(int numFuncs,
+                                              TACSFunction **funcs,
+                                              int **elemFuncs) {
+  int *elemFuncPtr = new int[numElements + 1];
+  memset(elemFuncPtr, 0, (numElements + 1) * sizeof(int));
+
+  // Count the number of functions for each element
+  for (int k = 0; k < numFuncs; k++) {
+    if (!funcs[k]) {
+      continue;
+    }
+    if (funcs[k]->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
+      for (int i = 0; i < numElements; i++) {
+        elemFuncPtr[i + 1]++;
+      }
+    } else if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
+      const int *elemNums;
+      int size = funcs[k]->getElementNums(&elemNums);
+      for (int j = 0; j < size; j++) {
+        if (elemNums[j] >= 0 && elemNums[j] < numElements) {
+          elemFuncPtr[elemNums[j] + 1]++;
+        }
+      }
     }
   }
+  for (int i = 0; i < numElements; i++) {
+    elemFuncPtr[i + 1] += elemFuncPtr[i];
+  }
 
-  // If the connectivity is set, determine if it is consistent
-  if (elementNodeIndex) {
-    for (int i = 0; i < numElements; i++) {
-      int size = elementNodeIndex[i + 1] - elementNodeIndex[i];
-      if (size != elements[i]->getNumNodes()) {
-        fprintf(stderr,
-                "[%d] TACSAssembler: Element %s does not match "
-                "connectivity\n",
-                mpiRank, elements[i]->getObjectName());
-        return 1;
+  // Fill in the function indices. The functions are visited in order,
+  // so the indices for each element are sorted.
+  int *funcs_list = new int[elemFuncPtr[numElements]];
+  for (int k = 0; k < numFuncs; k++) {
+    if (!funcs[k]) {
+      continue;
+    }
+    if (funcs[k]->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
+      for (int i = 0; i < numElements; i++) {
+        funcs_list[elemFuncPtr[i]] = k;
+        elemFuncPtr[i]++;
+      }
+    } else if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
+      const int *elemNums;
+      int size = funcs[k]->getElementNums(&elemNums);
+      for (int j = 0; j < size; j++) {
+        int i = elemNums[j];
+        if (i >= 0 && i < numElements) {
+          funcs_list[elemFuncPtr[i]] = k;
+          elemFuncPtr[i]++;
+        }
       }
     }
   }
 
-  return 0;
+  // Reset the pointer array
+  for (int i = numElements; i > 0; i--) {
+    elemFuncPtr[i] = elemFuncPtr[i - 1];
+  }
+  elemFuncPtr[0] = 0;
+
+  *elemFuncs = funcs_list;
+  return elemFuncPtr;
 }
 
-/**
-  Set the dependent node data structure
+/*
+  Create the vectors used to accumulate element contributions on
+  each thread.
 
-  The dependent nodes are designated by a negative index with a 1-base
-  numbering scheme. This dependent node data structure is a sparse
-  matrix with constant weights that designates the weights applied to
-  the global independent nodes (storred in depNodeToTacs).
+  The first thread adds its contributions directly to the input
+  vectors. The remaining threads use separate vectors with the same
+  layout so that no lock is required. The vectors for thread t are
+  stored at threadVecs[nvecs*t].
 
-  @param depNodePtr Offset into the connectivity/weight arrays
-  @param depNodeToTacs The independent global nodes
-  @param depNodeWeights The weight applied to each independent node
-  @return Fail flag indicating if a failure occured
+  @param nvecs The number of vectors
+  @param vecs The vectors to add the contributions to
+  @return The array of vectors for each thread
 */
-int TACSAssembler::setDependentNodes(const int *_depNodePtr,
-                                     const int *_depNodeToTacs,
-                                     const double *_depNodeWeights) {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call setDependentNodes() after initialize()\n",
-            mpiRank);
-    return 1;
+TACSBVec **TACSAssembler::createThreadVecs(int nvecs, TACSBVec **vecs) {
+  int nthreads = thread_info->getNumThreads();
+  TACSBVec **threadVecs = new TACSBVec *[nthreads * nvecs];
+  for (int k = 0; k < nvecs; k++) {
+    threadVecs[k] = vecs[k];
+    threadVecs[k]->incref();
   }
-  if (tacsExtNodeNums) {
-    fprintf(stderr, "[%d] Cannot call setDependentNodes() after reordering\n",
-            mpiRank);
-    return 1;
+  for (int t = 1; t < nthreads; t++) {
+    for (int k = 0; k < nvecs; k++) {
+      TACSBVec *vec = vecs[k];
+      threadVecs[nvecs * t + k] =
+          new TACSBVec(vec->getNodeMap(), vec->getBlockSize(),
+                       vec->getBVecDistribute(), vec->getBVecDepNodes());
+      threadVecs[nvecs * t + k]->incref();
+    }
   }
 
-  // Free the data if the dependent nodes have already been set
-  if (depNodes) {
-    depNodes->decref();
-  }
+  return threadVecs;
+}
 
-  // Get the ownership range of the nodes
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+/*
+  Add the contributions accumulated on each thread to the vectors of
+  the first thread and free the thread vectors.
 
-  // Check that all the independent nodes are positive and are within an
-  // allowable range
-  for (int i = 0; i < numDependentNodes; i++) {
-    for (int jp = _depNodePtr[i]; jp < _depNodePtr[i + 1]; jp++) {
-      if (_depNodeToTacs[jp] >= ownerRange[mpiSize]) {
-        fprintf(stderr,
-                "[%d] Dependent node %d contains node number %d out of range\n",
-                mpiRank, i, _depNodeToTacs[jp]);
-        return 1;
-      } else if (_depNodeToTacs[jp] < 0) {
-        fprintf(stderr, "[%d] Dependent node %d contains dependent node %d\n",
-                mpiRank, i, _depNodeToTacs[jp]);
-        return 1;
+  The locally owned, external and dependent parts of the vectors are
+  all added so that the result is the same as if the contributions
+  were added to the first vector directly.
+
+  @param nvecs The number of vectors
+  @param threadVecs The array of vectors for each thread
+*/
+void TACSAssembler::addThreadVecs(int nvecs, TACSBVec **threadVecs) {
+  int nthreads = thread_info->getNumThreads();
+  for (int t = 1; t < nthreads; t++) {
+    for (int k = 0; k < nvecs; k++) {
+      TACSBVec *vec = threadVecs[k];
+      TACSBVec *tvec = threadVecs[nvecs * t + k];
+
+      TacsScalar *x, *y;
+      int size = vec->getArray(&y);
+      tvec->getArray(&x);
+      for (int i = 0; i < size; i++) {
+        y[i] += x[i];
+      }
+
+      size = vec->getExtArray(&y);
+      tvec->getExtArray(&x);
+      for (int i = 0; i < size; i++) {
+        y[i] += x[i];
       }
+
+      size = vec->getDepArray(&y);
+      tvec->getDepArray(&x);
+      for (int i = 0; i < size; i++) {
+        y[i] += x[i];
+      }
+
+      tvec->decref();
     }
   }
-
-  if (numDependentNodes > 0) {
-    // Allocate the new memory and copy over the data
-    int *depNodePtr = new int[numDependentNodes + 1];
-    memcpy(depNodePtr, _depNodePtr, (numDependentNodes + 1) * sizeof(int));
-
-    int size = depNodePtr[numDependentNodes];
-    int *depNodeToTacs = new int[size];
-    memcpy(depNodeToTacs, _depNodeToTacs, size * sizeof(int));
-
-    double *depNodeWeights = new double[size];
-    memcpy(depNodeWeights, _depNodeWeights, size * sizeof(double));
-
-    // Allocate the dependent node data structure
-    depNodes = new TACSBVecDepNodes(numDependentNodes, &depNodePtr,
-                                    &depNodeToTacs, &depNodeWeights);
-    depNodes->incref();
+  for (int k = 0; k < nvecs; k++) {
+    threadVecs[k]->decref();
   }
-
-  return 0;
+  delete[] threadVecs;
 }
 
 /**
-  Add Dirichlet boundary conditions.
+   Return the thread information from the TACSAssembler object
 
-  These BCs are added to an object that will be associated with the
-  vectors/matrices that are created using TACSAssembler.
+   @return the thread info object
+*/
+TACSThreadInfo *TACSAssembler::getThreadInfo() { return thread_info; }
 
-  Fully-fixed boundary conditions can be specified by passing in
-  nbcs < 0. If the vals array is NULL, then it is assumed that all values
-  are fixed to zero.
+/**
+   Get the number of degrees of freedom per node
 
-  @param nnodes The number of nodes
-  @param nodes The node numbers
-  @param nbcs The number of nodal variables to be constrained
-  @param vars The variable indices satisfying (0 <= vars[i] < varsPerNode)
-  @param vals The boundary condition values
+   @return the number of degrees of freedom per node
 */
-void TACSAssembler::addBCs(int nnodes, const int *nodes, int nbcs,
-                           const int *vars, const TacsScalar *vals) {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call addBC() after initialize()\n", mpiRank);
-    return;
-  }
-
-  // Adjust the input to the addBC call. If no vars are specified,
-  // set the number of boundary conditions equal to the number of
-  // variables per node
-  if (!vars || (nbcs < 0)) {
-    nbcs = varsPerNode;
-  }
+int TACSAssembler::getVarsPerNode() { return varsPerNode; }
 
-  // Get the ownership range
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+/**
+   Get the number of design variables per "node"
 
-  // Add all the boundary conditions within the specified owner range
-  for (int i = 0; i < nnodes; i++) {
-    if (nodes[i] >= ownerRange[mpiRank] && nodes[i] < ownerRange[mpiRank + 1]) {
-      bcMap->addBC(nodes[i], nbcs, vars, vals);
-    }
-  }
-}
+   @return the number of design variables for each design "node"
+*/
+int TACSAssembler::getDesignVarsPerNode() { return designVarsPerNode; }
 
 /**
-  Add Dirichlet boundary conditions for the initial conditions.
+  Get the number of local nodes
 
-  These BCs are added to an object that will be associated with the
-  vectors/matrices that are created using TACSAssembler.
+  @return the number of local nodes defined on this processor
+*/
+int TACSAssembler::getNumNodes() { return numNodes; }
 
-  Fully-fixed boundary conditions can be specified by passing in
-  nbcs < 0. If the vals array is NULL, then it is assumed that all values
-  are fixed to zero.
+/**
+  Get the number of dependent nodes
 
-  @param nnodes The number of nodes
-  @param nodes The node numbers
-  @param nbcs The number of nodal variables to be constrained
-  @param vars The variable indices satisfying (0 <= vars[i] < varsPerNode)
-  @param vals The boundary condition values
+  @return the number of dependent nodes defined on this processor
 */
-void TACSAssembler::addInitBCs(int nnodes, const int *nodes, int nbcs,
-                               const int *vars, const TacsScalar *vals) {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call addInitBC() after initialize()\n",
-            mpiRank);
-    return;
-  }
-
-  // Adjust the input to the addBC call. If no vars are specified,
-  // set the number of boundary conditions equal to the number of
-  // variables per node
-  if (!vars || (nbcs < 0)) {
-    nbcs = varsPerNode;
-  }
+int TACSAssembler::getNumDependentNodes() { return numDependentNodes; }
 
-  // Get the ownership range
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+/**
+  Get the number of owned local nodes
 
-  // Add all the boundary conditions within the specified owner range
-  for (int i = 0; i < nnodes; i++) {
-    if (nodes[i] >= ownerRange[mpiRank] && nodes[i] < ownerRange[mpiRank + 1]) {
-      bcInitMap->addBC(nodes[i], nbcs, vars, vals);
-    }
-  }
-}
+  @return the number of locally owned nodes on this processor
+*/
+int TACSAssembler::getNumOwnedNodes() { return numOwnedNodes; }
 
 /**
-  Set new Dirichlet BC values at nodes where BCs are imposed
-
-  This takes the new boundary condition values as the entries in the
-  given vector where the Dirichlet boundary conditions are imposed.
+  Get the number of elements
 
-  @param vec The vector containing the new boundary condition values
+  @return The number of elements defined on this processor
 */
-void TACSAssembler::setBCValuesFromVec(TACSBVec *vec) {
-  TacsScalar *xvals = NULL;
-  vec->getArray(&xvals);
-
-  // Get the values from the boundary condition arrays
-  const int *nodes, *vars;
-  TacsScalar *values;
-  int nbcs = bcMap->getBCs(&nodes, &vars, &values);
+int TACSAssembler::getNumElements() { return numElements; }
 
-  // Get the ownership range
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+/**
+  Get the node-processor assignment
 
-  for (int i = 0; i < nbcs; i++) {
-    if (nodes[i] >= ownerRange[mpiRank] && nodes[i] < ownerRange[mpiRank + 1]) {
-      int var = varsPerNode * (nodes[i] - ownerRange[mpiRank]);
-      for (int k = 0; k < varsPerNode; k++) {
-        if (vars[i] & (1 << k)) {
-          // Scan through the rows to be zeroed
-          values[varsPerNode * i + k] = xvals[var + k];
-        }
-      }
-    }
-  }
-}
+  @return The map that defines the nodal assignment to each processor
+*/
+TACSNodeMap *TACSAssembler::getNodeMap() { return nodeMap; }
 
 /**
-  Create a global vector of node locations.
-
-  Note that the nodal coordinates are not set into the vector.
+  Get the node-processor design variable assignment
 
-  @return A new vector for spatial coordinates
+  @return The map that defines the design variable assignment to each processor
 */
-TACSBVec *TACSAssembler::createNodeVec() {
-  return new TACSBVec(nodeMap, TACS_SPATIAL_DIM, extDist, depNodes);
+TACSNodeMap *TACSAssembler::getDesignNodeMap() {
+  initDesignNodeMap();
+  return designNodeMap;
 }
 
 /**
-  Set the nodal locations from the input vector
+  Get the boundary conditions
 
-  @param X The nodal coordinate vector
+  @return The boundary conditions (may be NULL)
 */
-void TACSAssembler::setNodes(TACSBVec *X) {
-  xptVec->copyValues(X);
-
-  // Distribute the values at this point
-  xptVec->beginDistributeValues();
-  xptVec->endDistributeValues();
-}
+TACSBcMap *TACSAssembler::getBcMap() { return bcMap; }
 
 /**
-  Get the node locations from TACS
+  Get the additional boundary conditions associated with the initial
+  conditions.
 
-  @param X The nodal coordinates are copied into this vector
+  @return Initial boundary conditions (may be NULL)
 */
-void TACSAssembler::getNodes(TACSBVec *X) {
-  if (X) {
-    X->copyValues(xptVec);
-  }
-}
+TACSBcMap *TACSAssembler::getInitBcMap() { return bcInitMap; }
 
 /**
-  Get a pointer to the internal nodal coordinate vector
+  Get the vector distribution object
 
-  @param X A pointer to the nodal coordinate vector used by this Assembler
-  object
+  @return The object for distributing vector values
 */
-void TACSAssembler::getNodes(TACSBVec **X) {
-  if (X) {
-    *X = xptVec;
-  }
-}
+TACSBVecDistribute *TACSAssembler::getBVecDistribute() { return extDist; }
 
 /**
-  Set the auxiliary elements within the TACSAssembler object
-
-  This only needs to be done once sometime during initialization.  If
-  you need to change the loads repeatedly, this can be called
-  repeatedly. No check is made at this point that you haven't done
-  something odd. Note that the code assumes that the elements defined
-  here perfectly overlap the non-zero pattern of the elements set
-  internally within TACS already.
+  Get the dependent node vectors
 
-  @param auxElems Auxiliary element object
+  @return The object used to define the dependent node equations
 */
-void TACSAssembler::setAuxElements(TACSAuxElements *auxElems) {
-  // Increase the reference count to the input elements (Note that
-  // the input may be NULL to over-write the internal object
-  if (auxElems) {
-    auxElems->incref();
-  }
+TACSBVecDepNodes *TACSAssembler::getBVecDepNodes() { return depNodes; }
 
-  // Decrease the reference count if the old object is not NULL
-  if (auxElements) {
-    auxElements->decref();
-  }
-  auxElements = auxElems;
+/**
+  Get the maximum number of nodes for an element
 
-  // Check whether the auxiliary elements match
-  if (auxElements) {
-    int naux = 0;
-    TACSAuxElem *aux = NULL;
-    naux = auxElements->getAuxElements(&aux);
-    for (int k = 0; k < naux; k++) {
-      int elem = aux[k].num;
-      if (elem < 0 || elem >= numElements) {
-        fprintf(stderr, "[%d] Element number %d out of range [0,%d)\n", mpiRank,
-                elem, numElements);
-      } else if (elements[elem]->getNumVariables() !=
-                 aux[k].elem->getNumVariables()) {
-        fprintf(stderr, "[%d] Auxiliary element sizes do not match\n", mpiRank);
-      }
-    }
-  }
-}
+  @return The maximum number of nodes for an element
+*/
+int TACSAssembler::getMaxElementNodes() { return maxElementNodes; }
 
 /**
-  Retrieve the auxiliary element object from TACSAssembler
-
-  Note that the auxiliary element object may be NULL
+  Get the maximum number of element variables
 
-  @return The auxiliary element object
+  @return The maximum number of variables for an element
 */
-TACSAuxElements *TACSAssembler::getAuxElements() { return auxElements; }
+int TACSAssembler::getMaxElementVariables() { return maxElementSize; }
 
 /**
-  Compute the external list of nodes and sort these nodes
+  Get the maximum number of design variables for an element
 
-  This code is called automatically by TACSAssembler and is private.
-  This code computes numExtNodes and allocates the array
-  tacsExtNodeNums for use in other functions. This function should
-  only be called once during reordering or during initialization.
+  @return The maximum number of design variables for an element
+*/
+int TACSAssembler::getMaxElementDesignVars() { return maxElementDesignVars; }
 
-  @return Fail flag indicating if a failure occured
+/**
+  Get the array of elements from TACSAssembler
+
+  @return The array of element objects
 */
-int TACSAssembler::computeExtNodes() {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call computeExtNodes() after initialize()\n",
-            mpiRank);
-    return 1;
-  }
-  if (!elementNodeIndex) {
-    fprintf(stderr,
-            "[%d] Cannot call computeExtNodes() element "
-            "connectivity not defined\n",
-            mpiRank);
-    return 1;
-  }
+TACSElement **TACSAssembler::getElements() { return elements; }
 
-  // Get the ownership range of the nodes
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+/**
+  Get the element object and the corresponding element variables
 
-  // Find the maximum possible size of array
-  int max_size = elementNodeIndex[numElements];
+  @param index The element index
+  @param Xpts The element nodes array (may be NULL)
+  @param vars The element variable array (may be NULL)
+  @param dvars The element variable time derivative array (may be NULL)
+  @param dvars The element variable time derivative array (may be NULL)
+  @return The element object (NULL if index is out of range)
+*/
+TACSElement *TACSAssembler::getElement(int index, TacsScalar *Xpts,
+                                       TacsScalar *vars, TacsScalar *dvars,
+                                       TacsScalar *ddvars) {
+  if (elements && xptVec && (index >= 0 && index < numElements)) {
+    int ptr = elementNodeIndex[index];
+    int len = elementNodeIndex[index + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    if (Xpts) {
+      xptVec->getValues(len, nodes, Xpts);
+    }
+    if (vars) {
+      varsVec->getValues(len, nodes, vars);
+    }
+    if (dvars) {
+      dvarsVec->getValues(len, nodes, dvars);
+    }
+    if (ddvars) {
+      ddvarsVec->getValues(len, nodes, ddvars);
+    }
 
-  // Get the dependent node connectivity information (if any) and
-  // increase the size of the array to account for any external dependent
-  // nodes we may find.
-  const int *depNodePtr = NULL;
-  const int *depNodeConn = NULL;
-  if (depNodes) {
-    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
-    max_size += depNodePtr[numDependentNodes];
+    return elements[index];
   }
 
-  // Keep track of the external nodes that we've found
-  int ext_size = 0;
-  int *ext_list = new int[max_size];
+  return NULL;
+}
 
-  // First loop over the element connectivity
-  for (int i = 0; i < elementNodeIndex[numElements]; i++) {
-    int node = elementTacsNodes[i];
+/**
+  Get the element object and the pointer to the node numbers
 
-    // Check if the node is external
-    if ((node >= 0) &&
-        (node < ownerRange[mpiRank] || node >= ownerRange[mpiRank + 1])) {
-      ext_list[ext_size] = node;
-      ext_size++;
+  @param index The element index
+  @param nodes The global node numbers
+  @param len The number of nodes for this element
+  @return The element object (NULL if index is out of range)
+*/
+TACSElement *TACSAssembler::getElement(int index, int *len, const int **nodes) {
+  if (elements && (index >= 0 && index < numElements)) {
+    int ptr = elementNodeIndex[index];
+    if (len) {
+      *len = elementNodeIndex[index + 1] - ptr;
     }
-  }
-
-  // Loop over the dependent nodes
-  if (depNodes) {
-    int end = depNodePtr[numDependentNodes];
-    for (int i = 0; i < end; i++) {
-      int node = depNodeConn[i];
-
-      // Check if the node is external
-      if ((node >= 0) &&
-          (node < ownerRange[mpiRank] || node >= ownerRange[mpiRank + 1])) {
-        ext_list[ext_size] = node;
-        ext_size++;
-      }
+    if (nodes) {
+      *nodes = &elementTacsNodes[ptr];
     }
+    return elements[index];
   }
 
-  // Sort the list of nodes
-  numExtNodes = TacsUniqueSort(ext_size, ext_list);
-
-  // Allocate an array of the external nodes that is tight
-  // to the number of external nodes
-  tacsExtNodeNums = new int[numExtNodes];
-  memcpy(tacsExtNodeNums, ext_list, numExtNodes * sizeof(int));
-
-  // Free the original list of external nodes;
-  delete[] ext_list;
-
-  // Now the total number of nodes is equal to the external nodes
-  // plus the locally owned nodes
-  numNodes = numOwnedNodes + numExtNodes;
-
-  // Find the offset into the external node list
-  extNodeOffset = 0;
-  while (extNodeOffset < numExtNodes &&
-         tacsExtNodeNums[extNodeOffset] < ownerRange[mpiRank]) {
-    extNodeOffset++;
+  if (len) {
+    *len = 0;
   }
-
-  return 0;
+  if (nodes) {
+    *nodes = NULL;
+  }
+  return NULL;
 }
 
 /**
-  Compute a reordering of the nodes.
-
-  This function should be called after the element connectivity,
-  boundary conditions and optionally the dependent nodes are set, but
-  before the call to initialize().
-
-  This code computes and stores a reordering based on both the matrix
-  type and the ordering type. The matrix type determines what
-  constitutes a coupling node and what does not. The matrix type only
-  impacts the ordering in parallel computations.
-
-  The algorithm proceeds as follows:
+  Set the element connectivity.
 
-  1. Compute the coupling nodes referenced by another processor
-  2. Order the locally owned nodes based on the input ordering.
-  3. Based on the recvied coupling nodes, set the outgoing node
-  numbers back into the recieving array.
-  4. Set the new values of the nodes on the requesting processes
+  Note that the number of elements that are set at this stage must be
+  consistent with the number of elements passed in when TACSAssembler
+  is created.  (The connectivity arrays are copied and should be freed
+  by the caller.)
 
-  @param order_type The type of ordering to apply
-  @param mat_type The anticipated matrix distribution type
+  @param ptr Offset into the connectivity array for this processor
+  @param conn The connectivity from elements to global node index
+  @return Fail flag indicating if a failure occured
 */
-void TACSAssembler::computeReordering(OrderingType order_type,
-                                      MatrixOrderingType mat_type) {
-  // Return if the element connectivity not set
-  if (!elementNodeIndex) {
-    fprintf(stderr, "[%d] Must define element connectivity before reordering\n",
+int TACSAssembler::setElementConnectivity(const int *ptr, const int *conn) {
+  if (meshInitializedFlag) {
+    fprintf(stderr,
+            "[%d] Cannot call setElementConnectivity() after initialize()\n",
             mpiRank);
-    return;
+    return 1;
   }
   if (tacsExtNodeNums) {
     fprintf(stderr,
-            "[%d] TACSAssembler::computeReordering() can only be called once\n",
+            "[%d] Cannot call setElementConnectivity() after reordering\n",
             mpiRank);
-    return;
+    return 1;
   }
 
-  // Compute the external nodes
-  computeExtNodes();
+  // Free the data if it has already been set before
+  if (elementTacsNodes) {
+    delete[] elementTacsNodes;
+  }
+  if (elementNodeIndex) {
+    delete[] elementNodeIndex;
+  }
 
-  // Compute the local node numbers that correspond to the coupling
-  // nodes between processors
-  int *couplingNodes;
-  int *extPtr, *extCount;
-  int *recvPtr, *recvCount, *recvNodes;
-  int numCoupling = computeCouplingNodes(&couplingNodes, &extPtr, &extCount,
-                                         &recvPtr, &recvCount, &recvNodes);
+  int size = ptr[numElements];
+  elementNodeIndex = new int[numElements + 1];
+  elementTacsNodes = new int[size];
+  memcpy(elementNodeIndex, ptr, (numElements + 1) * sizeof(int));
 
-  // The new node numbers to be set according to the different
-  // re-ordering schemes
-  int *newNodeNums = new int[numNodes];
+  // Copy the node numbers
+  memcpy(elementTacsNodes, conn, size * sizeof(int));
 
-  // Metis can't handle the non-zero diagonal in the CSR data structure
-  int removeDiagonal = 0;
-  if (order_type == ND_ORDER) {
-    removeDiagonal = 1;
+  // If the elements are set, check the connectivity
+  if (elements) {
+    for (int i = 0; i < numElements; i++) {
+      int size = elementNodeIndex[i + 1] - elementNodeIndex[i];
+      if (size != elements[i]->getNumNodes()) {
+        fprintf(stderr,
+                "[%d] TACSAssembler: Element %s does not match "
+                " connectivity\n",
+                mpiRank, elements[i]->getObjectName());
+        return 1;
+      }
+    }
   }
 
-  // If using only one processor, order everything. In this case
-  // there is no distinction between local and global ordering.
-  if (mpiSize == 1) {
-    // Compute the local (global since it's serial) node to node
-    // connectivity based on the element connectivity.
-    int *rowp, *cols;
-    computeLocalNodeToNodeCSR(&rowp, &cols, removeDiagonal);
-
-    // Compute the reordering
-    computeMatReordering(order_type, numNodes, rowp, cols, NULL, newNodeNums);
+  // Check that the node numbers are all within range and that the
+  // dependent node numbers (if any) are in range
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
 
-    delete[] rowp;
-    delete[] cols;
-  } else if (mat_type == GAUSS_SEIDEL) {
-    // Compute the local node to node connectivity
-    int *rowp, *cols;
-    computeLocalNodeToNodeCSR(&rowp, &cols, removeDiagonal);
+  for (int i = 0; i < numElements; i++) {
+    int jend = elementNodeIndex[i + 1];
+    for (int j = elementNodeIndex[i]; j < jend; j++) {
+      if (elementTacsNodes[j] >= ownerRange[mpiSize]) {
+        fprintf(stderr,
+                "[%d] TACSAssembler: Element %d contains node number "
+                "out of range\n",
+                mpiRank, i);
+        return -1;
+      } else if (elementTacsNodes[j] < -numDependentNodes) {
+        fprintf(stderr,
+                "[%d] TACSAssembler: Element %d contains dependent "
+                "node number out of range\n",
+                mpiRank, i);
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
 
-    // Get the owner range
-    const int *ownerRange;
-    nodeMap->getOwnerRange(&ownerRange);
+/**
+  Get the element connectivity.
 
-    // Compute the node types. This is the node type relative to its
-    // owner.
-    int *nodeType = new int[numNodes];
+  @param ptr Offset into the connectivity array for this processor
+  @param conn The connectivity from elements to global node index
+*/
+void TACSAssembler::getElementConnectivity(const int **ptr, const int **conn) {
+  if (!meshInitializedFlag) {
+    fprintf(stderr,
+            "[%d] Cannot call getElementConnectivity() before initialize()\n",
+            mpiRank);
+    if (ptr) {
+      *ptr = NULL;
+    }
+    if (conn) {
+      *conn = NULL;
+    }
+    return;
+  }
 
-    for (int i = 0; i < numNodes; i++) {
-      // Set the node as a local node type
-      nodeType[i] = 0;
+  // Free the data if it has already been set before
+  if (ptr) {
+    *ptr = elementNodeIndex;
+  }
+  if (conn) {
+    *conn = elementTacsNodes;
+  }
+}
 
-      // Get the global node number
-      int node = getGlobalNodeNum(i);
+/**
+  Set the element array within TACS.
 
-      // Get the processor that owns this node
-      int owner = nodeMap->getNodeOwner(node);
+  The number of element pointers provided should be equal to the
+  number of elements specified in the TACSAssembler constructor.  Note
+  that the elements themselves are not copied, just the pointers to
+  them.
 
-      // Search the columns for the type of node
-      for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
-        // Get the local column index
-        int j = cols[jp];
+  @param elements The array of element pointers with length = numElements.
+  @return Fail flag indicating if a failure occured
+*/
+int TACSAssembler::setElements(TACSElement **_elements) {
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call setElements() after initialize()\n",
+            mpiRank);
+    return 1;
+  }
 
-        // Get the global node number
-        int col = getGlobalNodeNum(j);
+  // Check if the number of variables per node matches
+  for (int i = 0; i < numElements; i++) {
+    if (_elements[i]->getVarsPerNode() != varsPerNode) {
+      fprintf(stderr,
+              "[%d] TACSAssembler: Element %s, num displacements %d "
+              "does not match variables per node %d\n",
+              mpiRank, _elements[i]->getObjectName(),
+              _elements[i]->getVarsPerNode(), varsPerNode);
+      return 1;
+    }
+  }
 
-        if (col < ownerRange[owner]) {
-          if (nodeType[i] == 0) {
-            // Top node type
-            nodeType[i] = 1;
-          } else if (nodeType[i] == 3) {
-            // Mid-node type
-            nodeType[i] = 2;
-          }
-        } else if (col >= ownerRange[owner + 1]) {
-          if (nodeType[i] == 0) {
-            // Bottom node type
-            nodeType[i] = 3;
-          } else if (nodeType[i] == 1) {
-            // Mid-node type
-            nodeType[i] = 2;
-          }
-        }
+  // Copy over the element pointers into a local array
+  if (elements) {
+    for (int i = 0; i < numElements; i++) {
+      _elements[i]->incref();
+      if (elements[i]) {
+        elements[i]->decref();
       }
+      elements[i] = _elements[i];
     }
-
-    // This type of connectivity information is no longer required
-    delete[] rowp;
-    delete[] cols;
-
-    // We've computed the local node types, but this may be affected
-    // by the contributions from other processors. Now, perform some
-    // collective communication to globalize the node type
-    // information. This will order all the internal nodes first,
-    // followed by the top nodes, mid nodes and bottom nodes,
-    // respectively.
-
-    // Now allocate space for the node types
-    int *sendNodeType = new int[numExtNodes];
-    for (int i = 0; i < numExtNodes; i++) {
-      // Get the local node number
-      int index = getLocalNodeNum(tacsExtNodeNums[i]);
-      sendNodeType[i] = nodeType[index];
+  } else {
+    elements = new TACSElement *[numElements];
+    memset(elements, 0, numElements * sizeof(TACSElement *));
+    for (int i = 0; i < numElements; i++) {
+      _elements[i]->incref();
+      elements[i] = _elements[i];
     }
+  }
 
-    int *recvNodeType = new int[recvPtr[mpiSize]];
-    MPI_Alltoallv(sendNodeType, extCount, extPtr, MPI_INT, recvNodeType,
-                  recvCount, recvPtr, MPI_INT, tacs_comm);
+  // Keep track of the number of multiplier nodes
+  numMultiplierNodes = 0;
 
-    // Update the internal node types based on the recv'd values
-    for (int i = 0; i < recvPtr[mpiSize]; i++) {
-      int node = getLocalNodeNum(recvNodes[i]);
+  // Determine the maximum number of nodes per element
+  maxElementDesignVars = 0;
+  maxElementSize = 0;
+  maxElementNodes = 0;
 
-      if (nodeType[node] == 0) {
-        // Set the node type as the recv node type
-        nodeType[node] = recvNodeType[i];
-      } else if (nodeType[node] != recvNodeType[i]) {
-        // Mid-node type
-        nodeType[node] = 2;
-      }
+  for (int i = 0; i < numElements; i++) {
+    // Determine if the maximum number of variables and nodes needs to
+    // be changed
+    int elemSize = elements[i]->getNumVariables();
+    if (elemSize > maxElementSize) {
+      maxElementSize = elemSize;
     }
 
-    // Free the allocated data
-    delete[] sendNodeType;
-    delete[] recvNodeType;
-
-    // So now the local nodes have the correct node types,
-    // compute the local ordering.
-    int *reducedNodes = new int[numNodes];
-    memset(reducedNodes, 0, numNodes * sizeof(int));
+    elemSize = elements[i]->getNumNodes();
+    if (elemSize > maxElementNodes) {
+      maxElementNodes = elemSize;
+    }
 
-    // Exclude all the nodes that are external to this processor
-    for (int i = 0; i < extNodeOffset; i++) {
-      reducedNodes[i] = -1;
+    // Count up the multiplier nodes
+    int multiplier = elements[i]->getMultiplierIndex();
+    if (multiplier > 0) {
+      numMultiplierNodes++;
     }
-    for (int i = extNodeOffset + numOwnedNodes; i < numNodes; i++) {
-      reducedNodes[i] = -1;
+
+    // Keep track of the maximum number of element design variables
+    int numDVs = elements[i]->getDesignVarNums(i, 0, NULL);
+    if (numDVs > maxElementDesignVars) {
+      maxElementDesignVars = numDVs;
     }
+  }
 
-    // Loop over all of the node types. This will order all the
-    // internal nodes first
-    int offset = ownerRange[mpiRank];
-    for (int ntype = 0; ntype < 4; ntype++) {
-      int numReducedNodes = 0;
-      for (int i = extNodeOffset; i < extNodeOffset + numOwnedNodes; i++) {
-        if (nodeType[i] == ntype) {
-          reducedNodes[i] = numReducedNodes;
-          numReducedNodes++;
-        } else {
-          reducedNodes[i] = -1;
-        }
+  // If the connectivity is set, determine if it is consistent
+  if (elementNodeIndex) {
+    for (int i = 0; i < numElements; i++) {
+      int size = elementNodeIndex[i + 1] - elementNodeIndex[i];
+      if (size != elements[i]->getNumNodes()) {
+        fprintf(stderr,
+                "[%d] TACSAssembler: Element %s does not match "
+                "connectivity\n",
+                mpiRank, elements[i]->getObjectName());
+        return 1;
       }
+    }
+  }
 
-      if (numReducedNodes > 0) {
-        // Compute the reordering for the reduced set of nodes
-        int *newReducedNodes = new int[numReducedNodes];
-        int *reduced_rowp, *reduced_cols;
-        computeLocalNodeToNodeCSR(&reduced_rowp, &reduced_cols, numReducedNodes,
-                                  reducedNodes, removeDiagonal);
-        computeMatReordering(order_type, numReducedNodes, reduced_rowp,
-                             reduced_cols, NULL, newReducedNodes);
-        delete[] reduced_rowp;
-        delete[] reduced_cols;
+  return 0;
+}
 
-        // Set the new variable numbers for the boundary nodes
-        // and include their offset
-        for (int i = 0, j = 0; i < numNodes; i++) {
-          if (reducedNodes[i] >= 0) {
-            newNodeNums[i] = offset + newReducedNodes[j];
-            j++;
-          }
-        }
+/**
+  Set the dependent node data structure
 
-        offset += numReducedNodes;
+  The dependent nodes are designated by a negative index with a 1-base
+  numbering scheme. This dependent node data structure is a sparse
+  matrix with constant weights that designates the weights applied to
+  the global independent nodes (storred in depNodeToTacs).
 
-        // Free the new node numbers
-        delete[] newReducedNodes;
-      }
-    }
+  @param depNodePtr Offset into the connectivity/weight arrays
+  @param depNodeToTacs The independent global nodes
+  @param depNodeWeights The weight applied to each independent node
+  @return Fail flag indicating if a failure occured
+*/
+int TACSAssembler::setDependentNodes(const int *_depNodePtr,
+                                     const int *_depNodeToTacs,
+                                     const double *_depNodeWeights) {
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call setDependentNodes() after initialize()\n",
+            mpiRank);
+    return 1;
+  }
+  if (tacsExtNodeNums) {
+    fprintf(stderr, "[%d] Cannot call setDependentNodes() after reordering\n",
+            mpiRank);
+    return 1;
+  }
 
-    // Free the node type array
-    delete[] nodeType;
-  } else {
-    // First, find the reduced nodes - the set of nodes that are only
-    // referenced by this processor. These can be reordered without
-    // affecting other processors.
-    int *reducedNodes = new int[numNodes];
-    memset(reducedNodes, 0, numNodes * sizeof(int));
+  // Free the data if the dependent nodes have already been set
+  if (depNodes) {
+    depNodes->decref();
+  }
 
-    // Exclude all the nodes that are external to this processor
-    for (int i = 0; i < extNodeOffset; i++) {
-      reducedNodes[i] = -1;
-    }
-    for (int i = extNodeOffset + numOwnedNodes; i < numNodes; i++) {
-      reducedNodes[i] = -1;
-    }
-
-    // Depending on the matrix type, also add the external dependent
-    // nodes and nodes that also couple to those nodes
-    if (mat_type == DIRECT_SCHUR) {
-      for (int i = 0; i < numCoupling; i++) {
-        int node = couplingNodes[i];
-        reducedNodes[node] = -1;
-      }
-    } else if (mat_type == APPROXIMATE_SCHUR) {
-      // If we want an approximate schur ordering, where the nodes
-      // that couple to other processors are ordered last, we also add
-      // these nodes to the reduced set.
-      int *rowp, *cols;
-      computeLocalNodeToNodeCSR(&rowp, &cols);
+  // Get the ownership range of the nodes
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
 
-      // Order all nodes linked by an equation to an external node
-      // This ordering is required for the approximate Schur method
-      for (int i = 0; i < numCoupling; i++) {
-        int node = couplingNodes[i];
-        for (int jp = rowp[node]; jp < rowp[node + 1]; jp++) {
-          reducedNodes[cols[jp]] = -1;
-        }
+  // Check that all the independent nodes are positive and are within an
+  // allowable range
+  for (int i = 0; i < numDependentNodes; i++) {
+    for (int jp = _depNodePtr[i]; jp < _depNodePtr[i + 1]; jp++) {
+      if (_depNodeToTacs[jp] >= ownerRange[mpiSize]) {
+        fprintf(stderr,
+                "[%d] Dependent node %d contains node number %d out of range\n",
+                mpiRank, i, _depNodeToTacs[jp]);
+        return 1;
+      } else if (_depNodeToTacs[jp] < 0) {
+        fprintf(stderr, "[%d] Dependent node %d contains dependent node %d\n",
+                mpiRank, i, _depNodeToTacs[jp]);
+        return 1;
       }
-
-      delete[] rowp;
-      delete[] cols;
     }
+  }
 
-    // Now, order all nodes that are non-negative
-    int numReducedNodes = 0;
-    for (int i = 0; i < numNodes; i++) {
-      if (reducedNodes[i] >= 0) {
-        reducedNodes[i] = numReducedNodes;
-        numReducedNodes++;
-      }
-    }
+  if (numDependentNodes > 0) {
+    // Allocate the new memory and copy over the data
+    int *depNodePtr = new int[numDependentNodes + 1];
+    memcpy(depNodePtr, _depNodePtr, (numDependentNodes + 1) * sizeof(int));
 
-    // Compute the reordering for the reduced set of nodes
-    int *newReducedNodes = new int[numReducedNodes];
-    int *rowp, *cols;
-    computeLocalNodeToNodeCSR(&rowp, &cols, numReducedNodes, reducedNodes,
-                              removeDiagonal);
-    computeMatReordering(order_type, numReducedNodes, rowp, cols, NULL,
-                         newReducedNodes);
-    delete[] rowp;
-    delete[] cols;
+    int size = depNodePtr[numDependentNodes];
+    int *depNodeToTacs = new int[size];
+    memcpy(depNodeToTacs, _depNodeToTacs, size * sizeof(int));
 
-    // Place the result back into the newNodeNums - add the
-    // ownership offset
-    const int *ownerRange;
-    nodeMap->getOwnerRange(&ownerRange);
-    int offset = ownerRange[mpiRank];
-    for (int i = 0, j = 0; i < numNodes; i++) {
-      if (reducedNodes[i] >= 0) {
-        newNodeNums[i] = offset + newReducedNodes[j];
-        j++;
-      }
-    }
+    double *depNodeWeights = new double[size];
+    memcpy(depNodeWeights, _depNodeWeights, size * sizeof(double));
 
-    delete[] newReducedNodes;
+    // Allocate the dependent node data structure
+    depNodes = new TACSBVecDepNodes(numDependentNodes, &depNodePtr,
+                                    &depNodeToTacs, &depNodeWeights);
+    depNodes->incref();
+  }
 
-    // Add the offset to the total number of reduced nodes
-    offset += numReducedNodes;
+  return 0;
+}
 
-    // Now, order any remaining variables that have not yet been
-    // ordered. These are the coupling variables (if any) that
-    // have been labeled before.
-    numReducedNodes = 0;
-    for (int i = extNodeOffset; i < extNodeOffset + numOwnedNodes; i++) {
-      // If the node has not been ordered and is within the ownership
-      // range of this process, order it now.
-      if (reducedNodes[i] < 0) {
-        reducedNodes[i] = numReducedNodes;
-        numReducedNodes++;
-      } else {
-        reducedNodes[i] = -1;
-      }
-    }
+/**
+  Set a block transformation for the dependent node variables
 
-    if (numReducedNodes > 0) {
-      // Additive Schwarz ordering should number all locally owned
-      // nodes first, and should not require this second ordering.
-      if (mat_type == ADDITIVE_SCHWARZ) {
-        fprintf(stderr, "[%d] Error in additive Schwarz reordering\n", mpiRank);
-      }
+  By default, each variable at a dependent node is the weighted sum of
+  the same variable at the independent nodes. This sets a block of
+  weights for each entry of the dependent node connectivity so that
+  the variables at a dependent node are a linear combination of all of
+  the variables at its independent nodes:
 
-      // Order any remaning variables that are locally owned
-      newReducedNodes = new int[numReducedNodes];
-      computeLocalNodeToNodeCSR(&rowp, &cols, numReducedNodes, reducedNodes,
-                                removeDiagonal);
-      computeMatReordering(order_type, numReducedNodes, rowp, cols, NULL,
-                           newReducedNodes);
+  u_dep[k] = sum_{j} W_{j}[varsPerNode*k + l] u_{j}[l]
 
-      // Free the allocate CSR data structure
-      delete[] rowp;
-      delete[] cols;
+  This can be used to eliminate rigid connections, such as those
+  defined by RBE2 and RBE3 elements, from the global system instead of
+  adding Lagrange multipliers. The resulting system only contains the
+  independent variables and is positive definite when the remaining
+  elements are.
 
-      // Set the new variable numbers for the boundary nodes
-      // and include their offset
-      for (int i = 0, j = 0; i < numNodes; i++) {
-        if (reducedNodes[i] >= 0) {
-          newNodeNums[i] = offset + newReducedNodes[j];
-          j++;
-        }
-      }
+  The scalar weights from setDependentNodes() are still used for the
+  node locations. The location of each dependent node is offset from
+  this weighted sum by a fixed amount so that the dependent nodes can
+  be placed anywhere. The block weights are not updated when the
+  nodes move.
 
-      // Free the new node numbers
-      delete[] newReducedNodes;
-    }
+  This must be called after setDependentNodes() and before initialize().
 
-    delete[] reducedNodes;
+  @param depNodeBlockWeights The weight block for each independent node
+  @param depNodeXptOffsets The offset of each dependent node (may be NULL)
+  @return Fail flag indicating if a failure occured
+*/
+int TACSAssembler::setDependentNodeTransform(
+    const double *_depNodeBlockWeights, const TacsScalar *_depNodeXptOffsets) {
+  if (meshInitializedFlag) {
+    fprintf(stderr,
+            "[%d] Cannot call setDependentNodeTransform() after "
+            "initialize()\n",
+            mpiRank);
+    return 1;
   }
-
-  // So now we have new node numbers for the nodes owned by this
-  // processor, but the other processors do not have these new numbers
-  // yet. Find the values assigned to the nodes requested from
-  // external nodes recv_nodes is now an outgoing list of nodes to
-  // other processes
-  for (int i = 0; i < recvPtr[mpiSize]; i++) {
-    int node = getLocalNodeNum(recvNodes[i]);
-    recvNodes[i] = newNodeNums[node];
+  if (numDependentNodes > 0 && !depNodes) {
+    fprintf(stderr,
+            "[%d] Must call setDependentNodes() before "
+            "setDependentNodeTransform()\n",
+            mpiRank);
+    return 1;
   }
 
-  // Now send the new node numbers back to the other processors
-  // that reference them. This also uses all-to-all communication.
-  int *newExtNodes = new int[extPtr[mpiSize]];
-  MPI_Alltoallv(recvNodes, recvCount, recvPtr, MPI_INT, newExtNodes, extCount,
-                extPtr, MPI_INT, tacs_comm);
+  if (numDependentNodes > 0) {
+    const int *depNodePtr;
+    depNodes->getDepNodes(&depNodePtr, NULL, NULL);
 
-  // Once the new node numbers from other processors is received
-  // apply these new node numbers back to the locally owned
-  // reference numbers.
-  for (int i = 0; i < extNodeOffset; i++) {
-    newNodeNums[i] = newExtNodes[i];
+    int size = varsPerNode * varsPerNode * depNodePtr[numDependentNodes];
+    double *depNodeBlockWeights = new double[size];
+    memcpy(depNodeBlockWeights, _depNodeBlockWeights, size * sizeof(double));
+    depNodes->setBlockWeights(varsPerNode, &depNodeBlockWeights);
+
+    if (depNodeXptOffsets) {
+      delete[] depNodeXptOffsets;
+      depNodeXptOffsets = NULL;
+    }
+    if (_depNodeXptOffsets) {
+      depNodeXptOffsets = new TacsScalar[TACS_SPATIAL_DIM * numDependentNodes];
+      memcpy(depNodeXptOffsets, _depNodeXptOffsets,
+             TACS_SPATIAL_DIM * numDependentNodes * sizeof(TacsScalar));
+    }
   }
-  for (int i = extNodeOffset; i < numExtNodes; i++) {
-    newNodeNums[i + numOwnedNodes] = newExtNodes[i];
+
+  return 0;
+}
+
+/*
+  Fold the dependent node weights into the element connectivity
+
+  For each node of each element, store the independent nodes and
+  weights that define the node: a single entry with a unit weight for
+  an independent node, or the entries of the dependent node. The
+  element matrices are then transformed to the independent nodes with
+  this data, rather than re-building the weights from the dependent
+  node lists each time an element matrix is added.
+*/
+void TACSAssembler::initDepNodeGather() {
+  if (depGatherPtr) {
+    delete[] depGatherPtr;
+    delete[] depGatherVars;
+    delete[] depGatherWeights;
+    depGatherPtr = depGatherVars = NULL;
+    depGatherWeights = NULL;
+  }
+  if (numDependentNodes == 0 || !depNodes) {
+    return;
   }
 
-  // Free the new external node numbers
-  delete[] newExtNodes;
+  const int *depNodePtr, *depNodeConn;
+  const double *depNodeWeights;
+  depNodes->getDepNodes(&depNodePtr, &depNodeConn, &depNodeWeights);
 
-  // Reorder the local dependent node connectivity
-  int *depConn = NULL;
-  const int *depPtr = NULL;
-  if (depNodes) {
-    depNodes->getDepNodeReorder(&depPtr, &depConn);
-    int end = depPtr[numDependentNodes];
-    for (int i = 0; i < end; i++) {
-      int node = getLocalNodeNum(depConn[i]);
-      depConn[i] = newNodeNums[node];
+  // Count the number of entries for each element node
+  int size = elementNodeIndex[numElements];
+  depGatherPtr = new int[size + 1];
+  depGatherPtr[0] = 0;
+  for (int j = 0; j < size; j++) {
+    int node = elementTacsNodes[j];
+    int count = 1;
+    if (node < 0) {
+      int dep = -node - 1;
+      count = depNodePtr[dep + 1] - depNodePtr[dep];
     }
+    depGatherPtr[j + 1] = depGatherPtr[j] + count;
   }
 
-  // Reorder the element connectivity
-  int end = elementNodeIndex[numElements];
-  for (int i = 0; i < end; i++) {
-    int node = elementTacsNodes[i];
+  // Set the independent nodes and the weights
+  depGatherVars = new int[depGatherPtr[size]];
+  depGatherWeights = new TacsScalar[depGatherPtr[size]];
+  for (int j = 0; j < size; j++) {
+    int node = elementTacsNodes[j];
+    int k = depGatherPtr[j];
     if (node >= 0) {
-      node = getLocalNodeNum(node);
-      elementTacsNodes[i] = newNodeNums[node];
+      depGatherVars[k] = node;
+      depGatherWeights[k] = 1.0;
+    } else {
+      int dep = -node - 1;
+      for (int jp = depNodePtr[dep]; jp < depNodePtr[dep + 1]; jp++, k++) {
+        depGatherVars[k] = depNodeConn[jp];
+        depGatherWeights[k] = depNodeWeights[jp];
+      }
     }
   }
+}
 
-  // If boundary conditions are set, reorder them
-  if (bcMap) {
-    int *nodeNums;
-    int nbcs = bcMap->getBCNodeNums(&nodeNums);
-    for (int i = 0; i < nbcs; i++) {
-      int node = getLocalNodeNum(nodeNums[i]);
-      nodeNums[i] = newNodeNums[node];
-    }
-  }
-  if (bcInitMap) {
-    int *nodeNums;
-    int nbcs = bcInitMap->getBCNodeNums(&nodeNums);
-    for (int i = 0; i < nbcs; i++) {
-      int node = getLocalNodeNum(nodeNums[i]);
-      nodeNums[i] = newNodeNums[node];
+/*
+  Add an element matrix that references dependent nodes with block
+  weights
+
+  The element matrix is transformed to the independent variables,
+  K_{ab} = W_{a}^{T} K_{ij} W_{b}, where a and b are the independent
+  node entries that contribute to the element nodes i and j, and then
+  added to the matrix.
+
+  input:
+  A:          the matrix to which the element-matrix is added
+  elemNum:    the element number
+  mat:        the corresponding element matrix
+  matOr:      the orientation of the element matrix
+*/
+void TACSAssembler::addBlockWeightMatValues(TACSMat *A, const int elemNum,
+                                            const TacsScalar *mat,
+                                            MatrixOrientation matOr) {
+  const int start = elementNodeIndex[elemNum];
+  const int nnodes = elementNodeIndex[elemNum + 1] - start;
+  const int nvars = varsPerNode * nnodes;
+  const int *nodeNums = &elementTacsNodes[start];
+  const int bsize = varsPerNode;
+
+  const int *depNodePtr, *depNodeConn;
+  const double *depNodeBlocks;
+  depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+  depNodes->getBlockWeights(&depNodeBlocks);
+
+  // Count the number of independent node entries
+  int size = 0;
+  for (int i = 0; i < nnodes; i++) {
+    if (nodeNums[i] >= 0) {
+      size++;
+    } else {
+      int dep = -nodeNums[i] - 1;
+      size += depNodePtr[dep + 1] - depNodePtr[dep];
+    }
+  }
+
+  // Record the element node, the independent node and the weight
+  // block for each entry. A NULL block indicates the identity.
+  int *entryNode = new int[size];
+  int *vars = new int[size];
+  int *varp = new int[size + 1];
+  TacsScalar *weights = new TacsScalar[size];
+  const double **blocks = new const double *[size];
+  for (int i = 0, k = 0; i < nnodes; i++) {
+    if (nodeNums[i] >= 0) {
+      entryNode[k] = i;
+      vars[k] = nodeNums[i];
+      blocks[k] = NULL;
+      k++;
+    } else {
+      int dep = -nodeNums[i] - 1;
+      for (int j = depNodePtr[dep]; j < depNodePtr[dep + 1]; j++, k++) {
+        entryNode[k] = i;
+        vars[k] = depNodeConn[j];
+        blocks[k] = &depNodeBlocks[bsize * bsize * j];
+      }
     }
   }
-
-  // Finaly, reorder the external node numbers
-  for (int i = 0; i < extNodeOffset; i++) {
-    tacsExtNodeNums[i] = newNodeNums[i];
+  for (int k = 0; k <= size; k++) {
+    varp[k] = k;
   }
-  for (int i = extNodeOffset; i < numExtNodes; i++) {
-    tacsExtNodeNums[i] = newNodeNums[i + numOwnedNodes];
+  for (int k = 0; k < size; k++) {
+    weights[k] = 1.0;
   }
 
-  // Resort the external node numbers - these are already unique and
-  // the extNodeOffset should not change either
-  TacsUniqueSort(numExtNodes, tacsExtNodeNums);
+  // Compute the transformed matrix one block at a time
+  const int nevars = bsize * size;
+  TacsScalar *emat = new TacsScalar[nevars * nevars];
+  TacsScalar *t = new TacsScalar[2 * bsize * bsize];
+  TacsScalar *s = &t[bsize * bsize];
+  for (int a = 0; a < size; a++) {
+    const double *Wa = blocks[a];
+    for (int b = 0; b < size; b++) {
+      const double *Wb = blocks[b];
 
-  // Save the mapping to the new numbers for later reorderings
-  newNodeIndices = new TACSBVecIndices(&newNodeNums, numNodes);
-  newNodeIndices->incref();
+      // Get the block of the element matrix
+      const TacsScalar *K =
+          &mat[nvars * bsize * entryNode[a] + bsize * entryNode[b]];
 
-  delete[] couplingNodes;
-  delete[] extPtr;
-  delete[] extCount;
-  delete[] recvPtr;
-  delete[] recvCount;
-  delete[] recvNodes;
+      // Compute s = K*Wb
+      for (int ii = 0; ii < bsize; ii++) {
+        for (int jj = 0; jj < bsize; jj++) {
+          if (Wb) {
+            s[bsize * ii + jj] = 0.0;
+            for (int kk = 0; kk < bsize; kk++) {
+              s[bsize * ii + jj] += K[nvars * ii + kk] * Wb[bsize * kk + jj];
+            }
+          } else {
+            s[bsize * ii + jj] = K[nvars * ii + jj];
+          }
+        }
+      }
+
+      // Compute t = Wa^{T}*s
+      for (int ii = 0; ii < bsize; ii++) {
+        for (int jj = 0; jj < bsize; jj++) {
+          if (Wa) {
+            t[bsize * ii + jj] = 0.0;
+            for (int kk = 0; kk < bsize; kk++) {
+              t[bsize * ii + jj] += Wa[bsize * kk + ii] * s[bsize * kk + jj];
+            }
+          } else {
+            t[bsize * ii + jj] = s[bsize * ii + jj];
+          }
+        }
+      }
+
+      // Copy the values into the transformed element matrix
+      for (int ii = 0; ii < bsize; ii++) {
+        for (int jj = 0; jj < bsize; jj++) {
+          emat[nevars * (bsize * a + ii) + bsize * b + jj] =
+              t[bsize * ii + jj];
+        }
+      }
+    }
+  }
+
+  A->addWeightValues(size, varp, vars, weights, nevars, nevars, emat, matOr);
+
+  delete[] entryNode;
+  delete[] vars;
+  delete[] varp;
+  delete[] weights;
+  delete[] blocks;
+  delete[] emat;
+  delete[] t;
 }
 
 /**
-  Compute the reordering for the given matrix.
+  Add Dirichlet boundary conditions.
 
-  This uses either Reverse Cuthill-McKee (RCM_ORDER), Approximate
-  Minimum Degree (AMD) or Nested Disection (ND) to compute a
-  reordering of the variables.
-
-  The input to the function is a CSR-type data structure of the
-  matrix. Note that for ND (with the external package Metis), requires
-  that the diagonal be eliminated from the CSR data structure. (This
-  modified data structure can be computed with the no_diagonal flag
-  when calling the CSR creation routines.)
-
-  The matrix ordering routines compute a reordering such that:
-
-  P*A*P^{T} has fewer non-zeros.
-
-  The function returns an array new_vars such that:
+  These BCs are added to an object that will be associated with the
+  vectors/matrices that are created using TACSAssembler.
 
-  new_vars = P^{T} old_vars
-  perm = P
+  Fully-fixed boundary conditions can be specified by passing in
+  nbcs < 0. If the vals array is NULL, then it is assumed that all values
+  are fixed to zero.
 
-  @param order_type The ordering type
-  @param nvars The number of variables
-  @param rowp Pointer into each new row of the matrix
-  @param cols Column indices for each row
-  @param perm Permutation array
-  @param new_vars New variable array
+  @param nnodes The number of nodes
+  @param nodes The node numbers
+  @param nbcs The number of nodal variables to be constrained
+  @param vars The variable indices satisfying (0 <= vars[i] < varsPerNode)
+  @param vals The boundary condition values
 */
-void TACSAssembler::computeMatReordering(OrderingType order_type, int nvars,
-                                         int *rowp, int *cols, int *perm,
-                                         int *new_vars) {
-  int *_perm = perm;
-  int *_new_vars = new_vars;
-  if (!perm) {
-    _perm = new int[nvars];
-  }
-  if (!new_vars) {
-    _new_vars = new int[nvars];
+void TACSAssembler::addBCs(int nnodes, const int *nodes, int nbcs,
+                           const int *vars, const TacsScalar *vals) {
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call addBC() after initialize()\n", mpiRank);
+    return;
   }
 
-  if (order_type == RCM_ORDER) {
-    // Compute the matrix reordering using RCM TACS' version
-    // of the RCM algorithm
-    int root_node = 0;
-    int num_rcm_iters = 1;
-    TacsComputeRCMOrder(nvars, rowp, cols, _new_vars, root_node, num_rcm_iters);
+  // Adjust the input to the addBC call. If no vars are specified,
+  // set the number of boundary conditions equal to the number of
+  // variables per node
+  if (!vars || (nbcs < 0)) {
+    nbcs = varsPerNode;
+  }
 
-    if (perm) {
-      for (int k = 0; k < nvars; k++) {
-        perm[_new_vars[k]] = k;
-      }
-    }
-  } else if (order_type == AMD_ORDER) {
-#if TACS_HAS_AMD_LIBRARY
-    // Use the approximate minimum degree ordering
-    double control[AMD_CONTROL], info[AMD_INFO];
-    amd_defaults(control);  // Use the default values
-    amd_order(nvars, rowp, cols, _perm, control, info);
+  // Get the ownership range
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
 
-    if (new_vars) {
-      for (int k = 0; k < nvars; k++) {
-        new_vars[_perm[k]] = k;
-      }
+  // Add all the boundary conditions within the specified owner range
+  for (int i = 0; i < nnodes; i++) {
+    if (nodes[i] >= ownerRange[mpiRank] && nodes[i] < ownerRange[mpiRank + 1]) {
+      bcMap->addBC(nodes[i], nbcs, vars, vals);
     }
-#else
-    int use_exact_degree = 0;
-    int ncoupling_nodes = 0;
-    int *coupling_nodes = NULL;
-    amd_order_interface(nvars, rowp, cols, _perm, coupling_nodes,
-                        ncoupling_nodes, 0, NULL, NULL, NULL, use_exact_degree);
+  }
+}
 
-    if (new_vars) {
-      for (int k = 0; k < nvars; k++) {
-        new_vars[_perm[k]] = k;
-      }
-    }
-#endif  // TACS_HAS_AMD_LIBRARY
-  } else if (order_type == ND_ORDER) {
-    // Set the default options in METIS
-    int options[METIS_NOPTIONS];
-    METIS_SetDefaultOptions(options);
+/**
+  Add Dirichlet boundary conditions for the initial conditions.
 
-    // Use 0-based numbering
-    options[METIS_OPTION_NUMBERING] = 0;
-    METIS_NodeND(&nvars, rowp, cols, NULL, options, _perm, _new_vars);
-  } else if (order_type == TACS_AMD_ORDER) {
-    int use_exact_degree = 0;
-    int ncoupling_nodes = 0;
-    int *coupling_nodes = NULL;
-    amd_order_interface(nvars, rowp, cols, _perm, coupling_nodes,
-                        ncoupling_nodes, 0, NULL, NULL, NULL, use_exact_degree);
+  These BCs are added to an object that will be associated with the
+  vectors/matrices that are created using TACSAssembler.
 
-    if (new_vars) {
-      for (int k = 0; k < nvars; k++) {
-        new_vars[_perm[k]] = k;
-      }
-    }
-  } else if (order_type == MULTICOLOR_ORDER) {
-    // Compute the matrix reordering using RCM TACS' version of the
-    // RCM algorithm
-    int *colors = new int[nvars];
-    TacsComputeSerialMultiColor(nvars, rowp, cols, colors, new_vars);
-    delete[] colors;
+  Fully-fixed boundary conditions can be specified by passing in
+  nbcs < 0. If the vals array is NULL, then it is assumed that all values
+  are fixed to zero.
 
-    if (perm) {
-      for (int k = 0; k < nvars; k++) {
-        perm[_new_vars[k]] = k;
-      }
-    }
-  } else if (order_type == NATURAL_ORDER) {
-    if (perm) {
-      for (int k = 0; k < nvars; k++) {
-        perm[k] = k;
-      }
-    }
-    if (new_vars) {
-      for (int k = 0; k < nvars; k++) {
-        new_vars[k] = k;
-      }
-    }
+  @param nnodes The number of nodes
+  @param nodes The node numbers
+  @param nbcs The number of nodal variables to be constrained
+  @param vars The variable indices satisfying (0 <= vars[i] < varsPerNode)
+  @param vals The boundary condition values
+*/
+void TACSAssembler::addInitBCs(int nnodes, const int *nodes, int nbcs,
+                               const int *vars, const TacsScalar *vals) {
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call addInitBC() after initialize()\n",
+            mpiRank);
+    return;
   }
 
-  if (!perm) {
-    delete[] _perm;
+  // Adjust the input to the addBC call. If no vars are specified,
+  // set the number of boundary conditions equal to the number of
+  // variables per node
+  if (!vars || (nbcs < 0)) {
+    nbcs = varsPerNode;
   }
-  if (!new_vars) {
-    delete[] _new_vars;
+
+  // Get the ownership range
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
+
+  // Add all the boundary conditions within the specified owner range
+  for (int i = 0; i < nnodes; i++) {
+    if (nodes[i] >= ownerRange[mpiRank] && nodes[i] < ownerRange[mpiRank + 1]) {
+      bcInitMap->addBC(nodes[i], nbcs, vars, vals);
+    }
   }
 }
 
 /**
-  The following function returns a local node number based on the
-  provided (global) TACS node number.
+  Set new Dirichlet BC values at nodes where BCs are imposed
 
-  If the node number is on this processor, no search is required,
-  however, if the node is externally owned, then a binary search is
-  needed to determine the index into the off-processor list of nodes.
+  This takes the new boundary condition values as the entries in the
+  given vector where the Dirichlet boundary conditions are imposed.
 
-  @param node The global TACS node number unique across all processors
-  @return The local node number
+  @param vec The vector containing the new boundary condition values
 */
-int TACSAssembler::getLocalNodeNum(int node) {
+void TACSAssembler::setBCValuesFromVec(TACSBVec *vec) {
+  TacsScalar *xvals = NULL;
+  vec->getArray(&xvals);
+
+  // Get the values from the boundary condition arrays
+  const int *nodes, *vars;
+  TacsScalar *values;
+  int nbcs = bcMap->getBCs(&nodes, &vars, &values);
+
   // Get the ownership range
   const int *ownerRange;
   nodeMap->getOwnerRange(&ownerRange);
 
-  if (node >= ownerRange[mpiRank] && node < ownerRange[mpiRank + 1]) {
-    node = (node - ownerRange[mpiRank]) + extNodeOffset;
-  } else if (node >= 0) {
-    const int *ext_nodes = NULL;
-    if (tacsExtNodeNums) {
-      ext_nodes = tacsExtNodeNums;
-    } else if (extDistIndices) {
-      extDistIndices->getIndices(&ext_nodes);
-    } else {
-      fprintf(stderr, "[%d] External nodes not defined\n", mpiRank);
-      return -1;
-    }
-
-    // Find the local index for external nodes
-    int *item = TacsSearchArray(node, numExtNodes, ext_nodes);
-
-    // Check if the item is found in the list
-    if (item) {
-      if (node < ownerRange[mpiRank]) {
-        node = (item - ext_nodes);
-      } else {
-        node = numOwnedNodes + (item - ext_nodes);
+  for (int i = 0; i < nbcs; i++) {
+    if (nodes[i] >= ownerRange[mpiRank] && nodes[i] < ownerRange[mpiRank + 1]) {
+      int var = varsPerNode * (nodes[i] - ownerRange[mpiRank]);
+      for (int k = 0; k < varsPerNode; k++) {
+        if (vars[i] & (1 << k)) {
+          // Scan through the rows to be zeroed
+          values[varsPerNode * i + k] = xvals[var + k];
+        }
       }
-    } else {
-      fprintf(stderr, "[%d] External node %d not in external node list\n",
-              mpiRank, node);
-      return -1;
     }
-  } else {
-    fprintf(stderr, "[%d] Cannot compute local number for dependent node %d\n",
-            mpiRank, node);
-    return -1;
   }
-
-  return node;
 }
 
 /**
-  Given the local node number find the corresponding global TACS node
-  number
+  Create a global vector of node locations.
 
-  This function is the inverse of the getLocalNodeNum() function
-  defined above.
+  Note that the nodal coordinates are not set into the vector.
 
-  @param node The local node number
-  @return The global TACS node number
+  @return A new vector for spatial coordinates
 */
-int TACSAssembler::getGlobalNodeNum(int node) {
-  // Get the ownership range
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+TACSBVec *TACSAssembler::createNodeVec() {
+  return new TACSBVec(nodeMap, TACS_SPATIAL_DIM, extDist, depNodes,
+                      thread_info);
+}
 
-  if (node < extNodeOffset) {
-    const int *ext_nodes = NULL;
-    if (tacsExtNodeNums) {
-      ext_nodes = tacsExtNodeNums;
-    } else if (extDistIndices) {
-      extDistIndices->getIndices(&ext_nodes);
-    } else {
-      fprintf(stderr, "[%d] External nodes not defined\n", mpiRank);
-      return -1;
-    }
-
-    return ext_nodes[node];
-  } else if (node < extNodeOffset + numOwnedNodes) {
-    return (node - extNodeOffset) + ownerRange[mpiRank];
-  } else if (node < numNodes) {
-    const int *ext_nodes = NULL;
-    if (tacsExtNodeNums) {
-      ext_nodes = tacsExtNodeNums;
-    } else if (extDistIndices) {
-      extDistIndices->getIndices(&ext_nodes);
-    } else {
-      fprintf(stderr, "[%d] External nodes not defined\n", mpiRank);
-      return -1;
+/*
+  Check whether the locally owned values of two vectors with the same
+  layout differ
+*/
+static int TacsLocalValuesDiffer(TACSBVec *x, TACSBVec *y) {
+  TacsScalar *xvals, *yvals;
+  int xsize = x->getArray(&xvals);
+  int ysize = y->getArray(&yvals);
+  if (xsize != ysize) {
+    return 1;
+  }
+  for (int i = 0; i < xsize; i++) {
+    if (xvals[i] != yvals[i]) {
+      return 1;
     }
-
-    return ext_nodes[node - numOwnedNodes];
-  } else {
-    fprintf(stderr, "[%d] Local node number %d out of range\n", mpiRank, node);
-    return -1;
   }
-
-  return node;
+  return 0;
 }
 
 /**
-  The following function creates a data structure that links nodes
-  to elements - this reverses the existing data structure that
-  links elements to nodes but keeps the original in tact.
-
-  The algorithm proceeds as follows:
-
-  1. The size of the arrays are determined by finding how many
-  nodes point to each element
-
-  2. The index into the nodeElem array is determined by adding up
-  the contributions from all previous entries.
-
-  3. The original data structure is again traversed and this time
-  an element number is associated with each element.
+  Set the nodal locations from the input vector
 
-  @param _nodeElementPtr Pointer into the array nodeToElements
-  @param _nodeToElements Element index associated with each node
+  @param X The nodal coordinate vector
 */
-void TACSAssembler::computeNodeToElementCSR(int **_nodeElementPtr,
-                                            int **_nodeToElements) {
-  // Determine the node->element connectivity using local nodes
-  int *nodeElementPtr = new int[numNodes + 1];
-  memset(nodeElementPtr, 0, (numNodes + 1) * sizeof(int));
+void TACSAssembler::setNodes(TACSBVec *X) {
+  // Check whether the node locations change on any processor
+  int localChanged = TacsLocalValuesDiffer(xptVec, X);
+  int changed = 0;
+  MPI_Allreduce(&localChanged, &changed, 1, MPI_INT, MPI_MAX, tacs_comm);
 
-  // Get the dependent node connectivity information
-  const int *depNodePtr = NULL;
-  const int *depNodeConn = NULL;
-  if (depNodes) {
-    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
-  }
+  xptVec->copyValues(X);
 
-  // Loop over all the elements and count up the number of times
-  // each node refers to each element
-  for (int i = 0; i < numElements; i++) {
-    int end = elementNodeIndex[i + 1];
-    for (int jp = elementNodeIndex[i]; jp < end; jp++) {
-      // Check whether this is locally owned or not
-      int node = elementTacsNodes[jp];
+  // Distribute the values at this point
+  xptVec->beginDistributeValues();
+  xptVec->endDistributeValues();
 
-      if (node >= 0) {
-        node = getLocalNodeNum(node);
-        nodeElementPtr[node + 1]++;
-      } else if (node < 0) {
-        // This is a dependent-node, determine which independent
-        // nodes it depends on
-        int dep_node = -node - 1;
-        int kend = depNodePtr[dep_node + 1];
-        for (int kp = depNodePtr[dep_node]; kp < kend; kp++) {
-          node = getLocalNodeNum(depNodeConn[kp]);
-          nodeElementPtr[node + 1]++;
-        }
-      }
+  // Offset the locations of the dependent nodes
+  if (depNodeXptOffsets) {
+    TacsScalar *Xdep;
+    int size = xptVec->getDepArray(&Xdep);
+    for (int i = 0; i < size; i++) {
+      Xdep[i] += depNodeXptOffsets[i];
     }
   }
 
-  // Sum up the total size of the array
-  for (int i = 0; i < numNodes; i++) {
-    nodeElementPtr[i + 1] += nodeElementPtr[i];
-  }
-
-  // Allocate space for the nodeToElement connectivity
-  int size = nodeElementPtr[numNodes];
-  int *nodeToElements = new int[size];
-
-  // Loop over the elements again, this time adding the nodes to the
-  // connectivity
-  for (int i = 0; i < numElements; i++) {
-    int end = elementNodeIndex[i + 1];
-    for (int jp = elementNodeIndex[i]; jp < end; jp++) {
-      // Check whether this is locally owned or not
-      int node = elementTacsNodes[jp];
-      if (node >= 0) {
-        node = getLocalNodeNum(node);
-        nodeToElements[nodeElementPtr[node]] = i;
-        nodeElementPtr[node]++;
-      } else if (node < 0) {
-        // This is a dependent-node, determine which independent
-        // nodes it depends on
-        int dep_node = -node - 1;
-        int kend = depNodePtr[dep_node + 1];
-        for (int kp = depNodePtr[dep_node]; kp < kend; kp++) {
-          node = depNodeConn[kp];
-          node = getLocalNodeNum(node);
-          nodeToElements[nodeElementPtr[node]] = i;
-          nodeElementPtr[node]++;
-        }
+  // The cached element matrices and geometry depend on the node locations
+  if (changed) {
+    clearElementMatCache();
+    if (useElementGeometryCache) {
+      for (int i = 0; i < numElements; i++) {
+        elements[i]->clearGeometryCache();
       }
     }
+    designVersion++;
+    nodeVersion++;
   }
+}
 
-  // Set up the pointer array which denotes the start (and end) of each node
-  for (int i = 0; i < numNodes; i++) {
-    nodeElementPtr[numNodes - i] = nodeElementPtr[numNodes - i - 1];
+/**
+  Get the node locations from TACS
+
+  @param X The nodal coordinates are copied into this vector
+*/
+void TACSAssembler::getNodes(TACSBVec *X) {
+  if (X) {
+    X->copyValues(xptVec);
   }
-  nodeElementPtr[0] = 0;
+}
 
-  // Sort and unquify the CSR data structure
-  TacsSortAndUniquifyCSR(numNodes, nodeElementPtr, nodeToElements);
+/**
+  Get a pointer to the internal nodal coordinate vector
 
-  // Set the output pointers
-  *_nodeToElements = nodeToElements;
-  *_nodeElementPtr = nodeElementPtr;
+  @param X A pointer to the nodal coordinate vector used by this Assembler
+  object
+*/
+void TACSAssembler::getNodes(TACSBVec **X) {
+  if (X) {
+    *X = xptVec;
+  }
 }
 
 /**
-  Set up a CSR data structure pointing from local nodes to other
-  local nodes.
+  Set the auxiliary elements within the TACSAssembler object
 
-  This function works by first estimating the number of entries in
-  each row of the matrix. This information is stored temporarily in
-  the array rowp. After the contributions from the elements and sparse
-  constraints are added, the preceeding elements in rowp are added
-  such that rowp becomes the row pointer for the matrix. Note that
-  this is an upper bound because the elements and constraints may
-  introduce repeated variables. Next, cols is allocated corresponding
-  to the column index for each entry. This iterates back over all
-  elements and constraints. At this stage, rowp is treated as an array
-  of indices, that index into the i-th row of cols[:] where the next
-  index should be inserted. As a result, rowp must be adjusted after
-  this operation is completed.  The last step is to sort and uniquify
-  each row of the matrix.
+  This only needs to be done once sometime during initialization.  If
+  you need to change the loads repeatedly, this can be called
+  repeatedly. No check is made at this point that you haven't done
+  something odd. Note that the code assumes that the elements defined
+  here perfectly overlap the non-zero pattern of the elements set
+  internally within TACS already. This must be called on all
+  processors.
 
-  @param _rowp The row pointer corresponding to CSR data structure
-  @param cols The column indices for each row of the CSR data structure
-  @param nodiag Flag to indicate whether to remove the diagonal matrix entry
+  @param auxElems Auxiliary element object
 */
-void TACSAssembler::computeLocalNodeToNodeCSR(int **_rowp, int **_cols,
-                                              int nodiag) {
-  int *cols = NULL;
-  int *rowp = new int[numNodes + 1];
-  memset(rowp, 0, (numNodes + 1) * sizeof(int));
+void TACSAssembler::setAuxElements(TACSAuxElements *auxElems) {
+  // Check whether the object or its contents have changed on any
+  // processor since they were last set
+  int localChanged = (auxElems != auxElements);
+  if (auxElems && auxElems->getVersion() != auxElementsVersion) {
+    localChanged = 1;
+  }
+  int changed = 0;
+  MPI_Allreduce(&localChanged, &changed, 1, MPI_INT, MPI_MAX, tacs_comm);
+  auxElementsVersion = (auxElems ? auxElems->getVersion() : 0);
 
-  // Create the node -> element data structure
-  int *nodeElementPtr = NULL;
-  int *nodeToElements = NULL;
-  computeNodeToElementCSR(&nodeElementPtr, &nodeToElements);
+  // Increase the reference count to the input elements (Note that
+  // the input may be NULL to over-write the internal object
+  if (auxElems) {
+    auxElems->incref();
+  }
 
-  // If we have dependent nodes, use a different algorithm
-  if (depNodes) {
-    const int *depNodePtr = NULL;
-    const int *depNodeConn = NULL;
-    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+  // Decrease the reference count if the old object is not NULL
+  if (auxElements) {
+    auxElements->decref();
+  }
+  auxElements = auxElems;
 
-    // Count the number of nodes associated with each element
-    int *nodeCount = new int[numElements];
-    memset(nodeCount, 0, numElements * sizeof(int));
+  // The cached element matrices include the auxiliary contributions
+  if (changed) {
+    invalidateIncrementalJacobian();
+    designVersion++;
+  }
 
-    for (int i = 0; i < numElements; i++) {
-      int jend = elementNodeIndex[i + 1];
-      for (int jp = elementNodeIndex[i]; jp < jend; jp++) {
-        int node = elementTacsNodes[jp];
-        if (node >= 0) {
-          nodeCount[i]++;
-        } else {
-          // Add the number of independent nodes attached to this
-          // dependent node for later use
-          int dep = -node - 1;
-          nodeCount[i] += depNodePtr[dep + 1] - depNodePtr[dep];
-        }
+  // Check whether the auxiliary elements match
+  if (auxElements) {
+    int naux = 0;
+    TACSAuxElem *aux = NULL;
+    naux = auxElements->getAuxElements(&aux);
+    for (int k = 0; k < naux; k++) {
+      int elem = aux[k].num;
+      if (elem < 0 || elem >= numElements) {
+        fprintf(stderr, "[%d] Element number %d out of range [0,%d)\n", mpiRank,
+                elem, numElements);
+      } else if (elements[elem]->getNumVariables() !=
+                 aux[k].elem->getNumVariables()) {
+        fprintf(stderr, "[%d] Auxiliary element sizes do not match\n", mpiRank);
       }
     }
+  }
+}
 
-    // First, populate rowp by finding the approximate number of
-    // independent nodes per element
-    for (int i = 0; i < numNodes; i++) {
-      for (int jp = nodeElementPtr[i]; jp < nodeElementPtr[i + 1]; jp++) {
-        int elem = nodeToElements[jp];
-        rowp[i + 1] += nodeCount[elem];
-      }
-    }
+/**
+  Retrieve the auxiliary element object from TACSAssembler
 
-    // Make a conservative estimate of the rowp pointer data
-    for (int i = 0; i < numNodes; i++) {
-      rowp[i + 1] += rowp[i];
-    }
+  Note that the auxiliary element object may be NULL
 
-    // Set up the column indices for each row - label each one with
-    // a negative index so that we know what has not been set
-    int nnz = rowp[numNodes];
-    cols = new int[nnz];
-    for (int i = 0; i < nnz; i++) {
-      cols[i] = -1;
-    }
+  @return The auxiliary element object
+*/
+TACSAuxElements *TACSAssembler::getAuxElements() { return auxElements; }
 
-    // Add the element contribution to the column indices
-    for (int i = 0; i < numNodes; i++) {
-      for (int jp = nodeElementPtr[i]; jp < nodeElementPtr[i + 1]; jp++) {
-        int elem = nodeToElements[jp];
-
-        // Scan through all the nodes belonging to this element
-        int kend = elementNodeIndex[elem + 1];
-        int row = rowp[i];
-        for (int kp = elementNodeIndex[elem]; kp < kend; kp++) {
-          int node = elementTacsNodes[kp];
-          if (node >= 0) {
-            node = getLocalNodeNum(node);
-            cols[row] = node;
-            row++;
-          } else {
-            // This is a dependent-node, determine which independent
-            // nodes it depends on
-            int dep_node = -node - 1;
-            int pend = depNodePtr[dep_node + 1];
-            for (int p = depNodePtr[dep_node]; p < pend; p++) {
-              node = depNodeConn[p];
-              node = getLocalNodeNum(node);
-              cols[row] = node;
-              row++;
-            }
-          }
-        }
+/**
+  Set a uniform inertial load and a centrifugal load on all elements
+
+  The loads are created from the element objects with
+  createElementInertialForce() and createElementCentrifugalForce(),
+  but only once for each distinct element object, and are applied
+  directly within the element loops in assembleRes(),
+  assembleJacobian(), the fused residual and function evaluation and
+  the adjoint-residual products. This avoids the auxiliary element
+  entry for every element and the additional sort and search of the
+  auxiliary elements. The body loads are scaled by the load factor in
+  the same way as the auxiliary elements. Elements that do not
+  implement the load are skipped. This must be called on all
+  processors.
+
+  @param inertiaVec The acceleration vector (may be NULL)
+  @param omegaVec The angular velocity vector (may be NULL)
+  @param rotCenter The center of rotation (NULL for the origin)
+  @param first_order Evaluate the centrifugal load in the displaced position
+*/
+void TACSAssembler::setBodyLoads(const TacsScalar inertiaVec[],
+                                 const TacsScalar omegaVec[],
+                                 const TacsScalar rotCenter[],
+                                 int first_order) {
+  clearBodyLoads();
+  if (!inertiaVec && !omegaVec) {
+    return;
+  }
 
-        // Reset the pointer to this row
-        rowp[i] = row;
-      }
-    }
+  TacsScalar center[3] = {0.0, 0.0, 0.0};
+  if (rotCenter) {
+    memcpy(center, rotCenter, 3 * sizeof(TacsScalar));
+  }
 
-    // Adjust rowp back to a zero-based index
-    for (int i = numNodes; i > 0; i--) {
-      rowp[i] = rowp[i - 1];
-    }
-    rowp[0] = 0;
+  // Create the loads once for each distinct element object. The map
+  // stores the first element that uses each object.
+  std::unordered_map<TACSElement *, int> objElems;
+  bodyLoads = new TACSElement *[2 * numElements];
+  bodyLoadObjs = new TACSElement *[2 * numElements];
+  numBodyLoadObjs = 0;
+  for (int i = 0; i < numElements; i++) {
+    std::pair<std::unordered_map<TACSElement *, int>::iterator, bool> entry =
+        objElems.insert(std::make_pair(elements[i], i));
 
-    delete[] nodeCount;
-  } else {
-    // First, populate rowp by adding the contribution to a node from
-    // all adjacent elements.
-    for (int i = 0; i < numNodes; i++) {
-      for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
-        int elem = nodeToElements[j];
-        rowp[i + 1] += elementNodeIndex[elem + 1] - elementNodeIndex[elem];
+    if (entry.second) {
+      TACSElement *inertial = NULL, *centrifugal = NULL;
+      if (inertiaVec) {
+        inertial = elements[i]->createElementInertialForce(inertiaVec);
       }
-    }
-
-    // Make a conservative estimate of rowp
-    for (int i = 0; i < numNodes; i++) {
-      rowp[i + 1] += rowp[i];
-    }
-
-    // Set up the column indices for each row
-    int nnz = rowp[numNodes];
-    cols = new int[nnz];
-    for (int i = 0; i < nnz; i++) {
-      cols[i] = -1;
-    }
-
-    // Add the element contribution to the column indices
-    for (int i = 0; i < numNodes; i++) {
-      for (int jp = nodeElementPtr[i]; jp < nodeElementPtr[i + 1]; jp++) {
-        int elem = nodeToElements[jp];
-
-        // Add the columns to this row of the sparse matrix
-        int row = rowp[i];
-        int kend = elementNodeIndex[elem + 1];
-        for (int kp = elementNodeIndex[elem]; kp < kend; kp++) {
-          int node = elementTacsNodes[kp];
-          node = getLocalNodeNum(node);
-          cols[row] = node;
-          row++;
-        }
-        rowp[i] = row;
+      if (omegaVec) {
+        centrifugal = elements[i]->createElementCentrifugalForce(
+            omegaVec, center, first_order);
+      }
+      if (inertial) {
+        inertial->incref();
+        bodyLoadObjs[numBodyLoadObjs] = inertial;
+        numBodyLoadObjs++;
+      }
+      if (centrifugal) {
+        centrifugal->incref();
+        bodyLoadObjs[numBodyLoadObjs] = centrifugal;
+        numBodyLoadObjs++;
       }
-    }
 
-    // Adjust rowp back to a zero-based index
-    for (int i = numNodes; i > 0; i--) {
-      rowp[i] = rowp[i - 1];
+      bodyLoads[2 * i] = inertial;
+      bodyLoads[2 * i + 1] = centrifugal;
+    } else {
+      int first = entry.first->second;
+      bodyLoads[2 * i] = bodyLoads[2 * first];
+      bodyLoads[2 * i + 1] = bodyLoads[2 * first + 1];
     }
-    rowp[0] = 0;
   }
 
-  // Go through and sort/uniquify each row and remove
-  // the diagonal if requested
-  TacsSortAndUniquifyCSR(numNodes, rowp, cols, nodiag);
-
-  delete[] nodeElementPtr;
-  delete[] nodeToElements;
-
-  *_rowp = rowp;
-  *_cols = cols;
+  // The cached element matrices include the body load contributions
+  invalidateIncrementalJacobian();
+  loadVersion++;
 }
 
 /**
-  Prepare a reduced CSR data structure corresponding to a matrix
-  formed from a selection of the global matrix. This routine can be
-  used in matrix/variable re-ordering computations.
+  Remove the body loads set by setBodyLoads()
+*/
+void TACSAssembler::clearBodyLoads() {
+  if (bodyLoads) {
+    for (int i = 0; i < numBodyLoadObjs; i++) {
+      bodyLoadObjs[i]->decref();
+    }
+    delete[] bodyLoads;
+    delete[] bodyLoadObjs;
+    bodyLoads = NULL;
+    bodyLoadObjs = NULL;
+    numBodyLoadObjs = 0;
+    invalidateIncrementalJacobian();
+    loadVersion++;
+  }
+}
 
-  This function uses the same algorithm as computeLocalNodeToNodeCSR,
-  but performs extra operations required to restrict the computations
-  to Ar.  The rnodes array must consist of nrnodes non-negative
-  integers between 0 and nrnodes-1, at any arbitrary location. All
-  remaining entries of rnodes must be negative.
+/**
+  Get the number of changes to the nodes, design variables or auxiliary
+  elements
 
-  @param rowp The row pointer corresponding to CSR data structure
-  @param cols The column indices for each row of the CSR data structure
-  @param nrnodes The number of reduced nodes
-  @param rnodes The indices of the reduced nodes
-  @param nodiag Flag to indicate whether to remove the diagonal matrix entry
+  Objects that store data computed from the model, such as a factored
+  matrix, can compare this value to detect whether the data is stale.
+  Setting the nodes or design variables to their current values does
+  not change the version.
 */
-void TACSAssembler::computeLocalNodeToNodeCSR(int **_rowp, int **_cols,
-                                              int nrnodes, const int *rnodes,
-                                              int nodiag) {
-  int *cols = NULL;
-  int *rowp = new int[nrnodes + 1];
-  memset(rowp, 0, (nrnodes + 1) * sizeof(int));
+int TACSAssembler::getDesignVersion() { return designVersion; }
 
-  // Create/get the node -> element data structure
-  int *nodeElementPtr = NULL;
-  int *nodeToElements = NULL;
-  computeNodeToElementCSR(&nodeElementPtr, &nodeToElements);
+/**
+  Get the number of changes to the node locations
 
-  if (depNodes) {
-    const int *depNodePtr = NULL;
-    const int *depNodeConn = NULL;
-    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+  Changes to the nodes also increment the design version.
+*/
+int TACSAssembler::getNodeVersion() { return nodeVersion; }
 
-    // Count the number of nodes associated with each element
-    int *nodeCount = new int[numElements];
-    memset(nodeCount, 0, numElements * sizeof(int));
+/**
+  Get the number of changes to the body loads
 
-    for (int i = 0; i < numElements; i++) {
-      int jend = elementNodeIndex[i + 1];
-      for (int j = elementNodeIndex[i]; j < jend; j++) {
-        int node = elementTacsNodes[j];
+  The body loads contribute to the residual and the Jacobian but not to
+  the design-dependent data, so they do not change the design version.
+  Objects that store a Jacobian should compare this value as well.
+*/
+int TACSAssembler::getLoadVersion() { return loadVersion; }
 
-        if (node >= 0) {
-          // Convert to the local node number
-          node = getLocalNodeNum(node);
-          if (rnodes[node] >= 0) {
-            nodeCount[i]++;
-          }
-        } else {
-          // Find the dependent node
-          int dep = -node - 1;
-          for (int k = depNodePtr[dep]; k < depNodePtr[dep + 1]; k++) {
-            node = getLocalNodeNum(depNodeConn[k]);
-            if (rnodes[node] >= 0) {
-              nodeCount[i]++;
-            }
-          }
-        }
-      }
-    }
+/**
+  Get the number of changes to the state variables or their time
+  derivatives made through TACSAssembler
+*/
+int TACSAssembler::getStateVersion() { return stateVersion; }
 
-    // Count up the contribution to the rowp array from all elements
-    // using the node->element data
-    for (int i = 0; i < numNodes; i++) {
-      int node = rnodes[i];
-      if (node >= 0) {
-        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
-          int elem = nodeToElements[j];
-          rowp[node + 1] += nodeCount[elem];
-        }
-      }
-    }
+/**
+  Compute the external list of nodes and sort these nodes
 
-    // Make a conservative estimate of rowp
-    for (int i = 0; i < nrnodes; i++) {
-      rowp[i + 1] = rowp[i + 1] + rowp[i];
-    }
+  This code is called automatically by TACSAssembler and is private.
+  This code computes numExtNodes and allocates the array
+  tacsExtNodeNums for use in other functions. This function should
+  only be called once during reordering or during initialization.
 
-    // Set up the column indices for each row
-    int nnz = rowp[nrnodes];
-    cols = new int[nnz];
+  @return Fail flag indicating if a failure occured
+*/
+int TACSAssembler::computeExtNodes() {
+  TACSProfileScope scope("TACSAssembler::computeExtNodes");
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call computeExtNodes() after initialize()\n",
+            mpiRank);
+    return 1;
+  }
+  if (!elementNodeIndex) {
+    fprintf(stderr,
+            "[%d] Cannot call computeExtNodes() element "
+            "connectivity not defined\n",
+            mpiRank);
+    return 1;
+  }
 
-    // Add the element contribution to the column indices
-    for (int i = 0; i < numNodes; i++) {
-      int node = rnodes[i];
-      if (node >= 0) {
-        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
-          int elem = nodeToElements[j];
-          int kend = elementNodeIndex[elem + 1];
+  // Get the ownership range of the nodes
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
 
-          // Scan through all the nodes belonging to this element
-          int row = rowp[node];
-          for (int k = elementNodeIndex[elem]; k < kend; k++) {
-            int local = elementTacsNodes[k];
-            if (local >= 0) {
-              // Get the local node number
-              local = getLocalNodeNum(local);
-              int rn = rnodes[local];
-              // This is an independent node
-              if (rn >= 0) {
-                cols[row] = rn;
-                row++;
-              }
-            } else {
-              // This is a dependent node, add the dependent node
-              // variables
-              int dep = -local - 1;
-              int pend = depNodePtr[dep + 1];
-              for (int p = depNodePtr[dep]; p < pend; p++) {
-                local = depNodeConn[p];
-                local = getLocalNodeNum(local);
-                int rn = rnodes[local];
-                if (rn >= 0) {
-                  cols[row] = rn;
-                  row++;
-                }
-              }
-            }
-          }
-          rowp[node] = row;
-        }
-      }
-    }
+  // Find the maximum possible size of array
+  int max_size = elementNodeIndex[numElements];
 
-    // Adjust rowp back to a zero-based index
-    for (int i = nrnodes; i > 0; i--) {
-      rowp[i] = rowp[i - 1];
-    }
-    rowp[0] = 0;
+  // Get the dependent node connectivity information (if any) and
+  // increase the size of the array to account for any external dependent
+  // nodes we may find.
+  const int *depNodePtr = NULL;
+  const int *depNodeConn = NULL;
+  if (depNodes) {
+    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+    max_size += depNodePtr[numDependentNodes];
+  }
 
-    delete[] nodeCount;
-  } else {
-    // First, populate rowp by adding the contribution to a node from
-    // all adjacent elements.
-    for (int i = 0; i < numNodes; i++) {
-      int node = rnodes[i];
-      if (node >= 0) {
-        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
-          int elem = nodeToElements[j];
-          // Count up the number of reduced nodes that are required here.
-          int count = 0;
-          for (int k = elementNodeIndex[elem]; k < elementNodeIndex[elem + 1];
-               k++) {
-            int local = elementTacsNodes[k];
-            local = getLocalNodeNum(local);
-            if (rnodes[local] >= 0) {
-              count++;
-            }
-          }
+  // Keep track of the external nodes that we've found
+  int ext_size = 0;
+  int *ext_list = new int[max_size];
 
-          rowp[node + 1] += count;
-        }
-      }
-    }
+  // First loop over the element connectivity
+  for (int i = 0; i < elementNodeIndex[numElements]; i++) {
+    int node = elementTacsNodes[i];
 
-    // Make a conservative estimate of rowp
-    for (int i = 0; i < nrnodes; i++) {
-      rowp[i + 1] = rowp[i + 1] + rowp[i];
+    // Check if the node is external
+    if ((node >= 0) &&
+        (node < ownerRange[mpiRank] || node >= ownerRange[mpiRank + 1])) {
+      ext_list[ext_size] = node;
+      ext_size++;
     }
+  }
 
-    // Set up the column indices for each row
-    int nnz = rowp[nrnodes];
-    cols = new int[nnz];
+  // Loop over the dependent nodes
+  if (depNodes) {
+    int end = depNodePtr[numDependentNodes];
+    for (int i = 0; i < end; i++) {
+      int node = depNodeConn[i];
 
-    // Add the element contribution to the column indices
-    for (int i = 0; i < numNodes; i++) {
-      int node = rnodes[i];
-      if (node >= 0) {
-        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
-          int elem = nodeToElements[j];
-          int row = rowp[node];
-          for (int k = elementNodeIndex[elem]; k < elementNodeIndex[elem + 1];
-               k++) {
-            int local = elementTacsNodes[k];
-            local = getLocalNodeNum(local);
-            int rn = rnodes[local];
-            if (rn >= 0) {
-              cols[row] = rn;
-              row++;
-            }
-          }
-          rowp[node] = row;
-        }
+      // Check if the node is external
+      if ((node >= 0) &&
+          (node < ownerRange[mpiRank] || node >= ownerRange[mpiRank + 1])) {
+        ext_list[ext_size] = node;
+        ext_size++;
       }
     }
-
-    // Adjust rowp back to a zero-based index
-    for (int i = nrnodes; i > 0; i--) {
-      rowp[i] = rowp[i - 1];
-    }
-    rowp[0] = 0;
   }
 
-  // Go through and sort/uniquify each row and remove
-  // the diagonal if requested
-  TacsSortAndUniquifyCSR(nrnodes, rowp, cols, nodiag);
+  // Sort the list of nodes
+  numExtNodes = TacsUniqueSort(ext_size, ext_list);
 
-  // Free the node -> element data structure
-  delete[] nodeToElements;
-  delete[] nodeElementPtr;
+  // Allocate an array of the external nodes that is tight
+  // to the number of external nodes
+  tacsExtNodeNums = new int[numExtNodes];
+  memcpy(tacsExtNodeNums, ext_list, numExtNodes * sizeof(int));
 
-  *_rowp = rowp;
-  *_cols = cols;
+  // Free the original list of external nodes;
+  delete[] ext_list;
+
+  // Now the total number of nodes is equal to the external nodes
+  // plus the locally owned nodes
+  numNodes = numOwnedNodes + numExtNodes;
+
+  // Find the offset into the external node list
+  extNodeOffset = 0;
+  while (extNodeOffset < numExtNodes &&
+         tacsExtNodeNums[extNodeOffset] < ownerRange[mpiRank]) {
+    extNodeOffset++;
+  }
+
+  return 0;
 }
 
 /**
-  Compute the local node numbers that correspond to the coupling
-  nodes connected to elements on other processes.
+  Compute a reordering of the nodes.
 
-  Sort the global node numbers. Match the intervals and send them off
-  to the owning process. On the owner, scan through the arrays until
-  all the local coupling nodes are found.
+  This function should be called after the element connectivity,
+  boundary conditions and optionally the dependent nodes are set, but
+  before the call to initialize().
 
-  @param couplingNodes Local node numbers of the coupling nodes
-  @param extPtr Pointer into the external node array (may be NULL)
-  @param extCount External node count (may be NULL)
-  @param recvPtr Incoming external ptr from other processors (may be NULL)
-  @param recvCount Incoming external node count (may be NULL)
-  @param recvNodes The incoming nodes from other procs (may be NULL)
-*/
-int TACSAssembler::computeCouplingNodes(int **_couplingNodes, int **_extPtr,
-                                        int **_extCount, int **_recvPtr,
-                                        int **_recvCount, int **_recvNodes) {
-  // Get the ownership range and match the intervals of ownership
-  const int *ownerRange;
-  nodeMap->getOwnerRange(&ownerRange);
+  This code computes and stores a reordering based on both the matrix
+  type and the ordering type. The matrix type determines what
+  constitutes a coupling node and what does not. The matrix type only
+  impacts the ordering in parallel computations.
 
-  // Get the external node numbers
-  const int *extNodes = tacsExtNodeNums;
-  if (extDistIndices) {
-    extDistIndices->getIndices(&extNodes);
-  }
+  The algorithm proceeds as follows:
 
-  // Match the intervals for the external node numbers
-  int *extPtr = new int[mpiSize + 1];
-  int *extCount = new int[mpiSize];
-  TacsMatchIntervals(mpiSize, ownerRange, numExtNodes, extNodes, extPtr);
+  1. Compute the coupling nodes referenced by another processor
+  2. Order the locally owned nodes based on the input ordering.
+  3. Based on the recvied coupling nodes, set the outgoing node
+  numbers back into the recieving array.
+  4. Set the new values of the nodes on the requesting processes
 
-  // Send the nodes owned by other processors the information. First
-  // count up how many will go to each process.
-  for (int i = 0; i < mpiSize; i++) {
-    extCount[i] = extPtr[i + 1] - extPtr[i];
-    if (i == mpiRank) {
-      extCount[i] = 0;
-    }
+  @param order_type The type of ordering to apply
+  @param mat_type The anticipated matrix distribution type
+*/
+void TACSAssembler::computeReordering(OrderingType order_type,
+                                      MatrixOrderingType mat_type) {
+  TACSProfileScope scope("TACSAssembler::computeReordering");
+  // Return if the element connectivity not set
+  if (!elementNodeIndex) {
+    fprintf(stderr, "[%d] Must define element connectivity before reordering\n",
+            mpiRank);
+    return;
+  }
+  if (tacsExtNodeNums) {
+    fprintf(stderr,
+            "[%d] TACSAssembler::computeReordering() can only be called once\n",
+            mpiRank);
+    return;
   }
 
-  int *recvCount = new int[mpiSize];
-  int *recvPtr = new int[mpiSize + 1];
-  MPI_Alltoall(extCount, 1, MPI_INT, recvCount, 1, MPI_INT, tacs_comm);
+  // Compute the external nodes
+  computeExtNodes();
 
-  // Now prepare to send the node numbers to the other processors
-  recvPtr[0] = 0;
-  for (int i = 0; i < mpiSize; i++) {
-    recvPtr[i + 1] = recvPtr[i] + recvCount[i];
-  }
+  // Compute the local node numbers that correspond to the coupling
+  // nodes between processors
+  int *couplingNodes;
+  int *extPtr, *extCount;
+  int *recvPtr, *recvCount, *recvNodes;
+  int numCoupling = computeCouplingNodes(&couplingNodes, &extPtr, &extCount,
+                                         &recvPtr, &recvCount, &recvNodes);
 
-  // Number of nodes that will be received from other procs
-  int *recvNodes = new int[recvPtr[mpiSize]];
-  MPI_Alltoallv((void *)extNodes, extCount, extPtr, MPI_INT, recvNodes,
-                recvCount, recvPtr, MPI_INT, tacs_comm);
+  // The new node numbers to be set according to the different
+  // re-ordering schemes
+  int *newNodeNums = new int[numNodes];
 
-  // Sort the recv'd nodes
-  int *recvNodesSorted = NULL;
-  if (_recvNodes) {
-    recvNodesSorted = new int[recvPtr[mpiSize]];
-    memcpy(recvNodesSorted, recvNodes, recvPtr[mpiSize] * sizeof(int));
-  } else {
-    recvNodesSorted = recvNodes;
+  // Metis can't handle the non-zero diagonal in the CSR data structure
+  int removeDiagonal = 0;
+  if (order_type == ND_ORDER) {
+    removeDiagonal = 1;
   }
 
-  // Uniquely sort the recieved nodes
-  int nrecv_unique = TacsUniqueSort(recvPtr[mpiSize], recvNodesSorted);
+  // If using only one processor, order everything. In this case
+  // there is no distinction between local and global ordering.
+  if (mpiSize == 1) {
+    // Compute the local (global since it's serial) node to node
+    // connectivity based on the element connectivity.
+    int *rowp, *cols;
+    computeLocalNodeToNodeCSR(&rowp, &cols, removeDiagonal);
 
-  int num_multipliers = 0;
-  int *multipliers = NULL;
+    // Compute the reordering
+    computeMatReordering(order_type, numNodes, rowp, cols, NULL, newNodeNums);
 
-  if (numMultiplierNodes > 0) {
-    // Count up the number of multiplier nodes (if any). These are not
-    // all of the locally owned multipliers, only those that refer to
-    // external node numbers on other processors.
-    multipliers = new int[numMultiplierNodes];
+    delete[] rowp;
+    delete[] cols;
+  } else if (mat_type == GAUSS_SEIDEL) {
+    // Compute the local node to node connectivity
+    int *rowp, *cols;
+    computeLocalNodeToNodeCSR(&rowp, &cols, removeDiagonal);
 
-    // Add in the multiplier values
-    for (int i = 0; i < numElements; i++) {
-      // Get the multiplier index
-      int multiplier = elements[i]->getMultiplierIndex();
-      if (multiplier >= 0) {
-        // Get the local multiplier index
-        int elem_ptr = elementNodeIndex[i];
+    // Get the owner range
+    const int *ownerRange;
+    nodeMap->getOwnerRange(&ownerRange);
 
-        // Check if the multiplier is locally owned. If it is not, it is
-        // already in the external nodes anyway.
-        int mult_node = elementTacsNodes[elem_ptr + multiplier];
-        if (mult_node >= ownerRange[mpiRank] &&
-            mult_node < ownerRange[mpiRank + 1]) {
-          // Get the element size
-          int size = elementNodeIndex[i + 1] - elem_ptr;
+    // Compute the node types. This is the node type relative to its
+    // owner.
+    int *nodeType = new int[numNodes];
 
-          // Check if any of the nodes are actually external
-          for (int j = 0; j < size; j++) {
-            int node = elementTacsNodes[elem_ptr + j];
+    for (int i = 0; i < numNodes; i++) {
+      // Set the node as a local node type
+      nodeType[i] = 0;
 
-            // Add the multiplier node if it's an external node or or it
-            // is one of the nodes referred to on other procs.
-            if (node < ownerRange[mpiRank] || node >= ownerRange[mpiRank + 1]) {
-              multipliers[num_multipliers] = mult_node;
-              num_multipliers++;
-              break;
-            } else if (TacsSearchArray(node, nrecv_unique, recvNodesSorted)) {
-              multipliers[num_multipliers] = mult_node;
-              num_multipliers++;
-              break;
-            }
-          }
-        }
-      }
-    }
+      // Get the global node number
+      int node = getGlobalNodeNum(i);
 
-    // Uniquely sort the number of multiplier nodes
-    num_multipliers = TacsUniqueSort(num_multipliers, multipliers);
-  }
+      // Get the processor that owns this node
+      int owner = nodeMap->getNodeOwner(node);
 
-  // Count up the number of coupling nodes
-  int numCouplingNodes = nrecv_unique + numExtNodes + num_multipliers;
-  if (_couplingNodes) {
-    int *couplingNodes = new int[numCouplingNodes];
+      // Search the columns for the type of node
+      for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+        // Get the local column index
+        int j = cols[jp];
 
-    // Automatically add in the external node numbers
-    int index = 0;
-    for (int i = 0; i < extNodeOffset; i++, index++) {
-      couplingNodes[index] = i;
-    }
+        // Get the global node number
+        int col = getGlobalNodeNum(j);
 
-    // Add the coupling nodes received from other processors
-    if (num_multipliers > 0) {
-      for (int i = 0, j = 0; (i < nrecv_unique || j < num_multipliers);
-           index++) {
-        if (i < nrecv_unique && j < num_multipliers) {
-          if (recvNodesSorted[i] < multipliers[j]) {
-            couplingNodes[index] = getLocalNodeNum(recvNodesSorted[i]);
-            i++;
-          } else {
-            couplingNodes[index] = getLocalNodeNum(multipliers[j]);
-            j++;
+        if (col < ownerRange[owner]) {
+          if (nodeType[i] == 0) {
+            // Top node type
+            nodeType[i] = 1;
+          } else if (nodeType[i] == 3) {
+            // Mid-node type
+            nodeType[i] = 2;
+          }
+        } else if (col >= ownerRange[owner + 1]) {
+          if (nodeType[i] == 0) {
+            // Bottom node type
+            nodeType[i] = 3;
+          } else if (nodeType[i] == 1) {
+            // Mid-node type
+            nodeType[i] = 2;
           }
-        } else if (i < nrecv_unique) {
-          couplingNodes[index] = getLocalNodeNum(recvNodesSorted[i]);
-          i++;
-        } else if (j < num_multipliers) {
-          couplingNodes[index] = getLocalNodeNum(multipliers[j]);
-          j++;
         }
       }
-    } else {
-      for (int i = 0; i < nrecv_unique; index++, i++) {
-        couplingNodes[index] = getLocalNodeNum(recvNodesSorted[i]);
-      }
     }
 
-    // Add in the remaining external nodes
-    for (int i = extNodeOffset; i < numExtNodes; i++, index++) {
-      couplingNodes[index] = numOwnedNodes + i;
-    }
+    // This type of connectivity information is no longer required
+    delete[] rowp;
+    delete[] cols;
 
-    *_couplingNodes = couplingNodes;
-  }
+    // We've computed the local node types, but this may be affected
+    // by the contributions from other processors. Now, perform some
+    // collective communication to globalize the node type
+    // information. This will order all the internal nodes first,
+    // followed by the top nodes, mid nodes and bottom nodes,
+    // respectively.
 
-  // Free the multiplier index
-  if (multipliers) {
-    delete[] multipliers;
+    // Now allocate space for the node types
+    int *sendNodeType = new int[numExtNodes];
+    for (int i = 0; i < numExtNodes; i++) {
+      // Get the local node number
+      int index = getLocalNodeNum(tacsExtNodeNums[i]);
+      sendNodeType[i] = nodeType[index];
+    }
+
+    int *recvNodeType = new int[recvPtr[mpiSize]];
+    MPI_Alltoallv(sendNodeType, extCount, extPtr, MPI_INT, recvNodeType,
+                  recvCount, recvPtr, MPI_INT, tacs_comm);
+
+    // Update the internal node types based on the recv'd values
+    for (int i = 0; i < recvPtr[mpiSize]; i++) {
+      int node = getLocalNodeNum(recvNodes[i]);
+
+      if (nodeType[node] == 0) {
+        // Set the node type as the recv node type
+        nodeType[node] = recvNodeType[i];
+      } else if (nodeType[node] != recvNodeType[i]) {
+        // Mid-node type
+        nodeType[node] = 2;
+      }
+    }
+
+    // Free the allocated data
+    delete[] sendNodeType;
+    delete[] recvNodeType;
+
+    // So now the local nodes have the correct node types,
+    // compute the local ordering.
+    int *reducedNodes = new int[numNodes];
+    memset(reducedNodes, 0, numNodes * sizeof(int));
+
+    // Exclude all the nodes that are external to this processor
+    for (int i = 0; i < extNodeOffset; i++) {
+      reducedNodes[i] = -1;
+    }
+    for (int i = extNodeOffset + numOwnedNodes; i < numNodes; i++) {
+      reducedNodes[i] = -1;
+    }
+
+    // Loop over all of the node types. This will order all the
+    // internal nodes first
+    int offset = ownerRange[mpiRank];
+    for (int ntype = 0; ntype < 4; ntype++) {
+      int numReducedNodes = 0;
+      for (int i = extNodeOffset; i < extNodeOffset + numOwnedNodes; i++) {
+        if (nodeType[i] == ntype) {
+          reducedNodes[i] = numReducedNodes;
+          numReducedNodes++;
+        } else {
+          reducedNodes[i] = -1;
+        }
+      }
+
+      if (numReducedNodes > 0) {
+        // Compute the reordering for the reduced set of nodes
+        int *newReducedNodes = new int[numReducedNodes];
+        int *reduced_rowp, *reduced_cols;
+        computeLocalNodeToNodeCSR(&reduced_rowp, &reduced_cols, numReducedNodes,
+                                  reducedNodes, removeDiagonal);
+        computeMatReordering(order_type, numReducedNodes, reduced_rowp,
+                             reduced_cols, NULL, newReducedNodes);
+        delete[] reduced_rowp;
+        delete[] reduced_cols;
+
+        // Set the new variable numbers for the boundary nodes
+        // and include their offset
+        for (int i = 0, j = 0; i < numNodes; i++) {
+          if (reducedNodes[i] >= 0) {
+            newNodeNums[i] = offset + newReducedNodes[j];
+            j++;
+          }
+        }
+
+        offset += numReducedNodes;
+
+        // Free the new node numbers
+        delete[] newReducedNodes;
+      }
+    }
+
+    // Free the node type array
+    delete[] nodeType;
+  } else {
+    // First, find the reduced nodes - the set of nodes that are only
+    // referenced by this processor. These can be reordered without
+    // affecting other processors.
+    int *reducedNodes = new int[numNodes];
+    memset(reducedNodes, 0, numNodes * sizeof(int));
+
+    // Exclude all the nodes that are external to this processor
+    for (int i = 0; i < extNodeOffset; i++) {
+      reducedNodes[i] = -1;
+    }
+    for (int i = extNodeOffset + numOwnedNodes; i < numNodes; i++) {
+      reducedNodes[i] = -1;
+    }
+
+    // Depending on the matrix type, also add the external dependent
+    // nodes and nodes that also couple to those nodes
+    if (mat_type == DIRECT_SCHUR) {
+      for (int i = 0; i < numCoupling; i++) {
+        int node = couplingNodes[i];
+        reducedNodes[node] = -1;
+      }
+    } else if (mat_type == APPROXIMATE_SCHUR) {
+      // If we want an approximate schur ordering, where the nodes
+      // that couple to other processors are ordered last, we also add
+      // these nodes to the reduced set.
+      int *rowp, *cols;
+      computeLocalNodeToNodeCSR(&rowp, &cols);
+
+      // Order all nodes linked by an equation to an external node
+      // This ordering is required for the approximate Schur method
+      for (int i = 0; i < numCoupling; i++) {
+        int node = couplingNodes[i];
+        for (int jp = rowp[node]; jp < rowp[node + 1]; jp++) {
+          reducedNodes[cols[jp]] = -1;
+        }
+      }
+
+      delete[] rowp;
+      delete[] cols;
+    }
+
+    // Now, order all nodes that are non-negative
+    int numReducedNodes = 0;
+    for (int i = 0; i < numNodes; i++) {
+      if (reducedNodes[i] >= 0) {
+        reducedNodes[i] = numReducedNodes;
+        numReducedNodes++;
+      }
+    }
+
+    // Compute the reordering for the reduced set of nodes
+    int *newReducedNodes = new int[numReducedNodes];
+    int *rowp, *cols;
+    computeLocalNodeToNodeCSR(&rowp, &cols, numReducedNodes, reducedNodes,
+                              removeDiagonal);
+    computeMatReordering(order_type, numReducedNodes, rowp, cols, NULL,
+                         newReducedNodes);
+    delete[] rowp;
+    delete[] cols;
+
+    // Place the result back into the newNodeNums - add the
+    // ownership offset
+    const int *ownerRange;
+    nodeMap->getOwnerRange(&ownerRange);
+    int offset = ownerRange[mpiRank];
+    for (int i = 0, j = 0; i < numNodes; i++) {
+      if (reducedNodes[i] >= 0) {
+        newNodeNums[i] = offset + newReducedNodes[j];
+        j++;
+      }
+    }
+
+    delete[] newReducedNodes;
+
+    // Add the offset to the total number of reduced nodes
+    offset += numReducedNodes;
+
+    // Now, order any remaining variables that have not yet been
+    // ordered. These are the coupling variables (if any) that
+    // have been labeled before.
+    numReducedNodes = 0;
+    for (int i = extNodeOffset; i < extNodeOffset + numOwnedNodes; i++) {
+      // If the node has not been ordered and is within the ownership
+      // range of this process, order it now.
+      if (reducedNodes[i] < 0) {
+        reducedNodes[i] = numReducedNodes;
+        numReducedNodes++;
+      } else {
+        reducedNodes[i] = -1;
+      }
+    }
+
+    if (numReducedNodes > 0) {
+      // Additive Schwarz ordering should number all locally owned
+      // nodes first, and should not require this second ordering.
+      if (mat_type == ADDITIVE_SCHWARZ) {
+        fprintf(stderr, "[%d] Error in additive Schwarz reordering\n", mpiRank);
+      }
+
+      // Order any remaning variables that are locally owned
+      newReducedNodes = new int[numReducedNodes];
+      computeLocalNodeToNodeCSR(&rowp, &cols, numReducedNodes, reducedNodes,
+                                removeDiagonal);
+      computeMatReordering(order_type, numReducedNodes, rowp, cols, NULL,
+                           newReducedNodes);
+
+      // Free the allocate CSR data structure
+      delete[] rowp;
+      delete[] cols;
+
+      // Set the new variable numbers for the boundary nodes
+      // and include their offset
+      for (int i = 0, j = 0; i < numNodes; i++) {
+        if (reducedNodes[i] >= 0) {
+          newNodeNums[i] = offset + newReducedNodes[j];
+          j++;
+        }
+      }
+
+      // Free the new node numbers
+      delete[] newReducedNodes;
+    }
+
+    delete[] reducedNodes;
+  }
+
+  delete[] couplingNodes;
+
+  // Apply the new node numbers to the connectivity, the boundary
+  // conditions and the external nodes
+  applyReordering(newNodeNums, extPtr, extCount, recvPtr, recvCount,
+                  recvNodes);
+}
+
+/**
+  Set the reordering of the nodes directly.
+
+  The new node numbers for the owned nodes are given in the same form
+  as the output from getReordering(), and must lie within the
+  ownership range of this processor. This can be used to restore a
+  reordering computed with computeReordering() in a previous analysis.
+  Like computeReordering(), this must be called before initialize()
+  and can only be called once.
+
+  @param oldToNew The new node numbers for each of the owned nodes
+*/
+void TACSAssembler::setReordering(const int *oldToNew) {
+  // Return if the element connectivity not set
+  if (!elementNodeIndex) {
+    fprintf(stderr, "[%d] Must define element connectivity before reordering\n",
+            mpiRank);
+    return;
+  }
+  if (tacsExtNodeNums) {
+    fprintf(stderr,
+            "[%d] TACSAssembler::setReordering() can only be called once\n",
+            mpiRank);
+    return;
+  }
+
+  // Compute the external nodes
+  computeExtNodes();
+
+  // Compute the nodes that are sent to and received from other
+  // processors
+  int *couplingNodes;
+  int *extPtr, *extCount;
+  int *recvPtr, *recvCount, *recvNodes;
+  computeCouplingNodes(&couplingNodes, &extPtr, &extCount, &recvPtr,
+                       &recvCount, &recvNodes);
+  delete[] couplingNodes;
+
+  // Set the new node numbers for the owned nodes
+  int *newNodeNums = new int[numNodes];
+  for (int i = 0; i < numOwnedNodes; i++) {
+    newNodeNums[extNodeOffset + i] = oldToNew[i];
+  }
+
+  applyReordering(newNodeNums, extPtr, extCount, recvPtr, recvCount,
+                  recvNodes);
+}
+
+/*
+  Apply the new node numbers to the element connectivity, the
+  dependent nodes, the boundary conditions and the external nodes.
+
+  On input, newNodeNums contains the new node numbers for the owned
+  nodes. The new numbers for the external nodes are obtained from
+  their owners. This function takes ownership of all of the arrays.
+*/
+void TACSAssembler::applyReordering(int *newNodeNums, int *extPtr,
+                                    int *extCount, int *recvPtr,
+                                    int *recvCount, int *recvNodes) {
+  TACSProfileScope scope("TACSAssembler::applyReordering");
+  // So now we have new node numbers for the nodes owned by this
+  // processor, but the other processors do not have these new numbers
+  // yet. Find the values assigned to the nodes requested from
+  // external nodes recv_nodes is now an outgoing list of nodes to
+  // other processes
+  for (int i = 0; i < recvPtr[mpiSize]; i++) {
+    int node = getLocalNodeNum(recvNodes[i]);
+    recvNodes[i] = newNodeNums[node];
+  }
+
+  // Now send the new node numbers back to the other processors
+  // that reference them. This also uses all-to-all communication.
+  int *newExtNodes = new int[extPtr[mpiSize]];
+  MPI_Alltoallv(recvNodes, recvCount, recvPtr, MPI_INT, newExtNodes, extCount,
+                extPtr, MPI_INT, tacs_comm);
+
+  // Once the new node numbers from other processors is received
+  // apply these new node numbers back to the locally owned
+  // reference numbers.
+  for (int i = 0; i < extNodeOffset; i++) {
+    newNodeNums[i] = newExtNodes[i];
+  }
+  for (int i = extNodeOffset; i < numExtNodes; i++) {
+    newNodeNums[i + numOwnedNodes] = newExtNodes[i];
+  }
+
+  // Free the new external node numbers
+  delete[] newExtNodes;
+
+  // Reorder the local dependent node connectivity
+  int *depConn = NULL;
+  const int *depPtr = NULL;
+  if (depNodes) {
+    depNodes->getDepNodeReorder(&depPtr, &depConn);
+    int end = depPtr[numDependentNodes];
+    for (int i = 0; i < end; i++) {
+      int node = getLocalNodeNum(depConn[i]);
+      depConn[i] = newNodeNums[node];
+    }
+  }
+
+  // Reorder the element connectivity
+  int end = elementNodeIndex[numElements];
+  for (int i = 0; i < end; i++) {
+    int node = elementTacsNodes[i];
+    if (node >= 0) {
+      node = getLocalNodeNum(node);
+      elementTacsNodes[i] = newNodeNums[node];
+    }
+  }
+
+  // If boundary conditions are set, reorder them
+  if (bcMap) {
+    int *nodeNums;
+    int nbcs = bcMap->getBCNodeNums(&nodeNums);
+    for (int i = 0; i < nbcs; i++) {
+      int node = getLocalNodeNum(nodeNums[i]);
+      nodeNums[i] = newNodeNums[node];
+    }
+  }
+  if (bcInitMap) {
+    int *nodeNums;
+    int nbcs = bcInitMap->getBCNodeNums(&nodeNums);
+    for (int i = 0; i < nbcs; i++) {
+      int node = getLocalNodeNum(nodeNums[i]);
+      nodeNums[i] = newNodeNums[node];
+    }
+  }
+
+  // Finaly, reorder the external node numbers
+  for (int i = 0; i < extNodeOffset; i++) {
+    tacsExtNodeNums[i] = newNodeNums[i];
+  }
+  for (int i = extNodeOffset; i < numExtNodes; i++) {
+    tacsExtNodeNums[i] = newNodeNums[i + numOwnedNodes];
+  }
+
+  // Resort the external node numbers - these are already unique and
+  // the extNodeOffset should not change either
+  TacsUniqueSort(numExtNodes, tacsExtNodeNums);
+
+  // Save the mapping to the new numbers for later reorderings
+  newNodeIndices = new TACSBVecIndices(&newNodeNums, numNodes);
+  newNodeIndices->incref();
+
+  delete[] extPtr;
+  delete[] extCount;
+  delete[] recvPtr;
+  delete[] recvCount;
+  delete[] recvNodes;
+}
+
+/**
+  Compute the reordering for the given matrix.
+
+  This uses either Reverse Cuthill-McKee (RCM_ORDER), Approximate
+  Minimum Degree (AMD) or Nested Disection (ND) to compute a
+  reordering of the variables.
+
+  The input to the function is a CSR-type data structure of the
+  matrix. Note that for ND (with the external package Metis), requires
+  that the diagonal be eliminated from the CSR data structure. (This
+  modified data structure can be computed with the no_diagonal flag
+  when calling the CSR creation routines.)
+
+  The matrix ordering routines compute a reordering such that:
+
+  P*A*P^{T} has fewer non-zeros.
+
+  The function returns an array new_vars such that:
+
+  new_vars = P^{T} old_vars
+  perm = P
+
+  @param order_type The ordering type
+  @param nvars The number of variables
+  @param rowp Pointer into each new row of the matrix
+  @param cols Column indices for each row
+  @param perm Permutation array
+  @param new_vars New variable array
+*/
+void TACSAssembler::computeMatReordering(OrderingType order_type, int nvars,
+                                         int *rowp, int *cols, int *perm,
+                                         int *new_vars) {
+  TACSProfileScope scope("TACSAssembler::computeMatReordering");
+  int *_perm = perm;
+  int *_new_vars = new_vars;
+  if (!perm) {
+    _perm = new int[nvars];
+  }
+  if (!new_vars) {
+    _new_vars = new int[nvars];
+  }
+
+  if (order_type == RCM_ORDER) {
+    // Compute the matrix reordering using RCM TACS' version
+    // of the RCM algorithm
+    int root_node = 0;
+    int num_rcm_iters = 1;
+    TacsComputeRCMOrder(nvars, rowp, cols, _new_vars, root_node, num_rcm_iters);
+
+    if (perm) {
+      for (int k = 0; k < nvars; k++) {
+        perm[_new_vars[k]] = k;
+      }
+    }
+  } else if (order_type == AMD_ORDER) {
+#if TACS_HAS_AMD_LIBRARY
+    // Use the approximate minimum degree ordering
+    double control[AMD_CONTROL], info[AMD_INFO];
+    amd_defaults(control);  // Use the default values
+    amd_order(nvars, rowp, cols, _perm, control, info);
+
+    if (new_vars) {
+      for (int k = 0; k < nvars; k++) {
+        new_vars[_perm[k]] = k;
+      }
+    }
+#else
+    int use_exact_degree = 0;
+    int ncoupling_nodes = 0;
+    int *coupling_nodes = NULL;
+    amd_order_interface(nvars, rowp, cols, _perm, coupling_nodes,
+                        ncoupling_nodes, 0, NULL, NULL, NULL, use_exact_degree);
+
+    if (new_vars) {
+      for (int k = 0; k < nvars; k++) {
+        new_vars[_perm[k]] = k;
+      }
+    }
+#endif  // TACS_HAS_AMD_LIBRARY
+  } else if (order_type == ND_ORDER) {
+    // Set the default options in METIS
+    int options[METIS_NOPTIONS];
+    METIS_SetDefaultOptions(options);
+
+    // Use 0-based numbering
+    options[METIS_OPTION_NUMBERING] = 0;
+    METIS_NodeND(&nvars, rowp, cols, NULL, options, _perm, _new_vars);
+  } else if (order_type == TACS_AMD_ORDER) {
+    int use_exact_degree = 0;
+    int ncoupling_nodes = 0;
+    int *coupling_nodes = NULL;
+    amd_order_interface(nvars, rowp, cols, _perm, coupling_nodes,
+                        ncoupling_nodes, 0, NULL, NULL, NULL, use_exact_degree);
+
+    if (new_vars) {
+      for (int k = 0; k < nvars; k++) {
+        new_vars[_perm[k]] = k;
+      }
+    }
+  } else if (order_type == MULTICOLOR_ORDER) {
+    // Compute the matrix reordering using RCM TACS' version of the
+    // RCM algorithm
+    int *colors = new int[nvars];
+    TacsComputeSerialMultiColor(nvars, rowp, cols, colors, new_vars);
+    delete[] colors;
+
+    if (perm) {
+      for (int k = 0; k < nvars; k++) {
+        perm[_new_vars[k]] = k;
+      }
+    }
+  } else if (order_type == NATURAL_ORDER) {
+    if (perm) {
+      for (int k = 0; k < nvars; k++) {
+        perm[k] = k;
+      }
+    }
+    if (new_vars) {
+      for (int k = 0; k < nvars; k++) {
+        new_vars[k] = k;
+      }
+    }
+  }
+
+  if (!perm) {
+    delete[] _perm;
+  }
+  if (!new_vars) {
+    delete[] _new_vars;
+  }
+}
+
+/**
+  The following function returns a local node number based on the
+  provided (global) TACS node number.
+
+  If the node number is on this processor, no search is required,
+  however, if the node is externally owned, then a binary search is
+  needed to determine the index into the off-processor list of nodes.
+
+  @param node The global TACS node number unique across all processors
+  @return The local node number
+*/
+int TACSAssembler::getLocalNodeNum(int node) {
+  // Get the ownership range
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
+
+  if (node >= ownerRange[mpiRank] && node < ownerRange[mpiRank + 1]) {
+    node = (node - ownerRange[mpiRank]) + extNodeOffset;
+  } else if (node >= 0) {
+    const int *ext_nodes = NULL;
+    if (tacsExtNodeNums) {
+      ext_nodes = tacsExtNodeNums;
+    } else if (extDistIndices) {
+      extDistIndices->getIndices(&ext_nodes);
+    } else {
+      fprintf(stderr, "[%d] External nodes not defined\n", mpiRank);
+      return -1;
+    }
+
+    // Find the local index for external nodes
+    int *item = TacsSearchArray(node, numExtNodes, ext_nodes);
+
+    // Check if the item is found in the list
+    if (item) {
+      if (node < ownerRange[mpiRank]) {
+        node = (item - ext_nodes);
+      } else {
+        node = numOwnedNodes + (item - ext_nodes);
+      }
+    } else {
+      fprintf(stderr, "[%d] External node %d not in external node list\n",
+              mpiRank, node);
+      return -1;
+    }
+  } else {
+    fprintf(stderr, "[%d] Cannot compute local number for dependent node %d\n",
+            mpiRank, node);
+    return -1;
+  }
+
+  return node;
+}
+
+/**
+  Given the local node number find the corresponding global TACS node
+  number
+
+  This function is the inverse of the getLocalNodeNum() function
+  defined above.
+
+  @param node The local node number
+  @return The global TACS node number
+*/
+int TACSAssembler::getGlobalNodeNum(int node) {
+  // Get the ownership range
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
+
+  if (node < extNodeOffset) {
+    const int *ext_nodes = NULL;
+    if (tacsExtNodeNums) {
+      ext_nodes = tacsExtNodeNums;
+    } else if (extDistIndices) {
+      extDistIndices->getIndices(&ext_nodes);
+    } else {
+      fprintf(stderr, "[%d] External nodes not defined\n", mpiRank);
+      return -1;
+    }
+
+    return ext_nodes[node];
+  } else if (node < extNodeOffset + numOwnedNodes) {
+    return (node - extNodeOffset) + ownerRange[mpiRank];
+  } else if (node < numNodes) {
+    const int *ext_nodes = NULL;
+    if (tacsExtNodeNums) {
+      ext_nodes = tacsExtNodeNums;
+    } else if (extDistIndices) {
+      extDistIndices->getIndices(&ext_nodes);
+    } else {
+      fprintf(stderr, "[%d] External nodes not defined\n", mpiRank);
+      return -1;
+    }
+
+    return ext_nodes[node - numOwnedNodes];
+  } else {
+    fprintf(stderr, "[%d] Local node number %d out of range\n", mpiRank, node);
+    return -1;
+  }
+
+  return node;
+}
+
+/*
+  The arguments for the threaded loops that construct the node-based
+  CSR data structures
+*/
+struct TACSNodeCSRArgs {
+  TACSAssembler *assembler;
+  const int *src;
+  int *dest;
+  int nodiag;
+  int *rowp, *cols, *counts;
+  const int *elemPtr, *conn;
+  const int *depPtr, *depConn;
+  const int *nodeElementPtr, *nodeToElements;
+  int *nodeCount;
+};
+
+/*
+  Convert global node numbers to local node numbers, leaving the
+  dependent nodes (negative indices) unchanged
+*/
+static void TacsLocalNodeNumRange(int start, int end, int thread_id,
+                                  void *ctx) {
+  TACSNodeCSRArgs *args = (TACSNodeCSRArgs *)ctx;
+  for (int i = start; i < end; i++) {
+    int node = args->src[i];
+    args->dest[i] = (node >= 0 ? args->assembler->getLocalNodeNum(node) : node);
+  }
+}
+
+/*
+  Count the number of independent nodes referenced by each element
+*/
+static void TacsElementNodeCountRange(int start, int end, int thread_id,
+                                      void *ctx) {
+  TACSNodeCSRArgs *args = (TACSNodeCSRArgs *)ctx;
+  int *nodeCount = args->nodeCount;
+  for (int i = start; i < end; i++) {
+    int count = 0;
+    for (int jp = args->elemPtr[i]; jp < args->elemPtr[i + 1]; jp++) {
+      int node = args->conn[jp];
+      if (node >= 0) {
+        count++;
+      } else {
+        int dep = -node - 1;
+        count += args->depPtr[dep + 1] - args->depPtr[dep];
+      }
+    }
+    nodeCount[i] = count;
+  }
+}
+
+/*
+  Find an upper bound on the length of each row of the node-to-node
+  graph from the elements adjacent to each node
+*/
+static void TacsNodeCSRCountRange(int start, int end, int thread_id,
+                                  void *ctx) {
+  TACSNodeCSRArgs *args = (TACSNodeCSRArgs *)ctx;
+  for (int i = start; i < end; i++) {
+    int count = 0;
+    for (int jp = args->nodeElementPtr[i]; jp < args->nodeElementPtr[i + 1];
+         jp++) {
+      count += args->nodeCount[args->nodeToElements[jp]];
+    }
+    args->rowp[i + 1] = count;
+  }
+}
+
+/*
+  Add the independent nodes of the adjacent elements to each row of
+  the node-to-node graph. Each row is filled from rowp[i], so the rows
+  can be filled independently.
+*/
+static void TacsNodeCSRFillRange(int start, int end, int thread_id,
+                                 void *ctx) {
+  TACSNodeCSRArgs *args = (TACSNodeCSRArgs *)ctx;
+  for (int i = start; i < end; i++) {
+    int *col = &args->cols[args->rowp[i]];
+    for (int jp = args->nodeElementPtr[i]; jp < args->nodeElementPtr[i + 1];
+         jp++) {
+      int elem = args->nodeToElements[jp];
+      for (int kp = args->elemPtr[elem]; kp < args->elemPtr[elem + 1]; kp++) {
+        int node = args->conn[kp];
+        if (node >= 0) {
+          col[0] = node;
+          col++;
+        } else {
+          int dep = -node - 1;
+          for (int p = args->depPtr[dep]; p < args->depPtr[dep + 1]; p++) {
+            col[0] = args->depConn[p];
+            col++;
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+  Sort and uniquify each row in place and store the new length of the
+  row in counts, removing the diagonal entry if requested
+*/
+static void TacsSortCSRRowsRange(int start, int end, int thread_id,
+                                 void *ctx) {
+  TACSNodeCSRArgs *args = (TACSNodeCSRArgs *)ctx;
+  for (int i = start; i < end; i++) {
+    int *row = &args->cols[args->rowp[i]];
+    int size = TacsUniqueSort(args->rowp[i + 1] - args->rowp[i], row);
+    if (args->nodiag) {
+      int *item = TacsSearchArray(i, size, row);
+      if (item) {
+        size--;
+        for (int *p = item; p < &row[size]; p++) {
+          p[0] = p[1];
+        }
+      }
+    }
+    args->counts[i] = size;
+  }
+}
+
+/*
+  Sort and uniquify each row of the CSR data structure in parallel and
+  remove the gaps between the rows. This produces the same result as
+  TacsSortAndUniquifyCSR().
+*/
+static void TacsThreadedSortAndUniquifyCSR(TACSThreadInfo *thread_info,
+                                           int nrows, int *rowp, int *cols,
+                                           int nodiag) {
+  TACSNodeCSRArgs args;
+  memset(&args, 0, sizeof(args));
+  args.nodiag = nodiag;
+  args.rowp = rowp;
+  args.cols = cols;
+  args.counts = new int[nrows];
+  thread_info->parallelFor(nrows, 256, TacsSortCSRRowsRange, &args);
+
+  // Compact the rows
+  int pos = 0;
+  for (int i = 0; i < nrows; i++) {
+    int start = rowp[i];
+    if (start != pos) {
+      memmove(&cols[pos], &cols[start], args.counts[i] * sizeof(int));
+    }
+    rowp[i] = pos;
+    pos += args.counts[i];
+  }
+  rowp[nrows] = pos;
+
+  delete[] args.counts;
+}
+
+/**
+  Convert the element connectivity and the dependent node connectivity
+  to local node numbers. The dependent nodes in the element
+  connectivity are left as negative indices. The conversion requires a
+  search for each external node, so it is performed once and in
+  parallel.
+
+  @param _conn The element connectivity in local node numbers
+  @param _depConn The dependent node connectivity in local node numbers
+*/
+void TACSAssembler::computeLocalConn(int **_conn, int **_depConn) {
+  TACSNodeCSRArgs args;
+  memset(&args, 0, sizeof(args));
+  args.assembler = this;
+
+  int size = elementNodeIndex[numElements];
+  int *conn = new int[size];
+  args.src = elementTacsNodes;
+  args.dest = conn;
+  thread_info->parallelFor(size, 1024, TacsLocalNodeNumRange, &args);
+
+  int *depConn = NULL;
+  if (depNodes) {
+    const int *depNodePtr, *depNodeConn;
+    int ndep = depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+    size = depNodePtr[ndep];
+    depConn = new int[size];
+    args.src = depNodeConn;
+    args.dest = depConn;
+    thread_info->parallelFor(size, 1024, TacsLocalNodeNumRange, &args);
+  }
+
+  *_conn = conn;
+  *_depConn = depConn;
+}
+
+/**
+  The following function creates a data structure that links nodes
+  to elements - this reverses the existing data structure that
+  links elements to nodes but keeps the original in tact.
+
+  The algorithm proceeds as follows:
+
+  1. The size of the arrays are determined by finding how many
+  nodes point to each element
+
+  2. The index into the nodeElem array is determined by adding up
+  the contributions from all previous entries.
+
+  3. The original data structure is again traversed and this time
+  an element number is associated with each element.
+
+  @param _nodeElementPtr Pointer into the array nodeToElements
+  @param _nodeToElements Element index associated with each node
+*/
+void TACSAssembler::computeNodeToElementCSR(int **_nodeElementPtr,
+                                            int **_nodeToElements) {
+  TACSProfileScope scope("TACSAssembler::computeNodeToElementCSR");
+  int *conn, *depConn;
+  computeLocalConn(&conn, &depConn);
+  computeNodeToElementCSR(conn, depConn, _nodeElementPtr, _nodeToElements);
+  delete[] conn;
+  if (depConn) {
+    delete[] depConn;
+  }
+}
+
+/*
+  Compute the node to element data structure from the connectivity in
+  local node numbers
+*/
+void TACSAssembler::computeNodeToElementCSR(const int *conn,
+                                            const int *depConn,
+                                            int **_nodeElementPtr,
+                                            int **_nodeToElements) {
+  // Determine the node->element connectivity using local nodes
+  int *nodeElementPtr = new int[numNodes + 1];
+  memset(nodeElementPtr, 0, (numNodes + 1) * sizeof(int));
+
+  // Get the dependent node connectivity information
+  const int *depNodePtr = NULL;
+  if (depNodes) {
+    depNodes->getDepNodes(&depNodePtr, NULL, NULL);
+  }
+
+  // Loop over all the elements and count up the number of times
+  // each node refers to each element
+  for (int i = 0; i < numElements; i++) {
+    int end = elementNodeIndex[i + 1];
+    for (int jp = elementNodeIndex[i]; jp < end; jp++) {
+      int node = conn[jp];
+      if (node >= 0) {
+        nodeElementPtr[node + 1]++;
+      } else {
+        // This is a dependent-node, determine which independent
+        // nodes it depends on
+        int dep_node = -node - 1;
+        int kend = depNodePtr[dep_node + 1];
+        for (int kp = depNodePtr[dep_node]; kp < kend; kp++) {
+          nodeElementPtr[depConn[kp] + 1]++;
+        }
+      }
+    }
+  }
+
+  // Sum up the total size of the array
+  for (int i = 0; i < numNodes; i++) {
+    nodeElementPtr[i + 1] += nodeElementPtr[i];
+  }
+
+  // Allocate space for the nodeToElement connectivity
+  int size = nodeElementPtr[numNodes];
+  int *nodeToElements = new int[size];
+
+  // Loop over the elements again, this time adding the nodes to the
+  // connectivity
+  for (int i = 0; i < numElements; i++) {
+    int end = elementNodeIndex[i + 1];
+    for (int jp = elementNodeIndex[i]; jp < end; jp++) {
+      int node = conn[jp];
+      if (node >= 0) {
+        nodeToElements[nodeElementPtr[node]] = i;
+        nodeElementPtr[node]++;
+      } else {
+        // This is a dependent-node, determine which independent
+        // nodes it depends on
+        int dep_node = -node - 1;
+        int kend = depNodePtr[dep_node + 1];
+        for (int kp = depNodePtr[dep_node]; kp < kend; kp++) {
+          node = depConn[kp];
+          nodeToElements[nodeElementPtr[node]] = i;
+          nodeElementPtr[node]++;
+        }
+      }
+    }
+  }
+
+  // Set up the pointer array which denotes the start (and end) of each node
+  for (int i = 0; i < numNodes; i++) {
+    nodeElementPtr[numNodes - i] = nodeElementPtr[numNodes - i - 1];
+  }
+  nodeElementPtr[0] = 0;
+
+  // Sort and unquify the CSR data structure
+  TacsThreadedSortAndUniquifyCSR(thread_info, numNodes, nodeElementPtr,
+                                 nodeToElements, 0);
+
+  // Set the output pointers
+  *_nodeToElements = nodeToElements;
+  *_nodeElementPtr = nodeElementPtr;
+}
+
+/**
+  Set up a CSR data structure pointing from local nodes to other
+  local nodes.
+
+  The rows are first filled with the nodes of all the adjacent
+  elements, including the independent nodes of any dependent nodes,
+  and then each row is sorted and uniquified. The connectivity is
+  converted to local node numbers once, and the rows are counted,
+  filled and sorted in parallel.
+
+  Once the mesh is initialized, the connectivity can no longer change,
+  so the graph is computed once and stored. Subsequent calls return a
+  copy of the stored graph.
+
+  @param _rowp The row pointer corresponding to CSR data structure
+  @param cols The column indices for each row of the CSR data structure
+  @param nodiag Flag to indicate whether to remove the diagonal matrix entry
+*/
+void TACSAssembler::computeLocalNodeToNodeCSR(int **_rowp, int **_cols,
+                                              int nodiag) {
+  TACSProfileScope scope("TACSAssembler::computeLocalNodeToNodeCSR");
+  if (!nodeCSRRowp) {
+    int *rowp, *cols;
+    computeNodeToNodeGraph(&rowp, &cols, (meshInitializedFlag ? 0 : nodiag));
+    if (!meshInitializedFlag) {
+      *_rowp = rowp;
+      *_cols = cols;
+      return;
+    }
+    nodeCSRRowp = rowp;
+    nodeCSRCols = cols;
+  }
+
+  // Copy the stored graph, removing the diagonal if requested
+  int *rowp = new int[numNodes + 1];
+  int *cols = new int[nodeCSRRowp[numNodes]];
+  rowp[0] = 0;
+  for (int i = 0, pos = 0; i < numNodes; i++) {
+    for (int jp = nodeCSRRowp[i]; jp < nodeCSRRowp[i + 1]; jp++) {
+      if (!nodiag || nodeCSRCols[jp] != i) {
+        cols[pos] = nodeCSRCols[jp];
+        pos++;
+      }
+    }
+    rowp[i + 1] = pos;
+  }
+
+  *_rowp = rowp;
+  *_cols = cols;
+}
+
+/*
+  Compute the node-to-node graph from the element connectivity
+*/
+void TACSAssembler::computeNodeToNodeGraph(int **_rowp, int **_cols,
+                                           int nodiag) {
+  int *conn, *depConn;
+  computeLocalConn(&conn, &depConn);
+
+  // Create the node -> element data structure
+  int *nodeElementPtr = NULL;
+  int *nodeToElements = NULL;
+  computeNodeToElementCSR(conn, depConn, &nodeElementPtr, &nodeToElements);
+
+  TACSNodeCSRArgs args;
+  memset(&args, 0, sizeof(args));
+  args.elemPtr = elementNodeIndex;
+  args.conn = conn;
+  args.depConn = depConn;
+  args.nodeElementPtr = nodeElementPtr;
+  args.nodeToElements = nodeToElements;
+  if (depNodes) {
+    depNodes->getDepNodes(&args.depPtr, NULL, NULL);
+  }
+
+  // Count the number of independent nodes associated with each element
+  int *nodeCount = new int[numElements];
+  args.nodeCount = nodeCount;
+  thread_info->parallelFor(numElements, 256, TacsElementNodeCountRange,
+                           &args);
+
+  // Find a conservative estimate of the length of each row
+  int *rowp = new int[numNodes + 1];
+  rowp[0] = 0;
+  args.rowp = rowp;
+  thread_info->parallelFor(numNodes, 256, TacsNodeCSRCountRange, &args);
+  for (int i = 0; i < numNodes; i++) {
+    rowp[i + 1] += rowp[i];
+  }
+
+  // Add the element contributions to the column indices
+  int *cols = new int[rowp[numNodes]];
+  args.cols = cols;
+  thread_info->parallelFor(numNodes, 256, TacsNodeCSRFillRange, &args);
+
+  // Go through and sort/uniquify each row and remove
+  // the diagonal if requested
+  TacsThreadedSortAndUniquifyCSR(thread_info, numNodes, rowp, cols, nodiag);
+
+  delete[] nodeCount;
+  delete[] nodeElementPtr;
+  delete[] nodeToElements;
+  delete[] conn;
+  if (depConn) {
+    delete[] depConn;
+  }
+
+  *_rowp = rowp;
+  *_cols = cols;
+}
+
+/**
+  Prepare a reduced CSR data structure corresponding to a matrix
+  formed from a selection of the global matrix. This routine can be
+  used in matrix/variable re-ordering computations.
+
+  This function uses the same algorithm as computeLocalNodeToNodeCSR,
+  but performs extra operations required to restrict the computations
+  to Ar.  The rnodes array must consist of nrnodes non-negative
+  integers between 0 and nrnodes-1, at any arbitrary location. All
+  remaining entries of rnodes must be negative.
+
+  @param rowp The row pointer corresponding to CSR data structure
+  @param cols The column indices for each row of the CSR data structure
+  @param nrnodes The number of reduced nodes
+  @param rnodes The indices of the reduced nodes
+  @param nodiag Flag to indicate whether to remove the diagonal matrix entry
+*/
+void TACSAssembler::computeLocalNodeToNodeCSR(int **_rowp, int **_cols,
+                                              int nrnodes, const int *rnodes,
+                                              int nodiag) {
+  TACSProfileScope scope("TACSAssembler::computeLocalNodeToNodeCSR");
+  int *cols = NULL;
+  int *rowp = new int[nrnodes + 1];
+  memset(rowp, 0, (nrnodes + 1) * sizeof(int));
+
+  // Create/get the node -> element data structure
+  int *nodeElementPtr = NULL;
+  int *nodeToElements = NULL;
+  computeNodeToElementCSR(&nodeElementPtr, &nodeToElements);
+
+  if (depNodes) {
+    const int *depNodePtr = NULL;
+    const int *depNodeConn = NULL;
+    depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+
+    // Count the number of nodes associated with each element
+    int *nodeCount = new int[numElements];
+    memset(nodeCount, 0, numElements * sizeof(int));
+
+    for (int i = 0; i < numElements; i++) {
+      int jend = elementNodeIndex[i + 1];
+      for (int j = elementNodeIndex[i]; j < jend; j++) {
+        int node = elementTacsNodes[j];
+
+        if (node >= 0) {
+          // Convert to the local node number
+          node = getLocalNodeNum(node);
+          if (rnodes[node] >= 0) {
+            nodeCount[i]++;
+          }
+        } else {
+          // Find the dependent node
+          int dep = -node - 1;
+          for (int k = depNodePtr[dep]; k < depNodePtr[dep + 1]; k++) {
+            node = getLocalNodeNum(depNodeConn[k]);
+            if (rnodes[node] >= 0) {
+              nodeCount[i]++;
+            }
+          }
+        }
+      }
+    }
+
+    // Count up the contribution to the rowp array from all elements
+    // using the node->element data
+    for (int i = 0; i < numNodes; i++) {
+      int node = rnodes[i];
+      if (node >= 0) {
+        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
+          int elem = nodeToElements[j];
+          rowp[node + 1] += nodeCount[elem];
+        }
+      }
+    }
+
+    // Make a conservative estimate of rowp
+    for (int i = 0; i < nrnodes; i++) {
+      rowp[i + 1] = rowp[i + 1] + rowp[i];
+    }
+
+    // Set up the column indices for each row
+    int nnz = rowp[nrnodes];
+    cols = new int[nnz];
+
+    // Add the element contribution to the column indices
+    for (int i = 0; i < numNodes; i++) {
+      int node = rnodes[i];
+      if (node >= 0) {
+        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
+          int elem = nodeToElements[j];
+          int kend = elementNodeIndex[elem + 1];
+
+          // Scan through all the nodes belonging to this element
+          int row = rowp[node];
+          for (int k = elementNodeIndex[elem]; k < kend; k++) {
+            int local = elementTacsNodes[k];
+            if (local >= 0) {
+              // Get the local node number
+              local = getLocalNodeNum(local);
+              int rn = rnodes[local];
+              // This is an independent node
+              if (rn >= 0) {
+                cols[row] = rn;
+                row++;
+              }
+            } else {
+              // This is a dependent node, add the dependent node
+              // variables
+              int dep = -local - 1;
+              int pend = depNodePtr[dep + 1];
+              for (int p = depNodePtr[dep]; p < pend; p++) {
+                local = depNodeConn[p];
+                local = getLocalNodeNum(local);
+                int rn = rnodes[local];
+                if (rn >= 0) {
+                  cols[row] = rn;
+                  row++;
+                }
+              }
+            }
+          }
+          rowp[node] = row;
+        }
+      }
+    }
+
+    // Adjust rowp back to a zero-based index
+    for (int i = nrnodes; i > 0; i--) {
+      rowp[i] = rowp[i - 1];
+    }
+    rowp[0] = 0;
+
+    delete[] nodeCount;
+  } else {
+    // First, populate rowp by adding the contribution to a node from
+    // all adjacent elements.
+    for (int i = 0; i < numNodes; i++) {
+      int node = rnodes[i];
+      if (node >= 0) {
+        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
+          int elem = nodeToElements[j];
+          // Count up the number of reduced nodes that are required here.
+          int count = 0;
+          for (int k = elementNodeIndex[elem]; k < elementNodeIndex[elem + 1];
+               k++) {
+            int local = elementTacsNodes[k];
+            local = getLocalNodeNum(local);
+            if (rnodes[local] >= 0) {
+              count++;
+            }
+          }
+
+          rowp[node + 1] += count;
+        }
+      }
+    }
+
+    // Make a conservative estimate of rowp
+    for (int i = 0; i < nrnodes; i++) {
+      rowp[i + 1] = rowp[i + 1] + rowp[i];
+    }
+
+    // Set up the column indices for each row
+    int nnz = rowp[nrnodes];
+    cols = new int[nnz];
+
+    // Add the element contribution to the column indices
+    for (int i = 0; i < numNodes; i++) {
+      int node = rnodes[i];
+      if (node >= 0) {
+        for (int j = nodeElementPtr[i]; j < nodeElementPtr[i + 1]; j++) {
+          int elem = nodeToElements[j];
+          int row = rowp[node];
+          for (int k = elementNodeIndex[elem]; k < elementNodeIndex[elem + 1];
+               k++) {
+            int local = elementTacsNodes[k];
+            local = getLocalNodeNum(local);
+            int rn = rnodes[local];
+            if (rn >= 0) {
+              cols[row] = rn;
+              row++;
+            }
+          }
+          rowp[node] = row;
+        }
+      }
+    }
+
+    // Adjust rowp back to a zero-based index
+    for (int i = nrnodes; i > 0; i--) {
+      rowp[i] = rowp[i - 1];
+    }
+    rowp[0] = 0;
+  }
+
+  // Go through and sort/uniquify each row and remove
+  // the diagonal if requested
+  TacsSortAndUniquifyCSR(nrnodes, rowp, cols, nodiag);
+
+  // Free the node -> element data structure
+  delete[] nodeToElements;
+  delete[] nodeElementPtr;
+
+  *_rowp = rowp;
+  *_cols = cols;
+}
+
+/**
+  Compute the local node numbers that correspond to the coupling
+  nodes connected to elements on other processes.
+
+  Sort the global node numbers. Match the intervals and send them off
+  to the owning process. On the owner, scan through the arrays until
+  all the local coupling nodes are found.
+
+  @param couplingNodes Local node numbers of the coupling nodes
+  @param extPtr Pointer into the external node array (may be NULL)
+  @param extCount External node count (may be NULL)
+  @param recvPtr Incoming external ptr from other processors (may be NULL)
+  @param recvCount Incoming external node count (may be NULL)
+  @param recvNodes The incoming nodes from other procs (may be NULL)
+*/
+int TACSAssembler::computeCouplingNodes(int **_couplingNodes, int **_extPtr,
+                                        int **_extCount, int **_recvPtr,
+                                        int **_recvCount, int **_recvNodes) {
+  TACSProfileScope scope("TACSAssembler::computeCouplingNodes");
+  // Get the ownership range and match the intervals of ownership
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
+
+  // Get the external node numbers
+  const int *extNodes = tacsExtNodeNums;
+  if (extDistIndices) {
+    extDistIndices->getIndices(&extNodes);
+  }
+
+  // Match the intervals for the external node numbers
+  int *extPtr = new int[mpiSize + 1];
+  int *extCount = new int[mpiSize];
+  TacsMatchIntervals(mpiSize, ownerRange, numExtNodes, extNodes, extPtr);
+
+  // Send the nodes owned by other processors the information. First
+  // count up how many will go to each process.
+  for (int i = 0; i < mpiSize; i++) {
+    extCount[i] = extPtr[i + 1] - extPtr[i];
+    if (i == mpiRank) {
+      extCount[i] = 0;
+    }
+  }
+
+  int *recvCount = new int[mpiSize];
+  int *recvPtr = new int[mpiSize + 1];
+  MPI_Alltoall(extCount, 1, MPI_INT, recvCount, 1, MPI_INT, tacs_comm);
+
+  // Now prepare to send the node numbers to the other processors
+  recvPtr[0] = 0;
+  for (int i = 0; i < mpiSize; i++) {
+    recvPtr[i + 1] = recvPtr[i] + recvCount[i];
+  }
+
+  // Number of nodes that will be received from other procs
+  int *recvNodes = new int[recvPtr[mpiSize]];
+  MPI_Alltoallv((void *)extNodes, extCount, extPtr, MPI_INT, recvNodes,
+                recvCount, recvPtr, MPI_INT, tacs_comm);
+
+  // Sort the recv'd nodes
+  int *recvNodesSorted = NULL;
+  if (_recvNodes) {
+    recvNodesSorted = new int[recvPtr[mpiSize]];
+    memcpy(recvNodesSorted, recvNodes, recvPtr[mpiSize] * sizeof(int));
+  } else {
+    recvNodesSorted = recvNodes;
+  }
+
+  // Uniquely sort the recieved nodes
+  int nrecv_unique = TacsUniqueSort(recvPtr[mpiSize], recvNodesSorted);
+
+  int num_multipliers = 0;
+  int *multipliers = NULL;
+
+  if (numMultiplierNodes > 0) {
+    // Count up the number of multiplier nodes (if any). These are not
+    // all of the locally owned multipliers, only those that refer to
+    // external node numbers on other processors.
+    multipliers = new int[numMultiplierNodes];
+
+    // Add in the multiplier values
+    for (int i = 0; i < numElements; i++) {
+      // Get the multiplier index
+      int multiplier = elements[i]->getMultiplierIndex();
+      if (multiplier >= 0) {
+        // Get the local multiplier index
+        int elem_ptr = elementNodeIndex[i];
+
+        // Check if the multiplier is locally owned. If it is not, it is
+        // already in the external nodes anyway.
+        int mult_node = elementTacsNodes[elem_ptr + multiplier];
+        if (mult_node >= ownerRange[mpiRank] &&
+            mult_node < ownerRange[mpiRank + 1]) {
+          // Get the element size
+          int size = elementNodeIndex[i + 1] - elem_ptr;
+
+          // Check if any of the nodes are actually external
+          for (int j = 0; j < size; j++) {
+            int node = elementTacsNodes[elem_ptr + j];
+
+            // Add the multiplier node if it's an external node or or it
+            // is one of the nodes referred to on other procs.
+            if (node < ownerRange[mpiRank] || node >= ownerRange[mpiRank + 1]) {
+              multipliers[num_multipliers] = mult_node;
+              num_multipliers++;
+              break;
+            } else if (TacsSearchArray(node, nrecv_unique, recvNodesSorted)) {
+              multipliers[num_multipliers] = mult_node;
+              num_multipliers++;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    // Uniquely sort the number of multiplier nodes
+    num_multipliers = TacsUniqueSort(num_multipliers, multipliers);
+  }
+
+  // Count up the number of coupling nodes
+  int numCouplingNodes = nrecv_unique + numExtNodes + num_multipliers;
+  if (_couplingNodes) {
+    int *couplingNodes = new int[numCouplingNodes];
+
+    // Automatically add in the external node numbers
+    int index = 0;
+    for (int i = 0; i < extNodeOffset; i++, index++) {
+      couplingNodes[index] = i;
+    }
+
+    // Add the coupling nodes received from other processors
+    if (num_multipliers > 0) {
+      for (int i = 0, j = 0; (i < nrecv_unique || j < num_multipliers);
+           index++) {
+        if (i < nrecv_unique && j < num_multipliers) {
+          if (recvNodesSorted[i] < multipliers[j]) {
+            couplingNodes[index] = getLocalNodeNum(recvNodesSorted[i]);
+            i++;
+          } else {
+            couplingNodes[index] = getLocalNodeNum(multipliers[j]);
+            j++;
+          }
+        } else if (i < nrecv_unique) {
+          couplingNodes[index] = getLocalNodeNum(recvNodesSorted[i]);
+          i++;
+        } else if (j < num_multipliers) {
+          couplingNodes[index] = getLocalNodeNum(multipliers[j]);
+          j++;
+        }
+      }
+    } else {
+      for (int i = 0; i < nrecv_unique; index++, i++) {
+        couplingNodes[index] = getLocalNodeNum(recvNodesSorted[i]);
+      }
+    }
+
+    // Add in the remaining external nodes
+    for (int i = extNodeOffset; i < numExtNodes; i++, index++) {
+      couplingNodes[index] = numOwnedNodes + i;
+    }
+
+    *_couplingNodes = couplingNodes;
+  }
+
+  // Free the multiplier index
+  if (multipliers) {
+    delete[] multipliers;
+  }
+
+  if (_extPtr) {
+    *_extPtr = extPtr;
+  } else {
+    delete[] extPtr;
+  }
+  if (_extCount) {
+    *_extCount = extCount;
+  } else {
+    delete[] extCount;
+  }
+  if (_recvPtr) {
+    *_recvPtr = recvPtr;
+  } else {
+    delete[] recvPtr;
+  }
+  if (_recvCount) {
+    *_recvCount = recvCount;
+  } else {
+    delete[] recvCount;
+  }
+  if (_recvNodes) {
+    *_recvNodes = recvNodes;
+    delete[] recvNodesSorted;
+  } else {
+    delete[] recvNodes;
+  }
+
+  return numCouplingNodes;
+}
+
+/**
+  Compute the elements that couple with other processors.
+
+  Compute the coupling nodes and the node to element pointer
+  CSR data structure. From these, collect all elements that "own" a
+  node that is referred to from another process.
+
+  @param _couplingElems The elements coupled to other processors
+*/
+int TACSAssembler::computeCouplingElements(int **_couplingElems) {
+  // Compute the nodes that couple to other processors
+  int *couplingNodes;
+  int numCouplingNodes = computeCouplingNodes(&couplingNodes);
+
+  // Compute the node->element data structure
+  int *nodeElementPtr, *nodeToElements;
+  computeNodeToElementCSR(&nodeElementPtr, &nodeToElements);
+
+  // Determine the elements that contain a coupling node
+  int numCouplingElems = 0;
+  int *couplingElems = new int[numElements];
+
+  // Loop over all the coupling nodes and add all the elements
+  // touched by each coupling node
+  for (int i = 0; i < numCouplingNodes; i++) {
+    int cnode = couplingNodes[i];
+
+    for (int j = nodeElementPtr[cnode]; j < nodeElementPtr[cnode + 1]; j++) {
+      int elem = nodeToElements[j];
+      numCouplingElems =
+          TacsMergeSortedArrays(numCouplingElems, couplingElems, 1, &elem);
+    }
+  }
+
+  // Free the data
+  delete[] nodeElementPtr;
+  delete[] nodeToElements;
+  delete[] couplingNodes;
+
+  *_couplingElems = couplingElems;
+  return numCouplingElems;
+}
+
+/**
+  The function initialize performs a number of synchronization
+  tasks that prepare the finite-element model for use.
+
+  tacsNodeNums[i] is the global node number for the local node number i
+
+  Two objects are required:
+  1. NodeMap is constructed with the block sizes of each
+  node owned by this process
+
+  2. VecDistribute is constructed so that it takes an array and
+  distributes its values to a vector or takes the vector values and
+  collects them into an array This requires a sorted array of global
+  node numbers.
+
+  @return Fail flag indicating if a failure occured
+*/
+int TACSAssembler::initialize() {
+  TACSProfileScope scope("TACSAssembler::initialize");
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call initialize() more than once!\n", mpiRank);
+    return 1;
+  }
+  if (numDependentNodes > 0 && !depNodes) {
+    fprintf(stderr, "[%d] Error: Dependent nodes not defined\n", mpiRank);
+    return 1;
+  }
+  if (!elements) {
+    fprintf(stderr, "[%d] Error: Elements not defined\n", mpiRank);
+    return 1;
+  }
+  if (!elementNodeIndex) {
+    fprintf(stderr, "[%d] Error: Element connectivity not defined\n", mpiRank);
+    return 1;
+  }
+
+  // If the external nodes have not been computed, compute them now...
+  if (!tacsExtNodeNums) {
+    computeExtNodes();
+  }
+
+  // Flag to indicate that we've initialized TACSAssembler -
+  // the initialization can only be done once
+  meshInitializedFlag = 1;
+
+  // Set up data for any dependent nodes. Note that the minimum
+  // number of independent nodes is set as the maximum number
+  // of element node by default. This is required for addMatValues()
+  // to have enough memory for TRANSPOSE matrix assembly.
+  maxElementIndepNodes = maxElementNodes;
+  if (numDependentNodes > 0) {
+    const int *depNodePtr;
+    depNodes->getDepNodes(&depNodePtr, NULL, NULL);
+
+    // Compute the maximum number of independent nodes
+    for (int i = 0; i < numElements; i++) {
+      int jend = elementNodeIndex[i + 1];
+      int nnodes = 0;
+      for (int j = elementNodeIndex[i]; j < jend; j++) {
+        if (elementTacsNodes[j] >= 0) {
+          nnodes++;
+        } else {
+          int dep = -elementTacsNodes[j] - 1;
+          nnodes += depNodePtr[dep + 1] - depNodePtr[dep];
+        }
+      }
+      if (nnodes > maxElementIndepNodes) {
+        maxElementIndepNodes = nnodes;
+      }
+    }
+  }
+
+  // Create the distribution between the local nodes and the global ones
+  extDistIndices = new TACSBVecIndices(&tacsExtNodeNums, numExtNodes);
+  tacsExtNodeNums = NULL;
+  extDistIndices->incref();
+  extDistIndices->setUpInverse();
+
+  // Set up the external vector distribute object
+  extDist = new TACSBVecDistribute(nodeMap, extDistIndices);
+  extDist->incref();
+
+  // Scatter the boundary conditions to the external nodes
+  scatterExternalBCs(bcMap);
+  scatterExternalBCs(bcInitMap);
+
+  // Allocate the vectors
+  varsVec = createVec();
+  varsVec->incref();
+  dvarsVec = createVec();
+  dvarsVec->incref();
+  ddvarsVec = createVec();
+  ddvarsVec->incref();
+  xptVec = createNodeVec();
+  xptVec->incref();
+
+  // Allocate memory for the working array:
+  // Determine the size of the data working array
+  // max requirement is 4 element variable-size arrays,
+  // 2 node-size arrays and either the element matrix or
+  // the derivative of the residuals w.r.t. the nodes.
+  int dataSize = maxElementIndepNodes + 4 * maxElementSize +
+                 2 * TACS_SPATIAL_DIM * maxElementNodes;
+  if (TACS_SPATIAL_DIM * maxElementNodes > maxElementSize) {
+    dataSize += TACS_SPATIAL_DIM * maxElementNodes * maxElementSize;
+  } else {
+    dataSize += maxElementSize * maxElementSize;
+  }
+  elementData = new TacsScalar[dataSize];
+
+  int idataSize = maxElementIndepNodes + maxElementNodes + 1;
+  elementIData = new int[idataSize];
+
+  // Fold the dependent node weights into the element connectivity
+  initDepNodeGather();
+
+  // Allocate memory for the design variable data
+  elementSensData = new TacsScalar[designVarsPerNode * maxElementDesignVars];
+  elementSensIData = new int[maxElementDesignVars];
+
+  // The design variable map and the distribution of the external
+  // design variables are created on first use by initDesignNodeMap()
+
+  return 0;
+}
+
+/*
+  Create the default design variable map and the distribution of the
+  external design variables
+
+  These are only needed for design vectors and design sensitivities,
+  so they are created on first use rather than in initialize(). This
+  call is collective on the first use after initialize().
+*/
+void TACSAssembler::initDesignNodeMap() {
+  if (!meshInitializedFlag || designExtDist) {
+    return;
+  }
+
+  // Create the design variable node mapping
+  if (!designNodeMap) {
+    // Get the number of design variables
+    int numDVs = computeNumDesignVars();
+
+    if (mpiRank > 0) {
+      numDVs = 0;
+    }
+
+    designNodeMap = new TACSNodeMap(tacs_comm, numDVs);
+    designNodeMap->incref();
+  }
+
+  // Find all the design variable numbers associated
+  if (!designExtDist) {
+    // Get the design variables from the auxiliary elements
+    int dvLen = 0;
+    const int maxDVs = maxElementDesignVars;
+    int *dvNums = elementSensIData;
+
+    // Get the design variable range
+    const int *range;
+    designNodeMap->getOwnerRange(&range);
+    int lower = range[mpiRank];
+    int upper = range[mpiRank + 1];
+
+    if (auxElements) {
+      TACSAuxElem *aux = NULL;
+      int naux = auxElements->getAuxElements(&aux);
+      for (int i = 0; i < naux; i++) {
+        int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+        for (int j = 0; j < numDVs; j++) {
+          if (dvNums[j] < lower || dvNums[j] >= upper) {
+            dvLen++;
+          }
+        }
+      }
+    }
+    for (int i = 0; i < numElements; i++) {
+      int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+      for (int j = 0; j < numDVs; j++) {
+        if (dvNums[j] < lower || dvNums[j] >= upper) {
+          dvLen++;
+        }
+      }
+    }
+
+    if (designDepNodes) {
+      const int *dep_ptr, *dep_conn;
+      int num_dep = designDepNodes->getDepNodes(&dep_ptr, &dep_conn, NULL);
+      for (int j = 0; j < dep_ptr[num_dep]; j++) {
+        if (dep_conn[j] < lower || dep_conn[j] >= upper) {
+          dvLen++;
+        }
+      }
+    }
+
+    // Allocate space for absolutely everything!
+    int *allDVs = new int[dvLen];
+
+    // Add all of the design variable numbers to the external node values
+    dvLen = 0;
+    if (auxElements) {
+      TACSAuxElem *aux = NULL;
+      int naux = auxElements->getAuxElements(&aux);
+      for (int i = 0; i < naux; i++) {
+        int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+        for (int j = 0; j < numDVs; j++) {
+          if (dvNums[j] < lower || dvNums[j] >= upper) {
+            allDVs[dvLen] = dvNums[j];
+            dvLen++;
+          }
+        }
+      }
+    }
+    for (int i = 0; i < numElements; i++) {
+      int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+      for (int j = 0; j < numDVs; j++) {
+        if (dvNums[j] < lower || dvNums[j] >= upper) {
+          allDVs[dvLen] = dvNums[j];
+          dvLen++;
+        }
+      }
+    }
+
+    if (designDepNodes) {
+      const int *dep_ptr, *dep_conn;
+      int num_dep = designDepNodes->getDepNodes(&dep_ptr, &dep_conn, NULL);
+      for (int j = 0; j < dep_ptr[num_dep]; j++) {
+        if (dep_conn[j] < lower || dep_conn[j] >= upper) {
+          allDVs[dvLen] = dep_conn[j];
+          dvLen++;
+        }
+      }
+    }
+
+    dvLen = TacsUniqueSort(dvLen, allDVs);
+    int *dvs = new int[dvLen];
+    memcpy(dvs, allDVs, dvLen * sizeof(int));
+    delete[] allDVs;
+
+    TACSBVecIndices *dvIndices = new TACSBVecIndices(&dvs, dvLen);
+    dvIndices->setUpInverse();
+    designExtDist = new TACSBVecDistribute(designNodeMap, dvIndices);
+    designExtDist->incref();
+  }
+}
+
+/*
+  Check the element Jacobian entries at each quadrature point to
+  see if they are positive. The code prints the rank and element
+  index on that rank if the check fails.
+*/
+void TACSAssembler::checkElementDeterminants() {
+  if (elements) {
+    TacsScalar *vars, *dvars, *ddvars;
+    TacsScalar *elemXpts;
+    getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
+                    NULL, NULL);
+
+    for (int elemIndex = 0; elemIndex < numElements; elemIndex++) {
+      TACSElement *element = elements[elemIndex];
+
+      // Determine the values of the state variables for the
+      // current element
+      int ptr = elementNodeIndex[elemIndex];
+      int len = elementNodeIndex[elemIndex + 1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
+      varsVec->getValues(len, nodes, vars);
+      dvarsVec->getValues(len, nodes, dvars);
+      ddvarsVec->getValues(len, nodes, ddvars);
+
+      for (int n = 0; n < element->getNumQuadraturePoints(); n++) {
+        double pt[3];
+        element->getQuadraturePoint(n, pt);
+
+        // Evaluate the pointwise element density
+        TacsScalar density = 0.0, detXd = 0.0;
+        int count = element->evalPointQuantity(elemIndex, TACS_ELEMENT_DENSITY,
+                                               time, n, pt, elemXpts, vars,
+                                               dvars, ddvars, &detXd, &density);
+
+        if (count > 0) {
+          if (TacsRealPart(detXd) <= 0.0) {
+            printf(
+                "[%d] TACS Warning: Negative determinant of the Jacobian "
+                "transformation for element %d of type %s. Flipped mesh?",
+                mpiRank, elemIndex, element->getObjectName());
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+  Scatter the boundary conditions that are shared between processors
+
+  Note that we do not need to scatter the values along with the
+  boundary condition values because the values are only used on the
+  processors which own the nodes (that already have the correct
+  information.)
+
+  This function is called during initialize()
+*/
+void TACSAssembler::scatterExternalBCs(TACSBcMap *bcs) {
+  // Get the coupling nodes shared between processors
+  int *extPtr, *extCount;
+  int *recvPtr, *recvCount, *recvNodes;
+  computeCouplingNodes(NULL, &extPtr, &extCount, &recvPtr, &recvCount,
+                       &recvNodes);
+
+  // Get the nodes/variables
+  const int *nodes, *vars;
+  int nbcs = bcs->getBCs(&nodes, &vars, NULL);
+
+  // Allocate the maximum array size that will be required
+  int max_recv_size = 100;
+  int *recvBCs = new int[max_recv_size];
+  int index = 0;
+
+  // Search through the coupling nodes recvd from other procs
+  recvPtr[0] = 0;
+  int ptr = 0;
+  for (int k = 0; k < mpiSize; k++) {
+    // Utilize the fact that the recvNodes are sorted
+    // from each processor
+    if (recvCount[k] > 0) {
+      int size = recvCount[k];
+      for (int i = 0; i < nbcs; i++) {
+        int *item = TacsSearchArray(nodes[i], size, &recvNodes[ptr]);
+
+        // This node is an interface node and a boundary node
+        // add it to the list
+        if (item) {
+          // Extend the array if required
+          if (2 * (index + 1) >= max_recv_size) {
+            max_recv_size *= 2;
+            int *temp = new int[max_recv_size];
+            memcpy(temp, recvBCs, 2 * index * sizeof(int));
+            delete[] recvBCs;
+            recvBCs = temp;
+          }
+
+          // Set the new values into the array
+          recvBCs[2 * index] = nodes[i];
+          recvBCs[2 * index + 1] = vars[i];
+          index++;
+        }
+      }
+
+      // Update the pointer into the BC array
+      ptr += size;
+    }
+
+    // Record the number of newly added nodes
+    recvPtr[k + 1] = 2 * index;
+    recvCount[k] = 2 * index - recvPtr[k];
+  }
+
+  // Send the counts to the other procs
+  MPI_Alltoall(recvCount, 1, MPI_INT, extCount, 1, MPI_INT, tacs_comm);
+
+  // Count up the size
+  extPtr[0] = 0;
+  for (int i = 0; i < mpiSize; i++) {
+    extPtr[i + 1] = extPtr[i] + extCount[i];
+  }
+
+  // Allocate an array for the incoming data
+  int numExtBCs = extPtr[mpiSize];
+  int *extBCs = new int[numExtBCs];
+  MPI_Alltoallv(recvBCs, recvCount, recvPtr, MPI_INT, extBCs, extCount, extPtr,
+                MPI_INT, tacs_comm);
+
+  // Free the data that is no longer required
+  delete[] recvBCs;
+  delete[] extPtr;
+  delete[] extCount;
+  delete[] recvPtr;
+  delete[] recvCount;
+  delete[] recvNodes;
+
+  // Add the external boundary conditions
+  for (int k = 0; k < numExtBCs; k += 2) {
+    bcs->addBinaryFlagBC(extBCs[k], extBCs[k + 1]);
+  }
+  delete[] extBCs;
+}
+
+/**
+  Get pointers to the element data. This code provides a way to
+  automatically segment an array to avoid coding mistakes.
+
+  Note that this is coded in such a way that you can provide NULL
+  arguments
+*/
+void TACSAssembler::getDataPointers(TacsScalar *data, TacsScalar **v1,
+                                    TacsScalar **v2, TacsScalar **v3,
+                                    TacsScalar **v4, TacsScalar **x1,
+                                    TacsScalar **x2, TacsScalar **weights,
+                                    TacsScalar **mat) {
+  int s = 0;
+  if (v1) {
+    *v1 = &data[s];
+    s += maxElementSize;
+  }
+  if (v2) {
+    *v2 = &data[s];
+    s += maxElementSize;
+  }
+  if (v3) {
+    *v3 = &data[s];
+    s += maxElementSize;
+  }
+  if (v4) {
+    *v4 = &data[s];
+    s += maxElementSize;
+  }
+  if (x1) {
+    *x1 = &data[s];
+    s += TACS_SPATIAL_DIM * maxElementNodes;
+  };
+  if (x2) {
+    *x2 = &data[s];
+    s += TACS_SPATIAL_DIM * maxElementNodes;
+  };
+  if (weights) {
+    *weights = &data[s];
+    s += maxElementIndepNodes;
+  }
+  if (mat) {
+    *mat = &data[s];
+  }
+}
+
+/**
+  Check whether a reordering has been applied to the nodes
+
+  @return Flag indicating if the nodes have been reordered
+*/
+int TACSAssembler::isReordered() { return (newNodeIndices != NULL); }
+
+/**
+  Get the ordering from the old nodes to the new nodes
+
+  @param oldToNew Array of size equal to the number of owned nodes
+*/
+void TACSAssembler::getReordering(int *oldToNew) {
+  if (newNodeIndices) {
+    // Get the new node indices
+    const int *newNodes;
+    newNodeIndices->getIndices(&newNodes);
+    memcpy(oldToNew, &newNodes[extNodeOffset], numOwnedNodes * sizeof(int));
+  } else {
+    const int *ownerRange;
+    nodeMap->getOwnerRange(&ownerRange);
+    for (int k = 0; k < numOwnedNodes; k++) {
+      oldToNew[k] = ownerRange[mpiRank] + k;
+    }
+  }
+}
+
+/**
+  Reorder the vector using the reordering computed using the
+  computeReordering() call.
+
+  This is useful for reordering nodal vectors after the reordering has
+  been applied.
+
+  @param vec The vector to be reordered in place
+*/
+void TACSAssembler::reorderVec(TACSBVec *vec) {
+  if (newNodeIndices) {
+    // Get the ownership range
+    const int *ownerRange;
+    nodeMap->getOwnerRange(&ownerRange);
+
+    // Get the vector of values from the array
+    TacsScalar *x;
+    int bsize = vec->getBlockSize();
+    int size = vec->getArray(&x);
+
+    // Allocate an array to store the old values and fill them in
+    TacsScalar *xold = new TacsScalar[size];
+    memcpy(xold, x, size * sizeof(TacsScalar));
+
+    // Get the new node indices
+    const int *newNodes;
+    newNodeIndices->getIndices(&newNodes);
+
+    // Loop through the owned nodes
+    for (int i = 0; i < numOwnedNodes; i++) {
+      // Get the new node value
+      int node = newNodes[extNodeOffset + i];
+      node = node - ownerRange[mpiRank];
+
+      // Copy the values back to the array in the new
+      // order
+      for (int k = 0; k < bsize; k++) {
+        x[bsize * node + k] = xold[bsize * i + k];
+      }
+    }
+
+    delete[] xold;
+  }
+}
+
+/**
+  Reorder the nodes from the initial ordering to the final ordering
+
+  Note that this only works for the nodes that are owned locally.
+  Non-local or local non-owned nodes will not be reordered properly.
+
+  @param num_nodes The length of the nodes array
+  @param nodes The owned node numbers that will be converted
+*/
+void TACSAssembler::reorderNodes(int num_nodes, int *nodes) {
+  if (newNodeIndices) {
+    // Get the ownership range
+    const int *ownerRange;
+    nodeMap->getOwnerRange(&ownerRange);
+
+    // Get the new node indices
+    const int *newNodes;
+    newNodeIndices->getIndices(&newNodes);
+
+    for (int i = 0; i < num_nodes; i++) {
+      if (nodes[i] >= ownerRange[mpiRank] &&
+          nodes[i] < ownerRange[mpiRank + 1]) {
+        int index = (nodes[i] - ownerRange[mpiRank]) + extNodeOffset;
+        nodes[i] = newNodes[index];
+      } else {
+        nodes[i] = -1;
+      }
+    }
+  }
+}
+
+/**
+  Create a distributed design vector
+
+  Vector classes initialized by one TACS object, cannot be used by a
+  second, unless they share are exactly the parallel layout.
+
+  @return A new design variable vector
+*/
+TACSBVec *TACSAssembler::createDesignVec() {
+  if (!meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call createDeignVec() before initialize()\n",
+            mpiRank);
+    return NULL;
+  }
+
+  // Create the vector
+  initDesignNodeMap();
+  return new TACSBVec(designNodeMap, designVarsPerNode, designExtDist,
+                      designDepNodes);
+}
+
+/**
+  Set the design variable mapping, indicating the owners of the design vars
+
+  @param designVarsPerNode The number of design variables for each var number
+  @param designVarMap The design variable mapping
+*/
+void TACSAssembler::setDesignNodeMap(int _designVarsPerNode,
+                                     TACSNodeMap *_designNodeMap) {
+  if (meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call setDesignVarMap() after initialize()\n",
+            mpiRank);
+    return;
   }
 
-  if (_extPtr) {
-    *_extPtr = extPtr;
-  } else {
-    delete[] extPtr;
+  // Copy over the data
+  designVarsPerNode = _designVarsPerNode;
+  if (_designNodeMap) {
+    _designNodeMap->incref();
   }
-  if (_extCount) {
-    *_extCount = extCount;
-  } else {
-    delete[] extCount;
+  if (designNodeMap) {
+    designNodeMap->decref();
   }
-  if (_recvPtr) {
-    *_recvPtr = recvPtr;
-  } else {
-    delete[] recvPtr;
+  designNodeMap = _designNodeMap;
+}
+
+/**
+  Set the dependent design variable information
+
+  @param numDepDesignVars The number of dependent design variables
+  @param depNodePtr Pointer into the depNodes array
+  @param depNodes The dependent node numbers
+  @param depNodeWeights The weights applied to each independent node
+  @return Error code indicating failure or success
+*/
+int TACSAssembler::setDesignDependentNodes(int numDepDesignVars,
+                                           const int *_depNodePtr,
+                                           const int *_depNodeConn,
+                                           const double *_depNodeWeights) {
+  if (meshInitializedFlag) {
+    fprintf(stderr,
+            "[%d] Cannot call setDesignDependentNodes() after initialize()\n",
+            mpiRank);
+    return 1;
   }
-  if (_recvCount) {
-    *_recvCount = recvCount;
-  } else {
-    delete[] recvCount;
+
+  // Free the data if the dependent nodes have already been set
+  if (designDepNodes) {
+    designDepNodes->decref();
+    designDepNodes = NULL;
   }
-  if (_recvNodes) {
-    *_recvNodes = recvNodes;
-    delete[] recvNodesSorted;
-  } else {
-    delete[] recvNodes;
+
+  // Get the ownership range of the nodes
+  if (designNodeMap) {
+    const int *ownerRange;
+    designNodeMap->getOwnerRange(&ownerRange);
+
+    // Check that all the independent nodes are positive and are within an
+    // allowable range
+    for (int i = 0; i < numDepDesignVars; i++) {
+      for (int jp = _depNodePtr[i]; jp < _depNodePtr[i + 1]; jp++) {
+        if (_depNodeConn[jp] >= ownerRange[mpiSize]) {
+          fprintf(stderr,
+                  "[%d] Dependent design node %d contains node number "
+                  "%d out of range\n",
+                  mpiRank, i, _depNodeConn[jp]);
+          return 1;
+        } else if (_depNodeConn[jp] < 0) {
+          fprintf(stderr,
+                  "[%d] Dependent design node %d contains dependent node %d\n",
+                  mpiRank, i, _depNodeConn[jp]);
+          return 1;
+        }
+      }
+    }
   }
 
-  return numCouplingNodes;
+  if (numDepDesignVars > 0) {
+    // Allocate the new memory and copy over the data
+    int *depNodePtr = new int[numDepDesignVars + 1];
+    memcpy(depNodePtr, _depNodePtr, (numDepDesignVars + 1) * sizeof(int));
+
+    int size = depNodePtr[numDepDesignVars];
+    int *depNodeConn = new int[size];
+    memcpy(depNodeConn, _depNodeConn, size * sizeof(int));
+
+    double *depNodeWeights = new double[size];
+    memcpy(depNodeWeights, _depNodeWeights, size * sizeof(double));
+
+    // Allocate the dependent node data structure
+    designDepNodes = new TACSBVecDepNodes(numDepDesignVars, &depNodePtr,
+                                          &depNodeConn, &depNodeWeights);
+    designDepNodes->incref();
+  }
+
+  return 0;
 }
 
 /**
-  Compute the elements that couple with other processors.
+  Get the number of design variables defined by this assembler object.
 
-  Compute the coupling nodes and the node to element pointer
-  CSR data structure. From these, collect all elements that "own" a
-  node that is referred to from another process.
+  Note that when the designNodeMap is defined, the number of design variables
+  are taken from the defined mapping. Otherwise, the default mapping is
+  created from the maximum design variable number of all the elements in
+  the TACSAssembler object.
 
-  @param _couplingElems The elements coupled to other processors
+  @return The number of design variables defined by TACSAssembler
 */
-int TACSAssembler::computeCouplingElements(int **_couplingElems) {
-  // Compute the nodes that couple to other processors
-  int *couplingNodes;
-  int numCouplingNodes = computeCouplingNodes(&couplingNodes);
+int TACSAssembler::getNumDesignVars() {
+  initDesignNodeMap();
+  if (designNodeMap) {
+    const int *range;
+    designNodeMap->getOwnerRange(&range);
+    return range[mpiRank];
+  }
 
-  // Compute the node->element data structure
-  int *nodeElementPtr, *nodeToElements;
-  computeNodeToElementCSR(&nodeElementPtr, &nodeToElements);
+  return 0;
+}
 
-  // Determine the elements that contain a coupling node
-  int numCouplingElems = 0;
-  int *couplingElems = new int[numElements];
+/*
+  Compute the number of design variables from the largest design
+  variable number in the elements on all processors
+*/
+int TACSAssembler::computeNumDesignVars() {
+  if (elementSensIData) {
+    // Get the design variables from the elements on this process
+    const int maxDVs = maxElementDesignVars;
+    int *dvNums = elementSensIData;
+
+    // Set the maximum design variable number
+    int maxDV = 0;
+
+    // Get the design variables from the auxiliary elements
+    if (auxElements) {
+      TACSAuxElem *aux = NULL;
+      int naux = auxElements->getAuxElements(&aux);
+      for (int i = 0; i < naux; i++) {
+        int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+
+        for (int j = 0; j < numDVs; j++) {
+          if (dvNums[j] > maxDV) {
+            maxDV = dvNums[j];
+          }
+        }
+      }
+    }
+
+    for (int i = 0; i < numElements; i++) {
+      int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+      for (int j = 0; j < numDVs; j++) {
+        if (dvNums[j] > maxDV) {
+          maxDV = dvNums[j];
+        }
+      }
+    }
+
+    int maxDVglobal = 0;
+    MPI_Allreduce(&maxDV, &maxDVglobal, 1, MPI_INT, MPI_MAX, tacs_comm);
+
+    return maxDVglobal + 1;
+  }
+
+  return 0;
+}
+
+/**
+  Collect all the design variable values assigned by this process
+
+  This code does not ensure consistency of the design variable values
+  between processes. If the values of the design variables are
+  inconsistent to begin with. Call setDesignVars to force consistency.
+
+  Each process contains objects that maintain their own design
+  variable values. Ensuring the consistency of the ordering is up to
+  the user. Having multiply-defined design variable numbers
+  corresponding to different design variables results in undefined
+  behaviour.
+
+  @param dvs The vector of design variables
+*/
+void TACSAssembler::getDesignVars(TACSBVec *dvs) {
+  // Get the design variables from the elements on this process
+  const int maxDVs = maxElementDesignVars;
+  TacsScalar *dvVals = elementSensData;
+  int *dvNums = elementSensIData;
+
+  // Get the design variables from the auxiliary elements
+  if (auxElements) {
+    TACSAuxElem *aux = NULL;
+    int naux = auxElements->getAuxElements(&aux);
+    for (int i = 0; i < naux; i++) {
+      int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+      aux[i].elem->getDesignVars(aux[i].num, maxDVs, dvVals);
+      dvs->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
+    }
+  }
+
+  initDesignVarMap();
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementDVPtr[i];
+    int numDVs = elementDVPtr[i + 1] - ptr;
+    elements[i]->getDesignVars(i, numDVs, dvVals);
+    dvs->setValues(numDVs, &elementDVNums[ptr], dvVals,
+                   TACS_INSERT_NONZERO_VALUES);
+  }
+
+  dvs->beginSetValues(TACS_INSERT_NONZERO_VALUES);
+  dvs->endSetValues(TACS_INSERT_NONZERO_VALUES);
+}
+
+/*
+  Store the design variable numbers of each element and the values
+  currently set in the elements. The design variable numbers of an
+  element do not change, so the map is only computed once.
+*/
+void TACSAssembler::initDesignVarMap() {
+  if (elementDVPtr) {
+    return;
+  }
+
+  const int maxDVs = maxElementDesignVars;
+  int *dvNums = elementSensIData;
+
+  elementDVPtr = new int[numElements + 1];
+  elementDVPtr[0] = 0;
+  for (int i = 0; i < numElements; i++) {
+    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+    elementDVPtr[i + 1] = elementDVPtr[i] + numDVs;
+  }
+
+  int size = elementDVPtr[numElements];
+  elementDVNums = new int[size];
+  elementDVVals = new TacsScalar[designVarsPerNode * size];
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementDVPtr[i];
+    int numDVs = elementDVPtr[i + 1] - ptr;
+    elements[i]->getDesignVarNums(i, numDVs, &elementDVNums[ptr]);
+    elements[i]->getDesignVars(i, numDVs,
+                               &elementDVVals[designVarsPerNode * ptr]);
+  }
+}
+
+/*
+  The data used to gather the element design variables in parallel
+*/
+struct TACSDesignVarArgs {
+  TACSBVec *dvs;
+  const int *ptr, *nums;
+  TacsScalar *vals;
+  int dvsPerNode, maxLen;
+  int *changed;
+};
+
+/*
+  Gather the design variables of each element and compare them against
+  the values last set into the element, updating the stored values
+*/
+static void TacsGatherDesignVarsRange(int start, int end, int thread_id,
+                                      void *ctx) {
+  TACSDesignVarArgs *args = (TACSDesignVarArgs *)ctx;
+  TacsScalar *temp = new TacsScalar[args->maxLen];
+  for (int i = start; i < end; i++) {
+    int ptr = args->ptr[i];
+    int numDVs = args->ptr[i + 1] - ptr;
+    int len = args->dvsPerNode * numDVs;
+    TacsScalar *vals = &args->vals[args->dvsPerNode * ptr];
+
+    args->changed[i] = 0;
+    if (numDVs > 0) {
+      args->dvs->getValues(numDVs, &args->nums[ptr], temp);
+      for (int j = 0; j < len; j++) {
+        if (temp[j] != vals[j]) {
+          args->changed[i] = 1;
+          break;
+        }
+      }
+      if (args->changed[i]) {
+        memcpy(vals, temp, len * sizeof(TacsScalar));
+      }
+    }
+  }
+  delete[] temp;
+}
+
+/**
+  Set the design variables.
+
+  The design variable values provided must be the same on all
+  processes for consistency. This must be called by all processors.
+
+  The design variable numbers of each element and the values last set
+  into the elements are stored after the first call. The values for
+  all the elements are gathered and compared on the threads, and only
+  the elements whose values have changed are updated.
+
+  @param dvs The design variable values
+*/
+void TACSAssembler::setDesignVars(TACSBVec *dvs) {
+  // Distribute the non-local design variable values
+  dvs->beginDistributeValues();
+  dvs->endDistributeValues();
+
+  // Get the design variables from the elements on this process
+  const int maxDVs = maxElementDesignVars;
+  TacsScalar *dvVals = elementSensData;
+  int *dvNums = elementSensIData;
 
-  // Loop over all the coupling nodes and add all the elements
-  // touched by each coupling node
-  for (int i = 0; i < numCouplingNodes; i++) {
-    int cnode = couplingNodes[i];
+  // Get the design variables from the auxiliary elements
+  if (auxElements) {
+    TACSAuxElem *aux = NULL;
+    int naux = auxElements->getAuxElements(&aux);
+    for (int i = 0; i < naux; i++) {
+      int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+      dvs->getValues(numDVs, dvNums, dvVals);
+      aux[i].elem->setDesignVars(aux[i].num, maxDVs, dvVals);
 
-    for (int j = nodeElementPtr[cnode]; j < nodeElementPtr[cnode + 1]; j++) {
-      int elem = nodeToElements[j];
-      numCouplingElems =
-          TacsMergeSortedArrays(numCouplingElems, couplingElems, 1, &elem);
+      // Changes to the auxiliary elements are not tracked
+      if (numDVs > 0) {
+        invalidateIncrementalJacobian();
+      }
     }
   }
 
-  // Free the data
-  delete[] nodeElementPtr;
-  delete[] nodeToElements;
-  delete[] couplingNodes;
+  // Gather the values for each element and compare them against the
+  // values last set into the element
+  initDesignVarMap();
+  TACSDesignVarArgs args;
+  args.dvs = dvs;
+  args.ptr = elementDVPtr;
+  args.nums = elementDVNums;
+  args.vals = elementDVVals;
+  args.dvsPerNode = designVarsPerNode;
+  args.maxLen = maxDVs * designVarsPerNode;
+  args.changed = new int[numElements];
+  thread_info->parallelFor(numElements, 1024, TacsGatherDesignVarsRange,
+                           &args);
+
+  // Set the values into the elements that have changed. Elements may
+  // share data, so this is not performed on the threads.
+  int localChanged = 0;
+  for (int i = 0; i < numElements; i++) {
+    if (args.changed[i]) {
+      int ptr = elementDVPtr[i];
+      int numDVs = elementDVPtr[i + 1] - ptr;
+      elements[i]->setDesignVars(i, numDVs,
+                                 &elementDVVals[designVarsPerNode * ptr]);
+      localChanged = 1;
+    }
+  }
+  delete[] args.changed;
 
-  *_couplingElems = couplingElems;
-  return numCouplingElems;
+  int changed = 0;
+  MPI_Allreduce(&localChanged, &changed, 1, MPI_INT, MPI_MAX, tacs_comm);
+
+  // The cached element matrices depend on the design variables
+  if (changed) {
+    clearElementMatCache();
+    designVersion++;
+  }
 }
 
 /**
-  The function initialize performs a number of synchronization
-  tasks that prepare the finite-element model for use.
-
-  tacsNodeNums[i] is the global node number for the local node number i
-
-  Two objects are required:
-  1. NodeMap is constructed with the block sizes of each
-  node owned by this process
+  Retrieve the design variable range.
 
-  2. VecDistribute is constructed so that it takes an array and
-  distributes its values to a vector or takes the vector values and
-  collects them into an array This requires a sorted array of global
-  node numbers.
+  This call is collective on all TACS processes. The ranges provided
+  by individual objects may not be consistent (if someone provided
+  incorrect data they could be.)
 
-  @return Fail flag indicating if a failure occured
+  @param lb the lower bound on the design variables
+  @param ub the upper bound on the design variables
 */
-int TACSAssembler::initialize() {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call initialize() more than once!\n", mpiRank);
-    return 1;
-  }
-  if (numDependentNodes > 0 && !depNodes) {
-    fprintf(stderr, "[%d] Error: Dependent nodes not defined\n", mpiRank);
-    return 1;
-  }
-  if (!elements) {
-    fprintf(stderr, "[%d] Error: Elements not defined\n", mpiRank);
-    return 1;
-  }
-  if (!elementNodeIndex) {
-    fprintf(stderr, "[%d] Error: Element connectivity not defined\n", mpiRank);
-    return 1;
+void TACSAssembler::getDesignVarRange(TACSBVec *lb, TACSBVec *ub) {
+  // Get the design variables from the elements on this process
+  const int maxDVs = maxElementDesignVars;
+  TacsScalar *dvVals = elementSensData;
+  TacsScalar *ubVals = new TacsScalar[designVarsPerNode * maxDVs];
+  int *dvNums = elementSensIData;
+
+  // Get the design variables from the auxiliary elements
+  if (auxElements) {
+    TACSAuxElem *aux = NULL;
+    int naux = auxElements->getAuxElements(&aux);
+    for (int i = 0; i < naux; i++) {
+      int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+      aux[i].elem->getDesignVarRange(aux[i].num, maxDVs, dvVals, ubVals);
+      lb->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
+      ub->setValues(numDVs, dvNums, ubVals, TACS_INSERT_NONZERO_VALUES);
+    }
   }
 
-  // If the external nodes have not been computed, compute them now...
-  if (!tacsExtNodeNums) {
-    computeExtNodes();
+  for (int i = 0; i < numElements; i++) {
+    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+    elements[i]->getDesignVarRange(i, numDVs, dvVals, ubVals);
+    lb->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
+    ub->setValues(numDVs, dvNums, ubVals, TACS_INSERT_NONZERO_VALUES);
   }
 
-  // Flag to indicate that we've initialized TACSAssembler -
-  // the initialization can only be done once
-  meshInitializedFlag = 1;
+  // Insert the values into the arrays
+  lb->beginSetValues(TACS_INSERT_NONZERO_VALUES);
+  ub->beginSetValues(TACS_INSERT_NONZERO_VALUES);
+  lb->endSetValues(TACS_INSERT_NONZERO_VALUES);
+  ub->endSetValues(TACS_INSERT_NONZERO_VALUES);
 
-  // Set up data for any dependent nodes. Note that the minimum
-  // number of independent nodes is set as the maximum number
-  // of element node by default. This is required for addMatValues()
-  // to have enough memory for TRANSPOSE matrix assembly.
-  maxElementIndepNodes = maxElementNodes;
-  if (numDependentNodes > 0) {
-    const int *depNodePtr;
-    depNodes->getDepNodes(&depNodePtr, NULL, NULL);
+  delete[] ubVals;
+}
 
-    // Compute the maximum number of independent nodes
-    for (int i = 0; i < numElements; i++) {
-      int jend = elementNodeIndex[i + 1];
-      int nnodes = 0;
-      for (int j = elementNodeIndex[i]; j < jend; j++) {
-        if (elementTacsNodes[j] >= 0) {
-          nnodes++;
-        } else {
-          int dep = -elementTacsNodes[j] - 1;
-          nnodes += depNodePtr[dep + 1] - depNodePtr[dep];
-        }
-      }
-      if (nnodes > maxElementIndepNodes) {
-        maxElementIndepNodes = nnodes;
-      }
-    }
+/**
+  Create a distributed solution vector.
+
+  Vector classes initialized by one TACS object, cannot be used by a
+  second, unless they share are exactly the parallel layout.
+
+  @return A new, empty solution vector initialized to zero
+*/
+TACSBVec *TACSAssembler::createVec() {
+  if (!meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call createVec() before initialize()\n",
+            mpiRank);
+    return NULL;
   }
 
-  // Create the distribution between the local nodes and the global ones
-  extDistIndices = new TACSBVecIndices(&tacsExtNodeNums, numExtNodes);
-  tacsExtNodeNums = NULL;
-  extDistIndices->incref();
-  extDistIndices->setUpInverse();
+  // Create the vector
+  return new TACSBVec(nodeMap, varsPerNode, extDist, depNodes, thread_info);
+}
 
-  // Set up the external vector distribute object
-  extDist = new TACSBVecDistribute(nodeMap, extDistIndices);
-  extDist->incref();
+/**
+  Apply the boundary conditions associated with the regular boundary
+  conditions. This zeros all entries in the vector associated with Dirichlet
+  conditions.
 
-  // Scatter the boundary conditions to the external nodes
-  scatterExternalBCs(bcMap);
-  scatterExternalBCs(bcInitMap);
+  @param vec Apply the boundary conditions to this vector
+*/
+void TACSAssembler::applyBCs(TACSVec *vec) { vec->applyBCs(bcMap); }
 
-  // Allocate the vectors
-  varsVec = createVec();
-  varsVec->incref();
-  dvarsVec = createVec();
-  dvarsVec->incref();
-  ddvarsVec = createVec();
-  ddvarsVec->incref();
-  xptVec = createNodeVec();
-  xptVec->incref();
+/**
+  Apply the boundary conditions to the matrix
 
-  // Allocate memory for the working array:
-  // Determine the size of the data working array
-  // max requirement is 4 element variable-size arrays,
-  // 2 node-size arrays and either the element matrix or
-  // the derivative of the residuals w.r.t. the nodes.
-  int dataSize = maxElementIndepNodes + 4 * maxElementSize +
-                 2 * TACS_SPATIAL_DIM * maxElementNodes;
-  if (TACS_SPATIAL_DIM * maxElementNodes > maxElementSize) {
-    dataSize += TACS_SPATIAL_DIM * maxElementNodes * maxElementSize;
-  } else {
-    dataSize += maxElementSize * maxElementSize;
-  }
-  elementData = new TacsScalar[dataSize];
+  @param mat Apply the boundary conditions to the rows of this matrix
+*/
+void TACSAssembler::applyBCs(TACSMat *mat) { mat->applyBCs(bcMap); }
 
-  int idataSize = maxElementIndepNodes + maxElementNodes + 1;
-  elementIData = new int[idataSize];
+/**
+  Apply the boundary conditions to the tranpose of the matrix
 
-  // Allocate memory for the design variable data
-  elementSensData = new TacsScalar[designVarsPerNode * maxElementDesignVars];
-  elementSensIData = new int[maxElementDesignVars];
+  @param mat Apply the boundary conditions to the columns of this matrix
+*/
+void TACSAssembler::applyTransposeBCs(TACSMat *mat) {
+  mat->applyTransposeBCs(bcMap);
+}
 
-  // Create the design variable node mapping
-  if (!designNodeMap) {
-    // Get the number of design variables
-    int numDVs = getNumDesignVars();
+/**
+  Set the Dirichlet boundary conditions into the vector. This differs
+  from applyBCs since the boundary condition values are set (not zeroed).
 
-    if (mpiRank > 0) {
-      numDVs = 0;
-    }
+  @param vec Set the boundary conditions values into this vector
+*/
+void TACSAssembler::setBCs(TACSVec *vec) { vec->setBCs(bcMap); }
 
-    designNodeMap = new TACSNodeMap(tacs_comm, numDVs);
-    designNodeMap->incref();
+/*
+  Share the non-zero patterns of the matrices with the patterns of the
+  matrices created previously. If a pattern does not match, the
+  pattern of the new matrix is stored for the next matrix instead.
+*/
+static void TacsShareMatPatterns(int nmats, BCSRMat **mats,
+                                 BCSRMatPattern **patterns) {
+  for (int i = 0; i < nmats; i++) {
+    if (!patterns[i] || !mats[i]->sharePattern(patterns[i])) {
+      BCSRMatPattern *pattern = mats[i]->getPattern();
+      pattern->incref();
+      if (patterns[i]) {
+        patterns[i]->decref();
+      }
+      patterns[i] = pattern;
+    }
   }
+}
 
-  // Find all the design variable numbers associated
-  if (!designExtDist) {
-    // Get the design variables from the auxiliary elements
-    int dvLen = 0;
-    const int maxDVs = maxElementDesignVars;
-    int *dvNums = elementSensIData;
+/**
+  Create a distributed matrix
 
-    // Get the design variable range
-    const int *range;
-    designNodeMap->getOwnerRange(&range);
-    int lower = range[mpiRank];
-    int upper = range[mpiRank + 1];
+  This matrix is distributed in block-rows. Each processor owns a
+  local part of the matrix and an off-diagonal part which couples
+  between processors.
 
-    if (auxElements) {
-      TACSAuxElem *aux = NULL;
-      int naux = auxElements->getAuxElements(&aux);
-      for (int i = 0; i < naux; i++) {
-        int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
-        for (int j = 0; j < numDVs; j++) {
-          if (dvNums[j] < lower || dvNums[j] >= upper) {
-            dvLen++;
-          }
-        }
-      }
-    }
-    for (int i = 0; i < numElements; i++) {
-      int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
-      for (int j = 0; j < numDVs; j++) {
-        if (dvNums[j] < lower || dvNums[j] >= upper) {
-          dvLen++;
-        }
-      }
-    }
+  This code creates a local array of global indices that is used to
+  determine the destination for each entry in the sparse matrix.  This
+  TACSBVecIndices object is reused if any subsequent parMat objects
+  are created. All the matrices created by this function share a
+  single copy of the non-zero pattern.
+
+  @return A new parallel matrix with zeroed entries
+*/
+TACSParallelMat *TACSAssembler::createMat() {
+  TACSProfileScope scope("TACSAssembler::createMat");
+  if (!meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call createMat() before initialize()\n",
+            mpiRank);
+    return NULL;
+  }
 
-    if (designDepNodes) {
-      const int *dep_ptr, *dep_conn;
-      int num_dep = designDepNodes->getDepNodes(&dep_ptr, &dep_conn, NULL);
-      for (int j = 0; j < dep_ptr[num_dep]; j++) {
-        if (dep_conn[j] < lower || dep_conn[j] >= upper) {
-          dvLen++;
-        }
-      }
+  // Create the parMat indices if they do not already exist
+  if (!parMatIndices) {
+    // Get the global node numbering
+    int *indices = new int[numNodes];
+    for (int i = 0; i < numNodes; i++) {
+      indices[i] = getGlobalNodeNum(i);
     }
 
-    // Allocate space for absolutely everything!
-    int *allDVs = new int[dvLen];
+    parMatIndices = new TACSBVecIndices(&indices, numNodes);
+    parMatIndices->incref();
+    parMatIndices->setUpInverse();
+  }
 
-    // Add all of the design variable numbers to the external node values
-    dvLen = 0;
-    if (auxElements) {
-      TACSAuxElem *aux = NULL;
-      int naux = auxElements->getAuxElements(&aux);
-      for (int i = 0; i < naux; i++) {
-        int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
-        for (int j = 0; j < numDVs; j++) {
-          if (dvNums[j] < lower || dvNums[j] >= upper) {
-            allDVs[dvLen] = dvNums[j];
-            dvLen++;
-          }
-        }
-      }
-    }
-    for (int i = 0; i < numElements; i++) {
-      int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
-      for (int j = 0; j < numDVs; j++) {
-        if (dvNums[j] < lower || dvNums[j] >= upper) {
-          allDVs[dvLen] = dvNums[j];
-          dvLen++;
-        }
-      }
-    }
+  // Compute the local connectivity
+  int *rowp, *cols;
+  computeLocalNodeToNodeCSR(&rowp, &cols);
 
-    if (designDepNodes) {
-      const int *dep_ptr, *dep_conn;
-      int num_dep = designDepNodes->getDepNodes(&dep_ptr, &dep_conn, NULL);
-      for (int j = 0; j < dep_ptr[num_dep]; j++) {
-        if (dep_conn[j] < lower || dep_conn[j] >= upper) {
-          allDVs[dvLen] = dep_conn[j];
-          dvLen++;
-        }
-      }
-    }
+  // Create the distributed matrix class
+  TACSParallelMat *dmat = new TACSParallelMat(
+      thread_info, nodeMap, varsPerNode, numNodes, rowp, cols, parMatIndices);
 
-    dvLen = TacsUniqueSort(dvLen, allDVs);
-    int *dvs = new int[dvLen];
-    memcpy(dvs, allDVs, dvLen * sizeof(int));
-    delete[] allDVs;
+  // Free the local connectivity
+  delete[] rowp;
+  delete[] cols;
 
-    TACSBVecIndices *dvIndices = new TACSBVecIndices(&dvs, dvLen);
-    dvIndices->setUpInverse();
-    designExtDist = new TACSBVecDistribute(designNodeMap, dvIndices);
-    designExtDist->incref();
+  // All the matrices have the same non-zero pattern. Share it so that
+  // only one copy is stored.
+  BCSRMat *mats[2];
+  dmat->getBCSRMat(&mats[0], &mats[1]);
+  TacsShareMatPatterns(2, mats, parMatPatterns);
+
+  // Compute the locations of the element blocks in the matrix. The
+  // connectivity is fixed after initialize() so the plan remains valid
+  // for the lifetime of the matrix.
+  if (useMatScatterPlan && numDependentNodes == 0) {
+    dmat->setElementScatter(numElements, elementNodeIndex, elementTacsNodes);
   }
 
-  return 0;
+  // Return the resulting matrix object
+  return dmat;
 }
 
-/*
-  Check the element Jacobian entries at each quadrature point to
-  see if they are positive. The code prints the rank and element
-  index on that rank if the check fails.
-*/
-void TACSAssembler::checkElementDeterminants() {
-  if (elements) {
-    TacsScalar *vars, *dvars, *ddvars;
-    TacsScalar *elemXpts;
-    getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
-                    NULL, NULL);
+/**
+  Compute the connectivity information for the multiplier nodes
 
-    for (int elemIndex = 0; elemIndex < numElements; elemIndex++) {
-      TACSElement *element = elements[elemIndex];
+  This goes through element-by-element and finds the local node
+  numbers associated with the multipliers. These multipliers must be
+  ordered last. A unique set of these multipliers is determined and
+  the associated element variables that must be ordered before the
+  multiplier are determined. This data is stored in a CSR-like data
+  structure that is sorted and uniquified before it is returned.
 
-      // Determine the values of the state variables for the
-      // current element
-      int ptr = elementNodeIndex[elemIndex];
-      int len = elementNodeIndex[elemIndex + 1] - ptr;
-      const int *nodes = &elementTacsNodes[ptr];
-      xptVec->getValues(len, nodes, elemXpts);
-      varsVec->getValues(len, nodes, vars);
-      dvarsVec->getValues(len, nodes, dvars);
-      ddvarsVec->getValues(len, nodes, ddvars);
+  @param num_multipliers The number of multipliers
+  @param multipliers The multiplier node numbers
+  @param indep_ptr Pointer into the array of independent node numbers
+  @param indep_nodes Independent nodes associated with each multiplier
+*/
+void TACSAssembler::computeMultiplierConn(int *_num_multipliers,
+                                          int **_multipliers, int **_indep_ptr,
+                                          int **_indep_nodes) {
+  *_num_multipliers = 0;
+  *_multipliers = NULL;
+  *_indep_ptr = NULL;
+  *_indep_nodes = NULL;
 
-      for (int n = 0; n < element->getNumQuadraturePoints(); n++) {
-        double pt[3];
-        element->getQuadraturePoint(n, pt);
+  if (numMultiplierNodes == 0) {
+    return;
+  }
 
-        // Evaluate the pointwise element density
-        TacsScalar density = 0.0, detXd = 0.0;
-        int count = element->evalPointQuantity(elemIndex, TACS_ELEMENT_DENSITY,
-                                               time, n, pt, elemXpts, vars,
-                                               dvars, ddvars, &detXd, &density);
+  // Determine the local multiplier index - the local node number for
+  // each multiplier node.
+  int *multipliers = new int[numMultiplierNodes];
+  int num_multipliers = 0;
+  for (int i = 0; i < numElements; i++) {
+    int multiplier = elements[i]->getMultiplierIndex();
+    if (multiplier >= 0) {
+      // Get the local multiplier index
+      int elem_ptr = elementNodeIndex[i];
 
-        if (count > 0) {
-          if (TacsRealPart(detXd) <= 0.0) {
-            printf(
-                "[%d] TACS Warning: Negative determinant of the Jacobian "
-                "transformation for element %d of type %s. Flipped mesh?",
-                mpiRank, elemIndex, element->getObjectName());
-          }
-        }
-      }
+      // Get the new local index for the multiplier
+      int mult_node = getLocalNodeNum(elementTacsNodes[elem_ptr + multiplier]);
+
+      // Set the multiplier node number
+      multipliers[num_multipliers] = mult_node;
+      num_multipliers++;
     }
   }
-}
 
-/*
-  Scatter the boundary conditions that are shared between processors
+  // Uniquely sort the list of multipliers to determine the number of
+  // true multiplier nodes
+  num_multipliers = TacsUniqueSort(num_multipliers, multipliers);
 
-  Note that we do not need to scatter the values along with the
-  boundary condition values because the values are only used on the
-  processors which own the nodes (that already have the correct
-  information.)
+  // Create the array of offsets into the pointer array
+  int *ptr = new int[num_multipliers + 1];
+  memset(ptr, 0, (num_multipliers + 1) * sizeof(int));
 
-  This function is called during initialize()
-*/
-void TACSAssembler::scatterExternalBCs(TACSBcMap *bcs) {
-  // Get the coupling nodes shared between processors
-  int *extPtr, *extCount;
-  int *recvPtr, *recvCount, *recvNodes;
-  computeCouplingNodes(NULL, &extPtr, &extCount, &recvPtr, &recvCount,
-                       &recvNodes);
+  // Now count up again to determine the total size of the non-zero
+  // pattern required to store all the multiplier information
+  for (int i = 0; i < numElements; i++) {
+    int multiplier = elements[i]->getMultiplierIndex();
+    if (multiplier >= 0) {
+      // Get the local multiplier index
+      int elem_ptr = elementNodeIndex[i];
+      int size = elementNodeIndex[i + 1] - elem_ptr;
 
-  // Get the nodes/variables
-  const int *nodes, *vars;
-  int nbcs = bcs->getBCs(&nodes, &vars, NULL);
+      // Get the new local index for the multiplier
+      int mult_node = getLocalNodeNum(elementTacsNodes[elem_ptr + multiplier]);
 
-  // Allocate the maximum array size that will be required
-  int max_recv_size = 100;
-  int *recvBCs = new int[max_recv_size];
-  int index = 0;
+      // Find the local index for external nodes
+      int *item = TacsSearchArray(mult_node, num_multipliers, multipliers);
+      if (item) {
+        int index = item - multipliers;
 
-  // Search through the coupling nodes recvd from other procs
-  recvPtr[0] = 0;
-  int ptr = 0;
-  for (int k = 0; k < mpiSize; k++) {
-    // Utilize the fact that the recvNodes are sorted
-    // from each processor
-    if (recvCount[k] > 0) {
-      int size = recvCount[k];
-      for (int i = 0; i < nbcs; i++) {
-        int *item = TacsSearchArray(nodes[i], size, &recvNodes[ptr]);
+        // Add in the element size (minus the multiplier node itself)
+        ptr[index + 1] += size - 1;
+      }
+    }
+  }
 
-        // This node is an interface node and a boundary node
-        // add it to the list
-        if (item) {
-          // Extend the array if required
-          if (2 * (index + 1) >= max_recv_size) {
-            max_recv_size *= 2;
-            int *temp = new int[max_recv_size];
-            memcpy(temp, recvBCs, 2 * index * sizeof(int));
-            delete[] recvBCs;
-            recvBCs = temp;
-          }
+  // Set up the pointer array as an offset into each row
+  for (int i = 1; i <= num_multipliers; i++) {
+    ptr[i] += ptr[i - 1];
+  }
 
-          // Set the new values into the array
-          recvBCs[2 * index] = nodes[i];
-          recvBCs[2 * index + 1] = vars[i];
-          index++;
+  // Allocate the array of nodes
+  int *nodes = new int[ptr[num_multipliers]];
+
+  // Add in the values
+  for (int i = 0; i < numElements; i++) {
+    int multiplier = elements[i]->getMultiplierIndex();
+    if (multiplier >= 0) {
+      // Get the local multiplier index
+      int elem_ptr = elementNodeIndex[i];
+      int size = elementNodeIndex[i + 1] - elem_ptr;
+
+      // Get the new local index for the multiplier
+      int mult_node = getLocalNodeNum(elementTacsNodes[elem_ptr + multiplier]);
+
+      // Find the local index for external nodes
+      int *item = TacsSearchArray(mult_node, num_multipliers, multipliers);
+      if (item) {
+        int index = item - multipliers;
+        for (int j = 0; j < size; j++) {
+          if (j != multiplier) {
+            // Get the local node number associated with the
+            // independent degrees of freedom at this node
+            nodes[ptr[index]] = getLocalNodeNum(elementTacsNodes[elem_ptr + j]);
+            ptr[index]++;
+          }
         }
       }
-
-      // Update the pointer into the BC array
-      ptr += size;
     }
-
-    // Record the number of newly added nodes
-    recvPtr[k + 1] = 2 * index;
-    recvCount[k] = 2 * index - recvPtr[k];
   }
 
-  // Send the counts to the other procs
-  MPI_Alltoall(recvCount, 1, MPI_INT, extCount, 1, MPI_INT, tacs_comm);
-
-  // Count up the size
-  extPtr[0] = 0;
-  for (int i = 0; i < mpiSize; i++) {
-    extPtr[i + 1] = extPtr[i] + extCount[i];
+  // Reset the pointer array
+  int offset = 0;
+  for (int i = 0; i <= num_multipliers; i++) {
+    int tmp = ptr[i];
+    ptr[i] = offset;
+    offset = tmp;
   }
 
-  // Allocate an array for the incoming data
-  int numExtBCs = extPtr[mpiSize];
-  int *extBCs = new int[numExtBCs];
-  MPI_Alltoallv(recvBCs, recvCount, recvPtr, MPI_INT, extBCs, extCount, extPtr,
-                MPI_INT, tacs_comm);
-
-  // Free the data that is no longer required
-  delete[] recvBCs;
-  delete[] extPtr;
-  delete[] extCount;
-  delete[] recvPtr;
-  delete[] recvCount;
-  delete[] recvNodes;
+  // Sort and uniquify the CSR - this compresses the CSR data
+  TacsSortAndUniquifyCSR(num_multipliers, ptr, nodes);
 
-  // Add the external boundary conditions
-  for (int k = 0; k < numExtBCs; k += 2) {
-    bcs->addBinaryFlagBC(extBCs[k], extBCs[k + 1]);
-  }
-  delete[] extBCs;
+  // Set the data and return
+  *_num_multipliers = num_multipliers;
+  *_multipliers = multipliers;
+  *_indep_ptr = ptr;
+  *_indep_nodes = nodes;
 }
 
 /**
-  Get pointers to the element data. This code provides a way to
-  automatically segment an array to avoid coding mistakes.
-
-  Note that this is coded in such a way that you can provide NULL
-  arguments
-*/
-void TACSAssembler::getDataPointers(TacsScalar *data, TacsScalar **v1,
-                                    TacsScalar **v2, TacsScalar **v3,
-                                    TacsScalar **v4, TacsScalar **x1,
-                                    TacsScalar **x2, TacsScalar **weights,
-                                    TacsScalar **mat) {
-  int s = 0;
-  if (v1) {
-    *v1 = &data[s];
-    s += maxElementSize;
-  }
-  if (v2) {
-    *v2 = &data[s];
-    s += maxElementSize;
-  }
-  if (v3) {
-    *v3 = &data[s];
-    s += maxElementSize;
-  }
-  if (v4) {
-    *v4 = &data[s];
-    s += maxElementSize;
-  }
-  if (x1) {
-    *x1 = &data[s];
-    s += TACS_SPATIAL_DIM * maxElementNodes;
-  };
-  if (x2) {
-    *x2 = &data[s];
-    s += TACS_SPATIAL_DIM * maxElementNodes;
-  };
-  if (weights) {
-    *weights = &data[s];
-    s += maxElementIndepNodes;
-  }
-  if (mat) {
-    *mat = &data[s];
-  }
-}
+  Create a parallel matrix for finite-element analysis.
 
-/**
-  Check whether a reordering has been applied to the nodes
+  On the first call, this computes a reordering with the scheme
+  provided. On subsequent calls, the reordering scheme is reused so
+  that all TACSSchurMats, created from the same TACSAssembler object
+  have the same non-zero structure. This makes adding matrices together
+  easier (which is required for eigenvalue computations.)
 
-  @return Flag indicating if the nodes have been reordered
-*/
-int TACSAssembler::isReordered() { return (newNodeIndices != NULL); }
+  The first step is to determine the coupling nodes. (For a serial
+  case there are no coupling nodes, so this is very simple!)  Then,
+  the nodes that are not coupled to other processes are determined.
+  The coupling and non-coupling nodes are ordered separately.  The
+  coupling nodes must be ordered at the end of the block, while the
+  local nodes must be ordered first. This type of constraint is not
+  usually imposed in matrix ordering routines, so here we use a
+  kludge.  First, order all the nodes and determine the ordering of
+  the coupling variables within the full set. Next, order the local
+  nodes. This hopefully reduces the fill-ins required, although there
+  is no firm proof to back that up.
 
-/**
-  Get the ordering from the old nodes to the new nodes
+  The results from the reordering are placed in a set of objects.  The
+  matrix reordering is stored in schurBIndices and schurCIndices while
+  two mapping objects are created that map the variables from the
+  global vector to reordered matrix.
 
-  @param oldToNew Array of size equal to the number of owned nodes
-*/
-void TACSAssembler::getReordering(int *oldToNew) {
-  if (newNodeIndices) {
-    // Get the new node indices
-    const int *newNodes;
-    newNodeIndices->getIndices(&newNodes);
-    memcpy(oldToNew, &newNodes[extNodeOffset], numOwnedNodes * sizeof(int));
-  } else {
-    const int *ownerRange;
-    nodeMap->getOwnerRange(&ownerRange);
-    for (int k = 0; k < numOwnedNodes; k++) {
-      oldToNew[k] = ownerRange[mpiRank] + k;
-    }
-  }
-}
+  Mathematically this reordering can be written as follows,
 
-/**
-  Reorder the vector using the reordering computed using the
-  computeReordering() call.
+  A' = (P A P^{T})
 
-  This is useful for reordering nodal vectors after the reordering has
-  been applied.
+  where P^{T} is a permutation of the columns (variables), while P is
+  a permutation of the rows (equations).
 
-  @param vec The vector to be reordered in place
+  @param order_type Order the Schur matrix with this type of ordeirng
+  @return A new TACSSchurMat matrix with zeroed entries
 */
-void TACSAssembler::reorderVec(TACSBVec *vec) {
-  if (newNodeIndices) {
-    // Get the ownership range
-    const int *ownerRange;
-    nodeMap->getOwnerRange(&ownerRange);
-
-    // Get the vector of values from the array
-    TacsScalar *x;
-    int bsize = vec->getBlockSize();
-    int size = vec->getArray(&x);
-
-    // Allocate an array to store the old values and fill them in
-    TacsScalar *xold = new TacsScalar[size];
-    memcpy(xold, x, size * sizeof(TacsScalar));
-
-    // Get the new node indices
-    const int *newNodes;
-    newNodeIndices->getIndices(&newNodes);
+TACSSchurMat *TACSAssembler::createSchurMat(OrderingType order_type) {
+  TACSProfileScope scope("TACSAssembler::createSchurMat");
+  if (!meshInitializedFlag) {
+    fprintf(stderr,
+            "[%d] Cannot call createSchurMat() before "
+            "initialize()\n",
+            mpiRank);
+    return NULL;
+  }
 
-    // Loop through the owned nodes
-    for (int i = 0; i < numOwnedNodes; i++) {
-      // Get the new node value
-      int node = newNodes[extNodeOffset + i];
-      node = node - ownerRange[mpiRank];
+  if (!schurBMap) {
+    // The number of local nodes and the number of coupling nodes
+    // that are referenced by other processors
+    int nlocal_nodes = numNodes;
+    int ncoupling_nodes = 0;
 
-      // Copy the values back to the array in the new
-      // order
-      for (int k = 0; k < bsize; k++) {
-        x[bsize * node + k] = xold[bsize * i + k];
-      }
-    }
+    // The local nodes and their
+    int *perm_local_nodes = NULL;
+    int *tacs_local_nodes = NULL;
+    int *perm_coupling_nodes = NULL;
+    int *tacs_coupling_nodes = NULL;
 
-    delete[] xold;
-  }
-}
+    if (order_type == TACS_AMD_ORDER) {
+      // Use the AMD ordering scheme in TACS to compute an ordering of
+      // the nodes that reduces the fill-in in the complete matrix --
+      // including the off-diagonal contributions. This can reduce the
+      // computational effort and the discrepancy between factorization
+      // times on different processes.
 
-/**
-  Reorder the nodes from the initial ordering to the final ordering
+      // Find the local node numbers of the coupling nodes.
+      // Note that this is a sorted list
+      int *coupling_nodes;
+      ncoupling_nodes = computeCouplingNodes(&coupling_nodes);
+      nlocal_nodes = numNodes - ncoupling_nodes;
 
-  Note that this only works for the nodes that are owned locally.
-  Non-local or local non-owned nodes will not be reordered properly.
+      // Compute the CSR data structure for the node-to-node
+      // connectivity without the diagonal entry
+      int *rowp, *cols;
+      int no_diagonal = 1;
+      computeLocalNodeToNodeCSR(&rowp, &cols, no_diagonal);
 
-  @param num_nodes The length of the nodes array
-  @param nodes The owned node numbers that will be converted
-*/
-void TACSAssembler::reorderNodes(int num_nodes, int *nodes) {
-  if (newNodeIndices) {
-    // Get the ownership range
-    const int *ownerRange;
-    nodeMap->getOwnerRange(&ownerRange);
+      // Compute the multipliers/connectivity
+      int num_multipliers = 0;
+      int *multipliers = NULL;
+      int *indep_ptr = NULL;
+      int *indep_nodes = NULL;
+      computeMultiplierConn(&num_multipliers, &multipliers, &indep_ptr,
+                            &indep_nodes);
 
-    // Get the new node indices
-    const int *newNodes;
-    newNodeIndices->getIndices(&newNodes);
+      // Here perm is the entire permutation array
+      int *perm = new int[numNodes];
+      int use_exact_degree = 0;  // Don't use the exact degree
+      amd_order_interface(numNodes, rowp, cols, perm, coupling_nodes,
+                          ncoupling_nodes, num_multipliers, multipliers,
+                          indep_ptr, indep_nodes, use_exact_degree);
 
-    for (int i = 0; i < num_nodes; i++) {
-      if (nodes[i] >= ownerRange[mpiRank] &&
-          nodes[i] < ownerRange[mpiRank + 1]) {
-        int index = (nodes[i] - ownerRange[mpiRank]) + extNodeOffset;
-        nodes[i] = newNodes[index];
-      } else {
-        nodes[i] = -1;
-      }
-    }
-  }
-}
+      // Free the rowp/cols array (which are modified by the
+      // reordering anyway)
+      delete[] rowp;
+      delete[] cols;
 
-/**
-  Create a distributed design vector
+      // Free the multipliers array
+      delete[] multipliers;
+      delete[] indep_ptr;
+      delete[] indep_nodes;
 
-  Vector classes initialized by one TACS object, cannot be used by a
-  second, unless they share are exactly the parallel layout.
+      // Compute the coupling nodes based on their permutation
+      tacs_local_nodes = new int[nlocal_nodes];
+      tacs_coupling_nodes = new int[ncoupling_nodes];
+      perm_local_nodes = new int[nlocal_nodes];
+      perm_coupling_nodes = new int[ncoupling_nodes];
+      for (int i = 0; i < nlocal_nodes; i++) {
+        perm_local_nodes[i] = perm[i];
+        tacs_local_nodes[i] = getGlobalNodeNum(perm_local_nodes[i]);
+      }
+      for (int i = 0; i < ncoupling_nodes; i++) {
+        perm_coupling_nodes[i] = perm[i + nlocal_nodes];
+        tacs_coupling_nodes[i] = getGlobalNodeNum(perm_coupling_nodes[i]);
+      }
 
-  @return A new design variable vector
-*/
-TACSBVec *TACSAssembler::createDesignVec() {
-  if (!meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call createDeignVec() before initialize()\n",
-            mpiRank);
-    return NULL;
-  }
+      delete[] perm;
+      delete[] coupling_nodes;
+    } else {
+      // This scheme uses AMD or Nested Disection on the local and
+      // coupling nodes independently. This ignores the off-diagonal
+      // fill-ins which can be considerable!
+      int no_diagonal = 0;
+      if (order_type == ND_ORDER) {
+        no_diagonal = 1;
+      }
 
-  // Create the vector
-  return new TACSBVec(designNodeMap, designVarsPerNode, designExtDist,
-                      designDepNodes);
-}
+      // Find the local node numbers of the coupling nodes.
+      // Note that this is a sorted list
+      int *coupling_nodes;
+      ncoupling_nodes = computeCouplingNodes(&coupling_nodes);
+      nlocal_nodes = numNodes - ncoupling_nodes;
 
-/**
-  Set the design variable mapping, indicating the owners of the design vars
+      // Set the coupling nodes for ordering
+      int *all_nodes = new int[numNodes];
+      for (int k = 0; k < numNodes; k++) {
+        all_nodes[k] = -1;
+      }
 
-  @param designVarsPerNode The number of design variables for each var number
-  @param designVarMap The design variable mapping
-*/
-void TACSAssembler::setDesignNodeMap(int _designVarsPerNode,
-                                     TACSNodeMap *_designNodeMap) {
-  if (meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call setDesignVarMap() after initialize()\n",
-            mpiRank);
-    return;
-  }
+      for (int k = 0; k < ncoupling_nodes; k++) {
+        all_nodes[coupling_nodes[k]] = k;
+      }
 
-  // Copy over the data
-  designVarsPerNode = _designVarsPerNode;
-  if (_designNodeMap) {
-    _designNodeMap->incref();
-  }
-  if (designNodeMap) {
-    designNodeMap->decref();
-  }
-  designNodeMap = _designNodeMap;
-}
+      perm_coupling_nodes = new int[ncoupling_nodes];
+      tacs_coupling_nodes = new int[ncoupling_nodes];
 
-/**
-  Set the dependent design variable information
+      // Now, compute the reordering for the local coupling variables
+      if (ncoupling_nodes > 0) {
+        int *rowp, *cols;
+        computeLocalNodeToNodeCSR(&rowp, &cols, ncoupling_nodes, all_nodes,
+                                  no_diagonal);
 
-  @param numDepDesignVars The number of dependent design variables
-  @param depNodePtr Pointer into the depNodes array
-  @param depNodes The dependent node numbers
-  @param depNodeWeights The weights applied to each independent node
-  @return Error code indicating failure or success
-*/
-int TACSAssembler::setDesignDependentNodes(int numDepDesignVars,
-                                           const int *_depNodePtr,
-                                           const int *_depNodeConn,
-                                           const double *_depNodeWeights) {
-  if (meshInitializedFlag) {
-    fprintf(stderr,
-            "[%d] Cannot call setDesignDependentNodes() after initialize()\n",
-            mpiRank);
-    return 1;
-  }
+        // Compute the permutation of the coupling nodes
+        computeMatReordering(order_type, ncoupling_nodes, rowp, cols,
+                             perm_coupling_nodes, NULL);
 
-  // Free the data if the dependent nodes have already been set
-  if (designDepNodes) {
-    designDepNodes->decref();
-    designDepNodes = NULL;
-  }
+        for (int i = 0; i < ncoupling_nodes; i++) {
+          // Permute the coupling_nodes array - store in perm_coupling_nodes
+          perm_coupling_nodes[i] = coupling_nodes[perm_coupling_nodes[i]];
+          tacs_coupling_nodes[i] = getGlobalNodeNum(perm_coupling_nodes[i]);
+        }
 
-  // Get the ownership range of the nodes
-  if (designNodeMap) {
-    const int *ownerRange;
-    designNodeMap->getOwnerRange(&ownerRange);
+        delete[] rowp;
+        delete[] cols;
+      }
 
-    // Check that all the independent nodes are positive and are within an
-    // allowable range
-    for (int i = 0; i < numDepDesignVars; i++) {
-      for (int jp = _depNodePtr[i]; jp < _depNodePtr[i + 1]; jp++) {
-        if (_depNodeConn[jp] >= ownerRange[mpiSize]) {
-          fprintf(stderr,
-                  "[%d] Dependent design node %d contains node number "
-                  "%d out of range\n",
-                  mpiRank, i, _depNodeConn[jp]);
-          return 1;
-        } else if (_depNodeConn[jp] < 0) {
-          fprintf(stderr,
-                  "[%d] Dependent design node %d contains dependent node %d\n",
-                  mpiRank, i, _depNodeConn[jp]);
-          return 1;
+      // Set the remaining, local nodes for coupling
+      perm_local_nodes = new int[nlocal_nodes];
+      tacs_local_nodes = new int[nlocal_nodes];
+      int *local_nodes = new int[nlocal_nodes];
+      for (int j = 0, k = 0; k < numNodes; k++) {
+        if (all_nodes[k] < 0) {
+          all_nodes[k] = j;
+          local_nodes[j] = k;
+          j++;
+        } else {
+          all_nodes[k] = -1;
         }
       }
-    }
-  }
-
-  if (numDepDesignVars > 0) {
-    // Allocate the new memory and copy over the data
-    int *depNodePtr = new int[numDepDesignVars + 1];
-    memcpy(depNodePtr, _depNodePtr, (numDepDesignVars + 1) * sizeof(int));
-
-    int size = depNodePtr[numDepDesignVars];
-    int *depNodeConn = new int[size];
-    memcpy(depNodeConn, _depNodeConn, size * sizeof(int));
 
-    double *depNodeWeights = new double[size];
-    memcpy(depNodeWeights, _depNodeWeights, size * sizeof(double));
+      // Now, compute the reordering for the local variables
+      int *rowp, *cols;
+      computeLocalNodeToNodeCSR(&rowp, &cols, nlocal_nodes, all_nodes,
+                                no_diagonal);
+      computeMatReordering(order_type, nlocal_nodes, rowp, cols,
+                           perm_local_nodes, NULL);
 
-    // Allocate the dependent node data structure
-    designDepNodes = new TACSBVecDepNodes(numDepDesignVars, &depNodePtr,
-                                          &depNodeConn, &depNodeWeights);
-    designDepNodes->incref();
-  }
+      for (int i = 0; i < nlocal_nodes; i++) {
+        // Permute the local nodes and record the corresponding tacs variables
+        perm_local_nodes[i] = local_nodes[perm_local_nodes[i]];
+        tacs_local_nodes[i] = getGlobalNodeNum(perm_local_nodes[i]);
+      }
 
-  return 0;
-}
+      delete[] rowp;
+      delete[] cols;
+      delete[] coupling_nodes;
+      delete[] all_nodes;
+      delete[] local_nodes;
+    }
 
-/**
-  Get the number of design variables defined by this assembler object.
+    // Create persistent objects so that all further TACSSchurMat will have
+    // the same ordering.
+    schurBIndices = new TACSBVecIndices(&perm_local_nodes, nlocal_nodes);
+    schurCIndices = new TACSBVecIndices(&perm_coupling_nodes, ncoupling_nodes);
+    schurBIndices->incref();
+    schurCIndices->incref();
 
-  Note that when the designNodeMap is defined, the number of design variables
-  are taken from the defined mapping. Otherwise, the maximum design variable
-  values is computed from all elements in the TACSAssembler object.
+    TACSBVecIndices *tlocal =
+        new TACSBVecIndices(&tacs_local_nodes, nlocal_nodes);
+    TACSBVecIndices *tcoupling =
+        new TACSBVecIndices(&tacs_coupling_nodes, ncoupling_nodes);
+    schurBMap = new TACSBVecDistribute(nodeMap, tlocal);
+    schurCMap = new TACSBVecDistribute(nodeMap, tcoupling);
+    schurBMap->incref();
+    schurCMap->incref();
+  }
 
-  @return The number of design variables defined by TACSAssembler
-*/
-int TACSAssembler::getNumDesignVars() {
-  if (designNodeMap) {
-    const int *range;
-    designNodeMap->getOwnerRange(&range);
-    return range[mpiRank];
-  } else if (elementSensIData) {
-    // Get the design variables from the elements on this process
-    const int maxDVs = maxElementDesignVars;
-    int *dvNums = elementSensIData;
+  // Compute he local non-zero pattern
+  int *rowp, *cols;
+  computeLocalNodeToNodeCSR(&rowp, &cols);
 
-    // Set the maximum design variable number
-    int maxDV = 0;
+  TACSSchurMat *mat =
+      new TACSSchurMat(thread_info, nodeMap, varsPerNode, numNodes, rowp, cols,
+                       schurBIndices, schurBMap, schurCIndices, schurCMap);
+  delete[] rowp;
+  delete[] cols;
 
-    // Get the design variables from the auxiliary elements
-    if (auxElements) {
-      TACSAuxElem *aux = NULL;
-      int naux = auxElements->getAuxElements(&aux);
-      for (int i = 0; i < naux; i++) {
-        int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
+  // Share the non-zero pattern with the matrices created previously
+  BCSRMat *mats[4];
+  mat->getBCSRMat(&mats[0], &mats[1], &mats[2], &mats[3]);
+  TacsShareMatPatterns(4, mats, schurMatPatterns);
 
-        for (int j = 0; j < numDVs; j++) {
-          if (dvNums[j] > maxDV) {
-            maxDV = dvNums[j];
-          }
-        }
-      }
-    }
+  return mat;
+}
 
-    for (int i = 0; i < numElements; i++) {
-      int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
-      for (int j = 0; j < numDVs; j++) {
-        if (dvNums[j] > maxDV) {
-          maxDV = dvNums[j];
-        }
-      }
-    }
+/*
+  Create a serial BCSC matrix that enables sparse factorization with
+  partial (row) pivoting. This matrix class is useful for debugging and
+  testing the effects of roundoff errors in the solution process.  It
+  does not work in parallel applications.
+*/
+TACSSerialPivotMat *TACSAssembler::createSerialMat() {
+  if (!meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call createSerialMat() before initialize()\n",
+            mpiRank);
+    return NULL;
+  }
+  if (mpiSize > 1) {
+    fprintf(stderr,
+            "[%d] Cannot call createSerialMat() with multiple processors\n",
+            mpiRank);
+    return NULL;
+  }
 
-    int maxDVglobal = 0;
-    MPI_Allreduce(&maxDV, &maxDVglobal, 1, MPI_INT, MPI_MAX, tacs_comm);
+  // Compute he local non-zero pattern
+  int *rowp, *cols;
+  computeLocalNodeToNodeCSR(&rowp, &cols);
 
-    return maxDVglobal + 1;
-  }
+  // Allocate the matrix
+  TACSSerialPivotMat *mat = new TACSSerialPivotMat(
+      nodeMap, varsPerNode, numNodes, numNodes, rowp, cols);
+  delete[] rowp;
+  delete[] cols;
 
-  return 0;
+  return mat;
 }
 
 /**
-  Collect all the design variable values assigned by this process
+  Retrieve the initial conditions associated with the problem
 
-  This code does not ensure consistency of the design variable values
-  between processes. If the values of the design variables are
-  inconsistent to begin with. Call setDesignVars to force consistency.
+  @param vars The initial variable values (may be NULL)
+  @param dvars The initial time derivative values (may be NULL)
+  @param ddvars The initial second time derivative values (may be NULL)
+*/
+void TACSAssembler::getInitConditions(TACSBVec *vars, TACSBVec *dvars,
+                                      TACSBVec *ddvars) {
+  // If the user requests initial conditions of vars and vars0 has not been set,
+  // zero the vector to prepare to get initial conditions from the element
+  // interface
+  if (vars && !vars0) {
+    vars->zeroEntries();
+  }
+  if (dvars && !dvars0) {
+    dvars->zeroEntries();
+  }
+  if (ddvars && !ddvars0) {
+    ddvars->zeroEntries();
+  }
 
-  Each process contains objects that maintain their own design
-  variable values. Ensuring the consistency of the ordering is up to
-  the user. Having multiply-defined design variable numbers
-  corresponding to different design variables results in undefined
-  behaviour.
+  // Retrieve pointers to temporary storage
+  TacsScalar *elemVars, *elemDVars, *elemDDVars, *elemXpts;
+  getDataPointers(elementData, &elemVars, &elemDVars, &elemDDVars, NULL,
+                  &elemXpts, NULL, NULL, NULL);
 
-  @param dvs The vector of design variables
-*/
-void TACSAssembler::getDesignVars(TACSBVec *dvs) {
-  // Get the design variables from the elements on this process
-  const int maxDVs = maxElementDesignVars;
-  TacsScalar *dvVals = elementSensData;
-  int *dvNums = elementSensIData;
+  // Retrieve the initial condition values from each element
+  if ((vars && !vars0) || (dvars && !dvars0) || (ddvars && !ddvars0)) {
+    for (int i = 0; i < numElements; i++) {
+      int ptr = elementNodeIndex[i];
+      int len = elementNodeIndex[i + 1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
 
-  // Get the design variables from the auxiliary elements
-  if (auxElements) {
-    TACSAuxElem *aux = NULL;
-    int naux = auxElements->getAuxElements(&aux);
-    for (int i = 0; i < naux; i++) {
-      int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
-      aux[i].elem->getDesignVars(aux[i].num, maxDVs, dvVals);
-      dvs->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
+      // Get the initial condition values
+      int nvars = elements[i]->getNumVariables();
+      memset(elemVars, 0, nvars * sizeof(TacsScalar));
+      memset(elemDVars, 0, nvars * sizeof(TacsScalar));
+      memset(elemDDVars, 0, nvars * sizeof(TacsScalar));
+      elements[i]->getInitConditions(i, elemXpts, elemVars, elemDVars,
+                                     elemDDVars);
+
+      // Set the values into the vectors
+      if (vars && !vars0) {
+        vars->setValues(len, nodes, elemVars, TACS_INSERT_NONZERO_VALUES);
+      }
+      if (dvars && !dvars0) {
+        dvars->setValues(len, nodes, elemDVars, TACS_INSERT_NONZERO_VALUES);
+      }
+      if (ddvars && !ddvars0) {
+        ddvars->setValues(len, nodes, elemDDVars, TACS_INSERT_NONZERO_VALUES);
+      }
     }
   }
 
-  for (int i = 0; i < numElements; i++) {
-    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
-    elements[i]->getDesignVars(i, numDVs, dvVals);
-    dvs->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
+  // If the the initial conditions of vars is requested and the vars0 vector has
+  // not been declared, then set the values of the tacs vector
+  if (vars && !vars0) {
+    vars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
+  }
+  if (dvars && !dvars0) {
+    dvars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
+  }
+  if (ddvars && !ddvars0) {
+    ddvars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
+  }
+  if (vars && !vars0) {
+    vars->endSetValues(TACS_INSERT_NONZERO_VALUES);
+  }
+  if (dvars && !dvars0) {
+    dvars->endSetValues(TACS_INSERT_NONZERO_VALUES);
+  }
+  if (ddvars && !ddvars0) {
+    ddvars->endSetValues(TACS_INSERT_NONZERO_VALUES);
   }
 
-  dvs->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  dvs->endSetValues(TACS_INSERT_NONZERO_VALUES);
+  // If the vars is requested and vars0 has been set, then copy the values from
+  // vars0
+  if (vars && vars0) {
+    vars->copyValues(vars0);
+  }
+  if (dvars && dvars0) {
+    dvars->copyValues(dvars0);
+  }
+  if (ddvars && ddvars0) {
+    ddvars->copyValues(ddvars0);
+  }
 }
 
 /**
-  Set the design variables.
-
-  The design variable values provided must be the same on all
-  processes for consistency. This must be called by all processors.
+Set the initial conditions for the problem
 
-  @param dvs The design variable values
+  @param vars The initial variable values (may be NULL)
+  @param dvars The initial time derivative values (may be NULL)
+  @param ddvars The initial second time derivative values (may be NULL)
 */
-void TACSAssembler::setDesignVars(TACSBVec *dvs) {
-  // Distribute the non-local design variable values
-  dvs->beginDistributeValues();
-  dvs->endDistributeValues();
-
-  // Get the design variables from the elements on this process
-  const int maxDVs = maxElementDesignVars;
-  TacsScalar *dvVals = elementSensData;
-  int *dvNums = elementSensIData;
-
-  // Get the design variables from the auxiliary elements
-  if (auxElements) {
-    TACSAuxElem *aux = NULL;
-    int naux = auxElements->getAuxElements(&aux);
-    for (int i = 0; i < naux; i++) {
-      int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
-      dvs->getValues(numDVs, dvNums, dvVals);
-      aux[i].elem->setDesignVars(aux[i].num, maxDVs, dvVals);
+void TACSAssembler::setInitConditions(TACSBVec *vars, TACSBVec *dvars,
+                                      TACSBVec *ddvars) {
+  // Copy the values to the array.
+  if (vars) {
+    if (!vars0) {
+      vars0 = createVec();
+      vars0->incref();
     }
+    vars0->copyValues(vars);
   }
-
-  for (int i = 0; i < numElements; i++) {
-    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
-    dvs->getValues(numDVs, dvNums, dvVals);
-    elements[i]->setDesignVars(i, numDVs, dvVals);
+  if (dvars) {
+    if (!dvars0) {
+      dvars0 = createVec();
+      dvars0->incref();
+    }
+    dvars0->copyValues(dvars);
+  }
+  if (ddvars) {
+    if (!ddvars0) {
+      ddvars0 = createVec();
+      ddvars0->incref();
+    }
+    ddvars0->copyValues(ddvars);
   }
 }
 
 /**
-  Retrieve the design variable range.
+  Zero the entries of the local variables
+*/
+void TACSAssembler::zeroVariables() {
+  varsVec->zeroEntries();
+  stateVersion++;
+}
 
-  This call is collective on all TACS processes. The ranges provided
-  by individual objects may not be consistent (if someone provided
-  incorrect data they could be.)
+/**
+  Zero the values of the time-derivatives of the state variables.
+  This time-derivative is load-case independent.
+*/
+void TACSAssembler::zeroDotVariables() {
+  dvarsVec->zeroEntries();
+  stateVersion++;
+}
 
-  @param lb the lower bound on the design variables
-  @param ub the upper bound on the design variables
+/**
+  Zero the values of the time-derivatives of the state variables.
+  This time-derivative is load-case independent.
 */
-void TACSAssembler::getDesignVarRange(TACSBVec *lb, TACSBVec *ub) {
-  // Get the design variables from the elements on this process
-  const int maxDVs = maxElementDesignVars;
-  TacsScalar *dvVals = elementSensData;
-  TacsScalar *ubVals = new TacsScalar[designVarsPerNode * maxDVs];
-  int *dvNums = elementSensIData;
+void TACSAssembler::zeroDDotVariables() {
+  ddvarsVec->zeroEntries();
+  stateVersion++;
+}
 
-  // Get the design variables from the auxiliary elements
-  if (auxElements) {
-    TACSAuxElem *aux = NULL;
-    int naux = auxElements->getAuxElements(&aux);
-    for (int i = 0; i < naux; i++) {
-      int numDVs = aux[i].elem->getDesignVarNums(aux[i].num, maxDVs, dvNums);
-      aux[i].elem->getDesignVarRange(aux[i].num, maxDVs, dvVals, ubVals);
-      lb->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
-      ub->setValues(numDVs, dvNums, ubVals, TACS_INSERT_NONZERO_VALUES);
+/**
+  Set the value of the time/variables/time derivatives simultaneously
+
+  The state version only changes when the values differ from the
+  current values. Passing the vectors returned by getVariables() skips
+  the comparison and always changes the state version.
+
+  @param vars The variable values (may be NULL)
+  @param dvars The time derivative values (may be NULL)
+  @param ddvars The second time derivative values (may be NULL)
+*/
+void TACSAssembler::setVariables(TACSBVec *vars, TACSBVec *dvars,
+                                 TACSBVec *ddvars) {
+  // The vectors owned by TACSAssembler may have been modified in place,
+  // so passing one of them always counts as a change. Otherwise, check
+  // whether the values change on any processor.
+  int changed = ((vars && vars == varsVec) || (dvars && dvars == dvarsVec) ||
+                 (ddvars && ddvars == ddvarsVec));
+  if (!changed) {
+    int localChanged = 0;
+    if (vars) {
+      localChanged = localChanged || TacsLocalValuesDiffer(varsVec, vars);
+    }
+    if (dvars) {
+      localChanged = localChanged || TacsLocalValuesDiffer(dvarsVec, dvars);
+    }
+    if (ddvars) {
+      localChanged = localChanged || TacsLocalValuesDiffer(ddvarsVec, ddvars);
     }
+    MPI_Allreduce(&localChanged, &changed, 1, MPI_INT, MPI_MAX, tacs_comm);
   }
 
-  for (int i = 0; i < numElements; i++) {
-    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
-    elements[i]->getDesignVarRange(i, numDVs, dvVals, ubVals);
-    lb->setValues(numDVs, dvNums, dvVals, TACS_INSERT_NONZERO_VALUES);
-    ub->setValues(numDVs, dvNums, ubVals, TACS_INSERT_NONZERO_VALUES);
+  // Copy the values to the array.
+  if (vars && vars != varsVec) {
+    varsVec->copyValues(vars);
+  }
+  if (dvars && dvars != dvarsVec) {
+    dvarsVec->copyValues(dvars);
+  }
+  if (ddvars && ddvars != ddvarsVec) {
+    ddvarsVec->copyValues(ddvars);
+  }
+
+  // Distribute the values and evaluate the dependent nodes.
+  if (vars) {
+    varsVec->beginDistributeValues();
+  }
+  if (dvars) {
+    dvarsVec->beginDistributeValues();
+  }
+  if (ddvars) {
+    ddvarsVec->beginDistributeValues();
+  }
+  if (vars) {
+    varsVec->endDistributeValues();
+  }
+  if (dvars) {
+    dvarsVec->endDistributeValues();
+  }
+  if (ddvars) {
+    ddvarsVec->endDistributeValues();
+  }
+  if (changed) {
+    stateVersion++;
   }
-
-  // Insert the values into the arrays
-  lb->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  ub->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  lb->endSetValues(TACS_INSERT_NONZERO_VALUES);
-  ub->endSetValues(TACS_INSERT_NONZERO_VALUES);
-
-  delete[] ubVals;
 }
 
 /**
-  Create a distributed solution vector.
+  Copy the values directly without distributing them.
 
-  Vector classes initialized by one TACS object, cannot be used by a
-  second, unless they share are exactly the parallel layout.
+  This is designed for specific instances where you want to use the
+  values in the vector directly without distributing them.  This means
+  that the variable values may be inconsistent across processors.
+  This is not usually what you want to do.
 
-  @return A new, empty solution vector initialized to zero
+  @param vars The variable values (may be NULL)
+  @param dvars The time derivative values (may be NULL)
+  @param ddvars The second time derivative values (may be NULL)
 */
-TACSBVec *TACSAssembler::createVec() {
-  if (!meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call createVec() before initialize()\n",
-            mpiRank);
-    return NULL;
+void TACSAssembler::copyVariables(TACSBVec *vars, TACSBVec *dvars,
+                                  TACSBVec *ddvars) {
+  if (vars) {
+    varsVec->copyValues(vars);
   }
-
-  // Create the vector
-  return new TACSBVec(nodeMap, varsPerNode, extDist, depNodes);
+  if (dvars) {
+    dvarsVec->copyValues(dvars);
+  }
+  if (ddvars) {
+    ddvarsVec->copyValues(ddvars);
+  }
+  stateVersion++;
 }
 
 /**
-  Apply the boundary conditions associated with the regular boundary
-  conditions. This zeros all entries in the vector associated with Dirichlet
-  conditions.
+  Get the variables from the vectors in TACS
 
-  @param vec Apply the boundary conditions to this vector
+  @param vars The variable values (may be NULL)
+  @param dvars The time derivative values (may be NULL)
+  @param ddvars The second time derivative values (may be NULL)
 */
-void TACSAssembler::applyBCs(TACSVec *vec) { vec->applyBCs(bcMap); }
+void TACSAssembler::getVariables(TACSBVec *vars, TACSBVec *dvars,
+                                 TACSBVec *ddvars) {
+  // Copy the values to the array. Only local values are
+  // copied, not external/dependents
+  if (vars) {
+    vars->copyValues(varsVec);
+  }
+  if (dvars) {
+    dvars->copyValues(dvarsVec);
+  }
+  if (ddvars) {
+    ddvars->copyValues(ddvarsVec);
+  }
+}
 
 /**
-  Apply the boundary conditions to the matrix
+  Get the variables from the vectors in TACS
 
-  @param mat Apply the boundary conditions to the rows of this matrix
+  @param vars The variable values (may be NULL)
+  @param dvars The time derivative values (may be NULL)
+  @param ddvars The second time derivative values (may be NULL)
 */
-void TACSAssembler::applyBCs(TACSMat *mat) { mat->applyBCs(bcMap); }
+void TACSAssembler::getVariables(TACSBVec **vars, TACSBVec **dvars,
+                                 TACSBVec **ddvars) {
+  // Copy the values to the array. Only local values are
+  // copied, not external/dependents
+  if (vars) {
+    *vars = varsVec;
+  }
+  if (dvars) {
+    *dvars = dvarsVec;
+  }
+  if (ddvars) {
+    *ddvars = ddvarsVec;
+  }
+}
 
 /**
-  Apply the boundary conditions to the tranpose of the matrix
+  Set the simulation time internally in the TACSAssembler object
 
-  @param mat Apply the boundary conditions to the columns of this matrix
+  @param _time The simulation time
 */
-void TACSAssembler::applyTransposeBCs(TACSMat *mat) {
-  mat->applyTransposeBCs(bcMap);
-}
+void TACSAssembler::setSimulationTime(double _time) { time = _time; }
 
-/**
-  Set the Dirichlet boundary conditions into the vector. This differs
-  from applyBCs since the boundary condition values are set (not zeroed).
+/*
+  Retrieve the simulation time from the TACSAssembler object
 
-  @param vec Set the boundary conditions values into this vector
+  @return The simulation time
 */
-void TACSAssembler::setBCs(TACSVec *vec) { vec->setBCs(bcMap); }
+double TACSAssembler::getSimulationTime() { return time; }
 
 /**
-  Create a distributed matrix
-
-  This matrix is distributed in block-rows. Each processor owns a
-  local part of the matrix and an off-diagonal part which couples
-  between processors.
-
-  This code creates a local array of global indices that is used to
-  determine the destination for each entry in the sparse matrix.  This
-  TACSBVecIndices object is reused if any subsequent parMat objects
-  are created.
+  Evaluates the total kinetic and potential energies of the structure
 
-  @return A new parallel matrix with zeroed entries
+  @param Te The kinetic energy
+  @param Pe The potential energy
 */
-TACSParallelMat *TACSAssembler::createMat() {
-  if (!meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call createMat() before initialize()\n",
-            mpiRank);
-    return NULL;
-  }
+void TACSAssembler::evalEnergies(TacsScalar *Te, TacsScalar *Pe) {
+  // Zero the kinetic and potential energy
+  *Te = 0.0;
+  *Pe = 0.0;
 
-  // Create the parMat indices if they do not already exist
-  if (!parMatIndices) {
-    // Get the global node numbering
-    int *indices = new int[numNodes];
-    for (int i = 0; i < numNodes; i++) {
-      indices[i] = getGlobalNodeNum(i);
-    }
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, NULL, NULL, &elemXpts, NULL, NULL,
+                  NULL);
 
-    parMatIndices = new TACSBVecIndices(&indices, numNodes);
-    parMatIndices->incref();
-    parMatIndices->setUpInverse();
-  }
+  // Loop over all elements and add individual contributions to the
+  // total energy
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
 
-  // Compute the local connectivity
-  int *rowp, *cols;
-  computeLocalNodeToNodeCSR(&rowp, &cols);
+    // Compute and add the element's contributions to the total
+    // energy
+    TacsScalar elemTe, elemPe;
+    elements[i]->computeEnergies(i, time, elemXpts, vars, dvars, &elemTe,
+                                 &elemPe);
 
-  // Create the distributed matrix class
-  TACSParallelMat *dmat = new TACSParallelMat(
-      thread_info, nodeMap, varsPerNode, numNodes, rowp, cols, parMatIndices);
+    // Add up the kinetic and potential energy
+    *Te += elemTe;
+    *Pe += elemPe;
+  }
 
-  // Free the local connectivity
-  delete[] rowp;
-  delete[] cols;
+  // Sum up the kinetic and potential energies across all processors
+  TacsScalar input[2], output[2];
+  input[0] = *Te;
+  input[1] = *Pe;
+  MPI_Allreduce(input, output, 2, TACS_MPI_TYPE, MPI_SUM, tacs_comm);
 
-  // Return the resulting matrix object
-  return dmat;
+  *Te = output[0];
+  *Pe = output[1];
 }
 
 /**
-  Compute the connectivity information for the multiplier nodes
+  Assemble the residual
 
-  This goes through element-by-element and finds the local node
-  numbers associated with the multipliers. These multipliers must be
-  ordered last. A unique set of these multipliers is determined and
-  the associated element variables that must be ordered before the
-  multiplier are determined. This data is stored in a CSR-like data
-  structure that is sorted and uniquified before it is returned.
+  This residual includes the contributions from element tractions set
+  in the auxiliary element classes. Note that the vector entries are
+  zeroed first, and that the Dirichlet boundary conditions are applied
+  after the assembly of the residual is complete.
 
-  @param num_multipliers The number of multipliers
-  @param multipliers The multiplier node numbers
-  @param indep_ptr Pointer into the array of independent node numbers
-  @param indep_nodes Independent nodes associated with each multiplier
+  @param residual The residual vector
+  @param lambda Scaling factor for the aux element contributions, by default 1
 */
-void TACSAssembler::computeMultiplierConn(int *_num_multipliers,
-                                          int **_multipliers, int **_indep_ptr,
-                                          int **_indep_nodes) {
-  *_num_multipliers = 0;
-  *_multipliers = NULL;
-  *_indep_ptr = NULL;
-  *_indep_nodes = NULL;
-
-  if (numMultiplierNodes == 0) {
-    return;
-  }
-
-  // Determine the local multiplier index - the local node number for
-  // each multiplier node.
-  int *multipliers = new int[numMultiplierNodes];
-  int num_multipliers = 0;
-  for (int i = 0; i < numElements; i++) {
-    int multiplier = elements[i]->getMultiplierIndex();
-    if (multiplier >= 0) {
-      // Get the local multiplier index
-      int elem_ptr = elementNodeIndex[i];
-
-      // Get the new local index for the multiplier
-      int mult_node = getLocalNodeNum(elementTacsNodes[elem_ptr + multiplier]);
+void TACSAssembler::assembleRes(TACSBVec *residual, const TacsScalar lambda) {
+  TACSProfileScope scope("TACSAssembler::assembleRes");
+  // Allocate or update the element matrix cache
+  initElementMatCache();
 
-      // Set the multiplier node number
-      multipliers[num_multipliers] = mult_node;
-      num_multipliers++;
-    }
+  // Sort the list of auxiliary elements - this only performs the
+  // sort if it is required (if new elements are added)
+  if (auxElements) {
+    auxElements->sort();
   }
 
-  // Uniquely sort the list of multipliers to determine the number of
-  // true multiplier nodes
-  num_multipliers = TacsUniqueSort(num_multipliers, multipliers);
-
-  // Create the array of offsets into the pointer array
-  int *ptr = new int[num_multipliers + 1];
-  memset(ptr, 0, (num_multipliers + 1) * sizeof(int));
-
-  // Now count up again to determine the total size of the non-zero
-  // pattern required to store all the multiplier information
-  for (int i = 0; i < numElements; i++) {
-    int multiplier = elements[i]->getMultiplierIndex();
-    if (multiplier >= 0) {
-      // Get the local multiplier index
-      int elem_ptr = elementNodeIndex[i];
-      int size = elementNodeIndex[i + 1] - elem_ptr;
+  // Zero the residual
+  residual->zeroEntries();
 
-      // Get the new local index for the multiplier
-      int mult_node = getLocalNodeNum(elementTacsNodes[elem_ptr + multiplier]);
+  // Compute the element traversal order and kernels, if any
+  initElementOrder();
+  initElementKernels();
 
-      // Find the local index for external nodes
-      int *item = TacsSearchArray(mult_node, num_multipliers, multipliers);
-      if (item) {
-        int index = item - multipliers;
+  if (thread_info->getNumThreads() > 1) {
+    // Distribute the elements between the threads
+    initElementSchedule();
+    tacsPInfo->assembler = this;
+    tacsPInfo->res = residual;
+    tacsPInfo->lambda = lambda;
 
-        // Add in the element size (minus the multiplier node itself)
-        ptr[index + 1] += size - 1;
+    // Execute the assembly on the threads in the pool
+    runElementThreads(TACSAssembler::assembleRes_thread);
+  } else {
+    // Take temporary storage for a batch of elements from the scratch
+    // arena of this thread
+    TACSScratchScope scratch;
+    int s = maxElementSize;
+    int sx = 3 * maxElementNodes;
+    int nb = elementBatchSize;
+    TacsScalar *batchData = scratch.allocScalars(nb * (4 * s + sx));
+    int *elemIndices = scratch.allocInts(nb);
+    TacsScalar *batchVars = &batchData[0];
+    TacsScalar *batchDVars = &batchData[nb * s];
+    TacsScalar *batchDDVars = &batchData[2 * nb * s];
+    TacsScalar *batchRes = &batchData[3 * nb * s];
+    TacsScalar *batchXpts = &batchData[4 * nb * s];
+
+    // Get the auxiliary elements and their offsets for each element
+    int naux = 0, aux_count = 0;
+    TACSAuxElem *aux = NULL;
+    const int *auxPtr = NULL;
+    if (auxElements) {
+      naux = auxElements->getAuxElements(&aux);
+      if (elementOrder) {
+        auxElements->getElementPtr(numElements, &auxPtr);
       }
     }
-  }
 
-  // Set up the pointer array as an offset into each row
-  for (int i = 1; i <= num_multipliers; i++) {
-    ptr[i] += ptr[i - 1];
-  }
+    // To avoid allocating memory inside the element loop, make the aux element
+    // contribution array big enough for the largest element
+    int maxNVar = this->maxElementSize;
+    TacsScalar *auxElemRes = NULL;
+    bool scaleAux = lambda != TacsScalar(1.0) && (naux > 0 || bodyLoads);
+    if (scaleAux) {
+      auxElemRes = scratch.allocScalars(maxNVar);
+    }
 
-  // Allocate the array of nodes
-  int *nodes = new int[ptr[num_multipliers]];
+    // Go through and add the residuals from all the elements
+    for (int k = 0; k < numElements;) {
+      // Get the batch of elements that share an element object or kernel
+      int n = getElementBatch(elementOrder, k, numElements, elemIndices);
+      TACSElement *element = elements[elemIndices[0]];
+      int nvars = element->getNumVariables();
+      int nx = 3 * element->getNumNodes();
+
+      double t0 = (elementTimes ? MPI_Wtime() : 0.0);
+      for (int j = 0; j < n; j++) {
+        int ptr = elementNodeIndex[elemIndices[j]];
+        int len = elementNodeIndex[elemIndices[j] + 1] - ptr;
+        const int *nodes = &elementTacsNodes[ptr];
+        xptVec->getValues(len, nodes, &batchXpts[nx * j]);
+        varsVec->getValues(len, nodes, &batchVars[nvars * j]);
+        dvarsVec->getValues(len, nodes, &batchDVars[nvars * j]);
+        ddvarsVec->getValues(len, nodes, &batchDDVars[nvars * j]);
+      }
+      if (elementTimes) {
+        double t1 = MPI_Wtime();
+        addElementTime(ELEMENT_GET_VALUES_TIME, n, elemIndices, t1 - t0);
+        t0 = t1;
+      }
 
-  // Add in the values
-  for (int i = 0; i < numElements; i++) {
-    int multiplier = elements[i]->getMultiplierIndex();
-    if (multiplier >= 0) {
-      // Get the local multiplier index
-      int elem_ptr = elementNodeIndex[i];
-      int size = elementNodeIndex[i + 1] - elem_ptr;
+      // Add the residuals from the batch of elements
+      memset(batchRes, 0, n * nvars * sizeof(TacsScalar));
+      addElementResidualBatch(element, n, elemIndices, batchXpts, batchVars,
+                              batchDVars, batchDDVars, batchRes);
+      if (elementTimes) {
+        addElementTime(ELEMENT_RESIDUAL_TIME, n, elemIndices,
+                       MPI_Wtime() - t0);
+      }
 
-      // Get the new local index for the multiplier
-      int mult_node = getLocalNodeNum(elementTacsNodes[elem_ptr + multiplier]);
+      for (int j = 0; j < n; j++, k++) {
+        int i = elemIndices[j];
+        int ptr = elementNodeIndex[i];
+        int len = elementNodeIndex[i + 1] - ptr;
+        const int *nodes = &elementTacsNodes[ptr];
+        const TacsScalar *elemXpts = &batchXpts[nx * j];
+        const TacsScalar *vars = &batchVars[nvars * j];
+        const TacsScalar *dvars = &batchDVars[nvars * j];
+        const TacsScalar *ddvars = &batchDDVars[nvars * j];
+        TacsScalar *elemRes = &batchRes[nvars * j];
+
+        // Locate the auxiliary elements when the elements are not
+        // visited in increasing order
+        if (auxPtr) {
+          aux_count = auxPtr[i];
+        }
 
-      // Find the local index for external nodes
-      int *item = TacsSearchArray(mult_node, num_multipliers, multipliers);
-      if (item) {
-        int index = item - multipliers;
-        for (int j = 0; j < size; j++) {
-          if (j != multiplier) {
-            // Get the local node number associated with the
-            // independent degrees of freedom at this node
-            nodes[ptr[index]] = getLocalNodeNum(elementTacsNodes[elem_ptr + j]);
-            ptr[index]++;
+        // Add the residual from any auxiliary elements and body loads, if the
+        // load factor is 1 they can be added straight to the elemRes,
+        // otherwise they need to be scaled first
+        TacsScalar *loadRes = (scaleAux ? auxElemRes : elemRes);
+        if (scaleAux) {
+          memset(auxElemRes, 0, maxNVar * sizeof(TacsScalar));
+        }
+        while (aux_count < naux && aux[aux_count].num == i) {
+          aux[aux_count].elem->addResidual(i, time, elemXpts, vars, dvars,
+                                           ddvars, loadRes);
+          aux_count++;
+        }
+
+        // Add the body loads
+        TACSElement *loads[2];
+        int nloads = getBodyLoads(i, loads);
+        for (int l = 0; l < nloads; l++) {
+          loads[l]->addResidual(i, time, elemXpts, vars, dvars, ddvars,
+                                loadRes);
+        }
+
+        if (scaleAux) {
+          for (int jj = 0; jj < nvars; jj++) {
+            elemRes[jj] += lambda * auxElemRes[jj];
           }
         }
+
+        // Add the residual values
+        residual->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
       }
     }
-  }
 
-  // Reset the pointer array
-  int offset = 0;
-  for (int i = 0; i <= num_multipliers; i++) {
-    int tmp = ptr[i];
-    ptr[i] = offset;
-    offset = tmp;
   }
 
-  // Sort and uniquify the CSR - this compresses the CSR data
-  TacsSortAndUniquifyCSR(num_multipliers, ptr, nodes);
+  // Finish transmitting the residual
+  residual->beginSetValues(TACS_ADD_VALUES);
+  residual->endSetValues(TACS_ADD_VALUES);
 
-  // Set the data and return
-  *_num_multipliers = num_multipliers;
-  *_multipliers = multipliers;
-  *_indep_ptr = ptr;
-  *_indep_nodes = nodes;
+  // Apply the boundary conditions for the residual
+  residual->applyBCs(bcMap, varsVec);
 }
 
 /**
-  Create a parallel matrix for finite-element analysis.
-
-  On the first call, this computes a reordering with the scheme
-  provided. On subsequent calls, the reordering scheme is reused so
-  that all TACSSchurMats, created from the same TACSAssembler object
-  have the same non-zero structure. This makes adding matrices together
-  easier (which is required for eigenvalue computations.)
-
-  The first step is to determine the coupling nodes. (For a serial
-  case there are no coupling nodes, so this is very simple!)  Then,
-  the nodes that are not coupled to other processes are determined.
-  The coupling and non-coupling nodes are ordered separately.  The
-  coupling nodes must be ordered at the end of the block, while the
-  local nodes must be ordered first. This type of constraint is not
-  usually imposed in matrix ordering routines, so here we use a
-  kludge.  First, order all the nodes and determine the ordering of
-  the coupling variables within the full set. Next, order the local
-  nodes. This hopefully reduces the fill-ins required, although there
-  is no firm proof to back that up.
-
-  The results from the reordering are placed in a set of objects.  The
-  matrix reordering is stored in schurBIndices and schurCIndices while
-  two mapping objects are created that map the variables from the
-  global vector to reordered matrix.
-
-  Mathematically this reordering can be written as follows,
-
-  A' = (P A P^{T})
-
-  where P^{T} is a permutation of the columns (variables), while P is
-  a permutation of the rows (equations).
+  Assemble the residuals of several sets of auxiliary elements
+
+  This computes the contribution of each set of auxiliary elements to
+  the residual at the current state, without the contribution of the
+  elements themselves. This is intended for the load vectors of many
+  load cases: the node locations and states of each element are
+  gathered once and shared between all the load cases, and the
+  auxiliary elements of each element are located in constant time.
+  The rows of each residual associated with the boundary conditions
+  are zeroed.
+
+  @param nloads The number of sets of auxiliary elements
+  @param loads The sets of auxiliary elements (entries may be NULL)
+  @param residuals The residual vector for each set
+*/
+void TACSAssembler::assembleAuxRes(int nloads, TACSAuxElements **loads,
+                                   TACSBVec **residuals) {
+  TACSProfileScope scope("TACSAssembler::assembleAuxRes");
+  assembleLoadCaseRes(nloads, loads, residuals, NULL, 0);
+}
 
-  @param order_type Order the Schur matrix with this type of ordeirng
-  @return A new TACSSchurMat matrix with zeroed entries
+/**
+  Assemble the residuals for several load cases
+
+  The residual for load case l is the residual of the elements plus
+  lambda[l] times the contribution of the auxiliary elements loads[l],
+  which is the residual computed by assembleRes() with the auxiliary
+  elements set to loads[l]. The element residual is computed once for
+  all the load cases in a single pass over the elements, so that the
+  right-hand-sides for many load cases can be assembled together and
+  passed to a block solver or a factor-once, solve-many loop. The
+  auxiliary elements set in the assembler are not used.
+
+  @param nloads The number of load cases
+  @param loads The auxiliary elements for each case (entries may be NULL)
+  @param residuals The residual vector for each case
+  @param lambda The load factor for each case (NULL for unit factors)
 */
-TACSSchurMat *TACSAssembler::createSchurMat(OrderingType order_type) {
-  if (!meshInitializedFlag) {
-    fprintf(stderr,
-            "[%d] Cannot call createSchurMat() before "
-            "initialize()\n",
-            mpiRank);
-    return NULL;
-  }
+void TACSAssembler::assembleResMulti(int nloads, TACSAuxElements **loads,
+                                     TACSBVec **residuals,
+                                     const TacsScalar lambda[]) {
+  TACSProfileScope scope("TACSAssembler::assembleResMulti");
+  assembleLoadCaseRes(nloads, loads, residuals, lambda, 1);
+}
 
-  if (!schurBMap) {
-    // The number of local nodes and the number of coupling nodes
-    // that are referenced by other processors
-    int nlocal_nodes = numNodes;
-    int ncoupling_nodes = 0;
+/*
+  Assemble the residuals of a number of load cases in one pass
 
-    // The local nodes and their
-    int *perm_local_nodes = NULL;
-    int *tacs_local_nodes = NULL;
-    int *perm_coupling_nodes = NULL;
-    int *tacs_coupling_nodes = NULL;
+  When add_element_res is set, the element residual is computed once
+  for each element and added to every load case. Otherwise only the
+  elements with auxiliary elements in some load case are visited.
+*/
+void TACSAssembler::assembleLoadCaseRes(int nloads, TACSAuxElements **loads,
+                                        TACSBVec **residuals,
+                                        const TacsScalar lambda[],
+                                        int add_element_res) {
+
+  // Get the auxiliary elements and their offsets for each load case
+  TACSAuxElem **aux = new TACSAuxElem *[nloads];
+  const int **auxPtr = new const int *[nloads];
+  for (int l = 0; l < nloads; l++) {
+    aux[l] = NULL;
+    auxPtr[l] = NULL;
+    if (loads[l]) {
+      loads[l]->getElementPtr(numElements, &auxPtr[l]);
+      loads[l]->getAuxElements(&aux[l]);
+    }
+    residuals[l]->zeroEntries();
+  }
+
+  // Retrieve pointers to temporary storage. The residual of the
+  // element is stored in elemRes and the residual of each load case
+  // in auxRes.
+  TacsScalar *vars, *dvars, *ddvars, *elemRes, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  NULL, NULL, NULL);
+  TACSScratchScope scratch;
+  TacsScalar *auxRes = scratch.allocScalars(maxElementSize);
 
-    if (order_type == TACS_AMD_ORDER) {
-      // Use the AMD ordering scheme in TACS to compute an ordering of
-      // the nodes that reduces the fill-in in the complete matrix --
-      // including the off-diagonal contributions. This can reduce the
-      // computational effort and the discrepancy between factorization
-      // times on different processes.
+  for (int i = 0; i < numElements; i++) {
+    // Skip the element if there are no loads on it
+    int has_aux = 0;
+    for (int l = 0; l < nloads; l++) {
+      if (auxPtr[l] && auxPtr[l][i + 1] > auxPtr[l][i]) {
+        has_aux = 1;
+        break;
+      }
+    }
+    if (!has_aux && !add_element_res) {
+      continue;
+    }
 
-      // Find the local node numbers of the coupling nodes.
-      // Note that this is a sorted list
-      int *coupling_nodes;
-      ncoupling_nodes = computeCouplingNodes(&coupling_nodes);
-      nlocal_nodes = numNodes - ncoupling_nodes;
+    // Retrieve the element variables and node locations once
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+    int nvars = elements[i]->getNumVariables();
 
-      // Compute the CSR data structure for the node-to-node
-      // connectivity without the diagonal entry
-      int *rowp, *cols;
-      int no_diagonal = 1;
-      computeLocalNodeToNodeCSR(&rowp, &cols, no_diagonal);
+    // Compute the element residual once for all the load cases
+    memset(elemRes, 0, nvars * sizeof(TacsScalar));
+    if (add_element_res) {
+      elements[i]->addResidual(i, time, elemXpts, vars, dvars, ddvars,
+                               elemRes);
+    }
 
-      // Compute the multipliers/connectivity
-      int num_multipliers = 0;
-      int *multipliers = NULL;
-      int *indep_ptr = NULL;
-      int *indep_nodes = NULL;
-      computeMultiplierConn(&num_multipliers, &multipliers, &indep_ptr,
-                            &indep_nodes);
+    // Add the contribution from each load case
+    for (int l = 0; l < nloads; l++) {
+      if (auxPtr[l] && auxPtr[l][i + 1] > auxPtr[l][i]) {
+        memset(auxRes, 0, nvars * sizeof(TacsScalar));
+        for (int j = auxPtr[l][i]; j < auxPtr[l][i + 1]; j++) {
+          aux[l][j].elem->addResidual(i, time, elemXpts, vars, dvars, ddvars,
+                                      auxRes);
+        }
+        TacsScalar scale = (lambda ? lambda[l] : 1.0);
+        for (int k = 0; k < nvars; k++) {
+          auxRes[k] = elemRes[k] + scale * auxRes[k];
+        }
+        residuals[l]->setValues(len, nodes, auxRes, TACS_ADD_VALUES);
+      } else if (add_element_res) {
+        residuals[l]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+      }
+    }
+  }
 
-      // Here perm is the entire permutation array
-      int *perm = new int[numNodes];
-      int use_exact_degree = 0;  // Don't use the exact degree
-      amd_order_interface(numNodes, rowp, cols, perm, coupling_nodes,
-                          ncoupling_nodes, num_multipliers, multipliers,
-                          indep_ptr, indep_nodes, use_exact_degree);
+  delete[] aux;
+  delete[] auxPtr;
 
-      // Free the rowp/cols array (which are modified by the
-      // reordering anyway)
-      delete[] rowp;
-      delete[] cols;
+  // Finish transmitting the residuals and apply the boundary conditions
+  for (int l = 0; l < nloads; l++) {
+    residuals[l]->beginSetValues(TACS_ADD_VALUES);
+    residuals[l]->endSetValues(TACS_ADD_VALUES);
+    if (add_element_res) {
+      residuals[l]->applyBCs(bcMap, varsVec);
+    } else {
+      residuals[l]->applyBCs(bcMap);
+    }
+  }
+}
 
-      // Free the multipliers array
-      delete[] multipliers;
-      delete[] indep_ptr;
-      delete[] indep_nodes;
+/**
+  Assemble the Jacobian matrix
 
-      // Compute the coupling nodes based on their permutation
-      tacs_local_nodes = new int[nlocal_nodes];
-      tacs_coupling_nodes = new int[ncoupling_nodes];
-      perm_local_nodes = new int[nlocal_nodes];
-      perm_coupling_nodes = new int[ncoupling_nodes];
-      for (int i = 0; i < nlocal_nodes; i++) {
-        perm_local_nodes[i] = perm[i];
-        tacs_local_nodes[i] = getGlobalNodeNum(perm_local_nodes[i]);
-      }
-      for (int i = 0; i < ncoupling_nodes; i++) {
-        perm_coupling_nodes[i] = perm[i + nlocal_nodes];
-        tacs_coupling_nodes[i] = getGlobalNodeNum(perm_coupling_nodes[i]);
-      }
+  This function assembles the global Jacobian matrix and
+  residual. This Jacobian includes the contributions from all
+  elements. The Dirichlet boundary conditions are applied to the
+  matrix by zeroing the rows of the matrix associated with a boundary
+  condition, and setting the diagonal to unity. The matrix assembly
+  also performs any communication required so that the matrix can be
+  used immediately after assembly.
 
-      delete[] perm;
-      delete[] coupling_nodes;
-    } else {
-      // This scheme uses AMD or Nested Disection on the local and
-      // coupling nodes independently. This ignores the off-diagonal
-      // fill-ins which can be considerable!
-      int no_diagonal = 0;
-      if (order_type == ND_ORDER) {
-        no_diagonal = 1;
-      }
+  @param alpha Coefficient for the variables
+  @param beta Coefficient for the time-derivative terms
+  @param gamma Coefficientfor the second time derivative term
+  @param residual The residual of the governing equations
+  @param A The Jacobian matrix
+  @param matOr the matrix orientation NORMAL or TRANSPOSE
+  @param lambda Scaling factor for the aux element contributions, by default 1
+*/
+void TACSAssembler::assembleJacobian(TacsScalar alpha, TacsScalar beta,
+                                     TacsScalar gamma, TACSBVec *residual,
+                                     TACSMat *A, MatrixOrientation matOr,
+                                     const TacsScalar lambda) {
+  TACSProfileScope scope("TACSAssembler::assembleJacobian");
+  // Update only the contributions from the elements that changed
+  if (useIncrementalJacobian &&
+      assembleIncrementalJacobian(alpha, beta, gamma, residual, A, matOr,
+                                  lambda)) {
+    return;
+  }
 
-      // Find the local node numbers of the coupling nodes.
-      // Note that this is a sorted list
-      int *coupling_nodes;
-      ncoupling_nodes = computeCouplingNodes(&coupling_nodes);
-      nlocal_nodes = numNodes - ncoupling_nodes;
+  // Zero the residual and the matrix
+  if (residual) {
+    residual->zeroEntries();
+  }
+  A->zeroEntries();
 
-      // Set the coupling nodes for ordering
-      int *all_nodes = new int[numNodes];
-      for (int k = 0; k < numNodes; k++) {
-        all_nodes[k] = -1;
-      }
+  // Sort the list of auxiliary elements - this call only performs the
+  // sort if it is required (if new elements are added)
+  if (auxElements) {
+    auxElements->sort();
+  }
 
-      for (int k = 0; k < ncoupling_nodes; k++) {
-        all_nodes[coupling_nodes[k]] = k;
-      }
+  // Allocate or update the element matrix cache
+  initElementMatCache();
 
-      perm_coupling_nodes = new int[ncoupling_nodes];
-      tacs_coupling_nodes = new int[ncoupling_nodes];
+  // Compute the element traversal order and kernels, if any
+  initElementOrder();
+  initElementKernels();
 
-      // Now, compute the reordering for the local coupling variables
-      if (ncoupling_nodes > 0) {
-        int *rowp, *cols;
-        computeLocalNodeToNodeCSR(&rowp, &cols, ncoupling_nodes, all_nodes,
-                                  no_diagonal);
+  // Set up the data to apply the boundary conditions during assembly
+  int assemblyBCs = isAssemblyBCsActive();
+  if (assemblyBCs && !elementBCFlags) {
+    initAssemblyBCs();
+  }
 
-        // Compute the permutation of the coupling nodes
-        computeMatReordering(order_type, ncoupling_nodes, rowp, cols,
-                             perm_coupling_nodes, NULL);
+  // Let the elements compute only the upper triangle of their matrices
+  if (useSymmetricElementMatrices) {
+    for (int i = 0; i < numElements; i++) {
+      elements[i]->setUpperMatrixFill(1);
+    }
+  }
 
-        for (int i = 0; i < ncoupling_nodes; i++) {
-          // Permute the coupling_nodes array - store in perm_coupling_nodes
-          perm_coupling_nodes[i] = coupling_nodes[perm_coupling_nodes[i]];
-          tacs_coupling_nodes[i] = getGlobalNodeNum(perm_coupling_nodes[i]);
-        }
+  // Run the p-threaded version of the assembly code
+  if (thread_info->getNumThreads() > 1) {
+    // Distribute the elements between the threads
+    initElementSchedule();
+    tacsPInfo->assembler = this;
+    tacsPInfo->res = residual;
+    tacsPInfo->mat = A;
+    tacsPInfo->alpha = alpha;
+    tacsPInfo->beta = beta;
+    tacsPInfo->gamma = gamma;
+    tacsPInfo->lambda = lambda;
+    tacsPInfo->matOr = matOr;
 
-        delete[] rowp;
-        delete[] cols;
-      }
+    // Execute the assembly on the threads in the pool
+    runElementThreads(TACSAssembler::assembleJacobian_thread);
+  } else {
+    // Take temporary storage for a batch of elements from the scratch
+    // arena of this thread
+    TACSScratchScope scratch;
+    int s = maxElementSize;
+    int sx = 3 * maxElementNodes;
+    int nb = elementBatchSize;
+    TacsScalar *batchData = scratch.allocScalars(nb * (4 * s + sx + s * s));
+    int *elemIndices = scratch.allocInts(nb);
+    TacsScalar *batchVars = &batchData[0];
+    TacsScalar *batchDVars = &batchData[nb * s];
+    TacsScalar *batchDDVars = &batchData[2 * nb * s];
+    TacsScalar *batchRes = &batchData[3 * nb * s];
+    TacsScalar *batchXpts = &batchData[4 * nb * s];
+    TacsScalar *batchMat = &batchData[nb * (4 * s + sx)];
+
+    // Retrieve pointers to temporary storage for the weights
+    TacsScalar *elemWeights;
+    getDataPointers(elementData, NULL, NULL, NULL, NULL, NULL, NULL,
+                    &elemWeights, NULL);
 
-      // Set the remaining, local nodes for coupling
-      perm_local_nodes = new int[nlocal_nodes];
-      tacs_local_nodes = new int[nlocal_nodes];
-      int *local_nodes = new int[nlocal_nodes];
-      for (int j = 0, k = 0; k < numNodes; k++) {
-        if (all_nodes[k] < 0) {
-          all_nodes[k] = j;
-          local_nodes[j] = k;
-          j++;
-        } else {
-          all_nodes[k] = -1;
-        }
+    // Set the data for the auxiliary elements - if there are any
+    int naux = 0, aux_count = 0;
+    TACSAuxElem *aux = NULL;
+    const int *auxPtr = NULL;
+    if (auxElements) {
+      naux = auxElements->getAuxElements(&aux);
+      if (elementOrder) {
+        auxElements->getElementPtr(numElements, &auxPtr);
       }
+    }
 
-      // Now, compute the reordering for the local variables
-      int *rowp, *cols;
-      computeLocalNodeToNodeCSR(&rowp, &cols, nlocal_nodes, all_nodes,
-                                no_diagonal);
-      computeMatReordering(order_type, nlocal_nodes, rowp, cols,
-                           perm_local_nodes, NULL);
+    for (int k = 0; k < numElements;) {
+      // Get the batch of elements that share an element object or kernel
+      int n = getElementBatch(elementOrder, k, numElements, elemIndices);
+      TACSElement *element = elements[elemIndices[0]];
+      int nvars = element->getNumVariables();
+      int nx = 3 * element->getNumNodes();
+
+      double t0 = (elementTimes ? MPI_Wtime() : 0.0);
+      for (int j = 0; j < n; j++) {
+        int ptr = elementNodeIndex[elemIndices[j]];
+        int len = elementNodeIndex[elemIndices[j] + 1] - ptr;
+        const int *nodes = &elementTacsNodes[ptr];
+        xptVec->getValues(len, nodes, &batchXpts[nx * j]);
+        varsVec->getValues(len, nodes, &batchVars[nvars * j]);
+        dvarsVec->getValues(len, nodes, &batchDVars[nvars * j]);
+        ddvarsVec->getValues(len, nodes, &batchDDVars[nvars * j]);
+      }
+      if (elementTimes) {
+        double t1 = MPI_Wtime();
+        addElementTime(ELEMENT_GET_VALUES_TIME, n, elemIndices, t1 - t0);
+        t0 = t1;
+      }
 
-      for (int i = 0; i < nlocal_nodes; i++) {
-        // Permute the local nodes and record the corresponding tacs variables
-        perm_local_nodes[i] = local_nodes[perm_local_nodes[i]];
-        tacs_local_nodes[i] = getGlobalNodeNum(perm_local_nodes[i]);
+      // Compute the contributions to the Jacobian from the batch
+      memset(batchRes, 0, n * nvars * sizeof(TacsScalar));
+      memset(batchMat, 0, n * nvars * nvars * sizeof(TacsScalar));
+      addElementJacobianBatch(element, n, elemIndices, alpha, beta, gamma,
+                              batchXpts, batchVars, batchDVars, batchDDVars,
+                              batchRes, batchMat);
+      if (elementTimes) {
+        addElementTime(ELEMENT_JACOBIAN_TIME, n, elemIndices,
+                       MPI_Wtime() - t0);
       }
 
-      delete[] rowp;
-      delete[] cols;
-      delete[] coupling_nodes;
-      delete[] all_nodes;
-      delete[] local_nodes;
-    }
+      for (int j = 0; j < n; j++, k++) {
+        int i = elemIndices[j];
+        int ptr = elementNodeIndex[i];
+        int len = elementNodeIndex[i + 1] - ptr;
+        const int *nodes = &elementTacsNodes[ptr];
+        const TacsScalar *elemXpts = &batchXpts[nx * j];
+        const TacsScalar *vars = &batchVars[nvars * j];
+        const TacsScalar *dvars = &batchDVars[nvars * j];
+        const TacsScalar *ddvars = &batchDDVars[nvars * j];
+        TacsScalar *elemRes = &batchRes[nvars * j];
+        TacsScalar *elemMat = &batchMat[nvars * nvars * j];
+
+        // Add the contribution to the residual and the Jacobian from the
+        // auxiliary elements - if any, this is scaled by the loadFactor lambda
+        if (auxPtr) {
+          aux_count = auxPtr[i];
+        }
+        int aux_start = aux_count;
+        while (aux_count < naux && aux[aux_count].num == i) {
+          aux[aux_count].elem->addJacobian(
+              i, time, alpha * lambda, beta * lambda, gamma * lambda, elemXpts,
+              vars, dvars, ddvars, elemRes, elemMat);
+          aux_count++;
+        }
+        TACSElement *loads[2];
+        int nloads = getBodyLoads(i, loads);
+        for (int l = 0; l < nloads; l++) {
+          loads[l]->addJacobian(i, time, alpha * lambda, beta * lambda,
+                                gamma * lambda, elemXpts, vars, dvars, ddvars,
+                                elemRes, elemMat);
+        }
 
-    // Create persistent objects so that all further TACSSchurMat will have
-    // the same ordering.
-    schurBIndices = new TACSBVecIndices(&perm_local_nodes, nlocal_nodes);
-    schurCIndices = new TACSBVecIndices(&perm_coupling_nodes, ncoupling_nodes);
-    schurBIndices->incref();
-    schurCIndices->incref();
+        if (residual) {
+          residual->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+        }
+        if (assemblyBCs) {
+          applyElementMatBCs(i, elemMat, matOr);
+        }
+        double t0 = (elementTimes ? MPI_Wtime() : 0.0);
+        addMatValues(A, i, elemMat, elementIData, elemWeights, matOr,
+                     aux_count > aux_start || nloads > 0);
+        if (elementTimes) {
+          addElementTime(ELEMENT_MAT_VALUES_TIME, 1, &i, MPI_Wtime() - t0);
+        }
+      }
+    }
 
-    TACSBVecIndices *tlocal =
-        new TACSBVecIndices(&tacs_local_nodes, nlocal_nodes);
-    TACSBVecIndices *tcoupling =
-        new TACSBVecIndices(&tacs_coupling_nodes, ncoupling_nodes);
-    schurBMap = new TACSBVecDistribute(nodeMap, tlocal);
-    schurCMap = new TACSBVecDistribute(nodeMap, tcoupling);
-    schurBMap->incref();
-    schurCMap->incref();
   }
 
-  // Compute he local non-zero pattern
-  int *rowp, *cols;
-  computeLocalNodeToNodeCSR(&rowp, &cols);
-
-  TACSSchurMat *mat =
-      new TACSSchurMat(thread_info, nodeMap, varsPerNode, numNodes, rowp, cols,
-                       schurBIndices, schurBMap, schurCIndices, schurCMap);
-  delete[] rowp;
-  delete[] cols;
-
-  return mat;
-}
+  if (useSymmetricElementMatrices) {
+    for (int i = 0; i < numElements; i++) {
+      elements[i]->setUpperMatrixFill(0);
+    }
+  }
 
-/*
-  Create a serial BCSC matrix that enables sparse factorization with
-  partial (row) pivoting. This matrix class is useful for debugging and
-  testing the effects of roundoff errors in the solution process.  It
-  does not work in parallel applications.
-*/
-TACSSerialPivotMat *TACSAssembler::createSerialMat() {
-  if (!meshInitializedFlag) {
-    fprintf(stderr, "[%d] Cannot call createSerialMat() before initialize()\n",
-            mpiRank);
-    return NULL;
+  // Set the diagonal entries of the constrained rows
+  if (assemblyBCs) {
+    addAssemblyBCDiagonal(A);
   }
-  if (mpiSize > 1) {
-    fprintf(stderr,
-            "[%d] Cannot call createSerialMat() with multiple processors\n",
-            mpiRank);
-    return NULL;
+
+  // Do any matrix and residual assembly if required
+  A->beginAssembly();
+  if (residual) {
+    residual->beginSetValues(TACS_ADD_VALUES);
   }
 
-  // Compute he local non-zero pattern
-  int *rowp, *cols;
-  computeLocalNodeToNodeCSR(&rowp, &cols);
+  A->endAssembly();
+  if (residual) {
+    residual->endSetValues(TACS_ADD_VALUES);
+  }
 
-  // Allocate the matrix
-  TACSSerialPivotMat *mat = new TACSSerialPivotMat(
-      nodeMap, varsPerNode, numNodes, numNodes, rowp, cols);
-  delete[] rowp;
-  delete[] cols;
+  // Apply the boundary conditions
+  if (residual) {
+    residual->applyBCs(bcMap, varsVec);
+  }
 
-  return mat;
+  // Apply the appropriate boundary conditions, unless they have
+  // already been applied during the assembly
+  if (!assemblyBCs) {
+    A->applyBCs(bcMap);
+  }
 }
 
 /**
-  Retrieve the initial conditions associated with the problem
-
-  @param vars The initial variable values (may be NULL)
-  @param dvars The initial time derivative values (may be NULL)
-  @param ddvars The initial second time derivative values (may be NULL)
+  Assemble the residuals and Jacobians of an ensemble of models that
+  differ only in their design variables and states
+
+  This is used to analyze many realizations of the same mesh, for
+  instance with randomly perturbed material or thickness fields. The
+  node locations, the time derivatives and the element connectivity
+  are retrieved once for each element, and the element contributions
+  are then computed for each member with its design variables set into
+  the element. Matrices created by createMat() share their non-zero
+  pattern, so only the values are stored for each member.
+
+  The design variables of the elements and auxiliary elements are
+  restored when the assembly is complete. Elements may share data
+  between them, so the assembly is not performed on the threads.
+
+  @param nmembers The number of members in the ensemble
+  @param dvs The design variables for each member
+  @param vars The state variables for each member (NULL for the current)
+  @param alpha Coefficient for the variables
+  @param beta Coefficient for the time-derivative terms
+  @param gamma Coefficient for the second time derivative term
+  @param residuals The residual for each member (may be NULL)
+  @param mats The Jacobian matrix for each member (may be NULL)
+  @param matOr The matrix orientation NORMAL or TRANSPOSE
 */
-void TACSAssembler::getInitConditions(TACSBVec *vars, TACSBVec *dvars,
-                                      TACSBVec *ddvars) {
-  // If the user requests initial conditions of vars and vars0 has not been set,
-  // zero the vector to prepare to get initial conditions from the element
-  // interface
-  if (vars && !vars0) {
-    vars->zeroEntries();
-  }
-  if (dvars && !dvars0) {
-    dvars->zeroEntries();
+void TACSAssembler::assembleJacobianEnsemble(
+    int nmembers, TACSBVec **dvs, TACSBVec **vars, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, TACSBVec **residuals, TACSMat **mats,
+    MatrixOrientation matOr) {
+  TACSProfileScope scope("TACSAssembler::assembleJacobianEnsemble");
+
+  // Keep the current design variables of the auxiliary elements so
+  // that they can be restored
+  TACSBVec *current = createDesignVec();
+  current->incref();
+  getDesignVars(current);
+  current->beginDistributeValues();
+  current->endDistributeValues();
+
+  // Distribute the design and state variables of each member and zero
+  // the outputs
+  for (int k = 0; k < nmembers; k++) {
+    dvs[k]->beginDistributeValues();
+    dvs[k]->endDistributeValues();
+    if (vars) {
+      vars[k]->beginDistributeValues();
+      vars[k]->endDistributeValues();
+    }
+    if (residuals) {
+      residuals[k]->zeroEntries();
+    }
+    if (mats) {
+      mats[k]->zeroEntries();
+    }
   }
-  if (ddvars && !ddvars0) {
-    ddvars->zeroEntries();
+
+  if (auxElements) {
+    auxElements->sort();
   }
+  initDesignVarMap();
 
   // Retrieve pointers to temporary storage
-  TacsScalar *elemVars, *elemDVars, *elemDDVars, *elemXpts;
-  getDataPointers(elementData, &elemVars, &elemDVars, &elemDDVars, NULL,
-                  &elemXpts, NULL, NULL, NULL);
+  TacsScalar *elemVars, *dvars, *ddvars, *elemRes, *elemXpts, *elemWeights;
+  getDataPointers(elementData, &elemVars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  NULL, &elemWeights, NULL);
+  TACSScratchScope scratch;
+  TacsScalar *elemMat = scratch.allocScalars(maxElementSize * maxElementSize);
+  TacsScalar *dvVals = elementSensData;
+  int *dvNums = elementSensIData;
+  const int maxDVs = maxElementDesignVars;
 
-  // Retrieve the initial condition values from each element
-  if ((vars && !vars0) || (dvars && !dvars0) || (ddvars && !ddvars0)) {
-    for (int i = 0; i < numElements; i++) {
-      int ptr = elementNodeIndex[i];
-      int len = elementNodeIndex[i + 1] - ptr;
-      const int *nodes = &elementTacsNodes[ptr];
-      xptVec->getValues(len, nodes, elemXpts);
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (auxElements) {
+    naux = auxElements->getAuxElements(&aux);
+  }
 
-      // Get the initial condition values
-      int nvars = elements[i]->getNumVariables();
-      memset(elemVars, 0, nvars * sizeof(TacsScalar));
-      memset(elemDVars, 0, nvars * sizeof(TacsScalar));
-      memset(elemDDVars, 0, nvars * sizeof(TacsScalar));
-      elements[i]->getInitConditions(i, elemXpts, elemVars, elemDVars,
-                                     elemDDVars);
+  for (int i = 0; i < numElements; i++) {
+    // Retrieve the values shared by all the members
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+    if (!vars) {
+      varsVec->getValues(len, nodes, elemVars);
+    }
 
-      // Set the values into the vectors
-      if (vars && !vars0) {
-        vars->setValues(len, nodes, elemVars, TACS_INSERT_NONZERO_VALUES);
+    int nvars = elements[i]->getNumVariables();
+    int dvPtr = elementDVPtr[i];
+    int numDVs = elementDVPtr[i + 1] - dvPtr;
+    const int *elemDVNums = &elementDVNums[dvPtr];
+
+    // Find the auxiliary elements, which are sorted by element number
+    while (aux_count < naux && aux[aux_count].num < i) {
+      aux_count++;
+    }
+    int aux_start = aux_count;
+    while (aux_count < naux && aux[aux_count].num == i) {
+      aux_count++;
+    }
+    int aux_end = aux_count;
+
+    TACSElement *loads[2];
+    int nloads = getBodyLoads(i, loads);
+
+    for (int k = 0; k < nmembers; k++) {
+      // Set the design variables and states of this member
+      if (numDVs > 0) {
+        dvs[k]->getValues(numDVs, elemDVNums, dvVals);
+        elements[i]->setDesignVars(i, numDVs, dvVals);
       }
-      if (dvars && !dvars0) {
-        dvars->setValues(len, nodes, elemDVars, TACS_INSERT_NONZERO_VALUES);
+      for (int j = aux_start; j < aux_end; j++) {
+        int n = aux[j].elem->getDesignVarNums(aux[j].num, maxDVs, dvNums);
+        if (n > 0) {
+          dvs[k]->getValues(n, dvNums, dvVals);
+          aux[j].elem->setDesignVars(aux[j].num, n, dvVals);
+        }
       }
-      if (ddvars && !ddvars0) {
-        ddvars->setValues(len, nodes, elemDDVars, TACS_INSERT_NONZERO_VALUES);
+      if (vars) {
+        vars[k]->getValues(len, nodes, elemVars);
       }
-    }
-  }
 
-  // If the the initial conditions of vars is requested and the vars0 vector has
-  // not been declared, then set the values of the tacs vector
-  if (vars && !vars0) {
-    vars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  }
-  if (dvars && !dvars0) {
-    dvars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  }
-  if (ddvars && !ddvars0) {
-    ddvars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  }
-  if (vars && !vars0) {
-    vars->endSetValues(TACS_INSERT_NONZERO_VALUES);
-  }
-  if (dvars && !dvars0) {
-    dvars->endSetValues(TACS_INSERT_NONZERO_VALUES);
-  }
-  if (ddvars && !ddvars0) {
-    ddvars->beginSetValues(TACS_INSERT_NONZERO_VALUES);
-  }
+      memset(elemRes, 0, nvars * sizeof(TacsScalar));
+      memset(elemMat, 0, nvars * nvars * sizeof(TacsScalar));
+      elements[i]->addJacobian(i, time, alpha, beta, gamma, elemXpts, elemVars,
+                               dvars, ddvars, elemRes, elemMat);
+      for (int j = aux_start; j < aux_end; j++) {
+        aux[j].elem->addJacobian(i, time, alpha, beta, gamma, elemXpts,
+                                 elemVars, dvars, ddvars, elemRes, elemMat);
+      }
+      for (int l = 0; l < nloads; l++) {
+        loads[l]->addJacobian(i, time, alpha, beta, gamma, elemXpts, elemVars,
+                              dvars, ddvars, elemRes, elemMat);
+      }
+
+      if (residuals) {
+        residuals[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+      }
+      if (mats) {
+        addMatValues(mats[k], i, elemMat, elementIData, elemWeights, matOr,
+                     aux_end > aux_start || nloads > 0);
+      }
+    }
 
-  // If the vars is requested and vars0 has been set, then copy the values from
-  // vars0
-  if (vars && vars0) {
-    vars->copyValues(vars0);
-  }
-  if (dvars && dvars0) {
-    dvars->copyValues(dvars0);
+    // Restore the design variables last set into the element
+    if (numDVs > 0) {
+      elements[i]->setDesignVars(i, numDVs,
+                                 &elementDVVals[designVarsPerNode * dvPtr]);
+    }
+    for (int j = aux_start; j < aux_end; j++) {
+      int n = aux[j].elem->getDesignVarNums(aux[j].num, maxDVs, dvNums);
+      if (n > 0) {
+        current->getValues(n, dvNums, dvVals);
+        aux[j].elem->setDesignVars(aux[j].num, n, dvVals);
+      }
+    }
   }
-  if (ddvars && ddvars0) {
-    ddvars->copyValues(ddvars0);
+  current->decref();
+
+  // Complete the assembly and apply the boundary conditions
+  for (int k = 0; k < nmembers; k++) {
+    if (mats) {
+      mats[k]->beginAssembly();
+      mats[k]->endAssembly();
+      mats[k]->applyBCs(bcMap);
+    }
+    if (residuals) {
+      residuals[k]->beginSetValues(TACS_ADD_VALUES);
+      residuals[k]->endSetValues(TACS_ADD_VALUES);
+      residuals[k]->applyBCs(bcMap, vars ? vars[k] : varsVec);
+    }
   }
 }
 
 /**
-Set the initial conditions for the problem
+  Set whether to reassemble the Jacobian incrementally
+
+  When set, assembleJacobian() caches the element matrices together
+  with the node locations, design variables and state variables used
+  to compute them. On subsequent calls with the same matrix,
+  coefficients, orientation and simulation time, only the elements
+  whose inputs have changed are recomputed. Their contributions are
+  updated by adding the difference between the new and cached element
+  matrices, without zeroing the matrix.
+
+  For linear problems, the element Jacobians do not depend on the
+  state variables and changes to the states from setVariables() do not
+  require the element matrices to be recomputed. Set the linear flag
+  only if this is true.
+
+  The matrix must not be modified between calls to assembleJacobian().
+  Use invalidateIncrementalJacobian() to force a full reassembly if
+  any other element data is modified directly. Incremental assembly is
+  only used for matrices of type TACSParallelMat and is performed
+  without threads. Round-off errors from repeated updates mean that the
+  matrix is not bitwise identical to a full assembly.
+
+  @param flag Flag indicating whether to use incremental assembly
+  @param linear Flag indicating the Jacobian does not depend on the states
+  @param max_memory_mb Maximum size of the cache in MB (< 0 for no limit)
+*/
+void TACSAssembler::setIncrementalJacobian(int flag, int linear,
+                                           double max_memory_mb) {
+  invalidateIncrementalJacobian();
+  useIncrementalJacobian = flag;
+  incrementalLinear = linear;
+  incrementalMaxMemory = max_memory_mb;
+}
 
-  @param vars The initial variable values (may be NULL)
-  @param dvars The initial time derivative values (may be NULL)
-  @param ddvars The initial second time derivative values (may be NULL)
+/**
+  Discard the cached element data so that the next call to
+  assembleJacobian() performs a full assembly
 */
-void TACSAssembler::setInitConditions(TACSBVec *vars, TACSBVec *dvars,
-                                      TACSBVec *ddvars) {
-  // Copy the values to the array.
-  if (vars) {
-    if (!vars0) {
-      vars0 = createVec();
-      vars0->incref();
-    }
-    vars0->copyValues(vars);
+void TACSAssembler::invalidateIncrementalJacobian() {
+  if (incrementalMat) {
+    incrementalMat->decref();
   }
-  if (dvars) {
-    if (!dvars0) {
-      dvars0 = createVec();
-      dvars0->incref();
-    }
-    dvars0->copyValues(dvars);
+  if (incrementalPtr) {
+    delete[] incrementalPtr;
   }
-  if (ddvars) {
-    if (!ddvars0) {
-      ddvars0 = createVec();
-      ddvars0->incref();
-    }
-    ddvars0->copyValues(ddvars);
+  if (incrementalCache) {
+    delete[] incrementalCache;
   }
+  incrementalMat = NULL;
+  incrementalPtr = NULL;
+  incrementalCache = NULL;
+  updateElementCacheMemory();
 }
 
 /**
-  Zero the entries of the local variables
+  Set the tolerance for lagging element matrices in the incremental
+  Jacobian
+
+  Elements whose states differ from the states used to compute their
+  cached matrices by no more than the tolerance in every component keep
+  their cached matrices. Since the comparison is against the cached
+  states, the lag does not accumulate beyond the tolerance. This is
+  useful for problems, such as phase change, where the Jacobian only
+  changes sharply in a small region. The resulting matrix is
+  approximate, so it should only be used where an inexact Jacobian is
+  acceptable, for instance in Newton's method. A zero tolerance, the
+  default, only reuses element matrices when the states are unchanged.
+
+  When the time independent flag is set, the element Jacobians do not
+  depend explicitly on the simulation time, so a change in time does
+  not force a full assembly.
+
+  @param state_tol The largest change in the states that is lagged
+  @param time_independent Flag indicating the Jacobian does not depend on time
 */
-void TACSAssembler::zeroVariables() { varsVec->zeroEntries(); }
+void TACSAssembler::setIncrementalJacobianTolerance(double state_tol,
+                                                    int time_independent) {
+  incrementalStateTol = state_tol;
+  incrementalTimeIndependent = time_independent;
+}
 
 /**
-  Zero the values of the time-derivatives of the state variables.
-  This time-derivative is load-case independent.
-*/
-void TACSAssembler::zeroDotVariables() { dvarsVec->zeroEntries(); }
+  Get the memory in bytes used by the incremental Jacobian cache
 
-/**
-  Zero the values of the time-derivatives of the state variables.
-  This time-derivative is load-case independent.
+  @return The memory used by the cache
 */
-void TACSAssembler::zeroDDotVariables() { ddvarsVec->zeroEntries(); }
+size_t TACSAssembler::getIncrementalJacobianMemory() {
+  size_t mem = 0;
+  if (incrementalPtr) {
+    mem = sizeof(size_t) * (numElements + 1);
+    mem += sizeof(TacsScalar) * incrementalPtr[numElements];
+  }
+  return mem;
+}
 
 /**
-  Set the value of the time/variables/time derivatives simultaneously
-
-  @param vars The variable values (may be NULL)
-  @param dvars The time derivative values (may be NULL)
-  @param ddvars The second time derivative values (may be NULL)
+  Set whether to cache the element stiffness matrices
+
+  This cache is intended for linear static problems that are solved
+  for many load cases. The element residual is computed from the
+  cached values as r(u) = r(0) + K*u, where K is the element stiffness
+  matrix. The cached values are used in assembleRes(),
+  assembleJacobian() and addJacobianVecProduct() whenever the time
+  derivatives of the states are zero and, for the Jacobian, when the
+  coefficients beta and gamma are zero. The auxiliary elements are not
+  cached.
+
+  The cache is only valid if the element residuals are linear in the
+  states. The cached values are recomputed after a call to
+  setDesignVars(), setNodes() or setSimulationTime(). Use
+  clearElementMatCache() if any other element data is modified.
+
+  When a memory budget is given, only the elements that fit within the
+  budget are cached and the remaining elements are computed normally.
+
+  @param flag Flag indicating whether to use the cache
+  @param max_memory_mb Maximum size of the cache in MB (< 0 for no limit)
 */
-void TACSAssembler::setVariables(TACSBVec *vars, TACSBVec *dvars,
-                                 TACSBVec *ddvars) {
-  // Copy the values to the array.
-  if (vars) {
-    varsVec->copyValues(vars);
+void TACSAssembler::setElementMatCache(int flag, double max_memory_mb) {
+  if (elementMatCachePtr) {
+    delete[] elementMatCachePtr;
   }
-  if (dvars) {
-    dvarsVec->copyValues(dvars);
+  if (elementMatCacheFlags) {
+    delete[] elementMatCacheFlags;
   }
-  if (ddvars) {
-    ddvarsVec->copyValues(ddvars);
+  if (elementMatCacheData) {
+    delete[] elementMatCacheData;
   }
+  elementMatCachePtr = NULL;
+  elementMatCacheFlags = NULL;
+  elementMatCacheData = NULL;
+  elementMatCacheHits = 0;
+  elementMatCacheMisses = 0;
+  updateElementCacheMemory();
 
-  // Distribute the values and evaluate the dependent nodes.
-  if (vars) {
-    varsVec->beginDistributeValues();
-  }
-  if (dvars) {
-    dvarsVec->beginDistributeValues();
+  useElementMatCache = flag;
+  elementMatCacheMaxMemory = max_memory_mb;
+}
+
+/**
+  Discard the values stored in the element matrix cache so that they
+  are recomputed the next time they are needed
+*/
+void TACSAssembler::clearElementMatCache() {
+  if (elementMatCacheFlags) {
+    memset(elementMatCacheFlags, 0, numElements * sizeof(int));
   }
-  if (ddvars) {
-    ddvarsVec->beginDistributeValues();
+}
+
+/**
+  Get the memory in bytes used by the element matrix cache
+
+  @return The memory used by the cache
+*/
+size_t TACSAssembler::getElementMatCacheMemory() {
+  size_t mem = 0;
+  if (elementMatCachePtr) {
+    mem = sizeof(size_t) * (numElements + 1) + sizeof(int) * numElements;
+    mem += sizeof(TacsScalar) * elementMatCachePtr[numElements];
   }
-  if (vars) {
-    varsVec->endDistributeValues();
+  return mem;
+}
+
+/**
+  Get the number of element evaluations that used the cache (hits) and
+  the number that were computed directly or had to fill the cache
+  (misses)
+
+  @param hits The number of cache hits
+  @param misses The number of cache misses
+  @param reset Flag indicating whether to reset the counters
+*/
+void TACSAssembler::getElementMatCacheStats(long *hits, long *misses,
+                                            int reset) {
+  if (hits) {
+    *hits = elementMatCacheHits;
   }
-  if (dvars) {
-    dvarsVec->endDistributeValues();
+  if (misses) {
+    *misses = elementMatCacheMisses;
   }
-  if (ddvars) {
-    ddvarsVec->endDistributeValues();
+  if (reset) {
+    elementMatCacheHits = 0;
+    elementMatCacheMisses = 0;
   }
 }
 
 /**
-  Copy the values directly without distributing them.
+  Set whether the elements cache the geometric data computed from the
+  node locations
 
-  This is designed for specific instances where you want to use the
-  values in the vector directly without distributing them.  This means
-  that the variable values may be inconsistent across processors.
-  This is not usually what you want to do.
+  Elements that support the cache store data such as the local frames
+  and the Jacobian transformations at the quadrature points the first
+  time they are evaluated, and reuse them in later calls to
+  assembleRes() and assembleJacobian(). This avoids recomputing the
+  geometry in time-dependent and Newton iterations where the nodes do
+  not change. The cached data is discarded by setNodes().
 
-  @param vars The variable values (may be NULL)
-  @param dvars The time derivative values (may be NULL)
-  @param ddvars The second time derivative values (may be NULL)
+  The element objects must not be shared with another TACSAssembler
+  object while the cache is active.
+
+  @param flag Flag indicating whether to use the cache
 */
-void TACSAssembler::copyVariables(TACSBVec *vars, TACSBVec *dvars,
-                                  TACSBVec *ddvars) {
-  if (vars) {
-    varsVec->copyValues(vars);
-  }
-  if (dvars) {
-    dvarsVec->copyValues(dvars);
-  }
-  if (ddvars) {
-    ddvarsVec->copyValues(ddvars);
+void TACSAssembler::setElementGeometryCache(int flag) {
+  useElementGeometryCache = flag;
+  for (int i = 0; i < numElements; i++) {
+    elements[i]->setGeometryCache(flag ? numElements : 0);
   }
 }
 
 /**
-  Get the variables from the vectors in TACS
+  Set whether the element matrices in the Jacobian are symmetric
 
-  @param vars The variable values (may be NULL)
-  @param dvars The time derivative values (may be NULL)
-  @param ddvars The second time derivative values (may be NULL)
+  When set, assembleJacobian() allows the elements to compute only the
+  upper triangle of their contribution to the Jacobian, and fills the
+  lower triangle from the upper triangle before the contributions from
+  the auxiliary elements are added. Elements that do not exploit the
+  symmetry compute the full matrix as before.
+
+  This option is only valid when the Jacobian of every element is
+  symmetric for the values of alpha, beta and gamma that are used,
+  for instance for linear elastic problems. It does not apply to the
+  auxiliary elements.
+
+  @param flag Flag indicating whether the element matrices are symmetric
 */
-void TACSAssembler::getVariables(TACSBVec *vars, TACSBVec *dvars,
-                                 TACSBVec *ddvars) {
-  // Copy the values to the array. Only local values are
-  // copied, not external/dependents
-  if (vars) {
-    vars->copyValues(varsVec);
-  }
-  if (dvars) {
-    dvars->copyValues(dvarsVec);
-  }
-  if (ddvars) {
-    ddvars->copyValues(ddvarsVec);
-  }
+void TACSAssembler::setSymmetricElementMatrices(int flag) {
+  useSymmetricElementMatrices = flag;
 }
 
 /**
-  Get the variables from the vectors in TACS
+  Set whether to apply the boundary conditions during the assembly
+
+  When set, assembleJacobian() zeros the rows of each element matrix
+  for the constrained variables before the matrix is added, and adds
+  the unit diagonal entries for the constrained variables of the owned
+  nodes. This gives the same matrix as the post-assembly pass in
+  TACSMat::applyBCs(), without a second sweep over the constrained
+  rows of the assembled matrix.
+
+  The boundary conditions are only applied during the assembly when
+  there are no dependent nodes, since the rows of the constrained
+  nodes may otherwise receive contributions through the dependent
+  node weights. The post-assembly pass is used in that case, and for
+  the incremental update of the Jacobian.
+
+  @param flag Flag indicating whether to apply the BCs during assembly
+*/
+void TACSAssembler::setAssemblyBCs(int flag) { useAssemblyBCs = flag; }
 
-  @param vars The variable values (may be NULL)
-  @param dvars The time derivative values (may be NULL)
-  @param ddvars The second time derivative values (may be NULL)
+/*
+  Check whether the boundary conditions are applied during the
+  assembly of the Jacobian
 */
-void TACSAssembler::getVariables(TACSBVec **vars, TACSBVec **dvars,
-                                 TACSBVec **ddvars) {
-  // Copy the values to the array. Only local values are
-  // copied, not external/dependents
-  if (vars) {
-    *vars = varsVec;
+int TACSAssembler::isAssemblyBCsActive() {
+  return (useAssemblyBCs && meshInitializedFlag && numDependentNodes == 0);
+}
+
+/*
+  Compute the constrained variables for each element node and for each
+  owned boundary condition node. The boundary condition map includes
+  the external nodes, so the flags are available for all the nodes
+  referenced by the elements on this processor.
+*/
+void TACSAssembler::initAssemblyBCs() {
+  const int *nodes, *vars;
+  int nbcs = bcMap->getBCs(&nodes, &vars, NULL);
+
+  // Find the unique nodes and combine the flags for each node
+  int *bc_nodes = new int[nbcs];
+  memcpy(bc_nodes, nodes, nbcs * sizeof(int));
+  int num_bc_nodes = TacsUniqueSort(nbcs, bc_nodes);
+  int *bc_flags = new int[num_bc_nodes];
+  memset(bc_flags, 0, num_bc_nodes * sizeof(int));
+  for (int i = 0; i < nbcs; i++) {
+    int *item = TacsSearchArray(nodes[i], num_bc_nodes, bc_nodes);
+    bc_flags[item - bc_nodes] |= vars[i];
+  }
+
+  // Set the flags for each node of each element
+  int size = elementNodeIndex[numElements];
+  elementBCFlags = new int[size];
+  for (int j = 0; j < size; j++) {
+    elementBCFlags[j] = 0;
+    if (elementTacsNodes[j] >= 0) {
+      int *item =
+          TacsSearchArray(elementTacsNodes[j], num_bc_nodes, bc_nodes);
+      if (item) {
+        elementBCFlags[j] = bc_flags[item - bc_nodes];
+      }
+    }
   }
-  if (dvars) {
-    *dvars = dvarsVec;
+
+  // Store the owned nodes, which receive the diagonal entries
+  const int *ownerRange;
+  nodeMap->getOwnerRange(&ownerRange);
+  numOwnedBCNodes = 0;
+  ownedBCNodes = new int[num_bc_nodes];
+  ownedBCFlags = new int[num_bc_nodes];
+  for (int i = 0; i < num_bc_nodes; i++) {
+    if (bc_nodes[i] >= ownerRange[mpiRank] &&
+        bc_nodes[i] < ownerRange[mpiRank + 1] && bc_flags[i]) {
+      ownedBCNodes[numOwnedBCNodes] = bc_nodes[i];
+      ownedBCFlags[numOwnedBCNodes] = bc_flags[i];
+      numOwnedBCNodes++;
+    }
   }
-  if (ddvars) {
-    *ddvars = ddvarsVec;
+
+  delete[] bc_nodes;
+  delete[] bc_flags;
+}
+
+/*
+  Add the unit diagonal entries for the constrained variables of the
+  owned nodes. The constrained rows have no other entries, since the
+  rows of the element matrices have been zeroed.
+*/
+void TACSAssembler::addAssemblyBCDiagonal(TACSMat *A) {
+  int bsize = varsPerNode;
+  TacsScalar *ident = new TacsScalar[bsize * bsize];
+  for (int i = 0; i < numOwnedBCNodes; i++) {
+    for (int k = 0; k < bsize * bsize; k++) {
+      ident[k] = 0.0;
+    }
+    for (int j = 0; j < bsize; j++) {
+      if (ownedBCFlags[i] & (1 << j)) {
+        ident[(bsize + 1) * j] = 1.0;
+      }
+    }
+    A->addValues(1, &ownedBCNodes[i], 1, &ownedBCNodes[i], bsize, bsize,
+                 ident);
   }
+  delete[] ident;
 }
 
 /**
-  Set the simulation time internally in the TACSAssembler object
+  Set whether to accumulate the time spent in each element
+
+  When set, the wall time spent gathering the element data, computing
+  the element residuals and Jacobians and adding the element matrices
+  to the global matrix is accumulated for each element in
+  assembleRes(), assembleJacobian() and assembleMatType(). The times
+  for a batch of elements that share the same element object are
+  split evenly between the elements in the batch. The times can be
+  retrieved for each element, for instance to set the costs used to
+  balance the threaded element loops with setElementCosts(), or
+  summarized by element type and component with printElementTimes().
+
+  @param flag Flag indicating whether to accumulate the element times
+*/
+void TACSAssembler::setElementTiming(int flag) {
+  if (flag && !elementTimes) {
+    elementTimes = new double[NUM_ELEMENT_TIMING_TYPES * numElements];
+    zeroElementTimes();
+  } else if (!flag && elementTimes) {
+    delete[] elementTimes;
+    elementTimes = NULL;
+  }
+}
 
-  @param _time The simulation time
+/**
+  Zero the accumulated element times
 */
-void TACSAssembler::setSimulationTime(double _time) { time = _time; }
+void TACSAssembler::zeroElementTimes() {
+  if (elementTimes) {
+    memset(elementTimes, 0,
+           NUM_ELEMENT_TIMING_TYPES * numElements * sizeof(double));
+  }
+}
 
-/*
-  Retrieve the simulation time from the TACSAssembler object
+/**
+  Get the accumulated time for each local element
 
-  @return The simulation time
+  @param type The type of element time
+  @param times The time for each local element
 */
-double TACSAssembler::getSimulationTime() { return time; }
+void TACSAssembler::getElementTimes(ElementTimingType type, double times[]) {
+  for (int i = 0; i < numElements; i++) {
+    times[i] =
+        (elementTimes ? elementTimes[NUM_ELEMENT_TIMING_TYPES * i + type] : 0.0);
+  }
+}
 
 /**
-  Evaluates the total kinetic and potential energies of the structure
+  Get the accumulated element times for each component
 
-  @param Te The kinetic energy
-  @param Pe The potential energy
+  This call is collective. The times are summed over all processors
+  and stored as NUM_ELEMENT_TIMING_TYPES values for each component.
+
+  @param times The times for each component
 */
-void TACSAssembler::evalEnergies(TacsScalar *Te, TacsScalar *Pe) {
-  // Zero the kinetic and potential energy
-  *Te = 0.0;
-  *Pe = 0.0;
+void TACSAssembler::getComponentTimes(double times[]) {
+  int num_comps = getNumComponents();
+  int size = NUM_ELEMENT_TIMING_TYPES * num_comps;
 
-  // Retrieve pointers to temporary storage
-  TacsScalar *vars, *dvars, *elemXpts;
-  getDataPointers(elementData, &vars, &dvars, NULL, NULL, &elemXpts, NULL, NULL,
-                  NULL);
+  double *local = new double[size];
+  memset(local, 0, size * sizeof(double));
+  if (elementTimes) {
+    for (int i = 0; i < numElements; i++) {
+      int comp = elements[i]->getComponentNum();
+      if (comp >= 0 && comp < num_comps) {
+        for (int k = 0; k < NUM_ELEMENT_TIMING_TYPES; k++) {
+          local[NUM_ELEMENT_TIMING_TYPES * comp + k] +=
+              elementTimes[NUM_ELEMENT_TIMING_TYPES * i + k];
+        }
+      }
+    }
+  }
 
-  // Loop over all elements and add individual contributions to the
-  // total energy
+  MPI_Allreduce(local, times, size, MPI_DOUBLE, MPI_SUM, tacs_comm);
+  delete[] local;
+}
+
+/**
+  Print a summary of the accumulated element times
+
+  This call is collective. The times are summed over all processors
+  for each element type, identified by the name of the element class,
+  and for each component, and are printed on the root processor.
+
+  @param fp The file to print the summary to
+*/
+void TACSAssembler::printElementTimes(FILE *fp) {
+  const int ntypes = NUM_ELEMENT_TIMING_TYPES;
+  const int nv = ntypes + 1;
+
+  // Sum the times for each element type on this processor
+  int num_names = 0;
+  const char **names = new const char *[numElements];
+  double *vals = new double[nv * numElements];
   for (int i = 0; i < numElements; i++) {
-    int ptr = elementNodeIndex[i];
-    int len = elementNodeIndex[i + 1] - ptr;
-    const int *nodes = &elementTacsNodes[ptr];
-    xptVec->getValues(len, nodes, elemXpts);
-    varsVec->getValues(len, nodes, vars);
-    dvarsVec->getValues(len, nodes, dvars);
+    const char *name = elements[i]->getObjectName();
+    int index = 0;
+    while (index < num_names && strcmp(names[index], name) != 0) {
+      index++;
+    }
+    if (index == num_names) {
+      names[index] = name;
+      memset(&vals[nv * index], 0, nv * sizeof(double));
+      num_names++;
+    }
+    vals[nv * index] += 1.0;
+    for (int k = 0; k < ntypes; k++) {
+      vals[nv * index + 1 + k] +=
+          (elementTimes ? elementTimes[ntypes * i + k] : 0.0);
+    }
+  }
+
+  // Pack the names into a single buffer
+  int name_len = 0;
+  for (int k = 0; k < num_names; k++) {
+    name_len += strlen(names[k]) + 1;
+  }
+  char *name_buff = new char[name_len + 1];
+  for (int k = 0, offset = 0; k < num_names; k++) {
+    strcpy(&name_buff[offset], names[k]);
+    offset += strlen(names[k]) + 1;
+  }
+
+  // Gather the names and the values on the root
+  int rank, size;
+  MPI_Comm_rank(tacs_comm, &rank);
+  MPI_Comm_size(tacs_comm, &size);
+
+  int counts[2] = {num_names, name_len};
+  int *all_counts = NULL;
+  if (rank == 0) {
+    all_counts = new int[2 * size];
+  }
+  MPI_Gather(counts, 2, MPI_INT, all_counts, 2, MPI_INT, 0, tacs_comm);
+
+  int *name_cnt = NULL, *name_ptr = NULL, *val_cnt = NULL, *val_ptr = NULL;
+  char *all_names = NULL;
+  double *all_vals = NULL;
+  if (rank == 0) {
+    name_cnt = new int[size];
+    name_ptr = new int[size + 1];
+    val_cnt = new int[size];
+    val_ptr = new int[size + 1];
+    name_ptr[0] = val_ptr[0] = 0;
+    for (int k = 0; k < size; k++) {
+      val_cnt[k] = nv * all_counts[2 * k];
+      name_cnt[k] = all_counts[2 * k + 1];
+      val_ptr[k + 1] = val_ptr[k] + val_cnt[k];
+      name_ptr[k + 1] = name_ptr[k] + name_cnt[k];
+    }
+    all_names = new char[name_ptr[size] + 1];
+    all_vals = new double[val_ptr[size] + 1];
+  }
+  MPI_Gatherv(name_buff, name_len, MPI_CHAR, all_names, name_cnt, name_ptr,
+              MPI_CHAR, 0, tacs_comm);
+  MPI_Gatherv(vals, nv * num_names, MPI_DOUBLE, all_vals, val_cnt, val_ptr,
+              MPI_DOUBLE, 0, tacs_comm);
+
+  delete[] names;
+  delete[] vals;
+  delete[] name_buff;
+
+  // Compute the times for each component
+  int num_comps = getNumComponents();
+  double *comp_times = new double[ntypes * num_comps];
+  getComponentTimes(comp_times);
+
+  if (rank == 0) {
+    // Merge the values from all processors with the same name
+    int num_total = val_ptr[size] / nv;
+    const char **merged_names = new const char *[num_total + 1];
+    double *merged_vals = new double[nv * (num_total + 1)];
+    int num_merged = 0;
+
+    const char *name = all_names;
+    for (int j = 0; j < num_total; j++) {
+      int index = 0;
+      while (index < num_merged && strcmp(merged_names[index], name) != 0) {
+        index++;
+      }
+      if (index == num_merged) {
+        merged_names[index] = name;
+        memset(&merged_vals[nv * index], 0, nv * sizeof(double));
+        num_merged++;
+      }
+      for (int k = 0; k < nv; k++) {
+        merged_vals[nv * index + k] += all_vals[nv * j + k];
+      }
+      name += strlen(name) + 1;
+    }
 
-    // Compute and add the element's contributions to the total
-    // energy
-    TacsScalar elemTe, elemPe;
-    elements[i]->computeEnergies(i, time, elemXpts, vars, dvars, &elemTe,
-                                 &elemPe);
+    fprintf(fp, "TACSAssembler element times [s] summed over %d processors\n",
+            size);
+    fprintf(fp, "%-40s %10s %12s %12s %12s %12s\n", "Element", "Count",
+            "GetValues", "Residual", "Jacobian", "MatValues");
+    for (int j = 0; j < num_merged; j++) {
+      fprintf(fp, "%-40s %10.0f", merged_names[j], merged_vals[nv * j]);
+      for (int k = 0; k < ntypes; k++) {
+        fprintf(fp, " %12.4e", merged_vals[nv * j + 1 + k]);
+      }
+      fprintf(fp, "\n");
+    }
 
-    // Add up the kinetic and potential energy
-    *Te += elemTe;
-    *Pe += elemPe;
+    fprintf(fp, "%-40s %10s %12s %12s %12s %12s\n", "Component", "",
+            "GetValues", "Residual", "Jacobian", "MatValues");
+    for (int j = 0; j < num_comps; j++) {
+      fprintf(fp, "%-40d %10s", j, "");
+      for (int k = 0; k < ntypes; k++) {
+        fprintf(fp, " %12.4e", comp_times[ntypes * j + k]);
+      }
+      fprintf(fp, "\n");
+    }
+
+    delete[] merged_names;
+    delete[] merged_vals;
+    delete[] all_counts;
+    delete[] name_cnt;
+    delete[] name_ptr;
+    delete[] val_cnt;
+    delete[] val_ptr;
+    delete[] all_names;
+    delete[] all_vals;
+  }
+
+  delete[] comp_times;
+}
+
+/*
+  Split the time spent on a batch of elements evenly between the
+  elements in the batch
+*/
+void TACSAssembler::addElementTime(ElementTimingType type, int n,
+                                   const int *elemIndices, double t) {
+  double tn = t / n;
+  for (int j = 0; j < n; j++) {
+    elementTimes[NUM_ELEMENT_TIMING_TYPES * elemIndices[j] + type] += tn;
+  }
+}
+
+/*
+  Record the memory held by the element matrix and incremental
+  Jacobian caches
+*/
+void TACSAssembler::updateElementCacheMemory() {
+  TACSMemory::update(
+      TACS_MEMORY_ELEMENT_CACHE, &elementCacheMemory,
+      getElementMatCacheMemory() + getIncrementalJacobianMemory());
+}
+
+/*
+  Set the lower triangle of a square row-major matrix from the upper
+  triangle
+*/
+static inline void TacsCopyUpperToLower(int n, TacsScalar *mat) {
+  for (int i = 1; i < n; i++) {
+    for (int j = 0; j < i; j++) {
+      mat[n * i + j] = mat[n * j + i];
+    }
+  }
+}
+
+/*
+  Allocate the element matrix cache if required, and discard the
+  cached values if the simulation time has changed. This must be
+  called before any threads access the cache.
+*/
+void TACSAssembler::initElementMatCache() {
+  if (!useElementMatCache) {
+    return;
   }
 
-  // Sum up the kinetic and potential energies across all processors
-  TacsScalar input[2], output[2];
-  input[0] = *Te;
-  input[1] = *Pe;
-  MPI_Allreduce(input, output, 2, TACS_MPI_TYPE, MPI_SUM, tacs_comm);
+  if (!elementMatCachePtr) {
+    // Determine the number of entries that fit within the budget
+    double budget = -1.0;
+    if (elementMatCacheMaxMemory >= 0.0) {
+      budget = 1e6 * elementMatCacheMaxMemory / sizeof(TacsScalar);
+    }
 
-  *Te = output[0];
-  *Pe = output[1];
+    elementMatCachePtr = new size_t[numElements + 1];
+    elementMatCachePtr[0] = 0;
+    for (int i = 0; i < numElements; i++) {
+      size_t nvars = elements[i]->getNumVariables();
+      size_t size = nvars + nvars * nvars;
+      elementMatCachePtr[i + 1] = elementMatCachePtr[i];
+      if (budget < 0.0 || elementMatCachePtr[i] + size <= budget) {
+        elementMatCachePtr[i + 1] += size;
+      }
+    }
+
+    elementMatCacheFlags = new int[numElements];
+    memset(elementMatCacheFlags, 0, numElements * sizeof(int));
+    elementMatCacheData = new TacsScalar[elementMatCachePtr[numElements]];
+    elementMatCacheTime = time;
+    updateElementCacheMemory();
+  } else if (time != elementMatCacheTime) {
+    clearElementMatCache();
+    elementMatCacheTime = time;
+  }
 }
 
-/**
-  Assemble the residual
+/*
+  Add the element residual using the cached element stiffness matrix.
 
-  This residual includes the contributions from element tractions set
-  in the auxiliary element classes. Note that the vector entries are
-  zeroed first, and that the Dirichlet boundary conditions are applied
-  after the assembly of the residual is complete.
+  If the cached values for the element have not been computed, they
+  are computed from the element Jacobian at the current states. Each
+  element's cache entry is only accessed by the thread that processes
+  that element.
 
-  @param residual The residual vector
-  @param lambda Scaling factor for the aux element contributions, by default 1
+  returns: 1 if the residual was added, 0 if the element must be
+  computed directly
 */
-void TACSAssembler::assembleRes(TACSBVec *residual, const TacsScalar lambda) {
-  // Sort the list of auxiliary elements - this only performs the
-  // sort if it is required (if new elements are added)
-  if (auxElements) {
-    auxElements->sort();
-  }
-
-  // Zero the residual
-  residual->zeroEntries();
+int TACSAssembler::addCachedResidual(int elemIndex, int nvars,
+                                     const TacsScalar *Xpts,
+                                     const TacsScalar *vars,
+                                     const TacsScalar *dvars,
+                                     const TacsScalar *ddvars,
+                                     TacsScalar *res) {
+  return addCachedJacobian(elemIndex, nvars, 0.0, 0.0, 0.0, Xpts, vars, dvars,
+                           ddvars, res, NULL);
+}
 
-  if (thread_info->getNumThreads() > 1) {
-    // Set the number of completed elements to zero
-    numCompletedElements = 0;
-    tacsPInfo->assembler = this;
-    tacsPInfo->lambda = lambda;
+/*
+  Add the element residual and alpha times the element stiffness
+  matrix using the cached values. The matrix may be NULL.
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+  returns: 1 if the values were added, 0 if the element must be
+  computed directly
+*/
+int TACSAssembler::addCachedJacobian(int elemIndex, int nvars,
+                                     TacsScalar alpha, TacsScalar beta,
+                                     TacsScalar gamma, const TacsScalar *Xpts,
+                                     const TacsScalar *vars,
+                                     const TacsScalar *dvars,
+                                     const TacsScalar *ddvars,
+                                     TacsScalar *res, TacsScalar *mat) {
+  size_t start = elementMatCachePtr[elemIndex];
+  int cached = (elementMatCachePtr[elemIndex + 1] > start);
 
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&threads[k], &attr, TACSAssembler::assembleRes_thread,
-                     (void *)tacsPInfo);
+  // The cache only contains the stiffness contributions
+  if (cached && mat) {
+    cached = (beta == 0.0 && gamma == 0.0);
+  }
+  for (int k = 0; cached && k < nvars; k++) {
+    if (dvars[k] != 0.0 || ddvars[k] != 0.0) {
+      cached = 0;
     }
+  }
+  if (!cached) {
+    elementMatCacheMisses++;
+    return 0;
+  }
 
-    // Join all the threads
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(threads[k], NULL);
-    }
+  TacsScalar *r0 = &elementMatCacheData[start];
+  TacsScalar *K = &r0[nvars];
+  TacsScalar one = 1.0, negone = -1.0;
+  int incx = 1;
 
-    // Destroy the attribute
-    pthread_attr_destroy(&attr);
+  if (elementMatCacheFlags[elemIndex]) {
+    elementMatCacheHits++;
   } else {
-    // Retrieve pointers to temporary storage
-    TacsScalar *vars, *dvars, *ddvars, *elemRes, *elemXpts;
-    getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
-                    NULL, NULL, NULL);
+    elementMatCacheMisses++;
 
-    // Get the auxiliary elements
-    int naux = 0, aux_count = 0;
-    TACSAuxElem *aux = NULL;
-    if (auxElements) {
-      naux = auxElements->getAuxElements(&aux);
+    // Compute the stiffness matrix and the residual at zero states.
+    // Note the matrix is stored in row-major order, so the transpose
+    // argument is reversed.
+    memset(r0, 0, (nvars + nvars * nvars) * sizeof(TacsScalar));
+    elements[elemIndex]->addJacobian(elemIndex, time, 1.0, 0.0, 0.0, Xpts,
+                                     vars, dvars, ddvars, r0, K);
+    if (useSymmetricElementMatrices) {
+      TacsCopyUpperToLower(nvars, K);
     }
+    BLASgemv("T", &nvars, &nvars, &negone, K, &nvars, (TacsScalar *)vars,
+             &incx, &one, r0, &incx);
+    elementMatCacheFlags[elemIndex] = 1;
+  }
 
-    // To avoid allocating memory inside the element loop, make the aux element
-    // contribution array big enough for the largest element
-    int maxNVar = this->maxElementSize;
-    TacsScalar *auxElemRes = NULL;
-    bool scaleAux = lambda != TacsScalar(1.0) && naux > 0;
-    if (scaleAux) {
-      auxElemRes = new TacsScalar[maxNVar];
+  // Add the residual r(u) = r(0) + K*u
+  for (int k = 0; k < nvars; k++) {
+    res[k] += r0[k];
+  }
+  BLASgemv("T", &nvars, &nvars, &one, K, &nvars, (TacsScalar *)vars, &incx,
+           &one, res, &incx);
+
+  // Add the scaled stiffness matrix
+  if (mat) {
+    int size = nvars * nvars;
+    for (int k = 0; k < size; k++) {
+      mat[k] += alpha * K[k];
     }
+  }
 
-    // Go through and add the residuals from all the elements
-    for (int i = 0; i < numElements; i++) {
-      int ptr = elementNodeIndex[i];
-      int len = elementNodeIndex[i + 1] - ptr;
-      const int *nodes = &elementTacsNodes[ptr];
-      xptVec->getValues(len, nodes, elemXpts);
-      varsVec->getValues(len, nodes, vars);
-      dvarsVec->getValues(len, nodes, dvars);
-      ddvarsVec->getValues(len, nodes, ddvars);
+  return 1;
+}
 
-      // Add the residual from the working element
-      int nvars = elements[i]->getNumVariables();
-      memset(elemRes, 0, nvars * sizeof(TacsScalar));
-      elements[i]->addResidual(i, time, elemXpts, vars, dvars, ddvars, elemRes);
+/*
+  Add the residuals for a batch of elements, using the cached element
+  matrices when they are available. Batches evaluated with a registered
+  kernel may contain different element objects of the same type.
+*/
+void TACSAssembler::addElementResidualBatch(
+    TACSElement *element, int n, const int *elemIndices,
+    const TacsScalar *Xpts, const TacsScalar *vars, const TacsScalar *dvars,
+    const TacsScalar *ddvars, TacsScalar *res) {
+  if (!elementMatCacheData) {
+    int kernel = (elementKernels ? elementKernels[elemIndices[0]] : -1);
+    if (kernel >= 0) {
+      elementRegistry->addResidualBatch(kernel, elements, n, elemIndices, time,
+                                        Xpts, vars, dvars, ddvars, res);
+    } else {
+      element->addResidualBatch(n, elemIndices, time, Xpts, vars, dvars,
+                                ddvars, res);
+    }
+    return;
+  }
 
-      // Add the residual from any auxiliary elements, if the load factor is 1
-      // they can be added straight to the elemRes, otherwise they need to be
-      // scaled first
-      if (!scaleAux) {
-        while (aux_count < naux && aux[aux_count].num == i) {
-          aux[aux_count].elem->addResidual(i, time, elemXpts, vars, dvars,
-                                           ddvars, elemRes);
-          aux_count++;
-        }
-      } else {
-        memset(auxElemRes, 0, maxNVar * sizeof(TacsScalar));
-        while (aux_count < naux && aux[aux_count].num == i) {
-          aux[aux_count].elem->addResidual(i, time, elemXpts, vars, dvars,
-                                           ddvars, auxElemRes);
-          aux_count++;
-        }
-        for (int jj = 0; jj < nvars; jj++) {
-          elemRes[jj] += lambda * auxElemRes[jj];
-        }
-      }
+  int nvars = element->getNumVariables();
+  int nx = TACS_SPATIAL_DIM * element->getNumNodes();
+  for (int j = 0; j < n; j++) {
+    int i = elemIndices[j];
+    if (!addCachedResidual(i, nvars, &Xpts[nx * j], &vars[nvars * j],
+                           &dvars[nvars * j], &ddvars[nvars * j],
+                           &res[nvars * j])) {
+      elements[i]->addResidual(i, time, &Xpts[nx * j], &vars[nvars * j],
+                               &dvars[nvars * j], &ddvars[nvars * j],
+                               &res[nvars * j]);
+    }
+  }
+}
 
-      // Add the residual values
-      residual->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+/*
+  Add the residuals and Jacobians for a batch of elements, using the
+  cached element matrices when they are available. When the element
+  matrices are symmetric, the lower triangles are filled from the
+  upper triangles.
+*/
+void TACSAssembler::addElementJacobianBatch(
+    TACSElement *element, int n, const int *elemIndices, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar *Xpts,
+    const TacsScalar *vars, const TacsScalar *dvars, const TacsScalar *ddvars,
+    TacsScalar *res, TacsScalar *mat) {
+  int nvars = element->getNumVariables();
+  int kernel = (elementKernels ? elementKernels[elemIndices[0]] : -1);
+  if (!elementMatCacheData && kernel >= 0) {
+    elementRegistry->addJacobianBatch(kernel, elements, n, elemIndices, time,
+                                      alpha, beta, gamma, Xpts, vars, dvars,
+                                      ddvars, res, mat);
+  } else if (!elementMatCacheData) {
+    element->addJacobianBatch(n, elemIndices, time, alpha, beta, gamma, Xpts,
+                              vars, dvars, ddvars, res, mat);
+  } else {
+    int nx = TACS_SPATIAL_DIM * element->getNumNodes();
+    for (int j = 0; j < n; j++) {
+      int i = elemIndices[j];
+      if (!addCachedJacobian(i, nvars, alpha, beta, gamma, &Xpts[nx * j],
+                             &vars[nvars * j], &dvars[nvars * j],
+                             &ddvars[nvars * j], &res[nvars * j],
+                             &mat[nvars * nvars * j])) {
+        elements[i]->addJacobian(i, time, alpha, beta, gamma, &Xpts[nx * j],
+                                 &vars[nvars * j], &dvars[nvars * j],
+                                 &ddvars[nvars * j], &res[nvars * j],
+                                 &mat[nvars * nvars * j]);
+      }
     }
+  }
 
-    if (scaleAux) {
-      delete[] auxElemRes;
+  // Fill in the lower triangle of the element matrices
+  if (useSymmetricElementMatrices) {
+    for (int j = 0; j < n; j++) {
+      TacsCopyUpperToLower(nvars, &mat[nvars * nvars * j]);
     }
   }
+}
 
-  // Finish transmitting the residual
-  residual->beginSetValues(TACS_ADD_VALUES);
-  residual->endSetValues(TACS_ADD_VALUES);
+/*
+  Copy the values from a into b and return whether any values changed
+*/
+static inline int TacsCopyChanged(int n, const TacsScalar *a, TacsScalar *b) {
+  int changed = 0;
+  for (int i = 0; i < n; i++) {
+    if (a[i] != b[i]) {
+      changed = 1;
+      b[i] = a[i];
+    }
+  }
+  return changed;
+}
 
-  // Apply the boundary conditions for the residual
-  residual->applyBCs(bcMap, varsVec);
+/*
+  Return whether any value of a differs from b by more than tol
+*/
+static inline int TacsChangedTol(int n, const TacsScalar *a,
+                                 const TacsScalar *b, double tol) {
+  for (int i = 0; i < n; i++) {
+    if (fabs(TacsRealPart(a[i] - b[i])) > tol) {
+      return 1;
+    }
+  }
+  return 0;
 }
 
-/**
-  Assemble the Jacobian matrix
+/*
+  Assemble the Jacobian by updating the contributions of the elements
+  whose input data has changed since the last assembly.
 
-  This function assembles the global Jacobian matrix and
-  residual. This Jacobian includes the contributions from all
-  elements. The Dirichlet boundary conditions are applied to the
-  matrix by zeroing the rows of the matrix associated with a boundary
-  condition, and setting the diagonal to unity. The matrix assembly
-  also performs any communication required so that the matrix can be
-  used immediately after assembly.
+  If the cache is not consistent with the matrix and coefficients, all
+  elements are assembled and the cache is filled. Otherwise, only the
+  buffers used for the parallel assembly are zeroed and the difference
+  between the new and cached element matrices is added for the
+  elements that changed. The boundary conditions are re-applied in
+  both cases. Since applying the boundary conditions overwrites the
+  same entries with the same values each time, the result is
+  consistent with a full assembly.
 
-  @param alpha Coefficient for the variables
-  @param beta Coefficient for the time-derivative terms
-  @param gamma Coefficientfor the second time derivative term
-  @param residual The residual of the governing equations
-  @param A The Jacobian matrix
-  @param matOr the matrix orientation NORMAL or TRANSPOSE
-  @param lambda Scaling factor for the aux element contributions, by default 1
+  The residual, if provided, is always fully assembled.
+
+  returns: 1 if the matrix was assembled, 0 otherwise
 */
-void TACSAssembler::assembleJacobian(TacsScalar alpha, TacsScalar beta,
-                                     TacsScalar gamma, TACSBVec *residual,
-                                     TACSMat *A, MatrixOrientation matOr,
-                                     const TacsScalar lambda) {
-  // Zero the residual and the matrix
+int TACSAssembler::assembleIncrementalJacobian(
+    TacsScalar alpha, TacsScalar beta, TacsScalar gamma, TACSBVec *residual,
+    TACSMat *A, MatrixOrientation matOr, const TacsScalar lambda) {
+  TACSParallelMat *pmat = dynamic_cast<TACSParallelMat *>(A);
+  if (!pmat) {
+    return 0;
+  }
+
+  // Allocate the cache if it does not already exist
+  if (!incrementalPtr) {
+    size_t *ptr = new size_t[numElements + 1];
+    ptr[0] = 0;
+    for (int i = 0; i < numElements; i++) {
+      int len = elementNodeIndex[i + 1] - elementNodeIndex[i];
+      int nvars = elements[i]->getNumVariables();
+      int numDVs = elements[i]->getDesignVarNums(i, 0, NULL);
+      size_t size =
+          TACS_SPATIAL_DIM * len + designVarsPerNode * numDVs + nvars * nvars;
+      if (!incrementalLinear) {
+        size += 3 * nvars;
+      }
+      ptr[i + 1] = ptr[i] + size;
+    }
+
+    double mem = 1e-6 * sizeof(TacsScalar) * ptr[numElements];
+    if (incrementalMaxMemory >= 0.0 && mem > incrementalMaxMemory) {
+      fprintf(stderr,
+              "[%d] TACSAssembler: Incremental Jacobian cache requires %g MB, "
+              "exceeding the limit of %g MB\n",
+              mpiRank, mem, incrementalMaxMemory);
+      delete[] ptr;
+      useIncrementalJacobian = 0;
+      return 0;
+    }
+
+    incrementalPtr = ptr;
+    incrementalCache = new TacsScalar[ptr[numElements]];
+    updateElementCacheMemory();
+  }
+
+  // Check whether the cache is consistent with this assembly
+  int full = (pmat != incrementalMat || matOr != incrementalMatOr ||
+              (time != incrementalTime && !incrementalTimeIndependent) ||
+              alpha != incrementalCoef[0] ||
+              beta != incrementalCoef[1] || gamma != incrementalCoef[2] ||
+              lambda != incrementalCoef[3]);
+
+  // The residual is always fully assembled
   if (residual) {
-    residual->zeroEntries();
+    assembleRes(residual, lambda);
   }
-  A->zeroEntries();
 
   // Sort the list of auxiliary elements - this call only performs the
   // sort if it is required (if new elements are added)
@@ -4270,102 +7524,144 @@ void TACSAssembler::assembleJacobian(TacsScalar alpha, TacsScalar beta,
     auxElements->sort();
   }
 
-  // Run the p-threaded version of the assembly code
-  if (thread_info->getNumThreads() > 1) {
-    // Set the number of completed elements to zero
-    numCompletedElements = 0;
-    tacsPInfo->assembler = this;
-    tacsPInfo->res = residual;
-    tacsPInfo->mat = A;
-    tacsPInfo->alpha = alpha;
-    tacsPInfo->beta = beta;
-    tacsPInfo->gamma = gamma;
-    tacsPInfo->lambda = lambda;
-    tacsPInfo->matOr = matOr;
+  if (full) {
+    pmat->zeroEntries();
+  } else {
+    pmat->zeroExtEntries();
+  }
+  incrementalCount = 0;
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars, *elemRes, *elemXpts;
+  TacsScalar *elemWeights, *elemMat;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  NULL, &elemWeights, &elemMat);
+  TacsScalar *dvVals = elementSensData;
+  int *dvNums = elementSensIData;
 
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&threads[k], &attr, TACSAssembler::assembleJacobian_thread,
-                     (void *)tacsPInfo);
-    }
+  // Set the data for the auxiliary elements - if there are any
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (auxElements) {
+    naux = auxElements->getAuxElements(&aux);
+  }
 
-    // Join all the threads
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(threads[k], NULL);
-    }
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
 
-    // Destroy the attribute
-    pthread_attr_destroy(&attr);
-  } else {
-    // Retrieve pointers to temporary storage
-    TacsScalar *vars, *dvars, *ddvars, *elemRes, *elemXpts;
-    TacsScalar *elemWeights, *elemMat;
-    getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
-                    NULL, &elemWeights, &elemMat);
+    // Get the number of variables from the element
+    int nvars = elements[i]->getNumVariables();
 
-    // Set the data for the auxiliary elements - if there are any
-    int naux = 0, aux_count = 0;
-    TACSAuxElem *aux = NULL;
-    if (auxElements) {
-      naux = auxElements->getAuxElements(&aux);
+    // Get the current design variable values
+    int numDVs = elements[i]->getDesignVarNums(i, maxElementDesignVars, dvNums);
+    int dvSize = designVarsPerNode * numDVs;
+    memset(dvVals, 0, dvSize * sizeof(TacsScalar));
+    elements[i]->getDesignVars(i, numDVs, dvVals);
+
+    // Check whether the element data has changed and update the cache
+    TacsScalar *cache = &incrementalCache[incrementalPtr[i]];
+    int changed = TacsCopyChanged(TACS_SPATIAL_DIM * len, elemXpts, cache);
+    cache += TACS_SPATIAL_DIM * len;
+    changed |= TacsCopyChanged(dvSize, dvVals, cache);
+    cache += dvSize;
+    if (!incrementalLinear && incrementalStateTol > 0.0) {
+      // Lag the element matrix for small changes in the states, but
+      // store the states whenever the matrix is recomputed
+      double tol = incrementalStateTol;
+      if (!(full || changed)) {
+        changed = (TacsChangedTol(nvars, vars, cache, tol) ||
+                   TacsChangedTol(nvars, dvars, &cache[nvars], tol) ||
+                   TacsChangedTol(nvars, ddvars, &cache[2 * nvars], tol));
+      }
+      if (full || changed) {
+        memcpy(cache, vars, nvars * sizeof(TacsScalar));
+        memcpy(&cache[nvars], dvars, nvars * sizeof(TacsScalar));
+        memcpy(&cache[2 * nvars], ddvars, nvars * sizeof(TacsScalar));
+      }
+      cache += 3 * nvars;
+    } else if (!incrementalLinear) {
+      changed |= TacsCopyChanged(nvars, vars, cache);
+      changed |= TacsCopyChanged(nvars, dvars, &cache[nvars]);
+      changed |= TacsCopyChanged(nvars, ddvars, &cache[2 * nvars]);
+      cache += 3 * nvars;
     }
+    TacsScalar *cacheMat = cache;
 
-    for (int i = 0; i < numElements; i++) {
-      int ptr = elementNodeIndex[i];
-      int len = elementNodeIndex[i + 1] - ptr;
-      const int *nodes = &elementTacsNodes[ptr];
-      xptVec->getValues(len, nodes, elemXpts);
-      varsVec->getValues(len, nodes, vars);
-      dvarsVec->getValues(len, nodes, dvars);
-      ddvarsVec->getValues(len, nodes, ddvars);
+    // Skip over the auxiliary elements for elements before this one
+    while (aux_count < naux && aux[aux_count].num < i) {
+      aux_count++;
+    }
 
-      // Get the number of variables from the element
-      int nvars = elements[i]->getNumVariables();
+    if (!(full || changed)) {
+      continue;
+    }
+    incrementalCount++;
 
-      // Compute and add the contributions to the Jacobian
-      memset(elemRes, 0, nvars * sizeof(TacsScalar));
-      memset(elemMat, 0, nvars * nvars * sizeof(TacsScalar));
-      elements[i]->addJacobian(i, time, alpha, beta, gamma, elemXpts, vars,
-                               dvars, ddvars, elemRes, elemMat);
+    // Compute the contributions to the Jacobian
+    memset(elemRes, 0, nvars * sizeof(TacsScalar));
+    memset(elemMat, 0, nvars * nvars * sizeof(TacsScalar));
+    elements[i]->addJacobian(i, time, alpha, beta, gamma, elemXpts, vars,
+                             dvars, ddvars, elemRes, elemMat);
 
-      // Add the contribution to the residual and the Jacobian from the
-      // auxiliary elements - if any, this is scaled by the loadFactor lambda
-      while (aux_count < naux && aux[aux_count].num == i) {
-        aux[aux_count].elem->addJacobian(i, time, alpha * lambda, beta * lambda,
-                                         gamma * lambda, elemXpts, vars, dvars,
-                                         ddvars, elemRes, elemMat);
-        aux_count++;
-      }
+    // Add the contribution to the Jacobian from the auxiliary elements
+    int aux_start = aux_count;
+    while (aux_count < naux && aux[aux_count].num == i) {
+      aux[aux_count].elem->addJacobian(i, time, alpha * lambda, beta * lambda,
+                                       gamma * lambda, elemXpts, vars, dvars,
+                                       ddvars, elemRes, elemMat);
+      aux_count++;
+    }
+    TACSElement *loads[2];
+    int nloads = getBodyLoads(i, loads);
+    for (int l = 0; l < nloads; l++) {
+      loads[l]->addJacobian(i, time, alpha * lambda, beta * lambda,
+                            gamma * lambda, elemXpts, vars, dvars, ddvars,
+                            elemRes, elemMat);
+    }
 
-      if (residual) {
-        residual->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+    // Store the new element matrix and compute the change in the
+    // contribution to the matrix
+    if (full) {
+      memcpy(cacheMat, elemMat, nvars * nvars * sizeof(TacsScalar));
+    } else {
+      for (int k = 0; k < nvars * nvars; k++) {
+        TacsScalar value = elemMat[k];
+        elemMat[k] -= cacheMat[k];
+        cacheMat[k] = value;
       }
-      addMatValues(A, i, elemMat, elementIData, elemWeights, matOr);
     }
-  }
 
-  // Do any matrix and residual assembly if required
-  A->beginAssembly();
-  if (residual) {
-    residual->beginSetValues(TACS_ADD_VALUES);
-  }
-
-  A->endAssembly();
-  if (residual) {
-    residual->endSetValues(TACS_ADD_VALUES);
+    addMatValues(A, i, elemMat, elementIData, elemWeights, matOr,
+                 aux_count > aux_start || nloads > 0);
   }
 
-  // Apply the boundary conditions
-  if (residual) {
-    residual->applyBCs(bcMap, varsVec);
+  // Record the data used for this assembly
+  if (full) {
+    pmat->incref();
+    if (incrementalMat) {
+      incrementalMat->decref();
+    }
+    incrementalMat = pmat;
+    incrementalMatOr = matOr;
+    incrementalTime = time;
+    incrementalCoef[0] = alpha;
+    incrementalCoef[1] = beta;
+    incrementalCoef[2] = gamma;
+    incrementalCoef[3] = lambda;
   }
 
-  // Apply the appropriate boundary conditions
+  // Perform the parallel assembly and apply the boundary conditions
+  A->beginAssembly();
+  A->endAssembly();
   A->applyBCs(bcMap);
+
+  return 1;
 }
 
 /**
@@ -4381,35 +7677,26 @@ void TACSAssembler::assembleJacobian(TacsScalar alpha, TacsScalar beta,
 void TACSAssembler::assembleMatType(ElementMatrixType matType, TACSMat *A,
                                     MatrixOrientation matOr,
                                     const TacsScalar lambda) {
+  TACSProfileScope scope("TACSAssembler::assembleMatType");
+  // The values in the matrix are about to be overwritten
+  if (A == incrementalMat) {
+    invalidateIncrementalJacobian();
+  }
+
   // Zero the matrix
   A->zeroEntries();
 
   if (thread_info->getNumThreads() > 1) {
-    // Set the number of completed elements to zero
-    numCompletedElements = 0;
+    // Distribute the elements between the threads
+    initElementSchedule();
     tacsPInfo->assembler = this;
     tacsPInfo->mat = A;
     tacsPInfo->matType = matType;
     tacsPInfo->matOr = matOr;
     tacsPInfo->lambda = lambda;
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&threads[k], &attr, TACSAssembler::assembleMatType_thread,
-                     (void *)tacsPInfo);
-    }
-
-    // Join all the threads
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(threads[k], NULL);
-    }
-
-    // Destroy the attribute
-    pthread_attr_destroy(&attr);
+    // Execute the assembly on the threads in the pool
+    runElementThreads(TACSAssembler::assembleMatType_thread);
   } else {
     // Retrieve pointers to temporary storage
     TacsScalar *vars, *elemXpts, *elemMat, *elemWeights;
@@ -4426,7 +7713,8 @@ void TACSAssembler::assembleMatType(ElementMatrixType matType, TACSMat *A,
     // To avoid allocating memory inside the element loop, make the aux element
     // contribution mat big enough for the largest element
     int maxNVar = this->maxElementSize;
-    TacsScalar *auxElemMat = new TacsScalar[maxNVar * maxNVar];
+    TACSScratchScope scratch;
+    TacsScalar *auxElemMat = scratch.allocScalars(maxNVar * maxNVar);
 
     for (int i = 0; i < numElements; i++) {
       // Retrieve the element variables and node locations
@@ -4434,14 +7722,26 @@ void TACSAssembler::assembleMatType(ElementMatrixType matType, TACSMat *A,
       int len = elementNodeIndex[i + 1] - ptr;
       int nvars = elements[i]->getNumVariables();
       const int *nodes = &elementTacsNodes[ptr];
+      double t0 = (elementTimes ? MPI_Wtime() : 0.0);
       xptVec->getValues(len, nodes, elemXpts);
       varsVec->getValues(len, nodes, vars);
+      if (elementTimes) {
+        double t1 = MPI_Wtime();
+        addElementTime(ELEMENT_GET_VALUES_TIME, 1, &i, t1 - t0);
+        t0 = t1;
+      }
 
       // Get the element matrix
       elements[i]->getMatType(matType, i, time, elemXpts, vars, elemMat);
+      if (elementTimes) {
+        double t1 = MPI_Wtime();
+        addElementTime(ELEMENT_JACOBIAN_TIME, 1, &i, t1 - t0);
+        t0 = t1;
+      }
 
       // Add the contribution from any auxiliary elements,  they need to be
       // scaled first
+      int aux_start = aux_count;
       while (aux_count < naux && aux[aux_count].num == i) {
         aux[aux_count].elem->getMatType(matType, i, time, elemXpts, vars,
                                         auxElemMat);
@@ -4452,9 +7752,15 @@ void TACSAssembler::assembleMatType(ElementMatrixType matType, TACSMat *A,
       }
 
       // Add the values into the element
-      addMatValues(A, i, elemMat, elementIData, elemWeights, matOr);
+      if (elementTimes) {
+        t0 = MPI_Wtime();
+      }
+      addMatValues(A, i, elemMat, elementIData, elemWeights, matOr,
+                   aux_count > aux_start);
+      if (elementTimes) {
+        addElementTime(ELEMENT_MAT_VALUES_TIME, 1, &i, MPI_Wtime() - t0);
+      }
     }
-    delete[] auxElemMat;
   }
 
   A->beginAssembly();
@@ -4498,10 +7804,11 @@ void TACSAssembler::assembleMatCombo(ElementMatrixType matTypes[],
   // To avoid allocating memory inside the element loop, make the aux element
   // contribution mat big enough for the largest element
   int maxNVar = this->maxElementSize;
+  TACSScratchScope scratch;
   TacsScalar *auxElemMat = NULL;
   bool scaleAux = lambda != TacsScalar(1.0) && naux > 0;
   if (scaleAux) {
-    auxElemMat = new TacsScalar[maxNVar * maxNVar];
+    auxElemMat = scratch.allocScalars(maxNVar * maxNVar);
   }
 
   for (int i = 0; i < numElements; i++) {
@@ -4520,6 +7827,7 @@ void TACSAssembler::assembleMatCombo(ElementMatrixType matTypes[],
       // 1 they can be added straight to the elemRes, otherwise they need to be
       // scaled first
       int nvars = elements[i]->getNumVariables();
+      int aux_start = aux_count;
       if (!scaleAux) {
         while (aux_count < naux && aux[aux_count].num == i) {
           aux[aux_count].elem->getMatType(matTypes[j], i, time, elemXpts, vars,
@@ -4545,83 +7853,494 @@ void TACSAssembler::assembleMatCombo(ElementMatrixType matTypes[],
       }
 
       // Add the values into the element
-      addMatValues(A, i, elemMat, elementIData, elemWeights, matOr);
+      addMatValues(A, i, elemMat, elementIData, elemWeights, matOr,
+                   aux_count > aux_start);
     }
   }
-  if (scaleAux) {
-    delete[] auxElemMat;
-  }
 
   A->beginAssembly();
   A->endAssembly();
 
-  A->applyBCs(bcMap);
+  A->applyBCs(bcMap);
+}
+
+/**
+  Assemble the lumped (row-sum) mass matrix as a vector
+
+  The rows of the element mass matrices are summed and added to the
+  entries of the vector. No matrix is assembled. The boundary
+  conditions are not applied to the vector.
+
+  @param mass The diagonal of the lumped mass matrix (output)
+*/
+void TACSAssembler::assembleLumpedMass(TACSBVec *mass) {
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *lumped, *elemXpts, *elemMat;
+  getDataPointers(elementData, &vars, &lumped, NULL, NULL, &elemXpts, NULL,
+                  NULL, &elemMat);
+
+  mass->zeroEntries();
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    int nvars = elements[i]->getNumVariables();
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+
+    // Sum the rows of the element mass matrix
+    elements[i]->getMatType(TACS_MASS_MATRIX, i, time, elemXpts, vars,
+                            elemMat);
+    for (int ii = 0; ii < nvars; ii++) {
+      lumped[ii] = 0.0;
+      for (int jj = 0; jj < nvars; jj++) {
+        lumped[ii] += elemMat[nvars * ii + jj];
+      }
+    }
+
+    mass->setValues(len, nodes, lumped, TACS_ADD_VALUES);
+  }
+
+  mass->beginSetValues(TACS_ADD_VALUES);
+  mass->endSetValues(TACS_ADD_VALUES);
+}
+
+/**
+  Estimate the largest time step for explicit integration
+
+  The central-difference method with a lumped mass matrix is stable
+  for time steps h < 2/omega_max. The maximum frequency of the
+  assembled problem is bounded by the maximum frequency of the
+  elements with lumped mass matrices, and the element frequencies are
+  bounded with the Gershgorin estimate
+
+  omega_e^2 <= max_{i} sum_{j} |K_ij|/m_i
+
+  using the element stiffness matrix at the current state variables.
+  Rows without mass are skipped.
+
+  @return The estimated stable time step, or zero if there is no bound
+*/
+double TACSAssembler::estimateStableTimeStep() {
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *lumped, *elemXpts, *elemMat;
+  getDataPointers(elementData, &vars, &lumped, NULL, NULL, &elemXpts, NULL,
+                  NULL, &elemMat);
+
+  double omega2 = 0.0;
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    int nvars = elements[i]->getNumVariables();
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+
+    // Compute the element lumped mass matrix
+    elements[i]->getMatType(TACS_MASS_MATRIX, i, time, elemXpts, vars,
+                            elemMat);
+    for (int ii = 0; ii < nvars; ii++) {
+      lumped[ii] = 0.0;
+      for (int jj = 0; jj < nvars; jj++) {
+        lumped[ii] += elemMat[nvars * ii + jj];
+      }
+    }
+
+    // Bound the largest eigenvalue of M^{-1}*K for the element
+    elements[i]->getMatType(TACS_STIFFNESS_MATRIX, i, time, elemXpts, vars,
+                            elemMat);
+    for (int ii = 0; ii < nvars; ii++) {
+      double m = TacsRealPart(lumped[ii]);
+      if (m > 0.0) {
+        double ksum = 0.0;
+        for (int jj = 0; jj < nvars; jj++) {
+          ksum += fabs(TacsRealPart(elemMat[nvars * ii + jj]));
+        }
+        if (ksum > omega2 * m) {
+          omega2 = ksum / m;
+        }
+      }
+    }
+  }
+
+  double omega2_max;
+  MPI_Allreduce(&omega2, &omega2_max, 1, MPI_DOUBLE, MPI_MAX, tacs_comm);
+
+  if (omega2_max > 0.0) {
+    return 2.0 / sqrt(omega2_max);
+  }
+  return 0.0;
+}
+
+/**
+  Evaluate a list of TACS functions
+
+  First, check if the functions are initialized. Obtain the number of
+  iterations over the function domain required to evaluate the
+  functions.
+
+  This function will print an error and return 0 if the underlying
+  TACSAssembler object does not correspond to the TACSAssembler object.
+
+  The value of each function is stored along with the design, node and
+  state versions and the simulation time. Functions whose stored value
+  is current are not re-integrated, and when all of the values are
+  current no element loop is performed.
+
+  @param numFuncs The number of functions to evaluate
+  @param funcs Array of functions to evaluate
+  @param funcVals The function values
+*/
+void TACSAssembler::evalFunctions(int numFuncs, TACSFunction **funcs,
+                                  TacsScalar *funcVals) {
+  TACSProfileScope scope("TACSAssembler::evalFunctions");
+  // Here we will use time-independent formulation
+  TacsScalar tcoef = 1.0;
+
+  // Collect the functions without a current stored value
+  TACSFunction **evalFuncs = new TACSFunction *[numFuncs];
+  int numEval = 0;
+  for (int k = 0; k < numFuncs; k++) {
+    funcVals[k] = 0.0;
+    evalFuncs[k] = NULL;
+    if (funcs[k] && !funcs[k]->getCachedValue(&funcVals[k])) {
+      evalFuncs[k] = funcs[k];
+      numEval++;
+    }
+  }
+
+  if (numEval == 0) {
+    delete[] evalFuncs;
+    return;
+  }
+
+  // Check whether these are two-stage or single-stage functions
+  int twoStage = 0;
+  for (int k = 0; k < numFuncs; k++) {
+    if (evalFuncs[k] &&
+        evalFuncs[k]->getStageType() == TACSFunction::TWO_STAGE) {
+      twoStage = 1;
+      break;
+    }
+  }
+
+  // Just be lazy and call initialize on all the functions if any
+  // function is two-stage
+  if (twoStage) {
+    for (int k = 0; k < numFuncs; k++) {
+      if (evalFuncs[k]) {
+        evalFuncs[k]->initEvaluation(TACSFunction::INITIALIZE);
+      }
+    }
+    integrateFunctions(tcoef, TACSFunction::INITIALIZE, numFuncs, evalFuncs);
+    for (int k = 0; k < numFuncs; k++) {
+      if (evalFuncs[k]) {
+        evalFuncs[k]->finalEvaluation(TACSFunction::INITIALIZE);
+      }
+    }
+  }
+
+  // Perform the integration required to evaluate the function
+  for (int k = 0; k < numFuncs; k++) {
+    if (evalFuncs[k]) {
+      evalFuncs[k]->initEvaluation(TACSFunction::INTEGRATE);
+    }
+  }
+
+  integrateFunctions(tcoef, TACSFunction::INTEGRATE, numFuncs, evalFuncs);
+
+  for (int k = 0; k < numFuncs; k++) {
+    if (evalFuncs[k]) {
+      evalFuncs[k]->finalEvaluation(TACSFunction::INTEGRATE);
+    }
+  }
+
+  // Retrieve and store the function values
+  for (int k = 0; k < numFuncs; k++) {
+    if (evalFuncs[k]) {
+      funcVals[k] = evalFuncs[k]->getFunctionValue();
+      evalFuncs[k]->setCachedValue(funcVals[k]);
+    }
+  }
+
+  delete[] evalFuncs;
+}
+
+/**
+  Evaluate the residual, the functions and, optionally, the derivative
+  of the functions w.r.t. the state variables with fused element loops.
+
+  This produces the same result as calling assembleRes(), evalFunctions()
+  and addSVSens() with alpha = 1 and beta = gamma = 0, but the element
+  data is retrieved once per element in each loop and shared between
+  the residual and all of the functions. The residual and the first
+  function stage are evaluated in the same loop over the elements.
+  Two-stage functions require a second loop for the integration, and
+  the state variable sensitivities require a final loop since they
+  depend on the final function values.
+
+  The element loops are performed without threads.
+
+  @param residual The residual vector (may be NULL)
+  @param numFuncs The number of functions
+  @param funcs The array of functions
+  @param funcVals The function values
+  @param dfdu The derivatives of the functions w.r.t. the states (may be NULL)
+  @param lambda Scaling factor for the aux element contributions, by default 1
+*/
+void TACSAssembler::evalResAndFunctions(TACSBVec *residual, int numFuncs,
+                                        TACSFunction **funcs,
+                                        TacsScalar *funcVals, TACSBVec **dfdu,
+                                        const TacsScalar lambda) {
+  // First check if this is the right assembly object
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcs[k] && this != funcs[k]->getAssembler()) {
+      fprintf(stderr, "[%d] Cannot evaluate function %s, wrong TACS object\n",
+              mpiRank, funcs[k]->getObjectName());
+    }
+  }
+
+  // Count the number of times each element appears in the domain of
+  // each function. A NULL entry indicates the entire domain.
+  int **funcCounts = new int *[numFuncs];
+  for (int k = 0; k < numFuncs; k++) {
+    funcCounts[k] = NULL;
+    if (funcs[k] && funcs[k]->getDomainType() != TACSFunction::ENTIRE_DOMAIN) {
+      funcCounts[k] = new int[numElements];
+      memset(funcCounts[k], 0, numElements * sizeof(int));
+      if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
+        const int *elementNums;
+        int subDomainSize = funcs[k]->getElementNums(&elementNums);
+        for (int i = 0; i < subDomainSize; i++) {
+          if (elementNums[i] >= 0 && elementNums[i] < numElements) {
+            funcCounts[k][elementNums[i]]++;
+          }
+        }
+      }
+    }
+  }
+
+  // Check whether these are two-stage or single-stage functions
+  int twoStage = 0;
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcs[k] && funcs[k]->getStageType() == TACSFunction::TWO_STAGE) {
+      twoStage = 1;
+      break;
+    }
+  }
+
+  // Sort the list of auxiliary elements - this only performs the
+  // sort if it is required (if new elements are added)
+  if (auxElements) {
+    auxElements->sort();
+  }
+  initElementMatCache();
+
+  if (residual) {
+    residual->zeroEntries();
+  }
+
+  // Evaluate the residual along with the first stage of the functions
+  TACSFunction::EvaluationType ftype =
+      (twoStage ? TACSFunction::INITIALIZE : TACSFunction::INTEGRATE);
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcs[k]) {
+      funcs[k]->clearCachedValue();
+      funcs[k]->initEvaluation(ftype);
+    }
+  }
+  fusedResAndFunctions(residual, lambda, ftype, numFuncs, funcs, funcCounts);
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcs[k]) {
+      funcs[k]->finalEvaluation(ftype);
+    }
+  }
+
+  // Perform the integration for two-stage functions
+  if (twoStage) {
+    for (int k = 0; k < numFuncs; k++) {
+      if (funcs[k]) {
+        funcs[k]->initEvaluation(TACSFunction::INTEGRATE);
+      }
+    }
+    fusedResAndFunctions(NULL, lambda, TACSFunction::INTEGRATE, numFuncs, funcs,
+                         funcCounts);
+    for (int k = 0; k < numFuncs; k++) {
+      if (funcs[k]) {
+        funcs[k]->finalEvaluation(TACSFunction::INTEGRATE);
+      }
+    }
+  }
+
+  // Finish the assembly of the residual
+  if (residual) {
+    residual->beginSetValues(TACS_ADD_VALUES);
+    residual->endSetValues(TACS_ADD_VALUES);
+    residual->applyBCs(bcMap, varsVec);
+  }
+
+  // Retrieve the function values
+  for (int k = 0; k < numFuncs; k++) {
+    funcVals[k] = 0.0;
+    if (funcs[k]) {
+      funcVals[k] = funcs[k]->getFunctionValue();
+      funcs[k]->setCachedValue(funcVals[k]);
+    }
+  }
+
+  // Compute the derivatives w.r.t. the state variables
+  if (dfdu) {
+    fusedSVSens(numFuncs, funcs, funcCounts, dfdu);
+  }
+
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcCounts[k]) {
+      delete[] funcCounts[k];
+    }
+  }
+  delete[] funcCounts;
+}
+
+/*
+  Perform a single loop over the elements that adds the residual (if
+  provided) and evaluates the given stage of the functions.
+
+  input:
+  residual:    the residual vector (may be NULL)
+  lambda:      scaling factor for the aux element contributions
+  ftype:       the function evaluation type
+  numFuncs:    the number of functions
+  funcs:       the functions
+  funcCounts:  the number of times each element is in the function domain
+*/
+void TACSAssembler::fusedResAndFunctions(TACSBVec *residual, TacsScalar lambda,
+                                         TACSFunction::EvaluationType ftype,
+                                         int numFuncs, TACSFunction **funcs,
+                                         int **funcCounts) {
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars, *elemRes, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  NULL, NULL, NULL);
+
+  // Get the auxiliary elements
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (auxElements && residual) {
+    naux = auxElements->getAuxElements(&aux);
+  }
+
+  // Allocate space for the aux element contributions if they are scaled
+  TACSScratchScope scratch;
+  TacsScalar *auxElemRes = NULL;
+  bool scaleAux = lambda != TacsScalar(1.0) && (naux > 0 || bodyLoads);
+  if (scaleAux) {
+    auxElemRes = scratch.allocScalars(maxElementSize);
+  }
+
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+
+    if (residual) {
+      // Add the residual from the element
+      int nvars = elements[i]->getNumVariables();
+      memset(elemRes, 0, nvars * sizeof(TacsScalar));
+      addElementResidualBatch(elements[i], 1, &i, elemXpts, vars, dvars,
+                              ddvars, elemRes);
+
+      // Add the residual from any auxiliary elements
+      if (scaleAux) {
+        memset(auxElemRes, 0, nvars * sizeof(TacsScalar));
+      }
+      while (aux_count < naux && aux[aux_count].num == i) {
+        aux[aux_count].elem->addResidual(i, time, elemXpts, vars, dvars, ddvars,
+                                         (scaleAux ? auxElemRes : elemRes));
+        aux_count++;
+      }
+      TACSElement *loads[2];
+      int nloads = getBodyLoads(i, loads);
+      for (int l = 0; l < nloads; l++) {
+        loads[l]->addResidual(i, time, elemXpts, vars, dvars, ddvars,
+                              (scaleAux ? auxElemRes : elemRes));
+      }
+      if (scaleAux) {
+        for (int jj = 0; jj < nvars; jj++) {
+          elemRes[jj] += lambda * auxElemRes[jj];
+        }
+      }
+
+      residual->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+    }
+
+    // Evaluate the element-wise component of the functions
+    for (int k = 0; k < numFuncs; k++) {
+      if (funcs[k]) {
+        int count = (funcCounts[k] ? funcCounts[k][i] : 1);
+        for (int j = 0; j < count; j++) {
+          funcs[k]->elementWiseEval(ftype, i, elements[i], time, 1.0, elemXpts,
+                                    vars, dvars, ddvars);
+        }
+      }
+    }
+  }
+
 }
 
-/**
-  Evaluate a list of TACS functions
-
-  First, check if the functions are initialized. Obtain the number of
-  iterations over the function domain required to evaluate the
-  functions.
+/*
+  Perform a single loop over the elements that adds the derivatives
+  of all the functions w.r.t. the state variables.
 
-  This function will print an error and return 0 if the underlying
-  TACSAssembler object does not correspond to the TACSAssembler object.
+  input:
+  numFuncs:    the number of functions
+  funcs:       the functions
+  funcCounts:  the number of times each element is in the function domain
 
-  @param numFuncs The number of functions to evaluate
-  @param funcs Array of functions to evaluate
-  @param funcVals The function values
+  output:
+  dfdu:        the derivatives of the functions w.r.t. the states
 */
-void TACSAssembler::evalFunctions(int numFuncs, TACSFunction **funcs,
-                                  TacsScalar *funcVals) {
-  // Here we will use time-independent formulation
-  TacsScalar tcoef = 1.0;
+void TACSAssembler::fusedSVSens(int numFuncs, TACSFunction **funcs,
+                                int **funcCounts, TACSBVec **dfdu) {
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars, *elemRes, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  NULL, NULL, NULL);
 
-  // Check whether these are two-stage or single-stage functions
-  int twoStage = 0;
-  for (int k = 0; k < numFuncs; k++) {
-    if (funcs[k] && funcs[k]->getStageType() == TACSFunction::TWO_STAGE) {
-      twoStage = 1;
-      break;
-    }
-  }
+  for (int i = 0; i < numElements; i++) {
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
 
-  // Just be lazy and call initialize on all the functions if any
-  // function is two-stage
-  if (twoStage) {
-    for (int k = 0; k < numFuncs; k++) {
-      if (funcs[k]) {
-        funcs[k]->initEvaluation(TACSFunction::INITIALIZE);
-      }
-    }
-    integrateFunctions(tcoef, TACSFunction::INITIALIZE, numFuncs, funcs);
+    // Evaluate the element-wise sensitivity of the functions
     for (int k = 0; k < numFuncs; k++) {
       if (funcs[k]) {
-        funcs[k]->finalEvaluation(TACSFunction::INITIALIZE);
+        int count = (funcCounts[k] ? funcCounts[k][i] : 1);
+        for (int j = 0; j < count; j++) {
+          funcs[k]->getElementSVSens(i, elements[i], time, 1.0, 0.0, 0.0,
+                                     elemXpts, vars, dvars, ddvars, elemRes);
+          dfdu[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+        }
       }
     }
   }
 
-  // Perform the integration required to evaluate the function
-  for (int k = 0; k < numFuncs; k++) {
-    if (funcs[k]) {
-      funcs[k]->initEvaluation(TACSFunction::INTEGRATE);
-    }
-  }
-
-  integrateFunctions(tcoef, TACSFunction::INTEGRATE, numFuncs, funcs);
-
   for (int k = 0; k < numFuncs; k++) {
     if (funcs[k]) {
-      funcs[k]->finalEvaluation(TACSFunction::INTEGRATE);
+      dfdu[k]->beginSetValues(TACS_ADD_VALUES);
     }
   }
-
-  // Retrieve the function values
   for (int k = 0; k < numFuncs; k++) {
-    funcVals[k] = 0.0;
     if (funcs[k]) {
-      funcVals[k] = funcs[k]->getFunctionValue();
+      dfdu[k]->endSetValues(TACS_ADD_VALUES);
+      dfdu[k]->applyBCs(bcMap);
     }
   }
 }
@@ -4638,56 +8357,96 @@ void TACSAssembler::evalFunctions(int numFuncs, TACSFunction **funcs,
 void TACSAssembler::integrateFunctions(TacsScalar tcoef,
                                        TACSFunction::EvaluationType ftype,
                                        int numFuncs, TACSFunction **funcs) {
+  TACSProfileScope scope("TACSAssembler::integrateFunctions");
+  // The stored values of the functions are overwritten by the
+  // integration
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcs[k]) {
+      funcs[k]->clearCachedValue();
+    }
+  }
+
   // Retrieve pointers to temporary storage
   TacsScalar *vars, *dvars, *ddvars;
   TacsScalar *elemXpts;
   getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
                   NULL, NULL);
 
+  // The functions that are not integrated on the threads are
+  // integrated together in a single pass over the elements
+  TACSFunction **serialFuncs = new TACSFunction *[numFuncs];
+  int numSerial = 0;
+
+  int nthreads = thread_info->getNumThreads();
   for (int k = 0; k < numFuncs; k++) {
+    serialFuncs[k] = NULL;
     if (funcs[k]) {
-      if (funcs[k]->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
-        for (int i = 0; i < numElements; i++) {
-          // Determine the values of the state variables for the
-          // current element
-          int ptr = elementNodeIndex[i];
-          int len = elementNodeIndex[i + 1] - ptr;
-          const int *nodes = &elementTacsNodes[ptr];
-          xptVec->getValues(len, nodes, elemXpts);
-          varsVec->getValues(len, nodes, vars);
-          dvarsVec->getValues(len, nodes, dvars);
-          ddvarsVec->getValues(len, nodes, ddvars);
-
-          // Evaluate the element-wise component of the function
-          funcs[k]->elementWiseEval(ftype, i, elements[i], time, tcoef,
-                                    elemXpts, vars, dvars, ddvars);
+      int nvals = funcs[k]->getNumThreadValues(ftype);
+      if (nthreads > 1 && nvals > 0 &&
+          funcs[k]->getDomainType() != TACSFunction::NO_DOMAIN) {
+        // Accumulate the function values separately on each thread
+        TacsScalar *values = new TacsScalar[nthreads * nvals];
+        for (int t = 0; t < nthreads; t++) {
+          funcs[k]->initThreadValues(ftype, &values[nvals * t]);
         }
-      } else if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
-        const int *elementNums;
-        int subDomainSize = funcs[k]->getElementNums(&elementNums);
 
-        for (int i = 0; i < subDomainSize; i++) {
-          int elemNum = elementNums[i];
-
-          if (elemNum >= 0 && elemNum < numElements) {
-            // Determine the values of the state variables
-            // for the current element
-            int ptr = elementNodeIndex[elemNum];
-            int len = elementNodeIndex[elemNum + 1] - ptr;
-            const int *nodes = &elementTacsNodes[ptr];
-            xptVec->getValues(len, nodes, elemXpts);
-            varsVec->getValues(len, nodes, vars);
-            dvarsVec->getValues(len, nodes, dvars);
-            ddvarsVec->getValues(len, nodes, ddvars);
-
-            // Evaluate the element-wise component of the function
-            funcs[k]->elementWiseEval(ftype, elemNum, elements[elemNum], time,
-                                      tcoef, elemXpts, vars, dvars, ddvars);
-          }
+        tacsPInfo->assembler = this;
+        tacsPInfo->function = funcs[k];
+        tacsPInfo->ftype = ftype;
+        tacsPInfo->coef = tcoef;
+        tacsPInfo->sched =
+            createFunctionSchedule(funcs[k], &tacsPInfo->elemNums);
+        tacsPInfo->threadValues = values;
+        thread_info->runThreads(TACSAssembler::integrateFunctions_thread,
+                                (void *)tacsPInfo);
+        tacsPInfo->sched->decref();
+        tacsPInfo->sched = NULL;
+
+        // Add the values from each thread to the function
+        for (int t = 0; t < nthreads; t++) {
+          funcs[k]->addThreadValues(ftype, &values[nvals * t]);
         }
+        delete[] values;
+      } else {
+        serialFuncs[k] = funcs[k];
+        numSerial++;
+      }
+    }
+  }
+
+  if (numSerial > 0) {
+    int *elemFuncs;
+    int *elemFuncPtr =
+        createElementFunctionList(numFuncs, serialFuncs, &elemFuncs);
+
+    for (int i = 0; i < numElements; i++) {
+      if (elemFuncPtr[i] == elemFuncPtr[i + 1]) {
+        continue;
+      }
+
+      // Determine the values of the state variables for the current
+      // element
+      int ptr = elementNodeIndex[i];
+      int len = elementNodeIndex[i + 1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
+      varsVec->getValues(len, nodes, vars);
+      dvarsVec->getValues(len, nodes, dvars);
+      ddvarsVec->getValues(len, nodes, ddvars);
+
+      // Evaluate the element-wise component of each function
+      for (int j = elemFuncPtr[i]; j < elemFuncPtr[i + 1]; j++) {
+        serialFuncs[elemFuncs[j]]->elementWiseEval(ftype, i, elements[i], time,
+                                                   tcoef, elemXpts, vars,
+                                                   dvars, ddvars);
       }
     }
+
+    delete[] elemFuncPtr;
+    delete[] elemFuncs;
   }
+
+  delete[] serialFuncs;
 }
 
 /**
@@ -4724,6 +8483,7 @@ void TACSAssembler::integrateFunctions(TacsScalar tcoef,
 */
 void TACSAssembler::addDVSens(TacsScalar coef, int numFuncs,
                               TACSFunction **funcs, TACSBVec **dfdx) {
+  TACSProfileScope scope("TACSAssembler::addDVSens");
   // Retrieve pointers to temporary storage
   TacsScalar *vars, *dvars, *ddvars, *elemXpts;
   getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
@@ -4734,66 +8494,431 @@ void TACSAssembler::addDVSens(TacsScalar coef, int numFuncs,
   TacsScalar *fdvSens = elementSensData;
   int *dvNums = elementSensIData;
 
-  // For each function, evaluate the derivative w.r.t. the
-  // design variables for each element
+  // For each function, evaluate the derivative w.r.t. the design
+  // variables on the threads, or collect the function so that the
+  // derivatives of all the remaining functions are evaluated in a
+  // single pass over the elements
+  TACSFunction **serialFuncs = new TACSFunction *[numFuncs];
+  int numSerial = 0;
   for (int k = 0; k < numFuncs; k++) {
+    serialFuncs[k] = NULL;
     if (funcs[k]) {
-      if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
-        // Get the funcs[k] sub-domain
-        const int *elemSubList;
-        int numSubElems = funcs[k]->getElementNums(&elemSubList);
-
-        for (int i = 0; i < numSubElems; i++) {
-          int elemNum = elemSubList[i];
-          // Determine the values of the state variables for subElem
-          int ptr = elementNodeIndex[elemNum];
-          int len = elementNodeIndex[elemNum + 1] - ptr;
-          const int *nodes = &elementTacsNodes[ptr];
-          xptVec->getValues(len, nodes, elemXpts);
-          varsVec->getValues(len, nodes, vars);
-          dvarsVec->getValues(len, nodes, dvars);
-          ddvarsVec->getValues(len, nodes, ddvars);
-
-          // Get the design variables for this element
-          int numDVs =
-              elements[elemNum]->getDesignVarNums(elemNum, maxDVs, dvNums);
-
-          // Evaluate the element-wise sensitivity of the function
-          memset(fdvSens, 0, numDVs * designVarsPerNode * sizeof(TacsScalar));
-          funcs[k]->addElementDVSens(elemNum, elements[elemNum], time, coef,
-                                     elemXpts, vars, dvars, ddvars, maxDVs,
-                                     fdvSens);
-
-          // Add the derivative values
-          dfdx[k]->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+      if (thread_info->getNumThreads() > 1 &&
+          funcs[k]->getDomainType() != TACSFunction::NO_DOMAIN) {
+        // Add the derivatives to a separate vector on each thread
+        tacsPInfo->assembler = this;
+        tacsPInfo->function = funcs[k];
+        tacsPInfo->coef = coef;
+        tacsPInfo->sched =
+            createFunctionSchedule(funcs[k], &tacsPInfo->elemNums);
+        tacsPInfo->threadVecs = createThreadVecs(1, &dfdx[k]);
+        thread_info->runThreads(TACSAssembler::addDVSens_thread,
+                                (void *)tacsPInfo);
+        addThreadVecs(1, tacsPInfo->threadVecs);
+        tacsPInfo->threadVecs = NULL;
+        tacsPInfo->sched->decref();
+        tacsPInfo->sched = NULL;
+      } else {
+        serialFuncs[k] = funcs[k];
+        numSerial++;
+      }
+    }
+  }
+
+  if (numSerial > 0) {
+    int *elemFuncs;
+    int *elemFuncPtr =
+        createElementFunctionList(numFuncs, serialFuncs, &elemFuncs);
+
+    for (int elemNum = 0; elemNum < numElements; elemNum++) {
+      if (elemFuncPtr[elemNum] == elemFuncPtr[elemNum + 1]) {
+        continue;
+      }
+
+      // Determine the values of the state variables for elemNum
+      int ptr = elementNodeIndex[elemNum];
+      int len = elementNodeIndex[elemNum + 1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
+      varsVec->getValues(len, nodes, vars);
+      dvarsVec->getValues(len, nodes, dvars);
+      ddvarsVec->getValues(len, nodes, ddvars);
+
+      // Get the design variables for this element
+      int numDVs = elements[elemNum]->getDesignVarNums(elemNum, maxDVs, dvNums);
+
+      for (int j = elemFuncPtr[elemNum]; j < elemFuncPtr[elemNum + 1]; j++) {
+        int k = elemFuncs[j];
+
+        // Evaluate the element-wise sensitivity of the function
+        memset(fdvSens, 0, numDVs * designVarsPerNode * sizeof(TacsScalar));
+        funcs[k]->addElementDVSens(elemNum, elements[elemNum], time, coef,
+                                   elemXpts, vars, dvars, ddvars, maxDVs,
+                                   fdvSens);
+
+        // Add the derivative values
+        dfdx[k]->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+      }
+    }
+
+    delete[] elemFuncPtr;
+    delete[] elemFuncs;
+  }
+
+  delete[] serialFuncs;
+}
+
+/*
+  An entry in the sparse derivative of the functions w.r.t. the design
+  variables
+*/
+struct TacsDVSensEntry {
+  int row, col;
+  TacsScalar value;
+};
+
+/*
+  Compare two sparse entries by their column and then by their row
+*/
+static int compare_dv_sens_col(const void *a, const void *b) {
+  const TacsDVSensEntry *ea = static_cast<const TacsDVSensEntry *>(a);
+  const TacsDVSensEntry *eb = static_cast<const TacsDVSensEntry *>(b);
+  if (ea->col != eb->col) {
+    return ea->col - eb->col;
+  }
+  return ea->row - eb->row;
+}
+
+/*
+  Compare two sparse entries by their row and then by their column
+*/
+static int compare_dv_sens_row(const void *a, const void *b) {
+  const TacsDVSensEntry *ea = static_cast<const TacsDVSensEntry *>(a);
+  const TacsDVSensEntry *eb = static_cast<const TacsDVSensEntry *>(b);
+  if (ea->row != eb->row) {
+    return ea->row - eb->row;
+  }
+  return ea->col - eb->col;
+}
+
+/*
+  Sort the entries with the given comparison and add the values of
+  duplicate entries. Returns the new number of entries.
+*/
+static int combine_dv_sens_entries(int n, TacsDVSensEntry *entries,
+                                   int (*compare)(const void *,
+                                                  const void *)) {
+  if (n == 0) {
+    return 0;
+  }
+  qsort(entries, n, sizeof(TacsDVSensEntry), compare);
+  int k = 0;
+  for (int i = 1; i < n; i++) {
+    if (entries[i].row == entries[k].row && entries[i].col == entries[k].col) {
+      entries[k].value += entries[i].value;
+    } else {
+      k++;
+      entries[k] = entries[i];
+    }
+  }
+  return k + 1;
+}
+
+/**
+  Compute the sparse derivative of a list of functions w.r.t. the
+  design variables.
+
+  This produces the same values as addDVSens(), but only the non-zero
+  entries are stored. The entries from all the functions are computed
+  in a single pass over the elements. They are then sent to the
+  processor that owns each design variable in a single communication
+  round. This avoids forming and reducing a full design vector for
+  each function, which is mostly zero when each element depends on
+  only a few design variables.
+
+  On output, the derivatives of the functions w.r.t. the design
+  variables owned by this processor are stored in compressed sparse
+  row format with one row for each function. The column indices are
+  the global design variable indices (the design node times the
+  number of design variables per node plus the component) and are
+  sorted within each row. The arrays are allocated with new[] and must
+  be deleted by the caller.
+
+  @param coef The coefficient applied to the derivative
+  @param numFuncs The number of functions
+  @param funcs The TACSFunction function objects
+  @param rowp The pointer into each row (output)
+  @param cols The global design variable indices (output)
+  @param vals The derivative values (output)
+  @return The number of non-zero entries on this processor
+*/
+int TACSAssembler::getSparseDVSens(TacsScalar coef, int numFuncs,
+                                   TACSFunction **funcs, int **rowp,
+                                   int **cols, TacsScalar **vals) {
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
+                  NULL, NULL);
+
+  const int maxDVs = maxElementDesignVars;
+  TacsScalar *fdvSens = elementSensData;
+  int *dvNums = elementSensIData;
+
+  // Accumulate the non-zero entries from each element
+  int *elemFuncs;
+  int *elemFuncPtr = createElementFunctionList(numFuncs, funcs, &elemFuncs);
+
+  int num_entries = 0;
+  int max_entries = 1024;
+  TacsDVSensEntry *entries = new TacsDVSensEntry[max_entries];
+
+  for (int elemNum = 0; elemNum < numElements; elemNum++) {
+    if (elemFuncPtr[elemNum] == elemFuncPtr[elemNum + 1]) {
+      continue;
+    }
+
+    // Determine the values of the state variables for elemNum
+    int ptr = elementNodeIndex[elemNum];
+    int len = elementNodeIndex[elemNum + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+
+    // Get the design variables for this element
+    int numDVs = elements[elemNum]->getDesignVarNums(elemNum, maxDVs, dvNums);
+    int size = numDVs * designVarsPerNode;
+
+    for (int j = elemFuncPtr[elemNum]; j < elemFuncPtr[elemNum + 1]; j++) {
+      int k = elemFuncs[j];
+
+      // Evaluate the element-wise sensitivity of the function
+      memset(fdvSens, 0, size * sizeof(TacsScalar));
+      funcs[k]->addElementDVSens(elemNum, elements[elemNum], time, coef,
+                                 elemXpts, vars, dvars, ddvars, maxDVs,
+                                 fdvSens);
+
+      // Extend the array if required
+      if (num_entries + size > max_entries) {
+        int new_max = 2 * max_entries + size;
+        TacsDVSensEntry *temp = new TacsDVSensEntry[new_max];
+        memcpy(temp, entries, num_entries * sizeof(TacsDVSensEntry));
+        delete[] entries;
+        entries = temp;
+        max_entries = new_max;
+      }
+
+      for (int ii = 0; ii < numDVs; ii++) {
+        if (dvNums[ii] < 0) {
+          continue;
         }
-      } else if (funcs[k]->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
-        for (int elemNum = 0; elemNum < numElements; elemNum++) {
-          // Determine the values of the state variables for elemNum
-          int ptr = elementNodeIndex[elemNum];
-          int len = elementNodeIndex[elemNum + 1] - ptr;
-          const int *nodes = &elementTacsNodes[ptr];
-          xptVec->getValues(len, nodes, elemXpts);
-          varsVec->getValues(len, nodes, vars);
-          dvarsVec->getValues(len, nodes, dvars);
-          ddvarsVec->getValues(len, nodes, ddvars);
-
-          // Get the design variables for this element
-          int numDVs =
-              elements[elemNum]->getDesignVarNums(elemNum, maxDVs, dvNums);
-
-          // Evaluate the element-wise sensitivity of the function
-          memset(fdvSens, 0, numDVs * designVarsPerNode * sizeof(TacsScalar));
-          funcs[k]->addElementDVSens(elemNum, elements[elemNum], time, coef,
-                                     elemXpts, vars, dvars, ddvars, maxDVs,
-                                     fdvSens);
-
-          // Add the derivative values
-          dfdx[k]->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+        for (int jj = 0; jj < designVarsPerNode; jj++) {
+          TacsScalar value = fdvSens[designVarsPerNode * ii + jj];
+          if (value != 0.0) {
+            entries[num_entries].row = k;
+            entries[num_entries].col = designVarsPerNode * dvNums[ii] + jj;
+            entries[num_entries].value = value;
+            num_entries++;
+          }
+        }
+      }
+    }
+  }
+
+  delete[] elemFuncPtr;
+  delete[] elemFuncs;
+
+  // Combine the duplicate entries. The entries are sorted by column,
+  // which groups them by the processor that owns the design variable.
+  num_entries =
+      combine_dv_sens_entries(num_entries, entries, compare_dv_sens_col);
+
+  const int *ownerRange;
+  initDesignNodeMap();
+  designNodeMap->getOwnerRange(&ownerRange);
+
+  int *sendCount = new int[mpiSize];
+  int *sendPtr = new int[mpiSize + 1];
+  int *recvCount = new int[mpiSize];
+  int *recvPtr = new int[mpiSize + 1];
+  memset(sendCount, 0, mpiSize * sizeof(int));
+  for (int i = 0; i < num_entries; i++) {
+    int owner = TacsFindInterval(entries[i].col / designVarsPerNode,
+                                 mpiSize + 1, ownerRange);
+    sendCount[owner]++;
+  }
+
+  MPI_Alltoall(sendCount, 1, MPI_INT, recvCount, 1, MPI_INT, tacs_comm);
+
+  // Pack the indices and values to send
+  sendPtr[0] = recvPtr[0] = 0;
+  for (int k = 0; k < mpiSize; k++) {
+    sendPtr[k + 1] = sendPtr[k] + sendCount[k];
+    recvPtr[k + 1] = recvPtr[k] + recvCount[k];
+  }
+  int num_recv = recvPtr[mpiSize];
+
+  int *sendIndex = new int[2 * num_entries];
+  TacsScalar *sendValues = new TacsScalar[num_entries];
+  for (int i = 0; i < num_entries; i++) {
+    sendIndex[2 * i] = entries[i].row;
+    sendIndex[2 * i + 1] = entries[i].col;
+    sendValues[i] = entries[i].value;
+  }
+  delete[] entries;
+
+  int *recvIndex = new int[2 * num_recv];
+  TacsScalar *recvValues = new TacsScalar[num_recv];
+  MPI_Alltoallv(sendValues, sendCount, sendPtr, TACS_MPI_TYPE, recvValues,
+                recvCount, recvPtr, TACS_MPI_TYPE, tacs_comm);
+  for (int k = 0; k < mpiSize; k++) {
+    sendCount[k] *= 2;
+    sendPtr[k] *= 2;
+    recvCount[k] *= 2;
+    recvPtr[k] *= 2;
+  }
+  MPI_Alltoallv(sendIndex, sendCount, sendPtr, MPI_INT, recvIndex, recvCount,
+                recvPtr, MPI_INT, tacs_comm);
+
+  delete[] sendCount;
+  delete[] sendPtr;
+  delete[] recvCount;
+  delete[] recvPtr;
+  delete[] sendIndex;
+  delete[] sendValues;
+
+  // Combine the entries received from all processors by row
+  entries = new TacsDVSensEntry[num_recv];
+  for (int i = 0; i < num_recv; i++) {
+    entries[i].row = recvIndex[2 * i];
+    entries[i].col = recvIndex[2 * i + 1];
+    entries[i].value = recvValues[i];
+  }
+  delete[] recvIndex;
+  delete[] recvValues;
+  int nnz = combine_dv_sens_entries(num_recv, entries, compare_dv_sens_row);
+
+  // Form the compressed sparse row output
+  int *_rowp = new int[numFuncs + 1];
+  int *_cols = new int[nnz];
+  TacsScalar *_vals = new TacsScalar[nnz];
+  memset(_rowp, 0, (numFuncs + 1) * sizeof(int));
+  for (int i = 0; i < nnz; i++) {
+    _rowp[entries[i].row + 1]++;
+    _cols[i] = entries[i].col;
+    _vals[i] = entries[i].value;
+  }
+  for (int k = 0; k < numFuncs; k++) {
+    _rowp[k + 1] += _rowp[k];
+  }
+  delete[] entries;
+
+  *rowp = _rowp;
+  *cols = _cols;
+  *vals = _vals;
+
+  return nnz;
+}
+
+/**
+  Restrict the derivatives w.r.t. the node locations to a subset of
+  the nodes.
+
+  This function is collective on all TACSAssembler processes. After
+  this call, addXptSens(), addAdjointResXptSensProducts() and
+  addResXptProducts() only visit the elements that contain a node in
+  the subset. The element contributions to nodes outside the subset
+  are discarded, so the derivatives for these nodes are zero. This is
+  useful when only the derivatives for the surface nodes are required,
+  for instance when the surface nodes drive a mesh deformation.
+
+  The node numbers are global TACS node numbers. Each processor may
+  provide any part of the subset, and the subsets from all processors
+  are combined. Call this with numNodes = 0 on all processors to
+  restore the derivatives for all nodes.
+
+  @param numNodes The number of nodes provided on this processor
+  @param nodes The global node numbers in the subset
+*/
+void TACSAssembler::setXptSensNodes(int numNodes, const int *nodes) {
+  if (xptSensNodes) {
+    delete[] xptSensNodes;
+  }
+  if (xptSensElemFlags) {
+    delete[] xptSensElemFlags;
+  }
+  numXptSensNodes = 0;
+  xptSensNodes = NULL;
+  xptSensElemFlags = NULL;
+
+  // Combine the node numbers from all processors
+  int *counts = new int[mpiSize];
+  int *ptr = new int[mpiSize + 1];
+  MPI_Allgather(&numNodes, 1, MPI_INT, counts, 1, MPI_INT, tacs_comm);
+  ptr[0] = 0;
+  for (int k = 0; k < mpiSize; k++) {
+    ptr[k + 1] = ptr[k] + counts[k];
+  }
+
+  if (ptr[mpiSize] > 0) {
+    xptSensNodes = new int[ptr[mpiSize]];
+    MPI_Allgatherv((void *)nodes, numNodes, MPI_INT, xptSensNodes, counts, ptr,
+                   MPI_INT, tacs_comm);
+    numXptSensNodes = TacsUniqueSort(ptr[mpiSize], xptSensNodes);
+
+    // Flag the elements that contain a node in the subset, including
+    // the independent nodes of any dependent nodes
+    const int *depNodePtr = NULL;
+    const int *depNodeConn = NULL;
+    if (depNodes) {
+      depNodes->getDepNodes(&depNodePtr, &depNodeConn, NULL);
+    }
+
+    xptSensElemFlags = new int[numElements];
+    for (int i = 0; i < numElements; i++) {
+      xptSensElemFlags[i] = 0;
+      for (int jp = elementNodeIndex[i]; jp < elementNodeIndex[i + 1]; jp++) {
+        int node = elementTacsNodes[jp];
+        if (node >= 0) {
+          if (TacsSearchArray(node, numXptSensNodes, xptSensNodes)) {
+            xptSensElemFlags[i] = 1;
+          }
+        } else if (depNodePtr) {
+          int dep = -node - 1;
+          for (int kp = depNodePtr[dep]; kp < depNodePtr[dep + 1]; kp++) {
+            if (TacsSearchArray(depNodeConn[kp], numXptSensNodes,
+                                xptSensNodes)) {
+              xptSensElemFlags[i] = 1;
+            }
+          }
         }
       }
     }
   }
+
+  delete[] counts;
+  delete[] ptr;
+}
+
+/*
+  Zero the entries of the element node location derivative that
+  belong to independent nodes outside the node subset. The dependent
+  node entries are kept since they are added to their independent
+  nodes.
+*/
+void TACSAssembler::maskXptSens(int len, const int *nodes,
+                                TacsScalar *xptSens) {
+  if (xptSensNodes) {
+    for (int i = 0; i < len; i++) {
+      if (nodes[i] >= 0 &&
+          !TacsSearchArray(nodes[i], numXptSensNodes, xptSensNodes)) {
+        xptSens[TACS_SPATIAL_DIM * i] = 0.0;
+        xptSens[TACS_SPATIAL_DIM * i + 1] = 0.0;
+        xptSens[TACS_SPATIAL_DIM * i + 2] = 0.0;
+      }
+    }
+  }
 }
 
 /**
@@ -4815,6 +8940,7 @@ void TACSAssembler::addDVSens(TacsScalar coef, int numFuncs,
 */
 void TACSAssembler::addXptSens(TacsScalar coef, int numFuncs,
                                TACSFunction **funcs, TACSBVec **dfdXpt) {
+  TACSProfileScope scope("TACSAssembler::addXptSens");
   // First check if this is the right assembly object
   for (int k = 0; k < numFuncs; k++) {
     if (funcs[k] && this != funcs[k]->getAssembler()) {
@@ -4829,51 +8955,72 @@ void TACSAssembler::addXptSens(TacsScalar coef, int numFuncs,
   getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts,
                   &elemXptSens, NULL, NULL);
 
-  // For each function, evaluate the derivative w.r.t. the
-  // nodal locations for all elements or part of the domain
+  // For each function, evaluate the derivative w.r.t. the nodal
+  // locations on the threads, or collect the function so that the
+  // derivatives of all the remaining functions are evaluated in a
+  // single pass over the elements
+  TACSFunction **serialFuncs = new TACSFunction *[numFuncs];
+  int numSerial = 0;
   for (int k = 0; k < numFuncs; k++) {
+    serialFuncs[k] = NULL;
     if (funcs[k]) {
-      if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
-        // Get the function sub-domain
-        const int *elemSubList;
-        int numSubElems = funcs[k]->getElementNums(&elemSubList);
-        for (int i = 0; i < numSubElems; i++) {
-          int elemNum = elemSubList[i];
-          // Determine the values of the state variables for subElem
-          int ptr = elementNodeIndex[elemNum];
-          int len = elementNodeIndex[elemNum + 1] - ptr;
-          const int *nodes = &elementTacsNodes[ptr];
-          xptVec->getValues(len, nodes, elemXpts);
-          varsVec->getValues(len, nodes, vars);
-          dvarsVec->getValues(len, nodes, dvars);
-          ddvarsVec->getValues(len, nodes, ddvars);
-
-          // Evaluate the element-wise sensitivity of the function
-          funcs[k]->getElementXptSens(elemNum, elements[elemNum], time, coef,
-                                      elemXpts, vars, dvars, ddvars,
-                                      elemXptSens);
-          dfdXpt[k]->setValues(len, nodes, elemXptSens, TACS_ADD_VALUES);
-        }
-      } else if (funcs[k]->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
-        for (int elemNum = 0; elemNum < numElements; elemNum++) {
-          // Determine the values of the state variables for elemNum
-          int ptr = elementNodeIndex[elemNum];
-          int len = elementNodeIndex[elemNum + 1] - ptr;
-          const int *nodes = &elementTacsNodes[ptr];
-          xptVec->getValues(len, nodes, elemXpts);
-          varsVec->getValues(len, nodes, vars);
-          dvarsVec->getValues(len, nodes, dvars);
-          ddvarsVec->getValues(len, nodes, ddvars);
-
-          // Evaluate the element-wise sensitivity of the function
-          funcs[k]->getElementXptSens(elemNum, elements[elemNum], time, coef,
-                                      elemXpts, vars, dvars, ddvars,
-                                      elemXptSens);
-          dfdXpt[k]->setValues(len, nodes, elemXptSens, TACS_ADD_VALUES);
-        }
+      if (thread_info->getNumThreads() > 1 &&
+          funcs[k]->getDomainType() != TACSFunction::NO_DOMAIN) {
+        // Add the derivatives to a separate vector on each thread
+        tacsPInfo->assembler = this;
+        tacsPInfo->function = funcs[k];
+        tacsPInfo->coef = coef;
+        tacsPInfo->sched =
+            createFunctionSchedule(funcs[k], &tacsPInfo->elemNums);
+        tacsPInfo->threadVecs = createThreadVecs(1, &dfdXpt[k]);
+        thread_info->runThreads(TACSAssembler::addXptSens_thread,
+                                (void *)tacsPInfo);
+        addThreadVecs(1, tacsPInfo->threadVecs);
+        tacsPInfo->threadVecs = NULL;
+        tacsPInfo->sched->decref();
+        tacsPInfo->sched = NULL;
+      } else {
+        serialFuncs[k] = funcs[k];
+        numSerial++;
+      }
+    }
+  }
+
+  if (numSerial > 0) {
+    int *elemFuncs;
+    int *elemFuncPtr =
+        createElementFunctionList(numFuncs, serialFuncs, &elemFuncs);
+
+    for (int elemNum = 0; elemNum < numElements; elemNum++) {
+      if (elemFuncPtr[elemNum] == elemFuncPtr[elemNum + 1] ||
+          !isXptSensElement(elemNum)) {
+        continue;
+      }
+
+      // Determine the values of the state variables for elemNum
+      int ptr = elementNodeIndex[elemNum];
+      int len = elementNodeIndex[elemNum + 1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
+      varsVec->getValues(len, nodes, vars);
+      dvarsVec->getValues(len, nodes, dvars);
+      ddvarsVec->getValues(len, nodes, ddvars);
+
+      // Evaluate the element-wise sensitivity of each function
+      for (int j = elemFuncPtr[elemNum]; j < elemFuncPtr[elemNum + 1]; j++) {
+        int k = elemFuncs[j];
+        funcs[k]->getElementXptSens(elemNum, elements[elemNum], time, coef,
+                                    elemXpts, vars, dvars, ddvars, elemXptSens);
+        maskXptSens(len, nodes, elemXptSens);
+        dfdXpt[k]->setValues(len, nodes, elemXptSens, TACS_ADD_VALUES);
       }
     }
+
+    delete[] elemFuncPtr;
+    delete[] elemFuncs;
   }
+
+  delete[] serialFuncs;
 }
 
 /**
@@ -4899,6 +9046,7 @@ void TACSAssembler::addXptSens(TacsScalar coef, int numFuncs,
 void TACSAssembler::addSVSens(TacsScalar alpha, TacsScalar beta,
                               TacsScalar gamma, int numFuncs,
                               TACSFunction **funcs, TACSBVec **dfdu) {
+  TACSProfileScope scope("TACSAssembler::addSVSens");
   // First check if this is the right assembly object
   for (int k = 0; k < numFuncs; k++) {
     if (funcs[k] && this != funcs[k]->getAssembler()) {
@@ -4912,57 +9060,80 @@ void TACSAssembler::addSVSens(TacsScalar alpha, TacsScalar beta,
   getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
                   NULL, NULL, NULL);
 
+  // Evaluate the derivatives on the threads, or collect the function
+  // so that the derivatives of all the remaining functions are
+  // evaluated in a single pass over the elements
+  TACSFunction **serialFuncs = new TACSFunction *[numFuncs];
+  int numSerial = 0;
   for (int k = 0; k < numFuncs; k++) {
+    serialFuncs[k] = NULL;
     if (funcs[k]) {
-      if (funcs[k]->getDomainType() == TACSFunction::ENTIRE_DOMAIN) {
-        for (int elemNum = 0; elemNum < numElements; elemNum++) {
-          // Determine the values of the state variables for subElem
-          int ptr = elementNodeIndex[elemNum];
-          int len = elementNodeIndex[elemNum + 1] - ptr;
-          const int *nodes = &elementTacsNodes[ptr];
-          xptVec->getValues(len, nodes, elemXpts);
-          varsVec->getValues(len, nodes, vars);
-          dvarsVec->getValues(len, nodes, dvars);
-          ddvarsVec->getValues(len, nodes, ddvars);
-
-          // Evaluate the element-wise sensitivity of the function
-          funcs[k]->getElementSVSens(elemNum, elements[elemNum], time, alpha,
-                                     beta, gamma, elemXpts, vars, dvars, ddvars,
-                                     elemRes);
-          dfdu[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
-        }
-      } else if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN) {
-        const int *elementNums;
-        int subDomainSize = funcs[k]->getElementNums(&elementNums);
+      if (thread_info->getNumThreads() > 1 &&
+          funcs[k]->getDomainType() != TACSFunction::NO_DOMAIN) {
+        // Add the derivatives to a separate vector on each thread
+        tacsPInfo->assembler = this;
+        tacsPInfo->function = funcs[k];
+        tacsPInfo->alpha = alpha;
+        tacsPInfo->beta = beta;
+        tacsPInfo->gamma = gamma;
+        tacsPInfo->sched =
+            createFunctionSchedule(funcs[k], &tacsPInfo->elemNums);
+        tacsPInfo->threadVecs = createThreadVecs(1, &dfdu[k]);
+        thread_info->runThreads(TACSAssembler::addSVSens_thread,
+                                (void *)tacsPInfo);
+        addThreadVecs(1, tacsPInfo->threadVecs);
+        tacsPInfo->threadVecs = NULL;
+        tacsPInfo->sched->decref();
+        tacsPInfo->sched = NULL;
+      } else {
+        serialFuncs[k] = funcs[k];
+        numSerial++;
+      }
+    }
+  }
+
+  if (numSerial > 0) {
+    int *elemFuncs;
+    int *elemFuncPtr =
+        createElementFunctionList(numFuncs, serialFuncs, &elemFuncs);
+
+    for (int elemNum = 0; elemNum < numElements; elemNum++) {
+      if (elemFuncPtr[elemNum] == elemFuncPtr[elemNum + 1]) {
+        continue;
+      }
+
+      // Determine the values of the state variables for the current
+      // element
+      int ptr = elementNodeIndex[elemNum];
+      int len = elementNodeIndex[elemNum + 1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
+      varsVec->getValues(len, nodes, vars);
+      dvarsVec->getValues(len, nodes, dvars);
+      ddvarsVec->getValues(len, nodes, ddvars);
 
-        for (int i = 0; i < subDomainSize; i++) {
-          int elemNum = elementNums[i];
-          if (elemNum >= 0 && elemNum < numElements) {
-            // Determine the values of the state variables for the
-            // current element
-            int ptr = elementNodeIndex[elemNum];
-            int len = elementNodeIndex[elemNum + 1] - ptr;
-            const int *nodes = &elementTacsNodes[ptr];
-            xptVec->getValues(len, nodes, elemXpts);
-            varsVec->getValues(len, nodes, vars);
-            dvarsVec->getValues(len, nodes, dvars);
-            ddvarsVec->getValues(len, nodes, ddvars);
-
-            // Evaluate the element-wise sensitivity of the function
-            funcs[k]->getElementSVSens(elemNum, elements[elemNum], time, alpha,
-                                       beta, gamma, elemXpts, vars, dvars,
-                                       ddvars, elemRes);
-            dfdu[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
-          }
-        }
+      // Evaluate the element-wise sensitivity of each function
+      for (int j = elemFuncPtr[elemNum]; j < elemFuncPtr[elemNum + 1]; j++) {
+        int k = elemFuncs[j];
+        funcs[k]->getElementSVSens(elemNum, elements[elemNum], time, alpha,
+                                   beta, gamma, elemXpts, vars, dvars, ddvars,
+                                   elemRes);
+        dfdu[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
       }
+    }
+
+    delete[] elemFuncPtr;
+    delete[] elemFuncs;
+  }
+
+  delete[] serialFuncs;
 
-      // Add the values into the array
+  // Add the values into the array
+  for (int k = 0; k < numFuncs; k++) {
+    if (funcs[k]) {
       dfdu[k]->beginSetValues(TACS_ADD_VALUES);
     }
   }
-
-  // Finish adding the values
   for (int k = 0; k < numFuncs; k++) {
     if (funcs[k]) {
       dfdu[k]->endSetValues(TACS_ADD_VALUES);
@@ -4992,6 +9163,7 @@ void TACSAssembler::addSVSens(TacsScalar alpha, TacsScalar beta,
 void TACSAssembler::addAdjointResProducts(TacsScalar scale, int numAdjoints,
                                           TACSBVec **adjoint, TACSBVec **dfdx,
                                           const TacsScalar lambda) {
+  TACSProfileScope scope("TACSAssembler::addAdjointResProducts");
   // Distribute the design variable values to all processors
   for (int k = 0; k < numAdjoints; k++) {
     adjoint[k]->beginDistributeValues();
@@ -5006,17 +9178,41 @@ void TACSAssembler::addAdjointResProducts(TacsScalar scale, int numAdjoints,
     auxElements->sort();
   }
 
+  // Run the p-threaded version of the products
+  if (thread_info->getNumThreads() > 1) {
+    // Add the products to a separate set of vectors on each thread
+    initElementSchedule();
+    tacsPInfo->assembler = this;
+    tacsPInfo->coef = scale;
+    tacsPInfo->lambda = lambda;
+    tacsPInfo->numAdjoints = numAdjoints;
+    tacsPInfo->adjoints = adjoint;
+    tacsPInfo->threadVecs = createThreadVecs(numAdjoints, dfdx);
+    thread_info->runThreads(TACSAssembler::addAdjointResProducts_thread,
+                            (void *)tacsPInfo);
+    addThreadVecs(numAdjoints, tacsPInfo->threadVecs);
+    tacsPInfo->threadVecs = NULL;
+    return;
+  }
+
   // Retrieve pointers to temporary storage
-  TacsScalar *vars, *dvars, *ddvars;
-  TacsScalar *elemXpts, *elemAdjoint;
-  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemAdjoint, &elemXpts,
-                  NULL, NULL, NULL);
+  TacsScalar *vars, *dvars, *ddvars, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
+                  NULL, NULL);
 
   // Get the design variables from the elements on this process
   const int maxDVs = maxElementDesignVars;
-  TacsScalar *fdvSens = elementSensData;
   int *dvNums = elementSensIData;
 
+  // Allocate space for the element adjoints and derivatives so that
+  // each element can contract its residual derivative with all the
+  // adjoints at once
+  const int sdv = maxDVs * designVarsPerNode;
+  TACSScratchScope scratch;
+  TacsScalar *elemAdjoints =
+      scratch.allocScalars(numAdjoints * maxElementSize);
+  TacsScalar *fdvSens = scratch.allocScalars(numAdjoints * sdv);
+
   // Set the data for the auxiliary elements - if there are any
   int naux = 0, aux_count = 0;
   TACSAuxElem *aux = NULL;
@@ -5029,26 +9225,28 @@ void TACSAssembler::addAdjointResProducts(TacsScalar scale, int numAdjoints,
     int ptr = elementNodeIndex[i];
     int len = elementNodeIndex[i + 1] - ptr;
     const int *nodes = &elementTacsNodes[ptr];
+    int nvars = varsPerNode * len;
     xptVec->getValues(len, nodes, elemXpts);
     varsVec->getValues(len, nodes, vars);
     dvarsVec->getValues(len, nodes, dvars);
     ddvarsVec->getValues(len, nodes, ddvars);
 
+    // Get the element adjoint vectors
+    for (int k = 0; k < numAdjoints; k++) {
+      adjoint[k]->getValues(len, nodes, &elemAdjoints[nvars * k]);
+    }
+
     // Get the design variables for this element
     int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+    int size = numDVs * designVarsPerNode;
 
-    // Get the adjoint variables
+    // Add the adjoint-residual products
+    memset(fdvSens, 0, numAdjoints * size * sizeof(TacsScalar));
+    elements[i]->addAdjResProductMulti(i, time, scale, numAdjoints,
+                                       elemAdjoints, elemXpts, vars, dvars,
+                                       ddvars, numDVs, fdvSens);
     for (int k = 0; k < numAdjoints; k++) {
-      memset(fdvSens, 0, numDVs * designVarsPerNode * sizeof(TacsScalar));
-
-      // Get the element adjoint vector
-      adjoint[k]->getValues(len, nodes, elemAdjoint);
-
-      // Add the adjoint-residual product
-      elements[i]->addAdjResProduct(i, time, scale, elemAdjoint, elemXpts, vars,
-                                    dvars, ddvars, numDVs, fdvSens);
-
-      dfdx[k]->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+      dfdx[k]->setValues(numDVs, dvNums, &fdvSens[size * k], TACS_ADD_VALUES);
     }
 
     // Add the contribution from the auxiliary elements, scaled by lambda
@@ -5056,24 +9254,37 @@ void TACSAssembler::addAdjointResProducts(TacsScalar scale, int numAdjoints,
       while (aux_count < naux && aux[aux_count].num == i) {
         // Get the design variables for this element
         numDVs = aux[aux_count].elem->getDesignVarNums(i, maxDVs, dvNums);
+        size = numDVs * designVarsPerNode;
 
-        // Get the adjoint variables
+        memset(fdvSens, 0, numAdjoints * size * sizeof(TacsScalar));
+        aux[aux_count].elem->addAdjResProductMulti(
+            i, time, lambda * scale, numAdjoints, elemAdjoints, elemXpts, vars,
+            dvars, ddvars, numDVs, fdvSens);
         for (int k = 0; k < numAdjoints; k++) {
-          memset(fdvSens, 0, numDVs * designVarsPerNode * sizeof(TacsScalar));
-
-          // Get the element adjoint vector
-          adjoint[k]->getValues(len, nodes, elemAdjoint);
-
-          aux[aux_count].elem->addAdjResProduct(i, time, lambda * scale,
-                                                elemAdjoint, elemXpts, vars,
-                                                dvars, ddvars, numDVs, fdvSens);
-
-          dfdx[k]->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+          dfdx[k]->setValues(numDVs, dvNums, &fdvSens[size * k],
+                             TACS_ADD_VALUES);
         }
         aux_count++;
       }
     }
+
+    // Add the contribution from the body loads, scaled by lambda
+    TACSElement *loads[2];
+    int nloads = getBodyLoads(i, loads);
+    for (int l = 0; l < nloads; l++) {
+      numDVs = loads[l]->getDesignVarNums(i, maxDVs, dvNums);
+      size = numDVs * designVarsPerNode;
+
+      memset(fdvSens, 0, numAdjoints * size * sizeof(TacsScalar));
+      loads[l]->addAdjResProductMulti(i, time, lambda * scale, numAdjoints,
+                                      elemAdjoints, elemXpts, vars, dvars,
+                                      ddvars, numDVs, fdvSens);
+      for (int k = 0; k < numAdjoints; k++) {
+        dfdx[k]->setValues(numDVs, dvNums, &fdvSens[size * k], TACS_ADD_VALUES);
+      }
+    }
   }
+
 }
 
 /**
@@ -5104,65 +9315,531 @@ void TACSAssembler::addAdjointResXptSensProducts(TacsScalar scale,
     adjoint[k]->endDistributeValues();
   }
 
-  // Sort the list of auxiliary elements - this only performs the
-  // sort if it is required (if new elements are added)
-  if (auxElements) {
-    auxElements->sort();
+  // Sort the list of auxiliary elements - this only performs the
+  // sort if it is required (if new elements are added)
+  if (auxElements) {
+    auxElements->sort();
+  }
+
+  // Run the p-threaded version of the products
+  if (thread_info->getNumThreads() > 1) {
+    // Add the products to a separate set of vectors on each thread
+    initElementSchedule();
+    tacsPInfo->assembler = this;
+    tacsPInfo->coef = scale;
+    tacsPInfo->lambda = lambda;
+    tacsPInfo->numAdjoints = numAdjoints;
+    tacsPInfo->adjoints = adjoint;
+    tacsPInfo->threadVecs = createThreadVecs(numAdjoints, dfdXpt);
+    thread_info->runThreads(TACSAssembler::addAdjointResXptSensProducts_thread,
+                            (void *)tacsPInfo);
+    addThreadVecs(numAdjoints, tacsPInfo->threadVecs);
+    tacsPInfo->threadVecs = NULL;
+    return;
+  }
+
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars, *elemXpts;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
+                  NULL, NULL);
+
+  // Allocate space for the element adjoints and derivatives so that
+  // each element can contract its residual derivative with all the
+  // adjoints at once
+  const int sx = TACS_SPATIAL_DIM * maxElementNodes;
+  TACSScratchScope scratch;
+  TacsScalar *elemAdjoints =
+      scratch.allocScalars(numAdjoints * maxElementSize);
+  TacsScalar *xptSens = scratch.allocScalars(numAdjoints * sx);
+
+  // Set the data for the auxiliary elements - if there are any
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (auxElements) {
+    naux = auxElements->getAuxElements(&aux);
+  }
+
+  for (int i = 0; i < numElements; i++) {
+    // Skip the elements that do not touch the node subset
+    if (!isXptSensElement(i)) {
+      while (aux_count < naux && aux[aux_count].num == i) {
+        aux_count++;
+      }
+      continue;
+    }
+
+    // Find the variables and nodes
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    int nvars = varsPerNode * len;
+    int size = TACS_SPATIAL_DIM * len;
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+
+    // Get the element adjoint vectors
+    for (int k = 0; k < numAdjoints; k++) {
+      adjoint[k]->getValues(len, nodes, &elemAdjoints[nvars * k]);
+    }
+
+    // Add the adjoint-residual products
+    memset(xptSens, 0, numAdjoints * size * sizeof(TacsScalar));
+    elements[i]->addAdjResXptProductMulti(i, time, scale, numAdjoints,
+                                          elemAdjoints, elemXpts, vars, dvars,
+                                          ddvars, xptSens);
+
+    // Add the contribution from the auxiliary elements, scaled by lambda
+    if (aux_count < naux) {
+      while (aux_count < naux && aux[aux_count].num == i) {
+        aux[aux_count].elem->addAdjResXptProductMulti(
+            i, time, lambda * scale, numAdjoints, elemAdjoints, elemXpts, vars,
+            dvars, ddvars, xptSens);
+        aux_count++;
+      }
+    }
+
+    // Add the contribution from the body loads, scaled by lambda
+    TACSElement *loads[2];
+    int nloads = getBodyLoads(i, loads);
+    for (int l = 0; l < nloads; l++) {
+      loads[l]->addAdjResXptProductMulti(i, time, lambda * scale, numAdjoints,
+                                         elemAdjoints, elemXpts, vars, dvars,
+                                         ddvars, xptSens);
+    }
+
+    for (int k = 0; k < numAdjoints; k++) {
+      maskXptSens(len, nodes, &xptSens[size * k]);
+      dfdXpt[k]->setValues(len, nodes, &xptSens[size * k], TACS_ADD_VALUES);
+    }
+  }
+
+}
+
+/**
+  Evaluate the product of the derivative of the residual w.r.t. the
+  design variables with several direction vectors.
+
+  This function is collective on all TACSAssembler processes. This is
+  the forward counterpart of addAdjointResProducts() and forms the
+  right-hand-sides for direct (forward) sensitivities:
+
+  res[k] += scale*dR/dx*dx[k]
+
+  The directions are evaluated in a single pass over the elements. The
+  boundary condition entries of the output are zeroed, since the
+  residual at these entries does not depend on the design variables.
+
+  @param scale Scalar factor applied to the derivative
+  @param numDirs The number of direction vectors
+  @param dx The array of design variable directions
+  @param res The product of the derivative of the residuals and dx
+  @param lambda Scaling factor for the aux element contributions, by default 1
+*/
+void TACSAssembler::addResDVProducts(TacsScalar scale, int numDirs,
+                                     TACSBVec **dx, TACSBVec **res,
+                                     const TacsScalar lambda) {
+  // Distribute the design variable directions to all processors
+  for (int k = 0; k < numDirs; k++) {
+    dx[k]->beginDistributeValues();
+  }
+  for (int k = 0; k < numDirs; k++) {
+    dx[k]->endDistributeValues();
+  }
+
+  // Sort the list of auxiliary elements - this only performs the
+  // sort if it is required (if new elements are added)
+  if (auxElements) {
+    auxElements->sort();
+  }
+
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars;
+  TacsScalar *elemXpts, *elemRes;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  NULL, NULL, NULL);
+
+  // Get the design variables from the elements on this process
+  const int maxDVs = maxElementDesignVars;
+  TacsScalar *elemDir = elementSensData;
+  int *dvNums = elementSensIData;
+
+  // Set the data for the auxiliary elements - if there are any
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (auxElements) {
+    naux = auxElements->getAuxElements(&aux);
+  }
+
+  for (int i = 0; i < numElements; i++) {
+    // Find the variables and nodes
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    int nvars = varsPerNode * len;
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+
+    // Get the design variables for this element
+    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+    if (numDVs > 0) {
+      for (int k = 0; k < numDirs; k++) {
+        dx[k]->getValues(numDVs, dvNums, elemDir);
+
+        memset(elemRes, 0, nvars * sizeof(TacsScalar));
+        elements[i]->addResDVProduct(i, time, scale, elemXpts, vars, dvars,
+                                     ddvars, numDVs, elemDir, elemRes);
+
+        res[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+      }
+    }
+
+    // Add the contribution from the auxiliary elements, scaled by lambda
+    if (aux_count < naux) {
+      while (aux_count < naux && aux[aux_count].num == i) {
+        numDVs = aux[aux_count].elem->getDesignVarNums(i, maxDVs, dvNums);
+        if (numDVs > 0) {
+          for (int k = 0; k < numDirs; k++) {
+            dx[k]->getValues(numDVs, dvNums, elemDir);
+
+            memset(elemRes, 0, nvars * sizeof(TacsScalar));
+            aux[aux_count].elem->addResDVProduct(i, time, lambda * scale,
+                                                 elemXpts, vars, dvars, ddvars,
+                                                 numDVs, elemDir, elemRes);
+
+            res[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+          }
+        }
+        aux_count++;
+      }
+    }
+  }
+
+  for (int k = 0; k < numDirs; k++) {
+    res[k]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for (int k = 0; k < numDirs; k++) {
+    res[k]->endSetValues(TACS_ADD_VALUES);
+    res[k]->applyBCs(bcMap);
+  }
+}
+
+/**
+  Evaluate the product of the derivative of the residual w.r.t. the
+  nodal points with several direction vectors.
+
+  This function is collective on all TACSAssembler processes. This is
+  the forward counterpart of addAdjointResXptSensProducts():
+
+  res[k] += scale*dR/dXpts*dXpts[k]
+
+  @param scale Scalar factor applied to the derivative
+  @param numDirs The number of direction vectors
+  @param dXpts The array of node location directions
+  @param res The product of the derivative of the residuals and dXpts
+  @param lambda Scaling factor for the aux element contributions, by default 1
+*/
+void TACSAssembler::addResXptProducts(TacsScalar scale, int numDirs,
+                                      TACSBVec **dXpts, TACSBVec **res,
+                                      const TacsScalar lambda) {
+  for (int k = 0; k < numDirs; k++) {
+    dXpts[k]->beginDistributeValues();
+  }
+  for (int k = 0; k < numDirs; k++) {
+    dXpts[k]->endDistributeValues();
+  }
+
+  // Sort the list of auxiliary elements - this only performs the
+  // sort if it is required (if new elements are added)
+  if (auxElements) {
+    auxElements->sort();
+  }
+
+  // Retrieve pointers to temporary storage
+  TacsScalar *vars, *dvars, *ddvars;
+  TacsScalar *elemXpts, *elemRes, *elemDir;
+  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemRes, &elemXpts,
+                  &elemDir, NULL, NULL);
+
+  // Set the data for the auxiliary elements - if there are any
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (auxElements) {
+    naux = auxElements->getAuxElements(&aux);
+  }
+
+  for (int i = 0; i < numElements; i++) {
+    // Skip the elements that do not touch the node subset
+    if (!isXptSensElement(i)) {
+      while (aux_count < naux && aux[aux_count].num == i) {
+        aux_count++;
+      }
+      continue;
+    }
+
+    // Find the variables and nodes
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    int nvars = varsPerNode * len;
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, vars);
+    dvarsVec->getValues(len, nodes, dvars);
+    ddvarsVec->getValues(len, nodes, ddvars);
+
+    for (int k = 0; k < numDirs; k++) {
+      dXpts[k]->getValues(len, nodes, elemDir);
+      maskXptSens(len, nodes, elemDir);
+
+      memset(elemRes, 0, nvars * sizeof(TacsScalar));
+      elements[i]->addResXptProduct(i, time, scale, elemXpts, vars, dvars,
+                                    ddvars, elemDir, elemRes);
+
+      res[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+    }
+
+    // Add the contribution from the auxiliary elements, scaled by lambda
+    if (aux_count < naux) {
+      while (aux_count < naux && aux[aux_count].num == i) {
+        for (int k = 0; k < numDirs; k++) {
+          dXpts[k]->getValues(len, nodes, elemDir);
+          maskXptSens(len, nodes, elemDir);
+
+          memset(elemRes, 0, nvars * sizeof(TacsScalar));
+          aux[aux_count].elem->addResXptProduct(i, time, lambda * scale,
+                                                elemXpts, vars, dvars, ddvars,
+                                                elemDir, elemRes);
+
+          res[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+        }
+        aux_count++;
+      }
+    }
+  }
+
+  for (int k = 0; k < numDirs; k++) {
+    res[k]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for (int k = 0; k < numDirs; k++) {
+    res[k]->endSetValues(TACS_ADD_VALUES);
+    res[k]->applyBCs(bcMap);
+  }
+}
+
+/*
+  Evaluate the gradients of the Lagrangians L[k] = f[k] - psi[k]^{T}*R
+  with respect to the design variables and the states, with the
+  multipliers psi[k] held fixed, at the current design point and states
+
+  gx[k] = df[k]/dx - psi[k]^{T}*dR/dx
+  gu[k] = df[k]/du - psi[k]^{T}*dR/du
+*/
+void TACSAssembler::evalLagrangianGradients(int numFuncs, TACSFunction **funcs,
+                                            TACSBVec **psi, TACSBVec **gx,
+                                            TACSBVec **gu) {
+  // Evaluate the functions so that any function data that depends on
+  // the current point (such as the KS maximum) is updated
+  TacsScalar *fvals = new TacsScalar[numFuncs];
+  evalFunctions(numFuncs, funcs, fvals);
+  delete[] fvals;
+
+  for (int k = 0; k < numFuncs; k++) {
+    gx[k]->zeroEntries();
+    gu[k]->zeroEntries();
+  }
+
+  // Compute the derivatives w.r.t. the design variables
+  addDVSens(1.0, numFuncs, funcs, gx);
+  addAdjointResProducts(-1.0, numFuncs, psi, gx);
+  for (int k = 0; k < numFuncs; k++) {
+    gx[k]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for (int k = 0; k < numFuncs; k++) {
+    gx[k]->endSetValues(TACS_ADD_VALUES);
+  }
+
+  // Compute the derivatives w.r.t. the states
+  addSVSens(1.0, 0.0, 0.0, numFuncs, funcs, gu);
+  for (int k = 0; k < numFuncs; k++) {
+    addJacobianVecProduct(-1.0, 1.0, 0.0, 0.0, psi[k], gu[k],
+                          TACS_MAT_TRANSPOSE);
+  }
+}
+
+/**
+  Evaluate the product of the Hessian of several functions with a
+  direction in the design variables.
+
+  This function is collective on all TACSAssembler processes. The
+  Hessian is the second derivative of the reduced functions f(x,
+  u(x)), where the states satisfy R(x, u) = 0, and is computed using a
+  second-order adjoint (forward-over-reverse) method:
+
+  1. Solve the adjoint equations K*psi = df/du
+  2. Solve the forward equations K*w = -dR/dx*dir
+  3. Compute the directional derivatives of the Lagrangian gradients
+  along (dir, w) with the multipliers held fixed: dgx and dgu
+  4. Solve the second-order adjoint equations K*dpsi = dgu
+  5. Compute hvec = dgx - dpsi^{T}*dR/dx
+
+  The directional derivatives in step 3 are computed by complex step
+  when the complex code is compiled, and by central differences of the
+  analytic first-order derivatives otherwise. The solver must be set
+  up with the factored Jacobian at the current states, which must
+  satisfy the governing equations. As with the adjoint solves in TACS,
+  the Jacobian is assumed to be symmetric. This applies to steady
+  problems only.
+
+  @param numFuncs The number of functions
+  @param funcs The TACSFunction function objects
+  @param ksm The linear solver for the Jacobian at the current states
+  @param dir The direction in the design variables
+  @param hvec The Hessian-vector products for each function (output)
+  @param dh The finite-difference or complex-step step size
+*/
+void TACSAssembler::evalHessianVecProduct(int numFuncs, TACSFunction **funcs,
+                                          TACSKsm *ksm, TACSBVec *dir,
+                                          TACSBVec **hvec, double dh) {
+  // Store the design variables and states
+  TACSBVec *x = createDesignVec();
+  TACSBVec *xtemp = createDesignVec();
+  TACSBVec *u = createVec();
+  TACSBVec *utemp = createVec();
+  TACSBVec *w = createVec();
+  x->incref();
+  xtemp->incref();
+  u->incref();
+  utemp->incref();
+  w->incref();
+  getDesignVars(x);
+  getVariables(u);
+
+  TACSBVec **psi = new TACSBVec *[numFuncs];
+  TACSBVec **dpsi = new TACSBVec *[numFuncs];
+  TACSBVec **gu = new TACSBVec *[numFuncs];
+  for (int k = 0; k < numFuncs; k++) {
+    psi[k] = createVec();
+    dpsi[k] = createVec();
+    gu[k] = createVec();
+    psi[k]->incref();
+    dpsi[k]->incref();
+    gu[k]->incref();
+  }
+
+  // Solve for the adjoint variables
+  TacsScalar *fvals = new TacsScalar[numFuncs];
+  evalFunctions(numFuncs, funcs, fvals);
+  delete[] fvals;
+  addSVSens(1.0, 0.0, 0.0, numFuncs, funcs, gu);
+  for (int k = 0; k < numFuncs; k++) {
+    ksm->solve(gu[k], psi[k]);
+    psi[k]->applyBCs(bcMap);
   }
 
-  // Retrieve pointers to temporary storage
-  TacsScalar *vars, *dvars, *ddvars;
-  TacsScalar *elemXpts, *elemAdjoint, *xptSens;
-  getDataPointers(elementData, &vars, &dvars, &ddvars, &elemAdjoint, &elemXpts,
-                  &xptSens, NULL, NULL);
+  // Solve for the derivative of the states along the direction
+  utemp->zeroEntries();
+  addResDVProducts(-1.0, 1, &dir, &utemp);
+  ksm->solve(utemp, w);
+  w->applyBCs(bcMap);
 
-  // Set the data for the auxiliary elements - if there are any
-  int naux = 0, aux_count = 0;
-  TACSAuxElem *aux = NULL;
-  if (auxElements) {
-    naux = auxElements->getAuxElements(&aux);
-  }
+#ifdef TACS_USE_COMPLEX
+  // Evaluate the gradients at (x + i*dh*dir, u + i*dh*w)
+  xtemp->copyValues(x);
+  xtemp->axpy(TacsScalar(0.0, dh), dir);
+  setDesignVars(xtemp);
+  utemp->copyValues(u);
+  utemp->axpy(TacsScalar(0.0, dh), w);
+  setVariables(utemp);
+  evalLagrangianGradients(numFuncs, funcs, psi, hvec, gu);
 
-  for (int i = 0; i < numElements; i++) {
-    // Find the variables and nodes
-    int ptr = elementNodeIndex[i];
-    int len = elementNodeIndex[i + 1] - ptr;
-    const int *nodes = &elementTacsNodes[ptr];
-    xptVec->getValues(len, nodes, elemXpts);
-    varsVec->getValues(len, nodes, vars);
-    dvarsVec->getValues(len, nodes, dvars);
-    ddvarsVec->getValues(len, nodes, ddvars);
+  for (int k = 0; k < numFuncs; k++) {
+    TacsScalar *array;
+    int size = hvec[k]->getArray(&array);
+    for (int i = 0; i < size; i++) {
+      array[i] = TacsImagPart(array[i]) / dh;
+    }
+    size = gu[k]->getArray(&array);
+    for (int i = 0; i < size; i++) {
+      array[i] = TacsImagPart(array[i]) / dh;
+    }
+  }
+#else
+  TACSBVec **gx = new TACSBVec *[numFuncs];
+  TACSBVec **gu1 = new TACSBVec *[numFuncs];
+  for (int k = 0; k < numFuncs; k++) {
+    gx[k] = createDesignVec();
+    gu1[k] = createVec();
+    gx[k]->incref();
+    gu1[k]->incref();
+  }
 
-    // Get the adjoint variables
-    for (int k = 0; k < numAdjoints; k++) {
-      memset(xptSens, 0, TACS_SPATIAL_DIM * len * sizeof(TacsScalar));
-      adjoint[k]->getValues(len, nodes, elemAdjoint);
-      elements[i]->addAdjResXptProduct(i, time, scale, elemAdjoint, elemXpts,
-                                       vars, dvars, ddvars, xptSens);
+  // Evaluate the gradients at (x + dh*dir, u + dh*w)
+  xtemp->copyValues(x);
+  xtemp->axpy(dh, dir);
+  setDesignVars(xtemp);
+  utemp->copyValues(u);
+  utemp->axpy(dh, w);
+  setVariables(utemp);
+  evalLagrangianGradients(numFuncs, funcs, psi, hvec, gu);
 
-      dfdXpt[k]->setValues(len, nodes, xptSens, TACS_ADD_VALUES);
-    }
+  // Evaluate the gradients at (x - dh*dir, u - dh*w)
+  xtemp->copyValues(x);
+  xtemp->axpy(-dh, dir);
+  setDesignVars(xtemp);
+  utemp->copyValues(u);
+  utemp->axpy(-dh, w);
+  setVariables(utemp);
+  evalLagrangianGradients(numFuncs, funcs, psi, gx, gu1);
 
-    // Add the contribution from the auxiliary elements, scaled by lambda
-    if (aux_count < naux) {
-      while (aux_count < naux && aux[aux_count].num == i) {
-        // Get the adjoint variables
-        for (int k = 0; k < numAdjoints; k++) {
-          memset(xptSens, 0, TACS_SPATIAL_DIM * len * sizeof(TacsScalar));
+  // Form the central difference approximations
+  for (int k = 0; k < numFuncs; k++) {
+    hvec[k]->axpy(-1.0, gx[k]);
+    hvec[k]->scale(0.5 / dh);
+    gu[k]->axpy(-1.0, gu1[k]);
+    gu[k]->scale(0.5 / dh);
+    gx[k]->decref();
+    gu1[k]->decref();
+  }
+  delete[] gx;
+  delete[] gu1;
+#endif  // TACS_USE_COMPLEX
 
-          // Get the element adjoint vector
-          adjoint[k]->getValues(len, nodes, elemAdjoint);
+  // Restore the design variables and states
+  setDesignVars(x);
+  setVariables(u);
 
-          aux[aux_count].elem->addAdjResXptProduct(i, time, lambda * scale,
-                                                   elemAdjoint, elemXpts, vars,
-                                                   dvars, ddvars, xptSens);
+  // Solve the second-order adjoint equations and add the final
+  // contribution to the Hessian-vector products
+  for (int k = 0; k < numFuncs; k++) {
+    gu[k]->applyBCs(bcMap);
+    ksm->solve(gu[k], dpsi[k]);
+    dpsi[k]->applyBCs(bcMap);
+  }
+  addAdjointResProducts(-1.0, numFuncs, dpsi, hvec);
+  for (int k = 0; k < numFuncs; k++) {
+    hvec[k]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for (int k = 0; k < numFuncs; k++) {
+    hvec[k]->endSetValues(TACS_ADD_VALUES);
+  }
 
-          dfdXpt[k]->setValues(len, nodes, xptSens, TACS_ADD_VALUES);
-        }
-        aux_count++;
-      }
-    }
+  for (int k = 0; k < numFuncs; k++) {
+    psi[k]->decref();
+    dpsi[k]->decref();
+    gu[k]->decref();
   }
+  delete[] psi;
+  delete[] dpsi;
+  delete[] gu;
+
+  x->decref();
+  xtemp->decref();
+  u->decref();
+  utemp->decref();
+  w->decref();
 }
 
 /**
@@ -5227,6 +9904,85 @@ void TACSAssembler::addMatDVSensInnerProduct(TacsScalar scale,
   }
 }
 
+/**
+  Evaluate the derivatives of the inner products of several pairs of
+  vectors with several types of matrices in a single pass over the
+  elements.
+
+  For each pair k, this adds the derivative of
+
+  sum_{j} scale[numMatTypes*k + j] * psi[k]^{T} A_{j} phi[k]
+
+  to dfdx[k], where A_{j} is the matrix of type matTypes[j]. The element
+  data is retrieved once for each element, and the contributions from
+  all the matrix types for a pair are added to the vector together.
+  This is more efficient than calling addMatDVSensInnerProduct() for
+  each pair and matrix type when the derivatives of many eigenvalues
+  are required.
+
+  @param numMatTypes The number of matrix types
+  @param matTypes The types of matrices
+  @param numVecs The number of pairs of vectors
+  @param scale Scalar factors for each pair and matrix type
+  @param psi The left-multiplying vectors
+  @param phi The right-multiplying vectors
+  @param dfdx The derivative vectors
+*/
+void TACSAssembler::addMatDVSensInnerProducts(
+    int numMatTypes, const ElementMatrixType matTypes[], int numVecs,
+    const TacsScalar scale[], TACSBVec **psi, TACSBVec **phi,
+    TACSBVec **dfdx) {
+  for (int k = 0; k < numVecs; k++) {
+    psi[k]->beginDistributeValues();
+    if (phi[k] != psi[k]) {
+      phi[k]->beginDistributeValues();
+    }
+  }
+  for (int k = 0; k < numVecs; k++) {
+    psi[k]->endDistributeValues();
+    if (phi[k] != psi[k]) {
+      phi[k]->endDistributeValues();
+    }
+  }
+
+  // Retrieve pointers to temporary storage
+  TacsScalar *elemVars, *elemPsi, *elemPhi, *elemXpts;
+  getDataPointers(elementData, &elemVars, &elemPsi, &elemPhi, NULL, &elemXpts,
+                  NULL, NULL, NULL);
+
+  // Get the design variables from the elements on this process
+  const int maxDVs = maxElementDesignVars;
+  TacsScalar *fdvSens = elementSensData;
+  int *dvNums = elementSensIData;
+
+  for (int i = 0; i < numElements; i++) {
+    // Find the variables and nodes
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, elemVars);
+
+    // Get the design variables for this element
+    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+
+    for (int k = 0; k < numVecs; k++) {
+      psi[k]->getValues(len, nodes, elemPsi);
+      phi[k]->getValues(len, nodes, elemPhi);
+      memset(fdvSens, 0, numDVs * designVarsPerNode * sizeof(TacsScalar));
+
+      // Add the contributions from each matrix type
+      for (int j = 0; j < numMatTypes; j++) {
+        elements[i]->addMatDVSensInnerProduct(
+            matTypes[j], i, time, scale[numMatTypes * k + j], elemPsi, elemPhi,
+            elemXpts, elemVars, numDVs, fdvSens);
+      }
+
+      dfdx[k]->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+    }
+  }
+}
+
 /**
   Evaluate the derivative of an inner product of two vectors with a
   matrix of a given type. This code does not explicitly evaluate the
@@ -5286,6 +10042,89 @@ void TACSAssembler::addMatXptSensInnerProduct(TacsScalar scale,
   }
 }
 
+/**
+  Evaluate the derivatives of the inner products of several pairs of
+  vectors with several types of matrices with respect to the node
+  locations in a single pass over the elements.
+
+  This is the counterpart of addMatDVSensInnerProducts() for the node
+  locations. The element computes the derivatives for all the pairs at
+  once, so that any work that does not depend on the vectors, such as
+  the perturbed element matrices, is shared between the pairs.
+
+  @param numMatTypes The number of matrix types
+  @param matTypes The types of matrices
+  @param numVecs The number of pairs of vectors
+  @param scale Scalar factors for each pair and matrix type
+  @param psi The left-multiplying vectors
+  @param phi The right-multiplying vectors
+  @param dfdXpt The derivative vectors
+*/
+void TACSAssembler::addMatXptSensInnerProducts(
+    int numMatTypes, const ElementMatrixType matTypes[], int numVecs,
+    const TacsScalar scale[], TACSBVec **psi, TACSBVec **phi,
+    TACSBVec **dfdXpt) {
+  for (int k = 0; k < numVecs; k++) {
+    psi[k]->beginDistributeValues();
+    if (phi[k] != psi[k]) {
+      phi[k]->beginDistributeValues();
+    }
+  }
+  for (int k = 0; k < numVecs; k++) {
+    psi[k]->endDistributeValues();
+    if (phi[k] != psi[k]) {
+      phi[k]->endDistributeValues();
+    }
+  }
+
+  // Retrieve pointers to temporary storage
+  TacsScalar *elemVars, *elemXpts;
+  getDataPointers(elementData, &elemVars, NULL, NULL, NULL, &elemXpts, NULL,
+                  NULL, NULL);
+
+  // Allocate space for the element vectors and derivatives for all the
+  // pairs so that each element can share its work between the pairs
+  const int xptSize = TACS_SPATIAL_DIM * maxElementNodes;
+  TACSScratchScope scratch;
+  TacsScalar *elemPsi =
+      scratch.allocScalars(numVecs * (2 * maxElementSize + xptSize));
+  TacsScalar *elemPhi = &elemPsi[numVecs * maxElementSize];
+  TacsScalar *xptSens = &elemPhi[numVecs * maxElementSize];
+  TacsScalar *elemScale = scratch.allocScalars(numVecs);
+
+  for (int i = 0; i < numElements; i++) {
+    // Find the variables and nodes
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, elemVars);
+
+    const int nvars = elements[i]->getNumVariables();
+    const int nxpts = TACS_SPATIAL_DIM * len;
+    for (int k = 0; k < numVecs; k++) {
+      psi[k]->getValues(len, nodes, &elemPsi[nvars * k]);
+      phi[k]->getValues(len, nodes, &elemPhi[nvars * k]);
+    }
+    memset(xptSens, 0, numVecs * nxpts * sizeof(TacsScalar));
+
+    // Add the contributions from each matrix type
+    for (int j = 0; j < numMatTypes; j++) {
+      for (int k = 0; k < numVecs; k++) {
+        elemScale[k] = scale[numMatTypes * k + j];
+      }
+      elements[i]->addMatXptSensInnerProducts(matTypes[j], i, time, numVecs,
+                                              elemScale, elemPsi, elemPhi,
+                                              elemXpts, elemVars, xptSens);
+    }
+
+    for (int k = 0; k < numVecs; k++) {
+      dfdXpt[k]->setValues(len, nodes, &xptSens[nxpts * k], TACS_ADD_VALUES);
+    }
+  }
+
+}
+
 /**
   Evaluate the derivative of the inner product of two vectors with a
   matrix with respect to the state variables. This is only defined for
@@ -5348,6 +10187,75 @@ void TACSAssembler::evalMatSVSensInnerProduct(ElementMatrixType matType,
   dfdu->applyBCs(bcMap);
 }
 
+/**
+  Evaluate the derivatives of the inner products of several pairs of
+  vectors with a matrix with respect to the state variables in a
+  single pass over the elements.
+
+  @param matType The type of matrix
+  @param numVecs The number of pairs of vectors
+  @param psi The left-multiplying vectors
+  @param phi The right-multiplying vectors
+  @param dfdu The derivatives of the inner products w.r.t. the state vars
+*/
+void TACSAssembler::evalMatSVSensInnerProducts(ElementMatrixType matType,
+                                               int numVecs, TACSBVec **psi,
+                                               TACSBVec **phi,
+                                               TACSBVec **dfdu) {
+  // Zero the entries in the residual vectors
+  for (int k = 0; k < numVecs; k++) {
+    dfdu[k]->zeroEntries();
+  }
+
+  // Distribute the variable values
+  for (int k = 0; k < numVecs; k++) {
+    psi[k]->beginDistributeValues();
+    if (phi[k] != psi[k]) {
+      phi[k]->beginDistributeValues();
+    }
+  }
+  for (int k = 0; k < numVecs; k++) {
+    psi[k]->endDistributeValues();
+    if (phi[k] != psi[k]) {
+      phi[k]->endDistributeValues();
+    }
+  }
+
+  // Retrieve pointers to temporary storage
+  TacsScalar *elemVars, *elemPsi, *elemPhi, *elemRes, *elemXpts;
+  getDataPointers(elementData, &elemVars, &elemPsi, &elemPhi, &elemRes,
+                  &elemXpts, NULL, NULL, NULL);
+
+  for (int i = 0; i < numElements; i++) {
+    // Find the variables and nodes
+    int ptr = elementNodeIndex[i];
+    int len = elementNodeIndex[i + 1] - ptr;
+    const int *nodes = &elementTacsNodes[ptr];
+    xptVec->getValues(len, nodes, elemXpts);
+    varsVec->getValues(len, nodes, elemVars);
+
+    for (int k = 0; k < numVecs; k++) {
+      psi[k]->getValues(len, nodes, elemPsi);
+      phi[k]->getValues(len, nodes, elemPhi);
+
+      elements[i]->getMatSVSensInnerProduct(matType, i, time, elemPsi, elemPhi,
+                                            elemXpts, elemVars, elemRes);
+
+      dfdu[k]->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+    }
+  }
+
+  for (int k = 0; k < numVecs; k++) {
+    dfdu[k]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for (int k = 0; k < numVecs; k++) {
+    dfdu[k]->endSetValues(TACS_ADD_VALUES);
+
+    // Apply the boundary conditions to the fully assembled vector
+    dfdu[k]->applyBCs(bcMap);
+  }
+}
+
 /**
   Evaluate a Jacobian-vector product of the input vector
   x and store the result in the output vector y.
@@ -5374,9 +10282,13 @@ void TACSAssembler::addJacobianVecProduct(TacsScalar scale, TacsScalar alpha,
                                           TACSBVec *x, TACSBVec *y,
                                           MatrixOrientation matOr,
                                           const TacsScalar lambda) {
+  TACSProfileScope scope("TACSAssembler::addJacobianVecProduct");
   x->beginDistributeValues();
   x->endDistributeValues();
 
+  // Allocate or update the element matrix cache
+  initElementMatCache();
+
   // Retrieve pointers to temporary storage
   TacsScalar *vars, *dvars, *ddvars, *yvars, *elemXpts;
   TacsScalar *elemWeights, *elemMat;
@@ -5405,8 +10317,12 @@ void TACSAssembler::addJacobianVecProduct(TacsScalar scale, TacsScalar alpha,
 
     // Compute and add the contributions to the Jacobian
     memset(elemMat, 0, nvars * nvars * sizeof(TacsScalar));
-    elements[i]->addJacobian(i, time, alpha, beta, gamma, elemXpts, vars, dvars,
-                             ddvars, yvars, elemMat);
+    if (!(elementMatCacheData &&
+          addCachedJacobian(i, nvars, alpha, beta, gamma, elemXpts, vars,
+                            dvars, ddvars, yvars, elemMat))) {
+      elements[i]->addJacobian(i, time, alpha, beta, gamma, elemXpts, vars,
+                               dvars, ddvars, yvars, elemMat);
+    }
 
     // Add the contribution to the residual and the Jacobian
     // from the auxiliary elements - if any, this is scaled by the loadFactor
@@ -5681,11 +10597,179 @@ void TACSAssembler::testElement(int elemNum, int print_level, double dh,
     return;
   }
 
-  // Retrieve pointers to temporary storage
-  TacsScalar *res;
-  TacsScalar *vars, *dvars, *ddvars, *elemXpts;
-  getDataPointers(elementData, &vars, &dvars, &ddvars, &res, &elemXpts, NULL,
-                  NULL, NULL);
+  TacsScalar *temp = new TacsScalar[4 * maxElementSize +
+                                    3 * maxElementNodes + maxElementDesignVars];
+  int fail[NUM_ELEMENT_TESTS];
+  double times[NUM_ELEMENT_TESTS];
+  runElementTests(elemNum, temp, print_level, dh, rtol, atol, fail, times);
+  delete[] temp;
+}
+
+/**
+  Test a sample of the elements of each element class.
+
+  The elements are grouped by the name of their element object. Up to
+  num_samples elements, evenly spaced through the local element list,
+  are selected from each group and the same tests as testElement() are
+  applied. The tests are run on the threads, and a summary of the
+  number of failures and the average time for each test is printed
+  for each element class. The times provide a rough per-element
+  benchmark of the derivative kernels.
+
+  @param num_samples The maximum number of elements tested in each class
+  @param print_level Print level to use for the individual tests
+  @param dh Finite-difference (or complex-step) step length
+  @param rtol Relative tolerance to apply
+  @param atol Absolute tolerance to apply
+  @return The number of failed tests on this processor
+*/
+int TACSAssembler::testElements(int num_samples, int print_level, double dh,
+                                double rtol, double atol) {
+  if (!meshInitializedFlag) {
+    fprintf(stderr, "[%d] Cannot call testElements() before initialize()\n",
+            mpiRank);
+    return 0;
+  }
+
+  // Group the elements by the name of the element class
+  int num_classes = 0;
+  const char **class_names = new const char *[numElements];
+  int *elem_class = new int[numElements];
+  int *class_count = new int[numElements + 1];
+  for (int i = 0; i < numElements; i++) {
+    const char *name = elements[i]->getObjectName();
+    int c = 0;
+    for (; c < num_classes; c++) {
+      if (strcmp(name, class_names[c]) == 0) {
+        break;
+      }
+    }
+    if (c == num_classes) {
+      class_names[c] = name;
+      class_count[c] = 0;
+      num_classes++;
+    }
+    elem_class[i] = c;
+    class_count[c]++;
+  }
+
+  // Select evenly spaced samples from each class
+  int *sample_ptr = new int[num_classes + 1];
+  sample_ptr[0] = 0;
+  for (int c = 0; c < num_classes; c++) {
+    int n = (class_count[c] < num_samples ? class_count[c] : num_samples);
+    sample_ptr[c + 1] = sample_ptr[c] + n;
+  }
+  int num_tested = sample_ptr[num_classes];
+  int *samples = new int[num_tested];
+  int *visited = new int[num_classes];
+  int *added = new int[num_classes];
+  memset(visited, 0, num_classes * sizeof(int));
+  memset(added, 0, num_classes * sizeof(int));
+  for (int i = 0; i < numElements; i++) {
+    int c = elem_class[i];
+    int n = sample_ptr[c + 1] - sample_ptr[c];
+    if (added[c] < n &&
+        (long)added[c] * class_count[c] <= (long)visited[c] * n) {
+      samples[sample_ptr[c] + added[c]] = i;
+      added[c]++;
+    }
+    visited[c]++;
+  }
+  delete[] visited;
+  delete[] added;
+  delete[] elem_class;
+
+  int *fail = new int[NUM_ELEMENT_TESTS * num_tested];
+  double *times = new double[NUM_ELEMENT_TESTS * num_tested];
+  int tempSize = 4 * maxElementSize + 3 * maxElementNodes + maxElementDesignVars;
+
+  double t0 = MPI_Wtime();
+  if (thread_info->getNumThreads() > 1 && num_tested > 0) {
+    tacsPInfo->assembler = this;
+    tacsPInfo->sched =
+        new TACSThreadSchedule(num_tested, thread_info->getNumThreads());
+    tacsPInfo->sched->incref();
+    tacsPInfo->elemNums = samples;
+    tacsPInfo->testPrintLevel = print_level;
+    tacsPInfo->testDh = dh;
+    tacsPInfo->testRtol = rtol;
+    tacsPInfo->testAtol = atol;
+    tacsPInfo->testFail = fail;
+    tacsPInfo->testTimes = times;
+    thread_info->runThreads(TACSAssembler::testElements_thread,
+                            (void *)tacsPInfo);
+    tacsPInfo->sched->decref();
+    tacsPInfo->sched = NULL;
+    tacsPInfo->elemNums = NULL;
+    tacsPInfo->testFail = NULL;
+    tacsPInfo->testTimes = NULL;
+  } else {
+    TacsScalar *temp = new TacsScalar[tempSize];
+    for (int k = 0; k < num_tested; k++) {
+      runElementTests(samples[k], temp, print_level, dh, rtol, atol,
+                      &fail[NUM_ELEMENT_TESTS * k],
+                      &times[NUM_ELEMENT_TESTS * k]);
+    }
+    delete[] temp;
+  }
+  double t_total = MPI_Wtime() - t0;
+
+  // Print the summary for each element class
+  static const char *test_names[NUM_ELEMENT_TESTS] = {
+      "Jacobian", "AdjResProduct", "AdjResXptProduct",
+      "ElementModel", "MatDVSens", "MatSVSens"};
+
+  int total_fail = 0;
+  printf("[%d] TACSAssembler::testElements() %d elements in %d classes, "
+         "%d threads, %.4e s\n",
+         mpiRank, num_tested, num_classes, thread_info->getNumThreads(),
+         t_total);
+  for (int c = 0; c < num_classes; c++) {
+    int n = sample_ptr[c + 1] - sample_ptr[c];
+    printf("[%d] %s: tested %d of %d elements\n", mpiRank, class_names[c], n,
+           class_count[c]);
+    printf("[%d] %20s %8s %12s\n", mpiRank, "test", "failed", "avg time (s)");
+    for (int j = 0; j < NUM_ELEMENT_TESTS; j++) {
+      int nfail = 0;
+      double t = 0.0;
+      for (int k = sample_ptr[c]; k < sample_ptr[c + 1]; k++) {
+        nfail += fail[NUM_ELEMENT_TESTS * k + j];
+        t += times[NUM_ELEMENT_TESTS * k + j];
+      }
+      total_fail += nfail;
+      printf("[%d] %20s %8d %12.4e\n", mpiRank, test_names[j], nfail,
+             (n > 0 ? t / n : 0.0));
+    }
+  }
+
+  delete[] class_names;
+  delete[] class_count;
+  delete[] sample_ptr;
+  delete[] samples;
+  delete[] fail;
+  delete[] times;
+
+  return total_fail;
+}
+
+/*
+  Run the element tests on a single element
+
+  The temporary array must be large enough to store the node
+  locations, the variables and their time derivatives, and the design
+  variables for any element. The failure flag and the time for each
+  test are stored in fail and times. This only reads the assembler
+  data and may be called from multiple threads.
+*/
+void TACSAssembler::runElementTests(int elemNum, TacsScalar *temp,
+                                    int print_level, double dh, double rtol,
+                                    double atol, int fail[], double times[]) {
+  TacsScalar *vars = &temp[0];
+  TacsScalar *dvars = &temp[maxElementSize];
+  TacsScalar *ddvars = &temp[2 * maxElementSize];
+  TacsScalar *elemXpts = &temp[3 * maxElementSize];
+  TacsScalar *x = &temp[3 * maxElementSize + 3 * maxElementNodes];
 
   int ptr = elementNodeIndex[elemNum];
   int len = elementNodeIndex[elemNum + 1] - ptr;
@@ -5695,17 +10779,29 @@ void TACSAssembler::testElement(int elemNum, int print_level, double dh,
   dvarsVec->getValues(len, nodes, dvars);
   ddvarsVec->getValues(len, nodes, ddvars);
 
+  TACSElement *element = elements[elemNum];
+  double t0 = MPI_Wtime();
+
   int col = -1;
-  TacsTestElementJacobian(elements[elemNum], elemNum, time, elemXpts, vars,
-                          dvars, ddvars, col, dh, print_level, rtol, atol);
+  fail[0] = TacsTestElementJacobian(element, elemNum, time, elemXpts, vars,
+                                    dvars, ddvars, col, dh, print_level, rtol,
+                                    atol);
+  double t1 = MPI_Wtime();
+  times[0] = t1 - t0;
 
   const int maxDVs = maxElementDesignVars;
-  TacsScalar *x = elementSensData;
-  elements[elemNum]->getDesignVars(elemNum, maxDVs, x);
-  TacsTestAdjResProduct(elements[elemNum], elemNum, time, elemXpts, vars, dvars,
-                        ddvars, maxDVs, x, dh, print_level, rtol, atol);
-  TacsTestAdjResXptProduct(elements[elemNum], elemNum, time, elemXpts, vars,
-                           dvars, ddvars, dh, print_level, rtol, atol);
+  element->getDesignVars(elemNum, maxDVs, x);
+  fail[1] = TacsTestAdjResProduct(element, elemNum, time, elemXpts, vars, dvars,
+                                  ddvars, maxDVs, x, dh, print_level, rtol,
+                                  atol);
+  t0 = MPI_Wtime();
+  times[1] = t0 - t1;
+
+  fail[2] = TacsTestAdjResXptProduct(element, elemNum, time, elemXpts, vars,
+                                     dvars, ddvars, dh, print_level, rtol,
+                                     atol);
+  t1 = MPI_Wtime();
+  times[2] = t1 - t0;
 
   // Test the residual computation with the Lagrange multipliers zeroed.
   // This does not work for most elements. The test requires that
@@ -5719,22 +10815,31 @@ void TACSAssembler::testElement(int elemNum, int print_level, double dh,
   // TacsTestElementResidual(elements[elemNum], elemNum, time, elemXpts,
   //                         vars, dvars, ddvars,
   //                         dh, print_level, rtol, atol);
-  TACSElementModel *model = elements[elemNum]->getElementModel();
+  fail[3] = 0;
+  TACSElementModel *model = element->getElementModel();
   if (model) {
-    TacsTestElementModel(model, elemNum, time, dh, print_level, rtol, atol);
-  }
-  TacsTestElementMatDVSens(elements[elemNum], TACS_MASS_MATRIX, elemNum, time,
-                           elemXpts, vars, maxDVs, x, dh, print_level, rtol,
-                           atol);
-  TacsTestElementMatDVSens(elements[elemNum], TACS_STIFFNESS_MATRIX, elemNum,
-                           time, elemXpts, vars, maxDVs, x, dh, print_level,
-                           rtol, atol);
-  TacsTestElementMatDVSens(elements[elemNum], TACS_GEOMETRIC_STIFFNESS_MATRIX,
-                           elemNum, time, elemXpts, vars, maxDVs, x, dh,
-                           print_level, rtol, atol);
-  TacsTestElementMatSVSens(elements[elemNum], TACS_GEOMETRIC_STIFFNESS_MATRIX,
-                           elemNum, time, elemXpts, vars, dh, print_level, rtol,
-                           atol);
+    fail[3] = TacsTestElementModel(model, elemNum, time, dh, print_level, rtol,
+                                   atol);
+  }
+  t0 = MPI_Wtime();
+  times[3] = t0 - t1;
+
+  fail[4] = TacsTestElementMatDVSens(element, TACS_MASS_MATRIX, elemNum, time,
+                                     elemXpts, vars, maxDVs, x, dh,
+                                     print_level, rtol, atol);
+  fail[4] |= TacsTestElementMatDVSens(element, TACS_STIFFNESS_MATRIX, elemNum,
+                                      time, elemXpts, vars, maxDVs, x, dh,
+                                      print_level, rtol, atol);
+  fail[4] |= TacsTestElementMatDVSens(element, TACS_GEOMETRIC_STIFFNESS_MATRIX,
+                                      elemNum, time, elemXpts, vars, maxDVs, x,
+                                      dh, print_level, rtol, atol);
+  t1 = MPI_Wtime();
+  times[4] = t1 - t0;
+
+  fail[5] = TacsTestElementMatSVSens(element, TACS_GEOMETRIC_STIFFNESS_MATRIX,
+                                     elemNum, time, elemXpts, vars, dh,
+                                     print_level, rtol, atol);
+  times[5] = MPI_Wtime() - t1;
 }
 
 /**
@@ -6002,22 +11107,119 @@ int TACSAssembler::getNumComponents() {
   @param data The data for each point for each value (output)
 */
 void TACSAssembler::getElementOutputData(ElementType elem_type, int write_flag,
-                                         int *_len, int *_nvals,
-                                         TacsScalar **_data) {
+                                         int *len, int *nvals,
+                                         TacsScalar **data) {
+  computeElementOutputData(elem_type, write_flag, len, nvals, data, NULL);
+}
+
+/**
+  Get the output data for each element in single precision.
+
+  This is identical to the function above, except that the data is
+  converted element-by-element directly into the single-precision
+  array used by TACSToFH5, avoiding a full-size intermediate copy.
+
+  @param elem_type The element type to match
+  @param write_flag Binary flag indicating the components to write
+  @param len The number of points (output)
+  @param nvals The number of values at each point (output)
+  @param data The data for each point for each value (output)
+*/
+void TACSAssembler::getElementOutputData(ElementType elem_type, int write_flag,
+                                         int *len, int *nvals, float **data) {
+  computeElementOutputData(elem_type, write_flag, len, nvals, NULL, data);
+}
+
+/*
+  Compute the element output data in either double or single
+  precision. The elements are evaluated on the threads when more than
+  one thread is in use, since each element writes to its own segment
+  of the output array.
+*/
+void TACSAssembler::computeElementOutputData(ElementType elem_type,
+                                             int write_flag, int *_len,
+                                             int *_nvals, TacsScalar **_data,
+                                             float **_fdata) {
   int nvals = TacsGetTotalOutputCount(elem_type, write_flag);
-  int len = 0;
+
+  // Compute the offset of each element into the output data
+  int *outputPtr = new int[numElements + 1];
+  outputPtr[0] = 0;
   for (int i = 0; i < numElements; i++) {
-    len += elements[i]->getNumNodes();
+    outputPtr[i + 1] = outputPtr[i] + elements[i]->getNumNodes();
   }
-  TacsScalar *data = new TacsScalar[len * nvals];
-  memset(data, 0, len * nvals * sizeof(TacsScalar));
+  int len = outputPtr[numElements];
 
-  // Retrieve pointers to temporary storage
-  TacsScalar *elemXpts, *vars, *dvars, *ddvars;
-  getDataPointers(elementData, &vars, &dvars, &ddvars, NULL, &elemXpts, NULL,
-                  NULL, NULL);
+  TacsScalar *data = NULL;
+  float *fdata = NULL;
+  if (_data) {
+    data = new TacsScalar[len * nvals];
+    memset(data, 0, len * nvals * sizeof(TacsScalar));
+  } else {
+    fdata = new float[len * nvals];
+    memset(fdata, 0, len * nvals * sizeof(float));
+  }
+
+  if (thread_info->getNumThreads() > 1) {
+    initElementSchedule();
+
+    tacsPInfo->assembler = this;
+    tacsPInfo->sched = elemSchedule;
+    tacsPInfo->sched->incref();
+    tacsPInfo->outputType = elem_type;
+    tacsPInfo->outputFlag = write_flag;
+    tacsPInfo->outputNumVals = nvals;
+    tacsPInfo->outputPtr = outputPtr;
+    tacsPInfo->outputData = data;
+    tacsPInfo->outputFData = fdata;
+    thread_info->runThreads(TACSAssembler::getElementOutputData_thread,
+                            (void *)tacsPInfo);
+    tacsPInfo->sched->decref();
+    tacsPInfo->sched = NULL;
+    tacsPInfo->outputPtr = NULL;
+    tacsPInfo->outputData = NULL;
+    tacsPInfo->outputFData = NULL;
+  } else {
+    int tempSize = 3 * maxElementSize + (3 + nvals) * maxElementNodes;
+    TacsScalar *temp = new TacsScalar[tempSize];
+    getElementOutputRange(0, numElements, elem_type, write_flag, nvals,
+                          outputPtr, temp, data, fdata);
+    delete[] temp;
+  }
+
+  delete[] outputPtr;
+
+  // Set the output pointers
+  *_nvals = nvals;
+  *_len = len;
+  if (_data) {
+    *_data = data;
+  } else {
+    *_fdata = fdata;
+  }
+}
 
-  for (int i = 0, offset = 0; i < numElements; i++) {
+/*
+  Evaluate the output data for the elements in the range [start, end)
+
+  The temporary array must be large enough to store the variables,
+  their time derivatives and the node locations for any element. When
+  the single-precision output is used, it must also be able to store
+  the output data for any element.
+*/
+void TACSAssembler::getElementOutputRange(int start, int end,
+                                          ElementType elem_type, int write_flag,
+                                          int nvals, const int *outputPtr,
+                                          TacsScalar *temp, TacsScalar *data,
+                                          float *fdata) {
+  int s = maxElementSize;
+  TacsScalar *vars = &temp[0];
+  TacsScalar *dvars = &temp[s];
+  TacsScalar *ddvars = &temp[2 * s];
+  TacsScalar *elemXpts = &temp[3 * s];
+  TacsScalar *elemData = &temp[3 * s + 3 * maxElementNodes];
+
+  for (int i = start; i < end; i++) {
     int ptr = elementNodeIndex[i];
     int len = elementNodeIndex[i + 1] - ptr;
     const int *nodes = &elementTacsNodes[ptr];
@@ -6026,16 +11228,22 @@ void TACSAssembler::getElementOutputData(ElementType elem_type, int write_flag,
     dvarsVec->getValues(len, nodes, dvars);
     ddvarsVec->getValues(len, nodes, ddvars);
 
-    elements[i]->getOutputData(i, elem_type, write_flag, elemXpts, vars, dvars,
-                               ddvars, nvals, &data[offset]);
-
-    offset += nvals * elements[i]->getNumNodes();
+    int offset = nvals * outputPtr[i];
+    if (data) {
+      elements[i]->getOutputData(i, elem_type, write_flag, elemXpts, vars,
+                                 dvars, ddvars, nvals, &data[offset]);
+    } else {
+      // Evaluate the data for this element and convert it directly
+      // into the single-precision output
+      int size = nvals * (outputPtr[i + 1] - outputPtr[i]);
+      memset(elemData, 0, size * sizeof(TacsScalar));
+      elements[i]->getOutputData(i, elem_type, write_flag, elemXpts, vars,
+                                 dvars, ddvars, nvals, elemData);
+      for (int k = 0; k < size; k++) {
+        fdata[offset + k] = TacsRealPart(elemData[k]);
+      }
+    }
   }
-
-  // Set the output pointers
-  *_nvals = nvals;
-  *_len = len;
-  *_data = data;
 }
 
 /* get average output stress resultants from TACS*/
@@ -29,8 +29,10 @@ class TACSAssembler;
 // Basic analysis classes
 #include "TACSAuxElements.h"
 #include "TACSElement.h"
+#include "TACSElementRegistry.h"
 #include "TACSFunction.h"
 #include "TACSObject.h"
+#include "TACSThreadSchedule.h"
 
 // Linear algebra classes
 #include "TACSBVecDistribute.h"
@@ -77,6 +79,18 @@ class TACSAssembler : public TACSObject {
     DIRECT_SCHUR,
     GAUSS_SEIDEL
   };
+  enum ElementTimingType {
+    ELEMENT_GET_VALUES_TIME,  // Gather the element nodes and states
+    ELEMENT_RESIDUAL_TIME,    // Element residuals
+    ELEMENT_JACOBIAN_TIME,    // Element Jacobians and matrices
+    ELEMENT_MAT_VALUES_TIME,  // Add the element matrices to the matrix
+    NUM_ELEMENT_TIMING_TYPES
+  };
+  enum ElementOrderType {
+    NATURAL_ELEMENT_ORDER,  // Visit the elements in the input order
+    NODE_ELEMENT_ORDER,     // Order by the lowest node number
+    MORTON_ELEMENT_ORDER    // Order the centroids along a Morton curve
+  };
 
   // Create the TACSAssembler object in parallel
   // -------------------------------------------
@@ -91,6 +105,8 @@ class TACSAssembler : public TACSObject {
   int setElements(TACSElement **_elements);
   int setDependentNodes(const int *_depNodeIndex, const int *_depNodeToTacs,
                         const double *_depNodeWeights);
+  int setDependentNodeTransform(const double *_depNodeBlockWeights,
+                                const TacsScalar *_depNodeXptOffsets = NULL);
 
   void getAverageStresses(ElementType elem_type, TacsScalar *avgStresses);
   void setComplexStepGmatrix(bool flag);
@@ -117,6 +133,7 @@ class TACSAssembler : public TACSObject {
   // Reorder the unknowns according to the specified reordering
   // ----------------------------------------------------------
   void computeReordering(OrderingType order_type, MatrixOrderingType mat_type);
+  void setReordering(const int *oldToNew);
 
   // Functions for retrieving the reordering
   // ---------------------------------------
@@ -157,6 +174,21 @@ class TACSAssembler : public TACSObject {
   void setAuxElements(TACSAuxElements *aux_elems);
   TACSAuxElements *getAuxElements();
 
+  // Set body loads applied directly within the element loops
+  // --------------------------------------------------------
+  void setBodyLoads(const TacsScalar inertiaVec[],
+                    const TacsScalar omegaVec[] = NULL,
+                    const TacsScalar rotCenter[] = NULL, int first_order = 0);
+  void clearBodyLoads();
+  inline int getBodyLoads(int elemIndex, TACSElement *loads[]);
+
+  // Count the changes to the model and state data
+  // ---------------------------------------------
+  int getDesignVersion();
+  int getNodeVersion();
+  int getStateVersion();
+  int getLoadVersion();
+
   // Set the nodes in TACS
   // ---------------------
   TACSBVec *createNodeVec();
@@ -218,10 +250,19 @@ class TACSAssembler : public TACSObject {
   // Residual and Jacobian assembly
   // ------------------------------
   void assembleRes(TACSBVec *residual, const TacsScalar lambda = 1.0);
+  void assembleAuxRes(int nloads, TACSAuxElements **loads,
+                      TACSBVec **residuals);
+  void assembleResMulti(int nloads, TACSAuxElements **loads,
+                        TACSBVec **residuals, const TacsScalar lambda[] = NULL);
   void assembleJacobian(TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
                         TACSBVec *residual, TACSMat *A,
                         MatrixOrientation matOr = TACS_MAT_NORMAL,
                         const TacsScalar lambda = 1.0);
+  void assembleJacobianEnsemble(int nmembers, TACSBVec **dvs,
+                                TACSBVec **vars, TacsScalar alpha,
+                                TacsScalar beta, TacsScalar gamma,
+                                TACSBVec **residuals, TACSMat **mats,
+                                MatrixOrientation matOr = TACS_MAT_NORMAL);
   void assembleMatType(ElementMatrixType matType, TACSMat *A,
                        MatrixOrientation matOr = TACS_MAT_NORMAL,
                        const TacsScalar lambda = 1.0);
@@ -229,6 +270,8 @@ class TACSAssembler : public TACSObject {
                         int nmats, TACSMat *A,
                         MatrixOrientation matOr = TACS_MAT_NORMAL,
                         const TacsScalar lambda = 1.0);
+  void assembleLumpedMass(TACSBVec *mass);
+  double estimateStableTimeStep();
   void addJacobianVecProduct(TacsScalar scale, TacsScalar alpha,
                              TacsScalar beta, TacsScalar gamma, TACSBVec *x,
                              TACSBVec *y,
@@ -258,21 +301,37 @@ class TACSAssembler : public TACSObject {
   // Function and sensitivity evaluation
   // -----------------------------------
   void evalFunctions(int numFuncs, TACSFunction **funcs, TacsScalar *funcVals);
+  void evalResAndFunctions(TACSBVec *residual, int numFuncs,
+                           TACSFunction **funcs, TacsScalar *funcVals,
+                           TACSBVec **dfdu = NULL,
+                           const TacsScalar lambda = 1.0);
 
   // Steady or unsteady derivative evaluation
   // ----------------------------------------
   void addDVSens(TacsScalar coef, int numFuncs, TACSFunction **funcs,
                  TACSBVec **dfdx);
+  int getSparseDVSens(TacsScalar coef, int numFuncs, TACSFunction **funcs,
+                      int **rowp, int **cols, TacsScalar **vals);
   void addSVSens(TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
                  int numFuncs, TACSFunction **funcs, TACSBVec **dfdu);
   void addAdjointResProducts(TacsScalar scale, int numAdjoints,
                              TACSBVec **adjoint, TACSBVec **dfdx,
                              const TacsScalar lambda = 1.0);
+  void setXptSensNodes(int numNodes, const int *nodes);
   void addXptSens(TacsScalar coef, int numFuncs, TACSFunction **funcs,
                   TACSBVec **dfdXpts);
   void addAdjointResXptSensProducts(TacsScalar scale, int numAdjoints,
                                     TACSBVec **adjoint, TACSBVec **dfdXpts,
                                     const TacsScalar lambda = 1.0);
+  void addResDVProducts(TacsScalar scale, int numDirs, TACSBVec **dx,
+                        TACSBVec **res, const TacsScalar lambda = 1.0);
+  void addResXptProducts(TacsScalar scale, int numDirs, TACSBVec **dXpts,
+                         TACSBVec **res, const TacsScalar lambda = 1.0);
+
+  // Second-order derivatives for steady problems
+  // --------------------------------------------
+  void evalHessianVecProduct(int numFuncs, TACSFunction **funcs, TACSKsm *ksm,
+                             TACSBVec *dir, TACSBVec **hvec, double dh = 1e-6);
 
   // Advanced function interface - for time integration
   // --------------------------------------------------
@@ -288,6 +347,19 @@ class TACSAssembler : public TACSObject {
                                  TACSBVec *dfdXpts);
   void evalMatSVSensInnerProduct(ElementMatrixType matType, TACSBVec *psi,
                                  TACSBVec *phi, TACSBVec *res);
+  void addMatDVSensInnerProducts(int numMatTypes,
+                                 const ElementMatrixType matTypes[],
+                                 int numVecs, const TacsScalar scale[],
+                                 TACSBVec **psi, TACSBVec **phi,
+                                 TACSBVec **dfdx);
+  void addMatXptSensInnerProducts(int numMatTypes,
+                                  const ElementMatrixType matTypes[],
+                                  int numVecs, const TacsScalar scale[],
+                                  TACSBVec **psi, TACSBVec **phi,
+                                  TACSBVec **dfdXpts);
+  void evalMatSVSensInnerProducts(ElementMatrixType matType, int numVecs,
+                                  TACSBVec **psi, TACSBVec **phi,
+                                  TACSBVec **res);
 
   // Return elements and node numbers
   // --------------------------------
@@ -301,17 +373,66 @@ class TACSAssembler : public TACSObject {
   // ------------------------------------------------------
   void testElement(int elemNum, int print_level, double dh = 1e-6,
                    double rtol = 1e-8, double atol = 1e-1);
+  int testElements(int num_samples, int print_level = 0, double dh = 1e-6,
+                   double rtol = 1e-8, double atol = 1e-1);
   void testFunction(TACSFunction *func, double dh);
 
   // Set the number of threads to work with
   // --------------------------------------
   void setNumThreads(int t);
+  void setElementCosts(const double *costs);
+  void setElementColoring(int flag);
+  int getNumElementColors();
+  void setElementBatchSize(int size);
+  void setElementRegistry(TACSElementRegistry *registry);
+  void setElementOrder(ElementOrderType order_type);
+  void setMatScatterPlan(int flag);
+  void setMemoryPolicy(int first_touch, int huge_pages = 0);
+
+  // Incrementally reassemble the Jacobian for elements that changed
+  // ----------------------------------------------------------------
+  void setIncrementalJacobian(int flag, int linear = 0,
+                              double max_memory_mb = -1.0);
+  void invalidateIncrementalJacobian();
+  size_t getIncrementalJacobianMemory();
+  void setIncrementalJacobianTolerance(double state_tol,
+                                       int time_independent = 0);
+  int getNumIncrementalElements() { return incrementalCount; }
+
+  // Cache the element stiffness matrices for linear problems
+  // --------------------------------------------------------
+  void setElementMatCache(int flag, double max_memory_mb = -1.0);
+  void clearElementMatCache();
+  size_t getElementMatCacheMemory();
+  void getElementMatCacheStats(long *hits, long *misses, int reset = 0);
+
+  // Cache the element geometry data computed from the nodes
+  // -------------------------------------------------------
+  void setElementGeometryCache(int flag);
+
+  // Use the symmetry of the element matrices in the Jacobian assembly
+  // -----------------------------------------------------------------
+  void setSymmetricElementMatrices(int flag);
+
+  // Apply the boundary conditions while assembling the Jacobian
+  // -----------------------------------------------------------
+  void setAssemblyBCs(int flag);
+
+  // Accumulate the time spent in the element computations
+  // -----------------------------------------------------
+  void setElementTiming(int flag);
+  void zeroElementTimes();
+  void getElementTimes(ElementTimingType type, double times[]);
+  void getComponentTimes(double times[]);
+  void printElementTimes(FILE *fp = stdout);
 
   // Get information about the output files; For use by TACSToFH5
   // ------------------------------------------------------------
   int getNumComponents();
   void getElementOutputData(ElementType elem_type, int write_flag, int *len,
                             int *nvals, TacsScalar **data);
+  void getElementOutputData(ElementType elem_type, int write_flag, int *len,
+                            int *nvals, float **data);
 
   // Functions for ordering the variables
   // ------------------------------------
@@ -324,6 +445,7 @@ class TACSAssembler : public TACSObject {
   // Get the number of design variable numbers
   // -----------------------------------------
   int getNumDesignVars();
+  int computeNumDesignVars();
 
   // Get pointers to the start-locations within the data array
   // ---------------------------------------------------------
@@ -343,11 +465,19 @@ class TACSAssembler : public TACSObject {
   // ------------------------------------
   void computeLocalNodeToNodeCSR(int **_rowp, int **_cols, int nrnodes,
                                  const int *rnodes, int nodiag);
+  void computeLocalConn(int **_conn, int **_depConn);
+  void computeNodeToElementCSR(const int *conn, const int *depConn,
+                               int **_nodeElem, int **_nodeElemIndex);
+  void computeNodeToNodeGraph(int **_rowp, int **_cols, int nodiag);
 
   // Compute the connectivity of the multiplier information
   void computeMultiplierConn(int *_num_multipliers, int **_multipliers,
                              int **_indep_ptr, int **_indep_nodes);
 
+  // Apply new node numbers to the connectivity and boundary conditions
+  void applyReordering(int *newNodeNums, int *extPtr, int *extCount,
+                       int *recvPtr, int *recvCount, int *recvNodes);
+
   // Compute the reordering for a local matrix
   // -----------------------------------------
   void computeMatReordering(OrderingType order_type, int nvars, int *rowp,
@@ -359,7 +489,20 @@ class TACSAssembler : public TACSObject {
   // Add values into the matrix
   inline void addMatValues(TACSMat *A, const int elemNum, const TacsScalar *mat,
                            int *item, TacsScalar *temp,
-                           MatrixOrientation matOr);
+                           MatrixOrientation matOr, int denseMat = 0);
+  void addBlockWeightMatValues(TACSMat *A, const int elemNum,
+                               const TacsScalar *mat, MatrixOrientation matOr);
+  void initDepNodeGather();
+  void initDesignVarMap();
+  void initDesignNodeMap();
+
+  // Apply the boundary conditions to the element matrices and the
+  // matrix during the Jacobian assembly
+  int isAssemblyBCsActive();
+  void initAssemblyBCs();
+  inline void applyElementMatBCs(const int elemNum, TacsScalar *mat,
+                                 MatrixOrientation matOr);
+  void addAssemblyBCDiagonal(TACSMat *A);
 
   TACSNodeMap *nodeMap;               // Variable ownership map
   TACSBcMap *bcMap;                   // Boundary condition data
@@ -367,6 +510,7 @@ class TACSAssembler : public TACSObject {
   TACSBVecDistribute *extDist;        // Distribute the vector
   TACSBVecIndices *extDistIndices;    // The tacsVarNum indices
   TACSBVecDepNodes *depNodes;         // Dependent variable information
+  TacsScalar *depNodeXptOffsets;      // Fixed offsets of dependent nodes
   TACSNodeMap *designNodeMap;         // Distribution of design variables
   TACSBVecDistribute *designExtDist;  // Distribute the design variables
   TACSBVecDepNodes *designDepNodes;   // Dependent design variable information
@@ -377,6 +521,16 @@ class TACSAssembler : public TACSObject {
   // Additional information information for the TACSParallel class
   TACSBVecIndices *parMatIndices;
 
+  // The non-zero patterns shared by all the matrices created by
+  // createMat() and createSchurMat()
+  BCSRMatPattern *parMatPatterns[2];
+  BCSRMatPattern *schurMatPatterns[4];
+
+  // The node-to-node graph including the diagonal. This is computed
+  // once the mesh is initialized and copied by
+  // computeLocalNodeToNodeCSR().
+  int *nodeCSRRowp, *nodeCSRCols;
+
   // Additional ordering information for the TACSSchurMat class
   // These are created once - all subsequent calls use this data.
   TACSBVecIndices *schurBIndices, *schurCIndices;
@@ -419,6 +573,12 @@ class TACSAssembler : public TACSObject {
   // The auxiliary element class
   TACSAuxElements *auxElements;
 
+  // The body load elements for each element (two entries per element)
+  // and the distinct body load objects that they share
+  TACSElement **bodyLoads;
+  int numBodyLoadObjs;
+  TACSElement **bodyLoadObjs;
+
   // The variables, velocities and accelerations
   TACSBVec *varsVec, *dvarsVec, *ddvarsVec;
 
@@ -429,10 +589,22 @@ class TACSAssembler : public TACSObject {
   TacsScalar *elementData;  // Space for element residuals/matrices
   int *elementIData;        // Space for element index data
 
+  // The independent nodes and weights for each element node, with the
+  // dependent node weights folded in. The entries for the element node
+  // j are depGatherPtr[j] <= k < depGatherPtr[j+1].
+  int *depGatherPtr, *depGatherVars;
+  TacsScalar *depGatherWeights;
+
   // Memory for the design variables and inddex data
   TacsScalar *elementSensData;
   int *elementSensIData;
 
+  // The design variable numbers of each element and the values last
+  // set into the elements. The entries for element i are stored in
+  // elementDVPtr[i] <= k < elementDVPtr[i+1].
+  int *elementDVPtr, *elementDVNums;
+  TacsScalar *elementDVVals;
+
   // Memory for the initial condition vectors
   TACSBVec *vars0, *dvars0, *ddvars0;
 
@@ -443,10 +615,82 @@ class TACSAssembler : public TACSObject {
 
   // The static member functions that are used to p-thread TACSAssembler
   // operations... These are the most time-consuming operations.
-  static void schedPthreadJob(TACSAssembler *tacs, int *index, int total_size);
+  void initElementSchedule();
+  void initElementOrder();
+  void initElementKernels();
+  void computeElementColoring();
+  void runElementThreads(void *(*func)(void *));
+  int getElementBatch(const int *elemList, int start, int end,
+                      int *elemIndices);
+  void assembleLoadCaseRes(int nloads, TACSAuxElements **loads,
+                           TACSBVec **residuals, const TacsScalar lambda[],
+                           int add_element_res);
+  void fusedResAndFunctions(TACSBVec *residual, TacsScalar lambda,
+                           TACSFunction::EvaluationType ftype, int numFuncs,
+                           TACSFunction **funcs, int **funcCounts);
+  void fusedSVSens(int numFuncs, TACSFunction **funcs, int **funcCounts,
+                   TACSBVec **dfdu);
+  void initElementMatCache();
+  void updateElementCacheMemory();
+  void addElementTime(ElementTimingType type, int n, const int *elemIndices,
+                      double t);
+  int addCachedResidual(int elemIndex, int nvars, const TacsScalar *Xpts,
+                        const TacsScalar *vars, const TacsScalar *dvars,
+                        const TacsScalar *ddvars, TacsScalar *res);
+  int addCachedJacobian(int elemIndex, int nvars, TacsScalar alpha,
+                        TacsScalar beta, TacsScalar gamma,
+                        const TacsScalar *Xpts, const TacsScalar *vars,
+                        const TacsScalar *dvars, const TacsScalar *ddvars,
+                        TacsScalar *res, TacsScalar *mat);
+  void addElementResidualBatch(TACSElement *element, int n,
+                               const int *elemIndices, const TacsScalar *Xpts,
+                               const TacsScalar *vars, const TacsScalar *dvars,
+                               const TacsScalar *ddvars, TacsScalar *res);
+  void addElementJacobianBatch(TACSElement *element, int n,
+                               const int *elemIndices, TacsScalar alpha,
+                               TacsScalar beta, TacsScalar gamma,
+                               const TacsScalar *Xpts, const TacsScalar *vars,
+                               const TacsScalar *dvars,
+                               const TacsScalar *ddvars, TacsScalar *res,
+                               TacsScalar *mat);
+  int assembleIncrementalJacobian(TacsScalar alpha, TacsScalar beta,
+                                  TacsScalar gamma, TACSBVec *residual,
+                                  TACSMat *A, MatrixOrientation matOr,
+                                  const TacsScalar lambda);
+  TACSThreadSchedule *createFunctionSchedule(TACSFunction *func,
+                                             const int **elemNums);
+  TACSBVec **createThreadVecs(int nvecs, TACSBVec **vecs);
+  int *createElementFunctionList(int numFuncs, TACSFunction **funcs,
+                                 int **elemFuncs);
+  void evalLagrangianGradients(int numFuncs, TACSFunction **funcs,
+                               TACSBVec **psi, TACSBVec **gx, TACSBVec **gu);
+  int isXptSensElement(int elemNum) {
+    return (!xptSensElemFlags || xptSensElemFlags[elemNum]);
+  }
+  void maskXptSens(int len, const int *nodes, TacsScalar *xptSens);
+  void addThreadVecs(int nvecs, TACSBVec **threadVecs);
+  void computeElementOutputData(ElementType elem_type, int write_flag,
+                                int *len, int *nvals, TacsScalar **data,
+                                float **fdata);
+  void getElementOutputRange(int start, int end, ElementType elem_type,
+                             int write_flag, int nvals, const int *outputPtr,
+                             TacsScalar *temp, TacsScalar *data,
+                             float *fdata);
+  static const int NUM_ELEMENT_TESTS = 6;
+  void runElementTests(int elemNum, TacsScalar *temp, int print_level,
+                       double dh, double rtol, double atol, int fail[],
+                       double times[]);
   static void *assembleRes_thread(void *t);
   static void *assembleJacobian_thread(void *t);
   static void *assembleMatType_thread(void *t);
+  static void *integrateFunctions_thread(void *t);
+  static void *addDVSens_thread(void *t);
+  static void *addSVSens_thread(void *t);
+  static void *addXptSens_thread(void *t);
+  static void *addAdjointResProducts_thread(void *t);
+  static void *addAdjointResXptSensProducts_thread(void *t);
+  static void *getElementOutputData_thread(void *t);
+  static void *testElements_thread(void *t);
 
   // Class to store specific information about the threaded
   // operations to perform. Note that assembly operations are
@@ -471,6 +715,22 @@ class TACSAssembler : public TACSObject {
       fdvSens = NULL;
       fXptSens = NULL;
       adjoints = NULL;
+      color = -1;
+      function = NULL;
+      sched = NULL;
+      elemNums = NULL;
+      threadValues = NULL;
+      threadVecs = NULL;
+      outputType = TACS_ELEMENT_NONE;
+      outputFlag = 0;
+      outputNumVals = 0;
+      outputPtr = NULL;
+      outputData = NULL;
+      outputFData = NULL;
+      testPrintLevel = 0;
+      testDh = testRtol = testAtol = 0.0;
+      testFail = NULL;
+      testTimes = NULL;
     }
 
     // The data required to perform most of the matrix
@@ -487,7 +747,7 @@ class TACSAssembler : public TACSObject {
     MatrixOrientation matOr;
 
     // Information required for the computation of f or df/dx
-    double coef;
+    TacsScalar coef;
     int numFuncs;
     TACSFunction **functions;
     TACSFunction::EvaluationType ftype;
@@ -499,14 +759,129 @@ class TACSAssembler : public TACSObject {
     // Information for adjoint-dR/dx products
     int numAdjoints;
     TACSBVec **adjoints;
+
+    // The element color to assemble (negative if coloring is not used)
+    int color;
+
+    // Information for the threaded function and sensitivity loops
+    TACSFunction *function;     // The function to integrate/differentiate
+    TACSThreadSchedule *sched;  // The schedule for the function domain
+    const int *elemNums;        // The element numbers (NULL for all elements)
+    TacsScalar *threadValues;   // The values accumulated on each thread
+    TACSBVec **threadVecs;      // The vectors accumulated on each thread
+
+    // Information for the threaded evaluation of the output data
+    ElementType outputType;  // The element type for the output
+    int outputFlag;          // The output write flag
+    int outputNumVals;       // The number of values per output point
+    const int *outputPtr;    // The offset of each element into the output
+    TacsScalar *outputData;  // The output data (or NULL)
+    float *outputFData;      // The single-precision output data (or NULL)
+
+    // Information for the threaded element tests
+    int testPrintLevel;                 // The print level for the tests
+    double testDh, testRtol, testAtol;  // The step size and tolerances
+    int *testFail;                      // The failure flags for each test
+    double *testTimes;                  // The time for each test
   } * tacsPInfo;
 
   // The pthread data required to pthread tacs operations
-  int numCompletedElements;     // Keep track of how much work has been done
   TACSThreadInfo *thread_info;  // The pthread object
 
-  // The thread objects
-  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  // The work-stealing schedule for the threaded element loops and the
+  // estimated relative cost of each element used to balance the work
+  TACSThreadSchedule *elemSchedule;
+  double *elementCosts;
+
+  // Element coloring data: Elements with the same color share no
+  // independent nodes, so their contributions can be added to the
+  // global vectors and matrices concurrently without a lock
+  int useElementColoring;
+  int numElementColors;
+  int *elementColorPtr;  // Pointer into elementColors for each color
+  int *elementColors;    // Element indices, sorted by color
+  TACSThreadSchedule **colorSchedules;  // Schedule for each color
+
+  // The maximum number of consecutive elements that share the same
+  // element object that are passed to the batched element kernels
+  int elementBatchSize;
+
+  // The registry of specialized element kernels and the kernel for
+  // each element, or -1 when the element has no registered kernel
+  TACSElementRegistry *elementRegistry;
+  int *elementKernels;
+
+  // The order in which the residual and Jacobian loops visit the
+  // elements, or NULL when the elements are visited in the input order
+  ElementOrderType elementOrderType;
+  int *elementOrder;
+
+  // Flag indicating whether matrices created by createMat() store a
+  // precomputed element scatter plan
+  int useMatScatterPlan;
+
+  // Data for the incremental assembly of the Jacobian. The cache
+  // stores the node locations, design variables, states (unless the
+  // problem is linear) and the element matrix from the last assembly
+  int useIncrementalJacobian;
+  int incrementalLinear;
+  double incrementalMaxMemory;  // Maximum cache size in MB, < 0 no limit
+  double incrementalStateTol;   // Largest state change that is lagged
+  int incrementalTimeIndependent;
+  int incrementalCount;  // Elements recomputed in the last assembly
+
+  // The matrix, coefficients, orientation and time of the last assembly
+  TACSParallelMat *incrementalMat;
+  TacsScalar incrementalCoef[4];
+  MatrixOrientation incrementalMatOr;
+  double incrementalTime;
+
+  // Offset into the cache for each element and the cached element data
+  size_t *incrementalPtr;
+  TacsScalar *incrementalCache;
+
+  // Cache of the element stiffness matrices and the element residuals
+  // at zero states for linear problems. Elements that do not fit within
+  // the memory budget have an empty range in elementMatCachePtr.
+  int useElementMatCache;
+  double elementMatCacheMaxMemory;  // Maximum cache size in MB, < 0 no limit
+  double elementMatCacheTime;       // Time the cached values were computed
+  size_t *elementMatCachePtr;       // Offset into the cache for each element
+  int *elementMatCacheFlags;        // Flag indicating the entry is computed
+  TacsScalar *elementMatCacheData;  // The cached residuals and matrices
+  std::atomic<long> elementMatCacheHits, elementMatCacheMisses;
+
+  // The memory of the element caches recorded in TACSMemory
+  size_t elementCacheMemory;
+
+  // Flag indicating whether the elements cache their geometry data
+  int useElementGeometryCache;
+
+  // Flag indicating whether the element matrices are symmetric
+  int useSymmetricElementMatrices;
+
+  // Data for applying the boundary conditions during the assembly.
+  // The flags store the constrained variables of each element node
+  // and of each unique owned boundary condition node.
+  int useAssemblyBCs;
+  int *elementBCFlags;
+  int numOwnedBCNodes;
+  int *ownedBCNodes, *ownedBCFlags;
+
+  // The accumulated time spent in each element for each timing type,
+  // stored as NUM_ELEMENT_TIMING_TYPES values per element (NULL when
+  // the element timing is not used)
+  double *elementTimes;
+
+  // Subset of the nodes for the node location derivatives
+  int numXptSensNodes;    // The number of nodes in the subset
+  int *xptSensNodes;      // Sorted global node numbers in the subset
+  int *xptSensElemFlags;  // Flag indicating the element touches the subset
+
+  // Counters incremented when the model data or the states change
+  int designVersion, nodeVersion, stateVersion, loadVersion;
+  int auxElementsVersion;  // Version of the aux elements when last set
+
   pthread_mutex_t tacs_mutex;  // The mutex for coordinating assembly ops.
 
   // The name of the TACSAssembler object
@@ -529,14 +904,46 @@ class TACSAssembler : public TACSObject {
   mat:        the corresponding element matrix
   itemp:      temporary integer storage len(itemp) >= nnodes+1 + len(vars)
   temp:       temporary scalar storage len(temp) >= len(weights)
+  denseMat:   ignore the non-zero node blocks declared by the element,
+              for instance when auxiliary elements have been added
 
   input/output:
   A:          the matrix to which the element-matrix is added
 */
+/*
+  Get the body load elements for the given element
+
+  The inertial load, if any, is returned first, followed by the
+  centrifugal load.
+
+  input:
+  elemIndex:  the local element index
+
+  output:
+  loads:      the body load elements (at most two)
+
+  returns:    the number of body load elements
+*/
+inline int TACSAssembler::getBodyLoads(int elemIndex, TACSElement *loads[]) {
+  int n = 0;
+  if (bodyLoads) {
+    if (bodyLoads[2 * elemIndex]) {
+      loads[n] = bodyLoads[2 * elemIndex];
+      n++;
+    }
+    if (bodyLoads[2 * elemIndex + 1]) {
+      loads[n] = bodyLoads[2 * elemIndex + 1];
+      n++;
+    }
+  }
+  return n;
+}
+
 inline void TACSAssembler::addMatValues(TACSMat *A, const int elemNum,
                                         const TacsScalar *mat, int *itemp,
                                         TacsScalar *temp,
-                                        MatrixOrientation matOr) {
+                                        MatrixOrientation matOr,
+                                        int denseMat) {
   int start = elementNodeIndex[elemNum];
   int end = elementNodeIndex[elemNum + 1];
   int nnodes = end - start;
@@ -547,8 +954,18 @@ inline void TACSAssembler::addMatValues(TACSMat *A, const int elemNum,
 
   if (matOr == TACS_MAT_NORMAL && numDependentNodes == 0) {
     // If we have no dependent nodes, then we don't need to do
-    // anything extra here
-    A->addValues(nnodes, nodeNums, nnodes, nodeNums, nvars, nvars, mat);
+    // anything extra here. Use the precomputed scatter plan if the
+    // matrix has one, otherwise search for the entries. Elements that
+    // declare their non-zero node blocks skip the remaining zero blocks.
+    const int *blocks = NULL;
+    int nblocks = 0;
+    if (!denseMat) {
+      nblocks = elements[elemNum]->getNonZeroNodeBlocks(&blocks);
+    }
+    if (!A->addElementValues(elementNodeIndex, elemNum, nvars, mat, nblocks,
+                             blocks)) {
+      A->addValues(nnodes, nodeNums, nnodes, nodeNums, nvars, nvars, mat);
+    }
   } else {
     // If we have dependent nodes, then we have to figure out what
     // the weighting matrix is and add then add the element matrix
@@ -557,6 +974,29 @@ inline void TACSAssembler::addMatValues(TACSMat *A, const int elemNum,
     const double *depNodeWeights = NULL;
     if (depNodes) {
       depNodes->getDepNodes(&depNodePtr, &depNodeConn, &depNodeWeights);
+
+      // Dependent nodes with block weights require the element matrix
+      // to be transformed before it is added
+      if (depNodes->getBlockWeights(NULL) == varsPerNode) {
+        for (int i = 0; i < nnodes; i++) {
+          if (nodeNums[i] < 0) {
+            addBlockWeightMatValues(A, elemNum, mat, matOr);
+            return;
+          }
+        }
+      }
+    }
+
+    // Use the precomputed independent nodes and weights
+    if (depGatherPtr) {
+      int *varp = &itemp[0];
+      int base = depGatherPtr[start];
+      for (int i = 0; i <= nnodes; i++) {
+        varp[i] = depGatherPtr[start + i] - base;
+      }
+      A->addWeightValues(nnodes, varp, &depGatherVars[base],
+                         &depGatherWeights[base], nvars, nvars, mat, matOr);
+      return;
     }
 
     // Set pointers to the temporary arrays
@@ -589,4 +1029,38 @@ inline void TACSAssembler::addMatValues(TACSMat *A, const int elemNum,
   }
 }
 
+/*
+  Zero the rows of the element matrix for the constrained variables, or
+  the columns when the matrix is assembled in the transpose orientation,
+  so that the element does not contribute to the constrained rows of
+  the assembled matrix.
+*/
+inline void TACSAssembler::applyElementMatBCs(const int elemNum,
+                                              TacsScalar *mat,
+                                              MatrixOrientation matOr) {
+  int start = elementNodeIndex[elemNum];
+  int nnodes = elementNodeIndex[elemNum + 1] - start;
+  int nvars = varsPerNode * nnodes;
+  const int *flags = &elementBCFlags[start];
+
+  for (int i = 0; i < nnodes; i++) {
+    if (flags[i]) {
+      for (int j = 0; j < varsPerNode; j++) {
+        if (flags[i] & (1 << j)) {
+          int var = varsPerNode * i + j;
+          if (matOr == TACS_MAT_NORMAL) {
+            for (int k = 0; k < nvars; k++) {
+              mat[nvars * var + k] = 0.0;
+            }
+          } else {
+            for (int k = 0; k < nvars; k++) {
+              mat[nvars * k + var] = 0.0;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 #endif  // TACS_ASSEMBLER_H
@@ -17,27 +17,9 @@
 */
 
 #include "TACSAssembler.h"
+#include "TACSScratchArena.h"
 #include "tacslapack.h"
 
-/*!
-  Schedule the parts of the matrix/residual to assemble
-*/
-static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-void TACSAssembler::schedPthreadJob(TACSAssembler *assembler, int *index,
-                                    int total_size) {
-  pthread_mutex_lock(&sched_mutex);
-
-  if (assembler->numCompletedElements < total_size) {
-    *index = assembler->numCompletedElements;
-    assembler->numCompletedElements += 1;
-  } else {
-    *index = -1;
-  }
-
-  pthread_mutex_unlock(&sched_mutex);
-}
-
 /*!
   The threaded-implementation of the residual assembly
 
@@ -45,6 +27,9 @@ void TACSAssembler::schedPthreadJob(TACSAssembler *assembler, int *index,
   This function only uses the following data members:
 
   tacs:     the pointer to the TACSAssembler object
+
+  The elements are distributed between the threads using the
+  work-stealing element schedule.
 */
 void *TACSAssembler::assembleRes_thread(void *t) {
   TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
@@ -54,18 +39,22 @@ void *TACSAssembler::assembleRes_thread(void *t) {
   TACSBVec *res = pinfo->res;
   TacsScalar lambda = pinfo->lambda;
 
-  // Allocate a temporary array large enough to store everything required
+  // Take a temporary array large enough to store everything required
+  // for a batch of elements from the scratch arena of this thread
   int s = assembler->maxElementSize;
   int sx = 3 * assembler->maxElementNodes;
-  int dataSize = 4 * s + sx;
-  TacsScalar *data = new TacsScalar[dataSize];
+  int nb = assembler->elementBatchSize;
+  int dataSize = nb * (4 * s + sx);
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+  int *elemIndices = scratch.allocInts(nb);
 
   // Set pointers to the allocate memory
-  TacsScalar *vars = &data[0];
-  TacsScalar *dvars = &data[s];
-  TacsScalar *ddvars = &data[2 * s];
-  TacsScalar *elemRes = &data[3 * s];
-  TacsScalar *elemXpts = &data[4 * s];
+  TacsScalar *batchVars = &data[0];
+  TacsScalar *batchDVars = &data[nb * s];
+  TacsScalar *batchDDVars = &data[2 * nb * s];
+  TacsScalar *batchRes = &data[3 * nb * s];
+  TacsScalar *batchXpts = &data[4 * nb * s];
 
   // Set the data for the auxiliary elements - if there are any
   int naux = 0, aux_count = 0;
@@ -75,73 +64,132 @@ void *TACSAssembler::assembleRes_thread(void *t) {
   }
   // To avoid allocating memory inside the element loop, make the aux element
   // contribution array big enough for the largest element
-  TacsScalar *auxElemRes;
-  bool scaleAux = lambda != TacsScalar(1.0) && naux > 0;
+  TacsScalar *auxElemRes = NULL;
+  bool scaleAux =
+      lambda != TacsScalar(1.0) && (naux > 0 || assembler->bodyLoads);
   if (scaleAux) {
-    auxElemRes = new TacsScalar[s];
+    auxElemRes = scratch.allocScalars(s);
   }
 
-  while (assembler->numCompletedElements < assembler->numElements) {
-    int elemIndex = -1;
-    TACSAssembler::schedPthreadJob(assembler, &elemIndex,
-                                   assembler->numElements);
+  // Get the index of this thread within the element schedule. When
+  // coloring is used, only the elements of the current color are
+  // visited and no lock is required to add their contributions.
+  TACSThreadSchedule *sched = assembler->elemSchedule;
+  const int *elemList = assembler->elementOrder;
+  if (pinfo->color >= 0) {
+    sched = assembler->colorSchedules[pinfo->color];
+    int offset = assembler->elementColorPtr[pinfo->color];
+    elemList = &assembler->elementColors[offset];
+  }
+  int thread = sched->getThreadIndex();
 
-    if (elemIndex >= 0) {
-      // Get the element object
-      TACSElement *element = assembler->elements[elemIndex];
+  // The elements are not visited in increasing order when the element
+  // order is set, so the auxiliary elements are located by a search
+  int searchAux = (pinfo->color < 0 && elemList);
 
-      // Retrieve the variable values
-      int ptr = assembler->elementNodeIndex[elemIndex];
-      int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
-      const int *nodes = &assembler->elementTacsNodes[ptr];
-      assembler->xptVec->getValues(len, nodes, elemXpts);
-      assembler->varsVec->getValues(len, nodes, vars);
-      assembler->dvarsVec->getValues(len, nodes, dvars);
-      assembler->ddvarsVec->getValues(len, nodes, ddvars);
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    // The ranges are not visited in order, so locate the first
+    // auxiliary element within this range
+    aux_count = TacsFindFirstAuxElement(naux, aux,
+                                        (elemList ? elemList[start] : start));
 
-      // Generate the Jacobian of the element
-      element->addResidual(elemIndex, assembler->time, elemXpts, vars, dvars,
-                           ddvars, elemRes);
+    for (int k = start; k < end;) {
+      // Get the batch of elements that share an element object or kernel
+      int n = assembler->getElementBatch(elemList, k, end, elemIndices);
+      TACSElement *element = assembler->elements[elemIndices[0]];
+      int nvars = element->getNumVariables();
+      int nx = 3 * element->getNumNodes();
 
-      // Increment the aux counter until we possibly have
-      // aux[aux_count].num == elemIndex
-      while (aux_count < naux && aux[aux_count].num < elemIndex) {
-        aux_count++;
+      // Retrieve the variable values
+      double t0 = (assembler->elementTimes ? MPI_Wtime() : 0.0);
+      for (int j = 0; j < n; j++) {
+        int ptr = assembler->elementNodeIndex[elemIndices[j]];
+        int len = assembler->elementNodeIndex[elemIndices[j] + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        assembler->xptVec->getValues(len, nodes, &batchXpts[nx * j]);
+        assembler->varsVec->getValues(len, nodes, &batchVars[nvars * j]);
+        assembler->dvarsVec->getValues(len, nodes, &batchDVars[nvars * j]);
+        assembler->ddvarsVec->getValues(len, nodes, &batchDDVars[nvars * j]);
+      }
+      if (assembler->elementTimes) {
+        double t1 = MPI_Wtime();
+        assembler->addElementTime(ELEMENT_GET_VALUES_TIME, n, elemIndices,
+                                  t1 - t0);
+        t0 = t1;
       }
 
-      // Add the residual from any auxiliary elements, if the load factor is 1
-      // they can be added straight to the elemRes, otherwise they need to be
-      // scaled first
-      if (!scaleAux) {
-        while (aux_count < naux && aux[aux_count].num == elemIndex) {
-          aux[aux_count].elem->addResidual(elemIndex, assembler->time, elemXpts,
-                                           vars, dvars, ddvars, elemRes);
+      // Generate the residuals of the elements in the batch
+      memset(batchRes, 0, n * nvars * sizeof(TacsScalar));
+      assembler->addElementResidualBatch(element, n, elemIndices, batchXpts,
+                                         batchVars, batchDVars, batchDDVars,
+                                         batchRes);
+      if (assembler->elementTimes) {
+        assembler->addElementTime(ELEMENT_RESIDUAL_TIME, n, elemIndices,
+                                  MPI_Wtime() - t0);
+      }
+
+      for (int j = 0; j < n; j++, k++) {
+        int elemIndex = elemIndices[j];
+        int ptr = assembler->elementNodeIndex[elemIndex];
+        int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        const TacsScalar *elemXpts = &batchXpts[nx * j];
+        const TacsScalar *vars = &batchVars[nvars * j];
+        const TacsScalar *dvars = &batchDVars[nvars * j];
+        const TacsScalar *ddvars = &batchDDVars[nvars * j];
+        TacsScalar *elemRes = &batchRes[nvars * j];
+
+        // Increment the aux counter until we possibly have
+        // aux[aux_count].num == elemIndex
+        if (searchAux) {
+          aux_count = TacsFindFirstAuxElement(naux, aux, elemIndex);
+        }
+        while (aux_count < naux && aux[aux_count].num < elemIndex) {
           aux_count++;
         }
-      } else {
-        memset(auxElemRes, 0, s * sizeof(TacsScalar));
+
+        // Add the residual from any auxiliary elements and body loads, if the
+        // load factor is 1 they can be added straight to the elemRes,
+        // otherwise they need to be scaled first
+        TacsScalar *loadRes = (scaleAux ? auxElemRes : elemRes);
+        if (scaleAux) {
+          memset(auxElemRes, 0, s * sizeof(TacsScalar));
+        }
         while (aux_count < naux && aux[aux_count].num == elemIndex) {
-          aux[aux_count].elem->addResidual(elemIndex, assembler->time, elemXpts,
-                                           vars, dvars, ddvars, auxElemRes);
+          aux[aux_count].elem->addResidual(elemIndex, assembler->time,
+                                           elemXpts, vars, dvars, ddvars,
+                                           loadRes);
           aux_count++;
         }
-        for (int jj = 0; jj < s; jj++) {
-          elemRes[jj] += lambda * auxElemRes[jj];
+
+        // Add the body loads
+        TACSElement *loads[2];
+        int nloads = assembler->getBodyLoads(elemIndex, loads);
+        for (int l = 0; l < nloads; l++) {
+          loads[l]->addResidual(elemIndex, assembler->time, elemXpts, vars,
+                                dvars, ddvars, loadRes);
+        }
+
+        if (scaleAux) {
+          for (int jj = 0; jj < nvars; jj++) {
+            elemRes[jj] += lambda * auxElemRes[jj];
+          }
         }
-      }
 
-      // Add the values to the residual when the memory unlocks
-      pthread_mutex_lock(&assembler->tacs_mutex);
-      res->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
-      pthread_mutex_unlock(&assembler->tacs_mutex);
+        // Add the values to the residual when the memory unlocks
+        if (!elemList) {
+          pthread_mutex_lock(&assembler->tacs_mutex);
+        }
+        res->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+        if (!elemList) {
+          pthread_mutex_unlock(&assembler->tacs_mutex);
+        }
+      }
     }
   }
-  if (scaleAux) {
-    delete[] auxElemRes;
-  }
-  delete[] data;
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -165,24 +213,28 @@ void *TACSAssembler::assembleJacobian_thread(void *t) {
   TacsScalar gamma = pinfo->gamma;
   TacsScalar lambda = pinfo->lambda;
   MatrixOrientation matOr = pinfo->matOr;
+  int assemblyBCs = assembler->isAssemblyBCsActive();
 
-  // Allocate a temporary array large enough to store everything
-  // required
+  // Take a temporary array large enough to store everything required
+  // for a batch of elements from the scratch arena of this thread
   int s = assembler->maxElementSize;
   int sx = 3 * assembler->maxElementNodes;
   int sw = assembler->maxElementIndepNodes;
-  int dataSize = 4 * s + sx + s * s + sw;
-  TacsScalar *data = new TacsScalar[dataSize];
-  int *idata = new int[sw + assembler->maxElementNodes + 1];
+  int nb = assembler->elementBatchSize;
+  int dataSize = nb * (4 * s + sx + s * s) + sw;
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+  int *idata = scratch.allocInts(sw + assembler->maxElementNodes + 1);
+  int *elemIndices = scratch.allocInts(nb);
 
   // Set pointers to the allocate memory
-  TacsScalar *vars = &data[0];
-  TacsScalar *dvars = &data[s];
-  TacsScalar *ddvars = &data[2 * s];
-  TacsScalar *elemRes = &data[3 * s];
-  TacsScalar *elemXpts = &data[4 * s];
-  TacsScalar *elemWeights = &data[4 * s + sx];
-  TacsScalar *elemMat = &data[4 * s + sx + sw];
+  TacsScalar *batchVars = &data[0];
+  TacsScalar *batchDVars = &data[nb * s];
+  TacsScalar *batchDDVars = &data[2 * nb * s];
+  TacsScalar *batchRes = &data[3 * nb * s];
+  TacsScalar *batchXpts = &data[4 * nb * s];
+  TacsScalar *batchMat = &data[nb * (4 * s + sx)];
+  TacsScalar *elemWeights = &data[nb * (4 * s + sx + s * s)];
 
   // Set the data for the auxiliary elements - if there are any
   int naux = 0, aux_count = 0;
@@ -191,63 +243,132 @@ void *TACSAssembler::assembleJacobian_thread(void *t) {
     naux = assembler->auxElements->getAuxElements(&aux);
   }
 
-  while (assembler->numCompletedElements < assembler->numElements) {
-    int elemIndex = -1;
-    TACSAssembler::schedPthreadJob(assembler, &elemIndex,
-                                   assembler->numElements);
+  // Get the index of this thread within the element schedule. When
+  // coloring is used, only the elements of the current color are
+  // visited and no lock is required to add their contributions.
+  TACSThreadSchedule *sched = assembler->elemSchedule;
+  const int *elemList = assembler->elementOrder;
+  if (pinfo->color >= 0) {
+    sched = assembler->colorSchedules[pinfo->color];
+    int offset = assembler->elementColorPtr[pinfo->color];
+    elemList = &assembler->elementColors[offset];
+  }
+  int thread = sched->getThreadIndex();
 
-    if (elemIndex >= 0) {
-      // Get the element object
-      TACSElement *element = assembler->elements[elemIndex];
+  // The elements are not visited in increasing order when the element
+  // order is set, so the auxiliary elements are located by a search
+  int searchAux = (pinfo->color < 0 && elemList);
 
-      // Retrieve the variable values
-      int ptr = assembler->elementNodeIndex[elemIndex];
-      int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
-      const int *nodes = &assembler->elementTacsNodes[ptr];
-      assembler->xptVec->getValues(len, nodes, elemXpts);
-      assembler->varsVec->getValues(len, nodes, vars);
-      assembler->dvarsVec->getValues(len, nodes, dvars);
-      assembler->ddvarsVec->getValues(len, nodes, ddvars);
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    // The ranges are not visited in order, so locate the first
+    // auxiliary element within this range
+    aux_count = TacsFindFirstAuxElement(naux, aux,
+                                        (elemList ? elemList[start] : start));
 
-      // Retrieve the number of element variables
+    for (int k = start; k < end;) {
+      // Get the batch of elements that share an element object or kernel
+      int n = assembler->getElementBatch(elemList, k, end, elemIndices);
+      TACSElement *element = assembler->elements[elemIndices[0]];
       int nvars = element->getNumVariables();
-      memset(elemRes, 0, nvars * sizeof(TacsScalar));
-      memset(elemMat, 0, nvars * nvars * sizeof(TacsScalar));
-
-      // Generate the Jacobian of the element
-      element->addJacobian(elemIndex, assembler->time, alpha, beta, gamma,
-                           elemXpts, vars, dvars, ddvars, elemRes, elemMat);
+      int nx = 3 * element->getNumNodes();
 
-      // Increment the aux counter until we possibly have
-      // aux[aux_count].num == elemIndex
-      while (aux_count < naux && aux[aux_count].num < elemIndex) {
-        aux_count++;
+      // Retrieve the variable values
+      double t0 = (assembler->elementTimes ? MPI_Wtime() : 0.0);
+      for (int j = 0; j < n; j++) {
+        int ptr = assembler->elementNodeIndex[elemIndices[j]];
+        int len = assembler->elementNodeIndex[elemIndices[j] + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        assembler->xptVec->getValues(len, nodes, &batchXpts[nx * j]);
+        assembler->varsVec->getValues(len, nodes, &batchVars[nvars * j]);
+        assembler->dvarsVec->getValues(len, nodes, &batchDVars[nvars * j]);
+        assembler->ddvarsVec->getValues(len, nodes, &batchDDVars[nvars * j]);
       }
-
-      // Add the residual from the auxiliary elements
-      while (aux_count < naux && aux[aux_count].num == elemIndex) {
-        aux[aux_count].elem->addJacobian(
-            elemIndex, assembler->time, alpha * lambda, beta * lambda,
-            gamma * lambda, elemXpts, vars, dvars, ddvars, elemRes, elemMat);
-        aux_count++;
+      if (assembler->elementTimes) {
+        double t1 = MPI_Wtime();
+        assembler->addElementTime(ELEMENT_GET_VALUES_TIME, n, elemIndices,
+                                  t1 - t0);
+        t0 = t1;
       }
 
-      pthread_mutex_lock(&assembler->tacs_mutex);
-      // Add values to the residual
-      if (res) {
-        res->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+      // Generate the Jacobians of the elements in the batch
+      memset(batchRes, 0, n * nvars * sizeof(TacsScalar));
+      memset(batchMat, 0, n * nvars * nvars * sizeof(TacsScalar));
+      assembler->addElementJacobianBatch(element, n, elemIndices, alpha, beta,
+                                         gamma, batchXpts, batchVars,
+                                         batchDVars, batchDDVars, batchRes,
+                                         batchMat);
+      if (assembler->elementTimes) {
+        assembler->addElementTime(ELEMENT_JACOBIAN_TIME, n, elemIndices,
+                                  MPI_Wtime() - t0);
       }
 
-      // Add values to the matrix
-      assembler->addMatValues(A, elemIndex, elemMat, idata, elemWeights, matOr);
-      pthread_mutex_unlock(&assembler->tacs_mutex);
+      for (int j = 0; j < n; j++, k++) {
+        int elemIndex = elemIndices[j];
+        int ptr = assembler->elementNodeIndex[elemIndex];
+        int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        const TacsScalar *elemXpts = &batchXpts[nx * j];
+        const TacsScalar *vars = &batchVars[nvars * j];
+        const TacsScalar *dvars = &batchDVars[nvars * j];
+        const TacsScalar *ddvars = &batchDDVars[nvars * j];
+        TacsScalar *elemRes = &batchRes[nvars * j];
+        TacsScalar *elemMat = &batchMat[nvars * nvars * j];
+
+        // Increment the aux counter until we possibly have
+        // aux[aux_count].num == elemIndex
+        if (searchAux) {
+          aux_count = TacsFindFirstAuxElement(naux, aux, elemIndex);
+        }
+        while (aux_count < naux && aux[aux_count].num < elemIndex) {
+          aux_count++;
+        }
+
+        // Add the residual from the auxiliary elements
+        int aux_start = aux_count;
+        while (aux_count < naux && aux[aux_count].num == elemIndex) {
+          aux[aux_count].elem->addJacobian(
+              elemIndex, assembler->time, alpha * lambda, beta * lambda,
+              gamma * lambda, elemXpts, vars, dvars, ddvars, elemRes, elemMat);
+          aux_count++;
+        }
+        TACSElement *loads[2];
+        int nloads = assembler->getBodyLoads(elemIndex, loads);
+        for (int l = 0; l < nloads; l++) {
+          loads[l]->addJacobian(elemIndex, assembler->time, alpha * lambda,
+                                beta * lambda, gamma * lambda, elemXpts, vars,
+                                dvars, ddvars, elemRes, elemMat);
+        }
+
+        // Zero the constrained rows before the matrix is added
+        if (assemblyBCs) {
+          assembler->applyElementMatBCs(elemIndex, elemMat, matOr);
+        }
+
+        if (!elemList) {
+          pthread_mutex_lock(&assembler->tacs_mutex);
+        }
+        // Add values to the residual
+        if (res) {
+          res->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+        }
+
+        // Add values to the matrix
+        double t1 = (assembler->elementTimes ? MPI_Wtime() : 0.0);
+        assembler->addMatValues(A, elemIndex, elemMat, idata, elemWeights,
+                                matOr, aux_count > aux_start || nloads > 0);
+        if (assembler->elementTimes) {
+          assembler->addElementTime(ELEMENT_MAT_VALUES_TIME, 1, &elemIndex,
+                                    MPI_Wtime() - t1);
+        }
+        if (!elemList) {
+          pthread_mutex_unlock(&assembler->tacs_mutex);
+        }
+      }
     }
   }
 
-  delete[] data;
-  delete[] idata;
-
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -271,13 +392,14 @@ void *TACSAssembler::assembleMatType_thread(void *t) {
   MatrixOrientation matOr = pinfo->matOr;
   TacsScalar lambda = pinfo->lambda;
 
-  // Allocate a temporary array large enough to store everything required
+  // Take a temporary array large enough to store everything required
   int s = assembler->maxElementSize;
   int sx = 3 * assembler->maxElementNodes;
   int sw = assembler->maxElementIndepNodes;
   int dataSize = s + sx + s * s + sw;
-  TacsScalar *data = new TacsScalar[dataSize];
-  int *idata = new int[sw + assembler->maxElementNodes + 1];
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+  int *idata = scratch.allocInts(sw + assembler->maxElementNodes + 1);
 
   TacsScalar *vars = &data[0];
   TacsScalar *elemXpts = &data[s];
@@ -290,18 +412,33 @@ void *TACSAssembler::assembleMatType_thread(void *t) {
   if (assembler->auxElements) {
     naux = assembler->auxElements->getAuxElements(&aux);
   }
-  TacsScalar *auxElemMat;
+  TacsScalar *auxElemMat = NULL;
   bool scaleAux = lambda != TacsScalar(1.0) && naux > 0;
   if (scaleAux) {
-    auxElemMat = new TacsScalar[s * s];
+    auxElemMat = scratch.allocScalars(s * s);
+  }
+
+  // Get the index of this thread within the element schedule. When
+  // coloring is used, only the elements of the current color are
+  // visited and no lock is required to add their contributions.
+  TACSThreadSchedule *sched = assembler->elemSchedule;
+  const int *elemList = NULL;
+  if (pinfo->color >= 0) {
+    sched = assembler->colorSchedules[pinfo->color];
+    int offset = assembler->elementColorPtr[pinfo->color];
+    elemList = &assembler->elementColors[offset];
   }
+  int thread = sched->getThreadIndex();
 
-  while (assembler->numCompletedElements < assembler->numElements) {
-    int elemIndex = -1;
-    TACSAssembler::schedPthreadJob(assembler, &elemIndex,
-                                   assembler->numElements);
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    // The ranges are not visited in order, so locate the first
+    // auxiliary element within this range
+    aux_count = TacsFindFirstAuxElement(naux, aux,
+                                        (elemList ? elemList[start] : start));
 
-    if (elemIndex >= 0) {
+    for (int k = start; k < end; k++) {
+      int elemIndex = (elemList ? elemList[k] : k);
       // Get the element
       TACSElement *element = assembler->elements[elemIndex];
 
@@ -310,12 +447,23 @@ void *TACSAssembler::assembleMatType_thread(void *t) {
       int ptr = assembler->elementNodeIndex[elemIndex];
       int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
       const int *nodes = &assembler->elementTacsNodes[ptr];
+      double t0 = (assembler->elementTimes ? MPI_Wtime() : 0.0);
       assembler->xptVec->getValues(len, nodes, elemXpts);
       assembler->varsVec->getValues(len, nodes, vars);
+      if (assembler->elementTimes) {
+        double t1 = MPI_Wtime();
+        assembler->addElementTime(ELEMENT_GET_VALUES_TIME, 1, &elemIndex,
+                                  t1 - t0);
+        t0 = t1;
+      }
 
       // Retrieve the type of the matrix
       element->getMatType(matType, elemIndex, assembler->time, elemXpts, vars,
                           elemMat);
+      if (assembler->elementTimes) {
+        assembler->addElementTime(ELEMENT_JACOBIAN_TIME, 1, &elemIndex,
+                                  MPI_Wtime() - t0);
+      }
 
       // Increment the aux counter until we possibly have
       // aux[aux_count].num == elemIndex
@@ -326,6 +474,7 @@ void *TACSAssembler::assembleMatType_thread(void *t) {
       // Add the contribution from any auxiliary elements, if the load factor is
       // 1 they can be added straight to the elemRes, otherwise they need to be
       // scaled first
+      int aux_start = aux_count;
       if (!scaleAux) {
         while (aux_count < naux && aux[aux_count].num == elemIndex) {
           aux[aux_count].elem->getMatType(matType, elemIndex, assembler->time,
@@ -344,16 +493,619 @@ void *TACSAssembler::assembleMatType_thread(void *t) {
         }
       }
 
-      pthread_mutex_lock(&assembler->tacs_mutex);
+      if (!elemList) {
+        pthread_mutex_lock(&assembler->tacs_mutex);
+      }
       // Add values to the matrix
-      assembler->addMatValues(A, elemIndex, elemMat, idata, elemWeights, matOr);
-      pthread_mutex_unlock(&assembler->tacs_mutex);
+      double t1 = (assembler->elementTimes ? MPI_Wtime() : 0.0);
+      assembler->addMatValues(A, elemIndex, elemMat, idata, elemWeights, matOr,
+                              aux_count > aux_start);
+      if (assembler->elementTimes) {
+        assembler->addElementTime(ELEMENT_MAT_VALUES_TIME, 1, &elemIndex,
+                                  MPI_Wtime() - t1);
+      }
+      if (!elemList) {
+        pthread_mutex_unlock(&assembler->tacs_mutex);
+      }
     }
   }
-  if (scaleAux) {
-    delete[] auxElemMat;
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the function integration
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  function:      the function to integrate
+  ftype:         the type of evaluation
+  coef:          the integration coefficient
+  sched:         the schedule for the elements in the function domain
+  elemNums:      the element numbers in the domain (NULL for all elements)
+  threadValues:  the function values accumulated on each thread (output)
+*/
+void *TACSAssembler::integrateFunctions_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  TACSFunction *func = pinfo->function;
+  TACSFunction::EvaluationType ftype = pinfo->ftype;
+  TacsScalar tcoef = pinfo->coef;
+  const int *elemNums = pinfo->elemNums;
+
+  // Take a temporary array large enough to store everything required
+  int s = assembler->maxElementSize;
+  int sx = 3 * assembler->maxElementNodes;
+  int dataSize = 3 * s + sx;
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+
+  // Set pointers to the allocate memory
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2 * s];
+  TacsScalar *elemXpts = &data[3 * s];
+
+  // Get the index of this thread and the values it accumulates
+  TACSThreadSchedule *sched = pinfo->sched;
+  int thread = sched->getThreadIndex();
+  int nvals = func->getNumThreadValues(ftype);
+  TacsScalar *vals = &pinfo->threadValues[nvals * thread];
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    for (int k = start; k < end; k++) {
+      int elemIndex = (elemNums ? elemNums[k] : k);
+
+      if (elemIndex >= 0 && elemIndex < assembler->numElements) {
+        // Determine the values of the state variables for the
+        // current element
+        int ptr = assembler->elementNodeIndex[elemIndex];
+        int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        assembler->xptVec->getValues(len, nodes, elemXpts);
+        assembler->varsVec->getValues(len, nodes, vars);
+        assembler->dvarsVec->getValues(len, nodes, dvars);
+        assembler->ddvarsVec->getValues(len, nodes, ddvars);
+
+        // Evaluate the element-wise component of the function
+        func->elementWiseEvalThread(ftype, elemIndex,
+                                    assembler->elements[elemIndex],
+                                    assembler->time, tcoef, elemXpts, vars,
+                                    dvars, ddvars, vals);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the function design variable
+  sensitivity
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  function:    the function to differentiate
+  coef:        the coefficient applied to the derivative
+  sched:       the schedule for the elements in the function domain
+  elemNums:    the element numbers in the domain (NULL for all elements)
+  threadVecs:  the derivative vector for each thread (output)
+*/
+void *TACSAssembler::addDVSens_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  TACSFunction *func = pinfo->function;
+  TacsScalar coef = pinfo->coef;
+  const int *elemNums = pinfo->elemNums;
+
+  // Take a temporary array large enough to store everything required
+  int s = assembler->maxElementSize;
+  int sx = 3 * assembler->maxElementNodes;
+  const int maxDVs = assembler->maxElementDesignVars;
+  int sdv = maxDVs * assembler->designVarsPerNode;
+  int dataSize = 3 * s + sx + sdv;
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+  int *dvNums = scratch.allocInts(maxDVs);
+
+  // Set pointers to the allocate memory
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2 * s];
+  TacsScalar *elemXpts = &data[3 * s];
+  TacsScalar *fdvSens = &data[3 * s + sx];
+
+  // Get the index of this thread and the vector it accumulates
+  TACSThreadSchedule *sched = pinfo->sched;
+  int thread = sched->getThreadIndex();
+  TACSBVec *dfdx = pinfo->threadVecs[thread];
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    for (int k = start; k < end; k++) {
+      int elemIndex = (elemNums ? elemNums[k] : k);
+
+      if (elemIndex >= 0 && elemIndex < assembler->numElements) {
+        // Determine the values of the state variables for elemIndex
+        TACSElement *element = assembler->elements[elemIndex];
+        int ptr = assembler->elementNodeIndex[elemIndex];
+        int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        assembler->xptVec->getValues(len, nodes, elemXpts);
+        assembler->varsVec->getValues(len, nodes, vars);
+        assembler->dvarsVec->getValues(len, nodes, dvars);
+        assembler->ddvarsVec->getValues(len, nodes, ddvars);
+
+        // Get the design variables for this element
+        int numDVs = element->getDesignVarNums(elemIndex, maxDVs, dvNums);
+
+        // Evaluate the element-wise sensitivity of the function
+        memset(fdvSens, 0,
+               numDVs * assembler->designVarsPerNode * sizeof(TacsScalar));
+        func->addElementDVSens(elemIndex, element, assembler->time, coef,
+                               elemXpts, vars, dvars, ddvars, maxDVs, fdvSens);
+
+        // Add the derivative values
+        dfdx->setValues(numDVs, dvNums, fdvSens, TACS_ADD_VALUES);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the function state variable
+  sensitivity
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  function:    the function to differentiate
+  alpha:       the coefficient for the variables
+  beta:        the coefficient for the first time derivative
+  gamma:       the coefficient for the second time derivative
+  sched:       the schedule for the elements in the function domain
+  elemNums:    the element numbers in the domain (NULL for all elements)
+  threadVecs:  the derivative vector for each thread (output)
+*/
+void *TACSAssembler::addSVSens_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  TACSFunction *func = pinfo->function;
+  TacsScalar alpha = pinfo->alpha;
+  TacsScalar beta = pinfo->beta;
+  TacsScalar gamma = pinfo->gamma;
+  const int *elemNums = pinfo->elemNums;
+
+  // Take a temporary array large enough to store everything required
+  int s = assembler->maxElementSize;
+  int sx = 3 * assembler->maxElementNodes;
+  int dataSize = 4 * s + sx;
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+
+  // Set pointers to the allocate memory
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2 * s];
+  TacsScalar *elemRes = &data[3 * s];
+  TacsScalar *elemXpts = &data[4 * s];
+
+  // Get the index of this thread and the vector it accumulates
+  TACSThreadSchedule *sched = pinfo->sched;
+  int thread = sched->getThreadIndex();
+  TACSBVec *dfdu = pinfo->threadVecs[thread];
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    for (int k = start; k < end; k++) {
+      int elemIndex = (elemNums ? elemNums[k] : k);
+
+      if (elemIndex >= 0 && elemIndex < assembler->numElements) {
+        // Determine the values of the state variables for the
+        // current element
+        int ptr = assembler->elementNodeIndex[elemIndex];
+        int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        assembler->xptVec->getValues(len, nodes, elemXpts);
+        assembler->varsVec->getValues(len, nodes, vars);
+        assembler->dvarsVec->getValues(len, nodes, dvars);
+        assembler->ddvarsVec->getValues(len, nodes, ddvars);
+
+        // Evaluate the element-wise sensitivity of the function
+        func->getElementSVSens(elemIndex, assembler->elements[elemIndex],
+                               assembler->time, alpha, beta, gamma, elemXpts,
+                               vars, dvars, ddvars, elemRes);
+        dfdu->setValues(len, nodes, elemRes, TACS_ADD_VALUES);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the function node sensitivity
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  function:    the function to differentiate
+  coef:        the coefficient applied to the derivative
+  sched:       the schedule for the elements in the function domain
+  elemNums:    the element numbers in the domain (NULL for all elements)
+  threadVecs:  the derivative vector for each thread (output)
+*/
+void *TACSAssembler::addXptSens_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  TACSFunction *func = pinfo->function;
+  TacsScalar coef = pinfo->coef;
+  const int *elemNums = pinfo->elemNums;
+
+  // Take a temporary array large enough to store everything required
+  int s = assembler->maxElementSize;
+  int sx = 3 * assembler->maxElementNodes;
+  int dataSize = 3 * s + 2 * sx;
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+
+  // Set pointers to the allocate memory
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2 * s];
+  TacsScalar *elemXpts = &data[3 * s];
+  TacsScalar *elemXptSens = &data[3 * s + sx];
+
+  // Get the index of this thread and the vector it accumulates
+  TACSThreadSchedule *sched = pinfo->sched;
+  int thread = sched->getThreadIndex();
+  TACSBVec *dfdXpt = pinfo->threadVecs[thread];
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    for (int k = start; k < end; k++) {
+      int elemIndex = (elemNums ? elemNums[k] : k);
+
+      if (elemIndex >= 0 && elemIndex < assembler->numElements &&
+          assembler->isXptSensElement(elemIndex)) {
+        // Determine the values of the state variables for elemIndex
+        int ptr = assembler->elementNodeIndex[elemIndex];
+        int len = assembler->elementNodeIndex[elemIndex + 1] - ptr;
+        const int *nodes = &assembler->elementTacsNodes[ptr];
+        assembler->xptVec->getValues(len, nodes, elemXpts);
+        assembler->varsVec->getValues(len, nodes, vars);
+        assembler->dvarsVec->getValues(len, nodes, dvars);
+        assembler->ddvarsVec->getValues(len, nodes, ddvars);
+
+        // Evaluate the element-wise sensitivity of the function
+        func->getElementXptSens(elemIndex, assembler->elements[elemIndex],
+                                assembler->time, coef, elemXpts, vars, dvars,
+                                ddvars, elemXptSens);
+        assembler->maskXptSens(len, nodes, elemXptSens);
+        dfdXpt->setValues(len, nodes, elemXptSens, TACS_ADD_VALUES);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the adjoint-residual product with
+  respect to the design variables
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  coef:         the scalar factor applied to the derivative
+  lambda:       the scaling factor for the auxiliary elements
+  numAdjoints:  the number of adjoint vectors
+  adjoints:     the adjoint vectors
+  threadVecs:   the derivative vectors for each thread (output)
+*/
+void *TACSAssembler::addAdjointResProducts_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  TacsScalar scale = pinfo->coef;
+  TacsScalar lambda = pinfo->lambda;
+  int numAdjoints = pinfo->numAdjoints;
+  TACSBVec **adjoint = pinfo->adjoints;
+
+  // Take a temporary array large enough to store everything
+  // required, including the element adjoints and derivatives for all
+  // the adjoint vectors
+  int s = assembler->maxElementSize;
+  int sx = 3 * assembler->maxElementNodes;
+  const int maxDVs = assembler->maxElementDesignVars;
+  int sdv = maxDVs * assembler->designVarsPerNode;
+  int dataSize = 3 * s + sx + numAdjoints * (s + sdv);
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+  int *dvNums = scratch.allocInts(maxDVs);
+
+  // Set pointers to the allocate memory
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2 * s];
+  TacsScalar *elemXpts = &data[3 * s];
+  TacsScalar *elemAdjoints = &data[3 * s + sx];
+  TacsScalar *fdvSens = &data[3 * s + sx + numAdjoints * s];
+
+  // Set the data for the auxiliary elements - if there are any
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (assembler->auxElements) {
+    naux = assembler->auxElements->getAuxElements(&aux);
+  }
+
+  // Get the index of this thread and the vectors it accumulates
+  TACSThreadSchedule *sched = assembler->elemSchedule;
+  int thread = sched->getThreadIndex();
+  TACSBVec **dfdx = &pinfo->threadVecs[numAdjoints * thread];
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    // The ranges are not visited in order, so locate the first
+    // auxiliary element within this range
+    aux_count = TacsFindFirstAuxElement(naux, aux, start);
+
+    for (int i = start; i < end; i++) {
+      // Find the variables and nodes
+      TACSElement *element = assembler->elements[i];
+      int ptr = assembler->elementNodeIndex[i];
+      int len = assembler->elementNodeIndex[i + 1] - ptr;
+      const int *nodes = &assembler->elementTacsNodes[ptr];
+      int nvars = assembler->varsPerNode * len;
+      assembler->xptVec->getValues(len, nodes, elemXpts);
+      assembler->varsVec->getValues(len, nodes, vars);
+      assembler->dvarsVec->getValues(len, nodes, dvars);
+      assembler->ddvarsVec->getValues(len, nodes, ddvars);
+
+      // Get the element adjoint vectors
+      for (int k = 0; k < numAdjoints; k++) {
+        adjoint[k]->getValues(len, nodes, &elemAdjoints[nvars * k]);
+      }
+
+      // Get the design variables for this element
+      int numDVs = element->getDesignVarNums(i, maxDVs, dvNums);
+      int size = numDVs * assembler->designVarsPerNode;
+
+      // Add the adjoint-residual products
+      memset(fdvSens, 0, numAdjoints * size * sizeof(TacsScalar));
+      element->addAdjResProductMulti(i, assembler->time, scale, numAdjoints,
+                                     elemAdjoints, elemXpts, vars, dvars,
+                                     ddvars, numDVs, fdvSens);
+      for (int k = 0; k < numAdjoints; k++) {
+        dfdx[k]->setValues(numDVs, dvNums, &fdvSens[size * k],
+                           TACS_ADD_VALUES);
+      }
+
+      // Add the contribution from the auxiliary elements, scaled by lambda
+      while (aux_count < naux && aux[aux_count].num == i) {
+        // Get the design variables for this element
+        numDVs = aux[aux_count].elem->getDesignVarNums(i, maxDVs, dvNums);
+        size = numDVs * assembler->designVarsPerNode;
+
+        memset(fdvSens, 0, numAdjoints * size * sizeof(TacsScalar));
+        aux[aux_count].elem->addAdjResProductMulti(
+            i, assembler->time, lambda * scale, numAdjoints, elemAdjoints,
+            elemXpts, vars, dvars, ddvars, numDVs, fdvSens);
+        for (int k = 0; k < numAdjoints; k++) {
+          dfdx[k]->setValues(numDVs, dvNums, &fdvSens[size * k],
+                             TACS_ADD_VALUES);
+        }
+        aux_count++;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the adjoint-residual product with
+  respect to the node locations
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  coef:         the scalar factor applied to the derivative
+  lambda:       the scaling factor for the auxiliary elements
+  numAdjoints:  the number of adjoint vectors
+  adjoints:     the adjoint vectors
+  threadVecs:   the derivative vectors for each thread (output)
+*/
+void *TACSAssembler::addAdjointResXptSensProducts_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  TacsScalar scale = pinfo->coef;
+  TacsScalar lambda = pinfo->lambda;
+  int numAdjoints = pinfo->numAdjoints;
+  TACSBVec **adjoint = pinfo->adjoints;
+
+  // Take a temporary array large enough to store everything
+  // required, including the element adjoints and derivatives for all
+  // the adjoint vectors
+  int s = assembler->maxElementSize;
+  int sx = 3 * assembler->maxElementNodes;
+  int dataSize = 3 * s + sx + numAdjoints * (s + sx);
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(dataSize);
+
+  // Set pointers to the allocate memory
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2 * s];
+  TacsScalar *elemXpts = &data[3 * s];
+  TacsScalar *elemAdjoints = &data[3 * s + sx];
+  TacsScalar *xptSens = &data[3 * s + sx + numAdjoints * s];
+
+  // Set the data for the auxiliary elements - if there are any
+  int naux = 0, aux_count = 0;
+  TACSAuxElem *aux = NULL;
+  if (assembler->auxElements) {
+    naux = assembler->auxElements->getAuxElements(&aux);
+  }
+
+  // Get the index of this thread and the vectors it accumulates
+  TACSThreadSchedule *sched = assembler->elemSchedule;
+  int thread = sched->getThreadIndex();
+  TACSBVec **dfdXpt = &pinfo->threadVecs[numAdjoints * thread];
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    // The ranges are not visited in order, so locate the first
+    // auxiliary element within this range
+    aux_count = TacsFindFirstAuxElement(naux, aux, start);
+
+    for (int i = start; i < end; i++) {
+      // Skip the elements that do not touch the node subset
+      if (!assembler->isXptSensElement(i)) {
+        while (aux_count < naux && aux[aux_count].num == i) {
+          aux_count++;
+        }
+        continue;
+      }
+
+      // Find the variables and nodes
+      TACSElement *element = assembler->elements[i];
+      int ptr = assembler->elementNodeIndex[i];
+      int len = assembler->elementNodeIndex[i + 1] - ptr;
+      const int *nodes = &assembler->elementTacsNodes[ptr];
+      int nvars = assembler->varsPerNode * len;
+      int size = TACS_SPATIAL_DIM * len;
+      assembler->xptVec->getValues(len, nodes, elemXpts);
+      assembler->varsVec->getValues(len, nodes, vars);
+      assembler->dvarsVec->getValues(len, nodes, dvars);
+      assembler->ddvarsVec->getValues(len, nodes, ddvars);
+
+      // Get the element adjoint vectors
+      for (int k = 0; k < numAdjoints; k++) {
+        adjoint[k]->getValues(len, nodes, &elemAdjoints[nvars * k]);
+      }
+
+      // Add the adjoint-residual products
+      memset(xptSens, 0, numAdjoints * size * sizeof(TacsScalar));
+      element->addAdjResXptProductMulti(i, assembler->time, scale, numAdjoints,
+                                        elemAdjoints, elemXpts, vars, dvars,
+                                        ddvars, xptSens);
+
+      // Add the contribution from the auxiliary elements, scaled by lambda
+      while (aux_count < naux && aux[aux_count].num == i) {
+        aux[aux_count].elem->addAdjResXptProductMulti(
+            i, assembler->time, lambda * scale, numAdjoints, elemAdjoints,
+            elemXpts, vars, dvars, ddvars, xptSens);
+        aux_count++;
+      }
+
+      for (int k = 0; k < numAdjoints; k++) {
+        assembler->maskXptSens(len, nodes, &xptSens[size * k]);
+        dfdXpt[k]->setValues(len, nodes, &xptSens[size * k], TACS_ADD_VALUES);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  The threaded-implementation of the element output data
+
+  This function uses the following data from the
+  TACSAssemblerPthreadInfo class:
+
+  sched:          the element schedule
+  outputType:     the element type for the output
+  outputFlag:     the output write flag
+  outputNumVals:  the number of values per output point
+  outputPtr:      the offset of each element into the output
+  outputData:     the output data (or NULL)
+  outputFData:    the single-precision output data (or NULL)
+
+  Each element writes to a distinct segment of the output, so no
+  lock is required.
+*/
+void *TACSAssembler::getElementOutputData_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  int nvals = pinfo->outputNumVals;
+
+  // Take the temporary storage from the scratch arena of this thread
+  int tempSize = 3 * assembler->maxElementSize +
+                 (3 + nvals) * assembler->maxElementNodes;
+  TACSScratchScope scratch;
+  TacsScalar *temp = scratch.allocScalars(tempSize);
+
+  TACSThreadSchedule *sched = pinfo->sched;
+  int thread = sched->getThreadIndex();
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    assembler->getElementOutputRange(start, end, pinfo->outputType,
+                                     pinfo->outputFlag, nvals,
+                                     pinfo->outputPtr, temp,
+                                     pinfo->outputData, pinfo->outputFData);
+  }
+
+  return NULL;
+}
+
+/*
+  The threaded implementation of the element tests
+
+  elemNums:   the sampled element numbers
+  sched:      the schedule over the sampled elements
+  testFail:   the failure flags for each sample and test
+  testTimes:  the time for each sample and test
+
+  Each sample writes its own results, so no lock is required.
+*/
+void *TACSAssembler::testElements_thread(void *t) {
+  TACSAssemblerPthreadInfo *pinfo = static_cast<TACSAssemblerPthreadInfo *>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *assembler = pinfo->assembler;
+  const int *elemNums = pinfo->elemNums;
+  const int ntests = NUM_ELEMENT_TESTS;
+
+  // Take the temporary storage from the scratch arena of this thread
+  int tempSize = 4 * assembler->maxElementSize +
+                 3 * assembler->maxElementNodes +
+                 assembler->maxElementDesignVars;
+  TACSScratchScope scratch;
+  TacsScalar *temp = scratch.allocScalars(tempSize);
+
+  TACSThreadSchedule *sched = pinfo->sched;
+  int thread = sched->getThreadIndex();
+
+  int start, end;
+  while (sched->getNextRange(thread, &start, &end)) {
+    for (int k = start; k < end; k++) {
+      assembler->runElementTests(
+          elemNums[k], temp, pinfo->testPrintLevel, pinfo->testDh,
+          pinfo->testRtol, pinfo->testAtol, &pinfo->testFail[ntests * k],
+          &pinfo->testTimes[ntests * k]);
+    }
   }
-  delete[] data;
 
-  pthread_exit(NULL);
+  return NULL;
 }
@@ -37,7 +37,10 @@ TACSAuxElements::TACSAuxElements(int _num_elems) {
   max_elements = (_num_elems < 100 ? 100 : _num_elems);
   aux = new TACSAuxElem[max_elements];
   num_elements = 0;
-  is_sorted = 0;
+  is_sorted = 1;
+  version = 0;
+  num_ptr_elements = -1;
+  elem_ptr = NULL;
 }
 
 /*
@@ -48,16 +51,55 @@ TACSAuxElements::~TACSAuxElements() {
     aux[i].elem->decref();
   }
   delete[] aux;
+  if (elem_ptr) {
+    delete[] elem_ptr;
+  }
 }
 
 /*
   Sort the list of auxiliary elements so that their numbers are listed
   in ascending order. This is required within the TACSAssembler object
   for efficient residual assembly operations.
+
+  Elements appended in ascending order keep the list sorted. Otherwise
+  the list is sorted with a stable counting sort when the range of
+  element numbers is comparable to the number of entries, which is the
+  usual case for loads on a subset of the elements, and with qsort
+  when it is not.
 */
 void TACSAuxElements::sort() {
-  if (!is_sorted) {
-    qsort(aux, num_elements, sizeof(TACSAuxElem), compare_elems);
+  if (!is_sorted && num_elements > 0) {
+    int min_num = aux[0].num, max_num = aux[0].num;
+    for (int i = 1; i < num_elements; i++) {
+      if (aux[i].num < min_num) {
+        min_num = aux[i].num;
+      }
+      if (aux[i].num > max_num) {
+        max_num = aux[i].num;
+      }
+    }
+
+    if (max_num - min_num < 4 * num_elements) {
+      int range = max_num - min_num + 1;
+      int *count = new int[range + 1];
+      memset(count, 0, (range + 1) * sizeof(int));
+      for (int i = 0; i < num_elements; i++) {
+        count[aux[i].num - min_num + 1]++;
+      }
+      for (int i = 0; i < range; i++) {
+        count[i + 1] += count[i];
+      }
+
+      TACSAuxElem *tmp = new TACSAuxElem[max_elements];
+      for (int i = 0; i < num_elements; i++) {
+        tmp[count[aux[i].num - min_num]++] = aux[i];
+      }
+      delete[] count;
+      delete[] aux;
+      aux = tmp;
+    } else {
+      qsort(aux, num_elements, sizeof(TACSAuxElem), compare_elems);
+    }
     is_sorted = 1;
   }
 }
@@ -86,14 +128,19 @@ void TACSAuxElements::addElement(int num, TACSElement *elem) {
     aux = tmp;
   }
 
+  // The list is only unsorted if the new element is out of order
+  if (num_elements > 0 && num < aux[num_elements - 1].num) {
+    is_sorted = 0;
+  }
+
   // Insert the new element into the list
   elem->incref();
   aux[num_elements].elem = elem;
   aux[num_elements].num = num;
   num_elements++;
 
-  // The list is not sorted anymore
-  is_sorted = 0;
+  num_ptr_elements = -1;
+  version++;
 }
 
 /*
@@ -122,14 +169,59 @@ void TACSAuxElements::addElements(int nums[], TACSElement **elem,
 
   // Insert the new element into the list
   for (int k = 0; k < num_elems; k++) {
+    if (num_elements > 0 && nums[k] < aux[num_elements - 1].num) {
+      is_sorted = 0;
+    }
     elem[k]->incref();
     aux[num_elements].elem = elem[k];
     aux[num_elements].num = nums[k];
     num_elements++;
   }
 
-  // The list is not sorted anymore
-  is_sorted = 0;
+  num_ptr_elements = -1;
+  version++;
+}
+
+/*
+  Add all the elements from another auxiliary element set
+
+  The element objects are shared with the source set, not copied, so
+  that a load case that differs from a common set of loads by a few
+  elements can be built without re-creating the common elements.
+  Since the elements are shared, changes to their design variables
+  affect both sets.
+
+  input:
+  src:   the auxiliary elements to add
+*/
+void TACSAuxElements::addAuxElements(TACSAuxElements *src) {
+  if (!src || src == this || src->num_elements == 0) {
+    return;
+  }
+
+  int n = src->num_elements;
+  if (num_elements + n >= max_elements) {
+    max_elements = 2 * max_elements + n;
+    TACSAuxElem *tmp = new TACSAuxElem[max_elements];
+    memcpy(tmp, aux, num_elements * sizeof(TACSAuxElem));
+    delete[] aux;
+    aux = tmp;
+  }
+
+  // The result is sorted if both lists are sorted and do not overlap
+  if (!src->is_sorted ||
+      (num_elements > 0 && src->aux[0].num < aux[num_elements - 1].num)) {
+    is_sorted = 0;
+  }
+
+  for (int k = 0; k < n; k++) {
+    src->aux[k].elem->incref();
+    aux[num_elements] = src->aux[k];
+    num_elements++;
+  }
+
+  num_ptr_elements = -1;
+  version++;
 }
 
 /*
@@ -140,6 +232,51 @@ int TACSAuxElements::getAuxElements(TACSAuxElem **_elems) {
   return num_elements;
 }
 
+/*
+  Get the offsets into the sorted list of auxiliary elements for each
+  element number
+
+  The auxiliary elements for element i are the entries ptr[i] up to
+  ptr[i+1] of the array returned by getAuxElements(). This gives
+  constant-time access to the auxiliary elements of any element
+  without a search. The offsets are sorted and computed only when
+  elements have been added since the last call.
+
+  input:
+  num_elems:  the number of elements in TACSAssembler
+
+  output:
+  ptr:        the offsets of length num_elems+1
+
+  returns:    the number of auxiliary elements
+*/
+int TACSAuxElements::getElementPtr(int num_elems, const int **_ptr) {
+  sort();
+  if (num_ptr_elements != num_elems) {
+    if (elem_ptr) {
+      delete[] elem_ptr;
+    }
+    num_ptr_elements = num_elems;
+    elem_ptr = new int[num_elems + 1];
+
+    // Skip any entries with element numbers out of range
+    int j = 0;
+    while (j < num_elements && aux[j].num < 0) {
+      j++;
+    }
+    for (int i = 0; i < num_elems; i++) {
+      elem_ptr[i] = j;
+      while (j < num_elements && aux[j].num == i) {
+        j++;
+      }
+    }
+    elem_ptr[num_elems] = j;
+  }
+
+  *_ptr = elem_ptr;
+  return num_elements;
+}
+
 /*
   Get the design variables from all auxiliary elements
 */
@@ -156,6 +293,7 @@ void TACSAuxElements::setDesignVars(int numDVs, const TacsScalar dvs[]) {
   for (int i = 0; i < num_elements; i++) {
     aux[i].elem->setDesignVars(i, numDVs, dvs);
   }
+  version++;
 }
 
 /*
@@ -40,6 +40,25 @@ class TACSAuxElem {
   int num;
 };
 
+/*
+  Find the index of the first auxiliary element with an element
+  number greater than or equal to elemIndex, given that the auxiliary
+  elements are sorted by element number
+*/
+inline int TacsFindFirstAuxElement(int naux, const TACSAuxElem *aux,
+                                   int elemIndex) {
+  int low = 0, high = naux;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (aux[mid].num < elemIndex) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
 /*
   The TACSAuxiliaryElements class
 
@@ -66,16 +85,28 @@ class TACSAuxElements : public TACSObject {
   // ------------------------------
   void addElements(int nums[], TACSElement **elem, int num_elems);
 
+  // Add all the elements from another set (sharing the elements)
+  // ------------------------------------------------------------
+  void addAuxElements(TACSAuxElements *src);
+
   // Get the elements and sort them (if they are not already)
   // --------------------------------------------------------
   int getAuxElements(TACSAuxElem **elems);
 
+  // Get the pointer into the sorted elements for each element number
+  // -----------------------------------------------------------------
+  int getElementPtr(int num_elems, const int **ptr);
+
   // Functions to control the design variables
   // -----------------------------------------
   void getDesignVars(int numDVs, TacsScalar dvs[]);
   void setDesignVars(int numDVs, const TacsScalar dvs[]);
   void getDesignVarRange(int numDVs, TacsScalar lb[], TacsScalar ub[]);
 
+  // Get the number of changes made to the elements or design variables
+  // -------------------------------------------------------------------
+  int getVersion() { return version; }
+
   // Print the name of the TACSObject
   // --------------------------------
   const char *TACSObjectName() { return auxName; }
@@ -91,9 +122,16 @@ class TACSAuxElements : public TACSObject {
   // Keep track of the number of added elements
   int num_elements;
 
+  // Counter incremented when elements or design variables are set
+  int version;
+
   // The auxiliary elements
   TACSAuxElem *aux;
 
+  // The offsets into the sorted list for each element number
+  int num_ptr_elements;
+  int *elem_ptr;
+
   // The auxiliary object name
   static const char *auxName;
 };
@@ -0,0 +1,195 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSBenchmark.h"
+
+#include "KSM.h"
+
+static const char *bench_names[] = {
+    "assembleRes", "assembleJacobian", "distribute", "mult",
+    "SchurPc::factor", "GMRES+SchurPc::solve", "writeToFile"};
+
+/*
+  The data for the standard kernels
+*/
+struct TacsBenchData {
+  TACSAssembler *assembler;
+  TACSBVec *x, *y;
+  TACSSchurMat *mat;
+  TACSPc *pc;
+  TACSKsm *ksm;
+  const char *filename;
+};
+
+static void TacsBenchAssembleRes(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->assembler->assembleRes(d->y);
+}
+
+static void TacsBenchAssembleJacobian(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->assembler->assembleJacobian(1.0, 0.0, 0.0, d->y, d->mat);
+}
+
+static void TacsBenchDistribute(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->x->beginDistributeValues();
+  d->x->endDistributeValues();
+}
+
+static void TacsBenchMult(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->mat->mult(d->x, d->y);
+}
+
+static void TacsBenchFactor(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->pc->factor();
+}
+
+static void TacsBenchSolve(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->ksm->solve(d->x, d->y);
+}
+
+static void TacsBenchWrite(void *data) {
+  TacsBenchData *d = (TacsBenchData *)data;
+  d->x->writeToFile(d->filename);
+}
+
+/*
+  Time a kernel
+
+  The kernel is called once to warm up and then nreps times. The
+  fastest time on this processor is returned, along with the average
+  number of flops per call recorded by the flop counter.
+
+  @param comm The communicator for the barrier before each call
+  @param nreps The number of timed calls
+  @param kernel The kernel to time
+  @param data The data passed to the kernel
+  @param flops The average number of flops per call (may be NULL)
+  @return The fastest time on this processor
+*/
+double TACSBenchmark::timeKernel(MPI_Comm comm, int nreps,
+                                 void (*kernel)(void *), void *data,
+                                 double *flops) {
+  double best = 1e20;
+  kernel(data);
+
+  TacsZeroNumFlops();
+  for (int rep = 0; rep < nreps; rep++) {
+    MPI_Barrier(comm);
+    double t0 = MPI_Wtime();
+    kernel(data);
+    double t = MPI_Wtime() - t0;
+    if (t < best) {
+      best = t;
+    }
+  }
+  if (flops) {
+    *flops = TacsGetNumFlops() / (nreps > 0 ? nreps : 1);
+  }
+
+  return best;
+}
+
+/*
+  Time the standard kernels for the assembler
+
+  The Jacobian is assembled into a Schur complement matrix that is
+  factored completely, so that the GMRES solve converges in a few
+  iterations and its time is dominated by the application of the
+  factorization.
+
+  @param assembler The initialized assembler
+  @param nreps The number of timed calls for each kernel
+  @param filename The file for the output kernel (may be NULL)
+  @param values The min/avg/max times and the flops for each kernel
+*/
+void TACSBenchmark::runKernels(TACSAssembler *assembler, int nreps,
+                               const char *filename, double values[]) {
+  MPI_Comm comm = assembler->getMPIComm();
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  int lev_fill = 1000;
+  double fill = 10.0;
+  int gmres_iters = 30;
+
+  TacsBenchData data;
+  data.assembler = assembler;
+  data.x = assembler->createVec();
+  data.x->incref();
+  data.y = assembler->createVec();
+  data.y->incref();
+  data.mat = assembler->createSchurMat();
+  data.mat->incref();
+  data.pc = new TACSSchurPc(data.mat, lev_fill, fill, 1);
+  data.pc->incref();
+  data.ksm = new GMRES(data.mat, data.pc, gmres_iters, 2, 0);
+  data.ksm->incref();
+  data.ksm->setTolerances(1e-10, 1e-30);
+  data.filename = filename;
+
+  // Set small non-zero values of the state variables so that the
+  // nonlinear elements are not evaluated at a special point
+  data.x->set(1e-4);
+  assembler->setBCs(data.x);
+  assembler->setVariables(data.x);
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, data.mat);
+
+  void (*kernels[])(void *) = {
+      TacsBenchAssembleRes, TacsBenchAssembleJacobian, TacsBenchDistribute,
+      TacsBenchMult,        TacsBenchFactor,           TacsBenchSolve,
+      TacsBenchWrite};
+
+  for (int k = 0; k < TACS_BENCH_NUM_KERNELS; k++) {
+    double *v = &values[4 * k];
+    v[0] = v[1] = v[2] = v[3] = 0.0;
+    if (k == TACS_BENCH_VEC_WRITE && !filename) {
+      continue;
+    }
+    if (k == TACS_BENCH_KSM_SOLVE) {
+      data.x->set(1.0);
+      assembler->applyBCs(data.x);
+    }
+
+    double flops;
+    double time = timeKernel(comm, nreps, kernels[k], &data, &flops);
+
+    double tsum;
+    MPI_Allreduce(&time, &v[0], 1, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(&time, &tsum, 1, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(&time, &v[2], 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(&flops, &v[3], 1, MPI_DOUBLE, MPI_SUM, comm);
+    v[1] = tsum / size;
+  }
+
+  data.ksm->decref();
+  data.pc->decref();
+  data.mat->decref();
+  data.x->decref();
+  data.y->decref();
+}
+
+/*
+  Get the name of the kernel
+*/
+const char *TACSBenchmark::getKernelName(int kernel) {
+  if (kernel < 0 || kernel >= TACS_BENCH_NUM_KERNELS) {
+    return NULL;
+  }
+  return bench_names[kernel];
+}
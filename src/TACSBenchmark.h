@@ -0,0 +1,66 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_BENCHMARK_H
+#define TACS_BENCHMARK_H
+
+#include "TACSAssembler.h"
+
+/*
+  The kernels timed by TACSBenchmark::runKernels()
+*/
+enum TACSBenchmarkKernel {
+  TACS_BENCH_ASSEMBLE_RES = 0,   // Residual assembly
+  TACS_BENCH_ASSEMBLE_JACOBIAN,  // Jacobian assembly
+  TACS_BENCH_DISTRIBUTE,         // Exchange of the ghost values
+  TACS_BENCH_MAT_MULT,           // Matrix-vector product
+  TACS_BENCH_PC_FACTOR,          // Schur complement factorization
+  TACS_BENCH_KSM_SOLVE,          // GMRES solve with the factorization
+  TACS_BENCH_VEC_WRITE,          // Write the state vector to a file
+  TACS_BENCH_NUM_KERNELS
+};
+
+/*
+  The timing harness shared by the benchmark suite and the performance
+  tests
+
+  timeKernel() calls the kernel once to warm up and then times it nreps
+  times. The fastest time on this processor is returned.
+
+  runKernels() times the standard kernels for an assembler that has
+  been initialized. The results are stored in the array values, which
+  must be of length 4*TACS_BENCH_NUM_KERNELS, as the minimum, average
+  and maximum time over all processes and the average number of flops
+  per call summed over all processes. The file output kernel is only
+  timed when a file name is provided, otherwise its values are zero.
+  This call is collective on the communicator of the assembler.
+*/
+class TACSBenchmark {
+ public:
+  // Time a single kernel
+  // --------------------
+  static double timeKernel(MPI_Comm comm, int nreps, void (*kernel)(void *),
+                           void *data, double *flops = NULL);
+
+  // Time the standard kernels for an assembler
+  // ------------------------------------------
+  static void runKernels(TACSAssembler *assembler, int nreps,
+                         const char *filename, double values[]);
+
+  // Get the name of the kernel
+  // --------------------------
+  static const char *getKernelName(int kernel);
+};
+
+#endif  // TACS_BENCHMARK_H
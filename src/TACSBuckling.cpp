@@ -24,6 +24,56 @@
   Implementation of the buckling/frequency analysis
 */
 
+/*
+  Match the saved eigenvectors with the current eigenvectors using the
+  modal assurance criterion (MAC)
+
+  MAC(i, j) = (u_i^{T} v_j)^2/((u_i^{T} u_i)(v_j^{T} v_j))
+
+  The pairs are assigned greedily, starting with the pair with the
+  largest MAC value, so that each saved eigenvector is matched with a
+  distinct current eigenvector.
+
+  input:
+  n:         the number of eigenvectors
+  mac:       the MAC values where mac[n*i + j] = MAC(i, j)
+
+  output:
+  modes:     the current eigenvector matched to each saved eigenvector
+  mode_mac:  the MAC value of each match
+*/
+static void TacsMatchModes(int n, const TacsScalar *mac, int *modes,
+                           TacsScalar *mode_mac) {
+  int *matched = new int[n];
+  for (int i = 0; i < n; i++) {
+    modes[i] = -1;
+    matched[i] = 0;
+  }
+
+  for (int k = 0; k < n; k++) {
+    int imax = -1, jmax = -1;
+    double max_mac = -1.0;
+    for (int i = 0; i < n; i++) {
+      if (modes[i] >= 0) {
+        continue;
+      }
+      for (int j = 0; j < n; j++) {
+        if (!matched[j] && TacsRealPart(mac[n * i + j]) > max_mac) {
+          imax = i;
+          jmax = j;
+          max_mac = TacsRealPart(mac[n * i + j]);
+        }
+      }
+    }
+
+    modes[imax] = jmax;
+    mode_mac[imax] = mac[n * imax + jmax];
+    matched[jmax] = 1;
+  }
+
+  delete[] matched;
+}
+
 /*
   Linear buckling analysis object.
 
@@ -37,10 +87,16 @@
   Note: all the matrices supplied must be of the same type and support
   copy/axpy/axpby etc. operations.
 
+  When gmat is NULL, the geometric stiffness matrix is not assembled.
+  Instead, the products with the geometric stiffness matrix are computed
+  matrix-free and the shifted operator is assembled directly from the
+  element matrices. This avoids storing a third matrix at the cost of
+  recomputing the element geometric stiffness matrices for each product.
+
   input:
   assembler:    The TACS model corresponding to the analysis problem
   sigma:        The spectral shift
-  gmat:         The geometric stiffness matrix
+  gmat:         The geometric stiffness matrix (may be NULL)
   kmat:         The stiffness matrix
   aux_mat:      The auxiliary matrix associated with the solver
   solver:       Whatever KSM object you create
@@ -57,10 +113,15 @@ TACSLinearBuckling::TACSLinearBuckling(TACSAssembler *_assembler,
   assembler = _assembler;
   assembler->incref();
 
-  // Store the matrices required
+  // Store the matrices required. Use a matrix-free geometric stiffness
+  // matrix when none is provided.
   aux_mat = _aux_mat;
   gmat = _gmat;
   kmat = _kmat;
+  if (!gmat) {
+    gmat = new TACSMatrixFreeMat(assembler);
+  }
+  gmat_free = dynamic_cast<TACSMatrixFreeMat *>(gmat);
   aux_mat->incref();
   gmat->incref();
   kmat->incref();
@@ -104,6 +165,9 @@ TACSLinearBuckling::TACSLinearBuckling(TACSAssembler *_assembler,
   // multigrid level.
   mg = dynamic_cast<TACSMg *>(pc);
 
+  // The factorization is not shared by default
+  factor_cache = NULL;
+
   // Store the spectral shift info
   sigma = _sigma;
 
@@ -130,12 +194,22 @@ TACSLinearBuckling::TACSLinearBuckling(TACSAssembler *_assembler,
   update->incref();
   eigvec->incref();
   path->incref();
+
+  // The warm start is not set by default
+  num_tracked = 0;
+  tracked_valid = 0;
+  tracked_vecs = NULL;
+  tracked_modes = NULL;
+  tracked_mac = NULL;
 }
 
 /*
   Destructor object for the buckling object
 */
 TACSLinearBuckling::~TACSLinearBuckling() {
+  // Free the saved eigenvectors
+  setWarmStart(0);
+
   // Dereference the matrix objects
   aux_mat->decref();
   gmat->decref();
@@ -154,6 +228,10 @@ TACSLinearBuckling::~TACSLinearBuckling() {
   res->decref();
   update->decref();
   eigvec->decref();
+
+  if (factor_cache) {
+    factor_cache->decref();
+  }
 }
 
 /*
@@ -169,6 +247,161 @@ void TACSLinearBuckling::setSigma(TacsScalar _sigma) {
   ep_op->setSigma(sigma);
 }
 
+/*
+  Use the thick-restart block Lanczos method with the given block
+  size. The max_lanczos argument then bounds the size of the basis.
+*/
+void TACSLinearBuckling::setBlockLanczos(int block_size, int max_restarts) {
+  sep->setBlockLanczos(block_size, max_restarts);
+}
+
+/*
+  Warm-start the eigensolver with the eigenvectors from the previous
+  solve and track the modes between solves.
+
+  When the warm start is set, the eigenvectors are saved after each
+  solve and are used to seed the starting vectors of the next solve.
+  The new eigenvectors are matched with the saved eigenvectors using
+  the modal assurance criterion. This is useful within a design
+  optimization where the eigenvectors change only slightly between
+  design iterations. The mode that corresponds to the n-th mode of the
+  first solve is given by getTrackedMode(n).
+*/
+void TACSLinearBuckling::setWarmStart(int warm_start) {
+  if (warm_start && num_tracked == 0) {
+    num_tracked = num_eigvals;
+    tracked_valid = 0;
+    tracked_vecs = new TACSBVec *[num_tracked];
+    tracked_modes = new int[num_tracked];
+    tracked_mac = new TacsScalar[num_tracked];
+    for (int i = 0; i < num_tracked; i++) {
+      tracked_vecs[i] = assembler->createVec();
+      tracked_vecs[i]->incref();
+    }
+  } else if (!warm_start && num_tracked > 0) {
+    sep->setInitialVectors(0, NULL);
+    for (int i = 0; i < num_tracked; i++) {
+      tracked_vecs[i]->decref();
+    }
+    delete[] tracked_vecs;
+    delete[] tracked_modes;
+    delete[] tracked_mac;
+    num_tracked = 0;
+    tracked_valid = 0;
+    tracked_vecs = NULL;
+    tracked_modes = NULL;
+    tracked_mac = NULL;
+  }
+}
+
+/*
+  Share the direct factorization with other analyses of the model
+
+  The solver for the buckling analysis must be associated with the
+  matrix and the preconditioner of the cache. The factorization of the
+  stiffness matrix used for the load path and for the derivatives is
+  then shared with the static and adjoint solves of the cache, and
+  the factorization of the shifted operator is re-used when the model
+  and the shift have not changed. The stiffness matrix is assumed to
+  be independent of the load path.
+
+  @param cache The factorization cache (may be NULL)
+*/
+void TACSLinearBuckling::setFactorCache(TACSFactorCache *cache) {
+  if (cache && (mg || aux_mat != cache->getMat() || pc != cache->getPc())) {
+    fprintf(stderr,
+            "TACSBuckling: Error, the solver must use the matrix and "
+            "preconditioner of the factorization cache\n");
+    return;
+  }
+  if (cache) {
+    cache->incref();
+  }
+  if (factor_cache) {
+    factor_cache->decref();
+  }
+  factor_cache = cache;
+}
+
+/*
+  Get the index of the current mode that matches the n-th mode from
+  the first solve after the warm start was set, and optionally the
+  corresponding MAC value from the last solve. Without the warm start,
+  this returns n.
+*/
+int TACSLinearBuckling::getTrackedMode(int n, TacsScalar *mac) {
+  if (tracked_valid && n >= 0 && n < num_tracked) {
+    if (mac) {
+      *mac = tracked_mac[n];
+    }
+    return tracked_modes[n];
+  }
+  if (mac) {
+    *mac = 1.0;
+  }
+  return n;
+}
+
+/*
+  Match the current eigenvectors with the saved eigenvectors and then
+  save the current eigenvectors in the tracked order
+*/
+void TACSLinearBuckling::updateTrackedModes() {
+  if (num_tracked == 0) {
+    return;
+  }
+
+  const int n = num_tracked;
+  TACSVec **vecs = new TACSVec *[n];
+  for (int i = 0; i < n; i++) {
+    vecs[i] = tracked_vecs[i];
+  }
+
+  if (tracked_valid) {
+    TacsScalar *mac = new TacsScalar[n * n];
+    TacsScalar *norms = new TacsScalar[n];
+    TacsScalar *dots = new TacsScalar[n];
+    for (int i = 0; i < n; i++) {
+      norms[i] = tracked_vecs[i]->dot(tracked_vecs[i]);
+    }
+
+    for (int j = 0; j < n; j++) {
+      TacsScalar error;
+      sep->extractEigenvector(j, eigvec, &error);
+      TacsScalar norm = eigvec->dot(eigvec);
+      eigvec->mdot(vecs, dots, n);
+      for (int i = 0; i < n; i++) {
+        mac[n * i + j] = dots[i] * dots[i] / (norms[i] * norm);
+      }
+    }
+
+    TacsMatchModes(n, mac, tracked_modes, tracked_mac);
+
+    delete[] mac;
+    delete[] norms;
+    delete[] dots;
+  } else {
+    for (int i = 0; i < n; i++) {
+      tracked_modes[i] = i;
+      tracked_mac[i] = 1.0;
+    }
+  }
+
+  // Save the eigenvectors in the tracked order
+  for (int i = 0; i < n; i++) {
+    TacsScalar error;
+    sep->extractEigenvector(tracked_modes[i], tracked_vecs[i], &error);
+  }
+
+  // Seed the next solve with the saved eigenvectors
+  if (!tracked_valid) {
+    tracked_valid = 1;
+    sep->setInitialVectors(n, vecs);
+  }
+
+  delete[] vecs;
+}
+
 /*
   Solve the linearized buckling problem about x = 0.
 
@@ -231,17 +464,28 @@ void TACSLinearBuckling::solve(TACSVec *rhs, TACSVec *u0, KSMPrint *ksm_print) {
 
     // Assemble the geometric stiffness matrix and the stiffness matrix itself
     assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
-    assembler->assembleMatType(TACS_GEOMETRIC_STIFFNESS_MATRIX, gmat);
+    if (gmat_free) {
+      gmat_free->assembleMatrixFreeData(TACS_GEOMETRIC_STIFFNESS_MATRIX, 1.0,
+                                        0.0, 0.0);
+    } else {
+      assembler->assembleMatType(TACS_GEOMETRIC_STIFFNESS_MATRIX, gmat);
+    }
   } else {
     // Compute the stiffness matrix and copy the values to the
     // auxiliary matrix used to solve for the load path.
     assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
-    aux_mat->copyValues(kmat);
+    if (!factor_cache) {
+      aux_mat->copyValues(kmat);
+    }
 
     if (u0) {
       path->copyValues(u0);
     } else {
-      pc->factor();
+      if (factor_cache) {
+        factor_cache->factorStiffness();
+      } else {
+        pc->factor();
+      }
       assembler->assembleRes(res);
 
       // If need to add rhs
@@ -261,19 +505,50 @@ void TACSLinearBuckling::solve(TACSVec *rhs, TACSVec *u0, KSMPrint *ksm_print) {
     assembler->setBCs(path);
     assembler->setVariables(path);
 
-    // Assemble the stiffness and geometric stiffness matrix
-    assembler->assembleMatType(TACS_GEOMETRIC_STIFFNESS_MATRIX, gmat);
+    if (factor_cache) {
+      // Assemble the geometric stiffness matrix or its matrix-free data
+      if (gmat_free) {
+        gmat_free->assembleMatrixFreeData(TACS_GEOMETRIC_STIFFNESS_MATRIX,
+                                          1.0, 0.0, 0.0);
+      } else {
+        assembler->assembleMatType(TACS_GEOMETRIC_STIFFNESS_MATRIX, gmat);
+      }
+
+      // Assemble and factor the shifted operator in the shared matrix
+      ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX,
+                                       TACS_GEOMETRIC_STIFFNESS_MATRIX};
+      TacsScalar scale[2] = {1.0, sigma};
+      factor_cache->factor(2, matTypes, scale);
+    } else if (gmat_free) {
+      // Store the data for the matrix-free geometric stiffness products
+      gmat_free->assembleMatrixFreeData(TACS_GEOMETRIC_STIFFNESS_MATRIX, 1.0,
+                                        0.0, 0.0);
+
+      // Assemble the shifted operator directly from the element matrices
+      ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX,
+                                       TACS_GEOMETRIC_STIFFNESS_MATRIX};
+      TacsScalar scale[2] = {1.0, sigma};
+      assembler->assembleMatCombo(matTypes, scale, 2, aux_mat);
+    } else {
+      // Assemble the stiffness and geometric stiffness matrix
+      assembler->assembleMatType(TACS_GEOMETRIC_STIFFNESS_MATRIX, gmat);
 
-    // Form the shifted operator and factor it
-    aux_mat->axpy(sigma, gmat);
-    aux_mat->applyBCs(assembler->getBcMap());
+      // Form the shifted operator and factor it
+      aux_mat->axpy(sigma, gmat);
+      aux_mat->applyBCs(assembler->getBcMap());
+    }
   }
 
-  // Factor the preconditioner
-  pc->factor();
+  // Factor the preconditioner, unless it is owned by the shared cache
+  if (mg || !factor_cache) {
+    pc->factor();
+  }
 
   // Solve the symmetric eigenvalue problem
   sep->solve(ksm_print);
+
+  // Save the eigenvectors for the next solve
+  updateTrackedModes();
 }
 
 /*!
@@ -385,8 +660,12 @@ void TACSLinearBuckling::evalEigenDVSens(int n, TACSBVec *dfdx) {
 
   // Copy over the values of the stiffness matrix, factor
   // the stiffness matrix.
-  aux_mat->copyValues(kmat);
-  pc->factor();
+  if (factor_cache) {
+    factor_cache->factorStiffness();
+  } else {
+    aux_mat->copyValues(kmat);
+    pc->factor();
+  }
 
   // Get the eigenvalue and eigenvector
   TacsScalar error;
@@ -459,8 +738,12 @@ void TACSLinearBuckling::evalEigenXptSens(int n, TACSBVec *dfdX) {
 
   // Copy over the values of the stiffness matrix, factor
   // the stiffness matrix.
-  aux_mat->copyValues(kmat);
-  pc->factor();
+  if (factor_cache) {
+    factor_cache->factorStiffness();
+  } else {
+    aux_mat->copyValues(kmat);
+    pc->factor();
+  }
 
   // Get the eigenvalue and eigenvector
   TacsScalar error;
@@ -552,6 +835,213 @@ void TACSLinearBuckling::addEigenXptSens(TacsScalar coef, int n,
                                        eigvec, dfdX);
 }
 
+/*
+  Evaluate the derivatives of several eigenvalues with respect to the
+  design variables.
+
+  This is equivalent to calling evalEigenDVSens() for each mode, but
+  the inner products for all the modes are evaluated within a single
+  pass over the elements and the adjoint equations for the load path
+  are solved together.
+
+  input:
+  num_modes:  the number of modes
+  modes:      the indices of the modes
+
+  output:
+  dfdx:       the derivative of each eigenvalue
+*/
+void TACSLinearBuckling::evalEigenDVSensMulti(int num_modes, const int *modes,
+                                              TACSBVec **dfdx) {
+  evalEigenSensMulti(num_modes, modes, dfdx, NULL);
+}
+
+/*
+  Evaluate the derivatives of several eigenvalues with respect to the
+  node locations. This is equivalent to calling evalEigenXptSens() for
+  each mode.
+*/
+void TACSLinearBuckling::evalEigenXptSensMulti(int num_modes, const int *modes,
+                                               TACSBVec **dfdX) {
+  evalEigenSensMulti(num_modes, modes, NULL, dfdX);
+}
+
+/*
+  Evaluate the derivatives of the eigenvalues with respect to either
+  the design variables or the node locations
+*/
+void TACSLinearBuckling::evalEigenSensMulti(int num_modes, const int *modes,
+                                            TACSBVec **dfdx, TACSBVec **dfdX) {
+  if (num_modes <= 0) {
+    return;
+  }
+
+  // Copy over the values of the stiffness matrix, factor
+  // the stiffness matrix.
+  if (factor_cache) {
+    factor_cache->factorStiffness();
+  } else {
+    aux_mat->copyValues(kmat);
+    pc->factor();
+  }
+
+  // Extract the eigenvectors and compute the inner products u^{T}*G*u
+  TACSBVec **vecs = new TACSBVec *[3 * num_modes];
+  TACSBVec **rhs = &vecs[num_modes];
+  TACSBVec **adjoint = &vecs[2 * num_modes];
+  TacsScalar *eigs = new TacsScalar[4 * num_modes];
+  TacsScalar *norms = &eigs[num_modes];
+  TacsScalar *scale = &eigs[2 * num_modes];
+  for (int k = 0; k < 3 * num_modes; k++) {
+    vecs[k] = assembler->createVec();
+    vecs[k]->incref();
+  }
+  for (int k = 0; k < num_modes; k++) {
+    TacsScalar error;
+    eigs[k] = extractEigenvector(modes[k], vecs[k], &error);
+    gmat->mult(vecs[k], res);
+    norms[k] = res->dot(vecs[k]);
+    scale[2 * k] = 1.0;
+    scale[2 * k + 1] = TacsRealPart(eigs[k]);
+  }
+
+  // Evaluate the partial derivatives for the stiffness and geometric
+  // stiffness matrices for all the modes
+  ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX,
+                                   TACS_GEOMETRIC_STIFFNESS_MATRIX};
+  if (dfdx) {
+    for (int k = 0; k < num_modes; k++) {
+      dfdx[k]->zeroEntries();
+    }
+    assembler->addMatDVSensInnerProducts(2, matTypes, num_modes, scale, vecs,
+                                         vecs, dfdx);
+  } else {
+    for (int k = 0; k < num_modes; k++) {
+      dfdX[k]->zeroEntries();
+    }
+    assembler->addMatXptSensInnerProducts(2, matTypes, num_modes, scale, vecs,
+                                          vecs, dfdX);
+  }
+
+  // Evaluate derivative of the inner products with respect to the
+  // path variables and solve for the adjoint vectors
+  assembler->evalMatSVSensInnerProducts(TACS_GEOMETRIC_STIFFNESS_MATRIX,
+                                        num_modes, vecs, vecs, rhs);
+  TACSVec **b = new TACSVec *[2 * num_modes];
+  for (int k = 0; k < num_modes; k++) {
+    b[k] = rhs[k];
+    b[num_modes + k] = adjoint[k];
+  }
+  solver->solveMulti(num_modes, b, &b[num_modes]);
+  delete[] b;
+
+  // Evaluate the derivative of the adjoint-residual inner products
+  for (int k = 0; k < num_modes; k++) {
+    adjoint[k]->scale(-TacsRealPart(eigs[k]));
+  }
+  if (dfdx) {
+    assembler->addAdjointResProducts(1.0, num_modes, adjoint, dfdx);
+  } else {
+    assembler->addAdjointResXptSensProducts(1.0, num_modes, adjoint, dfdX);
+  }
+
+  // Scale the final results
+  for (int k = 0; k < num_modes; k++) {
+    TACSBVec *vec = (dfdx ? dfdx[k] : dfdX[k]);
+    vec->beginSetValues(TACS_ADD_VALUES);
+    vec->endSetValues(TACS_ADD_VALUES);
+    vec->scale(-1.0 / norms[k]);
+  }
+
+  for (int k = 0; k < 3 * num_modes; k++) {
+    vecs[k]->decref();
+  }
+  delete[] vecs;
+  delete[] eigs;
+}
+
+/*
+  Add the partial derivatives of several eigenvalues with respect to
+  the design variables. This is equivalent to calling addEigenDVSens()
+  for each mode.
+*/
+void TACSLinearBuckling::addEigenDVSensMulti(TacsScalar coef, int num_modes,
+                                             const int *modes,
+                                             TACSBVec **dfdx) {
+  if (num_modes <= 0) {
+    return;
+  }
+
+  TACSBVec **vecs = new TACSBVec *[num_modes];
+  TacsScalar *scale = new TacsScalar[2 * num_modes];
+  for (int k = 0; k < num_modes; k++) {
+    vecs[k] = assembler->createVec();
+    vecs[k]->incref();
+
+    // Get the eigenvalue and the inner product: u^{T}*G*u
+    TacsScalar error;
+    TacsScalar eig = extractEigenvector(modes[k], vecs[k], &error);
+    gmat->mult(vecs[k], res);
+    TacsScalar norm = res->dot(vecs[k]);
+    scale[2 * k] = -coef / norm;
+    scale[2 * k + 1] = -eig * coef / norm;
+  }
+
+  // Evaluate the partial derivatives for the stiffness and geometric
+  // stiffness matrices
+  ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX,
+                                   TACS_GEOMETRIC_STIFFNESS_MATRIX};
+  assembler->addMatDVSensInnerProducts(2, matTypes, num_modes, scale, vecs,
+                                       vecs, dfdx);
+
+  for (int k = 0; k < num_modes; k++) {
+    vecs[k]->decref();
+  }
+  delete[] vecs;
+  delete[] scale;
+}
+
+/*
+  Add the partial derivatives of several eigenvalues with respect to
+  the node locations. This is equivalent to calling addEigenXptSens()
+  for each mode.
+*/
+void TACSLinearBuckling::addEigenXptSensMulti(TacsScalar coef, int num_modes,
+                                              const int *modes,
+                                              TACSBVec **dfdX) {
+  if (num_modes <= 0) {
+    return;
+  }
+
+  TACSBVec **vecs = new TACSBVec *[num_modes];
+  TacsScalar *scale = new TacsScalar[2 * num_modes];
+  for (int k = 0; k < num_modes; k++) {
+    vecs[k] = assembler->createVec();
+    vecs[k]->incref();
+
+    // Get the eigenvalue and the inner product: u^{T}*G*u
+    TacsScalar error;
+    TacsScalar eig = extractEigenvector(modes[k], vecs[k], &error);
+    gmat->mult(vecs[k], res);
+    TacsScalar norm = res->dot(vecs[k]);
+    scale[2 * k] = -coef / norm;
+    scale[2 * k + 1] = -coef * eig / norm;
+  }
+
+  // Evaluate the partial derivatives for the stiffness and geometric
+  // stiffness matrices
+  ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX,
+                                   TACS_GEOMETRIC_STIFFNESS_MATRIX};
+  assembler->addMatXptSensInnerProducts(2, matTypes, num_modes, scale, vecs,
+                                        vecs, dfdX);
+
+  for (int k = 0; k < num_modes; k++) {
+    vecs[k]->decref();
+  }
+  delete[] vecs;
+  delete[] scale;
+}
+
 /*
   The function computes the partial derivatives of the buckling eigenvalues.
 
@@ -613,7 +1103,7 @@ void TACSLinearBuckling::evalEigenSVSens(int n, TACSBVec *dfdu) {
 TACSFrequencyAnalysis::TACSFrequencyAnalysis(TACSAssembler *_assembler,
                                              TacsScalar _sigma, TACSMat *_mmat,
                                              TACSMat *_kmat, TACSKsm *_solver,
-                                             int max_lanczos, int num_eigvals,
+                                             int max_lanczos, int _num_eigvals,
                                              double eig_tol) {
   // Store the TACSAssembler pointer
   assembler = _assembler;
@@ -621,6 +1111,7 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(TACSAssembler *_assembler,
 
   // Set the shift value
   sigma = _sigma;
+  num_eigvals = _num_eigvals;
 
   // Store the stiffness/mass matrices
   mmat = _mmat;
@@ -648,6 +1139,9 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(TACSAssembler *_assembler,
   // multigrid level.
   mg = dynamic_cast<TACSMg *>(pc);
 
+  // The factorization is not shared by default
+  factor_cache = NULL;
+
   // Allocate vectors that are required for the eigenproblem
   eigvec = assembler->createVec();
   res = assembler->createVec();
@@ -672,12 +1166,31 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(TACSAssembler *_assembler,
     sep = new SEP(simple_ep_op, max_lanczos, SEP::FULL, assembler->getBcMap());
   }
   sep->incref();
-  sep->setTolerances(eig_tol, SEP::SMALLEST_MAGNITUDE, num_eigvals);
+  sep->setTolerances(eig_tol, SEP::SMALLEST_MAGNITUDE, _num_eigvals);
 
   // Set unallocated objects to NULL
   pcmat = NULL;
   jd_op = NULL;
   jd = NULL;
+
+  // The warm start is not set by default
+  num_tracked = 0;
+  tracked_valid = 0;
+  tracked_vecs = NULL;
+  tracked_modes = NULL;
+  tracked_mac = NULL;
+
+  // LOBPCG is not available with the Lanczos eigensolver
+  lobpcg = NULL;
+  lobpcg_tol = 0.0;
+
+  // The reduced basis is not used by default
+  max_basis = num_basis = num_static = 0;
+  basis_tol = 0.0;
+  basis = NULL;
+  reduced_valid = 0;
+  ritz_eigs = ritz_errors = NULL;
+  ritz_vecs = NULL;
 }
 
 /*!
@@ -702,7 +1215,7 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(TACSAssembler *_assembler,
 TACSFrequencyAnalysis::TACSFrequencyAnalysis(
     TACSAssembler *_assembler, TacsScalar _init_eig, TACSMat *_mmat,
     TACSMat *_kmat, TACSMat *_pcmat, TACSPc *_pc, int max_jd_size,
-    int fgmres_size, int num_eigvals, double eigtol, double eig_rtol,
+    int fgmres_size, int _num_eigvals, double eigtol, double eig_rtol,
     double eig_atol, int num_recycle, JDRecycleType recycle_type) {
   // Store the TACSAssembler pointer
   assembler = _assembler;
@@ -710,6 +1223,7 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(
 
   // Set the initial eigenvalue estimate
   sigma = _init_eig;
+  num_eigvals = _num_eigvals;
 
   // Store the stiffness/mass/preconditioner matrices
   mmat = _mmat;
@@ -731,6 +1245,9 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(
   // multigrid level.
   mg = dynamic_cast<TACSMg *>(pc);
 
+  // The factorization is not shared by default
+  factor_cache = NULL;
+
   // Allocate vectors that are required for the eigenproblem
   eigvec = assembler->createVec();
   res = assembler->createVec();
@@ -746,7 +1263,7 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(
   jd_op->incref();
 
   // Allocate the Jacobi-Davidson solver
-  jd = new TACSJacobiDavidson(jd_op, num_eigvals, max_jd_size, fgmres_size);
+  jd = new TACSJacobiDavidson(jd_op, _num_eigvals, max_jd_size, fgmres_size);
   jd->incref();
 
   // Set unallocated objects to NULL
@@ -759,16 +1276,45 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis(
 
   // Set the number of eigenvectors to recycle
   jd->setRecycle(num_recycle, recycle_type);
+
+  // The warm start is not set by default
+  num_tracked = 0;
+  tracked_valid = 0;
+  tracked_vecs = NULL;
+  tracked_modes = NULL;
+  tracked_mac = NULL;
+
+  // LOBPCG is not used by default
+  lobpcg = NULL;
+  lobpcg_tol = eigtol;
+
+  // The reduced basis is not used by default
+  max_basis = num_basis = num_static = 0;
+  basis_tol = 0.0;
+  basis = NULL;
+  reduced_valid = 0;
+  ritz_eigs = ritz_errors = NULL;
+  ritz_vecs = NULL;
 }
 
 /*
   Deallocate all of the stored data
 */
 TACSFrequencyAnalysis::~TACSFrequencyAnalysis() {
+  // Free the saved eigenvectors and the reduced basis
+  setWarmStart(0);
+  setReducedBasis(0, 0.0);
+
   assembler->decref();
   eigvec->decref();
   res->decref();
 
+  if (lobpcg) {
+    lobpcg->decref();
+  }
+  if (factor_cache) {
+    factor_cache->decref();
+  }
   if (jd) {
     jd_op->decref();
     jd->decref();
@@ -801,12 +1347,498 @@ void TACSFrequencyAnalysis::setSigma(TacsScalar _sigma) {
   }
 }
 
+/*
+  Use the thick-restart block Lanczos method with the given block
+  size. This only applies when the Lanczos eigensolver is used.
+*/
+void TACSFrequencyAnalysis::setBlockLanczos(int block_size, int max_restarts) {
+  if (sep) {
+    sep->setBlockLanczos(block_size, max_restarts);
+  } else {
+    fprintf(stderr,
+            "TACSFrequencyAnalysis: Block Lanczos is not available with "
+            "the Jacobi-Davidson eigensolver\n");
+  }
+}
+
+/*
+  Use the LOBPCG eigensolver with the given block size in place of the
+  Jacobi-Davidson method. This uses the same operator and preconditioner
+  as the Jacobi-Davidson method. The block size is increased to at least
+  the number of eigenvalues. Since the eigenvectors from the previous
+  solve are used as the starting block, this is always warm-started.
+*/
+void TACSFrequencyAnalysis::setLOBPCG(int block_size, int max_iters) {
+  if (!jd_op) {
+    fprintf(stderr,
+            "TACSFrequencyAnalysis: LOBPCG requires the Jacobi-Davidson "
+            "operator and preconditioner\n");
+    return;
+  }
+
+  if (lobpcg) {
+    lobpcg->decref();
+  }
+  lobpcg = new TACSLOBPCG(jd_op, num_eigvals, block_size, max_iters);
+  lobpcg->incref();
+  lobpcg->setTolerances(lobpcg_tol, 1e-30);
+}
+
+/*
+  Set the options for the inner FGMRES solves of the Jacobi-Davidson
+  method. The given number of vectors is recycled between the
+  correction equations. When shift_rtol is non-negative, the coarsest
+  level of a multigrid preconditioner is shifted to the current Ritz
+  value whenever the Ritz value moves by more than shift_rtol relative
+  to the last shift.
+*/
+void TACSFrequencyAnalysis::setJDInnerSolver(int num_inner_recycle,
+                                             double shift_rtol) {
+  if (!jd) {
+    fprintf(stderr,
+            "TACSFrequencyAnalysis: The inner solver options only apply "
+            "to the Jacobi-Davidson eigensolver\n");
+    return;
+  }
+
+  jd->setInnerRecycle(num_inner_recycle);
+  jd->setShiftUpdate(shift_rtol);
+}
+
+/*
+  Warm-start the eigensolver with the eigenvectors from the previous
+  solve and track the modes between solves.
+
+  When the warm start is set, the eigenvectors are saved after each
+  solve and are used to seed the starting vectors of the next solve.
+  The new eigenvectors are matched with the saved eigenvectors using
+  the modal assurance criterion. This is useful within a design
+  optimization where the eigenvectors change only slightly between
+  design iterations. The mode that corresponds to the n-th mode of the
+  first solve is given by getTrackedMode(n).
+*/
+void TACSFrequencyAnalysis::setWarmStart(int warm_start) {
+  if (warm_start && num_tracked == 0) {
+    num_tracked = num_eigvals;
+    tracked_valid = 0;
+    tracked_vecs = new TACSBVec *[num_tracked];
+    tracked_modes = new int[num_tracked];
+    tracked_mac = new TacsScalar[num_tracked];
+    for (int i = 0; i < num_tracked; i++) {
+      tracked_vecs[i] = assembler->createVec();
+      tracked_vecs[i]->incref();
+    }
+    if (jd) {
+      jd->setRecycle(num_tracked, JD_NUM_RECYCLE);
+    }
+  } else if (!warm_start && num_tracked > 0) {
+    if (sep) {
+      sep->setInitialVectors(0, NULL);
+    }
+    for (int i = 0; i < num_tracked; i++) {
+      tracked_vecs[i]->decref();
+    }
+    delete[] tracked_vecs;
+    delete[] tracked_modes;
+    delete[] tracked_mac;
+    num_tracked = 0;
+    tracked_valid = 0;
+    tracked_vecs = NULL;
+    tracked_modes = NULL;
+    tracked_mac = NULL;
+    if (jd) {
+      jd->setRecycle(0, JD_NUM_RECYCLE);
+    }
+  }
+}
+
+/*
+  Share the direct factorization with other analyses of the model
+
+  This applies only to the Lanczos eigensolver. The solver must be
+  associated with the matrix and the preconditioner of the cache. The
+  factorization of the shifted operator K - sigma*M is then re-used
+  between solves when the model and the shift have not changed.
+
+  @param cache The factorization cache (may be NULL)
+*/
+void TACSFrequencyAnalysis::setFactorCache(TACSFactorCache *cache) {
+  if (cache && (mg || jd || kmat != cache->getMat() || pc != cache->getPc())) {
+    fprintf(stderr,
+            "TACSFrequencyAnalysis: Error, the solver must use the matrix "
+            "and preconditioner of the factorization cache\n");
+    return;
+  }
+  if (cache) {
+    cache->incref();
+  }
+  if (factor_cache) {
+    factor_cache->decref();
+  }
+  factor_cache = cache;
+}
+
+/*
+  Get the index of the current mode that matches the n-th mode from
+  the first solve after the warm start was set, and optionally the
+  corresponding MAC value from the last solve. Without the warm start,
+  this returns n.
+*/
+int TACSFrequencyAnalysis::getTrackedMode(int n, TacsScalar *mac) {
+  if (tracked_valid && n >= 0 && n < num_tracked) {
+    if (mac) {
+      *mac = tracked_mac[n];
+    }
+    return tracked_modes[n];
+  }
+  if (mac) {
+    *mac = 1.0;
+  }
+  return n;
+}
+
+/*
+  Match the current eigenvectors with the saved eigenvectors and then
+  save the current eigenvectors in the tracked order
+*/
+void TACSFrequencyAnalysis::updateTrackedModes() {
+  if (num_tracked == 0) {
+    return;
+  }
+
+  const int n = num_tracked;
+  TACSVec **vecs = new TACSVec *[n];
+  for (int i = 0; i < n; i++) {
+    vecs[i] = tracked_vecs[i];
+  }
+
+  if (tracked_valid) {
+    TacsScalar *mac = new TacsScalar[n * n];
+    TacsScalar *norms = new TacsScalar[n];
+    TacsScalar *dots = new TacsScalar[n];
+    for (int i = 0; i < n; i++) {
+      norms[i] = tracked_vecs[i]->dot(tracked_vecs[i]);
+    }
+
+    for (int j = 0; j < n; j++) {
+      TacsScalar error;
+      extractEigenvector(j, eigvec, &error);
+      TacsScalar norm = eigvec->dot(eigvec);
+      eigvec->mdot(vecs, dots, n);
+      for (int i = 0; i < n; i++) {
+        mac[n * i + j] = dots[i] * dots[i] / (norms[i] * norm);
+      }
+    }
+
+    TacsMatchModes(n, mac, tracked_modes, tracked_mac);
+
+    delete[] mac;
+    delete[] norms;
+    delete[] dots;
+  } else {
+    for (int i = 0; i < n; i++) {
+      tracked_modes[i] = i;
+      tracked_mac[i] = 1.0;
+    }
+  }
+
+  // Save the eigenvectors in the tracked order
+  for (int i = 0; i < n; i++) {
+    TacsScalar error;
+    extractEigenvector(tracked_modes[i], tracked_vecs[i], &error);
+  }
+
+  // Seed the next solve with the saved eigenvectors
+  if (!tracked_valid) {
+    tracked_valid = 1;
+    if (sep) {
+      sep->setInitialVectors(n, vecs);
+    }
+  }
+
+  delete[] vecs;
+}
+
+/*
+  Solve the eigenvalue problems with a reduced basis of the cached modes
+  and static shapes when possible.
+
+  When the reduced basis is set, the stiffness and mass matrices are
+  projected onto the basis and the small dense eigenproblem is solved
+  with LAPACK. The Ritz pairs are accepted when the relative residual
+
+  ||K*x - lambda*M*x||/||K*x||
+
+  of each requested eigenpair is less than the basis tolerance. Otherwise,
+  the full eigensolver is used and the new eigenvectors replace the cached
+  modes in the basis. This is useful for rapid what-if checks where the
+  design changes only slightly between solves. Static shapes, such as the
+  displacements due to the design loads, can be added to the basis to
+  capture the changes in the modes.
+*/
+void TACSFrequencyAnalysis::setReducedBasis(int max_basis_size,
+                                            double _basis_tol) {
+  if (basis) {
+    for (int i = 0; i < max_basis; i++) {
+      basis[i]->decref();
+    }
+    for (int i = 0; i < num_eigvals; i++) {
+      ritz_vecs[i]->decref();
+    }
+    delete[] basis;
+    delete[] ritz_vecs;
+    delete[] ritz_eigs;
+    delete[] ritz_errors;
+    basis = NULL;
+    ritz_vecs = NULL;
+    ritz_eigs = ritz_errors = NULL;
+  }
+
+  max_basis = 0;
+  num_basis = num_static = 0;
+  reduced_valid = 0;
+  basis_tol = _basis_tol;
+
+  if (max_basis_size > 0) {
+    max_basis = max_basis_size;
+    basis = new TACSVec *[max_basis];
+    for (int i = 0; i < max_basis; i++) {
+      basis[i] = assembler->createVec();
+      basis[i]->incref();
+    }
+    ritz_vecs = new TACSBVec *[num_eigvals];
+    for (int i = 0; i < num_eigvals; i++) {
+      ritz_vecs[i] = assembler->createVec();
+      ritz_vecs[i]->incref();
+    }
+    ritz_eigs = new TacsScalar[num_eigvals];
+    ritz_errors = new TacsScalar[num_eigvals];
+  }
+}
+
+/*
+  Add static shapes to the reduced basis.
+
+  The static shapes are kept in the basis between solves. Adding new
+  shapes discards the cached modes, so the next solve uses the full
+  eigensolver.
+*/
+void TACSFrequencyAnalysis::addReducedBasisVectors(int nvecs,
+                                                   TACSBVec **vecs) {
+  if (!basis) {
+    fprintf(stderr,
+            "TACSFrequencyAnalysis: Reduced basis must be set before "
+            "adding vectors\n");
+    return;
+  }
+
+  num_basis = num_static;
+  for (int i = 0; i < nvecs && num_basis < max_basis; i++) {
+    addBasisVector(vecs[i]);
+  }
+  num_static = num_basis;
+  reduced_valid = 0;
+}
+
+/*
+  Orthonormalize the vector against the reduced basis and add it to the
+  basis. Vectors that are nearly linearly dependent are discarded.
+*/
+int TACSFrequencyAnalysis::addBasisVector(TACSVec *vec) {
+  if (num_basis >= max_basis) {
+    return 0;
+  }
+
+  TACSVec *v = basis[num_basis];
+  v->copyValues(vec);
+  assembler->applyBCs(v);
+  TacsScalar init_norm = v->norm();
+  if (TacsRealPart(init_norm) == 0.0) {
+    return 0;
+  }
+
+  // Apply two passes of classical Gram-Schmidt
+  if (num_basis > 0) {
+    TacsScalar *dots = new TacsScalar[num_basis];
+    for (int k = 0; k < 2; k++) {
+      v->mdot(basis, dots, num_basis);
+      for (int i = 0; i < num_basis; i++) {
+        v->axpy(-dots[i], basis[i]);
+      }
+    }
+    delete[] dots;
+  }
+
+  TacsScalar norm = v->norm();
+  if (TacsRealPart(norm) <= 1e-8 * TacsRealPart(init_norm)) {
+    return 0;
+  }
+  v->scale(1.0 / norm);
+  num_basis++;
+
+  return 1;
+}
+
+/*
+  Replace the cached modes in the reduced basis with the eigenvectors
+  from the full eigensolver
+*/
+void TACSFrequencyAnalysis::updateReducedBasis() {
+  num_basis = num_static;
+  for (int k = 0; k < num_eigvals && num_basis < max_basis; k++) {
+    TacsScalar error;
+    extractEigenvector(k, eigvec, &error);
+    addBasisVector(eigvec);
+  }
+}
+
+/*
+  Solve the eigenproblem projected onto the reduced basis
+
+  The projected eigenproblem
+
+  (V^{T}*K*V)*y = lambda*(V^{T}*M*V)*y
+
+  is solved with LAPACK and the Ritz vectors x = V*y are checked with
+  the residual of the full eigenproblem. The Ritz pairs that are closest
+  to the shift are retained. Returns 1 if the Ritz pairs are accepted.
+*/
+int TACSFrequencyAnalysis::solveReduced(KSMPrint *ksm_print) {
+  reduced_valid = 0;
+
+  int n = num_basis;
+  if (n < num_eigvals) {
+    return 0;
+  }
+
+  // Assemble the stiffness and mass matrices. This overwrites the
+  // shared factored matrix.
+  assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
+  if (mmat) {
+    assembler->assembleMatType(TACS_MASS_MATRIX, mmat);
+  }
+  if (factor_cache) {
+    factor_cache->invalidate();
+  }
+
+  // Project the matrices onto the basis. The basis is orthonormal, so
+  // the projected mass matrix is the identity without a mass matrix.
+  double *Kr = new double[n * n];
+  double *Mr = new double[n * n];
+  TacsScalar *dots = new TacsScalar[n];
+  for (int j = 0; j < n; j++) {
+    kmat->mult(basis[j], res);
+    res->mdot(basis, dots, n);
+    for (int i = 0; i < n; i++) {
+      Kr[i + n * j] = TacsRealPart(dots[i]);
+    }
+
+    if (mmat) {
+      mmat->mult(basis[j], res);
+      res->mdot(basis, dots, n);
+      for (int i = 0; i < n; i++) {
+        Mr[i + n * j] = TacsRealPart(dots[i]);
+      }
+    } else {
+      for (int i = 0; i < n; i++) {
+        Mr[i + n * j] = (i == j ? 1.0 : 0.0);
+      }
+    }
+  }
+  delete[] dots;
+
+  // Solve the projected eigenproblem using the upper triangular part
+  // of the matrices
+  int itype = 1, info = 0;
+  int lwork = 1 + 6 * n + 2 * n * n;
+  int liwork = 3 + 5 * n;
+  double *eigs = new double[n];
+  double *work = new double[lwork];
+  int *iwork = new int[liwork];
+  LAPACKdsygvd(&itype, "V", "U", &n, Kr, &n, Mr, &n, eigs, work, &lwork,
+               iwork, &liwork, &info);
+  delete[] work;
+  delete[] iwork;
+
+  if (info != 0) {
+    delete[] Kr;
+    delete[] Mr;
+    delete[] eigs;
+    return 0;
+  }
+
+  // Order the Ritz values by their distance from the shift
+  int *perm = new int[n];
+  for (int i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+  double s = TacsRealPart(sigma);
+  for (int i = 1; i < n; i++) {
+    int p = perm[i];
+    int j = i;
+    for (; j > 0 && fabs(eigs[perm[j - 1]] - s) > fabs(eigs[p] - s); j--) {
+      perm[j] = perm[j - 1];
+    }
+    perm[j] = p;
+  }
+
+  // Form the Ritz vectors and compute the residuals of the full problem
+  double max_error = 0.0;
+  for (int k = 0; k < num_eigvals; k++) {
+    const double *y = &Kr[n * perm[k]];
+    ritz_vecs[k]->zeroEntries();
+    for (int j = 0; j < n; j++) {
+      ritz_vecs[k]->axpy(y[j], basis[j]);
+    }
+    ritz_eigs[k] = eigs[perm[k]];
+
+    kmat->mult(ritz_vecs[k], res);
+    TacsScalar knorm = res->norm();
+    if (mmat) {
+      mmat->mult(ritz_vecs[k], eigvec);
+      res->axpy(-ritz_eigs[k], eigvec);
+    } else {
+      res->axpy(-ritz_eigs[k], ritz_vecs[k]);
+    }
+    ritz_errors[k] = res->norm();
+    if (TacsRealPart(knorm) > 0.0) {
+      ritz_errors[k] /= knorm;
+    }
+    if (TacsRealPart(ritz_errors[k]) > max_error) {
+      max_error = TacsRealPart(ritz_errors[k]);
+    }
+  }
+
+  delete[] Kr;
+  delete[] Mr;
+  delete[] eigs;
+  delete[] perm;
+
+  reduced_valid = (max_error <= basis_tol);
+
+  if (ksm_print) {
+    char line[256];
+    sprintf(line, "Reduced basis size %d: max residual %10.4e %s\n", n,
+            max_error, (reduced_valid ? "accepted" : "rejected"));
+    ksm_print->print(line);
+  }
+
+  return reduced_valid;
+}
+
 /*
   Solve the eigenvalue problem
 */
 void TACSFrequencyAnalysis::solve(KSMPrint *ksm_print, int print_level) {
   // Zero the variables
   assembler->zeroVariables();
+
+  // Try the reduced basis before the full eigensolver
+  if (max_basis > 0 && solveReduced(ksm_print)) {
+    updateTrackedModes();
+    return;
+  }
+
   if (jd) {
     if (mg) {
       // Assemble the mass matrix
@@ -827,14 +1859,26 @@ void TACSFrequencyAnalysis::solve(KSMPrint *ksm_print, int print_level) {
       t0 = MPI_Wtime();
     }
 
-    // Solve the problem using Jacobi-Davidson
-    jd->solve(ksm_print, print_level);
+    if (lobpcg) {
+      // Set up the preconditioner for the shifted operator. With
+      // multigrid, the preconditioner has already been set up.
+      if (!mg) {
+        jd_op->setEigenvalueEstimate(TacsRealPart(sigma));
+      }
+
+      // Solve the problem using LOBPCG
+      lobpcg->solve(ksm_print, print_level);
+    } else {
+      // Solve the problem using Jacobi-Davidson
+      jd->solve(ksm_print, print_level);
+    }
 
     if (ksm_print && print_level > 0) {
       t0 = MPI_Wtime() - t0;
 
       char line[256];
-      sprintf(line, "JD computational time: %15.6f\n", t0);
+      sprintf(line, "%s computational time: %15.6f\n",
+              (lobpcg ? "LOBPCG" : "JD"), t0);
       ksm_print->print(line);
     }
   } else {
@@ -850,6 +1894,15 @@ void TACSFrequencyAnalysis::solve(KSMPrint *ksm_print, int print_level) {
 
       // Assemble the linear combination
       mg->assembleMatCombo(matTypes, scale, 2);
+    } else if (factor_cache) {
+      // Assemble the mass matrix and factor the shifted operator in
+      // the shared matrix, re-using the factorization when possible
+      ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX, TACS_MASS_MATRIX};
+      TacsScalar scale[2] = {1.0, -sigma};
+      if (mmat) {
+        assembler->assembleMatType(TACS_MASS_MATRIX, mmat);
+      }
+      factor_cache->factor((mmat ? 2 : 1), matTypes, scale);
     } else {
       // Assemble the stiffness and mass matrices
       assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
@@ -870,8 +1923,10 @@ void TACSFrequencyAnalysis::solve(KSMPrint *ksm_print, int print_level) {
       t0 = MPI_Wtime();
     }
 
-    // Factor the preconditioner
-    pc->factor();
+    // Factor the preconditioner, unless it is owned by the shared cache
+    if (mg || !factor_cache) {
+      pc->factor();
+    }
 
     // Solve the problem using Jacobi-Davidson
     sep->solve(ksm_print);
@@ -884,13 +1939,28 @@ void TACSFrequencyAnalysis::solve(KSMPrint *ksm_print, int print_level) {
       ksm_print->print(line);
     }
   }
+
+  // Cache the new eigenvectors in the reduced basis
+  if (max_basis > 0) {
+    updateReducedBasis();
+  }
+
+  // Save the eigenvectors for the next solve
+  updateTrackedModes();
 }
 
 /*!
   Extract the eigenvalue from the analysis
 */
 TacsScalar TACSFrequencyAnalysis::extractEigenvalue(int n, TacsScalar *error) {
-  if (sep) {
+  if (reduced_valid && n >= 0 && n < num_eigvals) {
+    if (error) {
+      *error = ritz_errors[n];
+    }
+    return ritz_eigs[n];
+  } else if (lobpcg) {
+    return lobpcg->extractEigenvalue(n, error);
+  } else if (sep) {
     return sep->extractEigenvalue(n, error);
   } else {
     // Error should be NULL unless needed
@@ -903,7 +1973,15 @@ TacsScalar TACSFrequencyAnalysis::extractEigenvalue(int n, TacsScalar *error) {
 */
 TacsScalar TACSFrequencyAnalysis::extractEigenvector(int n, TACSBVec *ans,
                                                      TacsScalar *error) {
-  if (sep) {
+  if (reduced_valid && n >= 0 && n < num_eigvals) {
+    if (error) {
+      *error = ritz_errors[n];
+    }
+    ans->copyValues(ritz_vecs[n]);
+    return ritz_eigs[n];
+  } else if (lobpcg) {
+    return lobpcg->extractEigenvector(n, ans, error);
+  } else if (sep) {
     return sep->extractEigenvector(n, ans, error);
   } else {
     // Error should be NULL unless needed
@@ -1018,6 +2096,102 @@ void TACSFrequencyAnalysis::evalEigenXptSens(int n, TACSBVec *dfdXpt) {
   dfdXpt->scale(scale);
 }
 
+/*
+  Evaluate the derivatives of several eigenvalues with respect to the
+  design variables.
+
+  This is equivalent to calling evalEigenDVSens() for each mode, but
+  the inner products for all the modes are evaluated within a single
+  pass over the elements.
+
+  input:
+  num_modes:  the number of modes
+  modes:      the indices of the modes
+
+  output:
+  dfdx:       the derivative of each eigenvalue
+*/
+void TACSFrequencyAnalysis::evalEigenDVSensMulti(int num_modes,
+                                                 const int *modes,
+                                                 TACSBVec **dfdx) {
+  evalEigenSensMulti(num_modes, modes, dfdx, NULL);
+}
+
+/*
+  Evaluate the derivatives of several eigenvalues with respect to the
+  node locations. This is equivalent to calling evalEigenXptSens() for
+  each mode.
+*/
+void TACSFrequencyAnalysis::evalEigenXptSensMulti(int num_modes,
+                                                  const int *modes,
+                                                  TACSBVec **dfdXpt) {
+  evalEigenSensMulti(num_modes, modes, NULL, dfdXpt);
+}
+
+/*
+  Evaluate the derivatives of the eigenvalues with respect to either
+  the design variables or the node locations
+*/
+void TACSFrequencyAnalysis::evalEigenSensMulti(int num_modes,
+                                               const int *modes,
+                                               TACSBVec **dfdx,
+                                               TACSBVec **dfdXpt) {
+  if (num_modes <= 0) {
+    return;
+  }
+
+  // Extract the eigenvectors and compute the inner products u^{T}*M*u
+  TACSBVec **vecs = new TACSBVec *[num_modes];
+  TacsScalar *norms = new TacsScalar[3 * num_modes];
+  TacsScalar *scale = &norms[num_modes];
+  for (int k = 0; k < num_modes; k++) {
+    vecs[k] = assembler->createVec();
+    vecs[k]->incref();
+
+    TacsScalar error;
+    TacsScalar eig = extractEigenvector(modes[k], vecs[k], &error);
+    if (mmat) {
+      mmat->mult(vecs[k], res);
+    } else {
+      res->copyValues(vecs[k]);
+    }
+    norms[k] = res->dot(vecs[k]);
+    scale[2 * k] = 1.0;
+    scale[2 * k + 1] = -TacsRealPart(eig);
+  }
+
+  // Evaluate the partial derivatives for the stiffness and mass
+  // matrices for all the modes
+  ElementMatrixType matTypes[2] = {TACS_STIFFNESS_MATRIX, TACS_MASS_MATRIX};
+  if (dfdx) {
+    for (int k = 0; k < num_modes; k++) {
+      dfdx[k]->zeroEntries();
+    }
+    assembler->addMatDVSensInnerProducts(2, matTypes, num_modes, scale, vecs,
+                                         vecs, dfdx);
+  } else {
+    for (int k = 0; k < num_modes; k++) {
+      dfdXpt[k]->zeroEntries();
+    }
+    assembler->addMatXptSensInnerProducts(2, matTypes, num_modes, scale, vecs,
+                                          vecs, dfdXpt);
+  }
+
+  // Finish computing the derivatives
+  for (int k = 0; k < num_modes; k++) {
+    TACSBVec *vec = (dfdx ? dfdx[k] : dfdXpt[k]);
+    vec->beginSetValues(TACS_ADD_VALUES);
+    vec->endSetValues(TACS_ADD_VALUES);
+    vec->scale(1.0 / norms[k]);
+  }
+
+  for (int k = 0; k < num_modes; k++) {
+    vecs[k]->decref();
+  }
+  delete[] vecs;
+  delete[] norms;
+}
+
 /*!
   Check the actual residual for the given eigenvalue
 */
@@ -1028,6 +2202,9 @@ void TACSFrequencyAnalysis::checkEigenvector(int n) {
   if (mmat) {
     assembler->assembleMatType(TACS_MASS_MATRIX, mmat);
   }
+  if (factor_cache) {
+    factor_cache->invalidate();
+  }
 
   // Create temporary arrays required
   TACSBVec *t1 = assembler->createVec();
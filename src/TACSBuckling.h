@@ -26,7 +26,10 @@
 
 #include "GSEP.h"
 #include "JacobiDavidson.h"
+#include "LOBPCG.h"
 #include "TACSAssembler.h"
+#include "TACSFactorCache.h"
+#include "TACSMatrixFreeMat.h"
 #include "TACSMg.h"
 
 /*
@@ -57,6 +60,19 @@ class TACSLinearBuckling : public TACSObject {
   TacsScalar getSigma();
   void setSigma(TacsScalar sigma);
 
+  // Use the thick-restart block Lanczos eigensolver
+  // ------------------------------------------------
+  void setBlockLanczos(int block_size, int max_restarts = 25);
+
+  // Warm-start the eigensolver and track the modes between solves
+  // --------------------------------------------------------------
+  void setWarmStart(int warm_start);
+  int getTrackedMode(int n, TacsScalar *mac = NULL);
+
+  // Share the direct factorization with other analyses
+  // --------------------------------------------------
+  void setFactorCache(TACSFactorCache *cache);
+
   // Solve the eigenvalue problem
   // ----------------------------
   void solve(TACSVec *rhs = NULL, TACSVec *u0 = NULL,
@@ -67,6 +83,15 @@ class TACSLinearBuckling : public TACSObject {
   void addEigenDVSens(TacsScalar coef, int n, TACSBVec *dfdx);
   void addEigenXptSens(TacsScalar coef, int n, TACSBVec *dfdX);
 
+  // Evaluate the derivatives for several modes at once
+  // --------------------------------------------------
+  void evalEigenDVSensMulti(int num_modes, const int *modes, TACSBVec **dfdx);
+  void evalEigenXptSensMulti(int num_modes, const int *modes, TACSBVec **dfdX);
+  void addEigenDVSensMulti(TacsScalar coef, int num_modes, const int *modes,
+                           TACSBVec **dfdx);
+  void addEigenXptSensMulti(TacsScalar coef, int num_modes, const int *modes,
+                            TACSBVec **dfdX);
+
   // Extract the eigenvalue or check the solution
   // --------------------------------------------
   TacsScalar extractEigenvalue(int n, TacsScalar *error);
@@ -96,6 +121,9 @@ class TACSLinearBuckling : public TACSObject {
   TACSKsm *solver;
   TACSMat *aux_mat, *kmat, *gmat;
 
+  // The geometric stiffness matrix when it is computed matrix-free
+  TACSMatrixFreeMat *gmat_free;
+
   // Vectors used in the analysis
   TACSBVec *path;  // The solution path
   TACSBVec *res, *update, *eigvec;
@@ -103,6 +131,22 @@ class TACSLinearBuckling : public TACSObject {
   // The multigrid object -- only defined if a multigrid
   // preconditioner is used
   TACSMg *mg;
+
+  // The factorization shared with other analyses
+  TACSFactorCache *factor_cache;
+
+  // Evaluate the derivatives for several modes w.r.t. dvs or nodes
+  void evalEigenSensMulti(int num_modes, const int *modes, TACSBVec **dfdx,
+                          TACSBVec **dfdX);
+
+  // Save the eigenvectors and match them with the saved eigenvectors
+  void updateTrackedModes();
+
+  // Data for warm-starting the eigensolver and tracking the modes
+  int num_tracked, tracked_valid;
+  TACSBVec **tracked_vecs;
+  int *tracked_modes;
+  TacsScalar *tracked_mac;
 };
 
 /*!
@@ -148,9 +192,30 @@ class TACSFrequencyAnalysis : public TACSObject {
   // ----------------------------------------
   TacsScalar getSigma();
   void setSigma(TacsScalar _sigma);
+  void setBlockLanczos(int block_size, int max_restarts = 25);
+  void setLOBPCG(int block_size, int max_iters = 200);
+  void setJDInnerSolver(int num_inner_recycle, double shift_rtol = -1.0);
   void solve(KSMPrint *ksm_print = NULL, int print_level = 0);
   void evalEigenDVSens(int n, TACSBVec *dfdx);
   void evalEigenXptSens(int n, TACSBVec *dfdX);
+  void evalEigenDVSensMulti(int num_modes, const int *modes, TACSBVec **dfdx);
+  void evalEigenXptSensMulti(int num_modes, const int *modes, TACSBVec **dfdX);
+
+  // Warm-start the eigensolver and track the modes between solves
+  // --------------------------------------------------------------
+  void setWarmStart(int warm_start);
+  int getTrackedMode(int n, TacsScalar *mac = NULL);
+
+  // Share the direct factorization with other analyses
+  // --------------------------------------------------
+  void setFactorCache(TACSFactorCache *cache);
+
+  // Solve with a reduced basis of the cached modes and static shapes
+  // ----------------------------------------------------------------
+  void setReducedBasis(int max_basis_size, double basis_tol);
+  void addReducedBasisVectors(int nvecs, TACSBVec **vecs);
+  int getReducedBasisSize() { return num_basis; }
+  int isReducedSolution() { return reduced_valid; }
 
   // Extract and check the solution
   // ------------------------------
@@ -174,6 +239,9 @@ class TACSFrequencyAnalysis : public TACSObject {
   // preconditioner is used
   TACSMg *mg;
 
+  // The factorization shared with other analyses
+  TACSFactorCache *factor_cache;
+
   // The eigen solver
   TacsScalar sigma;
   EPGeneralizedShiftInvert *ep_op;
@@ -184,8 +252,47 @@ class TACSFrequencyAnalysis : public TACSObject {
   TACSJDFrequencyOperator *jd_op;
   TACSJacobiDavidson *jd;
 
+  // The LOBPCG solver that uses the Jacobi-Davidson operator
+  TACSLOBPCG *lobpcg;
+  double lobpcg_tol;
+
   // Vectors required for eigen-sensitivity analysis
   TACSBVec *eigvec, *res;
+
+  // The number of eigenvalues requested
+  int num_eigvals;
+
+  // Evaluate the derivatives for several modes w.r.t. dvs or nodes
+  void evalEigenSensMulti(int num_modes, const int *modes, TACSBVec **dfdx,
+                          TACSBVec **dfdX);
+
+  // Save the eigenvectors and match them with the saved eigenvectors
+  void updateTrackedModes();
+
+  // Data for warm-starting the eigensolver and tracking the modes
+  int num_tracked, tracked_valid;
+  TACSBVec **tracked_vecs;
+  int *tracked_modes;
+  TacsScalar *tracked_mac;
+
+  // Solve the eigenproblem projected onto the reduced basis
+  int solveReduced(KSMPrint *ksm_print);
+
+  // Add an orthonormalized vector to the reduced basis
+  int addBasisVector(TACSVec *vec);
+
+  // Replace the cached modes in the reduced basis
+  void updateReducedBasis();
+
+  // The reduced basis: the static shapes followed by the cached modes
+  int max_basis, num_basis, num_static;
+  double basis_tol;
+  TACSVec **basis;
+
+  // The Ritz values, errors and vectors from the reduced solve
+  int reduced_valid;
+  TacsScalar *ritz_eigs, *ritz_errors;
+  TACSBVec **ritz_vecs;
 };
 
 #endif  // TACS_BUCKLING_H
@@ -0,0 +1,366 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSCommProfiler.h"
+
+/*
+  The values recorded for each category and each neighbor
+*/
+enum TacsCommTotal {
+  TACS_COMM_SENDS = 0,
+  TACS_COMM_SEND_BYTES,
+  TACS_COMM_RECVS,
+  TACS_COMM_RECV_BYTES,
+  TACS_COMM_COLLECTIVES,
+  TACS_COMM_COLLECTIVE_BYTES,
+  TACS_COMM_WAIT_TIME,
+  TACS_COMM_NUM_TOTALS
+};
+
+// The number of values stored for each neighbor. These are the first
+// entries of the totals.
+static const int TACS_COMM_NUM_NEIGHBOR_VALUES = 4;
+
+static const char *comm_names[] = {"halo", "mat_assembly", "reduction",
+                                   "dense_factor"};
+
+static const char *comm_keys[] = {
+    "sends",       "send_bytes",       "recvs",    "recv_bytes",
+    "collectives", "collective_bytes", "wait_time"};
+
+// The totals for each category and the values for each neighbor,
+// stored by the rank of the neighbor
+static pthread_mutex_t comm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static double comm_totals[TACS_COMM_NUM_CATEGORIES][TACS_COMM_NUM_TOTALS];
+static int comm_max_ranks[TACS_COMM_NUM_CATEGORIES];
+static double *comm_neighbors[TACS_COMM_NUM_CATEGORIES];
+
+/*
+  Check the environment for the initial flag
+*/
+static int TacsCommInitialFlag() {
+  const char *value = getenv("TACS_COMM_PROFILE");
+  if (value && atoi(value) != 0) {
+    return 1;
+  }
+  return 0;
+}
+
+int TACSCommProfiler::enabled = TacsCommInitialFlag();
+
+/*
+  Get the values for the neighbor, extending the array if required.
+  This must be called with the mutex held.
+*/
+static double *TacsCommGetNeighbor(int category, int rank) {
+  const int nv = TACS_COMM_NUM_NEIGHBOR_VALUES;
+  if (rank >= comm_max_ranks[category]) {
+    int max_ranks = 2 * comm_max_ranks[category];
+    if (max_ranks <= rank) {
+      max_ranks = rank + 16;
+    }
+    double *temp = new double[nv * max_ranks];
+    memset(temp, 0, nv * max_ranks * sizeof(double));
+    if (comm_neighbors[category]) {
+      memcpy(temp, comm_neighbors[category],
+             nv * comm_max_ranks[category] * sizeof(double));
+      delete[] comm_neighbors[category];
+    }
+    comm_neighbors[category] = temp;
+    comm_max_ranks[category] = max_ranks;
+  }
+  return &comm_neighbors[category][nv * rank];
+}
+
+/*
+  Enable or disable the recording
+
+  @param flag Flag indicating whether to record the communication
+*/
+void TACSCommProfiler::setEnabled(int flag) { enabled = (flag ? 1 : 0); }
+
+/*
+  Record a message sent to the destination rank
+
+  @param category The category of the communication
+  @param dest The rank of the destination in the communicator
+  @param bytes The size of the message in bytes
+*/
+void TACSCommProfiler::addSend(int category, int dest, size_t bytes) {
+  if (!enabled || category < 0 || category >= TACS_COMM_NUM_CATEGORIES ||
+      dest < 0) {
+    return;
+  }
+  pthread_mutex_lock(&comm_mutex);
+  double *nbr = TacsCommGetNeighbor(category, dest);
+  nbr[TACS_COMM_SENDS] += 1.0;
+  nbr[TACS_COMM_SEND_BYTES] += bytes;
+  comm_totals[category][TACS_COMM_SENDS] += 1.0;
+  comm_totals[category][TACS_COMM_SEND_BYTES] += bytes;
+  pthread_mutex_unlock(&comm_mutex);
+}
+
+/*
+  Record a message received from the source rank
+
+  @param category The category of the communication
+  @param source The rank of the source in the communicator
+  @param bytes The size of the message in bytes
+*/
+void TACSCommProfiler::addRecv(int category, int source, size_t bytes) {
+  if (!enabled || category < 0 || category >= TACS_COMM_NUM_CATEGORIES ||
+      source < 0) {
+    return;
+  }
+  pthread_mutex_lock(&comm_mutex);
+  double *nbr = TacsCommGetNeighbor(category, source);
+  nbr[TACS_COMM_RECVS] += 1.0;
+  nbr[TACS_COMM_RECV_BYTES] += bytes;
+  comm_totals[category][TACS_COMM_RECVS] += 1.0;
+  comm_totals[category][TACS_COMM_RECV_BYTES] += bytes;
+  pthread_mutex_unlock(&comm_mutex);
+}
+
+/*
+  Record a collective operation
+
+  @param category The category of the communication
+  @param bytes The size of the local contribution in bytes
+*/
+void TACSCommProfiler::addCollective(int category, size_t bytes) {
+  if (!enabled || category < 0 || category >= TACS_COMM_NUM_CATEGORIES) {
+    return;
+  }
+  pthread_mutex_lock(&comm_mutex);
+  comm_totals[category][TACS_COMM_COLLECTIVES] += 1.0;
+  comm_totals[category][TACS_COMM_COLLECTIVE_BYTES] += bytes;
+  pthread_mutex_unlock(&comm_mutex);
+}
+
+/*
+  Record the time spent waiting since the call to beginWait()
+
+  @param category The category of the communication
+  @param t0 The value returned by beginWait()
+*/
+void TACSCommProfiler::endWait(int category, double t0) {
+  if (!enabled || category < 0 || category >= TACS_COMM_NUM_CATEGORIES) {
+    return;
+  }
+  double t = MPI_Wtime() - t0;
+  pthread_mutex_lock(&comm_mutex);
+  comm_totals[category][TACS_COMM_WAIT_TIME] += t;
+  pthread_mutex_unlock(&comm_mutex);
+}
+
+/*
+  Discard all recorded values
+*/
+void TACSCommProfiler::reset() {
+  pthread_mutex_lock(&comm_mutex);
+  for (int k = 0; k < TACS_COMM_NUM_CATEGORIES; k++) {
+    memset(comm_totals[k], 0, TACS_COMM_NUM_TOTALS * sizeof(double));
+    if (comm_neighbors[k]) {
+      delete[] comm_neighbors[k];
+    }
+    comm_neighbors[k] = NULL;
+    comm_max_ranks[k] = 0;
+  }
+  pthread_mutex_unlock(&comm_mutex);
+}
+
+/*
+  Get the name of the category
+*/
+const char *TACSCommProfiler::getCategoryName(int category) {
+  if (category < 0 || category >= TACS_COMM_NUM_CATEGORIES) {
+    return "unknown";
+  }
+  return comm_names[category];
+}
+
+/*
+  Count the neighbors that have exchanged messages in the category.
+  This must be called with the mutex held.
+*/
+static int TacsCommCountNeighbors(int category) {
+  const int nv = TACS_COMM_NUM_NEIGHBOR_VALUES;
+  int count = 0;
+  for (int i = 0; i < comm_max_ranks[category]; i++) {
+    const double *nbr = &comm_neighbors[category][nv * i];
+    if (nbr[TACS_COMM_SENDS] > 0.0 || nbr[TACS_COMM_RECVS] > 0.0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/*
+  Print the number of messages, the megabytes sent and received, the
+  number of neighbors, the number of collectives and the wait time for
+  each category with the average and maximum over the processes in the
+  communicator. A large ratio of the maximum to the average indicates
+  an imbalance in the partition.
+
+  This call is collective on comm.
+*/
+void TACSCommProfiler::printSummary(MPI_Comm comm, FILE *fp) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // The messages, megabytes, neighbors, collectives and wait time
+  const int nk = 5;
+  const int n = nk * TACS_COMM_NUM_CATEGORIES;
+  double local[n], vmax[n], vsum[n];
+  pthread_mutex_lock(&comm_mutex);
+  for (int k = 0; k < TACS_COMM_NUM_CATEGORIES; k++) {
+    const double *t = comm_totals[k];
+    local[nk * k] = t[TACS_COMM_SENDS] + t[TACS_COMM_RECVS];
+    local[nk * k + 1] =
+        (t[TACS_COMM_SEND_BYTES] + t[TACS_COMM_RECV_BYTES]) / (1024.0 * 1024.0);
+    local[nk * k + 2] = TacsCommCountNeighbors(k);
+    local[nk * k + 3] = t[TACS_COMM_COLLECTIVES];
+    local[nk * k + 4] = t[TACS_COMM_WAIT_TIME];
+  }
+  pthread_mutex_unlock(&comm_mutex);
+
+  MPI_Reduce(local, vmax, n, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(local, vsum, n, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+  if (rank == 0 && fp) {
+    fprintf(fp, "TACSCommProfiler: Communication per process\n");
+    fprintf(fp, "%-13s %10s %10s %10s %10s %8s %8s %10s %10s %10s\n",
+            "category", "msgs avg", "msgs max", "MB avg", "MB max",
+            "nbrs avg", "nbrs max", "coll avg", "wait avg", "wait max");
+    for (int k = 0; k < TACS_COMM_NUM_CATEGORIES; k++) {
+      const double *mx = &vmax[nk * k];
+      const double *sm = &vsum[nk * k];
+      fprintf(fp,
+              "%-13s %10.1f %10.0f %10.3f %10.3f %8.1f %8.0f %10.1f %10.4f "
+              "%10.4f\n",
+              comm_names[k], sm[0] / size, mx[0], sm[1] / size, mx[1],
+              sm[2] / size, mx[2], sm[3] / size, sm[4] / size, mx[4]);
+    }
+    fflush(fp);
+  }
+}
+
+/*
+  Write the totals for each process and the values for each of its
+  neighbors to a JSON file on the root process
+
+  The values are packed into a single array on each process and
+  gathered on the root. This call is collective on comm.
+
+  @param comm The communicator
+  @param filename The name of the file
+  @return Zero on success, non-zero if the file could not be opened
+*/
+int TACSCommProfiler::writeJSON(MPI_Comm comm, const char *filename) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const int nt = TACS_COMM_NUM_TOTALS;
+  const int nv = TACS_COMM_NUM_NEIGHBOR_VALUES;
+
+  // Pack the totals, the number of neighbors in each category and
+  // then the rank and values for each neighbor
+  pthread_mutex_lock(&comm_mutex);
+  int num_nbrs[TACS_COMM_NUM_CATEGORIES];
+  int len = (nt + 1) * TACS_COMM_NUM_CATEGORIES;
+  for (int k = 0; k < TACS_COMM_NUM_CATEGORIES; k++) {
+    num_nbrs[k] = TacsCommCountNeighbors(k);
+    len += (nv + 1) * num_nbrs[k];
+  }
+
+  double *local = new double[len];
+  int pos = 0;
+  for (int k = 0; k < TACS_COMM_NUM_CATEGORIES; k++) {
+    memcpy(&local[pos], comm_totals[k], nt * sizeof(double));
+    pos += nt;
+    local[pos] = num_nbrs[k];
+    pos++;
+    for (int i = 0; i < comm_max_ranks[k]; i++) {
+      const double *nbr = &comm_neighbors[k][nv * i];
+      if (nbr[TACS_COMM_SENDS] > 0.0 || nbr[TACS_COMM_RECVS] > 0.0) {
+        local[pos] = i;
+        memcpy(&local[pos + 1], nbr, nv * sizeof(double));
+        pos += nv + 1;
+      }
+    }
+  }
+  pthread_mutex_unlock(&comm_mutex);
+
+  // Gather the values on the root
+  int *lens = NULL, *ptr = NULL;
+  double *all = NULL;
+  if (rank == 0) {
+    lens = new int[size];
+    ptr = new int[size + 1];
+  }
+  MPI_Gather(&len, 1, MPI_INT, lens, 1, MPI_INT, 0, comm);
+  if (rank == 0) {
+    ptr[0] = 0;
+    for (int k = 0; k < size; k++) {
+      ptr[k + 1] = ptr[k] + lens[k];
+    }
+    all = new double[ptr[size]];
+  }
+  MPI_Gatherv(local, len, MPI_DOUBLE, all, lens, ptr, MPI_DOUBLE, 0, comm);
+  delete[] local;
+
+  int fail = 0;
+  if (rank == 0) {
+    FILE *fp = fopen(filename, "w");
+    if (fp) {
+      fprintf(fp, "{\n  \"num_ranks\": %d,\n  \"ranks\": [", size);
+      for (int p = 0; p < size; p++) {
+        const double *v = &all[ptr[p]];
+        fprintf(fp, "%s\n    {\"rank\": %d", (p == 0 ? "" : ","), p);
+        for (int k = 0; k < TACS_COMM_NUM_CATEGORIES; k++) {
+          fprintf(fp, ",\n     \"%s\": {", comm_names[k]);
+          for (int j = 0; j < nt; j++) {
+            fprintf(fp, "\"%s\": %.9e, ", comm_keys[j], v[j]);
+          }
+          int nn = (int)v[nt];
+          v += nt + 1;
+          fprintf(fp, "\"neighbors\": [");
+          for (int i = 0; i < nn; i++, v += nv + 1) {
+            fprintf(fp, "%s\n       {\"rank\": %d", (i == 0 ? "" : ","),
+                    (int)v[0]);
+            for (int j = 0; j < nv; j++) {
+              fprintf(fp, ", \"%s\": %.9e", comm_keys[j], v[j + 1]);
+            }
+            fprintf(fp, "}");
+          }
+          fprintf(fp, "]}");
+        }
+        fprintf(fp, "}");
+      }
+      fprintf(fp, "\n  ]\n}\n");
+      fclose(fp);
+    } else {
+      fprintf(stderr, "TACSCommProfiler: Could not open file %s\n", filename);
+      fail = 1;
+    }
+    delete[] lens;
+    delete[] ptr;
+    delete[] all;
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+
+  return fail;
+}
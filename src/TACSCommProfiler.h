@@ -0,0 +1,88 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_COMM_PROFILER_H
+#define TACS_COMM_PROFILER_H
+
+#include "TACSObject.h"
+
+/*
+  The types of communication that are recorded
+*/
+enum TACSCommCategory {
+  TACS_COMM_HALO = 0,      // Vector ghost exchange in TACSBVecDistribute
+  TACS_COMM_MAT_ASSEMBLY,  // Off-process matrix entries in TACSMatDistribute
+  TACS_COMM_REDUCTION,     // Norms and dot products of the vectors
+  TACS_COMM_DENSE_FACTOR,  // Panel exchange in the block-cyclic factorization
+  TACS_COMM_NUM_CATEGORIES
+};
+
+/*
+  A global account of the MPI traffic on this process
+
+  For each category, the number of messages and bytes sent to and
+  received from each neighbor are recorded, along with the number of
+  collective operations, their size and the time spent waiting for
+  the communication to complete. The neighbor ranks are the ranks in
+  the communicator used for the operation, which is the communicator
+  of the assembler in the usual case.
+
+  Recording is disabled by default. It can be enabled at run time with
+  TACSCommProfiler::setEnabled() or by setting the environment
+  variable TACS_COMM_PROFILE to a non-zero value. When disabled, the
+  hooks cost a single flag check.
+
+  printSummary() prints the minimum, maximum and average values over
+  the processes, while writeJSON() writes the values from each process
+  and each of its neighbors to a single file on the root.
+*/
+class TACSCommProfiler {
+ public:
+  // Enable or disable the recording
+  // -------------------------------
+  static void setEnabled(int flag);
+  static int isEnabled() { return enabled; }
+
+  // Record the point-to-point messages
+  // ----------------------------------
+  static void addSend(int category, int dest, size_t bytes);
+  static void addRecv(int category, int source, size_t bytes);
+
+  // Record a collective operation
+  // -----------------------------
+  static void addCollective(int category, size_t bytes);
+
+  // Time the waits for communication to complete
+  // --------------------------------------------
+  static double beginWait() { return (enabled ? MPI_Wtime() : 0.0); }
+  static void endWait(int category, double t0);
+
+  // Discard all recorded values
+  // ---------------------------
+  static void reset();
+
+  // Get the name of the category
+  // ----------------------------
+  static const char *getCategoryName(int category);
+
+  // Print or write the values over all processes
+  // --------------------------------------------
+  static void printSummary(MPI_Comm comm, FILE *fp = stdout);
+  static int writeJSON(MPI_Comm comm, const char *filename);
+
+ private:
+  static int enabled;
+};
+
+#endif  // TACS_COMM_PROFILER_H
@@ -192,6 +192,28 @@ TACSContinuation::TACSContinuation(TACSAssembler *_assembler,
   term_function = NULL;
   term_function_value = 1.0;
   dlambda_ds_term_value = -1e20;
+
+  // No acceleration by default
+  anderson = NULL;
+
+  // Fixed step size, tangent predictor and a factorization every step
+  adapt_target_iters = 0;
+  adapt_min_scale = 0.25;
+  adapt_max_scale = 2.0;
+  use_secant = 0;
+  max_reuse_steps = 0;
+  num_factorizations = 0;
+
+  // No branch switching by default
+  branch_mode = NULL;
+  branch_perturb = 0.0;
+
+  // No restart output by default
+  restart_fname[0] = '\0';
+  restart_freq = 0;
+  restart_iter = 0;
+  restart_vars = restart_tangent = NULL;
+  restart_lambda = restart_dlambda_ds = restart_delta_r = 0.0;
 }
 
 TACSContinuation::~TACSContinuation() {
@@ -203,6 +225,18 @@ TACSContinuation::~TACSContinuation() {
   if (term_function) {
     term_function->decref();
   }
+  if (anderson) {
+    anderson->decref();
+  }
+  if (branch_mode) {
+    branch_mode->decref();
+  }
+  if (restart_vars) {
+    restart_vars->decref();
+  }
+  if (restart_tangent) {
+    restart_tangent->decref();
+  }
 }
 
 /**
@@ -222,11 +256,294 @@ void TACSContinuation::setTermLambdaRate(TacsScalar term_dlambda_ds) {
   dlambda_ds_term_value = term_dlambda_ds;
 }
 
+/**
+  Accelerate the Newton iterations with Anderson acceleration
+
+  The initial Newton iterations and the corrector iterations use a
+  factorization that is frozen within each load step. Anderson
+  acceleration of the updates, including the load factor update,
+  reduces the number of corrector iterations and the number of step
+  size reductions. A depth of zero turns off the acceleration.
+
+  @param depth The number of previous updates that are stored
+*/
+void TACSContinuation::setAndersonAcceleration(int depth) {
+  if (anderson) {
+    anderson->decref();
+    anderson = NULL;
+  }
+  if (depth > 0) {
+    anderson = new TACSAndersonAcceleration(assembler, depth);
+    anderson->incref();
+  }
+}
+
+/**
+  Adapt the arc-length based on the number of corrector iterations
+
+  After each converged step, the arc-length is scaled by the ratio
+  sqrt(target_iters/iters), bounded by the min and max scale factors,
+  where iters is the number of corrector iterations that were
+  required. When the step size had to be reduced to converge, the
+  arc-length is reduced by the min scale factor.
+
+  @param target_iters The desired number of corrector iterations (0 = off)
+  @param min_scale The minimum ratio between successive arc-lengths
+  @param max_scale The maximum ratio between successive arc-lengths
+*/
+void TACSContinuation::setAdaptiveStepSize(int target_iters, double min_scale,
+                                           double max_scale) {
+  adapt_target_iters = (target_iters > 0 ? target_iters : 0);
+  adapt_min_scale = min_scale;
+  adapt_max_scale = max_scale;
+}
+
+/**
+  Use the secant through the last two points on the path as the
+  predictor
+
+  The secant predictor replaces the linear solve for the tangent at
+  the start of each step after the first, and is normalized in the
+  same way as the tangent.
+
+  @param _use_secant Flag to indicate whether to use the secant predictor
+*/
+void TACSContinuation::setSecantPredictor(int _use_secant) {
+  use_secant = _use_secant;
+}
+
+/**
+  Reuse the factorization of the Jacobian over several steps
+
+  The Jacobian is re-assembled and factored when the factorization has
+  been used for max_steps steps, when the last corrector needed more
+  than half the maximum number of corrector iterations, or when the
+  corrector fails with an old factorization. Otherwise, the predictor
+  and the corrector use the factorization from an earlier point on
+  the path.
+
+  @param max_steps The maximum number of steps that reuse the factorization
+*/
+void TACSContinuation::setJacobianReuse(int max_steps) {
+  max_reuse_steps = (max_steps > 0 ? max_steps : 0);
+}
+
+/**
+  Switch to the branch that bifurcates along the given mode
+
+  The mode is typically an eigenvector from TACSLinearBuckling. The
+  stiffness along the mode, m^{T} J m/m^{T} m, is computed each time
+  the Jacobian is factored. When it changes sign, a bifurcation point
+  has been passed, and the predictor is deflected along the mode by a
+  fraction of its length so that the continuation follows the
+  bifurcated branch. The switch is only performed once per solve.
+
+  @param mode The buckling mode (NULL turns off branch switching)
+  @param perturb The relative size of the deflection of the predictor
+*/
+void TACSContinuation::setBranchSwitch(TACSBVec *mode, TacsScalar perturb) {
+  if (mode) {
+    mode->incref();
+  }
+  if (branch_mode) {
+    branch_mode->decref();
+  }
+  branch_mode = mode;
+  branch_perturb = perturb;
+}
+
+/*
+  The header block of the continuation restart files. The load factor
+  history for the completed iterations follows the header.
+*/
+struct TACSContinuationRestartHeader {
+  int iter;  // The next continuation iteration
+  int max_continuation_iters;
+  int max_correction_iters;
+  int max_correction_restarts;
+  double correction_rtol, correction_dtol;
+  double krylov_rtol, krylov_atol;
+  double tangent_rtol, tangent_atol;
+  TacsScalar lambda, dlambda_ds;
+  TacsScalar target_delta_r;
+};
+
+/**
+  Write a restart file periodically during solve_tangent()
+
+  @param filename The restart file, which is overwritten each time
+  @param _restart_freq The number of iterations between writes (0 = off)
+*/
+void TACSContinuation::setRestartOutput(const char *filename,
+                                        int _restart_freq) {
+  restart_freq = 0;
+  if (filename) {
+    strncpy(restart_fname, filename, sizeof(restart_fname) - 1);
+    restart_fname[sizeof(restart_fname) - 1] = '\0';
+    restart_freq = _restart_freq;
+  }
+}
+
+/*
+  Write the point on the path, the tangent, the step size, the history,
+  the design variables, the node locations and the solver settings
+*/
+int TACSContinuation::writeRestart(const char *filename, int iter,
+                                   TACSBVec *vars, TACSBVec *tangent,
+                                   TacsScalar lambda, TacsScalar dlambda_ds,
+                                   TacsScalar target_delta_r) {
+  int hist_size = 2 * max_continuation_iters * sizeof(TacsScalar);
+  int size = sizeof(TACSContinuationRestartHeader) + hist_size;
+  char *data = new char[size];
+  memset(data, 0, size);
+
+  TACSContinuationRestartHeader *header = (TACSContinuationRestartHeader *)data;
+  header->iter = iter;
+  header->max_continuation_iters = max_continuation_iters;
+  header->max_correction_iters = max_correction_iters;
+  header->max_correction_restarts = max_correction_restarts;
+  header->correction_rtol = correction_rtol;
+  header->correction_dtol = correction_dtol;
+  header->krylov_rtol = krylov_rtol;
+  header->krylov_atol = krylov_atol;
+  header->tangent_rtol = tangent_rtol;
+  header->tangent_atol = tangent_atol;
+  header->lambda = lambda;
+  header->dlambda_ds = dlambda_ds;
+  header->target_delta_r = target_delta_r;
+
+  char *hist = &data[sizeof(TACSContinuationRestartHeader)];
+  memcpy(hist, lambda_history, max_continuation_iters * sizeof(TacsScalar));
+  memcpy(&hist[max_continuation_iters * sizeof(TacsScalar)],
+         dlambda_ds_history, max_continuation_iters * sizeof(TacsScalar));
+
+  TACSRestartFile *file = new TACSRestartFile(assembler->getMPIComm(),
+                                              filename, TACSRestartFile::WRITE);
+  file->incref();
+
+  int fail = file->writeHeader("TACSContinuation", data, size);
+  if (!fail) {
+    fail = file->writeVec(vars) || file->writeVec(tangent);
+  }
+  if (!fail) {
+    TACSBVec *dvs = assembler->createDesignVec();
+    dvs->incref();
+    assembler->getDesignVars(dvs);
+    fail = file->writeVec(dvs);
+    dvs->decref();
+  }
+  if (!fail) {
+    TACSBVec *X = assembler->createNodeVec();
+    X->incref();
+    assembler->getNodes(X);
+    fail = file->writeVec(X);
+    X->decref();
+  }
+
+  file->decref();
+  delete[] data;
+
+  return fail;
+}
+
+/**
+  Read a restart file written during solve_tangent()
+
+  The design variables, node locations and solver settings are
+  restored immediately. The next call to solve_tangent() skips the
+  initial Newton iterations and resumes the arc-length continuation
+  from the stored point on the path. The maximum number of
+  continuation iterations must match the value used to write the file.
+
+  @param filename The name of the restart file
+  @return Zero on success
+*/
+int TACSContinuation::readRestart(const char *filename) {
+  int hist_size = 2 * max_continuation_iters * sizeof(TacsScalar);
+  int size = sizeof(TACSContinuationRestartHeader) + hist_size;
+  char *data = new char[size];
+
+  TACSRestartFile *file = new TACSRestartFile(assembler->getMPIComm(),
+                                              filename, TACSRestartFile::READ);
+  file->incref();
+
+  int fail = file->readHeader("TACSContinuation", data, size);
+
+  TACSBVec *vars = assembler->createVec();
+  TACSBVec *tangent = assembler->createVec();
+  vars->incref();
+  tangent->incref();
+  if (!fail) {
+    fail = file->readVec(vars) || file->readVec(tangent);
+  }
+  if (!fail) {
+    TACSBVec *dvs = assembler->createDesignVec();
+    dvs->incref();
+    fail = file->readVec(dvs);
+    if (!fail) {
+      assembler->setDesignVars(dvs);
+    }
+    dvs->decref();
+  }
+  if (!fail) {
+    TACSBVec *X = assembler->createNodeVec();
+    X->incref();
+    fail = file->readVec(X);
+    if (!fail) {
+      assembler->setNodes(X);
+    }
+    X->decref();
+  }
+
+  file->decref();
+
+  if (!fail) {
+    TACSContinuationRestartHeader *header =
+        (TACSContinuationRestartHeader *)data;
+    max_correction_iters = header->max_correction_iters;
+    max_correction_restarts = header->max_correction_restarts;
+    correction_rtol = header->correction_rtol;
+    correction_dtol = header->correction_dtol;
+    krylov_rtol = header->krylov_rtol;
+    krylov_atol = header->krylov_atol;
+    tangent_rtol = header->tangent_rtol;
+    tangent_atol = header->tangent_atol;
+
+    int len = max_continuation_iters * sizeof(TacsScalar);
+    char *hist = &data[sizeof(TACSContinuationRestartHeader)];
+    memcpy(lambda_history, hist, len);
+    memcpy(dlambda_ds_history, &hist[len], len);
+
+    // Store the point on the path for the next call to solve_tangent()
+    restart_iter = header->iter;
+    restart_lambda = header->lambda;
+    restart_dlambda_ds = header->dlambda_ds;
+    restart_delta_r = header->target_delta_r;
+    if (restart_vars) {
+      restart_vars->decref();
+    }
+    if (restart_tangent) {
+      restart_tangent->decref();
+    }
+    restart_vars = vars;
+    restart_tangent = tangent;
+  } else {
+    vars->decref();
+    tangent->decref();
+  }
+
+  delete[] data;
+
+  return fail;
+}
+
 /**
   Retrieve information about the solve
 */
 int TACSContinuation::getNumIterations() { return iteration_count; }
 
+int TACSContinuation::getNumFactorizations() { return num_factorizations; }
+
 void TACSContinuation::getSolution(int iter, TacsScalar *lambda,
                                    TacsScalar *dlambda_ds) {
   if (iter >= 0 && iter < iteration_count) {
@@ -294,8 +611,14 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
   update->incref();
   res->incref();
 
+  // The derivative of the residuals w.r.t. lambda is -load
+  TACSBVec *neg_load = assembler->createVec();
+  neg_load->incref();
+  neg_load->copyValues(load);
+  neg_load->scale(-1.0);
+
   TACSContinuationPathMat *path_mat =
-      new TACSContinuationPathMat(mat, load, tangent, 0.0);
+      new TACSContinuationPathMat(mat, neg_load, tangent, 0.0);
   path_mat->incref();
 
   TacsScalar lambda = 0.0;          // The load factor
@@ -303,6 +626,22 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
   TacsScalar target_delta_r = 0.0;  // Target change in r = (u - u_k)^T(u - u_k)
 
   double t0 = MPI_Wtime();
+  num_factorizations = 0;
+
+  // Resume from the point on the path read from a restart file
+  int start_iter = 0;
+  if (restart_vars) {
+    start_iter = restart_iter;
+    vars->copyValues(restart_vars);
+    tangent->copyValues(restart_tangent);
+    lambda = restart_lambda;
+    target_delta_r = restart_delta_r;
+    restart_vars->decref();
+    restart_tangent->decref();
+    restart_vars = restart_tangent = NULL;
+    restart_iter = 0;
+    lambda_init = 0.0;
+  }
 
   if (lambda_init != 0.0) {
     lambda = lambda_init;
@@ -321,6 +660,7 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
     TacsScalar alpha = 1.0, beta = 0.0, gamma = 0.0;
     assembler->assembleJacobian(alpha, beta, gamma, res, mat);
     pc->factor();
+    num_factorizations++;
 
     // Compute the tangent vector
     ksm->solve(load, tangent);
@@ -330,6 +670,9 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
 
     // Compute the initial norm based on the tangent approximation
     TacsScalar res_norm_init = 1.0;
+    if (anderson) {
+      anderson->reset();
+    }
 
     // Now perform a Newton iteration until convergence
     for (int k = 0; k < max_continuation_iters; k++) {
@@ -357,6 +700,9 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
 
       // Solve for the update and update the state variables
       ksm->solve(res, update);
+      if (anderson) {
+        anderson->computeUpdate(update);
+      }
       vars->axpy(-1.0, update);
     }
   }
@@ -367,21 +713,42 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
 
   // The rate of change of the lambda w.r.t. the arc-length
   TacsScalar dlambda_ds = 0.0;
+  if (start_iter > 0) {
+    dlambda_ds = restart_dlambda_ds;
+  }
+
+  // The number of steps since the last factorization, the corrector
+  // iterations in the last step and the stiffness along the mode
+  int reuse_count = 0;
+  int corr_iters = 0;
+  int branch_switched = 0, has_branch_value = 0;
+  TacsScalar branch_value = 0.0;
 
-  for (iteration_count = 0; iteration_count < max_continuation_iters;
+  for (iteration_count = start_iter; iteration_count < max_continuation_iters;
        iteration_count++) {
     // Copy the current values to a vector
     assembler->setVariables(vars);
 
-    // Assemble the stiffness matrix at the current iteration
+    // Decide whether the factorization from an earlier step is reused
+    int refactor =
+        (iteration_count == start_iter || reuse_count >= max_reuse_steps ||
+         2 * corr_iters > max_correction_iters);
+
     TacsScalar alpha = 1.0, beta = 0.0, gamma = 0.0;
-    assembler->assembleJacobian(alpha, beta, gamma, res, mat);
+    if (refactor) {
+      // Assemble the stiffness matrix at the current iteration
+      assembler->assembleJacobian(alpha, beta, gamma, res, mat);
 
-    // Compute the residual as r(u, lambda) = R(u) - lambda*load
-    res->axpy(-lambda, load);
+      // Compute the residual as r(u, lambda) = R(u) - lambda*load
+      res->axpy(-lambda, load);
 
-    // Factor the preconditioner
-    pc->factor();
+      // Factor the preconditioner
+      pc->factor();
+      num_factorizations++;
+      reuse_count = 0;
+    } else {
+      reuse_count++;
+    }
 
     // Compute the change in r = (u - u_k)^{T}(u - u_k)
     TacsScalar delta_s = 1.0;  // this will be over-written later
@@ -389,7 +756,19 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
     // Set the tolerances for the tangent computation
     ksm->setTolerances(tangent_rtol, tangent_atol);
 
-    if (iteration_count == 0) {
+    if (use_secant && iteration_count > start_iter) {
+      // Use the secant through the last two points as the predictor,
+      // normalized so that ||t||^2 + dlambda_ds^2 = 1
+      tangent->copyValues(vars);
+      tangent->axpy(-1.0, old_vars);
+      TacsScalar dlambda = lambda - lambda_old;
+      TacsScalar tnorm = tangent->norm();
+      TacsScalar snorm = sqrt(tnorm * tnorm + dlambda * dlambda);
+      if (TacsRealPart(snorm) > 0.0) {
+        tangent->scale(1.0 / snorm);
+        dlambda_ds = dlambda / snorm;
+      }
+    } else if (iteration_count == 0) {
       // Compute the initial tangent vector to the solution path
       ksm->setOperators(mat, pc);
       ksm->solve(load, tangent);
@@ -416,6 +795,34 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
       tangent->axpy(1.0, temp);
     }
 
+    // Check for a bifurcation point with the up-to-date Jacobian
+    if (branch_mode && refactor && !branch_switched) {
+      mat->mult(branch_mode, temp);
+      TacsScalar mnorm = branch_mode->norm();
+      TacsScalar value = branch_mode->dot(temp) / (mnorm * mnorm);
+
+      if (has_branch_value &&
+          TacsRealPart(value) * TacsRealPart(branch_value) < 0.0) {
+        // Deflect the predictor along the mode and re-normalize it
+        TacsScalar tnorm = tangent->norm();
+        TacsScalar snorm = sqrt(tnorm * tnorm + dlambda_ds * dlambda_ds);
+        tangent->axpy(branch_perturb * snorm / mnorm, branch_mode);
+        tnorm = tangent->norm();
+        snorm = sqrt(tnorm * tnorm + dlambda_ds * dlambda_ds);
+        tangent->scale(1.0 / snorm);
+        dlambda_ds = dlambda_ds / snorm;
+        branch_switched = 1;
+
+        if (ksm_print) {
+          ksm_print->print(
+              "TACSContinuation::solve_tangent: "
+              "Switching branches at a bifurcation point\n");
+        }
+      }
+      branch_value = value;
+      has_branch_value = 1;
+    }
+
     // Save values and update the iteration counter
     lambda_history[iteration_count] = lambda;
 
@@ -487,6 +894,7 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
     // Try using the current solution again
     int fail_flag = 1;
     int nrestarts = 0;
+    int step_reduced = 0;
     for (; fail_flag && (nrestarts < max_correction_restarts); nrestarts++) {
       // Perform an update based on the calculated value of ds
       // This ensures that the step lenght constraint is satisfied
@@ -498,6 +906,9 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
 
       // Now compute the next iteration
       TacsScalar init_res_norm = 0.0;
+      if (anderson) {
+        anderson->reset();
+      }
       for (int j = 0; j < max_correction_iters; j++) {
         // Compute the residual at the current value of (u, lambda)
         assembler->setVariables(vars);
@@ -519,6 +930,7 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
         } else if (TacsRealPart(res_norm) <
                    correction_rtol * TacsRealPart(init_res_norm)) {
           fail_flag = 0;
+          corr_iters = j;
           break;
         } else if (TacsRealPart(res_norm) >
                    correction_dtol * TacsRealPart(init_res_norm)) {
@@ -530,22 +942,41 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
         ksm->solve(res, temp);
 
         TacsScalar delta_lambda = path_mat->extract(temp);
+        if (anderson) {
+          anderson->computeUpdate(temp, &delta_lambda);
+        }
         lambda = lambda - delta_lambda;
         vars->axpy(-1.0, temp);
       }
 
-      // The corrector has failed. Try again with a smaller step size.
+      // The corrector has failed. Try again with a new factorization
+      // if an old one was used, otherwise with a smaller step size.
       if (fail_flag) {
         vars->copyValues(old_vars);
         lambda = lambda_old;
-        delta_s = 0.5 * delta_s;
 
-        if (ksm_print) {
-          char line[256];
-          sprintf(line,
-                  "Failed to converge, retrying with step size = %10.3e\n",
-                  TacsRealPart(delta_s));
-          ksm_print->print(line);
+        if (reuse_count > 0) {
+          assembler->setVariables(vars);
+          assembler->assembleJacobian(alpha, beta, gamma, res, mat);
+          pc->factor();
+          num_factorizations++;
+          reuse_count = 0;
+
+          if (ksm_print) {
+            ksm_print->print(
+                "Failed to converge, retrying with a new factorization\n");
+          }
+        } else {
+          delta_s = 0.5 * delta_s;
+          step_reduced = 1;
+
+          if (ksm_print) {
+            char line[256];
+            sprintf(line,
+                    "Failed to converge, retrying with step size = %10.3e\n",
+                    TacsRealPart(delta_s));
+            ksm_print->print(line);
+          }
         }
       }
     }
@@ -554,9 +985,32 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
       break;
     }
 
+    // Adapt the arc-length for the next step
+    if (adapt_target_iters > 0) {
+      double ratio = adapt_min_scale;
+      if (!step_reduced) {
+        ratio = adapt_max_scale;
+        if (corr_iters > 0) {
+          ratio = sqrt((1.0 * adapt_target_iters) / corr_iters);
+        }
+        if (ratio > adapt_max_scale) {
+          ratio = adapt_max_scale;
+        } else if (ratio < adapt_min_scale) {
+          ratio = adapt_min_scale;
+        }
+      }
+      target_delta_r *= ratio;
+    }
+
     if (callback) {
       callback->iteration(iteration_count, vars, lambda, dlambda_ds, assembler);
     }
+
+    // Write the restart file for the next iteration
+    if (restart_freq > 0 && (iteration_count + 1) % restart_freq == 0) {
+      writeRestart(restart_fname, iteration_count + 1, vars, tangent, lambda,
+                   dlambda_ds, target_delta_r);
+    }
   }
 
   // Deallocate temporary variables
@@ -566,5 +1020,6 @@ void TACSContinuation::solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm,
   tangent->decref();
   update->decref();
   res->decref();
+  neg_load->decref();
   path_mat->decref();
 }
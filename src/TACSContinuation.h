@@ -8,7 +8,9 @@
   Not for commercial purposes.
 */
 
+#include "TACSAndersonAcceleration.h"
 #include "TACSAssembler.h"
+#include "TACSRestart.h"
 
 /**
   Matrix type required for continuation methods.
@@ -104,6 +106,15 @@ class TACSContinuationCallback : public TACSObject {
   by a value of the TACSFunction passed to TACSContinuation algorithm.
 
   3. The maximum number of iterations is exceeded.
+
+  By default, the Jacobian is assembled and factored at the start of
+  each step and the arc-length is fixed. Optionally, the arc-length
+  can be adapted based on the number of corrector iterations, the
+  predictor can use the secant through the last two points on the
+  path, and the factorization can be reused over several steps. A
+  bifurcation is detected when the stiffness along a buckling mode
+  changes sign, at which point the predictor is deflected along the
+  mode to follow the bifurcated branch.
 */
 class TACSContinuation : public TACSObject {
  public:
@@ -120,6 +131,26 @@ class TACSContinuation : public TACSObject {
   void setTermFunction(TACSFunction *func, TacsScalar term_value);
   void setTermLambdaRate(TacsScalar term_dlambda_ds);
 
+  // Accelerate the corrector iterations
+  // -----------------------------------
+  void setAndersonAcceleration(int depth);
+
+  // Control the step size, the predictor and the factorizations
+  // -----------------------------------------------------------
+  void setAdaptiveStepSize(int target_iters, double min_scale = 0.25,
+                           double max_scale = 2.0);
+  void setSecantPredictor(int _use_secant);
+  void setJacobianReuse(int max_steps);
+
+  // Switch to a bifurcated branch along a buckling mode
+  // ---------------------------------------------------
+  void setBranchSwitch(TACSBVec *mode, TacsScalar perturb = 1e-2);
+
+  // Write/read restart files for the arc-length continuation
+  // --------------------------------------------------------
+  void setRestartOutput(const char *filename, int _restart_freq);
+  int readRestart(const char *filename);
+
   // Perform a continuation solve using a linearized arc-length constraint
   // ---------------------------------------------------------------------
   void solve_tangent(TACSMat *mat, TACSPc *pc, TACSKsm *ksm, TACSBVec *load,
@@ -130,6 +161,7 @@ class TACSContinuation : public TACSObject {
   // Retrieve information about the solve
   // ------------------------------------
   int getNumIterations();
+  int getNumFactorizations();
   void getSolution(int iter, TacsScalar *lambda, TacsScalar *dlambda_ds);
 
  private:
@@ -151,11 +183,39 @@ class TACSContinuation : public TACSObject {
   // Solution variables
   TACSAssembler *assembler;
 
+  // Acceleration for the Newton iterations with a frozen Jacobian
+  TACSAndersonAcceleration *anderson;
+
+  // Adaptive step size control based on the corrector iterations
+  int adapt_target_iters;  // Target number of corrector iterations (0 = off)
+  double adapt_min_scale, adapt_max_scale;  // Bounds on the step ratio
+
+  // Predictor and factorization reuse settings
+  int use_secant;          // Use a secant predictor after the first step
+  int max_reuse_steps;     // Max. steps that reuse the factorization
+  int num_factorizations;  // The number of factorizations in the last solve
+
+  // Branch switching at a bifurcation point
+  TACSBVec *branch_mode;      // The buckling mode (NULL = off)
+  TacsScalar branch_perturb;  // The relative perturbation along the mode
+
   // Information to store the iteration history
   int iteration_count;             // The number of iterations actually used
   TacsScalar *lambda_history;      // The history of the parameter
   TacsScalar *dlambda_ds_history;  // The history of dlambda/ds
 
+  // Write the restart file after the given iteration
+  int writeRestart(const char *filename, int iter, TACSBVec *vars,
+                   TACSBVec *tangent, TacsScalar lambda, TacsScalar dlambda_ds,
+                   TacsScalar target_delta_r);
+
+  // Restart file information
+  char restart_fname[256];  // The file for the periodic restart output
+  int restart_freq;         // Frequency of the restart output (0 = off)
+  int restart_iter;         // Iteration read from a restart file (0 = none)
+  TACSBVec *restart_vars, *restart_tangent;  // The restart path point
+  TacsScalar restart_lambda, restart_dlambda_ds, restart_delta_r;
+
   // Termination condition information
   TACSFunction *term_function;
   TacsScalar term_function_value;
@@ -0,0 +1,440 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSCraigBampton.h"
+
+#include "TACSBuckling.h"
+
+/*
+  Create the Craig-Bampton reduction for the substructure
+
+  @param assembler The substructure model
+  @param num_interface The number of interface nodes
+  @param interface_nodes The global interface node numbers
+  @param num_modes The number of fixed-interface modes
+  @param max_lanczos The size of the Lanczos subspace
+  @param eig_tol The eigenvalue tolerance
+*/
+TACSCraigBampton::TACSCraigBampton(TACSAssembler *_assembler,
+                                   int _num_interface,
+                                   const int *_interface_nodes, int _num_modes,
+                                   int _max_lanczos, double _eig_tol) {
+  assembler = _assembler;
+  assembler->incref();
+
+  // Convert the interface nodes to the internal node numbering. Only
+  // the owner can reorder a node, so take the maximum over all procs.
+  num_interface = _num_interface;
+  interface_nodes = new int[num_interface];
+  int *nodes = new int[num_interface];
+  memcpy(nodes, _interface_nodes, num_interface * sizeof(int));
+  assembler->reorderNodes(num_interface, nodes);
+  MPI_Allreduce(nodes, interface_nodes, num_interface, MPI_INT, MPI_MAX,
+                assembler->getMPIComm());
+  delete[] nodes;
+
+  // Round the number of modes up to fill the modal nodes
+  vars_per_node = assembler->getVarsPerNode();
+  num_modes = (_num_modes + vars_per_node - 1) / vars_per_node;
+  num_modes *= vars_per_node;
+  num_reduced = vars_per_node * num_interface + num_modes;
+
+  max_lanczos = _max_lanczos;
+  if (max_lanczos < 2 * num_modes) {
+    max_lanczos = 2 * num_modes;
+  }
+  eig_tol = _eig_tol;
+
+  eigvals = new TacsScalar[num_modes];
+  memset(eigvals, 0, num_modes * sizeof(TacsScalar));
+  Kr = new TacsScalar[num_reduced * num_reduced];
+  Mr = new TacsScalar[num_reduced * num_reduced];
+  memset(Kr, 0, num_reduced * num_reduced * sizeof(TacsScalar));
+  memset(Mr, 0, num_reduced * num_reduced * sizeof(TacsScalar));
+  basis = NULL;
+}
+
+TACSCraigBampton::~TACSCraigBampton() {
+  assembler->decref();
+  delete[] interface_nodes;
+  delete[] eigvals;
+  delete[] Kr;
+  delete[] Mr;
+  if (basis) {
+    for (int i = 0; i < num_reduced; i++) {
+      basis[i]->decref();
+    }
+    delete[] basis;
+  }
+}
+
+/*
+  Get the number of nodes of the superelement
+*/
+int TACSCraigBampton::getNumSuperElementNodes() {
+  return num_interface + num_modes / vars_per_node;
+}
+
+/*
+  Get the reduced stiffness and mass matrices in row-major order
+*/
+void TACSCraigBampton::getReducedMatrices(const TacsScalar **_Kr,
+                                          const TacsScalar **_Mr) {
+  if (_Kr) {
+    *_Kr = Kr;
+  }
+  if (_Mr) {
+    *_Mr = Mr;
+  }
+}
+
+/*
+  Get the n-th fixed-interface eigenvalue
+*/
+TacsScalar TACSCraigBampton::extractEigenvalue(int n) {
+  if (n >= 0 && n < num_modes) {
+    return eigvals[n];
+  }
+  return 0.0;
+}
+
+/*
+  Create the superelement from the reduced matrices
+*/
+TACSSuperElement *TACSCraigBampton::createSuperElement() {
+  return new TACSSuperElement(vars_per_node, getNumSuperElementNodes(), Kr,
+                              Mr);
+}
+
+/*
+  Compute the reduction basis and the reduced matrices
+
+  The fixed-interface modes are computed with the shift-invert Lanczos
+  method at a zero shift. The factorization of the constrained
+  stiffness matrix is then re-used to compute the constraint modes.
+  For a unit displacement e of an interface variable, the constraint
+  mode is
+
+  psi = e - K_{c}^{-1}*(K*e)
+
+  where K_{c} is the stiffness matrix with the boundary conditions and
+  the product K*e has the constrained rows set to zero.
+
+  @param ksm_print Print the eigensolver output (optional)
+  @return Fail flag indicating whether the computation failed
+*/
+int TACSCraigBampton::solve(KSMPrint *ksm_print) {
+  MPI_Comm comm = assembler->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  for (int i = 0; i < num_interface; i++) {
+    if (interface_nodes[i] < 0) {
+      fprintf(stderr,
+              "[%d] TACSCraigBampton: Interface node %d is not an "
+              "independent node\n",
+              mpi_rank, i);
+      return 1;
+    }
+  }
+
+  if (!basis) {
+    basis = new TACSBVec *[num_reduced];
+    for (int i = 0; i < num_reduced; i++) {
+      basis[i] = assembler->createVec();
+      basis[i]->incref();
+    }
+  }
+
+  // Create the matrices and the direct solver
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  kmat->incref();
+  TACSSchurMat *mmat = assembler->createSchurMat();
+  mmat->incref();
+  TACSSchurPc *pc = new TACSSchurPc(kmat, 1000000, 10.0, 1);
+  pc->incref();
+  TACSKsm *ksm = new GMRES(kmat, pc, 10, 0, 0);
+  ksm->incref();
+  ksm->setTolerances(1e-12, 1e-30);
+
+  // Compute the fixed-interface modes. This leaves the constrained
+  // stiffness matrix factored.
+  int fail = 0;
+  int num_boundary = vars_per_node * num_interface;
+  if (num_modes > 0) {
+    TACSFrequencyAnalysis *freq = new TACSFrequencyAnalysis(
+        assembler, 0.0, mmat, kmat, ksm, max_lanczos, num_modes, eig_tol);
+    freq->incref();
+    freq->solve(ksm_print);
+
+    for (int i = 0; i < num_modes; i++) {
+      TacsScalar error;
+      eigvals[i] =
+          freq->extractEigenvector(i, basis[num_boundary + i], &error);
+      if (TacsRealPart(error) > eig_tol) {
+        fail = 1;
+      }
+    }
+    freq->decref();
+  } else {
+    assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
+    pc->factor();
+  }
+
+  if (fail && mpi_rank == 0) {
+    fprintf(stderr,
+            "TACSCraigBampton: Fixed-interface modes did not converge\n");
+  }
+
+  // Compute the constraint modes
+  const int *range;
+  assembler->getNodeMap()->getOwnerRange(&range);
+  TACSBVec *e = assembler->createVec();
+  TACSBVec *r = assembler->createVec();
+  e->incref();
+  r->incref();
+
+  for (int i = 0; i < num_interface; i++) {
+    for (int k = 0; k < vars_per_node; k++) {
+      TACSBVec *psi = basis[vars_per_node * i + k];
+
+      // Set the unit displacement on the owner of the node
+      e->zeroEntries();
+      int node = interface_nodes[i];
+      if (node >= range[mpi_rank] && node < range[mpi_rank + 1]) {
+        TacsScalar *x;
+        e->getArray(&x);
+        x[vars_per_node * (node - range[mpi_rank]) + k] = 1.0;
+      }
+
+      r->zeroEntries();
+      assembler->addJacobianVecProduct(1.0, 1.0, 0.0, 0.0, e, r);
+      ksm->solve(r, psi);
+      assembler->applyBCs(psi);
+      psi->scale(-1.0);
+      psi->axpy(1.0, e);
+    }
+  }
+
+  e->decref();
+  r->decref();
+  kmat->decref();
+  mmat->decref();
+  pc->decref();
+  ksm->decref();
+
+  // Form the reduced matrices
+  computeReducedMatrix(TACS_STIFFNESS_MATRIX, Kr);
+  computeReducedMatrix(TACS_MASS_MATRIX, Mr);
+
+  return fail;
+}
+
+/*
+  Compute the reduced matrix T^{T}*A*T from the element matrices
+
+  The element matrices include the contributions from the interface
+  variables that are constrained in the substructure model.
+*/
+void TACSCraigBampton::computeReducedMatrix(ElementMatrixType matType,
+                                            TacsScalar *Ar) {
+  for (int j = 0; j < num_reduced; j++) {
+    basis[j]->beginDistributeValues();
+  }
+  for (int j = 0; j < num_reduced; j++) {
+    basis[j]->endDistributeValues();
+  }
+
+  // Allocate space for the element data
+  int max_nodes = assembler->getMaxElementNodes();
+  int max_vars = assembler->getMaxElementVariables();
+  TacsScalar *Xpts = new TacsScalar[3 * max_nodes];
+  TacsScalar *vars = new TacsScalar[max_vars];
+  TacsScalar *mat = new TacsScalar[max_vars * max_vars];
+  TacsScalar *T = new TacsScalar[max_vars * num_reduced];
+  TacsScalar *AT = new TacsScalar[max_vars * num_reduced];
+  TacsScalar *A = new TacsScalar[num_reduced * num_reduced];
+  memset(A, 0, num_reduced * num_reduced * sizeof(TacsScalar));
+
+  double time = assembler->getSimulationTime();
+  int num_elements = assembler->getNumElements();
+  for (int elem = 0; elem < num_elements; elem++) {
+    int len;
+    const int *nodes;
+    TACSElement *element = assembler->getElement(elem, &len, &nodes);
+    assembler->getElement(elem, Xpts, vars);
+    int nvars = element->getNumVariables();
+    element->getMatType(matType, elem, time, Xpts, vars, mat);
+
+    // Retrieve the basis at the element variables. T is stored with
+    // the basis vectors as rows.
+    for (int j = 0; j < num_reduced; j++) {
+      basis[j]->getValues(len, nodes, &T[nvars * j]);
+    }
+
+    // Compute the product of the element matrix with the basis
+    for (int j = 0; j < num_reduced; j++) {
+      const TacsScalar *t = &T[nvars * j];
+      TacsScalar *at = &AT[nvars * j];
+      for (int i = 0; i < nvars; i++) {
+        at[i] = 0.0;
+        const TacsScalar *m = &mat[nvars * i];
+        for (int k = 0; k < nvars; k++) {
+          at[i] += m[k] * t[k];
+        }
+      }
+    }
+
+    // Add the contribution to the reduced matrix
+    for (int i = 0; i < num_reduced; i++) {
+      const TacsScalar *t = &T[nvars * i];
+      for (int j = 0; j < num_reduced; j++) {
+        const TacsScalar *at = &AT[nvars * j];
+        TacsScalar value = 0.0;
+        for (int k = 0; k < nvars; k++) {
+          value += t[k] * at[k];
+        }
+        A[num_reduced * i + j] += value;
+      }
+    }
+  }
+
+  MPI_Allreduce(A, Ar, num_reduced * num_reduced, TACS_MPI_TYPE, MPI_SUM,
+                assembler->getMPIComm());
+
+  delete[] Xpts;
+  delete[] vars;
+  delete[] mat;
+  delete[] T;
+  delete[] AT;
+  delete[] A;
+}
+
+/*
+  Recover the substructure variables from the reduced variables
+
+  The reduced variables are ordered with the interface variables first
+  followed by the modal coordinates. This requires the basis from
+  solve().
+
+  @param reduced The reduced variables
+  @param vars The substructure variables
+  @return Fail flag indicating whether the basis is unavailable
+*/
+int TACSCraigBampton::recoverVariables(const TacsScalar *reduced,
+                                       TACSBVec *vars) {
+  if (!basis) {
+    fprintf(stderr,
+            "TACSCraigBampton: Cannot recover variables without the "
+            "reduction basis\n");
+    return 1;
+  }
+
+  vars->zeroEntries();
+  for (int i = 0; i < num_reduced; i++) {
+    vars->axpy(reduced[i], basis[i]);
+  }
+
+  return 0;
+}
+
+/*
+  Write the reduced matrices to a binary file from the root processor
+
+  The file format is as follows:
+  int                                    The number of variables per node
+  int                                    The number of interface nodes
+  int                                    The number of modes
+  num_modes*sizeof(TacsScalar)           The eigenvalues
+  num_reduced^2*sizeof(TacsScalar)       The reduced stiffness matrix
+  num_reduced^2*sizeof(TacsScalar)       The reduced mass matrix
+*/
+int TACSCraigBampton::writeToFile(const char *filename) {
+  MPI_Comm comm = assembler->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  int fail = 0;
+  if (mpi_rank == 0) {
+    FILE *fp = fopen(filename, "wb");
+    if (fp) {
+      int header[3] = {vars_per_node, num_interface, num_modes};
+      size_t nmodes = num_modes;
+      size_t size = num_reduced * num_reduced;
+      if (fwrite(header, sizeof(int), 3, fp) != 3 ||
+          fwrite(eigvals, sizeof(TacsScalar), nmodes, fp) != nmodes ||
+          fwrite(Kr, sizeof(TacsScalar), size, fp) != size ||
+          fwrite(Mr, sizeof(TacsScalar), size, fp) != size) {
+        fail = 1;
+      }
+      fclose(fp);
+    } else {
+      fail = 1;
+    }
+    if (fail) {
+      fprintf(stderr, "TACSCraigBampton: Failed to write file %s\n",
+              filename);
+    }
+  }
+
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  return fail;
+}
+
+/*
+  Read the reduced matrices from a binary file on the root processor
+
+  The dimensions stored in the file must match the dimensions of this
+  object otherwise nothing is read in.
+*/
+int TACSCraigBampton::readFromFile(const char *filename) {
+  MPI_Comm comm = assembler->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  int fail = 0;
+  if (mpi_rank == 0) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp) {
+      int header[3];
+      size_t nmodes = num_modes;
+      size_t size = num_reduced * num_reduced;
+      if (fread(header, sizeof(int), 3, fp) != 3 ||
+          header[0] != vars_per_node || header[1] != num_interface ||
+          header[2] != num_modes) {
+        fail = 1;
+      } else if (fread(eigvals, sizeof(TacsScalar), nmodes, fp) != nmodes ||
+                 fread(Kr, sizeof(TacsScalar), size, fp) != size ||
+                 fread(Mr, sizeof(TacsScalar), size, fp) != size) {
+        fail = 1;
+      }
+      fclose(fp);
+    } else {
+      fail = 1;
+    }
+    if (fail) {
+      fprintf(stderr, "TACSCraigBampton: Failed to read file %s\n",
+              filename);
+    }
+  }
+
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  if (!fail) {
+    MPI_Bcast(eigvals, num_modes, TACS_MPI_TYPE, 0, comm);
+    MPI_Bcast(Kr, num_reduced * num_reduced, TACS_MPI_TYPE, 0, comm);
+    MPI_Bcast(Mr, num_reduced * num_reduced, TACS_MPI_TYPE, 0, comm);
+  }
+
+  return fail;
+}
@@ -0,0 +1,104 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_CRAIG_BAMPTON_H
+#define TACS_CRAIG_BAMPTON_H
+
+#include "TACSAssembler.h"
+#include "TACSSuperElement.h"
+
+/*
+  Craig-Bampton component mode synthesis for a substructure.
+
+  The substructure is a separate TACSAssembler model that contains the
+  elements of the components to be reduced. The interface nodes shared
+  with the rest of the structure must be fully constrained by the
+  boundary conditions of the substructure model. The reduction basis is
+
+  T = [ Psi  Phi ]
+
+  where Psi are the static constraint modes due to a unit displacement
+  of each interface variable with the remaining interface variables
+  fixed and Phi are the lowest fixed-interface normal modes. The
+  reduced matrices T^{T}*K*T and T^{T}*M*T are computed element by
+  element, using the unconstrained element matrices, and are stored on
+  all processors.
+
+  The reduced matrices are used through a TACSSuperElement in the model
+  of the remaining structure. The nodes of the superelement are the
+  interface nodes followed by num_modes/vars_per_node modal nodes that
+  are not connected to any other element. The number of modes is
+  rounded up to a multiple of the number of variables per node. The
+  reduced matrices can be written to a file and read back so that an
+  unchanged substructure is only reduced once.
+*/
+class TACSCraigBampton : public TACSObject {
+ public:
+  TACSCraigBampton(TACSAssembler *_assembler, int _num_interface,
+                   const int *_interface_nodes, int _num_modes,
+                   int _max_lanczos = 100, double _eig_tol = 1e-8);
+  ~TACSCraigBampton();
+
+  // Compute the reduced matrices
+  // ----------------------------
+  int solve(KSMPrint *ksm_print = NULL);
+
+  // Retrieve the reduced model
+  // --------------------------
+  int getNumInterfaceNodes() { return num_interface; }
+  int getNumModes() { return num_modes; }
+  int getNumReducedVariables() { return num_reduced; }
+  int getNumSuperElementNodes();
+  void getReducedMatrices(const TacsScalar **_Kr, const TacsScalar **_Mr);
+  TacsScalar extractEigenvalue(int n);
+  TACSSuperElement *createSuperElement();
+
+  // Read/write the reduced matrices - the same on all procs
+  // --------------------------------------------------------
+  int writeToFile(const char *filename);
+  int readFromFile(const char *filename);
+
+  // Recover the substructure variables from the reduced variables
+  // -------------------------------------------------------------
+  int recoverVariables(const TacsScalar *reduced, TACSBVec *vars);
+
+ private:
+  // Compute T^{T}*A*T for the given matrix type
+  void computeReducedMatrix(ElementMatrixType matType, TacsScalar *Ar);
+
+  // The substructure model
+  TACSAssembler *assembler;
+
+  // The interface nodes in the substructure numbering
+  int num_interface;
+  int *interface_nodes;
+
+  // The number of variables per node, modes and reduced variables
+  int vars_per_node, num_modes, num_reduced;
+
+  // Parameters for the Lanczos eigensolver
+  int max_lanczos;
+  double eig_tol;
+
+  // The fixed-interface eigenvalues
+  TacsScalar *eigvals;
+
+  // The reduced stiffness and mass matrices in row-major order
+  TacsScalar *Kr, *Mr;
+
+  // The reduction basis, NULL if the matrices were read from a file
+  TACSBVec **basis;
+};
+
+#endif  // TACS_CRAIG_BAMPTON_H
@@ -46,6 +46,75 @@ static int compare_arg_sort(const void *a, const void *b) {
   return aval - bval;
 }
 
+/*
+  Compute the permutation that orders a list of n entries by their
+  destination processor and count the number of entries sent to each
+  processor. The relative order of the entries sent to each processor
+  is retained.
+*/
+static int *order_by_dest(int n, const int *dest, int size, int *send_count) {
+  int *send_ptr = new int[size + 1];
+  memset(send_count, 0, size * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    send_count[dest[i]]++;
+  }
+  send_ptr[0] = 0;
+  for (int i = 0; i < size; i++) {
+    send_ptr[i + 1] = send_ptr[i] + send_count[i];
+  }
+
+  int *perm = new int[n];
+  for (int i = 0; i < n; i++) {
+    perm[send_ptr[dest[i]]] = i;
+    send_ptr[dest[i]]++;
+  }
+  delete[] send_ptr;
+
+  return perm;
+}
+
+/*
+  Exchange data ordered by destination with all other processors.
+
+  Processor i is sent send_count[i] items, each consisting of width
+  entries. The received items are returned in a newly allocated array
+  ordered by the source processor, with recv_count[i] items from
+  processor i. The function returns the number of received items.
+*/
+template <typename T>
+static int exchange_data(MPI_Comm comm, MPI_Datatype dtype, int width,
+                         const int *send_count, const T *send, int *recv_count,
+                         T **recv) {
+  int size;
+  MPI_Comm_size(comm, &size);
+  MPI_Alltoall((void *)send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+
+  int *scount = new int[size];
+  int *sdisp = new int[size];
+  int *rcount = new int[size];
+  int *rdisp = new int[size];
+  int nsend = 0, nrecv = 0;
+  for (int i = 0; i < size; i++) {
+    scount[i] = width * send_count[i];
+    rcount[i] = width * recv_count[i];
+    sdisp[i] = width * nsend;
+    rdisp[i] = width * nrecv;
+    nsend += send_count[i];
+    nrecv += recv_count[i];
+  }
+
+  *recv = new T[width * nrecv];
+  MPI_Alltoallv((void *)send, scount, sdisp, dtype, *recv, rcount, rdisp,
+                dtype, comm);
+
+  delete[] scount;
+  delete[] sdisp;
+  delete[] rcount;
+  delete[] rdisp;
+
+  return nrecv;
+}
+
 /**
   Allocate the TACSCreator object
 
@@ -70,6 +139,8 @@ TACSCreator::TACSCreator(MPI_Comm _comm, int _vars_per_node) {
   num_nodes = 0;
   num_elements = 0;
   num_dependent_nodes = 0;
+  distributed = 0;
+  node_range = NULL;
 
   // Set the element connectivity and nodes
   elem_id_nums = NULL;
@@ -99,6 +170,12 @@ TACSCreator::TACSCreator(MPI_Comm _comm, int _vars_per_node) {
   owned_elements = NULL;
   owned_nodes = NULL;
 
+  // Balance the number of elements by default
+  weight_type = UNIFORM_WEIGHTS;
+  elem_costs = NULL;
+  num_id_costs = 0;
+  elem_id_costs = NULL;
+
   // Set the elements array to NULL
   elements = NULL;
   element_creator = NULL;
@@ -161,6 +238,15 @@ TACSCreator::~TACSCreator() {
   if (local_elem_id_nums) {
     delete[] local_elem_id_nums;
   }
+  if (node_range) {
+    delete[] node_range;
+  }
+  if (elem_costs) {
+    delete[] elem_costs;
+  }
+  if (elem_id_costs) {
+    delete[] elem_id_costs;
+  }
 
   if (elements) {
     for (int i = 0; i < num_elem_ids; i++) {
@@ -199,6 +285,47 @@ void TACSCreator::setGlobalConnectivity(int _num_nodes, int _num_elements,
   memcpy(elem_id_nums, _elem_id_nums, num_elements * sizeof(int));
 }
 
+/*
+  Set the connectivity for a mesh that is distributed across all
+  processors. This must be called on all processors.
+
+  The nodes are split into contiguous ranges so that this processor
+  sets the nodes with global numbers in [node_range[rank],
+  node_range[rank+1]), where the ranges are formed from the number of
+  nodes on each processor. The connectivity is in terms of these
+  global node numbers, and the elements on each processor form a
+  contiguous slice of the global element numbers in rank order.
+
+  @param _num_owned_nodes The number of nodes set on this processor
+  @param _num_owned_elements The number of elements on this processor
+  @param _elem_node_ptr Pointer into the connectivity for each element
+  @param _elem_node_conn The global node numbers for each element
+  @param _elem_id_nums The element id number for each element
+*/
+void TACSCreator::setDistributedConnectivity(int _num_owned_nodes,
+                                             int _num_owned_elements,
+                                             const int *_elem_node_ptr,
+                                             const int *_elem_node_conn,
+                                             const int *_elem_id_nums) {
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  distributed = 1;
+  setGlobalConnectivity(_num_owned_nodes, _num_owned_elements, _elem_node_ptr,
+                        _elem_node_conn, _elem_id_nums);
+
+  // Find the node ranges for all processors
+  if (node_range) {
+    delete[] node_range;
+  }
+  node_range = new int[size + 1];
+  node_range[0] = 0;
+  MPI_Allgather(&num_nodes, 1, MPI_INT, &node_range[1], 1, MPI_INT, comm);
+  for (int i = 0; i < size; i++) {
+    node_range[i + 1] += node_range[i];
+  }
+}
+
 /*
   Set the dependent node information
 */
@@ -310,6 +437,263 @@ void TACSCreator::setReorderingType(
   mat_type = _mat_type;
 }
 
+/*
+  Set the type of weights used to balance the mesh partition
+
+  With ELEMENT_COST_WEIGHTS, the partition balances the element costs.
+  These are, in order of precedence, the costs set for each element,
+  the costs set for each element-id number, or an estimate based on
+  the square of the number of element variables. With
+  NONZERO_WEIGHTS, the partition balances an estimate of the number of
+  matrix non-zeros in the rows owned by each processor, so that the
+  cost of the linear solve is balanced. COST_AND_NONZERO_WEIGHTS uses
+  a multi-constraint partition that balances both.
+
+  input:
+  weight_type:   the type of weights to use in the partition
+*/
+void TACSCreator::setPartitionWeights(PartitionWeightType _weight_type) {
+  weight_type = _weight_type;
+}
+
+/*
+  Set the cost of each element used to balance the partition
+
+  The costs are set for the elements in the same order as the
+  connectivity: on the root processor for the global mesh, or for the
+  local elements when the mesh is distributed. Passing NULL reverts to
+  the element-id costs or the default estimate.
+
+  input:
+  costs:    the relative cost of each element
+*/
+void TACSCreator::setElementCosts(const double *costs) {
+  if (elem_costs) {
+    delete[] elem_costs;
+    elem_costs = NULL;
+  }
+  if (costs && num_elements > 0) {
+    elem_costs = new double[num_elements];
+    memcpy(elem_costs, costs, num_elements * sizeof(double));
+  }
+}
+
+/*
+  Set the cost of the elements for each element-id number
+
+  This is used to set an estimate for each type of element, for
+  instance for elements with expensive constitutive models. Elements
+  with an id number outside the range use the default estimate.
+
+  input:
+  num_ids:    the number of element-id numbers
+  id_costs:   the relative cost of an element with each id number
+*/
+void TACSCreator::setElementIdCosts(int num_ids, const double *id_costs) {
+  if (elem_id_costs) {
+    delete[] elem_id_costs;
+    elem_id_costs = NULL;
+  }
+  num_id_costs = 0;
+  if (id_costs && num_ids > 0) {
+    num_id_costs = num_ids;
+    elem_id_costs = new double[num_ids];
+    memcpy(elem_id_costs, id_costs, num_ids * sizeof(double));
+  }
+}
+
+/*
+  Set the element costs from the measured costs of the local elements
+  in a TACSAssembler object created by this object
+
+  This call is collective. The measured costs, for instance from
+  TACSAssembler::getElementTimes(), are mapped back to the global
+  element order on the root processor. The current partition is
+  discarded, so that the next call to partitionMesh() or createTACS()
+  computes a new partition. This is only available when the global
+  mesh is set on the root processor.
+
+  input:
+  assembler:     the TACSAssembler object created from this mesh
+  local_costs:   the costs of the local elements in the assembler
+*/
+void TACSCreator::setElementCosts(TACSAssembler *assembler,
+                                  const double *local_costs) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  if (distributed) {
+    if (rank == root_rank) {
+      fprintf(stderr,
+              "TACSCreator: Cannot map the measured element costs for a "
+              "distributed mesh\n");
+    }
+    return;
+  }
+
+  // Gather the costs from all processors on the root
+  int num_local = assembler->getNumElements();
+  int *counts = NULL, *ptr = NULL;
+  double *all_costs = NULL;
+  if (rank == root_rank) {
+    counts = new int[size];
+    ptr = new int[size + 1];
+  }
+  MPI_Gather(&num_local, 1, MPI_INT, counts, 1, MPI_INT, root_rank, comm);
+  if (rank == root_rank) {
+    ptr[0] = 0;
+    for (int k = 0; k < size; k++) {
+      ptr[k + 1] = ptr[k] + counts[k];
+    }
+    all_costs = new double[ptr[size] + 1];
+  }
+  MPI_Gatherv((void *)local_costs, num_local, MPI_DOUBLE, all_costs, counts,
+              ptr, MPI_DOUBLE, root_rank, comm);
+
+  if (rank == root_rank) {
+    if (partition && ptr[size] == num_elements) {
+      // The elements on each processor are in ascending global order
+      if (!elem_costs) {
+        elem_costs = new double[num_elements];
+      }
+      for (int j = 0; j < num_elements; j++) {
+        int owner = partition[j];
+        elem_costs[j] = all_costs[ptr[owner]];
+        ptr[owner]++;
+      }
+
+      // Discard the partition so that it is recomputed
+      delete[] partition;
+      partition = NULL;
+    } else {
+      fprintf(stderr,
+              "TACSCreator: The element costs do not match the partition\n");
+    }
+
+    delete[] counts;
+    delete[] ptr;
+    delete[] all_costs;
+  }
+}
+
+/*
+  Compute the integer vertex weights of the elements for the
+  partitioner
+
+  The weights are computed for the elements set on this processor and
+  are scaled so that the average weight of each constraint is 100.
+  When the mesh is distributed, this call is collective.
+
+  output:
+  ncon:   the number of weights (constraints) for each element
+
+  returns: the weights or NULL if the elements are not weighted
+*/
+int *TACSCreator::computePartitionWeights(int *ncon) {
+  *ncon = 1;
+  if (weight_type == UNIFORM_WEIGHTS) {
+    return NULL;
+  }
+
+  int use_costs = (weight_type & ELEMENT_COST_WEIGHTS);
+  int use_nonzeros = (weight_type & NONZERO_WEIGHTS);
+  int nc = (use_costs && use_nonzeros ? 2 : 1);
+  *ncon = nc;
+
+  double *w = new double[nc * num_elements + 1];
+  int c = 0;
+  if (use_costs) {
+    for (int i = 0; i < num_elements; i++) {
+      double cost = 0.0;
+      int id = (elem_id_nums ? elem_id_nums[i] : -1);
+      if (elem_costs) {
+        cost = elem_costs[i];
+      } else if (elem_id_costs && id >= 0 && id < num_id_costs) {
+        cost = elem_id_costs[id];
+      } else {
+        double n = vars_per_node * (elem_node_ptr[i + 1] - elem_node_ptr[i]);
+        cost = n * n;
+      }
+      w[nc * i + c] = cost;
+    }
+    c++;
+  }
+
+  if (use_nonzeros) {
+    // Find the unique independent nodes referenced by the elements
+    int len = elem_node_ptr[num_elements];
+    int *nodes = new int[len + 1];
+    int num_unique = 0;
+    for (int j = 0; j < len; j++) {
+      if (elem_node_conn[j] >= 0) {
+        nodes[num_unique] = elem_node_conn[j];
+        num_unique++;
+      }
+    }
+    num_unique = TacsUniqueSort(num_unique, nodes);
+
+    // Estimate the size of the matrix row for each node as the sum of
+    // the sizes of the adjacent elements
+    int *degree = new int[num_unique + 1];
+    int *row_size = new int[num_unique + 1];
+    memset(degree, 0, num_unique * sizeof(int));
+    memset(row_size, 0, num_unique * sizeof(int));
+    for (int i = 0; i < num_elements; i++) {
+      int n = elem_node_ptr[i + 1] - elem_node_ptr[i];
+      for (int j = elem_node_ptr[i]; j < elem_node_ptr[i + 1]; j++) {
+        if (elem_node_conn[j] >= 0) {
+          int *item = TacsSearchArray(elem_node_conn[j], num_unique, nodes);
+          degree[item - nodes]++;
+          row_size[item - nodes] += n;
+        }
+      }
+    }
+
+    // Split the non-zeros of each row evenly between the adjacent
+    // elements
+    double b2 = vars_per_node * vars_per_node;
+    for (int i = 0; i < num_elements; i++) {
+      double nnz = 0.0;
+      for (int j = elem_node_ptr[i]; j < elem_node_ptr[i + 1]; j++) {
+        if (elem_node_conn[j] >= 0) {
+          int *item = TacsSearchArray(elem_node_conn[j], num_unique, nodes);
+          nnz += b2 * row_size[item - nodes] / degree[item - nodes];
+        }
+      }
+      w[nc * i + c] = nnz;
+    }
+
+    delete[] nodes;
+    delete[] degree;
+    delete[] row_size;
+  }
+
+  // Scale the weights so that the average weight is 100
+  double sums[3] = {0.0, 0.0, 0.0};
+  for (int i = 0; i < num_elements; i++) {
+    for (int k = 0; k < nc; k++) {
+      sums[k] += w[nc * i + k];
+    }
+  }
+  sums[2] = num_elements;
+  if (distributed) {
+    MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_DOUBLE, MPI_SUM, comm);
+  }
+
+  int *wgts = new int[nc * num_elements + 1];
+  for (int k = 0; k < nc; k++) {
+    double scale = (sums[k] > 0.0 ? 100.0 * sums[2] / sums[k] : 0.0);
+    for (int i = 0; i < num_elements; i++) {
+      int wi = (int)(scale * w[nc * i + k] + 0.5);
+      wgts[nc * i + k] = (wi > 1 ? wi : 1);
+    }
+  }
+  delete[] w;
+
+  return wgts;
+}
+
 /*
   Get the new node numbers
 */
@@ -367,6 +751,65 @@ void TACSCreator::getAssemblerNodeNums(TACSAssembler *assembler,
   const int *owner_range = NULL;
   nodeMap->getOwnerRange(&owner_range);
 
+  if (distributed) {
+    // Each processor provides nodes in the input numbering. Send them
+    // to the processors that set them to find the new node numbers.
+    orig_nodes = new int[num_orig_nodes];
+    int count = 0;
+    for (int i = 0; i < num_orig_nodes; i++) {
+      if (_orig_nodes[i] >= 0 && _orig_nodes[i] < node_range[size]) {
+        orig_nodes[count] = _orig_nodes[i];
+        count++;
+      }
+    }
+    count = TacsUniqueSort(count, orig_nodes);
+
+    int *send_count = new int[size];
+    int *recv_count = new int[size];
+    ext_ptr = new int[size + 1];
+    TacsMatchIntervals(size, node_range, count, orig_nodes, ext_ptr);
+    for (int i = 0; i < size; i++) {
+      send_count[i] = ext_ptr[i + 1] - ext_ptr[i];
+    }
+
+    int *nodes;
+    count = exchange_data(comm, MPI_INT, 1, send_count, orig_nodes,
+                          recv_count, &nodes);
+    delete[] orig_nodes;
+
+    // Convert to the new node numbers, skipping nodes that are not
+    // referenced by any element
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+      int node = new_nodes[nodes[i] - node_range[rank]];
+      if (node >= 0) {
+        nodes[n] = node;
+        n++;
+      }
+    }
+    n = TacsUniqueSort(n, nodes);
+
+    // Send the new node numbers to the processors that own them
+    TacsMatchIntervals(size, owner_range, n, nodes, ext_ptr);
+    for (int i = 0; i < size; i++) {
+      send_count[i] = ext_ptr[i + 1] - ext_ptr[i];
+    }
+    count = exchange_data(comm, MPI_INT, 1, send_count, nodes, recv_count,
+                          &tacs_nodes);
+    count = TacsUniqueSort(count, tacs_nodes);
+    delete[] nodes;
+    delete[] ext_ptr;
+    delete[] send_count;
+    delete[] recv_count;
+
+    // Apply the reordering in TACS
+    assembler->reorderNodes(count, tacs_nodes);
+
+    *num_dist_nodes = count;
+    *_tacs_nodes = tacs_nodes;
+    return;
+  }
+
   if (rank == root_rank) {
     // First allocate an array of nodes that we will overwrite
     orig_nodes = new int[num_orig_nodes];
@@ -427,6 +870,143 @@ void TACSCreator::getAssemblerNodeNums(TACSAssembler *assembler,
   *_tacs_nodes = tacs_nodes;
 }
 
+/**
+  Create a creator with the same mesh definition on a sub-communicator
+
+  This is collective on the communicator of this creator, and each
+  processor passes the sub-communicator it belongs to, typically from
+  MPI_Comm_split(). The global connectivity, the dependent nodes, the
+  boundary conditions and the node locations are sent from the root of
+  this creator to the root of each sub-communicator, so that the mesh
+  is not re-read or re-generated for each group. The elements, the
+  element creator and the reordering settings are shared. The
+  per-element partition costs are not copied.
+
+  Only meshes set with setGlobalConnectivity() can be copied.
+
+  @param sub_comm The sub-communicator of this processor
+  @return The creator on the sub-communicator
+*/
+TACSCreator *TACSCreator::createSubCreator(MPI_Comm sub_comm) {
+  int rank, sub_rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_rank(sub_comm, &sub_rank);
+
+  TACSCreator *sub = new TACSCreator(sub_comm, vars_per_node);
+  sub->use_reordering = use_reordering;
+  sub->order_type = order_type;
+  sub->mat_type = mat_type;
+  sub->weight_type = weight_type;
+  if (elem_id_costs) {
+    sub->setElementIdCosts(num_id_costs, elem_id_costs);
+  }
+  if (elements) {
+    sub->setElements(num_elem_ids, elements);
+  }
+  sub->element_creator = element_creator;
+
+  if (distributed) {
+    if (rank == root_rank) {
+      fprintf(stderr,
+              "TACSCreator: Cannot copy a distributed mesh to a "
+              "sub-communicator\n");
+    }
+    return sub;
+  }
+
+  // Form a communicator from the root of this creator, which is
+  // listed first, and the root of each sub-communicator
+  int color = ((sub_rank == 0 || rank == root_rank) ? 0 : MPI_UNDEFINED);
+  int key = (rank == root_rank ? -1 : rank);
+  MPI_Comm root_comm;
+  MPI_Comm_split(comm, color, key, &root_comm);
+
+  if (root_comm != MPI_COMM_NULL) {
+    int is_root = (rank == root_rank);
+    int sizes[8];
+    if (is_root) {
+      sizes[0] = num_nodes;
+      sizes[1] = num_elements;
+      sizes[2] = (elem_node_ptr ? elem_node_ptr[num_elements] : 0);
+      sizes[3] = num_dependent_nodes;
+      sizes[4] = (dep_node_ptr ? dep_node_ptr[num_dependent_nodes] : 0);
+      sizes[5] = num_bcs;
+      sizes[6] = (bc_ptr ? bc_ptr[num_bcs] : 0);
+      sizes[7] = (Xpts ? 1 : 0);
+    }
+    MPI_Bcast(sizes, 8, MPI_INT, 0, root_comm);
+
+    // Point to the data on the root, otherwise allocate space for it
+    int *ptr = elem_node_ptr, *conn = elem_node_conn, *ids = elem_id_nums;
+    int *dptr = dep_node_ptr, *dconn = dep_node_conn;
+    double *dweights = dep_node_weights;
+    int *bnodes = bc_nodes, *bptr = bc_ptr, *bvars = bc_vars;
+    TacsScalar *bvals = bc_vals, *X = Xpts;
+    if (!is_root) {
+      ptr = new int[sizes[1] + 1];
+      conn = new int[sizes[2]];
+      ids = new int[sizes[1]];
+      dptr = new int[sizes[3] + 1];
+      dconn = new int[sizes[4]];
+      dweights = new double[sizes[4]];
+      bnodes = new int[sizes[5]];
+      bptr = new int[sizes[5] + 1];
+      bvars = new int[sizes[6]];
+      bvals = new TacsScalar[sizes[6]];
+      X = new TacsScalar[3 * sizes[0] * sizes[7]];
+    }
+
+    MPI_Bcast(ptr, sizes[1] + 1, MPI_INT, 0, root_comm);
+    MPI_Bcast(conn, sizes[2], MPI_INT, 0, root_comm);
+    MPI_Bcast(ids, sizes[1], MPI_INT, 0, root_comm);
+    if (sizes[3] > 0) {
+      MPI_Bcast(dptr, sizes[3] + 1, MPI_INT, 0, root_comm);
+      MPI_Bcast(dconn, sizes[4], MPI_INT, 0, root_comm);
+      MPI_Bcast(dweights, sizes[4], MPI_DOUBLE, 0, root_comm);
+    }
+    if (sizes[5] > 0) {
+      MPI_Bcast(bnodes, sizes[5], MPI_INT, 0, root_comm);
+      MPI_Bcast(bptr, sizes[5] + 1, MPI_INT, 0, root_comm);
+      MPI_Bcast(bvars, sizes[6], MPI_INT, 0, root_comm);
+      MPI_Bcast(bvals, sizes[6], TACS_MPI_TYPE, 0, root_comm);
+    }
+    if (sizes[7]) {
+      MPI_Bcast(X, 3 * sizes[0], TACS_MPI_TYPE, 0, root_comm);
+    }
+
+    // Set the data into the creator on the sub-communicator root
+    if (sub_rank == 0) {
+      sub->setGlobalConnectivity(sizes[0], sizes[1], ptr, conn, ids);
+      if (sizes[3] > 0) {
+        sub->setDependentNodes(sizes[3], dptr, dconn, dweights);
+      }
+      if (sizes[5] > 0) {
+        sub->setBoundaryConditions(sizes[5], bnodes, bptr, bvars, bvals);
+      }
+      if (sizes[7]) {
+        sub->setNodes(X);
+      }
+    }
+
+    if (!is_root) {
+      delete[] ptr;
+      delete[] conn;
+      delete[] ids;
+      delete[] dptr;
+      delete[] dconn;
+      delete[] dweights;
+      delete[] bnodes;
+      delete[] bptr;
+      delete[] bvars;
+      delete[] bvals;
+      delete[] X;
+    }
+    MPI_Comm_free(&root_comm);
+  }
+
+  return sub;
+}
+
 /*
   Create the instance of the TACSAssembler object and return it.
 
@@ -438,6 +1018,10 @@ TACSAssembler *TACSCreator::createTACS() {
   MPI_Comm_size(comm, &size);
   MPI_Comm_rank(comm, &rank);
 
+  if (distributed) {
+    return createDistributedTACS();
+  }
+
   if (rank == root_rank && !partition) {
     // Partition the mesh using the serial code on the root
     // processor.
@@ -463,6 +1047,9 @@ TACSAssembler *TACSCreator::createTACS() {
 
   // This will be used later to determine which elements belong to
   // which domain within the finite-element mesh
+  if (local_elem_id_nums) {
+    delete[] local_elem_id_nums;
+  }
   local_elem_id_nums = new int[num_owned_elements];
 
   // Loacal nodal information
@@ -473,8 +1060,25 @@ TACSAssembler *TACSCreator::createTACS() {
   int *local_dep_node_conn = NULL;
   double *local_dep_node_weights = NULL;
 
+  // Keep the boundary conditions in the input ordering on the root
+  // processor so that the mesh can be repartitioned later
+  int *input_bc_nodes = NULL, *input_bc_ptr = NULL, *input_bc_vars = NULL;
+  TacsScalar *input_bc_vals = NULL;
+
   // For each processor, send the information to the owner
   if (rank == root_rank) {
+    if (num_bcs > 0) {
+      int len = bc_ptr[num_bcs];
+      input_bc_nodes = new int[num_bcs];
+      input_bc_ptr = new int[num_bcs + 1];
+      input_bc_vars = new int[len + 1];
+      input_bc_vals = new TacsScalar[len + 1];
+      memcpy(input_bc_nodes, bc_nodes, num_bcs * sizeof(int));
+      memcpy(input_bc_ptr, bc_ptr, (num_bcs + 1) * sizeof(int));
+      memcpy(input_bc_vars, bc_vars, len * sizeof(int));
+      memcpy(input_bc_vals, bc_vals, len * sizeof(TacsScalar));
+    }
+
     // Reset the nodes for the boundary conditions so that they
     // correspond to the new ordering
     for (int j = 0; j < num_bcs; j++) {
@@ -785,6 +1389,277 @@ TACSAssembler *TACSCreator::createTACS() {
     MPI_Bcast(bc_vals, bc_ptr[num_bcs], TACS_MPI_TYPE, root_rank, comm);
   }
 
+  TACSAssembler *tacs = createAssembler(
+      num_local_dep_nodes, local_dep_node_ptr, local_dep_node_conn,
+      local_dep_node_weights, local_elem_node_ptr, local_elem_node_conn,
+      Xpts_local);
+
+  // Restore the boundary conditions freed by createAssembler()
+  if (input_bc_nodes) {
+    bc_nodes = input_bc_nodes;
+    bc_ptr = input_bc_ptr;
+    bc_vars = input_bc_vars;
+    bc_vals = input_bc_vals;
+  }
+
+  // Free all the remaining memory
+  delete[] local_elem_node_ptr;
+  delete[] local_elem_node_conn;
+  delete[] Xpts_local;
+
+  return tacs;
+}
+
+/**
+  Repartition the mesh with the measured element costs and create a
+  new TACSAssembler object with the state of the current one
+
+  This call is collective. A TACSAssembler object cannot change its
+  partition in place, so the measured costs of the local elements,
+  for instance from TACSAssembler::getElementTimes(), are used to
+  compute a new partition and a new TACSAssembler object is created.
+  The costs are added to the partition weights if they are not already
+  used. The state variables and their time derivatives, the node
+  locations, the design variables and the simulation time are then
+  copied from the input assembler to the new one.
+
+  Objects that depend on the local element or node numbering, such as
+  the auxiliary elements, the functions, the matrices and the vectors,
+  must be created again from the new assembler. The design variable
+  map is the default map, and the design variables are only copied
+  when the number of design variables is unchanged. This is only
+  available when the global mesh is set on the root processor.
+
+  @param assembler The TACSAssembler object created from this mesh
+  @param local_costs The costs of the local elements in the assembler
+  @return The new TACSAssembler object or NULL on failure
+*/
+TACSAssembler *TACSCreator::repartition(TACSAssembler *assembler,
+                                        const double *local_costs) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  if (distributed) {
+    if (rank == root_rank) {
+      fprintf(stderr,
+              "TACSCreator: Cannot repartition a distributed mesh\n");
+    }
+    return NULL;
+  }
+
+  // Keep the node numbers of the current partition
+  int *old_nodes = NULL;
+  if (rank == root_rank) {
+    old_nodes = new int[num_nodes];
+    memcpy(old_nodes, new_nodes, num_nodes * sizeof(int));
+  }
+
+  // Set the measured costs. This discards the current partition.
+  setElementCosts(assembler, local_costs);
+  weight_type = (PartitionWeightType)(weight_type | ELEMENT_COST_WEIGHTS);
+
+  TACSAssembler *tacs = createTACS();
+
+  // Copy the node locations
+  TACSBVec *X = assembler->createNodeVec();
+  TACSBVec *Xnew = tacs->createNodeVec();
+  X->incref();
+  Xnew->incref();
+  assembler->getNodes(X);
+  migrateVec(assembler, old_nodes, X, tacs, new_nodes, Xnew);
+  tacs->setNodes(Xnew);
+  X->decref();
+  Xnew->decref();
+
+  // Copy the state variables and their time derivatives
+  TACSBVec *vars[3], *new_vars[3];
+  for (int k = 0; k < 3; k++) {
+    vars[k] = assembler->createVec();
+    vars[k]->incref();
+    new_vars[k] = tacs->createVec();
+    new_vars[k]->incref();
+  }
+  assembler->getVariables(vars[0], vars[1], vars[2]);
+  for (int k = 0; k < 3; k++) {
+    migrateVec(assembler, old_nodes, vars[k], tacs, new_nodes, new_vars[k]);
+  }
+  tacs->setVariables(new_vars[0], new_vars[1], new_vars[2]);
+  for (int k = 0; k < 3; k++) {
+    vars[k]->decref();
+    new_vars[k]->decref();
+  }
+
+  // Copy the design variables. These use the global design variable
+  // numbers in both assemblers.
+  TACSBVec *dvs = assembler->createDesignVec();
+  TACSBVec *new_dvs = tacs->createDesignVec();
+  dvs->incref();
+  new_dvs->incref();
+  assembler->getDesignVars(dvs);
+  tacs->getDesignVars(new_dvs);
+  migrateVec(NULL, NULL, dvs, NULL, NULL, new_dvs);
+  tacs->setDesignVars(new_dvs);
+  dvs->decref();
+  new_dvs->decref();
+
+  tacs->setSimulationTime(assembler->getSimulationTime());
+
+  if (old_nodes) {
+    delete[] old_nodes;
+  }
+
+  return tacs;
+}
+
+/*
+  Copy the values of a vector from one assembler to another assembler
+  with a different partition of the same mesh
+
+  This call is collective. The owned values are gathered on the root
+  processor in the order of the nodes before the reordering in each
+  assembler, copied between the node numbers of the two partitions and
+  scattered to the owners. When the node numbers are NULL, the values
+  are copied by their global index, and this is only done when the
+  vectors have the same global size.
+
+  input:
+  src_assembler:    the assembler of the source vector (or NULL)
+  src_nodes:        the node numbers in the source partition (root only)
+  src:              the source vector
+  dest_assembler:   the assembler of the destination vector (or NULL)
+  dest_nodes:       the node numbers in the new partition (root only)
+
+  output:
+  dest:             the destination vector
+*/
+void TACSCreator::migrateVec(TACSAssembler *src_assembler,
+                             const int *src_nodes, TACSBVec *src,
+                             TACSAssembler *dest_assembler,
+                             const int *dest_nodes, TACSBVec *dest) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  int bsize = src->getBlockSize();
+  TACSAssembler *assemblers[2] = {src_assembler, dest_assembler};
+  TACSBVec *vecs[2] = {src, dest};
+  TacsScalar *local[2];
+  int local_size[2];
+  int *counts[2] = {NULL, NULL}, *ptr[2] = {NULL, NULL};
+
+  for (int k = 0; k < 2; k++) {
+    vecs[k]->getSize(&local_size[k]);
+    local[k] = new TacsScalar[local_size[k] + 1];
+
+    if (rank == root_rank) {
+      counts[k] = new int[size];
+      ptr[k] = new int[size + 1];
+    }
+    MPI_Gather(&local_size[k], 1, MPI_INT, counts[k], 1, MPI_INT, root_rank,
+               comm);
+    if (rank == root_rank) {
+      ptr[k][0] = 0;
+      for (int i = 0; i < size; i++) {
+        ptr[k][i + 1] = ptr[k][i] + counts[k][i];
+      }
+    }
+  }
+
+  // Put the source values in the order before the reordering. The
+  // reordering only permutes the nodes owned by each processor.
+  TacsScalar *x;
+  src->getArray(&x);
+  int num_local = local_size[0] / bsize;
+  int *perm[2] = {NULL, NULL};
+  for (int k = 0; k < 2; k++) {
+    int n = local_size[k] / bsize;
+    perm[k] = new int[n + 1];
+    if (assemblers[k]) {
+      const int *range;
+      assemblers[k]->getNodeMap()->getOwnerRange(&range);
+      for (int i = 0; i < n; i++) {
+        perm[k][i] = range[rank] + i;
+      }
+      assemblers[k]->reorderNodes(n, perm[k]);
+      for (int i = 0; i < n; i++) {
+        perm[k][i] -= range[rank];
+      }
+    } else {
+      for (int i = 0; i < n; i++) {
+        perm[k][i] = i;
+      }
+    }
+  }
+  for (int i = 0; i < num_local; i++) {
+    memcpy(&local[0][bsize * i], &x[bsize * perm[0][i]],
+           bsize * sizeof(TacsScalar));
+  }
+
+  TacsScalar *all[2] = {NULL, NULL};
+  if (rank == root_rank) {
+    all[0] = new TacsScalar[ptr[0][size] + 1];
+    all[1] = new TacsScalar[ptr[1][size] + 1];
+  }
+  MPI_Gatherv(local[0], local_size[0], TACS_MPI_TYPE, all[0], counts[0],
+              ptr[0], TACS_MPI_TYPE, root_rank, comm);
+
+  // Copy the values between the two partitions on the root
+  int copied = 1;
+  if (rank == root_rank) {
+    memset(all[1], 0, ptr[1][size] * sizeof(TacsScalar));
+    if (src_nodes && dest_nodes) {
+      for (int i = 0; i < num_nodes; i++) {
+        if (src_nodes[i] >= 0 && dest_nodes[i] >= 0) {
+          memcpy(&all[1][bsize * dest_nodes[i]], &all[0][bsize * src_nodes[i]],
+                 bsize * sizeof(TacsScalar));
+        }
+      }
+    } else if (ptr[0][size] == ptr[1][size]) {
+      memcpy(all[1], all[0], ptr[0][size] * sizeof(TacsScalar));
+    } else {
+      copied = 0;
+    }
+  }
+  MPI_Bcast(&copied, 1, MPI_INT, root_rank, comm);
+
+  if (copied) {
+    MPI_Scatterv(all[1], counts[1], ptr[1], TACS_MPI_TYPE, local[1],
+                 local_size[1], TACS_MPI_TYPE, root_rank, comm);
+
+    dest->getArray(&x);
+    for (int i = 0; i < local_size[1] / bsize; i++) {
+      memcpy(&x[bsize * perm[1][i]], &local[1][bsize * i],
+             bsize * sizeof(TacsScalar));
+    }
+  }
+
+  for (int k = 0; k < 2; k++) {
+    delete[] local[k];
+    delete[] perm[k];
+    if (rank == root_rank) {
+      delete[] counts[k];
+      delete[] ptr[k];
+      delete[] all[k];
+    }
+  }
+}
+
+/*
+  Create the TACSAssembler object from the local part of the mesh.
+
+  The connectivity is in terms of the global node numbers and the
+  nodal locations are for the nodes owned by this processor. The
+  boundary conditions stored in the object are applied to the nodes
+  owned by this processor and are then freed.
+*/
+TACSAssembler *TACSCreator::createAssembler(
+    int num_local_dep_nodes, const int *local_dep_node_ptr,
+    const int *local_dep_node_conn, const double *local_dep_node_weights,
+    const int *local_elem_node_ptr, const int *local_elem_node_conn,
+    const TacsScalar *Xpts_local) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
   TACSAssembler *tacs =
       new TACSAssembler(comm, vars_per_node, num_owned_nodes,
                         num_owned_elements, num_local_dep_nodes);
@@ -900,11 +1775,6 @@ TACSAssembler *TACSCreator::createTACS() {
   tacs->setNodes(X);
   X->decref();
 
-  // Free all the remaining memory
-  delete[] local_elem_node_ptr;
-  delete[] local_elem_node_conn;
-  delete[] Xpts_local;
-
   return tacs;
 }
 
@@ -916,11 +1786,19 @@ TACSAssembler *TACSCreator::createTACS() {
   first forms the dual mesh with an element->element data structure.
   The function then calls METIS to partition the mesh.
 
+  When the mesh is distributed, this function must be called on all
+  processors and the partition is specified for the local elements.
+
   input:
   split_size:      the number of segments in the partition
   part:            (optional) the specified partition
 */
 void TACSCreator::partitionMesh(int split_size, const int *part) {
+  if (distributed) {
+    partitionDistributedMesh(split_size, part);
+    return;
+  }
+
   int rank;
   MPI_Comm_rank(comm, &rank);
   if (rank != root_rank) {
@@ -1103,6 +1981,7 @@ void TACSCreator::partitionMesh(int split_size, const int *part) {
     // Partition the mesh using METIS.
     if (split_size > 1) {
       int ncon = 1;  // "It should be at least 1"??
+      int *vwgt = computePartitionWeights(&ncon);
 
       // Set the default options
       int options[METIS_NOPTIONS];
@@ -1116,13 +1995,16 @@ void TACSCreator::partitionMesh(int split_size, const int *part) {
 
       if (split_size < 8) {
         METIS_PartGraphRecursive(&num_elements, &ncon, elem_ptr, elem_conn,
-                                 NULL, NULL, NULL, &split_size, NULL, NULL,
+                                 vwgt, NULL, NULL, &split_size, NULL, NULL,
                                  options, &objval, partition);
       } else {
-        METIS_PartGraphKway(&num_elements, &ncon, elem_ptr, elem_conn, NULL,
+        METIS_PartGraphKway(&num_elements, &ncon, elem_ptr, elem_conn, vwgt,
                             NULL, NULL, &split_size, NULL, NULL, options,
                             &objval, partition);
       }
+      if (vwgt) {
+        delete[] vwgt;
+      }
     } else {
       // If there is no split, just assign all elements to the
       // root processor
@@ -1208,6 +2090,484 @@ void TACSCreator::partitionMesh(int split_size, const int *part) {
   delete[] split_offset;
 }
 
+/*
+  Partition a mesh that is distributed across all processors.
+
+  The partition of the local elements is either specified, computed
+  with ParMETIS from the element connectivity or, when TACS is not
+  compiled with ParMETIS, is taken from the input element slices.
+
+  input:
+  split_size:      the number of segments in the partition
+  part:            (optional) the partition of the local elements
+*/
+void TACSCreator::partitionDistributedMesh(int split_size, const int *part) {
+  int mpi_size, rank;
+  MPI_Comm_size(comm, &mpi_size);
+  MPI_Comm_rank(comm, &rank);
+
+  if (split_size <= 0 || split_size > mpi_size) {
+    split_size = mpi_size;
+  }
+
+  if (partition) {
+    delete[] partition;
+  }
+  partition = new int[num_elements];
+
+  if (part) {
+    // Check whether the suggested partition is legitimate on all
+    // processors
+    int legit = 1;
+    for (int i = 0; i < num_elements; i++) {
+      if (part[i] < 0 || part[i] >= split_size) {
+        legit = 0;
+        break;
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &legit, 1, MPI_INT, MPI_MIN, comm);
+
+    if (legit) {
+      memcpy(partition, part, num_elements * sizeof(int));
+      return;
+    }
+  }
+
+  // By default, retain the input element slices
+  int owner = (int)(((long long)rank * split_size) / mpi_size);
+  for (int k = 0; k < num_elements; k++) {
+    partition[k] = owner;
+  }
+
+#ifdef TACS_HAS_PARMETIS
+  // ParMETIS requires at least one element on each processor
+  int min_elements = num_elements;
+  MPI_Allreduce(MPI_IN_PLACE, &min_elements, 1, MPI_INT, MPI_MIN, comm);
+
+  if (split_size > 1 && min_elements > 0) {
+    // Set the element distribution
+    int *elmdist = new int[mpi_size + 1];
+    elmdist[0] = 0;
+    MPI_Allgather(&num_elements, 1, MPI_INT, &elmdist[1], 1, MPI_INT, comm);
+    for (int i = 0; i < mpi_size; i++) {
+      elmdist[i + 1] += elmdist[i];
+    }
+
+    // Set the element to node connectivity for the independent nodes
+    int *eptr = new int[num_elements + 1];
+    int *eind = new int[elem_node_ptr[num_elements]];
+    eptr[0] = 0;
+    for (int i = 0, n = 0; i < num_elements; i++) {
+      for (int j = elem_node_ptr[i]; j < elem_node_ptr[i + 1]; j++) {
+        if (elem_node_conn[j] >= 0) {
+          eind[n] = elem_node_conn[j];
+          n++;
+        }
+      }
+      eptr[i + 1] = n;
+    }
+
+    // Elements that share a node are adjacent, as in partitionMesh()
+    int wgtflag = 0, numflag = 0, ncon = 1, ncommonnodes = 1;
+    int *elmwgt = computePartitionWeights(&ncon);
+    if (elmwgt) {
+      wgtflag = 2;  // Weights on the vertices only
+    }
+    real_t *tpwgts = new real_t[ncon * split_size];
+    for (int i = 0; i < ncon * split_size; i++) {
+      tpwgts[i] = 1.0 / split_size;
+    }
+    real_t ubvec[2] = {1.05, 1.05};
+    int options[3] = {0, 0, 0};
+    int edgecut = 0;
+
+    int fail = ParMETIS_V3_PartMeshKway(
+        elmdist, eptr, eind, elmwgt, &wgtflag, &numflag, &ncon, &ncommonnodes,
+        &split_size, tpwgts, ubvec, options, &edgecut, partition, &comm);
+    if (fail != METIS_OK) {
+      fprintf(stderr, "[%d] TACSCreator: ParMETIS partitioning failed\n",
+              rank);
+      for (int k = 0; k < num_elements; k++) {
+        partition[k] = owner;
+      }
+    }
+
+    delete[] elmdist;
+    delete[] eptr;
+    delete[] eind;
+    delete[] tpwgts;
+    if (elmwgt) {
+      delete[] elmwgt;
+    }
+  }
+#endif  // TACS_HAS_PARMETIS
+}
+
+/*
+  Create the TACSAssembler object from a distributed mesh.
+
+  The elements are sent to the processors in the partition, retaining
+  their global order. Each node is owned by the processor that owns
+  the first element that references it, and the owned nodes are
+  numbered in the order that they first appear within the elements on
+  each processor. This is the same numbering as the serial code. The
+  nodal locations and boundary conditions are then sent from the
+  processors that set them to the new owners.
+*/
+TACSAssembler *TACSCreator::createDistributedTACS() {
+  int size, rank;
+  MPI_Comm_size(comm, &size);
+  MPI_Comm_rank(comm, &rank);
+
+  // Dependent nodes are not distributed
+  int fail = 0;
+  for (int i = 0; i < elem_node_ptr[num_elements]; i++) {
+    if (elem_node_conn[i] < 0 || elem_node_conn[i] >= node_range[size]) {
+      fail = 1;
+      break;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  if (fail || num_dependent_nodes > 0) {
+    if (rank == root_rank) {
+      fprintf(stderr,
+              "[%d] TACSCreator: Dependent or undefined nodes are not "
+              "supported for distributed meshes\n",
+              rank);
+    }
+    return NULL;
+  }
+
+  if (!partition) {
+    partitionMesh(size);
+  }
+
+  int *send_count = new int[size];
+  int *recv_count = new int[size];
+  int *conn_count = new int[size];
+
+  // Send the elements to their new owners with their global element
+  // number, element id and the number of nodes
+  int elem_offset = 0;
+  MPI_Exscan(&num_elements, &elem_offset, 1, MPI_INT, MPI_SUM, comm);
+  if (rank == 0) {
+    elem_offset = 0;
+  }
+
+  int *perm = order_by_dest(num_elements, partition, size, send_count);
+  int *send_elems = new int[3 * num_elements];
+  int *send_conn = new int[elem_node_ptr[num_elements]];
+  memset(conn_count, 0, size * sizeof(int));
+  for (int i = 0, c = 0; i < num_elements; i++) {
+    int e = perm[i];
+    send_elems[3 * i] = elem_offset + e;
+    send_elems[3 * i + 1] = elem_id_nums[e];
+    send_elems[3 * i + 2] = elem_node_ptr[e + 1] - elem_node_ptr[e];
+    conn_count[partition[e]] += send_elems[3 * i + 2];
+    for (int j = elem_node_ptr[e]; j < elem_node_ptr[e + 1]; j++, c++) {
+      send_conn[c] = elem_node_conn[j];
+    }
+  }
+  delete[] perm;
+
+  int *recv_elems, *local_elem_node_conn;
+  num_owned_elements = exchange_data(comm, MPI_INT, 3, send_count, send_elems,
+                                     recv_count, &recv_elems);
+  exchange_data(comm, MPI_INT, 1, conn_count, send_conn, recv_count,
+                &local_elem_node_conn);
+  delete[] send_elems;
+  delete[] send_conn;
+  delete[] conn_count;
+
+  // The elements are received in ascending global order
+  int *elem_nums = new int[num_owned_elements];
+  int *local_elem_node_ptr = new int[num_owned_elements + 1];
+  if (local_elem_id_nums) {
+    delete[] local_elem_id_nums;
+  }
+  local_elem_id_nums = new int[num_owned_elements];
+  local_elem_node_ptr[0] = 0;
+  for (int k = 0; k < num_owned_elements; k++) {
+    elem_nums[k] = recv_elems[3 * k];
+    local_elem_id_nums[k] = recv_elems[3 * k + 1];
+    local_elem_node_ptr[k + 1] = local_elem_node_ptr[k] + recv_elems[3 * k + 2];
+  }
+  delete[] recv_elems;
+
+  // Find the nodes referenced on this processor and the first
+  // element that references each of them
+  int conn_size = local_elem_node_ptr[num_owned_elements];
+  int *nodes = new int[conn_size];
+  memcpy(nodes, local_elem_node_conn, conn_size * sizeof(int));
+  int num_ref = TacsUniqueSort(conn_size, nodes);
+
+  int *local_conn = new int[conn_size];
+  int *first_elem = new int[2 * num_ref];
+  for (int i = 0; i < num_ref; i++) {
+    first_elem[2 * i] = nodes[i];
+    first_elem[2 * i + 1] = -1;
+  }
+  for (int k = 0; k < num_owned_elements; k++) {
+    for (int j = local_elem_node_ptr[k]; j < local_elem_node_ptr[k + 1]; j++) {
+      int index =
+          TacsSearchArray(local_elem_node_conn[j], num_ref, nodes) - nodes;
+      local_conn[j] = index;
+      if (first_elem[2 * index + 1] < 0) {
+        first_elem[2 * index + 1] = elem_nums[k];
+      }
+    }
+  }
+  delete[] elem_nums;
+
+  // Send the referenced nodes to the processors that set them. The
+  // nodes are sorted, so they are ordered by destination.
+  int *ext_ptr = new int[size + 1];
+  TacsMatchIntervals(size, node_range, num_ref, nodes, ext_ptr);
+  for (int i = 0; i < size; i++) {
+    send_count[i] = ext_ptr[i + 1] - ext_ptr[i];
+  }
+  delete[] ext_ptr;
+
+  int *recv_ref;
+  int num_recv = exchange_data(comm, MPI_INT, 2, send_count, first_elem,
+                               recv_count, &recv_ref);
+  delete[] first_elem;
+
+  // Find the owner of each node set on this processor
+  int offset = node_range[rank];
+  int *node_owner = new int[num_nodes];
+  int *node_elem = new int[num_nodes];
+  for (int k = 0; k < num_nodes; k++) {
+    node_owner[k] = -1;
+    node_elem[k] = -1;
+  }
+  for (int i = 0, j = 0; i < size; i++) {
+    for (int end = j + recv_count[i]; j < end; j++) {
+      int k = recv_ref[2 * j] - offset;
+      if (node_elem[k] < 0 || recv_ref[2 * j + 1] < node_elem[k]) {
+        node_elem[k] = recv_ref[2 * j + 1];
+        node_owner[k] = i;
+      }
+    }
+  }
+  delete[] node_elem;
+
+  // Return the owners of the referenced nodes
+  int *reply = new int[num_recv];
+  for (int j = 0; j < num_recv; j++) {
+    reply[j] = node_owner[recv_ref[2 * j] - offset];
+  }
+  int *ref_owner;
+  exchange_data(comm, MPI_INT, 1, recv_count, reply, send_count, &ref_owner);
+
+  // Number the owned nodes in the order that they first appear
+  int *ref_nodes = new int[num_ref];
+  for (int i = 0; i < num_ref; i++) {
+    ref_nodes[i] = -1;
+  }
+  num_owned_nodes = 0;
+  for (int j = 0; j < conn_size; j++) {
+    int index = local_conn[j];
+    if (ref_owner[index] == rank && ref_nodes[index] < 0) {
+      ref_nodes[index] = num_owned_nodes;
+      num_owned_nodes++;
+    }
+  }
+  delete[] ref_owner;
+
+  int node_offset = 0;
+  MPI_Exscan(&num_owned_nodes, &node_offset, 1, MPI_INT, MPI_SUM, comm);
+  if (rank == 0) {
+    node_offset = 0;
+  }
+  for (int i = 0; i < num_ref; i++) {
+    if (ref_nodes[i] >= 0) {
+      ref_nodes[i] += node_offset;
+    }
+  }
+
+  // Send the new numbers of the owned nodes to the processors that set
+  // them, and then return the new numbers of all referenced nodes
+  int *recv_nodes;
+  exchange_data(comm, MPI_INT, 1, send_count, ref_nodes, recv_count,
+                &recv_nodes);
+  if (new_nodes) {
+    delete[] new_nodes;
+  }
+  new_nodes = new int[num_nodes];
+  for (int k = 0; k < num_nodes; k++) {
+    new_nodes[k] = -1;
+  }
+  for (int j = 0; j < num_recv; j++) {
+    if (recv_nodes[j] >= 0) {
+      new_nodes[recv_ref[2 * j] - offset] = recv_nodes[j];
+    }
+  }
+  for (int j = 0; j < num_recv; j++) {
+    reply[j] = new_nodes[recv_ref[2 * j] - offset];
+  }
+  delete[] recv_nodes;
+  delete[] recv_ref;
+  delete[] ref_nodes;
+
+  int *ref_new_nodes;
+  exchange_data(comm, MPI_INT, 1, recv_count, reply, send_count,
+                &ref_new_nodes);
+  delete[] reply;
+
+  // Convert the connectivity to the new node numbers
+  for (int j = 0; j < conn_size; j++) {
+    local_elem_node_conn[j] = ref_new_nodes[local_conn[j]];
+  }
+  delete[] ref_new_nodes;
+  delete[] local_conn;
+  delete[] nodes;
+
+  // Send the nodal locations to the new owners. Nodes that are not
+  // referenced by any element are dropped.
+  int num_send = 0;
+  int *send_index = new int[num_nodes];
+  int *dest = new int[num_nodes];
+  for (int k = 0; k < num_nodes; k++) {
+    if (node_owner[k] >= 0) {
+      send_index[num_send] = k;
+      dest[num_send] = node_owner[k];
+      num_send++;
+    }
+  }
+  perm = order_by_dest(num_send, dest, size, send_count);
+  int *send_nodes = new int[num_send];
+  TacsScalar *send_xpts = new TacsScalar[3 * num_send];
+  for (int i = 0; i < num_send; i++) {
+    int k = send_index[perm[i]];
+    send_nodes[i] = new_nodes[k];
+    send_xpts[3 * i] = Xpts[3 * k];
+    send_xpts[3 * i + 1] = Xpts[3 * k + 1];
+    send_xpts[3 * i + 2] = Xpts[3 * k + 2];
+  }
+  delete[] perm;
+  delete[] send_index;
+  delete[] dest;
+
+  TacsScalar *recv_xpts;
+  int num_recv_nodes = exchange_data(comm, MPI_INT, 1, send_count, send_nodes,
+                                     recv_count, &recv_nodes);
+  exchange_data(comm, TACS_MPI_TYPE, 3, send_count, send_xpts, recv_count,
+                &recv_xpts);
+  delete[] send_nodes;
+  delete[] send_xpts;
+
+  TacsScalar *Xpts_local = new TacsScalar[3 * num_owned_nodes];
+  for (int i = 0; i < num_recv_nodes; i++) {
+    int k = recv_nodes[i] - node_offset;
+    Xpts_local[3 * k] = recv_xpts[3 * i];
+    Xpts_local[3 * k + 1] = recv_xpts[3 * i + 1];
+    Xpts_local[3 * k + 2] = recv_xpts[3 * i + 2];
+  }
+  delete[] recv_nodes;
+  delete[] recv_xpts;
+
+  // Send the boundary conditions to the new owners of the nodes
+  int num_send_bcs = 0;
+  int *bc_index = new int[num_bcs];
+  dest = new int[num_bcs];
+  for (int i = 0; i < num_bcs; i++) {
+    int k = bc_nodes[i] - offset;
+    if (k < 0 || k >= num_nodes) {
+      fprintf(stderr,
+              "[%d] TACSCreator: Boundary condition node %d is not set on "
+              "this processor\n",
+              rank, bc_nodes[i]);
+    } else if (node_owner[k] >= 0) {
+      bc_index[num_send_bcs] = i;
+      dest[num_send_bcs] = node_owner[k];
+      num_send_bcs++;
+    }
+  }
+  delete[] node_owner;
+
+  perm = order_by_dest(num_send_bcs, dest, size, send_count);
+  int *vars_count = new int[size];
+  memset(vars_count, 0, size * sizeof(int));
+  int *send_bcs = new int[2 * num_send_bcs];
+  int vars_size = (bc_ptr ? bc_ptr[num_bcs] : 0);
+  int *send_vars = new int[vars_size];
+  TacsScalar *send_vals = new TacsScalar[vars_size];
+  for (int i = 0, c = 0; i < num_send_bcs; i++) {
+    int b = bc_index[perm[i]];
+    send_bcs[2 * i] = new_nodes[bc_nodes[b] - offset];
+    send_bcs[2 * i + 1] = bc_ptr[b + 1] - bc_ptr[b];
+    vars_count[dest[perm[i]]] += bc_ptr[b + 1] - bc_ptr[b];
+    for (int j = bc_ptr[b]; j < bc_ptr[b + 1]; j++, c++) {
+      send_vars[c] = bc_vars[j];
+      send_vals[c] = bc_vals[j];
+    }
+  }
+  delete[] perm;
+  delete[] dest;
+  delete[] bc_index;
+
+  // Replace the boundary conditions with those for the owned nodes
+  if (bc_nodes) {
+    delete[] bc_nodes;
+  }
+  if (bc_ptr) {
+    delete[] bc_ptr;
+  }
+  if (bc_vars) {
+    delete[] bc_vars;
+  }
+  if (bc_vals) {
+    delete[] bc_vals;
+  }
+
+  int *recv_bcs;
+  num_bcs = exchange_data(comm, MPI_INT, 2, send_count, send_bcs, recv_count,
+                          &recv_bcs);
+  exchange_data(comm, MPI_INT, 1, vars_count, send_vars, recv_count,
+                &bc_vars);
+  exchange_data(comm, TACS_MPI_TYPE, 1, vars_count, send_vals, recv_count,
+                &bc_vals);
+  delete[] vars_count;
+  delete[] send_bcs;
+  delete[] send_vars;
+  delete[] send_vals;
+
+  bc_nodes = new int[num_bcs];
+  bc_ptr = new int[num_bcs + 1];
+  bc_ptr[0] = 0;
+  for (int k = 0; k < num_bcs; k++) {
+    bc_nodes[k] = recv_bcs[2 * k];
+    bc_ptr[k + 1] = bc_ptr[k] + recv_bcs[2 * k + 1];
+  }
+  delete[] recv_bcs;
+  delete[] send_count;
+  delete[] recv_count;
+
+  // Store the number of owned nodes and elements on all processors
+  if (owned_nodes) {
+    delete[] owned_nodes;
+  }
+  if (owned_elements) {
+    delete[] owned_elements;
+  }
+  owned_nodes = new int[size];
+  owned_elements = new int[size];
+  MPI_Allgather(&num_owned_nodes, 1, MPI_INT, owned_nodes, 1, MPI_INT, comm);
+  MPI_Allgather(&num_owned_elements, 1, MPI_INT, owned_elements, 1, MPI_INT,
+                comm);
+
+  TACSAssembler *tacs =
+      createAssembler(0, NULL, NULL, NULL, local_elem_node_ptr,
+                      local_elem_node_conn, Xpts_local);
+
+  delete[] local_elem_node_ptr;
+  delete[] local_elem_node_conn;
+  delete[] Xpts_local;
+
+  return tacs;
+}
+
 /*
   Retrieve the element numbers on each processor corresponding to the
   given component numbers.
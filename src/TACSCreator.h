@@ -35,14 +35,42 @@
   The user may wish to modify the ordering of TACS. This can be done
   by specifying the reordering type prior to calling createTACS().
 
+  By default, the mesh partition balances the number of elements on
+  each processor. Since the cost of the elements can differ by an
+  order of magnitude or more, the partition can instead balance the
+  estimated or measured element costs, the estimated number of matrix
+  non-zeros for the rows owned by each processor, or both at once
+  (see setPartitionWeights()).
+
   The new node numbers and new element partition can be retrieved from
   the creator object using the getNodeNums()/getElementPartion().
   Note that it is guaranteed that on each partiton, the elements will
   be numbered in ascending global order. This can be used to remap the
   distributed element order back to the original element order.
+
+  For meshes that are too large for a single processor, the mesh can
+  instead be set with setDistributedConnectivity(). Each processor
+  then sets a contiguous slice of the elements, and the nodes are
+  split into contiguous ranges, in the order of the processor ranks.
+  The nodal locations and the boundary conditions are set for the
+  nodes in the range owned by each processor. In this case
+  partitionMesh() and createTACS() are called on all processors: the
+  mesh is partitioned in parallel with ParMETIS, when TACS is compiled
+  with TACS_HAS_PARMETIS, and the data is then migrated to the new
+  owners. Without ParMETIS, the input element slices are retained.
+  The node and element partitions are then stored on each processor
+  for the nodes and elements it set, and the element and node
+  numbering follows the same rules as in the serial case.
 */
 class TACSCreator : public TACSObject {
  public:
+  enum PartitionWeightType {
+    UNIFORM_WEIGHTS = 0,           // Balance the number of elements
+    ELEMENT_COST_WEIGHTS = 1,      // Balance the element costs
+    NONZERO_WEIGHTS = 2,           // Balance the matrix non-zeros
+    COST_AND_NONZERO_WEIGHTS = 3   // Balance both costs and non-zeros
+  };
+
   TACSCreator(MPI_Comm comm, int _vars_per_node);
   ~TACSCreator();
 
@@ -53,6 +81,14 @@ class TACSCreator : public TACSObject {
                              const int *_elem_node_conn,
                              const int *_elem_id_nums);
 
+  // Set the connectivity for a mesh distributed across all processors
+  // ------------------------------------------------------------------
+  void setDistributedConnectivity(int _num_owned_nodes,
+                                  int _num_owned_elements,
+                                  const int *_elem_node_ptr,
+                                  const int *_elem_node_conn,
+                                  const int *_elem_id_nums);
+
   // Set the boundary conditions
   // ---------------------------
   void setBoundaryConditions(int _num_bcs, const int *_bc_nodes,
@@ -75,6 +111,13 @@ class TACSCreator : public TACSObject {
   void setReorderingType(TACSAssembler::OrderingType _order_type,
                          TACSAssembler::MatrixOrderingType _mat_type);
 
+  // Set the weights used to balance the partition
+  // ----------------------------------------------
+  void setPartitionWeights(PartitionWeightType _weight_type);
+  void setElementCosts(const double *costs);
+  void setElementIdCosts(int num_ids, const double *id_costs);
+  void setElementCosts(TACSAssembler *assembler, const double *local_costs);
+
   // Partition the mesh
   // ------------------
   void partitionMesh(int split_size = 0, const int *part = NULL);
@@ -88,6 +131,15 @@ class TACSCreator : public TACSObject {
   // -------------------------------
   TACSAssembler *createTACS();
 
+  // Repartition with measured costs and copy the assembler state
+  // ------------------------------------------------------------
+  TACSAssembler *repartition(TACSAssembler *assembler,
+                             const double *local_costs);
+
+  // Copy the mesh definition to a creator on a sub-communicator
+  // -----------------------------------------------------------
+  TACSCreator *createSubCreator(MPI_Comm sub_comm);
+
   // Get local element numbers with the given set of element-id numbers
   // ------------------------------------------------------------------
   int getElementIdNums(int num_ids, int *ids, int **elem_nums);
@@ -106,6 +158,27 @@ class TACSCreator : public TACSObject {
   void getNumOwnedElements(int **_owned_elements);
 
  private:
+  // Compute the integer vertex weights for the partitioner
+  int *computePartitionWeights(int *ncon);
+
+  // Partition, distribute and create TACS from a distributed mesh
+  void partitionDistributedMesh(int split_size, const int *part);
+  TACSAssembler *createDistributedTACS();
+
+  // Copy a vector between assemblers with different partitions
+  void migrateVec(TACSAssembler *src_assembler, const int *src_nodes,
+                  TACSBVec *src, TACSAssembler *dest_assembler,
+                  const int *dest_nodes, TACSBVec *dest);
+
+  // Create TACSAssembler from the local part of the mesh
+  TACSAssembler *createAssembler(int num_local_dep_nodes,
+                                 const int *local_dep_node_ptr,
+                                 const int *local_dep_node_conn,
+                                 const double *local_dep_node_weights,
+                                 const int *local_elem_node_ptr,
+                                 const int *local_elem_node_conn,
+                                 const TacsScalar *Xpts_local);
+
   // The magic element-generator function pointer
   TACSElement *(*element_creator)(int local, int elem_id);
 
@@ -121,8 +194,12 @@ class TACSCreator : public TACSObject {
   MPI_Comm comm;
   int root_rank;
 
-  // The global connectivity information
+  // The global connectivity information. For a distributed mesh,
+  // these are the nodes and elements set on this processor, and
+  // node_range stores the input node ranges for all processors.
   int num_nodes, num_elements;
+  int distributed;
+  int *node_range;
 
   // The dependent node data, connectivity and weights
   int num_dependent_nodes;
@@ -150,12 +227,20 @@ class TACSCreator : public TACSObject {
   // Keep the number of owned nodes/elements
   int *owned_nodes, *owned_elements;
 
-  // The new node numbers for the independent nodes
+  // The new node numbers for the independent nodes. For a distributed
+  // mesh, only the new numbers of the input nodes on this processor.
   int *new_nodes;
 
   // The element partition
   int *partition;
 
+  // The weights used to balance the partition, and the element costs
+  // for each element or for each element-id number
+  PartitionWeightType weight_type;
+  double *elem_costs;
+  int num_id_costs;
+  double *elem_id_costs;
+
   // Local information about the partitioned mesh
   int num_owned_elements, num_owned_nodes;
   int *local_elem_id_nums;
@@ -0,0 +1,348 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSDensityFilter.h"
+
+#include "TACSKDTree.h"
+#include "TacsUtilities.h"
+
+/*
+  Create the density filter. This is collective on the communicator of
+  the assembler.
+
+  input:
+  assembler:   the TACSAssembler object
+  radius:      the filter radius
+*/
+TACSDensityFilter::TACSDensityFilter(TACSAssembler *_assembler,
+                                     double _radius) {
+  assembler = _assembler;
+  assembler->incref();
+  radius = _radius;
+  beta = 0.0;
+  eta = 0.5;
+
+  MPI_Comm comm = assembler->getMPIComm();
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  TACSNodeMap *dv_map = assembler->getDesignNodeMap();
+  const int *range;
+  dv_map->getOwnerRange(&range);
+  int num_owned = range[mpi_rank + 1] - range[mpi_rank];
+
+  // Find the design variables used by the elements on this processor
+  int num_elements = assembler->getNumElements();
+  int max_dvs = assembler->getMaxElementDesignVars();
+  int *dvs = new int[max_dvs];
+  int size = 0;
+  for (int i = 0; i < num_elements; i++) {
+    TACSElement *elem = assembler->getElement(i);
+    size += elem->getDesignVarNums(i, max_dvs, dvs);
+  }
+  int *dv_nums = new int[size];
+  int num_dvs = 0;
+  for (int i = 0; i < num_elements; i++) {
+    TACSElement *elem = assembler->getElement(i);
+    int n = elem->getDesignVarNums(i, max_dvs, dvs);
+    for (int j = 0; j < n; j++) {
+      if (dvs[j] >= 0) {
+        dv_nums[num_dvs] = dvs[j];
+        num_dvs++;
+      }
+    }
+  }
+  num_dvs = TacsUniqueSort(num_dvs, dv_nums);
+
+  // Add the element centroids to the design variables they use
+  TacsScalar *loc = new TacsScalar[4 * num_dvs];
+  memset(loc, 0, 4 * num_dvs * sizeof(TacsScalar));
+  TacsScalar *Xpts = new TacsScalar[3 * assembler->getMaxElementNodes()];
+  for (int i = 0; i < num_elements; i++) {
+    TACSElement *elem = assembler->getElement(i, Xpts);
+    int num_nodes = elem->getNumNodes();
+    const double inv = 1.0 / num_nodes;
+    TacsScalar c[3] = {0.0, 0.0, 0.0};
+    for (int j = 0; j < num_nodes; j++) {
+      c[0] += Xpts[3 * j];
+      c[1] += Xpts[3 * j + 1];
+      c[2] += Xpts[3 * j + 2];
+    }
+    int n = elem->getDesignVarNums(i, max_dvs, dvs);
+    for (int j = 0; j < n; j++) {
+      int *item = TacsSearchArray(dvs[j], num_dvs, dv_nums);
+      if (item) {
+        TacsScalar *l = &loc[4 * (item - dv_nums)];
+        l[0] += inv * c[0];
+        l[1] += inv * c[1];
+        l[2] += inv * c[2];
+        l[3] += 1.0;
+      }
+    }
+  }
+  delete[] dvs;
+  delete[] Xpts;
+
+  // Add the contributions to the design variables on their owners
+  TacsScalar *owned = new TacsScalar[4 * num_owned];
+  memset(owned, 0, 4 * num_owned * sizeof(TacsScalar));
+  TACSBVecIndices *indices = new TACSBVecIndices(&dv_nums, num_dvs);
+  TACSBVecDistribute *dist = new TACSBVecDistribute(dv_map, indices);
+  dist->incref();
+  TACSBVecDistCtx *ctx = dist->createCtx(4);
+  ctx->incref();
+  dist->beginReverse(ctx, loc, owned, TACS_ADD_VALUES);
+  dist->endReverse(ctx, loc, owned, TACS_ADD_VALUES);
+  ctx->decref();
+  dist->decref();
+  delete[] loc;
+
+  // Compute the locations of the owned design variables and their
+  // bounding box. Design variables not used by any element are left
+  // out of the filter.
+  int num_used = 0;
+  int *used = new int[num_owned];
+  TacsScalar *Xown = new TacsScalar[3 * num_owned];
+  double box[6] = {1e300, 1e300, 1e300, -1e300, -1e300, -1e300};
+  for (int i = 0; i < num_owned; i++) {
+    if (TacsRealPart(owned[4 * i + 3]) > 0.0) {
+      for (int k = 0; k < 3; k++) {
+        Xown[3 * num_used + k] = owned[4 * i + k] / owned[4 * i + 3];
+        double x = TacsRealPart(Xown[3 * num_used + k]);
+        if (x < box[k]) {
+          box[k] = x;
+        }
+        if (x > box[3 + k]) {
+          box[3 + k] = x;
+        }
+      }
+      used[num_used] = range[mpi_rank] + i;
+      num_used++;
+    }
+  }
+  delete[] owned;
+
+  // Send the owned locations to the processors whose bounding box is
+  // within the filter radius of this one
+  double *boxes = new double[6 * mpi_size];
+  MPI_Allgather(box, 6, MPI_DOUBLE, boxes, 6, MPI_DOUBLE, comm);
+  int *send_count = new int[mpi_size];
+  int *send_ptr = new int[mpi_size + 1];
+  int *recv_count = new int[mpi_size];
+  int *recv_ptr = new int[mpi_size + 1];
+  for (int p = 0; p < mpi_size; p++) {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; k++) {
+      double gap = boxes[6 * p + k] - box[3 + k];
+      if (box[k] - boxes[6 * p + 3 + k] > gap) {
+        gap = box[k] - boxes[6 * p + 3 + k];
+      }
+      if (gap > 0.0) {
+        d2 += gap * gap;
+      }
+    }
+    send_count[p] = 0;
+    if (p != mpi_rank && num_used > 0 && d2 <= radius * radius) {
+      send_count[p] = num_used;
+    }
+  }
+  delete[] boxes;
+
+  MPI_Alltoall(send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+  send_ptr[0] = recv_ptr[0] = 0;
+  for (int p = 0; p < mpi_size; p++) {
+    send_ptr[p + 1] = send_ptr[p] + send_count[p];
+    recv_ptr[p + 1] = recv_ptr[p] + recv_count[p];
+  }
+
+  // The owned locations are followed by the received locations
+  int num_pts = num_used + recv_ptr[mpi_size];
+  int *nums = new int[num_pts];
+  TacsScalar *X = new TacsScalar[3 * num_pts];
+  memcpy(nums, used, num_used * sizeof(int));
+  memcpy(X, Xown, 3 * num_used * sizeof(TacsScalar));
+
+  int *send_nums = new int[send_ptr[mpi_size]];
+  TacsScalar *send_X = new TacsScalar[3 * send_ptr[mpi_size]];
+  for (int p = 0; p < mpi_size; p++) {
+    if (send_count[p] > 0) {
+      memcpy(&send_nums[send_ptr[p]], used, num_used * sizeof(int));
+      memcpy(&send_X[3 * send_ptr[p]], Xown,
+             3 * num_used * sizeof(TacsScalar));
+    }
+  }
+  MPI_Alltoallv(send_nums, send_count, send_ptr, MPI_INT, &nums[num_used],
+                recv_count, recv_ptr, MPI_INT, comm);
+  for (int p = 0; p < mpi_size; p++) {
+    send_count[p] *= 3;
+    send_ptr[p + 1] *= 3;
+    recv_count[p] *= 3;
+    recv_ptr[p + 1] *= 3;
+  }
+  MPI_Alltoallv(send_X, send_count, send_ptr, TACS_MPI_TYPE, &X[3 * num_used],
+                recv_count, recv_ptr, TACS_MPI_TYPE, comm);
+  delete[] send_nums;
+  delete[] send_X;
+  delete[] send_count;
+  delete[] send_ptr;
+  delete[] recv_count;
+  delete[] recv_ptr;
+
+  // Add the rows of the filter for the owned design variables
+  int dvs_per_node = assembler->getDesignVarsPerNode();
+  filter = new TACSBVecInterp(dv_map, dv_map, dvs_per_node);
+  filter->incref();
+
+  TACSKDTree *tree = new TACSKDTree(num_pts, X);
+  tree->incref();
+  int max_size = 64;
+  int *index = new int[max_size];
+  int *cols = new int[max_size];
+  TacsScalar *weights = new TacsScalar[max_size];
+  for (int i = 0; i < num_used; i++) {
+    const TacsScalar *pt = &X[3 * i];
+    int n = tree->findInRadius(pt, radius, max_size, index);
+    if (n > max_size) {
+      max_size = 2 * n;
+      delete[] index;
+      delete[] cols;
+      delete[] weights;
+      index = new int[max_size];
+      cols = new int[max_size];
+      weights = new TacsScalar[max_size];
+      n = tree->findInRadius(pt, radius, max_size, index);
+    }
+
+    TacsScalar sum = 0.0;
+    for (int j = 0; j < n; j++) {
+      const TacsScalar *xj = &X[3 * index[j]];
+      TacsScalar d2 = ((xj[0] - pt[0]) * (xj[0] - pt[0]) +
+                       (xj[1] - pt[1]) * (xj[1] - pt[1]) +
+                       (xj[2] - pt[2]) * (xj[2] - pt[2]));
+      TacsScalar d = 0.0;
+      if (TacsRealPart(d2) > 0.0) {
+        d = sqrt(d2);
+      }
+      cols[j] = nums[index[j]];
+      weights[j] = radius - d;
+      sum += weights[j];
+    }
+    for (int j = 0; j < n; j++) {
+      weights[j] /= sum;
+    }
+    filter->addInterp(nums[i], weights, cols, n);
+  }
+  tree->decref();
+  delete[] index;
+  delete[] cols;
+  delete[] weights;
+  delete[] nums;
+  delete[] X;
+
+  // The unused design variables are passed through the filter
+  TacsScalar one = 1.0;
+  for (int i = 0, j = 0; i < num_owned; i++) {
+    int num = range[mpi_rank] + i;
+    if (j < num_used && used[j] == num) {
+      j++;
+    } else {
+      filter->addInterp(num, &one, &num, 1);
+    }
+  }
+  delete[] used;
+  delete[] Xown;
+
+  filter->initialize();
+
+  xtilde = assembler->createDesignVec();
+  xtilde->incref();
+  temp = assembler->createDesignVec();
+  temp->incref();
+}
+
+TACSDensityFilter::~TACSDensityFilter() {
+  assembler->decref();
+  filter->decref();
+  xtilde->decref();
+  temp->decref();
+}
+
+/*
+  Set the parameters of the Heaviside projection
+
+  input:
+  beta:   the sharpness of the projection (0 for no projection)
+  eta:    the threshold of the projection
+*/
+void TACSDensityFilter::setProjection(double _beta, double _eta) {
+  beta = _beta;
+  eta = _eta;
+}
+
+/*
+  Apply the filter and the projection to the design variables
+
+  input:
+  x:       the design variables
+
+  output:
+  xfilt:   the filtered and projected design variables
+*/
+void TACSDensityFilter::applyFilter(TACSBVec *x, TACSBVec *xfilt) {
+  filter->mult(x, xtilde);
+  xfilt->copyValues(xtilde);
+
+  if (beta > 0.0) {
+    TacsScalar *xf;
+    int size = xfilt->getArray(&xf);
+    double t0 = tanh(beta * eta);
+    double denom = t0 + tanh(beta * (1.0 - eta));
+    for (int i = 0; i < size; i++) {
+      xf[i] = (t0 + tanh(beta * (xf[i] - eta))) / denom;
+    }
+  }
+}
+
+/*
+  Compute the derivative w.r.t. the design variables from the
+  derivative w.r.t. the filtered design variables. This uses the
+  filtered values from the last call to applyFilter().
+
+  input:
+  dfdxfilt:   the derivative w.r.t. the filtered design variables
+
+  output:
+  dfdx:       the derivative w.r.t. the design variables
+*/
+void TACSDensityFilter::applyFilterSens(TACSBVec *dfdxfilt, TACSBVec *dfdx) {
+  temp->copyValues(dfdxfilt);
+
+  if (beta > 0.0) {
+    TacsScalar *t, *xt;
+    int size = temp->getArray(&t);
+    xtilde->getArray(&xt);
+    double denom = tanh(beta * eta) + tanh(beta * (1.0 - eta));
+    for (int i = 0; i < size; i++) {
+      TacsScalar th = tanh(beta * (xt[i] - eta));
+      t[i] *= beta * (1.0 - th * th) / denom;
+    }
+  }
+
+  filter->multTranspose(temp, dfdx);
+}
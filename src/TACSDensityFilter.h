@@ -0,0 +1,84 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_DENSITY_FILTER_H
+#define TACS_DENSITY_FILTER_H
+
+#include "TACSAssembler.h"
+#include "TACSBVecInterp.h"
+
+/*
+  A density filter with Heaviside projection for topology optimization
+
+  The filtered densities are a weighted average of the design
+  variables within the filter radius
+
+  x_f[i] = sum_j w_ij x[j] / sum_j w_ij,  w_ij = max(0, r - ||X_i - X_j||)
+
+  where the location X_i of each design variable is the average of the
+  centroids of the elements that use it. This covers both element-wise
+  and nodal densities. The filter is stored as a TACSBVecInterp on the
+  design variable map of the assembler, so it is applied in parallel on
+  the design vectors. The locations are only exchanged between the
+  processors whose design variables are within the filter radius of
+  each other.
+
+  When the projection parameter beta is positive, the filtered
+  densities are projected with the smoothed Heaviside function
+
+  x_p = (tanh(beta*eta) + tanh(beta*(x_f - eta))) /
+        (tanh(beta*eta) + tanh(beta*(1 - eta)))
+
+  and the sensitivities are computed by the chain rule through the
+  projection and the transpose of the filter.
+*/
+class TACSDensityFilter : public TACSObject {
+ public:
+  TACSDensityFilter(TACSAssembler *_assembler, double _radius);
+  ~TACSDensityFilter();
+
+  // Set the projection parameters (beta = 0 for no projection)
+  // ----------------------------------------------------------
+  void setProjection(double _beta, double _eta = 0.5);
+
+  // Apply the filter and compute the sensitivities
+  // ----------------------------------------------
+  void applyFilter(TACSBVec *x, TACSBVec *xfilt);
+  void applyFilterSens(TACSBVec *dfdxfilt, TACSBVec *dfdx);
+
+  // Get the underlying filter operator
+  // ----------------------------------
+  TACSBVecInterp *getFilter() { return filter; }
+
+ private:
+  // The assembler object
+  TACSAssembler *assembler;
+
+  // The filter radius and the projection parameters
+  double radius;
+  double beta, eta;
+
+  // The filter operator
+  TACSBVecInterp *filter;
+
+  // The filtered densities from the last call to applyFilter()
+  TACSBVec *xtilde;
+  TACSBVec *temp;
+};
+
+#endif  // TACS_DENSITY_FILTER_H
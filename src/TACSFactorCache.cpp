@@ -0,0 +1,150 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSFactorCache.h"
+
+/*
+  Create the matrix and perform the symbolic factorization
+
+  @param assembler The finite-element model
+  @param lev_fill The level of fill for the factorization
+  @param fill The expected fill ratio
+  @param reorder_schur Flag to reorder the global Schur complement
+*/
+TACSFactorCache::TACSFactorCache(TACSAssembler *_assembler, int lev_fill,
+                                 double fill, int reorder_schur) {
+  assembler = _assembler;
+  assembler->incref();
+
+  mat = assembler->createSchurMat();
+  mat->incref();
+  pc = new TACSSchurPc(mat, lev_fill, fill, reorder_schur);
+  pc->incref();
+  solver = new GMRES(mat, pc, 10, 0, 0);
+  solver->incref();
+  solver->setTolerances(1e-12, 1e-30);
+
+  linear = 0;
+  valid = 0;
+  num_mats = 0;
+  design_version = state_version = 0;
+  num_factor = num_reuse = 0;
+}
+
+TACSFactorCache::~TACSFactorCache() {
+  assembler->decref();
+  mat->decref();
+  pc->decref();
+  solver->decref();
+}
+
+/*
+  Invalidate the factorization so that the next call to factor()
+  assembles and factors the matrix
+*/
+void TACSFactorCache::invalidate() { valid = 0; }
+
+/*
+  Factor the linear combination of matrices
+
+  sum_{i} scale[i]*A(types[i])
+
+  The factorization is skipped if the same combination is already
+  factored and the model has not changed.
+
+  @param nmats The number of matrices
+  @param types The matrix types
+  @param scale The scalar coefficients for each matrix
+  @return 1 if the matrix was factored, 0 if the factorization was re-used
+*/
+int TACSFactorCache::factor(int nmats, const ElementMatrixType types[],
+                            const TacsScalar scale[]) {
+  if (nmats > MAX_NUM_MATRICES) {
+    fprintf(stderr,
+            "TACSFactorCache: Number of matrices %d exceeds the maximum %d\n",
+            nmats, MAX_NUM_MATRICES);
+    nmats = MAX_NUM_MATRICES;
+  }
+
+  // Check whether any of the matrices depend on the states
+  int state_dependent = !linear;
+  for (int i = 0; i < nmats; i++) {
+    if (types[i] != TACS_STIFFNESS_MATRIX && types[i] != TACS_MASS_MATRIX) {
+      state_dependent = 1;
+    }
+  }
+
+  int design = assembler->getDesignVersion();
+  int state = assembler->getStateVersion();
+
+  // Check whether the factored combination matches
+  int current = (valid && nmats == num_mats && design == design_version &&
+                 (!state_dependent || state == state_version));
+  for (int i = 0; current && i < nmats; i++) {
+    if (types[i] != mat_types[i] || scale[i] != mat_scale[i]) {
+      current = 0;
+    }
+  }
+
+  if (current) {
+    num_reuse++;
+    return 0;
+  }
+
+  // Assemble the combination and factor it
+  for (int i = 0; i < nmats; i++) {
+    mat_types[i] = types[i];
+    mat_scale[i] = scale[i];
+  }
+  assembler->assembleMatCombo(mat_types, mat_scale, nmats, mat);
+  pc->factor();
+
+  valid = 1;
+  num_mats = nmats;
+  design_version = design;
+  state_version = state;
+  num_factor++;
+
+  return 1;
+}
+
+/*
+  Factor the stiffness matrix if it is not current
+*/
+int TACSFactorCache::factorStiffness() {
+  ElementMatrixType type = TACS_STIFFNESS_MATRIX;
+  TacsScalar scale = 1.0;
+  return factor(1, &type, &scale);
+}
+
+/*
+  Solve K*ans = rhs, factoring the stiffness matrix if required
+*/
+void TACSFactorCache::solve(TACSBVec *rhs, TACSBVec *ans) {
+  factorStiffness();
+  solver->solve(rhs, ans);
+}
+
+/*
+  Get the number of numeric factorizations and the number of times the
+  factorization was re-used
+*/
+void TACSFactorCache::getStatistics(int *_num_factor, int *_num_reuse) {
+  if (_num_factor) {
+    *_num_factor = num_factor;
+  }
+  if (_num_reuse) {
+    *_num_reuse = num_reuse;
+  }
+}
@@ -0,0 +1,99 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_FACTOR_CACHE_H
+#define TACS_FACTOR_CACHE_H
+
+#include "TACSAssembler.h"
+
+/*
+  A direct factorization shared between the static, adjoint, buckling
+  and frequency analyses of a model
+
+  The stiffness matrix K and the shifted matrices K - sigma*G and
+  K - sigma*M all have the non-zero pattern of the model. This class
+  owns a single TACSSchurMat and TACSSchurPc, so the reordering and the
+  symbolic factorization are computed once and re-used for all of these
+  matrices and across design iterations. Each call to factor() assembles
+  and numerically factors the requested linear combination of matrices,
+  unless the same combination has already been factored and the model
+  has not changed since.
+
+  Changes to the model are detected with the design and state versions
+  of TACSAssembler. When the linear flag is set, the stiffness and mass
+  matrices are assumed to be independent of the state variables. Other
+  changes, for instance to the element data set directly, require a
+  call to invalidate().
+
+  The solver is a direct solve with the factorization. Since K is
+  symmetric, the same factorization is used for the adjoint solves.
+*/
+class TACSFactorCache : public TACSObject {
+ public:
+  static const int MAX_NUM_MATRICES = 4;
+
+  TACSFactorCache(TACSAssembler *_assembler, int lev_fill = 1000000,
+                  double fill = 10.0, int reorder_schur = 1);
+  ~TACSFactorCache();
+
+  // Retrieve the matrix, preconditioner and solver
+  // ----------------------------------------------
+  TACSSchurMat *getMat() { return mat; }
+  TACSSchurPc *getPc() { return pc; }
+  TACSKsm *getSolver() { return solver; }
+
+  // Set whether K and M are independent of the states
+  // -------------------------------------------------
+  void setLinear(int flag) { linear = flag; }
+
+  // Factor the linear combination of matrices if it is not current
+  // ---------------------------------------------------------------
+  int factor(int nmats, const ElementMatrixType types[],
+             const TacsScalar scale[]);
+  int factorStiffness();
+  void invalidate();
+
+  // Solve with the stiffness matrix
+  // -------------------------------
+  void solve(TACSBVec *rhs, TACSBVec *ans);
+
+  // Get the number of numeric factorizations and re-uses
+  // ----------------------------------------------------
+  void getStatistics(int *_num_factor, int *_num_reuse);
+
+ private:
+  // The finite-element model
+  TACSAssembler *assembler;
+
+  // The matrix, the direct factorization and the solver
+  TACSSchurMat *mat;
+  TACSSchurPc *pc;
+  TACSKsm *solver;
+
+  // Flag to indicate whether K and M are independent of the states
+  int linear;
+
+  // The combination of matrices that is currently factored and the
+  // versions of the model when it was factored
+  int valid;
+  int num_mats;
+  ElementMatrixType mat_types[MAX_NUM_MATRICES];
+  TacsScalar mat_scale[MAX_NUM_MATRICES];
+  int design_version, state_version;
+
+  // Statistics for the factorizations
+  int num_factor, num_reuse;
+};
+
+#endif  // TACS_FACTOR_CACHE_H
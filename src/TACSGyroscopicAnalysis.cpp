@@ -0,0 +1,380 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSGyroscopicAnalysis.h"
+
+#include "tacslapack.h"
+
+/*
+  Create the quadratic eigenvalue analysis
+
+  @param assembler The TACSAssembler model
+  @param sigma The real shift for the eigenvalues
+  @param kmat The matrix for the shifted problem K + sigma*G + sigma^2*M
+  @param gmat The gyroscopic and damping matrix
+  @param mmat The mass matrix
+  @param solver The solver associated with kmat
+  @param max_arnoldi The size of the Arnoldi subspace
+  @param num_eigvals The number of requested eigenvalues
+  @param eig_tol The relative tolerance for the eigenvalues
+*/
+TACSGyroscopicAnalysis::TACSGyroscopicAnalysis(
+    TACSAssembler *_assembler, double _sigma, TACSMat *_kmat, TACSMat *_gmat,
+    TACSMat *_mmat, TACSKsm *_solver, int _max_arnoldi, int _num_eigvals,
+    double _eig_tol) {
+  assembler = _assembler;
+  assembler->incref();
+
+  sigma = _sigma;
+  kmat = _kmat;
+  gmat = _gmat;
+  mmat = _mmat;
+  kmat->incref();
+  gmat->incref();
+  mmat->incref();
+
+  // Ensure that the solver is associated with the shifted matrix
+  TACSMat *mat;
+  solver = _solver;
+  solver->incref();
+  solver->getOperators(&mat, &pc);
+  if (mat != kmat) {
+    fprintf(stderr,
+            "TACSGyroscopicAnalysis: Solver must be associated with the "
+            "shifted matrix\n");
+  }
+
+  max_arnoldi = _max_arnoldi;
+  num_eigvals = _num_eigvals;
+  if (num_eigvals > max_arnoldi) {
+    num_eigvals = max_arnoldi;
+  }
+  eig_tol = _eig_tol;
+
+  // Allocate the companion vectors
+  Vu = new TACSVec *[max_arnoldi + 1];
+  Vv = new TACSVec *[max_arnoldi + 1];
+  for (int i = 0; i <= max_arnoldi; i++) {
+    Vu[i] = assembler->createVec();
+    Vu[i]->incref();
+    Vv[i] = assembler->createVec();
+    Vv[i]->incref();
+  }
+  temp = assembler->createVec();
+  temp->incref();
+
+  niters = 0;
+  H = new double[(max_arnoldi + 1) * max_arnoldi];
+  eigreal = new double[max_arnoldi];
+  eigimag = new double[max_arnoldi];
+  eigerror = new double[max_arnoldi];
+  ritzvecs = new double[max_arnoldi * max_arnoldi];
+  perm = new int[max_arnoldi];
+}
+
+TACSGyroscopicAnalysis::~TACSGyroscopicAnalysis() {
+  assembler->decref();
+  kmat->decref();
+  gmat->decref();
+  mmat->decref();
+  solver->decref();
+  for (int i = 0; i <= max_arnoldi; i++) {
+    Vu[i]->decref();
+    Vv[i]->decref();
+  }
+  delete[] Vu;
+  delete[] Vv;
+  temp->decref();
+  delete[] H;
+  delete[] eigreal;
+  delete[] eigimag;
+  delete[] eigerror;
+  delete[] ritzvecs;
+  delete[] perm;
+}
+
+/*
+  Apply the shift-invert operator (A - sigma*B)^{-1}*B to [u, v]
+
+  The result is
+
+  yu = -Q(sigma)^{-1}*(M*(v + sigma*u) + G*u)
+  yv = u + sigma*yu
+*/
+void TACSGyroscopicAnalysis::applyOperator(TACSVec *u, TACSVec *v, TACSVec *yu,
+                                           TACSVec *yv) {
+  temp->copyValues(v);
+  temp->axpy(sigma, u);
+  mmat->mult(temp, yv);
+  gmat->mult(u, temp);
+  yv->axpy(1.0, temp);
+  assembler->applyBCs(yv);
+
+  solver->solve(yv, yu);
+  yu->scale(-1.0);
+  assembler->applyBCs(yu);
+
+  yv->copyValues(u);
+  yv->axpy(sigma, yu);
+}
+
+/*
+  Assemble the matrices, factor the shifted matrix and compute the
+  eigenvalues with the Arnoldi method
+*/
+void TACSGyroscopicAnalysis::solve(KSMPrint *ksm_print, int print_level) {
+  double t0 = MPI_Wtime();
+
+  // Assemble the linearized matrices about the current state
+  assembler->assembleJacobian(1.0, sigma, sigma * sigma, NULL, kmat);
+  assembler->assembleJacobian(0.0, 1.0, 0.0, NULL, gmat);
+  assembler->assembleJacobian(0.0, 0.0, 1.0, NULL, mmat);
+  pc->factor();
+
+  // Set a random starting vector
+  Vu[0]->setRand(-1.0, 1.0);
+  Vv[0]->setRand(-1.0, 1.0);
+  assembler->applyBCs(Vu[0]);
+  assembler->applyBCs(Vv[0]);
+  TacsScalar norm = sqrt(Vu[0]->dot(Vu[0]) + Vv[0]->dot(Vv[0]));
+  Vu[0]->scale(1.0 / norm);
+  Vv[0]->scale(1.0 / norm);
+
+  // Build the Arnoldi subspace with two passes of classical
+  // Gram-Schmidt orthogonalization
+  const int ldh = max_arnoldi + 1;
+  memset(H, 0, ldh * max_arnoldi * sizeof(double));
+  TacsScalar *hu = new TacsScalar[max_arnoldi + 1];
+  TacsScalar *hv = new TacsScalar[max_arnoldi + 1];
+
+  double beta = 0.0;
+  niters = 0;
+  for (int k = 0; k < max_arnoldi; k++) {
+    applyOperator(Vu[k], Vv[k], Vu[k + 1], Vv[k + 1]);
+
+    for (int pass = 0; pass < 2; pass++) {
+      Vu[k + 1]->mdot(Vu, hu, k + 1);
+      Vv[k + 1]->mdot(Vv, hv, k + 1);
+      for (int j = 0; j <= k; j++) {
+        TacsScalar h = hu[j] + hv[j];
+        H[j + ldh * k] += TacsRealPart(h);
+        Vu[k + 1]->axpy(-h, Vu[j]);
+        Vv[k + 1]->axpy(-h, Vv[j]);
+      }
+    }
+
+    norm = sqrt(Vu[k + 1]->dot(Vu[k + 1]) + Vv[k + 1]->dot(Vv[k + 1]));
+    beta = TacsRealPart(norm);
+    H[k + 1 + ldh * k] = beta;
+    niters++;
+
+    // Check for breakdown of the subspace
+    if (beta < 1e-14 * fabs(H[k + ldh * k])) {
+      beta = 0.0;
+      break;
+    }
+    Vu[k + 1]->scale(1.0 / norm);
+    Vv[k + 1]->scale(1.0 / norm);
+  }
+
+  delete[] hu;
+  delete[] hv;
+
+  // Compute the eigenvalues and eigenvectors of the Hessenberg matrix
+  int n = niters;
+  double *A = new double[n * n];
+  for (int j = 0; j < n; j++) {
+    memcpy(&A[n * j], &H[ldh * j], n * sizeof(double));
+  }
+  double *wr = new double[n];
+  double *wi = new double[n];
+  int lwork = 10 * n;
+  double *work = new double[lwork];
+  int ldvl = 1, info = 0;
+  LAPACKdgeev("N", "V", &n, A, &n, wr, wi, NULL, &ldvl, ritzvecs, &n, work,
+              &lwork, &info);
+  if (info != 0) {
+    fprintf(stderr,
+            "TACSGyroscopicAnalysis: LAPACK dgeev failed with info = %d\n",
+            info);
+  }
+
+  // Convert the eigenvalues mu = 1/(lambda - sigma) and estimate the
+  // relative error from the last component of the Ritz vectors
+  for (int j = 0; j < n; j++) {
+    double d = wr[j] * wr[j] + wi[j] * wi[j];
+    eigreal[j] = sigma + wr[j] / d;
+    eigimag[j] = -wi[j] / d;
+
+    double ylast = fabs(ritzvecs[n - 1 + n * j]);
+    if (wi[j] > 0.0) {
+      ylast = sqrt(ylast * ylast + ritzvecs[n - 1 + n * (j + 1)] *
+                                       ritzvecs[n - 1 + n * (j + 1)]);
+    } else if (wi[j] < 0.0) {
+      ylast = sqrt(ylast * ylast + ritzvecs[n - 1 + n * (j - 1)] *
+                                       ritzvecs[n - 1 + n * (j - 1)]);
+    }
+    eigerror[j] = beta * ylast / sqrt(d);
+  }
+
+  // Sort the eigenvalues by the distance from the shift and order the
+  // complex conjugate pairs with the positive imaginary part first
+  for (int j = 0; j < n; j++) {
+    perm[j] = j;
+  }
+  for (int j = 1; j < n; j++) {
+    int p = perm[j];
+    double dp = wr[p] * wr[p] + wi[p] * wi[p];
+    int i = j - 1;
+    for (; i >= 0; i--) {
+      int q = perm[i];
+      double dq = wr[q] * wr[q] + wi[q] * wi[q];
+      if (dq > dp || (dq == dp && eigimag[q] >= eigimag[p])) {
+        break;
+      }
+      perm[i + 1] = q;
+    }
+    perm[i + 1] = p;
+  }
+
+  delete[] A;
+  delete[] wr;
+  delete[] wi;
+  delete[] work;
+
+  if (ksm_print && print_level > 0) {
+    char line[256];
+    sprintf(line, "Arnoldi: %d iterations, shift %15.6e\n", niters, sigma);
+    ksm_print->print(line);
+    sprintf(line, "%3s %18s %18s %10s\n", " ", "real", "imag", "error");
+    ksm_print->print(line);
+    for (int i = 0; i < num_eigvals && i < niters; i++) {
+      int j = perm[i];
+      sprintf(line, "%3d %18.10e %18.10e %10.3e\n", i, eigreal[j], eigimag[j],
+              eigerror[j]);
+      ksm_print->print(line);
+    }
+    sprintf(line, "Arnoldi computational time: %15.6f\n", MPI_Wtime() - t0);
+    ksm_print->print(line);
+  }
+}
+
+/*
+  Get the number of consecutive converged eigenvalues
+*/
+int TACSGyroscopicAnalysis::getNumConvergedEigenvalues() {
+  int count = 0;
+  for (int i = 0; i < num_eigvals && i < niters; i++) {
+    if (eigerror[perm[i]] > eig_tol) {
+      break;
+    }
+    count++;
+  }
+  return count;
+}
+
+/*
+  Extract the n-th eigenvalue ordered by the distance from the shift
+
+  @param n The index of the eigenvalue
+  @param real The real part of the eigenvalue
+  @param imag The imaginary part of the eigenvalue
+  @param error The relative error estimate
+*/
+void TACSGyroscopicAnalysis::extractEigenvalue(int n, double *real,
+                                               double *imag, double *error) {
+  if (n < 0 || n >= niters) {
+    fprintf(stderr, "TACSGyroscopicAnalysis: Eigenvalue %d out of range\n",
+            n);
+    *real = *imag = 0.0;
+    if (error) {
+      *error = 0.0;
+    }
+    return;
+  }
+
+  int j = perm[n];
+  *real = eigreal[j];
+  *imag = eigimag[j];
+  if (error) {
+    *error = eigerror[j];
+  }
+}
+
+/*
+  Extract the real and imaginary parts of the n-th eigenvector
+
+  @param n The index of the eigenvector
+  @param xr The real part of the eigenvector
+  @param xi The imaginary part of the eigenvector (may be NULL)
+  @param error The relative error estimate
+*/
+void TACSGyroscopicAnalysis::extractEigenvector(int n, TACSBVec *xr,
+                                                TACSBVec *xi, double *error) {
+  if (n < 0 || n >= niters) {
+    fprintf(stderr, "TACSGyroscopicAnalysis: Eigenvector %d out of range\n",
+            n);
+    return;
+  }
+
+  // Find the real and imaginary parts of the Ritz vector. The
+  // imaginary part of lambda has the opposite sign of mu.
+  int j = perm[n];
+  const double *yr = &ritzvecs[niters * j];
+  const double *yi = NULL;
+  double isign = 1.0;
+  if (eigimag[j] < 0.0) {
+    yi = &ritzvecs[niters * (j + 1)];
+  } else if (eigimag[j] > 0.0) {
+    yr = &ritzvecs[niters * (j - 1)];
+    yi = &ritzvecs[niters * j];
+    isign = -1.0;
+  }
+
+  xr->zeroEntries();
+  if (xi) {
+    xi->zeroEntries();
+  }
+  for (int k = 0; k < niters; k++) {
+    xr->axpy(yr[k], Vu[k]);
+    if (xi && yi) {
+      xi->axpy(isign * yi[k], Vu[k]);
+    }
+  }
+
+  if (error) {
+    *error = eigerror[j];
+  }
+}
+
+/*
+  Extract the natural frequencies from the imaginary parts of the
+  eigenvalues with a positive imaginary part
+
+  @param nfreqs The maximum number of frequencies
+  @param freqs The natural frequencies in rad/s
+  @return The number of natural frequencies
+*/
+int TACSGyroscopicAnalysis::extractNaturalFrequencies(int nfreqs,
+                                                      TacsScalar *freqs) {
+  int count = 0;
+  for (int i = 0; i < niters && count < nfreqs; i++) {
+    int j = perm[i];
+    if (eigimag[j] > 0.0) {
+      freqs[count] = eigimag[j];
+      count++;
+    }
+  }
+  return count;
+}
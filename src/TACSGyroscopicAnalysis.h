@@ -0,0 +1,110 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_GYROSCOPIC_ANALYSIS_H
+#define TACS_GYROSCOPIC_ANALYSIS_H
+
+#include "TACSAssembler.h"
+
+/*
+  Solve the quadratic eigenvalue problem for the linearized dynamics
+  about the current state of the model
+
+  (K + lambda*G + lambda^2*M) x = 0
+
+  where K, G and M are the derivatives of the residual with respect to
+  the variables and their first and second time derivatives. G contains
+  the gyroscopic and damping terms. The problem is linearized using the
+  companion form with z = [x, lambda*x]
+
+  [  0   I ] z = lambda [ I  0 ] z
+  [ -K  -G ]            [ 0  M ]
+
+  and solved with the shift-invert Arnoldi method. Each application of
+  the shift-invert operator requires one solution with the real shifted
+  matrix
+
+  Q(sigma) = K + sigma*G + sigma^2*M
+
+  which is assembled and factored once, and products with G and M. The
+  eigenvalues closest to sigma converge first. The eigenvalues are
+  complex in general and the natural frequencies are the imaginary
+  parts of the eigenvalues with a positive imaginary part.
+
+  The Arnoldi subspace is not restarted, so the subspace size must be
+  large enough for the requested eigenvalues to converge.
+*/
+class TACSGyroscopicAnalysis : public TACSObject {
+ public:
+  TACSGyroscopicAnalysis(TACSAssembler *_assembler, double _sigma,
+                         TACSMat *_kmat, TACSMat *_gmat, TACSMat *_mmat,
+                         TACSKsm *_solver, int _max_arnoldi, int _num_eigvals,
+                         double _eig_tol = 1e-8);
+  ~TACSGyroscopicAnalysis();
+
+  // Retrieve the instance of TACSAssembler
+  // --------------------------------------
+  TACSAssembler *getAssembler() { return assembler; }
+
+  // Solve the quadratic eigenvalue problem
+  // --------------------------------------
+  double getSigma() { return sigma; }
+  void setSigma(double _sigma) { sigma = _sigma; }
+  void solve(KSMPrint *ksm_print = NULL, int print_level = 0);
+
+  // Extract the solution
+  // --------------------
+  int getNumConvergedEigenvalues();
+  void extractEigenvalue(int n, double *real, double *imag,
+                         double *error = NULL);
+  void extractEigenvector(int n, TACSBVec *xr, TACSBVec *xi,
+                          double *error = NULL);
+  int extractNaturalFrequencies(int nfreqs, TacsScalar *freqs);
+
+ private:
+  // Apply the shift-invert operator to the companion vector [u, v]
+  void applyOperator(TACSVec *u, TACSVec *v, TACSVec *yu, TACSVec *yv);
+
+  // The TACS assembler object
+  TACSAssembler *assembler;
+
+  // The shift and the stiffness, gyroscopic and mass matrices
+  double sigma;
+  TACSMat *kmat, *gmat, *mmat;
+
+  // The solver for the shifted problem and its preconditioner
+  TACSKsm *solver;
+  TACSPc *pc;
+
+  // The subspace size, number of eigenvalues and the tolerance
+  int max_arnoldi, num_eigvals;
+  double eig_tol;
+
+  // The companion Arnoldi vectors
+  TACSVec **Vu, **Vv;
+  TACSVec *temp;
+
+  // The size of the Arnoldi subspace after the last solve and the
+  // Hessenberg matrix in column-major order
+  int niters;
+  double *H;
+
+  // The Ritz values of the quadratic problem, the error estimates and
+  // the eigenvectors of the Hessenberg matrix
+  double *eigreal, *eigimag, *eigerror;
+  double *ritzvecs;
+  int *perm;
+};
+
+#endif  // TACS_GYROSCOPIC_ANALYSIS_H
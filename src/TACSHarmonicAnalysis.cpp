@@ -0,0 +1,366 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSHarmonicAnalysis.h"
+
+#include "TACSProfiler.h"
+
+/*
+  Create the harmonic analysis
+
+  input:
+  assembler:    the TACSAssembler object
+  gmres_iters:  the size of the GMRES subspace for the direct path
+  nrestart:     the number of GMRES restarts
+*/
+TACSHarmonicAnalysis::TACSHarmonicAnalysis(TACSAssembler *_assembler,
+                                           int gmres_iters, int nrestart) {
+  assembler = _assembler;
+  assembler->incref();
+
+  // Create the matrices and the factorization of A + B
+  kmat = assembler->createSchurMat();
+  kmat->incref();
+  mmat = assembler->createSchurMat();
+  mmat->incref();
+  pcmat = assembler->createSchurMat();
+  pcmat->incref();
+  pc = new TACSSchurPc(pcmat, 1000000, 10.0, 1);
+  pc->incref();
+  assembled = 0;
+
+  alpha = beta = zeta = 0.0;
+  omega = 0.0;
+
+  // Create the solver for the real form of the complex system
+  hmat = new TACSHarmonicMat(this);
+  hmat->incref();
+  hpc = new TACSHarmonicPc(this);
+  hpc->incref();
+  ksm = new GMRES(hmat, hpc, gmres_iters, nrestart, 0);
+  ksm->incref();
+  ksm->setTolerances(1e-10, 1e-30);
+  rhs = new TACSSpectralVec(2, assembler);
+  rhs->incref();
+  sol = new TACSSpectralVec(2, assembler);
+  sol->incref();
+  num_iters = 0;
+
+  kx = assembler->createVec();
+  kx->incref();
+  mx = assembler->createVec();
+  mx->incref();
+  ta = assembler->createVec();
+  ta->incref();
+  tb = assembler->createVec();
+  tb->incref();
+
+  num_modes = 0;
+  modes = NULL;
+  eigvals = NULL;
+}
+
+TACSHarmonicAnalysis::~TACSHarmonicAnalysis() {
+  clearModes();
+  ksm->decref();
+  hmat->decref();
+  hpc->decref();
+  rhs->decref();
+  sol->decref();
+  pc->decref();
+  kmat->decref();
+  mmat->decref();
+  pcmat->decref();
+  kx->decref();
+  mx->decref();
+  ta->decref();
+  tb->decref();
+  assembler->decref();
+}
+
+/*
+  Set the Rayleigh damping C = alpha*M + beta*K
+*/
+void TACSHarmonicAnalysis::setRayleighDamping(double _alpha, double _beta) {
+  alpha = _alpha;
+  beta = _beta;
+}
+
+/*
+  Set the additional modal damping ratio used by the modal path
+*/
+void TACSHarmonicAnalysis::setModalDamping(double _zeta) { zeta = _zeta; }
+
+/*
+  Set the relative and absolute tolerances for the direct path
+*/
+void TACSHarmonicAnalysis::setTolerances(double _rtol, double _atol) {
+  ksm->setTolerances(_rtol, _atol);
+}
+
+/*
+  Set the monitor for the direct path (may be NULL)
+*/
+void TACSHarmonicAnalysis::setMonitor(KSMPrint *_ksm_print) {
+  ksm->setMonitor(_ksm_print);
+}
+
+/*
+  Assemble the stiffness and mass matrices at the current design and
+  state. This must be called again after the design changes.
+*/
+void TACSHarmonicAnalysis::assembleMatrices() {
+  assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
+  assembler->assembleMatType(TACS_MASS_MATRIX, mmat);
+  assembled = 1;
+}
+
+/*
+  Set the modes used for the modal path
+
+  The eigenvectors are copied from the frequency analysis, which must
+  have been solved, and are normalized with respect to the mass matrix.
+
+  input:
+  freq:       the solved frequency analysis
+  num_modes:  the number of modes to use
+*/
+void TACSHarmonicAnalysis::setModes(TACSFrequencyAnalysis *freq,
+                                    int _num_modes) {
+  clearModes();
+  if (!assembled) {
+    assembleMatrices();
+  }
+
+  num_modes = _num_modes;
+  modes = new TACSBVec *[num_modes];
+  eigvals = new TacsScalar[num_modes];
+  for (int j = 0; j < num_modes; j++) {
+    TacsScalar error;
+    modes[j] = assembler->createVec();
+    modes[j]->incref();
+    eigvals[j] = freq->extractEigenvalue(j, &error);
+    freq->extractEigenvector(j, modes[j], &error);
+
+    // Normalize the mode so that the modal mass is one
+    mmat->mult(modes[j], mx);
+    TacsScalar mass = modes[j]->dot(mx);
+    if (TacsRealPart(mass) > 0.0) {
+      modes[j]->scale(1.0 / sqrt(mass));
+    }
+  }
+}
+
+/*
+  Remove the modes so that the direct path is used
+*/
+void TACSHarmonicAnalysis::clearModes() {
+  if (modes) {
+    for (int j = 0; j < num_modes; j++) {
+      modes[j]->decref();
+    }
+    delete[] modes;
+    delete[] eigvals;
+  }
+  num_modes = 0;
+  modes = NULL;
+  eigvals = NULL;
+}
+
+/*
+  Compute the response to the load at each of the frequencies
+
+  The modal path is used when modes are set, otherwise the direct path
+  is used. The matrices are assembled on the first call if required.
+
+  input:
+  num_freqs:  the number of frequencies
+  freqs:      the angular frequencies
+  force:      the amplitude of the harmonic load
+
+  output:
+  ur:         the real part of the response at each frequency
+  ui:         the imaginary part of the response at each frequency
+
+  returns:    the number of frequencies where the direct path failed
+*/
+int TACSHarmonicAnalysis::solve(int num_freqs, const double freqs[],
+                                TACSBVec *force, TACSBVec **ur,
+                                TACSBVec **ui) {
+  TACSProfileScope scope("TACSHarmonicAnalysis::solve");
+  if (!assembled) {
+    assembleMatrices();
+  }
+
+  int fail = 0;
+  num_iters = 0;
+  for (int k = 0; k < num_freqs; k++) {
+    if (num_modes > 0) {
+      solveModal(freqs[k], force, ur[k], ui[k]);
+    } else if (!solveDirect(freqs[k], force, ur[k], ui[k])) {
+      fail++;
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Solve the real form of the complex system at a single frequency
+
+  returns:  1 if the solution converged, 0 otherwise
+*/
+int TACSHarmonicAnalysis::solveDirect(double _omega, TACSBVec *force,
+                                      TACSBVec *ur, TACSBVec *ui) {
+  omega = _omega;
+  hpc->factor();
+
+  rhs->getVec(0)->copyValues(force);
+  rhs->getVec(0)->applyBCs(assembler->getBcMap());
+  rhs->getVec(1)->zeroEntries();
+
+  int flag = ksm->solve(rhs, sol);
+  num_iters += ksm->getIterCount();
+
+  ur->copyValues(sol->getVec(0));
+  ui->copyValues(sol->getVec(1));
+
+  return flag;
+}
+
+/*
+  Compute the response at a single frequency by modal superposition
+*/
+void TACSHarmonicAnalysis::solveModal(double _omega, TACSBVec *force,
+                                      TACSBVec *ur, TACSBVec *ui) {
+  ur->zeroEntries();
+  ui->zeroEntries();
+  for (int j = 0; j < num_modes; j++) {
+    // Compute the modal load and the modal damping coefficient
+    TacsScalar p = modes[j]->dot(force);
+    TacsScalar wj = sqrt(eigvals[j]);
+    TacsScalar c = alpha + beta * eigvals[j] + 2.0 * zeta * wj;
+
+    // Compute p/(dr + i*di)
+    TacsScalar dr = eigvals[j] - _omega * _omega;
+    TacsScalar di = _omega * c;
+    TacsScalar d = dr * dr + di * di;
+    if (TacsRealPart(d) != 0.0) {
+      ur->axpy(p * dr / d, modes[j]);
+      ui->axpy(-p * di / d, modes[j]);
+    }
+  }
+}
+
+/*
+  Compute yA = A*x and yB = B*x at the current frequency, where yB may
+  be NULL
+*/
+void TACSHarmonicAnalysis::multAB(TACSBVec *x, TACSBVec *yA, TACSBVec *yB) {
+  kmat->mult(x, kx);
+  mmat->mult(x, mx);
+
+  // A*x = K*x - omega^2*M*x
+  yA->copyValues(kx);
+  yA->axpy(-omega * omega, mx);
+  yA->applyBCs(assembler->getBcMap());
+
+  // B*x = omega*(alpha*M*x + beta*K*x)
+  if (yB) {
+    yB->zeroEntries();
+    yB->axpy(omega * alpha, mx);
+    yB->axpy(omega * beta, kx);
+    yB->applyBCs(assembler->getBcMap());
+  }
+}
+
+TACSHarmonicAnalysis::TACSHarmonicMat::TACSHarmonicMat(
+    TACSHarmonicAnalysis *_analysis) {
+  analysis = _analysis;
+}
+
+TACSHarmonicAnalysis::TACSHarmonicMat::~TACSHarmonicMat() {}
+
+TACSVec *TACSHarmonicAnalysis::TACSHarmonicMat::createVec() {
+  return new TACSSpectralVec(2, analysis->assembler);
+}
+
+/*
+  Compute [yr, yi] = [A*xr - B*xi, B*xr + A*xi]
+*/
+void TACSHarmonicAnalysis::TACSHarmonicMat::mult(TACSVec *xvec,
+                                                 TACSVec *yvec) {
+  TACSSpectralVec *x = dynamic_cast<TACSSpectralVec *>(xvec);
+  TACSSpectralVec *y = dynamic_cast<TACSSpectralVec *>(yvec);
+  if (x && y) {
+    TACSBVec *yr = y->getVec(0), *yi = y->getVec(1);
+    analysis->multAB(x->getVec(0), yr, yi);
+    analysis->multAB(x->getVec(1), analysis->ta, analysis->tb);
+    yr->axpy(-1.0, analysis->tb);
+    yi->axpy(1.0, analysis->ta);
+  }
+}
+
+TACSHarmonicAnalysis::TACSHarmonicPc::TACSHarmonicPc(
+    TACSHarmonicAnalysis *_analysis) {
+  analysis = _analysis;
+}
+
+TACSHarmonicAnalysis::TACSHarmonicPc::~TACSHarmonicPc() {}
+
+/*
+  Form and factor A + B = (1 + omega*beta)*K + (omega*alpha - omega^2)*M.
+  The non-zero pattern of all the matrices is the same, so the symbolic
+  factorization is reused.
+*/
+void TACSHarmonicAnalysis::TACSHarmonicPc::factor() {
+  double omega = analysis->omega;
+  TACSSchurMat *pcmat = analysis->pcmat;
+  pcmat->copyValues(analysis->kmat);
+  pcmat->scale(1.0 + omega * analysis->beta);
+  pcmat->axpy(omega * analysis->alpha - omega * omega, analysis->mmat);
+  pcmat->applyBCs(analysis->assembler->getBcMap());
+  analysis->pc->factor();
+}
+
+/*
+  Apply the inverse of the block preconditioner to [f, g]:
+
+  h = (A + B)^{-1}(f + g)
+  yi = (A + B)^{-1}(A*h - f)
+  yr = h - yi
+*/
+void TACSHarmonicAnalysis::TACSHarmonicPc::applyFactor(TACSVec *xvec,
+                                                       TACSVec *yvec) {
+  TACSSpectralVec *x = dynamic_cast<TACSSpectralVec *>(xvec);
+  TACSSpectralVec *y = dynamic_cast<TACSSpectralVec *>(yvec);
+  if (x && y) {
+    TACSBVec *f = x->getVec(0), *g = x->getVec(1);
+    TACSBVec *yr = y->getVec(0), *yi = y->getVec(1);
+    TACSBVec *ta = analysis->ta, *tb = analysis->tb;
+
+    ta->copyValues(f);
+    ta->axpy(1.0, g);
+    analysis->pc->applyFactor(ta, yr);
+
+    analysis->multAB(yr, tb, NULL);
+    tb->axpy(-1.0, f);
+    analysis->pc->applyFactor(tb, yi);
+    yr->axpy(-1.0, yi);
+  }
+}
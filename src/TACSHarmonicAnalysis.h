@@ -0,0 +1,167 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_HARMONIC_ANALYSIS_H
+#define TACS_HARMONIC_ANALYSIS_H
+
+#include "KSM.h"
+#include "TACSAssembler.h"
+#include "TACSBuckling.h"
+#include "TACSSpectralIntegrator.h"
+
+/*
+  Compute the steady-state response to a harmonic load at many
+  frequencies
+
+  The response u(t) = Re((ur + i*ui)*exp(i*omega*t)) to the load
+  f*exp(i*omega*t) satisfies
+
+  (K - omega^2*M + i*omega*C)(ur + i*ui) = f
+
+  where the damping is C = alpha*M + beta*K. The stiffness and mass
+  matrices are assembled once by assembleMatrices() and are reused for
+  all frequencies until they are assembled again.
+
+  The direct path solves the real form of the complex system
+
+  [ A  -B ][ ur ] = [ f ]
+  [ B   A ][ ui ]   [ 0 ]
+
+  with A = K - omega^2*M and B = omega*C, using GMRES on the pair
+  [ur, ui] with the preconditioner
+
+  P = [ A  -B     ]
+      [ B   A + 2B]
+
+  Each application of the preconditioner requires two solutions with
+  the real matrix A + B, which is formed from K and M without an
+  element assembly and factored once per frequency, reusing the
+  symbolic factorization. Without damping, P is the exact inverse and
+  a single iteration is required.
+
+  The modal path is used when modes are set from a frequency analysis.
+  The response is then the superposition of the modes
+
+  u = sum_j phi_j*(phi_j^T f)/(m_j*(w_j^2 - omega^2 + i*omega*c_j))
+
+  where m_j is the modal mass, c_j = alpha + beta*w_j^2 + 2*zeta*w_j and
+  zeta is an additional modal damping ratio. The modal path requires no
+  factorizations, so that it is inexpensive for many frequencies, but
+  it is only accurate when the load is represented by the modes.
+
+  The frequencies are independent, so larger frequency sets may be
+  split between groups of processors, each with its own assembler and
+  analysis object.
+*/
+class TACSHarmonicAnalysis : public TACSObject {
+ public:
+  TACSHarmonicAnalysis(TACSAssembler *_assembler, int gmres_iters = 20,
+                       int nrestart = 2);
+  ~TACSHarmonicAnalysis();
+
+  // Retrieve the instance of TACSAssembler
+  // --------------------------------------
+  TACSAssembler *getAssembler() { return assembler; }
+
+  // Set the damping model
+  // ---------------------
+  void setRayleighDamping(double _alpha, double _beta);
+  void setModalDamping(double _zeta);
+
+  // Set the solution parameters for the direct path
+  // -----------------------------------------------
+  void setTolerances(double _rtol, double _atol);
+  void setMonitor(KSMPrint *_ksm_print);
+
+  // Assemble the stiffness and mass matrices
+  // ----------------------------------------
+  void assembleMatrices();
+
+  // Set the modes used for the modal path
+  // -------------------------------------
+  void setModes(TACSFrequencyAnalysis *freq, int _num_modes);
+  void clearModes();
+  int getNumModes() { return num_modes; }
+
+  // Compute the response at each frequency
+  // --------------------------------------
+  int solve(int num_freqs, const double freqs[], TACSBVec *force,
+            TACSBVec **ur, TACSBVec **ui);
+  int getNumIterations() { return num_iters; }
+
+ private:
+  // Solve with the direct and the modal paths at one frequency
+  int solveDirect(double omega, TACSBVec *force, TACSBVec *ur, TACSBVec *ui);
+  void solveModal(double omega, TACSBVec *force, TACSBVec *ur, TACSBVec *ui);
+
+  // The real form of the complex operator at a frequency
+  class TACSHarmonicMat : public TACSMat {
+   public:
+    TACSHarmonicMat(TACSHarmonicAnalysis *_analysis);
+    ~TACSHarmonicMat();
+    TACSVec *createVec();
+    void mult(TACSVec *x, TACSVec *y);
+
+   private:
+    TACSHarmonicAnalysis *analysis;
+  };
+
+  // The block preconditioner based on the factorization of A + B
+  class TACSHarmonicPc : public TACSPc {
+   public:
+    TACSHarmonicPc(TACSHarmonicAnalysis *_analysis);
+    ~TACSHarmonicPc();
+    void factor();
+    void applyFactor(TACSVec *x, TACSVec *y);
+
+   private:
+    TACSHarmonicAnalysis *analysis;
+  };
+
+  // Compute yA = A*x and yB = B*x at the current frequency
+  void multAB(TACSBVec *x, TACSBVec *yA, TACSBVec *yB);
+
+  // The TACS assembler object
+  TACSAssembler *assembler;
+
+  // The stiffness and mass matrices and the factored matrix A + B
+  TACSSchurMat *kmat, *mmat, *pcmat;
+  TACSSchurPc *pc;
+  int assembled;
+
+  // The damping parameters and the current frequency
+  double alpha, beta, zeta;
+  double omega;
+
+  // The solver for the real form of the complex system
+  TACSHarmonicMat *hmat;
+  TACSHarmonicPc *hpc;
+  TACSKsm *ksm;
+  TACSSpectralVec *rhs, *sol;
+  int num_iters;
+
+  // Temporary vectors
+  TACSBVec *kx, *mx, *ta, *tb;
+
+  // The mass-normalized modes and their frequencies for the modal path
+  int num_modes;
+  TACSBVec **modes;
+  TacsScalar *eigvals;
+};
+
+#endif  // TACS_HARMONIC_ANALYSIS_H
@@ -16,6 +16,7 @@
 
 #include <math.h>
 
+#include "TACSGyroscopicAnalysis.h"
 #include "TACSMg.h"
 #include "tacslapack.h"
 
@@ -39,6 +40,9 @@ TACSIntegrator::TACSIntegrator(TACSAssembler *_assembler, double tinit,
 
   // Allocate the total number of time steps
   num_time_steps = int(num_steps);
+  max_time_steps = num_time_steps;
+  time_init = tinit;
+  time_final = tfinal;
 
   // Store physical time of simulation
   time = new double[num_time_steps + 1];
@@ -71,7 +75,29 @@ TACSIntegrator::TACSIntegrator(TACSAssembler *_assembler, double tinit,
     qdot[k]->incref();
     qddot[k] = assembler->createVec();
     qddot[k]->incref();
-  }
+    q[k]->setMemoryCategory(TACS_MEMORY_INTEGRATOR);
+    qdot[k]->setMemoryCategory(TACS_MEMORY_INTEGRATOR);
+    qddot[k]->setMemoryCategory(TACS_MEMORY_INTEGRATOR);
+  }
+
+  // All states are stored by default
+  num_checkpoints = 0;
+  checkpoint_flags = new int[num_time_steps + 1];
+  memset(checkpoint_flags, 0, (max_time_steps + 1) * sizeof(int));
+  recompute_states = 0;
+  num_recomputed_steps = 0;
+
+  // Run the adjoint stages in series by default
+  pipelined_adjoint = 0;
+  num_adjoint_prev = 0;
+  adjoint_prev = NULL;
+  pipeline_step = 0;
+
+  // Use uniform time steps by default
+  adaptive_steps = 0;
+  err_rtol = err_atol = 0.0;
+  h_init = h_min = h_max = 0.0;
+  num_rejected_steps = 0;
 
   // Objects to store information about the functions of interest
   funcs = NULL;
@@ -101,6 +127,23 @@ TACSIntegrator::TACSIntegrator(TACSAssembler *_assembler, double tinit,
   init_newton_delta = 0.0;
   jac_comp_freq = 1;
 
+  // Assemble and factor the Jacobian at every iteration by default
+  jac_reuse = 0;
+  jac_rate_tol = 0.5;
+  jac_max_ksm_iters = 0;
+  jac_current = 0;
+  jac_design_version = 0;
+  jac_load_version = 0;
+  num_jac_factor = num_jac_reuse = 0;
+
+  // Use plain Newton updates and fixed linear tolerances by default
+  anderson = NULL;
+  newton_monitor = NULL;
+  ew_flag = 0;
+  ew_eta_max = 0.5;
+  ew_gamma = 0.9;
+  ew_alpha = 2.0;
+
   // Set the default LINEAR solver
   use_lapack = 0;
   use_schur_mat = 1;
@@ -122,6 +165,19 @@ TACSIntegrator::TACSIntegrator(TACSAssembler *_assembler, double tinit,
   // Set the rigid and shell visualization objects to NULL
   f5 = NULL;
 
+  // Set the time history output to NULL
+  history = NULL;
+  history_freq = 0;
+
+  // Set the in-situ adaptor to NULL
+  insitu = NULL;
+  insitu_freq = 0;
+
+  // No restart output by default
+  restart_fname[0] = '\0';
+  restart_freq = 0;
+  restart_step = 0;
+
   // Set kinetic and potential energies
   init_energy = 0.0;
 }
@@ -136,11 +192,14 @@ TACSIntegrator::~TACSIntegrator() {
   }
 
   // Dereference position, velocity and acceleration states
-  for (int k = 0; k < num_time_steps + 1; k++) {
-    q[k]->decref();
-    qdot[k]->decref();
-    qddot[k]->decref();
+  for (int k = 0; k < max_time_steps + 1; k++) {
+    if (q[k]) {
+      q[k]->decref();
+      qdot[k]->decref();
+      qddot[k]->decref();
+    }
   }
+  delete[] checkpoint_flags;
 
   // Dereference Newton's method objects
   res->decref();
@@ -154,6 +213,18 @@ TACSIntegrator::~TACSIntegrator() {
   if (ksm) {
     ksm->decref();
   }
+  if (anderson) {
+    anderson->decref();
+  }
+  if (newton_monitor) {
+    newton_monitor->decref();
+  }
+  if (adjoint_prev) {
+    for (int i = 0; i < num_adjoint_prev; i++) {
+      adjoint_prev[i]->decref();
+    }
+    delete[] adjoint_prev;
+  }
 
   if (time) {
     delete[] time;
@@ -175,6 +246,12 @@ TACSIntegrator::~TACSIntegrator() {
   if (f5) {
     f5->decref();
   }
+  if (history) {
+    history->decref();
+  }
+  if (insitu) {
+    insitu->decref();
+  }
 }
 
 /*
@@ -269,17 +346,218 @@ void TACSIntegrator::setKrylovSubspaceMethod(TACSKsm *_ksm) {
     ksm->decref();
   }
   ksm = _ksm;
+  jac_current = 0;
+}
+
+/*
+  Re-use the factored Jacobian across Newton iterations and time steps
+
+  When set, the Jacobian is assembled and factored only when no usable
+  factorization exists, or when the convergence with the current
+  factorization degrades. A factorization is refreshed when the ratio
+  of successive residual norms exceeds jac_rate_tol, or when the Krylov
+  method requires more than jac_max_ksm_iters iterations (if positive).
+  Changes to the design variables or node locations also force a new
+  factorization. This setting overrides the Jacobian assembly
+  frequency.
+
+  @param _jac_reuse Flag to re-use the Jacobian factorization
+  @param _jac_rate_tol The residual contraction rate that forces a refactor
+  @param _jac_max_ksm_iters The Krylov iterations that force a refactor
+*/
+void TACSIntegrator::setJacobianReuse(int _jac_reuse, double _jac_rate_tol,
+                                      int _jac_max_ksm_iters) {
+  jac_reuse = _jac_reuse;
+  jac_rate_tol = _jac_rate_tol;
+  jac_max_ksm_iters = _jac_max_ksm_iters;
+  jac_current = 0;
+}
+
+/*
+  Get the number of Jacobian factorizations and the number of Newton
+  iterations that re-used a factorization during the last integration
+*/
+void TACSIntegrator::getJacobianReuseStatistics(int *_num_jac_factor,
+                                                int *_num_jac_reuse) {
+  if (_num_jac_factor) {
+    *_num_jac_factor = num_jac_factor;
+  }
+  if (_num_jac_reuse) {
+    *_num_jac_reuse = num_jac_reuse;
+  }
+}
+
+/*
+  Accelerate the Newton iterations with Anderson acceleration
+
+  The updates computed with the same factored Jacobian are combined with
+  the previous depth updates to minimize the linearized residual. This
+  restores close to Newton convergence with a frozen Jacobian, so it is
+  most effective combined with setJacobianReuse(). The history is reset
+  when the Jacobian is refactored. A depth of zero turns off the
+  acceleration.
+
+  @param depth The number of previous updates that are stored
+*/
+void TACSIntegrator::setAndersonAcceleration(int depth) {
+  if (anderson) {
+    anderson->decref();
+    anderson = NULL;
+  }
+  if (depth > 0) {
+    anderson = new TACSAndersonAcceleration(assembler, depth);
+    anderson->incref();
+  }
+}
+
+/*
+  Set the monitor that records the convergence and performance of the
+  Newton iterations
+
+  The monitor receives the residual, the assembly, factorization and
+  solve times and the number of Krylov iterations for each Newton
+  iteration. The monitor is also set on the Krylov method, so that a
+  telemetry monitor records both levels in the same log.
+
+  @param _newton_monitor The monitor object (NULL to turn off)
+*/
+void TACSIntegrator::setNewtonMonitor(KSMPrint *_newton_monitor) {
+  if (_newton_monitor) {
+    _newton_monitor->incref();
+  }
+  if (newton_monitor) {
+    newton_monitor->decref();
+  }
+  newton_monitor = _newton_monitor;
+  if (ksm && newton_monitor) {
+    ksm->setMonitor(newton_monitor);
+  }
+}
+
+/*
+  Set the relative tolerance of the Krylov method from the convergence
+  of the Newton iterations
+
+  The forcing term is eta = gamma*(|R_k|/|R_{k-1}|)^alpha, with the
+  safeguards of Eisenstat and Walker, and is bounded above by eta_max.
+  This avoids over-solving the linear systems far from the solution
+  when an iterative preconditioner is used.
+
+  @param _ew_flag Flag to use the Eisenstat-Walker forcing terms
+  @param _ew_eta_max The maximum and initial forcing term
+  @param _ew_gamma The scaling parameter
+  @param _ew_alpha The exponent
+*/
+void TACSIntegrator::setEisenstatWalker(int _ew_flag, double _ew_eta_max,
+                                        double _ew_gamma, double _ew_alpha) {
+  ew_flag = _ew_flag;
+  ew_eta_max = _ew_eta_max;
+  ew_gamma = _ew_gamma;
+  ew_alpha = _ew_alpha;
+}
+
+/*
+  Overlap the total derivative contributions from each time step with
+  the adjoint solution at the previous time step
+
+  The contributions from the design variables and node locations at
+  step k are independent of the adjoint solve at step k-1, so the two
+  are executed concurrently as a task graph on the thread pool. This
+  requires more than one thread and, with more than one processor, an
+  MPI library initialized with MPI_THREAD_MULTIPLE. Otherwise, or if
+  the integration scheme or the checkpointing does not support it, the
+  adjoint is solved in series.
+
+  @param _pipelined_adjoint Flag to pipeline the adjoint stages
+*/
+void TACSIntegrator::setPipelinedAdjoint(int _pipelined_adjoint) {
+  pipelined_adjoint = _pipelined_adjoint;
 }
 
 /*
   Set the time interval for the simulation
 */
 void TACSIntegrator::setTimeInterval(double tinit, double tfinal) {
+  time_init = tinit;
+  time_final = tfinal;
+  num_time_steps = max_time_steps;
   for (int k = 0; k < num_time_steps + 1; k++) {
     time[k] = tinit + double(k) * (tfinal - tinit) / double(num_time_steps);
   }
 }
 
+/*
+  Store the states only at a limited number of checkpoints
+
+  By default, the states at every time step are stored for the adjoint.
+  When the number of checkpoints is positive, only the initial states,
+  the states at the checkpoints and the states required to take the
+  next time step are stored. The remaining states are recomputed from
+  the checkpoints during the adjoint using a binomial checkpointing
+  schedule (revolve). For n steps, c checkpoints and r repetitions,
+  this schedule can reverse up to (c + r)!/(c! r!) steps, with each
+  step recomputed at most r times.
+
+  Each checkpoint stores the states for getNumRestartSteps() time
+  steps. The states are recomputed with iterate() without the external
+  forces, so checkpointing requires integrate() for the forward
+  solution. The function evaluation and the output recompute the
+  states in a single forward pass. This must be called before the
+  forward solution.
+
+  @param _num_checkpoints The number of checkpoints (0 = store all)
+*/
+void TACSIntegrator::setCheckpoints(int _num_checkpoints) {
+  num_checkpoints = (_num_checkpoints > 0 ? _num_checkpoints : 0);
+  memset(checkpoint_flags, 0, (max_time_steps + 1) * sizeof(int));
+
+  if (num_checkpoints > 0) {
+    // Free all the states except the initial conditions
+    releaseStates(1, num_time_steps, 0);
+  } else {
+    for (int k = 0; k < max_time_steps + 1; k++) {
+      allocateStates(k);
+    }
+  }
+}
+
+/*
+  Select the time steps adaptively to control the local error
+
+  Each step is accepted when the weighted RMS norm of the local error
+  estimate, scaled component-wise by err_atol + err_rtol*|q|, is less
+  than one. Rejected steps are repeated with a smaller time step, and
+  the next time step is selected with a PI controller. The integration
+  stops at the final time, so the number of steps passed to the
+  constructor is the maximum number of steps. The adjoint uses the
+  accepted time history.
+
+  @param _err_rtol The relative tolerance for the local error
+  @param _err_atol The absolute tolerance for the local error
+  @param _h_init The initial time step
+  @param _h_min The minimum time step
+  @param _h_max The maximum time step (0 = no limit)
+*/
+void TACSIntegrator::setAdaptiveTimeStepping(double _err_rtol,
+                                             double _err_atol, double _h_init,
+                                             double _h_min, double _h_max) {
+  if (getErrorOrder() <= 0) {
+    fprintf(stderr,
+            "TACSIntegrator: Adaptive time steps are not available for "
+            "this integrator\n");
+    return;
+  }
+  adaptive_steps = 1;
+  err_rtol = _err_rtol;
+  err_atol = _err_atol;
+  h_init = _h_init;
+  h_min = _h_min;
+  h_max = _h_max;
+  if (h_min <= 0.0) {
+    h_min = 1e-6 * h_init;
+  }
+}
+
 /*
   Set the functions of interest that take part in the adjoint solve.
 */
@@ -355,23 +633,464 @@ void TACSIntegrator::setOutputPrefix(const char *_prefix) {
   strncpy(prefix, _prefix, sizeof(prefix));
 }
 
+/*
+  The maximum number of time steps stored in a restart file
+*/
+static const int TACS_INTEGRATOR_MAX_RESTART_STEPS = 16;
+
+/*
+  The header block of the integrator restart files
+*/
+struct TACSIntegratorRestartHeader {
+  int step_num;        // The last completed time step
+  int num_stored;      // The number of time steps with stored states
+  int num_time_steps;  // The number of time steps in the integration
+  int max_newton_iters;
+  int jac_comp_freq;
+  int use_schur_mat;
+  int lev;
+  int gmres_iters;
+  int num_restarts;
+  int is_flexible;
+  double atol, rtol;
+  double init_newton_delta;
+  double fill;
+  double time_init, time_final;
+  double time[TACS_INTEGRATOR_MAX_RESTART_STEPS];
+};
+
+/*
+  Write a restart file periodically during integrate()
+
+  @param filename The restart file, which is overwritten each time
+  @param _restart_freq The number of time steps between writes (0 = off)
+*/
+void TACSIntegrator::setRestartOutput(const char *filename,
+                                      int _restart_freq) {
+  restart_freq = 0;
+  if (filename) {
+    strncpy(restart_fname, filename, sizeof(restart_fname) - 1);
+    restart_fname[sizeof(restart_fname) - 1] = '\0';
+    restart_freq = _restart_freq;
+  }
+}
+
+/*
+  Write a restart file for the given time step
+
+  The file stores the states for the time steps that are required to
+  take the next step, the design variables, the node locations and the
+  Newton and Krylov settings. The file is written collectively with
+  MPI file I/O. The integration can be resumed with readRestart()
+  followed by integrate() using the same number of processors.
+
+  @param filename The name of the restart file
+  @param step_num The last completed time step
+  @return Zero on success
+*/
+int TACSIntegrator::writeRestart(const char *filename, int step_num) {
+  if (step_num < 0 || step_num > max_time_steps) {
+    return 1;
+  }
+
+  // Store the states required to restart the time integration
+  int num_stored = getNumRestartSteps();
+  if (num_stored > TACS_INTEGRATOR_MAX_RESTART_STEPS) {
+    num_stored = TACS_INTEGRATOR_MAX_RESTART_STEPS;
+  }
+  if (num_stored > step_num + 1) {
+    num_stored = step_num + 1;
+  }
+  for (int i = 0; i < num_stored; i++) {
+    if (!q[step_num - i]) {
+      fprintf(stderr,
+              "TACSIntegrator: States for step %d are not stored, "
+              "cannot write restart file\n",
+              step_num - i);
+      return 1;
+    }
+  }
+
+  TACSIntegratorRestartHeader header;
+  memset(&header, 0, sizeof(header));
+  header.step_num = step_num;
+  header.num_stored = num_stored;
+  header.num_time_steps = num_time_steps;
+  header.max_newton_iters = max_newton_iters;
+  header.jac_comp_freq = jac_comp_freq;
+  header.use_schur_mat = use_schur_mat;
+  header.lev = lev;
+  header.gmres_iters = gmres_iters;
+  header.num_restarts = num_restarts;
+  header.is_flexible = is_flexible;
+  header.atol = atol;
+  header.rtol = rtol;
+  header.init_newton_delta = init_newton_delta;
+  header.fill = fill;
+  header.time_init = time_init;
+  header.time_final = time_final;
+  for (int i = 0; i < num_stored; i++) {
+    header.time[i] = time[step_num - i];
+  }
+
+  TACSRestartFile *file = new TACSRestartFile(assembler->getMPIComm(),
+                                              filename, TACSRestartFile::WRITE);
+  file->incref();
+
+  int fail = file->writeHeader("TACSIntegrator", &header, sizeof(header));
+  for (int i = 0; i < num_stored && !fail; i++) {
+    int k = step_num - i;
+    fail = (file->writeVec(q[k]) || file->writeVec(qdot[k]) ||
+            file->writeVec(qddot[k]));
+  }
+
+  if (!fail) {
+    TACSBVec *dvs = assembler->createDesignVec();
+    dvs->incref();
+    assembler->getDesignVars(dvs);
+    fail = file->writeVec(dvs);
+    dvs->decref();
+  }
+  if (!fail) {
+    TACSBVec *X = assembler->createNodeVec();
+    X->incref();
+    assembler->getNodes(X);
+    fail = file->writeVec(X);
+    X->decref();
+  }
+
+  file->decref();
+
+  return fail;
+}
+
+/*
+  Read a restart file written by writeRestart()
+
+  The states, design variables, node locations and solver settings are
+  restored and the next call to integrate() resumes from the time step
+  after the one stored in the file. The states before the restart are
+  not restored, so integrateAdjoint() requires a forward solution that
+  was not restarted.
+
+  @param filename The name of the restart file
+  @param step_num The time step stored in the file (may be NULL)
+  @return Zero on success
+*/
+int TACSIntegrator::readRestart(const char *filename, int *step_num) {
+  TACSRestartFile *file = new TACSRestartFile(assembler->getMPIComm(),
+                                              filename, TACSRestartFile::READ);
+  file->incref();
+
+  TACSIntegratorRestartHeader header;
+  int fail = file->readHeader("TACSIntegrator", &header, sizeof(header));
+  if (!fail) {
+    int k = header.step_num;
+    if (k < 0 || k > max_time_steps ||
+        (!adaptive_steps && header.num_time_steps != num_time_steps)) {
+      fprintf(stderr,
+              "TACSIntegrator: Restart step %d of %d is not compatible "
+              "with %d time steps\n",
+              k, header.num_time_steps, num_time_steps);
+      fail = 1;
+    }
+  }
+
+  if (!fail) {
+    int k = header.step_num;
+    for (int i = 0; i < header.num_stored && !fail; i++) {
+      allocateStates(k - i);
+      time[k - i] = header.time[i];
+      fail = (file->readVec(q[k - i]) || file->readVec(qdot[k - i]) ||
+              file->readVec(qddot[k - i]));
+    }
+  }
+
+  if (!fail) {
+    TACSBVec *dvs = assembler->createDesignVec();
+    dvs->incref();
+    fail = file->readVec(dvs);
+    if (!fail) {
+      assembler->setDesignVars(dvs);
+    }
+    dvs->decref();
+  }
+  if (!fail) {
+    TACSBVec *X = assembler->createNodeVec();
+    X->incref();
+    fail = file->readVec(X);
+    if (!fail) {
+      assembler->setNodes(X);
+    }
+    X->decref();
+  }
+
+  file->decref();
+
+  if (!fail) {
+    int k = header.step_num;
+    max_newton_iters = header.max_newton_iters;
+    jac_comp_freq = header.jac_comp_freq;
+    use_schur_mat = header.use_schur_mat;
+    lev = header.lev;
+    gmres_iters = header.gmres_iters;
+    num_restarts = header.num_restarts;
+    is_flexible = header.is_flexible;
+    atol = header.atol;
+    rtol = header.rtol;
+    init_newton_delta = header.init_newton_delta;
+    fill = header.fill;
+    time_init = header.time_init;
+    time_final = header.time_final;
+    assembler->setSimulationTime(time[k]);
+    assembler->setVariables(q[k], qdot[k], qddot[k]);
+
+    // Resume the integration after the stored step
+    restart_step = k;
+    if (step_num) {
+      *step_num = k;
+    }
+  }
+
+  return fail;
+}
+
 /*
   Integration the equations of motion forward in time.
+
+  If readRestart() was called, the integration resumes after the time
+  step that was read from the restart file.
 */
 int TACSIntegrator::integrate() {
-  for (int i = 0; i < num_time_steps + 1; i++) {
+  if (adaptive_steps) {
+    return integrateAdaptive();
+  }
+
+  int nrestart = getNumRestartSteps();
+  int start = 0;
+  if (restart_step > 0) {
+    start = restart_step + 1;
+    restart_step = 0;
+  }
+
+  if (num_checkpoints > 0) {
+    // Discard the states from any previous solution
+    memset(checkpoint_flags, 0, (max_time_steps + 1) * sizeof(int));
+    releaseStates(1, num_time_steps, 0);
+
+    // Store the checkpoints where the adjoint will first use them
+    int start = 0;
+    for (int c = num_checkpoints; c > 0; c--) {
+      int nsteps = num_time_steps - 1 - start;
+      if (nsteps < 2) {
+        break;
+      }
+      start += getCheckpointSplit(nsteps, c);
+      checkpoint_flags[start] = 1;
+    }
+  }
+
+  for (int i = start; i < num_time_steps + 1; i++) {
+    allocateStates(i);
     int flag = iterate(i, NULL);
     if (flag != 0) {
       return flag;
     }
+
+    // Write the restart file before the states are released
+    if (restart_freq > 0 && i > 0 && i % restart_freq == 0) {
+      writeRestart(restart_fname, i);
+    }
+
+    // Free the states that are no longer required
+    if (num_checkpoints > 0) {
+      releaseStates(i - nrestart, i - nrestart, i);
+    }
+  }
+  return 0;
+}
+
+/*
+  Integrate the equations of motion forward in time with adaptive time
+  steps
+*/
+int TACSIntegrator::integrateAdaptive() {
+  int nrestart = getNumRestartSteps();
+  int order = getErrorOrder();
+  int prev_num_steps = num_time_steps;
+  num_time_steps = max_time_steps;
+  num_rejected_steps = 0;
+
+  // Discard the states from any previous solution. The checkpoints are
+  // placed by the adjoint since the number of steps is not known.
+  if (num_checkpoints > 0) {
+    memset(checkpoint_flags, 0, (max_time_steps + 1) * sizeof(int));
+    releaseStates(1, max_time_steps, 0);
+  }
+
+  int k = 0;
+  int fail = 0;
+  double h = h_init;
+  if (restart_step > 0) {
+    // Resume with the last step size from the restart file
+    k = restart_step;
+    h = time[k] - time[k - 1];
+    restart_step = 0;
+  } else {
+    time[0] = time_init;
+    allocateStates(0);
+    fail = iterate(0, NULL);
+    if (fail) {
+      return fail;
+    }
+  }
+
+  double err_prev = 1.0;
+  double t_tol = 1e-12 * fabs(time_final - time_init);
+  while (time[k] < time_final - t_tol) {
+    if (k >= max_time_steps) {
+      fprintf(stderr,
+              "TACSIntegrator: Exceeded the maximum number of time steps %d "
+              "at time %e\n",
+              max_time_steps, time[k]);
+      num_time_steps = k;
+      return 1;
+    }
+
+    // Limit the step and take the last step to the final time
+    if (h_max > 0.0 && h > h_max) {
+      h = h_max;
+    }
+    if (time[k] + 1.01 * h > time_final) {
+      h = time_final - time[k];
+    }
+    time[k + 1] = time[k] + h;
+
+    allocateStates(k + 1);
+    fail = iterate(k + 1, NULL);
+    double err = 0.0;
+    if (!fail) {
+      err = estimateError(k + 1);
+    }
+
+    if (fail || err > 1.0) {
+      // Reject the step and retry with a smaller time step
+      num_rejected_steps++;
+      if (fail) {
+        h *= 0.25;
+      } else {
+        double fact = 0.9 * pow(err, -1.0 / (order + 1));
+        h *= (fact > 0.2 ? fact : 0.2);
+      }
+      if (h < h_min) {
+        fprintf(stderr,
+                "TACSIntegrator: Time step %e is less than the minimum at "
+                "time %e\n",
+                h, time[k]);
+        num_time_steps = k;
+        return 1;
+      }
+      continue;
+    }
+
+    // Accept the step and free the states that are no longer required
+    k++;
+    recordTimeHistory(k);
+    if (restart_freq > 0 && k % restart_freq == 0) {
+      writeRestart(restart_fname, k);
+    }
+    if (num_checkpoints > 0) {
+      releaseStates(k - nrestart, k - nrestart, k);
+    }
+
+    // Select the next time step with the PI controller
+    if (err < 1e-10) {
+      err = 1e-10;
+    }
+    double fact = 0.9 * pow(err, -0.3 / (order + 1)) *
+                  pow(err_prev / err, 0.4 / (order + 1));
+    if (fact < 0.2) {
+      fact = 0.2;
+    } else if (fact > 5.0) {
+      fact = 5.0;
+    }
+    h *= fact;
+    err_prev = (err > 1e-4 ? err : 1e-4);
   }
+
+  // Set the number of steps that were taken
+  num_time_steps = k;
+  if (end_plane > num_time_steps || end_plane == prev_num_steps) {
+    end_plane = num_time_steps;
+  }
+  if (f5) {
+    f5->flush();
+  }
+  if (history) {
+    history->flush();
+  }
+  if (insitu) {
+    insitu->finish();
+  }
+
   return 0;
 }
 
+/*
+  Compute the weighted RMS norm of the local error
+
+  sqrt(1/n sum_{i} (err[i]/(err_atol + err_rtol*|vec[i]|))^2)
+*/
+double TACSIntegrator::computeErrorNorm(TACSBVec *err, TACSBVec *vec) {
+  TacsScalar *e, *x;
+  int size = err->getArray(&e);
+  vec->getArray(&x);
+
+  double local[2] = {0.0, 1.0 * size};
+  for (int i = 0; i < size; i++) {
+    double scale = err_atol + err_rtol * fabs(TacsRealPart(x[i]));
+    double r = TacsRealPart(e[i]) / scale;
+    local[0] += r * r;
+  }
+
+  double global[2];
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_SUM,
+                assembler->getMPIComm());
+  if (global[1] > 0.0) {
+    return sqrt(global[0] / global[1]);
+  }
+  return 0.0;
+}
+
 /*
   Integrate the adjoint equations backwards in time
 */
 void TACSIntegrator::integrateAdjoint() {
+  if (pipelined_adjoint && num_checkpoints == 0 && num_time_steps > 0 &&
+      hasPipelinedAdjoint() && isPipelineAvailable()) {
+    integrateAdjointPipelined();
+    return;
+  }
+
+  if (num_checkpoints > 0 && num_time_steps > 0) {
+    num_recomputed_steps = 0;
+
+    // Solve the adjoint at the final time step
+    loadStates(num_time_steps);
+    initAdjoint(num_time_steps);
+    iterateAdjoint(num_time_steps, NULL);
+    postAdjoint(num_time_steps);
+    releaseStates(1, num_time_steps, 0);
+
+    // Reverse through the remaining steps using the checkpoints
+    reverseAdjoint(0, num_time_steps - 1, num_checkpoints);
+
+    initAdjoint(0);
+    iterateAdjoint(0, NULL);
+    postAdjoint(0);
+    return;
+  }
+
   for (int i = num_time_steps; i >= 0; i--) {
     initAdjoint(i);
     iterateAdjoint(i, NULL);
@@ -379,6 +1098,325 @@ void TACSIntegrator::integrateAdjoint() {
   }
 }
 
+/*
+  Check whether the adjoint stages can be executed concurrently
+*/
+int TACSIntegrator::isPipelineAvailable() {
+  if (assembler->getThreadInfo()->getNumThreads() <= 1) {
+    return 0;
+  }
+
+  int size, provided;
+  MPI_Comm_size(assembler->getMPIComm(), &size);
+  MPI_Query_thread(&provided);
+  return (size == 1 || provided == MPI_THREAD_MULTIPLE);
+}
+
+/*
+  Execute a task of the pipelined adjoint: Task 0 adds the total
+  derivative contributions from the step after pipeline_step, and task
+  1 solves the adjoint at pipeline_step.
+*/
+void TACSIntegrator::adjointPipelineTask(int task, int thread_id,
+                                         void *ctx) {
+  TACSIntegrator *self = (TACSIntegrator *)ctx;
+  int k = self->pipeline_step;
+  if (task == 0) {
+    self->addAdjointSens(k + 1, self->adjoint_prev);
+  } else {
+    self->iterateAdjoint(k, NULL);
+  }
+}
+
+/*
+  Integrate the adjoint equations backwards in time with the total
+  derivative contributions from step k+1 computed concurrently with the
+  adjoint solve at step k.
+
+  The contributions from step k+1 to the right-hand-sides of the
+  earlier steps must be added before the right-hand-side at step k is
+  complete, so only the total derivative contributions are deferred.
+  These are evaluated at the states of step k+1 with a copy of the
+  adjoint variables, while the solve only uses the factored Jacobian.
+*/
+void TACSIntegrator::integrateAdjointPipelined() {
+  if (num_adjoint_prev != num_funcs) {
+    for (int i = 0; i < num_adjoint_prev; i++) {
+      adjoint_prev[i]->decref();
+    }
+    delete[] adjoint_prev;
+    num_adjoint_prev = num_funcs;
+    adjoint_prev = new TACSBVec *[num_funcs];
+    for (int i = 0; i < num_funcs; i++) {
+      adjoint_prev[i] = assembler->createVec();
+      adjoint_prev[i]->incref();
+    }
+  }
+
+  // Task 1 (the solve) does not depend on task 0
+  const int dep_ptr[3] = {0, 0, 0};
+  TACSThreadInfo *thread_info = assembler->getThreadInfo();
+
+  int k = num_time_steps;
+  initAdjoint(k);
+  iterateAdjoint(k, NULL);
+  propagateAdjoint(k);
+
+  for (k = num_time_steps - 1; k >= 0; k--) {
+    // Save the adjoint from step k+1 before it is overwritten
+    for (int n = 0; n < num_funcs; n++) {
+      TACSBVec *adjoint;
+      getAdjoint(k + 1, n, &adjoint);
+      adjoint_prev[n]->copyValues(adjoint);
+    }
+
+    // Assemble the right-hand-side and factor the Jacobian at step k
+    initAdjoint(k);
+
+    // Restore the states at step k+1 for the deferred contributions
+    assembler->setSimulationTime(time[k + 1]);
+    assembler->setVariables(q[k + 1], qdot[k + 1], qddot[k + 1]);
+
+    pipeline_step = k;
+    thread_info->runTaskGraph(2, dep_ptr, NULL,
+                              TACSIntegrator::adjointPipelineTask, this);
+
+    // Add the contributions to the earlier right-hand-sides
+    assembler->setSimulationTime(time[k]);
+    assembler->setVariables(q[k], qdot[k], qddot[k]);
+    propagateAdjoint(k);
+  }
+
+  // Add the contributions from the initial step
+  for (int n = 0; n < num_funcs; n++) {
+    TACSBVec *adjoint;
+    getAdjoint(0, n, &adjoint);
+    adjoint_prev[n]->copyValues(adjoint);
+  }
+  addAdjointSens(0, adjoint_prev);
+  finalizeAdjointSens();
+}
+
+/*
+  Sum the total derivatives across all processors once the adjoint is
+  complete
+*/
+void TACSIntegrator::finalizeAdjointSens() {
+  for (int n = 0; n < num_funcs; n++) {
+    dfdx[n]->beginSetValues(TACS_ADD_VALUES);
+    dfdXpt[n]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for (int n = 0; n < num_funcs; n++) {
+    dfdx[n]->endSetValues(TACS_ADD_VALUES);
+    dfdXpt[n]->endSetValues(TACS_ADD_VALUES);
+  }
+
+  // Keep track of the time taken for the reverse mode
+  time_reverse = MPI_Wtime() - time_reverse;
+}
+
+/*
+  Allocate the states at the given time step if they are not stored
+*/
+void TACSIntegrator::allocateStates(int step_num) {
+  if (!q[step_num]) {
+    q[step_num] = assembler->createVec();
+    q[step_num]->incref();
+    qdot[step_num] = assembler->createVec();
+    qdot[step_num]->incref();
+    qddot[step_num] = assembler->createVec();
+    qddot[step_num]->incref();
+    q[step_num]->setMemoryCategory(TACS_MEMORY_INTEGRATOR);
+    qdot[step_num]->setMemoryCategory(TACS_MEMORY_INTEGRATOR);
+    qddot[step_num]->setMemoryCategory(TACS_MEMORY_INTEGRATOR);
+  }
+}
+
+/*
+  Free the states at the given time step
+*/
+void TACSIntegrator::freeStates(int step_num) {
+  if (q[step_num]) {
+    q[step_num]->decref();
+    qdot[step_num]->decref();
+    qddot[step_num]->decref();
+    q[step_num] = qdot[step_num] = qddot[step_num] = NULL;
+  }
+}
+
+/*
+  Check whether the states at a step must be kept. The initial states,
+  the states that restart a checkpoint and the states required to take
+  the step after the current step are kept.
+*/
+int TACSIntegrator::isStateRequired(int step_num, int current_step) {
+  int nrestart = getNumRestartSteps();
+  if (step_num == 0) {
+    return 1;
+  }
+  if (step_num > current_step - nrestart && step_num <= current_step) {
+    return 1;
+  }
+  for (int k = step_num; k < step_num + nrestart && k <= num_time_steps; k++) {
+    if (checkpoint_flags[k]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+  Free the stored states in the interval [start, end] that are not
+  required to restart from the current step or from a checkpoint
+*/
+void TACSIntegrator::releaseStates(int start, int end, int current_step) {
+  if (start < 1) {
+    start = 1;
+  }
+  if (end > num_time_steps) {
+    end = num_time_steps;
+  }
+  for (int k = start; k <= end; k++) {
+    if (q[k] && !isStateRequired(k, current_step)) {
+      freeStates(k);
+    }
+  }
+}
+
+/*
+  Recompute the states from the stored states at the start step up to
+  the end step. The computation is skipped if the states required to
+  restart from the end step are already stored.
+*/
+int TACSIntegrator::advanceStates(int start, int end) {
+  int nrestart = getNumRestartSteps();
+  int stored = 1;
+  for (int k = end - nrestart + 1; k <= end; k++) {
+    if (k >= 0 && !q[k]) {
+      stored = 0;
+    }
+  }
+  if (stored) {
+    return 0;
+  }
+
+  int fail = 0;
+  recompute_states = 1;
+  for (int k = start + 1; k <= end; k++) {
+    allocateStates(k);
+    fail = iterate(k, NULL);
+    num_recomputed_steps++;
+    releaseStates(k - nrestart, k - nrestart, k);
+    if (fail) {
+      fprintf(stderr, "TACSIntegrator: Failed to recompute step %d\n", k);
+      break;
+    }
+  }
+  recompute_states = 0;
+
+  return fail;
+}
+
+/*
+  Make the states at the given step available
+*/
+void TACSIntegrator::loadStates(int step_num) {
+  if (q[step_num]) {
+    return;
+  }
+
+  // Find the closest previous step that can be used as a restart
+  int nrestart = getNumRestartSteps();
+  int start = step_num - 1;
+  for (; start > 0; start--) {
+    int stored = 1;
+    for (int k = start - nrestart + 1; k <= start; k++) {
+      if (k >= 0 && !q[k]) {
+        stored = 0;
+        break;
+      }
+    }
+    if (stored) {
+      break;
+    }
+  }
+
+  advanceStates(start, step_num);
+}
+
+/*
+  Get the number of steps to advance before placing the next
+  checkpoint in the binomial checkpointing schedule
+
+  With c checkpoints and r repetitions, at most
+  beta(c, r) = (c + r)!/(c! r!) steps can be reversed. Advancing by
+  num_steps - beta(c - 1, r) steps leaves a reversal of at most
+  beta(c - 1, r) steps after the checkpoint and beta(c, r - 1) steps
+  before it.
+*/
+int TACSIntegrator::getCheckpointSplit(int num_steps, int num_ckpts) {
+  // Find the number of repetitions required
+  int r = 1;
+  while (1) {
+    double beta = 1.0;
+    for (int i = 1; i <= num_ckpts; i++) {
+      beta *= double(r + i) / double(i);
+    }
+    if (beta >= num_steps) {
+      break;
+    }
+    r++;
+  }
+
+  double beta = 1.0;
+  for (int i = 1; i < num_ckpts; i++) {
+    beta *= double(r + i) / double(i);
+  }
+
+  int nsteps = num_steps - int(beta);
+  if (nsteps < 1) {
+    nsteps = 1;
+  }
+  return nsteps;
+}
+
+/*
+  Solve the adjoint equations for the steps end, end - 1, ..., start + 1
+  given the stored states at the start step and the number of free
+  checkpoints
+*/
+void TACSIntegrator::reverseAdjoint(int start, int end, int num_ckpts) {
+  if (end <= start) {
+    return;
+  }
+
+  if (num_ckpts == 0 || end - start == 1) {
+    // Recompute each step from the start step
+    for (int k = end; k > start; k--) {
+      advanceStates(start, k);
+      initAdjoint(k);
+      iterateAdjoint(k, NULL);
+      postAdjoint(k);
+      releaseStates(start + 1, end, start);
+    }
+  } else {
+    // Advance to the next checkpoint and reverse the steps after it
+    int mid = start + getCheckpointSplit(end - start, num_ckpts);
+    advanceStates(start, mid);
+    checkpoint_flags[mid] = 1;
+    reverseAdjoint(mid, end, num_ckpts - 1);
+
+    initAdjoint(mid);
+    iterateAdjoint(mid, NULL);
+    postAdjoint(mid);
+    checkpoint_flags[mid] = 0;
+    releaseStates(start + 1, end, start);
+
+    // Reverse the steps before the checkpoint
+    reverseAdjoint(start, mid - 1, num_ckpts);
+  }
+}
+
 /*
   Function that writes time, q, qdot, qddot to file
 */
@@ -389,6 +1427,7 @@ void TACSIntegrator::writeRawSolution(const char *filename, int format) {
   if (format == 1) {
     for (int k = 0; k < num_time_steps + 1; k++) {
       // Copy over the state values from TACSBVec
+      loadStates(k);
       int num_state_vars = q[k]->getArray(&qvals);
       qdot[k]->getArray(&qdotvals);
       qddot[k]->getArray(&qddotvals);
@@ -415,6 +1454,7 @@ void TACSIntegrator::writeRawSolution(const char *filename, int format) {
       */
       for (int k = 0; k < num_time_steps + 1; k++) {
         // Copy over the state values from TACSBVec
+        loadStates(k);
         int num_state_vars = q[k]->getArray(&qvals);
         qdot[k]->getArray(&qdotvals);
         qddot[k]->getArray(&qddotvals);
@@ -438,6 +1478,7 @@ void TACSIntegrator::writeRawSolution(const char *filename, int format) {
       // Write the DOFS on user specified element number in final ordering
       for (int k = 0; k < num_time_steps + 1; k++) {
         // Copy over the state values from TACSBVec
+        loadStates(k);
         int num_state_vars = q[k]->getArray(&qvals);
         qdot[k]->getArray(&qdotvals);
         qddot[k]->getArray(&qddotvals);
@@ -471,6 +1512,9 @@ void TACSIntegrator::writeSolutionToF5() {
   for (int k = 0; k < num_time_steps + 1; k++) {
     writeStepToF5(k);
   }
+  if (f5) {
+    f5->flush();
+  }
 }
 
 /*
@@ -478,6 +1522,7 @@ void TACSIntegrator::writeSolutionToF5() {
 */
 void TACSIntegrator::writeStepToF5(int step_num) {
   // Set the current states into TACS
+  loadStates(step_num);
   assembler->setVariables(q[step_num], qdot[step_num], qddot[step_num]);
   assembler->setSimulationTime(time[step_num]);
 
@@ -509,6 +1554,59 @@ void TACSIntegrator::setFH5(TACSToFH5 *_f5) {
   f5 = _f5;
 }
 
+/*
+  Set the time history output for the probe nodes and functions
+
+  The states are recorded every history_freq time steps. With adaptive
+  time steps, only the accepted steps are recorded.
+*/
+void TACSIntegrator::setTimeHistory(TACSTimeHistory *_history,
+                                    int _history_freq) {
+  if (_history) {
+    _history->incref();
+  }
+  if (history) {
+    history->decref();
+  }
+  history = _history;
+  history_freq = _history_freq;
+}
+
+/*
+  Set the in-situ adaptor that is passed the states in place of the
+  full-field output
+
+  The adaptor processes every insitu_freq time steps. With adaptive
+  time steps, only the accepted steps are processed.
+*/
+void TACSIntegrator::setInSituAdaptor(TACSInSituAdaptor *_insitu,
+                                      int _insitu_freq) {
+  if (_insitu) {
+    _insitu->incref();
+  }
+  if (insitu) {
+    insitu->finish();
+    insitu->decref();
+  }
+  insitu = _insitu;
+  insitu_freq = _insitu_freq;
+}
+
+/*
+  Record the states at the time step in the time history and pass
+  them to the in-situ adaptor
+*/
+void TACSIntegrator::recordTimeHistory(int step_num) {
+  if (history && history_freq > 0 && step_num % history_freq == 0) {
+    history->record(time[step_num], q[step_num], qdot[step_num],
+                    qddot[step_num]);
+  }
+  if (insitu && insitu_freq > 0 && step_num % insitu_freq == 0) {
+    insitu->process(step_num, time[step_num], q[step_num], qdot[step_num],
+                    qddot[step_num]);
+  }
+}
+
 /*
   Prints the wall time taken during operations in TACSIntegrator
 
@@ -577,6 +1675,14 @@ void TACSIntegrator::printOptionSummary() {
     fprintf(logfp, "%-30s %15g\n", "absolute_tolerance", atol);
     fprintf(logfp, "%-30s %15g\n", "relative_tolerance", rtol);
     fprintf(logfp, "%-30s %15d\n", "jac_comp_freq", jac_comp_freq);
+    fprintf(logfp, "%-30s %15d\n", "jac_reuse", jac_reuse);
+    if (jac_reuse) {
+      fprintf(logfp, "%-30s %15g\n", "jac_rate_tol", jac_rate_tol);
+      fprintf(logfp, "%-30s %15d\n", "jac_max_ksm_iters", jac_max_ksm_iters);
+    }
+    fprintf(logfp, "%-30s %15d\n", "anderson_depth",
+            (anderson ? anderson->getDepth() : 0));
+    fprintf(logfp, "%-30s %15d\n", "eisenstat_walker", ew_flag);
 
     fprintf(logfp, "===============================================\n");
     fprintf(logfp, "Linear Solver: Parameter values\n");
@@ -663,16 +1769,33 @@ int TACSIntegrator::newtonSolve(double alpha, double beta, double gamma,
   // Track the time taken for newton solve at each time step
   double tnewton = MPI_Wtime();
 
+  // Discard the acceleration history from the previous solve
+  if (anderson) {
+    anderson->reset();
+  }
+
   // Iterate until max iters or R <= tol
   double delta = 0.0;
+  double prev_res_norm = 0.0;
+  double ew_eta = ew_eta_max;
+  double ew_res_norm = 0.0;
+  KSMNewtonStats nstats;
   for (niter = 0; niter < max_newton_iters; niter++) {
     // Set the supplied initial input states into TACS
     assembler->setSimulationTime(t);
     assembler->setVariables(u, udot, uddot);
 
+    // Decide whether to assemble the Jacobian or re-use the factorization
+    int assemble_jac = ((niter % jac_comp_freq) == 0);
+    if (jac_reuse) {
+      assemble_jac = (!jac_current ||
+                      jac_design_version != assembler->getDesignVersion() ||
+                      jac_load_version != assembler->getLoadVersion());
+    }
+
     // Assemble the Jacobian matrix once in Newton iterations
     double t0 = MPI_Wtime();
-    if ((niter % jac_comp_freq) == 0) {
+    if (assemble_jac) {
       delta = init_newton_delta * gamma;
       if (niter > 0 && (TacsRealPart(res_norm) < TacsRealPart(init_res_norm))) {
         delta *= TacsRealPart(res_norm / init_res_norm);
@@ -697,6 +1820,10 @@ int TACSIntegrator::newtonSolve(double alpha, double beta, double gamma,
     }
 
     time_fwd_assembly += MPI_Wtime() - t0;
+    nstats.assembly_time = MPI_Wtime() - t0;
+    nstats.factor_time = nstats.solve_time = 0.0;
+    nstats.ksm_iters = 0;
+    nstats.jac_assembled = assemble_jac;
 
     // Compute the L2-norm of the residual
     res_norm = res->norm();
@@ -753,6 +1880,28 @@ int TACSIntegrator::newtonSolve(double alpha, double beta, double gamma,
       break;
     }
 
+    // Refactor at the current iterate if the re-used factorization no
+    // longer reduces the residual fast enough
+    if (jac_reuse && !assemble_jac && niter > 0 &&
+        TacsRealPart(res_norm) > jac_rate_tol * prev_res_norm) {
+      jac_current = 0;
+      if (newton_monitor) {
+        newton_monitor->printNewtonIteration(niter, res_norm, &nstats);
+      }
+      continue;
+    }
+    prev_res_norm = TacsRealPart(res_norm);
+
+    // Record the factorization that is used for this iteration
+    if (assemble_jac) {
+      num_jac_factor++;
+      jac_current = 1;
+      jac_design_version = assembler->getDesignVersion();
+      jac_load_version = assembler->getLoadVersion();
+    } else {
+      num_jac_reuse++;
+    }
+
     if (use_lapack) {
       if (mpiSize > 1) {
         fprintf(stderr, "TACSIntegrator:: Using LAPACK in parallel!\n");
@@ -762,15 +1911,53 @@ int TACSIntegrator::newtonSolve(double alpha, double beta, double gamma,
     } else {
       // LU Factor the matrix when needed
       double t1 = MPI_Wtime();
-      if ((niter % jac_comp_freq) == 0) {
+      if (assemble_jac) {
         pc->factor();
       }
       time_fwd_factor += MPI_Wtime() - t1;
+      nstats.factor_time = MPI_Wtime() - t1;
+
+      // Set the linear tolerance from the Eisenstat-Walker forcing term
+      if (ew_flag) {
+        if (ew_res_norm > 0.0) {
+          double eta_prev = ew_eta;
+          ew_eta =
+              ew_gamma * pow(TacsRealPart(res_norm) / ew_res_norm, ew_alpha);
+          double eta_safe = ew_gamma * pow(eta_prev, ew_alpha);
+          if (eta_safe > 0.1 && eta_safe > ew_eta) {
+            ew_eta = eta_safe;
+          }
+        }
+        if (ew_eta > ew_eta_max) {
+          ew_eta = ew_eta_max;
+        }
+        if (ew_eta < 0.1 * rtol) {
+          ew_eta = 0.1 * rtol;
+        }
+        ew_res_norm = TacsRealPart(res_norm);
+        ksm->setTolerances(ew_eta, 1.0e-30);
+      }
 
       // Solve for update using KSM
       double t2 = MPI_Wtime();
       ksm->solve(res, update);
       time_fwd_apply_factor += MPI_Wtime() - t2;
+      nstats.solve_time = MPI_Wtime() - t2;
+      nstats.ksm_iters = ksm->getIterCount();
+
+      // Refactor at the next iteration if the Krylov method struggles
+      if (jac_max_ksm_iters > 0 && ksm->getIterCount() > jac_max_ksm_iters) {
+        jac_current = 0;
+      }
+    }
+
+    // Accelerate the update, discarding the history when the Jacobian
+    // has been refactored
+    if (anderson) {
+      if (assemble_jac) {
+        anderson->reset();
+      }
+      anderson->computeUpdate(update);
     }
 
     // Find the norm of the displacement update
@@ -780,11 +1967,23 @@ int TACSIntegrator::newtonSolve(double alpha, double beta, double gamma,
     uddot->axpy(-gamma, update);
     udot->axpy(-beta, update);
     u->axpy(-alpha, update);
+
+    if (newton_monitor) {
+      newton_monitor->printNewtonIteration(niter, res_norm, &nstats);
+    }
   }
 
   // Failed nonlinear solution
   if (niter == max_newton_iters) {
     newton_exit_flag = -1;
+  } else if (newton_monitor) {
+    // Record the final iteration that satisfied the stopping criteria
+    newton_monitor->printNewtonIteration(niter, res_norm, &nstats);
+  }
+
+  // Restore the linear tolerance used for the adjoint solves
+  if (ew_flag && ksm) {
+    ksm->setTolerances(0.1 * rtol, 1.0e-30);
   }
 
   // Record the time taken for nonlinear solution
@@ -1023,6 +2222,82 @@ int TACSIntegrator::lapackNaturalFrequencies(int use_gyroscopic, TACSBVec *q,
   return index;
 }
 
+/*
+  Compute the natural frequencies of the model linearized about the
+  given state, including the gyroscopic and damping terms
+
+  Unlike lapackNaturalFrequencies(), the eigenproblem is solved with
+  the sparse shift-invert Arnoldi method and runs in parallel. The
+  frequencies closest to the shift converge first.
+
+  @param q The state variables
+  @param qdot The first time derivatives of the state variables
+  @param qddot The second time derivatives of the state variables
+  @param num_freqs The number of requested frequencies
+  @param freq The natural frequencies in rad/s
+  @param sigma The shift for the eigenvalues
+  @param max_arnoldi The size of the Arnoldi subspace
+  @return The number of frequencies computed
+*/
+int TACSIntegrator::naturalFrequencies(TACSBVec *q, TACSBVec *qdot,
+                                       TACSBVec *qddot, int num_freqs,
+                                       TacsScalar *freq, double sigma,
+                                       int max_arnoldi) {
+  // Set the (steady-state) state variables into TACS
+  assembler->setVariables(q, qdot, qddot);
+
+  // Create the matrices and the direct solver for the shifted problem
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  TACSSchurPc *pc = new TACSSchurPc(kmat, 1000000, 10.0, 1);
+  TACSKsm *solver = new GMRES(kmat, pc, 10, 0, 0);
+  solver->setTolerances(1e-12, 1e-30);
+  TACSMat *gmat = assembler->createMat();
+  TACSMat *mmat = assembler->createMat();
+
+  // Each frequency is a complex conjugate pair of eigenvalues
+  TACSGyroscopicAnalysis *analysis =
+      new TACSGyroscopicAnalysis(assembler, sigma, kmat, gmat, mmat, solver,
+                                 max_arnoldi, 2 * num_freqs);
+  analysis->incref();
+
+  analysis->solve();
+  int nfreqs = analysis->extractNaturalFrequencies(num_freqs, freq);
+
+  if (logfp && print_level > 0) {
+    for (int i = 0; i < nfreqs; i++) {
+      fprintf(logfp, "Natural frequency %3d %15.8e\n", i,
+              TacsRealPart(freq[i]));
+    }
+  }
+
+  // Write the real part of the modes to disk as f5
+  if (f5) {
+    TACSBVec *mode = assembler->createVec();
+    mode->incref();
+
+    // Size the file name for the prefix and the largest mode index
+    size_t len = strlen(prefix) + 32;
+    char *fname = new char[len];
+    for (int i = 0, index = 0; i < 2 * num_freqs && index < nfreqs; i++) {
+      double re, im;
+      analysis->extractEigenvalue(i, &re, &im);
+      if (im > 0.0) {
+        analysis->extractEigenvector(i, mode, NULL);
+        assembler->setVariables(mode, mode, mode);
+        snprintf(fname, len, "%s/mode_freq_%d.f5", prefix, index);
+        f5->writeToFile(fname);
+        index++;
+      }
+    }
+    delete[] fname;
+    mode->decref();
+  }
+
+  analysis->decref();
+
+  return nfreqs;
+}
+
 /*
   Solves the linear system Ax=b using LAPACK. The execution should be
   in serial mode.
@@ -1095,6 +2370,11 @@ void TACSIntegrator::lapackLinearSolve(TACSBVec *res, TACSMat *mat,
   Implement all the tasks to perform during each time step
 */
 void TACSIntegrator::logTimeStep(int step_num) {
+  // Skip the output when the states are recomputed for the adjoint
+  if (recompute_states) {
+    return;
+  }
+
   if (step_num == 0) {
     // Keep track of the time taken for foward mode
     time_forward = MPI_Wtime();
@@ -1102,6 +2382,7 @@ void TACSIntegrator::logTimeStep(int step_num) {
     time_fwd_factor = 0.0;
     time_fwd_apply_factor = 0.0;
     time_newton = 0.0;
+    num_jac_factor = num_jac_reuse = 0;
   }
   if (step_num == num_time_steps) {
     time_forward = MPI_Wtime() - time_forward;
@@ -1112,6 +2393,22 @@ void TACSIntegrator::logTimeStep(int step_num) {
     writeStepToF5(step_num);
   }
 
+  // Complete any asynchronous output at the end of the time history
+  if (f5 && step_num == num_time_steps) {
+    f5->flush();
+  }
+
+  // Record the time history. Adaptive steps are recorded once accepted.
+  if (!adaptive_steps || step_num == 0) {
+    recordTimeHistory(step_num);
+    if (history && step_num == num_time_steps) {
+      history->flush();
+    }
+    if (insitu && step_num == num_time_steps) {
+      insitu->finish();
+    }
+  }
+
   // Evaluate the energies
   TacsScalar energies[2];
   assembler->evalEnergies(&energies[0], &energies[1]);
@@ -1155,6 +2452,12 @@ void TACSIntegrator::logTimeStep(int step_num) {
               TacsRealPart((init_energy - (energies[0] + energies[1]))));
     }
   }
+
+  // Report the Jacobian re-use at the end of the time history
+  if (logfp && print_level >= 1 && jac_reuse && step_num == num_time_steps) {
+    fprintf(logfp, "%-30s %15d\n", "num_jac_factor", num_jac_factor);
+    fprintf(logfp, "%-30s %15d\n", "num_jac_reuse", num_jac_reuse);
+  }
 }
 
 /*
@@ -1162,6 +2465,7 @@ void TACSIntegrator::logTimeStep(int step_num) {
 */
 double TACSIntegrator::getStates(int step_num, TACSBVec **_q, TACSBVec **_qdot,
                                  TACSBVec **_qddot) {
+  loadStates(step_num);
   if (_q) {
     *_q = q[step_num];
   }
@@ -1217,6 +2521,9 @@ void TACSIntegrator::initializeLinearSolver() {
   }
 
   // ksm->setMonitor(new KSMPrintStdout("GMRES", 0, 1));
+  if (newton_monitor) {
+    ksm->setMonitor(newton_monitor);
+  }
   ksm->setTolerances(0.1 * rtol, 1.0e-30);
 
   // Set the global variable to initialize linear solver
@@ -1416,12 +2723,23 @@ TACSBDFIntegrator::TACSBDFIntegrator(TACSAssembler *_assembler, double _tinit,
 
   // As many RHS as the number of second derivative coeffs
   num_adjoint_rhs = (2 * max_bdf_order + 1) + 1;
+
+  // No reduced-order model by default
+  rom = NULL;
+  rom_tol = 0.1;
+  rom_check_freq = 1;
+  rom_active = 0;
+  num_rom_steps = 0;
+  rom_trip_step = -1;
 }
 
 /*
   Free any data that is allocated by this class
 */
 TACSBDFIntegrator::~TACSBDFIntegrator() {
+  if (rom) {
+    rom->decref();
+  }
   if (rhs) {
     for (int i = 0; i < num_funcs; i++) {
       psi[i]->decref();
@@ -1535,6 +2853,13 @@ int TACSBDFIntegrator::iterate(int k, TACSBVec *forces) {
     assembler->setBCs(q[0]);  // Set the Dirichlet BCs
     assembler->setVariables(q[0], qdot[0], qddot[0]);
 
+    // Use the reduced-order model until the error indicator trips. The
+    // recomputed states must match the stored ones, so the model is not
+    // used with checkpoints.
+    rom_active = (rom && rom->getBasisSize() > 0 && num_checkpoints == 0);
+    num_rom_steps = 0;
+    rom_trip_step = -1;
+
     // Solve for acceleration and set into TACS
     logTimeStep(k);
 
@@ -1561,39 +2886,293 @@ int TACSBDFIntegrator::iterate(int k, TACSBVec *forces) {
     qdot[k]->axpy(scale, q[k - i]);
   }
 
-  // approximate qddot using BDF formula
-  qddot[k]->zeroEntries();
-  for (int i = 0; i < nbddf; i++) {
-    double scale = bddf_coeff[i];
-    qddot[k]->axpy(scale, q[k - i]);
-  }
+  // approximate qddot using BDF formula
+  qddot[k]->zeroEntries();
+  for (int i = 0; i < nbddf; i++) {
+    double scale = bddf_coeff[i];
+    qddot[k]->axpy(scale, q[k - i]);
+  }
+
+  // If required, add the contribution to the second derivative
+  // from the initial values of the first derivatives
+  if (k == nbdf - 1) {
+    double scale = bdf_coeff[nbdf - 1];
+    qddot[k]->axpy(scale, qdot[0]);
+  }
+
+  // Determine the coefficients for linearizing the Residual
+  double alpha = 1.0;
+  double beta = bdf_coeff[0];
+  double gamma = bddf_coeff[0];
+
+  // Take the step with the reduced-order model. If the error indicator
+  // trips, the reduced solution is the starting point for the full model
+  // for the remaining steps.
+  int rom_fail = 1;
+  if (rom_active) {
+    rom_fail = reducedNewtonSolve(k, alpha, beta, gamma, forces);
+    if (rom_fail) {
+      rom_active = 0;
+      rom_trip_step = k;
+      if (mpiRank == 0) {
+        fprintf(logfp,
+                "[%d] TACSBDFIntegrator: Reduced-order model tripped at "
+                "step %d\n",
+                mpiRank, k);
+      }
+    } else {
+      num_rom_steps++;
+    }
+  }
+
+  // Solve the nonlinear system of stage equations starting with the
+  // approximated states
+  int newton_term = 0;
+  if (rom_fail) {
+    newton_term = newtonSolve(alpha, beta, gamma, time[k], q[k], qdot[k],
+                              qddot[k], forces);
+  }
+
+  // Tecplot output and print related stuff as configured
+  logTimeStep(k);
+
+  // Return a non-zero flag when the Newton iteration fails
+  int fail = 0;
+  if (newton_term < 0) {
+    fail = 1;
+  }
+  return fail;
+}
+
+/*
+  Solve for the step in the affine space spanned by the reduced-order
+  model about the predicted states in q[k], qdot[k] and qddot[k]. The
+  states are updated in place.
+
+  The error indicator is the norm of the full residual at the reduced
+  solution relative to the full residual at the predicted states. It is
+  evaluated every rom_check_freq steps, at the cost of two residual
+  assemblies.
+
+  @return Non-zero if the reduced Newton iteration fails or the error
+  indicator exceeds rom_tol
+*/
+int TACSBDFIntegrator::reducedNewtonSolve(int k, double alpha, double beta,
+                                          double gamma, TACSBVec *forces) {
+  double t = time[k];
+  int check = (rom_check_freq > 0 && (num_rom_steps % rom_check_freq) == 0);
+
+  // Evaluate the full residual at the predicted states
+  double res_pred = 0.0;
+  if (check) {
+    assembler->setSimulationTime(t);
+    assembler->setVariables(q[k], qdot[k], qddot[k]);
+    assembler->assembleRes(res);
+    if (forces) {
+      res->axpy(-1.0, forces);
+      assembler->applyBCs(res);
+    }
+    res_pred = TacsRealPart(res->norm());
+  }
+
+  int r = rom->getBasisSize();
+  TacsScalar *a = new TacsScalar[r];
+  TacsScalar *ra = new TacsScalar[r];
+  TacsScalar *fa = new TacsScalar[r];
+  TacsScalar *Ja = new TacsScalar[r * r];
+  TacsScalar *A = new TacsScalar[r * r];
+  int *ipiv = new int[r];
+  memset(a, 0, r * sizeof(TacsScalar));
+  memset(fa, 0, r * sizeof(TacsScalar));
+
+  // Project the external forces onto the basis
+  if (forces) {
+    rom->projectVec(forces, fa);
+  }
+
+  // Solve the reduced system with Newton's method
+  rom->setBaseState(q[k], qdot[k], qddot[k]);
+  int fail = 1;
+  double init_norm = 0.0;
+  for (int iter = 0; iter < max_newton_iters; iter++) {
+    rom->assembleReducedJacobian(t, alpha, beta, gamma, a, ra, Ja);
+    double norm = 0.0;
+    for (int i = 0; i < r; i++) {
+      ra[i] -= fa[i];
+      norm += TacsRealPart(ra[i] * ra[i]);
+    }
+    norm = sqrt(norm);
+    if (iter == 0) {
+      init_norm = norm;
+    }
+    if (norm != norm) {
+      break;
+    }
+    if (norm < rtol * init_norm || norm < atol) {
+      fail = 0;
+      break;
+    }
+
+    // Solve J*da = r using the column-major transpose of the Jacobian
+    for (int i = 0; i < r; i++) {
+      for (int j = 0; j < r; j++) {
+        A[i + r * j] = Ja[r * i + j];
+      }
+    }
+    int nrhs = 1, info = 0;
+    LAPACKgesv(&r, &nrhs, A, &r, ipiv, ra, &r, &info);
+    if (info != 0) {
+      break;
+    }
+    for (int i = 0; i < r; i++) {
+      a[i] -= ra[i];
+    }
+  }
+
+  // Update the states from the reduced solution
+  rom->addBasisVecs(1.0, a, q[k]);
+  rom->addBasisVecs(beta, a, qdot[k]);
+  rom->addBasisVecs(gamma, a, qddot[k]);
 
-  // If required, add the contribution to the second derivative
-  // from the initial values of the first derivatives
-  if (k == nbdf - 1) {
-    double scale = bdf_coeff[nbdf - 1];
-    qddot[k]->axpy(scale, qdot[0]);
+  delete[] a;
+  delete[] ra;
+  delete[] fa;
+  delete[] Ja;
+  delete[] A;
+  delete[] ipiv;
+
+  // Evaluate the error indicator at the reduced solution
+  if (!fail && check) {
+    assembler->setVariables(q[k], qdot[k], qddot[k]);
+    assembler->assembleRes(res);
+    if (forces) {
+      res->axpy(-1.0, forces);
+      assembler->applyBCs(res);
+    }
+    double res_rom = TacsRealPart(res->norm());
+    if (res_rom > rom_tol * res_pred && res_rom > atol) {
+      fail = 1;
+    }
+  } else {
+    assembler->setSimulationTime(t);
+    assembler->setVariables(q[k], qdot[k], qddot[k]);
   }
 
-  // Determine the coefficients for linearizing the Residual
-  double alpha = 1.0;
-  double beta = bdf_coeff[0];
-  double gamma = bddf_coeff[0];
+  return fail;
+}
 
-  // Solve the nonlinear system of stage equations starting with the
-  // approximated states
-  int newton_term =
-      newtonSolve(alpha, beta, gamma, time[k], q[k], qdot[k], qddot[k], forces);
+/*
+  Build a reduced-order model from the states of the last integration
+  and use it for the subsequent integrations
+
+  The POD basis is computed from the states relative to the initial
+  state, and the sampled elements are trained at up to max_train
+  evenly spaced time steps. This requires that all of the states are
+  stored.
+
+  @param max_basis_size The maximum number of basis vectors
+  @param energy_tol The fraction of the snapshot energy that is discarded
+  @param sample_tol The relative tolerance for the sampled residual
+  @param max_samples The maximum number of sampled elements (0 = no limit)
+  @param max_train The maximum number of training snapshots
+  @return The reduced-order model (or NULL)
+*/
+TACSReducedOrderModel *TACSBDFIntegrator::buildReducedOrderModel(
+    int max_basis_size, double energy_tol, double sample_tol, int max_samples,
+    int max_train) {
+  if (num_checkpoints > 0 || num_time_steps < 1 || !q[num_time_steps]) {
+    fprintf(stderr,
+            "TACSBDFIntegrator: The reduced-order model requires all of the "
+            "states from a previous integration\n");
+    return NULL;
+  }
+
+  TACSReducedOrderModel *new_rom =
+      new TACSReducedOrderModel(assembler, max_basis_size);
+  new_rom->computeBasis(num_time_steps, &q[1], q[0], energy_tol);
+
+  // Select evenly spaced training steps
+  int ntrain = (max_train < num_time_steps ? max_train : num_time_steps);
+  if (ntrain < 1) {
+    ntrain = 1;
+  }
+  double *ttrain = new double[ntrain];
+  TACSBVec **qtrain = new TACSBVec *[3 * ntrain];
+  for (int i = 0; i < ntrain; i++) {
+    int step = num_time_steps;
+    if (ntrain > 1) {
+      step = 1 + (i * (num_time_steps - 1)) / (ntrain - 1);
+    }
+    ttrain[i] = time[step];
+    qtrain[i] = q[step];
+    qtrain[ntrain + i] = qdot[step];
+    qtrain[2 * ntrain + i] = qddot[step];
+  }
+  new_rom->computeSampleElements(ntrain, ttrain, qtrain, &qtrain[ntrain],
+                                 &qtrain[2 * ntrain], sample_tol, max_samples);
+  delete[] ttrain;
+  delete[] qtrain;
+
+  setReducedOrderModel(new_rom, rom_tol, rom_check_freq);
+  return new_rom;
+}
 
-  // Tecplot output and print related stuff as configured
-  logTimeStep(k);
+/*
+  Set the reduced-order model used for the subsequent integrations
+
+  The steps are taken with the reduced-order model until its Newton
+  iteration fails, or until the residual of the full model at the
+  reduced solution exceeds rom_tol times the residual at the predicted
+  states. The remaining steps are taken with the full model. The
+  adjoint is always computed with the full model along the stored
+  states.
+
+  @param _rom The reduced-order model (NULL to use the full model)
+  @param _rom_tol The tolerance for the error indicator
+  @param _rom_check_freq The frequency of the error indicator (0 = never)
+*/
+void TACSBDFIntegrator::setReducedOrderModel(TACSReducedOrderModel *_rom,
+                                             double _rom_tol,
+                                             int _rom_check_freq) {
+  if (_rom) {
+    _rom->incref();
+  }
+  if (rom) {
+    rom->decref();
+  }
+  rom = _rom;
+  rom_tol = _rom_tol;
+  rom_check_freq = _rom_check_freq;
+}
 
-  // Return a non-zero flag when the Newton iteration fails
-  int fail = 0;
-  if (newton_term < 0) {
-    fail = 1;
+/*
+  Get the number of steps taken with the reduced-order model in the
+  last integration and the step where the error indicator tripped (-1
+  if it did not trip)
+*/
+void TACSBDFIntegrator::getReducedOrderStatistics(int *_num_rom_steps,
+                                                  int *_rom_trip_step) {
+  if (_num_rom_steps) {
+    *_num_rom_steps = num_rom_steps;
   }
-  return fail;
+  if (_rom_trip_step) {
+    *_rom_trip_step = rom_trip_step;
+  }
+}
+
+/*
+  Estimate the local error from the difference between the corrected
+  states and the second-order Taylor series predictor
+
+  q[k-1] + h*qdot[k-1] + 0.5*h^2*qddot[k-1]
+*/
+double TACSBDFIntegrator::estimateError(int k) {
+  double h = time[k] - time[k - 1];
+  update->copyValues(q[k]);
+  update->axpy(-1.0, q[k - 1]);
+  update->axpy(-h, qdot[k - 1]);
+  update->axpy(-0.5 * h * h, qddot[k - 1]);
+  return computeErrorNorm(update, q[k]);
 }
 
 /*
@@ -1622,6 +3201,7 @@ void TACSBDFIntegrator::evalFunctions(TacsScalar *fvals) {
     for (int k = start_plane; k <= end_plane; k++) {
       // Set the stages
       assembler->setSimulationTime(time[k]);
+      loadStates(k);
       assembler->setVariables(q[k], qdot[k], qddot[k]);
 
       double tcoeff = 0.0;
@@ -1651,6 +3231,7 @@ void TACSBDFIntegrator::evalFunctions(TacsScalar *fvals) {
 
   for (int k = start_plane; k <= end_plane; k++) {
     assembler->setSimulationTime(time[k]);
+    loadStates(k);
     assembler->setVariables(q[k], qdot[k], qddot[k]);
 
     double tcoeff = 0.0;
@@ -1737,6 +3318,7 @@ void TACSBDFIntegrator::initAdjoint(int k) {
 
   // Set the simulation time
   assembler->setSimulationTime(time[k]);
+  loadStates(k);
   assembler->setVariables(q[k], qdot[k], qddot[k]);
 
   if (k > 0) {
@@ -1797,6 +3379,7 @@ void TACSBDFIntegrator::initAdjoint(int k) {
     double tfactor = MPI_Wtime();
     pc->factor();
     time_rev_factor += MPI_Wtime() - tfactor;
+    jac_current = 0;
   }
 }
 
@@ -1831,6 +3414,21 @@ void TACSBDFIntegrator::iterateAdjoint(int k, TACSBVec **adj_rhs) {
   right-hand-side
 */
 void TACSBDFIntegrator::postAdjoint(int k) {
+  propagateAdjoint(k);
+  addAdjointSens(k, psi);
+
+  if (k == 0) {
+    // Finally sum up all of the results across all processors
+    finalizeAdjointSens();
+  }
+}
+
+/*
+  Zero the right-hand-sides that were just solved and add the
+  contributions from the adjoint at this step to the right-hand-sides
+  of the previous steps
+*/
+void TACSBDFIntegrator::propagateAdjoint(int k) {
   // Find the adjoint index
   int adj_index = k % num_adjoint_rhs;
 
@@ -1839,18 +3437,6 @@ void TACSBDFIntegrator::postAdjoint(int k) {
     rhs[adj_index * num_funcs + n]->zeroEntries();
   }
 
-  double tcoeff = 0.0;
-  if (k > start_plane && k <= end_plane) {
-    tcoeff += 0.5 * (time[k] - time[k - 1]);
-  }
-  if (k >= start_plane && k < end_plane) {
-    tcoeff += 0.5 * (time[k + 1] - time[k]);
-  }
-  if (k >= start_plane && k <= end_plane) {
-    assembler->addDVSens(tcoeff, num_funcs, funcs, dfdx);
-    assembler->addXptSens(tcoeff, num_funcs, funcs, dfdXpt);
-  }
-
   if (k > 0) {
     // Get the BDF coefficients at this time step
     int nbdf, nbddf;
@@ -1858,13 +3444,6 @@ void TACSBDFIntegrator::postAdjoint(int k) {
     double bddf_coeff[9];
     get2ndBDFCoeff(k, bdf_coeff, &nbdf, bddf_coeff, &nbddf, max_bdf_order);
 
-    // Add total derivative contributions from this step to all
-    // functions
-    double jacpdt = MPI_Wtime();
-    assembler->addAdjointResProducts(1.0, num_funcs, psi, dfdx);
-    assembler->addAdjointResXptSensProducts(1.0, num_funcs, psi, dfdXpt);
-    time_rev_jac_pdt += MPI_Wtime() - jacpdt;
-
     // Drop the contributions from this step to other right hand sides
     double tassembly2 = MPI_Wtime();
     for (int ii = 1; (ii < nbdf || ii < nbddf); ii++) {
@@ -1884,20 +3463,33 @@ void TACSBDFIntegrator::postAdjoint(int k) {
     }
     time_rev_assembly += MPI_Wtime() - tassembly2;
   }
+}
 
-  if (k == 0) {
-    // Finally sum up all of the results across all processors
-    for (int n = 0; n < num_funcs; n++) {
-      dfdx[n]->beginSetValues(TACS_ADD_VALUES);
-      dfdXpt[n]->beginSetValues(TACS_ADD_VALUES);
-    }
-    for (int n = 0; n < num_funcs; n++) {
-      dfdx[n]->endSetValues(TACS_ADD_VALUES);
-      dfdXpt[n]->endSetValues(TACS_ADD_VALUES);
-    }
+/*
+  Add the contributions to the total derivatives from this step using
+  the given adjoint variables. The states at this step must be set in
+  TACSAssembler.
+*/
+void TACSBDFIntegrator::addAdjointSens(int k, TACSBVec **adjoint) {
+  double tcoeff = 0.0;
+  if (k > start_plane && k <= end_plane) {
+    tcoeff += 0.5 * (time[k] - time[k - 1]);
+  }
+  if (k >= start_plane && k < end_plane) {
+    tcoeff += 0.5 * (time[k + 1] - time[k]);
+  }
+  if (k >= start_plane && k <= end_plane) {
+    assembler->addDVSens(tcoeff, num_funcs, funcs, dfdx);
+    assembler->addXptSens(tcoeff, num_funcs, funcs, dfdXpt);
+  }
 
-    // Keep track of the time taken for foward mode
-    time_reverse = MPI_Wtime() - time_reverse;
+  if (k > 0) {
+    // Add total derivative contributions from this step to all
+    // functions
+    double jacpdt = MPI_Wtime();
+    assembler->addAdjointResProducts(1.0, num_funcs, adjoint, dfdx);
+    assembler->addAdjointResXptSensProducts(1.0, num_funcs, adjoint, dfdXpt);
+    time_rev_jac_pdt += MPI_Wtime() - jacpdt;
   }
 }
 
@@ -1989,10 +3581,12 @@ TACSDIRKIntegrator::~TACSDIRKIntegrator() {
   delete[] B;
 
   // Cleanup stage states
-  for (int i = 0; i < num_stages * num_time_steps; i++) {
-    qS[i]->decref();
-    qdotS[i]->decref();
-    qddotS[i]->decref();
+  for (int i = 0; i < num_stages * max_time_steps; i++) {
+    if (qS[i]) {
+      qS[i]->decref();
+      qdotS[i]->decref();
+      qddotS[i]->decref();
+    }
   }
 
   delete[] qS;
@@ -2022,6 +3616,40 @@ TACSDIRKIntegrator::~TACSDIRKIntegrator() {
   }
 }
 
+/*
+  Allocate the states and the stage states that compute them
+*/
+void TACSDIRKIntegrator::allocateStates(int step_num) {
+  TACSIntegrator::allocateStates(step_num);
+  for (int stage = 0; step_num > 0 && stage < num_stages; stage++) {
+    int offset = (step_num - 1) * num_stages + stage;
+    if (!qS[offset]) {
+      qS[offset] = assembler->createVec();
+      qS[offset]->incref();
+      qdotS[offset] = assembler->createVec();
+      qdotS[offset]->incref();
+      qddotS[offset] = assembler->createVec();
+      qddotS[offset]->incref();
+    }
+  }
+}
+
+/*
+  Free the states and the stage states
+*/
+void TACSDIRKIntegrator::freeStates(int step_num) {
+  TACSIntegrator::freeStates(step_num);
+  for (int stage = 0; step_num > 0 && stage < num_stages; stage++) {
+    int offset = (step_num - 1) * num_stages + stage;
+    if (qS[offset]) {
+      qS[offset]->decref();
+      qdotS[offset]->decref();
+      qddotS[offset]->decref();
+      qS[offset] = qdotS[offset] = qddotS[offset] = NULL;
+    }
+  }
+}
+
 /*
   Function that puts the entries into Butcher tableau
 */
@@ -2391,6 +4019,7 @@ void TACSDIRKIntegrator::evalFunctions(TacsScalar *fvals) {
     for (int k = start_plane; k < end_plane; k++) {
       // Compute the time-step
       double h = time[k + 1] - time[k];
+      loadStates(k + 1);
 
       for (int stage = 0; stage < num_stages; stage++) {
         double tS = time[k] + c[stage] * h;
@@ -2426,6 +4055,7 @@ void TACSDIRKIntegrator::evalFunctions(TacsScalar *fvals) {
   for (int k = start_plane; k < end_plane; k++) {
     // Compute the time-step
     double h = time[k + 1] - time[k];
+    loadStates(k + 1);
 
     for (int stage = 0; stage < num_stages; stage++) {
       double tS = time[k] + c[stage] * h;
@@ -2533,6 +4163,7 @@ void TACSDIRKIntegrator::iterateAdjoint(int k, TACSBVec **adj_rhs) {
 
   // Compute the time step
   double h = time[k] - time[k - 1];
+  loadStates(k);
 
   // Iterate in reverse through the stage equations
   for (int stage = num_stages - 1; stage >= 0; stage--) {
@@ -2561,6 +4192,7 @@ void TACSDIRKIntegrator::iterateAdjoint(int k, TACSBVec **adj_rhs) {
 
     // Factor the preconditioner
     pc->factor();
+    jac_current = 0;
 
     // Compute the derivatives and store them
     if (k > start_plane && k <= end_plane) {
@@ -2693,6 +4325,7 @@ void TACSDIRKIntegrator::getAdjoint(int step_num, int func_num,
 double TACSDIRKIntegrator::getStageStates(int step_num, int stage_num,
                                           TACSBVec **_qS, TACSBVec **_qdotS,
                                           TACSBVec **_qddotS) {
+  loadStates(step_num);
   if (step_num == 0) {
     // stage states do not exist for the 0th time step since initial conditions
     // are provided
@@ -2771,6 +4404,8 @@ TACSESDIRKIntegrator::TACSESDIRKIntegrator(TACSAssembler *_tacs, double _tinit,
   c = new double[num_stages];
   A = new double[num_stages * (num_stages + 1) / 2];
   B = new double[num_stages];
+  bhat = new double[num_stages];
+  Bhat = new double[num_stages];
 
   // set the Butcher Tableau integration coefficients to zero
   memset(a, 0., num_stages * (num_stages + 1) / 2 * sizeof(double));
@@ -2778,6 +4413,8 @@ TACSESDIRKIntegrator::TACSESDIRKIntegrator(TACSAssembler *_tacs, double _tinit,
   memset(c, 0., num_stages * sizeof(double));
   memset(A, 0., num_stages * (num_stages + 1) / 2 * sizeof(double));
   memset(B, 0., num_stages * sizeof(double));
+  memset(bhat, 0., num_stages * sizeof(double));
+  memset(Bhat, 0., num_stages * sizeof(double));
 
   // assign the coefficients in the Butcher Tableau (first-order)
   setupDefaultCoeffs();
@@ -2796,9 +4433,11 @@ TACSESDIRKIntegrator::~TACSESDIRKIntegrator() {
   delete[] c;
   delete[] A;
   delete[] B;
+  delete[] bhat;
+  delete[] Bhat;
 
   // clean up the stage states
-  for (int k = 0; k < num_stages * num_time_steps; k++) {
+  for (int k = 0; k < num_stages * max_time_steps; k++) {
     qS[k]->decref();
     qdotS[k]->decref();
     qddotS[k]->decref();
@@ -2841,6 +4480,12 @@ void TACSESDIRKIntegrator::setupDefaultCoeffs() {
     b[2] = 11266239266428.0 / 11593286722821.0;
     b[3] = 1767732205903.0 / 4055673282236.0;
 
+    // embedded 2nd-order weights
+    bhat[0] = 2756255671327.0 / 12835298489170.0;
+    bhat[1] = -10771552573575.0 / 22201958757719.0;
+    bhat[2] = 9247589265047.0 / 10645013368117.0;
+    bhat[3] = 2193209047091.0 / 5459859503100.0;
+
     c[0] = 0.0;
     c[1] = 1767732205903.0 / 2027836641118.0;
     c[2] = 3.0 / 5.0;
@@ -2878,6 +4523,14 @@ void TACSESDIRKIntegrator::setupDefaultCoeffs() {
     b[4] = -2260.0 / 8211.0;
     b[5] = 0.25;
 
+    // embedded 3rd-order weights
+    bhat[0] = 4586570599.0 / 29645900160.0;
+    bhat[1] = 0.0;
+    bhat[2] = 178811875.0 / 945068544.0;
+    bhat[3] = 814220225.0 / 1159782912.0;
+    bhat[4] = -3700637.0 / 11593932.0;
+    bhat[5] = 61727.0 / 225920.0;
+
     c[0] = 0.0;
     c[1] = 0.5;
     c[2] = 83.0 / 250.0;
@@ -2934,6 +4587,16 @@ void TACSESDIRKIntegrator::setupDefaultCoeffs() {
     b[6] = 32727382324388.0 / 42900044865799.0;
     b[7] = 41.0 / 200.0;
 
+    // embedded 4th-order weights
+    bhat[0] = -975461918565.0 / 9796059967033.0;
+    bhat[1] = 0.0;
+    bhat[2] = 0.0;
+    bhat[3] = 78070527104295.0 / 32432590147079.0;
+    bhat[4] = -548382580838.0 / 3424219808633.0;
+    bhat[5] = -33438840321285.0 / 15594753105479.0;
+    bhat[6] = 3629800801594.0 / 4656183773603.0;
+    bhat[7] = 4035322873751.0 / 18575991585200.0;
+
     c[0] = 0.0;
     c[1] = 41.0 / 100.0;
     c[2] = 2935347310677.0 / 11292855782101.0;
@@ -2964,9 +4627,11 @@ void TACSESDIRKIntegrator::setupSecondCoeffs() {
   // set the values of the B coefficients
   for (int i = 0; i < num_stages; i++) {
     B[i] = 0.0;
+    Bhat[i] = 0.0;
     // loop over the rows in the tableau
     for (int j = 0; j < num_stages; j++) {
       B[i] += b[j] * getACoeff(j, i);
+      Bhat[i] += bhat[j] * getACoeff(j, i);
     }
   }
 
@@ -3166,6 +4831,22 @@ int TACSESDIRKIntegrator::iterate(int k, TACSBVec *forces) {
   return 0;
 }
 
+/*
+  Estimate the local error of the step from the difference between the
+  displacements computed with the weights of the method and the
+  embedded weights
+*/
+double TACSESDIRKIntegrator::estimateError(int k) {
+  double h = time[k] - time[k - 1];
+  update->zeroEntries();
+  for (int stage = 0; stage < num_stages; stage++) {
+    int offset = (k - 1) * num_stages + stage;
+    update->axpy(h * h * (B[stage] - Bhat[stage]), qddotS[offset]);
+  }
+
+  return computeErrorNorm(update, q[k]);
+}
+
 /*
   Integration logic of a single stage of ESDIRK. Use this function to march in
   time a single stage, which is necessary to maintain the method's proper order
@@ -3414,4 +5095,250 @@ double TACSESDIRKIntegrator::getStageStates(int step_num, int stage_num,
 
     return tS;
   }
-}
\ No newline at end of file
+}
+/*
+  Create the explicit central-difference integrator
+
+  @param _assembler The TACSAssembler object
+  @param _tinit The initial time
+  @param _tfinal The final time
+  @param _num_steps The number of stored time steps
+*/
+TACSCentralDifferenceIntegrator::TACSCentralDifferenceIntegrator(
+    TACSAssembler *_assembler, double _tinit, double _tfinal,
+    double _num_steps)
+    : TACSIntegrator(_assembler, _tinit, _tfinal, _num_steps) {
+  if (mpiRank == 0) {
+    fprintf(logfp, "[%d] Creating TACSIntegrator of type %s\n", mpiRank,
+            "CentralDifference");
+  }
+
+  mass_inv = assembler->createVec();
+  mass_inv->incref();
+
+  dt_factor = 0.9;
+  dt_stable = 0.0;
+  num_sub_steps = 0;
+}
+
+TACSCentralDifferenceIntegrator::~TACSCentralDifferenceIntegrator() {
+  mass_inv->decref();
+}
+
+/*
+  Set the fraction of the estimated stable time step used for the
+  sub-steps. The element estimate is an upper bound on the maximum
+  frequency, but nonlinear stiffening can reduce the stable step.
+*/
+void TACSCentralDifferenceIntegrator::setStableTimeStepFactor(
+    double _dt_factor) {
+  if (_dt_factor > 0.0) {
+    dt_factor = _dt_factor;
+  }
+}
+
+/*
+  Compute the acceleration
+
+  qddot = M^{-1}*(f - R(q, qdot, 0))
+
+  The residual is evaluated with zero acceleration so that it contains
+  only the internal, damping and external forces. The inverse mass is
+  zero for the rows with boundary conditions.
+*/
+void TACSCentralDifferenceIntegrator::computeAcceleration(double t,
+                                                          TACSBVec *_q,
+                                                          TACSBVec *_qdot,
+                                                          TACSBVec *forces,
+                                                          TACSBVec *_qddot) {
+  assembler->setSimulationTime(t);
+  assembler->setVariables(_q, _qdot);
+  assembler->zeroDDotVariables();
+
+  double t0 = MPI_Wtime();
+  assembler->assembleRes(res);
+  time_fwd_assembly += MPI_Wtime() - t0;
+  if (forces) {
+    res->axpy(-1.0, forces);
+  }
+
+  TacsScalar *r, *minv, *a;
+  int size = res->getArray(&r);
+  mass_inv->getArray(&minv);
+  _qddot->getArray(&a);
+  for (int i = 0; i < size; i++) {
+    a[i] = -minv[i] * r[i];
+  }
+}
+
+/*
+  March one step with the central-difference method. The interval is
+  divided into sub-steps no larger than the stable time step.
+*/
+int TACSCentralDifferenceIntegrator::iterate(int k, TACSBVec *forces) {
+  if (k == 0) {
+    // Output the results at the initial condition if configured
+    printOptionSummary();
+
+    // Retrieve the initial conditions and set into TACS
+    assembler->getInitConditions(q[0], qdot[0], qddot[0]);
+    assembler->setBCs(q[0]);
+    assembler->applyBCs(qdot[0]);
+    assembler->setVariables(q[0], qdot[0]);
+
+    // Assemble and invert the lumped mass matrix. Rows without mass
+    // are held fixed.
+    assembler->assembleLumpedMass(mass_inv);
+    TacsScalar *minv;
+    int size = mass_inv->getArray(&minv);
+    int num_zero = 0;
+    for (int i = 0; i < size; i++) {
+      if (TacsRealPart(minv[i]) > 0.0) {
+        minv[i] = 1.0 / minv[i];
+      } else {
+        minv[i] = 0.0;
+        num_zero++;
+      }
+    }
+    assembler->applyBCs(mass_inv);
+
+    int num_zero_total;
+    MPI_Allreduce(&num_zero, &num_zero_total, 1, MPI_INT, MPI_SUM,
+                  assembler->getMPIComm());
+    if (num_zero_total > 0 && mpiRank == 0) {
+      fprintf(stderr,
+              "TACSCentralDifferenceIntegrator: %d variables without mass "
+              "are held fixed\n",
+              num_zero_total);
+    }
+
+    // Compute the initial acceleration consistent with the states
+    num_sub_steps = 0;
+    computeAcceleration(time[0], q[0], qdot[0], forces, qddot[0]);
+    assembler->setVariables(q[0], qdot[0], qddot[0]);
+
+    logTimeStep(k);
+
+    return 0;
+  }
+
+  // Estimate the stable time step at the start of the interval
+  assembler->setVariables(q[k - 1], qdot[k - 1], qddot[k - 1]);
+  dt_stable = dt_factor * assembler->estimateStableTimeStep();
+
+  double dt = time[k] - time[k - 1];
+  int nsub = 1;
+  if (dt_stable > 0.0 && dt > dt_stable) {
+    nsub = (int)ceil(dt / dt_stable);
+  }
+  double h = dt / nsub;
+
+  q[k]->copyValues(q[k - 1]);
+  qdot[k]->copyValues(qdot[k - 1]);
+  qddot[k]->copyValues(qddot[k - 1]);
+
+  for (int i = 0; i < nsub; i++) {
+    double t = time[k - 1] + (i + 1) * h;
+    if (i == nsub - 1) {
+      t = time[k];
+    }
+
+    // Update the velocity to the mid-step and the displacements
+    qdot[k]->axpy(0.5 * h, qddot[k]);
+    q[k]->axpy(h, qdot[k]);
+
+    // Compute the acceleration and complete the velocity update
+    computeAcceleration(t, q[k], qdot[k], forces, qddot[k]);
+    qdot[k]->axpy(0.5 * h, qddot[k]);
+  }
+  num_sub_steps += nsub;
+
+  assembler->setVariables(q[k], qdot[k], qddot[k]);
+
+  // Tecplot output and print related stuff as configured
+  logTimeStep(k);
+
+  // Return a non-zero flag if the solution is no longer finite
+  TacsScalar qnorm = q[k]->norm();
+  if (TacsRealPart(qnorm) != TacsRealPart(qnorm)) {
+    fprintf(stderr,
+            "TACSCentralDifferenceIntegrator: Solution is not finite at "
+            "time %e\n",
+            time[k]);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  Evaluate the functions of interest with the trapezoid rule
+*/
+void TACSCentralDifferenceIntegrator::evalFunctions(TacsScalar *fvals) {
+  // Check whether these are two-stage or single-stage functions
+  int twoStage = 0;
+  for (int n = 0; n < num_funcs; n++) {
+    if (funcs[n] && funcs[n]->getStageType() == TACSFunction::TWO_STAGE) {
+      twoStage = 1;
+      break;
+    }
+  }
+
+  // Perform the initialization stage for two-stage functions
+  int num_stages = (twoStage ? 2 : 1);
+  for (int stage = 0; stage < num_stages; stage++) {
+    TACSFunction::EvaluationType ftype = TACSFunction::INTEGRATE;
+    if (twoStage && stage == 0) {
+      ftype = TACSFunction::INITIALIZE;
+    }
+
+    for (int n = 0; n < num_funcs; n++) {
+      if (funcs[n]) {
+        funcs[n]->initEvaluation(ftype);
+      }
+    }
+
+    for (int k = start_plane; k <= end_plane; k++) {
+      assembler->setSimulationTime(time[k]);
+      loadStates(k);
+      assembler->setVariables(q[k], qdot[k], qddot[k]);
+
+      double tcoeff = 0.0;
+      if (k > start_plane && k <= end_plane) {
+        tcoeff += 0.5 * (time[k] - time[k - 1]);
+      }
+      if (k >= start_plane && k < end_plane) {
+        tcoeff += 0.5 * (time[k + 1] - time[k]);
+      }
+      assembler->integrateFunctions(tcoeff, ftype, num_funcs, funcs);
+    }
+
+    for (int n = 0; n < num_funcs; n++) {
+      if (funcs[n]) {
+        funcs[n]->finalEvaluation(ftype);
+      }
+    }
+  }
+
+  // Retrieve the function values
+  for (int n = 0; n < num_funcs; n++) {
+    fvals[n] = 0.0;
+    if (funcs[n]) {
+      fvals[n] = funcs[n]->getFunctionValue();
+    }
+  }
+}
+
+/*
+  The adjoint of the explicit scheme is not implemented
+*/
+void TACSCentralDifferenceIntegrator::integrateAdjoint() {
+  fprintf(stderr,
+          "TACSCentralDifferenceIntegrator: Adjoint is not implemented\n");
+}
+
+void TACSCentralDifferenceIntegrator::getAdjoint(int step_num, int func_num,
+                                                 TACSBVec **adjoint) {
+  if (adjoint) {
+    *adjoint = NULL;
+  }
+}
@@ -16,8 +16,13 @@
 #define TACS_INTEGRATOR_H
 
 #include "KSM.h"
+#include "TACSAndersonAcceleration.h"
 #include "TACSAssembler.h"
+#include "TACSInSituAdaptor.h"
 #include "TACSObject.h"
+#include "TACSReducedOrderModel.h"
+#include "TACSRestart.h"
+#include "TACSTimeHistory.h"
 #include "TACSToFH5.h"
 
 /*
@@ -49,10 +54,48 @@ class TACSIntegrator : public TACSObject {
   void setInitNewtonDeltaFraction(double frac);
   void setKrylovSubspaceMethod(TACSKsm *_ksm);
 
+  // Re-use the Jacobian factorization until the convergence degrades
+  // ----------------------------------------------------------------
+  void setJacobianReuse(int _jac_reuse, double _jac_rate_tol = 0.5,
+                        int _jac_max_ksm_iters = 0);
+  void getJacobianReuseStatistics(int *_num_jac_factor, int *_num_jac_reuse);
+
+  // Accelerate the Newton iterations and set the linear tolerances
+  // --------------------------------------------------------------
+  void setAndersonAcceleration(int depth);
+  void setEisenstatWalker(int _ew_flag, double _ew_eta_max = 0.5,
+                          double _ew_gamma = 0.9, double _ew_alpha = 2.0);
+
+  // Record the convergence and performance of the Newton iterations
+  // ---------------------------------------------------------------
+  void setNewtonMonitor(KSMPrint *_newton_monitor);
+
+  // Overlap the total derivative contributions with the adjoint solves
+  // --------------------------------------------------------------------
+  void setPipelinedAdjoint(int _pipelined_adjoint);
+
   // Set (or reset) the time interval
   // --------------------------------
   void setTimeInterval(double tinit, double tfinal);
 
+  // Store the states only at checkpoints and recompute for the adjoint
+  // ------------------------------------------------------------------
+  void setCheckpoints(int _num_checkpoints);
+  int getNumRecomputedSteps() { return num_recomputed_steps; }
+
+  // Select the time steps adaptively using local error estimates
+  // ------------------------------------------------------------
+  void setAdaptiveTimeStepping(double _err_rtol, double _err_atol,
+                               double _h_init, double _h_min = 0.0,
+                               double _h_max = 0.0);
+  int getNumRejectedSteps() { return num_rejected_steps; }
+
+  // Write/read restart files with the states and the solver settings
+  // ----------------------------------------------------------------
+  void setRestartOutput(const char *filename, int _restart_freq);
+  int writeRestart(const char *filename, int step_num);
+  int readRestart(const char *filename, int *step_num = NULL);
+
   // Set the functions to integrate
   //--------------------------------
   void setFunctions(int num_funcs, TACSFunction **funcs, int start_plane = -1,
@@ -115,6 +158,8 @@ class TACSIntegrator : public TACSObject {
   void setOutputPrefix(const char *prefix);
   void setOutputFrequency(int _write_step);
   void setFH5(TACSToFH5 *_f5);
+  void setTimeHistory(TACSTimeHistory *_history, int _history_freq = 1);
+  void setInSituAdaptor(TACSInSituAdaptor *_insitu, int _insitu_freq = 1);
   void writeRawSolution(const char *filename, int format = 2);
   void writeSolutionToF5();
   void writeStepToF5(int step_num);
@@ -128,6 +173,9 @@ class TACSIntegrator : public TACSObject {
   int lapackNaturalFrequencies(int use_gyroscopic, TACSBVec *q, TACSBVec *qdot,
                                TACSBVec *qddot, TacsScalar *eigvals,
                                TacsScalar *modes = NULL);
+  int naturalFrequencies(TACSBVec *q, TACSBVec *qdot, TACSBVec *qddot,
+                         int num_freqs, TacsScalar *freq, double sigma = 0.0,
+                         int max_arnoldi = 100);
   void getRawMatrix(TACSMat *mat, TacsScalar *mat_vals);
 
  protected:
@@ -137,6 +185,32 @@ class TACSIntegrator : public TACSObject {
                   TACSBVec *forces = NULL);
   void lapackLinearSolve(TACSBVec *res, TACSMat *mat, TACSBVec *update);
 
+  // Allocate or free the states associated with a time step
+  virtual void allocateStates(int step_num);
+  virtual void freeStates(int step_num);
+
+  // The number of previous time steps required to take a step
+  virtual int getNumRestartSteps() { return 1; }
+
+  // Estimate the local error of the step relative to the tolerances
+  // and get the order of the error estimate (0 = no estimate)
+  virtual double estimateError(int step_num) { return 0.0; }
+  virtual int getErrorOrder() { return 0; }
+  double computeErrorNorm(TACSBVec *err, TACSBVec *vec);
+
+  // Make the states at the time step available, recomputing them from
+  // the closest previous states if required
+  void loadStates(int step_num);
+
+  // Split of postAdjoint() for the pipelined adjoint: Add the
+  // contributions to the right-hand-sides of the previous steps, and
+  // add the contributions to the total derivatives with the given
+  // adjoint variables at the states set in TACSAssembler
+  virtual int hasPipelinedAdjoint() { return 0; }
+  virtual void propagateAdjoint(int step_num) {}
+  virtual void addAdjointSens(int step_num, TACSBVec **adjoint) {}
+  void finalizeAdjointSens();
+
   // Variables that keep track of time
   double time_fwd_assembly;
   double time_fwd_factor;
@@ -153,16 +227,42 @@ class TACSIntegrator : public TACSObject {
   // Log the time step information
   void logTimeStep(int time_step);
 
+  // Record the time step in the time history and in-situ output
+  void recordTimeHistory(int step_num);
+
   // TACSAssembler information
   TACSAssembler *assembler;  // Instance of TACSAssembler
 
   // The step information
   int num_time_steps;  // Total number of time steps
+  int max_time_steps;  // Number of time steps allocated
+  double time_init;    // The initial time
+  double time_final;   // The final time
   double *time;        // Stores the time values
   TACSBVec **q;        // state variables across all time steps
   TACSBVec **qdot;     // first time derivative of ''
   TACSBVec **qddot;    // second time derivative of ''
 
+  // Checkpointing information for the adjoint
+  int num_checkpoints;       // Number of checkpoints (0 = store all states)
+  int *checkpoint_flags;     // Flag for each step stored as a checkpoint
+  int recompute_states;      // Flag to indicate the states are recomputed
+  int num_recomputed_steps;  // Number of steps recomputed for the adjoint
+
+  // Pipelined adjoint information
+  int pipelined_adjoint;    // Flag to pipeline the adjoint stages
+  int num_adjoint_prev;     // Number of saved adjoint vectors
+  TACSBVec **adjoint_prev;  // Adjoint variables from the later step
+  int pipeline_step;        // The step solved by the pipeline
+
+  // Adaptive time step parameters
+  int adaptive_steps;      // Flag to indicate adaptive time steps
+  double err_rtol;         // Relative tolerance for the local error
+  double err_atol;         // Absolute tolerance for the local error
+  double h_init;           // The initial time step
+  double h_min, h_max;     // Bounds on the time step
+  int num_rejected_steps;  // Number of rejected steps
+
   // Objects that store information about the functions of interest
   int start_plane, end_plane;  // Time-window for the functions of interest
   int num_funcs;               // The number of objective functions
@@ -188,6 +288,20 @@ class TACSIntegrator : public TACSObject {
   double rtol;               // Relative tolerance
   double init_newton_delta;  // Initial value of delta for globalization
   int jac_comp_freq;         // Frequency of Jacobian factorization
+  int jac_reuse;             // Flag to re-use the Jacobian factorization
+  double jac_rate_tol;       // Residual contraction that forces a refactor
+  int jac_max_ksm_iters;     // Krylov iterations that force a refactor
+  int jac_current;           // Flag to indicate the factorization is usable
+  int jac_design_version;    // Design version of the factored Jacobian
+  int jac_load_version;      // Body load version of the factored Jacobian
+  int num_jac_factor;        // Number of Jacobian factorizations
+  int num_jac_reuse;         // Number of Newton iterations with re-use
+  TACSAndersonAcceleration *anderson;  // Acceleration of the updates
+  KSMPrint *newton_monitor;  // Monitor for the Newton and Krylov iterations
+  int ew_flag;               // Flag to use the Eisenstat-Walker forcing terms
+  double ew_eta_max;         // Maximum (and initial) forcing term
+  double ew_gamma;           // Eisenstat-Walker scaling parameter
+  double ew_alpha;           // Eisenstat-Walker exponent
   int use_schur_mat;         // use the Schur matrix type for parallel execution
   TACSAssembler::OrderingType order_type;
   int use_lapack;  // Flag to switch to LAPACK for linear solve
@@ -202,6 +316,11 @@ class TACSIntegrator : public TACSObject {
  private:
   char prefix[256];  // Output prefix
 
+  // Restart file information
+  char restart_fname[256];  // The file for the periodic restart output
+  int restart_freq;         // Frequency of the restart output (0 = off)
+  int restart_step;         // Step read from a restart file (0 = none)
+
   // Information for visualization/logging purposes
   int print_level;    // 0 = off;
                       // 1 = summary per time step;
@@ -209,12 +328,31 @@ class TACSIntegrator : public TACSObject {
   TACSToFH5 *f5;      // F5 output visualization
   int f5_write_freq;  // Frequency for output during time marching
 
+  TACSTimeHistory *history;  // Streaming output at the probe nodes
+  int history_freq;          // Frequency for the time history records
+
+  TACSInSituAdaptor *insitu;  // In-situ analysis and visualization
+  int insitu_freq;            // Frequency for the in-situ processing
+
   int niter;                 // Newton iteration number
   TacsScalar res_norm;       // residual norm
   TacsScalar init_res_norm;  // Initial norm of the residual
   TacsScalar update_norm;    // Norm of the update
 
   TacsScalar init_energy;  // The energy during time = 0
+
+  // Functions for the pipelined adjoint
+  int isPipelineAvailable();
+  void integrateAdjointPipelined();
+  static void adjointPipelineTask(int task, int thread_id, void *ctx);
+
+  // Functions for the checkpointed adjoint
+  int integrateAdaptive();
+  int isStateRequired(int step_num, int current_step);
+  void releaseStates(int start, int end, int current_step);
+  int advanceStates(int start, int end);
+  int getCheckpointSplit(int num_steps, int num_ckpts);
+  void reverseAdjoint(int start, int end, int num_ckpts);
 };
 
 /*
@@ -244,6 +382,30 @@ class TACSBDFIntegrator : public TACSIntegrator {
   // Evaluate the functions of interest
   void evalFunctions(TacsScalar *fvals);
 
+  // Take steps with a reduced-order model until the error indicator trips
+  // ---------------------------------------------------------------------
+  TACSReducedOrderModel *buildReducedOrderModel(int max_basis_size,
+                                                double energy_tol = 1e-6,
+                                                double sample_tol = 1e-3,
+                                                int max_samples = 0,
+                                                int max_train = 10);
+  void setReducedOrderModel(TACSReducedOrderModel *_rom,
+                            double _rom_tol = 0.1, int _rom_check_freq = 1);
+  void getReducedOrderStatistics(int *_num_rom_steps, int *_rom_trip_step);
+
+ protected:
+  // The number of previous time steps required to take a step
+  int getNumRestartSteps() { return 2 * max_bdf_order; }
+
+  // The stages of postAdjoint() used by the pipelined adjoint
+  int hasPipelinedAdjoint() { return 1; }
+  void propagateAdjoint(int step_num);
+  void addAdjointSens(int step_num, TACSBVec **adjoint);
+
+  // Estimate the local error from the predictor
+  double estimateError(int step_num);
+  int getErrorOrder() { return (max_bdf_order < 2 ? max_bdf_order : 2); }
+
  private:
   void get2ndBDFCoeff(const int k, double bdf[], int *nbdf, double bddf[],
                       int *nbddf, const int max_order);
@@ -251,6 +413,18 @@ class TACSBDFIntegrator : public TACSIntegrator {
 
   int max_bdf_order;  // Maximum order of the BDF integration scheme
 
+  // Solve for the step in the span of the reduced-order model
+  int reducedNewtonSolve(int k, double alpha, double beta, double gamma,
+                         TACSBVec *forces);
+
+  // Reduced-order model information
+  TACSReducedOrderModel *rom;  // The reduced-order model (may be NULL)
+  double rom_tol;              // Tolerance for the error indicator
+  int rom_check_freq;          // Frequency of the error indicator
+  int rom_active;              // Flag to indicate the model is in use
+  int num_rom_steps;           // Number of steps taken with the model
+  int rom_trip_step;           // Step where the indicator tripped (or -1)
+
   // Adjoint information
   int num_adjoint_rhs;  // the number of right hand sides allocated
   TACSBVec **rhs;       // storage vector for the right hand sides
@@ -291,6 +465,11 @@ class TACSDIRKIntegrator : public TACSIntegrator {
   // Evaluate the functions of interest
   void evalFunctions(TacsScalar *fvals);
 
+ protected:
+  // Allocate or free the time step and stage states
+  void allocateStates(int step_num);
+  void freeStates(int step_num);
+
  private:
   // Set the default coefficients
   void setupDefaultCoeffs();
@@ -364,6 +543,11 @@ class TACSESDIRKIntegrator : public TACSIntegrator {
   // Get the adjoint value for the given function - adjoint not implemented yet
   void getAdjoint(int step_num, int func_num, TACSBVec **adjoint);
 
+ protected:
+  // estimate the local error using the embedded method
+  double estimateError(int step_num);
+  int getErrorOrder() { return num_stages / 2; }
+
  private:
   // set the first-order descirption integration coefficients
   void setupDefaultCoeffs();
@@ -395,6 +579,61 @@ class TACSESDIRKIntegrator : public TACSIntegrator {
 
   // the second order coefficients for the integration scheme
   double *A, *B;
+
+  // the embedded coefficients for the error estimate
+  double *bhat, *Bhat;
+};
+
+/*
+  Explicit central-difference integration scheme for TACS. *No adjoint
+  implementation*
+
+  The states are advanced with the central-difference method in
+  velocity form
+
+  qdot[n+1/2] = qdot[n] + h/2*qddot[n]
+  q[n+1] = q[n] + h*qdot[n+1/2]
+  qddot[n+1] = M^{-1}*(f - R(q[n+1], qdot[n+1/2], 0))
+  qdot[n+1] = qdot[n+1/2] + h/2*qddot[n+1]
+
+  where M is the lumped (row-sum) mass matrix. Each step requires only
+  a residual assembly, so no matrix is assembled or factored. The
+  method is stable for h < 2/omega_max. The stable time step is
+  estimated from the element eigenvalues, and each interval between
+  the stored time steps is divided into as many sub-steps as needed.
+*/
+class TACSCentralDifferenceIntegrator : public TACSIntegrator {
+ public:
+  TACSCentralDifferenceIntegrator(TACSAssembler *_tacs, double _tinit,
+                                  double _tfinal, double _num_steps);
+  ~TACSCentralDifferenceIntegrator();
+
+  // Set the fraction of the estimated stable time step that is used
+  void setStableTimeStepFactor(double _dt_factor);
+
+  // Get the stable time step and the number of sub-steps taken
+  double getStableTimeStep() { return dt_stable; }
+  int getNumSubSteps() { return num_sub_steps; }
+
+  // Iterate through the forward solution
+  int iterate(int k, TACSBVec *forces);
+
+  // Evaluate the functions of interest
+  void evalFunctions(TacsScalar *fvals);
+
+  // The adjoint is not implemented for the explicit scheme
+  void integrateAdjoint();
+  void getAdjoint(int step_num, int func_num, TACSBVec **adjoint);
+
+ private:
+  // Compute the acceleration from the residual and the lumped mass
+  void computeAcceleration(double t, TACSBVec *q, TACSBVec *qdot,
+                           TACSBVec *forces, TACSBVec *qddot);
+
+  TACSBVec *mass_inv;  // Inverse of the lumped mass matrix
+  double dt_factor;    // Fraction of the stable time step that is used
+  double dt_stable;    // The stable time step at the last step
+  int num_sub_steps;   // Total number of sub-steps
 };
 
 /*
@@ -0,0 +1,163 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSJobScheduler.h"
+
+/*
+  Split the processors into groups. This is collective on comm.
+
+  input:
+  comm:         the communicator for all the groups
+  num_groups:   the number of groups
+  group_sizes:  optional number of processors in each group
+*/
+TACSJobScheduler::TACSJobScheduler(MPI_Comm _comm, int _num_groups,
+                                   const int *group_sizes) {
+  comm = _comm;
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  num_groups = _num_groups;
+  if (num_groups < 1) {
+    num_groups = 1;
+  } else if (num_groups > size) {
+    num_groups = size;
+  }
+
+  // Find the group of this processor
+  group = (rank * num_groups) / size;
+  if (group_sizes) {
+    int total = 0;
+    for (int i = 0; i < num_groups; i++) {
+      total += group_sizes[i];
+    }
+    if (total == size) {
+      for (int i = 0, start = 0; i < num_groups; i++) {
+        if (rank >= start && rank < start + group_sizes[i]) {
+          group = i;
+          break;
+        }
+        start += group_sizes[i];
+      }
+    } else if (rank == 0) {
+      fprintf(stderr,
+              "TACSJobScheduler: Group sizes do not sum to the number "
+              "of processors, using groups of equal size\n");
+    }
+  }
+
+  MPI_Comm_split(comm, group, rank, &group_comm);
+  assembler = NULL;
+}
+
+TACSJobScheduler::~TACSJobScheduler() {
+  if (assembler) {
+    assembler->decref();
+  }
+  MPI_Comm_free(&group_comm);
+}
+
+/*
+  Create the model for this group. This is collective on comm.
+
+  The creator must be defined on the full communicator with the mesh
+  set on its root. The mesh is copied to a creator on the group
+  communicator, which creates the model for the group.
+
+  input:
+  creator:  the creator on the full communicator
+
+  returns:  the model for this group
+*/
+TACSAssembler *TACSJobScheduler::createAssembler(TACSCreator *creator) {
+  TACSCreator *group_creator = creator->createSubCreator(group_comm);
+  group_creator->incref();
+
+  TACSAssembler *tacs = group_creator->createTACS();
+  tacs->incref();
+  if (assembler) {
+    assembler->decref();
+  }
+  assembler = tacs;
+
+  group_creator->decref();
+  return assembler;
+}
+
+/*
+  Run the jobs on the groups. This is collective on comm.
+
+  The root of each group takes the next job from a counter stored on
+  the root of comm using an atomic fetch-and-add, and broadcasts the
+  job number to the rest of its group. The group then performs the job
+  and returns for the next one until all the jobs have been taken.
+
+  input:
+  num_jobs:    the number of jobs
+  func:        the function that performs a job
+  ctx:         the context passed to the function
+
+  output:
+  job_groups:  optional group that performed each job (on all procs)
+*/
+void TACSJobScheduler::run(int num_jobs, TACSJobFunction func, void *ctx,
+                           int *job_groups) {
+  int rank, group_rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_rank(group_comm, &group_rank);
+
+  // Create the shared job counter on the root processor
+  int counter = 0;
+  MPI_Win win;
+  MPI_Win_create(&counter, (rank == 0 ? sizeof(int) : 0), sizeof(int),
+                 MPI_INFO_NULL, comm, &win);
+
+  if (job_groups) {
+    for (int i = 0; i < num_jobs; i++) {
+      job_groups[i] = -1;
+    }
+  }
+
+  while (1) {
+    int job = 0;
+    if (group_rank == 0) {
+      int one = 1;
+      MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+      MPI_Fetch_and_op(&one, &job, MPI_INT, 0, 0, MPI_SUM, win);
+      MPI_Win_unlock(0, win);
+    }
+    MPI_Bcast(&job, 1, MPI_INT, 0, group_comm);
+    if (job >= num_jobs) {
+      break;
+    }
+
+    func(ctx, job, assembler);
+    if (job_groups && group_rank == 0) {
+      job_groups[job] = group;
+    }
+  }
+
+  MPI_Win_free(&win);
+
+  // Share the group that performed each job
+  if (job_groups) {
+    MPI_Allreduce(MPI_IN_PLACE, job_groups, num_jobs, MPI_INT, MPI_MAX, comm);
+  }
+}
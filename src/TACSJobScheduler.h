@@ -0,0 +1,81 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_JOB_SCHEDULER_H
+#define TACS_JOB_SCHEDULER_H
+
+#include "TACSCreator.h"
+
+/*
+  The callback that performs a single job
+
+  The job is performed collectively by all the processors in the group
+  using the assembler created on the group communicator.
+*/
+typedef void (*TACSJobFunction)(void *ctx, int job, TACSAssembler *assembler);
+
+/*
+  Schedule many independent analyses on groups of processors
+
+  The processors are split into contiguous groups, either of nearly
+  equal size or with the given sizes, and each group holds its own
+  copy of the finite-element model. The model for each group is
+  created from a single TACSCreator on the full communicator, which
+  sends the mesh definition from its root to the root of each group,
+  so the mesh is only read or generated once.
+
+  The jobs are numbered 0 to num_jobs-1 and are dispatched dynamically:
+  the root of each group takes the next job from a shared counter
+  whenever its group is idle, so groups that finish early pick up more
+  of the work. The groups only synchronize at the start and the end of
+  run(). This favors throughput over the latency of any single job,
+  which is the usual trade-off for parameter sweeps, load cases and
+  Monte Carlo sampling.
+*/
+class TACSJobScheduler : public TACSObject {
+ public:
+  TACSJobScheduler(MPI_Comm _comm, int _num_groups,
+                   const int *group_sizes = NULL);
+  ~TACSJobScheduler();
+
+  // Create the model for this group from a creator on the full comm
+  // ---------------------------------------------------------------
+  TACSAssembler *createAssembler(TACSCreator *creator);
+
+  // Retrieve the group data
+  // -----------------------
+  MPI_Comm getGroupComm() { return group_comm; }
+  TACSAssembler *getAssembler() { return assembler; }
+  int getGroup() { return group; }
+  int getNumGroups() { return num_groups; }
+
+  // Run the jobs on the groups
+  // --------------------------
+  void run(int num_jobs, TACSJobFunction func, void *ctx,
+           int *job_groups = NULL);
+
+ private:
+  // The communicator for all the groups and the group data
+  MPI_Comm comm, group_comm;
+  int group, num_groups;
+
+  // The finite-element model on this group
+  TACSAssembler *assembler;
+};
+
+#endif  // TACS_JOB_SCHEDULER_H
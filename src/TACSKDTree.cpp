@@ -0,0 +1,282 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSKDTree.h"
+
+// The largest range of points that is searched directly
+static const int TACS_KD_LEAF_SIZE = 8;
+
+/*
+  The nearest points found so far, sorted by the squared distance
+*/
+struct TACSKDTree::Nearest {
+  int k, count;
+  double *dist;
+  int *best;
+};
+
+static void TacsKDInsert(int k, int *count, double *dist, int *best, double d,
+                         int point) {
+  int pos = *count;
+  if (*count < k) {
+    (*count)++;
+  } else if (d >= dist[k - 1]) {
+    return;
+  } else {
+    pos = k - 1;
+  }
+  while (pos > 0 && dist[pos - 1] > d) {
+    dist[pos] = dist[pos - 1];
+    best[pos] = best[pos - 1];
+    pos--;
+  }
+  dist[pos] = d;
+  best[pos] = point;
+}
+
+static inline double TacsKDDist(const double *x, const double q[]) {
+  return ((x[0] - q[0]) * (x[0] - q[0]) + (x[1] - q[1]) * (x[1] - q[1]) +
+          (x[2] - q[2]) * (x[2] - q[2]));
+}
+
+/*
+  Build the tree for the points
+
+  input:
+  npts:   the number of points
+  Xpts:   the point locations (3*npts values)
+*/
+TACSKDTree::TACSKDTree(int _npts, const TacsScalar *Xpts) {
+  npts = _npts;
+  X = new double[3 * npts];
+  for (int i = 0; i < 3 * npts; i++) {
+    X[i] = TacsRealPart(Xpts[i]);
+  }
+  perm = new int[npts];
+  axis = new int[npts];
+  for (int i = 0; i < npts; i++) {
+    perm[i] = i;
+    axis[i] = 0;
+  }
+  build(0, npts);
+}
+
+TACSKDTree::~TACSKDTree() {
+  delete[] X;
+  delete[] perm;
+  delete[] axis;
+}
+
+/*
+  Build the tree for the points in the range start <= i < end
+*/
+void TACSKDTree::build(int start, int end) {
+  if (end - start <= TACS_KD_LEAF_SIZE) {
+    return;
+  }
+
+  // Split along the direction with the largest extent
+  double lower[3], upper[3];
+  for (int k = 0; k < 3; k++) {
+    lower[k] = upper[k] = X[3 * perm[start] + k];
+  }
+  for (int i = start + 1; i < end; i++) {
+    const double *x = &X[3 * perm[i]];
+    for (int k = 0; k < 3; k++) {
+      if (x[k] < lower[k]) {
+        lower[k] = x[k];
+      }
+      if (x[k] > upper[k]) {
+        upper[k] = x[k];
+      }
+    }
+  }
+  int dir = 0;
+  for (int k = 1; k < 3; k++) {
+    if (upper[k] - lower[k] > upper[dir] - lower[dir]) {
+      dir = k;
+    }
+  }
+
+  // Place the median at mid with the smaller points before it
+  int mid = (start + end) / 2;
+  int lo = start, hi = end - 1;
+  while (lo < hi) {
+    double pivot = X[3 * perm[(lo + hi) / 2] + dir];
+    int i = lo, j = hi;
+    while (i <= j) {
+      while (X[3 * perm[i] + dir] < pivot) {
+        i++;
+      }
+      while (X[3 * perm[j] + dir] > pivot) {
+        j--;
+      }
+      if (i <= j) {
+        int t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+        i++;
+        j--;
+      }
+    }
+    if (mid <= j) {
+      hi = j;
+    } else if (mid >= i) {
+      lo = i;
+    } else {
+      break;
+    }
+  }
+
+  axis[mid] = dir;
+  build(start, mid);
+  build(mid + 1, end);
+}
+
+/*
+  Find the nearest points to pt in the range start <= i < end
+*/
+void TACSKDTree::searchNearest(int start, int end, const double q[],
+                               Nearest *near) {
+  if (end - start <= TACS_KD_LEAF_SIZE) {
+    for (int i = start; i < end; i++) {
+      TacsKDInsert(near->k, &near->count, near->dist, near->best,
+                   TacsKDDist(&X[3 * perm[i]], q), perm[i]);
+    }
+    return;
+  }
+
+  int mid = (start + end) / 2;
+  int point = perm[mid];
+  TacsKDInsert(near->k, &near->count, near->dist, near->best,
+               TacsKDDist(&X[3 * point], q), point);
+
+  // Search the side of the split containing q first
+  double delta = q[axis[mid]] - X[3 * point + axis[mid]];
+  if (delta < 0.0) {
+    searchNearest(start, mid, q, near);
+  } else {
+    searchNearest(mid + 1, end, q, near);
+  }
+  if (near->count < near->k || delta * delta < near->dist[near->count - 1]) {
+    if (delta < 0.0) {
+      searchNearest(mid + 1, end, q, near);
+    } else {
+      searchNearest(start, mid, q, near);
+    }
+  }
+}
+
+/*
+  Find the nearest points to a point
+
+  input:
+  pt:     the point
+  k:      the number of points to find
+
+  output:
+  index:  the point indices sorted by distance (k values)
+  dist2:  the squared distances (k values, may be NULL)
+
+  returns: the number of points found, min(k, npts)
+*/
+int TACSKDTree::findNearest(const TacsScalar pt[], int k, int index[],
+                            double dist2[]) {
+  double q[3];
+  q[0] = TacsRealPart(pt[0]);
+  q[1] = TacsRealPart(pt[1]);
+  q[2] = TacsRealPart(pt[2]);
+
+  Nearest near;
+  near.k = k;
+  near.count = 0;
+  near.best = index;
+  near.dist = dist2;
+  if (!dist2) {
+    near.dist = new double[k];
+  }
+  if (k > 0) {
+    searchNearest(0, npts, q, &near);
+  }
+  if (!dist2) {
+    delete[] near.dist;
+  }
+
+  return near.count;
+}
+
+/*
+  Find the points within the radius r of q in the range start <= i < end
+*/
+void TACSKDTree::searchRadius(int start, int end, const double q[], double r2,
+                              int max_size, int index[], int *count) {
+  if (end - start <= TACS_KD_LEAF_SIZE) {
+    for (int i = start; i < end; i++) {
+      if (TacsKDDist(&X[3 * perm[i]], q) <= r2) {
+        if (*count < max_size) {
+          index[*count] = perm[i];
+        }
+        (*count)++;
+      }
+    }
+    return;
+  }
+
+  int mid = (start + end) / 2;
+  int point = perm[mid];
+  if (TacsKDDist(&X[3 * point], q) <= r2) {
+    if (*count < max_size) {
+      index[*count] = point;
+    }
+    (*count)++;
+  }
+
+  double delta = q[axis[mid]] - X[3 * point + axis[mid]];
+  if (delta <= 0.0 || delta * delta <= r2) {
+    searchRadius(start, mid, q, r2, max_size, index, count);
+  }
+  if (delta >= 0.0 || delta * delta <= r2) {
+    searchRadius(mid + 1, end, q, r2, max_size, index, count);
+  }
+}
+
+/*
+  Find the points within a radius of a point, in no particular order
+
+  input:
+  pt:         the point
+  radius:     the radius
+  max_size:   the length of the index array
+
+  output:
+  index:      the point indices
+
+  returns: the number of points within the radius, which may exceed
+  max_size, in which case only the first max_size are stored
+*/
+int TACSKDTree::findInRadius(const TacsScalar pt[], double radius,
+                             int max_size, int index[]) {
+  double q[3];
+  q[0] = TacsRealPart(pt[0]);
+  q[1] = TacsRealPart(pt[1]);
+  q[2] = TacsRealPart(pt[2]);
+
+  int count = 0;
+  searchRadius(0, npts, q, radius * radius, max_size, index, &count);
+  return count;
+}
@@ -0,0 +1,62 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_KD_TREE_H
+#define TACS_KD_TREE_H
+
+#include "TACSObject.h"
+
+/*
+  A kd-tree for finding the nearest points to a query point
+
+  The tree is stored implicitly in a permutation of the points: the
+  points in the range start <= i < end are split at the median
+  mid = (start + end)/2 along the direction of their largest extent,
+  and small ranges are searched directly. The tree uses the real part
+  of the locations, and the queries may be made concurrently.
+*/
+class TACSKDTree : public TACSObject {
+ public:
+  TACSKDTree(int _npts, const TacsScalar *Xpts);
+  ~TACSKDTree();
+
+  // Get the number of points
+  int getNumPoints() { return npts; }
+
+  // Find the nearest points, sorted by distance
+  int findNearest(const TacsScalar pt[], int k, int index[],
+                  double dist2[] = NULL);
+
+  // Find the points within a radius
+  int findInRadius(const TacsScalar pt[], double radius, int max_size,
+                   int index[]);
+
+ private:
+  struct Nearest;
+  void build(int start, int end);
+  void searchNearest(int start, int end, const double q[], Nearest *near);
+  void searchRadius(int start, int end, const double q[], double r2,
+                    int max_size, int index[], int *count);
+
+  int npts;
+  double *X;
+  int *perm;
+  int *axis;
+};
+
+#endif  // TACS_KD_TREE_H
@@ -0,0 +1,269 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSLinearConstraint.h"
+
+#include "TacsUtilities.h"
+
+/*
+  Create the linear constraint object. This is collective on the
+  communicator of the assembler.
+
+  input:
+  assembler:   the TACSAssembler object
+*/
+TACSLinearConstraint::TACSLinearConstraint(TACSAssembler *_assembler) {
+  assembler = _assembler;
+  assembler->incref();
+
+  MPI_Comm comm = assembler->getMPIComm();
+  num_comps = assembler->getNumComponents();
+
+  // Find the first element of each component on this processor and the
+  // number of design variables that it defines
+  int num_elements = assembler->getNumElements();
+  TACSElement **elements = assembler->getElements();
+  int *first = new int[num_comps];
+  int *count = new int[num_comps];
+  for (int i = 0; i < num_comps; i++) {
+    first[i] = -1;
+    count[i] = 0;
+  }
+  for (int i = 0; i < num_elements; i++) {
+    int comp = elements[i]->getComponentNum();
+    if (comp >= 0 && comp < num_comps && first[comp] < 0) {
+      first[comp] = i;
+      count[comp] = elements[i]->getDesignVarNums(i, 0, NULL);
+    }
+  }
+
+  // Share the number of design variables of each component
+  comp_ptr = new int[num_comps + 1];
+  MPI_Allreduce(count, &comp_ptr[1], num_comps, MPI_INT, MPI_MAX, comm);
+  comp_ptr[0] = 0;
+  for (int i = 0; i < num_comps; i++) {
+    comp_ptr[i + 1] += comp_ptr[i];
+  }
+
+  // Share the design variable numbers of each component
+  int size = comp_ptr[num_comps];
+  int *dvs = new int[size];
+  for (int i = 0; i < size; i++) {
+    dvs[i] = -1;
+  }
+  for (int i = 0; i < num_comps; i++) {
+    if (first[i] >= 0) {
+      int elem = first[i];
+      int len = comp_ptr[i + 1] - comp_ptr[i];
+      elements[elem]->getDesignVarNums(elem, len, &dvs[comp_ptr[i]]);
+    }
+  }
+  comp_dvs = new int[size];
+  MPI_Allreduce(dvs, comp_dvs, size, MPI_INT, MPI_MAX, comm);
+  delete[] dvs;
+  delete[] first;
+  delete[] count;
+
+  // Get the design variables owned by this processor
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  const int *range;
+  assembler->getDesignNodeMap()->getOwnerRange(&range);
+  dv_start = range[rank];
+  dv_end = range[rank + 1];
+  dvs_per_node = assembler->getDesignVarsPerNode();
+  num_cols = dvs_per_node * (dv_end - dv_start);
+
+  // Allocate space for the Jacobian
+  num_rows = 0;
+  max_rows = 256;
+  rowp = new int[max_rows + 1];
+  rowp[0] = 0;
+  max_size = 2 * max_rows;
+  cols = new int[max_size];
+  vals = new TacsScalar[max_size];
+}
+
+TACSLinearConstraint::~TACSLinearConstraint() {
+  assembler->decref();
+  delete[] comp_ptr;
+  delete[] comp_dvs;
+  delete[] rowp;
+  delete[] cols;
+  delete[] vals;
+}
+
+/*
+  Get the design variable numbers of a component
+
+  input:
+  comp:   the component number
+
+  output:
+  dvs:    the global design variable numbers (negative if undefined)
+
+  returns: the number of design variable numbers
+*/
+int TACSLinearConstraint::getComponentDesignVarNums(int comp,
+                                                    const int **dvs) {
+  if (comp < 0 || comp >= num_comps) {
+    *dvs = NULL;
+    return 0;
+  }
+  *dvs = &comp_dvs[comp_ptr[comp]];
+  return comp_ptr[comp + 1] - comp_ptr[comp];
+}
+
+/*
+  Add a row to the Jacobian. Only the entries for design variables
+  owned by this processor are stored, and entries for the same design
+  variable are combined.
+*/
+void TACSLinearConstraint::addRow(int n, const int dvs[],
+                                  const TacsScalar weights[]) {
+  if (num_rows >= max_rows) {
+    int new_max = 2 * max_rows;
+    TacsExtendArray(&rowp, max_rows + 1, new_max + 1);
+    max_rows = new_max;
+  }
+  if (rowp[num_rows] + n > max_size) {
+    int new_max = 2 * max_size + n;
+    TacsExtendArray(&cols, rowp[num_rows], new_max);
+    TacsExtendArray(&vals, rowp[num_rows], new_max);
+    max_size = new_max;
+  }
+
+  int start = rowp[num_rows];
+  int end = start;
+  for (int i = 0; i < n; i++) {
+    if (dvs[i] >= dv_start && dvs[i] < dv_end) {
+      int col = dvs_per_node * (dvs[i] - dv_start);
+      int k = start;
+      while (k < end && cols[k] != col) {
+        k++;
+      }
+      if (k < end) {
+        vals[k] += weights[i];
+      } else {
+        cols[end] = col;
+        vals[end] = weights[i];
+        end++;
+      }
+    }
+  }
+
+  num_rows++;
+  rowp[num_rows] = end;
+}
+
+/*
+  Add a constraint for each pair of components that the design
+  variable dv_index of the first component is equal to that of the
+  second. The rows have the coefficient 1 for the first component and
+  -1 for the second.
+
+  input:
+  num_pairs:    the number of component pairs
+  comp_pairs:   the component numbers of each pair (2*num_pairs)
+  dv_index:     the index of the design variable within each component
+
+  returns: the number of rows added
+*/
+int TACSLinearConstraint::addAdjacencyConstraints(int num_pairs,
+                                                  const int comp_pairs[],
+                                                  int dv_index) {
+  const TacsScalar weights[2] = {1.0, -1.0};
+  for (int i = 0; i < num_pairs; i++) {
+    int dvs[2];
+    for (int j = 0; j < 2; j++) {
+      const int *comp_dv_nums;
+      int len = getComponentDesignVarNums(comp_pairs[2 * i + j],
+                                          &comp_dv_nums);
+      dvs[j] = -1;
+      if (dv_index >= 0 && dv_index < len) {
+        dvs[j] = comp_dv_nums[dv_index];
+      }
+    }
+    addRow(2, dvs, weights);
+  }
+
+  return num_pairs;
+}
+
+/*
+  Add a constraint for each component that is the weighted sum of the
+  design variables with the given indices within the component.
+
+  input:
+  num_comps:   the number of components
+  comps:       the component numbers
+  num_dvs:     the number of design variables in each constraint
+  dv_index:    the index of each design variable within the component
+  weights:     the weight of each design variable
+
+  returns: the number of rows added
+*/
+int TACSLinearConstraint::addDVConstraints(int _num_comps, const int comps[],
+                                           int num_dvs, const int dv_index[],
+                                           const TacsScalar weights[]) {
+  int *dvs = new int[num_dvs];
+  for (int i = 0; i < _num_comps; i++) {
+    const int *comp_dv_nums;
+    int len = getComponentDesignVarNums(comps[i], &comp_dv_nums);
+    for (int j = 0; j < num_dvs; j++) {
+      dvs[j] = -1;
+      if (dv_index[j] >= 0 && dv_index[j] < len) {
+        dvs[j] = comp_dv_nums[dv_index[j]];
+      }
+    }
+    addRow(num_dvs, dvs, weights);
+  }
+  delete[] dvs;
+
+  return _num_comps;
+}
+
+/*
+  Get the Jacobian in compressed sparse row format
+
+  output:
+  num_rows:   the number of constraints
+  num_cols:   the number of design variables on this processor
+  rowp:       the pointer into each row
+  cols:       the local design variable number of each entry
+  vals:       the value of each entry
+*/
+void TACSLinearConstraint::getArrays(int *_num_rows, int *_num_cols,
+                                     const int **_rowp, const int **_cols,
+                                     const TacsScalar **_vals) {
+  if (_num_rows) {
+    *_num_rows = num_rows;
+  }
+  if (_num_cols) {
+    *_num_cols = num_cols;
+  }
+  if (_rowp) {
+    *_rowp = rowp;
+  }
+  if (_cols) {
+    *_cols = cols;
+  }
+  if (_vals) {
+    *_vals = vals;
+  }
+}
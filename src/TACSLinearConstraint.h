@@ -0,0 +1,89 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_LINEAR_CONSTRAINT_H
+#define TACS_LINEAR_CONSTRAINT_H
+
+#include "TACSAssembler.h"
+
+/*
+  Build the sparse Jacobian of linear constraints on the design
+  variables of the components of the model
+
+  The design variable numbers of each component are taken from the
+  first element of the component and shared between the processors
+  when the object is created. The constraints are then added row by
+  row, and each processor stores only the entries in the columns of
+  the design variables it owns, numbered locally from the start of its
+  ownership range. Each row exists on all processors, even when it has
+  no entries on a processor, so the constraint values are the sum of
+  the local products over the processors.
+
+  The constraints are linear, so the Jacobian is built once and is
+  returned in compressed sparse row format. Adding rows may reallocate
+  the arrays returned by getArrays().
+*/
+class TACSLinearConstraint : public TACSObject {
+ public:
+  TACSLinearConstraint(TACSAssembler *_assembler);
+  ~TACSLinearConstraint();
+
+  // Add constraints to the Jacobian
+  // -------------------------------
+  int addAdjacencyConstraints(int num_pairs, const int comp_pairs[],
+                              int dv_index);
+  int addDVConstraints(int num_comps, const int comps[], int num_dvs,
+                       const int dv_index[], const TacsScalar weights[]);
+
+  // Get the design variable numbers of a component
+  // ----------------------------------------------
+  int getNumComponents() { return num_comps; }
+  int getComponentDesignVarNums(int comp, const int **dvs);
+
+  // Get the size and the arrays of the Jacobian
+  // -------------------------------------------
+  int getNumConstraints() { return num_rows; }
+  int getNumDesignVars() { return num_cols; }
+  void getArrays(int *_num_rows, int *_num_cols, const int **_rowp,
+                 const int **_cols, const TacsScalar **_vals);
+
+ private:
+  // Add a row with the given global design variable numbers
+  void addRow(int n, const int dvs[], const TacsScalar weights[]);
+
+  // The assembler object
+  TACSAssembler *assembler;
+
+  // The design variable numbers of each component, stored in the range
+  // comp_ptr[i] <= k < comp_ptr[i+1] and negative when not defined
+  int num_comps;
+  int *comp_ptr, *comp_dvs;
+
+  // The design variables owned by this processor
+  int dv_start, dv_end, dvs_per_node;
+  int num_cols;
+
+  // The sparse Jacobian
+  int num_rows, max_rows;
+  int *rowp;
+  int max_size;
+  int *cols;
+  TacsScalar *vals;
+};
+
+#endif  // TACS_LINEAR_CONSTRAINT_H
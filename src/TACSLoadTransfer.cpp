@@ -0,0 +1,355 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSLoadTransfer.h"
+
+#include "TACSKDTree.h"
+#include "TacsUtilities.h"
+
+/*
+  The data used to compute the weights in parallel
+*/
+struct TACSLoadTransferArgs {
+  TACSKDTree *tree;
+  const TacsScalar *Xsurf, *Xaero;
+  int num_nearest;
+  int *nodes;
+  TacsScalar *weights;
+};
+
+static void TacsLoadTransferRange(int start, int end, int thread_id,
+                                  void *ctx) {
+  TACSLoadTransferArgs *args = (TACSLoadTransferArgs *)ctx;
+  int k = args->num_nearest;
+
+  TacsScalar *pts = new TacsScalar[3 * k];
+  for (int i = start; i < end; i++) {
+    const TacsScalar *pt = &args->Xaero[3 * i];
+    int *nodes = &args->nodes[k * i];
+    args->tree->findNearest(pt, k, nodes);
+    for (int j = 0; j < k; j++) {
+      memcpy(&pts[3 * j], &args->Xsurf[3 * nodes[j]], 3 * sizeof(TacsScalar));
+    }
+    TACSLoadTransfer::computeWeights(pt, k, pts, &args->weights[k * i]);
+  }
+  delete[] pts;
+}
+
+/*
+  Create the transfer object. This is collective on the communicator
+  of the assembler.
+
+  input:
+  assembler:        the TACSAssembler object
+  num_surf_nodes:   the number of surface nodes given on this processor
+  surf_nodes:       the TACSAssembler numbers of the surface nodes
+  num_aero_nodes:   the number of aerodynamic points on this processor
+  Xaero:            the aerodynamic point locations (3*num_aero_nodes)
+  num_nearest:      the number of surface nodes used for each point
+*/
+TACSLoadTransfer::TACSLoadTransfer(TACSAssembler *_assembler,
+                                   int num_surf_nodes, const int *surf_nodes,
+                                   int _num_aero_nodes,
+                                   const TacsScalar *Xaero, int num_nearest) {
+  assembler = _assembler;
+  assembler->incref();
+  vars_per_node = assembler->getVarsPerNode();
+  num_aero_nodes = _num_aero_nodes;
+
+  // Share the surface nodes with all processors
+  int mpi_size;
+  MPI_Comm comm = assembler->getMPIComm();
+  MPI_Comm_size(comm, &mpi_size);
+  int *counts = new int[mpi_size];
+  int *disps = new int[mpi_size + 1];
+  MPI_Allgather(&num_surf_nodes, 1, MPI_INT, counts, 1, MPI_INT, comm);
+  disps[0] = 0;
+  for (int i = 0; i < mpi_size; i++) {
+    disps[i + 1] = disps[i] + counts[i];
+  }
+  int *surf = new int[disps[mpi_size]];
+  MPI_Allgatherv((void *)surf_nodes, num_surf_nodes, MPI_INT, surf, counts,
+                 disps, MPI_INT, comm);
+  int num_surf = TacsUniqueSort(disps[mpi_size], surf);
+  delete[] counts;
+  delete[] disps;
+
+  // Gather the locations of the surface nodes
+  int *surf_copy = new int[num_surf];
+  memcpy(surf_copy, surf, num_surf * sizeof(int));
+  TACSBVecIndices *surf_indices = new TACSBVecIndices(&surf_copy, num_surf);
+  TACSBVecDistribute *surf_dist =
+      new TACSBVecDistribute(assembler->getNodeMap(), surf_indices);
+  surf_dist->incref();
+  TACSBVecDistCtx *surf_ctx = surf_dist->createCtx(3);
+  surf_ctx->incref();
+
+  TACSBVec *X = assembler->createNodeVec();
+  X->incref();
+  assembler->getNodes(X);
+  TacsScalar *Xarray;
+  X->getArray(&Xarray);
+  TacsScalar *Xsurf = new TacsScalar[3 * num_surf];
+  surf_dist->beginForward(surf_ctx, Xarray, Xsurf);
+  surf_dist->endForward(surf_ctx, Xarray, Xsurf);
+  X->decref();
+  surf_ctx->decref();
+  surf_dist->decref();
+
+  // Build the kd-tree of the surface nodes
+  TACSKDTree *tree = new TACSKDTree(num_surf, Xsurf);
+  tree->incref();
+
+  // Find the nearest surface nodes and the weights on the threads
+  if (num_nearest > num_surf) {
+    num_nearest = num_surf;
+  }
+  ptr = new int[num_aero_nodes + 1];
+  for (int i = 0; i <= num_aero_nodes; i++) {
+    ptr[i] = num_nearest * i;
+  }
+  nodes = new int[ptr[num_aero_nodes]];
+  weights = new TacsScalar[ptr[num_aero_nodes]];
+
+  if (num_nearest > 0) {
+    TACSLoadTransferArgs args;
+    args.tree = tree;
+    args.Xsurf = Xsurf;
+    args.Xaero = Xaero;
+    args.num_nearest = num_nearest;
+    args.nodes = nodes;
+    args.weights = weights;
+
+    TACSThreadInfo *thread_info = assembler->getThreadInfo();
+    thread_info->parallelFor(num_aero_nodes, 64, TacsLoadTransferRange,
+                             &args);
+  }
+
+  delete[] Xsurf;
+  tree->decref();
+
+  // Convert to the node numbers and find the unique nodes used on this
+  // processor
+  int size = ptr[num_aero_nodes];
+  for (int i = 0; i < size; i++) {
+    nodes[i] = surf[nodes[i]];
+  }
+  delete[] surf;
+
+  int *used = new int[size];
+  memcpy(used, nodes, size * sizeof(int));
+  int num_used = TacsUniqueSort(size, used);
+  local_index = new int[size];
+  for (int i = 0; i < size; i++) {
+    int *item = TacsSearchArray(nodes[i], num_used, used);
+    local_index[i] = item - used;
+  }
+
+  // Create the distribution object for the products
+  TACSBVecIndices *indices = new TACSBVecIndices(&used, num_used);
+  dist = new TACSBVecDistribute(assembler->getNodeMap(), indices);
+  dist->incref();
+  ctx = dist->createCtx(vars_per_node);
+  ctx->incref();
+  Ulocal = new TacsScalar[vars_per_node * num_used];
+}
+
+TACSLoadTransfer::~TACSLoadTransfer() {
+  assembler->decref();
+  dist->decref();
+  ctx->decref();
+  delete[] ptr;
+  delete[] nodes;
+  delete[] local_index;
+  delete[] weights;
+  delete[] Ulocal;
+}
+
+/*
+  Compute the MLS interpolation weights of a point
+
+  The basis is p(x) = (1, (x - pt)/r), where r is 1.5 times the distance
+  to the furthest point, and the weight function is the Wendland C2
+  function w(q) = (1 - q)^4 (4q + 1) of q = ||x - pt||/r. The weights
+  are the values of the MLS shape functions at pt
+
+  phi_j = w_j p(x_j)^{T} A^{-1} p(pt),  A = sum_j w_j p(x_j) p(x_j)^{T}
+
+  where the linear terms of A are regularized so that the weights are
+  defined for coplanar or collinear points.
+
+  input:
+  pt:       the point
+  npts:     the number of points
+  Xpts:     the point locations (3*npts values)
+
+  output:
+  weights:  the interpolation weights (npts values)
+*/
+void TACSLoadTransfer::computeWeights(const TacsScalar pt[], int npts,
+                                      const TacsScalar Xpts[],
+                                      TacsScalar weights[]) {
+  // Find the radius of the support
+  double rmax = 0.0;
+  for (int j = 0; j < npts; j++) {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; k++) {
+      double d = TacsRealPart(Xpts[3 * j + k] - pt[k]);
+      d2 += d * d;
+    }
+    if (d2 > rmax) {
+      rmax = d2;
+    }
+  }
+  if (rmax == 0.0) {
+    for (int j = 0; j < npts; j++) {
+      weights[j] = 1.0 / npts;
+    }
+    return;
+  }
+  double r = 1.5 * sqrt(rmax);
+
+  // Form the moment matrix
+  TacsScalar A[16];
+  memset(A, 0, 16 * sizeof(TacsScalar));
+  for (int j = 0; j < npts; j++) {
+    TacsScalar p[4];
+    p[0] = 1.0;
+    for (int k = 0; k < 3; k++) {
+      p[k + 1] = (Xpts[3 * j + k] - pt[k]) / r;
+    }
+    TacsScalar q2 = p[1] * p[1] + p[2] * p[2] + p[3] * p[3];
+    TacsScalar q = 0.0;
+    if (TacsRealPart(q2) > 0.0) {
+      q = sqrt(q2);
+    }
+    TacsScalar w = (1.0 - q) * (1.0 - q) * (1.0 - q) * (1.0 - q) *
+                   (4.0 * q + 1.0);
+    weights[j] = w;
+    for (int l = 0; l < 4; l++) {
+      for (int m = 0; m < 4; m++) {
+        A[4 * l + m] += w * p[l] * p[m];
+      }
+    }
+  }
+  for (int l = 1; l < 4; l++) {
+    A[5 * l] += 1e-12 * A[0];
+  }
+
+  // Solve A*b = e1, A is symmetric positive definite
+  TacsScalar b[4] = {1.0, 0.0, 0.0, 0.0};
+  for (int l = 0; l < 4; l++) {
+    for (int m = l + 1; m < 4; m++) {
+      TacsScalar f = A[4 * m + l] / A[5 * l];
+      for (int n = l; n < 4; n++) {
+        A[4 * m + n] -= f * A[4 * l + n];
+      }
+      b[m] -= f * b[l];
+    }
+  }
+  for (int l = 3; l >= 0; l--) {
+    for (int m = l + 1; m < 4; m++) {
+      b[l] -= A[4 * l + m] * b[m];
+    }
+    b[l] /= A[5 * l];
+  }
+
+  for (int j = 0; j < npts; j++) {
+    TacsScalar phi = b[0];
+    for (int k = 0; k < 3; k++) {
+      phi += b[k + 1] * (Xpts[3 * j + k] - pt[k]) / r;
+    }
+    weights[j] *= phi;
+  }
+}
+
+/*
+  Compute the displacements of the aerodynamic points
+
+  input:
+  us:   the structural state vector
+
+  output:
+  ua:   the displacements of the aerodynamic points (3*num_aero_nodes)
+*/
+void TACSLoadTransfer::transferDisps(TACSBVec *us, TacsScalar ua[]) {
+  TacsScalar *array;
+  us->getArray(&array);
+  dist->beginForward(ctx, array, Ulocal);
+  dist->endForward(ctx, array, Ulocal);
+
+  int ncomp = (vars_per_node < 3 ? vars_per_node : 3);
+  memset(ua, 0, 3 * num_aero_nodes * sizeof(TacsScalar));
+  for (int i = 0; i < num_aero_nodes; i++) {
+    for (int jp = ptr[i]; jp < ptr[i + 1]; jp++) {
+      const TacsScalar *u = &Ulocal[vars_per_node * local_index[jp]];
+      for (int k = 0; k < ncomp; k++) {
+        ua[3 * i + k] += weights[jp] * u[k];
+      }
+    }
+  }
+}
+
+/*
+  Compute the structural loads from the loads at the aerodynamic points
+
+  input:
+  fa:   the loads at the aerodynamic points (3*num_aero_nodes)
+
+  output:
+  fs:   the structural load vector
+*/
+void TACSLoadTransfer::transferLoads(const TacsScalar fa[], TACSBVec *fs) {
+  int ncomp = (vars_per_node < 3 ? vars_per_node : 3);
+  memset(Ulocal, 0, vars_per_node * dist->getNumNodes() * sizeof(TacsScalar));
+  for (int i = 0; i < num_aero_nodes; i++) {
+    for (int jp = ptr[i]; jp < ptr[i + 1]; jp++) {
+      TacsScalar *f = &Ulocal[vars_per_node * local_index[jp]];
+      for (int k = 0; k < ncomp; k++) {
+        f[k] += weights[jp] * fa[3 * i + k];
+      }
+    }
+  }
+
+  TacsScalar *array;
+  fs->zeroEntries();
+  fs->getArray(&array);
+  dist->beginReverse(ctx, Ulocal, array, TACS_ADD_VALUES);
+  dist->endReverse(ctx, Ulocal, array, TACS_ADD_VALUES);
+}
+
+/*
+  Get the interpolation weights for the aerodynamic points
+
+  output:
+  ptr:      pointer into the nodes and weights of each point
+  nodes:    the TACSAssembler node numbers
+  weights:  the interpolation weights
+*/
+void TACSLoadTransfer::getWeights(const int **_ptr, const int **_nodes,
+                                  const TacsScalar **_weights) {
+  if (_ptr) {
+    *_ptr = ptr;
+  }
+  if (_nodes) {
+    *_nodes = nodes;
+  }
+  if (_weights) {
+    *_weights = weights;
+  }
+}
@@ -0,0 +1,97 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_LOAD_TRANSFER_H
+#define TACS_LOAD_TRANSFER_H
+
+#include "TACSAssembler.h"
+
+/*
+  Transfer displacements and loads between the structural surface
+  nodes and an aerodynamic point cloud
+
+  Each aerodynamic point is interpolated from its nearest structural
+  surface nodes with moving least-squares (MLS) weights that use a
+  linear basis and a compactly supported Wendland weight function.
+  The displacements at the aerodynamic points are the forward product
+
+  u_a = W*u_s
+
+  of the translational components of the structural displacements, and
+  the structural loads are the transpose product
+
+  f_s = W^{T}*f_a
+
+  so that the transfer is consistent in the sense of virtual work. The
+  weights of each point sum to one and reproduce linear fields, so the
+  total force and moment of the loads are also conserved. When the
+  surface is planar near a point, the basis is regularized and the
+  interpolation reduces to the in-plane MLS fit.
+
+  The surface nodes are given on each processor as TACSAssembler node
+  numbers, and may be split between the processors in any way. Their
+  locations are shared with all processors, which each search a kd-tree
+  of the surface nodes for the aerodynamic points they own. The weights
+  are computed once, and the products only gather or add the values of
+  the structural nodes that are used on each processor.
+*/
+class TACSLoadTransfer : public TACSObject {
+ public:
+  TACSLoadTransfer(TACSAssembler *_assembler, int num_surf_nodes,
+                   const int *surf_nodes, int _num_aero_nodes,
+                   const TacsScalar *Xaero, int num_nearest = 8);
+  ~TACSLoadTransfer();
+
+  // Get the number of aerodynamic points on this processor
+  // ------------------------------------------------------
+  int getNumAeroNodes() { return num_aero_nodes; }
+
+  // Transfer the displacements and the loads
+  // ----------------------------------------
+  void transferDisps(TACSBVec *us, TacsScalar ua[]);
+  void transferLoads(const TacsScalar fa[], TACSBVec *fs);
+
+  // Get the interpolation weights in CSR format
+  // -------------------------------------------
+  void getWeights(const int **_ptr, const int **_nodes,
+                  const TacsScalar **_weights);
+
+  // Compute the weights for a single point
+  // --------------------------------------
+  static void computeWeights(const TacsScalar pt[], int npts,
+                             const TacsScalar Xpts[], TacsScalar weights[]);
+
+ private:
+  // The assembler object
+  TACSAssembler *assembler;
+  int vars_per_node;
+
+  // The interpolation weights for each aerodynamic point. The nodes
+  // are the global node numbers, and local_index is the index of each
+  // node in the local array of gathered values.
+  int num_aero_nodes;
+  int *ptr, *nodes, *local_index;
+  TacsScalar *weights;
+
+  // The distribution object used to gather and add the values
+  TACSBVecDistribute *dist;
+  TACSBVecDistCtx *ctx;
+  TacsScalar *Ulocal;
+};
+
+#endif  // TACS_LOAD_TRANSFER_H
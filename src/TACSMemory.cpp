@@ -0,0 +1,197 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSMemory.h"
+
+// The current bytes and the high-water marks. The last entry is the
+// total over all categories.
+static pthread_mutex_t mem_mutex = PTHREAD_MUTEX_INITIALIZER;
+static size_t mem_current[TACS_MEMORY_NUM_CATEGORIES + 1];
+static size_t mem_peak[TACS_MEMORY_NUM_CATEGORIES + 1];
+
+static const char *mem_names[] = {
+    "matrix",      "vector",     "dense_matrix", "krylov",
+    "eigensolver", "integrator", "element_cache", "scratch"};
+
+/*
+  Add bytes to the category and update the high-water marks. This
+  must be called with the mutex held.
+*/
+static void TacsMemAdd(int category, size_t bytes) {
+  int total = TACS_MEMORY_NUM_CATEGORIES;
+  mem_current[category] += bytes;
+  mem_current[total] += bytes;
+  if (mem_current[category] > mem_peak[category]) {
+    mem_peak[category] = mem_current[category];
+  }
+  if (mem_current[total] > mem_peak[total]) {
+    mem_peak[total] = mem_current[total];
+  }
+}
+
+/*
+  Remove bytes from the category. This must be called with the mutex
+  held.
+*/
+static void TacsMemRemove(int category, size_t bytes) {
+  int total = TACS_MEMORY_NUM_CATEGORIES;
+  mem_current[category] -=
+      (bytes < mem_current[category] ? bytes : mem_current[category]);
+  mem_current[total] -=
+      (bytes < mem_current[total] ? bytes : mem_current[total]);
+}
+
+/*
+  Record an allocation of the given number of bytes
+*/
+void TACSMemory::allocate(int category, size_t bytes) {
+  if (category < 0 || category >= TACS_MEMORY_NUM_CATEGORIES || bytes == 0) {
+    return;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  TacsMemAdd(category, bytes);
+  pthread_mutex_unlock(&mem_mutex);
+}
+
+/*
+  Record the release of the given number of bytes
+*/
+void TACSMemory::release(int category, size_t bytes) {
+  if (category < 0 || category >= TACS_MEMORY_NUM_CATEGORIES || bytes == 0) {
+    return;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  TacsMemRemove(category, bytes);
+  pthread_mutex_unlock(&mem_mutex);
+}
+
+/*
+  Change the bytes recorded by an object to the new size
+
+  input:
+  category:   the category charged for the memory
+  recorded:   the bytes previously recorded by the object (updated)
+  bytes:      the new number of bytes held by the object
+*/
+void TACSMemory::update(int category, size_t *recorded, size_t bytes) {
+  if (bytes > *recorded) {
+    allocate(category, bytes - *recorded);
+  } else if (bytes < *recorded) {
+    release(category, *recorded - bytes);
+  }
+  *recorded = bytes;
+}
+
+/*
+  Move memory from one category to another. This is used when an
+  object is used by a different subsystem than the one that created
+  it, for instance a vector that is used as a Krylov subspace vector.
+*/
+void TACSMemory::move(int old_category, int new_category, size_t bytes) {
+  if (old_category < 0 || old_category >= TACS_MEMORY_NUM_CATEGORIES ||
+      new_category < 0 || new_category >= TACS_MEMORY_NUM_CATEGORIES ||
+      old_category == new_category || bytes == 0) {
+    return;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  TacsMemRemove(old_category, bytes);
+  TacsMemAdd(new_category, bytes);
+  pthread_mutex_unlock(&mem_mutex);
+}
+
+/*
+  Get the current number of bytes in the category or the total
+*/
+size_t TACSMemory::getCurrentBytes(int category) {
+  if (category < 0 || category >= TACS_MEMORY_NUM_CATEGORIES) {
+    category = TACS_MEMORY_NUM_CATEGORIES;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  size_t bytes = mem_current[category];
+  pthread_mutex_unlock(&mem_mutex);
+  return bytes;
+}
+
+/*
+  Get the high-water mark for the category or the total
+*/
+size_t TACSMemory::getPeakBytes(int category) {
+  if (category < 0 || category >= TACS_MEMORY_NUM_CATEGORIES) {
+    category = TACS_MEMORY_NUM_CATEGORIES;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  size_t bytes = mem_peak[category];
+  pthread_mutex_unlock(&mem_mutex);
+  return bytes;
+}
+
+/*
+  Get the name of the category
+*/
+const char *TACSMemory::getCategoryName(int category) {
+  if (category < 0 || category >= TACS_MEMORY_NUM_CATEGORIES) {
+    return "total";
+  }
+  return mem_names[category];
+}
+
+/*
+  Reset the high-water marks to the current values
+*/
+void TACSMemory::resetPeak() {
+  pthread_mutex_lock(&mem_mutex);
+  for (int k = 0; k <= TACS_MEMORY_NUM_CATEGORIES; k++) {
+    mem_peak[k] = mem_current[k];
+  }
+  pthread_mutex_unlock(&mem_mutex);
+}
+
+/*
+  Print the current and peak memory in MB for each category with the
+  minimum, maximum and average over the processes in the communicator
+
+  This call is collective on comm.
+*/
+void TACSMemory::printSummary(MPI_Comm comm, FILE *fp) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const int n = 2 * (TACS_MEMORY_NUM_CATEGORIES + 1);
+  double local[n], vmin[n], vmax[n], vsum[n];
+  pthread_mutex_lock(&mem_mutex);
+  for (int k = 0; k <= TACS_MEMORY_NUM_CATEGORIES; k++) {
+    local[2 * k] = mem_current[k] / (1024.0 * 1024.0);
+    local[2 * k + 1] = mem_peak[k] / (1024.0 * 1024.0);
+  }
+  pthread_mutex_unlock(&mem_mutex);
+
+  MPI_Reduce(local, vmin, n, MPI_DOUBLE, MPI_MIN, 0, comm);
+  MPI_Reduce(local, vmax, n, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(local, vsum, n, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+  if (rank == 0 && fp) {
+    fprintf(fp, "TACSMemory: Memory per process [MB]\n");
+    fprintf(fp, "%-15s %12s %12s %12s %12s %12s %12s\n", "category",
+            "cur min", "cur max", "cur avg", "peak min", "peak max",
+            "peak avg");
+    for (int k = 0; k <= TACS_MEMORY_NUM_CATEGORIES; k++) {
+      fprintf(fp, "%-15s %12.2f %12.2f %12.2f %12.2f %12.2f %12.2f\n",
+              getCategoryName(k), vmin[2 * k], vmax[2 * k],
+              vsum[2 * k] / size, vmin[2 * k + 1], vmax[2 * k + 1],
+              vsum[2 * k + 1] / size);
+    }
+    fflush(fp);
+  }
+}
@@ -0,0 +1,77 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_MEMORY_H
+#define TACS_MEMORY_H
+
+#include "TACSObject.h"
+
+/*
+  The subsystems that the large allocations are charged to
+*/
+enum TACSMemoryCategory {
+  TACS_MEMORY_MATRIX = 0,     // Sparse matrix values and patterns
+  TACS_MEMORY_VECTOR,         // Distributed vectors
+  TACS_MEMORY_DENSE_MATRIX,   // Block-cyclic dense matrices
+  TACS_MEMORY_KRYLOV,         // Krylov subspace vectors
+  TACS_MEMORY_EIGENSOLVER,    // Lanczos and eigenvector bases
+  TACS_MEMORY_INTEGRATOR,     // Time history of the states
+  TACS_MEMORY_ELEMENT_CACHE,  // Cached element matrices and data
+  TACS_MEMORY_SCRATCH,        // Scratch arenas for the element loops
+  TACS_MEMORY_NUM_CATEGORIES
+};
+
+/*
+  A global account of the memory held by the large objects on this
+  process
+
+  The objects record the bytes they hold when their arrays are
+  allocated or resized, and release them when they are deleted. The
+  current number of bytes and the high-water mark are kept for each
+  category and for the total. These are the sizes requested by the
+  objects, not the sizes obtained from the operating system.
+
+  Objects typically keep the number of bytes they have recorded and
+  call update() with the new size, so that the difference is charged
+  to the category.
+
+  printSummary() is collective and prints the minimum, maximum and
+  average values over the processes in the communicator.
+*/
+class TACSMemory {
+ public:
+  // Record an allocation or release of memory
+  // -----------------------------------------
+  static void allocate(int category, size_t bytes);
+  static void release(int category, size_t bytes);
+  static void update(int category, size_t *recorded, size_t bytes);
+  static void move(int old_category, int new_category, size_t bytes);
+
+  // Get the current bytes and the high-water mark. A negative
+  // category returns the total over all categories.
+  // ---------------------------------------------------------
+  static size_t getCurrentBytes(int category = -1);
+  static size_t getPeakBytes(int category = -1);
+  static const char *getCategoryName(int category);
+
+  // Reset the high-water marks to the current values
+  // ------------------------------------------------
+  static void resetPeak();
+
+  // Print the summary over all processes
+  // ------------------------------------
+  static void printSummary(MPI_Comm comm, FILE *fp = stdout);
+};
+
+#endif  // TACS_MEMORY_H
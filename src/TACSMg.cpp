@@ -47,6 +47,9 @@ TACSMg::TACSMg(MPI_Comm _comm, int _nlevels, double _sor_omega, int _sor_iters,
   sor_omega = _sor_omega;
   sor_iters = _sor_iters;
   sor_symmetric = _sor_symmetric;
+  sor_multicolor = 0;
+  cycle_type = V_CYCLE;
+  coarse_ranks = -1;
 
   if (nlevels < 2) {
     int mpi_rank;
@@ -70,6 +73,12 @@ TACSMg::TACSMg(MPI_Comm _comm, int _nlevels, double _sor_omega, int _sor_iters,
   b = new TACSBVec *[nlevels];
   r = new TACSBVec *[nlevels];
 
+  // The K-cycle vectors are allocated when they are first used
+  kcycle_b = new TACSBVec *[nlevels];
+  kcycle_c = new TACSBVec *[nlevels];
+  kcycle_v = new TACSBVec *[nlevels];
+  kcycle_w = new TACSBVec *[nlevels];
+
   // Initialie the data in the arrays
   for (int i = 0; i < nlevels; i++) {
     iters[i] = 1;         // defaults to one - a V cycle
@@ -78,6 +87,7 @@ TACSMg::TACSMg(MPI_Comm _comm, int _nlevels, double _sor_omega, int _sor_iters,
     r[i] = NULL;
     x[i] = NULL;
     b[i] = NULL;
+    kcycle_b[i] = kcycle_c[i] = kcycle_v[i] = kcycle_w[i] = NULL;
   }
 
   // Create the pointers to the matrices
@@ -97,6 +107,11 @@ TACSMg::TACSMg(MPI_Comm _comm, int _nlevels, double _sor_omega, int _sor_iters,
   root_mat = NULL;
   root_pc = NULL;
 
+  // The coarse shift matrices are allocated when they are first used
+  coarse_shift_valid = 0;
+  coarse_base = NULL;
+  coarse_shift = NULL;
+
   // Total time for smoothing and interpolation for each level
   cumulative_level_time = new double[nlevels];
   memset(cumulative_level_time, 0, nlevels * sizeof(double));
@@ -119,6 +134,12 @@ TACSMg::~TACSMg() {
     if (x[i]) {
       x[i]->decref();
     }
+    if (kcycle_b[i]) {
+      kcycle_b[i]->decref();
+      kcycle_c[i]->decref();
+      kcycle_v[i]->decref();
+      kcycle_w[i]->decref();
+    }
   }
 
   for (int i = 0; i < nlevels - 1; i++) {
@@ -142,6 +163,10 @@ TACSMg::~TACSMg() {
   if (root_pc) {
     root_pc->decref();
   }
+  if (coarse_base) {
+    coarse_base->decref();
+    coarse_shift->decref();
+  }
 
   delete[] assembler;
   delete[] mat;
@@ -149,6 +174,10 @@ TACSMg::~TACSMg() {
   delete[] x;
   delete[] r;
   delete[] b;
+  delete[] kcycle_b;
+  delete[] kcycle_c;
+  delete[] kcycle_v;
+  delete[] kcycle_w;
   delete[] interp;
   delete[] pc;
   delete[] cumulative_level_time;
@@ -218,8 +247,10 @@ void TACSMg::setLevel(int level, TACSAssembler *_assembler,
         mat[level]->incref();
 
         int zero_guess = 0;
-        pc[level] = new TACSGaussSeidel(pmat, zero_guess, sor_omega, sor_iters,
-                                        sor_symmetric);
+        TACSGaussSeidel *gs = new TACSGaussSeidel(
+            pmat, zero_guess, sor_omega, sor_iters, sor_symmetric);
+        gs->setMultiColor(sor_multicolor);
+        pc[level] = gs;
         pc[level]->incref();
       } else {
         TACSParallelMat *fine_mat =
@@ -233,8 +264,10 @@ void TACSMg::setLevel(int level, TACSAssembler *_assembler,
           mat[level]->incref();
 
           int zero_guess = 0;
-          pc[level] = new TACSGaussSeidel(coarse_mat, zero_guess, sor_omega,
-                                          sor_iters, sor_symmetric);
+          TACSGaussSeidel *gs = new TACSGaussSeidel(
+              coarse_mat, zero_guess, sor_omega, sor_iters, sor_symmetric);
+          gs->setMultiColor(sor_multicolor);
+          pc[level] = gs;
           pc[level]->incref();
 
           // This matrix is computed using Galerkin projection
@@ -263,8 +296,10 @@ void TACSMg::setLevel(int level, TACSAssembler *_assembler,
 
         // Do not zero the initial guess for the PSOR object
         int zero_guess = 0;
-        pc[level] = new TACSGaussSeidel(pmat, zero_guess, sor_omega, sor_iters,
-                                        sor_symmetric);
+        TACSGaussSeidel *gs = new TACSGaussSeidel(
+            pmat, zero_guess, sor_omega, sor_iters, sor_symmetric);
+        gs->setMultiColor(sor_multicolor);
+        pc[level] = gs;
         pc[level]->incref();
       }
     }
@@ -280,7 +315,9 @@ void TACSMg::setLevel(int level, TACSAssembler *_assembler,
         root_mat = coarse_mat;
         root_mat->incref();
 
-        root_pc = new TACSBlockCyclicPc(coarse_mat);
+        int blocks_per_block = 4, reorder_blocks = 1;
+        root_pc = new TACSBlockCyclicPc(coarse_mat, blocks_per_block,
+                                        reorder_blocks, coarse_ranks);
         root_pc->incref();
 
         // Use Galerkin projection to create the coarsest problem
@@ -392,6 +429,8 @@ void TACSMg::factor() {
 */
 void TACSMg::assembleJacobian(double alpha, double beta, double gamma,
                               TACSBVec *res, MatrixOrientation matOr) {
+  coarse_shift_valid = 0;
+
   // Assemble the matrices
   if (assembler[0]) {
     TACSMatrixFreeMat *mat_free = dynamic_cast<TACSMatrixFreeMat *>(mat[0]);
@@ -447,6 +486,8 @@ void TACSMg::assembleJacobian(double alpha, double beta, double gamma,
 */
 void TACSMg::assembleMatType(ElementMatrixType matType,
                              MatrixOrientation matOr) {
+  coarse_shift_valid = 0;
+
   if (assembler[0]) {
     TACSMatrixFreeMat *mat_free = dynamic_cast<TACSMatrixFreeMat *>(mat[0]);
     if (mat_free) {
@@ -502,6 +543,8 @@ void TACSMg::assembleMatType(ElementMatrixType matType,
 */
 void TACSMg::assembleMatCombo(ElementMatrixType matTypes[], TacsScalar scale[],
                               int nmats, MatrixOrientation matOr) {
+  coarse_shift_valid = 0;
+
   if (assembler[0]) {
     assembler[0]->assembleMatCombo(matTypes, scale, nmats, mat[0], matOr);
   }
@@ -544,6 +587,7 @@ void TACSMg::assembleMatCombo(ElementMatrixType matTypes[], TacsScalar scale[],
 */
 int TACSMg::assembleGalerkinMat() {
   int fail = 0;
+  coarse_shift_valid = 0;
 
   // Compute the number
   for (int i = 1; i < nlevels - 1; i++) {
@@ -637,6 +681,124 @@ void TACSMg::setMonitor(KSMPrint *_monitor) {
   monitor = _monitor;
 }
 
+/**
+  Set the type of cycle used to compute the coarse-level corrections
+
+  @param cycle_type The type of multigrid cycle
+*/
+void TACSMg::setCycleType(MgCycleType _cycle_type) {
+  cycle_type = _cycle_type;
+}
+
+/**
+  Set whether the default Gauss-Seidel smoothers use multicolor sweeps
+
+  The rows of each color are relaxed concurrently by the threads of
+  the matrix (see TACSGaussSeidel::setMultiColor()). The flag applies
+  to the Gauss-Seidel smoothers already set on each level and to those
+  created afterwards by setLevel(). The coloring is computed when the
+  smoother is factored.
+
+  @param flag Flag indicating whether to use multicolor sweeps
+*/
+void TACSMg::setMultiColorSmoother(int flag) {
+  sor_multicolor = flag;
+  for (int level = 0; level < nlevels - 1; level++) {
+    TACSGaussSeidel *gs = dynamic_cast<TACSGaussSeidel *>(pc[level]);
+    if (gs) {
+      gs->setMultiColor(flag);
+    }
+  }
+}
+
+/**
+  Set the number of ranks used for the direct solve on the coarsest
+  level.
+
+  This only applies when the coarsest level is formed with Galerkin
+  projection. The coarse matrix is agglomerated onto the given number
+  of ranks and factored on a sub-communicator. A value less than one
+  uses all the ranks. If the coarsest level has already been set, the
+  coarse solver is re-created and must be factored again.
+
+  @param coarse_ranks The number of ranks for the coarse-level solve
+*/
+void TACSMg::setCoarseRanks(int _coarse_ranks) {
+  coarse_ranks = _coarse_ranks;
+
+  if (use_galerkin[nlevels - 1] && root_mat) {
+    TACSParallelMat *coarse_mat = dynamic_cast<TACSParallelMat *>(root_mat);
+    if (coarse_mat) {
+      int blocks_per_block = 4, reorder_blocks = 1;
+      TACSPc *_pc = new TACSBlockCyclicPc(coarse_mat, blocks_per_block,
+                                          reorder_blocks, coarse_ranks);
+      _pc->incref();
+      if (root_pc) {
+        root_pc->decref();
+      }
+      root_pc = _pc;
+    }
+  }
+}
+
+/**
+  Shift the operator on the coarsest level and refactor the coarse
+  solver.
+
+  The coarse matrix is set to A - sigma*S, where A is the coarse
+  matrix from the last call to one of the assembly functions and S is
+  the matrix of the given type assembled on the coarsest level. The
+  smoothers on the finer levels are not modified, so this is an
+  inexpensive update when the shift of the preconditioned operator
+  changes by a small amount. The unshifted coarse matrix is stored on
+  the first call after each assembly.
+
+  This is not available when the coarsest level is formed with Galerkin
+  projection, or when the coarse matrix was provided by the user and
+  cannot be duplicated.
+
+  @param sigma The shift applied to the coarse matrix
+  @param shiftType The type of matrix that is shifted
+  @return Fail flag, non-zero when the shift cannot be applied
+*/
+int TACSMg::setCoarseShift(double sigma, ElementMatrixType shiftType) {
+  if (use_galerkin[nlevels - 1] || !root_mat || !root_pc ||
+      !assembler[nlevels - 1]) {
+    return 1;
+  }
+
+  // Create the matrices for the unshifted coarse matrix and the shift
+  if (!coarse_base) {
+    if (dynamic_cast<TACSSchurMat *>(root_mat)) {
+      coarse_base = assembler[nlevels - 1]->createSchurMat();
+      coarse_shift = assembler[nlevels - 1]->createSchurMat();
+    } else if (dynamic_cast<TACSParallelMat *>(root_mat)) {
+      coarse_base = root_mat->createDuplicate();
+      coarse_shift = root_mat->createDuplicate();
+    } else {
+      return 1;
+    }
+    coarse_base->incref();
+    coarse_shift->incref();
+  }
+
+  // Store the unshifted matrix and assemble the shift matrix
+  if (!coarse_shift_valid) {
+    coarse_base->copyValues(root_mat);
+    assembler[nlevels - 1]->assembleMatType(shiftType, coarse_shift);
+    coarse_shift_valid = 1;
+  }
+
+  root_mat->copyValues(coarse_base);
+  if (sigma != 0.0) {
+    root_mat->axpy(-sigma, coarse_shift);
+  }
+  assembler[nlevels - 1]->applyBCs(root_mat);
+  root_pc->factor();
+
+  return 0;
+}
+
 /**
   Repeatedly apply the multi-grid method until the problem is solved
 */
@@ -648,7 +810,7 @@ void TACSMg::solve(TACSBVec *bvec, TACSBVec *xvec, int max_iters, double rtol,
   // Compute the initial residual and multiply
   TacsScalar rhs_norm = 0.0;
   for (int i = 0; i < max_iters; i++) {
-    applyMg(0);
+    applyMg(0, cycle_type);
     TacsScalar norm = r[0]->norm();
     if (monitor) {
       monitor->printResidual(i, norm);
@@ -688,7 +850,7 @@ void TACSMg::applyFactor(TACSVec *bvec, TACSVec *xvec) {
     if (monitor) {
       memset(cumulative_level_time, 0, nlevels * sizeof(double));
     }
-    applyMg(0);
+    applyMg(0, cycle_type);
     if (monitor) {
       for (int k = 0; k < nlevels; k++) {
         char descript[128];
@@ -714,8 +876,9 @@ void TACSMg::applyFactor(TACSVec *bvec, TACSVec *xvec) {
   post-smoothing.
 
   @param level Apply a cycle of multigrid at this level
+  @param cycle The type of cycle used for the coarse-level corrections
 */
-void TACSMg::applyMg(int level) {
+void TACSMg::applyMg(int level, MgCycleType cycle) {
   // If we've made it to the lowest level, apply the direct solver
   // otherwise, perform multigrid on the next-lowest level
   if (level == nlevels - 1) {
@@ -749,7 +912,7 @@ void TACSMg::applyMg(int level) {
     b[level + 1]->applyBCs(assembler[level + 1]->getBcMap());
     x[level + 1]->zeroEntries();
 
-    applyMg(level + 1);
+    applyCoarseCorrection(level + 1, cycle);
 
     // Interpolate back from the next lowest level
     interp[level]->multAdd(x[level + 1], x[level], x[level]);
@@ -763,3 +926,99 @@ void TACSMg::applyMg(int level) {
     cumulative_level_time[level] += MPI_Wtime() - t1;
   }
 }
+
+/*
+  Compute the correction x[level] from the right-hand-side b[level]
+  using the given type of cycle. On entry, x[level] is zero.
+*/
+void TACSMg::applyCoarseCorrection(int level, MgCycleType cycle) {
+  if (level == nlevels - 1 || cycle == V_CYCLE) {
+    applyMg(level, cycle);
+  } else if (cycle == W_CYCLE) {
+    applyMg(level, W_CYCLE);
+    applyMg(level, W_CYCLE);
+  } else if (cycle == F_CYCLE) {
+    applyMg(level, F_CYCLE);
+    applyMg(level, V_CYCLE);
+  } else {
+    applyKCycle(level);
+  }
+}
+
+/*
+  Apply two iterations of flexible conjugate gradient to the system on
+  the given level, preconditioned by a K-cycle on that level.
+
+  The second iteration is skipped if the first one reduces the
+  residual norm by a factor of four. On entry, x[level] is zero and
+  on exit, it contains the approximate solution. The right-hand-side
+  b[level] is unchanged.
+*/
+void TACSMg::applyKCycle(int level) {
+  const double kcycle_tol = 0.25;
+
+  if (!kcycle_b[level]) {
+    kcycle_b[level] = assembler[level]->createVec();
+    kcycle_c[level] = assembler[level]->createVec();
+    kcycle_v[level] = assembler[level]->createVec();
+    kcycle_w[level] = assembler[level]->createVec();
+    kcycle_b[level]->incref();
+    kcycle_c[level]->incref();
+    kcycle_v[level]->incref();
+    kcycle_w[level]->incref();
+  }
+  TACSBVec *bk = kcycle_b[level];
+  TACSBVec *c = kcycle_c[level];
+  TACSBVec *v = kcycle_v[level];
+  TACSBVec *w = kcycle_w[level];
+
+  // Save the right-hand-side, since b[level] is overwritten with the
+  // residual after the first iteration
+  bk->copyValues(b[level]);
+
+  // Compute the first search direction c = B*b and v = A*c
+  applyMg(level, K_CYCLE);
+  c->copyValues(x[level]);
+  mat[level]->mult(c, v);
+
+  TacsScalar rho1 = c->dot(v);
+  TacsScalar alpha1 = c->dot(bk);
+  if (TacsRealPart(rho1) <= 0.0) {
+    // The operator is not positive definite along c, so use the
+    // cycle without acceleration
+    return;
+  }
+
+  // Compute the residual after the first iteration
+  TacsScalar bnorm = bk->norm();
+  b[level]->copyValues(bk);
+  b[level]->axpy(-alpha1 / rho1, v);
+  TacsScalar rnorm = b[level]->norm();
+
+  if (TacsRealPart(rnorm) <= kcycle_tol * TacsRealPart(bnorm)) {
+    x[level]->copyValues(c);
+    x[level]->scale(alpha1 / rho1);
+  } else {
+    // Compute the second search direction d = B*r and w = A*d
+    x[level]->zeroEntries();
+    applyMg(level, K_CYCLE);
+    mat[level]->mult(x[level], w);
+
+    TacsScalar gamma = x[level]->dot(v);
+    TacsScalar beta = x[level]->dot(w);
+    TacsScalar alpha2 = x[level]->dot(b[level]);
+    TacsScalar rho2 = beta - gamma * gamma / rho1;
+
+    if (TacsRealPart(rho2) <= 0.0) {
+      x[level]->copyValues(c);
+      x[level]->scale(alpha1 / rho1);
+    } else {
+      // x = (alpha2/rho2)*d + (alpha1/rho1 - gamma*alpha2/(rho1*rho2))*c
+      x[level]->scale(alpha2 / rho2);
+      x[level]->axpy(alpha1 / rho1 - gamma * alpha2 / (rho1 * rho2), c);
+    }
+  }
+
+  // Restore the right-hand-side
+  b[level]->copyValues(bk);
+}
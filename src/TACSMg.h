@@ -52,10 +52,33 @@
   in TACS. This solver has good parallel scalability, but poor
   scalability with the numbers of degrees of freedom in the
   model. This should be considered when deciding on the number of
-  levels of multi-grid to use.
+  levels of multi-grid to use. When the coarsest level is formed by
+  Galerkin projection, the direct solve can be agglomerated onto a
+  subset of the ranks with setCoarseRanks(). This reduces the latency
+  of the coarse solve when the coarse problem is small relative to the
+  number of ranks.
+
+  When the multigrid method preconditions a shifted operator such as
+  K - sigma*M whose shift changes frequently, setCoarseShift() applies
+  the shift to the coarsest level only and refactors the coarse
+  solver, leaving the smoothers on the finer levels unchanged.
+
+  The coarse-level correction on each level is computed with one of
+  the following cycles, set with setCycleType():
+
+  V_CYCLE: A single cycle on the next coarsest level (default)
+  W_CYCLE: Two cycles on the next coarsest level
+  F_CYCLE: An F-cycle followed by a V-cycle on the next coarsest level
+  K_CYCLE: Two iterations of flexible conjugate gradient on the next
+  coarsest level, preconditioned with a K-cycle. The second iteration
+  is skipped when the first reduces the residual by a factor of four.
+  The K-cycle is only suitable for symmetric positive definite
+  problems.
 */
 class TACSMg : public TACSPc {
  public:
+  enum MgCycleType { V_CYCLE, W_CYCLE, F_CYCLE, K_CYCLE };
+
   TACSMg(MPI_Comm comm, int _nlevels, double _sor_omega = 1.0,
          int _sor_iters = 1, int _sor_symmetric = 0);
   ~TACSMg();
@@ -104,9 +127,27 @@ class TACSMg : public TACSPc {
   // --------------------------------
   void setMonitor(KSMPrint *_monitor);
 
+  // Set the type of cycle and the coarse-level solver
+  // -------------------------------------------------
+  void setCycleType(MgCycleType _cycle_type);
+  void setCoarseRanks(int _coarse_ranks);
+
+  // Shift the operator on the coarsest level only
+  // ---------------------------------------------
+  int setCoarseShift(double sigma,
+                     ElementMatrixType shiftType = TACS_MASS_MATRIX);
+
+  // Use multicolor sweeps in the default Gauss-Seidel smoothers
+  // -----------------------------------------------------------
+  void setMultiColorSmoother(int flag);
+
  private:
   // Recursive function to apply multi-grid at each level
-  void applyMg(int level);
+  void applyMg(int level, MgCycleType cycle);
+
+  // Compute the correction on the given coarse level
+  void applyCoarseCorrection(int level, MgCycleType cycle);
+  void applyKCycle(int level);
 
   // The MPI communicator for this object
   MPI_Comm comm;
@@ -116,8 +157,15 @@ class TACSMg : public TACSPc {
 
   // The SOR data
   int sor_iters, sor_symmetric;
+  int sor_multicolor;
   double sor_omega;
 
+  // The type of cycle
+  MgCycleType cycle_type;
+
+  // The number of ranks used for the Galerkin coarse-level solve
+  int coarse_ranks;
+
   // Flag to indicate whether to form the coarse grid operators
   // via Galerkin projection coarse = P^{T}*A*P
   int *use_galerkin;
@@ -132,6 +180,9 @@ class TACSMg : public TACSPc {
   // The solution, right-hand-side and residual on each level
   TACSBVec **x, **b, **r;
 
+  // The vectors for the K-cycle on each level
+  TACSBVec **kcycle_b, **kcycle_c, **kcycle_v, **kcycle_w;
+
   // The interpolation operators
   TACSBVecInterp **interp;
 
@@ -143,6 +194,10 @@ class TACSMg : public TACSPc {
   TACSPc *root_pc;    // The root direct solver
   TACSMat **mat;      // The matrices associated with each level
   TACSPc **pc;        // The smoothers for all but the lowest level
+
+  // The unshifted coarse matrix and the coarse shift matrix
+  int coarse_shift_valid;
+  TACSMat *coarse_base, *coarse_shift;
 };
 
 #endif  // TACS_MG_H
@@ -18,6 +18,8 @@
 
 #include "TACSObject.h"
 
+#include <sys/mman.h>
+
 /*
   Implementation of the reference counting TACSObject as well as
   initialization of MPI data for complex arithmetic
@@ -146,6 +148,61 @@ TACSThreadInfo::TACSThreadInfo(int _num_threads) {
   } else {
     num_threads = 1;
   }
+  if (num_threads > TACS_MAX_NUM_THREADS) {
+    num_threads = TACS_MAX_NUM_THREADS;
+  }
+
+  // The workers are only created when they are first needed
+  num_workers = 0;
+  pthread_mutex_init(&pool_mutex, NULL);
+  pthread_cond_init(&work_cond, NULL);
+  pthread_cond_init(&done_cond, NULL);
+  pthread_cond_init(&task_cond, NULL);
+  job_active = 0;
+  job_count = 0;
+  job_threads = 0;
+  job_remaining = 0;
+  shutdown = 0;
+
+  job_type = PTHREAD_JOB;
+  pthread_func = NULL;
+  pthread_arg = NULL;
+
+  range_func = NULL;
+  range_size = range_chunk = range_next = 0;
+
+  task_func = NULL;
+  num_tasks = num_completed_tasks = num_running_tasks = 0;
+  task_dep_count = NULL;
+  task_next_ptr = NULL;
+  task_next = NULL;
+  task_queue = NULL;
+  task_queue_head = task_queue_tail = 0;
+
+  job_ctx = NULL;
+
+  // Use the default memory allocation
+  first_touch = 0;
+  huge_pages = 0;
+}
+
+/*
+  Shut down the worker threads and free the synchronization data
+*/
+TACSThreadInfo::~TACSThreadInfo() {
+  pthread_mutex_lock(&pool_mutex);
+  shutdown = 1;
+  pthread_cond_broadcast(&work_cond);
+  pthread_mutex_unlock(&pool_mutex);
+
+  for (int k = 0; k < num_workers; k++) {
+    pthread_join(workers[k], NULL);
+  }
+
+  pthread_mutex_destroy(&pool_mutex);
+  pthread_cond_destroy(&work_cond);
+  pthread_cond_destroy(&done_cond);
+  pthread_cond_destroy(&task_cond);
 }
 
 void TACSThreadInfo::setNumThreads(int _num_threads) {
@@ -159,3 +216,527 @@ void TACSThreadInfo::setNumThreads(int _num_threads) {
 }
 
 int TACSThreadInfo::getNumThreads() { return num_threads; }
+
+/*
+  The index of the calling thread within the job that it is executing.
+  Threads outside of a job, including the calling thread, are thread 0.
+*/
+static thread_local int tacs_thread_index = 0;
+
+int TACSThreadInfo::getThreadIndex() { return tacs_thread_index; }
+
+/*
+  Set the memory allocation policy for the arrays allocated with
+  TacsAllocScalarArray()
+
+  @param _first_touch Zero the arrays in parallel on the pool threads
+  @param _huge_pages Align large arrays to huge page boundaries
+*/
+void TACSThreadInfo::setMemoryPolicy(int _first_touch, int _huge_pages) {
+  first_touch = _first_touch;
+  huge_pages = _huge_pages;
+}
+
+int TACSThreadInfo::getFirstTouch() { return first_touch; }
+
+int TACSThreadInfo::getHugePages() { return huge_pages; }
+
+/*
+  Make sure that at least nworkers threads exist in the pool.
+
+  Workers are never destroyed when the number of threads is reduced,
+  they simply sit idle until the object is deleted. This must be
+  called with the pool mutex held.
+*/
+void TACSThreadInfo::startWorkers(int nworkers) {
+  if (nworkers > TACS_MAX_NUM_THREADS - 1) {
+    nworkers = TACS_MAX_NUM_THREADS - 1;
+  }
+
+  if (nworkers > num_workers) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    for (int k = num_workers; k < nworkers; k++) {
+      // The worker threads are numbered starting from 1 since the
+      // calling thread is always thread 0
+      worker_data[k].info = this;
+      worker_data[k].thread_id = k + 1;
+      pthread_create(&workers[k], &attr, TACSThreadInfo::workerThread,
+                     (void *)&worker_data[k]);
+    }
+    num_workers = nworkers;
+
+    pthread_attr_destroy(&attr);
+  }
+}
+
+/*
+  The loop executed by each worker thread in the pool
+*/
+void *TACSThreadInfo::workerThread(void *t) {
+  WorkerData *wdata = static_cast<WorkerData *>(t);
+  TACSThreadInfo *info = wdata->info;
+  const int thread_id = wdata->thread_id;
+
+  int last_job = 0;
+  pthread_mutex_lock(&info->pool_mutex);
+  while (1) {
+    // Wait until a new job is posted or the pool is shut down
+    while (!info->shutdown && info->job_count == last_job) {
+      pthread_cond_wait(&info->work_cond, &info->pool_mutex);
+    }
+    if (info->shutdown) {
+      break;
+    }
+    last_job = info->job_count;
+
+    if (thread_id < info->job_threads) {
+      pthread_mutex_unlock(&info->pool_mutex);
+      info->executeJob(thread_id);
+      pthread_mutex_lock(&info->pool_mutex);
+
+      info->job_remaining--;
+      if (info->job_remaining == 0) {
+        pthread_cond_signal(&info->done_cond);
+      }
+    }
+  }
+  pthread_mutex_unlock(&info->pool_mutex);
+
+  return NULL;
+}
+
+/*
+  Post the current job to the workers, participate as thread 0 and
+  wait for all the workers to complete.
+
+  The job data must be set before calling this function. This must be
+  called with the pool mutex held, and returns with it released.
+*/
+void TACSThreadInfo::runJob(int nthreads) {
+  startWorkers(nthreads - 1);
+  if (nthreads > num_workers + 1) {
+    nthreads = num_workers + 1;
+  }
+
+  job_threads = nthreads;
+  job_remaining = nthreads - 1;
+  job_count++;
+  pthread_cond_broadcast(&work_cond);
+  pthread_mutex_unlock(&pool_mutex);
+
+  executeJob(0);
+
+  pthread_mutex_lock(&pool_mutex);
+  while (job_remaining > 0) {
+    pthread_cond_wait(&done_cond, &pool_mutex);
+  }
+  job_active = 0;
+  pthread_mutex_unlock(&pool_mutex);
+}
+
+/*
+  Execute the current job on the given thread
+*/
+void TACSThreadInfo::executeJob(int thread_id) {
+  tacs_thread_index = thread_id;
+  if (job_type == PTHREAD_JOB) {
+    pthread_func(pthread_arg);
+  } else if (job_type == RANGE_JOB) {
+    executeRangeJob(thread_id);
+  } else if (job_type == TASK_GRAPH_JOB) {
+    executeTaskGraphJob(thread_id);
+  }
+  tacs_thread_index = 0;
+}
+
+/*
+  Run the same function on each of the threads and wait for all of
+  them to complete.
+
+  The function is responsible for distributing the work between the
+  threads. This is the replacement for the pthread_create/pthread_join
+  pattern, so the function must return normally rather than calling
+  pthread_exit().
+
+  @param func The function to execute on each thread
+  @param arg The argument passed to the function
+*/
+void TACSThreadInfo::runThreads(void *(*func)(void *), void *arg) {
+  pthread_mutex_lock(&pool_mutex);
+  if (job_active || num_threads <= 1) {
+    // Nested or serial call: Execute the work on this thread
+    pthread_mutex_unlock(&pool_mutex);
+    func(arg);
+    return;
+  }
+
+  job_active = 1;
+  job_type = PTHREAD_JOB;
+  pthread_func = func;
+  pthread_arg = arg;
+
+  runJob(num_threads);
+}
+
+/*
+  Execute a parallel loop over the indices [0, n).
+
+  Each thread repeatedly takes the next chunk of chunk_size indices
+  until the range is exhausted. The function is called with the range
+  [start, end) and the index of the thread executing it, which is in
+  the range [0, getNumThreads()) and can be used to index per-thread
+  data.
+
+  @param n The number of indices in the range
+  @param chunk_size The number of indices assigned at a time
+  @param func The function to call for each chunk
+  @param ctx The context pointer passed to the function
+*/
+void TACSThreadInfo::parallelFor(int n, int chunk_size,
+                                 TACSThreadRangeFunc func, void *ctx) {
+  if (n <= 0) {
+    return;
+  }
+  if (chunk_size < 1) {
+    chunk_size = 1;
+  }
+
+  pthread_mutex_lock(&pool_mutex);
+  if (job_active || num_threads <= 1 || n <= chunk_size) {
+    pthread_mutex_unlock(&pool_mutex);
+    func(0, n, 0, ctx);
+    return;
+  }
+
+  job_active = 1;
+  job_type = RANGE_JOB;
+  range_func = func;
+  range_size = n;
+  range_chunk = chunk_size;
+  range_next = 0;
+  job_ctx = ctx;
+
+  runJob(num_threads);
+}
+
+/*
+  Execute the chunks of the parallel loop on the given thread
+*/
+void TACSThreadInfo::executeRangeJob(int thread_id) {
+  while (1) {
+    pthread_mutex_lock(&pool_mutex);
+    int start = range_next;
+    range_next += range_chunk;
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (start >= range_size) {
+      break;
+    }
+    int end = start + range_chunk;
+    if (end > range_size) {
+      end = range_size;
+    }
+    range_func(start, end, thread_id, job_ctx);
+  }
+}
+
+/*
+  Execute a graph of dependent tasks.
+
+  Task i may only start after all of the tasks in
+  deps[dep_ptr[i]:dep_ptr[i+1]] have completed. Independent tasks are
+  executed concurrently. The graph must be acyclic.
+
+  @param ntasks The number of tasks
+  @param dep_ptr Pointer into the dependency array for each task
+  @param deps The dependencies of each task
+  @param func The function to call for each task
+  @param ctx The context pointer passed to the function
+*/
+void TACSThreadInfo::runTaskGraph(int ntasks, const int *dep_ptr,
+                                  const int *deps, TACSThreadTaskFunc func,
+                                  void *ctx) {
+  if (ntasks <= 0) {
+    return;
+  }
+
+  // Compute the number of dependencies for each task and the
+  // transpose of the dependency graph
+  int *dep_count = new int[ntasks];
+  int *next_ptr = new int[ntasks + 1];
+  int *next = new int[dep_ptr[ntasks]];
+  int *queue = new int[ntasks];
+  memset(next_ptr, 0, (ntasks + 1) * sizeof(int));
+
+  for (int i = 0; i < ntasks; i++) {
+    dep_count[i] = dep_ptr[i + 1] - dep_ptr[i];
+    for (int jp = dep_ptr[i]; jp < dep_ptr[i + 1]; jp++) {
+      next_ptr[deps[jp] + 1]++;
+    }
+  }
+  for (int i = 0; i < ntasks; i++) {
+    next_ptr[i + 1] += next_ptr[i];
+  }
+  for (int i = 0; i < ntasks; i++) {
+    for (int jp = dep_ptr[i]; jp < dep_ptr[i + 1]; jp++) {
+      next[next_ptr[deps[jp]]] = i;
+      next_ptr[deps[jp]]++;
+    }
+  }
+  for (int i = ntasks; i > 0; i--) {
+    next_ptr[i] = next_ptr[i - 1];
+  }
+  next_ptr[0] = 0;
+
+  // Add the tasks without dependencies to the queue
+  int tail = 0;
+  for (int i = 0; i < ntasks; i++) {
+    if (dep_count[i] == 0) {
+      queue[tail] = i;
+      tail++;
+    }
+  }
+
+  pthread_mutex_lock(&pool_mutex);
+  if (job_active || num_threads <= 1) {
+    // Nested or serial call: Execute the tasks in order on this thread
+    pthread_mutex_unlock(&pool_mutex);
+
+    int head = 0;
+    for (; head < tail; head++) {
+      int task = queue[head];
+      func(task, 0, ctx);
+      for (int jp = next_ptr[task]; jp < next_ptr[task + 1]; jp++) {
+        dep_count[next[jp]]--;
+        if (dep_count[next[jp]] == 0) {
+          queue[tail] = next[jp];
+          tail++;
+        }
+      }
+    }
+    if (head < ntasks) {
+      fprintf(stderr,
+              "TACSThreadInfo: Task graph could not be completed, "
+              "check for cyclic dependencies\n");
+    }
+  } else {
+    job_active = 1;
+    job_type = TASK_GRAPH_JOB;
+    task_func = func;
+    num_tasks = ntasks;
+    num_completed_tasks = 0;
+    num_running_tasks = 0;
+    task_dep_count = dep_count;
+    task_next_ptr = next_ptr;
+    task_next = next;
+    task_queue = queue;
+    task_queue_head = 0;
+    task_queue_tail = tail;
+    job_ctx = ctx;
+
+    runJob(num_threads);
+
+    if (num_completed_tasks < ntasks) {
+      fprintf(stderr,
+              "TACSThreadInfo: Task graph could not be completed, "
+              "check for cyclic dependencies\n");
+    }
+    task_dep_count = task_next_ptr = task_next = task_queue = NULL;
+  }
+
+  delete[] dep_count;
+  delete[] next_ptr;
+  delete[] next;
+  delete[] queue;
+}
+
+/*
+  Execute tasks from the graph on the given thread until all tasks
+  are complete
+*/
+void TACSThreadInfo::executeTaskGraphJob(int thread_id) {
+  pthread_mutex_lock(&pool_mutex);
+  while (num_completed_tasks < num_tasks) {
+    if (task_queue_head < task_queue_tail) {
+      int task = task_queue[task_queue_head];
+      task_queue_head++;
+      num_running_tasks++;
+      pthread_mutex_unlock(&pool_mutex);
+
+      task_func(task, thread_id, job_ctx);
+
+      pthread_mutex_lock(&pool_mutex);
+      num_running_tasks--;
+      num_completed_tasks++;
+
+      // Release the tasks that depend on this task
+      for (int jp = task_next_ptr[task]; jp < task_next_ptr[task + 1]; jp++) {
+        int next = task_next[jp];
+        task_dep_count[next]--;
+        if (task_dep_count[next] == 0) {
+          task_queue[task_queue_tail] = next;
+          task_queue_tail++;
+        }
+      }
+      pthread_cond_broadcast(&task_cond);
+    } else if (num_running_tasks == 0) {
+      // No tasks are ready and none are running: The graph is cyclic
+      pthread_cond_broadcast(&task_cond);
+      break;
+    } else {
+      pthread_cond_wait(&task_cond, &pool_mutex);
+    }
+  }
+  pthread_mutex_unlock(&pool_mutex);
+}
+
+/*
+  Compute the partition of the rows into contiguous blocks for each
+  thread. The boundaries are distributed evenly between the groups of
+  rows.
+*/
+void TacsGetRowPartition(int nrows, int nparts, int group_size, int *ptr) {
+  if (group_size < 1) {
+    group_size = 1;
+  }
+  int ngroups = (nrows + group_size - 1) / group_size;
+  for (int k = 0; k <= nparts; k++) {
+    int row = group_size * (int)(((long)k * ngroups) / nparts);
+    ptr[k] = (row < nrows ? row : nrows);
+  }
+}
+
+// The size of the huge pages and the default array alignment
+static const size_t TACS_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t TACS_ARRAY_ALIGNMENT = 64;
+
+/*
+  The data needed to zero the rows of an array in parallel
+*/
+typedef struct {
+  TacsScalar *array;
+  size_t size;
+  const int *rowp;
+  int row_size;
+  int nparts;
+  const int *part;
+  int *touched;
+} TacsFirstTouchData;
+
+/*
+  Get the range of entries in the array for the given block of rows
+*/
+static void TacsGetFirstTouchRange(TacsFirstTouchData *data, int k,
+                                   size_t *start, size_t *end) {
+  int r0 = data->part[k], r1 = data->part[k + 1];
+  if (data->rowp) {
+    *start = (size_t)data->row_size * data->rowp[r0];
+    *end = (size_t)data->row_size * data->rowp[r1];
+  } else {
+    *start = (size_t)data->row_size * r0;
+    *end = (size_t)data->row_size * r1;
+  }
+  if (*end > data->size || k == data->nparts - 1) {
+    *end = data->size;
+  }
+  if (*start > *end) {
+    *start = *end;
+  }
+}
+
+/*
+  Zero the block of rows owned by the calling thread
+*/
+static void *TacsFirstTouchThread(void *t) {
+  TacsFirstTouchData *data = static_cast<TacsFirstTouchData *>(t);
+  int k = TACSThreadInfo::getThreadIndex();
+  if (k < data->nparts) {
+    size_t start, end;
+    TacsGetFirstTouchRange(data, k, &start, &end);
+    memset(&data->array[start], 0, (end - start) * sizeof(TacsScalar));
+    data->touched[k] = 1;
+  }
+
+  return NULL;
+}
+
+/*
+  Allocate a zeroed TacsScalar array using the memory policy.
+
+  The array is always allocated with posix_memalign so that it can be
+  freed in the same way regardless of the policy in effect.
+*/
+TacsScalar *TacsAllocScalarArray(size_t size, TACSThreadInfo *info, int nrows,
+                                 const int *rowp, int row_size,
+                                 int group_size) {
+  size_t bytes = size * sizeof(TacsScalar);
+  size_t alignment = TACS_ARRAY_ALIGNMENT;
+  if (info && info->getHugePages() && bytes >= TACS_HUGE_PAGE_SIZE) {
+    alignment = TACS_HUGE_PAGE_SIZE;
+  }
+  size_t alloc_bytes = alignment * ((bytes + alignment - 1) / alignment);
+  if (alloc_bytes == 0) {
+    alloc_bytes = alignment;
+  }
+
+  void *ptr = NULL;
+  if (posix_memalign(&ptr, alignment, alloc_bytes) != 0) {
+    fprintf(stderr, "TacsAllocScalarArray: Failed to allocate %zu bytes\n",
+            alloc_bytes);
+    return NULL;
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (alignment == TACS_HUGE_PAGE_SIZE) {
+    madvise(ptr, alloc_bytes, MADV_HUGEPAGE);
+  }
+#endif  // MADV_HUGEPAGE
+
+  TacsScalar *array = static_cast<TacsScalar *>(ptr);
+  int nparts = (info ? info->getNumThreads() : 1);
+  if (info && info->getFirstTouch() && nparts > 1 && nrows > 0) {
+    int *part = new int[nparts + 1];
+    int *touched = new int[nparts];
+    TacsGetRowPartition(nrows, nparts, group_size, part);
+    memset(touched, 0, nparts * sizeof(int));
+
+    TacsFirstTouchData data;
+    data.array = array;
+    data.size = size;
+    data.rowp = rowp;
+    data.row_size = row_size;
+    data.nparts = nparts;
+    data.part = part;
+    data.touched = touched;
+    info->runThreads(TacsFirstTouchThread, (void *)&data);
+
+    // Zero any blocks that were not touched. This occurs when the
+    // allocation is made from within a running job.
+    for (int k = 0; k < nparts; k++) {
+      if (!touched[k]) {
+        size_t start, end;
+        TacsGetFirstTouchRange(&data, k, &start, &end);
+        memset(&array[start], 0, (end - start) * sizeof(TacsScalar));
+      }
+    }
+
+    delete[] part;
+    delete[] touched;
+  } else {
+    memset(array, 0, bytes);
+  }
+
+  return array;
+}
+
+/*
+  Free an array allocated with TacsAllocScalarArray()
+*/
+void TacsFreeScalarArray(TacsScalar *array) {
+  if (array) {
+    free(array);
+  }
+}
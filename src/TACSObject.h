@@ -31,12 +31,15 @@
   references are never stolen.
 */
 
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "TacsComplexStep.h"
 #include "mpi.h"
+#include "pthread.h"
 
 extern MPI_Op TACS_MPI_MIN;
 extern MPI_Op TACS_MPI_MAX;
@@ -58,6 +61,38 @@ typedef TacsComplex TacsScalar;
 typedef double TacsScalar;
 #endif
 
+/*
+  Define the integer type for global counts and offsets of the
+  unknowns. These exceed the range of int on large models well before
+  the global node numbers do, so the node numbers and all the local
+  indices, including the block CSR matrix data, remain int. Define
+  TACS_USE_32BIT_GLOBAL_INDEX to use int for the global counts as well.
+*/
+#ifdef TACS_USE_32BIT_GLOBAL_INDEX
+#define TACS_MPI_GLOBAL_INDEX MPI_INT
+typedef int TacsGlobalIndex;
+#else
+#define TACS_MPI_GLOBAL_INDEX MPI_INT64_T
+typedef int64_t TacsGlobalIndex;
+#endif
+
+/*
+  Mark the header-only element functions and constant tables that are
+  also compiled for the device when TACS is built with nvcc or hipcc
+  (see src/bpmat/TACSDevice.h). Both macros have no effect otherwise.
+*/
+#if defined(__CUDACC__) || defined(__HIPCC__)
+#define TACS_HOST_DEVICE __host__ __device__
+#else
+#define TACS_HOST_DEVICE
+#endif
+
+#if defined(__CUDA_ARCH__) || defined(__HIP_DEVICE_COMPILE__)
+#define TACS_DEVICE_CONST __device__ const
+#else
+#define TACS_DEVICE_CONST const
+#endif
+
 /*
   Define the macro to add flop counts. This does not work for threaded
   implementations. Don't use it in threaded code!
@@ -144,19 +179,165 @@ class TACSObject {
   This should only be allocated by the TACSAssembler object. The
   number of threads is volitile in the sense that it can change
   between subsequent calls.
+
+  The thread info object also owns a persistent pool of worker
+  threads that is shared by all objects that reference it (the
+  assembler, the matrices and the solvers). The workers are created
+  the first time that threaded work is submitted and are re-used for
+  all subsequent calls, so that no threads are created or joined
+  within an analysis. The calling thread always participates in the
+  computation as thread 0.
+
+  Work can be submitted in three forms:
+
+  1. runThreads(): Run the same function on every thread. This is
+  used by the code that performs its own scheduling.
+
+  2. parallelFor(): Split the range [0, n) into chunks that are
+  processed by the threads in the pool.
+
+  3. runTaskGraph(): Execute a set of tasks where each task may only
+  start once all of its dependencies have completed.
+
+  Work submitted from within a running job is executed directly by the
+  calling thread.
+
+  The thread info object also sets the memory policy used by the
+  objects that share the pool. With first-touch allocation, the large
+  arrays are zeroed in parallel using the row partition from
+  TacsGetRowPartition(). The pages of each partition then reside on
+  the NUMA domain of the thread that also performs the mat-vec products
+  for those rows. Huge-page allocation aligns the large arrays to 2 MB
+  boundaries and requests transparent huge pages for them.
 */
 class TACSThreadInfo : public TACSObject {
  public:
-  static const int TACS_MAX_NUM_THREADS = 16;
+  static const int TACS_MAX_NUM_THREADS = 64;
+
+  // Function executed on a range of indices [start, end)
+  typedef void (*TACSThreadRangeFunc)(int start, int end, int thread_id,
+                                      void *ctx);
+
+  // Function executed for a single task in a task graph
+  typedef void (*TACSThreadTaskFunc)(int task, int thread_id, void *ctx);
 
   TACSThreadInfo(int _num_threads);
-  ~TACSThreadInfo() {}
+  ~TACSThreadInfo();
 
   void setNumThreads(int _num_threads);
   int getNumThreads();
 
+  // Submit work to the thread pool and wait for it to complete
+  // ----------------------------------------------------------
+  void runThreads(void *(*func)(void *), void *arg);
+  void parallelFor(int n, int chunk_size, TACSThreadRangeFunc func,
+                   void *ctx);
+  void runTaskGraph(int num_tasks, const int *dep_ptr, const int *deps,
+                    TACSThreadTaskFunc func, void *ctx);
+
+  // Get the index of the calling thread within the current job
+  // ------------------------------------------------------------
+  static int getThreadIndex();
+
+  // Set the memory allocation policy for the large arrays
+  // -----------------------------------------------------
+  void setMemoryPolicy(int _first_touch, int _huge_pages);
+  int getFirstTouch();
+  int getHugePages();
+
  private:
+  // The types of jobs that can be executed by the pool
+  enum JobType { PTHREAD_JOB, RANGE_JOB, TASK_GRAPH_JOB };
+
+  // Start the workers and execute the current job
+  void startWorkers(int nworkers);
+  void runJob(int nthreads);
+  void executeJob(int thread_id);
+  void executeRangeJob(int thread_id);
+  void executeTaskGraphJob(int thread_id);
+  static void *workerThread(void *t);
+
+  // The number of threads requested for each computation
   int num_threads;
+
+  // The memory allocation policy
+  int first_touch, huge_pages;
+
+  // The worker threads and the data passed to each of them
+  int num_workers;
+  pthread_t workers[TACS_MAX_NUM_THREADS];
+  struct WorkerData {
+    TACSThreadInfo *info;
+    int thread_id;
+  } worker_data[TACS_MAX_NUM_THREADS];
+
+  // Synchronization data for the pool
+  pthread_mutex_t pool_mutex;
+  pthread_cond_t work_cond, done_cond, task_cond;
+  int job_active;      // Flag indicating whether a job is running
+  int job_count;       // Incremented each time a job is submitted
+  int job_threads;     // Number of threads participating in the job
+  int job_remaining;   // Number of workers yet to finish the job
+  int shutdown;        // Flag to terminate the workers
+
+  // Data for the current job
+  JobType job_type;
+  void *(*pthread_func)(void *);
+  void *pthread_arg;
+
+  // Data for the parallel-for jobs
+  TACSThreadRangeFunc range_func;
+  int range_size, range_chunk, range_next;
+
+  // Data for the task graph jobs
+  TACSThreadTaskFunc task_func;
+  int num_tasks, num_completed_tasks, num_running_tasks;
+  int *task_dep_count;  // Number of incomplete dependencies
+  int *task_next_ptr;   // Pointer into the list of dependent tasks
+  int *task_next;       // Tasks that depend on each task
+  int *task_queue;      // Queue of tasks ready for execution
+  int task_queue_head, task_queue_tail;
+
+  // Context pointer for the range and task graph jobs
+  void *job_ctx;
 };
 
+/**
+  Compute the partition of the rows into contiguous blocks for each
+  thread. The block boundaries are a multiple of group_size.
+
+  @param nrows The number of rows
+  @param nparts The number of blocks
+  @param group_size The size of the row groups
+  @param ptr The block boundaries, of length nparts+1
+*/
+void TacsGetRowPartition(int nrows, int nparts, int group_size, int *ptr);
+
+/**
+  Allocate a zeroed TacsScalar array using the memory policy from the
+  thread info object.
+
+  The array consists of nrows rows. When rowp is NULL, each row has
+  row_size entries, otherwise row i has row_size*(rowp[i+1] - rowp[i])
+  entries. With first-touch allocation, each thread zeros the rows in
+  its block from TacsGetRowPartition(). The array must be freed with
+  TacsFreeScalarArray().
+
+  @param size The number of entries in the array
+  @param info The thread info object (may be NULL)
+  @param nrows The number of rows
+  @param rowp The pointer to the start of each row (may be NULL)
+  @param row_size The number of entries per row (or per rowp entry)
+  @param group_size The size of the row groups for the partition
+  @return The allocated array
+*/
+TacsScalar *TacsAllocScalarArray(size_t size, TACSThreadInfo *info = NULL,
+                                 int nrows = 0, const int *rowp = NULL,
+                                 int row_size = 1, int group_size = 1);
+
+/**
+  Free an array allocated with TacsAllocScalarArray()
+*/
+void TacsFreeScalarArray(TacsScalar *array);
+
 #endif
@@ -0,0 +1,319 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSPanelLength.h"
+
+#include "TACSElementAlgebra.h"
+#include "TacsUtilities.h"
+
+/*
+  Create the panel length object. This is collective on the
+  communicator of the assembler.
+
+  input:
+  assembler:    the TACSAssembler object
+  num_panels:   the number of panels
+  panel_ptr:    pointer into the boundary nodes of each panel
+  panel_nodes:  the boundary nodes of each panel, in order around the loop
+  directions:   the direction in which to measure each length (3 values)
+*/
+TACSPanelLength::TACSPanelLength(TACSAssembler *_assembler, int _num_panels,
+                                 const int *_panel_ptr,
+                                 const int *_panel_nodes,
+                                 const TacsScalar *_directions) {
+  assembler = _assembler;
+  assembler->incref();
+
+  // Copy the panel definitions
+  num_panels = _num_panels;
+  panel_ptr = new int[num_panels + 1];
+  memcpy(panel_ptr, _panel_ptr, (num_panels + 1) * sizeof(int));
+  panel_nodes = new int[panel_ptr[num_panels]];
+  memcpy(panel_nodes, _panel_nodes, panel_ptr[num_panels] * sizeof(int));
+  directions = new TacsScalar[3 * num_panels];
+  memcpy(directions, _directions, 3 * num_panels * sizeof(TacsScalar));
+
+  // Split the panels between the processors
+  int rank, size;
+  MPI_Comm comm = assembler->getMPIComm();
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  panel_start = (rank * num_panels) / size;
+  panel_end = ((rank + 1) * num_panels) / size;
+
+  // Find the unique nodes required on this processor
+  int start = panel_ptr[panel_start];
+  int len = panel_ptr[panel_end] - start;
+  int *nodes = new int[len];
+  memcpy(nodes, &panel_nodes[start], len * sizeof(int));
+  int num_nodes = TacsUniqueSort(len, nodes);
+
+  // Find the index of each panel node in the gathered nodes
+  local_index = new int[len];
+  for (int i = 0; i < len; i++) {
+    int *item = TacsSearchArray(panel_nodes[start + i], num_nodes, nodes);
+    local_index[i] = item - nodes;
+  }
+
+  // Create the distribution object that gathers the nodes
+  TACSBVecIndices *indices = new TACSBVecIndices(&nodes, num_nodes);
+  dist = new TACSBVecDistribute(assembler->getNodeMap(), indices);
+  dist->incref();
+  ctx = dist->createCtx(3);
+  ctx->incref();
+  Xlocal = new TacsScalar[3 * num_nodes];
+}
+
+TACSPanelLength::~TACSPanelLength() {
+  assembler->decref();
+  dist->decref();
+  ctx->decref();
+  delete[] panel_ptr;
+  delete[] panel_nodes;
+  delete[] directions;
+  delete[] local_index;
+  delete[] Xlocal;
+}
+
+/*
+  Compute the length of a panel and, optionally, its derivative
+
+  The intersection of the line p + alpha*d with the edge s + beta*e,
+  where e = t - s, is found in the least-squares sense from the normal
+  equations. The length alpha*||d|| is only used when the intersection
+  lies within the edge and the length exceeds the squared residual of
+  the least-squares problem. The derivative is the derivative of the
+  length for the point and the edge that give the maximum.
+
+  input:
+  npts:   the number of points around the boundary
+  pts:    the points (3*npts values)
+  dir:    the direction in which to measure the length
+
+  output:
+  sens:   the derivative w.r.t. the points (3*npts values, may be NULL)
+
+  returns: the panel length
+*/
+TacsScalar TACSPanelLength::computeLength(int npts, const TacsScalar pts[],
+                                          const TacsScalar dir[],
+                                          TacsScalar sens[]) {
+  TacsScalar length = 0.0;
+  int max_point = -1, max_edge = -1;
+
+  TacsScalar dd = vec3Dot(dir, dir);
+  TacsScalar dnorm = sqrt(dd);
+
+  for (int p = 0; p < npts; p++) {
+    for (int s = 0; s < npts; s++) {
+      int t = (s + 1) % npts;
+      if (s == p || t == p) {
+        continue;
+      }
+
+      // Form the normal equations for the intersection
+      TacsScalar e[3], r[3];
+      for (int k = 0; k < 3; k++) {
+        e[k] = pts[3 * t + k] - pts[3 * s + k];
+        r[k] = pts[3 * s + k] - pts[3 * p + k];
+      }
+      TacsScalar de = vec3Dot(dir, e);
+      TacsScalar ee = vec3Dot(e, e);
+      TacsScalar det = dd * ee - de * de;
+      if (TacsRealPart(det) == 0.0) {
+        continue;
+      }
+
+      TacsScalar dr = vec3Dot(dir, r);
+      TacsScalar er = vec3Dot(e, r);
+      TacsScalar alpha = (ee * dr - de * er) / det;
+      TacsScalar beta = (de * dr - dd * er) / det;
+
+      if (TacsRealPart(beta) - 1e-12 <= 1.0 &&
+          TacsRealPart(beta) + 1e-12 >= 0.0) {
+        // Compute the squared residual of the least-squares problem
+        TacsScalar res = 0.0;
+        for (int k = 0; k < 3; k++) {
+          TacsScalar rk = alpha * dir[k] - beta * e[k] - r[k];
+          res += rk * rk;
+        }
+
+        TacsScalar new_length = alpha * dnorm;
+        if (TacsRealPart(alpha) < 0.0) {
+          new_length = -alpha * dnorm;
+        }
+        if (TacsRealPart(new_length) > TacsRealPart(length) &&
+            TacsRealPart(new_length) > TacsRealPart(res)) {
+          length = new_length;
+          max_point = p;
+          max_edge = s;
+        }
+      }
+    }
+  }
+
+  if (sens) {
+    memset(sens, 0, 3 * npts * sizeof(TacsScalar));
+    if (max_point >= 0) {
+      int p = max_point, s = max_edge, t = (s + 1) % npts;
+      TacsScalar e[3], r[3];
+      for (int k = 0; k < 3; k++) {
+        e[k] = pts[3 * t + k] - pts[3 * s + k];
+        r[k] = pts[3 * s + k] - pts[3 * p + k];
+      }
+      TacsScalar de = vec3Dot(dir, e);
+      TacsScalar ee = vec3Dot(e, e);
+      TacsScalar dr = vec3Dot(dir, r);
+      TacsScalar er = vec3Dot(e, r);
+      TacsScalar det = dd * ee - de * de;
+      TacsScalar alpha = (ee * dr - de * er) / det;
+
+      // length = |alpha|*||d|| with alpha = N/det, where
+      // N = (e.e)(d.r) - (d.e)(e.r) and det = (d.d)(e.e) - (d.e)^2
+      TacsScalar scale = (TacsRealPart(alpha) < 0.0 ? -dnorm : dnorm) / det;
+      for (int k = 0; k < 3; k++) {
+        TacsScalar dalpha_dr = ee * dir[k] - de * e[k];
+        TacsScalar dalpha_de = 2.0 * e[k] * dr - dir[k] * er - de * r[k] -
+                               alpha * (2.0 * dd * e[k] - 2.0 * de * dir[k]);
+
+        // r = s - p and e = t - s
+        sens[3 * p + k] -= scale * dalpha_dr;
+        sens[3 * s + k] += scale * (dalpha_dr - dalpha_de);
+        sens[3 * t + k] += scale * dalpha_de;
+      }
+    }
+  }
+
+  return length;
+}
+
+/*
+  Gather the node locations required for the panels on this processor
+*/
+void TACSPanelLength::gatherNodes(TACSBVec *X) {
+  TacsScalar *Xarray;
+  X->getArray(&Xarray);
+  dist->beginForward(ctx, Xarray, Xlocal);
+  dist->endForward(ctx, Xarray, Xlocal);
+}
+
+/*
+  The data used to evaluate the panels in parallel
+*/
+struct TACSPanelLengthArgs {
+  int start;
+  const int *ptr, *local_index;
+  const TacsScalar *Xlocal, *directions;
+  TacsScalar *lengths, *sens;
+  int max_size;
+};
+
+static void TacsPanelLengthRange(int start, int end, int thread_id,
+                                 void *ctx) {
+  TACSPanelLengthArgs *args = (TACSPanelLengthArgs *)ctx;
+  TacsScalar *pts = new TacsScalar[3 * args->max_size];
+  for (int i = start; i < end; i++) {
+    int panel = args->start + i;
+    int ptr = args->ptr[panel];
+    int npts = args->ptr[panel + 1] - ptr;
+
+    const int *index = &args->local_index[ptr - args->ptr[args->start]];
+    for (int j = 0; j < npts; j++) {
+      memcpy(&pts[3 * j], &args->Xlocal[3 * index[j]], 3 * sizeof(TacsScalar));
+    }
+
+    TacsScalar *sens = NULL;
+    if (args->sens) {
+      sens = &args->sens[3 * ptr];
+    }
+    args->lengths[panel] = TACSPanelLength::computeLength(
+        npts, pts, &args->directions[3 * panel], sens);
+  }
+  delete[] pts;
+}
+
+/*
+  Evaluate the panels on this processor on the threads, then share the
+  results with all processors
+*/
+void TACSPanelLength::evalPanels(TACSBVec *X, TacsScalar lengths[],
+                                 TacsScalar sens[]) {
+  gatherNodes(X);
+
+  memset(lengths, 0, num_panels * sizeof(TacsScalar));
+  if (sens) {
+    memset(sens, 0, 3 * panel_ptr[num_panels] * sizeof(TacsScalar));
+  }
+
+  TACSPanelLengthArgs args;
+  args.start = panel_start;
+  args.ptr = panel_ptr;
+  args.local_index = local_index;
+  args.Xlocal = Xlocal;
+  args.directions = directions;
+  args.lengths = lengths;
+  args.sens = sens;
+  args.max_size = 0;
+  for (int i = panel_start; i < panel_end; i++) {
+    if (panel_ptr[i + 1] - panel_ptr[i] > args.max_size) {
+      args.max_size = panel_ptr[i + 1] - panel_ptr[i];
+    }
+  }
+
+  TACSThreadInfo *thread_info = assembler->getThreadInfo();
+  thread_info->parallelFor(panel_end - panel_start, 16, TacsPanelLengthRange,
+                           &args);
+
+  // Each entry is computed by exactly one processor
+  MPI_Comm comm = assembler->getMPIComm();
+  MPI_Allreduce(MPI_IN_PLACE, lengths, num_panels, TACS_MPI_TYPE, MPI_SUM,
+                comm);
+  if (sens) {
+    MPI_Allreduce(MPI_IN_PLACE, sens, 3 * panel_ptr[num_panels], TACS_MPI_TYPE,
+                  MPI_SUM, comm);
+  }
+}
+
+/*
+  Evaluate the lengths of all the panels. This is collective.
+
+  input:
+  X:        the node locations
+
+  output:
+  lengths:  the length of each panel (on all processors)
+*/
+void TACSPanelLength::evalLengths(TACSBVec *X, TacsScalar lengths[]) {
+  evalPanels(X, lengths, NULL);
+}
+
+/*
+  Evaluate the lengths of all the panels and their derivatives w.r.t.
+  the boundary nodes of each panel. This is collective.
+
+  input:
+  X:        the node locations
+
+  output:
+  lengths:  the length of each panel (on all processors)
+  sens:     the derivatives in the order of the panel nodes (3 per node)
+*/
+void TACSPanelLength::evalLengthSens(TACSBVec *X, TacsScalar lengths[],
+                                     TacsScalar sens[]) {
+  evalPanels(X, lengths, sens);
+}
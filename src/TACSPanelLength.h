@@ -0,0 +1,97 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_PANEL_LENGTH_H
+#define TACS_PANEL_LENGTH_H
+
+#include "TACSAssembler.h"
+
+/*
+  Compute the lengths of panels from the node locations
+
+  Each panel is defined by the closed loop of nodes around its
+  boundary, in order, and a direction in which the length is measured.
+  The length is the longest chord of the boundary polygon in the given
+  direction: a line through each boundary point in the given direction
+  is intersected with each edge that is not adjacent to the point, and
+  the largest distance to an intersection within the bounds of an edge
+  is the length. This is approximate, and is intended for directions
+  close to the plane of the panel.
+
+  The panel definitions must be the same on all processors, and are
+  given in terms of the TACSAssembler node numbers. The panels are
+  split between the processors and the node locations needed for the
+  panels on each processor are gathered from the node vector with a
+  distribution object that is set up once. The lengths and their
+  derivatives are then computed on the threads and shared with all
+  processors.
+
+  The derivatives are returned in the order of the panel nodes, so that
+  they form the values of a sparse Jacobian with the row pointer
+  panel_ptr and the node numbers panel_nodes.
+*/
+class TACSPanelLength : public TACSObject {
+ public:
+  TACSPanelLength(TACSAssembler *_assembler, int _num_panels,
+                  const int *_panel_ptr, const int *_panel_nodes,
+                  const TacsScalar *_directions);
+  ~TACSPanelLength();
+
+  // Get the number of panels and the total number of panel nodes
+  // ------------------------------------------------------------
+  int getNumPanels() { return num_panels; }
+  int getNumPanelNodes() { return panel_ptr[num_panels]; }
+
+  // Evaluate the lengths and their derivatives w.r.t. the nodes
+  // -----------------------------------------------------------
+  void evalLengths(TACSBVec *X, TacsScalar lengths[]);
+  void evalLengthSens(TACSBVec *X, TacsScalar lengths[], TacsScalar sens[]);
+
+  // Compute the length of a single panel
+  // ------------------------------------
+  static TacsScalar computeLength(int npts, const TacsScalar pts[],
+                                  const TacsScalar dir[],
+                                  TacsScalar sens[] = NULL);
+
+ private:
+  // Gather the node locations for the panels on this processor
+  void gatherNodes(TACSBVec *X);
+
+  // Compute the lengths (and derivatives) and share them
+  void evalPanels(TACSBVec *X, TacsScalar lengths[], TacsScalar sens[]);
+
+  // The assembler object
+  TACSAssembler *assembler;
+
+  // The panel definitions
+  int num_panels;
+  int *panel_ptr, *panel_nodes;
+  TacsScalar *directions;
+
+  // The panels evaluated on this processor
+  int panel_start, panel_end;
+
+  // The index into the gathered nodes for each panel node on this
+  // processor, and the distribution object used to gather them
+  int *local_index;
+  TACSBVecDistribute *dist;
+  TACSBVecDistCtx *ctx;
+  TacsScalar *Xlocal;
+};
+
+#endif  // TACS_PANEL_LENGTH_H
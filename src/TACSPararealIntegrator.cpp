@@ -0,0 +1,303 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSPararealIntegrator.h"
+
+/*
+  Create the Parareal integrator
+
+  The assembler must be created on the spatial communicator of this
+  time slab, and the spatial communicators must partition comm into
+  contiguous groups of processors ordered by time slab, for instance
+  with createSlabComm().
+
+  @param _comm The communicator containing all the time slabs
+  @param _assembler The model on the spatial communicator of this slab
+  @param _tinit The initial time
+  @param _tfinal The final time
+  @param num_coarse_steps The number of coarse time steps in each slab
+  @param num_fine_steps The number of fine time steps in each slab
+  @param max_bdf_order The maximum order of the BDF propagators
+*/
+TACSPararealIntegrator::TACSPararealIntegrator(
+    MPI_Comm _comm, TACSAssembler *_assembler, double _tinit, double _tfinal,
+    int num_coarse_steps, int num_fine_steps, int max_bdf_order) {
+  comm = _comm;
+  assembler = _assembler;
+  assembler->incref();
+  tinit = _tinit;
+  tfinal = _tfinal;
+
+  // Processors with the same spatial rank form the time communicator
+  int rank, space_rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_rank(assembler->getMPIComm(), &space_rank);
+  MPI_Comm_split(comm, space_rank, rank, &time_comm);
+  MPI_Comm_rank(time_comm, &slab);
+  MPI_Comm_size(time_comm, &num_slabs);
+
+  // Create the propagators for this slab
+  double t0, t1;
+  getSlabInterval(&t0, &t1);
+  coarse = new TACSBDFIntegrator(assembler, t0, t1, num_coarse_steps,
+                                 max_bdf_order);
+  coarse->incref();
+  fine =
+      new TACSBDFIntegrator(assembler, t0, t1, num_fine_steps, max_bdf_order);
+  fine->incref();
+
+  for (int i = 0; i < 3; i++) {
+    init[i] = assembler->createVec();
+    init[i]->incref();
+    start[i] = assembler->createVec();
+    start[i]->incref();
+    coarse_end[i] = assembler->createVec();
+    coarse_end[i]->incref();
+    fine_end[i] = assembler->createVec();
+    fine_end[i]->incref();
+    temp[i] = assembler->createVec();
+    temp[i]->incref();
+    end[i] = assembler->createVec();
+    end[i]->incref();
+  }
+
+  tol = 1e-8;
+  max_iters = num_slabs;
+  num_iters = 0;
+  print_level = 0;
+}
+
+TACSPararealIntegrator::~TACSPararealIntegrator() {
+  MPI_Comm_free(&time_comm);
+  assembler->decref();
+  coarse->decref();
+  fine->decref();
+  for (int i = 0; i < 3; i++) {
+    init[i]->decref();
+    start[i]->decref();
+    coarse_end[i]->decref();
+    fine_end[i]->decref();
+    temp[i]->decref();
+    end[i]->decref();
+  }
+}
+
+/*
+  Split the processors into contiguous groups, one for each time slab
+
+  The number of processors must be a multiple of the number of slabs.
+  The returned communicator must be freed by the caller.
+
+  @param comm The communicator containing all processors
+  @param num_slabs The number of time slabs
+  @return The spatial communicator for the time slab of this processor
+*/
+MPI_Comm TACSPararealIntegrator::createSlabComm(MPI_Comm comm,
+                                                int num_slabs) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  if (num_slabs < 1 || num_slabs > size || size % num_slabs != 0) {
+    fprintf(stderr,
+            "TACSPararealIntegrator: Number of processors %d is not a "
+            "multiple of the number of slabs %d\n",
+            size, num_slabs);
+    num_slabs = 1;
+  }
+
+  MPI_Comm slab_comm;
+  MPI_Comm_split(comm, rank / (size / num_slabs), rank, &slab_comm);
+  return slab_comm;
+}
+
+/*
+  Get the time interval for the time slab on this processor
+*/
+void TACSPararealIntegrator::getSlabInterval(double *t0, double *t1) {
+  double dt = (tfinal - tinit) / num_slabs;
+  if (t0) {
+    *t0 = tinit + slab * dt;
+  }
+  if (t1) {
+    *t1 = (slab == num_slabs - 1 ? tfinal : tinit + (slab + 1) * dt);
+  }
+}
+
+/*
+  Get the states at the end of the time slab on this processor
+*/
+void TACSPararealIntegrator::getFinalStates(TACSBVec **q, TACSBVec **qdot,
+                                            TACSBVec **qddot) {
+  if (q) {
+    *q = end[0];
+  }
+  if (qdot) {
+    *qdot = end[1];
+  }
+  if (qddot) {
+    *qddot = end[2];
+  }
+}
+
+/*
+  Propagate the states over the time slab with the given integrator
+*/
+int TACSPararealIntegrator::propagate(TACSIntegrator *integ, TACSBVec *in[],
+                                      TACSBVec *out[]) {
+  assembler->setInitConditions(in[0], in[1], in[2]);
+  int fail = integ->integrate();
+
+  TACSBVec *q, *qdot, *qddot;
+  integ->getStates(integ->getNumTimeSteps(), &q, &qdot, &qddot);
+  out[0]->copyValues(q);
+  out[1]->copyValues(qdot);
+  out[2]->copyValues(qddot);
+
+  return fail;
+}
+
+/*
+  Send the states to the next time slab. The local arrays of each
+  vector match since the slabs have the same partition.
+*/
+void TACSPararealIntegrator::sendStates(TACSBVec *vecs[]) {
+  for (int i = 0; i < 3; i++) {
+    TacsScalar *x;
+    int size = vecs[i]->getArray(&x);
+    MPI_Send(x, size, TACS_MPI_TYPE, slab + 1, i, time_comm);
+  }
+}
+
+/*
+  Receive the states from the previous time slab
+*/
+void TACSPararealIntegrator::recvStates(TACSBVec *vecs[]) {
+  for (int i = 0; i < 3; i++) {
+    TacsScalar *x;
+    int size = vecs[i]->getArray(&x);
+    MPI_Recv(x, size, TACS_MPI_TYPE, slab - 1, i, time_comm,
+             MPI_STATUS_IGNORE);
+  }
+}
+
+/*
+  Solve for the time history with the Parareal iteration
+
+  The iteration stops when the relative change in the displacements and
+  velocities at the end of all slabs is less than the tolerance. The
+  fine integrator is finally re-run from the converged initial states,
+  so that it holds the time history of this slab.
+
+  @return 0 on success, non-zero if a propagator failed
+*/
+int TACSPararealIntegrator::solve() {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  double t0 = MPI_Wtime();
+
+  // Get the initial conditions of the problem
+  assembler->getInitConditions(init[0], init[1], init[2]);
+
+  // Perform the initial coarse sweep down the time slabs
+  if (slab == 0) {
+    for (int i = 0; i < 3; i++) {
+      start[i]->copyValues(init[i]);
+    }
+  } else {
+    recvStates(start);
+  }
+  int fail = propagate(coarse, start, coarse_end);
+  for (int i = 0; i < 3; i++) {
+    end[i]->copyValues(coarse_end[i]);
+  }
+  if (slab < num_slabs - 1) {
+    sendStates(end);
+  }
+
+  num_iters = 0;
+  for (int iter = 0; iter < max_iters; iter++) {
+    // Run the fine propagators concurrently. The initial states on this
+    // slab no longer change once iter > slab.
+    if (iter <= slab) {
+      fail = propagate(fine, start, fine_end) || fail;
+    }
+
+    // Apply the coarse correction down the time slabs
+    if (slab > 0) {
+      recvStates(start);
+    }
+    fail = propagate(coarse, start, temp) || fail;
+
+    // Compute U = G_new + F - G_old and the change in U
+    double norms[2] = {0.0, 0.0};
+    for (int i = 0; i < 3; i++) {
+      coarse_end[i]->axpy(-1.0, fine_end[i]);
+      coarse_end[i]->axpy(-1.0, temp[i]);
+      end[i]->axpy(1.0, coarse_end[i]);
+      if (i < 2) {
+        TacsScalar dnorm = end[i]->norm();
+        norms[0] += TacsRealPart(dnorm * dnorm);
+      }
+      end[i]->copyValues(coarse_end[i]);
+      end[i]->scale(-1.0);
+      if (i < 2) {
+        TacsScalar unorm = end[i]->norm();
+        norms[1] += TacsRealPart(unorm * unorm);
+      }
+      coarse_end[i]->copyValues(temp[i]);
+    }
+    if (slab < num_slabs - 1) {
+      sendStates(end);
+    }
+
+    // Find the largest relative change over all the slabs
+    double change = 0.0;
+    if (norms[1] > 0.0) {
+      change = sqrt(norms[0] / norms[1]);
+    } else if (norms[0] > 0.0) {
+      change = sqrt(norms[0]);
+    }
+    double max_change;
+    MPI_Allreduce(&change, &max_change, 1, MPI_DOUBLE, MPI_MAX, time_comm);
+
+    num_iters++;
+    if (rank == 0 && print_level > 0) {
+      printf("TACSPararealIntegrator: iteration %3d |dU|/|U| %15.8e\n",
+             num_iters, max_change);
+    }
+    if (max_change < tol) {
+      break;
+    }
+  }
+
+  // Re-run the fine propagator on slabs where the initial states have
+  // changed since the last fine solution
+  if (num_iters <= slab) {
+    fail = propagate(fine, start, fine_end) || fail;
+  }
+
+  // Restore the initial conditions of the problem
+  assembler->setInitConditions(init[0], init[1], init[2]);
+
+  // Check whether any of the propagators failed
+  int fail_flag;
+  MPI_Allreduce(&fail, &fail_flag, 1, MPI_INT, MPI_MAX, comm);
+
+  if (rank == 0 && print_level > 0) {
+    printf("TACSPararealIntegrator: %d iterations on %d slabs in %.4e s\n",
+           num_iters, num_slabs, MPI_Wtime() - t0);
+  }
+
+  return fail_flag;
+}
@@ -0,0 +1,111 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_PARAREAL_INTEGRATOR_H
+#define TACS_PARAREAL_INTEGRATOR_H
+
+#include "TACSIntegrator.h"
+
+/*
+  Parallel-in-time integration with the Parareal method
+
+  The time interval is split into equal time slabs, one for each group
+  of processors. Each group owns a copy of the model created on its own
+  spatial communicator, and all copies must have the same parallel
+  partition. Processors with the same rank in each spatial communicator
+  form a time communicator that is used to pass the states between the
+  time slabs.
+
+  Each slab has a coarse and a fine TACSBDFIntegrator. The Parareal
+  iteration is
+
+  U[n+1]^{k+1} = G(U[n]^{k+1}) + F(U[n]^{k}) - G(U[n]^{k})
+
+  where G and F are the coarse and fine propagators over a slab and
+  U = (q, qdot, qddot). The fine propagators run concurrently, while the
+  coarse correction is passed down the time slabs. This is the
+  two-level MGRIT method with F-relaxation. After k iterations the
+  states on the first k slabs are exact, so the iteration always
+  terminates after at most the number of slabs.
+
+  The propagators start from the states set with
+  TACSAssembler::setInitConditions(). After solve(), the fine integrator
+  on each slab contains the converged time history on that slab.
+*/
+class TACSPararealIntegrator : public TACSObject {
+ public:
+  TACSPararealIntegrator(MPI_Comm _comm, TACSAssembler *_assembler,
+                         double _tinit, double _tfinal, int num_coarse_steps,
+                         int num_fine_steps, int max_bdf_order = 2);
+  ~TACSPararealIntegrator();
+
+  // Split a communicator into groups of processors for the time slabs
+  // -----------------------------------------------------------------
+  static MPI_Comm createSlabComm(MPI_Comm comm, int num_slabs);
+
+  // Set the solution parameters
+  // ---------------------------
+  void setTolerance(double _tol) { tol = _tol; }
+  void setMaxIterations(int _max_iters) { max_iters = _max_iters; }
+  void setPrintLevel(int _print_level) { print_level = _print_level; }
+
+  // Retrieve the propagators and the slab information
+  // -------------------------------------------------
+  TACSBDFIntegrator *getCoarseIntegrator() { return coarse; }
+  TACSBDFIntegrator *getFineIntegrator() { return fine; }
+  MPI_Comm getTimeComm() { return time_comm; }
+  int getSlabIndex() { return slab; }
+  int getNumSlabs() { return num_slabs; }
+  void getSlabInterval(double *t0, double *t1);
+
+  // Solve the time history
+  // ----------------------
+  int solve();
+  int getNumIterations() { return num_iters; }
+  void getFinalStates(TACSBVec **q, TACSBVec **qdot, TACSBVec **qddot);
+
+ private:
+  // Propagate the states over the slab
+  int propagate(TACSIntegrator *integ, TACSBVec *in[], TACSBVec *out[]);
+
+  // Pass the states between the slabs
+  void sendStates(TACSBVec *vecs[]);
+  void recvStates(TACSBVec *vecs[]);
+
+  // The model on this time slab
+  TACSAssembler *assembler;
+
+  // The communicators and the slab information
+  MPI_Comm comm, time_comm;
+  int slab, num_slabs;
+  double tinit, tfinal;
+
+  // The coarse and fine propagators on this slab
+  TACSBDFIntegrator *coarse, *fine;
+
+  // The initial conditions of the problem
+  TACSBVec *init[3];
+
+  // The states at the start of the slab, the coarse and fine states at
+  // the end of the slab and the corrected states at the end of the slab
+  TACSBVec *start[3], *coarse_end[3], *fine_end[3], *end[3];
+  TACSBVec *temp[3];
+
+  // The solution parameters
+  double tol;
+  int max_iters, num_iters;
+  int print_level;
+};
+
+#endif  // TACS_PARAREAL_INTEGRATOR_H
@@ -0,0 +1,464 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSProfiler.h"
+
+/*
+  A node in the tree of scopes for one thread. The children of a node
+  are stored as a linked list through the sibling index.
+*/
+struct TacsProfNode {
+  const char *name;
+  int parent, child, sibling;
+  long count;
+  double start, time, flops, bytes;
+};
+
+/*
+  The tree of scopes recorded on one thread. Node zero is the root.
+*/
+struct TacsProfThread {
+  int num_nodes, max_nodes;
+  TacsProfNode *nodes;
+  int current;
+  TacsProfThread *next;
+};
+
+/*
+  A scope combined over all threads, identified by its full path
+*/
+struct TacsProfEntry {
+  char *path;
+  double values[4];  // count, time, flops, bytes
+};
+
+static const int TACS_PROF_MAX_PATH = 1024;
+
+// The list of threads that have entered a scope
+static pthread_mutex_t prof_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t prof_once = PTHREAD_ONCE_INIT;
+static pthread_key_t prof_key;
+static TacsProfThread *prof_threads = NULL;
+
+static void TacsProfCreateKey() { pthread_key_create(&prof_key, NULL); }
+
+/*
+  Check the environment for the initial profiling flag
+*/
+static int TacsProfInitialFlag() {
+  const char *value = getenv("TACS_PROFILE");
+  if (value && atoi(value) != 0) {
+    return 1;
+  }
+  return 0;
+}
+
+int TACSProfiler::enabled = TacsProfInitialFlag();
+
+/*
+  Get the scope tree for the calling thread, creating it if required
+*/
+static TacsProfThread *TacsProfGetThread() {
+  pthread_once(&prof_once, TacsProfCreateKey);
+  TacsProfThread *t = (TacsProfThread *)pthread_getspecific(prof_key);
+  if (!t) {
+    t = new TacsProfThread;
+    t->max_nodes = 64;
+    t->nodes = new TacsProfNode[t->max_nodes];
+    t->num_nodes = 1;
+    t->current = 0;
+    memset(&t->nodes[0], 0, sizeof(TacsProfNode));
+    t->nodes[0].name = "root";
+    t->nodes[0].parent = t->nodes[0].child = t->nodes[0].sibling = -1;
+    pthread_setspecific(prof_key, t);
+
+    pthread_mutex_lock(&prof_mutex);
+    t->next = prof_threads;
+    prof_threads = t;
+    pthread_mutex_unlock(&prof_mutex);
+  }
+  return t;
+}
+
+/*
+  Enable or disable the profiling
+
+  @param flag Flag indicating whether to record the scopes
+*/
+void TACSProfiler::setEnabled(int flag) { enabled = (flag ? 1 : 0); }
+
+/*
+  Enter the named scope as a child of the active scope on this thread
+
+  @param name The name of the scope
+  @return The index of the scope to pass to endScope()
+*/
+int TACSProfiler::beginScope(const char *name) {
+  TacsProfThread *t = TacsProfGetThread();
+  int parent = t->current;
+
+  // Search the children of the active scope
+  int k = t->nodes[parent].child;
+  while (k >= 0 && t->nodes[k].name != name &&
+         strcmp(t->nodes[k].name, name) != 0) {
+    k = t->nodes[k].sibling;
+  }
+
+  // Add a new child
+  if (k < 0) {
+    if (t->num_nodes >= t->max_nodes) {
+      t->max_nodes *= 2;
+      TacsProfNode *temp = new TacsProfNode[t->max_nodes];
+      memcpy(temp, t->nodes, t->num_nodes * sizeof(TacsProfNode));
+      delete[] t->nodes;
+      t->nodes = temp;
+    }
+    k = t->num_nodes;
+    t->num_nodes++;
+    memset(&t->nodes[k], 0, sizeof(TacsProfNode));
+    t->nodes[k].name = name;
+    t->nodes[k].parent = parent;
+    t->nodes[k].child = -1;
+    t->nodes[k].sibling = t->nodes[parent].child;
+    t->nodes[parent].child = k;
+  }
+
+  t->nodes[k].start = MPI_Wtime();
+  t->current = k;
+  return k;
+}
+
+/*
+  Leave the scope and make its parent the active scope
+
+  @param scope The index returned by beginScope()
+*/
+void TACSProfiler::endScope(int scope) {
+  TacsProfThread *t = TacsProfGetThread();
+  if (scope > 0 && scope < t->num_nodes) {
+    TacsProfNode *node = &t->nodes[scope];
+    node->time += MPI_Wtime() - node->start;
+    node->count++;
+    t->current = node->parent;
+  }
+}
+
+/*
+  Add the work to the innermost active scope on this thread
+
+  @param flops The number of floating point operations
+  @param bytes The number of bytes read, written or communicated
+*/
+void TACSProfiler::addWork(double flops, double bytes) {
+  if (enabled) {
+    TacsProfThread *t = TacsProfGetThread();
+    t->nodes[t->current].flops += flops;
+    t->nodes[t->current].bytes += bytes;
+  }
+}
+
+/*
+  Discard the recorded scopes on all threads
+
+  This must not be called while any scope is active.
+*/
+void TACSProfiler::reset() {
+  pthread_mutex_lock(&prof_mutex);
+  for (TacsProfThread *t = prof_threads; t; t = t->next) {
+    t->num_nodes = 1;
+    t->current = 0;
+    t->nodes[0].child = -1;
+  }
+  pthread_mutex_unlock(&prof_mutex);
+}
+
+/*
+  Find the entry with the given path, or add it to the list
+*/
+static int TacsProfFindEntry(const char *path, int *num_entries,
+                             int *max_entries, TacsProfEntry **entries) {
+  for (int i = 0; i < *num_entries; i++) {
+    if (strcmp((*entries)[i].path, path) == 0) {
+      return i;
+    }
+  }
+
+  if (*num_entries >= *max_entries) {
+    *max_entries = 2 * (*max_entries) + 16;
+    TacsProfEntry *temp = new TacsProfEntry[*max_entries];
+    if (*entries) {
+      memcpy(temp, *entries, (*num_entries) * sizeof(TacsProfEntry));
+      delete[] * entries;
+    }
+    *entries = temp;
+  }
+
+  int k = *num_entries;
+  (*num_entries)++;
+  size_t len = strlen(path);
+  (*entries)[k].path = new char[len + 1];
+  memcpy((*entries)[k].path, path, len + 1);
+  for (int j = 0; j < 4; j++) {
+    (*entries)[k].values[j] = 0.0;
+  }
+  return k;
+}
+
+/*
+  Combine the scopes recorded on all threads by path
+*/
+static int TacsProfCollectEntries(TacsProfEntry **entries) {
+  int num_entries = 0, max_entries = 0;
+  *entries = NULL;
+
+  pthread_mutex_lock(&prof_mutex);
+  for (TacsProfThread *t = prof_threads; t; t = t->next) {
+    for (int k = 1; k < t->num_nodes; k++) {
+      // Build the path from the root to this scope
+      const char *names[64];
+      int depth = 0;
+      for (int p = k; p > 0 && depth < 64; p = t->nodes[p].parent) {
+        names[depth] = t->nodes[p].name;
+        depth++;
+      }
+
+      char path[TACS_PROF_MAX_PATH];
+      path[0] = '\0';
+      size_t len = 0;
+      for (int d = depth - 1; d >= 0; d--) {
+        int n = snprintf(&path[len], TACS_PROF_MAX_PATH - len, "%s%s",
+                         (d == depth - 1 ? "" : "/"), names[d]);
+        if (n < 0 || len + n >= (size_t)TACS_PROF_MAX_PATH) {
+          break;
+        }
+        len += n;
+      }
+
+      int i = TacsProfFindEntry(path, &num_entries, &max_entries, entries);
+      (*entries)[i].values[0] += t->nodes[k].count;
+      (*entries)[i].values[1] += t->nodes[k].time;
+      (*entries)[i].values[2] += t->nodes[k].flops;
+      (*entries)[i].values[3] += t->nodes[k].bytes;
+    }
+  }
+  pthread_mutex_unlock(&prof_mutex);
+
+  return num_entries;
+}
+
+static void TacsProfFreeEntries(int num_entries, TacsProfEntry *entries) {
+  for (int i = 0; i < num_entries; i++) {
+    delete[] entries[i].path;
+  }
+  if (entries) {
+    delete[] entries;
+  }
+}
+
+/*
+  Write a string with the JSON special characters escaped
+*/
+static void TacsProfWriteString(FILE *fp, const char *str) {
+  fprintf(fp, "\"");
+  for (; *str; str++) {
+    if (*str == '"' || *str == '\\') {
+      fprintf(fp, "\\%c", *str);
+    } else {
+      fprintf(fp, "%c", *str);
+    }
+  }
+  fprintf(fp, "\"");
+}
+
+/*
+  Write the scopes recorded on this process to a JSON file
+
+  @param filename The name of the file
+  @return Zero on success, non-zero if the file cannot be opened
+*/
+int TACSProfiler::writeJSON(const char *filename) {
+  FILE *fp = fopen(filename, "w");
+  if (!fp) {
+    fprintf(stderr, "TACSProfiler: Could not open file %s\n", filename);
+    return 1;
+  }
+
+  TacsProfEntry *entries;
+  int num_entries = TacsProfCollectEntries(&entries);
+
+  fprintf(fp, "{\n  \"scopes\": [");
+  for (int i = 0; i < num_entries; i++) {
+    fprintf(fp, "%s\n    {\"path\": ", (i == 0 ? "" : ","));
+    TacsProfWriteString(fp, entries[i].path);
+    fprintf(fp,
+            ", \"count\": %.0f, \"time\": %.9e, \"flops\": %.9e, "
+            "\"bytes\": %.9e}",
+            entries[i].values[0], entries[i].values[1], entries[i].values[2],
+            entries[i].values[3]);
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  fclose(fp);
+
+  TacsProfFreeEntries(num_entries, entries);
+  return 0;
+}
+
+/*
+  Write the minimum, maximum and average of each scope across all
+  processes to a JSON file on the root process
+
+  A scope that is not recorded on a process counts as zero on that
+  process. This call is collective on the communicator.
+
+  @param comm The MPI communicator
+  @param filename The name of the file
+  @return Zero on success, non-zero if the file cannot be opened
+*/
+int TACSProfiler::writeSummaryJSON(MPI_Comm comm, const char *filename) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  TacsProfEntry *entries;
+  int num_entries = TacsProfCollectEntries(&entries);
+
+  // Pack the local paths separated by newlines
+  int local_len = 0;
+  for (int i = 0; i < num_entries; i++) {
+    local_len += strlen(entries[i].path) + 1;
+  }
+  char *local_paths = new char[local_len + 1];
+  local_paths[0] = '\0';
+  for (int i = 0, pos = 0; i < num_entries; i++) {
+    pos += sprintf(&local_paths[pos], "%s\n", entries[i].path);
+  }
+
+  // Gather the paths on the root to find their union
+  int *lens = NULL, *ptr = NULL;
+  char *all_paths = NULL;
+  if (rank == 0) {
+    lens = new int[size];
+    ptr = new int[size + 1];
+  }
+  MPI_Gather(&local_len, 1, MPI_INT, lens, 1, MPI_INT, 0, comm);
+  if (rank == 0) {
+    ptr[0] = 0;
+    for (int k = 0; k < size; k++) {
+      ptr[k + 1] = ptr[k] + lens[k];
+    }
+    all_paths = new char[ptr[size] + 1];
+  }
+  MPI_Gatherv(local_paths, local_len, MPI_CHAR, all_paths, lens, ptr, MPI_CHAR,
+              0, comm);
+  delete[] local_paths;
+
+  int num_union = 0, max_union = 0;
+  TacsProfEntry *union_entries = NULL;
+  int union_len = 0;
+  char *union_paths = NULL;
+  if (rank == 0) {
+    all_paths[ptr[size]] = '\0';
+    char *start = all_paths;
+    for (char *c = all_paths; *c; c++) {
+      if (*c == '\n') {
+        *c = '\0';
+        TacsProfFindEntry(start, &num_union, &max_union, &union_entries);
+        start = c + 1;
+      }
+    }
+    for (int i = 0; i < num_union; i++) {
+      union_len += strlen(union_entries[i].path) + 1;
+    }
+    union_paths = new char[union_len + 1];
+    for (int i = 0, pos = 0; i < num_union; i++) {
+      pos += sprintf(&union_paths[pos], "%s\n", union_entries[i].path);
+    }
+    delete[] lens;
+    delete[] ptr;
+    delete[] all_paths;
+  }
+
+  // Broadcast the union of the paths
+  MPI_Bcast(&union_len, 1, MPI_INT, 0, comm);
+  if (rank != 0) {
+    union_paths = new char[union_len + 1];
+  }
+  MPI_Bcast(union_paths, union_len, MPI_CHAR, 0, comm);
+  union_paths[union_len] = '\0';
+  if (rank != 0) {
+    char *start = union_paths;
+    for (char *c = union_paths; *c; c++) {
+      if (*c == '\n') {
+        *c = '\0';
+        TacsProfFindEntry(start, &num_union, &max_union, &union_entries);
+        start = c + 1;
+      }
+    }
+  }
+  delete[] union_paths;
+
+  // Find the local values for each path in the union
+  double *values = new double[4 * num_union];
+  memset(values, 0, 4 * num_union * sizeof(double));
+  for (int i = 0; i < num_entries; i++) {
+    int k = TacsProfFindEntry(entries[i].path, &num_union, &max_union,
+                              &union_entries);
+    for (int j = 0; j < 4; j++) {
+      values[4 * k + j] = entries[i].values[j];
+    }
+  }
+  TacsProfFreeEntries(num_entries, entries);
+
+  double *vmin = new double[4 * num_union];
+  double *vmax = new double[4 * num_union];
+  double *vsum = new double[4 * num_union];
+  MPI_Reduce(values, vmin, 4 * num_union, MPI_DOUBLE, MPI_MIN, 0, comm);
+  MPI_Reduce(values, vmax, 4 * num_union, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(values, vsum, 4 * num_union, MPI_DOUBLE, MPI_SUM, 0, comm);
+  delete[] values;
+
+  int fail = 0;
+  if (rank == 0) {
+    FILE *fp = fopen(filename, "w");
+    if (fp) {
+      const char *keys[] = {"count", "time", "flops", "bytes"};
+      fprintf(fp, "{\n  \"num_ranks\": %d,\n  \"scopes\": [", size);
+      for (int i = 0; i < num_union; i++) {
+        fprintf(fp, "%s\n    {\"path\": ", (i == 0 ? "" : ","));
+        TacsProfWriteString(fp, union_entries[i].path);
+        for (int j = 0; j < 4; j++) {
+          fprintf(fp,
+                  ",\n     \"%s\": {\"min\": %.9e, \"max\": %.9e, "
+                  "\"avg\": %.9e}",
+                  keys[j], vmin[4 * i + j], vmax[4 * i + j],
+                  vsum[4 * i + j] / size);
+        }
+        fprintf(fp, "}");
+      }
+      fprintf(fp, "\n  ]\n}\n");
+      fclose(fp);
+    } else {
+      fprintf(stderr, "TACSProfiler: Could not open file %s\n", filename);
+      fail = 1;
+    }
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+
+  delete[] vmin;
+  delete[] vmax;
+  delete[] vsum;
+  TacsProfFreeEntries(num_union, union_entries);
+
+  return fail;
+}
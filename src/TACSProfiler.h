@@ -0,0 +1,100 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_PROFILER_H
+#define TACS_PROFILER_H
+
+#include "TACSObject.h"
+
+/*
+  A global registry of timed scopes
+
+  Each scope records the number of calls, the wall time and,
+  optionally, the number of flops and bytes moved. Scopes that are
+  entered while another scope is active are recorded as children of
+  that scope, so the registry forms a tree for each thread. The names
+  are identified by pointer and string comparison, so they must remain
+  valid while profiling is active (string literals are intended).
+
+  Profiling is disabled by default. It can be enabled at run time with
+  TACSProfiler::setEnabled() or by setting the environment variable
+  TACS_PROFILE to a non-zero value. When disabled, entering a scope
+  costs a single flag check.
+
+  The timers are kept separately for each thread, and are combined by
+  path when the results are written. The times for scopes that are
+  entered on several threads are therefore the sum of the thread times.
+
+  writeJSON() writes the values from this process, and
+  writeSummaryJSON() writes the minimum, maximum and average values of
+  each scope across all processes.
+*/
+class TACSProfiler {
+ public:
+  // Enable or disable the profiling
+  // -------------------------------
+  static void setEnabled(int flag);
+  static int isEnabled() { return enabled; }
+
+  // Enter and leave a scope on the calling thread
+  // ---------------------------------------------
+  static int beginScope(const char *name);
+  static void endScope(int scope);
+
+  // Add work to the innermost active scope on the calling thread
+  // -----------------------------------------------------------
+  static void addWork(double flops, double bytes);
+
+  // Discard all recorded values
+  // ---------------------------
+  static void reset();
+
+  // Write the recorded values
+  // -------------------------
+  static int writeJSON(const char *filename);
+  static int writeSummaryJSON(MPI_Comm comm, const char *filename);
+
+ private:
+  static int enabled;
+};
+
+/*
+  Record the enclosing C++ scope in the profiler
+*/
+class TACSProfileScope {
+ public:
+  TACSProfileScope(const char *name) {
+    scope = -1;
+    if (TACSProfiler::isEnabled()) {
+      scope = TACSProfiler::beginScope(name);
+    }
+  }
+  ~TACSProfileScope() {
+    if (scope >= 0) {
+      TACSProfiler::endScope(scope);
+    }
+  }
+
+  // Add work to this scope
+  void addWork(double flops, double bytes) {
+    if (scope >= 0) {
+      TACSProfiler::addWork(flops, bytes);
+    }
+  }
+
+ private:
+  int scope;
+};
+
+#endif  // TACS_PROFILER_H
@@ -0,0 +1,346 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSRandomVibration.h"
+
+#include "TACSProfiler.h"
+
+/*
+  Create the random vibration analysis
+
+  input:
+  assembler:  the TACSAssembler object
+*/
+TACSRandomVibration::TACSRandomVibration(TACSAssembler *_assembler) {
+  assembler = _assembler;
+  assembler->incref();
+
+  num_modes = 0;
+  modes = NULL;
+  eigvals = NULL;
+  zeta = 0.0;
+
+  force = NULL;
+  num_freqs = 0;
+  freqs = NULL;
+  psd = NULL;
+
+  cov = NULL;
+}
+
+TACSRandomVibration::~TACSRandomVibration() {
+  clearModes();
+  if (force) {
+    force->decref();
+  }
+  if (freqs) {
+    delete[] freqs;
+    delete[] psd;
+  }
+  assembler->decref();
+}
+
+/*
+  Free the modes and the covariance
+*/
+void TACSRandomVibration::clearModes() {
+  if (modes) {
+    for (int j = 0; j < num_modes; j++) {
+      modes[j]->decref();
+    }
+    delete[] modes;
+    delete[] eigvals;
+  }
+  if (cov) {
+    delete[] cov;
+  }
+  num_modes = 0;
+  modes = NULL;
+  eigvals = NULL;
+  cov = NULL;
+}
+
+/*
+  Set the modes from a frequency analysis
+
+  The eigenvectors are copied from the frequency analysis, which must
+  have been solved, and are normalized with respect to the mass matrix
+  at the current design. The covariance must be computed again after
+  the modes are set.
+
+  input:
+  freq:       the solved frequency analysis
+  num_modes:  the number of modes to use
+*/
+void TACSRandomVibration::setModes(TACSFrequencyAnalysis *freq,
+                                   int _num_modes) {
+  clearModes();
+
+  TACSSchurMat *mmat = assembler->createSchurMat();
+  mmat->incref();
+  assembler->assembleMatType(TACS_MASS_MATRIX, mmat);
+  TACSBVec *mx = assembler->createVec();
+  mx->incref();
+
+  num_modes = _num_modes;
+  modes = new TACSBVec *[num_modes];
+  eigvals = new TacsScalar[num_modes];
+  for (int j = 0; j < num_modes; j++) {
+    TacsScalar error;
+    modes[j] = assembler->createVec();
+    modes[j]->incref();
+    eigvals[j] = freq->extractEigenvalue(j, &error);
+    freq->extractEigenvector(j, modes[j], &error);
+
+    // Normalize the mode so that the modal mass is one
+    mmat->mult(modes[j], mx);
+    TacsScalar mass = modes[j]->dot(mx);
+    if (TacsRealPart(mass) > 0.0) {
+      modes[j]->scale(1.0 / sqrt(mass));
+    }
+
+    // Distribute the values so that the element values can be read
+    modes[j]->beginDistributeValues();
+    modes[j]->endDistributeValues();
+  }
+
+  mx->decref();
+  mmat->decref();
+}
+
+/*
+  Set the modal damping ratio applied to all modes
+*/
+void TACSRandomVibration::setModalDamping(double _zeta) { zeta = _zeta; }
+
+/*
+  Set the spatial distribution of the load and the one-sided power
+  spectral density of its amplitude
+
+  input:
+  force:      the spatial distribution of the load
+  num_freqs:  the number of frequencies
+  freqs:      the angular frequencies in increasing order
+  psd:        the spectral density at each frequency
+*/
+void TACSRandomVibration::setLoadPSD(TACSBVec *_force, int _num_freqs,
+                                     const double _freqs[],
+                                     const double _psd[]) {
+  _force->incref();
+  if (force) {
+    force->decref();
+  }
+  force = _force;
+
+  if (freqs) {
+    delete[] freqs;
+    delete[] psd;
+  }
+  num_freqs = _num_freqs;
+  freqs = new double[num_freqs];
+  psd = new double[num_freqs];
+  memcpy(freqs, _freqs, num_freqs * sizeof(double));
+  memcpy(psd, _psd, num_freqs * sizeof(double));
+}
+
+/*
+  Compute the covariance of the modal coordinates
+
+  The modal participation of the load is computed once, and the
+  integrand is evaluated in closed form for each pair of modes at each
+  frequency, so that no solutions are required.
+*/
+void TACSRandomVibration::computeCovariance() {
+  TACSProfileScope scope("TACSRandomVibration::computeCovariance");
+  if (cov) {
+    delete[] cov;
+  }
+  cov = new TacsScalar[num_modes * num_modes];
+  memset(cov, 0, num_modes * num_modes * sizeof(TacsScalar));
+  if (!force || num_modes == 0) {
+    return;
+  }
+
+  // Compute the modal participation of the load
+  TacsScalar *p = new TacsScalar[num_modes];
+  TacsScalar *omega = new TacsScalar[num_modes];
+  for (int j = 0; j < num_modes; j++) {
+    p[j] = modes[j]->dot(force);
+    omega[j] = 0.0;
+    if (TacsRealPart(eigvals[j]) > 0.0) {
+      omega[j] = sqrt(eigvals[j]);
+    }
+  }
+
+  // The real and imaginary parts of the inverse of the modal
+  // frequency response function
+  TacsScalar *a = new TacsScalar[num_modes];
+  TacsScalar *b = new TacsScalar[num_modes];
+  for (int i = 0; i < num_freqs; i++) {
+    // Compute the trapezoid weight for this frequency
+    double w = 0.0;
+    if (i > 0) {
+      w += 0.5 * (freqs[i] - freqs[i - 1]);
+    }
+    if (i < num_freqs - 1) {
+      w += 0.5 * (freqs[i + 1] - freqs[i]);
+    }
+    w *= psd[i];
+
+    for (int j = 0; j < num_modes; j++) {
+      TacsScalar aj = eigvals[j] - freqs[i] * freqs[i];
+      TacsScalar bj = 2.0 * zeta * omega[j] * freqs[i];
+      TacsScalar d = aj * aj + bj * bj;
+      a[j] = p[j] * aj / d;
+      b[j] = p[j] * bj / d;
+    }
+
+    // Re(H_j*conj(H_k)) = (a_j*a_k + b_j*b_k)/(d_j*d_k)
+    for (int j = 0; j < num_modes; j++) {
+      for (int k = 0; k <= j; k++) {
+        cov[num_modes * j + k] += w * (a[j] * a[k] + b[j] * b[k]);
+      }
+    }
+  }
+
+  // Copy the lower triangle into the upper triangle
+  for (int j = 0; j < num_modes; j++) {
+    for (int k = 0; k < j; k++) {
+      cov[num_modes * k + j] = cov[num_modes * j + k];
+    }
+  }
+
+  delete[] p;
+  delete[] omega;
+  delete[] a;
+  delete[] b;
+}
+
+/*
+  Get the mode with the given index
+*/
+TACSBVec *TACSRandomVibration::getMode(int j) {
+  if (j >= 0 && j < num_modes) {
+    return modes[j];
+  }
+  return NULL;
+}
+
+/*
+  Get the eigenvalue of the mode with the given index
+*/
+TacsScalar TACSRandomVibration::getEigenvalue(int j) {
+  if (j >= 0 && j < num_modes) {
+    return eigvals[j];
+  }
+  return 0.0;
+}
+
+/*
+  Get the element variables for each mode
+
+  The variables for mode j are stored at modeVars[j*numVars], where
+  numVars is the number of variables of the element. This is
+  thread-safe.
+*/
+void TACSRandomVibration::getElementModeVars(int elemIndex,
+                                             TacsScalar modeVars[]) {
+  int len;
+  const int *nodes;
+  TACSElement *element = assembler->getElement(elemIndex, &len, &nodes);
+  int numVars = element->getNumVariables();
+  for (int j = 0; j < num_modes; j++) {
+    modes[j]->getValues(len, nodes, &modeVars[numVars * j]);
+  }
+}
+
+/*
+  Compute the RMS values of the element output data
+
+  Only the displacements, strains and stresses are linear in the
+  states, so the remaining classes of output are removed from the
+  write flag. The output data is computed once for each mode and the
+  variables stored in the assembler are restored afterwards. No data
+  is returned until the covariance has been computed.
+
+  input:
+  elem_type:   the element type to match
+  write_flag:  the classes of output data
+
+  output:
+  len:         the number of points
+  nvals:       the number of values at each point
+  data:        the RMS value of each value at each point
+*/
+void TACSRandomVibration::getRMSOutputData(ElementType elem_type,
+                                           int write_flag, int *len,
+                                           int *nvals, TacsScalar **data) {
+  TACSProfileScope scope("TACSRandomVibration::getRMSOutputData");
+  write_flag &= (TACS_OUTPUT_DISPLACEMENTS | TACS_OUTPUT_STRAINS |
+                 TACS_OUTPUT_STRESSES);
+  *len = *nvals = 0;
+  *data = NULL;
+  if (!cov || num_modes == 0) {
+    return;
+  }
+
+  // Store the variables so that they can be restored
+  TACSBVec *q = assembler->createVec();
+  q->incref();
+  TACSBVec *qdot = assembler->createVec();
+  qdot->incref();
+  TACSBVec *qddot = assembler->createVec();
+  qddot->incref();
+  assembler->getVariables(q, qdot, qddot);
+
+  // Compute the output data for each mode
+  int size = 0;
+  TacsScalar **modeData = new TacsScalar *[num_modes];
+  for (int j = 0; j < num_modes; j++) {
+    assembler->setVariables(modes[j]);
+    assembler->getElementOutputData(elem_type, write_flag, len, nvals,
+                                    &modeData[j]);
+    size = (*len) * (*nvals);
+  }
+  assembler->setVariables(q, qdot, qddot);
+  q->decref();
+  qdot->decref();
+  qddot->decref();
+
+  // Compute the RMS value of each entry
+  TacsScalar *rms = new TacsScalar[size];
+  for (int i = 0; i < size; i++) {
+    TacsScalar var = 0.0;
+    for (int j = 0; j < num_modes; j++) {
+      TacsScalar yj = modeData[j][i];
+      for (int k = 0; k < num_modes; k++) {
+        var += yj * cov[num_modes * j + k] * modeData[k][i];
+      }
+    }
+    rms[i] = 0.0;
+    if (TacsRealPart(var) > 0.0) {
+      rms[i] = sqrt(var);
+    }
+  }
+
+  for (int j = 0; j < num_modes; j++) {
+    delete[] modeData[j];
+  }
+  delete[] modeData;
+  *data = rms;
+}
@@ -0,0 +1,110 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_RANDOM_VIBRATION_H
+#define TACS_RANDOM_VIBRATION_H
+
+#include "TACSAssembler.h"
+#include "TACSBuckling.h"
+
+/*
+  Compute the stationary response to a random load using the modes
+  from a frequency analysis
+
+  The load f(t) = f*g(t) has a fixed spatial distribution f and a
+  scalar amplitude g(t) with the one-sided power spectral density S(w).
+  With the mass-normalized modes phi_j, the modal frequency response
+  functions are
+
+  H_j(w) = 1/(w_j^2 - w^2 + 2*i*zeta*w_j*w)
+
+  and the covariance of the modal coordinates is
+
+  Q_jk = int_{0}^{inf} p_j*p_k*Re(H_j(w)*conj(H_k(w)))*S(w) dw
+
+  where p_j = phi_j^T f is the modal participation of the load. The
+  integral is computed with the trapezoid rule over the frequencies at
+  which the spectral density is given, so these must resolve the peaks
+  of the response.
+
+  The covariance of any quantity y that is linear in the states is
+  then y_j^T Q y_k, where y_j is the quantity evaluated for mode j. The
+  modal quantities are computed once per element, so that the RMS
+  values at all points require no solutions and no additional element
+  evaluations per frequency. The RMS values of the element output data
+  are computed with getRMSOutputData(), and the RMS stress may be
+  aggregated with the TACSRMSStress function.
+*/
+class TACSRandomVibration : public TACSObject {
+ public:
+  TACSRandomVibration(TACSAssembler *_assembler);
+  ~TACSRandomVibration();
+
+  // Retrieve the instance of TACSAssembler
+  // --------------------------------------
+  TACSAssembler *getAssembler() { return assembler; }
+
+  // Set the modes from a frequency analysis
+  // ---------------------------------------
+  void setModes(TACSFrequencyAnalysis *freq, int _num_modes);
+  void setModalDamping(double _zeta);
+
+  // Set the load and its power spectral density
+  // -------------------------------------------
+  void setLoadPSD(TACSBVec *_force, int _num_freqs, const double _freqs[],
+                  const double _psd[]);
+
+  // Compute the covariance of the modal coordinates
+  // -----------------------------------------------
+  void computeCovariance();
+
+  // Access the modes and the covariance
+  // -----------------------------------
+  int getNumModes() { return num_modes; }
+  TACSBVec *getMode(int j);
+  TacsScalar getEigenvalue(int j);
+  const TacsScalar *getCovariance() { return cov; }
+  void getElementModeVars(int elemIndex, TacsScalar modeVars[]);
+
+  // Compute the RMS values of the element output data
+  // -------------------------------------------------
+  void getRMSOutputData(ElementType elem_type, int write_flag, int *len,
+                        int *nvals, TacsScalar **data);
+
+ private:
+  void clearModes();
+
+  // The TACS assembler object
+  TACSAssembler *assembler;
+
+  // The mass-normalized modes and their eigenvalues
+  int num_modes;
+  TACSBVec **modes;
+  TacsScalar *eigvals;
+  double zeta;
+
+  // The load and the spectral density of its amplitude
+  TACSBVec *force;
+  int num_freqs;
+  double *freqs, *psd;
+
+  // The covariance of the modal coordinates
+  TacsScalar *cov;
+};
+
+#endif  // TACS_RANDOM_VIBRATION_H
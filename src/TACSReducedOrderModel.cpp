@@ -0,0 +1,910 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSReducedOrderModel.h"
+
+#include "tacslapack.h"
+
+/*
+  Allocate the reduced-order model
+
+  @param assembler The finite-element model
+  @param _max_basis_size The maximum number of basis vectors
+  @param _oversample The oversampling used in the randomized SVD
+*/
+TACSReducedOrderModel::TACSReducedOrderModel(TACSAssembler *_assembler,
+                                             int _max_basis_size,
+                                             int _oversample) {
+  assembler = _assembler;
+  assembler->incref();
+
+  max_basis_size = (_max_basis_size < 1 ? 1 : _max_basis_size);
+  oversample = (_oversample < 0 ? 0 : _oversample);
+  basis_size = 0;
+  basis = NULL;
+  num_sigma = 0;
+  sigma = NULL;
+
+  num_samples = 0;
+  sample_elems = NULL;
+  sample_weights = NULL;
+  sample_ptr = NULL;
+  xpt_ptr = NULL;
+  sample_basis = NULL;
+  sample_vars = sample_dvars = sample_ddvars = NULL;
+  sample_xpts = NULL;
+
+  // Allocate the temporary element data
+  int max_vars = assembler->getMaxElementVariables();
+  elem_vars = new TacsScalar[max_vars];
+  elem_dvars = new TacsScalar[max_vars];
+  elem_ddvars = new TacsScalar[max_vars];
+  elem_res = new TacsScalar[max_vars];
+  elem_mat = new TacsScalar[max_vars * max_vars];
+  elem_jv = new TacsScalar[max_vars * max_basis_size];
+}
+
+TACSReducedOrderModel::~TACSReducedOrderModel() {
+  assembler->decref();
+  for (int i = 0; i < basis_size; i++) {
+    basis[i]->decref();
+  }
+  delete[] basis;
+  delete[] sigma;
+  delete[] sample_elems;
+  delete[] sample_weights;
+  delete[] sample_ptr;
+  delete[] xpt_ptr;
+  delete[] sample_basis;
+  delete[] sample_vars;
+  delete[] sample_dvars;
+  delete[] sample_ddvars;
+  delete[] sample_xpts;
+  delete[] elem_vars;
+  delete[] elem_dvars;
+  delete[] elem_ddvars;
+  delete[] elem_res;
+  delete[] elem_mat;
+  delete[] elem_jv;
+}
+
+/*
+  Compute the POD basis from the snapshots with a randomized SVD
+
+  The snapshot matrix X = [q[i] - qref] is sketched with a Gaussian
+  random matrix, Y = X*Omega, the sketch is orthonormalized to form Q,
+  and the small matrix B = Q^{T}*X is decomposed through the eigenvalues
+  of B*B^{T}. When there are fewer snapshots than the sketch size, the
+  snapshots are orthonormalized directly and the decomposition is exact.
+  The random matrix is generated identically on all processors.
+
+  @param num_snapshots The number of snapshots
+  @param snapshots The state vectors
+  @param qref The reference state subtracted from the snapshots (or NULL)
+  @param energy_tol The fraction of the snapshot energy that is discarded
+  @return The number of basis vectors
+*/
+int TACSReducedOrderModel::computeBasis(int num_snapshots,
+                                        TACSBVec **snapshots, TACSBVec *qref,
+                                        double energy_tol) {
+  // Free the previous basis
+  for (int i = 0; i < basis_size; i++) {
+    basis[i]->decref();
+  }
+  delete[] basis;
+  delete[] sigma;
+  basis_size = 0;
+  basis = NULL;
+  num_sigma = 0;
+  sigma = NULL;
+
+  if (num_snapshots <= 0) {
+    return 0;
+  }
+
+  // Form the snapshots relative to the reference state
+  TACSBVec **X = new TACSBVec *[num_snapshots];
+  for (int j = 0; j < num_snapshots; j++) {
+    X[j] = assembler->createVec();
+    X[j]->incref();
+    X[j]->copyValues(snapshots[j]);
+    if (qref) {
+      X[j]->axpy(-1.0, qref);
+    }
+    assembler->applyBCs(X[j]);
+  }
+
+  // Form the sketch of the range of the snapshots
+  int nsketch = max_basis_size + oversample;
+  TACSBVec **Q = NULL;
+  if (num_snapshots <= nsketch) {
+    nsketch = num_snapshots;
+    Q = new TACSBVec *[nsketch];
+    for (int i = 0; i < nsketch; i++) {
+      Q[i] = assembler->createVec();
+      Q[i]->incref();
+      Q[i]->copyValues(X[i]);
+    }
+  } else {
+    // Generate the Gaussian random matrix with the Box-Muller transform
+    // from a linear congruential generator with a fixed seed
+    unsigned int seed = 1234567u;
+    Q = new TACSBVec *[nsketch];
+    for (int i = 0; i < nsketch; i++) {
+      Q[i] = assembler->createVec();
+      Q[i]->incref();
+      for (int j = 0; j < num_snapshots; j++) {
+        seed = 1664525u * seed + 1013904223u;
+        double u1 = (seed + 1.0) / 4294967297.0;
+        seed = 1664525u * seed + 1013904223u;
+        double u2 = (seed + 1.0) / 4294967297.0;
+        double omega = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+        Q[i]->axpy(omega, X[j]);
+      }
+    }
+  }
+
+  // Orthonormalize the sketch with classical Gram-Schmidt applied
+  // twice, dropping vectors that are linearly dependent
+  TacsScalar *h = new TacsScalar[nsketch];
+  double max_norm = 0.0;
+  int nq = 0;
+  for (int i = 0; i < nsketch; i++) {
+    double norm0 = TacsRealPart(Q[i]->norm());
+    if (norm0 > max_norm) {
+      max_norm = norm0;
+    }
+    for (int iter = 0; iter < 2 && nq > 0; iter++) {
+      Q[i]->mdot((TACSVec **)Q, h, nq);
+      for (int j = 0; j < nq; j++) {
+        Q[i]->axpy(-h[j], Q[j]);
+      }
+    }
+    double norm = TacsRealPart(Q[i]->norm());
+    if (norm > 1e-12 * max_norm && norm > 0.0) {
+      Q[i]->scale(1.0 / norm);
+      if (i != nq) {
+        TACSBVec *t = Q[nq];
+        Q[nq] = Q[i];
+        Q[i] = t;
+      }
+      nq++;
+    }
+  }
+  delete[] h;
+
+  if (nq == 0) {
+    for (int i = 0; i < nsketch; i++) {
+      Q[i]->decref();
+    }
+    for (int j = 0; j < num_snapshots; j++) {
+      X[j]->decref();
+    }
+    delete[] Q;
+    delete[] X;
+    setSampleElements(0, NULL, NULL);
+    return 0;
+  }
+
+  // Compute B = Q^{T}*X and C = B*B^{T}
+  TacsScalar *bcol = new TacsScalar[nq];
+  double *B = new double[nq * num_snapshots];
+  for (int j = 0; j < num_snapshots; j++) {
+    X[j]->mdot((TACSVec **)Q, bcol, nq);
+    for (int i = 0; i < nq; i++) {
+      B[i + nq * j] = TacsRealPart(bcol[i]);
+    }
+  }
+  delete[] bcol;
+
+  double *C = new double[nq * nq];
+  for (int i = 0; i < nq; i++) {
+    for (int k = 0; k < nq; k++) {
+      double c = 0.0;
+      for (int j = 0; j < num_snapshots; j++) {
+        c += B[i + nq * j] * B[k + nq * j];
+      }
+      C[i + nq * k] = c;
+    }
+  }
+  delete[] B;
+
+  // Compute the eigenvalues in ascending order
+  int lwork = 3 * nq + 64;
+  double *eigs = new double[nq];
+  double *work = new double[lwork];
+  int info = 0;
+  LAPACKdsyev("V", "U", &nq, C, &nq, eigs, work, &lwork, &info);
+  delete[] work;
+
+  // Store the singular values in descending order
+  num_sigma = nq;
+  sigma = new double[nq];
+  double total = 0.0;
+  for (int i = 0; i < nq; i++) {
+    double e = eigs[nq - 1 - i];
+    sigma[i] = (e > 0.0 ? sqrt(e) : 0.0);
+    total += sigma[i] * sigma[i];
+  }
+  delete[] eigs;
+
+  // Select the number of basis vectors from the retained energy
+  double energy = 0.0;
+  for (basis_size = 0; basis_size < nq && basis_size < max_basis_size;) {
+    if (info != 0 || sigma[basis_size] <= 0.0 ||
+        energy >= (1.0 - energy_tol) * total) {
+      break;
+    }
+    energy += sigma[basis_size] * sigma[basis_size];
+    basis_size++;
+  }
+
+  // Form the basis V = Q*U from the leading eigenvectors
+  basis = new TACSBVec *[basis_size];
+  for (int k = 0; k < basis_size; k++) {
+    const double *u = &C[nq * (nq - 1 - k)];
+    basis[k] = assembler->createVec();
+    basis[k]->incref();
+    for (int i = 0; i < nq; i++) {
+      basis[k]->axpy(u[i], Q[i]);
+    }
+    assembler->applyBCs(basis[k]);
+    basis[k]->beginDistributeValues();
+    basis[k]->endDistributeValues();
+  }
+  delete[] C;
+
+  for (int i = 0; i < nsketch; i++) {
+    Q[i]->decref();
+  }
+  for (int j = 0; j < num_snapshots; j++) {
+    X[j]->decref();
+  }
+  delete[] Q;
+  delete[] X;
+
+  // Use all elements until the samples are computed
+  int num_elements = assembler->getNumElements();
+  int *elems = new int[num_elements];
+  double *weights = new double[num_elements];
+  for (int i = 0; i < num_elements; i++) {
+    elems[i] = i;
+    weights[i] = 1.0;
+  }
+  setSampleElements(num_elements, elems, weights);
+  delete[] elems;
+  delete[] weights;
+
+  return basis_size;
+}
+
+/*
+  Select the sampled elements and their weights
+
+  The projected residual contributions of every element are computed
+  at the training snapshots. Elements are added greedily by their
+  correlation with the remaining error in the sum of the projected
+  residuals, and the weights are found from a non-negative
+  least-squares problem over the selected elements. Elements that
+  receive a non-positive weight are discarded. The selection stops
+  when the relative error is less than tol or when max_samples elements
+  are selected across all processors.
+
+  @param num_snapshots The number of training snapshots
+  @param times The simulation times of the snapshots
+  @param q The states at the snapshots
+  @param qdot The first time derivatives at the snapshots
+  @param qddot The second time derivatives at the snapshots
+  @param tol The relative tolerance on the projected residual
+  @param max_samples The maximum number of elements (0 = no limit)
+  @return The number of sampled elements across all processors
+*/
+int TACSReducedOrderModel::computeSampleElements(
+    int num_snapshots, const double *times, TACSBVec **q, TACSBVec **qdot,
+    TACSBVec **qddot, double tol, int max_samples) {
+  if (basis_size == 0 || num_snapshots <= 0) {
+    return getNumSampleElements();
+  }
+
+  MPI_Comm comm = assembler->getMPIComm();
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Compute the projected residual of each element at each snapshot.
+  // At a converged snapshot the contributions sum to the projected
+  // external forces, so the static, time-dependent and auxiliary parts
+  // of the residual are matched separately.
+  int num_elements = assembler->getNumElements();
+  int vpn = assembler->getVarsPerNode();
+  int nblock = basis_size * num_snapshots;
+  int ldg = 3 * nblock;
+  double *G = new double[ldg * num_elements];
+  memset(G, 0, ldg * num_elements * sizeof(double));
+  int max_vars = assembler->getMaxElementVariables();
+  TacsScalar *Xpts = new TacsScalar[3 * assembler->getMaxElementNodes()];
+  TacsScalar *Ve = new TacsScalar[max_vars];
+  TacsScalar *zero = new TacsScalar[max_vars];
+  TacsScalar *res = new TacsScalar[3 * max_vars];
+  memset(zero, 0, max_vars * sizeof(TacsScalar));
+
+  TACSAuxElements *aux_elements = assembler->getAuxElements();
+  TACSAuxElem *aux = NULL;
+  int naux = 0;
+  if (aux_elements) {
+    naux = aux_elements->getAuxElements(&aux);
+  }
+
+  for (int s = 0; s < num_snapshots; s++) {
+    q[s]->beginDistributeValues();
+    qdot[s]->beginDistributeValues();
+    qddot[s]->beginDistributeValues();
+    q[s]->endDistributeValues();
+    qdot[s]->endDistributeValues();
+    qddot[s]->endDistributeValues();
+
+    for (int i = 0, aux_count = 0; i < num_elements; i++) {
+      int len;
+      const int *nodes;
+      TACSElement *element = assembler->getElement(i, &len, &nodes);
+      int nvars = len * vpn;
+      assembler->getElement(i, Xpts);
+      q[s]->getValues(len, nodes, elem_vars);
+      qdot[s]->getValues(len, nodes, elem_dvars);
+      qddot[s]->getValues(len, nodes, elem_ddvars);
+
+      // Compute the static residual, the change due to the rates and
+      // the residual of the auxiliary elements and body loads
+      memset(res, 0, 3 * nvars * sizeof(TacsScalar));
+      element->addResidual(i, times[s], Xpts, elem_vars, zero, zero, res);
+      element->addResidual(i, times[s], Xpts, elem_vars, elem_dvars,
+                           elem_ddvars, &res[nvars]);
+      for (int j = 0; j < nvars; j++) {
+        res[nvars + j] -= res[j];
+      }
+      while (aux_count < naux && aux[aux_count].num < i) {
+        aux_count++;
+      }
+      while (aux_count < naux && aux[aux_count].num == i) {
+        aux[aux_count].elem->addResidual(i, times[s], Xpts, elem_vars,
+                                         elem_dvars, elem_ddvars,
+                                         &res[2 * nvars]);
+        aux_count++;
+      }
+      TACSElement *loads[2];
+      int nloads = assembler->getBodyLoads(i, loads);
+      for (int l = 0; l < nloads; l++) {
+        loads[l]->addResidual(i, times[s], Xpts, elem_vars, elem_dvars,
+                              elem_ddvars, &res[2 * nvars]);
+      }
+
+      for (int k = 0; k < basis_size; k++) {
+        basis[k]->getValues(len, nodes, Ve);
+        for (int b = 0; b < 3; b++) {
+          TacsScalar val = 0.0;
+          for (int j = 0; j < nvars; j++) {
+            val += Ve[j] * res[b * nvars + j];
+          }
+          G[ldg * i + b * nblock + basis_size * s + k] = TacsRealPart(val);
+        }
+      }
+    }
+  }
+  delete[] Xpts;
+  delete[] Ve;
+  delete[] zero;
+  delete[] res;
+
+  // Compute the target sum of the projected residuals
+  double *b = new double[ldg];
+  double *r = new double[ldg];
+  memset(r, 0, ldg * sizeof(double));
+  for (int i = 0; i < num_elements; i++) {
+    for (int j = 0; j < ldg; j++) {
+      r[j] += G[ldg * i + j];
+    }
+  }
+  MPI_Allreduce(r, b, ldg, MPI_DOUBLE, MPI_SUM, comm);
+  memcpy(r, b, ldg * sizeof(double));
+
+  double bnorm = 0.0;
+  for (int j = 0; j < ldg; j++) {
+    bnorm += b[j] * b[j];
+  }
+  bnorm = sqrt(bnorm);
+
+  // The norm of each element column and the status of each element
+  double *gnorm = new double[num_elements];
+  int *status = new int[num_elements];
+  for (int i = 0; i < num_elements; i++) {
+    double norm = 0.0;
+    for (int j = 0; j < ldg; j++) {
+      norm += G[ldg * i + j] * G[ldg * i + j];
+    }
+    gnorm[i] = sqrt(norm);
+    status[i] = (gnorm[i] > 0.0 ? 0 : -1);
+  }
+
+  // The selected columns are stored on all processors
+  int num_global;
+  MPI_Allreduce(&num_elements, &num_global, 1, MPI_INT, MPI_SUM, comm);
+  if (max_samples <= 0 || max_samples > num_global) {
+    max_samples = num_global;
+  }
+  int max_sel = (max_samples < ldg + 1 ? max_samples : ldg + 1);
+  double *Gs = new double[ldg * max_sel];
+  int *sel_rank = new int[max_sel];
+  int *sel_elem = new int[max_sel];
+  double *w = new double[max_sel];
+  int nsel = 0;
+
+  double rnorm = bnorm;
+  while (rnorm > tol * bnorm && nsel < max_sel) {
+    // Find the element most correlated with the remaining error
+    struct {
+      double val;
+      int rank;
+    } local, global;
+    local.val = 0.0;
+    local.rank = rank;
+    int best = -1;
+    for (int i = 0; i < num_elements; i++) {
+      if (status[i] == 0) {
+        double dot = 0.0;
+        for (int j = 0; j < ldg; j++) {
+          dot += G[ldg * i + j] * r[j];
+        }
+        dot /= gnorm[i];
+        if (dot > local.val) {
+          local.val = dot;
+          best = i;
+        }
+      }
+    }
+    MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+    if (global.val <= 0.0) {
+      break;
+    }
+
+    // Add the column from the owner to the selected set
+    if (rank == global.rank) {
+      memcpy(&Gs[ldg * nsel], &G[ldg * best], ldg * sizeof(double));
+      status[best] = 1;
+    }
+    MPI_Bcast(&best, 1, MPI_INT, global.rank, comm);
+    MPI_Bcast(&Gs[ldg * nsel], ldg, MPI_DOUBLE, global.rank, comm);
+    sel_rank[nsel] = global.rank;
+    sel_elem[nsel] = best;
+    nsel++;
+
+    // Compute the weights, discarding elements with negative weights
+    while (nsel > 0 && solveWeights(nsel, ldg, Gs, b, w) != 0) {
+      int n = 0;
+      for (int k = 0; k < nsel; k++) {
+        if (w[k] > 0.0) {
+          if (k != n) {
+            memcpy(&Gs[ldg * n], &Gs[ldg * k], ldg * sizeof(double));
+            sel_rank[n] = sel_rank[k];
+            sel_elem[n] = sel_elem[k];
+          }
+          n++;
+        } else if (sel_rank[k] == rank) {
+          status[sel_elem[k]] = -1;
+        }
+      }
+      nsel = n;
+    }
+
+    // Update the remaining error
+    memcpy(r, b, ldg * sizeof(double));
+    for (int k = 0; k < nsel; k++) {
+      for (int j = 0; j < ldg; j++) {
+        r[j] -= w[k] * Gs[ldg * k + j];
+      }
+    }
+    rnorm = 0.0;
+    for (int j = 0; j < ldg; j++) {
+      rnorm += r[j] * r[j];
+    }
+    rnorm = sqrt(rnorm);
+  }
+
+  if (rank == 0 && rnorm > tol * bnorm) {
+    fprintf(stderr,
+            "TACSReducedOrderModel: Sampled residual error %8.2e exceeds the "
+            "tolerance with %d elements\n",
+            rnorm / bnorm, nsel);
+  }
+
+  // Extract the elements owned by this processor
+  int nlocal = 0;
+  for (int k = 0; k < nsel; k++) {
+    if (sel_rank[k] == rank) {
+      sel_elem[nlocal] = sel_elem[k];
+      w[nlocal] = w[k];
+      nlocal++;
+    }
+  }
+
+  // Sort the local elements so the auxiliary elements can be merged
+  for (int k = 1; k < nlocal; k++) {
+    int e = sel_elem[k];
+    double we = w[k];
+    int j = k - 1;
+    for (; j >= 0 && sel_elem[j] > e; j--) {
+      sel_elem[j + 1] = sel_elem[j];
+      w[j + 1] = w[j];
+    }
+    sel_elem[j + 1] = e;
+    w[j + 1] = we;
+  }
+  setSampleElements(nlocal, sel_elem, w);
+
+  delete[] G;
+  delete[] b;
+  delete[] r;
+  delete[] gnorm;
+  delete[] status;
+  delete[] Gs;
+  delete[] sel_rank;
+  delete[] sel_elem;
+  delete[] w;
+
+  return getNumSampleElements();
+}
+
+/*
+  Solve the normal equations for the least-squares weights of the
+  selected columns with a Cholesky factorization. A small
+  regularization keeps the problem solvable when the columns are nearly
+  linearly dependent.
+
+  @return Non-zero if any weight is not positive
+*/
+int TACSReducedOrderModel::solveWeights(int n, int ldg, const double *G,
+                                        const double *b, double *w) {
+  double *A = new double[n * n];
+  double max_diag = 0.0;
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k <= i; k++) {
+      double a = 0.0;
+      for (int j = 0; j < ldg; j++) {
+        a += G[ldg * i + j] * G[ldg * k + j];
+      }
+      A[n * i + k] = a;
+    }
+    double rhs = 0.0;
+    for (int j = 0; j < ldg; j++) {
+      rhs += G[ldg * i + j] * b[j];
+    }
+    w[i] = rhs;
+    if (A[(n + 1) * i] > max_diag) {
+      max_diag = A[(n + 1) * i];
+    }
+  }
+
+  // Factor A = L*L^{T} in the lower triangle
+  for (int i = 0; i < n; i++) {
+    A[(n + 1) * i] += 1e-12 * max_diag;
+  }
+  for (int k = 0; k < n; k++) {
+    double d = A[(n + 1) * k];
+    for (int j = 0; j < k; j++) {
+      d -= A[n * k + j] * A[n * k + j];
+    }
+    d = (d > 0.0 ? sqrt(d) : 1e-300);
+    A[(n + 1) * k] = d;
+    for (int i = k + 1; i < n; i++) {
+      double a = A[n * i + k];
+      for (int j = 0; j < k; j++) {
+        a -= A[n * i + j] * A[n * k + j];
+      }
+      A[n * i + k] = a / d;
+    }
+  }
+
+  // Solve L*L^{T}*w = rhs
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < i; j++) {
+      w[i] -= A[n * i + j] * w[j];
+    }
+    w[i] /= A[(n + 1) * i];
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    for (int j = i + 1; j < n; j++) {
+      w[i] -= A[n * j + i] * w[j];
+    }
+    w[i] /= A[(n + 1) * i];
+  }
+  delete[] A;
+
+  int fail = 0;
+  for (int i = 0; i < n; i++) {
+    if (w[i] <= 0.0) {
+      fail = 1;
+    }
+  }
+  return fail;
+}
+
+/*
+  Set the elements used in the reduced model and gather the basis at
+  their nodes
+*/
+void TACSReducedOrderModel::setSampleElements(int num, const int *elems,
+                                              const double *weights) {
+  delete[] sample_elems;
+  delete[] sample_weights;
+  delete[] sample_ptr;
+  delete[] xpt_ptr;
+  delete[] sample_basis;
+  delete[] sample_vars;
+  delete[] sample_dvars;
+  delete[] sample_ddvars;
+  delete[] sample_xpts;
+
+  int vpn = assembler->getVarsPerNode();
+  num_samples = num;
+  sample_elems = new int[num_samples];
+  sample_weights = new double[num_samples];
+  sample_ptr = new int[num_samples + 1];
+  xpt_ptr = new int[num_samples + 1];
+  sample_ptr[0] = xpt_ptr[0] = 0;
+  for (int i = 0; i < num_samples; i++) {
+    int len;
+    assembler->getElement(elems[i], &len, NULL);
+    sample_elems[i] = elems[i];
+    sample_weights[i] = weights[i];
+    sample_ptr[i + 1] = sample_ptr[i] + len * vpn;
+    xpt_ptr[i + 1] = xpt_ptr[i] + 3 * len;
+  }
+
+  int size = sample_ptr[num_samples];
+  sample_basis = new TacsScalar[size * (basis_size > 0 ? basis_size : 1)];
+  sample_vars = new TacsScalar[size];
+  sample_dvars = new TacsScalar[size];
+  sample_ddvars = new TacsScalar[size];
+  sample_xpts = new TacsScalar[xpt_ptr[num_samples]];
+  memset(sample_vars, 0, size * sizeof(TacsScalar));
+  memset(sample_dvars, 0, size * sizeof(TacsScalar));
+  memset(sample_ddvars, 0, size * sizeof(TacsScalar));
+
+  // Store the basis at each element as a row-major nvars x basis_size
+  // matrix
+  for (int i = 0; i < num_samples; i++) {
+    int len;
+    const int *nodes;
+    assembler->getElement(sample_elems[i], &len, &nodes);
+    int nvars = sample_ptr[i + 1] - sample_ptr[i];
+    TacsScalar *Ve = &sample_basis[basis_size * sample_ptr[i]];
+    for (int k = 0; k < basis_size; k++) {
+      basis[k]->getValues(len, nodes, elem_vars);
+      for (int j = 0; j < nvars; j++) {
+        Ve[basis_size * j + k] = elem_vars[j];
+      }
+    }
+  }
+}
+
+/*
+  Get the basis vector
+*/
+TACSBVec *TACSReducedOrderModel::getBasisVec(int i) {
+  if (i >= 0 && i < basis_size) {
+    return basis[i];
+  }
+  return NULL;
+}
+
+/*
+  Get the number of sampled elements across all processors
+*/
+int TACSReducedOrderModel::getNumSampleElements() {
+  int num = 0;
+  MPI_Allreduce(&num_samples, &num, 1, MPI_INT, MPI_SUM,
+                assembler->getMPIComm());
+  return num;
+}
+
+/*
+  Get the singular values of the snapshots in descending order
+
+  @return The number of singular values
+*/
+int TACSReducedOrderModel::getSingularValues(const double **_sigma) {
+  if (_sigma) {
+    *_sigma = sigma;
+  }
+  return num_sigma;
+}
+
+/*
+  Project the vector onto the basis: a = V^{T}*vec
+*/
+void TACSReducedOrderModel::projectVec(TACSBVec *vec, TacsScalar *a) {
+  if (basis_size > 0) {
+    vec->mdot((TACSVec **)basis, a, basis_size);
+  }
+}
+
+/*
+  Add the reduced vector to the full vector: vec += scale*V*a
+*/
+void TACSReducedOrderModel::addBasisVecs(TacsScalar scale, const TacsScalar *a,
+                                         TACSBVec *vec) {
+  for (int k = 0; k < basis_size; k++) {
+    vec->axpy(scale * a[k], basis[k]);
+  }
+}
+
+/*
+  Set the base state of the affine space used by the reduced model and
+  gather it at the sampled elements
+
+  @param q The base state
+  @param qdot The first time derivative of the base state
+  @param qddot The second time derivative of the base state
+*/
+void TACSReducedOrderModel::setBaseState(TACSBVec *q, TACSBVec *qdot,
+                                         TACSBVec *qddot) {
+  q->beginDistributeValues();
+  qdot->beginDistributeValues();
+  qddot->beginDistributeValues();
+  q->endDistributeValues();
+  qdot->endDistributeValues();
+  qddot->endDistributeValues();
+
+  for (int i = 0; i < num_samples; i++) {
+    int len;
+    const int *nodes;
+    assembler->getElement(sample_elems[i], &len, &nodes);
+    q->getValues(len, nodes, &sample_vars[sample_ptr[i]]);
+    qdot->getValues(len, nodes, &sample_dvars[sample_ptr[i]]);
+    qddot->getValues(len, nodes, &sample_ddvars[sample_ptr[i]]);
+    assembler->getElement(sample_elems[i], &sample_xpts[xpt_ptr[i]]);
+  }
+}
+
+/*
+  Assemble the reduced residual and Jacobian at the state
+
+  q = q0 + V*a, qdot = qdot0 + beta*V*a, qddot = qddot0 + gamma*V*a
+
+  over the sampled elements. The results are summed across all
+  processors.
+
+  @param time The simulation time
+  @param alpha The coefficient of the stiffness matrix
+  @param beta The coefficient of the damping matrix
+  @param gamma The coefficient of the mass matrix
+  @param a The reduced coordinates relative to the base state
+  @param res The reduced residual
+  @param jac The reduced Jacobian in row-major order (may be NULL)
+*/
+void TACSReducedOrderModel::assembleReducedJacobian(
+    double time, TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+    const TacsScalar *a, TacsScalar *res, TacsScalar *jac) {
+  int r = basis_size;
+  TacsScalar *local = new TacsScalar[r * (r + 1)];
+  memset(local, 0, r * (r + 1) * sizeof(TacsScalar));
+
+  TACSAuxElements *aux_elements = assembler->getAuxElements();
+  TACSAuxElem *aux = NULL;
+  int naux = 0, aux_count = 0;
+  if (aux_elements) {
+    naux = aux_elements->getAuxElements(&aux);
+  }
+
+  for (int i = 0; i < num_samples; i++) {
+    int elem = sample_elems[i];
+    int nvars;
+    const TacsScalar *Ve = &sample_basis[r * sample_ptr[i]];
+    const TacsScalar *Xpts = &sample_xpts[xpt_ptr[i]];
+    TACSElement *element = assembler->getElement(elem, &nvars, NULL);
+    nvars = sample_ptr[i + 1] - sample_ptr[i];
+
+    // Compute the element states
+    for (int j = 0; j < nvars; j++) {
+      TacsScalar va = 0.0;
+      for (int k = 0; k < r; k++) {
+        va += Ve[r * j + k] * a[k];
+      }
+      elem_vars[j] = sample_vars[sample_ptr[i] + j] + va;
+      elem_dvars[j] = sample_dvars[sample_ptr[i] + j] + beta * va;
+      elem_ddvars[j] = sample_ddvars[sample_ptr[i] + j] + gamma * va;
+    }
+
+    memset(elem_res, 0, nvars * sizeof(TacsScalar));
+    if (jac) {
+      memset(elem_mat, 0, nvars * nvars * sizeof(TacsScalar));
+      element->addJacobian(elem, time, alpha, beta, gamma, Xpts, elem_vars,
+                           elem_dvars, elem_ddvars, elem_res, elem_mat);
+    } else {
+      element->addResidual(elem, time, Xpts, elem_vars, elem_dvars,
+                           elem_ddvars, elem_res);
+    }
+
+    // Add the auxiliary elements, which are sorted by element number
+    while (aux_count < naux && aux[aux_count].num < elem) {
+      aux_count++;
+    }
+    while (aux_count < naux && aux[aux_count].num == elem) {
+      if (jac) {
+        aux[aux_count].elem->addJacobian(elem, time, alpha, beta, gamma, Xpts,
+                                         elem_vars, elem_dvars, elem_ddvars,
+                                         elem_res, elem_mat);
+      } else {
+        aux[aux_count].elem->addResidual(elem, time, Xpts, elem_vars,
+                                         elem_dvars, elem_ddvars, elem_res);
+      }
+      aux_count++;
+    }
+
+    // Add the body loads applied within the element loops
+    TACSElement *loads[2];
+    int nloads = assembler->getBodyLoads(elem, loads);
+    for (int l = 0; l < nloads; l++) {
+      if (jac) {
+        loads[l]->addJacobian(elem, time, alpha, beta, gamma, Xpts, elem_vars,
+                              elem_dvars, elem_ddvars, elem_res, elem_mat);
+      } else {
+        loads[l]->addResidual(elem, time, Xpts, elem_vars, elem_dvars,
+                              elem_ddvars, elem_res);
+      }
+    }
+
+    // Add w*V^{T}*R to the reduced residual
+    TacsScalar w = sample_weights[i];
+    for (int j = 0; j < nvars; j++) {
+      for (int k = 0; k < r; k++) {
+        local[k] += w * Ve[r * j + k] * elem_res[j];
+      }
+    }
+
+    if (jac) {
+      // Compute J*V and add w*V^{T}*J*V to the reduced Jacobian
+      memset(elem_jv, 0, nvars * r * sizeof(TacsScalar));
+      for (int j = 0; j < nvars; j++) {
+        for (int l = 0; l < nvars; l++) {
+          TacsScalar m = elem_mat[nvars * j + l];
+          if (m != 0.0) {
+            for (int k = 0; k < r; k++) {
+              elem_jv[r * j + k] += m * Ve[r * l + k];
+            }
+          }
+        }
+      }
+      TacsScalar *J = &local[r];
+      for (int j = 0; j < nvars; j++) {
+        for (int k = 0; k < r; k++) {
+          TacsScalar v = w * Ve[r * j + k];
+          for (int l = 0; l < r; l++) {
+            J[r * k + l] += v * elem_jv[r * j + l];
+          }
+        }
+      }
+    }
+  }
+
+  // Sum the contributions from all processors
+  TacsScalar *global = new TacsScalar[r * (r + 1)];
+  int size = (jac ? r * (r + 1) : r);
+  MPI_Allreduce(local, global, size, TACS_MPI_TYPE, MPI_SUM,
+                assembler->getMPIComm());
+  memcpy(res, global, r * sizeof(TacsScalar));
+  if (jac) {
+    memcpy(jac, &global[r], r * r * sizeof(TacsScalar));
+  }
+  delete[] local;
+  delete[] global;
+}
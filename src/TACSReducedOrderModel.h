@@ -0,0 +1,113 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_REDUCED_ORDER_MODEL_H
+#define TACS_REDUCED_ORDER_MODEL_H
+
+#include "TACSAssembler.h"
+
+/*
+  A hyper-reduced POD-Galerkin model of the time-dependent residual
+
+  The basis V is computed from state snapshots with a randomized SVD
+  performed directly on the distributed vectors. The states are
+  restricted to the affine space
+
+  q = q0 + V*a,  qdot = qdot0 + beta*V*a,  qddot = qddot0 + gamma*V*a
+
+  about a base state (for instance the predictor of a time step), and
+  the reduced residual and Jacobian
+
+  r = sum_{e in S} w[e] V[e]^{T} R[e]
+  J = sum_{e in S} w[e] V[e]^{T} (alpha*K[e] + beta*C[e] + gamma*M[e]) V[e]
+
+  are evaluated over a sampled subset of elements S with non-negative
+  weights w. The sampled elements are selected greedily so that the
+  weighted sums reproduce the projected static, time-dependent and
+  auxiliary element and body load residuals at a set of training snapshots
+  (energy-conserving sampling and weighting). Until the
+  samples are computed, all elements are used with unit weight.
+
+  The basis vectors are zero at the Dirichlet boundary conditions, so
+  the base state must satisfy the boundary conditions.
+*/
+class TACSReducedOrderModel : public TACSObject {
+ public:
+  TACSReducedOrderModel(TACSAssembler *_assembler, int _max_basis_size,
+                        int _oversample = 10);
+  ~TACSReducedOrderModel();
+
+  // Compute the basis and the sampled elements from snapshots
+  // ---------------------------------------------------------
+  int computeBasis(int num_snapshots, TACSBVec **snapshots, TACSBVec *qref,
+                   double energy_tol = 1e-8);
+  int computeSampleElements(int num_snapshots, const double *times,
+                            TACSBVec **q, TACSBVec **qdot, TACSBVec **qddot,
+                            double tol = 1e-3, int max_samples = 0);
+
+  // Get information about the reduced model
+  // ---------------------------------------
+  int getBasisSize() { return basis_size; }
+  TACSBVec *getBasisVec(int i);
+  int getNumSampleElements();
+  int getSingularValues(const double **_sigma);
+
+  // Map between the full and reduced spaces
+  // ---------------------------------------
+  void projectVec(TACSBVec *vec, TacsScalar *a);
+  void addBasisVecs(TacsScalar scale, const TacsScalar *a, TACSBVec *vec);
+
+  // Evaluate the reduced residual and Jacobian about a base state
+  // -------------------------------------------------------------
+  void setBaseState(TACSBVec *q, TACSBVec *qdot, TACSBVec *qddot);
+  void assembleReducedJacobian(double time, TacsScalar alpha, TacsScalar beta,
+                               TacsScalar gamma, const TacsScalar *a,
+                               TacsScalar *res, TacsScalar *jac);
+
+ private:
+  // Set the elements used by the reduced model and gather the basis
+  void setSampleElements(int num, const int *elems, const double *weights);
+
+  // Solve the non-negative least-squares problem for the weights
+  int solveWeights(int num, int ldg, const double *G, const double *b,
+                   double *w);
+
+  // The finite-element model
+  TACSAssembler *assembler;
+
+  // The basis vectors and the singular values of the snapshots
+  int max_basis_size, oversample;
+  int basis_size;
+  TACSBVec **basis;
+  int num_sigma;
+  double *sigma;
+
+  // The sampled elements on this processor and their weights
+  int num_samples;
+  int *sample_elems;
+  double *sample_weights;
+  int *sample_ptr;  // Offset into the arrays of element variables
+  int *xpt_ptr;     // Offset into the array of element nodes
+
+  // The basis and the base state restricted to the sampled elements
+  TacsScalar *sample_basis;
+  TacsScalar *sample_vars, *sample_dvars, *sample_ddvars;
+  TacsScalar *sample_xpts;
+
+  // Temporary element data
+  TacsScalar *elem_vars, *elem_dvars, *elem_ddvars;
+  TacsScalar *elem_res, *elem_mat, *elem_jv;
+};
+
+#endif  // TACS_REDUCED_ORDER_MODEL_H
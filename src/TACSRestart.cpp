@@ -0,0 +1,189 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSRestart.h"
+
+/*
+  The preamble at the beginning of each restart file
+*/
+struct TACSRestartPreamble {
+  char magic[8];    // Identifies the file as a TACS restart file
+  char kind[32];    // The kind of solver that wrote the file
+  int version;      // The version of the file format
+  int mpi_size;     // The number of processors that wrote the file
+  int scalar_size;  // sizeof(TacsScalar) when the file was written
+  int header_size;  // The size of the header block in bytes
+};
+
+static const char tacs_restart_magic[8] = "TACSRST";
+static const int tacs_restart_version = 1;
+
+TACSRestartFile::TACSRestartFile(MPI_Comm _comm, const char *filename,
+                                 RestartMode mode) {
+  comm = _comm;
+  fp = NULL;
+  offset = 0;
+
+  // Copy the filename
+  char *fname = new char[strlen(filename) + 1];
+  strcpy(fname, filename);
+
+  if (mode == WRITE) {
+    // Remove any existing file so that no stale data is left at the end
+    MPI_File_delete(fname, MPI_INFO_NULL);
+    MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                  MPI_INFO_NULL, &fp);
+  } else {
+    MPI_File_open(comm, fname, MPI_MODE_RDONLY, MPI_INFO_NULL, &fp);
+  }
+
+  delete[] fname;
+}
+
+TACSRestartFile::~TACSRestartFile() {
+  if (fp) {
+    MPI_File_close(&fp);
+  }
+}
+
+/*
+  Write the preamble and the header block from the root processor
+
+  @param kind The name of the solver that writes the file
+  @param header The header data
+  @param size The size of the header in bytes
+  @return Zero on success
+*/
+int TACSRestartFile::writeHeader(const char *kind, const void *header,
+                                 int size) {
+  if (!fp) {
+    return 1;
+  }
+
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  TACSRestartPreamble pre;
+  memset(&pre, 0, sizeof(pre));
+  memcpy(pre.magic, tacs_restart_magic, sizeof(pre.magic));
+  strncpy(pre.kind, kind, sizeof(pre.kind) - 1);
+  pre.version = tacs_restart_version;
+  pre.mpi_size = mpi_size;
+  pre.scalar_size = sizeof(TacsScalar);
+  pre.header_size = size;
+
+  char datarep[] = "native";
+  MPI_File_set_view(fp, offset, MPI_BYTE, MPI_BYTE, datarep, MPI_INFO_NULL);
+  if (mpi_rank == 0) {
+    MPI_File_write_at(fp, 0, &pre, sizeof(pre), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, sizeof(pre), (void *)header, size, MPI_BYTE,
+                      MPI_STATUS_IGNORE);
+  }
+  offset += sizeof(pre) + size;
+
+  return 0;
+}
+
+/*
+  Read the preamble and the header block on the root processor and
+  broadcast them to all processors
+
+  The read fails if the file was not written by the same kind of
+  solver, with a different number of processors or scalar type, or
+  with a different header size.
+
+  @param kind The name of the solver that reads the file
+  @param header The header data
+  @param size The size of the header in bytes
+  @return Zero on success
+*/
+int TACSRestartFile::readHeader(const char *kind, void *header, int size) {
+  if (!fp) {
+    return 1;
+  }
+
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  TACSRestartPreamble pre;
+  memset(&pre, 0, sizeof(pre));
+
+  char datarep[] = "native";
+  MPI_File_set_view(fp, offset, MPI_BYTE, MPI_BYTE, datarep, MPI_INFO_NULL);
+  if (mpi_rank == 0) {
+    MPI_File_read_at(fp, 0, &pre, sizeof(pre), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+  MPI_Bcast(&pre, sizeof(pre), MPI_BYTE, 0, comm);
+  pre.kind[sizeof(pre.kind) - 1] = '\0';
+
+  int fail = 0;
+  if (memcmp(pre.magic, tacs_restart_magic, sizeof(pre.magic)) != 0 ||
+      pre.version != tacs_restart_version) {
+    if (mpi_rank == 0) {
+      fprintf(stderr, "TACSRestartFile: Not a TACS restart file\n");
+    }
+    fail = 1;
+  } else if (strcmp(pre.kind, kind) != 0 || pre.header_size != size) {
+    if (mpi_rank == 0) {
+      fprintf(stderr,
+              "TACSRestartFile: File written by %s cannot be read by %s\n",
+              pre.kind, kind);
+    }
+    fail = 1;
+  } else if (pre.mpi_size != mpi_size ||
+             pre.scalar_size != (int)sizeof(TacsScalar)) {
+    if (mpi_rank == 0) {
+      fprintf(stderr,
+              "TACSRestartFile: File written with %d processors and "
+              "scalar size %d, cannot read with %d processors and scalar "
+              "size %d\n",
+              pre.mpi_size, pre.scalar_size, mpi_size,
+              (int)sizeof(TacsScalar));
+    }
+    fail = 1;
+  }
+
+  if (!fail) {
+    if (mpi_rank == 0) {
+      MPI_File_read_at(fp, sizeof(pre), header, size, MPI_BYTE,
+                       MPI_STATUS_IGNORE);
+    }
+    MPI_Bcast(header, size, MPI_BYTE, 0, comm);
+    offset += sizeof(pre) + size;
+  }
+
+  return fail;
+}
+
+/*
+  Write the next vector to the file
+*/
+int TACSRestartFile::writeVec(TACSBVec *vec) {
+  if (!fp) {
+    return 1;
+  }
+  return vec->writeToFile(fp, &offset);
+}
+
+/*
+  Read the next vector from the file
+*/
+int TACSRestartFile::readVec(TACSBVec *vec) {
+  if (!fp) {
+    return 1;
+  }
+  return vec->readFromFile(fp, &offset);
+}
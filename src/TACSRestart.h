@@ -0,0 +1,62 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_RESTART_H
+#define TACS_RESTART_H
+
+#include "TACSBVec.h"
+
+/*
+  A collective restart file that stores a header block followed by a
+  sequence of distributed vectors
+
+  The file is written with MPI file I/O in the native representation.
+  Each file begins with a fixed preamble that records the kind of
+  solver that wrote it, the number of processors, the size of the
+  scalar type and the size of the header block. The header block is a
+  plain struct defined by the solver, which is written by the root
+  processor and broadcast on reading. The vectors follow in the order
+  they were written, each in the format of TACSBVec::writeToFile().
+
+  The vectors are stored in the parallel ordering of the variables, so
+  a restart file must be read with the same number of processors and
+  the same ordering as when it was written. All calls are collective.
+*/
+class TACSRestartFile : public TACSObject {
+ public:
+  enum RestartMode { READ, WRITE };
+
+  TACSRestartFile(MPI_Comm _comm, const char *filename, RestartMode mode);
+  ~TACSRestartFile();
+
+  // Check whether the file was opened successfully
+  int isOpen() { return fp != NULL; }
+
+  // Write/read the header block. The kind and size must match on read
+  // -----------------------------------------------------------------
+  int writeHeader(const char *kind, const void *header, int size);
+  int readHeader(const char *kind, void *header, int size);
+
+  // Write/read the vectors in sequence
+  // ----------------------------------
+  int writeVec(TACSBVec *vec);
+  int readVec(TACSBVec *vec);
+
+ private:
+  MPI_Comm comm;
+  MPI_File fp;
+  MPI_Offset offset;
+};
+
+#endif  // TACS_RESTART_H
@@ -0,0 +1,150 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSScratchArena.h"
+
+#include "TACSMemory.h"
+
+// The arena for each thread, freed when the thread exits
+static thread_local TACSScratchArena tacs_thread_arena;
+
+/*
+  Create an empty arena. No memory is allocated until it is needed.
+*/
+TACSScratchArena::TACSScratchArena() {
+  num_blocks = 0;
+  current = 0;
+  offset = 0;
+  capacity = 0;
+  recorded = 0;
+}
+
+/*
+  Free the blocks held by the arena
+*/
+TACSScratchArena::~TACSScratchArena() {
+  for (int i = 0; i < num_blocks; i++) {
+    free(blocks[i]);
+  }
+  TACSMemory::update(TACS_MEMORY_SCRATCH, &recorded, 0);
+}
+
+/*
+  Get the arena for the calling thread
+*/
+TACSScratchArena *TACSScratchArena::getThreadArena() {
+  return &tacs_thread_arena;
+}
+
+/*
+  Add a block with at least the given number of bytes to the end of
+  the list of blocks
+
+  @param bytes The minimum size of the block
+  @return 1 if the block was added, 0 otherwise
+*/
+int TACSScratchArena::addBlock(size_t bytes) {
+  if (num_blocks >= MAX_NUM_BLOCKS) {
+    return 0;
+  }
+
+  size_t size = (capacity > MIN_BLOCK_SIZE ? capacity : MIN_BLOCK_SIZE);
+  if (size < bytes) {
+    size = bytes;
+  }
+  void *ptr = NULL;
+  if (posix_memalign(&ptr, ALIGNMENT, size) != 0) {
+    return 0;
+  }
+
+  blocks[num_blocks] = (char *)ptr;
+  block_sizes[num_blocks] = size;
+  num_blocks++;
+  capacity += size;
+  TACSMemory::update(TACS_MEMORY_SCRATCH, &recorded, capacity);
+
+  return 1;
+}
+
+/*
+  Allocate an array from the top of the stack
+
+  The array remains valid until the scope in which it was allocated
+  is released.
+
+  @param bytes The number of bytes to allocate
+  @return The array, or NULL if the memory could not be allocated
+*/
+void *TACSScratchArena::allocate(size_t bytes) {
+  // Round up the size so that the next array is also aligned
+  bytes = ALIGNMENT * ((bytes + ALIGNMENT - 1) / ALIGNMENT);
+
+  // Move to the first block with enough space
+  while (current < num_blocks && offset + bytes > block_sizes[current]) {
+    current++;
+    offset = 0;
+  }
+  if (current >= num_blocks) {
+    if (!addBlock(bytes)) {
+      fprintf(stderr, "TACSScratchArena: Failed to allocate %zu bytes\n",
+              bytes);
+      return NULL;
+    }
+    current = num_blocks - 1;
+    offset = 0;
+  }
+
+  void *ptr = &blocks[current][offset];
+  offset += bytes;
+  return ptr;
+}
+
+/*
+  Get the current top of the stack
+
+  @param block The block at the top of the stack
+  @param offset The offset within the block
+*/
+void TACSScratchArena::getMark(int *_block, size_t *_offset) {
+  *_block = current;
+  *_offset = offset;
+}
+
+/*
+  Release all arrays allocated after the mark
+
+  When the stack is empty and the arena holds more than one block, the
+  blocks are merged so that the next loop fits in a single block.
+
+  @param block The block at the mark
+  @param offset The offset within the block at the mark
+*/
+void TACSScratchArena::release(int _block, size_t _offset) {
+  current = _block;
+  offset = _offset;
+
+  if (current == 0 && offset == 0 && num_blocks > 1) {
+    size_t size = capacity;
+    for (int i = 0; i < num_blocks; i++) {
+      free(blocks[i]);
+    }
+    num_blocks = 0;
+    capacity = 0;
+    addBlock(size);
+  }
+}
@@ -0,0 +1,116 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_SCRATCH_ARENA_H
+#define TACS_SCRATCH_ARENA_H
+
+#include "TACSObject.h"
+
+/*
+  A stack allocator for the temporary arrays used within the element
+  loops
+
+  Each thread has its own arena, obtained with getThreadArena(), so no
+  locking is required. Arrays are taken from the top of the stack and
+  are released together when the enclosing TACSScratchScope goes out
+  of scope. The storage is kept between calls, so that once the arena
+  has grown to the size needed by the largest loop, the loops make no
+  further heap allocations.
+
+  The arena grows by adding a block at least as large as the current
+  capacity. The arrays in the existing blocks are not moved. When the
+  outermost scope is released, the blocks are merged into a single
+  block of the total capacity.
+
+  Element implementations may take their temporaries from the arena
+  of the calling thread in the same way as the assembler:
+
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(size);
+*/
+class TACSScratchArena {
+ public:
+  TACSScratchArena();
+  ~TACSScratchArena();
+
+  // Allocate arrays aligned to the cache line size
+  // ----------------------------------------------
+  void *allocate(size_t bytes);
+  TacsScalar *allocScalars(int n) {
+    return (TacsScalar *)allocate(n * sizeof(TacsScalar));
+  }
+  int *allocInts(int n) { return (int *)allocate(n * sizeof(int)); }
+
+  // Mark the top of the stack and release the arrays after a mark
+  // --------------------------------------------------------------
+  void getMark(int *block, size_t *offset);
+  void release(int block, size_t offset);
+
+  // Get the number of bytes held by the arena
+  size_t getCapacity() { return capacity; }
+
+  // Get the arena for the calling thread
+  static TACSScratchArena *getThreadArena();
+
+ private:
+  static const int MAX_NUM_BLOCKS = 32;
+  static const size_t ALIGNMENT = 64;
+  static const size_t MIN_BLOCK_SIZE = 65536;
+
+  // Add a block with at least the given number of bytes
+  int addBlock(size_t bytes);
+
+  int num_blocks;                       // The number of blocks
+  char *blocks[MAX_NUM_BLOCKS];         // The blocks of memory
+  size_t block_sizes[MAX_NUM_BLOCKS];   // The size of each block
+  int current;                          // The block at the top
+  size_t offset;                        // The top within the block
+  size_t capacity;                      // The total size of the blocks
+  size_t recorded;                      // The bytes recorded in TACSMemory
+};
+
+/*
+  A scope within the scratch arena
+
+  The top of the stack is recorded when the scope is created and
+  restored when the scope is destroyed. If no arena is provided, the
+  arena of the calling thread is used.
+*/
+class TACSScratchScope {
+ public:
+  TACSScratchScope(TACSScratchArena *_arena = NULL) {
+    arena = (_arena ? _arena : TACSScratchArena::getThreadArena());
+    arena->getMark(&block, &offset);
+  }
+  ~TACSScratchScope() { arena->release(block, offset); }
+
+  TacsScalar *allocScalars(int n) { return arena->allocScalars(n); }
+  int *allocInts(int n) { return arena->allocInts(n); }
+  TACSScratchArena *getArena() { return arena; }
+
+ private:
+  // The scope cannot be copied
+  TACSScratchScope(const TACSScratchScope &);
+  TACSScratchScope &operator=(const TACSScratchScope &);
+
+  TACSScratchArena *arena;
+  int block;
+  size_t offset;
+};
+
+#endif  // TACS_SCRATCH_ARENA_H
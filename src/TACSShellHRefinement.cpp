@@ -0,0 +1,963 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSShellHRefinement.h"
+
+/*
+  The corner nodes of each edge of a quadrilateral element in the
+  tensor-product ordering. The first two edges run along the first
+  parametric direction and the last two along the second.
+*/
+static const int tacs_quad_edge_corners[] = {0, 1, 2, 3, 0, 2, 1, 3};
+
+/*
+  The maximum number of independent nodes used to interpolate a node
+*/
+static const int TACS_MAX_NODE_WEIGHTS = 32;
+
+/*
+  Compare two edges, stored as (n0, n1, ...), by their nodes
+*/
+static int compare_edges(const void *a, const void *b) {
+  const int *ea = static_cast<const int *>(a);
+  const int *eb = static_cast<const int *>(b);
+  if (ea[0] != eb[0]) {
+    return ea[0] - eb[0];
+  }
+  return ea[1] - eb[1];
+}
+
+/**
+  Create the h-refinement object from a serial quadrilateral mesh
+
+  The mesh is only required on the root processor. All other
+  processors may pass zero nodes and elements.
+
+  @param comm The MPI communicator
+  @param vars_per_node The number of variables at each node
+  @param num_nodes The number of nodes
+  @param num_elements The number of elements
+  @param elem_conn The four corner nodes of each element
+  @param Xpts The locations of the nodes
+  @param elem_comps The component number of each element (NULL for 0)
+*/
+TACSShellHRefinement::TACSShellHRefinement(
+    MPI_Comm _comm, int _vars_per_node, int _num_nodes, int _num_elements,
+    const int *_elem_conn, const TacsScalar *_Xpts, const int *_elem_comps) {
+  comm = _comm;
+  vars_per_node = _vars_per_node;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  num_nodes = 0;
+  Xpts = NULL;
+  node_parents = NULL;
+  node_bcs = NULL;
+
+  num_elements = 0;
+  elem_conn = NULL;
+  elem_comps = NULL;
+  elem_levels = NULL;
+  elem_part = NULL;
+
+  if (rank == 0) {
+    num_nodes = _num_nodes;
+    Xpts = new TacsScalar[3 * num_nodes];
+    memcpy(Xpts, _Xpts, 3 * num_nodes * sizeof(TacsScalar));
+
+    node_parents = new int[4 * num_nodes];
+    node_bcs = new int[num_nodes];
+    for (int i = 0; i < 4 * num_nodes; i++) {
+      node_parents[i] = -1;
+    }
+    memset(node_bcs, 0, num_nodes * sizeof(int));
+
+    num_elements = _num_elements;
+    elem_conn = new int[4 * num_elements];
+    memcpy(elem_conn, _elem_conn, 4 * num_elements * sizeof(int));
+
+    elem_comps = new int[num_elements];
+    if (_elem_comps) {
+      memcpy(elem_comps, _elem_comps, num_elements * sizeof(int));
+    } else {
+      memset(elem_comps, 0, num_elements * sizeof(int));
+    }
+
+    elem_levels = new int[num_elements];
+    memset(elem_levels, 0, num_elements * sizeof(int));
+  }
+
+  num_comps = 0;
+  elements = NULL;
+
+  max_level = 8;
+  repartition_tol = 0.1;
+
+  creator = NULL;
+  node_nums = NULL;
+  num_indep_nodes = 0;
+  num_dep_nodes = 0;
+
+  prev_creator = NULL;
+  prev_num_nodes = 0;
+  prev_node_nums = NULL;
+}
+
+TACSShellHRefinement::~TACSShellHRefinement() {
+  delete[] Xpts;
+  delete[] node_parents;
+  delete[] node_bcs;
+  delete[] elem_conn;
+  delete[] elem_comps;
+  delete[] elem_levels;
+  delete[] elem_part;
+  delete[] node_nums;
+  delete[] prev_node_nums;
+
+  if (elements) {
+    for (int i = 0; i < num_comps; i++) {
+      if (elements[i]) {
+        elements[i]->decref();
+      }
+    }
+    delete[] elements;
+  }
+
+  if (creator) {
+    creator->decref();
+  }
+  if (prev_creator) {
+    prev_creator->decref();
+  }
+}
+
+/**
+  Set the boundary conditions on the initial nodes (root only)
+
+  The boundary conditions are applied to the nodes created along an
+  edge when both nodes of the edge are constrained. The variables
+  constrained on the edge are those constrained at both nodes. This
+  must be called before the mesh is refined.
+
+  @param num_bcs The number of nodes with boundary conditions
+  @param bc_nodes The node numbers
+  @param bc_ptr Pointer into the variable array (NULL for all variables)
+  @param bc_vars The constrained variables at each node
+*/
+void TACSShellHRefinement::setBoundaryConditions(int _num_bcs,
+                                                 const int *_bc_nodes,
+                                                 const int *_bc_ptr,
+                                                 const int *_bc_vars) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank != 0) {
+    return;
+  }
+
+  memset(node_bcs, 0, num_nodes * sizeof(int));
+  for (int i = 0; i < _num_bcs; i++) {
+    int node = _bc_nodes[i];
+    if (_bc_ptr) {
+      for (int j = _bc_ptr[i]; j < _bc_ptr[i + 1]; j++) {
+        node_bcs[node] |= 1 << _bc_vars[j];
+      }
+    } else {
+      node_bcs[node] = (1 << vars_per_node) - 1;
+    }
+  }
+}
+
+/**
+  Set the element for each component (all processors)
+
+  @param num_comps The number of components
+  @param elements The element for each component
+*/
+void TACSShellHRefinement::setElements(int _num_comps,
+                                       TACSElement **_elements) {
+  for (int i = 0; i < _num_comps; i++) {
+    if (_elements[i]) {
+      _elements[i]->incref();
+    }
+  }
+  if (elements) {
+    for (int i = 0; i < num_comps; i++) {
+      if (elements[i]) {
+        elements[i]->decref();
+      }
+    }
+    delete[] elements;
+  }
+
+  num_comps = _num_comps;
+  elements = new TACSElement *[num_comps];
+  memcpy(elements, _elements, num_comps * sizeof(TACSElement *));
+}
+
+/**
+  Get the nodes of the current mesh (root only)
+
+  @param Xpts The node locations
+  @return The number of nodes
+*/
+int TACSShellHRefinement::getNumNodes(const TacsScalar **_Xpts) {
+  if (_Xpts) {
+    *_Xpts = Xpts;
+  }
+  return num_nodes;
+}
+
+/**
+  Get the elements of the current mesh (root only)
+
+  @param elem_conn The four corner nodes of each element
+  @param elem_levels The refinement level of each element
+  @return The number of elements
+*/
+int TACSShellHRefinement::getElements(const int **_elem_conn,
+                                      const int **_elem_levels) {
+  if (_elem_conn) {
+    *_elem_conn = elem_conn;
+  }
+  if (_elem_levels) {
+    *_elem_levels = elem_levels;
+  }
+  return num_elements;
+}
+
+/**
+  Get the number of independent and dependent nodes in the last mesh
+  created on the root processor
+
+  @param num_indep_nodes The number of independent nodes
+  @param num_dep_nodes The number of dependent nodes
+*/
+void TACSShellHRefinement::getNumMeshNodes(int *_num_indep_nodes,
+                                           int *_num_dep_nodes) {
+  if (_num_indep_nodes) {
+    *_num_indep_nodes = num_indep_nodes;
+  }
+  if (_num_dep_nodes) {
+    *_num_dep_nodes = num_dep_nodes;
+  }
+}
+
+/*
+  Find the edges of the elements (root only)
+
+  Each edge is stored as (n0, n1, elem, edge) with its lowest node
+  number first, and the edges are sorted by their nodes.
+*/
+int *TACSShellHRefinement::computeEdges() {
+  int *edges = new int[16 * num_elements];
+  for (int i = 0; i < num_elements; i++) {
+    for (int k = 0; k < 4; k++) {
+      int n0 = elem_conn[4 * i + tacs_quad_edge_corners[2 * k]];
+      int n1 = elem_conn[4 * i + tacs_quad_edge_corners[2 * k + 1]];
+      int *e = &edges[16 * i + 4 * k];
+      e[0] = (n0 < n1 ? n0 : n1);
+      e[1] = (n0 < n1 ? n1 : n0);
+      e[2] = i;
+      e[3] = k;
+    }
+  }
+  qsort(edges, 4 * num_elements, 4 * sizeof(int), compare_edges);
+
+  return edges;
+}
+
+/*
+  Add the weights of the independent nodes that interpolate the given
+  node (root only)
+
+  The node is interpolated from its parents when it is a dependent
+  node in the mesh with the given node numbers, or when it was created
+  after that mesh. The interpolation is applied recursively until only
+  independent nodes remain.
+*/
+int TACSShellHRefinement::getNodeWeights(int node, double w, int nnodes,
+                                         const int *nums, int max_size,
+                                         int size, int vars[],
+                                         double weights[]) {
+  if (node >= nnodes || nums[node] < 0) {
+    const int *p = &node_parents[4 * node];
+    int np = (p[2] >= 0 ? 4 : 2);
+    for (int j = 0; j < np; j++) {
+      size = getNodeWeights(p[j], w / np, nnodes, nums, max_size, size, vars,
+                            weights);
+    }
+    return size;
+  }
+
+  for (int j = 0; j < size; j++) {
+    if (vars[j] == node) {
+      weights[j] += w;
+      return size;
+    }
+  }
+  if (size < max_size) {
+    vars[size] = node;
+    weights[size] = w;
+    size++;
+  } else {
+    fprintf(stderr,
+            "TACSShellHRefinement: Exceeded the maximum number of node "
+            "weights\n");
+  }
+
+  return size;
+}
+
+/**
+  Create the TACSAssembler object for the current mesh
+
+  This must be called on all processors. The nodes that lie at the
+  midpoint of an element edge are dependent nodes, and the remaining
+  nodes are numbered in order.
+
+  The elements keep the partition of the previous mesh, unless the
+  number of elements on a processor exceeds the average by more than
+  the repartition tolerance, in which case the mesh is repartitioned.
+
+  @return The TACSAssembler object
+*/
+TACSAssembler *TACSShellHRefinement::createTACS() {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Keep the previous mesh for the interpolation
+  if (prev_creator) {
+    prev_creator->decref();
+  }
+  prev_creator = creator;
+  creator = new TACSCreator(comm, vars_per_node);
+  creator->incref();
+
+  if (rank == 0) {
+    prev_num_nodes = num_indep_nodes + num_dep_nodes;
+    delete[] prev_node_nums;
+    prev_node_nums = node_nums;
+    node_nums = new int[num_nodes];
+
+    // Flag the nodes at the midpoint of an element edge
+    int *edges = computeEdges();
+    for (int n = 0; n < num_nodes; n++) {
+      const int *p = &node_parents[4 * n];
+      node_nums[n] = 0;
+      if (p[0] >= 0 && p[2] < 0) {
+        int e[2];
+        e[0] = (p[0] < p[1] ? p[0] : p[1]);
+        e[1] = (p[0] < p[1] ? p[1] : p[0]);
+        if (bsearch(e, edges, 4 * num_elements, 4 * sizeof(int),
+                    compare_edges)) {
+          node_nums[n] = -1;
+        }
+      }
+    }
+    delete[] edges;
+
+    // Number the independent and dependent nodes
+    num_indep_nodes = 0;
+    num_dep_nodes = 0;
+    for (int n = 0; n < num_nodes; n++) {
+      if (node_nums[n] < 0) {
+        node_nums[n] = -num_dep_nodes - 1;
+        num_dep_nodes++;
+      } else {
+        node_nums[n] = num_indep_nodes;
+        num_indep_nodes++;
+      }
+    }
+
+    // Compute the dependent node weights
+    int *dep_ptr = new int[num_dep_nodes + 1];
+    int *dep_conn = new int[TACS_MAX_NODE_WEIGHTS * num_dep_nodes];
+    double *dep_weights = new double[TACS_MAX_NODE_WEIGHTS * num_dep_nodes];
+    dep_ptr[0] = 0;
+    for (int n = 0, dep = 0; n < num_nodes; n++) {
+      if (node_nums[n] < 0) {
+        int ptr = dep_ptr[dep];
+        int len = getNodeWeights(n, 1.0, num_nodes, node_nums,
+                                 TACS_MAX_NODE_WEIGHTS, 0, &dep_conn[ptr],
+                                 &dep_weights[ptr]);
+        for (int j = ptr; j < ptr + len; j++) {
+          dep_conn[j] = node_nums[dep_conn[j]];
+        }
+        dep_ptr[dep + 1] = ptr + len;
+        dep++;
+      }
+    }
+
+    // Create the element connectivity
+    int *ptr = new int[num_elements + 1];
+    int *conn = new int[4 * num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      ptr[i] = 4 * i;
+      for (int j = 0; j < 4; j++) {
+        conn[4 * i + j] = node_nums[elem_conn[4 * i + j]];
+      }
+    }
+    ptr[num_elements] = 4 * num_elements;
+
+    // Set the locations and boundary conditions of the independent
+    // nodes
+    TacsScalar *X = new TacsScalar[3 * num_indep_nodes];
+    int num_bcs = 0, num_bc_vars = 0;
+    for (int n = 0; n < num_nodes; n++) {
+      if (node_nums[n] >= 0) {
+        memcpy(&X[3 * node_nums[n]], &Xpts[3 * n], 3 * sizeof(TacsScalar));
+        if (node_bcs[n]) {
+          num_bcs++;
+          num_bc_vars += vars_per_node;
+        }
+      }
+    }
+    int *bc_nodes = new int[num_bcs];
+    int *bc_ptr = new int[num_bcs + 1];
+    int *bc_vars = new int[num_bc_vars];
+    bc_ptr[0] = 0;
+    for (int n = 0, k = 0; n < num_nodes; n++) {
+      if (node_nums[n] >= 0 && node_bcs[n]) {
+        bc_nodes[k] = node_nums[n];
+        bc_ptr[k + 1] = bc_ptr[k];
+        for (int j = 0; j < vars_per_node; j++) {
+          if (node_bcs[n] & (1 << j)) {
+            bc_vars[bc_ptr[k + 1]] = j;
+            bc_ptr[k + 1]++;
+          }
+        }
+        k++;
+      }
+    }
+
+    creator->setGlobalConnectivity(num_indep_nodes, num_elements, ptr, conn,
+                                   elem_comps);
+    if (num_dep_nodes > 0) {
+      creator->setDependentNodes(num_dep_nodes, dep_ptr, dep_conn,
+                                 dep_weights);
+    }
+    creator->setBoundaryConditions(num_bcs, bc_nodes, bc_ptr, bc_vars);
+    creator->setNodes(X);
+
+    // Keep the partition from the previous mesh if it is still
+    // sufficiently balanced
+    if (elem_part && size > 1) {
+      int *count = new int[size];
+      memset(count, 0, size * sizeof(int));
+      for (int i = 0; i < num_elements; i++) {
+        count[elem_part[i]]++;
+      }
+      int max_count = 0;
+      for (int k = 0; k < size; k++) {
+        if (count[k] > max_count) {
+          max_count = count[k];
+        }
+      }
+      delete[] count;
+
+      if (max_count <= (1.0 + repartition_tol) * num_elements / size) {
+        creator->partitionMesh(size, elem_part);
+      }
+    }
+
+    delete[] dep_ptr;
+    delete[] dep_conn;
+    delete[] dep_weights;
+    delete[] ptr;
+    delete[] conn;
+    delete[] X;
+    delete[] bc_nodes;
+    delete[] bc_ptr;
+    delete[] bc_vars;
+  }
+
+  // This call must occur on all processors
+  creator->setElements(num_comps, elements);
+
+  TACSAssembler *assembler = creator->createTACS();
+
+  // Record the partition so that it can be inherited by the refined
+  // elements
+  if (rank == 0) {
+    const int *partition;
+    creator->getElementPartition(&partition);
+    delete[] elem_part;
+    elem_part = new int[num_elements];
+    memcpy(elem_part, partition, num_elements * sizeof(int));
+  }
+
+  return assembler;
+}
+
+/**
+  Create the interpolation from the variables of the previous mesh to
+  the variables of the last mesh
+
+  This must be called on all processors with the TACSAssembler objects
+  created by the last two calls to createTACS(). The interpolation is
+  exact for the displacement field of the previous mesh, so the
+  interpolated solution can be used as the starting point for the
+  solution on the new mesh.
+
+  @param prev_assembler The TACSAssembler object for the previous mesh
+  @param assembler The TACSAssembler object for the last mesh
+  @return The interpolation between the meshes
+*/
+TACSBVecInterp *TACSShellHRefinement::createInterpolation(
+    TACSAssembler *prev_assembler, TACSAssembler *assembler) {
+  if (!prev_creator) {
+    fprintf(stderr,
+            "TACSShellHRefinement: Cannot create the interpolation before "
+            "the mesh has been refined\n");
+    return NULL;
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TACSBVecInterp *interp = new TACSBVecInterp(prev_assembler, assembler);
+
+  if (rank == 0) {
+    const int *prev_new_nodes, *new_nodes;
+    prev_creator->getNodeNums(&prev_new_nodes);
+    creator->getNodeNums(&new_nodes);
+
+    int vars[TACS_MAX_NODE_WEIGHTS];
+    double weights[TACS_MAX_NODE_WEIGHTS];
+    TacsScalar w[TACS_MAX_NODE_WEIGHTS];
+    for (int n = 0; n < num_nodes; n++) {
+      if (node_nums[n] >= 0) {
+        int len = getNodeWeights(n, 1.0, prev_num_nodes, prev_node_nums,
+                                 TACS_MAX_NODE_WEIGHTS, 0, vars, weights);
+        for (int j = 0; j < len; j++) {
+          vars[j] = prev_new_nodes[prev_node_nums[vars[j]]];
+          w[j] = weights[j];
+        }
+        interp->addInterp(new_nodes[node_nums[n]], w, vars, len);
+      }
+    }
+  }
+
+  interp->initialize();
+
+  return interp;
+}
+
+/*
+  Compute the area of each element from its corner nodes (root only)
+*/
+void TACSShellHRefinement::computeElementAreas(TacsScalar area[]) {
+  for (int i = 0; i < num_elements; i++) {
+    const int *c = &elem_conn[4 * i];
+    TacsScalar d1[3], d2[3], n[3];
+    for (int d = 0; d < 3; d++) {
+      d1[d] = Xpts[3 * c[3] + d] - Xpts[3 * c[0] + d];
+      d2[d] = Xpts[3 * c[2] + d] - Xpts[3 * c[1] + d];
+    }
+    n[0] = d1[1] * d2[2] - d1[2] * d2[1];
+    n[1] = d1[2] * d2[0] - d1[0] * d2[2];
+    n[2] = d1[0] * d2[1] - d1[1] * d2[0];
+    area[i] = 0.5 * sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  }
+}
+
+/**
+  Compute the error indicator for each element
+
+  This must be called on all processors with the TACSAssembler object
+  created by the last call to createTACS(). The stresses are recovered
+  at the nodes with an area-weighted average of the element-average
+  stresses, and the indicator is the area-weighted difference between
+  the recovered and element stresses. The error indicator is only
+  returned on the root processor, in the order of the elements.
+
+  @param assembler The TACSAssembler object with the solution
+  @param err The error indicator for each element (root only)
+*/
+void TACSShellHRefinement::computeErrorEstimate(TACSAssembler *assembler,
+                                                TacsScalar err[]) {
+  const int NUM_STRESSES = 9;
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Compute the average stress in each local element
+  int num_local = assembler->getNumElements();
+  TacsScalar *local_stress = new TacsScalar[NUM_STRESSES * num_local];
+  memset(local_stress, 0, NUM_STRESSES * num_local * sizeof(TacsScalar));
+
+  int max_vars = assembler->getMaxElementVariables();
+  int max_nodes = assembler->getMaxElementNodes();
+  TacsScalar *data = new TacsScalar[3 * max_vars + 3 * max_nodes];
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[max_vars];
+  TacsScalar *ddvars = &data[2 * max_vars];
+  TacsScalar *elemXpts = &data[3 * max_vars];
+  for (int i = 0; i < num_local; i++) {
+    TACSElement *element =
+        assembler->getElement(i, elemXpts, vars, dvars, ddvars);
+    element->getAverageStresses(i, TACS_BEAM_OR_SHELL_ELEMENT, elemXpts, vars,
+                                dvars, ddvars,
+                                &local_stress[NUM_STRESSES * i]);
+  }
+  delete[] data;
+
+  // Gather the stresses on the root processor. The elements on each
+  // processor are stored in ascending order of the global elements.
+  int *owned_elements = NULL, *counts = NULL, *disp = NULL;
+  TacsScalar *stress = NULL;
+  if (rank == 0) {
+    creator->getNumOwnedElements(&owned_elements);
+    counts = new int[size];
+    disp = new int[size + 1];
+    disp[0] = 0;
+    for (int k = 0; k < size; k++) {
+      counts[k] = NUM_STRESSES * owned_elements[k];
+      disp[k + 1] = disp[k] + counts[k];
+    }
+    stress = new TacsScalar[disp[size]];
+  }
+  MPI_Gatherv(local_stress, NUM_STRESSES * num_local, TACS_MPI_TYPE, stress,
+              counts, disp, TACS_MPI_TYPE, 0, comm);
+  delete[] local_stress;
+
+  if (rank == 0) {
+    // Find the stresses in the order of the elements
+    TacsScalar *elem_stress = new TacsScalar[NUM_STRESSES * num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      int k = elem_part[i];
+      memcpy(&elem_stress[NUM_STRESSES * i], &stress[disp[k]],
+             NUM_STRESSES * sizeof(TacsScalar));
+      disp[k] += NUM_STRESSES;
+    }
+
+    // Find the largest magnitude of each stress component and ignore
+    // the components that only contain round-off
+    double smax[NUM_STRESSES], smax_all = 0.0;
+    for (int k = 0; k < NUM_STRESSES; k++) {
+      smax[k] = 0.0;
+    }
+    for (int i = 0; i < num_elements; i++) {
+      for (int k = 0; k < NUM_STRESSES; k++) {
+        double s = fabs(TacsRealPart(elem_stress[NUM_STRESSES * i + k]));
+        if (s > smax[k]) {
+          smax[k] = s;
+        }
+      }
+    }
+    for (int k = 0; k < NUM_STRESSES; k++) {
+      if (smax[k] > smax_all) {
+        smax_all = smax[k];
+      }
+    }
+    for (int k = 0; k < NUM_STRESSES; k++) {
+      if (smax[k] <= 1e-8 * smax_all) {
+        smax[k] = 0.0;
+      }
+    }
+
+    // Recover the stresses at the nodes
+    TacsScalar *area = new TacsScalar[num_elements];
+    computeElementAreas(area);
+    TacsScalar *node_stress = new TacsScalar[NUM_STRESSES * num_nodes];
+    TacsScalar *node_area = new TacsScalar[num_nodes];
+    memset(node_stress, 0, NUM_STRESSES * num_nodes * sizeof(TacsScalar));
+    memset(node_area, 0, num_nodes * sizeof(TacsScalar));
+    for (int i = 0; i < num_elements; i++) {
+      for (int j = 0; j < 4; j++) {
+        int n = elem_conn[4 * i + j];
+        node_area[n] += area[i];
+        for (int k = 0; k < NUM_STRESSES; k++) {
+          node_stress[NUM_STRESSES * n + k] +=
+              area[i] * elem_stress[NUM_STRESSES * i + k];
+        }
+      }
+    }
+    for (int n = 0; n < num_nodes; n++) {
+      if (TacsRealPart(node_area[n]) != 0.0) {
+        for (int k = 0; k < NUM_STRESSES; k++) {
+          node_stress[NUM_STRESSES * n + k] /= node_area[n];
+        }
+      }
+    }
+
+    // Compute the difference between the recovered and element stresses
+    for (int i = 0; i < num_elements; i++) {
+      TacsScalar e = 0.0;
+      for (int j = 0; j < 4; j++) {
+        int n = elem_conn[4 * i + j];
+        for (int k = 0; k < NUM_STRESSES; k++) {
+          if (smax[k] != 0.0) {
+            TacsScalar d = (node_stress[NUM_STRESSES * n + k] -
+                            elem_stress[NUM_STRESSES * i + k]) /
+                           smax[k];
+            e += d * d;
+          }
+        }
+      }
+      err[i] = sqrt(0.25 * area[i] * e);
+    }
+
+    delete[] elem_stress;
+    delete[] area;
+    delete[] node_stress;
+    delete[] node_area;
+    delete[] counts;
+    delete[] disp;
+    delete[] stress;
+  }
+}
+
+/**
+  Split the elements with the largest error indicators
+
+  Each element with an error indicator of at least fraction times the
+  largest indicator is split into four elements, provided that its
+  refinement level is less than the maximum level. Additional elements
+  are split to keep the refinement 2:1 balanced. The first new element
+  replaces the parent element, and the remaining new elements are
+  added at the end of the element list. This must be called on all
+  processors.
+
+  @param err The error indicator for each element (root only)
+  @param fraction The fraction of the largest indicator to refine
+  @return The number of refined elements
+*/
+int TACSShellHRefinement::refine(const TacsScalar err[], double fraction) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int num_refined = 0;
+  if (rank == 0) {
+    double max_err = 0.0;
+    for (int i = 0; i < num_elements; i++) {
+      if (TacsRealPart(err[i]) > max_err) {
+        max_err = TacsRealPart(err[i]);
+      }
+    }
+
+    int *marked = new int[num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      marked[i] = (max_err > 0.0 &&
+                   TacsRealPart(err[i]) >= fraction * max_err &&
+                   elem_levels[i] < max_level);
+    }
+
+    // Mark the coarser neighbors of the marked elements. The node at
+    // the end of an edge of the marked element lies at the midpoint
+    // of the edge of a coarser neighbor when the other end of the
+    // edge is one of its parents.
+    int *edges = computeEdges();
+    int *edges_end = &edges[16 * num_elements];
+    int changed = 1;
+    while (changed) {
+      changed = 0;
+      for (int i = 0; i < num_elements; i++) {
+        if (!marked[i]) {
+          continue;
+        }
+        for (int k = 0; k < 4; k++) {
+          for (int m = 0; m < 2; m++) {
+            int x = elem_conn[4 * i + tacs_quad_edge_corners[2 * k + m]];
+            int y = elem_conn[4 * i + tacs_quad_edge_corners[2 * k + 1 - m]];
+            const int *p = &node_parents[4 * x];
+            if (p[0] < 0 || p[2] >= 0 || (p[0] != y && p[1] != y)) {
+              continue;
+            }
+
+            int e[2];
+            e[0] = (p[0] < p[1] ? p[0] : p[1]);
+            e[1] = (p[0] < p[1] ? p[1] : p[0]);
+            int *ptr = (int *)bsearch(e, edges, 4 * num_elements,
+                                      4 * sizeof(int), compare_edges);
+            if (ptr) {
+              while (ptr > edges && compare_edges(ptr - 4, e) == 0) {
+                ptr -= 4;
+              }
+              for (; ptr < edges_end && compare_edges(ptr, e) == 0; ptr += 4) {
+                if (!marked[ptr[2]]) {
+                  marked[ptr[2]] = 1;
+                  changed = 1;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    delete[] edges;
+
+    for (int i = 0; i < num_elements; i++) {
+      if (marked[i]) {
+        num_refined++;
+      }
+    }
+
+    // Find the existing nodes at the edge midpoints
+    int num_mid = 0;
+    for (int n = 0; n < num_nodes; n++) {
+      if (node_parents[4 * n] >= 0 && node_parents[4 * n + 2] < 0) {
+        num_mid++;
+      }
+    }
+    int *mid = new int[3 * num_mid];
+    for (int n = 0, j = 0; n < num_nodes; n++) {
+      const int *p = &node_parents[4 * n];
+      if (p[0] >= 0 && p[2] < 0) {
+        mid[3 * j] = (p[0] < p[1] ? p[0] : p[1]);
+        mid[3 * j + 1] = (p[0] < p[1] ? p[1] : p[0]);
+        mid[3 * j + 2] = n;
+        j++;
+      }
+    }
+    qsort(mid, num_mid, 3 * sizeof(int), compare_edges);
+
+    // Find the edges of the refined elements
+    int *refined = new int[num_refined];
+    int *ref_edges = new int[16 * num_refined];
+    for (int i = 0, r = 0; i < num_elements; i++) {
+      if (marked[i]) {
+        refined[r] = i;
+        for (int k = 0; k < 4; k++) {
+          int n0 = elem_conn[4 * i + tacs_quad_edge_corners[2 * k]];
+          int n1 = elem_conn[4 * i + tacs_quad_edge_corners[2 * k + 1]];
+          int *e = &ref_edges[16 * r + 4 * k];
+          e[0] = (n0 < n1 ? n0 : n1);
+          e[1] = (n0 < n1 ? n1 : n0);
+          e[2] = r;
+          e[3] = k;
+        }
+        r++;
+      }
+    }
+    qsort(ref_edges, 4 * num_refined, 4 * sizeof(int), compare_edges);
+    delete[] marked;
+
+    // Allocate space for the new nodes
+    int max_new_nodes = num_nodes + 5 * num_refined;
+    TacsScalar *new_Xpts = new TacsScalar[3 * max_new_nodes];
+    int *new_parents = new int[4 * max_new_nodes];
+    int *new_bcs = new int[max_new_nodes];
+    memcpy(new_Xpts, Xpts, 3 * num_nodes * sizeof(TacsScalar));
+    memcpy(new_parents, node_parents, 4 * num_nodes * sizeof(int));
+    memcpy(new_bcs, node_bcs, num_nodes * sizeof(int));
+    for (int i = 4 * num_nodes; i < 4 * max_new_nodes; i++) {
+      new_parents[i] = -1;
+    }
+
+    // Find or create the node at the midpoint of each refined edge
+    int new_num_nodes = num_nodes;
+    int *ref_mid = new int[4 * num_refined];
+    for (int j = 0; j < 4 * num_refined; j++) {
+      const int *e = &ref_edges[4 * j];
+      if (j == 0 || compare_edges(e, e - 4) != 0) {
+        int *ptr =
+            (int *)bsearch(e, mid, num_mid, 3 * sizeof(int), compare_edges);
+        if (ptr) {
+          ref_mid[4 * e[2] + e[3]] = ptr[2];
+        } else {
+          int n = new_num_nodes;
+          new_num_nodes++;
+          for (int d = 0; d < 3; d++) {
+            new_Xpts[3 * n + d] =
+                0.5 * (Xpts[3 * e[0] + d] + Xpts[3 * e[1] + d]);
+          }
+          new_parents[4 * n] = e[0];
+          new_parents[4 * n + 1] = e[1];
+          new_bcs[n] = node_bcs[e[0]] & node_bcs[e[1]];
+          ref_mid[4 * e[2] + e[3]] = n;
+        }
+      } else {
+        // The edge is shared with the previous refined element
+        const int *prev = e - 4;
+        ref_mid[4 * e[2] + e[3]] = ref_mid[4 * prev[2] + prev[3]];
+      }
+    }
+    delete[] mid;
+    delete[] ref_edges;
+
+    // Split the elements
+    int new_num_elements = num_elements + 3 * num_refined;
+    int *new_conn = new int[4 * new_num_elements];
+    int *new_comps = new int[new_num_elements];
+    int *new_levels = new int[new_num_elements];
+    int *new_part = NULL;
+    memcpy(new_conn, elem_conn, 4 * num_elements * sizeof(int));
+    memcpy(new_comps, elem_comps, num_elements * sizeof(int));
+    memcpy(new_levels, elem_levels, num_elements * sizeof(int));
+    if (elem_part) {
+      new_part = new int[new_num_elements];
+      memcpy(new_part, elem_part, num_elements * sizeof(int));
+    }
+
+    for (int r = 0; r < num_refined; r++) {
+      int i = refined[r];
+      const int *c = &elem_conn[4 * i];
+      const int *m = &ref_mid[4 * r];
+
+      // Add the center node
+      int z = new_num_nodes;
+      new_num_nodes++;
+      for (int d = 0; d < 3; d++) {
+        new_Xpts[3 * z + d] =
+            0.25 * (Xpts[3 * c[0] + d] + Xpts[3 * c[1] + d] +
+                    Xpts[3 * c[2] + d] + Xpts[3 * c[3] + d]);
+      }
+      for (int j = 0; j < 4; j++) {
+        new_parents[4 * z + j] = c[j];
+      }
+      new_bcs[z] = 0;
+
+      // The new elements in the tensor-product ordering
+      int child_conn[16] = {c[0], m[0], m[2], z,    m[0], c[1], z,    m[3],
+                            m[2], z,    c[2], m[1], z,    m[3], m[1], c[3]};
+      for (int j = 0; j < 4; j++) {
+        int child = (j == 0 ? i : num_elements + 3 * r + j - 1);
+        memcpy(&new_conn[4 * child], &child_conn[4 * j], 4 * sizeof(int));
+        new_comps[child] = elem_comps[i];
+        new_levels[child] = elem_levels[i] + 1;
+        if (new_part) {
+          new_part[child] = elem_part[i];
+        }
+      }
+    }
+    delete[] refined;
+    delete[] ref_mid;
+
+    delete[] Xpts;
+    delete[] node_parents;
+    delete[] node_bcs;
+    num_nodes = new_num_nodes;
+    Xpts = new_Xpts;
+    node_parents = new_parents;
+    node_bcs = new_bcs;
+
+    delete[] elem_conn;
+    delete[] elem_comps;
+    delete[] elem_levels;
+    delete[] elem_part;
+    num_elements = new_num_elements;
+    elem_conn = new_conn;
+    elem_comps = new_comps;
+    elem_levels = new_levels;
+    elem_part = new_part;
+  }
+
+  MPI_Bcast(&num_refined, 1, MPI_INT, 0, comm);
+
+  return num_refined;
+}
@@ -0,0 +1,139 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_SHELL_H_REFINEMENT_H
+#define TACS_SHELL_H_REFINEMENT_H
+
+#include "TACSBVecInterp.h"
+#include "TACSCreator.h"
+
+/**
+  Adaptive h-refinement of linear quadrilateral shell meshes
+
+  The mesh is defined by a serial quadrilateral mesh on the root
+  processor, where the four corner nodes of each element are given in
+  the tensor-product ordering used by the shell elements. Each
+  refined element is split into four elements by adding nodes at the
+  midpoints of its edges and at its center. The new nodes are placed
+  on the bilinear surface of the parent element.
+
+  The refinement is kept 2:1 balanced, so that each element edge is
+  shared with at most two finer elements. The node at the midpoint of
+  an edge shared with an element that has not been refined is a
+  hanging node. The hanging nodes are dependent nodes that interpolate
+  the end nodes of the coarse edge, so that the displacement field
+  remains continuous between elements.
+
+  The error indicator is computed from the element-average stresses in
+  the same manner as TACSShellPRefinement. The elements with the
+  largest indicators are split by refine(). The refined elements keep
+  the processor of their parent, so that only the new elements are
+  added to each partition. The mesh is only repartitioned when the
+  number of elements on a processor exceeds the average by more than
+  the repartition tolerance.
+
+  After a new TACSAssembler object is created, createInterpolation()
+  returns the interpolation between the variables of the previous and
+  the new mesh. This can be used to transfer the solution to the new
+  mesh as the starting point for the next solution.
+*/
+class TACSShellHRefinement : public TACSObject {
+ public:
+  TACSShellHRefinement(MPI_Comm _comm, int _vars_per_node, int _num_nodes,
+                       int _num_elements, const int *_elem_conn,
+                       const TacsScalar *_Xpts, const int *_elem_comps = NULL);
+  ~TACSShellHRefinement();
+
+  // Set the boundary conditions on the initial nodes
+  // ------------------------------------------------
+  void setBoundaryConditions(int _num_bcs, const int *_bc_nodes,
+                             const int *_bc_ptr = NULL,
+                             const int *_bc_vars = NULL);
+
+  // Set the elements for each component
+  // -----------------------------------
+  void setElements(int _num_comps, TACSElement **_elements);
+
+  // Set the refinement options
+  // --------------------------
+  void setMaxRefinementLevel(int _max_level) { max_level = _max_level; }
+  void setRepartitionTolerance(double _tol) { repartition_tol = _tol; }
+
+  // Get the mesh on the root processor
+  // ----------------------------------
+  int getNumNodes(const TacsScalar **_Xpts);
+  int getElements(const int **_elem_conn, const int **_elem_levels);
+
+  // Create the TACSAssembler object for the current mesh
+  // ----------------------------------------------------
+  TACSAssembler *createTACS();
+
+  // Get the number of independent and dependent nodes in the last mesh
+  // ------------------------------------------------------------------
+  void getNumMeshNodes(int *_num_indep_nodes, int *_num_dep_nodes);
+
+  // Interpolate from the previous mesh to the last mesh
+  // ---------------------------------------------------
+  TACSBVecInterp *createInterpolation(TACSAssembler *prev_assembler,
+                                      TACSAssembler *assembler);
+
+  // Estimate the error and refine the mesh
+  // --------------------------------------
+  void computeErrorEstimate(TACSAssembler *assembler, TacsScalar err[]);
+  int refine(const TacsScalar err[], double fraction);
+
+ private:
+  int *computeEdges();
+  int getNodeWeights(int node, double w, int nnodes, const int *nums,
+                     int max_size, int size, int vars[], double weights[]);
+  void computeElementAreas(TacsScalar area[]);
+
+  // The communicator
+  MPI_Comm comm;
+  int vars_per_node;
+
+  // The nodes of the mesh (root only). The nodes created by refinement
+  // store the two edge nodes or four element nodes that they
+  // interpolate, while the remaining entries are negative. The
+  // constrained variables at each node are stored as a bit mask.
+  int num_nodes;
+  TacsScalar *Xpts;
+  int *node_parents;
+  int *node_bcs;
+
+  // The elements of the mesh (root only)
+  int num_elements;
+  int *elem_conn, *elem_comps, *elem_levels, *elem_part;
+
+  // The elements for each component
+  int num_comps;
+  TACSElement **elements;
+
+  // The refinement options
+  int max_level;
+  double repartition_tol;
+
+  // The creator for the last mesh and the creator node number of each
+  // node (negative for the dependent nodes)
+  TACSCreator *creator;
+  int *node_nums;
+  int num_indep_nodes, num_dep_nodes;
+
+  // The creator and node numbers for the previous mesh
+  TACSCreator *prev_creator;
+  int prev_num_nodes;
+  int *prev_node_nums;
+};
+
+#endif  // TACS_SHELL_H_REFINEMENT_H
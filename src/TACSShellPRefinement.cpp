@@ -0,0 +1,818 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSShellPRefinement.h"
+
+#include "TACSLagrangeInterpolation.h"
+
+/*
+  The corner nodes of each edge of a quadrilateral element in the
+  tensor-product ordering. The first two edges run along the first
+  parametric direction and the last two along the second.
+*/
+static const int tacs_quad_edge_corners[] = {0, 1, 2, 3, 0, 2, 1, 3};
+
+/*
+  Compare two edges, stored as (n0, n1, elem, edge), by their nodes
+*/
+static int compare_edges(const void *a, const void *b) {
+  const int *ea = static_cast<const int *>(a);
+  const int *eb = static_cast<const int *>(b);
+  if (ea[0] != eb[0]) {
+    return ea[0] - eb[0];
+  }
+  return ea[1] - eb[1];
+}
+
+/*
+  Get the locations of the nodes along the edge of an element with
+  the given order
+*/
+static const double *getOrderKnots(int order) {
+  if (order == 3) {
+    return TacsGaussLobattoPoints3;
+  } else if (order == 4) {
+    return TacsGaussLobattoPoints4;
+  }
+  return TacsGaussLobattoPoints2;
+}
+
+/*
+  Evaluate the one-dimensional Lagrange shape functions with the given
+  knots at the parametric point u
+*/
+static void evalLagrangeShapeFunctions(int order, const double knots[],
+                                       double u, double N[]) {
+  for (int i = 0; i < order; i++) {
+    N[i] = 1.0;
+    for (int j = 0; j < order; j++) {
+      if (i != j) {
+        N[i] *= (u - knots[j]) / (knots[i] - knots[j]);
+      }
+    }
+  }
+}
+
+/**
+  Create the p-refinement object from a serial quadrilateral mesh
+
+  The mesh is only required on the root processor. All other
+  processors may pass zero nodes and elements.
+
+  @param comm The MPI communicator
+  @param vars_per_node The number of variables at each node
+  @param num_nodes The number of corner nodes
+  @param num_elements The number of elements
+  @param elem_conn The four corner nodes of each element
+  @param Xpts The locations of the corner nodes
+  @param elem_comps The component number of each element (NULL for 0)
+*/
+TACSShellPRefinement::TACSShellPRefinement(
+    MPI_Comm _comm, int _vars_per_node, int _num_nodes, int _num_elements,
+    const int *_elem_conn, const TacsScalar *_Xpts, const int *_elem_comps) {
+  comm = _comm;
+  vars_per_node = _vars_per_node;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  num_nodes = 0;
+  num_elements = 0;
+  elem_conn = NULL;
+  elem_comps = NULL;
+  orders = NULL;
+  Xpts = NULL;
+
+  if (rank == 0) {
+    num_nodes = _num_nodes;
+    num_elements = _num_elements;
+
+    elem_conn = new int[4 * num_elements];
+    memcpy(elem_conn, _elem_conn, 4 * num_elements * sizeof(int));
+
+    elem_comps = new int[num_elements];
+    if (_elem_comps) {
+      memcpy(elem_comps, _elem_comps, num_elements * sizeof(int));
+    } else {
+      memset(elem_comps, 0, num_elements * sizeof(int));
+    }
+
+    // Start with the linear elements
+    orders = new int[num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      orders[i] = 2;
+    }
+
+    Xpts = new TacsScalar[3 * num_nodes];
+    memcpy(Xpts, _Xpts, 3 * num_nodes * sizeof(TacsScalar));
+  }
+
+  num_bcs = 0;
+  bc_nodes = NULL;
+  bc_ptr = NULL;
+  bc_vars = NULL;
+
+  num_comps = 0;
+  elements = NULL;
+
+  creator = NULL;
+  num_indep_nodes = 0;
+  num_dep_nodes = 0;
+}
+
+TACSShellPRefinement::~TACSShellPRefinement() {
+  delete[] elem_conn;
+  delete[] elem_comps;
+  delete[] orders;
+  delete[] Xpts;
+  delete[] bc_nodes;
+  delete[] bc_ptr;
+  delete[] bc_vars;
+
+  if (elements) {
+    for (int i = 0; i < (MAX_ORDER - 1) * num_comps; i++) {
+      if (elements[i]) {
+        elements[i]->decref();
+      }
+    }
+    delete[] elements;
+  }
+
+  if (creator) {
+    creator->decref();
+  }
+}
+
+/**
+  Set the boundary conditions on the corner nodes (root only)
+
+  The boundary conditions are applied to the higher-order nodes along
+  an edge when both corner nodes of the edge are constrained. The
+  variables constrained on the edge are those constrained at both
+  corners.
+
+  @param num_bcs The number of corner nodes with boundary conditions
+  @param bc_nodes The corner node numbers
+  @param bc_ptr Pointer into the variable array (NULL for all variables)
+  @param bc_vars The constrained variables at each node
+*/
+void TACSShellPRefinement::setBoundaryConditions(int _num_bcs,
+                                                 const int *_bc_nodes,
+                                                 const int *_bc_ptr,
+                                                 const int *_bc_vars) {
+  delete[] bc_nodes;
+  delete[] bc_ptr;
+  delete[] bc_vars;
+
+  num_bcs = _num_bcs;
+  bc_nodes = new int[num_bcs];
+  memcpy(bc_nodes, _bc_nodes, num_bcs * sizeof(int));
+
+  if (_bc_ptr) {
+    bc_ptr = new int[num_bcs + 1];
+    memcpy(bc_ptr, _bc_ptr, (num_bcs + 1) * sizeof(int));
+    bc_vars = new int[bc_ptr[num_bcs]];
+    memcpy(bc_vars, _bc_vars, bc_ptr[num_bcs] * sizeof(int));
+  } else {
+    bc_ptr = new int[num_bcs + 1];
+    bc_vars = new int[vars_per_node * num_bcs];
+    bc_ptr[0] = 0;
+    for (int i = 0; i < num_bcs; i++) {
+      for (int j = 0; j < vars_per_node; j++) {
+        bc_vars[bc_ptr[i] + j] = j;
+      }
+      bc_ptr[i + 1] = bc_ptr[i] + vars_per_node;
+    }
+  }
+}
+
+/**
+  Set the elements for each component and order (all processors)
+
+  @param num_comps The number of components
+  @param elements The elements for each component and order
+*/
+void TACSShellPRefinement::setElements(int _num_comps,
+                                       TACSElement **_elements) {
+  int size = (MAX_ORDER - 1) * _num_comps;
+  for (int i = 0; i < size; i++) {
+    if (_elements[i]) {
+      _elements[i]->incref();
+    }
+  }
+  if (elements) {
+    for (int i = 0; i < (MAX_ORDER - 1) * num_comps; i++) {
+      if (elements[i]) {
+        elements[i]->decref();
+      }
+    }
+    delete[] elements;
+  }
+
+  num_comps = _num_comps;
+  elements = new TACSElement *[size];
+  memcpy(elements, _elements, size * sizeof(TACSElement *));
+}
+
+/**
+  Set the order of each element (root only)
+
+  @param orders The order of each element between 2 and MAX_ORDER
+*/
+void TACSShellPRefinement::setElementOrders(const int _orders[]) {
+  for (int i = 0; i < num_elements; i++) {
+    orders[i] = _orders[i];
+    if (orders[i] < 2) {
+      orders[i] = 2;
+    } else if (orders[i] > MAX_ORDER) {
+      orders[i] = MAX_ORDER;
+    }
+  }
+}
+
+/**
+  Get the order of each element (root only)
+
+  @param orders The order of each element
+  @return The number of elements
+*/
+int TACSShellPRefinement::getElementOrders(const int **_orders) {
+  if (_orders) {
+    *_orders = orders;
+  }
+  return num_elements;
+}
+
+/**
+  Get the number of independent and dependent nodes in the last mesh
+  created on the root processor
+
+  @param num_indep_nodes The number of independent nodes
+  @param num_dep_nodes The number of dependent nodes
+*/
+void TACSShellPRefinement::getNumNodes(int *_num_indep_nodes,
+                                       int *_num_dep_nodes) {
+  if (_num_indep_nodes) {
+    *_num_indep_nodes = num_indep_nodes;
+  }
+  if (_num_dep_nodes) {
+    *_num_dep_nodes = num_dep_nodes;
+  }
+}
+
+/**
+  Create the TACSAssembler object with the current element orders
+
+  This must be called on all processors. The independent nodes are
+  numbered with the corner nodes first, followed by the nodes along
+  each edge and then the interior nodes of each element.
+
+  @return The TACSAssembler object
+*/
+TACSAssembler *TACSShellPRefinement::createTACS() {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  if (creator) {
+    creator->decref();
+  }
+  creator = new TACSCreator(comm, vars_per_node);
+  creator->incref();
+
+  if (rank == 0) {
+    // Find the unique edges in the mesh. Each edge is stored with its
+    // lowest node number first.
+    int *edges = new int[16 * num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      for (int k = 0; k < 4; k++) {
+        int n0 = elem_conn[4 * i + tacs_quad_edge_corners[2 * k]];
+        int n1 = elem_conn[4 * i + tacs_quad_edge_corners[2 * k + 1]];
+        int *e = &edges[16 * i + 4 * k];
+        e[0] = (n0 < n1 ? n0 : n1);
+        e[1] = (n0 < n1 ? n1 : n0);
+        e[2] = i;
+        e[3] = k;
+      }
+    }
+    qsort(edges, 4 * num_elements, 4 * sizeof(int), compare_edges);
+
+    // Number the edges and record their end nodes
+    int num_edges = 0;
+    int *elem_edges = new int[4 * num_elements];
+    int *edge_nodes = new int[8 * num_elements];
+    for (int j = 0; j < 4 * num_elements; j++) {
+      const int *e = &edges[4 * j];
+      if (j == 0 || compare_edges(e, e - 4) != 0) {
+        edge_nodes[2 * num_edges] = e[0];
+        edge_nodes[2 * num_edges + 1] = e[1];
+        num_edges++;
+      }
+      elem_edges[4 * e[2] + e[3]] = num_edges - 1;
+    }
+    delete[] edges;
+
+    // The order of each edge is the lowest order of the adjacent
+    // elements
+    int *edge_order = new int[num_edges];
+    for (int i = 0; i < num_edges; i++) {
+      edge_order[i] = MAX_ORDER;
+    }
+    for (int i = 0; i < num_elements; i++) {
+      for (int k = 0; k < 4; k++) {
+        int edge = elem_edges[4 * i + k];
+        if (orders[i] < edge_order[edge]) {
+          edge_order[edge] = orders[i];
+        }
+      }
+    }
+
+    // Number the independent nodes along the edges and within the
+    // elements
+    int *edge_ptr = new int[num_edges + 1];
+    edge_ptr[0] = num_nodes;
+    for (int i = 0; i < num_edges; i++) {
+      edge_ptr[i + 1] = edge_ptr[i] + edge_order[i] - 2;
+    }
+    int *interior_ptr = new int[num_elements + 1];
+    interior_ptr[0] = edge_ptr[num_edges];
+    for (int i = 0; i < num_elements; i++) {
+      int p = orders[i];
+      interior_ptr[i + 1] = interior_ptr[i] + (p - 2) * (p - 2);
+    }
+    num_indep_nodes = interior_ptr[num_elements];
+
+    // Flag the dependent node groups. Each group contains the edge
+    // nodes for an element of order p > edge order, shared between
+    // all elements of order p along the edge.
+    int *edge_dep = new int[(MAX_ORDER - 1) * num_edges];
+    for (int i = 0; i < (MAX_ORDER - 1) * num_edges; i++) {
+      edge_dep[i] = -1;
+    }
+    for (int i = 0; i < num_elements; i++) {
+      for (int k = 0; k < 4; k++) {
+        int edge = elem_edges[4 * i + k];
+        if (orders[i] > edge_order[edge]) {
+          edge_dep[(MAX_ORDER - 1) * edge + orders[i] - 2] = 1;
+        }
+      }
+    }
+
+    // Number the dependent nodes and count their weights
+    num_dep_nodes = 0;
+    int dep_conn_size = 0;
+    for (int i = 0; i < num_edges; i++) {
+      for (int p = 2; p <= MAX_ORDER; p++) {
+        int *dep = &edge_dep[(MAX_ORDER - 1) * i + p - 2];
+        if (*dep > 0) {
+          *dep = num_dep_nodes;
+          num_dep_nodes += p - 2;
+          dep_conn_size += (p - 2) * edge_order[i];
+        }
+      }
+    }
+
+    // Compute the dependent node weights: Each dependent node
+    // interpolates the nodes of the lower-order edge at its location
+    int *dep_ptr = new int[num_dep_nodes + 1];
+    int *dep_conn = new int[dep_conn_size];
+    double *dep_weights = new double[dep_conn_size];
+    dep_ptr[0] = 0;
+    for (int i = 0; i < num_edges; i++) {
+      int pe = edge_order[i];
+      const double *edge_knots = getOrderKnots(pe);
+
+      for (int p = 2; p <= MAX_ORDER; p++) {
+        int dep = edge_dep[(MAX_ORDER - 1) * i + p - 2];
+        if (dep < 0) {
+          continue;
+        }
+        const double *knots = getOrderKnots(p);
+        for (int q = 1; q < p - 1; q++, dep++) {
+          double N[MAX_ORDER];
+          evalLagrangeShapeFunctions(pe, edge_knots, knots[q], N);
+
+          int ptr = dep_ptr[dep];
+          for (int j = 0; j < pe; j++) {
+            if (j == 0) {
+              dep_conn[ptr + j] = edge_nodes[2 * i];
+            } else if (j == pe - 1) {
+              dep_conn[ptr + j] = edge_nodes[2 * i + 1];
+            } else {
+              dep_conn[ptr + j] = edge_ptr[i] + j - 1;
+            }
+            dep_weights[ptr + j] = N[j];
+          }
+          dep_ptr[dep + 1] = ptr + pe;
+        }
+      }
+    }
+
+    // Create the element connectivity
+    int *ptr = new int[num_elements + 1];
+    ptr[0] = 0;
+    for (int i = 0; i < num_elements; i++) {
+      ptr[i + 1] = ptr[i] + orders[i] * orders[i];
+    }
+    int *conn = new int[ptr[num_elements]];
+    int *elem_ids = new int[num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      int p = orders[i];
+      elem_ids[i] = (MAX_ORDER - 1) * elem_comps[i] + p - 2;
+
+      const int *c = &elem_conn[4 * i];
+      for (int jj = 0; jj < p; jj++) {
+        for (int ii = 0; ii < p; ii++) {
+          int *node = &conn[ptr[i] + ii + p * jj];
+
+          // Determine the edge (if any) and the location along it
+          int k = -1, m = 0;
+          if (jj == 0 || jj == p - 1) {
+            k = (jj == 0 ? 0 : 1);
+            m = ii;
+          }
+          if (ii == 0 || ii == p - 1) {
+            if (k >= 0) {
+              // This is a corner node
+              *node = c[(ii == 0 ? 0 : 1) + (jj == 0 ? 0 : 2)];
+              continue;
+            }
+            k = (ii == 0 ? 2 : 3);
+            m = jj;
+          }
+
+          if (k < 0) {
+            *node = interior_ptr[i] + (ii - 1) + (p - 2) * (jj - 1);
+          } else {
+            // Find the location along the edge from its lowest node
+            int edge = elem_edges[4 * i + k];
+            int n0 = c[tacs_quad_edge_corners[2 * k]];
+            int q = (n0 == edge_nodes[2 * edge] ? m : p - 1 - m);
+
+            if (p == edge_order[edge]) {
+              *node = edge_ptr[edge] + q - 1;
+            } else {
+              int dep = edge_dep[(MAX_ORDER - 1) * edge + p - 2];
+              *node = -(dep + q - 1) - 1;
+            }
+          }
+        }
+      }
+    }
+
+    // Compute the locations of the independent nodes
+    TacsScalar *X = new TacsScalar[3 * num_indep_nodes];
+    memcpy(X, Xpts, 3 * num_nodes * sizeof(TacsScalar));
+    for (int i = 0; i < num_edges; i++) {
+      const double *knots = getOrderKnots(edge_order[i]);
+      const TacsScalar *X0 = &Xpts[3 * edge_nodes[2 * i]];
+      const TacsScalar *X1 = &Xpts[3 * edge_nodes[2 * i + 1]];
+      for (int q = 1; q < edge_order[i] - 1; q++) {
+        TacsScalar *Xn = &X[3 * (edge_ptr[i] + q - 1)];
+        for (int d = 0; d < 3; d++) {
+          Xn[d] =
+              0.5 * (1.0 - knots[q]) * X0[d] + 0.5 * (1.0 + knots[q]) * X1[d];
+        }
+      }
+    }
+    for (int i = 0; i < num_elements; i++) {
+      int p = orders[i];
+      const double *knots = getOrderKnots(p);
+      const int *c = &elem_conn[4 * i];
+      for (int jj = 1; jj < p - 1; jj++) {
+        for (int ii = 1; ii < p - 1; ii++) {
+          double u = knots[ii], v = knots[jj];
+          double N[4];
+          N[0] = 0.25 * (1.0 - u) * (1.0 - v);
+          N[1] = 0.25 * (1.0 + u) * (1.0 - v);
+          N[2] = 0.25 * (1.0 - u) * (1.0 + v);
+          N[3] = 0.25 * (1.0 + u) * (1.0 + v);
+
+          int node = interior_ptr[i] + (ii - 1) + (p - 2) * (jj - 1);
+          TacsScalar *Xn = &X[3 * node];
+          for (int d = 0; d < 3; d++) {
+            Xn[d] = N[0] * Xpts[3 * c[0] + d] + N[1] * Xpts[3 * c[1] + d] +
+                    N[2] * Xpts[3 * c[2] + d] + N[3] * Xpts[3 * c[3] + d];
+          }
+        }
+      }
+    }
+
+    // Extend the boundary conditions to the edges where both corner
+    // nodes are constrained
+    int *bc_index = new int[num_nodes];
+    for (int i = 0; i < num_nodes; i++) {
+      bc_index[i] = -1;
+    }
+    for (int i = 0; i < num_bcs; i++) {
+      bc_index[bc_nodes[i]] = i;
+    }
+
+    int max_bcs = num_bcs, max_bc_vars = (bc_ptr ? bc_ptr[num_bcs] : 0);
+    for (int i = 0; i < num_edges; i++) {
+      int b0 = bc_index[edge_nodes[2 * i]];
+      int b1 = bc_index[edge_nodes[2 * i + 1]];
+      if (b0 >= 0 && b1 >= 0) {
+        max_bcs += edge_order[i] - 2;
+        max_bc_vars += (edge_order[i] - 2) * (bc_ptr[b0 + 1] - bc_ptr[b0]);
+      }
+    }
+
+    int new_num_bcs = num_bcs;
+    int *new_bc_nodes = new int[max_bcs];
+    int *new_bc_ptr = new int[max_bcs + 1];
+    int *new_bc_vars = new int[max_bc_vars];
+    new_bc_ptr[0] = 0;
+    if (num_bcs > 0) {
+      memcpy(new_bc_nodes, bc_nodes, num_bcs * sizeof(int));
+      memcpy(new_bc_ptr, bc_ptr, (num_bcs + 1) * sizeof(int));
+      memcpy(new_bc_vars, bc_vars, bc_ptr[num_bcs] * sizeof(int));
+    }
+    for (int i = 0; i < num_edges; i++) {
+      int b0 = bc_index[edge_nodes[2 * i]];
+      int b1 = bc_index[edge_nodes[2 * i + 1]];
+      if (b0 < 0 || b1 < 0) {
+        continue;
+      }
+      for (int q = 1; q < edge_order[i] - 1; q++) {
+        int *vars = &new_bc_vars[new_bc_ptr[new_num_bcs]];
+        int nvars = 0;
+        for (int j = bc_ptr[b0]; j < bc_ptr[b0 + 1]; j++) {
+          for (int jj = bc_ptr[b1]; jj < bc_ptr[b1 + 1]; jj++) {
+            if (bc_vars[j] == bc_vars[jj]) {
+              vars[nvars] = bc_vars[j];
+              nvars++;
+              break;
+            }
+          }
+        }
+        if (nvars > 0) {
+          new_bc_nodes[new_num_bcs] = edge_ptr[i] + q - 1;
+          new_bc_ptr[new_num_bcs + 1] = new_bc_ptr[new_num_bcs] + nvars;
+          new_num_bcs++;
+        }
+      }
+    }
+    delete[] bc_index;
+
+    creator->setGlobalConnectivity(num_indep_nodes, num_elements, ptr, conn,
+                                   elem_ids);
+    if (num_dep_nodes > 0) {
+      creator->setDependentNodes(num_dep_nodes, dep_ptr, dep_conn,
+                                 dep_weights);
+    }
+    creator->setBoundaryConditions(new_num_bcs, new_bc_nodes, new_bc_ptr,
+                                   new_bc_vars);
+    creator->setNodes(X);
+
+    delete[] elem_edges;
+    delete[] edge_nodes;
+    delete[] edge_order;
+    delete[] edge_ptr;
+    delete[] interior_ptr;
+    delete[] edge_dep;
+    delete[] dep_ptr;
+    delete[] dep_conn;
+    delete[] dep_weights;
+    delete[] ptr;
+    delete[] conn;
+    delete[] elem_ids;
+    delete[] X;
+    delete[] new_bc_nodes;
+    delete[] new_bc_ptr;
+    delete[] new_bc_vars;
+  }
+
+  // This call must occur on all processors
+  creator->setElements((MAX_ORDER - 1) * num_comps, elements);
+
+  return creator->createTACS();
+}
+
+/*
+  Compute the area of each element from its corner nodes (root only)
+*/
+void TACSShellPRefinement::computeElementAreas(TacsScalar area[]) {
+  for (int i = 0; i < num_elements; i++) {
+    const int *c = &elem_conn[4 * i];
+    TacsScalar d1[3], d2[3], n[3];
+    for (int d = 0; d < 3; d++) {
+      d1[d] = Xpts[3 * c[3] + d] - Xpts[3 * c[0] + d];
+      d2[d] = Xpts[3 * c[2] + d] - Xpts[3 * c[1] + d];
+    }
+    n[0] = d1[1] * d2[2] - d1[2] * d2[1];
+    n[1] = d1[2] * d2[0] - d1[0] * d2[2];
+    n[2] = d1[0] * d2[1] - d1[1] * d2[0];
+    area[i] = 0.5 * sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  }
+}
+
+/**
+  Compute the error indicator for each element
+
+  This must be called on all processors with the TACSAssembler object
+  created by the last call to createTACS(). The error indicator is
+  only returned on the root processor, in the original element order.
+
+  @param assembler The TACSAssembler object with the solution
+  @param err The error indicator for each element (root only)
+*/
+void TACSShellPRefinement::computeErrorEstimate(TACSAssembler *assembler,
+                                                TacsScalar err[]) {
+  const int NUM_STRESSES = 9;
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Compute the average stress in each local element
+  int num_local = assembler->getNumElements();
+  TacsScalar *local_stress = new TacsScalar[NUM_STRESSES * num_local];
+  memset(local_stress, 0, NUM_STRESSES * num_local * sizeof(TacsScalar));
+
+  int max_vars = assembler->getMaxElementVariables();
+  int max_nodes = assembler->getMaxElementNodes();
+  TacsScalar *data = new TacsScalar[3 * max_vars + 3 * max_nodes];
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[max_vars];
+  TacsScalar *ddvars = &data[2 * max_vars];
+  TacsScalar *elemXpts = &data[3 * max_vars];
+  for (int i = 0; i < num_local; i++) {
+    TACSElement *element =
+        assembler->getElement(i, elemXpts, vars, dvars, ddvars);
+    element->getAverageStresses(i, TACS_BEAM_OR_SHELL_ELEMENT, elemXpts, vars,
+                                dvars, ddvars,
+                                &local_stress[NUM_STRESSES * i]);
+  }
+  delete[] data;
+
+  // Gather the stresses on the root processor. The elements on each
+  // processor are stored in ascending order of the global elements.
+  int *owned_elements = NULL, *counts = NULL, *disp = NULL;
+  TacsScalar *stress = NULL;
+  if (rank == 0) {
+    creator->getNumOwnedElements(&owned_elements);
+    counts = new int[size];
+    disp = new int[size + 1];
+    disp[0] = 0;
+    for (int k = 0; k < size; k++) {
+      counts[k] = NUM_STRESSES * owned_elements[k];
+      disp[k + 1] = disp[k] + counts[k];
+    }
+    stress = new TacsScalar[disp[size]];
+  }
+  MPI_Gatherv(local_stress, NUM_STRESSES * num_local, TACS_MPI_TYPE, stress,
+              counts, disp, TACS_MPI_TYPE, 0, comm);
+  delete[] local_stress;
+
+  if (rank == 0) {
+    // Find the stresses in the original element order
+    const int *partition;
+    creator->getElementPartition(&partition);
+    TacsScalar *elem_stress = new TacsScalar[NUM_STRESSES * num_elements];
+    for (int i = 0; i < num_elements; i++) {
+      int k = partition[i];
+      memcpy(&elem_stress[NUM_STRESSES * i], &stress[disp[k]],
+             NUM_STRESSES * sizeof(TacsScalar));
+      disp[k] += NUM_STRESSES;
+    }
+
+    // Find the largest magnitude of each stress component
+    double smax[NUM_STRESSES], smax_all = 0.0;
+    for (int k = 0; k < NUM_STRESSES; k++) {
+      smax[k] = 0.0;
+    }
+    for (int i = 0; i < num_elements; i++) {
+      for (int k = 0; k < NUM_STRESSES; k++) {
+        double s = fabs(TacsRealPart(elem_stress[NUM_STRESSES * i + k]));
+        if (s > smax[k]) {
+          smax[k] = s;
+        }
+      }
+    }
+    for (int k = 0; k < NUM_STRESSES; k++) {
+      if (smax[k] > smax_all) {
+        smax_all = smax[k];
+      }
+    }
+
+    // Ignore the components that only contain round-off, since their
+    // normalized values would otherwise dominate the indicator
+    for (int k = 0; k < NUM_STRESSES; k++) {
+      if (smax[k] <= 1e-8 * smax_all) {
+        smax[k] = 0.0;
+      }
+    }
+
+    // Recover the stresses at the corner nodes using an area-weighted
+    // average of the adjacent element stresses
+    TacsScalar *area = new TacsScalar[num_elements];
+    computeElementAreas(area);
+    TacsScalar *node_stress = new TacsScalar[NUM_STRESSES * num_nodes];
+    TacsScalar *node_area = new TacsScalar[num_nodes];
+    memset(node_stress, 0, NUM_STRESSES * num_nodes * sizeof(TacsScalar));
+    memset(node_area, 0, num_nodes * sizeof(TacsScalar));
+    for (int i = 0; i < num_elements; i++) {
+      for (int j = 0; j < 4; j++) {
+        int n = elem_conn[4 * i + j];
+        node_area[n] += area[i];
+        for (int k = 0; k < NUM_STRESSES; k++) {
+          node_stress[NUM_STRESSES * n + k] +=
+              area[i] * elem_stress[NUM_STRESSES * i + k];
+        }
+      }
+    }
+    for (int n = 0; n < num_nodes; n++) {
+      if (TacsRealPart(node_area[n]) != 0.0) {
+        for (int k = 0; k < NUM_STRESSES; k++) {
+          node_stress[NUM_STRESSES * n + k] /= node_area[n];
+        }
+      }
+    }
+
+    // Compute the difference between the recovered and element stresses
+    for (int i = 0; i < num_elements; i++) {
+      TacsScalar e = 0.0;
+      for (int j = 0; j < 4; j++) {
+        int n = elem_conn[4 * i + j];
+        for (int k = 0; k < NUM_STRESSES; k++) {
+          if (smax[k] != 0.0) {
+            TacsScalar d = (node_stress[NUM_STRESSES * n + k] -
+                            elem_stress[NUM_STRESSES * i + k]) /
+                           smax[k];
+            e += d * d;
+          }
+        }
+      }
+      err[i] = sqrt(0.25 * area[i] * e);
+    }
+
+    delete[] elem_stress;
+    delete[] area;
+    delete[] node_stress;
+    delete[] node_area;
+    delete[] counts;
+    delete[] disp;
+    delete[] stress;
+  }
+}
+
+/**
+  Raise the order of the elements with the largest error indicators
+
+  An element can be refined if its order is less than MAX_ORDER and an
+  element has been set for its component at the next order. The order
+  of each such element with an error indicator of at least fraction
+  times the largest indicator of these elements is increased by one.
+  Elements that cannot be refined are excluded from the largest
+  indicator, since the indicator does not decrease with the order and
+  would otherwise stop the refinement. This must be called on all
+  processors.
+
+  @param err The error indicator for each element (root only)
+  @param fraction The fraction of the largest indicator to refine
+  @return The number of refined elements
+*/
+int TACSShellPRefinement::refine(const TacsScalar err[], double fraction) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int num_refined = 0;
+  if (rank == 0) {
+    // Find the elements that can be refined
+    int *refinable = new int[num_elements];
+    double max_err = 0.0;
+    for (int i = 0; i < num_elements; i++) {
+      int p = orders[i];
+      int index = (MAX_ORDER - 1) * elem_comps[i] + p - 1;
+      refinable[i] = (p < MAX_ORDER && elem_comps[i] < num_comps &&
+                      elements[index] != NULL);
+      if (refinable[i] && TacsRealPart(err[i]) > max_err) {
+        max_err = TacsRealPart(err[i]);
+      }
+    }
+
+    for (int i = 0; i < num_elements; i++) {
+      if (refinable[i] && TacsRealPart(err[i]) >= fraction * max_err &&
+          max_err > 0.0) {
+        orders[i]++;
+        num_refined++;
+      }
+    }
+    delete[] refinable;
+  }
+
+  MPI_Bcast(&num_refined, 1, MPI_INT, 0, comm);
+
+  return num_refined;
+}
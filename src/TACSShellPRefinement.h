@@ -0,0 +1,118 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_SHELL_P_REFINEMENT_H
+#define TACS_SHELL_P_REFINEMENT_H
+
+#include "TACSCreator.h"
+
+/**
+  Variable-order shell meshes and p-refinement
+
+  The mesh is defined by a serial quadrilateral mesh on the root
+  processor, where the four corner nodes of each element are given in
+  the tensor-product ordering used by the shell elements. Each element
+  is assigned an order between 2 and MAX_ORDER, and the higher-order
+  nodes are generated along the edges and within the elements when
+  the TACSAssembler object is created.
+
+  Elements of different order are joined using the minimum rule: the
+  independent nodes along an edge are those of the lowest-order
+  element that shares the edge. The edge nodes of the higher-order
+  elements are dependent nodes that interpolate the lower-order edge,
+  so that the displacement field remains continuous between elements.
+  Raising the order of an element therefore only adds the interior
+  nodes of the element, and the edge nodes that it shares with
+  elements of the same order.
+
+  The elements are set for each component and order. The element for
+  component comp and order p is stored in the array passed to
+  setElements() at index (MAX_ORDER - 1)*comp + p - 2. Entries for
+  orders that are not used may be NULL.
+
+  The error indicator is computed from the element-average stresses
+  returned by TACSElement::getAverageStresses(). The stresses are
+  recovered at the corner nodes by an area-weighted average of the
+  element values, and the indicator for each element is the
+  area-weighted difference between the recovered and element stresses,
+  with each stress component normalized by its largest magnitude in the
+  mesh. Components that are negligible compared with the others are
+  ignored. The elements with the largest indicators are refined by
+  refine(), after which a new TACSAssembler object is created.
+*/
+class TACSShellPRefinement : public TACSObject {
+ public:
+  static const int MAX_ORDER = 4;
+
+  TACSShellPRefinement(MPI_Comm _comm, int _vars_per_node, int _num_nodes,
+                       int _num_elements, const int *_elem_conn,
+                       const TacsScalar *_Xpts, const int *_elem_comps = NULL);
+  ~TACSShellPRefinement();
+
+  // Set the boundary conditions on the corner nodes
+  // -----------------------------------------------
+  void setBoundaryConditions(int _num_bcs, const int *_bc_nodes,
+                             const int *_bc_ptr = NULL,
+                             const int *_bc_vars = NULL);
+
+  // Set the elements for each component and order
+  // ---------------------------------------------
+  void setElements(int _num_comps, TACSElement **_elements);
+
+  // Set/get the element orders on the root processor
+  // ------------------------------------------------
+  void setElementOrders(const int _orders[]);
+  int getElementOrders(const int **_orders);
+
+  // Create the TACSAssembler object for the current orders
+  // ------------------------------------------------------
+  TACSAssembler *createTACS();
+
+  // Get the number of independent and dependent nodes in the last mesh
+  // ------------------------------------------------------------------
+  void getNumNodes(int *_num_indep_nodes, int *_num_dep_nodes);
+
+  // Estimate the error and refine the mesh
+  // --------------------------------------
+  void computeErrorEstimate(TACSAssembler *assembler, TacsScalar err[]);
+  int refine(const TacsScalar err[], double fraction);
+
+ private:
+  void computeElementAreas(TacsScalar area[]);
+
+  // The communicator
+  MPI_Comm comm;
+  int vars_per_node;
+
+  // The serial corner mesh and the element orders (root only)
+  int num_nodes, num_elements;
+  int *elem_conn, *elem_comps, *orders;
+  TacsScalar *Xpts;
+
+  // The boundary conditions on the corner nodes (root only)
+  int num_bcs;
+  int *bc_nodes, *bc_ptr, *bc_vars;
+
+  // The elements for each component and order
+  int num_comps;
+  TACSElement **elements;
+
+  // The creator for the last mesh, used to find the element partition
+  TACSCreator *creator;
+
+  // The number of nodes in the last mesh
+  int num_indep_nodes, num_dep_nodes;
+};
+
+#endif  // TACS_SHELL_P_REFINEMENT_H
@@ -1,31 +1,59 @@
 #include "TACSSpectralIntegrator.h"
 
-TACSSpectralVec::TACSSpectralVec(int Nvecs, TACSAssembler *assembler) {
+#include "tacslapack.h"
+
+TACSSpectralVec::TACSSpectralVec(int Nvecs, TACSAssembler *assembler,
+                                 MPI_Comm _time_comm, const int *_range) {
   N = Nvecs;
+  initTimeDistribution(_time_comm, _range);
 
   vecs = new TACSBVec *[N];
   for (int i = 0; i < N; i++) {
-    vecs[i] = assembler->createVec();
-    vecs[i]->incref();
+    vecs[i] = NULL;
+    if (i >= start && i < end) {
+      vecs[i] = assembler->createVec();
+      vecs[i]->incref();
+    }
+  }
+
+  temp = NULL;
+  if (time_size > 1) {
+    temp = assembler->createVec();
+    temp->incref();
   }
 }
 
-TACSSpectralVec::TACSSpectralVec(int Nvecs, TACSMat *mat) {
+TACSSpectralVec::TACSSpectralVec(int Nvecs, TACSMat *mat,
+                                 MPI_Comm _time_comm, const int *_range) {
   N = Nvecs;
+  initTimeDistribution(_time_comm, _range);
 
   vecs = new TACSBVec *[N];
   for (int i = 0; i < N; i++) {
-    TACSVec *vec = mat->createVec();
-    vec->incref();
-
-    TACSBVec *bvec = dynamic_cast<TACSBVec *>(vec);
-    if (bvec) {
-      vecs[i] = bvec;
-    } else {
-      vecs[i] = NULL;
-      vec->decref();
+    vecs[i] = NULL;
+    if (i >= start && i < end) {
+      vecs[i] = createBVec(mat);
     }
   }
+
+  temp = NULL;
+  if (time_size > 1) {
+    temp = createBVec(mat);
+  }
+}
+
+/*
+  Create a block vector from the matrix
+*/
+TACSBVec *TACSSpectralVec::createBVec(TACSMat *mat) {
+  TACSVec *vec = mat->createVec();
+  vec->incref();
+
+  TACSBVec *bvec = dynamic_cast<TACSBVec *>(vec);
+  if (!bvec) {
+    vec->decref();
+  }
+  return bvec;
 }
 
 TACSSpectralVec::~TACSSpectralVec() {
@@ -35,18 +63,61 @@ TACSSpectralVec::~TACSSpectralVec() {
     }
   }
   delete[] vecs;
+  delete[] range;
+  if (temp) {
+    temp->decref();
+  }
+}
+
+/*
+  Set the range of time instances owned by this group of processors. If
+  no range is provided, the time instances are split evenly.
+*/
+void TACSSpectralVec::initTimeDistribution(MPI_Comm _time_comm,
+                                           const int *_range) {
+  time_comm = _time_comm;
+  time_rank = 0;
+  time_size = 1;
+  if (time_comm != MPI_COMM_NULL) {
+    MPI_Comm_rank(time_comm, &time_rank);
+    MPI_Comm_size(time_comm, &time_size);
+  }
+
+  range = new int[time_size + 1];
+  for (int i = 0; i <= time_size; i++) {
+    if (_range) {
+      range[i] = _range[i];
+    } else {
+      range[i] = (i * N) / time_size;
+    }
+  }
+  start = range[time_rank];
+  end = range[time_rank + 1];
+}
+
+void TACSSpectralVec::getOwnershipRange(int *_start, int *_end) {
+  if (_start) {
+    *_start = start;
+  }
+  if (_end) {
+    *_end = end;
+  }
 }
 
 TacsScalar TACSSpectralVec::norm() {
   TacsScalar nrm = 0.0;
-  for (int i = 0; i < N; i++) {
+  for (int i = start; i < end; i++) {
     nrm += vecs[i]->dot(vecs[i]);
   }
+  if (time_size > 1) {
+    TacsScalar temp_nrm = nrm;
+    MPI_Allreduce(&temp_nrm, &nrm, 1, TACS_MPI_TYPE, MPI_SUM, time_comm);
+  }
   return sqrt(nrm);
 }
 
 void TACSSpectralVec::scale(TacsScalar alpha) {
-  for (int i = 0; i < N; i++) {
+  for (int i = start; i < end; i++) {
     vecs[i]->scale(alpha);
   }
 }
@@ -55,9 +126,13 @@ TacsScalar TACSSpectralVec::dot(TACSVec *xvec) {
   TACSSpectralVec *x = dynamic_cast<TACSSpectralVec *>(xvec);
   if (x) {
     TacsScalar d = 0.0;
-    for (int i = 0; i < N; i++) {
+    for (int i = start; i < end; i++) {
       d += vecs[i]->dot(x->getVec(i));
     }
+    if (time_size > 1) {
+      TacsScalar temp_d = d;
+      MPI_Allreduce(&temp_d, &d, 1, TACS_MPI_TYPE, MPI_SUM, time_comm);
+    }
     return d;
   }
 
@@ -67,7 +142,7 @@ TacsScalar TACSSpectralVec::dot(TACSVec *xvec) {
 void TACSSpectralVec::axpy(TacsScalar alpha, TACSVec *xvec) {
   TACSSpectralVec *x = dynamic_cast<TACSSpectralVec *>(xvec);
   if (x) {
-    for (int i = 0; i < N; i++) {
+    for (int i = start; i < end; i++) {
       vecs[i]->axpy(alpha, x->getVec(i));
     }
   }
@@ -76,7 +151,7 @@ void TACSSpectralVec::axpy(TacsScalar alpha, TACSVec *xvec) {
 void TACSSpectralVec::copyValues(TACSVec *xvec) {
   TACSSpectralVec *x = dynamic_cast<TACSSpectralVec *>(xvec);
   if (x) {
-    for (int i = 0; i < N; i++) {
+    for (int i = start; i < end; i++) {
       vecs[i]->copyValues(x->getVec(i));
     }
   }
@@ -85,14 +160,14 @@ void TACSSpectralVec::copyValues(TACSVec *xvec) {
 void TACSSpectralVec::axpby(TacsScalar alpha, TacsScalar beta, TACSVec *xvec) {
   TACSSpectralVec *x = dynamic_cast<TACSSpectralVec *>(xvec);
   if (x) {
-    for (int i = 0; i < N; i++) {
+    for (int i = start; i < end; i++) {
       vecs[i]->axpby(alpha, beta, x->getVec(i));
     }
   }
 }
 
 void TACSSpectralVec::zeroEntries() {
-  for (int i = 0; i < N; i++) {
+  for (int i = start; i < end; i++) {
     vecs[i]->zeroEntries();
   }
 }
@@ -104,6 +179,64 @@ TACSBVec *TACSSpectralVec::getVec(int index) {
   return NULL;
 }
 
+/*
+  Broadcast the time instance from the group that owns it. The local
+  arrays match since all the groups have the same spatial partition.
+*/
+TACSBVec *TACSSpectralVec::bcastTimeInstance(int index) {
+  if (time_size == 1) {
+    return vecs[index];
+  }
+
+  int root = 0;
+  while (index >= range[root + 1]) {
+    root++;
+  }
+
+  TACSBVec *vec = (root == time_rank ? vecs[index] : temp);
+  TacsScalar *x;
+  int size = vec->getArray(&x);
+  MPI_Bcast(x, size, TACS_MPI_TYPE, root, time_comm);
+
+  return vec;
+}
+
+/*
+  Apply a dense N x N operator in time to the vector
+
+  y[i] = sum_{j} A[N*i + j] * x[j]
+
+  Each time instance is broadcast once from the group that owns it. The
+  output vector must have the same distribution and cannot be x.
+*/
+void TACSSpectralVec::multTimeOperator(const double *A, TACSSpectralVec *y) {
+  for (int i = start; i < end; i++) {
+    y->vecs[i]->zeroEntries();
+  }
+
+  for (int j = 0; j < N; j++) {
+    TACSBVec *xj = bcastTimeInstance(j);
+    for (int i = start; i < end; i++) {
+      if (A[N * i + j] != 0.0) {
+        y->vecs[i]->axpy(A[N * i + j], xj);
+      }
+    }
+  }
+}
+
+/*
+  Copy all the time instances into a vector that is not distributed in
+  time, and owns all N time instances
+*/
+void TACSSpectralVec::gatherValues(TACSSpectralVec *full) {
+  for (int j = 0; j < N; j++) {
+    TACSBVec *xj = bcastTimeInstance(j);
+    if (xj != full->vecs[j]) {
+      full->vecs[j]->copyValues(xj);
+    }
+  }
+}
+
 /*
   Create a time spectral matrix with the given integrator class
 */
@@ -129,6 +262,9 @@ TACSLinearSpectralMat::TACSLinearSpectralMat(TACSSpectralIntegrator *spec) {
   } else {
     vec->decref();
   }
+
+  dx = dynamic_cast<TACSSpectralVec *>(createVec());
+  dx->incref();
 }
 
 TACSLinearSpectralMat::~TACSLinearSpectralMat() {
@@ -138,10 +274,12 @@ TACSLinearSpectralMat::~TACSLinearSpectralMat() {
   if (temp) {
     temp->decref();
   }
+  dx->decref();
 }
 
 TACSVec *TACSLinearSpectralMat::createVec() {
-  return new TACSSpectralVec(N, H);
+  return new TACSSpectralVec(N, H, spectral->getTimeComm(),
+                             spectral->getTimeRange());
 }
 
 void TACSLinearSpectralMat::mult(TACSVec *xvec, TACSVec *yvec) {
@@ -149,22 +287,21 @@ void TACSLinearSpectralMat::mult(TACSVec *xvec, TACSVec *yvec) {
   TACSSpectralVec *y = dynamic_cast<TACSSpectralVec *>(yvec);
 
   if (x && y) {
-    // Compute the contributions to the derivative
+    // Compute the derivative at the time instances owned by this group,
+    // excluding the initial conditions
+    const double *Dt, *DtT;
+    spectral->getTimeOperator(&Dt, &DtT);
     if (orient == TACS_MAT_NORMAL) {
-      for (int i = 0; i < N; i++) {
-        int include_ics = 0;  // Do not include the initial conditions
-        spectral->computeDeriv(i + 1, x, temp, include_ics);
-        C->mult(temp, y->getVec(i));
-      }
+      x->multTimeOperator(Dt, dx);
     } else {
-      for (int i = 0; i < N; i++) {
-        spectral->computeDerivTranspose(i + 1, x, temp);
-        C->mult(temp, y->getVec(i));
-      }
+      x->multTimeOperator(DtT, dx);
     }
 
-    // Add the diagonal contributions
-    for (int i = 0; i < N; i++) {
+    // Add the contributions from the derivative and the diagonal
+    int start, end;
+    x->getOwnershipRange(&start, &end);
+    for (int i = start; i < end; i++) {
+      C->mult(dx->getVec(i), y->getVec(i));
       H->mult(x->getVec(i), temp);
       y->getVec(i)->axpy(1.0, temp);
     }
@@ -207,6 +344,17 @@ TACSLinearSpectralMg::TACSLinearSpectralMg(TACSLinearSpectralMat *_mat,
   TACSParallelMat *H, *C;
   mat->getMat(&H, &C);
 
+  int time_size = 1;
+  MPI_Comm time_comm = mat->getSpectralIntegrator()->getTimeComm();
+  if (time_comm != MPI_COMM_NULL) {
+    MPI_Comm_size(time_comm, &time_size);
+  }
+  if (time_size > 1) {
+    fprintf(stderr,
+            "TACSLinearSpectralMg: Multigrid is not distributed in time, "
+            "use TACSLinearSpectralDiagPc\n");
+  }
+
   nlevels = _nlevels;
 
   int N = 0;
@@ -744,8 +892,175 @@ void TACSLinearSpectralMg::applyMg(int level) {
   data[level]->applyFactor(data[level]->b, data[level]->x);
 }
 
+/*
+  Create the preconditioner based on the diagonalization in time
+*/
+TACSLinearSpectralDiagPc::TACSLinearSpectralDiagPc(
+    TACSLinearSpectralMat *_mat) {
+  mat = _mat;
+  mat->incref();
+  mat->getMat(&H, &C);
+
+  TACSSpectralIntegrator *spectral = mat->getSpectralIntegrator();
+  N = spectral->getTimeDiagonalization(&eig_real, &eig_imag, &V, &Vinv, &VT,
+                                       &VinvT);
+
+  s = dynamic_cast<TACSSpectralVec *>(mat->createVec());
+  s->incref();
+  w = dynamic_cast<TACSSpectralVec *>(mat->createVec());
+  w->incref();
+  s->getOwnershipRange(&start, &end);
+
+  t0 = dynamic_cast<TACSBVec *>(H->createVec());
+  t0->incref();
+  t1 = dynamic_cast<TACSBVec *>(H->createVec());
+  t1->incref();
+
+  // Create the matrices for the modes owned by this group
+  sigma = new double[N];
+  mode_mats = new TACSParallelMat *[N];
+  mode_pcs = new TACSBlockCyclicPc *[N];
+  for (int k = 0; k < N; k++) {
+    sigma[k] = 0.0;
+    mode_mats[k] = NULL;
+    mode_pcs[k] = NULL;
+
+    if (k >= start && k < end && eig_imag[k] >= 0.0) {
+      sigma[k] = eig_real[k] + eig_imag[k];
+      mode_mats[k] = dynamic_cast<TACSParallelMat *>(H->createDuplicate());
+      mode_mats[k]->incref();
+      mode_pcs[k] = new TACSBlockCyclicPc(mode_mats[k]);
+      mode_pcs[k]->incref();
+    }
+  }
+}
+
+TACSLinearSpectralDiagPc::~TACSLinearSpectralDiagPc() {
+  mat->decref();
+  s->decref();
+  w->decref();
+  t0->decref();
+  t1->decref();
+  for (int k = 0; k < N; k++) {
+    if (mode_mats[k]) {
+      mode_mats[k]->decref();
+      mode_pcs[k]->decref();
+    }
+  }
+  delete[] sigma;
+  delete[] mode_mats;
+  delete[] mode_pcs;
+}
+
+/*
+  Factor H + sigma[k] * C for the modes owned by this group
+*/
+void TACSLinearSpectralDiagPc::factor() {
+  for (int k = start; k < end; k++) {
+    if (mode_mats[k]) {
+      mode_mats[k]->copyValues(H);
+      mode_mats[k]->axpy(sigma[k], C);
+      mode_pcs[k]->factor();
+    }
+  }
+}
+
+/*
+  Apply the preconditioner
+
+  For a complex conjugate pair a +/- ib stored in modes k and k + 1, the
+  transformed system is
+
+  [ A    b*C ][ w[k]     ] = [ s[k]     ]
+  [ -b*C   A ][ w[k + 1] ] = [ s[k + 1] ]
+
+  where A = H + a*C. With B = |b|*C and y = -sign(b)*w[k + 1], this is
+
+  [ A  -B ][ w[k] ] = [ f ] = [ s[k]               ]
+  [ B   A ][ y    ] = [ g ] = [ -sign(b)*s[k + 1]  ]
+
+  The PRESB preconditioner replaces the second diagonal block by A + 2*B
+  and is applied with two solves with A + B:
+
+  h = (A + B)^{-1} (f + g)
+  y = (A + B)^{-1} (A*h - f)
+  w[k] = h - y
+*/
+void TACSLinearSpectralDiagPc::applyFactor(TACSVec *in, TACSVec *out) {
+  TACSSpectralVec *r = dynamic_cast<TACSSpectralVec *>(in);
+  TACSSpectralVec *u = dynamic_cast<TACSSpectralVec *>(out);
+  if (!r || !u) {
+    fprintf(stderr,
+            "TACSLinearSpectralDiagPc type error: Input/output must be "
+            "TACSSpectralVec\n");
+    return;
+  }
+
+  // The transpose system uses D^{T} = V^{-T} * Lambda^{T} * V^{T}
+  int transpose = (mat->getMatrixOrientation() == TACS_MAT_TRANSPOSE);
+
+  // Transform the residual to the modes
+  if (transpose) {
+    r->multTimeOperator(VT, s);
+  } else {
+    r->multTimeOperator(Vinv, s);
+  }
+
+  // Solve for each mode owned by this group
+  for (int k = start; k < end; k++) {
+    if (eig_imag[k] == 0.0) {
+      mode_pcs[k]->applyFactor(s->getVec(k), w->getVec(k));
+    } else if (eig_imag[k] > 0.0) {
+      double a = eig_real[k];
+      double b = (transpose ? -eig_imag[k] : eig_imag[k]);
+      double sb = (b > 0.0 ? 1.0 : -1.0);
+      TACSBVec *s0 = s->getVec(k), *s1 = s->getVec(k + 1);
+      TACSBVec *w0 = w->getVec(k), *w1 = w->getVec(k + 1);
+
+      // h = (A + B)^{-1} (f + g)
+      t0->copyValues(s0);
+      t0->axpy(-sb, s1);
+      mode_pcs[k]->applyFactor(t0, w0);
+
+      // y = (A + B)^{-1} (A*h - f)
+      H->mult(w0, t0);
+      C->mult(w0, t1);
+      t0->axpy(a, t1);
+      t0->axpy(-1.0, s0);
+      mode_pcs[k]->applyFactor(t0, w1);
+
+      // w[k] = h - y and w[k + 1] = -sign(b)*y
+      w0->axpy(-1.0, w1);
+      w1->scale(-sb);
+    }
+  }
+
+  // Transform back from the modes
+  if (transpose) {
+    w->multTimeOperator(VinvT, u);
+  } else {
+    w->multTimeOperator(V, u);
+  }
+}
+
+/*
+  Create the spectral integrator
+
+  When a communicator is provided, the time instances are distributed
+  across groups of processors. The assembler must be created on the
+  spatial communicator of this group, and all groups must have the same
+  spatial partition, for instance with TACSPararealIntegrator's
+  createSlabComm(). Processors with the same spatial rank form the time
+  communicator.
+
+  @param _assembler The model on the spatial communicator of this group
+  @param _tfinal The final time
+  @param _N The number of time instances = number of LGL points - 1
+  @param comm The communicator containing all the groups of processors
+*/
 TACSSpectralIntegrator::TACSSpectralIntegrator(TACSAssembler *_assembler,
-                                               double _tfinal, int _N) {
+                                               double _tfinal, int _N,
+                                               MPI_Comm comm) {
   N = _N;
   pts = NULL;
   wts = NULL;
@@ -756,6 +1071,17 @@ TACSSpectralIntegrator::TACSSpectralIntegrator(TACSAssembler *_assembler,
   assembler = _assembler;
   assembler->incref();
 
+  // Create the time communicator
+  time_comm = MPI_COMM_NULL;
+  time_size = 1;
+  if (comm != MPI_COMM_NULL) {
+    int rank, space_rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_rank(assembler->getMPIComm(), &space_rank);
+    MPI_Comm_split(comm, space_rank, rank, &time_comm);
+    MPI_Comm_size(time_comm, &time_size);
+  }
+
   // Compute the time-spectral part
   tinit = 0.0;
   tfinal = _tfinal;
@@ -767,19 +1093,44 @@ TACSSpectralIntegrator::TACSSpectralIntegrator(TACSAssembler *_assembler,
   // Initialize the operator
   initOperator();
 
+  // Diagonalize the operator and distribute the time instances
+  initTimeDiagonalization();
+  initTimeDistribution();
+
   // Create the initial conditions
   init = assembler->createVec();
   init->incref();
 
   // Set the variables
-  vars = new TACSSpectralVec(N, assembler);
+  vars = createVec();
   vars->incref();
+
+  full_vars = NULL;
+  if (time_size > 1) {
+    full_vars = new TACSSpectralVec(N, assembler);
+    full_vars->incref();
+  }
 }
 
 TACSSpectralIntegrator::~TACSSpectralIntegrator() {
   assembler->decref();
   init->decref();
   vars->decref();
+  if (full_vars) {
+    full_vars->decref();
+  }
+  if (time_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&time_comm);
+  }
+  delete[] time_range;
+  delete[] Dint;
+  delete[] DintT;
+  delete[] eig_real;
+  delete[] eig_imag;
+  delete[] V;
+  delete[] Vinv;
+  delete[] VT;
+  delete[] VinvT;
 
   if (pts) {
     delete[] pts;
@@ -827,8 +1178,70 @@ int TACSSpectralIntegrator::getFirstOrderCoefficients(const double *d[]) {
   return N;
 }
 
+MPI_Comm TACSSpectralIntegrator::getTimeComm() { return time_comm; }
+
+const int *TACSSpectralIntegrator::getTimeRange() { return time_range; }
+
+/*
+  Get the N x N derivative operator at the time instances, excluding the
+  initial condition, and its transpose
+*/
+void TACSSpectralIntegrator::getTimeOperator(const double **Dt,
+                                             const double **DtT) {
+  if (Dt) {
+    *Dt = Dint;
+  }
+  if (DtT) {
+    *DtT = DintT;
+  }
+}
+
+/*
+  Get the real diagonalization of the derivative operator D = V*Lambda*V^{-1}
+
+  Complex conjugate pairs are stored in consecutive entries, with the
+  positive imaginary part first, and the real and imaginary parts of the
+  eigenvector in the corresponding columns of V. All matrices are N x N
+  and stored in row-major order.
+*/
+int TACSSpectralIntegrator::getTimeDiagonalization(
+    const double **eigreal, const double **eigimag, const double **Vt,
+    const double **Vtinv, const double **VtT, const double **VtinvT) {
+  if (eigreal) {
+    *eigreal = eig_real;
+  }
+  if (eigimag) {
+    *eigimag = eig_imag;
+  }
+  if (Vt) {
+    *Vt = V;
+  }
+  if (Vtinv) {
+    *Vtinv = Vinv;
+  }
+  if (VtT) {
+    *VtT = VT;
+  }
+  if (VtinvT) {
+    *VtinvT = VinvT;
+  }
+  return N;
+}
+
 TACSSpectralVec *TACSSpectralIntegrator::createVec() {
-  return new TACSSpectralVec(N, assembler);
+  return new TACSSpectralVec(N, assembler, time_comm, time_range);
+}
+
+/*
+  Get a vector with all the time instances of the solution. When the
+  time instances are distributed, they are gathered into full_vars.
+*/
+TACSSpectralVec *TACSSpectralIntegrator::getFullVec(TACSSpectralVec *sol) {
+  if (time_size > 1) {
+    sol->gatherValues(full_vars);
+    return full_vars;
+  }
+  return sol;
 }
 
 TACSLinearSpectralMat *TACSSpectralIntegrator::createLinearMat() {
@@ -844,18 +1257,17 @@ void TACSSpectralIntegrator::setVariables(TACSSpectralVec *vec) {
 }
 
 void TACSSpectralIntegrator::assembleRes(TACSSpectralVec *res) {
-  TACSBVec *dudt = assembler->createVec();
+  TACSSpectralVec *dudt = createVec();
   dudt->incref();
 
-  for (int i = 0; i < N; i++) {
-    // Extract the u variable for the i+1 LGL point
-    TACSBVec *u = vars->getVec(i);
+  // Compute the derivative at the time instances owned by this group
+  computeDerivs(vars, dudt);
 
-    // Compute the derivative at the time interval
-    computeDeriv(i + 1, vars, dudt);
-
-    // Set the values of the variables at this point
-    assembler->setVariables(u, dudt);
+  int start, end;
+  vars->getOwnershipRange(&start, &end);
+  for (int i = start; i < end; i++) {
+    // Set the values of the variables at the i+1 LGL point
+    assembler->setVariables(vars->getVec(i), dudt->getVec(i));
 
     // Assemble the residual
     assembler->assembleRes(res->getVec(i));
@@ -874,7 +1286,8 @@ void TACSSpectralIntegrator::assembleMat(TACSLinearSpectralMat *mat,
 }
 
 /*
-  Use the spectral operator, compute the derivative
+  Use the spectral operator, compute the derivative. The solution must
+  contain all the time instances.
 */
 void TACSSpectralIntegrator::computeDeriv(int index, TACSSpectralVec *sol,
                                           TACSBVec *dudt,
@@ -914,6 +1327,23 @@ void TACSSpectralIntegrator::computeDerivTranspose(int index,
   }
 }
 
+/*
+  Compute the derivative at the time instances owned by this group
+*/
+void TACSSpectralIntegrator::computeDerivs(TACSSpectralVec *sol,
+                                           TACSSpectralVec *dudt,
+                                           int include_init_conditions) {
+  sol->multTimeOperator(Dint, dudt);
+
+  if (include_init_conditions) {
+    int start, end;
+    sol->getOwnershipRange(&start, &end);
+    for (int i = start; i < end; i++) {
+      dudt->getVec(i)->axpy(D[(i + 1) * (N + 1)], init);
+    }
+  }
+}
+
 void TACSSpectralIntegrator::computeSolutionAndDeriv(double time,
                                                      TACSSpectralVec *sol,
                                                      TACSBVec *u,
@@ -921,6 +1351,7 @@ void TACSSpectralIntegrator::computeSolutionAndDeriv(double time,
   if (!sol) {
     sol = vars;
   }
+  sol = getFullVec(sol);
 
   if (time >= tinit && time <= tfinal) {
     double *P = new double[N + 1];
@@ -970,6 +1401,9 @@ void TACSSpectralIntegrator::evalFunctions(int num_funcs, TACSFunction **funcs,
   TACSBVec *dudt = assembler->createVec();
   dudt->incref();
 
+  // The functions are evaluated by each group with all time instances
+  TACSSpectralVec *sol = getFullVec(vars);
+
   // Initialize the function if had already not been initialized
   if (twoStage) {
     // First stage
@@ -985,9 +1419,9 @@ void TACSSpectralIntegrator::evalFunctions(int num_funcs, TACSFunction **funcs,
       if (i == 0) {
         u = init;
       } else {
-        u = vars->getVec(i - 1);
+        u = sol->getVec(i - 1);
       }
-      computeDeriv(i, vars, dudt);
+      computeDeriv(i, sol, dudt);
 
       // Set the simulation time and variables
       assembler->setSimulationTime(tpts[i]);
@@ -1018,9 +1452,9 @@ void TACSSpectralIntegrator::evalFunctions(int num_funcs, TACSFunction **funcs,
     if (i == 0) {
       u = init;
     } else {
-      u = vars->getVec(i - 1);
+      u = sol->getVec(i - 1);
     }
-    computeDeriv(i, vars, dudt);
+    computeDeriv(i, sol, dudt);
 
     // Set the simulation time and variables
     assembler->setSimulationTime(tpts[i]);
@@ -1054,15 +1488,19 @@ void TACSSpectralIntegrator::evalSVSens(TACSFunction *func,
   TACSBVec *dudt = assembler->createVec();
   dudt->incref();
 
-  for (int i = 1; i < N + 1; i++) {
+  TACSSpectralVec *sol = getFullVec(vars);
+  int start, end;
+  dfdu->getOwnershipRange(&start, &end);
+
+  for (int i = start + 1; i < end + 1; i++) {
     // Get the solution values at the i-th LGL node
     TACSBVec *u = NULL;
     if (i == 0) {
       u = init;
     } else {
-      u = vars->getVec(i - 1);
+      u = sol->getVec(i - 1);
     }
-    computeDeriv(i, vars, dudt);
+    computeDeriv(i, sol, dudt);
 
     // Set the simulation time and variables
     assembler->setSimulationTime(tpts[i]);
@@ -1080,15 +1518,17 @@ void TACSSpectralIntegrator::addDVSens(TACSFunction *func, TACSBVec *dfdx) {
   TACSBVec *dudt = assembler->createVec();
   dudt->incref();
 
+  TACSSpectralVec *sol = getFullVec(vars);
+
   for (int i = 0; i < N + 1; i++) {
     // Get the solution values at the i-th LGL node
     TACSBVec *u = NULL;
     if (i == 0) {
       u = init;
     } else {
-      u = vars->getVec(i - 1);
+      u = sol->getVec(i - 1);
     }
-    computeDeriv(i, vars, dudt);
+    computeDeriv(i, sol, dudt);
 
     // Set the simulation time and variables
     assembler->setSimulationTime(tpts[i]);
@@ -1107,22 +1547,44 @@ void TACSSpectralIntegrator::addAdjointResProduct(TacsScalar scale,
   TACSBVec *dudt = assembler->createVec();
   dudt->incref();
 
-  for (int i = 1; i < N + 1; i++) {
+  TACSSpectralVec *sol = getFullVec(vars);
+  int start, end;
+  adjoint->getOwnershipRange(&start, &end);
+
+  // Add the contributions from other groups through a separate vector
+  TACSBVec *dfdx_local = dfdx;
+  if (time_size > 1) {
+    dfdx_local = assembler->createDesignVec();
+    dfdx_local->incref();
+  }
+
+  for (int i = start + 1; i < end + 1; i++) {
     // Get the solution values at the i-th LGL node
     TACSBVec *u = NULL;
     if (i == 0) {
       u = init;
     } else {
-      u = vars->getVec(i - 1);
+      u = sol->getVec(i - 1);
     }
-    computeDeriv(i, vars, dudt);
+    computeDeriv(i, sol, dudt);
 
     // Set the simulation time and variables
     assembler->setSimulationTime(tpts[i]);
     assembler->setVariables(u, dudt);
 
     TACSBVec *adj = adjoint->getVec(i - 1);
-    assembler->addAdjointResProducts(scale, 1, &adj, &dfdx);
+    assembler->addAdjointResProducts(scale, 1, &adj, &dfdx_local);
+  }
+
+  if (time_size > 1) {
+    dfdx_local->beginSetValues(TACS_ADD_VALUES);
+    dfdx_local->endSetValues(TACS_ADD_VALUES);
+
+    TacsScalar *x;
+    int size = dfdx_local->getArray(&x);
+    MPI_Allreduce(MPI_IN_PLACE, x, size, TACS_MPI_TYPE, MPI_SUM, time_comm);
+    dfdx->axpy(1.0, dfdx_local);
+    dfdx_local->decref();
   }
 
   dudt->decref();
@@ -1254,6 +1716,141 @@ void TACSSpectralIntegrator::initOperator() {
   }
 }
 
+/*
+  Invert the n x n matrix A with Gauss-Jordan elimination and partial
+  pivoting. Returns non-zero if the matrix is singular.
+*/
+static int invertTimeMatrix(int n, const double *A, double *Ainv) {
+  double *B = new double[n * n];
+  for (int i = 0; i < n * n; i++) {
+    B[i] = A[i];
+    Ainv[i] = 0.0;
+  }
+  for (int i = 0; i < n; i++) {
+    Ainv[(n + 1) * i] = 1.0;
+  }
+
+  int fail = 0;
+  for (int k = 0; k < n; k++) {
+    // Find the pivot row
+    int p = k;
+    for (int i = k + 1; i < n; i++) {
+      if (fabs(B[n * i + k]) > fabs(B[n * p + k])) {
+        p = i;
+      }
+    }
+    if (B[n * p + k] == 0.0) {
+      fail = 1;
+      break;
+    }
+    for (int j = 0; j < n; j++) {
+      double t = B[n * k + j];
+      B[n * k + j] = B[n * p + j];
+      B[n * p + j] = t;
+      t = Ainv[n * k + j];
+      Ainv[n * k + j] = Ainv[n * p + j];
+      Ainv[n * p + j] = t;
+    }
+
+    // Eliminate the column from all other rows
+    double inv = 1.0 / B[n * k + k];
+    for (int j = 0; j < n; j++) {
+      B[n * k + j] *= inv;
+      Ainv[n * k + j] *= inv;
+    }
+    for (int i = 0; i < n; i++) {
+      double f = B[n * i + k];
+      if (i != k && f != 0.0) {
+        for (int j = 0; j < n; j++) {
+          B[n * i + j] -= f * B[n * k + j];
+          Ainv[n * i + j] -= f * Ainv[n * k + j];
+        }
+      }
+    }
+  }
+
+  delete[] B;
+  return fail;
+}
+
+/*
+  Form the derivative operator at the time instances, excluding the
+  initial condition, and compute its real diagonalization
+*/
+void TACSSpectralIntegrator::initTimeDiagonalization() {
+  Dint = new double[N * N];
+  DintT = new double[N * N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      Dint[N * i + j] = D[(i + 1) * (N + 1) + j + 1];
+      DintT[N * j + i] = D[(i + 1) * (N + 1) + j + 1];
+    }
+  }
+
+  // LAPACK uses column-major order, so pass in the transpose
+  double *A = new double[N * N];
+  double *VR = new double[N * N];
+  memcpy(A, DintT, N * N * sizeof(double));
+
+  eig_real = new double[N];
+  eig_imag = new double[N];
+  int n = N, lwork = 8 * N, info = 0;
+  double *work = new double[lwork];
+  LAPACKdgeev("N", "V", &n, A, &n, eig_real, eig_imag, NULL, &n, VR, &n, work,
+              &lwork, &info);
+  if (info != 0) {
+    fprintf(stderr,
+            "TACSSpectralIntegrator: Eigenvalue decomposition failed with "
+            "info = %d\n",
+            info);
+  }
+
+  V = new double[N * N];
+  Vinv = new double[N * N];
+  VT = new double[N * N];
+  VinvT = new double[N * N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      V[N * i + j] = VR[i + N * j];
+      VT[N * j + i] = VR[i + N * j];
+    }
+  }
+  if (invertTimeMatrix(N, V, Vinv)) {
+    fprintf(stderr,
+            "TACSSpectralIntegrator: Singular eigenvector matrix for the "
+            "derivative operator\n");
+  }
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      VinvT[N * j + i] = Vinv[N * i + j];
+    }
+  }
+
+  delete[] A;
+  delete[] VR;
+  delete[] work;
+}
+
+/*
+  Split the time instances evenly between the groups without splitting
+  a complex conjugate pair of modes
+*/
+void TACSSpectralIntegrator::initTimeDistribution() {
+  time_range = new int[time_size + 1];
+  time_range[0] = 0;
+  for (int p = 1; p < time_size; p++) {
+    int k = (p * N) / time_size;
+    if (k > 0 && k < N && eig_imag[k - 1] > 0.0) {
+      k++;
+    }
+    if (k < time_range[p - 1]) {
+      k = time_range[p - 1];
+    }
+    time_range[p] = k;
+  }
+  time_range[time_size] = N;
+}
+
 void TACSSpectralIntegrator::evalInterpolation(double pt, double P[],
                                                double Px[]) {
   for (int i = 0; i < N + 1; i++) {
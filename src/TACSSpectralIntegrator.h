@@ -11,11 +11,21 @@ class TACSSpectralIntegrator;
 /*
   The spectral vector contains all the time instances used in the spectral
   expansion, except the initial condition
+
+  The time instances may be distributed across groups of processors. In
+  this case, each group owns a contiguous range of time instances that
+  are stored on its own spatial communicator. The time communicator
+  connects the processors with the same spatial rank in each group, and
+  all groups must have the same spatial partition. The range array has
+  size + 1 entries, where size is the size of the time communicator.
+  getVec() returns NULL for time instances owned by other groups.
 */
 class TACSSpectralVec : public TACSVec {
  public:
-  TACSSpectralVec(int N, TACSAssembler *assembler);
-  TACSSpectralVec(int N, TACSMat *mat);
+  TACSSpectralVec(int N, TACSAssembler *assembler,
+                  MPI_Comm time_comm = MPI_COMM_NULL, const int *range = NULL);
+  TACSSpectralVec(int N, TACSMat *mat, MPI_Comm time_comm = MPI_COMM_NULL,
+                  const int *range = NULL);
   ~TACSSpectralVec();
 
   TacsScalar norm();
@@ -28,9 +38,33 @@ class TACSSpectralVec : public TACSVec {
 
   TACSBVec *getVec(int index);
 
+  // Get the distribution of the time instances
+  int getNumTimeInstances() { return N; }
+  void getOwnershipRange(int *_start, int *_end);
+  MPI_Comm getTimeComm() { return time_comm; }
+
+  // Apply a dense operator in time: y[i] = sum_{j} A[N*i + j] * x[j]
+  void multTimeOperator(const double *A, TACSSpectralVec *y);
+
+  // Copy all the time instances into a vector that owns all of them
+  void gatherValues(TACSSpectralVec *full);
+
  private:
+  void initTimeDistribution(MPI_Comm _time_comm, const int *_range);
+  TACSBVec *createBVec(TACSMat *mat);
+  TACSBVec *bcastTimeInstance(int index);
+
   int N;
   TACSBVec **vecs;
+
+  // The distribution of the time instances
+  MPI_Comm time_comm;
+  int time_rank, time_size;
+  int *range;
+  int start, end;
+
+  // Buffer for time instances owned by other groups
+  TACSBVec *temp;
 };
 
 /*
@@ -51,12 +85,14 @@ class TACSLinearSpectralMat : public TACSMat {
   void setMatrixOrientation(MatrixOrientation matOr);
   MatrixOrientation getMatrixOrientation();
   int getFirstOrderCoefficients(const double *d[]);
+  TACSSpectralIntegrator *getSpectralIntegrator() { return spectral; }
 
  private:
   TACSSpectralIntegrator *spectral;
   int N;
   TACSParallelMat *H, *C;
   TACSBVec *temp;
+  TACSSpectralVec *dx;
   MatrixOrientation orient;
 };
 
@@ -152,9 +188,62 @@ class TACSLinearSpectralMg : public TACSPc {
   TACSLinearSpectralMat *mat;
 };
 
+/*
+  Preconditioner for the spectral system based on the diagonalization of
+  the derivative operator in time
+
+  The derivative operator at the time instances, excluding the initial
+  condition, is diagonalized in real form as D = V * Lambda * V^{-1},
+  where Lambda is block diagonal with the real eigenvalues and 2x2
+  blocks [a, b; -b, a] for each complex conjugate pair a +/- ib. The
+  space-time system is transformed to
+
+  (Lambda x C + I x H) w = (V^{-1} x I) r,   u = (V x I) w
+
+  so that each real eigenvalue gives an independent spatial solve with
+  H + lambda * C. Each complex conjugate pair gives a 2x2 block system
+  in real arithmetic that is solved with two solves with the matrix
+  H + (a + |b|) * C (the PRESB preconditioner). This is exact when H and
+  C are symmetric and positive definite, and a close approximation
+  otherwise, so the preconditioner should be used with GMRES.
+
+  The modes are solved concurrently by the groups of processors that own
+  them. The factorizations are computed with TACSBlockCyclicPc. Note
+  that the conditioning of V grows with the number of time instances.
+*/
+class TACSLinearSpectralDiagPc : public TACSPc {
+ public:
+  TACSLinearSpectralDiagPc(TACSLinearSpectralMat *_mat);
+  ~TACSLinearSpectralDiagPc();
+
+  void factor();
+  void applyFactor(TACSVec *in, TACSVec *out);
+
+ private:
+  TACSLinearSpectralMat *mat;
+  TACSParallelMat *H, *C;
+
+  // The time diagonalization from the integrator
+  int N;
+  const double *eig_real, *eig_imag;
+  const double *V, *Vinv, *VT, *VinvT;
+
+  // The shift and factorization for each mode. Complex conjugate pairs
+  // are stored at the index of the first mode of the pair.
+  int start, end;
+  double *sigma;
+  TACSParallelMat **mode_mats;
+  TACSBlockCyclicPc **mode_pcs;
+
+  // The vectors in the transformed space and temporary vectors
+  TACSSpectralVec *s, *w;
+  TACSBVec *t0, *t1;
+};
+
 class TACSSpectralIntegrator : public TACSObject {
  public:
-  TACSSpectralIntegrator(TACSAssembler *_assembler, double tfinal, int N);
+  TACSSpectralIntegrator(TACSAssembler *_assembler, double tfinal, int N,
+                         MPI_Comm comm = MPI_COMM_NULL);
   ~TACSSpectralIntegrator();
 
   int getNumLGLNodes();
@@ -164,6 +253,18 @@ class TACSSpectralIntegrator : public TACSObject {
   TACSAssembler *getAssembler();
   int getFirstOrderCoefficients(const double *d[]);
 
+  // Get the distribution of the time instances
+  MPI_Comm getTimeComm();
+  const int *getTimeRange();
+
+  // Get the derivative operator at the time instances
+  void getTimeOperator(const double **Dt, const double **DtT);
+
+  // Get the real diagonalization of the derivative operator
+  int getTimeDiagonalization(const double **eigreal, const double **eigimag,
+                             const double **Vt, const double **Vtinv,
+                             const double **VtT, const double **VtinvT);
+
   TACSSpectralVec *createVec();
   TACSLinearSpectralMat *createLinearMat();
   void setInitialConditions(TACSBVec *init);
@@ -184,6 +285,10 @@ class TACSSpectralIntegrator : public TACSObject {
                     int include_init_conditions = 1);
   void computeDerivTranspose(int index, TACSSpectralVec *sol, TACSBVec *dudt);
 
+  // Compute the time derivative at all the time instances
+  void computeDerivs(TACSSpectralVec *sol, TACSSpectralVec *dudt,
+                     int include_init_conditions = 1);
+
   // Compute the solution at a point in the time interval
   void computeSolutionAndDeriv(double time, TACSSpectralVec *sol, TACSBVec *u,
                                TACSBVec *dudt = NULL);
@@ -195,6 +300,13 @@ class TACSSpectralIntegrator : public TACSObject {
   // Initialize the full-order and first-order derivative operators
   void initOperator();
 
+  // Diagonalize the derivative operator and distribute the time instances
+  void initTimeDiagonalization();
+  void initTimeDistribution();
+
+  // Get a copy of the solution that contains all the time instances
+  TACSSpectralVec *getFullVec(TACSSpectralVec *sol);
+
   // Compute the interpolation at a point
   void evalInterpolation(double pt, double P[], double Px[]);
 
@@ -207,6 +319,14 @@ class TACSSpectralIntegrator : public TACSObject {
   // Spectral values
   TACSSpectralVec *vars;
 
+  // The time communicator and the ranges of the time instances
+  MPI_Comm time_comm;
+  int time_size;
+  int *time_range;
+
+  // Copy of the solution at all time instances when distributed in time
+  TACSSpectralVec *full_vars;
+
   // Time values
   double tinit;    // The initial time
   double tfinal;   // The final time
@@ -221,6 +341,13 @@ class TACSSpectralIntegrator : public TACSObject {
   // The derivative operator at the quadrature point
   double *D;   // First derivative operator
   double *d0;  // First-order first derivative operator
+
+  // The derivative operator at the time instances and its transpose
+  double *Dint, *DintT;
+
+  // The real diagonalization of the derivative operator
+  double *eig_real, *eig_imag;
+  double *V, *Vinv, *VT, *VinvT;
 };
 
 #endif  // TACS_SPECTRAL_INTEGRATOR_H
\ No newline at end of file
@@ -0,0 +1,419 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSSpectrumSlicing.h"
+
+#include "TacsUtilities.h"
+
+/*
+  Create the spectrum slicing object. This is collective on comm, and
+  each processor passes in the model for its own group.
+
+  input:
+  comm:         the communicator for all the groups
+  num_groups:   the number of groups (and slices)
+  assembler:    the model created on the group communicator
+  lower:        the lower bound of the interval
+  upper:        the upper bound of the interval
+  bounds:       optional bounds of the slices (num_groups+1 values)
+  max_lanczos:  the maximum size of the Lanczos basis for each slice
+  eig_tol:      the eigenproblem tolerance
+*/
+TACSSpectrumSlicing::TACSSpectrumSlicing(MPI_Comm _comm, int _num_groups,
+                                         TACSAssembler *_assembler,
+                                         double lower, double upper,
+                                         const double *_bounds,
+                                         int _max_lanczos, double _eig_tol) {
+  comm = _comm;
+  num_groups = _num_groups;
+  group = getGroup(comm, num_groups);
+
+  assembler = _assembler;
+  assembler->incref();
+
+  // Check that the model is defined on the group communicator
+  int size, rank, group_size;
+  MPI_Comm_size(comm, &size);
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(assembler->getMPIComm(), &group_size);
+  int expected = 0;
+  for (int i = 0; i < size; i++) {
+    if ((i * num_groups) / size == group) {
+      expected++;
+    }
+  }
+  if (group_size != expected) {
+    fprintf(stderr,
+            "[%d] TACSSpectrumSlicing: The model must be created on the "
+            "group communicator from createGroupComm()\n",
+            rank);
+  }
+
+  // Set the bounds of the slices
+  bounds = new double[num_groups + 1];
+  for (int i = 0; i <= num_groups; i++) {
+    if (_bounds) {
+      bounds[i] = _bounds[i];
+    } else {
+      bounds[i] = lower + ((upper - lower) * i) / num_groups;
+    }
+  }
+
+  // Create the matrices and the direct solver for the shifted problem
+  kmat = assembler->createSchurMat();
+  kmat->incref();
+  mmat = assembler->createSchurMat();
+  mmat->incref();
+  pc = new TACSSchurPc(kmat, 1000000, 10.0, 1);
+  pc->incref();
+  ksm = new GMRES(kmat, pc, 10, 0, 0);
+  ksm->incref();
+  ksm->setTolerances(1e-12, 1e-30);
+
+  // Create the eigensolver
+  max_lanczos = _max_lanczos;
+  eig_tol = _eig_tol;
+  double sigma = 0.5 * (bounds[group] + bounds[group + 1]);
+  ep_op = new EPGeneralizedShiftInvert(sigma, ksm, mmat);
+  ep_op->incref();
+  sep = new SEP(ep_op, max_lanczos, SEP::FULL, assembler->getBcMap());
+  sep->incref();
+
+  slice_counts = new int[num_groups];
+  memset(slice_counts, 0, num_groups * sizeof(int));
+
+  num_eigs = 0;
+  eigs = errors = NULL;
+  eig_group = eig_index = NULL;
+}
+
+TACSSpectrumSlicing::~TACSSpectrumSlicing() {
+  assembler->decref();
+  kmat->decref();
+  mmat->decref();
+  pc->decref();
+  ksm->decref();
+  ep_op->decref();
+  sep->decref();
+  delete[] bounds;
+  delete[] slice_counts;
+  if (eigs) {
+    delete[] eigs;
+    delete[] errors;
+    delete[] eig_group;
+    delete[] eig_index;
+  }
+}
+
+/*
+  Get the group for this processor. The processors are split into
+  contiguous groups of nearly equal size.
+*/
+int TACSSpectrumSlicing::getGroup(MPI_Comm comm, int num_groups) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  return (rank * num_groups) / size;
+}
+
+/*
+  Create the communicator for the group of this processor. The model
+  for the group must be created on this communicator.
+*/
+MPI_Comm TACSSpectrumSlicing::createGroupComm(MPI_Comm comm, int num_groups) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  MPI_Comm group_comm;
+  MPI_Comm_split(comm, getGroup(comm, num_groups), rank, &group_comm);
+  return group_comm;
+}
+
+/*
+  Get the bounds of the given slice
+*/
+void TACSSpectrumSlicing::getSliceBounds(int slice, double *lower,
+                                         double *upper) {
+  if (slice >= 0 && slice < num_groups) {
+    *lower = bounds[slice];
+    *upper = bounds[slice + 1];
+  }
+}
+
+/*
+  Use the thick-restart block Lanczos method within each slice
+*/
+void TACSSpectrumSlicing::setBlockLanczos(int block_size, int max_restarts) {
+  sep->setBlockLanczos(block_size, max_restarts);
+}
+
+/*
+  Assemble and factor K - shift*M and compute its inertia. This returns
+  the number of eigenvalues less than the shift.
+*/
+int TACSSpectrumSlicing::computeInertia(double shift) {
+  assembler->assembleMatType(TACS_STIFFNESS_MATRIX, kmat);
+  assembler->assembleMatType(TACS_MASS_MATRIX, mmat);
+  kmat->axpy(-shift, mmat);
+  kmat->applyBCs(assembler->getBcMap());
+  pc->factor();
+
+  // The rows with boundary conditions contribute positive pivots
+  int nneg, npos;
+  pc->getInertia(&nneg, &npos);
+  return nneg;
+}
+
+/*
+  Compute all the eigenvalues within the interval.
+
+  Each group counts the eigenvalues within its slice and then computes
+  them with a shift placed at the center of the slice. Since the
+  eigenvalues within the slice are closer to the shift than any other
+  eigenvalue, these are the eigenvalues with the largest transformed
+  magnitude. The eigenvalues are assigned to the slice [lower, upper),
+  except for the last slice which is closed, and are then gathered from
+  all the groups.
+*/
+void TACSSpectrumSlicing::solve(KSMPrint *ksm_print) {
+  int rank, group_rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_rank(assembler->getMPIComm(), &group_rank);
+
+  double lower = bounds[group];
+  double upper = bounds[group + 1];
+
+  // Count the eigenvalues within the slice. K is positive
+  // semi-definite, so there are no eigenvalues less than zero.
+  int nlower = 0, nupper = 0;
+  if (lower > 0.0) {
+    nlower = computeInertia(lower);
+  }
+  if (upper > 0.0) {
+    nupper = computeInertia(upper);
+  }
+  int count = nupper - nlower;
+
+  // Factor the shifted matrix at the center of the slice
+  double sigma = 0.5 * (lower + upper);
+  computeInertia(sigma);
+  ep_op->setSigma(sigma);
+
+  // Compute the eigenvalues within the slice
+  int nlocal = 0;
+  TacsScalar *local_eigs = NULL;
+  int *local_index = NULL;
+  if (count > 0) {
+    sep->setTolerances(eig_tol, SEP::NEAREST_SHIFT, count);
+    sep->solve();
+
+    local_eigs = new TacsScalar[2 * count];
+    local_index = new int[count];
+    for (int k = 0; k < count; k++) {
+      TacsScalar error;
+      TacsScalar eig = sep->extractEigenvalue(k, &error);
+      double value = TacsRealPart(eig);
+      if (TacsRealPart(error) >= 0.0 && value >= lower &&
+          (value < upper || (group == num_groups - 1 && value <= upper))) {
+        local_eigs[2 * nlocal] = eig;
+        local_eigs[2 * nlocal + 1] = error;
+        local_index[nlocal] = k;
+        nlocal++;
+      }
+    }
+
+    if (nlocal < count && group_rank == 0) {
+      fprintf(stderr,
+              "TACSSpectrumSlicing: Found %d of %d eigenvalues in "
+              "[%g, %g]\n",
+              nlocal, count, lower, upper);
+    }
+  }
+
+  // Only the root of each group contributes to the merged results
+  if (group_rank != 0) {
+    nlocal = 0;
+    count = 0;
+  }
+  memset(slice_counts, 0, num_groups * sizeof(int));
+  slice_counts[group] = count;
+  MPI_Allreduce(MPI_IN_PLACE, slice_counts, num_groups, MPI_INT, MPI_SUM,
+                comm);
+
+  // Gather the eigenvalues from all the groups
+  int size;
+  MPI_Comm_size(comm, &size);
+  int *counts = new int[size];
+  int *ptr = new int[size + 1];
+  MPI_Allgather(&nlocal, 1, MPI_INT, counts, 1, MPI_INT, comm);
+  ptr[0] = 0;
+  for (int i = 0; i < size; i++) {
+    ptr[i + 1] = ptr[i] + counts[i];
+  }
+  int total = ptr[size];
+
+  int *all_index = new int[total];
+  MPI_Allgatherv(local_index, nlocal, MPI_INT, all_index, counts, ptr,
+                 MPI_INT, comm);
+
+  for (int i = 0; i < size; i++) {
+    counts[i] *= 2;
+    ptr[i] *= 2;
+  }
+  TacsScalar *all_eigs = new TacsScalar[2 * total];
+  MPI_Allgatherv(local_eigs, 2 * nlocal, TACS_MPI_TYPE, all_eigs, counts, ptr,
+                 TACS_MPI_TYPE, comm);
+
+  // Record the group that computed each eigenvalue
+  int *all_group = new int[total];
+  for (int i = 0, k = 0; i < size; i++) {
+    for (int j = 0; j < counts[i] / 2; j++, k++) {
+      all_group[k] = (i * num_groups) / size;
+    }
+  }
+
+  // Sort the eigenvalues in ascending order
+  TacsScalar *values = new TacsScalar[total];
+  int *order = new int[total];
+  for (int i = 0; i < total; i++) {
+    values[i] = all_eigs[2 * i];
+  }
+  TacsArgSort(total, values, order);
+
+  if (eigs) {
+    delete[] eigs;
+    delete[] errors;
+    delete[] eig_group;
+    delete[] eig_index;
+  }
+  eigs = new TacsScalar[total];
+  errors = new TacsScalar[total];
+  eig_group = new int[total];
+  eig_index = new int[total];
+
+  // Merge the eigenvalues, discarding copies of an eigenvalue on the
+  // bound between two slices that were found by both groups
+  const double dup_tol = 1e-8;
+  num_eigs = 0;
+  for (int i = 0; i < total; i++) {
+    int k = order[i];
+    double value = TacsRealPart(all_eigs[2 * k]);
+    if (num_eigs > 0 && eig_group[num_eigs - 1] != all_group[k]) {
+      double prev = TacsRealPart(eigs[num_eigs - 1]);
+      double scale = (fabs(value) > 1.0 ? fabs(value) : 1.0);
+      if (fabs(value - prev) <= dup_tol * scale) {
+        continue;
+      }
+    }
+    eigs[num_eigs] = all_eigs[2 * k];
+    errors[num_eigs] = all_eigs[2 * k + 1];
+    eig_group[num_eigs] = all_group[k];
+    eig_index[num_eigs] = all_index[k];
+    num_eigs++;
+  }
+
+  delete[] counts;
+  delete[] ptr;
+  delete[] all_index;
+  delete[] all_eigs;
+  delete[] all_group;
+  delete[] values;
+  delete[] order;
+  if (local_eigs) {
+    delete[] local_eigs;
+    delete[] local_index;
+  }
+
+  // Print out a summary of the slices and the eigenvalues
+  if (ksm_print) {
+    char line[256];
+    sprintf(line, "%5s %15s %15s %8s\n", "slice", "lower", "upper", "count");
+    ksm_print->print(line);
+    for (int i = 0; i < num_groups; i++) {
+      sprintf(line, "%5d %15.6e %15.6e %8d\n", i, bounds[i], bounds[i + 1],
+              slice_counts[i]);
+      ksm_print->print(line);
+    }
+
+    sprintf(line, "%5s %18s %10s %6s\n", " ", "eigenvalue", "error", "slice");
+    ksm_print->print(line);
+    for (int i = 0; i < num_eigs; i++) {
+      sprintf(line, "%5d %18.10e %10.3e %6d\n", i, TacsRealPart(eigs[i]),
+              TacsRealPart(errors[i]), eig_group[i]);
+      ksm_print->print(line);
+    }
+  }
+}
+
+/*
+  Get the number of eigenvalues within the given slice from the
+  inertia counts
+*/
+int TACSSpectrumSlicing::getSliceCount(int slice) {
+  if (slice >= 0 && slice < num_groups) {
+    return slice_counts[slice];
+  }
+  return 0;
+}
+
+/*
+  Get the group that computed the n-th eigenvalue
+*/
+int TACSSpectrumSlicing::getEigenvalueGroup(int n) {
+  if (n >= 0 && n < num_eigs) {
+    return eig_group[n];
+  }
+  return -1;
+}
+
+/*
+  Extract the n-th eigenvalue in ascending order
+*/
+TacsScalar TACSSpectrumSlicing::extractEigenvalue(int n, TacsScalar *error) {
+  if (n < 0 || n >= num_eigs) {
+    fprintf(stderr, "TACSSpectrumSlicing: Eigenvalue out of range\n");
+    *error = -1.0;
+    return 0.0;
+  }
+
+  *error = errors[n];
+  return eigs[n];
+}
+
+/*
+  Extract the n-th eigenvector in ascending order. This is collective
+  on the group communicator and can only be called by the group that
+  computed the eigenvector.
+*/
+TacsScalar TACSSpectrumSlicing::extractEigenvector(int n, TACSBVec *ans,
+                                                   TacsScalar *error) {
+  if (n < 0 || n >= num_eigs) {
+    fprintf(stderr, "TACSSpectrumSlicing: Eigenvector out of range\n");
+    *error = -1.0;
+    return 0.0;
+  }
+  if (eig_group[n] != group) {
+    fprintf(stderr,
+            "TACSSpectrumSlicing: Eigenvector %d was computed by group %d\n",
+            n, eig_group[n]);
+    *error = -1.0;
+    return eigs[n];
+  }
+
+  return sep->extractEigenvector(eig_index[n], ans, error);
+}
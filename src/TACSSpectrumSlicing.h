@@ -0,0 +1,122 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_SPECTRUM_SLICING_H
+#define TACS_SPECTRUM_SLICING_H
+
+#include "GSEP.h"
+#include "TACSAssembler.h"
+
+/*
+  Spectrum slicing for the natural frequency eigenproblem:
+
+  K u = lambda M u
+
+  The processors are split into groups and the interval [lower, upper]
+  is divided into one slice for each group. Each group holds its own
+  copy of the finite-element model and computes the eigenpairs within
+  its slice independently. The group factors K - s M at the ends of the
+  slice, and the number of negative eigenvalues of these factors gives
+  the number of eigenvalues within the slice by Sylvester's law of
+  inertia. The group then computes these eigenvalues using Lanczos with
+  a shift-invert operator centered in the slice. The eigenvalues from
+  all the groups are merged and de-duplicated at the end.
+
+  Since the groups only communicate to merge the results, the
+  throughput increases with the number of groups rather than with the
+  size of a single factorization.
+
+  The models must be created on the group communicators obtained from
+  createGroupComm(). Eigenvectors can only be extracted by the group
+  that computed them. Since K is positive semi-definite, there are no
+  eigenvalues less than zero and no factorization is required for slice
+  bounds less than or equal to zero. The inertia counts require a
+  complete factorization of a symmetric matrix.
+*/
+class TACSSpectrumSlicing : public TACSObject {
+ public:
+  TACSSpectrumSlicing(MPI_Comm _comm, int _num_groups,
+                      TACSAssembler *_assembler, double lower, double upper,
+                      const double *_bounds = NULL, int _max_lanczos = 100,
+                      double _eig_tol = 1e-8);
+  ~TACSSpectrumSlicing();
+
+  // Split the processors into groups
+  // --------------------------------
+  static int getGroup(MPI_Comm comm, int num_groups);
+  static MPI_Comm createGroupComm(MPI_Comm comm, int num_groups);
+
+  // Retrieve the group data
+  // -----------------------
+  TACSAssembler *getAssembler() { return assembler; }
+  int getGroup() { return group; }
+  int getNumGroups() { return num_groups; }
+  void getSliceBounds(int slice, double *lower, double *upper);
+
+  // Set the eigensolver options
+  // ---------------------------
+  void setBlockLanczos(int block_size, int max_restarts = 25);
+
+  // Solve for all the eigenvalues within the interval
+  // -------------------------------------------------
+  void solve(KSMPrint *ksm_print = NULL);
+
+  // Extract the merged eigenvalues and eigenvectors
+  // -----------------------------------------------
+  int getNumEigenvalues() { return num_eigs; }
+  int getSliceCount(int slice);
+  int getEigenvalueGroup(int n);
+  TacsScalar extractEigenvalue(int n, TacsScalar *error);
+  TacsScalar extractEigenvector(int n, TACSBVec *ans, TacsScalar *error);
+
+ private:
+  // Factor K - shift*M and return the number of negative eigenvalues
+  int computeInertia(double shift);
+
+  // The communicator for all the groups and the group data
+  MPI_Comm comm;
+  int group, num_groups;
+
+  // The finite-element model on this group
+  TACSAssembler *assembler;
+
+  // The bounds of the slices
+  double *bounds;
+
+  // The matrices and the direct solver for the shifted problem
+  TACSSchurMat *kmat, *mmat;
+  TACSSchurPc *pc;
+  TACSKsm *ksm;
+
+  // The eigensolver for this group
+  int max_lanczos;
+  double eig_tol;
+  EPGeneralizedShiftInvert *ep_op;
+  SEP *sep;
+
+  // The number of eigenvalues in each slice from the inertia counts
+  int *slice_counts;
+
+  // The merged eigenvalues, their errors, the group that computed
+  // them and their index within the eigensolver of that group
+  int num_eigs;
+  TacsScalar *eigs, *errors;
+  int *eig_group, *eig_index;
+};
+
+#endif  // TACS_SPECTRUM_SLICING_H
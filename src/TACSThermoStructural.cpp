@@ -0,0 +1,268 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSThermoStructural.h"
+
+/*
+  Create the staggered thermal-structural solver
+
+  input:
+  thermal:     the heat conduction assembler (one variable per node)
+  structure:   the structural assembler
+  coupled:     the coupled thermoelastic assembler
+*/
+TACSThermoStructural::TACSThermoStructural(TACSAssembler *_thermal,
+                                           TACSAssembler *_structure,
+                                           TACSAssembler *_coupled) {
+  thermal = _thermal;
+  thermal->incref();
+  structure = _structure;
+  structure->incref();
+  coupled = _coupled;
+  coupled->incref();
+
+  vars_per_node = structure->getVarsPerNode();
+  if (thermal->getVarsPerNode() != 1 ||
+      coupled->getVarsPerNode() != vars_per_node + 1 ||
+      thermal->getNumOwnedNodes() != coupled->getNumOwnedNodes() ||
+      structure->getNumOwnedNodes() != coupled->getNumOwnedNodes()) {
+    int rank;
+    MPI_Comm_rank(coupled->getMPIComm(), &rank);
+    fprintf(stderr,
+            "[%d] TACSThermoStructural: The assemblers must use the same "
+            "mesh with 1, n and n+1 variables per node\n",
+            rank);
+  }
+
+  // Create the direct solvers for each field
+  tmat = thermal->createSchurMat();
+  tmat->incref();
+  tpc = new TACSSchurPc(tmat, 1000000, 10.0, 1);
+  tpc->incref();
+  tksm = new GMRES(tmat, tpc, 10, 0, 0);
+  tksm->incref();
+  tksm->setTolerances(1e-12, 1e-30);
+
+  smat = structure->createSchurMat();
+  smat->incref();
+  spc = new TACSSchurPc(smat, 1000000, 10.0, 1);
+  spc->incref();
+  sksm = new GMRES(smat, spc, 10, 0, 0);
+  sksm->incref();
+  sksm->setTolerances(1e-12, 1e-30);
+
+  factored = 0;
+  num_factorizations = 0;
+
+  // Create the vectors
+  uc = coupled->createVec();
+  uc->incref();
+  rc = coupled->createVec();
+  rc->incref();
+  rT = thermal->createVec();
+  rT->incref();
+  dT = thermal->createVec();
+  dT->incref();
+  ru = structure->createVec();
+  ru->incref();
+  du = structure->createVec();
+  du->incref();
+
+  rtol = 1e-8;
+  atol = 1e-30;
+  max_iters = 20;
+  print_level = 0;
+  num_iters = 0;
+}
+
+TACSThermoStructural::~TACSThermoStructural() {
+  thermal->decref();
+  structure->decref();
+  coupled->decref();
+  tmat->decref();
+  tpc->decref();
+  tksm->decref();
+  smat->decref();
+  spc->decref();
+  sksm->decref();
+  uc->decref();
+  rc->decref();
+  rT->decref();
+  dT->decref();
+  ru->decref();
+  du->decref();
+}
+
+/*
+  Set the relative and absolute tolerances on the coupled residual
+*/
+void TACSThermoStructural::setTolerances(double _rtol, double _atol) {
+  rtol = _rtol;
+  atol = _atol;
+}
+
+/*
+  Set the maximum number of coupling iterations
+*/
+void TACSThermoStructural::setMaxIterations(int _max_iters) {
+  max_iters = _max_iters;
+}
+
+/*
+  Set the print level (0 for no output)
+*/
+void TACSThermoStructural::setPrintLevel(int _print_level) {
+  print_level = _print_level;
+}
+
+/*
+  Discard the field factorizations so that they are recomputed on the
+  next solve
+*/
+void TACSThermoStructural::resetFactorizations() { factored = 0; }
+
+/*
+  Merge the temperatures and the structural variables into the coupled
+  vector, where the temperature is the last variable at each node
+*/
+void TACSThermoStructural::merge(TACSBVec *T, TACSBVec *u, TACSBVec *uc) {
+  TacsScalar *tarray, *uarray, *carray;
+  T->getArray(&tarray);
+  u->getArray(&uarray);
+  int size = uc->getArray(&carray);
+
+  const int n = vars_per_node;
+  int num_nodes = size / (n + 1);
+  for (int i = 0; i < num_nodes; i++) {
+    memcpy(&carray[(n + 1) * i], &uarray[n * i], n * sizeof(TacsScalar));
+    carray[(n + 1) * i + n] = tarray[i];
+  }
+}
+
+/*
+  Split the coupled vector into the temperatures and the structural
+  variables
+*/
+void TACSThermoStructural::split(TACSBVec *uc, TACSBVec *T, TACSBVec *u) {
+  TacsScalar *tarray, *uarray, *carray;
+  T->getArray(&tarray);
+  u->getArray(&uarray);
+  int size = uc->getArray(&carray);
+
+  const int n = vars_per_node;
+  int num_nodes = size / (n + 1);
+  for (int i = 0; i < num_nodes; i++) {
+    memcpy(&uarray[n * i], &carray[(n + 1) * i], n * sizeof(TacsScalar));
+    tarray[i] = carray[(n + 1) * i + n];
+  }
+}
+
+/*
+  Assemble and factor the Jacobian of each field
+*/
+void TACSThermoStructural::factor(TACSBVec *T, TACSBVec *u) {
+  thermal->setVariables(T);
+  thermal->assembleJacobian(1.0, 0.0, 0.0, NULL, tmat);
+  tpc->factor();
+
+  structure->setVariables(u);
+  structure->assembleJacobian(1.0, 0.0, 0.0, NULL, smat);
+  spc->factor();
+
+  factored = 1;
+  num_factorizations++;
+}
+
+/*
+  Compute the residuals of both fields from the coupled model, less the
+  external loads
+*/
+void TACSThermoStructural::computeResidual(TACSBVec *heat, TACSBVec *force,
+                                           TACSBVec *T, TACSBVec *u) {
+  merge(T, u, uc);
+  coupled->setVariables(uc);
+  coupled->assembleRes(rc);
+  split(rc, rT, ru);
+  if (heat) {
+    rT->axpy(-1.0, heat);
+  }
+  if (force) {
+    ru->axpy(-1.0, force);
+  }
+}
+
+/*
+  Solve the coupled problem with block Gauss-Seidel iterations
+
+  The external loads are given in the layout of each field and may be
+  NULL. The temperatures and the structural variables are used as the
+  starting point and are overwritten with the solution.
+
+  input:
+  heat:    the external heat loads
+  force:   the external structural loads
+
+  input/output:
+  T:       the temperatures
+  u:       the structural variables
+
+  returns: zero when the iterations converged
+*/
+int TACSThermoStructural::solve(TACSBVec *heat, TACSBVec *force,
+                                TACSBVec *T, TACSBVec *u) {
+  int rank;
+  MPI_Comm_rank(coupled->getMPIComm(), &rank);
+
+  if (!factored) {
+    factor(T, u);
+  }
+
+  TacsScalar norm0 = 0.0;
+  for (num_iters = 0; num_iters <= max_iters; num_iters++) {
+    computeResidual(heat, force, T, u);
+    TacsScalar tnorm = rT->norm();
+    TacsScalar unorm = ru->norm();
+    TacsScalar norm = sqrt(tnorm * tnorm + unorm * unorm);
+    if (num_iters == 0) {
+      norm0 = norm;
+    }
+
+    if (rank == 0 && print_level > 0) {
+      printf("TACSThermoStructural %3d |R_T| %15.8e |R_u| %15.8e\n",
+             num_iters, TacsRealPart(tnorm), TacsRealPart(unorm));
+    }
+    if (TacsRealPart(norm) < rtol * TacsRealPart(norm0) ||
+        TacsRealPart(norm) < atol) {
+      return 0;
+    }
+    if (num_iters == max_iters) {
+      break;
+    }
+
+    // Update the temperatures
+    tksm->solve(rT, dT);
+    T->axpy(-1.0, dT);
+
+    // Update the structural variables with the new temperatures
+    computeResidual(heat, force, T, u);
+    sksm->solve(ru, du);
+    u->axpy(-1.0, du);
+  }
+
+  return 1;
+}
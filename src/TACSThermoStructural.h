@@ -0,0 +1,110 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_THERMO_STRUCTURAL_H
+#define TACS_THERMO_STRUCTURAL_H
+
+#include "KSM.h"
+#include "TACSAssembler.h"
+
+/*
+  A staggered solver for coupled thermal-structural problems
+
+  The solver uses three assemblers on the same mesh: a heat conduction
+  model with one variable per node, a structural model, and a coupled
+  thermoelastic model with the structural variables followed by the
+  temperature at each node, such as TACSLinearThermoelasticity3D or
+  TACSThermalShellElement. All three must be created from the same
+  mesh with the same partition and node ordering, and the same
+  boundary conditions.
+
+  The residual of the coupled problem is assembled once per field
+  update by the coupled model, which provides the thermal loads and
+  any other coupling terms. Each field is then updated by block
+  Gauss-Seidel using the factorization of its own Jacobian from the
+  field assemblers:
+
+  T <- T - K_TT^{-1} R_T(u, T)
+  u <- u - K_uu^{-1} R_u(u, T)
+
+  The block size of the factored matrices is one for the temperature
+  and the structural block size for the displacements, instead of the
+  larger block size of the coupled model. The factorizations are
+  computed on the first solve and reused for all coupling iterations
+  and subsequent solves until resetFactorizations() is called, for
+  instance after a design change.
+
+  The temperatures and displacements are split from and merged into the
+  coupled vectors in place, one node at a time.
+*/
+class TACSThermoStructural : public TACSObject {
+ public:
+  TACSThermoStructural(TACSAssembler *_thermal, TACSAssembler *_structure,
+                       TACSAssembler *_coupled);
+  ~TACSThermoStructural();
+
+  // Set the solution parameters
+  // ---------------------------
+  void setTolerances(double _rtol, double _atol);
+  void setMaxIterations(int _max_iters);
+  void setPrintLevel(int _print_level);
+
+  // Discard the field factorizations
+  // --------------------------------
+  void resetFactorizations();
+  int getNumFactorizations() { return num_factorizations; }
+
+  // Solve the coupled problem with the given external loads
+  // -------------------------------------------------------
+  int solve(TACSBVec *heat, TACSBVec *force, TACSBVec *T, TACSBVec *u);
+  int getNumIterations() { return num_iters; }
+
+  // Split and merge the coupled vectors
+  // -----------------------------------
+  void merge(TACSBVec *T, TACSBVec *u, TACSBVec *uc);
+  void split(TACSBVec *uc, TACSBVec *T, TACSBVec *u);
+
+ private:
+  // Factor the field Jacobians at the current states
+  void factor(TACSBVec *T, TACSBVec *u);
+
+  // Compute the residuals of both fields
+  void computeResidual(TACSBVec *heat, TACSBVec *force, TACSBVec *T,
+                       TACSBVec *u);
+
+  // The assemblers
+  TACSAssembler *thermal, *structure, *coupled;
+  int vars_per_node;
+
+  // The solvers for each field
+  TACSSchurMat *tmat, *smat;
+  TACSSchurPc *tpc, *spc;
+  TACSKsm *tksm, *sksm;
+  int factored, num_factorizations;
+
+  // The coupled and the field vectors
+  TACSBVec *uc, *rc;
+  TACSBVec *rT, *dT, *ru, *du;
+
+  // The solution parameters
+  double rtol, atol;
+  int max_iters, print_level;
+  int num_iters;
+};
+
+#endif  // TACS_THERMO_STRUCTURAL_H
@@ -0,0 +1,238 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSThreadSchedule.h"
+
+/**
+  Create the schedule for the index range [0, size)
+
+  The blocks assigned to each thread are chosen so that the sum of the
+  costs in each block is approximately equal. When no costs are
+  provided, each index is assumed to have unit cost.
+
+  @param size The number of indices in the range
+  @param num_threads The number of threads that will execute the loop
+  @param costs Optional estimate of the cost for each index
+  @param min_chunk The minimum number of indices assigned to a thread at once
+*/
+TACSThreadSchedule::TACSThreadSchedule(int _size, int _num_threads,
+                                       const double *costs, int _min_chunk) {
+  size = (_size > 0 ? _size : 0);
+  num_threads = (_num_threads > 1 ? _num_threads : 1);
+  if (_min_chunk < 1) {
+    _min_chunk = 1;
+  }
+
+  block_ptr = new int[num_threads + 1];
+  chunk_size = new int[num_threads];
+  blocks = new std::atomic<uint64_t>[num_threads];
+
+  // Compute the total cost of all the indices
+  double total = 0.0;
+  if (costs) {
+    for (int i = 0; i < size; i++) {
+      total += costs[i];
+    }
+  }
+
+  if (costs && total > 0.0) {
+    // Split the range so that each block has an equal share of the cost
+    block_ptr[0] = 0;
+    double sum = 0.0;
+    for (int i = 0, k = 1; k < num_threads; k++) {
+      double target = (k * total) / num_threads;
+      while (i < size && sum + 0.5 * costs[i] < target) {
+        sum += costs[i];
+        i++;
+      }
+      block_ptr[k] = i;
+    }
+    block_ptr[num_threads] = size;
+  } else {
+    for (int k = 0; k <= num_threads; k++) {
+      block_ptr[k] = (int)(((long)k * size) / num_threads);
+    }
+  }
+
+  // Each thread processes its block in about 16 chunks so that work
+  // remains available for stealing near the end of the loop
+  for (int k = 0; k < num_threads; k++) {
+    int len = block_ptr[k + 1] - block_ptr[k];
+    chunk_size[k] = (len + 15) / 16;
+    if (chunk_size[k] < _min_chunk) {
+      chunk_size[k] = _min_chunk;
+    }
+  }
+
+  reset();
+}
+
+TACSThreadSchedule::~TACSThreadSchedule() {
+  delete[] block_ptr;
+  delete[] chunk_size;
+  delete[] blocks;
+}
+
+/**
+  Get the size of the index range
+*/
+int TACSThreadSchedule::getSize() { return size; }
+
+/**
+  Get the number of threads for which the schedule was constructed
+*/
+int TACSThreadSchedule::getNumThreads() { return num_threads; }
+
+/**
+  Reset the schedule to the initial blocks before executing a loop.
+
+  This must not be called while a loop is using the schedule.
+*/
+void TACSThreadSchedule::reset() {
+  for (int k = 0; k < num_threads; k++) {
+    blocks[k].store(packRange(block_ptr[k], block_ptr[k + 1]));
+  }
+  thread_counter.store(0);
+}
+
+/**
+  Get a unique index for the calling thread.
+
+  If more threads call this function than the schedule was created
+  for, the extra threads receive a negative index and only execute
+  work stolen from the other threads.
+
+  @return The thread index
+*/
+int TACSThreadSchedule::getThreadIndex() {
+  int thread = thread_counter.fetch_add(1);
+  if (thread >= num_threads) {
+    return -1;
+  }
+  return thread;
+}
+
+/**
+  Get the next range of indices [start, end) for the given thread
+
+  @param thread The thread index from getThreadIndex()
+  @param start The first index in the range
+  @param end One past the last index in the range
+  @return One if a range was assigned, zero if the loop is complete
+*/
+int TACSThreadSchedule::getNextRange(int thread, int *start, int *end) {
+  if (thread < 0 || thread >= num_threads) {
+    return stealRange(-1, start, end);
+  }
+
+  while (1) {
+    uint64_t range = blocks[thread].load();
+    uint32_t head, tail;
+    unpackRange(range, &head, &tail);
+
+    if (head < tail) {
+      // Take the next chunk from the front of this thread's block
+      uint32_t next = head + chunk_size[thread];
+      if (next > tail) {
+        next = tail;
+      }
+      if (blocks[thread].compare_exchange_weak(range, packRange(next, tail))) {
+        *start = head;
+        *end = next;
+        return 1;
+      }
+    } else if (!stealRange(thread, start, end)) {
+      // No work remains anywhere
+      return 0;
+    } else if (*start < *end) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  Steal half of the remaining indices from the block with the most
+  remaining work.
+
+  When the thread index is valid, the stolen range is placed in the
+  thread's own (empty) block and an empty range is returned so that
+  the caller takes chunks from it, allowing other threads to steal it
+  in turn. Otherwise, the stolen range is returned directly.
+*/
+int TACSThreadSchedule::stealRange(int thread, int *start, int *end) {
+  while (1) {
+    // Find the block with the most remaining work
+    int victim = -1;
+    uint32_t max_remaining = 0;
+    uint64_t victim_range = 0;
+    for (int k = 0; k < num_threads; k++) {
+      if (k != thread) {
+        uint64_t range = blocks[k].load();
+        uint32_t head, tail;
+        unpackRange(range, &head, &tail);
+        if (head < tail && tail - head > max_remaining) {
+          victim = k;
+          max_remaining = tail - head;
+          victim_range = range;
+        }
+      }
+    }
+
+    if (victim < 0) {
+      *start = *end = 0;
+      return 0;
+    }
+
+    // Take half of the remaining indices from the back of the block
+    uint32_t head, tail;
+    unpackRange(victim_range, &head, &tail);
+    uint32_t new_tail = tail - (tail - head + 1) / 2;
+
+    if (blocks[victim].compare_exchange_weak(victim_range,
+                                             packRange(head, new_tail))) {
+      if (thread >= 0) {
+        blocks[thread].store(packRange(new_tail, tail));
+        *start = *end = 0;
+      } else {
+        *start = new_tail;
+        *end = tail;
+      }
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  Get the block of indices initially assigned to the given thread
+
+  @param thread The thread index
+  @param start The first index in the block
+  @param end One past the last index in the block
+*/
+void TACSThreadSchedule::getThreadBlock(int thread, int *start, int *end) {
+  if (thread >= 0 && thread < num_threads) {
+    *start = block_ptr[thread];
+    *end = block_ptr[thread + 1];
+  } else {
+    *start = *end = 0;
+  }
+}
@@ -0,0 +1,95 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_THREAD_SCHEDULE_H
+#define TACS_THREAD_SCHEDULE_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "TACSObject.h"
+
+/**
+  A work-stealing scheduler for threaded loops over a range of indices.
+
+  The index range [0, size) is split into one contiguous block per
+  thread so that each block has approximately the same estimated
+  cost. Each thread takes chunks from the front of its own block. Once
+  a thread's block is exhausted, it steals half of the remaining
+  indices from the back of the block with the most remaining work.
+
+  The begin/end indices of each block are packed into a single 64-bit
+  word so that all updates are performed with a compare-and-swap
+  without any locks.
+
+  Each thread that executes the loop must first obtain a thread index
+  with getThreadIndex(), and then call getNextRange() until it returns
+  zero. The schedule must be reset before it is used for another loop.
+*/
+class TACSThreadSchedule : public TACSObject {
+ public:
+  TACSThreadSchedule(int _size, int _num_threads, const double *costs = NULL,
+                     int _min_chunk = 1);
+  ~TACSThreadSchedule();
+
+  // Get the size of the index range and the number of threads
+  int getSize();
+  int getNumThreads();
+
+  // Reset the schedule so that it can be used again
+  void reset();
+
+  // Get the thread index to use with getNextRange
+  int getThreadIndex();
+
+  // Get the next range of indices to process
+  int getNextRange(int thread, int *start, int *end);
+
+  // Get the initial range of indices assigned to a thread
+  void getThreadBlock(int thread, int *start, int *end);
+
+ private:
+  // Pack/unpack the range of indices in a block
+  static inline uint64_t packRange(uint32_t head, uint32_t tail) {
+    return ((uint64_t)head << 32) | tail;
+  }
+  static inline void unpackRange(uint64_t range, uint32_t *head,
+                                 uint32_t *tail) {
+    *head = (uint32_t)(range >> 32);
+    *tail = (uint32_t)(range & 0xffffffff);
+  }
+
+  // Steal work from the block with the largest remaining range
+  int stealRange(int thread, int *start, int *end);
+
+  // The size of the index range and the number of threads
+  int size, num_threads;
+
+  // The initial block boundaries and chunk size for each thread
+  int *block_ptr;
+  int *chunk_size;
+
+  // The remaining range for each thread's block
+  std::atomic<uint64_t> *blocks;
+
+  // Counter used to assign the thread indices
+  std::atomic<int> thread_counter;
+};
+
+#endif  // TACS_THREAD_SCHEDULE_H
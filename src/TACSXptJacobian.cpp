@@ -0,0 +1,109 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSXptJacobian.h"
+
+TACSXptJacobian::TACSXptJacobian(TACSAssembler *_assembler) {
+  assembler = _assembler;
+  assembler->incref();
+}
+
+TACSXptJacobian::~TACSXptJacobian() { assembler->decref(); }
+
+/*
+  Create a node vector, the input to mult() and the output of
+  multTranspose()
+*/
+TACSVec *TACSXptJacobian::createVec() { return assembler->createNodeVec(); }
+
+void TACSXptJacobian::mult(TACSVec *x, TACSVec *y) { multMulti(1, &x, &y); }
+
+void TACSXptJacobian::multTranspose(TACSVec *x, TACSVec *y) {
+  multTransposeMulti(1, &x, &y);
+}
+
+/*
+  Compute y[k] = dR/dXpts*x[k] for all the vectors in one element pass
+*/
+void TACSXptJacobian::multMulti(int nvecs, TACSVec **tx, TACSVec **ty) {
+  TACSBVec **x = new TACSBVec *[nvecs];
+  TACSBVec **y = new TACSBVec *[nvecs];
+  int fail = 0;
+  for (int k = 0; k < nvecs; k++) {
+    x[k] = dynamic_cast<TACSBVec *>(tx[k]);
+    y[k] = dynamic_cast<TACSBVec *>(ty[k]);
+    if (!x[k] || !y[k]) {
+      fail = 1;
+    }
+  }
+
+  if (!fail) {
+    for (int k = 0; k < nvecs; k++) {
+      y[k]->zeroEntries();
+    }
+    assembler->addResXptProducts(1.0, nvecs, x, y);
+  }
+
+  delete[] x;
+  delete[] y;
+}
+
+/*
+  Compute y[k] = dR/dXpts^{T}*x[k] for all the vectors in one element
+  pass. The boundary condition entries of the input vectors are not
+  included in the product.
+*/
+void TACSXptJacobian::multTransposeMulti(int nvecs, TACSVec **tx,
+                                         TACSVec **ty) {
+  TACSBVec **x = new TACSBVec *[nvecs];
+  TACSBVec **y = new TACSBVec *[nvecs];
+  int fail = 0;
+  for (int k = 0; k < nvecs; k++) {
+    y[k] = dynamic_cast<TACSBVec *>(ty[k]);
+    x[k] = NULL;
+    TACSBVec *vec = dynamic_cast<TACSBVec *>(tx[k]);
+    if (vec && y[k]) {
+      // Copy the input so that the boundary conditions can be applied
+      x[k] = assembler->createVec();
+      x[k]->incref();
+      x[k]->copyValues(vec);
+      assembler->applyBCs(x[k]);
+    } else {
+      fail = 1;
+    }
+  }
+
+  if (!fail) {
+    for (int k = 0; k < nvecs; k++) {
+      y[k]->zeroEntries();
+    }
+    assembler->addAdjointResXptSensProducts(1.0, nvecs, x, y);
+    for (int k = 0; k < nvecs; k++) {
+      y[k]->beginSetValues(TACS_ADD_VALUES);
+    }
+    for (int k = 0; k < nvecs; k++) {
+      y[k]->endSetValues(TACS_ADD_VALUES);
+    }
+  }
+
+  for (int k = 0; k < nvecs; k++) {
+    if (x[k]) {
+      x[k]->decref();
+    }
+  }
+  delete[] x;
+  delete[] y;
+}
+
+const char *TACSXptJacobian::getObjectName() { return "TACSXptJacobian"; }
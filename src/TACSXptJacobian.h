@@ -0,0 +1,54 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_XPT_JACOBIAN_H
+#define TACS_XPT_JACOBIAN_H
+
+#include "TACSAssembler.h"
+
+/*
+  Matrix-free operator for the derivative of the residuals with
+  respect to the node locations, dR/dXpts.
+
+  The product mult(dXpts, res) computes res = dR/dXpts*dXpts, where
+  dXpts is a node vector and res is a state vector, and
+  multTranspose(psi, dfdXpts) computes dfdXpts = psi^{T}*dR/dXpts.
+  The products are evaluated element by element, so the operator is
+  distributed in the same way as the TACSAssembler object. When a
+  node subset is set with TACSAssembler::setXptSensNodes(), only the
+  columns for the nodes in the subset are retained, and only the
+  elements that touch the subset are visited.
+
+  Several vectors can be multiplied in a single pass over the elements
+  with multMulti() and multTransposeMulti(). This allows the products
+  with a mesh deformation Jacobian to be formed without assembling a
+  dense node vector for each function.
+*/
+class TACSXptJacobian : public TACSMat {
+ public:
+  TACSXptJacobian(TACSAssembler *_assembler);
+  ~TACSXptJacobian();
+
+  TACSVec *createVec();
+  void mult(TACSVec *x, TACSVec *y);
+  void multTranspose(TACSVec *x, TACSVec *y);
+  void multMulti(int nvecs, TACSVec **x, TACSVec **y);
+  void multTransposeMulti(int nvecs, TACSVec **x, TACSVec **y);
+  const char *getObjectName();
+
+ private:
+  TACSAssembler *assembler;
+};
+
+#endif  // TACS_XPT_JACOBIAN_H
@@ -0,0 +1,246 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_DUAL_NUMBER_H
+#define TACS_DUAL_NUMBER_H
+
+#include <cmath>
+
+#include "TACSObject.h"
+
+/*
+  A forward-mode dual number that carries N directional derivatives
+
+  The value and the derivatives are stored as TacsScalar. Evaluating
+  code that is templated on its scalar type with TacsDualNumber<N>
+  computes the derivatives in N directions in a single sweep, where a
+  complex-step evaluation only gives one direction. The derivative of
+  each operation is exact, so there is no step size to choose.
+
+  The comparison operators only act on the real part of the value, so
+  that the same branches are taken as in the real evaluation.
+*/
+template <int N>
+class TacsDualNumber {
+ public:
+  TacsDualNumber() {
+    value = 0.0;
+    for (int k = 0; k < N; k++) {
+      deriv[k] = 0.0;
+    }
+  }
+  TacsDualNumber(const TacsScalar a) {
+    value = a;
+    for (int k = 0; k < N; k++) {
+      deriv[k] = 0.0;
+    }
+  }
+  TacsDualNumber(const TacsScalar a, const TacsScalar d[]) {
+    value = a;
+    for (int k = 0; k < N; k++) {
+      deriv[k] = d[k];
+    }
+  }
+
+  TacsDualNumber<N> &operator+=(const TacsDualNumber<N> &b) {
+    value += b.value;
+    for (int k = 0; k < N; k++) {
+      deriv[k] += b.deriv[k];
+    }
+    return *this;
+  }
+  TacsDualNumber<N> &operator-=(const TacsDualNumber<N> &b) {
+    value -= b.value;
+    for (int k = 0; k < N; k++) {
+      deriv[k] -= b.deriv[k];
+    }
+    return *this;
+  }
+  TacsDualNumber<N> &operator*=(const TacsDualNumber<N> &b) {
+    for (int k = 0; k < N; k++) {
+      deriv[k] = deriv[k] * b.value + value * b.deriv[k];
+    }
+    value *= b.value;
+    return *this;
+  }
+  TacsDualNumber<N> &operator/=(const TacsDualNumber<N> &b) {
+    TacsScalar inv = 1.0 / b.value;
+    value *= inv;
+    for (int k = 0; k < N; k++) {
+      deriv[k] = (deriv[k] - value * b.deriv[k]) * inv;
+    }
+    return *this;
+  }
+
+  TacsScalar value;
+  TacsScalar deriv[N];
+};
+
+/*
+  Apply the chain rule f(a) with the derivative df = f'(a)
+*/
+template <int N>
+inline TacsDualNumber<N> TacsDualChain(const TacsDualNumber<N> &a,
+                                       const TacsScalar f,
+                                       const TacsScalar df) {
+  TacsDualNumber<N> c(f);
+  for (int k = 0; k < N; k++) {
+    c.deriv[k] = df * a.deriv[k];
+  }
+  return c;
+}
+
+// Arithmetic operators
+template <int N>
+inline TacsDualNumber<N> operator-(const TacsDualNumber<N> &a) {
+  return TacsDualChain(a, -a.value, -1.0);
+}
+
+template <int N>
+inline TacsDualNumber<N> operator+(TacsDualNumber<N> a,
+                                   const TacsDualNumber<N> &b) {
+  return a += b;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator-(TacsDualNumber<N> a,
+                                   const TacsDualNumber<N> &b) {
+  return a -= b;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator*(TacsDualNumber<N> a,
+                                   const TacsDualNumber<N> &b) {
+  return a *= b;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator/(TacsDualNumber<N> a,
+                                   const TacsDualNumber<N> &b) {
+  return a /= b;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator+(TacsDualNumber<N> a, const TacsScalar b) {
+  a.value += b;
+  return a;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator+(const TacsScalar a, TacsDualNumber<N> b) {
+  b.value += a;
+  return b;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator-(TacsDualNumber<N> a, const TacsScalar b) {
+  a.value -= b;
+  return a;
+}
+
+template <int N>
+inline TacsDualNumber<N> operator-(const TacsScalar a,
+                                   const TacsDualNumber<N> &b) {
+  return TacsDualChain(b, a - b.value, -1.0);
+}
+
+template <int N>
+inline TacsDualNumber<N> operator*(const TacsDualNumber<N> &a,
+                                   const TacsScalar b) {
+  return TacsDualChain(a, a.value * b, b);
+}
+
+template <int N>
+inline TacsDualNumber<N> operator*(const TacsScalar a,
+                                   const TacsDualNumber<N> &b) {
+  return TacsDualChain(b, a * b.value, a);
+}
+
+template <int N>
+inline TacsDualNumber<N> operator/(const TacsDualNumber<N> &a,
+                                   const TacsScalar b) {
+  return TacsDualChain(a, a.value / b, 1.0 / b);
+}
+
+template <int N>
+inline TacsDualNumber<N> operator/(const TacsScalar a,
+                                   const TacsDualNumber<N> &b) {
+  TacsScalar f = a / b.value;
+  return TacsDualChain(b, f, -f / b.value);
+}
+
+// Comparison operators on the real part of the value
+template <int N>
+inline bool operator<(const TacsDualNumber<N> &a, const TacsDualNumber<N> &b) {
+  return TacsRealPart(a.value) < TacsRealPart(b.value);
+}
+
+template <int N>
+inline bool operator>(const TacsDualNumber<N> &a, const TacsDualNumber<N> &b) {
+  return TacsRealPart(a.value) > TacsRealPart(b.value);
+}
+
+template <int N>
+inline bool operator<(const TacsDualNumber<N> &a, const double b) {
+  return TacsRealPart(a.value) < b;
+}
+
+template <int N>
+inline bool operator>(const TacsDualNumber<N> &a, const double b) {
+  return TacsRealPart(a.value) > b;
+}
+
+// Elementary functions
+template <int N>
+inline TacsDualNumber<N> sqrt(const TacsDualNumber<N> &a) {
+  TacsScalar f = sqrt(a.value);
+  return TacsDualChain(a, f, 0.5 / f);
+}
+
+template <int N>
+inline TacsDualNumber<N> exp(const TacsDualNumber<N> &a) {
+  TacsScalar f = exp(a.value);
+  return TacsDualChain(a, f, f);
+}
+
+template <int N>
+inline TacsDualNumber<N> log(const TacsDualNumber<N> &a) {
+  return TacsDualChain(a, log(a.value), 1.0 / a.value);
+}
+
+template <int N>
+inline TacsDualNumber<N> sin(const TacsDualNumber<N> &a) {
+  return TacsDualChain(a, sin(a.value), cos(a.value));
+}
+
+template <int N>
+inline TacsDualNumber<N> cos(const TacsDualNumber<N> &a) {
+  return TacsDualChain(a, cos(a.value), -sin(a.value));
+}
+
+template <int N>
+inline TacsDualNumber<N> pow(const TacsDualNumber<N> &a, const double p) {
+  TacsScalar f = pow(a.value, p);
+  return TacsDualChain(a, f, p * pow(a.value, p - 1.0));
+}
+
+template <int N>
+inline TacsDualNumber<N> fabs(const TacsDualNumber<N> &a) {
+  if (TacsRealPart(a.value) < 0.0) {
+    return -a;
+  }
+  return a;
+}
+
+#endif  // TACS_DUAL_NUMBER_H
@@ -314,20 +314,20 @@ static inline void addScatterColumn(TacsScalar *X, const int xdim,
   output:
   X:     the values are added to this array
 */
-static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
-                                         const TacsScalar *Y, const int ydim,
-                                         const int *index, const int n,
-                                         const int m) {
+template <typename T>
+static inline void subtractScatterColumn(T *X, const int xdim, const T *Y,
+                                         const int ydim, const int *index,
+                                         const int n, const int m) {
   if (m == 1) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       Y += ydim;
       index++;
     }
   } else if (m == 2) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       Y += ydim;
@@ -335,7 +335,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 3) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -344,7 +344,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 4) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -354,7 +354,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 5) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -365,7 +365,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 6) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -377,7 +377,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 7) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -390,7 +390,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 8) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -404,7 +404,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 9) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -419,7 +419,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 10) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -435,7 +435,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 11) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -452,7 +452,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 12) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -470,7 +470,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 13) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -489,7 +489,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 14) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -509,7 +509,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 15) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -530,7 +530,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else if (m == 16) {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       x[0] -= Y[0];
       x[1] -= Y[1];
       x[2] -= Y[2];
@@ -552,7 +552,7 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
     }
   } else {
     for (int i = 0; i < n; i++) {
-      TacsScalar *x = &X[xdim * index[0]];
+      T *x = &X[xdim * index[0]];
       for (int j = 0; j < m; j++) {
         x[j] -= Y[j];
       }
@@ -562,6 +562,64 @@ static inline void subtractScatterColumn(TacsScalar *X, const int xdim,
   }
 }
 
+/*
+  Overloaded wrappers for the BLAS routines used by the
+  factorization. These select the single-precision routines when the
+  factorization is stored in single precision.
+*/
+static inline void BCSCgemv(const char *t, int *m, int *n, TacsScalar *alpha,
+                            TacsScalar *a, int *lda, TacsScalar *x, int *incx,
+                            TacsScalar *beta, TacsScalar *y, int *incy) {
+  BLASgemv(t, m, n, alpha, a, lda, x, incx, beta, y, incy);
+}
+
+static inline void BCSCtrsv(const char *uplo, const char *trans,
+                            const char *diag, int *n, TacsScalar *a, int *lda,
+                            TacsScalar *x, int *incx) {
+  BLAStrsv(uplo, trans, diag, n, a, lda, x, incx);
+}
+
+static inline void BCSCgemm(const char *ta, const char *tb, int *m, int *n,
+                            int *k, TacsScalar *alpha, TacsScalar *a, int *lda,
+                            TacsScalar *b, int *ldb, TacsScalar *beta,
+                            TacsScalar *c, int *ldc) {
+  BLASgemm(ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+static inline void BCSCtrsm(const char *side, const char *uplo,
+                            const char *transa, const char *diag, int *m,
+                            int *n, TacsScalar *alpha, TacsScalar *a, int *lda,
+                            TacsScalar *b, int *ldb) {
+  BLAStrsm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+}
+
+#ifndef TACS_USE_COMPLEX
+static inline void BCSCgemv(const char *t, int *m, int *n, float *alpha,
+                            float *a, int *lda, float *x, int *incx,
+                            float *beta, float *y, int *incy) {
+  BLASsgemv(t, m, n, alpha, a, lda, x, incx, beta, y, incy);
+}
+
+static inline void BCSCtrsv(const char *uplo, const char *trans,
+                            const char *diag, int *n, float *a, int *lda,
+                            float *x, int *incx) {
+  BLASstrsv(uplo, trans, diag, n, a, lda, x, incx);
+}
+
+static inline void BCSCgemm(const char *ta, const char *tb, int *m, int *n,
+                            int *k, float *alpha, float *a, int *lda, float *b,
+                            int *ldb, float *beta, float *c, int *ldc) {
+  BLASsgemm(ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+static inline void BCSCtrsm(const char *side, const char *uplo,
+                            const char *transa, const char *diag, int *m,
+                            int *n, float *alpha, float *a, int *lda, float *b,
+                            int *ldb) {
+  BLASstrsm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+}
+#endif  // TACS_USE_COMPLEX
+
 /*
   Create the block-based compressed sparse column matrix for
   storage. This constructor takes in a local communicator and the
@@ -1491,8 +1549,15 @@ int BCSCMat::getMaxBlockSize() { return max_block_size; }
   pivoting. Note that the storage format is arranged by groups of
   columns, but is not blocked by row - enabling easier implementation
   of pivoting but sacrificing additional performance, perhaps.
+
+  Consecutive block columns with identical non-zero patterns are
+  merged into supernodes that are factored together as a single
+  node. This increases the width of the panels used in the dense
+  BLAS updates. The supernodes are limited to max_snode_size
+  columns. Setting max_snode_size = 0 uses the block columns from
+  the matrix without merging.
 */
-BCSCMatPivot::BCSCMatPivot(BCSCMat *_mat) {
+BCSCMatPivot::BCSCMatPivot(BCSCMat *_mat, int max_snode_size) {
   mat = _mat;
   mat->incref();
 
@@ -1501,16 +1566,49 @@ BCSCMatPivot::BCSCMatPivot(BCSCMat *_mat) {
 
   // Retrieve the data from the BCSRMat data structure
   int mat_nrows, mat_ncols, mat_nblock_cols;
-  mat->getArrays(&mat_nrows, &mat_ncols, &mat_nblock_cols, &bptr, NULL, NULL,
-                 NULL, NULL);
-
-  // Retrieve the maximum block size in the matrix
-  max_block_size = mat->getMaxBlockSize();
+  const int *mat_bptr, *mat_colp, *mat_rows;
+  mat->getArrays(&mat_nrows, &mat_ncols, &mat_nblock_cols, &mat_bptr, NULL,
+                 &mat_colp, &mat_rows, NULL);
 
   // Set the sizes of the arrays
   nrows = mat_nrows;
   ncols = mat_ncols;
-  nblock_cols = mat_nblock_cols;
+
+  // Detect the supernodes: consecutive block columns with identical
+  // row indices
+  node_block_ptr = new int[mat_nblock_cols + 1];
+  nblock_cols = 0;
+  node_block_ptr[0] = 0;
+  for (int j = 0; j < mat_nblock_cols; j++) {
+    int first = node_block_ptr[nblock_cols];
+    if (j == first) {
+      continue;
+    }
+
+    int size = mat_colp[j + 1] - mat_colp[j];
+    int merge = (mat_bptr[j + 1] - mat_bptr[first] <= max_snode_size &&
+                 size == mat_colp[first + 1] - mat_colp[first] &&
+                 memcmp(&mat_rows[mat_colp[j]], &mat_rows[mat_colp[first]],
+                        size * sizeof(int)) == 0);
+    if (!merge) {
+      nblock_cols++;
+      node_block_ptr[nblock_cols] = j;
+    }
+  }
+  if (mat_nblock_cols > 0) {
+    nblock_cols++;
+  }
+  node_block_ptr[nblock_cols] = mat_nblock_cols;
+
+  // Set the variables in each supernode
+  max_block_size = 0;
+  bptr = new int[nblock_cols + 1];
+  for (int i = 0; i <= nblock_cols; i++) {
+    bptr[i] = mat_bptr[node_block_ptr[i]];
+    if (i > 0 && bptr[i] - bptr[i - 1] > max_block_size) {
+      max_block_size = bptr[i] - bptr[i - 1];
+    }
+  }
 
   // Allocate the temporary buffer
   temp_array_size = 64000;
@@ -1543,6 +1641,12 @@ BCSCMatPivot::BCSCMatPivot(BCSCMat *_mat) {
 
   max_lu_rows_size = 0;
   lu_rows = NULL;
+
+  // The single-precision factorization is not used by default
+  use_single = 0;
+  temp_array_single = NULL;
+  temp_column_single = NULL;
+  LU_single = NULL;
 }
 
 /*
@@ -1585,8 +1689,57 @@ BCSCMatPivot::~BCSCMatPivot() {
   if (lu_rows) {
     delete[] lu_rows;
   }
+  if (temp_array_single) {
+    delete[] temp_array_single;
+  }
+  if (temp_column_single) {
+    delete[] temp_column_single;
+  }
+  if (LU_single) {
+    delete[] LU_single;
+  }
+  delete[] bptr;
+  delete[] node_block_ptr;
 }
 
+/*
+  Set whether the factorization is computed and stored in single
+  precision. This halves the memory and bandwidth required for the
+  factor. The solution from the single-precision factor is accurate to
+  about single precision, so it should be used within iterative
+  refinement or a Krylov method with a double-precision residual.
+
+  The factor must be recomputed after the precision is changed. The
+  single-precision factorization is not available in complex mode.
+*/
+void BCSCMatPivot::setSinglePrecision(int flag) {
+#ifdef TACS_USE_COMPLEX
+  if (flag) {
+    fprintf(stderr,
+            "BCSCMatPivot: Single-precision factorization is not available "
+            "in complex mode\n");
+  }
+#else
+  if ((flag != 0) != (use_single != 0)) {
+    // Free the factor stored in the previous precision
+    if (LU) {
+      delete[] LU;
+      LU = NULL;
+    }
+    if (LU_single) {
+      delete[] LU_single;
+      LU_single = NULL;
+    }
+  }
+  use_single = (flag != 0);
+#endif  // TACS_USE_COMPLEX
+}
+
+/*
+  Is the factorization stored in single precision?
+*/
+int BCSCMatPivot::isSinglePrecision() { return use_single; }
+
 /*
   Determine the topological ordering of the nodes required for the
   application of L^{-1} to a sparse right-hand-side. Here, 'iteration'
@@ -1787,14 +1940,15 @@ void BCSCMatPivot::computeColNzPattern(int iteration, const int *rhs_rows,
   temp_cols:       temporary storage for columns
   temp_cols_size   size of the temporary storage
 */
-void BCSCMatPivot::applyNodeUpdate(int node, int node_dim, TacsScalar *spa,
-                                   int spa_dim, TacsScalar *temp_block,
-                                   int temp_block_size, TacsScalar *temp_cols,
+template <typename T>
+void BCSCMatPivot::applyNodeUpdate(T *LU, int node, int node_dim, T *spa,
+                                   int spa_dim, T *temp_block,
+                                   int temp_block_size, T *temp_cols,
                                    int temp_cols_size) {
   // Determine the location of the diagonal of the L matrix
   int loffset =
       lu_aptr[node] + node_dim * (lu_diag_ptr[node] - lu_col_ptr[node]);
-  TacsScalar *L = &LU[loffset];
+  T *L = &LU[loffset];
 
   // Compute the column size
   int max_col_size = temp_cols_size / spa_dim;
@@ -1804,11 +1958,11 @@ void BCSCMatPivot::applyNodeUpdate(int node, int node_dim, TacsScalar *spa,
 
   // Fill in the block array with the right hand side
   const int *var = &node_to_vars[node_ptr];
-  TacsScalar *tblock = &temp_block[0];
+  T *tblock = &temp_block[0];
 
   for (int i = 0; i < node_dim; i++) {
     // Retrieve the data from the sparse accumulator
-    TacsScalar *tspa = &spa[spa_dim * var[0]];
+    T *tspa = &spa[spa_dim * var[0]];
     for (int j = 0; j < spa_dim; j++) {
       tblock[0] = tspa[0];
       tblock++;
@@ -1823,8 +1977,8 @@ void BCSCMatPivot::applyNodeUpdate(int node, int node_dim, TacsScalar *spa,
   // This solves the equation: x^{T}*L^{T} = f^{T}, however, since
   // we're using row-major ordering this is equivalent to solving x*L =
   // f, (where L is stored as an upper-triangular matrix.
-  TacsScalar alpha = 1.0;
-  BLAStrsm("R", "U", "N", "U", &spa_dim, &node_dim, &alpha, L, &node_dim,
+  T alpha = 1.0;
+  BCSCtrsm("R", "U", "N", "U", &spa_dim, &node_dim, &alpha, L, &node_dim,
            temp_block, &spa_dim);
 
   // Place the result back into the sparse accumulator
@@ -1833,7 +1987,7 @@ void BCSCMatPivot::applyNodeUpdate(int node, int node_dim, TacsScalar *spa,
 
   for (int i = 0; i < node_dim; i++) {
     // Retrieve the data from the sparse accumulator
-    TacsScalar *tspa = &spa[spa_dim * var[0]];
+    T *tspa = &spa[spa_dim * var[0]];
     for (int j = 0; j < spa_dim; j++) {
       tspa[0] = tblock[0];
       tblock++;
@@ -1858,8 +2012,8 @@ void BCSCMatPivot::applyNodeUpdate(int node, int node_dim, TacsScalar *spa,
 
     // Compute the matrix-matrix product:
     // x = L[s:, r:s]*y where y = L[r:s, r:s]^{-1}*spa[r:s, :]
-    TacsScalar alpha = 1.0, beta = 0.0;
-    BLASgemm("N", "N", &spa_dim, &col_size, &node_dim, &alpha, temp_block,
+    T alpha = 1.0, beta = 0.0;
+    BCSCgemm("N", "N", &spa_dim, &col_size, &node_dim, &alpha, temp_block,
              &spa_dim, L, &node_dim, &beta, temp_cols, &spa_dim);
 
     // Update the location of the pointer to the lower block
@@ -1899,16 +2053,16 @@ void BCSCMatPivot::applyNodeUpdate(int node, int node_dim, TacsScalar *spa,
   temp_cols:       temporary storage for columns
   temp_cols_size   size of the temporary storage
 */
-void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
-                                        int spa_dim, TacsScalar *temp_block,
-                                        int temp_block_size,
-                                        TacsScalar *temp_cols,
+template <typename T>
+void BCSCMatPivot::applyNodeUpperUpdate(T *LU, int node, int node_dim, T *spa,
+                                        int spa_dim, T *temp_block,
+                                        int temp_block_size, T *temp_cols,
                                         int temp_cols_size) {
   // Determine the location after the last entry of the U matrix -
   // this is the diagonal block
   int loffset =
       lu_aptr[node] + node_dim * (lu_diag_ptr[node] - lu_col_ptr[node]);
-  TacsScalar *U = &LU[loffset];
+  T *U = &LU[loffset];
 
   // Compute the column size
   int max_col_size = temp_cols_size / spa_dim;
@@ -1918,11 +2072,11 @@ void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
 
   // Fill in the block array with the right hand side
   const int *var = &node_to_vars[node_ptr];
-  TacsScalar *tblock = temp_block;
+  T *tblock = temp_block;
 
   for (int i = 0; i < node_dim; i++) {
     // Retrieve the data from the sparse accumulator
-    TacsScalar *tspa = &spa[spa_dim * var[0]];
+    T *tspa = &spa[spa_dim * var[0]];
     for (int j = 0; j < spa_dim; j++) {
       tblock[0] = tspa[0];
       tblock++;
@@ -1937,8 +2091,8 @@ void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
   // matrix from LAPACK's perspective (column-major order). This code
   // solves the equation: U^{T}*x^{T} = f^{T}, however, since
   // we're using row-major ordering this is equivalent to solving x*U = f
-  TacsScalar alpha = 1.0;
-  BLAStrsm("R", "L", "N", "N", &spa_dim, &node_dim, &alpha, U, &node_dim,
+  T alpha = 1.0;
+  BCSCtrsm("R", "L", "N", "N", &spa_dim, &node_dim, &alpha, U, &node_dim,
            temp_block, &spa_dim);
 
   // Place the result back into the sparse accumulator
@@ -1947,7 +2101,7 @@ void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
 
   for (int i = 0; i < node_dim; i++) {
     // Retrieve the data from the sparse accumulator
-    TacsScalar *tspa = &spa[spa_dim * var[0]];
+    T *tspa = &spa[spa_dim * var[0]];
     for (int j = 0; j < spa_dim; j++) {
       tspa[0] = tblock[0];
       tblock++;
@@ -1972,8 +2126,8 @@ void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
 
     // Compute the matrix-matrix product:
     // x = U[s:, r:s]*y where y = U[r:s, r:s]^{-1}*f[r:s, :]
-    TacsScalar alpha = 1.0, beta = 0.0;
-    BLASgemm("N", "N", &spa_dim, &col_size, &node_dim, &alpha, temp_block,
+    T alpha = 1.0, beta = 0.0;
+    BCSCgemm("N", "N", &spa_dim, &col_size, &node_dim, &alpha, temp_block,
              &spa_dim, U, &node_dim, &beta, temp_cols, &spa_dim);
 
     // Update the location of the pointer to the U block
@@ -1992,9 +2146,8 @@ void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
   the same non-zero structure, this greatly simplifies the
   update/pivoting method.
 
-  At the moment, this code is implemented without BLAS, but several
-  operations in this function could be converted to use level-2 and
-  level-1 BLAS operations.
+  The updates from the previous columns in the panel are applied with
+  level-2 BLAS operations.
 
   This modifies the following data:
   perm:             the permutation sequence
@@ -2010,8 +2163,9 @@ void BCSCMatPivot::applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
   num_rows:     number of rows in the panel
   diag_index:   index of the first diagonal entry of the left-most column
 */
-void BCSCMatPivot::factorNode(int node, TacsScalar *col, int node_dim,
-                              int *rows, int num_rows, int diag_index) {
+template <typename T>
+void BCSCMatPivot::factorNode(int node, T *col, int node_dim, int *rows,
+                              int num_rows, int diag_index) {
   int init_diag_index = diag_index;
 
   // Update the data structure for this newly constructed node
@@ -2022,25 +2176,29 @@ void BCSCMatPivot::factorNode(int node, TacsScalar *col, int node_dim,
     if (j > 0) {
       // Set pointers to the portion of the column corresponding to
       // the lower diagonal matrix
-      TacsScalar *L = &col[node_dim * init_diag_index];
-      TacsScalar *U = &col[node_dim * init_diag_index + j];
+      T *L = &col[node_dim * init_diag_index];
+      T *U = &col[node_dim * init_diag_index + j];
 
       // Solve the problem L[init_diag:diag, init_diag:diag]^{-1}*U
-      BLAStrsv("U", "T", "U", &j, L, &node_dim, U, &node_dim);
-
-      // Update the remaining portion of the panel
-      for (int i = diag_index; i < num_rows; i++) {
-        for (int k = 0; k < j; k++) {
-          col[node_dim * i + j] -= col[node_dim * i + k] * U[k * node_dim];
-        }
+      BCSCtrsv("U", "T", "U", &j, L, &node_dim, U, &node_dim);
+
+      // Update the remaining portion of the panel. Since the panel is
+      // stored in row-major order, it is the transpose of a
+      // column-major matrix from the perspective of BLAS.
+      int nr = num_rows - diag_index;
+      if (nr > 0) {
+        T alpha = -1.0, beta = 1.0;
+        T *M = &col[node_dim * diag_index];
+        BCSCgemv("T", &j, &nr, &alpha, M, &node_dim, U, &node_dim, &beta,
+                 &M[j], &node_dim);
       }
     }
 
     // Determine the maximum value in the current column
     int max_row_index = diag_index;
-    TacsScalar *c = &col[node_dim * diag_index + j];
-    TacsScalar diag_entry = c[0];
-    TacsScalar max_entry = c[0];
+    T *c = &col[node_dim * diag_index + j];
+    T diag_entry = c[0];
+    T max_entry = c[0];
     c += node_dim;
 
     for (int i = diag_index + 1; i < num_rows; i++) {
@@ -2062,7 +2220,7 @@ void BCSCMatPivot::factorNode(int node, TacsScalar *col, int node_dim,
 
     // Record the pivot variable
     int pivot = rows[diag_index];
-    TacsScalar entry = diag_entry;
+    T entry = diag_entry;
 
     // Pivot only if required by the pivot tolerance
     if (fabs(TacsRealPart(max_entry)) > fabs(TacsRealPart(diag_entry))) {
@@ -2079,7 +2237,7 @@ void BCSCMatPivot::factorNode(int node, TacsScalar *col, int node_dim,
 
         // Swap the values in the rows diag/max_row_index
         for (int i = 0; i < node_dim; i++) {
-          TacsScalar temp = col[node_dim * max_row_index + i];
+          T temp = col[node_dim * max_row_index + i];
           col[node_dim * max_row_index + i] = col[node_dim * diag_index + i];
           col[node_dim * diag_index + i] = temp;
         }
@@ -2143,6 +2301,28 @@ void BCSCMatPivot::factorNode(int node, TacsScalar *col, int node_dim,
   returns: the actual fill in from the fully factored matrix
 */
 double BCSCMatPivot::factor(double _fill) {
+#ifndef TACS_USE_COMPLEX
+  if (use_single) {
+    // Allocate the single-precision temporary arrays
+    if (!temp_array_single) {
+      temp_array_single =
+          new float[max_block_size * max_block_size + temp_array_size];
+      temp_column_single = new float[nrows * max_block_size];
+    }
+    return factorImpl(_fill, LU_single, temp_array_single, temp_column_single);
+  }
+#endif  // TACS_USE_COMPLEX
+  return factorImpl(_fill, LU, temp_array, temp_column);
+}
+
+/*
+  Compute the factorization with the given precision of the LU
+  factor. The entries of the matrix are converted to the precision of
+  the factor when they are copied into the sparse accumulator.
+*/
+template <typename T>
+double BCSCMatPivot::factorImpl(double _fill, T *&LU, T *temp_array,
+                                T *temp_column) {
   // Retrieve the data from the BCSRMat data structure
   int mat_nrows, mat_ncols, mat_nblock_cols;
   const int *mat_bptr, *mat_aptr;
@@ -2162,11 +2342,15 @@ double BCSCMatPivot::factor(double _fill) {
     }
 
     // Set the lu size and allocate the array
-    max_lu_size = fill * mat_aptr[nblock_cols];
-    LU = new TacsScalar[max_lu_size];
+    max_lu_size = fill * mat_aptr[mat_nblock_cols];
+    LU = new T[max_lu_size];
 
-    max_lu_rows_size = fill * mat_colp[nblock_cols];
-    lu_rows = new int[max_lu_rows_size];
+    // The row indices are shared between the factors of either
+    // precision
+    if (!lu_rows) {
+      max_lu_rows_size = fill * mat_colp[mat_nblock_cols];
+      lu_rows = new int[max_lu_rows_size];
+    }
   }
 
   // Set the var -> node data structure
@@ -2186,12 +2370,12 @@ double BCSCMatPivot::factor(double _fill) {
   }
 
   // Initialize the temporary storage
-  TacsScalar *temp_block = &temp_array[0];
-  TacsScalar *temp_cols = &temp_array[max_block_size * max_block_size];
+  T *temp_block = &temp_array[0];
+  T *temp_cols = &temp_array[max_block_size * max_block_size];
 
   // Initialize the sparse accumulator object
-  TacsScalar *column = temp_column;
-  memset(column, 0, nrows * max_block_size * sizeof(TacsScalar));
+  T *column = temp_column;
+  memset(column, 0, nrows * max_block_size * sizeof(T));
 
   // Allocate temporary arrays for data used during the factorization
   int *node_stack = &temp_iarray[0];
@@ -2209,27 +2393,36 @@ double BCSCMatPivot::factor(double _fill) {
   lu_diag_ptr[0] = 0;
 
   for (int node = 0; node < nblock_cols; node++) {
-    // Copy the values from the next group of columns to the matrix
+    // Copy the values from the block columns in this supernode to the
+    // temporary column. All the block columns have the same rows.
     int node_dim = bptr[node + 1] - bptr[node];
-    int col_size = mat_colp[node + 1] - mat_colp[node];
-
-    for (int ip = mat_colp[node]; ip < mat_colp[node + 1];
-         ip++, A += node_dim) {
-      // Copy over the values to the temporary column
-      memcpy(&column[node_dim * mat_rows[ip]], A,
-             node_dim * sizeof(TacsScalar));
+    int first = node_block_ptr[node];
+    int col_size = mat_colp[first + 1] - mat_colp[first];
+    const int *col_rows = &mat_rows[mat_colp[first]];
+
+    for (int c = first; c < node_block_ptr[node + 1]; c++) {
+      int cdim = mat_bptr[c + 1] - mat_bptr[c];
+      int offset = mat_bptr[c] - bptr[node];
+      const TacsScalar *a = &A[mat_aptr[c]];
+
+      for (int ip = mat_colp[c]; ip < mat_colp[c + 1]; ip++, a += cdim) {
+        // Copy over the values to the temporary column
+        T *col = &column[node_dim * mat_rows[ip] + offset];
+        for (int k = 0; k < cdim; k++) {
+          col[k] = a[k];
+        }
+      }
     }
 
     // Compute the topological post-order of the nodes
     int num_nodes = 0;
-    computeTopologicalOrder(node, &mat_rows[mat_colp[node]], col_size,
-                            topo_order, &num_nodes, node_stack, node_labels);
+    computeTopologicalOrder(node, col_rows, col_size, topo_order, &num_nodes,
+                            node_stack, node_labels);
 
     // Compute the non-zero pattern of the
     int num_vars = 0;
-    computeColNzPattern(node, &mat_rows[mat_colp[node]], col_size, topo_order,
-                        num_nodes, var_labels, &topo_order[num_nodes],
-                        &num_vars);
+    computeColNzPattern(node, col_rows, col_size, topo_order, num_nodes,
+                        var_labels, &topo_order[num_nodes], &num_vars);
 
     // Compute the additional space required for the non-zero pattern
     int nnz_rows = num_vars;
@@ -2244,10 +2437,10 @@ double BCSCMatPivot::factor(double _fill) {
       max_lu_size = node_dim * nnz_rows + 2 * max_lu_size;
 
       // Allocate a new LU array and free the old one
-      TacsScalar *old_LU = LU;
-      LU = new (std::nothrow) TacsScalar[max_lu_size];
+      T *old_LU = LU;
+      LU = new (std::nothrow) T[max_lu_size];
       if (LU) {
-        memcpy(LU, old_LU, lu_aptr[node] * sizeof(TacsScalar));
+        memcpy(LU, old_LU, lu_aptr[node] * sizeof(T));
       }
       delete[] old_LU;
 
@@ -2281,7 +2474,7 @@ double BCSCMatPivot::factor(double _fill) {
     for (int i = num_nodes - 1; i >= 0; i--) {
       int node = topo_order[i];
       int cdim = bptr[node + 1] - bptr[node];
-      applyNodeUpdate(node, cdim, column, node_dim, temp_block,
+      applyNodeUpdate(LU, node, cdim, column, node_dim, temp_block,
                       node_dim * node_dim, temp_cols, temp_array_size);
     }
 
@@ -2294,7 +2487,7 @@ double BCSCMatPivot::factor(double _fill) {
     lu_aptr[node + 1] = lu_aptr[node] + node_dim * nnz_rows;
 
     // Set the pointer into the LU vector
-    TacsScalar *lu = &LU[lu_aptr[node]];
+    T *lu = &LU[lu_aptr[node]];
     int *lu_row = &lu_rows[lu_col_ptr[node]];
 
     // Scan through all the new data in topological order
@@ -2305,11 +2498,11 @@ double BCSCMatPivot::factor(double _fill) {
         int row = node_to_vars[k];
 
         // Copy the data from the row
-        memcpy(lu, &column[node_dim * row], node_dim * sizeof(TacsScalar));
+        memcpy(lu, &column[node_dim * row], node_dim * sizeof(T));
         lu += node_dim;
 
         // Zero the corresponding row in the dense column
-        memset(&column[node_dim * row], 0, node_dim * sizeof(TacsScalar));
+        memset(&column[node_dim * row], 0, node_dim * sizeof(T));
 
         // Set the row index
         lu_row[0] = row;
@@ -2324,11 +2517,11 @@ double BCSCMatPivot::factor(double _fill) {
       int row = topo_order[i];
 
       // Copy the data from the row
-      memcpy(lu, &column[node_dim * row], node_dim * sizeof(TacsScalar));
+      memcpy(lu, &column[node_dim * row], node_dim * sizeof(T));
       lu += node_dim;
 
       // Zero the corresponding row in 'column'
-      memset(&column[node_dim * row], 0, node_dim * sizeof(TacsScalar));
+      memset(&column[node_dim * row], 0, node_dim * sizeof(T));
 
       // Set the row index and increment the pointer
       lu_row[0] = row;
@@ -2345,7 +2538,9 @@ double BCSCMatPivot::factor(double _fill) {
                diag_index);
   }
 
-  return (1.0 * lu_col_ptr[nblock_cols]) / mat_colp[nblock_cols];
+  // The supernodes store each row index once for all their columns,
+  // so the fill is measured by the number of stored entries
+  return (1.0 * lu_aptr[nblock_cols]) / mat_aptr[mat_nblock_cols];
 }
 
 /*
@@ -2360,12 +2555,32 @@ double BCSCMatPivot::factor(double _fill) {
   X:        the dense matrix of size (nrows, bsize)
 */
 void BCSCMatPivot::applyFactor(TacsScalar *X, int vec_bsize) {
+#ifndef TACS_USE_COMPLEX
+  if (use_single) {
+    applyFactorImpl(X, vec_bsize, LU_single, temp_array_single,
+                    temp_column_single);
+    return;
+  }
+#endif  // TACS_USE_COMPLEX
+  applyFactorImpl(X, vec_bsize, LU, temp_array, temp_column);
+}
+
+/*
+  Apply the factorization stored with the given precision. The
+  right-hand-side is converted to the precision of the factor and the
+  solution is converted back.
+*/
+template <typename T>
+void BCSCMatPivot::applyFactorImpl(TacsScalar *X, int vec_bsize, T *LU,
+                                   T *temp_array, T *temp_column) {
   if (vec_bsize == 1) {
-    memcpy(temp_column, X, nrows * sizeof(TacsScalar));
+    for (int i = 0; i < nrows; i++) {
+      temp_column[i] = X[i];
+    }
 
     // Apply the lower/upper parts of the factorization
-    applyLower(temp_column, 1, temp_array, temp_array_size);
-    applyUpper(temp_column, 1, temp_array, temp_array_size);
+    applyLower(LU, temp_column, 1, temp_array, temp_array_size);
+    applyUpper(LU, temp_column, 1, temp_array, temp_array_size);
 
     for (int i = 0; i < nrows; i++) {
       X[perm[i]] = temp_column[i];
@@ -2394,11 +2609,11 @@ void BCSCMatPivot::applyFactor(TacsScalar *X, int vec_bsize) {
       }
 
       // Apply the lower/upper parts of the factorization
-      applyLower(temp_column, num_cols, temp_array, temp_array_size);
-      applyUpper(temp_column, num_cols, temp_array, temp_array_size);
+      applyLower(LU, temp_column, num_cols, temp_array, temp_array_size);
+      applyUpper(LU, temp_column, num_cols, temp_array, temp_array_size);
 
       // Transpose the answer and copy the result back into the array
-      TacsScalar *c = temp_column;
+      T *c = temp_column;
       for (int i = 0; i < nrows; i++) {
         for (int j = 0; j < vec_bsize; j++) {
           X[nrows * j + perm[i]] = c[0];
@@ -2423,10 +2638,11 @@ void BCSCMatPivot::applyFactor(TacsScalar *X, int vec_bsize) {
   output:
   B = L^{-1}*B
 */
-void BCSCMatPivot::applyLower(TacsScalar *B, int vec_bsize, TacsScalar *temp,
+template <typename T>
+void BCSCMatPivot::applyLower(T *LU, T *B, int vec_bsize, T *temp,
                               int temp_size) {
-  TacsScalar *temp_block = &temp[0];
-  TacsScalar *temp_cols = &temp[vec_bsize * max_block_size];
+  T *temp_block = &temp[0];
+  T *temp_cols = &temp[vec_bsize * max_block_size];
 
   int temp_block_size = vec_bsize * max_block_size;
   int temp_cols_size = temp_size - temp_block_size;
@@ -2434,8 +2650,8 @@ void BCSCMatPivot::applyLower(TacsScalar *B, int vec_bsize, TacsScalar *temp,
   for (int node = 0; node < nblock_cols; node++) {
     int node_dim = bptr[node + 1] - bptr[node];
     // Compute L^{-1}*B
-    applyNodeUpdate(node, node_dim, B, vec_bsize, temp_block, temp_block_size,
-                    temp_cols, temp_cols_size);
+    applyNodeUpdate(LU, node, node_dim, B, vec_bsize, temp_block,
+                    temp_block_size, temp_cols, temp_cols_size);
   }
 }
 
@@ -2450,10 +2666,11 @@ void BCSCMatPivot::applyLower(TacsScalar *B, int vec_bsize, TacsScalar *temp,
   output:
   B = U^{-1}*B
 */
-void BCSCMatPivot::applyUpper(TacsScalar *B, int vec_bsize, TacsScalar *temp,
+template <typename T>
+void BCSCMatPivot::applyUpper(T *LU, T *B, int vec_bsize, T *temp,
                               int temp_size) {
-  TacsScalar *temp_block = &temp[0];
-  TacsScalar *temp_cols = &temp[vec_bsize * max_block_size];
+  T *temp_block = &temp[0];
+  T *temp_cols = &temp[vec_bsize * max_block_size];
 
   int temp_block_size = vec_bsize * max_block_size;
   int temp_cols_size = temp_size - temp_block_size;
@@ -2461,7 +2678,7 @@ void BCSCMatPivot::applyUpper(TacsScalar *B, int vec_bsize, TacsScalar *temp,
   for (int node = nblock_cols - 1; node >= 0; node--) {
     int node_dim = bptr[node + 1] - bptr[node];
     // Compute U^{-1}*B
-    applyNodeUpperUpdate(node, node_dim, B, vec_bsize, temp_block,
+    applyNodeUpperUpdate(LU, node, node_dim, B, vec_bsize, temp_block,
                          temp_block_size, temp_cols, temp_cols_size);
   }
 }
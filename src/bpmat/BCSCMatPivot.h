@@ -178,7 +178,7 @@ class BCSCMat : public TACSObject {
 */
 class BCSCMatPivot : public TACSObject {
  public:
-  BCSCMatPivot(BCSCMat *C);
+  BCSCMatPivot(BCSCMat *C, int max_snode_size = 64);
   ~BCSCMatPivot();
 
   // Factor the matrix and store the result
@@ -187,29 +187,44 @@ class BCSCMatPivot : public TACSObject {
   // Apply the factorization to a right-hand-side vector
   void applyFactor(TacsScalar *X, int vec_bsize);
 
+  // Factor and store the factorization in single precision
+  void setSinglePrecision(int flag);
+  int isSinglePrecision();
+
  private:
+  // The factorization and its application for the given precision
+  // of the factor. The arguments LU, temp_array and temp_column
+  // replace the members of the same names.
+  template <typename T>
+  double factorImpl(double _fill, T *&LU, T *temp_array, T *temp_column);
+  template <typename T>
+  void applyFactorImpl(TacsScalar *X, int vec_bsize, T *LU, T *temp_array,
+                       T *temp_column);
+
   // Apply the lower portion of the factorization
-  void applyLower(TacsScalar *B, int vec_bsize, TacsScalar *temp,
-                  int temp_size);
+  template <typename T>
+  void applyLower(T *LU, T *B, int vec_bsize, T *temp, int temp_size);
 
   // Apply the upper portion of the factorization
-  void applyUpper(TacsScalar *B, int vec_bsize, TacsScalar *temp,
-                  int temp_size);
+  template <typename T>
+  void applyUpper(T *LU, T *B, int vec_bsize, T *temp, int temp_size);
 
   // Apply the column update, spa = L[node]^{-1}*spa, to the columns
-  void applyNodeUpdate(int node, int node_dim, TacsScalar *spa, int spa_width,
-                       TacsScalar *temp_block, int temp_block_size,
-                       TacsScalar *temp_cols, int temp_cols_size);
+  template <typename T>
+  void applyNodeUpdate(T *LU, int node, int node_dim, T *spa, int spa_width,
+                       T *temp_block, int temp_block_size, T *temp_cols,
+                       int temp_cols_size);
 
   // Apply the column update, spa = U[node]^{-1}*spa, to the columns
-  void applyNodeUpperUpdate(int node, int node_dim, TacsScalar *spa,
-                            int spa_width, TacsScalar *temp_block,
-                            int temp_block_size, TacsScalar *temp_cols,
-                            int temp_cols_size);
+  template <typename T>
+  void applyNodeUpperUpdate(T *LU, int node, int node_dim, T *spa,
+                            int spa_width, T *temp_block, int temp_block_size,
+                            T *temp_cols, int temp_cols_size);
 
   // Factor the panel matrix associated with a node
-  void factorNode(int node, TacsScalar *column, int node_size, int *rows,
-                  int num_rows, int diag_index);
+  template <typename T>
+  void factorNode(int node, T *column, int node_size, int *rows, int num_rows,
+                  int diag_index);
 
   // Compute the non-zero pattern of a sparse right-hand-side
   // by performing a depth-first search of the graph G(L^{T})
@@ -244,13 +259,23 @@ class BCSCMatPivot : public TACSObject {
   // The block column that servese as the sparse accumulator
   TacsScalar *temp_column;
 
+  // The temporary arrays and the factor when the factorization is
+  // stored in single precision
+  int use_single;
+  float *temp_array_single;
+  float *temp_column_single;
+  float *LU_single;
+
   // Data to store the LU factorization
   // ----------------------------------
   int nrows;           // The number of rows in the matrix
   int ncols;           // The number of columns in the matrix
-  int nblock_cols;     // The number of block columns
-  int max_block_size;  // The maximum block size
-  const int *bptr;     // Pointer to the block-pointer in mat
+  int nblock_cols;     // The number of supernodes
+  int max_block_size;  // The maximum supernode size
+  int *bptr;           // Pointer to the first variable in each supernode
+
+  // The first block column in mat of each supernode
+  int *node_block_ptr;
 
   // Store the permutation array
   int *perm;  // row i in A -> row perm[i] in P*A
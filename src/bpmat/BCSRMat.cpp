@@ -21,6 +21,8 @@
 #include <stdio.h>
 
 #include "BCSRMatImpl.h"
+#include "BCSRMatTemplate.h"
+#include "TACSProfiler.h"
 #include "TacsUtilities.h"
 #include "tacslapack.h"
 
@@ -28,6 +30,281 @@
   BCSR matrix implementation
 */
 
+/*
+  Add the flops and bytes for one pass over the non-zero blocks of the
+  matrix (a product or a triangular solve) to the profiler scope
+*/
+static void BCSRMatAddPassWork(BCSRMatData *data, TACSProfileScope *scope) {
+  if (TACSProfiler::isEnabled()) {
+    double nnz = data->rowp[data->nrows];
+    double entries = nnz * data->bsize * data->bsize;
+    double bytes = entries * sizeof(TacsScalar) + nnz * sizeof(int) +
+                   2.0 * data->nrows * data->bsize * sizeof(TacsScalar);
+    scope->addWork(2.0 * entries, bytes);
+  }
+}
+
+/*
+  Roofline statistics for the BCSRMat kernels
+
+  When TACS is built with -DTACS_KERNEL_PROFILE, each kernel records
+  its wall time, the flops and the bytes read and written. The work is
+  computed from the number of non-zero blocks, assuming that each
+  matrix entry, index and vector entry is transferred once per call.
+  The byte counts are therefore the minimum traffic, and the achieved
+  bandwidth computed from them is a lower bound.
+*/
+struct BCSRMatKernelStats {
+  long calls;
+  double time, flops, bytes_read, bytes_written;
+};
+
+static pthread_mutex_t bcsr_kernel_mutex = PTHREAD_MUTEX_INITIALIZER;
+static BCSRMatKernelStats bcsr_kernel_stats[BCSRMat::NUM_KERNEL_TYPES];
+static const char *bcsr_kernel_names[] = {
+    "mult",       "multAdd", "multTranspose", "applyFactor", "applyLower",
+    "applyUpper", "factor",  "matMultAdd",    "applySOR"};
+
+#ifdef TACS_KERNEL_PROFILE
+/*
+  The work performed by one kernel call
+*/
+struct BCSRMatKernelWork {
+  double flops, bytes_read, bytes_written;
+};
+
+/*
+  Record the time and work of a kernel for the enclosing scope
+*/
+class BCSRMatKernelTimer {
+ public:
+  BCSRMatKernelTimer(BCSRMat::KernelType _type, BCSRMatKernelWork _work) {
+    type = _type;
+    work = _work;
+    t0 = MPI_Wtime();
+  }
+  ~BCSRMatKernelTimer() {
+    double t = MPI_Wtime() - t0;
+    pthread_mutex_lock(&bcsr_kernel_mutex);
+    BCSRMatKernelStats *s = &bcsr_kernel_stats[type];
+    s->calls++;
+    s->time += t;
+    s->flops += work.flops;
+    s->bytes_read += work.bytes_read;
+    s->bytes_written += work.bytes_written;
+    pthread_mutex_unlock(&bcsr_kernel_mutex);
+  }
+
+ private:
+  BCSRMat::KernelType type;
+  BCSRMatKernelWork work;
+  double t0;
+};
+
+#define BCSR_KERNEL_TIMER(type, work) \
+  BCSRMatKernelTimer kernel_timer(type, work)
+
+/*
+  The size of the stored matrix entries
+*/
+static double BCSRMatValueSize(BCSRMatData *data) {
+  return (data->Af ? sizeof(BCSRFactorScalar) : sizeof(TacsScalar));
+}
+
+/*
+  The work for iters products with the rows in the range [start, end).
+  When add is true, a second input vector is read.
+*/
+static BCSRMatKernelWork BCSRMatProductWork(BCSRMatData *data, int start,
+                                            int end, int add, int iters = 1) {
+  double b = data->bsize;
+  double nnz = data->rowp[end] - data->rowp[start];
+  double nr = end - start;
+  BCSRMatKernelWork w;
+  w.flops = iters * 2.0 * b * b * nnz;
+  w.bytes_read =
+      iters * (b * b * nnz * BCSRMatValueSize(data) +
+               (nnz + nr + 1) * sizeof(int) +
+               (data->ncols + add * nr) * b * sizeof(TacsScalar));
+  w.bytes_written = iters * nr * b * sizeof(TacsScalar);
+  return w;
+}
+
+/*
+  The work for the triangular solves with the lower and/or upper
+  factors. The upper factor includes the inverse of the diagonal.
+*/
+static BCSRMatKernelWork BCSRMatTriangularWork(BCSRMatData *data, int lower,
+                                               int upper) {
+  double b = data->bsize;
+  double nlower = 0.0, nupper = 0.0;
+  if (data->diag) {
+    for (int i = 0; i < data->nrows; i++) {
+      nlower += data->diag[i] - data->rowp[i];
+      nupper += data->rowp[i + 1] - data->diag[i];
+    }
+  }
+  double nnz = (lower ? nlower : 0.0) + (upper ? nupper : 0.0);
+  double nr = data->nrows;
+  double passes = (lower ? 1.0 : 0.0) + (upper ? 1.0 : 0.0);
+  BCSRMatKernelWork w;
+  w.flops = 2.0 * b * b * nnz;
+  w.bytes_read = b * b * nnz * BCSRMatValueSize(data) +
+                 (nnz + passes * (nr + 1)) * sizeof(int) +
+                 passes * nr * b * sizeof(TacsScalar);
+  w.bytes_written = passes * nr * b * sizeof(TacsScalar);
+  return w;
+}
+
+/*
+  The work for the numerical factorization. The number of block
+  products is an upper bound, since the updates that fall outside the
+  non-zero pattern are dropped.
+*/
+static BCSRMatKernelWork BCSRMatFactorWork(BCSRMatData *data) {
+  double b = data->bsize;
+  double nnz = data->rowp[data->nrows];
+  double nprod = 0.0;
+  if (data->diag) {
+    for (int i = 0; i < data->nrows; i++) {
+      for (int jp = data->rowp[i]; jp < data->diag[i]; jp++) {
+        int j = data->cols[jp];
+        nprod += 1.0 + (data->rowp[j + 1] - data->diag[j] - 1);
+      }
+    }
+  }
+  BCSRMatKernelWork w;
+  w.flops = 2.0 * b * b * b * (nprod + data->nrows);
+  w.bytes_read = b * b * nnz * sizeof(TacsScalar) +
+                 (nnz + 2.0 * data->nrows + 1) * sizeof(int);
+  w.bytes_written = b * b * nnz * sizeof(TacsScalar);
+  return w;
+}
+
+/*
+  The work for the product C += alpha*A*B
+*/
+static BCSRMatKernelWork BCSRMatMatProductWork(BCSRMatData *C,
+                                               BCSRMatData *A,
+                                               BCSRMatData *B) {
+  double b = C->bsize;
+  double nprod = 0.0;
+  for (int i = 0; i < A->nrows; i++) {
+    for (int kp = A->rowp[i]; kp < A->rowp[i + 1]; kp++) {
+      int k = A->cols[kp];
+      nprod += B->rowp[k + 1] - B->rowp[k];
+    }
+  }
+  double nnz = A->rowp[A->nrows] + B->rowp[B->nrows] + C->rowp[C->nrows];
+  BCSRMatKernelWork w;
+  w.flops = 2.0 * b * b * b * nprod;
+  w.bytes_read = b * b * nnz * sizeof(TacsScalar) +
+                 (nnz + A->nrows + B->nrows + C->nrows + 3) * sizeof(int);
+  w.bytes_written = b * b * C->rowp[C->nrows] * sizeof(TacsScalar);
+  return w;
+}
+#else
+#define BCSR_KERNEL_TIMER(type, work)
+#endif  // TACS_KERNEL_PROFILE
+
+/*!
+  Get the statistics recorded for a kernel
+
+  @param type The type of kernel
+  @param calls The number of calls
+  @param time The total wall time of the calls
+  @param flops The number of floating point operations
+  @param bytes_read The number of bytes read
+  @param bytes_written The number of bytes written
+*/
+void BCSRMat::getKernelStats(KernelType type, long *calls, double *time,
+                             double *flops, double *bytes_read,
+                             double *bytes_written) {
+  BCSRMatKernelStats s = {0, 0.0, 0.0, 0.0, 0.0};
+  if (type >= 0 && type < NUM_KERNEL_TYPES) {
+    pthread_mutex_lock(&bcsr_kernel_mutex);
+    s = bcsr_kernel_stats[type];
+    pthread_mutex_unlock(&bcsr_kernel_mutex);
+  }
+  if (calls) {
+    *calls = s.calls;
+  }
+  if (time) {
+    *time = s.time;
+  }
+  if (flops) {
+    *flops = s.flops;
+  }
+  if (bytes_read) {
+    *bytes_read = s.bytes_read;
+  }
+  if (bytes_written) {
+    *bytes_written = s.bytes_written;
+  }
+}
+
+/*!
+  Discard the statistics recorded for all kernels
+*/
+void BCSRMat::resetKernelStats() {
+  pthread_mutex_lock(&bcsr_kernel_mutex);
+  memset(bcsr_kernel_stats, 0, sizeof(bcsr_kernel_stats));
+  pthread_mutex_unlock(&bcsr_kernel_mutex);
+}
+
+/*!
+  Print the achieved GFLOP/s and GB/s of each kernel
+
+  The work is summed over all processes and divided by the maximum
+  time over the processes, so the rates are for the whole
+  communicator. This call is collective on comm.
+
+  @param comm The communicator
+  @param fp The file to print to on the root processor
+*/
+void BCSRMat::printKernelStats(MPI_Comm comm, FILE *fp) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  const int n = NUM_KERNEL_TYPES;
+  double local[5 * n], sums[5 * n], times[n], tmax[n];
+  pthread_mutex_lock(&bcsr_kernel_mutex);
+  for (int k = 0; k < n; k++) {
+    times[k] = bcsr_kernel_stats[k].time;
+    local[5 * k] = bcsr_kernel_stats[k].calls;
+    local[5 * k + 1] = bcsr_kernel_stats[k].time;
+    local[5 * k + 2] = bcsr_kernel_stats[k].flops;
+    local[5 * k + 3] = bcsr_kernel_stats[k].bytes_read;
+    local[5 * k + 4] = bcsr_kernel_stats[k].bytes_written;
+  }
+  pthread_mutex_unlock(&bcsr_kernel_mutex);
+
+  MPI_Reduce(local, sums, 5 * n, MPI_DOUBLE, MPI_SUM, 0, comm);
+  MPI_Reduce(times, tmax, n, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+  if (rank == 0 && fp) {
+#ifndef TACS_KERNEL_PROFILE
+    fprintf(fp,
+            "BCSRMat: Kernel statistics require -DTACS_KERNEL_PROFILE\n");
+#endif  // TACS_KERNEL_PROFILE
+    fprintf(fp, "%-15s %10s %12s %12s %12s %12s %10s\n", "kernel", "calls",
+            "time", "GB read", "GB written", "GFLOP/s", "GB/s");
+    for (int k = 0; k < n; k++) {
+      double calls = sums[5 * k];
+      if (calls > 0.0) {
+        double t = tmax[k];
+        double flops = sums[5 * k + 2];
+        double bytes = sums[5 * k + 3] + sums[5 * k + 4];
+        fprintf(fp, "%-15s %10.0f %12.6f %12.4f %12.4f %12.4f %10.4f\n",
+                bcsr_kernel_names[k], calls, t, 1e-9 * sums[5 * k + 3],
+                1e-9 * sums[5 * k + 4], (t > 0.0 ? 1e-9 * flops / t : 0.0),
+                (t > 0.0 ? 1e-9 * bytes / t : 0.0));
+      }
+    }
+    fflush(fp);
+  }
+}
+
 /*
   Merge two uniquely sorted arrays with levels associated with them.
 
@@ -142,6 +419,8 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *mat, int levFill, double fill,
   thread_info->incref();
   tdata = NULL;
   Adiag = NULL;
+  copy_source = NULL;
+  copy_map = NULL;
 
   if (fill < 1.0) {
     fprintf(stderr, "BCSRMat(): fill must be greater than 1.0\n");
@@ -156,12 +435,7 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *mat, int levFill, double fill,
   int *levs;
   computeILUk(mat, levFill, fill, &levs);
 
-  int length = data->rowp[data->nrows];
-  int bsize = data->bsize;
-  length *= bsize * bsize;
-
-  data->A = new TacsScalar[length];
-  memset(data->A, 0, length * sizeof(TacsScalar));
+  allocValues();
 
   // Go through and print out the nz-pattern of the matrix
   if (fname) {
@@ -205,7 +479,7 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *mat, int levFill, double fill,
   ncols:        the number of columns in the matrix
   rowp:         the CSR row pointer
   cols:         the column indices
-  A:            the matrix values
+  A:            the matrix values, allocated with TacsAllocScalarArray
 */
 BCSRMat::BCSRMat(MPI_Comm _comm, TACSThreadInfo *_thread_info, int bsize,
                  int nrows, int ncols, int **_rowp, int **_cols,
@@ -215,6 +489,8 @@ BCSRMat::BCSRMat(MPI_Comm _comm, TACSThreadInfo *_thread_info, int bsize,
   thread_info->incref();
   tdata = NULL;
   Adiag = NULL;
+  copy_source = NULL;
+  copy_map = NULL;
 
   data = new BCSRMatData(bsize, nrows, ncols);
   data->incref();
@@ -230,13 +506,44 @@ BCSRMat::BCSRMat(MPI_Comm _comm, TACSThreadInfo *_thread_info, int bsize,
     data->A = *_A;
     *_A = NULL;
   } else {
-    // Find the size of the array
-    int length = bsize * bsize * data->rowp[nrows];
-    data->A = new TacsScalar[length];
-    memset(data->A, 0, length * sizeof(TacsScalar));
+    allocValues();
   }
 }
 
+/*!
+  Create the BCSRMatrix using a shared non-zero pattern. The values
+  are allocated and zeroed, but the rowp/cols arrays are shared with
+  all the other matrices that use the same pattern.
+
+  input:
+  comm:         the communicator reference for this matrix
+  thread_info:  the POSIX threads class for threading
+  bsize:        the block size of the elements in the matrix
+  pattern:      the shared non-zero pattern
+*/
+BCSRMat::BCSRMat(MPI_Comm _comm, TACSThreadInfo *_thread_info, int bsize,
+                 BCSRMatPattern *pattern) {
+  comm = _comm;
+  thread_info = _thread_info;
+  thread_info->incref();
+  tdata = NULL;
+  Adiag = NULL;
+  copy_source = NULL;
+  copy_map = NULL;
+
+  data = new BCSRMatData(bsize, pattern->nrows, pattern->ncols);
+  data->incref();
+  initBlockImpl();
+
+  pattern->incref();
+  data->pattern = pattern;
+  data->rowp = pattern->rowp;
+  data->cols = pattern->cols;
+  data->diag = pattern->diag;
+
+  allocValues();
+}
+
 /*!
   This function performs a few calculations.
 
@@ -261,6 +568,8 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *Bmat, BCSRMat *Emat, BCSRMat *Fmat,
   thread_info->incref();
   tdata = NULL;
   Adiag = NULL;
+  copy_source = NULL;
+  copy_map = NULL;
 
   // Check that the dimensions of the matrices match
   if (Bmat->data->nrows != Emat->data->nrows ||
@@ -296,11 +605,7 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *Bmat, BCSRMat *Emat, BCSRMat *Fmat,
 
   delete[] levs;
 
-  int bsize = data->bsize;
-  int length = data->rowp[data->nrows];
-  length *= bsize * bsize;
-  data->A = new TacsScalar[length];
-  memset(data->A, 0, length * sizeof(TacsScalar));
+  allocValues();
 }
 
 /*!
@@ -323,6 +628,8 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *smat, int *alevs, BCSRMat *amat,
   thread_info->incref();
   tdata = NULL;
   Adiag = NULL;
+  copy_source = NULL;
+  copy_map = NULL;
 
   // Check that the block sizes are the same
   if (amat->data->bsize != bmat->data->bsize) {
@@ -446,12 +753,7 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *smat, int *alevs, BCSRMat *amat,
   data->rowp = rowp;
   data->cols = cols;
 
-  int bsize = data->bsize;
-  int length = rowp[nrows];
-  length *= bsize * bsize;
-
-  data->A = new TacsScalar[length];
-  memset(data->A, 0, length * sizeof(TacsScalar));
+  allocValues();
 }
 
 /*
@@ -491,6 +793,8 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *B, double fill) {
   thread_info->incref();
   tdata = NULL;
   Adiag = NULL;
+  copy_source = NULL;
+  copy_map = NULL;
 
   data = new BCSRMatData(B->data->bsize, B->data->ncols, B->data->ncols);
   data->incref();
@@ -576,12 +880,7 @@ BCSRMat::BCSRMat(MPI_Comm _comm, BCSRMat *B, double fill) {
   data->rowp = rowp;
   data->cols = cols;
 
-  int bsize = data->bsize;
-  int length = rowp[nrows];
-  length *= bsize * bsize;
-
-  data->A = new TacsScalar[length];
-  memset(data->A, 0, length * sizeof(TacsScalar));
+  allocValues();
 }
 
 BCSRMat::~BCSRMat() {
@@ -593,23 +892,70 @@ BCSRMat::~BCSRMat() {
   if (Adiag) {
     delete[] Adiag;
   }
+  if (copy_source) {
+    copy_source->decref();
+  }
+  if (copy_map) {
+    delete[] copy_map;
+  }
 }
 
 /*
-  Create a duplicate of the BCSRMat non-zero data
+  Create a duplicate of the BCSRMat non-zero data. The duplicate
+  shares the non-zero pattern with this matrix.
 */
 BCSRMat *BCSRMat::createDuplicate() {
-  int bsize = data->bsize;
-  int nrows = data->nrows;
-  int ncols = data->ncols;
-  int *rowp = new int[nrows + 1];
-  memcpy(rowp, data->rowp, (nrows + 1) * sizeof(int));
+  return new BCSRMat(comm, thread_info, data->bsize, getPattern());
+}
+
+/*
+  Get the non-zero pattern of the matrix so that it can be shared
+  with other matrices. After this call, the pattern is owned by the
+  BCSRMatPattern object.
+*/
+BCSRMatPattern *BCSRMat::getPattern() {
+  if (!data->pattern) {
+    data->pattern = new BCSRMatPattern(data->nrows, data->ncols, data->rowp,
+                                       data->cols, data->diag);
+    data->pattern->incref();
+  }
+  return data->pattern;
+}
 
-  int size = rowp[nrows];
-  int *cols = new int[size];
-  memcpy(cols, data->cols, size * sizeof(int));
+/*
+  Use the given pattern in place of the pattern stored by this matrix
+  when the two are identical. The values of the matrix are not
+  modified. This returns 1 if the pattern is shared, and 0 if the
+  patterns are not the same.
+*/
+int BCSRMat::sharePattern(BCSRMatPattern *pattern) {
+  if (data->pattern == pattern) {
+    return 1;
+  }
+  if (!pattern->isEqual(data->nrows, data->ncols, data->rowp, data->cols)) {
+    return 0;
+  }
 
-  return new BCSRMat(comm, thread_info, bsize, nrows, ncols, &rowp, &cols);
+  // Keep the diagonal pointer if it has already been computed
+  pattern->incref();
+  if (data->pattern) {
+    data->pattern->decref();
+  } else {
+    if (data->diag && !pattern->diag) {
+      pattern->diag = data->diag;
+    } else if (data->diag) {
+      delete[] data->diag;
+    }
+    delete[] data->rowp;
+    delete[] data->cols;
+  }
+
+  data->pattern = pattern;
+  data->rowp = pattern->rowp;
+  data->cols = pattern->cols;
+  data->diag = pattern->diag;
+
+  return 1;
 }
 
 MPI_Comm BCSRMat::getMPIComm() { return comm; }
@@ -968,10 +1314,52 @@ BCSRMat *BCSRMat::computeILUkFpc(BCSRMat *Fmat, const int *levs, int levFill,
                      Fmat->data->ncols, &frowp, &fcols);
 }
 
+/*
+  Allocate the zeroed matrix values using the memory policy from the
+  thread info object. The rows are first-touched using the same
+  partition as the threaded matrix-vector products.
+*/
+void BCSRMat::allocValues() {
+  int bsize = data->bsize;
+  size_t length = (size_t)bsize * bsize * data->rowp[data->nrows];
+  data->A = TacsAllocScalarArray(length, thread_info, data->nrows, data->rowp,
+                                 bsize * bsize, data->matvec_group_size);
+  data->updateMemory();
+}
+
+/*
+  Restore the double-precision matrix values from the single-precision
+  copy of the factor. This is called before any operation that reads
+  or modifies the matrix entries, other than the triangular solves.
+*/
+void BCSRMat::restoreValues() {
+  if (data->Af) {
+    allocValues();
+    size_t length =
+        (size_t)data->bsize * data->bsize * data->rowp[data->nrows];
+    for (size_t i = 0; i < length; i++) {
+      data->A[i] = data->Af[i];
+    }
+    delete[] data->Af;
+    data->Af = NULL;
+    data->updateMemory();
+  }
+}
+
 /*
   Compute the location of the diagonal entry for each row
 */
 void BCSRMat::setUpDiag() {
+  // The shared pattern only needs the diagonal computed once
+  if (data->pattern) {
+    if (data->pattern->diag) {
+      data->diag = data->pattern->diag;
+      return;
+    }
+    data->pattern->diag = new int[data->nrows];
+    data->diag = data->pattern->diag;
+  }
+
   if (!data->diag) {
     data->diag = new int[data->nrows];
   }
@@ -1010,16 +1398,52 @@ void BCSRMat::initGenericImpl() {
   applyschur = BCSRMatApplyFactorSchur;
   applysor = BCSRMatApplySOR;
 
-  // No default threaded versions
+  // The level-scheduled triangular solves are the only default
+  // threaded versions
   bmultadd_thread = NULL;
   bfactor_thread = NULL;
-  applylower_thread = NULL;
-  applyupper_thread = NULL;
+  applylower_thread = BCSRMatApplyLowerLevel_thread<0>;
+  applyupper_thread = BCSRMatApplyUpperLevel_thread<0>;
   bmatmult_thread = NULL;
   bfactorlower_thread = NULL;
   bfactorupper_thread = NULL;
 }
 
+/*
+  Initialize the templated implementations of each low-level routine
+  for the block size N. These are used for the block sizes without a
+  hand-written implementation.
+*/
+template <int N>
+void BCSRMat::initTemplateImpl() {
+  // These are tuning parameters
+  data->matvec_group_size = 16;
+  data->matmat_group_size = 4;
+
+  // The serial versions
+  bfactor = BCSRMatFactor<N>;
+  applylower = BCSRMatApplyLower<N>;
+  applyupper = BCSRMatApplyUpper<N>;
+  bmult = BCSRMatVecMult<N>;
+  bmultadd = BCSRMatVecMultAdd<N>;
+  bmulttrans = BCSRMatVecMultTranspose<N>;
+  bmatmult = BCSRMatMatMultAdd<N>;
+  bfactorlower = BCSRMatFactorLower<N>;
+  bfactorupper = BCSRMatFactorUpper<N>;
+  applypartiallower = BCSRMatApplyPartialLower<N>;
+  applypartialupper = BCSRMatApplyPartialUpper<N>;
+  applyschur = BCSRMatApplyFactorSchur<N>;
+  bmatmatmultnormal = BCSRMatMatMultNormal<N>;
+  applysor = BCSRMatApplySOR<N>;
+
+  // The threaded versions
+  bmultadd_thread = BCSRMatVecMultAdd_thread<N>;
+  bfactor_thread = BCSRMatFactorLevel_thread<N>;
+  bmatmult_thread = BCSRMatMatMultAdd_thread<N>;
+  applylower_thread = BCSRMatApplyLowerLevel_thread<N>;
+  applyupper_thread = BCSRMatApplyUpperLevel_thread<N>;
+}
+
 /*
   Initialize the block-specific implementations of each low-level
   routine
@@ -1046,6 +1470,11 @@ void BCSRMat::initBlockImpl() {
       applyschur = BCSRMatApplyFactorSchur1;
       bmatmatmultnormal = BCSRMatMatMultNormal1;
       applysor = BCSRMatApplySOR1;
+
+      // The threaded versions
+      bfactor_thread = BCSRMatFactorLevel_thread<1>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<1>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<1>;
       break;
     case 2:
       bfactor = BCSRMatFactor2;
@@ -1060,6 +1489,11 @@ void BCSRMat::initBlockImpl() {
       applypartialupper = BCSRMatApplyPartialUpper2;
       applyschur = BCSRMatApplyFactorSchur2;
       applysor = BCSRMatApplySOR2;
+
+      // The threaded versions
+      bfactor_thread = BCSRMatFactorLevel_thread<2>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<2>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<2>;
       break;
     case 3:
       bfactor = BCSRMatFactor3;
@@ -1074,6 +1508,11 @@ void BCSRMat::initBlockImpl() {
       applypartialupper = BCSRMatApplyPartialUpper3;
       applyschur = BCSRMatApplyFactorSchur3;
       applysor = BCSRMatApplySOR3;
+
+      // The threaded versions
+      bfactor_thread = BCSRMatFactorLevel_thread<3>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<3>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<3>;
       break;
     case 4:
       bfactor = BCSRMatFactor4;
@@ -1088,6 +1527,11 @@ void BCSRMat::initBlockImpl() {
       applypartialupper = BCSRMatApplyPartialUpper4;
       applyschur = BCSRMatApplyFactorSchur4;
       applysor = BCSRMatApplySOR4;
+
+      // The threaded versions
+      bfactor_thread = BCSRMatFactorLevel_thread<4>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<4>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<4>;
       break;
     case 5:
       bfactor = BCSRMatFactor5;
@@ -1102,6 +1546,11 @@ void BCSRMat::initBlockImpl() {
       applypartialupper = BCSRMatApplyPartialUpper5;
       applyschur = BCSRMatApplyFactorSchur5;
       applysor = BCSRMatApplySOR5;
+
+      // The threaded versions
+      bfactor_thread = BCSRMatFactorLevel_thread<5>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<5>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<5>;
       break;
     case 6:
       // These are tuning parameters
@@ -1124,12 +1573,21 @@ void BCSRMat::initBlockImpl() {
 
       // The threaded versions
       bmultadd_thread = BCSRMatVecMultAdd6_thread;
-      bfactor_thread = BCSRMatFactor6_thread;
-      applylower_thread = BCSRMatApplyLower6_thread;
-      applyupper_thread = BCSRMatApplyUpper6_thread;
+      bfactor_thread = BCSRMatFactorLevel_thread<6>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<6>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<6>;
       bmatmult_thread = BCSRMatMatMultAdd6_thread;
       bfactorlower_thread = BCSRMatFactorLower6_thread;
       bfactorupper_thread = BCSRMatFactorUpper6_thread;
+
+      // Use the vectorized versions if supported by the CPU
+      if (BCSRMatGetSIMDLevel() > BCSR_MAT_SIMD_NONE) {
+        applylower = BCSRMatApplyLower6SIMD;
+        applyupper = BCSRMatApplyUpper6SIMD;
+        bmult = BCSRMatVecMult6SIMD;
+        bmultadd = BCSRMatVecMultAdd6SIMD;
+        bmultadd_thread = BCSRMatVecMultAdd6SIMD_thread;
+      }
       break;
     case 8:
       // These are tuning parameters
@@ -1152,13 +1610,40 @@ void BCSRMat::initBlockImpl() {
 
       // The threaded versions
       bmultadd_thread = BCSRMatVecMultAdd8_thread;
-      bfactor_thread = BCSRMatFactor8_thread;
-      applylower_thread = BCSRMatApplyLower8_thread;
-      applyupper_thread = BCSRMatApplyUpper8_thread;
+      bfactor_thread = BCSRMatFactorLevel_thread<8>;
+      applylower_thread = BCSRMatApplyLowerLevel_thread<8>;
+      applyupper_thread = BCSRMatApplyUpperLevel_thread<8>;
       bmatmult_thread = BCSRMatMatMultAdd8_thread;
       bfactorlower_thread = BCSRMatFactorLower8_thread;
       bfactorupper_thread = BCSRMatFactorUpper8_thread;
       break;
+    case 7:
+      initTemplateImpl<7>();
+      break;
+    case 9:
+      initTemplateImpl<9>();
+      break;
+    case 10:
+      initTemplateImpl<10>();
+      break;
+    case 11:
+      initTemplateImpl<11>();
+      break;
+    case 12:
+      initTemplateImpl<12>();
+      break;
+    case 13:
+      initTemplateImpl<13>();
+      break;
+    case 14:
+      initTemplateImpl<14>();
+      break;
+    case 15:
+      initTemplateImpl<15>();
+      break;
+    case 16:
+      initTemplateImpl<16>();
+      break;
     default:
       break;
   }
@@ -1173,9 +1658,12 @@ void BCSRMat::initBlockImpl() {
   performed in place.
 */
 void BCSRMat::factor() {
+  TACSProfileScope scope("BCSRMat::factor");
+  restoreValues();
   if (!data->diag) {
     setUpDiag();
   }
+  BCSR_KERNEL_TIMER(FACTOR_KERNEL, BCSRMatFactorWork(data));
 
   if (bfactor_thread && thread_info->getNumThreads() > 1) {
     // If not allocated, allocate the threaded data
@@ -1184,23 +1672,12 @@ void BCSRMat::factor() {
       tdata->incref();
     }
 
-    tdata->init_apply_lower_sched();
-
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    // The level schedule is computed from the non-zero pattern the
+    // first time and re-used for every subsequent factorization
+    tdata->init_apply_level_sched();
 
-    // Go through and run the threads
-    for (long k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&tdata->threads[k], &attr, bfactor_thread, (void *)tdata);
-    }
-
-    // Destroy the attribute and join all the threads
-    pthread_attr_destroy(&attr);
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(tdata->threads[k], NULL);
-    }
+    // Run the threaded implementation using the thread pool
+    thread_info->runThreads(bfactor_thread, (void *)tdata);
   } else {
     bfactor(data);
   }
@@ -1210,6 +1687,10 @@ void BCSRMat::factor() {
   Compute y = A*x
 */
 void BCSRMat::mult(TacsScalar *xvec, TacsScalar *yvec) {
+  TACSProfileScope scope("BCSRMat::mult");
+  BCSRMatAddPassWork(data, &scope);
+  restoreValues();
+  BCSR_KERNEL_TIMER(MULT_KERNEL, BCSRMatProductWork(data, 0, data->nrows, 0));
   if (bmultadd_thread && thread_info->getNumThreads() > 1) {
     // If not allocated, allocate the threaded data
     if (!tdata) {
@@ -1217,26 +1698,17 @@ void BCSRMat::mult(TacsScalar *xvec, TacsScalar *yvec) {
       tdata->incref();
     }
 
-    tdata->init_mat_mult_sched();
+    if (thread_info->getFirstTouch()) {
+      tdata->init_mat_mult_partition_sched(thread_info->getNumThreads());
+    } else {
+      tdata->init_mat_mult_sched();
+    }
     tdata->input = xvec;
     tdata->output = yvec;
     memset(yvec, 0, data->bsize * data->nrows * sizeof(TacsScalar));
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-    // Go through and run the threads
-    for (long k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&tdata->threads[k], &attr, bmultadd_thread, (void *)tdata);
-    }
-
-    // Destroy the attribute and join all the threads
-    pthread_attr_destroy(&attr);
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(tdata->threads[k], NULL);
-    }
+    // Run the threaded implementation using the thread pool
+    thread_info->runThreads(bmultadd_thread, (void *)tdata);
 
     tdata->input = tdata->output = NULL;
   } else {
@@ -1248,6 +1720,11 @@ void BCSRMat::mult(TacsScalar *xvec, TacsScalar *yvec) {
   Compute y = A*x + z
 */
 void BCSRMat::multAdd(TacsScalar *xvec, TacsScalar *zvec, TacsScalar *yvec) {
+  TACSProfileScope scope("BCSRMat::multAdd");
+  BCSRMatAddPassWork(data, &scope);
+  restoreValues();
+  BCSR_KERNEL_TIMER(MULT_ADD_KERNEL,
+                    BCSRMatProductWork(data, 0, data->nrows, 1));
   if (bmultadd_thread && thread_info->getNumThreads() > 1) {
     // If not allocated, allocate the threaded data
     if (!tdata) {
@@ -1256,7 +1733,11 @@ void BCSRMat::multAdd(TacsScalar *xvec, TacsScalar *zvec, TacsScalar *yvec) {
     }
 
     // Assign the input/output info
-    tdata->init_mat_mult_sched();
+    if (thread_info->getFirstTouch()) {
+      tdata->init_mat_mult_partition_sched(thread_info->getNumThreads());
+    } else {
+      tdata->init_mat_mult_sched();
+    }
     tdata->input = xvec;
     tdata->output = yvec;
 
@@ -1264,21 +1745,8 @@ void BCSRMat::multAdd(TacsScalar *xvec, TacsScalar *zvec, TacsScalar *yvec) {
       memcpy(yvec, zvec, data->bsize * data->nrows * sizeof(TacsScalar));
     }
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-    // Go through and run the threads
-    for (long k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&tdata->threads[k], &attr, bmultadd_thread, (void *)tdata);
-    }
-
-    // Destroy the attribute and join all the threads
-    pthread_attr_destroy(&attr);
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(tdata->threads[k], NULL);
-    }
+    // Run the threaded implementation using the thread pool
+    thread_info->runThreads(bmultadd_thread, (void *)tdata);
 
     tdata->input = tdata->output = NULL;
   } else {
@@ -1290,6 +1758,11 @@ void BCSRMat::multAdd(TacsScalar *xvec, TacsScalar *zvec, TacsScalar *yvec) {
   Compute y = A^{T}*x
 */
 void BCSRMat::multTranspose(TacsScalar *xvec, TacsScalar *yvec) {
+  TACSProfileScope scope("BCSRMat::multTranspose");
+  BCSRMatAddPassWork(data, &scope);
+  restoreValues();
+  BCSR_KERNEL_TIMER(MULT_TRANSPOSE_KERNEL,
+                    BCSRMatProductWork(data, 0, data->nrows, 0));
   memset(yvec, 0, data->bsize * data->ncols * sizeof(TacsScalar));
   bmulttrans(data, xvec, yvec);
 }
@@ -1302,8 +1775,14 @@ void BCSRMat::multTranspose(TacsScalar *xvec, TacsScalar *yvec) {
   y = U^{-1} L^{-1} x
 */
 void BCSRMat::applyFactor(TacsScalar *xvec, TacsScalar *yvec) {
+  TACSProfileScope scope("BCSRMat::applyFactor");
+  BCSRMatAddPassWork(data, &scope);
+  BCSR_KERNEL_TIMER(APPLY_FACTOR_KERNEL, BCSRMatTriangularWork(data, 1, 1));
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyFactor error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyLowerSingle(data, xvec, yvec);
+    BCSRMatApplyUpperSingle(data, yvec, yvec);
   } else {
     if (applylower_thread && applyupper_thread &&
         thread_info->getNumThreads() > 1) {
@@ -1318,39 +1797,13 @@ void BCSRMat::applyFactor(TacsScalar *xvec, TacsScalar *yvec) {
       }
       tdata->output = yvec;
 
-      // Create the joinable attribute
-      pthread_attr_t attr;
-      pthread_attr_init(&attr);
-      pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
       // Apply L^{-1}
-      tdata->init_apply_lower_sched();
-
-      // Go through and run the threads
-      for (long k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_create(&tdata->threads[k], &attr, applylower_thread,
-                       (void *)tdata);
-      }
-
-      for (int k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_join(tdata->threads[k], NULL);
-      }
+      tdata->init_apply_level_sched();
+      thread_info->runThreads(applylower_thread, (void *)tdata);
 
       // Apply U^{-1}
-      tdata->init_apply_upper_sched();
-
-      // Go through and run the threads
-      for (long k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_create(&tdata->threads[k], &attr, applyupper_thread,
-                       (void *)tdata);
-      }
-
-      for (int k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_join(tdata->threads[k], NULL);
-      }
-
-      // Destroy the attribute and join all the threads
-      pthread_attr_destroy(&attr);
+      tdata->init_apply_level_sched();
+      thread_info->runThreads(applyupper_thread, (void *)tdata);
     } else {
       applylower(data, xvec, yvec);
       applyupper(data, yvec, yvec);
@@ -1366,8 +1819,14 @@ void BCSRMat::applyFactor(TacsScalar *xvec, TacsScalar *yvec) {
   x = U^{-1} L^{-1} x
 */
 void BCSRMat::applyFactor(TacsScalar *xvec) {
+  TACSProfileScope scope("BCSRMat::applyFactor");
+  BCSRMatAddPassWork(data, &scope);
+  BCSR_KERNEL_TIMER(APPLY_FACTOR_KERNEL, BCSRMatTriangularWork(data, 1, 1));
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyFactor error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyLowerSingle(data, xvec, xvec);
+    BCSRMatApplyUpperSingle(data, xvec, xvec);
   } else {
     if (applylower_thread && applyupper_thread &&
         thread_info->getNumThreads() > 1) {
@@ -1379,39 +1838,13 @@ void BCSRMat::applyFactor(TacsScalar *xvec) {
 
       tdata->output = xvec;
 
-      // Create the joinable attribute
-      pthread_attr_t attr;
-      pthread_attr_init(&attr);
-      pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
       // Apply L^{-1}
-      tdata->init_apply_lower_sched();
-
-      // Go through and run the threads
-      for (long k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_create(&tdata->threads[k], &attr, applylower_thread,
-                       (void *)tdata);
-      }
-
-      for (int k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_join(tdata->threads[k], NULL);
-      }
+      tdata->init_apply_level_sched();
+      thread_info->runThreads(applylower_thread, (void *)tdata);
 
       // Apply U^{-1}
-      tdata->init_apply_upper_sched();
-
-      // Go through and run the threads
-      for (long k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_create(&tdata->threads[k], &attr, applyupper_thread,
-                       (void *)tdata);
-      }
-
-      for (int k = 0; k < thread_info->getNumThreads(); k++) {
-        pthread_join(tdata->threads[k], NULL);
-      }
-
-      // Destroy the attribute and join all the threads
-      pthread_attr_destroy(&attr);
+      tdata->init_apply_level_sched();
+      thread_info->runThreads(applyupper_thread, (void *)tdata);
     } else {
       applylower(data, xvec, xvec);
       applyupper(data, xvec, xvec);
@@ -1425,8 +1858,11 @@ void BCSRMat::applyFactor(TacsScalar *xvec) {
   y = U^{-1} x
 */
 void BCSRMat::applyUpper(TacsScalar *xvec, TacsScalar *yvec) {
+  BCSR_KERNEL_TIMER(APPLY_UPPER_KERNEL, BCSRMatTriangularWork(data, 0, 1));
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyUpper error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyUpperSingle(data, xvec, yvec);
   } else {
     applyupper(data, xvec, yvec);
   }
@@ -1438,8 +1874,11 @@ void BCSRMat::applyUpper(TacsScalar *xvec, TacsScalar *yvec) {
   y = L^{-1} x
 */
 void BCSRMat::applyLower(TacsScalar *xvec, TacsScalar *yvec) {
+  BCSR_KERNEL_TIMER(APPLY_LOWER_KERNEL, BCSRMatTriangularWork(data, 1, 0));
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyLower error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyLowerSingle(data, xvec, yvec);
   } else {
     applylower(data, xvec, yvec);
   }
@@ -1456,6 +1895,8 @@ void BCSRMat::applyLower(TacsScalar *xvec, TacsScalar *yvec) {
 void BCSRMat::applyPartialLower(TacsScalar *xvec, int var_offset) {
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyPartialLower error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyPartialLowerSingle(data, xvec, var_offset);
   } else {
     applypartiallower(data, xvec, var_offset);
   }
@@ -1472,6 +1913,8 @@ void BCSRMat::applyPartialLower(TacsScalar *xvec, int var_offset) {
 void BCSRMat::applyPartialUpper(TacsScalar *xvec, int var_offset) {
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyPartialUpper error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyPartialUpperSingle(data, xvec, var_offset);
   } else {
     applypartialupper(data, xvec, var_offset);
   }
@@ -1493,16 +1936,376 @@ void BCSRMat::applyPartialUpper(TacsScalar *xvec, int var_offset) {
 void BCSRMat::applyFactorSchur(TacsScalar *x, int var_offset) {
   if (!data->diag) {
     fprintf(stderr, "BCSRMat applyFactorSchur error: matrix not factored\n");
+  } else if (data->Af) {
+    BCSRMatApplyFactorSchurSingle(data, x, var_offset);
   } else {
     applyschur(data, x, var_offset);
   }
 }
 
+/*
+  The data passed to the threaded products with multiple vectors
+*/
+struct BCSRMatMultiArgs {
+  BCSRMatData *data;
+  int nvecs;
+  TacsScalar **x, **z, **y;
+};
+
+static void BCSRMatMultMultiRange(int start, int end, int thread_id,
+                                  void *ctx) {
+  BCSRMatMultiArgs *args = (BCSRMatMultiArgs *)ctx;
+  BCSRMatVecMultAddMulti(args->data, start, end, args->nvecs, args->x,
+                         args->z, args->y);
+}
+
+/*!
+  Compute y[i] = A*x[i] for i = 0,...,nvecs-1
+
+  All the products are computed in a single pass over the entries of
+  the matrix, which is faster than nvecs separate calls to mult().
+*/
+void BCSRMat::multMulti(int nvecs, TacsScalar **xvecs, TacsScalar **yvecs) {
+  multAddMulti(nvecs, xvecs, NULL, yvecs);
+}
+
+/*!
+  Compute y[i] = A*x[i] + z[i] for i = 0,...,nvecs-1
+
+  The z array, or any of its entries, may be NULL in which case it is
+  treated as zero. The output may be the same as z.
+*/
+void BCSRMat::multAddMulti(int nvecs, TacsScalar **xvecs, TacsScalar **zvecs,
+                           TacsScalar **yvecs) {
+  restoreValues();
+
+  BCSRMatMultiArgs args;
+  args.data = data;
+  args.nvecs = nvecs;
+  args.x = xvecs;
+  args.z = zvecs;
+  args.y = yvecs;
+  thread_info->parallelFor(data->nrows, 4 * data->matvec_group_size,
+                           BCSRMatMultMultiRange, &args);
+}
+
+struct BCSRMatComplexArgs {
+  BCSRMatData *data;
+  const TacsComplex *x;
+  TacsComplex *y;
+};
+
+static void BCSRMatMultComplexRange(int start, int end, int thread_id,
+                                    void *ctx) {
+  BCSRMatComplexArgs *args = (BCSRMatComplexArgs *)ctx;
+  BCSRMatVecMultAddScalar<TacsComplex>(args->data, start, end, args->x, NULL,
+                                       args->y);
+}
+
+/*!
+  Compute y = A*x with complex vectors
+
+  In the real build the matrix entries remain real, so that the
+  complex-step derivative of a product can be checked without
+  assembling the matrix in complex arithmetic. In the complex build
+  this is the same as mult().
+*/
+void BCSRMat::multComplex(const TacsComplex *xvec, TacsComplex *yvec) {
+  restoreValues();
+
+  BCSRMatComplexArgs args;
+  args.data = data;
+  args.x = xvec;
+  args.y = yvec;
+  thread_info->parallelFor(data->nrows, 4 * data->matvec_group_size,
+                           BCSRMatMultComplexRange, &args);
+}
+
+/*!
+  Compute y = A^{T}*x with complex vectors
+*/
+void BCSRMat::multTransposeComplex(const TacsComplex *xvec,
+                                   TacsComplex *yvec) {
+  restoreValues();
+  int size = data->bsize * data->ncols;
+  for (int i = 0; i < size; i++) {
+    yvec[i] = 0.0;
+  }
+  BCSRMatVecMultTransposeScalar<TacsComplex>(data, xvec, yvec);
+}
+
+/*
+  Compute y += A*x for the blocks in [kstart, kend) of a single row
+*/
+template <int N>
+static void BCSRMatMultAddSegmentsImpl(BCSRMatData *data, int nsegs,
+                                       const int *segs, const TacsScalar *x,
+                                       TacsScalar *y) {
+  const int *cols = data->cols;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const TacsScalar *A = data->A;
+
+  for (int s = 0; s < nsegs; s++) {
+    TacsScalar *yi = &y[bsize * segs[3 * s]];
+    int kend = segs[3 * s + 2];
+    for (int k = segs[3 * s + 1]; k < kend; k++) {
+      const TacsScalar *a = &A[b2 * k];
+      const TacsScalar *xj = &x[bsize * cols[k]];
+      for (int m = 0; m < bsize; m++) {
+        TacsScalar t = 0.0;
+        for (int n = 0; n < bsize; n++) {
+          t += a[bsize * m + n] * xj[n];
+        }
+        yi[m] += t;
+      }
+    }
+  }
+}
+
+/*!
+  Compute y += A*x using only a subset of the blocks in each row
+
+  Each segment is a triple (row, kstart, kend) and adds the product
+  of the blocks in the range [kstart, kend) of the row. This is used
+  to add the contributions from the off-processor values as they
+  arrive, where the segments select the column range owned by one
+  processor.
+*/
+void BCSRMat::multAddSegments(int nsegs, const int *segs, TacsScalar *xvec,
+                              TacsScalar *yvec) {
+  restoreValues();
+
+  switch (data->bsize) {
+    case 1:
+      BCSRMatMultAddSegmentsImpl<1>(data, nsegs, segs, xvec, yvec);
+      break;
+    case 2:
+      BCSRMatMultAddSegmentsImpl<2>(data, nsegs, segs, xvec, yvec);
+      break;
+    case 3:
+      BCSRMatMultAddSegmentsImpl<3>(data, nsegs, segs, xvec, yvec);
+      break;
+    case 6:
+      BCSRMatMultAddSegmentsImpl<6>(data, nsegs, segs, xvec, yvec);
+      break;
+    default:
+      BCSRMatMultAddSegmentsImpl<0>(data, nsegs, segs, xvec, yvec);
+      break;
+  }
+}
+
+/*!
+  Apply the ILU factorization to multiple vectors
+
+  y[i] = U^{-1} L^{-1} x[i] for i = 0,...,nvecs-1
+
+  The factor is traversed once for L^{-1} and once for U^{-1} for all
+  of the vectors.
+*/
+void BCSRMat::applyFactorMulti(int nvecs, TacsScalar **xvecs,
+                               TacsScalar **yvecs) {
+  if (!data->diag) {
+    fprintf(stderr, "BCSRMat applyFactorMulti error: matrix not factored\n");
+  } else if (data->Af) {
+    for (int i = 0; i < nvecs; i++) {
+      applyFactor(xvecs[i], yvecs[i]);
+    }
+  } else {
+    BCSRMatApplyLowerMulti(data, nvecs, xvecs, yvecs);
+    BCSRMatApplyUpperMulti(data, nvecs, yvecs, yvecs);
+  }
+}
+
+/*!
+  Apply the lower factor to multiple vectors: y[i] = L^{-1} x[i]
+*/
+void BCSRMat::applyLowerMulti(int nvecs, TacsScalar **xvecs,
+                              TacsScalar **yvecs) {
+  if (!data->diag) {
+    fprintf(stderr, "BCSRMat applyLowerMulti error: matrix not factored\n");
+  } else if (data->Af) {
+    for (int i = 0; i < nvecs; i++) {
+      applyLower(xvecs[i], yvecs[i]);
+    }
+  } else {
+    BCSRMatApplyLowerMulti(data, nvecs, xvecs, yvecs);
+  }
+}
+
+/*!
+  Apply the upper factor to multiple vectors: y[i] = U^{-1} x[i]
+*/
+void BCSRMat::applyUpperMulti(int nvecs, TacsScalar **xvecs,
+                              TacsScalar **yvecs) {
+  if (!data->diag) {
+    fprintf(stderr, "BCSRMat applyUpperMulti error: matrix not factored\n");
+  } else if (data->Af) {
+    for (int i = 0; i < nvecs; i++) {
+      applyUpper(xvecs[i], yvecs[i]);
+    }
+  } else {
+    BCSRMatApplyUpperMulti(data, nvecs, xvecs, yvecs);
+  }
+}
+
+/*!
+  Convert the factored matrix to single precision.
+
+  The double-precision entries are released and replaced with a
+  single-precision copy that is used by the applyFactor(),
+  applyLower(), applyUpper(), applyPartialLower(), applyPartialUpper()
+  and applyFactorSchur() functions. These mixed-precision solves read
+  the factor in single precision but perform all arithmetic in double
+  precision. This halves the memory required for the factor which is
+  usually acceptable for a preconditioner. Note that the threaded
+  triangular solves are not used for the single-precision factor.
+
+  Any other operation that accesses the matrix entries first restores
+  the double-precision values, but the values lost in the conversion
+  cannot be recovered.
+
+  This is not available in complex mode.
+*/
+void BCSRMat::convertFactorToSingle() {
+#ifdef TACS_USE_COMPLEX
+  fprintf(stderr,
+          "BCSRMat convertFactorToSingle error: not available in complex "
+          "mode\n");
+#else
+  if (!data->diag) {
+    fprintf(stderr,
+            "BCSRMat convertFactorToSingle error: matrix not factored\n");
+  } else if (!data->Af) {
+    size_t length =
+        (size_t)data->bsize * data->bsize * data->rowp[data->nrows];
+    data->Af = new float[length];
+    for (size_t i = 0; i < length; i++) {
+      data->Af[i] = data->A[i];
+    }
+    TacsFreeScalarArray(data->A);
+    data->A = NULL;
+    data->updateMemory();
+  }
+#endif  // TACS_USE_COMPLEX
+}
+
+/*!
+  Check whether the factor is stored in single precision
+*/
+int BCSRMat::isFactorSingle() { return (data->Af != NULL); }
+
+/*!
+  Compute the ILU factorization of the real part of the matrix.
+
+  In complex mode, the real part of the entries is copied to a real
+  array and factored in real arithmetic. The triangular solves then
+  apply the real factor to the real and imaginary parts of the vector
+  separately. For complex-step derivatives, where the imaginary part
+  of the matrix is a small perturbation, this is an effective
+  preconditioner that requires about a quarter of the work of the
+  complex factorization.
+
+  The complex entries are released. Any other operation that accesses
+  the matrix entries restores a complex array with a zero imaginary
+  part. The threaded factorization and triangular solves are not used.
+
+  In real mode, this is the same as factor().
+*/
+void BCSRMat::factorRealPart() {
+#ifdef TACS_USE_COMPLEX
+  TACSProfileScope scope("BCSRMat::factorRealPart");
+  restoreValues();
+  if (!data->diag) {
+    setUpDiag();
+  }
+  convertFactorToRealPart();
+  BCSRMatFactorRealPart(data);
+#else
+  factor();
+#endif  // TACS_USE_COMPLEX
+}
+
+/*!
+  Discard the imaginary part of the factored matrix.
+
+  In complex mode, the complex entries are replaced with a real copy
+  of their real part that is used by the triangular solves in the same
+  manner as the single-precision factor. This is used to restore the
+  real factor from factorRealPart() after an operation that required
+  the complex entries. In real mode, this has no effect.
+*/
+void BCSRMat::convertFactorToRealPart() {
+#ifdef TACS_USE_COMPLEX
+  if (!data->diag) {
+    fprintf(stderr,
+            "BCSRMat convertFactorToRealPart error: matrix not factored\n");
+  } else if (!data->Af) {
+    size_t length =
+        (size_t)data->bsize * data->bsize * data->rowp[data->nrows];
+    data->Af = new double[length];
+    for (size_t i = 0; i < length; i++) {
+      data->Af[i] = TacsRealPart(data->A[i]);
+    }
+    TacsFreeScalarArray(data->A);
+    data->A = NULL;
+    data->updateMemory();
+  }
+#endif  // TACS_USE_COMPLEX
+}
+
+/*!
+  Compute the inertia of the factored matrix.
+
+  The matrix must be symmetric and the factorization must be complete.
+  The block LU factorization without pivoting between blocks is then
+  equivalent to a block LDL^{T} factorization, so that the inertia of
+  the matrix is the sum of the inertia of the diagonal blocks of the
+  factor by Sylvester's law of inertia. The inverses of these blocks
+  are stored in the factor and have the same inertia.
+
+  output:
+  nneg:   the number of negative eigenvalues
+  npos:   the number of positive eigenvalues
+*/
+void BCSRMat::getInertia(int *nneg, int *npos) {
+  *nneg = *npos = 0;
+  if (!data->diag) {
+    fprintf(stderr, "BCSRMat getInertia error: matrix not factored\n");
+    return;
+  }
+
+  const int bsize = data->bsize;
+  const int b2 = bsize * bsize;
+  TacsScalar *D = new TacsScalar[b2];
+  double *work = new double[b2 + 4 * bsize];
+
+  for (int i = 0; i < data->nrows; i++) {
+    size_t offset = (size_t)b2 * data->diag[i];
+    for (int k = 0; k < b2; k++) {
+      if (data->Af) {
+        D[k] = data->Af[offset + k];
+      } else {
+        D[k] = data->A[offset + k];
+      }
+    }
+
+    int neg, pos;
+    BMatComputeInertia(D, bsize, work, &neg, &pos);
+    *nneg += neg;
+    *npos += pos;
+  }
+
+  delete[] D;
+  delete[] work;
+}
+
 /*!
   Copy the diagonal entries to a set of diagonal matrices.  Factor
   these matrices and store the result.
 */
 void BCSRMat::factorDiag(const TacsScalar *diag) {
+  restoreValues();
   if (!data->diag) {
     setUpDiag();
   }
@@ -1538,6 +2341,9 @@ void BCSRMat::factorDiag(const TacsScalar *diag) {
 */
 void BCSRMat::applySOR(TacsScalar *b, TacsScalar *x, TacsScalar omega,
                        int iters) {
+  restoreValues();
+  BCSR_KERNEL_TIMER(APPLY_SOR_KERNEL,
+                    BCSRMatProductWork(data, 0, data->nrows, 1, iters));
   if (Adiag) {
     for (int i = 0; i < iters; i++) {
       applysor(data, NULL, 0, data->nrows, 0, Adiag, omega, b, NULL, x);
@@ -1553,6 +2359,11 @@ void BCSRMat::applySOR(TacsScalar *b, TacsScalar *x, TacsScalar omega,
 void BCSRMat::applySOR(BCSRMat *B, int start, int end, int var_offset,
                        TacsScalar omega, const TacsScalar *b,
                        const TacsScalar *xext, TacsScalar *x) {
+  restoreValues();
+  if (B) {
+    B->restoreValues();
+  }
+  BCSR_KERNEL_TIMER(APPLY_SOR_KERNEL, BCSRMatProductWork(data, start, end, 1));
   if (Adiag) {
     if (B) {
       applysor(data, B->data, start, end, var_offset, Adiag, omega, b, xext, x);
@@ -1564,6 +2375,68 @@ void BCSRMat::applySOR(BCSRMat *B, int start, int end, int var_offset,
   }
 }
 
+struct BCSRMatColoredSORArgs {
+  BCSRMatData *data;
+  const TacsScalar *Adiag;
+  const int *rows;
+  TacsScalar omega;
+  const TacsScalar *b;
+  TacsScalar *x;
+};
+
+static void BCSRMatColoredSORRange(int start, int end, int thread_id,
+                                   void *ctx) {
+  BCSRMatColoredSORArgs *args = (BCSRMatColoredSORArgs *)ctx;
+  BCSRMatApplyRowSOR(args->data, &args->rows[start], end - start, args->Adiag,
+                     args->omega, args->b, args->x);
+}
+
+/*!
+  Apply a multicolor SOR sweep to the system A*x = b
+
+  The rows of color c are rows[color_ptr[c]] to rows[color_ptr[c+1]-1]
+  and no two rows of the same color may be coupled by the matrix. The
+  colors are visited in order, or in reverse order for the backward
+  sweep of symmetric SOR, and the rows of each color are updated
+  concurrently by the threads.
+
+  input:
+  ncolors:    the number of colors
+  color_ptr:  the offset into rows for each color
+  rows:       the rows sorted by color
+  omega:      the relaxation factor
+  b:          the right-hand-side
+  reverse:    flag to visit the colors in reverse order
+
+  input/output:
+  x:          the solution vector
+*/
+void BCSRMat::applyColoredSOR(int ncolors, const int *color_ptr,
+                              const int *rows, TacsScalar omega,
+                              const TacsScalar *b, TacsScalar *x,
+                              int reverse) {
+  restoreValues();
+  if (!Adiag) {
+    fprintf(stderr, "Cannot apply SOR: diagonal has not been factored\n");
+    return;
+  }
+
+  BCSRMatColoredSORArgs args;
+  args.data = data;
+  args.Adiag = Adiag;
+  args.omega = omega;
+  args.b = b;
+  args.x = x;
+  for (int k = 0; k < ncolors; k++) {
+    int c = (reverse ? ncolors - 1 - k : k);
+    int n = color_ptr[c + 1] - color_ptr[c];
+    if (n > 0) {
+      args.rows = &rows[color_ptr[c]];
+      thread_info->parallelFor(n, 16, BCSRMatColoredSORRange, &args);
+    }
+  }
+}
+
 /*!
   Compute the matrix-matrix product.
 
@@ -1571,6 +2444,11 @@ void BCSRMat::applySOR(BCSRMat *B, int start, int end, int var_offset,
   matrix to have the correct non-zero pattern.
 */
 void BCSRMat::matMultAdd(double alpha, BCSRMat *amat, BCSRMat *bmat) {
+  restoreValues();
+  amat->restoreValues();
+  bmat->restoreValues();
+  BCSR_KERNEL_TIMER(MAT_MULT_ADD_KERNEL,
+                    BCSRMatMatProductWork(data, amat->data, bmat->data));
   // Check that the sizes work
   if (data->bsize != amat->data->bsize || data->bsize != bmat->data->bsize) {
     fprintf(stderr,
@@ -1601,21 +2479,8 @@ void BCSRMat::matMultAdd(double alpha, BCSRMat *amat, BCSRMat *bmat) {
     tdata->Bmat = bmat->data;
     tdata->alpha = alpha;
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-    // Go through and run the threads
-    for (long k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&tdata->threads[k], &attr, bmatmult_thread, (void *)tdata);
-    }
-
-    // Destroy the attribute and join all the threads
-    pthread_attr_destroy(&attr);
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(tdata->threads[k], NULL);
-    }
+    // Run the threaded implementation using the thread pool
+    thread_info->runThreads(bmatmult_thread, (void *)tdata);
 
     tdata->alpha = 0.0;
     tdata->Amat = tdata->Bmat = NULL;
@@ -1628,6 +2493,8 @@ void BCSRMat::matMultAdd(double alpha, BCSRMat *amat, BCSRMat *bmat) {
   Compute L^{-1} E
 */
 void BCSRMat::applyLowerFactor(BCSRMat *emat) {
+  restoreValues();
+  emat->restoreValues();
   if (!data->diag) {
     fprintf(stderr,
             "BCSRMat error: cannot use applyLowerFactor "
@@ -1650,22 +2517,8 @@ void BCSRMat::applyLowerFactor(BCSRMat *emat) {
     tdata->Amat = emat->data;
     tdata->init_apply_lower_sched();
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-    // Go through and run the threads
-    for (long k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&tdata->threads[k], &attr, bfactorlower_thread,
-                     (void *)tdata);
-    }
-
-    // Destroy the attribute and join all the threads
-    pthread_attr_destroy(&attr);
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(tdata->threads[k], NULL);
-    }
+    // Run the threaded implementation using the thread pool
+    thread_info->runThreads(bfactorlower_thread, (void *)tdata);
 
     tdata->Amat = NULL;
   } else {
@@ -1677,6 +2530,8 @@ void BCSRMat::applyLowerFactor(BCSRMat *emat) {
   Compute F U^{-1}
 */
 void BCSRMat::applyUpperFactor(BCSRMat *fmat) {
+  restoreValues();
+  fmat->restoreValues();
   if (!data->diag) {
     fprintf(stderr,
             "BCSRMat error: cannot use applyUpperFactor with "
@@ -1699,22 +2554,8 @@ void BCSRMat::applyUpperFactor(BCSRMat *fmat) {
     tdata->Amat = fmat->data;
     tdata->init_mat_mult_sched();
 
-    // Create the joinable attribute
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-    // Go through and run the threads
-    for (long k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_create(&tdata->threads[k], &attr, bfactorupper_thread,
-                     (void *)tdata);
-    }
-
-    // Destroy the attribute and join all the threads
-    pthread_attr_destroy(&attr);
-    for (int k = 0; k < thread_info->getNumThreads(); k++) {
-      pthread_join(tdata->threads[k], NULL);
-    }
+    // Run the threaded implementation using the thread pool
+    thread_info->runThreads(bfactorupper_thread, (void *)tdata);
 
     tdata->Amat = NULL;
   } else {
@@ -1729,6 +2570,8 @@ void BCSRMat::applyUpperFactor(BCSRMat *fmat) {
   this code.
 */
 void BCSRMat::matMultNormal(TacsScalar *s, BCSRMat *bmat) {
+  restoreValues();
+  bmat->restoreValues();
   if (data->nrows != bmat->data->ncols) {
     fprintf(stderr,
             "BCSRMat error: matMultNormal matrices are not the "
@@ -1743,6 +2586,7 @@ void BCSRMat::matMultNormal(TacsScalar *s, BCSRMat *bmat) {
   Zero all entries of the matrix
 */
 void BCSRMat::zeroEntries() {
+  restoreValues();
   int bsize = data->bsize;
   int length = data->rowp[data->nrows];
   length *= bsize * bsize;
@@ -1754,6 +2598,7 @@ void BCSRMat::zeroEntries() {
   Scale all the entries in the matrix by a factor
 */
 void BCSRMat::scale(TacsScalar alpha) {
+  restoreValues();
   const int bsize = data->bsize;
   int length = data->rowp[data->nrows];
   length *= bsize * bsize;
@@ -1777,6 +2622,7 @@ void BCSRMat::scale(TacsScalar alpha) {
 */
 void BCSRMat::addRowValues(int row, int ncol, const int *col, int nca,
                            const TacsScalar *avals) {
+  restoreValues();
   if (ncol <= 0) {
     return;
   }
@@ -1859,6 +2705,7 @@ void BCSRMat::addRowWeightValues(TacsScalar alpha, int row, int nwrows,
                                  const TacsScalar *weights, int nca,
                                  const TacsScalar *avals,
                                  MatrixOrientation matOr) {
+  restoreValues();
   if (nwrows <= 0 || alpha == 0.0) {
     return;
   }
@@ -1949,6 +2796,7 @@ void BCSRMat::addRowWeightValues(TacsScalar alpha, int row, int nwrows,
 */
 void BCSRMat::addBlockRowValues(int row, int ncol, const int *col,
                                 const TacsScalar *avals) {
+  restoreValues();
   if (ncol <= 0) {
     return;
   }
@@ -2003,6 +2851,7 @@ void BCSRMat::addBlockRowValues(int row, int ncol, const int *col,
   ident:    flag to indicate whether to set the diagonal to 1
 */
 void BCSRMat::zeroRow(int row, int vars, int ident) {
+  restoreValues();
   if (row >= 0 && row < data->nrows) {
     const int *rowp = data->rowp;
     const int *cols = data->cols;
@@ -2035,6 +2884,7 @@ void BCSRMat::zeroRow(int row, int vars, int ident) {
 */
 void BCSRMat::zeroColumns(int num_zero_cols, const int *zero_cols,
                           const int *zero_vars, int ident) {
+  restoreValues();
   const int ncols = data->ncols;
   const int nrows = data->nrows;
   const int *rowp = data->rowp;
@@ -2148,6 +2998,7 @@ void BCSRMat::zeroColumns(int num_zero_cols, const int *zero_cols,
 */
 void BCSRMat::partition(int nrows_p, BCSRMat **Bmat, BCSRMat **Emat,
                         BCSRMat **Fmat, BCSRMat **Cmat) {
+  restoreValues();
   const int ncols = data->ncols;
   const int nrows = data->nrows;
   const int *rowp = data->rowp;
@@ -2312,6 +3163,7 @@ void BCSRMat::partition(int nrows_p, BCSRMat **Bmat, BCSRMat **Emat,
 void BCSRMat::getArrays(int *_bsize, int *_nrows, int *_ncols,
                         const int **_rowp, const int **_cols,
                         TacsScalar **Avals) {
+  restoreValues();
   if (_bsize) {
     *_bsize = data->bsize;
   }
@@ -2336,6 +3188,7 @@ void BCSRMat::getArrays(int *_bsize, int *_nrows, int *_ncols,
   Get the matrix in a dense column-major format appropriate for LAPACK
 */
 void BCSRMat::getDenseColumnMajor(TacsScalar *D) {
+  restoreValues();
   const int bsize = data->bsize;
   const int nrows = data->nrows;
   const int *rowp = data->rowp;
@@ -2373,6 +3226,8 @@ void BCSRMat::getDenseColumnMajor(TacsScalar *D) {
   Scan through each row of the matrix, copying entries.
 */
 void BCSRMat::copyValues(BCSRMat *mat) {
+  restoreValues();
+  mat->restoreValues();
   if (mat->data->nrows != data->nrows || mat->data->ncols != data->ncols ||
       data->bsize != mat->data->bsize) {
     fprintf(stderr,
@@ -2381,35 +3236,61 @@ void BCSRMat::copyValues(BCSRMat *mat) {
     return;
   }
 
+  // Compute the location of each source block in this matrix. The
+  // non-zero pattern of a BCSRMat never changes, so the map is only
+  // re-computed when the values are copied from a different matrix.
+  if (mat->data != copy_source) {
+    computeCopyMap(mat->data);
+  }
+
+  const int b2 = data->bsize * data->bsize;
+  const int mat_nnz = mat->data->rowp[mat->data->nrows];
+  const TacsScalar *Amat = mat->data->A;
+
+  this->zeroEntries();
+
+  for (int j = 0; j < mat_nnz; j++) {
+    if (copy_map[j] >= 0) {
+      memcpy(&data->A[b2 * copy_map[j]], &Amat[b2 * j],
+             b2 * sizeof(TacsScalar));
+    }
+  }
+}
+
+/*
+  Compute the map from the blocks of the source matrix to the blocks
+  of this matrix used in copyValues(). Blocks that are not in the
+  non-zero pattern of this matrix are assigned -1.
+*/
+void BCSRMat::computeCopyMap(BCSRMatData *src) {
+  src->incref();
+  if (copy_source) {
+    copy_source->decref();
+  }
+  if (copy_map) {
+    delete[] copy_map;
+  }
+  copy_source = src;
+  copy_map = new int[src->rowp[src->nrows]];
+
   const int nrows = data->nrows;
   const int *rowp = data->rowp;
   const int *cols = data->cols;
-  const int bsize = data->bsize;
-  const int b2 = bsize * bsize;
-
-  this->zeroEntries();
 
   for (int i = 0; i < nrows; i++) {
     int p = rowp[i];
     int end = rowp[i + 1];
-    int mat_end = mat->data->rowp[i + 1];
+    int src_end = src->rowp[i + 1];
 
-    for (int j = mat->data->rowp[i]; (j < mat_end) && (p < end); j++) {
-      while (cols[p] < mat->data->cols[j] && p < end) {
+    for (int j = src->rowp[i]; j < src_end; j++) {
+      while (p < end && cols[p] < src->cols[j]) {
         p++;
       }
 
-      // Copy the matrix if the two entries are equal
-      // and the size of both block--matrices is the same
+      copy_map[j] = -1;
       if (p < end) {
-        if (cols[p] == mat->data->cols[j]) {
-          int n = b2 * p;
-          int m = b2 * j;
-
-          int last = b2 * (p + 1);
-          for (; n < last; n++, m++) {
-            data->A[n] = mat->data->A[m];
-          }
+        if (cols[p] == src->cols[j]) {
+          copy_map[j] = p;
         } else {
           fprintf(stderr, "BCSRMat: NZ-pattern error cannot copy values\n");
         }
@@ -2428,6 +3309,8 @@ void BCSRMat::copyValues(BCSRMat *mat) {
 */
 
 void BCSRMat::axpy(TacsScalar alpha, BCSRMat *mat) {
+  restoreValues();
+  mat->restoreValues();
   if (mat->data->nrows != data->nrows || mat->data->ncols != data->ncols ||
       mat->data->bsize != data->bsize) {
     fprintf(stderr,
@@ -2485,6 +3368,8 @@ void BCSRMat::axpy(TacsScalar alpha, BCSRMat *mat) {
   patterns are static.
 */
 void BCSRMat::axpby(TacsScalar alpha, TacsScalar beta, BCSRMat *mat) {
+  restoreValues();
+  mat->restoreValues();
   if (mat->data->nrows != data->nrows || mat->data->ncols != data->ncols) {
     fprintf(stderr,
             "BCSRMat: Matrices are not the same "
@@ -2535,6 +3420,7 @@ void BCSRMat::axpby(TacsScalar alpha, TacsScalar beta, BCSRMat *mat) {
   Add a value to the diagonal entries of the matrix
 */
 void BCSRMat::addDiag(TacsScalar alpha) {
+  restoreValues();
   if (data->diag) {
     const int bsize = data->bsize;
     const int b2 = bsize * bsize;
@@ -2565,6 +3451,7 @@ void BCSRMat::addDiag(TacsScalar alpha) {
   Add an array of values to the diagonal entries of the matrix
 */
 void BCSRMat::addDiag(TacsScalar *alpha) {
+  restoreValues();
   if (data->diag) {
     const int bsize = data->bsize;
     const int b2 = bsize * bsize;
@@ -2644,6 +3531,7 @@ void BCSRMat::getNumUpperLowerDiagonals(int *_bl, int *_bu) {
   returns: the matrix band size
 */
 void BCSRMat::getBandedMatrix(TacsScalar *A, int size, int symm_flag) {
+  restoreValues();
   // Compute the matrix bandwidth
   int bl, bu;
   getNumUpperLowerDiagonals(&bl, &bu);
@@ -2717,6 +3605,8 @@ void BCSRMat::getBandedMatrix(TacsScalar *A, int size, int symm_flag) {
   2. Test matrix-multiplication against a randomly generated vector
 */
 int BCSRMat::isEqual(BCSRMat *mat, double tol) {
+  restoreValues();
+  mat->restoreValues();
   if (mat->data->nrows != data->nrows || mat->data->ncols != data->ncols) {
     printf("Matrices do not have the same dimensions\n");
     return 0;
@@ -2891,6 +3781,7 @@ void BCSRMat::testSchur(int nrows_p, int lev, double fill, double tol) {
   A                   // the matrix entries
 */
 void BCSRMat::printMat(const char *fname) {
+  restoreValues();
   // Print the matrix in a somewhat human readable format
   FILE *fp = fopen(fname, "w");
 
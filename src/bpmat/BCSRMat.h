@@ -41,6 +41,10 @@ class BCSRMat : public TACSObject {
   BCSRMat(MPI_Comm _comm, TACSThreadInfo *_thread_info, int _bsize, int _nrows,
           int _ncols, int **_rowp, int **_cols, TacsScalar **_A = NULL);
 
+  // Create a matrix from a shared non-zero pattern
+  BCSRMat(MPI_Comm _comm, TACSThreadInfo *_thread_info, int _bsize,
+          BCSRMatPattern *pattern);
+
   // Perform the symbolic computation C = S + A*B
   BCSRMat(MPI_Comm _comm, BCSRMat *Smat, int *alevs, BCSRMat *Amat, int *blevs,
           BCSRMat *Bmat, int levFill, double fill);
@@ -59,6 +63,10 @@ class BCSRMat : public TACSObject {
   // Create a duplicate of the matrix without copying values
   BCSRMat *createDuplicate();
 
+  // Share the non-zero pattern with other matrices
+  BCSRMatPattern *getPattern();
+  int sharePattern(BCSRMatPattern *pattern);
+
   // Access data
   // -----------
   MPI_Comm getMPIComm();
@@ -102,12 +110,42 @@ class BCSRMat : public TACSObject {
   void applyPartialLower(TacsScalar *xvec, int var_offset);
   void applyPartialUpper(TacsScalar *xvec, int var_offset);
   void applyFactorSchur(TacsScalar *x, int var_offset);
+
+  // Products and solves with multiple vectors in a single pass
+  // ----------------------------------------------------------
+  void multMulti(int nvecs, TacsScalar **xvecs, TacsScalar **yvecs);
+  void multAddMulti(int nvecs, TacsScalar **xvecs, TacsScalar **zvecs,
+                    TacsScalar **yvecs);
+  void multAddSegments(int nsegs, const int *segs, TacsScalar *xvec,
+                       TacsScalar *yvec);
+  void applyFactorMulti(int nvecs, TacsScalar **xvecs, TacsScalar **yvecs);
+  void applyLowerMulti(int nvecs, TacsScalar **xvecs, TacsScalar **yvecs);
+  void applyUpperMulti(int nvecs, TacsScalar **xvecs, TacsScalar **yvecs);
+
+  // Products with complex vectors for complex-step checks
+  // -----------------------------------------------------
+  void multComplex(const TacsComplex *xvec, TacsComplex *yvec);
+  void multTransposeComplex(const TacsComplex *xvec, TacsComplex *yvec);
+
+  // Store the factor in single precision for the triangular solves
+  void convertFactorToSingle();
+  int isFactorSingle();
+
+  // Factor and store only the real part of the matrix in complex mode
+  void factorRealPart();
+  void convertFactorToRealPart();
+
+  // Compute the inertia of the matrix from its complete factorization
+  void getInertia(int *nneg, int *npos);
   void setDiagPairs(const int *_pairs, int _npairs);
   void factorDiag(const TacsScalar *diag = NULL);
   void applySOR(TacsScalar *x, TacsScalar *y, TacsScalar omega, int iters);
   void applySOR(BCSRMat *B, int start, int end, int var_offset,
                 TacsScalar omega, const TacsScalar *b, const TacsScalar *xext,
                 TacsScalar *x);
+  void applyColoredSOR(int ncolors, const int *color_ptr, const int *rows,
+                       TacsScalar omega, const TacsScalar *b, TacsScalar *x,
+                       int reverse = 0);
 
   void matMultAdd(double alpha, BCSRMat *amat, BCSRMat *bmat);
   void applyLowerFactor(BCSRMat *emat);
@@ -144,8 +182,36 @@ class BCSRMat : public TACSObject {
   void initGenericImpl();
   void initBlockImpl();
 
+  // Roofline statistics of the kernels. These are only recorded when
+  // TACS is built with -DTACS_KERNEL_PROFILE.
+  // -----------------------------------------------------------------
+  enum KernelType {
+    MULT_KERNEL,
+    MULT_ADD_KERNEL,
+    MULT_TRANSPOSE_KERNEL,
+    APPLY_FACTOR_KERNEL,
+    APPLY_LOWER_KERNEL,
+    APPLY_UPPER_KERNEL,
+    FACTOR_KERNEL,
+    MAT_MULT_ADD_KERNEL,
+    APPLY_SOR_KERNEL,
+    NUM_KERNEL_TYPES
+  };
+  static void getKernelStats(KernelType type, long *calls, double *time,
+                             double *flops, double *bytes_read,
+                             double *bytes_written);
+  static void resetKernelStats();
+  static void printKernelStats(MPI_Comm comm, FILE *fp = stdout);
+
  private:
   void setUpDiag();  // Set up the diagonal entry pointer 'diag'
+  void allocValues();  // Allocate the values using the memory policy
+  void restoreValues();  // Restore the double-precision values
+  void computeCopyMap(BCSRMatData *src);  // Set up the copyValues() map
+
+  // Use the templated implementations for the block size N
+  template <int N>
+  void initTemplateImpl();
   void computeILUk(BCSRMat *mat, int levFill, double fill, int **_levs);
   BCSRMat *computeILUkEpc(BCSRMat *EMat, const int *levs, int levFill,
                           double fill, int **_elevs);
@@ -195,6 +261,11 @@ class BCSRMat : public TACSObject {
   // The threaded BCSR matrix data
   BCSRMatThread *tdata;
 
+  // The map from the blocks of the last matrix passed to
+  // copyValues() to the blocks of this matrix
+  BCSRMatData *copy_source;
+  int *copy_map;
+
   // Storage space for the factored diagonal entries
   TacsScalar *Adiag;
   int npairs;
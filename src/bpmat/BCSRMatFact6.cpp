@@ -51,7 +51,6 @@ void *BCSRMatFactor6_thread(void *t) {
       if (diag[row] < 0) {
         fprintf(stderr, "Error in factorization: no diagonal entry for row %d",
                 row);
-        pthread_exit(NULL);
         return NULL;
       }
 
@@ -419,7 +418,7 @@ block row %d \n",
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -599,7 +598,7 @@ void *BCSRMatFactorLower6_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -935,7 +934,7 @@ void *BCSRMatFactorUpper6_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
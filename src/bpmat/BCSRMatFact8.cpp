@@ -53,7 +53,6 @@ void *BCSRMatFactor8_thread(void *t) {
       if (diag[row] < 0) {
         fprintf(stderr, "Error in factorization: no diagonal entry for row %d",
                 row);
-        pthread_exit(NULL);
         return NULL;
       }
 
@@ -633,7 +632,7 @@ void *BCSRMatFactor8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -899,7 +898,7 @@ void *BCSRMatFactorLower8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -1421,7 +1420,7 @@ void *BCSRMatFactorUpper8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
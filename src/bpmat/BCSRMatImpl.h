@@ -22,8 +22,42 @@
 /*
   Implementations of the various block-specific operations
 */
+#include <atomic>
+
+#include "TACSMemory.h"
 #include "TACSObject.h"
 
+/*
+  The non-zero pattern of a BCSR matrix that is shared between several
+  matrices. The pattern takes ownership of the arrays and frees them
+  when the last matrix that uses the pattern is deleted.
+*/
+class BCSRMatPattern : public TACSObject {
+ public:
+  BCSRMatPattern(int _nrows, int _ncols, int *_rowp, int *_cols, int *_diag);
+  ~BCSRMatPattern();
+
+  // Check if the pattern is the same as the given CSR data
+  int isEqual(int _nrows, int _ncols, const int *_rowp, const int *_cols);
+
+  int nrows;  // The number of rows
+  int ncols;  // The number of columns
+  int *rowp;  // A pointer into cols for the start of each row
+  int *cols;  // The column number of each variable
+  int *diag;  // A pointer to the diagonal entries (may be NULL)
+};
+
+/*
+  The type of the reduced factor: a single-precision copy of the
+  factor in real mode, and a factor of the real part of the matrix in
+  complex mode
+*/
+#ifdef TACS_USE_COMPLEX
+typedef double BCSRFactorScalar;
+#else
+typedef float BCSRFactorScalar;
+#endif  // TACS_USE_COMPLEX
+
 class BCSRMatData : public TACSObject {
  public:
   BCSRMatData(int _bsize, int _nrows, int _ncols);
@@ -37,12 +71,27 @@ class BCSRMatData : public TACSObject {
   int *rowp;  // A pointer into cols for the start of each row
   int *cols;  // The column number of each variable
 
+  // The shared pattern that owns the diag/rowp/cols arrays. When this
+  // is NULL, the arrays are owned by this object.
+  BCSRMatPattern *pattern;
+
   // Information about the size of groups to use
   int matvec_group_size;  // The size of groups for mat-vec operations
   int matmat_group_size;  // The size of groups for mat-mat operations
 
-  // The storage space for each block - this can change
+  // The storage space for each block - this can change. This is
+  // allocated with TacsAllocScalarArray()
   TacsScalar *A;  // The vector of elements of each block
+
+  // Reduced copy of the factored matrix entries. When this is
+  // allocated, A is NULL and the triangular solves are performed using
+  // these values. This is a single-precision copy of the factor in real
+  // mode and the factor of the real part of the matrix in complex mode.
+  BCSRFactorScalar *Af;
+
+  // Record the memory held by the arrays in TACSMemory
+  void updateMemory();
+  size_t mem_bytes;
 };
 
 class BCSRMatThread : public TACSObject {
@@ -54,6 +103,7 @@ class BCSRMatThread : public TACSObject {
   // ------------------------
   // Matrix-matrix and matrix-vector product scheduler
   void init_mat_mult_sched();
+  void init_mat_mult_partition_sched(const int nparts);
   void mat_mult_sched_job(const int group_size, int *row);
   void mat_mult_sched_job_size(const int group_size, int *row, const int nrows);
 
@@ -71,7 +121,11 @@ class BCSRMatThread : public TACSObject {
   void apply_upper_mark_completed(const int group_size, int index, int irow,
                                   int jstart, int jend);
 
-  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  // Level scheduler for the L^{-1} and U^{-1} applications
+  void init_apply_level_sched();
+  int apply_level_sched_job(const int upper, const int group_size, int *start,
+                            int *end);
+  void apply_level_mark_completed(int start, int end);
 
   // The input/output when dealing with vectors
   TacsScalar *input, *output;
@@ -91,12 +145,37 @@ class BCSRMatThread : public TACSObject {
   int *assigned_row_index;   // The index of the fully assigned rows
   int *completed_row_index;  // The indices of the full assigned columns
 
+  // The row partition used with the first-touch memory policy
+  int use_partition;    // Flag indicating whether to use the partition
+  int num_parts;        // The number of blocks in the partition
+  int part_group_size;  // The group size used for the partition
+  int *part_ptr;        // The initial block of rows for each thread
+  int *part_next;       // The next unassigned row in each block
+  int *part_end;        // The end of the unassigned rows in each block
+
+  // The level sets for the triangular solves. The rows in each level
+  // only depend on rows in the previous levels. These are computed
+  // once since the non-zero pattern of the matrix never changes.
+  int num_lower_levels, num_upper_levels;
+  int *lower_level_ptr, *lower_level_rows;
+  int *upper_level_ptr, *upper_level_rows;
+
+  // The next unassigned position and the number of completed rows in
+  // the level ordering
+  std::atomic<int> level_next;
+  std::atomic<int> level_completed;
+
   // The threaded implementation
   pthread_mutex_t mutex;
   pthread_cond_t cond;
 };
 
 int BMatComputeInverse(TacsScalar *Ainv, TacsScalar *A, int *ipiv, int n);
+#ifdef TACS_USE_COMPLEX
+int BMatComputeInverse(double *Ainv, double *A, int *ipiv, int n);
+#endif  // TACS_USE_COMPLEX
+void BMatComputeInertia(const TacsScalar *A, int n, double *work, int *nneg,
+                        int *npos);
 
 /*
   The generic implementation. These will be slow.
@@ -125,6 +204,9 @@ void BCSRMatApplySOR(BCSRMatData *Adata, BCSRMatData *Bdata, const int start,
                      const TacsScalar *Adiag, const TacsScalar omega,
                      const TacsScalar *b, const TacsScalar *xext,
                      TacsScalar *x);
+void BCSRMatApplyRowSOR(BCSRMatData *Adata, const int *rows, const int nrows,
+                        const TacsScalar *Adiag, const TacsScalar omega,
+                        const TacsScalar *b, TacsScalar *x);
 
 /*
   These are the definitions for the block-specific code.
@@ -281,6 +363,54 @@ void *BCSRMatApplyUpper6_thread(void *t);
 
 void *BCSRMatMatMultAdd6_thread(void *t);
 
+// The SIMD implementations for bsize = 6, selected at runtime based on
+// the instruction sets supported by the CPU
+enum BCSRMatSIMDLevel {
+  BCSR_MAT_SIMD_NONE = 0,
+  BCSR_MAT_SIMD_AVX2 = 1,
+  BCSR_MAT_SIMD_AVX512 = 2
+};
+int BCSRMatGetSIMDLevel();
+void BCSRMatSetMaxSIMDLevel(int level);
+
+void BCSRMatVecMult6SIMD(BCSRMatData *A, TacsScalar *x, TacsScalar *y);
+void BCSRMatVecMultAdd6SIMD(BCSRMatData *A, TacsScalar *x, TacsScalar *y,
+                            TacsScalar *z);
+void BCSRMatApplyLower6SIMD(BCSRMatData *A, TacsScalar *x, TacsScalar *y);
+void BCSRMatApplyUpper6SIMD(BCSRMatData *A, TacsScalar *x, TacsScalar *y);
+void *BCSRMatVecMultAdd6SIMD_thread(void *t);
+
+// The triangular solves that use the reduced factor stored in
+// BCSRMatData::Af with full-precision vectors
+void BCSRMatApplyLowerSingle(BCSRMatData *A, TacsScalar *x, TacsScalar *y);
+void BCSRMatApplyUpperSingle(BCSRMatData *A, TacsScalar *x, TacsScalar *y);
+void BCSRMatApplyPartialLowerSingle(BCSRMatData *A, TacsScalar *x,
+                                    int var_offset);
+void BCSRMatApplyPartialUpperSingle(BCSRMatData *A, TacsScalar *x,
+                                    int var_offset);
+void BCSRMatApplyFactorSchurSingle(BCSRMatData *A, TacsScalar *x,
+                                   int var_offset);
+#ifdef TACS_USE_COMPLEX
+// Factor the real part of the matrix stored in BCSRMatData::Af
+void BCSRMatFactorRealPart(BCSRMatData *A);
+#endif  // TACS_USE_COMPLEX
+
+// The products and triangular solves with multiple vectors
+void BCSRMatVecMultAddMulti(BCSRMatData *A, int start, int end, int nvecs,
+                            TacsScalar **x, TacsScalar **z, TacsScalar **y);
+void BCSRMatApplyLowerMulti(BCSRMatData *A, int nvecs, TacsScalar **x,
+                            TacsScalar **y);
+void BCSRMatApplyUpperMulti(BCSRMatData *A, int nvecs, TacsScalar **x,
+                            TacsScalar **y);
+
+// The products templated on the scalar type of the vectors, which are
+// instantiated for TacsComplex and, in the real build, TacsReal
+template <typename T>
+void BCSRMatVecMultAddScalar(BCSRMatData *A, int start, int end, const T *x,
+                             const T *z, T *y);
+template <typename T>
+void BCSRMatVecMultTransposeScalar(BCSRMatData *A, const T *x, T *y);
+
 // The bsize == 8 code
 void BCSRMatVecMult8(BCSRMatData *A, TacsScalar *x, TacsScalar *y);
 void BCSRMatVecMultAdd8(BCSRMatData *A, TacsScalar *x, TacsScalar *y,
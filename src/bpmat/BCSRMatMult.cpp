@@ -16,6 +16,8 @@
   http://www.apache.org/licenses/LICENSE-2.0
 */
 
+#include <sched.h>
+
 #include "BCSRMatImpl.h"
 #include "tacslapack.h"
 
@@ -23,6 +25,45 @@
   Code for the general block-size case
 */
 
+/*
+  Implementation of the BCSRMatPattern class
+*/
+BCSRMatPattern::BCSRMatPattern(int _nrows, int _ncols, int *_rowp, int *_cols,
+                               int *_diag) {
+  nrows = _nrows;
+  ncols = _ncols;
+  rowp = _rowp;
+  cols = _cols;
+  diag = _diag;
+}
+
+BCSRMatPattern::~BCSRMatPattern() {
+  if (diag) {
+    delete[] diag;
+  }
+  if (rowp) {
+    delete[] rowp;
+  }
+  if (cols) {
+    delete[] cols;
+  }
+}
+
+/*
+  Check if the pattern is identical to the given CSR data
+*/
+int BCSRMatPattern::isEqual(int _nrows, int _ncols, const int *_rowp,
+                            const int *_cols) {
+  if (_nrows != nrows || _ncols != ncols) {
+    return 0;
+  }
+  if (_rowp == rowp && _cols == cols) {
+    return 1;
+  }
+  return (memcmp(_rowp, rowp, (nrows + 1) * sizeof(int)) == 0 &&
+          memcmp(_cols, cols, rowp[nrows] * sizeof(int)) == 0);
+}
+
 /*
   Implementation of the BCSRMatData class
 */
@@ -34,7 +75,10 @@ BCSRMatData::BCSRMatData(int _bsize, int _nrows, int _ncols) {
   diag = NULL;
   rowp = NULL;
   cols = NULL;
+  pattern = NULL;
   A = NULL;
+  Af = NULL;
+  mem_bytes = 0;
 
   // The sizes of the groups of procs
   matvec_group_size = 1;
@@ -42,18 +86,51 @@ BCSRMatData::BCSRMatData(int _bsize, int _nrows, int _ncols) {
 }
 
 BCSRMatData::~BCSRMatData() {
-  if (diag) {
-    delete[] diag;
+  TACSMemory::update(TACS_MEMORY_MATRIX, &mem_bytes, 0);
+  if (pattern) {
+    pattern->decref();
+  } else {
+    if (diag) {
+      delete[] diag;
+    }
+    if (rowp) {
+      delete[] rowp;
+    }
+    if (cols) {
+      delete[] cols;
+    }
   }
-  if (rowp) {
-    delete[] rowp;
+  if (A) {
+    TacsFreeScalarArray(A);
   }
-  if (cols) {
-    delete[] cols;
+  if (Af) {
+    delete[] Af;
   }
-  if (A) {
-    delete[] A;
+}
+
+/*
+  Record the memory held by the values and the non-zero pattern. The
+  pattern is only charged to the object that owns it.
+*/
+void BCSRMatData::updateMemory() {
+  size_t bytes = 0;
+  if (rowp) {
+    size_t nnz = rowp[nrows];
+    size_t b2 = bsize * bsize;
+    if (A) {
+      bytes += b2 * nnz * sizeof(TacsScalar);
+    }
+    if (Af) {
+      bytes += b2 * nnz * sizeof(BCSRFactorScalar);
+    }
+    if (!pattern) {
+      bytes += (nrows + 1 + nnz) * sizeof(int);
+      if (diag) {
+        bytes += nrows * sizeof(int);
+      }
+    }
   }
+  TACSMemory::update(TACS_MEMORY_MATRIX, &mem_bytes, bytes);
 }
 
 /*
@@ -74,6 +151,19 @@ BCSRMatThread::BCSRMatThread(BCSRMatData *_mat) {
   completed_row_index = new int[nrows];
 
   num_completed_rows = 0;
+  use_partition = 0;
+  num_parts = 0;
+  part_group_size = 0;
+  part_ptr = NULL;
+  part_next = NULL;
+  part_end = NULL;
+
+  num_lower_levels = num_upper_levels = 0;
+  lower_level_ptr = lower_level_rows = NULL;
+  upper_level_ptr = upper_level_rows = NULL;
+  level_next = 0;
+  level_completed = 0;
+
   pthread_mutex_init(&mutex, NULL);
   pthread_cond_init(&cond, NULL);
 }
@@ -90,20 +180,95 @@ BCSRMatThread::~BCSRMatThread() {
   if (completed_row_index) {
     delete[] completed_row_index;
   }
+  if (part_ptr) {
+    delete[] part_ptr;
+    delete[] part_next;
+    delete[] part_end;
+  }
+  if (lower_level_ptr) {
+    delete[] lower_level_ptr;
+    delete[] lower_level_rows;
+  }
+  if (upper_level_ptr) {
+    delete[] upper_level_ptr;
+    delete[] upper_level_rows;
+  }
 }
 
 /*
   Schedule the jobs for matrix-vector and matrix-matrix products with
   a given group size
 */
-void BCSRMatThread::init_mat_mult_sched() { num_completed_rows = 0; }
+void BCSRMatThread::init_mat_mult_sched() {
+  num_completed_rows = 0;
+  use_partition = 0;
+}
+
+/*
+  Schedule the matrix-vector products so that each thread first
+  processes the rows in its block of the partition from
+  TacsGetRowPartition(). This is the partition used to first-touch the
+  matrix values, so each thread accesses memory on its own NUMA domain.
+  Once a thread's block is exhausted, it takes groups of rows from the
+  end of the block with the most remaining rows.
+*/
+void BCSRMatThread::init_mat_mult_partition_sched(const int nparts) {
+  const int group_size = mat->matvec_group_size;
+  if (nparts != num_parts || group_size != part_group_size) {
+    if (part_ptr) {
+      delete[] part_ptr;
+      delete[] part_next;
+      delete[] part_end;
+    }
+    num_parts = nparts;
+    part_group_size = group_size;
+    part_ptr = new int[nparts + 1];
+    part_next = new int[nparts];
+    part_end = new int[nparts];
+    TacsGetRowPartition(mat->nrows, nparts, group_size, part_ptr);
+  }
+
+  for (int k = 0; k < num_parts; k++) {
+    part_next[k] = part_ptr[k];
+    part_end[k] = part_ptr[k + 1];
+  }
+  num_completed_rows = 0;
+  use_partition = 1;
+}
 
 void BCSRMatThread::mat_mult_sched_job(const int group_size, int *row) {
   const int nrows = mat->nrows;
 
   pthread_mutex_lock(&mutex);
 
-  if (num_completed_rows < nrows) {
+  if (use_partition && group_size == part_group_size) {
+    *row = -1;
+    int k = TACSThreadInfo::getThreadIndex();
+    if (k < num_parts && part_next[k] < part_end[k]) {
+      // Take the next group of rows from this thread's block
+      *row = part_next[k];
+      int end = *row + group_size;
+      part_next[k] = (end < part_end[k] ? end : part_end[k]);
+      num_completed_rows += part_next[k] - *row;
+    } else {
+      // Take the last group of rows from the largest remaining block
+      int max_rows = 0;
+      for (int j = 0; j < num_parts; j++) {
+        if (part_end[j] - part_next[j] > max_rows) {
+          k = j;
+          max_rows = part_end[j] - part_next[j];
+        }
+      }
+      if (max_rows > 0) {
+        *row = group_size * ((part_end[k] - 1) / group_size);
+        if (*row < part_next[k]) {
+          *row = part_next[k];
+        }
+        num_completed_rows += part_end[k] - *row;
+        part_end[k] = *row;
+      }
+    }
+  } else if (num_completed_rows < nrows) {
     *row = num_completed_rows;
     num_completed_rows += group_size;
   } else {
@@ -299,13 +464,167 @@ void BCSRMatThread::apply_upper_mark_completed(const int group_size, int index,
   pthread_mutex_unlock(&mutex);
 }
 
+/*
+  Sort the rows by level given the level of each row. On return,
+  rows[ptr[l]:ptr[l+1]] contains the rows in level l in increasing
+  order.
+*/
+static void BCSRMatSortLevels(const int nrows, const int nlevels,
+                              const int *level, int **_ptr, int **_rows) {
+  int *ptr = new int[nlevels + 1];
+  int *rows = new int[nrows];
+  memset(ptr, 0, (nlevels + 1) * sizeof(int));
+  for (int i = 0; i < nrows; i++) {
+    ptr[level[i] + 1]++;
+  }
+  for (int l = 0; l < nlevels; l++) {
+    ptr[l + 1] += ptr[l];
+  }
+  for (int i = 0; i < nrows; i++) {
+    rows[ptr[level[i]]] = i;
+    ptr[level[i]]++;
+  }
+  for (int l = nlevels; l > 0; l--) {
+    ptr[l] = ptr[l - 1];
+  }
+  ptr[0] = 0;
+
+  *_ptr = ptr;
+  *_rows = rows;
+}
+
+/*
+  Initialize the level scheduler for the triangular solves.
+
+  The first call performs the symbolic level-set analysis of the
+  factored non-zero pattern. For L^{-1}, the level of row i is one
+  more than the maximum level of the rows referenced by the entries
+  to the left of the diagonal. For U^{-1}, the level is computed from
+  the last row using the entries to the right of the diagonal. The
+  analysis is reused for all subsequent calls. This must be called
+  before each application of L^{-1} or U^{-1}.
+*/
+void BCSRMatThread::init_apply_level_sched() {
+  if (!lower_level_ptr) {
+    const int nrows = mat->nrows;
+    const int *rowp = mat->rowp;
+    const int *cols = mat->cols;
+    const int *diag = mat->diag;
+    int *level = new int[nrows];
+
+    num_lower_levels = 0;
+    for (int i = 0; i < nrows; i++) {
+      int lev = 0;
+      for (int k = rowp[i]; k < diag[i]; k++) {
+        if (level[cols[k]] + 1 > lev) {
+          lev = level[cols[k]] + 1;
+        }
+      }
+      level[i] = lev;
+      if (lev + 1 > num_lower_levels) {
+        num_lower_levels = lev + 1;
+      }
+    }
+    BCSRMatSortLevels(nrows, num_lower_levels, level, &lower_level_ptr,
+                      &lower_level_rows);
+
+    num_upper_levels = 0;
+    for (int i = nrows - 1; i >= 0; i--) {
+      int lev = 0;
+      for (int k = diag[i] + 1; k < rowp[i + 1]; k++) {
+        if (level[cols[k]] + 1 > lev) {
+          lev = level[cols[k]] + 1;
+        }
+      }
+      level[i] = lev;
+      if (lev + 1 > num_upper_levels) {
+        num_upper_levels = lev + 1;
+      }
+    }
+    BCSRMatSortLevels(nrows, num_upper_levels, level, &upper_level_ptr,
+                      &upper_level_rows);
+
+    delete[] level;
+  }
+
+  level_next = 0;
+  level_completed = 0;
+}
+
+/*
+  Obtain the next range of positions [start, end) in the level
+  ordering for L^{-1} (upper = 0) or U^{-1} (upper = 1).
+
+  The range never extends past the end of a level. The ranges become
+  smaller towards the end of each level so that the rows are spread
+  over all the threads. Before returning, this waits until all the
+  rows in the previous levels are completed. Since the ranges are
+  assigned in order, the rows in the previous levels have already
+  been assigned to a running thread, so this is free of deadlock for
+  any number of threads. Returns 0 when all the rows are assigned.
+*/
+int BCSRMatThread::apply_level_sched_job(const int upper, const int group_size,
+                                         int *start, int *end) {
+  const int nrows = mat->nrows;
+  const int nlevels = (upper ? num_upper_levels : num_lower_levels);
+  const int *ptr = (upper ? upper_level_ptr : lower_level_ptr);
+
+  int pos = level_next.load(std::memory_order_relaxed);
+  int lev = 0;
+  while (1) {
+    if (pos >= nrows) {
+      return 0;
+    }
+
+    // Find the level containing the position
+    int low = 0, high = nlevels;
+    while (high - low > 1) {
+      int mid = (low + high) / 2;
+      if (ptr[mid] <= pos) {
+        low = mid;
+      } else {
+        high = mid;
+      }
+    }
+    lev = low;
+
+    int size = (ptr[lev + 1] - pos) / 4;
+    if (size > group_size) {
+      size = group_size;
+    } else if (size < 1) {
+      size = 1;
+    }
+    if (level_next.compare_exchange_weak(pos, pos + size,
+                                         std::memory_order_relaxed)) {
+      *start = pos;
+      *end = pos + size;
+      break;
+    }
+  }
+
+  // Wait until all the rows in the previous levels are completed
+  while (level_completed.load(std::memory_order_acquire) < ptr[lev]) {
+    sched_yield();
+  }
+
+  return 1;
+}
+
+/*
+  Mark the range of positions in the level ordering as completed
+*/
+void BCSRMatThread::apply_level_mark_completed(int start, int end) {
+  level_completed.fetch_add(end - start, std::memory_order_release);
+}
+
 /*!
   Compute the inverse of a matrix.
 
   A == A row-major ordered matrix of (bsize)x(bsize)
   w == A work array of size (bsize*bsize)
 */
-int BMatComputeInverse(TacsScalar *Ainv, TacsScalar *A, int *ipiv, int n) {
+template <typename T>
+static int BMatComputeInverseImpl(T *Ainv, T *A, int *ipiv, int n) {
   int fail = 0;
 
   for (int k = 0; k < n - 1; k++) {
@@ -328,7 +647,7 @@ int BMatComputeInverse(TacsScalar *Ainv, TacsScalar *A, int *ipiv, int n) {
     if (r != k) {
       int nr = n * r;
       for (int j = 0; j < n; j++) {
-        TacsScalar t = A[nk + j];
+        T t = A[nk + j];
         A[nk + j] = A[nr + j];
         A[nr + j] = t;
       }
@@ -388,6 +707,58 @@ int BMatComputeInverse(TacsScalar *Ainv, TacsScalar *A, int *ipiv, int n) {
   return fail;
 }
 
+int BMatComputeInverse(TacsScalar *Ainv, TacsScalar *A, int *ipiv, int n) {
+  return BMatComputeInverseImpl(Ainv, A, ipiv, n);
+}
+
+#ifdef TACS_USE_COMPLEX
+/*!
+  Compute the inverse of a real matrix for the factor of the real part
+  of a complex matrix
+*/
+int BMatComputeInverse(double *Ainv, double *A, int *ipiv, int n) {
+  return BMatComputeInverseImpl(Ainv, A, ipiv, n);
+}
+#endif  // TACS_USE_COMPLEX
+
+/*!
+  Compute the inertia of a symmetric matrix. Since the inertia of a
+  matrix and its inverse are the same, this can also be applied to the
+  inverted diagonal blocks of a factorization. Only the symmetric part
+  of the real part of the matrix is used.
+
+  A == A (n)x(n) matrix
+  work == A work array of size n*n + 4*n
+  nneg == The number of negative eigenvalues
+  npos == The number of positive eigenvalues
+*/
+void BMatComputeInertia(const TacsScalar *A, int n, double *work, int *nneg,
+                        int *npos) {
+  double *S = work;
+  double *eigs = &work[n * n];
+  double *w = &work[n * n + n];
+  int lwork = 3 * n;
+
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      S[i + n * j] =
+          0.5 * (TacsRealPart(A[i + n * j]) + TacsRealPart(A[j + n * i]));
+    }
+  }
+
+  int info = 0;
+  LAPACKdsyev("N", "U", &n, S, &n, eigs, w, &lwork, &info);
+
+  *nneg = *npos = 0;
+  for (int i = 0; i < n; i++) {
+    if (eigs[i] < 0.0) {
+      (*nneg)++;
+    } else if (eigs[i] > 0.0) {
+      (*npos)++;
+    }
+  }
+}
+
 /*!
   Compute the matrix-vector product: y = A * x
 */
@@ -989,6 +1360,66 @@ void BCSRMatApplySSOR(BCSRMatData *data, TacsScalar *Adiag, TacsScalar omega,
   delete[] tx;
 }
 
+/*!
+  Apply a step of SOR to the given list of rows of the system A*x = b.
+
+  The rows are updated in the order of the list. When no two rows in
+  the list are coupled, as for the rows of one color of a multicolor
+  ordering, the result does not depend on the order and the list can
+  be split between threads.
+*/
+void BCSRMatApplyRowSOR(BCSRMatData *Adata, const int *rows, const int nrows,
+                        const TacsScalar *Adiag, const TacsScalar omega,
+                        const TacsScalar *b, TacsScalar *x) {
+  const int *rowp = Adata->rowp;
+  const int *cols = Adata->cols;
+  const int bsize = Adata->bsize;
+  const int b2 = bsize * bsize;
+
+  TacsScalar tx[32];
+  TacsScalar *t = tx;
+  if (bsize > 32) {
+    t = new TacsScalar[bsize];
+  }
+
+  for (int ii = 0; ii < nrows; ii++) {
+    int i = rows[ii];
+    int bi = bsize * i;
+
+    // tx <- b_i - A_{ij}*x_{j} for j != i
+    for (int n = 0; n < bsize; n++) {
+      t[n] = b[bi + n];
+    }
+
+    const TacsScalar *a = &Adata->A[b2 * rowp[i]];
+    for (int k = rowp[i]; k < rowp[i + 1]; k++, a += b2) {
+      int j = cols[k];
+      if (i != j) {
+        const TacsScalar *xj = &x[bsize * j];
+        for (int m = 0; m < bsize; m++) {
+          for (int n = 0; n < bsize; n++) {
+            t[m] -= a[bsize * m + n] * xj[n];
+          }
+        }
+      }
+    }
+
+    // x[i] = (1.0 - omega)*x[i] + omega*D^{-1}tx
+    const TacsScalar *adiag = &Adiag[b2 * i];
+    for (int m = 0; m < bsize; m++) {
+      TacsScalar val = 0.0;
+      for (int n = 0; n < bsize; n++) {
+        val += adiag[bsize * m + n] * t[n];
+      }
+      x[bi + m] = (1.0 - omega) * x[bi + m] + omega * val;
+    }
+  }
+
+  if (t != tx) {
+    delete[] t;
+  }
+}
+
 /*!
   Apply a given number of steps of SOR to the system A*x = b.
 */
@@ -73,7 +73,7 @@ void *BCSRMatVecMultAdd6_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -121,7 +121,7 @@ void BCSRMatVecMult6(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
 }
 
 /*!
-  Compute the matrix vector product plus addition: z = A * x + y
+  Compute the matrix vector product plus addition: y = A * x + z
 */
 
 void BCSRMatVecMultAdd6(BCSRMatData *data, TacsScalar *x, TacsScalar *y,
@@ -135,27 +135,27 @@ void BCSRMatVecMultAdd6(BCSRMatData *data, TacsScalar *x, TacsScalar *y,
   for (int i = 0; i < nrows; i++) {
     int end = rowp[i + 1];
 
-    z[0] = y[0];
-    z[1] = y[1];
-    z[2] = y[2];
-    z[3] = y[3];
-    z[4] = y[4];
-    z[5] = y[5];
+    y[0] = z[0];
+    y[1] = z[1];
+    y[2] = z[2];
+    y[3] = z[3];
+    y[4] = z[4];
+    y[5] = z[5];
 
     for (int k = rowp[i]; k < end; k++) {
       int j = 6 * cols[k];
 
-      z[0] += a[0] * x[j] + a[1] * x[j + 1] + a[2] * x[j + 2] +
+      y[0] += a[0] * x[j] + a[1] * x[j + 1] + a[2] * x[j + 2] +
               a[3] * x[j + 3] + a[4] * x[j + 4] + a[5] * x[j + 5];
-      z[1] += a[6] * x[j] + a[7] * x[j + 1] + a[8] * x[j + 2] +
+      y[1] += a[6] * x[j] + a[7] * x[j + 1] + a[8] * x[j + 2] +
               a[9] * x[j + 3] + a[10] * x[j + 4] + a[11] * x[j + 5];
-      z[2] += a[12] * x[j] + a[13] * x[j + 1] + a[14] * x[j + 2] +
+      y[2] += a[12] * x[j] + a[13] * x[j + 1] + a[14] * x[j + 2] +
               a[15] * x[j + 3] + a[16] * x[j + 4] + a[17] * x[j + 5];
-      z[3] += a[18] * x[j] + a[19] * x[j + 1] + a[20] * x[j + 2] +
+      y[3] += a[18] * x[j] + a[19] * x[j + 1] + a[20] * x[j + 2] +
               a[21] * x[j + 3] + a[22] * x[j + 4] + a[23] * x[j + 5];
-      z[4] += a[24] * x[j] + a[25] * x[j + 1] + a[26] * x[j + 2] +
+      y[4] += a[24] * x[j] + a[25] * x[j + 1] + a[26] * x[j + 2] +
               a[27] * x[j + 3] + a[28] * x[j + 4] + a[29] * x[j + 5];
-      z[5] += a[30] * x[j] + a[31] * x[j + 1] + a[32] * x[j + 2] +
+      y[5] += a[30] * x[j] + a[31] * x[j + 1] + a[32] * x[j + 2] +
               a[33] * x[j + 3] + a[34] * x[j + 4] + a[35] * x[j + 5];
 
       a += 36;
@@ -231,7 +231,7 @@ void *BCSRMatApplyLower6_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*
@@ -310,7 +310,7 @@ void *BCSRMatApplyUpper6_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -1053,7 +1053,7 @@ void *BCSRMatMatMultAdd6_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -0,0 +1,387 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "BCSRMatImpl.h"
+
+/*
+  Explicitly vectorized implementations of the matrix-vector product
+  and the triangular solves for block size = 6.
+
+  The instruction set is selected at runtime based on the capabilities
+  of the CPU, so that the code can be compiled without any
+  architecture-specific flags. Each of the kernels below is written in
+  terms of a row kernel that computes the sum of the products of the
+  6x6 blocks in a block row with the corresponding entries of a
+  vector. The 36 entries of each block are contiguous, so they are
+  loaded as 9 AVX2 (or 4.5 AVX-512) vectors and multiplied with a
+  periodic arrangement of the vector entries. The products are
+  accumulated for the entire row and only reduced to the six outputs
+  once at the end of the row.
+
+  The SIMD kernels are only used for real arithmetic on x86-64. In all
+  other cases the row kernel is a scalar implementation.
+*/
+
+#if !defined(TACS_USE_COMPLEX) && defined(__GNUC__) && defined(__x86_64__)
+#define TACS_BCSR_X86_SIMD
+#include <immintrin.h>
+#endif  // TACS_BCSR_X86_SIMD
+
+// The row kernel: y = sum_{k} A[k]*x[cols[k]] for nblocks blocks
+typedef void (*BCSRMatRowMult6Func)(const TacsScalar *a, const int *cols,
+                                    const int nblocks, const TacsScalar *x,
+                                    TacsScalar *y);
+
+/*
+  Scalar version of the row kernel
+*/
+static void BCSRMatRowMult6(const TacsScalar *a, const int *cols,
+                            const int nblocks, const TacsScalar *x,
+                            TacsScalar *y) {
+  TacsScalar y0 = 0.0, y1 = 0.0, y2 = 0.0;
+  TacsScalar y3 = 0.0, y4 = 0.0, y5 = 0.0;
+  for (int k = 0; k < nblocks; k++) {
+    const TacsScalar *xj = &x[6 * cols[k]];
+    y0 += a[0] * xj[0] + a[1] * xj[1] + a[2] * xj[2] + a[3] * xj[3] +
+          a[4] * xj[4] + a[5] * xj[5];
+    y1 += a[6] * xj[0] + a[7] * xj[1] + a[8] * xj[2] + a[9] * xj[3] +
+          a[10] * xj[4] + a[11] * xj[5];
+    y2 += a[12] * xj[0] + a[13] * xj[1] + a[14] * xj[2] + a[15] * xj[3] +
+          a[16] * xj[4] + a[17] * xj[5];
+    y3 += a[18] * xj[0] + a[19] * xj[1] + a[20] * xj[2] + a[21] * xj[3] +
+          a[22] * xj[4] + a[23] * xj[5];
+    y4 += a[24] * xj[0] + a[25] * xj[1] + a[26] * xj[2] + a[27] * xj[3] +
+          a[28] * xj[4] + a[29] * xj[5];
+    y5 += a[30] * xj[0] + a[31] * xj[1] + a[32] * xj[2] + a[33] * xj[3] +
+          a[34] * xj[4] + a[35] * xj[5];
+    a += 36;
+  }
+  y[0] = y0;
+  y[1] = y1;
+  y[2] = y2;
+  y[3] = y3;
+  y[4] = y4;
+  y[5] = y5;
+}
+
+#ifdef TACS_BCSR_X86_SIMD
+
+/*
+  Reduce the accumulated products of the block entries to the six
+  outputs of the row
+*/
+static inline void BCSRMatReduceRow6(const double *t, double *y) {
+  for (int m = 0; m < 6; m++) {
+    y[m] = ((t[6 * m] + t[6 * m + 1]) + (t[6 * m + 2] + t[6 * m + 3])) +
+           (t[6 * m + 4] + t[6 * m + 5]);
+  }
+}
+
+/*
+  AVX2 version of the row kernel.
+
+  The entry 4*q + i of the block multiplies the vector entry
+  (4*q + i) % 6, so the vectors are arranged with a period of three:
+  [x0, x1, x2, x3], [x4, x5, x0, x1] and [x2, x3, x4, x5].
+*/
+__attribute__((target("avx2,fma"))) static void BCSRMatRowMult6_avx2(
+    const double *a, const int *cols, const int nblocks, const double *x,
+    double *y) {
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+  __m256d s4 = _mm256_setzero_pd(), s5 = _mm256_setzero_pd();
+  __m256d s6 = _mm256_setzero_pd(), s7 = _mm256_setzero_pd();
+  __m256d s8 = _mm256_setzero_pd();
+
+  for (int k = 0; k < nblocks; k++) {
+    const double *xj = &x[6 * cols[k]];
+    __m256d x0 = _mm256_loadu_pd(xj);
+    __m256d x2 = _mm256_loadu_pd(&xj[2]);
+    __m256d x1 = _mm256_permute2f128_pd(x2, x0, 0x21);
+
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[0]), x0, s0);
+    s1 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[4]), x1, s1);
+    s2 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[8]), x2, s2);
+    s3 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[12]), x0, s3);
+    s4 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[16]), x1, s4);
+    s5 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[20]), x2, s5);
+    s6 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[24]), x0, s6);
+    s7 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[28]), x1, s7);
+    s8 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[32]), x2, s8);
+    a += 36;
+  }
+
+  double t[36];
+  _mm256_storeu_pd(&t[0], s0);
+  _mm256_storeu_pd(&t[4], s1);
+  _mm256_storeu_pd(&t[8], s2);
+  _mm256_storeu_pd(&t[12], s3);
+  _mm256_storeu_pd(&t[16], s4);
+  _mm256_storeu_pd(&t[20], s5);
+  _mm256_storeu_pd(&t[24], s6);
+  _mm256_storeu_pd(&t[28], s7);
+  _mm256_storeu_pd(&t[32], s8);
+  BCSRMatReduceRow6(t, y);
+}
+
+/*
+  AVX-512 version of the row kernel.
+
+  The entry 8*q + i of the block multiplies the vector entry
+  (8*q + i) % 6, so the vectors are arranged with a period of three:
+  [x0, ..., x5, x0, x1], [x2, ..., x5, x0, ..., x3] and
+  [x4, x5, x0, ..., x5]. The last four entries of the block multiply
+  [x2, x3, x4, x5].
+*/
+__attribute__((target("avx512f,avx2,fma"))) static void BCSRMatRowMult6_avx512(
+    const double *a, const int *cols, const int nblocks, const double *x,
+    double *y) {
+  const __m512i p0 = _mm512_set_epi64(1, 0, 5, 4, 3, 2, 1, 0);
+  const __m512i p1 = _mm512_set_epi64(3, 2, 1, 0, 5, 4, 3, 2);
+  const __m512i p2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 5, 4);
+
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+  __m512d s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+  __m256d s4 = _mm256_setzero_pd();
+
+  for (int k = 0; k < nblocks; k++) {
+    const double *xj = &x[6 * cols[k]];
+    __m512d xv = _mm512_maskz_loadu_pd(0x3f, xj);
+    __m512d x0 = _mm512_maskz_permutexvar_pd(0xff, p0, xv);
+    __m512d x1 = _mm512_maskz_permutexvar_pd(0xff, p1, xv);
+    __m512d x2 = _mm512_maskz_permutexvar_pd(0xff, p2, xv);
+
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(&a[0]), x0, s0);
+    s1 = _mm512_fmadd_pd(_mm512_loadu_pd(&a[8]), x1, s1);
+    s2 = _mm512_fmadd_pd(_mm512_loadu_pd(&a[16]), x2, s2);
+    s3 = _mm512_fmadd_pd(_mm512_loadu_pd(&a[24]), x0, s3);
+    s4 = _mm256_fmadd_pd(_mm256_loadu_pd(&a[32]), _mm256_loadu_pd(&xj[2]), s4);
+    a += 36;
+  }
+
+  double t[36];
+  _mm512_storeu_pd(&t[0], s0);
+  _mm512_storeu_pd(&t[8], s1);
+  _mm512_storeu_pd(&t[16], s2);
+  _mm512_storeu_pd(&t[24], s3);
+  _mm256_storeu_pd(&t[32], s4);
+  BCSRMatReduceRow6(t, y);
+}
+
+#endif  // TACS_BCSR_X86_SIMD
+
+/*
+  Detect the highest level of SIMD instructions supported by the CPU
+*/
+static int BCSRMatDetectSIMDLevel() {
+#ifdef TACS_BCSR_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return BCSR_MAT_SIMD_AVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return BCSR_MAT_SIMD_AVX2;
+  }
+#endif  // TACS_BCSR_X86_SIMD
+  return BCSR_MAT_SIMD_NONE;
+}
+
+// The maximum SIMD level that may be used
+static int bcsr_mat_max_simd_level = BCSR_MAT_SIMD_AVX512;
+
+/*
+  Get the level of SIMD instructions used by the block size = 6
+  implementations. This is the lesser of the level supported by the
+  CPU and the maximum level set by BCSRMatSetMaxSIMDLevel().
+*/
+int BCSRMatGetSIMDLevel() {
+  static const int cpu_level = BCSRMatDetectSIMDLevel();
+  if (cpu_level < bcsr_mat_max_simd_level) {
+    return cpu_level;
+  }
+  return bcsr_mat_max_simd_level;
+}
+
+/*
+  Set the maximum level of SIMD instructions to use. This only affects
+  matrices that are created after this call.
+*/
+void BCSRMatSetMaxSIMDLevel(int level) {
+  if (level < BCSR_MAT_SIMD_NONE) {
+    level = BCSR_MAT_SIMD_NONE;
+  }
+  bcsr_mat_max_simd_level = level;
+}
+
+/*
+  Get the row kernel for the current SIMD level
+*/
+static BCSRMatRowMult6Func BCSRMatGetRowMult6() {
+#ifdef TACS_BCSR_X86_SIMD
+  int level = BCSRMatGetSIMDLevel();
+  if (level >= BCSR_MAT_SIMD_AVX512) {
+    return BCSRMatRowMult6_avx512;
+  } else if (level >= BCSR_MAT_SIMD_AVX2) {
+    return BCSRMatRowMult6_avx2;
+  }
+#endif  // TACS_BCSR_X86_SIMD
+  return BCSRMatRowMult6;
+}
+
+/*!
+  Compute the matrix-vector product: y = A * x
+*/
+void BCSRMatVecMult6SIMD(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const TacsScalar *A = data->A;
+  BCSRMatRowMult6Func rowmult = BCSRMatGetRowMult6();
+
+  for (int i = 0; i < nrows; i++) {
+    int k = rowp[i];
+    rowmult(&A[36 * k], &cols[k], rowp[i + 1] - k, x, &y[6 * i]);
+  }
+
+  TacsAddFlops(2 * 36 * rowp[nrows]);
+}
+
+/*!
+  Compute the matrix vector product plus addition: y = A * x + z
+*/
+void BCSRMatVecMultAdd6SIMD(BCSRMatData *data, TacsScalar *x, TacsScalar *y,
+                            TacsScalar *z) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const TacsScalar *A = data->A;
+  BCSRMatRowMult6Func rowmult = BCSRMatGetRowMult6();
+
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar t[6];
+    int k = rowp[i];
+    rowmult(&A[36 * k], &cols[k], rowp[i + 1] - k, x, t);
+
+    for (int m = 0; m < 6; m++) {
+      y[6 * i + m] = z[6 * i + m] + t[m];
+    }
+  }
+
+  TacsAddFlops(2 * 36 * rowp[nrows] + 6 * nrows);
+}
+
+/*!
+  Threaded implementation of the matrix-vector product. The output is
+  initialized before the threads are executed.
+*/
+void *BCSRMatVecMultAdd6SIMD_thread(void *t) {
+  BCSRMatThread *tdata = static_cast<BCSRMatThread *>(t);
+  const int nrows = tdata->mat->nrows;
+
+  // Get the input/output vectors
+  const TacsScalar *x = tdata->input;
+
+  const int *rowp = tdata->mat->rowp;
+  const int *cols = tdata->mat->cols;
+  const TacsScalar *A = tdata->mat->A;
+  const int group_size = tdata->mat->matvec_group_size;
+  BCSRMatRowMult6Func rowmult = BCSRMatGetRowMult6();
+
+  while (tdata->num_completed_rows < nrows) {
+    int row = -1;
+    tdata->mat_mult_sched_job(group_size, &row);
+
+    if (row >= 0) {
+      TacsScalar *y = &tdata->output[6 * row];
+      for (int ii = row; ii < nrows && (ii < row + group_size); ii++) {
+        TacsScalar s[6];
+        int k = rowp[ii];
+        rowmult(&A[36 * k], &cols[k], rowp[ii + 1] - k, x, s);
+        for (int m = 0; m < 6; m++) {
+          y[m] += s[m];
+        }
+        y += 6;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  Apply the lower factorization y = L^{-1} x
+*/
+void BCSRMatApplyLower6SIMD(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+  BCSRMatRowMult6Func rowmult = BCSRMatGetRowMult6();
+
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar t[6];
+    int k = rowp[i];
+    rowmult(&A[36 * k], &cols[k], diag[i] - k, y, t);
+
+    for (int m = 0; m < 6; m++) {
+      y[6 * i + m] = x[6 * i + m] - t[m];
+    }
+  }
+}
+
+/*!
+  Apply the upper factorization y = U^{-1} x
+*/
+void BCSRMatApplyUpper6SIMD(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+  BCSRMatRowMult6Func rowmult = BCSRMatGetRowMult6();
+
+  for (int i = nrows - 1; i >= 0; i--) {
+    TacsScalar t[6];
+    int k = diag[i] + 1;
+    rowmult(&A[36 * k], &cols[k], rowp[i + 1] - k, y, t);
+
+    TacsScalar y0 = x[6 * i] - t[0];
+    TacsScalar y1 = x[6 * i + 1] - t[1];
+    TacsScalar y2 = x[6 * i + 2] - t[2];
+    TacsScalar y3 = x[6 * i + 3] - t[3];
+    TacsScalar y4 = x[6 * i + 4] - t[4];
+    TacsScalar y5 = x[6 * i + 5] - t[5];
+
+    // Apply the inverse on the diagonal
+    const TacsScalar *a = &A[36 * diag[i]];
+    TacsScalar *yi = &y[6 * i];
+    yi[0] =
+        a[0] * y0 + a[1] * y1 + a[2] * y2 + a[3] * y3 + a[4] * y4 + a[5] * y5;
+    yi[1] =
+        a[6] * y0 + a[7] * y1 + a[8] * y2 + a[9] * y3 + a[10] * y4 + a[11] * y5;
+    yi[2] = a[12] * y0 + a[13] * y1 + a[14] * y2 + a[15] * y3 + a[16] * y4 +
+            a[17] * y5;
+    yi[3] = a[18] * y0 + a[19] * y1 + a[20] * y2 + a[21] * y3 + a[22] * y4 +
+            a[23] * y5;
+    yi[4] = a[24] * y0 + a[25] * y1 + a[26] * y2 + a[27] * y3 + a[28] * y4 +
+            a[29] * y5;
+    yi[5] = a[30] * y0 + a[31] * y1 + a[32] * y2 + a[33] * y3 + a[34] * y4 +
+            a[35] * y5;
+  }
+}
@@ -85,7 +85,7 @@ void *BCSRMatVecMultAdd8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -148,7 +148,7 @@ void BCSRMatVecMult8(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
 }
 
 /*!
-  Compute the matrix vector product plus addition: z = A * x + y
+  Compute the matrix vector product plus addition: y = A * x + z
 */
 
 void BCSRMatVecMultAdd8(BCSRMatData *data, TacsScalar *x, TacsScalar *y,
@@ -162,40 +162,40 @@ void BCSRMatVecMultAdd8(BCSRMatData *data, TacsScalar *x, TacsScalar *y,
   for (int i = 0; i < nrows; i++) {
     int end = rowp[i + 1];
 
-    z[0] = y[0];
-    z[1] = y[1];
-    z[2] = y[2];
-    z[3] = y[3];
-    z[4] = y[4];
-    z[5] = y[5];
-    z[6] = y[6];
-    z[7] = y[7];
+    y[0] = z[0];
+    y[1] = z[1];
+    y[2] = z[2];
+    y[3] = z[3];
+    y[4] = z[4];
+    y[5] = z[5];
+    y[6] = z[6];
+    y[7] = z[7];
 
     for (int k = rowp[i]; k < end; k++) {
       int j = 8 * cols[k];
 
-      z[0] += a[0] * x[j] + a[1] * x[j + 1] + a[2] * x[j + 2] +
+      y[0] += a[0] * x[j] + a[1] * x[j + 1] + a[2] * x[j + 2] +
               a[3] * x[j + 3] + a[4] * x[j + 4] + a[5] * x[j + 5] +
               a[6] * x[j + 6] + a[7] * x[j + 7];
-      z[1] += a[8] * x[j] + a[9] * x[j + 1] + a[10] * x[j + 2] +
+      y[1] += a[8] * x[j] + a[9] * x[j + 1] + a[10] * x[j + 2] +
               a[11] * x[j + 3] + a[12] * x[j + 4] + a[13] * x[j + 5] +
               a[14] * x[j + 6] + a[15] * x[j + 7];
-      z[2] += a[16] * x[j] + a[17] * x[j + 1] + a[18] * x[j + 2] +
+      y[2] += a[16] * x[j] + a[17] * x[j + 1] + a[18] * x[j + 2] +
               a[19] * x[j + 3] + a[20] * x[j + 4] + a[21] * x[j + 5] +
               a[22] * x[j + 6] + a[23] * x[j + 7];
-      z[3] += a[24] * x[j] + a[25] * x[j + 1] + a[26] * x[j + 2] +
+      y[3] += a[24] * x[j] + a[25] * x[j + 1] + a[26] * x[j + 2] +
               a[27] * x[j + 3] + a[28] * x[j + 4] + a[29] * x[j + 5] +
               a[30] * x[j + 6] + a[31] * x[j + 7];
-      z[4] += a[32] * x[j] + a[33] * x[j + 1] + a[34] * x[j + 2] +
+      y[4] += a[32] * x[j] + a[33] * x[j + 1] + a[34] * x[j + 2] +
               a[35] * x[j + 3] + a[36] * x[j + 4] + a[37] * x[j + 5] +
               a[38] * x[j + 6] + a[39] * x[j + 7];
-      z[5] += a[40] * x[j] + a[41] * x[j + 1] + a[42] * x[j + 2] +
+      y[5] += a[40] * x[j] + a[41] * x[j + 1] + a[42] * x[j + 2] +
               a[43] * x[j + 3] + a[44] * x[j + 4] + a[45] * x[j + 5] +
               a[46] * x[j + 6] + a[47] * x[j + 7];
-      z[6] += a[48] * x[j] + a[49] * x[j + 1] + a[50] * x[j + 2] +
+      y[6] += a[48] * x[j] + a[49] * x[j + 1] + a[50] * x[j + 2] +
               a[51] * x[j + 3] + a[52] * x[j + 4] + a[53] * x[j + 5] +
               a[54] * x[j + 6] + a[55] * x[j + 7];
-      z[7] += a[56] * x[j] + a[57] * x[j + 1] + a[58] * x[j + 2] +
+      y[7] += a[56] * x[j] + a[57] * x[j + 1] + a[58] * x[j + 2] +
               a[59] * x[j + 3] + a[60] * x[j + 4] + a[61] * x[j + 5] +
               a[62] * x[j + 6] + a[63] * x[j + 7];
       a += 64;
@@ -283,7 +283,7 @@ void *BCSRMatApplyLower8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*
@@ -378,7 +378,7 @@ void *BCSRMatApplyUpper8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -1475,7 +1475,7 @@ void *BCSRMatMatMultAdd8_thread(void *t) {
     }
   }
 
-  pthread_exit(NULL);
+  return NULL;
 }
 
 /*!
@@ -0,0 +1,243 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "BCSRMatImpl.h"
+
+/*
+  Implementations of the matrix-vector products and the triangular
+  solves with multiple vectors.
+
+  Each block of the matrix is loaded once and applied to all of the
+  vectors before moving to the next block, so the matrix is streamed
+  from memory once for all the vectors, instead of once per vector.
+  The vectors are passed as arrays of pointers to the individual
+  vector arrays, so that they can be taken directly from separate
+  TACSBVec objects.
+
+  Each kernel is templated on the block size N so that the loops over
+  the blocks are unrolled for the common block sizes. The value N = 0
+  is used for all other block sizes.
+*/
+
+/*
+  Compute y += A*x for a single block
+*/
+template <int N>
+static inline void BCSRBlockMultAddMulti(const int bsize, const TacsScalar *a,
+                                         const TacsScalar *x, TacsScalar *y) {
+  const int n = (N > 0 ? N : bsize);
+  for (int m = 0; m < n; m++) {
+    TacsScalar s = 0.0;
+    for (int k = 0; k < n; k++) {
+      s += a[n * m + k] * x[k];
+    }
+    y[m] += s;
+  }
+}
+
+/*
+  Compute y -= A*x for a single block
+*/
+template <int N>
+static inline void BCSRBlockMultSubMulti(const int bsize, const TacsScalar *a,
+                                         const TacsScalar *x, TacsScalar *y) {
+  const int n = (N > 0 ? N : bsize);
+  for (int m = 0; m < n; m++) {
+    TacsScalar s = 0.0;
+    for (int k = 0; k < n; k++) {
+      s += a[n * m + k] * x[k];
+    }
+    y[m] -= s;
+  }
+}
+
+/*
+  Compute y[v] = A*x[v] + z[v] for the rows [start, end)
+*/
+template <int N>
+static void BCSRMatVecMultAddMultiImpl(BCSRMatData *data, int start, int end,
+                                       int nvecs, TacsScalar **x,
+                                       TacsScalar **z, TacsScalar **y) {
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const TacsScalar *A = data->A;
+
+  // The sums for each vector in the current row
+  TacsScalar *t = new TacsScalar[bsize * nvecs];
+
+  for (int i = start; i < end; i++) {
+    for (int q = 0; q < bsize * nvecs; q++) {
+      t[q] = 0.0;
+    }
+
+    int kend = rowp[i + 1];
+    for (int k = rowp[i]; k < kend; k++) {
+      const TacsScalar *a = &A[b2 * k];
+      const int bj = bsize * cols[k];
+      for (int v = 0; v < nvecs; v++) {
+        BCSRBlockMultAddMulti<N>(bsize, a, &x[v][bj], &t[bsize * v]);
+      }
+    }
+
+    const int bi = bsize * i;
+    for (int v = 0; v < nvecs; v++) {
+      if (z && z[v]) {
+        for (int m = 0; m < bsize; m++) {
+          y[v][bi + m] = z[v][bi + m] + t[bsize * v + m];
+        }
+      } else {
+        for (int m = 0; m < bsize; m++) {
+          y[v][bi + m] = t[bsize * v + m];
+        }
+      }
+    }
+  }
+
+  delete[] t;
+}
+
+/*
+  Apply the lower factorization y[v] = L^{-1} x[v]
+*/
+template <int N>
+static void BCSRMatApplyLowerMultiImpl(BCSRMatData *data, int nvecs,
+                                       TacsScalar **x, TacsScalar **y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const TacsScalar *A = data->A;
+
+  for (int i = 0; i < nrows; i++) {
+    const int bi = bsize * i;
+    for (int v = 0; v < nvecs; v++) {
+      if (x[v] != y[v]) {
+        for (int m = 0; m < bsize; m++) {
+          y[v][bi + m] = x[v][bi + m];
+        }
+      }
+    }
+
+    int kend = diag[i];
+    for (int k = rowp[i]; k < kend; k++) {
+      const TacsScalar *a = &A[b2 * k];
+      const int bj = bsize * cols[k];
+      for (int v = 0; v < nvecs; v++) {
+        BCSRBlockMultSubMulti<N>(bsize, a, &y[v][bj], &y[v][bi]);
+      }
+    }
+  }
+}
+
+/*
+  Apply the upper factorization y[v] = U^{-1} x[v]
+*/
+template <int N>
+static void BCSRMatApplyUpperMultiImpl(BCSRMatData *data, int nvecs,
+                                       TacsScalar **x, TacsScalar **y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const TacsScalar *A = data->A;
+
+  // The partial results for each vector in the current row
+  TacsScalar *t = new TacsScalar[bsize * nvecs];
+
+  for (int i = nrows - 1; i >= 0; i--) {
+    const int bi = bsize * i;
+    for (int v = 0; v < nvecs; v++) {
+      for (int m = 0; m < bsize; m++) {
+        t[bsize * v + m] = x[v][bi + m];
+      }
+    }
+
+    int kend = rowp[i + 1];
+    for (int k = diag[i] + 1; k < kend; k++) {
+      const TacsScalar *a = &A[b2 * k];
+      const int bj = bsize * cols[k];
+      for (int v = 0; v < nvecs; v++) {
+        BCSRBlockMultSubMulti<N>(bsize, a, &y[v][bj], &t[bsize * v]);
+      }
+    }
+
+    // Apply the inverse on the diagonal
+    const TacsScalar *adiag = &A[b2 * diag[i]];
+    for (int v = 0; v < nvecs; v++) {
+      for (int m = 0; m < bsize; m++) {
+        y[v][bi + m] = 0.0;
+      }
+      BCSRBlockMultAddMulti<N>(bsize, adiag, &t[bsize * v], &y[v][bi]);
+    }
+  }
+
+  delete[] t;
+}
+
+/*
+  Select the implementation based on the block size of the matrix
+*/
+#define BCSR_MAT_MULTI_DISPATCH(func, args) \
+  switch (data->bsize) {                    \
+    case 1:                                 \
+      func<1> args;                         \
+      break;                                \
+    case 2:                                 \
+      func<2> args;                         \
+      break;                                \
+    case 3:                                 \
+      func<3> args;                         \
+      break;                                \
+    case 4:                                 \
+      func<4> args;                         \
+      break;                                \
+    case 5:                                 \
+      func<5> args;                         \
+      break;                                \
+    case 6:                                 \
+      func<6> args;                         \
+      break;                                \
+    case 8:                                 \
+      func<8> args;                         \
+      break;                                \
+    default:                                \
+      func<0> args;                         \
+      break;                                \
+  }
+
+void BCSRMatVecMultAddMulti(BCSRMatData *data, int start, int end, int nvecs,
+                            TacsScalar **x, TacsScalar **z, TacsScalar **y) {
+  BCSR_MAT_MULTI_DISPATCH(BCSRMatVecMultAddMultiImpl,
+                          (data, start, end, nvecs, x, z, y));
+}
+
+void BCSRMatApplyLowerMulti(BCSRMatData *data, int nvecs, TacsScalar **x,
+                            TacsScalar **y) {
+  BCSR_MAT_MULTI_DISPATCH(BCSRMatApplyLowerMultiImpl, (data, nvecs, x, y));
+}
+
+void BCSRMatApplyUpperMulti(BCSRMatData *data, int nvecs, TacsScalar **x,
+                            TacsScalar **y) {
+  BCSR_MAT_MULTI_DISPATCH(BCSRMatApplyUpperMultiImpl, (data, nvecs, x, y));
+}
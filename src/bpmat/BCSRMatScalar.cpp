@@ -0,0 +1,179 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "BCSRMatImpl.h"
+
+/*
+  Matrix-vector products templated on the scalar type of the vectors.
+
+  The matrix entries are stored as TacsScalar, while the input and
+  output vectors are of type T. In the real build this allows a real
+  matrix to be applied to complex vectors, so that a complex-step
+  check can be performed through the product in the same process
+  without a second copy of the matrix in complex arithmetic. The
+  kernels are explicitly instantiated below for TacsComplex and, when
+  TacsScalar is real, for TacsReal.
+
+  As in BCSRMatSingle.cpp, the kernels are also templated on the block
+  size N with N = 0 used for the block sizes only known at runtime.
+*/
+
+/*
+  Compute y += A*x for a single block
+*/
+template <typename T, int N>
+static inline void BCSRBlockMultAddScalar(const int bsize, const TacsScalar *a,
+                                          const T *x, T *y) {
+  const int n = (N > 0 ? N : bsize);
+  for (int m = 0; m < n; m++) {
+    T s = 0.0;
+    for (int k = 0; k < n; k++) {
+      s += a[n * m + k] * x[k];
+    }
+    y[m] += s;
+  }
+}
+
+/*
+  Compute y += A^{T}*x for a single block
+*/
+template <typename T, int N>
+static inline void BCSRBlockMultTransAddScalar(const int bsize,
+                                               const TacsScalar *a, const T *x,
+                                               T *y) {
+  const int n = (N > 0 ? N : bsize);
+  for (int m = 0; m < n; m++) {
+    for (int k = 0; k < n; k++) {
+      y[k] += a[n * m + k] * x[m];
+    }
+  }
+}
+
+/*
+  Compute y = A*x + z for the rows in [start, end)
+*/
+template <typename T, int N>
+static void BCSRMatVecMultAddScalarImpl(BCSRMatData *data, int start, int end,
+                                        const T *x, const T *z, T *y) {
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const TacsScalar *A = data->A;
+
+  for (int i = start; i < end; i++) {
+    T *yi = &y[bsize * i];
+    if (z) {
+      for (int m = 0; m < bsize; m++) {
+        yi[m] = z[bsize * i + m];
+      }
+    } else {
+      for (int m = 0; m < bsize; m++) {
+        yi[m] = 0.0;
+      }
+    }
+
+    int kend = rowp[i + 1];
+    for (int k = rowp[i]; k < kend; k++) {
+      BCSRBlockMultAddScalar<T, N>(bsize, &A[b2 * k], &x[bsize * cols[k]],
+                                   yi);
+    }
+  }
+}
+
+/*
+  Compute y += A^{T}*x
+*/
+template <typename T, int N>
+static void BCSRMatVecMultTransposeScalarImpl(BCSRMatData *data, const T *x,
+                                              T *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const TacsScalar *A = data->A;
+
+  for (int i = 0; i < nrows; i++) {
+    int kend = rowp[i + 1];
+    for (int k = rowp[i]; k < kend; k++) {
+      BCSRBlockMultTransAddScalar<T, N>(bsize, &A[b2 * k], &x[bsize * i],
+                                        &y[bsize * cols[k]]);
+    }
+  }
+}
+
+/*
+  Select the implementation based on the block size of the matrix
+*/
+#define BCSR_MAT_SCALAR_DISPATCH(func, args) \
+  switch (data->bsize) {                     \
+    case 1:                                  \
+      func<T, 1> args;                       \
+      break;                                 \
+    case 2:                                  \
+      func<T, 2> args;                       \
+      break;                                 \
+    case 3:                                  \
+      func<T, 3> args;                       \
+      break;                                 \
+    case 4:                                  \
+      func<T, 4> args;                       \
+      break;                                 \
+    case 5:                                  \
+      func<T, 5> args;                       \
+      break;                                 \
+    case 6:                                  \
+      func<T, 6> args;                       \
+      break;                                 \
+    case 8:                                  \
+      func<T, 8> args;                       \
+      break;                                 \
+    default:                                 \
+      func<T, 0> args;                       \
+      break;                                 \
+  }
+
+template <typename T>
+void BCSRMatVecMultAddScalar(BCSRMatData *data, int start, int end,
+                             const T *x, const T *z, T *y) {
+  BCSR_MAT_SCALAR_DISPATCH(BCSRMatVecMultAddScalarImpl,
+                           (data, start, end, x, z, y));
+}
+
+template <typename T>
+void BCSRMatVecMultTransposeScalar(BCSRMatData *data, const T *x, T *y) {
+  BCSR_MAT_SCALAR_DISPATCH(BCSRMatVecMultTransposeScalarImpl, (data, x, y));
+}
+
+template void BCSRMatVecMultAddScalar<TacsComplex>(BCSRMatData *, int, int,
+                                                   const TacsComplex *,
+                                                   const TacsComplex *,
+                                                   TacsComplex *);
+template void BCSRMatVecMultTransposeScalar<TacsComplex>(BCSRMatData *,
+                                                         const TacsComplex *,
+                                                         TacsComplex *);
+
+#ifndef TACS_USE_COMPLEX
+template void BCSRMatVecMultAddScalar<TacsReal>(BCSRMatData *, int, int,
+                                                const TacsReal *,
+                                                const TacsReal *, TacsReal *);
+template void BCSRMatVecMultTransposeScalar<TacsReal>(BCSRMatData *,
+                                                      const TacsReal *,
+                                                      TacsReal *);
+#endif  // TACS_USE_COMPLEX
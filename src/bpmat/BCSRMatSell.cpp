@@ -0,0 +1,326 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "BCSRMatSell.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  Compare two (length, row) pairs so that the longest rows come first,
+  with ties broken by the row index
+*/
+static int BCSRMatSellCompareRows(const void *a, const void *b) {
+  const int *ia = (const int *)a;
+  const int *ib = (const int *)b;
+  if (ia[0] != ib[0]) {
+    return ib[0] - ia[0];
+  }
+  return ia[1] - ib[1];
+}
+
+/*
+  Compute the product for a single chunk
+
+  y[perm[r]] = z[perm[r]] + sum_{s} A[s, r] x[cols[s, r]]
+
+  The sum for all rows in the chunk is accumulated in t, which is of
+  length C*bsize. When z is NULL, it is treated as zero. The block
+  size N is a compile-time constant, except when N = 0.
+*/
+template <int N>
+static void BCSRMatSellMultChunk(const int bsize, const int C, const int c,
+                                 const int *chunk_ptr, const int *perm,
+                                 const int *cols, const TacsScalar *A,
+                                 const TacsScalar *x, const TacsScalar *z,
+                                 TacsScalar *y, TacsScalar *t) {
+  const int n = (N > 0 ? N : bsize);
+  const int b2 = n * n;
+
+  for (int i = 0; i < C * n; i++) {
+    t[i] = 0.0;
+  }
+
+  for (int s = chunk_ptr[c]; s < chunk_ptr[c + 1]; s++) {
+    const int *sc = &cols[C * s];
+    const TacsScalar *a = &A[b2 * C * s];
+
+    for (int r = 0; r < C; r++, a += b2) {
+      const TacsScalar *xj = &x[n * sc[r]];
+      TacsScalar *tr = &t[n * r];
+      for (int m = 0; m < n; m++) {
+        for (int k = 0; k < n; k++) {
+          tr[m] += a[n * m + k] * xj[k];
+        }
+      }
+    }
+  }
+
+  const int *p = &perm[C * c];
+  for (int r = 0; r < C; r++) {
+    if (p[r] >= 0) {
+      TacsScalar *yr = &y[n * p[r]];
+      if (z) {
+        const TacsScalar *zr = &z[n * p[r]];
+        for (int m = 0; m < n; m++) {
+          yr[m] = zr[m] + t[n * r + m];
+        }
+      } else {
+        for (int m = 0; m < n; m++) {
+          yr[m] = t[n * r + m];
+        }
+      }
+    }
+  }
+}
+
+/*
+  Create the SELL-C-sigma storage from the non-zero pattern of the
+  BCSRMat and copy the values.
+
+  input:
+  mat:         the matrix
+  chunk_size:  the number of rows in each chunk (C)
+  sigma:       the size of the window used to sort the rows
+*/
+BCSRMatSell::BCSRMatSell(BCSRMat *mat, int _chunk_size, int _sigma) {
+  thread_info = mat->getThreadInfo();
+  if (thread_info) {
+    thread_info->incref();
+  }
+
+  chunk_size = _chunk_size;
+  if (chunk_size < 1) {
+    chunk_size = 1;
+  }
+  sigma = _sigma;
+  if (sigma < 1) {
+    sigma = 1;
+  }
+
+  const int *rowp, *csr_cols;
+  TacsScalar *Acsr;
+  mat->getArrays(&bsize, &nrows, &ncols, &rowp, &csr_cols, &Acsr);
+  nnz = rowp[nrows];
+  const int C = chunk_size;
+
+  // Sort the rows by decreasing length within each window
+  int *pairs = new int[2 * nrows];
+  for (int i = 0; i < nrows; i++) {
+    pairs[2 * i] = rowp[i + 1] - rowp[i];
+    pairs[2 * i + 1] = i;
+  }
+  for (int w = 0; w < nrows; w += sigma) {
+    int len = (w + sigma < nrows ? sigma : nrows - w);
+    qsort(&pairs[2 * w], len, 2 * sizeof(int), BCSRMatSellCompareRows);
+  }
+
+  // Set the rows stored in each position of the chunks
+  num_chunks = (nrows + C - 1) / C;
+  perm = new int[C * num_chunks];
+  for (int i = 0; i < C * num_chunks; i++) {
+    perm[i] = (i < nrows ? pairs[2 * i + 1] : -1);
+  }
+  delete[] pairs;
+
+  // Each chunk has as many slots as its longest row
+  chunk_ptr = new int[num_chunks + 1];
+  chunk_ptr[0] = 0;
+  for (int c = 0; c < num_chunks; c++) {
+    int max_len = 0;
+    for (int r = 0; r < C; r++) {
+      int row = perm[C * c + r];
+      if (row >= 0 && rowp[row + 1] - rowp[row] > max_len) {
+        max_len = rowp[row + 1] - rowp[row];
+      }
+    }
+    chunk_ptr[c + 1] = chunk_ptr[c] + max_len;
+  }
+
+  // Set the column indices. The padding entries use the last column
+  // in the row so that the zero blocks reference nearby entries.
+  int num_slots = chunk_ptr[num_chunks];
+  cols = new int[C * num_slots];
+  csr_index = new int[nnz];
+  for (int c = 0; c < num_chunks; c++) {
+    for (int r = 0; r < C; r++) {
+      int row = perm[C * c + r];
+      int row_len = 0, pad_col = 0;
+      if (row >= 0) {
+        row_len = rowp[row + 1] - rowp[row];
+        if (row_len > 0) {
+          pad_col = csr_cols[rowp[row + 1] - 1];
+        }
+      }
+
+      for (int j = 0, s = chunk_ptr[c]; s < chunk_ptr[c + 1]; j++, s++) {
+        if (j < row_len) {
+          int k = rowp[row] + j;
+          cols[C * s + r] = csr_cols[k];
+          csr_index[k] = C * s + r;
+        } else {
+          cols[C * s + r] = pad_col;
+        }
+      }
+    }
+  }
+
+  // Allocate the zeroed values and copy the entries
+  size_t length = (size_t)bsize * bsize * C * num_slots;
+  A = TacsAllocScalarArray(length, thread_info, num_chunks, chunk_ptr,
+                           bsize * bsize * C, 1);
+  setValues(mat);
+
+  input = sum = output = NULL;
+}
+
+BCSRMatSell::~BCSRMatSell() {
+  if (thread_info) {
+    thread_info->decref();
+  }
+  delete[] chunk_ptr;
+  delete[] perm;
+  delete[] cols;
+  delete[] csr_index;
+  TacsFreeScalarArray(A);
+}
+
+/*
+  Copy the values from the BCSRMat. This must be a matrix with the
+  same non-zero pattern used to create this object.
+*/
+void BCSRMatSell::setValues(BCSRMat *mat) {
+  int bs, nr, nc;
+  const int *rowp, *csr_cols;
+  TacsScalar *Acsr;
+  mat->getArrays(&bs, &nr, &nc, &rowp, &csr_cols, &Acsr);
+
+  if (bs != bsize || nr != nrows || nc != ncols || rowp[nr] != nnz) {
+    fprintf(stderr, "BCSRMatSell error: non-zero pattern does not match\n");
+    return;
+  }
+
+  const int b2 = bsize * bsize;
+  for (int k = 0; k < nnz; k++) {
+    memcpy(&A[b2 * csr_index[k]], &Acsr[b2 * k], b2 * sizeof(TacsScalar));
+  }
+}
+
+/*
+  Compute the products for the chunks in [start, end)
+*/
+void BCSRMatSell::multRange(int start, int end, int thread_id, void *ctx) {
+  BCSRMatSell *self = (BCSRMatSell *)ctx;
+  const int bsize = self->bsize;
+  const int C = self->chunk_size;
+  TacsScalar *t = new TacsScalar[C * bsize];
+
+  for (int c = start; c < end; c++) {
+    switch (bsize) {
+      case 1:
+        BCSRMatSellMultChunk<1>(bsize, C, c, self->chunk_ptr, self->perm,
+                                self->cols, self->A, self->input, self->sum,
+                                self->output, t);
+        break;
+      case 2:
+        BCSRMatSellMultChunk<2>(bsize, C, c, self->chunk_ptr, self->perm,
+                                self->cols, self->A, self->input, self->sum,
+                                self->output, t);
+        break;
+      case 3:
+        BCSRMatSellMultChunk<3>(bsize, C, c, self->chunk_ptr, self->perm,
+                                self->cols, self->A, self->input, self->sum,
+                                self->output, t);
+        break;
+      case 6:
+        BCSRMatSellMultChunk<6>(bsize, C, c, self->chunk_ptr, self->perm,
+                                self->cols, self->A, self->input, self->sum,
+                                self->output, t);
+        break;
+      default:
+        BCSRMatSellMultChunk<0>(bsize, C, c, self->chunk_ptr, self->perm,
+                                self->cols, self->A, self->input, self->sum,
+                                self->output, t);
+        break;
+    }
+  }
+
+  delete[] t;
+}
+
+/*!
+  Compute y = A*x
+*/
+void BCSRMatSell::mult(TacsScalar *x, TacsScalar *y) { multAdd(x, NULL, y); }
+
+/*!
+  Compute y = A*x + z. When z is NULL, this computes y = A*x.
+*/
+void BCSRMatSell::multAdd(TacsScalar *x, TacsScalar *z, TacsScalar *y) {
+  input = x;
+  sum = z;
+  output = y;
+
+  // Rows in different chunks are distinct, so the chunks can be
+  // processed in any order
+  if (thread_info) {
+    thread_info->parallelFor(num_chunks, 16, multRange, this);
+  } else {
+    multRange(0, num_chunks, 0, this);
+  }
+
+  input = sum = output = NULL;
+}
+
+/*!
+  Compute y = A^{T}*x
+*/
+void BCSRMatSell::multTranspose(TacsScalar *x, TacsScalar *y) {
+  const int C = chunk_size;
+  const int b2 = bsize * bsize;
+  memset(y, 0, bsize * ncols * sizeof(TacsScalar));
+
+  for (int c = 0; c < num_chunks; c++) {
+    const int *p = &perm[C * c];
+    for (int s = chunk_ptr[c]; s < chunk_ptr[c + 1]; s++) {
+      const TacsScalar *a = &A[b2 * C * s];
+      for (int r = 0; r < C; r++, a += b2) {
+        if (p[r] >= 0) {
+          const TacsScalar *xr = &x[bsize * p[r]];
+          TacsScalar *yj = &y[bsize * cols[C * s + r]];
+          for (int m = 0; m < bsize; m++) {
+            for (int k = 0; k < bsize; k++) {
+              yj[k] += a[bsize * m + k] * xr[m];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+  Get the ratio of the number of stored blocks, including the padding,
+  to the number of non-zero blocks
+*/
+double BCSRMatSell::getFillRatio() {
+  if (nnz > 0) {
+    return (double)chunk_size * chunk_ptr[num_chunks] / nnz;
+  }
+  return 1.0;
+}
@@ -0,0 +1,92 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_BCSR_MAT_SELL_H
+#define TACS_BCSR_MAT_SELL_H
+
+#include "BCSRMat.h"
+
+/*!
+  Sliced-ELLPACK (SELL-C-sigma) copy of a BCSRMat used for the
+  matrix-vector products.
+
+  The rows of the matrix are sorted by decreasing length within
+  windows of sigma rows, and then grouped into chunks of C consecutive
+  sorted rows. Every row in a chunk is padded with zero blocks to the
+  length of the longest row in the chunk. The blocks of each chunk are
+  stored so that the j-th blocks of all C rows are contiguous, which
+  makes the inner loop of the product regular across the rows of the
+  chunk. This is most beneficial for small block sizes, where the
+  short and irregular rows of the CSR layout limit vectorization.
+
+  The non-zero pattern is copied from the BCSRMat when the object is
+  created. The values are not shared: they must be copied again with
+  setValues() whenever the entries of the BCSRMat change. The BCSRMat
+  is still used for all other operations, including the factorization.
+*/
+class BCSRMatSell : public TACSObject {
+ public:
+  BCSRMatSell(BCSRMat *mat, int _chunk_size = 8, int _sigma = 64);
+  ~BCSRMatSell();
+
+  // Copy the values from the BCSRMat with the same non-zero pattern
+  void setValues(BCSRMat *mat);
+
+  // Compute matrix-vector products with the SELL storage
+  void mult(TacsScalar *x, TacsScalar *y);
+  void multAdd(TacsScalar *x, TacsScalar *z, TacsScalar *y);
+  void multTranspose(TacsScalar *x, TacsScalar *y);
+
+  // Get information about the storage
+  int getChunkSize() { return chunk_size; }
+  int getSigma() { return sigma; }
+  double getFillRatio();
+
+ private:
+  // Threaded range function for the products over the chunks
+  static void multRange(int start, int end, int thread_id, void *ctx);
+
+  // Information about the threaded execution
+  TACSThreadInfo *thread_info;
+
+  // The dimensions of the matrix
+  int bsize, nrows, ncols, nnz;
+
+  // The SELL parameters
+  int chunk_size, sigma;
+
+  // The number of chunks and the offset to the first slot of each
+  // chunk. Each slot contains one block for every row in the chunk.
+  int num_chunks;
+  int *chunk_ptr;
+
+  // The row stored in each position of the chunks, -1 for padding
+  int *perm;
+
+  // The block column index and values for each slot
+  int *cols;
+  TacsScalar *A;
+
+  // The location in A of each of the blocks in the CSR storage
+  int *csr_index;
+
+  // The input/output arrays used during the threaded products
+  TacsScalar *input, *sum, *output;
+};
+
+#endif  // TACS_BCSR_MAT_SELL_H
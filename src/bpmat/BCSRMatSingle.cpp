@@ -0,0 +1,410 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "BCSRMatImpl.h"
+
+/*
+  Mixed-precision implementations of the triangular solves.
+
+  These kernels apply an ILU factorization whose entries are stored in
+  single precision in BCSRMatData::Af, while the input and output
+  vectors are kept in double precision. Each block entry is converted
+  to double precision as it is loaded, so that all the arithmetic is
+  performed in double precision and only the storage of the factor is
+  reduced. Since the triangular solves are limited by the memory
+  bandwidth, halving the size of the factor reduces the cost of
+  applying the preconditioner.
+
+  In complex mode, the same kernels apply a factor of the real part of
+  the matrix stored in double precision. Since the factor is real,
+  each product with a block acts on the real and imaginary parts of
+  the vector separately, which requires half the work of a
+  product with a complex factor.
+
+  Each kernel is templated on the block size N so that the loops over
+  the blocks are unrolled for the common block sizes. The value N = 0
+  is used for all other block sizes where the block size is only known
+  at runtime.
+*/
+
+/*
+  Compute t -= A*x for a single block of the reduced factor
+*/
+template <int N>
+static inline void BCSRBlockMultSubSingle(const int bsize,
+                                          const BCSRFactorScalar *a,
+                                          const TacsScalar *x, TacsScalar *t) {
+  const int n = (N > 0 ? N : bsize);
+  for (int m = 0; m < n; m++) {
+    TacsScalar s = 0.0;
+    for (int k = 0; k < n; k++) {
+      s += (double)a[n * m + k] * x[k];
+    }
+    t[m] -= s;
+  }
+}
+
+/*
+  Compute y = A*t for a single block of the reduced factor
+*/
+template <int N>
+static inline void BCSRBlockMultSingle(const int bsize,
+                                       const BCSRFactorScalar *a,
+                                       const TacsScalar *t, TacsScalar *y) {
+  const int n = (N > 0 ? N : bsize);
+  for (int m = 0; m < n; m++) {
+    TacsScalar s = 0.0;
+    for (int k = 0; k < n; k++) {
+      s += (double)a[n * m + k] * t[k];
+    }
+    y[m] = s;
+  }
+}
+
+/*
+  Apply the lower factorization y = L^{-1} x
+*/
+template <int N>
+static void BCSRMatApplyLowerSingleImpl(BCSRMatData *data, TacsScalar *x,
+                                        TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const BCSRFactorScalar *A = data->Af;
+
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar *yi = &y[bsize * i];
+    if (x != y) {
+      for (int m = 0; m < bsize; m++) {
+        yi[m] = x[bsize * i + m];
+      }
+    }
+
+    // The entries to the left of the diagonal only reference rows
+    // that have already been computed
+    int end = diag[i];
+    for (int k = rowp[i]; k < end; k++) {
+      BCSRBlockMultSubSingle<N>(bsize, &A[b2 * k], &y[bsize * cols[k]], yi);
+    }
+  }
+}
+
+/*
+  Apply the upper factorization y = U^{-1} x
+*/
+template <int N>
+static void BCSRMatApplyUpperSingleImpl(BCSRMatData *data, TacsScalar *x,
+                                        TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const BCSRFactorScalar *A = data->Af;
+
+  TacsScalar tn[N > 0 ? N : 1];
+  TacsScalar *t = (N > 0 ? tn : new TacsScalar[bsize]);
+
+  for (int i = nrows - 1; i >= 0; i--) {
+    for (int m = 0; m < bsize; m++) {
+      t[m] = x[bsize * i + m];
+    }
+
+    int end = rowp[i + 1];
+    for (int k = diag[i] + 1; k < end; k++) {
+      BCSRBlockMultSubSingle<N>(bsize, &A[b2 * k], &y[bsize * cols[k]], t);
+    }
+
+    // Apply the inverse on the diagonal
+    BCSRBlockMultSingle<N>(bsize, &A[b2 * diag[i]], t, &y[bsize * i]);
+  }
+
+  if (N == 0) {
+    delete[] t;
+  }
+}
+
+/*
+  Apply the lower factorization x = L^{-1} x for the rows past the
+  variable offset
+*/
+template <int N>
+static void BCSRMatApplyPartialLowerSingleImpl(BCSRMatData *data,
+                                               TacsScalar *x, int var_offset) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const BCSRFactorScalar *A = data->Af;
+
+  int off = bsize * var_offset;
+
+  for (int i = var_offset + 1; i < nrows; i++) {
+    int bi = bsize * i - off;
+    int k = rowp[i];
+    while (cols[k] < var_offset) {
+      k++;
+    }
+
+    int end = diag[i];
+    for (; k < end; k++) {
+      int bj = bsize * cols[k] - off;
+      BCSRBlockMultSubSingle<N>(bsize, &A[b2 * k], &x[bj], &x[bi]);
+    }
+  }
+}
+
+/*
+  Apply the upper factorization x = U^{-1} x for the rows past the
+  variable offset
+*/
+template <int N>
+static void BCSRMatApplyPartialUpperSingleImpl(BCSRMatData *data,
+                                               TacsScalar *x, int var_offset) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const BCSRFactorScalar *A = data->Af;
+
+  TacsScalar tn[N > 0 ? N : 1];
+  TacsScalar *t = (N > 0 ? tn : new TacsScalar[bsize]);
+
+  int off = bsize * var_offset;
+
+  for (int i = nrows - 1; i >= var_offset; i--) {
+    int bi = bsize * i - off;
+    for (int m = 0; m < bsize; m++) {
+      t[m] = x[bi + m];
+    }
+
+    int end = rowp[i + 1];
+    for (int k = diag[i] + 1; k < end; k++) {
+      int bj = bsize * cols[k] - off;
+      BCSRBlockMultSubSingle<N>(bsize, &A[b2 * k], &x[bj], t);
+    }
+
+    // Apply the inverse on the diagonal
+    BCSRBlockMultSingle<N>(bsize, &A[b2 * diag[i]], t, &x[bi]);
+  }
+
+  if (N == 0) {
+    delete[] t;
+  }
+}
+
+/*
+  Compute x = U_b^{-1} ( x - (L_b^{-1} E) y ) for the approximate
+  Schur preconditioner. See BCSRMatApplyFactorSchur() for details.
+*/
+template <int N>
+static void BCSRMatApplyFactorSchurSingleImpl(BCSRMatData *data,
+                                              TacsScalar *x, int var_offset) {
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  const BCSRFactorScalar *A = data->Af;
+
+  TacsScalar tn[N > 0 ? N : 1];
+  TacsScalar *t = (N > 0 ? tn : new TacsScalar[bsize]);
+
+  for (int i = var_offset - 1; i >= 0; i--) {
+    int bi = bsize * i;
+    for (int m = 0; m < bsize; m++) {
+      t[m] = x[bi + m];
+    }
+
+    int end = rowp[i + 1];
+    for (int k = diag[i] + 1; k < end; k++) {
+      BCSRBlockMultSubSingle<N>(bsize, &A[b2 * k], &x[bsize * cols[k]], t);
+    }
+
+    // Apply the inverse on the diagonal
+    BCSRBlockMultSingle<N>(bsize, &A[b2 * diag[i]], t, &x[bi]);
+  }
+
+  if (N == 0) {
+    delete[] t;
+  }
+}
+
+/*
+  Select the implementation based on the block size of the matrix
+*/
+#define BCSR_MAT_SINGLE_DISPATCH(func, args) \
+  switch (data->bsize) {                     \
+    case 1:                                  \
+      func<1> args;                          \
+      break;                                 \
+    case 2:                                  \
+      func<2> args;                          \
+      break;                                 \
+    case 3:                                  \
+      func<3> args;                          \
+      break;                                 \
+    case 4:                                  \
+      func<4> args;                          \
+      break;                                 \
+    case 5:                                  \
+      func<5> args;                          \
+      break;                                 \
+    case 6:                                  \
+      func<6> args;                          \
+      break;                                 \
+    case 8:                                  \
+      func<8> args;                          \
+      break;                                 \
+    default:                                 \
+      func<0> args;                          \
+      break;                                 \
+  }
+
+void BCSRMatApplyLowerSingle(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  BCSR_MAT_SINGLE_DISPATCH(BCSRMatApplyLowerSingleImpl, (data, x, y));
+}
+
+void BCSRMatApplyUpperSingle(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  BCSR_MAT_SINGLE_DISPATCH(BCSRMatApplyUpperSingleImpl, (data, x, y));
+}
+
+void BCSRMatApplyPartialLowerSingle(BCSRMatData *data, TacsScalar *x,
+                                    int var_offset) {
+  BCSR_MAT_SINGLE_DISPATCH(BCSRMatApplyPartialLowerSingleImpl,
+                           (data, x, var_offset));
+}
+
+void BCSRMatApplyPartialUpperSingle(BCSRMatData *data, TacsScalar *x,
+                                    int var_offset) {
+  BCSR_MAT_SINGLE_DISPATCH(BCSRMatApplyPartialUpperSingleImpl,
+                           (data, x, var_offset));
+}
+
+void BCSRMatApplyFactorSchurSingle(BCSRMatData *data, TacsScalar *x,
+                                   int var_offset) {
+  BCSR_MAT_SINGLE_DISPATCH(BCSRMatApplyFactorSchurSingleImpl,
+                           (data, x, var_offset));
+}
+
+#ifdef TACS_USE_COMPLEX
+/*
+  Perform the ILU factorization of the real part of the matrix stored
+  in BCSRMatData::Af. This follows BCSRMatFactor() but all operations
+  are performed in real arithmetic.
+*/
+template <int N>
+static void BCSRMatFactorRealPartImpl(BCSRMatData *data) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const int bsize = (N > 0 ? N : data->bsize);
+  const int b2 = bsize * bsize;
+  double *A = data->Af;
+
+  double *D = new double[b2];
+  int *ipiv = new int[bsize];
+
+  for (int i = 0; i < nrows; i++) {
+    if (diag[i] < 0) {
+      fprintf(stderr, "Error in factorization: no diagonal entry for row %d\n",
+              i);
+      break;
+    }
+
+    // Scan from the first entry in the current row, towards the diagonal
+    int row_end = rowp[i + 1];
+
+    for (int j = rowp[i]; cols[j] < i; j++) {
+      int cj = cols[j];
+      double *a = &A[b2 * j];
+      const double *b = &A[b2 * diag[cj]];
+
+      // D = A[cj] * A[diag[cj]]
+      for (int n = 0; n < bsize; n++) {
+        for (int m = 0; m < bsize; m++) {
+          double t = 0.0;
+          for (int l = 0; l < bsize; l++) {
+            t += a[n * bsize + l] * b[l * bsize + m];
+          }
+          D[n * bsize + m] = t;
+        }
+      }
+
+      // Scan through row cj starting at the first entry past the diagonal
+      int k = j + 1;
+      int end = rowp[cj + 1];
+      for (int p = diag[cj] + 1; (p < end) && (k < row_end); p++) {
+        while (k < row_end && cols[k] < cols[p]) {
+          k++;
+        }
+
+        // A[k] = A[k] - A[j] * A[p]
+        if (k < row_end && cols[k] == cols[p]) {
+          a = &A[b2 * k];
+          b = &A[b2 * p];
+
+          for (int n = 0; n < bsize; n++) {
+            for (int m = 0; m < bsize; m++) {
+              double t = 0.0;
+              for (int l = 0; l < bsize; l++) {
+                t += D[n * bsize + l] * b[l * bsize + m];
+              }
+              a[n * bsize + m] -= t;
+            }
+          }
+        }
+      }
+
+      // Copy over the matrix
+      a = &A[b2 * j];
+      for (int n = 0; n < b2; n++) {
+        a[n] = D[n];
+      }
+    }
+
+    // Invert the diagonal block
+    double *a = &A[b2 * diag[i]];
+    for (int n = 0; n < b2; n++) {
+      D[n] = a[n];
+    }
+
+    int fail = BMatComputeInverse(a, D, ipiv, bsize);
+    if (fail != 0) {
+      fprintf(stderr, "Failure in factorization of row %d, block row %d\n", i,
+              fail);
+    }
+  }
+
+  delete[] D;
+  delete[] ipiv;
+}
+
+void BCSRMatFactorRealPart(BCSRMatData *data) {
+  BCSR_MAT_SINGLE_DISPATCH(BCSRMatFactorRealPartImpl, (data));
+}
+#endif  // TACS_USE_COMPLEX
@@ -0,0 +1,943 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_BCSR_MAT_TEMPLATE_H
+#define TACS_BCSR_MAT_TEMPLATE_H
+
+/*
+  Templated implementations of the block-specific operations.
+
+  These are instantiated in BCSRMat::initBlockImpl() for the block
+  sizes that do not have a hand-written implementation. The block size
+  N is a compile-time constant so that the loops over the block
+  entries can be fully unrolled and vectorized by the compiler. The
+  blocks are stored in row-major order, the same as in the
+  hand-written implementations.
+*/
+
+#include "BCSRMatImpl.h"
+
+/*
+  Operations on the individual N x N blocks
+*/
+
+// Compute y += A*x
+template <int N>
+inline void BCSRBlockMultAdd(const TacsScalar *a, const TacsScalar *x,
+                             TacsScalar *y) {
+  for (int m = 0; m < N; m++) {
+    TacsScalar t = 0.0;
+    for (int n = 0; n < N; n++) {
+      t += a[N * m + n] * x[n];
+    }
+    y[m] += t;
+  }
+}
+
+// Compute y -= A*x
+template <int N>
+inline void BCSRBlockMultSub(const TacsScalar *a, const TacsScalar *x,
+                             TacsScalar *y) {
+  for (int m = 0; m < N; m++) {
+    TacsScalar t = 0.0;
+    for (int n = 0; n < N; n++) {
+      t += a[N * m + n] * x[n];
+    }
+    y[m] -= t;
+  }
+}
+
+// Compute y += A^{T}*x
+template <int N>
+inline void BCSRBlockMultTransAdd(const TacsScalar *a, const TacsScalar *x,
+                                  TacsScalar *y) {
+  for (int m = 0; m < N; m++) {
+    for (int n = 0; n < N; n++) {
+      y[n] += a[N * m + n] * x[m];
+    }
+  }
+}
+
+// Compute C = A*B
+template <int N>
+inline void BCSRBlockMatMult(const TacsScalar *a, const TacsScalar *b,
+                             TacsScalar *c) {
+  for (int n = 0; n < N; n++) {
+    for (int m = 0; m < N; m++) {
+      c[N * n + m] = 0.0;
+    }
+    for (int l = 0; l < N; l++) {
+      const TacsScalar anl = a[N * n + l];
+      for (int m = 0; m < N; m++) {
+        c[N * n + m] += anl * b[N * l + m];
+      }
+    }
+  }
+}
+
+// Compute C += alpha*A*B
+template <int N>
+inline void BCSRBlockMatMultAdd(const TacsScalar alpha, const TacsScalar *a,
+                                const TacsScalar *b, TacsScalar *c) {
+  for (int n = 0; n < N; n++) {
+    for (int l = 0; l < N; l++) {
+      const TacsScalar anl = alpha * a[N * n + l];
+      for (int m = 0; m < N; m++) {
+        c[N * n + m] += anl * b[N * l + m];
+      }
+    }
+  }
+}
+
+/*!
+  Compute the matrix-vector product: y = A * x
+*/
+template <int N>
+void BCSRMatVecMult(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const TacsScalar *a = data->A;
+
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar t[N];
+    for (int m = 0; m < N; m++) {
+      t[m] = 0.0;
+    }
+
+    int end = rowp[i + 1];
+    for (int k = rowp[i]; k < end; k++) {
+      BCSRBlockMultAdd<N>(a, &x[N * cols[k]], t);
+      a += N * N;
+    }
+
+    for (int m = 0; m < N; m++) {
+      y[m] = t[m];
+    }
+    y += N;
+  }
+}
+
+/*!
+  Compute the matrix vector product plus addition: y = A * x + z
+*/
+template <int N>
+void BCSRMatVecMultAdd(BCSRMatData *data, TacsScalar *x, TacsScalar *y,
+                       TacsScalar *z) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const TacsScalar *a = data->A;
+
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar t[N];
+    for (int m = 0; m < N; m++) {
+      t[m] = z[m];
+    }
+
+    int end = rowp[i + 1];
+    for (int k = rowp[i]; k < end; k++) {
+      BCSRBlockMultAdd<N>(a, &x[N * cols[k]], t);
+      a += N * N;
+    }
+
+    for (int m = 0; m < N; m++) {
+      y[m] = t[m];
+    }
+    y += N;
+    z += N;
+  }
+}
+
+/*!
+  Compute the matrix-vector product: y += A^{T} * x
+*/
+template <int N>
+void BCSRMatVecMultTranspose(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const TacsScalar *a = data->A;
+
+  for (int i = 0; i < nrows; i++) {
+    int end = rowp[i + 1];
+    for (int k = rowp[i]; k < end; k++) {
+      BCSRBlockMultTransAdd<N>(a, x, &y[N * cols[k]]);
+      a += N * N;
+    }
+    x += N;
+  }
+}
+
+/*!
+  Threaded implementation of the matrix-vector product. The output
+  must be initialized before the threads are executed.
+*/
+template <int N>
+void *BCSRMatVecMultAdd_thread(void *t) {
+  BCSRMatThread *tdata = static_cast<BCSRMatThread *>(t);
+  const int nrows = tdata->mat->nrows;
+
+  // Get the input/output vectors
+  const TacsScalar *x = tdata->input;
+
+  const int *rowp = tdata->mat->rowp;
+  const int *cols = tdata->mat->cols;
+  const TacsScalar *A = tdata->mat->A;
+  const int group_size = tdata->mat->matvec_group_size;
+
+  while (tdata->num_completed_rows < nrows) {
+    int row = -1;
+    tdata->mat_mult_sched_job(group_size, &row);
+
+    if (row >= 0) {
+      TacsScalar *y = &tdata->output[N * row];
+      int k = rowp[row];
+      const TacsScalar *a = &A[N * N * k];
+      for (int ii = row; ii < nrows && (ii < row + group_size); ii++) {
+        int end = rowp[ii + 1];
+        for (; k < end; k++) {
+          BCSRBlockMultAdd<N>(a, &x[N * cols[k]], y);
+          a += N * N;
+        }
+        y += N;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  Apply the lower factorization y = L^{-1} x
+*/
+template <int N>
+void BCSRMatApplyLower(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar t[N];
+    for (int m = 0; m < N; m++) {
+      t[m] = x[N * i + m];
+    }
+
+    int end = diag[i];
+    int k = rowp[i];
+    const TacsScalar *a = &A[N * N * k];
+    for (; k < end; k++) {
+      BCSRBlockMultSub<N>(a, &y[N * cols[k]], t);
+      a += N * N;
+    }
+
+    for (int m = 0; m < N; m++) {
+      y[N * i + m] = t[m];
+    }
+  }
+}
+
+/*!
+  Apply the upper factorization y = U^{-1} x
+*/
+template <int N>
+void BCSRMatApplyUpper(BCSRMatData *data, TacsScalar *x, TacsScalar *y) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  for (int i = nrows - 1; i >= 0; i--) {
+    TacsScalar t[N];
+    for (int m = 0; m < N; m++) {
+      t[m] = x[N * i + m];
+    }
+
+    int end = rowp[i + 1];
+    int k = diag[i] + 1;
+    const TacsScalar *a = &A[N * N * k];
+    for (; k < end; k++) {
+      BCSRBlockMultSub<N>(a, &y[N * cols[k]], t);
+      a += N * N;
+    }
+
+    // Apply the inverse on the diagonal
+    const TacsScalar *adiag = &A[N * N * diag[i]];
+    for (int m = 0; m < N; m++) {
+      y[N * i + m] = 0.0;
+    }
+    BCSRBlockMultAdd<N>(adiag, t, &y[N * i]);
+  }
+}
+
+/*!
+  Apply the lower factorization x = L^{-1} x for the rows past the
+  variable offset
+*/
+template <int N>
+void BCSRMatApplyPartialLower(BCSRMatData *data, TacsScalar *x,
+                              int var_offset) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  int off = N * var_offset;
+
+  for (int i = var_offset + 1; i < nrows; i++) {
+    int bi = N * i - off;
+    int k = rowp[i];
+    while (cols[k] < var_offset) {
+      k++;
+    }
+
+    int end = diag[i];
+    for (; k < end; k++) {
+      int bj = N * cols[k] - off;
+      BCSRBlockMultSub<N>(&A[N * N * k], &x[bj], &x[bi]);
+    }
+  }
+}
+
+/*!
+  Apply the upper factorization x = U^{-1} x for the rows past the
+  variable offset
+*/
+template <int N>
+void BCSRMatApplyPartialUpper(BCSRMatData *data, TacsScalar *x,
+                              int var_offset) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  int off = N * var_offset;
+
+  for (int i = nrows - 1; i >= var_offset; i--) {
+    int bi = N * i - off;
+    TacsScalar t[N];
+    for (int m = 0; m < N; m++) {
+      t[m] = x[bi + m];
+    }
+
+    int end = rowp[i + 1];
+    for (int k = diag[i] + 1; k < end; k++) {
+      int bj = N * cols[k] - off;
+      BCSRBlockMultSub<N>(&A[N * N * k], &x[bj], t);
+    }
+
+    // Apply the inverse on the diagonal
+    for (int m = 0; m < N; m++) {
+      x[bi + m] = 0.0;
+    }
+    BCSRBlockMultAdd<N>(&A[N * N * diag[i]], t, &x[bi]);
+  }
+}
+
+/*!
+  Special function for the approximate Schur preconditioner.
+
+  Compute x = U_b^{-1} ( L_b^{-1} f - (L_b^{-1} E) y )
+
+  See BCSRMatApplyFactorSchur() for a description of the arguments.
+*/
+template <int N>
+void BCSRMatApplyFactorSchur(BCSRMatData *data, TacsScalar *x, int var_offset) {
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  // Compute x = U_b^{-1} ( x - (L_b^{-1} E) y )
+  for (int i = var_offset - 1; i >= 0; i--) {
+    int bi = N * i;
+    TacsScalar t[N];
+    for (int m = 0; m < N; m++) {
+      t[m] = x[bi + m];
+    }
+
+    int end = rowp[i + 1];
+    for (int k = diag[i] + 1; k < end; k++) {
+      BCSRBlockMultSub<N>(&A[N * N * k], &x[N * cols[k]], t);
+    }
+
+    // Apply the inverse on the diagonal
+    for (int m = 0; m < N; m++) {
+      x[bi + m] = 0.0;
+    }
+    BCSRBlockMultAdd<N>(&A[N * N * diag[i]], t, &x[bi]);
+  }
+}
+
+/*
+  Compute y -= A*x for a block with either a compile-time block size
+  N, or a runtime block size when N = 0
+*/
+template <int N>
+inline void BCSRBlockMultSubSize(const int bsize, const TacsScalar *a,
+                                 const TacsScalar *x, TacsScalar *y) {
+  if (N > 0) {
+    BCSRBlockMultSub<N>(a, x, y);
+  } else {
+    for (int m = 0; m < bsize; m++) {
+      TacsScalar t = 0.0;
+      for (int n = 0; n < bsize; n++) {
+        t += a[bsize * m + n] * x[n];
+      }
+      y[m] -= t;
+    }
+  }
+}
+
+/*!
+  Apply the lower factorization y = L^{-1} y using the level
+  scheduler. The input must be copied to the output before the call.
+  The value N = 0 is used for a runtime block size.
+*/
+template <int N>
+void *BCSRMatApplyLowerLevel_thread(void *t) {
+  BCSRMatThread *tdata = static_cast<BCSRMatThread *>(t);
+  const int *rowp = tdata->mat->rowp;
+  const int *cols = tdata->mat->cols;
+  const int *diag = tdata->mat->diag;
+  const TacsScalar *A = tdata->mat->A;
+  const int bsize = (N > 0 ? N : tdata->mat->bsize);
+  const int b2 = bsize * bsize;
+  const int group_size = tdata->mat->matvec_group_size;
+  const int *rows = tdata->lower_level_rows;
+
+  TacsScalar *y = tdata->output;
+
+  int start, end;
+  while (tdata->apply_level_sched_job(0, group_size, &start, &end)) {
+    for (int p = start; p < end; p++) {
+      const int i = rows[p];
+      TacsScalar *yi = &y[bsize * i];
+
+      int kend = diag[i];
+      for (int k = rowp[i]; k < kend; k++) {
+        BCSRBlockMultSubSize<N>(bsize, &A[b2 * k], &y[bsize * cols[k]], yi);
+      }
+    }
+
+    tdata->apply_level_mark_completed(start, end);
+  }
+
+  return NULL;
+}
+
+/*!
+  Apply the upper factorization y = U^{-1} y using the level
+  scheduler. The value N = 0 is used for a runtime block size.
+*/
+template <int N>
+void *BCSRMatApplyUpperLevel_thread(void *t) {
+  BCSRMatThread *tdata = static_cast<BCSRMatThread *>(t);
+  const int *rowp = tdata->mat->rowp;
+  const int *cols = tdata->mat->cols;
+  const int *diag = tdata->mat->diag;
+  const TacsScalar *A = tdata->mat->A;
+  const int bsize = (N > 0 ? N : tdata->mat->bsize);
+  const int b2 = bsize * bsize;
+  const int group_size = tdata->mat->matvec_group_size;
+  const int *rows = tdata->upper_level_rows;
+
+  TacsScalar *y = tdata->output;
+
+  TacsScalar tn[N > 0 ? N : 1];
+  TacsScalar *tv = (N > 0 ? tn : new TacsScalar[bsize]);
+
+  int start, end;
+  while (tdata->apply_level_sched_job(1, group_size, &start, &end)) {
+    for (int p = start; p < end; p++) {
+      const int i = rows[p];
+      TacsScalar *yi = &y[bsize * i];
+      for (int m = 0; m < bsize; m++) {
+        tv[m] = yi[m];
+      }
+
+      int kend = rowp[i + 1];
+      for (int k = diag[i] + 1; k < kend; k++) {
+        BCSRBlockMultSubSize<N>(bsize, &A[b2 * k], &y[bsize * cols[k]], tv);
+      }
+
+      // Apply the inverse on the diagonal
+      for (int m = 0; m < bsize; m++) {
+        yi[m] = 0.0;
+      }
+      const TacsScalar *adiag = &A[b2 * diag[i]];
+      if (N > 0) {
+        BCSRBlockMultAdd<N>(adiag, tv, yi);
+      } else {
+        for (int m = 0; m < bsize; m++) {
+          for (int n = 0; n < bsize; n++) {
+            yi[m] += adiag[bsize * m + n] * tv[n];
+          }
+        }
+      }
+    }
+
+    tdata->apply_level_mark_completed(start, end);
+  }
+
+  if (N == 0) {
+    delete[] tv;
+  }
+
+  return NULL;
+}
+
+/*!
+  Apply a step of SOR to the system A*x = b for a single row
+*/
+template <int N>
+inline void BCSRMatApplySORRow(BCSRMatData *Adata, BCSRMatData *Bdata,
+                               const int i, const int var_offset,
+                               const TacsScalar *Adiag, const TacsScalar omega,
+                               const TacsScalar *b, const TacsScalar *xext,
+                               TacsScalar *x) {
+  const int *Arowp = Adata->rowp;
+  const int *Acols = Adata->cols;
+
+  // Copy the right-hand-side to the temporary vector for this row
+  TacsScalar t[N];
+  for (int m = 0; m < N; m++) {
+    t[m] = b[N * i + m];
+  }
+
+  // Scan through the row and compute the result:
+  // tx <- b_i - A_{ij}*x_{j} for j != i
+  const TacsScalar *a = &Adata->A[N * N * Arowp[i]];
+  int end = Arowp[i + 1];
+  for (int k = Arowp[i]; k < end; k++) {
+    int j = Acols[k];
+    if (i != j) {
+      BCSRBlockMultSub<N>(a, &x[N * j], t);
+    }
+    a += N * N;
+  }
+
+  if (Bdata && i >= var_offset) {
+    const int row = i - var_offset;
+    const int *Browp = Bdata->rowp;
+    const int *Bcols = Bdata->cols;
+
+    a = &Bdata->A[N * N * Browp[row]];
+    end = Browp[row + 1];
+    for (int k = Browp[row]; k < end; k++) {
+      BCSRBlockMultSub<N>(a, &xext[N * Bcols[k]], t);
+      a += N * N;
+    }
+  }
+
+  // Compute the update: x[i] = (1.0 - omega)*x[i] + omega*D^{-1}tx
+  TacsScalar d[N];
+  for (int m = 0; m < N; m++) {
+    d[m] = 0.0;
+  }
+  BCSRBlockMultAdd<N>(&Adiag[N * N * i], t, d);
+  for (int m = 0; m < N; m++) {
+    x[N * i + m] = (1.0 - omega) * x[N * i + m] + omega * d[m];
+  }
+}
+
+/*!
+  Apply a given number of steps of SOR to the system A*x = b.
+
+  When start < end, the rows are processed in the forward order,
+  otherwise the rows from start-1 down to end are processed in reverse
+  order.
+*/
+template <int N>
+void BCSRMatApplySOR(BCSRMatData *Adata, BCSRMatData *Bdata, const int start,
+                     const int end, const int var_offset,
+                     const TacsScalar *Adiag, const TacsScalar omega,
+                     const TacsScalar *b, const TacsScalar *xext,
+                     TacsScalar *x) {
+  if (start < end) {
+    for (int i = start; i < end; i++) {
+      BCSRMatApplySORRow<N>(Adata, Bdata, i, var_offset, Adiag, omega, b, xext,
+                            x);
+    }
+  } else {
+    for (int i = start - 1; i >= end; i--) {
+      BCSRMatApplySORRow<N>(Adata, Bdata, i, var_offset, Adiag, omega, b, xext,
+                            x);
+    }
+  }
+}
+
+/*!
+  Perform a matrix-matrix multiplication for a single row of C
+*/
+template <int N>
+inline void BCSRMatMatMultAddRow(const int i, double alpha,
+                                 BCSRMatData *Adata, BCSRMatData *Bdata,
+                                 BCSRMatData *Cdata) {
+  const int *arowp = Adata->rowp;
+  const int *acols = Adata->cols;
+  const TacsScalar *A = Adata->A;
+
+  const int *browp = Bdata->rowp;
+  const int *bcols = Bdata->cols;
+  const TacsScalar *B = Bdata->A;
+
+  const int *crowp = Cdata->rowp;
+  const int *ccols = Cdata->cols;
+  TacsScalar *C = Cdata->A;
+
+  // C_{ik} = A_{ij} B_{jk}
+  for (int jp = arowp[i]; jp < arowp[i + 1]; jp++) {
+    int j = acols[jp];
+    const TacsScalar *a = &A[N * N * jp];
+
+    int kp = browp[j];
+    int kp_end = browp[j + 1];
+
+    int cp = crowp[i];
+    int cp_end = crowp[i + 1];
+
+    for (; kp < kp_end; kp++) {
+      while ((cp < cp_end) && (ccols[cp] < bcols[kp])) {
+        cp++;
+      }
+      if (cp >= cp_end) {
+        break;
+      }
+
+      if (bcols[kp] == ccols[cp]) {
+        BCSRBlockMatMultAdd<N>(alpha, a, &B[N * N * kp], &C[N * N * cp]);
+      }
+    }
+  }
+}
+
+/*!
+  Perform a matrix-matrix multiplication: C += alpha*A*B
+*/
+template <int N>
+void BCSRMatMatMultAdd(double alpha, BCSRMatData *Adata, BCSRMatData *Bdata,
+                       BCSRMatData *Cdata) {
+  const int nrows_a = Adata->nrows;
+  for (int i = 0; i < nrows_a; i++) {
+    BCSRMatMatMultAddRow<N>(i, alpha, Adata, Bdata, Cdata);
+  }
+}
+
+/*!
+  Threaded implementation of the matrix-matrix multiplication
+*/
+template <int N>
+void *BCSRMatMatMultAdd_thread(void *t) {
+  BCSRMatThread *tdata = static_cast<BCSRMatThread *>(t);
+  const double alpha = tdata->alpha;
+  const int nrows_a = tdata->Amat->nrows;
+  const int nrows_c = tdata->mat->nrows;
+  const int group_size = tdata->mat->matmat_group_size;
+
+  while (tdata->num_completed_rows < nrows_c) {
+    int row = -1;
+    tdata->mat_mult_sched_job(group_size, &row);
+
+    if (row < 0) {
+      break;
+    }
+
+    for (int i = row; (i < nrows_a) && (i < row + group_size); i++) {
+      BCSRMatMatMultAddRow<N>(i, alpha, tdata->Amat, tdata->Bmat, tdata->mat);
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  Compute the scaled normal equations: A = B^{T}*s*B
+*/
+template <int N>
+void BCSRMatMatMultNormal(BCSRMatData *Adata, TacsScalar *scale,
+                          BCSRMatData *Bdata) {
+  const int nrows_a = Adata->nrows;
+  const int *arowp = Adata->rowp;
+  const int *acols = Adata->cols;
+  TacsScalar *A = Adata->A;
+
+  const int nrows_b = Bdata->nrows;
+  const int *browp = Bdata->rowp;
+  const int *bcols = Bdata->cols;
+  const TacsScalar *B = Bdata->A;
+
+  int *kptr = new int[nrows_b];
+  memcpy(kptr, browp, nrows_b * sizeof(int));
+
+  // A_{ij} = B_{ki}*s{k}*B_{kj}
+  for (int i = 0; i < nrows_a; i++) {
+    // Scan through column i of the matrix B_{*i}
+    for (int k = 0; k < nrows_b; k++) {
+      if ((kptr[k] < browp[k + 1]) && (bcols[kptr[k]] == i)) {
+        const TacsScalar *bi = &B[N * N * kptr[k]];
+        kptr[k]++;
+
+        int jpa = arowp[i];
+        int jpa_end = arowp[i + 1];
+
+        int jpb = browp[k];
+        int jpb_end = browp[k + 1];
+
+        // Locate j such that (k,j) in nz(B_{kj}) and (i,j) in nz(A_{ij})
+        for (; jpa < jpa_end; jpa++) {
+          while ((jpb < jpb_end) && (bcols[jpb] < acols[jpa])) {
+            jpb++;
+          }
+          if (jpb >= jpb_end) {
+            break;
+          }
+
+          if (acols[jpa] == bcols[jpb]) {
+            const TacsScalar *bj = &B[N * N * jpb];
+            const TacsScalar *s = &scale[N * k];
+            TacsScalar *a = &A[N * N * jpa];
+
+            // a_{nm} += s_{l}*b_{ln}*b_{lm}
+            for (int n = 0; n < N; n++) {
+              for (int l = 0; l < N; l++) {
+                const TacsScalar sb = s[l] * bi[N * l + n];
+                for (int m = 0; m < N; m++) {
+                  a[N * n + m] += sb * bj[N * l + m];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  delete[] kptr;
+}
+
+/*!
+  Factor the row i of the matrix in place. All the rows that are
+  referenced to the left of the diagonal must already be factored.
+  Returns a non-zero value on failure.
+*/
+template <int N>
+inline int BCSRMatFactorRow(const int i, BCSRMatData *data) {
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  TacsScalar *A = data->A;
+
+  TacsScalar D[N * N];
+  int ipiv[N];
+
+  if (diag[i] < 0) {
+    fprintf(stderr, "Error in factorization: no diagonal entry for row %d\n",
+            i);
+    return 1;
+  }
+
+  // Scan from the first entry in the current row, towards the diagonal
+  int row_end = rowp[i + 1];
+
+  for (int j = rowp[i]; cols[j] < i; j++) {
+    int cj = cols[j];
+
+    // D = A[j] * A[diag[cj]]
+    BCSRBlockMatMult<N>(&A[N * N * j], &A[N * N * diag[cj]], D);
+
+    // Scan through the remainder of the row
+    int k = j + 1;
+    int end = rowp[cj + 1];
+
+    // Scan through row cj starting at the first entry past the diagonal
+    for (int p = diag[cj] + 1; (p < end) && (k < row_end); p++) {
+      // Determine where the two rows have the same elements
+      while (k < row_end && cols[k] < cols[p]) {
+        k++;
+      }
+
+      // A[k] = A[k] - D * A[p]
+      if (k < row_end && cols[k] == cols[p]) {
+        BCSRBlockMatMultAdd<N>(-1.0, D, &A[N * N * p], &A[N * N * k]);
+      }
+    }
+
+    // Copy over the matrix
+    TacsScalar *a = &A[N * N * j];
+    for (int n = 0; n < N * N; n++) {
+      a[n] = D[n];
+    }
+  }
+
+  // Invert the diagonal block
+  TacsScalar *a = &A[N * N * diag[i]];
+  for (int n = 0; n < N * N; n++) {
+    D[n] = a[n];
+  }
+
+  int fail = BMatComputeInverse(a, D, ipiv, N);
+  if (fail != 0) {
+    fprintf(stderr, "Failure in factorization of row %d, block row %d\n", i,
+            fail);
+  }
+
+  return 0;
+}
+
+/*!
+  Perform an ILU factorization of the matrix using the existing
+  non-zero pattern. The entries are over-written and all operations
+  are performed in place.
+*/
+template <int N>
+void BCSRMatFactor(BCSRMatData *data) {
+  const int nrows = data->nrows;
+  for (int i = 0; i < nrows; i++) {
+    if (BCSRMatFactorRow<N>(i, data)) {
+      return;
+    }
+  }
+}
+
+/*!
+  Threaded ILU factorization using the level scheduler. The rows
+  within each level of the lower triangular part are independent and
+  are factored concurrently. The levels are computed from the non-zero
+  pattern once and re-used for each subsequent factorization.
+*/
+template <int N>
+void *BCSRMatFactorLevel_thread(void *t) {
+  BCSRMatThread *tdata = static_cast<BCSRMatThread *>(t);
+  const int group_size = tdata->mat->matmat_group_size;
+  const int *rows = tdata->lower_level_rows;
+
+  int start, end;
+  while (tdata->apply_level_sched_job(0, group_size, &start, &end)) {
+    for (int p = start; p < end; p++) {
+      BCSRMatFactorRow<N>(rows[p], tdata->mat);
+    }
+
+    tdata->apply_level_mark_completed(start, end);
+  }
+
+  return NULL;
+}
+
+/*!
+  Compute E = L_{B}^{-1} E
+*/
+template <int N>
+void BCSRMatFactorLower(BCSRMatData *data, BCSRMatData *Edata) {
+  const int nrows = data->nrows;
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  const int *erowp = Edata->rowp;
+  const int *ecols = Edata->cols;
+  TacsScalar *E = Edata->A;
+
+  for (int i = 0; i < nrows; i++) {
+    // Scan from the first entry in the current row, towards the diagonal
+    int j_end = diag[i];
+
+    for (int j = rowp[i]; j < j_end; j++) {
+      int cj = cols[j];
+      const TacsScalar *d = &A[N * N * j];
+
+      int k = erowp[i];
+      int k_end = erowp[i + 1];
+
+      int p = erowp[cj];
+      int p_end = erowp[cj + 1];
+
+      for (; (p < p_end) && (k < k_end); p++) {
+        // Determine where the two rows have the same elements
+        while (k < k_end && ecols[k] < ecols[p]) {
+          k++;
+        }
+
+        if (k < k_end && ecols[k] == ecols[p]) {
+          BCSRBlockMatMultAdd<N>(-1.0, d, &E[N * N * p], &E[N * N * k]);
+        }
+      }
+    }
+  }
+}
+
+/*!
+  Compute F = F U_{B}^{-1}
+*/
+template <int N>
+void BCSRMatFactorUpper(BCSRMatData *data, BCSRMatData *Fdata) {
+  const int *rowp = data->rowp;
+  const int *cols = data->cols;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  const int nrows_f = Fdata->nrows;
+  const int *frowp = Fdata->rowp;
+  const int *fcols = Fdata->cols;
+  TacsScalar *F = Fdata->A;
+
+  TacsScalar D[N * N];
+
+  for (int i = 0; i < nrows_f; i++) {
+    int j_end = frowp[i + 1];
+
+    for (int j = frowp[i]; j < j_end; j++) {
+      int cj = fcols[j];
+
+      // D = F[j] * A[diag[cj]]
+      BCSRBlockMatMult<N>(&F[N * N * j], &A[N * N * diag[cj]], D);
+
+      int k = j + 1;
+      int k_end = frowp[i + 1];
+
+      int p = diag[cj] + 1;
+      int p_end = rowp[cj + 1];
+
+      // Scan through row cj starting at the first entry past the diagonal
+      for (; (p < p_end) && (k < k_end); p++) {
+        // Determine where the two rows have the same elements
+        while (k < k_end && fcols[k] < cols[p]) {
+          k++;
+        }
+
+        if (k < k_end && fcols[k] == cols[p]) {
+          BCSRBlockMatMultAdd<N>(-1.0, D, &A[N * N * p], &F[N * N * k]);
+        }
+      }
+
+      // Copy over the matrix
+      TacsScalar *a = &F[N * N * j];
+      for (int n = 0; n < N * N; n++) {
+        a[n] = D[n];
+      }
+    }
+  }
+}
+
+#endif  // TACS_BCSR_MAT_TEMPLATE_H
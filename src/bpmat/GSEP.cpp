@@ -18,6 +18,7 @@
 
 #include "GSEP.h"
 
+#include "TACSBVec.h"
 #include "tacslapack.h"
 
 /*
@@ -98,6 +99,10 @@ void EPShiftInvert::mult(TACSVec *x, TACSVec *y) {
   return;
 }
 
+void EPShiftInvert::multMulti(int nvecs, TACSVec **x, TACSVec **y) {
+  ksm->solveMulti(nvecs, x, y);
+}
+
 // The eigenvalues are computed as mu = 1.0/( eig - sigma )
 // eig = 1.0/mu + sigma
 TacsScalar EPShiftInvert::convertEigenvalue(TacsScalar value) {
@@ -133,12 +138,20 @@ EPGeneralizedShiftInvert::EPGeneralizedShiftInvert(TacsScalar _sigma,
   inner->incref();
   temp = inner->createVec();
   temp->incref();
+  num_temps = 0;
+  temps = NULL;
 }
 
 EPGeneralizedShiftInvert::~EPGeneralizedShiftInvert() {
   ksm->decref();
   inner->decref();
   temp->decref();
+  for (int i = 0; i < num_temps; i++) {
+    temps[i]->decref();
+  }
+  if (temps) {
+    delete[] temps;
+  }
 }
 
 /*
@@ -160,6 +173,31 @@ void EPGeneralizedShiftInvert::mult(TACSVec *x, TACSVec *y) {
   return;
 }
 
+/*
+  Compute y[i] = ( A - sigma B )^{-1}*inner x[i] for a block of vectors
+*/
+void EPGeneralizedShiftInvert::multMulti(int nvecs, TACSVec **x, TACSVec **y) {
+  if (nvecs > num_temps) {
+    TACSVec **t = new TACSVec *[nvecs];
+    for (int i = 0; i < nvecs; i++) {
+      if (i < num_temps) {
+        t[i] = temps[i];
+      } else {
+        t[i] = inner->createVec();
+        t[i]->incref();
+      }
+    }
+    if (temps) {
+      delete[] temps;
+    }
+    temps = t;
+    num_temps = nvecs;
+  }
+
+  inner->multMulti(nvecs, x, temps);
+  ksm->solveMulti(nvecs, temps, y);
+}
+
 /*
   Compute <x,y> = x^{T} inner y
 */
@@ -208,12 +246,20 @@ EPBucklingShiftInvert::EPBucklingShiftInvert(TacsScalar _sigma, TACSKsm *_ksm,
   inner->incref();
   temp = inner->createVec();
   temp->incref();
+  num_temps = 0;
+  temps = NULL;
 }
 
 EPBucklingShiftInvert::~EPBucklingShiftInvert() {
   ksm->decref();
   inner->decref();
   temp->decref();
+  for (int i = 0; i < num_temps; i++) {
+    temps[i]->decref();
+  }
+  if (temps) {
+    delete[] temps;
+  }
 }
 
 void EPBucklingShiftInvert::setSigma(TacsScalar _sigma) { sigma = _sigma; }
@@ -227,6 +273,31 @@ void EPBucklingShiftInvert::mult(TACSVec *x, TACSVec *y) {
   return;
 }
 
+/*
+  Compute y[i] = ( A - sigma B )^{-1}*inner x[i] for a block of vectors
+*/
+void EPBucklingShiftInvert::multMulti(int nvecs, TACSVec **x, TACSVec **y) {
+  if (nvecs > num_temps) {
+    TACSVec **t = new TACSVec *[nvecs];
+    for (int i = 0; i < nvecs; i++) {
+      if (i < num_temps) {
+        t[i] = temps[i];
+      } else {
+        t[i] = inner->createVec();
+        t[i]->incref();
+      }
+    }
+    if (temps) {
+      delete[] temps;
+    }
+    temps = t;
+    num_temps = nvecs;
+  }
+
+  inner->multMulti(nvecs, x, temps);
+  ksm->solveMulti(nvecs, temps, y);
+}
+
 // Compute <x,y> = x^{T} inner y
 TacsScalar EPBucklingShiftInvert::dot(TACSVec *x, TACSVec *y) {
   inner->mult(y, temp);
@@ -369,6 +440,202 @@ static void ComputeEigsTriDiag(int n, TacsScalar *_diag, TacsScalar *_upper,
   delete[] upper;
 }
 
+/*
+  Compute the eigenvalues and eigenvectors of a dense symmetric matrix
+  stored in the upper triangular part of the column-major array H.
+
+  input:
+  n:        the order of the matrix
+  H:        the matrix entries
+  ldh:      the leading dimension of H
+
+  output:
+  eigs:     the eigenvalues in ascending order
+  eigvecs:  the eigenvectors such that eigvecs[n*i + j] is the j-th
+            component of the i-th eigenvector
+*/
+static void ComputeEigsSymmetric(int n, const TacsScalar *H, int ldh,
+                                 TacsScalar *_eigs, TacsScalar *_eigvecs) {
+  // Copy the real part of the matrix since LAPACK over-writes it
+  double *A = new double[n * n];
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i <= j; i++) {
+      A[i + n * j] = TacsRealPart(H[i + ldh * j]);
+    }
+  }
+
+  double *eigs = new double[n];
+  int lwork = 1 + 6 * n + 2 * n * n;
+  double *work = new double[lwork];
+  int liwork = 3 + 5 * n;
+  int *iwork = new int[liwork];
+  int info = 0;
+  LAPACKsyevd("V", "U", &n, A, &n, eigs, work, &lwork, iwork, &liwork, &info);
+
+  if (info != 0) {
+    fprintf(stderr, "Error encountered in LAPACK function dsyevd\n");
+  }
+
+  for (int i = 0; i < n; i++) {
+#ifdef TACS_USE_COMPLEX
+    // Treat the imaginary part of H as a perturbation, as in
+    // ComputeEigsTriDiag(), so that the complex step can be applied
+    double sens = 0.0;
+    for (int j = 0; j < n; j++) {
+      double ans = 0.0;
+      for (int k = 0; k < n; k++) {
+        if (j <= k) {
+          ans += TacsImagPart(H[j + ldh * k]) * A[k + n * i];
+        } else {
+          ans += TacsImagPart(H[k + ldh * j]) * A[k + n * i];
+        }
+      }
+      sens += ans * A[j + n * i];
+    }
+    _eigs[i] = TacsScalar(eigs[i], sens);
+#else
+    _eigs[i] = eigs[i];
+#endif  // TACS_USE_COMPLEX
+  }
+  for (int i = 0; i < n * n; i++) {
+    _eigvecs[i] = A[i];
+  }
+
+  delete[] A;
+  delete[] eigs;
+  delete[] work;
+  delete[] iwork;
+}
+
+/*
+  Retrieve the local arrays of a set of vectors. This returns 0 unless
+  all the vectors are TACSBVec objects of the same size.
+*/
+static int GetLocalArrays(int nvecs, TACSVec **vecs, TacsScalar **arrays,
+                          int *size, MPI_Comm *comm) {
+  *size = -1;
+  for (int i = 0; i < nvecs; i++) {
+    TACSBVec *vec = dynamic_cast<TACSBVec *>(vecs[i]);
+    if (!vec) {
+      return 0;
+    }
+    int s = vec->getArray(&arrays[i]);
+    if (*size >= 0 && s != *size) {
+      return 0;
+    }
+    *size = s;
+    *comm = vec->getMPIComm();
+  }
+  return 1;
+}
+
+// The number of rows in each panel for the level-3 BLAS block operations
+static const int TACS_SEP_PANEL_SIZE = 256;
+
+/*
+  Compute the block of inner products C = V^{T} W, where C is stored
+  in column-major order with leading dimension nv.
+
+  When the vectors are TACSBVec objects, the local contributions are
+  computed with level-3 BLAS on panels of rows copied out of the
+  vectors and all nv*nw entries are summed with a single reduction.
+  Otherwise, one multiple dot product is used for each vector in W.
+*/
+static void BlockDot(int nv, TACSVec **V, int nw, TACSVec **W, TacsScalar *C) {
+  if (nv == 0 || nw == 0) {
+    return;
+  }
+
+  TacsScalar **arrays = new TacsScalar *[nv + nw];
+  int vsize = 0, wsize = 0;
+  MPI_Comm comm = MPI_COMM_NULL;
+  if (GetLocalArrays(nv, V, arrays, &vsize, &comm) &&
+      GetLocalArrays(nw, W, &arrays[nv], &wsize, &comm) && vsize == wsize) {
+    memset(C, 0, nv * nw * sizeof(TacsScalar));
+
+    int psize = TACS_SEP_PANEL_SIZE;
+    TacsScalar *Vp = new TacsScalar[psize * nv];
+    TacsScalar *Wp = new TacsScalar[psize * nw];
+    for (int start = 0; start < vsize; start += psize) {
+      int nr = vsize - start;
+      if (nr > psize) {
+        nr = psize;
+      }
+      for (int i = 0; i < nv; i++) {
+        memcpy(&Vp[nr * i], &arrays[i][start], nr * sizeof(TacsScalar));
+      }
+      for (int j = 0; j < nw; j++) {
+        memcpy(&Wp[nr * j], &arrays[nv + j][start], nr * sizeof(TacsScalar));
+      }
+
+      TacsScalar alpha = 1.0, beta = 1.0;
+      BLASgemm("T", "N", &nv, &nw, &nr, &alpha, Vp, &nr, Wp, &nr, &beta, C,
+               &nv);
+    }
+    delete[] Vp;
+    delete[] Wp;
+
+    MPI_Allreduce(MPI_IN_PLACE, C, nv * nw, TACS_MPI_TYPE, MPI_SUM, comm);
+  } else {
+    for (int j = 0; j < nw; j++) {
+      W[j]->mdot(V, &C[nv * j], nv);
+    }
+  }
+
+  delete[] arrays;
+}
+
+/*
+  Compute the block update W <- W + alpha*V*C, where C is stored in
+  column-major order with leading dimension ldc.
+*/
+static void BlockAxpy(int nv, TACSVec **V, int nw, TACSVec **W,
+                      TacsScalar alpha, TacsScalar *C, int ldc) {
+  if (nv == 0 || nw == 0) {
+    return;
+  }
+
+  TacsScalar **arrays = new TacsScalar *[nv + nw];
+  int vsize = 0, wsize = 0;
+  MPI_Comm comm = MPI_COMM_NULL;
+  if (GetLocalArrays(nv, V, arrays, &vsize, &comm) &&
+      GetLocalArrays(nw, W, &arrays[nv], &wsize, &comm) && vsize == wsize) {
+    int psize = TACS_SEP_PANEL_SIZE;
+    TacsScalar *Vp = new TacsScalar[psize * nv];
+    TacsScalar *Wp = new TacsScalar[psize * nw];
+    for (int start = 0; start < vsize; start += psize) {
+      int nr = vsize - start;
+      if (nr > psize) {
+        nr = psize;
+      }
+      for (int i = 0; i < nv; i++) {
+        memcpy(&Vp[nr * i], &arrays[i][start], nr * sizeof(TacsScalar));
+      }
+      for (int j = 0; j < nw; j++) {
+        memcpy(&Wp[nr * j], &arrays[nv + j][start], nr * sizeof(TacsScalar));
+      }
+
+      TacsScalar beta = 1.0;
+      BLASgemm("N", "N", &nr, &nw, &nv, &alpha, Vp, &nr, C, &ldc, &beta, Wp,
+               &nr);
+
+      for (int j = 0; j < nw; j++) {
+        memcpy(&arrays[nv + j][start], &Wp[nr * j], nr * sizeof(TacsScalar));
+      }
+    }
+    delete[] Vp;
+    delete[] Wp;
+  } else {
+    for (int j = 0; j < nw; j++) {
+      for (int i = 0; i < nv; i++) {
+        W[j]->axpy(alpha * C[i + ldc * j], V[i]);
+      }
+    }
+  }
+
+  delete[] arrays;
+}
+
 /*
   Create the symmetric eigenvalue problem solver
 
@@ -420,10 +687,23 @@ SEP::SEP(EPOperator *_Op, int _max_iters, OrthoType _ortho_type,
   niters = -1;
 
   // Create the vectors required for the Lanczos subspace
-  for (int i = 0; i < max_iters + 1; i++) {
+  num_vecs = max_iters + 1;
+  for (int i = 0; i < num_vecs; i++) {
     Q[i] = Op->createVec();
     Q[i]->incref();
+    Q[i]->setMemoryCategory(TACS_MEMORY_EIGENSOLVER);
   }
+
+  // By default, use the single-vector Lanczos method
+  block_size = 0;
+  max_restarts = 0;
+  num_work = 0;
+  Qwork = NULL;
+  eig_errors = new TacsScalar[max_iters];
+
+  // By default, the starting vectors are random
+  num_init_vecs = 0;
+  init_vecs = NULL;
 }
 
 /*
@@ -431,10 +711,23 @@ SEP::SEP(EPOperator *_Op, int _max_iters, OrthoType _ortho_type,
 */
 SEP::~SEP() {
   Op->decref();
-  for (int i = 0; i < max_iters + 1; i++) {
+  for (int i = 0; i < num_vecs; i++) {
     Q[i]->decref();
   }
   delete[] Q;
+  for (int i = 0; i < num_work; i++) {
+    Qwork[i]->decref();
+  }
+  if (Qwork) {
+    delete[] Qwork;
+  }
+
+  for (int i = 0; i < num_init_vecs; i++) {
+    init_vecs[i]->decref();
+  }
+  if (init_vecs) {
+    delete[] init_vecs;
+  }
 
   if (bcs) {
     bcs->decref();
@@ -445,6 +738,7 @@ SEP::~SEP() {
   delete[] eigs;
   delete[] eigvecs;
   delete[] perm;
+  delete[] eig_errors;
 }
 
 /*
@@ -452,6 +746,74 @@ SEP::~SEP() {
 */
 void SEP::setOrthoType(enum OrthoType _ortho_type) { ortho_type = _ortho_type; }
 
+/*
+  Use the thick-restart block Lanczos method with the given block size.
+  A block size of zero restores the single-vector Lanczos method.
+
+  The basis contains at most max_iters vectors, which must be at least
+  three times the block size. At most max_iters - 2*block_size
+  eigenvalues can be computed.
+
+  input:
+  block_size:    the number of vectors in each block
+  max_restarts:  the maximum number of restarts
+*/
+void SEP::setBlockLanczos(int _block_size, int _max_restarts) {
+  if (_block_size > 0 && max_iters < 3 * _block_size) {
+    fprintf(stderr,
+            "SEP: Basis size %d too small for block size %d, "
+            "using single-vector Lanczos\n",
+            max_iters, _block_size);
+    _block_size = 0;
+  }
+
+  block_size = (_block_size > 0 ? _block_size : 0);
+  max_restarts = (_max_restarts > 0 ? _max_restarts : 0);
+  niters = -1;
+
+  if (block_size > 0) {
+    // Allocate space for the basis and the next block
+    if (max_iters + block_size > num_vecs) {
+      TACSVec **Qnew = new TACSVec *[max_iters + block_size];
+      for (int i = 0; i < max_iters + block_size; i++) {
+        if (i < num_vecs) {
+          Qnew[i] = Q[i];
+        } else {
+          Qnew[i] = Op->createVec();
+          Qnew[i]->incref();
+          Qnew[i]->setMemoryCategory(TACS_MEMORY_EIGENSOLVER);
+        }
+      }
+      delete[] Q;
+      Q = Qnew;
+      num_vecs = max_iters + block_size;
+    }
+
+    // Allocate the vectors used to form the Ritz vectors on restart
+    int nwork = max_iters - 2 * block_size;
+    if (nwork < block_size) {
+      nwork = block_size;
+    }
+    if (nwork > num_work) {
+      TACSVec **Qnew = new TACSVec *[nwork];
+      for (int i = 0; i < nwork; i++) {
+        if (i < num_work) {
+          Qnew[i] = Qwork[i];
+        } else {
+          Qnew[i] = Op->createVec();
+          Qnew[i]->incref();
+          Qnew[i]->setMemoryCategory(TACS_MEMORY_EIGENSOLVER);
+        }
+      }
+      if (Qwork) {
+        delete[] Qwork;
+      }
+      Qwork = Qnew;
+      num_work = nwork;
+    }
+  }
+}
+
 /*
   Set the tolerances to use, the desired spectrum, and the number of
   eigenvalues that are requested in the solve
@@ -474,6 +836,72 @@ void SEP::setOperator(EPOperator *_Op) {
   Op = _Op;
 }
 
+/*
+  Set the vectors used to seed the starting vectors of the next
+  solve. The vectors are not copied, so their values at the time of
+  the solve are used. This is typically used to warm-start the solver
+  with the eigenvectors from a previous design.
+
+  input:
+  nvecs:  the number of seed vectors
+  vecs:   the seed vectors
+*/
+void SEP::setInitialVectors(int nvecs, TACSVec **vecs) {
+  for (int i = 0; i < nvecs; i++) {
+    vecs[i]->incref();
+  }
+  for (int i = 0; i < num_init_vecs; i++) {
+    init_vecs[i]->decref();
+  }
+  if (init_vecs) {
+    delete[] init_vecs;
+  }
+
+  num_init_vecs = (nvecs > 0 ? nvecs : 0);
+  init_vecs = NULL;
+  if (num_init_vecs > 0) {
+    init_vecs = new TACSVec *[num_init_vecs];
+    for (int i = 0; i < num_init_vecs; i++) {
+      init_vecs[i] = vecs[i];
+    }
+  }
+}
+
+/*
+  Form the nv starting vectors. Without seed vectors, the starting
+  vectors are random. Otherwise, the seed vectors are normalized and
+  the i-th seed vector is added to the starting vector i % nv. A small
+  random component is retained so that the subspace is not exactly
+  invariant when the seed vectors are eigenvectors.
+*/
+void SEP::initStartVectors(int nv, TACSVec **V) {
+  for (int j = 0; j < nv; j++) {
+    V[j]->setRand();
+    if (bcs) {
+      V[j]->applyBCs(bcs);
+    }
+  }
+
+  if (num_init_vecs > 0) {
+    const double random_scale = 1e-3;
+    for (int j = 0; j < nv; j++) {
+      TacsScalar norm = sqrt(Op->dot(V[j], V[j]));
+      V[j]->scale(random_scale / norm);
+    }
+    for (int i = 0; i < num_init_vecs; i++) {
+      TacsScalar norm = sqrt(Op->dot(init_vecs[i], init_vecs[i]));
+      if (TacsRealPart(norm) > 0.0) {
+        V[i % nv]->axpy(1.0 / norm, init_vecs[i]);
+      }
+    }
+    if (bcs) {
+      for (int j = 0; j < nv; j++) {
+        V[j]->applyBCs(bcs);
+      }
+    }
+  }
+}
+
 /*
   Solve the eigenvalue problem using the Lanczos method with full or
   local orthogonalization.
@@ -483,12 +911,14 @@ void SEP::setOperator(EPOperator *_Op) {
   series or orthonormal vectors with respect to a given inner product.
 */
 void SEP::solve(KSMPrint *ksm_print, KSMPrint *ksm_file) {
-  // Select the initial vector randomly
-  Q[0]->setRand();
-  if (bcs) {
-    Q[0]->applyBCs(bcs);
+  if (block_size > 0) {
+    solveBlock(ksm_print, ksm_file);
+    return;
   }
 
+  // Select the initial vector
+  initStartVectors(1, Q);
+
   // Normalize the first vector
   TacsScalar norm = sqrt(Op->dot(Q[0], Q[0]));
   Q[0]->scale(1.0 / norm);
@@ -528,7 +958,19 @@ void SEP::solve(KSMPrint *ksm_print, KSMPrint *ksm_file) {
       niters = max_iters;
     }
   } else {
-    // Perform a full orthogonalization using modified Gram-Schmidt
+    // Perform a full orthogonalization using classical Gram-Schmidt
+    // with reorthogonalization. The inner-product matrix is applied
+    // once per pass, rather than once for each vector in the basis,
+    // so a work vector is required to store the product.
+    if (num_work == 0) {
+      num_work = 1;
+      Qwork = new TACSVec *[1];
+      Qwork[0] = Op->createVec();
+      Qwork[0]->incref();
+      Qwork[0]->setMemoryCategory(TACS_MEMORY_EIGENSOLVER);
+    }
+    TacsScalar *C = new TacsScalar[max_iters];
+
     int i = 0;
     for (; i < max_iters; i++) {
       // Compute the new vector using the provided operator
@@ -537,16 +979,11 @@ void SEP::solve(KSMPrint *ksm_print, KSMPrint *ksm_file) {
         Q[i + 1]->applyBCs(bcs);
       }
 
-      for (int j = i; j >= 0; j--) {
-        TacsScalar h = Op->dot(Q[i + 1], Q[j]);
-        Q[i + 1]->axpy(-h, Q[j]);
-
-        // Store the diagonal term (and discard all other terms which
-        // will only be non-zero due to numerical issues
-        if (j == i) {
-          Alpha[i] = h;
-        }
-      }
+      // Store the diagonal term (and discard all other terms which
+      // will only be non-zero due to numerical issues
+      memset(C, 0, (i + 1) * sizeof(TacsScalar));
+      orthogonalize(i + 1, Q, 1, &Q[i + 1], C, i + 1);
+      Alpha[i] = C[i];
 
       // Evalute the sub-digonal
       Beta[i] = sqrt(Op->dot(Q[i + 1], Q[i + 1]));
@@ -564,6 +1001,8 @@ void SEP::solve(KSMPrint *ksm_print, KSMPrint *ksm_file) {
     if (i == max_iters) {
       niters = max_iters;
     }
+
+    delete[] C;
   }
 
   // Compute the norm of the last vector in the inner product
@@ -605,6 +1044,11 @@ TacsScalar SEP::extractEigenvalue(int n, TacsScalar *error) {
     return 0.0;
   }
 
+  if (block_size > 0) {
+    *error = eig_errors[n];
+    return Op->convertEigenvalue(eigs[n]);
+  }
+
   n = perm[n];
 
   TacsScalar er = Op->errorNorm(Q[niters]);
@@ -629,6 +1073,12 @@ TacsScalar SEP::extractEigenvector(int n, TACSVec *ans, TacsScalar *error) {
     return 0.0;
   }
 
+  if (block_size > 0) {
+    ans->copyValues(Q[n]);
+    *error = eig_errors[n];
+    return Op->convertEigenvalue(eigs[n]);
+  }
+
   n = perm[n];
 
   ans->zeroEntries();
@@ -699,15 +1149,19 @@ void SEP::sortEigenvalues(TacsScalar *values, int neigs, int *p) {
   // Set the flags based on the sorting criteria: Use absolute value
   // if we only care about the magnitude and sort ascending if we only
   // care about the smallest values
-  int use_abs =
-      (spectrum == SMALLEST_MAGNITUDE || spectrum == LARGEST_MAGNITUDE);
+  int use_transformed = (spectrum == NEAREST_SHIFT);
+  int use_abs = (spectrum == SMALLEST_MAGNITUDE ||
+                 spectrum == LARGEST_MAGNITUDE || use_transformed);
   int sort_ascending = (spectrum == SMALLEST_MAGNITUDE || spectrum == SMALLEST);
 
   // Sort the array using insertion sort
   for (int i = 0; i < neigs; i++) {
     // Convert the transformed eigenvalue into the correct
     // range
-    TacsScalar eig_new = Op->convertEigenvalue(values[p[i]]);
+    TacsScalar eig_new = values[p[i]];
+    if (!use_transformed) {
+      eig_new = Op->convertEigenvalue(eig_new);
+    }
 
     // Take the absolute value of the eigenvalue
     if (use_abs) {
@@ -721,7 +1175,10 @@ void SEP::sortEigenvalues(TacsScalar *values, int neigs, int *p) {
     int j = i - 1;
     for (; j >= 0; j--) {
       // Convert the j-th eigenvalue
-      TacsScalar eig_j = Op->convertEigenvalue(values[p[j]]);
+      TacsScalar eig_j = values[p[j]];
+      if (!use_transformed) {
+        eig_j = Op->convertEigenvalue(eig_j);
+      }
       if (use_abs) {
         if (TacsRealPart(eig_j) < 0.0) {
           eig_j *= -1.0;
@@ -784,3 +1241,272 @@ int SEP::checkConverged(TacsScalar *A, TacsScalar *B, int n) {
 
   return is_converged;
 }
+
+/*
+  Orthogonalize the vectors W against the orthonormal vectors V, and add
+  the coefficients of the projection to C, which is stored in
+  column-major order with leading dimension ldc.
+
+  This uses block classical Gram-Schmidt with two passes, so that all
+  the inner products for each pass are computed with a single
+  reduction, and the inner-product matrix is applied to the block W in
+  a single pass.
+*/
+void SEP::orthogonalize(int nv, TACSVec **V, int nw, TACSVec **W, TacsScalar *C,
+                        int ldc) {
+  if (nv == 0 || nw == 0) {
+    return;
+  }
+
+  TACSMat *inner = Op->getInnerMat();
+  TacsScalar *D = new TacsScalar[nv * nw];
+  for (int pass = 0; pass < 2; pass++) {
+    if (inner) {
+      inner->multMulti(nw, W, Qwork);
+      BlockDot(nv, V, nw, Qwork, D);
+    } else {
+      BlockDot(nv, V, nw, W, D);
+    }
+    BlockAxpy(nv, V, nw, W, -1.0, D, nv);
+
+    for (int j = 0; j < nw; j++) {
+      for (int i = 0; i < nv; i++) {
+        C[i + ldc * j] += D[i + nv * j];
+      }
+    }
+  }
+
+  delete[] D;
+}
+
+/*
+  Orthonormalize the block of vectors V[nv], ..., V[nv + block_size-1]
+  that is already orthogonal to the first nv vectors. On exit, the
+  original block is equal to the new block times the upper triangular
+  block_size x block_size matrix R stored in column-major order.
+
+  If the block is rank deficient, the dependent vectors are replaced by
+  random vectors orthogonal to all the previous vectors and the
+  corresponding diagonal entry of R is zero.
+*/
+void SEP::orthonormalizeBlock(int nv, TACSVec **V, TacsScalar *R) {
+  const int p = block_size;
+  memset(R, 0, p * p * sizeof(TacsScalar));
+
+  for (int j = 0; j < p; j++) {
+    TACSVec *w = V[nv + j];
+    TacsScalar norm0 = sqrt(Op->dot(w, w));
+
+    // Orthogonalize against the previous vectors in the block
+    orthogonalize(j, &V[nv], 1, &w, &R[p * j], p);
+    TacsScalar norm = sqrt(Op->dot(w, w));
+
+    if (TacsRealPart(norm) <= 1e-10 * TacsRealPart(norm0) ||
+        TacsRealPart(norm) == 0.0) {
+      // Replace the vector with a random vector orthogonal to the
+      // basis and the previous vectors in the block
+      TacsScalar *C = new TacsScalar[nv + j];
+      memset(C, 0, (nv + j) * sizeof(TacsScalar));
+      w->setRand();
+      if (bcs) {
+        w->applyBCs(bcs);
+      }
+      orthogonalize(nv + j, V, 1, &w, C, nv + j);
+      delete[] C;
+
+      norm = sqrt(Op->dot(w, w));
+    } else {
+      R[j + p * j] = norm;
+    }
+    w->scale(1.0 / norm);
+  }
+}
+
+/*
+  Compute the Ritz values from the projected matrix H of order n and
+  estimate their errors using the coupling R to the next block.
+
+  The Ritz values are sorted by the desired spectrum and the errors of
+  the first nwant values are stored in eig_errors in the sorted order.
+  This returns the number of leading Ritz values that have converged.
+*/
+int SEP::computeRitzValues(int n, TacsScalar *H, TacsScalar *R, int nwant) {
+  const int p = block_size;
+  ComputeEigsSymmetric(n, H, max_iters, eigs, eigvecs);
+  sortEigenvalues(eigs, n, perm);
+
+  // Compute the error norms of the vectors in the next block
+  TacsScalar *er = new TacsScalar[p];
+  for (int j = 0; j < p; j++) {
+    er[j] = Op->errorNorm(Q[n + j]);
+  }
+
+  // The residual of the Ritz pair (theta, Q*y) is Q[n:n+p]*R*y[n-p:n]
+  int nconv = 0;
+  for (int k = 0; k < nwant && k < n; k++) {
+    const TacsScalar *y = &eigvecs[n * perm[k] + n - p];
+    double err = 0.0;
+    for (int j = 0; j < p; j++) {
+      TacsScalar z = 0.0;
+      for (int i = j; i < p; i++) {
+        z += R[j + p * i] * y[i];
+      }
+      err += fabs(TacsRealPart(z * er[j]));
+    }
+    eig_errors[k] = err;
+
+    if (nconv == k && err <= tol) {
+      nconv++;
+    }
+  }
+
+  delete[] er;
+  return nconv;
+}
+
+/*
+  Solve the eigenvalue problem using the thick-restart block Lanczos
+  method.
+
+  The basis is expanded one block at a time until it contains
+  max_iters vectors. The Ritz values are computed from the projected
+  matrix after each block. When the basis is full, the method restarts
+  with the Ritz vectors closest to the desired end of the spectrum and
+  the last block, which keeps the Krylov relation intact. The projected
+  matrix is then diagonal for the retained Ritz vectors, with coupling
+  to the following block that is recovered by the full
+  orthogonalization.
+*/
+void SEP::solveBlock(KSMPrint *ksm_print, KSMPrint *ksm_file) {
+  const int p = block_size;
+  const int m = max_iters;
+
+  // Determine the number of eigenvalues that can be computed
+  int nwant = neigvals;
+  if (nwant > m - 2 * p) {
+    fprintf(stderr,
+            "SEP: Only %d of %d eigenvalues can be computed with a basis "
+            "of size %d\n",
+            m - 2 * p, neigvals, m);
+    nwant = m - 2 * p;
+  }
+
+  // The number of Ritz vectors retained at each restart
+  int keep = nwant + (m - 2 * p - nwant) / 2;
+
+  // The projected matrix and the coupling to the next block
+  TacsScalar *H = new TacsScalar[m * m];
+  TacsScalar *R = new TacsScalar[p * p];
+  memset(H, 0, m * m * sizeof(TacsScalar));
+
+  // Select the initial block
+  initStartVectors(p, Q);
+  orthonormalizeBlock(0, Q, R);
+
+  int n = 0;
+  int nconv = 0;
+  int nblocks = 0;
+  int nrestarts = 0;
+  while (1) {
+    // Expand the basis until it is full
+    while (n + p <= m) {
+      Op->multMulti(p, &Q[n], &Q[n + p]);
+      if (bcs) {
+        for (int j = 0; j < p; j++) {
+          Q[n + p + j]->applyBCs(bcs);
+        }
+      }
+      nblocks++;
+
+      // Orthogonalize against the full basis and the current block. The
+      // coefficients form the next columns of the projected matrix.
+      orthogonalize(n + p, Q, p, &Q[n + p], &H[m * n], m);
+      orthonormalizeBlock(n + p, Q, R);
+      n += p;
+
+      nconv = computeRitzValues(n, H, R, nwant);
+      if (nconv >= nwant) {
+        break;
+      }
+    }
+
+    if (nconv >= nwant || nrestarts >= max_restarts) {
+      break;
+    }
+    nrestarts++;
+
+    // Form the retained Ritz vectors
+    TacsScalar *Y = new TacsScalar[n * keep];
+    for (int k = 0; k < keep; k++) {
+      memcpy(&Y[n * k], &eigvecs[n * perm[k]], n * sizeof(TacsScalar));
+      Qwork[k]->zeroEntries();
+    }
+    BlockAxpy(n, Q, keep, Qwork, 1.0, Y, n);
+    delete[] Y;
+
+    // Restart with the Ritz vectors followed by the next block
+    for (int k = 0; k < keep; k++) {
+      TACSVec *t = Q[k];
+      Q[k] = Qwork[k];
+      Qwork[k] = t;
+    }
+    for (int j = 0; j < p; j++) {
+      TACSVec *t = Q[keep + j];
+      Q[keep + j] = Q[n + j];
+      Q[n + j] = t;
+    }
+
+    memset(H, 0, m * m * sizeof(TacsScalar));
+    for (int k = 0; k < keep; k++) {
+      H[k + m * k] = eigs[perm[k]];
+    }
+    n = keep;
+  }
+
+  // Form the Ritz vectors for the requested eigenvalues and store them
+  // in sorted order
+  niters = (nwant < n ? nwant : n);
+  TacsScalar *Y = new TacsScalar[n * niters];
+  for (int k = 0; k < niters; k++) {
+    memcpy(&Y[n * k], &eigvecs[n * perm[k]], n * sizeof(TacsScalar));
+    Qwork[k]->zeroEntries();
+  }
+  BlockAxpy(n, Q, niters, Qwork, 1.0, Y, n);
+  for (int k = 0; k < niters; k++) {
+    TACSVec *t = Q[k];
+    Q[k] = Qwork[k];
+    Qwork[k] = t;
+    Y[k] = eigs[perm[k]];
+  }
+  for (int k = 0; k < niters; k++) {
+    eigs[k] = Y[k];
+    perm[k] = k;
+  }
+  delete[] Y;
+  delete[] H;
+  delete[] R;
+
+  // Print out a summary of the eigenvalues and errors
+  if (ksm_print) {
+    char line[256];
+    sprintf(line, "Block Lanczos: %d blocks of size %d, %d restarts\n",
+            nblocks, p, nrestarts);
+    ksm_print->print(line);
+    sprintf(line, "%3s %18s %18s %10s\n", " ", "eigenvalue", "shift-invert eig",
+            "error");
+    ksm_print->print(line);
+
+    for (int i = 0; i < niters; i++) {
+      sprintf(line, "%3d %18.10e %18.10e %10.3e\n", i,
+              TacsRealPart(Op->convertEigenvalue(eigs[i])),
+              TacsRealPart(eigs[i]), TacsRealPart(eig_errors[i]));
+      ksm_print->print(line);
+    }
+  }
+  // Print the iteration count to file
+  if (ksm_file) {
+    char line[256];
+    sprintf(line, "%2d\n", nblocks);
+    ksm_file->print(line);
+  }
+}
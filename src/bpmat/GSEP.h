@@ -51,10 +51,23 @@ class EPOperator : public TACSObject {
   // -----------------
   virtual void mult(TACSVec *x, TACSVec *y) = 0;
 
+  // Compute y[i] = A *x[i] for a block of vectors
+  // ----------------------------------------------
+  virtual void multMulti(int nvecs, TACSVec **x, TACSVec **y) {
+    for (int i = 0; i < nvecs; i++) {
+      mult(x[i], y[i]);
+    }
+  }
+
   // Compute the inner product <x,y>
   // -------------------------------
   virtual TacsScalar dot(TACSVec *x, TACSVec *y) { return x->dot(y); }
 
+  // Get the matrix B that defines the inner product <x,y> = x^{T} B y.
+  // This must be consistent with dot(). NULL means B = I.
+  // ------------------------------------------------------------------
+  virtual TACSMat *getInnerMat() { return NULL; }
+
   // Compute || B *x || - this is used to compute the eigenvalue error
   // ------------------------------------------------------------------
   virtual TacsScalar errorNorm(TACSVec *x) { return 1.0; }
@@ -90,6 +103,7 @@ class EPShiftInvert : public EPOperator {
 
   TACSVec *createVec();
   void mult(TACSVec *x, TACSVec *y);
+  void multMulti(int nvecs, TACSVec **x, TACSVec **y);
 
   // The eigenvalues are computed as mu = 1.0/( eig - sigma )
   // eig = 1.0/mu + sigma
@@ -120,7 +134,9 @@ class EPGeneralizedShiftInvert : public EPOperator {
   void setSigma(TacsScalar _sigma);
   TACSVec *createVec();
   void mult(TACSVec *x, TACSVec *y);  // Compute y = (A - sigma B)^{-1}*inner*x
+  void multMulti(int nvecs, TACSVec **x, TACSVec **y);
   TacsScalar dot(TACSVec *x, TACSVec *y);  // Compute <x,y> = x^{T}*inner*y
+  TACSMat *getInnerMat() { return inner; }
   TacsScalar errorNorm(TACSVec *x);
   TacsScalar convertEigenvalue(TacsScalar value);
 
@@ -129,6 +145,10 @@ class EPGeneralizedShiftInvert : public EPOperator {
   TACSKsm *ksm;
   TACSMat *inner;
   TACSVec *temp;
+
+  // Temporary vectors for the block products
+  int num_temps;
+  TACSVec **temps;
 };
 
 /*
@@ -151,7 +171,9 @@ class EPBucklingShiftInvert : public EPOperator {
   void setSigma(TacsScalar _sigma);
   TACSVec *createVec();
   void mult(TACSVec *x, TACSVec *y);  // Compute y = (A - sigma B)^{-1}*inner*x
+  void multMulti(int nvecs, TACSVec **x, TACSVec **y);
   TacsScalar dot(TACSVec *x, TACSVec *y);  // Compute <x,y> = x^{T}*inner*y
+  TACSMat *getInnerMat() { return inner; }
   TacsScalar errorNorm(TACSVec *x);
   TacsScalar convertEigenvalue(TacsScalar value);
 
@@ -160,6 +182,10 @@ class EPBucklingShiftInvert : public EPOperator {
   TACSKsm *ksm;
   TACSMat *inner;
   TACSVec *temp;
+
+  // Temporary vectors for the block products
+  int num_temps;
+  TACSVec **temps;
 };
 
 /*
@@ -173,16 +199,37 @@ class EPBucklingShiftInvert : public EPOperator {
   Note that the full orthogonalization is suggested (and is the
   default) since this has better numerical properties. The Lanczos
   vectors lose orthogonality as the eigenvalues converge.
+
+  When a block size is set with setBlockLanczos(), a thick-restart
+  block Lanczos method is used instead. In this case max_iters bounds
+  the size of the basis, not the number of iterations. The operator is
+  applied to a block of vectors at once, so that the shift-invert
+  solves can share passes over the factored matrix, and the block is
+  orthogonalized against the basis using level-3 BLAS. When the basis
+  is full, the method restarts and retains the Ritz vectors closest to
+  the desired end of the spectrum. This makes it possible to compute
+  many eigenpairs with a basis of fixed size.
+
+  The starting vectors can be seeded with setInitialVectors(), for
+  instance with the eigenvectors from a previous solve of a nearby
+  problem. The seed vectors are summed into the starting vector (or
+  into the vectors of the starting block) together with a small random
+  component, so that the Krylov subspace rapidly captures the modes
+  that are near the seed vectors.
 */
 class SEP : public TACSObject {
  public:
   // Set the type of orthogonalization to use
   enum OrthoType { FULL, LOCAL };
+  // NEAREST_SHIFT selects the eigenvalues closest to the shift of a
+  // shift and invert operator, which have the largest magnitude of the
+  // transformed eigenvalue
   enum EigenSpectrum {
     SMALLEST,
     LARGEST,
     SMALLEST_MAGNITUDE,
-    LARGEST_MAGNITUDE
+    LARGEST_MAGNITUDE,
+    NEAREST_SHIFT
   };
 
   SEP(EPOperator *_Op, int _max_iters, OrthoType _ortho_type = FULL,
@@ -192,12 +239,18 @@ class SEP : public TACSObject {
   // Set the orthogonalization strategy
   void setOrthoType(OrthoType _ortho_type);
 
+  // Use the thick-restart block Lanczos method (block_size = 0 disables it)
+  void setBlockLanczos(int _block_size, int _max_restarts = 25);
+
   // Set the solution tolerances, type of spectrum and number of eigenvalues
   void setTolerances(double _tol, EigenSpectrum _spectrum, int _neigvals);
 
   // Reset the eigenproblem operator
   void setOperator(EPOperator *_Op);
 
+  // Seed the starting vectors (nvecs = 0 restores a random start)
+  void setInitialVectors(int nvecs, TACSVec **vecs);
+
   // Solve the eigenproblem
   void solve(KSMPrint *ksm_print = NULL, KSMPrint *ksm_file = NULL);
 
@@ -216,6 +269,22 @@ class SEP : public TACSObject {
   // Check whether the right eigenvalues have converged
   int checkConverged(TacsScalar *A, TacsScalar *B, int n);
 
+  // Form the starting vectors from the random and seed vectors
+  void initStartVectors(int nv, TACSVec **V);
+
+  // Solve the eigenproblem with the thick-restart block Lanczos method
+  void solveBlock(KSMPrint *ksm_print, KSMPrint *ksm_file);
+
+  // Orthogonalize the vectors W against V and add the coefficients to C
+  void orthogonalize(int nv, TACSVec **V, int nw, TACSVec **W, TacsScalar *C,
+                     int ldc);
+
+  // Orthonormalize the block of vectors stored after the first nv vectors
+  void orthonormalizeBlock(int nv, TACSVec **V, TacsScalar *R);
+
+  // Compute the Ritz values and their errors from the projected matrix
+  int computeRitzValues(int n, TacsScalar *H, TacsScalar *R, int nwant);
+
   // Data used to determine which spectrum to use and when
   // enough eigenvalues are converged
   double tol;
@@ -242,8 +311,19 @@ class SEP : public TACSObject {
   OrthoType ortho_type;
 
   int max_iters;
+  int num_vecs;
   TACSVec **Q;  // The Vectors for the eigenvalue problem...
 
+  // Data for the thick-restart block Lanczos method
+  int block_size, max_restarts;
+  int num_work;
+  TACSVec **Qwork;
+  TacsScalar *eig_errors;
+
+  // The vectors used to seed the starting vectors
+  int num_init_vecs;
+  TACSVec **init_vecs;
+
   // Boundary conditions that are applied
   TACSBcMap *bcs;
 };
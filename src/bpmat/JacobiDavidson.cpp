@@ -14,6 +14,7 @@
 
 #include "JacobiDavidson.h"
 
+#include "TACSMg.h"
 #include "TacsUtilities.h"
 #include "tacslapack.h"
 
@@ -121,6 +122,21 @@ void TACSJDFrequencyOperator::setEigenvalueEstimate(double estimate) {
   pc->factor();
 }
 
+/*
+  Update the preconditioner for a new eigenvalue estimate
+
+  When the preconditioner is multigrid, only the coarsest level is
+  shifted to K - estimate*M and refactored. The smoothers on the finer
+  levels keep the shift from the last call to setEigenvalueEstimate().
+*/
+int TACSJDFrequencyOperator::updateEigenvalueEstimate(double estimate) {
+  TACSMg *mg = dynamic_cast<TACSMg *>(pc);
+  if (mg) {
+    return !mg->setCoarseShift(estimate);
+  }
+  return 0;
+}
+
 // Apply the preconditioner
 void TACSJDFrequencyOperator::applyFactor(TACSVec *x, TACSVec *y) {
   pc->applyFactor(x, y);
@@ -248,6 +264,18 @@ TACSJacobiDavidson::TACSJacobiDavidson(TACSJacobiDavidsonOperator *_oper,
     Z[i] = oper->createVec();
     Z[i]->incref();
   }
+
+  // The recycled subspace is not used by default
+  max_inner_recycle = 0;
+  num_inner_recycle = 0;
+  U = AU = BU = NULL;
+  C = Uc = NULL;
+  Bc = Hs = NULL;
+  Gr = Geigs = Gwork = NULL;
+  Glwork = 0;
+
+  // The preconditioner shift is not updated by default
+  shift_rtol = -1.0;
 }
 
 /*
@@ -293,6 +321,9 @@ TACSJacobiDavidson::~TACSJacobiDavidson() {
   }
   delete[] Z;
 
+  // Free the recycled subspace
+  setInnerRecycle(0);
+
   work->decref();
 }
 
@@ -467,6 +498,13 @@ void TACSJacobiDavidson::solve(KSMPrint *ksm_print, int print_level) {
   int iteration = 0;
   int gmres_iteration = 0;
 
+  // The recycled subspace is only valid for the current operators
+  num_inner_recycle = 0;
+
+  // The Ritz value used for the last preconditioner update
+  int pc_shift_set = 0;
+  double pc_shift = 0.0;
+
   // Check if the recycle flag is set
   int kstart = 0;
   if (num_recycle_vecs > 0) {
@@ -772,20 +810,91 @@ void TACSJacobiDavidson::solve(KSMPrint *ksm_print, int print_level) {
       continue;
     }
 
+    // Update the preconditioner when the Ritz value has moved
+    if (shift_rtol >= 0.0) {
+      if (!pc_shift_set || fabs(theta - pc_shift) > shift_rtol * fabs(theta)) {
+        oper->updateEigenvalueEstimate(theta);
+        pc_shift_set = 1;
+        pc_shift = theta;
+      }
+    }
+
+    // Form the orthonormal basis C for the image of the recycled
+    // subspace under the projected operator
+    //
+    // C = (I - P*Q^{T})*(A - theta*B)*(I - Q*P^{T})*U
+    //
+    // The products with A and B are stored, so the basis is updated for
+    // the new shift without matrix-vector products. The right projection
+    // uses (A - theta*B)*q = r for the current Ritz vector, while the
+    // terms from the converged eigenvectors are proportional to P and
+    // are removed by the left projection. The same operations are
+    // applied to Uc so that C is the image of Uc.
+    int nrecycle = 0;
+    for (int j = 0; j < num_inner_recycle; j++) {
+      C[nrecycle]->copyValues(AU[j]);
+      C[nrecycle]->axpy(-theta, BU[j]);
+      Uc[nrecycle]->copyValues(U[j]);
+      for (int i = 0; i <= nconverged; i++) {
+        TacsScalar h = Uc[nrecycle]->dot(P[i]);
+        Uc[nrecycle]->axpy(-h, Q[i]);
+        if (i == nconverged) {
+          C[nrecycle]->axpy(-h, work);
+        }
+      }
+      for (int i = 0; i <= nconverged; i++) {
+        TacsScalar h = C[nrecycle]->dot(Q[i]);
+        C[nrecycle]->axpy(-h, P[i]);
+      }
+
+      TacsScalar cnorm0 = C[nrecycle]->norm();
+      for (int i = 0; i < nrecycle; i++) {
+        TacsScalar h = C[nrecycle]->dot(C[i]);
+        C[nrecycle]->axpy(-h, C[i]);
+        Uc[nrecycle]->axpy(-h, Uc[i]);
+      }
+
+      // Discard the directions that are nearly linearly dependent
+      TacsScalar cnorm = C[nrecycle]->norm();
+      if (TacsRealPart(cnorm) > 1e-10 * TacsRealPart(cnorm0)) {
+        C[nrecycle]->scale(1.0 / cnorm);
+        Uc[nrecycle]->scale(1.0 / cnorm);
+        nrecycle++;
+      }
+    }
+
     // Now solve the system (K - theta*M)*t = -work
     // Keep track of the number of iterations in GMRES
     int niters = 0;
 
     // Copy the residual to the first work vector
     W[0]->copyValues(work);
-    res[0] = W[0]->norm();
-    W[0]->scale(1.0 / res[0]);  // W[0] = b/|| b ||
 
     // Keep track of the initial norm of the right-hand-side
-    double beta = TacsRealPart(res[0]);
+    double beta = TacsRealPart(W[0]->norm());
+
+    // Remove the components of the residual in the recycled subspace.
+    // The corresponding part of the solution, Uc*C^{T}*r, is added to
+    // the next basis vector.
+    V[k + 1]->zeroEntries();
+    for (int j = 0; j < nrecycle; j++) {
+      TacsScalar h = C[j]->dot(W[0]);
+      W[0]->axpy(-h, C[j]);
+      V[k + 1]->axpy(-h, Uc[j]);
+    }
+
+    // Skip the iterations if the recycled subspace solves the problem
+    int max_iters = max_gmres_size;
+    res[0] = W[0]->norm();
+    if (fabs(TacsRealPart(res[0])) < atol ||
+        fabs(TacsRealPart(res[0])) < rtol * beta) {
+      max_iters = 0;
+    } else {
+      W[0]->scale(1.0 / res[0]);  // W[0] = b/|| b ||
+    }
 
     // Using GMRES, solve for the update equation
-    for (int i = 0; i < max_gmres_size; i++) {
+    for (int i = 0; i < max_iters; i++) {
       // Now compute: work = (I - Q*P^{T})*Z[i]
       // Note that we compute the product in this way since
       // it is numerical more stable and equivalent to the form above
@@ -813,6 +922,12 @@ void TACSJacobiDavidson::solve(KSMPrint *ksm_print, int print_level) {
         W[i + 1]->axpy(-h, P[j]);
       }
 
+      // Orthogonalize against the recycled subspace C
+      for (int j = 0; j < nrecycle; j++) {
+        Bc[j + i * max_inner_recycle] = W[i + 1]->dot(C[j]);
+        W[i + 1]->axpy(-Bc[j + i * max_inner_recycle], C[j]);
+      }
+
       // Build the orthogonal basis using MGS
       for (int j = i; j >= 0; j--) {
         H[j + Hptr[i]] = W[i + 1]->dot(W[j]);   // H[j,i] = dot(W[i+1], W[i])
@@ -824,6 +939,13 @@ void TACSJacobiDavidson::solve(KSMPrint *ksm_print, int print_level) {
       W[i + 1]->scale(1.0 /
                       H[i + 1 + Hptr[i]]);  // W[i+1] = W[i+1]/|| W[i+1] ||
 
+      // Keep the Hessenberg matrix before the rotations are applied
+      if (max_inner_recycle > 0) {
+        for (int j = 0; j <= i + 1; j++) {
+          Hs[j + Hptr[i]] = H[j + Hptr[i]];
+        }
+      }
+
       // Apply the existing part of Q to the new components of the
       // Hessenberg matrix
       TacsScalar h1, h2;
@@ -874,11 +996,25 @@ void TACSJacobiDavidson::solve(KSMPrint *ksm_print, int print_level) {
     }
 
     // Compute the next basis vector for the outer Jacobi--Davidson basis
-    V[k + 1]->zeroEntries();
     for (int i = 0; i < niters; i++) {
       V[k + 1]->axpy(-res[i], Z[i]);
     }
 
+    // Remove the part of the update that lies in the recycled subspace,
+    // t <- t + Uc*Bc*y, where Bc = C^{T}*(I - P*Q^{T})*A*Z
+    for (int j = 0; j < nrecycle; j++) {
+      TacsScalar h = 0.0;
+      for (int i = 0; i < niters; i++) {
+        h += Bc[j + i * max_inner_recycle] * res[i];
+      }
+      V[k + 1]->axpy(h, Uc[j]);
+    }
+
+    // Select the new recycled subspace from the directions [Uc, Z]
+    if (max_inner_recycle > 0 && niters > 0) {
+      updateInnerRecycle(nrecycle, niters);
+    }
+
     // Compute the product to test the error
     // (1 - P*Q^{T})*(A - theta*B)*(1 - Q*P^{T})
     W[0]->copyValues(V[k + 1]);
@@ -954,3 +1090,171 @@ void TACSJacobiDavidson::setRecycle(int _num_recycle_vecs,
   num_recycle_vecs = _num_recycle_vecs;
   recycle_type = _recycle_type;
 }
+
+/*
+  Select the recycled subspace for the next FGMRES solve
+
+  The last solve satisfies the augmented Arnoldi relation
+
+  Op*[Uc, Z] = [C, W]*G,  G = [ I  Bc ]
+                              [ 0  Hs ]
+
+  where [C, W] has orthonormal columns, so that ||Op*[Uc, Z]*g|| =
+  ||G*g||. The new recycled vectors are U = [Uc, Z]*g for the
+  eigenvectors g of G^{T}*G with the smallest eigenvalues. These are
+  the directions that are reduced the least by the operator, which
+  slow the convergence of FGMRES. The products with A and B are
+  computed for the new vectors so that the subspace can be used with
+  the next Ritz value.
+
+  input:
+  nrecycle: the number of recycled vectors used in the last solve
+  niters:   the number of FGMRES iterations in the last solve
+*/
+void TACSJacobiDavidson::updateInnerRecycle(int nrecycle, int niters) {
+  // Form G^{T}*G. The columns of the Hessenberg matrix are orthogonal to
+  // the columns of the identity block, so only Bc couples the blocks.
+  int n = nrecycle + niters;
+  memset(Gr, 0, n * n * sizeof(double));
+  for (int j = 0; j < nrecycle; j++) {
+    Gr[j + n * j] = 1.0;
+    for (int i = 0; i < niters; i++) {
+      double b = TacsRealPart(Bc[j + i * max_inner_recycle]);
+      Gr[j + n * (nrecycle + i)] = b;
+      Gr[(nrecycle + i) + n * j] = b;
+    }
+  }
+  for (int i = 0; i < niters; i++) {
+    for (int l = 0; l <= i; l++) {
+      double g = 0.0;
+      for (int j = 0; j < nrecycle; j++) {
+        g += TacsRealPart(Bc[j + i * max_inner_recycle] *
+                          Bc[j + l * max_inner_recycle]);
+      }
+      for (int j = 0; j <= l + 1; j++) {
+        g += TacsRealPart(Hs[j + Hptr[i]] * Hs[j + Hptr[l]]);
+      }
+      Gr[(nrecycle + i) + n * (nrecycle + l)] = g;
+      Gr[(nrecycle + l) + n * (nrecycle + i)] = g;
+    }
+  }
+
+  // Compute the eigenvalues in ascending order
+  const char *jobz = "V", *uplo = "U";
+  int info;
+  LAPACKdsyev(jobz, uplo, &n, Gr, &n, Geigs, Gwork, &Glwork, &info);
+  if (info != 0) {
+    num_inner_recycle = 0;
+    return;
+  }
+
+  // Form the new recycled vectors and their products
+  num_inner_recycle = max_inner_recycle;
+  if (num_inner_recycle > n) {
+    num_inner_recycle = n;
+  }
+  for (int k = 0; k < num_inner_recycle; k++) {
+    const double *g = &Gr[n * k];
+    U[k]->zeroEntries();
+    for (int j = 0; j < nrecycle; j++) {
+      U[k]->axpy(g[j], Uc[j]);
+    }
+    for (int i = 0; i < niters; i++) {
+      U[k]->axpy(g[nrecycle + i], Z[i]);
+    }
+    oper->multA(U[k], AU[k]);
+    oper->multB(U[k], BU[k]);
+  }
+}
+
+/*
+  Set the number of vectors recycled between the FGMRES solves
+
+  The inner FGMRES solves for the correction equations are augmented
+  with a recycled subspace selected from the previous solve (see
+  updateInnerRecycle). The products of the recycled vectors with A and
+  B are stored so that the recycled subspace is used with each new
+  Ritz value without additional products. Selecting the subspace costs
+  one product with A and one with B for each recycled vector.
+
+  input:
+  max_inner_recycle: the maximum number of recycled vectors (0 to disable)
+*/
+void TACSJacobiDavidson::setInnerRecycle(int _max_inner_recycle) {
+  // Free the existing recycled subspace
+  for (int i = 0; i < max_inner_recycle; i++) {
+    U[i]->decref();
+    AU[i]->decref();
+    BU[i]->decref();
+    C[i]->decref();
+    Uc[i]->decref();
+  }
+  if (U) {
+    delete[] U;
+    delete[] AU;
+    delete[] BU;
+    delete[] C;
+    delete[] Uc;
+    delete[] Bc;
+    delete[] Hs;
+    delete[] Gr;
+    delete[] Geigs;
+    delete[] Gwork;
+  }
+  U = AU = BU = NULL;
+  C = Uc = NULL;
+  Bc = Hs = NULL;
+  Gr = Geigs = Gwork = NULL;
+
+  max_inner_recycle = 0;
+  if (_max_inner_recycle > 0) {
+    max_inner_recycle = _max_inner_recycle;
+  }
+  num_inner_recycle = 0;
+
+  if (max_inner_recycle > 0) {
+    U = new TACSVec *[max_inner_recycle];
+    AU = new TACSVec *[max_inner_recycle];
+    BU = new TACSVec *[max_inner_recycle];
+    C = new TACSVec *[max_inner_recycle];
+    Uc = new TACSVec *[max_inner_recycle];
+    for (int i = 0; i < max_inner_recycle; i++) {
+      U[i] = oper->createVec();
+      U[i]->incref();
+      AU[i] = oper->createVec();
+      AU[i]->incref();
+      BU[i] = oper->createVec();
+      BU[i]->incref();
+      C[i] = oper->createVec();
+      C[i]->incref();
+      Uc[i] = oper->createVec();
+      Uc[i]->incref();
+    }
+    Bc = new TacsScalar[max_inner_recycle * max_gmres_size];
+    Hs = new TacsScalar[Hptr[max_gmres_size]];
+
+    // Space for the eigenproblem that selects the recycled subspace
+    int n = max_inner_recycle + max_gmres_size;
+    Glwork = 16 * n;
+    Gr = new double[n * n];
+    Geigs = new double[n];
+    Gwork = new double[Glwork];
+  }
+}
+
+/*
+  Set the relative change in the Ritz value that updates the
+  preconditioner
+
+  Before each correction equation, the preconditioner is updated with
+  the operator's updateEigenvalueEstimate() when the Ritz value has
+  moved by more than shift_rtol*|theta| since the last update. For the
+  frequency operator with multigrid, this shifts and refactors only the
+  coarsest level.
+
+  input:
+  shift_rtol: the relative tolerance (negative to disable)
+*/
+void TACSJacobiDavidson::setShiftUpdate(double _shift_rtol) {
+  shift_rtol = _shift_rtol;
+}
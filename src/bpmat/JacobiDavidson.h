@@ -40,6 +40,10 @@ class TACSJacobiDavidsonOperator : public TACSObject {
   // Set the eigenvalue estimate (and reset the factorization)
   virtual void setEigenvalueEstimate(double estimate) = 0;
 
+  // Update the preconditioner for a new eigenvalue estimate at a low
+  // cost. Returns zero if the preconditioner was not updated.
+  virtual int updateEigenvalueEstimate(double estimate) { return 0; }
+
   // Apply the preconditioner
   virtual void applyFactor(TACSVec *x, TACSVec *y) = 0;
 
@@ -112,6 +116,9 @@ class TACSJDFrequencyOperator : public TACSJacobiDavidsonOperator {
   // pc = K in this case
   void setEigenvalueEstimate(double estimate);
 
+  // Shift the coarse level of a multigrid preconditioner
+  int updateEigenvalueEstimate(double estimate);
+
   // Apply the preconditioner
   void applyFactor(TACSVec *x, TACSVec *y);
 
@@ -165,6 +172,13 @@ class TACSJacobiDavidson : public TACSObject {
   // Set the number of vectors to recycle
   void setRecycle(int _recycle, JDRecycleType _recycle_type);
 
+  // Set the number of vectors recycled between the FGMRES solves
+  void setInnerRecycle(int _max_inner_recycle);
+
+  // Set the relative change in the Ritz value that updates the
+  // preconditioner
+  void setShiftUpdate(double _shift_rtol);
+
  private:
   // The operator class that defines the eigenproblem
   TACSJacobiDavidsonOperator *oper;
@@ -220,6 +234,25 @@ class TACSJacobiDavidson : public TACSObject {
 
   // Subspace data for GMRES whether its flexible or not
   TACSVec **W, **Z;
+
+  // Select the recycled subspace from the last FGMRES solve
+  void updateInnerRecycle(int nrecycle, int niters);
+
+  // The recycled subspace U with the products A*U and B*U
+  int max_inner_recycle, num_inner_recycle;
+  TACSVec **U, **AU, **BU;
+
+  // The orthonormal basis C for the image of the recycled subspace Uc,
+  // the projection coefficients and the unrotated Hessenberg matrix
+  TACSVec **C, **Uc;
+  TacsScalar *Bc, *Hs;
+
+  // Data for the eigenproblem that selects the recycled subspace
+  int Glwork;
+  double *Gr, *Geigs, *Gwork;
+
+  // The tolerance for updating the preconditioner shift
+  double shift_rtol;
 };
 
 #endif  // TACS_JACOBI_DAVIDSON_H
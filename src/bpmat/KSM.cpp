@@ -21,6 +21,11 @@
 #include <math.h>
 #include <stdio.h>
 
+#include "TACSBVec.h"
+#include "TACSCommProfiler.h"
+#include "TACSProfiler.h"
+#include "tacslapack.h"
+
 /*
   Implementation of various Krylov-subspace methods
 */
@@ -215,6 +220,121 @@ void TACSVec::mdot(TACSVec **x, TacsScalar *ans, int m) {
   }
 }
 
+/*
+  The default implementation for adding a linear combination of
+  vectors. This can be implemented more efficiently by updating the
+  vector in a single pass.
+
+  input:
+  m:     the number of vectors in x
+  alpha: the coefficients of the vectors
+  x:     the vectors
+*/
+void TACSVec::maxpy(int m, const TacsScalar *alpha, TACSVec **x) {
+  for (int k = 0; k < m; k++) {
+    axpy(alpha[k], x[k]);
+  }
+}
+
+/*
+  Wait for a split-phase reduction and record the time spent waiting
+*/
+static void TacsWaitReduction(MPI_Request *request) {
+  double t0 = TACSCommProfiler::beginWait();
+  MPI_Wait(request, MPI_STATUS_IGNORE);
+  TACSCommProfiler::endWait(TACS_COMM_REDUCTION, t0);
+}
+
+/*
+  Start the dot product of this vector with x. The default
+  implementation computes the result immediately.
+*/
+void TACSVec::beginDot(TACSVec *x, TACSVecRequest *req) {
+  req->request = MPI_REQUEST_NULL;
+  req->values[0] = dot(x);
+}
+
+/*
+  Start the computation of the norm of this vector. The value stored
+  in the request is the square of the norm.
+*/
+void TACSVec::beginNorm(TACSVecRequest *req) {
+  req->request = MPI_REQUEST_NULL;
+  TacsScalar nrm = norm();
+  req->values[0] = nrm * nrm;
+}
+
+/*
+  Start the multiple dot product. The result is stored in ans, which
+  must not be used until endMdot() is called.
+*/
+void TACSVec::beginMdot(TACSVec **x, TacsScalar *ans, int m,
+                        TACSVecRequest *req) {
+  req->request = MPI_REQUEST_NULL;
+  mdot(x, ans, m);
+}
+
+/*
+  Compute y <- y + alpha*x and start the computation of the norm of
+  the updated vector
+*/
+void TACSVec::beginAxpyNorm(TacsScalar alpha, TACSVec *x,
+                            TACSVecRequest *req) {
+  axpy(alpha, x);
+  beginNorm(req);
+}
+
+/*
+  Start the computation of the dot products of this vector with x1
+  and x2 with a single reduction
+*/
+void TACSVec::beginDot2(TACSVec *x1, TACSVec *x2, TACSVecRequest *req) {
+  req->request = MPI_REQUEST_NULL;
+  req->values[0] = dot(x1);
+  req->values[1] = dot(x2);
+}
+
+/*
+  Complete the split-phase reductions
+*/
+TacsScalar TACSVec::endDot(TACSVecRequest *req) {
+  TacsWaitReduction(&req->request);
+  return req->values[0];
+}
+
+TacsScalar TACSVec::endNorm(TACSVecRequest *req) {
+  TacsWaitReduction(&req->request);
+  return sqrt(req->values[0]);
+}
+
+void TACSVec::endMdot(TACSVecRequest *req) {
+  TacsWaitReduction(&req->request);
+}
+
+void TACSVec::endDot2(TACSVecRequest *req, TacsScalar *d1, TacsScalar *d2) {
+  TacsWaitReduction(&req->request);
+  *d1 = req->values[0];
+  *d2 = req->values[1];
+}
+
+/*
+  Compute y <- y + alpha*x and return the norm of the updated vector
+*/
+TacsScalar TACSVec::axpyNorm(TacsScalar alpha, TACSVec *x) {
+  TACSVecRequest req;
+  beginAxpyNorm(alpha, x, &req);
+  return endNorm(&req);
+}
+
+/*
+  Compute the dot products of this vector with x1 and x2
+*/
+void TACSVec::dot2(TACSVec *x1, TACSVec *x2, TacsScalar *d1, TacsScalar *d2) {
+  TACSVecRequest req;
+  beginDot2(x1, x2, &req);
+  endDot2(&req, d1, d2);
+}
+
 const char *TACSMat::getObjectName() { return matName; }
 const char *TACSMat::matName = "TACSMat";
 
@@ -332,6 +452,131 @@ void KSMPrintFile::print(const char *cstr) {
   }
 }
 
+/*
+  A KSM print object that writes the telemetry as JSON lines
+
+  input:
+  filename: the name of the file
+  descript: the name of the solver recorded with each entry
+  rank:     output/create file if rank == 0
+*/
+KSMPrintTelemetry::KSMPrintTelemetry(const char *filename,
+                                     const char *_descript, int _rank) {
+  rank = _rank;
+  solve_count = 0;
+  newton_count = 0;
+
+  // Copy the description to a local array
+  size_t n = strlen(_descript);
+  descript = new char[n + 1];
+  strcpy(descript, _descript);
+
+  fp = NULL;
+  if (rank == 0) {
+    fp = fopen(filename, "w");
+  }
+}
+
+KSMPrintTelemetry::~KSMPrintTelemetry() {
+  if (fp) {
+    fclose(fp);
+  }
+  delete[] descript;
+}
+
+/*
+  Record the residual from a solver that does not record its
+  performance data
+*/
+void KSMPrintTelemetry::printResidual(int iter, TacsScalar res) {
+  if (iter == 0) {
+    solve_count++;
+  }
+  if (fp) {
+    fprintf(fp,
+            "{\"type\": \"ksm\", \"solver\": \"%s\", \"solve\": %d, "
+            "\"iter\": %d, \"res\": %.8e}\n",
+            descript, solve_count, iter, TacsRealPart(res));
+  }
+}
+
+/*
+  Record the residual and the time spent in each operation
+*/
+void KSMPrintTelemetry::printIteration(int iter, TacsScalar res,
+                                       const KSMIterStats *stats) {
+  if (iter == 0) {
+    solve_count++;
+  }
+  if (fp) {
+    fprintf(fp,
+            "{\"type\": \"ksm\", \"solver\": \"%s\", \"solve\": %d, "
+            "\"iter\": %d, \"res\": %.8e, \"pc_time\": %.6e, "
+            "\"mat_time\": %.6e, \"orth_time\": %.6e, "
+            "\"reductions\": %d}\n",
+            descript, solve_count, iter, TacsRealPart(res), stats->pc_time,
+            stats->mat_time, stats->orth_time, stats->num_reductions);
+  }
+}
+
+/*
+  Record the summary of a Krylov solve
+*/
+void KSMPrintTelemetry::endSolve(int iters, TacsScalar res, int solve_flag,
+                                 double time) {
+  if (fp) {
+    fprintf(fp,
+            "{\"type\": \"ksm_solve\", \"solver\": \"%s\", "
+            "\"solve\": %d, \"iters\": %d, \"res\": %.8e, "
+            "\"flag\": %d, \"time\": %.6e}\n",
+            descript, solve_count, iters, TacsRealPart(res), solve_flag, time);
+    fflush(fp);
+  }
+}
+
+/*
+  Record a nonlinear iteration
+*/
+void KSMPrintTelemetry::printNewtonIteration(int iter, TacsScalar res,
+                                             const KSMNewtonStats *stats) {
+  if (iter == 0) {
+    newton_count++;
+  }
+  if (fp) {
+    fprintf(fp,
+            "{\"type\": \"newton\", \"solver\": \"%s\", "
+            "\"newton\": %d, \"iter\": %d, \"res\": %.8e, "
+            "\"assembly_time\": %.6e, \"factor_time\": %.6e, "
+            "\"solve_time\": %.6e, \"ksm_iters\": %d, "
+            "\"jac_assembled\": %d}\n",
+            descript, newton_count, iter, TacsRealPart(res),
+            stats->assembly_time, stats->factor_time, stats->solve_time,
+            stats->ksm_iters, stats->jac_assembled);
+    fflush(fp);
+  }
+}
+
+/*
+  Record a message, escaping the characters that are not allowed in a
+  JSON string
+*/
+void KSMPrintTelemetry::print(const char *cstr) {
+  if (fp) {
+    fprintf(fp, "{\"type\": \"message\", \"solver\": \"%s\", \"text\": \"",
+            descript);
+    for (const char *c = cstr; *c; c++) {
+      if (*c == '"' || *c == '\\') {
+        fprintf(fp, "\\%c", *c);
+      } else if (*c == '\n') {
+        fprintf(fp, "\\n");
+      } else if ((unsigned char)*c >= 32) {
+        fputc(*c, fp);
+      }
+    }
+    fprintf(fp, "\"}\n");
+  }
+}
+
 /*
   The preconditioned conjugate gradient method
 
@@ -437,9 +682,12 @@ void PCG::setMonitor(KSMPrint *_monitor) {
   solve_flag: flag for the whether the solve terminated successfully
 */
 int PCG::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  TACSProfileScope scope("PCG::solve");
   int solve_flag = 0;
   iterCount = 0;
   TacsScalar rhs_norm = 0.0;
+  double t_solve = MPI_Wtime();
+  KSMIterStats stats = {0.0, 0.0, 0.0, 1};
   // R, Z and P are work-vectors
   // R == the residual
 
@@ -460,7 +708,7 @@ int PCG::solve(TACSVec *b, TACSVec *x, int zero_guess) {
     }
 
     if (monitor && count == 0) {
-      monitor->printResidual(0, rhs_norm);
+      monitor->printIteration(0, rhs_norm, &stats);
     }
 
     if (TacsRealPart(rhs_norm) > atol) {
@@ -470,21 +718,33 @@ int PCG::solve(TACSVec *b, TACSVec *x, int zero_guess) {
       // Copy Z to P, ie. P = Z
       P->copyValues(Z);
 
+      // The residual norm and (R,Z) are computed with a single
+      // reduction in each iteration
+      TacsScalar temp = R->dot(Z);  // (R,Z)
       for (int i = 0; i < reset; i++) {
+        double t0 = MPI_Wtime();
         mat->mult(P, work);                        // work = A*P
-        TacsScalar temp = R->dot(Z);               // (R,Z)
+        double t1 = MPI_Wtime();
         TacsScalar alpha = temp / (work->dot(P));  // alpha = (R,Z)/(A*P,P)
         x->axpy(alpha, P);                         // x = x + alpha*P
         R->axpy(-alpha, work);                     // R' = R - alpha*A*P
+        double t2 = MPI_Wtime();
         pc->applyFactor(R, Z);                     // Z' = M^{-1} R
-        TacsScalar beta = R->dot(Z) / temp;        // beta = (R',Z')/(R,Z)
-        P->axpby(1.0, beta, Z);                    // P' = Z' + beta*P
+        stats.mat_time = t1 - t0;
+        stats.pc_time = MPI_Wtime() - t2;
+        stats.num_reductions = 2;
+
+        TacsScalar rz, rr;
+        R->dot2(Z, R, &rz, &rr);      // (R',Z') and (R',R')
+        TacsScalar beta = rz / temp;  // beta = (R',Z')/(R,Z)
+        temp = rz;
+        P->axpby(1.0, beta, Z);  // P' = Z' + beta*P
         iterCount++;
 
-        resNorm = R->norm();
+        resNorm = sqrt(rr);
 
         if (monitor) {
-          monitor->printResidual(i + 1, resNorm);
+          monitor->printIteration(i + 1, resNorm, &stats);
         }
 
         if (TacsRealPart(resNorm) < atol ||
@@ -499,6 +759,11 @@ int PCG::solve(TACSVec *b, TACSVec *x, int zero_guess) {
       break;
     }
   }
+
+  if (monitor) {
+    monitor->endSolve(iterCount, resNorm, solve_flag, MPI_Wtime() - t_solve);
+  }
+
   return solve_flag;
 }
 
@@ -516,8 +781,33 @@ static void ClassicalGramSchmidt(TacsScalar *h, TACSVec *q, TACSVec **w,
                                  int nvecs) {
   q->mdot(w, h, nvecs);
   for (int j = 0; j < nvecs; j++) {
-    q->axpy(-h[j], w[j]);
+    h[j] = -h[j];
+  }
+  q->maxpy(nvecs, h, w);
+  for (int j = 0; j < nvecs; j++) {
+    h[j] = -h[j];
+  }
+}
+
+/*
+  Classical Gram-Schmidt orthogonalization with reorthogonalization
+
+  Two passes of classical Gram-Schmidt give a basis that is orthogonal
+  to working precision, like modified Gram-Schmidt, but with two
+  reductions in place of one for each vector. Each pass reads the
+  basis once with a multiple dot product and once with a multiple
+  axpy.
+*/
+static void ClassicalGramSchmidtReorth(TacsScalar *h, TACSVec *q,
+                                       TACSVec **w, int nvecs) {
+  ClassicalGramSchmidt(h, q, w, nvecs);
+
+  TacsScalar *c = new TacsScalar[nvecs];
+  ClassicalGramSchmidt(c, q, w, nvecs);
+  for (int j = 0; j < nvecs; j++) {
+    h[j] += c[j];
   }
+  delete[] c;
 }
 
 /*
@@ -599,6 +889,7 @@ void GMRES::init(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart,
   for (int i = 0; i < msub + 1; i++) {
     W[i] = mat->createVec();
     W[i]->incref();
+    W[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
   }
 
   if (isFlexible) {
@@ -606,6 +897,7 @@ void GMRES::init(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart,
     for (int i = 0; i < msub; i++) {
       Z[i] = mat->createVec();
       Z[i]->incref();
+      Z[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
     }
   } else if (pc) {
     // Allocate the work array
@@ -746,13 +1038,19 @@ void GMRES::setMonitor(KSMPrint *_monitor) {
 
 /*
   Set the type of orthogonalization to use. This will be either
-  classical Gram-Schmidt or modified Gram-Schmidt (default).
+  classical Gram-Schmidt, modified Gram-Schmidt (default) or classical
+  Gram-Schmidt with reorthogonalization.
 
-  Unless you have a good reason, you should use modified Gram-Schmidt.
+  Unless you have a good reason, you should use modified Gram-Schmidt
+  or, for large subspaces in parallel, classical Gram-Schmidt with
+  reorthogonalization, which is as stable but uses two reductions per
+  iteration instead of one for each vector in the subspace.
 */
 void GMRES::setOrthoType(enum OrthoType otype) {
   if (otype == CLASSICAL_GRAM_SCHMIDT) {
     orthogonalize = ClassicalGramSchmidt;
+  } else if (otype == CLASSICAL_GRAM_SCHMIDT_REORTH) {
+    orthogonalize = ClassicalGramSchmidtReorth;
   } else {
     orthogonalize = ModifiedGramSchmidt;
   }
@@ -783,16 +1081,14 @@ const char *GMRES::gmresName = "GMRES";
   solve_flag: flag for the whether the solve terminated successfully
 */
 int GMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  TACSProfileScope scope("GMRES::solve");
   TacsScalar rhs_norm = 0.0;
   int solve_flag = 0;
   iterCount = 0;
 
   double t_pc = 0.0, t_ortho = 0.0;
-  double t_total = 0.0;
-
-  if (monitor_time) {
-    t_total = MPI_Wtime();
-  }
+  double t_total = MPI_Wtime();
+  KSMIterStats stats = {0.0, 0.0, 0.0, 1};
 
   for (int count = 0; count < nrestart + 1; count++) {
     // Compute the residual
@@ -813,7 +1109,9 @@ int GMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
     }
 
     if (monitor) {
-      monitor->printResidual(0, fabs(TacsRealPart(res[0])));
+      stats.pc_time = stats.mat_time = stats.orth_time = 0.0;
+      stats.num_reductions = 1;
+      monitor->printIteration(0, fabs(TacsRealPart(res[0])), &stats);
     }
 
     if (count == 0) {
@@ -829,32 +1127,41 @@ int GMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
     }
 
     for (int i = 0; i < msub; i++) {
-      if (monitor_time) {
-        t_pc -= MPI_Wtime();
-      }
+      double t0 = MPI_Wtime(), t1 = t0;
       if (isFlexible) {
         // Apply the preconditioner, Z[i] = M^{-1} W[i]
         pc->applyFactor(W[i], Z[i]);
+        t1 = MPI_Wtime();
         mat->mult(Z[i], W[i + 1]);  // W[i+1] = A*Z[i] = A*M^{-1}*W[i]
       } else {
         if (pc) {
           // Apply the preconditioner, work = M^{-1} W[i]
           pc->applyFactor(W[i], work);
+          t1 = MPI_Wtime();
           mat->mult(work, W[i + 1]);  // W[i+1] = A*work = A*M^{-1}*W[i]
         } else {
           mat->mult(W[i], W[i + 1]);  // Compute W[i+1] = A*W[i]
         }
       }
-      if (monitor_time) {
-        double t0 = MPI_Wtime();
-        t_pc += t0;
-        t_ortho -= t0;
-      }
+      double t2 = MPI_Wtime();
 
       // Build the orthogonal basis using MGS
       orthogonalize(&H[Hptr[i]], W[i + 1], W, i + 1);
-      if (monitor_time) {
-        t_ortho += MPI_Wtime();
+      double t3 = MPI_Wtime();
+      t_pc += t2 - t0;
+      t_ortho += t3 - t2;
+
+      // Classical Gram-Schmidt uses a single reduction for each pass,
+      // modified Gram-Schmidt one for each vector, plus one for the norm
+      stats.pc_time = t1 - t0;
+      stats.mat_time = t2 - t1;
+      stats.orth_time = t3 - t2;
+      if (orthogonalize == ClassicalGramSchmidt) {
+        stats.num_reductions = 2;
+      } else if (orthogonalize == ClassicalGramSchmidtReorth) {
+        stats.num_reductions = 3;
+      } else {
+        stats.num_reductions = i + 2;
       }
 
       H[i + 1 + Hptr[i]] = W[i + 1]->norm();  // H[i+1,i] = || W[i+1] ||
@@ -891,7 +1198,7 @@ int GMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
       resNorm = fabs(res[i + 1]);
 
       if (monitor) {
-        monitor->printResidual(i + 1, resNorm);
+        monitor->printIteration(i + 1, resNorm, &stats);
       }
 
       if (TacsRealPart(resNorm) < atol ||
@@ -941,8 +1248,12 @@ int GMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
     }
   }
 
+  t_total = MPI_Wtime() - t_total;
+  if (monitor) {
+    monitor->endSolve(iterCount, resNorm, solve_flag, t_total);
+  }
+
   if (monitor_time && monitor) {
-    t_total = MPI_Wtime() - t_total;
     char str_mat[80], str_ort[80], str_tot[80];
     sprintf(str_mat, "pc-mat time %10.6f\n", t_pc);
     sprintf(str_ort, "ortho time  %10.6f\n", t_ortho);
@@ -956,180 +1267,174 @@ int GMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
 }
 
 /*
-  Create the GCROT linear system solver
-
-  This constructor creates an object that uses a simplified variant of
-  GCROT described by Hicken and Zingg.
+  The ratio of the squared norm after orthogonalization to the squared
+  norm before orthogonalization below which the norm is computed
+  directly instead of from the dot products. Below this ratio, the
+  cancellation in the norm and the division by the small norm in the
+  pipelined recurrence lose too much accuracy.
+*/
+static const double TACS_KSM_CANCELLATION_TOL = 1e-4;
 
-  input:
-  mat:        the matrix operator
-  pc:         the preconditioner
-  outer:      the number of outer vectors
-  max_outer:  the maximum number of outer iterations before we give up
-  msub:       the size of the underlying GMRES (FGMRES) subspace
-  isFlexible: flag to indicate required use of flexible GCROT
+/*
+  Apply the existing Givens rotations to the new column h of the
+  Hessenberg matrix, compute the new rotation and update the residual.
+  The new residual norm is returned.
 */
-GCROT::GCROT(TACSMat *_mat, TACSPc *_pc, int _outer, int _max_outer, int _msub,
-             int _isFlexible) {
-  init(_mat, _pc, _outer, _max_outer, _msub, _isFlexible);
+static TacsScalar KSMApplyGivens(int i, TacsScalar *h, TacsScalar *Qsin,
+                                 TacsScalar *Qcos, TacsScalar *res) {
+  // Apply the existing part of Q to the new components of
+  // the Hessenberg matrix
+  TacsScalar h1, h2;
+  for (int k = 0; k < i; k++) {
+    h1 = h[k];
+    h2 = h[k + 1];
+    h[k] = h1 * Qcos[k] + h2 * Qsin[k];
+    h[k + 1] = -h1 * Qsin[k] + h2 * Qcos[k];
+  }
+
+  // Now, compute the rotation for the new column that was just added
+  h1 = h[i];
+  h2 = h[i + 1];
+  TacsScalar sq = sqrt(h1 * h1 + h2 * h2);
+
+  Qcos[i] = h1 / sq;
+  Qsin[i] = h2 / sq;
+  h[i] = h1 * Qcos[i] + h2 * Qsin[i];
+  h[i + 1] = -h1 * Qsin[i] + h2 * Qcos[i];
+
+  // Update the residual
+  h1 = res[i];
+  res[i] = h1 * Qcos[i];
+  res[i + 1] = -h1 * Qsin[i];
+
+  return fabs(res[i + 1]);
 }
 
 /*
-  Create the GCROT linear system solver without a preconditioner. Note
-  that this variant is never flexible.
+  Compute the weights of the Arnoldi vectors from the upper triangular
+  Hessenberg matrix and add the right-preconditioned update to x.
 */
-GCROT::GCROT(TACSMat *_mat, int _outer, int _max_outer, int _msub) {
-  init(_mat, NULL, _outer, _max_outer, _msub, 0);
+static void KSMUpdateSolution(int niters, TacsScalar *H, const int *Hptr,
+                              TacsScalar *res, TACSVec **W, TACSPc *pc,
+                              TACSVec *work, TACSVec *x) {
+  // Compute the weights
+  for (int i = niters - 1; i >= 0; i--) {
+    for (int j = i + 1; j < niters; j++) {
+      res[i] = res[i] - H[i + Hptr[j]] * res[j];
+    }
+    res[i] = res[i] / H[i + Hptr[i]];
+  }
+
+  // Compute the linear combination
+  if (!pc) {
+    for (int i = 0; i < niters; i++) {
+      x->axpy(res[i], W[i]);
+    }
+  } else {
+    work->zeroEntries();
+    for (int i = 0; i < niters; i++) {
+      work->axpy(res[i], W[i]);
+    }
+
+    // Apply M^{-1} to the linear combination
+    pc->applyFactor(work, W[0]);
+    x->axpy(1.0, W[0]);
+  }
 }
 
 /*
-  Initialize the GCROT data.
+  Create the pipelined GMRES object
 
-  This allocates all the vectors required for the underlying subspace.
-  After initialization, no new significant memory allocation is
-  required.
+  input:
+  mat:        the matrix operator
+  pc:         the preconditioner (possibly NULL)
+  m:          the size of the Krylov subspace
+  nrestart:   the number of restarts before we give up
 */
-void GCROT::init(TACSMat *_mat, TACSPc *_pc, int _outer, int _max_outer,
-                 int _msub, int _isFlexible) {
+PipelinedGMRES::PipelinedGMRES(TACSMat *_mat, TACSPc *_pc, int _m,
+                               int _nrestart) {
   monitor = NULL;
-  msub = _msub;              // Size of the F/GMRES subspace
-  outer = _outer;            // Number of outer iterations
-  max_outer = _max_outer;    // Maximum number of outer iterations
-  isFlexible = _isFlexible;  // Flexible variant?
+  msub = (_m > 1 ? _m : 1);
+  nrestart = (_nrestart >= 0 ? _nrestart : 0);
 
   mat = _mat;
   pc = _pc;
   mat->incref();
-
   if (pc) {
     pc->incref();
-  } else {
-    // If there's no Pc then it doesn't have to be a flexible variant
-    isFlexible = 0;
   }
 
   // Set default absolute and relative tolerances
   rtol = 1e-8;
   atol = 1e-30;
 
-  // Allocate the subspace of vectors
-  Z = NULL;  // Required only for flexible GMRES
+  // Allocate the Arnoldi vectors and their products
   W = new TACSVec *[msub + 1];
-
+  Z = new TACSVec *[msub + 1];
   for (int i = 0; i < msub + 1; i++) {
     W[i] = mat->createVec();
     W[i]->incref();
+    W[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    Z[i] = mat->createVec();
+    Z[i]->incref();
+    Z[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
   }
+  dvecs = new TACSVec *[msub + 1];
 
-  if (isFlexible) {
-    Z = new TACSVec *[msub];
-
-    for (int i = 0; i < msub; i++) {
-      Z[i] = mat->createVec();
-      Z[i]->incref();
-    }
-  }
-
-  R = mat->createVec();
-  c_hat = mat->createVec();
-  u_hat = mat->createVec();
-
-  R->incref();
-  c_hat->incref();
-  u_hat->incref();
-
-  U = new TACSVec *[outer];
-  C = new TACSVec *[outer];
-
-  for (int i = 0; i < outer; i++) {
-    U[i] = mat->createVec();
-    U[i]->incref();
-    C[i] = mat->createVec();
-    C[i]->incref();
-  }
+  q = mat->createVec();
+  q->incref();
+  work = mat->createVec();
+  work->incref();
 
   // Allocate space for the Hessenberg matrix
-  // This is a (msub+1) x msub matrix with non-zeros
-  // on and above the first diagonal below the main diagonal
   Hptr = new int[msub + 1];
   Hptr[0] = 0;
-
   for (int i = 0; i < msub; i++) {
     Hptr[i + 1] = Hptr[i] + i + 2;
   }
 
   int size = Hptr[msub];
-  H = new TacsScalar[size];        // The Hessenberg matrix
-  res = new TacsScalar[msub + 1];  // The residual
-  B = new TacsScalar[msub * outer];
-
+  H = new TacsScalar[size];
+  res = new TacsScalar[msub + 1];
   memset(H, 0, size * sizeof(TacsScalar));
   memset(res, 0, (msub + 1) * sizeof(TacsScalar));
-  memset(B, 0, msub * outer * sizeof(TacsScalar));
 
-  // Allocate the terms that represent the unitary Q matrix
-  // in the QR factorixation of H
   Qsin = new TacsScalar[msub];
   Qcos = new TacsScalar[msub];
-
   memset(Qsin, 0, msub * sizeof(TacsScalar));
   memset(Qcos, 0, msub * sizeof(TacsScalar));
 }
 
 /*
-  Delete the object and free all the data
+  Free the data/memory allocated by the pipelined GMRES object
 */
-GCROT::~GCROT() {
+PipelinedGMRES::~PipelinedGMRES() {
   mat->decref();
-
   if (pc) {
     pc->decref();
   }
-
-  R->decref();
-  u_hat->decref();
-  c_hat->decref();
-
-  for (int i = 0; i < outer; i++) {
-    if (U[i]) {
-      U[i]->decref();
-    }
-    if (C[i]) {
-      C[i]->decref();
-    }
-  }
-
-  delete[] U;
-  delete[] C;
-
-  if (Z) {
-    for (int i = 0; i < msub; i++) {
-      Z[i]->decref();
-    }
-    delete[] Z;
+  if (monitor) {
+    monitor->decref();
   }
 
   for (int i = 0; i < msub + 1; i++) {
     W[i]->decref();
+    Z[i]->decref();
   }
   delete[] W;
-
-  if (monitor) {
-    monitor->decref();
-  }
+  delete[] Z;
+  delete[] dvecs;
+  q->decref();
+  work->decref();
 
   delete[] H;
   delete[] Hptr;
   delete[] res;
-  delete[] B;
   delete[] Qsin;
   delete[] Qcos;
 }
 
-/*
-  Set the matrix/preconditioner operators used for GCROT
-*/
-void GCROT::setOperators(TACSMat *_mat, TACSPc *_pc) {
+void PipelinedGMRES::setOperators(TACSMat *_mat, TACSPc *_pc) {
   if (_mat) {
     _mat->incref();
     if (mat) {
@@ -1146,10 +1451,7 @@ void GCROT::setOperators(TACSMat *_mat, TACSPc *_pc) {
   }
 }
 
-/*
-  Retrieve the matrix/preconditioner operators set in the GCROT object
-*/
-void GCROT::getOperators(TACSMat **_mat, TACSPc **_pc) {
+void PipelinedGMRES::getOperators(TACSMat **_mat, TACSPc **_pc) {
   if (_mat) {
     *_mat = mat;
   }
@@ -1158,18 +1460,12 @@ void GCROT::getOperators(TACSMat **_mat, TACSPc **_pc) {
   }
 }
 
-/*
-  Set the relative and absolute convergence tolerances for GCROT
-*/
-void GCROT::setTolerances(double _rtol, double _atol) {
+void PipelinedGMRES::setTolerances(double _rtol, double _atol) {
   rtol = _rtol;
   atol = _atol;
 }
 
-/*
-  Set the residual/solution monitor object
-*/
-void GCROT::setMonitor(KSMPrint *_monitor) {
+void PipelinedGMRES::setMonitor(KSMPrint *_monitor) {
   _monitor->incref();
   if (monitor) {
     monitor->decref();
@@ -1177,266 +1473,2594 @@ void GCROT::setMonitor(KSMPrint *_monitor) {
   monitor = _monitor;
 }
 
-const char *GCROT::getObjectName() { return gcrotName; }
+const char *PipelinedGMRES::getObjectName() { return gmresName; }
 
-const char *GCROT::gcrotName = "GCROT";
+const char *PipelinedGMRES::gmresName = "PipelinedGMRES";
 
 /*
-  Solve the linear system defined by the matrix operator with the
-  given (possibly flexible) preconditioner
+  Compute out = A*M^{-1}*in, or out = A*in without a preconditioner
+*/
+void PipelinedGMRES::applyOperator(TACSVec *in, TACSVec *out) {
+  if (pc) {
+    pc->applyFactor(in, work);
+    mat->mult(work, out);
+  } else {
+    mat->mult(in, out);
+  }
+}
+
+/*
+  Try to solve the linear system using pipelined GMRES.
 
   input:
-  b:          the input right-hand-side
-  x:          the solution vector
-  zero_guess: flag to treat x as an initial guess or zero
+  b:          the right-hand-side
+  x:          the solution vector (with possibly significant entries)
+  zero_guess: flag to indicate whether to zero entries of x before solution
 
   output:
   solve_flag: flag for the whether the solve terminated successfully
 */
-int GCROT::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+int PipelinedGMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  TACSProfileScope scope("PipelinedGMRES::solve");
   TacsScalar rhs_norm = 0.0;
   int solve_flag = 0;
-  int mat_iters = 0;
   iterCount = 0;
 
-  // Compute the residual
-  if (zero_guess) {
-    // If the initial guess is zero
-    x->zeroEntries();  // Set x = 0
-    R->copyValues(b);  // R = b
-  } else {
-    // If the initial guess is non-zero or restarting
-    mat->mult(x, R);  // R = A*x
-    mat_iters++;
-    R->axpy(-1.0, b);  // R = A*x - b
-    R->scale(-1.0);    // R = b - A*x0
-  }
+  for (int count = 0; count < nrestart + 1; count++) {
+    // Compute the residual
+    if (zero_guess && count == 0) {
+      x->zeroEntries();
+      W[0]->copyValues(b);
 
-  rhs_norm = R->norm();  // The initial residual
-  resNorm = rhs_norm;
+      res[0] = W[0]->norm();
+      W[0]->scale(1.0 / res[0]);  // W[0] = b/|| b ||
+    } else {
+      mat->mult(x, W[0]);
+      W[0]->axpy(-1.0, b);  // W[0] = A*x - b
 
-  if (TacsRealPart(rhs_norm) < atol) {
-    solve_flag = 1;
-    return solve_flag;
-  }
+      res[0] = W[0]->norm();
+      W[0]->scale(-1.0 / res[0]);  // W[0] = (b - A*x)/|| b - A*x ||
+    }
 
-  for (int count = 0; count < max_outer; count++) {
-    // Size of the U/C subspaces
-    int outer_size = (count < outer ? count : outer);  // min(count, outer);
-    int niters = 0;  // The size of the Hessenberg matrix
+    if (monitor) {
+      monitor->printResidual(0, fabs(TacsRealPart(res[0])));
+    }
 
-    W[0]->copyValues(R);  // W[0] = R
-    res[0] = W[0]->norm();
-    W[0]->scale(1.0 / res[0]);  // W[0] = b/|| b ||
+    if (count == 0) {
+      rhs_norm = res[0];  // The initial residual
+      resNorm = rhs_norm;
+    }
 
-    if (monitor) {
-      monitor->printResidual(mat_iters, resNorm);
+    int niters = 0;  // Keep track of the size of the Hessenberg matrix
+
+    if (TacsRealPart(res[0]) < atol) {
+      solve_flag = 1;
+      break;
     }
 
-    // The inner F/GMRES loop
-    for (int i = 0; i < msub; i++) {
-      if (isFlexible) {
-        // Apply the preconditioner, Z[i] = M^{-1} W[i]
-        pc->applyFactor(W[i], Z[i]);
-        mat->mult(Z[i], W[i + 1]);  // W[i+1] = A*Z[i] = A*M^{-1}*W[i]
-      } else {
-        if (pc) {
-          // Use u_hat here as a temporary array
-          // Apply the preconditioner, work = M^{-1} W[i]
-          pc->applyFactor(W[i], u_hat);
-          mat->mult(u_hat, W[i + 1]);  // W[i+1] = A*work = A*M^{-1}*W[i]
-        } else {
-          mat->mult(W[i], W[i + 1]);  // Compute W[i+1] = A*W[i]
-        }
-      }
-      mat_iters++;
+    // Z[0] = A*M^{-1}*W[0]
+    applyOperator(W[0], Z[0]);
 
-      // First, orthonormalize W[i+1] w.r.t.
-      // the basis C[j] j = 0 .. outer_size-1 B is (outer_size, msub)
-      for (int j = 0; j < outer_size; j++) {
-        B[j * msub + i] = W[i + 1]->dot(C[j]);  // B[j,i] = dot( W[i+1], C[j] )
-        W[i + 1]->axpy(-B[j * msub + i],
-                       C[j]);  // W[i+1] = W[i+1] - B[j,i]*C[j]
+    for (int i = 0; i < msub; i++) {
+      // Start the reduction for the dot products of Z[i] with the
+      // Arnoldi vectors and with itself. The last entry is the
+      // squared norm of Z[i].
+      TacsScalar *h = &H[Hptr[i]];
+      for (int j = 0; j <= i; j++) {
+        dvecs[j] = W[j];
       }
-
-      // Build expand the orthogonal basis using MGS
-      for (int j = i; j >= 0; j--) {
-        H[j + Hptr[i]] = W[i + 1]->dot(W[j]);   // H[j,i] = dot( W[i+1], W[i] )
-        W[i + 1]->axpy(-H[j + Hptr[i]], W[j]);  // W[i+1] = W[i+1] - H[j,i]*W[j]
+      dvecs[i + 1] = Z[i];
+      Z[i]->mdotBegin(dvecs, h, i + 2);
+
+      // Compute q = A*M^{-1}*Z[i] while the reduction is in flight.
+      // This is not needed on the last iteration.
+      int has_next = (i < msub - 1);
+      if (has_next) {
+        applyOperator(Z[i], q);
       }
 
-      H[i + 1 + Hptr[i]] = W[i + 1]->norm();  // H[i+1,i] = || W[i+1] ||
-      W[i + 1]->scale(1.0 /
-                      H[i + 1 + Hptr[i]]);  // W[i+1] = W[i+1]/|| W[i+1] ||
+      Z[i]->mdotEnd(h, i + 2);
 
-      // Apply the existing part of Q to the new components of
-      // the Hessenberg matrix
-      TacsScalar h1, h2;
-      for (int k = 0; k < i; k++) {
-        h1 = H[k + Hptr[i]];
-        h2 = H[k + 1 + Hptr[i]];
-        H[k + Hptr[i]] = h1 * Qcos[k] + h2 * Qsin[k];
-        H[k + 1 + Hptr[i]] = -h1 * Qsin[k] + h2 * Qcos[k];
+      // Form the new Arnoldi vector with classical Gram-Schmidt
+      W[i + 1]->copyValues(Z[i]);
+      TacsScalar hsum = 0.0;
+      for (int j = 0; j <= i; j++) {
+        W[i + 1]->axpy(-h[j], W[j]);
+        hsum += h[j] * h[j];
       }
 
-      // Now, compute the rotation for the new column that was just added
-      h1 = H[i + Hptr[i]];
-      h2 = H[i + 1 + Hptr[i]];
-      TacsScalar sq = sqrt(h1 * h1 + h2 * h2);
+      // Compute H[i+1,i] from the norm of Z[i]
+      int direct = 0;
+      TacsScalar znorm = h[i + 1];
+      TacsScalar hnorm = znorm - hsum;
+      if (TacsRealPart(hnorm) >
+          TACS_KSM_CANCELLATION_TOL * TacsRealPart(znorm)) {
+        h[i + 1] = sqrt(hnorm);
+      } else {
+        h[i + 1] = W[i + 1]->norm();
+        direct = 1;
+      }
 
-      Qcos[i] = h1 / sq;
-      Qsin[i] = h2 / sq;
-      H[i + Hptr[i]] = h1 * Qcos[i] + h2 * Qsin[i];
-      H[i + 1 + Hptr[i]] = -h1 * Qsin[i] + h2 * Qcos[i];
+      if (TacsRealPart(h[i + 1]) != 0.0) {
+        W[i + 1]->scale(1.0 / h[i + 1]);
+      }
 
-      // Update the residual
-      h1 = res[i];
-      // h2 = res[i+1]; = 0
-      res[i] = h1 * Qcos[i];
-      res[i + 1] = -h1 * Qsin[i];
+      // Compute Z[i+1] = A*M^{-1}*W[i+1] from the recurrence
+      if (has_next) {
+        if (direct) {
+          applyOperator(W[i + 1], Z[i + 1]);
+        } else {
+          Z[i + 1]->copyValues(q);
+          for (int j = 0; j <= i; j++) {
+            Z[i + 1]->axpy(-h[j], Z[j]);
+          }
+          if (TacsRealPart(h[i + 1]) != 0.0) {
+            Z[i + 1]->scale(1.0 / h[i + 1]);
+          }
+        }
+      }
 
+      resNorm = KSMApplyGivens(i, h, Qsin, Qcos, res);
       niters++;
 
-      resNorm = fabs(res[i + 1]);
-
       if (monitor) {
-        monitor->printResidual(mat_iters, resNorm);
+        monitor->printResidual(i + 1, resNorm);
       }
+
       if (TacsRealPart(resNorm) < atol ||
           TacsRealPart(resNorm) < rtol * TacsRealPart(rhs_norm)) {
-        // Set the solve flag
         solve_flag = 1;
-
         break;
       }
     }
+
     iterCount += niters;
 
-    // Now, compute the solution - the linear combination of the
+    // Compute the solution from the linear combination of the
     // Arnoldi vectors
-    // H is now upper triangular
+    KSMUpdateSolution(niters, H, Hptr, res, W, pc, work, x);
 
-    // Compute the weights
-    for (int i = niters - 1; i >= 0; i--) {
-      // Compute res[i] = res[i] - H[i,j]*res[j];
-      for (int j = i + 1; j < niters; j++) {
-        res[i] = res[i] - H[i + Hptr[j]] * res[j];
-      }
-      res[i] = res[i] / H[i + Hptr[i]];
+    if (solve_flag) {
+      break;
     }
+  }
 
-    // u_hat = Z*y - U*B*y
-    // where y = the weights computed from the inner GMRES loop above
+  return solve_flag;
+}
 
-    // Compute the linear combination
-    if (isFlexible) {  // Flexible variant
-      u_hat->zeroEntries();
-      for (int i = 0; i < niters; i++) {
-        u_hat->axpy(res[i], Z[i]);
-      }
-    } else if (!pc) {  // If there's no pc
-      u_hat->zeroEntries();
-      for (int i = 0; i < niters; i++) {
-        u_hat->axpy(res[i], W[i]);
-      }
-    } else {  // If the pc isn't flexible
-      // Use c_hat here as a temporary array
-      c_hat->zeroEntries();
-      for (int i = 0; i < niters; i++) {
-        c_hat->axpy(res[i], W[i]);
-      }
+/*
+  Create the s-step GMRES object
 
-      // Apply u_hat = M^{-1} c_hat to the linear combination
-      pc->applyFactor(c_hat, u_hat);
-    }
+  input:
+  mat:        the matrix operator
+  pc:         the preconditioner (possibly NULL)
+  m:          the size of the Krylov subspace
+  nrestart:   the number of restarts before we give up
+  s:          the number of vectors generated between reductions
+*/
+SStepGMRES::SStepGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart,
+                       int _s) {
+  monitor = NULL;
+  msub = (_m > 1 ? _m : 1);
+  nrestart = (_nrestart >= 0 ? _nrestart : 0);
+  sstep = (_s > 1 ? _s : 1);
+  if (sstep > msub) {
+    sstep = msub;
+  }
 
-    // Now complete u_hat by computing u_hat = u_hat - U*B*y
-    // Here y = res
-    // Note that B is (outer_size,msub)
-    for (int i = 0; i < outer_size; i++) {
-      TacsScalar bsum = TacsScalar(0.0);
-      for (int j = 0; j < niters; j++) {
-        bsum = bsum + B[i * msub + j] * res[j];
-      }
+  mat = _mat;
+  pc = _pc;
+  mat->incref();
+  if (pc) {
+    pc->incref();
+  }
 
-      u_hat->axpy(-bsum, U[i]);
-    }
+  // Set default absolute and relative tolerances
+  rtol = 1e-8;
+  atol = 1e-30;
 
-    c_hat->zeroEntries();
+  // Allocate the subspace of vectors
+  W = new TACSVec *[msub + 1];
+  for (int i = 0; i < msub + 1; i++) {
+    W[i] = mat->createVec();
+    W[i]->incref();
+    W[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+  }
+  work = mat->createVec();
+  work->incref();
 
-    // Compute c_hat = W*H*y
-    // The Hessenberg matrix has been modified by pre-multiplying by Q
-    // now, undo these rotations and multiply by Q^{T}
-    for (int i = 0; i < niters; i++) {
-      TacsScalar h1, h2;
-      for (int k = i; k >= 0; k--) {
-        h1 = H[k + Hptr[i]];
-        h2 = H[k + 1 + Hptr[i]];
-        H[k + Hptr[i]] = h1 * Qcos[k] - h2 * Qsin[k];
-        H[k + 1 + Hptr[i]] = h1 * Qsin[k] + h2 * Qcos[k];
-      }
-    }
+  // Allocate space for the Hessenberg matrix
+  Hptr = new int[msub + 1];
+  Hptr[0] = 0;
+  for (int i = 0; i < msub; i++) {
+    Hptr[i + 1] = Hptr[i] + i + 2;
+  }
+
+  int size = Hptr[msub];
+  H = new TacsScalar[size];
+  Hraw = new TacsScalar[size];
+  res = new TacsScalar[msub + 1];
+  memset(H, 0, size * sizeof(TacsScalar));
+  memset(Hraw, 0, size * sizeof(TacsScalar));
+  memset(res, 0, (msub + 1) * sizeof(TacsScalar));
+
+  // The dot products of each of the s new vectors with the whole
+  // basis, the Cholesky factor and the new Hessenberg columns
+  G = new TacsScalar[sstep * (msub + 1)];
+  R = new TacsScalar[sstep * sstep];
+  shifts = new TacsScalar[sstep];
+  memset(shifts, 0, sstep * sizeof(TacsScalar));
+  Hnew = new TacsScalar[sstep * (msub + 1)];
+
+  Qsin = new TacsScalar[msub];
+  Qcos = new TacsScalar[msub];
+  memset(Qsin, 0, msub * sizeof(TacsScalar));
+  memset(Qcos, 0, msub * sizeof(TacsScalar));
+}
+
+/*
+  Free the data/memory allocated by the s-step GMRES object
+*/
+SStepGMRES::~SStepGMRES() {
+  mat->decref();
+  if (pc) {
+    pc->decref();
+  }
+  if (monitor) {
+    monitor->decref();
+  }
+
+  for (int i = 0; i < msub + 1; i++) {
+    W[i]->decref();
+  }
+  delete[] W;
+  work->decref();
+
+  delete[] H;
+  delete[] Hraw;
+  delete[] Hptr;
+  delete[] res;
+  delete[] G;
+  delete[] R;
+  delete[] shifts;
+  delete[] Hnew;
+  delete[] Qsin;
+  delete[] Qcos;
+}
+
+void SStepGMRES::setOperators(TACSMat *_mat, TACSPc *_pc) {
+  if (_mat) {
+    _mat->incref();
+    if (mat) {
+      mat->decref();
+    }
+    mat = _mat;
+  }
+  if (_pc) {
+    _pc->incref();
+    if (pc) {
+      pc->decref();
+    }
+    pc = _pc;
+  }
+}
+
+void SStepGMRES::getOperators(TACSMat **_mat, TACSPc **_pc) {
+  if (_mat) {
+    *_mat = mat;
+  }
+  if (_pc) {
+    *_pc = pc;
+  }
+}
+
+void SStepGMRES::setTolerances(double _rtol, double _atol) {
+  rtol = _rtol;
+  atol = _atol;
+}
+
+void SStepGMRES::setMonitor(KSMPrint *_monitor) {
+  _monitor->incref();
+  if (monitor) {
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
+
+const char *SStepGMRES::getObjectName() { return gmresName; }
+
+const char *SStepGMRES::gmresName = "SStepGMRES";
+
+/*
+  Compute out = A*M^{-1}*in, or out = A*in without a preconditioner
+*/
+void SStepGMRES::applyOperator(TACSVec *in, TACSVec *out) {
+  if (pc) {
+    pc->applyFactor(in, work);
+    mat->mult(work, out);
+  } else {
+    mat->mult(in, out);
+  }
+}
+
+/*
+  Try to solve the linear system using s-step GMRES.
+
+  Each block starts from the last Arnoldi vector W[k] and computes the
+  basis vectors K[j] = (A*M^{-1} - shifts[j]*I) K[j-1] in W[k+1+j] for
+  j = 0,...,p-1. The dot products of each K[j] with all the vectors
+  W[0],...,W[k+p] are computed with p reductions that are all started
+  before any of them is completed, so that only a single latency is
+  incurred. The dot products give
+
+  C = Q^{T} K  and  K^{T} K - C^{T} C = R^{T} R
+
+  where Q = [W[0],...,W[k]]. The orthonormal vectors are then
+  Qn = (K - Q C) R^{-1}. Since A*M^{-1}*B = K + B*diag(shifts) with
+  B = [W[k], K[0], ... K[p-2]], the new columns of the Hessenberg
+  matrix are found from the coefficients of B and K in the new basis
+  and the existing columns of the Hessenberg matrix.
+
+  input:
+  b:          the right-hand-side
+  x:          the solution vector (with possibly significant entries)
+  zero_guess: flag to indicate whether to zero entries of x before solution
+
+  output:
+  solve_flag: flag for the whether the solve terminated successfully
+*/
+int SStepGMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  TACSProfileScope scope("SStepGMRES::solve");
+  TacsScalar rhs_norm = 0.0;
+  int solve_flag = 0;
+  iterCount = 0;
+
+  for (int count = 0; count < nrestart + 1; count++) {
+    // Compute the residual
+    if (zero_guess && count == 0) {
+      x->zeroEntries();
+      W[0]->copyValues(b);
+
+      res[0] = W[0]->norm();
+      W[0]->scale(1.0 / res[0]);  // W[0] = b/|| b ||
+    } else {
+      mat->mult(x, W[0]);
+      W[0]->axpy(-1.0, b);  // W[0] = A*x - b
+
+      res[0] = W[0]->norm();
+      W[0]->scale(-1.0 / res[0]);  // W[0] = (b - A*x)/|| b - A*x ||
+    }
+
+    if (monitor) {
+      monitor->printResidual(0, fabs(TacsRealPart(res[0])));
+    }
+
+    if (count == 0) {
+      rhs_norm = res[0];  // The initial residual
+      resNorm = rhs_norm;
+    }
+
+    int niters = 0;  // Keep track of the size of the Hessenberg matrix
+
+    if (TacsRealPart(res[0]) < atol) {
+      solve_flag = 1;
+      break;
+    }
+
+    for (int k = 0; k < msub && !solve_flag;) {
+      // Generate the shifted basis vectors in W[k+1],...,W[k+p]
+      int p = (k + sstep <= msub ? sstep : msub - k);
+      for (int j = 0; j < p; j++) {
+        applyOperator(W[k + j], W[k + 1 + j]);
+        W[k + 1 + j]->axpy(-shifts[j], W[k + j]);
+      }
+
+      // Compute all the dot products for the block
+      const int nd = k + 1 + p;
+      for (int j = 0; j < p; j++) {
+        W[k + 1 + j]->mdotBegin(W, &G[nd * j], nd);
+      }
+      for (int j = 0; j < p; j++) {
+        W[k + 1 + j]->mdotEnd(&G[nd * j], nd);
+      }
+
+      // Compute the Cholesky factorization of the projected Gram
+      // matrix. R is stored by column with R(l, j) = R[l + sstep*j].
+      int nvalid = p;
+      for (int j = 0; j < p; j++) {
+        const TacsScalar *Cj = &G[nd * j];
+        for (int l = 0; l <= j; l++) {
+          const TacsScalar *Cl = &G[nd * l];
+          TacsScalar d = Cj[k + 1 + l];
+          for (int r = 0; r <= k; r++) {
+            d -= Cl[r] * Cj[r];
+          }
+          for (int r = 0; r < l; r++) {
+            d -= R[r + sstep * l] * R[r + sstep * j];
+          }
+          if (l < j) {
+            R[l + sstep * j] = d / R[l + sstep * l];
+          } else if (TacsRealPart(d) >
+                     TACS_KSM_CANCELLATION_TOL * TacsRealPart(Cj[k + 1 + j])) {
+            R[j + sstep * j] = sqrt(d);
+          } else {
+            nvalid = j;
+          }
+        }
+        if (nvalid < p) {
+          break;
+        }
+      }
+
+      // Truncate the block at the first vector that is numerically
+      // dependent. The norm of this vector is computed directly.
+      if (nvalid < p) {
+        p = nvalid + 1;
+      }
+
+      // Form the orthonormal vectors Qn = (K - Q*C)*R^{-1} in place
+      for (int j = 0; j < p; j++) {
+        TACSVec *v = W[k + 1 + j];
+        const TacsScalar *Cj = &G[nd * j];
+        for (int r = 0; r <= k; r++) {
+          v->axpy(-Cj[r], W[r]);
+        }
+        for (int l = 0; l < j; l++) {
+          v->axpy(-R[l + sstep * j], W[k + 1 + l]);
+        }
+        if (j == nvalid) {
+          R[j + sstep * j] = v->norm();
+        }
+        if (TacsRealPart(R[j + sstep * j]) != 0.0) {
+          v->scale(1.0 / R[j + sstep * j]);
+        }
+      }
+
+      // Compute the right-hand-side for the new Hessenberg columns
+      // Ta + Tb*diag(shifts) - H_old*Tb, where column j of Ta contains
+      // the coefficients of K[j], and Tb contains the coefficients of B.
+      const int ldh = k + 1 + p;
+      for (int j = 0; j < p; j++) {
+        TacsScalar *hj = &Hnew[ldh * j];
+        const TacsScalar *Cj = &G[nd * j];
+        for (int r = 0; r < ldh; r++) {
+          hj[r] = 0.0;
+        }
+        for (int r = 0; r <= k; r++) {
+          hj[r] = Cj[r];
+        }
+        for (int l = 0; l <= j; l++) {
+          hj[k + 1 + l] = R[l + sstep * j];
+        }
+
+        // Add the shifted term, A*M^{-1}*B[j] = K[j] + shifts[j]*B[j].
+        // B[j] = K[j-1] for j > 0 also has components along the
+        // existing Arnoldi vectors W[0],...,W[k-1].
+        if (j == 0) {
+          hj[k] += shifts[0];
+        } else {
+          const TacsScalar *Cb = &G[nd * (j - 1)];
+          for (int r = 0; r <= k; r++) {
+            hj[r] += shifts[j] * Cb[r];
+          }
+          for (int l = 0; l < j; l++) {
+            hj[k + 1 + l] += shifts[j] * R[l + sstep * (j - 1)];
+          }
+          for (int c = 0; c < k; c++) {
+            const TacsScalar *hc = &Hraw[Hptr[c]];
+            for (int r = 0; r <= c + 1; r++) {
+              hj[r] -= hc[r] * Cb[c];
+            }
+          }
+        }
+      }
+
+      // Solve Hn*Tb_sq = rhs, where Tb_sq are the coefficients of B
+      // along W[k],...,W[k+p-1]. Tb_sq is upper triangular with
+      // Tb_sq(0, j) = C(k, j-1) and Tb_sq(l, j) = R(l-1, j-1).
+      for (int j = 1; j < p; j++) {
+        TacsScalar *hj = &Hnew[ldh * j];
+        for (int l = 0; l < j; l++) {
+          const TacsScalar *hl = &Hnew[ldh * l];
+          TacsScalar t = (l == 0 ? G[nd * (j - 1) + k]
+                                 : R[(l - 1) + sstep * (j - 1)]);
+          for (int r = 0; r <= k + 1 + l; r++) {
+            hj[r] -= hl[r] * t;
+          }
+        }
+        TacsScalar diag = R[(j - 1) + sstep * (j - 1)];
+        for (int r = 0; r < ldh; r++) {
+          hj[r] /= diag;
+        }
+      }
+
+      // Add the new columns to the Hessenberg matrix and update the
+      // QR factorization, checking for convergence after each column
+      for (int j = 0; j < p; j++) {
+        int i = k + j;
+        for (int r = 0; r <= i + 1; r++) {
+          Hraw[Hptr[i] + r] = Hnew[ldh * j + r];
+          H[Hptr[i] + r] = Hnew[ldh * j + r];
+        }
+
+        // Use the diagonal of the Hessenberg matrix as the shifts for
+        // the next block
+        shifts[j] = Hraw[Hptr[i] + i];
+
+        resNorm = KSMApplyGivens(i, &H[Hptr[i]], Qsin, Qcos, res);
+        niters++;
+
+        if (monitor) {
+          monitor->printResidual(i + 1, resNorm);
+        }
+
+        if (TacsRealPart(resNorm) < atol ||
+            TacsRealPart(resNorm) < rtol * TacsRealPart(rhs_norm)) {
+          solve_flag = 1;
+          break;
+        }
+      }
+
+      k += p;
+    }
+
+    iterCount += niters;
+
+    // Compute the solution from the linear combination of the
+    // Arnoldi vectors
+    KSMUpdateSolution(niters, H, Hptr, res, W, pc, work, x);
+
+    if (solve_flag) {
+      break;
+    }
+  }
+
+  return solve_flag;
+}
+
+/*
+  Create the GCROT linear system solver
+
+  This constructor creates an object that uses a simplified variant of
+  GCROT described by Hicken and Zingg.
+
+  input:
+  mat:        the matrix operator
+  pc:         the preconditioner
+  outer:      the number of outer vectors
+  max_outer:  the maximum number of outer iterations before we give up
+  msub:       the size of the underlying GMRES (FGMRES) subspace
+  isFlexible: flag to indicate required use of flexible GCROT
+*/
+GCROT::GCROT(TACSMat *_mat, TACSPc *_pc, int _outer, int _max_outer, int _msub,
+             int _isFlexible) {
+  init(_mat, _pc, _outer, _max_outer, _msub, _isFlexible);
+}
+
+/*
+  Create the GCROT linear system solver without a preconditioner. Note
+  that this variant is never flexible.
+*/
+GCROT::GCROT(TACSMat *_mat, int _outer, int _max_outer, int _msub) {
+  init(_mat, NULL, _outer, _max_outer, _msub, 0);
+}
+
+/*
+  Initialize the GCROT data.
+
+  This allocates all the vectors required for the underlying subspace.
+  After initialization, no new significant memory allocation is
+  required.
+*/
+void GCROT::init(TACSMat *_mat, TACSPc *_pc, int _outer, int _max_outer,
+                 int _msub, int _isFlexible) {
+  monitor = NULL;
+  msub = _msub;              // Size of the F/GMRES subspace
+  outer = _outer;            // Number of outer iterations
+  max_outer = _max_outer;    // Maximum number of outer iterations
+  isFlexible = _isFlexible;  // Flexible variant?
+
+  mat = _mat;
+  pc = _pc;
+  mat->incref();
+
+  if (pc) {
+    pc->incref();
+  } else {
+    // If there's no Pc then it doesn't have to be a flexible variant
+    isFlexible = 0;
+  }
+
+  // Set default absolute and relative tolerances
+  rtol = 1e-8;
+  atol = 1e-30;
+
+  // Allocate the subspace of vectors
+  Z = NULL;  // Required only for flexible GMRES
+  W = new TACSVec *[msub + 1];
+
+  for (int i = 0; i < msub + 1; i++) {
+    W[i] = mat->createVec();
+    W[i]->incref();
+    W[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+  }
+
+  if (isFlexible) {
+    Z = new TACSVec *[msub];
+
+    for (int i = 0; i < msub; i++) {
+      Z[i] = mat->createVec();
+      Z[i]->incref();
+      Z[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    }
+  }
+
+  R = mat->createVec();
+  c_hat = mat->createVec();
+  u_hat = mat->createVec();
+
+  R->incref();
+  c_hat->incref();
+  u_hat->incref();
+
+  U = new TACSVec *[outer];
+  C = new TACSVec *[outer];
+
+  for (int i = 0; i < outer; i++) {
+    U[i] = mat->createVec();
+    U[i]->incref();
+    U[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    C[i] = mat->createVec();
+    C[i]->incref();
+    C[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+  }
+
+  // Allocate space for the Hessenberg matrix
+  // This is a (msub+1) x msub matrix with non-zeros
+  // on and above the first diagonal below the main diagonal
+  Hptr = new int[msub + 1];
+  Hptr[0] = 0;
+
+  for (int i = 0; i < msub; i++) {
+    Hptr[i + 1] = Hptr[i] + i + 2;
+  }
+
+  int size = Hptr[msub];
+  H = new TacsScalar[size];        // The Hessenberg matrix
+  res = new TacsScalar[msub + 1];  // The residual
+  B = new TacsScalar[msub * outer];
+
+  memset(H, 0, size * sizeof(TacsScalar));
+  memset(res, 0, (msub + 1) * sizeof(TacsScalar));
+  memset(B, 0, msub * outer * sizeof(TacsScalar));
+
+  // Allocate the terms that represent the unitary Q matrix
+  // in the QR factorixation of H
+  Qsin = new TacsScalar[msub];
+  Qcos = new TacsScalar[msub];
+
+  memset(Qsin, 0, msub * sizeof(TacsScalar));
+  memset(Qcos, 0, msub * sizeof(TacsScalar));
+}
+
+/*
+  Delete the object and free all the data
+*/
+GCROT::~GCROT() {
+  mat->decref();
+
+  if (pc) {
+    pc->decref();
+  }
+
+  R->decref();
+  u_hat->decref();
+  c_hat->decref();
+
+  for (int i = 0; i < outer; i++) {
+    if (U[i]) {
+      U[i]->decref();
+    }
+    if (C[i]) {
+      C[i]->decref();
+    }
+  }
+
+  delete[] U;
+  delete[] C;
+
+  if (Z) {
+    for (int i = 0; i < msub; i++) {
+      Z[i]->decref();
+    }
+    delete[] Z;
+  }
+
+  for (int i = 0; i < msub + 1; i++) {
+    W[i]->decref();
+  }
+  delete[] W;
+
+  if (monitor) {
+    monitor->decref();
+  }
+
+  delete[] H;
+  delete[] Hptr;
+  delete[] res;
+  delete[] B;
+  delete[] Qsin;
+  delete[] Qcos;
+}
+
+/*
+  Set the matrix/preconditioner operators used for GCROT
+*/
+void GCROT::setOperators(TACSMat *_mat, TACSPc *_pc) {
+  if (_mat) {
+    _mat->incref();
+    if (mat) {
+      mat->decref();
+    }
+    mat = _mat;
+  }
+  if (_pc) {
+    _pc->incref();
+    if (pc) {
+      pc->decref();
+    }
+    pc = _pc;
+  }
+}
+
+/*
+  Retrieve the matrix/preconditioner operators set in the GCROT object
+*/
+void GCROT::getOperators(TACSMat **_mat, TACSPc **_pc) {
+  if (_mat) {
+    *_mat = mat;
+  }
+  if (_pc) {
+    *_pc = pc;
+  }
+}
+
+/*
+  Set the relative and absolute convergence tolerances for GCROT
+*/
+void GCROT::setTolerances(double _rtol, double _atol) {
+  rtol = _rtol;
+  atol = _atol;
+}
+
+/*
+  Set the residual/solution monitor object
+*/
+void GCROT::setMonitor(KSMPrint *_monitor) {
+  _monitor->incref();
+  if (monitor) {
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
+
+const char *GCROT::getObjectName() { return gcrotName; }
+
+const char *GCROT::gcrotName = "GCROT";
+
+/*
+  Solve the linear system defined by the matrix operator with the
+  given (possibly flexible) preconditioner
+
+  input:
+  b:          the input right-hand-side
+  x:          the solution vector
+  zero_guess: flag to treat x as an initial guess or zero
+
+  output:
+  solve_flag: flag for the whether the solve terminated successfully
+*/
+int GCROT::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  TACSProfileScope scope("GCROT::solve");
+  TacsScalar rhs_norm = 0.0;
+  int solve_flag = 0;
+  int mat_iters = 0;
+  iterCount = 0;
+
+  // Compute the residual
+  if (zero_guess) {
+    // If the initial guess is zero
+    x->zeroEntries();  // Set x = 0
+    R->copyValues(b);  // R = b
+  } else {
+    // If the initial guess is non-zero or restarting
+    mat->mult(x, R);  // R = A*x
+    mat_iters++;
+    R->axpy(-1.0, b);  // R = A*x - b
+    R->scale(-1.0);    // R = b - A*x0
+  }
+
+  rhs_norm = R->norm();  // The initial residual
+  resNorm = rhs_norm;
+
+  if (TacsRealPart(rhs_norm) < atol) {
+    solve_flag = 1;
+    return solve_flag;
+  }
+
+  for (int count = 0; count < max_outer; count++) {
+    // Size of the U/C subspaces
+    int outer_size = (count < outer ? count : outer);  // min(count, outer);
+    int niters = 0;  // The size of the Hessenberg matrix
+
+    W[0]->copyValues(R);  // W[0] = R
+    res[0] = W[0]->norm();
+    W[0]->scale(1.0 / res[0]);  // W[0] = b/|| b ||
+
+    if (monitor) {
+      monitor->printResidual(mat_iters, resNorm);
+    }
+
+    // The inner F/GMRES loop
+    for (int i = 0; i < msub; i++) {
+      if (isFlexible) {
+        // Apply the preconditioner, Z[i] = M^{-1} W[i]
+        pc->applyFactor(W[i], Z[i]);
+        mat->mult(Z[i], W[i + 1]);  // W[i+1] = A*Z[i] = A*M^{-1}*W[i]
+      } else {
+        if (pc) {
+          // Use u_hat here as a temporary array
+          // Apply the preconditioner, work = M^{-1} W[i]
+          pc->applyFactor(W[i], u_hat);
+          mat->mult(u_hat, W[i + 1]);  // W[i+1] = A*work = A*M^{-1}*W[i]
+        } else {
+          mat->mult(W[i], W[i + 1]);  // Compute W[i+1] = A*W[i]
+        }
+      }
+      mat_iters++;
+
+      // First, orthonormalize W[i+1] w.r.t.
+      // the basis C[j] j = 0 .. outer_size-1 B is (outer_size, msub)
+      for (int j = 0; j < outer_size; j++) {
+        B[j * msub + i] = W[i + 1]->dot(C[j]);  // B[j,i] = dot( W[i+1], C[j] )
+        W[i + 1]->axpy(-B[j * msub + i],
+                       C[j]);  // W[i+1] = W[i+1] - B[j,i]*C[j]
+      }
+
+      // Build expand the orthogonal basis using MGS
+      for (int j = i; j > 0; j--) {
+        H[j + Hptr[i]] = W[i + 1]->dot(W[j]);   // H[j,i] = dot( W[i+1], W[i] )
+        W[i + 1]->axpy(-H[j + Hptr[i]], W[j]);  // W[i+1] = W[i+1] - H[j,i]*W[j]
+      }
+
+      // Fuse the last update with the norm, H[i+1,i] = || W[i+1] ||
+      H[Hptr[i]] = W[i + 1]->dot(W[0]);
+      H[i + 1 + Hptr[i]] = W[i + 1]->axpyNorm(-H[Hptr[i]], W[0]);
+      W[i + 1]->scale(1.0 /
+                      H[i + 1 + Hptr[i]]);  // W[i+1] = W[i+1]/|| W[i+1] ||
+
+      // Apply the existing part of Q to the new components of
+      // the Hessenberg matrix
+      TacsScalar h1, h2;
+      for (int k = 0; k < i; k++) {
+        h1 = H[k + Hptr[i]];
+        h2 = H[k + 1 + Hptr[i]];
+        H[k + Hptr[i]] = h1 * Qcos[k] + h2 * Qsin[k];
+        H[k + 1 + Hptr[i]] = -h1 * Qsin[k] + h2 * Qcos[k];
+      }
+
+      // Now, compute the rotation for the new column that was just added
+      h1 = H[i + Hptr[i]];
+      h2 = H[i + 1 + Hptr[i]];
+      TacsScalar sq = sqrt(h1 * h1 + h2 * h2);
+
+      Qcos[i] = h1 / sq;
+      Qsin[i] = h2 / sq;
+      H[i + Hptr[i]] = h1 * Qcos[i] + h2 * Qsin[i];
+      H[i + 1 + Hptr[i]] = -h1 * Qsin[i] + h2 * Qcos[i];
+
+      // Update the residual
+      h1 = res[i];
+      // h2 = res[i+1]; = 0
+      res[i] = h1 * Qcos[i];
+      res[i + 1] = -h1 * Qsin[i];
+
+      niters++;
+
+      resNorm = fabs(res[i + 1]);
+
+      if (monitor) {
+        monitor->printResidual(mat_iters, resNorm);
+      }
+      if (TacsRealPart(resNorm) < atol ||
+          TacsRealPart(resNorm) < rtol * TacsRealPart(rhs_norm)) {
+        // Set the solve flag
+        solve_flag = 1;
+
+        break;
+      }
+    }
+    iterCount += niters;
+
+    // Now, compute the solution - the linear combination of the
+    // Arnoldi vectors
+    // H is now upper triangular
+
+    // Compute the weights
+    for (int i = niters - 1; i >= 0; i--) {
+      // Compute res[i] = res[i] - H[i,j]*res[j];
+      for (int j = i + 1; j < niters; j++) {
+        res[i] = res[i] - H[i + Hptr[j]] * res[j];
+      }
+      res[i] = res[i] / H[i + Hptr[i]];
+    }
+
+    // u_hat = Z*y - U*B*y
+    // where y = the weights computed from the inner GMRES loop above
+
+    // Compute the linear combination
+    if (isFlexible) {  // Flexible variant
+      u_hat->zeroEntries();
+      for (int i = 0; i < niters; i++) {
+        u_hat->axpy(res[i], Z[i]);
+      }
+    } else if (!pc) {  // If there's no pc
+      u_hat->zeroEntries();
+      for (int i = 0; i < niters; i++) {
+        u_hat->axpy(res[i], W[i]);
+      }
+    } else {  // If the pc isn't flexible
+      // Use c_hat here as a temporary array
+      c_hat->zeroEntries();
+      for (int i = 0; i < niters; i++) {
+        c_hat->axpy(res[i], W[i]);
+      }
+
+      // Apply u_hat = M^{-1} c_hat to the linear combination
+      pc->applyFactor(c_hat, u_hat);
+    }
+
+    // Now complete u_hat by computing u_hat = u_hat - U*B*y
+    // Here y = res
+    // Note that B is (outer_size,msub)
+    for (int i = 0; i < outer_size; i++) {
+      TacsScalar bsum = TacsScalar(0.0);
+      for (int j = 0; j < niters; j++) {
+        bsum = bsum + B[i * msub + j] * res[j];
+      }
+
+      u_hat->axpy(-bsum, U[i]);
+    }
+
+    c_hat->zeroEntries();
+
+    // Compute c_hat = W*H*y
+    // The Hessenberg matrix has been modified by pre-multiplying by Q
+    // now, undo these rotations and multiply by Q^{T}
+    for (int i = 0; i < niters; i++) {
+      TacsScalar h1, h2;
+      for (int k = i; k >= 0; k--) {
+        h1 = H[k + Hptr[i]];
+        h2 = H[k + 1 + Hptr[i]];
+        H[k + Hptr[i]] = h1 * Qcos[k] - h2 * Qsin[k];
+        H[k + 1 + Hptr[i]] = h1 * Qsin[k] + h2 * Qcos[k];
+      }
+    }
 
     // The matrix H is (niters+1) by (niters) // H[i,j] = H[i + Hptr[j]]
     // y = the variables res is niters
     for (int i = 0; i < niters + 1; i++) {
-      TacsScalar hsum = TacsScalar(0.0);
-      int j = i - 1;
-      if (i == 0) {
-        j = 0;
+      TacsScalar hsum = TacsScalar(0.0);
+      int j = i - 1;
+      if (i == 0) {
+        j = 0;
+      }
+
+      // hsum = hsum + H[i,j]*res[j]
+      for (; j < niters; j++) {
+        hsum += H[i + Hptr[j]] * res[j];
+      }
+
+      c_hat->axpy(hsum, W[i]);
+    }
+
+    TacsScalar cnorm = c_hat->norm();
+    c_hat->scale(1.0 / cnorm);
+    u_hat->scale(1.0 / cnorm);
+
+    // Update the residual and solution
+    TacsScalar alpha = R->dot(c_hat);
+    R->axpy(-alpha, c_hat);
+    x->axpy(alpha, u_hat);
+
+    // Compute the residual and compare...
+    // mat->mult( x, R );      // R = A*x
+    // R->axpy( -1.0, b );     // R = A*x - b
+    // R->scale( -1.0 );
+
+    if (solve_flag) {
+      break;
+    }
+
+    // Now, prepend c_hat and u_hat to C and U respectively.
+    // All this is done with pointers - no copying actually occurs.
+    // Otherwise, discard the oldest vector -
+    // but use it for the 'new' u_hat/c_hat
+    TACSVec *u = u_hat;
+    TACSVec *c = c_hat;
+
+    // This is the size of the subspace on the next iteration
+    outer_size = (count + 1 < outer ? count + 1 : outer);
+
+    for (int i = 0; i < outer_size; i++) {
+      TACSVec *tu = U[i];
+      TACSVec *tc = C[i];
+
+      U[i] = u;
+      C[i] = c;
+
+      u = tu;
+      c = tc;
+    }
+
+    u_hat = u;
+    c_hat = c;
+  }
+
+  return solve_flag;
+}
+
+/*
+  Create the GCRO-DR linear system solver
+
+  input:
+  mat:       the matrix operator
+  pc:        the preconditioner (may be NULL)
+  msub:      the size of the GMRES subspace in each cycle
+  nrecycle:  the number of vectors in the recycled subspace
+  nrestart:  the maximum number of restart cycles
+*/
+GCRODR::GCRODR(TACSMat *_mat, TACSPc *_pc, int _msub, int _nrecycle,
+               int _nrestart) {
+  monitor = NULL;
+  msub = (_msub < 1 ? 1 : _msub);
+  nrecycle = (_nrecycle < 0 ? 0 : _nrecycle);
+  nrestart = _nrestart;
+  nU = 0;
+
+  mat = _mat;
+  pc = _pc;
+  mat->incref();
+  if (pc) {
+    pc->incref();
+  }
+
+  // Set default absolute and relative tolerances
+  rtol = 1e-8;
+  atol = 1e-30;
+
+  // Allocate the Arnoldi vectors. The preconditioned vectors are only
+  // required when there is a preconditioner.
+  W = new TACSVec *[msub + 1];
+  for (int i = 0; i < msub + 1; i++) {
+    W[i] = mat->createVec();
+    W[i]->incref();
+    W[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+  }
+
+  Z = W;
+  if (pc) {
+    Z = new TACSVec *[msub];
+    for (int i = 0; i < msub; i++) {
+      Z[i] = mat->createVec();
+      Z[i]->incref();
+      Z[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    }
+  }
+
+  // Allocate the recycled subspace
+  U = new TACSVec *[nrecycle];
+  C = new TACSVec *[nrecycle];
+  Ut = new TACSVec *[nrecycle];
+  Ct = new TACSVec *[nrecycle];
+  for (int i = 0; i < nrecycle; i++) {
+    U[i] = mat->createVec();
+    U[i]->incref();
+    U[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    C[i] = mat->createVec();
+    C[i]->incref();
+    C[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    Ut[i] = mat->createVec();
+    Ut[i]->incref();
+    Ut[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    Ct[i] = mat->createVec();
+    Ct[i]->incref();
+    Ct[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+  }
+
+  R = mat->createVec();
+  R->incref();
+
+  // Allocate the dense (msub+1) x msub Hessenberg matrices
+  H = new TacsScalar[(msub + 1) * msub];
+  Hq = new TacsScalar[(msub + 1) * msub];
+  B = new TacsScalar[(nrecycle + 1) * msub];
+  res = new TacsScalar[msub + 1];
+  Qsin = new TacsScalar[msub];
+  Qcos = new TacsScalar[msub];
+
+  memset(H, 0, (msub + 1) * msub * sizeof(TacsScalar));
+  memset(Hq, 0, (msub + 1) * msub * sizeof(TacsScalar));
+  memset(B, 0, (nrecycle + 1) * msub * sizeof(TacsScalar));
+  memset(res, 0, (msub + 1) * sizeof(TacsScalar));
+  memset(Qsin, 0, msub * sizeof(TacsScalar));
+  memset(Qcos, 0, msub * sizeof(TacsScalar));
+}
+
+/*
+  Delete the object and free all the data
+*/
+GCRODR::~GCRODR() {
+  mat->decref();
+  if (pc) {
+    pc->decref();
+  }
+
+  for (int i = 0; i < msub + 1; i++) {
+    W[i]->decref();
+  }
+  if (Z != W) {
+    for (int i = 0; i < msub; i++) {
+      Z[i]->decref();
+    }
+    delete[] Z;
+  }
+  delete[] W;
+
+  for (int i = 0; i < nrecycle; i++) {
+    U[i]->decref();
+    C[i]->decref();
+    Ut[i]->decref();
+    Ct[i]->decref();
+  }
+  delete[] U;
+  delete[] C;
+  delete[] Ut;
+  delete[] Ct;
+
+  R->decref();
+
+  if (monitor) {
+    monitor->decref();
+  }
+
+  delete[] H;
+  delete[] Hq;
+  delete[] B;
+  delete[] res;
+  delete[] Qsin;
+  delete[] Qcos;
+}
+
+/*
+  Set the matrix/preconditioner operators used for GCRO-DR
+
+  The recycled subspace is retained, and C = A*U is recomputed with the
+  new matrix at the start of the next solve.
+*/
+void GCRODR::setOperators(TACSMat *_mat, TACSPc *_pc) {
+  if (_mat) {
+    _mat->incref();
+    if (mat) {
+      mat->decref();
+    }
+    mat = _mat;
+  }
+  if (_pc && pc) {
+    _pc->incref();
+    pc->decref();
+    pc = _pc;
+  }
+}
+
+/*
+  Retrieve the matrix/preconditioner operators set in the GCRO-DR object
+*/
+void GCRODR::getOperators(TACSMat **_mat, TACSPc **_pc) {
+  if (_mat) {
+    *_mat = mat;
+  }
+  if (_pc) {
+    *_pc = pc;
+  }
+}
+
+/*
+  Set the relative and absolute convergence tolerances for GCRO-DR
+*/
+void GCRODR::setTolerances(double _rtol, double _atol) {
+  rtol = _rtol;
+  atol = _atol;
+}
+
+/*
+  Set the residual/solution monitor object
+*/
+void GCRODR::setMonitor(KSMPrint *_monitor) {
+  _monitor->incref();
+  if (monitor) {
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
+
+const char *GCRODR::getObjectName() { return gcrodrName; }
+
+const char *GCRODR::gcrodrName = "GCRODR";
+
+/*
+  Get the vectors that span the current recycled subspace
+
+  output:
+  U:  the array of recycled vectors
+
+  returns: the number of vectors in the recycled subspace
+*/
+int GCRODR::getRecycleSpace(TACSVec ***_U) {
+  if (_U) {
+    *_U = U;
+  }
+  return nU;
+}
+
+/*
+  Set the recycled subspace from the given vectors
+
+  The values are copied. Only the first nrecycle vectors are used.
+
+  input:
+  num:  the number of vectors
+  U:    the vectors that span the subspace
+*/
+void GCRODR::setRecycleSpace(int num, TACSVec **_U) {
+  nU = 0;
+  for (int i = 0; i < num && nU < nrecycle; i++) {
+    if (_U[i]) {
+      U[nU]->copyValues(_U[i]);
+      nU++;
+    }
+  }
+}
+
+/*
+  Discard the recycled subspace
+*/
+void GCRODR::clearRecycleSpace() { nU = 0; }
+
+/*
+  Write the recycled subspace to a set of binary files
+
+  Each vector is written with TACSBVec::writeToFile to a file named
+  prefix_<i>.bin. The files can only be read back in on the same
+  number of processors with the same variable distribution.
+
+  input:
+  prefix:  the prefix for the file names
+
+  returns: fail flag
+*/
+int GCRODR::writeRecycleSpace(const char *prefix) {
+  char *fname = new char[strlen(prefix) + 32];
+  int fail = 0;
+  for (int i = 0; i < nU && !fail; i++) {
+    TACSBVec *vec = dynamic_cast<TACSBVec *>(U[i]);
+    if (!vec) {
+      fprintf(stderr, "GCRODR: Recycled vectors must be TACSBVec objects\n");
+      fail = 1;
+      break;
+    }
+    snprintf(fname, strlen(prefix) + 32, "%s_%d.bin", prefix, i);
+    fail = vec->writeToFile(fname);
+  }
+
+  delete[] fname;
+  return fail;
+}
+
+/*
+  Read the recycled subspace from the files written by
+  writeRecycleSpace()
+
+  Files are read in order until a file cannot be read, or the
+  recycled subspace is full.
+
+  input:
+  prefix:  the prefix for the file names
+
+  returns: the number of vectors read
+*/
+int GCRODR::readRecycleSpace(const char *prefix) {
+  char *fname = new char[strlen(prefix) + 32];
+  nU = 0;
+  for (int i = 0; i < nrecycle; i++) {
+    TACSBVec *vec = dynamic_cast<TACSBVec *>(U[i]);
+    if (!vec) {
+      fprintf(stderr, "GCRODR: Recycled vectors must be TACSBVec objects\n");
+      break;
+    }
+    snprintf(fname, strlen(prefix) + 32, "%s_%d.bin", prefix, i);
+
+    // Check whether the file exists before it is opened collectively
+    int rank, exists = 0;
+    MPI_Comm_rank(vec->getMPIComm(), &rank);
+    if (rank == 0) {
+      FILE *fp = fopen(fname, "rb");
+      if (fp) {
+        exists = 1;
+        fclose(fp);
+      }
+    }
+    MPI_Bcast(&exists, 1, MPI_INT, 0, vec->getMPIComm());
+    if (!exists || vec->readFromFile(fname)) {
+      break;
+    }
+    nU++;
+  }
+
+  delete[] fname;
+  return nU;
+}
+
+/*
+  Compute C = A*U with the current operator and orthonormalize C with
+  modified Gram-Schmidt, applying the same operations to U so that
+  A*U = C still holds. Vectors that are linearly dependent on the
+  others are discarded.
+
+  returns: the number of matrix-vector products
+*/
+int GCRODR::updateRecycleSpace() {
+  for (int i = 0; i < nU; i++) {
+    mat->mult(U[i], C[i]);
+  }
+  int mat_iters = nU;
+
+  int k = 0;
+  for (int i = 0; i < nU; i++) {
+    TacsScalar cnorm = C[i]->norm();
+    for (int j = 0; j < k; j++) {
+      TacsScalar h = C[i]->dot(C[j]);
+      C[i]->axpy(-h, C[j]);
+      U[i]->axpy(-h, U[j]);
+    }
+
+    TacsScalar rnorm = C[i]->norm();
+    if (TacsRealPart(rnorm) > 1e-12 * TacsRealPart(cnorm) &&
+        TacsRealPart(rnorm) > 0.0) {
+      C[i]->scale(1.0 / rnorm);
+      U[i]->scale(1.0 / rnorm);
+
+      // Keep the vector by swapping it into position k
+      TACSVec *t = U[k];
+      U[k] = U[i];
+      U[i] = t;
+      t = C[k];
+      C[k] = C[i];
+      C[i] = t;
+      k++;
+    }
+  }
+  nU = k;
+
+  return mat_iters;
+}
+
+/*
+  Replace the recycled subspace with harmonic Ritz vectors
+
+  After a cycle with niters = m iterations, the Arnoldi relationship
+  is
+
+  A*[U, Z] = [C, W]*G,  G = [ I  B    ]
+                            [ 0  Hbar ]
+
+  where [C, W] has orthonormal columns. The harmonic Ritz vectors
+  y = [U, Z]*p satisfy the generalized eigenvalue problem
+
+  G^{T}*G*p = theta*G^{T}*[C, W]^{T}*[U, Z]*p
+
+  The vectors with the smallest |theta| approximate the eigenvectors
+  with the smallest eigenvalues in magnitude. The new subspace is
+  formed from these vectors, using the QR factorization G*P = Q*R so
+  that C = [C, W]*Q and U = [U, Z]*P*R^{-1}, without any additional
+  products with the matrix.
+*/
+void GCRODR::harvestRecycleSpace(int m) {
+  if (nrecycle <= 0 || m <= 0) {
+    return;
+  }
+
+  int k = nU;
+  int n = k + m;
+  int nw = n + 1;
+
+  // Set the vectors in the spaces [U, Z] and [C, W]
+  TACSVec **V = new TACSVec *[n];
+  TACSVec **Wh = new TACSVec *[nw];
+  for (int i = 0; i < k; i++) {
+    V[i] = U[i];
+    Wh[i] = C[i];
+  }
+  for (int i = 0; i < m; i++) {
+    V[k + i] = Z[i];
+  }
+  for (int i = 0; i < m + 1; i++) {
+    Wh[k + i] = W[i];
+  }
+
+  // Form the (n+1) x n matrix G in column-major order
+  TacsScalar *G = new TacsScalar[nw * n];
+  memset(G, 0, nw * n * sizeof(TacsScalar));
+  for (int i = 0; i < k; i++) {
+    G[i + i * nw] = 1.0;
+  }
+  for (int j = 0; j < m; j++) {
+    for (int i = 0; i < k; i++) {
+      G[i + (k + j) * nw] = B[i + j * nrecycle];
+    }
+    for (int i = 0; i <= j + 1; i++) {
+      G[k + i + (k + j) * nw] = H[i + j * (msub + 1)];
+    }
+  }
+
+  // Compute the inner products [C, W]^{T}*[U, Z]
+  TacsScalar *WV = new TacsScalar[nw * n];
+  for (int j = 0; j < n; j++) {
+    V[j]->mdot(Wh, &WV[j * nw], nw);
+  }
+
+  // Form the generalized eigenvalue problem. The eigenvalue problem
+  // only selects the subspace, so the real part is used for complex
+  // arithmetic.
+  double *A = new double[n * n];
+  double *Bm = new double[n * n];
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      double a = 0.0, b = 0.0;
+      for (int l = 0; l < nw; l++) {
+        a += TacsRealPart(G[l + i * nw]) * TacsRealPart(G[l + j * nw]);
+        b += TacsRealPart(G[l + i * nw]) * TacsRealPart(WV[l + j * nw]);
+      }
+      A[i + j * n] = a;
+      Bm[i + j * n] = b;
+    }
+  }
+
+  double *alphar = new double[n];
+  double *alphai = new double[n];
+  double *beta = new double[n];
+  double *vr = new double[n * n];
+  int lwork = 16 * n;
+  double *work = new double[lwork];
+  int info = 0;
+  LAPACKdggev("N", "V", &n, A, &n, Bm, &n, alphar, alphai, beta, NULL, &n, vr,
+              &n, work, &lwork, &info);
+
+  int *perm = new int[n];
+  double *theta = new double[n];
+  int nsel = 0;
+  if (info == 0) {
+    // Sort the finite harmonic Ritz values by magnitude
+    for (int i = 0; i < n; i++) {
+      if (fabs(beta[i]) > 0.0) {
+        theta[nsel] =
+            sqrt(alphar[i] * alphar[i] + alphai[i] * alphai[i]) / fabs(beta[i]);
+        perm[nsel] = i;
+        nsel++;
+      }
+    }
+    for (int i = 1; i < nsel; i++) {
+      double t = theta[i];
+      int p = perm[i];
+      int j = i;
+      for (; j > 0 && theta[j - 1] > t; j--) {
+        theta[j] = theta[j - 1];
+        perm[j] = perm[j - 1];
+      }
+      theta[j] = t;
+      perm[j] = p;
+    }
+  }
+  if (nsel > nrecycle) {
+    nsel = nrecycle;
+  }
+
+  // Copy the selected eigenvectors into P. For a complex conjugate
+  // pair, the two columns of vr store the real and imaginary parts,
+  // which span the same real subspace.
+  TacsScalar *P = new TacsScalar[n * nsel];
+  for (int j = 0; j < nsel; j++) {
+    for (int i = 0; i < n; i++) {
+      P[i + j * n] = vr[i + perm[j] * n];
+    }
+  }
+
+  // Compute Q = G*P and factor Q = Q*R with modified Gram-Schmidt,
+  // while computing P*R^{-1} in place
+  TacsScalar *Q = new TacsScalar[nw * nsel];
+  memset(Q, 0, nw * nsel * sizeof(TacsScalar));
+  for (int j = 0; j < nsel; j++) {
+    for (int l = 0; l < n; l++) {
+      for (int i = 0; i < nw; i++) {
+        Q[i + j * nw] += G[i + l * nw] * P[l + j * n];
+      }
+    }
+  }
+
+  int kk = 0;
+  for (int j = 0; j < nsel; j++) {
+    TacsScalar *q = &Q[j * nw];
+    TacsScalar *p = &P[j * n];
+    TacsScalar qnorm = 0.0;
+    for (int i = 0; i < nw; i++) {
+      qnorm += q[i] * q[i];
+    }
+    qnorm = sqrt(qnorm);
+
+    for (int l = 0; l < kk; l++) {
+      TacsScalar h = 0.0;
+      for (int i = 0; i < nw; i++) {
+        h += q[i] * Q[i + l * nw];
+      }
+      for (int i = 0; i < nw; i++) {
+        q[i] -= h * Q[i + l * nw];
+      }
+      for (int i = 0; i < n; i++) {
+        p[i] -= h * P[i + l * n];
+      }
+    }
+
+    TacsScalar rnorm = 0.0;
+    for (int i = 0; i < nw; i++) {
+      rnorm += q[i] * q[i];
+    }
+    rnorm = sqrt(rnorm);
+
+    // Discard the vector if it is linearly dependent
+    if (TacsRealPart(rnorm) > 1e-10 * TacsRealPart(qnorm) &&
+        TacsRealPart(rnorm) > 0.0) {
+      for (int i = 0; i < nw; i++) {
+        Q[i + kk * nw] = q[i] / rnorm;
+      }
+      for (int i = 0; i < n; i++) {
+        P[i + kk * n] = p[i] / rnorm;
+      }
+      kk++;
+    }
+  }
+
+  // Form the new subspace
+  for (int j = 0; j < kk; j++) {
+    Ct[j]->zeroEntries();
+    for (int i = 0; i < nw; i++) {
+      Ct[j]->axpy(Q[i + j * nw], Wh[i]);
+    }
+    Ut[j]->zeroEntries();
+    for (int i = 0; i < n; i++) {
+      Ut[j]->axpy(P[i + j * n], V[i]);
+    }
+  }
+
+  if (kk > 0) {
+    TACSVec **t = U;
+    U = Ut;
+    Ut = t;
+    t = C;
+    C = Ct;
+    Ct = t;
+    nU = kk;
+  }
+
+  delete[] V;
+  delete[] Wh;
+  delete[] G;
+  delete[] WV;
+  delete[] A;
+  delete[] Bm;
+  delete[] alphar;
+  delete[] alphai;
+  delete[] beta;
+  delete[] vr;
+  delete[] work;
+  delete[] perm;
+  delete[] theta;
+  delete[] P;
+  delete[] Q;
+}
+
+/*
+  Solve the linear system with GCRO-DR
+
+  input:
+  b:          the input right-hand-side
+  x:          the solution vector
+  zero_guess: flag to treat x as an initial guess or zero
+
+  output:
+  solve_flag: flag for the whether the solve terminated successfully
+*/
+int GCRODR::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  TACSProfileScope scope("GCRODR::solve");
+  int solve_flag = 0;
+  int mat_iters = 0;
+  iterCount = 0;
+
+  // Compute the residual
+  if (zero_guess) {
+    x->zeroEntries();
+    R->copyValues(b);
+  } else {
+    mat->mult(x, R);
+    mat_iters++;
+    R->axpby(1.0, -1.0, b);  // R = b - A*x
+  }
+
+  TacsScalar rhs_norm = R->norm();
+  resNorm = rhs_norm;
+
+  if (TacsRealPart(rhs_norm) < atol) {
+    solve_flag = 1;
+    return solve_flag;
+  }
+
+  // Update the recycled subspace for the current operator and project
+  // the residual onto the orthogonal complement of C
+  if (nU > 0) {
+    mat_iters += updateRecycleSpace();
+
+    R->mdot(C, res, nU);
+    for (int i = 0; i < nU; i++) {
+      x->axpy(res[i], U[i]);
+      R->axpy(-res[i], C[i]);
+    }
+    resNorm = R->norm();
+  }
+
+  const int ldh = msub + 1;
+  for (int count = 0; count < nrestart; count++) {
+    if (monitor) {
+      monitor->printResidual(mat_iters, resNorm);
+    }
+    if (TacsRealPart(resNorm) < atol ||
+        TacsRealPart(resNorm) < rtol * TacsRealPart(rhs_norm)) {
+      solve_flag = 1;
+      break;
+    }
+
+    int niters = 0;
+    res[0] = R->norm();
+    W[0]->copyValues(R);
+    W[0]->scale(1.0 / res[0]);
+
+    for (int i = 0; i < msub; i++) {
+      if (pc) {
+        pc->applyFactor(W[i], Z[i]);  // Z[i] = M^{-1}*W[i]
+      }
+      mat->mult(Z[i], W[i + 1]);  // W[i+1] = A*Z[i]
+      mat_iters++;
+
+      // Orthogonalize against the recycled subspace, B[:,i] = C^{T}*W[i+1]
+      if (nU > 0) {
+        W[i + 1]->mdot(C, &B[i * nrecycle], nU);
+        for (int j = 0; j < nU; j++) {
+          W[i + 1]->axpy(-B[j + i * nrecycle], C[j]);
+        }
+      }
+
+      // Orthonormalize against the Arnoldi vectors with MGS
+      for (int j = i; j > 0; j--) {
+        H[j + i * ldh] = W[i + 1]->dot(W[j]);
+        W[i + 1]->axpy(-H[j + i * ldh], W[j]);
+      }
+      H[i * ldh] = W[i + 1]->dot(W[0]);
+      H[i + 1 + i * ldh] = W[i + 1]->axpyNorm(-H[i * ldh], W[0]);
+      W[i + 1]->scale(1.0 / H[i + 1 + i * ldh]);
+
+      // Apply the existing rotations to a copy of the new column
+      TacsScalar *hq = &Hq[i * ldh];
+      memcpy(hq, &H[i * ldh], (i + 2) * sizeof(TacsScalar));
+      for (int k = 0; k < i; k++) {
+        TacsScalar h1 = hq[k];
+        TacsScalar h2 = hq[k + 1];
+        hq[k] = h1 * Qcos[k] + h2 * Qsin[k];
+        hq[k + 1] = -h1 * Qsin[k] + h2 * Qcos[k];
+      }
+
+      // Compute the rotation for the new column
+      TacsScalar h1 = hq[i];
+      TacsScalar h2 = hq[i + 1];
+      TacsScalar sq = sqrt(h1 * h1 + h2 * h2);
+      Qcos[i] = h1 / sq;
+      Qsin[i] = h2 / sq;
+      hq[i] = h1 * Qcos[i] + h2 * Qsin[i];
+      hq[i + 1] = 0.0;
+
+      // Update the residual
+      h1 = res[i];
+      res[i] = h1 * Qcos[i];
+      res[i + 1] = -h1 * Qsin[i];
+
+      niters++;
+      resNorm = fabs(res[i + 1]);
+
+      if (monitor) {
+        monitor->printResidual(mat_iters, resNorm);
+      }
+      if (TacsRealPart(resNorm) < atol ||
+          TacsRealPart(resNorm) < rtol * TacsRealPart(rhs_norm)) {
+        solve_flag = 1;
+        break;
+      }
+    }
+    iterCount += niters;
+
+    // Compute the weights y from the upper triangular system
+    for (int i = niters - 1; i >= 0; i--) {
+      for (int j = i + 1; j < niters; j++) {
+        res[i] -= Hq[i + j * ldh] * res[j];
+      }
+      res[i] = res[i] / Hq[i + i * ldh];
+    }
+
+    // Update the solution x = x + Z*y - U*B*y
+    for (int i = 0; i < niters; i++) {
+      x->axpy(res[i], Z[i]);
+    }
+    for (int j = 0; j < nU; j++) {
+      TacsScalar bsum = 0.0;
+      for (int i = 0; i < niters; i++) {
+        bsum += B[j + i * nrecycle] * res[i];
+      }
+      x->axpy(-bsum, U[j]);
+    }
+
+    // Update the residual R = R - W*Hbar*y
+    for (int i = 0; i < niters + 1; i++) {
+      TacsScalar hsum = 0.0;
+      for (int j = (i > 0 ? i - 1 : 0); j < niters; j++) {
+        hsum += H[i + j * ldh] * res[j];
+      }
+      R->axpy(-hsum, W[i]);
+    }
+
+    // Update the recycled subspace from this cycle
+    harvestRecycleSpace(niters);
+
+    if (solve_flag) {
+      break;
+    }
+  }
+
+  return solve_flag;
+}
+
+/*
+  Orthonormalize the vectors in place with two passes of classical
+  Gram-Schmidt. Vectors that are linearly dependent on the previous
+  vectors are moved to the end of the array.
+
+  input:
+  n:     the number of vectors
+  vecs:  the vectors
+  h:     a temporary array of length n
+
+  returns: the number of orthonormal vectors
+*/
+static int TacsOrthonormalize(int n, TACSVec **vecs, TacsScalar *h) {
+  int k = 0;
+  for (int j = 0; j < n; j++) {
+    TacsScalar norm0 = vecs[j]->norm();
+    for (int pass = 0; pass < 2 && k > 0; pass++) {
+      vecs[j]->mdot(vecs, h, k);
+      for (int i = 0; i < k; i++) {
+        vecs[j]->axpy(-h[i], vecs[i]);
+      }
+    }
+
+    TacsScalar vnorm = vecs[j]->norm();
+    if (TacsRealPart(vnorm) > 1e-10 * TacsRealPart(norm0) &&
+        TacsRealPart(vnorm) > 0.0) {
+      vecs[j]->scale(1.0 / vnorm);
+      TACSVec *t = vecs[k];
+      vecs[k] = vecs[j];
+      vecs[j] = t;
+      k++;
+    }
+  }
+
+  return k;
+}
+
+/*
+  Create the block GMRES object
+
+  input:
+  mat:        the matrix operator
+  pc:         the preconditioner (may be NULL)
+  m:          the number of block iterations before restarting
+  nrestart:   the maximum number of restarts
+  max_block:  the maximum number of right-hand-sides in each block
+*/
+BlockGMRES::BlockGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart,
+                       int _max_block) {
+  monitor = NULL;
+  msub = (_m < 1 ? 1 : _m);
+  nrestart = _nrestart;
+  max_block = (_max_block < 1 ? 1 : _max_block);
+  max_cols = msub * max_block;
+
+  mat = _mat;
+  pc = _pc;
+  mat->incref();
+  if (pc) {
+    pc->incref();
+  }
+
+  // Set default absolute and relative tolerances
+  rtol = 1e-8;
+  atol = 1e-30;
+
+  // Allocate the Arnoldi vectors
+  int nv = max_cols + max_block;
+  V = new TACSVec *[nv];
+  for (int i = 0; i < nv; i++) {
+    V[i] = mat->createVec();
+    V[i]->incref();
+    V[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+  }
+
+  Z = V;
+  if (pc) {
+    Z = new TACSVec *[max_cols];
+    for (int i = 0; i < max_cols; i++) {
+      Z[i] = mat->createVec();
+      Z[i]->incref();
+      Z[i]->setMemoryCategory(TACS_MEMORY_KRYLOV);
+    }
+  }
+
+  Rv = new TACSVec *[max_block];
+  Wt = new TACSVec *[max_block];
+  for (int i = 0; i < max_block; i++) {
+    Rv[i] = mat->createVec();
+    Rv[i]->incref();
+    Wt[i] = mat->createVec();
+    Wt[i]->incref();
+  }
+
+  H = new TacsScalar[nv * max_cols];
+  E = new TacsScalar[nv * max_block];
+
+  rot_ptr = new int[max_cols + 1];
+  rot_row = new int[max_cols * max_block];
+  rot_cos = new TacsScalar[max_cols * max_block];
+  rot_sin = new TacsScalar[max_cols * max_block];
+}
+
+/*
+  Free the block GMRES data
+*/
+BlockGMRES::~BlockGMRES() {
+  mat->decref();
+  if (pc) {
+    pc->decref();
+  }
+
+  for (int i = 0; i < max_cols + max_block; i++) {
+    V[i]->decref();
+  }
+  if (Z != V) {
+    for (int i = 0; i < max_cols; i++) {
+      Z[i]->decref();
+    }
+    delete[] Z;
+  }
+  delete[] V;
+
+  for (int i = 0; i < max_block; i++) {
+    Rv[i]->decref();
+    Wt[i]->decref();
+  }
+  delete[] Rv;
+  delete[] Wt;
+
+  if (monitor) {
+    monitor->decref();
+  }
+
+  delete[] H;
+  delete[] E;
+  delete[] rot_ptr;
+  delete[] rot_row;
+  delete[] rot_cos;
+  delete[] rot_sin;
+}
+
+/*
+  Set the matrix/preconditioner operators used for block GMRES
+*/
+void BlockGMRES::setOperators(TACSMat *_mat, TACSPc *_pc) {
+  if (_mat) {
+    _mat->incref();
+    if (mat) {
+      mat->decref();
+    }
+    mat = _mat;
+  }
+  if (_pc && pc) {
+    _pc->incref();
+    pc->decref();
+    pc = _pc;
+  }
+}
+
+/*
+  Retrieve the matrix/preconditioner operators
+*/
+void BlockGMRES::getOperators(TACSMat **_mat, TACSPc **_pc) {
+  if (_mat) {
+    *_mat = mat;
+  }
+  if (_pc) {
+    *_pc = pc;
+  }
+}
+
+/*
+  Set the relative and absolute convergence tolerances
+*/
+void BlockGMRES::setTolerances(double _rtol, double _atol) {
+  rtol = _rtol;
+  atol = _atol;
+}
+
+/*
+  Set the residual/solution monitor object
+*/
+void BlockGMRES::setMonitor(KSMPrint *_monitor) {
+  _monitor->incref();
+  if (monitor) {
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
+
+const char *BlockGMRES::getObjectName() { return blockGmresName; }
+
+const char *BlockGMRES::blockGmresName = "BlockGMRES";
+
+/*
+  Solve the linear system with a single right-hand-side
+*/
+int BlockGMRES::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  return solveBlock(1, &b, &x, zero_guess);
+}
+
+/*
+  Solve the linear systems A*x[i] = b[i] for several right-hand-sides
+
+  The right-hand-sides are solved in groups of at most max_block
+  vectors. On return, the iteration count is the total number of block
+  iterations, and the residual norm is the largest over all the
+  right-hand-sides.
+
+  input:
+  nrhs:       the number of right-hand-sides
+  b:          the right-hand-sides
+  x:          the solution vectors
+  zero_guess: flag to treat x as an initial guess or zero
+
+  returns: 1 if all the systems converged, 0 otherwise
+*/
+int BlockGMRES::solveMulti(int nrhs, TACSVec **b, TACSVec **x,
+                           int zero_guess) {
+  int flag = 1;
+  int iters = 0;
+  TacsScalar rnorm = 0.0;
+  for (int start = 0; start < nrhs; start += max_block) {
+    int nb = nrhs - start;
+    if (nb > max_block) {
+      nb = max_block;
+    }
+    if (!solveBlock(nb, &b[start], &x[start], zero_guess)) {
+      flag = 0;
+    }
+    iters += iterCount;
+    if (TacsRealPart(resNorm) > TacsRealPart(rnorm)) {
+      rnorm = resNorm;
+    }
+  }
+  iterCount = iters;
+  resNorm = rnorm;
+
+  return flag;
+}
+
+/*
+  Solve a block of at most max_block right-hand-sides
+*/
+int BlockGMRES::solveBlock(int nrhs, TACSVec **b, TACSVec **x,
+                           int zero_guess) {
+  TACSProfileScope scope("BlockGMRES::solveBlock");
+  int solve_flag = 0;
+  iterCount = 0;
+
+  const int ldh = max_cols + max_block;
+  TacsScalar *h = new TacsScalar[ldh];
+  TacsScalar *rhs_norm = new TacsScalar[nrhs];
+  int *active = new int[nrhs];
+  int *done = new int[nrhs];
+  TACSVec **xa = new TACSVec *[nrhs];
+  TACSVec **ra = new TACSVec *[nrhs];
+
+  // Compute the initial residuals
+  if (zero_guess) {
+    for (int i = 0; i < nrhs; i++) {
+      x[i]->zeroEntries();
+      Rv[i]->copyValues(b[i]);
+    }
+  } else {
+    mat->multMulti(nrhs, x, Rv);
+    for (int i = 0; i < nrhs; i++) {
+      Rv[i]->axpby(1.0, -1.0, b[i]);  // R = b - A*x
+    }
+  }
+
+  for (int i = 0; i < nrhs; i++) {
+    rhs_norm[i] = Rv[i]->norm();
+    done[i] = 0;
+    active[i] = i;
+  }
+  int na = nrhs;
+
+  for (int count = 0;; count++) {
+    if (count > 0) {
+      // Compute the true residuals of the active right-hand-sides
+      for (int j = 0; j < na; j++) {
+        xa[j] = x[active[j]];
+        ra[j] = Rv[active[j]];
+      }
+      mat->multMulti(na, xa, ra);
+      for (int j = 0; j < na; j++) {
+        ra[j]->axpby(1.0, -1.0, b[active[j]]);
       }
+    }
 
-      // hsum = hsum + H[i,j]*res[j]
-      for (; j < niters; j++) {
-        hsum += H[i + Hptr[j]] * res[j];
+    // Remove the right-hand-sides that have converged from the block
+    int nactive = 0;
+    TacsScalar rnorm = 0.0;
+    for (int j = 0; j < na; j++) {
+      int i = active[j];
+      TacsScalar rn = Rv[i]->norm();
+      if (TacsRealPart(rn) < atol ||
+          TacsRealPart(rn) < rtol * TacsRealPart(rhs_norm[i])) {
+        done[i] = 1;
+      } else {
+        active[nactive] = i;
+        nactive++;
+      }
+      if (TacsRealPart(rn) > TacsRealPart(rnorm)) {
+        rnorm = rn;
       }
+    }
+    na = nactive;
+    resNorm = rnorm;
 
-      c_hat->axpy(hsum, W[i]);
+    if (monitor) {
+      monitor->printResidual(iterCount, resNorm);
+    }
+    if (na == 0) {
+      solve_flag = 1;
+      break;
+    }
+    if (count >= nrestart) {
+      break;
     }
 
-    TacsScalar cnorm = c_hat->norm();
-    c_hat->scale(1.0 / cnorm);
-    u_hat->scale(1.0 / cnorm);
+    // Orthonormalize the residuals so that R = V*E. Residuals that are
+    // linearly dependent on the others do not add a new vector.
+    memset(E, 0, ldh * na * sizeof(TacsScalar));
+    int nv = 0;
+    for (int j = 0; j < na; j++) {
+      TacsScalar *e = &E[j * ldh];
+      V[nv]->copyValues(Rv[active[j]]);
+      for (int pass = 0; pass < 2 && nv > 0; pass++) {
+        V[nv]->mdot(V, h, nv);
+        for (int i = 0; i < nv; i++) {
+          e[i] += h[i];
+          V[nv]->axpy(-h[i], V[i]);
+        }
+      }
 
-    // Update the residual and solution
-    TacsScalar alpha = R->dot(c_hat);
-    R->axpy(-alpha, c_hat);
-    x->axpy(alpha, u_hat);
+      TacsScalar rn = Rv[active[j]]->norm();
+      TacsScalar vnorm = V[nv]->norm();
+      if (TacsRealPart(vnorm) > 1e-10 * TacsRealPart(rn)) {
+        V[nv]->scale(1.0 / vnorm);
+        e[nv] = vnorm;
+        nv++;
+      }
+    }
 
-    // Compute the residual and compare...
-    // mat->mult( x, R );      // R = A*x
-    // R->axpy( -1.0, b );     // R = A*x - b
-    // R->scale( -1.0 );
+    // Run the block Arnoldi process. The products with the unprocessed
+    // Arnoldi vectors are computed together, then each product is
+    // orthogonalized in turn. There are never more than max_block
+    // unprocessed vectors.
+    int ncols = 0;
+    int converged = 0;
+    rot_ptr[0] = 0;
+    while (ncols < max_cols && ncols < nv && !converged) {
+      int blk = nv - ncols;
+      if (blk > max_cols - ncols) {
+        blk = max_cols - ncols;
+      }
 
-    if (solve_flag) {
-      break;
+      if (pc) {
+        pc->applyFactorMulti(blk, &V[ncols], &Z[ncols]);
+      }
+      mat->multMulti(blk, &Z[ncols], Wt);
+      iterCount++;
+
+      for (int k = 0; k < blk; k++) {
+        int col = ncols;
+        TacsScalar *hc = &H[col * ldh];
+        memset(hc, 0, ldh * sizeof(TacsScalar));
+
+        // Orthogonalize against the Arnoldi vectors with two passes
+        // of classical Gram-Schmidt
+        for (int pass = 0; pass < 2; pass++) {
+          Wt[k]->mdot(V, h, nv);
+          for (int i = 0; i < nv; i++) {
+            hc[i] += h[i];
+            Wt[k]->axpy(-h[i], V[i]);
+          }
+        }
+
+        TacsScalar hnorm = 0.0;
+        for (int i = 0; i < nv; i++) {
+          hnorm += hc[i] * hc[i];
+        }
+        TacsScalar vnorm = Wt[k]->norm();
+        hnorm = sqrt(hnorm + vnorm * vnorm);
+
+        // Add the new vector unless it is linearly dependent
+        if (TacsRealPart(vnorm) > 1e-10 * TacsRealPart(hnorm)) {
+          TACSVec *t = V[nv];
+          V[nv] = Wt[k];
+          Wt[k] = t;
+          V[nv]->scale(1.0 / vnorm);
+          hc[nv] = vnorm;
+          nv++;
+        }
+
+        // Apply the previous rotations to the new column
+        for (int c = 0; c < col; c++) {
+          for (int r = rot_ptr[c]; r < rot_ptr[c + 1]; r++) {
+            int q = rot_row[r];
+            TacsScalar h1 = hc[c];
+            TacsScalar h2 = hc[q];
+            hc[c] = h1 * rot_cos[r] + h2 * rot_sin[r];
+            hc[q] = -h1 * rot_sin[r] + h2 * rot_cos[r];
+          }
+        }
+
+        // Eliminate the entries below the diagonal, and apply the
+        // rotations to the right-hand-sides
+        int nrot = rot_ptr[col];
+        for (int q = col + 1; q < nv; q++) {
+          if (hc[q] != 0.0) {
+            TacsScalar h1 = hc[col];
+            TacsScalar h2 = hc[q];
+            TacsScalar sq = sqrt(h1 * h1 + h2 * h2);
+            rot_row[nrot] = q;
+            rot_cos[nrot] = h1 / sq;
+            rot_sin[nrot] = h2 / sq;
+            hc[col] = sq;
+            hc[q] = 0.0;
+
+            for (int j = 0; j < na; j++) {
+              TacsScalar e1 = E[col + j * ldh];
+              TacsScalar e2 = E[q + j * ldh];
+              E[col + j * ldh] = e1 * rot_cos[nrot] + e2 * rot_sin[nrot];
+              E[q + j * ldh] = -e1 * rot_sin[nrot] + e2 * rot_cos[nrot];
+            }
+            nrot++;
+          }
+        }
+        rot_ptr[col + 1] = nrot;
+        ncols++;
+
+        // Estimate the residual norms from the least-squares problem
+        converged = 1;
+        TacsScalar rnorm = 0.0;
+        for (int j = 0; j < na; j++) {
+          TacsScalar est = 0.0;
+          for (int q = ncols; q < nv; q++) {
+            est += E[q + j * ldh] * E[q + j * ldh];
+          }
+          est = sqrt(est);
+          int i = active[j];
+          if (TacsRealPart(est) >= atol &&
+              TacsRealPart(est) >= rtol * TacsRealPart(rhs_norm[i])) {
+            converged = 0;
+          }
+          if (TacsRealPart(est) > TacsRealPart(rnorm)) {
+            rnorm = est;
+          }
+        }
+        resNorm = rnorm;
+        if (converged) {
+          break;
+        }
+      }
+
+      if (monitor) {
+        monitor->printResidual(iterCount, resNorm);
+      }
     }
 
-    // Now, prepend c_hat and u_hat to C and U respectively.
-    // All this is done with pointers - no copying actually occurs.
-    // Otherwise, discard the oldest vector -
-    // but use it for the 'new' u_hat/c_hat
-    TACSVec *u = u_hat;
-    TACSVec *c = c_hat;
+    // Compute the weights and update the solutions
+    for (int j = 0; j < na; j++) {
+      for (int i = ncols - 1; i >= 0; i--) {
+        h[i] = E[i + j * ldh];
+        for (int c = i + 1; c < ncols; c++) {
+          h[i] -= H[i + c * ldh] * h[c];
+        }
+        if (H[i + i * ldh] != 0.0) {
+          h[i] = h[i] / H[i + i * ldh];
+        } else {
+          h[i] = 0.0;
+        }
+      }
 
-    // This is the size of the subspace on the next iteration
-    outer_size = (count + 1 < outer ? count + 1 : outer);
+      for (int i = 0; i < ncols; i++) {
+        x[active[j]]->axpy(h[i], Z[i]);
+      }
+    }
+  }
 
-    for (int i = 0; i < outer_size; i++) {
-      TACSVec *tu = U[i];
-      TACSVec *tc = C[i];
+  delete[] h;
+  delete[] rhs_norm;
+  delete[] active;
+  delete[] done;
+  delete[] xa;
+  delete[] ra;
 
-      U[i] = u;
-      C[i] = c;
+  return solve_flag;
+}
 
-      u = tu;
-      c = tc;
+/*
+  Create the block PCG object
+
+  input:
+  mat:        the matrix operator
+  pc:         the preconditioner (may be NULL)
+  max_iters:  the maximum number of iterations
+  max_block:  the maximum number of right-hand-sides in each block
+*/
+BlockPCG::BlockPCG(TACSMat *_mat, TACSPc *_pc, int _max_iters,
+                   int _max_block) {
+  monitor = NULL;
+  max_iters = _max_iters;
+  max_block = (_max_block < 1 ? 1 : _max_block);
+
+  mat = _mat;
+  pc = _pc;
+  mat->incref();
+  if (pc) {
+    pc->incref();
+  }
+
+  // Set default absolute and relative tolerances
+  rtol = 1e-8;
+  atol = 1e-30;
+
+  R = new TACSVec *[max_block];
+  Z = new TACSVec *[max_block];
+  P = new TACSVec *[max_block];
+  Q = new TACSVec *[max_block];
+  for (int i = 0; i < max_block; i++) {
+    R[i] = mat->createVec();
+    R[i]->incref();
+    Z[i] = mat->createVec();
+    Z[i]->incref();
+    P[i] = mat->createVec();
+    P[i]->incref();
+    Q[i] = mat->createVec();
+    Q[i]->incref();
+  }
+}
+
+/*
+  Free the block PCG data
+*/
+BlockPCG::~BlockPCG() {
+  mat->decref();
+  if (pc) {
+    pc->decref();
+  }
+
+  for (int i = 0; i < max_block; i++) {
+    R[i]->decref();
+    Z[i]->decref();
+    P[i]->decref();
+    Q[i]->decref();
+  }
+  delete[] R;
+  delete[] Z;
+  delete[] P;
+  delete[] Q;
+
+  if (monitor) {
+    monitor->decref();
+  }
+}
+
+/*
+  Set the matrix/preconditioner operators used for block PCG
+*/
+void BlockPCG::setOperators(TACSMat *_mat, TACSPc *_pc) {
+  if (_mat) {
+    _mat->incref();
+    if (mat) {
+      mat->decref();
     }
+    mat = _mat;
+  }
+  if (_pc && pc) {
+    _pc->incref();
+    pc->decref();
+    pc = _pc;
+  }
+}
 
-    u_hat = u;
-    c_hat = c;
+/*
+  Retrieve the matrix/preconditioner operators
+*/
+void BlockPCG::getOperators(TACSMat **_mat, TACSPc **_pc) {
+  if (_mat) {
+    *_mat = mat;
+  }
+  if (_pc) {
+    *_pc = pc;
+  }
+}
+
+/*
+  Set the relative and absolute convergence tolerances
+*/
+void BlockPCG::setTolerances(double _rtol, double _atol) {
+  rtol = _rtol;
+  atol = _atol;
+}
+
+/*
+  Set the residual/solution monitor object
+*/
+void BlockPCG::setMonitor(KSMPrint *_monitor) {
+  _monitor->incref();
+  if (monitor) {
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
+
+const char *BlockPCG::getObjectName() { return blockPcgName; }
+
+const char *BlockPCG::blockPcgName = "BlockPCG";
+
+/*
+  Solve the linear system with a single right-hand-side
+*/
+int BlockPCG::solve(TACSVec *b, TACSVec *x, int zero_guess) {
+  return solveBlock(1, &b, &x, zero_guess);
+}
+
+/*
+  Solve the linear systems A*x[i] = b[i] for several right-hand-sides
+
+  The right-hand-sides are solved in groups of at most max_block
+  vectors. On return, the iteration count is the total number of block
+  iterations, and the residual norm is the largest over all the
+  right-hand-sides.
+
+  input:
+  nrhs:       the number of right-hand-sides
+  b:          the right-hand-sides
+  x:          the solution vectors
+  zero_guess: flag to treat x as an initial guess or zero
+
+  returns: 1 if all the systems converged, 0 otherwise
+*/
+int BlockPCG::solveMulti(int nrhs, TACSVec **b, TACSVec **x, int zero_guess) {
+  int flag = 1;
+  int iters = 0;
+  TacsScalar rnorm = 0.0;
+  for (int start = 0; start < nrhs; start += max_block) {
+    int nb = nrhs - start;
+    if (nb > max_block) {
+      nb = max_block;
+    }
+    if (!solveBlock(nb, &b[start], &x[start], zero_guess)) {
+      flag = 0;
+    }
+    iters += iterCount;
+    if (TacsRealPart(resNorm) > TacsRealPart(rnorm)) {
+      rnorm = resNorm;
+    }
+  }
+  iterCount = iters;
+  resNorm = rnorm;
+
+  return flag;
+}
+
+/*
+  Solve a block of at most max_block right-hand-sides with the
+  breakdown-free block conjugate gradient method
+
+  At each iteration, the block of search directions P is orthonormal
+  and A-orthogonal to the previous block. The solution is updated with
+  X = X + P*alpha, where (P^{T}*A*P)*alpha = P^{T}*R, and the next
+  search directions are formed by orthonormalizing Z - P*beta, where
+  (P^{T}*A*P)*beta = (A*P)^{T}*Z and Z = M^{-1}*R.
+*/
+int BlockPCG::solveBlock(int nrhs, TACSVec **b, TACSVec **x, int zero_guess) {
+  TACSProfileScope scope("BlockPCG::solveBlock");
+  int solve_flag = 0;
+  iterCount = 0;
+
+  TacsScalar *rhs_norm = new TacsScalar[nrhs];
+  int *active = new int[nrhs];
+  TACSVec **ra = new TACSVec *[nrhs];
+  TacsScalar *PQ = new TacsScalar[max_block * max_block];
+  TacsScalar *T = new TacsScalar[max_block * max_block];
+  TacsScalar *h = new TacsScalar[max_block];
+  int *ipiv = new int[max_block];
+
+  // Compute the initial residuals
+  if (zero_guess) {
+    for (int i = 0; i < nrhs; i++) {
+      x[i]->zeroEntries();
+      R[i]->copyValues(b[i]);
+    }
+  } else {
+    mat->multMulti(nrhs, x, R);
+    for (int i = 0; i < nrhs; i++) {
+      R[i]->axpby(1.0, -1.0, b[i]);  // R = b - A*x
+    }
+  }
+
+  // Find the right-hand-sides that have not converged
+  int na = 0;
+  resNorm = 0.0;
+  for (int i = 0; i < nrhs; i++) {
+    rhs_norm[i] = R[i]->norm();
+    if (TacsRealPart(rhs_norm[i]) >= atol) {
+      ra[na] = R[i];
+      active[na] = i;
+      na++;
+    }
+    if (TacsRealPart(rhs_norm[i]) > TacsRealPart(resNorm)) {
+      resNorm = rhs_norm[i];
+    }
+  }
+  if (monitor) {
+    monitor->printResidual(0, resNorm);
+  }
+
+  // Compute the initial search directions
+  int np = 0;
+  if (na > 0) {
+    if (pc) {
+      pc->applyFactorMulti(na, ra, P);
+    } else {
+      for (int j = 0; j < na; j++) {
+        P[j]->copyValues(ra[j]);
+      }
+    }
+    np = TacsOrthonormalize(na, P, h);
+  } else {
+    solve_flag = 1;
+  }
+
+  for (int iter = 0; iter < max_iters && np > 0; iter++) {
+    // Compute Q = A*P and the matrix P^{T}*A*P
+    mat->multMulti(np, P, Q);
+    for (int j = 0; j < np; j++) {
+      Q[j]->mdot(P, &PQ[j * np], np);
+    }
+
+    int info = 0;
+    LAPACKgetrf(&np, &np, PQ, &np, ipiv, &info);
+    if (info != 0) {
+      break;
+    }
+
+    // Compute alpha = (P^{T}*A*P)^{-1}*P^{T}*R and update the solution
+    // and the residuals
+    for (int j = 0; j < na; j++) {
+      ra[j]->mdot(P, &T[j * np], np);
+    }
+    LAPACKgetrs("N", &np, &na, PQ, &np, ipiv, T, &np, &info);
+    for (int j = 0; j < na; j++) {
+      for (int i = 0; i < np; i++) {
+        x[active[j]]->axpy(T[i + j * np], P[i]);
+        ra[j]->axpy(-T[i + j * np], Q[i]);
+      }
+    }
+    iterCount++;
+
+    // Remove the right-hand-sides that have converged from the block
+    int nactive = 0;
+    resNorm = 0.0;
+    for (int j = 0; j < na; j++) {
+      int i = active[j];
+      TacsScalar rn = ra[j]->norm();
+      if (TacsRealPart(rn) >= atol &&
+          TacsRealPart(rn) >= rtol * TacsRealPart(rhs_norm[i])) {
+        ra[nactive] = ra[j];
+        active[nactive] = i;
+        nactive++;
+      }
+      if (TacsRealPart(rn) > TacsRealPart(resNorm)) {
+        resNorm = rn;
+      }
+    }
+    na = nactive;
+
+    if (monitor) {
+      monitor->printResidual(iterCount, resNorm);
+    }
+    if (na == 0) {
+      solve_flag = 1;
+      break;
+    }
+
+    // Compute Z = M^{-1}*R
+    if (pc) {
+      pc->applyFactorMulti(na, ra, Z);
+    } else {
+      for (int j = 0; j < na; j++) {
+        Z[j]->copyValues(ra[j]);
+      }
+    }
+
+    // Compute beta = (P^{T}*A*P)^{-1}*Q^{T}*Z and Z = Z - P*beta
+    for (int j = 0; j < na; j++) {
+      Z[j]->mdot(Q, &T[j * np], np);
+    }
+    LAPACKgetrs("N", &np, &na, PQ, &np, ipiv, T, &np, &info);
+    for (int j = 0; j < na; j++) {
+      for (int i = 0; i < np; i++) {
+        Z[j]->axpy(-T[i + j * np], P[i]);
+      }
+    }
+
+    // The new search directions are the orthonormalized Z
+    TACSVec **t = P;
+    P = Z;
+    Z = t;
+    np = TacsOrthonormalize(na, P, h);
   }
 
+  delete[] rhs_norm;
+  delete[] active;
+  delete[] ra;
+  delete[] PQ;
+  delete[] T;
+  delete[] h;
+  delete[] ipiv;
+
   return solve_flag;
 }
 
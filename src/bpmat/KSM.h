@@ -25,6 +25,7 @@
 
 #include <math.h>
 
+#include "TACSMemory.h"
 #include "TACSObject.h"
 
 /*
@@ -78,6 +79,18 @@ class TACSBcMap : public TACSObject {
   int bc_increment;
 };
 
+/*!
+  The request handle for a split-phase vector reduction.
+
+  The handle stores the MPI request and the values that are reduced,
+  so several reductions may be outstanding at the same time. The
+  handle must remain valid until the matching end function is called.
+*/
+struct TACSVecRequest {
+  MPI_Request request;
+  TacsScalar values[2];
+};
+
 /*!
   The abstract vector class.
 
@@ -100,17 +113,52 @@ class TACSVec : public TACSObject {
   virtual void mdot(TACSVec **x, TacsScalar *ans,
                     int m);                             // Multiple dot product
   virtual void axpy(TacsScalar alpha, TACSVec *x) = 0;  // y <- y + alpha * x
+  virtual void maxpy(int m, const TacsScalar *alpha,
+                     TACSVec **x);  // y <- y + sum alpha[k] * x[k]
   virtual void copyValues(TACSVec *x) = 0;  // Copy values from x to this
   virtual void axpby(TacsScalar alpha, TacsScalar beta,
                      TACSVec *x) = 0;  // Compute y <- alpha * x + beta * y
   virtual void zeroEntries() = 0;      // Zero all the entries
 
+  // Split the multiple dot product so that the reduction can overlap
+  // other work. The result is only available after mdotEnd().
+  // ----------------------------------------------------------------
+  virtual void mdotBegin(TACSVec **x, TacsScalar *ans, int m) {
+    mdot(x, ans, m);
+  }
+  virtual void mdotEnd(TacsScalar *ans, int m) {}
+
+  // Split-phase reductions. The begin functions compute the local
+  // contributions and start the reduction, and the result is returned
+  // by the end functions. The default implementations are blocking.
+  // ------------------------------------------------------------------
+  virtual void beginDot(TACSVec *x, TACSVecRequest *req);
+  virtual void beginNorm(TACSVecRequest *req);
+  virtual void beginMdot(TACSVec **x, TacsScalar *ans, int m,
+                         TACSVecRequest *req);
+  TacsScalar endDot(TACSVecRequest *req);
+  TacsScalar endNorm(TACSVecRequest *req);
+  void endMdot(TACSVecRequest *req);
+
+  // Fused operations that require a single reduction
+  // ------------------------------------------------
+  virtual void beginAxpyNorm(TacsScalar alpha, TACSVec *x,
+                             TACSVecRequest *req);
+  virtual void beginDot2(TACSVec *x1, TACSVec *x2, TACSVecRequest *req);
+  void endDot2(TACSVecRequest *req, TacsScalar *d1, TacsScalar *d2);
+  TacsScalar axpyNorm(TacsScalar alpha, TACSVec *x);
+  void dot2(TACSVec *x1, TACSVec *x2, TacsScalar *d1, TacsScalar *d2);
+
   // Additional useful member functions
   // ----------------------------------
   virtual void setRand(double lower = -1.0, double upper = 1.0) {}
   virtual void initRand() {}
   virtual void applyBCs(TACSBcMap *map, TACSVec *vec = NULL) {}
   virtual void setBCs(TACSBcMap *map) {}
+
+  // Set the category that the memory for this vector is charged to
+  // --------------------------------------------------------------
+  virtual void setMemoryCategory(int category) {}
 };
 
 /*!
@@ -122,6 +170,11 @@ class TACSVec : public TACSObject {
   addValues(): Adds a small, dense matrix to the rows set in row[] and
   the columns set in col[].
 
+  addElementValues(): Adds a dense element matrix using a precomputed
+  scatter plan for the element. Returns 0 if no plan is available, in
+  which case the caller must use addValues() instead. If a list of
+  (row, column) node blocks is given, only those blocks are added.
+
   applyBCs(): Applies the Dirichlet boundary conditions to the matrix
   by settin the associated diagonal elements to 1.
 
@@ -156,6 +209,11 @@ class TACSMat : public TACSObject {
                                const TacsScalar *weights, int nv, int mv,
                                const TacsScalar *values,
                                MatrixOrientation matOr = TACS_MAT_NORMAL) {}
+  virtual int addElementValues(const int *elem_ptr, int elem, int mv,
+                               const TacsScalar *values, int nblocks = 0,
+                               const int *blocks = NULL) {
+    return 0;
+  }
   virtual void applyBCs(TACSBcMap *bcmap) {}
   virtual void applyTransposeBCs(TACSBcMap *bcmap) {}
   virtual void beginAssembly() {}
@@ -174,6 +232,11 @@ class TACSMat : public TACSObject {
   // ----------------------------------------
   virtual void mult(TACSVec *x, TACSVec *y) = 0;
   virtual void multTranspose(TACSVec *x, TACSVec *y) {}
+  virtual void multMulti(int nvecs, TACSVec **x, TACSVec **y) {
+    for (int i = 0; i < nvecs; i++) {
+      mult(x[i], y[i]);
+    }
+  }
   virtual void copyValues(TACSMat *mat) {}
   virtual void scale(TacsScalar alpha) {}
   virtual void axpy(TacsScalar alpha, TACSMat *mat) {}
@@ -204,6 +267,14 @@ class TACSPc : public TACSObject {
   // -------------------------------------------
   virtual void applyFactor(TACSVec *x, TACSVec *y) = 0;
 
+  // Apply the preconditioner to each of the vectors x[i] to produce y[i]
+  // --------------------------------------------------------------------
+  virtual void applyFactorMulti(int nvecs, TACSVec **x, TACSVec **y) {
+    for (int i = 0; i < nvecs; i++) {
+      applyFactor(x[i], y[i]);
+    }
+  }
+
   // Factor (or set up) the preconditioner
   // -------------------------------------
   virtual void factor() = 0;
@@ -225,12 +296,57 @@ class TACSPc : public TACSObject {
   Monitor the residual or other interesting quantity and print out the
   result to the screen or file.
 */
+/*
+  The performance data for one iteration of a Krylov method. The
+  times are the wall times spent in each operation during the
+  iteration, and the number of global reductions includes the dot
+  products and norms.
+*/
+struct KSMIterStats {
+  double pc_time;      // Time applying the preconditioner
+  double mat_time;     // Time computing matrix-vector products
+  double orth_time;    // Time orthogonalizing the new vector
+  int num_reductions;  // Number of global reductions
+};
+
+/*
+  The performance data for one nonlinear (Newton) iteration
+*/
+struct KSMNewtonStats {
+  double assembly_time;  // Time assembling the residual and Jacobian
+  double factor_time;    // Time factoring the preconditioner
+  double solve_time;     // Time in the Krylov method
+  int ksm_iters;         // Number of Krylov iterations
+  int jac_assembled;     // Flag indicating the Jacobian was assembled
+};
+
+/*
+  The monitor object for the iterative methods
+
+  printResidual() and print() are required. Monitors that record the
+  performance of the solvers also implement printIteration(), which
+  receives the performance data for each iteration, endSolve(), which
+  is called at the end of each solve, and printNewtonIteration(),
+  which is called for each nonlinear iteration. Solvers that do not
+  record the performance data only call printResidual().
+*/
 class KSMPrint : public TACSObject {
  public:
   virtual ~KSMPrint() {}
 
   virtual void printResidual(int iter, TacsScalar res) = 0;
   virtual void print(const char *cstr) = 0;
+
+  // Record the performance data for an iteration or a solve
+  // -------------------------------------------------------
+  virtual void printIteration(int iter, TacsScalar res,
+                              const KSMIterStats *stats) {
+    printResidual(iter, res);
+  }
+  virtual void endSolve(int iters, TacsScalar res, int solve_flag,
+                        double time) {}
+  virtual void printNewtonIteration(int iter, TacsScalar res,
+                                    const KSMNewtonStats *stats) {}
   const char *getObjectName();
 
  private:
@@ -253,6 +369,10 @@ class KSMPrint : public TACSObject {
   solve(): Solve the linear system to the specified tolerance using
   the Krylov subspace method.
 
+  solveMulti(): Solve the linear system for several right-hand-sides.
+  By default, each system is solved in turn, but block methods solve
+  them together.
+
   setTolerances(rtol, atol): Set the relative and absolute stopping
   tolerances for the method
 
@@ -271,6 +391,16 @@ class TACSKsm : public TACSObject {
   virtual void setOperators(TACSMat *_mat, TACSPc *_pc) = 0;
   virtual void getOperators(TACSMat **_mat, TACSPc **_pc) = 0;
   virtual int solve(TACSVec *b, TACSVec *x, int zero_guess = 1) = 0;
+  virtual int solveMulti(int nrhs, TACSVec **b, TACSVec **x,
+                         int zero_guess = 1) {
+    int flag = 1;
+    for (int i = 0; i < nrhs; i++) {
+      if (!solve(b[i], x[i], zero_guess)) {
+        flag = 0;
+      }
+    }
+    return flag;
+  }
   virtual void setTolerances(double _rtol, double _atol) = 0;
   virtual void setMonitor(KSMPrint *_monitor) = 0;
   virtual int getIterCount() { return iterCount; }
@@ -303,6 +433,34 @@ class KSMPrintStdout : public KSMPrint {
   int freq;
 };
 
+/*
+  Write the convergence and performance data to a file as JSON lines
+
+  Each iteration, solve summary, Newton iteration and message is
+  written as one JSON object per line, so that the logs from many runs
+  can be concatenated and analyzed. Only the processor with rank == 0
+  writes the file.
+*/
+class KSMPrintTelemetry : public KSMPrint {
+ public:
+  KSMPrintTelemetry(const char *filename, const char *_descript, int _rank);
+  ~KSMPrintTelemetry();
+
+  void printResidual(int iter, TacsScalar res);
+  void print(const char *cstr);
+  void printIteration(int iter, TacsScalar res, const KSMIterStats *stats);
+  void endSolve(int iters, TacsScalar res, int solve_flag, double time);
+  void printNewtonIteration(int iter, TacsScalar res,
+                            const KSMNewtonStats *stats);
+
+ private:
+  FILE *fp;
+  char *descript;
+  int rank;
+  int solve_count;   // The number of Krylov solves recorded
+  int newton_count;  // The number of nonlinear solves recorded
+};
+
 /*
   Write out the print statements to a file
 */
@@ -390,7 +548,11 @@ class PCG : public TACSKsm {
 */
 class GMRES : public TACSKsm {
  public:
-  enum OrthoType { CLASSICAL_GRAM_SCHMIDT, MODIFIED_GRAM_SCHMIDT };
+  enum OrthoType {
+    CLASSICAL_GRAM_SCHMIDT,
+    MODIFIED_GRAM_SCHMIDT,
+    CLASSICAL_GRAM_SCHMIDT_REORTH
+  };
   GMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart, int _isFlexible);
   GMRES(TACSMat *_mat, int _m, int _nrestart);
   ~GMRES();
@@ -438,6 +600,161 @@ class GMRES : public TACSKsm {
   static const char *gmresName;
 };
 
+/*!
+  Pipelined right-preconditioned GMRES
+
+  This variant of GMRES overlaps the global reduction required for the
+  orthogonalization with the application of the preconditioner and
+  the matrix-vector product. This is the p(1)-GMRES method of Ghysels
+  et al. Each iteration requires a single non-blocking reduction that
+  computes the dot products for classical Gram-Schmidt and the norm of
+  the new vector together. While this reduction is in flight, the
+  product of the operator with the unorthogonalized vector is
+  computed. The product with the new Arnoldi vector is then recovered
+  from the recurrence
+
+  A*M^{-1}*W[i+1] = (A*M^{-1}*Z[i] - sum_{j} H[j,i]*Z[j])/H[i+1,i]
+
+  where Z[j] = A*M^{-1}*W[j]. The norm H[i+1,i] is computed from the
+  norm of the unorthogonalized vector. When this suffers from severe
+  cancellation, the norm and the product are computed directly.
+
+  This method requires twice the storage of GMRES and is less stable,
+  but it hides the latency of the reductions when many processors are
+  used. The preconditioner cannot be flexible.
+
+  The input parameters are:
+  -------------------------
+  mat: the matrix handle
+  pc: (optional) the preconditioner
+  m: the size of the Krylov-subspace to use before restarting
+  nrestart: the number of restarts to use
+*/
+class PipelinedGMRES : public TACSKsm {
+ public:
+  PipelinedGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart);
+  ~PipelinedGMRES();
+
+  TACSVec *createVec() { return mat->createVec(); }
+  int solve(TACSVec *b, TACSVec *x, int zero_guess = 1);
+  void setOperators(TACSMat *_mat, TACSPc *_pc);
+  void getOperators(TACSMat **_mat, TACSPc **_pc);
+  void setTolerances(double _rtol, double _atol);
+  void setMonitor(KSMPrint *_monitor);
+  const char *getObjectName();
+
+ private:
+  // Compute out = A*M^{-1}*in
+  void applyOperator(TACSVec *in, TACSVec *out);
+
+  TACSMat *mat;
+  TACSPc *pc;
+  int msub;
+  int nrestart;
+
+  TACSVec **W;      // The Arnoldi vectors that span the Krylov subspace
+  TACSVec **Z;      // The products of the operator with the Arnoldi vectors
+  TACSVec **dvecs;  // The vectors used in the dot products
+  TACSVec *work;    // A work vector for the preconditioner
+  TACSVec *q;       // The product of the operator with the next vector
+
+  int *Hptr;      // Array to make accessing the elements of the matrix easier!
+  TacsScalar *H;  // The Hessenberg matrix
+
+  double rtol;
+  double atol;
+
+  TacsScalar *Qsin;
+  TacsScalar *Qcos;
+  TacsScalar *res;
+
+  KSMPrint *monitor;
+
+  static const char *gmresName;
+};
+
+/*!
+  Right-preconditioned s-step GMRES
+
+  This variant of GMRES generates s vectors of the Krylov subspace at
+  a time using the shifted (Newton) basis
+
+  K[j] = (A*M^{-1} - shifts[j]*I) K[j-1],  K[-1] = W[k]
+
+  where W[k] is the last Arnoldi vector. The shifts are the diagonal
+  entries of the Hessenberg matrix from the previous block, which keep
+  the basis well-conditioned when the preconditioned operator is close
+  to the identity. The new vectors are then
+  orthogonalized against the existing basis, and against each other,
+  using the dot products computed in a single batch of reductions.
+  The new vectors are orthogonalized against the existing basis with
+  classical Gram-Schmidt, and against each other with a Cholesky
+  factorization of their projected Gram matrix. The columns of the
+  Hessenberg matrix are recovered from the change of basis.
+
+  This reduces the number of synchronization points by a factor of s
+  compared to GMRES with classical Gram-Schmidt. The basis becomes
+  ill-conditioned as s increases, so s should be small. If
+  the Cholesky factorization breaks down, the block is truncated and
+  the norm of the next vector is computed directly. The preconditioner
+  cannot be flexible.
+
+  The input parameters are:
+  -------------------------
+  mat: the matrix handle
+  pc: (optional) the preconditioner
+  m: the size of the Krylov-subspace to use before restarting
+  nrestart: the number of restarts to use
+  s: the number of vectors generated between reductions
+*/
+class SStepGMRES : public TACSKsm {
+ public:
+  SStepGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart, int _s = 4);
+  ~SStepGMRES();
+
+  TACSVec *createVec() { return mat->createVec(); }
+  int solve(TACSVec *b, TACSVec *x, int zero_guess = 1);
+  void setOperators(TACSMat *_mat, TACSPc *_pc);
+  void getOperators(TACSMat **_mat, TACSPc **_pc);
+  void setTolerances(double _rtol, double _atol);
+  void setMonitor(KSMPrint *_monitor);
+  const char *getObjectName();
+
+ private:
+  // Compute out = A*M^{-1}*in
+  void applyOperator(TACSVec *in, TACSVec *out);
+
+  TACSMat *mat;
+  TACSPc *pc;
+  int msub;
+  int nrestart;
+  int sstep;
+
+  TACSVec **W;    // The Arnoldi vectors that span the Krylov subspace
+  TACSVec *work;  // A work vector for the preconditioner
+
+  int *Hptr;         // Pointer to the columns of the Hessenberg matrix
+  TacsScalar *H;     // The Hessenberg matrix after the Givens rotations
+  TacsScalar *Hraw;  // The Hessenberg matrix without the rotations
+
+  // The dot products, Cholesky factor and new Hessenberg columns
+  TacsScalar *G, *R, *Hnew;
+
+  // The shifts used to generate the basis
+  TacsScalar *shifts;
+
+  double rtol;
+  double atol;
+
+  TacsScalar *Qsin;
+  TacsScalar *Qcos;
+  TacsScalar *res;
+
+  KSMPrint *monitor;
+
+  static const char *gmresName;
+};
+
 /*!
   A simplified and flexible variant of GCROT - from Hicken and Zingg
 
@@ -499,6 +816,224 @@ class GCROT : public TACSKsm {
   static const char *gcrotName;
 };
 
+/*!
+  Flexible GCRO with deflated restarting and recycling - GCRO-DR
+
+  This Krylov subspace method retains a subspace of the solution space
+  between restarts and between calls to solve(). When a sequence of
+  closely related linear systems is solved, such as the Newton or
+  adjoint systems in an optimization or a time-accurate simulation,
+  the retained subspace deflates the eigenvalues that slow down the
+  convergence of the restarted method.
+
+  The recycled subspace U is stored together with C = A*U, where the
+  columns of C are orthonormal. At the start of each solve, C is
+  recomputed with the current matrix, so that the subspace remains
+  valid as the operator changes. Each restart cycle then runs flexible
+  GMRES on the operator projected onto the orthogonal complement of
+  C. At the end of each cycle, U is replaced by the harmonic Ritz
+  vectors with the smallest harmonic Ritz values from the subspace
+  spanned by U and the directions from the cycle.
+
+  The recycled subspace can be retrieved or set directly, or written
+  to and read from a file, so that it can be carried over between
+  runs.
+
+  The input parameters are:
+  mat: The matrix operator
+  pc: The preconditioner (optional, may be flexible)
+  msub: The size of the GMRES subspace in each cycle
+  nrecycle: The number of vectors in the recycled subspace
+  nrestart: The maximum number of restart cycles
+*/
+class GCRODR : public TACSKsm {
+ public:
+  GCRODR(TACSMat *_mat, TACSPc *_pc, int _msub, int _nrecycle,
+         int _nrestart);
+  ~GCRODR();
+
+  TACSVec *createVec() { return mat->createVec(); }
+  int solve(TACSVec *b, TACSVec *x, int zero_guess = 1);
+  void setOperators(TACSMat *_mat, TACSPc *_pc);
+  void getOperators(TACSMat **_mat, TACSPc **_pc);
+  void setTolerances(double _rtol, double _atol);
+  void setMonitor(KSMPrint *_monitor);
+  const char *getObjectName();
+
+  // Access the recycled subspace
+  // ----------------------------
+  int getRecycleSpace(TACSVec ***_U);
+  void setRecycleSpace(int num, TACSVec **_U);
+  void clearRecycleSpace();
+  int writeRecycleSpace(const char *prefix);
+  int readRecycleSpace(const char *prefix);
+
+ private:
+  // Compute C = A*U for the current operator and orthonormalize C
+  int updateRecycleSpace();
+
+  // Replace U and C with the harmonic Ritz vectors from the last cycle
+  void harvestRecycleSpace(int niters);
+
+  TACSMat *mat;
+  TACSPc *pc;
+  int msub;      // Size of the GMRES subspace
+  int nrecycle;  // Maximum size of the recycled subspace
+  int nrestart;  // Maximum number of restart cycles
+  int nU;        // Current size of the recycled subspace
+
+  TACSVec **W;         // The Arnoldi vectors
+  TACSVec **Z;         // The preconditioned Arnoldi vectors
+  TACSVec **U, **C;    // The recycled subspace with C = A*U
+  TACSVec **Ut, **Ct;  // Storage for the updated recycled subspace
+  TACSVec *R;          // The residual
+
+  TacsScalar *H;    // The Hessenberg matrix without the rotations
+  TacsScalar *Hq;   // The Hessenberg matrix after the Givens rotations
+  TacsScalar *B;    // The matrix C^{T}*A*Z
+  TacsScalar *res;  // The rotated residual, then the weights
+  TacsScalar *Qsin;
+  TacsScalar *Qcos;
+
+  double rtol;
+  double atol;
+
+  KSMPrint *monitor;
+
+  static const char *gcrodrName;
+};
+
+/*!
+  Block GMRES for several right-hand-sides
+
+  This class solves the linear systems A*x[i] = b[i] for several
+  right-hand-sides together. The block Krylov subspace is generated
+  with multMulti() and applyFactorMulti(), so that the matrix and the
+  preconditioner are streamed from memory once for each block of
+  vectors, rather than once for each vector.
+
+  Each new vector in the block Arnoldi process is orthogonalized
+  against all the previous vectors. When a new vector is linearly
+  dependent on the previous vectors, it is dropped and the block size
+  is reduced. At each restart, the right-hand-sides that have
+  converged are removed from the block. The preconditioner is applied
+  on the right and may be flexible.
+
+  The right-hand-sides are solved in groups of at most max_block
+  vectors.
+
+  The input parameters are:
+  mat: The matrix operator
+  pc: The preconditioner (optional)
+  m: The number of block iterations before restarting
+  nrestart: The maximum number of restarts
+  max_block: The maximum number of right-hand-sides in each block
+*/
+class BlockGMRES : public TACSKsm {
+ public:
+  BlockGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart,
+             int _max_block);
+  ~BlockGMRES();
+
+  TACSVec *createVec() { return mat->createVec(); }
+  int solve(TACSVec *b, TACSVec *x, int zero_guess = 1);
+  int solveMulti(int nrhs, TACSVec **b, TACSVec **x, int zero_guess = 1);
+  void setOperators(TACSMat *_mat, TACSPc *_pc);
+  void getOperators(TACSMat **_mat, TACSPc **_pc);
+  void setTolerances(double _rtol, double _atol);
+  void setMonitor(KSMPrint *_monitor);
+  const char *getObjectName();
+
+ private:
+  // Solve a block of at most max_block right-hand-sides
+  int solveBlock(int nrhs, TACSVec **b, TACSVec **x, int zero_guess);
+
+  TACSMat *mat;
+  TACSPc *pc;
+  int msub;       // The number of block iterations before restarting
+  int nrestart;   // The maximum number of restarts
+  int max_block;  // The maximum block size
+  int max_cols;   // The maximum number of columns in the Arnoldi process
+
+  TACSVec **V;   // The Arnoldi vectors
+  TACSVec **Z;   // The preconditioned Arnoldi vectors
+  TACSVec **Rv;  // The residuals
+  TACSVec **Wt;  // The new vectors for each block
+
+  TacsScalar *H;  // The Hessenberg matrix with the Givens rotations
+  TacsScalar *E;  // The right-hand-sides of the least-squares problem
+
+  // The Givens rotations that eliminate the entries below the diagonal
+  int *rot_ptr, *rot_row;
+  TacsScalar *rot_cos, *rot_sin;
+
+  double rtol;
+  double atol;
+
+  KSMPrint *monitor;
+
+  static const char *blockGmresName;
+};
+
+/*!
+  Block preconditioned conjugate gradient for several right-hand-sides
+
+  This class solves the symmetric positive definite linear systems
+  A*x[i] = b[i] for several right-hand-sides together. The search
+  directions for all the right-hand-sides are updated together with
+  multMulti() and applyFactorMulti().
+
+  The search directions are orthonormalized at each iteration, and
+  directions that are linearly dependent on the others are dropped.
+  This avoids the breakdown of block conjugate gradient when the
+  residuals become linearly dependent. Right-hand-sides that have
+  converged are removed from the block.
+
+  The right-hand-sides are solved in groups of at most max_block
+  vectors.
+
+  The input parameters are:
+  mat: The matrix operator
+  pc: The preconditioner (optional, must be symmetric)
+  max_iters: The maximum number of iterations
+  max_block: The maximum number of right-hand-sides in each block
+*/
+class BlockPCG : public TACSKsm {
+ public:
+  BlockPCG(TACSMat *_mat, TACSPc *_pc, int _max_iters, int _max_block);
+  ~BlockPCG();
+
+  TACSVec *createVec() { return mat->createVec(); }
+  int solve(TACSVec *b, TACSVec *x, int zero_guess = 1);
+  int solveMulti(int nrhs, TACSVec **b, TACSVec **x, int zero_guess = 1);
+  void setOperators(TACSMat *_mat, TACSPc *_pc);
+  void getOperators(TACSMat **_mat, TACSPc **_pc);
+  void setTolerances(double _rtol, double _atol);
+  void setMonitor(KSMPrint *_monitor);
+  const char *getObjectName();
+
+ private:
+  // Solve a block of at most max_block right-hand-sides
+  int solveBlock(int nrhs, TACSVec **b, TACSVec **x, int zero_guess);
+
+  TACSMat *mat;
+  TACSPc *pc;
+  int max_iters;  // The maximum number of iterations
+  int max_block;  // The maximum block size
+
+  TACSVec **R;  // The residuals
+  TACSVec **Z;  // The preconditioned residuals
+  TACSVec **P;  // The search directions
+  TACSVec **Q;  // The products Q = A*P
+
+  double rtol;
+  double atol;
+
+  KSMPrint *monitor;
+
+  static const char *blockPcgName;
+};
+
 /*
   Create a Krylov-subspace class that is just a preconditioner.
 
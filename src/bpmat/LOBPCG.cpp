@@ -0,0 +1,411 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "LOBPCG.h"
+
+#include "tacslapack.h"
+
+/*
+  Create the LOBPCG solver
+
+  input:
+  oper:         the operator that defines the eigenproblem
+  num_eigvals:  the number of eigenvalues sought
+  block_size:   the size of the block (at least num_eigvals)
+  max_iters:    the maximum number of iterations
+*/
+TACSLOBPCG::TACSLOBPCG(TACSJacobiDavidsonOperator *_oper, int _num_eigvals,
+                       int _block_size, int _max_iters) {
+  oper = _oper;
+  oper->incref();
+
+  // The block must contain all the eigenvalues sought. Extra vectors
+  // in the block accelerate the convergence of the last eigenvalues.
+  num_eigvals = _num_eigvals;
+  block_size = _block_size;
+  if (block_size < num_eigvals) {
+    block_size = num_eigvals;
+  }
+  max_iters = _max_iters;
+
+  // The default tolerances
+  eig_rtol = 1e-8;
+  eig_atol = 1e-30;
+
+  nconverged = 0;
+  has_solution = 0;
+
+  const int m = block_size;
+  eigvals = new TacsScalar[m];
+  eigerror = new TacsScalar[m];
+  memset(eigvals, 0, m * sizeof(TacsScalar));
+  memset(eigerror, 0, m * sizeof(TacsScalar));
+
+  // Allocate the blocks of vectors
+  TACSVec ***blocks[10] = {&X, &BX, &W, &BW, &P, &BP, &Xn, &BXn, &Pn, &BPn};
+  for (int k = 0; k < 10; k++) {
+    TACSVec **vecs = new TACSVec *[m];
+    for (int i = 0; i < m; i++) {
+      vecs[i] = oper->createVec();
+      vecs[i]->incref();
+    }
+    *blocks[k] = vecs;
+  }
+  work = oper->createVec();
+  work->incref();
+
+  // The subspace is at most three times the block size
+  S = new TACSVec *[3 * m];
+  BS = new TACSVec *[3 * m];
+
+  // Allocate the data for the projected eigenproblem
+  dots = new TacsScalar[3 * m];
+  gA = new double[9 * m * m];
+  ritzvals = new double[3 * m];
+  lwork = 16 * 3 * m;
+  rwork = new double[lwork];
+}
+
+/*
+  Free the data associated with the object
+*/
+TACSLOBPCG::~TACSLOBPCG() {
+  oper->decref();
+
+  TACSVec **blocks[10] = {X, BX, W, BW, P, BP, Xn, BXn, Pn, BPn};
+  for (int k = 0; k < 10; k++) {
+    for (int i = 0; i < block_size; i++) {
+      blocks[k][i]->decref();
+    }
+    delete[] blocks[k];
+  }
+  work->decref();
+
+  delete[] S;
+  delete[] BS;
+  delete[] eigvals;
+  delete[] eigerror;
+  delete[] dots;
+  delete[] gA;
+  delete[] ritzvals;
+  delete[] rwork;
+}
+
+// Get the MPI_Comm
+MPI_Comm TACSLOBPCG::getMPIComm() { return oper->getMPIComm(); }
+
+/*
+  Set the tolerances. An eigenpair is converged when
+
+  ||A*x - lambda*B*x|| <= eig_rtol*||A*x|| + eig_atol
+*/
+void TACSLOBPCG::setTolerances(double _eig_rtol, double _eig_atol) {
+  eig_rtol = _eig_rtol;
+  eig_atol = _eig_atol;
+}
+
+/*
+  Get the number of converged eigenvalues
+*/
+int TACSLOBPCG::getNumConvergedEigenvalues() { return nconverged; }
+
+/*!
+  Extract the eigenvalue from the analysis
+*/
+TacsScalar TACSLOBPCG::extractEigenvalue(int n, TacsScalar *error) {
+  if (n >= 0 && n < block_size) {
+    if (error) {
+      *error = eigerror[n];
+    }
+    return eigvals[n];
+  }
+
+  if (error) {
+    *error = 0.0;
+  }
+  return 0.0;
+}
+
+/*!
+  Extract the eigenvector and eigenvalue from the analysis
+*/
+TacsScalar TACSLOBPCG::extractEigenvector(int n, TACSVec *ans,
+                                          TacsScalar *error) {
+  if (n >= 0 && n < block_size) {
+    if (ans) {
+      ans->copyValues(X[n]);
+    }
+    if (error) {
+      *error = eigerror[n];
+    }
+    return eigvals[n];
+  }
+
+  if (error) {
+    *error = 0.0;
+  }
+  return 0.0;
+}
+
+/*
+  B-orthonormalize the vector v against the B-orthonormal subspace S
+  using two passes of classical Gram-Schmidt. The products BS = B*S are
+  used so that only a single product with B is required. On return,
+  Bv = B*v. Returns 0 if the vector is nearly linearly dependent on the
+  subspace and is discarded.
+*/
+int TACSLOBPCG::orthonormalize(int ns, TACSVec **_S, TACSVec **_BS,
+                               TACSVec *v, TACSVec *Bv) {
+  oper->applyBCs(v);
+  oper->multB(v, Bv);
+  TacsScalar init_norm = sqrt(v->dot(Bv));
+  if (TacsRealPart(init_norm) <= 0.0) {
+    return 0;
+  }
+
+  if (ns > 0) {
+    for (int k = 0; k < 2; k++) {
+      Bv->mdot(_S, dots, ns);
+      for (int i = 0; i < ns; i++) {
+        v->axpy(-dots[i], _S[i]);
+        Bv->axpy(-dots[i], _BS[i]);
+      }
+    }
+  }
+
+  TacsScalar norm = v->dot(Bv);
+  if (TacsRealPart(norm) <= 1e-20 * TacsRealPart(init_norm * init_norm)) {
+    return 0;
+  }
+  norm = sqrt(norm);
+  v->scale(1.0 / norm);
+  Bv->scale(1.0 / norm);
+
+  return 1;
+}
+
+/*
+  Solve the projected eigenproblem stored in gA. On return, the columns
+  of gA contain the eigenvectors in ascending order of the eigenvalues.
+*/
+int TACSLOBPCG::solveProjected(int ns) {
+  int n = ns, info = 0;
+  LAPACKdsyev("V", "U", &n, gA, &n, ritzvals, rwork, &lwork, &info);
+  return info;
+}
+
+/*
+  Solve the eigenvalue problem
+
+  The block is initialized with the eigenvectors from the previous
+  solve, if any, so that subsequent solves within a design optimization
+  start from a good estimate.
+*/
+void TACSLOBPCG::solve(KSMPrint *ksm_print, int print_level) {
+  const int m = block_size;
+  nconverged = 0;
+
+  // Initialize and B-orthonormalize the block
+  for (int k = 0; k < m; k++) {
+    if (!has_solution) {
+      X[k]->setRand(-1.0, 1.0);
+    }
+    for (int trial = 0; !orthonormalize(k, X, BX, X[k], BX[k]); trial++) {
+      if (trial > 10) {
+        fprintf(stderr, "TACSLOBPCG: Failed to initialize the block\n");
+        return;
+      }
+      X[k]->setRand(-1.0, 1.0);
+    }
+  }
+
+  // Apply the Rayleigh-Ritz method to the initial block
+  for (int j = 0; j < m; j++) {
+    oper->multA(X[j], work);
+    work->mdot(X, dots, m);
+    for (int i = 0; i < m; i++) {
+      gA[i + m * j] = TacsRealPart(dots[i]);
+    }
+  }
+  for (int j = 0; j < m; j++) {
+    for (int i = 0; i < j; i++) {
+      gA[i + m * j] = gA[j + m * i] = 0.5 * (gA[i + m * j] + gA[j + m * i]);
+    }
+  }
+  if (solveProjected(m) != 0) {
+    fprintf(stderr, "TACSLOBPCG: Projected eigenproblem failed\n");
+    return;
+  }
+  for (int k = 0; k < m; k++) {
+    Xn[k]->zeroEntries();
+    BXn[k]->zeroEntries();
+    for (int j = 0; j < m; j++) {
+      Xn[k]->axpy(gA[j + m * k], X[j]);
+      BXn[k]->axpy(gA[j + m * k], BX[j]);
+    }
+    eigvals[k] = ritzvals[k];
+  }
+  for (int k = 0; k < m; k++) {
+    TACSVec *t = X[k];
+    X[k] = Xn[k];
+    Xn[k] = t;
+    t = BX[k];
+    BX[k] = BXn[k];
+    BXn[k] = t;
+  }
+  has_solution = 1;
+
+  if (ksm_print && print_level > 0) {
+    char line[256];
+    sprintf(line, "%4s %4s %15s %15s\n", "Iter", "Conv", "Max residual",
+            "Ritz value");
+    ksm_print->print(line);
+  }
+
+  int *converged = new int[m];
+  int has_dirs = 0;
+  int iter = 0;
+  for (;; iter++) {
+    // Compute the residuals W = A*X - B*X*Theta and check convergence
+    double max_res = 0.0;
+    for (int k = 0; k < m; k++) {
+      oper->multA(X[k], W[k]);
+      TacsScalar anorm = W[k]->norm();
+      W[k]->axpy(-eigvals[k], BX[k]);
+      eigerror[k] = W[k]->norm();
+      converged[k] = (TacsRealPart(eigerror[k]) <=
+                      eig_rtol * TacsRealPart(anorm) + eig_atol);
+      if (k < num_eigvals && TacsRealPart(eigerror[k]) > max_res) {
+        max_res = TacsRealPart(eigerror[k]);
+      }
+    }
+
+    nconverged = 0;
+    while (nconverged < m && converged[nconverged]) {
+      nconverged++;
+    }
+
+    if (ksm_print && print_level > 0) {
+      int index = (nconverged < m ? nconverged : m - 1);
+      char line[256];
+      sprintf(line, "%4d %4d %15.5e %15.5e\n", iter, nconverged, max_res,
+              TacsRealPart(eigvals[index]));
+      ksm_print->print(line);
+    }
+
+    if (nconverged >= num_eigvals || iter >= max_iters) {
+      break;
+    }
+
+    // Form the subspace from the block, the preconditioned residuals
+    // and the search directions of the vectors that have not converged
+    int ns = 0;
+    for (int k = 0; k < m; k++, ns++) {
+      S[k] = X[k];
+      BS[k] = BX[k];
+    }
+    for (int k = 0; k < m; k++) {
+      if (!converged[k]) {
+        oper->applyFactor(W[k], work);
+        TACSVec *t = W[k];
+        W[k] = work;
+        work = t;
+        if (orthonormalize(ns, S, BS, W[k], BW[k])) {
+          S[ns] = W[k];
+          BS[ns] = BW[k];
+          ns++;
+        }
+      }
+    }
+    if (has_dirs) {
+      for (int k = 0; k < m; k++) {
+        if (!converged[k] && orthonormalize(ns, S, BS, P[k], BP[k])) {
+          S[ns] = P[k];
+          BS[ns] = BP[k];
+          ns++;
+        }
+      }
+    }
+
+    // Form the projected matrix S^{T}*A*S. The block of Ritz vectors
+    // gives the diagonal matrix of Ritz values.
+    memset(gA, 0, ns * ns * sizeof(double));
+    for (int i = 0; i < m; i++) {
+      gA[i + ns * i] = TacsRealPart(eigvals[i]);
+    }
+    for (int j = m; j < ns; j++) {
+      oper->multA(S[j], work);
+      work->mdot(S, dots, ns);
+      for (int i = 0; i < ns; i++) {
+        gA[i + ns * j] = TacsRealPart(dots[i]);
+      }
+    }
+    for (int j = m; j < ns; j++) {
+      for (int i = 0; i < j; i++) {
+        double a = (i < m ? gA[i + ns * j]
+                          : 0.5 * (gA[i + ns * j] + gA[j + ns * i]));
+        gA[i + ns * j] = gA[j + ns * i] = a;
+      }
+    }
+
+    if (solveProjected(ns) != 0) {
+      fprintf(stderr, "TACSLOBPCG: Projected eigenproblem failed\n");
+      break;
+    }
+
+    // Compute the new search directions and the new block of Ritz vectors
+    for (int k = 0; k < m; k++) {
+      const double *y = &gA[ns * k];
+      Pn[k]->zeroEntries();
+      BPn[k]->zeroEntries();
+      for (int j = m; j < ns; j++) {
+        Pn[k]->axpy(y[j], S[j]);
+        BPn[k]->axpy(y[j], BS[j]);
+      }
+      Xn[k]->copyValues(Pn[k]);
+      BXn[k]->copyValues(BPn[k]);
+      for (int j = 0; j < m; j++) {
+        Xn[k]->axpy(y[j], S[j]);
+        BXn[k]->axpy(y[j], BS[j]);
+      }
+      eigvals[k] = ritzvals[k];
+    }
+
+    for (int k = 0; k < m; k++) {
+      TACSVec *t = X[k];
+      X[k] = Xn[k];
+      Xn[k] = t;
+      t = BX[k];
+      BX[k] = BXn[k];
+      BXn[k] = t;
+      t = P[k];
+      P[k] = Pn[k];
+      Pn[k] = t;
+      t = BP[k];
+      BP[k] = BPn[k];
+      BPn[k] = t;
+    }
+    has_dirs = (ns > m);
+  }
+
+  delete[] converged;
+
+  if (ksm_print) {
+    char line[256];
+    sprintf(line, "LOBPCG: %d of %d eigenvalues converged in %d iterations\n",
+            (nconverged < num_eigvals ? nconverged : num_eigvals), num_eigvals,
+            iter);
+    ksm_print->print(line);
+  }
+}
@@ -0,0 +1,101 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_LOBPCG_H
+#define TACS_LOBPCG_H
+
+#include "JacobiDavidson.h"
+
+/*
+  The locally optimal block preconditioned conjugate gradient (LOBPCG)
+  method for the smallest eigenvalues of the generalized eigenproblem
+
+  A*x = lambda*B*x
+
+  The method uses the same operator as the Jacobi-Davidson method. At
+  each iteration, the preconditioner is applied to the residuals of the
+  block of Ritz vectors X and the Rayleigh-Ritz method is applied on the
+  subspace spanned by X, the preconditioned residuals W and the previous
+  search directions P. The subspace is kept B-orthonormal so that only a
+  small symmetric eigenproblem is solved with LAPACK. Converged vectors
+  are soft-locked: they remain in X but no new directions are computed
+  for them.
+
+  Unlike the shift-invert Lanczos method, only the action of the
+  preconditioner is required. With a multigrid preconditioner, no
+  factorization of the shifted operator is needed and all the modes
+  within the block converge together.
+*/
+class TACSLOBPCG : public TACSObject {
+ public:
+  TACSLOBPCG(TACSJacobiDavidsonOperator *_oper, int _num_eigvals,
+             int _block_size, int _max_iters = 200);
+  ~TACSLOBPCG();
+
+  // Get the MPI_Comm
+  MPI_Comm getMPIComm();
+
+  // Extract the eigenvalues and eigenvectors
+  int getNumConvergedEigenvalues();
+  TacsScalar extractEigenvalue(int n, TacsScalar *error);
+  TacsScalar extractEigenvector(int n, TACSVec *ans, TacsScalar *error);
+
+  // Solve the eigenvalue problem
+  void solve(KSMPrint *ksm_print = NULL, int print_level = 0);
+
+  // Set the relative and absolute tolerances on the residual
+  void setTolerances(double _eig_rtol, double _eig_atol);
+
+ private:
+  // B-orthonormalize a vector against the subspace
+  int orthonormalize(int ns, TACSVec **S, TACSVec **BS, TACSVec *v,
+                     TACSVec *Bv);
+
+  // Solve the projected eigenproblem with LAPACK
+  int solveProjected(int ns);
+
+  // The operator class that defines the eigenproblem
+  TACSJacobiDavidsonOperator *oper;
+
+  // The number of eigenvalues, the block size and iteration limit
+  int num_eigvals, block_size, max_iters;
+
+  // The relative and absolute tolerances
+  double eig_rtol, eig_atol;
+
+  // The number of converged eigenvalues
+  int nconverged;
+
+  // Flag to indicate whether the block holds a previous solution
+  int has_solution;
+
+  // The Ritz values and the norms of the residuals
+  TacsScalar *eigvals, *eigerror;
+
+  // The Ritz vectors, preconditioned residuals, search directions and
+  // their products with B, and the vectors for the next iteration
+  TACSVec **X, **BX, **W, **BW, **P, **BP;
+  TACSVec **Xn, **BXn, **Pn, **BPn;
+  TACSVec *work;
+
+  // The subspace and its products with B
+  TACSVec **S, **BS;
+
+  // Data for the projected eigenproblem
+  TacsScalar *dots;
+  double *gA, *ritzvals, *rwork;
+  int lwork;
+};
+
+#endif  // TACS_LOBPCG_H
@@ -18,8 +18,13 @@
 
 #include "TACSBVec.h"
 
+#include "TACSCommProfiler.h"
 #include "tacslapack.h"
 
+// The number of rows in each panel for the multiple dot products and
+// the multiple axpy
+static const int TACS_BVEC_PANEL_SIZE = 256;
+
 /*
   The following class defines the dependent node information.
 
@@ -34,12 +39,17 @@ TACSBVecDepNodes::TACSBVecDepNodes(int _ndep_nodes, int **_dep_ptr,
   *_dep_conn = NULL;
   dep_weights = *_dep_weights;
   *_dep_weights = NULL;
+  block_size = 0;
+  dep_block_weights = NULL;
 }
 
 TACSBVecDepNodes::~TACSBVecDepNodes() {
   delete[] dep_ptr;
   delete[] dep_conn;
   delete[] dep_weights;
+  if (dep_block_weights) {
+    delete[] dep_block_weights;
+  }
 }
 
 /*
@@ -59,6 +69,45 @@ int TACSBVecDepNodes::getDepNodes(const int **_dep_ptr, const int **_dep_conn,
   return ndep_nodes;
 }
 
+/*
+  Set block weights for the dependent nodes.
+
+  The block weights replace the scalar weights for vectors with the
+  given block size, so that the components of the dependent node are
+  coupled to the components of the independent nodes. Each weight is
+  a block_size x block_size matrix stored in row-major order such that
+
+  x_dep[i] = sum_{j} W_{j}[block_size*i + k] x_{j}[k]
+
+  Vectors with a different block size, such as the node locations,
+  still use the scalar weights. Note that this class steals the
+  ownership of the data.
+*/
+void TACSBVecDepNodes::setBlockWeights(int _block_size,
+                                       double **_dep_block_weights) {
+  if (dep_block_weights) {
+    delete[] dep_block_weights;
+  }
+  block_size = _block_size;
+  dep_block_weights = *_dep_block_weights;
+  *_dep_block_weights = NULL;
+}
+
+/*
+  Get the block weights for the dependent nodes
+
+  @return The block size of the weights (zero if not set)
+*/
+int TACSBVecDepNodes::getBlockWeights(const double **_dep_block_weights) {
+  if (_dep_block_weights) {
+    *_dep_block_weights = dep_block_weights;
+  }
+  if (dep_block_weights) {
+    return block_size;
+  }
+  return 0;
+}
+
 /*
   Get the dependent node connectivity for reordering
 */
@@ -76,24 +125,26 @@ int TACSBVecDepNodes::getDepNodeReorder(const int **_dep_ptr, int **_dep_conn) {
   Create a block-based parallel vector
 
   input:
-  rmap:   the variable->processor map for the unknowns
-  bcs:    the boundary conditions associated with this vector
+  rmap:         the variable->processor map for the unknowns
+  bcs:          the boundary conditions associated with this vector
+  thread_info:  the memory policy used to allocate the owned values
 */
 TACSBVec::TACSBVec(TACSNodeMap *map, int _bsize, TACSBVecDistribute *_ext_dist,
-                   TACSBVecDepNodes *_dep_nodes) {
+                   TACSBVecDepNodes *_dep_nodes, TACSThreadInfo *thread_info) {
   node_map = map;
   node_map->incref();
 
   // Get the MPI communicator
   comm = node_map->getMPIComm();
+  mdot_req.request = MPI_REQUEST_NULL;
 
   // Set the block size
   bsize = _bsize;
   size = bsize * node_map->getNumNodes();
 
   // Allocate the array of owned unknowns
-  x = new TacsScalar[size];
-  memset(x, 0, size * sizeof(TacsScalar));
+  x = TacsAllocScalarArray(size, thread_info, node_map->getNumNodes(), NULL,
+                           bsize);
 
   // Set the external data
   ext_dist = _ext_dist;
@@ -126,6 +177,25 @@ TACSBVec::TACSBVec(TACSNodeMap *map, int _bsize, TACSBVecDistribute *_ext_dist,
     dep_size = 0;
     x_dep = NULL;
   }
+
+  // Record the memory for the vector
+  mem_category = TACS_MEMORY_VECTOR;
+  mem_bytes = 0;
+  TACSMemory::update(mem_category, &mem_bytes,
+                     (size + ext_size + dep_size) * sizeof(TacsScalar));
+}
+
+/*
+  Set the category that the memory for this vector is charged to
+
+  This is used by the solvers and integrators that hold many vectors,
+  so that the memory is reported for the subsystem that uses it.
+*/
+void TACSBVec::setMemoryCategory(int category) {
+  if (category >= 0 && category < TACS_MEMORY_NUM_CATEGORIES) {
+    TACSMemory::move(mem_category, category, mem_bytes);
+    mem_category = category;
+  }
 }
 
 /*
@@ -141,29 +211,36 @@ TACSBVec::TACSBVec(MPI_Comm _comm, int _size, int _bsize) {
   bsize = _bsize;
   size = _size;
   comm = _comm;
+  mdot_req.request = MPI_REQUEST_NULL;
   node_map = NULL;
 
-  x = new TacsScalar[size];
-  memset(x, 0, size * sizeof(TacsScalar));
+  x = TacsAllocScalarArray(size);
 
   // Zero/NULL the external data
   ext_size = 0;
   x_ext = NULL;
   ext_dist = NULL;
+  ext_indices = NULL;
   ext_ctx = NULL;
 
   // Zero/NULL the dependent node data
   dep_size = 0;
   x_dep = NULL;
   dep_nodes = NULL;
+
+  // Record the memory for the vector
+  mem_category = TACS_MEMORY_VECTOR;
+  mem_bytes = 0;
+  TACSMemory::update(mem_category, &mem_bytes, size * sizeof(TacsScalar));
 }
 
 TACSBVec::~TACSBVec() {
+  TACSMemory::update(mem_category, &mem_bytes, 0);
   if (node_map) {
     node_map->decref();
   }
   if (x) {
-    delete[] x;
+    TacsFreeScalarArray(x);
   }
   if (x_ext) {
     delete[] x_ext;
@@ -194,8 +271,20 @@ void TACSBVec::getSize(int *_size) { *_size = size; }
   Compute the norm of the vector
 */
 TacsScalar TACSBVec::norm() {
-  // Compute the norm for each processor
-  TacsScalar res, sum;
+  TacsScalar res = localNormSquared();
+  TacsScalar sum;
+  TACSCommProfiler::addCollective(TACS_COMM_REDUCTION, sizeof(TacsScalar));
+  double t0 = TACSCommProfiler::beginWait();
+  MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
+  TACSCommProfiler::endWait(TACS_COMM_REDUCTION, t0);
+  return sqrt(sum);
+}
+
+/*
+  Compute the on-processor contribution to the square of the norm
+*/
+TacsScalar TACSBVec::localNormSquared() {
+  TacsScalar res;
 #if defined(TACS_USE_COMPLEX)
   res = 0.0;
   int i = 0;
@@ -217,9 +306,7 @@ TacsScalar TACSBVec::norm() {
 #endif
   TacsAddFlops(2 * size);
 
-  MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
-
-  return sqrt(sum);
+  return res;
 }
 
 /*
@@ -243,36 +330,48 @@ TacsScalar TACSBVec::dot(TACSVec *tvec) {
       return 0.0;
     }
 
-    TacsScalar res;
-#if defined(TACS_USE_COMPLEX)
-    res = 0.0;
-    int i = 0;
-    int rem = size % 4;
-    TacsScalar *y = x;
-    TacsScalar *z = vec->x;
-    for (; i < rem; i++) {
-      res += y[0] * z[0];
-      y++;
-      z++;
-    }
-
-    for (; i < size; i += 4) {
-      res += y[0] * z[0] + y[1] * z[1] + y[2] * z[2] + y[3] * z[3];
-      y += 4;
-      z += 4;
-    }
-#else
-    int one = 1;
-    res = BLASdot(&size, x, &one, vec->x, &one);
-#endif
+    TacsScalar res = localDot(vec);
+    TACSCommProfiler::addCollective(TACS_COMM_REDUCTION, sizeof(TacsScalar));
+    double t0 = TACSCommProfiler::beginWait();
     MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
+    TACSCommProfiler::endWait(TACS_COMM_REDUCTION, t0);
   } else {
     fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
   }
 
+  return sum;
+}
+
+/*
+  Compute the on-processor contribution to the dot product. The sizes
+  of the vectors must be the same.
+*/
+TacsScalar TACSBVec::localDot(TACSBVec *vec) {
+  TacsScalar res;
+#if defined(TACS_USE_COMPLEX)
+  res = 0.0;
+  int i = 0;
+  int rem = size % 4;
+  TacsScalar *y = x;
+  TacsScalar *z = vec->x;
+  for (; i < rem; i++) {
+    res += y[0] * z[0];
+    y++;
+    z++;
+  }
+
+  for (; i < size; i += 4) {
+    res += y[0] * z[0] + y[1] * z[1] + y[2] * z[2] + y[3] * z[3];
+    y += 4;
+    z += 4;
+  }
+#else
+  int one = 1;
+  res = BLASdot(&size, x, &one, vec->x, &one);
+#endif
   TacsAddFlops(2 * size);
 
-  return sum;
+  return res;
 }
 
 /*
@@ -281,47 +380,207 @@ TacsScalar TACSBVec::dot(TACSVec *tvec) {
   number of dot products.
 */
 void TACSBVec::mdot(TACSVec **tvec, TacsScalar *ans, int nvecs) {
-  for (int k = 0; k < nvecs; k++) {
-    ans[k] = 0.0;
+  localMdot(tvec, ans, nvecs);
+  TACSCommProfiler::addCollective(TACS_COMM_REDUCTION,
+                                  nvecs * sizeof(TacsScalar));
+  double t0 = TACSCommProfiler::beginWait();
+  MPI_Allreduce(MPI_IN_PLACE, ans, nvecs, TACS_MPI_TYPE, MPI_SUM, comm);
+  TACSCommProfiler::endWait(TACS_COMM_REDUCTION, t0);
+}
 
-    TACSBVec *vec = dynamic_cast<TACSBVec *>(tvec[k]);
-    if (vec) {
-      if (vec->size != size) {
-        fprintf(stderr, "TACSBVec::dot Error, the sizes must be the same\n");
-        continue;
-      }
+/*
+  Start the multiple dot product without waiting for the result.
+
+  The local contributions are computed and a non-blocking reduction is
+  started. The result in ans is not available until mdotEnd() is
+  called with the same array. Other work that does not involve ans may
+  be performed between the two calls to hide the latency of the
+  reduction. Only one reduction started with mdotBegin() may be
+  outstanding for each vector, use beginMdot() for more.
+*/
+void TACSBVec::mdotBegin(TACSVec **tvec, TacsScalar *ans, int nvecs) {
+  beginMdot(tvec, ans, nvecs, &mdot_req);
+}
 
-#if defined(TACS_USE_COMPLEX)
+/*
+  Complete the multiple dot product started by mdotBegin()
+*/
+void TACSBVec::mdotEnd(TacsScalar *ans, int nvecs) { endMdot(&mdot_req); }
+
+/*
+  Start the sum of the values in the request over all processors
+*/
+void TACSBVec::beginReduction(TACSVecRequest *req, TacsScalar *vals, int n) {
+  TACSCommProfiler::addCollective(TACS_COMM_REDUCTION, n * sizeof(TacsScalar));
+#if MPI_VERSION >= 3
+  MPI_Iallreduce(MPI_IN_PLACE, vals, n, TACS_MPI_TYPE, MPI_SUM, comm,
+                 &req->request);
+#else
+  MPI_Allreduce(MPI_IN_PLACE, vals, n, TACS_MPI_TYPE, MPI_SUM, comm);
+  req->request = MPI_REQUEST_NULL;
+#endif
+}
+
+/*
+  Start the dot product with a non-blocking reduction. The result is
+  returned by endDot().
+*/
+void TACSBVec::beginDot(TACSVec *tvec, TACSVecRequest *req) {
+  req->values[0] = 0.0;
+  TACSBVec *vec = dynamic_cast<TACSBVec *>(tvec);
+  if (vec) {
+    if (vec->size != size) {
+      fprintf(stderr, "TACSBVec::dot Error, the sizes must be the same\n");
+    } else {
+      req->values[0] = localDot(vec);
+    }
+  } else {
+    fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
+  }
+  beginReduction(req, req->values, 1);
+}
+
+/*
+  Start the norm with a non-blocking reduction. The result is
+  returned by endNorm().
+*/
+void TACSBVec::beginNorm(TACSVecRequest *req) {
+  req->values[0] = localNormSquared();
+  beginReduction(req, req->values, 1);
+}
+
+/*
+  Start the multiple dot product with a non-blocking reduction. The
+  values in ans are not available until endMdot() is called.
+*/
+void TACSBVec::beginMdot(TACSVec **tvec, TacsScalar *ans, int nvecs,
+                         TACSVecRequest *req) {
+  localMdot(tvec, ans, nvecs);
+  beginReduction(req, ans, nvecs);
+}
+
+/*
+  Compute y <- y + alpha*x and start the reduction for the norm of the
+  updated vector. The update and the local contribution to the norm
+  are computed in a single pass over the vector.
+*/
+void TACSBVec::beginAxpyNorm(TacsScalar alpha, TACSVec *tvec,
+                             TACSVecRequest *req) {
+  req->values[0] = 0.0;
+  TACSBVec *vec = dynamic_cast<TACSBVec *>(tvec);
+  if (vec) {
+    if (vec->size != size) {
+      fprintf(stderr, "TACSBVec::axpy Error, the sizes must be the same\n");
+    } else {
       TacsScalar res = 0.0;
-      int i = 0;
-      int rem = size % 4;
-      TacsScalar *y = x;
-      TacsScalar *z = vec->x;
-      for (; i < rem; i++) {
-        res += y[0] * z[0];
-        y++;
-        z++;
+      const TacsScalar *z = vec->x;
+      for (int i = 0; i < size; i++) {
+        x[i] += alpha * z[i];
+        res += x[i] * x[i];
       }
+      req->values[0] = res;
+      TacsAddFlops(4 * size);
+    }
+  } else {
+    fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
+  }
+  beginReduction(req, req->values, 1);
+}
 
-      for (; i < size; i += 4) {
-        res += y[0] * z[0] + y[1] * z[1] + y[2] * z[2] + y[3] * z[3];
-        y += 4;
-        z += 4;
+/*
+  Start the dot products of this vector with x1 and x2. The local
+  contributions are computed in a single pass and both values are
+  summed with a single reduction.
+*/
+void TACSBVec::beginDot2(TACSVec *tvec1, TACSVec *tvec2,
+                         TACSVecRequest *req) {
+  req->values[0] = req->values[1] = 0.0;
+  TACSBVec *vec1 = dynamic_cast<TACSBVec *>(tvec1);
+  TACSBVec *vec2 = dynamic_cast<TACSBVec *>(tvec2);
+  if (vec1 && vec2) {
+    if (vec1->size != size || vec2->size != size) {
+      fprintf(stderr, "TACSBVec::dot Error, the sizes must be the same\n");
+    } else {
+      TacsScalar res1 = 0.0, res2 = 0.0;
+      const TacsScalar *z1 = vec1->x;
+      const TacsScalar *z2 = vec2->x;
+      for (int i = 0; i < size; i++) {
+        res1 += x[i] * z1[i];
+        res2 += x[i] * z2[i];
       }
+      req->values[0] = res1;
+      req->values[1] = res2;
+      TacsAddFlops(4 * size);
+    }
+  } else {
+    fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
+  }
+  beginReduction(req, req->values, 2);
+}
 
-      ans[k] = res;
+/*
+  Compute the on-processor contributions to the multiple dot product
+*/
+void TACSBVec::localMdot(TACSVec **tvec, TacsScalar *ans, int nvecs) {
+  TacsScalar **z = new TacsScalar *[nvecs];
+  getVecArrays(tvec, nvecs, z);
+  for (int k = 0; k < nvecs; k++) {
+    ans[k] = 0.0;
+  }
+
+  // Compute the products in panels of rows so that each panel of this
+  // vector is read from memory once for all the vectors
+  for (int start = 0; start < size; start += TACS_BVEC_PANEL_SIZE) {
+    int n = size - start;
+    if (n > TACS_BVEC_PANEL_SIZE) {
+      n = TACS_BVEC_PANEL_SIZE;
+    }
+    TacsScalar *y = &x[start];
+    for (int k = 0; k < nvecs; k++) {
+      if (z[k]) {
+#if defined(TACS_USE_COMPLEX)
+        const TacsScalar *zk = &z[k][start];
+        TacsScalar res = 0.0;
+        for (int i = 0; i < n; i++) {
+          res += y[i] * zk[i];
+        }
+        ans[k] += res;
 #else
-      int one = 1;
-      ans[k] = BLASdot(&size, x, &one, vec->x, &one);
+        int one = 1;
+        ans[k] += BLASdot(&n, y, &one, &z[k][start], &one);
 #endif
-    } else {
-      fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
+      }
     }
   }
-
   TacsAddFlops(2 * nvecs * size);
 
-  MPI_Allreduce(MPI_IN_PLACE, ans, nvecs, TACS_MPI_TYPE, MPI_SUM, comm);
+  delete[] z;
+}
+
+/*
+  Get the arrays of the given vectors. The array is NULL for any
+  vector that is not a TACSBVec or that has a different size.
+
+  returns: the number of valid arrays
+*/
+int TACSBVec::getVecArrays(TACSVec **tvec, int nvecs, TacsScalar **arrays) {
+  int nvalid = 0;
+  for (int k = 0; k < nvecs; k++) {
+    arrays[k] = NULL;
+
+    TACSBVec *vec = dynamic_cast<TACSBVec *>(tvec[k]);
+    if (vec) {
+      if (vec->size != size) {
+        fprintf(stderr, "TACSBVec::mdot Error, the sizes must be the same\n");
+        continue;
+      }
+      arrays[k] = vec->x;
+      nvalid++;
+    } else {
+      fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
+    }
+  }
+  return nvalid;
 }
 
 /*
@@ -345,6 +604,34 @@ void TACSBVec::axpy(TacsScalar alpha, TACSVec *tvec) {
   TacsAddFlops(2 * size);
 }
 
+/*
+  Compute y <- y + sum alpha[k]*x[k]
+
+  The update is computed in panels of rows so that each panel of this
+  vector is read and written once for all the vectors in x.
+*/
+void TACSBVec::maxpy(int nvecs, const TacsScalar *alpha, TACSVec **tvec) {
+  TacsScalar **z = new TacsScalar *[nvecs];
+  getVecArrays(tvec, nvecs, z);
+
+  for (int start = 0; start < size; start += TACS_BVEC_PANEL_SIZE) {
+    int n = size - start;
+    if (n > TACS_BVEC_PANEL_SIZE) {
+      n = TACS_BVEC_PANEL_SIZE;
+    }
+    for (int k = 0; k < nvecs; k++) {
+      if (z[k]) {
+        int one = 1;
+        TacsScalar a = alpha[k];
+        BLASaxpy(&n, &a, &z[k][start], &one, &x[start], &one);
+      }
+    }
+  }
+  TacsAddFlops(2 * nvecs * size);
+
+  delete[] z;
+}
+
 /*
   Compute x <- alpha *vec + beta *x
 */
@@ -477,8 +764,8 @@ void TACSBVec::setRand(double lower, double upper) {
     // processors.
     for (int k = 0; k < mpi_size; k++) {
       if (k != mpi_rank) {
-        int end = bsize * owner_range[k + 1];
-        for (int i = bsize * owner_range[k]; i < end; i++) {
+        int count = bsize * (owner_range[k + 1] - owner_range[k]);
+        for (int i = 0; i < count; i++) {
           rand();
         }
       } else {
@@ -641,24 +928,15 @@ const char *TACSBVec::getObjectName() { return vecName; }
   The file format is as follows:
   int                      The length of the vector
   len *sizeof(TacsScalar)  The vector entries
+
+  Vectors longer than INT_MAX store -1 followed by the length as a
+  64-bit integer in place of the int length.
 */
 int TACSBVec::writeToFile(const char *filename) {
-  int mpi_rank, mpi_size;
-  MPI_Comm_rank(comm, &mpi_rank);
-  MPI_Comm_size(comm, &mpi_size);
-
   // Copy the filename
   char *fname = new char[strlen(filename) + 1];
   strcpy(fname, filename);
 
-  // Get the range of variable numbers
-  int *range = new int[mpi_size + 1];
-  range[0] = 0;
-  MPI_Allgather(&size, 1, MPI_INT, &range[1], 1, MPI_INT, comm);
-  for (int i = 0; i < mpi_size; i++) {
-    range[i + 1] += range[i];
-  }
-
   // Open the MPI file
   int fail = 0;
   MPI_File fp = NULL;
@@ -666,26 +944,86 @@ int TACSBVec::writeToFile(const char *filename) {
                 &fp);
 
   if (fp) {
-    if (mpi_rank == 0) {
-      MPI_File_write(fp, &range[mpi_size], 1, MPI_INT, MPI_STATUS_IGNORE);
-    }
-
-    char datarep[] = "native";
-    MPI_File_set_view(fp, sizeof(int), TACS_MPI_TYPE, TACS_MPI_TYPE, datarep,
-                      MPI_INFO_NULL);
-    MPI_File_write_at_all(fp, range[mpi_rank], x, size, TACS_MPI_TYPE,
-                          MPI_STATUS_IGNORE);
+    MPI_Offset offset = 0;
+    fail = writeToFile(fp, &offset);
     MPI_File_close(&fp);
   } else {
     fail = 1;
   }
 
-  delete[] range;
   delete[] fname;
 
   return fail;
 }
 
+/*
+  Get the global range of the entries of the vector owned by each
+  processor. The array is allocated with new[] and must be freed by
+  the caller.
+*/
+TacsGlobalIndex *TACSBVec::getGlobalRange() {
+  int mpi_size;
+  MPI_Comm_size(comm, &mpi_size);
+
+  TacsGlobalIndex local_size = size;
+  TacsGlobalIndex *range = new TacsGlobalIndex[mpi_size + 1];
+  range[0] = 0;
+  MPI_Allgather(&local_size, 1, TACS_MPI_GLOBAL_INDEX, &range[1], 1,
+                TACS_MPI_GLOBAL_INDEX, comm);
+  for (int i = 0; i < mpi_size; i++) {
+    range[i + 1] += range[i];
+  }
+
+  return range;
+}
+
+/*!
+  Write the values to an open MPI file at the given byte offset.
+
+  The vector is written in the same format as writeToFile(filename)
+  and the offset is advanced past the end of the vector, so that
+  several vectors can be written to the same file. This call is
+  collective and the offset must be the same on all processors.
+*/
+int TACSBVec::writeToFile(MPI_File fp, MPI_Offset *offset) {
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  // Get the range of variable numbers
+  TacsGlobalIndex *range = getGlobalRange();
+  TacsGlobalIndex len = range[mpi_size];
+
+  // Use the 64-bit length only when the length does not fit in an int
+  int len32 = (len > INT_MAX ? -1 : (int)len);
+  MPI_Offset header = sizeof(int);
+  if (len32 < 0) {
+    header += sizeof(int64_t);
+  }
+
+  char datarep[] = "native";
+  MPI_File_set_view(fp, *offset, MPI_BYTE, MPI_BYTE, datarep, MPI_INFO_NULL);
+  if (mpi_rank == 0) {
+    MPI_File_write_at(fp, 0, &len32, sizeof(int), MPI_BYTE, MPI_STATUS_IGNORE);
+    if (len32 < 0) {
+      int64_t len64 = len;
+      MPI_File_write_at(fp, sizeof(int), &len64, sizeof(int64_t), MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+    }
+  }
+
+  MPI_File_set_view(fp, *offset + header, TACS_MPI_TYPE, TACS_MPI_TYPE,
+                    datarep, MPI_INFO_NULL);
+  MPI_File_write_at_all(fp, range[mpi_rank], x, size, TACS_MPI_TYPE,
+                        MPI_STATUS_IGNORE);
+
+  *offset += header + (MPI_Offset)len * sizeof(TacsScalar);
+
+  delete[] range;
+
+  return 0;
+}
+
 /*!
   Read values from a binary data file.
 
@@ -695,57 +1033,87 @@ int TACSBVec::writeToFile(const char *filename) {
   The file format is as follows:
   int                      The length of the vector
   len *sizeof(TacsScalar)  The vector entries
+
+  Vectors longer than INT_MAX store -1 followed by the length as a
+  64-bit integer in place of the int length.
 */
 int TACSBVec::readFromFile(const char *filename) {
-  int mpi_rank, mpi_size;
-  MPI_Comm_rank(comm, &mpi_rank);
-  MPI_Comm_size(comm, &mpi_size);
-
   // Copy the filename
   char *fname = new char[strlen(filename) + 1];
   strcpy(fname, filename);
 
-  // Get the range of variable numbers
-  int *range = new int[mpi_size + 1];
-  range[0] = 0;
-  MPI_Allgather(&size, 1, MPI_INT, &range[1], 1, MPI_INT, comm);
-  for (int i = 0; i < mpi_size; i++) {
-    range[i + 1] += range[i];
-  }
-
   int fail = 0;
   MPI_File fp = NULL;
   MPI_File_open(comm, fname, MPI_MODE_RDONLY, MPI_INFO_NULL, &fp);
 
   if (fp) {
-    int len = 0;
-    if (mpi_rank == 0) {
-      MPI_File_read(fp, &len, 1, MPI_INT, MPI_STATUS_IGNORE);
-    }
-    MPI_Bcast(&len, 1, MPI_INT, 0, comm);
-    if (len != range[mpi_size]) {
-      fprintf(stderr,
-              "[%d] Cannot read TACSBVec from file, incorrect "
-              "size %d != %d\n",
-              mpi_rank, range[mpi_size], len);
-      memset(x, 0, size * sizeof(TacsScalar));
+    MPI_Offset offset = 0;
+    fail = readFromFile(fp, &offset);
+    MPI_File_close(&fp);
+  } else {
+    fail = 1;
+  }
+
+  delete[] fname;
+
+  return fail;
+}
+
+/*!
+  Read the values from an open MPI file at the given byte offset.
 
-      // Mark this as a failure
-      fail = 1;
+  The offset is advanced past the end of the vector in the file. This
+  call is collective and the offset must be the same on all
+  processors.
+*/
+int TACSBVec::readFromFile(MPI_File fp, MPI_Offset *offset) {
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  // Get the range of variable numbers
+  TacsGlobalIndex *range = getGlobalRange();
+
+  int fail = 0;
+  int64_t len = 0;
+  MPI_Offset header = sizeof(int);
+  char datarep[] = "native";
+  MPI_File_set_view(fp, *offset, MPI_BYTE, MPI_BYTE, datarep, MPI_INFO_NULL);
+  if (mpi_rank == 0) {
+    int len32 = 0;
+    MPI_File_read_at(fp, 0, &len32, sizeof(int), MPI_BYTE, MPI_STATUS_IGNORE);
+    len = len32;
+    if (len32 < 0) {
+      MPI_File_read_at(fp, sizeof(int), &len, sizeof(int64_t), MPI_BYTE,
+                       MPI_STATUS_IGNORE);
     }
+  }
+  MPI_Bcast(&len, 1, MPI_INT64_T, 0, comm);
+  if (len > INT_MAX) {
+    header += sizeof(int64_t);
+  }
+
+  if (len != range[mpi_size]) {
+    fprintf(stderr,
+            "[%d] Cannot read TACSBVec from file, incorrect "
+            "size %lld != %lld\n",
+            mpi_rank, (long long)range[mpi_size], (long long)len);
+    memset(x, 0, size * sizeof(TacsScalar));
 
-    char datarep[] = "native";
-    MPI_File_set_view(fp, sizeof(int), TACS_MPI_TYPE, TACS_MPI_TYPE, datarep,
-                      MPI_INFO_NULL);
+    // Mark this as a failure
+    fail = 1;
+  } else {
+    MPI_File_set_view(fp, *offset + header, TACS_MPI_TYPE, TACS_MPI_TYPE,
+                      datarep, MPI_INFO_NULL);
     MPI_File_read_at_all(fp, range[mpi_rank], x, size, TACS_MPI_TYPE,
                          MPI_STATUS_IGNORE);
-    MPI_File_close(&fp);
-  } else {
-    fail = 1;
+  }
+
+  if (len > 0) {
+    *offset += header + (MPI_Offset)len * sizeof(TacsScalar);
   }
 
   delete[] range;
-  delete[] fname;
 
   return fail;
 }
@@ -857,26 +1225,38 @@ void TACSBVec::beginSetValues(TACSBVecOperation op) {
     const double *dep_weights;
     int ndep = dep_nodes->getDepNodes(&dep_ptr, &dep_conn, &dep_weights);
 
+    // Use the block weights if they match this vector
+    const double *dep_blocks;
+    if (dep_nodes->getBlockWeights(&dep_blocks) != bsize) {
+      dep_blocks = NULL;
+    }
+
     const TacsScalar *z = x_dep;
     for (int i = 0; i < ndep; i++, z += bsize) {
       for (int jp = dep_ptr[i]; jp < dep_ptr[i + 1]; jp++) {
+        TacsScalar *y = NULL;
+
         // Check if the dependent node is locally owned
         if (dep_conn[jp] >= owner_range[rank] &&
             dep_conn[jp] < owner_range[rank + 1]) {
           // Find the offset into the local array
           int x_index = bsize * (dep_conn[jp] - owner_range[rank]);
-          TacsScalar *y = &x[x_index];
-
-          // Add the values to the array
-          for (int k = 0; k < bsize; k++, y++) {
-            y[0] += dep_weights[jp] * z[k];
-          }
+          y = &x[x_index];
         } else {
           // Add the dependent values to external array
           int ext_index = bsize * ext_indices->findIndex(dep_conn[jp]);
-          TacsScalar *y = &x_ext[ext_index];
+          y = &x_ext[ext_index];
+        }
 
-          // Add the values to the array
+        // Add the values to the array
+        if (dep_blocks) {
+          const double *W = &dep_blocks[bsize * bsize * jp];
+          for (int k = 0; k < bsize; k++) {
+            for (int l = 0; l < bsize; l++) {
+              y[l] += W[bsize * k + l] * z[k];
+            }
+          }
+        } else {
           for (int k = 0; k < bsize; k++, y++) {
             y[0] += dep_weights[jp] * z[k];
           }
@@ -941,6 +1321,12 @@ void TACSBVec::endDistributeValues() {
     const double *dep_weights;
     int ndep = dep_nodes->getDepNodes(&dep_ptr, &dep_conn, &dep_weights);
 
+    // Use the block weights if they match this vector
+    const double *dep_blocks;
+    if (dep_nodes->getBlockWeights(&dep_blocks) != bsize) {
+      dep_blocks = NULL;
+    }
+
     // Set a pointer into the dependent variables
     TacsScalar *z = x_dep;
     for (int i = 0; i < ndep; i++, z += bsize) {
@@ -951,22 +1337,28 @@ void TACSBVec::endDistributeValues() {
 
       // Compute the weighted value of the dependent node
       for (int jp = dep_ptr[i]; jp < dep_ptr[i + 1]; jp++) {
+        const TacsScalar *y = NULL;
+
         // Check if the dependent node is locally owned
         if (dep_conn[jp] >= owner_range[rank] &&
             dep_conn[jp] < owner_range[rank + 1]) {
           // Find the offset into the local array
           int x_index = bsize * (dep_conn[jp] - owner_range[rank]);
-          TacsScalar *y = &x[x_index];
-
-          // Add the values to the array
-          for (int k = 0; k < bsize; k++, y++) {
-            z[k] += dep_weights[jp] * y[0];
-          }
+          y = &x[x_index];
         } else {
           int ext_index = bsize * ext_indices->findIndex(dep_conn[jp]);
-          TacsScalar *y = &x_ext[ext_index];
+          y = &x_ext[ext_index];
+        }
 
-          // Add the values to the array
+        // Add the values to the array
+        if (dep_blocks) {
+          const double *W = &dep_blocks[bsize * bsize * jp];
+          for (int k = 0; k < bsize; k++) {
+            for (int l = 0; l < bsize; l++) {
+              z[k] += W[bsize * k + l] * y[l];
+            }
+          }
+        } else {
           for (int k = 0; k < bsize; k++, y++) {
             z[k] += dep_weights[jp] * y[0];
           }
@@ -45,10 +45,19 @@ class TACSBVecDepNodes : public TACSObject {
   // --------------------------------------------------
   int getDepNodeReorder(const int **_dep_ptr, int **_dep_conn);
 
+  // Set/get the block weights used for vectors of a given block size
+  // ----------------------------------------------------------------
+  void setBlockWeights(int _block_size, double **_dep_block_weights);
+  int getBlockWeights(const double **_dep_block_weights);
+
  private:
   int ndep_nodes;
   int *dep_ptr, *dep_conn;
   double *dep_weights;
+
+  // Optional block weights (block_size x block_size per weight)
+  int block_size;
+  double *dep_block_weights;
 };
 
 /*
@@ -67,7 +76,8 @@ class TACSBVecDepNodes : public TACSObject {
 class TACSBVec : public TACSVec {
  public:
   TACSBVec(TACSNodeMap *map, int bsize, TACSBVecDistribute *ext_dist = NULL,
-           TACSBVecDepNodes *dep_nodes = NULL);
+           TACSBVecDepNodes *dep_nodes = NULL,
+           TACSThreadInfo *thread_info = NULL);
   TACSBVec(MPI_Comm _comm, int size, int bsize);
   ~TACSBVec();
 
@@ -81,12 +91,27 @@ class TACSBVec : public TACSVec {
   TacsScalar dot(TACSVec *x);           // Compute x^{T}*y
   void mdot(TACSVec **x, TacsScalar *ans, int m);  // Multiple dot product
   void axpy(TacsScalar alpha, TACSVec *x);         // y <- y + alpha*x
+  void maxpy(int m, const TacsScalar *alpha,
+             TACSVec **x);  // y <- y + sum alpha[k]*x[k]
   void copyValues(TACSVec *x);                     // Copy values from x to this
   void axpby(TacsScalar alpha, TacsScalar beta,
              TACSVec *x);  // y <- alpha*x + beta*y
   void applyBCs(TACSBcMap *map, TACSVec *vec = NULL);
   void setBCs(TACSBcMap *map);
 
+  // Split the multiple dot product to overlap the reduction
+  // -------------------------------------------------------
+  void mdotBegin(TACSVec **x, TacsScalar *ans, int m);
+  void mdotEnd(TacsScalar *ans, int m);
+
+  // Split-phase and fused reductions
+  // --------------------------------
+  void beginDot(TACSVec *x, TACSVecRequest *req);
+  void beginNorm(TACSVecRequest *req);
+  void beginMdot(TACSVec **x, TacsScalar *ans, int m, TACSVecRequest *req);
+  void beginAxpyNorm(TacsScalar alpha, TACSVec *x, TACSVecRequest *req);
+  void beginDot2(TACSVec *x1, TACSVec *x2, TACSVecRequest *req);
+
   // Get/set the vector elements
   // ---------------------------
   void set(TacsScalar val);                  // Set all values of the vector
@@ -97,10 +122,16 @@ class TACSBVec : public TACSVec {
   void initRand();                           // Init random number generator
   void setRand(double lower, double upper);  // Set random values
 
+  // Set the category that the memory for this vector is charged to
+  // --------------------------------------------------------------
+  void setMemoryCategory(int category);
+
   // Read/write the vector to a binary file -- the same on all procs
   // ---------------------------------------------------------------
   int writeToFile(const char *filename);
   int readFromFile(const char *filename);
+  int writeToFile(MPI_File fp, MPI_Offset *offset);
+  int readFromFile(MPI_File fp, MPI_Offset *offset);
 
   // Retrieve objects stored within the vector class
   // -----------------------------------------------
@@ -127,9 +158,26 @@ class TACSBVec : public TACSVec {
   const char *getObjectName();
 
  private:
+  // Compute the local parts of the reductions
+  TacsScalar localNormSquared();
+  TacsScalar localDot(TACSBVec *vec);
+  void localMdot(TACSVec **x, TacsScalar *ans, int m);
+
+  // Get the arrays of a set of vectors with the same size as this one
+  int getVecArrays(TACSVec **x, int m, TacsScalar **arrays);
+
+  // Get the global range of entries owned by each processor
+  TacsGlobalIndex *getGlobalRange();
+
+  // Start the sum of the values over all processors
+  void beginReduction(TACSVecRequest *req, TacsScalar *vals, int n);
+
   // The MPI communicator
   MPI_Comm comm;
 
+  // The request for the outstanding split multiple dot product
+  TACSVecRequest mdot_req;
+
   // The variable map that defines the global distribution of nodes
   TACSNodeMap *node_map;
 
@@ -157,6 +205,10 @@ class TACSBVec : public TACSVec {
   // Pointer to the dependent node data
   TACSBVecDepNodes *dep_nodes;
 
+  // The memory recorded for the vector and its category
+  int mem_category;
+  size_t mem_bytes;
+
   // Name for the vector
   static const char *vecName;
 };
@@ -18,6 +18,9 @@
 
 #include "TACSBVecDistribute.h"
 
+#include "TACSCommProfiler.h"
+#include "TACSDevice.h"
+#include "TACSProfiler.h"
 #include "TacsUtilities.h"
 
 /*
@@ -290,11 +293,12 @@ void VecDistSetVars6(int bsize, int nvars, const int *vars, int lower,
   All variables eminating from [buffRange[n],buffRange[n+1]) For each
   process from which variables will be extracted, in the array proc.
 
-  3. Communicate the required number of variables between processes.
-  (Create appropriate buffers on each recieving process of appropriate size)
-  Communicate the block sizes back to the requesting processes.
-  (The buffer on the local/requesting process will be an offset into
-  index into the local array supplied by the user).
+  3. Send the required variables to the processes that own them,
+  using only messages between neighboring processes (see
+  findRequests()).
+
+  4. Create the distributed graph communicators used for the forward
+  and reverse transfers between the neighbors.
 */
 TACSBVecDistribute::TACSBVecDistribute(TACSNodeMap *_rmap,
                                        TACSBVecIndices *_bindex) {
@@ -356,17 +360,10 @@ TACSBVecDistribute::TACSBVecDistribute(TACSNodeMap *_rmap,
   MPI_Comm_size(comm, &mpi_size);
   MPI_Comm_rank(comm, &mpi_rank);
 
-  // Count up the number of processors that variables will be accquired from
-  // Number of variables required by mpiRank from processor i
-  int *full_ext_count = new int[mpi_size];
+  // Find the range of the external variables owned by each processor
   int *full_ext_ptr = new int[mpi_size + 1];
   full_ext_ptr[0] = 0;
 
-  // Number of variables requested from mpiRank by processor i
-  int *full_req_count = new int[mpi_size];
-  int *full_req_ptr = new int[mpi_size + 1];
-  full_req_ptr[0] = 0;
-
   // Get the ownership range
   const int *owner_range;
   rmap->getOwnerRange(&owner_range);
@@ -374,46 +371,13 @@ TACSBVecDistribute::TACSBVecDistribute(TACSNodeMap *_rmap,
   // Match the intervals for the owner range into the extneral variables
   TacsMatchIntervals(mpi_size, owner_range, next_vars, ext_vars, full_ext_ptr);
 
-  // Find the external counts destined for each processor
-  for (int i = 0; i < mpi_size; i++) {
-    full_ext_count[i] = full_ext_ptr[i + 1] - full_ext_ptr[i];
-    if (i == mpi_rank) {
-      full_ext_count[i] = 0;
-    }
-  }
-
-  // Transmit the number of external variables to the other processes
-  MPI_Alltoall(full_ext_count, 1, MPI_INT, full_req_count, 1, MPI_INT, comm);
-
-  // Set up the index into the array that will be filled
-  // with the requesting variables
-  full_req_ptr[0] = 0;
-  for (int i = 0; i < mpi_size; i++) {
-    full_req_ptr[i + 1] = full_req_ptr[i] + full_req_count[i];
-  }
-
-  // Allocate an array to store the requests from each processor
-  req_vars = new int[full_req_ptr[mpi_size]];
-
-  // Transmit the external variables to the owners
-  MPI_Alltoallv((void *)ext_vars, full_ext_count, full_ext_ptr, MPI_INT,
-                req_vars, full_req_count, full_req_ptr, MPI_INT, comm);
-
-  // Delete the requesting processors
-  delete[] full_ext_count;
-  delete[] full_req_count;
-
-  // Many processors will likely have no variables associated with
-  // them. Create a data structure so that we can skip these
-  // processors and avoid wasting CPU time.
-  int ne = 0, nr = 0;
+  // Count up the number of processors that variables will be
+  // accquired from
+  int ne = 0;
   for (int i = 0; i < mpi_size; i++) {
     if ((i != mpi_rank) && (full_ext_ptr[i + 1] - full_ext_ptr[i]) > 0) {
       ne++;
     }
-    if ((i != mpi_rank) && (full_req_ptr[i + 1] - full_req_ptr[i]) > 0) {
-      nr++;
-    }
   }
 
   // Set the size of the self data
@@ -427,14 +391,7 @@ TACSBVecDistribute::TACSBVecDistribute(TACSNodeMap *_rmap,
   ext_ptr = new int[n_ext_proc + 1];
   ext_count = new int[n_ext_proc];
 
-  // Number of processors to which we are sending data
-  n_req_proc = nr;
-  req_proc = new int[n_req_proc];
-  req_ptr = new int[n_req_proc + 1];
-  req_count = new int[n_req_proc];
-
-  // Set pointers to the external/requests processor ranks
-  ne = nr = 0;
+  ne = 0;
   for (int i = 0; i < mpi_size; i++) {
     if ((i != mpi_rank) && (full_ext_ptr[i + 1] - full_ext_ptr[i]) > 0) {
       ext_proc[ne] = i;
@@ -442,28 +399,260 @@ TACSBVecDistribute::TACSBVecDistribute(TACSNodeMap *_rmap,
       ext_count[ne] = full_ext_ptr[i + 1] - full_ext_ptr[i];
       ne++;
     }
-    if ((i != mpi_rank) && (full_req_ptr[i + 1] - full_req_ptr[i]) > 0) {
-      req_proc[nr] = i;
-      req_ptr[nr] = full_req_ptr[i];
-      req_count[nr] = full_req_ptr[i + 1] - full_req_ptr[i];
-      nr++;
-    }
   }
 
-  // Compute the total size of the arrays required
   ext_ptr[ne] = 0;
   if (ne > 0) {
     ext_ptr[ne] = ext_ptr[ne - 1] + ext_count[ne - 1];
   }
 
-  req_ptr[nr] = 0;
-  if (nr > 0) {
-    req_ptr[nr] = req_ptr[nr - 1] + req_count[nr - 1];
+  delete[] full_ext_ptr;
+
+  // Send the external variables to their owners and find the
+  // processors that request variables from this processor. This only
+  // exchanges messages with the neighbors.
+  findRequests();
+
+  // Find the processors on the same node, if any, and the processors
+  // that exchange messages
+  initSharedMemory();
+
+  // Create the distributed graph communicators for the transfers.
+  // The forward transfer receives from the owners of the external
+  // variables and sends to the requesting processors. The reverse
+  // transfer goes in the opposite direction.
+  int *ext_msg_proc = new int[n_ext_msg];
+  for (int i = 0; i < n_ext_msg; i++) {
+    ext_msg_proc[i] = ext_proc[ext_msg[i]];
   }
+  int *req_msg_proc = new int[n_req_msg];
+  for (int i = 0; i < n_req_msg; i++) {
+    req_msg_proc[i] = req_proc[req_msg[i]];
+  }
+  MPI_Dist_graph_create_adjacent(
+      comm, n_ext_msg, ext_msg_proc, MPI_UNWEIGHTED, n_req_msg, req_msg_proc,
+      MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &forward_comm);
+  MPI_Dist_graph_create_adjacent(
+      comm, n_req_msg, req_msg_proc, MPI_UNWEIGHTED, n_ext_msg, ext_msg_proc,
+      MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &reverse_comm);
+  delete[] ext_msg_proc;
+  delete[] req_msg_proc;
+}
 
-  // Free the full data
-  delete[] full_req_ptr;
-  delete[] full_ext_ptr;
+/*
+  Find the processors that exchange values through shared memory and
+  the processors that exchange messages.
+
+  When shared memory windows are used, the processors on the same node
+  are found with MPI_Comm_split_type(). For each of these processors,
+  the offset of the values in the window of the other processor is
+  exchanged once here. Each context then stores its buffers in a
+  shared window (see allocBuffers()), and the values are copied
+  directly from the buffers of the other processors on the node
+  instead of being sent. If no processor on the node has a neighbor
+  on the same node, the node communicator is not kept and all the
+  values are sent as messages.
+*/
+void TACSBVecDistribute::initSharedMemory() {
+  node_comm = MPI_COMM_NULL;
+  ext_node_rank = ext_node_offset = NULL;
+  req_node_rank = req_node_offset = NULL;
+
+#ifdef TACS_USE_SHARED_MEMORY_WINDOWS
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, mpi_rank, MPI_INFO_NULL,
+                      &node_comm);
+
+  // Translate the ranks of the neighbors to ranks on the node
+  MPI_Group group, node_group;
+  MPI_Comm_group(comm, &group);
+  MPI_Comm_group(node_comm, &node_group);
+  ext_node_rank = new int[n_ext_proc];
+  ext_node_offset = new int[n_ext_proc];
+  req_node_rank = new int[n_req_proc];
+  req_node_offset = new int[n_req_proc];
+  MPI_Group_translate_ranks(group, n_ext_proc, ext_proc, node_group,
+                            ext_node_rank);
+  MPI_Group_translate_ranks(group, n_req_proc, req_proc, node_group,
+                            req_node_rank);
+  MPI_Group_free(&group);
+  MPI_Group_free(&node_group);
+
+  int num_node = 0;
+  for (int i = 0; i < n_ext_proc; i++) {
+    if (ext_node_rank[i] == MPI_UNDEFINED) {
+      ext_node_rank[i] = -1;
+    } else {
+      num_node++;
+    }
+  }
+  for (int i = 0; i < n_req_proc; i++) {
+    if (req_node_rank[i] == MPI_UNDEFINED) {
+      req_node_rank[i] = -1;
+    } else {
+      num_node++;
+    }
+  }
+
+  // Shared memory is only used if some processor on the node has a
+  // neighbor on the node, since each transfer synchronizes the node
+  MPI_Allreduce(MPI_IN_PLACE, &num_node, 1, MPI_INT, MPI_SUM, node_comm);
+  if (num_node == 0) {
+    MPI_Comm_free(&node_comm);
+    node_comm = MPI_COMM_NULL;
+    delete[] ext_node_rank;
+    delete[] ext_node_offset;
+    delete[] req_node_rank;
+    delete[] req_node_offset;
+    ext_node_rank = ext_node_offset = NULL;
+    req_node_rank = req_node_offset = NULL;
+  } else {
+    // The window of each processor stores the external values
+    // followed by the requested values. Send the offsets of the
+    // values to the processors on the node that read them.
+    MPI_Request *reqs = new MPI_Request[2 * (n_ext_proc + n_req_proc)];
+    int *offsets = new int[n_ext_proc + n_req_proc];
+    int n = 0;
+    for (int i = 0; i < n_ext_proc; i++) {
+      if (ext_node_rank[i] >= 0) {
+        offsets[i] = ext_ptr[i];
+        MPI_Isend(&offsets[i], 1, MPI_INT, ext_node_rank[i], 0, node_comm,
+                  &reqs[n++]);
+        MPI_Irecv(&ext_node_offset[i], 1, MPI_INT, ext_node_rank[i], 1,
+                  node_comm, &reqs[n++]);
+      }
+    }
+    for (int i = 0; i < n_req_proc; i++) {
+      if (req_node_rank[i] >= 0) {
+        offsets[n_ext_proc + i] = next_vars + req_ptr[i];
+        MPI_Isend(&offsets[n_ext_proc + i], 1, MPI_INT, req_node_rank[i], 1,
+                  node_comm, &reqs[n++]);
+        MPI_Irecv(&req_node_offset[i], 1, MPI_INT, req_node_rank[i], 0,
+                  node_comm, &reqs[n++]);
+      }
+    }
+    MPI_Waitall(n, reqs, MPI_STATUSES_IGNORE);
+    delete[] reqs;
+    delete[] offsets;
+  }
+#endif  // TACS_USE_SHARED_MEMORY_WINDOWS
+
+  // Set the processors that exchange messages
+  ext_msg = new int[n_ext_proc];
+  n_ext_msg = 0;
+  for (int i = 0; i < n_ext_proc; i++) {
+    if (!ext_node_rank || ext_node_rank[i] < 0) {
+      ext_msg[n_ext_msg] = i;
+      n_ext_msg++;
+    }
+  }
+  req_msg = new int[n_req_proc];
+  n_req_msg = 0;
+  for (int i = 0; i < n_req_proc; i++) {
+    if (!req_node_rank || req_node_rank[i] < 0) {
+      req_msg[n_req_msg] = i;
+      n_req_msg++;
+    }
+  }
+}
+
+/*
+  Find the processors that request variables from this processor and
+  the variables that they request.
+
+  This uses the non-blocking consensus algorithm of Hoefler et al. The
+  external variables are sent to their owners with synchronous sends,
+  while the requests from other processors are received as they
+  arrive. Once all the sends on a processor have been matched, it
+  enters a non-blocking barrier. When the barrier completes, all the
+  requests have been received. The cost scales with the number of
+  neighbors, instead of the number of processors as for an all-to-all
+  exchange of the counts.
+*/
+void TACSBVecDistribute::findRequests() {
+  // Use a duplicate communicator so these messages cannot interfere
+  // with any other messages
+  MPI_Comm nbx_comm;
+  MPI_Comm_dup(comm, &nbx_comm);
+
+  MPI_Request *sends = new MPI_Request[n_ext_proc];
+  for (int i = 0; i < n_ext_proc; i++) {
+    MPI_Issend((void *)&ext_vars[ext_ptr[i]], ext_count[i], MPI_INT,
+               ext_proc[i], 0, nbx_comm, &sends[i]);
+  }
+
+  // The source processor, offset and count for each message, and the
+  // requested variables from all the messages
+  int max_msgs = 8, nmsgs = 0;
+  int max_data = 256, ndata = 0;
+  int *msg_info = new int[3 * max_msgs];
+  int *msg_data = new int[max_data];
+
+  MPI_Request barrier = MPI_REQUEST_NULL;
+  int barrier_active = 0, done = 0;
+  while (!done) {
+    int flag;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, 0, nbx_comm, &flag, &status);
+    if (flag) {
+      int count;
+      MPI_Get_count(&status, MPI_INT, &count);
+      if (nmsgs >= max_msgs) {
+        TacsExtendArray(&msg_info, 3 * nmsgs, 6 * max_msgs);
+        max_msgs *= 2;
+      }
+      if (ndata + count > max_data) {
+        int len = 2 * (ndata + count);
+        TacsExtendArray(&msg_data, ndata, len);
+        max_data = len;
+      }
+
+      MPI_Recv(&msg_data[ndata], count, MPI_INT, status.MPI_SOURCE, 0,
+               nbx_comm, MPI_STATUS_IGNORE);
+      msg_info[3 * nmsgs] = status.MPI_SOURCE;
+      msg_info[3 * nmsgs + 1] = ndata;
+      msg_info[3 * nmsgs + 2] = count;
+      ndata += count;
+      nmsgs++;
+    }
+
+    if (barrier_active) {
+      MPI_Test(&barrier, &done, MPI_STATUS_IGNORE);
+    } else {
+      int sent;
+      MPI_Testall(n_ext_proc, sends, &sent, MPI_STATUSES_IGNORE);
+      if (sent) {
+        MPI_Ibarrier(nbx_comm, &barrier);
+        barrier_active = 1;
+      }
+    }
+  }
+
+  delete[] sends;
+  MPI_Comm_free(&nbx_comm);
+
+  // Order the requesting processors by rank
+  qsort(msg_info, nmsgs, 3 * sizeof(int), TacsIntegerComparator);
+
+  // Set the processors to which we are sending data
+  n_req_proc = nmsgs;
+  req_proc = new int[n_req_proc];
+  req_ptr = new int[n_req_proc + 1];
+  req_count = new int[n_req_proc];
+  req_vars = new int[ndata];
+
+  req_ptr[0] = 0;
+  for (int i = 0; i < n_req_proc; i++) {
+    req_proc[i] = msg_info[3 * i];
+    req_count[i] = msg_info[3 * i + 2];
+    req_ptr[i + 1] = req_ptr[i] + req_count[i];
+    memcpy(&req_vars[req_ptr[i]], &msg_data[msg_info[3 * i + 1]],
+           req_count[i] * sizeof(int));
+  }
+
+  delete[] msg_info;
+  delete[] msg_data;
 }
 
 /*
@@ -477,6 +666,14 @@ TACSBVecDistribute::~TACSBVecDistribute() {
   delete[] req_proc;
   delete[] req_count;
   delete[] req_vars;
+  delete[] ext_msg;
+  delete[] req_msg;
+  if (ext_node_rank) {
+    delete[] ext_node_rank;
+    delete[] ext_node_offset;
+    delete[] req_node_rank;
+    delete[] req_node_offset;
+  }
 
   if (!sorted_flag) {
     delete[] ext_sorted;
@@ -485,29 +682,269 @@ TACSBVecDistribute::~TACSBVecDistribute() {
 
   bindex->decref();
   rmap->decref();
+
+  // The communicators cannot be freed after MPI has been finalized
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (!finalized) {
+    MPI_Comm_free(&forward_comm);
+    MPI_Comm_free(&reverse_comm);
+    if (node_comm != MPI_COMM_NULL) {
+      MPI_Comm_free(&node_comm);
+    }
+  }
 }
 
 /*
   Create a context
+
+  The context owns the buffers for the values that are sent and
+  received, and persistent requests for the forward and reverse
+  transfers that are bound to these buffers. When MPI-4 is available,
+  each transfer is a single persistent neighborhood collective on the
+  distributed graph communicator. Otherwise, the transfers use
+  persistent point-to-point requests on the same communicators.
+
+  When the values are exchanged through shared memory, this call is
+  collective on the node, and so is the destruction of the context.
 */
 TACSBVecDistCtx *TACSBVecDistribute::createCtx(int bsize) {
   TACSBVecDistCtx *ctx = new TACSBVecDistCtx(this, bsize);
-  if (!sorted_flag) {
+  allocBuffers(ctx);
+
+  initRequests(ctx, ctx->reqvals, ctx->ext_sorted_vals);
+
+  return ctx;
+}
+
+/*
+  Allocate the host buffers for the external and requested values.
+
+  When the values are exchanged through shared memory, the buffers are
+  allocated in a shared window and the addresses of the values in the
+  windows of the other processors on the node are stored. The window
+  stays locked for the lifetime of the context, and the processors
+  are synchronized with syncSharedBuffers().
+*/
+void TACSBVecDistribute::allocBuffers(TACSBVecDistCtx *ctx) {
+  int bsize = ctx->bsize;
+  int nreq = req_ptr[n_req_proc];
+  if (node_comm == MPI_COMM_NULL) {
     ctx->ext_sorted_vals = new TacsScalar[bsize * next_vars];
+    ctx->reqvals = new TacsScalar[bsize * nreq];
+    return;
   }
-  ctx->reqvals = new TacsScalar[bsize * req_ptr[n_req_proc]];
 
-  // Allocate space for the send/recevies
-  if (n_req_proc > 0) {
-    ctx->sends = new MPI_Request[n_req_proc];
+  // Ask for memory local to each processor
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "alloc_shared_noncontig", "true");
+
+  TacsScalar *base;
+  MPI_Aint size = bsize * (next_vars + nreq) * sizeof(TacsScalar);
+  MPI_Win_allocate_shared(size, sizeof(TacsScalar), info, node_comm, &base,
+                          &ctx->win);
+  MPI_Info_free(&info);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, ctx->win);
+  ctx->ext_sorted_vals = base;
+  ctx->reqvals = &base[bsize * next_vars];
+
+  // Find the addresses of the values in the other windows
+  ctx->ext_node_vals = new const TacsScalar *[n_ext_proc];
+  for (int i = 0; i < n_ext_proc; i++) {
+    ctx->ext_node_vals[i] = NULL;
+    if (ext_node_rank[i] >= 0) {
+      MPI_Aint peer_size;
+      int disp_unit;
+      TacsScalar *peer;
+      MPI_Win_shared_query(ctx->win, ext_node_rank[i], &peer_size, &disp_unit,
+                           &peer);
+      ctx->ext_node_vals[i] = &peer[bsize * ext_node_offset[i]];
+    }
   }
-  if (n_ext_proc > 0) {
-    ctx->recvs = new MPI_Request[n_ext_proc];
+  ctx->req_node_vals = new const TacsScalar *[n_req_proc];
+  for (int i = 0; i < n_req_proc; i++) {
+    ctx->req_node_vals[i] = NULL;
+    if (req_node_rank[i] >= 0) {
+      MPI_Aint peer_size;
+      int disp_unit;
+      TacsScalar *peer;
+      MPI_Win_shared_query(ctx->win, req_node_rank[i], &peer_size, &disp_unit,
+                           &peer);
+      ctx->req_node_vals[i] = &peer[bsize * req_node_offset[i]];
+    }
+  }
+}
+
+/*
+  Synchronize the processors on the node that share the buffers of the
+  context. This is called before the buffers are written, so that the
+  other processors have finished reading the values from the previous
+  transfer, and before the values of the other processors are read, so
+  that they have been written.
+*/
+void TACSBVecDistribute::syncSharedBuffers(TACSBVecDistCtx *ctx) {
+  if (ctx->win != MPI_WIN_NULL) {
+    double t0 = TACSCommProfiler::beginWait();
+    MPI_Win_sync(ctx->win);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(ctx->win);
+    TACSCommProfiler::endWait(TACS_COMM_HALO, t0);
+  }
+}
+
+/*
+  Copy the values from the processors on the same node into the
+  receive buffer, in the place where the values would be received as
+  a message. For the forward transfer, these are the requested values
+  of the owners, and for the reverse transfer, the external values of
+  the requesting processors.
+*/
+void TACSBVecDistribute::copySharedValues(TACSBVecDistCtx *ctx, int forward) {
+  if (ctx->win == MPI_WIN_NULL) {
+    return;
+  }
+
+  syncSharedBuffers(ctx);
+
+  int bsize = ctx->bsize;
+  if (forward) {
+    for (int i = 0; i < n_ext_proc; i++) {
+      if (ctx->ext_node_vals[i]) {
+        memcpy(&ctx->ext_sorted_vals[bsize * ext_ptr[i]], ctx->ext_node_vals[i],
+               bsize * ext_count[i] * sizeof(TacsScalar));
+      }
+    }
+  } else {
+    for (int i = 0; i < n_req_proc; i++) {
+      if (ctx->req_node_vals[i]) {
+        memcpy(&ctx->reqvals[bsize * req_ptr[i]], ctx->req_node_vals[i],
+               bsize * req_count[i] * sizeof(TacsScalar));
+      }
+    }
+  }
+}
+
+/*
+  Set the counts and displacements and create the persistent requests
+  for the forward and reverse transfers between the given buffers
+*/
+void TACSBVecDistribute::initRequests(TACSBVecDistCtx *ctx, TacsScalar *reqvals,
+                                      TacsScalar *ext_vals) {
+  int bsize = ctx->bsize;
+
+  // Set the counts and displacements into the buffers for the
+  // processors that exchange messages
+  ctx->req_counts = new int[n_req_msg + 1];
+  ctx->req_displs = new int[n_req_msg + 1];
+  for (int i = 0; i < n_req_msg; i++) {
+    ctx->req_counts[i] = bsize * req_count[req_msg[i]];
+    ctx->req_displs[i] = bsize * req_ptr[req_msg[i]];
+  }
+  ctx->ext_counts = new int[n_ext_msg + 1];
+  ctx->ext_displs = new int[n_ext_msg + 1];
+  for (int i = 0; i < n_ext_msg; i++) {
+    ctx->ext_counts[i] = bsize * ext_count[ext_msg[i]];
+    ctx->ext_displs[i] = bsize * ext_ptr[ext_msg[i]];
   }
 
+#ifdef TACS_USE_NEIGHBOR_INIT
+  ctx->num_requests = 1;
+  ctx->forward_reqs = new MPI_Request[1];
+  ctx->reverse_reqs = new MPI_Request[1];
+  MPI_Neighbor_alltoallv_init(reqvals, ctx->req_counts, ctx->req_displs,
+                              TACS_MPI_TYPE, ext_vals, ctx->ext_counts,
+                              ctx->ext_displs, TACS_MPI_TYPE, forward_comm,
+                              MPI_INFO_NULL, &ctx->forward_reqs[0]);
+  MPI_Neighbor_alltoallv_init(ext_vals, ctx->ext_counts, ctx->ext_displs,
+                              TACS_MPI_TYPE, reqvals, ctx->req_counts,
+                              ctx->req_displs, TACS_MPI_TYPE, reverse_comm,
+                              MPI_INFO_NULL, &ctx->reverse_reqs[0]);
+#else
+  ctx->num_requests = n_req_msg + n_ext_msg;
+  ctx->forward_reqs = new MPI_Request[ctx->num_requests];
+  ctx->reverse_reqs = new MPI_Request[ctx->num_requests];
+  for (int i = 0; i < n_req_msg; i++) {
+    int proc = req_proc[req_msg[i]];
+    MPI_Send_init(&reqvals[ctx->req_displs[i]], ctx->req_counts[i],
+                  TACS_MPI_TYPE, proc, ctx->ctx_tag, forward_comm,
+                  &ctx->forward_reqs[i]);
+    MPI_Recv_init(&reqvals[ctx->req_displs[i]], ctx->req_counts[i],
+                  TACS_MPI_TYPE, proc, ctx->ctx_tag, reverse_comm,
+                  &ctx->reverse_reqs[i]);
+  }
+  for (int i = 0; i < n_ext_msg; i++) {
+    int k = n_req_msg + i;
+    int proc = ext_proc[ext_msg[i]];
+    MPI_Recv_init(&ext_vals[ctx->ext_displs[i]], ctx->ext_counts[i],
+                  TACS_MPI_TYPE, proc, ctx->ctx_tag, forward_comm,
+                  &ctx->forward_reqs[k]);
+    MPI_Send_init(&ext_vals[ctx->ext_displs[i]], ctx->ext_counts[i],
+                  TACS_MPI_TYPE, proc, ctx->ctx_tag, reverse_comm,
+                  &ctx->reverse_reqs[k]);
+  }
+#endif  // TACS_USE_NEIGHBOR_INIT
+}
+
+/*
+  Create a context for transferring arrays stored on the device.
+
+  The context can only be used with beginForwardDevice() and
+  endForwardDevice(), where the global and local arrays are device
+  arrays (see TACSDevice.h). The values are gathered into the send
+  buffers on the device. When TACS_USE_GPU_AWARE_MPI is defined, the
+  device buffers are passed directly to MPI, otherwise they are
+  copied to and from host buffers around the transfer.
+*/
+TACSBVecDistCtx *TACSBVecDistribute::createDeviceCtx(int bsize) {
+  TACSBVecDistCtx *ctx = new TACSBVecDistCtx(this, bsize);
+  ctx->is_device = 1;
+
+  // Copy the indices needed to gather the values on the device
+  int nreq = req_ptr[n_req_proc];
+  ctx->dev_req_vars = (int *)TacsDeviceMalloc(nreq * sizeof(int));
+  TacsDeviceCopyToDevice(ctx->dev_req_vars, req_vars, nreq * sizeof(int));
+  ctx->dev_self_vars = (int *)TacsDeviceMalloc(ext_self_count * sizeof(int));
+  TacsDeviceCopyToDevice(ctx->dev_self_vars, &ext_vars[ext_self_ptr],
+                         ext_self_count * sizeof(int));
+  if (!sorted_flag) {
+    ctx->dev_unsorted_index =
+        (int *)TacsDeviceMalloc(nvars_unsorted * sizeof(int));
+    TacsDeviceCopyToDevice(ctx->dev_unsorted_index, ext_unsorted_index,
+                           nvars_unsorted * sizeof(int));
+  }
+
+  // Allocate the buffers on the device
+  ctx->dev_reqvals =
+      (TacsScalar *)TacsDeviceMalloc(bsize * nreq * sizeof(TacsScalar));
+  ctx->dev_ext_sorted_vals =
+      (TacsScalar *)TacsDeviceMalloc(bsize * next_vars * sizeof(TacsScalar));
+
+#ifdef TACS_USE_GPU_AWARE_MPI
+  initRequests(ctx, ctx->dev_reqvals, ctx->dev_ext_sorted_vals);
+#else
+  allocBuffers(ctx);
+  initRequests(ctx, ctx->reqvals, ctx->ext_sorted_vals);
+#endif  // TACS_USE_GPU_AWARE_MPI
+
   return ctx;
 }
 
+/*
+  Copy the values received from the other processors between the
+  sorted buffer and the sorted local array. This skips the values
+  owned by this processor, which are copied directly.
+*/
+void TACSBVecDistribute::copyExtValues(int bsize, const TacsScalar *src,
+                                       TacsScalar *dest) {
+  int end = bsize * ext_self_ptr;
+  memcpy(dest, src, end * sizeof(TacsScalar));
+
+  int start = bsize * (ext_self_ptr + ext_self_count);
+  end = bsize * next_vars;
+  memcpy(&dest[start], &src[start], (end - start) * sizeof(TacsScalar));
+}
+
 /*
   Get the number of indices
 */
@@ -543,17 +980,18 @@ TACSBVecIndices *TACSBVecDistribute::getIndices() { return bindex; }
 void TACSBVecDistribute::beginForward(TACSBVecDistCtx *ctx, TacsScalar *global,
                                       TacsScalar *local,
                                       const int node_offset) {
-  if (this != ctx->me) {
+  TACSProfileScope scope("TACSBVecDistribute::beginForward");
+  if (this != ctx->me || ctx->is_device) {
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
   }
+  scope.addWork(0.0, 1.0 * ctx->bsize * req_ptr[n_req_proc] *
+                         sizeof(TacsScalar));
 
   // Set pointers to the context data
   int bsize = ctx->bsize;
   TacsScalar *reqvals = ctx->reqvals;
   TacsScalar *ext_sorted_vals = ctx->ext_sorted_vals;
-  MPI_Request *sends = ctx->sends;
-  MPI_Request *recvs = ctx->recvs;
 
   // Get the rank/size
   int mpi_rank;
@@ -567,51 +1005,24 @@ void TACSBVecDistribute::beginForward(TACSBVecDistCtx *ctx, TacsScalar *global,
   rmap->getOwnerRange(&owner_range);
 
   // Set the lower offset
-  int lower = bsize * (owner_range[mpi_rank] + node_offset);
+  int lower = owner_range[mpi_rank] + node_offset;
 
-  // Copy the global values to their requesters
+  // Copy the global values to their requesters and start the transfer
+  syncSharedBuffers(ctx);
   bgetvars(bsize, req_ptr[n_req_proc], req_vars, lower, global, reqvals,
            TACS_INSERT_VALUES);
+  MPI_Startall(ctx->num_requests, ctx->forward_reqs);
+  ctx->forward_active = 1;
+  addCommStats(bsize, 1);
 
-  for (int i = 0; i < n_req_proc; i++) {
-    // Initiate the sends and receives
-    int dest = req_proc[i];
-    int start = bsize * req_ptr[i];
-    int size = bsize * req_count[i];
-    MPI_Isend(&reqvals[start], size, TACS_MPI_TYPE, dest, ctx->ctx_tag, comm,
-              &sends[i]);
-  }
-
+  // Copy over the local values. If the local array is sorted, they
+  // can be placed directly into the local array.
   if (sorted_flag) {
-    // Copy over the local values
     bgetvars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower, global,
              &local[bsize * ext_self_ptr], TACS_INSERT_VALUES);
-
-    // If the receiving array is sorted, it can be placed directly
-    // into local array
-    for (int i = 0; i < n_ext_proc; i++) {
-      int dest = ext_proc[i];
-      int start = bsize * ext_ptr[i];
-      int size = bsize * ext_count[i];
-
-      MPI_Irecv(&local[start], size, TACS_MPI_TYPE, dest, ctx->ctx_tag, comm,
-                &recvs[i]);
-    }
   } else {
-    // Copy the local values first
     bgetvars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower, global,
              &ext_sorted_vals[bsize * ext_self_ptr], TACS_INSERT_VALUES);
-
-    // If the receiving array is not sorted, the data must
-    // first be placed in a receiving array
-    for (int i = 0; i < n_ext_proc; i++) {
-      int dest = ext_proc[i];
-      int start = bsize * ext_ptr[i];
-      int size = bsize * ext_count[i];
-
-      MPI_Irecv(&ext_sorted_vals[start], size, TACS_MPI_TYPE, dest,
-                ctx->ctx_tag, comm, &recvs[i]);
-    }
   }
 }
 
@@ -620,16 +1031,22 @@ void TACSBVecDistribute::beginForward(TACSBVecDistCtx *ctx, TacsScalar *global,
 */
 void TACSBVecDistribute::endForward(TACSBVecDistCtx *ctx, TacsScalar *global,
                                     TacsScalar *local, const int node_offset) {
+  TACSProfileScope scope("TACSBVecDistribute::endForward");
   if (this != ctx->me) {
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
   }
 
-  // Finalize the sends and receives
-  MPI_Waitall(n_req_proc, ctx->sends, MPI_STATUSES_IGNORE);
-  MPI_Waitall(n_ext_proc, ctx->recvs, MPI_STATUSES_IGNORE);
+  // Finalize the transfer
+  double t0 = TACSCommProfiler::beginWait();
+  MPI_Waitall(ctx->num_requests, ctx->forward_reqs, MPI_STATUSES_IGNORE);
+  TACSCommProfiler::endWait(TACS_COMM_HALO, t0);
+  ctx->forward_active = 0;
+  copySharedValues(ctx, 1);
 
-  if (!sorted_flag) {
+  if (sorted_flag) {
+    copyExtValues(ctx->bsize, ctx->ext_sorted_vals, local);
+  } else {
     // Initialize the implementation
     initImpl(ctx->bsize);
 
@@ -639,6 +1056,206 @@ void TACSBVecDistribute::endForward(TACSBVecDistCtx *ctx, TacsScalar *global,
   }
 }
 
+/*
+  Copy the values received from the other processors to the sorted
+  local array on the device. The source is a host array when
+  from_host is true, and a device array otherwise.
+*/
+void TACSBVecDistribute::copyExtValuesDevice(int bsize, const TacsScalar *src,
+                                             TacsScalar *dest, int from_host) {
+  int ranges[4];
+  ranges[0] = 0;
+  ranges[1] = bsize * ext_self_ptr;
+  ranges[2] = bsize * (ext_self_ptr + ext_self_count);
+  ranges[3] = bsize * next_vars;
+
+  for (int k = 0; k < 4; k += 2) {
+    size_t bytes = (ranges[k + 1] - ranges[k]) * sizeof(TacsScalar);
+    if (bytes > 0) {
+      if (from_host) {
+        TacsDeviceCopyToDevice(&dest[ranges[k]], &src[ranges[k]], bytes);
+      } else {
+        TacsDeviceCopy(&dest[ranges[k]], &src[ranges[k]], bytes);
+      }
+    }
+  }
+}
+
+/*
+  Begin the forward transfer of the device array global to the device
+  array local. The context must be created with createDeviceCtx().
+
+  The requested values are gathered on the device. Both arrays may be
+  used by other device operations after this call, since the device
+  operations are ordered, but local is not complete until
+  endForwardDevice() is called.
+*/
+void TACSBVecDistribute::beginForwardDevice(TACSBVecDistCtx *ctx,
+                                            TacsScalar *global,
+                                            TacsScalar *local) {
+  if (this != ctx->me || !ctx->is_device) {
+    fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
+    return;
+  }
+
+  int bsize = ctx->bsize;
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  const int *owner_range;
+  rmap->getOwnerRange(&owner_range);
+  int lower = owner_range[mpi_rank];
+
+  // Gather the requested values into the send buffer
+  int nreq = req_ptr[n_req_proc];
+  TacsDeviceGatherVars(bsize, nreq, ctx->dev_req_vars, lower, global,
+                       ctx->dev_reqvals);
+#ifdef TACS_USE_GPU_AWARE_MPI
+  // MPI reads the buffer directly, so the gather must be complete
+  TacsDeviceSynchronize();
+#else
+  syncSharedBuffers(ctx);
+  TacsDeviceCopyToHost(ctx->reqvals, ctx->dev_reqvals,
+                       bsize * nreq * sizeof(TacsScalar));
+#endif  // TACS_USE_GPU_AWARE_MPI
+
+  MPI_Startall(ctx->num_requests, ctx->forward_reqs);
+  ctx->forward_active = 1;
+  addCommStats(bsize, 1);
+
+  // Copy over the values owned by this processor
+  if (sorted_flag) {
+    TacsDeviceGatherVars(bsize, ext_self_count, ctx->dev_self_vars, lower,
+                         global, &local[bsize * ext_self_ptr]);
+  } else {
+    TacsDeviceGatherVars(bsize, ext_self_count, ctx->dev_self_vars, lower,
+                         global, &ctx->dev_ext_sorted_vals[bsize * ext_self_ptr]);
+  }
+}
+
+/*
+  Finish the forward transfer of the device array global to the
+  device array local
+*/
+void TACSBVecDistribute::endForwardDevice(TACSBVecDistCtx *ctx,
+                                          TacsScalar *global,
+                                          TacsScalar *local) {
+  if (this != ctx->me || !ctx->is_device) {
+    fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
+    return;
+  }
+
+  double t0 = TACSCommProfiler::beginWait();
+  MPI_Waitall(ctx->num_requests, ctx->forward_reqs, MPI_STATUSES_IGNORE);
+  TACSCommProfiler::endWait(TACS_COMM_HALO, t0);
+  ctx->forward_active = 0;
+  copySharedValues(ctx, 1);
+
+  int bsize = ctx->bsize;
+#ifdef TACS_USE_GPU_AWARE_MPI
+  const TacsScalar *ext_vals = ctx->dev_ext_sorted_vals;
+  int from_host = 0;
+#else
+  const TacsScalar *ext_vals = ctx->ext_sorted_vals;
+  int from_host = 1;
+#endif  // TACS_USE_GPU_AWARE_MPI
+
+  if (sorted_flag) {
+    copyExtValuesDevice(bsize, ext_vals, local, from_host);
+  } else {
+    if (from_host) {
+      copyExtValuesDevice(bsize, ext_vals, ctx->dev_ext_sorted_vals, 1);
+    }
+    TacsDeviceGatherVars(bsize, nvars_unsorted, ctx->dev_unsorted_index, 0,
+                         ctx->dev_ext_sorted_vals, local);
+  }
+}
+
+/*
+  Get the number of processors that this processor sends values to or
+  receives values from through messages. The processors on the same
+  node that exchange values through shared memory are not counted.
+*/
+int TACSBVecDistribute::getNumMessageProcs() { return n_ext_msg + n_req_msg; }
+
+/*
+  Get the number of processors whose values can be completed
+  separately with endForwardAny().
+
+  This is zero if the forward transfer can only be completed for all
+  processors at once. This is the case when the indices are not
+  sorted, when the transfer is a single neighborhood collective, or
+  when values are copied from other processors through shared memory.
+*/
+int TACSBVecDistribute::getNumExtProcs() {
+#ifdef TACS_USE_NEIGHBOR_INIT
+  return 0;
+#else
+  return (sorted_flag && node_comm == MPI_COMM_NULL ? n_ext_proc : 0);
+#endif  // TACS_USE_NEIGHBOR_INIT
+}
+
+/*
+  Get the range of nodes [start, end) in the local array that are
+  received from the given processor index
+*/
+void TACSBVecDistribute::getExtProcRange(int index, int *start, int *end) {
+  *start = *end = 0;
+  if (index >= 0 && index < n_ext_proc) {
+    *start = ext_ptr[index];
+    *end = ext_ptr[index] + ext_count[index];
+  }
+}
+
+/*
+  Complete part of the forward transfer started with beginForward().
+
+  This waits until the values from any of the processors have arrived
+  and copies them to the local array. The index of the processor is
+  returned in index (see getExtProcRange()). When all the values
+  arrive at once, index is set to -1. This function returns 1 when
+  new values are available, and 0 when the transfer is complete. It
+  must be called until it returns 0, instead of calling endForward().
+*/
+int TACSBVecDistribute::endForwardAny(TACSBVecDistCtx *ctx,
+                                      TacsScalar *global, TacsScalar *local,
+                                      int *index) {
+  *index = -1;
+  if (this != ctx->me) {
+    fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
+    return 0;
+  }
+  if (!ctx->forward_active) {
+    return 0;
+  }
+
+  if (getNumExtProcs() > 0) {
+    // The receives follow the sends in the array of requests
+    int i;
+    double t0 = TACSCommProfiler::beginWait();
+    MPI_Waitany(n_ext_msg, &ctx->forward_reqs[n_req_msg], &i,
+                MPI_STATUS_IGNORE);
+    TACSCommProfiler::endWait(TACS_COMM_HALO, t0);
+    if (i != MPI_UNDEFINED) {
+      i = ext_msg[i];
+      int bsize = ctx->bsize;
+      int start = bsize * ext_ptr[i];
+      memcpy(&local[start], &ctx->ext_sorted_vals[start],
+             bsize * ext_count[i] * sizeof(TacsScalar));
+      *index = i;
+      return 1;
+    }
+
+    t0 = TACSCommProfiler::beginWait();
+    MPI_Waitall(n_req_msg, ctx->forward_reqs, MPI_STATUSES_IGNORE);
+    TACSCommProfiler::endWait(TACS_COMM_HALO, t0);
+    ctx->forward_active = 0;
+    return 0;
+  }
+
+  endForward(ctx, global, local);
+  return 1;
+}
+
 /*!
   Initiate the distribution of values from vec to the local array.
 
@@ -651,17 +1268,17 @@ void TACSBVecDistribute::endForward(TACSBVecDistCtx *ctx, TacsScalar *global,
 void TACSBVecDistribute::beginReverse(TACSBVecDistCtx *ctx, TacsScalar *local,
                                       TacsScalar *global,
                                       TACSBVecOperation op) {
-  if (this != ctx->me) {
+  TACSProfileScope scope("TACSBVecDistribute::beginReverse");
+  if (this != ctx->me || ctx->is_device) {
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
   }
+  scope.addWork(0.0, 1.0 * ctx->bsize * (next_vars - ext_self_count) *
+                         sizeof(TacsScalar));
 
   // Set pointers to the context data
   int bsize = ctx->bsize;
-  TacsScalar *reqvals = ctx->reqvals;
   TacsScalar *ext_sorted_vals = ctx->ext_sorted_vals;
-  MPI_Request *sends = ctx->sends;
-  MPI_Request *recvs = ctx->recvs;
 
   // Get the rank/size
   int mpi_rank;
@@ -673,41 +1290,26 @@ void TACSBVecDistribute::beginReverse(TACSBVecDistCtx *ctx, TacsScalar *local,
   // Get the ownership range
   const int *owner_range;
   rmap->getOwnerRange(&owner_range);
-  int lower = bsize * owner_range[mpi_rank];
+  int lower = owner_range[mpi_rank];
 
-  // If the index array is not sorted, then allocate an array that is
-  // large enough to store the sorted external values
-  if (!sorted_flag) {
-    // Copy over the values from the sorted to the unsorted array
+  // Copy the values into the sorted array that is bound to the
+  // persistent requests and start the transfer
+  syncSharedBuffers(ctx);
+  if (sorted_flag) {
+    copyExtValues(bsize, local, ext_sorted_vals);
+  } else {
     int len = bsize * next_vars;
     memset(ext_sorted_vals, 0, len * sizeof(TacsScalar));
     bsetvars(bsize, nvars_unsorted, ext_unsorted_index, 0, local,
              ext_sorted_vals, op);
     local = ext_sorted_vals;
   }
+  MPI_Startall(ctx->num_requests, ctx->reverse_reqs);
+  addCommStats(bsize, 0);
 
   // Do the sends on myself
   bsetvars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower,
            &local[bsize * ext_self_ptr], global, op);
-
-  // Note that the receives/send MPI_Requests have been reversed --
-  // this is because they are allocated for the forward operation -
-  // the sizes must be reversed for the reverse operation done here
-  for (int i = 0; i < n_ext_proc; i++) {
-    int dest = ext_proc[i];
-    int start = bsize * ext_ptr[i];
-    int size = bsize * ext_count[i];
-    MPI_Isend(&local[start], size, TACS_MPI_TYPE, dest, ctx->ctx_tag, comm,
-              &recvs[i]);
-  }
-
-  for (int i = 0; i < n_req_proc; i++) {
-    int dest = req_proc[i];
-    int start = bsize * req_ptr[i];
-    int size = bsize * req_count[i];
-    MPI_Irecv(&reqvals[start], size, TACS_MPI_TYPE, dest, ctx->ctx_tag, comm,
-              &sends[i]);
-  }
 }
 
 /*
@@ -716,6 +1318,7 @@ void TACSBVecDistribute::beginReverse(TACSBVecDistCtx *ctx, TacsScalar *local,
 */
 void TACSBVecDistribute::endReverse(TACSBVecDistCtx *ctx, TacsScalar *local,
                                     TacsScalar *global, TACSBVecOperation op) {
+  TACSProfileScope scope("TACSBVecDistribute::endReverse");
   if (this != ctx->me) {
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
@@ -732,16 +1335,49 @@ void TACSBVecDistribute::endReverse(TACSBVecDistCtx *ctx, TacsScalar *local,
   rmap->getOwnerRange(&owner_range);
 
   // Set the lower offset
-  int lower = ctx->bsize * owner_range[mpi_rank];
+  int lower = owner_range[mpi_rank];
 
-  // Finalize the sends and receives
-  MPI_Waitall(n_req_proc, ctx->sends, MPI_STATUSES_IGNORE);
-  MPI_Waitall(n_ext_proc, ctx->recvs, MPI_STATUSES_IGNORE);
+  // Finalize the transfer
+  double t0 = TACSCommProfiler::beginWait();
+  MPI_Waitall(ctx->num_requests, ctx->reverse_reqs, MPI_STATUSES_IGNORE);
+  TACSCommProfiler::endWait(TACS_COMM_HALO, t0);
+  copySharedValues(ctx, 0);
 
   bsetvars(ctx->bsize, req_ptr[n_req_proc], req_vars, lower, ctx->reqvals,
            global, op);
 }
 
+/*
+  Record the messages for a transfer with the communication profiler.
+  The forward transfer sends the requested values to the processors
+  in req_proc and receives the external values from ext_proc, and the
+  reverse transfer does the opposite. Values copied through shared
+  memory are not messages and are not recorded.
+*/
+void TACSBVecDistribute::addCommStats(int bsize, int forward) {
+  if (!TACSCommProfiler::isEnabled()) {
+    return;
+  }
+  for (int k = 0; k < n_req_msg; k++) {
+    int i = req_msg[k];
+    size_t bytes = bsize * req_count[i] * sizeof(TacsScalar);
+    if (forward) {
+      TACSCommProfiler::addSend(TACS_COMM_HALO, req_proc[i], bytes);
+    } else {
+      TACSCommProfiler::addRecv(TACS_COMM_HALO, req_proc[i], bytes);
+    }
+  }
+  for (int k = 0; k < n_ext_msg; k++) {
+    int i = ext_msg[k];
+    size_t bytes = bsize * ext_count[i] * sizeof(TacsScalar);
+    if (forward) {
+      TACSCommProfiler::addRecv(TACS_COMM_HALO, ext_proc[i], bytes);
+    } else {
+      TACSCommProfiler::addSend(TACS_COMM_HALO, ext_proc[i], bytes);
+    }
+  }
+}
+
 const char *TACSBVecDistribute::getObjectName() { return name; }
 
 const char *TACSBVecDistribute::name = "TACSBVecDistribute";
@@ -788,13 +1424,18 @@ void TACSBVecDistribute::initImpl(int bsize) {
   Copy variables distributed arbitrarily in one array to
   a second array where they are ordered sequentially.
 
-  y[i] op x[var[i]]
+  y[i] op x[var[i] - lower]
+
+  The offset lower is the first node owned by this processor. It is
+  subtracted before scaling by the block size, so that only the local
+  entry offset is formed, which stays within the range of int even
+  when the global number of unknowns does not.
 */
 void VecDistGetVars(int bsize, int nvars, const int *vars, int lower,
                     TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = bsize * vars[i] - lower;
+      int v = bsize * (vars[i] - lower);
       for (int k = 0; k < bsize; k++) {
         y[k] = x[v + k];
       }
@@ -802,7 +1443,7 @@ void VecDistGetVars(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {  // Add
     for (int i = 0; i < nvars; i++) {
-      int v = bsize * vars[i] - lower;
+      int v = bsize * (vars[i] - lower);
       for (int k = 0; k < bsize; k++) {
         y[k] += x[v + k];
       }
@@ -810,7 +1451,7 @@ void VecDistGetVars(int bsize, int nvars, const int *vars, int lower,
     }
   } else {  // Insert the non-zero values
     for (int i = 0; i < nvars; i++) {
-      int v = bsize * vars[i] - lower;
+      int v = bsize * (vars[i] - lower);
       for (int k = 0; k < bsize; k++) {
         if (TacsRealPart(x[v + k]) != 0.0) {
           y[k] = x[v + k];
@@ -825,13 +1466,13 @@ void VecDistGetVars(int bsize, int nvars, const int *vars, int lower,
   Copy variables from an ordered array to an array where
   they are distributed arbitrarily
 
-  y[var[i]] op x[i]
+  y[var[i] - lower] op x[i]
 */
 void VecDistSetVars(int bsize, int nvars, const int *vars, int lower,
                     TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = bsize * vars[i] - lower;
+      int v = bsize * (vars[i] - lower);
       for (int k = 0; k < bsize; k++) {
         y[v + k] = x[k];
       }
@@ -839,7 +1480,7 @@ void VecDistSetVars(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {  // Add
     for (int i = 0; i < nvars; i++) {
-      int v = bsize * vars[i] - lower;
+      int v = bsize * (vars[i] - lower);
       for (int k = 0; k < bsize; k++) {
         y[v + k] += x[k];
       }
@@ -847,7 +1488,7 @@ void VecDistSetVars(int bsize, int nvars, const int *vars, int lower,
     }
   } else {  // Insert the non-zero values
     for (int i = 0; i < nvars; i++) {
-      int v = bsize * vars[i] - lower;
+      int v = bsize * (vars[i] - lower);
       for (int k = 0; k < bsize; k++) {
         if (TacsRealPart(x[k]) != 0.0) {
           y[v + k] = x[k];
@@ -918,21 +1559,21 @@ void VecDistGetVars2(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 2 * vars[i] - lower;
+      int v = 2 * (vars[i] - lower);
       y[0] = x[v];
       y[1] = x[v + 1];
       y += 2;
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 2 * vars[i] - lower;
+      int v = 2 * (vars[i] - lower);
       y[0] += x[v];
       y[1] += x[v + 1];
       y += 2;
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 2 * vars[i] - lower;
+      int v = 2 * (vars[i] - lower);
       if (TacsRealPart(x[v]) != 0.0) {
         y[0] = x[v];
       }
@@ -948,21 +1589,21 @@ void VecDistSetVars2(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 2 * vars[i] - lower;
+      int v = 2 * (vars[i] - lower);
       y[v] = x[0];
       y[v + 1] = x[1];
       x += 2;
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 2 * vars[i] - lower;
+      int v = 2 * (vars[i] - lower);
       y[v] += x[0];
       y[v + 1] += x[1];
       x += 2;
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 2 * vars[i] - lower;
+      int v = 2 * (vars[i] - lower);
       if (TacsRealPart(x[0]) != 0.0) {
         y[v] = x[0];
       }
@@ -981,7 +1622,7 @@ void VecDistGetVars3(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 3 * vars[i] - lower;
+      int v = 3 * (vars[i] - lower);
       y[0] = x[v];
       y[1] = x[v + 1];
       y[2] = x[v + 2];
@@ -989,7 +1630,7 @@ void VecDistGetVars3(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 3 * vars[i] - lower;
+      int v = 3 * (vars[i] - lower);
       y[0] += x[v];
       y[1] += x[v + 1];
       y[2] += x[v + 2];
@@ -997,7 +1638,7 @@ void VecDistGetVars3(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 3 * vars[i] - lower;
+      int v = 3 * (vars[i] - lower);
       if (TacsRealPart(x[v]) != 0.0) {
         y[0] = x[v];
       }
@@ -1016,7 +1657,7 @@ void VecDistSetVars3(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 3 * vars[i] - lower;
+      int v = 3 * (vars[i] - lower);
       y[v] = x[0];
       y[v + 1] = x[1];
       y[v + 2] = x[2];
@@ -1024,7 +1665,7 @@ void VecDistSetVars3(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 3 * vars[i] - lower;
+      int v = 3 * (vars[i] - lower);
       y[v] += x[0];
       y[v + 1] += x[1];
       y[v + 2] += x[2];
@@ -1032,7 +1673,7 @@ void VecDistSetVars3(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 3 * vars[i] - lower;
+      int v = 3 * (vars[i] - lower);
       if (TacsRealPart(x[0]) != 0.0) {
         y[v] = x[0];
       }
@@ -1053,7 +1694,7 @@ void VecDistGetVars4(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 4 * vars[i] - lower;
+      int v = 4 * (vars[i] - lower);
       y[0] = x[v];
       y[1] = x[v + 1];
       y[2] = x[v + 2];
@@ -1062,7 +1703,7 @@ void VecDistGetVars4(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 4 * vars[i] - lower;
+      int v = 4 * (vars[i] - lower);
       y[0] += x[v];
       y[1] += x[v + 1];
       y[2] += x[v + 2];
@@ -1071,7 +1712,7 @@ void VecDistGetVars4(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 4 * vars[i] - lower;
+      int v = 4 * (vars[i] - lower);
       if (TacsRealPart(x[v]) != 0.0) {
         y[0] = x[v];
       }
@@ -1093,7 +1734,7 @@ void VecDistSetVars4(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 4 * vars[i] - lower;
+      int v = 4 * (vars[i] - lower);
       y[v] = x[0];
       y[v + 1] = x[1];
       y[v + 2] = x[2];
@@ -1102,7 +1743,7 @@ void VecDistSetVars4(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 4 * vars[i] - lower;
+      int v = 4 * (vars[i] - lower);
       y[v] += x[0];
       y[v + 1] += x[1];
       y[v + 2] += x[2];
@@ -1111,7 +1752,7 @@ void VecDistSetVars4(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 4 * vars[i] - lower;
+      int v = 4 * (vars[i] - lower);
       if (TacsRealPart(x[0]) != 0.0) {
         y[v] = x[0];
       }
@@ -1136,7 +1777,7 @@ void VecDistGetVars5(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 5 * vars[i] - lower;
+      int v = 5 * (vars[i] - lower);
       y[0] = x[v];
       y[1] = x[v + 1];
       y[2] = x[v + 2];
@@ -1146,7 +1787,7 @@ void VecDistGetVars5(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 5 * vars[i] - lower;
+      int v = 5 * (vars[i] - lower);
       y[0] += x[v];
       y[1] += x[v + 1];
       y[2] += x[v + 2];
@@ -1156,7 +1797,7 @@ void VecDistGetVars5(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 5 * vars[i] - lower;
+      int v = 5 * (vars[i] - lower);
       if (TacsRealPart(x[v]) != 0.0) {
         y[0] = x[v];
       }
@@ -1181,7 +1822,7 @@ void VecDistSetVars5(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 5 * vars[i] - lower;
+      int v = 5 * (vars[i] - lower);
       y[v] = x[0];
       y[v + 1] = x[1];
       y[v + 2] = x[2];
@@ -1191,7 +1832,7 @@ void VecDistSetVars5(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 5 * vars[i] - lower;
+      int v = 5 * (vars[i] - lower);
       y[v] += x[0];
       y[v + 1] += x[1];
       y[v + 2] += x[2];
@@ -1201,7 +1842,7 @@ void VecDistSetVars5(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 5 * vars[i] - lower;
+      int v = 5 * (vars[i] - lower);
       if (TacsRealPart(x[0]) != 0.0) {
         y[v] = x[0];
       }
@@ -1229,7 +1870,7 @@ void VecDistGetVars6(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 6 * vars[i] - lower;
+      int v = 6 * (vars[i] - lower);
       y[0] = x[v];
       y[1] = x[v + 1];
       y[2] = x[v + 2];
@@ -1240,7 +1881,7 @@ void VecDistGetVars6(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 6 * vars[i] - lower;
+      int v = 6 * (vars[i] - lower);
       y[0] += x[v];
       y[1] += x[v + 1];
       y[2] += x[v + 2];
@@ -1251,7 +1892,7 @@ void VecDistGetVars6(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 6 * vars[i] - lower;
+      int v = 6 * (vars[i] - lower);
       if (TacsRealPart(x[v]) != 0.0) {
         y[0] = x[v];
       }
@@ -1279,7 +1920,7 @@ void VecDistSetVars6(int bsize, int nvars, const int *vars, int lower,
                      TacsScalar *x, TacsScalar *y, TACSBVecOperation op) {
   if (op == TACS_INSERT_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 6 * vars[i] - lower;
+      int v = 6 * (vars[i] - lower);
       y[v] = x[0];
       y[v + 1] = x[1];
       y[v + 2] = x[2];
@@ -1290,7 +1931,7 @@ void VecDistSetVars6(int bsize, int nvars, const int *vars, int lower,
     }
   } else if (op == TACS_ADD_VALUES) {
     for (int i = 0; i < nvars; i++) {
-      int v = 6 * vars[i] - lower;
+      int v = 6 * (vars[i] - lower);
       y[v] += x[0];
       y[v + 1] += x[1];
       y[v + 2] += x[2];
@@ -1301,7 +1942,7 @@ void VecDistSetVars6(int bsize, int nvars, const int *vars, int lower,
     }
   } else {
     for (int i = 0; i < nvars; i++) {
-      int v = 6 * vars[i] - lower;
+      int v = 6 * (vars[i] - lower);
       if (TacsRealPart(x[0]) != 0.0) {
         y[v] = x[0];
       }
@@ -1326,17 +1967,51 @@ void VecDistSetVars6(int bsize, int nvars, const int *vars, int lower,
 }
 
 TACSBVecDistCtx::~TACSBVecDistCtx() {
-  if (ext_sorted_vals) {
-    delete[] ext_sorted_vals;
+  // The requests cannot be freed after MPI has been finalized
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (!finalized) {
+    for (int i = 0; i < num_requests; i++) {
+      MPI_Request_free(&forward_reqs[i]);
+      MPI_Request_free(&reverse_reqs[i]);
+    }
+  }
+  if (forward_reqs) {
+    delete[] forward_reqs;
+  }
+  if (reverse_reqs) {
+    delete[] reverse_reqs;
+  }
+  if (win != MPI_WIN_NULL) {
+    // The buffers are owned by the shared window
+    if (!finalized) {
+      MPI_Win_unlock_all(win);
+      MPI_Win_free(&win);
+    }
+    delete[] ext_node_vals;
+    delete[] req_node_vals;
+  } else {
+    if (ext_sorted_vals) {
+      delete[] ext_sorted_vals;
+    }
+    if (reqvals) {
+      delete[] reqvals;
+    }
   }
-  if (reqvals) {
-    delete[] reqvals;
+  if (is_device) {
+    TacsDeviceFree(dev_req_vars);
+    TacsDeviceFree(dev_self_vars);
+    TacsDeviceFree(dev_unsorted_index);
+    TacsDeviceFree(dev_reqvals);
+    TacsDeviceFree(dev_ext_sorted_vals);
   }
-  if (sends) {
-    delete[] sends;
+  if (req_counts) {
+    delete[] req_counts;
+    delete[] req_displs;
   }
-  if (recvs) {
-    delete[] recvs;
+  if (ext_counts) {
+    delete[] ext_counts;
+    delete[] ext_displs;
   }
 }
 
@@ -1345,8 +2020,17 @@ TACSBVecDistCtx::TACSBVecDistCtx(TACSBVecDistribute *_me, int _bsize) {
   me = _me;
   ext_sorted_vals = NULL;
   reqvals = NULL;
-  sends = NULL;
-  recvs = NULL;
+  win = MPI_WIN_NULL;
+  ext_node_vals = req_node_vals = NULL;
+  req_counts = req_displs = NULL;
+  ext_counts = ext_displs = NULL;
+  forward_active = 0;
+  is_device = 0;
+  dev_req_vars = dev_self_vars = dev_unsorted_index = NULL;
+  dev_reqvals = dev_ext_sorted_vals = NULL;
+  num_requests = 0;
+  forward_reqs = NULL;
+  reverse_reqs = NULL;
 
   // Set the tag values
   ctx_tag = tag_value;
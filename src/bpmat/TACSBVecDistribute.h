@@ -25,6 +25,23 @@
 
 #include "TACSNodeMap.h"
 
+/*
+  Use the persistent neighborhood collectives when they are available
+*/
+#if MPI_VERSION >= 4
+#define TACS_USE_NEIGHBOR_INIT
+#endif
+
+/*
+  When TACS_USE_SHARED_MEMORY_HALO is defined, the values exchanged
+  between processors on the same node are copied through MPI-3 shared
+  memory windows instead of being sent as messages. This is not used
+  with TACS_USE_GPU_AWARE_MPI, where the buffers are device arrays.
+*/
+#if defined(TACS_USE_SHARED_MEMORY_HALO) && !defined(TACS_USE_GPU_AWARE_MPI)
+#define TACS_USE_SHARED_MEMORY_WINDOWS
+#endif
+
 enum TACSBVecOperation {
   TACS_INSERT_VALUES,
   TACS_ADD_VALUES,
@@ -115,6 +132,25 @@ class TACSBVecDistribute : public TACSObject {
   void endForward(TACSBVecDistCtx *ctx, TacsScalar *global, TacsScalar *local,
                   const int node_offset = 0);
 
+  // Complete the forward transfer one processor at a time
+  // -----------------------------------------------------
+  int getNumExtProcs();
+  void getExtProcRange(int index, int *start, int *end);
+  int endForwardAny(TACSBVecDistCtx *ctx, TacsScalar *global,
+                    TacsScalar *local, int *index);
+
+  // Get the number of processors that exchange values through messages
+  // ------------------------------------------------------------------
+  int getNumMessageProcs();
+
+  // Transfer device arrays with a context from createDeviceCtx()
+  // ------------------------------------------------------------
+  TACSBVecDistCtx *createDeviceCtx(int bsize);
+  void beginForwardDevice(TACSBVecDistCtx *ctx, TacsScalar *global,
+                          TacsScalar *local);
+  void endForwardDevice(TACSBVecDistCtx *ctx, TacsScalar *global,
+                        TacsScalar *local);
+
   // Add or insert data back into the vector
   // ---------------------------------------
   void beginReverse(TACSBVecDistCtx *ctx, TacsScalar *local, TacsScalar *global,
@@ -129,6 +165,17 @@ class TACSBVecDistribute : public TACSObject {
   // Block-specific implementation pointers
   // --------------------------------------
   void initImpl(int bsize);
+  void findRequests();
+  void copyExtValues(int bsize, const TacsScalar *src, TacsScalar *dest);
+  void copyExtValuesDevice(int bsize, const TacsScalar *src, TacsScalar *dest,
+                           int from_host);
+  void initRequests(TACSBVecDistCtx *ctx, TacsScalar *reqvals,
+                    TacsScalar *ext_vals);
+  void initSharedMemory();
+  void allocBuffers(TACSBVecDistCtx *ctx);
+  void syncSharedBuffers(TACSBVecDistCtx *ctx);
+  void copySharedValues(TACSBVecDistCtx *ctx, int forward);
+  void addCommStats(int bsize, int forward);
   void (*bgetvars)(int bsize, int nvars, const int *vars, int lower,
                    TacsScalar *x, TacsScalar *y, TACSBVecOperation op);
   void (*bsetvars)(int bsize, int nvars, const int *vars, int lower,
@@ -137,6 +184,10 @@ class TACSBVecDistribute : public TACSObject {
   // The communicator and the MPI data
   MPI_Comm comm;
 
+  // The distributed graph communicators for the forward and reverse
+  // transfers between neighboring processors
+  MPI_Comm forward_comm, reverse_comm;
+
   // Data defining the distribution of the variables
   TACSNodeMap *rmap;
 
@@ -171,6 +222,20 @@ class TACSBVecDistribute : public TACSObject {
   int ext_self_ptr;
   int ext_self_count;
 
+  // The indices of the processors in ext_proc and req_proc that
+  // exchange messages. This excludes the processors on the same node
+  // when the values are exchanged through shared memory.
+  int n_ext_msg, *ext_msg;
+  int n_req_msg, *req_msg;
+
+  // Data for the exchange through shared memory on the node. The node
+  // rank is -1 for processors that are not on the same node, and the
+  // offsets are the node offsets of the values in the window of the
+  // other processor.
+  MPI_Comm node_comm;
+  int *ext_node_rank, *ext_node_offset;
+  int *req_node_rank, *req_node_offset;
+
   // Set the name of the object
   static const char *name;
 };
@@ -199,9 +264,30 @@ class TACSBVecDistCtx : public TACSObject {
   // The requested values
   TacsScalar *reqvals;
 
-  // The MPI requests for either the sends or recvs
-  MPI_Request *sends;
-  MPI_Request *recvs;
+  // The shared memory window that stores ext_sorted_vals followed by
+  // reqvals, and the addresses of the values from the processors on
+  // the same node, or NULL for the other processors
+  MPI_Win win;
+  const TacsScalar **ext_node_vals, **req_node_vals;
+
+  // The counts and displacements for the requested and external values
+  int *req_counts, *req_displs;
+  int *ext_counts, *ext_displs;
+
+  // Flag to indicate whether a forward transfer is in progress
+  int forward_active;
+
+  // The device arrays for a context created by createDeviceCtx(). The
+  // host arrays reqvals and ext_sorted_vals are only allocated to
+  // stage the transfers when MPI cannot use device arrays directly.
+  int is_device;
+  int *dev_req_vars, *dev_self_vars, *dev_unsorted_index;
+  TacsScalar *dev_reqvals, *dev_ext_sorted_vals;
+
+  // The persistent requests for the forward and reverse transfers
+  int num_requests;
+  MPI_Request *forward_reqs;
+  MPI_Request *reverse_reqs;
 
   // Set the send and recv tags
   int ctx_tag;
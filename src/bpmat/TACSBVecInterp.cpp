@@ -31,49 +31,82 @@
 void BVecInterpMultAddGen(int bsize, int nrows, const int *rowp,
                           const int *cols, const TacsScalar *weights,
                           const TacsScalar *x, TacsScalar *y);
-void BVecInterpMultTransposeAddGen(int bsize, int nrows, const int *rowp,
-                                   const int *cols, const TacsScalar *weights,
-                                   const TacsScalar *x, TacsScalar *y);
 
 void BVecInterpMultAdd1(int bsize, int nrows, const int *rowp, const int *cols,
                         const TacsScalar *weights, const TacsScalar *x,
                         TacsScalar *y);
-void BVecInterpMultTransposeAdd1(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *weights,
-                                 const TacsScalar *x, TacsScalar *y);
 
 void BVecInterpMultAdd2(int bsize, int nrows, const int *rowp, const int *cols,
                         const TacsScalar *weights, const TacsScalar *x,
                         TacsScalar *y);
-void BVecInterpMultTransposeAdd2(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *weights,
-                                 const TacsScalar *x, TacsScalar *y);
 
 void BVecInterpMultAdd3(int bsize, int nrows, const int *rowp, const int *cols,
                         const TacsScalar *weights, const TacsScalar *x,
                         TacsScalar *y);
-void BVecInterpMultTransposeAdd3(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *weights,
-                                 const TacsScalar *x, TacsScalar *y);
 void BVecInterpMultAdd4(int bsize, int nrows, const int *rowp, const int *cols,
                         const TacsScalar *weights, const TacsScalar *x,
                         TacsScalar *y);
-void BVecInterpMultTransposeAdd4(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *weights,
-                                 const TacsScalar *x, TacsScalar *y);
 void BVecInterpMultAdd5(int bsize, int nrows, const int *rowp, const int *cols,
                         const TacsScalar *weights, const TacsScalar *x,
                         TacsScalar *y);
-void BVecInterpMultTransposeAdd5(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *weights,
-                                 const TacsScalar *x, TacsScalar *y);
 
 void BVecInterpMultAdd6(int bsize, int nrows, const int *rowp, const int *cols,
                         const TacsScalar *weights, const TacsScalar *x,
                         TacsScalar *y);
-void BVecInterpMultTransposeAdd6(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *weights,
-                                 const TacsScalar *x, TacsScalar *y);
+
+/*
+  The arguments for the threaded products
+*/
+typedef struct {
+  TACSBVecInterp *self;
+  const int *rowp, *cols;
+  const TacsScalar *weights, *x;
+  TacsScalar *y;
+} TACSBVecInterpMultArgs;
+
+/*
+  Form the transpose of the CSR weights with nrows rows and ncols
+  columns. The entries of each row of the transpose are stored in
+  order of increasing column index.
+*/
+static void TacsBVecInterpTranspose(int nrows, int ncols, const int *rowp,
+                                    const int *cols, const TacsScalar *weights,
+                                    int **_trowp, int **_tcols,
+                                    TacsScalar **_tweights) {
+  int nnz = rowp[nrows];
+  int *trowp = new int[ncols + 1];
+  int *tcols = new int[nnz];
+  TacsScalar *tweights = new TacsScalar[nnz];
+
+  // Count up the number of entries in each column
+  memset(trowp, 0, (ncols + 1) * sizeof(int));
+  for (int jp = 0; jp < nnz; jp++) {
+    trowp[cols[jp] + 1]++;
+  }
+  for (int i = 0; i < ncols; i++) {
+    trowp[i + 1] += trowp[i];
+  }
+
+  // Place the entries, using the rows of the transpose as counters
+  for (int i = 0; i < nrows; i++) {
+    for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      int k = trowp[cols[jp]];
+      tcols[k] = i;
+      tweights[k] = weights[jp];
+      trowp[cols[jp]]++;
+    }
+  }
+
+  // Shift the row pointer back
+  for (int i = ncols; i > 0; i--) {
+    trowp[i] = trowp[i - 1];
+  }
+  trowp[0] = 0;
+
+  *_trowp = trowp;
+  *_tcols = tcols;
+  *_tweights = tweights;
+}
 
 /*
   This object represents a matrix that interpolates between
@@ -109,6 +142,9 @@ TACSBVecInterp::TACSBVecInterp(TACSAssembler *_inAssembler,
   outAssembler->incref();
   init(inAssembler->getNodeMap(), outAssembler->getNodeMap(),
        inAssembler->getVarsPerNode());
+
+  // Use the threads from the output assembler for the products
+  setThreadInfo(outAssembler->getThreadInfo());
 }
 
 /*
@@ -178,6 +214,13 @@ void TACSBVecInterp::init(TACSNodeMap *_inMap, TACSNodeMap *_outMap,
   ext_weights = NULL;
   x_ext = NULL;
 
+  // The transposes are formed in initialize()
+  trowp = tcols = NULL;
+  tweights = NULL;
+  ext_trowp = ext_tcols = NULL;
+  ext_tweights = NULL;
+  thread_info = NULL;
+
   // NULL the transpose weight vector
   transpose_weights = NULL;
 
@@ -189,35 +232,37 @@ void TACSBVecInterp::init(TACSNodeMap *_inMap, TACSNodeMap *_outMap,
   ext_interp_cols = NULL;
   ext_interp_weights = NULL;
 
+  // The Galerkin plan is computed when it is first needed
+  rap_fine_dist = rap_coarse_dist = NULL;
+  rap_prowp = NULL;
+  rap_pweights = NULL;
+  rap_ap_rowp = rap_ap_ptr = rap_ap_map = NULL;
+  rap_AP = NULL;
+  rap_num_rows = 0;
+  rap_rowp = rap_pairs = rap_loc_ptr = rap_locs = NULL;
+
   // Initialize the implementation
   multadd = BVecInterpMultAddGen;
-  multtransadd = BVecInterpMultTransposeAddGen;
 
   // Initialize the block-specific implementations
   switch (bsize) {
     case 1:
       multadd = BVecInterpMultAdd1;
-      multtransadd = BVecInterpMultTransposeAdd1;
       break;
     case 2:
       multadd = BVecInterpMultAdd2;
-      multtransadd = BVecInterpMultTransposeAdd2;
       break;
     case 3:
       multadd = BVecInterpMultAdd3;
-      multtransadd = BVecInterpMultTransposeAdd3;
       break;
     case 4:
       multadd = BVecInterpMultAdd4;
-      multtransadd = BVecInterpMultTransposeAdd4;
       break;
     case 5:
       multadd = BVecInterpMultAdd5;
-      multtransadd = BVecInterpMultTransposeAdd5;
       break;
     case 6:
       multadd = BVecInterpMultAdd6;
-      multtransadd = BVecInterpMultTransposeAdd6;
       break;
     default:
       break;
@@ -296,6 +341,27 @@ TACSBVecInterp::~TACSBVecInterp() {
   if (transpose_weights) {
     delete[] transpose_weights;
   }
+  if (trowp) {
+    delete[] trowp;
+  }
+  if (tcols) {
+    delete[] tcols;
+  }
+  if (tweights) {
+    delete[] tweights;
+  }
+  if (ext_trowp) {
+    delete[] ext_trowp;
+  }
+  if (ext_tcols) {
+    delete[] ext_tcols;
+  }
+  if (ext_tweights) {
+    delete[] ext_tweights;
+  }
+  if (thread_info) {
+    thread_info->decref();
+  }
 
   if (ext_interp_rows) {
     delete[] ext_interp_rows;
@@ -309,6 +375,8 @@ TACSBVecInterp::~TACSBVecInterp() {
   if (ext_interp_weights) {
     delete[] ext_interp_weights;
   }
+
+  clearGalerkinPlan();
 }
 
 /*
@@ -442,6 +510,9 @@ void TACSBVecInterp::addInterp(int num, TacsScalar w[], int vars[], int size) {
   perform restriction or prolongation operations.
 */
 void TACSBVecInterp::initialize() {
+  // The weights may change, so the Galerkin plan is no longer valid
+  clearGalerkinPlan();
+
   // Retrieve the MPI comm size
   int mpi_size, mpi_rank;
   MPI_Comm_size(comm, &mpi_size);
@@ -1047,6 +1118,73 @@ void TACSBVecInterp::initialize() {
 
   // Zero the external vector
   memset(x_ext, 0, bsize * num_ext_vars * sizeof(TacsScalar));
+
+  // Form the transposes of the local and external parts so that the
+  // transpose products are computed row-wise
+  TacsBVecInterpTranspose(N, M, rowp, cols, weights, &trowp, &tcols,
+                          &tweights);
+  TacsBVecInterpTranspose(N, num_ext_vars, ext_rowp, ext_cols, ext_weights,
+                          &ext_trowp, &ext_tcols, &ext_tweights);
+}
+
+/*
+  Set the threads used to compute the products
+
+  input:
+  thread_info:  the thread pool (may be NULL for a serial product)
+*/
+void TACSBVecInterp::setThreadInfo(TACSThreadInfo *_thread_info) {
+  if (_thread_info) {
+    _thread_info->incref();
+  }
+  if (thread_info) {
+    thread_info->decref();
+  }
+  thread_info = _thread_info;
+}
+
+/*
+  Compute y += A*x for the rows in [start, end) of a CSR part
+*/
+void TACSBVecInterp::multAddRange(int start, int end, int thread_id,
+                                  void *ctx) {
+  TACSBVecInterpMultArgs *args = (TACSBVecInterpMultArgs *)ctx;
+  TACSBVecInterp *self = args->self;
+  int bsize = self->bsize;
+  self->multadd(bsize, end - start, &args->rowp[start], args->cols,
+                &args->weights[args->rowp[start]], args->x,
+                &args->y[bsize * start]);
+}
+
+/*
+  Compute y += A*x for a CSR part with one weight per block. The rows
+  are split across the threads when more than one thread is available.
+
+  input:
+  nrows:    the number of rows
+  rowp:     the pointer into each row
+  cols:     the column indices
+  weights:  the interpolation weights
+  x:        the input array
+
+  output:
+  y:        the output array
+*/
+void TACSBVecInterp::multAddRows(int nrows, const int *_rowp,
+                                 const int *_cols, const TacsScalar *_weights,
+                                 const TacsScalar *x, TacsScalar *y) {
+  if (thread_info && thread_info->getNumThreads() > 1) {
+    TACSBVecInterpMultArgs args;
+    args.self = this;
+    args.rowp = _rowp;
+    args.cols = _cols;
+    args.weights = _weights;
+    args.x = x;
+    args.y = y;
+    thread_info->parallelFor(nrows, 256, multAddRange, &args);
+  } else {
+    multadd(bsize, nrows, _rowp, _cols, _weights, x, y);
+  }
 }
 
 /*
@@ -1080,13 +1218,13 @@ void TACSBVecInterp::mult(TACSBVec *inVec, TACSBVec *outVec) {
   vecDist->beginForward(ctx, in, x_ext);
 
   // Multiply the on-processor part
-  multadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(N, rowp, cols, weights, in, out);
 
   // Finish the off-processor communication
   vecDist->endForward(ctx, in, x_ext);
 
   // Multiply the off-processor part
-  multadd(bsize, N, ext_rowp, ext_cols, ext_weights, x_ext, out);
+  multAddRows(N, ext_rowp, ext_cols, ext_weights, x_ext, out);
 }
 
 /*
@@ -1125,13 +1263,13 @@ void TACSBVecInterp::multAdd(TACSBVec *inVec, TACSBVec *addVec,
   vecDist->beginForward(ctx, in, x_ext);
 
   // Multiply the on-processor part
-  multadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(N, rowp, cols, weights, in, out);
 
   // Finish the off-processo communication
   vecDist->endForward(ctx, in, x_ext);
 
   // Multiply the off-processor part
-  multadd(bsize, N, ext_rowp, ext_cols, ext_weights, x_ext, out);
+  multAddRows(N, ext_rowp, ext_cols, ext_weights, x_ext, out);
 }
 
 /*
@@ -1164,13 +1302,13 @@ void TACSBVecInterp::multTranspose(TACSBVec *inVec, TACSBVec *outVec) {
   memset(x_ext, 0, bsize * num_ext_vars * sizeof(TacsScalar));
 
   // Multiply the off-processor part first
-  multtransadd(bsize, N, ext_rowp, ext_cols, ext_weights, in, x_ext);
+  multAddRows(num_ext_vars, ext_trowp, ext_tcols, ext_tweights, in, x_ext);
 
   // Initialize communication to the off-processor part
   vecDist->beginReverse(ctx, x_ext, out, TACS_ADD_VALUES);
 
   // Multiply the on-processor part
-  multtransadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(M, trowp, tcols, tweights, in, out);
 
   // Finalize the communication to the off-processor part
   vecDist->endReverse(ctx, x_ext, out, TACS_ADD_VALUES);
@@ -1211,13 +1349,13 @@ void TACSBVecInterp::multTransposeAdd(TACSBVec *inVec, TACSBVec *addVec,
   memset(x_ext, 0, bsize * num_ext_vars * sizeof(TacsScalar));
 
   // Multiply the off-processor part first
-  multtransadd(bsize, N, ext_rowp, ext_cols, ext_weights, in, x_ext);
+  multAddRows(num_ext_vars, ext_trowp, ext_tcols, ext_tweights, in, x_ext);
 
   // Initialize communication to the off-processor part
   vecDist->beginReverse(ctx, x_ext, out, TACS_ADD_VALUES);
 
   // Multiply the on-processor part
-  multtransadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(M, trowp, tcols, tweights, in, out);
 
   // Finalize the communication to the off-processor part
   vecDist->endReverse(ctx, x_ext, out, TACS_ADD_VALUES);
@@ -1671,6 +1809,7 @@ void TACSBVecInterp::computeGalerkinNonZeroPattern(TACSParallelMat *Afine,
   }
 
   // Initialize the external rows
+  clearGalerkinPlan();
   initExtInterpRows(num_ext_indices, ext_indices);
 
   // Get the local matrices
@@ -1771,6 +1910,371 @@ void TACSBVecInterp::computeGalerkinNonZeroPattern(TACSParallelMat *Afine,
   *_Acoarse = Acoarse;
 }
 
+/*
+  Arguments for the threaded numeric phase of the Galerkin projection
+*/
+typedef struct {
+  TACSBVecInterp *self;
+  int bsize, Np;
+  const int *Arowp, *Acols, *Browp, *Bcols;
+  const TacsScalar *Avals, *Bvals;
+  TacsScalar *data[TACSMatDistribute::SCATTER_NUM_TARGETS];
+} TACSGalerkinArgs;
+
+/*
+  Compute the plan for the numeric phase of the Galerkin projection.
+
+  The projection is computed in two steps. First, the block rows of
+  A*P are computed for each local row of the fine matrix,
+
+  (A*P)[i] = sum_{j} A[i,j]*P[j]
+
+  using the rows of P for the local and external fine nodes. Second,
+  the coarse matrix is formed from the sum over the fine rows
+
+  Ac = sum_{i} P[i]^{T}*(A*P)[i]
+
+  The plan stores the position of each product in the row of A*P and
+  the location of each block of the coarse matrix in its local or
+  external storage, so that no searches are required in the numeric
+  phase. The products in the second step are grouped by the coarse
+  row, so that each coarse row is only modified by one thread.
+
+  The plan is only stored when both matrices have a TACSMatDistribute
+  object and every block of the projection is in the non-zero pattern
+  of the coarse matrix.
+
+  input:
+  Afine:    the fine matrix
+  Acoarse:  the coarse matrix
+
+  returns:  1 if the plan was computed, 0 otherwise
+*/
+int TACSBVecInterp::computeGalerkinPlan(TACSParallelMat *Afine,
+                                        TACSParallelMat *Acoarse) {
+  TACSMatDistribute *fine_dist = Afine->getMatDistribute();
+  TACSMatDistribute *coarse_dist = Acoarse->getMatDistribute();
+  if (!fine_dist || !coarse_dist) {
+    return 0;
+  }
+
+  BCSRMat *A, *B;
+  Afine->getBCSRMat(&A, &B);
+
+  int Na, Na_coupled;
+  const int *Arowp, *Acols, *Browp, *Bcols;
+  Afine->getRowMap(NULL, &Na, &Na_coupled);
+  A->getArrays(NULL, NULL, NULL, &Arowp, &Acols, NULL);
+  B->getArrays(NULL, NULL, NULL, &Browp, &Bcols, NULL);
+  int Np = Na - Na_coupled;
+
+  // Get the indices of the external unknowns
+  TACSBVecDistribute *ext_map;
+  Afine->getExtColMap(&ext_map);
+  const int *ext_indices;
+  int num_ext = ext_map->getIndices()->getIndices(&ext_indices);
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  const int *range;
+  outMap->getOwnerRange(&range);
+
+  // Gather the rows of P for the local and then the external nodes
+  int nfine = Na + num_ext;
+  rap_prowp = new int[nfine + 1];
+  rap_prowp[0] = 0;
+  for (int i = 0; i < nfine; i++) {
+    int row = (i < Na ? range[rank] + i : ext_indices[i - Na]);
+    rap_prowp[i + 1] = rap_prowp[i] + getRow(row, NULL, NULL);
+  }
+
+  int *pcols = new int[rap_prowp[nfine]];
+  rap_pweights = new TacsScalar[rap_prowp[nfine]];
+  for (int i = 0; i < nfine; i++) {
+    int row = (i < Na ? range[rank] + i : ext_indices[i - Na]);
+    getRow(row, &pcols[rap_prowp[i]], &rap_pweights[rap_prowp[i]]);
+  }
+
+  // Count the number of products in each row of A*P
+  int max_products = 0;
+  rap_ap_ptr = new int[Na + 1];
+  rap_ap_ptr[0] = 0;
+  for (int i = 0; i < Na; i++) {
+    int count = 0;
+    for (int jp = Arowp[i]; jp < Arowp[i + 1]; jp++) {
+      int j = Acols[jp];
+      count += rap_prowp[j + 1] - rap_prowp[j];
+    }
+    if (i >= Np) {
+      for (int jp = Browp[i - Np]; jp < Browp[i - Np + 1]; jp++) {
+        int j = Na + Bcols[jp];
+        count += rap_prowp[j + 1] - rap_prowp[j];
+      }
+    }
+    rap_ap_ptr[i + 1] = rap_ap_ptr[i] + count;
+    if (count > max_products) {
+      max_products = count;
+    }
+  }
+
+  // Find the coarse columns in each row of A*P and the position of
+  // each product within the row
+  rap_ap_map = new int[rap_ap_ptr[Na]];
+  rap_ap_rowp = new int[Na + 1];
+  int *ap_cols = new int[rap_ap_ptr[Na]];
+  int *temp = new int[max_products];
+
+  rap_ap_rowp[0] = 0;
+  for (int i = 0; i < Na; i++) {
+    int count = 0;
+    for (int jp = Arowp[i]; jp < Arowp[i + 1]; jp++) {
+      int j = Acols[jp];
+      for (int k = rap_prowp[j]; k < rap_prowp[j + 1]; k++, count++) {
+        temp[count] = pcols[k];
+      }
+    }
+    if (i >= Np) {
+      for (int jp = Browp[i - Np]; jp < Browp[i - Np + 1]; jp++) {
+        int j = Na + Bcols[jp];
+        for (int k = rap_prowp[j]; k < rap_prowp[j + 1]; k++, count++) {
+          temp[count] = pcols[k];
+        }
+      }
+    }
+
+    int *row_cols = &ap_cols[rap_ap_rowp[i]];
+    memcpy(row_cols, temp, count * sizeof(int));
+    int len = TacsUniqueSort(count, row_cols);
+    rap_ap_rowp[i + 1] = rap_ap_rowp[i] + len;
+
+    int *map = &rap_ap_map[rap_ap_ptr[i]];
+    for (int k = 0; k < count; k++) {
+      map[k] = TacsSearchArray(temp[k], len, row_cols) - row_cols;
+    }
+  }
+  delete[] temp;
+
+  // Find the coarse rows that receive contributions from this
+  // processor
+  rap_num_rows = rap_prowp[Na];
+  int *rap_rows = new int[rap_num_rows];
+  memcpy(rap_rows, pcols, rap_num_rows * sizeof(int));
+  rap_num_rows = TacsUniqueSort(rap_num_rows, rap_rows);
+
+  // Group the pairs of fine rows and weights by the coarse row
+  rap_rowp = new int[rap_num_rows + 1];
+  memset(rap_rowp, 0, (rap_num_rows + 1) * sizeof(int));
+  for (int k = 0; k < rap_prowp[Na]; k++) {
+    int r = TacsSearchArray(pcols[k], rap_num_rows, rap_rows) - rap_rows;
+    rap_rowp[r + 1]++;
+  }
+  for (int r = 0; r < rap_num_rows; r++) {
+    rap_rowp[r + 1] += rap_rowp[r];
+  }
+
+  int npairs = rap_rowp[rap_num_rows];
+  rap_pairs = new int[2 * npairs];
+  for (int i = 0; i < Na; i++) {
+    for (int k = rap_prowp[i]; k < rap_prowp[i + 1]; k++) {
+      int r = TacsSearchArray(pcols[k], rap_num_rows, rap_rows) - rap_rows;
+      rap_pairs[2 * rap_rowp[r]] = i;
+      rap_pairs[2 * rap_rowp[r] + 1] = k;
+      rap_rowp[r]++;
+    }
+  }
+  for (int r = rap_num_rows; r > 0; r--) {
+    rap_rowp[r] = rap_rowp[r - 1];
+  }
+  rap_rowp[0] = 0;
+
+  // Find the location of each block of the coarse matrix
+  rap_loc_ptr = new int[npairs + 1];
+  rap_loc_ptr[0] = 0;
+  for (int p = 0; p < npairs; p++) {
+    int i = rap_pairs[2 * p];
+    rap_loc_ptr[p + 1] = rap_loc_ptr[p] + rap_ap_rowp[i + 1] - rap_ap_rowp[i];
+  }
+
+  int fail = 0;
+  rap_locs = new int[rap_loc_ptr[npairs]];
+  for (int r = 0; r < rap_num_rows && !fail; r++) {
+    for (int p = rap_rowp[r]; p < rap_rowp[r + 1] && !fail; p++) {
+      int i = rap_pairs[2 * p];
+      int *loc = &rap_locs[rap_loc_ptr[p]];
+      for (int jp = rap_ap_rowp[i]; jp < rap_ap_rowp[i + 1]; jp++, loc++) {
+        loc[0] = coarse_dist->getBlockLocation(Acoarse, rap_rows[r],
+                                               ap_cols[jp]);
+        if (loc[0] < 0) {
+          fail = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  delete[] pcols;
+  delete[] ap_cols;
+  delete[] rap_rows;
+
+  if (fail) {
+    clearGalerkinPlan();
+    return 0;
+  }
+
+  rap_AP = new TacsScalar[bsize * bsize * rap_ap_rowp[Na]];
+  rap_fine_dist = fine_dist;
+  rap_fine_dist->incref();
+  rap_coarse_dist = coarse_dist;
+  rap_coarse_dist->incref();
+
+  return 1;
+}
+
+/*
+  Free the plan for the Galerkin projection
+*/
+void TACSBVecInterp::clearGalerkinPlan() {
+  if (rap_fine_dist) {
+    rap_fine_dist->decref();
+  }
+  if (rap_coarse_dist) {
+    rap_coarse_dist->decref();
+  }
+  if (rap_prowp) {
+    delete[] rap_prowp;
+  }
+  if (rap_pweights) {
+    delete[] rap_pweights;
+  }
+  if (rap_ap_rowp) {
+    delete[] rap_ap_rowp;
+  }
+  if (rap_ap_ptr) {
+    delete[] rap_ap_ptr;
+  }
+  if (rap_ap_map) {
+    delete[] rap_ap_map;
+  }
+  if (rap_AP) {
+    delete[] rap_AP;
+  }
+  if (rap_rowp) {
+    delete[] rap_rowp;
+  }
+  if (rap_pairs) {
+    delete[] rap_pairs;
+  }
+  if (rap_loc_ptr) {
+    delete[] rap_loc_ptr;
+  }
+  if (rap_locs) {
+    delete[] rap_locs;
+  }
+  rap_fine_dist = rap_coarse_dist = NULL;
+  rap_prowp = NULL;
+  rap_pweights = NULL;
+  rap_ap_rowp = rap_ap_ptr = rap_ap_map = NULL;
+  rap_AP = NULL;
+  rap_num_rows = 0;
+  rap_rowp = rap_pairs = rap_loc_ptr = rap_locs = NULL;
+}
+
+/*
+  Compute the block rows of A*P for the fine rows in [start, end)
+*/
+void TACSBVecInterp::galerkinProductRange(int start, int end, int thread_id,
+                                          void *ctx) {
+  TACSGalerkinArgs *args = (TACSGalerkinArgs *)ctx;
+  TACSBVecInterp *self = args->self;
+  const int b2 = args->bsize * args->bsize;
+  const int *prowp = self->rap_prowp;
+  const TacsScalar *pweights = self->rap_pweights;
+
+  for (int i = start; i < end; i++) {
+    TacsScalar *ap = &self->rap_AP[b2 * self->rap_ap_rowp[i]];
+    int len = self->rap_ap_rowp[i + 1] - self->rap_ap_rowp[i];
+    memset(ap, 0, b2 * len * sizeof(TacsScalar));
+
+    const int *map = &self->rap_ap_map[self->rap_ap_ptr[i]];
+    for (int jp = args->Arowp[i]; jp < args->Arowp[i + 1]; jp++) {
+      const TacsScalar *a = &args->Avals[b2 * jp];
+      int j = args->Acols[jp];
+      for (int k = prowp[j]; k < prowp[j + 1]; k++, map++) {
+        TacsScalar *t = &ap[b2 * map[0]];
+        for (int n = 0; n < b2; n++) {
+          t[n] += pweights[k] * a[n];
+        }
+      }
+    }
+
+    if (i >= args->Np) {
+      int row = i - args->Np;
+      int Na = self->N;
+      for (int jp = args->Browp[row]; jp < args->Browp[row + 1]; jp++) {
+        const TacsScalar *a = &args->Bvals[b2 * jp];
+        int j = Na + args->Bcols[jp];
+        for (int k = prowp[j]; k < prowp[j + 1]; k++, map++) {
+          TacsScalar *t = &ap[b2 * map[0]];
+          for (int n = 0; n < b2; n++) {
+            t[n] += pweights[k] * a[n];
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+  Add the products P[i]^{T}*(A*P)[i] to the coarse rows in [start, end)
+*/
+void TACSBVecInterp::galerkinScatterRange(int start, int end, int thread_id,
+                                          void *ctx) {
+  TACSGalerkinArgs *args = (TACSGalerkinArgs *)ctx;
+  TACSBVecInterp *self = args->self;
+  const int b2 = args->bsize * args->bsize;
+  const int ntargets = TACSMatDistribute::SCATTER_NUM_TARGETS;
+
+  for (int r = start; r < end; r++) {
+    for (int p = self->rap_rowp[r]; p < self->rap_rowp[r + 1]; p++) {
+      int i = self->rap_pairs[2 * p];
+      TacsScalar w = self->rap_pweights[self->rap_pairs[2 * p + 1]];
+
+      const TacsScalar *ap = &self->rap_AP[b2 * self->rap_ap_rowp[i]];
+      int len = self->rap_ap_rowp[i + 1] - self->rap_ap_rowp[i];
+      const int *loc = &self->rap_locs[self->rap_loc_ptr[p]];
+      for (int c = 0; c < len; c++, ap += b2) {
+        TacsScalar *a =
+            &args->data[loc[c] % ntargets][b2 * (loc[c] / ntargets)];
+        for (int n = 0; n < b2; n++) {
+          a[n] += w * ap[n];
+        }
+      }
+    }
+  }
+}
+
+/*
+  Compute the values of the Galerkin projection of the fine matrix onto
+  the coarse matrix
+
+  Ac = P^{T}*A*P
+
+  The coarse matrix must have the non-zero pattern computed by
+  computeGalerkinNonZeroPattern(). On the first call, a plan for the
+  projection is computed and stored, see computeGalerkinPlan(). The
+  plan is reused for subsequent calls with matrices that have the same
+  non-zero patterns, which is the case when the fine matrix values are
+  updated within a nonlinear or optimization loop. Both steps of the
+  numeric phase are executed in parallel with the threads from the
+  fine matrix.
+
+  When the plan cannot be computed, each product is added to the
+  coarse matrix with addValues().
+
+  input:
+  Afine:    the fine matrix
+  Acoarse:  the coarse matrix
+*/
 void TACSBVecInterp::computeGalerkin(TACSParallelMat *Afine,
                                      TACSParallelMat *Acoarse) {
   Acoarse->zeroEntries();
@@ -1778,6 +2282,36 @@ void TACSBVecInterp::computeGalerkin(TACSParallelMat *Afine,
   BCSRMat *A, *B;
   Afine->getBCSRMat(&A, &B);
 
+  // Compute the plan if either of the non-zero patterns has changed
+  if (!rap_rowp || Afine->getMatDistribute() != rap_fine_dist ||
+      Acoarse->getMatDistribute() != rap_coarse_dist) {
+    clearGalerkinPlan();
+    computeGalerkinPlan(Afine, Acoarse);
+  }
+
+  if (rap_rowp) {
+    TACSGalerkinArgs args;
+    args.self = this;
+    int Na, Na_coupled;
+    Afine->getRowMap(NULL, &Na, &Na_coupled);
+    args.Np = Na - Na_coupled;
+
+    TacsScalar *Avals, *Bvals;
+    A->getArrays(&args.bsize, NULL, NULL, &args.Arowp, &args.Acols, &Avals);
+    B->getArrays(NULL, NULL, NULL, &args.Browp, &args.Bcols, &Bvals);
+    args.Avals = Avals;
+    args.Bvals = Bvals;
+    rap_coarse_dist->getBlockData(Acoarse, args.data);
+
+    TACSThreadInfo *thread_info = A->getThreadInfo();
+    thread_info->parallelFor(Na, 64, galerkinProductRange, &args);
+    thread_info->parallelFor(rap_num_rows, 16, galerkinScatterRange, &args);
+
+    Acoarse->beginAssembly();
+    Acoarse->endAssembly();
+    return;
+  }
+
   // Get the rank and the owner range
   int rank;
   MPI_Comm_rank(outMap->getMPIComm(), &rank);
@@ -1923,25 +2457,6 @@ void BVecInterpMultAddGen(int bsize, int nrows, const int *rowp,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for generic bsize
-*/
-void BVecInterpMultTransposeAddGen(int bsize, int nrows, const int *rowp,
-                                   const int *cols, const TacsScalar *w,
-                                   const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      for (int k = 0; k < bsize; k++) {
-        y[bsize * cols[j] + k] += w[0] * x[bsize * i + k];
-      }
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 1
 */
@@ -1959,23 +2474,6 @@ void BVecInterpMultAdd1(int bsize, int nrows, const int *rowp, const int *cols,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 1
-*/
-void BVecInterpMultTransposeAdd1(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *w,
-                                 const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      y[cols[j]] += w[0] * x[i];
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 2
 */
@@ -1994,24 +2492,6 @@ void BVecInterpMultAdd2(int bsize, int nrows, const int *rowp, const int *cols,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 2
-*/
-void BVecInterpMultTransposeAdd2(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *w,
-                                 const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      y[2 * cols[j]] += w[0] * x[2 * i];
-      y[2 * cols[j] + 1] += w[0] * x[2 * i + 1];
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 3
 */
@@ -2031,24 +2511,6 @@ void BVecInterpMultAdd3(int bsize, int nrows, const int *rowp, const int *cols,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 3
-*/
-void BVecInterpMultTransposeAdd3(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *w,
-                                 const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      y[3 * cols[j]] += w[0] * x[3 * i];
-      y[3 * cols[j] + 1] += w[0] * x[3 * i + 1];
-      y[3 * cols[j] + 2] += w[0] * x[3 * i + 2];
-      w++;
-    }
-  }
-}
 /*
   Compute a matrix-vector product for bsize = 4
 */
@@ -2069,25 +2531,6 @@ void BVecInterpMultAdd4(int bsize, int nrows, const int *rowp, const int *cols,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 4
-*/
-void BVecInterpMultTransposeAdd4(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *w,
-                                 const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      y[4 * cols[j]] += w[0] * x[4 * i];
-      y[4 * cols[j] + 1] += w[0] * x[4 * i + 1];
-      y[4 * cols[j] + 2] += w[0] * x[4 * i + 2];
-      y[4 * cols[j] + 3] += w[0] * x[4 * i + 3];
-      w++;
-    }
-  }
-}
 /*
   Compute a matrix-vector product for bsize = 5
 */
@@ -2109,27 +2552,6 @@ void BVecInterpMultAdd5(int bsize, int nrows, const int *rowp, const int *cols,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 5
-*/
-void BVecInterpMultTransposeAdd5(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *w,
-                                 const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      y[5 * cols[j]] += w[0] * x[5 * i];
-      y[5 * cols[j] + 1] += w[0] * x[5 * i + 1];
-      y[5 * cols[j] + 2] += w[0] * x[5 * i + 2];
-      y[5 * cols[j] + 3] += w[0] * x[5 * i + 3];
-      y[5 * cols[j] + 4] += w[0] * x[5 * i + 4];
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 5
 */
@@ -2152,24 +2574,3 @@ void BVecInterpMultAdd6(int bsize, int nrows, const int *rowp, const int *cols,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 6
-*/
-void BVecInterpMultTransposeAdd6(int bsize, int nrows, const int *rowp,
-                                 const int *cols, const TacsScalar *w,
-                                 const TacsScalar *x, TacsScalar *y) {
-  for (int i = 0; i < nrows; i++) {
-    int j = rowp[i];
-    int end = rowp[i + 1];
-
-    for (; j < end; j++) {
-      y[6 * cols[j]] += w[0] * x[6 * i];
-      y[6 * cols[j] + 1] += w[0] * x[6 * i + 1];
-      y[6 * cols[j] + 2] += w[0] * x[6 * i + 2];
-      y[6 * cols[j] + 3] += w[0] * x[6 * i + 3];
-      y[6 * cols[j] + 4] += w[0] * x[6 * i + 4];
-      y[6 * cols[j] + 5] += w[0] * x[6 * i + 5];
-      w++;
-    }
-  }
-}
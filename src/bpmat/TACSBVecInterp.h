@@ -46,6 +46,13 @@
   implemented elsewhere in TACS, since each block would be a bsize x
   bsize identity matrix.
 
+  The local and external parts of the operator are stored in CSR
+  format with one weight per block, and the transpose of each part is
+  stored explicitly once the operator is initialized. As a result, the
+  forward and transpose products are both row-wise gathers that are
+  split across the threads without scattered additions. The transfer
+  of the external values is overlapped with the local product.
+
   The BVecInterp operator performs the following multiplication:
 
   1. y <- A*x
@@ -70,6 +77,10 @@ class TACSBVecInterp : public TACSObject {
   void addInterp(int vNum, TacsScalar weights[], int inNums[], int size);
   void initialize();
 
+  // Set the threads used for the products
+  // -------------------------------------
+  void setThreadInfo(TACSThreadInfo *_thread_info);
+
   // Perform the foward interpolation
   // --------------------------------
   void mult(TACSBVec *in, TACSBVec *out);
@@ -88,10 +99,12 @@ class TACSBVecInterp : public TACSObject {
   // -----------------------
   void printInterp(const char *filename);
 
-  // Initialize the non-zero pattern
+  // Compute the Galerkin projection P^{T}*A*P
+  // ------------------------------------------
   void computeGalerkinNonZeroPattern(TACSParallelMat *Afine,
                                      TACSParallelMat **_Acoarse);
   void computeGalerkin(TACSParallelMat *Afine, TACSParallelMat *Acoarse);
+  void clearGalerkinPlan();
 
  private:
   // The MPI communicator
@@ -103,9 +116,12 @@ class TACSBVecInterp : public TACSObject {
   void (*multadd)(int bsize, int nrows, const int *rowp, const int *cols,
                   const TacsScalar *weights, const TacsScalar *x,
                   TacsScalar *y);
-  void (*multtransadd)(int bsize, int nrows, const int *rowp, const int *cols,
-                       const TacsScalar *weights, const TacsScalar *x,
-                       TacsScalar *y);
+
+  // Compute y += A*x for the rows of a CSR part on the threads
+  void multAddRows(int nrows, const int *_rowp, const int *_cols,
+                   const TacsScalar *_weights, const TacsScalar *x,
+                   TacsScalar *y);
+  static void multAddRange(int start, int end, int thread_id, void *ctx);
 
   // Initialize data from off-processor rows
   void initExtInterpRows(int _num_ext_interp_rows, const int *_ext_interp_rows);
@@ -114,6 +130,13 @@ class TACSBVecInterp : public TACSObject {
   int getMaxRowSize();
   int getRow(int row, int *columns, TacsScalar *values);
 
+  // Compute the plan for the numeric phase of the Galerkin projection
+  int computeGalerkinPlan(TACSParallelMat *Afine, TACSParallelMat *Acoarse);
+  static void galerkinProductRange(int start, int end, int thread_id,
+                                   void *ctx);
+  static void galerkinScatterRange(int start, int end, int thread_id,
+                                   void *ctx);
+
   // The on and off-processor parts of the interpolation
   // These are dynamically expanded if they are not large enough
   int max_on_size, max_on_weights;
@@ -132,6 +155,15 @@ class TACSBVecInterp : public TACSObject {
   int *ext_rowp, *ext_cols;
   TacsScalar *ext_weights;
 
+  // The transpose of the local and external weights
+  int *trowp, *tcols;
+  TacsScalar *tweights;
+  int *ext_trowp, *ext_tcols;
+  TacsScalar *ext_tweights;
+
+  // The threads used for the products (may be NULL)
+  TACSThreadInfo *thread_info;
+
   int num_ext_vars;   // The number of external variables
   TacsScalar *x_ext;  // Variable values from other processors
 
@@ -154,6 +186,22 @@ class TACSBVecInterp : public TACSObject {
   // external variables
   TACSBVecDistribute *vecDist;
   TACSBVecDistCtx *ctx;
+
+  // The plan for the Galerkin projection, computed on the first call
+  // to computeGalerkin(). The plan is valid for the fine and coarse
+  // non-zero patterns defined by the two distribution objects.
+  TACSMatDistribute *rap_fine_dist, *rap_coarse_dist;
+  int *rap_prowp;            // Rows of P for the local and external nodes
+  TacsScalar *rap_pweights;  // Weights of P for each row
+  int *rap_ap_rowp;          // Pointer into the rows of A*P
+  int *rap_ap_ptr;           // Pointer into rap_ap_map for each fine row
+  int *rap_ap_map;           // Position of each product in the row of A*P
+  TacsScalar *rap_AP;        // The block values of A*P
+  int rap_num_rows;          // Number of coarse rows with contributions
+  int *rap_rowp;             // Pointer into rap_pairs for each coarse row
+  int *rap_pairs;            // The fine row and weight index for each pair
+  int *rap_loc_ptr;          // Pointer into rap_locs for each pair
+  int *rap_locs;             // Encoded block locations in the coarse matrix
 };
 
 #endif  // TACS_BVEC_INTERP_H
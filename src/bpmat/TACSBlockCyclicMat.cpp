@@ -20,6 +20,10 @@
 
 #include <stdlib.h>
 
+#include "BCSRMatImpl.h"
+#include "TACSCommProfiler.h"
+#include "TACSDevice.h"
+#include "TACSMemory.h"
 #include "TacsUtilities.h"
 #include "tacslapack.h"
 
@@ -27,6 +31,7 @@
 #include "amd.h"
 #else
 #include "AMDInterface.h"
+#include "tacsmetis.h"
 #endif  // TACS_HAS_AMD_LIBRARY
 
 /*
@@ -74,11 +79,12 @@ TACSBlockCyclicMat::TACSBlockCyclicMat(MPI_Comm _comm, int csr_m, int csr_n,
                                        int reorder_blocks, int max_grid_size) {
   comm = _comm;
   monitor_factor = 0;
+  use_device = 0;
+  d_Dvals = d_Lvals = d_Uvals = d_work = NULL;
   perm = iperm = orig_bptr = NULL;
 
-  int rank = 0, size = 0;
+  int size = 0;
   MPI_Comm_size(comm, &size);
-  MPI_Comm_rank(comm, &rank);
 
   // Determine the process grid
   if (max_grid_size <= 0 || max_grid_size > size) {
@@ -125,6 +131,88 @@ TACSBlockCyclicMat::TACSBlockCyclicMat(MPI_Comm _comm, int csr_m, int csr_n,
     }
   }
 
+  // Set the non-zero pattern from the CSR contributions
+  init_sparse(csr_bsize, csr_vars, csr_nvars, csr_rowp, csr_cols,
+              reorder_blocks);
+}
+
+/*
+  Assemble the non-zero pattern of a square matrix where the blocks
+  are defined by a partition of the block-CSR variables.
+
+  This constructor is intended for use with a supernodal partition
+  computed by computeSupernodes(). The block-CSR variables must
+  already be numbered so that each block is a contiguous range of
+  variables. Since this numbering already reduces fill-in, the blocks
+  are not reordered.
+
+  input:
+  comm:           MPI communicator for the matrix
+  csr_m:          number of block-CSR rows and columns
+  csr_bsize:      input block-CSR block size
+  csr_vars:       global block-CSR variable numbers
+  csr_nvars:      number of CSR variables
+  csr_rowp:       CSR row pointer
+  csr_cols:       global non-zero column indices
+  num_blocks:     number of blocks in the partition
+  csr_block_ptr:  block i contains CSR variables
+                  csr_block_ptr[i] <= var < csr_block_ptr[i+1]
+*/
+TACSBlockCyclicMat::TACSBlockCyclicMat(MPI_Comm _comm, int csr_m,
+                                       int csr_bsize, const int *csr_vars,
+                                       int csr_nvars, const int *csr_rowp,
+                                       const int *csr_cols, int num_blocks,
+                                       const int *csr_block_ptr,
+                                       int max_grid_size) {
+  comm = _comm;
+  monitor_factor = 0;
+  use_device = 0;
+  d_Dvals = d_Lvals = d_Uvals = d_work = NULL;
+  perm = iperm = orig_bptr = NULL;
+
+  int size = 0;
+  MPI_Comm_size(comm, &size);
+
+  // Determine the process grid
+  if (max_grid_size <= 0 || max_grid_size > size) {
+    max_grid_size = size;
+  }
+  init_proc_grid(max_grid_size);
+
+  // Set the block pointer from the partition
+  nrows = ncols = num_blocks;
+  bptr = new int[nrows + 1];
+  max_bsize = 0;
+  for (int i = 0; i <= nrows; i++) {
+    bptr[i] = csr_bsize * csr_block_ptr[i];
+    if (i > 0 && bptr[i] - bptr[i - 1] > max_bsize) {
+      max_bsize = bptr[i] - bptr[i - 1];
+    }
+  }
+  if (bptr[nrows] != csr_bsize * csr_m) {
+    fprintf(stderr,
+            "TACSBlockCyclicMat: Block partition does not match the "
+            "matrix size\n");
+  }
+
+  // Set the non-zero pattern from the CSR contributions
+  int reorder_blocks = 0;
+  init_sparse(csr_bsize, csr_vars, csr_nvars, csr_rowp, csr_cols,
+              reorder_blocks);
+}
+
+/*
+  Determine the block non-zero pattern from the distributed block-CSR
+  contributions, compute the fill-in and allocate the storage. The
+  block pointer bptr must be set before calling this function.
+*/
+void TACSBlockCyclicMat::init_sparse(int csr_bsize, const int *csr_vars,
+                                     int csr_nvars, const int *csr_rowp,
+                                     const int *csr_cols,
+                                     int reorder_blocks) {
+  int size = 0;
+  MPI_Comm_size(comm, &size);
+
   // Determine the block-CSR format for the block-cyclic matrix.
 
   // The following approach allocates more memory than is actually
@@ -192,6 +280,8 @@ TACSBlockCyclicMat::TACSBlockCyclicMat(MPI_Comm _comm, int csr_m, int csr_n,
 TACSBlockCyclicMat::TACSBlockCyclicMat(MPI_Comm _comm, int _nrows, int _ncols) {
   comm = _comm;
   monitor_factor = 0;
+  use_device = 0;
+  d_Dvals = d_Lvals = d_Uvals = d_work = NULL;
   perm = iperm = orig_bptr = NULL;
 
   int rank = 0, size = 0;
@@ -291,6 +381,8 @@ TACSBlockCyclicMat::TACSBlockCyclicMat(MPI_Comm _comm, int _nrows, int _ncols) {
 }
 
 TACSBlockCyclicMat::~TACSBlockCyclicMat() {
+  TACSMemory::update(TACS_MEMORY_DENSE_MATRIX, &mem_bytes, 0);
+
   // Delete the process grid information
   delete[] proc_grid;
 
@@ -323,6 +415,14 @@ TACSBlockCyclicMat::~TACSBlockCyclicMat() {
   delete[] lval_offset;
   delete[] Lvals;
 
+  // Free the device copies of the factor
+  if (d_Dvals) {
+    TacsDeviceFree(d_Dvals);
+    TacsDeviceFree(d_Lvals);
+    TacsDeviceFree(d_Uvals);
+    TacsDeviceFree(d_work);
+  }
+
   // Delete arrays for the back-solves
   if (lower_row_sum_count) {
     delete[] lower_row_sum_count;
@@ -684,6 +784,210 @@ void TACSBlockCyclicMat::compute_symbolic_factor(int **_rowp, int **_cols,
   delete[] rcols;
 }
 
+/*
+  Compute a fill-reducing ordering of the nodal non-zero pattern and
+  a partition of the ordered nodes into supernodes.
+
+  The nodes are first ordered using approximate minimum degree or,
+  when use_nd is set, METIS nested dissection. Nested dissection gives
+  less fill-in and a wider elimination tree for the large interface
+  problems that arise on many processors. The ordering is then
+  modified by a postorder of the elimination
+  tree. The postorder leaves the fill-in unchanged, but places the
+  nodes of each supernode next to one another. Node j is added to the
+  supernode containing node j-1 when j is the parent of j-1 in the
+  elimination tree and the column of the factor for j-1 has exactly
+  one more non-zero entry than the column for j. The columns within
+  a supernode therefore share the same non-zero pattern below the
+  diagonal block. The size of each supernode is limited to max_size
+  nodes.
+
+  input:
+  n:          the number of nodes
+  rowp:       the CSR row pointer of the symmetric nodal pattern
+  cols:       the column indices of the nodal pattern
+  max_size:   the maximum number of nodes in a supernode
+  use_nd:     use nested dissection instead of minimum degree
+
+  output:
+  perm:        new node i -> old node perm[i]
+  num_snodes:  the number of supernodes
+  snode_ptr:   supernode i contains the new nodes
+               snode_ptr[i] <= node < snode_ptr[i+1] (length n+1)
+*/
+void TACSBlockCyclicMat::computeSupernodes(int n, const int *rowp,
+                                           const int *cols, int max_size,
+                                           int *perm, int *num_snodes,
+                                           int *snode_ptr, int use_nd) {
+  if (n <= 0) {
+    *num_snodes = 0;
+    snode_ptr[0] = 0;
+    return;
+  }
+  if (max_size < 1) {
+    max_size = 1;
+  }
+
+  // Compute the fill-reducing ordering. Use a copy of the pattern
+  // since the ordering may destroy the input.
+  int *tmp_rowp = new int[n + 1];
+  int *tmp_cols = new int[rowp[n]];
+  int *iperm = new int[n];
+  if (use_nd) {
+    // METIS can't handle the diagonal entries, so remove them
+    tmp_rowp[0] = 0;
+    for (int i = 0, p = 0; i < n; i++) {
+      for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+        if (cols[jp] != i) {
+          tmp_cols[p] = cols[jp];
+          p++;
+        }
+      }
+      tmp_rowp[i + 1] = p;
+    }
+
+    int options[METIS_NOPTIONS];
+    METIS_SetDefaultOptions(options);
+    options[METIS_OPTION_NUMBERING] = 0;
+    METIS_NodeND(&n, tmp_rowp, tmp_cols, NULL, options, perm, iperm);
+  } else {
+    memcpy(tmp_rowp, rowp, (n + 1) * sizeof(int));
+    memcpy(tmp_cols, cols, rowp[n] * sizeof(int));
+#ifdef TACS_HAS_AMD_LIBRARY
+    double control[AMD_CONTROL], info[AMD_INFO];
+    amd_defaults(control);  // Use the default values
+    amd_order(n, tmp_rowp, tmp_cols, perm, control, info);
+#else
+    int use_exact_degree = 0;
+    amd_order_interface(n, tmp_rowp, tmp_cols, perm, NULL, 0, 0, NULL, NULL,
+                        NULL, use_exact_degree);
+#endif  // TACS_HAS_AMD_LIBRARY
+  }
+  delete[] tmp_rowp;
+  delete[] tmp_cols;
+
+  for (int i = 0; i < n; i++) {
+    iperm[perm[i]] = i;
+  }
+
+  // Compute the elimination tree using path compression
+  int *parent = new int[n];
+  int *ancestor = new int[n];
+  for (int i = 0; i < n; i++) {
+    parent[i] = -1;
+    ancestor[i] = -1;
+    int row = perm[i];
+    for (int jp = rowp[row]; jp < rowp[row + 1]; jp++) {
+      int inext = -1;
+      for (int k = iperm[cols[jp]]; k != -1 && k < i; k = inext) {
+        inext = ancestor[k];
+        ancestor[k] = i;
+        if (inext == -1) {
+          parent[k] = i;
+        }
+      }
+    }
+  }
+
+  // Compute the postorder of the elimination tree. The children of
+  // each node are stored as a linked list in ascending order.
+  int *head = new int[n];
+  int *next = new int[n];
+  for (int i = 0; i < n; i++) {
+    head[i] = -1;
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    if (parent[i] != -1) {
+      next[i] = head[parent[i]];
+      head[parent[i]] = i;
+    }
+  }
+
+  int *post = new int[n];
+  int *stack = ancestor;
+  for (int root = 0, k = 0; root < n; root++) {
+    if (parent[root] != -1) {
+      continue;
+    }
+    int top = 0;
+    stack[0] = root;
+    while (top >= 0) {
+      int p = stack[top];
+      int child = head[p];
+      if (child == -1) {
+        top--;
+        post[k] = p;
+        k++;
+      } else {
+        head[p] = next[child];
+        top++;
+        stack[top] = child;
+      }
+    }
+  }
+
+  // Combine the two orderings and relabel the elimination tree
+  int *ipost = head;
+  for (int k = 0; k < n; k++) {
+    ipost[post[k]] = k;
+  }
+  int *post_parent = next;
+  for (int k = 0; k < n; k++) {
+    int p = parent[post[k]];
+    post_parent[k] = (p == -1 ? -1 : ipost[p]);
+  }
+  for (int k = 0; k < n; k++) {
+    post[k] = perm[post[k]];
+  }
+  memcpy(perm, post, n * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    iperm[perm[i]] = i;
+  }
+
+  // Count the number of non-zeros below the diagonal in each column
+  // of the factor by traversing the row sub-trees
+  int *col_count = parent;
+  int *mark = ancestor;
+  for (int i = 0; i < n; i++) {
+    col_count[i] = 0;
+  }
+  for (int i = 0; i < n; i++) {
+    mark[i] = i;
+    int row = perm[i];
+    for (int jp = rowp[row]; jp < rowp[row + 1]; jp++) {
+      int k = iperm[cols[jp]];
+      if (k < i) {
+        for (; mark[k] != i; k = post_parent[k]) {
+          col_count[k]++;
+          mark[k] = i;
+        }
+      }
+    }
+  }
+
+  // Group the nodes into supernodes
+  int nsnodes = 0;
+  snode_ptr[0] = 0;
+  for (int j = 1; j < n; j++) {
+    int snode_size = j - snode_ptr[nsnodes];
+    if (post_parent[j - 1] != j || col_count[j - 1] != col_count[j] + 1 ||
+        snode_size >= max_size) {
+      nsnodes++;
+      snode_ptr[nsnodes] = j;
+    }
+  }
+  nsnodes++;
+  snode_ptr[nsnodes] = n;
+  *num_snodes = nsnodes;
+
+  delete[] iperm;
+  delete[] parent;
+  delete[] ancestor;
+  delete[] head;
+  delete[] next;
+  delete[] post;
+}
+
 /*
   Given the non-zero pattern in rowp/cols create Urowp/Ucols and
   Lcolp/Lrows arrays. Note that rowp/cols must be sorted row-wise.
@@ -844,6 +1148,55 @@ void TACSBlockCyclicMat::setMonitorFactorFlag(int flag) {
   monitor_factor = flag;
 }
 
+/*
+  Set the flag to perform the factorization with the device backend.
+
+  When set, the matrix values are copied to the device at the start of
+  each factorization and the factored values are copied back to the
+  host at the end, so that the back-solves are unchanged. The device
+  arrays are allocated on the first factorization and are kept until
+  the matrix is deleted, since the non-zero pattern does not change.
+*/
+void TACSBlockCyclicMat::setDeviceFactorFlag(int flag) { use_device = flag; }
+
+/*
+  Compute the inertia of the factored matrix.
+
+  The matrix must be symmetric. The block LU factorization does not
+  pivot between blocks, so the inertia of the matrix is the sum of the
+  inertia of the diagonal blocks of the factor, which are stored as
+  their inverses by the owning processors. This is collective on the
+  communicator of the matrix.
+
+  output:
+  nneg:   the number of negative eigenvalues
+  npos:   the number of positive eigenvalues
+*/
+void TACSBlockCyclicMat::getInertia(int *nneg, int *npos) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int counts[2] = {0, 0};
+  int proc_row, proc_col;
+  if (get_proc_row_column(rank, &proc_row, &proc_col)) {
+    double *work = new double[max_bsize * max_bsize + 4 * max_bsize];
+    for (int i = 0; i < nrows; i++) {
+      if (rank == get_block_owner(i, i)) {
+        int bi = bptr[i + 1] - bptr[i];
+        int neg, pos;
+        BMatComputeInertia(&Dvals[dval_offset[i]], bi, work, &neg, &pos);
+        counts[0] += neg;
+        counts[1] += pos;
+      }
+    }
+    delete[] work;
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, counts, 2, MPI_INT, MPI_SUM, comm);
+  *nneg = counts[0];
+  *npos = counts[1];
+}
+
 /*
   This function performs several initialization tasks, including
   determining the number of matrix elements that are stored locally,
@@ -935,6 +1288,12 @@ void TACSBlockCyclicMat::init_nz_arrays() {
   Lvals = new TacsScalar[lval_size];
   memset(Lvals, 0, lval_size * sizeof(TacsScalar));
 
+  // Record the memory for the dense blocks
+  mem_bytes = 0;
+  TACSMemory::update(
+      TACS_MEMORY_DENSE_MATRIX, &mem_bytes,
+      ((size_t)dval_size + uval_size + lval_size) * sizeof(TacsScalar));
+
   int max_buff[2], max_buff_all[2];
   max_buff[0] = max_lbuff_size;
   max_buff[1] = max_ubuff_size;
@@ -2434,6 +2793,11 @@ TacsScalar *TACSBlockCyclicMat::get_block(int rank, int i, int j) {
   A[i+1:n,i+1:n] <-- A[i+1:n,i+1:n] - L[i+1:n,i]*U[i,i+1:n]
 */
 void TACSBlockCyclicMat::factor() {
+  if (use_device) {
+    factor_device();
+    return;
+  }
+
   int rank;
   MPI_Comm_rank(comm, &rank);
 
@@ -2491,6 +2855,8 @@ void TACSBlockCyclicMat::factor() {
         int dest = proc_grid[proc_col + p * npcols];
         if (rank != dest) {
           MPI_Send(d_diag, bi * bi, TACS_MPI_TYPE, dest, p, comm);
+          TACSCommProfiler::addSend(TACS_COMM_DENSE_FACTOR, dest,
+                                    bi * bi * sizeof(TacsScalar));
         }
       }
     }
@@ -2498,8 +2864,12 @@ void TACSBlockCyclicMat::factor() {
     // Receive U[i,i]^{-1}
     if (rank != diag_owner && proc_col == get_proc_column(i)) {
       MPI_Status status;
+      double t0 = TACSCommProfiler::beginWait();
       MPI_Recv(temp_diag, bi * bi, TACS_MPI_TYPE, diag_owner, proc_row, comm,
                &status);
+      TACSCommProfiler::endWait(TACS_COMM_DENSE_FACTOR, t0);
+      TACSCommProfiler::addRecv(TACS_COMM_DENSE_FACTOR, diag_owner,
+                                bi * bi * sizeof(TacsScalar));
       d_diag = temp_diag;
     }
 
@@ -2529,6 +2899,8 @@ void TACSBlockCyclicMat::factor() {
           int tag = 2 * i;
           MPI_Isend(&Uvals[offset], ubuff_size, TACS_MPI_TYPE, dest, tag, comm,
                     &U_send_request[k]);
+          TACSCommProfiler::addSend(TACS_COMM_DENSE_FACTOR, dest,
+                                    ubuff_size * sizeof(TacsScalar));
           k++;
         }
       }
@@ -2538,6 +2910,8 @@ void TACSBlockCyclicMat::factor() {
       int tag = 2 * i;
       MPI_Irecv(Ubuff, ubuff_size, TACS_MPI_TYPE, source, tag, comm,
                 &U_recv_request);
+      TACSCommProfiler::addRecv(TACS_COMM_DENSE_FACTOR, source,
+                                ubuff_size * sizeof(TacsScalar));
     }
 
     // Determine the size of the incoming/outgoing L
@@ -2588,6 +2962,8 @@ void TACSBlockCyclicMat::factor() {
           int offset = lval_offset[Lcolp[i]];
           MPI_Isend(&Lvals[offset], lbuff_size, TACS_MPI_TYPE, dest, tag, comm,
                     &L_send_request[k]);
+          TACSCommProfiler::addSend(TACS_COMM_DENSE_FACTOR, dest,
+                                    lbuff_size * sizeof(TacsScalar));
           k++;
         }
       }
@@ -2597,6 +2973,8 @@ void TACSBlockCyclicMat::factor() {
       int tag = 2 * i + 1;
       MPI_Irecv(Lbuff, lbuff_size, TACS_MPI_TYPE, source, tag, comm,
                 &L_recv_request);
+      TACSCommProfiler::addRecv(TACS_COMM_DENSE_FACTOR, source,
+                                lbuff_size * sizeof(TacsScalar));
     }
 
     // There are four cases:
@@ -2614,6 +2992,7 @@ void TACSBlockCyclicMat::factor() {
     }
 
     // Wait for the remaining sends to complete
+    double t_wait = TACSCommProfiler::beginWait();
     if (source_proc_row == proc_row) {
       MPI_Waitall(nprows - 1, U_send_request, U_send_status);
     }
@@ -2638,6 +3017,7 @@ void TACSBlockCyclicMat::factor() {
 
     // Compute the bi-rank update to the remainder of the matrix
     // A[i+1:n,i+1:n] = A[i+1:n,i+1:n] - L[i:n,i]*U[i,i:n]
+    TACSCommProfiler::endWait(TACS_COMM_DENSE_FACTOR, t_wait);
 
     if (monitor_factor) {
       t_recv_wait += MPI_Wtime();
@@ -2721,3 +3101,367 @@ void TACSBlockCyclicMat::factor() {
   delete[] U_send_status;
   delete[] L_send_status;
 }
+
+/*
+  Get the device address of a block from its host address
+*/
+TacsScalar *TACSBlockCyclicMat::get_device_block(TacsScalar *A) {
+  if (A >= Dvals && A < &Dvals[dval_size]) {
+    return &d_Dvals[A - Dvals];
+  } else if (A >= Lvals && A < &Lvals[lval_size]) {
+    return &d_Lvals[A - Lvals];
+  }
+  return &d_Uvals[A - Uvals];
+}
+
+/*
+  Factor the matrix in-place using the device backend.
+
+  This follows the same steps and communication pattern as factor().
+  The inverse of each diagonal block is computed on the host, while
+  the panel scaling L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1} and the
+  trailing matrix updates are computed with TacsDeviceGemm().
+
+  The trailing update from step i is split between two streams. The
+  updates to the blocks in row or column i+1, which are required for
+  the next panel, are queued on stream 0 together with the panel
+  operations. The remaining updates are queued on stream 1. The host
+  only waits for stream 0 at the start of each step, so the update
+  on stream 1 overlaps with the inversion of the next diagonal block
+  and the communication of the next panel. Before queuing the next
+  panel updates, stream 0 waits for the previous work on stream 1.
+  The L/U data received from other processes is copied to one of two
+  device buffers that alternate between steps.
+*/
+void TACSBlockCyclicMat::factor_device() {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int proc_row, proc_col;  // Get the location of rank on the process grid
+  if (!get_proc_row_column(rank, &proc_row, &proc_col)) {
+    // This process is not on the process grid - does not participate
+    return;
+  }
+
+  // Allocate the device arrays on the first call. These are kept
+  // since the non-zero pattern does not change.
+  int b2 = max_bsize * max_bsize;
+  if (!d_Dvals) {
+    size_t work_size = 2 * b2 + 2 * (max_lbuff_size + max_ubuff_size);
+    d_Dvals = (TacsScalar *)TacsDeviceMalloc(dval_size * sizeof(TacsScalar));
+    d_Lvals = (TacsScalar *)TacsDeviceMalloc(lval_size * sizeof(TacsScalar));
+    d_Uvals = (TacsScalar *)TacsDeviceMalloc(uval_size * sizeof(TacsScalar));
+    d_work = (TacsScalar *)TacsDeviceMalloc(work_size * sizeof(TacsScalar));
+  }
+  TacsScalar *d_temp_diag = d_work;
+  TacsScalar *d_temp_block = &d_work[b2];
+  TacsScalar *d_Lbuff[2], *d_Ubuff[2];
+  d_Lbuff[0] = &d_work[2 * b2];
+  d_Lbuff[1] = &d_Lbuff[0][max_lbuff_size];
+  d_Ubuff[0] = &d_Lbuff[1][max_lbuff_size];
+  d_Ubuff[1] = &d_Ubuff[0][max_ubuff_size];
+
+  // Copy the assembled values to the device
+  TacsDeviceCopyToDevice(d_Dvals, Dvals, dval_size * sizeof(TacsScalar));
+  TacsDeviceCopyToDevice(d_Lvals, Lvals, lval_size * sizeof(TacsScalar));
+  TacsDeviceCopyToDevice(d_Uvals, Uvals, uval_size * sizeof(TacsScalar));
+
+  int *temp_piv = new int[max_bsize];
+  TacsScalar *temp_diag = new TacsScalar[max_bsize * max_bsize];
+  int lwork = 128 * max_bsize;
+  TacsScalar *work = new TacsScalar[lwork];
+
+  // Buffers to handle the recieves information
+  TacsScalar *Ubuff = new TacsScalar[max_ubuff_size];
+  TacsScalar *Lbuff = new TacsScalar[max_lbuff_size];
+
+  // Send information for rows owning U
+  MPI_Request *U_send_request = new MPI_Request[nprows - 1];
+  MPI_Status *U_send_status = new MPI_Status[nprows - 1];
+
+  // Send information for columns owning L
+  MPI_Request *L_send_request = new MPI_Request[npcols - 1];
+  MPI_Status *L_send_status = new MPI_Status[npcols - 1];
+
+  double t_panel = 0.0;
+  double t_recv_wait = 0.0;
+  double t_send_wait = 0.0;
+  int n_gemm = 0;
+
+  for (int i = 0; i < nrows; i++) {
+    int bi = bptr[i + 1] - bptr[i];
+
+    // Wait for the panel operations and the updates to row and
+    // column i from the previous step
+    if (monitor_factor) {
+      t_panel -= MPI_Wtime();
+    }
+    TacsDeviceStreamSynchronize(0);
+    if (monitor_factor) {
+      t_panel += MPI_Wtime();
+    }
+
+    // The device address of the inverse of the diagonal block
+    TacsScalar *d_diag = NULL;
+    int diag_owner = get_block_owner(i, i);
+
+    // Get the owner for the diagonal block
+    if (rank == diag_owner) {
+      // Copy the diagonal block to the host
+      int nd = dval_offset[i];
+      TacsDeviceCopyAsync(0, &Dvals[nd], &d_Dvals[nd],
+                          bi * bi * sizeof(TacsScalar));
+      TacsDeviceStreamSynchronize(0);
+
+      // Compute the inverse of the diagonal block
+      int info;
+      LAPACKgetrf(&bi, &bi, &Dvals[nd], &bi, temp_piv, &info);
+      LAPACKgetri(&bi, &Dvals[nd], &bi, temp_piv, work, &lwork, &info);
+      // Add flops from the inversion
+      TacsAddFlops(1.333333 * bi * bi * bi);
+
+      TacsDeviceCopyAsync(0, &d_Dvals[nd], &Dvals[nd],
+                          bi * bi * sizeof(TacsScalar));
+      d_diag = &d_Dvals[nd];
+
+      // Send the factor to the column processes
+      for (int p = 0; p < nprows; p++) {
+        int dest = proc_grid[proc_col + p * npcols];
+        if (rank != dest) {
+          MPI_Send(&Dvals[nd], bi * bi, TACS_MPI_TYPE, dest, p, comm);
+          TACSCommProfiler::addSend(TACS_COMM_DENSE_FACTOR, dest,
+                                    bi * bi * sizeof(TacsScalar));
+        }
+      }
+    }
+
+    // Receive U[i,i]^{-1}
+    if (rank != diag_owner && proc_col == get_proc_column(i)) {
+      MPI_Status status;
+      double t0 = TACSCommProfiler::beginWait();
+      MPI_Recv(temp_diag, bi * bi, TACS_MPI_TYPE, diag_owner, proc_row, comm,
+               &status);
+      TACSCommProfiler::endWait(TACS_COMM_DENSE_FACTOR, t0);
+      TACSCommProfiler::addRecv(TACS_COMM_DENSE_FACTOR, diag_owner,
+                                bi * bi * sizeof(TacsScalar));
+      TacsDeviceCopyAsync(0, d_temp_diag, temp_diag,
+                          bi * bi * sizeof(TacsScalar));
+      d_diag = d_temp_diag;
+    }
+
+    // Determine the size of the incoming/outgoing U
+    int ubuff_size = 0;
+    for (int jp = Urowp[i]; jp < Urowp[i + 1]; jp++) {
+      int j = Ucols[jp];
+      int bj = bptr[j + 1] - bptr[j];
+
+      if (get_proc_column(j) == proc_col) {
+        ubuff_size += bi * bj;
+      }
+    }
+
+    // Set the U values to the row processes that need it
+    MPI_Request U_recv_request;
+    int source_proc_row = get_proc_row(i);
+    if (source_proc_row == proc_row) {
+      // Copy the values of U to the host and send them
+      int offset = uval_offset[Urowp[i]];
+      if (nprows > 1) {
+        TacsDeviceCopyAsync(0, &Uvals[offset], &d_Uvals[offset],
+                            ubuff_size * sizeof(TacsScalar));
+        TacsDeviceStreamSynchronize(0);
+      }
+      for (int p = 0, k = 0; p < nprows; p++) {
+        int dest = proc_grid[proc_col + p * npcols];
+        if (rank != dest) {
+          int tag = 2 * i;
+          MPI_Isend(&Uvals[offset], ubuff_size, TACS_MPI_TYPE, dest, tag, comm,
+                    &U_send_request[k]);
+          TACSCommProfiler::addSend(TACS_COMM_DENSE_FACTOR, dest,
+                                    ubuff_size * sizeof(TacsScalar));
+          k++;
+        }
+      }
+    } else {
+      // The receiving processes
+      int source = proc_grid[proc_col + source_proc_row * npcols];
+      int tag = 2 * i;
+      MPI_Irecv(Ubuff, ubuff_size, TACS_MPI_TYPE, source, tag, comm,
+                &U_recv_request);
+      TACSCommProfiler::addRecv(TACS_COMM_DENSE_FACTOR, source,
+                                ubuff_size * sizeof(TacsScalar));
+    }
+
+    // Determine the size of the incoming/outgoing L
+    int lbuff_size = 0;
+    for (int jp = Lcolp[i]; jp < Lcolp[i + 1]; jp++) {
+      int j = Lrows[jp];
+      int bj = bptr[j + 1] - bptr[j];
+
+      if (get_proc_row(j) == proc_row) {
+        lbuff_size += bi * bj;
+      }
+    }
+
+    // Compute L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1} on the device
+    if (proc_col == get_proc_column(i)) {
+      for (int jp = Lcolp[i]; jp < Lcolp[i + 1]; jp++) {
+        int j = Lrows[jp];
+        int bj = bptr[j + 1] - bptr[j];
+
+        if (rank == get_block_owner(j, i)) {
+          int np = lval_offset[jp];
+          TacsDeviceGemm(0, bj, bi, bi, 1.0, &d_Lvals[np], bj, d_diag, bi, 0.0,
+                         d_temp_block, bj);
+          TacsDeviceCopyAsync(0, &d_Lvals[np], d_temp_block,
+                              bi * bj * sizeof(TacsScalar));
+          n_gemm++;
+          TacsAddFlops(2 * bi * bi * bj);
+        }
+      }
+    }
+
+    // Set the L values to the row processes that need it
+    MPI_Request L_recv_request;
+    int source_proc_column = get_proc_column(i);
+    if (source_proc_column == proc_col) {
+      // Copy the values of L to the host and send them
+      int offset = lval_offset[Lcolp[i]];
+      if (npcols > 1) {
+        TacsDeviceCopyAsync(0, &Lvals[offset], &d_Lvals[offset],
+                            lbuff_size * sizeof(TacsScalar));
+        TacsDeviceStreamSynchronize(0);
+      }
+      for (int p = 0, k = 0; p < npcols; p++) {
+        int dest = proc_grid[p + proc_row * npcols];
+        if (rank != dest) {
+          int tag = 2 * i + 1;
+          MPI_Isend(&Lvals[offset], lbuff_size, TACS_MPI_TYPE, dest, tag, comm,
+                    &L_send_request[k]);
+          TACSCommProfiler::addSend(TACS_COMM_DENSE_FACTOR, dest,
+                                    lbuff_size * sizeof(TacsScalar));
+          k++;
+        }
+      }
+    } else {
+      // The receiving processes
+      int source = proc_grid[source_proc_column + proc_row * npcols];
+      int tag = 2 * i + 1;
+      MPI_Irecv(Lbuff, lbuff_size, TACS_MPI_TYPE, source, tag, comm,
+                &L_recv_request);
+      TACSCommProfiler::addRecv(TACS_COMM_DENSE_FACTOR, source,
+                                lbuff_size * sizeof(TacsScalar));
+    }
+
+    if (monitor_factor) {
+      t_send_wait -= MPI_Wtime();
+    }
+
+    // Wait for the remaining sends to complete
+    double t_wait = TACSCommProfiler::beginWait();
+    if (source_proc_row == proc_row) {
+      MPI_Waitall(nprows - 1, U_send_request, U_send_status);
+    }
+    if (source_proc_column == proc_col) {
+      MPI_Waitall(npcols - 1, L_send_request, L_send_status);
+    }
+
+    if (monitor_factor) {
+      t_send_wait += MPI_Wtime();
+      t_recv_wait -= MPI_Wtime();
+    }
+
+    // Wait for the receive to complete and copy the values to the
+    // device. The buffers from two steps ago are free since the
+    // update on stream 1 that used them was complete before stream 0
+    // was synchronized at the start of this step.
+    TacsScalar *d_L = &d_Lvals[lval_offset[Lcolp[i]]];
+    if (source_proc_column != proc_col) {
+      MPI_Status L_recv_status;
+      MPI_Wait(&L_recv_request, &L_recv_status);
+      d_L = d_Lbuff[i % 2];
+      TacsDeviceCopyAsync(0, d_L, Lbuff, lbuff_size * sizeof(TacsScalar));
+    }
+    TacsScalar *d_U = &d_Uvals[uval_offset[Urowp[i]]];
+    if (source_proc_row != proc_row) {
+      MPI_Status U_recv_status;
+      MPI_Wait(&U_recv_request, &U_recv_status);
+      d_U = d_Ubuff[i % 2];
+      TacsDeviceCopyAsync(0, d_U, Ubuff, ubuff_size * sizeof(TacsScalar));
+    }
+    TACSCommProfiler::endWait(TACS_COMM_DENSE_FACTOR, t_wait);
+
+    if (monitor_factor) {
+      t_recv_wait += MPI_Wtime();
+    }
+
+    // The update on stream 1 requires L and U, while the update to
+    // row and column i+1 on stream 0 must follow the previous update
+    TacsDeviceStreamWait(1, 0);
+    TacsDeviceStreamWait(0, 1);
+
+    // Compute the bi-rank update to the remainder of the matrix
+    // A[i+1:n,i+1:n] = A[i+1:n,i+1:n] - L[i:n,i]*U[i,i:n]
+    TacsScalar *L = d_L;
+    for (int iip = Lcolp[i]; iip < Lcolp[i + 1]; iip++) {
+      // Skip rows not locally owned
+      int ii = Lrows[iip];
+      int bii = bptr[ii + 1] - bptr[ii];
+      if (get_proc_row(ii) != proc_row) {
+        continue;
+      }
+
+      TacsScalar *U = d_U;
+      for (int jjp = Urowp[i]; jjp < Urowp[i + 1]; jjp++) {
+        // Skip columns not locally owned
+        int jj = Ucols[jjp];
+        int bjj = bptr[jj + 1] - bptr[jj];
+        if (get_proc_column(jj) != proc_col) {
+          continue;
+        }
+
+        TacsScalar *A = get_block(rank, ii, jj);
+
+        if (A) {
+          // Queue the blocks required for the next panel first
+          int stream = (ii == i + 1 || jj == i + 1) ? 0 : 1;
+          TacsDeviceGemm(stream, bii, bjj, bi, -1.0, L, bii, U, bi, 1.0,
+                         get_device_block(A), bii);
+          n_gemm++;
+          TacsAddFlops(2 * bii * bjj * bi);
+        }
+
+        U += bi * bjj;
+      }
+
+      L += bi * bii;
+    }
+  }
+
+  // Wait for the remaining updates and copy the factor to the host
+  TacsDeviceStreamSynchronize(0);
+  TacsDeviceStreamSynchronize(1);
+  TacsDeviceCopyToHost(Dvals, d_Dvals, dval_size * sizeof(TacsScalar));
+  TacsDeviceCopyToHost(Lvals, d_Lvals, lval_size * sizeof(TacsScalar));
+  TacsDeviceCopyToHost(Uvals, d_Uvals, uval_size * sizeof(TacsScalar));
+
+  if (monitor_factor) {
+    printf("[%d] Number of GEMM updates: %d\n", rank, n_gemm);
+    printf("[%d] Panel wait time:  %15.8f\n", rank, t_panel);
+    printf("[%d] Recv wait time:   %15.8f\n", rank, t_recv_wait);
+    printf("[%d] Send wait time:   %15.8f\n", rank, t_send_wait);
+  }
+
+  delete[] temp_piv;
+  delete[] temp_diag;
+  delete[] work;
+
+  // Release memory for the data transfer
+  delete[] Ubuff;
+  delete[] Lbuff;
+
+  delete[] U_send_request;
+  delete[] L_send_request;
+  delete[] U_send_status;
+  delete[] L_send_status;
+}
@@ -63,6 +63,24 @@
   the matrix. As a result, the factorization is done in place, using
   the existing non-zero pattern.
 
+  The block structure can either consist of a fixed number of CSR
+  blocks per block, or be set from a supernodal partition of the
+  nodes. In the latter case, the nodes are first ordered with a
+  fill-reducing ordering (approximate minimum degree or nested
+  dissection) followed by a postorder of the elimination
+  tree. Consecutive nodes whose columns in the factor share the same
+  non-zero pattern are then grouped into a single block, so that the
+  blocks stored in the factor are dense and the zero blocks are
+  never formed. This ordering is computed with computeSupernodes().
+
+  The factorization can also be performed with the device backend
+  (see TACSDevice.h) by calling setDeviceFactorFlag(). The trailing
+  matrix updates are then computed on the device, while the inverse
+  of the diagonal blocks and the communication remain on the host.
+  The updates to the next row and column of blocks are queued on a
+  separate stream from the remaining updates, so that the host can
+  factor the next panel while the rest of the update is computed.
+
   The main requirements for the code are:
 
   1. Initialize the non-zero pattern from the distributed contributions
@@ -80,6 +98,12 @@ class TACSBlockCyclicMat : public TACSObject {
                      const int *csr_cols, int csr_blocks_per_block,
                      int reorder_blocks, int max_grid_size = -1);
 
+  // Create a sparse matrix with variable-size (supernodal) blocks
+  TACSBlockCyclicMat(MPI_Comm _comm, int csr_m, int csr_bsize,
+                     const int *csr_vars, int nvars, const int *csr_rowp,
+                     const int *csr_cols, int num_blocks,
+                     const int *csr_block_ptr, int max_grid_size = -1);
+
   // Create a dense matrix
   TACSBlockCyclicMat(MPI_Comm _comm, int _nrows, int _ncols);
   ~TACSBlockCyclicMat();
@@ -89,7 +113,17 @@ class TACSBlockCyclicMat : public TACSObject {
   void getSize(int *nr, int *nc);
   void getProcessGridSize(int *_nprows, int *_npcols);
   void setMonitorFactorFlag(int flag);
+  void setDeviceFactorFlag(int flag);
   int getLocalVecSize() { return xbptr[nrows]; }
+  size_t getNumLocalEntries() {
+    return (size_t)dval_size + uval_size + lval_size;
+  }
+
+  // Compute a fill-reducing supernodal ordering of a nodal pattern
+  // ---------------------------------------------------------------
+  static void computeSupernodes(int n, const int *rowp, const int *cols,
+                                int max_size, int *perm, int *num_snodes,
+                                int *snode_ptr, int use_nd = 0);
 
   // Get block pointers to the columns
   // ---------------------------------
@@ -133,6 +167,7 @@ class TACSBlockCyclicMat : public TACSObject {
   void mult(TacsScalar *x, TacsScalar *y);
   void applyFactor(TacsScalar *x);
   void factor();
+  void getInertia(int *nneg, int *npos);
 
   // Given the i/j location within the matrix, determine the owner
   // -------------------------------------------------------------
@@ -144,12 +179,17 @@ class TACSBlockCyclicMat : public TACSObject {
 
  private:
   void init_proc_grid(int size);
+  void init_sparse(int csr_bsize, const int *csr_vars, int csr_nvars,
+                   const int *csr_rowp, const int *csr_cols,
+                   int reorder_blocks);
   void init_nz_arrays();
   void init_row_counts();
   void merge_nz_pattern(int root, int *rowp, int *cols, int reorder_blocks);
   void compute_symbolic_factor(int **_rowp, int **_cols, int max_size);
   void init_ptr_arrays(int *rowp, int *cols);
   int get_block_num(int var, const int *ptr);
+  void factor_device();
+  TacsScalar *get_device_block(TacsScalar *A);
   int add_values(int rank, int i, int j, int csr_bsize, int csr_i, int csr_j,
                  TacsScalar *b);
 
@@ -238,6 +278,7 @@ class TACSBlockCyclicMat : public TACSObject {
   TacsScalar *Dvals, *Lvals, *Uvals;
   int *dval_offset, *lval_offset, *uval_offset;
   int dval_size, uval_size, lval_size;
+  size_t mem_bytes;  // The memory recorded for the values
 
   // Store information about the size of the buffers required for the
   // factorization.
@@ -250,6 +291,11 @@ class TACSBlockCyclicMat : public TACSObject {
   // Monitor the time spent in the factorization process
   int monitor_factor;
 
+  // Device copies of the factor used when use_device is set
+  int use_device;
+  TacsScalar *d_Dvals, *d_Lvals, *d_Uvals;
+  TacsScalar *d_work;  // Device buffers for the diagonal and L/U
+
   // Store information about the back-solve
   int lower_block_count, upper_block_count;
   int *lower_row_sum_count, *lower_row_sum_recv;
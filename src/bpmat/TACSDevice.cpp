@@ -0,0 +1,221 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSDevice.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tacslapack.h"
+
+/*
+  The host implementation of the device backend.
+
+  This is used when TACS is compiled without CUDA or HIP. The device
+  arrays are ordinary host arrays, so every operation is performed
+  directly on the host. The GPU implementations are in
+  TACSDeviceKernels.cu.
+*/
+#if !defined(TACS_USE_CUDA) && !defined(TACS_USE_HIP)
+
+const char *TacsDeviceGetName() { return "host"; }
+
+void *TacsDeviceMalloc(size_t bytes) { return malloc(bytes > 0 ? bytes : 1); }
+
+void TacsDeviceFree(void *ptr) { free(ptr); }
+
+void TacsDeviceMemset(void *ptr, size_t bytes) { memset(ptr, 0, bytes); }
+
+void TacsDeviceCopyToDevice(void *dest, const void *src, size_t bytes) {
+  memcpy(dest, src, bytes);
+}
+
+void TacsDeviceCopyToHost(void *dest, const void *src, size_t bytes) {
+  memcpy(dest, src, bytes);
+}
+
+void TacsDeviceCopy(void *dest, const void *src, size_t bytes) {
+  memmove(dest, src, bytes);
+}
+
+void TacsDeviceSynchronize() {}
+
+void TacsDeviceScale(int n, TacsScalar alpha, TacsScalar *x) {
+  for (int i = 0; i < n; i++) {
+    x[i] *= alpha;
+  }
+}
+
+void TacsDeviceAxpy(int n, TacsScalar alpha, const TacsScalar *x,
+                    TacsScalar *y) {
+  for (int i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+void TacsDeviceAxpby(int n, TacsScalar alpha, TacsScalar beta,
+                     const TacsScalar *x, TacsScalar *y) {
+  for (int i = 0; i < n; i++) {
+    y[i] = beta * y[i] + alpha * x[i];
+  }
+}
+
+TacsScalar TacsDeviceDot(int n, const TacsScalar *x, const TacsScalar *y) {
+  TacsScalar sum = 0.0;
+  for (int i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+void TacsDeviceMdot(int n, int m, const TacsScalar *const *x,
+                    const TacsScalar *y, TacsScalar *ans) {
+  for (int k = 0; k < m; k++) {
+    ans[k] = TacsDeviceDot(n, x[k], y);
+  }
+}
+
+void TacsDeviceGatherVars(int bsize, int nvars, const int *vars, int lower,
+                          const TacsScalar *x, TacsScalar *y) {
+  for (int i = 0; i < nvars; i++) {
+    const TacsScalar *xv = &x[bsize * (vars[i] - lower)];
+    for (int k = 0; k < bsize; k++) {
+      y[bsize * i + k] = xv[k];
+    }
+  }
+}
+
+void TacsDeviceBCSRMultAdd(int bsize, int nrows, const int *rowp,
+                           const int *cols, const TacsScalar *A,
+                           const TacsScalar *x, const TacsScalar *z,
+                           TacsScalar *y) {
+  const int b2 = bsize * bsize;
+  for (int i = 0; i < nrows; i++) {
+    TacsScalar *yi = &y[bsize * i];
+    for (int m = 0; m < bsize; m++) {
+      yi[m] = (z ? z[bsize * i + m] : 0.0);
+    }
+
+    for (int k = rowp[i]; k < rowp[i + 1]; k++) {
+      const TacsScalar *a = &A[b2 * k];
+      const TacsScalar *xj = &x[bsize * cols[k]];
+      for (int m = 0; m < bsize; m++) {
+        TacsScalar t = 0.0;
+        for (int n = 0; n < bsize; n++) {
+          t += a[bsize * m + n] * xj[n];
+        }
+        yi[m] += t;
+      }
+    }
+  }
+}
+
+void TacsDeviceScatterAddVars(int bsize, int nvars, const int *vars,
+                              int lower, const TacsScalar *x, TacsScalar *y) {
+  for (int i = 0; i < nvars; i++) {
+    if (vars[i] >= 0) {
+      TacsScalar *yv = &y[bsize * (vars[i] - lower)];
+      for (int k = 0; k < bsize; k++) {
+        yv[k] += x[bsize * i + k];
+      }
+    }
+  }
+}
+
+void TacsDeviceSetEntries(int n, const int *index, TacsScalar value,
+                          TacsScalar *x) {
+  for (int i = 0; i < n; i++) {
+    x[index[i]] = value;
+  }
+}
+
+/*
+  Add a single block to the block array selected by the encoded plan
+  entry
+*/
+static inline void TacsDeviceAddBlock(int bsize, int loc, int ldv,
+                                      const TacsScalar *v, TacsScalar *A,
+                                      TacsScalar *B, TacsScalar *ext) {
+  const int b2 = bsize * bsize;
+  TacsScalar *data[3] = {A, B, ext};
+  TacsScalar *a = &data[loc % 3][b2 * (loc / 3)];
+  for (int ii = 0; ii < bsize; ii++) {
+    for (int jj = 0; jj < bsize; jj++) {
+      a[ii * bsize + jj] += v[ldv * ii + jj];
+    }
+  }
+}
+
+void TacsDeviceAddElementMatrices(int bsize, int nnodes, int nelems,
+                                  const int *elems, const int *ptr,
+                                  const int *plan, const TacsScalar *values,
+                                  TacsScalar *A, TacsScalar *B,
+                                  TacsScalar *ext) {
+  const int mv = bsize * nnodes;
+  for (int i = 0; i < nelems; i++) {
+    int elem = elems[i];
+    if (ptr[elem + 1] == ptr[elem]) {
+      continue;
+    }
+    const int *p = &plan[ptr[elem]];
+    const TacsScalar *mat = &values[(size_t)mv * mv * i];
+    for (int ii = 0; ii < nnodes; ii++) {
+      for (int jj = 0; jj < nnodes; jj++, p++) {
+        if (p[0] >= 0) {
+          TacsDeviceAddBlock(bsize, p[0], mv,
+                             &mat[mv * bsize * ii + bsize * jj], A, B, ext);
+        }
+      }
+    }
+  }
+}
+
+void TacsDeviceAddBlocks(int bsize, int nblocks, const int *plan,
+                         const TacsScalar *values, TacsScalar *A,
+                         TacsScalar *B) {
+  const int b2 = bsize * bsize;
+  for (int i = 0; i < nblocks; i++) {
+    if (plan[i] >= 0) {
+      TacsDeviceAddBlock(bsize, plan[i], bsize, &values[b2 * i], A, B, NULL);
+    }
+  }
+}
+
+/*
+  The operations are performed immediately on the host, so the
+  streams require no synchronization
+*/
+void TacsDeviceCopyAsync(int stream, void *dest, const void *src,
+                         size_t bytes) {
+  memmove(dest, src, bytes);
+}
+
+void TacsDeviceStreamWait(int stream, int other) {}
+
+void TacsDeviceStreamSynchronize(int stream) {}
+
+void TacsDeviceGemm(int stream, int m, int n, int k, TacsScalar alpha,
+                    const TacsScalar *A, int lda, const TacsScalar *B,
+                    int ldb, TacsScalar beta, TacsScalar *C, int ldc) {
+  if (m > 0 && n > 0 && k > 0) {
+    BLASgemm("N", "N", &m, &n, &k, &alpha, (TacsScalar *)A, &lda,
+             (TacsScalar *)B, &ldb, &beta, C, &ldc);
+  }
+}
+
+#endif  // !TACS_USE_CUDA && !TACS_USE_HIP
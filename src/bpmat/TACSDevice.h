@@ -0,0 +1,155 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_DEVICE_H
+#define TACS_DEVICE_H
+
+/*
+  The device backend used by the device-resident vectors and matrices.
+
+  The backend is selected at compile time:
+
+  TACS_USE_CUDA: The kernels in TACSDeviceKernels.cu are compiled with
+  nvcc and the arrays are allocated in the GPU memory.
+
+  TACS_USE_HIP: The same kernels are compiled with hipcc.
+
+  Otherwise, the kernels in TACSDevice.cpp are used and the "device"
+  arrays are allocated in the host memory. This makes it possible to
+  use and test the device code paths on machines without a GPU.
+
+  When TACS_USE_GPU_AWARE_MPI is defined, device arrays are passed
+  directly to MPI. Otherwise the data is copied through host buffers
+  before and after each transfer.
+
+  All pointers to arrays passed to the kernels must be device arrays,
+  unless stated otherwise. The reductions return their result on the
+  host. The device backends only support real scalars.
+*/
+
+#include "TACSObject.h"
+
+#if (defined(TACS_USE_CUDA) || defined(TACS_USE_HIP)) && \
+    defined(TACS_USE_COMPLEX)
+#error "The TACS device backend does not support complex scalars"
+#endif
+
+// Get the name of the backend
+const char *TacsDeviceGetName();
+
+// Allocate, free and copy device memory
+// -------------------------------------
+void *TacsDeviceMalloc(size_t bytes);
+void TacsDeviceFree(void *ptr);
+void TacsDeviceMemset(void *ptr, size_t bytes);
+void TacsDeviceCopyToDevice(void *dest, const void *src, size_t bytes);
+void TacsDeviceCopyToHost(void *dest, const void *src, size_t bytes);
+void TacsDeviceCopy(void *dest, const void *src, size_t bytes);
+void TacsDeviceSynchronize();
+
+// Vector operations on arrays of length n
+// ---------------------------------------
+void TacsDeviceScale(int n, TacsScalar alpha, TacsScalar *x);
+void TacsDeviceAxpy(int n, TacsScalar alpha, const TacsScalar *x,
+                    TacsScalar *y);
+void TacsDeviceAxpby(int n, TacsScalar alpha, TacsScalar beta,
+                     const TacsScalar *x, TacsScalar *y);
+TacsScalar TacsDeviceDot(int n, const TacsScalar *x, const TacsScalar *y);
+
+// Compute ans[k] = x[k]^{T} y for k = 0,...,m-1 where x is a host
+// array of device pointers and ans is a host array
+void TacsDeviceMdot(int n, int m, const TacsScalar *const *x,
+                    const TacsScalar *y, TacsScalar *ans);
+
+// Compute y[i] = x[bsize*(vars[i] - lower) + k] for each block entry
+// ------------------------------------------------------------------
+void TacsDeviceGatherVars(int bsize, int nvars, const int *vars, int lower,
+                          const TacsScalar *x, TacsScalar *y);
+
+// Compute y = A*x + z for a block CSR matrix. The matrix arrays rowp,
+// cols and A are device arrays using the BCSRMatData layout. When z
+// is NULL, y = A*x.
+// -------------------------------------------------------------------
+void TacsDeviceBCSRMultAdd(int bsize, int nrows, const int *rowp,
+                           const int *cols, const TacsScalar *A,
+                           const TacsScalar *x, const TacsScalar *z,
+                           TacsScalar *y);
+
+// Compute y[bsize*(vars[i] - lower) + k] += x[bsize*i + k] for each
+// block entry. Entries with vars[i] < 0 are skipped. The same entry
+// of y may appear more than once in vars.
+// -----------------------------------------------------------------
+void TacsDeviceScatterAddVars(int bsize, int nvars, const int *vars,
+                              int lower, const TacsScalar *x, TacsScalar *y);
+
+// Set x[index[i]] = value for i = 0,...,n-1
+// ------------------------------------------
+void TacsDeviceSetEntries(int n, const int *index, TacsScalar value,
+                          TacsScalar *x);
+
+// Add a batch of dense element matrices to block matrices using an
+// element scatter plan from TACSMatDistribute. Each plan entry is
+// encoded as 3*(block index) + target, where the target 0, 1 or 2
+// selects the block array A, B or ext, and negative entries are
+// skipped. The matrix for element i of the batch starts at
+// values[i*mv*mv], where mv = bsize*nnodes, and is added with the
+// plan that starts at plan[ptr[elems[i]]]. Elements without a plan,
+// where ptr[elems[i]+1] == ptr[elems[i]], are skipped.
+// ------------------------------------------------------------------
+void TacsDeviceAddElementMatrices(int bsize, int nnodes, int nelems,
+                                  const int *elems, const int *ptr,
+                                  const int *plan, const TacsScalar *values,
+                                  TacsScalar *A, TacsScalar *B,
+                                  TacsScalar *ext);
+
+// Add the blocks values[b2*i] for i = 0,...,nblocks-1 to the block
+// arrays A and B using a plan with the same encoding as above
+// -----------------------------------------------------------------
+void TacsDeviceAddBlocks(int bsize, int nblocks, const int *plan,
+                         const TacsScalar *values, TacsScalar *A,
+                         TacsScalar *B);
+
+// Streams for asynchronous dense operations
+// ------------------------------------------
+// The dense operations below are queued on one of
+// TACS_DEVICE_NUM_STREAMS streams and may run concurrently with the
+// host. Operations on the same stream are performed in order. The
+// host arrays passed to the asynchronous copies must not be modified
+// until the stream has been synchronized.
+static const int TACS_DEVICE_NUM_STREAMS = 2;
+
+// Copy bytes between any combination of host and device arrays
+void TacsDeviceCopyAsync(int stream, void *dest, const void *src,
+                         size_t bytes);
+
+// Make all later work on stream wait until the work currently queued
+// on the other stream is complete, without blocking the host
+void TacsDeviceStreamWait(int stream, int other);
+
+// Block the host until all work queued on the stream is complete
+void TacsDeviceStreamSynchronize(int stream);
+
+// Compute C = alpha*A*B + beta*C where A is m x k, B is k x n and C is
+// m x n. All matrices are stored in column-major order with the given
+// leading dimensions. This uses cuBLAS or hipBLAS on the GPU.
+// -------------------------------------------------------------------
+void TacsDeviceGemm(int stream, int m, int n, int k, TacsScalar alpha,
+                    const TacsScalar *A, int lda, const TacsScalar *B,
+                    int ldb, TacsScalar beta, TacsScalar *C, int ldc);
+
+#endif  // TACS_DEVICE_H
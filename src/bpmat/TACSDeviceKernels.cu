@@ -0,0 +1,509 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+/*
+  The CUDA and HIP implementations of the device backend.
+
+  This file is compiled with nvcc when TACS_USE_CUDA is defined, or
+  with hipcc when TACS_USE_HIP is defined. The HIP runtime functions
+  are mapped to the CUDA names below so that the kernels are shared.
+  All kernels are launched on the default stream, so the operations
+  are ordered and the copies to the host are synchronous. The dense
+  operations use separate streams and cuBLAS or hipBLAS. These
+  streams are created as blocking streams, so work on the default
+  stream also waits for them. The
+  assembly kernels use atomicAdd() on double values, which requires a
+  device with compute capability 6.0 or higher.
+*/
+
+#include <stdio.h>
+
+#include "TACSDevice.h"
+
+#if defined(TACS_USE_HIP)
+#include <hip/hip_runtime.h>
+#include <hipblas/hipblas.h>
+#define cudaError_t hipError_t
+#define cudaSuccess hipSuccess
+#define cudaGetErrorString hipGetErrorString
+#define cudaMalloc hipMalloc
+#define cudaFree hipFree
+#define cudaMemset hipMemset
+#define cudaMemcpy hipMemcpy
+#define cudaMemcpyHostToDevice hipMemcpyHostToDevice
+#define cudaMemcpyDeviceToHost hipMemcpyDeviceToHost
+#define cudaMemcpyDeviceToDevice hipMemcpyDeviceToDevice
+#define cudaDeviceSynchronize hipDeviceSynchronize
+#define cudaGetLastError hipGetLastError
+#define cudaStream_t hipStream_t
+#define cudaStreamCreate hipStreamCreate
+#define cudaStreamSynchronize hipStreamSynchronize
+#define cudaStreamWaitEvent hipStreamWaitEvent
+#define cudaEvent_t hipEvent_t
+#define cudaEventCreateWithFlags hipEventCreateWithFlags
+#define cudaEventDisableTiming hipEventDisableTiming
+#define cudaEventRecord hipEventRecord
+#define cudaMemcpyAsync hipMemcpyAsync
+#define cudaMemcpyDefault hipMemcpyDefault
+#define cublasHandle_t hipblasHandle_t
+#define cublasStatus_t hipblasStatus_t
+#define cublasCreate hipblasCreate
+#define cublasSetStream hipblasSetStream
+#define cublasDgemm hipblasDgemm
+#define CUBLAS_OP_N HIPBLAS_OP_N
+#define CUBLAS_STATUS_SUCCESS HIPBLAS_STATUS_SUCCESS
+#else
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+#endif
+
+// The number of threads in each block and the maximum number of
+// blocks used for the reductions
+static const int TACS_DEVICE_BLOCK_SIZE = 256;
+static const int TACS_DEVICE_MAX_BLOCKS = 1024;
+
+/*
+  Check the return code from the runtime
+*/
+static void TacsDeviceCheck(cudaError_t err, const char *name) {
+  if (err != cudaSuccess) {
+    fprintf(stderr, "TACSDevice error: %s failed with %s\n", name,
+            cudaGetErrorString(err));
+  }
+}
+
+/*
+  Get the number of blocks needed for n entries
+*/
+static int TacsDeviceNumBlocks(int n) {
+  int nblocks = (n + TACS_DEVICE_BLOCK_SIZE - 1) / TACS_DEVICE_BLOCK_SIZE;
+  return (nblocks < 1 ? 1 : nblocks);
+}
+
+#if defined(TACS_USE_HIP)
+const char *TacsDeviceGetName() { return "HIP"; }
+#else
+const char *TacsDeviceGetName() { return "CUDA"; }
+#endif
+
+void *TacsDeviceMalloc(size_t bytes) {
+  void *ptr = NULL;
+  TacsDeviceCheck(cudaMalloc(&ptr, bytes > 0 ? bytes : 1), "cudaMalloc");
+  return ptr;
+}
+
+void TacsDeviceFree(void *ptr) {
+  if (ptr) {
+    TacsDeviceCheck(cudaFree(ptr), "cudaFree");
+  }
+}
+
+void TacsDeviceMemset(void *ptr, size_t bytes) {
+  TacsDeviceCheck(cudaMemset(ptr, 0, bytes), "cudaMemset");
+}
+
+void TacsDeviceCopyToDevice(void *dest, const void *src, size_t bytes) {
+  TacsDeviceCheck(cudaMemcpy(dest, src, bytes, cudaMemcpyHostToDevice),
+                  "cudaMemcpy");
+}
+
+void TacsDeviceCopyToHost(void *dest, const void *src, size_t bytes) {
+  TacsDeviceCheck(cudaMemcpy(dest, src, bytes, cudaMemcpyDeviceToHost),
+                  "cudaMemcpy");
+}
+
+void TacsDeviceCopy(void *dest, const void *src, size_t bytes) {
+  TacsDeviceCheck(cudaMemcpy(dest, src, bytes, cudaMemcpyDeviceToDevice),
+                  "cudaMemcpy");
+}
+
+void TacsDeviceSynchronize() {
+  TacsDeviceCheck(cudaDeviceSynchronize(), "cudaDeviceSynchronize");
+}
+
+__global__ void TacsDeviceScaleKernel(int n, double alpha, double *x) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    x[i] *= alpha;
+  }
+}
+
+__global__ void TacsDeviceAxpbyKernel(int n, double alpha, double beta,
+                                      const double *x, double *y) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    y[i] = beta * y[i] + alpha * x[i];
+  }
+}
+
+/*
+  Compute the partial sums of x[k]^{T} y for each block. The vector
+  index k is given by blockIdx.y and the partial sums are stored in
+  sums[k*gridDim.x + blockIdx.x].
+*/
+__global__ void TacsDeviceMdotKernel(int n, const double *const *x,
+                                     const double *y, double *sums) {
+  __shared__ double s[TACS_DEVICE_BLOCK_SIZE];
+  const double *xk = x[blockIdx.y];
+
+  double t = 0.0;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    t += xk[i] * y[i];
+  }
+  s[threadIdx.x] = t;
+  __syncthreads();
+
+  for (int stride = blockDim.x / 2; stride > 0; stride /= 2) {
+    if (threadIdx.x < stride) {
+      s[threadIdx.x] += s[threadIdx.x + stride];
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    sums[blockIdx.y * gridDim.x + blockIdx.x] = s[0];
+  }
+}
+
+__global__ void TacsDeviceGatherKernel(int bsize, int nvars, const int *vars,
+                                       int lower, const double *x,
+                                       double *y) {
+  int n = bsize * nvars;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    int v = i / bsize;
+    int k = i - bsize * v;
+    y[i] = x[bsize * (vars[v] - lower) + k];
+  }
+}
+
+/*
+  Compute the block CSR product with one thread for each scalar row.
+  The block size is a compile-time constant, except when N = 0.
+*/
+template <int N>
+__global__ void TacsDeviceBCSRMultAddKernel(int bs, int nrows, const int *rowp,
+                                            const int *cols, const double *A,
+                                            const double *x, const double *z,
+                                            double *y) {
+  const int bsize = (N > 0 ? N : bs);
+  const int b2 = bsize * bsize;
+  int n = bsize * nrows;
+  for (int r = blockIdx.x * blockDim.x + threadIdx.x; r < n;
+       r += blockDim.x * gridDim.x) {
+    int i = r / bsize;
+    int m = r - bsize * i;
+
+    double t = (z ? z[r] : 0.0);
+    for (int k = rowp[i]; k < rowp[i + 1]; k++) {
+      const double *a = &A[b2 * k + bsize * m];
+      const double *xj = &x[bsize * cols[k]];
+      for (int j = 0; j < bsize; j++) {
+        t += a[j] * xj[j];
+      }
+    }
+    y[r] = t;
+  }
+}
+
+__global__ void TacsDeviceScatterAddKernel(int bsize, int nvars,
+                                           const int *vars, int lower,
+                                           const double *x, double *y) {
+  int n = bsize * nvars;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    int v = i / bsize;
+    int k = i - bsize * v;
+    if (vars[v] >= 0) {
+      atomicAdd(&y[bsize * (vars[v] - lower) + k], x[i]);
+    }
+  }
+}
+
+__global__ void TacsDeviceSetEntriesKernel(int n, const int *index,
+                                           double value, double *x) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    x[index[i]] = value;
+  }
+}
+
+/*
+  Add the element matrices with one thread for each scalar entry. The
+  entries of different elements may be added to the same location, so
+  the additions are atomic.
+*/
+__global__ void TacsDeviceAddElementMatricesKernel(
+    int bsize, int nnodes, int nelems, const int *elems, const int *ptr,
+    const int *plan, const double *values, double *A, double *B,
+    double *ext) {
+  const int mv = bsize * nnodes;
+  const int b2 = bsize * bsize;
+  const long n = (long)nelems * mv * mv;
+  for (long r = blockIdx.x * blockDim.x + threadIdx.x; r < n;
+       r += blockDim.x * gridDim.x) {
+    int e = r / (mv * mv);
+    int elem = elems[e];
+    if (ptr[elem + 1] == ptr[elem]) {
+      continue;
+    }
+
+    int entry = r - (long)e * mv * mv;
+    int row = entry / mv;
+    int col = entry - mv * row;
+    int i = row / bsize, ii = row - bsize * i;
+    int j = col / bsize, jj = col - bsize * j;
+
+    int loc = plan[ptr[elem] + nnodes * i + j];
+    if (loc >= 0) {
+      double *data = (loc % 3 == 0 ? A : (loc % 3 == 1 ? B : ext));
+      atomicAdd(&data[b2 * (loc / 3) + bsize * ii + jj], values[r]);
+    }
+  }
+}
+
+/*
+  Add the blocks with one thread for each scalar entry. Each block has
+  a unique location, so no atomic operations are required.
+*/
+__global__ void TacsDeviceAddBlocksKernel(int bsize, int nblocks,
+                                          const int *plan,
+                                          const double *values, double *A,
+                                          double *B) {
+  const int b2 = bsize * bsize;
+  const int n = b2 * nblocks;
+  for (int r = blockIdx.x * blockDim.x + threadIdx.x; r < n;
+       r += blockDim.x * gridDim.x) {
+    int i = r / b2;
+    int loc = plan[i];
+    if (loc >= 0) {
+      double *data = (loc % 3 == 0 ? A : B);
+      data[b2 * (loc / 3) + r - b2 * i] += values[r];
+    }
+  }
+}
+
+void TacsDeviceScale(int n, TacsScalar alpha, TacsScalar *x) {
+  TacsDeviceScaleKernel<<<TacsDeviceNumBlocks(n), TACS_DEVICE_BLOCK_SIZE>>>(
+      n, alpha, x);
+  TacsDeviceCheck(cudaGetLastError(), "TacsDeviceScale");
+}
+
+void TacsDeviceAxpy(int n, TacsScalar alpha, const TacsScalar *x,
+                    TacsScalar *y) {
+  TacsDeviceAxpbyKernel<<<TacsDeviceNumBlocks(n), TACS_DEVICE_BLOCK_SIZE>>>(
+      n, alpha, 1.0, x, y);
+  TacsDeviceCheck(cudaGetLastError(), "TacsDeviceAxpy");
+}
+
+void TacsDeviceAxpby(int n, TacsScalar alpha, TacsScalar beta,
+                     const TacsScalar *x, TacsScalar *y) {
+  TacsDeviceAxpbyKernel<<<TacsDeviceNumBlocks(n), TACS_DEVICE_BLOCK_SIZE>>>(
+      n, alpha, beta, x, y);
+  TacsDeviceCheck(cudaGetLastError(), "TacsDeviceAxpby");
+}
+
+TacsScalar TacsDeviceDot(int n, const TacsScalar *x, const TacsScalar *y) {
+  TacsScalar ans;
+  TacsDeviceMdot(n, 1, &x, y, &ans);
+  return ans;
+}
+
+/*
+  The partial sums from each block are copied to the host and summed
+  there, so the result does not depend on the order of atomic updates
+*/
+void TacsDeviceMdot(int n, int m, const TacsScalar *const *x,
+                    const TacsScalar *y, TacsScalar *ans) {
+  if (m <= 0) {
+    return;
+  }
+
+  int nblocks = TacsDeviceNumBlocks(n);
+  if (nblocks > TACS_DEVICE_MAX_BLOCKS) {
+    nblocks = TACS_DEVICE_MAX_BLOCKS;
+  }
+
+  // Copy the array of vector pointers to the device
+  double **xd = (double **)TacsDeviceMalloc(m * sizeof(double *));
+  TacsDeviceCopyToDevice(xd, x, m * sizeof(double *));
+  double *sums = (double *)TacsDeviceMalloc(m * nblocks * sizeof(double));
+
+  dim3 grid(nblocks, m);
+  TacsDeviceMdotKernel<<<grid, TACS_DEVICE_BLOCK_SIZE>>>(n, xd, y, sums);
+  TacsDeviceCheck(cudaGetLastError(), "TacsDeviceMdot");
+
+  double *s = new double[m * nblocks];
+  TacsDeviceCopyToHost(s, sums, m * nblocks * sizeof(double));
+  for (int k = 0; k < m; k++) {
+    ans[k] = 0.0;
+    for (int j = 0; j < nblocks; j++) {
+      ans[k] += s[k * nblocks + j];
+    }
+  }
+
+  delete[] s;
+  TacsDeviceFree(sums);
+  TacsDeviceFree(xd);
+}
+
+void TacsDeviceGatherVars(int bsize, int nvars, const int *vars, int lower,
+                          const TacsScalar *x, TacsScalar *y) {
+  int n = bsize * nvars;
+  if (n > 0) {
+    TacsDeviceGatherKernel<<<TacsDeviceNumBlocks(n), TACS_DEVICE_BLOCK_SIZE>>>(
+        bsize, nvars, vars, lower, x, y);
+    TacsDeviceCheck(cudaGetLastError(), "TacsDeviceGatherVars");
+  }
+}
+
+void TacsDeviceBCSRMultAdd(int bsize, int nrows, const int *rowp,
+                           const int *cols, const TacsScalar *A,
+                           const TacsScalar *x, const TacsScalar *z,
+                           TacsScalar *y) {
+  int n = bsize * nrows;
+  if (n <= 0) {
+    return;
+  }
+
+  int nblocks = TacsDeviceNumBlocks(n);
+  if (bsize == 6) {
+    TacsDeviceBCSRMultAddKernel<6><<<nblocks, TACS_DEVICE_BLOCK_SIZE>>>(
+        bsize, nrows, rowp, cols, A, x, z, y);
+  } else if (bsize == 3) {
+    TacsDeviceBCSRMultAddKernel<3><<<nblocks, TACS_DEVICE_BLOCK_SIZE>>>(
+        bsize, nrows, rowp, cols, A, x, z, y);
+  } else {
+    TacsDeviceBCSRMultAddKernel<0><<<nblocks, TACS_DEVICE_BLOCK_SIZE>>>(
+        bsize, nrows, rowp, cols, A, x, z, y);
+  }
+  TacsDeviceCheck(cudaGetLastError(), "TacsDeviceBCSRMultAdd");
+}
+
+void TacsDeviceScatterAddVars(int bsize, int nvars, const int *vars,
+                              int lower, const TacsScalar *x, TacsScalar *y) {
+  int n = bsize * nvars;
+  if (n > 0) {
+    TacsDeviceScatterAddKernel<<<TacsDeviceNumBlocks(n),
+                                 TACS_DEVICE_BLOCK_SIZE>>>(bsize, nvars, vars,
+                                                           lower, x, y);
+    TacsDeviceCheck(cudaGetLastError(), "TacsDeviceScatterAddVars");
+  }
+}
+
+void TacsDeviceSetEntries(int n, const int *index, TacsScalar value,
+                          TacsScalar *x) {
+  if (n > 0) {
+    TacsDeviceSetEntriesKernel<<<TacsDeviceNumBlocks(n),
+                                 TACS_DEVICE_BLOCK_SIZE>>>(n, index, value, x);
+    TacsDeviceCheck(cudaGetLastError(), "TacsDeviceSetEntries");
+  }
+}
+
+void TacsDeviceAddElementMatrices(int bsize, int nnodes, int nelems,
+                                  const int *elems, const int *ptr,
+                                  const int *plan, const TacsScalar *values,
+                                  TacsScalar *A, TacsScalar *B,
+                                  TacsScalar *ext) {
+  long n = (long)nelems * bsize * nnodes * bsize * nnodes;
+  if (n > 0) {
+    long nblocks = (n + TACS_DEVICE_BLOCK_SIZE - 1) / TACS_DEVICE_BLOCK_SIZE;
+    if (nblocks > 65535) {
+      nblocks = 65535;
+    }
+    TacsDeviceAddElementMatricesKernel<<<nblocks, TACS_DEVICE_BLOCK_SIZE>>>(
+        bsize, nnodes, nelems, elems, ptr, plan, values, A, B, ext);
+    TacsDeviceCheck(cudaGetLastError(), "TacsDeviceAddElementMatrices");
+  }
+}
+
+void TacsDeviceAddBlocks(int bsize, int nblocks, const int *plan,
+                         const TacsScalar *values, TacsScalar *A,
+                         TacsScalar *B) {
+  int n = bsize * bsize * nblocks;
+  if (n > 0) {
+    TacsDeviceAddBlocksKernel<<<TacsDeviceNumBlocks(n),
+                                TACS_DEVICE_BLOCK_SIZE>>>(bsize, nblocks, plan,
+                                                          values, A, B);
+    TacsDeviceCheck(cudaGetLastError(), "TacsDeviceAddBlocks");
+  }
+}
+
+/*
+  The streams, the events used to order them and the BLAS handle for
+  the dense operations. These are created on first use.
+*/
+static cudaStream_t tacs_device_streams[TACS_DEVICE_NUM_STREAMS];
+static cudaEvent_t tacs_device_events[TACS_DEVICE_NUM_STREAMS];
+static cublasHandle_t tacs_device_blas_handle;
+static int tacs_device_streams_init = 0;
+
+static cudaStream_t TacsDeviceGetStream(int stream) {
+  if (!tacs_device_streams_init) {
+    for (int k = 0; k < TACS_DEVICE_NUM_STREAMS; k++) {
+      TacsDeviceCheck(cudaStreamCreate(&tacs_device_streams[k]),
+                      "cudaStreamCreate");
+      TacsDeviceCheck(cudaEventCreateWithFlags(&tacs_device_events[k],
+                                               cudaEventDisableTiming),
+                      "cudaEventCreate");
+    }
+    if (cublasCreate(&tacs_device_blas_handle) != CUBLAS_STATUS_SUCCESS) {
+      fprintf(stderr, "TACSDevice error: Failed to create the BLAS handle\n");
+    }
+    tacs_device_streams_init = 1;
+  }
+  return tacs_device_streams[stream % TACS_DEVICE_NUM_STREAMS];
+}
+
+void TacsDeviceCopyAsync(int stream, void *dest, const void *src,
+                         size_t bytes) {
+  if (bytes > 0) {
+    TacsDeviceCheck(cudaMemcpyAsync(dest, src, bytes, cudaMemcpyDefault,
+                                    TacsDeviceGetStream(stream)),
+                    "cudaMemcpyAsync");
+  }
+}
+
+void TacsDeviceStreamWait(int stream, int other) {
+  cudaStream_t s = TacsDeviceGetStream(stream);
+  cudaStream_t t = TacsDeviceGetStream(other);
+  cudaEvent_t event = tacs_device_events[other % TACS_DEVICE_NUM_STREAMS];
+  TacsDeviceCheck(cudaEventRecord(event, t), "cudaEventRecord");
+  TacsDeviceCheck(cudaStreamWaitEvent(s, event, 0), "cudaStreamWaitEvent");
+}
+
+void TacsDeviceStreamSynchronize(int stream) {
+  TacsDeviceCheck(cudaStreamSynchronize(TacsDeviceGetStream(stream)),
+                  "cudaStreamSynchronize");
+}
+
+void TacsDeviceGemm(int stream, int m, int n, int k, TacsScalar alpha,
+                    const TacsScalar *A, int lda, const TacsScalar *B,
+                    int ldb, TacsScalar beta, TacsScalar *C, int ldc) {
+  if (m > 0 && n > 0 && k > 0) {
+    cudaStream_t s = TacsDeviceGetStream(stream);
+    cublasSetStream(tacs_device_blas_handle, s);
+    cublasStatus_t status =
+        cublasDgemm(tacs_device_blas_handle, CUBLAS_OP_N, CUBLAS_OP_N, m, n, k,
+                    &alpha, A, lda, B, ldb, &beta, C, ldc);
+    if (status != CUBLAS_STATUS_SUCCESS) {
+      fprintf(stderr, "TACSDevice error: TacsDeviceGemm failed\n");
+    }
+  }
+}
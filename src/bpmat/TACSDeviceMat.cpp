@@ -0,0 +1,707 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSDeviceMat.h"
+
+/*
+  Create a device vector with the layout defined by the node map
+*/
+TACSDeviceVec::TACSDeviceVec(TACSNodeMap *map, int _bsize) {
+  node_map = map;
+  node_map->incref();
+  comm = node_map->getMPIComm();
+  bsize = _bsize;
+  size = bsize * node_map->getNumNodes();
+
+  x = (TacsScalar *)TacsDeviceMalloc(size * sizeof(TacsScalar));
+  TacsDeviceMemset(x, size * sizeof(TacsScalar));
+  mdot_req.request = MPI_REQUEST_NULL;
+}
+
+TACSDeviceVec::~TACSDeviceVec() {
+  node_map->decref();
+  TacsDeviceFree(x);
+}
+
+/*
+  Compute the norm of the vector
+*/
+TacsScalar TACSDeviceVec::norm() {
+  TacsScalar res = TacsDeviceDot(size, x, x);
+  TacsAddFlops(2 * size);
+
+  TacsScalar sum;
+  MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
+
+  return sqrt(sum);
+}
+
+/*
+  Scale the vector by a scalar
+*/
+void TACSDeviceVec::scale(TacsScalar alpha) {
+  TacsDeviceScale(size, alpha, x);
+  TacsAddFlops(size);
+}
+
+/*
+  Compute the dot product of two vectors
+*/
+TacsScalar TACSDeviceVec::dot(TACSVec *tvec) {
+  TacsScalar sum = 0.0;
+  TACSDeviceVec *vec = dynamic_cast<TACSDeviceVec *>(tvec);
+  if (vec) {
+    if (vec->size != size) {
+      fprintf(stderr, "TACSDeviceVec::dot Error, the sizes must be the same\n");
+      return 0.0;
+    }
+
+    TacsScalar res = TacsDeviceDot(size, x, vec->x);
+    MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
+  } else {
+    fprintf(stderr, "TACSDeviceVec type error: Input must be TACSDeviceVec\n");
+  }
+
+  TacsAddFlops(2 * size);
+
+  return sum;
+}
+
+/*
+  Compute multiple dot products with a single reduction
+*/
+void TACSDeviceVec::mdot(TACSVec **tvec, TacsScalar *ans, int nvecs) {
+  localMdot(tvec, ans, nvecs);
+  MPI_Allreduce(MPI_IN_PLACE, ans, nvecs, TACS_MPI_TYPE, MPI_SUM, comm);
+}
+
+/*
+  Start the multiple dot product without waiting for the result. See
+  TACSBVec::mdotBegin() for details.
+*/
+void TACSDeviceVec::mdotBegin(TACSVec **tvec, TacsScalar *ans, int nvecs) {
+  beginMdot(tvec, ans, nvecs, &mdot_req);
+}
+
+/*
+  Complete the multiple dot product started by mdotBegin()
+*/
+void TACSDeviceVec::mdotEnd(TacsScalar *ans, int nvecs) {
+  endMdot(&mdot_req);
+}
+
+/*
+  Start the sum of the values in the request over all processors
+*/
+void TACSDeviceVec::beginReduction(TACSVecRequest *req, TacsScalar *vals,
+                                   int n) {
+#if MPI_VERSION >= 3
+  MPI_Iallreduce(MPI_IN_PLACE, vals, n, TACS_MPI_TYPE, MPI_SUM, comm,
+                 &req->request);
+#else
+  MPI_Allreduce(MPI_IN_PLACE, vals, n, TACS_MPI_TYPE, MPI_SUM, comm);
+  req->request = MPI_REQUEST_NULL;
+#endif
+}
+
+/*
+  Start the dot product with a non-blocking reduction. See
+  TACSBVec::beginDot() for details.
+*/
+void TACSDeviceVec::beginDot(TACSVec *tvec, TACSVecRequest *req) {
+  localMdot(&tvec, req->values, 1);
+  beginReduction(req, req->values, 1);
+}
+
+/*
+  Start the norm with a non-blocking reduction
+*/
+void TACSDeviceVec::beginNorm(TACSVecRequest *req) {
+  req->values[0] = TacsDeviceDot(size, x, x);
+  TacsAddFlops(2 * size);
+  beginReduction(req, req->values, 1);
+}
+
+/*
+  Start the multiple dot product with a non-blocking reduction
+*/
+void TACSDeviceVec::beginMdot(TACSVec **tvec, TacsScalar *ans, int nvecs,
+                              TACSVecRequest *req) {
+  localMdot(tvec, ans, nvecs);
+  beginReduction(req, ans, nvecs);
+}
+
+/*
+  Compute y <- y + alpha*x and start the reduction for the norm of the
+  updated vector
+*/
+void TACSDeviceVec::beginAxpyNorm(TacsScalar alpha, TACSVec *tvec,
+                                  TACSVecRequest *req) {
+  axpy(alpha, tvec);
+  beginNorm(req);
+}
+
+/*
+  Start the dot products with x1 and x2 with a single device
+  reduction and a single MPI reduction
+*/
+void TACSDeviceVec::beginDot2(TACSVec *tvec1, TACSVec *tvec2,
+                              TACSVecRequest *req) {
+  TACSVec *tvecs[2] = {tvec1, tvec2};
+  localMdot(tvecs, req->values, 2);
+  beginReduction(req, req->values, 2);
+}
+
+/*
+  Compute the on-processor contributions to the multiple dot product.
+  All the products are computed with a single device reduction.
+*/
+void TACSDeviceVec::localMdot(TACSVec **tvec, TacsScalar *ans, int nvecs) {
+  const TacsScalar **vecs = new const TacsScalar *[nvecs];
+  for (int k = 0; k < nvecs; k++) {
+    TACSDeviceVec *vec = dynamic_cast<TACSDeviceVec *>(tvec[k]);
+    if (vec && vec->size == size) {
+      vecs[k] = vec->x;
+    } else {
+      fprintf(stderr, "TACSDeviceVec::mdot Error, incompatible vector\n");
+      vecs[k] = x;
+    }
+  }
+
+  TacsDeviceMdot(size, nvecs, vecs, x, ans);
+  TacsAddFlops(2 * nvecs * size);
+
+  delete[] vecs;
+}
+
+/*
+  Compute y = alpha*x + y
+*/
+void TACSDeviceVec::axpy(TacsScalar alpha, TACSVec *tvec) {
+  TACSDeviceVec *vec = dynamic_cast<TACSDeviceVec *>(tvec);
+
+  if (vec) {
+    if (vec->size != size) {
+      fprintf(stderr, "TACSDeviceVec::axpy Error, the sizes must be the same\n");
+      return;
+    }
+
+    TacsDeviceAxpy(size, alpha, vec->x, x);
+  } else {
+    fprintf(stderr, "TACSDeviceVec type error: Input must be TACSDeviceVec\n");
+  }
+
+  TacsAddFlops(2 * size);
+}
+
+/*
+  Compute x <- alpha*vec + beta*x
+*/
+void TACSDeviceVec::axpby(TacsScalar alpha, TacsScalar beta, TACSVec *tvec) {
+  TACSDeviceVec *vec = dynamic_cast<TACSDeviceVec *>(tvec);
+
+  if (vec) {
+    if (vec->size != size) {
+      fprintf(stderr, "TACSDeviceVec::axpby Error sizes must be the same\n");
+      return;
+    }
+
+    TacsDeviceAxpby(size, alpha, beta, vec->x, x);
+  } else {
+    fprintf(stderr, "TACSDeviceVec type error: Input must be TACSDeviceVec\n");
+  }
+
+  TacsAddFlops(3 * size);
+}
+
+/*
+  Copy the values from another device vector
+*/
+void TACSDeviceVec::copyValues(TACSVec *tvec) {
+  TACSDeviceVec *vec = dynamic_cast<TACSDeviceVec *>(tvec);
+  if (vec) {
+    if (vec->size != size) {
+      fprintf(stderr,
+              "TACSDeviceVec::copyValues error, sizes must be the same\n");
+      return;
+    }
+
+    TacsDeviceCopy(x, vec->x, size * sizeof(TacsScalar));
+  } else {
+    fprintf(stderr, "TACSDeviceVec type error: Input must be TACSDeviceVec\n");
+  }
+}
+
+/*
+  Zero all the entries in the vector
+*/
+void TACSDeviceVec::zeroEntries() {
+  TacsDeviceMemset(x, size * sizeof(TacsScalar));
+}
+
+/*
+  Set random values. The values are the same as those set by
+  TACSBVec::setRand() on the host.
+*/
+void TACSDeviceVec::setRand(double lower, double upper) {
+  TACSBVec *vec = new TACSBVec(node_map, bsize);
+  vec->incref();
+  vec->setRand(lower, upper);
+  setValues(vec);
+  vec->decref();
+}
+
+/*
+  Copy the values from the host vector to the device
+*/
+void TACSDeviceVec::setValues(TACSBVec *vec) {
+  TacsScalar *array;
+  int vsize = vec->getArray(&array);
+  if (vsize != size) {
+    fprintf(stderr, "TACSDeviceVec::setValues error, sizes must be the same\n");
+    return;
+  }
+  TacsDeviceCopyToDevice(x, array, size * sizeof(TacsScalar));
+}
+
+/*
+  Copy the values from the device to the host vector
+*/
+void TACSDeviceVec::getValues(TACSBVec *vec) {
+  TacsScalar *array;
+  int vsize = vec->getArray(&array);
+  if (vsize != size) {
+    fprintf(stderr, "TACSDeviceVec::getValues error, sizes must be the same\n");
+    return;
+  }
+  TacsDeviceCopyToHost(array, x, size * sizeof(TacsScalar));
+}
+
+/*
+  Get the device array of values
+*/
+int TACSDeviceVec::getArray(TacsScalar **array) {
+  if (array) {
+    *array = x;
+  }
+  return size;
+}
+
+const char *TACSDeviceVec::vecName = "TACSDeviceVec";
+
+const char *TACSDeviceVec::getObjectName() { return vecName; }
+
+/*
+  Create the device copy of the parallel matrix
+*/
+TACSDeviceParallelMat::TACSDeviceParallelMat(TACSParallelMat *_mat) {
+  mat = _mat;
+  mat->incref();
+  mat->getRowMap(&bsize, &N, &Nc);
+  ext_offset = bsize * (N - Nc);
+
+  rmap = mat->getRowMap();
+  rmap->incref();
+  mat->getExtColMap(&ext_dist);
+  ext_dist->incref();
+  ctx = ext_dist->createDeviceCtx(bsize);
+  ctx->incref();
+
+  int len = bsize * ext_dist->getNumNodes();
+  x_ext = (TacsScalar *)TacsDeviceMalloc(len * sizeof(TacsScalar));
+  TacsDeviceMemset(x_ext, len * sizeof(TacsScalar));
+
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  copyPattern(A, &Aloc);
+  copyPattern(B, &Bext);
+  copyValues(mat);
+
+  // The assembly data is created when it is first needed
+  scatter_key = NULL;
+  scatter_ptr = scatter_plan = NULL;
+  num_ext_blocks = num_in_blocks = 0;
+  ext_A = in_A = NULL;
+  in_plan = NULL;
+  bc_key = NULL;
+  bc_key_size = 0;
+  num_bc_zero = num_bc_ext_zero = num_bc_ident = 0;
+  bc_zero = bc_ident = NULL;
+}
+
+TACSDeviceParallelMat::~TACSDeviceParallelMat() {
+  mat->decref();
+  rmap->decref();
+  ext_dist->decref();
+  ctx->decref();
+  TacsDeviceFree(x_ext);
+  freeBCSR(&Aloc);
+  freeBCSR(&Bext);
+  TacsDeviceFree(scatter_ptr);
+  TacsDeviceFree(scatter_plan);
+  TacsDeviceFree(ext_A);
+  TacsDeviceFree(in_A);
+  TacsDeviceFree(in_plan);
+  TacsDeviceFree(bc_zero);
+  TacsDeviceFree(bc_ident);
+}
+
+/*
+  Copy the non-zero pattern of the matrix to the device and allocate
+  the values
+*/
+void TACSDeviceParallelMat::copyPattern(BCSRMat *mat, DeviceBCSR *dmat) {
+  int bs, ncols;
+  const int *rowp, *cols;
+  TacsScalar *A;
+  mat->getArrays(&bs, &dmat->nrows, &ncols, &rowp, &cols, &A);
+  dmat->nnz = rowp[dmat->nrows];
+
+  dmat->rowp = (int *)TacsDeviceMalloc((dmat->nrows + 1) * sizeof(int));
+  TacsDeviceCopyToDevice(dmat->rowp, rowp, (dmat->nrows + 1) * sizeof(int));
+  dmat->cols = (int *)TacsDeviceMalloc(dmat->nnz * sizeof(int));
+  TacsDeviceCopyToDevice(dmat->cols, cols, dmat->nnz * sizeof(int));
+
+  size_t length = (size_t)bsize * bsize * dmat->nnz;
+  dmat->A = (TacsScalar *)TacsDeviceMalloc(length * sizeof(TacsScalar));
+}
+
+/*
+  Copy the values of the matrix to the device
+*/
+void TACSDeviceParallelMat::copyBCSRValues(BCSRMat *mat, DeviceBCSR *dmat) {
+  int bs, nrows, ncols;
+  const int *rowp, *cols;
+  TacsScalar *A;
+  mat->getArrays(&bs, &nrows, &ncols, &rowp, &cols, &A);
+  if (bs != bsize || nrows != dmat->nrows || rowp[nrows] != dmat->nnz) {
+    fprintf(stderr,
+            "TACSDeviceParallelMat error: non-zero pattern does not match\n");
+    return;
+  }
+
+  size_t length = (size_t)bsize * bsize * dmat->nnz;
+  TacsDeviceCopyToDevice(dmat->A, A, length * sizeof(TacsScalar));
+}
+
+/*
+  Free the device arrays
+*/
+void TACSDeviceParallelMat::freeBCSR(DeviceBCSR *dmat) {
+  TacsDeviceFree(dmat->rowp);
+  TacsDeviceFree(dmat->cols);
+  TacsDeviceFree(dmat->A);
+}
+
+/*
+  Copy the values from a TACSParallelMat with the same non-zero
+  pattern, or from another device matrix created from it
+*/
+void TACSDeviceParallelMat::copyValues(TACSMat *mat) {
+  TACSParallelMat *pmat = dynamic_cast<TACSParallelMat *>(mat);
+  TACSDeviceParallelMat *dmat = dynamic_cast<TACSDeviceParallelMat *>(mat);
+  if (pmat) {
+    BCSRMat *A, *B;
+    pmat->getBCSRMat(&A, &B);
+    copyBCSRValues(A, &Aloc);
+    copyBCSRValues(B, &Bext);
+  } else if (dmat && dmat->Aloc.nnz == Aloc.nnz &&
+             dmat->Bext.nnz == Bext.nnz) {
+    size_t b2 = (size_t)bsize * bsize;
+    TacsDeviceCopy(Aloc.A, dmat->Aloc.A, b2 * Aloc.nnz * sizeof(TacsScalar));
+    TacsDeviceCopy(Bext.A, dmat->Bext.A, b2 * Bext.nnz * sizeof(TacsScalar));
+  } else {
+    fprintf(stderr, "Cannot copy matrices of different types\n");
+  }
+}
+
+/*
+  Zero the entries of the matrix and the buffer of external blocks
+*/
+void TACSDeviceParallelMat::zeroEntries() {
+  size_t b2 = (size_t)bsize * bsize;
+  TacsDeviceMemset(Aloc.A, b2 * Aloc.nnz * sizeof(TacsScalar));
+  TacsDeviceMemset(Bext.A, b2 * Bext.nnz * sizeof(TacsScalar));
+  if (ext_A) {
+    TacsDeviceMemset(ext_A, b2 * num_ext_blocks * sizeof(TacsScalar));
+  }
+}
+
+/*
+  Copy the element scatter plan of the host matrix to the device
+
+  The plan must first be computed with
+  TACSParallelMat::setElementScatter() using the same element
+  connectivity pointer.
+
+  input:
+  elem_ptr:  the element connectivity pointer used for the plan
+
+  returns:   1 if the plan is available, 0 otherwise
+*/
+int TACSDeviceParallelMat::setElementScatter(const int *elem_ptr) {
+  TACSMatDistribute *mat_dist = mat->getMatDistribute();
+  const int *ptr = NULL, *plan = NULL;
+  int num_elements = 0;
+  if (mat_dist) {
+    num_elements = mat_dist->getElementScatter(elem_ptr, &ptr, &plan);
+  }
+  if (num_elements == 0) {
+    fprintf(stderr,
+            "TACSDeviceParallelMat error: No element scatter plan for the "
+            "connectivity\n");
+    return 0;
+  }
+
+  TacsDeviceFree(scatter_ptr);
+  TacsDeviceFree(scatter_plan);
+  scatter_ptr = (int *)TacsDeviceMalloc((num_elements + 1) * sizeof(int));
+  TacsDeviceCopyToDevice(scatter_ptr, ptr, (num_elements + 1) * sizeof(int));
+  int size = ptr[num_elements];
+  scatter_plan = (int *)TacsDeviceMalloc(size * sizeof(int));
+  TacsDeviceCopyToDevice(scatter_plan, plan, size * sizeof(int));
+  scatter_key = elem_ptr;
+
+  // Allocate the device buffers for the blocks exchanged with the
+  // other processors
+  if (!ext_A) {
+    size_t b2 = (size_t)bsize * bsize;
+    TacsScalar *host_ext;
+    num_ext_blocks = mat_dist->getExtValues(&host_ext);
+    ext_A = (TacsScalar *)TacsDeviceMalloc(b2 * num_ext_blocks *
+                                           sizeof(TacsScalar));
+    TacsDeviceMemset(ext_A, b2 * num_ext_blocks * sizeof(TacsScalar));
+
+    const int *plan_in;
+    TacsScalar *host_in;
+    num_in_blocks = mat_dist->getIncomingScatter(mat, &plan_in, &host_in);
+    in_A = (TacsScalar *)TacsDeviceMalloc(b2 * num_in_blocks *
+                                          sizeof(TacsScalar));
+    in_plan = (int *)TacsDeviceMalloc(num_in_blocks * sizeof(int));
+    TacsDeviceCopyToDevice(in_plan, plan_in, num_in_blocks * sizeof(int));
+  }
+
+  return 1;
+}
+
+/*
+  Add a batch of element matrices stored on the device
+
+  All the elements in the batch must have the same number of nodes.
+  The elements of the batch that have no plan are skipped.
+
+  input:
+  nnodes:  the number of nodes for each element
+  nelems:  the number of elements in the batch
+  elems:   the device array of element indices
+  values:  the device array of the element matrices
+*/
+void TACSDeviceParallelMat::addElementMatrices(int nnodes, int nelems,
+                                               const int *elems,
+                                               const TacsScalar *values) {
+  if (!scatter_plan) {
+    fprintf(stderr,
+            "TACSDeviceParallelMat error: Must call setElementScatter() "
+            "before adding element matrices\n");
+    return;
+  }
+  TacsDeviceAddElementMatrices(bsize, nnodes, nelems, elems, scatter_ptr,
+                               scatter_plan, values, Aloc.A, Bext.A, ext_A);
+}
+
+/*
+  Send the external blocks to the processors that own their rows
+*/
+void TACSDeviceParallelMat::beginAssembly() {
+  TACSMatDistribute *mat_dist = mat->getMatDistribute();
+  if (mat_dist && ext_A) {
+    TacsScalar *host_ext;
+    mat_dist->getExtValues(&host_ext);
+    size_t b2 = (size_t)bsize * bsize;
+    TacsDeviceCopyToHost(host_ext, ext_A,
+                         b2 * num_ext_blocks * sizeof(TacsScalar));
+    mat_dist->beginAssembly(mat);
+  }
+}
+
+/*
+  Receive the blocks from the other processors and add them to the
+  matrix on the device
+*/
+void TACSDeviceParallelMat::endAssembly() {
+  TACSMatDistribute *mat_dist = mat->getMatDistribute();
+  if (mat_dist && ext_A) {
+    mat_dist->endAssemblyTransfer();
+
+    const int *plan_in;
+    TacsScalar *host_in;
+    mat_dist->getIncomingScatter(mat, &plan_in, &host_in);
+    size_t b2 = (size_t)bsize * bsize;
+    TacsDeviceCopyToDevice(in_A, host_in,
+                           b2 * num_in_blocks * sizeof(TacsScalar));
+    TacsDeviceAddBlocks(bsize, num_in_blocks, in_plan, in_A, Aloc.A, Bext.A);
+  }
+}
+
+/*
+  Apply the boundary conditions
+
+  The entries of the rows that are zeroed, and the diagonal entries
+  that are set to one, are found on the host the first time the
+  boundary conditions are applied and are stored on the device. The
+  result is the same as TACSParallelMat::applyBCs().
+*/
+void TACSDeviceParallelMat::applyBCs(TACSBcMap *bcmap) {
+  if (!bcmap) {
+    return;
+  }
+
+  const int *nodes, *vars;
+  int nbcs = bcmap->getBCs(&nodes, &vars, NULL);
+  if (bcmap != bc_key || nbcs != bc_key_size) {
+    int mpi_rank;
+    const int *owner_range;
+    MPI_Comm_rank(rmap->getMPIComm(), &mpi_rank);
+    rmap->getOwnerRange(&owner_range);
+
+    BCSRMat *A, *B;
+    mat->getBCSRMat(&A, &B);
+    const int *Arowp, *Acols, *Browp;
+    A->getArrays(NULL, NULL, NULL, &Arowp, &Acols, NULL);
+    B->getArrays(NULL, NULL, NULL, &Browp, NULL, NULL);
+
+    // Count the number of entries set by the boundary conditions
+    const int b2 = bsize * bsize;
+    num_bc_zero = num_bc_ext_zero = num_bc_ident = 0;
+    for (int i = 0; i < nbcs; i++) {
+      if (nodes[i] >= owner_range[mpi_rank] &&
+          nodes[i] < owner_range[mpi_rank + 1]) {
+        int row = nodes[i] - owner_range[mpi_rank];
+        int brow = row - (N - Nc);
+        for (int ii = 0; ii < bsize; ii++) {
+          if (vars[i] & (1 << ii)) {
+            num_bc_zero += bsize * (Arowp[row + 1] - Arowp[row]);
+            num_bc_ident++;
+            if (brow >= 0) {
+              num_bc_ext_zero += bsize * (Browp[brow + 1] - Browp[brow]);
+            }
+          }
+        }
+      }
+    }
+
+    // Find the entries in the diagonal and off-diagonal parts
+    int *zero = new int[num_bc_zero + num_bc_ext_zero];
+    int *ext_zero = &zero[num_bc_zero];
+    int *ident = new int[num_bc_ident];
+    int nzero = 0, next = 0, nident = 0;
+    for (int i = 0; i < nbcs; i++) {
+      if (nodes[i] >= owner_range[mpi_rank] &&
+          nodes[i] < owner_range[mpi_rank + 1]) {
+        int row = nodes[i] - owner_range[mpi_rank];
+        int brow = row - (N - Nc);
+        for (int ii = 0; ii < bsize; ii++) {
+          if (vars[i] & (1 << ii)) {
+            for (int j = Arowp[row]; j < Arowp[row + 1]; j++) {
+              for (int jj = 0; jj < bsize; jj++) {
+                zero[nzero++] = b2 * j + bsize * ii + jj;
+              }
+              if (Acols[j] == row) {
+                ident[nident++] = b2 * j + (bsize + 1) * ii;
+              }
+            }
+            if (brow >= 0) {
+              for (int j = Browp[brow]; j < Browp[brow + 1]; j++) {
+                for (int jj = 0; jj < bsize; jj++) {
+                  ext_zero[next++] = b2 * j + bsize * ii + jj;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    num_bc_ident = nident;
+
+    int nbc = num_bc_zero + num_bc_ext_zero;
+    TacsDeviceFree(bc_zero);
+    TacsDeviceFree(bc_ident);
+    bc_zero = (int *)TacsDeviceMalloc(nbc * sizeof(int));
+    TacsDeviceCopyToDevice(bc_zero, zero, nbc * sizeof(int));
+    bc_ident = (int *)TacsDeviceMalloc(num_bc_ident * sizeof(int));
+    TacsDeviceCopyToDevice(bc_ident, ident, num_bc_ident * sizeof(int));
+    delete[] zero;
+    delete[] ident;
+
+    bc_key = bcmap;
+    bc_key_size = nbcs;
+  }
+
+  TacsDeviceSetEntries(num_bc_zero, bc_zero, 0.0, Aloc.A);
+  TacsDeviceSetEntries(num_bc_ext_zero, &bc_zero[num_bc_zero], 0.0, Bext.A);
+  TacsDeviceSetEntries(num_bc_ident, bc_ident, 1.0, Aloc.A);
+}
+
+/*
+  Get the local dimensions of the matrix
+*/
+void TACSDeviceParallelMat::getSize(int *_nr, int *_nc) {
+  *_nr = N * bsize;
+  *_nc = N * bsize;
+}
+
+/*!
+  Matrix multiplication
+
+  The exchange of the external values is started first, so that the
+  transfer overlaps the product with the local matrix.
+*/
+void TACSDeviceParallelMat::mult(TACSVec *txvec, TACSVec *tyvec) {
+  TACSDeviceVec *xvec = dynamic_cast<TACSDeviceVec *>(txvec);
+  TACSDeviceVec *yvec = dynamic_cast<TACSDeviceVec *>(tyvec);
+
+  if (xvec && yvec) {
+    TacsScalar *x, *y;
+    xvec->getArray(&x);
+    yvec->getArray(&y);
+
+    ext_dist->beginForwardDevice(ctx, x, x_ext);
+    TacsDeviceBCSRMultAdd(bsize, Aloc.nrows, Aloc.rowp, Aloc.cols, Aloc.A, x,
+                          NULL, y);
+    ext_dist->endForwardDevice(ctx, x, x_ext);
+    TacsDeviceBCSRMultAdd(bsize, Bext.nrows, Bext.rowp, Bext.cols, Bext.A,
+                          x_ext, &y[ext_offset], &y[ext_offset]);
+
+    TacsAddFlops(2 * bsize * bsize * (Aloc.nnz + Bext.nnz));
+  } else {
+    fprintf(stderr,
+            "TACSDeviceParallelMat type error: Input/output must be "
+            "TACSDeviceVec\n");
+  }
+}
+
+/*
+  Create a device vector compatible with the matrix
+*/
+TACSVec *TACSDeviceParallelMat::createVec() {
+  return new TACSDeviceVec(rmap, bsize);
+}
+
+const char *TACSDeviceParallelMat::matName = "TACSDeviceParallelMat";
+
+const char *TACSDeviceParallelMat::getObjectName() { return matName; }
@@ -0,0 +1,195 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_DEVICE_MAT_H
+#define TACS_DEVICE_MAT_H
+
+#include "TACSDevice.h"
+#include "TACSParallelMat.h"
+
+/*
+  Parallel block vector with the values stored on the device.
+
+  The vector has the same parallel layout as a TACSBVec created from
+  the same node map and block size. All of the operations required by
+  the Krylov methods are performed on the device, so that a solve
+  with a TACSDeviceParallelMat only transfers the scalar results of
+  the reductions to the host. The values are copied to and from a
+  TACSBVec on the host with setValues() and getValues().
+*/
+class TACSDeviceVec : public TACSVec {
+ public:
+  TACSDeviceVec(TACSNodeMap *map, int bsize);
+  ~TACSDeviceVec();
+
+  // The basic vector operations
+  // ---------------------------
+  MPI_Comm getMPIComm() { return comm; }
+  void getSize(int *_size) { *_size = size; }
+  int getBlockSize() { return bsize; }
+  TacsScalar norm();
+  void scale(TacsScalar alpha);
+  TacsScalar dot(TACSVec *x);
+  void mdot(TACSVec **x, TacsScalar *ans, int m);
+  void axpy(TacsScalar alpha, TACSVec *x);
+  void copyValues(TACSVec *x);
+  void axpby(TacsScalar alpha, TacsScalar beta, TACSVec *x);
+  void zeroEntries();
+  void setRand(double lower, double upper);
+
+  // Split the multiple dot product to overlap the reduction
+  // -------------------------------------------------------
+  void mdotBegin(TACSVec **x, TacsScalar *ans, int m);
+  void mdotEnd(TacsScalar *ans, int m);
+
+  // Split-phase and fused reductions
+  // --------------------------------
+  void beginDot(TACSVec *x, TACSVecRequest *req);
+  void beginNorm(TACSVecRequest *req);
+  void beginMdot(TACSVec **x, TacsScalar *ans, int m, TACSVecRequest *req);
+  void beginAxpyNorm(TacsScalar alpha, TACSVec *x, TACSVecRequest *req);
+  void beginDot2(TACSVec *x1, TACSVec *x2, TACSVecRequest *req);
+
+  // Transfer the values to and from a vector on the host
+  // ----------------------------------------------------
+  void setValues(TACSBVec *vec);
+  void getValues(TACSBVec *vec);
+
+  // Get the device array and the node map
+  // -------------------------------------
+  int getArray(TacsScalar **array);
+  TACSNodeMap *getNodeMap() { return node_map; }
+  const char *getObjectName();
+
+ private:
+  // Compute the local part of the multiple dot product
+  void localMdot(TACSVec **x, TacsScalar *ans, int m);
+
+  // Start the sum of the values over all processors
+  void beginReduction(TACSVecRequest *req, TacsScalar *vals, int n);
+
+  MPI_Comm comm;
+  TACSNodeMap *node_map;
+  int bsize, size;
+
+  // The device array of values
+  TacsScalar *x;
+
+  // The request for the split multiple dot product
+  TACSVecRequest mdot_req;
+
+  static const char *vecName;
+};
+
+/*
+  Device copy of a TACSParallelMat used for matrix-vector products.
+
+  The non-zero pattern and values of the local and external parts of
+  the matrix are copied to the device when the object is created. The
+  values must be copied again with copyValues() whenever the entries
+  of the TACSParallelMat change. The external values are exchanged
+  with a device context of the column map of the matrix, and the
+  product with the local part of the matrix is started before the
+  exchange is completed.
+
+  This matrix, together with TACSDeviceVec and a preconditioner that
+  only uses the matrix and vector operations, such as
+  TACSChebyshevSmoother, allows a complete Krylov solve on the device.
+
+  The matrix can also be assembled directly on the device from a batch
+  of element matrices computed on the device. This uses the element
+  scatter plan of the TACSParallelMat (see setElementScatter()), so
+  that the blocks are added without searching the non-zero pattern.
+  The blocks of rows owned by other processors are accumulated in a
+  device buffer that is exchanged in beginAssembly()/endAssembly().
+*/
+class TACSDeviceParallelMat : public TACSMat {
+ public:
+  TACSDeviceParallelMat(TACSParallelMat *mat);
+  ~TACSDeviceParallelMat();
+
+  // Copy the values from a TACSParallelMat with the same pattern
+  // ------------------------------------------------------------
+  void copyValues(TACSMat *mat);
+
+  // Assemble the matrix from element matrices on the device
+  // --------------------------------------------------------
+  void zeroEntries();
+  int setElementScatter(const int *elem_ptr);
+  void addElementMatrices(int nnodes, int nelems, const int *elems,
+                          const TacsScalar *values);
+  void beginAssembly();
+  void endAssembly();
+  void applyBCs(TACSBcMap *bcmap);
+
+  // Functions required for solving linear systems
+  // ---------------------------------------------
+  void getSize(int *_nr, int *_nc);
+  void mult(TACSVec *x, TACSVec *y);
+  TACSVec *createVec();
+  const char *getObjectName();
+
+ private:
+  // The device copy of a BCSRMat
+  struct DeviceBCSR {
+    int nrows, nnz;
+    int *rowp, *cols;
+    TacsScalar *A;
+  };
+  void copyPattern(BCSRMat *mat, DeviceBCSR *dmat);
+  void copyBCSRValues(BCSRMat *mat, DeviceBCSR *dmat);
+  void freeBCSR(DeviceBCSR *dmat);
+
+  // The host matrix that defines the pattern and the assembly data
+  TACSParallelMat *mat;
+
+  // The row map and the external column map
+  TACSNodeMap *rmap;
+  TACSBVecDistribute *ext_dist;
+  TACSBVecDistCtx *ctx;
+
+  // The dimensions of the matrix
+  int bsize, N, Nc;
+
+  // The device copies of the local and external matrices
+  DeviceBCSR Aloc, Bext;
+
+  // The device array of the external values
+  TacsScalar *x_ext;
+  int ext_offset;
+
+  // The device copy of the element scatter plan
+  const int *scatter_key;
+  int *scatter_ptr, *scatter_plan;
+
+  // The device buffers for the blocks sent to and received from the
+  // other processors, and the plan for adding the received blocks
+  int num_ext_blocks, num_in_blocks;
+  TacsScalar *ext_A, *in_A;
+  int *in_plan;
+
+  // The entries of the matrix set by the boundary conditions
+  TACSBcMap *bc_key;
+  int bc_key_size;
+  int num_bc_zero, num_bc_ext_zero, num_bc_ident;
+  int *bc_zero, *bc_ident;
+
+  static const char *matName;
+};
+
+#endif  // TACS_DEVICE_MAT_H
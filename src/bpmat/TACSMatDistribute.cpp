@@ -18,6 +18,7 @@
 
 #include "TACSMatDistribute.h"
 
+#include "TACSCommProfiler.h"
 #include "TacsUtilities.h"
 
 /*
@@ -72,6 +73,13 @@ TACSMatDistribute::TACSMatDistribute(TACSThreadInfo *thread_info,
   row_map = _row_map;
   row_map->incref();
 
+  // No element scatter plan has been computed yet
+  scatter_key = NULL;
+  scatter_num_elements = 0;
+  scatter_ptr = NULL;
+  scatter_plan = NULL;
+  in_plan = NULL;
+
   // Get the rank/size of this communicator
   int mpiRank, mpiSize;
   comm = row_map->getMPIComm();
@@ -412,10 +420,59 @@ TACSMatDistribute::TACSMatDistribute(TACSThreadInfo *thread_info,
   ext_A = new TacsScalar[bsize * bsize * ext_rowp[num_ext_rows]];
   in_A = new TacsScalar[bsize * bsize * in_rowp[num_in_rows]];
   zeroEntries();
+
+  // Create the persistent requests used to exchange the values
+  initAssemblyRequests();
+}
+
+/*
+  Create the persistent send and receive requests for the assembly
+
+  The pattern of the exchange and the buffers never change, so the
+  requests are created once and started by each call to
+  beginAssembly(). The requests are inactive after they complete and
+  are freed in the destructor.
+*/
+void TACSMatDistribute::initAssemblyRequests() {
+  const int b2 = bsize * bsize;
+
+  for (int k = 0, offset = 0, buff_offset = 0; k < num_in_procs; k++) {
+    int count = in_rowp[offset + in_count[k]] - in_rowp[offset];
+    count *= b2;
+
+    int source = in_procs[k];
+    int tag = 5;
+    MPI_Recv_init(&in_A[buff_offset], count, TACS_MPI_TYPE, source, tag, comm,
+                  &in_requests[k]);
+    offset += in_count[k];
+    buff_offset += count;
+  }
+
+  for (int k = 0, offset = 0, buff_offset = 0; k < num_ext_procs; k++) {
+    int count = ext_rowp[offset + ext_count[k]] - ext_rowp[offset];
+    count *= b2;
+
+    int dest = ext_procs[k];
+    int tag = 5;
+    MPI_Send_init(&ext_A[buff_offset], count, TACS_MPI_TYPE, dest, tag, comm,
+                  &ext_requests[k]);
+    offset += ext_count[k];
+    buff_offset += count;
+  }
 }
 
 TACSMatDistribute::~TACSMatDistribute() {
   row_map->decref();
+  for (int k = 0; k < num_ext_procs; k++) {
+    if (ext_requests[k] != MPI_REQUEST_NULL) {
+      MPI_Request_free(&ext_requests[k]);
+    }
+  }
+  for (int k = 0; k < num_in_procs; k++) {
+    if (in_requests[k] != MPI_REQUEST_NULL) {
+      MPI_Request_free(&in_requests[k]);
+    }
+  }
   delete[] ext_procs;
   delete[] ext_count;
   delete[] ext_row_ptr;
@@ -433,6 +490,11 @@ TACSMatDistribute::~TACSMatDistribute() {
   delete[] in_cols;
   delete[] in_A;
   delete[] in_requests;
+  if (in_plan) {
+    delete[] in_plan;
+  }
+
+  clearElementScatter();
 }
 
 void TACSMatDistribute::zeroEntries() {
@@ -845,6 +907,478 @@ void TACSMatDistribute::addValues(TACSParallelMat *mat, int nrow,
   }
 }
 
+/*
+  Find the location of the block (row, col) in the matrix storage.
+
+  The location is encoded as
+
+  loc = SCATTER_NUM_TARGETS*(block index) + target
+
+  where target is SCATTER_ALOC or SCATTER_BEXT for blocks in rows
+  owned by this processor and SCATTER_EXT for blocks in rows that are
+  sent to another processor during assembly. The block values are
+  stored at data[target][bsize*bsize*(block index)] with the arrays
+  from getBlockData().
+
+  input:
+  mat:   the matrix that uses this distribution object
+  row:   the global block row index
+  col:   the global block column index
+
+  returns:  the encoded location or -1 if the block is not in the matrix
+*/
+int TACSMatDistribute::getBlockLocation(TACSParallelMat *mat, int row,
+                                        int col) {
+  if (row < 0 || col < 0) {
+    return -1;
+  }
+
+  int mpiRank;
+  MPI_Comm_rank(comm, &mpiRank);
+
+  const int *ownerRange;
+  row_map->getOwnerRange(&ownerRange);
+
+  // The lower/upper variable ranges
+  int lower = ownerRange[mpiRank];
+  int upper = ownerRange[mpiRank + 1];
+
+  if (row >= lower && row < upper) {
+    // Get the number of local variables and number of coupling
+    // variables
+    int N, Nc;
+    mat->getRowMap(NULL, &N, &Nc);
+    int Np = N - Nc;
+
+    BCSRMat *Aloc, *Bext;
+    mat->getBCSRMat(&Aloc, &Bext);
+
+    if (col >= lower && col < upper) {
+      // The block is in the diagonal part
+      const int *Arowp, *Acols;
+      Aloc->getArrays(NULL, NULL, NULL, &Arowp, &Acols, NULL);
+
+      int r = row - lower;
+      int start = Arowp[r];
+      int size = Arowp[r + 1] - start;
+      int *item = TacsSearchArray(col - lower, size, &Acols[start]);
+      if (item) {
+        return SCATTER_NUM_TARGETS * (item - Acols) + SCATTER_ALOC;
+      }
+    } else if (row - lower >= Np) {
+      // The block is in the off-diagonal part
+      const int *Browp, *Bcols;
+      Bext->getArrays(NULL, NULL, NULL, &Browp, &Bcols, NULL);
+
+      int *item = TacsSearchArray(col, col_map_size, col_map_vars);
+      if (item) {
+        int r = row - lower - Np;
+        int start = Browp[r];
+        int size = Browp[r + 1] - start;
+        item = TacsSearchArray(item - col_map_vars, size, &Bcols[start]);
+        if (item) {
+          return SCATTER_NUM_TARGETS * (item - Bcols) + SCATTER_BEXT;
+        }
+      }
+    }
+  } else {
+    // The block is in a row that is sent to another processor
+    int *item = TacsSearchArray(row, num_ext_rows, ext_rows);
+    if (item) {
+      int r_ext = item - ext_rows;
+      int start = ext_rowp[r_ext];
+      int size = ext_rowp[r_ext + 1] - start;
+      item = TacsSearchArray(col, size, &ext_cols[start]);
+      if (item) {
+        return SCATTER_NUM_TARGETS * (item - ext_cols) + SCATTER_EXT;
+      }
+    }
+  }
+
+  return -1;
+}
+
+/*
+  Get the arrays that store the blocks for each of the targets used in
+  the encoded block locations
+
+  input:
+  mat:   the matrix that uses this distribution object
+
+  output:
+  data:  the SCATTER_NUM_TARGETS arrays of block values
+*/
+void TACSMatDistribute::getBlockData(TACSParallelMat *mat,
+                                     TacsScalar *data[]) {
+  BCSRMat *Aloc, *Bext;
+  mat->getBCSRMat(&Aloc, &Bext);
+  Aloc->getArrays(NULL, NULL, NULL, NULL, NULL, &data[SCATTER_ALOC]);
+  Bext->getArrays(NULL, NULL, NULL, NULL, NULL, &data[SCATTER_BEXT]);
+  data[SCATTER_EXT] = ext_A;
+}
+
+/*
+  Compute the element scatter plan for the matrix.
+
+  The scatter plan stores the location of every block of each element
+  matrix within the local diagonal matrix (Aloc), the local
+  off-diagonal matrix (Bext) or the external buffer of rows that are
+  sent to other processors. Each entry is encoded as
+
+  plan = SCATTER_NUM_TARGETS*(block index) + target
+
+  where target is one of SCATTER_ALOC, SCATTER_BEXT or SCATTER_EXT.
+  Negative column or row indices are skipped and stored as -1. If any
+  block of an element cannot be located, no plan is stored for that
+  element and addElementValues() returns zero so that the standard
+  addValues() code (with its error reporting) is used instead.
+
+  The plan only depends on the non-zero pattern, so it is shared by
+  all matrices created from one another with createDuplicate(). The
+  element connectivity pointer serves as the key that identifies the
+  connectivity the plan was computed for.
+
+  input:
+  mat:           the matrix that uses this distribution object
+  num_elements:  the number of elements
+  elem_ptr:      pointer into the element connectivity
+  elem_nodes:    the global node numbers for each element
+*/
+void TACSMatDistribute::computeElementScatter(TACSParallelMat *mat,
+                                              int num_elements,
+                                              const int *elem_ptr,
+                                              const int *elem_nodes) {
+  // Free any existing plan
+  clearElementScatter();
+
+  // Allocate enough space to store the plan for every element
+  int max_size = 0;
+  for (int i = 0; i < num_elements; i++) {
+    int nnodes = elem_ptr[i + 1] - elem_ptr[i];
+    max_size += nnodes * nnodes;
+  }
+  scatter_ptr = new int[num_elements + 1];
+  scatter_plan = new int[max_size];
+
+  int offset = 0;
+  for (int elem = 0; elem < num_elements; elem++) {
+    const int *nodes = &elem_nodes[elem_ptr[elem]];
+    int nnodes = elem_ptr[elem + 1] - elem_ptr[elem];
+    int *plan = &scatter_plan[offset];
+    scatter_ptr[elem] = offset;
+
+    int fail = 0;
+    for (int i = 0; i < nnodes && !fail; i++) {
+      int r = nodes[i];
+      for (int j = 0; j < nnodes && !fail; j++) {
+        int c = nodes[j];
+        int loc = getBlockLocation(mat, r, c);
+
+        // Flag the element if a block with valid indices was not found
+        if (loc < 0 && r >= 0 && c >= 0) {
+          fail = 1;
+        }
+        plan[i * nnodes + j] = loc;
+      }
+    }
+
+    // Only keep the plan for elements where all blocks were found
+    if (!fail) {
+      offset += nnodes * nnodes;
+    }
+  }
+  scatter_ptr[num_elements] = offset;
+
+  // Shrink the plan if some elements were not included
+  if (offset < max_size) {
+    int *plan = new int[offset];
+    memcpy(plan, scatter_plan, offset * sizeof(int));
+    delete[] scatter_plan;
+    scatter_plan = plan;
+  }
+
+  scatter_key = elem_ptr;
+  scatter_num_elements = num_elements;
+}
+
+/*
+  Free the element scatter plan
+*/
+void TACSMatDistribute::clearElementScatter() {
+  if (scatter_ptr) {
+    delete[] scatter_ptr;
+  }
+  if (scatter_plan) {
+    delete[] scatter_plan;
+  }
+  scatter_key = NULL;
+  scatter_num_elements = 0;
+  scatter_ptr = NULL;
+  scatter_plan = NULL;
+}
+
+/*
+  Get the memory in bytes required to store the element scatter plan
+*/
+size_t TACSMatDistribute::getElementScatterMemory() {
+  size_t mem = 0;
+  if (scatter_plan) {
+    mem = sizeof(int) * (scatter_num_elements + 1);
+    mem += sizeof(int) * scatter_ptr[scatter_num_elements];
+  }
+  return mem;
+}
+
+/*
+  Add a block of the element matrix to a block of the matrix. The
+  block size is a compile-time constant for the common block sizes so
+  that the loops are fully unrolled.
+*/
+template <int bs>
+static inline void TacsAddScatterBlock(TacsScalar *a, const TacsScalar *v,
+                                       int mv) {
+  for (int ii = 0; ii < bs; ii++, a += bs, v += mv) {
+    for (int jj = 0; jj < bs; jj++) {
+      a[jj] += v[jj];
+    }
+  }
+}
+
+static inline void TacsAddScatterBlock(int bs, TacsScalar *a,
+                                       const TacsScalar *v, int mv) {
+  switch (bs) {
+    case 3:
+      TacsAddScatterBlock<3>(a, v, mv);
+      break;
+    case 6:
+      TacsAddScatterBlock<6>(a, v, mv);
+      break;
+    default:
+      for (int ii = 0; ii < bs; ii++, a += bs, v += mv) {
+        for (int jj = 0; jj < bs; jj++) {
+          a[jj] += v[jj];
+        }
+      }
+  }
+}
+
+/*
+  Add the values of an element matrix to the matrix using the
+  precomputed element scatter plan.
+
+  This performs no searches: Each block of the element matrix is added
+  directly to its location in the diagonal, off-diagonal or external
+  storage. The blocks are added in the same order and with the same
+  orientation as addValues() with row = col = the element nodes.
+
+  When the element declares which of its node blocks are non-zero,
+  only those blocks are added and the remaining (zero) blocks of the
+  element matrix are never read.
+
+  input:
+  mat:       the matrix that uses this distribution object
+  elem_ptr:  the element connectivity pointer used to compute the plan
+  elem:      the element index
+  mv:        the number of columns in the values matrix
+  values:    the dense element matrix
+  nblocks:   the number of non-zero node blocks (0 for all blocks)
+  blocks:    the (row, column) element node pairs for each block
+
+  returns:   1 if the values were added, 0 if no plan is available
+*/
+int TACSMatDistribute::addElementValues(TACSParallelMat *mat,
+                                        const int *elem_ptr, int elem, int mv,
+                                        const TacsScalar *values, int nblocks,
+                                        const int *blocks) {
+  if (!scatter_plan || elem_ptr != scatter_key || elem < 0 ||
+      elem >= scatter_num_elements) {
+    return 0;
+  }
+
+  const int start = scatter_ptr[elem];
+  if (scatter_ptr[elem + 1] == start) {
+    return 0;
+  }
+  const int *plan = &scatter_plan[start];
+  const int nnodes = elem_ptr[elem + 1] - elem_ptr[elem];
+
+  // Get the data arrays from the block matrices
+  TacsScalar *data[SCATTER_NUM_TARGETS];
+  getBlockData(mat, data);
+
+  const int b2 = bsize * bsize;
+  if (nblocks > 0 && blocks) {
+    for (int k = 0; k < nblocks; k++) {
+      const int i = blocks[2 * k];
+      const int j = blocks[2 * k + 1];
+      const int p = plan[nnodes * i + j];
+      if (p >= 0) {
+        const TacsScalar *v = &values[mv * bsize * i + bsize * j];
+        TacsScalar *a =
+            &data[p % SCATTER_NUM_TARGETS][b2 * (p / SCATTER_NUM_TARGETS)];
+        TacsAddScatterBlock(bsize, a, v, mv);
+      }
+    }
+
+    return 1;
+  }
+
+  for (int i = 0; i < nnodes; i++) {
+    const TacsScalar *v = &values[mv * bsize * i];
+    for (int j = 0; j < nnodes; j++, plan++, v += bsize) {
+      if (plan[0] >= 0) {
+        TacsScalar *a = &data[plan[0] % SCATTER_NUM_TARGETS]
+                             [b2 * (plan[0] / SCATTER_NUM_TARGETS)];
+        TacsAddScatterBlock(bsize, a, v, mv);
+      }
+    }
+  }
+
+  return 1;
+}
+
+/*
+  Get the element scatter plan for use on the device
+
+  The plan for element elem starts at plan[ptr[elem]], and has
+  nnodes*nnodes entries when ptr[elem+1] > ptr[elem]. The elements
+  without a plan must be added with addValues() instead.
+
+  input:
+  elem_ptr:  the element connectivity pointer used to compute the plan
+
+  output:
+  ptr:       the offset into the plan for each element
+  plan:      the encoded block locations
+
+  returns:   the number of elements, or 0 if no plan is available
+*/
+int TACSMatDistribute::getElementScatter(const int *elem_ptr,
+                                         const int **_ptr, const int **_plan) {
+  if (!scatter_plan || elem_ptr != scatter_key) {
+    *_ptr = NULL;
+    *_plan = NULL;
+    return 0;
+  }
+  *_ptr = scatter_ptr;
+  *_plan = scatter_plan;
+  return scatter_num_elements;
+}
+
+/*
+  Get the buffer of blocks that are sent to other processors
+
+  The plan entries with the target SCATTER_EXT refer to the blocks in
+  this buffer. The values in the buffer are sent by beginAssembly().
+
+  output:
+  ext_A:    the buffer of external blocks
+
+  returns:  the number of blocks in the buffer
+*/
+int TACSMatDistribute::getExtValues(TacsScalar **_ext_A) {
+  *_ext_A = ext_A;
+  return ext_rowp[num_ext_rows];
+}
+
+/*
+  Get the plan for adding the blocks received from other processors
+
+  The plan contains one encoded location in Aloc or Bext for each
+  block in the receive buffer, using the same encoding as the element
+  scatter plan. Blocks that are not in the non-zero pattern are stored
+  as -1. The plan is computed the first time it is requested.
+
+  input:
+  mat:      the matrix that uses this distribution object
+
+  output:
+  plan:     the encoded location of each received block
+  in_A:     the receive buffer that is filled by endAssemblyTransfer()
+
+  returns:  the number of blocks in the receive buffer
+*/
+int TACSMatDistribute::getIncomingScatter(TACSParallelMat *mat,
+                                          const int **_plan,
+                                          TacsScalar **_in_A) {
+  int nblocks = in_rowp[num_in_rows];
+
+  if (!in_plan) {
+    BCSRMat *Aloc, *Bext;
+    mat->getBCSRMat(&Aloc, &Bext);
+
+    const int *Arowp, *Acols, *Browp, *Bcols;
+    Aloc->getArrays(NULL, NULL, NULL, &Arowp, &Acols, NULL);
+    Bext->getArrays(NULL, NULL, NULL, &Browp, &Bcols, NULL);
+
+    int N, Nc;
+    mat->getRowMap(NULL, &N, &Nc);
+    int Np = N - Nc;
+
+    int mpiRank;
+    MPI_Comm_rank(comm, &mpiRank);
+    const int *ownerRange;
+    row_map->getOwnerRange(&ownerRange);
+    int lower = ownerRange[mpiRank];
+    int upper = ownerRange[mpiRank + 1];
+
+    in_plan = new int[nblocks];
+    for (int j = 0; j < num_in_rows; j++) {
+      int row = in_rows[j] - lower;
+      for (int k = in_rowp[j]; k < in_rowp[j + 1]; k++) {
+        int col = in_cols[k];
+        int *item = NULL;
+        in_plan[k] = -1;
+
+        if (col >= lower && col < upper) {
+          int start = Arowp[row];
+          int size = Arowp[row + 1] - start;
+          item = TacsSearchArray(col - lower, size, &Acols[start]);
+          if (item) {
+            in_plan[k] = SCATTER_NUM_TARGETS * (item - Acols) + SCATTER_ALOC;
+          }
+        } else if (row >= Np) {
+          item = TacsSearchArray(col, col_map_size, col_map_vars);
+          if (item) {
+            int start = Browp[row - Np];
+            int size = Browp[row - Np + 1] - start;
+            item = TacsSearchArray(item - col_map_vars, size, &Bcols[start]);
+            if (item) {
+              in_plan[k] = SCATTER_NUM_TARGETS * (item - Bcols) + SCATTER_BEXT;
+            }
+          }
+        }
+
+        if (!item) {
+          fprintf(stderr,
+                  "[%d] TACSMatDistribute: could not find block (%d, %d)\n",
+                  mpiRank, in_rows[j], col);
+        }
+      }
+    }
+  }
+
+  *_plan = in_plan;
+  *_in_A = in_A;
+  return nblocks;
+}
+
+/*
+  Complete the communication started with beginAssembly() without
+  adding the received blocks to the matrix. The blocks are left in the
+  receive buffer returned by getIncomingScatter().
+*/
+void TACSMatDistribute::endAssemblyTransfer() {
+  double t0 = TACSCommProfiler::beginWait();
+  if (num_in_procs > 0) {
+    MPI_Waitall(num_in_procs, in_requests, MPI_STATUSES_IGNORE);
+  }
+  if (num_ext_procs > 0) {
+    MPI_Waitall(num_ext_procs, ext_requests, MPI_STATUSES_IGNORE);
+  }
+  TACSCommProfiler::endWait(TACS_COMM_MAT_ASSEMBLY, t0);
+}
+
 /*
   Add a weighted sum of the dense input matrix.
 
@@ -1149,76 +1683,65 @@ void TACSMatDistribute::setValues(TACSParallelMat *mat, int nvars,
 }
 
 /*
-   Initiate the communication of the off-process matrix entries
+  Initiate the communication of the off-process matrix entries
+
+  The persistent requests are started, so no matching or buffer setup
+  is performed here.
 */
 void TACSMatDistribute::beginAssembly(TACSParallelMat *mat) {
-  int mpiRank;
-  MPI_Comm_rank(comm, &mpiRank);
-
-  // Get the block size squared
   const int b2 = bsize * bsize;
 
-  // Post the recvs
-  for (int k = 0, offset = 0, buff_offset = 0; k < num_in_procs; k++) {
+  // Record the message sizes for the profiler
+  for (int k = 0, offset = 0; k < num_in_procs; k++) {
     int count = in_rowp[offset + in_count[k]] - in_rowp[offset];
-    count *= b2;
-
-    int source = in_procs[k];
-    int tag = 5;
-    MPI_Irecv(&in_A[buff_offset], count, TACS_MPI_TYPE, source, tag, comm,
-              &in_requests[k]);
+    TACSCommProfiler::addRecv(TACS_COMM_MAT_ASSEMBLY, in_procs[k],
+                              b2 * count * sizeof(TacsScalar));
     offset += in_count[k];
-    buff_offset += count;
   }
-
-  // Post the sends
-  for (int k = 0, offset = 0, buff_offset = 0; k < num_ext_procs; k++) {
+  for (int k = 0, offset = 0; k < num_ext_procs; k++) {
     int count = ext_rowp[offset + ext_count[k]] - ext_rowp[offset];
-    count *= b2;
-
-    int dest = ext_procs[k];
-    int tag = 5;
-    MPI_Isend(&ext_A[buff_offset], count, TACS_MPI_TYPE, dest, tag, comm,
-              &ext_requests[k]);
+    TACSCommProfiler::addSend(TACS_COMM_MAT_ASSEMBLY, ext_procs[k],
+                              b2 * count * sizeof(TacsScalar));
     offset += ext_count[k];
-    buff_offset += count;
+  }
+
+  // Start the receives before the sends
+  if (num_in_procs > 0) {
+    MPI_Startall(num_in_procs, in_requests);
+  }
+  if (num_ext_procs > 0) {
+    MPI_Startall(num_ext_procs, ext_requests);
   }
 }
 
 /*
   Finish the communication of the off-process matrix entries.
-  Once the communication is completed, add the off-processor
-  entries to the matrix.
+
+  The received blocks are added to the matrix as each message
+  completes, using the precomputed location of each block in the
+  diagonal or off-diagonal matrix so that no searches are required.
 */
 void TACSMatDistribute::endAssembly(TACSParallelMat *mat) {
   int mpiRank;
   MPI_Comm_rank(comm, &mpiRank);
 
-  // Get the map between the global-external variables and the local
-  // variables (for Bext)
-  BCSRMat *Aloc, *Bext;
-  mat->getBCSRMat(&Aloc, &Bext);
-
-  // Get the number of local variables and number of coupling
-  // variables
-  int N, Nc;
-  mat->getRowMap(NULL, &N, &Nc);
-  int Np = N - Nc;
-
   // Get the block size squared
   const int b2 = bsize * bsize;
 
-  // Find the owner range for mapping variables
-  const int *ownerRange;
-  row_map->getOwnerRange(&ownerRange);
-  int lower = ownerRange[mpiRank];
-  int upper = ownerRange[mpiRank + 1];
+  // Get the location of each received block and the matrix data
+  const int *plan;
+  TacsScalar *recv_A;
+  getIncomingScatter(mat, &plan, &recv_A);
+  TacsScalar *data[SCATTER_NUM_TARGETS];
+  getBlockData(mat, data);
 
   for (int i = 0; i < num_in_procs; i++) {
     // Get the recv that just completed
     int index;
     MPI_Status status;
+    double t0 = TACSCommProfiler::beginWait();
     int ierr = MPI_Waitany(num_in_procs, in_requests, &index, &status);
+    TACSCommProfiler::endWait(TACS_COMM_MAT_ASSEMBLY, t0);
 
     // Check whether the recv was successful
     if (ierr != MPI_SUCCESS) {
@@ -1231,30 +1754,17 @@ void TACSMatDistribute::endAssembly(TACSParallelMat *mat) {
               mpiRank, err_str);
     }
 
-    // Identify which group of rows were just recv'd from another
-    // processor
-    for (int j = in_row_ptr[index]; j < in_row_ptr[index + 1]; j++) {
-      // Find the local index of the row
-      int row = in_rows[j] - lower;
-
-      // Find the local row index
-      for (int k = in_rowp[j]; k < in_rowp[j + 1]; k++) {
-        TacsScalar *a = &in_A[b2 * k];
-
-        // Set the column indices
-        int col = in_cols[k];
-        if (col >= lower && col < upper) {
-          // Get the local column index
-          col = col - lower;
-          Aloc->addBlockRowValues(row, 1, &col, a);
-        } else {
-          // Use the map from the global column index back to the
-          // processor
-          int *item = TacsSearchArray(col, col_map_size, col_map_vars);
-          if (item) {
-            int c = item - col_map_vars;
-            Bext->addBlockRowValues(row - Np, 1, &c, a);
-          }
+    // Add the blocks from the group of rows that were just recv'd
+    // from another processor
+    int start = in_rowp[in_row_ptr[index]];
+    int end = in_rowp[in_row_ptr[index + 1]];
+    for (int k = start; k < end; k++) {
+      if (plan[k] >= 0) {
+        const TacsScalar *a = &recv_A[b2 * k];
+        TacsScalar *v = &data[plan[k] % SCATTER_NUM_TARGETS]
+                             [b2 * (plan[k] / SCATTER_NUM_TARGETS)];
+        for (int jj = 0; jj < b2; jj++) {
+          v[jj] += a[jj];
         }
       }
     }
@@ -1262,6 +1772,8 @@ void TACSMatDistribute::endAssembly(TACSParallelMat *mat) {
 
   // Wait for all the sending requests
   if (num_ext_procs > 0) {
+    double t0 = TACSCommProfiler::beginWait();
     MPI_Waitall(num_ext_procs, ext_requests, MPI_STATUSES_IGNORE);
+    TACSCommProfiler::endWait(TACS_COMM_MAT_ASSEMBLY, t0);
   }
 }
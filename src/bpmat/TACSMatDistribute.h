@@ -28,9 +28,24 @@ class TACSParallelMat;
 /*
   Distribute components of a matrix from a local CSR format to a global
   distributed format compatible with TACSParallelMat.
+
+  The exchange of the off-processor entries is fixed when the object
+  is created: the blocks for other processors are written directly
+  into the send buffer (see computeElementScatter()), the sends and
+  receives use persistent requests, and the received blocks are added
+  to the matrix using their precomputed locations.
 */
 class TACSMatDistribute : public TACSObject {
  public:
+  // The storage that contains an encoded block location, see
+  // getBlockLocation()
+  enum ScatterTarget {
+    SCATTER_ALOC = 0,
+    SCATTER_BEXT = 1,
+    SCATTER_EXT = 2,
+    SCATTER_NUM_TARGETS = 3
+  };
+
   TACSMatDistribute(TACSThreadInfo *thread_info, TACSNodeMap *rmap, int bsize,
                     int num_nodes, const int *rowp, const int *cols,
                     TACSBVecIndices *bindex, BCSRMat **_Aloc, BCSRMat **_Bext,
@@ -50,6 +65,30 @@ class TACSMatDistribute : public TACSObject {
                        int mv, const TacsScalar *values,
                        MatrixOrientation matOr = TACS_MAT_NORMAL);
 
+  // Precompute/use the locations of element blocks in the matrix
+  // --------------------------------------------------------------
+  void computeElementScatter(TACSParallelMat *mat, int num_elements,
+                             const int *elem_ptr, const int *elem_nodes);
+  void clearElementScatter();
+  size_t getElementScatterMemory();
+  int addElementValues(TACSParallelMat *mat, const int *elem_ptr, int elem,
+                       int mv, const TacsScalar *values, int nblocks = 0,
+                       const int *blocks = NULL);
+
+  // Locate single blocks in the local or external storage
+  // ------------------------------------------------------
+  int getBlockLocation(TACSParallelMat *mat, int row, int col);
+  void getBlockData(TACSParallelMat *mat, TacsScalar *data[]);
+
+  // Access the data used to assemble the matrix on the device
+  // ----------------------------------------------------------
+  int getElementScatter(const int *elem_ptr, const int **_ptr,
+                        const int **_plan);
+  int getExtValues(TacsScalar **_ext_A);
+  int getIncomingScatter(TACSParallelMat *mat, const int **_plan,
+                         TacsScalar **_in_A);
+  void endAssemblyTransfer();
+
   // Set values into the matrix from the local BCSRMat
   // -------------------------------------------------
   void setValues(TACSParallelMat *mat, int nvars, const int *ext_vars,
@@ -67,6 +106,9 @@ class TACSMatDistribute : public TACSObject {
                        int **_Arowp, int **_Acols, int *_Np, int **_Browp,
                        int **_Bcols);
 
+  // Create the persistent requests for the assembly
+  void initAssemblyRequests();
+
   // Variables for the column map
   // ----------------------------
   int col_map_size;
@@ -91,7 +133,15 @@ class TACSMatDistribute : public TACSObject {
   int *ext_rowp;              // Pointer into the rows
   int *ext_cols;              // Global column indices
   TacsScalar *ext_A;          // Pointer to the data accumulated on this proc
-  MPI_Request *ext_requests;  // Requests for sending info
+  MPI_Request *ext_requests;  // Persistent requests for sending info
+
+  // Element scatter plan: the encoded block location for each pair
+  // of nodes in each element, see computeElementScatter()
+  // ----------------------------------------------------------------
+  const int *scatter_key;    // Connectivity used to compute the plan
+  int scatter_num_elements;  // Number of elements in the plan
+  int *scatter_ptr;          // Offset into the plan for each element
+  int *scatter_plan;         // Encoded block locations
 
   // Data received from other processes
   // ----------------------------------
@@ -103,8 +153,9 @@ class TACSMatDistribute : public TACSObject {
   int *in_rows;      // Row numbers for each row (num_in_rows)
   int *in_rowp;      // Pointer into the column numbers (num_in_rows)
   int *in_cols;      // Global column indices
-  MPI_Request *in_requests;  // Requests for recving data
+  MPI_Request *in_requests;  // Persistent requests for recving data
   TacsScalar *in_A;
+  int *in_plan;  // Encoded block locations for in_A, see getIncomingScatter()
 };
 
 #endif  // TACS_MAT_DISTRIBUTE_H
@@ -45,7 +45,18 @@ TACSNodeMap::TACSNodeMap(MPI_Comm _comm, int _N, NodeMapType _ntype) {
     MPI_Allgather(&N, 1, MPI_INT, &ownerRange[1], 1, MPI_INT, comm);
 
     // Set the ownership values so that they range over the owned
-    // unknown node numbers
+    // unknown node numbers. The node numbers are int, so check that
+    // the total is in range before forming the sums.
+    TacsGlobalIndex total = 0;
+    for (int i = 0; i < mpiSize; i++) {
+      total += ownerRange[i + 1];
+    }
+    if (total > INT_MAX) {
+      fprintf(stderr,
+              "[%d] TACSNodeMap: Number of nodes %lld exceeds the "
+              "maximum of %d\n",
+              mpiRank, (long long)total, INT_MAX);
+    }
     for (int i = 0; i < mpiSize; i++) {
       ownerRange[i + 1] += ownerRange[i];
     }
@@ -0,0 +1,385 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+
+#include "TACSPETScInterface.h"
+
+#ifdef TACS_HAS_PETSC
+
+// The PETSc scalar must have the same layout as TacsScalar
+#if defined(TACS_USE_COMPLEX) && !defined(PETSC_USE_COMPLEX)
+#error "The complex build of TACS requires PETSc with complex scalars"
+#elif !defined(TACS_USE_COMPLEX) && defined(PETSC_USE_COMPLEX)
+#error "The real build of TACS requires PETSc with real scalars"
+#endif
+#if !defined(PETSC_USE_REAL_DOUBLE)
+#error "TACS requires PETSc with double-precision scalars"
+#endif
+
+/*
+  Create a PETSc vector that uses the local values of the TACSBVec as
+  its storage. No values are copied, so the changes to either vector
+  are visible in the other. The PETSc vector must be destroyed with
+  VecDestroy() before the TACSBVec is deleted.
+
+  input:
+  vec:  the TACSBVec object
+
+  returns: the PETSc vector
+*/
+Vec TACSCreatePETScVec(TACSBVec *vec) {
+  TacsScalar *array;
+  int size = vec->getArray(&array);
+
+  Vec v = NULL;
+  VecCreateMPIWithArray(vec->getMPIComm(), vec->getBlockSize(), size,
+                        PETSC_DECIDE, (PetscScalar *)array, &v);
+  return v;
+}
+
+/*
+  Create the PETSc preconditioner for the given matrix.
+
+  The PETSc library is initialized without arguments if this has not
+  already been done. The PC type and its parameters are set from the
+  PETSc options database when the object is created.
+
+  input:
+  mat:        the matrix
+  prefix:     the (optional) prefix for the PETSc options
+  use_shell:  use a MATSHELL matrix instead of an assembled copy
+*/
+TACSPETScPc::TACSPETScPc(TACSParallelMat *_mat, const char *prefix,
+                         int _use_shell) {
+  mat = _mat;
+  mat->incref();
+  use_shell = _use_shell;
+
+  PetscBool initialized;
+  PetscInitialized(&initialized);
+  if (!initialized) {
+    PetscInitializeNoArguments();
+  }
+
+  MPI_Comm comm = mat->getMPIComm();
+  int bsize, N;
+  mat->getRowMap(&bsize, &N, NULL);
+
+  // Create the vectors without storage. The arrays are placed in
+  // these vectors from the TACSBVec objects in applyFactor().
+  VecCreateMPIWithArray(comm, bsize, bsize * N, PETSC_DECIDE, NULL, &x);
+  VecCreateMPIWithArray(comm, bsize, bsize * N, PETSC_DECIDE, NULL, &y);
+
+  aloc_cols = bext_cols = NULL;
+  xtemp = ytemp = NULL;
+  A = NULL;
+  if (use_shell) {
+    createShell();
+  } else {
+    createBAIJ();
+  }
+
+  // Create the preconditioner and set the type from the options
+  PCCreate(comm, &pc);
+  if (prefix) {
+    PCSetOptionsPrefix(pc, prefix);
+  }
+  PCSetOperators(pc, A, A);
+  PCSetFromOptions(pc);
+}
+
+/*
+  Free the PETSc objects
+*/
+TACSPETScPc::~TACSPETScPc() {
+  PCDestroy(&pc);
+  MatDestroy(&A);
+  VecDestroy(&x);
+  VecDestroy(&y);
+  if (aloc_cols) {
+    delete[] aloc_cols;
+  }
+  if (bext_cols) {
+    delete[] bext_cols;
+  }
+  if (xtemp) {
+    xtemp->decref();
+  }
+  if (ytemp) {
+    ytemp->decref();
+  }
+  mat->decref();
+}
+
+/*
+  Create the MATMPIBAIJ matrix with the non-zero pattern of the
+  TACSParallelMat.
+
+  The rows of Aloc are the rows owned by this processor and the rows
+  of Bext are the last Nc of these rows. The global block column
+  indices are computed once here and used each time the values are
+  set.
+*/
+void TACSPETScPc::createBAIJ() {
+  MPI_Comm comm = mat->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  int bsize, N, Nc;
+  mat->getRowMap(&bsize, &N, &Nc);
+  const int *owner_range;
+  mat->getRowMap()->getOwnerRange(&owner_range);
+
+  BCSRMat *Aloc, *Bext;
+  mat->getBCSRMat(&Aloc, &Bext);
+  const int *arowp, *acols, *browp, *bcols;
+  Aloc->getArrays(NULL, NULL, NULL, &arowp, &acols, NULL);
+  Bext->getArrays(NULL, NULL, NULL, &browp, &bcols, NULL);
+
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+  const int *ext_vars;
+  ext_dist->getIndices()->getIndices(&ext_vars);
+
+  // Compute the global block column indices
+  aloc_cols = new PetscInt[arowp[N] > 0 ? arowp[N] : 1];
+  for (int k = 0; k < arowp[N]; k++) {
+    aloc_cols[k] = owner_range[mpi_rank] + acols[k];
+  }
+  bext_cols = new PetscInt[browp[Nc] > 0 ? browp[Nc] : 1];
+  for (int k = 0; k < browp[Nc]; k++) {
+    bext_cols[k] = ext_vars[bcols[k]];
+  }
+
+  // Set the number of blocks in the diagonal and off-diagonal parts
+  // of each block row
+  PetscInt *d_nnz = new PetscInt[2 * N + 1];
+  PetscInt *o_nnz = &d_nnz[N];
+  for (int i = 0; i < N; i++) {
+    d_nnz[i] = arowp[i + 1] - arowp[i];
+    o_nnz[i] = 0;
+    if (i >= N - Nc) {
+      int ib = i - (N - Nc);
+      o_nnz[i] = browp[ib + 1] - browp[ib];
+    }
+  }
+
+  MatCreateBAIJ(comm, bsize, bsize * N, bsize * N, PETSC_DETERMINE,
+                PETSC_DETERMINE, 0, d_nnz, 0, o_nnz, &A);
+  MatSetOption(A, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_TRUE);
+  delete[] d_nnz;
+}
+
+/*
+  Copy the values from the TACSParallelMat into the MATMPIBAIJ matrix.
+
+  The blocks in TACS and the values passed to MatSetValuesBlocked()
+  are both stored in row-major order, so each block is set directly
+  from the TACS arrays.
+*/
+void TACSPETScPc::setBAIJValues() {
+  int mpi_rank;
+  MPI_Comm_rank(mat->getMPIComm(), &mpi_rank);
+
+  int bsize, N, Nc;
+  mat->getRowMap(&bsize, &N, &Nc);
+  const int b2 = bsize * bsize;
+  const int *owner_range;
+  mat->getRowMap()->getOwnerRange(&owner_range);
+
+  BCSRMat *Aloc, *Bext;
+  mat->getBCSRMat(&Aloc, &Bext);
+  const int *arowp, *browp;
+  TacsScalar *Avals, *Bvals;
+  Aloc->getArrays(NULL, NULL, NULL, &arowp, NULL, &Avals);
+  Bext->getArrays(NULL, NULL, NULL, &browp, NULL, &Bvals);
+
+  for (int i = 0; i < N; i++) {
+    PetscInt row = owner_range[mpi_rank] + i;
+    for (int k = arowp[i]; k < arowp[i + 1]; k++) {
+      MatSetValuesBlocked(A, 1, &row, 1, &aloc_cols[k],
+                          (PetscScalar *)&Avals[b2 * k], INSERT_VALUES);
+    }
+  }
+
+  for (int ib = 0; ib < Nc; ib++) {
+    PetscInt row = owner_range[mpi_rank] + N - Nc + ib;
+    for (int k = browp[ib]; k < browp[ib + 1]; k++) {
+      MatSetValuesBlocked(A, 1, &row, 1, &bext_cols[k],
+                          (PetscScalar *)&Bvals[b2 * k], INSERT_VALUES);
+    }
+  }
+
+  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+  MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
+}
+
+/*
+  Create the MATSHELL matrix that applies the products with the
+  TACSParallelMat
+*/
+void TACSPETScPc::createShell() {
+  int bsize, N;
+  mat->getRowMap(&bsize, &N, NULL);
+
+  xtemp = dynamic_cast<TACSBVec *>(mat->createVec());
+  ytemp = dynamic_cast<TACSBVec *>(mat->createVec());
+  xtemp->incref();
+  ytemp->incref();
+
+  MatCreateShell(mat->getMPIComm(), bsize * N, bsize * N, PETSC_DETERMINE,
+                 PETSC_DETERMINE, (void *)this, &A);
+  MatShellSetOperation(A, MATOP_MULT, (void (*)(void))shellMult);
+  MatShellSetOperation(A, MATOP_MULT_TRANSPOSE,
+                       (void (*)(void))shellMultTranspose);
+  MatShellSetOperation(A, MATOP_GET_DIAGONAL,
+                       (void (*)(void))shellGetDiagonal);
+}
+
+/*
+  Compute y = A*x for the MATSHELL matrix. The PETSc vectors are
+  copied to and from the temporary TACS vectors.
+*/
+PetscErrorCode TACSPETScPc::shellMult(Mat A, Vec x, Vec y) {
+  TACSPETScPc *self;
+  MatShellGetContext(A, &self);
+
+  TacsScalar *xt, *yt;
+  int size = self->xtemp->getArray(&xt);
+  self->ytemp->getArray(&yt);
+
+  const PetscScalar *xa;
+  VecGetArrayRead(x, &xa);
+  memcpy(xt, xa, size * sizeof(TacsScalar));
+  VecRestoreArrayRead(x, &xa);
+
+  self->mat->mult(self->xtemp, self->ytemp);
+
+  PetscScalar *ya;
+  VecGetArray(y, &ya);
+  memcpy(ya, yt, size * sizeof(TacsScalar));
+  VecRestoreArray(y, &ya);
+
+  return 0;
+}
+
+/*
+  Compute y = A^{T}*x for the MATSHELL matrix
+*/
+PetscErrorCode TACSPETScPc::shellMultTranspose(Mat A, Vec x, Vec y) {
+  TACSPETScPc *self;
+  MatShellGetContext(A, &self);
+
+  TacsScalar *xt, *yt;
+  int size = self->xtemp->getArray(&xt);
+  self->ytemp->getArray(&yt);
+
+  const PetscScalar *xa;
+  VecGetArrayRead(x, &xa);
+  memcpy(xt, xa, size * sizeof(TacsScalar));
+  VecRestoreArrayRead(x, &xa);
+
+  self->mat->multTranspose(self->xtemp, self->ytemp);
+
+  PetscScalar *ya;
+  VecGetArray(y, &ya);
+  memcpy(ya, yt, size * sizeof(TacsScalar));
+  VecRestoreArray(y, &ya);
+
+  return 0;
+}
+
+/*
+  Extract the diagonal of the MATSHELL matrix from the diagonal blocks
+  of Aloc
+*/
+PetscErrorCode TACSPETScPc::shellGetDiagonal(Mat A, Vec d) {
+  TACSPETScPc *self;
+  MatShellGetContext(A, &self);
+
+  BCSRMat *Aloc;
+  self->mat->getBCSRMat(&Aloc, NULL);
+  int bsize, N;
+  const int *rowp, *cols;
+  TacsScalar *Avals;
+  Aloc->getArrays(&bsize, &N, NULL, &rowp, &cols, &Avals);
+  const int b2 = bsize * bsize;
+
+  PetscScalar *da;
+  VecGetArray(d, &da);
+  TacsScalar *diag = (TacsScalar *)da;
+  memset(diag, 0, bsize * N * sizeof(TacsScalar));
+  for (int i = 0; i < N; i++) {
+    for (int k = rowp[i]; k < rowp[i + 1]; k++) {
+      if (cols[k] == i) {
+        const TacsScalar *a = &Avals[b2 * k];
+        for (int j = 0; j < bsize; j++) {
+          diag[bsize * i + j] = a[(bsize + 1) * j];
+        }
+        break;
+      }
+    }
+  }
+  VecRestoreArray(d, &da);
+
+  return 0;
+}
+
+/*
+  Set up the PETSc preconditioner with the current matrix values
+*/
+void TACSPETScPc::factor() {
+  if (!use_shell) {
+    setBAIJValues();
+  }
+  PCSetOperators(pc, A, A);
+  PCSetUp(pc);
+}
+
+/*
+  Apply the PETSc preconditioner. The arrays of the TACSBVec objects
+  are placed directly in the PETSc vectors without a copy.
+*/
+void TACSPETScPc::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
+  TACSBVec *xvec, *yvec;
+  xvec = dynamic_cast<TACSBVec *>(txvec);
+  yvec = dynamic_cast<TACSBVec *>(tyvec);
+
+  if (xvec && yvec && xvec != yvec) {
+    TacsScalar *xa, *ya;
+    xvec->getArray(&xa);
+    yvec->getArray(&ya);
+
+    VecPlaceArray(x, (PetscScalar *)xa);
+    VecPlaceArray(y, (PetscScalar *)ya);
+    PCApply(pc, x, y);
+    VecResetArray(x);
+    VecResetArray(y);
+  } else {
+    fprintf(stderr,
+            "TACSPETScPc type error: Input/output must be distinct "
+            "TACSBVec objects\n");
+  }
+}
+
+/*
+  Retrieve the underlying matrix
+*/
+void TACSPETScPc::getMat(TACSMat **_mat) { *_mat = mat; }
+
+#endif  // TACS_HAS_PETSC
@@ -0,0 +1,98 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+
+#ifndef TACS_PETSC_INTERFACE_H
+#define TACS_PETSC_INTERFACE_H
+
+/*
+  An interface to the preconditioners in PETSc. This is only compiled
+  when TACS_HAS_PETSC is defined in Makefile.in. PETSc must use the
+  same scalar type as TACS: real for the real build and complex for
+  the complex build.
+*/
+
+#ifdef TACS_HAS_PETSC
+
+#include <petscpc.h>
+
+#include "TACSBVec.h"
+#include "TACSParallelMat.h"
+
+// Create a PETSc vector that shares the local values of a TACSBVec
+Vec TACSCreatePETScVec(TACSBVec *vec);
+
+/*
+  A preconditioner that applies a PETSc PC to a TACSParallelMat.
+
+  The PC is configured from the PETSc options database with the given
+  options prefix, for instance "-pc_type hypre -pc_hypre_type
+  boomeramg" or "-pc_type gamg". By default, the matrix is assembled in
+  a PETSc MATMPIBAIJ matrix, which is required by the algebraic
+  multigrid methods. Alternatively, a MATSHELL matrix applies the
+  products with the TACSParallelMat directly without storing a copy of
+  the matrix, but only supports the PCs that require the products and
+  the diagonal, such as PCJACOBI or PCNONE.
+*/
+class TACSPETScPc : public TACSPc {
+ public:
+  TACSPETScPc(TACSParallelMat *_mat, const char *prefix = NULL,
+              int _use_shell = 0);
+  ~TACSPETScPc();
+
+  // Functions required by TACSPc
+  // ----------------------------
+  void factor();
+  void applyFactor(TACSVec *xvec, TACSVec *yvec);
+  void getMat(TACSMat **_mat);
+
+  // Access the underlying PETSc objects
+  // -----------------------------------
+  Mat getPETScMat() { return A; }
+  PC getPETScPC() { return pc; }
+
+ private:
+  // Create the PETSc matrix and copy the values from the TACS matrix
+  void createBAIJ();
+  void setBAIJValues();
+  void createShell();
+
+  // The matrix operations for the MATSHELL matrix
+  static PetscErrorCode shellMult(Mat A, Vec x, Vec y);
+  static PetscErrorCode shellMultTranspose(Mat A, Vec x, Vec y);
+  static PetscErrorCode shellGetDiagonal(Mat A, Vec d);
+
+  // The matrix
+  TACSParallelMat *mat;
+  int use_shell;
+
+  // The global block column indices of the entries in Aloc and Bext
+  PetscInt *aloc_cols, *bext_cols;
+
+  // Temporary vectors for the products with the MATSHELL matrix
+  TACSBVec *xtemp, *ytemp;
+
+  // The PETSc objects. The vectors x and y do not have their own
+  // storage and are used to wrap the arrays of the TACSBVec objects.
+  Mat A;
+  PC pc;
+  Vec x, y;
+};
+
+#endif  // TACS_HAS_PETSC
+#endif  // TACS_PETSC_INTERFACE_H
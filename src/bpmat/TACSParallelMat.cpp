@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 
+#include "TacsUtilities.h"
 #include "tacslapack.h"
 
 /*!
@@ -91,6 +92,13 @@ void TACSParallelMat::init(TACSNodeMap *_rmap, BCSRMat *_Aloc, BCSRMat *_Bext,
   // No external column map
   ext_dist = NULL;
   x_ext = NULL;
+  num_seg_procs = 0;
+  seg_ptr = segs = NULL;
+
+  // The SELL storage is not used by default
+  Asell = Bsell = NULL;
+  sell_chunk_size = sell_sigma = 0;
+  sell_stale = 1;
 
   N = Aloc->getRowDim();
   if (N != Aloc->getColDim()) {
@@ -134,6 +142,85 @@ void TACSParallelMat::init(TACSNodeMap *_rmap, BCSRMat *_Aloc, BCSRMat *_Bext,
   x_ext = new TacsScalar[len];
   memset(x_ext, 0, len * sizeof(TacsScalar));
   ext_offset = bsize * Np;
+
+  initExtSegments();
+}
+
+/*
+  Set up the segments of the external matrix that multiply the values
+  from each processor.
+
+  The entries in each row of Bext are sorted by column, and the
+  values from each processor occupy a contiguous range of columns, so
+  the blocks that multiply the values from one processor form a
+  single segment in each row. No segments are created if the values
+  from all processors can only be received at once.
+*/
+void TACSParallelMat::initExtSegments() {
+  num_seg_procs = ext_dist->getNumExtProcs();
+  if (num_seg_procs <= 0) {
+    num_seg_procs = 0;
+    return;
+  }
+
+  // Set the group for each external node. Group 0 contains the nodes
+  // whose values are available immediately.
+  int next = ext_dist->getNumNodes();
+  int *group = new int[next];
+  memset(group, 0, next * sizeof(int));
+  for (int p = 0; p < num_seg_procs; p++) {
+    int start, end;
+    ext_dist->getExtProcRange(p, &start, &end);
+    for (int j = start; j < end; j++) {
+      group[j] = p + 1;
+    }
+  }
+
+  int bs, nrows, ncols;
+  const int *rowp, *cols;
+  TacsScalar *A;
+  Bext->getArrays(&bs, &nrows, &ncols, &rowp, &cols, &A);
+
+  // Count up the number of segments in each group
+  int ngroups = num_seg_procs + 1;
+  seg_ptr = new int[ngroups + 1];
+  memset(seg_ptr, 0, (ngroups + 1) * sizeof(int));
+  for (int i = 0; i < nrows; i++) {
+    int k = rowp[i];
+    while (k < rowp[i + 1]) {
+      int g = group[cols[k]];
+      while (k < rowp[i + 1] && group[cols[k]] == g) {
+        k++;
+      }
+      seg_ptr[g + 1]++;
+    }
+  }
+  for (int g = 0; g < ngroups; g++) {
+    seg_ptr[g + 1] += seg_ptr[g];
+  }
+
+  // Fill in the segments
+  segs = new int[3 * seg_ptr[ngroups]];
+  int *count = new int[ngroups];
+  memcpy(count, seg_ptr, ngroups * sizeof(int));
+  for (int i = 0; i < nrows; i++) {
+    int k = rowp[i];
+    while (k < rowp[i + 1]) {
+      int g = group[cols[k]];
+      int kstart = k;
+      while (k < rowp[i + 1] && group[cols[k]] == g) {
+        k++;
+      }
+      int *sg = &segs[3 * count[g]];
+      sg[0] = i;
+      sg[1] = kstart;
+      sg[2] = k;
+      count[g]++;
+    }
+  }
+
+  delete[] count;
+  delete[] group;
 }
 
 TACSParallelMat::~TACSParallelMat() {
@@ -149,6 +236,12 @@ TACSParallelMat::~TACSParallelMat() {
   if (Bext) {
     Bext->decref();
   }
+  if (Asell) {
+    Asell->decref();
+  }
+  if (Bsell) {
+    Bsell->decref();
+  }
   if (ext_dist) {
     ext_dist->decref();
   }
@@ -158,6 +251,12 @@ TACSParallelMat::~TACSParallelMat() {
   if (x_ext) {
     delete[] x_ext;
   }
+  if (seg_ptr) {
+    delete[] seg_ptr;
+  }
+  if (segs) {
+    delete[] segs;
+  }
 }
 
 TACSMat *TACSParallelMat::createDuplicate() {
@@ -167,6 +266,9 @@ TACSMat *TACSParallelMat::createDuplicate() {
   TACSParallelMat *mat = new TACSParallelMat(rmap, Adup, Bdup, ext_dist);
   mat->mat_dist = mat_dist;
   mat->mat_dist->incref();
+  if (Asell) {
+    mat->setSellStorage(sell_chunk_size, sell_sigma);
+  }
 
   return mat;
 }
@@ -179,10 +281,22 @@ void TACSParallelMat::getSize(int *_nr, int *_nc) {
   *_nc = N * bsize;
 }
 
+/*!
+  Zero the values that are stored for the parallel assembly, but not
+  the entries of the matrix itself. Values added to the matrix after
+  this call are added to the existing matrix entries.
+*/
+void TACSParallelMat::zeroExtEntries() {
+  if (mat_dist) {
+    mat_dist->zeroEntries();
+  }
+}
+
 /*!
   Zero all matrix-entries
 */
 void TACSParallelMat::zeroEntries() {
+  sell_stale = 1;
   Aloc->zeroEntries();
   Bext->zeroEntries();
   if (mat_dist) {
@@ -196,6 +310,7 @@ void TACSParallelMat::zeroEntries() {
 void TACSParallelMat::copyValues(TACSMat *mat) {
   TACSParallelMat *pmat = dynamic_cast<TACSParallelMat *>(mat);
   if (pmat) {
+    sell_stale = 1;
     Aloc->copyValues(pmat->Aloc);
     Bext->copyValues(pmat->Bext);
   } else {
@@ -207,6 +322,7 @@ void TACSParallelMat::copyValues(TACSMat *mat) {
   Scale the entries in the other matrices by a given scalar
 */
 void TACSParallelMat::scale(TacsScalar alpha) {
+  sell_stale = 1;
   Aloc->scale(alpha);
   Bext->scale(alpha);
 }
@@ -217,6 +333,7 @@ void TACSParallelMat::scale(TacsScalar alpha) {
 void TACSParallelMat::axpy(TacsScalar alpha, TACSMat *mat) {
   TACSParallelMat *pmat = dynamic_cast<TACSParallelMat *>(mat);
   if (pmat) {
+    sell_stale = 1;
     Aloc->axpy(alpha, pmat->Aloc);
     Bext->axpy(alpha, pmat->Bext);
   } else {
@@ -230,6 +347,7 @@ void TACSParallelMat::axpy(TacsScalar alpha, TACSMat *mat) {
 void TACSParallelMat::axpby(TacsScalar alpha, TacsScalar beta, TACSMat *mat) {
   TACSParallelMat *pmat = dynamic_cast<TACSParallelMat *>(mat);
   if (pmat) {
+    sell_stale = 1;
     Aloc->axpby(alpha, beta, pmat->Aloc);
     Bext->axpby(alpha, beta, pmat->Bext);
   } else {
@@ -240,7 +358,10 @@ void TACSParallelMat::axpby(TacsScalar alpha, TacsScalar beta, TACSMat *mat) {
 /*
   Add a scalar to the diagonal
 */
-void TACSParallelMat::addDiag(TacsScalar alpha) { Aloc->addDiag(alpha); }
+void TACSParallelMat::addDiag(TacsScalar alpha) {
+  sell_stale = 1;
+  Aloc->addDiag(alpha);
+}
 
 /*!
   Matrix multiplication
@@ -256,14 +377,56 @@ void TACSParallelMat::mult(TACSVec *txvec, TACSVec *tyvec) {
     yvec->getArray(&y);
 
     ext_dist->beginForward(ctx, x, x_ext);
-    Aloc->mult(x, y);
-    ext_dist->endForward(ctx, x, x_ext);
-    Bext->multAdd(x_ext, &y[ext_offset], &y[ext_offset]);
+    if (Asell) {
+      updateSellValues();
+      Asell->mult(x, y);
+    } else {
+      Aloc->mult(x, y);
+    }
+    endForwardMultAdd(ctx, x, x_ext, &y[ext_offset]);
   } else {
     fprintf(stderr, "PMat type error: Input/output must be TACSBVec\n");
   }
 }
 
+/*!
+  Complete the forward transfer of the external values started with
+  beginForward() and add the product with the external matrix
+
+  y <- y + Bext*xext
+
+  where y is the part of the output for the coupling rows. When the
+  values from each processor can be received separately, the
+  contributions from each processor are added as its values arrive.
+  The context must be created by the external column map of this
+  matrix.
+*/
+void TACSParallelMat::endForwardMultAdd(TACSBVecDistCtx *_ctx, TacsScalar *x,
+                                        TacsScalar *xext, TacsScalar *y) {
+  if (segs) {
+    // Add the contributions from the values that are available
+    Bext->multAddSegments(seg_ptr[1], segs, xext, y);
+
+    int index;
+    while (ext_dist->endForwardAny(_ctx, x, xext, &index)) {
+      // Add the contributions from the processor, or from all the
+      // processors when all the values arrived at once
+      int first = (index >= 0 ? index + 1 : 1);
+      int last = (index >= 0 ? index + 1 : num_seg_procs);
+      Bext->multAddSegments(seg_ptr[last + 1] - seg_ptr[first],
+                            &segs[3 * seg_ptr[first]], xext, y);
+    }
+  } else {
+    ext_dist->endForward(_ctx, x, xext);
+    if (Bsell) {
+      updateSellValues();
+      Bsell->multAdd(xext, y, y);
+    } else {
+      Bext->multAdd(xext, y, y);
+    }
+  }
+}
+
 /*!
   Matrix multiplication
 */
@@ -277,8 +440,14 @@ void TACSParallelMat::multTranspose(TACSVec *txvec, TACSVec *tyvec) {
     xvec->getArray(&x);
     yvec->getArray(&y);
 
-    Bext->multTranspose(&x[ext_offset], x_ext);
-    Aloc->multTranspose(x, y);
+    if (Asell) {
+      updateSellValues();
+      Bsell->multTranspose(&x[ext_offset], x_ext);
+      Asell->multTranspose(x, y);
+    } else {
+      Bext->multTranspose(&x[ext_offset], x_ext);
+      Aloc->multTranspose(x, y);
+    }
 
     ext_dist->beginReverse(ctx, x_ext, y, TACS_ADD_VALUES);
     ext_dist->endReverse(ctx, x_ext, y, TACS_ADD_VALUES);
@@ -287,10 +456,63 @@ void TACSParallelMat::multTranspose(TACSVec *txvec, TACSVec *tyvec) {
   }
 }
 
+/*!
+  Matrix multiplication with multiple vectors
+
+  Compute y[i] <- A*x[i] for i = 0,...,nvecs-1 with a single pass over
+  the local matrix entries
+*/
+void TACSParallelMat::multMulti(int nvecs, TACSVec **txvecs,
+                                TACSVec **tyvecs) {
+  // Use the single-vector products if the SELL storage is in use or
+  // the vectors are not all TACSBVec objects
+  int use_multi = (Asell == NULL);
+  TacsScalar **x = new TacsScalar *[4 * nvecs];
+  TacsScalar **y = &x[nvecs];
+  TacsScalar **xext = &x[2 * nvecs];
+  TacsScalar **yext = &x[3 * nvecs];
+  for (int i = 0; i < nvecs && use_multi; i++) {
+    TACSBVec *xvec = dynamic_cast<TACSBVec *>(txvecs[i]);
+    TACSBVec *yvec = dynamic_cast<TACSBVec *>(tyvecs[i]);
+    if (xvec && yvec) {
+      xvec->getArray(&x[i]);
+      yvec->getArray(&y[i]);
+    } else {
+      use_multi = 0;
+    }
+  }
+
+  if (use_multi) {
+    int len = bsize * ext_dist->getNumNodes();
+    TacsScalar *ext = new TacsScalar[nvecs * len];
+
+    // Collect the external values for all vectors
+    for (int i = 0; i < nvecs; i++) {
+      xext[i] = &ext[i * len];
+      yext[i] = &y[i][ext_offset];
+      ext_dist->beginForward(ctx, x[i], xext[i]);
+      ext_dist->endForward(ctx, x[i], xext[i]);
+    }
+
+    Aloc->multMulti(nvecs, x, y);
+    Bext->multAddMulti(nvecs, xext, yext, yext);
+
+    delete[] ext;
+  } else {
+    for (int i = 0; i < nvecs; i++) {
+      mult(txvecs[i], tyvecs[i]);
+    }
+  }
+
+  delete[] x;
+}
+
 /*!
   Access the underlying matrices
 */
 void TACSParallelMat::getBCSRMat(BCSRMat **A, BCSRMat **B) {
+  // The entries may be modified through the returned matrices
+  sell_stale = 1;
   if (A) {
     *A = Aloc;
   }
@@ -342,6 +564,8 @@ void TACSParallelMat::getExtColMap(TACSBVecDistribute **ext_map) {
 */
 void TACSParallelMat::applyBCs(TACSBcMap *bcmap) {
   if (bcmap) {
+    sell_stale = 1;
+
     // Get the MPI rank and ownership range
     int mpi_rank;
     const int *ownerRange;
@@ -378,6 +602,8 @@ void TACSParallelMat::applyBCs(TACSBcMap *bcmap) {
 */
 void TACSParallelMat::applyTransposeBCs(TACSBcMap *bcmap) {
   if (bcmap) {
+    sell_stale = 1;
+
     // Get the MPI rank and ownership range
     int mpi_rank;
     const int *ownerRange;
@@ -433,7 +659,8 @@ void TACSParallelMat::applyTransposeBCs(TACSBcMap *bcmap) {
   Create a vector for the matrix
 */
 TACSVec *TACSParallelMat::createVec() {
-  return new TACSBVec(rmap, Aloc->getBlockSize());
+  return new TACSBVec(rmap, Aloc->getBlockSize(), NULL, NULL,
+                      Aloc->getThreadInfo());
 }
 
 /*!
@@ -548,6 +775,64 @@ void TACSParallelMat::addWeightValues(int nvars, const int *varp,
   }
 }
 
+/*
+  Add the element matrix using the precomputed element scatter plan
+
+  The element connectivity pointer must be the same pointer that was
+  passed to setElementScatter(). The matrix must be square and the
+  rows and columns are the element nodes.
+
+  input:
+  elem_ptr:  the element connectivity pointer used for the plan
+  elem:      the element index
+  mv:        the number of columns in the values matrix
+  values:    the dense element matrix
+  nblocks:   the number of non-zero node blocks (0 for all blocks)
+  blocks:    the (row, column) element node pairs for each block
+
+  returns:   1 if the values were added, 0 otherwise
+*/
+int TACSParallelMat::addElementValues(const int *elem_ptr, int elem, int mv,
+                                      const TacsScalar *values, int nblocks,
+                                      const int *blocks) {
+  if (mat_dist) {
+    return mat_dist->addElementValues(this, elem_ptr, elem, mv, values,
+                                      nblocks, blocks);
+  }
+  return 0;
+}
+
+/*
+  Compute the element scatter plan
+
+  The plan stores the location of each block of each element matrix
+  so that the element matrices can be added without searching the
+  non-zero pattern. The plan is shared by all duplicates of this
+  matrix. It remains valid as long as the element connectivity does
+  not change.
+
+  input:
+  num_elements:  the number of elements
+  elem_ptr:      pointer into the element connectivity
+  elem_nodes:    the global node numbers for each element
+*/
+void TACSParallelMat::setElementScatter(int num_elements, const int *elem_ptr,
+                                        const int *elem_nodes) {
+  if (mat_dist) {
+    mat_dist->computeElementScatter(this, num_elements, elem_ptr, elem_nodes);
+  }
+}
+
+/*
+  Get the memory in bytes used to store the element scatter plan
+*/
+size_t TACSParallelMat::getElementScatterMemory() {
+  if (mat_dist) {
+    return mat_dist->getElementScatterMemory();
+  }
+  return 0;
+}
+
 /*!
   Given a non-zero pattern, pass in the values for the array
 */
@@ -575,6 +860,56 @@ void TACSParallelMat::endAssembly() {
   if (mat_dist) {
     mat_dist->endAssembly(this);
   }
+  sell_stale = 1;
+}
+
+/*
+  Use SELL-C-sigma copies of the local matrix blocks for mult() and
+  multTranspose().
+
+  The SELL storage is created from the non-zero pattern of the Aloc
+  and Bext blocks. The BCSRMat blocks remain the primary copy of the
+  matrix and are used for all other operations, including the
+  factorization in the preconditioners. The values are copied into the
+  SELL storage before the first product after the entries have been
+  modified by any of the member functions of this class. Values added
+  with addValues() are only used after endAssembly() is called.
+
+  input:
+  chunk_size:  the number of rows in each chunk, <= 0 to disable
+  sigma:       the size of the window used to sort the rows
+*/
+void TACSParallelMat::setSellStorage(int chunk_size, int sigma) {
+  if (Asell) {
+    Asell->decref();
+  }
+  if (Bsell) {
+    Bsell->decref();
+  }
+  Asell = Bsell = NULL;
+  sell_chunk_size = sell_sigma = 0;
+
+  if (chunk_size > 0) {
+    sell_chunk_size = chunk_size;
+    sell_sigma = sigma;
+    Asell = new BCSRMatSell(Aloc, chunk_size, sigma);
+    Asell->incref();
+    Bsell = new BCSRMatSell(Bext, chunk_size, sigma);
+    Bsell->incref();
+  }
+  sell_stale = 0;
+}
+
+/*
+  Copy the values into the SELL storage if the entries of the matrix
+  have been modified since the last copy
+*/
+void TACSParallelMat::updateSellValues() {
+  if (sell_stale) {
+    Asell->setValues(Aloc);
+    Bsell->setValues(Bext);
+    sell_stale = 0;
+  }
 }
 
 const char *TACSParallelMat::getObjectName() { return matName; }
@@ -627,6 +962,10 @@ TACSGaussSeidel::TACSGaussSeidel(TACSParallelMat *_mat, int _zero_guess,
   iters = _iters;
   symmetric = _symmetric;
   use_l1_gauss_seidel = _use_l1_gauss_seidel;
+
+  use_multicolor = 0;
+  num_int_colors = num_ext_colors = 0;
+  color_ptr = color_rows = NULL;
 }
 
 /*
@@ -642,6 +981,139 @@ TACSGaussSeidel::~TACSGaussSeidel() {
   if (bvec) {
     bvec->decref();
   }
+  if (color_ptr) {
+    delete[] color_ptr;
+    delete[] color_rows;
+  }
+}
+
+/*
+  Set whether to use a multicolor ordering of the sweeps
+
+  The rows of the local matrix are colored so that no two rows of the
+  same color are coupled. Each color is then updated concurrently by
+  the threads of the matrix, while the colors are visited in sequence.
+  The interior rows and the coupling rows, which depend on the values
+  from other processors through Bext, are colored separately. The
+  interior colors are swept while the external values are in transit,
+  and the coupling colors are swept with the right-hand-side corrected
+  by the Bext contribution, as in the sequential smoother.
+
+  The result differs from the sequential sweep since the rows are
+  visited in a different order, but the smoothing properties are
+  similar for the usual finite-element matrices.
+*/
+void TACSGaussSeidel::setMultiColor(int flag) {
+  use_multicolor = flag;
+  if (!use_multicolor && color_ptr) {
+    delete[] color_ptr;
+    delete[] color_rows;
+    color_ptr = color_rows = NULL;
+    num_int_colors = num_ext_colors = 0;
+  }
+}
+
+/*
+  Get the total number of colors, or 0 if the coloring is not used
+*/
+int TACSGaussSeidel::getNumColors() {
+  return num_int_colors + num_ext_colors;
+}
+
+/*
+  Color the interior and coupling rows of the local matrix with the
+  greedy multicolor algorithm
+*/
+void TACSGaussSeidel::computeColoring() {
+  int bsize, N, Nc;
+  mat->getRowMap(&bsize, &N, &Nc);
+  BCSRMatData *data = Aloc->getMatData();
+
+  color_ptr = new int[N + 2];
+  color_rows = new int[N];
+  int *rowp = new int[N + 1];
+  int *cols = new int[data->rowp[N]];
+  int *colors = new int[N];
+  int *new_vars = new int[N];
+
+  // Color the interior rows [0, N - Nc) and the coupling rows
+  // [N - Nc, N), only keeping the couplings within each set
+  int ncolors = 0;
+  for (int k = 0; k < 2; k++) {
+    int start = (k == 0 ? 0 : N - Nc);
+    int end = (k == 0 ? N - Nc : N);
+    int n = end - start;
+
+    rowp[0] = 0;
+    for (int i = start; i < end; i++) {
+      int p = rowp[i - start];
+      for (int jp = data->rowp[i]; jp < data->rowp[i + 1]; jp++) {
+        int j = data->cols[jp];
+        if (j >= start && j < end && j != i) {
+          cols[p] = j - start;
+          p++;
+        }
+      }
+      rowp[i - start + 1] = p;
+    }
+
+    int nc = 0;
+    if (n > 0) {
+      nc = TacsComputeSerialMultiColor(n, rowp, cols, colors, new_vars);
+    }
+
+    // Set the pointer into the rows for each color
+    for (int c = 0; c <= nc; c++) {
+      color_ptr[ncolors + c] = start;
+    }
+    for (int i = 0; i < n; i++) {
+      color_ptr[ncolors + colors[i] + 1]++;
+    }
+    for (int c = 0; c < nc; c++) {
+      color_ptr[ncolors + c + 1] += color_ptr[ncolors + c] - start;
+    }
+    for (int i = 0; i < n; i++) {
+      color_rows[start + new_vars[i]] = start + i;
+    }
+
+    if (k == 0) {
+      num_int_colors = nc;
+    } else {
+      num_ext_colors = nc;
+    }
+    ncolors += nc;
+  }
+
+  delete[] rowp;
+  delete[] cols;
+  delete[] colors;
+  delete[] new_vars;
+}
+
+/*
+  Apply a forward or reverse sweep to the interior or coupling rows
+*/
+void TACSGaussSeidel::applySweep(int coupling, int reverse,
+                                 const TacsScalar *b, TacsScalar *y) {
+  if (color_ptr) {
+    if (coupling) {
+      Aloc->applyColoredSOR(num_ext_colors, &color_ptr[num_int_colors],
+                            color_rows, omega, b, y, reverse);
+    } else {
+      Aloc->applyColoredSOR(num_int_colors, color_ptr, color_rows, omega, b,
+                            y, reverse);
+    }
+  } else {
+    int bsize, N, Nc;
+    mat->getRowMap(&bsize, &N, &Nc);
+    int start = (coupling ? N - Nc : 0);
+    int end = (coupling ? N : N - Nc);
+    if (reverse) {
+      Aloc->applySOR(NULL, end, start, N - Nc, omega, b, NULL, y);
+    } else {
+      Aloc->applySOR(NULL, start, end, N - Nc, omega, b, NULL, y);
+    }
+  }
 }
 
 /*
@@ -721,11 +1193,41 @@ void TACSGaussSeidel::factor() {
   // Factor the diagonal
   Aloc->factorDiag(diag);
 
+  // The non-zero pattern is fixed, so the coloring is only computed once
+  if (use_multicolor && !color_ptr) {
+    computeColoring();
+  }
+
   if (diag) {
     delete[] diag;
   }
 }
 
+/*
+  Finish sending the external-interface unknowns and compute the
+  right-hand-side for the coupling rows
+
+  b = x - Bext*yext
+
+  The contributions from each processor are added as they arrive.
+  Since yext does not change during a sweep, the right-hand-side can
+  also be used for the reverse sweep.
+*/
+void TACSGaussSeidel::endExtRHS(TacsScalar *x, TacsScalar *y, TacsScalar *b) {
+  int bsize, N, Nc;
+  mat->getRowMap(&bsize, &N, &Nc);
+  int size = bsize * Nc;
+
+  TacsScalar *bc = &b[ext_offset];
+  memset(bc, 0, size * sizeof(TacsScalar));
+  mat->endForwardMultAdd(ctx, y, yext, bc);
+
+  const TacsScalar *xc = &x[ext_offset];
+  for (int i = 0; i < size; i++) {
+    bc[i] = xc[i] - bc[i];
+  }
+}
+
 /*!
   Apply the preconditioner to the input vector.
 
@@ -757,43 +1259,38 @@ void TACSGaussSeidel::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
     int bsize, N, Nc;
     mat->getRowMap(&bsize, &N, &Nc);
 
-    // Set the start/end values for the A-matrix
-    const int start = 0;
-    const int end = N - Nc;
-    const int offset = N - Nc;
-
-    // Set the start/end values for the B-matrix
-    const int bstart = end;
-    const int bend = N;
-
     if (symmetric) {
       if (zero_guess) {
         yvec->zeroEntries();
-        Aloc->applySOR(x, y, omega, 1);
+        applySweep(0, 0, x, y);
+        applySweep(1, 0, x, y);
 
+        // The external values are zero, so b = x for the coupling rows
         int ysize = bsize * ext_dist->getNumNodes();
         memset(yext, 0, ysize * sizeof(TacsScalar));
+        memcpy(&b[ext_offset], &x[ext_offset],
+               bsize * Nc * sizeof(TacsScalar));
       } else {
         // Begin sending the external-interface values
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega, x, NULL, y);
+        applySweep(0, 0, x, y);
 
         // Finish sending the external-interface unknowns
-        ext_dist->endForward(ctx, y, yext);
+        endExtRHS(x, y, b);
 
-        // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega, x, yext, y);
+        // Apply the smoother to the coupling part of the matrix
+        applySweep(1, 0, b, y);
       }
 
       // Reverse the smoother
-      Aloc->applySOR(Bext, bend, bstart, offset, omega, x, yext, y);
+      applySweep(1, 1, b, y);
 
       ext_dist->beginForward(ctx, y, yext);
 
       // Apply the smoother to the local part of the matrix
-      Aloc->applySOR(NULL, end, start, offset, omega, x, NULL, y);
+      applySweep(0, 1, x, y);
 
       // Finish sending the external-interface unknowns
       ext_dist->endForward(ctx, y, yext);
@@ -803,21 +1300,21 @@ void TACSGaussSeidel::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega, x, NULL, y);
+        applySweep(0, 0, x, y);
 
         // Finish sending the external-interface unknowns
-        ext_dist->endForward(ctx, y, yext);
+        endExtRHS(x, y, b);
 
-        // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega, x, yext, y);
+        // Apply the smoother to the coupling part of the matrix
+        applySweep(1, 0, b, y);
 
         // Reverse the smoother
-        Aloc->applySOR(Bext, bend, bstart, offset, omega, x, yext, y);
+        applySweep(1, 1, b, y);
 
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, end, start, offset, omega, x, NULL, y);
+        applySweep(0, 1, x, y);
 
         // Finish sending the external-interface unknowns
         ext_dist->endForward(ctx, y, yext);
@@ -825,19 +1322,20 @@ void TACSGaussSeidel::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
     } else {
       if (zero_guess) {
         yvec->zeroEntries();
-        Aloc->applySOR(x, y, omega, 1);
+        applySweep(0, 0, x, y);
+        applySweep(1, 0, x, y);
       } else {
         // Begin sending the external-interface values
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega, x, NULL, y);
+        applySweep(0, 0, x, y);
 
         // Finish sending the external-interface unknowns
-        ext_dist->endForward(ctx, y, yext);
+        endExtRHS(x, y, b);
 
-        // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega, x, yext, y);
+        // Apply the smoother to the coupling part of the matrix
+        applySweep(1, 0, b, y);
       }
 
       for (int i = 1; i < iters; i++) {
@@ -845,13 +1343,13 @@ void TACSGaussSeidel::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega, x, NULL, y);
+        applySweep(0, 0, x, y);
 
         // Finish sending the external-interface unknowns
-        ext_dist->endForward(ctx, y, yext);
+        endExtRHS(x, y, b);
 
-        // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega, x, yext, y);
+        // Apply the smoother to the coupling part of the matrix
+        applySweep(1, 0, b, y);
       }
     }
   } else {
@@ -874,15 +1372,12 @@ TACSChebyshevSmoother::TACSChebyshevSmoother(TACSMat *_mat, int _degree,
   mat = _mat;
   mat->incref();
 
-  // Create the vectors that are needed in the computation
-  TACSVec *tt = mat->createVec();
-  TACSVec *ht = mat->createVec();
-  TACSVec *rest = mat->createVec();
-
-  // Convert the vectors to TACSBVecs
-  t = dynamic_cast<TACSBVec *>(tt);
-  h = dynamic_cast<TACSBVec *>(ht);
-  res = dynamic_cast<TACSBVec *>(rest);
+  // Create the vectors that are needed in the computation. Only the
+  // TACSVec operations are used, so the vectors may be device vectors
+  // when the matrix is a TACSDeviceParallelMat.
+  t = mat->createVec();
+  h = mat->createVec();
+  res = mat->createVec();
   t->incref();
   h->incref();
   res->incref();
@@ -978,12 +1473,7 @@ void TACSChebyshevSmoother::factor() {
 /*
   Apply the Chebyshev smoother to the preconditioner
 */
-void TACSChebyshevSmoother::applyFactor(TACSVec *tx, TACSVec *ty) {
-  // Covert to TACSBVec objects
-  TACSBVec *x, *y;
-  x = dynamic_cast<TACSBVec *>(tx);
-  y = dynamic_cast<TACSBVec *>(ty);
-
+void TACSChebyshevSmoother::applyFactor(TACSVec *x, TACSVec *y) {
   if (x && y) {
     for (int i = 0; i < iters; i++) {
       // Compute the initial residual
@@ -1184,52 +1674,1357 @@ double TACSChebyshevSmoother::arnoldi(int size, TACSMat *pmat) {
   return rho;
 }
 
-/*!
-  Build the additive Schwarz preconditioner
+/*
+  Perform Arnoldi on the operator M^{-1}*A, starting from a random
+  vector. When rtol > 0, the iteration stops once the GMRES residual
+  for the starting vector falls below rtol. The (m+1) x m Hessenberg
+  matrix is stored by column with a leading dimension of size+1.
+
+  @return The number of Arnoldi steps m
 */
-TACSAdditiveSchwarz::TACSAdditiveSchwarz(TACSParallelMat *_mat, int levFill,
-                                         double fill) {
-  mat = _mat;
-  mat->incref();
+static int TacsPolynomialArnoldi(TACSMat *mat, TACSPc *pc, int size,
+                                 double rtol, double *H) {
+  memset(H, 0, size * (size + 1) * sizeof(double));
 
-  // Get the underlying matrices in the distributed matrix class
-  BCSRMat *B;
-  mat->getBCSRMat(&Aloc, &B);
-  Aloc->incref();
+  // Allocate space for the vectors
+  TACSVec **W = new TACSVec *[size + 1];
+  for (int i = 0; i < size + 1; i++) {
+    W[i] = mat->createVec();
+    W[i]->incref();
+  }
+  TACSVec *t = NULL;
+  if (pc) {
+    t = mat->createVec();
+    t->incref();
+  }
 
-  // Form the preconditioner matrix for the on-processor (block-diagonal)
-  // components of the matrix. Incref the pointer to the matrix
-  Apc = new BCSRMat(mat->getMPIComm(), Aloc, levFill, fill);
-  Apc->incref();
+  // The Givens rotations used to estimate the GMRES residual
+  double *hcol = new double[size + 1];
+  double *cs = new double[size];
+  double *sn = new double[size];
 
-  alpha = 0.0;  // Diagonal scalar to be added to the preconditioner
+  // Create an initial random vector
+  W[0]->setRand(-1.0, 1.0);
+  W[0]->scale(1.0 / TacsRealPart(W[0]->norm()));
+
+  double res = 1.0;
+  int m = 0;
+  for (int i = 0; i < size; i++) {
+    if (pc) {
+      mat->mult(W[i], t);
+      pc->applyFactor(t, W[i + 1]);
+    } else {
+      mat->mult(W[i], W[i + 1]);
+    }
+
+    // Orthogonalize against the existing subspace
+    double *h = &H[i * (size + 1)];
+    for (int j = 0; j <= i; j++) {
+      h[j] = TacsRealPart(W[i + 1]->dot(W[j]));
+      W[i + 1]->axpy(-h[j], W[j]);
+    }
+    h[i + 1] = TacsRealPart(W[i + 1]->norm());
+    m = i + 1;
+
+    // Apply the rotations to a copy of the new column
+    for (int j = 0; j <= i + 1; j++) {
+      hcol[j] = h[j];
+    }
+    for (int j = 0; j < i; j++) {
+      double h1 = hcol[j], h2 = hcol[j + 1];
+      hcol[j] = cs[j] * h1 + sn[j] * h2;
+      hcol[j + 1] = -sn[j] * h1 + cs[j] * h2;
+    }
+    double r = sqrt(hcol[i] * hcol[i] + hcol[i + 1] * hcol[i + 1]);
+    if (r == 0.0) {
+      break;
+    }
+    cs[i] = hcol[i] / r;
+    sn[i] = hcol[i + 1] / r;
+    res *= fabs(sn[i]);
+
+    // Stop on convergence or when the Krylov subspace is invariant
+    if (res < rtol || h[i + 1] <= 1e-14 * r) {
+      break;
+    }
+    W[i + 1]->scale(1.0 / h[i + 1]);
+  }
+
+  for (int i = 0; i < size + 1; i++) {
+    W[i]->decref();
+  }
+  if (t) {
+    t->decref();
+  }
+  delete[] W;
+  delete[] hcol;
+  delete[] cs;
+  delete[] sn;
+
+  return m;
 }
 
 /*
-  Free the memory from the additive Schwarz preconditioner
+  Create the Chebyshev polynomial preconditioner
 */
-TACSAdditiveSchwarz::~TACSAdditiveSchwarz() {
-  mat->decref();
-  Aloc->decref();
-  Apc->decref();
+TACSChebyshevPc::TACSChebyshevPc(TACSMat *_mat, int _max_degree, TACSPc *_pc,
+                                 double _rtol, int _arnoldi_size,
+                                 double _upper_factor) {
+  mat = _mat;
+  mat->incref();
+  pc = _pc;
+  if (pc) {
+    pc->incref();
+  }
+
+  max_degree = (_max_degree > 1 ? _max_degree : 1);
+  arnoldi_size = (_arnoldi_size > 1 ? _arnoldi_size : 1);
+  rtol = _rtol;
+  upper_factor = _upper_factor;
+
+  alpha = beta = 0.0;
+  degree = 0;
+
+  r = mat->createVec();
+  d = mat->createVec();
+  t = mat->createVec();
+  s = mat->createVec();
+  r->incref();
+  d->incref();
+  t->incref();
+  s->incref();
 }
 
 /*
-  Add the diagonal shift factor to the preconditioner. The shift
-  defaults to zero
+  Free the Chebyshev polynomial preconditioner
 */
-void TACSAdditiveSchwarz::setDiagShift(TacsScalar _alpha) { alpha = _alpha; }
+TACSChebyshevPc::~TACSChebyshevPc() {
+  mat->decref();
+  if (pc) {
+    pc->decref();
+  }
+  r->decref();
+  d->decref();
+  t->decref();
+  s->decref();
+}
 
 /*
-  Factor the preconditioner by copying the values from the
-  block-diagonal matrix and then factoring the copy.
+  Factor the inner preconditioner, estimate the spectral interval of
+  M^{-1}*A and select the degree of the polynomial.
+
+  The interval is set from the extreme Ritz values. The smallest Ritz
+  value over-estimates the smallest eigenvalue, but the Chebyshev
+  residual polynomial is bounded by one on [0, alpha], so eigenvalues
+  below the interval are not amplified.
 */
-void TACSAdditiveSchwarz::factor() {
-  Apc->copyValues(Aloc);
-  if (alpha != 0.0) {
+void TACSChebyshevPc::factor() {
+  if (pc) {
+    pc->factor();
+  }
+
+  int size = arnoldi_size;
+  double *H = new double[size * (size + 1)];
+  int m = TacsPolynomialArnoldi(mat, pc, size, 0.0, H);
+
+  // Compute the Ritz values from the square Hessenberg matrix
+  double *eigreal = new double[m];
+  double *eigimag = new double[m];
+  int lwork = 4 * m;
+  double *work = new double[lwork];
+  int ldv = 1;
+  int ldh = size + 1;
+  int info = 0;
+  LAPACKdgeev("N", "N", &m, H, &ldh, eigreal, eigimag, NULL, &ldv, NULL, &ldv,
+              work, &lwork, &info);
+
+  double lmin = 0.0, lmax = 0.0;
+  for (int i = 0; i < m; i++) {
+    if (i == 0 || eigreal[i] < lmin) {
+      lmin = eigreal[i];
+    }
+    if (i == 0 || eigreal[i] > lmax) {
+      lmax = eigreal[i];
+    }
+  }
+
+  delete[] eigreal;
+  delete[] eigimag;
+  delete[] work;
+  delete[] H;
+
+  if (info != 0 || lmax <= 0.0) {
+    fprintf(stderr,
+            "TACSChebyshevPc: Unable to estimate the spectrum, info = %d\n",
+            info);
+    lmax = 1.0;
+    lmin = 0.0;
+  }
+
+  // Limit the ratio of the interval to guard against zero or
+  // negative Ritz values
+  beta = upper_factor * lmax;
+  alpha = lmin;
+  if (alpha < 1e-6 * beta) {
+    alpha = 1e-6 * beta;
+  }
+
+  // Select the smallest degree such that the Chebyshev bound
+  // 2*sigma^k/(1 + sigma^{2k}) <= rtol over [alpha, beta]
+  double kappa = sqrt(beta / alpha);
+  double sigma = (kappa - 1.0) / (kappa + 1.0);
+  degree = max_degree;
+  if (rtol > 0.0 && rtol < 1.0 && sigma > 0.0) {
+    double k = ceil(log(0.5 * rtol) / log(sigma));
+    if (k < max_degree) {
+      degree = (k > 1.0 ? (int)k : 1);
+    }
+  }
+}
+
+/*
+  Apply the operator out = M^{-1}*A*in
+*/
+void TACSChebyshevPc::applyOp(TACSVec *in, TACSVec *out) {
+  if (pc) {
+    mat->mult(in, s);
+    pc->applyFactor(s, out);
+  } else {
+    mat->mult(in, out);
+  }
+}
+
+/*
+  Apply the Chebyshev iteration with a zero initial guess to the
+  preconditioned system M^{-1}*A*y = M^{-1}*x
+*/
+void TACSChebyshevPc::applyFactor(TACSVec *x, TACSVec *y) {
+  double theta = 0.5 * (beta + alpha);
+  double delta = 0.5 * (beta - alpha);
+  double sigma = theta / delta;
+  double rho = 1.0 / sigma;
+
+  // r = M^{-1}*x
+  if (pc) {
+    pc->applyFactor(x, r);
+  } else {
+    r->copyValues(x);
+  }
+
+  // d = r/theta, y = d
+  d->copyValues(r);
+  d->scale(1.0 / theta);
+  y->copyValues(d);
+
+  for (int k = 1; k < degree; k++) {
+    // r <- r - M^{-1}*A*d
+    applyOp(d, t);
+    r->axpy(-1.0, t);
+
+    // d <- rho_new*rho*d + (2*rho_new/delta)*r
+    double rho_new = 1.0 / (2.0 * sigma - rho);
+    d->axpby(2.0 * rho_new / delta, rho_new * rho, r);
+    y->axpy(1.0, d);
+    rho = rho_new;
+  }
+}
+
+/*
+  Retrieve the underlying matrix
+*/
+void TACSChebyshevPc::getMat(TACSMat **_mat) { *_mat = mat; }
+
+/*
+  Get the degree of the polynomial selected in factor()
+*/
+int TACSChebyshevPc::getDegree() { return degree; }
+
+/*
+  Create the GMRES polynomial preconditioner
+*/
+TACSGMRESPolynomialPc::TACSGMRESPolynomialPc(TACSMat *_mat, int _max_degree,
+                                             TACSPc *_pc, double _rtol) {
+  mat = _mat;
+  mat->incref();
+  pc = _pc;
+  if (pc) {
+    pc->incref();
+  }
+
+  max_degree = (_max_degree > 1 ? _max_degree : 1);
+  rtol = _rtol;
+
+  degree = nroots = 0;
+  root_re = new double[max_degree];
+  root_im = new double[max_degree];
+
+  prod = mat->createVec();
+  w = mat->createVec();
+  t = mat->createVec();
+  s = mat->createVec();
+  prod->incref();
+  w->incref();
+  t->incref();
+  s->incref();
+}
+
+/*
+  Free the GMRES polynomial preconditioner
+*/
+TACSGMRESPolynomialPc::~TACSGMRESPolynomialPc() {
+  mat->decref();
+  if (pc) {
+    pc->decref();
+  }
+  delete[] root_re;
+  delete[] root_im;
+  prod->decref();
+  w->decref();
+  t->decref();
+  s->decref();
+}
+
+/*
+  Factor the inner preconditioner and compute the roots of the GMRES
+  residual polynomial.
+
+  The roots are the harmonic Ritz values, which are the eigenvalues of
+  the generalized problem Hb^{T}*Hb*y = theta*H^{T}*y, where Hb is the
+  (m+1) x m Hessenberg matrix and H is its leading m x m block.
+*/
+void TACSGMRESPolynomialPc::factor() {
+  if (pc) {
+    pc->factor();
+  }
+
+  int size = max_degree;
+  double *H = new double[size * (size + 1)];
+  int m = TacsPolynomialArnoldi(mat, pc, size, rtol, H);
+  int ldh = size + 1;
+
+  // Form A = Hb^{T}*Hb and B = H^{T}
+  double *A = new double[m * m];
+  double *B = new double[m * m];
+  for (int j = 0; j < m; j++) {
+    for (int i = 0; i < m; i++) {
+      double a = 0.0;
+      for (int k = 0; k <= m; k++) {
+        a += H[k + i * ldh] * H[k + j * ldh];
+      }
+      A[i + j * m] = a;
+      B[i + j * m] = H[j + i * ldh];
+    }
+  }
+
+  double *alphar = new double[m];
+  double *alphai = new double[m];
+  double *betav = new double[m];
+  int lwork = 8 * m + 16;
+  double *work = new double[lwork];
+  int ldv = 1;
+  int info = 0;
+  LAPACKdggev("N", "N", &m, A, &m, B, &m, alphar, alphai, betav, NULL, &ldv,
+              NULL, &ldv, work, &lwork, &info);
+
+  // Collect the finite roots, storing one root from each conjugate pair
+  int nr = 0;
+  double *re = new double[m];
+  double *im = new double[m];
+  for (int i = 0; info == 0 && i < m; i++) {
+    if (betav[i] != 0.0 && alphai[i] >= 0.0) {
+      re[nr] = alphar[i] / betav[i];
+      im[nr] = alphai[i] / betav[i];
+      if (re[nr] != 0.0 || im[nr] != 0.0) {
+        nr++;
+      }
+    }
+  }
+
+  if (info != 0 || nr == 0) {
+    fprintf(stderr,
+            "TACSGMRESPolynomialPc: Unable to compute the roots, info = %d\n",
+            info);
+  }
+
+  // Order the roots with a modified Leja ordering to limit the growth
+  // of the intermediate products. The first root has the largest
+  // modulus, and each subsequent root maximizes the product of the
+  // distances to the roots (and conjugates) that are already selected.
+  int *used = new int[nr];
+  memset(used, 0, nr * sizeof(int));
+  nroots = 0;
+  degree = 0;
+  for (int k = 0; k < nr; k++) {
+    int next = -1;
+    double best = 0.0;
+    for (int i = 0; i < nr; i++) {
+      if (used[i]) {
+        continue;
+      }
+      double val = 0.0;
+      if (k == 0) {
+        val = log(sqrt(re[i] * re[i] + im[i] * im[i]));
+      } else {
+        for (int j = 0; j < nroots; j++) {
+          double dr = re[i] - root_re[j];
+          double di = im[i] - root_im[j];
+          double dc = im[i] + root_im[j];
+          val += 0.5 * log(dr * dr + di * di + 1e-300);
+          if (root_im[j] != 0.0) {
+            val += 0.5 * log(dr * dr + dc * dc + 1e-300);
+          }
+        }
+      }
+      if (next < 0 || val > best) {
+        next = i;
+        best = val;
+      }
+    }
+    used[next] = 1;
+    root_re[nroots] = re[next];
+    root_im[nroots] = im[next];
+    nroots++;
+    degree += (im[next] != 0.0 ? 2 : 1);
+  }
+
+  delete[] used;
+  delete[] re;
+  delete[] im;
+  delete[] alphar;
+  delete[] alphai;
+  delete[] betav;
+  delete[] work;
+  delete[] A;
+  delete[] B;
+  delete[] H;
+}
+
+/*
+  Apply the operator out = M^{-1}*A*in
+*/
+void TACSGMRESPolynomialPc::applyOp(TACSVec *in, TACSVec *out) {
+  if (pc) {
+    mat->mult(in, s);
+    pc->applyFactor(s, out);
+  } else {
+    mat->mult(in, out);
+  }
+}
+
+/*
+  Apply the polynomial y = p(M^{-1}*A)*M^{-1}*x.
+
+  The product prod = prod_{i} (I - M^{-1}*A/theta_{i})*M^{-1}*x is
+  updated one root at a time. Since 1 - z*p(z) is the product of the
+  factors, each real root adds prod/theta to y. Each conjugate pair
+  (a +/- ib) adds w = (2*a*prod - M^{-1}*A*prod)/(a^2 + b^2) to y and
+  updates prod <- prod - M^{-1}*A*w.
+*/
+void TACSGMRESPolynomialPc::applyFactor(TACSVec *x, TACSVec *y) {
+  if (pc) {
+    pc->applyFactor(x, prod);
+  } else {
+    prod->copyValues(x);
+  }
+
+  if (nroots == 0) {
+    y->copyValues(prod);
+    return;
+  }
+
+  y->zeroEntries();
+  int count = 0;
+  for (int i = 0; i < nroots; i++) {
+    double a = root_re[i];
+    double b = root_im[i];
+    if (b == 0.0) {
+      y->axpy(1.0 / a, prod);
+      count++;
+      if (count < degree) {
+        applyOp(prod, w);
+        prod->axpy(-1.0 / a, w);
+      }
+    } else {
+      double mod2 = a * a + b * b;
+      applyOp(prod, t);
+      w->copyValues(t);
+      w->axpby(2.0 * a / mod2, -1.0 / mod2, prod);
+      y->axpy(1.0, w);
+      count += 2;
+      if (count < degree) {
+        applyOp(w, t);
+        prod->axpy(-1.0, t);
+      }
+    }
+  }
+}
+
+/*
+  Retrieve the underlying matrix
+*/
+void TACSGMRESPolynomialPc::getMat(TACSMat **_mat) { *_mat = mat; }
+
+/*
+  Get the degree of the polynomial selected in factor()
+*/
+int TACSGMRESPolynomialPc::getDegree() { return degree; }
+
+/*!
+  Build the additive Schwarz preconditioner
+*/
+TACSAdditiveSchwarz::TACSAdditiveSchwarz(TACSParallelMat *_mat, int levFill,
+                                         double fill) {
+  mat = _mat;
+  mat->incref();
+
+  // Get the underlying matrices in the distributed matrix class
+  BCSRMat *B;
+  mat->getBCSRMat(&Aloc, &B);
+  Aloc->incref();
+
+  // Form the preconditioner matrix for the on-processor (block-diagonal)
+  // components of the matrix. Incref the pointer to the matrix
+  Apc = new BCSRMat(mat->getMPIComm(), Aloc, levFill, fill);
+  Apc->incref();
+
+  alpha = 0.0;  // Diagonal scalar to be added to the preconditioner
+  single_factor = 0;
+  real_factor = 0;
+  lev_fill = levFill;
+  fill_ratio = fill;
+
+  // No overlap by default
+  overlap = 0;
+  restricted = 1;
+  num_ovl_nodes = 0;
+  Aovl = NULL;
+  ovl_dist = NULL;
+  ovl_ctx = NULL;
+  ext_ovl_index = NULL;
+  xovl = yovl = NULL;
+  send_count = send_ptr = send_rows = NULL;
+  recv_count = recv_ptr = NULL;
+  recv_rowp = recv_cols = NULL;
+
+  // No coarse space by default
+  num_modes = 0;
+  Z = Zext = NULL;
+  mode_dropped = NULL;
+  num_nbrs = 0;
+  nbrs = NULL;
+  ext_nbr = NULL;
+  coarse_mat = NULL;
+  coarse_pc = NULL;
+  coarse_x = coarse_y = NULL;
+
+  temp = NULL;
+}
+
+/*
+  Free the memory from the additive Schwarz preconditioner
+*/
+TACSAdditiveSchwarz::~TACSAdditiveSchwarz() {
+  clearOverlap();
+  clearCoarseSpace();
+  mat->decref();
+  Aloc->decref();
+  Apc->decref();
+  if (temp) {
+    temp->decref();
+  }
+}
+
+/*
+  Add the diagonal shift factor to the preconditioner. The shift
+  defaults to zero
+*/
+void TACSAdditiveSchwarz::setDiagShift(TacsScalar _alpha) { alpha = _alpha; }
+
+/*
+  Store the ILU factorization in single precision. This halves the
+  memory required for the factor and the memory traffic in
+  applyFactor(), while the vectors and the arithmetic remain in double
+  precision. This is not available in complex mode.
+*/
+void TACSAdditiveSchwarz::setSinglePrecisionFactor(int _single_factor) {
+  single_factor = _single_factor;
+}
+
+/*
+  Factor only the real part of the matrix in complex mode. The ILU
+  factorization is computed in real arithmetic and applied to the real
+  and imaginary parts of the vectors separately. This is an effective
+  preconditioner for complex-step derivatives at a fraction of the cost
+  of the complex factorization. This has no effect in real mode.
+*/
+void TACSAdditiveSchwarz::setRealPartFactor(int _real_factor) {
+  real_factor = _real_factor;
+}
+
+/*
+  Retrieve the non-zero pattern of the rows of the given nodes from
+  the processors that own them. The nodes must be sorted and must not
+  be owned by this processor. The global column indices of the rows are
+  returned in the same order as the input nodes.
+
+  If the plan arrays are provided, the rows requested by each processor
+  and the number of blocks sent to/received from each processor are
+  returned so that the values can be transferred with the same pattern.
+  This is collective on the communicator of the matrix.
+*/
+static void TacsGetExtRows(TACSParallelMat *mat, int num_nodes,
+                           const int *nodes, int **_rowp, int **_cols,
+                           int **_send_count, int **_send_ptr,
+                           int **_send_rows, int **_recv_count,
+                           int **_recv_ptr) {
+  MPI_Comm comm = mat->getMPIComm();
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  const int *range;
+  mat->getRowMap()->getOwnerRange(&range);
+
+  int bsize, n, nc;
+  mat->getRowMap(&bsize, &n, &nc);
+
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  const int *arowp, *acols, *browp, *bcols;
+  A->getArrays(NULL, NULL, NULL, &arowp, &acols, NULL);
+  B->getArrays(NULL, NULL, NULL, &browp, &bcols, NULL);
+
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+  const int *ext_vars;
+  ext_dist->getIndices()->getIndices(&ext_vars);
+
+  // Send the requested nodes to their owners
+  int *ptr = new int[mpi_size + 1];
+  TacsMatchIntervals(mpi_size, range, num_nodes, nodes, ptr);
+
+  int *req_count = new int[mpi_size];
+  int *in_count = new int[mpi_size];
+  int *in_ptr = new int[mpi_size + 1];
+  for (int k = 0; k < mpi_size; k++) {
+    req_count[k] = ptr[k + 1] - ptr[k];
+  }
+  MPI_Alltoall(req_count, 1, MPI_INT, in_count, 1, MPI_INT, comm);
+  in_ptr[0] = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    in_ptr[k + 1] = in_ptr[k] + in_count[k];
+  }
+
+  int *in_rows = new int[in_ptr[mpi_size]];
+  MPI_Alltoallv((void *)nodes, req_count, ptr, MPI_INT, in_rows, in_count,
+                in_ptr, MPI_INT, comm);
+
+  // Find the length of each requested row
+  int *in_len = new int[in_ptr[mpi_size]];
+  int *send_count = new int[mpi_size];
+  int *send_ptr = new int[mpi_size + 1];
+  send_ptr[0] = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    send_count[k] = 0;
+    for (int j = in_ptr[k]; j < in_ptr[k + 1]; j++) {
+      int i = in_rows[j] - range[mpi_rank];
+      in_rows[j] = i;
+      in_len[j] = arowp[i + 1] - arowp[i];
+      if (i >= n - nc) {
+        int ib = i - (n - nc);
+        in_len[j] += browp[ib + 1] - browp[ib];
+      }
+      send_count[k] += in_len[j];
+    }
+    send_ptr[k + 1] = send_ptr[k] + send_count[k];
+  }
+
+  int *rowp = new int[num_nodes + 1];
+  rowp[0] = 0;
+  MPI_Alltoallv(in_len, in_count, in_ptr, MPI_INT, &rowp[1], req_count, ptr,
+                MPI_INT, comm);
+
+  // Count up the number of entries received from each processor
+  int *recv_count = new int[mpi_size];
+  int *recv_ptr = new int[mpi_size + 1];
+  recv_ptr[0] = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    recv_count[k] = 0;
+    for (int j = ptr[k]; j < ptr[k + 1]; j++) {
+      recv_count[k] += rowp[j + 1];
+    }
+    recv_ptr[k + 1] = recv_ptr[k] + recv_count[k];
+  }
+  for (int i = 0; i < num_nodes; i++) {
+    rowp[i + 1] += rowp[i];
+  }
+
+  // Send the global column indices of the rows
+  int *send_cols = new int[send_ptr[mpi_size]];
+  for (int j = 0, index = 0; j < in_ptr[mpi_size]; j++) {
+    int i = in_rows[j];
+    for (int jp = arowp[i]; jp < arowp[i + 1]; jp++, index++) {
+      send_cols[index] = acols[jp] + range[mpi_rank];
+    }
+    if (i >= n - nc) {
+      int ib = i - (n - nc);
+      for (int jp = browp[ib]; jp < browp[ib + 1]; jp++, index++) {
+        send_cols[index] = ext_vars[bcols[jp]];
+      }
+    }
+  }
+
+  int *cols = new int[rowp[num_nodes]];
+  MPI_Alltoallv(send_cols, send_count, send_ptr, MPI_INT, cols, recv_count,
+                recv_ptr, MPI_INT, comm);
+
+  delete[] ptr;
+  delete[] req_count;
+  delete[] in_len;
+  delete[] send_cols;
+
+  *_rowp = rowp;
+  *_cols = cols;
+  if (_send_count) {
+    *_send_count = send_count;
+    *_send_ptr = send_ptr;
+    *_send_rows = in_rows;
+    *_recv_count = recv_count;
+    *_recv_ptr = recv_ptr;
+  } else {
+    delete[] send_count;
+    delete[] send_ptr;
+    delete[] in_rows;
+    delete[] recv_count;
+    delete[] recv_ptr;
+  }
+  delete[] in_count;
+  delete[] in_ptr;
+}
+
+/*
+  Extend the subdomains by the given number of layers of nodes
+
+  The first layer consists of the external nodes that are coupled to
+  the owned nodes. Each additional layer adds the nodes that are
+  coupled to the previous layer. The couplings to nodes outside the
+  overlapping subdomain are dropped.
+
+  This is collective on the communicator of the matrix.
+
+  input:
+  overlap:     the number of layers of overlap
+  restricted:  flag to use restricted additive Schwarz
+*/
+void TACSAdditiveSchwarz::setOverlap(int _overlap, int _restricted) {
+  clearOverlap();
+  overlap = (_overlap > 0 ? _overlap : 0);
+  restricted = _restricted;
+
+  MPI_Comm comm = mat->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  int bsize, n, nc;
+  mat->getRowMap(&bsize, &n, &nc);
+
+  const int *range;
+  mat->getRowMap()->getOwnerRange(&range);
+  int lower = range[mpi_rank];
+  int upper = range[mpi_rank + 1];
+
+  if (overlap == 0) {
+    // Restore the factorization of the local block
+    Apc->decref();
+    Apc = new BCSRMat(comm, Aloc, lev_fill, fill_ratio);
+    Apc->incref();
+    return;
+  }
+
+  // The first layer is the set of external columns
+  BCSRMat *Bext;
+  mat->getBCSRMat(NULL, &Bext);
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+  const int *ext_vars;
+  int num_ext = ext_dist->getIndices()->getIndices(&ext_vars);
+
+  int max_ovl = num_ext;
+  int *ovl = new int[max_ovl];
+  memcpy(ovl, ext_vars, num_ext * sizeof(int));
+  int num_ovl = num_ext;
+
+  int num_new = num_ext;
+  int *new_nodes = new int[num_ext];
+  memcpy(new_nodes, ext_vars, num_ext * sizeof(int));
+
+  // Add the remaining layers
+  for (int level = 1; level < overlap; level++) {
+    int *rowp, *cols;
+    TacsGetExtRows(mat, num_new, new_nodes, &rowp, &cols, NULL, NULL, NULL,
+                   NULL, NULL);
+
+    // Find the nodes that are not yet in the subdomain
+    int len = 0;
+    for (int j = 0; j < rowp[num_new]; j++) {
+      int c = cols[j];
+      if ((c < lower || c >= upper) && !TacsSearchArray(c, num_ovl, ovl)) {
+        cols[len] = c;
+        len++;
+      }
+    }
+    len = TacsUniqueSort(len, cols);
+
+    delete[] new_nodes;
+    new_nodes = new int[len];
+    memcpy(new_nodes, cols, len * sizeof(int));
+    num_new = len;
+    delete[] rowp;
+    delete[] cols;
+
+    // Merge the new layer into the set of overlap nodes
+    if (num_ovl + num_new > max_ovl) {
+      max_ovl = num_ovl + num_new;
+      int *tmp = new int[max_ovl];
+      memcpy(tmp, ovl, num_ovl * sizeof(int));
+      delete[] ovl;
+      ovl = tmp;
+    }
+    num_ovl = TacsMergeSortedArrays(num_ovl, ovl, num_new, new_nodes);
+  }
+  delete[] new_nodes;
+
+  // Retrieve the pattern of all the overlap rows and the plan for
+  // transferring their values
+  int *ovl_rowp, *ovl_cols;
+  TacsGetExtRows(mat, num_ovl, ovl, &ovl_rowp, &ovl_cols, &send_count,
+                 &send_ptr, &send_rows, &recv_count, &recv_ptr);
+  num_ovl_nodes = num_ovl;
+
+  // Convert the global column indices to the subdomain numbering,
+  // where columns outside the subdomain are set to -1
+  for (int j = 0; j < ovl_rowp[num_ovl]; j++) {
+    int c = ovl_cols[j];
+    if (c >= lower && c < upper) {
+      ovl_cols[j] = c - lower;
+    } else {
+      int *item = TacsSearchArray(c, num_ovl, ovl);
+      ovl_cols[j] = (item ? n + (item - ovl) : -1);
+    }
+  }
+  recv_rowp = ovl_rowp;
+  recv_cols = ovl_cols;
+
+  // Find the subdomain index of each column of Bext
+  ext_ovl_index = new int[num_ext];
+  for (int j = 0; j < num_ext; j++) {
+    int *item = TacsSearchArray(ext_vars[j], num_ovl, ovl);
+    ext_ovl_index[j] = n + (item - ovl);
+  }
+
+  // Create the non-zero pattern for the subdomain matrix
+  const int *arowp, *acols, *browp, *bcols;
+  Aloc->getArrays(NULL, NULL, NULL, &arowp, &acols, NULL);
+  Bext->getArrays(NULL, NULL, NULL, &browp, &bcols, NULL);
+
+  int nrows = n + num_ovl;
+  int *rowp = new int[nrows + 1];
+  int *cols = new int[arowp[n] + browp[nc] + ovl_rowp[num_ovl]];
+  rowp[0] = 0;
+  for (int i = 0; i < nrows; i++) {
+    int index = rowp[i];
+    if (i < n) {
+      for (int jp = arowp[i]; jp < arowp[i + 1]; jp++, index++) {
+        cols[index] = acols[jp];
+      }
+      if (i >= n - nc) {
+        int ib = i - (n - nc);
+        for (int jp = browp[ib]; jp < browp[ib + 1]; jp++, index++) {
+          cols[index] = ext_ovl_index[bcols[jp]];
+        }
+      }
+    } else {
+      int r = i - n;
+      for (int jp = ovl_rowp[r]; jp < ovl_rowp[r + 1]; jp++) {
+        if (ovl_cols[jp] >= 0) {
+          cols[index] = ovl_cols[jp];
+          index++;
+        }
+      }
+    }
+    int len = TacsUniqueSort(index - rowp[i], &cols[rowp[i]]);
+    rowp[i + 1] = rowp[i] + len;
+  }
+
+  Aovl = new BCSRMat(comm, Aloc->getThreadInfo(), bsize, nrows, nrows, &rowp,
+                     &cols);
+  Aovl->incref();
+
+  // Factor the overlapping subdomain matrix instead of the local block
+  Apc->decref();
+  Apc = new BCSRMat(comm, Aovl, lev_fill, fill_ratio);
+  Apc->incref();
+
+  // Create the object to retrieve the vector values at the overlap nodes
+  TACSBVecIndices *ovl_indices = new TACSBVecIndices(&ovl, num_ovl);
+  ovl_dist = new TACSBVecDistribute(mat->getRowMap(), ovl_indices);
+  ovl_dist->incref();
+  ovl_ctx = ovl_dist->createCtx(bsize);
+  ovl_ctx->incref();
+
+  xovl = new TacsScalar[bsize * nrows];
+  yovl = new TacsScalar[bsize * nrows];
+}
+
+/*
+  Free the data for the overlapping subdomain
+*/
+void TACSAdditiveSchwarz::clearOverlap() {
+  if (Aovl) {
+    Aovl->decref();
+  }
+  if (ovl_dist) {
+    ovl_dist->decref();
+  }
+  if (ovl_ctx) {
+    ovl_ctx->decref();
+  }
+  if (ext_ovl_index) {
+    delete[] ext_ovl_index;
+  }
+  if (xovl) {
+    delete[] xovl;
+  }
+  if (yovl) {
+    delete[] yovl;
+  }
+  if (send_count) {
+    delete[] send_count;
+    delete[] send_ptr;
+    delete[] send_rows;
+    delete[] recv_count;
+    delete[] recv_ptr;
+  }
+  if (recv_rowp) {
+    delete[] recv_rowp;
+    delete[] recv_cols;
+  }
+  overlap = 0;
+  num_ovl_nodes = 0;
+  Aovl = NULL;
+  ovl_dist = NULL;
+  ovl_ctx = NULL;
+  ext_ovl_index = NULL;
+  xovl = yovl = NULL;
+  send_count = send_ptr = send_rows = NULL;
+  recv_count = recv_ptr = NULL;
+  recv_rowp = recv_cols = NULL;
+}
+
+/*
+  Set the coarse space from the given near null-space vectors
+
+  Each vector is restricted to the nodes owned by each processor and
+  the restrictions are orthonormalized locally. Vectors that are
+  dependent on a processor are dropped from the coarse space on that
+  processor. When no vectors are provided, the coarse space consists
+  of the constant vectors for each component of the nodes.
+
+  This is collective on the communicator of the matrix.
+
+  input:
+  nmodes:        the number of vectors
+  modes:         the near null-space vectors (may be NULL)
+  coarse_ranks:  the number of ranks used for the coarse direct solve
+*/
+void TACSAdditiveSchwarz::setCoarseSpace(int nmodes, TACSBVec **modes,
+                                         int coarse_ranks) {
+  clearCoarseSpace();
+
+  MPI_Comm comm = mat->getMPIComm();
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  int bsize, n, nc;
+  mat->getRowMap(&bsize, &n, &nc);
+  int nloc = bsize * n;
+
+  if (!modes) {
+    nmodes = bsize;
+  }
+  if (nmodes <= 0) {
+    return;
+  }
+  num_modes = nmodes;
+
+  // Copy the local values of the modes
+  Z = new TacsScalar[nmodes * nloc];
+  for (int k = 0; k < nmodes; k++) {
+    TacsScalar *z = &Z[k * nloc];
+    if (modes) {
+      TacsScalar *array;
+      modes[k]->getArray(&array);
+      memcpy(z, array, nloc * sizeof(TacsScalar));
+    } else {
+      memset(z, 0, nloc * sizeof(TacsScalar));
+      for (int i = 0; i < n; i++) {
+        z[bsize * i + k] = 1.0;
+      }
+    }
+  }
+
+  // Orthonormalize the local restrictions of the modes with modified
+  // Gram-Schmidt and drop the dependent modes
+  mode_dropped = new int[nmodes];
+  for (int k = 0; k < nmodes; k++) {
+    TacsScalar *z = &Z[k * nloc];
+    double nrm0 = 0.0;
+    for (int i = 0; i < nloc; i++) {
+      nrm0 += TacsRealPart(z[i] * z[i]);
+    }
+    for (int j = 0; j < k; j++) {
+      TacsScalar *q = &Z[j * nloc];
+      TacsScalar d = 0.0;
+      for (int i = 0; i < nloc; i++) {
+        d += q[i] * z[i];
+      }
+      for (int i = 0; i < nloc; i++) {
+        z[i] -= d * q[i];
+      }
+    }
+    double nrm = 0.0;
+    for (int i = 0; i < nloc; i++) {
+      nrm += TacsRealPart(z[i] * z[i]);
+    }
+    mode_dropped[k] = (nrm <= 1e-16 * nrm0 || nrm == 0.0);
+    if (mode_dropped[k]) {
+      memset(z, 0, nloc * sizeof(TacsScalar));
+    } else {
+      double scale = 1.0 / sqrt(nrm);
+      for (int i = 0; i < nloc; i++) {
+        z[i] *= scale;
+      }
+    }
+  }
+
+  // Retrieve the values of the modes at the external nodes
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+  const int *ext_vars;
+  int num_ext = ext_dist->getIndices()->getIndices(&ext_vars);
+  TACSBVecDistCtx *ext_ctx = ext_dist->createCtx(bsize);
+  ext_ctx->incref();
+  Zext = new TacsScalar[nmodes * bsize * num_ext];
+  for (int k = 0; k < nmodes; k++) {
+    TacsScalar *zext = &Zext[k * bsize * num_ext];
+    ext_dist->beginForward(ext_ctx, &Z[k * nloc], zext);
+    ext_dist->endForward(ext_ctx, &Z[k * nloc], zext);
+  }
+  ext_ctx->decref();
+
+  // Find the processors that own the external nodes
+  const int *range;
+  mat->getRowMap()->getOwnerRange(&range);
+  int *ptr = new int[mpi_size + 1];
+  TacsMatchIntervals(mpi_size, range, num_ext, ext_vars, ptr);
+
+  nbrs = new int[mpi_size];
+  num_nbrs = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    if (k == mpi_rank || ptr[k + 1] > ptr[k]) {
+      nbrs[num_nbrs] = k;
+      num_nbrs++;
+    }
+  }
+  ext_nbr = new int[num_ext];
+  for (int j = 0, index = 0; j < num_nbrs; j++) {
+    int k = nbrs[j];
+    for (int i = ptr[k]; i < ptr[k + 1]; i++, index++) {
+      ext_nbr[index] = j;
+    }
+  }
+  delete[] ptr;
+
+  // Create the coarse operator with one block row per processor and
+  // one block column for each neighboring processor
+  TACSNodeMap *coarse_map = new TACSNodeMap(comm, 1);
+  int *indices = new int[num_nbrs];
+  int *rowp = new int[num_nbrs + 1];
+  int *cols = new int[num_nbrs];
+  rowp[0] = 0;
+  for (int j = 0; j < num_nbrs; j++) {
+    indices[j] = nbrs[j];
+    cols[j] = j;
+    rowp[j + 1] = rowp[j] + (nbrs[j] == mpi_rank ? num_nbrs : 0);
+  }
+  TACSBVecIndices *coarse_indices = new TACSBVecIndices(&indices, num_nbrs);
+  coarse_indices->incref();
+  coarse_mat =
+      new TACSParallelMat(Aloc->getThreadInfo(), coarse_map, nmodes, num_nbrs,
+                          rowp, cols, coarse_indices);
+  coarse_mat->incref();
+  coarse_indices->decref();
+  delete[] rowp;
+  delete[] cols;
+
+  coarse_pc = new TACSBlockCyclicPc(coarse_mat, 4, 1, coarse_ranks);
+  coarse_pc->incref();
+
+  coarse_x = dynamic_cast<TACSBVec *>(coarse_mat->createVec());
+  coarse_y = dynamic_cast<TACSBVec *>(coarse_mat->createVec());
+  coarse_x->incref();
+  coarse_y->incref();
+}
+
+/*
+  Free the data for the coarse space
+*/
+void TACSAdditiveSchwarz::clearCoarseSpace() {
+  if (Z) {
+    delete[] Z;
+  }
+  if (Zext) {
+    delete[] Zext;
+  }
+  if (mode_dropped) {
+    delete[] mode_dropped;
+  }
+  if (nbrs) {
+    delete[] nbrs;
+  }
+  if (ext_nbr) {
+    delete[] ext_nbr;
+  }
+  if (coarse_pc) {
+    coarse_pc->decref();
+  }
+  if (coarse_mat) {
+    coarse_mat->decref();
+  }
+  if (coarse_x) {
+    coarse_x->decref();
+  }
+  if (coarse_y) {
+    coarse_y->decref();
+  }
+  num_modes = 0;
+  Z = Zext = NULL;
+  mode_dropped = NULL;
+  num_nbrs = 0;
+  nbrs = NULL;
+  ext_nbr = NULL;
+  coarse_mat = NULL;
+  coarse_pc = NULL;
+  coarse_x = coarse_y = NULL;
+}
+
+/*
+  Factor the preconditioner by copying the values from the
+  block-diagonal matrix and then factoring the copy.
+
+  With overlap, the values of the local rows and the rows received
+  from the other processors are first copied into the subdomain
+  matrix.
+*/
+void TACSAdditiveSchwarz::factor() {
+  if (Aovl) {
+    MPI_Comm comm = mat->getMPIComm();
+    int mpi_size;
+    MPI_Comm_size(comm, &mpi_size);
+
+    int bsize, n, nc;
+    mat->getRowMap(&bsize, &n, &nc);
+    int b2 = bsize * bsize;
+
+    BCSRMat *Bext;
+    mat->getBCSRMat(NULL, &Bext);
+    const int *arowp, *acols, *browp, *bcols;
+    TacsScalar *Avals, *Bvals;
+    Aloc->getArrays(NULL, NULL, NULL, &arowp, &acols, &Avals);
+    Bext->getArrays(NULL, NULL, NULL, &browp, &bcols, &Bvals);
+
+    // Add the values from the owned rows
+    Aovl->zeroEntries();
+    int *tmp = new int[browp[nc] > 0 ? browp[nc] : 1];
+    for (int i = 0; i < n; i++) {
+      Aovl->addBlockRowValues(i, arowp[i + 1] - arowp[i], &acols[arowp[i]],
+                              &Avals[b2 * arowp[i]]);
+      if (i >= n - nc) {
+        int ib = i - (n - nc);
+        int len = browp[ib + 1] - browp[ib];
+        for (int j = 0; j < len; j++) {
+          tmp[j] = ext_ovl_index[bcols[browp[ib] + j]];
+        }
+        Aovl->addBlockRowValues(i, len, tmp, &Bvals[b2 * browp[ib]]);
+      }
+    }
+    delete[] tmp;
+
+    // Send the values of the rows requested by the other processors
+    int *scount = new int[2 * mpi_size];
+    int *rcount = &scount[mpi_size];
+    int *sptr = new int[2 * mpi_size];
+    int *rptr = &sptr[mpi_size];
+    for (int k = 0; k < mpi_size; k++) {
+      scount[k] = b2 * send_count[k];
+      sptr[k] = b2 * send_ptr[k];
+      rcount[k] = b2 * recv_count[k];
+      rptr[k] = b2 * recv_ptr[k];
+    }
+
+    TacsScalar *send_vals = new TacsScalar[b2 * send_ptr[mpi_size]];
+    TacsScalar *v = send_vals;
+    int num_send_rows = 0;
+    for (int k = 0, count = 0; k < mpi_size; k++) {
+      int end = send_ptr[k + 1];
+      while (count < end) {
+        int i = send_rows[num_send_rows];
+        int len = b2 * (arowp[i + 1] - arowp[i]);
+        memcpy(v, &Avals[b2 * arowp[i]], len * sizeof(TacsScalar));
+        v += len;
+        count += arowp[i + 1] - arowp[i];
+        if (i >= n - nc) {
+          int ib = i - (n - nc);
+          len = b2 * (browp[ib + 1] - browp[ib]);
+          memcpy(v, &Bvals[b2 * browp[ib]], len * sizeof(TacsScalar));
+          v += len;
+          count += browp[ib + 1] - browp[ib];
+        }
+        num_send_rows++;
+      }
+    }
+
+    TacsScalar *recv_vals = new TacsScalar[b2 * recv_ptr[mpi_size]];
+    MPI_Alltoallv(send_vals, scount, sptr, TACS_MPI_TYPE, recv_vals, rcount,
+                  rptr, TACS_MPI_TYPE, comm);
+
+    // Add the values from the overlap rows
+    for (int r = 0; r < num_ovl_nodes; r++) {
+      Aovl->addBlockRowValues(n + r, recv_rowp[r + 1] - recv_rowp[r],
+                              &recv_cols[recv_rowp[r]],
+                              &recv_vals[b2 * recv_rowp[r]]);
+    }
+
+    delete[] scount;
+    delete[] sptr;
+    delete[] send_vals;
+    delete[] recv_vals;
+
+    Apc->copyValues(Aovl);
+  } else {
+    Apc->copyValues(Aloc);
+  }
+  if (alpha != 0.0) {
     Apc->addDiag(alpha);
   }
-  Apc->factor();
+  if (real_factor) {
+    Apc->factorRealPart();
+  } else {
+    Apc->factor();
+  }
+  if (single_factor) {
+    Apc->convertFactorToSingle();
+  }
+
+  if (coarse_mat) {
+    factorCoarse();
+  }
+}
+
+/*
+  Form and factor the coarse operator
+
+  Each processor computes its block row of Z^{T}*A*Z. The block in
+  the column of a neighboring processor is computed from the columns
+  of Bext owned by that processor.
+*/
+void TACSAdditiveSchwarz::factorCoarse() {
+  MPI_Comm comm = mat->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  int bsize, n, nc;
+  mat->getRowMap(&bsize, &n, &nc);
+  int nloc = bsize * n;
+  int ncoup = bsize * nc;
+
+  BCSRMat *Bext;
+  mat->getBCSRMat(NULL, &Bext);
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+  const int *ext_vars;
+  int num_ext = ext_dist->getIndices()->getIndices(&ext_vars);
+  int next = bsize * num_ext;
+
+  int self = 0;
+  for (int j = 0; j < num_nbrs; j++) {
+    if (nbrs[j] == mpi_rank) {
+      self = j;
+    }
+  }
+
+  // The block row of the coarse operator stored row-major
+  int mv = num_modes * num_nbrs;
+  TacsScalar *E = new TacsScalar[num_modes * mv];
+  memset(E, 0, num_modes * mv * sizeof(TacsScalar));
+
+  TacsScalar *w = new TacsScalar[nloc];
+  TacsScalar *xe = new TacsScalar[next];
+  TacsScalar *we = new TacsScalar[ncoup];
+
+  for (int l = 0; l < num_modes; l++) {
+    // Compute the block from the owned nodes
+    Aloc->mult(&Z[l * nloc], w);
+    for (int k = 0; k < num_modes; k++) {
+      TacsScalar d = 0.0;
+      const TacsScalar *z = &Z[k * nloc];
+      for (int i = 0; i < nloc; i++) {
+        d += z[i] * w[i];
+      }
+      E[k * mv + self * num_modes + l] += d;
+    }
+
+    // Compute the blocks from the nodes owned by each neighbor
+    const TacsScalar *zext = &Zext[l * next];
+    for (int s = 0; s < num_nbrs; s++) {
+      if (s == self || ncoup == 0) {
+        continue;
+      }
+      for (int j = 0; j < num_ext; j++) {
+        for (int ii = 0; ii < bsize; ii++) {
+          xe[bsize * j + ii] = (ext_nbr[j] == s ? zext[bsize * j + ii] : 0.0);
+        }
+      }
+      Bext->mult(xe, we);
+      for (int k = 0; k < num_modes; k++) {
+        TacsScalar d = 0.0;
+        const TacsScalar *z = &Z[k * nloc + (nloc - ncoup)];
+        for (int i = 0; i < ncoup; i++) {
+          d += z[i] * we[i];
+        }
+        E[k * mv + s * num_modes + l] += d;
+      }
+    }
+  }
+
+  // Set the identity for the modes that are dropped on this processor
+  for (int k = 0; k < num_modes; k++) {
+    if (mode_dropped[k]) {
+      E[k * mv + self * num_modes + k] = 1.0;
+    }
+  }
+
+  coarse_mat->zeroEntries();
+  coarse_mat->addValues(1, &mpi_rank, num_nbrs, nbrs, num_modes, mv, E);
+  coarse_mat->beginAssembly();
+  coarse_mat->endAssembly();
+  coarse_pc->factor();
+
+  delete[] E;
+  delete[] w;
+  delete[] xe;
+  delete[] we;
 }
 
 /*!
@@ -1239,6 +3034,12 @@ void TACSAdditiveSchwarz::factor() {
   factorization of the diagonal to the input vector:
 
   y = U^{-1} L^{-1} x
+
+  With overlap, the input is extended to the overlapping subdomain
+  and, for the restricted variant, only the owned components of the
+  subdomain solution are kept. Otherwise the overlap components are
+  added to the processors that own them. The coarse correction
+  Z*E^{-1}*Z^{T}*x is then added to the result.
 */
 void TACSAdditiveSchwarz::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
   TACSBVec *xvec, *yvec;
@@ -1251,7 +3052,54 @@ void TACSAdditiveSchwarz::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
     xvec->getArray(&x);
     yvec->getArray(&y);
 
-    Apc->applyFactor(x, y);
+    if (Aovl) {
+      int bsize, n, nc;
+      mat->getRowMap(&bsize, &n, &nc);
+      int nloc = bsize * n;
+
+      memcpy(xovl, x, nloc * sizeof(TacsScalar));
+      ovl_dist->beginForward(ovl_ctx, x, &xovl[nloc]);
+      ovl_dist->endForward(ovl_ctx, x, &xovl[nloc]);
+
+      Apc->applyFactor(xovl, yovl);
+
+      memcpy(y, yovl, nloc * sizeof(TacsScalar));
+      if (!restricted) {
+        ovl_dist->beginReverse(ovl_ctx, &yovl[nloc], y, TACS_ADD_VALUES);
+        ovl_dist->endReverse(ovl_ctx, &yovl[nloc], y, TACS_ADD_VALUES);
+      }
+    } else {
+      Apc->applyFactor(x, y);
+    }
+
+    if (coarse_pc) {
+      int bsize, n, nc;
+      mat->getRowMap(&bsize, &n, &nc);
+      int nloc = bsize * n;
+
+      // Restrict the input to the coarse space
+      TacsScalar *xc, *yc;
+      coarse_x->getArray(&xc);
+      for (int k = 0; k < num_modes; k++) {
+        const TacsScalar *z = &Z[k * nloc];
+        TacsScalar d = 0.0;
+        for (int i = 0; i < nloc; i++) {
+          d += z[i] * x[i];
+        }
+        xc[k] = d;
+      }
+
+      coarse_pc->applyFactor(coarse_x, coarse_y);
+
+      // Add the coarse correction
+      coarse_y->getArray(&yc);
+      for (int k = 0; k < num_modes; k++) {
+        const TacsScalar *z = &Z[k * nloc];
+        for (int i = 0; i < nloc; i++) {
+          y[i] += yc[k] * z[i];
+        }
+      }
+    }
   } else {
     fprintf(stderr,
             "TACSAdditiveSchwarz type error: Input/output must be TACSBVec\n");
@@ -1270,7 +3118,15 @@ void TACSAdditiveSchwarz::applyFactor(TACSVec *txvec) {
   TACSBVec *xvec;
   xvec = dynamic_cast<TACSBVec *>(txvec);
 
-  if (xvec) {
+  if (xvec && (Aovl || coarse_pc)) {
+    // Copy the input so that the overlap and coarse space can be used
+    if (!temp) {
+      temp = dynamic_cast<TACSBVec *>(mat->createVec());
+      temp->incref();
+    }
+    temp->copyValues(xvec);
+    applyFactor(temp, xvec);
+  } else if (xvec) {
     // Apply the ILU factorization to a vector
     // This is the default Additive-Scharwz method
     TacsScalar *x;
@@ -1283,6 +3139,47 @@ void TACSAdditiveSchwarz::applyFactor(TACSVec *txvec) {
   }
 }
 
+/*!
+  Apply the preconditioner to multiple vectors
+
+  y[i] = U^{-1} L^{-1} x[i]
+
+  The factorization is traversed once for all the vectors.
+*/
+void TACSAdditiveSchwarz::applyFactorMulti(int nvecs, TACSVec **txvecs,
+                                           TACSVec **tyvecs) {
+  if (Aovl || coarse_pc) {
+    for (int i = 0; i < nvecs; i++) {
+      applyFactor(txvecs[i], tyvecs[i]);
+    }
+    return;
+  }
+
+  TacsScalar **x = new TacsScalar *[2 * nvecs];
+  TacsScalar **y = &x[nvecs];
+
+  int fail = 0;
+  for (int i = 0; i < nvecs; i++) {
+    TACSBVec *xvec = dynamic_cast<TACSBVec *>(txvecs[i]);
+    TACSBVec *yvec = dynamic_cast<TACSBVec *>(tyvecs[i]);
+    if (xvec && yvec) {
+      xvec->getArray(&x[i]);
+      yvec->getArray(&y[i]);
+    } else {
+      fail = 1;
+    }
+  }
+
+  if (fail) {
+    fprintf(stderr,
+            "TACSAdditiveSchwarz type error: Input/output must be TACSBVec\n");
+  } else {
+    Apc->applyFactorMulti(nvecs, x, y);
+  }
+
+  delete[] x;
+}
+
 /*!
   Retrieve the underlying matrix
 */
@@ -1655,11 +3552,28 @@ TACSVec *TACSGlobalSchurMat::createVec() {
   return new TACSBVec(rmap, Apc->getBlockSize());
 }
 
+/*
+  Create the block-cyclic factorization of the matrix
+
+  input:
+  mat:               the matrix to factor
+  blocks_per_block:  the number of matrix blocks in each dense block
+  reorder_blocks:    reorder the blocks to reduce the fill-in
+  num_ranks:         the number of ranks used to store the factorization
+*/
 TACSBlockCyclicPc::TACSBlockCyclicPc(TACSParallelMat *_mat,
-                                     int blocks_per_block, int reorder_blocks) {
+                                     int blocks_per_block, int reorder_blocks,
+                                     int num_ranks) {
   mat = _mat;
   mat->incref();
 
+  bcyclic = NULL;
+  group_comm = sub_comm = MPI_COMM_NULL;
+  group_vals_count = group_vals_ptr = NULL;
+  num_group_vars = 0;
+  group_vars = group_rowp = group_cols = NULL;
+  group_vals = NULL;
+
   // Get the communicator and the number of ranks
   int mpi_size, mpi_rank;
   comm = mat->getMPIComm();
@@ -1726,17 +3640,107 @@ TACSBlockCyclicPc::TACSBlockCyclicPc(TACSParallelMat *_mat,
     rowp[i + 1] = index;
   }
 
-  // Allocate the block cyclic matrix
-  bcyclic = new TACSBlockCyclicMat(comm, N, N, bsize, csr_vars, n, rowp, cols,
-                                   blocks_per_block, reorder_blocks);
-  bcyclic->incref();
+  if (num_ranks > 0 && num_ranks < mpi_size) {
+    // Split the ranks into contiguous groups and gather the rows from
+    // each group onto the first rank within the group
+    int group = (int)(((long int)mpi_rank * num_ranks) / mpi_size);
+    MPI_Comm_split(comm, group, mpi_rank, &group_comm);
+
+    int group_rank, group_size;
+    MPI_Comm_rank(group_comm, &group_rank);
+    MPI_Comm_size(group_comm, &group_size);
+    int color = (group_rank == 0 ? 0 : MPI_UNDEFINED);
+    MPI_Comm_split(comm, color, mpi_rank, &sub_comm);
+
+    int b2 = bsize * bsize;
+    int local_size[2];
+    local_size[0] = n;
+    local_size[1] = rowp[n];
+
+    int *sizes = NULL;
+    int *row_count = NULL, *row_ptr = NULL;
+    int *col_count = NULL, *col_ptr = NULL;
+    int *row_sizes = NULL;
+    if (group_rank == 0) {
+      sizes = new int[2 * group_size];
+    }
+    MPI_Gather(local_size, 2, MPI_INT, sizes, 2, MPI_INT, 0, group_comm);
+
+    if (group_rank == 0) {
+      row_count = new int[group_size];
+      row_ptr = new int[group_size + 1];
+      col_count = new int[group_size];
+      col_ptr = new int[group_size + 1];
+      group_vals_count = new int[group_size];
+      group_vals_ptr = new int[group_size];
+
+      row_ptr[0] = col_ptr[0] = 0;
+      for (int k = 0; k < group_size; k++) {
+        row_count[k] = sizes[2 * k];
+        col_count[k] = sizes[2 * k + 1];
+        row_ptr[k + 1] = row_ptr[k] + row_count[k];
+        col_ptr[k + 1] = col_ptr[k] + col_count[k];
+        group_vals_count[k] = b2 * col_count[k];
+        group_vals_ptr[k] = b2 * col_ptr[k];
+      }
+
+      num_group_vars = row_ptr[group_size];
+      group_vars = new int[num_group_vars];
+      group_rowp = new int[num_group_vars + 1];
+      group_cols = new int[col_ptr[group_size]];
+      group_vals = new TacsScalar[b2 * col_ptr[group_size]];
+      row_sizes = &group_rowp[1];
+    }
+
+    // Gather the variables and the non-zero pattern of the rows
+    int *local_sizes = new int[n];
+    for (int i = 0; i < n; i++) {
+      local_sizes[i] = rowp[i + 1] - rowp[i];
+    }
+    MPI_Gatherv(csr_vars, n, MPI_INT, group_vars, row_count, row_ptr, MPI_INT,
+                0, group_comm);
+    MPI_Gatherv(local_sizes, n, MPI_INT, row_sizes, row_count, row_ptr,
+                MPI_INT, 0, group_comm);
+    MPI_Gatherv(cols, rowp[n], MPI_INT, group_cols, col_count, col_ptr,
+                MPI_INT, 0, group_comm);
+    delete[] local_sizes;
+
+    if (group_rank == 0) {
+      group_rowp[0] = 0;
+      for (int i = 0; i < num_group_vars; i++) {
+        group_rowp[i + 1] += group_rowp[i];
+      }
+
+      delete[] sizes;
+      delete[] row_count;
+      delete[] row_ptr;
+      delete[] col_count;
+      delete[] col_ptr;
+    }
+
+    // Allocate the block cyclic matrix on the sub-communicator
+    if (sub_comm != MPI_COMM_NULL) {
+      bcyclic = new TACSBlockCyclicMat(
+          sub_comm, N, N, bsize, group_vars, num_group_vars, group_rowp,
+          group_cols, blocks_per_block, reorder_blocks);
+      bcyclic->incref();
+    }
+  } else {
+    // Allocate the block cyclic matrix
+    bcyclic = new TACSBlockCyclicMat(comm, N, N, bsize, csr_vars, n, rowp,
+                                     cols, blocks_per_block, reorder_blocks);
+    bcyclic->incref();
+  }
 
   delete[] csr_vars;
   delete[] rowp;
   delete[] cols;
 
   // Find the indices corresponding to the local vector
-  int rhs_size = bcyclic->getLocalVecSize();
+  int rhs_size = 0;
+  if (bcyclic) {
+    rhs_size = bcyclic->getLocalVecSize();
+  }
   int num_local_indices = rhs_size / bsize;
   int *indices = new int[num_local_indices];
 
@@ -1768,12 +3772,39 @@ TACSBlockCyclicPc::TACSBlockCyclicPc(TACSParallelMat *_mat,
 
 TACSBlockCyclicPc::~TACSBlockCyclicPc() {
   mat->decref();
-  bcyclic->decref();
+  if (bcyclic) {
+    bcyclic->decref();
+  }
   if (rhs_array) {
     delete[] rhs_array;
   }
   vec_dist->decref();
   vec_ctx->decref();
+
+  if (group_vals_count) {
+    delete[] group_vals_count;
+  }
+  if (group_vals_ptr) {
+    delete[] group_vals_ptr;
+  }
+  if (group_vars) {
+    delete[] group_vars;
+  }
+  if (group_rowp) {
+    delete[] group_rowp;
+  }
+  if (group_cols) {
+    delete[] group_cols;
+  }
+  if (group_vals) {
+    delete[] group_vals;
+  }
+  if (sub_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&sub_comm);
+  }
+  if (group_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&group_comm);
+  }
 }
 
 // Apply the preconditioner to x, to produce y
@@ -1791,7 +3822,9 @@ void TACSBlockCyclicPc::applyFactor(TACSVec *tx, TACSVec *ty) {
     vec_dist->endForward(vec_ctx, x_array, rhs_array);
 
     // Apply the factorization to the right-hand-side
-    bcyclic->applyFactor(rhs_array);
+    if (bcyclic) {
+      bcyclic->applyFactor(rhs_array);
+    }
 
     // Distribute the values back to their original locations in the
     // output vector
@@ -1806,6 +3839,11 @@ void TACSBlockCyclicPc::applyFactor(TACSVec *tx, TACSVec *ty) {
 
 // Factor (or set up) the preconditioner
 void TACSBlockCyclicPc::factor() {
+  if (group_comm != MPI_COMM_NULL) {
+    factorGroup();
+    return;
+  }
+
   bcyclic->zeroEntries();
 
   int mpi_size, mpi_rank;
@@ -1890,5 +3928,54 @@ void TACSBlockCyclicPc::factor() {
   bcyclic->factor();
 }
 
+/*
+  Gather the values of the matrix onto the first rank in each group
+  and factor the agglomerated matrix on the sub-communicator
+*/
+void TACSBlockCyclicPc::factorGroup() {
+  // Get the block matrices
+  BCSRMat *Aloc, *Bext;
+  mat->getBCSRMat(&Aloc, &Bext);
+  const int *arowp, *browp;
+  TacsScalar *Avals, *Bvals;
+  Aloc->getArrays(NULL, NULL, NULL, &arowp, NULL, &Avals);
+  Bext->getArrays(NULL, NULL, NULL, &browp, NULL, &Bvals);
+
+  // Get the matrix block size
+  int bsize, n, nc;
+  mat->getRowMap(&bsize, &n, &nc);
+  int b2 = bsize * bsize;
+
+  // Copy the values in the same order as the non-zero pattern
+  // passed to the first rank in the group
+  int size = b2 * (arowp[n] + browp[nc]);
+  TacsScalar *vals = new TacsScalar[size];
+  TacsScalar *v = vals;
+  for (int i = 0; i < n; i++) {
+    int len = b2 * (arowp[i + 1] - arowp[i]);
+    memcpy(v, &Avals[b2 * arowp[i]], len * sizeof(TacsScalar));
+    v += len;
+
+    if (i >= n - nc) {
+      int ib = i - (n - nc);
+      len = b2 * (browp[ib + 1] - browp[ib]);
+      memcpy(v, &Bvals[b2 * browp[ib]], len * sizeof(TacsScalar));
+      v += len;
+    }
+  }
+
+  MPI_Gatherv(vals, size, TACS_MPI_TYPE, group_vals, group_vals_count,
+              group_vals_ptr, TACS_MPI_TYPE, 0, group_comm);
+  delete[] vals;
+
+  // Add the values and factor the matrix
+  if (bcyclic) {
+    bcyclic->zeroEntries();
+    bcyclic->addAlltoallValues(bsize, num_group_vars, group_vars, group_rowp,
+                               group_cols, group_vals);
+    bcyclic->factor();
+  }
+}
+
 // Get the matrix associated with the preconditioner itself
 void TACSBlockCyclicPc::getMat(TACSMat **_mat) { *_mat = mat; }
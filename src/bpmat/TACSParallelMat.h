@@ -22,6 +22,7 @@
 class TACSMatDistribute;
 
 #include "BCSRMat.h"
+#include "BCSRMatSell.h"
 #include "KSM.h"
 #include "TACSBVec.h"
 #include "TACSBVecDistribute.h"
@@ -48,6 +49,10 @@ class TACSMatDistribute;
   2. Perform local matrix-vector product
   3. End scatter operation
   4. Perform local, exteral matrix-vector product
+
+  When the values from each processor can be received separately,
+  steps 3 and 4 are combined: the contributions from the external
+  matrix are added for each processor as its values arrive.
 */
 class TACSParallelMat : public TACSMat {
  public:
@@ -66,6 +71,9 @@ class TACSParallelMat : public TACSMat {
                        const TacsScalar *weights, int nv, int mv,
                        const TacsScalar *values,
                        MatrixOrientation matOr = TACS_MAT_NORMAL);
+  int addElementValues(const int *elem_ptr, int elem, int mv,
+                       const TacsScalar *values, int nblocks = 0,
+                       const int *blocks = NULL);
   void beginAssembly();
   void endAssembly();
 
@@ -73,6 +81,16 @@ class TACSParallelMat : public TACSMat {
   // -----------------------------------------
   TACSMat *createDuplicate();
 
+  // Precompute the location of the element blocks in the matrix
+  // ------------------------------------------------------------
+  void setElementScatter(int num_elements, const int *elem_ptr,
+                         const int *elem_nodes);
+  size_t getElementScatterMemory();
+
+  // Use a SELL-C-sigma copy of the local blocks for the products
+  // ------------------------------------------------------------
+  void setSellStorage(int chunk_size, int sigma = 64);
+
   // Set values into the matrix from the local BCSRMat
   // -------------------------------------------------
   void setValues(int nvars, const int *ext_vars, const int *rowp,
@@ -81,6 +99,7 @@ class TACSParallelMat : public TACSMat {
   // Functions for setting values in the matrix
   // ------------------------------------------
   void zeroEntries();                        // Zero the matrix values
+  void zeroExtEntries();                     // Zero the assembly buffers
   void applyBCs(TACSBcMap *bcmap);           // Apply the boundary conditions
   void applyTransposeBCs(TACSBcMap *bcmap);  // Apply the transpose BCs
 
@@ -89,6 +108,7 @@ class TACSParallelMat : public TACSMat {
   void getSize(int *_nr, int *_nc);            // Get the local dimensions
   void mult(TACSVec *x, TACSVec *y);           // y <- A*x
   void multTranspose(TACSVec *x, TACSVec *y);  // y <- A^{T}*x
+  void multMulti(int nvecs, TACSVec **x, TACSVec **y);
   TACSVec *createVec();                        // Create a vector
   void copyValues(TACSMat *mat);               // Copy matrix entries
   void scale(TacsScalar alpha);                // Scale the matrix
@@ -105,6 +125,9 @@ class TACSParallelMat : public TACSMat {
   void getColMap(int *bs, int *_M);
   TACSNodeMap *getRowMap() { return rmap; }
   void getExtColMap(TACSBVecDistribute **ext_map);  // Access the column map
+  TACSMatDistribute *getMatDistribute() { return mat_dist; }
+  void endForwardMultAdd(TACSBVecDistCtx *_ctx, TacsScalar *x,
+                         TacsScalar *xext, TacsScalar *y);
   void printNzPattern(const char *fileName);  // Print the non-zero pattern
   const char *getObjectName();
 
@@ -113,9 +136,20 @@ class TACSParallelMat : public TACSMat {
   void init(TACSNodeMap *_rmap, BCSRMat *_Aloc, BCSRMat *_Bext,
             TACSBVecDistribute *_col_map);
 
+  // Copy the values into the SELL storage if they are out of date
+  void updateSellValues();
+
+  // Set up the segments of Bext that use the values from each processor
+  void initExtSegments();
+
   // Local entries for the matrix
   BCSRMat *Aloc, *Bext;
 
+  // Optional SELL-C-sigma copies of Aloc and Bext for the products
+  BCSRMatSell *Asell, *Bsell;
+  int sell_chunk_size, sell_sigma;
+  int sell_stale;  // Flag indicating that the SELL values are out of date
+
   // Map the local entries into the global data
   TACSNodeMap *rmap;
   TACSBVecDistribute *ext_dist;
@@ -132,6 +166,13 @@ class TACSParallelMat : public TACSMat {
   TacsScalar *x_ext;
   int ext_offset;
 
+  // The segments (row, kstart, kend) of the blocks in Bext that
+  // multiply the values received from each processor. The first
+  // group of segments uses the values that are available immediately
+  // and group p + 1 uses the values from processor index p.
+  int num_seg_procs;
+  int *seg_ptr, *segs;
+
   static const char *matName;
 };
 
@@ -152,7 +193,19 @@ class TACSGaussSeidel : public TACSPc {
   void applyFactor(TACSVec *xvec, TACSVec *yvec);
   void getMat(TACSMat **_mat);
 
+  // Use a multicolor ordering for thread-parallel sweeps
+  void setMultiColor(int flag);
+  int getNumColors();
+
  private:
+  // Finish the transfer and compute b = x - Bext*yext for the coupling rows
+  void endExtRHS(TacsScalar *x, TacsScalar *y, TacsScalar *b);
+
+  // Compute the coloring and sweep over the interior or coupling rows
+  void computeColoring();
+  void applySweep(int coupling, int reverse, const TacsScalar *b,
+                  TacsScalar *y);
+
   // Parallel matrix pointer
   TACSParallelMat *mat;
 
@@ -172,6 +225,12 @@ class TACSGaussSeidel : public TACSPc {
   TACSBVecDistCtx *ctx;
   int ext_offset;
   TacsScalar *yext;
+
+  // The multicolor ordering of the interior rows, followed by the
+  // coupling rows, which are colored separately
+  int use_multicolor;
+  int num_int_colors, num_ext_colors;
+  int *color_ptr, *color_rows;
 };
 
 /*
@@ -213,7 +272,101 @@ class TACSChebyshevSmoother : public TACSPc {
   double *r, *c;
 
   // Temporary vectors
-  TACSBVec *res, *t, *h;
+  TACSVec *res, *t, *h;
+};
+
+/*
+  Chebyshev polynomial preconditioner
+
+  This applies a fixed polynomial in M^{-1}*A, where M is an optional
+  inner preconditioner, as a stand-alone preconditioner. The spectral
+  interval is estimated with Arnoldi when the preconditioner is
+  factored. The degree is then selected so that the Chebyshev bound
+  on the residual reduction over this interval is below rtol, up to
+  the maximum degree.
+
+  The application only requires matrix-vector products, vector
+  updates and applications of the inner preconditioner, so that no
+  global reductions are performed once the preconditioner is factored.
+*/
+class TACSChebyshevPc : public TACSPc {
+ public:
+  TACSChebyshevPc(TACSMat *_mat, int _max_degree, TACSPc *_pc = NULL,
+                  double _rtol = 1e-2, int _arnoldi_size = 20,
+                  double _upper_factor = 1.05);
+  ~TACSChebyshevPc();
+
+  void factor();
+  void applyFactor(TACSVec *xvec, TACSVec *yvec);
+  void getMat(TACSMat **_mat);
+  int getDegree();
+
+ private:
+  // Apply the operator out = M^{-1}*A*in
+  void applyOp(TACSVec *in, TACSVec *out);
+
+  // The matrix and the inner preconditioner
+  TACSMat *mat;
+  TACSPc *pc;
+
+  // Parameters used to select the polynomial
+  int max_degree, arnoldi_size;
+  double rtol, upper_factor;
+
+  // The spectral interval [alpha, beta] and the degree
+  double alpha, beta;
+  int degree;
+
+  // Temporary vectors
+  TACSVec *r, *d, *t, *s;
+};
+
+/*
+  GMRES polynomial preconditioner
+
+  This applies the polynomial p(M^{-1}*A)*M^{-1}, where 1 - z*p(z) is
+  the GMRES residual polynomial from an Arnoldi iteration started with
+  a random vector when the preconditioner is factored. The Arnoldi
+  iteration stops when the GMRES residual is below rtol, which sets
+  the degree of the polynomial. The polynomial is applied in product
+  form using its roots, the harmonic Ritz values, in a Leja ordering.
+  Complex conjugate pairs of roots are applied together in real
+  arithmetic.
+
+  Unlike the Chebyshev polynomial, this does not require the spectrum
+  to lie in a real interval. As with the Chebyshev preconditioner, the
+  application is free of global reductions.
+*/
+class TACSGMRESPolynomialPc : public TACSPc {
+ public:
+  TACSGMRESPolynomialPc(TACSMat *_mat, int _max_degree, TACSPc *_pc = NULL,
+                        double _rtol = 1e-2);
+  ~TACSGMRESPolynomialPc();
+
+  void factor();
+  void applyFactor(TACSVec *xvec, TACSVec *yvec);
+  void getMat(TACSMat **_mat);
+  int getDegree();
+
+ private:
+  // Apply the operator out = M^{-1}*A*in
+  void applyOp(TACSVec *in, TACSVec *out);
+
+  // The matrix and the inner preconditioner
+  TACSMat *mat;
+  TACSPc *pc;
+
+  // Parameters used to select the polynomial
+  int max_degree;
+  double rtol;
+
+  // The degree of the polynomial and the real and imaginary parts of
+  // the roots. Only one root from each conjugate pair is stored.
+  int degree, nroots;
+  double *root_re, *root_im;
+
+  // Temporary vectors
+  TACSVec *prod, *w, *t, *s;
 };
 
 /*
@@ -221,6 +374,20 @@ class TACSChebyshevSmoother : public TACSPc {
 
   Set up involves factoring the diagonal portion of the matrix.  Apply
   the local preconditioner to the local components of the residual.
+
+  The subdomains can be extended with setOverlap() by a number of
+  layers of nodes from the matrix graph. The rows of the overlap nodes
+  are retrieved from the processors that own them, and the incomplete
+  factorization is computed for the overlapping subdomain. By default,
+  the restricted variant is used, where only the owned components of
+  the subdomain solution are kept.
+
+  A coarse space can be added with setCoarseSpace(). The coarse space
+  consists of the given near null-space vectors, such as the rigid
+  body modes, restricted to the nodes owned by each processor. The
+  coarse operator Z^{T}*A*Z has one block row per processor and is
+  solved with the parallel direct solver. The coarse correction is
+  added to the subdomain solutions.
 */
 class TACSAdditiveSchwarz : public TACSPc {
  public:
@@ -228,16 +395,63 @@ class TACSAdditiveSchwarz : public TACSPc {
   ~TACSAdditiveSchwarz();
 
   void setDiagShift(TacsScalar _alpha);
+  void setSinglePrecisionFactor(int _single_factor);
+  void setRealPartFactor(int _real_factor);
+  void setOverlap(int _overlap, int _restricted = 1);
+  void setCoarseSpace(int nmodes, TACSBVec **modes = NULL,
+                      int coarse_ranks = -1);
   void factor();
   void applyFactor(TACSVec *xvec, TACSVec *yvec);
   void applyFactor(TACSVec *yvec);
+  void applyFactorMulti(int nvecs, TACSVec **xvecs, TACSVec **yvecs);
   void getMat(TACSMat **_mat);
 
  private:
+  // Free the data for the overlap and the coarse space
+  void clearOverlap();
+  void clearCoarseSpace();
+
+  // Factor the coarse operator
+  void factorCoarse();
+
   TACSParallelMat *mat;
   BCSRMat *Aloc;
   TacsScalar alpha;
   BCSRMat *Apc;
+  int single_factor;
+  int real_factor;
+
+  // The parameters for the incomplete factorization
+  int lev_fill;
+  double fill_ratio;
+
+  // The matrix for the overlapping subdomain. The rows of the owned
+  // nodes are followed by the rows of the overlap nodes.
+  int overlap, restricted;
+  int num_ovl_nodes;
+  BCSRMat *Aovl;
+  TACSBVecDistribute *ovl_dist;
+  TACSBVecDistCtx *ovl_ctx;
+  int *ext_ovl_index;       // Index in Aovl of each column of Bext
+  TacsScalar *xovl, *yovl;  // Vectors on the overlapping subdomain
+
+  // The plan for retrieving the values of the overlap rows
+  int *send_count, *send_ptr, *send_rows;
+  int *recv_count, *recv_ptr;
+  int *recv_rowp, *recv_cols;
+
+  // The coarse space and the coarse operator
+  int num_modes;
+  TacsScalar *Z, *Zext;     // Local and external values of the modes
+  int *mode_dropped;        // Flag for modes that are locally dependent
+  int num_nbrs, *nbrs;      // Processors coupled to this processor
+  int *ext_nbr;             // Neighbor index of each column of Bext
+  TACSParallelMat *coarse_mat;
+  TACSPc *coarse_pc;
+  TACSBVec *coarse_x, *coarse_y;
+
+  // Temporary vector for the in-place application
+  TACSBVec *temp;
 };
 
 /*
@@ -313,11 +527,23 @@ class TACSApproximateSchur : public TACSPc {
 
 /*
   A pre-conditioner based on a parallel block-cyclic matrix
+
+  The factorization is distributed over all the ranks in the
+  communicator of the matrix by default. When num_ranks is smaller
+  than the number of ranks, the matrix is agglomerated onto num_ranks
+  of the processors. The ranks are split into num_ranks contiguous
+  groups, and the rows from each group are gathered onto the first
+  rank in the group. The factorization and the back-solves are then
+  performed on a sub-communicator that only contains these ranks, so
+  that the remaining ranks do not take part in the communication
+  within the back-solves. This reduces the latency of the solve when
+  the matrix is small relative to the number of ranks, such as on the
+  coarsest level of a multigrid method.
 */
 class TACSBlockCyclicPc : public TACSPc {
  public:
   TACSBlockCyclicPc(TACSParallelMat *_mat, int blocks_per_block = 4,
-                    int reorder_blocks = 1);
+                    int reorder_blocks = 1, int num_ranks = -1);
   ~TACSBlockCyclicPc();
 
   // Apply the preconditioner to x, to produce y
@@ -330,12 +556,25 @@ class TACSBlockCyclicPc : public TACSPc {
   void getMat(TACSMat **_mat);
 
  private:
+  // Factor the matrix agglomerated onto a subset of the ranks
+  void factorGroup();
+
   MPI_Comm comm;
   TACSParallelMat *mat;
   TACSBlockCyclicMat *bcyclic;
   TacsScalar *rhs_array;
   TACSBVecDistribute *vec_dist;
   TACSBVecDistCtx *vec_ctx;
+
+  // Data for the matrix agglomerated onto a subset of the ranks. The
+  // group communicator contains the ranks that send their rows to the
+  // same rank, and the sub-communicator contains the ranks that store
+  // the factorization.
+  MPI_Comm group_comm, sub_comm;
+  int *group_vals_count, *group_vals_ptr;  // Values from each group rank
+  int num_group_vars;                      // Rows stored on this rank
+  int *group_vars, *group_rowp, *group_cols;
+  TacsScalar *group_vals;
 };
 
 #endif  // TACS_PARALLEL_MATRIX_H
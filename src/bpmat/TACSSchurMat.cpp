@@ -939,7 +939,11 @@ void TACSSchurMat::getBCSRMat(BCSRMat **_B, BCSRMat **_E, BCSRMat **_F,
   smat:    the TACSSchurMat matrix for the preconditioner
   levFill: the level of fill to use
   fill:    the expected/best estimate of the fill-in factor
-  reorder: flag to indicate whether to re-order the global Schur complement
+  reorder: the ordering of the global Schur complement: 0 uses the
+           natural ordering, 1 re-orders fixed-size blocks of variables,
+           2 uses a minimum degree nodal ordering with one block for
+           each supernode of the factor and 3 uses a nested dissection
+           nodal ordering with one block for each supernode
 */
 TACSSchurPc::TACSSchurPc(TACSSchurMat *_mat, int levFill, double fill,
                          int reorder_schur_complement) {
@@ -954,6 +958,8 @@ TACSSchurPc::TACSSchurPc(TACSSchurMat *_mat, int levFill, double fill,
 
   monitor_factor = 0;
   monitor_back_solve = 0;
+  single_factor = 0;
+  real_factor = 0;
 
   // By default use the less-memory intensive option
   use_cyclic_alltoall = 0;
@@ -1090,10 +1096,36 @@ TACSSchurPc::TACSSchurPc(TACSSchurMat *_mat, int levFill, double fill,
     schur_cols[i] = local_schur_vars[cols[i]];
   }
 
-  // Create the global block-cyclic Schur complement matrix
-  bcyclic = new TACSBlockCyclicMat(
-      comm, M, N, bsize, local_schur_vars, num_schur_vars, rowp, schur_cols,
-      csr_blocks_per_block, reorder_schur_complement, max_grid_size);
+  if (reorder_schur_complement >= 2) {
+    // Gather the nodal non-zero pattern to the root, compute the
+    // supernodal ordering and renumber the global Schur variables
+    int num_snodes = 0;
+    int *snode_ptr = new int[num_unique_schur + 1];
+    int use_nd = (reorder_schur_complement == 3);
+    compute_supernodal_order(root, num_unique_schur, num_schur_root,
+                             schur_count, schur_ptr, schur_root, unique_schur,
+                             rowp, schur_cols, csr_blocks_per_block, use_nd,
+                             &num_snodes, snode_ptr);
+
+    // Pass the new variable numbers back to the owners
+    MPI_Scatterv(schur_root, schur_count, schur_ptr, MPI_INT,
+                 local_schur_vars, num_local_schur_vars, MPI_INT, root, comm);
+    for (int i = 0; i < rowp[num_schur_vars]; i++) {
+      schur_cols[i] = local_schur_vars[cols[i]];
+    }
+
+    // Create the global block-cyclic Schur complement matrix with
+    // one block for each supernode
+    bcyclic = new TACSBlockCyclicMat(comm, M, bsize, local_schur_vars,
+                                     num_schur_vars, rowp, schur_cols,
+                                     num_snodes, snode_ptr, max_grid_size);
+    delete[] snode_ptr;
+  } else {
+    // Create the global block-cyclic Schur complement matrix
+    bcyclic = new TACSBlockCyclicMat(
+        comm, M, N, bsize, local_schur_vars, num_schur_vars, rowp, schur_cols,
+        csr_blocks_per_block, reorder_schur_complement, max_grid_size);
+  }
   bcyclic->incref();
   delete[] schur_cols;
 
@@ -1236,6 +1268,133 @@ TACSSchurPc::TACSSchurPc(TACSSchurMat *_mat, int levFill, double fill,
   gschur->incref();
 }
 
+/*
+  Compute a supernodal ordering for the global Schur complement.
+
+  The nodal non-zero pattern of the global Schur complement is
+  gathered to the root process, where a fill-reducing ordering and a
+  partition into supernodes is computed. The global Schur variables
+  are then renumbered in place so that each supernode is a contiguous
+  set of variables. The supernode partition is broadcast to all
+  processes.
+
+  input:
+  root:         the root process
+  num_unique:   the number of unique global Schur variables
+  num_root:     the number of gathered variables on the root
+  count, ptr:   the number and offset of the variables from each rank
+  rowp, cols:   the local non-zero pattern in the global Schur numbering
+  max_size:     the maximum number of nodes in a supernode
+  use_nd:       use nested dissection for the fill-reducing ordering
+
+  input/output:
+  schur_root:    the global Schur variable of each gathered variable
+  unique_schur:  the TACS variable of each global Schur variable
+
+  output:
+  num_snodes:   the number of supernodes
+  snode_ptr:    the pointer to the start of each supernode
+*/
+void TACSSchurPc::compute_supernodal_order(
+    int root, int num_unique, int num_root, const int *count, const int *ptr,
+    int *schur_root, int *unique_schur, const int *rowp, const int *cols,
+    int max_size, int use_nd, int *num_snodes, int *snode_ptr) {
+  MPI_Comm comm = mat->getNodeMap()->getMPIComm();
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Gather the length of each row to the root
+  int *row_count = new int[num_local_schur_vars];
+  for (int i = 0; i < num_local_schur_vars; i++) {
+    row_count[i] = rowp[i + 1] - rowp[i];
+  }
+
+  int *root_row_count = NULL;
+  int *col_count = NULL;
+  int *col_ptr = NULL;
+  if (rank == root) {
+    root_row_count = new int[num_root];
+    col_count = new int[size];
+    col_ptr = new int[size + 1];
+  }
+  MPI_Gatherv(row_count, num_local_schur_vars, MPI_INT, root_row_count,
+              (int *)count, (int *)ptr, MPI_INT, root, comm);
+  delete[] row_count;
+
+  // Gather the column indices to the root
+  int nnz = rowp[num_local_schur_vars];
+  MPI_Gather(&nnz, 1, MPI_INT, col_count, 1, MPI_INT, root, comm);
+
+  int *root_cols = NULL;
+  if (rank == root) {
+    col_ptr[0] = 0;
+    for (int k = 0; k < size; k++) {
+      col_ptr[k + 1] = col_ptr[k] + col_count[k];
+    }
+    root_cols = new int[col_ptr[size]];
+  }
+  MPI_Gatherv((void *)cols, nnz, MPI_INT, root_cols, col_count, col_ptr,
+              MPI_INT, root, comm);
+
+  if (rank == root) {
+    // Assemble the nodal pattern of the global Schur complement
+    int *node_rowp = new int[num_unique + 1];
+    int *node_cols = new int[col_ptr[size]];
+    memset(node_rowp, 0, (num_unique + 1) * sizeof(int));
+    for (int i = 0; i < num_root; i++) {
+      node_rowp[schur_root[i] + 1] += root_row_count[i];
+    }
+    for (int i = 0; i < num_unique; i++) {
+      node_rowp[i + 1] += node_rowp[i];
+    }
+    for (int i = 0, jp = 0; i < num_root; i++) {
+      int row = schur_root[i];
+      for (int k = 0; k < root_row_count[i]; k++, jp++) {
+        node_cols[node_rowp[row]] = root_cols[jp];
+        node_rowp[row]++;
+      }
+    }
+    for (int i = num_unique; i > 0; i--) {
+      node_rowp[i] = node_rowp[i - 1];
+    }
+    node_rowp[0] = 0;
+    TacsSortAndUniquifyCSR(num_unique, node_rowp, node_cols);
+
+    // Compute the ordering and the supernodes
+    int *perm = new int[num_unique];
+    TACSBlockCyclicMat::computeSupernodes(num_unique, node_rowp, node_cols,
+                                          max_size, perm, num_snodes,
+                                          snode_ptr, use_nd);
+
+    // Renumber the global Schur variables
+    int *iperm = new int[num_unique];
+    int *temp = new int[num_unique];
+    for (int i = 0; i < num_unique; i++) {
+      iperm[perm[i]] = i;
+      temp[i] = unique_schur[perm[i]];
+    }
+    memcpy(unique_schur, temp, num_unique * sizeof(int));
+    for (int i = 0; i < num_root; i++) {
+      schur_root[i] = iperm[schur_root[i]];
+    }
+
+    delete[] node_rowp;
+    delete[] node_cols;
+    delete[] perm;
+    delete[] iperm;
+    delete[] temp;
+    delete[] root_row_count;
+    delete[] root_cols;
+    delete[] col_count;
+    delete[] col_ptr;
+  }
+
+  // Broadcast the supernode partition
+  MPI_Bcast(num_snodes, 1, MPI_INT, root, comm);
+  MPI_Bcast(snode_ptr, *num_snodes + 1, MPI_INT, root, comm);
+}
+
 /*
   Destructor for the TACSSchurPc preconditioner object
 */
@@ -1404,6 +1563,89 @@ void TACSSchurPc::setAlltoallAssemblyFlag(int flag) {
   use_cyclic_alltoall = flag;
 }
 
+/*
+  Set the flag that controls whether the factor of the diagonal block
+  is stored in single precision.
+
+  When true, the factor Bpc = Lb*Ub is converted to single precision
+  once the off-diagonal blocks have been computed. The back-solves
+  with Lb and Ub in applyFactor() then read the factor in single
+  precision while the vectors and the arithmetic remain in double
+  precision. This is not available in complex mode.
+
+  input:
+  flag:  the flag value for the single-precision factor
+*/
+void TACSSchurPc::setSinglePrecisionFactor(int flag) { single_factor = flag; }
+
+/*
+  Set the flag that controls whether only the real part of the
+  diagonal block is factored in complex mode.
+
+  When true, Bpc = Lb*Ub is factored in real arithmetic and the
+  back-solves with Lb and Ub in applyFactor() apply the real factor to
+  the real and imaginary parts separately. The off-diagonal blocks and
+  the global Schur complement are still formed and factored with
+  complex entries. This has no effect in real mode.
+
+  input:
+  flag:  the flag value for the real-part factor
+*/
+void TACSSchurPc::setRealPartFactor(int flag) { real_factor = flag; }
+
+/*
+  Set the flag that controls whether the global Schur complement is
+  factored with the device backend.
+
+  When true, the trailing matrix updates in the block-cyclic
+  factorization are computed on the device. See
+  TACSBlockCyclicMat::setDeviceFactorFlag().
+
+  input:
+  flag:  the flag value for the device factorization
+*/
+void TACSSchurPc::setDeviceFactorFlag(int flag) {
+  bcyclic->setDeviceFactorFlag(flag);
+}
+
+/*
+  Compute the inertia of the factored matrix.
+
+  By Sylvester's law of inertia, the inertia of the symmetric matrix is
+  the sum of the inertia of the block-diagonal matrix B and the global
+  Schur complement. The result is only exact when the matrix is
+  symmetric and the level of fill is large enough that the
+  factorization of B is complete. This is collective on the
+  communicator of the matrix.
+
+  output:
+  nneg:   the number of negative eigenvalues
+  npos:   the number of positive eigenvalues
+*/
+void TACSSchurPc::getInertia(int *nneg, int *npos) {
+  int counts[2];
+  Bpc->getInertia(&counts[0], &counts[1]);
+  MPI_Allreduce(MPI_IN_PLACE, counts, 2, MPI_INT, MPI_SUM,
+                b_map->getMPIComm());
+
+  int schur_neg, schur_pos;
+  bcyclic->getInertia(&schur_neg, &schur_pos);
+  *nneg = counts[0] + schur_neg;
+  *npos = counts[1] + schur_pos;
+}
+
+/*
+  Get the number of entries stored in the factor of the global Schur
+  complement on all processors. This is collective.
+*/
+size_t TACSSchurPc::getNumSchurFactorEntries() {
+  unsigned long long local = bcyclic->getNumLocalEntries();
+  unsigned long long total = 0;
+  MPI_Allreduce(&local, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+                b_map->getMPIComm());
+  return total;
+}
+
 /*
   Factor the Schur-complement based preconditioner
 
@@ -1440,7 +1682,11 @@ void TACSSchurPc::factor() {
 
   // Copy the diagonal matrix B and factor it
   Bpc->copyValues(B);
-  Bpc->factor();
+  if (real_factor) {
+    Bpc->factorRealPart();
+  } else {
+    Bpc->factor();
+  }
 
   if (monitor_factor) {
     diag_factor_time += MPI_Wtime();
@@ -1453,6 +1699,13 @@ void TACSSchurPc::factor() {
   Fpc->copyValues(F);
   Bpc->applyLowerFactor(Epc);
   Bpc->applyUpperFactor(Fpc);
+  if (real_factor) {
+    // Discard the zero imaginary part restored by the products above
+    Bpc->convertFactorToRealPart();
+  }
+  if (single_factor) {
+    Bpc->convertFactorToSingle();
+  }
 
   // Compute the Schur complement matrix Sc
   Sc->matMultAdd(-1.0, Fpc, Epc);
@@ -1651,7 +1904,845 @@ void TACSSchurPc::applyFactor(TACSVec *tin, TACSVec *tout) {
   }
 }
 
+/*!
+  Apply the Schur preconditioner to multiple vectors
+
+  This performs the same steps as applyFactor(), but the local
+  triangular solves with Bpc and the products with Epc and Fpc are
+  performed for all the vectors with a single pass over each matrix.
+  The global Schur complement system is solved for each vector in
+  turn.
+*/
+void TACSSchurPc::applyFactorMulti(int nvecs, TACSVec **tin, TACSVec **tout) {
+  TACSBVec **invecs = new TACSBVec *[2 * nvecs];
+  TACSBVec **outvecs = &invecs[nvecs];
+
+  int fail = 0;
+  for (int i = 0; i < nvecs; i++) {
+    invecs[i] = dynamic_cast<TACSBVec *>(tin[i]);
+    outvecs[i] = dynamic_cast<TACSBVec *>(tout[i]);
+    if (!invecs[i] || !outvecs[i]) {
+      fail = 1;
+    }
+  }
+
+  if (fail) {
+    fprintf(stderr, "TACSSchurPc type error: Input/output must be TACSBVec\n");
+    delete[] invecs;
+    return;
+  }
+
+  // Allocate the local and interface storage for each vector
+  int xsize = Bpc->getBlockSize() * b_map->getNumNodes();
+  int ysize = Bpc->getBlockSize() * c_map->getNumNodes();
+  TacsScalar *xdata = new TacsScalar[nvecs * xsize];
+  TacsScalar *ydata = new TacsScalar[nvecs * ysize];
+  TacsScalar **xl = new TacsScalar *[2 * nvecs];
+  TacsScalar **yi = &xl[nvecs];
+  for (int i = 0; i < nvecs; i++) {
+    xl[i] = &xdata[i * xsize];
+    yi[i] = &ydata[i * ysize];
+
+    // Re-order the local variables into xl[i]
+    TacsScalar *in;
+    invecs[i]->getArray(&in);
+    b_map->beginForward(b_ctx, in, xl[i]);
+    b_map->endForward(b_ctx, in, xl[i]);
+  }
+
+  // xl = L^{-1} f and yi = F U^{-1} xl = F U^{-1} L^{-1} f
+  Bpc->applyLowerMulti(nvecs, xl, xl);
+  Fpc->multMulti(nvecs, xl, yi);
+
+  // Solve the global Schur complement system for each vector
+  TacsScalar *g = NULL, *y = NULL;
+  gschur->getArray(&g);
+  yschur->getArray(&y);
+  for (int i = 0; i < nvecs; i++) {
+    TacsScalar *in, *out;
+    invecs[i]->getArray(&in);
+    outvecs[i]->getArray(&out);
+
+    // Compute the right hand side: g - F U^{-1} L^{-1} f
+    tacs_schur_dist->beginForward(tacs_schur_ctx, in, g);
+    yschur->zeroEntries();
+    schur_dist->beginReverse(schur_ctx, yi[i], y, TACS_ADD_VALUES);
+    tacs_schur_dist->endForward(tacs_schur_ctx, in, g);
+    schur_dist->endReverse(schur_ctx, yi[i], y, TACS_ADD_VALUES);
+    gschur->axpy(-1.0, yschur);
+
+    bcyclic->applyFactor(g);
+    yschur->copyValues(gschur);
+
+    // Pass the solution back to the interface and global variables
+    schur_dist->beginForward(schur_ctx, y, yi[i]);
+    tacs_schur_dist->beginReverse(tacs_schur_ctx, y, out, TACS_INSERT_VALUES);
+    schur_dist->endForward(schur_ctx, y, yi[i]);
+    tacs_schur_dist->endReverse(tacs_schur_ctx, y, out, TACS_INSERT_VALUES);
+
+    int one = 1;
+    TacsScalar alpha = -1.0;
+    BLASscal(&ysize, &alpha, yi[i], &one);
+  }
+
+  // xl = U^{-1} (xl - L^{-1} E yi)
+  Epc->multAddMulti(nvecs, yi, xl, xl);
+  Bpc->applyUpperMulti(nvecs, xl, xl);
+
+  for (int i = 0; i < nvecs; i++) {
+    TacsScalar *out;
+    outvecs[i]->getArray(&out);
+    b_map->beginReverse(b_ctx, xl[i], out, TACS_INSERT_VALUES);
+    b_map->endReverse(b_ctx, xl[i], out, TACS_INSERT_VALUES);
+  }
+
+  delete[] xdata;
+  delete[] ydata;
+  delete[] xl;
+  delete[] invecs;
+}
+
 /*
   Retrieve the underlying matrix
 */
 void TACSSchurPc::getMat(TACSMat **_mat) { *_mat = mat; }
+
+/*
+  Compare two pairs of integers for sorting
+*/
+static int TacsComparePairs(const void *a, const void *b) {
+  const int *ia = static_cast<const int *>(a);
+  const int *ib = static_cast<const int *>(b);
+  if (ia[0] != ib[0]) {
+    return ia[0] - ib[0];
+  }
+  return ia[1] - ib[1];
+}
+
+/*
+  Find the set of processors that reference each of the given global
+  nodes.
+
+  Each processor sends its list of nodes to the owners of the nodes.
+  The owners collect the processors that referenced each node and
+  return the sorted list of processors. This is collective on the
+  communicator of the node map.
+
+  input:
+  rmap:    the node map
+  nnodes:  the number of nodes
+  nodes:   the unique global node numbers
+
+  output:
+  ptr:     pointer into the ranks array for each node
+  ranks:   the sorted ranks that reference each node
+*/
+static void TacsComputeSharedRanks(TACSNodeMap *rmap, int nnodes,
+                                   const int *nodes, int **_ptr,
+                                   int **_ranks) {
+  MPI_Comm comm = rmap->getMPIComm();
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  const int *range;
+  rmap->getOwnerRange(&range);
+
+  // Sort the nodes so that they can be sent to their owners
+  int *sorted = new int[nnodes];
+  memcpy(sorted, nodes, nnodes * sizeof(int));
+  TacsUniqueSort(nnodes, sorted);
+
+  int *ptr = new int[mpi_size + 1];
+  TacsMatchIntervals(mpi_size, range, nnodes, sorted, ptr);
+
+  int *count = new int[mpi_size];
+  int *in_count = new int[mpi_size];
+  int *in_ptr = new int[mpi_size + 1];
+  for (int k = 0; k < mpi_size; k++) {
+    count[k] = ptr[k + 1] - ptr[k];
+  }
+  MPI_Alltoall(count, 1, MPI_INT, in_count, 1, MPI_INT, comm);
+  in_ptr[0] = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    in_ptr[k + 1] = in_ptr[k] + in_count[k];
+  }
+
+  int num_in = in_ptr[mpi_size];
+  int *in_nodes = new int[num_in];
+  MPI_Alltoallv(sorted, count, ptr, MPI_INT, in_nodes, in_count, in_ptr,
+                MPI_INT, comm);
+
+  // Sort the (node, rank) pairs
+  int *pairs = new int[2 * num_in];
+  for (int k = 0; k < mpi_size; k++) {
+    for (int j = in_ptr[k]; j < in_ptr[k + 1]; j++) {
+      pairs[2 * j] = in_nodes[j];
+      pairs[2 * j + 1] = k;
+    }
+  }
+  qsort(pairs, num_in, 2 * sizeof(int), TacsComparePairs);
+
+  // Find the range of pairs for each requested node
+  int *in_len = new int[num_in];
+  int *send_count = new int[mpi_size];
+  int *send_ptr = new int[mpi_size + 1];
+  send_ptr[0] = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    send_count[k] = 0;
+    for (int j = in_ptr[k]; j < in_ptr[k + 1]; j++) {
+      int start = 0, end = num_in;
+      while (start < end) {
+        int mid = (start + end) / 2;
+        if (pairs[2 * mid] < in_nodes[j]) {
+          start = mid + 1;
+        } else {
+          end = mid;
+        }
+      }
+      end = start;
+      while (end < num_in && pairs[2 * end] == in_nodes[j]) {
+        end++;
+      }
+      in_len[j] = end - start;
+      in_nodes[j] = start;
+      send_count[k] += in_len[j];
+    }
+    send_ptr[k + 1] = send_ptr[k] + send_count[k];
+  }
+
+  // Send back the number of ranks for each node
+  int *sorted_ptr = new int[nnodes + 1];
+  sorted_ptr[0] = 0;
+  MPI_Alltoallv(in_len, in_count, in_ptr, MPI_INT, &sorted_ptr[1], count, ptr,
+                MPI_INT, comm);
+
+  int *recv_count = new int[mpi_size];
+  int *recv_ptr = new int[mpi_size + 1];
+  recv_ptr[0] = 0;
+  for (int k = 0; k < mpi_size; k++) {
+    recv_count[k] = 0;
+    for (int j = ptr[k]; j < ptr[k + 1]; j++) {
+      recv_count[k] += sorted_ptr[j + 1];
+    }
+    recv_ptr[k + 1] = recv_ptr[k] + recv_count[k];
+  }
+  for (int i = 0; i < nnodes; i++) {
+    sorted_ptr[i + 1] += sorted_ptr[i];
+  }
+
+  // Send back the ranks for each node
+  int *send_ranks = new int[send_ptr[mpi_size]];
+  for (int j = 0, index = 0; j < num_in; j++) {
+    for (int i = 0; i < in_len[j]; i++, index++) {
+      send_ranks[index] = pairs[2 * (in_nodes[j] + i) + 1];
+    }
+  }
+
+  int *sorted_ranks = new int[sorted_ptr[nnodes]];
+  MPI_Alltoallv(send_ranks, send_count, send_ptr, MPI_INT, sorted_ranks,
+                recv_count, recv_ptr, MPI_INT, comm);
+
+  // Place the ranks in the original order of the nodes
+  int *node_ptr = new int[nnodes + 1];
+  int *ranks = new int[sorted_ptr[nnodes]];
+  node_ptr[0] = 0;
+  for (int i = 0; i < nnodes; i++) {
+    int j = TacsSearchArray(nodes[i], nnodes, sorted) - sorted;
+    node_ptr[i + 1] = node_ptr[i] + sorted_ptr[j + 1] - sorted_ptr[j];
+    memcpy(&ranks[node_ptr[i]], &sorted_ranks[sorted_ptr[j]],
+           (sorted_ptr[j + 1] - sorted_ptr[j]) * sizeof(int));
+  }
+
+  delete[] sorted;
+  delete[] ptr;
+  delete[] count;
+  delete[] in_count;
+  delete[] in_ptr;
+  delete[] in_nodes;
+  delete[] pairs;
+  delete[] in_len;
+  delete[] send_count;
+  delete[] send_ptr;
+  delete[] sorted_ptr;
+  delete[] recv_count;
+  delete[] recv_ptr;
+  delete[] send_ranks;
+  delete[] sorted_ranks;
+
+  *_ptr = node_ptr;
+  *_ranks = ranks;
+}
+
+/*!
+  Create the BDDC preconditioner for the Schur matrix
+
+  The primal nodes and the coarse problem are determined from the
+  interface nodes of the matrix. This is collective on the
+  communicator of the matrix.
+
+  input:
+  mat:           the TACSSchurMat matrix for the preconditioner
+  levFill:       the level of fill for the local factorization
+  fill:          the expected fill-in factor for the local factorization
+  coarse_ranks:  the number of ranks used for the coarse direct solve
+*/
+TACSBDDCPc::TACSBDDCPc(TACSSchurMat *_mat, int levFill, double fill,
+                       int _coarse_ranks) {
+  mat = _mat;
+  mat->incref();
+  coarse_ranks = _coarse_ranks;
+
+  mat->getBCSRMat(&B, &E, &F, &C);
+  B->incref();
+  E->incref();
+  F->incref();
+  C->incref();
+
+  int bsize = B->getBlockSize();
+  nb = B->getRowDim();
+  nc = C->getRowDim();
+
+  b_map = mat->getLocalMap();
+  c_map = mat->getSchurMap();
+  b_map->incref();
+  c_map->incref();
+  b_ctx = b_map->createCtx(bsize);
+  c_ctx = c_map->createCtx(bsize);
+  b_ctx->incref();
+  c_ctx->incref();
+
+  TACSNodeMap *rmap = mat->getNodeMap();
+  MPI_Comm comm = rmap->getMPIComm();
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  // Create the non-zero pattern of the local Neumann matrix
+  const int *brow, *bcol, *erow, *ecol, *frow, *fcol, *crow, *ccol;
+  B->getArrays(NULL, NULL, NULL, &brow, &bcol, NULL);
+  E->getArrays(NULL, NULL, NULL, &erow, &ecol, NULL);
+  F->getArrays(NULL, NULL, NULL, &frow, &fcol, NULL);
+  C->getArrays(NULL, NULL, NULL, &crow, &ccol, NULL);
+
+  int n = nb + nc;
+  int *rowp = new int[n + 1];
+  int *cols = new int[brow[nb] + erow[nb] + frow[nc] + crow[nc]];
+  rowp[0] = 0;
+  for (int i = 0; i < nb; i++) {
+    int index = rowp[i];
+    for (int jp = brow[i]; jp < brow[i + 1]; jp++, index++) {
+      cols[index] = bcol[jp];
+    }
+    for (int jp = erow[i]; jp < erow[i + 1]; jp++, index++) {
+      cols[index] = nb + ecol[jp];
+    }
+    rowp[i + 1] = index;
+  }
+  for (int i = 0; i < nc; i++) {
+    int index = rowp[nb + i];
+    for (int jp = frow[i]; jp < frow[i + 1]; jp++, index++) {
+      cols[index] = fcol[jp];
+    }
+    for (int jp = crow[i]; jp < crow[i + 1]; jp++, index++) {
+      cols[index] = nb + ccol[jp];
+    }
+    rowp[nb + i + 1] = index;
+  }
+
+  K = new BCSRMat(comm, B->getThreadInfo(), bsize, n, n, &rowp, &cols);
+  K->incref();
+
+  // Form the factorization of the local Neumann matrix. The B
+  // variables are ordered first, so the leading block of the
+  // factorization is the factorization of B.
+  Kpc = new BCSRMat(comm, K, levFill, fill);
+  Kpc->incref();
+
+  // Find the processors that share each interface node
+  const int *cvars;
+  c_map->getIndices()->getIndices(&cvars);
+  int *set_ptr, *set_ranks;
+  TacsComputeSharedRanks(rmap, nc, cvars, &set_ptr, &set_ranks);
+
+  weights = new TacsScalar[nc];
+  for (int i = 0; i < nc; i++) {
+    int count = set_ptr[i + 1] - set_ptr[i];
+    weights[i] = (count > 0 ? 1.0 / count : 1.0);
+  }
+
+  // Group the interface nodes into classes of nodes shared by the same
+  // set of processors. Select the nodes with the lowest and highest
+  // global index in each class as primal nodes.
+  int num_classes = 0;
+  int *class_rep = new int[nc];
+  int *class_min = new int[nc];
+  int *class_max = new int[nc];
+  for (int i = 0; i < nc; i++) {
+    int len = set_ptr[i + 1] - set_ptr[i];
+    if (len < 2) {
+      continue;
+    }
+
+    int c = 0;
+    for (; c < num_classes; c++) {
+      int r = class_rep[c];
+      if (set_ptr[r + 1] - set_ptr[r] == len &&
+          memcmp(&set_ranks[set_ptr[r]], &set_ranks[set_ptr[i]],
+                 len * sizeof(int)) == 0) {
+        break;
+      }
+    }
+    if (c == num_classes) {
+      class_rep[c] = class_min[c] = class_max[c] = i;
+      num_classes++;
+    } else {
+      if (cvars[i] < cvars[class_min[c]]) {
+        class_min[c] = i;
+      }
+      if (cvars[i] > cvars[class_max[c]]) {
+        class_max[c] = i;
+      }
+    }
+  }
+
+  is_primal = new int[n];
+  for (int i = 0; i < n; i++) {
+    is_primal[i] = 0;
+  }
+  for (int c = 0; c < num_classes; c++) {
+    is_primal[nb + class_min[c]] = 1;
+    is_primal[nb + class_max[c]] = 1;
+  }
+  delete[] class_rep;
+  delete[] class_min;
+  delete[] class_max;
+
+  num_primal = 0;
+  for (int i = 0; i < nc; i++) {
+    if (is_primal[nb + i]) {
+      num_primal++;
+    }
+  }
+  primal = new int[num_primal];
+  for (int i = 0, j = 0; i < nc; i++) {
+    if (is_primal[nb + i]) {
+      primal[j] = i;
+      j++;
+    }
+  }
+
+  // The coarse nodes are owned by the lowest rank that shares them
+  int num_owned = 0;
+  for (int j = 0; j < num_primal; j++) {
+    if (set_ranks[set_ptr[primal[j]]] == mpi_rank) {
+      num_owned++;
+    }
+  }
+  int offset = 0;
+  MPI_Scan(&num_owned, &offset, 1, MPI_INT, MPI_SUM, comm);
+  offset -= num_owned;
+  MPI_Allreduce(&num_owned, &num_global_primal, 1, MPI_INT, MPI_SUM, comm);
+
+  // Distribute the coarse indices to the processors that share them
+  TACSBVecDistCtx *ctx = c_map->createCtx(1);
+  ctx->incref();
+  TACSBVec *index_vec = new TACSBVec(rmap, 1);
+  index_vec->incref();
+  TacsScalar *index_vals = new TacsScalar[nc];
+  memset(index_vals, 0, nc * sizeof(TacsScalar));
+  for (int j = 0, k = offset; j < num_primal; j++) {
+    if (set_ranks[set_ptr[primal[j]]] == mpi_rank) {
+      index_vals[primal[j]] = k + 1;
+      k++;
+    }
+  }
+
+  TacsScalar *ivals;
+  index_vec->getArray(&ivals);
+  c_map->beginReverse(ctx, index_vals, ivals, TACS_ADD_VALUES);
+  c_map->endReverse(ctx, index_vals, ivals, TACS_ADD_VALUES);
+  c_map->beginForward(ctx, ivals, index_vals);
+  c_map->endForward(ctx, ivals, index_vals);
+
+  coarse_index = new int[num_primal];
+  for (int j = 0; j < num_primal; j++) {
+    coarse_index[j] = (int)TacsRealPart(index_vals[primal[j]]) - 1;
+  }
+  delete[] index_vals;
+  index_vec->decref();
+  ctx->decref();
+
+  delete[] set_ptr;
+  delete[] set_ranks;
+
+  // Create the coarse problem. Each processor contributes a dense
+  // block for its primal nodes.
+  coarse_mat = NULL;
+  coarse_pc = NULL;
+  coarse_dist = NULL;
+  coarse_ctx = NULL;
+  coarse_x = coarse_y = NULL;
+  if (num_global_primal > 0) {
+    TACSNodeMap *coarse_map = new TACSNodeMap(comm, num_owned);
+    int *indices = new int[num_primal];
+    memcpy(indices, coarse_index, num_primal * sizeof(int));
+    TACSBVecIndices *coarse_indices = new TACSBVecIndices(&indices, num_primal);
+    coarse_indices->incref();
+
+    int *crowp = new int[num_primal + 1];
+    int *ccols = new int[num_primal * num_primal];
+    crowp[0] = 0;
+    for (int i = 0; i < num_primal; i++) {
+      for (int j = 0; j < num_primal; j++) {
+        ccols[crowp[i] + j] = j;
+      }
+      crowp[i + 1] = crowp[i] + num_primal;
+    }
+
+    coarse_mat =
+        new TACSParallelMat(B->getThreadInfo(), coarse_map, bsize, num_primal,
+                            crowp, ccols, coarse_indices);
+    coarse_mat->incref();
+    delete[] crowp;
+    delete[] ccols;
+
+    coarse_pc = new TACSBlockCyclicPc(coarse_mat, 4, 1, coarse_ranks);
+    coarse_pc->incref();
+
+    coarse_dist = new TACSBVecDistribute(coarse_map, coarse_indices);
+    coarse_dist->incref();
+    coarse_ctx = coarse_dist->createCtx(bsize);
+    coarse_ctx->incref();
+    coarse_indices->decref();
+
+    coarse_x = dynamic_cast<TACSBVec *>(coarse_mat->createVec());
+    coarse_y = dynamic_cast<TACSBVec *>(coarse_mat->createVec());
+    coarse_x->incref();
+    coarse_y->incref();
+  }
+
+  // Allocate the primal basis functions and the coarse contribution
+  int np = bsize * num_primal;
+  Psi = new TacsScalar[bsize * nc * np];
+  Sp = new TacsScalar[np * np];
+  memset(Psi, 0, bsize * nc * np * sizeof(TacsScalar));
+  memset(Sp, 0, np * np * sizeof(TacsScalar));
+
+  // Allocate the local work arrays
+  xlocal = new TacsScalar[bsize * nb];
+  rc = new TacsScalar[bsize * nc];
+  tc = new TacsScalar[bsize * nc];
+  wlocal = new TacsScalar[bsize * n];
+  zlocal = new TacsScalar[bsize * n];
+  pc_vals = new TacsScalar[np];
+
+  temp = new TACSBVec(rmap, bsize);
+  temp->incref();
+}
+
+/*
+  Free the BDDC preconditioner
+*/
+TACSBDDCPc::~TACSBDDCPc() {
+  mat->decref();
+  B->decref();
+  E->decref();
+  F->decref();
+  C->decref();
+  K->decref();
+  Kpc->decref();
+  b_map->decref();
+  c_map->decref();
+  b_ctx->decref();
+  c_ctx->decref();
+
+  delete[] weights;
+  delete[] primal;
+  delete[] coarse_index;
+  delete[] is_primal;
+  delete[] Psi;
+  delete[] Sp;
+
+  if (coarse_mat) {
+    coarse_mat->decref();
+    coarse_pc->decref();
+    coarse_dist->decref();
+    coarse_ctx->decref();
+    coarse_x->decref();
+    coarse_y->decref();
+  }
+
+  delete[] xlocal;
+  delete[] rc;
+  delete[] tc;
+  delete[] wlocal;
+  delete[] zlocal;
+  delete[] pc_vals;
+  temp->decref();
+}
+
+/*
+  Get the total number of primal nodes in the coarse problem
+*/
+int TACSBDDCPc::getNumPrimalNodes() { return num_global_primal; }
+
+/*
+  Factor the BDDC preconditioner
+
+  1. Copy the values of B, E, F and C into the local Neumann matrix K.
+  The rows of boundary conditions on interface nodes that are zero on
+  this processor are given a unit diagonal.
+
+  2. Copy K into Kpc, replace the rows and columns of the primal
+  variables with the identity and factor Kpc.
+
+  3. Compute the primal basis functions Psi and their contributions
+  Psi^{T}*K*Psi to the coarse problem, then assemble and factor the
+  coarse problem.
+*/
+void TACSBDDCPc::factor() {
+  int bsize = B->getBlockSize();
+  int b2 = bsize * bsize;
+  int n = nb + nc;
+
+  const int *brow, *bcol, *erow, *ecol, *frow, *fcol, *crow, *ccol;
+  TacsScalar *Bv, *Ev, *Fv, *Cv;
+  B->getArrays(NULL, NULL, NULL, &brow, &bcol, &Bv);
+  E->getArrays(NULL, NULL, NULL, &erow, &ecol, &Ev);
+  F->getArrays(NULL, NULL, NULL, &frow, &fcol, &Fv);
+  C->getArrays(NULL, NULL, NULL, &crow, &ccol, &Cv);
+
+  // Copy the values into the local Neumann matrix
+  const int *rowp, *cols;
+  TacsScalar *Kv;
+  K->getArrays(NULL, NULL, NULL, &rowp, &cols, &Kv);
+  for (int i = 0; i < nb; i++) {
+    int len = b2 * (brow[i + 1] - brow[i]);
+    memcpy(&Kv[b2 * rowp[i]], &Bv[b2 * brow[i]], len * sizeof(TacsScalar));
+    memcpy(&Kv[b2 * rowp[i] + len], &Ev[b2 * erow[i]],
+           b2 * (erow[i + 1] - erow[i]) * sizeof(TacsScalar));
+  }
+  for (int i = 0; i < nc; i++) {
+    int len = b2 * (frow[i + 1] - frow[i]);
+    memcpy(&Kv[b2 * rowp[nb + i]], &Fv[b2 * frow[i]],
+           len * sizeof(TacsScalar));
+    memcpy(&Kv[b2 * rowp[nb + i] + len], &Cv[b2 * crow[i]],
+           b2 * (crow[i + 1] - crow[i]) * sizeof(TacsScalar));
+  }
+
+  // Set a unit diagonal for the rows that are zero
+  for (int i = 0; i < n; i++) {
+    for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      if (cols[jp] == i) {
+        TacsScalar *a = &Kv[b2 * jp];
+        for (int k = 0; k < bsize; k++) {
+          if (a[(bsize + 1) * k] == 0.0) {
+            a[(bsize + 1) * k] = 1.0;
+          }
+        }
+      }
+    }
+  }
+
+  // Constrain the primal variables and factor
+  Kpc->copyValues(K);
+  const int *prowp, *pcols;
+  TacsScalar *Pv;
+  Kpc->getArrays(NULL, NULL, NULL, &prowp, &pcols, &Pv);
+  for (int i = 0; i < n; i++) {
+    for (int jp = prowp[i]; jp < prowp[i + 1]; jp++) {
+      if (is_primal[i] || is_primal[pcols[jp]]) {
+        TacsScalar *a = &Pv[b2 * jp];
+        memset(a, 0, b2 * sizeof(TacsScalar));
+        if (pcols[jp] == i) {
+          for (int k = 0; k < bsize; k++) {
+            a[(bsize + 1) * k] = 1.0;
+          }
+        }
+      }
+    }
+  }
+  Kpc->factor();
+
+  // Compute the primal basis functions and the coarse contributions
+  int np = bsize * num_primal;
+  int offset = bsize * nb;
+  for (int j = 0; j < np; j++) {
+    int dof = bsize * (nb + primal[j / bsize]) + (j % bsize);
+
+    // Compute the column of K
+    memset(zlocal, 0, bsize * n * sizeof(TacsScalar));
+    zlocal[dof] = 1.0;
+    K->mult(zlocal, wlocal);
+
+    // Solve Kc*w = -K*e_j with the primal variables set to zero
+    for (int i = 0; i < bsize * n; i++) {
+      wlocal[i] = -wlocal[i];
+    }
+    for (int p = 0; p < num_primal; p++) {
+      for (int k = 0; k < bsize; k++) {
+        wlocal[bsize * (nb + primal[p]) + k] = 0.0;
+      }
+    }
+    Kpc->applyFactor(wlocal, zlocal);
+    zlocal[dof] = 1.0;
+
+    memcpy(&Psi[j * bsize * nc], &zlocal[offset],
+           bsize * nc * sizeof(TacsScalar));
+
+    // Compute the row of the coarse contribution
+    K->mult(zlocal, wlocal);
+    for (int p = 0; p < num_primal; p++) {
+      for (int k = 0; k < bsize; k++) {
+        Sp[(bsize * p + k) * np + j] = wlocal[bsize * (nb + primal[p]) + k];
+      }
+    }
+  }
+
+  // Assemble and factor the coarse problem
+  if (coarse_mat) {
+    coarse_mat->zeroEntries();
+    coarse_mat->addValues(num_primal, coarse_index, num_primal, coarse_index,
+                          np, np, Sp);
+    coarse_mat->beginAssembly();
+    coarse_mat->endAssembly();
+    coarse_pc->factor();
+  }
+}
+
+/*
+  Solve with B using the leading block of the factorization of the
+  constrained Neumann matrix. The input is the interior part of the
+  array x of length bsize*(nb + nc), the remainder of x is
+  overwritten.
+*/
+void TACSBDDCPc::applyInteriorFactor(TacsScalar *x) {
+  int offset = B->getBlockSize() * nb;
+  Kpc->applyLower(x, x);
+  memset(&x[offset], 0, B->getBlockSize() * nc * sizeof(TacsScalar));
+  Kpc->applyFactorSchur(x, nb);
+}
+
+/*!
+  Apply the BDDC preconditioner to the input vector
+
+  1. Eliminate the interior unknowns: g' = g - F B^{-1} f
+  2. Apply the BDDC preconditioner to the interface residual g' to
+  obtain the interface unknowns y
+  3. Compute the interior unknowns: x = B^{-1} (f - E y)
+*/
+void TACSBDDCPc::applyFactor(TACSVec *tin, TACSVec *tout) {
+  TACSBVec *invec, *outvec;
+  invec = dynamic_cast<TACSBVec *>(tin);
+  outvec = dynamic_cast<TACSBVec *>(tout);
+
+  if (invec && outvec) {
+    int bsize = B->getBlockSize();
+    int nbs = bsize * nb;
+    int ncs = bsize * nc;
+    int np = bsize * num_primal;
+
+    TacsScalar *in, *out, *t;
+    invec->getArray(&in);
+    outvec->getArray(&out);
+    temp->getArray(&t);
+
+    // Retrieve the interior and interface residuals
+    b_map->beginForward(b_ctx, in, xlocal);
+    c_map->beginForward(c_ctx, in, rc);
+    b_map->endForward(b_ctx, in, xlocal);
+
+    // Compute F B^{-1} f
+    memcpy(zlocal, xlocal, nbs * sizeof(TacsScalar));
+    applyInteriorFactor(zlocal);
+    F->mult(zlocal, tc);
+    c_map->endForward(c_ctx, in, rc);
+
+    // Assemble the interface residual g - F B^{-1} f
+    temp->zeroEntries();
+    c_map->beginReverse(c_ctx, tc, t, TACS_ADD_VALUES);
+    c_map->endReverse(c_ctx, tc, t, TACS_ADD_VALUES);
+    c_map->beginForward(c_ctx, t, tc);
+    c_map->endForward(c_ctx, t, tc);
+    for (int i = 0; i < nc; i++) {
+      for (int k = 0; k < bsize; k++) {
+        int index = bsize * i + k;
+        rc[index] = weights[i] * (rc[index] - tc[index]);
+      }
+    }
+
+    // Compute the coarse right-hand-side
+    for (int j = 0; j < np; j++) {
+      const TacsScalar *psi = &Psi[j * ncs];
+      TacsScalar d = 0.0;
+      for (int i = 0; i < ncs; i++) {
+        d += psi[i] * rc[i];
+      }
+      pc_vals[j] = d;
+    }
+    if (coarse_mat) {
+      TacsScalar *cx;
+      coarse_x->zeroEntries();
+      coarse_x->getArray(&cx);
+      coarse_dist->beginReverse(coarse_ctx, pc_vals, cx, TACS_ADD_VALUES);
+      coarse_dist->endReverse(coarse_ctx, pc_vals, cx, TACS_ADD_VALUES);
+    }
+
+    // Solve the local problem with the primal variables constrained
+    memset(zlocal, 0, nbs * sizeof(TacsScalar));
+    memcpy(&zlocal[nbs], rc, ncs * sizeof(TacsScalar));
+    for (int p = 0; p < num_primal; p++) {
+      for (int k = 0; k < bsize; k++) {
+        zlocal[nbs + bsize * primal[p] + k] = 0.0;
+      }
+    }
+    Kpc->applyFactor(zlocal, wlocal);
+    TacsScalar *yc = &wlocal[nbs];
+
+    // Add the coarse correction
+    if (coarse_mat) {
+      TacsScalar *cy;
+      coarse_pc->applyFactor(coarse_x, coarse_y);
+      coarse_y->getArray(&cy);
+      coarse_dist->beginForward(coarse_ctx, cy, pc_vals);
+      coarse_dist->endForward(coarse_ctx, cy, pc_vals);
+
+      for (int j = 0; j < np; j++) {
+        const TacsScalar *psi = &Psi[j * ncs];
+        for (int i = 0; i < ncs; i++) {
+          yc[i] += pc_vals[j] * psi[i];
+        }
+      }
+    }
+
+    // Average the interface values
+    for (int i = 0; i < nc; i++) {
+      for (int k = 0; k < bsize; k++) {
+        yc[bsize * i + k] *= weights[i];
+      }
+    }
+    outvec->zeroEntries();
+    c_map->beginReverse(c_ctx, yc, out, TACS_ADD_VALUES);
+    c_map->endReverse(c_ctx, yc, out, TACS_ADD_VALUES);
+    c_map->beginForward(c_ctx, out, yc);
+    c_map->endForward(c_ctx, out, yc);
+
+    // Compute the interior unknowns x = B^{-1} (f - E y)
+    E->mult(yc, zlocal);
+    for (int i = 0; i < nbs; i++) {
+      zlocal[i] = xlocal[i] - zlocal[i];
+    }
+    applyInteriorFactor(zlocal);
+
+    b_map->beginReverse(b_ctx, zlocal, out, TACS_INSERT_VALUES);
+    b_map->endReverse(b_ctx, zlocal, out, TACS_INSERT_VALUES);
+  } else {
+    fprintf(stderr, "TACSBDDCPc type error: Input/output must be TACSBVec\n");
+  }
+}
+
+/*
+  Retrieve the underlying matrix
+*/
+void TACSBDDCPc::getMat(TACSMat **_mat) { *_mat = mat; }
@@ -27,6 +27,7 @@
 #include "TACSBVec.h"
 #include "TACSBVecDistribute.h"
 #include "TACSBlockCyclicMat.h"
+#include "TACSParallelMat.h"
 
 /*!
   A class for a distributed finite-element matrix.
@@ -153,9 +154,18 @@ class TACSSchurPc : public TACSPc {
   // -------------------------------------------
   void factor();
   void applyFactor(TACSVec *xvec, TACSVec *yvec);
+  void applyFactorMulti(int nvecs, TACSVec **xvecs, TACSVec **yvecs);
   void getMat(TACSMat **_mat);
   void testSchurComplement(TACSVec *in, TACSVec *out);
 
+  // Compute the inertia of the factored matrix
+  // ------------------------------------------
+  void getInertia(int *nneg, int *npos);
+
+  // Get the number of entries stored in the Schur complement factor
+  // ---------------------------------------------------------------
+  size_t getNumSchurFactorEntries();
+
   // Monitor the factorization time on each process
   // ----------------------------------------------
   void setMonitorFactorFlag(int flag);
@@ -165,12 +175,32 @@ class TACSSchurPc : public TACSPc {
   // --------------------------------------
   void setAlltoallAssemblyFlag(int flag);
 
+  // Store the diagonal factor in single precision
+  // ---------------------------------------------
+  void setSinglePrecisionFactor(int flag);
+
+  // Factor the real part of the diagonal block in complex mode
+  // ----------------------------------------------------------
+  void setRealPartFactor(int flag);
+
+  // Factor the global Schur complement on the device
+  // ------------------------------------------------
+  void setDeviceFactorFlag(int flag);
+
   // Get the underlying precondition representation
   // ----------------------------------------------
   void getBCSRMat(BCSRMat **_Bpc, BCSRMat **_Epc, BCSRMat **_Fpc,
                   BCSRMat **_Sc);
 
  private:
+  // Compute the supernodal ordering of the global Schur complement
+  void compute_supernodal_order(int root, int num_unique, int num_root,
+                                const int *count, const int *ptr,
+                                int *schur_root, int *unique_schur,
+                                const int *rowp, const int *cols,
+                                int max_size, int use_nd, int *num_snodes,
+                                int *snode_ptr);
+
   TACSSchurMat *mat;
   BCSRMat *B, *E, *F, *C;    // The block matrices
   BCSRMat *Bpc, *Epc, *Fpc;  // The diagonal contributions
@@ -183,6 +213,8 @@ class TACSSchurPc : public TACSPc {
 
   int monitor_factor;      // Monitor the factorization time
   int monitor_back_solve;  // Monitor the back-solves
+  int single_factor;       // Store the factor of Bpc in single precision
+  int real_factor;         // Factor the real part of Bpc in complex mode
 
   // The sparse block cyclic matrix
   TACSBlockCyclicMat *bcyclic;  // This stores the Schur complement
@@ -211,4 +243,101 @@ class TACSSchurPc : public TACSPc {
   TACSBVec *gschur, *yschur;  // The Schur complement vectors
 };
 
+/*!
+  Balancing domain decomposition by constraints (BDDC) preconditioner.
+
+  This preconditioner uses the same split of the unknowns into the
+  interior (B) and interface (C) variables on each processor as
+  TACSSchurPc, but replaces the factorization of the global Schur
+  complement with the BDDC preconditioner for the interface problem.
+  The interior unknowns are eliminated exactly with the factorization
+  of B, and only a small coarse problem is solved globally.
+
+  Each processor forms the local Neumann matrix
+
+  K = [ B, E ]
+  .   [ F, C ]
+
+  The interface nodes are grouped into classes of nodes that are
+  shared by the same set of processors. The nodes with the lowest and
+  highest global index in each class are selected as primal nodes,
+  whose values are continuous across the processors. This selection
+  is consistent on all the processors that share a class and, for
+  most meshes, removes the rigid body modes from the local problems.
+
+  The BDDC preconditioner for the interface residual r is
+
+  u = sum_{i} R_{i}^{T} D_{i} (K_{c}^{-1} D_{i} R_{i} r + Psi_{i} u_{0})
+
+  where D_{i} scales the interface nodes by the inverse of the number
+  of processors that share them, K_{c} is the local Neumann matrix with
+  the primal variables constrained to zero, and Psi_{i} are the
+  energy-minimizing basis functions that take unit values at the
+  primal variables. The coarse correction u_{0} is the solution of the
+  coarse problem formed from sum_{i} Psi_{i}^{T} K Psi_{i}, which is
+  factored with the parallel direct solver.
+
+  The factorization of K_{c} contains the factorization of B, so only
+  one local factorization is stored. Application of the preconditioner
+  requires only the exchange of the interface values with neighboring
+  processors and the coarse solve.
+*/
+class TACSBDDCPc : public TACSPc {
+ public:
+  TACSBDDCPc(TACSSchurMat *_mat, int levFill, double fill,
+             int _coarse_ranks = -1);
+  ~TACSBDDCPc();
+
+  // Functions associated with the factorization
+  // -------------------------------------------
+  void factor();
+  void applyFactor(TACSVec *xvec, TACSVec *yvec);
+  void getMat(TACSMat **_mat);
+
+  // Get the total number of primal nodes in the coarse problem
+  // ----------------------------------------------------------
+  int getNumPrimalNodes();
+
+ private:
+  // Solve with B using the leading block of the factorization
+  void applyInteriorFactor(TacsScalar *x);
+
+  TACSSchurMat *mat;
+  BCSRMat *B, *E, *F, *C;  // The block matrices
+  BCSRMat *K;              // The local Neumann matrix [B, E; F, C]
+  BCSRMat *Kpc;            // Factorization with constrained primal nodes
+
+  TACSBVecDistribute *b_map;  // The map for the local entries
+  TACSBVecDistribute *c_map;  // The map for the interface entries
+  TACSBVecDistCtx *b_ctx;
+  TACSBVecDistCtx *c_ctx;
+
+  // The number of interior and interface nodes
+  int nb, nc;
+
+  // The inverse of the number of processors sharing each interface node
+  TacsScalar *weights;
+
+  // The primal nodes as local interface indices and coarse indices
+  int num_primal, num_global_primal;
+  int *primal, *coarse_index;
+  int *is_primal;  // Flag for each node in K
+
+  // The interface values of the primal basis functions and the local
+  // contribution to the coarse problem
+  TacsScalar *Psi, *Sp;
+
+  // The coarse problem
+  int coarse_ranks;
+  TACSParallelMat *coarse_mat;
+  TACSBlockCyclicPc *coarse_pc;
+  TACSBVecDistribute *coarse_dist;
+  TACSBVecDistCtx *coarse_ctx;
+  TACSBVec *coarse_x, *coarse_y;
+
+  // Local and global work arrays
+  TacsScalar *xlocal, *rc, *tc, *wlocal, *zlocal, *pc_vals;
+  TACSBVec *temp;
+};
+
 #endif  // TACS_SCHUR_MATRIX_H
@@ -14,6 +14,8 @@
 
 #include "TACSSerialPivotMat.h"
 
+#include "tacslapack.h"
+
 /*
   Compare integers for binary searches
 */
@@ -254,6 +256,12 @@ TACSSerialPivotPc::TACSSerialPivotPc(TACSSerialPivotMat *_mat) {
   fill = 10.0;
   pivot = new BCSCMatPivot(mat->getBCSCMat());
   pivot->incref();
+
+  // No iterative refinement is needed with the default factor
+  max_refine_iters = 0;
+  refine_rtol = 0.0;
+  refine_size = 0;
+  refine_work = NULL;
 }
 
 /*
@@ -262,6 +270,39 @@ TACSSerialPivotPc::TACSSerialPivotPc(TACSSerialPivotMat *_mat) {
 TACSSerialPivotPc::~TACSSerialPivotPc() {
   mat->decref();
   pivot->decref();
+  if (refine_work) {
+    delete[] refine_work;
+  }
+}
+
+/*
+  Compute and store the factorization in single precision.
+
+  The single-precision factor requires half the memory and bandwidth
+  of the full factor. To recover the accuracy of the solution, the
+  application of the factor is followed by iterative refinement with
+  the residual computed in full precision:
+
+  r = x - A*y,  y <- y + (LU)^{-1}*r
+
+  The refinement stops when ||r|| <= refine_rtol*||x|| or after
+  max_refine_iters iterations. The iterations converge when the matrix
+  is not too ill-conditioned relative to single precision. Otherwise,
+  use the preconditioner within GMRES, which then requires only the
+  single-precision accuracy of the factor.
+
+  The single-precision factor is not available in complex mode.
+
+  input:
+  flag:               use the single-precision factor
+  _max_refine_iters:  maximum number of refinement iterations
+  _refine_rtol:       relative tolerance on the residual
+*/
+void TACSSerialPivotPc::setSinglePrecision(int flag, int _max_refine_iters,
+                                           double _refine_rtol) {
+  pivot->setSinglePrecision(flag);
+  max_refine_iters = _max_refine_iters;
+  refine_rtol = _refine_rtol;
 }
 
 /*
@@ -301,6 +342,41 @@ void TACSSerialPivotPc::applyFactor(TACSVec *txvec, TACSVec *tyvec) {
 
     // Apply the factor
     pivot->applyFactor(y, 1);
+
+    if (pivot->isSinglePrecision() && max_refine_iters > 0) {
+      if (size > refine_size) {
+        if (refine_work) {
+          delete[] refine_work;
+        }
+        refine_size = size;
+        refine_work = new TacsScalar[refine_size];
+      }
+
+      // Compute the norm of the right-hand-side
+      int one = 1;
+      double xnorm = BLASnrm2(&size, x, &one);
+
+      BCSCMat *bmat = mat->getBCSCMat();
+      TacsScalar *r = refine_work;
+      for (int k = 0; k < max_refine_iters; k++) {
+        // Compute the residual r = x - A*y in full precision
+        bmat->mult(y, r, 1);
+        for (int i = 0; i < size; i++) {
+          r[i] = x[i] - r[i];
+        }
+
+        double rnorm = BLASnrm2(&size, r, &one);
+        if (rnorm <= refine_rtol * xnorm) {
+          break;
+        }
+
+        // Apply the correction y <- y + (LU)^{-1}*r
+        pivot->applyFactor(r, 1);
+        for (int i = 0; i < size; i++) {
+          y[i] += r[i];
+        }
+      }
+    }
   }
 }
 
@@ -74,10 +74,21 @@ class TACSSerialPivotPc : public TACSPc {
   void applyFactor(TACSVec *txvec, TACSVec *tyvec);
   void getMat(TACSMat **_mat);
 
+  // Use a single-precision factor with iterative refinement
+  // -------------------------------------------------------
+  void setSinglePrecision(int flag, int _max_refine_iters = 3,
+                          double _refine_rtol = 1e-12);
+
  private:
   TACSSerialPivotMat *mat;
   double fill;
   BCSCMatPivot *pivot;
+
+  // Data for the iterative refinement
+  int max_refine_iters;
+  double refine_rtol;
+  int refine_size;
+  TacsScalar *refine_work;
 };
 
 #endif  // TACS_SERIAL_PIVOT_MATRIX_H
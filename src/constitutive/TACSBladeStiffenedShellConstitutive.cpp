@@ -210,6 +210,9 @@ TACSBladeStiffenedShellConstitutive::TACSBladeStiffenedShellConstitutive(
   // Arrays for storing ply failure sensitivities
   this->panelPlyFailSens = new TacsScalar[2 * this->numPanelPlies];
   this->stiffenerPlyFailSens = new TacsScalar[this->numPanelPlies];
+
+  // Store the stiffness and critical loads for the initial design
+  this->updateCache();
 }
 
 // ==============================================================================
@@ -341,6 +344,7 @@ void TACSBladeStiffenedShellConstitutive::setStiffenerPlyFractions(
   for (int ii = 0; ii < this->numStiffenerPlies; ii++) {
     this->stiffenerPlyFracs[ii] = plyFractions[ii];
   }
+  this->updateCache();
 }
 
 void TACSBladeStiffenedShellConstitutive::setPanelPlyFractions(
@@ -348,6 +352,7 @@ void TACSBladeStiffenedShellConstitutive::setPanelPlyFractions(
   for (int ii = 0; ii < this->numPanelPlies; ii++) {
     this->panelPlyFracs[ii] = plyFractions[ii];
   }
+  this->updateCache();
 }
 
 // ==============================================================================
@@ -416,6 +421,7 @@ int TACSBladeStiffenedShellConstitutive::setDesignVars(int elemIndex, int dvLen,
         this->stiffenerPlyFracs[ii] = dvs[this->stiffenerPlyFracLocalNums[ii]];
       }
     }
+    this->updateCache();
   }
   return this->numDesignVars;
 }
@@ -725,7 +731,7 @@ void TACSBladeStiffenedShellConstitutive::evalStress(int elemIndex,
 
   // Just compute the stiffness matrix and multiply by the strain
   TacsScalar C[NUM_TANGENT_STIFFNESS_ENTRIES];
-  this->computeStiffness(C);
+  this->getStiffness(C);
   TacsScalar* A = &C[0];
   TacsScalar* B = &C[6];
   TacsScalar* D = &C[12];
@@ -823,7 +829,20 @@ void TACSBladeStiffenedShellConstitutive::addStressDVSens(
 // Evaluate the tangent stiffness
 void TACSBladeStiffenedShellConstitutive::evalTangentStiffness(
     int elemIndex, const double pt[], const TacsScalar X[], TacsScalar C[]) {
-  this->computeStiffness(C);
+  this->getStiffness(C);
+}
+
+// Evaluate the tangent stiffness at a batch of points, the stiffness does not
+// depend on the point or element so it is only computed once
+void TACSBladeStiffenedShellConstitutive::evalTangentStiffnessBatch(
+    int npts, const int elemIndex[], const double pt[], const TacsScalar X[],
+    TacsScalar C[]) {
+  TacsScalar C0[NUM_TANGENT_STIFFNESS_ENTRIES];
+  this->getStiffness(C0);
+  for (int ii = 0; ii < npts; ii++) {
+    memcpy(&C[NUM_TANGENT_STIFFNESS_ENTRIES * ii], C0,
+           NUM_TANGENT_STIFFNESS_ENTRIES * sizeof(TacsScalar));
+  }
 }
 
 // ==============================================================================
@@ -850,34 +869,17 @@ TacsScalar TACSBladeStiffenedShellConstitutive::computeFailureValues(
   fails[1] = this->computeStiffenerFailure(stiffenerStrain);
 
   // --- Local panel buckling ---
-  // Compute panel stiffness matrix and loads
-  TacsScalar panelStiffness[NUM_TANGENT_STIFFNESS_ENTRIES],
-      stress[NUM_STRESSES];
-  this->computePanelStiffness(panelStiffness);
-  const TacsScalar *A, *D;
-  this->extractTangentStiffness(panelStiffness, &A, NULL, &D, NULL, NULL);
+  // Compute the panel loads, the critical local loads only depend on the
+  // design variables so the stored values are used
+  TacsScalar stress[NUM_STRESSES];
   this->computePanelStress(e, stress);
-
-  // Compute the critical local loads
-  TacsScalar N1Crit, N12Crit;
-  TacsScalar D11 = D[0], D12 = D[1], D22 = D[3], D66 = D[5],
-             L = this->stiffenerPitch;
-  N1Crit = this->computeCriticalLocalAxialLoad(D11, D22, D12, D66, L);
-  N12Crit = this->computeCriticalShearLoad(D11, D22, D12 + 2.0 * D66, L);
-
-  // Compute the buckling criteria
-  fails[2] = this->bucklingEnvelope(-stress[0], N1Crit, stress[2], N12Crit);
+  fails[2] = this->bucklingEnvelope(-stress[0], this->N1CritLocalCache,
+                                    stress[2], this->N12CritLocalCache);
 
   // --- Global buckling ---
-  TacsScalar D1, D2, D3;
-  this->computeCriticalGlobalBucklingStiffness(&D1, &D2, &D3);
-  L = this->panelLength;
-
-  N1Crit = computeCriticalGlobalAxialLoad(D1, L);
-  N12Crit = this->computeCriticalShearLoad(D1, D2, D3, L);
-
   this->evalStress(0, NULL, NULL, e, stress);
-  fails[3] = this->bucklingEnvelope(-stress[0], N1Crit, stress[2], N12Crit);
+  fails[3] = this->bucklingEnvelope(-stress[0], this->N1CritGlobalCache,
+                                    stress[2], this->N12CritGlobalCache);
 
   return ksAggregation(fails, this->NUM_FAILURES, this->ksWeight);
 }
@@ -907,19 +909,16 @@ TacsScalar TACSBladeStiffenedShellConstitutive::evalFailureStrainSens(
   // Compute panel stiffness matrix and loads
   TacsScalar panelStiffness[NUM_TANGENT_STIFFNESS_ENTRIES],
       panelStress[NUM_STRESSES];
-  this->computePanelStiffness(panelStiffness);
-  const TacsScalar *APanel, *DPanel;
-  this->extractTangentStiffness(panelStiffness, &APanel, NULL, &DPanel, NULL,
+  this->getPanelStiffness(panelStiffness);
+  const TacsScalar *APanel;
+  this->extractTangentStiffness(panelStiffness, &APanel, NULL, NULL, NULL,
                                 NULL);
   this->computePanelStress(e, panelStress);
 
-  // Compute the critical local loads (no need to compute their sensitivities
+  // Get the critical local loads (no need to compute their sensitivities
   // because they're not dependent on the strain))
-  TacsScalar N1CritLocal, N12CritLocal;
-  TacsScalar D11 = DPanel[0], D12 = DPanel[1], D22 = DPanel[3], D66 = DPanel[5],
-             L = this->stiffenerPitch;
-  N1CritLocal = this->computeCriticalLocalAxialLoad(D11, D22, D12, D66, L);
-  N12CritLocal = this->computeCriticalShearLoad(D11, D22, D12 + 2.0 * D66, L);
+  TacsScalar N1CritLocal = this->N1CritLocalCache;
+  TacsScalar N12CritLocal = this->N12CritLocalCache;
 
   // Compute the buckling criteria and it's sensitivities
   TacsScalar N1LocalSens, N12LocalSens, N1CritLocalSens, N12CritLocalSens;
@@ -929,17 +928,14 @@ TacsScalar TACSBladeStiffenedShellConstitutive::evalFailureStrainSens(
 
   // --- Global buckling ---
   TacsScalar stiffness[NUM_TANGENT_STIFFNESS_ENTRIES], stress[NUM_STRESSES];
-  this->computeStiffness(stiffness);
+  this->getStiffness(stiffness);
   const TacsScalar *A, *B, *D, *As;
   TacsScalar drill;
   this->extractTangentStiffness(stiffness, &A, &B, &D, &As, &drill);
   this->computeStress(A, B, D, As, drill, e, stress);
   TacsScalar N1GlobalSens, N1CritGlobalSens, N12GlobalSens, N12CritGlobalSens;
-  TacsScalar D1, D2, D3;
-  this->computeCriticalGlobalBucklingStiffness(&D1, &D2, &D3);
-  L = this->panelLength;
-  TacsScalar N1CritGlobal = computeCriticalGlobalAxialLoad(D1, L);
-  TacsScalar N12CritGlobal = this->computeCriticalShearLoad(D1, D2, D3, L);
+  TacsScalar N1CritGlobal = this->N1CritGlobalCache;
+  TacsScalar N12CritGlobal = this->N12CritGlobalCache;
 
   fails[3] = this->bucklingEnvelopeSens(
       -stress[0], N1CritGlobal, stress[2], N12CritGlobal, &N1GlobalSens,
@@ -1018,7 +1014,7 @@ void TACSBladeStiffenedShellConstitutive::addFailureDVSens(
   // Compute panel stiffness matrix and loads
   TacsScalar panelStiffness[NUM_TANGENT_STIFFNESS_ENTRIES],
       panelStress[NUM_STRESSES];
-  this->computePanelStiffness(panelStiffness);
+  this->getPanelStiffness(panelStiffness);
   const TacsScalar *A, *D;
   this->extractTangentStiffness(panelStiffness, &A, NULL, &D, NULL, NULL);
   this->computePanelStress(strain, panelStress);
@@ -1261,6 +1257,50 @@ void TACSBladeStiffenedShellConstitutive::computeStiffness(TacsScalar C[]) {
   this->addStiffenerStiffness(Cstiff, C);
 }
 
+// Get the stiffness matrix, the stored matrix is only used if it was computed
+// with the current drilling regularization
+void TACSBladeStiffenedShellConstitutive::getStiffness(TacsScalar C[]) {
+  if (this->stiffnessCacheDrillReg == DRILLING_REGULARIZATION) {
+    memcpy(C, this->stiffnessCache,
+           this->NUM_TANGENT_STIFFNESS_ENTRIES * sizeof(TacsScalar));
+  } else {
+    this->computeStiffness(C);
+  }
+}
+
+// Get the panel stiffness matrix, the stored matrix is only used if it was
+// computed with the current drilling regularization
+void TACSBladeStiffenedShellConstitutive::getPanelStiffness(TacsScalar C[]) {
+  if (this->stiffnessCacheDrillReg == DRILLING_REGULARIZATION) {
+    memcpy(C, this->panelStiffnessCache,
+           this->NUM_TANGENT_STIFFNESS_ENTRIES * sizeof(TacsScalar));
+  } else {
+    this->computePanelStiffness(C);
+  }
+}
+
+// Recompute the stored stiffness matrices and the critical buckling loads,
+// which only depend on the design variables
+void TACSBladeStiffenedShellConstitutive::updateCache() {
+  this->computeStiffness(this->stiffnessCache);
+  this->computePanelStiffness(this->panelStiffnessCache);
+  this->stiffnessCacheDrillReg = DRILLING_REGULARIZATION;
+
+  const TacsScalar* D = &this->panelStiffnessCache[12];
+  TacsScalar D11 = D[0], D12 = D[1], D22 = D[3], D66 = D[5],
+             L = this->stiffenerPitch;
+  this->N1CritLocalCache =
+      this->computeCriticalLocalAxialLoad(D11, D22, D12, D66, L);
+  this->N12CritLocalCache =
+      this->computeCriticalShearLoad(D11, D22, D12 + 2.0 * D66, L);
+
+  TacsScalar D1, D2, D3;
+  this->computeCriticalGlobalBucklingStiffness(&D1, &D2, &D3);
+  L = this->panelLength;
+  this->N1CritGlobalCache = this->computeCriticalGlobalAxialLoad(D1, L);
+  this->N12CritGlobalCache = this->computeCriticalShearLoad(D1, D2, D3, L);
+}
+
 void TACSBladeStiffenedShellConstitutive::computeSmearedStiffness(
     const int numPlies, const TacsScalar* const QMats,
     const TacsScalar* const AbarMats, const TacsScalar plyFractions[],
@@ -1441,7 +1481,7 @@ void TACSBladeStiffenedShellConstitutive::addStrainTransformProductDVsens(
 void TACSBladeStiffenedShellConstitutive::computePanelStress(
     const TacsScalar strain[], TacsScalar stress[]) {
   TacsScalar C[this->NUM_TANGENT_STIFFNESS_ENTRIES];
-  this->computePanelStiffness(C);
+  this->getPanelStiffness(C);
 
   TacsScalar* A = &C[0];
   TacsScalar* B = &C[6];
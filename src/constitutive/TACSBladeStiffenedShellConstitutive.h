@@ -291,6 +291,11 @@ class TACSBladeStiffenedShellConstitutive : public TACSShellConstitutive {
   void evalTangentStiffness(int elemIndex, const double pt[],
                             const TacsScalar X[], TacsScalar C[]);
 
+  // Evaluate the tangent stiffness at a batch of points
+  void evalTangentStiffnessBatch(int npts, const int elemIndex[],
+                                 const double pt[], const TacsScalar X[],
+                                 TacsScalar C[]);
+
   // ==============================================================================
   // Compute failure criteria
   // ==============================================================================
@@ -378,6 +383,28 @@ class TACSBladeStiffenedShellConstitutive : public TACSShellConstitutive {
    */
   void computeStiffness(TacsScalar C[]);
 
+  /**
+   * @brief Get the stiffness matrix of the stiffened shell, using the stored
+   * stiffness matrix if it is up to date
+   *
+   * @param C Array to store the stiffness matrix in
+   */
+  void getStiffness(TacsScalar C[]);
+
+  /**
+   * @brief Get the stiffness matrix of the panel, using the stored stiffness
+   * matrix if it is up to date
+   *
+   * @param C Array to store the stiffness matrix in
+   */
+  void getPanelStiffness(TacsScalar C[]);
+
+  /**
+   * @brief Recompute the stored stiffness matrices and critical buckling
+   * loads, this must be called whenever the design variables change
+   */
+  void updateCache();
+
   /**
    * @brief Compute the Q and ABar Matrices for a laminate based on the Q and
    * ABar matrices for each ply
@@ -1020,6 +1047,17 @@ class TACSBladeStiffenedShellConstitutive : public TACSShellConstitutive {
   TacsScalar* panelAbarMats;
   TacsScalar* stiffenerAbarMats;
 
+  // --- Stiffness matrices and critical buckling loads for the current
+  // design variables ---
+  TacsScalar stiffnessCache[NUM_TANGENT_STIFFNESS_ENTRIES];
+  TacsScalar panelStiffnessCache[NUM_TANGENT_STIFFNESS_ENTRIES];
+  TacsScalar N1CritLocalCache;    ///< Critical local axial load
+  TacsScalar N12CritLocalCache;   ///< Critical local shear load
+  TacsScalar N1CritGlobalCache;   ///< Critical global axial load
+  TacsScalar N12CritGlobalCache;  ///< Critical global shear load
+  double stiffnessCacheDrillReg;  ///< Drilling regularization used to compute
+                                  ///< the stored stiffness
+
   // --- Design variable bounds ---
   TacsScalar panelLengthLowerBound = 0.0;
   TacsScalar panelLengthUpperBound = 1e20;
@@ -43,6 +43,8 @@ TACSCompositeShellConstitutive::TACSCompositeShellConstitutive(
 
   kcorr = _kcorr;
   tOffset = _tOffset;
+
+  computeLaminateStiffness(abd);
 }
 
 TACSCompositeShellConstitutive::~TACSCompositeShellConstitutive() {
@@ -114,51 +116,11 @@ void TACSCompositeShellConstitutive::evalStress(int elemIndex,
                                                 const TacsScalar X[],
                                                 const TacsScalar e[],
                                                 TacsScalar s[]) {
-  TacsScalar A[6], B[6], D[6], As[3], drill;
-
-  // Zero the stiffness matrices
-  for (int k = 0; k < 6; k++) {
-    A[k] = B[k] = D[k] = 0.0;
-  }
-
-  for (int k = 0; k < 3; k++) {
-    As[k] = 0.0;
-  }
-
-  // Compute the total thickness of the laminate
-  TacsScalar t = 0.0;
-  for (int i = 0; i < num_plies; i++) {
-    t += ply_thickness[i];
-  }
-
-  // Compute the contribution to the stiffness from each layer
-  TacsScalar t0 = -(0.5 + tOffset) * t;
-  for (int k = 0; k < num_plies; k++) {
-    TacsScalar Qbar[6], Abar[3];
-    ply_props[k]->calculateQbar(ply_angles[k], Qbar);
-    ply_props[k]->calculateAbar(ply_angles[k], Abar);
-
-    TacsScalar t1 = t0 + ply_thickness[k];
-
-    TacsScalar a = (t1 - t0);
-    TacsScalar b = 0.5 * (t1 * t1 - t0 * t0);
-    TacsScalar d = 1.0 / 3.0 * (t1 * t1 * t1 - t0 * t0 * t0);
-
-    for (int i = 0; i < 6; i++) {
-      A[i] += a * Qbar[i];
-      B[i] += b * Qbar[i];
-      D[i] += d * Qbar[i];
-    }
-
-    for (int i = 0; i < 3; i++) {
-      As[i] += kcorr * a * Abar[i];
-    }
-
-    // Update the position of the bottom interface
-    t0 = t1;
-  }
-
-  drill = 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
+  const TacsScalar *A = &abd[0];
+  const TacsScalar *B = &abd[6];
+  const TacsScalar *D = &abd[12];
+  const TacsScalar *As = &abd[18];
+  TacsScalar drill = 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
 
   // Evaluate the stress
   TACSShellConstitutive::computeStress(A, B, D, As, drill, e, s);
@@ -250,6 +212,32 @@ void TACSCompositeShellConstitutive::evalTangentStiffness(int elemIndex,
                                                           const double pt[],
                                                           const TacsScalar X[],
                                                           TacsScalar C[]) {
+  for (int i = 0; i < NUM_TANGENT_STIFFNESS_ENTRIES - 1; i++) {
+    C[i] = abd[i];
+  }
+  C[21] = 0.5 * DRILLING_REGULARIZATION * (abd[18] + abd[20]);
+}
+
+/*
+  Evaluate the tangent stiffness at a batch of points. The laminate
+  stiffness does not depend on the point or element, so it is copied
+  to each point.
+*/
+void TACSCompositeShellConstitutive::evalTangentStiffnessBatch(
+    int npts, const int elemIndex[], const double pt[], const TacsScalar X[],
+    TacsScalar C[]) {
+  TacsScalar C0[NUM_TANGENT_STIFFNESS_ENTRIES];
+  evalTangentStiffness(0, pt, X, C0);
+  for (int i = 0; i < npts; i++, C += NUM_TANGENT_STIFFNESS_ENTRIES) {
+    memcpy(C, C0, NUM_TANGENT_STIFFNESS_ENTRIES * sizeof(TacsScalar));
+  }
+}
+
+/*
+  Integrate the A, B, D and As matrices of the laminate through the
+  thickness. The drilling stiffness entry is set to zero.
+*/
+void TACSCompositeShellConstitutive::computeLaminateStiffness(TacsScalar C[]) {
   TacsScalar *A = &C[0];
   TacsScalar *B = &C[6];
   TacsScalar *D = &C[12];
@@ -297,7 +285,7 @@ void TACSCompositeShellConstitutive::evalTangentStiffness(int elemIndex,
     t0 = t1;
   }
 
-  C[21] = 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
+  C[21] = 0.0;
 }
 
 // Evaluate the thermal strain
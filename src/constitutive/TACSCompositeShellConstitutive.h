@@ -61,6 +61,11 @@ class TACSCompositeShellConstitutive : public TACSShellConstitutive {
   void evalTangentStiffness(int elemIndex, const double pt[],
                             const TacsScalar X[], TacsScalar C[]);
 
+  // Evaluate the tangent stiffness at a batch of points
+  void evalTangentStiffnessBatch(int npts, const int elemIndex[],
+                                 const double pt[], const TacsScalar X[],
+                                 TacsScalar C[]);
+
   // Evaluate the thermal strain
   void evalThermalStrain(int elemIndex, const double pt[], const TacsScalar X[],
                          TacsScalar theta, TacsScalar strain[]);
@@ -88,11 +93,18 @@ class TACSCompositeShellConstitutive : public TACSShellConstitutive {
   TacsScalar *ply_thickness, *ply_angles;
   TacsScalar kcorr, tOffset;
 
+  // The laminate A, B, D and As matrices. These are integrated once
+  // since the ply thicknesses and angles are fixed.
+  TacsScalar abd[NUM_TANGENT_STIFFNESS_ENTRIES];
+
   // The object name
   static const char *constName;
 
   void getLaminaStrain(TacsScalar strain[], const TacsScalar rmStrain[],
                        TacsScalar tp);
+
+  // Integrate the laminate stiffness through the thickness
+  void computeLaminateStiffness(TacsScalar C[]);
 };
 
 #endif  // TACS_COMPOSITE_SHELL_CONSTITUTIVE_H
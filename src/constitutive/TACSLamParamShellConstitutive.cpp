@@ -118,6 +118,8 @@ TACSLamParamShellConstitutive::TACSLamParamShellConstitutive(
   // The invariant coefficients for the shear coefficients
   U6 = (Q44 + Q55) / 2.0;
   U7 = (Q44 - Q55) / 2.0;
+
+  computeLaminateStiffness();
 }
 
 TACSLamParamShellConstitutive::~TACSLamParamShellConstitutive() {
@@ -183,6 +185,9 @@ int TACSLamParamShellConstitutive::setDesignVars(int elemIndex, int dvLen,
     W3 = dvs[i];
     i++;
   }
+
+  computeLaminateStiffness();
+
   return numDesignVars;
 }
 
@@ -332,11 +337,34 @@ TacsScalar TACSLamParamShellConstitutive::evalSpecificHeat(
   return 0.0;
 }
 
-// Get the stiffness values
+// Get the stiffness values from the stored stiffness matrices
 void TACSLamParamShellConstitutive::getStiffness(TacsScalar A[], TacsScalar B[],
                                                  TacsScalar D[],
                                                  TacsScalar As[],
                                                  TacsScalar *drill) {
+  for (int i = 0; i < 6; i++) {
+    A[i] = abd[i];
+    B[i] = abd[6 + i];
+    D[i] = abd[12 + i];
+  }
+  As[0] = abd[18];
+  As[1] = abd[19];
+  As[2] = abd[20];
+
+  *drill = 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
+}
+
+/*
+  Compute the stiffness matrices for the current lamination parameters
+  and ply fractions. This is called each time the design variables are
+  set, so the positive-definiteness checks are made once per design.
+*/
+void TACSLamParamShellConstitutive::computeLaminateStiffness() {
+  TacsScalar *A = &abd[0];
+  TacsScalar *B = &abd[6];
+  TacsScalar *D = &abd[12];
+  TacsScalar *As = &abd[18];
+
   // Calculate the in-plane stiffness using the lamination
   // parameters
   TacsScalar V1 = f0 - f90;
@@ -378,7 +406,7 @@ void TACSLamParamShellConstitutive::getStiffness(TacsScalar A[], TacsScalar B[],
             0.0, TacsRealPart(W3), 0.0);
   }
 
-  *drill = 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
+  abd[21] = 0.0;
 }
 
 // Evaluate the stress
@@ -134,6 +134,9 @@ class TACSLamParamShellConstitutive : public TACSShellConstitutive {
   void getStiffness(TacsScalar A[], TacsScalar B[], TacsScalar D[],
                     TacsScalar As[], TacsScalar *drill);
 
+  // Compute the stiffness matrices when the parameter values change
+  void computeLaminateStiffness();
+
   // The number of design variables
   int numDesignVars;
 
@@ -161,6 +164,9 @@ class TACSLamParamShellConstitutive : public TACSShellConstitutive {
   int nW1, nW3;       // The design variable numbers
   TacsScalar W1, W3;  // The lamination parameter values
 
+  // The A, B, D and As matrices for the current parameter values
+  TacsScalar abd[NUM_TANGENT_STIFFNESS_ENTRIES];
+
   static const char *constName;
 };
 
@@ -63,6 +63,10 @@ TACSPhaseChangeMaterialConstitutive::TACSPhaseChangeMaterialConstitutive(
              // Tm+dT]
   b = 2.0 * tan(0.99 * M_PI /
                 2.0);  // constant used to evaluate transition boundaries
+
+  table_size = 0;
+  table_lower = table_step = 0.0;
+  table = NULL;
 }
 
 TACSPhaseChangeMaterialConstitutive::~TACSPhaseChangeMaterialConstitutive() {
@@ -72,6 +76,9 @@ TACSPhaseChangeMaterialConstitutive::~TACSPhaseChangeMaterialConstitutive() {
   if (liquid_properties) {
     liquid_properties->decref();
   }
+  if (table) {
+    delete[] table;
+  }
 }
 
 int TACSPhaseChangeMaterialConstitutive::getNumStresses() { return 0; }
@@ -126,17 +133,117 @@ int TACSPhaseChangeMaterialConstitutive::getDesignVarRange(int elemIndex,
   return 0;
 }
 
+/*
+  Tabulate the transition coefficient and the latent heat factor
+
+  The functions and their derivatives are stored at npts uniformly
+  spaced temperatures in [Tm - width, Tm + width] and evaluated with
+  cubic Hermite interpolation, so that the derivatives used in the
+  Jacobian are the exact derivatives of the interpolated values. Outside
+  the table, the functions are evaluated directly. The default width
+  covers the region where either function changes appreciably. Passing
+  npts < 2 removes the table.
+*/
+void TACSPhaseChangeMaterialConstitutive::setTransitionTable(int npts,
+                                                             double width) {
+  if (table) {
+    delete[] table;
+  }
+  table = NULL;
+  table_size = 0;
+  if (npts < 2) {
+    return;
+  }
+
+  double dt = fabs(TacsRealPart(dT));
+  if (width <= 0.0) {
+    width = 6.0 * dt;
+    if (dt * sqrt(dt / M_PI) > dt) {
+      width = 6.0 * dt * sqrt(dt / M_PI);
+    }
+  }
+
+  table_size = npts;
+  table_lower = TacsRealPart(Tm) - width;
+  table_step = 2.0 * width / (npts - 1);
+  table = new TacsScalar[4 * npts];
+  for (int i = 0; i < npts; i++) {
+    TacsScalar T = table_lower + i * table_step;
+    evalTransitionExact(T, &table[4 * i], &table[4 * i + 1], &table[4 * i + 2],
+                        &table[4 * i + 3]);
+  }
+}
+
+/*
+  Get the change in temperature that changes the phase fraction by at
+  most phase_tol, based on the maximum slope of the transition
+  coefficient. This can be used as the state tolerance for lagging the
+  element matrices in the incremental Jacobian.
+*/
+TacsScalar TACSPhaseChangeMaterialConstitutive::getPhaseFractionTempTol(
+    double phase_tol) {
+  return phase_tol * M_PI * dT / b;
+}
+
+// Evaluate the transition functions directly
+void TACSPhaseChangeMaterialConstitutive::evalTransitionExact(
+    const TacsScalar T, TacsScalar *B, TacsScalar *dBdT, TacsScalar *D,
+    TacsScalar *dDdT) {
+  *B = atan(b / dT * (T - Tm)) / M_PI + 0.5;
+  *dBdT = (b / dT / (1.0 + pow(b / dT * (T - Tm), 2))) / M_PI;
+  TacsScalar f1 = -(T - Tm) * (T - Tm) / (dT * dT);
+  TacsScalar f2 = pow(dT * dT, 0.5) / M_PI;
+  *D = exp(f1 / f2);
+  *dDdT = (-2.0 / f2) * exp(f1 / f2) * (T - Tm) / (dT * dT);
+}
+
+// Evaluate the transition functions from the table, if it is set
+void TACSPhaseChangeMaterialConstitutive::evalTransition(const TacsScalar T,
+                                                         TacsScalar *B,
+                                                         TacsScalar *dBdT,
+                                                         TacsScalar *D,
+                                                         TacsScalar *dDdT) {
+  double x = (TacsRealPart(T) - table_lower) / table_step;
+  if (!table || x < 0.0 || x >= table_size - 1) {
+    evalTransitionExact(T, B, dBdT, D, dDdT);
+    return;
+  }
+
+  int i = (int)x;
+  TacsScalar s = (T - table_lower) / table_step - (double)i;
+  TacsScalar s2 = s * s, s3 = s2 * s;
+  TacsScalar h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+  TacsScalar h10 = s3 - 2.0 * s2 + s;
+  TacsScalar h01 = 3.0 * s2 - 2.0 * s3;
+  TacsScalar h11 = s3 - s2;
+  TacsScalar d00 = (6.0 * s2 - 6.0 * s) / table_step;
+  TacsScalar d10 = (3.0 * s2 - 4.0 * s + 1.0) / table_step;
+  TacsScalar d01 = (6.0 * s - 6.0 * s2) / table_step;
+  TacsScalar d11 = (3.0 * s2 - 2.0 * s) / table_step;
+
+  const TacsScalar *t0 = &table[4 * i];
+  const TacsScalar *t1 = &table[4 * (i + 1)];
+  const double h = table_step;
+  *B = h00 * t0[0] + h10 * h * t0[1] + h01 * t1[0] + h11 * h * t1[1];
+  *dBdT = d00 * t0[0] + d10 * h * t0[1] + d01 * t1[0] + d11 * h * t1[1];
+  *D = h00 * t0[2] + h10 * h * t0[3] + h01 * t1[2] + h11 * h * t1[3];
+  *dDdT = d00 * t0[2] + d10 * h * t0[3] + d01 * t1[2] + d11 * h * t1[3];
+}
+
 // Compute the phase change coefficient
 TacsScalar TACSPhaseChangeMaterialConstitutive::evalTransitionCoef(
     const TacsScalar T) {
-  TacsScalar phi = atan(b / dT * (T - Tm)) / M_PI + 0.5;
-  return phi;
+  TacsScalar B, dBdT, D, dDdT;
+  evalTransition(T, &B, &dBdT, &D, &dDdT);
+  return B;
 }
 
 // Compute the phase change coefficient
 TacsScalar TACSPhaseChangeMaterialConstitutive::evalTransitionCoefSVSens(
     const TacsScalar T) {
-  return (b / dT / (1.0 + pow(b / dT * (T - Tm), 2))) / M_PI;
+  TacsScalar B, dBdT, D, dDdT;
+  evalTransition(T, &B, &dBdT, &D, &dDdT);
+  return dBdT;
 }
 
 // Evaluate the material's phase (0=solid, 1=liquid)
@@ -191,12 +298,10 @@ TacsScalar TACSPhaseChangeMaterialConstitutive::evalSpecificHeat(
     const TacsScalar u[]) {
   if (solid_properties && liquid_properties) {
     TacsScalar T = u[0];
-    TacsScalar B = evalTransitionCoef(T);
+    TacsScalar B, dBdT, D, dDdT;
+    evalTransition(T, &B, &dBdT, &D, &dDdT);
     TacsScalar cs = solid_properties->getSpecificHeat();
     TacsScalar cl = liquid_properties->getSpecificHeat();
-    TacsScalar f1 = -(T - Tm) * (T - Tm) / (dT * dT);
-    TacsScalar f2 = pow(dT * dT, 0.5) / M_PI;
-    TacsScalar D = exp(f1 / f2);
     return cs + (cl - cs) * B + lh * D;
   }
   return 0.0;
@@ -207,12 +312,10 @@ void TACSPhaseChangeMaterialConstitutive::addSpecificHeatSVSens(
     const TacsScalar u[]) {
   if (solid_properties && liquid_properties) {
     TacsScalar T = u[0];
-    TacsScalar dBdT = evalTransitionCoefSVSens(T);
+    TacsScalar B, dBdT, D, dDdT;
+    evalTransition(T, &B, &dBdT, &D, &dDdT);
     TacsScalar cs = solid_properties->getSpecificHeat();
     TacsScalar cl = liquid_properties->getSpecificHeat();
-    TacsScalar f1 = -(T - Tm) * (T - Tm) / (dT * dT);
-    TacsScalar f2 = pow(dT * dT, 0.5) / M_PI;
-    TacsScalar dDdT = (-2.0 / f2) * exp(f1 / f2) * (T - Tm) / (dT * dT);
     dfdu[0] += (cl - cs) * dBdT + lh * dDdT;
   }
 }
@@ -51,6 +51,12 @@ class TACSPhaseChangeMaterialConstitutive : public TACSConstitutive {
   int getDesignVarRange(int elemIndex, int dvLen, TacsScalar lb[],
                         TacsScalar ub[]);
 
+  // Tabulate the transition functions near the melting temperature
+  void setTransitionTable(int npts, double width = -1.0);
+
+  // Get the temperature change that bounds a change in phase fraction
+  TacsScalar getPhaseFractionTempTol(double phase_tol);
+
   // Compute the phase change coefficient
   TacsScalar evalTransitionCoef(const TacsScalar T);
 
@@ -130,6 +136,18 @@ class TACSPhaseChangeMaterialConstitutive : public TACSConstitutive {
   TacsScalar lh, Tm, t, tlb, tub, dT, b;
   int tNum;
 
+  // Evaluate the transition coefficient B, the latent heat factor D and
+  // their derivatives, either exactly or from the table
+  void evalTransition(const TacsScalar T, TacsScalar *B, TacsScalar *dBdT,
+                      TacsScalar *D, TacsScalar *dDdT);
+  void evalTransitionExact(const TacsScalar T, TacsScalar *B,
+                           TacsScalar *dBdT, TacsScalar *D, TacsScalar *dDdT);
+
+  // The table of B, dB/dT, D and dD/dT at uniformly spaced temperatures
+  int table_size;
+  double table_lower, table_step;
+  TacsScalar *table;
+
   static const char *psName;
 };
 
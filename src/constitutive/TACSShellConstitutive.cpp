@@ -53,6 +53,20 @@ void TACSShellConstitutive::extractTangentStiffness(
   }
 }
 
+/*
+  Evaluate the tangent stiffness at each point in the batch
+*/
+void TACSShellConstitutive::evalTangentStiffnessBatch(int npts,
+                                                      const int elemIndex[],
+                                                      const double pt[],
+                                                      const TacsScalar X[],
+                                                      TacsScalar C[]) {
+  for (int i = 0; i < npts; i++) {
+    evalTangentStiffness(elemIndex[i], &pt[3 * i], &X[3 * i],
+                         &C[NUM_TANGENT_STIFFNESS_ENTRIES * i]);
+  }
+}
+
 /*
   Set the default drilling regularization value
 */
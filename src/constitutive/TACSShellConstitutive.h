@@ -75,6 +75,25 @@ class TACSShellConstitutive : public TACSConstitutive {
                                     const TacsScalar scale[], int dvLen,
                                     TacsScalar dfdx[]) {}
 
+  /**
+    Evaluate the tangent stiffness at a batch of points
+
+    The points may belong to different elements that share this
+    constitutive object. The parametric point, physical location and
+    tangent stiffness for the i-th point begin at pt[3*i], X[3*i] and
+    C[NUM_TANGENT_STIFFNESS_ENTRIES*i], respectively. The default
+    implementation calls evalTangentStiffness() for each point.
+
+    @param npts The number of points in the batch
+    @param elemIndex The local element index for each point
+    @param pt The parametric points
+    @param X The point locations
+    @param C The components of the tangent stiffness at each point
+  */
+  virtual void evalTangentStiffnessBatch(int npts, const int elemIndex[],
+                                         const double pt[],
+                                         const TacsScalar X[], TacsScalar C[]);
+
   // Set the drilling regularization value
   static void setDrillingRegularization(double kval);
 
@@ -86,10 +105,10 @@ class TACSShellConstitutive : public TACSConstitutive {
 
   // Once the stiffness matrices have been evaluated, use this
   // function to compute the stress given the strain components
-  static inline void computeStress(const TacsScalar A[], const TacsScalar B[],
-                                   const TacsScalar D[], const TacsScalar As[],
-                                   const TacsScalar drill, const TacsScalar e[],
-                                   TacsScalar s[]);
+  TACS_HOST_DEVICE static inline void computeStress(
+      const TacsScalar A[], const TacsScalar B[], const TacsScalar D[],
+      const TacsScalar As[], const TacsScalar drill, const TacsScalar e[],
+      TacsScalar s[]);
 
   // The name of the constitutive object
   const char *getObjectName();
@@ -122,7 +141,7 @@ class TACSShellConstitutive : public TACSConstitutive {
   [As] = [ As[0] As[1] ]
   .      [ As[1] As[2] ]
 */
-inline void TACSShellConstitutive::computeStress(
+TACS_HOST_DEVICE inline void TACSShellConstitutive::computeStress(
     const TacsScalar A[], const TacsScalar B[], const TacsScalar D[],
     const TacsScalar As[], const TacsScalar drill, const TacsScalar e[],
     TacsScalar s[]) {
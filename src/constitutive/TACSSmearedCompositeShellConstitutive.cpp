@@ -85,6 +85,15 @@ TACSSmearedCompositeShellConstitutive::TACSSmearedCompositeShellConstitutive(
   for (int i = 0; i < nfvals; i++) {
     dfvals[i] = new TacsScalar[NUM_STRESSES];
   }
+
+  ply_qbar = new TacsScalar[6 * num_plies];
+  ply_abar = new TacsScalar[3 * num_plies];
+  for (int k = 0; k < num_plies; k++) {
+    ply_props[k]->calculateQbar(ply_angles[k], &ply_qbar[6 * k]);
+    ply_props[k]->calculateAbar(ply_angles[k], &ply_abar[3 * k]);
+  }
+
+  computeLaminateStiffness();
 }
 
 TACSSmearedCompositeShellConstitutive::
@@ -104,6 +113,8 @@ TACSSmearedCompositeShellConstitutive::
     delete[] dfvals[i];
   }
   delete[] dfvals;
+  delete[] ply_qbar;
+  delete[] ply_abar;
 }
 
 int TACSSmearedCompositeShellConstitutive::getDesignVarNums(int elemIndex,
@@ -140,6 +151,9 @@ int TACSSmearedCompositeShellConstitutive::setDesignVars(
       index++;
     }
   }
+
+  computeLaminateStiffness();
+
   return index;
 }
 
@@ -285,11 +299,29 @@ TacsScalar TACSSmearedCompositeShellConstitutive::evalSpecificHeat(
   return 0.0;
 }
 
-// Evaluate the FSDT stiffness matrices
+// Evaluate the FSDT stiffness matrices from the stored laminate stiffness
 TacsScalar TACSSmearedCompositeShellConstitutive::evalFSDTStiffness(
     int elemIndex, const double pt[], const TacsScalar X[], TacsScalar A[],
     TacsScalar B[], TacsScalar D[], TacsScalar As[]) {
-  TacsScalar drill;
+  for (int i = 0; i < 6; i++) {
+    A[i] = abd[i];
+    B[i] = abd[6 + i];
+    D[i] = abd[12 + i];
+  }
+
+  for (int i = 0; i < 3; i++) {
+    As[i] = abd[18 + i];
+  }
+
+  return 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
+}
+
+// Integrate the laminate stiffness for the current design variables
+void TACSSmearedCompositeShellConstitutive::computeLaminateStiffness() {
+  TacsScalar *A = &abd[0];
+  TacsScalar *B = &abd[6];
+  TacsScalar *D = &abd[12];
+  TacsScalar *As = &abd[18];
 
   // Zero the stiffness matrices
   for (int k = 0; k < 6; k++) {
@@ -302,9 +334,8 @@ TacsScalar TACSSmearedCompositeShellConstitutive::evalFSDTStiffness(
 
   // Compute the contribution to the stiffness from each layer
   for (int k = 0; k < num_plies; k++) {
-    TacsScalar Qbar[6], Abar[3];
-    ply_props[k]->calculateQbar(ply_angles[k], Qbar);
-    ply_props[k]->calculateAbar(ply_angles[k], Abar);
+    const TacsScalar *Qbar = &ply_qbar[6 * k];
+    const TacsScalar *Abar = &ply_abar[3 * k];
 
     TacsScalar a = ply_fractions[k] * thickness;
     TacsScalar b = t_offset * ply_fractions[k] * thickness * thickness;
@@ -322,9 +353,7 @@ TacsScalar TACSSmearedCompositeShellConstitutive::evalFSDTStiffness(
     }
   }
 
-  drill = 0.5 * DRILLING_REGULARIZATION * (As[0] + As[2]);
-
-  return drill;
+  abd[21] = 0.0;
 }
 
 // Evaluate the stress
@@ -351,9 +380,8 @@ void TACSSmearedCompositeShellConstitutive::addStressDVSens(
   int index = 0;
   if (thickness_dv_num >= 0) {
     for (int k = 0; k < num_plies; k++) {
-      TacsScalar Qbar[6], Abar[3];
-      ply_props[k]->calculateQbar(ply_angles[k], Qbar);
-      ply_props[k]->calculateAbar(ply_angles[k], Abar);
+      const TacsScalar *Qbar = &ply_qbar[6 * k];
+      const TacsScalar *Abar = &ply_abar[3 * k];
 
       TacsScalar da = ply_fractions[k];
       TacsScalar db = 2.0 * t_offset * ply_fractions[k] * thickness;
@@ -384,9 +412,8 @@ void TACSSmearedCompositeShellConstitutive::addStressDVSens(
 
   for (int k = 0; k < num_plies; k++) {
     if (ply_fraction_dv_nums[k] >= 0) {
-      TacsScalar Qbar[6], Abar[3];
-      ply_props[k]->calculateQbar(ply_angles[k], Qbar);
-      ply_props[k]->calculateAbar(ply_angles[k], Abar);
+      const TacsScalar *Qbar = &ply_qbar[6 * k];
+      const TacsScalar *Abar = &ply_abar[3 * k];
 
       TacsScalar da = thickness;
       TacsScalar db = t_offset * thickness * thickness;
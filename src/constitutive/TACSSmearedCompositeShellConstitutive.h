@@ -136,12 +136,21 @@ class TACSSmearedCompositeShellConstitutive : public TACSShellConstitutive {
   TacsScalar **dfvals;
   TacsScalar t_offset;
 
+  // The Qbar and Abar matrices for each ply. These are fixed since the
+  // ply angles are fixed.
+  TacsScalar *ply_qbar, *ply_abar;
+
+  // The laminate A, B, D and As matrices for the current design
+  // variables, recomputed each time the design variables are set
+  TacsScalar abd[NUM_TANGENT_STIFFNESS_ENTRIES];
+
   // The object name
   static const char *constName;
 
   TacsScalar evalFSDTStiffness(int elemIndex, const double pt[],
                                const TacsScalar X[], TacsScalar A[],
                                TacsScalar B[], TacsScalar D[], TacsScalar As[]);
+  void computeLaminateStiffness();
   void getLaminaStrain(const TacsScalar rmStrain[], TacsScalar tp,
                        TacsScalar strain[]);
   void evalPlyTopBottomFailure(const TacsScalar strain[], TacsScalar fvals[]);
@@ -0,0 +1,500 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSContactSearch.h"
+
+#include <math.h>
+
+/*
+  Compute the closest point on the triangle (a, b, c) to the point p
+  and return the squared distance
+*/
+static double TacsClosestPointTriangle(const double p[], const double a[],
+                                       const double b[], const double c[]) {
+  double ab[3], ac[3], ap[3], q[3];
+  for (int k = 0; k < 3; k++) {
+    ab[k] = b[k] - a[k];
+    ac[k] = c[k] - a[k];
+    ap[k] = p[k] - a[k];
+  }
+
+  double d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+  double d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+
+  // Check the vertex regions, then the edge regions and finally the
+  // interior of the triangle
+  double v = 0.0, w = 0.0;
+  if (d1 <= 0.0 && d2 <= 0.0) {
+    v = w = 0.0;
+  } else {
+    double bp[3], cp[3];
+    for (int k = 0; k < 3; k++) {
+      bp[k] = p[k] - b[k];
+      cp[k] = p[k] - c[k];
+    }
+    double d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+    double d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+    double d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+    double d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+    double va = d3 * d6 - d5 * d4;
+    double vb = d5 * d2 - d1 * d6;
+    double vc = d1 * d4 - d3 * d2;
+
+    if (d3 >= 0.0 && d4 <= d3) {
+      v = 1.0;
+      w = 0.0;
+    } else if (d6 >= 0.0 && d5 <= d6) {
+      v = 0.0;
+      w = 1.0;
+    } else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+      v = d1 / (d1 - d3);
+      w = 0.0;
+    } else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+      v = 0.0;
+      w = d2 / (d2 - d6);
+    } else if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+      w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+      v = 1.0 - w;
+    } else {
+      double denom = 1.0 / (va + vb + vc);
+      v = vb * denom;
+      w = vc * denom;
+    }
+  }
+
+  double dist = 0.0;
+  for (int k = 0; k < 3; k++) {
+    q[k] = a[k] + v * ab[k] + w * ac[k] - p[k];
+    dist += q[k] * q[k];
+  }
+  return dist;
+}
+
+/*
+  Create the contact search object
+
+  @param num_facets The number of surface facets
+  @param facet_size The number of nodes per facet (3 or 4)
+  @param facet_nodes The node numbers for each facet
+  @param cell_size The spatial hash cell size (<= 0 for automatic)
+  @param margin The bounding box margin (<= 0 for automatic)
+*/
+TACSContactSearch::TACSContactSearch(int _num_facets, int _facet_size,
+                                     const int *_facet_nodes,
+                                     double _cell_size, double _margin) {
+  num_facets = _num_facets;
+  facet_size = _facet_size;
+  if (facet_size != 3 && facet_size != 4) {
+    fprintf(stderr,
+            "TACSContactSearch: Facet size %d not supported, "
+            "must be 3 or 4\n",
+            facet_size);
+    facet_size = 3;
+    num_facets = 0;
+  }
+  cell_size = _cell_size;
+  margin = _margin;
+
+  facet_nodes = new int[facet_size * num_facets];
+  memcpy(facet_nodes, _facet_nodes, facet_size * num_facets * sizeof(int));
+
+  Xf = new double[3 * facet_size * num_facets];
+  box = new double[6 * num_facets];
+  fat_box = new double[6 * num_facets];
+  marker = new int[num_facets];
+  memset(marker, 0, num_facets * sizeof(int));
+  search_count = 0;
+
+  table_size = 0;
+  table_ptr = NULL;
+  table = NULL;
+  h = 1.0;
+  num_rebuilds = 0;
+}
+
+TACSContactSearch::~TACSContactSearch() {
+  delete[] facet_nodes;
+  delete[] Xf;
+  delete[] box;
+  delete[] fat_box;
+  delete[] marker;
+  if (table_ptr) {
+    delete[] table_ptr;
+  }
+  if (table) {
+    delete[] table;
+  }
+}
+
+/*
+  Update the facet node locations
+
+  The bounding box of each facet is recomputed. The spatial hash is
+  only rebuilt when one of the facets has moved outside of the inflated
+  box that was used to bin it.
+
+  @param X The node locations indexed by the facet node numbers
+  @return 1 if the hash was rebuilt, 0 otherwise
+*/
+int TACSContactSearch::update(const TacsScalar X[]) {
+  int fail = (table == NULL);
+
+  for (int f = 0; f < num_facets; f++) {
+    double *xf = &Xf[3 * facet_size * f];
+    double *lo = &box[6 * f], *hi = &box[6 * f + 3];
+    for (int k = 0; k < 3; k++) {
+      lo[k] = 1e300;
+      hi[k] = -1e300;
+    }
+
+    for (int i = 0; i < facet_size; i++) {
+      const TacsScalar *x = &X[3 * facet_nodes[facet_size * f + i]];
+      for (int k = 0; k < 3; k++) {
+        xf[3 * i + k] = TacsRealPart(x[k]);
+        if (xf[3 * i + k] < lo[k]) {
+          lo[k] = xf[3 * i + k];
+        }
+        if (xf[3 * i + k] > hi[k]) {
+          hi[k] = xf[3 * i + k];
+        }
+      }
+    }
+
+    if (!fail) {
+      const double *flo = &fat_box[6 * f], *fhi = &fat_box[6 * f + 3];
+      for (int k = 0; k < 3; k++) {
+        if (lo[k] < flo[k] || hi[k] > fhi[k]) {
+          fail = 1;
+        }
+      }
+    }
+  }
+
+  if (fail) {
+    rebuild();
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+  Get the range of hash cells that overlap with the given box
+*/
+void TACSContactSearch::getCellRange(const double lo[], const double hi[],
+                                     int clo[], int chi[]) {
+  for (int k = 0; k < 3; k++) {
+    clo[k] = (int)floor(lo[k] / h);
+    chi[k] = (int)floor(hi[k] / h);
+  }
+}
+
+/*
+  Inflate the facet bounding boxes and bin the facets into the hash
+*/
+void TACSContactSearch::rebuild() {
+  num_rebuilds++;
+
+  // Compute the mean facet size
+  double size = 0.0;
+  for (int f = 0; f < num_facets; f++) {
+    double dmax = 0.0;
+    for (int k = 0; k < 3; k++) {
+      double d = box[6 * f + 3 + k] - box[6 * f + k];
+      if (d > dmax) {
+        dmax = d;
+      }
+    }
+    size += dmax;
+  }
+  if (num_facets > 0) {
+    size /= num_facets;
+  }
+  if (size <= 0.0) {
+    size = 1.0;
+  }
+
+  // Set the margin and cell size relative to the mean facet size
+  double m = margin;
+  if (m <= 0.0) {
+    m = 0.1 * size;
+  }
+  h = cell_size;
+  if (h <= 0.0) {
+    h = size + 2.0 * m;
+  }
+
+  for (int f = 0; f < num_facets; f++) {
+    for (int k = 0; k < 3; k++) {
+      fat_box[6 * f + k] = box[6 * f + k] - m;
+      fat_box[6 * f + 3 + k] = box[6 * f + 3 + k] + m;
+    }
+  }
+
+  // Count the number of cells covered by the facets and size the
+  // table as a power of two at least twice as large
+  int num_entries = 0;
+  for (int f = 0; f < num_facets; f++) {
+    int clo[3], chi[3];
+    getCellRange(&fat_box[6 * f], &fat_box[6 * f + 3], clo, chi);
+    num_entries += (chi[0] - clo[0] + 1) * (chi[1] - clo[1] + 1) *
+                   (chi[2] - clo[2] + 1);
+  }
+
+  int size_needed = 1;
+  while (size_needed < 2 * num_entries) {
+    size_needed *= 2;
+  }
+  if (size_needed != table_size) {
+    if (table_ptr) {
+      delete[] table_ptr;
+    }
+    table_size = size_needed;
+    table_ptr = new int[table_size + 1];
+  }
+  if (table) {
+    delete[] table;
+  }
+  table = new int[num_entries > 0 ? num_entries : 1];
+
+  // Count the entries in each bucket, then fill the buckets
+  memset(table_ptr, 0, (table_size + 1) * sizeof(int));
+  for (int pass = 0; pass < 2; pass++) {
+    for (int f = 0; f < num_facets; f++) {
+      int clo[3], chi[3];
+      getCellRange(&fat_box[6 * f], &fat_box[6 * f + 3], clo, chi);
+      for (int i = clo[0]; i <= chi[0]; i++) {
+        for (int j = clo[1]; j <= chi[1]; j++) {
+          for (int k = clo[2]; k <= chi[2]; k++) {
+            int b = hashCell(i, j, k);
+            if (pass == 0) {
+              table_ptr[b + 1]++;
+            } else {
+              table[table_ptr[b]] = f;
+              table_ptr[b]++;
+            }
+          }
+        }
+      }
+    }
+
+    if (pass == 0) {
+      for (int b = 0; b < table_size; b++) {
+        table_ptr[b + 1] += table_ptr[b];
+      }
+    } else {
+      // Reset the pointer array after it was incremented in the fill
+      for (int b = table_size; b > 0; b--) {
+        table_ptr[b] = table_ptr[b - 1];
+      }
+      table_ptr[0] = 0;
+    }
+  }
+}
+
+/*
+  Compute the distance from the point to the facet
+*/
+double TACSContactSearch::computeDistance(int f, const double pt[]) {
+  const double *xf = &Xf[3 * facet_size * f];
+  double d = 0.0;
+  if (facet_size == 3) {
+    d = TacsClosestPointTriangle(pt, &xf[0], &xf[3], &xf[6]);
+  } else {
+    // Split the quadrilateral with tensor-product node ordering
+    // into the triangles (0, 1, 3) and (0, 3, 2)
+    d = TacsClosestPointTriangle(pt, &xf[0], &xf[3], &xf[9]);
+    double d2 = TacsClosestPointTriangle(pt, &xf[0], &xf[9], &xf[6]);
+    if (d2 < d) {
+      d = d2;
+    }
+  }
+  return sqrt(d);
+}
+
+/*
+  Find the facets whose bounding box is within the radius of a point
+
+  @param pt The point location
+  @param radius The search radius
+  @param max_facets The maximum length of the facets array
+  @param facets The facets within the radius
+  @return The number of facets found (may exceed max_facets)
+*/
+int TACSContactSearch::findFacets(const TacsScalar pt[], double radius,
+                                  int max_facets, int facets[]) {
+  if (!table) {
+    return 0;
+  }
+
+  double p[3], lo[3], hi[3];
+  for (int k = 0; k < 3; k++) {
+    p[k] = TacsRealPart(pt[k]);
+    lo[k] = p[k] - radius;
+    hi[k] = p[k] + radius;
+  }
+
+  // Use a new marker value so that duplicate entries from the
+  // neighbouring cells are skipped
+  search_count++;
+  if (search_count == 0) {
+    memset(marker, 0, num_facets * sizeof(int));
+    search_count = 1;
+  }
+
+  int clo[3], chi[3];
+  getCellRange(lo, hi, clo, chi);
+
+  int count = 0;
+  for (int i = clo[0]; i <= chi[0]; i++) {
+    for (int j = clo[1]; j <= chi[1]; j++) {
+      for (int k = clo[2]; k <= chi[2]; k++) {
+        int b = hashCell(i, j, k);
+        for (int ip = table_ptr[b]; ip < table_ptr[b + 1]; ip++) {
+          int f = table[ip];
+          if (marker[f] == search_count) {
+            continue;
+          }
+          marker[f] = search_count;
+
+          // Check the distance to the bounding box
+          const double *flo = &box[6 * f], *fhi = &box[6 * f + 3];
+          double d2 = 0.0;
+          for (int kk = 0; kk < 3; kk++) {
+            double d = 0.0;
+            if (p[kk] < flo[kk]) {
+              d = flo[kk] - p[kk];
+            } else if (p[kk] > fhi[kk]) {
+              d = p[kk] - fhi[kk];
+            }
+            d2 += d * d;
+          }
+          if (d2 <= radius * radius) {
+            if (count < max_facets) {
+              facets[count] = f;
+            }
+            count++;
+          }
+        }
+      }
+    }
+  }
+
+  return count;
+}
+
+/*
+  Find the closest facet to a point within the search radius
+
+  @param pt The point location
+  @param radius The search radius
+  @param dist The distance to the closest facet
+  @param skip_node Skip facets that contain this node
+  @return The closest facet, or -1 if no facet is within the radius
+*/
+int TACSContactSearch::findClosestFacet(const TacsScalar pt[], double radius,
+                                        double *dist, int skip_node) {
+  if (!table) {
+    return -1;
+  }
+
+  double p[3];
+  for (int k = 0; k < 3; k++) {
+    p[k] = TacsRealPart(pt[k]);
+  }
+
+  double lo[3], hi[3];
+  for (int k = 0; k < 3; k++) {
+    lo[k] = p[k] - radius;
+    hi[k] = p[k] + radius;
+  }
+
+  search_count++;
+  if (search_count == 0) {
+    memset(marker, 0, num_facets * sizeof(int));
+    search_count = 1;
+  }
+
+  int clo[3], chi[3];
+  getCellRange(lo, hi, clo, chi);
+
+  int closest = -1;
+  double dmin = radius;
+  for (int i = clo[0]; i <= chi[0]; i++) {
+    for (int j = clo[1]; j <= chi[1]; j++) {
+      for (int k = clo[2]; k <= chi[2]; k++) {
+        int b = hashCell(i, j, k);
+        for (int ip = table_ptr[b]; ip < table_ptr[b + 1]; ip++) {
+          int f = table[ip];
+          if (marker[f] == search_count) {
+            continue;
+          }
+          marker[f] = search_count;
+
+          int skip = 0;
+          for (int ii = 0; ii < facet_size; ii++) {
+            if (facet_nodes[facet_size * f + ii] == skip_node) {
+              skip = 1;
+            }
+          }
+          if (skip) {
+            continue;
+          }
+
+          double d = computeDistance(f, p);
+          if (d <= dmin) {
+            dmin = d;
+            closest = f;
+          }
+        }
+      }
+    }
+  }
+
+  if (dist) {
+    *dist = dmin;
+  }
+  return closest;
+}
+
+/*
+  Find the closest facet to each of the given nodes
+
+  The search is updated with the node locations first. The facets
+  that contain the node itself are ignored. The result can be used to
+  create a node-to-surface contact element for each pair with the node
+  followed by the facet nodes.
+
+  @param num_nodes The number of nodes
+  @param nodes The node numbers
+  @param X The node locations
+  @param radius The search radius
+  @param facets The closest facet to each node, or -1 if none is found
+  @return The number of nodes with a facet within the radius
+*/
+int TACSContactSearch::findNodeToSurfacePairs(int num_nodes, const int nodes[],
+                                              const TacsScalar X[],
+                                              double radius, int facets[]) {
+  update(X);
+
+  int count = 0;
+  for (int i = 0; i < num_nodes; i++) {
+    facets[i] = findClosestFacet(&X[3 * nodes[i]], radius, NULL, nodes[i]);
+    if (facets[i] >= 0) {
+      count++;
+    }
+  }
+
+  return count;
+}
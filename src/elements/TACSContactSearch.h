@@ -0,0 +1,111 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_CONTACT_SEARCH_H
+#define TACS_CONTACT_SEARCH_H
+
+#include "TACSObject.h"
+
+/*
+  Spatial search for contact candidates on a faceted surface.
+
+  The surface is defined by triangular (3-node) or quadrilateral
+  (4-node) facets that index into an array of node locations. The
+  quadrilateral nodes use the same tensor-product ordering as the
+  shell and solid element faces, so the connectivity of the shell
+  elements can be used directly as the facets.
+
+  The facets are stored in a uniform spatial hash. Each facet is
+  binned using its bounding box inflated by a margin. When the node
+  locations are updated, the hash is only rebuilt if a facet has
+  moved outside of its inflated box, so that updating the search
+  between Newton iterations costs a single pass over the facets for
+  small increments of the displacements.
+
+  The search is local to the processor. The candidate pairs are used
+  to define the connectivity of the contact elements, after which the
+  assembler distributes the candidate surface nodes between processors
+  in the same way as any other element nodes.
+*/
+class TACSContactSearch : public TACSObject {
+ public:
+  TACSContactSearch(int _num_facets, int _facet_size, const int *_facet_nodes,
+                    double _cell_size = 0.0, double _margin = 0.0);
+  ~TACSContactSearch();
+
+  // Update the node locations and rebuild the hash if required
+  // ----------------------------------------------------------
+  int update(const TacsScalar X[]);
+  int getNumRebuilds() { return num_rebuilds; }
+
+  // Search for the facets near a point
+  // ----------------------------------
+  int findFacets(const TacsScalar pt[], double radius, int max_facets,
+                 int facets[]);
+  int findClosestFacet(const TacsScalar pt[], double radius, double *dist,
+                       int skip_node = -1);
+
+  // Find the closest facet to each of a set of nodes
+  // ------------------------------------------------
+  int findNodeToSurfacePairs(int num_nodes, const int nodes[],
+                             const TacsScalar X[], double radius,
+                             int facets[]);
+
+  // Get the facet information
+  // -------------------------
+  int getNumFacets() { return num_facets; }
+  int getFacetSize() { return facet_size; }
+  const int *getFacetNodes() { return facet_nodes; }
+
+  const char *getObjectName() { return "TACSContactSearch"; }
+
+ private:
+  void rebuild();
+  void getCellRange(const double lo[], const double hi[], int clo[],
+                    int chi[]);
+  int hashCell(int i, int j, int k) {
+    unsigned int h = (73856093u * (unsigned int)i) ^
+                     (19349663u * (unsigned int)j) ^
+                     (83492791u * (unsigned int)k);
+    return (int)(h & (unsigned int)(table_size - 1));
+  }
+  double computeDistance(int facet, const double pt[]);
+
+  // The facet definitions
+  int num_facets, facet_size;
+  int *facet_nodes;
+
+  // The user-specified cell size and margin (<= 0 for automatic)
+  double cell_size, margin;
+
+  // The current node locations for the facets
+  double *Xf;
+
+  // The current and inflated bounding boxes for each facet
+  double *box, *fat_box;
+
+  // The hash table in compressed form: bucket b contains the
+  // facets table[table_ptr[b]:table_ptr[b+1]]
+  int table_size;
+  int *table_ptr, *table;
+  double h;
+
+  // Marker used to avoid duplicate facets in a search
+  int *marker, search_count;
+
+  // The number of times that the hash has been rebuilt
+  int num_rebuilds;
+};
+
+#endif  // TACS_CONTACT_SEARCH_H
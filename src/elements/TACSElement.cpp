@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 
+#include "TACSScratchArena.h"
 #include "tacslapack.h"
 
 /*
@@ -32,11 +33,23 @@ int TACSElement::fdOrder = 2;
 */
 void TACSElement::setFiniteDifferenceOrder(int order) { fdOrder = order; }
 
+/*
+  The maximum number of Jacobian columns that are perturbed in each
+  call to addResidualBatch() in the default addJacobian()
+*/
+static const int TACS_ELEMENT_JACOBIAN_BATCH_COLS = 16;
+
 /*
   Finds the finite-difference based Jacobian of the element. This is
   the default Jacobian implementation for any TACSElement. The user
   can override this function and provide an analytic Jacobian
   implemention in descendant classes.
+
+  In the complex build the columns are computed with the complex step,
+  otherwise central differences are used. The perturbed states for a
+  group of columns are evaluated together with a single call to
+  addResidualBatch(), so elements that vectorize the residual across a
+  batch also compute this Jacobian at the vectorized rate.
 */
 void TACSElement::addJacobian(int elemIndex, double time, TacsScalar alpha,
                               TacsScalar beta, TacsScalar gamma,
@@ -44,163 +57,186 @@ void TACSElement::addJacobian(int elemIndex, double time, TacsScalar alpha,
                               const TacsScalar dvars[],
                               const TacsScalar ddvars[], TacsScalar res[],
                               TacsScalar J[]) {
-  // The step length
+  // The step length and the number of residuals for each column
 #ifdef TACS_USE_COMPLEX
   const double dh = 1e-30;
+  const int nsteps = 1;
 #else
   const double dh = 1e-7;
+  const int nsteps = 2;
 #endif  // TACS_USE_COMPLEX
 
   // Get the number of variables
-  int nvars = getNumVariables();
+  const int nvars = getNumVariables();
+  const int nx = 3 * getNumNodes();
 
   // Call the residual implementation
   if (res) {
     addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, res);
   }
 
-  // Original and perturbed residual vectors
-  TacsScalar *Rtmp1 = new TacsScalar[nvars];
-  TacsScalar *Rtmp2 = new TacsScalar[nvars];
-
-  // Perturbed state vectors
-  TacsScalar *qTmp = new TacsScalar[nvars];
-  TacsScalar *qdotTmp = new TacsScalar[nvars];
-  TacsScalar *qddotTmp = new TacsScalar[nvars];
-
-  // Copy the state variables into pstate
-  memcpy(qTmp, vars, nvars * sizeof(TacsScalar));
-  memcpy(qdotTmp, dvars, nvars * sizeof(TacsScalar));
-  memcpy(qddotTmp, ddvars, nvars * sizeof(TacsScalar));
-
-  // Perturb each state variable and find the residual
-  if (TacsRealPart(alpha) != 0.0) {
-    for (int i = 0; i < nvars; i++) {
-#ifdef TACS_USE_COMPLEX
-      qTmp[i] = vars[i] + TacsScalar(0.0, dh);
+  // The coefficients and states for each time derivative
+  const TacsScalar coef[3] = {alpha, beta, gamma};
+
+  // Allocate the data for the batch of perturbed residuals
+  const int max_batch = nsteps * TACS_ELEMENT_JACOBIAN_BATCH_COLS;
+  TACSScratchScope scratch;
+  int *index = scratch.allocInts(max_batch);
+  TacsScalar *Xbatch = scratch.allocScalars(nx * max_batch);
+  TacsScalar *qbatch = scratch.allocScalars(3 * nvars * max_batch);
+  TacsScalar *Rbatch = scratch.allocScalars(nvars * max_batch);
+  TacsScalar *q[3];
+  q[0] = &qbatch[0];
+  q[1] = &qbatch[nvars * max_batch];
+  q[2] = &qbatch[2 * nvars * max_batch];
+
+  for (int b = 0; b < max_batch; b++) {
+    index[b] = elemIndex;
+    memcpy(&Xbatch[nx * b], Xpts, nx * sizeof(TacsScalar));
+  }
 
-      // Assemble the unperturbed residual
-      memset(Rtmp1, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp1);
+  for (int s = 0; s < 3; s++) {
+    if (TacsRealPart(coef[s]) == 0.0) {
+      continue;
+    }
 
-      // Find the approximated jacobian
-      for (int j = 0; j < nvars; j++) {
-        J[j * nvars + i] += alpha * TacsImagPart(Rtmp1[j]) / dh;
+    for (int i0 = 0; i0 < nvars; i0 += TACS_ELEMENT_JACOBIAN_BATCH_COLS) {
+      int ncols = nvars - i0;
+      if (ncols > TACS_ELEMENT_JACOBIAN_BATCH_COLS) {
+        ncols = TACS_ELEMENT_JACOBIAN_BATCH_COLS;
       }
-#else
-      // Perturb the i-th variable
-      qTmp[i] = vars[i] + dh;
-
-      // Assemble the unperturbed residual
-      memset(Rtmp1, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp1);
+      int nbatch = nsteps * ncols;
 
-      // Perturb the i-th variable
-      qTmp[i] = vars[i] - dh;
+      // Set the states and perturb the column for each batch entry
+      for (int b = 0; b < nbatch; b++) {
+        memcpy(&q[0][nvars * b], vars, nvars * sizeof(TacsScalar));
+        memcpy(&q[1][nvars * b], dvars, nvars * sizeof(TacsScalar));
+        memcpy(&q[2][nvars * b], ddvars, nvars * sizeof(TacsScalar));
 
-      // Assemble the unperturbed residual
-      memset(Rtmp2, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp2);
-
-      // Find the approximated jacobian
-      for (int j = 0; j < nvars; j++) {
-        J[j * nvars + i] += 0.5 * alpha * (Rtmp1[j] - Rtmp2[j]) / dh;
-      }
-#endif  // TACS_USE_COMPLEX
-      // Restore the i-th variable
-      qTmp[i] = vars[i];
-    }
-  }
-
-  if (TacsRealPart(beta) != 0.0) {
-    // Perturb each state variable and find the residual
-    for (int i = 0; i < nvars; i++) {
+        int i = i0 + b / nsteps;
 #ifdef TACS_USE_COMPLEX
-      qdotTmp[i] = dvars[i] + TacsScalar(0.0, dh);
-
-      // Assemble the unperturbed residual
-      memset(Rtmp1, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp1);
-
-      // Find the approximated jacobian
-      for (int j = 0; j < nvars; j++) {
-        J[j * nvars + i] += beta * TacsImagPart(Rtmp1[j]) / dh;
-      }
+        q[s][nvars * b + i] += TacsScalar(0.0, dh);
 #else
-      // Perturb the i-th variable
-      qdotTmp[i] = dvars[i] + dh;
-
-      // Assemble the unperturbed residual
-      memset(Rtmp1, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp1);
-
-      // Perturb the i-th variable
-      qdotTmp[i] = dvars[i] - dh;
-
-      // Assemble the unperturbed residual
-      memset(Rtmp2, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp2);
-
-      // Find the approximated jacobian
-      for (int j = 0; j < nvars; j++) {
-        J[j * nvars + i] += 0.5 * beta * (Rtmp1[j] - Rtmp2[j]) / dh;
-      }
+        q[s][nvars * b + i] += (b % 2 == 0 ? dh : -dh);
 #endif  // TACS_USE_COMPLEX
-      // Restore the i-th variable
-      qdotTmp[i] = dvars[i];
-    }
-  }
-
-  if (TacsRealPart(gamma) != 0.0) {
-    // Perturb each state variable and find the residual
-    for (int i = 0; i < nvars; i++) {
-#ifdef TACS_USE_COMPLEX
-      qddotTmp[i] = ddvars[i] + TacsScalar(0.0, dh);
-
-      // Assemble the unperturbed residual
-      memset(Rtmp1, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp1);
-
-      // Find the approximated jacobian
-      for (int j = 0; j < nvars; j++) {
-        J[j * nvars + i] += gamma * TacsImagPart(Rtmp1[j]) / dh;
       }
-#else
-      // Perturb the i-th variable
-      qddotTmp[i] = ddvars[i] + dh;
 
-      // Assemble the unperturbed residual
-      memset(Rtmp1, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp1);
-
-      // Perturb the i-th variable
-      qddotTmp[i] = ddvars[i] - dh;
-
-      // Assemble the unperturbed residual
-      memset(Rtmp2, 0, nvars * sizeof(TacsScalar));
-      addResidual(elemIndex, time, Xpts, qTmp, qdotTmp, qddotTmp, Rtmp2);
+      // Evaluate the perturbed residuals
+      memset(Rbatch, 0, nvars * nbatch * sizeof(TacsScalar));
+      addResidualBatch(nbatch, index, time, Xbatch, q[0], q[1], q[2], Rbatch);
 
       // Find the approximated jacobian
-      for (int j = 0; j < nvars; j++) {
-        J[j * nvars + i] += 0.5 * gamma * (Rtmp1[j] - Rtmp2[j]) / dh;
-      }
+      for (int c = 0; c < ncols; c++) {
+        int i = i0 + c;
+#ifdef TACS_USE_COMPLEX
+        const TacsScalar *R = &Rbatch[nvars * c];
+        for (int j = 0; j < nvars; j++) {
+          J[j * nvars + i] += coef[s] * TacsImagPart(R[j]) / dh;
+        }
+#else
+        const TacsScalar *R1 = &Rbatch[nvars * 2 * c];
+        const TacsScalar *R2 = &Rbatch[nvars * (2 * c + 1)];
+        for (int j = 0; j < nvars; j++) {
+          J[j * nvars + i] += 0.5 * coef[s] * (R1[j] - R2[j]) / dh;
+        }
 #endif  // TACS_USE_COMPLEX
-      // Restore the i-th variable
-      qddotTmp[i] = ddvars[i];
+      }
     }
   }
+}
+
+/*
+  Add the residuals for a batch of elements by calling addResidual()
+  for each element in the batch
+*/
+void TACSElement::addResidualBatch(int numElems, const int elemIndex[],
+                                   double time, const TacsScalar Xpts[],
+                                   const TacsScalar vars[],
+                                   const TacsScalar dvars[],
+                                   const TacsScalar ddvars[],
+                                   TacsScalar res[]) {
+  const int nx = 3 * getNumNodes();
+  const int nvars = getNumVariables();
+  for (int i = 0; i < numElems; i++) {
+    addResidual(elemIndex[i], time, &Xpts[nx * i], &vars[nvars * i],
+                &dvars[nvars * i], &ddvars[nvars * i], &res[nvars * i]);
+  }
+}
 
-  delete[] Rtmp1;
-  delete[] Rtmp2;
-  delete[] qTmp;
-  delete[] qdotTmp;
-  delete[] qddotTmp;
+/*
+  Add the residuals and Jacobians for a batch of elements by calling
+  addJacobian() for each element in the batch
+*/
+void TACSElement::addJacobianBatch(int numElems, const int elemIndex[],
+                                   double time, TacsScalar alpha,
+                                   TacsScalar beta, TacsScalar gamma,
+                                   const TacsScalar Xpts[],
+                                   const TacsScalar vars[],
+                                   const TacsScalar dvars[],
+                                   const TacsScalar ddvars[], TacsScalar res[],
+                                   TacsScalar mat[]) {
+  const int nx = 3 * getNumNodes();
+  const int nvars = getNumVariables();
+  for (int i = 0; i < numElems; i++) {
+    addJacobian(elemIndex[i], time, alpha, beta, gamma, &Xpts[nx * i],
+                &vars[nvars * i], &dvars[nvars * i], &ddvars[nvars * i],
+                &res[nvars * i], &mat[nvars * nvars * i]);
+  }
 }
 
 void TACSElement::addAdjResProduct(
     int elemIndex, double time, TacsScalar scale, const TacsScalar psi[],
     const TacsScalar Xpts[], const TacsScalar vars[], const TacsScalar dvars[],
     const TacsScalar ddvars[], int dvLen, TacsScalar dfdx[]) {
+  addAdjResProductFD(elemIndex, time, scale, 1, psi, Xpts, vars, dvars, ddvars,
+                     dvLen, dfdx);
+}
+
+void TACSElement::addAdjResXptProduct(
+    int elemIndex, double time, TacsScalar scale, const TacsScalar psi[],
+    const TacsScalar Xpts[], const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar fXptSens[]) {
+  addAdjResXptProductFD(elemIndex, time, scale, 1, psi, Xpts, vars, dvars,
+                        ddvars, fXptSens);
+}
+
+void TACSElement::addAdjResProductMulti(
+    int elemIndex, double time, TacsScalar scale, int numAdjoints,
+    const TacsScalar psi[], const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], int dvLen,
+    TacsScalar dfdx[]) {
+  int nvars = getNumVariables();
+  int dvSize = dvLen * getDesignVarsPerNode();
+  for (int k = 0; k < numAdjoints; k++) {
+    addAdjResProduct(elemIndex, time, scale, &psi[nvars * k], Xpts, vars,
+                     dvars, ddvars, dvLen, &dfdx[dvSize * k]);
+  }
+}
+
+void TACSElement::addAdjResXptProductMulti(
+    int elemIndex, double time, TacsScalar scale, int numAdjoints,
+    const TacsScalar psi[], const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[],
+    TacsScalar fXptSens[]) {
+  int nvars = getNumVariables();
+  int nxpts = 3 * getNumNodes();
+  for (int k = 0; k < numAdjoints; k++) {
+    addAdjResXptProduct(elemIndex, time, scale, &psi[nvars * k], Xpts, vars,
+                        dvars, ddvars, &fXptSens[nxpts * k]);
+  }
+}
+
+/*
+  Compute the adjoint-residual products with respect to the design
+  variables using finite-differences or the complex-step method. The
+  residual is evaluated once for each perturbed design variable and
+  contracted with all the adjoint vectors.
+*/
+void TACSElement::addAdjResProductFD(
+    int elemIndex, double time, TacsScalar scale, int numAdjoints,
+    const TacsScalar psi[], const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], int dvLen,
+    TacsScalar dfdx[]) {
   // The step length
 #ifdef TACS_USE_COMPLEX
   const double dh = 1e-30;
@@ -212,6 +248,7 @@ void TACSElement::addAdjResProduct(
   getDesignVars(elemIndex, dvLen, x);
 
   int nvars = getNumVariables();
+  int dvSize = dvLen * getDesignVarsPerNode();
   TacsScalar *res = new TacsScalar[nvars];
   TacsScalar *tmp = new TacsScalar[nvars];
 
@@ -231,16 +268,15 @@ void TACSElement::addAdjResProduct(
     memset(tmp, 0, nvars * sizeof(TacsScalar));
     addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, tmp);
 
-    TacsScalar product = 0.0;
 #ifdef TACS_USE_COMPLEX
     for (int i = 0; i < nvars; i++) {
-      product += psi[i] * TacsImagPart(tmp[i]) / dh;
+      tmp[i] = TacsImagPart(tmp[i]) / dh;
     }
 #else
     if (fdOrder < 2) {
       // Use first-order forward differencing
       for (int i = 0; i < nvars; i++) {
-        product += psi[i] * (tmp[i] - res[i]) / dh;
+        tmp[i] = (tmp[i] - res[i]) / dh;
       }
     } else {
       // Use second-order central differencing
@@ -250,12 +286,19 @@ void TACSElement::addAdjResProduct(
       addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, res);
       // Central difference
       for (int i = 0; i < nvars; i++) {
-        product += psi[i] * (tmp[i] - res[i]) / (2.0 * dh);
+        tmp[i] = (tmp[i] - res[i]) / (2.0 * dh);
       }
     }
 #endif  // TACS_USE_COMPLEX
 
-    dfdx[k] += scale * product;
+    // Contract the derivative of the residual with each adjoint
+    for (int j = 0; j < numAdjoints; j++) {
+      TacsScalar product = 0.0;
+      for (int i = 0; i < nvars; i++) {
+        product += psi[nvars * j + i] * tmp[i];
+      }
+      dfdx[dvSize * j + k] += scale * product;
+    }
     x[k] = xt;
   }
 
@@ -267,10 +310,17 @@ void TACSElement::addAdjResProduct(
   delete[] tmp;
 }
 
-void TACSElement::addAdjResXptProduct(
-    int elemIndex, double time, TacsScalar scale, const TacsScalar psi[],
-    const TacsScalar Xpts[], const TacsScalar vars[], const TacsScalar dvars[],
-    const TacsScalar ddvars[], TacsScalar fXptSens[]) {
+/*
+  Compute the adjoint-residual products with respect to the node
+  locations using finite-differences or the complex-step method. The
+  residual is evaluated once for each perturbed node coordinate and
+  contracted with all the adjoint vectors.
+*/
+void TACSElement::addAdjResXptProductFD(
+    int elemIndex, double time, TacsScalar scale, int numAdjoints,
+    const TacsScalar psi[], const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[],
+    TacsScalar fXptSens[]) {
   // The step length
 #ifdef TACS_USE_COMPLEX
   const double dh = 1e-30;
@@ -298,16 +348,15 @@ void TACSElement::addAdjResXptProduct(
     memset(tmp, 0, nvars * sizeof(TacsScalar));
     addResidual(elemIndex, time, X, vars, dvars, ddvars, tmp);
 
-    TacsScalar product = 0.0;
 #ifdef TACS_USE_COMPLEX
     for (int i = 0; i < nvars; i++) {
-      product += psi[i] * TacsImagPart(tmp[i]) / dh;
+      tmp[i] = TacsImagPart(tmp[i]) / dh;
     }
 #else
     if (fdOrder < 2) {
       // Use first-order forward differencing
       for (int i = 0; i < nvars; i++) {
-        product += psi[i] * (tmp[i] - res[i]) / (dh);
+        tmp[i] = (tmp[i] - res[i]) / dh;
       }
     } else {
       // Use second-order central differencing
@@ -316,12 +365,19 @@ void TACSElement::addAdjResXptProduct(
       addResidual(elemIndex, time, X, vars, dvars, ddvars, res);
       // Central difference
       for (int i = 0; i < nvars; i++) {
-        product += psi[i] * (tmp[i] - res[i]) / (2.0 * dh);
+        tmp[i] = (tmp[i] - res[i]) / (2.0 * dh);
       }
     }
 #endif  // TACS_USE_COMPLEX
 
-    fXptSens[k] += scale * product;
+    // Contract the derivative of the residual with each adjoint
+    for (int j = 0; j < numAdjoints; j++) {
+      TacsScalar product = 0.0;
+      for (int i = 0; i < nvars; i++) {
+        product += psi[nvars * j + i] * tmp[i];
+      }
+      fXptSens[3 * nnodes * j + k] += scale * product;
+    }
 
     X[k] = Xpts[k];
   }
@@ -331,6 +387,135 @@ void TACSElement::addAdjResXptProduct(
   delete[] tmp;
 }
 
+void TACSElement::addResDVProduct(
+    int elemIndex, double time, TacsScalar scale, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], int dvLen, const TacsScalar dx[],
+    TacsScalar res[]) {
+  // The step length
+#ifdef TACS_USE_COMPLEX
+  const double dh = 1e-30;
+#else
+  const double dh = 1e-7;
+#endif  // TACS_USE_COMPLEX
+
+  TacsScalar *x0 = new TacsScalar[dvLen];
+  TacsScalar *x = new TacsScalar[dvLen];
+  getDesignVars(elemIndex, dvLen, x0);
+
+  int nvars = getNumVariables();
+  TacsScalar *fres = new TacsScalar[nvars];
+  TacsScalar *bres = new TacsScalar[nvars];
+
+  // Perturb the design variables along the direction
+  for (int k = 0; k < dvLen; k++) {
+#ifdef TACS_USE_COMPLEX
+    x[k] = x0[k] + TacsScalar(0.0, dh) * dx[k];
+#else
+    x[k] = x0[k] + dh * dx[k];
+#endif  // TACS_USE_COMPLEX
+  }
+  setDesignVars(elemIndex, dvLen, x);
+
+  memset(fres, 0, nvars * sizeof(TacsScalar));
+  addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, fres);
+
+#ifdef TACS_USE_COMPLEX
+  for (int i = 0; i < nvars; i++) {
+    res[i] += scale * TacsImagPart(fres[i]) / dh;
+  }
+#else
+  if (fdOrder < 2) {
+    // Use first-order forward differencing
+    setDesignVars(elemIndex, dvLen, x0);
+    memset(bres, 0, nvars * sizeof(TacsScalar));
+    addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, bres);
+    for (int i = 0; i < nvars; i++) {
+      res[i] += scale * (fres[i] - bres[i]) / dh;
+    }
+  } else {
+    // Use second-order central differencing
+    for (int k = 0; k < dvLen; k++) {
+      x[k] = x0[k] - dh * dx[k];
+    }
+    setDesignVars(elemIndex, dvLen, x);
+    memset(bres, 0, nvars * sizeof(TacsScalar));
+    addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, bres);
+    for (int i = 0; i < nvars; i++) {
+      res[i] += scale * (fres[i] - bres[i]) / (2.0 * dh);
+    }
+  }
+#endif  // TACS_USE_COMPLEX
+
+  // Reset the design variable values
+  setDesignVars(elemIndex, dvLen, x0);
+
+  delete[] x0;
+  delete[] x;
+  delete[] fres;
+  delete[] bres;
+}
+
+void TACSElement::addResXptProduct(
+    int elemIndex, double time, TacsScalar scale, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], const TacsScalar dXpts[], TacsScalar res[]) {
+  // The step length
+#ifdef TACS_USE_COMPLEX
+  const double dh = 1e-30;
+#else
+  const double dh = 1e-7;
+#endif  // TACS_USE_COMPLEX
+
+  int nnodes = getNumNodes();
+  TacsScalar *X = new TacsScalar[3 * nnodes];
+
+  int nvars = getNumVariables();
+  TacsScalar *fres = new TacsScalar[nvars];
+  TacsScalar *bres = new TacsScalar[nvars];
+
+  // Perturb the node locations along the direction
+  for (int k = 0; k < 3 * nnodes; k++) {
+#ifdef TACS_USE_COMPLEX
+    X[k] = Xpts[k] + TacsScalar(0.0, dh) * dXpts[k];
+#else
+    X[k] = Xpts[k] + dh * dXpts[k];
+#endif  // TACS_USE_COMPLEX
+  }
+
+  memset(fres, 0, nvars * sizeof(TacsScalar));
+  addResidual(elemIndex, time, X, vars, dvars, ddvars, fres);
+
+#ifdef TACS_USE_COMPLEX
+  for (int i = 0; i < nvars; i++) {
+    res[i] += scale * TacsImagPart(fres[i]) / dh;
+  }
+#else
+  if (fdOrder < 2) {
+    // Use first-order forward differencing
+    memset(bres, 0, nvars * sizeof(TacsScalar));
+    addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, bres);
+    for (int i = 0; i < nvars; i++) {
+      res[i] += scale * (fres[i] - bres[i]) / dh;
+    }
+  } else {
+    // Use second-order central differencing
+    for (int k = 0; k < 3 * nnodes; k++) {
+      X[k] = Xpts[k] - dh * dXpts[k];
+    }
+    memset(bres, 0, nvars * sizeof(TacsScalar));
+    addResidual(elemIndex, time, X, vars, dvars, ddvars, bres);
+    for (int i = 0; i < nvars; i++) {
+      res[i] += scale * (fres[i] - bres[i]) / (2.0 * dh);
+    }
+  }
+#endif  // TACS_USE_COMPLEX
+
+  delete[] X;
+  delete[] fres;
+  delete[] bres;
+}
+
 void TACSElement::getMatType(ElementMatrixType matType, int elemIndex,
                              double time, const TacsScalar Xpts[],
                              const TacsScalar vars[], TacsScalar mat[]) {
@@ -435,6 +620,14 @@ void TACSElement::addMatXptSensInnerProduct(
     ElementMatrixType matType, int elemIndex, double time, TacsScalar scale,
     const TacsScalar psi[], const TacsScalar phi[], const TacsScalar Xpts[],
     const TacsScalar vars[], TacsScalar dfdX[]) {
+  TACSElement::addMatXptSensInnerProducts(matType, elemIndex, time, 1, &scale,
+                                          psi, phi, Xpts, vars, dfdX);
+}
+
+void TACSElement::addMatXptSensInnerProducts(
+    ElementMatrixType matType, int elemIndex, double time, int numVecs,
+    const TacsScalar scale[], const TacsScalar psi[], const TacsScalar phi[],
+    const TacsScalar Xpts[], const TacsScalar vars[], TacsScalar dfdX[]) {
   // The step length
 #ifdef TACS_USE_COMPLEX
   const double dh = 1e-30;
@@ -448,13 +641,19 @@ void TACSElement::addMatXptSensInnerProduct(
 
   int nvars = getNumVariables();
   TacsScalar *mat = new TacsScalar[nvars * nvars];
+  TacsScalar *p1 = new TacsScalar[2 * numVecs];
+  TacsScalar *p2 = &p1[numVecs];
 
+  // Compute the products psi[k]^{T}*mat*phi[k] for all the vectors
   memset(mat, 0, nvars * nvars * sizeof(TacsScalar));
-  TacsScalar p1 = 0.0;
   getMatType(matType, elemIndex, time, Xpts, vars, mat);
-  for (int i = 0; i < nvars; i++) {
-    for (int j = 0; j < nvars; j++) {
-      p1 += mat[i + j * nvars] * psi[i] * phi[j];
+  for (int v = 0; v < numVecs; v++) {
+    const TacsScalar *pv = &psi[nvars * v], *qv = &phi[nvars * v];
+    p1[v] = 0.0;
+    for (int i = 0; i < nvars; i++) {
+      for (int j = 0; j < nvars; j++) {
+        p1[v] += mat[i + j * nvars] * pv[i] * qv[j];
+      }
     }
   }
 
@@ -468,42 +667,52 @@ void TACSElement::addMatXptSensInnerProduct(
 #endif  // TACS_USE_COMPLEX
 
     memset(mat, 0, nvars * nvars * sizeof(TacsScalar));
-    TacsScalar p2 = 0.0;
     getMatType(matType, elemIndex, time, X, vars, mat);
-    for (int i = 0; i < nvars; i++) {
-      for (int j = 0; j < nvars; j++) {
-        p2 += mat[i + j * nvars] * psi[i] * phi[j];
+    for (int v = 0; v < numVecs; v++) {
+      const TacsScalar *pv = &psi[nvars * v], *qv = &phi[nvars * v];
+      p2[v] = 0.0;
+      for (int i = 0; i < nvars; i++) {
+        for (int j = 0; j < nvars; j++) {
+          p2[v] += mat[i + j * nvars] * pv[i] * qv[j];
+        }
       }
     }
 
-    TacsScalar product = 0.0;
 #ifdef TACS_USE_COMPLEX
-    product = TacsImagPart(p2) / dh;
+    for (int v = 0; v < numVecs; v++) {
+      dfdX[3 * nnodes * v + k] += scale[v] * TacsImagPart(p2[v]) / dh;
+    }
 #else
     if (fdOrder < 2) {
       // Use first-order forward differencing
-      product = (p2 - p1) / dh;
+      for (int v = 0; v < numVecs; v++) {
+        dfdX[3 * nnodes * v + k] += scale[v] * (p2[v] - p1[v]) / dh;
+      }
     } else {
       // Use second-order central differencing
       X[k] = xt - dh;  //  backward step
-      p1 = 0.0;
+      memset(mat, 0, nvars * nvars * sizeof(TacsScalar));
       getMatType(matType, elemIndex, time, X, vars, mat);
-      for (int i = 0; i < nvars; i++) {
-        for (int j = 0; j < nvars; j++) {
-          p1 += mat[i + j * nvars] * psi[i] * phi[j];
+      for (int v = 0; v < numVecs; v++) {
+        const TacsScalar *pv = &psi[nvars * v], *qv = &phi[nvars * v];
+        TacsScalar pb = 0.0;
+        for (int i = 0; i < nvars; i++) {
+          for (int j = 0; j < nvars; j++) {
+            pb += mat[i + j * nvars] * pv[i] * qv[j];
+          }
         }
+        // Central difference
+        dfdX[3 * nnodes * v + k] += scale[v] * 0.5 * (p2[v] - pb) / dh;
       }
-      // Central difference
-      product = 0.5 * (p2 - p1) / dh;
     }
 #endif  // TACS_USE_COMPLEX
 
-    dfdX[k] += scale * product;
     X[k] = xt;
   }
 
   delete[] X;
   delete[] mat;
+  delete[] p1;
 }
 
 void TACSElement::getMatSVSensInnerProduct(
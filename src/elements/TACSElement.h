@@ -119,6 +119,21 @@ class TACSElement : public TACSObject {
   */
   virtual int getMultiplierIndex() { return -1; }
 
+  /**
+    Get the node blocks of the element matrices that may be non-zero
+
+    Elements that only couple a few pairs of nodes, such as constraint
+    elements that connect each node to a multiplier node, can list the
+    (row, column) pairs of local node indices for the blocks that may
+    be non-zero. All other blocks of the Jacobian and of the matrices
+    from getMatType() must be zero, so that they can be skipped during
+    assembly. A return value of zero indicates a dense element matrix.
+
+    @param blocks The (row, column) local node pairs for each block
+    @return The number of non-zero node blocks
+  */
+  virtual int getNonZeroNodeBlocks(const int *blocks[]) { return 0; }
+
   /**
     Get the element basis class
 
@@ -324,6 +339,35 @@ class TACSElement : public TACSObject {
     return 0;
   }
 
+  /**
+    Set the number of elements for which the geometric data computed
+    from the node locations is cached
+
+    Elements that support the cache store the geometric data for the
+    element indices less than num_elements the first time it is
+    needed, and reuse it until clearGeometryCache() is called. A value
+    of zero disables the cache.
+
+    @param num_elements The number of cached elements
+  */
+  virtual void setGeometryCache(int num_elements) {}
+
+  /**
+    Discard the cached geometric data when the node locations change
+  */
+  virtual void clearGeometryCache() {}
+
+  /**
+    Set whether addJacobian() only needs to fill the upper triangle
+
+    When the flag is set, the caller fills in the lower triangle of the
+    matrix from the upper triangle, so elements with symmetric
+    Jacobians may skip the computation of the lower triangle.
+
+    @param flag Flag indicating whether only the upper triangle is used
+  */
+  virtual void setUpperMatrixFill(int flag) {}
+
   /**
     Retrieve the initial conditions for time-dependent analysis
 
@@ -453,6 +497,67 @@ class TACSElement : public TACSObject {
                            const TacsScalar dvars[], const TacsScalar ddvars[],
                            TacsScalar res[], TacsScalar mat[]);
 
+  /**
+    Add the residual contributions from a batch of elements that all
+    use this element object.
+
+    The data for each element in the batch is stored contiguously, one
+    element after another. The data for the i-th element in the batch
+    begins at Xpts[3*num_nodes*i], vars[num_vars*i], dvars[num_vars*i],
+    ddvars[num_vars*i] and res[num_vars*i], where num_nodes and
+    num_vars are the values returned by getNumNodes() and
+    getNumVariables().
+
+    The default implementation calls addResidual() for each element.
+    Elements may override this to avoid the per-element overhead.
+
+    @param numElems The number of elements in the batch
+    @param elemIndex The local element indices
+    @param time The simulation time
+    @param Xpts The element node locations
+    @param vars The values of the element degrees of freedom
+    @param dvars The first time derivative of the element DOF
+    @param ddvars The second time derivative of the element DOF
+    @param res The element residuals input/output
+  */
+  virtual void addResidualBatch(int numElems, const int elemIndex[],
+                                double time, const TacsScalar Xpts[],
+                                const TacsScalar vars[],
+                                const TacsScalar dvars[],
+                                const TacsScalar ddvars[], TacsScalar res[]);
+
+  /**
+    Add the residual and Jacobian contributions from a batch of
+    elements that all use this element object.
+
+    The data is stored in the same layout as addResidualBatch(). The
+    Jacobian of the i-th element in the batch begins at
+    mat[num_vars*num_vars*i].
+
+    The default implementation calls addJacobian() for each element.
+
+    @param numElems The number of elements in the batch
+    @param elemIndex The local element indices
+    @param time The simulation time
+    @param alpha The coefficient for the DOF Jacobian
+    @param beta The coefficient for the first time derivative DOF Jacobian
+    @param gamma The coefficient for the second time derivative DOF Jacobian
+    @param Xpts The element node locations
+    @param vars The values of the element degrees of freedom
+    @param dvars The first time derivative of the element DOF
+    @param ddvars The second time derivative of the element DOF
+    @param res The element residuals input/output
+    @param mat The element Jacobians input/output
+  */
+  virtual void addJacobianBatch(int numElems, const int elemIndex[],
+                                double time, TacsScalar alpha,
+                                TacsScalar beta, TacsScalar gamma,
+                                const TacsScalar Xpts[],
+                                const TacsScalar vars[],
+                                const TacsScalar dvars[],
+                                const TacsScalar ddvars[], TacsScalar res[],
+                                TacsScalar mat[]);
+
   /**
     Add the derivative of the adjoint-residual product to the output vector
 
@@ -512,6 +617,127 @@ class TACSElement : public TACSObject {
                                    const TacsScalar ddvars[],
                                    TacsScalar fXptSens[]);
 
+  /**
+    Add the derivatives of several adjoint-residual products to the
+    output vectors
+
+    This adds the contribution scaled by an input factor as follows:
+
+    dfdx[k] += scale*d(psi[k]^{T}*(res))/dx
+
+    The adjoint vectors are stored consecutively in psi, each with
+    getNumVariables() entries, and the derivatives are stored
+    consecutively in dfdx, each with dvLen*getDesignVarsPerNode()
+    entries. By default, this calls addAdjResProduct() for each
+    adjoint. Elements can override this to evaluate the derivative of
+    the residual once and contract it with all the adjoints.
+
+    @param elemIndex The local element index
+    @param time The simulation time
+    @param scale The coefficient for the derivative result
+    @param numAdjoints The number of adjoint vectors
+    @param psi The element adjoint variables
+    @param Xpts The element node locations
+    @param vars The values of the element degrees of freedom
+    @param dvars The first time derivative of the element DOF
+    @param ddvars The second time derivative of the element DOF
+    @param dvLen The length of the design variable vector
+    @param dfdx The derivative vectors
+  */
+  virtual void addAdjResProductMulti(
+      int elemIndex, double time, TacsScalar scale, int numAdjoints,
+      const TacsScalar psi[], const TacsScalar Xpts[], const TacsScalar vars[],
+      const TacsScalar dvars[], const TacsScalar ddvars[], int dvLen,
+      TacsScalar dfdx[]);
+
+  /**
+    Add the derivatives of several adjoint-residual products w.r.t. the
+    node locations to the output vectors
+
+    This adds the contribution scaled by an input factor as follows:
+
+    fXptSens[k] += scale*d(psi[k]^{T}*(res))/d(Xpts)
+
+    The adjoint vectors are stored consecutively in psi, each with
+    getNumVariables() entries, and the derivatives are stored
+    consecutively in fXptSens, each with 3*getNumNodes() entries. By
+    default, this calls addAdjResXptProduct() for each adjoint.
+
+    @param elemIndex The local element index
+    @param time The simulation time
+    @param scale The coefficient for the derivative result
+    @param numAdjoints The number of adjoint vectors
+    @param psi The element adjoint variables
+    @param Xpts The element node locations
+    @param vars The values of the element degrees of freedom
+    @param dvars The first time derivative of the element DOF
+    @param ddvars The second time derivative of the element DOF
+    @param fXptSens The derivative vectors
+  */
+  virtual void addAdjResXptProductMulti(
+      int elemIndex, double time, TacsScalar scale, int numAdjoints,
+      const TacsScalar psi[], const TacsScalar Xpts[], const TacsScalar vars[],
+      const TacsScalar dvars[], const TacsScalar ddvars[],
+      TacsScalar fXptSens[]);
+
+  /**
+    Add the directional derivative of the residual w.r.t. the design
+    variables to the output vector
+
+    This adds the contribution scaled by an input factor as follows:
+
+    res += scale*d(res)/dx*dx
+
+    This is the forward counterpart of addAdjResProduct() and is used
+    for direct sensitivities. By default, the product is computed
+    using a single complex step or finite-difference step along the
+    direction dx.
+
+    @param elemIndex The local element index
+    @param time The simulation time
+    @param scale The coefficient for the derivative result
+    @param Xpts The element node locations
+    @param vars The values of the element degrees of freedom
+    @param dvars The first time derivative of the element DOF
+    @param ddvars The second time derivative of the element DOF
+    @param dvLen The length of the design variable vector
+    @param dx The direction in the design variables
+    @param res The residual product
+  */
+  virtual void addResDVProduct(int elemIndex, double time, TacsScalar scale,
+                               const TacsScalar Xpts[], const TacsScalar vars[],
+                               const TacsScalar dvars[],
+                               const TacsScalar ddvars[], int dvLen,
+                               const TacsScalar dx[], TacsScalar res[]);
+
+  /**
+    Add the directional derivative of the residual w.r.t. the node
+    locations to the output vector
+
+    This adds the contribution scaled by an input factor as follows:
+
+    res += scale*d(res)/d(Xpts)*dXpts
+
+    By default, the product is computed using a single complex step or
+    finite-difference step along the direction dXpts.
+
+    @param elemIndex The local element index
+    @param time The simulation time
+    @param scale The coefficient for the derivative result
+    @param Xpts The element node locations
+    @param vars The values of the element degrees of freedom
+    @param dvars The first time derivative of the element DOF
+    @param ddvars The second time derivative of the element DOF
+    @param dXpts The direction in the node locations
+    @param res The residual product
+  */
+  virtual void addResXptProduct(int elemIndex, double time, TacsScalar scale,
+                                const TacsScalar Xpts[],
+                                const TacsScalar vars[],
+                                const TacsScalar dvars[],
+                                const TacsScalar ddvars[],
+                                const TacsScalar dXpts[], TacsScalar res[]);
+
   /**
     Compute a specific type of element matrix (mass, stiffness, geometric
     stiffness, etc.)
@@ -627,6 +853,33 @@ class TACSElement : public TACSObject {
       const TacsScalar psi[], const TacsScalar phi[], const TacsScalar Xpts[],
       const TacsScalar vars[], TacsScalar dfdXpts[]);
 
+  /**
+   Add the derivatives of the products of a specific matrix with
+   several pairs of vectors w.r.t. the nodal coordinates
+
+   dfdXpts[k] += scale[k]*d(psi[k]^{T}*(mat)*phi[k])/d(X)
+
+   The default implementation evaluates each perturbed element matrix
+   once and applies it to all the pairs of vectors. Elements that
+   implement addMatXptSensInnerProduct() directly should implement
+   this function as well.
+
+   @param matType The type of element matrix to compute
+   @param elemIndex The local element index
+   @param time The simulation time
+   @param numVecs The number of pairs of vectors
+   @param scale The scalar values that multiply each derivative
+   @param psi The left-hand vectors stored one after the other
+   @param phi The right-hand vectors stored one after the other
+   @param Xpts The element node locations
+   @param vars The values of element degrees of freedom
+   @param dfdXpts The element derivatives stored one after the other
+ */
+  virtual void addMatXptSensInnerProducts(
+      ElementMatrixType matType, int elemIndex, double time, int numVecs,
+      const TacsScalar scale[], const TacsScalar psi[], const TacsScalar phi[],
+      const TacsScalar Xpts[], const TacsScalar vars[], TacsScalar dfdXpts[]);
+
   /**
     Compute the derivative of the product of a specific matrix w.r.t.
     the input variables (vars).
@@ -763,6 +1016,21 @@ class TACSElement : public TACSObject {
                              const TacsScalar ddvars[], int ld_data,
                              TacsScalar *data) {}
 
+ protected:
+  // Finite-difference implementations of the adjoint-residual
+  // products. Each perturbed residual is contracted with all the
+  // adjoint vectors.
+  void addAdjResProductFD(int elemIndex, double time, TacsScalar scale,
+                          int numAdjoints, const TacsScalar psi[],
+                          const TacsScalar Xpts[], const TacsScalar vars[],
+                          const TacsScalar dvars[], const TacsScalar ddvars[],
+                          int dvLen, TacsScalar dfdx[]);
+  void addAdjResXptProductFD(int elemIndex, double time, TacsScalar scale,
+                             int numAdjoints, const TacsScalar psi[],
+                             const TacsScalar Xpts[], const TacsScalar vars[],
+                             const TacsScalar dvars[],
+                             const TacsScalar ddvars[], TacsScalar fXptSens[]);
+
  private:
   int componentNum;
   // Defines order of finite differencing method
@@ -18,6 +18,7 @@
 #include "TACSElementAlgebra.h"
 #include "TACSInertialForce2D.h"
 #include "TACSPressure2D.h"
+#include "TACSScratchArena.h"
 #include "TACSTraction2D.h"
 
 TACSElement2D::TACSElement2D(TACSElementModel *_model,
@@ -179,6 +180,15 @@ void TACSElement2D::addJacobian(int elemIndex, double time, TacsScalar alpha,
   model->getWeakMatrixNonzeros(TACS_JACOBIAN_MATRIX, elemIndex, &Jac_nnz,
                                &Jac_pairs);
 
+  // Store the Jacobian transformation and the weak form coefficients at
+  // each quadrature point, the element matrix is added once all of the
+  // quadrature points have been evaluated
+  const int data_size = nquad * (4 + Jac_nnz);
+  const int temp_size = basis->getAllWeakMatricesTempSize(vars_per_node);
+  TACSScratchScope scratch;
+  TacsScalar *data = scratch.allocScalars(data_size + temp_size);
+  TacsScalar *temp = &data[data_size];
+
   // Loop over each quadrature point and add the residual contribution
   for (int n = 0; n < nquad; n++) {
     // Get the quadrature weight
@@ -187,7 +197,8 @@ void TACSElement2D::addJacobian(int elemIndex, double time, TacsScalar alpha,
 
     // Get the solution field and the solution field gradient and the
     // Jacobian transformation
-    TacsScalar X[3], Xd[6], J[4];
+    TacsScalar *J = &data[n * (4 + Jac_nnz)];
+    TacsScalar X[3], Xd[6];
     TacsScalar Ut[3 * MAX_VARS_PER_NODE];
     TacsScalar Ud[2 * MAX_VARS_PER_NODE], Ux[2 * MAX_VARS_PER_NODE];
     TacsScalar detXd = basis->getFieldGradient(
@@ -198,7 +209,7 @@ void TACSElement2D::addJacobian(int elemIndex, double time, TacsScalar alpha,
 
     // Evaluate the weak form of the model
     TacsScalar DUt[3 * MAX_VARS_PER_NODE], DUx[2 * MAX_VARS_PER_NODE];
-    TacsScalar Jac[25 * MAX_VARS_PER_NODE * MAX_VARS_PER_NODE];
+    TacsScalar *Jac = &data[n * (4 + Jac_nnz) + 4];
     model->evalWeakMatrix(TACS_JACOBIAN_MATRIX, elemIndex, n, time, pt, X, Xd,
                           Ut, Ux, DUt, DUx, Jac);
 
@@ -207,10 +218,12 @@ void TACSElement2D::addJacobian(int elemIndex, double time, TacsScalar alpha,
       basis->addWeakResidual(n, pt, detXd, J, vars_per_node, DUt, DUx, res);
     }
 
-    // Add the weak form of the residual at this point
+    // Scale the weak form of the Jacobian at this point
     basis->scaleWeakMatrix(detXd, alpha, beta, gamma, Jac_nnz, Jac_pairs, Jac);
-    basis->addWeakMatrix(n, pt, J, vars_per_node, Jac_nnz, Jac_pairs, Jac, mat);
   }
+
+  // Add the contributions from all the quadrature points
+  basis->addAllWeakMatrices(vars_per_node, Jac_nnz, Jac_pairs, data, temp, mat);
 }
 
 // Functions for the adjoint
@@ -36,8 +36,9 @@
   output:
   out:  the resulting vector
 */
-static inline void crossProduct(const TacsScalar x[], const TacsScalar y[],
-                                TacsScalar out[]) {
+TACS_HOST_DEVICE static inline void crossProduct(const TacsScalar x[],
+                                                 const TacsScalar y[],
+                                                 TacsScalar out[]) {
   out[0] = (x[1] * y[2] - x[2] * y[1]);
   out[1] = (x[2] * y[0] - x[0] * y[2]);
   out[2] = (x[0] * y[1] - x[1] * y[0]);
@@ -57,10 +58,12 @@ static inline void crossProduct(const TacsScalar x[], const TacsScalar y[],
   out:  the resulting vector
   sout: sensitivity of the resulting vector
 */
-static inline void crossProductSens(const TacsScalar A[], const TacsScalar B[],
-                                    const TacsScalar sA[],
-                                    const TacsScalar sB[], TacsScalar out[],
-                                    TacsScalar sout[]) {
+TACS_HOST_DEVICE static inline void crossProductSens(const TacsScalar A[],
+                                                     const TacsScalar B[],
+                                                     const TacsScalar sA[],
+                                                     const TacsScalar sB[],
+                                                     TacsScalar out[],
+                                                     TacsScalar sout[]) {
   //   (A2 * B3 - A3 * B2 ), ( A3 *B1 - A1 * B3 ), ( A1 * B2 - A2 * B1 )
 
   out[0] = A[1] * B[2] - A[2] * B[1];
@@ -85,8 +88,10 @@ static inline void crossProductSens(const TacsScalar A[], const TacsScalar B[],
   output:
   out:  the resulting vector
 */
-static inline void crossProduct(const TacsScalar a, const TacsScalar x[],
-                                const TacsScalar y[], TacsScalar out[]) {
+TACS_HOST_DEVICE static inline void crossProduct(const TacsScalar a,
+                                                 const TacsScalar x[],
+                                                 const TacsScalar y[],
+                                                 TacsScalar out[]) {
   out[0] = a * (x[1] * y[2] - x[2] * y[1]);
   out[1] = a * (x[2] * y[0] - x[0] * y[2]);
   out[2] = a * (x[0] * y[1] - x[1] * y[0]);
@@ -105,8 +110,10 @@ static inline void crossProduct(const TacsScalar a, const TacsScalar x[],
   output:
   out:  the resulting vector
 */
-static inline void crossProductAdd(const TacsScalar a, const TacsScalar x[],
-                                   const TacsScalar y[], TacsScalar out[]) {
+TACS_HOST_DEVICE static inline void crossProductAdd(const TacsScalar a,
+                                                    const TacsScalar x[],
+                                                    const TacsScalar y[],
+                                                    TacsScalar out[]) {
   out[0] += a * (x[1] * y[2] - x[2] * y[1]);
   out[1] += a * (x[2] * y[0] - x[0] * y[2]);
   out[2] += a * (x[0] * y[1] - x[1] * y[0]);
@@ -119,7 +126,8 @@ static inline void crossProductAdd(const TacsScalar a, const TacsScalar x[],
   a:   the scalar
   x:   the vector
 */
-static inline void vec3Scale(const TacsScalar a, TacsScalar x[]) {
+TACS_HOST_DEVICE static inline void vec3Scale(const TacsScalar a,
+                                              TacsScalar x[]) {
   x[0] *= a;
   x[1] *= a;
   x[2] *= a;
@@ -136,7 +144,8 @@ static inline void vec3Scale(const TacsScalar a, TacsScalar x[]) {
 
   returns: the dot product
 */
-static inline TacsScalar vec3Dot(const TacsScalar x[], const TacsScalar y[]) {
+TACS_HOST_DEVICE static inline TacsScalar vec3Dot(const TacsScalar x[],
+                                                  const TacsScalar y[]) {
   return (x[0] * y[0] + x[1] * y[1] + x[2] * y[2]);
 }
 
@@ -152,8 +161,9 @@ static inline TacsScalar vec3Dot(const TacsScalar x[], const TacsScalar y[]) {
   in/out:
   y:    the result
 */
-static inline void vec3Axpy(const TacsScalar a, const TacsScalar x[],
-                            TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void vec3Axpy(const TacsScalar a,
+                                             const TacsScalar x[],
+                                             TacsScalar y[]) {
   y[0] += a * x[0];
   y[1] += a * x[1];
   y[2] += a * x[2];
@@ -166,7 +176,8 @@ static inline void vec3Axpy(const TacsScalar a, const TacsScalar x[],
   a:   the scalar
   x:   the vector
 */
-static inline void vec2Scale(const TacsScalar a, TacsScalar x[]) {
+TACS_HOST_DEVICE static inline void vec2Scale(const TacsScalar a,
+                                              TacsScalar x[]) {
   x[0] *= a;
   x[1] *= a;
 }
@@ -182,7 +193,8 @@ static inline void vec2Scale(const TacsScalar a, TacsScalar x[]) {
 
   returns: the dot product
 */
-static inline TacsScalar vec2Dot(const TacsScalar x[], const TacsScalar y[]) {
+TACS_HOST_DEVICE static inline TacsScalar vec2Dot(const TacsScalar x[],
+                                                  const TacsScalar y[]) {
   return (x[0] * y[0] + x[1] * y[1]);
 }
 
@@ -198,8 +210,9 @@ static inline TacsScalar vec2Dot(const TacsScalar x[], const TacsScalar y[]) {
   in/out:
   y:    the result
 */
-static inline void vec2Axpy(const TacsScalar a, const TacsScalar x[],
-                            TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void vec2Axpy(const TacsScalar a,
+                                             const TacsScalar x[],
+                                             TacsScalar y[]) {
   y[0] += a * x[0];
   y[1] += a * x[1];
 }
@@ -216,8 +229,9 @@ static inline void vec2Axpy(const TacsScalar a, const TacsScalar x[],
   output:
   C:   the resulting matrix
 */
-static inline void vec3x3Outer(const TacsReal a[], const TacsReal b[],
-                               TacsReal C[]) {
+TACS_HOST_DEVICE static inline void vec3x3Outer(const TacsReal a[],
+                                                const TacsReal b[],
+                                                TacsReal C[]) {
   C[0] = a[0] * b[0];
   C[1] = a[0] * b[1];
   C[2] = a[0] * b[2];
@@ -243,8 +257,10 @@ static inline void vec3x3Outer(const TacsReal a[], const TacsReal b[],
   output:
   C:   the resulting matrix
 */
-static inline void vec3x3OuterAdd(const TacsScalar alpha, const TacsScalar a[],
-                                  const TacsScalar b[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void vec3x3OuterAdd(const TacsScalar alpha,
+                                                   const TacsScalar a[],
+                                                   const TacsScalar b[],
+                                                   TacsScalar C[]) {
   C[0] += alpha * a[0] * b[0];
   C[1] += alpha * a[0] * b[1];
   C[2] += alpha * a[0] * b[2];
@@ -270,8 +286,9 @@ static inline void vec3x3OuterAdd(const TacsScalar alpha, const TacsScalar a[],
   output:
   C:   the resulting matrix
 */
-static inline void vec3x3Outer(const TacsComplex a[], const TacsReal b[],
-                               TacsComplex C[]) {
+TACS_HOST_DEVICE static inline void vec3x3Outer(const TacsComplex a[],
+                                                const TacsReal b[],
+                                                TacsComplex C[]) {
   C[0] = a[0] * b[0];
   C[1] = a[0] * b[1];
   C[2] = a[0] * b[2];
@@ -297,9 +314,10 @@ static inline void vec3x3Outer(const TacsComplex a[], const TacsReal b[],
   output:
   C:   the resulting matrix
 */
-static inline void vec3x3OuterAdd(const TacsComplex alpha,
-                                  const TacsComplex a[], const TacsReal b[],
-                                  TacsComplex C[]) {
+TACS_HOST_DEVICE static inline void vec3x3OuterAdd(const TacsComplex alpha,
+                                                   const TacsComplex a[],
+                                                   const TacsReal b[],
+                                                   TacsComplex C[]) {
   C[0] += alpha * a[0] * b[0];
   C[1] += alpha * a[0] * b[1];
   C[2] += alpha * a[0] * b[2];
@@ -325,8 +343,9 @@ static inline void vec3x3OuterAdd(const TacsComplex alpha,
   output:
   C:   the resulting matrix
 */
-static inline void vec2x2Outer(const TacsScalar a[], const TacsScalar b[],
-                               TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void vec2x2Outer(const TacsScalar a[],
+                                                const TacsScalar b[],
+                                                TacsScalar C[]) {
   C[0] = a[0] * b[0];
   C[1] = a[0] * b[1];
 
@@ -346,8 +365,10 @@ static inline void vec2x2Outer(const TacsScalar a[], const TacsScalar b[],
   output:
   C:   the resulting matrix
 */
-static inline void vec2x2OuterAdd(const TacsScalar alpha, const TacsScalar a[],
-                                  const TacsScalar b[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void vec2x2OuterAdd(const TacsScalar alpha,
+                                                   const TacsScalar a[],
+                                                   const TacsScalar b[],
+                                                   TacsScalar C[]) {
   C[0] += alpha * a[0] * b[0];
   C[1] += alpha * a[0] * b[1];
 
@@ -367,8 +388,9 @@ static inline void vec2x2OuterAdd(const TacsScalar alpha, const TacsScalar a[],
   output:
   C:   the resulting matrix
 */
-static inline void vec2x2Outer(const TacsComplex a[], const TacsReal b[],
-                               TacsComplex C[]) {
+TACS_HOST_DEVICE static inline void vec2x2Outer(const TacsComplex a[],
+                                                const TacsReal b[],
+                                                TacsComplex C[]) {
   C[0] = a[0] * b[0];
   C[1] = a[0] * b[1];
 
@@ -388,9 +410,10 @@ static inline void vec2x2Outer(const TacsComplex a[], const TacsReal b[],
   output:
   C:   the resulting matrix
 */
-static inline void vec2x2OuterAdd(const TacsComplex alpha,
-                                  const TacsComplex a[], const TacsReal b[],
-                                  TacsComplex C[]) {
+TACS_HOST_DEVICE static inline void vec2x2OuterAdd(const TacsComplex alpha,
+                                                   const TacsComplex a[],
+                                                   const TacsReal b[],
+                                                   TacsComplex C[]) {
   C[0] += alpha * a[0] * b[0];
   C[1] += alpha * a[0] * b[1];
 
@@ -406,8 +429,9 @@ static inline void vec2x2OuterAdd(const TacsComplex alpha,
 
   d(x/||x||_{2})/dx = (I*||x||^2 + x*x^{T})/||x||^3
 */
-static inline void vec3NormDeriv(TacsScalar nrm, const TacsScalar x[],
-                                 TacsScalar D[]) {
+TACS_HOST_DEVICE static inline void vec3NormDeriv(TacsScalar nrm,
+                                                  const TacsScalar x[],
+                                                  TacsScalar D[]) {
   TacsScalar s = 1.0 / (nrm * nrm * nrm);
   TacsScalar t = nrm * nrm;
 
@@ -434,7 +458,7 @@ static inline void vec3NormDeriv(TacsScalar nrm, const TacsScalar x[],
   A: normalized 3-vector
   Anrm: norm of input vector
 */
-static inline TacsScalar vec3Normalize(TacsScalar A[]) {
+TACS_HOST_DEVICE static inline TacsScalar vec3Normalize(TacsScalar A[]) {
   TacsScalar Anrm = sqrt(A[0] * A[0] + A[1] * A[1] + A[2] * A[2]);
   TacsScalar invAnrm = 1.0 / Anrm;
 
@@ -459,8 +483,9 @@ static inline TacsScalar vec3Normalize(TacsScalar A[]) {
   Anrm: norm of input vector
   sAnrm: sensitivity of the norm of input vector
 */
-static inline TacsScalar vec3NormalizeSens(TacsScalar A[], TacsScalar *sAnrm,
-                                           TacsScalar sA[]) {
+TACS_HOST_DEVICE static inline TacsScalar vec3NormalizeSens(TacsScalar A[],
+                                                            TacsScalar *sAnrm,
+                                                            TacsScalar sA[]) {
   TacsScalar Anrm = sqrt(A[0] * A[0] + A[1] * A[1] + A[2] * A[2]);
   TacsScalar invAnrm = 1.0 / Anrm;
   *sAnrm = (1.0 / Anrm) * (A[0] * sA[0] + A[1] * sA[1] + A[2] * sA[2]);
@@ -490,8 +515,9 @@ static inline TacsScalar vec3NormalizeSens(TacsScalar A[], TacsScalar *sAnrm,
   output:
   y:   the resulting vector
 */
-static inline void mat3x3Mult(const TacsScalar A[], const TacsScalar x[],
-                              TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat3x3Mult(const TacsScalar A[],
+                                               const TacsScalar x[],
+                                               TacsScalar y[]) {
   y[0] = A[0] * x[0] + A[1] * x[1] + A[2] * x[2];
   y[1] = A[3] * x[0] + A[4] * x[1] + A[5] * x[2];
   y[2] = A[6] * x[0] + A[7] * x[1] + A[8] * x[2];
@@ -507,8 +533,9 @@ static inline void mat3x3Mult(const TacsScalar A[], const TacsScalar x[],
   output:
   y:   the resulting vector
 */
-static inline void mat3x3Mult(const TacsComplex A[], const TacsReal x[],
-                              TacsComplex y[]) {
+TACS_HOST_DEVICE static inline void mat3x3Mult(const TacsComplex A[],
+                                               const TacsReal x[],
+                                               TacsComplex y[]) {
   y[0] = A[0] * x[0] + A[1] * x[1] + A[2] * x[2];
   y[1] = A[3] * x[0] + A[4] * x[1] + A[5] * x[2];
   y[2] = A[6] * x[0] + A[7] * x[1] + A[8] * x[2];
@@ -524,8 +551,9 @@ static inline void mat3x3Mult(const TacsComplex A[], const TacsReal x[],
   output:
   y:   the resulting vector
 */
-static inline void mat2x2Mult(const TacsScalar A[], const TacsScalar x[],
-                              TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat2x2Mult(const TacsScalar A[],
+                                               const TacsScalar x[],
+                                               TacsScalar y[]) {
   y[0] = A[0] * x[0] + A[1] * x[1];
   y[1] = A[2] * x[0] + A[3] * x[1];
 }
@@ -540,8 +568,9 @@ static inline void mat2x2Mult(const TacsScalar A[], const TacsScalar x[],
   output:
   y:   the resulting vector
 */
-static inline void mat2x2Mult(const TacsComplex A[], const TacsReal x[],
-                              TacsComplex y[]) {
+TACS_HOST_DEVICE static inline void mat2x2Mult(const TacsComplex A[],
+                                               const TacsReal x[],
+                                               TacsComplex y[]) {
   y[0] = A[0] * x[0] + A[1] * x[1];
   y[1] = A[2] * x[0] + A[3] * x[1];
 }
@@ -556,8 +585,9 @@ static inline void mat2x2Mult(const TacsComplex A[], const TacsReal x[],
   output:
   y:   the resulting vector
 */
-static inline void mat3x3MultTrans(const TacsScalar A[], const TacsScalar x[],
-                                   TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat3x3MultTrans(const TacsScalar A[],
+                                                    const TacsScalar x[],
+                                                    TacsScalar y[]) {
   y[0] = A[0] * x[0] + A[3] * x[1] + A[6] * x[2];
   y[1] = A[1] * x[0] + A[4] * x[1] + A[7] * x[2];
   y[2] = A[2] * x[0] + A[5] * x[1] + A[8] * x[2];
@@ -573,8 +603,9 @@ static inline void mat3x3MultTrans(const TacsScalar A[], const TacsScalar x[],
   output:
   y:   the resulting vector
 */
-static inline void mat3x3MultTrans(const TacsComplex A[], const TacsReal x[],
-                                   TacsComplex y[]) {
+TACS_HOST_DEVICE static inline void mat3x3MultTrans(const TacsComplex A[],
+                                                    const TacsReal x[],
+                                                    TacsComplex y[]) {
   y[0] = A[0] * x[0] + A[3] * x[1] + A[6] * x[2];
   y[1] = A[1] * x[0] + A[4] * x[1] + A[7] * x[2];
   y[2] = A[2] * x[0] + A[5] * x[1] + A[8] * x[2];
@@ -590,8 +621,9 @@ static inline void mat3x3MultTrans(const TacsComplex A[], const TacsReal x[],
   output:
   y:   the resulting vector
 */
-static inline void mat2x2MultTrans(const TacsScalar A[], const TacsScalar x[],
-                                   TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat2x2MultTrans(const TacsScalar A[],
+                                                    const TacsScalar x[],
+                                                    TacsScalar y[]) {
   y[0] = A[0] * x[0] + A[2] * x[1];
   y[1] = A[1] * x[0] + A[3] * x[1];
 }
@@ -606,8 +638,9 @@ static inline void mat2x2MultTrans(const TacsScalar A[], const TacsScalar x[],
   output:
   y:   the resulting vector
 */
-static inline void mat2x2MultTrans(const TacsComplex A[], const TacsReal x[],
-                                   TacsComplex y[]) {
+TACS_HOST_DEVICE static inline void mat2x2MultTrans(const TacsComplex A[],
+                                                    const TacsReal x[],
+                                                    TacsComplex y[]) {
   y[0] = A[0] * x[0] + A[2] * x[1];
   y[1] = A[1] * x[0] + A[3] * x[1];
 }
@@ -622,8 +655,9 @@ static inline void mat2x2MultTrans(const TacsComplex A[], const TacsReal x[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat3x3MultAdd(const TacsScalar A[], const TacsScalar x[],
-                                 TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat3x3MultAdd(const TacsScalar A[],
+                                                  const TacsScalar x[],
+                                                  TacsScalar y[]) {
   y[0] += A[0] * x[0] + A[1] * x[1] + A[2] * x[2];
   y[1] += A[3] * x[0] + A[4] * x[1] + A[5] * x[2];
   y[2] += A[6] * x[0] + A[7] * x[1] + A[8] * x[2];
@@ -639,8 +673,9 @@ static inline void mat3x3MultAdd(const TacsScalar A[], const TacsScalar x[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat2x2MultAdd(const TacsScalar A[], const TacsScalar x[],
-                                 TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat2x2MultAdd(const TacsScalar A[],
+                                                  const TacsScalar x[],
+                                                  TacsScalar y[]) {
   y[0] += A[0] * x[0] + A[1] * x[1];
   y[1] += A[2] * x[0] + A[3] * x[1];
 }
@@ -655,8 +690,9 @@ static inline void mat2x2MultAdd(const TacsScalar A[], const TacsScalar x[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat3x3MultTransAdd(const TacsScalar A[],
-                                      const TacsScalar x[], TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat3x3MultTransAdd(const TacsScalar A[],
+                                                       const TacsScalar x[],
+                                                       TacsScalar y[]) {
   y[0] += A[0] * x[0] + A[3] * x[1] + A[6] * x[2];
   y[1] += A[1] * x[0] + A[4] * x[1] + A[7] * x[2];
   y[2] += A[2] * x[0] + A[5] * x[1] + A[8] * x[2];
@@ -672,8 +708,9 @@ static inline void mat3x3MultTransAdd(const TacsScalar A[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat2x2MultTransAdd(const TacsScalar A[],
-                                      const TacsScalar x[], TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat2x2MultTransAdd(const TacsScalar A[],
+                                                       const TacsScalar x[],
+                                                       TacsScalar y[]) {
   y[0] += A[0] * x[0] + A[2] * x[1];
   y[1] += A[1] * x[0] + A[3] * x[1];
 }
@@ -688,8 +725,9 @@ static inline void mat2x2MultTransAdd(const TacsScalar A[],
   x:   a 3-vector
   y:   a 3-vector
 */
-static inline TacsScalar mat3x3Inner(const TacsScalar A[], const TacsScalar x[],
-                                     const TacsScalar y[]) {
+TACS_HOST_DEVICE static inline TacsScalar mat3x3Inner(const TacsScalar A[],
+                                                      const TacsScalar x[],
+                                                      const TacsScalar y[]) {
   return (x[0] * (A[0] * y[0] + A[1] * y[1] + A[2] * y[2]) +
           x[1] * (A[3] * y[0] + A[4] * y[1] + A[5] * y[2]) +
           x[2] * (A[6] * y[0] + A[7] * y[1] + A[8] * y[2]));
@@ -705,8 +743,9 @@ static inline TacsScalar mat3x3Inner(const TacsScalar A[], const TacsScalar x[],
   x:   a 2-vector
   y:   a 2-vector
 */
-static inline TacsScalar mat2x2Inner(const TacsScalar A[], const TacsScalar x[],
-                                     const TacsScalar y[]) {
+TACS_HOST_DEVICE static inline TacsScalar mat2x2Inner(const TacsScalar A[],
+                                                      const TacsScalar x[],
+                                                      const TacsScalar y[]) {
   return (x[0] * (A[0] * y[0] + A[1] * y[1]) +
           x[1] * (A[2] * y[0] + A[3] * y[1]));
 }
@@ -721,9 +760,8 @@ static inline TacsScalar mat2x2Inner(const TacsScalar A[], const TacsScalar x[],
 
   returns:  the inner product
 */
-static inline TacsScalar mat3x3SymmInner(const TacsScalar A[],
-                                         const TacsScalar x[],
-                                         const TacsScalar y[]) {
+TACS_HOST_DEVICE static inline TacsScalar mat3x3SymmInner(
+    const TacsScalar A[], const TacsScalar x[], const TacsScalar y[]) {
   return (y[0] * (A[0] * x[0] + A[1] * x[1] + A[2] * x[2]) +
           y[1] * (A[1] * x[0] + A[3] * x[1] + A[4] * x[2]) +
           y[2] * (A[2] * x[0] + A[4] * x[1] + A[5] * x[2]));
@@ -739,9 +777,8 @@ static inline TacsScalar mat3x3SymmInner(const TacsScalar A[],
 
   returns:  the inner product
 */
-static inline TacsScalar mat2x2SymmInner(const TacsScalar A[],
-                                         const TacsScalar x[],
-                                         const TacsScalar y[]) {
+TACS_HOST_DEVICE static inline TacsScalar mat2x2SymmInner(
+    const TacsScalar A[], const TacsScalar x[], const TacsScalar y[]) {
   return (y[0] * (A[0] * x[0] + A[1] * x[1]) +
           y[1] * (A[1] * x[0] + A[2] * x[1]));
 }
@@ -756,8 +793,9 @@ static inline TacsScalar mat2x2SymmInner(const TacsScalar A[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat3x3SymmMult(const TacsScalar A[], const TacsScalar x[],
-                                  TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmMult(const TacsScalar A[],
+                                                   const TacsScalar x[],
+                                                   TacsScalar y[]) {
   y[0] = A[0] * x[0] + A[1] * x[1] + A[2] * x[2];
   y[1] = A[1] * x[0] + A[3] * x[1] + A[4] * x[2];
   y[2] = A[2] * x[0] + A[4] * x[1] + A[5] * x[2];
@@ -773,8 +811,9 @@ static inline void mat3x3SymmMult(const TacsScalar A[], const TacsScalar x[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat2x2SymmMult(const TacsScalar A[], const TacsScalar x[],
-                                  TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat2x2SymmMult(const TacsScalar A[],
+                                                   const TacsScalar x[],
+                                                   TacsScalar y[]) {
   y[0] = A[0] * x[0] + A[1] * x[1];
   y[1] = A[1] * x[0] + A[2] * x[1];
 }
@@ -789,8 +828,9 @@ static inline void mat2x2SymmMult(const TacsScalar A[], const TacsScalar x[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat3x3SymmMultAdd(const TacsScalar A[], const TacsScalar x[],
-                                     TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmMultAdd(const TacsScalar A[],
+                                                      const TacsScalar x[],
+                                                      TacsScalar y[]) {
   y[0] += A[0] * x[0] + A[1] * x[1] + A[2] * x[2];
   y[1] += A[1] * x[0] + A[3] * x[1] + A[4] * x[2];
   y[2] += A[2] * x[0] + A[4] * x[1] + A[5] * x[2];
@@ -806,8 +846,9 @@ static inline void mat3x3SymmMultAdd(const TacsScalar A[], const TacsScalar x[],
   in/out:
   y:   the resulting vector
 */
-static inline void mat2x2SymmMultAdd(const TacsScalar A[], const TacsScalar x[],
-                                     TacsScalar y[]) {
+TACS_HOST_DEVICE static inline void mat2x2SymmMultAdd(const TacsScalar A[],
+                                                      const TacsScalar x[],
+                                                      TacsScalar y[]) {
   y[0] += A[0] * x[0] + A[1] * x[1];
   y[1] += A[1] * x[0] + A[2] * x[1];
 }
@@ -822,8 +863,9 @@ static inline void mat2x2SymmMultAdd(const TacsScalar A[], const TacsScalar x[],
   output:
   C:   the resulting matrix
 */
-static inline void mat3x3MatMult(const TacsScalar A[], const TacsScalar B[],
-                                 TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat3x3MatMult(const TacsScalar A[],
+                                                  const TacsScalar B[],
+                                                  TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[1] * B[3] + A[2] * B[6];
   C[3] = A[3] * B[0] + A[4] * B[3] + A[5] * B[6];
   C[6] = A[6] * B[0] + A[7] * B[3] + A[8] * B[6];
@@ -847,8 +889,9 @@ static inline void mat3x3MatMult(const TacsScalar A[], const TacsScalar B[],
   output:
   C:   the resulting matrix
 */
-static inline void mat2x2MatMult(const TacsScalar A[], const TacsScalar B[],
-                                 TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat2x2MatMult(const TacsScalar A[],
+                                                  const TacsScalar B[],
+                                                  TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[1] * B[2];
   C[2] = A[2] * B[0] + A[3] * B[2];
 
@@ -866,8 +909,9 @@ static inline void mat2x2MatMult(const TacsScalar A[], const TacsScalar B[],
   output:
   C:   the resulting matrix
 */
-static inline void mat3x3MatTransMult(const TacsScalar A[],
-                                      const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat3x3MatTransMult(const TacsScalar A[],
+                                                       const TacsScalar B[],
+                                                       TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
   C[3] = A[3] * B[0] + A[4] * B[1] + A[5] * B[2];
   C[6] = A[6] * B[0] + A[7] * B[1] + A[8] * B[2];
@@ -891,8 +935,9 @@ static inline void mat3x3MatTransMult(const TacsScalar A[],
   output:
   C:   the resulting matrix
 */
-static inline void mat2x2MatTransMult(const TacsScalar A[],
-                                      const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat2x2MatTransMult(const TacsScalar A[],
+                                                       const TacsScalar B[],
+                                                       TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[1] * B[1];
   C[1] = A[0] * B[2] + A[1] * B[3];
 
@@ -910,8 +955,9 @@ static inline void mat2x2MatTransMult(const TacsScalar A[],
   output:
   C:   the resulting matrix
 */
-static inline void mat3x3TransMatMult(const TacsScalar A[],
-                                      const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat3x3TransMatMult(const TacsScalar A[],
+                                                       const TacsScalar B[],
+                                                       TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[3] * B[3] + A[6] * B[6];
   C[1] = A[0] * B[1] + A[3] * B[4] + A[6] * B[7];
   C[2] = A[0] * B[2] + A[3] * B[5] + A[6] * B[8];
@@ -935,8 +981,9 @@ static inline void mat3x3TransMatMult(const TacsScalar A[],
   output:
   C:   the resulting matrix
 */
-static inline void mat2x2TransMatMult(const TacsScalar A[],
-                                      const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat2x2TransMatMult(const TacsScalar A[],
+                                                       const TacsScalar B[],
+                                                       TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[2] * B[2];
   C[1] = A[0] * B[1] + A[2] * B[3];
 
@@ -954,8 +1001,9 @@ static inline void mat2x2TransMatMult(const TacsScalar A[],
   output:
   C:   the resulting matrix
 */
-static inline void mat3x3MatMultAdd(const TacsScalar A[], const TacsScalar B[],
-                                    TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat3x3MatMultAdd(const TacsScalar A[],
+                                                     const TacsScalar B[],
+                                                     TacsScalar C[]) {
   C[0] += A[0] * B[0] + A[1] * B[3] + A[2] * B[6];
   C[3] += A[3] * B[0] + A[4] * B[3] + A[5] * B[6];
   C[6] += A[6] * B[0] + A[7] * B[3] + A[8] * B[6];
@@ -979,8 +1027,9 @@ static inline void mat3x3MatMultAdd(const TacsScalar A[], const TacsScalar B[],
   output:
   C:   the resulting matrix
 */
-static inline void mat2x2MatMultAdd(const TacsScalar A[], const TacsScalar B[],
-                                    TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat2x2MatMultAdd(const TacsScalar A[],
+                                                     const TacsScalar B[],
+                                                     TacsScalar C[]) {
   C[0] += A[0] * B[0] + A[1] * B[2];
   C[2] += A[2] * B[0] + A[3] * B[2];
 
@@ -991,10 +1040,9 @@ static inline void mat2x2MatMultAdd(const TacsScalar A[], const TacsScalar B[],
 /*
   Compute D = A^{T}*B*C
 */
-static inline void mat3x3TransMatTransform(const TacsScalar A[],
-                                           const TacsScalar B[],
-                                           const TacsScalar C[],
-                                           TacsScalar D[]) {
+TACS_HOST_DEVICE static inline void mat3x3TransMatTransform(
+    const TacsScalar A[], const TacsScalar B[], const TacsScalar C[],
+    TacsScalar D[]) {
   TacsScalar tmp[9];
   mat3x3TransMatMult(A, B, tmp);
   mat3x3MatMult(tmp, C, D);
@@ -1003,10 +1051,9 @@ static inline void mat3x3TransMatTransform(const TacsScalar A[],
 /*
   Compute D += A^{T}*B*C
 */
-static inline void mat3x3TransMatTransformAdd(const TacsScalar A[],
-                                              const TacsScalar B[],
-                                              const TacsScalar C[],
-                                              TacsScalar D[]) {
+TACS_HOST_DEVICE static inline void mat3x3TransMatTransformAdd(
+    const TacsScalar A[], const TacsScalar B[], const TacsScalar C[],
+    TacsScalar D[]) {
   TacsScalar tmp[9];
   mat3x3TransMatMult(A, B, tmp);
   mat3x3MatMultAdd(tmp, C, D);
@@ -1022,8 +1069,9 @@ static inline void mat3x3TransMatTransformAdd(const TacsScalar A[],
   output:
   C:   the resulting matrix
 */
-static inline void mat3x3TransMatMultAdd(const TacsScalar A[],
-                                         const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat3x3TransMatMultAdd(const TacsScalar A[],
+                                                          const TacsScalar B[],
+                                                          TacsScalar C[]) {
   C[0] += A[0] * B[0] + A[3] * B[3] + A[6] * B[6];
   C[1] += A[0] * B[1] + A[3] * B[4] + A[6] * B[7];
   C[2] += A[0] * B[2] + A[3] * B[5] + A[6] * B[8];
@@ -1047,8 +1095,9 @@ static inline void mat3x3TransMatMultAdd(const TacsScalar A[],
   output:
   A:  the 3x3 flattened symmetric matrix
 */
-static inline void mat3x3SymmTransform(const TacsScalar T[],
-                                       const TacsScalar S[], TacsScalar A[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmTransform(const TacsScalar T[],
+                                                        const TacsScalar S[],
+                                                        TacsScalar A[]) {
   // Compute W = S*T^{T}
   // [S[0] S[1] S[2]][T[0] T[3] T[6]]
   // [S[1] S[3] S[4]][T[1] T[4] T[7]]
@@ -1091,9 +1140,8 @@ static inline void mat3x3SymmTransform(const TacsScalar T[],
   output:
   A:  the 3x3 flattened symmetric matrix
 */
-static inline void mat3x3SymmTransformTranspose(const TacsScalar T[],
-                                                const TacsScalar S[],
-                                                TacsScalar A[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmTransformTranspose(
+    const TacsScalar T[], const TacsScalar S[], TacsScalar A[]) {
   // Compute W = S*T
   // [S[0] S[1] S[2]][T[0] T[1] T[2]]
   // [S[1] S[3] S[4]][T[3] T[4] T[5]]
@@ -1136,9 +1184,8 @@ static inline void mat3x3SymmTransformTranspose(const TacsScalar T[],
   output:
   dS:  the derivative w.r.t. the 3x3 flattened symmetric matrix
 */
-static inline void mat3x3SymmTransformSens(const TacsScalar T[],
-                                           const TacsScalar dA[],
-                                           TacsScalar dS[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmTransformSens(
+    const TacsScalar T[], const TacsScalar dA[], TacsScalar dS[]) {
   TacsScalar dW[9];
 
   dW[0] = T[0] * dA[0];
@@ -1176,9 +1223,8 @@ static inline void mat3x3SymmTransformSens(const TacsScalar T[],
   output:
   dS:  the derivative w.r.t. the 3x3 flattened symmetric matrix
 */
-static inline void mat3x3SymmTransformTransSens(const TacsScalar T[],
-                                                const TacsScalar dA[],
-                                                TacsScalar dS[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmTransformTransSens(
+    const TacsScalar T[], const TacsScalar dA[], TacsScalar dS[]) {
   TacsScalar dW[9];
   dW[0] = T[0] * dA[0];
   dW[1] = T[0] * dA[1] + T[1] * dA[3];
@@ -1217,9 +1263,8 @@ static inline void mat3x3SymmTransformTransSens(const TacsScalar T[],
   output:
   d2S: The second derivative of the 3x3 symmetric matrix
 */
-static inline void mat3x3SymmTransformTransHessian(const TacsScalar T[],
-                                                   const TacsScalar d2A[],
-                                                   TacsScalar d2S[]) {
+TACS_HOST_DEVICE static inline void mat3x3SymmTransformTransHessian(
+    const TacsScalar T[], const TacsScalar d2A[], TacsScalar d2S[]) {
   TacsScalar tmp[36];
   const TacsScalar *dA = d2A;
   TacsScalar *dS = tmp;
@@ -1297,9 +1342,9 @@ static inline void mat3x3SymmTransformTransHessian(const TacsScalar T[],
   output:
   D:   the output
 */
-static inline void mat3x3MatSkewTransform(const TacsScalar B[],
-                                          const TacsScalar c[],
-                                          TacsScalar D[]) {
+TACS_HOST_DEVICE static inline void mat3x3MatSkewTransform(const TacsScalar B[],
+                                                           const TacsScalar c[],
+                                                           TacsScalar D[]) {
   // [B[0]  B[1]  B[2]][0    -c[2]  c[1]]
   // [B[3]  B[4]  B[5]][c[2]   0   -c[0]]
   // [B[6]  B[7]  B[8]][-c[1] c[0]  a[1]]
@@ -1328,9 +1373,9 @@ static inline void mat3x3MatSkewTransform(const TacsScalar B[],
   output:
   D:   the output
 */
-static inline void mat3x3SkewMatTransform(const TacsScalar a[],
-                                          const TacsScalar B[],
-                                          TacsScalar D[]) {
+TACS_HOST_DEVICE static inline void mat3x3SkewMatTransform(const TacsScalar a[],
+                                                           const TacsScalar B[],
+                                                           TacsScalar D[]) {
   // [0    -a[2]  a[1]][B[0]  B[1]  B[2]]
   // [a[2]   0   -a[0]][B[3]  B[4]  B[5]]
   // [-a[1] a[0]  a[1]][B[6]  B[7]  B[8]]
@@ -1359,10 +1404,9 @@ static inline void mat3x3SkewMatTransform(const TacsScalar a[],
   output:
   D:   the output
 */
-static inline void mat3x3SkewMatSkewTransform(const TacsScalar a[],
-                                              const TacsScalar B[],
-                                              const TacsScalar c[],
-                                              TacsScalar D[]) {
+TACS_HOST_DEVICE static inline void mat3x3SkewMatSkewTransform(
+    const TacsScalar a[], const TacsScalar B[], const TacsScalar c[],
+    TacsScalar D[]) {
   // [0    -a[2]  a[1]][B[0]  B[1]  B[2]][0    -c[2]  c[1]]
   // [a[2]   0   -a[0]][B[3]  B[4]  B[5]][c[2]   0   -c[0]]
   // [-a[1] a[0]  a[1]][B[6]  B[7]  B[8]][-c[1] c[0]  a[1]]
@@ -1403,8 +1447,9 @@ static inline void mat3x3SkewMatSkewTransform(const TacsScalar a[],
   output:
   C:   the resulting matrix
 */
-static inline void mat2x2TransMatMultAdd(const TacsScalar A[],
-                                         const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat2x2TransMatMultAdd(const TacsScalar A[],
+                                                          const TacsScalar B[],
+                                                          TacsScalar C[]) {
   C[0] += A[0] * B[0] + A[2] * B[2];
   C[2] += A[1] * B[0] + A[3] * B[2];
 
@@ -1422,8 +1467,9 @@ static inline void mat2x2TransMatMultAdd(const TacsScalar A[],
   output:
   C:   the resulting matrix
 */
-static inline void mat3x3MatTransMultAdd(const TacsScalar A[],
-                                         const TacsScalar B[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void mat3x3MatTransMultAdd(const TacsScalar A[],
+                                                          const TacsScalar B[],
+                                                          TacsScalar C[]) {
   C[0] += A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
   C[3] += A[3] * B[0] + A[4] * B[1] + A[5] * B[2];
   C[6] += A[6] * B[0] + A[7] * B[1] + A[8] * B[2];
@@ -1451,8 +1497,9 @@ static inline void mat3x3MatTransMultAdd(const TacsScalar A[],
   output:
   C:   a 3x4 matrix in row-major order
 */
-static inline void matMat3x4Mult(const TacsScalar A[], const TacsScalar B[],
-                                 TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void matMat3x4Mult(const TacsScalar A[],
+                                                  const TacsScalar B[],
+                                                  TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[1] * B[4] + A[2] * B[8];
   C[1] = A[0] * B[1] + A[1] * B[5] + A[2] * B[9];
   C[2] = A[0] * B[2] + A[1] * B[6] + A[2] * B[10];
@@ -1483,8 +1530,9 @@ static inline void matMat3x4Mult(const TacsScalar A[], const TacsScalar B[],
   output:
   C:   a 3x4 matrix in row-major order
 */
-static inline void matSymmMat3x4Mult(const TacsScalar A[], const TacsScalar B[],
-                                     TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void matSymmMat3x4Mult(const TacsScalar A[],
+                                                      const TacsScalar B[],
+                                                      TacsScalar C[]) {
   C[0] = A[0] * B[0] + A[1] * B[4] + A[2] * B[8];
   C[1] = A[0] * B[1] + A[1] * B[5] + A[2] * B[9];
   C[2] = A[0] * B[2] + A[1] * B[6] + A[2] * B[10];
@@ -1515,8 +1563,9 @@ static inline void matSymmMat3x4Mult(const TacsScalar A[], const TacsScalar B[],
   output:
   C:    the result is added to this matrix
 */
-static inline void setMatSkew(const TacsScalar a, const TacsScalar b[],
-                              TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void setMatSkew(const TacsScalar a,
+                                               const TacsScalar b[],
+                                               TacsScalar C[]) {
   C[0] = 0.0;
   C[1] = -a * b[2];
   C[2] = a * b[1];
@@ -1544,8 +1593,9 @@ static inline void setMatSkew(const TacsScalar a, const TacsScalar b[],
   output:
   C:    the result is added to this matrix
 */
-static inline void addMatSkew(const TacsScalar a, const TacsScalar b[],
-                              TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void addMatSkew(const TacsScalar a,
+                                               const TacsScalar b[],
+                                               TacsScalar C[]) {
   C[1] -= a * b[2];
   C[2] += a * b[1];
 
@@ -1568,8 +1618,10 @@ static inline void addMatSkew(const TacsScalar a, const TacsScalar b[],
   output:
   C:    the result is added to this matrix
 */
-static inline void setMatSkewSkew(const TacsScalar a, const TacsScalar b[],
-                                  const TacsScalar c[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void setMatSkewSkew(const TacsScalar a,
+                                                   const TacsScalar b[],
+                                                   const TacsScalar c[],
+                                                   TacsScalar C[]) {
   C[0] = -a * (c[1] * b[1] + c[2] * b[2]);
   C[1] = a * c[0] * b[1];
   C[2] = a * c[0] * b[2];
@@ -1595,8 +1647,10 @@ static inline void setMatSkewSkew(const TacsScalar a, const TacsScalar b[],
   output:
   C:    the result is added to this matrix
 */
-static inline void addMatSkewSkew(const TacsScalar a, const TacsScalar b[],
-                                  const TacsScalar c[], TacsScalar C[]) {
+TACS_HOST_DEVICE static inline void addMatSkewSkew(const TacsScalar a,
+                                                   const TacsScalar b[],
+                                                   const TacsScalar c[],
+                                                   TacsScalar C[]) {
   C[0] -= a * (c[1] * b[1] + c[2] * b[2]);
   C[1] += a * c[0] * b[1];
   C[2] += a * c[0] * b[2];
@@ -1623,8 +1677,9 @@ static inline void addMatSkewSkew(const TacsScalar a, const TacsScalar b[],
   in/out:
   D: the block matrix with in row-major order
 */
-static inline void addBlockMat(const TacsScalar a, const TacsScalar A[],
-                               TacsScalar D[], const int ldd) {
+TACS_HOST_DEVICE static inline void addBlockMat(const TacsScalar a,
+                                                const TacsScalar A[],
+                                                TacsScalar D[], const int ldd) {
   D[0] += a * A[0];
   D[1] += a * A[1];
   D[2] += a * A[2];
@@ -1653,8 +1708,10 @@ static inline void addBlockMat(const TacsScalar a, const TacsScalar A[],
   in/out:
   D:    the block matrix with in row-major order
 */
-static inline void addBlockMatTrans(const TacsScalar a, const TacsScalar A[],
-                                    TacsScalar D[], const int ldd) {
+TACS_HOST_DEVICE static inline void addBlockMatTrans(const TacsScalar a,
+                                                     const TacsScalar A[],
+                                                     TacsScalar D[],
+                                                     const int ldd) {
   D[0] += a * A[0];
   D[1] += a * A[3];
   D[2] += a * A[6];
@@ -1683,8 +1740,9 @@ static inline void addBlockMatTrans(const TacsScalar a, const TacsScalar A[],
   in/out:
   D:    the block matrix with in row-major order
 */
-static inline void addVecMat(const TacsScalar a, const TacsScalar A[],
-                             TacsScalar D[], const int ldd) {
+TACS_HOST_DEVICE static inline void addVecMat(const TacsScalar a,
+                                              const TacsScalar A[],
+                                              TacsScalar D[], const int ldd) {
   D[0] += a * A[0];
   D += ldd;
   D[0] += a * A[1];
@@ -1705,8 +1763,10 @@ static inline void addVecMat(const TacsScalar a, const TacsScalar A[],
   in/out:
   D: the block matrix with in row-major order
 */
-static inline void addBlockSymmMat(const TacsScalar a, const TacsScalar A[],
-                                   TacsScalar D[], const int ldd) {
+TACS_HOST_DEVICE static inline void addBlockSymmMat(const TacsScalar a,
+                                                    const TacsScalar A[],
+                                                    TacsScalar D[],
+                                                    const int ldd) {
   D[0] += a * A[0];
   D[1] += a * A[1];
   D[2] += a * A[2];
@@ -1732,8 +1792,9 @@ static inline void addBlockSymmMat(const TacsScalar a, const TacsScalar A[],
   in/out:
   D:    the block matrix in row-major order
 */
-static inline void addBlockIdent(const TacsScalar a, TacsScalar D[],
-                                 const int ldd) {
+TACS_HOST_DEVICE static inline void addBlockIdent(const TacsScalar a,
+                                                  TacsScalar D[],
+                                                  const int ldd) {
   D[0] += a;
 
   D += ldd;
@@ -1754,8 +1815,10 @@ static inline void addBlockIdent(const TacsScalar a, TacsScalar D[],
   in/out:
   D:    the block matrix in row-major order
 */
-static inline void addBlockSkew(const TacsScalar a, const TacsScalar x[],
-                                TacsScalar D[], const int ldd) {
+TACS_HOST_DEVICE static inline void addBlockSkew(const TacsScalar a,
+                                                 const TacsScalar x[],
+                                                 TacsScalar D[],
+                                                 const int ldd) {
   D[1] -= a * x[2];
   D[2] += a * x[1];
 
@@ -1782,9 +1845,11 @@ static inline void addBlockSkew(const TacsScalar a, const TacsScalar x[],
   in/out:
   D:    the block matrix in row-major order
 */
-static inline void addBlockSkewSkew(const TacsScalar a, const TacsScalar x[],
-                                    const TacsScalar y[], TacsScalar D[],
-                                    const int ldd) {
+TACS_HOST_DEVICE static inline void addBlockSkewSkew(const TacsScalar a,
+                                                     const TacsScalar x[],
+                                                     const TacsScalar y[],
+                                                     TacsScalar D[],
+                                                     const int ldd) {
   D[0] -= a * (x[1] * y[1] + x[2] * y[2]);
   D[1] += a * y[0] * x[1];
   D[2] += a * y[0] * x[2];
@@ -1808,7 +1873,7 @@ static inline void addBlockSkewSkew(const TacsScalar a, const TacsScalar x[],
 
   returns:  the determinant of A
 */
-static inline TacsScalar det3x3(const TacsScalar A[]) {
+TACS_HOST_DEVICE static inline TacsScalar det3x3(const TacsScalar A[]) {
   return (A[8] * (A[0] * A[4] - A[3] * A[1]) -
           A[7] * (A[0] * A[5] - A[3] * A[2]) +
           A[6] * (A[1] * A[5] - A[2] * A[4]));
@@ -1818,7 +1883,8 @@ static inline TacsScalar det3x3(const TacsScalar A[]) {
   Compute the derivative of the determinant with respect to the
   components of A
 */
-static inline void det3x3Sens(const TacsScalar A[], TacsScalar Ad[]) {
+TACS_HOST_DEVICE static inline void det3x3Sens(const TacsScalar A[],
+                                               TacsScalar Ad[]) {
   Ad[0] = A[8] * A[4] - A[7] * A[5];
   Ad[1] = A[6] * A[5] - A[8] * A[3];
   Ad[2] = A[7] * A[3] - A[6] * A[4];
@@ -1836,8 +1902,9 @@ static inline void det3x3Sens(const TacsScalar A[], TacsScalar Ad[]) {
   Compute the derivative of the determinant with respect to the
   components of A
 */
-static inline void addDet3x3Sens(const TacsScalar s, const TacsScalar A[],
-                                 TacsScalar Ad[]) {
+TACS_HOST_DEVICE static inline void addDet3x3Sens(const TacsScalar s,
+                                                  const TacsScalar A[],
+                                                  TacsScalar Ad[]) {
   Ad[0] += s * (A[8] * A[4] - A[7] * A[5]);
   Ad[1] += s * (A[6] * A[5] - A[8] * A[3]);
   Ad[2] += s * (A[7] * A[3] - A[6] * A[4]);
@@ -1855,8 +1922,9 @@ static inline void addDet3x3Sens(const TacsScalar s, const TacsScalar A[],
   Compute the derivative of the determinant with respect to the
   components of A
 */
-static inline void det3x32ndSens(const TacsScalar s, const TacsScalar A[],
-                                 TacsScalar Ad[]) {
+TACS_HOST_DEVICE static inline void det3x32ndSens(const TacsScalar s,
+                                                  const TacsScalar A[],
+                                                  TacsScalar Ad[]) {
   // Ad[0] = s*(A[8]*A[4] - A[7]*A[5]);
   Ad[0] = 0.0;
   Ad[1] = 0.0;
@@ -1977,7 +2045,8 @@ static inline void det3x32ndSens(const TacsScalar s, const TacsScalar A[],
 
   returns:    the determinant of A
 */
-static inline TacsScalar inv3x3(const TacsScalar A[], TacsScalar Ainv[]) {
+TACS_HOST_DEVICE static inline TacsScalar inv3x3(const TacsScalar A[],
+                                                 TacsScalar Ainv[]) {
   TacsScalar det =
       (A[8] * (A[0] * A[4] - A[3] * A[1]) - A[7] * (A[0] * A[5] - A[3] * A[2]) +
        A[6] * (A[1] * A[5] - A[2] * A[4]));
@@ -2008,8 +2077,9 @@ static inline TacsScalar inv3x3(const TacsScalar A[], TacsScalar Ainv[]) {
   output:
   Ainvd:      derivative of the inverse of the 3x3 matrix
 */
-static inline void inv3x3Sens(const TacsScalar Ainv[], const TacsScalar Ainvd[],
-                              TacsScalar Ad[]) {
+TACS_HOST_DEVICE static inline void inv3x3Sens(const TacsScalar Ainv[],
+                                               const TacsScalar Ainvd[],
+                                               TacsScalar Ad[]) {
   // d(Ainv_{kl})/d(A_{ij})
   //  = -Ainv_{kn}*delta_{ni}*delta{mj}*Ainv_{ml}
   //  = -Ainv_{ki}*Ainv_{jl}
@@ -2045,9 +2115,11 @@ static inline void inv3x3Sens(const TacsScalar Ainv[], const TacsScalar Ainvd[],
   sh: the sensitivity of the determinant of the matrix
   returns the determinant of A
 */
-static inline TacsScalar inv3x3Sens(const TacsScalar A[], const TacsScalar sA[],
-                                    TacsScalar Ainv[], TacsScalar sAinv[],
-                                    TacsScalar *_sh) {
+TACS_HOST_DEVICE static inline TacsScalar inv3x3Sens(const TacsScalar A[],
+                                                     const TacsScalar sA[],
+                                                     TacsScalar Ainv[],
+                                                     TacsScalar sAinv[],
+                                                     TacsScalar *_sh) {
   TacsScalar h =
       (A[8] * (A[0] * A[4] - A[3] * A[1]) - A[7] * (A[0] * A[5] - A[3] * A[2]) +
        A[6] * (A[1] * A[5] - A[2] * A[4]));
@@ -2110,7 +2182,7 @@ static inline TacsScalar inv3x3Sens(const TacsScalar A[], const TacsScalar sA[],
 
   returns:  the determinant of A
 */
-static inline TacsScalar det2x2(const TacsScalar A[]) {
+TACS_HOST_DEVICE static inline TacsScalar det2x2(const TacsScalar A[]) {
   return (A[0] * A[3] - A[1] * A[2]);
 }
 
@@ -2118,7 +2190,8 @@ static inline TacsScalar det2x2(const TacsScalar A[]) {
   Compute the derivative of the determinant with respect to the
   components of A
 */
-static inline void det2x2Sens(const TacsScalar A[], TacsScalar Ad[]) {
+TACS_HOST_DEVICE static inline void det2x2Sens(const TacsScalar A[],
+                                               TacsScalar Ad[]) {
   Ad[0] = A[3];
   Ad[1] = -A[2];
   Ad[2] = -A[1];
@@ -2136,7 +2209,8 @@ static inline void det2x2Sens(const TacsScalar A[], TacsScalar Ad[]) {
 
   returns:    the determinant of A
 */
-static inline TacsScalar inv2x2(const TacsScalar A[], TacsScalar Ainv[]) {
+TACS_HOST_DEVICE static inline TacsScalar inv2x2(const TacsScalar A[],
+                                                 TacsScalar Ainv[]) {
   TacsScalar det = A[0] * A[3] - A[1] * A[2];
   TacsScalar detinv = 1.0 / det;
 
@@ -2159,8 +2233,9 @@ static inline TacsScalar inv2x2(const TacsScalar A[], TacsScalar Ainv[]) {
   output:
   Ainvd:      derivative of the inverse of the 3x3 matrix
 */
-static inline void inv2x2Sens(const TacsScalar Ainv[], const TacsScalar Ainvd[],
-                              TacsScalar Ad[]) {
+TACS_HOST_DEVICE static inline void inv2x2Sens(const TacsScalar Ainv[],
+                                               const TacsScalar Ainvd[],
+                                               TacsScalar Ad[]) {
   // d(Ainv_{kl})/d(A_{ij})
   //  = -Ainv_{kn}*delta_{ni}*delta{mj}*Ainv_{ml}
   //  = -Ainv_{ki}*Ainv_{jl}
@@ -0,0 +1,549 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_ELEMENT_ALGEBRA_BATCH_H
+#define TACS_ELEMENT_ALGEBRA_BATCH_H
+
+/*
+  Small-matrix operations on a batch of points at a time.
+
+  These are the batched counterparts of the 3x3 operations in
+  TACSElementAlgebra.h, which remain the scalar API. The batched
+  operations store the matrices in structure-of-arrays form: entry k
+  of the row-major matrix at point p is stored at A[k*n + p], where n
+  is the number of points in the batch. Each operation is a single
+  loop over the points with unit-stride access, so that the compiler
+  can vectorize it for real scalars. The same code is used for complex
+  scalars, where the loop runs without vectorization.
+
+  The pack and unpack functions convert between the usual layout, with
+  the matrices for each point stored one after the other at a fixed
+  stride, and the batched layout.
+*/
+
+#include "TACSElementAlgebra.h"
+
+/*
+  Mark a loop over the points in a batch as free of dependencies
+  between iterations
+*/
+#if defined(_OPENMP)
+#define TACS_BATCH_LOOP _Pragma("omp simd")
+#elif defined(__clang__)
+#define TACS_BATCH_LOOP _Pragma("clang loop vectorize(enable)")
+#elif defined(__GNUC__)
+#define TACS_BATCH_LOOP _Pragma("GCC ivdep")
+#else
+#define TACS_BATCH_LOOP
+#endif
+
+/*
+  Copy size entries per point from a strided array to the batched
+  layout
+
+  input:
+  n:       the number of points
+  size:    the number of entries per point
+  in:      the input array
+  stride:  the stride between points in the input array
+
+  output:
+  out:     the batched array
+*/
+static inline void batchPack(const int n, const int size,
+                             const TacsScalar in[], const int stride,
+                             TacsScalar out[]) {
+  for (int p = 0; p < n; p++, in += stride) {
+    for (int k = 0; k < size; k++) {
+      out[k * n + p] = in[k];
+    }
+  }
+}
+
+/*
+  Copy size entries per point from the batched layout to a strided
+  array
+
+  input:
+  n:       the number of points
+  size:    the number of entries per point
+  in:      the batched array
+  stride:  the stride between points in the output array
+
+  output:
+  out:     the output array
+*/
+static inline void batchUnpack(const int n, const int size,
+                               const TacsScalar in[], const int stride,
+                               TacsScalar out[]) {
+  for (int p = 0; p < n; p++, out += stride) {
+    for (int k = 0; k < size; k++) {
+      out[k] = in[k * n + p];
+    }
+  }
+}
+
+/*
+  Compute y <- A*x at each point
+
+  input:
+  n:   the number of points
+  A:   the batched 3x3 matrices
+  x:   the batched 3-vectors
+
+  output:
+  y:   the batched resulting vectors
+*/
+static inline void mat3x3MultBatch(const int n, const TacsScalar *A,
+                                   const TacsScalar *x, TacsScalar *y) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    const TacsScalar x0 = x[p], x1 = x[n + p], x2 = x[2 * n + p];
+    y[p] = A[p] * x0 + A[n + p] * x1 + A[2 * n + p] * x2;
+    y[n + p] = A[3 * n + p] * x0 + A[4 * n + p] * x1 + A[5 * n + p] * x2;
+    y[2 * n + p] = A[6 * n + p] * x0 + A[7 * n + p] * x1 + A[8 * n + p] * x2;
+  }
+}
+
+/*
+  Compute y <- A^{T}*x at each point
+
+  input:
+  n:   the number of points
+  A:   the batched 3x3 matrices
+  x:   the batched 3-vectors
+
+  output:
+  y:   the batched resulting vectors
+*/
+static inline void mat3x3MultTransBatch(const int n, const TacsScalar *A,
+                                        const TacsScalar *x, TacsScalar *y) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    const TacsScalar x0 = x[p], x1 = x[n + p], x2 = x[2 * n + p];
+    y[p] = A[p] * x0 + A[3 * n + p] * x1 + A[6 * n + p] * x2;
+    y[n + p] = A[n + p] * x0 + A[4 * n + p] * x1 + A[7 * n + p] * x2;
+    y[2 * n + p] = A[2 * n + p] * x0 + A[5 * n + p] * x1 + A[8 * n + p] * x2;
+  }
+}
+
+/*
+  Compute C = A*B, or C += A*B when add is true, at each point. The
+  output must not overlap the inputs.
+*/
+template <bool add>
+static inline void mat3x3MatMultBatchImpl(const int n, const TacsScalar *A,
+                                          const TacsScalar *B,
+                                          TacsScalar *C) {
+  for (int i = 0; i < 3; i++) {
+    const TacsScalar *Ai = &A[3 * i * n];
+    TacsScalar *Ci = &C[3 * i * n];
+    TACS_BATCH_LOOP
+    for (int p = 0; p < n; p++) {
+      const TacsScalar a0 = Ai[p], a1 = Ai[n + p], a2 = Ai[2 * n + p];
+      const TacsScalar c0 = a0 * B[p] + a1 * B[3 * n + p] + a2 * B[6 * n + p];
+      const TacsScalar c1 =
+          a0 * B[n + p] + a1 * B[4 * n + p] + a2 * B[7 * n + p];
+      const TacsScalar c2 =
+          a0 * B[2 * n + p] + a1 * B[5 * n + p] + a2 * B[8 * n + p];
+      if (add) {
+        Ci[p] += c0;
+        Ci[n + p] += c1;
+        Ci[2 * n + p] += c2;
+      } else {
+        Ci[p] = c0;
+        Ci[n + p] = c1;
+        Ci[2 * n + p] = c2;
+      }
+    }
+  }
+}
+
+/*
+  Compute C = A*B at each point
+
+  input:
+  n:   the number of points
+  A:   the first batched 3x3 matrices
+  B:   the second batched 3x3 matrices
+
+  output:
+  C:   the batched resulting matrices
+*/
+static inline void mat3x3MatMultBatch(const int n, const TacsScalar *A,
+                                      const TacsScalar *B, TacsScalar *C) {
+  mat3x3MatMultBatchImpl<false>(n, A, B, C);
+}
+
+/*
+  Compute C += A*B at each point
+
+  input:
+  n:   the number of points
+  A:   the first batched 3x3 matrices
+  B:   the second batched 3x3 matrices
+
+  output:
+  C:   the batched resulting matrices
+*/
+static inline void mat3x3MatMultAddBatch(const int n, const TacsScalar *A,
+                                         const TacsScalar *B, TacsScalar *C) {
+  mat3x3MatMultBatchImpl<true>(n, A, B, C);
+}
+
+/*
+  Compute C = A^{T}*B, or C += A^{T}*B when add is true, at each
+  point. The output must not overlap the inputs.
+*/
+template <bool add>
+static inline void mat3x3TransMatMultBatchImpl(const int n,
+                                               const TacsScalar *A,
+                                               const TacsScalar *B,
+                                               TacsScalar *C) {
+  for (int i = 0; i < 3; i++) {
+    const TacsScalar *Ai = &A[i * n];
+    TacsScalar *Ci = &C[3 * i * n];
+    TACS_BATCH_LOOP
+    for (int p = 0; p < n; p++) {
+      const TacsScalar a0 = Ai[p], a1 = Ai[3 * n + p], a2 = Ai[6 * n + p];
+      const TacsScalar c0 = a0 * B[p] + a1 * B[3 * n + p] + a2 * B[6 * n + p];
+      const TacsScalar c1 =
+          a0 * B[n + p] + a1 * B[4 * n + p] + a2 * B[7 * n + p];
+      const TacsScalar c2 =
+          a0 * B[2 * n + p] + a1 * B[5 * n + p] + a2 * B[8 * n + p];
+      if (add) {
+        Ci[p] += c0;
+        Ci[n + p] += c1;
+        Ci[2 * n + p] += c2;
+      } else {
+        Ci[p] = c0;
+        Ci[n + p] = c1;
+        Ci[2 * n + p] = c2;
+      }
+    }
+  }
+}
+
+/*
+  Compute C = A^{T}*B at each point
+
+  input:
+  n:   the number of points
+  A:   the first batched 3x3 matrices
+  B:   the second batched 3x3 matrices
+
+  output:
+  C:   the batched resulting matrices
+*/
+static inline void mat3x3TransMatMultBatch(const int n, const TacsScalar *A,
+                                           const TacsScalar *B,
+                                           TacsScalar *C) {
+  mat3x3TransMatMultBatchImpl<false>(n, A, B, C);
+}
+
+/*
+  Compute C += A^{T}*B at each point
+
+  input:
+  n:   the number of points
+  A:   the first batched 3x3 matrices
+  B:   the second batched 3x3 matrices
+
+  output:
+  C:   the batched resulting matrices
+*/
+static inline void mat3x3TransMatMultAddBatch(const int n, const TacsScalar *A,
+                                              const TacsScalar *B,
+                                              TacsScalar *C) {
+  mat3x3TransMatMultBatchImpl<true>(n, A, B, C);
+}
+
+/*
+  Compute C = A*B^{T}, or C += A*B^{T} when add is true, at each
+  point. The output must not overlap the inputs.
+*/
+template <bool add>
+static inline void mat3x3MatTransMultBatchImpl(const int n,
+                                               const TacsScalar *A,
+                                               const TacsScalar *B,
+                                               TacsScalar *C) {
+  for (int i = 0; i < 3; i++) {
+    const TacsScalar *Ai = &A[3 * i * n];
+    TacsScalar *Ci = &C[3 * i * n];
+    TACS_BATCH_LOOP
+    for (int p = 0; p < n; p++) {
+      const TacsScalar a0 = Ai[p], a1 = Ai[n + p], a2 = Ai[2 * n + p];
+      const TacsScalar c0 = a0 * B[p] + a1 * B[n + p] + a2 * B[2 * n + p];
+      const TacsScalar c1 =
+          a0 * B[3 * n + p] + a1 * B[4 * n + p] + a2 * B[5 * n + p];
+      const TacsScalar c2 =
+          a0 * B[6 * n + p] + a1 * B[7 * n + p] + a2 * B[8 * n + p];
+      if (add) {
+        Ci[p] += c0;
+        Ci[n + p] += c1;
+        Ci[2 * n + p] += c2;
+      } else {
+        Ci[p] = c0;
+        Ci[n + p] = c1;
+        Ci[2 * n + p] = c2;
+      }
+    }
+  }
+}
+
+/*
+  Compute C = A*B^{T} at each point
+
+  input:
+  n:   the number of points
+  A:   the first batched 3x3 matrices
+  B:   the second batched 3x3 matrices
+
+  output:
+  C:   the batched resulting matrices
+*/
+static inline void mat3x3MatTransMultBatch(const int n, const TacsScalar *A,
+                                           const TacsScalar *B,
+                                           TacsScalar *C) {
+  mat3x3MatTransMultBatchImpl<false>(n, A, B, C);
+}
+
+/*
+  Compute C += A*B^{T} at each point
+
+  input:
+  n:   the number of points
+  A:   the first batched 3x3 matrices
+  B:   the second batched 3x3 matrices
+
+  output:
+  C:   the batched resulting matrices
+*/
+static inline void mat3x3MatTransMultAddBatch(const int n, const TacsScalar *A,
+                                              const TacsScalar *B,
+                                              TacsScalar *C) {
+  mat3x3MatTransMultBatchImpl<true>(n, A, B, C);
+}
+
+/*
+  Compute the determinant of the 3x3 matrix at each point
+
+  input:
+  n:     the number of points
+  A:     the batched 3x3 matrices
+
+  output:
+  det:   the determinant at each point
+*/
+static inline void det3x3Batch(const int n, const TacsScalar *A,
+                               TacsScalar *det) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    const TacsScalar a0 = A[p], a1 = A[n + p], a2 = A[2 * n + p];
+    const TacsScalar a3 = A[3 * n + p], a4 = A[4 * n + p], a5 = A[5 * n + p];
+    const TacsScalar a6 = A[6 * n + p], a7 = A[7 * n + p], a8 = A[8 * n + p];
+    det[p] = (a8 * (a0 * a4 - a3 * a1) - a7 * (a0 * a5 - a3 * a2) +
+              a6 * (a1 * a5 - a2 * a4));
+  }
+}
+
+/*
+  Compute the inverse of the 3x3 matrix at each point
+
+  input:
+  n:      the number of points
+  A:      the batched 3x3 matrices
+
+  output:
+  Ainv:   the batched inverse matrices
+  det:    the determinant at each point (may be NULL)
+*/
+static inline void inv3x3Batch(const int n, const TacsScalar *A,
+                               TacsScalar *Ainv, TacsScalar *det) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    const TacsScalar a0 = A[p], a1 = A[n + p], a2 = A[2 * n + p];
+    const TacsScalar a3 = A[3 * n + p], a4 = A[4 * n + p], a5 = A[5 * n + p];
+    const TacsScalar a6 = A[6 * n + p], a7 = A[7 * n + p], a8 = A[8 * n + p];
+    const TacsScalar d = (a8 * (a0 * a4 - a3 * a1) - a7 * (a0 * a5 - a3 * a2) +
+                          a6 * (a1 * a5 - a2 * a4));
+    const TacsScalar dinv = 1.0 / d;
+
+    Ainv[p] = (a4 * a8 - a5 * a7) * dinv;
+    Ainv[n + p] = -(a1 * a8 - a2 * a7) * dinv;
+    Ainv[2 * n + p] = (a1 * a5 - a2 * a4) * dinv;
+
+    Ainv[3 * n + p] = -(a3 * a8 - a5 * a6) * dinv;
+    Ainv[4 * n + p] = (a0 * a8 - a2 * a6) * dinv;
+    Ainv[5 * n + p] = -(a0 * a5 - a2 * a3) * dinv;
+
+    Ainv[6 * n + p] = (a3 * a7 - a4 * a6) * dinv;
+    Ainv[7 * n + p] = -(a0 * a7 - a1 * a6) * dinv;
+    Ainv[8 * n + p] = (a0 * a4 - a1 * a3) * dinv;
+
+    if (det) {
+      det[p] = d;
+    }
+  }
+}
+
+/*
+  Compute the transformation A = T^{T}*S*T at each point
+
+  input:
+  n:   the number of points
+  T:   the batched 3x3 transformations
+  S:   the batched 3x3 flattened symmetric matrices
+
+  output:
+  A:   the batched 3x3 flattened symmetric matrices
+*/
+static inline void mat3x3SymmTransformTransposeBatch(const int n,
+                                                     const TacsScalar *T,
+                                                     const TacsScalar *S,
+                                                     TacsScalar *A) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    TacsScalar t[9], s[6], w[9];
+    for (int k = 0; k < 9; k++) {
+      t[k] = T[k * n + p];
+    }
+    for (int k = 0; k < 6; k++) {
+      s[k] = S[k * n + p];
+    }
+
+    // Compute W = S*T
+    w[0] = s[0] * t[0] + s[1] * t[3] + s[2] * t[6];
+    w[1] = s[0] * t[1] + s[1] * t[4] + s[2] * t[7];
+    w[2] = s[0] * t[2] + s[1] * t[5] + s[2] * t[8];
+
+    w[3] = s[1] * t[0] + s[3] * t[3] + s[4] * t[6];
+    w[4] = s[1] * t[1] + s[3] * t[4] + s[4] * t[7];
+    w[5] = s[1] * t[2] + s[3] * t[5] + s[4] * t[8];
+
+    w[6] = s[2] * t[0] + s[4] * t[3] + s[5] * t[6];
+    w[7] = s[2] * t[1] + s[4] * t[4] + s[5] * t[7];
+    w[8] = s[2] * t[2] + s[4] * t[5] + s[5] * t[8];
+
+    // Compute the symmetric part of T^{T}*W
+    A[p] = t[0] * w[0] + t[3] * w[3] + t[6] * w[6];
+    A[n + p] = t[0] * w[1] + t[3] * w[4] + t[6] * w[7];
+    A[2 * n + p] = t[0] * w[2] + t[3] * w[5] + t[6] * w[8];
+
+    A[3 * n + p] = t[1] * w[1] + t[4] * w[4] + t[7] * w[7];
+    A[4 * n + p] = t[1] * w[2] + t[4] * w[5] + t[7] * w[8];
+
+    A[5 * n + p] = t[2] * w[2] + t[5] * w[5] + t[8] * w[8];
+  }
+}
+
+/*
+  Compute the derivative of the transformation A = T^{T}*S*T at each
+  point
+
+  input:
+  n:   the number of points
+  T:   the batched 3x3 transformations
+  dA:  the derivative w.r.t. the batched flattened symmetric matrices
+
+  output:
+  dS:  the derivative w.r.t. the batched flattened symmetric matrices
+*/
+static inline void mat3x3SymmTransformTransSensBatch(const int n,
+                                                     const TacsScalar *T,
+                                                     const TacsScalar *dA,
+                                                     TacsScalar *dS) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    TacsScalar t[9], da[6], dw[9];
+    for (int k = 0; k < 9; k++) {
+      t[k] = T[k * n + p];
+    }
+    for (int k = 0; k < 6; k++) {
+      da[k] = dA[k * n + p];
+    }
+
+    dw[0] = t[0] * da[0];
+    dw[1] = t[0] * da[1] + t[1] * da[3];
+    dw[2] = t[0] * da[2] + t[1] * da[4] + t[2] * da[5];
+
+    dw[3] = t[3] * da[0];
+    dw[4] = t[3] * da[1] + t[4] * da[3];
+    dw[5] = t[3] * da[2] + t[4] * da[4] + t[5] * da[5];
+
+    dw[6] = t[6] * da[0];
+    dw[7] = t[6] * da[1] + t[7] * da[3];
+    dw[8] = t[6] * da[2] + t[7] * da[4] + t[8] * da[5];
+
+    dS[p] = (t[0] * dw[0] + t[1] * dw[1] + t[2] * dw[2]);
+    dS[n + p] = (t[3] * dw[0] + t[4] * dw[1] + t[5] * dw[2] + t[0] * dw[3] +
+                 t[1] * dw[4] + t[2] * dw[5]);
+    dS[2 * n + p] = (t[6] * dw[0] + t[7] * dw[1] + t[8] * dw[2] +
+                     t[0] * dw[6] + t[1] * dw[7] + t[2] * dw[8]);
+
+    dS[3 * n + p] = (t[3] * dw[3] + t[4] * dw[4] + t[5] * dw[5]);
+    dS[4 * n + p] = (t[6] * dw[3] + t[7] * dw[4] + t[8] * dw[5] +
+                     t[3] * dw[6] + t[4] * dw[7] + t[5] * dw[8]);
+
+    dS[5 * n + p] = (t[6] * dw[6] + t[7] * dw[7] + t[8] * dw[8]);
+  }
+}
+
+/*
+  Compute the cross product out = x cross y at each point
+
+  input:
+  n:     the number of points
+  x:     the first batched 3-vectors
+  y:     the second batched 3-vectors
+
+  output:
+  out:   the batched resulting vectors
+*/
+static inline void crossProductBatch(const int n, const TacsScalar *x,
+                                     const TacsScalar *y, TacsScalar *out) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    const TacsScalar x0 = x[p], x1 = x[n + p], x2 = x[2 * n + p];
+    const TacsScalar y0 = y[p], y1 = y[n + p], y2 = y[2 * n + p];
+    out[p] = x1 * y2 - x2 * y1;
+    out[n + p] = x2 * y0 - x0 * y2;
+    out[2 * n + p] = x0 * y1 - x1 * y0;
+  }
+}
+
+/*
+  Compute the dot product of two 3-vectors at each point
+
+  input:
+  n:     the number of points
+  x:     the first batched 3-vectors
+  y:     the second batched 3-vectors
+
+  output:
+  dot:   the dot product at each point
+*/
+static inline void vec3DotBatch(const int n, const TacsScalar *x,
+                                const TacsScalar *y, TacsScalar *dot) {
+  TACS_BATCH_LOOP
+  for (int p = 0; p < n; p++) {
+    dot[p] = x[p] * y[p] + x[n + p] * y[n + p] + x[2 * n + p] * y[2 * n + p];
+  }
+}
+
+#endif  // TACS_ELEMENT_ALGEBRA_BATCH_H
@@ -0,0 +1,124 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+
+#include "TACSElementRegistry.h"
+
+#include <string.h>
+
+TACSElementRegistry::TACSElementRegistry() {
+  num_kernels = 0;
+  max_num_kernels = 0;
+  kernels = NULL;
+}
+
+TACSElementRegistry::~TACSElementRegistry() {
+  for (int i = 0; i < num_kernels; i++) {
+    if (kernels[i].name) {
+      delete[] kernels[i].name;
+    }
+  }
+  if (kernels) {
+    delete[] kernels;
+  }
+}
+
+const char *TACSElementRegistry::getObjectName() {
+  return "TACSElementRegistry";
+}
+
+/*
+  Add the kernels for an element type
+
+  If the type is already registered, its kernels are replaced.
+
+  input:
+  type:      the type info of the element class
+  name:      the name used to identify the kernel (may be NULL)
+  residual:  the residual batch kernel
+  jacobian:  the residual and Jacobian batch kernel
+
+  returns:   the index of the kernel
+*/
+int TACSElementRegistry::addKernel(const std::type_info &type,
+                                   const char *name,
+                                   TACSResidualBatchKernel residual,
+                                   TACSJacobianBatchKernel jacobian) {
+  // Check if the type is already registered
+  int index = 0;
+  for (; index < num_kernels; index++) {
+    if (*kernels[index].type == type) {
+      break;
+    }
+  }
+
+  if (index == num_kernels) {
+    if (num_kernels >= max_num_kernels) {
+      max_num_kernels = 2 * max_num_kernels + 8;
+      ElementKernel *temp = new ElementKernel[max_num_kernels];
+      if (kernels) {
+        memcpy(temp, kernels, num_kernels * sizeof(ElementKernel));
+        delete[] kernels;
+      }
+      kernels = temp;
+    }
+    kernels[index].name = NULL;
+    num_kernels++;
+  }
+
+  if (kernels[index].name) {
+    delete[] kernels[index].name;
+  }
+  if (!name) {
+    name = type.name();
+  }
+  kernels[index].type = &type;
+  kernels[index].name = new char[strlen(name) + 1];
+  strcpy(kernels[index].name, name);
+  kernels[index].residual = residual;
+  kernels[index].jacobian = jacobian;
+
+  return index;
+}
+
+/*
+  Get the name of a registered kernel
+*/
+const char *TACSElementRegistry::getKernelName(int kernel) {
+  if (kernel >= 0 && kernel < num_kernels) {
+    return kernels[kernel].name;
+  }
+  return NULL;
+}
+
+/*
+  Find the kernel registered for the exact type of the element object
+
+  returns:   the index of the kernel or -1 if the type is not registered
+*/
+int TACSElementRegistry::findKernel(TACSElement *element) {
+  if (element) {
+    const std::type_info &type = typeid(*element);
+    for (int i = 0; i < num_kernels; i++) {
+      if (*kernels[i].type == type) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
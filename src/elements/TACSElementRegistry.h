@@ -0,0 +1,176 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+
+#ifndef TACS_ELEMENT_REGISTRY_H
+#define TACS_ELEMENT_REGISTRY_H
+
+#include <typeinfo>
+
+#include "TACSElement.h"
+
+/*
+  Function pointer types for the specialized batch kernels
+
+  The elements in the batch are elements[elemIndex[i]] for i = 0 to
+  numElems-1. The data is stored in the same layout as in
+  TACSElement::addResidualBatch() and TACSElement::addJacobianBatch().
+*/
+typedef void (*TACSResidualBatchKernel)(TACSElement *const elements[],
+                                        int numElems, const int elemIndex[],
+                                        double time, const TacsScalar Xpts[],
+                                        const TacsScalar vars[],
+                                        const TacsScalar dvars[],
+                                        const TacsScalar ddvars[],
+                                        TacsScalar res[]);
+
+typedef void (*TACSJacobianBatchKernel)(
+    TACSElement *const elements[], int numElems, const int elemIndex[],
+    double time, TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+    const TacsScalar Xpts[], const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar res[], TacsScalar mat[]);
+
+/*
+  The residual kernel for a batch of elements of exactly the type
+  ElementType. The calls are qualified so that they are resolved at
+  compile time and the element code is inlined into the batch loop.
+*/
+template <class ElementType>
+void TacsElementResidualBatch(TACSElement *const elements[], int numElems,
+                              const int elemIndex[], double time,
+                              const TacsScalar Xpts[], const TacsScalar vars[],
+                              const TacsScalar dvars[],
+                              const TacsScalar ddvars[], TacsScalar res[]) {
+  ElementType *elem = static_cast<ElementType *>(elements[elemIndex[0]]);
+  const int nx = 3 * elem->ElementType::getNumNodes();
+  const int nvars = elem->ElementType::getNumVariables();
+  for (int i = 0; i < numElems; i++) {
+    elem = static_cast<ElementType *>(elements[elemIndex[i]]);
+    elem->ElementType::addResidual(elemIndex[i], time, &Xpts[nx * i],
+                                   &vars[nvars * i], &dvars[nvars * i],
+                                   &ddvars[nvars * i], &res[nvars * i]);
+  }
+}
+
+/*
+  The residual and Jacobian kernel for a batch of elements of exactly
+  the type ElementType
+*/
+template <class ElementType>
+void TacsElementJacobianBatch(TACSElement *const elements[], int numElems,
+                              const int elemIndex[], double time,
+                              TacsScalar alpha, TacsScalar beta,
+                              TacsScalar gamma, const TacsScalar Xpts[],
+                              const TacsScalar vars[], const TacsScalar dvars[],
+                              const TacsScalar ddvars[], TacsScalar res[],
+                              TacsScalar mat[]) {
+  ElementType *elem = static_cast<ElementType *>(elements[elemIndex[0]]);
+  const int nx = 3 * elem->ElementType::getNumNodes();
+  const int nvars = elem->ElementType::getNumVariables();
+  for (int i = 0; i < numElems; i++) {
+    elem = static_cast<ElementType *>(elements[elemIndex[i]]);
+    elem->ElementType::addJacobian(elemIndex[i], time, alpha, beta, gamma,
+                                   &Xpts[nx * i], &vars[nvars * i],
+                                   &dvars[nvars * i], &ddvars[nvars * i],
+                                   &res[nvars * i], &mat[nvars * nvars * i]);
+  }
+}
+
+/*
+  A registry of assembly kernels specialized for element types
+
+  Each registered element type has a residual and a Jacobian kernel
+  instantiated at compile time. TACSAssembler looks up the kernel for
+  every element object once. Consecutive elements whose element
+  objects have the same registered type are then evaluated together
+  with a single call, even when the element or constitutive objects
+  differ, and no virtual calls are made on the element within the
+  batch. Elements of types that are not registered fall back to
+  TACSElement::addResidualBatch() and
+  TACSElement::addJacobianBatch().
+
+  An element object only matches a kernel when its type is exactly the
+  registered type, not a class derived from it. The number of nodes
+  and variables of a registered type must be fixed by the type, as is
+  the case for the shell elements, so that the elements in a batch
+  share the same data layout.
+
+  TACSElementRegistry *registry = new TACSElementRegistry();
+  registry->registerElement<TACSQuad4Shell>("TACSQuad4Shell");
+  assembler->setElementRegistry(registry);
+*/
+class TACSElementRegistry : public TACSObject {
+ public:
+  TACSElementRegistry();
+  ~TACSElementRegistry();
+
+  // Register the kernels for an element type
+  template <class ElementType>
+  int registerElement(const char *name = NULL) {
+    return addKernel(typeid(ElementType), name,
+                     TacsElementResidualBatch<ElementType>,
+                     TacsElementJacobianBatch<ElementType>);
+  }
+
+  // Add the kernels for the element type with the given type info
+  int addKernel(const std::type_info &type, const char *name,
+                TACSResidualBatchKernel residual,
+                TACSJacobianBatchKernel jacobian);
+
+  // Get information about the registered kernels
+  int getNumKernels() { return num_kernels; }
+  const char *getKernelName(int kernel);
+
+  // Find the kernel for an element object, or -1 if none is registered
+  int findKernel(TACSElement *element);
+
+  // Evaluate a batch of elements with a kernel
+  // ------------------------------------------
+  void addResidualBatch(int kernel, TACSElement *const elements[],
+                        int numElems, const int elemIndex[], double time,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar res[]) {
+    kernels[kernel].residual(elements, numElems, elemIndex, time, Xpts, vars,
+                             dvars, ddvars, res);
+  }
+  void addJacobianBatch(int kernel, TACSElement *const elements[],
+                        int numElems, const int elemIndex[], double time,
+                        TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar res[], TacsScalar mat[]) {
+    kernels[kernel].jacobian(elements, numElems, elemIndex, time, alpha, beta,
+                             gamma, Xpts, vars, dvars, ddvars, res, mat);
+  }
+
+  const char *getObjectName();
+
+ private:
+  struct ElementKernel {
+    const std::type_info *type;
+    char *name;
+    TACSResidualBatchKernel residual;
+    TACSJacobianBatchKernel jacobian;
+  };
+
+  int num_kernels, max_num_kernels;
+  ElementKernel *kernels;
+};
+
+#endif  // TACS_ELEMENT_REGISTRY_H
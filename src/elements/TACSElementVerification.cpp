@@ -17,6 +17,7 @@
 #include <string.h>
 
 #include "TACSElementAlgebra.h"
+#include "TACSElementAlgebraBatch.h"
 #include "tacslapack.h"
 
 /*
@@ -2242,3 +2243,244 @@ int TacsTestElementModel(TACSElementModel *model, int elemIndex,
 
   return fail;
 }
+
+/*
+  Compare the output of a batched operation against the scalar
+  operation. Both the real and imaginary parts are compared in the
+  complex case.
+*/
+static int TacsCheckAlgebraBatch(const char *descript, int size,
+                                 const TacsScalar *test, const TacsScalar *ref,
+                                 int test_print_level, double test_fail_atol,
+                                 double test_fail_rtol) {
+  double max_err = 0.0;
+  int fail = 0;
+  for (int i = 0; i < size; i++) {
+#ifdef TACS_USE_COMPLEX
+    double err = std::abs(test[i] - ref[i]);
+    double tol = test_fail_atol + test_fail_rtol * std::abs(ref[i]);
+#else
+    double err = fabs(test[i] - ref[i]);
+    double tol = test_fail_atol + test_fail_rtol * fabs(ref[i]);
+#endif
+    if (err > max_err) {
+      max_err = err;
+    }
+    if (err > tol) {
+      fail = 1;
+    }
+  }
+
+  if (test_print_level > 0) {
+    fprintf(stderr, "%-36s Max Err: %10.4e %s\n", descript, max_err,
+            fail ? "FAILED" : "");
+  }
+
+  return fail;
+}
+
+/*
+  Test the batched small-matrix operations against the scalar
+  operations with random data
+*/
+int TacsTestElementAlgebraBatch(int npts, int test_print_level,
+                                double test_fail_atol, double test_fail_rtol) {
+  const int n = npts;
+  int fail = 0;
+
+  // The random input data for each point, one point after another
+  TacsScalar *A = new TacsScalar[9 * n];
+  TacsScalar *B = new TacsScalar[9 * n];
+  TacsScalar *C = new TacsScalar[9 * n];
+  TacsScalar *S = new TacsScalar[6 * n];
+  TacsScalar *x = new TacsScalar[3 * n];
+  TacsScalar *y = new TacsScalar[3 * n];
+  TacsGenerateRandomArray(A, 9 * n);
+  TacsGenerateRandomArray(B, 9 * n);
+  TacsGenerateRandomArray(C, 9 * n);
+  TacsGenerateRandomArray(S, 6 * n);
+  TacsGenerateRandomArray(x, 3 * n);
+  TacsGenerateRandomArray(y, 3 * n);
+
+  // Make A diagonally dominant so that it is safely invertible
+  for (int p = 0; p < n; p++) {
+    A[9 * p] += 4.0;
+    A[9 * p + 4] += 4.0;
+    A[9 * p + 8] += 4.0;
+  }
+
+  // The batched inputs and outputs
+  TacsScalar *Ab = new TacsScalar[9 * n];
+  TacsScalar *Bb = new TacsScalar[9 * n];
+  TacsScalar *Sb = new TacsScalar[6 * n];
+  TacsScalar *xb = new TacsScalar[3 * n];
+  TacsScalar *yb = new TacsScalar[3 * n];
+  TacsScalar *outb = new TacsScalar[9 * n];
+  batchPack(n, 9, A, 9, Ab);
+  batchPack(n, 9, B, 9, Bb);
+  batchPack(n, 6, S, 6, Sb);
+  batchPack(n, 3, x, 3, xb);
+  batchPack(n, 3, y, 3, yb);
+
+  // The reference and test outputs for each point
+  TacsScalar *ref = new TacsScalar[9 * n];
+  TacsScalar *out = new TacsScalar[9 * n];
+
+  if (test_print_level > 0) {
+    fprintf(stderr, "Testing the batched operations with %d points\n", n);
+  }
+
+  // y = A*x and y = A^{T}*x
+  for (int p = 0; p < n; p++) {
+    mat3x3Mult(&A[9 * p], &x[3 * p], &ref[3 * p]);
+  }
+  mat3x3MultBatch(n, Ab, xb, outb);
+  batchUnpack(n, 3, outb, 3, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3MultBatch", 3 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    mat3x3MultTrans(&A[9 * p], &x[3 * p], &ref[3 * p]);
+  }
+  mat3x3MultTransBatch(n, Ab, xb, outb);
+  batchUnpack(n, 3, outb, 3, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3MultTransBatch", 3 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  // The matrix-matrix products, with and without accumulation
+  for (int p = 0; p < n; p++) {
+    mat3x3MatMult(&A[9 * p], &B[9 * p], &ref[9 * p]);
+  }
+  mat3x3MatMultBatch(n, Ab, Bb, outb);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3MatMultBatch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    memcpy(&ref[9 * p], &C[9 * p], 9 * sizeof(TacsScalar));
+    mat3x3MatMultAdd(&A[9 * p], &B[9 * p], &ref[9 * p]);
+  }
+  batchPack(n, 9, C, 9, outb);
+  mat3x3MatMultAddBatch(n, Ab, Bb, outb);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3MatMultAddBatch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    mat3x3TransMatMult(&A[9 * p], &B[9 * p], &ref[9 * p]);
+  }
+  mat3x3TransMatMultBatch(n, Ab, Bb, outb);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3TransMatMultBatch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    memcpy(&ref[9 * p], &C[9 * p], 9 * sizeof(TacsScalar));
+    mat3x3TransMatMultAdd(&A[9 * p], &B[9 * p], &ref[9 * p]);
+  }
+  batchPack(n, 9, C, 9, outb);
+  mat3x3TransMatMultAddBatch(n, Ab, Bb, outb);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3TransMatMultAddBatch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    mat3x3MatTransMult(&A[9 * p], &B[9 * p], &ref[9 * p]);
+  }
+  mat3x3MatTransMultBatch(n, Ab, Bb, outb);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3MatTransMultBatch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    memcpy(&ref[9 * p], &C[9 * p], 9 * sizeof(TacsScalar));
+    mat3x3MatTransMultAdd(&A[9 * p], &B[9 * p], &ref[9 * p]);
+  }
+  batchPack(n, 9, C, 9, outb);
+  mat3x3MatTransMultAddBatch(n, Ab, Bb, outb);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3MatTransMultAddBatch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  // The determinant and the inverse
+  for (int p = 0; p < n; p++) {
+    ref[p] = det3x3(&A[9 * p]);
+  }
+  det3x3Batch(n, Ab, out);
+  fail |= TacsCheckAlgebraBatch("det3x3Batch", n, out, ref, test_print_level,
+                                test_fail_atol, test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    inv3x3(&A[9 * p], &ref[9 * p]);
+  }
+  inv3x3Batch(n, Ab, outb, NULL);
+  batchUnpack(n, 9, outb, 9, out);
+  fail |= TacsCheckAlgebraBatch("inv3x3Batch", 9 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  // The symmetric transformation and its derivative
+  for (int p = 0; p < n; p++) {
+    mat3x3SymmTransformTranspose(&A[9 * p], &S[6 * p], &ref[6 * p]);
+  }
+  mat3x3SymmTransformTransposeBatch(n, Ab, Sb, outb);
+  batchUnpack(n, 6, outb, 6, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3SymmTransformTransposeBatch", 6 * n,
+                                out, ref, test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    mat3x3SymmTransformTransSens(&A[9 * p], &S[6 * p], &ref[6 * p]);
+  }
+  mat3x3SymmTransformTransSensBatch(n, Ab, Sb, outb);
+  batchUnpack(n, 6, outb, 6, out);
+  fail |= TacsCheckAlgebraBatch("mat3x3SymmTransformTransSensBatch", 6 * n,
+                                out, ref, test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  // The vector operations
+  for (int p = 0; p < n; p++) {
+    crossProduct(&x[3 * p], &y[3 * p], &ref[3 * p]);
+  }
+  crossProductBatch(n, xb, yb, outb);
+  batchUnpack(n, 3, outb, 3, out);
+  fail |= TacsCheckAlgebraBatch("crossProductBatch", 3 * n, out, ref,
+                                test_print_level, test_fail_atol,
+                                test_fail_rtol);
+
+  for (int p = 0; p < n; p++) {
+    ref[p] = vec3Dot(&x[3 * p], &y[3 * p]);
+  }
+  vec3DotBatch(n, xb, yb, out);
+  fail |= TacsCheckAlgebraBatch("vec3DotBatch", n, out, ref, test_print_level,
+                                test_fail_atol, test_fail_rtol);
+
+  if (test_print_level) {
+    fprintf(stderr, "\n");
+  }
+
+  delete[] A;
+  delete[] B;
+  delete[] C;
+  delete[] S;
+  delete[] x;
+  delete[] y;
+  delete[] Ab;
+  delete[] Bb;
+  delete[] Sb;
+  delete[] xb;
+  delete[] yb;
+  delete[] outb;
+  delete[] ref;
+  delete[] out;
+
+  return fail;
+}
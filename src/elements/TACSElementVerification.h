@@ -18,6 +18,7 @@
 #include "TACSElement.h"
 #include "TACSElementBasis.h"
 #include "TACSElementModel.h"
+#include "TacsDualNumber.h"
 
 /**
   Assign variables randomly to an array. This is useful for
@@ -448,4 +449,113 @@ int TacsTestElementModel(TACSElementModel *model, int elemIndex,
                          int test_print_level = 2, double test_fail_atol = 1e-5,
                          double test_fail_rtol = 1e-5);
 
+/**
+  Test the batched small-matrix operations against the scalar
+  operations in TACSElementAlgebra.h with random data
+
+  @param npts The number of points in the batch
+  @param test_print_level The output level
+  @param test_fail_atol The test absolute tolerance
+  @param test_fail_rtol The test relative tolerance
+*/
+int TacsTestElementAlgebraBatch(int npts = 13, int test_print_level = 2,
+                                double test_fail_atol = 1e-12,
+                                double test_fail_rtol = 1e-12);
+
+/**
+  Test the derivatives of a function in N random directions with a
+  single evaluation in TacsDualNumber<N> arithmetic
+
+  The function object must provide a member function template
+
+    template <typename T>
+    void operator()(const T *in, T *out);
+
+  that computes the nout outputs from the nin inputs. The derivatives
+  from the dual evaluation are compared against a finite-difference
+  (or complex-step) approximation in each direction.
+
+  @param func The function object
+  @param nin The number of inputs
+  @param x The input values
+  @param nout The number of outputs
+  @param dh The finite-difference step size
+  @param test_print_level The output level
+  @param test_fail_atol The test absolute tolerance
+  @param test_fail_rtol The test relative tolerance
+*/
+template <int N, class Func>
+int TacsTestDualDirections(Func &func, int nin, const TacsScalar *x, int nout,
+                           double dh = 1e-7, int test_print_level = 2,
+                           double test_fail_atol = 1e-5,
+                           double test_fail_rtol = 1e-5) {
+  // Generate the random directions
+  TacsScalar *pert = new TacsScalar[N * nin];
+  TacsGenerateRandomArray(pert, N * nin);
+
+  // Evaluate all the directional derivatives in a single sweep
+  TacsDualNumber<N> *din = new TacsDualNumber<N>[nin];
+  TacsDualNumber<N> *dout = new TacsDualNumber<N>[nout];
+  for (int i = 0; i < nin; i++) {
+    din[i].value = x[i];
+    for (int k = 0; k < N; k++) {
+      din[i].deriv[k] = pert[nin * k + i];
+    }
+  }
+  func(din, dout);
+
+  TacsScalar *result = new TacsScalar[N * nout];
+  for (int j = 0; j < nout; j++) {
+    for (int k = 0; k < N; k++) {
+      result[nout * k + j] = dout[j].deriv[k];
+    }
+  }
+
+  // Compute the approximation one direction at a time
+  TacsScalar *fd = new TacsScalar[N * nout];
+  TacsScalar *xtmp = new TacsScalar[nin];
+  TacsScalar *ftmp = new TacsScalar[nout];
+  for (int k = 0; k < N; k++) {
+    TacsForwardDiffPerturb(xtmp, nin, x, &pert[nin * k], dh);
+    func(xtmp, &fd[nout * k]);
+    TacsBackwardDiffPerturb(xtmp, nin, x, &pert[nin * k], dh);
+    func(xtmp, ftmp);
+    TacsFormDiffApproximate(&fd[nout * k], ftmp, nout, dh);
+  }
+
+  // Compute the error
+  int max_err_index, max_rel_index;
+  double max_err = TacsGetMaxError(result, fd, N * nout, &max_err_index);
+  double max_rel = TacsGetMaxRelError(result, fd, N * nout, &max_rel_index);
+
+  if (test_print_level > 0) {
+    fprintf(stderr, "Testing the derivatives in %d directions\n", N);
+    fprintf(stderr, "Max Err: %10.4e in component %d.\n", max_err,
+            max_err_index);
+    fprintf(stderr, "Max REr: %10.4e in component %d.\n", max_rel,
+            max_rel_index);
+  }
+
+  // Print the error if required
+  if (test_print_level > 1) {
+    TacsPrintErrorComponents(stderr, "df/dx", result, fd, N * nout);
+  }
+  if (test_print_level) {
+    fprintf(stderr, "\n");
+  }
+
+  int fail =
+      !TacsAssertAllClose(result, fd, N * nout, test_fail_atol, test_fail_rtol);
+
+  delete[] pert;
+  delete[] din;
+  delete[] dout;
+  delete[] result;
+  delete[] fd;
+  delete[] xtmp;
+  delete[] ftmp;
+
+  return fail;
+}
+
 #endif  // TACS_ELEMENT_VERIFICATION_H
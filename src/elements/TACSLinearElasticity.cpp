@@ -572,6 +572,23 @@ int TACSLinearElasticity2D::evalPointQuantity(
     }
 
     return 1;
+  } else if (quantityType == TACS_ELEMENT_STRESS) {
+    if (quantity) {
+      TacsScalar e[3];
+      if (strain_type == TACS_LINEAR_STRAIN) {
+        e[0] = Ux[0];
+        e[1] = Ux[3];
+        e[2] = Ux[1] + Ux[2];
+      } else {
+        e[0] = Ux[0] + 0.5 * (Ux[0] * Ux[0] + Ux[2] * Ux[2]);
+        e[1] = Ux[3] + 0.5 * (Ux[1] * Ux[1] + Ux[3] * Ux[3]);
+        e[2] = Ux[1] + Ux[2] + (Ux[0] * Ux[1] + Ux[2] * Ux[3]);
+      }
+
+      stiff->evalStress(elemIndex, pt, X, e, quantity);
+    }
+
+    return 3;
   } else if (quantityType == TACS_ELEMENT_DISPLACEMENT) {
     if (quantity) {
       // Return displacement components
@@ -642,6 +659,19 @@ void TACSLinearElasticity2D::addPointQuantityDVSens(
     stiff->evalStress(elemIndex, pt, X, e, s);
     stiff->addStressDVSens(elemIndex, scale * dfdq[0], pt, X, e, e, dvLen,
                            dfdx);
+  } else if (quantityType == TACS_ELEMENT_STRESS) {
+    TacsScalar e[3];
+    if (strain_type == TACS_LINEAR_STRAIN) {
+      e[0] = Ux[0];
+      e[1] = Ux[3];
+      e[2] = Ux[1] + Ux[2];
+    } else {
+      e[0] = Ux[0] + 0.5 * (Ux[0] * Ux[0] + Ux[2] * Ux[2]);
+      e[1] = Ux[3] + 0.5 * (Ux[1] * Ux[1] + Ux[3] * Ux[3]);
+      e[2] = Ux[1] + Ux[2] + (Ux[0] * Ux[1] + Ux[2] * Ux[3]);
+    }
+
+    stiff->addStressDVSens(elemIndex, scale, pt, X, e, dfdq, dvLen, dfdx);
   } else if (quantityType == TACS_ELEMENT_DENSITY_MOMENT) {
     TacsScalar dfdmass = 0.0;
     dfdmass += scale * dfdq[0] * X[0];
@@ -733,6 +763,25 @@ void TACSLinearElasticity2D::evalPointQuantitySens(
       dfdUx[2] = 2.0 * dfdq[0] * (s[0] * Ux[2] + s[2] * (1.0 + Ux[3]));
       dfdUx[3] = 2.0 * dfdq[0] * (s[1] * (1.0 + Ux[3]) + s[2] * Ux[2]);
     }
+  } else if (quantityType == TACS_ELEMENT_STRESS) {
+    // The constitutive matrix is symmetric, so the derivative of the
+    // stress product w.r.t. the strain is C*dfdq
+    TacsScalar sens[3];
+    stiff->evalStress(elemIndex, pt, X, dfdq, sens);
+
+    if (strain_type == TACS_LINEAR_STRAIN) {
+      dfdUx[0] = sens[0];
+      dfdUx[3] = sens[1];
+
+      dfdUx[1] = sens[2];
+      dfdUx[2] = sens[2];
+    } else {
+      dfdUx[0] = sens[0] * (1.0 + Ux[0]) + sens[2] * Ux[1];
+      dfdUx[1] = sens[1] * Ux[1] + sens[2] * (1.0 + Ux[0]);
+
+      dfdUx[2] = sens[0] * Ux[2] + sens[2] * (1.0 + Ux[3]);
+      dfdUx[3] = sens[1] * (1.0 + Ux[3]) + sens[2] * Ux[2];
+    }
   } else if (quantityType == TACS_ELEMENT_DISPLACEMENT) {
     dfdUt[0] = dfdq[0];
     dfdUt[3] = dfdq[1];
@@ -2007,6 +2056,31 @@ int TACSLinearElasticity3D::evalPointQuantity(
     }
 
     return 1;
+  } else if (quantityType == TACS_ELEMENT_STRESS) {
+    if (quantity) {
+      TacsScalar e[6];
+      if (strain_type == TACS_LINEAR_STRAIN) {
+        e[0] = Ux[0];
+        e[1] = Ux[4];
+        e[2] = Ux[8];
+
+        e[3] = Ux[5] + Ux[7];
+        e[4] = Ux[2] + Ux[6];
+        e[5] = Ux[1] + Ux[3];
+      } else {
+        e[0] = Ux[0] + 0.5 * (Ux[0] * Ux[0] + Ux[3] * Ux[3] + Ux[6] * Ux[6]);
+        e[1] = Ux[4] + 0.5 * (Ux[1] * Ux[1] + Ux[4] * Ux[4] + Ux[7] * Ux[7]);
+        e[2] = Ux[8] + 0.5 * (Ux[2] * Ux[2] + Ux[5] * Ux[5] + Ux[8] * Ux[8]);
+
+        e[3] = Ux[5] + Ux[7] + (Ux[1] * Ux[2] + Ux[4] * Ux[5] + Ux[7] * Ux[8]);
+        e[4] = Ux[2] + Ux[6] + (Ux[0] * Ux[2] + Ux[3] * Ux[5] + Ux[6] * Ux[8]);
+        e[5] = Ux[1] + Ux[3] + (Ux[0] * Ux[1] + Ux[3] * Ux[4] + Ux[6] * Ux[7]);
+      }
+
+      stiff->evalStress(elemIndex, pt, X, e, quantity);
+    }
+
+    return 6;
   } else if (quantityType == TACS_ELEMENT_DISPLACEMENT) {
     if (quantity) {
       // Return displacement components
@@ -2098,6 +2172,27 @@ void TACSLinearElasticity3D::addPointQuantityDVSens(
     stiff->evalStress(elemIndex, pt, X, e, s);
     stiff->addStressDVSens(elemIndex, scale * dfdq[0], pt, X, e, e, dvLen,
                            dfdx);
+  } else if (quantityType == TACS_ELEMENT_STRESS) {
+    TacsScalar e[6];
+    if (strain_type == TACS_LINEAR_STRAIN) {
+      e[0] = Ux[0];
+      e[1] = Ux[4];
+      e[2] = Ux[8];
+
+      e[3] = Ux[5] + Ux[7];
+      e[4] = Ux[2] + Ux[6];
+      e[5] = Ux[1] + Ux[3];
+    } else {
+      e[0] = Ux[0] + 0.5 * (Ux[0] * Ux[0] + Ux[3] * Ux[3] + Ux[6] * Ux[6]);
+      e[1] = Ux[4] + 0.5 * (Ux[1] * Ux[1] + Ux[4] * Ux[4] + Ux[7] * Ux[7]);
+      e[2] = Ux[8] + 0.5 * (Ux[2] * Ux[2] + Ux[5] * Ux[5] + Ux[8] * Ux[8]);
+
+      e[3] = Ux[5] + Ux[7] + (Ux[1] * Ux[2] + Ux[4] * Ux[5] + Ux[7] * Ux[8]);
+      e[4] = Ux[2] + Ux[6] + (Ux[0] * Ux[2] + Ux[3] * Ux[5] + Ux[6] * Ux[8]);
+      e[5] = Ux[1] + Ux[3] + (Ux[0] * Ux[1] + Ux[3] * Ux[4] + Ux[6] * Ux[7]);
+    }
+
+    stiff->addStressDVSens(elemIndex, scale, pt, X, e, dfdq, dvLen, dfdx);
   } else if (quantityType == TACS_ELEMENT_DENSITY_MOMENT) {
     TacsScalar dfdmass = 0.0;
     dfdmass += scale * dfdq[0] * X[0];
@@ -2256,6 +2351,38 @@ void TACSLinearElasticity3D::evalPointQuantitySens(
       dfdUx[8] =
           2.0 * dfdq[0] * (Ux[6] * s[4] + Ux[7] * s[3] + Ux[8] * s[2] + s[2]);
     }
+  } else if (quantityType == TACS_ELEMENT_STRESS) {
+    // The constitutive matrix is symmetric, so the derivative of the
+    // stress product w.r.t. the strain is C*dfdq
+    TacsScalar sens[6];
+    stiff->evalStress(elemIndex, pt, X, dfdq, sens);
+
+    if (strain_type == TACS_LINEAR_STRAIN) {
+      dfdUx[0] = sens[0];
+      dfdUx[4] = sens[1];
+      dfdUx[8] = sens[2];
+
+      dfdUx[5] = sens[3];
+      dfdUx[7] = sens[3];
+
+      dfdUx[2] = sens[4];
+      dfdUx[6] = sens[4];
+
+      dfdUx[1] = sens[5];
+      dfdUx[3] = sens[5];
+    } else {
+      dfdUx[0] = Ux[0] * sens[0] + Ux[1] * sens[5] + Ux[2] * sens[4] + sens[0];
+      dfdUx[1] = Ux[1] * sens[1] + Ux[2] * sens[3] + sens[5] * (Ux[0] + 1.0);
+      dfdUx[2] = Ux[1] * sens[3] + Ux[2] * sens[2] + sens[4] * (Ux[0] + 1.0);
+
+      dfdUx[3] = Ux[3] * sens[0] + Ux[5] * sens[4] + sens[5] * (Ux[4] + 1.0);
+      dfdUx[4] = Ux[3] * sens[5] + Ux[4] * sens[1] + Ux[5] * sens[3] + sens[1];
+      dfdUx[5] = Ux[3] * sens[4] + Ux[5] * sens[2] + sens[3] * (Ux[4] + 1.0);
+
+      dfdUx[6] = Ux[6] * sens[0] + Ux[7] * sens[5] + sens[4] * (Ux[8] + 1.0);
+      dfdUx[7] = Ux[6] * sens[5] + Ux[7] * sens[1] + sens[3] * (Ux[8] + 1.0);
+      dfdUx[8] = Ux[6] * sens[4] + Ux[7] * sens[3] + Ux[8] * sens[2] + sens[2];
+    }
   } else if (quantityType == TACS_ELEMENT_DISPLACEMENT) {
     dfdUt[0] = dfdq[0];
     dfdUt[3] = dfdq[1];
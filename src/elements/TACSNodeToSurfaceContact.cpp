@@ -0,0 +1,375 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSNodeToSurfaceContact.h"
+
+#include "TACSElementAlgebra.h"
+
+const char *TACSNodeToSurfaceContact::elemName = "TACSNodeToSurfaceContact";
+
+/*
+  Create the contact element
+
+  @param vars_per_node The number of variables per node (>= 3)
+  @param facet_size The number of facet nodes (3 or 4)
+  @param penalty The penalty stiffness (force per unit length)
+  @param tol The parametric tolerance for a projection within the facet
+*/
+TACSNodeToSurfaceContact::TACSNodeToSurfaceContact(int _vars_per_node,
+                                                   int _facet_size,
+                                                   TacsScalar _penalty,
+                                                   double _tol) {
+  vars_per_node = _vars_per_node;
+  facet_size = _facet_size;
+  penalty = _penalty;
+  tol = _tol;
+
+  if (vars_per_node < 3) {
+    fprintf(stderr,
+            "TACSNodeToSurfaceContact: At least 3 variables per node "
+            "are required\n");
+    vars_per_node = 3;
+  }
+  if (facet_size != 3 && facet_size != 4) {
+    fprintf(stderr,
+            "TACSNodeToSurfaceContact: Facet size %d not supported, "
+            "must be 3 or 4\n",
+            facet_size);
+    facet_size = 3;
+  }
+}
+
+const char *TACSNodeToSurfaceContact::getObjectName() { return elemName; }
+
+int TACSNodeToSurfaceContact::getVarsPerNode() { return vars_per_node; }
+
+int TACSNodeToSurfaceContact::getNumNodes() { return 1 + facet_size; }
+
+/*
+  Evaluate the shape functions, the point, the tangents and the mixed
+  second derivative of the facet at the parametric point xi
+*/
+void TACSNodeToSurfaceContact::computeFacetPoint(
+    const TacsScalar xi[], const TacsScalar xf[], TacsScalar N[],
+    TacsScalar Na[], TacsScalar Nb[], TacsScalar xm[], TacsScalar t[],
+    TacsScalar tab[]) {
+  if (facet_size == 3) {
+    N[0] = 1.0 - xi[0] - xi[1];
+    N[1] = xi[0];
+    N[2] = xi[1];
+    Na[0] = -1.0;
+    Na[1] = 1.0;
+    Na[2] = 0.0;
+    Nb[0] = -1.0;
+    Nb[1] = 0.0;
+    Nb[2] = 1.0;
+  } else {
+    N[0] = 0.25 * (1.0 - xi[0]) * (1.0 - xi[1]);
+    N[1] = 0.25 * (1.0 + xi[0]) * (1.0 - xi[1]);
+    N[2] = 0.25 * (1.0 - xi[0]) * (1.0 + xi[1]);
+    N[3] = 0.25 * (1.0 + xi[0]) * (1.0 + xi[1]);
+    Na[0] = -0.25 * (1.0 - xi[1]);
+    Na[1] = 0.25 * (1.0 - xi[1]);
+    Na[2] = -0.25 * (1.0 + xi[1]);
+    Na[3] = 0.25 * (1.0 + xi[1]);
+    Nb[0] = -0.25 * (1.0 - xi[0]);
+    Nb[1] = -0.25 * (1.0 + xi[0]);
+    Nb[2] = 0.25 * (1.0 - xi[0]);
+    Nb[3] = 0.25 * (1.0 + xi[0]);
+  }
+
+  for (int k = 0; k < 3; k++) {
+    xm[k] = t[k] = t[3 + k] = tab[k] = 0.0;
+  }
+  for (int i = 0; i < facet_size; i++) {
+    for (int k = 0; k < 3; k++) {
+      xm[k] += N[i] * xf[3 * i + k];
+      t[k] += Na[i] * xf[3 * i + k];
+      t[3 + k] += Nb[i] * xf[3 * i + k];
+    }
+  }
+  if (facet_size == 4) {
+    const double Nab[4] = {0.25, -0.25, -0.25, 0.25};
+    for (int i = 0; i < 4; i++) {
+      for (int k = 0; k < 3; k++) {
+        tab[k] += Nab[i] * xf[3 * i + k];
+      }
+    }
+  }
+}
+
+/*
+  Compute the gap and its first and second derivatives w.r.t. the
+  element variables
+
+  The contact node is projected onto the facet using a Newton method
+  to find the closest point. At the closest point, the variation of
+  the gap is n^{T}(du_s - sum_i N_i du_i) since the terms from the
+  variation of the projection and the normal vanish. The second
+  derivative accounts for the rotation of the normal and the motion
+  of the projection along the facet.
+
+  @return 1 if the projection lies within the facet, 0 otherwise
+*/
+int TACSNodeToSurfaceContact::computeGapGradient(const TacsScalar Xpts[],
+                                                 const TacsScalar vars[],
+                                                 TacsScalar *gap,
+                                                 TacsScalar G[],
+                                                 TacsScalar H[]) {
+  const int nnodes = 1 + facet_size;
+  const int nvars = vars_per_node * nnodes;
+
+  // Compute the deformed node locations
+  TacsScalar x[3 * (1 + MAX_FACET_NODES)];
+  for (int i = 0; i < nnodes; i++) {
+    for (int k = 0; k < 3; k++) {
+      x[3 * i + k] = Xpts[3 * i + k] + vars[vars_per_node * i + k];
+    }
+  }
+  const TacsScalar *xs = &x[0];
+  const TacsScalar *xf = &x[3];
+
+  // Project the node onto the facet
+  TacsScalar xi[2];
+  if (facet_size == 3) {
+    xi[0] = xi[1] = 1.0 / 3.0;
+  } else {
+    xi[0] = xi[1] = 0.0;
+  }
+
+  TacsScalar N[MAX_FACET_NODES], Na[MAX_FACET_NODES], Nb[MAX_FACET_NODES];
+  TacsScalar xm[3], t[6], tab[3];
+  for (int iter = 0; iter < 10; iter++) {
+    computeFacetPoint(xi, xf, N, Na, Nb, xm, t, tab);
+
+    TacsScalar d[3];
+    d[0] = xm[0] - xs[0];
+    d[1] = xm[1] - xs[1];
+    d[2] = xm[2] - xs[2];
+
+    // The stationarity conditions of the squared distance
+    TacsScalar r[2], J[3];
+    r[0] = vec3Dot(&t[0], d);
+    r[1] = vec3Dot(&t[3], d);
+    J[0] = vec3Dot(&t[0], &t[0]);
+    J[1] = vec3Dot(&t[0], &t[3]) + vec3Dot(tab, d);
+    J[2] = vec3Dot(&t[3], &t[3]);
+
+    TacsScalar det = J[0] * J[2] - J[1] * J[1];
+    if (TacsRealPart(det) == 0.0) {
+      return 0;
+    }
+    TacsScalar dxi[2];
+    dxi[0] = (J[2] * r[0] - J[1] * r[1]) / det;
+    dxi[1] = (J[0] * r[1] - J[1] * r[0]) / det;
+    xi[0] -= dxi[0];
+    xi[1] -= dxi[1];
+
+    if (fabs(TacsRealPart(dxi[0])) + fabs(TacsRealPart(dxi[1])) < 1e-12) {
+      break;
+    }
+  }
+
+  // Check whether the projection lies within the facet
+  double a = TacsRealPart(xi[0]), b = TacsRealPart(xi[1]);
+  if (facet_size == 3) {
+    if (a < -tol || b < -tol || a + b > 1.0 + tol) {
+      return 0;
+    }
+  } else if (a < -1.0 - tol || a > 1.0 + tol || b < -1.0 - tol ||
+             b > 1.0 + tol) {
+    return 0;
+  }
+
+  // Evaluate the facet at the projection and compute the normal
+  computeFacetPoint(xi, xf, N, Na, Nb, xm, t, tab);
+
+  TacsScalar n[3];
+  crossProduct(&t[0], &t[3], n);
+  TacsScalar nrm = sqrt(vec3Dot(n, n));
+  if (TacsRealPart(nrm) == 0.0) {
+    return 0;
+  }
+  TacsScalar inv = 1.0 / nrm;
+  n[0] *= inv;
+  n[1] *= inv;
+  n[2] *= inv;
+
+  TacsScalar d[3];
+  d[0] = xs[0] - xm[0];
+  d[1] = xs[1] - xm[1];
+  d[2] = xs[2] - xm[2];
+  TacsScalar g = vec3Dot(n, d);
+  *gap = g;
+
+  if (G) {
+    memset(G, 0, nvars * sizeof(TacsScalar));
+    for (int k = 0; k < 3; k++) {
+      G[k] = n[k];
+    }
+    for (int i = 0; i < facet_size; i++) {
+      for (int k = 0; k < 3; k++) {
+        G[vars_per_node * (i + 1) + k] = -N[i] * n[k];
+      }
+    }
+  }
+
+  if (H) {
+    // The metric, its inverse and the curvature of the facet
+    TacsScalar A[3], Ainv[3], Minv[3], bc;
+    A[0] = vec3Dot(&t[0], &t[0]);
+    A[1] = vec3Dot(&t[0], &t[3]);
+    A[2] = vec3Dot(&t[3], &t[3]);
+    TacsScalar det = A[0] * A[2] - A[1] * A[1];
+    Minv[0] = A[2] / det;
+    Minv[1] = -A[1] / det;
+    Minv[2] = A[0] / det;
+
+    bc = vec3Dot(n, tab);
+    A[1] -= g * bc;
+    det = A[0] * A[2] - A[1] * A[1];
+    Ainv[0] = A[2] / det;
+    Ainv[1] = -A[1] / det;
+    Ainv[2] = A[0] / det;
+
+    // D_a^{T}du = t_a^{T}(du_s - sum_i N_i du_i) and
+    // T_a^{T}du = n^{T} sum_i N_{i,a} du_i
+    TacsScalar *D = new TacsScalar[6 * nvars];
+    TacsScalar *T = &D[2 * nvars];
+    TacsScalar *X = &D[4 * nvars];
+    memset(D, 0, 4 * nvars * sizeof(TacsScalar));
+    for (int a = 0; a < 2; a++) {
+      const TacsScalar *Nd = (a == 0 ? Na : Nb);
+      for (int k = 0; k < 3; k++) {
+        D[a * nvars + k] = t[3 * a + k];
+      }
+      for (int i = 0; i < facet_size; i++) {
+        for (int k = 0; k < 3; k++) {
+          D[a * nvars + vars_per_node * (i + 1) + k] = -N[i] * t[3 * a + k];
+          T[a * nvars + vars_per_node * (i + 1) + k] = Nd[i] * n[k];
+        }
+      }
+    }
+
+    // The derivative of the projection X_a = A^{-1}(D + g*T)
+    for (int j = 0; j < nvars; j++) {
+      TacsScalar r0 = D[j] + g * T[j];
+      TacsScalar r1 = D[nvars + j] + g * T[nvars + j];
+      X[j] = Ainv[0] * r0 + Ainv[1] * r1;
+      X[nvars + j] = Ainv[1] * r0 + Ainv[2] * r1;
+    }
+
+    // H = -sum_{ab} M^{ab} D_b (T_a + b_{ac} X_c)^{T} - sum_a T_a X_a^{T}
+    for (int i = 0; i < nvars; i++) {
+      TacsScalar w0 = Minv[0] * D[i] + Minv[1] * D[nvars + i];
+      TacsScalar w1 = Minv[1] * D[i] + Minv[2] * D[nvars + i];
+      TacsScalar *h = &H[nvars * i];
+      for (int j = 0; j < nvars; j++) {
+        TacsScalar p0 = T[j] + bc * X[nvars + j];
+        TacsScalar p1 = T[nvars + j] + bc * X[j];
+        h[j] = -(w0 * p0 + w1 * p1) - T[i] * X[j] - T[nvars + i] * X[nvars + j];
+      }
+    }
+
+    delete[] D;
+  }
+
+  return 1;
+}
+
+/*
+  Compute the gap between the contact node and the facet
+
+  @param Xpts The element node locations
+  @param vars The element variables
+  @param gap The gap along the facet normal (negative for penetration)
+  @return 1 if the projection lies within the facet, 0 otherwise
+*/
+int TACSNodeToSurfaceContact::computeGap(const TacsScalar Xpts[],
+                                         const TacsScalar vars[],
+                                         TacsScalar *gap) {
+  *gap = 0.0;
+  return computeGapGradient(Xpts, vars, gap, NULL, NULL);
+}
+
+void TACSNodeToSurfaceContact::computeEnergies(
+    int elemIndex, double time, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[], TacsScalar *Te,
+    TacsScalar *Pe) {
+  *Te = 0.0;
+  *Pe = 0.0;
+
+  TacsScalar gap;
+  if (computeGapGradient(Xpts, vars, &gap, NULL, NULL) &&
+      TacsRealPart(gap) < 0.0) {
+    *Pe = 0.5 * penalty * gap * gap;
+  }
+}
+
+/*
+  Add the penalty contact force k*g*dg/du when the node penetrates
+*/
+void TACSNodeToSurfaceContact::addResidual(int elemIndex, double time,
+                                           const TacsScalar Xpts[],
+                                           const TacsScalar vars[],
+                                           const TacsScalar dvars[],
+                                           const TacsScalar ddvars[],
+                                           TacsScalar res[]) {
+  const int nvars = vars_per_node * (1 + facet_size);
+  TacsScalar *G = new TacsScalar[nvars];
+
+  TacsScalar gap;
+  if (computeGapGradient(Xpts, vars, &gap, G, NULL) &&
+      TacsRealPart(gap) < 0.0) {
+    TacsScalar f = penalty * gap;
+    for (int i = 0; i < nvars; i++) {
+      res[i] += f * G[i];
+    }
+  }
+
+  delete[] G;
+}
+
+/*
+  Add the contact stiffness k*(dg/du*dg/du^{T} + g*d^2g/du^2)
+*/
+void TACSNodeToSurfaceContact::addJacobian(
+    int elemIndex, double time, TacsScalar alpha, TacsScalar beta,
+    TacsScalar gamma, const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar res[],
+    TacsScalar mat[]) {
+  const int nvars = vars_per_node * (1 + facet_size);
+  TacsScalar *G = new TacsScalar[nvars * (nvars + 1)];
+  TacsScalar *H = &G[nvars];
+
+  TacsScalar gap;
+  if (computeGapGradient(Xpts, vars, &gap, G, H) &&
+      TacsRealPart(gap) < 0.0) {
+    TacsScalar f = penalty * gap;
+    if (res) {
+      for (int i = 0; i < nvars; i++) {
+        res[i] += f * G[i];
+      }
+    }
+
+    TacsScalar scale = alpha * penalty;
+    for (int i = 0; i < nvars; i++) {
+      for (int j = 0; j < nvars; j++) {
+        mat[nvars * i + j] += scale * (G[i] * G[j] + gap * H[nvars * i + j]);
+      }
+    }
+  }
+
+  delete[] G;
+}
@@ -0,0 +1,105 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_NODE_TO_SURFACE_CONTACT_H
+#define TACS_NODE_TO_SURFACE_CONTACT_H
+
+#include "TACSElement.h"
+
+/*
+  A frictionless, penalty-based node-to-surface contact element.
+
+  The first node of the element is the contact (slave) node and the
+  remaining nodes define a triangular or quadrilateral facet of the
+  target surface. The quadrilateral nodes use the tensor-product
+  ordering of the shell and solid element faces. The first three
+  variables at each node are the displacements, so the element can be
+  used with both shell (6 variables per node) and solid (3 variables
+  per node) models.
+
+  In the deformed configuration, the contact node is projected onto
+  the facet. When the projection lies within the facet and the gap
+  g = n^{T}(x_s - x_m) along the facet normal is negative, a penalty
+  energy 1/2*k*g^2 is added. The facet normal follows the right-hand
+  rule with the node ordering, and must point away from the target
+  body.
+
+  The candidate node/facet pairs are found with TACSContactSearch.
+  Since the projection is recomputed in every evaluation, the contact
+  point slides along the facet during the Newton iterations.
+*/
+class TACSNodeToSurfaceContact : public TACSElement {
+ public:
+  TACSNodeToSurfaceContact(int _vars_per_node, int _facet_size,
+                           TacsScalar _penalty, double _tol = 0.0);
+
+  // Get the element properties and names
+  // ------------------------------------
+  const char *getObjectName();
+  int getVarsPerNode();
+  int getNumNodes();
+  ElementType getElementType() { return TACS_SPRING_ELEMENT; }
+  int getNumQuadraturePoints() { return 0; }
+  double getQuadratureWeight(int n) { return 0.0; }
+  double getQuadraturePoint(int n, double pt[]) { return 0.0; }
+  int getNumElementFaces() { return 0; }
+  int getNumFaceQuadraturePoints(int face) { return 0; }
+  double getFaceQuadraturePoint(int face, int n, double pt[],
+                                double tangent[]) {
+    return 0.0;
+  }
+
+  // Set/get the penalty parameter
+  // -----------------------------
+  void setPenalty(TacsScalar _penalty) { penalty = _penalty; }
+  TacsScalar getPenalty() { return penalty; }
+
+  // Compute the gap between the node and the facet
+  // ----------------------------------------------
+  int computeGap(const TacsScalar Xpts[], const TacsScalar vars[],
+                 TacsScalar *gap);
+
+  // Functions for analysis
+  // ----------------------
+  void computeEnergies(int elemIndex, double time, const TacsScalar Xpts[],
+                       const TacsScalar vars[], const TacsScalar dvars[],
+                       TacsScalar *Te, TacsScalar *Pe);
+
+  void addResidual(int elemIndex, double time, const TacsScalar Xpts[],
+                   const TacsScalar vars[], const TacsScalar dvars[],
+                   const TacsScalar ddvars[], TacsScalar res[]);
+
+  void addJacobian(int elemIndex, double time, TacsScalar alpha,
+                   TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+                   const TacsScalar vars[], const TacsScalar dvars[],
+                   const TacsScalar ddvars[], TacsScalar res[],
+                   TacsScalar mat[]);
+
+ private:
+  static const int MAX_FACET_NODES = 4;
+
+  int computeGapGradient(const TacsScalar Xpts[], const TacsScalar vars[],
+                         TacsScalar *gap, TacsScalar G[], TacsScalar H[]);
+  void computeFacetPoint(const TacsScalar xi[], const TacsScalar xf[],
+                         TacsScalar N[], TacsScalar Na[], TacsScalar Nb[],
+                         TacsScalar xm[], TacsScalar t[], TacsScalar tab[]);
+
+  int vars_per_node, facet_size;
+  TacsScalar penalty;
+  double tol;
+
+  static const char *elemName;
+};
+
+#endif  // TACS_NODE_TO_SURFACE_CONTACT_H
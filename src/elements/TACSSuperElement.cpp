@@ -0,0 +1,114 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSSuperElement.h"
+
+const char *TACSSuperElement::elemName = "TACSSuperElement";
+
+/*
+  Create the superelement and copy the reduced matrices
+*/
+TACSSuperElement::TACSSuperElement(int _vars_per_node, int _num_nodes,
+                                   const TacsScalar *_K,
+                                   const TacsScalar *_M) {
+  vars_per_node = _vars_per_node;
+  num_nodes = _num_nodes;
+  num_vars = vars_per_node * num_nodes;
+
+  K = new TacsScalar[num_vars * num_vars];
+  M = new TacsScalar[num_vars * num_vars];
+  memcpy(K, _K, num_vars * num_vars * sizeof(TacsScalar));
+  if (_M) {
+    memcpy(M, _M, num_vars * num_vars * sizeof(TacsScalar));
+  } else {
+    memset(M, 0, num_vars * num_vars * sizeof(TacsScalar));
+  }
+}
+
+TACSSuperElement::~TACSSuperElement() {
+  delete[] K;
+  delete[] M;
+}
+
+const char *TACSSuperElement::getObjectName() { return elemName; }
+
+int TACSSuperElement::getVarsPerNode() { return vars_per_node; }
+
+int TACSSuperElement::getNumNodes() { return num_nodes; }
+
+/*
+  Compute the kinetic and potential energies
+*/
+void TACSSuperElement::computeEnergies(int elemIndex, double time,
+                                       const TacsScalar Xpts[],
+                                       const TacsScalar vars[],
+                                       const TacsScalar dvars[],
+                                       TacsScalar *Te, TacsScalar *Pe) {
+  *Te = 0.0;
+  *Pe = 0.0;
+  for (int i = 0; i < num_vars; i++) {
+    for (int j = 0; j < num_vars; j++) {
+      *Te += 0.5 * dvars[i] * M[num_vars * i + j] * dvars[j];
+      *Pe += 0.5 * vars[i] * K[num_vars * i + j] * vars[j];
+    }
+  }
+}
+
+/*
+  Add the residual K*u + M*ddu
+*/
+void TACSSuperElement::addResidual(int elemIndex, double time,
+                                   const TacsScalar Xpts[],
+                                   const TacsScalar vars[],
+                                   const TacsScalar dvars[],
+                                   const TacsScalar ddvars[],
+                                   TacsScalar res[]) {
+  for (int i = 0; i < num_vars; i++) {
+    const TacsScalar *k = &K[num_vars * i];
+    const TacsScalar *m = &M[num_vars * i];
+    for (int j = 0; j < num_vars; j++) {
+      res[i] += k[j] * vars[j] + m[j] * ddvars[j];
+    }
+  }
+}
+
+/*
+  Add the Jacobian alpha*K + gamma*M and the residual
+*/
+void TACSSuperElement::addJacobian(int elemIndex, double time,
+                                   TacsScalar alpha, TacsScalar beta,
+                                   TacsScalar gamma, const TacsScalar Xpts[],
+                                   const TacsScalar vars[],
+                                   const TacsScalar dvars[],
+                                   const TacsScalar ddvars[], TacsScalar res[],
+                                   TacsScalar mat[]) {
+  if (res) {
+    addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, res);
+  }
+  for (int i = 0; i < num_vars * num_vars; i++) {
+    mat[i] += alpha * K[i] + gamma * M[i];
+  }
+}
+
+void TACSSuperElement::getMatType(ElementMatrixType matType, int elemIndex,
+                                  double time, const TacsScalar Xpts[],
+                                  const TacsScalar vars[], TacsScalar mat[]) {
+  if (matType == TACS_STIFFNESS_MATRIX) {
+    memcpy(mat, K, num_vars * num_vars * sizeof(TacsScalar));
+  } else if (matType == TACS_MASS_MATRIX) {
+    memcpy(mat, M, num_vars * num_vars * sizeof(TacsScalar));
+  } else {
+    memset(mat, 0, num_vars * num_vars * sizeof(TacsScalar));
+  }
+}
@@ -0,0 +1,80 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_SUPER_ELEMENT_H
+#define TACS_SUPER_ELEMENT_H
+
+#include "TACSElement.h"
+
+/*
+  A superelement defined by dense reduced stiffness and mass matrices.
+
+  The matrices are stored in row-major order with the element variable
+  ordering so that the element contributes K*u + M*ddu to the residual.
+  This is used with reduced matrices from a component mode synthesis,
+  where the first nodes of the element are the interface nodes and the
+  remaining nodes hold the modal coordinates. The modal nodes are not
+  shared with any other element.
+*/
+class TACSSuperElement : public TACSElement {
+ public:
+  TACSSuperElement(int _vars_per_node, int _num_nodes, const TacsScalar *_K,
+                   const TacsScalar *_M);
+  ~TACSSuperElement();
+
+  // Get the element properties and names
+  // ------------------------------------
+  const char *getObjectName();
+  int getVarsPerNode();
+  int getNumNodes();
+  int getNumQuadraturePoints() { return 1; }
+  double getQuadratureWeight(int n) { return 1.0; }
+  double getQuadraturePoint(int n, double pt[]) { return 1.0; }
+  int getNumElementFaces() { return 0; }
+  int getNumFaceQuadraturePoints(int face) { return 0; }
+  double getFaceQuadraturePoint(int face, int n, double pt[],
+                                double tangent[]) {
+    return 0.0;
+  }
+
+  // Functions for analysis
+  // ----------------------
+  void computeEnergies(int elemIndex, double time, const TacsScalar Xpts[],
+                       const TacsScalar vars[], const TacsScalar dvars[],
+                       TacsScalar *Te, TacsScalar *Pe);
+
+  void addResidual(int elemIndex, double time, const TacsScalar Xpts[],
+                   const TacsScalar vars[], const TacsScalar dvars[],
+                   const TacsScalar ddvars[], TacsScalar res[]);
+
+  void addJacobian(int elemIndex, double time, TacsScalar alpha,
+                   TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+                   const TacsScalar vars[], const TacsScalar dvars[],
+                   const TacsScalar ddvars[], TacsScalar res[],
+                   TacsScalar mat[]);
+
+  void getMatType(ElementMatrixType matType, int elemIndex, double time,
+                  const TacsScalar Xpts[], const TacsScalar vars[],
+                  TacsScalar mat[]);
+
+ private:
+  int vars_per_node, num_nodes, num_vars;
+
+  // The reduced stiffness and mass matrices
+  TacsScalar *K, *M;
+
+  static const char *elemName;
+};
+
+#endif  // TACS_SUPER_ELEMENT_H
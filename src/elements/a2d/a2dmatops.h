@@ -1433,6 +1433,139 @@ class ADSymm3x3IsotropicConstitutive {
   ADSymm3x3& S;
 };
 
+/*
+  Packed variants of the matrix operations
+
+  Each lane of the packed objects is processed with the same passive
+  operands, for instance several directional derivatives at the same
+  quadrature point.
+*/
+template <int N>
+class ADMat3x3FromThreeADVec3Pack {
+ public:
+  ADMat3x3FromThreeADVec3Pack(ADVec3Pack<N>& x, ADVec3Pack<N>& y,
+                              ADVec3Pack<N>& z, ADMat3x3Pack<N>& C)
+      : x(x), y(y), z(z), C(C) {
+    assemble(x.x, y.x, z.x, C.A);
+  }
+  void forward() { assemble(x.xd, y.xd, z.xd, C.Ad); }
+  void reverse() {
+    for (int i = 0; i < 3; i++) {
+      for (int k = 0; k < N; k++) {
+        x.xd[N * i + k] += C.Ad[N * (3 * i) + k];
+        y.xd[N * i + k] += C.Ad[N * (3 * i + 1) + k];
+        z.xd[N * i + k] += C.Ad[N * (3 * i + 2) + k];
+      }
+    }
+  }
+
+  ADVec3Pack<N>& x;
+  ADVec3Pack<N>& y;
+  ADVec3Pack<N>& z;
+  ADMat3x3Pack<N>& C;
+
+ private:
+  // Set the columns of the matrix from the three vectors in each lane
+  static void assemble(const TacsScalar a[], const TacsScalar b[],
+                       const TacsScalar c[], TacsScalar M[]) {
+    for (int i = 0; i < 3; i++) {
+      for (int k = 0; k < N; k++) {
+        M[N * (3 * i) + k] = a[N * i + k];
+        M[N * (3 * i + 1) + k] = b[N * i + k];
+        M[N * (3 * i + 2) + k] = c[N * i + k];
+      }
+    }
+  }
+};
+
+template <int N>
+class ADMat3x3MatMultPack {
+ public:
+  ADMat3x3MatMultPack(ADMat3x3Pack<N>& A, const Mat3x3& B, ADMat3x3Pack<N>& C)
+      : A(A), B(B), C(C) {
+    mult(A.A, C.A);
+  }
+  void forward() { mult(A.Ad, C.Ad); }
+  void reverse() {
+    // Ad += Cd * B^{T}
+    const TacsScalar* b = B.A;
+    for (int i = 0; i < 3; i++) {
+      const TacsScalar* c = &C.Ad[3 * N * i];
+      for (int j = 0; j < 3; j++) {
+        TacsScalar* a = &A.Ad[N * (3 * i + j)];
+        for (int k = 0; k < N; k++) {
+          a[k] += c[k] * b[3 * j] + c[N + k] * b[3 * j + 1] +
+                  c[2 * N + k] * b[3 * j + 2];
+        }
+      }
+    }
+  }
+
+  ADMat3x3Pack<N>& A;
+  const Mat3x3& B;
+  ADMat3x3Pack<N>& C;
+
+ private:
+  // Compute out = in * B for each lane
+  void mult(const TacsScalar in[], TacsScalar out[]) {
+    const TacsScalar* b = B.A;
+    for (int i = 0; i < 3; i++) {
+      const TacsScalar* a = &in[3 * N * i];
+      for (int j = 0; j < 3; j++) {
+        TacsScalar* c = &out[N * (3 * i + j)];
+        for (int k = 0; k < N; k++) {
+          c[k] = a[k] * b[j] + a[N + k] * b[3 + j] + a[2 * N + k] * b[6 + j];
+        }
+      }
+    }
+  }
+};
+
+template <int N>
+class MatTrans3x3ADMatMultPack {
+ public:
+  MatTrans3x3ADMatMultPack(const Mat3x3& A, ADMat3x3Pack<N>& B,
+                           ADMat3x3Pack<N>& C)
+      : A(A), B(B), C(C) {
+    multTrans(B.A, C.A);
+  }
+  void forward() { multTrans(B.Ad, C.Ad); }
+  void reverse() {
+    // Bd += A * Cd
+    const TacsScalar* a = A.A;
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        TacsScalar* b = &B.Ad[N * (3 * i + j)];
+        const TacsScalar* c = &C.Ad[N * j];
+        for (int k = 0; k < N; k++) {
+          b[k] += a[3 * i] * c[k] + a[3 * i + 1] * c[3 * N + k] +
+                  a[3 * i + 2] * c[6 * N + k];
+        }
+      }
+    }
+  }
+
+  const Mat3x3& A;
+  ADMat3x3Pack<N>& B;
+  ADMat3x3Pack<N>& C;
+
+ private:
+  // Compute out = A^{T} * in for each lane
+  void multTrans(const TacsScalar in[], TacsScalar out[]) {
+    const TacsScalar* a = A.A;
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        TacsScalar* c = &out[N * (3 * i + j)];
+        const TacsScalar* b = &in[N * j];
+        for (int k = 0; k < N; k++) {
+          c[k] = a[i] * b[k] + a[3 + i] * b[3 * N + k] +
+                 a[6 + i] * b[6 * N + k];
+        }
+      }
+    }
+  }
+};
+
 }  // namespace A2D
 
 #endif  // A2D_MAT_OPS_H
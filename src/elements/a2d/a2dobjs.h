@@ -338,6 +338,43 @@ class ADMat3x3 {
   TacsScalar A[9], Ad[9];
 };
 
+/*
+  Packed active vector type
+
+  The entries of N vectors (lanes) are stored with the lane index
+  varying fastest, so that x[N * i + k] is the i-th component of the
+  k-th lane. The packed operations loop over the lanes innermost,
+  which allows the compiler to evaluate several lanes per instruction.
+*/
+template <int N>
+class ADVec3Pack {
+ public:
+  ADVec3Pack() {
+    for (int i = 0; i < 3 * N; i++) {
+      x[i] = 0.0;
+      xd[i] = 0.0;
+    }
+  }
+
+  TacsScalar x[3 * N], xd[3 * N];
+};
+
+/*
+  Packed active 3x3 matrix type with the lane index varying fastest
+*/
+template <int N>
+class ADMat3x3Pack {
+ public:
+  ADMat3x3Pack() {
+    for (int i = 0; i < 9 * N; i++) {
+      A[i] = 0.0;
+      Ad[i] = 0.0;
+    }
+  }
+
+  TacsScalar A[9 * N], Ad[9 * N];
+};
+
 }  // namespace A2D
 
 #endif  // A2D_OBJS_H
@@ -903,6 +903,88 @@ class ADMat3x3ADVecADVecInnerProduct {
   ADScalar& alpha;
 };
 
+/*
+  Packed variants of the vector operations
+
+  Each lane of the packed objects is processed with the same passive
+  operands, for instance several directional derivatives at the same
+  quadrature point.
+*/
+template <int N>
+class ADVec3ADVecScalarAxpyPack {
+ public:
+  ADVec3ADVecScalarAxpyPack(const TacsScalar scale, const Scalar& alpha,
+                            ADVec3Pack<N>& x, ADVec3Pack<N>& y,
+                            ADVec3Pack<N>& v)
+      : scale(scale), alpha(alpha), x(x), y(y), v(v) {
+    const TacsScalar a = scale * alpha.value;
+    for (int i = 0; i < 3 * N; i++) {
+      v.x[i] = a * x.x[i] + y.x[i];
+    }
+  }
+  void forward() {
+    const TacsScalar a = scale * alpha.value;
+    for (int i = 0; i < 3 * N; i++) {
+      v.xd[i] = a * x.xd[i] + y.xd[i];
+    }
+  }
+  void reverse() {
+    const TacsScalar a = scale * alpha.value;
+    for (int i = 0; i < 3 * N; i++) {
+      x.xd[i] += a * v.xd[i];
+      y.xd[i] += v.xd[i];
+    }
+  }
+
+  const TacsScalar scale;
+  const Scalar& alpha;
+  ADVec3Pack<N>& x;
+  ADVec3Pack<N>& y;
+  ADVec3Pack<N>& v;
+};
+
+template <int N>
+class MatTrans3x3ADVecMultScalePack {
+ public:
+  MatTrans3x3ADVecMultScalePack(const Scalar& scale, const Mat3x3& A,
+                                ADVec3Pack<N>& x, ADVec3Pack<N>& y)
+      : scale(scale), A(A), x(x), y(y) {
+    multTrans(x.x, y.x);
+  }
+  void forward() { multTrans(x.xd, y.xd); }
+  void reverse() {
+    const TacsScalar* a = A.A;
+    for (int i = 0; i < 3; i++) {
+      const TacsScalar a0 = scale.value * a[3 * i];
+      const TacsScalar a1 = scale.value * a[3 * i + 1];
+      const TacsScalar a2 = scale.value * a[3 * i + 2];
+      for (int k = 0; k < N; k++) {
+        x.xd[N * i + k] +=
+            a0 * y.xd[k] + a1 * y.xd[N + k] + a2 * y.xd[2 * N + k];
+      }
+    }
+  }
+
+  const Scalar& scale;
+  const Mat3x3& A;
+  ADVec3Pack<N>& x;
+  ADVec3Pack<N>& y;
+
+ private:
+  // Compute out = scale * A^{T} * in for each lane
+  void multTrans(const TacsScalar in[], TacsScalar out[]) {
+    const TacsScalar* a = A.A;
+    for (int i = 0; i < 3; i++) {
+      const TacsScalar a0 = scale.value * a[i];
+      const TacsScalar a1 = scale.value * a[3 + i];
+      const TacsScalar a2 = scale.value * a[6 + i];
+      for (int k = 0; k < N; k++) {
+        out[N * i + k] = a0 * in[k] + a1 * in[N + k] + a2 * in[2 * N + k];
+      }
+    }
+  }
+};
+
 }  // namespace A2D
 
 #endif  // A2D_VEC_OPS_H
@@ -15,6 +15,192 @@
 #include "TACSElementBasis.h"
 
 #include "TACSElementAlgebra.h"
+#include "tacslapack.h"
+
+/*
+  Allocate a table of shape function values aligned to a cache line
+*/
+static double *TacsAllocBasisTable(int size) {
+  const size_t alignment = 64;
+  size_t bytes = (size > 0 ? size : 1) * sizeof(double);
+  bytes = alignment * ((bytes + alignment - 1) / alignment);
+
+  void *ptr = NULL;
+  if (posix_memalign(&ptr, alignment, bytes) != 0) {
+    fprintf(stderr, "TACSElementBasis: Failed to allocate %zu bytes\n", bytes);
+    return NULL;
+  }
+  return static_cast<double *>(ptr);
+}
+
+/*
+  Interpolation kernels shared by the volume and face routines
+*/
+static void TacsInterpFields(const int num_nodes, const double N[],
+                             const int vars_per_node,
+                             const TacsScalar values[], const int incr,
+                             TacsScalar field[]) {
+  for (int i = 0; i < vars_per_node; i++) {
+    field[incr * i] = 0.0;
+    for (int j = 0; j < num_nodes; j++) {
+      field[incr * i] += values[vars_per_node * j + i] * N[j];
+    }
+  }
+}
+
+static void TacsAddInterpFieldsTranspose(const int num_nodes, const double N[],
+                                         const int incr,
+                                         const TacsScalar field[],
+                                         const int vars_per_node,
+                                         TacsScalar values[]) {
+  for (int i = 0; i < vars_per_node; i++) {
+    for (int j = 0; j < num_nodes; j++) {
+      values[vars_per_node * j + i] += field[incr * i] * N[j];
+    }
+  }
+}
+
+static void TacsInterpFieldsGrad(const int num_nodes, const int num_params,
+                                 const double Nxi[], const int vars_per_node,
+                                 const TacsScalar values[], TacsScalar grad[]) {
+  for (int i = 0; i < vars_per_node; i++) {
+    for (int j = 0; j < num_params; j++) {
+      grad[num_params * i + j] = 0.0;
+    }
+    for (int k = 0; k < num_nodes; k++) {
+      for (int j = 0; j < num_params; j++) {
+        grad[num_params * i + j] +=
+            values[vars_per_node * k + i] * Nxi[num_params * k + j];
+      }
+    }
+  }
+}
+
+static void TacsAddInterpFieldsGradTranspose(const int num_nodes,
+                                             const int num_params,
+                                             const double Nxi[],
+                                             const int vars_per_node,
+                                             const TacsScalar grad[],
+                                             TacsScalar values[]) {
+  for (int i = 0; i < vars_per_node; i++) {
+    for (int k = 0; k < num_nodes; k++) {
+      for (int j = 0; j < num_params; j++) {
+        values[vars_per_node * k + i] +=
+            grad[num_params * i + j] * Nxi[num_params * k + j];
+      }
+    }
+  }
+}
+
+TACSElementBasis::TACSElementBasis() {
+  tables_ready = 0;
+  pthread_mutex_init(&table_mutex, NULL);
+  table_size = 0;
+  num_table_faces = 0;
+  face_table_ptr = NULL;
+  quad_table = NULL;
+  face_table = NULL;
+}
+
+TACSElementBasis::~TACSElementBasis() {
+  pthread_mutex_destroy(&table_mutex);
+  if (face_table_ptr) {
+    delete[] face_table_ptr;
+  }
+  free(quad_table);
+  free(face_table);
+}
+
+/*
+  Compute the shape functions and their derivatives at the volume and
+  face quadrature points.
+
+  This is called the first time a table is needed. Elements share basis
+  objects across threads, so the tables are built under a lock and only
+  marked as ready once they are complete.
+*/
+void TACSElementBasis::initBasisTables() {
+  pthread_mutex_lock(&table_mutex);
+  if (!tables_ready.load(std::memory_order_relaxed)) {
+    const int num_nodes = getNumNodes();
+    const int num_params = getNumParameters();
+    const int nquad = getNumQuadraturePoints();
+
+    // Pad the entries for each point to a multiple of 8 doubles
+    table_size = 8 * (((1 + num_params) * num_nodes + 7) / 8);
+
+    quad_table = TacsAllocBasisTable(nquad * table_size);
+    for (int n = 0; n < nquad; n++) {
+      double pt[3];
+      getQuadraturePoint(n, pt);
+      double *N = &quad_table[table_size * n];
+      computeBasisGradient(pt, N, &N[num_nodes]);
+    }
+
+    num_table_faces = getNumElementFaces();
+    face_table_ptr = new int[num_table_faces + 1];
+    face_table_ptr[0] = 0;
+    for (int face = 0; face < num_table_faces; face++) {
+      face_table_ptr[face + 1] =
+          face_table_ptr[face] + getNumFaceQuadraturePoints(face);
+    }
+
+    face_table =
+        TacsAllocBasisTable(face_table_ptr[num_table_faces] * table_size);
+    for (int face = 0; face < num_table_faces; face++) {
+      for (int n = 0; n < face_table_ptr[face + 1] - face_table_ptr[face];
+           n++) {
+        double pt[3], t[6];
+        getFaceQuadraturePoint(face, n, pt, t);
+        double *N = &face_table[table_size * (face_table_ptr[face] + n)];
+        computeBasisGradient(pt, N, &N[num_nodes]);
+      }
+    }
+
+    tables_ready.store(1, std::memory_order_release);
+  }
+  pthread_mutex_unlock(&table_mutex);
+}
+
+const double *TACSElementBasis::getBasisValues(const int n, const double pt[],
+                                               double work[]) {
+  if (n >= 0 && n < getNumQuadraturePoints()) {
+    if (!tables_ready.load(std::memory_order_acquire)) {
+      initBasisTables();
+    }
+    return &quad_table[table_size * n];
+  }
+  computeBasis(pt, work);
+  return work;
+}
+
+const double *TACSElementBasis::getBasisGradientValues(const int n,
+                                                       const double pt[],
+                                                       double work[]) {
+  if (n >= 0 && n < getNumQuadraturePoints()) {
+    if (!tables_ready.load(std::memory_order_acquire)) {
+      initBasisTables();
+    }
+    return &quad_table[table_size * n];
+  }
+  computeBasisGradient(pt, work, &work[getNumNodes()]);
+  return work;
+}
+
+const double *TACSElementBasis::getFaceBasisGradientValues(const int face,
+                                                           const int n,
+                                                           const double pt[],
+                                                           double work[]) {
+  if (!tables_ready.load(std::memory_order_acquire)) {
+    initBasisTables();
+  }
+  if (face >= 0 && face < num_table_faces && n >= 0 &&
+      n < face_table_ptr[face + 1] - face_table_ptr[face]) {
+    return &face_table[table_size * (face_table_ptr[face] + n)];
+  }
+  computeBasisGradient(pt, work, &work[getNumNodes()]);
+  return work;
+}
 
 /*
   Get the layout type
@@ -1050,21 +1236,145 @@ void TACSElementBasis::addMatVecProduct(const int vars_per_node,
   addInterpAllFieldsGradTranspose(vars_per_node, out, py);
 }
 
-void TACSElementBasis::interpFields(const int n, const double pt[],
-                                    const int vars_per_node,
-                                    const TacsScalar values[], const int incr,
-                                    TacsScalar field[]) {
+/*
+  Get the size of the temporary array required by addAllWeakMatrices
+*/
+int TACSElementBasis::getAllWeakMatricesTempSize(const int vars_per_node) {
+  const int num_nodes = getNumNodes();
+  const int nquad = getNumQuadraturePoints();
+  const int nc = getNumParameters() + 1;
+
+  return nquad * nc * (2 * num_nodes + vars_per_node * vars_per_node * nc) +
+         num_nodes * num_nodes;
+}
+
+/*
+  Add the weak form of the matrix from all quadrature points to the
+  element matrix
+*/
+void TACSElementBasis::addAllWeakMatrices(const int vars_per_node,
+                                          const int Jac_nnz,
+                                          const int *Jac_pairs,
+                                          const TacsScalar *data,
+                                          TacsScalar temp[], TacsScalar *mat) {
   const int num_nodes = getNumNodes();
-  double N[MAX_NUM_NODES];
-  computeBasis(pt, N);
+  const int num_params = getNumParameters();
+  const int num_vars = num_nodes * vars_per_node;
+  const int np2 = num_params * num_params;
+  const int nquad = getNumQuadraturePoints();
+
+  // The number of rows in B_n and the size of the blocks of D_n
+  const int nc = num_params + 1;
+  const int nb = nc * nc;
+  const int dsize = vars_per_node * vars_per_node * nb;
+
+  // Set the pointers into the temporary array. B and F are stored in
+  // column-major order with num_nodes rows and nc*nquad columns.
+  TacsScalar *B = temp;
+  TacsScalar *F = &temp[num_nodes * nc * nquad];
+  TacsScalar *D = &temp[2 * num_nodes * nc * nquad];
+  TacsScalar *K = &D[dsize * nquad];
+
+  memset(D, 0, dsize * nquad * sizeof(TacsScalar));
+
+  for (int n = 0; n < nquad; n++) {
+    // Set the locations for the data pointers
+    const TacsScalar *J = &data[n * (np2 + Jac_nnz)];
+    const TacsScalar *Jac = &data[n * (np2 + Jac_nnz) + np2];
+
+    // Compute the shape functions and their derivatives w.r.t. the
+    // physical coordinates
+    double pt[3];
+    getQuadraturePoint(n, pt);
+    double work[4 * MAX_NUM_NODES];
+    const double *N = getBasisGradientValues(n, pt, work);
+    const double *Nxi = &N[num_nodes];
+
+    TacsScalar *Bn = &B[num_nodes * nc * n];
+    for (int k = 0; k < num_nodes; k++) {
+      Bn[k] = N[k];
+      for (int j = 0; j < num_params; j++) {
+        TacsScalar Nx = 0.0;
+        for (int m = 0; m < num_params; m++) {
+          Nx += Nxi[num_params * k + m] * J[num_params * m + j];
+        }
+        Bn[num_nodes * (j + 1) + k] = Nx;
+      }
+    }
+
+    // Collect the entries for each pair of variables. The value and its
+    // time derivatives all use the shape functions.
+    TacsScalar *Dn = &D[dsize * n];
+    for (int ii = 0; ii < Jac_nnz; ii++) {
+      int ix = Jac_pairs[2 * ii];
+      int jx = Jac_pairs[2 * ii + 1];
+
+      int i = ix / (num_params + 3);
+      int j = jx / (num_params + 3);
+      int ic = ix % (num_params + 3) - 2;
+      int jc = jx % (num_params + 3) - 2;
+      if (ic < 0) {
+        ic = 0;
+      }
+      if (jc < 0) {
+        jc = 0;
+      }
+
+      Dn[nb * (vars_per_node * i + j) + nc * ic + jc] += Jac[ii];
+    }
+  }
+
   for (int i = 0; i < vars_per_node; i++) {
-    field[incr * i] = 0.0;
-    for (int j = 0; j < num_nodes; j++) {
-      field[incr * i] += values[vars_per_node * j + i] * N[j];
+    for (int j = 0; j < vars_per_node; j++) {
+      // Compute F_n = B_n*D_n(i, j) at each quadrature point
+      int nonzero = 0;
+      for (int n = 0; n < nquad; n++) {
+        const TacsScalar *Dn = &D[dsize * n + nb * (vars_per_node * i + j)];
+        const TacsScalar *Bn = &B[num_nodes * nc * n];
+        TacsScalar *Fn = &F[num_nodes * nc * n];
+
+        memset(Fn, 0, num_nodes * nc * sizeof(TacsScalar));
+        for (int ic = 0; ic < nc; ic++) {
+          for (int jc = 0; jc < nc; jc++) {
+            TacsScalar d = Dn[nc * ic + jc];
+            if (d != 0.0) {
+              nonzero = 1;
+              for (int k = 0; k < num_nodes; k++) {
+                Fn[num_nodes * jc + k] += d * Bn[num_nodes * ic + k];
+              }
+            }
+          }
+        }
+      }
+
+      if (nonzero) {
+        // Compute K = F*B^{T} summed over all quadrature points
+        int m = num_nodes;
+        int kdim = nc * nquad;
+        TacsScalar one = 1.0, zero = 0.0;
+        BLASgemm("N", "T", &m, &m, &kdim, &one, F, &m, B, &m, &zero, K, &m);
+
+        // Add the block to the element matrix
+        for (int k = 0; k < num_nodes; k++) {
+          TacsScalar *M = &mat[num_vars * (vars_per_node * k + i) + j];
+          for (int l = 0; l < num_nodes; l++) {
+            M[vars_per_node * l] += K[k + num_nodes * l];
+          }
+        }
+      }
     }
   }
 }
 
+void TACSElementBasis::interpFields(const int n, const double pt[],
+                                    const int vars_per_node,
+                                    const TacsScalar values[], const int incr,
+                                    TacsScalar field[]) {
+  double work[MAX_NUM_NODES];
+  const double *N = getBasisValues(n, pt, work);
+  TacsInterpFields(getNumNodes(), N, vars_per_node, values, incr, field);
+}
+
 void TACSElementBasis::interpFields(const int n, const double pt[],
                                     const int vars_per_node,
                                     const TacsScalar val1[],
@@ -1081,7 +1391,9 @@ void TACSElementBasis::interpFaceFields(const int face, const int n,
                                         const int vars_per_node,
                                         const TacsScalar values[],
                                         const int incr, TacsScalar field[]) {
-  interpFields(-1, pt, vars_per_node, values, incr, field);
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getFaceBasisGradientValues(face, n, pt, work);
+  TacsInterpFields(getNumNodes(), N, vars_per_node, values, incr, field);
 }
 
 void TACSElementBasis::addInterpFieldsTranspose(const int n, const double pt[],
@@ -1089,20 +1401,19 @@ void TACSElementBasis::addInterpFieldsTranspose(const int n, const double pt[],
                                                 const TacsScalar field[],
                                                 const int vars_per_node,
                                                 TacsScalar values[]) {
-  const int num_nodes = getNumNodes();
-  double N[MAX_NUM_NODES];
-  computeBasis(pt, N);
-  for (int i = 0; i < vars_per_node; i++) {
-    for (int j = 0; j < num_nodes; j++) {
-      values[vars_per_node * j + i] += field[incr * i] * N[j];
-    }
-  }
+  double work[MAX_NUM_NODES];
+  const double *N = getBasisValues(n, pt, work);
+  TacsAddInterpFieldsTranspose(getNumNodes(), N, incr, field, vars_per_node,
+                               values);
 }
 
 void TACSElementBasis::addInterpFaceFieldsTranspose(
     const int face, const int n, const double pt[], const int incr,
     const TacsScalar field[], const int vars_per_node, TacsScalar values[]) {
-  addInterpFieldsTranspose(-1, pt, incr, field, vars_per_node, values);
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getFaceBasisGradientValues(face, n, pt, work);
+  TacsAddInterpFieldsTranspose(getNumNodes(), N, incr, field, vars_per_node,
+                               values);
 }
 
 void TACSElementBasis::interpFieldsGrad(const int n, const double pt[],
@@ -1110,20 +1421,10 @@ void TACSElementBasis::interpFieldsGrad(const int n, const double pt[],
                                         const TacsScalar values[],
                                         TacsScalar grad[]) {
   const int num_nodes = getNumNodes();
-  const int num_params = getNumParameters();
-  double N[MAX_NUM_NODES], Nxi[3 * MAX_NUM_NODES];
-  computeBasisGradient(pt, N, Nxi);
-  for (int i = 0; i < vars_per_node; i++) {
-    for (int j = 0; j < num_params; j++) {
-      grad[num_params * i + j] = 0.0;
-    }
-    for (int k = 0; k < num_nodes; k++) {
-      for (int j = 0; j < num_params; j++) {
-        grad[num_params * i + j] +=
-            values[vars_per_node * k + i] * Nxi[num_params * k + j];
-      }
-    }
-  }
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getBasisGradientValues(n, pt, work);
+  TacsInterpFieldsGrad(num_nodes, getNumParameters(), &N[num_nodes],
+                       vars_per_node, values, grad);
 }
 
 void TACSElementBasis::interpFaceFieldsGrad(const int face, const int n,
@@ -1131,7 +1432,11 @@ void TACSElementBasis::interpFaceFieldsGrad(const int face, const int n,
                                             const int vars_per_node,
                                             const TacsScalar values[],
                                             TacsScalar grad[]) {
-  interpFieldsGrad(-1, pt, vars_per_node, values, grad);
+  const int num_nodes = getNumNodes();
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getFaceBasisGradientValues(face, n, pt, work);
+  TacsInterpFieldsGrad(num_nodes, getNumParameters(), &N[num_nodes],
+                       vars_per_node, values, grad);
 }
 
 void TACSElementBasis::addInterpFieldsGradTranspose(int n, const double pt[],
@@ -1139,17 +1444,10 @@ void TACSElementBasis::addInterpFieldsGradTranspose(int n, const double pt[],
                                                     const TacsScalar grad[],
                                                     TacsScalar values[]) {
   const int num_nodes = getNumNodes();
-  const int num_params = getNumParameters();
-  double N[MAX_NUM_NODES], Nxi[3 * MAX_NUM_NODES];
-  computeBasisGradient(pt, N, Nxi);
-  for (int i = 0; i < vars_per_node; i++) {
-    for (int k = 0; k < num_nodes; k++) {
-      for (int j = 0; j < num_params; j++) {
-        values[vars_per_node * k + i] +=
-            grad[num_params * i + j] * Nxi[num_params * k + j];
-      }
-    }
-  }
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getBasisGradientValues(n, pt, work);
+  TacsAddInterpFieldsGradTranspose(num_nodes, getNumParameters(),
+                                   &N[num_nodes], vars_per_node, grad, values);
 }
 
 void TACSElementBasis::addInterpFaceFieldsGradTranspose(const int face, int n,
@@ -1157,7 +1455,11 @@ void TACSElementBasis::addInterpFaceFieldsGradTranspose(const int face, int n,
                                                         const int vars_per_node,
                                                         const TacsScalar grad[],
                                                         TacsScalar values[]) {
-  addInterpFieldsGradTranspose(-1, pt, vars_per_node, grad, values);
+  const int num_nodes = getNumNodes();
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getFaceBasisGradientValues(face, n, pt, work);
+  TacsAddInterpFieldsGradTranspose(num_nodes, getNumParameters(),
+                                   &N[num_nodes], vars_per_node, grad, values);
 }
 
 void TACSElementBasis::addInterpOuterProduct(const int n, const double pt[],
@@ -1166,8 +1468,8 @@ void TACSElementBasis::addInterpOuterProduct(const int n, const double pt[],
                                              const int col_incr,
                                              TacsScalar *mat) {
   const int num_nodes = getNumNodes();
-  double N[MAX_NUM_NODES];
-  computeBasis(pt, N);
+  double work[MAX_NUM_NODES];
+  const double *N = getBasisValues(n, pt, work);
   for (int i = 0; i < num_nodes; i++, mat += row_incr) {
     for (int j = 0; j < num_nodes; j++, mat += col_incr) {
       mat[0] += weight * N[i] * N[j];
@@ -1181,8 +1483,9 @@ void TACSElementBasis::addInterpGradOuterProduct(
     const int col_incr, TacsScalar *mat) {
   const int num_nodes = getNumNodes();
   const int num_params = getNumParameters();
-  double N[MAX_NUM_NODES], Nxi[3 * MAX_NUM_NODES];
-  computeBasisGradient(pt, N, Nxi);
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getBasisGradientValues(n, pt, work);
+  const double *Nxi = &N[num_nodes];
 
   if (transpose) {
     if (num_params == 1) {
@@ -1239,8 +1542,9 @@ void TACSElementBasis::addInterpGradGradOuterProduct(
     const int col_incr, TacsScalar *mat) {
   const int num_nodes = getNumNodes();
   const int num_params = getNumParameters();
-  double N[MAX_NUM_NODES], Nxi[3 * MAX_NUM_NODES];
-  computeBasisGradient(pt, N, Nxi);
+  double work[4 * MAX_NUM_NODES];
+  const double *N = getBasisGradientValues(n, pt, work);
+  const double *Nxi = &N[num_nodes];
 
   if (num_params == 1) {
     for (int i = 0; i < num_nodes; i++, mat += row_incr) {
@@ -15,6 +15,8 @@
 #ifndef TACS_ELEMENT_BASIS_H
 #define TACS_ELEMENT_BASIS_H
 
+#include <atomic>
+
 #include "TACSElementTypes.h"
 #include "TACSObject.h"
 
@@ -25,10 +27,19 @@
   These are designed to provide common quadrature, interpolation, and
   transformation computations needed for finite element computations.
   This is also designed to capture
+
+  The default interpolation routines evaluate the shape functions and
+  their derivatives from tables stored at the volume and face
+  quadrature points. These tables are computed the first time they are
+  needed, so subclasses that override all of the interpolation
+  routines never allocate them.
 */
 
 class TACSElementBasis : public TACSObject {
  public:
+  TACSElementBasis();
+  virtual ~TACSElementBasis();
+
   /**
     Get the layout type
 
@@ -467,6 +478,43 @@ class TACSElementBasis : public TACSObject {
                         TacsScalar temp[], const TacsScalar *px,
                         TacsScalar *py);
 
+  /**
+    Get the size of the temporary array required by addAllWeakMatrices
+
+    @param vars_per_node The number of variables per node
+    @return The size of the temporary array
+  */
+  int getAllWeakMatricesTempSize(const int vars_per_node);
+
+  /**
+    Add the weak form of the matrix from all quadrature points to the
+    element matrix
+
+    The data array has the same layout as the data used in
+    addMatVecProduct(). At each quadrature point, the shape functions
+    and their derivatives w.r.t. the physical coordinates form the rows
+    of the matrix B_n. The entries of the weak form Jacobian are combined
+    into a (num_params+1) x (num_params+1) block D_n for each pair of
+    variables (k, l), so that the contribution to the element matrix is
+
+    mat[k, l] += sum_{n} B_n*D_n(k, l)*B_n^{T}
+
+    The B_n matrices for all quadrature points are stacked so that this
+    sum is evaluated with one matrix-matrix product for each non-zero pair
+    of variables. This gives the same result as calling addWeakMatrix()
+    at each quadrature point, but is much faster for higher-order bases.
+
+    @param vars_per_node The number of variables per node
+    @param Jac_nnz Number of non-zero Jacobian entries
+    @param Jac_paris The (i,j) locations of the Jacobian entries
+    @param data The element data
+    @param temp A temporary array of size getAllWeakMatricesTempSize()
+    @param mat The element matrix
+  */
+  void addAllWeakMatrices(const int vars_per_node, const int Jac_nnz,
+                          const int *Jac_pairs, const TacsScalar *data,
+                          TacsScalar temp[], TacsScalar *mat);
+
   /**
     Interpolate the specified number of fields
 
@@ -732,11 +780,66 @@ class TACSElementBasis : public TACSObject {
   virtual void computeBasisGradient(const double pt[], double N[],
                                     double Nxi[]) = 0;
 
+ protected:
+  /**
+    Get the shape functions at a point
+
+    At a quadrature point (n >= 0) this returns a pointer into the
+    stored table, otherwise the shape functions are computed in the
+    work array.
+
+    @param n The quadrature point index (or -1)
+    @param pt The parametric point
+    @param work Work array of length getNumNodes()
+    @return The shape function values
+  */
+  const double *getBasisValues(const int n, const double pt[], double work[]);
+
+  /**
+    Get the shape functions and their derivatives at a point
+
+    The shape functions are stored first, followed by the derivatives
+    in the same layout as computeBasisGradient().
+
+    @param n The quadrature point index (or -1)
+    @param pt The parametric point
+    @param work Work array of length (1 + getNumParameters())*getNumNodes()
+    @return The shape functions followed by their derivatives
+  */
+  const double *getBasisGradientValues(const int n, const double pt[],
+                                       double work[]);
+
+  /**
+    Get the shape functions and their derivatives at a face point
+
+    @param face The face index
+    @param n The quadrature point index on this face (or -1)
+    @param pt The parametric point
+    @param work Work array of length (1 + getNumParameters())*getNumNodes()
+    @return The shape functions followed by their derivatives
+  */
+  const double *getFaceBasisGradientValues(const int face, const int n,
+                                           const double pt[], double work[]);
+
  private:
+  // Compute the tables of shape functions at the quadrature points
+  void initBasisTables();
+
   // This is the maximum number of nodes (basis functions). This
   // is only used in the default implementation of the interpolatant
   // functions above and should not be accessed by any external class.
   static const int MAX_NUM_NODES = 216;  // = 6**3
+
+  // Shape functions and derivatives at the volume and face quadrature
+  // points. Each point occupies table_size entries, padded so that every
+  // point starts on a cache line.
+  std::atomic<int> tables_ready;
+  pthread_mutex_t table_mutex;
+  int table_size;
+  int num_table_faces;
+  int *face_table_ptr;
+  double *quad_table;
+  double *face_table;
 };
 
 #endif  // TACS_ELEMENT_BASIS_H
@@ -1271,28 +1271,12 @@ void TACSQuarticHexaBasis::addInterpFieldsGradTranspose(int n,
 void TACSQuarticHexaBasis::interpAllFieldsGrad(const int m,
                                                const TacsScalar values[],
                                                TacsScalar out[]) {
-  if (m == 1) {
-    TACSInterpAllTensor3DInterp5VarsPerNode1(Nf, Nfxi, values, out);
-  } else if (m == 3) {
-    TACSInterpAllTensor3DInterp5VarsPerNode3(Nf, Nfxi, values, out);
-  } else if (m == 4) {
-    TACSInterpAllTensor3DInterp5VarsPerNode4(Nf, Nfxi, values, out);
-  } else {
-    TACSInterpAllTensor3DInterp5(m, Nf, Nfxi, values, out);
-  }
+  TacsInterpAllTensor3DSumFactor(m, 5, 5, Nf, Nfxi, values, out);
 }
 
 void TACSQuarticHexaBasis::addInterpAllFieldsGradTranspose(
     const int m, const TacsScalar in[], TacsScalar values[]) {
-  if (m == 1) {
-    TacsAddAllTransTensor3DInterp5VarsPerNode1(Nf, Nfxi, in, values);
-  } else if (m == 3) {
-    TacsAddAllTransTensor3DInterp5VarsPerNode3(Nf, Nfxi, in, values);
-  } else if (m == 4) {
-    TacsAddAllTransTensor3DInterp5VarsPerNode4(Nf, Nfxi, in, values);
-  } else {
-    TacsAddAllTransTensor3DInterp5(m, Nf, Nfxi, in, values);
-  }
+  TacsAddAllTransTensor3DSumFactor(m, 5, 5, Nf, Nfxi, in, values);
 }
 
 /*
@@ -1632,26 +1616,10 @@ void TACSQuinticHexaBasis::addInterpFieldsGradTranspose(int n,
 void TACSQuinticHexaBasis::interpAllFieldsGrad(const int m,
                                                const TacsScalar values[],
                                                TacsScalar out[]) {
-  if (m == 1) {
-    TACSInterpAllTensor3DInterp6VarsPerNode1(Nf, Nfxi, values, out);
-  } else if (m == 3) {
-    TACSInterpAllTensor3DInterp6VarsPerNode3(Nf, Nfxi, values, out);
-  } else if (m == 4) {
-    TACSInterpAllTensor3DInterp6VarsPerNode4(Nf, Nfxi, values, out);
-  } else {
-    TACSInterpAllTensor3DInterp6(m, Nf, Nfxi, values, out);
-  }
+  TacsInterpAllTensor3DSumFactor(m, 6, 6, Nf, Nfxi, values, out);
 }
 
 void TACSQuinticHexaBasis::addInterpAllFieldsGradTranspose(
     const int m, const TacsScalar in[], TacsScalar values[]) {
-  if (m == 1) {
-    TacsAddAllTransTensor3DInterp6VarsPerNode1(Nf, Nfxi, in, values);
-  } else if (m == 3) {
-    TacsAddAllTransTensor3DInterp6VarsPerNode3(Nf, Nfxi, in, values);
-  } else if (m == 4) {
-    TacsAddAllTransTensor3DInterp6VarsPerNode4(Nf, Nfxi, in, values);
-  } else {
-    TacsAddAllTransTensor3DInterp6(m, Nf, Nfxi, in, values);
-  }
+  TacsAddAllTransTensor3DSumFactor(m, 6, 6, Nf, Nfxi, in, values);
 }
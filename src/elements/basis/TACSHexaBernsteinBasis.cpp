@@ -16,6 +16,7 @@
 
 #include "TACSBernsteinInterpolation.h"
 #include "TACSGaussQuadrature.h"
+#include "TACSTensorProductBasisImpl.h"
 
 static void getFaceTangents(int face, double t[]) {
   if (face == 0) {
@@ -72,6 +73,13 @@ static void getFaceTangents(int face, double t[]) {
 /*
   Quadratic Hexa basis class functions
 */
+TACSQuadraticHexaBernsteinBasis::TACSQuadraticHexaBernsteinBasis() {
+  for (int i = 0; i < 3; i++) {
+    TacsBernsteinShapeFuncDerivative(3, TacsGaussQuadPts3[i], &Nf[3 * i],
+                                     &Nfx[3 * i]);
+  }
+}
+
 ElementLayout TACSQuadraticHexaBernsteinBasis::getLayoutType() {
   return TACS_HEXA_QUADRATIC_ELEMENT;
 }
@@ -170,9 +178,26 @@ void TACSQuadraticHexaBernsteinBasis::computeBasisGradient(const double pt[],
   }
 }
 
+void TACSQuadraticHexaBernsteinBasis::interpAllFieldsGrad(
+    const int m, const TacsScalar values[], TacsScalar out[]) {
+  TacsInterpAllTensor3DSumFactor(m, 3, 3, Nf, Nfx, values, out);
+}
+
+void TACSQuadraticHexaBernsteinBasis::addInterpAllFieldsGradTranspose(
+    const int m, const TacsScalar in[], TacsScalar values[]) {
+  TacsAddAllTransTensor3DSumFactor(m, 3, 3, Nf, Nfx, in, values);
+}
+
 /*
   Cubic Hexa basis class functions
 */
+TACSCubicHexaBernsteinBasis::TACSCubicHexaBernsteinBasis() {
+  for (int i = 0; i < 4; i++) {
+    TacsBernsteinShapeFuncDerivative(4, TacsGaussQuadPts4[i], &Nf[4 * i],
+                                     &Nfx[4 * i]);
+  }
+}
+
 ElementLayout TACSCubicHexaBernsteinBasis::getLayoutType() {
   return TACS_HEXA_CUBIC_ELEMENT;
 }
@@ -269,3 +294,13 @@ void TACSCubicHexaBernsteinBasis::computeBasisGradient(const double pt[],
     }
   }
 }
+
+void TACSCubicHexaBernsteinBasis::interpAllFieldsGrad(
+    const int m, const TacsScalar values[], TacsScalar out[]) {
+  TacsInterpAllTensor3DSumFactor(m, 4, 4, Nf, Nfx, values, out);
+}
+
+void TACSCubicHexaBernsteinBasis::addInterpAllFieldsGradTranspose(
+    const int m, const TacsScalar in[], TacsScalar values[]) {
+  TacsAddAllTransTensor3DSumFactor(m, 4, 4, Nf, Nfx, in, values);
+}
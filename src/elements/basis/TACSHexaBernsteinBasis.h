@@ -22,6 +22,7 @@
 */
 class TACSQuadraticHexaBernsteinBasis : public TACSElementBasis {
  public:
+  TACSQuadraticHexaBernsteinBasis();
   ElementLayout getLayoutType();
   void getVisPoint(int n, double pt[]);
   int getNumNodes();
@@ -32,8 +33,15 @@ class TACSQuadraticHexaBernsteinBasis : public TACSElementBasis {
   int getNumElementFaces();
   int getNumFaceQuadraturePoints(int face);
   double getFaceQuadraturePoint(int face, int n, double pt[], double t[]);
+  void interpAllFieldsGrad(const int m, const TacsScalar values[],
+                           TacsScalar out[]);
+  void addInterpAllFieldsGradTranspose(const int m, const TacsScalar in[],
+                                       TacsScalar values[]);
   void computeBasis(const double pt[], double N[]);
   void computeBasisGradient(const double pt[], double N[], double Nxi[]);
+
+ private:
+  double Nf[9], Nfx[9];
 };
 
 /**
@@ -41,6 +49,7 @@ class TACSQuadraticHexaBernsteinBasis : public TACSElementBasis {
 */
 class TACSCubicHexaBernsteinBasis : public TACSElementBasis {
  public:
+  TACSCubicHexaBernsteinBasis();
   ElementLayout getLayoutType();
   void getVisPoint(int n, double pt[]);
   int getNumNodes();
@@ -51,8 +60,15 @@ class TACSCubicHexaBernsteinBasis : public TACSElementBasis {
   int getNumElementFaces();
   int getNumFaceQuadraturePoints(int face);
   double getFaceQuadraturePoint(int face, int n, double pt[], double t[]);
+  void interpAllFieldsGrad(const int m, const TacsScalar values[],
+                           TacsScalar out[]);
+  void addInterpAllFieldsGradTranspose(const int m, const TacsScalar in[],
+                                       TacsScalar values[]);
   void computeBasis(const double pt[], double N[]);
   void computeBasisGradient(const double pt[], double N[], double Nxi[]);
+
+ private:
+  double Nf[16], Nfx[16];
 };
 
 #endif  // TACS_HEXA_BERNSTEIN_BASIS_H
@@ -17,6 +17,7 @@
 #include "TACSBasisMacros.h"
 #include "TACSGaussQuadrature.h"
 #include "TACSLagrangeInterpolation.h"
+#include "TACSTensorProductBasisImpl.h"
 
 static void getEdgeTangent(int edge, double t[]) {
   if (edge == 0) {
@@ -700,6 +701,17 @@ void TACSQuarticQuadBasis::addInterpFieldsGradTranspose(int n,
   }
 }
 
+void TACSQuarticQuadBasis::interpAllFieldsGrad(const int m,
+                                               const TacsScalar values[],
+                                               TacsScalar out[]) {
+  TacsInterpAllTensor2DSumFactor(m, 5, 5, Nf, Nfxi, values, out);
+}
+
+void TACSQuarticQuadBasis::addInterpAllFieldsGradTranspose(
+    const int m, const TacsScalar in[], TacsScalar values[]) {
+  TacsAddAllTransTensor2DSumFactor(m, 5, 5, Nf, Nfxi, in, values);
+}
+
 /*
   Quintic Quad basis class functions
 */
@@ -886,4 +898,15 @@ void TACSQuinticQuadBasis::addInterpFieldsGradTranspose(int n,
       TACS_BASIS_TRANSPOSE_TENSOR2D_ORDER6(n1, n2xi, g[1], temp, m, v);
     }
   }
-}
\ No newline at end of file
+}
+
+void TACSQuinticQuadBasis::interpAllFieldsGrad(const int m,
+                                               const TacsScalar values[],
+                                               TacsScalar out[]) {
+  TacsInterpAllTensor2DSumFactor(m, 6, 6, Nf, Nfxi, values, out);
+}
+
+void TACSQuinticQuadBasis::addInterpAllFieldsGradTranspose(
+    const int m, const TacsScalar in[], TacsScalar values[]) {
+  TacsAddAllTransTensor2DSumFactor(m, 6, 6, Nf, Nfxi, in, values);
+}
@@ -114,6 +114,10 @@ class TACSQuarticQuadBasis : public TACSElementBasis {
                                     const int num_fields,
                                     const TacsScalar grad[],
                                     TacsScalar values[]);
+  void interpAllFieldsGrad(const int m, const TacsScalar values[],
+                           TacsScalar out[]);
+  void addInterpAllFieldsGradTranspose(const int m, const TacsScalar in[],
+                                       TacsScalar values[]);
   void computeBasis(const double pt[], double N[]);
   void computeBasisGradient(const double pt[], double N[], double Nxi[]);
 
@@ -150,6 +154,10 @@ class TACSQuinticQuadBasis : public TACSElementBasis {
                                     const int num_fields,
                                     const TacsScalar grad[],
                                     TacsScalar values[]);
+  void interpAllFieldsGrad(const int m, const TacsScalar values[],
+                           TacsScalar out[]);
+  void addInterpAllFieldsGradTranspose(const int m, const TacsScalar in[],
+                                       TacsScalar values[]);
   void computeBasis(const double pt[], double N[]);
   void computeBasisGradient(const double pt[], double N[], double Nxi[]);
 
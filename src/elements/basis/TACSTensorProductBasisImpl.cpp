@@ -1100,3 +1100,242 @@ void TacsAddAllTransTensor3DInterp6VarsPerNode4(const double N[],
     in += 96;
   }
 }
+
+/*
+  Interpolate the fields and their gradients at all the quadrature
+  points of a 2D tensor-product rule.
+
+  Each field is contracted one direction at a time, so the cost is
+  O(m*p*q*(p + q)) instead of O(m*p^2*q^2) when each quadrature point
+  is evaluated separately.
+*/
+void TacsInterpAllTensor2DSumFactor(const int m, const int p, const int q,
+                                    const double N[], const double Nx[],
+                                    const TacsScalar values[],
+                                    TacsScalar out[]) {
+  // Values after the contraction in the x-direction stored as
+  // A[q*j + a] for node j and quadrature point a
+  TacsScalar A[TACS_SUM_FACTOR_MAX_ORDER * TACS_SUM_FACTOR_MAX_ORDER];
+  TacsScalar Ax[TACS_SUM_FACTOR_MAX_ORDER * TACS_SUM_FACTOR_MAX_ORDER];
+
+  for (int f = 0; f < m; f++) {
+    // Contract over the nodes in the x-direction
+    for (int j = 0; j < p; j++) {
+      const TacsScalar *v = &values[m * p * j + f];
+      for (int a = 0; a < q; a++) {
+        const double *n1 = &N[p * a];
+        const double *n1x = &Nx[p * a];
+        TacsScalar t = 0.0, tx = 0.0;
+        for (int i = 0; i < p; i++) {
+          t += n1[i] * v[m * i];
+          tx += n1x[i] * v[m * i];
+        }
+        A[q * j + a] = t;
+        Ax[q * j + a] = tx;
+      }
+    }
+
+    // Contract over the nodes in the y-direction
+    for (int b = 0; b < q; b++) {
+      const double *n2 = &N[p * b];
+      const double *n2x = &Nx[p * b];
+      for (int a = 0; a < q; a++) {
+        TacsScalar t = 0.0, tx = 0.0, ty = 0.0;
+        for (int j = 0; j < p; j++) {
+          t += n2[j] * A[q * j + a];
+          tx += n2[j] * Ax[q * j + a];
+          ty += n2x[j] * A[q * j + a];
+        }
+
+        TacsScalar *u = &out[3 * m * (q * b + a)];
+        u[f] = t;
+        u[m + 2 * f] = tx;
+        u[m + 2 * f + 1] = ty;
+      }
+    }
+  }
+}
+
+/*
+  Add the transpose of the 2D sum-factorized interpolation
+*/
+void TacsAddAllTransTensor2DSumFactor(const int m, const int p, const int q,
+                                      const double N[], const double Nx[],
+                                      const TacsScalar in[],
+                                      TacsScalar values[]) {
+  TacsScalar A[TACS_SUM_FACTOR_MAX_ORDER * TACS_SUM_FACTOR_MAX_ORDER];
+  TacsScalar Ax[TACS_SUM_FACTOR_MAX_ORDER * TACS_SUM_FACTOR_MAX_ORDER];
+
+  for (int f = 0; f < m; f++) {
+    // Transpose of the contraction in the y-direction
+    memset(A, 0, p * q * sizeof(TacsScalar));
+    memset(Ax, 0, p * q * sizeof(TacsScalar));
+    for (int b = 0; b < q; b++) {
+      const double *n2 = &N[p * b];
+      const double *n2x = &Nx[p * b];
+      for (int a = 0; a < q; a++) {
+        const TacsScalar *u = &in[3 * m * (q * b + a)];
+        for (int j = 0; j < p; j++) {
+          A[q * j + a] += n2[j] * u[f] + n2x[j] * u[m + 2 * f + 1];
+          Ax[q * j + a] += n2[j] * u[m + 2 * f];
+        }
+      }
+    }
+
+    // Transpose of the contraction in the x-direction
+    for (int j = 0; j < p; j++) {
+      TacsScalar *v = &values[m * p * j + f];
+      for (int a = 0; a < q; a++) {
+        const double *n1 = &N[p * a];
+        const double *n1x = &Nx[p * a];
+        for (int i = 0; i < p; i++) {
+          v[m * i] += n1[i] * A[q * j + a] + n1x[i] * Ax[q * j + a];
+        }
+      }
+    }
+  }
+}
+
+/*
+  Interpolate the fields and their gradients at all the quadrature
+  points of a 3D tensor-product rule.
+
+  The cost is O(m*p*q*(p^2 + p*q + q^2)) instead of O(m*p^3*q^3) when
+  each quadrature point is evaluated separately.
+*/
+void TacsInterpAllTensor3DSumFactor(const int m, const int p, const int q,
+                                    const double N[], const double Nx[],
+                                    const TacsScalar values[],
+                                    TacsScalar out[]) {
+  const int size = TACS_SUM_FACTOR_MAX_ORDER * TACS_SUM_FACTOR_MAX_ORDER *
+                   TACS_SUM_FACTOR_MAX_ORDER;
+
+  // Values after the contraction in the x-direction stored as
+  // A[q*(p*k + j) + a] and after the contraction in the y-direction
+  // stored as B[q*(q*k + b) + a]
+  TacsScalar A[size], Ax[size];
+  TacsScalar B[size], Bx[size], By[size];
+
+  for (int f = 0; f < m; f++) {
+    // Contract over the nodes in the x-direction
+    for (int jk = 0; jk < p * p; jk++) {
+      const TacsScalar *v = &values[m * p * jk + f];
+      for (int a = 0; a < q; a++) {
+        const double *n1 = &N[p * a];
+        const double *n1x = &Nx[p * a];
+        TacsScalar t = 0.0, tx = 0.0;
+        for (int i = 0; i < p; i++) {
+          t += n1[i] * v[m * i];
+          tx += n1x[i] * v[m * i];
+        }
+        A[q * jk + a] = t;
+        Ax[q * jk + a] = tx;
+      }
+    }
+
+    // Contract over the nodes in the y-direction
+    for (int k = 0; k < p; k++) {
+      for (int b = 0; b < q; b++) {
+        const double *n2 = &N[p * b];
+        const double *n2x = &Nx[p * b];
+        for (int a = 0; a < q; a++) {
+          TacsScalar t = 0.0, tx = 0.0, ty = 0.0;
+          for (int j = 0; j < p; j++) {
+            const int index = q * (p * k + j) + a;
+            t += n2[j] * A[index];
+            tx += n2[j] * Ax[index];
+            ty += n2x[j] * A[index];
+          }
+          const int index = q * (q * k + b) + a;
+          B[index] = t;
+          Bx[index] = tx;
+          By[index] = ty;
+        }
+      }
+    }
+
+    // Contract over the nodes in the z-direction
+    for (int c = 0; c < q; c++) {
+      const double *n3 = &N[p * c];
+      const double *n3x = &Nx[p * c];
+      for (int ab = 0; ab < q * q; ab++) {
+        TacsScalar t = 0.0, tx = 0.0, ty = 0.0, tz = 0.0;
+        for (int k = 0; k < p; k++) {
+          const int index = q * q * k + ab;
+          t += n3[k] * B[index];
+          tx += n3[k] * Bx[index];
+          ty += n3[k] * By[index];
+          tz += n3x[k] * B[index];
+        }
+
+        TacsScalar *u = &out[4 * m * (q * q * c + ab)];
+        u[f] = t;
+        u[m + 3 * f] = tx;
+        u[m + 3 * f + 1] = ty;
+        u[m + 3 * f + 2] = tz;
+      }
+    }
+  }
+}
+
+/*
+  Add the transpose of the 3D sum-factorized interpolation
+*/
+void TacsAddAllTransTensor3DSumFactor(const int m, const int p, const int q,
+                                      const double N[], const double Nx[],
+                                      const TacsScalar in[],
+                                      TacsScalar values[]) {
+  const int size = TACS_SUM_FACTOR_MAX_ORDER * TACS_SUM_FACTOR_MAX_ORDER *
+                   TACS_SUM_FACTOR_MAX_ORDER;
+  TacsScalar A[size], Ax[size];
+  TacsScalar B[size], Bx[size], By[size];
+
+  for (int f = 0; f < m; f++) {
+    // Transpose of the contraction in the z-direction
+    memset(B, 0, p * q * q * sizeof(TacsScalar));
+    memset(Bx, 0, p * q * q * sizeof(TacsScalar));
+    memset(By, 0, p * q * q * sizeof(TacsScalar));
+    for (int c = 0; c < q; c++) {
+      const double *n3 = &N[p * c];
+      const double *n3x = &Nx[p * c];
+      for (int ab = 0; ab < q * q; ab++) {
+        const TacsScalar *u = &in[4 * m * (q * q * c + ab)];
+        for (int k = 0; k < p; k++) {
+          const int index = q * q * k + ab;
+          B[index] += n3[k] * u[f] + n3x[k] * u[m + 3 * f + 2];
+          Bx[index] += n3[k] * u[m + 3 * f];
+          By[index] += n3[k] * u[m + 3 * f + 1];
+        }
+      }
+    }
+
+    // Transpose of the contraction in the y-direction
+    memset(A, 0, p * p * q * sizeof(TacsScalar));
+    memset(Ax, 0, p * p * q * sizeof(TacsScalar));
+    for (int k = 0; k < p; k++) {
+      for (int b = 0; b < q; b++) {
+        const double *n2 = &N[p * b];
+        const double *n2x = &Nx[p * b];
+        for (int a = 0; a < q; a++) {
+          const int index = q * (q * k + b) + a;
+          for (int j = 0; j < p; j++) {
+            A[q * (p * k + j) + a] += n2[j] * B[index] + n2x[j] * By[index];
+            Ax[q * (p * k + j) + a] += n2[j] * Bx[index];
+          }
+        }
+      }
+    }
+
+    // Transpose of the contraction in the x-direction
+    for (int jk = 0; jk < p * p; jk++) {
+      TacsScalar *v = &values[m * p * jk + f];
+      for (int a = 0; a < q; a++) {
+        const double *n1 = &N[p * a];
+        const double *n1x = &Nx[p * a];
+        for (int i = 0; i < p; i++) {
+          v[m * i] += n1[i] * A[q * jk + a] + n1x[i] * Ax[q * jk + a];
+        }
+      }
+    }
+  }
+}
@@ -1398,4 +1398,34 @@ void TacsAddAllTransTensor3DInterp6VarsPerNode4(const double N[],
                                                 const TacsScalar in[],
                                                 TacsScalar values[]);
 
+/*
+  Sum-factorized tensor product functions for general order
+
+  The one-dimensional shape functions and their derivatives are
+  stored as N[p*a + i] for quadrature point a and node i, where p is
+  the number of nodes and q is the number of quadrature points along
+  each parametric direction (p, q <= TACS_SUM_FACTOR_MAX_ORDER). The
+  values at each quadrature point are the interpolated fields
+  followed by their parametric gradients, the same layout used by
+  TACSElementBasis::interpAllFieldsGrad.
+*/
+#define TACS_SUM_FACTOR_MAX_ORDER 8
+
+void TacsInterpAllTensor2DSumFactor(const int m, const int p, const int q,
+                                    const double N[], const double Nx[],
+                                    const TacsScalar values[],
+                                    TacsScalar out[]);
+void TacsAddAllTransTensor2DSumFactor(const int m, const int p, const int q,
+                                      const double N[], const double Nx[],
+                                      const TacsScalar in[],
+                                      TacsScalar values[]);
+void TacsInterpAllTensor3DSumFactor(const int m, const int p, const int q,
+                                    const double N[], const double Nx[],
+                                    const TacsScalar values[],
+                                    TacsScalar out[]);
+void TacsAddAllTransTensor3DSumFactor(const int m, const int p, const int q,
+                                      const double N[], const double Nx[],
+                                      const TacsScalar in[],
+                                      TacsScalar values[]);
+
 #endif  // TACS_TENSOR_PRODUCT_BASIS_IMPL_H
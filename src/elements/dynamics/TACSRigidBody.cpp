@@ -971,14 +971,23 @@ void TACSRigidBody::addResidual(int elemIndex, double time,
                                 const TacsScalar *Xpts, const TacsScalar *vars,
                                 const TacsScalar *dvars,
                                 const TacsScalar *ddvars, TacsScalar *res) {
-  // Get the acceleration due to gravity
-  const TacsScalar *g;
-  gvec->getVector(&g);
+  TacsScalar C[9], dotC[9], omega[3], domega[3];
+  computeKinematics(vars, dvars, ddvars, C, dotC, omega, domega);
+  addKinematicResidual(vars, dvars, ddvars, C, dotC, omega, domega, res);
+}
 
-  // Set the location and its time derivatives
-  const TacsScalar *v0 = &dvars[0];
-  const TacsScalar *a0 = &ddvars[0];
+/*
+  Compute the rotation matrix, its time derivative and the angular
+  velocity and acceleration from the Euler parameters.
 
+  These quantities are required by both the residual and the Jacobian,
+  so they are computed once for each call to addJacobian.
+*/
+void TACSRigidBody::computeKinematics(const TacsScalar *vars,
+                                      const TacsScalar *dvars,
+                                      const TacsScalar *ddvars, TacsScalar C[],
+                                      TacsScalar dotC[], TacsScalar omega[],
+                                      TacsScalar domega[]) {
   // Set the pointers to the Euler parameters and all their time
   // derivatives
   TacsScalar eta = vars[3];
@@ -989,15 +998,38 @@ void TACSRigidBody::addResidual(int elemIndex, double time,
   const TacsScalar *ddeps = &ddvars[4];
 
   // Compute the rotation matrix
-  TacsScalar C[9], dotC[9];
   computeRotationMat(eta, eps, C);
   computeRotationMatDeriv(eta, eps, deta, deps, dotC);
 
   // Compute the angular velocity and acceleration from the Euler
   // parameters
-  TacsScalar omega[3], domega[3];
   computeSRateProduct(eta, eps, deta, deps, omega);
   computeSRateProduct(eta, eps, ddeta, ddeps, domega);
+}
+
+/*
+  Add the residual of the governing equations given the rotation
+  matrix, its time derivative and the angular velocity and
+  acceleration computed by computeKinematics.
+*/
+void TACSRigidBody::addKinematicResidual(
+    const TacsScalar *vars, const TacsScalar *dvars, const TacsScalar *ddvars,
+    const TacsScalar C[], const TacsScalar dotC[], const TacsScalar omega[],
+    const TacsScalar domega[], TacsScalar *res) {
+  // Get the acceleration due to gravity
+  const TacsScalar *g;
+  gvec->getVector(&g);
+
+  // Set the location and its time derivatives
+  const TacsScalar *v0 = &dvars[0];
+  const TacsScalar *a0 = &ddvars[0];
+
+  // Set the pointers to the Euler parameters and their first time
+  // derivatives
+  TacsScalar eta = vars[3];
+  TacsScalar deta = dvars[3];
+  const TacsScalar *eps = &vars[4];
+  const TacsScalar *deps = &dvars[4];
 
   // Compute C^{T}*c^{x}*domega
   TacsScalar t1[3], t2[3];
@@ -1064,7 +1096,11 @@ void TACSRigidBody::addJacobian(int elemIndex, double time, TacsScalar alpha,
                                 const TacsScalar *dvars,
                                 const TacsScalar *ddvars, TacsScalar *res,
                                 TacsScalar *mat) {
-  addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, res);
+  // Compute the rotation matrix and angular rates once and use them
+  // for both the residual and the Jacobian
+  TacsScalar C[9], dotC[9], omega[3], domega[3];
+  computeKinematics(vars, dvars, ddvars, C, dotC, omega, domega);
+  addKinematicResidual(vars, dvars, ddvars, C, dotC, omega, domega, res);
 
   // Get the acceleration due to gravity
   const TacsScalar *g;
@@ -1083,23 +1119,12 @@ void TACSRigidBody::addJacobian(int elemIndex, double time, TacsScalar alpha,
   TacsScalar ddeta = ddvars[3];
   const TacsScalar *ddeps = &ddvars[4];
 
-  // Compute the rotation matrix
-  TacsScalar C[9], dotC[9];
-  computeRotationMat(eta, eps, C);
-  computeRotationMatDeriv(eta, eps, deta, deps, dotC);
-
   // Compute the rotation rate matrices
   TacsScalar S[12], Sdot[12], Sddot[12];
   computeSRateMat(eta, eps, S);
   computeSRateMat(deta, deps, Sdot);
   computeSRateMat(ddeta, ddeps, Sddot);
 
-  // Compute the angular velocity and acceleration from the Euler
-  // parameters
-  TacsScalar omega[3], domega[3];
-  computeSRateProduct(eta, eps, deta, deps, omega);
-  computeSRateProduct(eta, eps, ddeta, ddeps, domega);
-
   // Add the components from the position governing equation
   // -------------------------------------------------------
   mat[0] += gamma * mass;
@@ -197,6 +197,16 @@ class TACSRigidBody : public TACSElement {
   // Recompute the inertial properties in the global ref. frame
   void updateInertialProperties();
 
+  // Compute the kinematic quantities shared by the residual/Jacobian
+  void computeKinematics(const TacsScalar vars[], const TacsScalar dvars[],
+                         const TacsScalar ddvars[], TacsScalar C[],
+                         TacsScalar dotC[], TacsScalar omega[],
+                         TacsScalar domega[]);
+  void addKinematicResidual(const TacsScalar vars[], const TacsScalar dvars[],
+                            const TacsScalar ddvars[], const TacsScalar C[],
+                            const TacsScalar dotC[], const TacsScalar omega[],
+                            const TacsScalar domega[], TacsScalar res[]);
+
   // The inertial properties in the global reference frame
   TacsScalar mass;  // The mass of the rigid body
   TacsScalar c[3];  // The first moment of inertia
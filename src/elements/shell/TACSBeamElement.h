@@ -10,10 +10,12 @@
 #include "TACSBeamInertialForce.h"
 #include "TACSBeamTraction.h"
 #include "TACSBeamUtilities.h"
+#include "TACSDirector.h"
 #include "TACSElement.h"
 #include "TACSElementAlgebra.h"
 #include "TACSElementTypes.h"
 #include "TACSGaussQuadrature.h"
+#include "TACSScratchArena.h"
 #include "a2d.h"
 
 /*
@@ -215,21 +217,35 @@ class TACSBeamElement : public TACSElement {
                    const TacsScalar *vars, const TacsScalar *dvars,
                    const TacsScalar *ddvars, TacsScalar *res);
 
-  // void addJacobian( int elemIndex, double time,
-  //                   TacsScalar alpha,
-  //                   TacsScalar beta,
-  //                   TacsScalar gamma,
-  //                   const TacsScalar Xpts[],
-  //                   const TacsScalar vars[],
-  //                   const TacsScalar dvars[],
-  //                   const TacsScalar ddvars[],
-  //                   TacsScalar res[],
-  //                   TacsScalar mat[] );
+  void addJacobian(int elemIndex, double time, TacsScalar alpha,
+                   TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+                   const TacsScalar vars[], const TacsScalar dvars[],
+                   const TacsScalar ddvars[], TacsScalar res[],
+                   TacsScalar mat[]);
+
+  void addJacobianBatch(int numElems, const int elemIndex[], double time,
+                        TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar res[], TacsScalar mat[]);
 
   void getMatType(ElementMatrixType matType, int elemIndex, double time,
                   const TacsScalar Xpts[], const TacsScalar vars[],
                   TacsScalar mat[]);
 
+  void getMatVecDataSizes(ElementMatrixType matType, int elemIndex,
+                          int *_data_size, int *_temp_size);
+
+  void getMatVecProductData(ElementMatrixType matType, int elemIndex,
+                            double time, TacsScalar alpha, TacsScalar beta,
+                            TacsScalar gamma, const TacsScalar Xpts[],
+                            const TacsScalar vars[], const TacsScalar dvars[],
+                            const TacsScalar ddvars[], TacsScalar data[]);
+
+  void addMatVecProduct(ElementMatrixType matType, int elemIndex,
+                        const TacsScalar data[], TacsScalar temp[],
+                        const TacsScalar px[], TacsScalar py[]);
+
   void addAdjResProduct(int elemIndex, double time, TacsScalar scale,
                         const TacsScalar psi[], const TacsScalar Xpts[],
                         const TacsScalar vars[], const TacsScalar dvars[],
@@ -282,6 +298,34 @@ class TACSBeamElement : public TACSElement {
   static const int dsize = 3 * basis::NUM_NODES;
   static const int csize = 9 * basis::NUM_NODES;
 
+  // The size of the matrix-free data stored at each quadrature point
+  static const int matvec_quad_size =
+      21 + TACSBeamConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES + 6;
+
+  // Is the residual linear in the element variables?
+  static bool isLinearKinematics() {
+    return (typeid(model) == typeid(TACSBeamLinearModel) &&
+            typeid(director) == typeid(TACSLinearizedRotation));
+  }
+
+  // The number of Jacobian columns computed together in addJacobian()
+  static const int jac_lanes = 4;
+
+  // Compute the matrix-free data at the quadrature points from the
+  // node locations and the node normals
+  void computeMatVecQuadData(int elemIndex, TacsScalar alpha,
+                             TacsScalar gamma, const TacsScalar Xpts[],
+                             const TacsScalar fn1[], const TacsScalar fn2[],
+                             TacsScalar qdata[]);
+
+  // Add the linear Jacobian computed from the matrix-free data
+  void addJacobianFromData(const TacsScalar data[], TacsScalar mat[]);
+
+  // Add the products of the linear Jacobian with a packed set of vectors
+  template <int lanes>
+  void addPackedMatVecProduct(const TacsScalar data[], const TacsScalar px[],
+                              TacsScalar py[]);
+
   TACSBeamTransform *transform;
   TACSBeamConstitutive *con;
 };
@@ -675,6 +719,122 @@ void TACSBeamElement<quadrature, basis, director, model>::addResidual(
       vars, res);
 }
 
+/*
+  Add the residual and the Jacobian of the beam element.
+
+  For a beam with linear kinematics, the Jacobian is computed from the
+  matrix-free product data, jac_lanes columns at a time, using the packed
+  A2D operations. Otherwise, the default finite-difference Jacobian is
+  used.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::addJacobian(
+    int elemIndex, double time, TacsScalar alpha, TacsScalar beta,
+    TacsScalar gamma, const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar res[],
+    TacsScalar mat[]) {
+  if (!isLinearKinematics()) {
+    TACSElement::addJacobian(elemIndex, time, alpha, beta, gamma, Xpts, vars,
+                             dvars, ddvars, res, mat);
+    return;
+  }
+
+  if (res) {
+    addResidual(elemIndex, time, Xpts, vars, dvars, ddvars, res);
+  }
+
+  // Compute the transformations and scaled constitutive data
+  TacsScalar data[9 * num_nodes +
+                  quadrature::NUM_QUADRATURE_POINTS * matvec_quad_size];
+  getMatVecProductData(TACS_JACOBIAN_MATRIX, elemIndex, time, alpha, beta,
+                       gamma, Xpts, vars, dvars, ddvars, data);
+  addJacobianFromData(data, mat);
+}
+
+/*
+  Add the residuals and the Jacobians for a batch of beam elements.
+
+  For linear kinematics, the node normals of the whole batch are
+  computed together with the batched small-matrix kernels, since the
+  elements share the reference axis of the transform. The Jacobian of
+  each element is then computed from its matrix-free data in the same
+  way as addJacobian().
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::addJacobianBatch(
+    int numElems, const int elemIndex[], double time, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar res[], TacsScalar mat[]) {
+  if (!isLinearKinematics()) {
+    TACSElement::addJacobianBatch(numElems, elemIndex, time, alpha, beta,
+                                  gamma, Xpts, vars, dvars, ddvars, res, mat);
+    return;
+  }
+
+  const int nvars = vars_per_node * num_nodes;
+  const int data_size =
+      9 * num_nodes + quadrature::NUM_QUADRATURE_POINTS * matvec_quad_size;
+
+  // Compute the node normals for the batch
+  TACSScratchScope scratch;
+  TacsScalar *fn1 = scratch.allocScalars(16 * numElems * num_nodes);
+  TacsScalar *fn2 = &fn1[3 * numElems * num_nodes];
+  TacsScalar *work = &fn1[6 * numElems * num_nodes];
+  const A2D::Vec3 &axis = transform->getRefAxis();
+  TacsBeamComputeNodeNormalsBatch<basis>(numElems, Xpts, axis, fn1, fn2,
+                                         work);
+
+  TacsScalar *data = scratch.allocScalars(data_size);
+  for (int k = 0; k < numElems; k++) {
+    const TacsScalar *X = &Xpts[3 * num_nodes * k];
+    if (res) {
+      addResidual(elemIndex[k], time, X, &vars[nvars * k], &dvars[nvars * k],
+                  &ddvars[nvars * k], &res[nvars * k]);
+    }
+
+    // Set the matrix-free data for this element
+    memcpy(data, X, 3 * num_nodes * sizeof(TacsScalar));
+    memcpy(&data[3 * num_nodes], &fn1[3 * num_nodes * k],
+           3 * num_nodes * sizeof(TacsScalar));
+    memcpy(&data[6 * num_nodes], &fn2[3 * num_nodes * k],
+           3 * num_nodes * sizeof(TacsScalar));
+    computeMatVecQuadData(elemIndex[k], alpha, gamma, X,
+                          &data[3 * num_nodes], &data[6 * num_nodes],
+                          &data[9 * num_nodes]);
+
+    addJacobianFromData(data, &mat[nvars * nvars * k]);
+  }
+}
+
+/*
+  Add the linear Jacobian computed from the matrix-free data
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::addJacobianFromData(
+    const TacsScalar data[], TacsScalar mat[]) {
+  const int nvars = vars_per_node * num_nodes;
+
+  // Compute the columns of the Jacobian from the products with the
+  // unit vectors, stored with the lane index varying fastest
+  TacsScalar px[jac_lanes * nvars], py[jac_lanes * nvars];
+  for (int j = 0; j < nvars; j += jac_lanes) {
+    memset(px, 0, jac_lanes * nvars * sizeof(TacsScalar));
+    memset(py, 0, jac_lanes * nvars * sizeof(TacsScalar));
+    for (int k = 0; k < jac_lanes && j + k < nvars; k++) {
+      px[jac_lanes * (j + k) + k] = 1.0;
+    }
+
+    addPackedMatVecProduct<jac_lanes>(data, px, py);
+
+    for (int i = 0; i < nvars; i++) {
+      for (int k = 0; k < jac_lanes && j + k < nvars; k++) {
+        mat[nvars * i + j + k] += py[jac_lanes * i + k];
+      }
+    }
+  }
+}
+
 template <class quadrature, class basis, class director, class model>
 void TACSBeamElement<quadrature, basis, director, model>::getMatType(
     ElementMatrixType matType, int elemIndex, double time,
@@ -701,6 +861,420 @@ void TACSBeamElement<quadrature, basis, director, model>::getMatType(
               mat);
 }
 
+/*
+  Get the sizes of the data for a matrix-free product with the Jacobian.
+
+  For a beam with linear kinematics, the node normals and, at each
+  quadrature point, the transformations, the scaled tangent stiffness
+  and the scaled mass moments are stored. The product is then computed
+  at the quadrature points without forming the element matrix.
+  Otherwise, the states are stored and the product is computed as a
+  directional derivative of the residual.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::getMatVecDataSizes(
+    ElementMatrixType matType, int elemIndex, int *_data_size,
+    int *_temp_size) {
+  const int nvars = vars_per_node * num_nodes;
+  if (matType != TACS_JACOBIAN_MATRIX) {
+    *_data_size = 0;
+    *_temp_size = 0;
+  } else if (isLinearKinematics()) {
+    const int nquad = quadrature::getNumQuadraturePoints();
+    *_data_size = 9 * num_nodes + nquad * matvec_quad_size;
+    *_temp_size = 0;
+  } else {
+    *_data_size = 4 + 3 * num_nodes + 3 * nvars;
+    *_temp_size = 4 * nvars;
+  }
+}
+
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::getMatVecProductData(
+    ElementMatrixType matType, int elemIndex, double time, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar data[]) {
+  if (matType != TACS_JACOBIAN_MATRIX || !data) {
+    return;
+  }
+
+  const int nvars = vars_per_node * num_nodes;
+  if (!isLinearKinematics()) {
+    // Store the time, the coefficients and the states
+    data[0] = time;
+    data[1] = alpha;
+    data[2] = beta;
+    data[3] = gamma;
+    memcpy(&data[4], Xpts, 3 * num_nodes * sizeof(TacsScalar));
+    memcpy(&data[4 + 3 * num_nodes], vars, nvars * sizeof(TacsScalar));
+    memcpy(&data[4 + 3 * num_nodes + nvars], dvars, nvars * sizeof(TacsScalar));
+    memcpy(&data[4 + 3 * num_nodes + 2 * nvars], ddvars,
+           nvars * sizeof(TacsScalar));
+    return;
+  }
+
+  // Get the reference axis
+  const A2D::Vec3 &axis = transform->getRefAxis();
+
+  // Store the node locations and the normal directions
+  TacsScalar *fn1 = &data[3 * num_nodes];
+  TacsScalar *fn2 = &data[6 * num_nodes];
+  memcpy(data, Xpts, 3 * num_nodes * sizeof(TacsScalar));
+  TacsBeamComputeNodeNormals<basis>(Xpts, axis, fn1, fn2);
+
+  computeMatVecQuadData(elemIndex, alpha, gamma, Xpts, fn1, fn2,
+                        &data[9 * num_nodes]);
+}
+
+/*
+  Compute the transformations, the scaled tangent stiffness and the
+  scaled mass moments at each quadrature point
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::computeMatVecQuadData(
+    int elemIndex, TacsScalar alpha, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar fn1[], const TacsScalar fn2[], TacsScalar qdata[]) {
+  // Compute the number of quadrature points
+  const int nquad = quadrature::getNumQuadraturePoints();
+
+  for (int quad_index = 0; quad_index < nquad; quad_index++) {
+    // Get the quadrature weight
+    double pt[3];
+    double weight = quadrature::getQuadraturePoint(quad_index, pt);
+
+    // Interpolate the geometry fields
+    A2D::Vec3 X0, X0xi, n1, n2, n1xi, n2xi;
+    basis::template interpFields<3, 3>(pt, Xpts, X0.x);
+    basis::template interpFieldsGrad<3, 3>(pt, Xpts, X0xi.x);
+    basis::template interpFields<3, 3>(pt, fn1, n1.x);
+    basis::template interpFields<3, 3>(pt, fn2, n2.x);
+    basis::template interpFieldsGrad<3, 3>(pt, fn1, n1xi.x);
+    basis::template interpFieldsGrad<3, 3>(pt, fn2, n2xi.x);
+
+    // Compute the transformation at the quadrature point
+    A2D::Mat3x3 T;
+    transform->computeTransform(X0xi.x, T.A);
+
+    // Compute the inverse and the determinant of the transform
+    A2D::Mat3x3 Xd, Xdinv;
+    A2D::Mat3x3FromThreeVec3 assembleXd(X0xi, n1, n2, Xd);
+    A2D::Mat3x3Inverse invXd(Xd, Xdinv);
+    A2D::Scalar detXd;
+    A2D::Mat3x3Det computedetXd(weight, Xd, detXd);
+
+    // Compute XdinvT = Xdinv * T
+    A2D::Mat3x3 XdinvT;
+    A2D::Mat3x3MatMult multXdinvT(Xdinv, T, XdinvT);
+
+    // Compute s0, sz1 and sz2
+    A2D::Scalar s0, sz1, sz2;
+    A2D::Vec3 e1(1.0, 0.0, 0.0);
+    A2D::Mat3x3VecVecInnerProduct inners0(XdinvT, e1, e1, s0);
+    A2D::Mat3x3VecVecInnerProduct innersz1(Xdinv, e1, n1xi, sz1);
+    A2D::Mat3x3VecVecInnerProduct innersz2(Xdinv, e1, n2xi, sz2);
+
+    // Store the transformations
+    memcpy(&qdata[0], T.A, 9 * sizeof(TacsScalar));
+    memcpy(&qdata[9], XdinvT.A, 9 * sizeof(TacsScalar));
+    qdata[18] = s0.value;
+    qdata[19] = sz1.value;
+    qdata[20] = sz2.value;
+
+    // Store the scaled tangent stiffness and mass moments
+    TacsScalar *C = &qdata[21];
+    con->evalTangentStiffness(elemIndex, pt, X0.x, C);
+    for (int i = 0; i < TACSBeamConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES;
+         i++) {
+      C[i] *= alpha * detXd.value;
+    }
+
+    TacsScalar *rho =
+        &qdata[21 + TACSBeamConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES];
+    con->evalMassMoments(elemIndex, pt, X0.x, rho);
+    for (int i = 0; i < 6; i++) {
+      rho[i] *= gamma * detXd.value;
+    }
+
+    qdata += matvec_quad_size;
+  }
+}
+
+template <class quadrature, class basis, class director, class model>
+void TACSBeamElement<quadrature, basis, director, model>::addMatVecProduct(
+    ElementMatrixType matType, int elemIndex, const TacsScalar data[],
+    TacsScalar temp[], const TacsScalar px[], TacsScalar py[]) {
+  if (matType != TACS_JACOBIAN_MATRIX) {
+    return;
+  }
+
+  const int nvars = vars_per_node * num_nodes;
+  if (!isLinearKinematics()) {
+    // The step length
+#ifdef TACS_USE_COMPLEX
+    const double dh = 1e-30;
+#else
+    const double dh = 1e-7;
+#endif  // TACS_USE_COMPLEX
+
+    // Compute the directional derivative of the residual in the
+    // direction (alpha*px, beta*px, gamma*px)
+    double time = TacsRealPart(data[0]);
+    const TacsScalar *Xpts = &data[4];
+    const TacsScalar *vars = &data[4 + 3 * num_nodes];
+    const TacsScalar *dvars = &data[4 + 3 * num_nodes + nvars];
+    const TacsScalar *ddvars = &data[4 + 3 * num_nodes + 2 * nvars];
+    TacsScalar *q = &temp[0];
+    TacsScalar *qdot = &temp[nvars];
+    TacsScalar *qddot = &temp[2 * nvars];
+    TacsScalar *res = &temp[3 * nvars];
+
+#ifdef TACS_USE_COMPLEX
+    for (int i = 0; i < nvars; i++) {
+      q[i] = vars[i] + TacsScalar(0.0, dh) * data[1] * px[i];
+      qdot[i] = dvars[i] + TacsScalar(0.0, dh) * data[2] * px[i];
+      qddot[i] = ddvars[i] + TacsScalar(0.0, dh) * data[3] * px[i];
+    }
+    memset(res, 0, nvars * sizeof(TacsScalar));
+    addResidual(elemIndex, time, Xpts, q, qdot, qddot, res);
+    for (int i = 0; i < nvars; i++) {
+      py[i] += TacsImagPart(res[i]) / dh;
+    }
+#else
+    for (int k = 0; k < 2; k++) {
+      double h = (k == 0 ? dh : -dh);
+      for (int i = 0; i < nvars; i++) {
+        q[i] = vars[i] + h * data[1] * px[i];
+        qdot[i] = dvars[i] + h * data[2] * px[i];
+        qddot[i] = ddvars[i] + h * data[3] * px[i];
+      }
+      memset(res, 0, nvars * sizeof(TacsScalar));
+      addResidual(elemIndex, time, Xpts, q, qdot, qddot, res);
+      for (int i = 0; i < nvars; i++) {
+        py[i] += 0.5 * res[i] / h;
+      }
+    }
+#endif  // TACS_USE_COMPLEX
+    return;
+  }
+
+  addPackedMatVecProduct<1>(data, px, py);
+}
+
+/*
+  Add the products of the Jacobian of a beam with linear kinematics with
+  a set of vectors, using the data from getMatVecProductData().
+
+  The vectors px and py store the entries of the lanes with the lane
+  index varying fastest, so that px[lanes * i + k] is the i-th entry of
+  the k-th vector. The fields at the quadrature points are interpolated
+  for all lanes at once and the A2D kernels are evaluated with the
+  packed operations.
+*/
+template <class quadrature, class basis, class director, class model>
+template <int lanes>
+void TACSBeamElement<quadrature, basis, director, model>::
+    addPackedMatVecProduct(const TacsScalar data[], const TacsScalar px[],
+                           TacsScalar py[]) {
+  const int nvars = vars_per_node * num_nodes;
+  const int ntying = basis::NUM_TYING_POINTS;
+
+  // Compute the number of quadrature points
+  const int nquad = quadrature::getNumQuadraturePoints();
+
+  // Set pointers into the element data
+  const TacsScalar *Xpts = &data[0];
+  const TacsScalar *fn1 = &data[3 * num_nodes];
+  const TacsScalar *fn2 = &data[6 * num_nodes];
+  const TacsScalar *qdata = &data[9 * num_nodes];
+
+  // The residual is linear in the variables, so the product is the
+  // residual evaluated at px with the stored tangent stiffness and
+  // mass moments. The directors and their second time derivatives are
+  // both the directors computed from px. The directors are packed by
+  // lane, while the tying strain is stored separately for each lane.
+  TacsScalar d1[lanes * dsize], d1ddot[lanes * dsize];
+  TacsScalar d2[lanes * dsize], d2ddot[lanes * dsize];
+  TacsScalar ety[lanes * ntying], dety[lanes * ntying];
+  for (int k = 0; k < lanes; k++) {
+    TacsScalar p[nvars];
+    TacsScalar d1k[dsize], d1ddotk[dsize], d2k[dsize], d2ddotk[dsize];
+    for (int i = 0; i < nvars; i++) {
+      p[i] = px[lanes * i + k];
+    }
+    director::template computeDirectorRates<vars_per_node, offset,
+                                            basis::NUM_NODES>(p, p, fn1, d1k,
+                                                              d1ddotk);
+    director::template computeDirectorRates<vars_per_node, offset,
+                                            basis::NUM_NODES>(p, p, fn2, d2k,
+                                                              d2ddotk);
+    model::template computeTyingStrain<vars_per_node, basis>(
+        Xpts, fn1, fn2, p, d1k, d2k, &ety[ntying * k]);
+
+    for (int i = 0; i < dsize; i++) {
+      d1[lanes * i + k] = d1k[i];
+      d1ddot[lanes * i + k] = d1ddotk[i];
+      d2[lanes * i + k] = d2k[i];
+      d2ddot[lanes * i + k] = d2ddotk[i];
+    }
+  }
+
+  // The contributions to the products and the director fields
+  TacsScalar y[lanes * nvars], d1d[lanes * dsize], d2d[lanes * dsize];
+  memset(y, 0, lanes * nvars * sizeof(TacsScalar));
+  memset(d1d, 0, lanes * dsize * sizeof(TacsScalar));
+  memset(d2d, 0, lanes * dsize * sizeof(TacsScalar));
+  memset(dety, 0, lanes * ntying * sizeof(TacsScalar));
+
+  for (int quad_index = 0; quad_index < nquad; quad_index++) {
+    double pt[3];
+    quadrature::getQuadraturePoint(quad_index, pt);
+
+    // Retrieve the data at this quadrature point
+    A2D::Mat3x3 T(&qdata[0]), XdinvT(&qdata[9]);
+    A2D::Scalar s0(qdata[18]), sz1(qdata[19]), sz2(qdata[20]);
+    const TacsScalar *C = &qdata[21];
+    const TacsScalar *rho =
+        &qdata[21 + TACSBeamConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES];
+
+    // Interpolate the solution fields for all lanes
+    A2D::ADVec3Pack<lanes> u0xi, d01, d02, d01xi, d02xi;
+    basis::template interpFieldsGrad<lanes * vars_per_node, 3 * lanes>(
+        pt, px, u0xi.x);
+    basis::template interpFields<3 * lanes, 3 * lanes>(pt, d1, d01.x);
+    basis::template interpFields<3 * lanes, 3 * lanes>(pt, d2, d02.x);
+    basis::template interpFieldsGrad<3 * lanes, 3 * lanes>(pt, d1, d01xi.x);
+    basis::template interpFieldsGrad<3 * lanes, 3 * lanes>(pt, d2, d02xi.x);
+
+    // Compute u0x = T^{T} * u0d * XdinvT
+    A2D::ADMat3x3Pack<lanes> u0d, u0dXdinvT, u0x;
+    A2D::ADMat3x3FromThreeADVec3Pack<lanes> assembleu0d(u0xi, d01, d02, u0d);
+    A2D::ADMat3x3MatMultPack<lanes> multu0d(u0d, XdinvT, u0dXdinvT);
+    A2D::MatTrans3x3ADMatMultPack<lanes> multu0x(T, u0dXdinvT, u0x);
+
+    // Compute d1x = s0 * T^{T} * (d1xi - sz1 * u0xi)
+    A2D::ADVec3Pack<lanes> d1t, d1x;
+    A2D::ADVec3ADVecScalarAxpyPack<lanes> axpyd1t(-1.0, sz1, u0xi, d01xi,
+                                                  d1t);
+    A2D::MatTrans3x3ADVecMultScalePack<lanes> matmultd1x(s0, T, d1t, d1x);
+
+    // Compute d2x = s0 * T^{T} * (d2xi - sz2 * u0xi)
+    A2D::ADVec3Pack<lanes> d2t, d2x;
+    A2D::ADVec3ADVecScalarAxpyPack<lanes> axpyd2t(-1.0, sz2, u0xi, d02xi,
+                                                  d2t);
+    A2D::MatTrans3x3ADVecMultScalePack<lanes> matmultd2x(s0, T, d2t, d2x);
+
+    // Evaluate the strain and the stress from the scaled tangent
+    // stiffness in each lane
+    for (int k = 0; k < lanes; k++) {
+      TacsScalar u0xk[9], d1xk[3], d2xk[3];
+      for (int i = 0; i < 9; i++) {
+        u0xk[i] = u0x.A[lanes * i + k];
+      }
+      for (int i = 0; i < 3; i++) {
+        d1xk[i] = d1x.x[lanes * i + k];
+        d2xk[i] = d2x.x[lanes * i + k];
+      }
+
+      // Evaluate the tying components of the strain
+      TacsScalar gty[2], e0ty[2], de0ty[2];
+      basis::interpTyingStrain(pt, &ety[ntying * k], gty);
+      e0ty[0] = 2.0 * XdinvT.A[0] * gty[0];
+      e0ty[1] = 2.0 * XdinvT.A[0] * gty[1];
+
+      TacsScalar e[6], s[6];
+      model::evalStrain(u0xk, d1xk, d2xk, e0ty, e);
+      TACSBeamConstitutive::computeStress(C, e, s);
+
+      TacsScalar du0xk[9], dd1xk[3], dd2xk[3];
+      model::evalStrainSens(1.0, s, u0xk, d1xk, d2xk, e0ty, du0xk, dd1xk,
+                            dd2xk, de0ty);
+      for (int i = 0; i < 9; i++) {
+        u0x.Ad[lanes * i + k] = du0xk[i];
+      }
+      for (int i = 0; i < 3; i++) {
+        d1x.xd[lanes * i + k] = dd1xk[i];
+        d2x.xd[lanes * i + k] = dd2xk[i];
+      }
+
+      TacsScalar dgty[2];
+      dgty[0] = 2.0 * XdinvT.A[0] * de0ty[0];
+      dgty[1] = 2.0 * XdinvT.A[0] * de0ty[1];
+      basis::addInterpTyingStrainTranspose(pt, dgty, &dety[ntying * k]);
+    }
+
+    matmultd2x.reverse();
+    axpyd2t.reverse();
+    matmultd1x.reverse();
+    axpyd1t.reverse();
+    multu0x.reverse();
+    multu0d.reverse();
+    assembleu0d.reverse();
+
+    basis::template addInterpFieldsGradTranspose<lanes * vars_per_node,
+                                                 3 * lanes>(pt, u0xi.xd, y);
+    basis::template addInterpFieldsTranspose<3 * lanes, 3 * lanes>(
+        pt, d01.xd, d1d);
+    basis::template addInterpFieldsTranspose<3 * lanes, 3 * lanes>(
+        pt, d02.xd, d2d);
+    basis::template addInterpFieldsGradTranspose<3 * lanes, 3 * lanes>(
+        pt, d01xi.xd, d1d);
+    basis::template addInterpFieldsGradTranspose<3 * lanes, 3 * lanes>(
+        pt, d02xi.xd, d2d);
+
+    // Add the contributions from the scaled mass moments
+    TacsScalar u0ddot[3 * lanes], d01ddot[3 * lanes], d02ddot[3 * lanes];
+    basis::template interpFields<lanes * vars_per_node, 3 * lanes>(pt, px,
+                                                                   u0ddot);
+    basis::template interpFields<3 * lanes, 3 * lanes>(pt, d1ddot, d01ddot);
+    basis::template interpFields<3 * lanes, 3 * lanes>(pt, d2ddot, d02ddot);
+
+    TacsScalar du0[3 * lanes], dd01[3 * lanes], dd02[3 * lanes];
+    for (int i = 0; i < 3 * lanes; i++) {
+      du0[i] = rho[0] * u0ddot[i] + rho[1] * d01ddot[i] + rho[2] * d02ddot[i];
+      dd01[i] = rho[1] * u0ddot[i] + rho[3] * d01ddot[i] + rho[5] * d02ddot[i];
+      dd02[i] = rho[2] * u0ddot[i] + rho[5] * d01ddot[i] + rho[4] * d02ddot[i];
+    }
+    basis::template addInterpFieldsTranspose<lanes * vars_per_node,
+                                             3 * lanes>(pt, du0, y);
+    basis::template addInterpFieldsTranspose<3 * lanes, 3 * lanes>(pt, dd01,
+                                                                   d1d);
+    basis::template addInterpFieldsTranspose<3 * lanes, 3 * lanes>(pt, dd02,
+                                                                   d2d);
+
+    qdata += matvec_quad_size;
+  }
+
+  // Add the contributions from the tying strain and the director fields
+  // in each lane
+  for (int k = 0; k < lanes; k++) {
+    TacsScalar p[nvars], yk[nvars];
+    TacsScalar d1k[dsize], d2k[dsize], d1dk[dsize], d2dk[dsize];
+    for (int i = 0; i < nvars; i++) {
+      p[i] = px[lanes * i + k];
+      yk[i] = y[lanes * i + k];
+    }
+    for (int i = 0; i < dsize; i++) {
+      d1k[i] = d1[lanes * i + k];
+      d2k[i] = d2[lanes * i + k];
+      d1dk[i] = d1d[lanes * i + k];
+      d2dk[i] = d2d[lanes * i + k];
+    }
+
+    model::template addComputeTyingStrainTranspose<vars_per_node, basis>(
+        Xpts, fn1, fn2, p, d1k, d2k, &dety[ntying * k], yk, d1dk, d2dk);
+
+    director::template addDirectorResidual<vars_per_node, offset, num_nodes>(
+        p, p, p, fn1, d1dk, yk);
+    director::template addDirectorResidual<vars_per_node, offset, num_nodes>(
+        p, p, p, fn2, d2dk, yk);
+
+    for (int i = 0; i < nvars; i++) {
+      py[lanes * i + k] += yk[i];
+    }
+  }
+}
+
 template <class quadrature, class basis, class director, class model>
 void TACSBeamElement<quadrature, basis, director, model>::addAdjResProduct(
     int elemIndex, double time, TacsScalar scale, const TacsScalar psi[],
@@ -2071,6 +2645,36 @@ void TACSBeamElement<quadrature, basis, director, model>::getOutputData(
     // Get the number of nodes associated with the visualization
     int num_vis_nodes = TacsGetNumVisNodes(basis::getLayoutType());
 
+    // When only the nodes and displacements are requested, skip the
+    // strain and stress recovery
+    const int recover_flag =
+        TACS_OUTPUT_STRAINS | TACS_OUTPUT_STRESSES | TACS_OUTPUT_EXTRAS;
+    if (!(write_flag & recover_flag)) {
+      for (int index = 0; index < num_vis_nodes; index++, data += ld_data) {
+        double pt[3];
+        basis::getNodePoint(index, pt);
+
+        TacsScalar *d = data;
+        if (write_flag & TACS_OUTPUT_NODES) {
+          basis::template interpFields<3, 3>(pt, Xpts, d);
+          d += 3;
+        }
+        if (write_flag & TACS_OUTPUT_DISPLACEMENTS) {
+          int len = vars_per_node;
+          if (len > 6) {
+            len = 6;
+          }
+          for (int i = 0; i < len; i++) {
+            d[i] = vars[i + vars_per_node * index];
+          }
+          for (int i = len; i < 6; i++) {
+            d[i] = 0.0;
+          }
+        }
+      }
+      return;
+    }
+
     // Get the reference axis
     const A2D::Vec3 &axis = transform->getRefAxis();
 
@@ -2188,7 +2792,9 @@ void TACSBeamElement<quadrature, basis, director, model>::getOutputData(
 
       // Compute the corresponding stresses
       TacsScalar s[6];
-      con->evalStress(elemIndex, pt, X0.x, e, s);
+      if (write_flag & TACS_OUTPUT_STRESSES) {
+        con->evalStress(elemIndex, pt, X0.x, e, s);
+      }
 
       if (write_flag & TACS_OUTPUT_NODES) {
         data[0] = X0.x[0];
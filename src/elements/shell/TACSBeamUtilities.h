@@ -2,6 +2,7 @@
 #define TACS_BEAM_UTILITIES_H
 
 #include "TACSElementAlgebra.h"
+#include "TACSElementAlgebraBatch.h"
 #include "a2d.h"
 
 /*
@@ -54,6 +55,78 @@ void TacsBeamComputeNodeNormals(const TacsScalar Xpts[], const A2D::Vec3& axis,
   }
 }
 
+/*
+  Compute the frame normals at each node location for a batch of
+  elements that share the same reference axis
+
+  The node locations and the normal directions for each element are
+  stored one element after another. The intermediate directions are
+  stored in structure-of-arrays form over all the nodes in the batch,
+  so the work array must have room for 10*n*basis::NUM_NODES entries.
+
+  @param n The number of elements in the batch
+  @param Xpts The node locations for the elements
+  @param axis The coordinates of the reference axis
+  @param fn1 The first normal direction
+  @param fn2 The second normal direction
+  @param work The work array
+*/
+template <class basis>
+void TacsBeamComputeNodeNormalsBatch(const int n, const TacsScalar Xpts[],
+                                     const A2D::Vec3& axis, TacsScalar fn1[],
+                                     TacsScalar fn2[], TacsScalar work[]) {
+  const int np = n * basis::NUM_NODES;
+  TacsScalar* t1 = &work[0];
+  TacsScalar* t2 = &work[3 * np];
+  TacsScalar* t3 = &work[6 * np];
+  TacsScalar* s = &work[9 * np];
+
+  // Compute the derivative X,xi at each node
+  for (int e = 0, p = 0; e < n; e++) {
+    const TacsScalar* X = &Xpts[3 * basis::NUM_NODES * e];
+    for (int i = 0; i < basis::NUM_NODES; i++, p++) {
+      double pt[2];
+      basis::getNodePoint(i, pt);
+
+      TacsScalar X0xi[3];
+      basis::template interpFieldsGrad<3, 3>(pt, X, X0xi);
+      t1[p] = X0xi[0];
+      t1[np + p] = X0xi[1];
+      t1[2 * np + p] = X0xi[2];
+    }
+  }
+
+  // Normalize the first direction
+  vec3DotBatch(np, t1, t1, s);
+  TACS_BATCH_LOOP
+  for (int p = 0; p < np; p++) {
+    TacsScalar inv = 1.0 / sqrt(s[p]);
+    t1[p] *= inv;
+    t1[np + p] *= inv;
+    t1[2 * np + p] *= inv;
+  }
+
+  // t2 = axis - dot(t1, axis) * t1, normalized
+  const TacsScalar a0 = axis.x[0], a1 = axis.x[1], a2 = axis.x[2];
+  TACS_BATCH_LOOP
+  for (int p = 0; p < np; p++) {
+    TacsScalar dot = a0 * t1[p] + a1 * t1[np + p] + a2 * t1[2 * np + p];
+    TacsScalar d0 = a0 - dot * t1[p];
+    TacsScalar d1 = a1 - dot * t1[np + p];
+    TacsScalar d2 = a2 - dot * t1[2 * np + p];
+    TacsScalar inv = 1.0 / sqrt(d0 * d0 + d1 * d1 + d2 * d2);
+    t2[p] = d0 * inv;
+    t2[np + p] = d1 * inv;
+    t2[2 * np + p] = d2 * inv;
+  }
+
+  // Compute the n2 direction
+  crossProductBatch(np, t1, t2, t3);
+
+  batchUnpack(np, 3, t2, 3, fn1);
+  batchUnpack(np, 3, t3, 3, fn2);
+}
+
 /*
   Compute the frame normals at each node location
 
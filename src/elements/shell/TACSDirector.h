@@ -22,7 +22,8 @@ class TACSLinearizedRotation {
     @param C The rotation matrices at each point
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeRotationMat(const TacsScalar vars[], TacsScalar C[]) {
+  TACS_HOST_DEVICE static void computeRotationMat(const TacsScalar vars[],
+                                                  TacsScalar C[]) {
     const TacsScalar *q = &vars[offset];
     for (int i = 0; i < num_nodes; i++) {
       // C = I - q^{x}
@@ -43,9 +44,10 @@ class TACSLinearizedRotation {
     @param Cd The rotation matrices at each point
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeRotationMatDeriv(const TacsScalar vars[],
-                                      const TacsScalar varsd[], TacsScalar C[],
-                                      TacsScalar Cd[]) {
+  TACS_HOST_DEVICE static void computeRotationMatDeriv(const TacsScalar vars[],
+                                                       const TacsScalar varsd[],
+                                                       TacsScalar C[],
+                                                       TacsScalar Cd[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qd = &varsd[offset];
     for (int i = 0; i < num_nodes; i++) {
@@ -76,8 +78,9 @@ class TACSLinearizedRotation {
     @param res The residual array
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationMatResidual(const TacsScalar vars[],
-                                     const TacsScalar dC[], TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addRotationMatResidual(const TacsScalar vars[],
+                                                      const TacsScalar dC[],
+                                                      TacsScalar res[]) {
     TacsScalar *r = &res[offset];
 
     for (int i = 0; i < num_nodes; i++) {
@@ -101,11 +104,12 @@ class TACSLinearizedRotation {
     @param mat The Jacobian matrix
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationMatJacobian(const TacsScalar alpha,
-                                     const TacsScalar vars[],
-                                     const TacsScalar dC[],
-                                     const TacsScalar d2C[], TacsScalar res[],
-                                     TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addRotationMatJacobian(const TacsScalar alpha,
+                                                      const TacsScalar vars[],
+                                                      const TacsScalar dC[],
+                                                      const TacsScalar d2C[],
+                                                      TacsScalar res[],
+                                                      TacsScalar mat[]) {
     const int size = vars_per_node * num_nodes;
     const int csize = 9 * num_nodes;
 
@@ -184,13 +188,14 @@ class TACSLinearizedRotation {
     The linearized rotation class is unconstrained
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationConstraint(const TacsScalar vars[], TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addRotationConstraint(const TacsScalar vars[],
+                                                     TacsScalar res[]) {
   }
 
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationConstrJacobian(const TacsScalar alpha,
-                                        const TacsScalar vars[],
-                                        TacsScalar res[], TacsScalar mat[]) {}
+  TACS_HOST_DEVICE static void addRotationConstrJacobian(
+      const TacsScalar alpha, const TacsScalar vars[], TacsScalar res[],
+      TacsScalar mat[]) {}
 
   /**
     Compute the director and rates at all nodes.
@@ -207,10 +212,11 @@ class TACSLinearizedRotation {
     @param dddot The second time derivative of the director
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRates(const TacsScalar vars[],
-                                   const TacsScalar dvars[],
-                                   const TacsScalar t[], TacsScalar d[],
-                                   TacsScalar ddot[]) {
+  TACS_HOST_DEVICE static void computeDirectorRates(const TacsScalar vars[],
+                                                    const TacsScalar dvars[],
+                                                    const TacsScalar t[],
+                                                    TacsScalar d[],
+                                                    TacsScalar ddot[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     for (int i = 0; i < num_nodes; i++) {
@@ -242,11 +248,13 @@ class TACSLinearizedRotation {
     @param dddot The second time derivative of the director
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRates(const TacsScalar vars[],
-                                   const TacsScalar dvars[],
-                                   const TacsScalar ddvars[],
-                                   const TacsScalar t[], TacsScalar d[],
-                                   TacsScalar ddot[], TacsScalar dddot[]) {
+  TACS_HOST_DEVICE static void computeDirectorRates(const TacsScalar vars[],
+                                                    const TacsScalar dvars[],
+                                                    const TacsScalar ddvars[],
+                                                    const TacsScalar t[],
+                                                    TacsScalar d[],
+                                                    TacsScalar ddot[],
+                                                    TacsScalar dddot[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     const TacsScalar *qddot = &ddvars[offset];
@@ -285,13 +293,11 @@ class TACSLinearizedRotation {
     @param dd The derivative of the director values
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRatesDeriv(const TacsScalar vars[],
-                                        const TacsScalar dvars[],
-                                        const TacsScalar ddvars[],
-                                        const TacsScalar psi[],
-                                        const TacsScalar t[], TacsScalar d[],
-                                        TacsScalar ddot[], TacsScalar dddot[],
-                                        TacsScalar dpsi[]) {
+  TACS_HOST_DEVICE static void computeDirectorRatesDeriv(
+      const TacsScalar vars[], const TacsScalar dvars[],
+      const TacsScalar ddvars[], const TacsScalar psi[], const TacsScalar t[],
+      TacsScalar d[], TacsScalar ddot[], TacsScalar dddot[],
+      TacsScalar dpsi[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     const TacsScalar *qddot = &ddvars[offset];
@@ -346,11 +352,12 @@ class TACSLinearizedRotation {
     @param res The output residual
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorResidual(const TacsScalar vars[],
-                                  const TacsScalar dvars[],
-                                  const TacsScalar ddvars[],
-                                  const TacsScalar t[], const TacsScalar dd[],
-                                  TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addDirectorResidual(const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   const TacsScalar t[],
+                                                   const TacsScalar dd[],
+                                                   TacsScalar res[]) {
     TacsScalar *r = &res[offset];
 
     for (int i = 0; i < num_nodes; i++) {
@@ -366,13 +373,20 @@ class TACSLinearizedRotation {
     Add terms from the Jacobian
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorJacobian(
-      TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
-      const TacsScalar vars[], const TacsScalar dvars[],
-      const TacsScalar ddvars[], const TacsScalar t[], const TacsScalar dd[],
-      const TacsScalar d2Tdotd[], const TacsScalar d2Tdotu[],
-      const TacsScalar d2d[], const TacsScalar d2du[], TacsScalar res[],
-      TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addDirectorJacobian(TacsScalar alpha,
+                                                   TacsScalar beta,
+                                                   TacsScalar gamma,
+                                                   const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   const TacsScalar t[],
+                                                   const TacsScalar dd[],
+                                                   const TacsScalar d2Tdotd[],
+                                                   const TacsScalar d2Tdotu[],
+                                                   const TacsScalar d2d[],
+                                                   const TacsScalar d2du[],
+                                                   TacsScalar res[],
+                                                   TacsScalar mat[]) {
     // Add the derivative due to and d2d
     const int dsize = 3 * num_nodes;
     const int nvars = vars_per_node * num_nodes;
@@ -501,9 +515,10 @@ class TACSLinearizedRotation {
     @param dt The adjoint sensitivity w.r.t. the reference directions
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorRefNormalSens(const TacsScalar vars[],
-                                       const TacsScalar t[],
-                                       const TacsScalar dd[], TacsScalar dt[]) {
+  TACS_HOST_DEVICE static void addDirectorRefNormalSens(const TacsScalar vars[],
+                                                        const TacsScalar t[],
+                                                        const TacsScalar dd[],
+                                                        TacsScalar dt[]) {
     const TacsScalar *q = &vars[offset];
 
     for (int i = 0; i < num_nodes; i++) {
@@ -538,7 +553,7 @@ class TACSLinearizedRotation {
     @param dt The adjoint sensitivity w.r.t. the reference directions
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorRefNormalSens(
+  TACS_HOST_DEVICE static void addDirectorRefNormalSens(
       const TacsScalar vars[], const TacsScalar psi[], const TacsScalar t[],
       const TacsScalar dd[], const TacsScalar ddpsi[], TacsScalar dt[]) {
     const TacsScalar *q = &vars[offset];
@@ -557,15 +572,17 @@ class TACSLinearizedRotation {
     }
   }
 
-  static TacsScalar evalDrillStrain(const TacsScalar u0x[],
-                                    const TacsScalar Ct[]) {
+  TACS_HOST_DEVICE static TacsScalar evalDrillStrain(const TacsScalar u0x[],
+                                                     const TacsScalar Ct[]) {
     // Compute the rotational penalty
     return 0.5 * (Ct[3] + u0x[3] - Ct[1] - u0x[1]);
   }
 
-  static void evalDrillStrainSens(TacsScalar scale, const TacsScalar u0x[],
-                                  const TacsScalar Ct[], TacsScalar du0x[],
-                                  TacsScalar dCt[]) {
+  TACS_HOST_DEVICE static void evalDrillStrainSens(TacsScalar scale,
+                                                   const TacsScalar u0x[],
+                                                   const TacsScalar Ct[],
+                                                   TacsScalar du0x[],
+                                                   TacsScalar dCt[]) {
     dCt[0] = 0.0;
     dCt[1] = -0.5 * scale;
     dCt[2] = 0.0;
@@ -587,20 +604,21 @@ class TACSLinearizedRotation {
     du0x[8] = 0.0;
   }
 
-  static TacsScalar evalDrillStrainDeriv(const TacsScalar u0x[],
-                                         const TacsScalar Ct[],
-                                         const TacsScalar u0xd[],
-                                         const TacsScalar Ctd[],
-                                         TacsScalar *ed) {
+  TACS_HOST_DEVICE static TacsScalar evalDrillStrainDeriv(
+      const TacsScalar u0x[], const TacsScalar Ct[], const TacsScalar u0xd[],
+      const TacsScalar Ctd[], TacsScalar *ed) {
     *ed = 0.5 * (Ctd[3] + u0xd[3] - Ctd[1] - u0xd[1]);
 
     // Compute the rotational penalty
     return 0.5 * (Ct[3] + u0x[3] - Ct[1] - u0x[1]);
   }
 
-  static void evalDrillStrainHessian(TacsScalar d2et, const TacsScalar u0x[],
-                                     const TacsScalar Ct[], TacsScalar d2u0x[],
-                                     TacsScalar d2Ct[], TacsScalar d2Ctu0x[]) {
+  TACS_HOST_DEVICE static void evalDrillStrainHessian(TacsScalar d2et,
+                                                      const TacsScalar u0x[],
+                                                      const TacsScalar Ct[],
+                                                      TacsScalar d2u0x[],
+                                                      TacsScalar d2Ct[],
+                                                      TacsScalar d2Ctu0x[]) {
     memset(d2u0x, 0, 81 * sizeof(TacsScalar));
     memset(d2Ct, 0, 81 * sizeof(TacsScalar));
     memset(d2Ctu0x, 0, 81 * sizeof(TacsScalar));
@@ -627,7 +645,8 @@ class TACSQuadraticRotation {
     @param C The rotation matrices at each point
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeRotationMat(const TacsScalar vars[], TacsScalar C[]) {
+  TACS_HOST_DEVICE static void computeRotationMat(const TacsScalar vars[],
+                                                  TacsScalar C[]) {
     const TacsScalar *q = &vars[offset];
     for (int i = 0; i < num_nodes; i++) {
       TacsScalar qTq = vec3Dot(q, q);
@@ -649,9 +668,10 @@ class TACSQuadraticRotation {
     @param Cd The rotation matrices at each point
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeRotationMatDeriv(const TacsScalar vars[],
-                                      const TacsScalar varsd[], TacsScalar C[],
-                                      TacsScalar Cd[]) {
+  TACS_HOST_DEVICE static void computeRotationMatDeriv(const TacsScalar vars[],
+                                                       const TacsScalar varsd[],
+                                                       TacsScalar C[],
+                                                       TacsScalar Cd[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qd = &varsd[offset];
     for (int i = 0; i < num_nodes; i++) {
@@ -689,8 +709,9 @@ class TACSQuadraticRotation {
     @param res The residual array
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationMatResidual(const TacsScalar vars[],
-                                     const TacsScalar dC[], TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addRotationMatResidual(const TacsScalar vars[],
+                                                      const TacsScalar dC[],
+                                                      TacsScalar res[]) {
     const TacsScalar *q = &vars[offset];
     TacsScalar *r = &res[offset];
 
@@ -725,11 +746,12 @@ class TACSQuadraticRotation {
     @param mat The Jacobian matrix
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationMatJacobian(const TacsScalar alpha,
-                                     const TacsScalar vars[],
-                                     const TacsScalar dC[],
-                                     const TacsScalar d2C[], TacsScalar res[],
-                                     TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addRotationMatJacobian(const TacsScalar alpha,
+                                                      const TacsScalar vars[],
+                                                      const TacsScalar dC[],
+                                                      const TacsScalar d2C[],
+                                                      TacsScalar res[],
+                                                      TacsScalar mat[]) {
     const int size = vars_per_node * num_nodes;
     const int csize = 9 * num_nodes;
 
@@ -832,13 +854,14 @@ class TACSQuadraticRotation {
     The quadratic rotation matrix is unconstrained
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationConstraint(const TacsScalar vars[], TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addRotationConstraint(const TacsScalar vars[],
+                                                     TacsScalar res[]) {
   }
 
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationConstrJacobian(const TacsScalar alpha,
-                                        const TacsScalar vars[],
-                                        TacsScalar res[], TacsScalar mat[]) {}
+  TACS_HOST_DEVICE static void addRotationConstrJacobian(
+      const TacsScalar alpha, const TacsScalar vars[], TacsScalar res[],
+      TacsScalar mat[]) {}
 
   /**
     Compute the director and rates at all nodes.
@@ -855,10 +878,11 @@ class TACSQuadraticRotation {
     @param dddot The second time derivative of the director
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRates(const TacsScalar vars[],
-                                   const TacsScalar dvars[],
-                                   const TacsScalar t[], TacsScalar d[],
-                                   TacsScalar ddot[]) {
+  TACS_HOST_DEVICE static void computeDirectorRates(const TacsScalar vars[],
+                                                    const TacsScalar dvars[],
+                                                    const TacsScalar t[],
+                                                    TacsScalar d[],
+                                                    TacsScalar ddot[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     for (int i = 0; i < num_nodes; i++) {
@@ -905,11 +929,13 @@ class TACSQuadraticRotation {
     @param dddot The second time derivative of the director
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRates(const TacsScalar vars[],
-                                   const TacsScalar dvars[],
-                                   const TacsScalar ddvars[],
-                                   const TacsScalar t[], TacsScalar d[],
-                                   TacsScalar ddot[], TacsScalar dddot[]) {
+  TACS_HOST_DEVICE static void computeDirectorRates(const TacsScalar vars[],
+                                                    const TacsScalar dvars[],
+                                                    const TacsScalar ddvars[],
+                                                    const TacsScalar t[],
+                                                    TacsScalar d[],
+                                                    TacsScalar ddot[],
+                                                    TacsScalar dddot[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     const TacsScalar *qddot = &ddvars[offset];
@@ -973,13 +999,11 @@ class TACSQuadraticRotation {
     @param dd The derivative of the director values
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRatesDeriv(const TacsScalar vars[],
-                                        const TacsScalar dvars[],
-                                        const TacsScalar ddvars[],
-                                        const TacsScalar psi[],
-                                        const TacsScalar t[], TacsScalar d[],
-                                        TacsScalar ddot[], TacsScalar dddot[],
-                                        TacsScalar dpsi[]) {
+  TACS_HOST_DEVICE static void computeDirectorRatesDeriv(
+      const TacsScalar vars[], const TacsScalar dvars[],
+      const TacsScalar ddvars[], const TacsScalar psi[], const TacsScalar t[],
+      TacsScalar d[], TacsScalar ddot[], TacsScalar dddot[],
+      TacsScalar dpsi[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     const TacsScalar *qddot = &ddvars[offset];
@@ -1053,11 +1077,12 @@ class TACSQuadraticRotation {
     @param res The output residual
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorResidual(const TacsScalar vars[],
-                                  const TacsScalar dvars[],
-                                  const TacsScalar ddvars[],
-                                  const TacsScalar t[], const TacsScalar dd[],
-                                  TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addDirectorResidual(const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   const TacsScalar t[],
+                                                   const TacsScalar dd[],
+                                                   TacsScalar res[]) {
     TacsScalar *r = &res[offset];
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
@@ -1096,13 +1121,20 @@ class TACSQuadraticRotation {
     Add terms from the Jacobian
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorJacobian(
-      TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
-      const TacsScalar vars[], const TacsScalar dvars[],
-      const TacsScalar ddvars[], const TacsScalar t[], const TacsScalar dd[],
-      const TacsScalar d2Tdotd[], const TacsScalar d2Tdotu[],
-      const TacsScalar d2d[], const TacsScalar d2du[], TacsScalar res[],
-      TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addDirectorJacobian(TacsScalar alpha,
+                                                   TacsScalar beta,
+                                                   TacsScalar gamma,
+                                                   const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   const TacsScalar t[],
+                                                   const TacsScalar dd[],
+                                                   const TacsScalar d2Tdotd[],
+                                                   const TacsScalar d2Tdotu[],
+                                                   const TacsScalar d2d[],
+                                                   const TacsScalar d2du[],
+                                                   TacsScalar res[],
+                                                   TacsScalar mat[]) {
     const int size = vars_per_node * num_nodes;
     const int dsize = 3 * num_nodes;
 
@@ -1346,9 +1378,10 @@ class TACSQuadraticRotation {
     @param dt The adjoint sensitivity w.r.t. the reference directions
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorRefNormalSens(const TacsScalar vars[],
-                                       const TacsScalar t[],
-                                       const TacsScalar dd[], TacsScalar dt[]) {
+  TACS_HOST_DEVICE static void addDirectorRefNormalSens(const TacsScalar vars[],
+                                                        const TacsScalar t[],
+                                                        const TacsScalar dd[],
+                                                        TacsScalar dt[]) {
     const TacsScalar *q = &vars[offset];
 
     for (int i = 0; i < num_nodes; i++) {
@@ -1391,7 +1424,7 @@ class TACSQuadraticRotation {
     @param dt The adjoint sensitivity w.r.t. the reference directions
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorRefNormalSens(
+  TACS_HOST_DEVICE static void addDirectorRefNormalSens(
       const TacsScalar vars[], const TacsScalar psi[], const TacsScalar t[],
       const TacsScalar dd[], const TacsScalar ddpsi[], TacsScalar dt[]) {
     const TacsScalar *q = &vars[offset];
@@ -1426,15 +1459,17 @@ class TACSQuadraticRotation {
     }
   }
 
-  static TacsScalar evalDrillStrain(const TacsScalar u0x[],
-                                    const TacsScalar Ct[]) {
+  TACS_HOST_DEVICE static TacsScalar evalDrillStrain(const TacsScalar u0x[],
+                                                     const TacsScalar Ct[]) {
     // Compute the rotational penalty
     return 0.5 * (Ct[3] + u0x[3] - Ct[1] - u0x[1]);
   }
 
-  static void evalDrillStrainSens(TacsScalar scale, const TacsScalar u0x[],
-                                  const TacsScalar Ct[], TacsScalar du0x[],
-                                  TacsScalar dCt[]) {
+  TACS_HOST_DEVICE static void evalDrillStrainSens(TacsScalar scale,
+                                                   const TacsScalar u0x[],
+                                                   const TacsScalar Ct[],
+                                                   TacsScalar du0x[],
+                                                   TacsScalar dCt[]) {
     dCt[0] = 0.0;
     dCt[1] = -0.5 * scale;
     dCt[2] = 0.0;
@@ -1456,20 +1491,21 @@ class TACSQuadraticRotation {
     du0x[8] = 0.0;
   }
 
-  static TacsScalar evalDrillStrainDeriv(const TacsScalar u0x[],
-                                         const TacsScalar Ct[],
-                                         const TacsScalar u0xd[],
-                                         const TacsScalar Ctd[],
-                                         TacsScalar *ed) {
+  TACS_HOST_DEVICE static TacsScalar evalDrillStrainDeriv(
+      const TacsScalar u0x[], const TacsScalar Ct[], const TacsScalar u0xd[],
+      const TacsScalar Ctd[], TacsScalar *ed) {
     *ed = 0.5 * (Ctd[3] + u0xd[3] - Ctd[1] - u0xd[1]);
 
     // Compute the rotational penalty
     return 0.5 * (Ct[3] + u0x[3] - Ct[1] - u0x[1]);
   }
 
-  static void evalDrillStrainHessian(TacsScalar d2et, const TacsScalar u0x[],
-                                     const TacsScalar Ct[], TacsScalar d2u0x[],
-                                     TacsScalar d2Ct[], TacsScalar d2Ctu0x[]) {
+  TACS_HOST_DEVICE static void evalDrillStrainHessian(TacsScalar d2et,
+                                                      const TacsScalar u0x[],
+                                                      const TacsScalar Ct[],
+                                                      TacsScalar d2u0x[],
+                                                      TacsScalar d2Ct[],
+                                                      TacsScalar d2Ctu0x[]) {
     memset(d2u0x, 0, 81 * sizeof(TacsScalar));
     memset(d2Ct, 0, 81 * sizeof(TacsScalar));
     memset(d2Ctu0x, 0, 81 * sizeof(TacsScalar));
@@ -1487,7 +1523,8 @@ class TACSQuaternionRotation {
     @param C The rotation matrices at each point
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeRotationMat(const TacsScalar vars[], TacsScalar C[]) {
+  TACS_HOST_DEVICE static void computeRotationMat(const TacsScalar vars[],
+                                                  TacsScalar C[]) {
     const TacsScalar *q = &vars[offset];
     for (int i = 0; i < num_nodes; i++) {
       C[0] = 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]);
@@ -1516,9 +1553,10 @@ class TACSQuaternionRotation {
     @param Cd The rotation matrices at each point
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeRotationMatDeriv(const TacsScalar vars[],
-                                      const TacsScalar varsd[], TacsScalar C[],
-                                      TacsScalar Cd[]) {
+  TACS_HOST_DEVICE static void computeRotationMatDeriv(const TacsScalar vars[],
+                                                       const TacsScalar varsd[],
+                                                       TacsScalar C[],
+                                                       TacsScalar Cd[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qd = &varsd[offset];
 
@@ -1567,8 +1605,9 @@ class TACSQuaternionRotation {
     @param res The residual array
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationMatResidual(const TacsScalar vars[],
-                                     const TacsScalar dC[], TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addRotationMatResidual(const TacsScalar vars[],
+                                                      const TacsScalar dC[],
+                                                      TacsScalar res[]) {
     const TacsScalar *q = &vars[offset];
     TacsScalar *r = &res[offset];
 
@@ -1599,11 +1638,12 @@ class TACSQuaternionRotation {
     @param mat The Jacobian matrix
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationMatJacobian(const TacsScalar alpha,
-                                     const TacsScalar vars[],
-                                     const TacsScalar dC[],
-                                     const TacsScalar d2C[], TacsScalar res[],
-                                     TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addRotationMatJacobian(const TacsScalar alpha,
+                                                      const TacsScalar vars[],
+                                                      const TacsScalar dC[],
+                                                      const TacsScalar d2C[],
+                                                      TacsScalar res[],
+                                                      TacsScalar mat[]) {
     const int size = vars_per_node * num_nodes;
     const int csize = 9 * num_nodes;
 
@@ -1711,7 +1751,8 @@ class TACSQuaternionRotation {
   }
 
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationConstraint(const TacsScalar vars[], TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addRotationConstraint(const TacsScalar vars[],
+                                                     TacsScalar res[]) {
     const TacsScalar *q = &vars[offset];
     TacsScalar *r = &res[offset];
     for (int i = 0; i < num_nodes; i++) {
@@ -1732,9 +1773,9 @@ class TACSQuaternionRotation {
   }
 
   template <int vars_per_node, int offset, int num_nodes>
-  static void addRotationConstrJacobian(const TacsScalar alpha,
-                                        const TacsScalar vars[],
-                                        TacsScalar res[], TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addRotationConstrJacobian(
+      const TacsScalar alpha, const TacsScalar vars[], TacsScalar res[],
+      TacsScalar mat[]) {
     const int size = vars_per_node * num_nodes;
     const TacsScalar *q = &vars[offset];
     TacsScalar *r = NULL;
@@ -1800,10 +1841,11 @@ class TACSQuaternionRotation {
     @param dddot The second time derivative of the director
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRates(const TacsScalar vars[],
-                                   const TacsScalar dvars[],
-                                   const TacsScalar t[], TacsScalar d[],
-                                   TacsScalar ddot[]) {
+  TACS_HOST_DEVICE static void computeDirectorRates(const TacsScalar vars[],
+                                                    const TacsScalar dvars[],
+                                                    const TacsScalar t[],
+                                                    TacsScalar d[],
+                                                    TacsScalar ddot[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
 
@@ -1875,11 +1917,13 @@ class TACSQuaternionRotation {
     @param dddot The second time derivative of the director
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRates(const TacsScalar vars[],
-                                   const TacsScalar dvars[],
-                                   const TacsScalar ddvars[],
-                                   const TacsScalar t[], TacsScalar d[],
-                                   TacsScalar ddot[], TacsScalar dddot[]) {
+  TACS_HOST_DEVICE static void computeDirectorRates(const TacsScalar vars[],
+                                                    const TacsScalar dvars[],
+                                                    const TacsScalar ddvars[],
+                                                    const TacsScalar t[],
+                                                    TacsScalar d[],
+                                                    TacsScalar ddot[],
+                                                    TacsScalar dddot[]) {
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
     const TacsScalar *qddot = &ddvars[offset];
@@ -1996,7 +2040,7 @@ class TACSQuaternionRotation {
     @param dd The derivative of the director values
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void computeDirectorRatesDeriv(
+  TACS_HOST_DEVICE static void computeDirectorRatesDeriv(
       const TacsScalar vars[], const TacsScalar dvars[],
       const TacsScalar ddvars[], const TacsScalar varsd[], const TacsScalar t[],
       TacsScalar d[], TacsScalar ddot[], TacsScalar dddot[], TacsScalar dd[]) {
@@ -2139,11 +2183,12 @@ class TACSQuaternionRotation {
     @param res The output residual
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorResidual(const TacsScalar vars[],
-                                  const TacsScalar dvars[],
-                                  const TacsScalar ddvars[],
-                                  const TacsScalar t[], const TacsScalar dd[],
-                                  TacsScalar res[]) {
+  TACS_HOST_DEVICE static void addDirectorResidual(const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   const TacsScalar t[],
+                                                   const TacsScalar dd[],
+                                                   TacsScalar res[]) {
     TacsScalar *r = &res[offset];
     const TacsScalar *q = &vars[offset];
     const TacsScalar *qdot = &dvars[offset];
@@ -2180,99 +2225,88 @@ class TACSQuaternionRotation {
     }
   }
 
+  /*
+    Compute the derivative of the director with respect to the
+    quaternion at a node, D = d(d)/dq for d = (C^{T}(q) - I)*t. The
+    derivative is linear in the quaternion, so that the same function
+    gives the derivatives of the director rates, for instance
+    D(qdot) = d(ddot)/d(qdot).
+
+    @param q The quaternion (or a rate of the quaternion)
+    @param t The reference direction
+    @param D The 3x4 derivative in row-major order
+  */
+  TACS_HOST_DEVICE static inline void computeDirectorDeriv(
+      const TacsScalar q[], const TacsScalar t[], TacsScalar D[]) {
+    D[0] = 2.0 * (q[2] * t[2] - q[3] * t[1]);
+    D[1] = 2.0 * (q[2] * t[1] + q[3] * t[2]);
+    D[2] = 2.0 * (-2.0 * q[2] * t[0] + q[1] * t[1] + q[0] * t[2]);
+    D[3] = 2.0 * (-2.0 * q[3] * t[0] - q[0] * t[1] + q[1] * t[2]);
+
+    D[4] = 2.0 * (q[3] * t[0] - q[1] * t[2]);
+    D[5] = 2.0 * (q[2] * t[0] - 2.0 * q[1] * t[1] - q[0] * t[2]);
+    D[6] = 2.0 * (q[1] * t[0] + q[3] * t[2]);
+    D[7] = 2.0 * (q[0] * t[0] - 2.0 * q[3] * t[1] + q[2] * t[2]);
+
+    D[8] = 2.0 * (q[1] * t[1] - q[2] * t[0]);
+    D[9] = 2.0 * (q[3] * t[0] + q[0] * t[1] - 2.0 * q[1] * t[2]);
+    D[10] = 2.0 * (q[3] * t[1] - q[0] * t[0] - 2.0 * q[2] * t[2]);
+    D[11] = 2.0 * (q[1] * t[0] + q[2] * t[1]);
+  }
+
   /*
     Add the contributions to the Jacobian matrix from the director
+
+    The terms from the director rates are combined in closed form.
+    Since D(q) is linear in q, the rate contributions
+
+    gamma*D(q) + 2*beta*D(qdot) + alpha*D(qddot) = D(w)
+
+    with w = gamma*q + 2*beta*qdot + alpha*qddot, so that only two 3x4
+    derivatives are formed at each node and each block of the
+    Jacobian takes two products with the second derivatives.
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorJacobian(
-      TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
-      const TacsScalar vars[], const TacsScalar dvars[],
-      const TacsScalar ddvars[], const TacsScalar t[], const TacsScalar dd[],
-      const TacsScalar d2Tdotd[], const TacsScalar d2Tdotu[],
-      const TacsScalar d2d[], const TacsScalar d2du[], TacsScalar res[],
-      TacsScalar mat[]) {
+  TACS_HOST_DEVICE static void addDirectorJacobian(TacsScalar alpha,
+                                                   TacsScalar beta,
+                                                   TacsScalar gamma,
+                                                   const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   const TacsScalar t[],
+                                                   const TacsScalar dd[],
+                                                   const TacsScalar d2Tdotd[],
+                                                   const TacsScalar d2Tdotu[],
+                                                   const TacsScalar d2d[],
+                                                   const TacsScalar d2du[],
+                                                   TacsScalar res[],
+                                                   TacsScalar mat[]) {
     const int size = vars_per_node * num_nodes;
     const int dsize = 3 * num_nodes;
 
-    // Pre-compute the Jacobian matrices
-    const TacsScalar *ti = t;
-    TacsScalar D[12 * num_nodes], Ddot[12 * num_nodes], Dddot[12 * num_nodes];
-    for (int i = 0; i < num_nodes; i++, ti += 3) {
-      // D = d(Qdot*t)/d(qdot)
-      TacsScalar *Di = &D[12 * i];
-      TacsScalar *Didot = &Ddot[12 * i];
-      TacsScalar *Diddot = &Dddot[12 * i];
+    // Pre-compute the derivative of the director D and the combined
+    // derivative of the director rates E at each node
+    TacsScalar D[12 * num_nodes], E[12 * num_nodes];
+    for (int i = 0; i < num_nodes; i++) {
       const TacsScalar *qi = &vars[offset + vars_per_node * i];
       const TacsScalar *qidot = &dvars[offset + vars_per_node * i];
       const TacsScalar *qiddot = &ddvars[offset + vars_per_node * i];
 
-      Di[0] = 2.0 * (qi[2] * ti[2] - qi[3] * ti[1]);
-      Di[1] = 2.0 * (qi[2] * ti[1] + qi[3] * ti[2]);
-      Di[2] = 2.0 * (-2.0 * qi[2] * ti[0] + qi[1] * ti[1] + qi[0] * ti[2]);
-      Di[3] = 2.0 * (-2.0 * qi[3] * ti[0] - qi[0] * ti[1] + qi[1] * ti[2]);
-
-      Di[4] = 2.0 * (qi[3] * ti[0] - qi[1] * ti[2]);
-      Di[5] = 2.0 * (qi[2] * ti[0] - 2.0 * qi[1] * ti[1] - qi[0] * ti[2]);
-      Di[6] = 2.0 * (qi[1] * ti[0] + qi[3] * ti[2]);
-      Di[7] = 2.0 * (qi[0] * ti[0] - 2.0 * qi[3] * ti[1] + qi[2] * ti[2]);
-
-      Di[8] = 2.0 * (qi[1] * ti[1] - qi[2] * ti[0]);
-      Di[9] = 2.0 * (qi[3] * ti[0] + qi[0] * ti[1] - 2.0 * qi[1] * ti[2]);
-      Di[10] = 2.0 * (qi[3] * ti[1] - qi[0] * ti[0] - 2.0 * qi[2] * ti[2]);
-      Di[11] = 2.0 * (qi[1] * ti[0] + qi[2] * ti[1]);
-
-      Didot[0] = 2.0 * (qidot[2] * ti[2] - qidot[3] * ti[1]);
-      Didot[1] = 2.0 * (qidot[2] * ti[1] + qidot[3] * ti[2]);
-      Didot[2] =
-          2.0 * (-2.0 * qidot[2] * ti[0] + qidot[1] * ti[1] + qidot[0] * ti[2]);
-      Didot[3] =
-          2.0 * (-2.0 * qidot[3] * ti[0] - qidot[0] * ti[1] + qidot[1] * ti[2]);
-
-      Didot[4] = 2.0 * (qidot[3] * ti[0] - qidot[1] * ti[2]);
-      Didot[5] =
-          2.0 * (qidot[2] * ti[0] - 2.0 * qidot[1] * ti[1] - qidot[0] * ti[2]);
-      Didot[6] = 2.0 * (qidot[1] * ti[0] + qidot[3] * ti[2]);
-      Didot[7] =
-          2.0 * (qidot[0] * ti[0] - 2.0 * qidot[3] * ti[1] + qidot[2] * ti[2]);
-
-      Didot[8] = 2.0 * (qidot[1] * ti[1] - qidot[2] * ti[0]);
-      Didot[9] =
-          2.0 * (qidot[3] * ti[0] + qidot[0] * ti[1] - 2.0 * qidot[1] * ti[2]);
-      Didot[10] =
-          2.0 * (qidot[3] * ti[1] - qidot[0] * ti[0] - 2.0 * qidot[2] * ti[2]);
-      Didot[11] = 2.0 * (qidot[1] * ti[0] + qidot[2] * ti[1]);
-
-      Diddot[0] = 2.0 * (qiddot[2] * ti[2] - qiddot[3] * ti[1]);
-      Diddot[1] = 2.0 * (qiddot[2] * ti[1] + qiddot[3] * ti[2]);
-      Diddot[2] = 2.0 * (-2.0 * qiddot[2] * ti[0] + qiddot[1] * ti[1] +
-                         qiddot[0] * ti[2]);
-      Diddot[3] = 2.0 * (-2.0 * qiddot[3] * ti[0] - qiddot[0] * ti[1] +
-                         qiddot[1] * ti[2]);
-
-      Diddot[4] = 2.0 * (qiddot[3] * ti[0] - qiddot[1] * ti[2]);
-      Diddot[5] = 2.0 * (qiddot[2] * ti[0] - 2.0 * qiddot[1] * ti[1] -
-                         qiddot[0] * ti[2]);
-      Diddot[6] = 2.0 * (qiddot[1] * ti[0] + qiddot[3] * ti[2]);
-      Diddot[7] = 2.0 * (qiddot[0] * ti[0] - 2.0 * qiddot[3] * ti[1] +
-                         qiddot[2] * ti[2]);
-
-      Diddot[8] = 2.0 * (qiddot[1] * ti[1] - qiddot[2] * ti[0]);
-      Diddot[9] = 2.0 * (qiddot[3] * ti[0] + qiddot[0] * ti[1] -
-                         2.0 * qiddot[1] * ti[2]);
-      Diddot[10] = 2.0 * (qiddot[3] * ti[1] - qiddot[0] * ti[0] -
-                          2.0 * qiddot[2] * ti[2]);
-      Diddot[11] = 2.0 * (qiddot[1] * ti[0] + qiddot[2] * ti[1]);
+      TacsScalar wi[4];
+      for (int k = 0; k < 4; k++) {
+        wi[k] = gamma * qi[k] + 2.0 * beta * qidot[k] + alpha * qiddot[k];
+      }
+
+      computeDirectorDeriv(qi, &t[3 * i], &D[12 * i]);
+      computeDirectorDeriv(wi, &t[3 * i], &E[12 * i]);
     }
 
-    const TacsScalar *q = &vars[offset];
-    const TacsScalar *qdot = &dvars[offset];
     TacsScalar *r = NULL;
     if (res) {
       r = &res[offset];
     }
     TacsScalar *m = &mat[offset * size + offset];
 
-    // Re-set the pointer
     const TacsScalar *Di = D;
     for (int i = 0; i < num_nodes; i++, Di += 12) {
       if (res) {
@@ -2285,49 +2319,18 @@ class TACSQuaternionRotation {
       }
 
       const TacsScalar *Dj = D;
-      const TacsScalar *Djdot = Ddot;
-      const TacsScalar *Djddot = Dddot;
-      for (int j = 0; j < num_nodes; j++, Dj += 12, Djdot += 12, Djddot += 12) {
+      const TacsScalar *Ej = E;
+      for (int j = 0; j < num_nodes; j++, Dj += 12, Ej += 12) {
+        // dfdq = Dj^{T}*d2d + Ej^{T}*d2Tdotd for the (i, j) block
         TacsScalar dfdq[12];
         for (int k = 0; k < 3; k++) {
-          TacsScalar tmp[3];
-          tmp[0] = d2d[dsize * (3 * i + k) + 3 * j] +
-                   gamma * d2Tdotd[dsize * (3 * i + k) + 3 * j];
-          tmp[1] = d2d[dsize * (3 * i + k) + 3 * j + 1] +
-                   gamma * d2Tdotd[dsize * (3 * i + k) + 3 * j + 1];
-          tmp[2] = d2d[dsize * (3 * i + k) + 3 * j + 2] +
-                   gamma * d2Tdotd[dsize * (3 * i + k) + 3 * j + 2];
-
-          dfdq[k] = Dj[0] * tmp[0] + Dj[4] * tmp[1] + Dj[8] * tmp[2];
-          dfdq[3 + k] = Dj[1] * tmp[0] + Dj[5] * tmp[1] + Dj[9] * tmp[2];
-          dfdq[6 + k] = Dj[2] * tmp[0] + Dj[6] * tmp[1] + Dj[10] * tmp[2];
-          dfdq[9 + k] = Dj[3] * tmp[0] + Dj[7] * tmp[1] + Dj[11] * tmp[2];
-
-          tmp[0] = beta * d2Tdotd[dsize * (3 * i + k) + 3 * j];
-          tmp[1] = beta * d2Tdotd[dsize * (3 * i + k) + 3 * j + 1];
-          tmp[2] = beta * d2Tdotd[dsize * (3 * i + k) + 3 * j + 2];
-
-          dfdq[k] +=
-              2.0 * (Djdot[0] * tmp[0] + Djdot[4] * tmp[1] + Djdot[8] * tmp[2]);
-          dfdq[3 + k] +=
-              2.0 * (Djdot[1] * tmp[0] + Djdot[5] * tmp[1] + Djdot[9] * tmp[2]);
-          dfdq[6 + k] += 2.0 * (Djdot[2] * tmp[0] + Djdot[6] * tmp[1] +
-                                Djdot[10] * tmp[2]);
-          dfdq[9 + k] += 2.0 * (Djdot[3] * tmp[0] + Djdot[7] * tmp[1] +
-                                Djdot[11] * tmp[2]);
-
-          tmp[0] = alpha * d2Tdotd[dsize * (3 * i + k) + 3 * j];
-          tmp[1] = alpha * d2Tdotd[dsize * (3 * i + k) + 3 * j + 1];
-          tmp[2] = alpha * d2Tdotd[dsize * (3 * i + k) + 3 * j + 2];
-
-          dfdq[k] +=
-              Djddot[0] * tmp[0] + Djddot[4] * tmp[1] + Djddot[8] * tmp[2];
-          dfdq[3 + k] +=
-              Djddot[1] * tmp[0] + Djddot[5] * tmp[1] + Djddot[9] * tmp[2];
-          dfdq[6 + k] +=
-              Djddot[2] * tmp[0] + Djddot[6] * tmp[1] + Djddot[10] * tmp[2];
-          dfdq[9 + k] +=
-              Djddot[3] * tmp[0] + Djddot[7] * tmp[1] + Djddot[11] * tmp[2];
+          const TacsScalar *a = &d2d[dsize * (3 * i + k) + 3 * j];
+          const TacsScalar *b = &d2Tdotd[dsize * (3 * i + k) + 3 * j];
+          for (int ii = 0; ii < 4; ii++) {
+            dfdq[3 * ii + k] = (Dj[ii] * a[0] + Dj[4 + ii] * a[1] +
+                                Dj[8 + ii] * a[2] + Ej[ii] * b[0] +
+                                Ej[4 + ii] * b[1] + Ej[8 + ii] * b[2]);
+          }
         }
 
         TacsScalar jac[16];
@@ -2375,68 +2378,36 @@ class TACSQuaternionRotation {
         }
       }
 
-      q += vars_per_node;
-      qdot += vars_per_node;
-
       dd += 3;
       t += 3;
       m += vars_per_node * size;
     }
 
     Di = D;
-    const TacsScalar *Didot = Ddot;
-    const TacsScalar *Diddot = Dddot;
-    for (int i = 0; i < num_nodes; i++, Di += 12, Didot += 12, Diddot += 12) {
+    const TacsScalar *Ei = E;
+    for (int i = 0; i < num_nodes; i++, Di += 12, Ei += 12) {
       for (int j = 0; j < num_nodes; j++) {
+        // dfdq = Di^{T}*(d2du + gamma*d2Tdotu) for the rows of the
+        // quaternion and dfdqT = Di^{T}*d2du + Ei^{T}*d2Tdotu for the
+        // columns of the quaternion
         TacsScalar dfdq[12], dfdqT[12];
         for (int k = 0; k < 3; k++) {
-          TacsScalar tmp[3];
-          tmp[0] = d2du[dsize * (3 * i) + 3 * j + k] +
-                   gamma * d2Tdotu[dsize * (3 * i) + 3 * j + k];
-          tmp[1] = d2du[dsize * (3 * i + 1) + 3 * j + k] +
-                   gamma * d2Tdotu[dsize * (3 * i + 1) + 3 * j + k];
-          tmp[2] = d2du[dsize * (3 * i + 2) + 3 * j + k] +
-                   gamma * d2Tdotu[dsize * (3 * i + 2) + 3 * j + k];
-
-          dfdq[k] = Di[0] * tmp[0] + Di[4] * tmp[1] + Di[8] * tmp[2];
-          dfdq[3 + k] = Di[1] * tmp[0] + Di[5] * tmp[1] + Di[9] * tmp[2];
-          dfdq[6 + k] = Di[2] * tmp[0] + Di[6] * tmp[1] + Di[10] * tmp[2];
-          dfdq[9 + k] = Di[3] * tmp[0] + Di[7] * tmp[1] + Di[11] * tmp[2];
-
-          tmp[0] = d2du[dsize * (3 * i) + 3 * j + k];
-          tmp[1] = d2du[dsize * (3 * i + 1) + 3 * j + k];
-          tmp[2] = d2du[dsize * (3 * i + 2) + 3 * j + k];
-
-          dfdqT[k] = dfdq[k];
-          dfdqT[3 + k] = dfdq[3 + k];
-          dfdqT[6 + k] = dfdq[6 + k];
-          dfdqT[9 + k] = dfdq[9 + k];
-
-          tmp[0] = beta * d2Tdotu[dsize * (3 * i) + 3 * j + k];
-          tmp[1] = beta * d2Tdotu[dsize * (3 * i + 1) + 3 * j + k];
-          tmp[2] = beta * d2Tdotu[dsize * (3 * i + 2) + 3 * j + k];
-
-          dfdqT[k] +=
-              2.0 * (Didot[0] * tmp[0] + Didot[4] * tmp[1] + Didot[8] * tmp[2]);
-          dfdqT[3 + k] +=
-              2.0 * (Didot[1] * tmp[0] + Didot[5] * tmp[1] + Didot[9] * tmp[2]);
-          dfdqT[6 + k] += 2.0 * (Didot[2] * tmp[0] + Didot[6] * tmp[1] +
-                                 Didot[10] * tmp[2]);
-          dfdqT[9 + k] += 2.0 * (Didot[3] * tmp[0] + Didot[7] * tmp[1] +
-                                 Didot[11] * tmp[2]);
-
-          tmp[0] = alpha * d2Tdotu[dsize * (3 * i) + 3 * j + k];
-          tmp[1] = alpha * d2Tdotu[dsize * (3 * i + 1) + 3 * j + k];
-          tmp[2] = alpha * d2Tdotu[dsize * (3 * i + 2) + 3 * j + k];
+          TacsScalar a[3], b[3];
+          for (int l = 0; l < 3; l++) {
+            a[l] = d2du[dsize * (3 * i + l) + 3 * j + k];
+            b[l] = d2Tdotu[dsize * (3 * i + l) + 3 * j + k];
+          }
 
-          dfdqT[k] +=
-              Diddot[0] * tmp[0] + Diddot[4] * tmp[1] + Diddot[8] * tmp[2];
-          dfdqT[3 + k] +=
-              Diddot[1] * tmp[0] + Diddot[5] * tmp[1] + Diddot[9] * tmp[2];
-          dfdqT[6 + k] +=
-              Diddot[2] * tmp[0] + Diddot[6] * tmp[1] + Diddot[10] * tmp[2];
-          dfdqT[9 + k] +=
-              Diddot[3] * tmp[0] + Diddot[7] * tmp[1] + Diddot[11] * tmp[2];
+          for (int ii = 0; ii < 4; ii++) {
+            TacsScalar Da =
+                Di[ii] * a[0] + Di[4 + ii] * a[1] + Di[8 + ii] * a[2];
+            TacsScalar Db =
+                Di[ii] * b[0] + Di[4 + ii] * b[1] + Di[8 + ii] * b[2];
+            TacsScalar Eb =
+                Ei[ii] * b[0] + Ei[4 + ii] * b[1] + Ei[8 + ii] * b[2];
+            dfdq[3 * ii + k] = Da + gamma * Db;
+            dfdqT[3 * ii + k] = Da + Eb;
+          }
         }
 
         for (int ii = 0; ii < 4; ii++) {
@@ -2477,9 +2448,10 @@ class TACSQuaternionRotation {
     @param dt The adjoint sensitivity w.r.t. the reference directions
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorRefNormalSens(const TacsScalar vars[],
-                                       const TacsScalar t[],
-                                       const TacsScalar dd[], TacsScalar dt[]) {
+  TACS_HOST_DEVICE static void addDirectorRefNormalSens(const TacsScalar vars[],
+                                                        const TacsScalar t[],
+                                                        const TacsScalar dd[],
+                                                        TacsScalar dt[]) {
     const TacsScalar *q = &vars[offset];
 
     for (int i = 0; i < num_nodes; i++) {
@@ -2529,7 +2501,7 @@ class TACSQuaternionRotation {
     @param dt The adjoint sensitivity w.r.t. the reference directions
   */
   template <int vars_per_node, int offset, int num_nodes>
-  static void addDirectorRefNormalSens(
+  TACS_HOST_DEVICE static void addDirectorRefNormalSens(
       const TacsScalar vars[], const TacsScalar psi[], const TacsScalar t[],
       const TacsScalar dd[], const TacsScalar ddpsi[], TacsScalar dt[]) {
     const TacsScalar *q = &vars[offset];
@@ -2584,16 +2556,18 @@ class TACSQuaternionRotation {
     }
   }
 
-  static TacsScalar evalDrillStrain(const TacsScalar u0x[],
-                                    const TacsScalar Ct[]) {
+  TACS_HOST_DEVICE static TacsScalar evalDrillStrain(const TacsScalar u0x[],
+                                                     const TacsScalar Ct[]) {
     // e2^{T}*Ct*(e1 + u_{,x}*e1) - e1^{T}*Ct*(e2 + u_{,x}*e2)
     return ((Ct[3] * (1.0 + u0x[0]) + Ct[4] * u0x[3] + Ct[5] * u0x[6]) -
             (Ct[0] * u0x[1] + Ct[1] * (1.0 + u0x[4]) + Ct[2] * u0x[7]));
   }
 
-  static void evalDrillStrainSens(TacsScalar scale, const TacsScalar u0x[],
-                                  const TacsScalar Ct[], TacsScalar du0x[],
-                                  TacsScalar dCt[]) {
+  TACS_HOST_DEVICE static void evalDrillStrainSens(TacsScalar scale,
+                                                   const TacsScalar u0x[],
+                                                   const TacsScalar Ct[],
+                                                   TacsScalar du0x[],
+                                                   TacsScalar dCt[]) {
     // Derivative with respect to u0x
     du0x[0] = scale * Ct[3];
     du0x[1] = -scale * Ct[0];
@@ -2616,11 +2590,9 @@ class TACSQuaternionRotation {
     dCt[8] = 0.0;
   }
 
-  static TacsScalar evalDrillStrainDeriv(const TacsScalar u0x[],
-                                         const TacsScalar Ct[],
-                                         const TacsScalar u0xd[],
-                                         const TacsScalar Ctd[],
-                                         TacsScalar *ed) {
+  TACS_HOST_DEVICE static TacsScalar evalDrillStrainDeriv(
+      const TacsScalar u0x[], const TacsScalar Ct[], const TacsScalar u0xd[],
+      const TacsScalar Ctd[], TacsScalar *ed) {
     // e2^{T}*Ct*(e1 + u_{,x}*e1) - e1^{T}*Ct*(e2 + u_{,x}*e2)
     *ed = ((Ctd[3] * (1.0 + u0x[0]) + Ctd[4] * u0x[3] + Ctd[5] * u0x[6]) +
            (Ct[3] * u0xd[0] + Ct[4] * u0xd[3] + Ct[5] * u0xd[6])) -
@@ -2631,276 +2603,24 @@ class TACSQuaternionRotation {
             (Ct[0] * u0x[1] + Ct[1] * (1.0 + u0x[4]) + Ct[2] * u0x[7]));
   }
 
-  static void evalDrillStrainHessian(TacsScalar det, const TacsScalar u0x[],
-                                     const TacsScalar Ct[], TacsScalar d2u0x[],
-                                     TacsScalar d2Ct[], TacsScalar d2Ctu0x[]) {
+  TACS_HOST_DEVICE static void evalDrillStrainHessian(TacsScalar det,
+                                                      const TacsScalar u0x[],
+                                                      const TacsScalar Ct[],
+                                                      TacsScalar d2u0x[],
+                                                      TacsScalar d2Ct[],
+                                                      TacsScalar d2Ctu0x[]) {
     memset(d2u0x, 0, 81 * sizeof(TacsScalar));
     memset(d2Ct, 0, 81 * sizeof(TacsScalar));
     memset(d2Ctu0x, 0, 81 * sizeof(TacsScalar));
 
-    // d2Ctu0x[0] = det*(0);
-    // d2Ctu0x[1] = det*(-1);
-    // d2Ctu0x[2] = det*(0);
-    // d2Ctu0x[3] = det*(0);
-    // d2Ctu0x[4] = det*(0);
-    // d2Ctu0x[5] = det*(0);
-    // d2Ctu0x[6] = det*(0);
-    // d2Ctu0x[7] = det*(0);
-    // d2Ctu0x[8] = det*(0);
-    // d2Ctu0x[9] = det*(0);
-    // d2Ctu0x[10] = det*(0);
-    // d2Ctu0x[11] = det*(0);
-    // d2Ctu0x[12] = det*(0);
-    // d2Ctu0x[13] = det*(-1);
-    // d2Ctu0x[14] = det*(0);
-    // d2Ctu0x[15] = det*(0);
-    // d2Ctu0x[16] = det*(0);
-    // d2Ctu0x[17] = det*(0);
-    // d2Ctu0x[18] = det*(0);
-    // d2Ctu0x[19] = det*(0);
-    // d2Ctu0x[20] = det*(0);
-    // d2Ctu0x[21] = det*(0);
-    // d2Ctu0x[22] = det*(0);
-    // d2Ctu0x[23] = det*(0);
-    // d2Ctu0x[24] = det*(0);
-    // d2Ctu0x[25] = det*(-1);
-    // d2Ctu0x[26] = det*(0);
-    // d2Ctu0x[27] = det*(1);
-    // d2Ctu0x[28] = det*(0);
-    // d2Ctu0x[29] = det*(0);
-    // d2Ctu0x[30] = det*(0);
-    // d2Ctu0x[31] = det*(0);
-    // d2Ctu0x[32] = det*(0);
-    // d2Ctu0x[33] = det*(0);
-    // d2Ctu0x[34] = det*(0);
-    // d2Ctu0x[35] = det*(0);
-    // d2Ctu0x[36] = det*(0);
-    // d2Ctu0x[37] = det*(0);
-    // d2Ctu0x[38] = det*(0);
-    // d2Ctu0x[39] = det*(1);
-    // d2Ctu0x[40] = det*(0);
-    // d2Ctu0x[41] = det*(0);
-    // d2Ctu0x[42] = det*(0);
-    // d2Ctu0x[43] = det*(0);
-    // d2Ctu0x[44] = det*(0);
-    // d2Ctu0x[45] = det*(0);
-    // d2Ctu0x[46] = det*(0);
-    // d2Ctu0x[47] = det*(0);
-    // d2Ctu0x[48] = det*(0);
-    // d2Ctu0x[49] = det*(0);
-    // d2Ctu0x[50] = det*(0);
-    // d2Ctu0x[51] = det*(1);
-    // d2Ctu0x[52] = det*(0);
-    // d2Ctu0x[53] = det*(0);
-    // d2Ctu0x[54] = det*(0);
-    // d2Ctu0x[55] = det*(0);
-    // d2Ctu0x[56] = det*(0);
-    // d2Ctu0x[57] = det*(0);
-    // d2Ctu0x[58] = det*(0);
-    // d2Ctu0x[59] = det*(0);
-    // d2Ctu0x[60] = det*(0);
-    // d2Ctu0x[61] = det*(0);
-    // d2Ctu0x[62] = det*(0);
-    // d2Ctu0x[63] = det*(0);
-    // d2Ctu0x[64] = det*(0);
-    // d2Ctu0x[65] = det*(0);
-    // d2Ctu0x[66] = det*(0);
-    // d2Ctu0x[67] = det*(0);
-    // d2Ctu0x[68] = det*(0);
-    // d2Ctu0x[69] = det*(0);
-    // d2Ctu0x[70] = det*(0);
-    // d2Ctu0x[71] = det*(0);
-    // d2Ctu0x[72] = det*(0);
-    // d2Ctu0x[73] = det*(0);
-    // d2Ctu0x[74] = det*(0);
-    // d2Ctu0x[75] = det*(0);
-    // d2Ctu0x[76] = det*(0);
-    // d2Ctu0x[77] = det*(0);
-    // d2Ctu0x[78] = det*(0);
-    // d2Ctu0x[79] = det*(0);
-    // d2Ctu0x[80] = det*(0);
-
-    // d2Ct[0] = scale*(drill*u0x[1]*u0x[1]);
-    // d2Ct[1] = scale*(drill*u0x[1]*(u0x[4] + 1.0));
-    // d2Ct[2] = scale*(drill*u0x[1]*u0x[7]);
-    // d2Ct[3] = scale*(-drill*u0x[1]*(u0x[0] + 1.0));
-    // d2Ct[4] = scale*(-drill*u0x[1]*u0x[3]);
-    // d2Ct[5] = scale*(-drill*u0x[1]*u0x[6]);
-    // d2Ct[6] = 0.0;
-    // d2Ct[7] = 0.0;
-    // d2Ct[8] = 0.0;
-
-    // d2Ct[9] = scale*(drill*u0x[1]*(u0x[4] + 1.0));
-    // d2Ct[10] = scale*(0.5*drill*(u0x[4] + 1.0)*(2.0*u0x[4] + 2.0));
-    // d2Ct[11] = scale*(drill*u0x[7]*(u0x[4] + 1.0));
-    // d2Ct[12] = scale*(-0.5*drill*(u0x[0] + 1.0)*(2.0*u0x[4] + 2.0));
-    // d2Ct[13] = scale*(-drill*u0x[3]*(u0x[4] + 1.0));
-    // d2Ct[14] = scale*(-drill*u0x[6]*(u0x[4] + 1.0));
-    // d2Ct[15] = 0.0;
-    // d2Ct[16] = 0.0;
-    // d2Ct[17] = 0.0;
-
-    // d2Ct[18] = scale*(drill*u0x[1]*u0x[7]);
-    // d2Ct[19] = scale*(drill*u0x[7]*(u0x[4] + 1.0));
-    // d2Ct[20] = scale*(drill*u0x[7]*u0x[7]);
-    // d2Ct[21] = scale*(-drill*u0x[7]*(u0x[0] + 1.0));
-    // d2Ct[22] = scale*(-drill*u0x[3]*u0x[7]);
-    // d2Ct[23] = scale*(-drill*u0x[6]*u0x[7]);
-    // d2Ct[24] = 0.0;
-    // d2Ct[25] = 0.0;
-    // d2Ct[26] = 0.0;
-
-    // d2Ct[27] = scale*(-drill*u0x[1]*(u0x[0] + 1.0));
-    // d2Ct[28] = scale*(-0.5*drill*(2.0*u0x[0] + 2.0)*(u0x[4] + 1.0));
-    // d2Ct[29] = scale*(-drill*u0x[7]*(u0x[0] + 1.0));
-    // d2Ct[30] = scale*(0.5*drill*(u0x[0] + 1.0)*(2.0*u0x[0] + 2.0));
-    // d2Ct[31] = scale*(drill*u0x[3]*(u0x[0] + 1.0));
-    // d2Ct[32] = scale*(drill*u0x[6]*(u0x[0] + 1.0));
-    // d2Ct[33] = 0.0;
-    // d2Ct[34] = 0.0;
-    // d2Ct[35] = 0.0;
-
-    // d2Ct[36] = scale*(-drill*u0x[1]*u0x[3]);
-    // d2Ct[37] = scale*(-drill*u0x[3]*(u0x[4] + 1.0));
-    // d2Ct[38] = scale*(-drill*u0x[3]*u0x[7]);
-    // d2Ct[39] = scale*(drill*u0x[3]*(u0x[0] + 1.0));
-    // d2Ct[40] = scale*(drill*u0x[3]*u0x[3]);
-    // d2Ct[41] = scale*(drill*u0x[3]*u0x[6]);
-    // d2Ct[42] = 0.0;
-    // d2Ct[43] = 0.0;
-    // d2Ct[44] = 0.0;
-
-    // d2Ct[45] = scale*(-drill*u0x[1]*u0x[6]);
-    // d2Ct[46] = scale*(-drill*u0x[6]*(u0x[4] + 1.0));
-    // d2Ct[47] = scale*(-drill*u0x[6]*u0x[7]);
-    // d2Ct[48] = scale*(drill*u0x[6]*(u0x[0] + 1.0));
-    // d2Ct[49] = scale*(drill*u0x[3]*u0x[6]);
-    // d2Ct[50] = scale*(drill*u0x[6]*u0x[6]);
-    // d2Ct[51] = 0.0;
-    // d2Ct[52] = 0.0;
-    // d2Ct[53] = 0.0;
-
-    // d2Ct[54] = 0.0;
-    // d2Ct[55] = 0.0;
-    // d2Ct[56] = 0.0;
-    // d2Ct[57] = 0.0;
-    // d2Ct[58] = 0.0;
-    // d2Ct[59] = 0.0;
-    // d2Ct[60] = 0.0;
-    // d2Ct[61] = 0.0;
-    // d2Ct[62] = 0.0;
-
-    // d2Ct[63] = 0.0;
-    // d2Ct[64] = 0.0;
-    // d2Ct[65] = 0.0;
-    // d2Ct[66] = 0.0;
-    // d2Ct[67] = 0.0;
-    // d2Ct[68] = 0.0;
-    // d2Ct[69] = 0.0;
-    // d2Ct[70] = 0.0;
-    // d2Ct[71] = 0.0;
-
-    // d2Ct[72] = 0.0;
-    // d2Ct[73] = 0.0;
-    // d2Ct[74] = 0.0;
-    // d2Ct[75] = 0.0;
-    // d2Ct[76] = 0.0;
-    // d2Ct[77] = 0.0;
-    // d2Ct[78] = 0.0;
-    // d2Ct[79] = 0.0;
-    // d2Ct[80] = 0.0;
-
-    // d2Ctu0x[0] = scale*(-Ct[3]*drill*u0x[1]);
-    // d2Ctu0x[1] = scale*(drill*(2.0*Ct[0]*u0x[1] + Ct[1]*(u0x[4] + 1.0) +
-    // Ct[2]*u0x[7] - Ct[3]*(u0x[0] + 1.0) - Ct[4]*u0x[3] - Ct[5]*u0x[6]));
-    // d2Ctu0x[2] = 0.0;
-    // d2Ctu0x[3] = scale*(-Ct[4]*drill*u0x[1]);
-    // d2Ctu0x[4] = scale*(Ct[1]*drill*u0x[1]);
-    // d2Ctu0x[5] = 0.0;
-    // d2Ctu0x[6] = scale*(-Ct[5]*drill*u0x[1]);
-    // d2Ctu0x[7] = scale*(Ct[2]*drill*u0x[1]);
-    // d2Ctu0x[8] = 0.0;
-
-    // d2Ctu0x[9] = scale*(-Ct[3]*drill*(u0x[4] + 1.0));
-    // d2Ctu0x[10] = scale*(Ct[0]*drill*(u0x[4] + 1.0));
-    // d2Ctu0x[11] = 0.0;
-    // d2Ctu0x[12] = scale*(-Ct[4]*drill*(u0x[4] + 1.0));
-    // d2Ctu0x[13] = scale*(drill*(Ct[0]*u0x[1] + Ct[1]*(u0x[4] + 1.0) +
-    // 0.5*Ct[1]*(2.0*u0x[4] + 2.0) + Ct[2]*u0x[7] - Ct[3]*(u0x[0] + 1.0) -
-    // Ct[4]*u0x[3] - Ct[5]*u0x[6])); d2Ctu0x[14] = 0.0; d2Ctu0x[15] =
-    // scale*(-Ct[5]*drill*(u0x[4] + 1.0)); d2Ctu0x[16] =
-    // scale*(Ct[2]*drill*(u0x[4] + 1.0)); d2Ctu0x[17] = 0.0;
-
-    // d2Ctu0x[18] = scale*(-Ct[3]*drill*u0x[7]);
-    // d2Ctu0x[19] = scale*(Ct[0]*drill*u0x[7]);
-    // d2Ctu0x[20] = 0.0;
-    // d2Ctu0x[21] = scale*(-Ct[4]*drill*u0x[7]);
-    // d2Ctu0x[22] = scale*(Ct[1]*drill*u0x[7]);
-    // d2Ctu0x[23] = 0.0;
-    // d2Ctu0x[24] = scale*(-Ct[5]*drill*u0x[7]);
-    // d2Ctu0x[25] = scale*(drill*(Ct[0]*u0x[1] + Ct[1]*(u0x[4] + 1.0)
-    // + 2.0*Ct[2]*u0x[7] - Ct[3]*(u0x[0] + 1.0) - Ct[4]*u0x[3] -
-    // Ct[5]*u0x[6])); d2Ctu0x[26] = 0.0;
-
-    // d2Ctu0x[27] = scale*(drill*(-Ct[0]*u0x[1] - Ct[1]*(u0x[4] + 1.0) -
-    // Ct[2]*u0x[7] + Ct[3]*(u0x[0] + 1.0) + 0.5*Ct[3]*(2.0*u0x[0] + 2.0) +
-    // Ct[4]*u0x[3] + Ct[5]*u0x[6])); d2Ctu0x[28] = scale*(-Ct[0]*drill*(u0x[0]
-    // + 1.0)); d2Ctu0x[29] = 0.0; d2Ctu0x[30] = scale*(Ct[4]*drill*(u0x[0]
-    // + 1.0)); d2Ctu0x[31] = scale*(-Ct[1]*drill*(u0x[0] + 1.0)); d2Ctu0x[32] =
-    // 0.0; d2Ctu0x[33] = scale*(Ct[5]*drill*(u0x[0] + 1.0)); d2Ctu0x[34] =
-    // scale*(-Ct[2]*drill*(u0x[0] + 1.0)); d2Ctu0x[35] = 0.0;
-
-    // d2Ctu0x[36] = scale*(Ct[3]*drill*u0x[3]);
-    // d2Ctu0x[37] = scale*(-Ct[0]*drill*u0x[3]);
-    // d2Ctu0x[38] = 0.0;
-    // d2Ctu0x[39] = scale*(drill*(-Ct[0]*u0x[1] - Ct[1]*(u0x[4] + 1.0) -
-    // Ct[2]*u0x[7] + Ct[3]*(u0x[0] + 1.0) + 2.0*Ct[4]*u0x[3] + Ct[5]*u0x[6]));
-    // d2Ctu0x[40] = scale*(-Ct[1]*drill*u0x[3]);
-    // d2Ctu0x[41] = 0.0;
-    // d2Ctu0x[42] = scale*(Ct[5]*drill*u0x[3]);
-    // d2Ctu0x[43] = scale*(-Ct[2]*drill*u0x[3]);
-    // d2Ctu0x[44] = 0.0;
-
-    // d2Ctu0x[45] = scale*(Ct[3]*drill*u0x[6]);
-    // d2Ctu0x[46] = scale*(-Ct[0]*drill*u0x[6]);
-    // d2Ctu0x[47] = 0.0;
-    // d2Ctu0x[48] = scale*(Ct[4]*drill*u0x[6]);
-    // d2Ctu0x[49] = scale*(-Ct[1]*drill*u0x[6]);
-    // d2Ctu0x[50] = 0.0;
-    // d2Ctu0x[51] = scale*(drill*(-Ct[0]*u0x[1] - Ct[1]*(u0x[4] + 1.0) -
-    // Ct[2]*u0x[7] + Ct[3]*(u0x[0] + 1.0) + Ct[4]*u0x[3] + 2.0*Ct[5]*u0x[6]));
-    // d2Ctu0x[52] = scale*(-Ct[2]*drill*u0x[6]);
-    // d2Ctu0x[53] = 0.0;
-
-    // d2Ctu0x[54] = 0.0;
-    // d2Ctu0x[55] = 0.0;
-    // d2Ctu0x[56] = 0.0;
-    // d2Ctu0x[57] = 0.0;
-    // d2Ctu0x[58] = 0.0;
-    // d2Ctu0x[59] = 0.0;
-    // d2Ctu0x[60] = 0.0;
-    // d2Ctu0x[61] = 0.0;
-
-    // d2Ctu0x[62] = 0.0;
-    // d2Ctu0x[63] = 0.0;
-    // d2Ctu0x[64] = 0.0;
-    // d2Ctu0x[65] = 0.0;
-    // d2Ctu0x[66] = 0.0;
-    // d2Ctu0x[67] = 0.0;
-    // d2Ctu0x[68] = 0.0;
-    // d2Ctu0x[69] = 0.0;
-    // d2Ctu0x[70] = 0.0;
-    // d2Ctu0x[71] = 0.0;
-
-    // d2Ctu0x[72] = 0.0;
-    // d2Ctu0x[73] = 0.0;
-    // d2Ctu0x[74] = 0.0;
-    // d2Ctu0x[75] = 0.0;
-    // d2Ctu0x[76] = 0.0;
-    // d2Ctu0x[77] = 0.0;
-    // d2Ctu0x[78] = 0.0;
-    // d2Ctu0x[79] = 0.0;
-    // d2Ctu0x[80] = 0.0;
+    // The drill strain is linear in both Ct and u0x, so the only
+    // non-zero second derivatives are the products of their entries
+    d2Ctu0x[1] = -det;
+    d2Ctu0x[13] = -det;
+    d2Ctu0x[25] = -det;
+    d2Ctu0x[27] = det;
+    d2Ctu0x[39] = det;
+    d2Ctu0x[51] = det;
   }
 };
 
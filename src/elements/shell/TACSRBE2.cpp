@@ -50,6 +50,26 @@ TACSRBE2::TACSRBE2(int _numNodes, int _dof_constrained[]) {
       dof_constrained[j][i] = _dof_constrained[NUM_DISPS * j + i];
     }
   }
+
+  // The artificial stiffness adds to every diagonal block, while the
+  // multipliers couple the independent node and each dependent node
+  num_nz_blocks = NUM_NODES + 4 * NUM_DEP_NODES;
+  nz_blocks = new int[2 * num_nz_blocks];
+  int k = 0;
+  for (int i = 0; i < NUM_NODES; i++) {
+    nz_blocks[k++] = i;
+    nz_blocks[k++] = i;
+  }
+  for (int n = 0; n < NUM_DEP_NODES; n++) {
+    const int m = 1 + NUM_DEP_NODES + n;
+    const int nodes[2] = {0, 1 + n};
+    for (int i = 0; i < 2; i++) {
+      nz_blocks[k++] = nodes[i];
+      nz_blocks[k++] = m;
+      nz_blocks[k++] = m;
+      nz_blocks[k++] = nodes[i];
+    }
+  }
 }
 
 TACSRBE2::~TACSRBE2() {
@@ -59,6 +79,7 @@ TACSRBE2::~TACSRBE2() {
     }
     delete[] dof_constrained;
   }
+  delete[] nz_blocks;
 }
 
 // Default scaling and artificial stiffness parameters
@@ -96,6 +117,15 @@ int TACSRBE2::getVarsPerNode() { return NUM_DISPS; }
 
 int TACSRBE2::getNumNodes() { return NUM_NODES; }
 
+/*
+  Get the (row, column) node pairs of the non-zero blocks of the
+  element matrix
+*/
+int TACSRBE2::getNonZeroNodeBlocks(const int *blocks[]) {
+  *blocks = nz_blocks;
+  return num_nz_blocks;
+}
+
 int TACSRBE2::numExtras() { return NUM_EXTRAS; }
 
 ElementType TACSRBE2::getElementType() { return TACS_RIGID_ELEMENT; }
@@ -106,6 +136,60 @@ void TACSRBE2::getMultiplierIndex( int *multiplier ){
   *multiplier = NUM_DEP_NODES + 1;
 }*/
 
+/*
+  Get the weights that express the dependent node variables in terms
+  of the independent node variables
+
+  These weights can be passed to
+  TACSAssembler::setDependentNodeTransform() to eliminate the dependent
+  nodes from the global system instead of adding this element. The
+  rigid link gives
+
+  u_n = u_0 + theta_0 x (X_n - X_0)
+  theta_n = theta_0
+
+  so that each dependent node has one 6 x 6 block of weights (stored in
+  row-major order) for the independent node.
+
+  @param Xpts The element node locations
+  @param weights The weights for each dependent node
+  @return Fail flag, set if a dependent node has unconstrained dof
+*/
+int TACSRBE2::getDependentNodeTransform(const TacsScalar Xpts[],
+                                        double weights[]) {
+  int fail = 0;
+  const TacsScalar *X0 = &Xpts[0];
+  const TacsScalar *Xn = &Xpts[3];
+  for (int n = 0; n < NUM_DEP_NODES; n++, Xn += 3) {
+    for (int k = 0; k < NUM_DISPS; k++) {
+      if (!dof_constrained[n][k]) {
+        fail = 1;
+      }
+    }
+
+    double r[3];
+    r[0] = TacsRealPart(Xn[0] - X0[0]);
+    r[1] = TacsRealPart(Xn[1] - X0[1]);
+    r[2] = TacsRealPart(Xn[2] - X0[2]);
+
+    double *W = &weights[NUM_DISPS * NUM_DISPS * n];
+    memset(W, 0, NUM_DISPS * NUM_DISPS * sizeof(double));
+    for (int k = 0; k < NUM_DISPS; k++) {
+      W[(NUM_DISPS + 1) * k] = 1.0;
+    }
+
+    // The displacement due to the rotation of the independent node
+    W[4] = r[2];
+    W[5] = -r[1];
+    W[NUM_DISPS + 3] = -r[2];
+    W[NUM_DISPS + 5] = r[0];
+    W[2 * NUM_DISPS + 3] = r[1];
+    W[2 * NUM_DISPS + 4] = -r[0];
+  }
+
+  return fail;
+}
+
 /*
   The element name, variable, stress and strain names.
 */
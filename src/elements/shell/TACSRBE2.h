@@ -26,6 +26,10 @@ class TACSRBE2 : public TACSElement {
   int const* const* getDependentDOFs() { return dof_constrained; }
   int getNumDependentNodes() { return NUM_DEP_NODES; }
 
+  // Get the weights used to eliminate the dependent nodes
+  // -----------------------------------------------------
+  int getDependentNodeTransform(const TacsScalar Xpts[], double weights[]);
+
   // Get the element properties and names
   // ------------------------------------
   const char* getObjectName();
@@ -48,6 +52,7 @@ class TACSRBE2 : public TACSElement {
     return 0.0;
   }
   /*int getMultiplierIndex();*/
+  int getNonZeroNodeBlocks(const int* blocks[]);
 
   // Functions for analysis
   // ----------------------
@@ -94,6 +99,10 @@ class TACSRBE2 : public TACSElement {
   // Flag which dependent dofs to include
   int** dof_constrained;
 
+  // The (row, column) node pairs of the non-zero matrix blocks
+  int num_nz_blocks;
+  int* nz_blocks;
+
   // constraint matrix scaling factor, see ref [2]
   static double C1;
   // artificial stiffness scaling factor, see ref [2]
@@ -62,6 +62,23 @@ TACSRBE3::TACSRBE3(int numNodes, int _dep_dof_constrained[], double weights[],
       indep_dof_constrained[j][i] = _indep_dof_constrained[NUM_DISPS * j + i];
     }
   }
+
+  // The multiplier node couples to every other node, while only the
+  // dependent node and the multiplier node have diagonal blocks
+  const int m = NUM_NODES - 1;
+  num_nz_blocks = 2 * NUM_NODES;
+  nz_blocks = new int[2 * num_nz_blocks];
+  int k = 0;
+  nz_blocks[k++] = 0;
+  nz_blocks[k++] = 0;
+  nz_blocks[k++] = m;
+  nz_blocks[k++] = m;
+  for (int n = 0; n < m; n++) {
+    nz_blocks[k++] = n;
+    nz_blocks[k++] = m;
+    nz_blocks[k++] = m;
+    nz_blocks[k++] = n;
+  }
 }
 
 TACSRBE3::~TACSRBE3() {
@@ -74,6 +91,7 @@ TACSRBE3::~TACSRBE3() {
     }
     delete[] indep_dof_constrained;
   }
+  delete[] nz_blocks;
 }
 
 // Default scaling and artificial stiffness parameters
@@ -111,6 +129,15 @@ int TACSRBE3::getVarsPerNode() { return NUM_DISPS; }
 
 int TACSRBE3::getNumNodes() { return NUM_NODES; }
 
+/*
+  Get the (row, column) node pairs of the non-zero blocks of the
+  element matrix
+*/
+int TACSRBE3::getNonZeroNodeBlocks(const int *blocks[]) {
+  *blocks = nz_blocks;
+  return num_nz_blocks;
+}
+
 int TACSRBE3::numExtras() { return NUM_EXTRAS; }
 
 ElementType TACSRBE3::getElementType() { return TACS_RIGID_ELEMENT; }
@@ -122,6 +149,61 @@ ElementType TACSRBE3::getElementType() { return TACS_RIGID_ELEMENT; }
   return NUM_INDEP_NODES + 1;
 }*/
 
+/*
+  Get the weights that express the dependent node variables in terms
+  of the independent node variables
+
+  These weights can be passed to
+  TACSAssembler::setDependentNodeTransform() to eliminate the dependent
+  node from the global system instead of adding this element. The
+  weights are the coefficients of the constraint equations enforced
+  through the Lagrange multipliers, so that each independent node has
+  one 6 x 6 block of weights (stored in row-major order).
+
+  @param Xpts The element node locations
+  @param weights The weights for each independent node
+  @return Fail flag, set if the dependent node has unconstrained dof
+*/
+int TACSRBE3::getDependentNodeTransform(const TacsScalar Xpts[],
+                                        double weights[]) {
+  int fail = 0;
+  for (int k = 0; k < NUM_DISPS; k++) {
+    if (!dep_dof_constrained[k]) {
+      fail = 1;
+    }
+  }
+
+  TacsScalar *vars = new TacsScalar[NUM_VARIABLES];
+  TacsScalar *zero = new TacsScalar[NUM_VARIABLES];
+  TacsScalar *res = new TacsScalar[NUM_VARIABLES];
+  memset(vars, 0, NUM_VARIABLES * sizeof(TacsScalar));
+  memset(zero, 0, NUM_VARIABLES * sizeof(TacsScalar));
+
+  // The constraint equations are linear, so the coefficients of each
+  // independent variable are found from the residual of a unit input
+  const int ii = NUM_DISPS * (NUM_NODES - 1);
+  for (int n = 0; n < NUM_INDEP_NODES; n++) {
+    double *W = &weights[NUM_DISPS * NUM_DISPS * n];
+    for (int j = 0; j < NUM_DISPS; j++) {
+      vars[NUM_DISPS * (n + 1) + j] = 1.0;
+      memset(res, 0, NUM_VARIABLES * sizeof(TacsScalar));
+      addResidual(0, 0.0, Xpts, vars, zero, zero, res);
+      vars[NUM_DISPS * (n + 1) + j] = 0.0;
+
+      // The constraint is u0 + C*u = 0 so the weights are -C
+      for (int k = 0; k < NUM_DISPS; k++) {
+        W[NUM_DISPS * k + j] = -TacsRealPart(res[ii + k]) / C1;
+      }
+    }
+  }
+
+  delete[] vars;
+  delete[] zero;
+  delete[] res;
+
+  return fail;
+}
+
 /*
   The element name, variable, stress and strain names.
 */
@@ -29,6 +29,10 @@ class TACSRBE3 : public TACSElement {
   const double* getWeights() { return w; }
   int getNumIndependentNodes() { return NUM_INDEP_NODES; }
 
+  // Get the weights used to eliminate the dependent node
+  // ----------------------------------------------------
+  int getDependentNodeTransform(const TacsScalar Xpts[], double weights[]);
+
   // Get the element properties and names
   // ------------------------------------
   const char* getObjectName();
@@ -49,6 +53,7 @@ class TACSRBE3 : public TACSElement {
     return 0.0;
   }
   /*int getMultiplierIndex();*/
+  int getNonZeroNodeBlocks(const int* blocks[]);
 
   // Functions for analysis
   // ----------------------
@@ -113,6 +118,10 @@ class TACSRBE3 : public TACSElement {
   int dep_dof_constrained[NUM_DISPS];
   int** indep_dof_constrained;
 
+  // The (row, column) node pairs of the non-zero matrix blocks
+  int num_nz_blocks;
+  int* nz_blocks;
+
   // constraint matrix scaling factor, see ref [2]
   static double C1;
   // artificial stiffness scaling factor, see ref [2]
@@ -6,9 +6,12 @@
 #include "TACSElementAlgebra.h"
 #include "TACSElementTypes.h"
 #include "TACSElementVerification.h"
+#include "TACSScratchArena.h"
 #include "TACSShellCentrifugalForce.h"
 #include "TACSShellConstitutive.h"
 #include "TACSShellElementModel.h"
+#include "TACSShellElementQuadBasis.h"
+#include "TACSShellElementQuadrature.h"
 #include "TACSShellElementTransform.h"
 #include "TACSShellInertialForce.h"
 #include "TACSShellInplaneElementModel.h"
@@ -60,6 +63,18 @@ class TACSShellElement : public TACSElement {
     else {
       nlElem = this;
     }
+
+    // The geometry cache is not active by default
+    geo_cache_size = 0;
+    geo_cache_version = 1;
+    geo_cache_flags = NULL;
+    geo_cache = NULL;
+
+    // Fill the full element matrices by default
+    upper_fill = 0;
+
+    // Set the default hourglass stiffness coefficient
+    hourglass_coef = 0.1;
   }
 
   ~TACSShellElement() {
@@ -75,10 +90,35 @@ class TACSShellElement : public TACSElement {
     if (nlElem != this) {
       delete nlElem;
     }
+
+    if (geo_cache_flags) {
+      delete[] geo_cache_flags;
+    }
+    if (geo_cache) {
+      delete[] geo_cache;
+    }
   }
 
   const char *getObjectName() { return "TACSShellElement"; }
 
+  void setGeometryCache(int num_elements);
+  void clearGeometryCache() {
+    geo_cache_version++;
+    if (nlElem != this) {
+      nlElem->clearGeometryCache();
+    }
+  }
+  void setUpperMatrixFill(int flag) { upper_fill = flag; }
+
+  /**
+    Set the coefficient of the hourglass stiffness used with the
+    one-point quadrature. A coefficient of one gives a stiffness
+    comparable to the hourglass stiffness under full integration.
+
+    @param coef The hourglass stiffness coefficient
+  */
+  void setHourglassCoefficient(double coef) { hourglass_coef = coef; }
+
   int getVarsPerNode() { return vars_per_node; }
   int getNumNodes() { return num_nodes; }
 
@@ -169,16 +209,53 @@ class TACSShellElement : public TACSElement {
                    const TacsScalar ddvars[], TacsScalar res[],
                    TacsScalar mat[]);
 
+  void addResidualBatch(int numElems, const int elemIndex[], double time,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar res[]);
+
+  void addJacobianBatch(int numElems, const int elemIndex[], double time,
+                        TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar res[], TacsScalar mat[]);
+
   void getMatType(ElementMatrixType matType, int elemIndex, double time,
                   const TacsScalar Xpts[], const TacsScalar vars[],
                   TacsScalar mat[]);
 
+  void getMatVecDataSizes(ElementMatrixType matType, int elemIndex,
+                          int *_data_size, int *_temp_size);
+
+  void getMatVecProductData(ElementMatrixType matType, int elemIndex,
+                            double time, TacsScalar alpha, TacsScalar beta,
+                            TacsScalar gamma, const TacsScalar Xpts[],
+                            const TacsScalar vars[], const TacsScalar dvars[],
+                            const TacsScalar ddvars[], TacsScalar data[]);
+
+  void addMatVecProduct(ElementMatrixType matType, int elemIndex,
+                        const TacsScalar data[], TacsScalar temp[],
+                        const TacsScalar px[], TacsScalar py[]);
+
   void addAdjResProduct(int elemIndex, double time, TacsScalar scale,
                         const TacsScalar psi[], const TacsScalar Xpts[],
                         const TacsScalar vars[], const TacsScalar dvars[],
                         const TacsScalar ddvars[], int dvLen,
                         TacsScalar dfdx[]);
 
+  // The node location derivatives use the finite-difference default, so
+  // each perturbed residual is shared between all the adjoints
+  void addAdjResXptProductMulti(int elemIndex, double time, TacsScalar scale,
+                                int numAdjoints, const TacsScalar psi[],
+                                const TacsScalar Xpts[],
+                                const TacsScalar vars[],
+                                const TacsScalar dvars[],
+                                const TacsScalar ddvars[],
+                                TacsScalar fXptSens[]) {
+    addAdjResXptProductFD(elemIndex, time, scale, numAdjoints, psi, Xpts, vars,
+                          dvars, ddvars, fXptSens);
+  }
+
   int evalPointQuantity(int elemIndex, int quantityType, double time, int n,
                         double pt[], const TacsScalar Xpts[],
                         const TacsScalar vars[], const TacsScalar dvars[],
@@ -217,11 +294,357 @@ class TACSShellElement : public TACSElement {
   static const int dsize = 3 * num_nodes;
   static const int csize = 9 * num_nodes;
 
+  // The size of the matrix-free data stored at each quadrature point
+  static const int matvec_quad_size =
+      27 + TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES + 3;
+
+  // The size of the geometric data stored at each quadrature point and
+  // for the whole element
+  static const int geo_quad_size = 31;
+  static const int geo_size =
+      24 * num_nodes + geo_quad_size * quadrature::NUM_QUADRATURE_POINTS;
+
+  // Compute or retrieve the geometric data for the element
+  void computeGeometry(const TacsScalar Xpts[], TacsScalar geo[]);
+  const TacsScalar *getGeometry(int elemIndex, const TacsScalar Xpts[],
+                                TacsScalar geo[]);
+
+  // Evaluate the tangent stiffness at all quadrature points at once
+  void evalQuadTangentStiffness(int elemIndex, const TacsScalar qgeo[],
+                                TacsScalar Cq[]);
+
+  // Is the residual linear in the element variables?
+  static bool isLinearKinematics() {
+    return ((typeid(model) == typeid(TACSShellLinearModel) ||
+             typeid(model) == typeid(TACSShellInplaneLinearModel)) &&
+            typeid(director) == typeid(TACSLinearizedRotation));
+  }
+
+  // Is the matrix-free Jacobian product computed from the data stored
+  // at the quadrature points?
+  static bool useQuadMatVecData() {
+    return isLinearKinematics() && !hourglass_control;
+  }
+
+  // For the four-node quadrilateral, the last four tying points are the
+  // g23 points at xi = -1, 1 followed by the g13 points at eta = -1, 1
+  static const int hourglass_g23 = basis::NUM_TYING_POINTS - 4;
+  static const int hourglass_g13 = basis::NUM_TYING_POINTS - 2;
+
+  // Are the hourglass modes of the one-point quadrature stabilized?
+  static const int hourglass_control =
+      (quadrature::NUM_QUADRATURE_POINTS == 1 && basis::NUM_NODES == 4);
+
+  // Compute the hourglass vector, the hourglass stiffness for the
+  // displacements, rotations, transverse shear and drilling strains and
+  // the hourglass mass for the displacements and rotations
+  void computeHourglassCoefs(int elemIndex, const TacsScalar Xpts[],
+                             TacsScalar hg[], TacsScalar kh[],
+                             TacsScalar mh[]);
+
+  // Add the hourglass contributions to the residual and to the
+  // derivatives with respect to the drilling and tying strains
+  static void addHourglassResidual(const TacsScalar hg[], const TacsScalar kh[],
+                                   const TacsScalar mh[],
+                                   const TacsScalar vars[],
+                                   const TacsScalar ddvars[],
+                                   const TacsScalar etn[],
+                                   const TacsScalar ety[], TacsScalar res[],
+                                   TacsScalar detn[], TacsScalar dety[]);
+
+  // Add the hourglass contributions to the Jacobian and to the second
+  // derivatives with respect to the drilling and tying strains
+  static void addHourglassJacobian(TacsScalar alpha, TacsScalar gamma,
+                                   const TacsScalar hg[], const TacsScalar kh[],
+                                   const TacsScalar mh[], TacsScalar mat[],
+                                   TacsScalar d2etn[], TacsScalar d2ety[]);
+
   TACSShellTransform *transform;
   TACSShellConstitutive *con;
   TACSElement *nlElem;
+
+  // The cached geometric data, indexed by element
+  int geo_cache_size, geo_cache_version;
+  int *geo_cache_flags;
+  TacsScalar *geo_cache;
+
+  // Flag indicating whether only the upper triangle of the Jacobian is
+  // required
+  int upper_fill;
+
+  // The hourglass stiffness coefficient for the one-point quadrature
+  double hourglass_coef;
 };
 
+/*
+  Allocate (or free when num_elements = 0) the storage for the cached
+  geometric data
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::setGeometryCache(
+    int num_elements) {
+  if (nlElem != this) {
+    nlElem->setGeometryCache(num_elements);
+  }
+  if (num_elements < 0) {
+    num_elements = 0;
+  }
+  if (num_elements == geo_cache_size) {
+    return;
+  }
+
+  if (geo_cache_flags) {
+    delete[] geo_cache_flags;
+  }
+  if (geo_cache) {
+    delete[] geo_cache;
+  }
+  geo_cache_size = num_elements;
+  geo_cache_flags = NULL;
+  geo_cache = NULL;
+
+  if (num_elements > 0) {
+    geo_cache_flags = new int[num_elements];
+    memset(geo_cache_flags, 0, num_elements * sizeof(int));
+    geo_cache = new TacsScalar[(size_t)geo_size * num_elements];
+  }
+}
+
+/*
+  Compute the geometric data for the element. This consists of the
+  node locations, the node normals, the frames and transformations at
+  the nodes, and the location, transformations and determinant of the
+  frame at each quadrature point.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::computeGeometry(
+    const TacsScalar Xpts[], TacsScalar geo[]) {
+  TacsScalar *fn = &geo[3 * num_nodes];
+  TacsScalar *Xdn = &geo[6 * num_nodes];
+  TacsScalar *Tn = &geo[15 * num_nodes];
+  memcpy(geo, Xpts, 3 * num_nodes * sizeof(TacsScalar));
+
+  // Compute the node normal directions and the transformations
+  TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+  for (int i = 0; i < num_nodes; i++) {
+    TacsScalar Xxi[6];
+    TacsShellExtractFrame(&Xdn[9 * i], Xxi);
+    transform->computeTransform(Xxi, &fn[3 * i], &Tn[9 * i]);
+  }
+
+  TacsScalar *qgeo = &geo[24 * num_nodes];
+  const int nquad = quadrature::getNumQuadraturePoints();
+  for (int quad_index = 0; quad_index < nquad; quad_index++) {
+    double pt[3];
+    quadrature::getQuadraturePoint(quad_index, pt);
+
+    // Compute X, X,xi and the interpolated normal n0
+    TacsScalar Xxi[6], n0[3];
+    basis::template interpFields<3, 3>(pt, Xpts, &qgeo[0]);
+    basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
+    basis::template interpFields<3, 3>(pt, fn, n0);
+
+    // Compute the transformation at the quadrature point
+    transform->computeTransform(Xxi, n0, &qgeo[3]);
+    qgeo[30] = TacsShellComputeXdinvT<basis>(pt, fn, Xxi, n0, &qgeo[3],
+                                             &qgeo[12], &qgeo[21]);
+    qgeo += geo_quad_size;
+  }
+}
+
+/*
+  Get the geometric data for the element
+
+  When the cache is active, the data is computed the first time it is
+  requested after the cache is cleared and re-used afterwards. The
+  nodes are stored with the data, so calls with other node locations
+  (such as finite-difference perturbations) are computed into the
+  temporary array geo instead. Each element index is only accessed by
+  the thread assembling it.
+*/
+template <class quadrature, class basis, class director, class model>
+const TacsScalar *
+TACSShellElement<quadrature, basis, director, model>::getGeometry(
+    int elemIndex, const TacsScalar Xpts[], TacsScalar geo[]) {
+  if (geo_cache && elemIndex >= 0 && elemIndex < geo_cache_size) {
+    TacsScalar *data = &geo_cache[(size_t)geo_size * elemIndex];
+    if (geo_cache_flags[elemIndex] != geo_cache_version) {
+      computeGeometry(Xpts, data);
+      geo_cache_flags[elemIndex] = geo_cache_version;
+      return data;
+    }
+
+    int equal = 1;
+    for (int i = 0; i < 3 * num_nodes; i++) {
+      if (data[i] != Xpts[i]) {
+        equal = 0;
+        break;
+      }
+    }
+    if (equal) {
+      return data;
+    }
+  }
+
+  computeGeometry(Xpts, geo);
+  return geo;
+}
+
+/*
+  Evaluate the tangent stiffness at the quadrature points of the element
+  with a single batched call to the constitutive object. The point
+  locations are taken from the geometric data at the quadrature points.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::
+    evalQuadTangentStiffness(int elemIndex, const TacsScalar qgeo[],
+                             TacsScalar Cq[]) {
+  const int nquad = quadrature::getNumQuadraturePoints();
+
+  int elems[quadrature::NUM_QUADRATURE_POINTS];
+  double pts[3 * quadrature::NUM_QUADRATURE_POINTS];
+  TacsScalar X[3 * quadrature::NUM_QUADRATURE_POINTS];
+  for (int i = 0; i < nquad; i++) {
+    elems[i] = elemIndex;
+    pts[3 * i + 2] = 0.0;
+    quadrature::getQuadraturePoint(i, &pts[3 * i]);
+    X[3 * i] = qgeo[geo_quad_size * i];
+    X[3 * i + 1] = qgeo[geo_quad_size * i + 1];
+    X[3 * i + 2] = qgeo[geo_quad_size * i + 2];
+  }
+
+  con->evalTangentStiffnessBatch(nquad, elems, pts, X, Cq);
+}
+
+/*
+  Compute the hourglass vector and the coefficients of the hourglass
+  stiffness and mass for the one-point quadrature.
+
+  The hourglass energy for each displacement and rotation component is
+  0.5*kh*(hg^{T}*u)^2, with the stiffness scaled by the average
+  in-plane membrane or bending stiffness. The modes that are linear in
+  the transverse shear strain are stabilized through the differences of
+  the g13 and g23 tying strains, and the linear drilling rotation modes
+  through the deviation of the nodal drilling strains from their mean.
+  The stiffness coefficients are set such that hourglass_coef = 1 gives
+  the stiffness of these modes for a fully integrated rectangle. The
+  mass is the consistent mass of the hourglass mode for a parallelogram.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::
+    computeHourglassCoefs(int elemIndex, const TacsScalar Xpts[],
+                          TacsScalar hg[], TacsScalar kh[], TacsScalar mh[]) {
+  TacsScalar area, gg[2];
+  TacsScalar bb = TacsShellComputeHourglassVector(Xpts, hg, &area, gg);
+
+  // Evaluate the stiffness and mass moments at the element center
+  double pt[3] = {0.0, 0.0, 0.0};
+  TacsScalar X[3];
+  basis::template interpFields<3, 3>(pt, Xpts, X);
+
+  TacsScalar C[TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES];
+  con->evalTangentStiffness(elemIndex, pt, X, C);
+  TacsScalar moments[3];
+  con->evalMassMoments(elemIndex, pt, X, moments);
+
+  TacsScalar kscale = hourglass_coef * area;
+  kh[0] = 0.5 * kscale * (C[0] + C[3]) * bb / 12.0;
+  kh[1] = 0.5 * kscale * (C[12] + C[15]) * bb / 12.0;
+  kh[2] = 0.5 * kscale * (C[18] + C[20]) * gg[0] / 3.0;
+  kh[3] = 0.5 * kscale * (C[18] + C[20]) * gg[1] / 3.0;
+  kh[4] = kscale * C[21] / 12.0;
+
+  mh[0] = moments[0] * area / 144.0;
+  mh[1] = moments[2] * area / 144.0;
+}
+
+/*
+  Add the hourglass forces for the displacements and the first three
+  rotational parameters to the residual, and the derivatives of the
+  hourglass energy of the drilling and g13/g23 tying strains to detn
+  and dety
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::addHourglassResidual(
+    const TacsScalar hg[], const TacsScalar kh[], const TacsScalar mh[],
+    const TacsScalar vars[], const TacsScalar ddvars[], const TacsScalar etn[],
+    const TacsScalar ety[], TacsScalar res[], TacsScalar detn[],
+    TacsScalar dety[]) {
+  for (int j = 0; j < 2; j++) {
+    for (int k = j * offset; k < j * offset + 3; k++) {
+      TacsScalar q = 0.0, qddot = 0.0;
+      for (int i = 0; i < num_nodes; i++) {
+        q += hg[i] * vars[vars_per_node * i + k];
+        qddot += hg[i] * ddvars[vars_per_node * i + k];
+      }
+
+      TacsScalar f = kh[j] * q + mh[j] * qddot;
+      for (int i = 0; i < num_nodes; i++) {
+        res[vars_per_node * i + k] += hg[i] * f;
+      }
+    }
+  }
+
+  const int g23 = hourglass_g23, g13 = hourglass_g13;
+  TacsScalar d23 = kh[3] * (ety[g23 + 1] - ety[g23]);
+  TacsScalar d13 = kh[2] * (ety[g13 + 1] - ety[g13]);
+  dety[g23] -= d23;
+  dety[g23 + 1] += d23;
+  dety[g13] -= d13;
+  dety[g13 + 1] += d13;
+
+  TacsScalar etm = 0.0;
+  for (int i = 0; i < num_nodes; i++) {
+    etm += etn[i];
+  }
+  etm *= 1.0 / num_nodes;
+  for (int i = 0; i < num_nodes; i++) {
+    detn[i] += kh[4] * (etn[i] - etm);
+  }
+}
+
+/*
+  Add the hourglass stiffness and mass to the Jacobian, and the second
+  derivatives of the hourglass energy of the drilling and g13/g23 tying
+  strains to d2etn and d2ety
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::addHourglassJacobian(
+    TacsScalar alpha, TacsScalar gamma, const TacsScalar hg[],
+    const TacsScalar kh[], const TacsScalar mh[], TacsScalar mat[],
+    TacsScalar d2etn[], TacsScalar d2ety[]) {
+  const int nvars = vars_per_node * num_nodes;
+  for (int j = 0; j < 2; j++) {
+    TacsScalar coef = alpha * kh[j] + gamma * mh[j];
+    for (int k = j * offset; k < j * offset + 3; k++) {
+      for (int i = 0; i < num_nodes; i++) {
+        TacsScalar *row = &mat[nvars * (vars_per_node * i + k)];
+        for (int l = 0; l < num_nodes; l++) {
+          row[vars_per_node * l + k] += coef * hg[i] * hg[l];
+        }
+      }
+    }
+  }
+
+  const int nty = basis::NUM_TYING_POINTS;
+  const int index[] = {hourglass_g23, hourglass_g13};
+  for (int j = 0; j < 2; j++) {
+    const int t = index[j];
+    TacsScalar coef = alpha * kh[3 - j];
+    d2ety[nty * t + t] += coef;
+    d2ety[nty * t + t + 1] -= coef;
+    d2ety[nty * (t + 1) + t] -= coef;
+    d2ety[nty * (t + 1) + t + 1] += coef;
+  }
+
+  for (int i = 0; i < num_nodes; i++) {
+    for (int l = 0; l < num_nodes; l++) {
+      d2etn[num_nodes * i + l] -= alpha * kh[4] / (1.0 * num_nodes);
+    }
+    d2etn[(num_nodes + 1) * i] += alpha * kh[4];
+  }
+}
+
 /*
   Compute the kinetic and potential energies of the shell
 */
@@ -318,6 +741,38 @@ void TACSShellElement<quadrature, basis, director, model>::computeEnergies(
               moments[2] * vec3Dot(d0dot, d0dot));
   }
 
+  // Add the energies of the hourglass modes
+  if (hourglass_control) {
+    TacsScalar hg[num_nodes], kh[5], mh[2];
+    computeHourglassCoefs(elemIndex, Xpts, hg, kh, mh);
+
+    for (int j = 0; j < 2; j++) {
+      for (int k = j * offset; k < j * offset + 3; k++) {
+        TacsScalar q = 0.0, qdot = 0.0;
+        for (int i = 0; i < num_nodes; i++) {
+          q += hg[i] * vars[vars_per_node * i + k];
+          qdot += hg[i] * dvars[vars_per_node * i + k];
+        }
+        Uelem += 0.5 * kh[j] * q * q;
+        Telem += 0.5 * mh[j] * qdot * qdot;
+      }
+    }
+
+    const int g23 = hourglass_g23, g13 = hourglass_g13;
+    TacsScalar d23 = ety[g23 + 1] - ety[g23];
+    TacsScalar d13 = ety[g13 + 1] - ety[g13];
+    Uelem += 0.5 * (kh[3] * d23 * d23 + kh[2] * d13 * d13);
+
+    TacsScalar etm = 0.0;
+    for (int i = 0; i < num_nodes; i++) {
+      etm += etn[i];
+    }
+    etm *= 1.0 / num_nodes;
+    for (int i = 0; i < num_nodes; i++) {
+      Uelem += 0.5 * kh[4] * (etn[i] - etm) * (etn[i] - etm);
+    }
+  }
+
   *Te = Telem;
   *Ue = Uelem;
 }
@@ -337,9 +792,14 @@ void TACSShellElement<quadrature, basis, director, model>::addResidual(
   TacsScalar dd[dsize];
   memset(dd, 0, 3 * num_nodes * sizeof(TacsScalar));
 
-  // Compute the node normal directions
-  TacsScalar fn[3 * num_nodes], Xdn[9 * num_nodes];
-  TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+  // Get the node normal directions and the transformations at the
+  // nodes and quadrature points
+  TacsScalar geo_data[geo_size];
+  const TacsScalar *geo = getGeometry(elemIndex, Xpts, geo_data);
+  const TacsScalar *fn = &geo[3 * num_nodes];
+  const TacsScalar *Xdn = &geo[6 * num_nodes];
+  const TacsScalar *Tn = &geo[15 * num_nodes];
+  const TacsScalar *qgeo = &geo[24 * num_nodes];
 
   // Compute the drill strain penalty at each node
   TacsScalar etn[num_nodes], detn[num_nodes];
@@ -347,10 +807,10 @@ void TACSShellElement<quadrature, basis, director, model>::addResidual(
 
   // Store information about the transformation and derivatives at each node for
   // the drilling degrees of freedom
-  TacsScalar XdinvTn[9 * num_nodes], Tn[9 * num_nodes];
+  TacsScalar XdinvTn[9 * num_nodes];
   TacsScalar u0xn[9 * num_nodes], Ctn[csize];
   TacsShellComputeDrillStrain<vars_per_node, offset, basis, director, model>(
-      transform, Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, etn);
+      Xdn, fn, vars, Tn, XdinvTn, u0xn, Ctn, etn);
 
   TacsScalar d[dsize], ddot[dsize], dddot[dsize];
   director::template computeDirectorRates<vars_per_node, offset, num_nodes>(
@@ -368,22 +828,22 @@ void TACSShellElement<quadrature, basis, director, model>::addResidual(
     double pt[3];
     double weight = quadrature::getQuadraturePoint(quad_index, pt);
 
-    // Compute X, X,xi and the interpolated normal n0
-    TacsScalar X[3], Xxi[6], n0[3], T[9], et;
-    basis::template interpFields<3, 3>(pt, Xpts, X);
-    basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
-    basis::template interpFields<3, 3>(pt, fn, n0);
-    basis::template interpFields<1, 1>(pt, etn, &et);
+    // Set pointers to the point location and the transformations
+    const TacsScalar *X = &qgeo[0];
+    const TacsScalar *T = &qgeo[3];
+    const TacsScalar *XdinvT = &qgeo[12];
+    const TacsScalar *XdinvzT = &qgeo[21];
+    TacsScalar detXd = weight * qgeo[30];
+    qgeo += geo_quad_size;
 
-    // Compute the transformation at the quadrature point
-    transform->computeTransform(Xxi, n0, T);
+    // Interpolate the drill strain
+    TacsScalar et;
+    basis::template interpFields<1, 1>(pt, etn, &et);
 
     // Evaluate the displacement gradient at the point
-    TacsScalar XdinvT[9], XdinvzT[9];
     TacsScalar u0x[9], u1x[9];
-    TacsScalar detXd = TacsShellComputeDispGrad<vars_per_node, basis>(
-        pt, Xpts, vars, fn, d, Xxi, n0, T, XdinvT, XdinvzT, u0x, u1x);
-    detXd *= weight;
+    TacsShellInterpDispGrad<vars_per_node, basis>(pt, vars, d, T, XdinvT,
+                                                  XdinvzT, u0x, u1x);
 
     // Evaluate the tying components of the strain
     TacsScalar gty[6];  // The symmetric components of the tying strain
@@ -445,6 +905,13 @@ void TACSShellElement<quadrature, basis, director, model>::addResidual(
     basis::template addInterpFieldsTranspose<3, 3>(pt, dd0dot, dd);
   }
 
+  // Add the hourglass forces for the one-point quadrature
+  if (hourglass_control) {
+    TacsScalar hg[num_nodes], kh[5], mh[2];
+    computeHourglassCoefs(elemIndex, Xpts, hg, kh, mh);
+    addHourglassResidual(hg, kh, mh, vars, ddvars, etn, ety, res, detn, dety);
+  }
+
   // Add the contribution to the residual from the drill strain
   TacsShellAddDrillStrainSens<vars_per_node, offset, basis, director, model>(
       Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, res);
@@ -461,6 +928,46 @@ void TACSShellElement<quadrature, basis, director, model>::addResidual(
   // rotational parametrization) - if any
   director::template addRotationConstraint<vars_per_node, offset, num_nodes>(
       vars, res);
+
+}
+
+/*
+  Add the residuals for a batch of elements.
+
+  The shell element calls are resolved at compile time here so that
+  the element kernels are inlined into a single loop over the batch.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::addResidualBatch(
+    int numElems, const int elemIndex[], double time, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar res[]) {
+  const int nx = 3 * num_nodes;
+  const int nvars = vars_per_node * num_nodes;
+  for (int i = 0; i < numElems; i++) {
+    TACSShellElement::addResidual(elemIndex[i], time, &Xpts[nx * i],
+                                  &vars[nvars * i], &dvars[nvars * i],
+                                  &ddvars[nvars * i], &res[nvars * i]);
+  }
+}
+
+/*
+  Add the residuals and Jacobians for a batch of elements
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::addJacobianBatch(
+    int numElems, const int elemIndex[], double time, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar res[], TacsScalar mat[]) {
+  const int nx = 3 * num_nodes;
+  const int nvars = vars_per_node * num_nodes;
+  for (int i = 0; i < numElems; i++) {
+    TACSShellElement::addJacobian(elemIndex[i], time, alpha, beta, gamma,
+                                  &Xpts[nx * i], &vars[nvars * i],
+                                  &dvars[nvars * i], &ddvars[nvars * i],
+                                  &res[nvars * i], &mat[nvars * nvars * i]);
+  }
 }
 
 /*
@@ -499,9 +1006,19 @@ void TACSShellElement<quadrature, basis, director, model>::addJacobian(
   memset(d2etyu, 0, basis::NUM_TYING_POINTS * usize * sizeof(TacsScalar));
   memset(d2etyd, 0, basis::NUM_TYING_POINTS * dsize * sizeof(TacsScalar));
 
-  // Compute the node normal directions
-  TacsScalar fn[3 * num_nodes], Xdn[9 * num_nodes];
-  TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+  // Get the node normal directions and the transformations at the
+  // nodes and quadrature points
+  TacsScalar geo_data[geo_size];
+  const TacsScalar *geo = getGeometry(elemIndex, Xpts, geo_data);
+  const TacsScalar *fn = &geo[3 * num_nodes];
+  const TacsScalar *Xdn = &geo[6 * num_nodes];
+  const TacsScalar *Tn = &geo[15 * num_nodes];
+  const TacsScalar *qgeo = &geo[24 * num_nodes];
+
+  // Evaluate the tangent stiffness at all the quadrature points
+  TacsScalar Cq[TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES *
+                quadrature::NUM_QUADRATURE_POINTS];
+  evalQuadTangentStiffness(elemIndex, qgeo, Cq);
 
   // Compute the drill strain penalty at each node
   TacsScalar etn[num_nodes], detn[num_nodes];
@@ -511,10 +1028,10 @@ void TACSShellElement<quadrature, basis, director, model>::addJacobian(
 
   // Store information about the transformation and derivatives at each node for
   // the drilling degrees of freedom
-  TacsScalar XdinvTn[9 * num_nodes], Tn[9 * num_nodes];
+  TacsScalar XdinvTn[9 * num_nodes];
   TacsScalar u0xn[9 * num_nodes], Ctn[csize];
   TacsShellComputeDrillStrain<vars_per_node, offset, basis, director, model>(
-      transform, Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, etn);
+      Xdn, fn, vars, Tn, XdinvTn, u0xn, Ctn, etn);
 
   TacsScalar d[dsize], ddot[dsize], dddot[dsize];
   director::template computeDirectorRates<vars_per_node, offset, num_nodes>(
@@ -531,22 +1048,22 @@ void TACSShellElement<quadrature, basis, director, model>::addJacobian(
     double pt[3];
     double weight = quadrature::getQuadraturePoint(quad_index, pt);
 
-    // Compute X, X,xi and the interpolated normal n0
-    TacsScalar X[3], Xxi[6], n0[3], T[9], et;
-    basis::template interpFields<3, 3>(pt, Xpts, X);
-    basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
-    basis::template interpFields<3, 3>(pt, fn, n0);
-    basis::template interpFields<1, 1>(pt, etn, &et);
+    // Set pointers to the point location and the transformations
+    const TacsScalar *X = &qgeo[0];
+    const TacsScalar *T = &qgeo[3];
+    const TacsScalar *XdinvT = &qgeo[12];
+    const TacsScalar *XdinvzT = &qgeo[21];
+    TacsScalar detXd = weight * qgeo[30];
+    qgeo += geo_quad_size;
 
-    // Compute the transformation at the quadrature point
-    transform->computeTransform(Xxi, n0, T);
+    // Interpolate the drill strain
+    TacsScalar et;
+    basis::template interpFields<1, 1>(pt, etn, &et);
 
     // Evaluate the displacement gradient at the point
-    TacsScalar XdinvT[9], XdinvzT[9];
     TacsScalar u0x[9], u1x[9];
-    TacsScalar detXd = TacsShellComputeDispGrad<vars_per_node, basis>(
-        pt, Xpts, vars, fn, d, Xxi, n0, T, XdinvT, XdinvzT, u0x, u1x);
-    detXd *= weight;
+    TacsShellInterpDispGrad<vars_per_node, basis>(pt, vars, d, T, XdinvT,
+                                                  XdinvzT, u0x, u1x);
 
     // Evaluate the tying components of the strain
     TacsScalar gty[6];  // The symmetric components of the tying strain
@@ -561,9 +1078,9 @@ void TACSShellElement<quadrature, basis, director, model>::addJacobian(
     model::evalStrain(u0x, u1x, e0ty, e);
     e[8] = et;
 
-    // Compute the tangent stiffness matrix
-    TacsScalar Cs[TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES];
-    con->evalTangentStiffness(elemIndex, pt, X, Cs);
+    // Get the tangent stiffness matrix at this point
+    const TacsScalar *Cs =
+        &Cq[TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES * quad_index];
 
     TacsScalar drill;
     const TacsScalar *A, *B, *D, *As;
@@ -648,9 +1165,17 @@ void TACSShellElement<quadrature, basis, director, model>::addJacobian(
     basis::template addInterpFieldsOuterProduct<3, 3, 3, 3>(pt, d2Td, d2Tdotu);
   }
 
+  // Add the hourglass terms for the one-point quadrature
+  if (hourglass_control) {
+    TacsScalar hg[num_nodes], kh[5], mh[2];
+    computeHourglassCoefs(elemIndex, Xpts, hg, kh, mh);
+    addHourglassResidual(hg, kh, mh, vars, ddvars, etn, ety, res, detn, dety);
+    addHourglassJacobian(alpha, gamma, hg, kh, mh, mat, d2etn, d2ety);
+  }
+
   // Add the contribution to the residual from the drill strain
   TacsShellAddDrillStrainHessian<vars_per_node, offset, basis, director, model>(
-      Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, d2etn, res, mat);
+      alpha, Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, d2etn, res, mat);
 
   // Add the residual from the tying strain
   model::template addComputeTyingStrainTranspose<vars_per_node, basis>(
@@ -671,6 +1196,396 @@ void TACSShellElement<quadrature, basis, director, model>::addJacobian(
                                                           mat);
 }
 
+/*
+  Evaluate the bilinear shape functions and their derivatives with
+  respect to the parameters for the four-node shell element
+*/
+TACS_HOST_DEVICE inline void TacsShellQuad4ShapeFunctions(const double pt[],
+                                                          double N[],
+                                                          double Na[],
+                                                          double Nb[]) {
+  N[0] = 0.25 * (1.0 - pt[0]) * (1.0 - pt[1]);
+  N[1] = 0.25 * (1.0 + pt[0]) * (1.0 - pt[1]);
+  N[2] = 0.25 * (1.0 - pt[0]) * (1.0 + pt[1]);
+  N[3] = 0.25 * (1.0 + pt[0]) * (1.0 + pt[1]);
+
+  Na[0] = -0.25 * (1.0 - pt[1]);
+  Na[1] = 0.25 * (1.0 - pt[1]);
+  Na[2] = -0.25 * (1.0 + pt[1]);
+  Na[3] = 0.25 * (1.0 + pt[1]);
+
+  Nb[0] = -0.25 * (1.0 - pt[0]);
+  Nb[1] = -0.25 * (1.0 + pt[0]);
+  Nb[2] = 0.25 * (1.0 - pt[0]);
+  Nb[3] = 0.25 * (1.0 + pt[0]);
+}
+
+/*
+  Add the contributions to the residual and Jacobian matrix for the
+  linear four-node shell (TACSQuad4Shell)
+
+  The strain is linear in the element variables for this element, so
+  the strain at each quadrature point is written as e = B*q, where the
+  rows of B are formed directly from the bilinear shape functions, the
+  director matrices d = -n^{x}*q and the transformations. The rows of
+  B for the tying strains and the drilling strain are formed once per
+  element and interpolated to the quadrature points. The stiffness
+  contribution is then B^{T}*C*B, with all loop bounds fixed at
+  compile time.
+*/
+template <>
+inline void TACSShellElement<TACSQuadLinearQuadrature, TACSShellQuadBasis<2>,
+                             TACSLinearizedRotation, TACSShellLinearModel>::
+    addJacobian(int elemIndex, double time, TacsScalar alpha, TacsScalar beta,
+                TacsScalar gamma, const TacsScalar Xpts[],
+                const TacsScalar vars[], const TacsScalar dvars[],
+                const TacsScalar ddvars[], TacsScalar res[],
+                TacsScalar mat[]) {
+  typedef TACSQuadLinearQuadrature quadrature;
+  typedef TACSShellQuadBasis<2> basis;
+  const int nvars = vars_per_node * num_nodes;
+  const int ntying = basis::NUM_TYING_POINTS;
+  const int nquad = quadrature::getNumQuadraturePoints();
+
+  // Get the node normal directions and the transformations at the
+  // nodes and quadrature points
+  TacsScalar geo_data[geo_size];
+  const TacsScalar *geo = getGeometry(elemIndex, Xpts, geo_data);
+  const TacsScalar *fn = &geo[3 * num_nodes];
+  const TacsScalar *Xdn = &geo[6 * num_nodes];
+  const TacsScalar *Tn = &geo[15 * num_nodes];
+  const TacsScalar *qgeo = &geo[24 * num_nodes];
+
+  // Evaluate the tangent stiffness at all the quadrature points
+  TacsScalar Cq[TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES *
+                quadrature::NUM_QUADRATURE_POINTS];
+  evalQuadTangentStiffness(elemIndex, qgeo, Cq);
+
+  // Compute the director matrices such that d = Dn*q = q x n
+  TacsScalar Dn[9 * num_nodes];
+  for (int i = 0; i < num_nodes; i++) {
+    setMatSkew(-1.0, &fn[3 * i], &Dn[9 * i]);
+  }
+
+  // Compute the rows of B for the strain at each tying point
+  TacsScalar Bty[ntying * nvars];
+  memset(Bty, 0, ntying * nvars * sizeof(TacsScalar));
+  for (int index = 0; index < ntying; index++) {
+    const TacsShellTyingStrainComponent field = basis::getTyingField(index);
+
+    double pt[2], N[4], Na[4], Nb[4];
+    basis::getTyingPoint(index, pt);
+    TacsShellQuad4ShapeFunctions(pt, N, Na, Nb);
+
+    // Compute the frame derivatives and the normal at the tying point
+    TacsScalar X1[3] = {0.0, 0.0, 0.0}, X2[3] = {0.0, 0.0, 0.0};
+    TacsScalar n0[3] = {0.0, 0.0, 0.0};
+    for (int j = 0; j < num_nodes; j++) {
+      for (int k = 0; k < 3; k++) {
+        X1[k] += Na[j] * Xpts[3 * j + k];
+        X2[k] += Nb[j] * Xpts[3 * j + k];
+        n0[k] += N[j] * fn[3 * j + k];
+      }
+    }
+
+    TacsScalar *b = &Bty[nvars * index];
+    for (int j = 0; j < num_nodes; j++, b += vars_per_node) {
+      if (field == TACS_SHELL_G11_COMPONENT) {
+        for (int k = 0; k < 3; k++) {
+          b[k] = Na[j] * X1[k];
+        }
+      } else if (field == TACS_SHELL_G22_COMPONENT) {
+        for (int k = 0; k < 3; k++) {
+          b[k] = Nb[j] * X2[k];
+        }
+      } else if (field == TACS_SHELL_G12_COMPONENT) {
+        for (int k = 0; k < 3; k++) {
+          b[k] = 0.5 * (Nb[j] * X1[k] + Na[j] * X2[k]);
+        }
+      } else {
+        // g23 = 0.5*(X,2^{T}*d0 + n0^{T}*u,2)
+        // g13 = 0.5*(X,1^{T}*d0 + n0^{T}*u,1)
+        const TacsScalar *Xt = X1;
+        double Nt = Na[j];
+        if (field == TACS_SHELL_G23_COMPONENT) {
+          Xt = X2;
+          Nt = Nb[j];
+        }
+
+        const TacsScalar *Dj = &Dn[9 * j];
+        for (int k = 0; k < 3; k++) {
+          b[k] = 0.5 * Nt * n0[k];
+          b[3 + k] = 0.5 * N[j] *
+                     (Dj[k] * Xt[0] + Dj[3 + k] * Xt[1] + Dj[6 + k] * Xt[2]);
+        }
+      }
+    }
+  }
+
+  // Compute the rows of B for the drilling strain at each node
+  TacsScalar Bdn[num_nodes * nvars];
+  memset(Bdn, 0, num_nodes * nvars * sizeof(TacsScalar));
+  for (int i = 0; i < num_nodes; i++) {
+    double pt[2], N[4], Na[4], Nb[4];
+    basis::getNodePoint(i, pt);
+    TacsShellQuad4ShapeFunctions(pt, N, Na, Nb);
+
+    // Compute XdinvT = Xdinv*T at the node
+    const TacsScalar *T = &Tn[9 * i];
+    TacsScalar Xdinv[9], XdinvT[9];
+    inv3x3(&Xdn[9 * i], Xdinv);
+    mat3x3MatMult(Xdinv, T, XdinvT);
+
+    // The drilling strain 0.5*(u0x[3] - u0x[1]) from the displacements
+    TacsScalar *b = &Bdn[nvars * i];
+    for (int j = 0; j < num_nodes; j++) {
+      TacsScalar w0 = Na[j] * XdinvT[0] + Nb[j] * XdinvT[3];
+      TacsScalar w1 = Na[j] * XdinvT[1] + Nb[j] * XdinvT[4];
+      for (int a = 0; a < 3; a++) {
+        b[vars_per_node * j + a] = 0.5 * (T[3 * a + 1] * w0 - T[3 * a] * w1);
+      }
+    }
+
+    // The contribution 0.5*(Ct[3] - Ct[1]) from the rotation at the
+    // node, where Ct = T^{T}*C*T and C = I - q^{x}
+    TacsScalar t1[3], t2[3], t3[3];
+    t1[0] = T[0];
+    t1[1] = T[3];
+    t1[2] = T[6];
+    t2[0] = T[1];
+    t2[1] = T[4];
+    t2[2] = T[7];
+    crossProduct(t1, t2, t3);
+    for (int k = 0; k < 3; k++) {
+      b[vars_per_node * i + 3 + k] = -t3[k];
+    }
+  }
+
+  // The pairs of indices of the tying strain fields, ordered by the
+  // field index, and the factors for the corresponding strains
+  const int ty_index[][2] = {{0, 0}, {1, 1}, {0, 1}, {1, 2}, {0, 2}};
+  const int ty_strain[] = {0, 1, 2, 6, 7};
+  const double ty_scale[] = {1.0, 1.0, 2.0, 2.0, 2.0};
+
+  for (int quad_index = 0; quad_index < nquad; quad_index++) {
+    // Get the quadrature weight and the shape functions
+    double pt[3], N[4], Na[4], Nb[4];
+    double weight = quadrature::getQuadraturePoint(quad_index, pt);
+    TacsShellQuad4ShapeFunctions(pt, N, Na, Nb);
+
+    // Set pointers to the point location and the transformations
+    const TacsScalar *X = &qgeo[0];
+    const TacsScalar *T = &qgeo[3];
+    const TacsScalar *XdinvT = &qgeo[12];
+    const TacsScalar *XdinvzT = &qgeo[21];
+    TacsScalar detXd = weight * qgeo[30];
+    qgeo += geo_quad_size;
+
+    // Interpolate the rows of the tying strain fields
+    double Nty[ntying];
+    basis::evalTyingInterp(pt, Nty);
+
+    TacsScalar Bg[5 * nvars];
+    memset(Bg, 0, 5 * nvars * sizeof(TacsScalar));
+    for (int index = 0; index < ntying; index++) {
+      TacsScalar *b = &Bg[nvars * basis::getTyingField(index)];
+      const TacsScalar *bty = &Bty[nvars * index];
+      for (int v = 0; v < nvars; v++) {
+        b[v] += Nty[index] * bty[v];
+      }
+    }
+
+    // Compute the rows of the full strain, where the in-plane and
+    // transverse shear strains are the components of
+    // e0ty = XdinvT^{T}*gty*XdinvT
+    TacsScalar Be[9 * nvars];
+    memset(Be, 0, 9 * nvars * sizeof(TacsScalar));
+    for (int m = 0; m < 5; m++) {
+      const int p = ty_index[m][0], q = ty_index[m][1];
+      TacsScalar *b = &Be[nvars * ty_strain[m]];
+
+      for (int f = 0; f < 5; f++) {
+        const int k = ty_index[f][0], l = ty_index[f][1];
+        TacsScalar c = XdinvT[3 * k + p] * XdinvT[3 * l + q];
+        if (k != l) {
+          c += XdinvT[3 * l + p] * XdinvT[3 * k + q];
+        }
+        c *= ty_scale[m];
+
+        const TacsScalar *bg = &Bg[nvars * f];
+        for (int v = 0; v < nvars; v++) {
+          b[v] += c * bg[v];
+        }
+      }
+    }
+
+    // Compute the bending strain rows from
+    // u1x = T^{T}*u1d*XdinvT + T^{T}*u0d*XdinvzT
+    for (int j = 0; j < num_nodes; j++) {
+      TacsScalar w[2], z[2];
+      w[0] = Na[j] * XdinvzT[0] + Nb[j] * XdinvzT[3];
+      w[1] = Na[j] * XdinvzT[1] + Nb[j] * XdinvzT[4];
+      z[0] = Na[j] * XdinvT[0] + Nb[j] * XdinvT[3] + N[j] * XdinvzT[6];
+      z[1] = Na[j] * XdinvT[1] + Nb[j] * XdinvT[4] + N[j] * XdinvzT[7];
+
+      const TacsScalar *Dj = &Dn[9 * j];
+      for (int a = 0; a < 3; a++) {
+        // Components of T^{T}*e_a and T^{T}*Dj*e_a
+        TacsScalar t0 = T[3 * a], t1 = T[3 * a + 1];
+        TacsScalar s0 = T[0] * Dj[a] + T[3] * Dj[3 + a] + T[6] * Dj[6 + a];
+        TacsScalar s1 = T[1] * Dj[a] + T[4] * Dj[3 + a] + T[7] * Dj[6 + a];
+
+        const int u = vars_per_node * j + a;
+        Be[3 * nvars + u] = t0 * w[0];
+        Be[4 * nvars + u] = t1 * w[1];
+        Be[5 * nvars + u] = t0 * w[1] + t1 * w[0];
+
+        const int r = vars_per_node * j + 3 + a;
+        Be[3 * nvars + r] = s0 * z[0];
+        Be[4 * nvars + r] = s1 * z[1];
+        Be[5 * nvars + r] = s0 * z[1] + s1 * z[0];
+      }
+    }
+
+    // Interpolate the drilling strain row
+    for (int i = 0; i < num_nodes; i++) {
+      const TacsScalar *bdn = &Bdn[nvars * i];
+      for (int v = 0; v < nvars; v++) {
+        Be[8 * nvars + v] += N[i] * bdn[v];
+      }
+    }
+
+    // Compute the strain e = B*q
+    TacsScalar e[9];
+    for (int m = 0; m < 9; m++) {
+      e[m] = 0.0;
+      const TacsScalar *b = &Be[nvars * m];
+      for (int v = 0; v < nvars; v++) {
+        e[m] += b[v] * vars[v];
+      }
+    }
+
+    // Get the tangent stiffness matrix at this point
+    const TacsScalar *Cs =
+        &Cq[TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES * quad_index];
+
+    TacsScalar drill;
+    const TacsScalar *A, *B, *D, *As;
+    TACSShellConstitutive::extractTangentStiffness(Cs, &A, &B, &D, &As, &drill);
+
+    // Compute the stress and add the residual B^{T}*s
+    TacsScalar s[9];
+    TACSShellConstitutive::computeStress(A, B, D, As, drill, e, s);
+    for (int m = 0; m < 9; m++) {
+      const TacsScalar ds = detXd * s[m];
+      const TacsScalar *b = &Be[nvars * m];
+      for (int v = 0; v < nvars; v++) {
+        res[v] += ds * b[v];
+      }
+    }
+
+    // Form the dense stiffness and compute CB = C*B
+    TacsScalar C[81];
+    for (int n = 0; n < 9; n++) {
+      TacsScalar en[9], sn[9];
+      memset(en, 0, 9 * sizeof(TacsScalar));
+      en[n] = 1.0;
+      TACSShellConstitutive::computeStress(A, B, D, As, drill, en, sn);
+      for (int m = 0; m < 9; m++) {
+        C[9 * m + n] = sn[m];
+      }
+    }
+
+    TacsScalar CB[9 * nvars];
+    memset(CB, 0, 9 * nvars * sizeof(TacsScalar));
+    for (int m = 0; m < 9; m++) {
+      TacsScalar *cb = &CB[nvars * m];
+      for (int n = 0; n < 9; n++) {
+        const TacsScalar c = alpha * detXd * C[9 * m + n];
+        const TacsScalar *b = &Be[nvars * n];
+        for (int v = 0; v < nvars; v++) {
+          cb[v] += c * b[v];
+        }
+      }
+    }
+
+    // Add the stiffness B^{T}*C*B, skipping the lower triangle when it
+    // is filled in by the caller
+    for (int m = 0; m < 9; m++) {
+      const TacsScalar *b = &Be[nvars * m];
+      const TacsScalar *cb = &CB[nvars * m];
+      for (int u = 0; u < nvars; u++) {
+        TacsScalar *row = &mat[nvars * u];
+        for (int v = (upper_fill ? u : 0); v < nvars; v++) {
+          row[v] += b[u] * cb[v];
+        }
+      }
+    }
+
+    // Evaluate the mass moments
+    TacsScalar moments[3];
+    con->evalMassMoments(elemIndex, pt, X, moments);
+
+    // Evaluate the second time derivatives
+    TacsScalar u0ddot[3] = {0.0, 0.0, 0.0}, d0ddot[3] = {0.0, 0.0, 0.0};
+    for (int j = 0; j < num_nodes; j++) {
+      const TacsScalar *Dj = &Dn[9 * j];
+      const TacsScalar *qddot = &ddvars[vars_per_node * j];
+      for (int k = 0; k < 3; k++) {
+        u0ddot[k] += N[j] * qddot[k];
+        d0ddot[k] += N[j] * (Dj[3 * k] * qddot[3] + Dj[3 * k + 1] * qddot[4] +
+                             Dj[3 * k + 2] * qddot[5]);
+      }
+    }
+
+    // Add the inertial contributions to the residual
+    TacsScalar du0dot[3], dd0dot[3];
+    for (int k = 0; k < 3; k++) {
+      du0dot[k] = detXd * (moments[0] * u0ddot[k] + moments[1] * d0ddot[k]);
+      dd0dot[k] = detXd * (moments[1] * u0ddot[k] + moments[2] * d0ddot[k]);
+    }
+    for (int i = 0; i < num_nodes; i++) {
+      const TacsScalar *Di = &Dn[9 * i];
+      TacsScalar *r = &res[vars_per_node * i];
+      for (int k = 0; k < 3; k++) {
+        r[k] += N[i] * du0dot[k];
+        r[3 + k] += N[i] * (Di[k] * dd0dot[0] + Di[3 + k] * dd0dot[1] +
+                            Di[6 + k] * dd0dot[2]);
+      }
+    }
+
+    // Add the mass matrix contributions
+    const TacsScalar m0 = gamma * detXd * moments[0];
+    const TacsScalar m1 = gamma * detXd * moments[1];
+    const TacsScalar m2 = gamma * detXd * moments[2];
+    for (int i = 0; i < num_nodes; i++) {
+      const TacsScalar *Di = &Dn[9 * i];
+      for (int j = 0; j < num_nodes; j++) {
+        const TacsScalar *Dj = &Dn[9 * j];
+        const double Nij = N[i] * N[j];
+
+        for (int a = 0; a < 3; a++) {
+          TacsScalar *row = &mat[nvars * (vars_per_node * i + a)];
+          row[vars_per_node * j + a] += m0 * Nij;
+          for (int b = 0; b < 3; b++) {
+            row[vars_per_node * j + 3 + b] += m1 * Nij * Dj[3 * a + b];
+          }
+        }
+
+        for (int a = 0; a < 3; a++) {
+          TacsScalar *row = &mat[nvars * (vars_per_node * i + 3 + a)];
+          for (int b = 0; b < 3; b++) {
+            row[vars_per_node * j + b] += m1 * Nij * Di[3 * b + a];
+            row[vars_per_node * j + 3 + b] +=
+                m2 * Nij *
+                (Di[a] * Dj[b] + Di[3 + a] * Dj[3 + b] + Di[6 + a] * Dj[6 + b]);
+          }
+        }
+      }
+    }
+  }
+}
+
 template <class quadrature, class basis, class director, class model>
 void TACSShellElement<quadrature, basis, director, model>::getMatType(
     ElementMatrixType matType, int elemIndex, double time,
@@ -758,6 +1673,328 @@ void TACSShellElement<quadrature, basis, director, model>::getMatType(
               mat);
 }
 
+/*
+  Get the sizes of the data for a matrix-free product.
+
+  For the stiffness, mass or geometric stiffness matrix, only the
+  simulation time, the scaling, the node locations and the state
+  variables are stored for each element. The element matrix is
+  recomputed within the temporary array each time the product is
+  evaluated, so that no matrix needs to be assembled or stored.
+
+  For the Jacobian of a shell with linear kinematics and without
+  hourglass control, the frame normals, the nodal frames for the
+  drilling strain and, at each quadrature point, the transformations,
+  the scaled tangent stiffness and the scaled mass moments are stored.
+  The product is then computed at the quadrature points without
+  forming the element matrix.
+  Otherwise, the states are stored and the element Jacobian is
+  recomputed within the temporary array.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::getMatVecDataSizes(
+    ElementMatrixType matType, int elemIndex, int *_data_size,
+    int *_temp_size) {
+  const int nvars = vars_per_node * num_nodes;
+  if (matType == TACS_JACOBIAN_MATRIX) {
+    if (useQuadMatVecData()) {
+      const int nquad = quadrature::getNumQuadraturePoints();
+      *_data_size = 24 * num_nodes + nquad * matvec_quad_size;
+      *_temp_size = 0;
+    } else {
+      *_data_size = 4 + 3 * num_nodes + 3 * nvars;
+      *_temp_size = nvars * (nvars + 1);
+    }
+  } else {
+    *_data_size = 2 + 3 * num_nodes + nvars;
+    *_temp_size = nvars * nvars;
+  }
+}
+
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::getMatVecProductData(
+    ElementMatrixType matType, int elemIndex, double time, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar data[]) {
+  if (!data) {
+    return;
+  }
+
+  const int nvars = vars_per_node * num_nodes;
+  if (matType == TACS_JACOBIAN_MATRIX && useQuadMatVecData()) {
+    const int nquad = quadrature::getNumQuadraturePoints();
+
+    // Store the node locations, the frame normals and the nodal frames
+    TacsScalar *fn = &data[3 * num_nodes];
+    TacsScalar *Xdn = &data[6 * num_nodes];
+    TacsScalar *Tn = &data[15 * num_nodes];
+    memcpy(data, Xpts, 3 * num_nodes * sizeof(TacsScalar));
+    TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+    for (int i = 0; i < num_nodes; i++) {
+      TacsScalar Xxi[6];
+      TacsShellExtractFrame(&Xdn[9 * i], Xxi);
+      transform->computeTransform(Xxi, &fn[3 * i], &Tn[9 * i]);
+    }
+
+    // The director values are only used to evaluate the transformations
+    TacsScalar d[dsize], ddot[dsize];
+    director::template computeDirectorRates<vars_per_node, offset, num_nodes>(
+        vars, dvars, fn, d, ddot);
+
+    TacsScalar *qdata = &data[24 * num_nodes];
+    for (int quad_index = 0; quad_index < nquad; quad_index++) {
+      // Get the quadrature weight
+      double pt[3];
+      double weight = quadrature::getQuadraturePoint(quad_index, pt);
+
+      // Set pointers into the data at this quadrature point
+      TacsScalar *T = &qdata[0];
+      TacsScalar *XdinvT = &qdata[9];
+      TacsScalar *XdinvzT = &qdata[18];
+      TacsScalar *Cs = &qdata[27];
+      TacsScalar *moments =
+          &qdata[27 + TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES];
+
+      // Compute X, X,xi and the interpolated normal n0
+      TacsScalar X[3], Xxi[6], n0[3];
+      basis::template interpFields<3, 3>(pt, Xpts, X);
+      basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
+      basis::template interpFields<3, 3>(pt, fn, n0);
+
+      // Compute the transformations at the quadrature point
+      transform->computeTransform(Xxi, n0, T);
+      TacsScalar u0x[9], u1x[9];
+      TacsScalar detXd = TacsShellComputeDispGrad<vars_per_node, basis>(
+          pt, Xpts, vars, fn, d, Xxi, n0, T, XdinvT, XdinvzT, u0x, u1x);
+      detXd *= weight;
+
+      // Store the scaled tangent stiffness and mass moments
+      con->evalTangentStiffness(elemIndex, pt, X, Cs);
+      for (int i = 0; i < TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES;
+           i++) {
+        Cs[i] *= alpha * detXd;
+      }
+
+      con->evalMassMoments(elemIndex, pt, X, moments);
+      for (int i = 0; i < 3; i++) {
+        moments[i] *= gamma * detXd;
+      }
+
+      qdata += matvec_quad_size;
+    }
+  } else if (matType == TACS_JACOBIAN_MATRIX) {
+    // Store the time, the coefficients and the states
+    data[0] = time;
+    data[1] = alpha;
+    data[2] = beta;
+    data[3] = gamma;
+    memcpy(&data[4], Xpts, 3 * num_nodes * sizeof(TacsScalar));
+    memcpy(&data[4 + 3 * num_nodes], vars, nvars * sizeof(TacsScalar));
+    memcpy(&data[4 + 3 * num_nodes + nvars], dvars, nvars * sizeof(TacsScalar));
+    memcpy(&data[4 + 3 * num_nodes + 2 * nvars], ddvars,
+           nvars * sizeof(TacsScalar));
+  } else {
+    // Store the time and the scaling factor for the matrix
+    data[0] = time;
+    if (matType == TACS_MASS_MATRIX) {
+      data[1] = gamma;
+    } else {
+      data[1] = alpha;
+    }
+
+    // Store the node locations and the state variables
+    memcpy(&data[2], Xpts, 3 * num_nodes * sizeof(TacsScalar));
+    memcpy(&data[2 + 3 * num_nodes], vars, nvars * sizeof(TacsScalar));
+  }
+}
+
+template <class quadrature, class basis, class director, class model>
+void TACSShellElement<quadrature, basis, director, model>::addMatVecProduct(
+    ElementMatrixType matType, int elemIndex, const TacsScalar data[],
+    TacsScalar temp[], const TacsScalar px[], TacsScalar py[]) {
+  const int nvars = vars_per_node * num_nodes;
+  if (matType == TACS_JACOBIAN_MATRIX && useQuadMatVecData()) {
+    // Compute the number of quadrature points
+    const int nquad = quadrature::getNumQuadraturePoints();
+
+    // Set pointers into the element data
+    const TacsScalar *Xpts = &data[0];
+    const TacsScalar *fn = &data[3 * num_nodes];
+    const TacsScalar *Xdn = &data[6 * num_nodes];
+    const TacsScalar *Tn = &data[15 * num_nodes];
+    const TacsScalar *qdata = &data[24 * num_nodes];
+
+    // The residual is linear in the variables, so the product is the
+    // residual evaluated at px with the stored tangent stiffness and
+    // mass moments. The director and its second time derivative are
+    // both the director computed from px.
+    TacsScalar d[dsize], dddot[dsize];
+    director::template computeDirectorRates<vars_per_node, offset, num_nodes>(
+        px, px, fn, d, dddot);
+
+    // Derivative of the director field
+    TacsScalar dd[dsize];
+    memset(dd, 0, dsize * sizeof(TacsScalar));
+
+    // Compute the drill strain at each node
+    TacsScalar etn[num_nodes], detn[num_nodes];
+    memset(detn, 0, num_nodes * sizeof(TacsScalar));
+    TacsScalar XdinvTn[9 * num_nodes];
+    TacsScalar u0xn[9 * num_nodes], Ctn[csize];
+    TacsShellComputeDrillStrain<vars_per_node, offset, basis, director, model>(
+        Xdn, fn, px, Tn, XdinvTn, u0xn, Ctn, etn);
+
+    // Compute the tying strain values
+    TacsScalar ety[basis::NUM_TYING_POINTS], dety[basis::NUM_TYING_POINTS];
+    memset(dety, 0, basis::NUM_TYING_POINTS * sizeof(TacsScalar));
+    model::template computeTyingStrain<vars_per_node, basis>(Xpts, fn, px, d,
+                                                             ety);
+
+    // Interpolate the displacements, the director field, its second
+    // time derivative and the drill strain at all the quadrature points
+    // at once. The values at each point are followed by the parametric
+    // gradient.
+    const int max_quad = quadrature::NUM_QUADRATURE_POINTS;
+    TacsScalar u0q[9 * max_quad], d0q[9 * max_quad], d0ddotq[9 * max_quad];
+    TacsScalar etq[3 * max_quad];
+    basis::template interpAllFieldsGrad<quadrature, vars_per_node, 3>(px, u0q);
+    basis::template interpAllFieldsGrad<quadrature, 3, 3>(d, d0q);
+    basis::template interpAllFieldsGrad<quadrature, 3, 3>(dddot, d0ddotq);
+    basis::template interpAllFieldsGrad<quadrature, 1, 1>(etn, etq);
+
+    // Evaluate the displacement gradient at all the quadrature points
+    TacsScalar u0xq[9 * max_quad], u1xq[9 * max_quad];
+    TACSScratchScope scratch;
+    TacsShellComputeDispGradFromFieldsBatch(nquad, u0q, d0q, qdata,
+                                            matvec_quad_size, u0xq, u1xq,
+                                            scratch.allocScalars(72 * nquad));
+
+    // The coefficients of the interpolated quantities
+    TacsScalar du0q[9 * max_quad], dd0q[9 * max_quad], detq[3 * max_quad];
+
+    for (int quad_index = 0; quad_index < nquad; quad_index++) {
+      double pt[3];
+      quadrature::getQuadraturePoint(quad_index, pt);
+
+      // Set pointers into the data at this quadrature point
+      const TacsScalar *T = &qdata[0];
+      const TacsScalar *XdinvT = &qdata[9];
+      const TacsScalar *XdinvzT = &qdata[18];
+      const TacsScalar *Cs = &qdata[27];
+      const TacsScalar *moments =
+          &qdata[27 + TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES];
+
+      // Set pointers to the interpolated quantities at this point
+      const TacsScalar *u0 = &u0q[9 * quad_index];
+      const TacsScalar *d0ddot = &d0ddotq[9 * quad_index];
+      TacsScalar *du0 = &du0q[9 * quad_index];
+      TacsScalar *dd0 = &dd0q[9 * quad_index];
+      TacsScalar *de = &detq[3 * quad_index];
+
+      // The displacement gradient at the point
+      const TacsScalar *u0x = &u0xq[9 * quad_index];
+      const TacsScalar *u1x = &u1xq[9 * quad_index];
+
+      // Evaluate the tying components of the strain
+      TacsScalar gty[6], e0ty[6];
+      basis::interpTyingStrain(pt, ety, gty);
+      mat3x3SymmTransformTranspose(XdinvT, gty, e0ty);
+
+      // Compute the set of strain components
+      TacsScalar e[9];
+      model::evalStrain(u0x, u1x, e0ty, e);
+      e[8] = etq[3 * quad_index];
+
+      // Compute the stress based on the scaled tangent stiffness
+      TacsScalar drill;
+      const TacsScalar *A, *B, *D, *As;
+      TACSShellConstitutive::extractTangentStiffness(Cs, &A, &B, &D, &As,
+                                                     &drill);
+      TacsScalar s[9];
+      TACSShellConstitutive::computeStress(A, B, D, As, drill, e, s);
+
+      // Add the contributions from the stress
+      TacsScalar du0x[9], du1x[9], de0ty[6];
+      model::evalStrainSens(1.0, s, u0x, u1x, du0x, du1x, de0ty);
+      de[0] = s[8];
+      de[1] = de[2] = 0.0;
+      TacsShellComputeDispGradFromFieldsSens(T, XdinvT, XdinvzT, du0x, du1x,
+                                             &du0[3], dd0, &dd0[3]);
+
+      TacsScalar dgty[6];
+      mat3x3SymmTransformTransSens(XdinvT, de0ty, dgty);
+      basis::addInterpTyingStrainTranspose(pt, dgty, dety);
+
+      // Add the contributions from the scaled mass moments
+      for (int i = 0; i < 3; i++) {
+        du0[i] = moments[0] * u0[i] + moments[1] * d0ddot[i];
+        dd0[i] += moments[1] * u0[i] + moments[2] * d0ddot[i];
+      }
+
+      qdata += matvec_quad_size;
+    }
+
+    // Add the contributions from the interpolated quantities
+    basis::template addInterpAllFieldsGradTranspose<quadrature, vars_per_node,
+                                                    3>(du0q, py);
+    basis::template addInterpAllFieldsGradTranspose<quadrature, 3, 3>(dd0q, dd);
+    basis::template addInterpAllFieldsGradTranspose<quadrature, 1, 1>(detq,
+                                                                      detn);
+
+    // Add the contributions from the drill strain and tying strain
+    TacsShellAddDrillStrainSens<vars_per_node, offset, basis, director, model>(
+        Xdn, fn, px, XdinvTn, Tn, u0xn, Ctn, detn, py);
+    model::template addComputeTyingStrainTranspose<vars_per_node, basis>(
+        Xpts, fn, px, d, dety, py, dd);
+
+    // Add the contributions to the director field
+    director::template addDirectorResidual<vars_per_node, offset, num_nodes>(
+        px, px, px, fn, dd, py);
+
+    return;
+  }
+
+  if (matType == TACS_JACOBIAN_MATRIX) {
+    // Recompute the element Jacobian from the stored states
+    double time = TacsRealPart(data[0]);
+    const TacsScalar *Xpts = &data[4];
+    const TacsScalar *vars = &data[4 + 3 * num_nodes];
+    const TacsScalar *dvars = &data[4 + 3 * num_nodes + nvars];
+    const TacsScalar *ddvars = &data[4 + 3 * num_nodes + 2 * nvars];
+    TacsScalar *res = &temp[nvars * nvars];
+    memset(temp, 0, nvars * (nvars + 1) * sizeof(TacsScalar));
+    addJacobian(elemIndex, time, data[1], data[2], data[3], Xpts, vars, dvars,
+                ddvars, res, temp);
+
+    for (int i = 0; i < nvars; i++) {
+      TacsScalar value = 0.0;
+      const TacsScalar *row = &temp[nvars * i];
+      for (int j = 0; j < nvars; j++) {
+        value += row[j] * px[j];
+      }
+      py[i] += value;
+    }
+    return;
+  }
+
+  // Recompute the element matrix from the stored data
+  double time = TacsRealPart(data[0]);
+  const TacsScalar *Xpts = &data[2];
+  const TacsScalar *vars = &data[2 + 3 * num_nodes];
+  getMatType(matType, elemIndex, time, Xpts, vars, temp);
+
+  // Add the scaled product with the element matrix
+  for (int i = 0; i < nvars; i++) {
+    TacsScalar value = 0.0;
+    const TacsScalar *row = &temp[nvars * i];
+    for (int j = 0; j < nvars; j++) {
+      value += row[j] * px[j];
+    }
+    py[i] += data[1] * value;
+  }
+}
+
 template <class quadrature, class basis, class director, class model>
 void TACSShellElement<quadrature, basis, director, model>::addAdjResProduct(
     int elemIndex, double time, TacsScalar scale, const TacsScalar psi[],
@@ -853,6 +2090,78 @@ void TACSShellElement<quadrature, basis, director, model>::addAdjResProduct(
     // Add the contribution from the dynamics
     con->addMassMomentsDVSens(elemIndex, pt, X, coef, dvLen, dfdx);
   }
+
+  // Add the contribution from the hourglass stiffness and mass. The
+  // derivatives of the stiffness entries are computed from products
+  // with unit strains.
+  if (hourglass_control) {
+    TacsScalar hg[num_nodes], area, gg[2];
+    TacsScalar bb = TacsShellComputeHourglassVector(Xpts, hg, &area, gg);
+
+    double pt[3] = {0.0, 0.0, 0.0};
+    TacsScalar X[3];
+    basis::template interpFields<3, 3>(pt, Xpts, X);
+
+    // Compute the products psi^{T}*K*u and psi^{T}*M*uddot for the
+    // displacements and rotations with unit coefficients
+    TacsScalar ku[2], mu[2];
+    for (int j = 0; j < 2; j++) {
+      ku[j] = mu[j] = 0.0;
+      for (int k = j * offset; k < j * offset + 3; k++) {
+        TacsScalar q = 0.0, qddot = 0.0, p = 0.0;
+        for (int i = 0; i < num_nodes; i++) {
+          q += hg[i] * vars[vars_per_node * i + k];
+          qddot += hg[i] * ddvars[vars_per_node * i + k];
+          p += hg[i] * psi[vars_per_node * i + k];
+        }
+        ku[j] += p * q;
+        mu[j] += p * qddot;
+      }
+    }
+
+    // Compute the products for the transverse shear tying strain
+    // differences and the drilling strain deviation
+    const int g23 = hourglass_g23, g13 = hourglass_g13;
+    TacsScalar ks = (gg[1] * (ety[g23 + 1] - ety[g23]) *
+                         (etyd[g23 + 1] - etyd[g23]) +
+                     gg[0] * (ety[g13 + 1] - ety[g13]) *
+                         (etyd[g13 + 1] - etyd[g13])) /
+                    3.0;
+
+    TacsScalar etm = 0.0, etmd = 0.0;
+    for (int i = 0; i < num_nodes; i++) {
+      etm += etn[i];
+      etmd += etnd[i];
+    }
+    etm *= 1.0 / num_nodes;
+    etmd *= 1.0 / num_nodes;
+    TacsScalar kd = 0.0;
+    for (int i = 0; i < num_nodes; i++) {
+      kd += (etn[i] - etm) * (etnd[i] - etmd);
+    }
+    kd *= 1.0 / 12.0;
+
+    TacsScalar kscale = scale * hourglass_coef * area;
+    const int index[] = {0, 1, 3, 4, 6, 7, 8};
+    const TacsScalar kprod[] = {
+        0.5 * bb * ku[0] / 12.0, 0.5 * bb * ku[0] / 12.0,
+        0.5 * bb * ku[1] / 12.0, 0.5 * bb * ku[1] / 12.0,
+        0.5 * ks,                0.5 * ks,
+        kd};
+    for (int j = 0; j < 7; j++) {
+      TacsScalar e[9];
+      memset(e, 0, 9 * sizeof(TacsScalar));
+      e[index[j]] = 1.0;
+      con->addStressDVSens(elemIndex, kscale * kprod[j], pt, X, e, e, dvLen,
+                           dfdx);
+    }
+
+    TacsScalar coef[3];
+    coef[0] = scale * mu[0] * area / 144.0;
+    coef[1] = 0.0;
+    coef[2] = scale * mu[1] * area / 144.0;
+    con->addMassMomentsDVSens(elemIndex, pt, X, coef, dvLen, dfdx);
+  }
 }
 
 template <class quadrature, class basis, class director, class model>
@@ -1395,6 +2704,36 @@ void TACSShellElement<quadrature, basis, director, model>::getOutputData(
     // Get the number of nodes associated with the visualization
     int num_vis_nodes = TacsGetNumVisNodes(basis::getLayoutType());
 
+    // When only the nodes and displacements are requested, skip the
+    // strain and stress recovery
+    const int recover_flag =
+        TACS_OUTPUT_STRAINS | TACS_OUTPUT_STRESSES | TACS_OUTPUT_EXTRAS;
+    if (!(write_flag & recover_flag)) {
+      for (int index = 0; index < num_vis_nodes; index++, data += ld_data) {
+        double pt[3];
+        basis::getNodePoint(index, pt);
+
+        TacsScalar *d = data;
+        if (write_flag & TACS_OUTPUT_NODES) {
+          basis::template interpFields<3, 3>(pt, Xpts, d);
+          d += 3;
+        }
+        if (write_flag & TACS_OUTPUT_DISPLACEMENTS) {
+          int len = vars_per_node;
+          if (len > 6) {
+            len = 6;
+          }
+          for (int i = 0; i < len; i++) {
+            d[i] = vars[i + vars_per_node * index];
+          }
+          for (int i = len; i < 6; i++) {
+            d[i] = 0.0;
+          }
+        }
+      }
+      return;
+    }
+
     // Compute the node normal directions
     TacsScalar fn[3 * num_nodes], Xdn[9 * num_nodes];
     TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
@@ -1453,7 +2792,9 @@ void TACSShellElement<quadrature, basis, director, model>::getOutputData(
 
       // Compute the corresponding stresses
       TacsScalar s[9];
-      con->evalStress(elemIndex, pt, X, e, s);
+      if (write_flag & TACS_OUTPUT_STRESSES) {
+        con->evalStress(elemIndex, pt, X, e, s);
+      }
 
       if (write_flag & TACS_OUTPUT_NODES) {
         data[0] = X[0];
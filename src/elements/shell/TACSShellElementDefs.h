@@ -5,6 +5,7 @@
 #include "TACSBeamElementBasis.h"
 #include "TACSBeamElementModel.h"
 #include "TACSDirector.h"
+#include "TACSElementRegistry.h"
 #include "TACSShellElement.h"
 #include "TACSShellElementModel.h"
 #include "TACSShellElementQuadBasis.h"
@@ -31,6 +32,18 @@ typedef TACSShellElement<TACSTriLinearQuadrature, TACSShellTriLinearBasis,
                          TACSLinearizedRotation, TACSShellInplaneLinearModel>
     TACSTri3Shell;
 
+/*
+  Linear and nonlinear 4-node shell elements with one-point quadrature
+  and hourglass control
+*/
+typedef TACSShellElement<TACSQuadReducedQuadrature, TACSShellQuadBasis<2>,
+                         TACSLinearizedRotation, TACSShellLinearModel>
+    TACSQuad4ReducedShell;
+
+typedef TACSShellElement<TACSQuadReducedQuadrature, TACSShellQuadBasis<2>,
+                         TACSLinearizedRotation, TACSShellNonlinearModel>
+    TACSQuad4NonlinearReducedShell;
+
 /*
   Thermal shell elements with appropriate quadrature schemes
 */
@@ -294,4 +307,51 @@ inline TACSElement *TacsCreateShellByName(const char *name,
   return shell;
 }
 
+/**
+  Register the specialized assembly kernels for the shell elements
+  created by TacsCreateShellByName().
+
+  The beam elements are not registered: their batched Jacobian shares
+  the reference axis of a single element object.
+
+  @param registry The registry of element kernels
+*/
+inline void TacsRegisterShellElements(TACSElementRegistry *registry) {
+  registry->registerElement<TACSQuad4Shell>("TACSQuad4Shell");
+  registry->registerElement<TACSQuad9Shell>("TACSQuad9Shell");
+  registry->registerElement<TACSQuad16Shell>("TACSQuad16Shell");
+  registry->registerElement<TACSTri3Shell>("TACSTri3Shell");
+  registry->registerElement<TACSQuad4NonlinearShell>(
+      "TACSQuad4NonlinearShell");
+  registry->registerElement<TACSQuad9NonlinearShell>(
+      "TACSQuad9NonlinearShell");
+  registry->registerElement<TACSQuad16NonlinearShell>(
+      "TACSQuad16NonlinearShell");
+  registry->registerElement<TACSTri3NonlinearShell>("TACSTri3NonlinearShell");
+  registry->registerElement<TACSQuad4ShellModRot>("TACSQuad4ShellModRot");
+  registry->registerElement<TACSQuad9ShellModRot>("TACSQuad9ShellModRot");
+  registry->registerElement<TACSQuad16ShellModRot>("TACSQuad16ShellModRot");
+  registry->registerElement<TACSTri3ShellModRot>("TACSTri3ShellModRot");
+  registry->registerElement<TACSQuad4ShellQuaternion>(
+      "TACSQuad4ShellQuaternion");
+  registry->registerElement<TACSQuad9ShellQuaternion>(
+      "TACSQuad9ShellQuaternion");
+  registry->registerElement<TACSQuad16ShellQuaternion>(
+      "TACSQuad16ShellQuaternion");
+  registry->registerElement<TACSTri3ShellQuaternion>(
+      "TACSTri3ShellQuaternion");
+  registry->registerElement<TACSQuad4ThermalShell>("TACSQuad4ThermalShell");
+  registry->registerElement<TACSQuad9ThermalShell>("TACSQuad9ThermalShell");
+  registry->registerElement<TACSQuad16ThermalShell>("TACSQuad16ThermalShell");
+  registry->registerElement<TACSTri3ThermalShell>("TACSTri3ThermalShell");
+  registry->registerElement<TACSQuad4NonlinearThermalShell>(
+      "TACSQuad4NonlinearThermalShell");
+  registry->registerElement<TACSQuad9NonlinearThermalShell>(
+      "TACSQuad9NonlinearThermalShell");
+  registry->registerElement<TACSQuad16NonlinearThermalShell>(
+      "TACSQuad16NonlinearThermalShell");
+  registry->registerElement<TACSTri3NonlinearThermalShell>(
+      "TACSTri3NonlinearThermalShell");
+}
+
 #endif  // TACS_SHELL_ELEMENT_DEFS_H
@@ -0,0 +1,590 @@
+#ifndef TACS_SHELL_ELEMENT_DEVICE_H
+#define TACS_SHELL_ELEMENT_DEVICE_H
+
+#include "TACSDevice.h"
+#include "TACSDirector.h"
+#include "TACSShellConstitutive.h"
+#include "TACSShellElementModel.h"
+#include "TACSShellElementTransform.h"
+#include "TACSShellUtilities.h"
+
+/*
+  Batched evaluation of the shell element residuals and Jacobians on
+  the device.
+
+  The basis, director, model and quadrature classes of the shell
+  element are header-only with compile-time sizes, so the element
+  computations can be compiled for the device. The transform and the
+  constitutive objects are virtual, so their contributions are
+  evaluated on the host with computeData() and stored in a data array
+  for each element:
+
+  T:        the transformation at each quadrature point (9 per point)
+  Cs:       the tangent stiffness at each quadrature point
+  moments:  the mass moments at each quadrature point (3 per point)
+  Tn:       the transformation at each node (9 per node)
+
+  The data only depends on the node locations and the design
+  variables, so it is computed once and re-used for each residual
+  and Jacobian. The stress is evaluated from the stored tangent
+  stiffness, which is exact for the shell constitutive classes where
+  the stress is linear in the strain.
+
+  The batch functions process nelems elements stored contiguously in
+  device arrays, with one thread for each element. When TACS is built
+  without a GPU backend, the batch functions loop over the elements on
+  the host (see TACSDevice.h). A typical sequence to assemble the
+  Jacobian on the device is:
+
+  1. Gather the element variables with TacsDeviceGatherVars()
+  2. Compute the element matrices with addJacobianBatch()
+  3. Add them with TACSDeviceParallelMat::addElementMatrices()
+  4. Complete the assembly with beginAssembly()/endAssembly()
+  5. Apply the boundary conditions with applyBCs()
+
+  The element residuals are added to a device vector in the same way
+  with TacsDeviceScatterAddVars().
+*/
+template <class quadrature, class basis, class director, class model>
+class TACSShellElementDevice {
+ public:
+  static const int offset = 3;
+  static const int vars_per_node = offset + director::NUM_PARAMETERS;
+  static const int num_nodes = basis::NUM_NODES;
+  static const int num_vars = vars_per_node * num_nodes;
+  static const int num_quad = quadrature::NUM_QUADRATURE_POINTS;
+  static const int num_stiff =
+      TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES;
+
+  // The size of the data for each element
+  static const int DATA_SIZE =
+      (9 + num_stiff + 3) * num_quad + 9 * num_nodes;
+
+  // Compute the element data on the host
+  // ------------------------------------
+  static void computeData(TACSShellTransform *transform,
+                          TACSShellConstitutive *con, int elemIndex,
+                          const TacsScalar Xpts[], TacsScalar data[]);
+
+  // Compute the residual and Jacobian for a single element
+  // ------------------------------------------------------
+  TACS_HOST_DEVICE static void addResidual(const TacsScalar data[],
+                                           const TacsScalar Xpts[],
+                                           const TacsScalar vars[],
+                                           const TacsScalar dvars[],
+                                           const TacsScalar ddvars[],
+                                           TacsScalar res[]);
+  TACS_HOST_DEVICE static void addJacobian(
+      const TacsScalar data[], TacsScalar alpha, TacsScalar beta,
+      TacsScalar gamma, const TacsScalar Xpts[], const TacsScalar vars[],
+      const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar res[],
+      TacsScalar mat[]);
+
+  // Compute the residuals and Jacobians for a batch of elements
+  // -----------------------------------------------------------
+  static void addResidualBatch(int nelems, const TacsScalar data[],
+                               const TacsScalar Xpts[],
+                               const TacsScalar vars[],
+                               const TacsScalar dvars[],
+                               const TacsScalar ddvars[], TacsScalar res[]);
+  static void addJacobianBatch(int nelems, const TacsScalar data[],
+                               TacsScalar alpha, TacsScalar beta,
+                               TacsScalar gamma, const TacsScalar Xpts[],
+                               const TacsScalar vars[],
+                               const TacsScalar dvars[],
+                               const TacsScalar ddvars[], TacsScalar res[],
+                               TacsScalar mat[]);
+
+ private:
+  // Set sizes for the different components
+  static const int usize = 3 * num_nodes;
+  static const int dsize = 3 * num_nodes;
+  static const int csize = 9 * num_nodes;
+
+  // Offsets to the components of the element data
+  static const int T_OFFSET = 0;
+  static const int CS_OFFSET = 9 * num_quad;
+  static const int MOMENTS_OFFSET = (9 + num_stiff) * num_quad;
+  static const int TN_OFFSET = (9 + num_stiff + 3) * num_quad;
+};
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+/*
+  Kernels that evaluate one element on each thread
+*/
+template <class element>
+__global__ void TacsShellDeviceResidualKernel(
+    int nelems, const TacsScalar *data, const TacsScalar *Xpts,
+    const TacsScalar *vars, const TacsScalar *dvars,
+    const TacsScalar *ddvars, TacsScalar *res) {
+  const int nx = 3 * element::num_nodes;
+  const int nvars = element::num_vars;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < nelems;
+       i += blockDim.x * gridDim.x) {
+    element::addResidual(&data[element::DATA_SIZE * i], &Xpts[nx * i],
+                         &vars[nvars * i], &dvars[nvars * i],
+                         &ddvars[nvars * i], &res[nvars * i]);
+  }
+}
+
+template <class element>
+__global__ void TacsShellDeviceJacobianKernel(
+    int nelems, const TacsScalar *data, TacsScalar alpha, TacsScalar beta,
+    TacsScalar gamma, const TacsScalar *Xpts, const TacsScalar *vars,
+    const TacsScalar *dvars, const TacsScalar *ddvars, TacsScalar *res,
+    TacsScalar *mat) {
+  const int nx = 3 * element::num_nodes;
+  const int nvars = element::num_vars;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < nelems;
+       i += blockDim.x * gridDim.x) {
+    element::addJacobian(&data[element::DATA_SIZE * i], alpha, beta, gamma,
+                         &Xpts[nx * i], &vars[nvars * i], &dvars[nvars * i],
+                         &ddvars[nvars * i], &res[nvars * i],
+                         &mat[nvars * nvars * i]);
+  }
+}
+
+// The number of threads in each block for the element kernels
+static const int TACS_SHELL_DEVICE_BLOCK_SIZE = 64;
+#endif  // __CUDACC__ || __HIPCC__
+
+/*
+  Compute the data for an element on the host
+
+  input:
+  transform:  the shell transformation object
+  con:        the shell constitutive object
+  elemIndex:  the element index passed to the constitutive object
+  Xpts:       the element node locations (on the host)
+
+  output:
+  data:       the element data of length DATA_SIZE (on the host)
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElementDevice<quadrature, basis, director, model>::computeData(
+    TACSShellTransform *transform, TACSShellConstitutive *con, int elemIndex,
+    const TacsScalar Xpts[], TacsScalar data[]) {
+  // Compute the node normal directions
+  TacsScalar fn[3 * num_nodes], Xdn[9 * num_nodes];
+  TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+
+  for (int quad_index = 0; quad_index < num_quad; quad_index++) {
+    double pt[3];
+    quadrature::getQuadraturePoint(quad_index, pt);
+
+    // Compute X, X,xi and the interpolated normal n0
+    TacsScalar X[3], Xxi[6], n0[3];
+    basis::template interpFields<3, 3>(pt, Xpts, X);
+    basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
+    basis::template interpFields<3, 3>(pt, fn, n0);
+
+    transform->computeTransform(Xxi, n0, &data[T_OFFSET + 9 * quad_index]);
+    con->evalTangentStiffness(elemIndex, pt, X,
+                              &data[CS_OFFSET + num_stiff * quad_index]);
+    con->evalMassMoments(elemIndex, pt, X,
+                         &data[MOMENTS_OFFSET + 3 * quad_index]);
+  }
+
+  // Compute the transformation at each node
+  for (int i = 0; i < num_nodes; i++) {
+    TacsScalar Xxi[6];
+    TacsShellExtractFrame(&Xdn[9 * i], Xxi);
+    transform->computeTransform(Xxi, &fn[3 * i], &data[TN_OFFSET + 9 * i]);
+  }
+}
+
+/*
+  Add the residual for a single element using the element data. This
+  follows TACSShellElement::addResidual().
+*/
+template <class quadrature, class basis, class director, class model>
+TACS_HOST_DEVICE void
+TACSShellElementDevice<quadrature, basis, director, model>::addResidual(
+    const TacsScalar data[], const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar res[]) {
+  // Derivative of the director field
+  TacsScalar dd[dsize];
+  memset(dd, 0, dsize * sizeof(TacsScalar));
+
+  // Compute the node normal directions
+  TacsScalar fn[3 * num_nodes], Xdn[9 * num_nodes];
+  TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+
+  // Compute the drill strain penalty at each node
+  TacsScalar etn[num_nodes], detn[num_nodes];
+  memset(detn, 0, num_nodes * sizeof(TacsScalar));
+
+  const TacsScalar *Tn = &data[TN_OFFSET];
+  TacsScalar XdinvTn[9 * num_nodes];
+  TacsScalar u0xn[9 * num_nodes], Ctn[csize];
+  TacsShellComputeDrillStrain<vars_per_node, offset, basis, director, model>(
+      Xdn, fn, vars, Tn, XdinvTn, u0xn, Ctn, etn);
+
+  TacsScalar d[dsize], ddot[dsize], dddot[dsize];
+  director::template computeDirectorRates<vars_per_node, offset, num_nodes>(
+      vars, dvars, ddvars, fn, d, ddot, dddot);
+
+  // Compute the tying strain values
+  TacsScalar ety[basis::NUM_TYING_POINTS], dety[basis::NUM_TYING_POINTS];
+  memset(dety, 0, basis::NUM_TYING_POINTS * sizeof(TacsScalar));
+  model::template computeTyingStrain<vars_per_node, basis>(Xpts, fn, vars, d,
+                                                           ety);
+
+  for (int quad_index = 0; quad_index < num_quad; quad_index++) {
+    double pt[3];
+    double weight = quadrature::getQuadraturePoint(quad_index, pt);
+
+    // Get the transformation, stiffness and mass moments
+    const TacsScalar *T = &data[T_OFFSET + 9 * quad_index];
+    const TacsScalar *Cs = &data[CS_OFFSET + num_stiff * quad_index];
+    const TacsScalar *moments = &data[MOMENTS_OFFSET + 3 * quad_index];
+
+    // Compute X,xi and the interpolated normal n0
+    TacsScalar Xxi[6], n0[3], et;
+    basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
+    basis::template interpFields<3, 3>(pt, fn, n0);
+    basis::template interpFields<1, 1>(pt, etn, &et);
+
+    // Evaluate the displacement gradient at the point
+    TacsScalar XdinvT[9], XdinvzT[9];
+    TacsScalar u0x[9], u1x[9];
+    TacsScalar detXd = TacsShellComputeDispGrad<vars_per_node, basis>(
+        pt, Xpts, vars, fn, d, Xxi, n0, T, XdinvT, XdinvzT, u0x, u1x);
+    detXd *= weight;
+
+    // Evaluate the tying components of the strain
+    TacsScalar gty[6];
+    basis::interpTyingStrain(pt, ety, gty);
+    TacsScalar e0ty[6];
+    mat3x3SymmTransformTranspose(XdinvT, gty, e0ty);
+
+    // Compute the set of strain components
+    TacsScalar e[9];
+    model::evalStrain(u0x, u1x, e0ty, e);
+    e[8] = et;
+
+    // Compute the stress from the tangent stiffness
+    TacsScalar s[9];
+    TACSShellConstitutive::computeStress(&Cs[0], &Cs[6], &Cs[12], &Cs[18],
+                                         Cs[21], e, s);
+
+    // Compute the derivative of the product of the stress and strain
+    // with respect to u0x, u1x and e0ty
+    TacsScalar du0x[9], du1x[9], de0ty[6];
+    model::evalStrainSens(detXd, s, u0x, u1x, du0x, du1x, de0ty);
+
+    // Add the contribution to the drilling strain
+    TacsScalar det = detXd * s[8];
+    basis::template addInterpFieldsTranspose<1, 1>(pt, &det, detn);
+
+    // Add the contributions to the residual from du0x, du1x
+    TacsShellAddDispGradSens<vars_per_node, basis>(pt, T, XdinvT, XdinvzT, du0x,
+                                                   du1x, res, dd);
+
+    // Add the contribution from the tying strain
+    TacsScalar dgty[6];
+    mat3x3SymmTransformTransSens(XdinvT, de0ty, dgty);
+    basis::addInterpTyingStrainTranspose(pt, dgty, dety);
+
+    // Evaluate the second time derivatives
+    TacsScalar u0ddot[3], d0ddot[3];
+    basis::template interpFields<vars_per_node, 3>(pt, ddvars, u0ddot);
+    basis::template interpFields<3, 3>(pt, dddot, d0ddot);
+
+    // Add the inertial contributions
+    TacsScalar du0dot[3];
+    du0dot[0] = detXd * (moments[0] * u0ddot[0] + moments[1] * d0ddot[0]);
+    du0dot[1] = detXd * (moments[0] * u0ddot[1] + moments[1] * d0ddot[1]);
+    du0dot[2] = detXd * (moments[0] * u0ddot[2] + moments[1] * d0ddot[2]);
+    basis::template addInterpFieldsTranspose<vars_per_node, 3>(pt, du0dot, res);
+
+    TacsScalar dd0dot[3];
+    dd0dot[0] = detXd * (moments[1] * u0ddot[0] + moments[2] * d0ddot[0]);
+    dd0dot[1] = detXd * (moments[1] * u0ddot[1] + moments[2] * d0ddot[1]);
+    dd0dot[2] = detXd * (moments[1] * u0ddot[2] + moments[2] * d0ddot[2]);
+    basis::template addInterpFieldsTranspose<3, 3>(pt, dd0dot, dd);
+  }
+
+  // Add the contribution to the residual from the drill strain
+  TacsShellAddDrillStrainSens<vars_per_node, offset, basis, director, model>(
+      Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, res);
+
+  // Add the contributions from the tying strain
+  model::template addComputeTyingStrainTranspose<vars_per_node, basis>(
+      Xpts, fn, vars, d, dety, res, dd);
+
+  // Add the contributions to the director field
+  director::template addDirectorResidual<vars_per_node, offset, num_nodes>(
+      vars, dvars, ddvars, fn, dd, res);
+
+  // Add the contribution from the rotation constraint
+  director::template addRotationConstraint<vars_per_node, offset, num_nodes>(
+      vars, res);
+}
+
+/*
+  Add the residual and Jacobian for a single element using the element
+  data. This follows TACSShellElement::addJacobian().
+*/
+template <class quadrature, class basis, class director, class model>
+TACS_HOST_DEVICE void
+TACSShellElementDevice<quadrature, basis, director, model>::addJacobian(
+    const TacsScalar data[], TacsScalar alpha, TacsScalar beta,
+    TacsScalar gamma, const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar res[],
+    TacsScalar mat[]) {
+  // Derivative of the director field
+  TacsScalar dd[dsize];
+  memset(dd, 0, dsize * sizeof(TacsScalar));
+
+  // Second derivatives required for the director
+  TacsScalar d2d[dsize * dsize], d2du[usize * dsize];
+  TacsScalar d2Tdotd[dsize * dsize], d2Tdotu[usize * dsize];
+  memset(d2d, 0, dsize * dsize * sizeof(TacsScalar));
+  memset(d2du, 0, usize * dsize * sizeof(TacsScalar));
+  memset(d2Tdotd, 0, dsize * dsize * sizeof(TacsScalar));
+  memset(d2Tdotu, 0, usize * dsize * sizeof(TacsScalar));
+
+  // Zero the contributions to the tying strain derivatives
+  TacsScalar dety[basis::NUM_TYING_POINTS];
+  TacsScalar d2ety[basis::NUM_TYING_POINTS * basis::NUM_TYING_POINTS];
+  TacsScalar d2etyu[basis::NUM_TYING_POINTS * usize];
+  TacsScalar d2etyd[basis::NUM_TYING_POINTS * dsize];
+  memset(dety, 0, basis::NUM_TYING_POINTS * sizeof(TacsScalar));
+  memset(
+      d2ety, 0,
+      basis::NUM_TYING_POINTS * basis::NUM_TYING_POINTS * sizeof(TacsScalar));
+  memset(d2etyu, 0, basis::NUM_TYING_POINTS * usize * sizeof(TacsScalar));
+  memset(d2etyd, 0, basis::NUM_TYING_POINTS * dsize * sizeof(TacsScalar));
+
+  // Compute the node normal directions
+  TacsScalar fn[3 * num_nodes], Xdn[9 * num_nodes];
+  TacsShellComputeNodeNormals<basis>(Xpts, fn, Xdn);
+
+  // Compute the drill strain penalty at each node
+  TacsScalar etn[num_nodes], detn[num_nodes];
+  TacsScalar d2etn[num_nodes * num_nodes];
+  memset(detn, 0, num_nodes * sizeof(TacsScalar));
+  memset(d2etn, 0, num_nodes * num_nodes * sizeof(TacsScalar));
+
+  const TacsScalar *Tn = &data[TN_OFFSET];
+  TacsScalar XdinvTn[9 * num_nodes];
+  TacsScalar u0xn[9 * num_nodes], Ctn[csize];
+  TacsShellComputeDrillStrain<vars_per_node, offset, basis, director, model>(
+      Xdn, fn, vars, Tn, XdinvTn, u0xn, Ctn, etn);
+
+  TacsScalar d[dsize], ddot[dsize], dddot[dsize];
+  director::template computeDirectorRates<vars_per_node, offset, num_nodes>(
+      vars, dvars, ddvars, fn, d, ddot, dddot);
+
+  // Compute the tying strain values
+  TacsScalar ety[basis::NUM_TYING_POINTS];
+  model::template computeTyingStrain<vars_per_node, basis>(Xpts, fn, vars, d,
+                                                           ety);
+
+  for (int quad_index = 0; quad_index < num_quad; quad_index++) {
+    double pt[3];
+    double weight = quadrature::getQuadraturePoint(quad_index, pt);
+
+    // Get the transformation, stiffness and mass moments
+    const TacsScalar *T = &data[T_OFFSET + 9 * quad_index];
+    const TacsScalar *Cs = &data[CS_OFFSET + num_stiff * quad_index];
+    const TacsScalar *moments = &data[MOMENTS_OFFSET + 3 * quad_index];
+
+    // Compute X,xi and the interpolated normal n0
+    TacsScalar Xxi[6], n0[3], et;
+    basis::template interpFieldsGrad<3, 3>(pt, Xpts, Xxi);
+    basis::template interpFields<3, 3>(pt, fn, n0);
+    basis::template interpFields<1, 1>(pt, etn, &et);
+
+    // Evaluate the displacement gradient at the point
+    TacsScalar XdinvT[9], XdinvzT[9];
+    TacsScalar u0x[9], u1x[9];
+    TacsScalar detXd = TacsShellComputeDispGrad<vars_per_node, basis>(
+        pt, Xpts, vars, fn, d, Xxi, n0, T, XdinvT, XdinvzT, u0x, u1x);
+    detXd *= weight;
+
+    // Evaluate the tying components of the strain
+    TacsScalar gty[6];
+    basis::interpTyingStrain(pt, ety, gty);
+    TacsScalar e0ty[6];
+    mat3x3SymmTransformTranspose(XdinvT, gty, e0ty);
+
+    // Compute the set of strain components
+    TacsScalar e[9];
+    model::evalStrain(u0x, u1x, e0ty, e);
+    e[8] = et;
+
+    // Compute the stress from the tangent stiffness
+    TacsScalar s[9];
+    TACSShellConstitutive::computeStress(&Cs[0], &Cs[6], &Cs[12], &Cs[18],
+                                         Cs[21], e, s);
+
+    // Compute the derivative of the product of the stress and strain
+    // with respect to u0x, u1x and e0ty
+    TacsScalar du0x[9], du1x[9], de0ty[6];
+    model::evalStrainSens(detXd, s, u0x, u1x, du0x, du1x, de0ty);
+
+    TacsScalar d2u0x[81], d2u1x[81], d2u0xu1x[81];
+    TacsScalar d2e0ty[36], d2e0tyu0x[54], d2e0tyu1x[54];
+    model::evalStrainHessian(alpha * detXd, s, Cs, u0x, u1x, e0ty, d2u0x, d2u1x,
+                             d2u0xu1x, d2e0ty, d2e0tyu0x, d2e0tyu1x);
+
+    // Add the contributions to the residual from du0x and du1x
+    TacsScalar det = detXd * s[8];
+    basis::template addInterpFieldsTranspose<1, 1>(pt, &det, detn);
+
+    TacsShellAddDispGradSens<vars_per_node, basis>(pt, T, XdinvT, XdinvzT, du0x,
+                                                   du1x, res, dd);
+
+    // Add the contribution from the drilling stiffness
+    TacsScalar d2et = detXd * alpha * Cs[21];
+    basis::template addInterpFieldsOuterProduct<1, 1, 1, 1>(pt, &d2et, d2etn);
+
+    // Add the contributions to the Jacobian from d2u0x, d2u1x
+    TacsShellAddDispGradHessian<vars_per_node, basis>(
+        pt, T, XdinvT, XdinvzT, d2u0x, d2u1x, d2u0xu1x, mat, d2d, d2du);
+
+    // Add the contributions from the tying strain
+    TacsScalar dgty[6], d2gty[36];
+    mat3x3SymmTransformTransSens(XdinvT, de0ty, dgty);
+    mat3x3SymmTransformTransHessian(XdinvT, d2e0ty, d2gty);
+    basis::addInterpTyingStrainTranspose(pt, dgty, dety);
+    basis::addInterpTyingStrainHessian(pt, d2gty, d2ety);
+
+    // Add the coupling between the displacement and tying strain
+    TacsShellAddTyingDispCoupling<basis>(pt, T, XdinvT, XdinvzT, d2e0tyu0x,
+                                         d2e0tyu1x, d2etyu, d2etyd);
+
+    // Evaluate the second time derivatives
+    TacsScalar u0ddot[3], d0ddot[3];
+    basis::template interpFields<vars_per_node, 3>(pt, ddvars, u0ddot);
+    basis::template interpFields<3, 3>(pt, dddot, d0ddot);
+
+    // Add the inertial contributions
+    TacsScalar du0dot[3];
+    du0dot[0] = detXd * (moments[0] * u0ddot[0] + moments[1] * d0ddot[0]);
+    du0dot[1] = detXd * (moments[0] * u0ddot[1] + moments[1] * d0ddot[1]);
+    du0dot[2] = detXd * (moments[0] * u0ddot[2] + moments[1] * d0ddot[2]);
+    basis::template addInterpFieldsTranspose<vars_per_node, 3>(pt, du0dot, res);
+
+    TacsScalar dd0dot[3];
+    dd0dot[0] = detXd * (moments[1] * u0ddot[0] + moments[2] * d0ddot[0]);
+    dd0dot[1] = detXd * (moments[1] * u0ddot[1] + moments[2] * d0ddot[1]);
+    dd0dot[2] = detXd * (moments[1] * u0ddot[2] + moments[2] * d0ddot[2]);
+    basis::template addInterpFieldsTranspose<3, 3>(pt, dd0dot, dd);
+
+    TacsScalar d2u0dot[9];
+    memset(d2u0dot, 0, 9 * sizeof(TacsScalar));
+    d2u0dot[0] = d2u0dot[4] = d2u0dot[8] = gamma * detXd * moments[0];
+    basis::template addInterpFieldsOuterProduct<vars_per_node, vars_per_node, 3,
+                                                3>(pt, d2u0dot, mat);
+
+    TacsScalar d2Td[9];
+    memset(d2Td, 0, 9 * sizeof(TacsScalar));
+    d2Td[0] = d2Td[4] = d2Td[8] = detXd * moments[2];
+    basis::template addInterpFieldsOuterProduct<3, 3, 3, 3>(pt, d2Td, d2Tdotd);
+
+    d2Td[0] = d2Td[4] = d2Td[8] = detXd * moments[1];
+    basis::template addInterpFieldsOuterProduct<3, 3, 3, 3>(pt, d2Td, d2Tdotu);
+  }
+
+  // Add the contribution to the residual from the drill strain
+  TacsShellAddDrillStrainHessian<vars_per_node, offset, basis, director, model>(
+      alpha, Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, d2etn, res, mat);
+
+  // Add the residual from the tying strain
+  model::template addComputeTyingStrainTranspose<vars_per_node, basis>(
+      Xpts, fn, vars, d, dety, res, dd);
+
+  // Add the second order terms from the tying strain
+  model::template addComputeTyingStrainHessian<vars_per_node, basis>(
+      alpha, Xpts, fn, vars, d, dety, d2ety, d2etyu, d2etyd, mat, d2d, d2du);
+
+  // Add the contributions to the stiffness matrix
+  director::template addDirectorJacobian<vars_per_node, offset, num_nodes>(
+      alpha, beta, gamma, vars, dvars, ddvars, fn, dd, d2Tdotd, d2Tdotu, d2d,
+      d2du, res, mat);
+
+  // Add the constraint associated with the rotational parametrization
+  director::template addRotationConstrJacobian<vars_per_node, offset,
+                                               num_nodes>(alpha, vars, res,
+                                                          mat);
+}
+
+/*
+  Add the residuals for a batch of elements
+
+  All arrays are device arrays that store the values for each element
+  contiguously: data has DATA_SIZE entries, Xpts has 3*num_nodes
+  entries and vars, dvars, ddvars and res have num_vars entries for
+  each element.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElementDevice<quadrature, basis, director, model>::
+    addResidualBatch(int nelems, const TacsScalar data[],
+                     const TacsScalar Xpts[], const TacsScalar vars[],
+                     const TacsScalar dvars[], const TacsScalar ddvars[],
+                     TacsScalar res[]) {
+  if (nelems <= 0) {
+    return;
+  }
+#if defined(__CUDACC__) || defined(__HIPCC__)
+  int nblocks = (nelems + TACS_SHELL_DEVICE_BLOCK_SIZE - 1) /
+                TACS_SHELL_DEVICE_BLOCK_SIZE;
+  TacsShellDeviceResidualKernel<TACSShellElementDevice>
+      <<<nblocks, TACS_SHELL_DEVICE_BLOCK_SIZE>>>(nelems, data, Xpts, vars,
+                                                  dvars, ddvars, res);
+#elif defined(TACS_USE_CUDA) || defined(TACS_USE_HIP)
+  fprintf(stderr,
+          "TACSShellElementDevice error: addResidualBatch() must be "
+          "compiled with the device compiler\n");
+#else
+  const int nx = 3 * num_nodes;
+  for (int i = 0; i < nelems; i++) {
+    addResidual(&data[DATA_SIZE * i], &Xpts[nx * i], &vars[num_vars * i],
+                &dvars[num_vars * i], &ddvars[num_vars * i],
+                &res[num_vars * i]);
+  }
+#endif  // __CUDACC__ || __HIPCC__
+}
+
+/*
+  Add the residuals and Jacobians for a batch of elements
+
+  The arrays are stored as in addResidualBatch(), and mat has
+  num_vars*num_vars entries for each element.
+*/
+template <class quadrature, class basis, class director, class model>
+void TACSShellElementDevice<quadrature, basis, director, model>::
+    addJacobianBatch(int nelems, const TacsScalar data[], TacsScalar alpha,
+                     TacsScalar beta, TacsScalar gamma,
+                     const TacsScalar Xpts[], const TacsScalar vars[],
+                     const TacsScalar dvars[], const TacsScalar ddvars[],
+                     TacsScalar res[], TacsScalar mat[]) {
+  if (nelems <= 0) {
+    return;
+  }
+#if defined(__CUDACC__) || defined(__HIPCC__)
+  int nblocks = (nelems + TACS_SHELL_DEVICE_BLOCK_SIZE - 1) /
+                TACS_SHELL_DEVICE_BLOCK_SIZE;
+  TacsShellDeviceJacobianKernel<TACSShellElementDevice>
+      <<<nblocks, TACS_SHELL_DEVICE_BLOCK_SIZE>>>(nelems, data, alpha, beta,
+                                                  gamma, Xpts, vars, dvars,
+                                                  ddvars, res, mat);
+#elif defined(TACS_USE_CUDA) || defined(TACS_USE_HIP)
+  fprintf(stderr,
+          "TACSShellElementDevice error: addJacobianBatch() must be "
+          "compiled with the device compiler\n");
+#else
+  const int nx = 3 * num_nodes;
+  for (int i = 0; i < nelems; i++) {
+    addJacobian(&data[DATA_SIZE * i], alpha, beta, gamma, &Xpts[nx * i],
+                &vars[num_vars * i], &dvars[num_vars * i],
+                &ddvars[num_vars * i], &res[num_vars * i],
+                &mat[num_vars * num_vars * i]);
+  }
+#endif  // __CUDACC__ || __HIPCC__
+}
+
+#endif  // TACS_SHELL_ELEMENT_DEVICE_H
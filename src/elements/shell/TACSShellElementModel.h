@@ -26,9 +26,11 @@ class TACSShellLinearModel {
     @param d The interpolated director field
   */
   template <int vars_per_node, class basis>
-  static void computeTyingStrain(const TacsScalar Xpts[], const TacsScalar fn[],
-                                 const TacsScalar vars[], const TacsScalar d[],
-                                 TacsScalar ety[]) {
+  TACS_HOST_DEVICE static void computeTyingStrain(const TacsScalar Xpts[],
+                                                  const TacsScalar fn[],
+                                                  const TacsScalar vars[],
+                                                  const TacsScalar d[],
+                                                  TacsScalar ety[]) {
     for (int index = 0; index < basis::NUM_TYING_POINTS; index++) {
       // Get the field index
       const TacsShellTyingStrainComponent field = basis::getTyingField(index);
@@ -73,7 +75,7 @@ class TACSShellLinearModel {
   }
 
   template <int vars_per_node, class basis>
-  static void addComputeTyingStrainTranspose(
+  TACS_HOST_DEVICE static void addComputeTyingStrainTranspose(
       const TacsScalar Xpts[], const TacsScalar fn[], const TacsScalar vars[],
       const TacsScalar d[], const TacsScalar dety[], TacsScalar res[],
       TacsScalar dd[]) {
@@ -156,7 +158,7 @@ class TACSShellLinearModel {
   }
 
   template <int vars_per_node, class basis>
-  static void addComputeTyingStrainHessian(
+  TACS_HOST_DEVICE static void addComputeTyingStrainHessian(
       const TacsScalar alpha, const TacsScalar Xpts[], const TacsScalar fn[],
       const TacsScalar vars[], const TacsScalar d[], const TacsScalar dety[],
       const TacsScalar d2ety[], const TacsScalar d2etyu[],
@@ -369,10 +371,14 @@ class TACSShellLinearModel {
     Compute the directional derivative
   */
   template <int vars_per_node, class basis>
-  static void computeTyingStrainDeriv(
-      const TacsScalar Xpts[], const TacsScalar fn[], const TacsScalar vars[],
-      const TacsScalar d[], const TacsScalar varsd[], const TacsScalar dd[],
-      TacsScalar ety[], TacsScalar etyd[]) {
+  TACS_HOST_DEVICE static void computeTyingStrainDeriv(const TacsScalar Xpts[],
+                                                       const TacsScalar fn[],
+                                                       const TacsScalar vars[],
+                                                       const TacsScalar d[],
+                                                       const TacsScalar varsd[],
+                                                       const TacsScalar dd[],
+                                                       TacsScalar ety[],
+                                                       TacsScalar etyd[]) {
     for (int index = 0; index < basis::NUM_TYING_POINTS; index++) {
       // Get the field index
       const TacsShellTyingStrainComponent field = basis::getTyingField(index);
@@ -433,8 +439,10 @@ class TACSShellLinearModel {
     Evaluate the strain as a function of the displacement derivatives
     and interpolated strain from the tensorial components
   */
-  static inline void evalStrain(const TacsScalar u0x[], const TacsScalar u1x[],
-                                const TacsScalar e0ty[], TacsScalar e[]) {
+  TACS_HOST_DEVICE static inline void evalStrain(const TacsScalar u0x[],
+                                                 const TacsScalar u1x[],
+                                                 const TacsScalar e0ty[],
+                                                 TacsScalar e[]) {
     // Evaluate the in-plane strains from the tying strain expressions
     e[0] = e0ty[0];
     e[1] = e0ty[3];
@@ -453,11 +461,13 @@ class TACSShellLinearModel {
   /**
     Evaluate the derivative of the strain
   */
-  static inline void evalStrainSens(const TacsScalar scale,
-                                    const TacsScalar dfde[],
-                                    const TacsScalar u0x[],
-                                    const TacsScalar u1x[], TacsScalar du0x[],
-                                    TacsScalar du1x[], TacsScalar de0ty[]) {
+  TACS_HOST_DEVICE static inline void evalStrainSens(const TacsScalar scale,
+                                                     const TacsScalar dfde[],
+                                                     const TacsScalar u0x[],
+                                                     const TacsScalar u1x[],
+                                                     TacsScalar du0x[],
+                                                     TacsScalar du1x[],
+                                                     TacsScalar de0ty[]) {
     // Evaluate the in-plane strains from the tying strain expressions
     de0ty[0] = scale * dfde[0];
     de0ty[1] = 2.0 * scale * dfde[2];
@@ -488,10 +498,14 @@ class TACSShellLinearModel {
     du1x[8] = 0.0;
   }
 
-  static inline void evalStrainDeriv(
-      const TacsScalar u0x[], const TacsScalar u1x[], const TacsScalar e0ty[],
-      const TacsScalar u0xd[], const TacsScalar u1xd[],
-      const TacsScalar e0tyd[], TacsScalar e[], TacsScalar ed[]) {
+  TACS_HOST_DEVICE static inline void evalStrainDeriv(const TacsScalar u0x[],
+                                                      const TacsScalar u1x[],
+                                                      const TacsScalar e0ty[],
+                                                      const TacsScalar u0xd[],
+                                                      const TacsScalar u1xd[],
+                                                      const TacsScalar e0tyd[],
+                                                      TacsScalar e[],
+                                                      TacsScalar ed[]) {
     // Evaluate the in-plane strains from the tying strain expressions
     e[0] = e0ty[0];
     e[1] = e0ty[3];
@@ -521,7 +535,7 @@ class TACSShellLinearModel {
     ed[7] = 2.0 * e0tyd[2];
   }
 
-  static inline void evalStrainHessian(
+  TACS_HOST_DEVICE static inline void evalStrainHessian(
       const TacsScalar scale, const TacsScalar dfde[], const TacsScalar Cs[],
       const TacsScalar u0x[], const TacsScalar u1x[], const TacsScalar e0ty[],
       TacsScalar d2u0x[], TacsScalar d2u1x[], TacsScalar d2u0xu1x[],
@@ -637,9 +651,11 @@ class TACSShellNonlinearModel {
     @param d The interpolated director field
   */
   template <int vars_per_node, class basis>
-  static void computeTyingStrain(const TacsScalar Xpts[], const TacsScalar fn[],
-                                 const TacsScalar vars[], const TacsScalar d[],
-                                 TacsScalar ety[]) {
+  TACS_HOST_DEVICE static void computeTyingStrain(const TacsScalar Xpts[],
+                                                  const TacsScalar fn[],
+                                                  const TacsScalar vars[],
+                                                  const TacsScalar d[],
+                                                  TacsScalar ety[]) {
     for (int index = 0; index < basis::NUM_TYING_POINTS; index++) {
       // Get the field index
       const TacsShellTyingStrainComponent field = basis::getTyingField(index);
@@ -693,7 +709,7 @@ class TACSShellNonlinearModel {
   }
 
   template <int vars_per_node, class basis>
-  static void addComputeTyingStrainTranspose(
+  TACS_HOST_DEVICE static void addComputeTyingStrainTranspose(
       const TacsScalar Xpts[], const TacsScalar fn[], const TacsScalar vars[],
       const TacsScalar d[], const TacsScalar dety[], TacsScalar res[],
       TacsScalar dd[]) {
@@ -775,7 +791,7 @@ class TACSShellNonlinearModel {
   }
 
   template <int vars_per_node, class basis>
-  static void addComputeTyingStrainHessian(
+  TACS_HOST_DEVICE static void addComputeTyingStrainHessian(
       const TacsScalar alpha, const TacsScalar Xpts[], const TacsScalar fn[],
       const TacsScalar vars[], const TacsScalar d[], const TacsScalar dety[],
       const TacsScalar d2ety[], const TacsScalar d2etyu[],
@@ -1027,10 +1043,14 @@ class TACSShellNonlinearModel {
   }
 
   template <int vars_per_node, class basis>
-  static void computeTyingStrainDeriv(
-      const TacsScalar Xpts[], const TacsScalar fn[], const TacsScalar vars[],
-      const TacsScalar d[], const TacsScalar varsd[], const TacsScalar dd[],
-      TacsScalar ety[], TacsScalar etyd[]) {
+  TACS_HOST_DEVICE static void computeTyingStrainDeriv(const TacsScalar Xpts[],
+                                                       const TacsScalar fn[],
+                                                       const TacsScalar vars[],
+                                                       const TacsScalar d[],
+                                                       const TacsScalar varsd[],
+                                                       const TacsScalar dd[],
+                                                       TacsScalar ety[],
+                                                       TacsScalar etyd[]) {
     for (int index = 0; index < basis::NUM_TYING_POINTS; index++) {
       // Get the field index
       const TacsShellTyingStrainComponent field = basis::getTyingField(index);
@@ -1108,8 +1128,10 @@ class TACSShellNonlinearModel {
     Evaluate the strain as a function of the displacement derivatives
     and interpolated strain from the tensorial components
   */
-  static void evalStrain(const TacsScalar u0x[], const TacsScalar u1x[],
-                         const TacsScalar e0ty[], TacsScalar e[]) {
+  TACS_HOST_DEVICE static void evalStrain(const TacsScalar u0x[],
+                                          const TacsScalar u1x[],
+                                          const TacsScalar e0ty[],
+                                          TacsScalar e[]) {
     // Evaluate the in-plane strains from the tying strain expressions
     e[0] = e0ty[0];
     e[1] = e0ty[3];
@@ -1130,10 +1152,13 @@ class TACSShellNonlinearModel {
   /**
     Evaluate the derivative of the strain
   */
-  static void evalStrainSens(const TacsScalar scale, const TacsScalar dfde[],
-                             const TacsScalar u0x[], const TacsScalar u1x[],
-                             TacsScalar du0x[], TacsScalar du1x[],
-                             TacsScalar de0ty[]) {
+  TACS_HOST_DEVICE static void evalStrainSens(const TacsScalar scale,
+                                              const TacsScalar dfde[],
+                                              const TacsScalar u0x[],
+                                              const TacsScalar u1x[],
+                                              TacsScalar du0x[],
+                                              TacsScalar du1x[],
+                                              TacsScalar de0ty[]) {
     // Evaluate the in-plane strains from the tying strain expressions
     de0ty[0] = scale * dfde[0];
     de0ty[1] = 2.0 * scale * dfde[2];
@@ -1165,10 +1190,14 @@ class TACSShellNonlinearModel {
     du1x[8] = 0.0;
   }
 
-  static void evalStrainDeriv(const TacsScalar u0x[], const TacsScalar u1x[],
-                              const TacsScalar e0ty[], const TacsScalar u0xd[],
-                              const TacsScalar u1xd[], const TacsScalar e0tyd[],
-                              TacsScalar e[], TacsScalar ed[]) {
+  TACS_HOST_DEVICE static void evalStrainDeriv(const TacsScalar u0x[],
+                                               const TacsScalar u1x[],
+                                               const TacsScalar e0ty[],
+                                               const TacsScalar u0xd[],
+                                               const TacsScalar u1xd[],
+                                               const TacsScalar e0tyd[],
+                                               TacsScalar e[],
+                                               TacsScalar ed[]) {
     // Evaluate the in-plane strains from the tying strain expressions
     e[0] = e0ty[0];
     e[1] = e0ty[3];
@@ -1206,13 +1235,18 @@ class TACSShellNonlinearModel {
     ed[7] = 2.0 * e0tyd[2];
   }
 
-  static void evalStrainHessian(const TacsScalar scale, const TacsScalar s[],
-                                const TacsScalar Cs[], const TacsScalar u0x[],
-                                const TacsScalar u1x[], const TacsScalar e0ty[],
-                                TacsScalar d2u0x[], TacsScalar d2u1x[],
-                                TacsScalar d2u0xu1x[], TacsScalar d2e0ty[],
-                                TacsScalar d2e0tyu0x[],
-                                TacsScalar d2e0tyu1x[]) {
+  TACS_HOST_DEVICE static void evalStrainHessian(const TacsScalar scale,
+                                                 const TacsScalar s[],
+                                                 const TacsScalar Cs[],
+                                                 const TacsScalar u0x[],
+                                                 const TacsScalar u1x[],
+                                                 const TacsScalar e0ty[],
+                                                 TacsScalar d2u0x[],
+                                                 TacsScalar d2u1x[],
+                                                 TacsScalar d2u0xu1x[],
+                                                 TacsScalar d2e0ty[],
+                                                 TacsScalar d2e0tyu0x[],
+                                                 TacsScalar d2e0tyu1x[]) {
     TacsScalar drill;
     const TacsScalar *A, *B, *D, *As;
     TACSShellConstitutive::extractTangentStiffness(Cs, &A, &B, &D, &As, &drill);
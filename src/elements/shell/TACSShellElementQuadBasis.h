@@ -15,8 +15,9 @@ enum TacsShellTyingStrainComponent {
 };
 
 template <int order>
-inline void TacsLagrangeShapeFunction(const double u, const double knots[],
-                                      double N[]) {
+TACS_HOST_DEVICE inline void TacsLagrangeShapeFunction(const double u,
+                                                       const double knots[],
+                                                       double N[]) {
   // Loop over the shape functions
   for (int i = 0; i < order; i++) {
     N[i] = 1.0;
@@ -30,9 +31,8 @@ inline void TacsLagrangeShapeFunction(const double u, const double knots[],
 }
 
 template <int order>
-inline void TacsLagrangeShapeFuncDerivative(const double u,
-                                            const double knots[], double N[],
-                                            double Nd[]) {
+TACS_HOST_DEVICE inline void TacsLagrangeShapeFuncDerivative(
+    const double u, const double knots[], double N[], double Nd[]) {
   // Loop over the shape function knot locations
   for (int i = 0; i < order; i++) {
     N[i] = 1.0;
@@ -60,7 +60,8 @@ inline void TacsLagrangeShapeFuncDerivative(const double u,
 }
 
 template <int order>
-inline void TacsLagrangeLobattoShapeFunction(const double u, double *N) {
+TACS_HOST_DEVICE inline void TacsLagrangeLobattoShapeFunction(const double u,
+                                                              double *N) {
   if (order == 1) {
     N[0] = 1.0;
   } else if (order == 2) {
@@ -83,8 +84,8 @@ inline void TacsLagrangeLobattoShapeFunction(const double u, double *N) {
 }
 
 template <int order>
-inline void TacsLagrangeLobattoShapeFuncDerivative(const double u, double *N,
-                                                   double *Nd) {
+TACS_HOST_DEVICE inline void TacsLagrangeLobattoShapeFuncDerivative(
+    const double u, double *N, double *Nd) {
   if (order == 1) {
     N[0] = 1.0;
   } else if (order == 2) {
@@ -113,7 +114,7 @@ inline void TacsLagrangeLobattoShapeFuncDerivative(const double u, double *N,
   }
 }
 
-const double TacsShellLinearTyingPoints[2] = {-1.0, 1.0};
+TACS_DEVICE_CONST double TacsShellLinearTyingPoints[2] = {-1.0, 1.0};
 
 template <int order>
 class TACSShellQuadBasis {
@@ -144,7 +145,7 @@ class TACSShellQuadBasis {
   /*
     Get the parametric points of each node in the element
   */
-  static void getNodePoint(const int n, double pt[]) {
+  TACS_HOST_DEVICE static void getNodePoint(const int n, double pt[]) {
     pt[0] = -1.0 + (2.0 / (order - 1)) * (n % order);
     pt[1] = -1.0 + (2.0 / (order - 1)) * (n / order);
   }
@@ -169,8 +170,9 @@ class TACSShellQuadBasis {
   }
 
   template <int vars_per_node, int m>
-  static void interpFields(const double pt[], const TacsScalar values[],
-                           TacsScalar field[]) {
+  TACS_HOST_DEVICE static void interpFields(const double pt[],
+                                            const TacsScalar values[],
+                                            TacsScalar field[]) {
     double na[order], nb[order];
     TacsLagrangeLobattoShapeFunction<order>(pt[0], na);
     TacsLagrangeLobattoShapeFunction<order>(pt[1], nb);
@@ -190,9 +192,8 @@ class TACSShellQuadBasis {
   }
 
   template <int vars_per_node, int m>
-  static void addInterpFieldsTranspose(const double pt[],
-                                       const TacsScalar field[],
-                                       TacsScalar values[]) {
+  TACS_HOST_DEVICE static void addInterpFieldsTranspose(
+      const double pt[], const TacsScalar field[], TacsScalar values[]) {
     double na[order], nb[order];
     TacsLagrangeLobattoShapeFunction<order>(pt[0], na);
     TacsLagrangeLobattoShapeFunction<order>(pt[1], nb);
@@ -208,8 +209,9 @@ class TACSShellQuadBasis {
   }
 
   template <int vars_per_node, int m>
-  static void interpFieldsGrad(const double pt[], const TacsScalar values[],
-                               TacsScalar grad[]) {
+  TACS_HOST_DEVICE static void interpFieldsGrad(const double pt[],
+                                                const TacsScalar values[],
+                                                TacsScalar grad[]) {
     double na[order], dna[order];
     double nb[order], dnb[order];
     TacsLagrangeLobattoShapeFuncDerivative<order>(pt[0], na, dna);
@@ -232,8 +234,8 @@ class TACSShellQuadBasis {
   }
 
   template <int vars_per_node, int m>
-  static void addInterpFieldsGradTranspose(const double pt[], TacsScalar grad[],
-                                           TacsScalar values[]) {
+  TACS_HOST_DEVICE static void addInterpFieldsGradTranspose(
+      const double pt[], TacsScalar grad[], TacsScalar values[]) {
     double na[order], dna[order];
     double nb[order], dnb[order];
     TacsLagrangeLobattoShapeFuncDerivative<order>(pt[0], na, dna);
@@ -250,6 +252,120 @@ class TACSShellQuadBasis {
     }
   }
 
+  /**
+    Interpolate the fields and their parametric gradients at all the
+    quadrature points using sum factorization.
+
+    The output at quadrature point n is stored as the values
+    out[3*m*n + k] followed by the gradient out[3*m*n + m + 2*k + j],
+    the same layout as interpFields and interpFieldsGrad. The
+    quadrature must be a tensor product of a one-dimensional rule, so
+    the fields are contracted one direction at a time at a cost of
+    O(order^3) per field instead of O(order^4).
+
+    @param values The values at the nodes
+    @param out The fields and gradients at the quadrature points
+  */
+  template <class quadrature, int vars_per_node, int m>
+  TACS_HOST_DEVICE static void interpAllFieldsGrad(const TacsScalar values[],
+                                                   TacsScalar out[]) {
+    const int nq = quadrature::NUM_QUADRATURE_POINTS_1D;
+    double N[order * nq], Nx[order * nq];
+    getTensorShapeFunctions<quadrature>(N, Nx);
+
+    // Contract over the nodes in the x-direction
+    TacsScalar A[order * nq * m], Ax[order * nq * m];
+    for (int j = 0; j < order; j++) {
+      for (int a = 0; a < nq; a++) {
+        TacsScalar *t = &A[m * (nq * j + a)];
+        TacsScalar *tx = &Ax[m * (nq * j + a)];
+        for (int k = 0; k < m; k++) {
+          t[k] = tx[k] = 0.0;
+        }
+
+        const TacsScalar *v = &values[vars_per_node * order * j];
+        for (int i = 0; i < order; i++) {
+          for (int k = 0; k < m; k++) {
+            t[k] += N[order * a + i] * v[k];
+            tx[k] += Nx[order * a + i] * v[k];
+          }
+          v += vars_per_node;
+        }
+      }
+    }
+
+    // Contract over the nodes in the y-direction
+    for (int b = 0; b < nq; b++) {
+      for (int a = 0; a < nq; a++) {
+        TacsScalar *u = &out[3 * m * (nq * b + a)];
+        for (int k = 0; k < 3 * m; k++) {
+          u[k] = 0.0;
+        }
+
+        for (int j = 0; j < order; j++) {
+          const TacsScalar *t = &A[m * (nq * j + a)];
+          const TacsScalar *tx = &Ax[m * (nq * j + a)];
+          for (int k = 0; k < m; k++) {
+            u[k] += N[order * b + j] * t[k];
+            u[m + 2 * k] += N[order * b + j] * tx[k];
+            u[m + 2 * k + 1] += Nx[order * b + j] * t[k];
+          }
+        }
+      }
+    }
+  }
+
+  /**
+    Add the transpose of interpAllFieldsGrad to the values at the nodes
+
+    @param in The field and gradient coefficients at the quadrature points
+    @param values The values at the nodes
+  */
+  template <class quadrature, int vars_per_node, int m>
+  TACS_HOST_DEVICE static void addInterpAllFieldsGradTranspose(
+      const TacsScalar in[], TacsScalar values[]) {
+    const int nq = quadrature::NUM_QUADRATURE_POINTS_1D;
+    double N[order * nq], Nx[order * nq];
+    getTensorShapeFunctions<quadrature>(N, Nx);
+
+    // Transpose of the contraction in the y-direction
+    TacsScalar A[order * nq * m], Ax[order * nq * m];
+    for (int k = 0; k < order * nq * m; k++) {
+      A[k] = Ax[k] = 0.0;
+    }
+
+    for (int b = 0; b < nq; b++) {
+      for (int a = 0; a < nq; a++) {
+        const TacsScalar *u = &in[3 * m * (nq * b + a)];
+        for (int j = 0; j < order; j++) {
+          TacsScalar *t = &A[m * (nq * j + a)];
+          TacsScalar *tx = &Ax[m * (nq * j + a)];
+          for (int k = 0; k < m; k++) {
+            t[k] += (N[order * b + j] * u[k] +
+                     Nx[order * b + j] * u[m + 2 * k + 1]);
+            tx[k] += N[order * b + j] * u[m + 2 * k];
+          }
+        }
+      }
+    }
+
+    // Transpose of the contraction in the x-direction
+    for (int j = 0; j < order; j++) {
+      for (int a = 0; a < nq; a++) {
+        const TacsScalar *t = &A[m * (nq * j + a)];
+        const TacsScalar *tx = &Ax[m * (nq * j + a)];
+
+        TacsScalar *v = &values[vars_per_node * order * j];
+        for (int i = 0; i < order; i++) {
+          for (int k = 0; k < m; k++) {
+            v[k] += N[order * a + i] * t[k] + Nx[order * a + i] * tx[k];
+          }
+          v += vars_per_node;
+        }
+      }
+    }
+  }
+
   /**
     Add the outer-product of the shape functions to the matrix.
 
@@ -268,9 +384,8 @@ class TACSShellQuadBasis {
     @param mat The Jacobian matrix
   */
   template <int nbrows, int nbcols, int njrows, int njcols>
-  static void addInterpFieldsOuterProduct(const double pt[],
-                                          const TacsScalar jac[],
-                                          TacsScalar *mat) {
+  TACS_HOST_DEVICE static void addInterpFieldsOuterProduct(
+      const double pt[], const TacsScalar jac[], TacsScalar *mat) {
     double na[order], nb[order];
     TacsLagrangeLobattoShapeFunction<order>(pt[0], na);
     TacsLagrangeLobattoShapeFunction<order>(pt[1], nb);
@@ -319,9 +434,9 @@ class TACSShellQuadBasis {
     @param mat The element matrix
   */
   template <int nbrows, int nbcols, int njrows, int njcols>
-  static void addInterpGradOuterProduct(const double pt[],
-                                        const TacsScalar jac[],
-                                        TacsScalar *mat) {
+  TACS_HOST_DEVICE static void addInterpGradOuterProduct(const double pt[],
+                                                         const TacsScalar jac[],
+                                                         TacsScalar *mat) {
     double na[order], dna[order];
     double nb[order], dnb[order];
     TacsLagrangeLobattoShapeFuncDerivative<order>(pt[0], na, dna);
@@ -377,10 +492,9 @@ class TACSShellQuadBasis {
     @param mat The element matrix
   */
   template <int nbrows, int nbcols, int njrows, int njcols>
-  static void addInterpGradMixedOuterProduct(const double pt[],
-                                             const TacsScalar jac[],
-                                             const TacsScalar jacT[],
-                                             TacsScalar *mat) {
+  TACS_HOST_DEVICE static void addInterpGradMixedOuterProduct(
+      const double pt[], const TacsScalar jac[], const TacsScalar jacT[],
+      TacsScalar *mat) {
     double na[order], dna[order];
     double nb[order], dnb[order];
     TacsLagrangeLobattoShapeFuncDerivative<order>(pt[0], na, dna);
@@ -501,8 +615,8 @@ class TACSShellQuadBasis {
   /*
     Get the knots associated with the tying points
   */
-  static inline void getTyingKnots(const double **ty_knots_order,
-                                   const double **ty_knots_reduced) {
+  TACS_HOST_DEVICE static inline void getTyingKnots(
+      const double **ty_knots_order, const double **ty_knots_reduced) {
     if (order == 2) {
       *ty_knots_order = TacsShellLinearTyingPoints;
       *ty_knots_reduced = TacsGaussQuadPts1;
@@ -527,7 +641,7 @@ class TACSShellQuadBasis {
     @param index The index of the tying point
     @param pt The parametric point associated with the tying point
   */
-  static inline void getTyingPoint(int ty_index, double pt[]) {
+  TACS_HOST_DEVICE static inline void getTyingPoint(int ty_index, double pt[]) {
     const double *ty_knots_order, *ty_knots_reduced;
     getTyingKnots(&ty_knots_order, &ty_knots_reduced);
 
@@ -566,7 +680,7 @@ class TACSShellQuadBasis {
   /*
     Evaluate the interpolation for all of the tying points
   */
-  static void evalTyingInterp(const double pt[], double N[]) {
+  TACS_HOST_DEVICE static void evalTyingInterp(const double pt[], double N[]) {
     const double *ty_knots_order, *ty_knots_reduced;
     getTyingKnots(&ty_knots_order, &ty_knots_reduced);
 
@@ -618,7 +732,7 @@ class TACSShellQuadBasis {
   /*
     Get the number of tying points associated with each field
   */
-  static inline int getNumTyingPoints(const int field) {
+  TACS_HOST_DEVICE static inline int getNumTyingPoints(const int field) {
     if (field == TACS_SHELL_G11_COMPONENT) {
       return NUM_G11_TYING_POINTS;
     } else if (field == TACS_SHELL_G22_COMPONENT) {
@@ -648,9 +762,9 @@ class TACSShellQuadBasis {
     @param ety The strain computed at the tying points
     @param gty The interpolated tying strain
   */
-  static inline void interpTyingStrain(const double pt[],
-                                       const TacsScalar ety[],
-                                       TacsScalar gty[]) {
+  TACS_HOST_DEVICE static inline void interpTyingStrain(const double pt[],
+                                                        const TacsScalar ety[],
+                                                        TacsScalar gty[]) {
     const int index[] = {0, 3, 1, 4, 2};
     const int num_tying_fields = 5;
 
@@ -678,9 +792,8 @@ class TACSShellQuadBasis {
     @param dgty The derivative of the interpolated strain
     @param dety The output derivative of the strain at the tying points
   */
-  static inline void addInterpTyingStrainTranspose(const double pt[],
-                                                   const TacsScalar dgty[],
-                                                   TacsScalar dety[]) {
+  TACS_HOST_DEVICE static inline void addInterpTyingStrainTranspose(
+      const double pt[], const TacsScalar dgty[], TacsScalar dety[]) {
     const int index[] = {0, 3, 1, 4, 2};
     const int num_tying_fields = 5;
 
@@ -704,9 +817,8 @@ class TACSShellQuadBasis {
     @param d2gty The second derivative of the interpolated strain
     @param d2ety The second derivatives of the strain at the tying points
   */
-  static inline void addInterpTyingStrainHessian(const double pt[],
-                                                 const TacsScalar d2gty[],
-                                                 TacsScalar d2ety[]) {
+  TACS_HOST_DEVICE static inline void addInterpTyingStrainHessian(
+      const double pt[], const TacsScalar d2gty[], TacsScalar d2ety[]) {
     // Set the values into the strain tensor
     const int index[] = {0, 3, 1, 4, 2};
     const int num_strains = 6;
@@ -732,6 +844,22 @@ class TACSShellQuadBasis {
       }
     }
   }
+
+ private:
+  /*
+    Evaluate the one-dimensional shape functions and their derivatives
+    at the points of a tensor-product quadrature rule
+  */
+  template <class quadrature>
+  TACS_HOST_DEVICE static void getTensorShapeFunctions(double N[],
+                                                       double Nx[]) {
+    for (int a = 0; a < quadrature::NUM_QUADRATURE_POINTS_1D; a++) {
+      double pt[2];
+      quadrature::getQuadraturePoint(a, pt);
+      TacsLagrangeLobattoShapeFuncDerivative<order>(pt[0], &N[order * a],
+                                                    &Nx[order * a]);
+    }
+  }
 };
 
 #endif  // TACS_SHELL_ELEMENT_QUAD_BASIS_H
@@ -13,22 +13,24 @@
 class TACSQuadLinearQuadrature {
  public:
   static const int NUM_QUADRATURE_POINTS = 4;
+  static const int NUM_QUADRATURE_POINTS_1D = 2;
 
-  static int getNumParameters() { return 2; }
-  static int getNumQuadraturePoints() { return 4; }
-  static double getQuadratureWeight(int n) {
+  TACS_HOST_DEVICE static int getNumParameters() { return 2; }
+  TACS_HOST_DEVICE static int getNumQuadraturePoints() { return 4; }
+  TACS_HOST_DEVICE static double getQuadratureWeight(int n) {
     return TacsGaussQuadWts2[n % 2] * TacsGaussQuadWts2[n / 2];
   }
-  static double getQuadraturePoint(int n, double pt[]) {
+  TACS_HOST_DEVICE static double getQuadraturePoint(int n, double pt[]) {
     pt[0] = TacsGaussQuadPts2[n % 2];
     pt[1] = TacsGaussQuadPts2[n / 2];
 
     return TacsGaussQuadWts2[n % 2] * TacsGaussQuadWts2[n / 2];
   }
-  static int getNumElementFaces() { return 4; }
-  static int getNumFaceQuadraturePoints(int face) { return 2; }
-  static double getFaceQuadraturePoint(int face, int n, double pt[],
-                                       double t[]) {
+  TACS_HOST_DEVICE static int getNumElementFaces() { return 4; }
+  TACS_HOST_DEVICE static int getNumFaceQuadraturePoints(int face) { return 2; }
+  TACS_HOST_DEVICE static double getFaceQuadraturePoint(int face, int n,
+                                                        double pt[],
+                                                        double t[]) {
     if (face / 2 == 0) {
       pt[0] = -1.0 + 2.0 * (face % 2);
       pt[1] = TacsGaussQuadPts2[n];
@@ -59,25 +61,49 @@ class TACSQuadLinearQuadrature {
   }
 };
 
+/**
+  Reduced one-point quadrature for the 4-node quadrilateral
+
+  The face quadrature is the same as for the full 2x2 quadrature. The
+  zero-energy hourglass modes of the one-point rule must be stabilized
+  by the element.
+*/
+class TACSQuadReducedQuadrature : public TACSQuadLinearQuadrature {
+ public:
+  static const int NUM_QUADRATURE_POINTS = 1;
+  static const int NUM_QUADRATURE_POINTS_1D = 1;
+
+  TACS_HOST_DEVICE static int getNumQuadraturePoints() { return 1; }
+  TACS_HOST_DEVICE static double getQuadratureWeight(int n) { return 4.0; }
+  TACS_HOST_DEVICE static double getQuadraturePoint(int n, double pt[]) {
+    pt[0] = 0.0;
+    pt[1] = 0.0;
+
+    return 4.0;
+  }
+};
+
 class TACSQuadQuadraticQuadrature {
  public:
   static const int NUM_QUADRATURE_POINTS = 9;
+  static const int NUM_QUADRATURE_POINTS_1D = 3;
 
-  static int getNumParameters() { return 2; }
-  static int getNumQuadraturePoints() { return 9; }
-  static double getQuadratureWeight(int n) {
+  TACS_HOST_DEVICE static int getNumParameters() { return 2; }
+  TACS_HOST_DEVICE static int getNumQuadraturePoints() { return 9; }
+  TACS_HOST_DEVICE static double getQuadratureWeight(int n) {
     return TacsGaussQuadWts3[n % 3] * TacsGaussQuadWts3[n / 3];
   }
-  static double getQuadraturePoint(int n, double pt[]) {
+  TACS_HOST_DEVICE static double getQuadraturePoint(int n, double pt[]) {
     pt[0] = TacsGaussQuadPts3[n % 3];
     pt[1] = TacsGaussQuadPts3[n / 3];
 
     return TacsGaussQuadWts3[n % 3] * TacsGaussQuadWts3[n / 3];
   }
-  static int getNumElementFaces() { return 4; }
-  static int getNumFaceQuadraturePoints(int face) { return 3; }
-  static double getFaceQuadraturePoint(int face, int n, double pt[],
-                                       double t[]) {
+  TACS_HOST_DEVICE static int getNumElementFaces() { return 4; }
+  TACS_HOST_DEVICE static int getNumFaceQuadraturePoints(int face) { return 3; }
+  TACS_HOST_DEVICE static double getFaceQuadraturePoint(int face, int n,
+                                                        double pt[],
+                                                        double t[]) {
     if (face / 2 == 0) {
       pt[0] = -1.0 + 2.0 * (face % 2);
       pt[1] = TacsGaussQuadPts3[n];
@@ -111,22 +137,24 @@ class TACSQuadQuadraticQuadrature {
 class TACSQuadCubicQuadrature {
  public:
   static const int NUM_QUADRATURE_POINTS = 16;
+  static const int NUM_QUADRATURE_POINTS_1D = 4;
 
-  static int getNumParameters() { return 2; }
-  static int getNumQuadraturePoints() { return 16; }
-  static double getQuadratureWeight(int n) {
+  TACS_HOST_DEVICE static int getNumParameters() { return 2; }
+  TACS_HOST_DEVICE static int getNumQuadraturePoints() { return 16; }
+  TACS_HOST_DEVICE static double getQuadratureWeight(int n) {
     return TacsGaussQuadWts4[n % 4] * TacsGaussQuadWts4[n / 4];
   }
-  static double getQuadraturePoint(int n, double pt[]) {
+  TACS_HOST_DEVICE static double getQuadraturePoint(int n, double pt[]) {
     pt[0] = TacsGaussQuadPts4[n % 4];
     pt[1] = TacsGaussQuadPts4[n / 4];
 
     return TacsGaussQuadWts4[n % 4] * TacsGaussQuadWts4[n / 4];
   }
-  static int getNumElementFaces() { return 4; }
-  static int getNumFaceQuadraturePoints(int face) { return 4; }
-  static double getFaceQuadraturePoint(int face, int n, double pt[],
-                                       double t[]) {
+  TACS_HOST_DEVICE static int getNumElementFaces() { return 4; }
+  TACS_HOST_DEVICE static int getNumFaceQuadraturePoints(int face) { return 4; }
+  TACS_HOST_DEVICE static double getFaceQuadraturePoint(int face, int n,
+                                                        double pt[],
+                                                        double t[]) {
     if (face / 2 == 0) {
       pt[0] = -1.0 + 2.0 * (face % 2);
       pt[1] = TacsGaussQuadPts4[n];
@@ -161,19 +189,22 @@ class TACSTriLinearQuadrature {
  public:
   static const int NUM_QUADRATURE_POINTS = 3;
 
-  static int getNumParameters() { return 2; }
-  static int getNumQuadraturePoints() { return 3; }
-  static double getQuadratureWeight(int n) { return TacsTriangleWts3[n]; }
-  static double getQuadraturePoint(int n, double pt[]) {
+  TACS_HOST_DEVICE static int getNumParameters() { return 2; }
+  TACS_HOST_DEVICE static int getNumQuadraturePoints() { return 3; }
+  TACS_HOST_DEVICE static double getQuadratureWeight(int n) {
+    return TacsTriangleWts3[n];
+  }
+  TACS_HOST_DEVICE static double getQuadraturePoint(int n, double pt[]) {
     pt[0] = TacsTrianglePts3[2 * n];
     pt[1] = TacsTrianglePts3[2 * n + 1];
 
     return TacsTriangleWts3[n];
   }
-  static int getNumElementFaces() { return 3; }
-  static int getNumFaceQuadraturePoints(int face) { return 2; }
-  static double getFaceQuadraturePoint(int face, int n, double pt[],
-                                       double t[]) {
+  TACS_HOST_DEVICE static int getNumElementFaces() { return 3; }
+  TACS_HOST_DEVICE static int getNumFaceQuadraturePoints(int face) { return 2; }
+  TACS_HOST_DEVICE static double getFaceQuadraturePoint(int face, int n,
+                                                        double pt[],
+                                                        double t[]) {
     if (face == 0) {
       t[0] = 1.0;
       t[1] = 0.0;
@@ -207,19 +238,22 @@ class TACSTriQuadraticQuadrature {
  public:
   static const int NUM_QUADRATURE_POINTS = 6;
 
-  static int getNumParameters() { return 2; }
-  static int getNumQuadraturePoints() { return 4; }
-  static double getQuadratureWeight(int n) { return TacsTriangleWts4[n]; }
-  static double getQuadraturePoint(int n, double pt[]) {
+  TACS_HOST_DEVICE static int getNumParameters() { return 2; }
+  TACS_HOST_DEVICE static int getNumQuadraturePoints() { return 4; }
+  TACS_HOST_DEVICE static double getQuadratureWeight(int n) {
+    return TacsTriangleWts4[n];
+  }
+  TACS_HOST_DEVICE static double getQuadraturePoint(int n, double pt[]) {
     pt[0] = TacsTrianglePts4[2 * n];
     pt[1] = TacsTrianglePts4[2 * n + 1];
 
     return TacsTriangleWts4[n];
   }
-  static int getNumElementFaces() { return 3; }
-  static int getNumFaceQuadraturePoints(int face) { return 2; }
-  static double getFaceQuadraturePoint(int face, int n, double pt[],
-                                       double t[]) {
+  TACS_HOST_DEVICE static int getNumElementFaces() { return 3; }
+  TACS_HOST_DEVICE static int getNumFaceQuadraturePoints(int face) { return 2; }
+  TACS_HOST_DEVICE static double getFaceQuadraturePoint(int face, int n,
+                                                        double pt[],
+                                                        double t[]) {
     if (face == 0) {
       t[0] = 1.0;
       t[1] = 0.0;
@@ -111,6 +111,37 @@ class TACSShellTriLinearBasis {
     }
   }
 
+  /**
+    Interpolate the fields and their parametric gradients at all the
+    quadrature points, stored in the same layout as
+    TACSShellQuadBasis::interpAllFieldsGrad
+  */
+  template <class quadrature, int vars_per_node, int m>
+  static void interpAllFieldsGrad(const TacsScalar values[], TacsScalar out[]) {
+    for (int n = 0; n < quadrature::getNumQuadraturePoints(); n++) {
+      double pt[3];
+      quadrature::getQuadraturePoint(n, pt);
+      interpFields<vars_per_node, m>(pt, values, &out[3 * m * n]);
+      interpFieldsGrad<vars_per_node, m>(pt, values, &out[3 * m * n + m]);
+    }
+  }
+
+  template <class quadrature, int vars_per_node, int m>
+  static void addInterpAllFieldsGradTranspose(const TacsScalar in[],
+                                              TacsScalar values[]) {
+    for (int n = 0; n < quadrature::getNumQuadraturePoints(); n++) {
+      double pt[3];
+      quadrature::getQuadraturePoint(n, pt);
+
+      TacsScalar grad[2 * m];
+      for (int k = 0; k < 2 * m; k++) {
+        grad[k] = in[3 * m * n + m + k];
+      }
+      addInterpFieldsTranspose<vars_per_node, m>(pt, &in[3 * m * n], values);
+      addInterpFieldsGradTranspose<vars_per_node, m>(pt, grad, values);
+    }
+  }
+
   /**
     Add the outer-product of the shape functions to the matrix
 
@@ -530,6 +561,37 @@ class TACSShellTriQuadraticBasis {
     }
   }
 
+  /**
+    Interpolate the fields and their parametric gradients at all the
+    quadrature points, stored in the same layout as
+    TACSShellQuadBasis::interpAllFieldsGrad
+  */
+  template <class quadrature, int vars_per_node, int m>
+  static void interpAllFieldsGrad(const TacsScalar values[], TacsScalar out[]) {
+    for (int n = 0; n < quadrature::getNumQuadraturePoints(); n++) {
+      double pt[3];
+      quadrature::getQuadraturePoint(n, pt);
+      interpFields<vars_per_node, m>(pt, values, &out[3 * m * n]);
+      interpFieldsGrad<vars_per_node, m>(pt, values, &out[3 * m * n + m]);
+    }
+  }
+
+  template <class quadrature, int vars_per_node, int m>
+  static void addInterpAllFieldsGradTranspose(const TacsScalar in[],
+                                              TacsScalar values[]) {
+    for (int n = 0; n < quadrature::getNumQuadraturePoints(); n++) {
+      double pt[3];
+      quadrature::getQuadraturePoint(n, pt);
+
+      TacsScalar grad[2 * m];
+      for (int k = 0; k < 2 * m; k++) {
+        grad[k] = in[3 * m * n + m + k];
+      }
+      addInterpFieldsTranspose<vars_per_node, m>(pt, &in[3 * m * n], values);
+      addInterpFieldsGradTranspose<vars_per_node, m>(pt, grad, values);
+    }
+  }
+
   /**
     Add the outer-product of the shape functions to the matrix
 
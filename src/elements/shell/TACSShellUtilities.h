@@ -2,11 +2,13 @@
 #define TACS_SHELL_UTILITIES_H
 
 #include "TACSElementAlgebra.h"
+#include "TACSElementAlgebraBatch.h"
 #include "TACSElementVerification.h"
 #include "TACSShellElementTransform.h"
 
-inline void TacsShellAssembleFrame(const TacsScalar Xxi[], const TacsScalar n[],
-                                   TacsScalar Xd[]) {
+TACS_HOST_DEVICE inline void TacsShellAssembleFrame(const TacsScalar Xxi[],
+                                                    const TacsScalar n[],
+                                                    TacsScalar Xd[]) {
   Xd[0] = Xxi[0];
   Xd[1] = Xxi[1];
   Xd[2] = n[0];
@@ -20,7 +22,8 @@ inline void TacsShellAssembleFrame(const TacsScalar Xxi[], const TacsScalar n[],
   Xd[8] = n[2];
 }
 
-inline void TacsShellAssembleFrame(const TacsScalar nxi[], TacsScalar Xdz[]) {
+TACS_HOST_DEVICE inline void TacsShellAssembleFrame(const TacsScalar nxi[],
+                                                    TacsScalar Xdz[]) {
   Xdz[0] = nxi[0];
   Xdz[1] = nxi[1];
   Xdz[2] = 0.0;
@@ -34,8 +37,10 @@ inline void TacsShellAssembleFrame(const TacsScalar nxi[], TacsScalar Xdz[]) {
   Xdz[8] = 0.0;
 }
 
-inline void TacsShellAssembleFrame(const TacsScalar a[], const TacsScalar b[],
-                                   const TacsScalar c[], TacsScalar Xd[]) {
+TACS_HOST_DEVICE inline void TacsShellAssembleFrame(const TacsScalar a[],
+                                                    const TacsScalar b[],
+                                                    const TacsScalar c[],
+                                                    TacsScalar Xd[]) {
   if (a) {
     Xd[0] = a[0];
     Xd[3] = a[1];
@@ -67,8 +72,9 @@ inline void TacsShellAssembleFrame(const TacsScalar a[], const TacsScalar b[],
   }
 }
 
-inline void TacsShellExtractFrame(const TacsScalar Xd[], TacsScalar Xxi[],
-                                  TacsScalar n[]) {
+TACS_HOST_DEVICE inline void TacsShellExtractFrame(const TacsScalar Xd[],
+                                                   TacsScalar Xxi[],
+                                                   TacsScalar n[]) {
   Xxi[0] = Xd[0];
   Xxi[1] = Xd[1];
   n[0] = Xd[2];
@@ -82,7 +88,8 @@ inline void TacsShellExtractFrame(const TacsScalar Xd[], TacsScalar Xxi[],
   n[2] = Xd[8];
 }
 
-inline void TacsShellExtractFrame(const TacsScalar Xd[], TacsScalar Xxi[]) {
+TACS_HOST_DEVICE inline void TacsShellExtractFrame(const TacsScalar Xd[],
+                                                   TacsScalar Xxi[]) {
   Xxi[0] = Xd[0];
   Xxi[1] = Xd[1];
 
@@ -93,8 +100,8 @@ inline void TacsShellExtractFrame(const TacsScalar Xd[], TacsScalar Xxi[]) {
   Xxi[5] = Xd[7];
 }
 
-inline void TacsShellExtractFrameSens(const TacsScalar d2u0d[],
-                                      TacsScalar d2u0xi[]) {
+TACS_HOST_DEVICE inline void TacsShellExtractFrameSens(const TacsScalar d2u0d[],
+                                                       TacsScalar d2u0xi[]) {
   // Extract the second derivatives
   for (int j = 0; j < 6; j++) {
     int jj = 3 * (j / 2) + (j % 2);
@@ -106,9 +113,10 @@ inline void TacsShellExtractFrameSens(const TacsScalar d2u0d[],
   }
 }
 
-inline void TacsShellExtractFrameSens(const TacsScalar d2u0d[],
-                                      TacsScalar d2u0xi[], TacsScalar d2d0[],
-                                      TacsScalar d2d0u0xi[]) {
+TACS_HOST_DEVICE inline void TacsShellExtractFrameSens(const TacsScalar d2u0d[],
+                                                       TacsScalar d2u0xi[],
+                                                       TacsScalar d2d0[],
+                                                       TacsScalar d2d0u0xi[]) {
   // Extract the second derivatives
   for (int j = 0; j < 6; j++) {
     int jj = 3 * (j / 2) + (j % 2);
@@ -136,9 +144,9 @@ inline void TacsShellExtractFrameSens(const TacsScalar d2u0d[],
   }
 }
 
-inline void TacsShellExtractFrameMixedSens(const TacsScalar d2u0du1d[],
-                                           TacsScalar d2d0xiu0xi[],
-                                           TacsScalar d2d0d0xi[]) {
+TACS_HOST_DEVICE inline void TacsShellExtractFrameMixedSens(
+    const TacsScalar d2u0du1d[], TacsScalar d2d0xiu0xi[],
+    TacsScalar d2d0d0xi[]) {
   // Extract the second derivatives
   for (int j = 0; j < 6; j++) {
     int jj = 3 * (j / 2) + (j % 2);
@@ -164,8 +172,10 @@ inline void TacsShellExtractFrameMixedSens(const TacsScalar d2u0du1d[],
   C = T^{T}*A*B
   dA = T*dC*B^{T}
 */
-inline void mat3x3TransMatMatHessian(const TacsScalar T[], const TacsScalar B[],
-                                     const TacsScalar d2C[], TacsScalar d2A[]) {
+TACS_HOST_DEVICE inline void mat3x3TransMatMatHessian(const TacsScalar T[],
+                                                      const TacsScalar B[],
+                                                      const TacsScalar d2C[],
+                                                      TacsScalar d2A[]) {
   // Compute the second derivatives
   TacsScalar tmp2[81], t1[9], t2[9];
   for (int i = 0; i < 9; i++) {
@@ -187,10 +197,10 @@ inline void mat3x3TransMatMatHessian(const TacsScalar T[], const TacsScalar B[],
   }
 }
 
-inline void mat3x3TransMatMatHessianAdd(const TacsScalar T[],
-                                        const TacsScalar B[],
-                                        const TacsScalar d2C[],
-                                        TacsScalar d2A[]) {
+TACS_HOST_DEVICE inline void mat3x3TransMatMatHessianAdd(const TacsScalar T[],
+                                                         const TacsScalar B[],
+                                                         const TacsScalar d2C[],
+                                                         TacsScalar d2A[]) {
   // Compute the second derivatives
   TacsScalar tmp2[81], t1[9], t2[9];
   for (int i = 0; i < 9; i++) {
@@ -212,11 +222,12 @@ inline void mat3x3TransMatMatHessianAdd(const TacsScalar T[],
   }
 }
 
-inline void mat3x3TransMatMatHessian(const TacsScalar T1[],
-                                     const TacsScalar T2[],
-                                     const TacsScalar B1[],
-                                     const TacsScalar B2[],
-                                     const TacsScalar d2C[], TacsScalar d2A[]) {
+TACS_HOST_DEVICE inline void mat3x3TransMatMatHessian(const TacsScalar T1[],
+                                                      const TacsScalar T2[],
+                                                      const TacsScalar B1[],
+                                                      const TacsScalar B2[],
+                                                      const TacsScalar d2C[],
+                                                      TacsScalar d2A[]) {
   // Compute the second derivatives
   TacsScalar tmp2[81], t1[9], t2[9];
   for (int i = 0; i < 9; i++) {
@@ -238,9 +249,12 @@ inline void mat3x3TransMatMatHessian(const TacsScalar T1[],
   }
 }
 
-inline void mat3x3TransMatMatHessianAdd(
-    const TacsScalar T1[], const TacsScalar T2[], const TacsScalar B1[],
-    const TacsScalar B2[], const TacsScalar d2C[], TacsScalar d2A[]) {
+TACS_HOST_DEVICE inline void mat3x3TransMatMatHessianAdd(const TacsScalar T1[],
+                                                         const TacsScalar T2[],
+                                                         const TacsScalar B1[],
+                                                         const TacsScalar B2[],
+                                                         const TacsScalar d2C[],
+                                                         TacsScalar d2A[]) {
   // Compute the second derivatives
   TacsScalar tmp2[81], t1[9], t2[9];
   for (int i = 0; i < 9; i++) {
@@ -262,7 +276,7 @@ inline void mat3x3TransMatMatHessianAdd(
   }
 }
 
-inline void mat3x3TransMatMatHessianAddSymm(
+TACS_HOST_DEVICE inline void mat3x3TransMatMatHessianAddSymm(
     const TacsScalar T1[], const TacsScalar T2[], const TacsScalar B1[],
     const TacsScalar B2[], const TacsScalar d2C[], TacsScalar d2A[]) {
   // Compute the second derivatives
@@ -299,9 +313,10 @@ inline void mat3x3TransMatMatHessianAddSymm(
   @param fnorm Optional: the norm of the cross-product
 */
 template <class basis>
-void TacsShellComputeNodeNormals(const TacsScalar Xpts[], TacsScalar fn[],
-                                 TacsScalar Xdn[] = NULL,
-                                 TacsScalar fnorm[] = NULL) {
+TACS_HOST_DEVICE void TacsShellComputeNodeNormals(const TacsScalar Xpts[],
+                                                  TacsScalar fn[],
+                                                  TacsScalar Xdn[] = NULL,
+                                                  TacsScalar fnorm[] = NULL) {
   for (int i = 0; i < basis::NUM_NODES; i++) {
     double pt[2];
     basis::getNodePoint(i, pt);
@@ -342,30 +357,23 @@ void TacsShellComputeNodeNormals(const TacsScalar Xpts[], TacsScalar fn[],
 }
 
 /**
-  Compute the displacement gradient of the constant and through-thickness
-  rate of change of the displacements.
+  Compute the transformations between the parametric and the local
+  coordinates at a point. These depend only on the node locations.
 
   @param pt The parametric point
-  @param Xpts The node locations for the element
-  @param vars The element variables
   @param fn The frame normal directions at each node
-  @param d The director field at each node
   @param Xxi The in-plane coordinate derivatives
   @param n0 The interpolated frame normal direction
   @param T The transformation to local coordinates
   @param XdinvT Product of inverse of the Jacobian trans. and T
   @param XdinvzT Product of z-derivative of Jac. trans. inv. and T
-  @param u0x Derivative of the displacement in the local x coordinates
-  @param u1x Derivative of the through-thickness disp. in local x coordinates
+  @return The determinant of the Jacobian transformation
 */
-template <int vars_per_node, class basis>
-TacsScalar TacsShellComputeDispGrad(const double pt[], const TacsScalar Xpts[],
-                                    const TacsScalar vars[],
-                                    const TacsScalar fn[], const TacsScalar d[],
-                                    const TacsScalar Xxi[],
-                                    const TacsScalar n0[], const TacsScalar T[],
-                                    TacsScalar XdinvT[], TacsScalar XdinvzT[],
-                                    TacsScalar u0x[], TacsScalar u1x[]) {
+template <class basis>
+TACS_HOST_DEVICE TacsScalar TacsShellComputeXdinvT(
+    const double pt[], const TacsScalar fn[], const TacsScalar Xxi[],
+    const TacsScalar n0[], const TacsScalar T[], TacsScalar XdinvT[],
+    TacsScalar XdinvzT[]) {
   // Compute n,xi = [dn/dxi1; dn/dxi2]
   TacsScalar nxi[6];
   basis::template interpFieldsGrad<3, 3>(pt, fn, nxi);
@@ -392,6 +400,106 @@ TacsScalar TacsShellComputeDispGrad(const double pt[], const TacsScalar Xpts[],
   // Compute Xdinvz = -Xdinv*Xdz*Xdinv*T
   mat3x3MatMult(negXdinvXdz, XdinvT, XdinvzT);
 
+  return detXd;
+}
+
+/**
+  Compute the hourglass vector for a 4-node quadrilateral shell with
+  one-point quadrature.
+
+  The hourglass vector h = (1, -1, -1, 1) is made orthogonal to the
+  linear fields using gamma = h - (h^{T}*X)*b, where b are the surface
+  gradients of the shape functions at the element center. For a
+  parallelogram, gamma^{T}*u = 4*a for the hourglass mode u = a*xi*eta.
+
+  @param Xpts The node locations
+  @param gamma The hourglass vector
+  @param area The area of the element
+  @param gg The squared norms of the dual basis to the tangent directions
+  @return The sum of the squares of the shape function gradients
+*/
+TACS_HOST_DEVICE inline TacsScalar TacsShellComputeHourglassVector(
+    const TacsScalar Xpts[], TacsScalar gamma[], TacsScalar *area,
+    TacsScalar gg[]) {
+  const double h[] = {1.0, -1.0, -1.0, 1.0};
+  const double Nxi[] = {-0.25, 0.25, -0.25, 0.25};
+  const double Neta[] = {-0.25, -0.25, 0.25, 0.25};
+
+  // Compute the tangent directions at the center and h^{T}*X
+  TacsScalar t1[3], t2[3], hX[3];
+  for (int k = 0; k < 3; k++) {
+    t1[k] = t2[k] = hX[k] = 0.0;
+    for (int i = 0; i < 4; i++) {
+      t1[k] += Nxi[i] * Xpts[3 * i + k];
+      t2[k] += Neta[i] * Xpts[3 * i + k];
+      hX[k] += h[i] * Xpts[3 * i + k];
+    }
+  }
+
+  TacsScalar n[3];
+  crossProduct(t1, t2, n);
+  *area = 4.0 * sqrt(vec3Dot(n, n));
+
+  // Compute the dual basis from the inverse of the surface metric
+  TacsScalar a11 = vec3Dot(t1, t1);
+  TacsScalar a12 = vec3Dot(t1, t2);
+  TacsScalar a22 = vec3Dot(t2, t2);
+  TacsScalar inv = 1.0 / (a11 * a22 - a12 * a12);
+
+  TacsScalar g1[3], g2[3];
+  for (int k = 0; k < 3; k++) {
+    g1[k] = inv * (a22 * t1[k] - a12 * t2[k]);
+    g2[k] = inv * (a11 * t2[k] - a12 * t1[k]);
+  }
+  gg[0] = vec3Dot(g1, g1);
+  gg[1] = vec3Dot(g2, g2);
+
+  TacsScalar bb = 0.0;
+  for (int i = 0; i < 4; i++) {
+    TacsScalar b[3];
+    for (int k = 0; k < 3; k++) {
+      b[k] = Nxi[i] * g1[k] + Neta[i] * g2[k];
+    }
+    gamma[i] = h[i] - vec3Dot(hX, b);
+    bb += vec3Dot(b, b);
+  }
+
+  return bb;
+}
+
+/**
+  Compute the displacement gradient of the constant and through-thickness
+  rate of change of the displacements.
+
+  @param pt The parametric point
+  @param Xpts The node locations for the element
+  @param vars The element variables
+  @param fn The frame normal directions at each node
+  @param d The director field at each node
+  @param Xxi The in-plane coordinate derivatives
+  @param n0 The interpolated frame normal direction
+  @param T The transformation to local coordinates
+  @param XdinvT Product of inverse of the Jacobian trans. and T
+  @param XdinvzT Product of z-derivative of Jac. trans. inv. and T
+  @param u0x Derivative of the displacement in the local x coordinates
+  @param u1x Derivative of the through-thickness disp. in local x coordinates
+*/
+template <int vars_per_node, class basis>
+TACS_HOST_DEVICE TacsScalar TacsShellComputeDispGrad(const double pt[],
+                                                     const TacsScalar Xpts[],
+                                                     const TacsScalar vars[],
+                                                     const TacsScalar fn[],
+                                                     const TacsScalar d[],
+                                                     const TacsScalar Xxi[],
+                                                     const TacsScalar n0[],
+                                                     const TacsScalar T[],
+                                                     TacsScalar XdinvT[],
+                                                     TacsScalar XdinvzT[],
+                                                     TacsScalar u0x[],
+                                                     TacsScalar u1x[]) {
+  TacsScalar detXd =
+      TacsShellComputeXdinvT<basis>(pt, fn, Xxi, n0, T, XdinvT, XdinvzT);
+
   // Compute the director field and the gradient of the director
   // field at the specified point
   TacsScalar d0[3], d0xi[6];
@@ -442,7 +550,7 @@ TacsScalar TacsShellComputeDispGrad(const double pt[], const TacsScalar Xpts[],
   @param u1xd Derivative of u1x
 */
 template <int vars_per_node, class basis>
-TacsScalar TacsShellComputeDispGradDeriv(
+TACS_HOST_DEVICE TacsScalar TacsShellComputeDispGradDeriv(
     const double pt[], const TacsScalar Xpts[], const TacsScalar vars[],
     const TacsScalar fn[], const TacsScalar d[], const TacsScalar Xxi[],
     const TacsScalar n0[], const TacsScalar T[], const TacsScalar varsd[],
@@ -514,6 +622,168 @@ TacsScalar TacsShellComputeDispGradDeriv(
   return detXd;
 }
 
+/**
+  Compute the displacement gradient from the parametric gradient of
+  the displacements and the director field already interpolated to the
+  point
+
+  @param u0xi The parametric gradient of the displacements
+  @param d0 The director field
+  @param d0xi The parametric gradient of the director field
+  @param T The transformation to local coordinates
+  @param XdinvT Product of inverse of the Jacobian trans. and T
+  @param XdinvzT Product of z-derivative of Jac. trans. inv. and T
+  @param u0x Derivative of the displacement in the local x coordinates
+  @param u1x Derivative of the through-thickness disp. in local x coordinates
+*/
+TACS_HOST_DEVICE inline void TacsShellComputeDispGradFromFields(
+    const TacsScalar u0xi[], const TacsScalar d0[], const TacsScalar d0xi[],
+    const TacsScalar T[], const TacsScalar XdinvT[], const TacsScalar XdinvzT[],
+    TacsScalar u0x[], TacsScalar u1x[]) {
+  // Compute the derivative u0,x
+  TacsShellAssembleFrame(u0xi, d0, u0x);  // Use u0x to store [u0,xi; d0]
+
+  // u1x = T^{T}*u1d*XdinvT + T^{T}*u0d*XdinvzT
+  TacsScalar tmp[9];
+  TacsShellAssembleFrame(d0xi, u1x);  // Use u1x to store [d0,xi; 0]
+  mat3x3MatMult(u1x, XdinvT, tmp);
+  mat3x3MatMultAdd(u0x, XdinvzT, tmp);
+  mat3x3TransMatMult(T, tmp, u1x);
+
+  // u0x = T^{T}*u0d*Xdinv*T
+  mat3x3MatMult(u0x, XdinvT, tmp);
+  mat3x3TransMatMult(T, tmp, u0x);
+}
+
+/**
+  Compute the displacement gradient at a batch of points
+
+  This is the batched form of TacsShellComputeDispGradFromFields. The
+  displacements and the director field at each point are stored as
+  the value followed by the parametric gradient (9 entries per point),
+  which is the layout from interpAllFieldsGrad. The transformations T,
+  XdinvT and XdinvzT at each point are stored one after the other,
+  with the given stride between points. The work array must have room
+  for 72*n entries.
+
+  @param n The number of points
+  @param u0q The displacements and their parametric gradient
+  @param d0q The director field and its parametric gradient
+  @param T The transformations, followed by XdinvT and XdinvzT
+  @param tstride The stride between the transformations at each point
+  @param u0x Derivative of the displacement in the local x coordinates
+  @param u1x Derivative of the through-thickness disp. in local x coordinates
+  @param work The work array
+*/
+inline void TacsShellComputeDispGradFromFieldsBatch(
+    const int n, const TacsScalar u0q[], const TacsScalar d0q[],
+    const TacsScalar T[], const int tstride, TacsScalar u0x[],
+    TacsScalar u1x[], TacsScalar work[]) {
+  TacsScalar *Tb = &work[0];
+  TacsScalar *XdinvTb = &work[9 * n];
+  TacsScalar *XdinvzTb = &work[18 * n];
+  TacsScalar *u0d = &work[27 * n];
+  TacsScalar *d0d = &work[36 * n];
+  TacsScalar *tmp = &work[45 * n];
+  TacsScalar *u0xb = &work[54 * n];
+  TacsScalar *u1xb = &work[63 * n];
+
+  // Assemble the frames [u0,xi; d0] and [d0,xi; 0] from the 3x2
+  // parametric gradients at each point
+  for (int p = 0; p < n; p++) {
+    const TacsScalar *u0 = &u0q[9 * p];
+    const TacsScalar *d0 = &d0q[9 * p];
+    for (int i = 0; i < 3; i++) {
+      u0d[(3 * i) * n + p] = u0[3 + 2 * i];
+      u0d[(3 * i + 1) * n + p] = u0[4 + 2 * i];
+      u0d[(3 * i + 2) * n + p] = d0[i];
+
+      d0d[(3 * i) * n + p] = d0[3 + 2 * i];
+      d0d[(3 * i + 1) * n + p] = d0[4 + 2 * i];
+      d0d[(3 * i + 2) * n + p] = 0.0;
+    }
+  }
+  batchPack(n, 27, T, tstride, Tb);
+
+  // u1x = T^{T}*u1d*XdinvT + T^{T}*u0d*XdinvzT
+  mat3x3MatMultBatch(n, d0d, XdinvTb, tmp);
+  mat3x3MatMultAddBatch(n, u0d, XdinvzTb, tmp);
+  mat3x3TransMatMultBatch(n, Tb, tmp, u1xb);
+
+  // u0x = T^{T}*u0d*Xdinv*T
+  mat3x3MatMultBatch(n, u0d, XdinvTb, tmp);
+  mat3x3TransMatMultBatch(n, Tb, tmp, u0xb);
+
+  batchUnpack(n, 9, u0xb, 9, u0x);
+  batchUnpack(n, 9, u1xb, 9, u1x);
+}
+
+/**
+  Compute the displacement gradient using the transformations that
+  were previously computed at the point
+
+  @param pt The parametric point
+  @param vars The element variables
+  @param d The director field at each node
+  @param T The transformation to local coordinates
+  @param XdinvT Product of inverse of the Jacobian trans. and T
+  @param XdinvzT Product of z-derivative of Jac. trans. inv. and T
+  @param u0x Derivative of the displacement in the local x coordinates
+  @param u1x Derivative of the through-thickness disp. in local x coordinates
+*/
+template <int vars_per_node, class basis>
+TACS_HOST_DEVICE void TacsShellInterpDispGrad(
+    const double pt[], const TacsScalar vars[], const TacsScalar d[],
+    const TacsScalar T[], const TacsScalar XdinvT[], const TacsScalar XdinvzT[],
+    TacsScalar u0x[], TacsScalar u1x[]) {
+  // Compute the director field and the gradient of the director
+  // field at the specified point
+  TacsScalar d0[3], d0xi[6];
+  basis::template interpFields<3, 3>(pt, d, d0);
+  basis::template interpFieldsGrad<3, 3>(pt, d, d0xi);
+
+  // Compute the gradient of the displacement solution at the quadrature points
+  TacsScalar u0xi[6];
+  basis::template interpFieldsGrad<vars_per_node, 3>(pt, vars, u0xi);
+
+  TacsShellComputeDispGradFromFields(u0xi, d0, d0xi, T, XdinvT, XdinvzT, u0x,
+                                     u1x);
+}
+
+/**
+  Compute the coefficients of the parametric gradient of the
+  displacements and the director field from the coefficients of u0x
+  and u1x. This is the transpose of TacsShellComputeDispGradFromFields.
+
+  @param T The transformation to local coordinates
+  @param XdinvT Product of inverse of the Jacobian trans. and T
+  @param XdinvzT Product of z-derivative of Jac. trans. inv. and T
+  @param du0x Coefficients for u0x
+  @param du1x Coefficients for u1x
+  @param du0xi Coefficients for the parametric gradient of the displacements
+  @param dd0 Coefficients for the director field
+  @param dd0xi Coefficients for the parametric gradient of the director
+*/
+TACS_HOST_DEVICE inline void TacsShellComputeDispGradFromFieldsSens(
+    const TacsScalar T[], const TacsScalar XdinvT[], const TacsScalar XdinvzT[],
+    const TacsScalar du0x[], const TacsScalar du1x[], TacsScalar du0xi[],
+    TacsScalar dd0[], TacsScalar dd0xi[]) {
+  // Compute du0d = T*du0x*XdinvT^{T} + T*du1x*XdinvzT^{T}
+  TacsScalar du0d[9], tmp[9];
+  mat3x3MatTransMult(du1x, XdinvzT, tmp);
+  mat3x3MatTransMultAdd(du0x, XdinvT, tmp);
+  mat3x3MatMult(T, tmp, du0d);
+
+  // Compute du1d = T*du1x*XdinvT^{T}
+  TacsScalar du1d[9];
+  mat3x3MatTransMult(du1x, XdinvT, tmp);
+  mat3x3MatMult(T, tmp, du1d);
+
+  // du0d = [du0xi; dd0]
+  TacsShellExtractFrame(du0d, du0xi, dd0);
+  TacsShellExtractFrame(du1d, dd0xi);
+}
+
 /**
   Add/accumulate the contributions to the residual from the coefficients
   of u0x, u1x and Ct
@@ -528,11 +798,14 @@ TacsScalar TacsShellComputeDispGradDeriv(
   @param dd Residual intermediate for the director field
 */
 template <int vars_per_node, class basis>
-void TacsShellAddDispGradSens(const double pt[], const TacsScalar T[],
-                              const TacsScalar XdinvT[],
-                              const TacsScalar XdinvzT[],
-                              const TacsScalar du0x[], const TacsScalar du1x[],
-                              TacsScalar res[], TacsScalar dd[]) {
+TACS_HOST_DEVICE void TacsShellAddDispGradSens(const double pt[],
+                                               const TacsScalar T[],
+                                               const TacsScalar XdinvT[],
+                                               const TacsScalar XdinvzT[],
+                                               const TacsScalar du0x[],
+                                               const TacsScalar du1x[],
+                                               TacsScalar res[],
+                                               TacsScalar dd[]) {
   // Compute du0d = T*du0x*XdinvT^{T} + T*du1x*XdinvzT^{T}
   TacsScalar du0d[9], tmp[9];
   mat3x3MatTransMult(du1x, XdinvzT, tmp);
@@ -580,13 +853,16 @@ void TacsShellAddDispGradSens(const double pt[], const TacsScalar T[],
   @param d2du The mixed Jacobian matrix intermediate for displacements/d
 */
 template <int vars_per_node, class basis>
-void TacsShellAddDispGradHessian(const double pt[], const TacsScalar T[],
-                                 const TacsScalar XdinvT[],
-                                 const TacsScalar XdinvzT[],
-                                 const TacsScalar d2u0x[],
-                                 const TacsScalar d2u1x[],
-                                 const TacsScalar d2u0xu1x[], TacsScalar mat[],
-                                 TacsScalar d2d[], TacsScalar d2du[]) {
+TACS_HOST_DEVICE void TacsShellAddDispGradHessian(const double pt[],
+                                                  const TacsScalar T[],
+                                                  const TacsScalar XdinvT[],
+                                                  const TacsScalar XdinvzT[],
+                                                  const TacsScalar d2u0x[],
+                                                  const TacsScalar d2u1x[],
+                                                  const TacsScalar d2u0xu1x[],
+                                                  TacsScalar mat[],
+                                                  TacsScalar d2d[],
+                                                  TacsScalar d2du[]) {
   // d2u0d = d2u0x*[d(u0x)/d(u0d)]^2 +
   //         d2u1x*[d(u1x)/d(u0d)]^2 +
   //         d2u0xu1x*[d(u0x)/d(u0d)*d(u1x)/d(u0x)]
@@ -634,34 +910,28 @@ void TacsShellAddDispGradHessian(const double pt[], const TacsScalar T[],
 }
 
 /**
-  Compute the drilling strain penalty at each node
+  Compute the drilling strain penalty at each node given the
+  transformation at each node
 
-  @param transform Transformation object
   @param Xdn The frame derivatives at each node
   @param fn The frame normals at each node
   @param vars The state variable values
-  @param XdinvTn Computed inverse frame times transformation at each node
   @param Tn The transformation at each node
+  @param XdinvTn Computed inverse frame times transformation at each node
   @param u0xn The derivative of the displacements at each node
   @param Ctn The rotation matrix at each node
   @param etn The drill strain penalty value at each node
 */
 template <int vars_per_node, int offset, class basis, class director,
           class model>
-void TacsShellComputeDrillStrain(TACSShellTransform *transform,
-                                 const TacsScalar Xdn[], const TacsScalar fn[],
-                                 const TacsScalar vars[], TacsScalar XdinvTn[],
-                                 TacsScalar Tn[], TacsScalar u0xn[],
-                                 TacsScalar Ctn[], TacsScalar etn[]) {
+TACS_HOST_DEVICE void TacsShellComputeDrillStrain(
+    const TacsScalar Xdn[], const TacsScalar fn[], const TacsScalar vars[],
+    const TacsScalar Tn[], TacsScalar XdinvTn[], TacsScalar u0xn[],
+    TacsScalar Ctn[], TacsScalar etn[]) {
   for (int i = 0; i < basis::NUM_NODES; i++) {
     double pt[2];
     basis::getNodePoint(i, pt);
 
-    // Compute the transformation at the node
-    TacsScalar Xxi[6];
-    TacsShellExtractFrame(&Xdn[9 * i], Xxi);
-    transform->computeTransform(Xxi, &fn[3 * i], &Tn[9 * i]);
-
     // Compute the field gradient at the node
     TacsScalar u0xi[6];
     basis::template interpFieldsGrad<vars_per_node, 3>(pt, vars, u0xi);
@@ -692,6 +962,37 @@ void TacsShellComputeDrillStrain(TACSShellTransform *transform,
   }
 }
 
+/**
+  Compute the drilling strain penalty at each node
+
+  @param transform Transformation object
+  @param Xdn The frame derivatives at each node
+  @param fn The frame normals at each node
+  @param vars The state variable values
+  @param XdinvTn Computed inverse frame times transformation at each node
+  @param Tn The transformation at each node
+  @param u0xn The derivative of the displacements at each node
+  @param Ctn The rotation matrix at each node
+  @param etn The drill strain penalty value at each node
+*/
+template <int vars_per_node, int offset, class basis, class director,
+          class model>
+void TacsShellComputeDrillStrain(TACSShellTransform *transform,
+                                 const TacsScalar Xdn[], const TacsScalar fn[],
+                                 const TacsScalar vars[], TacsScalar XdinvTn[],
+                                 TacsScalar Tn[], TacsScalar u0xn[],
+                                 TacsScalar Ctn[], TacsScalar etn[]) {
+  // Compute the transformation at each node
+  for (int i = 0; i < basis::NUM_NODES; i++) {
+    TacsScalar Xxi[6];
+    TacsShellExtractFrame(&Xdn[9 * i], Xxi);
+    transform->computeTransform(Xxi, &fn[3 * i], &Tn[9 * i]);
+  }
+
+  TacsShellComputeDrillStrain<vars_per_node, offset, basis, director, model>(
+      Xdn, fn, vars, Tn, XdinvTn, u0xn, Ctn, etn);
+}
+
 /**
   Compute the drilling strain penalty at each node
 
@@ -779,12 +1080,15 @@ void TacsShellComputeDrillStrainDeriv(
 */
 template <int vars_per_node, int offset, class basis, class director,
           class model>
-void TacsShellAddDrillStrainSens(const TacsScalar Xdn[], const TacsScalar fn[],
-                                 const TacsScalar vars[],
-                                 const TacsScalar XdinvTn[],
-                                 const TacsScalar Tn[], const TacsScalar u0xn[],
-                                 const TacsScalar Ctn[],
-                                 const TacsScalar detn[], TacsScalar res[]) {
+TACS_HOST_DEVICE void TacsShellAddDrillStrainSens(const TacsScalar Xdn[],
+                                                  const TacsScalar fn[],
+                                                  const TacsScalar vars[],
+                                                  const TacsScalar XdinvTn[],
+                                                  const TacsScalar Tn[],
+                                                  const TacsScalar u0xn[],
+                                                  const TacsScalar Ctn[],
+                                                  const TacsScalar detn[],
+                                                  TacsScalar res[]) {
   for (int i = 0; i < basis::NUM_NODES; i++) {
     double pt[2];
     basis::getNodePoint(i, pt);
@@ -821,6 +1125,7 @@ void TacsShellAddDrillStrainSens(const TacsScalar Xdn[], const TacsScalar fn[],
   Add the first and second derivatives of the drilling strain penalty
   to the residual and Jacobian matrix
 
+  @param alpha The coefficient for the Jacobian w.r.t. the states
   @param Xdn The frame derivatives at each node
   @param fn The frame normals at each node
   @param vars The state variable values
@@ -836,11 +1141,18 @@ void TacsShellAddDrillStrainSens(const TacsScalar Xdn[], const TacsScalar fn[],
 */
 template <int vars_per_node, int offset, class basis, class director,
           class model>
-void TacsShellAddDrillStrainHessian(
-    const TacsScalar Xdn[], const TacsScalar fn[], const TacsScalar vars[],
-    const TacsScalar XdinvTn[], const TacsScalar Tn[], const TacsScalar u0xn[],
-    const TacsScalar Ctn[], const TacsScalar detn[], const TacsScalar d2etn[],
-    TacsScalar res[], TacsScalar mat[]) {
+TACS_HOST_DEVICE void TacsShellAddDrillStrainHessian(const TacsScalar alpha,
+                                                     const TacsScalar Xdn[],
+                                                     const TacsScalar fn[],
+                                                     const TacsScalar vars[],
+                                                     const TacsScalar XdinvTn[],
+                                                     const TacsScalar Tn[],
+                                                     const TacsScalar u0xn[],
+                                                     const TacsScalar Ctn[],
+                                                     const TacsScalar detn[],
+                                                     const TacsScalar d2etn[],
+                                                     TacsScalar res[],
+                                                     TacsScalar mat[]) {
   // Zero the derivative of the rotation
   const int size = vars_per_node * basis::NUM_NODES;
   const int num_nodes = basis::NUM_NODES;
@@ -906,10 +1218,14 @@ void TacsShellAddDrillStrainHessian(
       }
     }
 
+    // Skip the rows that are identically zero, which includes the
+    // entries for the constraint multipliers of the director
     const TacsScalar *t2 = &drot[i * size];
     for (int ii = 0; ii < size; ii++) {
-      for (int jj = 0; jj < size; jj++) {
-        mat[ii * size + jj] += t[ii] * t2[jj];
+      if (t[ii] != 0.0) {
+        for (int jj = 0; jj < size; jj++) {
+          mat[ii * size + jj] += t[ii] * t2[jj];
+        }
       }
     }
   }
@@ -920,8 +1236,8 @@ void TacsShellAddDrillStrainHessian(
     basis::getNodePoint(i, pt);
 
     TacsScalar d2u0x[81], d2Ct[81], d2Ctu0x[81];
-    director::evalDrillStrainHessian(detn[i], &u0xn[9 * i], &Ctn[9 * i], d2u0x,
-                                     d2Ct, d2Ctu0x);
+    director::evalDrillStrainHessian(alpha * detn[i], &u0xn[9 * i],
+                                     &Ctn[9 * i], d2u0x, d2Ct, d2Ctu0x);
 
     // Compute the second derivative w.r.t. u0d
     TacsScalar d2u0d[81];
@@ -933,6 +1249,7 @@ void TacsShellAddDrillStrainHessian(
 
     // d2C0u0d = Ctu0x*[d(u0x)/d(u0d)]*[d(Ct)/d(Cpt)]
     TacsScalar d2Cptu0d[81];
+    memset(d2Cptu0d, 0, 81 * sizeof(TacsScalar));
     mat3x3TransMatMatHessianAdd(&Tn[9 * i], &Tn[9 * i], &XdinvTn[9 * i],
                                 &Tn[9 * i], d2Ctu0x, d2Cptu0d);
 
@@ -942,6 +1259,61 @@ void TacsShellAddDrillStrainHessian(
 
     basis::template addInterpGradOuterProduct<vars_per_node, vars_per_node, 3,
                                               3>(pt, d2u0xi, mat);
+
+    // Add the second derivatives of the rotation matrix w.r.t. the
+    // rotation parameters at this node, weighted by dCpt = T*dCt*T^{T}
+    TacsScalar du0x[9], dCt[9], dCpt[9], tmp[9];
+    director::evalDrillStrainSens(alpha * detn[i], &u0xn[9 * i], &Ctn[9 * i],
+                                  du0x, dCt);
+    mat3x3MatMult(&Tn[9 * i], dCt, tmp);
+    mat3x3MatTransMult(tmp, &Tn[9 * i], dCpt);
+
+    TacsScalar jac[vars_per_node * vars_per_node];
+    memset(jac, 0, vars_per_node * vars_per_node * sizeof(TacsScalar));
+    director::template addRotationMatJacobian<vars_per_node, offset, 1>(
+        1.0, &vars[i * vars_per_node], dCpt, d2Cpt, NULL, jac);
+
+    TacsScalar *m = &mat[(size + 1) * vars_per_node * i];
+    for (int ii = 0; ii < vars_per_node; ii++) {
+      for (int jj = 0; jj < vars_per_node; jj++) {
+        m[ii * size + jj] += jac[ii * vars_per_node + jj];
+      }
+    }
+
+    // Add the coupling between the rotation parameters and the in-plane
+    // components of the displacement gradient u0d
+    for (int k = 0; k < 9; k++) {
+      if (k % 3 == 2) {
+        continue;
+      }
+
+      TacsScalar dC[9];
+      for (int j = 0; j < 9; j++) {
+        dC[j] = d2Cptu0d[9 * j + k];
+      }
+
+      TacsScalar w[size], g[size];
+      memset(w, 0, size * sizeof(TacsScalar));
+      memset(g, 0, size * sizeof(TacsScalar));
+      director::template addRotationMatResidual<vars_per_node, offset, 1>(
+          &vars[i * vars_per_node], dC, &w[i * vars_per_node]);
+
+      TacsScalar du0d[9], du0xi[6];
+      memset(du0d, 0, 9 * sizeof(TacsScalar));
+      du0d[k] = 1.0;
+      TacsShellExtractFrame(du0d, du0xi);
+      basis::template addInterpFieldsGradTranspose<vars_per_node, 3>(pt, du0xi,
+                                                                     g);
+
+      for (int ii = 0; ii < size; ii++) {
+        if (w[ii] != 0.0) {
+          for (int jj = 0; jj < size; jj++) {
+            mat[ii * size + jj] += w[ii] * g[jj];
+            mat[jj * size + ii] += g[jj] * w[ii];
+          }
+        }
+      }
+    }
   }
 }
 
@@ -959,12 +1331,10 @@ void TacsShellAddDrillStrainHessian(
   @param d2etyd The second derivative of the tying strain and the director
 */
 template <class basis>
-void TacsShellAddTyingDispCoupling(const double pt[], const TacsScalar T[],
-                                   const TacsScalar XdinvT[],
-                                   const TacsScalar XdinvzT[],
-                                   const TacsScalar d2e0tyu0x[],
-                                   const TacsScalar d2e0tyu1x[],
-                                   TacsScalar d2etyu[], TacsScalar d2etyd[]) {
+TACS_HOST_DEVICE void TacsShellAddTyingDispCoupling(
+    const double pt[], const TacsScalar T[], const TacsScalar XdinvT[],
+    const TacsScalar XdinvzT[], const TacsScalar d2e0tyu0x[],
+    const TacsScalar d2e0tyu1x[], TacsScalar d2etyu[], TacsScalar d2etyd[]) {
   const int usize = 3 * basis::NUM_NODES;
   const int dsize = 3 * basis::NUM_NODES;
 
@@ -124,6 +124,19 @@ class TACSThermalShellElement : public TACSElement {
                         const TacsScalar ddvars[], int dvLen,
                         TacsScalar dfdx[]);
 
+  // The node location derivatives use the finite-difference default, so
+  // each perturbed residual is shared between all the adjoints
+  void addAdjResXptProductMulti(int elemIndex, double time, TacsScalar scale,
+                                int numAdjoints, const TacsScalar psi[],
+                                const TacsScalar Xpts[],
+                                const TacsScalar vars[],
+                                const TacsScalar dvars[],
+                                const TacsScalar ddvars[],
+                                TacsScalar fXptSens[]) {
+    addAdjResXptProductFD(elemIndex, time, scale, numAdjoints, psi, Xpts, vars,
+                          dvars, ddvars, fXptSens);
+  }
+
   int evalPointQuantity(int elemIndex, int quantityType, double time, int n,
                         double pt[], const TacsScalar Xpts[],
                         const TacsScalar vars[], const TacsScalar dvars[],
@@ -732,7 +745,7 @@ void TACSThermalShellElement<quadrature, basis, director, model>::addJacobian(
 
   // Add the contribution to the residual from the drill strain
   TacsShellAddDrillStrainHessian<vars_per_node, offset, basis, director, model>(
-      Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, d2etn, res, mat);
+      alpha, Xdn, fn, vars, XdinvTn, Tn, u0xn, Ctn, detn, d2etn, res, mat);
 
   // Add the residual from the tying strain
   model::template addComputeTyingStrainTranspose<vars_per_node, basis>(
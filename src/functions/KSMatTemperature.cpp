@@ -89,6 +89,7 @@ const char *TACSKSMatTemperature::functionName() { return funcName; }
 void TACSKSMatTemperature::setKSDispType(
     TACSKSTemperature::KSTemperatureType _ksType) {
   ksType = _ksType;
+  clearCachedValue();
 }
 
 /*
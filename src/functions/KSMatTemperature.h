@@ -42,7 +42,10 @@ class TACSKSMatTemperature : public TACSFunction {
   // Set the type of displacement aggregate
   // --------------------------------------
   void setKSDispType(TACSKSTemperature::KSTemperatureType _ksType);
-  void setNumMats(int _nmats) { nmats = _nmats; }
+  void setNumMats(int _nmats) {
+    nmats = _nmats;
+    clearCachedValue();
+  }
 
   // Collective calls on the TACS MPI Comm
   // -------------------------------------
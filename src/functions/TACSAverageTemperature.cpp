@@ -69,10 +69,39 @@ void TACSAverageTemperature::finalEvaluation(EvaluationType ftype) {
 /*
   Evaluate the temperature contributed by this element
 */
-void TACSAverageTemperature::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSAverageTemperature::elementWiseEval(EvaluationType ftype,
+                                             int elemIndex,
+                                             TACSElement *element, double time,
+                                             TacsScalar scale,
+                                             const TacsScalar Xpts[],
+                                             const TacsScalar vars[],
+                                             const TacsScalar dvars[],
+                                             const TacsScalar ddvars[]) {
+  elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                        dvars, ddvars, &integral_temp);
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSAverageTemperature::getNumThreadValues(EvaluationType ftype) {
+  return 1;
+}
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSAverageTemperature::elementWiseEvalThread(EvaluationType ftype,
+                                                   int elemIndex,
+                                                   TACSElement *element,
+                                                   double time,
+                                                   TacsScalar scale,
+                                                   const TacsScalar Xpts[],
+                                                   const TacsScalar vars[],
+                                                   const TacsScalar dvars[],
+                                                   const TacsScalar ddvars[],
+                                                   TacsScalar vals[]) {
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -83,11 +112,19 @@ void TACSAverageTemperature::elementWiseEval(
         element->evalPointQuantity(elemIndex, TACS_TEMPERATURE, time, i, pt,
                                    Xpts, vars, dvars, ddvars, &detXd, &temp);
     if (count >= 1) {
-      integral_temp += scale * detXd * weight * temp;
+      vals[0] += scale * detXd * weight * temp;
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSAverageTemperature::addThreadValues(EvaluationType ftype,
+                                             const TacsScalar vals[]) {
+  integral_temp += vals[0];
+}
+
 /*
   These functions are used to determine the sensitivity of the
   function to the state variables.
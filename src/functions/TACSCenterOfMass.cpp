@@ -76,10 +76,38 @@ void TACSCenterOfMass::finalEvaluation(EvaluationType ftype) {
 /*
   Perform the element-wise evaluation of the TACSKSFailure function.
 */
-void TACSCenterOfMass::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSCenterOfMass::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                       TACSElement *element, double time,
+                                       TacsScalar scale,
+                                       const TacsScalar Xpts[],
+                                       const TacsScalar vars[],
+                                       const TacsScalar dvars[],
+                                       const TacsScalar ddvars[]) {
+  TacsScalar vals[2] = {totalMass, massMoment};
+  elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                        dvars, ddvars, vals);
+  totalMass = vals[0];
+  massMoment = vals[1];
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSCenterOfMass::getNumThreadValues(EvaluationType ftype) { return 2; }
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSCenterOfMass::elementWiseEvalThread(EvaluationType ftype,
+                                             int elemIndex,
+                                             TACSElement *element, double time,
+                                             TacsScalar scale,
+                                             const TacsScalar Xpts[],
+                                             const TacsScalar vars[],
+                                             const TacsScalar dvars[],
+                                             const TacsScalar ddvars[],
+                                             TacsScalar vals[]) {
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -92,7 +120,7 @@ void TACSCenterOfMass::elementWiseEval(
                                    Xpts, vars, dvars, ddvars, &detXd, &density);
 
     if (count >= 1) {
-      totalMass += scale * weight * detXd * density;
+      vals[0] += scale * weight * detXd * density;
     }
     TacsScalar densityMoment[3];
     count = element->evalPointQuantity(elemIndex, TACS_ELEMENT_DENSITY_MOMENT,
@@ -100,11 +128,20 @@ void TACSCenterOfMass::elementWiseEval(
                                        &detXd, densityMoment);
 
     for (int j = 0; j < count; j++) {
-      massMoment += scale * weight * detXd * densityMoment[j] * dir[j];
+      vals[1] += scale * weight * detXd * densityMoment[j] * dir[j];
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSCenterOfMass::addThreadValues(EvaluationType ftype,
+                                       const TacsScalar vals[]) {
+  totalMass += vals[0];
+  massMoment += vals[1];
+}
+
 /*
   Determine the derivative of the mass w.r.t. the material
   design variables
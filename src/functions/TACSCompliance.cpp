@@ -41,6 +41,7 @@ const char *TACSCompliance::getObjectName() { return funcName; }
 */
 void TACSCompliance::setComplianceType(int _compliance_type) {
   compliance_type = _compliance_type;
+  clearCachedValue();
 }
 
 /*
@@ -72,6 +73,27 @@ void TACSCompliance::elementWiseEval(EvaluationType ftype, int elemIndex,
                                      const TacsScalar vars[],
                                      const TacsScalar dvars[],
                                      const TacsScalar ddvars[]) {
+  elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                        dvars, ddvars, &compliance);
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSCompliance::getNumThreadValues(EvaluationType ftype) { return 1; }
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSCompliance::elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                                           TACSElement *element, double time,
+                                           TacsScalar scale,
+                                           const TacsScalar Xpts[],
+                                           const TacsScalar vars[],
+                                           const TacsScalar dvars[],
+                                           const TacsScalar ddvars[],
+                                           TacsScalar vals[]) {
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -83,11 +105,19 @@ void TACSCompliance::elementWiseEval(EvaluationType ftype, int elemIndex,
                                    Xpts, vars, dvars, ddvars, &detXd, &U0);
 
     if (count >= 1) {
-      compliance += scale * detXd * weight * U0;
+      vals[0] += scale * detXd * weight * U0;
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSCompliance::addThreadValues(EvaluationType ftype,
+                                     const TacsScalar vals[]) {
+  compliance += vals[0];
+}
+
 /*
   These functions are used to determine the sensitivity of the
   function to the state variables.
@@ -64,10 +64,35 @@ void TACSEnclosedVolume::finalEvaluation(EvaluationType ftype) {
 /*
   Perform the element-wise evaluation of the TACSKSFailure function.
 */
-void TACSEnclosedVolume::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSEnclosedVolume::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                         TACSElement *element, double time,
+                                         TacsScalar scale,
+                                         const TacsScalar Xpts[],
+                                         const TacsScalar vars[],
+                                         const TacsScalar dvars[],
+                                         const TacsScalar ddvars[]) {
+  elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                        dvars, ddvars, &totalVol);
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSEnclosedVolume::getNumThreadValues(EvaluationType ftype) { return 1; }
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSEnclosedVolume::elementWiseEvalThread(EvaluationType ftype,
+                                               int elemIndex,
+                                               TACSElement *element,
+                                               double time, TacsScalar scale,
+                                               const TacsScalar Xpts[],
+                                               const TacsScalar vars[],
+                                               const TacsScalar dvars[],
+                                               const TacsScalar ddvars[],
+                                               TacsScalar vals[]) {
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -80,11 +105,19 @@ void TACSEnclosedVolume::elementWiseEval(
         ddvars, &detXd, &density);
 
     if (count >= 1) {
-      totalVol += scale * weight * detXd * density;
+      vals[0] += scale * weight * detXd * density;
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSEnclosedVolume::addThreadValues(EvaluationType ftype,
+                                         const TacsScalar vals[]) {
+  totalVol += vals[0];
+}
+
 /*
   Determine the derivative of the volume w.r.t. the material
   design variables
@@ -43,6 +43,13 @@ class TACSEnclosedVolume : public TACSFunction {
                        TACSElement *element, double time, TacsScalar scale,
                        const TacsScalar Xpts[], const TacsScalar vars[],
                        const TacsScalar dvars[], const TacsScalar ddvars[]);
+  int getNumThreadValues(EvaluationType ftype);
+  void elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                             TACSElement *element, double time,
+                             TacsScalar scale, const TacsScalar Xpts[],
+                             const TacsScalar vars[], const TacsScalar dvars[],
+                             const TacsScalar ddvars[], TacsScalar vals[]);
+  void addThreadValues(EvaluationType ftype, const TacsScalar vals[]);
   void finalEvaluation(EvaluationType ftype);
 
   /**
@@ -0,0 +1,120 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSFailureCache.h"
+
+/*
+  Allocate storage for each quadrature point of the local elements
+
+  @param assembler The finite-element model
+*/
+TACSFailureCache::TACSFailureCache(TACSAssembler *_assembler) {
+  assembler = _assembler;
+  assembler->incref();
+
+  TACSElement **elements = assembler->getElements();
+  num_elements = assembler->getNumElements();
+  elem_ptr = new int[num_elements + 1];
+  elem_ptr[0] = 0;
+  for (int i = 0; i < num_elements; i++) {
+    elem_ptr[i + 1] = elem_ptr[i] + elements[i]->getNumQuadraturePoints();
+  }
+
+  elem_design_version = new int[num_elements];
+  elem_state_version = new int[num_elements];
+  elem_time = new double[num_elements];
+
+  int size = elem_ptr[num_elements];
+  counts = new int[size];
+  detXd_values = new TacsScalar[size];
+  fail_values = new TacsScalar[size];
+
+  invalidate();
+}
+
+TACSFailureCache::~TACSFailureCache() {
+  assembler->decref();
+  delete[] elem_ptr;
+  delete[] elem_design_version;
+  delete[] elem_state_version;
+  delete[] elem_time;
+  delete[] counts;
+  delete[] detXd_values;
+  delete[] fail_values;
+}
+
+/*
+  Invalidate the stored values so that the next call to evalFailure()
+  re-evaluates the failure index for each element
+*/
+void TACSFailureCache::invalidate() {
+  for (int i = 0; i < num_elements; i++) {
+    elem_design_version[i] = -1;
+    elem_state_version[i] = -1;
+    elem_time[i] = 0.0;
+  }
+}
+
+/*
+  Evaluate the failure index at a quadrature point, or retrieve the
+  stored value if the element has already been evaluated
+
+  Each element is only accessed by one thread at a time during the
+  function evaluation, so the values for an element can be updated
+  without locking.
+
+  The arguments and return value are the same as for
+  TACSElement::evalPointQuantity() with the TACS_FAILURE_INDEX.
+*/
+int TACSFailureCache::evalFailure(int elemIndex, TACSElement *element,
+                                  double time, int n, double pt[],
+                                  const TacsScalar Xpts[],
+                                  const TacsScalar vars[],
+                                  const TacsScalar dvars[],
+                                  const TacsScalar ddvars[], TacsScalar *detXd,
+                                  TacsScalar *fail) {
+  if (elemIndex < 0 || elemIndex >= num_elements || n < 0 ||
+      n >= elem_ptr[elemIndex + 1] - elem_ptr[elemIndex]) {
+    return element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, n,
+                                      pt, Xpts, vars, dvars, ddvars, detXd,
+                                      fail);
+  }
+
+  // Reset the element values if the model has changed
+  int design_version = assembler->getDesignVersion();
+  int state_version = assembler->getStateVersion();
+  const int ptr = elem_ptr[elemIndex];
+  if (elem_design_version[elemIndex] != design_version ||
+      elem_state_version[elemIndex] != state_version ||
+      elem_time[elemIndex] != time) {
+    for (int i = ptr; i < elem_ptr[elemIndex + 1]; i++) {
+      counts[i] = -1;
+    }
+    elem_design_version[elemIndex] = design_version;
+    elem_state_version[elemIndex] = state_version;
+    elem_time[elemIndex] = time;
+  }
+
+  if (counts[ptr + n] < 0) {
+    detXd_values[ptr + n] = 0.0;
+    fail_values[ptr + n] = 0.0;
+    counts[ptr + n] = element->evalPointQuantity(
+        elemIndex, TACS_FAILURE_INDEX, time, n, pt, Xpts, vars, dvars, ddvars,
+        &detXd_values[ptr + n], &fail_values[ptr + n]);
+  }
+
+  *detXd = detXd_values[ptr + n];
+  *fail = fail_values[ptr + n];
+  return counts[ptr + n];
+}
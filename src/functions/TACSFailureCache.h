@@ -0,0 +1,74 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_FAILURE_CACHE_H
+#define TACS_FAILURE_CACHE_H
+
+#include "TACSAssembler.h"
+
+/*
+  Storage for the failure index at each quadrature point of the model
+
+  The failure-based functions evaluate the failure index at every
+  quadrature point in each stage of the function evaluation and again
+  in each of the derivative computations. For elements with expensive
+  failure criteria, such as the blade-stiffened panel buckling and ply
+  failure criteria, this is the dominant cost of the function
+  evaluation. When this object is passed to TACSKSFailure or
+  TACSInducedFailure, the failure index and the determinant of the
+  Jacobian at each point are computed once and re-used by all of the
+  functions that share the object.
+
+  The stored values for an element are re-computed when the design or
+  state versions of TACSAssembler or the time change. The element
+  states passed to evalFailure() must therefore be those set in
+  TACSAssembler. Other changes, for instance to the element data set
+  directly, require a call to invalidate().
+*/
+class TACSFailureCache : public TACSObject {
+ public:
+  TACSFailureCache(TACSAssembler *_assembler);
+  ~TACSFailureCache();
+
+  // Evaluate the failure index at a quadrature point
+  // ------------------------------------------------
+  int evalFailure(int elemIndex, TACSElement *element, double time, int n,
+                  double pt[], const TacsScalar Xpts[], const TacsScalar vars[],
+                  const TacsScalar dvars[], const TacsScalar ddvars[],
+                  TacsScalar *detXd, TacsScalar *fail);
+
+  // Force the re-evaluation of all the values
+  // -----------------------------------------
+  void invalidate();
+
+ private:
+  // The finite-element model
+  TACSAssembler *assembler;
+
+  // Offset to the first quadrature point of each element
+  int num_elements;
+  int *elem_ptr;
+
+  // The versions of the model and the time for the stored element values
+  int *elem_design_version, *elem_state_version;
+  double *elem_time;
+
+  // The number of quantities, the determinant of the Jacobian and the
+  // failure index at each quadrature point. A negative count indicates
+  // that the point has not been evaluated.
+  int *counts;
+  TacsScalar *detXd_values, *fail_values;
+};
+
+#endif  // TACS_FAILURE_CACHE_H
@@ -0,0 +1,504 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSFatigueDamage.h"
+
+#include <stdlib.h>
+
+#include "TACSAssembler.h"
+#include "TACSKSAggregation.h"
+#include "TACSStressMeasures.h"
+
+/*
+  Compare two records by their time, which is the first member of the
+  record
+*/
+static int TacsCompareRecordTimes(const void *a, const void *b) {
+  double ta = *(const double *)a;
+  double tb = *(const double *)b;
+  if (ta < tb) {
+    return -1;
+  } else if (ta > tb) {
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  Create the fatigue damage function
+
+  input:
+  assembler:  the TACSAssembler object
+  ksWeight:   the KS aggregation weight
+  exponent:   the Basquin exponent m
+  refRange:   the stress range with a life of one cycle
+*/
+TACSFatigueDamage::TACSFatigueDamage(TACSAssembler *_assembler,
+                                     double _ksWeight, double _exponent,
+                                     double _refRange)
+    : TACSFunction(_assembler, TACSFunction::ENTIRE_DOMAIN,
+                   TACSFunction::SINGLE_STAGE, 0) {
+  ksWeight = _ksWeight;
+  exponent = _exponent;
+  refRange = _refRange;
+  component = -1;
+
+  maxDamage = -1e20;
+  ksSum = 0.0;
+
+  num_elements = 0;
+  point_offset = NULL;
+  states = NULL;
+  elem_records = NULL;
+  dfdd = NULL;
+}
+
+TACSFatigueDamage::~TACSFatigueDamage() { clearData(); }
+
+const char *TACSFatigueDamage::funcName = "TACSFatigueDamage";
+
+/*
+  Return the function name
+*/
+const char *TACSFatigueDamage::getObjectName() { return funcName; }
+
+/*
+  Retrieve the KS aggregation weight
+*/
+double TACSFatigueDamage::getParameter() { return ksWeight; }
+
+/*
+  Set the KS aggregation parameter
+*/
+void TACSFatigueDamage::setParameter(double _ksWeight) {
+  ksWeight = _ksWeight;
+  clearCachedValue();
+}
+
+/*
+  Set the stress component used for counting, or -1 for the signed von
+  Mises stress
+*/
+void TACSFatigueDamage::setStressComponent(int _component) {
+  component = _component;
+  clearCachedValue();
+}
+
+/*
+  Retrieve the function value
+*/
+TacsScalar TACSFatigueDamage::getFunctionValue() {
+  return maxDamage + log(ksSum) / ksWeight;
+}
+
+/*
+  Retrieve the maximum damage
+*/
+TacsScalar TACSFatigueDamage::getMaximumDamage() { return maxDamage; }
+
+/*
+  Free the point states and the records
+*/
+void TACSFatigueDamage::clearData() {
+  if (elem_records) {
+    for (int i = 0; i < num_elements; i++) {
+      if (elem_records[i].records) {
+        free(elem_records[i].records);
+      }
+    }
+    delete[] elem_records;
+  }
+  if (point_offset) {
+    delete[] point_offset;
+  }
+  if (states) {
+    delete[] states;
+  }
+  if (dfdd) {
+    delete[] dfdd;
+  }
+  num_elements = 0;
+  point_offset = NULL;
+  states = NULL;
+  elem_records = NULL;
+  dfdd = NULL;
+}
+
+/*
+  Evaluate the stress measure and its derivative w.r.t. the stress
+  components at a quadrature point. Returns the number of stress
+  components, which is zero when the stress is not defined.
+*/
+int TACSFatigueDamage::evalStress(int elemIndex, TACSElement *element,
+                                  double time, int n, double pt[],
+                                  const TacsScalar Xpts[],
+                                  const TacsScalar vars[],
+                                  const TacsScalar dvars[],
+                                  const TacsScalar ddvars[], TacsScalar *detXd,
+                                  TacsScalar *stress, TacsScalar dsdq[]) {
+  TacsScalar s[9];
+  int count =
+      element->evalPointQuantity(elemIndex, TACS_ELEMENT_STRESS, time, n, pt,
+                                 Xpts, vars, dvars, ddvars, detXd, s);
+  if (count < 1 || count > 9 || component >= count) {
+    return 0;
+  }
+
+  if (component >= 0) {
+    for (int i = 0; i < count; i++) {
+      dsdq[i] = 0.0;
+    }
+    dsdq[component] = 1.0;
+    *stress = s[component];
+  } else {
+    *stress = TacsSignedVonMises(count, s, dsdq);
+  }
+
+  return count;
+}
+
+/*
+  Record the derivative of the damage w.r.t. the stress at a reversal
+*/
+void TACSFatigueDamage::addRecord(int elemIndex, int n, const Reversal *rev,
+                                  TacsScalar sens) {
+  // The sensitivity is not required when the step is not weighted
+  if (rev->scale == 0.0) {
+    return;
+  }
+
+  ElementRecords *rec = &elem_records[elemIndex];
+  if (rec->num_records >= rec->max_records) {
+    rec->max_records = 2 * rec->max_records + 8;
+    rec->records =
+        (Record *)realloc(rec->records, rec->max_records * sizeof(Record));
+  }
+  Record *r = &rec->records[rec->num_records];
+  r->time = rev->time;
+  r->point = n;
+  r->sens = sens / rev->scale;
+  rec->num_records++;
+}
+
+/*
+  Count a cycle between two reversals with the given factor (0.5 for a
+  half cycle) and record the sensitivity of its damage
+*/
+void TACSFatigueDamage::addCycle(int elemIndex, int n, PointState *state,
+                                 const Reversal *a, const Reversal *b,
+                                 double factor) {
+  TacsScalar range = a->value - b->value;
+  double sign = (TacsRealPart(range) < 0.0 ? -1.0 : 1.0);
+  range *= sign;
+  if (TacsRealPart(range) <= 0.0) {
+    return;
+  }
+
+  TacsScalar x = range / refRange;
+  state->damage += factor * pow(x, exponent);
+
+  // The derivative of the damage w.r.t. the range
+  TacsScalar dd = factor * exponent * pow(x, exponent - 1.0) / refRange;
+  addRecord(elemIndex, n, a, sign * dd);
+  addRecord(elemIndex, n, b, -sign * dd);
+}
+
+/*
+  Add a reversal to the stack at a point and count the closed cycles
+  with the rainflow rule
+*/
+void TACSFatigueDamage::addReversal(int elemIndex, int n, PointState *state,
+                                    const Reversal *rev) {
+  Reversal *S = state->reversals;
+
+  // Count the oldest reversal as a half cycle when the stack is full
+  if (state->num_reversals == MAX_REVERSALS) {
+    addCycle(elemIndex, n, state, &S[0], &S[1], 0.5);
+    for (int i = 1; i < MAX_REVERSALS; i++) {
+      S[i - 1] = S[i];
+    }
+    state->num_reversals--;
+  }
+  S[state->num_reversals] = *rev;
+  state->num_reversals++;
+
+  while (state->num_reversals >= 3) {
+    int k = state->num_reversals;
+    double X = fabs(TacsRealPart(S[k - 1].value - S[k - 2].value));
+    double Y = fabs(TacsRealPart(S[k - 2].value - S[k - 3].value));
+    if (X < Y) {
+      break;
+    }
+
+    if (k == 3) {
+      // The range contains the starting point: count a half cycle and
+      // discard the starting point
+      addCycle(elemIndex, n, state, &S[0], &S[1], 0.5);
+      S[0] = S[1];
+      S[1] = S[2];
+      state->num_reversals = 2;
+    } else {
+      // Count a full cycle and discard both of its reversals
+      addCycle(elemIndex, n, state, &S[k - 3], &S[k - 2], 1.0);
+      S[k - 3] = S[k - 1];
+      state->num_reversals -= 2;
+    }
+  }
+}
+
+/*
+  Initialize the point states for the integration over the history
+*/
+void TACSFatigueDamage::initEvaluation(EvaluationType ftype) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    maxDamage = -1e20;
+    ksSum = 0.0;
+
+    clearData();
+    num_elements = assembler->getNumElements();
+    TACSElement **elements = assembler->getElements();
+    point_offset = new int[num_elements + 1];
+    point_offset[0] = 0;
+    for (int i = 0; i < num_elements; i++) {
+      point_offset[i + 1] =
+          point_offset[i] + elements[i]->getNumQuadraturePoints();
+    }
+
+    int num_points = point_offset[num_elements];
+    states = new PointState[num_points];
+    memset(states, 0, num_points * sizeof(PointState));
+    dfdd = new TacsScalar[num_points];
+    memset(dfdd, 0, num_points * sizeof(TacsScalar));
+    elem_records = new ElementRecords[num_elements];
+    memset(elem_records, 0, num_elements * sizeof(ElementRecords));
+  }
+}
+
+/*
+  Add the sample of the stress at each quadrature point at this time
+  and count the reversals detected from the previous sample
+*/
+void TACSFatigueDamage::elementWiseEval(
+    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
+    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+  if (ftype != TACSFunction::INTEGRATE || !states) {
+    return;
+  }
+
+  int num_points = point_offset[elemIndex + 1] - point_offset[elemIndex];
+  for (int i = 0; i < num_points; i++) {
+    double pt[3];
+    double weight = element->getQuadraturePoint(i, pt);
+
+    TacsScalar stress = 0.0, detXd = 0.0, dsdq[9];
+    int count = evalStress(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                           ddvars, &detXd, &stress, dsdq);
+    if (count < 1) {
+      continue;
+    }
+
+    PointState *state = &states[point_offset[elemIndex] + i];
+    state->active = 1;
+    state->weight = weight * detXd;
+
+    Reversal sample;
+    sample.value = stress;
+    sample.time = time;
+    sample.scale = TacsRealPart(scale);
+
+    if (state->num_samples == 0) {
+      // The starting point is always a reversal
+      addReversal(elemIndex, i, state, &sample);
+    } else {
+      double diff = TacsRealPart(stress - state->last.value);
+      int dir = (diff > 0.0 ? 1 : (diff < 0.0 ? -1 : 0));
+      if (dir != 0) {
+        // The last sample is a reversal when the direction changes
+        if (state->dir != 0 && dir != state->dir) {
+          addReversal(elemIndex, i, state, &state->last);
+        }
+        state->dir = dir;
+      }
+    }
+    state->last = sample;
+    state->num_samples++;
+  }
+}
+
+/*
+  Count the residual reversals as half cycles, aggregate the damage
+  and prepare the records for the reverse sweep
+*/
+void TACSFatigueDamage::finalEvaluation(EvaluationType ftype) {
+  if (ftype != TACSFunction::INTEGRATE || !states) {
+    return;
+  }
+
+  TacsScalar vals[2];
+  TacsKSInitValues(vals);
+  for (int elem = 0; elem < num_elements; elem++) {
+    for (int p = point_offset[elem]; p < point_offset[elem + 1]; p++) {
+      PointState *state = &states[p];
+      if (!state->active) {
+        continue;
+      }
+      int n = p - point_offset[elem];
+
+      // The final sample is the last reversal
+      if (state->num_samples > 1) {
+        addReversal(elem, n, state, &state->last);
+      }
+      for (int i = 0; i < state->num_reversals - 1; i++) {
+        addCycle(elem, n, state, &state->reversals[i],
+                 &state->reversals[i + 1], 0.5);
+      }
+      state->num_reversals = 0;
+
+      TacsKSAddValue(ksWeight, 0, state->damage, state->weight, vals);
+    }
+  }
+
+  TacsKSAllreduceValues(assembler->getMPIComm(), ksWeight, 0, vals);
+  maxDamage = vals[0];
+  ksSum = vals[1];
+
+  // Compute the derivative of the function w.r.t. the damage at each
+  // point, and discard the records of the points that do not
+  // contribute to the function
+  for (int elem = 0; elem < num_elements; elem++) {
+    for (int p = point_offset[elem]; p < point_offset[elem + 1]; p++) {
+      PointState *state = &states[p];
+      dfdd[p] = 0.0;
+      if (state->active) {
+        dfdd[p] = state->weight * exp(ksWeight * (state->damage - maxDamage)) /
+                  ksSum;
+      }
+    }
+
+    ElementRecords *rec = &elem_records[elem];
+    int num = 0;
+    for (int i = 0; i < rec->num_records; i++) {
+      int p = point_offset[elem] + rec->records[i].point;
+      if (fabs(TacsRealPart(dfdd[p])) > 1e-16) {
+        rec->records[num] = rec->records[i];
+        num++;
+      }
+    }
+    rec->num_records = num;
+    if (num > 0) {
+      qsort(rec->records, num, sizeof(Record), TacsCompareRecordTimes);
+    }
+  }
+}
+
+/*
+  Get the records of an element at the given time
+
+  The records are sorted by time, so the first record at this time is
+  found by bisection.
+*/
+const TACSFatigueDamage::Record *TACSFatigueDamage::getRecords(
+    int elemIndex, double time, int *num_records) {
+  *num_records = 0;
+  if (!elem_records || elemIndex >= num_elements) {
+    return NULL;
+  }
+
+  const ElementRecords *rec = &elem_records[elemIndex];
+  int low = 0, high = rec->num_records;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (rec->records[mid].time < time) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  int end = low;
+  while (end < rec->num_records && rec->records[end].time == time) {
+    end++;
+  }
+  *num_records = end - low;
+  return &rec->records[low];
+}
+
+/*
+  Add the derivative of the function w.r.t. the state variables at the
+  reversals that occur at this time
+*/
+void TACSFatigueDamage::getElementSVSens(
+    int elemIndex, TACSElement *element, double time, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar dfdu[]) {
+  int numVars = element->getNumVariables();
+  memset(dfdu, 0, numVars * sizeof(TacsScalar));
+
+  int num_records = 0;
+  const Record *records = getRecords(elemIndex, time, &num_records);
+  for (int i = 0; i < num_records; i++) {
+    int n = records[i].point;
+    double pt[3];
+    element->getQuadraturePoint(n, pt);
+
+    TacsScalar stress = 0.0, detXd = 0.0, dsdq[9];
+    int count = evalStress(elemIndex, element, time, n, pt, Xpts, vars, dvars,
+                           ddvars, &detXd, &stress, dsdq);
+    if (count >= 1) {
+      TacsScalar dfds = dfdd[point_offset[elemIndex] + n] * records[i].sens;
+      for (int j = 0; j < count; j++) {
+        dsdq[j] *= dfds;
+      }
+      element->addPointQuantitySVSens(elemIndex, TACS_ELEMENT_STRESS, time,
+                                      alpha, beta, gamma, n, pt, Xpts, vars,
+                                      dvars, ddvars, dsdq, dfdu);
+    }
+  }
+}
+
+/*
+  Add the derivative of the function w.r.t. the design variables at
+  the reversals that occur at this time
+*/
+void TACSFatigueDamage::addElementDVSens(
+    int elemIndex, TACSElement *element, double time, TacsScalar scale,
+    const TacsScalar Xpts[], const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], int dvLen, TacsScalar dfdx[]) {
+  int num_records = 0;
+  const Record *records = getRecords(elemIndex, time, &num_records);
+  for (int i = 0; i < num_records; i++) {
+    int n = records[i].point;
+    double pt[3];
+    element->getQuadraturePoint(n, pt);
+
+    TacsScalar stress = 0.0, detXd = 0.0, dsdq[9];
+    int count = evalStress(elemIndex, element, time, n, pt, Xpts, vars, dvars,
+                           ddvars, &detXd, &stress, dsdq);
+    if (count >= 1) {
+      TacsScalar dfds = dfdd[point_offset[elemIndex] + n] * records[i].sens;
+      for (int j = 0; j < count; j++) {
+        dsdq[j] *= dfds;
+      }
+      element->addPointQuantityDVSens(elemIndex, TACS_ELEMENT_STRESS, time,
+                                      scale, n, pt, Xpts, vars, dvars, ddvars,
+                                      dsdq, dvLen, dfdx);
+    }
+  }
+}
@@ -0,0 +1,199 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_FATIGUE_DAMAGE_H
+#define TACS_FATIGUE_DAMAGE_H
+
+#include "TACSFunction.h"
+
+/*
+  Compute a KS aggregate of the fatigue damage accumulated over a
+  transient history
+
+  The damage is accumulated at each quadrature point as the history is
+  integrated, so that the stress history is never stored. Each call to
+  the integration with a new simulation time adds one sample of the
+  stress at each point. The reversals of the stress are detected from
+  consecutive samples and counted with the streaming (ASTM E1049)
+  rainflow method, and the damage of each cycle with the range ds is
+  computed from the Basquin relationship
+
+  d = (ds/dsRef)^m
+
+  where dsRef is the range with a life of one cycle. The residual
+  reversals are counted as half cycles at the end of the history.
+
+  The stress measure is either a component of the TACS_ELEMENT_STRESS
+  quantity or the signed von Mises stress. Each point stores a bounded
+  stack of at most MAX_REVERSALS unmatched reversals. When the stack
+  is full, the oldest reversal is counted as a half cycle.
+
+  The damage at the points is aggregated with the continuous KS
+  function. For the adjoint, the derivative of the damage with respect
+  to the stress at each reversal is recorded when its cycle is
+  counted, and these records are retrieved by the simulation time of
+  the step in the reverse sweep. The records for points that do not
+  contribute to the KS function are discarded once the history is
+  complete. The records are divided by the time integration factor of
+  the forward step, which the integrator applies again in the reverse
+  sweep.
+
+  The function must be integrated over the history in order of
+  increasing time and is not thread-safe during the integration.
+*/
+class TACSFatigueDamage : public TACSFunction {
+ public:
+  TACSFatigueDamage(TACSAssembler *_assembler, double _ksWeight,
+                    double _exponent, double _refRange);
+  ~TACSFatigueDamage();
+
+  /**
+    Get the object/function name
+  */
+  const char *getObjectName();
+
+  // Set parameters for the KS function
+  // ----------------------------------
+  double getParameter();
+  void setParameter(double _ksWeight);
+
+  // Set the stress component (or -1 for the signed von Mises stress)
+  // ----------------------------------------------------------------
+  void setStressComponent(int _component);
+
+  /**
+    Get the maximum damage
+  */
+  TacsScalar getMaximumDamage();
+
+  /**
+     Initialize the function for the given type of evaluation
+  */
+  void initEvaluation(EvaluationType ftype);
+
+  /**
+     Add the samples at this time to the damage at each point
+  */
+  void elementWiseEval(EvaluationType ftype, int elemIndex,
+                       TACSElement *element, double time, TacsScalar scale,
+                       const TacsScalar Xpts[], const TacsScalar vars[],
+                       const TacsScalar dvars[], const TacsScalar ddvars[]);
+
+  /**
+     Count the residual reversals and aggregate the damage
+  */
+  void finalEvaluation(EvaluationType ftype);
+
+  /**
+     Get the value of the function
+  */
+  TacsScalar getFunctionValue();
+
+  /**
+     Evaluate the derivative of the function w.r.t. state variables
+  */
+  void getElementSVSens(int elemIndex, TACSElement *element, double time,
+                        TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar *elemSVSens);
+
+  /**
+     Add the derivative of the function w.r.t. the design variables
+  */
+  void addElementDVSens(int elemIndex, TACSElement *element, double time,
+                        TacsScalar scale, const TacsScalar Xpts[],
+                        const TacsScalar vars[], const TacsScalar dvars[],
+                        const TacsScalar ddvars[], int dvLen,
+                        TacsScalar dfdx[]);
+
+ private:
+  // The maximum number of unmatched reversals at each point
+  static const int MAX_REVERSALS = 8;
+
+  // A reversal of the stress at a point
+  struct Reversal {
+    TacsScalar value;  // The stress at the reversal
+    double time;       // The time of the step
+    double scale;      // The time integration factor of the step
+  };
+
+  // The state of the cycle counting at a point
+  struct PointState {
+    int active;         // Does this point define the stress?
+    int num_samples;    // The number of samples
+    int dir;            // The sign of the last change in the stress
+    Reversal last;      // The last sample
+    int num_reversals;  // The number of unmatched reversals
+    Reversal reversals[MAX_REVERSALS];
+    TacsScalar damage;  // The accumulated damage
+    TacsScalar weight;  // The quadrature weight times detXd
+  };
+
+  // The derivative of the damage w.r.t. the stress at a reversal
+  struct Record {
+    double time;      // The time of the reversal
+    int point;        // The quadrature point within the element
+    TacsScalar sens;  // The derivative divided by the time factor
+  };
+
+  // The records for each element
+  struct ElementRecords {
+    int num_records, max_records;
+    Record *records;
+  };
+
+  // Evaluate the stress measure and its derivative at a point
+  int evalStress(int elemIndex, TACSElement *element, double time, int n,
+                 double pt[], const TacsScalar Xpts[],
+                 const TacsScalar vars[], const TacsScalar dvars[],
+                 const TacsScalar ddvars[], TacsScalar *detXd,
+                 TacsScalar *stress, TacsScalar dsdq[]);
+
+  // Count the cycles at a point
+  void addReversal(int elemIndex, int n, PointState *state,
+                   const Reversal *rev);
+  void addCycle(int elemIndex, int n, PointState *state, const Reversal *a,
+                const Reversal *b, double factor);
+  void addRecord(int elemIndex, int n, const Reversal *rev, TacsScalar sens);
+  const Record *getRecords(int elemIndex, double time, int *num_records);
+
+  // Free the point states and the records
+  void clearData();
+
+  // The name of the function
+  static const char *funcName;
+
+  // The KS weight and the Basquin parameters
+  double ksWeight, exponent, refRange;
+  int component;
+
+  // The maximum damage and the sum of the exponentials
+  TacsScalar maxDamage, ksSum;
+
+  // The point states and records for each element
+  int num_elements;
+  int *point_offset;
+  PointState *states;
+  ElementRecords *elem_records;
+
+  // The derivative of the function w.r.t. the damage at each point
+  TacsScalar *dfdd;
+};
+
+#endif  // TACS_FATIGUE_DAMAGE_H
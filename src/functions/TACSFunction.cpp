@@ -48,6 +48,8 @@ TACSFunction::TACSFunction(TACSAssembler *_assembler, DomainType _funcDomain,
   maxElems = (_maxElems > 0 ? _maxElems : 0);
   numElems = 0;
   elemNums = NULL;
+
+  clearCachedValue();
 }
 
 /*
@@ -102,6 +104,7 @@ void TACSFunction::setDomain(int _numElems, const int _elemNums[]) {
 
     memcpy(elemNums, _elemNums, numElems * sizeof(int));
     numElems = TacsUniqueSort(numElems, elemNums);
+    clearCachedValue();
   }
 }
 
@@ -148,6 +151,7 @@ void TACSFunction::addDomain(int _numElems, const int _elemNums[]) {
     }
 
     numElems = TacsUniqueSort(numElems, elemNums);
+    clearCachedValue();
   }
 }
 
@@ -170,3 +174,39 @@ TACSAssembler *TACSFunction::getAssembler() { return assembler; }
   Retrieve the object name
 */
 const char *TACSFunction::getObjectName() { return "TACSFunction"; }
+
+/*
+  Retrieve the stored function value if the model has not changed
+  since it was evaluated
+*/
+int TACSFunction::getCachedValue(TacsScalar *value) {
+  if (cacheDesignVersion >= 0 &&
+      cacheDesignVersion == assembler->getDesignVersion() &&
+      cacheNodeVersion == assembler->getNodeVersion() &&
+      cacheStateVersion == assembler->getStateVersion() &&
+      cacheTime == assembler->getSimulationTime()) {
+    *value = cacheValue;
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  Store the function value for the current state of the model
+*/
+void TACSFunction::setCachedValue(TacsScalar value) {
+  cacheDesignVersion = assembler->getDesignVersion();
+  cacheNodeVersion = assembler->getNodeVersion();
+  cacheStateVersion = assembler->getStateVersion();
+  cacheTime = assembler->getSimulationTime();
+  cacheValue = value;
+}
+
+/*
+  Discard the stored function value
+*/
+void TACSFunction::clearCachedValue() {
+  cacheDesignVersion = cacheNodeVersion = cacheStateVersion = -1;
+  cacheTime = 0.0;
+  cacheValue = 0.0;
+}
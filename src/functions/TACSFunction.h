@@ -41,42 +41,45 @@ class TACSAssembler;
   TACSFunction. This is not thread-safe since multiple threads could
   update the same memory address.
 
-  To circumvent this issue, the code uses a function context for each
-  active thread. Each context is thread-specific and data is
-  accumulated first within each context then a mutex is used to ensure
-  thread-safe writing to the data within the function class itself.
+  To circumvent this issue, functions that support threaded
+  integration accumulate their data within a separate array of values
+  for each active thread. The size of this array is returned by
+  getNumThreadValues(). Each thread initializes its values with
+  initThreadValues(), calls elementWiseEvalThread() for the elements
+  that it is assigned, and the values from all threads are then added
+  to the function one thread at a time with addThreadValues().
+  Functions that return zero from getNumThreadValues() are always
+  integrated on a single thread using elementWiseEval(). Any data used
+  by the thread-safe methods below must only be read after the
+  evaluation, and must not be modified by them.
 
   The functions that are thread-safe are:
-  elementWiseEval(), elementWiseSVSens(), elementWiseDVSens() and
-  elementWiseXptSens()
+  elementWiseEvalThread(), getElementSVSens(), addElementDVSens() and
+  getElementXptSens()
 
   The way this object works is with the following sequence of calls:
 
-  1. If the function is not initialized (!isInitialized()), then call
-  preInitialize(), for each element in the function domain call
-  elementWiseInitialize(), then call postInitialize(). Note that these
-  functions are not thread-safe.
+  1. If the function is two-stage, call initEvaluation() with the
+  INITIALIZE type, integrate over the elements in the function domain,
+  then call finalEvaluation(). Note that initEvaluation() and
+  finalEvaluation() are collective and are not thread-safe.
 
-  2. Obtain the size of the buffer sizes required for the function by
-  calling getEvalWorkSizes( int * iwork, int * work ). Call preEval()
-  once on each MPI process, call preEvalThread() once for each thread
-  in a mutex-protected mode, call the thread-safe code
-  elementWiseEval(), once for each element in the domain, then call
-  postEvalThread() for each thread in a mutex-protected mode and
-  postEval on all MPI process. Subsequent calls to getValue() must
-  return the same value on all processes.
+  2. Call initEvaluation() with the INTEGRATE type, integrate over the
+  elements in the function domain, then call finalEvaluation().
+  Subsequent calls to getFunctionValue() must return the same value
+  on all processes.
 
   3. To evaluate the gradient of the function w.r.t. either the state
-  variables, design variables or nodes call elementWiseSVSens(),
-  elementWiseDVSens() and elementWiseXptSens(). Note that these are all
+  variables, design variables or nodes call getElementSVSens(),
+  addElementDVSens() and getElementXptSens(). Note that these are all
   thread-safe. Note that the results must be summed across all threads/
   MPI processes. Also note that the function may use internal values stored
   from a previous function call. As a reult, it may be necessary to evaluate
   the function before evaluating the derivatives.
 
   Note: You cannot mix calling sequences. That is you cannot call
-  elementWiseDVSens() before finishing the ENTIRE evaluation sequence in
-  2. Otherwise the work arrays will not contain the correct data.
+  addElementDVSens() before finishing the ENTIRE evaluation sequence in
+  2. Otherwise the function will not contain the correct data.
 */
 class TACSFunction : public TACSObject {
  public:
@@ -104,7 +107,7 @@ class TACSFunction : public TACSObject {
   /**
      Get the stage type of this function: Either one or two stage
 
-     Some functions (such as aggregation functionals) require a
+     Some functions (such as the induced aggregation functionals) require a
      two-stage integration strategy for numerical stability.
 
      @return The enum type indicating whether this is a one or two stage func.
@@ -170,6 +173,65 @@ class TACSFunction : public TACSObject {
                                const TacsScalar dvars[],
                                const TacsScalar ddvars[]) {}
 
+  /**
+     Get the number of values accumulated by each thread during a
+     threaded integration over the function domain.
+
+     Functions that return zero (the default) are integrated on a
+     single thread using elementWiseEval().
+
+     @param ftype The type of evaluation
+     @return The number of values accumulated on each thread
+  */
+  virtual int getNumThreadValues(EvaluationType ftype) { return 0; }
+
+  /**
+     Initialize the values accumulated on a thread
+
+     By default, the values are set to zero.
+
+     @param ftype The type of evaluation
+     @param vals The values accumulated on the thread
+  */
+  virtual void initThreadValues(EvaluationType ftype, TacsScalar vals[]) {
+    memset(vals, 0, getNumThreadValues(ftype) * sizeof(TacsScalar));
+  }
+
+  /**
+     Perform an element-wise integration over this element and
+     accumulate the result into the thread values.
+
+     This code must be thread-safe: It may be called concurrently for
+     different elements and must not modify the function object. Note
+     that this is not a collective call.
+
+     @param ftype The type of evaluation
+     @param elemIndex The local element index
+     @param element The TACSElement object
+     @param time The simulation time
+     @param scale The scalar integration factor to apply
+     @param Xpts The element node locations
+     @param vars The element DOF
+     @param dvars The first time derivatives of the element DOF
+     @param ddvars The second time derivatives of the element DOF
+     @param vals The values accumulated on the thread
+  */
+  virtual void elementWiseEvalThread(
+      EvaluationType ftype, int elemIndex, TACSElement *element, double time,
+      TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
+      const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar vals[]) {}
+
+  /**
+     Add the values accumulated on a thread to the function
+
+     This is called on a single thread at a time once the integration
+     over the domain is complete, but before finalEvaluation().
+
+     @param ftype The type of evaluation
+     @param vals The values accumulated on the thread
+  */
+  virtual void addThreadValues(EvaluationType ftype, const TacsScalar vals[]) {}
+
   /**
      Finalize the function evaluation for the specified eval type.
 
@@ -182,6 +244,30 @@ class TACSFunction : public TACSObject {
   */
   virtual TacsScalar getFunctionValue() = 0;
 
+  /**
+     Retrieve the value stored from the last call to
+     TACSAssembler::evalFunctions()
+
+     The value is only returned if the design, node and state versions
+     of the assembler and the simulation time are the same as when the
+     value was stored. Classes that define parameters that modify the
+     function must call clearCachedValue() when they are changed.
+
+     @param value The stored function value
+     @return Flag indicating whether the stored value is current
+  */
+  int getCachedValue(TacsScalar *value);
+
+  /**
+     Store the function value for the current versions of the assembler
+  */
+  void setCachedValue(TacsScalar value);
+
+  /**
+     Discard the stored function value
+  */
+  void clearCachedValue();
+
   /**
      Evaluate the derivative of the function w.r.t. state variables
 
@@ -264,6 +350,12 @@ class TACSFunction : public TACSObject {
   int maxElems;   // maximum size of currently allocated elemNums array
   int numElems;   // number of elements actually stored in elemNums
   int *elemNums;  // sorted array of element numbers
+
+  // The stored function value and the assembler versions and time for
+  // which it was evaluated. A negative version indicates no value.
+  int cacheDesignVersion, cacheNodeVersion, cacheStateVersion;
+  double cacheTime;
+  TacsScalar cacheValue;
 };
 
 #endif  // TACS_FUNCTION_H
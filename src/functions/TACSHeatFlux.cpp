@@ -74,6 +74,20 @@ void TACSHeatFlux::finalEvaluation(EvaluationType ftype) {
                 assembler->getMPIComm());
 }
 
+/*
+  Retrieve the surfaces to integrate for the element
+
+  The map is only read after construction, so this may be called
+  concurrently from multiple threads.
+*/
+int TACSHeatFlux::getFaceKey(int elemIndex) {
+  std::map<int, int>::const_iterator it = element_to_face_key.find(elemIndex);
+  if (it != element_to_face_key.end()) {
+    return it->second;
+  }
+  return 0;
+}
+
 /*
   Perform the element-wise evaluation of the TACSDisplacementIntegral function.
 */
@@ -83,12 +97,29 @@ void TACSHeatFlux::elementWiseEval(EvaluationType ftype, int elemIndex,
                                    const TacsScalar vars[],
                                    const TacsScalar dvars[],
                                    const TacsScalar ddvars[]) {
+  elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                        dvars, ddvars, &value);
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSHeatFlux::getNumThreadValues(EvaluationType ftype) { return 1; }
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSHeatFlux::elementWiseEvalThread(
+    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
+    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar vals[]) {
   // Retrieve the number of stress components for this element
   TACSElementBasis *basis = element->getElementBasis();
 
   if (basis) {
     // Get the surface index
-    int face_key = element_to_face_key[elemIndex];
+    int face_key = getFaceKey(elemIndex);
 
     for (int face = 0; (face_key && face < MAX_SURFACE_INDEX); face++) {
       // Check if this is a surface that we need to integrate
@@ -113,9 +144,9 @@ void TACSHeatFlux::elementWiseEval(EvaluationType ftype, int elemIndex,
             TacsScalar Area =
                 basis->getFaceNormal(face, i, Xpts, X, Xd, normal);
             if (count == 2) {
-              value += scale * weight * Area * vec2Dot(flux, normal);
+              vals[0] += scale * weight * Area * vec2Dot(flux, normal);
             } else if (count == 3) {
-              value += scale * weight * Area * vec3Dot(flux, normal);
+              vals[0] += scale * weight * Area * vec3Dot(flux, normal);
             }
           }
         }
@@ -124,6 +155,14 @@ void TACSHeatFlux::elementWiseEval(EvaluationType ftype, int elemIndex,
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSHeatFlux::addThreadValues(EvaluationType ftype,
+                                   const TacsScalar vals[]) {
+  value += vals[0];
+}
+
 /*
   These functions are used to determine the sensitivity of the
   function with respect to the state variables.
@@ -143,7 +182,7 @@ void TACSHeatFlux::getElementSVSens(
 
   if (basis) {
     // Get the surface index
-    int face_key = element_to_face_key[elemIndex];
+    int face_key = getFaceKey(elemIndex);
 
     for (int face = 0; (face_key && face < MAX_SURFACE_INDEX); face++) {
       // Check if this is a surface that we need to integrate
@@ -157,7 +196,6 @@ void TACSHeatFlux::getElementSVSens(
 
           // Evaluate the heat flux at the quadrature point
           TacsScalar flux[3], detXd = 0.0;
-          ;
           const int not_a_quadrature_pt = -1;
           int count = element->evalPointQuantity(
               elemIndex, TACS_HEAT_FLUX, time, not_a_quadrature_pt, pt, Xpts,
@@ -206,7 +244,7 @@ void TACSHeatFlux::getElementXptSens(
 
   if (basis) {
     // Get the surface index
-    int face_key = element_to_face_key[elemIndex];
+    int face_key = getFaceKey(elemIndex);
 
     for (int face = 0; (face_key && face < MAX_SURFACE_INDEX); face++) {
       // Check if this is a surface that we need to integrate
@@ -280,7 +318,7 @@ void TACSHeatFlux::addElementDVSens(
 
   if (basis) {
     // Get the surface index
-    int face_key = element_to_face_key[elemIndex];
+    int face_key = getFaceKey(elemIndex);
 
     for (int face = 0; (face_key && face < MAX_SURFACE_INDEX); face++) {
       // Check if this is a surface that we need to integrate
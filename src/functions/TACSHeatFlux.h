@@ -48,6 +48,17 @@ class TACSHeatFlux : public TACSFunction {
                        const TacsScalar Xpts[], const TacsScalar vars[],
                        const TacsScalar dvars[], const TacsScalar ddvars[]);
 
+  /**
+     Perform the integration using the values accumulated on each thread
+  */
+  int getNumThreadValues(EvaluationType ftype);
+  void elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                             TACSElement *element, double time,
+                             TacsScalar scale, const TacsScalar Xpts[],
+                             const TacsScalar vars[], const TacsScalar dvars[],
+                             const TacsScalar ddvars[], TacsScalar vals[]);
+  void addThreadValues(EvaluationType ftype, const TacsScalar vals[]);
+
   /**
      Finalize the function evaluation for the specified eval type.
   */
@@ -93,6 +104,9 @@ class TACSHeatFlux : public TACSFunction {
 
   // List of elements and its associated surfaces
   std::map<int, int> element_to_face_key;
+
+  // Get the surfaces of an element without modifying the map
+  int getFaceKey(int elemIndex);
 };
 
 #endif  // TACS_HEAT_FLUX_H
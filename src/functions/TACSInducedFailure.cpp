@@ -32,12 +32,18 @@ TACSInducedFailure::TACSInducedFailure(TACSAssembler *_assembler, double _P)
   maxFail = -1e20;
   failNumer = 0.0;
   failDenom = 0.0;
+
+  failCache = NULL;
 }
 
 /*
   Delete all the allocated data
 */
-TACSInducedFailure::~TACSInducedFailure() {}
+TACSInducedFailure::~TACSInducedFailure() {
+  if (failCache) {
+    failCache->decref();
+  }
+}
 
 /*
   The name of the function class
@@ -47,7 +53,10 @@ const char *TACSInducedFailure::funcName = "TACSInducedFailure";
 /*
   Set the value of P
 */
-void TACSInducedFailure::setParameter(double _P) { P = _P; }
+void TACSInducedFailure::setParameter(double _P) {
+  P = _P;
+  clearCachedValue();
+}
 
 /*
   Retrieve the value of P
@@ -59,6 +68,41 @@ double TACSInducedFailure::getParameter() { return P; }
 */
 void TACSInducedFailure::setInducedType(enum InducedNormType type) {
   normType = type;
+  clearCachedValue();
+}
+
+/*
+  Set the object used to store the failure values
+
+  The object may be shared with other failure functions defined on the
+  same TACSAssembler object, or may be NULL.
+*/
+void TACSInducedFailure::setFailureCache(TACSFailureCache *_failCache) {
+  if (_failCache) {
+    _failCache->incref();
+  }
+  if (failCache) {
+    failCache->decref();
+  }
+  failCache = _failCache;
+}
+
+/*
+  Evaluate the failure index at a quadrature point
+*/
+int TACSInducedFailure::evalFailure(int elemIndex, TACSElement *element,
+                                    double time, int n, double pt[],
+                                    const TacsScalar Xpts[],
+                                    const TacsScalar vars[],
+                                    const TacsScalar dvars[],
+                                    const TacsScalar ddvars[],
+                                    TacsScalar *detXd, TacsScalar *fail) {
+  if (failCache) {
+    return failCache->evalFailure(elemIndex, element, time, n, pt, Xpts, vars,
+                                  dvars, ddvars, detXd, fail);
+  }
+  return element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, n, pt,
+                                    Xpts, vars, dvars, ddvars, detXd, fail);
 }
 
 /*
@@ -112,10 +156,60 @@ void TACSInducedFailure::finalEvaluation(EvaluationType ftype) {
   Perform the element-wise evaluation of the TACSInducedFailure
   function.
 */
-void TACSInducedFailure::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSInducedFailure::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                         TACSElement *element, double time,
+                                         TacsScalar scale,
+                                         const TacsScalar Xpts[],
+                                         const TacsScalar vars[],
+                                         const TacsScalar dvars[],
+                                         const TacsScalar ddvars[]) {
+  if (ftype == TACSFunction::INITIALIZE) {
+    elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                          dvars, ddvars, &maxFail);
+  } else {
+    TacsScalar vals[2] = {failNumer, failDenom};
+    elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                          dvars, ddvars, vals);
+    failNumer = vals[0];
+    failDenom = vals[1];
+  }
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSInducedFailure::getNumThreadValues(EvaluationType ftype) {
+  if (ftype == TACSFunction::INITIALIZE) {
+    return 1;
+  }
+  return 2;
+}
+
+/*
+  Initialize the values accumulated on each thread
+*/
+void TACSInducedFailure::initThreadValues(EvaluationType ftype,
+                                          TacsScalar vals[]) {
+  if (ftype == TACSFunction::INITIALIZE) {
+    vals[0] = -1e20;
+  } else {
+    vals[0] = vals[1] = 0.0;
+  }
+}
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSInducedFailure::elementWiseEvalThread(EvaluationType ftype,
+                                               int elemIndex,
+                                               TACSElement *element,
+                                               double time, TacsScalar scale,
+                                               const TacsScalar Xpts[],
+                                               const TacsScalar vars[],
+                                               const TacsScalar dvars[],
+                                               const TacsScalar ddvars[],
+                                               TacsScalar vals[]) {
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -123,56 +217,70 @@ void TACSInducedFailure::elementWiseEval(
     // Evaluate the failure index, and check whether it is an
     // undefined quantity of interest on this element
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     // Check whether the quantity requested is defined or not
     if (count >= 1) {
       if (ftype == TACSFunction::INITIALIZE) {
         // Set the maximum failure load
-        if (TacsRealPart(fail) > TacsRealPart(maxFail)) {
-          maxFail = fail;
+        if (TacsRealPart(fail) > TacsRealPart(vals[0])) {
+          vals[0] = fail;
         }
       } else {
         if (normType == POWER) {
           TacsScalar fp = pow(fabs(fail / maxFail), P);
-          failNumer += scale * weight * detXd * (fail / maxFail) * fp;
-          failDenom += weight * detXd * fp;
+          vals[0] += scale * weight * detXd * (fail / maxFail) * fp;
+          vals[1] += weight * detXd * fp;
         } else if (normType == DISCRETE_POWER) {
           TacsScalar fp = pow(fabs(fail / maxFail), P);
-          failNumer += scale * (fail / maxFail) * fp;
-          failDenom += fp;
+          vals[0] += scale * (fail / maxFail) * fp;
+          vals[1] += fp;
         } else if (normType == POWER_SQUARED) {
           TacsScalar fp = pow(fabs(fail / maxFail), P);
-          failNumer += scale * weight * detXd * (fail * fail / maxFail) * fp;
-          failDenom += weight * detXd * fp;
+          vals[0] += scale * weight * detXd * (fail * fail / maxFail) * fp;
+          vals[1] += weight * detXd * fp;
         } else if (normType == DISCRETE_POWER_SQUARED) {
           TacsScalar fp = pow(fabs(fail / maxFail), P);
-          failNumer += scale * (fail * fail / maxFail) * fp;
-          failDenom += fp;
+          vals[0] += scale * (fail * fail / maxFail) * fp;
+          vals[1] += fp;
         } else if (normType == EXPONENTIAL) {
           TacsScalar efp = exp(P * (fail - maxFail));
-          failNumer += scale * weight * detXd * (fail / maxFail) * efp;
-          failDenom += weight * detXd * efp;
+          vals[0] += scale * weight * detXd * (fail / maxFail) * efp;
+          vals[1] += weight * detXd * efp;
         } else if (normType == DISCRETE_EXPONENTIAL) {
           TacsScalar efp = exp(P * (fail - maxFail));
-          failNumer += scale * (fail / maxFail) * efp;
-          failDenom += efp;
+          vals[0] += scale * (fail / maxFail) * efp;
+          vals[1] += efp;
         } else if (normType == EXPONENTIAL_SQUARED) {
           TacsScalar efp = exp(P * (fail - maxFail));
-          failNumer += scale * weight * detXd * (fail * fail / maxFail) * efp;
-          failDenom += weight * detXd * efp;
+          vals[0] += scale * weight * detXd * (fail * fail / maxFail) * efp;
+          vals[1] += weight * detXd * efp;
         } else if (normType == DISCRETE_EXPONENTIAL_SQUARED) {
           TacsScalar efp = exp(P * (fail - maxFail));
-          failNumer += scale * (fail * fail / maxFail) * efp;
-          failDenom += efp;
+          vals[0] += scale * (fail * fail / maxFail) * efp;
+          vals[1] += efp;
         }
       }
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSInducedFailure::addThreadValues(EvaluationType ftype,
+                                         const TacsScalar vals[]) {
+  if (ftype == TACSFunction::INITIALIZE) {
+    if (TacsRealPart(vals[0]) > TacsRealPart(maxFail)) {
+      maxFail = vals[0];
+    }
+  } else {
+    failNumer += vals[0];
+    failDenom += vals[1];
+  }
+}
+
 /*
   Determine the derivative of the P-norm function w.r.t. the state
   variables over this element.
@@ -192,9 +300,8 @@ void TACSInducedFailure::getElementSVSens(
     double weight = element->getQuadraturePoint(i, pt);
 
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     if (count >= 1) {
       // Compute the derivative of the induced aggregation with
@@ -280,9 +387,8 @@ void TACSInducedFailure::getElementXptSens(
     double weight = element->getQuadraturePoint(i, pt);
 
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     if (count >= 1) {
       // Compute the sensitivity contribution
@@ -374,9 +480,8 @@ void TACSInducedFailure::addElementDVSens(
     double weight = element->getQuadraturePoint(i, pt);
 
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     if (count >= 1) {
       // Compute the derivative of the induced aggregation with
@@ -19,6 +19,7 @@
   Compute an aggregated function using an induced norm approach
 */
 
+#include "TACSFailureCache.h"
 #include "TACSFunction.h"
 
 /*
@@ -90,6 +91,10 @@ class TACSInducedFailure : public TACSFunction {
   // -----------------------------------------------------------
   void setMaxFailOffset(TacsScalar _maxFail) { maxFail = _maxFail; }
 
+  // Set the object used to store and share the failure values
+  // ---------------------------------------------------------
+  void setFailureCache(TACSFailureCache *_failCache);
+
   /**
      Initialize the function for the given type of evaluation
   */
@@ -102,6 +107,14 @@ class TACSInducedFailure : public TACSFunction {
                        TACSElement *element, double time, TacsScalar scale,
                        const TacsScalar Xpts[], const TacsScalar vars[],
                        const TacsScalar dvars[], const TacsScalar ddvars[]);
+  int getNumThreadValues(EvaluationType ftype);
+  void initThreadValues(EvaluationType ftype, TacsScalar vals[]);
+  void elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                             TACSElement *element, double time,
+                             TacsScalar scale, const TacsScalar Xpts[],
+                             const TacsScalar vars[], const TacsScalar dvars[],
+                             const TacsScalar ddvars[], TacsScalar vals[]);
+  void addThreadValues(EvaluationType ftype, const TacsScalar vals[]);
 
   /**
      Finalize the function evaluation for the specified eval type.
@@ -140,9 +153,18 @@ class TACSInducedFailure : public TACSFunction {
                          const TacsScalar ddvars[], TacsScalar fXptSens[]);
 
  private:
+  // Evaluate the failure index at a point, using the cache if it is set
+  int evalFailure(int elemIndex, TACSElement *element, double time, int n,
+                  double pt[], const TacsScalar Xpts[], const TacsScalar vars[],
+                  const TacsScalar dvars[], const TacsScalar ddvars[],
+                  TacsScalar *detXd, TacsScalar *fail);
+
   // The type of norm to evaluate
   InducedNormType normType;
 
+  // The stored failure values (may be NULL)
+  TACSFailureCache *failCache;
+
   TacsScalar maxFail;  // The maximum failure function at a Gauss point
   TacsScalar failNumer, failDenom;  // The numerator and denominator
 
@@ -0,0 +1,116 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_KS_AGGREGATION_H
+#define TACS_KS_AGGREGATION_H
+
+#include "TACSObject.h"
+
+/*
+  Single-pass aggregation for the KS and p-norm functions
+
+  The partial aggregate is stored as the pair vals = (max, sum), where
+  max is the largest value seen so far and sum is the weighted sum of
+  exp(ksWeight*(f - max)) for the KS functions or
+  |f/max|^ksWeight for the p-norm functions. When a larger value is
+  found, the sum is rescaled to the new maximum so that the exponent
+  never becomes positive. Two partial aggregates can be merged in the
+  same way, so the values from each thread and each processor can be
+  combined after a single pass over the elements.
+
+  The comparisons use the real part of the values, so that the complex
+  step is exact: the aggregate is analytically independent of the
+  maximum used to scale the sum.
+*/
+
+/*
+  Initialize an empty partial aggregate
+*/
+inline void TacsKSInitValues(TacsScalar vals[]) {
+  vals[0] = -1e20;
+  vals[1] = 0.0;
+}
+
+/*
+  Compute the factor that rescales a sum from the maximum m0 to the
+  larger maximum m1
+*/
+inline TacsScalar TacsKSRescaleFactor(double ksWeight, int pnorm,
+                                      TacsScalar m0, TacsScalar m1) {
+  if (pnorm) {
+    return pow(fabs(TacsRealPart(m0 / m1)), ksWeight);
+  }
+  return exp(ksWeight * (m0 - m1));
+}
+
+/*
+  Add a value with the given weight to the partial aggregate
+*/
+inline void TacsKSAddValue(double ksWeight, int pnorm, TacsScalar f,
+                           TacsScalar weight, TacsScalar vals[]) {
+  if (TacsRealPart(f) > TacsRealPart(vals[0])) {
+    if (vals[1] != 0.0) {
+      vals[1] *= TacsKSRescaleFactor(ksWeight, pnorm, vals[0], f);
+    }
+    vals[0] = f;
+  }
+  if (pnorm) {
+    vals[1] += weight * pow(fabs(TacsRealPart(f / vals[0])), ksWeight);
+  } else {
+    vals[1] += weight * exp(ksWeight * (f - vals[0]));
+  }
+}
+
+/*
+  Merge the partial aggregate in into vals
+*/
+inline void TacsKSMergeValues(double ksWeight, int pnorm,
+                              const TacsScalar in[], TacsScalar vals[]) {
+  if (TacsRealPart(in[0]) > TacsRealPart(vals[0])) {
+    if (vals[1] != 0.0) {
+      vals[1] *= TacsKSRescaleFactor(ksWeight, pnorm, vals[0], in[0]);
+    }
+    vals[0] = in[0];
+    vals[1] += in[1];
+  } else if (in[1] != 0.0) {
+    vals[1] += in[1] * TacsKSRescaleFactor(ksWeight, pnorm, in[0], vals[0]);
+  }
+}
+
+/*
+  Combine the partial aggregates from all processors
+
+  The pairs are gathered with a single collective and merged in rank
+  order, so that every processor obtains the same result.
+*/
+inline void TacsKSAllreduceValues(MPI_Comm comm, double ksWeight, int pnorm,
+                                  TacsScalar vals[]) {
+  int size;
+  MPI_Comm_size(comm, &size);
+  if (size == 1) {
+    return;
+  }
+
+  TacsScalar *all = new TacsScalar[2 * size];
+  MPI_Allgather(vals, 2, TACS_MPI_TYPE, all, 2, TACS_MPI_TYPE, comm);
+
+  TacsKSInitValues(vals);
+  for (int k = 0; k < size; k++) {
+    TacsKSMergeValues(ksWeight, pnorm, &all[2 * k], vals);
+  }
+
+  delete[] all;
+}
+
+#endif  // TACS_KS_AGGREGATION_H
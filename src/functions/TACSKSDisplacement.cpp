@@ -19,6 +19,7 @@
 #include "TACSKSDisplacement.h"
 
 #include "TACSAssembler.h"
+#include "TACSKSAggregation.h"
 
 /*
   Initialize the TACSKSDisplacement class properties
@@ -27,7 +28,7 @@ TACSKSDisplacement::TACSKSDisplacement(TACSAssembler *_assembler,
                                        double _ksWeight, const double _dir[],
                                        double _alpha)
     : TACSFunction(_assembler, TACSFunction::ENTIRE_DOMAIN,
-                   TACSFunction::TWO_STAGE, 0) {
+                   TACSFunction::SINGLE_STAGE, 0) {
   ksWeight = _ksWeight;
   dir[0] = _dir[0];
   dir[1] = _dir[1];
@@ -54,6 +55,7 @@ const char *TACSKSDisplacement::funcName = "TACSKSDisplacement";
 */
 void TACSKSDisplacement::setKSDisplacementType(enum KSDisplacementType type) {
   ksType = type;
+  clearCachedValue();
 }
 
 /*
@@ -66,6 +68,7 @@ double TACSKSDisplacement::getParameter() { return ksWeight; }
 */
 void TACSKSDisplacement::setParameter(double _ksWeight) {
   ksWeight = _ksWeight;
+  clearCachedValue();
 }
 
 /*
@@ -92,9 +95,8 @@ TacsScalar TACSKSDisplacement::getMaximumDisplacement() { return maxDisp; }
   Initialize the internal values stored within the KS function
 */
 void TACSKSDisplacement::initEvaluation(EvaluationType ftype) {
-  if (ftype == TACSFunction::INITIALIZE) {
+  if (ftype == TACSFunction::INTEGRATE) {
     maxDisp = -1e20;
-  } else if (ftype == TACSFunction::INTEGRATE) {
     ksDispSum = 0.0;
   }
 }
@@ -103,20 +105,17 @@ void TACSKSDisplacement::initEvaluation(EvaluationType ftype) {
   Reduce the function values across all MPI processes
 */
 void TACSKSDisplacement::finalEvaluation(EvaluationType ftype) {
-  if (ftype == TACSFunction::INITIALIZE) {
-    // Distribute the values of the KS function computed on this domain
-    TacsScalar temp = maxDisp;
-    MPI_Allreduce(&temp, &maxDisp, 1, TACS_MPI_TYPE, TACS_MPI_MAX,
-                  assembler->getMPIComm());
-  } else {
-    // Find the sum of the ks contributions from all processes
-    TacsScalar temp = ksDispSum;
-    MPI_Allreduce(&temp, &ksDispSum, 1, TACS_MPI_TYPE, MPI_SUM,
-                  assembler->getMPIComm());
+  if (ftype == TACSFunction::INTEGRATE) {
+    // Merge the maximum and the scaled sum from all processes
+    int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+    TacsScalar vals[2] = {maxDisp, ksDispSum};
+    TacsKSAllreduceValues(assembler->getMPIComm(), ksWeight, pnorm, vals);
+    maxDisp = vals[0];
+    ksDispSum = vals[1];
 
     // Compute the P-norm quantity if needed
     invPnorm = 0.0;
-    if (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS) {
+    if (pnorm) {
       if (ksDispSum != 0.0) {
         invPnorm = pow(ksDispSum, (1.0 - ksWeight) / ksWeight);
       }
@@ -127,10 +126,55 @@ void TACSKSDisplacement::finalEvaluation(EvaluationType ftype) {
 /*
   Perform the element-wise evaluation of the TACSKSDisplacement function.
 */
-void TACSKSDisplacement::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSKSDisplacement::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                         TACSElement *element, double time,
+                                         TacsScalar scale,
+                                         const TacsScalar Xpts[],
+                                         const TacsScalar vars[],
+                                         const TacsScalar dvars[],
+                                         const TacsScalar ddvars[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    TacsScalar vals[2] = {maxDisp, ksDispSum};
+    elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                          dvars, ddvars, vals);
+    maxDisp = vals[0];
+    ksDispSum = vals[1];
+  }
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSKSDisplacement::getNumThreadValues(EvaluationType ftype) { return 2; }
+
+/*
+  Initialize the values accumulated on each thread
+*/
+void TACSKSDisplacement::initThreadValues(EvaluationType ftype,
+                                          TacsScalar vals[]) {
+  TacsKSInitValues(vals);
+}
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSKSDisplacement::elementWiseEvalThread(EvaluationType ftype,
+                                               int elemIndex,
+                                               TACSElement *element,
+                                               double time, TacsScalar scale,
+                                               const TacsScalar Xpts[],
+                                               const TacsScalar vars[],
+                                               const TacsScalar dvars[],
+                                               const TacsScalar ddvars[],
+                                               TacsScalar vals[]) {
+  // The maximum is found while the sum is accumulated, so the
+  // initialization pass is not required
+  if (ftype != TACSFunction::INTEGRATE) {
+    return;
+  }
+  int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -149,33 +193,30 @@ void TACSKSDisplacement::elementWiseEval(
 
     // Check whether the quantity requested is defined or not
     if (count >= 1) {
-      if (ftype == TACSFunction::INITIALIZE) {
-        // Set the maximum displacement
-        if (TacsRealPart(dispProj) > TacsRealPart(maxDisp)) {
-          maxDisp = dispProj;
-        }
-      } else {
-        // Add the displacement to the sum
-        if (ksType == DISCRETE) {
-          TacsScalar fexp = exp(ksWeight * (dispProj - maxDisp));
-          ksDispSum += scale * fexp;
-        } else if (ksType == CONTINUOUS) {
-          TacsScalar fexp = exp(ksWeight * (dispProj - maxDisp));
-          ksDispSum += scale * weight * detXd * fexp;
-        } else if (ksType == PNORM_DISCRETE) {
-          TacsScalar fpow =
-              pow(fabs(TacsRealPart(dispProj / maxDisp)), ksWeight);
-          ksDispSum += scale * fpow;
-        } else if (ksType == PNORM_CONTINUOUS) {
-          TacsScalar fpow =
-              pow(fabs(TacsRealPart(dispProj / maxDisp)), ksWeight);
-          ksDispSum += scale * weight * detXd * fpow;
-        }
+      // Add the displacement to the running maximum and scaled sum
+      TacsScalar w = scale;
+      if (ksType == CONTINUOUS || ksType == PNORM_CONTINUOUS) {
+        w *= weight * detXd;
       }
+      TacsKSAddValue(ksWeight, pnorm, dispProj, w, vals);
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSKSDisplacement::addThreadValues(EvaluationType ftype,
+                                         const TacsScalar vals[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+    TacsScalar sum[2] = {maxDisp, ksDispSum};
+    TacsKSMergeValues(ksWeight, pnorm, vals, sum);
+    maxDisp = sum[0];
+    ksDispSum = sum[1];
+  }
+}
+
 /*
   These functions are used to determine the sensitivity of the
   function with respect to the state variables.
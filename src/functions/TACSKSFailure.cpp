@@ -19,6 +19,7 @@
 #include "TACSKSFailure.h"
 
 #include "TACSAssembler.h"
+#include "TACSKSAggregation.h"
 
 /*
   Initialize the TACSKSFailure class properties
@@ -26,7 +27,7 @@
 TACSKSFailure::TACSKSFailure(TACSAssembler *_assembler, double _ksWeight,
                              double _alpha, double _safetyFactor)
     : TACSFunction(_assembler, TACSFunction::ENTIRE_DOMAIN,
-                   TACSFunction::TWO_STAGE, 0) {
+                   TACSFunction::SINGLE_STAGE, 0) {
   ksWeight = _ksWeight;
   alpha = _alpha;
   safetyFactor = _safetyFactor;
@@ -37,9 +38,15 @@ TACSKSFailure::TACSKSFailure(TACSAssembler *_assembler, double _ksWeight,
   maxFail = -1e20;
   ksFailSum = 0.0;
   invPnorm = 0.0;
+
+  failCache = NULL;
 }
 
-TACSKSFailure::~TACSKSFailure() {}
+TACSKSFailure::~TACSKSFailure() {
+  if (failCache) {
+    failCache->decref();
+  }
+}
 
 /*
   TACSKSFailure function name
@@ -49,7 +56,43 @@ const char *TACSKSFailure::funcName = "TACSKSFailure";
 /*
   Set the KS aggregation type
 */
-void TACSKSFailure::setKSFailureType(enum KSFailureType type) { ksType = type; }
+void TACSKSFailure::setKSFailureType(enum KSFailureType type) {
+  ksType = type;
+  clearCachedValue();
+}
+
+/*
+  Set the object used to store the failure values
+
+  The object may be shared with other failure functions defined on the
+  same TACSAssembler object, or may be NULL.
+*/
+void TACSKSFailure::setFailureCache(TACSFailureCache *_failCache) {
+  if (_failCache) {
+    _failCache->incref();
+  }
+  if (failCache) {
+    failCache->decref();
+  }
+  failCache = _failCache;
+}
+
+/*
+  Evaluate the failure index at a quadrature point
+*/
+int TACSKSFailure::evalFailure(int elemIndex, TACSElement *element,
+                               double time, int n, double pt[],
+                               const TacsScalar Xpts[], const TacsScalar vars[],
+                               const TacsScalar dvars[],
+                               const TacsScalar ddvars[], TacsScalar *detXd,
+                               TacsScalar *fail) {
+  if (failCache) {
+    return failCache->evalFailure(elemIndex, element, time, n, pt, Xpts, vars,
+                                  dvars, ddvars, detXd, fail);
+  }
+  return element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, n, pt,
+                                    Xpts, vars, dvars, ddvars, detXd, fail);
+}
 
 /*
   Retrieve the KS aggregation weight
@@ -59,7 +102,10 @@ double TACSKSFailure::getParameter() { return ksWeight; }
 /*
   Set the KS aggregation parameter
 */
-void TACSKSFailure::setParameter(double _ksWeight) { ksWeight = _ksWeight; }
+void TACSKSFailure::setParameter(double _ksWeight) {
+  ksWeight = _ksWeight;
+  clearCachedValue();
+}
 
 /*
   Return the function name
@@ -85,9 +131,8 @@ TacsScalar TACSKSFailure::getMaximumFailure() { return maxFail; }
   Initialize the internal values stored within the KS function
 */
 void TACSKSFailure::initEvaluation(EvaluationType ftype) {
-  if (ftype == TACSFunction::INITIALIZE) {
+  if (ftype == TACSFunction::INTEGRATE) {
     maxFail = -1e20;
-  } else if (ftype == TACSFunction::INTEGRATE) {
     ksFailSum = 0.0;
   }
 }
@@ -96,20 +141,17 @@ void TACSKSFailure::initEvaluation(EvaluationType ftype) {
   Reduce the function values across all MPI processes
 */
 void TACSKSFailure::finalEvaluation(EvaluationType ftype) {
-  if (ftype == TACSFunction::INITIALIZE) {
-    // Distribute the values of the KS function computed on this domain
-    TacsScalar temp = maxFail;
-    MPI_Allreduce(&temp, &maxFail, 1, TACS_MPI_TYPE, TACS_MPI_MAX,
-                  assembler->getMPIComm());
-  } else {
-    // Find the sum of the ks contributions from all processes
-    TacsScalar temp = ksFailSum;
-    MPI_Allreduce(&temp, &ksFailSum, 1, TACS_MPI_TYPE, MPI_SUM,
-                  assembler->getMPIComm());
+  if (ftype == TACSFunction::INTEGRATE) {
+    // Merge the maximum and the scaled sum from all processes
+    int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+    TacsScalar vals[2] = {maxFail, ksFailSum};
+    TacsKSAllreduceValues(assembler->getMPIComm(), ksWeight, pnorm, vals);
+    maxFail = vals[0];
+    ksFailSum = vals[1];
 
     // Compute the P-norm quantity if needed
     invPnorm = 0.0;
-    if (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS) {
+    if (pnorm) {
       if (ksFailSum != 0.0) {
         invPnorm = pow(ksFailSum, (1.0 - ksWeight) / ksWeight);
       }
@@ -126,6 +168,46 @@ void TACSKSFailure::elementWiseEval(EvaluationType ftype, int elemIndex,
                                     const TacsScalar vars[],
                                     const TacsScalar dvars[],
                                     const TacsScalar ddvars[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    TacsScalar vals[2] = {maxFail, ksFailSum};
+    elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                          dvars, ddvars, vals);
+    maxFail = vals[0];
+    ksFailSum = vals[1];
+  }
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSKSFailure::getNumThreadValues(EvaluationType ftype) { return 2; }
+
+/*
+  Initialize the values accumulated on each thread
+*/
+void TACSKSFailure::initThreadValues(EvaluationType ftype, TacsScalar vals[]) {
+  TacsKSInitValues(vals);
+}
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSKSFailure::elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                                          TACSElement *element, double time,
+                                          TacsScalar scale,
+                                          const TacsScalar Xpts[],
+                                          const TacsScalar vars[],
+                                          const TacsScalar dvars[],
+                                          const TacsScalar ddvars[],
+                                          TacsScalar vals[]) {
+  // The maximum is found while the sum is accumulated, so the
+  // initialization pass is not required
+  if (ftype != TACSFunction::INTEGRATE) {
+    return;
+  }
+  int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -133,40 +215,38 @@ void TACSKSFailure::elementWiseEval(EvaluationType ftype, int elemIndex,
     // Evaluate the failure index, and check whether it is an
     // undefined quantity of interest on this element
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     // Scale failure value by safety factor
     fail *= safetyFactor;
 
     // Check whether the quantity requested is defined or not
     if (count >= 1) {
-      if (ftype == TACSFunction::INITIALIZE) {
-        // Set the maximum failure load
-        if (TacsRealPart(fail) > TacsRealPart(maxFail)) {
-          maxFail = fail;
-        }
-      } else {
-        // Add the failure load to the sum
-        if (ksType == DISCRETE) {
-          TacsScalar fexp = exp(ksWeight * (fail - maxFail));
-          ksFailSum += scale * fexp;
-        } else if (ksType == CONTINUOUS) {
-          TacsScalar fexp = exp(ksWeight * (fail - maxFail));
-          ksFailSum += scale * weight * detXd * fexp;
-        } else if (ksType == PNORM_DISCRETE) {
-          TacsScalar fpow = pow(fabs(TacsRealPart(fail / maxFail)), ksWeight);
-          ksFailSum += scale * fpow;
-        } else if (ksType == PNORM_CONTINUOUS) {
-          TacsScalar fpow = pow(fabs(TacsRealPart(fail / maxFail)), ksWeight);
-          ksFailSum += scale * weight * detXd * fpow;
-        }
+      // Add the failure value to the running maximum and scaled sum
+      TacsScalar w = scale;
+      if (ksType == CONTINUOUS || ksType == PNORM_CONTINUOUS) {
+        w *= weight * detXd;
       }
+      TacsKSAddValue(ksWeight, pnorm, fail, w, vals);
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSKSFailure::addThreadValues(EvaluationType ftype,
+                                    const TacsScalar vals[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+    TacsScalar sum[2] = {maxFail, ksFailSum};
+    TacsKSMergeValues(ksWeight, pnorm, vals, sum);
+    maxFail = sum[0];
+    ksFailSum = sum[1];
+  }
+}
+
 /*
   These functions are used to determine the sensitivity of the
   function with respect to the state variables.
@@ -186,9 +266,8 @@ void TACSKSFailure::getElementSVSens(
     double weight = element->getQuadraturePoint(i, pt);
 
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     // Scale failure value by safety factor
     fail *= safetyFactor;
@@ -242,9 +321,8 @@ void TACSKSFailure::getElementXptSens(
     double weight = element->getQuadraturePoint(i, pt);
 
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     // Scale failure value by safety factor
     fail *= safetyFactor;
@@ -296,9 +374,8 @@ void TACSKSFailure::addElementDVSens(
     double weight = element->getQuadraturePoint(i, pt);
 
     TacsScalar fail = 0.0, detXd = 0.0;
-    int count =
-        element->evalPointQuantity(elemIndex, TACS_FAILURE_INDEX, time, i, pt,
-                                   Xpts, vars, dvars, ddvars, &detXd, &fail);
+    int count = evalFailure(elemIndex, element, time, i, pt, Xpts, vars, dvars,
+                            ddvars, &detXd, &fail);
 
     // Scale failure value by safety factor
     fail *= safetyFactor;
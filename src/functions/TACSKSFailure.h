@@ -23,6 +23,7 @@
   Compute the KS function in TACS
 */
 
+#include "TACSFailureCache.h"
 #include "TACSFunction.h"
 
 /*
@@ -75,6 +76,10 @@ class TACSKSFailure : public TACSFunction {
   // -----------------------------------------------------------
   void setMaxFailOffset(TacsScalar _maxFail) { maxFail = _maxFail; }
 
+  // Set the object used to store and share the failure values
+  // ---------------------------------------------------------
+  void setFailureCache(TACSFailureCache *_failCache);
+
   /**
     Get the maximum failure value
   */
@@ -92,6 +97,14 @@ class TACSKSFailure : public TACSFunction {
                        TACSElement *element, double time, TacsScalar scale,
                        const TacsScalar Xpts[], const TacsScalar vars[],
                        const TacsScalar dvars[], const TacsScalar ddvars[]);
+  int getNumThreadValues(EvaluationType ftype);
+  void initThreadValues(EvaluationType ftype, TacsScalar vals[]);
+  void elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                             TACSElement *element, double time,
+                             TacsScalar scale, const TacsScalar Xpts[],
+                             const TacsScalar vars[], const TacsScalar dvars[],
+                             const TacsScalar ddvars[], TacsScalar vals[]);
+  void addThreadValues(EvaluationType ftype, const TacsScalar vals[]);
 
   /**
      Finalize the function evaluation for the specified eval type.
@@ -130,9 +143,18 @@ class TACSKSFailure : public TACSFunction {
                          const TacsScalar ddvars[], TacsScalar fXptSens[]);
 
  private:
+  // Evaluate the failure index at a point, using the cache if it is set
+  int evalFailure(int elemIndex, TACSElement *element, double time, int n,
+                  double pt[], const TacsScalar Xpts[], const TacsScalar vars[],
+                  const TacsScalar dvars[], const TacsScalar ddvars[],
+                  TacsScalar *detXd, TacsScalar *fail);
+
   // The type of aggregation to use
   KSFailureType ksType;
 
+  // The stored failure values (may be NULL)
+  TACSFailureCache *failCache;
+
   // The weight on the ks function value
   double ksWeight;
 
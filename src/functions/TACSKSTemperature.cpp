@@ -19,6 +19,7 @@
 #include "TACSKSTemperature.h"
 
 #include "TACSAssembler.h"
+#include "TACSKSAggregation.h"
 
 /*
   Initialize the TACSKSTemperature class properties
@@ -26,7 +27,7 @@
 TACSKSTemperature::TACSKSTemperature(TACSAssembler *_assembler,
                                      double _ksWeight, double _alpha)
     : TACSFunction(_assembler, TACSFunction::ENTIRE_DOMAIN,
-                   TACSFunction::TWO_STAGE, 0) {
+                   TACSFunction::SINGLE_STAGE, 0) {
   ksWeight = _ksWeight;
   alpha = _alpha;
   ksType = CONTINUOUS;
@@ -50,6 +51,7 @@ const char *TACSKSTemperature::funcName = "TACSKSTemperature";
 */
 void TACSKSTemperature::setKSTemperatureType(enum KSTemperatureType type) {
   ksType = type;
+  clearCachedValue();
 }
 
 /*
@@ -60,7 +62,10 @@ double TACSKSTemperature::getParameter() { return ksWeight; }
 /*
   Set the KS aggregation parameter
 */
-void TACSKSTemperature::setParameter(double _ksWeight) { ksWeight = _ksWeight; }
+void TACSKSTemperature::setParameter(double _ksWeight) {
+  ksWeight = _ksWeight;
+  clearCachedValue();
+}
 
 /*
   Return the function name
@@ -86,9 +91,8 @@ TacsScalar TACSKSTemperature::getMaximumTemperature() { return maxTemp; }
   Initialize the internal values stored within the KS function
 */
 void TACSKSTemperature::initEvaluation(EvaluationType ftype) {
-  if (ftype == TACSFunction::INITIALIZE) {
+  if (ftype == TACSFunction::INTEGRATE) {
     maxTemp = -1e20;
-  } else if (ftype == TACSFunction::INTEGRATE) {
     ksTempSum = 0.0;
   }
 }
@@ -97,20 +101,17 @@ void TACSKSTemperature::initEvaluation(EvaluationType ftype) {
   Reduce the function values across all MPI processes
 */
 void TACSKSTemperature::finalEvaluation(EvaluationType ftype) {
-  if (ftype == TACSFunction::INITIALIZE) {
-    // Distribute the values of the KS function computed on this domain
-    TacsScalar temp = maxTemp;
-    MPI_Allreduce(&temp, &maxTemp, 1, TACS_MPI_TYPE, TACS_MPI_MAX,
-                  assembler->getMPIComm());
-  } else {
-    // Find the sum of the ks contributions from all processes
-    TacsScalar temp = ksTempSum;
-    MPI_Allreduce(&temp, &ksTempSum, 1, TACS_MPI_TYPE, MPI_SUM,
-                  assembler->getMPIComm());
+  if (ftype == TACSFunction::INTEGRATE) {
+    // Merge the maximum and the scaled sum from all processes
+    int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+    TacsScalar vals[2] = {maxTemp, ksTempSum};
+    TacsKSAllreduceValues(assembler->getMPIComm(), ksWeight, pnorm, vals);
+    maxTemp = vals[0];
+    ksTempSum = vals[1];
 
     // Compute the P-norm quantity if needed
     invPnorm = 0.0;
-    if (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS) {
+    if (pnorm) {
       if (ksTempSum != 0.0) {
         invPnorm = pow(ksTempSum, (1.0 - ksWeight) / ksWeight);
       }
@@ -121,10 +122,55 @@ void TACSKSTemperature::finalEvaluation(EvaluationType ftype) {
 /*
   Perform the element-wise evaluation of the TACSKSTemperature function.
 */
-void TACSKSTemperature::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSKSTemperature::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                        TACSElement *element, double time,
+                                        TacsScalar scale,
+                                        const TacsScalar Xpts[],
+                                        const TacsScalar vars[],
+                                        const TacsScalar dvars[],
+                                        const TacsScalar ddvars[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    TacsScalar vals[2] = {maxTemp, ksTempSum};
+    elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                          dvars, ddvars, vals);
+    maxTemp = vals[0];
+    ksTempSum = vals[1];
+  }
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSKSTemperature::getNumThreadValues(EvaluationType ftype) { return 2; }
+
+/*
+  Initialize the values accumulated on each thread
+*/
+void TACSKSTemperature::initThreadValues(EvaluationType ftype,
+                                         TacsScalar vals[]) {
+  TacsKSInitValues(vals);
+}
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSKSTemperature::elementWiseEvalThread(EvaluationType ftype,
+                                              int elemIndex,
+                                              TACSElement *element, double time,
+                                              TacsScalar scale,
+                                              const TacsScalar Xpts[],
+                                              const TacsScalar vars[],
+                                              const TacsScalar dvars[],
+                                              const TacsScalar ddvars[],
+                                              TacsScalar vals[]) {
+  // The maximum is found while the sum is accumulated, so the
+  // initialization pass is not required
+  if (ftype != TACSFunction::INTEGRATE) {
+    return;
+  }
+  int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -138,33 +184,30 @@ void TACSKSTemperature::elementWiseEval(
 
     // Check whether the quantity requested is defined or not
     if (count >= 1) {
-      if (ftype == TACSFunction::INITIALIZE) {
-        // Set the maximum temperature
-        if (TacsRealPart(temperature) > TacsRealPart(maxTemp)) {
-          maxTemp = temperature;
-        }
-      } else {
-        // Add the temperature to the sum
-        if (ksType == DISCRETE) {
-          TacsScalar fexp = exp(ksWeight * (temperature - maxTemp));
-          ksTempSum += scale * fexp;
-        } else if (ksType == CONTINUOUS) {
-          TacsScalar fexp = exp(ksWeight * (temperature - maxTemp));
-          ksTempSum += scale * weight * detXd * fexp;
-        } else if (ksType == PNORM_DISCRETE) {
-          TacsScalar fpow =
-              pow(fabs(TacsRealPart(temperature / maxTemp)), ksWeight);
-          ksTempSum += scale * fpow;
-        } else if (ksType == PNORM_CONTINUOUS) {
-          TacsScalar fpow =
-              pow(fabs(TacsRealPart(temperature / maxTemp)), ksWeight);
-          ksTempSum += scale * weight * detXd * fpow;
-        }
+      // Add the temperature to the running maximum and scaled sum
+      TacsScalar w = scale;
+      if (ksType == CONTINUOUS || ksType == PNORM_CONTINUOUS) {
+        w *= weight * detXd;
       }
+      TacsKSAddValue(ksWeight, pnorm, temperature, w, vals);
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSKSTemperature::addThreadValues(EvaluationType ftype,
+                                        const TacsScalar vals[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    int pnorm = (ksType == PNORM_DISCRETE || ksType == PNORM_CONTINUOUS);
+    TacsScalar sum[2] = {maxTemp, ksTempSum};
+    TacsKSMergeValues(ksWeight, pnorm, vals, sum);
+    maxTemp = sum[0];
+    ksTempSum = sum[1];
+  }
+}
+
 /*
   These functions are used to determine the sensitivity of the
   function with respect to the state variables.
@@ -0,0 +1,502 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSMassProperties.h"
+
+/*
+  The index of each inertia component returned by the element. 2D
+  elements return the xx, xy and yy components only.
+*/
+static const int inertia_index_2d[] = {0, 1, 3};
+static const int inertia_index_3d[] = {0, 1, 2, 3, 4, 5};
+
+static inline const int *getInertiaIndex(int count) {
+  if (count == 3) {
+    return inertia_index_2d;
+  }
+  return inertia_index_3d;
+}
+
+/*
+  Allocate storage for the values of each local element
+
+  @param assembler The finite-element model
+*/
+TACSMassProperties::TACSMassProperties(TACSAssembler *_assembler) {
+  assembler = _assembler;
+  assembler->incref();
+
+  TACSElement **elements = assembler->getElements();
+  num_elements = assembler->getNumElements();
+  const int maxDVs = assembler->getMaxElementDesignVars();
+  const int dvsPerNode = assembler->getDesignVarsPerNode();
+  int *dvNums = new int[maxDVs];
+
+  dv_ptr = new int[num_elements + 1];
+  xpt_ptr = new int[num_elements + 1];
+  dv_ptr[0] = xpt_ptr[0] = 0;
+  for (int i = 0; i < num_elements; i++) {
+    int numDVs = elements[i]->getDesignVarNums(i, maxDVs, dvNums);
+    dv_ptr[i + 1] = dv_ptr[i] + dvsPerNode * numDVs;
+    xpt_ptr[i + 1] = xpt_ptr[i] + 3 * elements[i]->getNumNodes();
+  }
+  delete[] dvNums;
+
+  dv_values = new TacsScalar[dv_ptr[num_elements]];
+  xpt_values = new TacsScalar[xpt_ptr[num_elements]];
+  elem_values = new TacsScalar[NUM_MASS_PROPERTIES * num_elements];
+
+  mass = 0.0;
+  moment[0] = moment[1] = moment[2] = 0.0;
+  for (int j = 0; j < 6; j++) {
+    inertia[j] = 0.0;
+  }
+
+  num_updated = 0;
+  invalidate();
+}
+
+TACSMassProperties::~TACSMassProperties() {
+  assembler->decref();
+  delete[] dv_ptr;
+  delete[] xpt_ptr;
+  delete[] dv_values;
+  delete[] xpt_values;
+  delete[] elem_values;
+}
+
+/*
+  Invalidate the stored values so that the next evaluation
+  re-integrates every element
+*/
+void TACSMassProperties::invalidate() {
+  design_version = -1;
+  for (int i = 0; i < NUM_MASS_PROPERTIES * num_elements; i++) {
+    elem_values[i] = 0.0;
+  }
+  for (int i = 0; i < num_elements; i++) {
+    elem_values[NUM_MASS_PROPERTIES * i] = -1.0;
+  }
+}
+
+/*
+  Re-integrate the elements whose design variables or node locations
+  have changed since the last evaluation and sum the element values
+
+  An element with a negative stored mass has not been evaluated.
+*/
+void TACSMassProperties::updateElementValues() {
+  num_updated = 0;
+  if (design_version == assembler->getDesignVersion()) {
+    return;
+  }
+
+  const int maxDVs = assembler->getMaxElementDesignVars();
+  const int dvsPerNode = assembler->getDesignVarsPerNode();
+  const int maxVars = assembler->getMaxElementVariables();
+  const int maxNodes = assembler->getMaxElementNodes();
+  const double time = assembler->getSimulationTime();
+
+  TacsScalar *dvs = new TacsScalar[dvsPerNode * maxDVs];
+  TacsScalar *Xpts = new TacsScalar[3 * maxNodes];
+  TacsScalar *vars = new TacsScalar[3 * maxVars];
+  TacsScalar *dvars = &vars[maxVars];
+  TacsScalar *ddvars = &vars[2 * maxVars];
+
+  for (int elemIndex = 0; elemIndex < num_elements; elemIndex++) {
+    TACSElement *element =
+        assembler->getElement(elemIndex, Xpts, vars, dvars, ddvars);
+    element->getDesignVars(elemIndex, maxDVs, dvs);
+
+    // Compare the design variables and nodes with the stored values
+    TacsScalar *values = &elem_values[NUM_MASS_PROPERTIES * elemIndex];
+    int changed = (TacsRealPart(values[0]) < 0.0);
+    for (int j = dv_ptr[elemIndex], k = 0; j < dv_ptr[elemIndex + 1];
+         j++, k++) {
+      if (dv_values[j] != dvs[k]) {
+        dv_values[j] = dvs[k];
+        changed = 1;
+      }
+    }
+    for (int j = xpt_ptr[elemIndex], k = 0; j < xpt_ptr[elemIndex + 1];
+         j++, k++) {
+      if (xpt_values[j] != Xpts[k]) {
+        xpt_values[j] = Xpts[k];
+        changed = 1;
+      }
+    }
+    if (!changed) {
+      continue;
+    }
+
+    num_updated++;
+    memset(values, 0, NUM_MASS_PROPERTIES * sizeof(TacsScalar));
+    for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
+      double pt[3];
+      double weight = element->getQuadraturePoint(i, pt);
+
+      TacsScalar detXd = 0.0, density = 0.0;
+      int count = element->evalPointQuantity(
+          elemIndex, TACS_ELEMENT_DENSITY, time, i, pt, Xpts, vars, dvars,
+          ddvars, &detXd, &density);
+      if (count >= 1) {
+        values[0] += weight * detXd * density;
+      }
+
+      TacsScalar densityMoment[3];
+      count = element->evalPointQuantity(elemIndex, TACS_ELEMENT_DENSITY_MOMENT,
+                                         time, i, pt, Xpts, vars, dvars,
+                                         ddvars, &detXd, densityMoment);
+      for (int j = 0; j < count && j < 3; j++) {
+        values[1 + j] += weight * detXd * densityMoment[j];
+      }
+
+      TacsScalar I0[6];
+      count = element->evalPointQuantity(
+          elemIndex, TACS_ELEMENT_MOMENT_OF_INERTIA, time, i, pt, Xpts, vars,
+          dvars, ddvars, &detXd, I0);
+      if (count >= 1) {
+        const int *index = getInertiaIndex(count);
+        for (int j = 0; j < count && j < 6; j++) {
+          values[4 + index[j]] += weight * detXd * I0[j];
+        }
+      }
+    }
+  }
+
+  delete[] dvs;
+  delete[] Xpts;
+  delete[] vars;
+
+  // Sum the stored element values and the values across all processors
+  TacsScalar sum[NUM_MASS_PROPERTIES];
+  memset(sum, 0, NUM_MASS_PROPERTIES * sizeof(TacsScalar));
+  for (int i = 0; i < num_elements; i++) {
+    for (int j = 0; j < NUM_MASS_PROPERTIES; j++) {
+      sum[j] += elem_values[NUM_MASS_PROPERTIES * i + j];
+    }
+  }
+
+  TacsScalar total[NUM_MASS_PROPERTIES];
+  MPI_Allreduce(sum, total, NUM_MASS_PROPERTIES, TACS_MPI_TYPE, MPI_SUM,
+                assembler->getMPIComm());
+  mass = total[0];
+  for (int j = 0; j < 3; j++) {
+    moment[j] = total[1 + j];
+  }
+  for (int j = 0; j < 6; j++) {
+    inertia[j] = total[4 + j];
+  }
+
+  design_version = assembler->getDesignVersion();
+}
+
+/*
+  Evaluate the mass properties of the model
+
+  This call is collective on all processors in the assembler.
+
+  @param props The mass, center of mass and inertia tensor about the
+  center of mass
+*/
+void TACSMassProperties::evalMassProperties(TacsScalar props[]) {
+  updateElementValues();
+
+  // Move the inertia tensor to the center of mass using the parallel
+  // axis theorem, I = I0 - (|M|^2*delta - M*M^T)/m
+  const TacsScalar *M = moment;
+  TacsScalar T[6];
+  T[0] = M[1] * M[1] + M[2] * M[2];
+  T[1] = -M[0] * M[1];
+  T[2] = -M[0] * M[2];
+  T[3] = M[0] * M[0] + M[2] * M[2];
+  T[4] = -M[1] * M[2];
+  T[5] = M[0] * M[0] + M[1] * M[1];
+
+  props[0] = mass;
+  for (int j = 0; j < 3; j++) {
+    props[1 + j] = M[j] / mass;
+  }
+  for (int j = 0; j < 6; j++) {
+    props[4 + j] = inertia[j] - T[j] / mass;
+  }
+}
+
+/*
+  Convert the seeds for the mass properties to seeds for the mass,
+  first moment of mass and inertia tensor about the origin
+*/
+void TACSMassProperties::getQuantitySeeds(int numSeeds,
+                                          const TacsScalar seeds[],
+                                          TacsScalar qseeds[]) {
+  const TacsScalar *M = moment;
+  const TacsScalar m = mass;
+
+  // The parallel axis term and its derivative w.r.t. M
+  TacsScalar T[6];
+  T[0] = M[1] * M[1] + M[2] * M[2];
+  T[1] = -M[0] * M[1];
+  T[2] = -M[0] * M[2];
+  T[3] = M[0] * M[0] + M[2] * M[2];
+  T[4] = -M[1] * M[2];
+  T[5] = M[0] * M[0] + M[1] * M[1];
+
+  const TacsScalar dT[6][3] = {{0.0, 2.0 * M[1], 2.0 * M[2]},
+                               {-M[1], -M[0], 0.0},
+                               {-M[2], 0.0, -M[0]},
+                               {2.0 * M[0], 0.0, 2.0 * M[2]},
+                               {0.0, -M[2], -M[1]},
+                               {2.0 * M[0], 2.0 * M[1], 0.0}};
+
+  for (int k = 0; k < numSeeds; k++) {
+    const TacsScalar *s = &seeds[NUM_MASS_PROPERTIES * k];
+    TacsScalar *q = &qseeds[NUM_MASS_PROPERTIES * k];
+
+    q[0] = s[0];
+    for (int i = 0; i < 3; i++) {
+      q[0] -= s[1 + i] * M[i] / (m * m);
+      q[1 + i] = s[1 + i] / m;
+    }
+    for (int j = 0; j < 6; j++) {
+      q[0] += s[4 + j] * T[j] / (m * m);
+      for (int i = 0; i < 3; i++) {
+        q[1 + i] -= s[4 + j] * dT[j][i] / m;
+      }
+      q[4 + j] = s[4 + j];
+    }
+  }
+}
+
+/*
+  Add the derivatives of the seeded combinations of the mass
+  properties w.r.t. the design variables
+
+  The derivatives for all of the seeds are computed in a single pass
+  over the elements. As in TACSAssembler::addDVSens(), the values are
+  added to the vectors but the caller must call beginSetValues() and
+  endSetValues() on each vector.
+
+  @param numSeeds The number of combinations
+  @param seeds The seeds for each property (numSeeds*NUM_MASS_PROPERTIES)
+  @param dfdx The derivative vectors
+*/
+void TACSMassProperties::addDVSens(int numSeeds, const TacsScalar seeds[],
+                                   TACSBVec **dfdx) {
+  updateElementValues();
+
+  TacsScalar *qseeds = new TacsScalar[NUM_MASS_PROPERTIES * numSeeds];
+  getQuantitySeeds(numSeeds, seeds, qseeds);
+
+  const int maxDVs = assembler->getMaxElementDesignVars();
+  const int dvsPerNode = assembler->getDesignVarsPerNode();
+  const int maxVars = assembler->getMaxElementVariables();
+  const int maxNodes = assembler->getMaxElementNodes();
+  const double time = assembler->getSimulationTime();
+  const int dvSize = dvsPerNode * maxDVs;
+
+  int *dvNums = new int[maxDVs];
+  TacsScalar *fdvSens = new TacsScalar[numSeeds * dvSize];
+  TacsScalar *Xpts = new TacsScalar[3 * maxNodes];
+  TacsScalar *vars = new TacsScalar[3 * maxVars];
+  TacsScalar *dvars = &vars[maxVars];
+  TacsScalar *ddvars = &vars[2 * maxVars];
+
+  for (int elemIndex = 0; elemIndex < num_elements; elemIndex++) {
+    TACSElement *element =
+        assembler->getElement(elemIndex, Xpts, vars, dvars, ddvars);
+    int numDVs = element->getDesignVarNums(elemIndex, maxDVs, dvNums);
+    if (numDVs <= 0) {
+      continue;
+    }
+    memset(fdvSens, 0, numSeeds * dvSize * sizeof(TacsScalar));
+
+    for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
+      double pt[3];
+      double weight = element->getQuadraturePoint(i, pt);
+
+      TacsScalar detXd = 0.0, density = 0.0;
+      int count = element->evalPointQuantity(
+          elemIndex, TACS_ELEMENT_DENSITY, time, i, pt, Xpts, vars, dvars,
+          ddvars, &detXd, &density);
+      if (count >= 1) {
+        for (int k = 0; k < numSeeds; k++) {
+          TacsScalar dfdq = weight * detXd * qseeds[NUM_MASS_PROPERTIES * k];
+          element->addPointQuantityDVSens(
+              elemIndex, TACS_ELEMENT_DENSITY, time, 1.0, i, pt, Xpts, vars,
+              dvars, ddvars, &dfdq, maxDVs, &fdvSens[k * dvSize]);
+        }
+      }
+
+      TacsScalar densityMoment[3];
+      count = element->evalPointQuantity(elemIndex, TACS_ELEMENT_DENSITY_MOMENT,
+                                         time, i, pt, Xpts, vars, dvars,
+                                         ddvars, &detXd, densityMoment);
+      if (count >= 1) {
+        for (int k = 0; k < numSeeds; k++) {
+          const TacsScalar *q = &qseeds[NUM_MASS_PROPERTIES * k];
+          TacsScalar dfdq[3] = {0.0, 0.0, 0.0};
+          for (int j = 0; j < count && j < 3; j++) {
+            dfdq[j] = weight * detXd * q[1 + j];
+          }
+          element->addPointQuantityDVSens(
+              elemIndex, TACS_ELEMENT_DENSITY_MOMENT, time, 1.0, i, pt, Xpts,
+              vars, dvars, ddvars, dfdq, maxDVs, &fdvSens[k * dvSize]);
+        }
+      }
+
+      TacsScalar I0[6];
+      count = element->evalPointQuantity(
+          elemIndex, TACS_ELEMENT_MOMENT_OF_INERTIA, time, i, pt, Xpts, vars,
+          dvars, ddvars, &detXd, I0);
+      if (count >= 1) {
+        const int *index = getInertiaIndex(count);
+        for (int k = 0; k < numSeeds; k++) {
+          const TacsScalar *q = &qseeds[NUM_MASS_PROPERTIES * k];
+          TacsScalar dfdq[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+          for (int j = 0; j < count && j < 6; j++) {
+            dfdq[j] = weight * detXd * q[4 + index[j]];
+          }
+          element->addPointQuantityDVSens(
+              elemIndex, TACS_ELEMENT_MOMENT_OF_INERTIA, time, 1.0, i, pt,
+              Xpts, vars, dvars, ddvars, dfdq, maxDVs, &fdvSens[k * dvSize]);
+        }
+      }
+    }
+
+    for (int k = 0; k < numSeeds; k++) {
+      if (dfdx[k]) {
+        dfdx[k]->setValues(numDVs, dvNums, &fdvSens[k * dvSize],
+                           TACS_ADD_VALUES);
+      }
+    }
+  }
+
+  delete[] qseeds;
+  delete[] dvNums;
+  delete[] fdvSens;
+  delete[] Xpts;
+  delete[] vars;
+}
+
+/*
+  Add the derivatives of the seeded combinations of the mass
+  properties w.r.t. the node locations
+
+  The derivatives for all of the seeds are computed in a single pass
+  over the elements. The caller must call beginSetValues() and
+  endSetValues() on each vector.
+
+  @param numSeeds The number of combinations
+  @param seeds The seeds for each property (numSeeds*NUM_MASS_PROPERTIES)
+  @param dfdXpts The derivative vectors
+*/
+void TACSMassProperties::addXptSens(int numSeeds, const TacsScalar seeds[],
+                                    TACSBVec **dfdXpts) {
+  updateElementValues();
+
+  TacsScalar *qseeds = new TacsScalar[NUM_MASS_PROPERTIES * numSeeds];
+  getQuantitySeeds(numSeeds, seeds, qseeds);
+
+  const int maxVars = assembler->getMaxElementVariables();
+  const int maxNodes = assembler->getMaxElementNodes();
+  const double time = assembler->getSimulationTime();
+  const int xptSize = 3 * maxNodes;
+
+  TacsScalar *fXptSens = new TacsScalar[numSeeds * xptSize];
+  TacsScalar *Xpts = new TacsScalar[xptSize];
+  TacsScalar *vars = new TacsScalar[3 * maxVars];
+  TacsScalar *dvars = &vars[maxVars];
+  TacsScalar *ddvars = &vars[2 * maxVars];
+
+  for (int elemIndex = 0; elemIndex < num_elements; elemIndex++) {
+    TACSElement *element =
+        assembler->getElement(elemIndex, Xpts, vars, dvars, ddvars);
+    int len;
+    const int *nodes;
+    assembler->getElement(elemIndex, &len, &nodes);
+    memset(fXptSens, 0, numSeeds * xptSize * sizeof(TacsScalar));
+
+    for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
+      double pt[3];
+      double weight = element->getQuadraturePoint(i, pt);
+
+      TacsScalar detXd = 0.0, density = 0.0;
+      int count = element->evalPointQuantity(
+          elemIndex, TACS_ELEMENT_DENSITY, time, i, pt, Xpts, vars, dvars,
+          ddvars, &detXd, &density);
+      if (count >= 1) {
+        for (int k = 0; k < numSeeds; k++) {
+          const TacsScalar q = qseeds[NUM_MASS_PROPERTIES * k];
+          TacsScalar dfdq = weight * detXd * q;
+          TacsScalar dfddetXd = weight * density * q;
+          element->addPointQuantityXptSens(
+              elemIndex, TACS_ELEMENT_DENSITY, time, 1.0, i, pt, Xpts, vars,
+              dvars, ddvars, dfddetXd, &dfdq, &fXptSens[k * xptSize]);
+        }
+      }
+
+      TacsScalar densityMoment[3];
+      count = element->evalPointQuantity(elemIndex, TACS_ELEMENT_DENSITY_MOMENT,
+                                         time, i, pt, Xpts, vars, dvars,
+                                         ddvars, &detXd, densityMoment);
+      if (count >= 1) {
+        for (int k = 0; k < numSeeds; k++) {
+          const TacsScalar *q = &qseeds[NUM_MASS_PROPERTIES * k];
+          TacsScalar dfdq[3] = {0.0, 0.0, 0.0};
+          TacsScalar dfddetXd = 0.0;
+          for (int j = 0; j < count && j < 3; j++) {
+            dfdq[j] = weight * detXd * q[1 + j];
+            dfddetXd += weight * densityMoment[j] * q[1 + j];
+          }
+          element->addPointQuantityXptSens(
+              elemIndex, TACS_ELEMENT_DENSITY_MOMENT, time, 1.0, i, pt, Xpts,
+              vars, dvars, ddvars, dfddetXd, dfdq, &fXptSens[k * xptSize]);
+        }
+      }
+
+      TacsScalar I0[6];
+      count = element->evalPointQuantity(
+          elemIndex, TACS_ELEMENT_MOMENT_OF_INERTIA, time, i, pt, Xpts, vars,
+          dvars, ddvars, &detXd, I0);
+      if (count >= 1) {
+        const int *index = getInertiaIndex(count);
+        for (int k = 0; k < numSeeds; k++) {
+          const TacsScalar *q = &qseeds[NUM_MASS_PROPERTIES * k];
+          TacsScalar dfdq[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+          TacsScalar dfddetXd = 0.0;
+          for (int j = 0; j < count && j < 6; j++) {
+            dfdq[j] = weight * detXd * q[4 + index[j]];
+            dfddetXd += weight * I0[j] * q[4 + index[j]];
+          }
+          element->addPointQuantityXptSens(
+              elemIndex, TACS_ELEMENT_MOMENT_OF_INERTIA, time, 1.0, i, pt,
+              Xpts, vars, dvars, ddvars, dfddetXd, dfdq,
+              &fXptSens[k * xptSize]);
+        }
+      }
+    }
+
+    for (int k = 0; k < numSeeds; k++) {
+      if (dfdXpts[k]) {
+        dfdXpts[k]->setValues(len, nodes, &fXptSens[k * xptSize],
+                              TACS_ADD_VALUES);
+      }
+    }
+  }
+
+  delete[] qseeds;
+  delete[] fXptSens;
+  delete[] Xpts;
+  delete[] vars;
+}
@@ -0,0 +1,98 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_MASS_PROPERTIES_H
+#define TACS_MASS_PROPERTIES_H
+
+#include "TACSAssembler.h"
+
+/*
+  Evaluate the mass, center of mass and inertia tensor of the model
+  in a single pass over the elements
+
+  TACSStructuralMass, TACSCenterOfMass and TACSMomentOfInertia each
+  integrate the density over all of the elements, and each evaluates
+  its own derivatives in a separate pass. This object integrates the
+  mass, the first moment of mass and the inertia tensor about the
+  origin together and stores the contribution from each element. When
+  the design variables or nodes change, only the elements whose design
+  variable values or node locations differ from the stored values are
+  re-integrated.
+
+  The mass properties are returned in the order
+
+  props = [m, cx, cy, cz, Ixx, Ixy, Ixz, Iyy, Iyz, Izz]
+
+  where c is the center of mass and I is the inertia tensor about the
+  center of mass, with the same sign convention as TACSMomentOfInertia.
+  For 2D elements, only Ixx, Ixy and Iyy are non-zero.
+
+  The derivatives of any number of linear combinations of the mass
+  properties are computed in a single pass. Each combination is given
+  by a row of seeds in the same order as the properties.
+*/
+class TACSMassProperties : public TACSObject {
+ public:
+  static const int NUM_MASS_PROPERTIES = 10;
+
+  TACSMassProperties(TACSAssembler *_assembler);
+  ~TACSMassProperties();
+
+  // Evaluate the mass properties of the model
+  // -----------------------------------------
+  void evalMassProperties(TacsScalar props[]);
+
+  // Add the derivatives of the seeded combinations of the properties
+  // ----------------------------------------------------------------
+  void addDVSens(int numSeeds, const TacsScalar seeds[], TACSBVec **dfdx);
+  void addXptSens(int numSeeds, const TacsScalar seeds[], TACSBVec **dfdXpts);
+
+  // Force the re-evaluation of all the element values
+  // -------------------------------------------------
+  void invalidate();
+
+  // Get the number of elements re-integrated in the last evaluation
+  // ---------------------------------------------------------------
+  int getNumUpdatedElements() { return num_updated; }
+
+ private:
+  // Update the stored element values
+  void updateElementValues();
+
+  // Compute the seeds for the integrated quantities
+  void getQuantitySeeds(int numSeeds, const TacsScalar seeds[],
+                        TacsScalar qseeds[]);
+
+  // The finite-element model
+  TACSAssembler *assembler;
+  int num_elements;
+
+  // The design version of the stored values
+  int design_version;
+  int num_updated;
+
+  // The design variable values and node locations of each element at
+  // the last evaluation
+  int *dv_ptr, *xpt_ptr;
+  TacsScalar *dv_values, *xpt_values;
+
+  // The mass, first moment of mass and inertia tensor about the
+  // origin integrated over each element
+  TacsScalar *elem_values;
+
+  // The values integrated over the whole model
+  TacsScalar mass, moment[3], inertia[6];
+};
+
+#endif  // TACS_MASS_PROPERTIES_H
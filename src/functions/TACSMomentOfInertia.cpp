@@ -97,10 +97,42 @@ void TACSMomentOfInertia::finalEvaluation(EvaluationType ftype) {
 /*
   Perform the element-wise evaluation of the TACSMomentOfInertia function.
 */
-void TACSMomentOfInertia::elementWiseEval(
-    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
-    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
-    const TacsScalar dvars[], const TacsScalar ddvars[]) {
+void TACSMomentOfInertia::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                          TACSElement *element, double time,
+                                          TacsScalar scale,
+                                          const TacsScalar Xpts[],
+                                          const TacsScalar vars[],
+                                          const TacsScalar dvars[],
+                                          const TacsScalar ddvars[]) {
+  TacsScalar vals[5] = {totalMass, massMoment[0], massMoment[1],
+                        massMoment[2], I0};
+  elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                        dvars, ddvars, vals);
+  totalMass = vals[0];
+  massMoment[0] = vals[1];
+  massMoment[1] = vals[2];
+  massMoment[2] = vals[3];
+  I0 = vals[4];
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSMomentOfInertia::getNumThreadValues(EvaluationType ftype) { return 5; }
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values
+*/
+void TACSMomentOfInertia::elementWiseEvalThread(EvaluationType ftype,
+                                                int elemIndex,
+                                                TACSElement *element,
+                                                double time, TacsScalar scale,
+                                                const TacsScalar Xpts[],
+                                                const TacsScalar vars[],
+                                                const TacsScalar dvars[],
+                                                const TacsScalar ddvars[],
+                                                TacsScalar vals[]) {
   for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
     double pt[3];
     double weight = element->getQuadraturePoint(i, pt);
@@ -114,7 +146,7 @@ void TACSMomentOfInertia::elementWiseEval(
                                          &detXd, &density);
 
       if (count >= 1) {
-        totalMass += scale * weight * detXd * density;
+        vals[0] += scale * weight * detXd * density;
       }
 
       TacsScalar densityMoment[3];
@@ -123,7 +155,7 @@ void TACSMomentOfInertia::elementWiseEval(
                                          &detXd, densityMoment);
 
       for (int j = 0; j < count; j++) {
-        massMoment[j] += scale * weight * detXd * densityMoment[j];
+        vals[1 + j] += scale * weight * detXd * densityMoment[j];
       }
     }
 
@@ -137,11 +169,23 @@ void TACSMomentOfInertia::elementWiseEval(
     TacsScalar ip[6];
     getInnerProductFactor(count, ip);
     for (int j = 0; j < count; j++) {
-      I0 += scale * weight * detXd * I0_elem[j] * ip[j];
+      vals[4] += scale * weight * detXd * I0_elem[j] * ip[j];
     }
   }
 }
 
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSMomentOfInertia::addThreadValues(EvaluationType ftype,
+                                          const TacsScalar vals[]) {
+  totalMass += vals[0];
+  massMoment[0] += vals[1];
+  massMoment[1] += vals[2];
+  massMoment[2] += vals[3];
+  I0 += vals[4];
+}
+
 /*
   Determine the derivative of the mass w.r.t. the material
   design variables
@@ -0,0 +1,309 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSRMSStress.h"
+
+#include "TACSAssembler.h"
+#include "TACSKSAggregation.h"
+#include "TACSStressMeasures.h"
+
+/*
+  Create the RMS stress function
+
+  input:
+  assembler:  the TACSAssembler object
+  random:     the random vibration analysis with the covariance
+  ksWeight:   the KS aggregation weight
+  sigmaRef:   the reference stress
+*/
+TACSRMSStress::TACSRMSStress(TACSAssembler *_assembler,
+                             TACSRandomVibration *_random, double _ksWeight,
+                             double _sigmaRef)
+    : TACSFunction(_assembler, TACSFunction::ENTIRE_DOMAIN,
+                   TACSFunction::SINGLE_STAGE, 0) {
+  random = _random;
+  random->incref();
+  ksWeight = _ksWeight;
+  sigmaRef = _sigmaRef;
+
+  maxRMS = -1e20;
+  ksSum = 0.0;
+}
+
+TACSRMSStress::~TACSRMSStress() { random->decref(); }
+
+const char *TACSRMSStress::funcName = "TACSRMSStress";
+
+/*
+  Return the function name
+*/
+const char *TACSRMSStress::getObjectName() { return funcName; }
+
+/*
+  Retrieve the KS aggregation weight
+*/
+double TACSRMSStress::getParameter() { return ksWeight; }
+
+/*
+  Set the KS aggregation parameter
+*/
+void TACSRMSStress::setParameter(double _ksWeight) {
+  ksWeight = _ksWeight;
+  clearCachedValue();
+}
+
+/*
+  Retrieve the function value
+*/
+TacsScalar TACSRMSStress::getFunctionValue() {
+  return maxRMS + log(ksSum) / ksWeight;
+}
+
+/*
+  Retrieve the maximum value
+*/
+TacsScalar TACSRMSStress::getMaximumRMSStress() { return maxRMS; }
+
+/*
+  Evaluate the modal stresses and the RMS stress at a quadrature point
+
+  The stress for mode j is stored at modeStress[MAX_STRESS_COMPONENTS*j]
+  and the RMS stress is divided by the reference stress. Returns the
+  number of stress components, which is zero when the element does not
+  define the stress.
+*/
+int TACSRMSStress::evalRMSStress(int elemIndex, TACSElement *element,
+                                 double time, int n, double pt[],
+                                 const TacsScalar Xpts[],
+                                 const TacsScalar modeVars[],
+                                 const TacsScalar dvars[],
+                                 const TacsScalar ddvars[], TacsScalar *detXd,
+                                 TacsScalar modeStress[], TacsScalar *rms) {
+  const int numModes = random->getNumModes();
+  const int numVars = element->getNumVariables();
+  const TacsScalar *cov = random->getCovariance();
+
+  int count = 0;
+  for (int j = 0; j < numModes; j++) {
+    count = element->evalPointQuantity(
+        elemIndex, TACS_ELEMENT_STRESS, time, n, pt, Xpts,
+        &modeVars[numVars * j], dvars, ddvars, detXd,
+        &modeStress[MAX_STRESS_COMPONENTS * j]);
+    if (count < 1 || count > MAX_STRESS_COMPONENTS) {
+      return 0;
+    }
+  }
+
+  // E[vm^2] = sum_{jk} Q_jk*s_j^T V s_k
+  TacsScalar ms = 0.0;
+  for (int k = 0; k < numModes; k++) {
+    TacsScalar vs[MAX_STRESS_COMPONENTS];
+    TacsVonMisesProduct(count, &modeStress[MAX_STRESS_COMPONENTS * k], vs);
+    for (int j = 0; j < numModes; j++) {
+      const TacsScalar *sj = &modeStress[MAX_STRESS_COMPONENTS * j];
+      TacsScalar prod = 0.0;
+      for (int i = 0; i < count; i++) {
+        prod += sj[i] * vs[i];
+      }
+      ms += cov[numModes * j + k] * prod;
+    }
+  }
+
+  *rms = 0.0;
+  if (TacsRealPart(ms) > 0.0) {
+    *rms = sqrt(ms) / sigmaRef;
+  }
+
+  return count;
+}
+
+/*
+  Initialize the internal values stored within the KS function
+*/
+void TACSRMSStress::initEvaluation(EvaluationType ftype) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    maxRMS = -1e20;
+    ksSum = 0.0;
+  }
+}
+
+/*
+  Reduce the function values across all MPI processes
+*/
+void TACSRMSStress::finalEvaluation(EvaluationType ftype) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    TacsScalar vals[2] = {maxRMS, ksSum};
+    TacsKSAllreduceValues(assembler->getMPIComm(), ksWeight, 0, vals);
+    maxRMS = vals[0];
+    ksSum = vals[1];
+  }
+}
+
+/*
+  Perform the element-wise evaluation of the function
+*/
+void TACSRMSStress::elementWiseEval(EvaluationType ftype, int elemIndex,
+                                    TACSElement *element, double time,
+                                    TacsScalar scale, const TacsScalar Xpts[],
+                                    const TacsScalar vars[],
+                                    const TacsScalar dvars[],
+                                    const TacsScalar ddvars[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    TacsScalar vals[2] = {maxRMS, ksSum};
+    elementWiseEvalThread(ftype, elemIndex, element, time, scale, Xpts, vars,
+                          dvars, ddvars, vals);
+    maxRMS = vals[0];
+    ksSum = vals[1];
+  }
+}
+
+/*
+  Get the number of values accumulated on each thread
+*/
+int TACSRMSStress::getNumThreadValues(EvaluationType ftype) { return 2; }
+
+/*
+  Initialize the values accumulated on each thread
+*/
+void TACSRMSStress::initThreadValues(EvaluationType ftype, TacsScalar vals[]) {
+  TacsKSInitValues(vals);
+}
+
+/*
+  Perform the element-wise evaluation, accumulating the result into
+  the thread values. The modal variables of the element are read once
+  and used at all quadrature points.
+*/
+void TACSRMSStress::elementWiseEvalThread(
+    EvaluationType ftype, int elemIndex, TACSElement *element, double time,
+    TacsScalar scale, const TacsScalar Xpts[], const TacsScalar vars[],
+    const TacsScalar dvars[], const TacsScalar ddvars[], TacsScalar vals[]) {
+  const int numModes = random->getNumModes();
+  if (ftype != TACSFunction::INTEGRATE || numModes == 0 ||
+      !random->getCovariance()) {
+    return;
+  }
+
+  TacsScalar *modeVars =
+      new TacsScalar[numModes * element->getNumVariables()];
+  TacsScalar *modeStress = new TacsScalar[numModes * MAX_STRESS_COMPONENTS];
+  random->getElementModeVars(elemIndex, modeVars);
+
+  for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
+    double pt[3];
+    double weight = element->getQuadraturePoint(i, pt);
+
+    TacsScalar rms = 0.0, detXd = 0.0;
+    int count = evalRMSStress(elemIndex, element, time, i, pt, Xpts, modeVars,
+                              dvars, ddvars, &detXd, modeStress, &rms);
+    if (count >= 1) {
+      TacsKSAddValue(ksWeight, 0, rms, scale * weight * detXd, vals);
+    }
+  }
+
+  delete[] modeVars;
+  delete[] modeStress;
+}
+
+/*
+  Add the values accumulated on a thread to the function
+*/
+void TACSRMSStress::addThreadValues(EvaluationType ftype,
+                                    const TacsScalar vals[]) {
+  if (ftype == TACSFunction::INTEGRATE) {
+    TacsScalar sum[2] = {maxRMS, ksSum};
+    TacsKSMergeValues(ksWeight, 0, vals, sum);
+    maxRMS = sum[0];
+    ksSum = sum[1];
+  }
+}
+
+/*
+  The function does not depend on the state variables
+*/
+void TACSRMSStress::getElementSVSens(
+    int elemIndex, TACSElement *element, double time, TacsScalar alpha,
+    TacsScalar beta, TacsScalar gamma, const TacsScalar Xpts[],
+    const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], TacsScalar dfdu[]) {
+  int numVars = element->getNumVariables();
+  memset(dfdu, 0, numVars * sizeof(TacsScalar));
+}
+
+/*
+  Add the derivative of the function w.r.t. the design variables with
+  the modes and the covariance held fixed
+
+  d(rms)/d(s_j) = V*(sum_k Q_jk*s_k)/(sigmaRef^2*rms)
+*/
+void TACSRMSStress::addElementDVSens(
+    int elemIndex, TACSElement *element, double time, TacsScalar scale,
+    const TacsScalar Xpts[], const TacsScalar vars[], const TacsScalar dvars[],
+    const TacsScalar ddvars[], int dvLen, TacsScalar dfdx[]) {
+  const int numModes = random->getNumModes();
+  const TacsScalar *cov = random->getCovariance();
+  if (numModes == 0 || !cov) {
+    return;
+  }
+
+  const int numVars = element->getNumVariables();
+  TacsScalar *modeVars = new TacsScalar[numModes * numVars];
+  TacsScalar *modeStress = new TacsScalar[numModes * MAX_STRESS_COMPONENTS];
+  random->getElementModeVars(elemIndex, modeVars);
+
+  for (int i = 0; i < element->getNumQuadraturePoints(); i++) {
+    double pt[3];
+    double weight = element->getQuadraturePoint(i, pt);
+
+    TacsScalar rms = 0.0, detXd = 0.0;
+    int count = evalRMSStress(elemIndex, element, time, i, pt, Xpts, modeVars,
+                              dvars, ddvars, &detXd, modeStress, &rms);
+    if (count < 1 || TacsRealPart(rms) <= 0.0) {
+      continue;
+    }
+
+    // The derivative of the function w.r.t. the RMS stress
+    TacsScalar dfdrms = weight * detXd * exp(ksWeight * (rms - maxRMS)) / ksSum;
+    dfdrms /= sigmaRef * sigmaRef * rms;
+
+    for (int j = 0; j < numModes; j++) {
+      TacsScalar s[MAX_STRESS_COMPONENTS], dfdq[MAX_STRESS_COMPONENTS];
+      for (int l = 0; l < count; l++) {
+        s[l] = 0.0;
+      }
+      for (int k = 0; k < numModes; k++) {
+        const TacsScalar *sk = &modeStress[MAX_STRESS_COMPONENTS * k];
+        for (int l = 0; l < count; l++) {
+          s[l] += cov[numModes * j + k] * sk[l];
+        }
+      }
+      TacsVonMisesProduct(count, s, dfdq);
+      for (int l = 0; l < count; l++) {
+        dfdq[l] *= dfdrms;
+      }
+
+      element->addPointQuantityDVSens(elemIndex, TACS_ELEMENT_STRESS, time,
+                                      scale, i, pt, Xpts,
+                                      &modeVars[numVars * j], dvars, ddvars,
+                                      dfdq, dvLen, dfdx);
+    }
+  }
+
+  delete[] modeVars;
+  delete[] modeStress;
+}
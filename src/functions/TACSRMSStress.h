@@ -0,0 +1,142 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_RMS_STRESS_H
+#define TACS_RMS_STRESS_H
+
+#include "TACSFunction.h"
+#include "TACSRandomVibration.h"
+
+/*
+  Compute a KS aggregate of the RMS von Mises stress under a random
+  load
+
+  The modal stresses s_j are evaluated at each quadrature point from
+  the modes stored in the TACSRandomVibration object, and the mean
+  square von Mises stress is
+
+  E[vm^2] = sum_{jk} Q_jk*s_j^T V s_k
+
+  where V is the matrix of the von Mises quadratic form and Q is the
+  covariance of the modal coordinates. The RMS stress divided by the
+  reference stress is aggregated over the domain with the continuous
+  KS function. Only elements that define the TACS_ELEMENT_STRESS
+  quantity contribute to the function.
+
+  The function does not depend on the states. The design variable
+  sensitivity holds the modes and the covariance fixed and only
+  accounts for the dependence of the stress on the design variables
+  through the constitutive relationship, so that it is exact for
+  design variables that only change the stiffness of the material
+  used for stress recovery.
+*/
+class TACSRMSStress : public TACSFunction {
+ public:
+  TACSRMSStress(TACSAssembler *_assembler, TACSRandomVibration *_random,
+                double _ksWeight, double _sigmaRef = 1.0);
+  ~TACSRMSStress();
+
+  /**
+    Get the object/function name
+  */
+  const char *getObjectName();
+
+  // Set parameters for the KS function
+  // ----------------------------------
+  double getParameter();
+  void setParameter(double _ksWeight);
+
+  /**
+    Get the maximum RMS stress divided by the reference stress
+  */
+  TacsScalar getMaximumRMSStress();
+
+  /**
+     Initialize the function for the given type of evaluation
+  */
+  void initEvaluation(EvaluationType ftype);
+
+  /**
+     Perform an element-wise integration over this element.
+  */
+  void elementWiseEval(EvaluationType ftype, int elemIndex,
+                       TACSElement *element, double time, TacsScalar scale,
+                       const TacsScalar Xpts[], const TacsScalar vars[],
+                       const TacsScalar dvars[], const TacsScalar ddvars[]);
+  int getNumThreadValues(EvaluationType ftype);
+  void initThreadValues(EvaluationType ftype, TacsScalar vals[]);
+  void elementWiseEvalThread(EvaluationType ftype, int elemIndex,
+                             TACSElement *element, double time,
+                             TacsScalar scale, const TacsScalar Xpts[],
+                             const TacsScalar vars[], const TacsScalar dvars[],
+                             const TacsScalar ddvars[], TacsScalar vals[]);
+  void addThreadValues(EvaluationType ftype, const TacsScalar vals[]);
+
+  /**
+     Finalize the function evaluation for the specified eval type.
+  */
+  void finalEvaluation(EvaluationType ftype);
+
+  /**
+     Get the value of the function
+  */
+  TacsScalar getFunctionValue();
+
+  /**
+     Evaluate the derivative of the function w.r.t. state variables
+  */
+  void getElementSVSens(int elemIndex, TACSElement *element, double time,
+                        TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+                        const TacsScalar Xpts[], const TacsScalar vars[],
+                        const TacsScalar dvars[], const TacsScalar ddvars[],
+                        TacsScalar *elemSVSens);
+
+  /**
+     Add the derivative of the function w.r.t. the design variables
+  */
+  void addElementDVSens(int elemIndex, TACSElement *element, double time,
+                        TacsScalar scale, const TacsScalar Xpts[],
+                        const TacsScalar vars[], const TacsScalar dvars[],
+                        const TacsScalar ddvars[], int dvLen,
+                        TacsScalar dfdx[]);
+
+ private:
+  // The maximum number of stress components
+  static const int MAX_STRESS_COMPONENTS = 9;
+
+  // Evaluate the modal stresses and the RMS stress at a point
+  int evalRMSStress(int elemIndex, TACSElement *element, double time, int n,
+                    double pt[], const TacsScalar Xpts[],
+                    const TacsScalar modeVars[], const TacsScalar dvars[],
+                    const TacsScalar ddvars[], TacsScalar *detXd,
+                    TacsScalar modeStress[], TacsScalar *rms);
+
+  // The random vibration analysis that stores the modes
+  TACSRandomVibration *random;
+
+  // The name of the function
+  static const char *funcName;
+
+  // The KS weight and the reference stress
+  double ksWeight, sigmaRef;
+
+  // The maximum value and the sum of the exponentials
+  TacsScalar maxRMS, ksSum;
+};
+
+#endif  // TACS_RMS_STRESS_H
@@ -0,0 +1,93 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2010 University of Toronto
+  Copyright (C) 2012 University of Michigan
+  Copyright (C) 2014 Georgia Tech Research Corporation
+  Additional copyright (C) 2010 Graeme J. Kennedy and Joaquim
+  R.R.A. Martins All rights reserved.
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_STRESS_MEASURES_H
+#define TACS_STRESS_MEASURES_H
+
+#include "TACSObject.h"
+
+/*
+  Scalar measures of the stress returned by the TACS_ELEMENT_STRESS
+  quantity
+
+  The plane stress and solid components are ordered as (s11, s22, s12)
+  and (s11, s22, s33, s23, s13, s12). The von Mises stress is written
+  as the quadratic form vm^2 = s^T V s, and any other number of
+  components uses the sum of squares.
+*/
+
+/*
+  Compute the product vs = V*s of the von Mises quadratic form
+*/
+inline void TacsVonMisesProduct(int count, const TacsScalar s[],
+                                TacsScalar vs[]) {
+  if (count == 3) {
+    vs[0] = s[0] - 0.5 * s[1];
+    vs[1] = s[1] - 0.5 * s[0];
+    vs[2] = 3.0 * s[2];
+  } else if (count == 6) {
+    vs[0] = s[0] - 0.5 * (s[1] + s[2]);
+    vs[1] = s[1] - 0.5 * (s[0] + s[2]);
+    vs[2] = s[2] - 0.5 * (s[0] + s[1]);
+    vs[3] = 3.0 * s[3];
+    vs[4] = 3.0 * s[4];
+    vs[5] = 3.0 * s[5];
+  } else {
+    for (int i = 0; i < count; i++) {
+      vs[i] = s[i];
+    }
+  }
+}
+
+/*
+  Compute the signed von Mises stress and its derivative
+
+  The sign is taken from the sum of the normal stresses, so that the
+  result distinguishes tension from compression for cycle counting.
+  The derivative is zero when the stress is zero.
+*/
+inline TacsScalar TacsSignedVonMises(int count, const TacsScalar s[],
+                                     TacsScalar dvm[]) {
+  TacsScalar vs[9];
+  TacsVonMisesProduct(count, s, vs);
+  TacsScalar vm2 = 0.0;
+  for (int i = 0; i < count; i++) {
+    vm2 += s[i] * vs[i];
+  }
+
+  TacsScalar trace = s[0] + s[1];
+  if (count == 6) {
+    trace += s[2];
+  }
+  double sign = (TacsRealPart(trace) < 0.0 ? -1.0 : 1.0);
+
+  if (TacsRealPart(vm2) <= 0.0) {
+    for (int i = 0; i < count; i++) {
+      dvm[i] = 0.0;
+    }
+    return 0.0;
+  }
+
+  TacsScalar vm = sqrt(vm2);
+  for (int i = 0; i < count; i++) {
+    dvm[i] = sign * vs[i] / vm;
+  }
+  return sign * vm;
+}
+
+#endif  // TACS_STRESS_MEASURES_H
@@ -18,6 +18,262 @@
 
 #include "TACSFH5.h"
 
+#include "TACSProfiler.h"
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+  Convert between float and the 16-bit storage types. Both conversions
+  round to the nearest value with ties to even.
+*/
+static uint16_t TacsFloatToHalf(float value) {
+  uint32_t x;
+  memcpy(&x, &value, sizeof(uint32_t));
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t absx = x & 0x7fffffff;
+
+  if (absx >= 0x7f800000) {
+    // Infinity or NaN
+    return sign | 0x7c00 | (absx > 0x7f800000 ? 0x200 : 0);
+  } else if (absx >= 0x477ff000) {
+    // Values that round to a magnitude above 65504 overflow
+    return sign | 0x7c00;
+  } else if (absx < 0x38800000) {
+    // Subnormal values, stored as multiples of 2^-24
+    if (absx < 0x33000000) {
+      return sign;
+    }
+    uint32_t mant = (absx & 0x7fffff) | 0x800000;
+    int shift = 126 - (absx >> 23);
+    uint32_t h = mant >> shift;
+    uint32_t rem = mant & ((1u << shift) - 1);
+    uint32_t half = 1u << (shift - 1);
+    if (rem > half || (rem == half && (h & 1))) {
+      h++;
+    }
+    return sign | h;
+  }
+
+  uint32_t h = (absx - 0x38000000) >> 13;
+  uint32_t rem = absx & 0x1fff;
+  if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) {
+    h++;
+  }
+  return sign | h;
+}
+
+static float TacsHalfToFloat(uint16_t h) {
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  uint32_t exponent = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+
+  if (exponent == 0) {
+    float value = ldexpf((float)mant, -24);
+    return (sign ? -value : value);
+  }
+
+  uint32_t x = 0;
+  if (exponent == 0x1f) {
+    x = sign | 0x7f800000 | (mant << 13);
+  } else {
+    x = sign | ((exponent + 112) << 23) | (mant << 13);
+  }
+  float value;
+  memcpy(&value, &x, sizeof(float));
+  return value;
+}
+
+static uint16_t TacsFloatToBFloat16(float value) {
+  uint32_t x;
+  memcpy(&x, &value, sizeof(uint32_t));
+  if ((x & 0x7fffffff) > 0x7f800000) {
+    // Keep NaN values quiet so that they are not rounded to infinity
+    return (x >> 16) | 0x40;
+  }
+  x += 0x7fff + ((x >> 16) & 1);
+  return x >> 16;
+}
+
+static float TacsBFloat16ToFloat(uint16_t b) {
+  uint32_t x = (uint32_t)b << 16;
+  float value;
+  memcpy(&value, &x, sizeof(float));
+  return value;
+}
+
+/*
+  The compressed zone data is encoded column by column. Each entry is
+  replaced by its difference from the entry in the previous row of the
+  same column, and the result is written as a variable-length integer
+  with 7 bits per byte. Nearby nodes and elements have similar values,
+  so most differences only need a few bytes.
+
+  For lossless compression, the difference between floating point
+  values is the exclusive-or of their bit patterns, so that values
+  that share their sign, exponent and leading mantissa bits have small
+  differences. Integers use the zig-zag encoded arithmetic difference.
+
+  For quantized compression, each value is rounded to the nearest
+  multiple of 2*tol, so that the absolute error is at most tol. The
+  integer multiples are then encoded like integer data.
+*/
+static inline uint64_t TacsZigZag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t TacsUnZigZag(uint64_t u) {
+  return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+static inline size_t TacsPutVarint(uint64_t u, unsigned char *out) {
+  size_t n = 0;
+  while (u >= 0x80) {
+    out[n] = (unsigned char)(u | 0x80);
+    u >>= 7;
+    n++;
+  }
+  out[n] = (unsigned char)u;
+  return n + 1;
+}
+
+static inline int TacsGetVarint(const unsigned char *in, size_t len,
+                                size_t *pos, uint64_t *u) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64 && *pos < len; shift += 7) {
+    unsigned char c = in[*pos];
+    (*pos)++;
+    value |= (uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80)) {
+      *u = value;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Get the largest number of bytes required to encode a single entry
+static size_t TacsFH5MaxEncodedSize(int codec, int dtype) {
+  if (codec == TACSFH5File::FH5_QUANTIZE ||
+      dtype == TACSFH5File::FH5_DOUBLE) {
+    return 10;
+  } else if (dtype == TACSFH5File::FH5_HALF ||
+             dtype == TACSFH5File::FH5_BFLOAT16) {
+    return 3;
+  }
+  return 5;
+}
+
+/*
+  Encode a dim1 x dim2 array of the stored type into the output buffer
+  and return the number of bytes
+*/
+static size_t TacsFH5Encode(int codec, int dtype, double tol, int dim1,
+                            int dim2, const void *data, unsigned char *out) {
+  uint64_t *prev = new uint64_t[dim2];
+  memset(prev, 0, dim2 * sizeof(uint64_t));
+
+  size_t n = 0;
+  for (int i = 0; i < dim1; i++) {
+    for (int j = 0; j < dim2; j++) {
+      size_t index = (size_t)i * dim2 + j;
+      uint64_t u = 0;
+      if (codec == TACSFH5File::FH5_QUANTIZE) {
+        double v = 0.0;
+        if (dtype == TACSFH5File::FH5_FLOAT) {
+          v = ((const float *)data)[index];
+        } else {
+          v = ((const double *)data)[index];
+        }
+        // Non-finite or out of range values are stored as zero
+        double r = floor(0.5 * v / tol + 0.5);
+        int64_t q = 0;
+        if (r > -4e18 && r < 4e18) {
+          q = (int64_t)r;
+        }
+        u = TacsZigZag(q - (int64_t)prev[j]);
+        prev[j] = (uint64_t)q;
+      } else if (dtype == TACSFH5File::FH5_INT) {
+        int64_t v = ((const int *)data)[index];
+        u = TacsZigZag(v - (int64_t)prev[j]);
+        prev[j] = (uint64_t)v;
+      } else {
+        uint64_t bits = 0;
+        if (dtype == TACSFH5File::FH5_DOUBLE) {
+          memcpy(&bits, &((const double *)data)[index], sizeof(double));
+        } else if (dtype == TACSFH5File::FH5_FLOAT) {
+          uint32_t b;
+          memcpy(&b, &((const float *)data)[index], sizeof(float));
+          bits = b;
+        } else {
+          bits = ((const uint16_t *)data)[index];
+        }
+        u = bits ^ prev[j];
+        prev[j] = bits;
+      }
+      n += TacsPutVarint(u, &out[n]);
+    }
+  }
+
+  delete[] prev;
+  return n;
+}
+
+/*
+  Decode the dim1 x dim2 array from the input buffer. Integer data is
+  decoded to int, double data to double and all other data to float.
+
+  @return 0 on success, 1 if the buffer is too short
+*/
+static int TacsFH5Decode(int codec, int dtype, double tol, int dim1, int dim2,
+                         const unsigned char *in, size_t len, void *data) {
+  uint64_t *prev = new uint64_t[dim2];
+  memset(prev, 0, dim2 * sizeof(uint64_t));
+
+  int fail = 0;
+  size_t pos = 0;
+  for (int i = 0; i < dim1 && !fail; i++) {
+    for (int j = 0; j < dim2; j++) {
+      size_t index = (size_t)i * dim2 + j;
+      uint64_t u = 0;
+      if (TacsGetVarint(in, len, &pos, &u)) {
+        fail = 1;
+        break;
+      }
+
+      if (codec == TACSFH5File::FH5_QUANTIZE) {
+        int64_t q = (int64_t)prev[j] + TacsUnZigZag(u);
+        prev[j] = (uint64_t)q;
+        if (dtype == TACSFH5File::FH5_DOUBLE) {
+          ((double *)data)[index] = 2.0 * tol * q;
+        } else {
+          ((float *)data)[index] = 2.0 * tol * q;
+        }
+      } else if (dtype == TACSFH5File::FH5_INT) {
+        int64_t v = (int64_t)prev[j] + TacsUnZigZag(u);
+        prev[j] = (uint64_t)v;
+        ((int *)data)[index] = (int)v;
+      } else {
+        uint64_t bits = u ^ prev[j];
+        prev[j] = bits;
+        if (dtype == TACSFH5File::FH5_DOUBLE) {
+          memcpy(&((double *)data)[index], &bits, sizeof(double));
+        } else if (dtype == TACSFH5File::FH5_FLOAT) {
+          uint32_t b = (uint32_t)bits;
+          memcpy(&((float *)data)[index], &b, sizeof(float));
+        } else if (dtype == TACSFH5File::FH5_HALF) {
+          ((float *)data)[index] = TacsHalfToFloat((uint16_t)bits);
+        } else {
+          ((float *)data)[index] = TacsBFloat16ToFloat((uint16_t)bits);
+        }
+      }
+    }
+  }
+
+  delete[] prev;
+  return fail;
+}
+
 /**
    Create the FH5 object with the given communicator
 
@@ -34,12 +290,28 @@ TACSFH5File::TACSFH5File(MPI_Comm _comm) {
   current = root = tip = NULL;
   num_comp = 0;
   comp_names = NULL;
+
+  num_pending = max_pending = 0;
+  pending_requests = NULL;
+  pending_types = NULL;
+  pending_buffers = NULL;
+  pending_bytes = 0;
+
+  compression = FH5_NO_COMPRESSION;
+  compression_tol = 0.0;
+  float_storage = FH5_FLOAT;
 }
 
 /**
    Free the FH5 object
 */
 TACSFH5File::~TACSFH5File() {
+  close();
+  if (pending_requests) {
+    delete[] pending_requests;
+    delete[] pending_types;
+    delete[] pending_buffers;
+  }
   if (rfp) {
     fclose(rfp);
   }
@@ -179,16 +451,38 @@ int TACSFH5File::createFile(const char *file_name, int num_components,
    data (double) or (int)
 
    dim1*dim2*sizeof(double)/sizeof(int)
+
+   When the zone is compressed, the data type records the stored type
+   in the low byte and the compression in the next byte. The data then
+   consists of one compressed chunk for each processor:
+
+   number of chunks (int)
+   dim 1 of each chunk (int)
+   bytes in each chunk (long long)
+   tolerance (double)
+   chunk data (char)
 */
 int TACSFH5File::writeZoneData(char *zone_name, char *var_names,
                                FH5DataType data_name, int dim1, int dim2,
                                void *data, int *dim1_range) {
+  TACSProfileScope scope("TACSFH5File::writeZoneData");
+  if (fp && file_for_writing &&
+      (compression != FH5_NO_COMPRESSION ||
+       (data_name == FH5_FLOAT && float_storage != FH5_FLOAT))) {
+    waitWrites();
+    return writeEncodedZoneData(zone_name, var_names, data_name, dim1, dim2,
+                                data, dim1_range, 0);
+  }
+
   // Check the file status to ensure that it's open
   if (fp && file_for_writing) {
     int rank, size;
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &size);
 
+    // The view cannot be changed while writes are pending
+    waitWrites();
+
     int *dim_count = NULL;
     if (!dim1_range) {
       int *dim_count = new int[size + 1];
@@ -258,6 +552,9 @@ int TACSFH5File::writeZoneData(char *zone_name, char *var_names,
       file_offset += total_dim * dim2 * sizeof(int);
     }
 
+    // Reset the view so that the later writes can use byte offsets
+    MPI_File_set_view(fp, 0, MPI_CHAR, MPI_CHAR, datarep, MPI_INFO_NULL);
+
     // Free the dimension count
     if (dim_count) {
       delete[] dim_count;
@@ -270,10 +567,409 @@ int TACSFH5File::writeZoneData(char *zone_name, char *var_names,
 }
 
 /**
-   Close the file
+   Write the data to a file without waiting for the write to complete.
+
+   The zone is written in the same format as writeZoneData(), but with
+   non-blocking collective writes. The file object takes ownership of
+   the data, which must be allocated with new[] as an array of the
+   type given by data_name. The data is freed once the write has
+   completed, either in testWrites(), waitWrites() or close().
+
+   The writes use explicit byte offsets so that the file view is not
+   changed while the writes are pending.
+*/
+int TACSFH5File::iwriteZoneData(char *zone_name, char *var_names,
+                                FH5DataType data_name, int dim1, int dim2,
+                                void *data, int *dim1_range) {
+  if (fp && file_for_writing &&
+      (compression != FH5_NO_COMPRESSION ||
+       (data_name == FH5_FLOAT && float_storage != FH5_FLOAT))) {
+    return writeEncodedZoneData(zone_name, var_names, data_name, dim1, dim2,
+                                data, dim1_range, 1);
+  }
+
+  if (fp && file_for_writing) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    int *dim_count = NULL;
+    if (!dim1_range) {
+      dim_count = new int[size + 1];
+      dim_count[0] = 0;
+      MPI_Allgather(&dim1, 1, MPI_INT, &dim_count[1], 1, MPI_INT, comm);
+
+      for (int k = 0; k < size; k++) {
+        dim_count[k + 1] += dim_count[k];
+      }
+      dim1_range = dim_count;
+    }
+    int total_dim = dim1_range[size];
+
+    // Calculate the size of the header
+    size_t header_len =
+        5 * sizeof(int) + strlen(zone_name) + strlen(var_names) + 2;
+
+    // Write the header for this zone just on the root processor
+    if (rank == 0) {
+      char *pre_header = new char[header_len];
+      int pre_int[5];
+      pre_int[0] = data_name;
+      pre_int[1] = total_dim;
+      pre_int[2] = dim2;
+      pre_int[3] = strlen(zone_name) + 1;
+      pre_int[4] = strlen(var_names) + 1;
+      memcpy(pre_header, pre_int, 5 * sizeof(int));
+
+      size_t off = 5 * sizeof(int);
+      memcpy(&pre_header[off], zone_name, strlen(zone_name) + 1);
+
+      off += strlen(zone_name) + 1;
+      memcpy(&pre_header[off], var_names, strlen(var_names) + 1);
+
+      MPI_Request request;
+      MPI_File_iwrite_at(fp, file_offset, pre_header, header_len, MPI_CHAR,
+                         &request);
+      addPendingWrite(request, -1, pre_header, header_len);
+    }
+    file_offset += header_len;
+
+    MPI_Datatype dtype = MPI_DOUBLE;
+    size_t dsize = sizeof(double);
+    if (data_name == FH5_INT) {
+      dtype = MPI_INT;
+      dsize = sizeof(int);
+    } else if (data_name == FH5_FLOAT) {
+      dtype = MPI_FLOAT;
+      dsize = sizeof(float);
+    }
+
+    MPI_Request request;
+    MPI_Offset offset =
+        file_offset + (MPI_Offset)dim1_range[rank] * dim2 * dsize;
+    MPI_File_iwrite_at_all(fp, offset, data, dim1 * dim2, dtype, &request);
+    addPendingWrite(request, data_name, data, dim1 * dim2 * dsize);
+
+    file_offset += (MPI_Offset)total_dim * dim2 * dsize;
+
+    if (dim_count) {
+      delete[] dim_count;
+    }
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+   Set the compression and the storage type for the zones that are
+   written after this call.
+
+   Lossless compression applies to all zones. Quantization applies to
+   the float and double zones, which are stored with an absolute error
+   of at most tol, while integer zones are compressed without loss.
+   The float zones are stored with the type float_type, which may be
+   FH5_FLOAT, FH5_HALF or FH5_BFLOAT16, unless they are quantized.
+   Note that values with a magnitude above 65504 overflow the half
+   type, while bfloat16 has the range of float with less precision.
+
+   This must be called with the same arguments on all processors.
+
+   @param codec The type of compression
+   @param tol The absolute error tolerance for quantization
+   @param float_type The type used to store float data
+*/
+void TACSFH5File::setCompression(FH5Compression codec, double tol,
+                                 FH5DataType float_type) {
+  if (codec == FH5_QUANTIZE && !(tol > 0.0)) {
+    fprintf(stderr,
+            "TACSFH5File: Quantization requires a positive tolerance, "
+            "using lossless compression\n");
+    codec = FH5_LOSSLESS;
+  }
+  if (float_type != FH5_FLOAT && float_type != FH5_HALF &&
+      float_type != FH5_BFLOAT16) {
+    fprintf(stderr, "TACSFH5File: Unrecognized float storage type\n");
+    float_type = FH5_FLOAT;
+  }
+  compression = codec;
+  compression_tol = tol;
+  float_storage = float_type;
+}
+
+/*
+  Write the zone data with the current compression and storage type.
+
+  The local data is converted to the storage type and encoded, and the
+  resulting bytes are written at explicit byte offsets. When async is
+  set, the writes are non-blocking and the file object takes ownership
+  of the data, as in iwriteZoneData().
+*/
+int TACSFH5File::writeEncodedZoneData(char *zone_name, char *var_names,
+                                      FH5DataType data_name, int dim1,
+                                      int dim2, void *data, int *dim1_range,
+                                      int async) {
+  TACSProfileScope scope("TACSFH5File::writeEncodedZoneData");
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Determine the compression and the stored type for this zone
+  int codec = compression;
+  int stored_type = data_name;
+  if (codec == FH5_QUANTIZE && data_name == FH5_INT) {
+    codec = FH5_LOSSLESS;
+  }
+  if (codec != FH5_QUANTIZE && data_name == FH5_FLOAT) {
+    stored_type = float_storage;
+  }
+
+  // Convert the float data to the 16-bit storage type
+  size_t len = (size_t)dim1 * dim2;
+  const void *values = data;
+  uint16_t *values16 = NULL;
+  if (stored_type == FH5_HALF || stored_type == FH5_BFLOAT16) {
+    values16 = new uint16_t[len];
+    const float *fdata = (const float *)data;
+    for (size_t i = 0; i < len; i++) {
+      if (stored_type == FH5_HALF) {
+        values16[i] = TacsFloatToHalf(fdata[i]);
+      } else {
+        values16[i] = TacsFloatToBFloat16(fdata[i]);
+      }
+    }
+    values = values16;
+  }
+
+  // Encode the local data
+  char *buffer = NULL;
+  size_t bytes = 0;
+  if (codec == FH5_NO_COMPRESSION) {
+    bytes = len * sizeof(uint16_t);
+    buffer = new char[bytes];
+    memcpy(buffer, values16, bytes);
+  } else {
+    unsigned char *temp =
+        new unsigned char[len * TacsFH5MaxEncodedSize(codec, stored_type)];
+    bytes = TacsFH5Encode(codec, stored_type, compression_tol, dim1, dim2,
+                          values, temp);
+    buffer = new char[bytes];
+    memcpy(buffer, temp, bytes);
+    delete[] temp;
+  }
+  if (values16) {
+    delete[] values16;
+  }
+
+  // The data is no longer needed once it has been encoded
+  if (async) {
+    if (data_name == FH5_INT) {
+      delete[] (int *)data;
+    } else if (data_name == FH5_FLOAT) {
+      delete[] (float *)data;
+    } else {
+      delete[] (double *)data;
+    }
+  }
+
+  int *dim_count = NULL;
+  if (!dim1_range) {
+    dim_count = new int[size + 1];
+    dim_count[0] = 0;
+    MPI_Allgather(&dim1, 1, MPI_INT, &dim_count[1], 1, MPI_INT, comm);
+
+    for (int k = 0; k < size; k++) {
+      dim_count[k + 1] += dim_count[k];
+    }
+    dim1_range = dim_count;
+  }
+  int total_dim = dim1_range[size];
+
+  // Compute the size of the header and the offset of the local data
+  size_t header_len =
+      5 * sizeof(int) + strlen(zone_name) + strlen(var_names) + 2;
+  MPI_Offset data_offset = 0, data_len = 0;
+  long long *chunk_bytes = NULL;
+  if (codec == FH5_NO_COMPRESSION) {
+    data_offset = (MPI_Offset)dim1_range[rank] * dim2 * sizeof(uint16_t);
+    data_len = (MPI_Offset)total_dim * dim2 * sizeof(uint16_t);
+  } else {
+    chunk_bytes = new long long[size];
+    long long local_bytes = bytes;
+    MPI_Allgather(&local_bytes, 1, MPI_LONG_LONG, chunk_bytes, 1,
+                  MPI_LONG_LONG, comm);
+
+    size_t table_len =
+        (size + 1) * sizeof(int) + size * sizeof(long long) + sizeof(double);
+    header_len += table_len;
+    for (int k = 0; k < size; k++) {
+      if (k < rank) {
+        data_offset += chunk_bytes[k];
+      }
+      data_len += chunk_bytes[k];
+    }
+  }
+
+  // Write the header and the chunk table just on the root processor
+  if (rank == 0) {
+    char *pre_header = new char[header_len];
+    int pre_int[5];
+    pre_int[0] = stored_type | (codec << 8);
+    pre_int[1] = total_dim;
+    pre_int[2] = dim2;
+    pre_int[3] = strlen(zone_name) + 1;
+    pre_int[4] = strlen(var_names) + 1;
+    memcpy(pre_header, pre_int, 5 * sizeof(int));
+
+    size_t off = 5 * sizeof(int);
+    memcpy(&pre_header[off], zone_name, strlen(zone_name) + 1);
+
+    off += strlen(zone_name) + 1;
+    memcpy(&pre_header[off], var_names, strlen(var_names) + 1);
+    off += strlen(var_names) + 1;
+
+    if (chunk_bytes) {
+      memcpy(&pre_header[off], &size, sizeof(int));
+      off += sizeof(int);
+      for (int k = 0; k < size; k++) {
+        int rows = dim1_range[k + 1] - dim1_range[k];
+        memcpy(&pre_header[off], &rows, sizeof(int));
+        off += sizeof(int);
+      }
+      memcpy(&pre_header[off], chunk_bytes, size * sizeof(long long));
+      off += size * sizeof(long long);
+      memcpy(&pre_header[off], &compression_tol, sizeof(double));
+    }
+
+    if (async) {
+      MPI_Request request;
+      MPI_File_iwrite_at(fp, file_offset, pre_header, header_len, MPI_CHAR,
+                         &request);
+      addPendingWrite(request, -1, pre_header, header_len);
+    } else {
+      MPI_File_write_at(fp, file_offset, pre_header, header_len, MPI_CHAR,
+                        MPI_STATUS_IGNORE);
+      delete[] pre_header;
+    }
+  }
+  file_offset += header_len;
+
+  // Write the local data
+  if (async) {
+    MPI_Request request;
+    MPI_File_iwrite_at_all(fp, file_offset + data_offset, buffer, bytes,
+                           MPI_CHAR, &request);
+    addPendingWrite(request, -1, buffer, bytes);
+  } else {
+    MPI_File_write_at_all(fp, file_offset + data_offset, buffer, bytes,
+                          MPI_CHAR, MPI_STATUS_IGNORE);
+    delete[] buffer;
+  }
+  file_offset += data_len;
+
+  if (chunk_bytes) {
+    delete[] chunk_bytes;
+  }
+  if (dim_count) {
+    delete[] dim_count;
+  }
+
+  return 1;
+}
+
+/**
+   Test whether the pending writes have completed, and if so, free the
+   data that they own
+
+   @return 1 if there are no pending writes, 0 otherwise
+*/
+int TACSFH5File::testWrites() {
+  if (num_pending > 0) {
+    int flag = 0;
+    MPI_Testall(num_pending, pending_requests, &flag, MPI_STATUSES_IGNORE);
+    if (!flag) {
+      return 0;
+    }
+    freePendingBuffers();
+  }
+  return 1;
+}
+
+/**
+   Wait for the pending writes to complete and free the data they own
+*/
+void TACSFH5File::waitWrites() {
+  if (num_pending > 0) {
+    MPI_Waitall(num_pending, pending_requests, MPI_STATUSES_IGNORE);
+    freePendingBuffers();
+  }
+}
+
+/**
+   Get the number of bytes owned by the pending writes
+*/
+size_t TACSFH5File::getPendingBytes() { return pending_bytes; }
+
+/*
+  Add a pending write request and the buffer that it owns. A dtype of
+  -1 indicates a character buffer.
+*/
+void TACSFH5File::addPendingWrite(MPI_Request request, int dtype,
+                                  void *buffer, size_t bytes) {
+  if (num_pending >= max_pending) {
+    int new_max = 2 * max_pending + 8;
+    MPI_Request *requests = new MPI_Request[new_max];
+    int *types = new int[new_max];
+    void **buffers = new void *[new_max];
+    if (num_pending > 0) {
+      memcpy(requests, pending_requests, num_pending * sizeof(MPI_Request));
+      memcpy(types, pending_types, num_pending * sizeof(int));
+      memcpy(buffers, pending_buffers, num_pending * sizeof(void *));
+    }
+    if (pending_requests) {
+      delete[] pending_requests;
+      delete[] pending_types;
+      delete[] pending_buffers;
+    }
+    pending_requests = requests;
+    pending_types = types;
+    pending_buffers = buffers;
+    max_pending = new_max;
+  }
+
+  pending_requests[num_pending] = request;
+  pending_types[num_pending] = dtype;
+  pending_buffers[num_pending] = buffer;
+  pending_bytes += bytes;
+  num_pending++;
+}
+
+/*
+  Free the buffers owned by the completed writes
+*/
+void TACSFH5File::freePendingBuffers() {
+  for (int k = 0; k < num_pending; k++) {
+    if (pending_types[k] == FH5_INT) {
+      delete[] (int *)pending_buffers[k];
+    } else if (pending_types[k] == FH5_FLOAT) {
+      delete[] (float *)pending_buffers[k];
+    } else if (pending_types[k] == FH5_DOUBLE) {
+      delete[] (double *)pending_buffers[k];
+    } else {
+      delete[] (char *)pending_buffers[k];
+    }
+  }
+  num_pending = 0;
+  pending_bytes = 0;
+}
+
+/**
+   Close the file once all pending writes have completed
 */
 void TACSFH5File::close() {
   if (fp) {
+    waitWrites();
     MPI_File_set_size(fp, file_offset);
     MPI_File_close(&fp);
     fp = NULL;
@@ -417,8 +1113,10 @@ int TACSFH5File::scanFH5File() {
       return 1;
     }
 
-    // Record the type of data - one of the FH5DataNames
-    tip->dtype = header[0];
+    // Record the type of data - one of the FH5DataNames - and the
+    // type of compression
+    tip->dtype = header[0] & 0xff;
+    tip->codec = header[0] >> 8;
     tip->dim1 = header[1];
     tip->dim2 = header[2];
 
@@ -433,7 +1131,30 @@ int TACSFH5File::scanFH5File() {
     // Record the file position
     file_pos = ftell(rfp);
     tip->data_offset = file_pos;
-    if (tip->dtype == FH5_INT) {
+    if (tip->codec != FH5_NO_COMPRESSION) {
+      // Read the number of chunks and the size of each chunk
+      int nchunks = 0;
+      if (fread(&nchunks, sizeof(int), 1, rfp) != 1 || nchunks < 0) {
+        fprintf(stderr, "FH5: Error reading chunk table\n");
+        return 1;
+      }
+      long long *chunk_bytes = new long long[nchunks];
+      fseek(rfp, nchunks * sizeof(int), SEEK_CUR);
+      if (fread(chunk_bytes, sizeof(long long), nchunks, rfp) !=
+          (size_t)nchunks) {
+        fprintf(stderr, "FH5: Error reading chunk table\n");
+        delete[] chunk_bytes;
+        return 1;
+      }
+      file_pos += (nchunks + 1) * sizeof(int) +
+                  nchunks * sizeof(long long) + sizeof(double);
+      for (int k = 0; k < nchunks; k++) {
+        file_pos += chunk_bytes[k];
+      }
+      delete[] chunk_bytes;
+    } else if (tip->dtype == FH5_HALF || tip->dtype == FH5_BFLOAT16) {
+      file_pos += sizeof(uint16_t) * tip->dim1 * tip->dim2;
+    } else if (tip->dtype == FH5_INT) {
       file_pos += sizeof(int) * tip->dim1 * tip->dim2;
     } else if (tip->dtype == FH5_FLOAT) {
       file_pos += sizeof(float) * tip->dim1 * tip->dim2;
@@ -490,7 +1211,8 @@ int TACSFH5File::getZoneInfo(const char **zone_name, const char **var_names,
   if (dtype) {
     if (current->dtype == FH5_INT) {
       *dtype = FH5_INT;
-    } else if (current->dtype == FH5_FLOAT) {
+    } else if (current->dtype == FH5_FLOAT || current->dtype == FH5_HALF ||
+               current->dtype == FH5_BFLOAT16) {
       *dtype = FH5_FLOAT;
     } else if (current->dtype == FH5_DOUBLE) {
       *dtype = FH5_DOUBLE;
@@ -548,7 +1270,29 @@ int TACSFH5File::getZoneData(const char **zone_name, const char **var_names,
   }
 
   size_t len = current->dim1 * current->dim2;
-  if (dtype == FH5_INT) {
+  if (current->codec != FH5_NO_COMPRESSION || dtype == FH5_HALF ||
+      dtype == FH5_BFLOAT16) {
+    // The 16-bit types are decoded to float
+    if (dtype == FH5_HALF || dtype == FH5_BFLOAT16) {
+      dtype = FH5_FLOAT;
+    }
+    if (_dtype) {
+      *_dtype = (FH5DataType)dtype;
+    }
+    if (data) {
+      if (dtype == FH5_INT) {
+        *data = new int[len];
+      } else if (dtype == FH5_FLOAT) {
+        *data = new float[len];
+      } else {
+        *data = new double[len];
+      }
+      if (readEncodedZoneData(*data)) {
+        fprintf(stderr, "FH5: Error reading compressed data\n");
+        return 0;
+      }
+    }
+  } else if (dtype == FH5_INT) {
     if (_dtype) {
       *_dtype = FH5_INT;
     }
@@ -585,3 +1329,75 @@ int TACSFH5File::getZoneData(const char **zone_name, const char **var_names,
 
   return 1;
 }
+
+/*
+  Read the current zone data that is stored with compression or with a
+  16-bit type. The data must be allocated with the decoded type.
+
+  @return 0 on success, 1 on failure
+*/
+int TACSFH5File::readEncodedZoneData(void *data) {
+  int dtype = current->dtype;
+  int dim2 = current->dim2;
+  size_t len = current->dim1 * current->dim2;
+
+  if (current->codec == FH5_NO_COMPRESSION) {
+    uint16_t *values = new uint16_t[len];
+    int fail = (fread(values, sizeof(uint16_t), len, rfp) != len);
+    for (size_t i = 0; i < len && !fail; i++) {
+      if (dtype == FH5_HALF) {
+        ((float *)data)[i] = TacsHalfToFloat(values[i]);
+      } else {
+        ((float *)data)[i] = TacsBFloat16ToFloat(values[i]);
+      }
+    }
+    delete[] values;
+    return fail;
+  }
+
+  // Read the chunk table
+  int nchunks = 0;
+  if (fread(&nchunks, sizeof(int), 1, rfp) != 1 || nchunks < 0) {
+    return 1;
+  }
+  int *rows = new int[nchunks];
+  long long *chunk_bytes = new long long[nchunks];
+  double tol = 0.0;
+  int fail = 0;
+  if (fread(rows, sizeof(int), nchunks, rfp) != (size_t)nchunks ||
+      fread(chunk_bytes, sizeof(long long), nchunks, rfp) !=
+          (size_t)nchunks ||
+      fread(&tol, sizeof(double), 1, rfp) != 1) {
+    fail = 1;
+  }
+
+  // Decode each of the chunks in turn
+  size_t dsize = sizeof(float);
+  if (dtype == FH5_INT) {
+    dsize = sizeof(int);
+  } else if (dtype == FH5_DOUBLE) {
+    dsize = sizeof(double);
+  }
+  size_t offset = 0;
+  for (int k = 0; k < nchunks && !fail; k++) {
+    if (rows[k] < 0 || offset + (size_t)rows[k] * dim2 > len) {
+      fail = 1;
+      break;
+    }
+    unsigned char *buffer = new unsigned char[chunk_bytes[k]];
+    if (fread(buffer, sizeof(char), chunk_bytes[k], rfp) !=
+        (size_t)chunk_bytes[k]) {
+      fail = 1;
+    } else {
+      void *ptr = &((char *)data)[offset * dsize];
+      fail = TacsFH5Decode(current->codec, dtype, tol, rows[k], dim2, buffer,
+                           chunk_bytes[k], ptr);
+    }
+    offset += (size_t)rows[k] * dim2;
+    delete[] buffer;
+  }
+
+  delete[] rows;
+  delete[] chunk_bytes;
+  return fail;
+}
@@ -29,8 +29,22 @@
 class TACSFH5File : public TACSObject {
  public:
   // Data types accepted by FH5: Note that float comes last
-  // for backwards compatibility
-  enum FH5DataType { FH5_INT = 0, FH5_DOUBLE = 1, FH5_FLOAT = 2 };
+  // for backwards compatibility. The half and bfloat16 types are only
+  // used for storage in the file and are read back as float.
+  enum FH5DataType {
+    FH5_INT = 0,
+    FH5_DOUBLE = 1,
+    FH5_FLOAT = 2,
+    FH5_HALF = 3,
+    FH5_BFLOAT16 = 4
+  };
+
+  // Compression applied to the zone data
+  enum FH5Compression {
+    FH5_NO_COMPRESSION = 0,
+    FH5_LOSSLESS = 1,
+    FH5_QUANTIZE = 2
+  };
 
   // Create the FH5 object
   TACSFH5File(MPI_Comm _comm);
@@ -43,6 +57,17 @@ class TACSFH5File : public TACSObject {
                     int dim1, int dim2, void *data, int *dim1_range = NULL);
   void close();
 
+  // Set the compression and storage type for the zones written next
+  void setCompression(FH5Compression codec, double tol = 0.0,
+                      FH5DataType float_type = FH5_FLOAT);
+
+  // Write zone data without waiting for the write to complete
+  int iwriteZoneData(char *zone_name, char *var_names, FH5DataType data_name,
+                     int dim1, int dim2, void *data, int *dim1_range = NULL);
+  int testWrites();
+  void waitWrites();
+  size_t getPendingBytes();
+
   // Open a file for reading input
   int openFile(const char *file_name);
 
@@ -67,6 +92,7 @@ class TACSFH5File : public TACSObject {
       next = NULL;
       var_names = NULL;
       dtype = -1;
+      codec = FH5_NO_COMPRESSION;
       dim1 = dim2 = 0;
       data_offset = 0;
     }
@@ -78,7 +104,7 @@ class TACSFH5File : public TACSObject {
         delete[] var_names;
       }
     }
-    int dtype;
+    int dtype, codec;
     char *zone_name;
     char *var_names;
     int dim1, dim2;
@@ -90,6 +116,19 @@ class TACSFH5File : public TACSObject {
   int scanFH5File();
   void deleteFH5FileInfo();
 
+  // Read the current zone data with compression or a 16-bit type
+  int readEncodedZoneData(void *data);
+
+  // Encode and write the zone data with the current compression
+  int writeEncodedZoneData(char *zone_name, char *var_names,
+                           FH5DataType data_name, int dim1, int dim2,
+                           void *data, int *dim1_range, int async);
+
+  // Add a pending write and the buffer that it owns
+  void addPendingWrite(MPI_Request request, int dtype, void *buffer,
+                       size_t bytes);
+  void freePendingBuffers();
+
   int num_comp;       // The number of components
   char **comp_names;  // The component names
 
@@ -101,6 +140,18 @@ class TACSFH5File : public TACSObject {
 
   // Serial file containing the FE solution
   FILE *rfp;
+
+  // Compression settings for the zones that are written
+  FH5Compression compression;
+  double compression_tol;
+  FH5DataType float_storage;
+
+  // Requests for the non-blocking writes and the buffers they own
+  int num_pending, max_pending;
+  MPI_Request *pending_requests;
+  int *pending_types;
+  void **pending_buffers;
+  size_t pending_bytes;
 };
 
 #endif  // FH5_INCLUDE_H
@@ -19,6 +19,7 @@
 
 TACSFH5Loader::TACSFH5Loader() {
   data_file = NULL;
+  thread_info = NULL;
 
   comp_nums = NULL;
   ltypes = NULL;
@@ -63,6 +64,9 @@ TACSFH5Loader::~TACSFH5Loader() {
   if (data_file) {
     data_file->decref();
   }
+  if (thread_info) {
+    thread_info->decref();
+  }
 }
 
 int TACSFH5Loader::loadData(const char *conn_fname, const char *data_fname) {
@@ -415,82 +419,70 @@ void TACSFH5Loader::computePlanarMask(ElementLayout layout, const float base[],
   }
 }
 
-/**
-  Compute the node to element data structure for the specified layout
-  and optional mask array.
-
-  Note that if all indices should be used, num_sub_indices = -1 will
-  form a connectivity from all nodes
-
-  @param layout Element layout type to use
-  @param mask The element mask to apply (optional)
-  @param num_sub_indices Connect only those elements with sub indices
-  @param sub_indices Subindex array
-  @param node_to_element_ptr Output pointer into the node_to_element array
-  @param node_to_element Elements associated with the specified node
+/*
+  A hash table for the faces of the elements
+
+  Each face is identified by its sorted corner nodes. The table uses
+  open addressing with linear probing, and records the number of times
+  each distinct face is added, so that the faces shared by two
+  elements can be found in linear time.
 */
-void TACSFH5Loader::computeNodeToElement(ElementLayout layout, const int *mask,
-                                         int num_sub_indices,
-                                         const int *sub_indices,
-                                         int **_node_to_element_ptr,
-                                         int **_node_to_element) {
-  // Scan through the elements, and figure out how many times
-  // each node is referred to
-  int *node_to_element_ptr = new int[num_nodes_continuous + 1];
-  memset(node_to_element_ptr, 0, (num_nodes_continuous + 1) * sizeof(int));
-  for (int i = 0; i < num_elements; i++) {
-    if (ltypes[i] == layout && !(mask && mask[i])) {
-      if (num_sub_indices > 0) {
-        for (int j = 0; j < num_sub_indices; j++) {
-          int node = conn[ptr[i] + sub_indices[j]];
-          node_to_element_ptr[node + 1]++;
-        }
-      } else {
-        for (int j = ptr[i]; j < ptr[i + 1]; j++) {
-          int node = conn[ptr[j]];
-          node_to_element_ptr[node + 1]++;
-        }
-      }
+class TacsFaceHash {
+ public:
+  TacsFaceHash(int max_faces) {
+    table_size = 1;
+    while (table_size < 2 * max_faces) {
+      table_size *= 2;
     }
+    table = new int[table_size];
+    for (int i = 0; i < table_size; i++) {
+      table[i] = -1;
+    }
+    keys = new int[4 * max_faces];
+    counts = new int[max_faces];
+    num_faces = 0;
   }
-
-  // Set the node pointer
-  for (int i = 1; i <= num_nodes_continuous; i++) {
-    node_to_element_ptr[i] += node_to_element_ptr[i - 1];
+  ~TacsFaceHash() {
+    delete[] table;
+    delete[] keys;
+    delete[] counts;
   }
 
-  // Now, loop over and set the adjacent
-  int *node_to_element = new int[node_to_element_ptr[num_nodes_continuous]];
+  // Add the face and return the index of the distinct face
+  int addFace(const int nodes[]) {
+    int key[4] = {nodes[0], nodes[1], nodes[2], nodes[3]};
+    TacsSort(4, key);
 
-  for (int i = 0; i < num_elements; i++) {
-    if (ltypes[i] == layout && !(mask && mask[i])) {
-      if (num_sub_indices > 0) {
-        for (int j = 0; j < num_sub_indices; j++) {
-          // Only consider the corner nodes
-          int node = conn[ptr[i] + sub_indices[j]];
-          node_to_element[node_to_element_ptr[node]] = i;
-          node_to_element_ptr[node]++;
-        }
-      } else {
-        for (int j = ptr[i]; j < ptr[i + 1]; j++) {
-          // Only consider the corner nodes
-          int node = conn[j];
-          node_to_element[node_to_element_ptr[node]] = i;
-          node_to_element_ptr[node]++;
-        }
+    unsigned int h = 2166136261u;
+    for (int k = 0; k < 4; k++) {
+      h = (h ^ (unsigned int)key[k]) * 16777619u;
+    }
+
+    int mask = table_size - 1;
+    int slot = h & mask;
+    while (table[slot] >= 0) {
+      const int *k = &keys[4 * table[slot]];
+      if (k[0] == key[0] && k[1] == key[1] && k[2] == key[2] &&
+          k[3] == key[3]) {
+        counts[table[slot]]++;
+        return table[slot];
       }
+      slot = (slot + 1) & mask;
     }
-  }
 
-  // Reset the node to element pointer
-  for (int i = num_nodes_continuous; i > 0; i--) {
-    node_to_element_ptr[i] = node_to_element_ptr[i - 1];
+    table[slot] = num_faces;
+    memcpy(&keys[4 * num_faces], key, 4 * sizeof(int));
+    counts[num_faces] = 1;
+    return num_faces++;
   }
-  node_to_element_ptr[0] = 0;
 
-  *_node_to_element_ptr = node_to_element_ptr;
-  *_node_to_element = node_to_element;
-}
+  // Get the number of times the distinct face was added
+  int getCount(int face) { return counts[face]; }
+
+ private:
+  int table_size, num_faces;
+  int *table, *keys, *counts;
+};
 
 /*
   Compute the unique set of triangles representing the
@@ -540,10 +532,13 @@ void TACSFH5Loader::getUnmatchedEdgesAndFaces(
                         (npe - 1) * npe * npe * (j / 4));
     }
 
-    // Compute the node to element data across shared nodes
-    int *node_to_element_ptr, *node_to_element;
-    computeNodeToElement(layout, mask, 8, hex_indices, &node_to_element_ptr,
-                         &node_to_element);
+    // Count the number of elements with this layout
+    int num_layout = 0;
+    for (int i = 0; i < num_elements; i++) {
+      if (ltypes[i] == layout && !(mask && mask[i])) {
+        num_layout++;
+      }
+    }
 
     // Face nodes associated with each edge
     int hex_face_nodes[][4] = {{0, 2, 4, 6}, {1, 3, 5, 7}, {0, 1, 4, 5},
@@ -564,51 +559,26 @@ void TACSFH5Loader::getUnmatchedEdgesAndFaces(
       }
     }
 
-    // Look for elements that are adjacent to one another
-    // via a connected face
-    for (int i = 0; i < num_elements; i++) {
+    // Hash the faces of all the elements. A face is on the boundary
+    // when it is not shared with another element.
+    TacsFaceHash *face_hash = new TacsFaceHash(6 * num_layout);
+    int *face_ids = new int[6 * num_layout];
+    for (int i = 0, n = 0; i < num_elements; i++) {
       if (ltypes[i] == layout && !(mask && mask[i])) {
-        for (int face = 0; face < 6; face++) {
-          int len[4];
-          const int *array[4];
+        for (int face = 0; face < 6; face++, n++) {
+          int nodes[4];
           for (int j = 0; j < 4; j++) {
-            // Pull out the node number from the connectivity and set the
-            // array pointer and length of each element sub-length
-            int node = conn[ptr[i] + hex_face_nodes[face][j]];
-            len[j] = node_to_element_ptr[node + 1] - node_to_element_ptr[node];
-            array[j] = &node_to_element[node_to_element_ptr[node]];
+            nodes[j] = conn[ptr[i] + hex_face_nodes[face][j]];
           }
+          face_ids[n] = face_hash->addFace(nodes);
+        }
+      }
+    }
 
-          // Find if there is an element that shares all the same
-          // face nodes as element i, that
-          int unique_face = 1;
-          for (int j = 0; j < len[0]; j++) {
-            if (array[0][j] != i) {
-              int count = 1;
-
-              // Search through the adjacent nodes
-              for (int n = 1; n < 4; n++) {
-                for (int jj = 0; (jj < len[n] && array[n][jj] <= array[0][j]);
-                     jj++) {
-                  // Check for a matching element number
-                  if (array[n][jj] == array[0][j]) {
-                    count++;
-                    break;
-                  }
-                }
-
-                // Check if it doesn't exist
-                if (count != n + 1) {
-                  break;
-                }
-              }
-
-              if (count == 4) {
-                unique_face = 0;
-                break;
-              }
-            }
-          }
+    for (int i = 0, n = 0; i < num_elements; i++) {
+      if (ltypes[i] == layout && !(mask && mask[i])) {
+        for (int face = 0; face < 6; face++, n++) {
+          int unique_face = (face_hash->getCount(face_ids[n]) == 1);
 
           if (unique_face) {
             // Add the faces
@@ -663,8 +633,8 @@ void TACSFH5Loader::getUnmatchedEdgesAndFaces(
       }
     }
 
-    delete[] node_to_element;
-    delete[] node_to_element_ptr;
+    delete face_hash;
+    delete[] face_ids;
   }
 
   int num_points = 0;
@@ -752,9 +722,126 @@ void TACSFH5Loader::getUnmatchedEdgesAndFaces(
   delete[] global_to_local;
 }
 
+/*
+  The data shared by the threads during the isosurface extraction
+*/
+struct TacsIsoSurfaceData {
+  ElementLayout layout;
+  int npe;
+  const int *mask, *ltypes, *ptr, *conn;
+  const float *data;
+  int incr;
+  const float *xpts;
+  int xpts_incr;
+  float isoval;
+
+  // The element offset and the triangle offsets for each element
+  int elem_offset;
+  int *tri_ptr;
+  float *verts;
+};
+
+/*
+  Extract the triangles for the elements [start, end) relative to the
+  element offset. When verts is NULL, only the number of triangles for
+  each element is counted.
+*/
+static void TacsIsoSurfaceRange(int start, int end, int thread_id,
+                                void *ctx) {
+  TacsIsoSurfaceData *d = (TacsIsoSurfaceData *)ctx;
+  const int hex_ordering_transform[] = {0, 1, 3, 2, 4, 5, 7, 6};
+  const int npe = d->npe;
+
+  for (int n = start; n < end; n++) {
+    int i = n + d->elem_offset;
+    int ntris = 0;
+    if (d->ltypes[i] == d->layout && !(d->mask && d->mask[i])) {
+      for (int iz = 0; iz < npe - 1; iz++) {
+        for (int iy = 0; iy < npe - 1; iy++) {
+          for (int ix = 0; ix < npe - 1; ix++) {
+            TACSMarchingCubesCell cell;
+
+            for (int kk = 0; kk < 2; kk++) {
+              for (int jj = 0; jj < 2; jj++) {
+                for (int ii = 0; ii < 2; ii++) {
+                  // Compute the index
+                  int index = hex_ordering_transform[ii + 2 * jj + 4 * kk];
+
+                  // Compute the offset into the local mesh
+                  int offset =
+                      (ix + ii) + (iy + jj) * npe + (iz + kk) * npe * npe;
+
+                  // Get the node number
+                  int node = d->conn[d->ptr[i] + offset];
+                  cell.val[index] = d->data[d->incr * node];
+
+                  // Extract the node value
+                  const float *vals = &d->xpts[node * d->xpts_incr];
+                  cell.p[index].x = vals[0];
+                  cell.p[index].y = vals[1];
+                  cell.p[index].z = vals[2];
+                }
+              }
+            }
+
+            // Find the additional triangles that are needed
+            TACSMarchingCubesTriangle tris[5];
+            int new_tris = TacsPolygonizeCube(cell, d->isoval, tris);
+
+            // Add the new triangles at the offset for this element
+            if (d->verts) {
+              float *v = &d->verts[9 * (d->tri_ptr[n] + ntris)];
+              for (int k = 0; k < new_tris; k++) {
+                for (int kk = 0; kk < 3; kk++) {
+                  v[0] = tris[k].p[kk].x;
+                  v[1] = tris[k].p[kk].y;
+                  v[2] = tris[k].p[kk].z;
+                  v += 3;
+                }
+              }
+            }
+            ntris += new_tris;
+          }
+        }
+      }
+    }
+
+    if (!d->verts) {
+      d->tri_ptr[n + 1] = ntris;
+    }
+  }
+}
+
+/*
+  Set the number of threads used for the post-processing
+
+  @param num_threads The number of threads
+*/
+void TACSFH5Loader::setNumThreads(int num_threads) {
+  if (thread_info) {
+    thread_info->decref();
+    thread_info = NULL;
+  }
+  if (num_threads > 1) {
+    thread_info = new TACSThreadInfo(num_threads);
+    thread_info->incref();
+  }
+}
+
 /*
   Extract the iso-surface for the given element type.
 
+  The triangles are extracted in two passes over the elements. The
+  first pass counts the triangles for each element, and the offsets of
+  the triangles are then computed by a prefix sum, so that the second
+  pass can write the triangles for each element directly into the
+  output on the threads. The triangles are in the order of the
+  elements regardless of the number of threads.
+
+  When a communicator is provided, the elements are split into
+  contiguous blocks and each processor returns only the triangles for
+  its own block.
+
   @param layout Element layout type to look for
   @param mask Element mask array to apply
   @param isoval The isovalue of the contour
@@ -762,10 +849,12 @@ void TACSFH5Loader::getUnmatchedEdgesAndFaces(
   @param _data Continuous data set to use (overrides index choice)
   @param _ntris Output number of triangles
   @param _verts Triangles vertices
+  @param comm The communicator used to split the elements
 */
 void TACSFH5Loader::getIsoSurfaces(ElementLayout layout, const int *mask,
                                    float isoval, int index, float *_data,
-                                   int *_ntris, float **_verts) {
+                                   int *_ntris, float **_verts,
+                                   MPI_Comm comm) {
   // Set the proper pointer to the data
   int incr = 1;
   float *data = NULL;
@@ -780,19 +869,11 @@ void TACSFH5Loader::getIsoSurfaces(ElementLayout layout, const int *mask,
   int ntris = 0;
   float *verts = NULL;
 
-  // Keep track of the max number of triangles
-  int chunk_size = num_elements;
-  if (num_elements > (1 << 16)) {
-    chunk_size = 1 << 16;
-  }
-  int max_num_tris = 0;
-
-  if (layout == TACS_HEXA_ELEMENT || layout == TACS_HEXA_QUADRATIC_ELEMENT ||
-      layout == TACS_HEXA_CUBIC_ELEMENT ||
-      layout == TACS_HEXA_QUARTIC_ELEMENT ||
-      layout == TACS_HEXA_QUARTIC_ELEMENT) {
-    const int hex_ordering_transform[] = {0, 1, 3, 2, 4, 5, 7, 6};
-
+  if (data &&
+      (layout == TACS_HEXA_ELEMENT || layout == TACS_HEXA_QUADRATIC_ELEMENT ||
+       layout == TACS_HEXA_CUBIC_ELEMENT ||
+       layout == TACS_HEXA_QUARTIC_ELEMENT ||
+       layout == TACS_HEXA_QUARTIC_ELEMENT)) {
     int npe = 2;
     if (layout == TACS_HEXA_QUADRATIC_ELEMENT) {
       npe = 3;
@@ -804,67 +885,59 @@ void TACSFH5Loader::getIsoSurfaces(ElementLayout layout, const int *mask,
       npe = 6;
     }
 
-    for (int i = 0; i < num_elements; i++) {
-      if (ltypes[i] == layout && !(mask && mask[i])) {
-        for (int iz = 0; iz < npe - 1; iz++) {
-          for (int iy = 0; iy < npe - 1; iy++) {
-            for (int ix = 0; ix < npe - 1; ix++) {
-              TACSMarchingCubesCell cell;
-
-              for (int kk = 0; kk < 2; kk++) {
-                for (int jj = 0; jj < 2; jj++) {
-                  for (int ii = 0; ii < 2; ii++) {
-                    // Compute the index
-                    int index = hex_ordering_transform[ii + 2 * jj + 4 * kk];
-
-                    // Compute the offset into the local mesh
-                    int offset =
-                        (ix + ii) + (iy + jj) * npe + (iz + kk) * npe * npe;
-
-                    // Get the node number
-                    int node = conn[ptr[i] + offset];
-                    cell.val[index] = data[incr * node];
-
-                    // Extract the node value
-                    const float *vals =
-                        &continuous_data[node * num_vals_continuous];
-                    cell.p[index].x = vals[0];
-                    cell.p[index].y = vals[1];
-                    cell.p[index].z = vals[2];
-                  }
-                }
-              }
-
-              // Find the additional triangles that are needed
-              TACSMarchingCubesTriangle tris[5];
-              int new_tris = TacsPolygonizeCube(cell, isoval, tris);
-
-              // Expand the buffer if needed
-              if (new_tris + ntris > max_num_tris) {
-                max_num_tris = ntris + new_tris + chunk_size;
-                float *buff = new float[9 * max_num_tris];
-                memcpy(buff, verts, 9 * ntris * sizeof(float));
-                if (verts) {
-                  delete[] verts;
-                }
-                verts = buff;
-              }
+    // Find the block of elements for this processor
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int elem_start = (int)(((long long)num_elements * rank) / size);
+    int elem_end = (int)(((long long)num_elements * (rank + 1)) / size);
+    int num_local = elem_end - elem_start;
+
+    TacsIsoSurfaceData iso;
+    iso.layout = layout;
+    iso.npe = npe;
+    iso.mask = mask;
+    iso.ltypes = ltypes;
+    iso.ptr = ptr;
+    iso.conn = conn;
+    iso.data = data;
+    iso.incr = incr;
+    iso.xpts = continuous_data;
+    iso.xpts_incr = num_vals_continuous;
+    iso.isoval = isoval;
+    iso.elem_offset = elem_start;
+    iso.tri_ptr = new int[num_local + 1];
+    iso.tri_ptr[0] = 0;
+    iso.verts = NULL;
+
+    // Count the triangles for each element
+    const int chunk_size = 256;
+    if (thread_info) {
+      thread_info->parallelFor(num_local, chunk_size, TacsIsoSurfaceRange,
+                               &iso);
+    } else {
+      TacsIsoSurfaceRange(0, num_local, 0, &iso);
+    }
 
-              // Add the new triangles
-              float *v = &verts[9 * ntris];
-              for (int k = 0; k < new_tris; ntris++, k++) {
-                for (int kk = 0; kk < 3; kk++) {
-                  v[0] = tris[k].p[kk].x;
-                  v[1] = tris[k].p[kk].y;
-                  v[2] = tris[k].p[kk].z;
-                  v += 3;
-                }
-              }
-            }
-          }
-        }
+    // Compute the offsets for the triangles of each element
+    for (int n = 0; n < num_local; n++) {
+      iso.tri_ptr[n + 1] += iso.tri_ptr[n];
+    }
+    ntris = iso.tri_ptr[num_local];
+
+    // Write out the triangles
+    if (ntris > 0) {
+      verts = new float[9 * ntris];
+      iso.verts = verts;
+      if (thread_info) {
+        thread_info->parallelFor(num_local, chunk_size, TacsIsoSurfaceRange,
+                                 &iso);
+      } else {
+        TacsIsoSurfaceRange(0, num_local, 0, &iso);
       }
     }
+
+    delete[] iso.tri_ptr;
   }
 
   *_ntris = ntris;
@@ -25,6 +25,10 @@
    via TACSToFH5 into memory. The data can then be accessed via member
    functions. You can copy out the data if you so desire, but only one
    copy of the data is ever stored by TACSFH5Loader.
+
+   The isosurface extraction uses the threads set by setNumThreads()
+   and can be split over the processors of a communicator, with each
+   processor extracting the triangles of its own block of elements.
 */
 class TACSFH5Loader : public TACSObject {
  public:
@@ -34,6 +38,9 @@ class TACSFH5Loader : public TACSObject {
   // Load data from the file
   int loadData(const char *conn_file, const char *data_file = NULL);
 
+  // Set the number of threads used for post-processing
+  void setNumThreads(int num_threads);
+
   // Get the component names/data from the file
   int getNumComponents();
   char *getComponentName(int comp);
@@ -56,7 +63,8 @@ class TACSFH5Loader : public TACSObject {
                                  int *_num_edges, int **_edges, int *_num_faces,
                                  int **_faces);
   void getIsoSurfaces(ElementLayout layout, const int *mask, float isoval,
-                      int index, float *_data, int *_ntris, float **_verts);
+                      int index, float *_data, int *_ntris, float **_verts,
+                      MPI_Comm comm = MPI_COMM_SELF);
   void getUnmatchedEdgesAndFaces(ElementLayout layout, const int *mask,
                                  int index, const float *data, int *_num_points,
                                  float **_points, float **_values,
@@ -64,10 +72,6 @@ class TACSFH5Loader : public TACSObject {
                                  int **_verts);
 
  private:
-  void computeNodeToElement(ElementLayout layout, const int *mask,
-                            int num_sub_indices, const int *sub_indices,
-                            int **_node_to_element_ptr, int **_node_to_element);
-
   // Things associated with the types of elements
   int num_elements;
   int *comp_nums, *ltypes;
@@ -88,6 +92,9 @@ class TACSFH5Loader : public TACSObject {
 
   // Open file that contains the
   TACSFH5File *data_file;
+
+  // The threads used for post-processing
+  TACSThreadInfo *thread_info;
 };
 
 #endif  // TACS_FH5_LOADER_H
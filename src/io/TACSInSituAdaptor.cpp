@@ -0,0 +1,129 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSInSituAdaptor.h"
+
+#include "TACSProfiler.h"
+
+/**
+  Create the in-situ adaptor
+
+  @param assembler The TACSAssembler object
+  @param elem_type The type of element output data to compute
+  @param write_flag The classes of element output data (0 for none)
+*/
+TACSInSituAdaptor::TACSInSituAdaptor(TACSAssembler *_assembler,
+                                     ElementType _elem_type,
+                                     int _write_flag) {
+  assembler = _assembler;
+  assembler->incref();
+
+  // The connectivity, nodes and states are passed as views
+  elem_type = _elem_type;
+  write_flag = _write_flag & (~(TACS_OUTPUT_CONNECTIVITY | TACS_OUTPUT_LOADS));
+  if (TacsGetTotalOutputCount(elem_type, write_flag) == 0) {
+    write_flag = 0;
+  }
+  initialized = 0;
+}
+
+TACSInSituAdaptor::~TACSInSituAdaptor() { assembler->decref(); }
+
+/**
+  Pass the states at a time step to the backend
+
+  The states are set into the assembler so that the element output
+  data is consistent with the states. The rates and accelerations may
+  be NULL, in which case the corresponding views are NULL.
+
+  @param step_num The time step number
+  @param time The simulation time
+  @param q The state variables
+  @param qdot The first time derivative of the state variables
+  @param qddot The second time derivative of the state variables
+*/
+void TACSInSituAdaptor::process(int step_num, double time, TACSBVec *q,
+                                TACSBVec *qdot, TACSBVec *qddot) {
+  TACSProfileScope scope("TACSInSituAdaptor::process");
+  if (!initialized) {
+    initialize();
+    initialized = 1;
+  }
+
+  TACSInSituData data;
+  memset(&data, 0, sizeof(TACSInSituData));
+  data.step_num = step_num;
+  data.time = time;
+
+  // Set up the views of the nodes and the states
+  data.num_owned_nodes = assembler->getNumOwnedNodes();
+  data.num_dep_nodes = assembler->getNumDependentNodes();
+  data.vars_per_node = assembler->getVarsPerNode();
+
+  TACSBVec *X;
+  TacsScalar *array;
+  assembler->getNodes(&X);
+  X->getArray(&array);
+  data.Xpts = array;
+  X->getDepArray(&array);
+  data.Xpts_dep = array;
+
+  q->getArray(&array);
+  data.q = array;
+  q->getDepArray(&array);
+  data.q_dep = array;
+  if (qdot) {
+    qdot->getArray(&array);
+    data.qdot = array;
+    qdot->getDepArray(&array);
+    data.qdot_dep = array;
+  }
+  if (qddot) {
+    qddot->getArray(&array);
+    data.qddot = array;
+    qddot->getDepArray(&array);
+    data.qddot_dep = array;
+  }
+
+  data.num_elements = assembler->getNumElements();
+  assembler->getElementConnectivity(&data.ptr, &data.conn);
+
+  // Compute the element output data, if any is requested
+  data.elem_type = elem_type;
+  float *output_data = NULL;
+  if (write_flag) {
+    assembler->setVariables(q, qdot, qddot);
+    assembler->setSimulationTime(time);
+    assembler->getElementOutputData(elem_type, write_flag,
+                                    &data.num_output_points,
+                                    &data.num_output_vals, &output_data);
+    data.output_data = output_data;
+  }
+
+  execute(&data);
+
+  if (output_data) {
+    delete[] output_data;
+  }
+}
+
+/**
+  Complete the in-situ processing at the end of the time history
+*/
+void TACSInSituAdaptor::finish() {
+  if (initialized) {
+    finalize();
+    initialized = 0;
+  }
+}
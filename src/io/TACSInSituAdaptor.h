@@ -0,0 +1,99 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_IN_SITU_ADAPTOR_H
+#define TACS_IN_SITU_ADAPTOR_H
+
+#include "TACSAssembler.h"
+
+/*
+  The data passed to an in-situ backend at each step
+
+  The arrays of the vectors and the connectivity are views of the
+  data stored by TACS and must not be modified or retained after
+  execute() returns. The node and state arrays are stored node by node
+  for the owned nodes, followed by the dependent nodes in separate
+  arrays. The connectivity uses the global node numbers, where a
+  negative entry -(i+1) refers to the dependent node i on this
+  processor. The element output data is computed by the adaptor in
+  single precision for each node of each element, in the order of the
+  connectivity, and is NULL when no output is requested.
+*/
+struct TACSInSituData {
+  int step_num;
+  double time;
+
+  // The nodes and the states
+  int num_owned_nodes, num_dep_nodes, vars_per_node;
+  const TacsScalar *Xpts, *Xpts_dep;
+  const TacsScalar *q, *q_dep;
+  const TacsScalar *qdot, *qdot_dep;
+  const TacsScalar *qddot, *qddot_dep;
+
+  // The element connectivity
+  int num_elements;
+  const int *ptr, *conn;
+
+  // The element-wise output data
+  ElementType elem_type;
+  int num_output_points, num_output_vals;
+  const float *output_data;
+};
+
+/**
+  An adaptor for in-situ analysis and visualization
+
+  The integrator calls process() at the selected time steps instead
+  of writing the full fields to disk. The adaptor sets up views of the
+  current data and passes them to execute(), which is implemented by a
+  backend such as a ParaView Catalyst or ADIOS2 bridge. The backend
+  may also override initialize(), which is called before the first
+  step is processed, and finalize(), which is called at the end of the
+  time history. All three calls are collective on the communicator of
+  the assembler.
+
+  The element output data is only computed when the write flag
+  selects one or more classes of output with the TACS_OUTPUT_* flags,
+  since this is the only data that is not a view of existing arrays.
+*/
+class TACSInSituAdaptor : public TACSObject {
+ public:
+  TACSInSituAdaptor(TACSAssembler *_assembler,
+                    ElementType _elem_type = TACS_ELEMENT_NONE,
+                    int _write_flag = 0);
+  virtual ~TACSInSituAdaptor();
+
+  // Process the states at a time step
+  // ---------------------------------
+  void process(int step_num, double time, TACSBVec *q, TACSBVec *qdot,
+               TACSBVec *qddot);
+  void finish();
+
+ protected:
+  // Hooks for the backend
+  // ---------------------
+  virtual void initialize() {}
+  virtual void execute(const TACSInSituData *data) = 0;
+  virtual void finalize() {}
+
+  // The Assembler object
+  TACSAssembler *assembler;
+
+ private:
+  ElementType elem_type;  // The element type for the output data
+  int write_flag;         // The classes of element output data
+  int initialized;        // Has initialize() been called
+};
+
+#endif  // TACS_IN_SITU_ADAPTOR_H
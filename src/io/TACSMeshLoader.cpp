@@ -18,10 +18,13 @@
 
 #include "TACSMeshLoader.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "TacsUtilities.h"
+
 /*!
   This is an interface for reading NASTRAN-style files.
 
@@ -119,6 +122,139 @@ static int read_buffer_line(char *line, size_t line_len, size_t *loc,
   return i;
 }
 
+// The maximum depth of nested INCLUDE statements
+static const int TACS_BDF_MAX_INCLUDE_DEPTH = 16;
+
+/*
+  Append data to a buffer, expanding the buffer if needed
+*/
+static void append_bdf_buffer(char **buffer, size_t *len, size_t *max_len,
+                              const char *data, size_t data_len) {
+  if (*len + data_len > *max_len) {
+    *max_len = 2 * (*len + data_len) + 1024;
+    char *temp = new char[*max_len];
+    if (*buffer) {
+      memcpy(temp, *buffer, *len);
+      delete[] *buffer;
+    }
+    *buffer = temp;
+  }
+  memcpy(&(*buffer)[*len], data, data_len);
+  *len += data_len;
+}
+
+/*
+  Read the entire file into a buffer and replace each INCLUDE
+  statement with the contents of the included file.
+
+  The file name in the INCLUDE statement is enclosed in single quotes
+  and must appear on the same line. Relative file names are taken
+  relative to the directory of the file that contains the statement.
+  The included files are expanded recursively, up to a fixed depth to
+  guard against cyclic includes.
+*/
+static int read_bdf_file(const char *file_name, int depth, char **buffer,
+                         size_t *len, size_t *max_len) {
+  if (depth > TACS_BDF_MAX_INCLUDE_DEPTH) {
+    fprintf(stderr, "TACSMeshLoader: INCLUDE nested too deeply in %s\n",
+            file_name);
+    return 1;
+  }
+
+  FILE *fp = fopen(file_name, "r");
+  if (!fp) {
+    fprintf(stderr, "TACSMeshLoader: Unable to open file %s\n", file_name);
+    return 1;
+  }
+
+  // Determine the size of the file and read it in
+  fseek(fp, 0, SEEK_END);
+  size_t file_len = ftell(fp);
+  rewind(fp);
+
+  char *file_buffer = new char[file_len + 1];
+  if (fread(file_buffer, 1, file_len, fp) != file_len) {
+    fprintf(stderr, "TACSMeshLoader: Problem reading file %s\n", file_name);
+    delete[] file_buffer;
+    fclose(fp);
+    return 1;
+  }
+  fclose(fp);
+
+  // Find the length of the directory name, including the separator
+  const char *sep = strrchr(file_name, '/');
+  size_t dir_len = (sep ? sep - file_name + 1 : 0);
+
+  int fail = 0;
+  size_t start = 0, loc = 0;
+  while (loc < file_len && !fail) {
+    // Check whether this line is an INCLUDE statement
+    const char *include = "INCLUDE";
+    size_t k = 0;
+    for (; k < 7 && loc + k < file_len; k++) {
+      if (toupper(file_buffer[loc + k]) != include[k]) {
+        break;
+      }
+    }
+
+    // Find the end of the line
+    size_t end = loc;
+    while (end < file_len && file_buffer[end] != '\n') {
+      end++;
+    }
+
+    if (k == 7) {
+      // Copy the data before the INCLUDE statement
+      append_bdf_buffer(buffer, len, max_len, &file_buffer[start],
+                        loc - start);
+
+      // Extract the quoted file name
+      char *q1 = (char *)memchr(&file_buffer[loc], '\'', end - loc);
+      char *q2 = NULL;
+      if (q1) {
+        q2 = (char *)memchr(q1 + 1, '\'', &file_buffer[end] - (q1 + 1));
+      }
+      if (!q2) {
+        fprintf(stderr, "TACSMeshLoader: Unrecognized INCLUDE in %s\n",
+                file_name);
+        fail = 1;
+        break;
+      }
+
+      size_t name_len = q2 - (q1 + 1);
+      char *include_name = new char[dir_len + name_len + 1];
+      if (q1[1] == '/') {
+        memcpy(include_name, q1 + 1, name_len);
+        include_name[name_len] = '\0';
+      } else {
+        memcpy(include_name, file_name, dir_len);
+        memcpy(&include_name[dir_len], q1 + 1, name_len);
+        include_name[dir_len + name_len] = '\0';
+      }
+
+      fail = read_bdf_file(include_name, depth + 1, buffer, len, max_len);
+      delete[] include_name;
+
+      // Make sure that the included data ends with a new line
+      if (*len > 0 && (*buffer)[*len - 1] != '\n') {
+        append_bdf_buffer(buffer, len, max_len, "\n", 1);
+      }
+
+      start = (end < file_len ? end + 1 : end);
+    }
+
+    loc = end + 1;
+  }
+
+  if (!fail && start < file_len) {
+    append_bdf_buffer(buffer, len, max_len, &file_buffer[start],
+                      file_len - start);
+  }
+  delete[] file_buffer;
+
+  return fail;
+}
+
 /*
   Reverse look up.
 
@@ -420,6 +556,507 @@ static int parse_element_field(size_t *loc, char *buffer,
   return fail;
 }
 
+/*
+  The maximum number of nodes for any of the element types
+*/
+static const int TACS_BDF_MAX_ELEMENT_NODES = 27;
+
+/*
+  The number of bytes read past the end of each processor's range of
+  the file in scanBDFFileParallel(). The cards that start within the
+  range must be complete within this overlap.
+*/
+static const int TACS_BDF_READ_OVERLAP = 16384;
+
+/*
+  The mesh data parsed from a set of cards in a BDF file.
+
+  The sizes are computed in a first pass over the cards, after which
+  the arrays are allocated and filled in during a second pass. All
+  node, element and component numbers are converted to 0-based
+  numbers, but are otherwise left in the file numbering.
+*/
+struct TacsBDFCards {
+  // The sizes of the data
+  int num_nodes, num_elements, num_bcs;
+  int conn_size, bc_vars_size;
+  int max_component, num_descript;
+
+  // The node numbers and locations
+  int *node_nums;
+  double *Xpts;
+
+  // The element numbers, component numbers and connectivity
+  int *elem_nums, *elem_comp;
+  int *conn_ptr, *conn;
+
+  // The boundary conditions
+  int *bc_nodes, *bc_ptr, *bc_vars;
+  TacsScalar *bc_vals;
+
+  // The component information
+  int num_components, descript_offset;
+  char *component_elems, *component_descript;
+};
+
+/*
+  Allocate the arrays for the cards based on the sizes from the first
+  pass
+*/
+static void allocate_bdf_cards(TacsBDFCards *cards) {
+  cards->node_nums = new int[cards->num_nodes];
+  cards->Xpts = new double[3 * cards->num_nodes];
+  cards->elem_nums = new int[cards->num_elements];
+  cards->elem_comp = new int[cards->num_elements];
+  cards->conn_ptr = new int[cards->num_elements + 1];
+  cards->conn = new int[cards->conn_size];
+  cards->bc_nodes = new int[cards->num_bcs];
+  cards->bc_ptr = new int[cards->num_bcs + 1];
+  cards->bc_vars = new int[cards->bc_vars_size];
+  cards->bc_vals = new TacsScalar[cards->bc_vars_size];
+}
+
+/*
+  Free the arrays that are still owned by the cards
+*/
+static void free_bdf_cards(TacsBDFCards *cards) {
+  delete[] cards->node_nums;
+  delete[] cards->Xpts;
+  delete[] cards->elem_nums;
+  delete[] cards->elem_comp;
+  delete[] cards->conn_ptr;
+  delete[] cards->conn;
+  delete[] cards->bc_nodes;
+  delete[] cards->bc_ptr;
+  delete[] cards->bc_vars;
+  delete[] cards->bc_vals;
+}
+
+/*
+  Parse the cards in the buffer that start within [start, end).
+
+  When fill is zero, only the sizes in the cards object are computed.
+  Otherwise the arrays, allocated with the sizes from the first pass,
+  are filled in. Cards that start within the range may extend past its
+  end. If at_eof is zero, the buffer does not extend to the end of the
+  file and every card must be complete before the end of the buffer.
+*/
+static int parse_bdf_cards(char *buffer, size_t buffer_len, size_t start,
+                           size_t end, int at_eof, int fill,
+                           TacsBDFCards *cards) {
+  int fail = 0;
+
+  // Each line can only be 80 characters long
+  char line[81];
+
+  // Space for the node numbers of a single element
+  int temp_nodes[TACS_BDF_MAX_ELEMENT_NODES];
+
+  // Reset the sizes of the things to be read in
+  cards->num_nodes = 0;
+  cards->num_elements = 0;
+  cards->num_bcs = 0;
+  cards->conn_size = 0;
+  cards->bc_vars_size = 0;
+  if (fill) {
+    cards->conn_ptr[0] = 0;
+    cards->bc_ptr[0] = 0;
+  } else {
+    cards->max_component = 0;
+  }
+
+  // Keep track of the component numbers loaded from an
+  // ICEM-generated bdf file
+  int component_counter = 0;
+
+  size_t buffer_loc = start;
+  while (buffer_loc < end) {
+    // Read the first line of the buffer
+    size_t buffer_temp_loc = buffer_loc;
+    if (!read_buffer_line(line, sizeof(line), &buffer_temp_loc, buffer,
+                          buffer_len)) {
+      fail = 1;
+      break;
+    }
+
+    if (strncmp(line, "$       Shell", 13) == 0) {
+      // A standard icem output - description of each
+      // component. This is very useful for describing what the
+      // components actually are with a string.
+      // Again use a fixed width format
+      int comp_num = cards->descript_offset + component_counter;
+      component_counter++;
+
+      if (fill && comp_num >= 0 && comp_num < cards->num_components) {
+        char comp[33];
+        strncpy(comp, &line[41], 32);
+        comp[32] = '\0';
+        // Remove white space
+        sscanf(comp, "%s", &cards->component_descript[33 * comp_num]);
+      }
+    }
+    if (line[0] != '$') {  // A comment line
+      if (strncmp(line, "END BULK", 8) == 0 ||
+          strncmp(line, "ENDDATA", 7) == 0) {
+        break;
+      } else if (strncmp(line, "GRID", 4) == 0) {
+        int node;
+        double x, y, z;
+        if (line[4] == '*') {
+          char line2[81];
+          if (!read_buffer_line(line2, sizeof(line2), &buffer_temp_loc, buffer,
+                                buffer_len)) {
+            fail = 1;
+            break;
+          }
+          parse_node_long_field(line, line2, &node, &x, &y, &z);
+        } else {
+          parse_node_short_free_field(line, &node, &x, &y, &z);
+        }
+
+        if (fill) {
+          int n = cards->num_nodes;
+          cards->node_nums[n] = node - 1;  // Get the C ordering
+          cards->Xpts[3 * n] = x;
+          cards->Xpts[3 * n + 1] = y;
+          cards->Xpts[3 * n + 2] = z;
+        }
+        cards->num_nodes++;
+      } else if (strncmp(line, "SPC", 3) == 0) {
+        if (fill) {
+          // This is a variable-length format. Read in grid points until
+          // zero is reached. This is a fixed-width format
+          // SPC SID  G1  C  D
+
+          // Read in the nodal value
+          char node[9];
+          strncpy(node, &line[16], 8);
+          node[8] = '\0';
+          cards->bc_nodes[cards->num_bcs] = atoi(node) - 1;
+
+          strncpy(node, &line[32], 8);
+          node[8] = '\0';
+          double val = bdf_atof(node);
+
+          // Read in the dof that will be constrained
+          for (int k = 24; k < 32; k++) {
+            char dofs[9] = "12345678";
+
+            for (int j = 0; j < 8; j++) {
+              if (dofs[j] == line[k]) {
+                cards->bc_vars[cards->bc_vars_size] = j;
+                cards->bc_vals[cards->bc_vars_size] = val;
+                cards->bc_vars_size++;
+                break;
+              }
+            }
+          }
+
+          cards->bc_ptr[cards->num_bcs + 1] = cards->bc_vars_size;
+        } else {
+          cards->bc_vars_size += 8;
+        }
+        cards->num_bcs++;
+      } else {
+        // Check the library of elements
+        int max_num_conn = -1;
+        int entry_width = 8;
+
+        // Loop over the number of types and determine the number of
+        // nodes
+        int index = -1;
+        for (int k = 0; k < TacsMeshLoaderNumElementTypes; k++) {
+          int len = strlen(TacsMeshLoaderElementTypes[k]);
+          if (strncmp(line, TacsMeshLoaderElementTypes[k], len) == 0) {
+            max_num_conn = TacsMeshLoaderElementLimits[k][1];
+            index = k;
+
+            // Check if we should use the extended width or not
+            if (line[len] == '*') {
+              entry_width = 16;
+            }
+            break;
+          }
+        }
+
+        if (index >= 0) {
+          // Find the number of entries in the element
+          int elem_num, component_num, num_conn;
+          buffer_temp_loc = buffer_loc;
+          fail = parse_element_field(&buffer_temp_loc, buffer, buffer_len,
+                                     entry_width, max_num_conn, &elem_num,
+                                     &component_num, temp_nodes, &num_conn);
+          if (fail) {
+            fprintf(stderr,
+                    "TACSMeshLoader: Unable to parse element. Line\n %s\n",
+                    line);
+            break;
+          }
+
+          // Check if the number of nodes is within the prescribed limits
+          if (num_conn < TacsMeshLoaderElementLimits[index][0]) {
+            fprintf(stderr,
+                    "TACSMeshLoader: Number of nodes for element %s "
+                    "not within limits\n",
+                    TacsMeshLoaderElementTypes[index]);
+            fail = 1;
+            break;
+          }
+
+          if (fill) {
+            int *conn = &cards->conn[cards->conn_size];
+            if (strncmp(line, "CQUAD4", 6) == 0 ||
+                strncmp(line, "CQUADR", 6) == 0) {
+              conn[0] = temp_nodes[0] - 1;
+              conn[1] = temp_nodes[1] - 1;
+              conn[2] = temp_nodes[3] - 1;
+              conn[3] = temp_nodes[2] - 1;
+            } else if (strncmp(line, "CQUAD9", 6) == 0 ||
+                       strncmp(line, "CQUAD", 5) == 0) {
+              conn[0] = temp_nodes[0] - 1;
+              conn[1] = temp_nodes[4] - 1;
+              conn[2] = temp_nodes[1] - 1;
+              conn[3] = temp_nodes[7] - 1;
+              conn[4] = temp_nodes[8] - 1;
+              conn[5] = temp_nodes[5] - 1;
+              conn[6] = temp_nodes[3] - 1;
+              conn[7] = temp_nodes[6] - 1;
+              conn[8] = temp_nodes[2] - 1;
+            } else if (strncmp(line, "CHEXA", 5) == 0) {
+              conn[0] = temp_nodes[0] - 1;
+              conn[1] = temp_nodes[1] - 1;
+              conn[2] = temp_nodes[3] - 1;
+              conn[3] = temp_nodes[2] - 1;
+              conn[4] = temp_nodes[4] - 1;
+              conn[5] = temp_nodes[5] - 1;
+              conn[6] = temp_nodes[7] - 1;
+              conn[7] = temp_nodes[6] - 1;
+            } else {
+              for (int k = 0; k < num_conn; k++) {
+                conn[k] = temp_nodes[k] - 1;
+              }
+            }
+
+            // Set the element and component numbers
+            int n = cards->num_elements;
+            cards->elem_nums[n] = elem_num - 1;
+            cards->elem_comp[n] = component_num - 1;
+            cards->conn_ptr[n + 1] = cards->conn_size + num_conn;
+
+            int comp = component_num - 1;
+            if (comp < cards->num_components &&
+                cards->component_elems[9 * comp] == '\0') {
+              if (strncmp(line, "CTETRA", 6) == 0 && num_conn == 10) {
+                strcpy(&cards->component_elems[9 * comp], "CTETRA10");
+              } else {
+                strcpy(&cards->component_elems[9 * comp],
+                       TacsMeshLoaderElementTypes[index]);
+              }
+            }
+          } else if (component_num > cards->max_component) {
+            cards->max_component = component_num;
+          }
+
+          cards->conn_size += num_conn;
+          cards->num_elements++;
+        } else if (!fill) {
+          fprintf(stderr, "TACSMeshLoader: Element not recognized. Line\n %s\n",
+                  line);
+        }
+      }
+    }
+
+    // Check that the card did not run past the data that was read
+    if (!at_eof && buffer_temp_loc >= buffer_len) {
+      fprintf(stderr,
+              "TACSMeshLoader: Card extends past the range read from the "
+              "file. Line\n %s\n",
+              line);
+      fail = 1;
+      break;
+    }
+
+    buffer_loc = buffer_temp_loc;
+  }
+
+  if (!fill) {
+    cards->num_descript = component_counter;
+  }
+
+  return fail;
+}
+
+/*
+  Find the processor that owns the given file node or element number.
+
+  The numbers in [0, bound) are split into contiguous intervals of
+  equal length so that the ownership is monotonic in the number.
+*/
+static int get_bdf_owner(int num, int bound, int size) {
+  if (num <= 0 || bound <= 0) {
+    return 0;
+  }
+  int owner = (int)(((long long)num * size) / bound);
+  if (owner >= size) {
+    owner = size - 1;
+  }
+  return owner;
+}
+
+/*
+  Find the index k such that list[k] = var within a sorted list, or
+  return -1 if it is not found
+*/
+static int find_index_sorted(int var, int size, const int *list) {
+  int low = 0, high = size - 1;
+  while (low <= high) {
+    int mid = low + (high - low) / 2;
+    if (list[mid] == var) {
+      return mid;
+    } else if (list[mid] < var) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return -1;
+}
+
+/*
+  Compute the permutation that orders a list of n entries by their
+  destination processor and count the number of entries sent to each
+  processor
+*/
+static int *order_by_dest(int n, const int *dest, int size, int *send_count) {
+  int *send_ptr = new int[size + 1];
+  memset(send_count, 0, size * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    send_count[dest[i]]++;
+  }
+  send_ptr[0] = 0;
+  for (int i = 0; i < size; i++) {
+    send_ptr[i + 1] = send_ptr[i] + send_count[i];
+  }
+
+  int *perm = new int[n];
+  for (int i = 0; i < n; i++) {
+    perm[send_ptr[dest[i]]] = i;
+    send_ptr[dest[i]]++;
+  }
+  delete[] send_ptr;
+
+  return perm;
+}
+
+/*
+  Exchange data ordered by destination with all other processors.
+
+  Processor i is sent send_count[i] items, each consisting of width
+  entries. The received items are returned in a newly allocated array
+  ordered by the source processor, with recv_count[i] items from
+  processor i. The function returns the number of received items.
+*/
+template <typename T>
+static int exchange_bdf_data(MPI_Comm comm, MPI_Datatype dtype, int width,
+                             const int *send_count, const T *send,
+                             int *recv_count, T **recv) {
+  int size;
+  MPI_Comm_size(comm, &size);
+  MPI_Alltoall((void *)send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+
+  int *scount = new int[size];
+  int *sdisp = new int[size];
+  int *rcount = new int[size];
+  int *rdisp = new int[size];
+  int nsend = 0, nrecv = 0;
+  for (int i = 0; i < size; i++) {
+    scount[i] = width * send_count[i];
+    rcount[i] = width * recv_count[i];
+    sdisp[i] = width * nsend;
+    rdisp[i] = width * nrecv;
+    nsend += send_count[i];
+    nrecv += recv_count[i];
+  }
+
+  *recv = new T[width * nrecv];
+  MPI_Alltoallv((void *)send, scount, sdisp, dtype, *recv, rcount, rdisp,
+                dtype, comm);
+
+  delete[] scount;
+  delete[] sdisp;
+  delete[] rcount;
+  delete[] rdisp;
+
+  return nrecv;
+}
+
+/*
+  Convert 0-based file node numbers to the global node numbers from
+  scanBDFFileParallel().
+
+  The file node number i is owned by get_bdf_owner(i) which stores the
+  sorted list of its file node numbers. The corresponding global node
+  numbers are given by owned_nodes or, if it is NULL, are contiguous
+  starting at node_offset. Undefined nodes are set to -1 and the
+  function returns a non-zero fail flag.
+*/
+static int convert_bdf_node_nums(MPI_Comm comm, int bound, int num_owned,
+                                 const int *owned_nums,
+                                 const int *owned_nodes, int node_offset,
+                                 int n, int *nodes) {
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  // Send the node numbers to their owners
+  int *dest = new int[n];
+  for (int i = 0; i < n; i++) {
+    dest[i] = get_bdf_owner(nodes[i], bound, size);
+  }
+  int *send_count = new int[size];
+  int *recv_count = new int[size];
+  int *perm = order_by_dest(n, dest, size, send_count);
+  for (int i = 0; i < n; i++) {
+    dest[i] = nodes[perm[i]];
+  }
+
+  int *recv;
+  int nrecv = exchange_bdf_data(comm, MPI_INT, 1, send_count, dest,
+                                recv_count, &recv);
+  delete[] dest;
+
+  // Look up the global node numbers for the nodes owned here
+  for (int i = 0; i < nrecv; i++) {
+    int index = find_index_sorted(recv[i], num_owned, owned_nums);
+    if (index < 0) {
+      recv[i] = -1;
+    } else if (owned_nodes) {
+      recv[i] = owned_nodes[index];
+    } else {
+      recv[i] = node_offset + index;
+    }
+  }
+
+  // Return the global node numbers in the order they were sent
+  int *result;
+  exchange_bdf_data(comm, MPI_INT, 1, recv_count, recv, send_count, &result);
+  delete[] recv;
+
+  int fail = 0;
+  for (int i = 0; i < n; i++) {
+    nodes[perm[i]] = result[i];
+    if (result[i] < 0) {
+      fail = 1;
+    }
+  }
+
+  delete[] result;
+  delete[] perm;
+  delete[] send_count;
+  delete[] recv_count;
+
+  return fail;
+}
+
 /*
   The TACSMeshLoader class
 
@@ -429,7 +1066,7 @@ static int parse_element_field(size_t *loc, char *buffer,
 
   This constructor simply sets all data to NULL and stores the
   communicator for later use. Note that the file is only scanned on
-  the root processor.
+  the root processor, unless scanBDFFileParallel() is used.
 */
 TACSMeshLoader::TACSMeshLoader(MPI_Comm _comm) {
   comm = _comm;
@@ -455,6 +1092,14 @@ TACSMeshLoader::TACSMeshLoader(MPI_Comm _comm) {
 
   // Set the creator object to NULL
   creator = NULL;
+
+  // The mesh is not distributed until scanBDFFileParallel() is called
+  distributed = 0;
+  node_num_bound = 0;
+  node_range = NULL;
+  num_dir_nodes = 0;
+  dir_file_nums = dir_node_nums = NULL;
+  node_reordering = NULL;
 }
 
 /*
@@ -515,6 +1160,18 @@ TACSMeshLoader::~TACSMeshLoader() {
   if (elem_arg_sort_list) {
     delete[] elem_arg_sort_list;
   }
+  if (node_range) {
+    delete[] node_range;
+  }
+  if (dir_file_nums) {
+    delete[] dir_file_nums;
+  }
+  if (dir_node_nums) {
+    delete[] dir_node_nums;
+  }
+  if (node_reordering) {
+    delete[] node_reordering;
+  }
 
   // Free the creator object
   if (creator) {
@@ -573,393 +1230,83 @@ int TACSMeshLoader::scanBDFFile(const char *file_name) {
 
   const int root = 0;
   if (rank == root) {
-    FILE *fp = fopen(file_name, "r");
-    if (!fp) {
-      fprintf(stderr, "TACSMeshLoader: Unable to open file %s\n", file_name);
-      fail = 1;
+    // Read the entire file, with the included files expanded in place
+    char *buffer = NULL;
+    size_t buffer_len = 0, max_buffer_len = 0;
+    fail = read_bdf_file(file_name, 0, &buffer, &buffer_len, &max_buffer_len);
+    if (fail) {
+      if (buffer) {
+        delete[] buffer;
+      }
       MPI_Abort(comm, fail);
       return fail;
     }
 
-    // Count up the number of nodes, elements and size of connectivity data
-    num_nodes = 0;
-    num_elements = 0;
-    num_components = 0;
-    num_bcs = 0;
-
-    // The size of the connectivity arrays
-    int elem_conn_size = 0;
-    int bc_vars_size = 0;
-
     // Each line can only be 80 characters long
     char line[81];
 
-    // Determine the size of the file
-    fseek(fp, 0, SEEK_END);
-    size_t buffer_len = ftell(fp);
-    rewind(fp);
-
-    // Allocate enough space to store the entire file
-    char *buffer = new char[buffer_len];
-    if (fread(buffer, 1, buffer_len, fp) != buffer_len) {
-      fprintf(stderr, "[%d] TACSMeshLoader: Problem reading file %s\n", rank,
-              file_name);
-      MPI_Abort(comm, 1);
-      return 1;
-    }
-    fclose(fp);
-
     // Keep track of where the current point in the buffer is
     size_t buffer_loc = 0;
     read_buffer_line(line, sizeof(line), &buffer_loc, buffer, buffer_len);
 
     // Flags which indicate where the bulk data begins
-    int in_bulk = 0;
     int bulk_start = 0;
 
     // Scan the file for the begin bulk location. If none exists, then
     // the whole file is treated as bulk data.
     while (buffer_loc < buffer_len) {
       if (strncmp(line, "BEGIN BULK", 10) == 0) {
-        in_bulk = 1;
         bulk_start = buffer_loc;
       }
       read_buffer_line(line, sizeof(line), &buffer_loc, buffer, buffer_len);
     }
 
-    // Treat the entire file as bulk data
-    if (!in_bulk) {
-      in_bulk = 1;
-    }
+    // Count up the number of nodes, elements and size of connectivity
+    // data, then allocate everything and read in the data
+    TacsBDFCards cards;
+    memset(&cards, 0, sizeof(cards));
+    fail = parse_bdf_cards(buffer, buffer_len, bulk_start, buffer_len, 1, 0,
+                           &cards);
 
-    // Set the starting location
-    buffer_loc = bulk_start;
+    // Allocate space for storing the component names
+    num_components = cards.max_component;
+    component_elems = new char[9 * num_components];
+    component_descript = new char[33 * num_components];
+    memset(component_elems, '\0', 9 * num_components * sizeof(char));
+    memset(component_descript, '\0', 33 * num_components * sizeof(char));
 
-    // Keep track of the maximum number of nodes defined by
-    // any of the elements
-    int max_element_conn = -1;
+    cards.num_components = num_components;
+    cards.component_elems = component_elems;
+    cards.component_descript = component_descript;
+    allocate_bdf_cards(&cards);
 
-    while (buffer_loc < buffer_len) {
-      // Read the first line of the buffer
-      size_t buffer_temp_loc = buffer_loc;
-      if (!read_buffer_line(line, sizeof(line), &buffer_temp_loc, buffer,
-                            buffer_len)) {
-        fail = 1;
-        break;
-      }
-
-      if (line[0] != '$') {
-        if (in_bulk && (strncmp(line, "END BULK", 8) == 0 ||
-                        strncmp(line, "ENDDATA", 7) == 0)) {
-          buffer_temp_loc = buffer_len;
-        } else if (strncmp(line, "GRID*", 5) == 0) {
-          char line2[81];
-          if (!read_buffer_line(line2, sizeof(line2), &buffer_temp_loc, buffer,
-                                buffer_len)) {
-            fail = 1;
-            break;
-          }
-          int node;
-          double x, y, z;
-          parse_node_long_field(line, line2, &node, &x, &y, &z);
-          num_nodes++;
-        } else if (strncmp(line, "GRID", 4) == 0) {
-          int node;
-          double x, y, z;
-          parse_node_short_free_field(line, &node, &x, &y, &z);
-          num_nodes++;
-        } else if (strncmp(line, "SPC", 3) == 0) {
-          bc_vars_size += 8;
-          num_bcs++;
-        } else {
-          // Check the library of elements
-          int max_num_conn = -1;
-          int entry_width = 8;
-
-          // Loop over the number of types and determine the number of
-          // nodes
-          int index = -1;
-          for (int k = 0; k < TacsMeshLoaderNumElementTypes; k++) {
-            int len = strlen(TacsMeshLoaderElementTypes[k]);
-            if (strncmp(line, TacsMeshLoaderElementTypes[k], len) == 0) {
-              max_num_conn = TacsMeshLoaderElementLimits[k][1];
-              index = k;
-
-              // Check if we should use the extended width or not
-              if (line[len] == '*') {
-                entry_width = 16;
-              }
-              break;
-            }
-          }
-
-          if (index >= 0) {
-            // Find the number of entries in the element
-            int elem_num, component_num, num_conn;
-            buffer_temp_loc = buffer_loc;
-            int fail = parse_element_field(&buffer_temp_loc, buffer, buffer_len,
-                                           entry_width, max_num_conn, &elem_num,
-                                           &component_num, NULL, &num_conn);
-            if (fail) {
-              break;
-            }
-
-            // Check if the number of nodes is within the prescribed limits
-            if (num_conn < TacsMeshLoaderElementLimits[index][0]) {
-              fprintf(stderr,
-                      "TACSMeshLoader: Number of nodes for element %s "
-                      "not within limits\n",
-                      TacsMeshLoaderElementTypes[index]);
-              fail = 1;
-              break;
-            }
-
-            elem_conn_size += num_conn;
-            num_elements++;
-            if (num_conn > max_element_conn) {
-              max_element_conn = num_conn;
-            }
-            if (component_num > num_components) {
-              num_components = component_num;
-            }
-          } else {
-            fprintf(stderr,
-                    "TACSMeshLoader: Element not recognized. Line\n %s\n",
-                    line);
-          }
-        }
-      }
-
-      buffer_loc = buffer_temp_loc;
-    }
-
-    // Allocate space to store the node numbers
-    int *temp_nodes = new int[max_element_conn];
-
-    // Allocate space for everything
-    file_node_nums = new int[num_nodes];
-    double *file_Xpts = new double[3 * num_nodes];
-
-    // Element type information
-    file_elem_nums = new int[num_elements];
-    int *file_comp = new int[num_elements];
-
-    // The connectivity information
-    int *file_conn = new int[elem_conn_size];
-    int *file_conn_ptr = new int[num_elements + 1];
-    file_conn_ptr[0] = 0;
-
-    // Boundary condition information
-    bc_nodes = new int[num_bcs];
-    bc_ptr = new int[num_bcs + 1];
-    bc_vals = new TacsScalar[bc_vars_size];
-    bc_vars = new int[bc_vars_size];
-    bc_ptr[0] = 0;
-
-    // Allocate space for storing the component names
-    component_elems = new char[9 * num_components];
-    component_descript = new char[33 * num_components];
-    memset(component_elems, '\0', 9 * num_components * sizeof(char));
-    memset(component_descript, '\0', 33 * num_components * sizeof(char));
-
-    // Reset the sizes of the things to be read in
-    num_nodes = 0;
-    num_elements = 0;
-    num_bcs = 0;
-    elem_conn_size = 0;
-    bc_vars_size = 0;
-
-    // Rewind to the beginning of the bulk section and allocate everything
-    buffer_loc = bulk_start;
-
-    // Keep track of the component numbers loaded from an
-    // ICEM-generated bdf file
-    int component_counter = 0;
-
-    while (buffer_loc < buffer_len) {
-      // Read the first line of the buffer
-      size_t buffer_temp_loc = buffer_loc;
-      if (!read_buffer_line(line, sizeof(line), &buffer_temp_loc, buffer,
-                            buffer_len)) {
-        fail = 1;
-        break;
-      }
-
-      if (strncmp(line, "$       Shell", 13) == 0) {
-        // A standard icem output - description of each
-        // component. This is very useful for describing what the
-        // components actually are with a string.
-        // Again use a fixed width format
-        char comp[33];
-        int comp_num = component_counter;
-        component_counter++;
-
-        strncpy(comp, &line[41], 32);
-        comp[32] = '\0';
-        // Remove white space
-        if (comp_num >= 0 && comp_num < num_components) {
-          sscanf(comp, "%s", &component_descript[33 * comp_num]);
-        }
-      }
-      if (line[0] != '$') {  // A comment line
-        if (in_bulk && (strncmp(line, "END BULK", 8) == 0 ||
-                        strncmp(line, "ENDDATA", 7) == 0)) {
-          buffer_temp_loc = buffer_len;
-        } else if (strncmp(line, "GRID*", 5) == 0) {
-          char line2[81];
-          if (!read_buffer_line(line2, sizeof(line2), &buffer_temp_loc, buffer,
-                                buffer_len)) {
-            fail = 1;
-            break;
-          }
-          int node;
-          double x, y, z;
-          parse_node_long_field(line, line2, &node, &x, &y, &z);
-          file_node_nums[num_nodes] = node - 1;  // Get the C ordering
-          file_Xpts[3 * num_nodes] = x;
-          file_Xpts[3 * num_nodes + 1] = y;
-          file_Xpts[3 * num_nodes + 2] = z;
-          num_nodes++;
-        } else if (strncmp(line, "GRID", 4) == 0) {
-          int node;
-          double x, y, z;
-          parse_node_short_free_field(line, &node, &x, &y, &z);
-          file_node_nums[num_nodes] = node - 1;  // Get the C ordering
-          file_Xpts[3 * num_nodes] = x;
-          file_Xpts[3 * num_nodes + 1] = y;
-          file_Xpts[3 * num_nodes + 2] = z;
-          num_nodes++;
-        } else if (strncmp(line, "SPC", 3) == 0) {
-          // This is a variable-length format. Read in grid points until
-          // zero is reached. This is a fixed-width format
-          // SPC SID  G1  C  D
-
-          // Read in the nodal value
-          char node[9];
-          strncpy(node, &line[16], 8);
-          node[8] = '\0';
-          bc_nodes[num_bcs] = atoi(node) - 1;
-
-          strncpy(node, &line[32], 8);
-          node[8] = '\0';
-          double val = bdf_atof(node);
-
-          // Read in the dof that will be constrained
-          for (int k = 24; k < 32; k++) {
-            char dofs[9] = "12345678";
-
-            for (int j = 0; j < 8; j++) {
-              if (dofs[j] == line[k]) {
-                bc_vars[bc_vars_size] = j;
-                bc_vals[bc_vars_size] = val;
-                bc_vars_size++;
-                break;
-              }
-            }
-          }
-
-          bc_ptr[num_bcs + 1] = bc_vars_size;
-          num_bcs++;
-        } else {
-          // Check the library of elements
-          int max_num_conn = -1;
-          int entry_width = 8;
-
-          // Loop over the number of types and determine the number of
-          // nodes
-          int index = -1;
-          for (int k = 0; k < TacsMeshLoaderNumElementTypes; k++) {
-            int len = strlen(TacsMeshLoaderElementTypes[k]);
-            if (strncmp(line, TacsMeshLoaderElementTypes[k], len) == 0) {
-              max_num_conn = TacsMeshLoaderElementLimits[k][1];
-              index = k;
-
-              // Check if we should use the extended width or not
-              if (line[len] == '*') {
-                entry_width = 16;
-              }
-              break;
-            }
-          }
-
-          if (index >= 0) {
-            // Find the number of entries in the element
-            int elem_num, component_num, num_conn;
-            buffer_temp_loc = buffer_loc;
-            int fail = parse_element_field(
-                &buffer_temp_loc, buffer, buffer_len, entry_width, max_num_conn,
-                &elem_num, &component_num, temp_nodes, &num_conn);
-            if (fail) {
-              break;
-            }
-
-            if (strncmp(line, "CQUAD4", 6) == 0 ||
-                strncmp(line, "CQUADR", 6) == 0) {
-              file_conn[elem_conn_size] = temp_nodes[0] - 1;
-              file_conn[elem_conn_size + 1] = temp_nodes[1] - 1;
-              file_conn[elem_conn_size + 2] = temp_nodes[3] - 1;
-              file_conn[elem_conn_size + 3] = temp_nodes[2] - 1;
-            } else if (strncmp(line, "CQUAD9", 6) == 0 ||
-                       strncmp(line, "CQUAD", 5) == 0) {
-              file_conn[elem_conn_size] = temp_nodes[0] - 1;
-              file_conn[elem_conn_size + 1] = temp_nodes[4] - 1;
-              file_conn[elem_conn_size + 2] = temp_nodes[1] - 1;
-              file_conn[elem_conn_size + 3] = temp_nodes[7] - 1;
-              file_conn[elem_conn_size + 4] = temp_nodes[8] - 1;
-              file_conn[elem_conn_size + 5] = temp_nodes[5] - 1;
-              file_conn[elem_conn_size + 6] = temp_nodes[3] - 1;
-              file_conn[elem_conn_size + 7] = temp_nodes[6] - 1;
-              file_conn[elem_conn_size + 8] = temp_nodes[2] - 1;
-            } else if (strncmp(line, "CHEXA", 5) == 0) {
-              file_conn[elem_conn_size] = temp_nodes[0] - 1;
-              file_conn[elem_conn_size + 1] = temp_nodes[1] - 1;
-              file_conn[elem_conn_size + 2] = temp_nodes[3] - 1;
-              file_conn[elem_conn_size + 3] = temp_nodes[2] - 1;
-              file_conn[elem_conn_size + 4] = temp_nodes[4] - 1;
-              file_conn[elem_conn_size + 5] = temp_nodes[5] - 1;
-              file_conn[elem_conn_size + 6] = temp_nodes[7] - 1;
-              file_conn[elem_conn_size + 7] = temp_nodes[6] - 1;
-            } else {
-              for (int k = 0; k < num_conn; k++) {
-                file_conn[elem_conn_size + k] = temp_nodes[k] - 1;
-              }
-            }
-
-            // Set the node numbers
-            file_elem_nums[num_elements] = elem_num - 1;
-            file_comp[num_elements] = component_num - 1;
-
-            elem_conn_size += num_conn;
-            file_conn_ptr[num_elements + 1] = elem_conn_size;
-            num_elements++;
-
-            if (component_elems[9 * (component_num - 1)] == '\0') {
-              if (strncmp(line, "CTETRA", 6) == 0 && num_conn == 10) {
-                strcpy(&component_elems[9 * (component_num - 1)], "CTETRA10");
-              } else {
-                strcpy(&component_elems[9 * (component_num - 1)],
-                       TacsMeshLoaderElementTypes[index]);
-              }
-            }
-          } else {
-            fprintf(stderr,
-                    "TACSMeshLoader: Element not recognized. Line\n %s\n",
-                    line);
-          }
-        }
-      }
-
-      buffer_loc = buffer_temp_loc;
+    if (!fail) {
+      fail = parse_bdf_cards(buffer, buffer_len, bulk_start, buffer_len, 1, 1,
+                             &cards);
     }
 
     delete[] buffer;
-    delete[] temp_nodes;
 
     if (fail) {
+      free_bdf_cards(&cards);
       MPI_Abort(comm, fail);
       return fail;
     }
 
+    // Take the file node/element numbers and the boundary conditions
+    num_nodes = cards.num_nodes;
+    num_elements = cards.num_elements;
+    num_bcs = cards.num_bcs;
+    file_node_nums = cards.node_nums;
+    file_elem_nums = cards.elem_nums;
+    bc_nodes = cards.bc_nodes;
+    bc_ptr = cards.bc_ptr;
+    bc_vars = cards.bc_vars;
+    bc_vals = cards.bc_vals;
+    cards.node_nums = cards.elem_nums = NULL;
+    cards.bc_nodes = cards.bc_ptr = cards.bc_vars = NULL;
+    cards.bc_vals = NULL;
+
     // Arg sort the list of nodes
     node_arg_sort_list = new int[num_nodes];
     for (int k = 0; k < num_nodes; k++) {
@@ -989,13 +1336,12 @@ int TACSMeshLoader::scanBDFFile(const char *file_name) {
     for (int k = 0; k < num_nodes; k++) {
       int n = node_arg_sort_list[k];
       for (int j = 0; j < 3; j++) {
-        Xpts[3 * k + j] = file_Xpts[3 * n + j];
+        Xpts[3 * k + j] = cards.Xpts[3 * n + j];
       }
     }
-    delete[] file_Xpts;
 
     // Read in the connectivity array and store the information
-    elem_node_conn = new int[elem_conn_size];
+    elem_node_conn = new int[cards.conn_size];
     elem_node_ptr = new int[num_elements + 1];
     elem_component = new int[num_elements];
 
@@ -1005,8 +1351,8 @@ int TACSMeshLoader::scanBDFFile(const char *file_name) {
     for (int k = 0, n = 0; k < num_elements; k++) {
       int e = elem_arg_sort_list[k];
 
-      for (int j = file_conn_ptr[e]; j < file_conn_ptr[e + 1]; j++, n++) {
-        int node_num = file_conn[j];
+      for (int j = cards.conn_ptr[e]; j < cards.conn_ptr[e + 1]; j++, n++) {
+        int node_num = cards.conn[j];
 
         // Find node_num in the list
         int node = find_index_arg_sorted(node_num, num_nodes, file_node_nums,
@@ -1019,7 +1365,7 @@ int TACSMeshLoader::scanBDFFile(const char *file_name) {
         }
       }
 
-      elem_component[k] = file_comp[e];
+      elem_component[k] = cards.elem_comp[e];
       elem_node_ptr[k + 1] = n;
     }
 
@@ -1036,9 +1382,7 @@ int TACSMeshLoader::scanBDFFile(const char *file_name) {
     }
 
     // Free data that has been allocated locally
-    delete[] file_comp;
-    delete[] file_conn;
-    delete[] file_conn_ptr;
+    free_bdf_cards(&cards);
   }
 
   // Distribute the component numbers and descritpions
@@ -1059,7 +1403,998 @@ int TACSMeshLoader::scanBDFFile(const char *file_name) {
 }
 
 /*
-  Retrieve the number of nodes in the model
+  Scan a Nastran BDF file in parallel.
+
+  Each processor reads a contiguous range of bytes from the file with
+  MPI-IO and parses the cards whose first line starts within its
+  range. The nodes, elements and boundary conditions are then
+  redistributed with collective exchanges so that each processor owns
+  a contiguous interval of the file node and element numbers. The
+  nodes and elements are numbered in the same sorted order as
+  scanBDFFile(), but the mesh is never stored on a single processor.
+
+  After this call the data is distributed: getConnectivity() and
+  getBCs() return the locally owned elements, nodes and boundary
+  conditions in terms of the global node numbers, and createTACS()
+  creates TACSAssembler directly from this data. Note that the
+  partition follows the file numbering and is not a graph partition
+  of the mesh.
+*/
+int TACSMeshLoader::scanBDFFileParallel(const char *file_name) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  int fail = 0;
+
+  MPI_File fp = NULL;
+  if (MPI_File_open(comm, (char *)file_name, MPI_MODE_RDONLY, MPI_INFO_NULL,
+                    &fp) != MPI_SUCCESS) {
+    fprintf(stderr, "[%d] TACSMeshLoader: Unable to open file %s\n", rank,
+            file_name);
+    fail = 1;
+    MPI_Abort(comm, fail);
+    return fail;
+  }
+
+  // Split the file into contiguous ranges of bytes
+  MPI_Offset file_size;
+  MPI_File_get_size(fp, &file_size);
+  MPI_Offset chunk = (file_size + size - 1) / size;
+  MPI_Offset start = rank * chunk;
+  if (start > file_size) {
+    start = file_size;
+  }
+  MPI_Offset end = start + chunk;
+  if (end > file_size) {
+    end = file_size;
+  }
+
+  // Read the character before the range to find the first line that
+  // starts within it, and read past its end for the continuation lines
+  MPI_Offset read_start = (start > 0 ? start - 1 : 0);
+  MPI_Offset read_end = end + TACS_BDF_READ_OVERLAP;
+  if (read_end > file_size) {
+    read_end = file_size;
+  }
+  size_t buffer_len = read_end - read_start;
+  char *buffer = new char[buffer_len + 1];
+
+  // Read the data in pieces so that each count fits within an int
+  const size_t max_piece = 1 << 30;
+  int num_pieces = (buffer_len + max_piece - 1) / max_piece;
+  MPI_Allreduce(MPI_IN_PLACE, &num_pieces, 1, MPI_INT, MPI_MAX, comm);
+  for (int i = 0; i < num_pieces; i++) {
+    size_t offset = i * max_piece;
+    int count = 0;
+    if (offset < buffer_len) {
+      count = (buffer_len - offset < max_piece ? buffer_len - offset
+                                               : max_piece);
+    } else {
+      offset = 0;
+    }
+    MPI_File_read_at_all(fp, read_start + offset, &buffer[offset], count,
+                         MPI_CHAR, MPI_STATUS_IGNORE);
+  }
+  MPI_File_close(&fp);
+
+  // The local range within the buffer
+  size_t loc = start - read_start;
+  size_t local_end = end - read_start;
+  if (start > 0) {
+    while (loc < local_end && buffer[loc - 1] != '\n') {
+      loc++;
+    }
+  }
+
+  // Each line can only be 80 characters long
+  char line[81];
+
+  // Find the location of the bulk data. If the begin bulk statement
+  // appears more than once, use the last one.
+  long long bulk_start = 0;
+  for (size_t pos = loc; pos < local_end;) {
+    read_buffer_line(line, sizeof(line), &pos, buffer, buffer_len);
+    if (strncmp(line, "BEGIN BULK", 10) == 0) {
+      bulk_start = read_start + pos;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &bulk_start, 1, MPI_LONG_LONG_INT, MPI_MAX,
+                comm);
+
+  if (bulk_start > (long long)(read_start + loc)) {
+    loc = bulk_start - read_start;
+  } else if (start > 0) {
+    // Skip the continuation lines of a card from the previous range
+    while (loc < local_end && (buffer[loc] == ' ' || buffer[loc] == '*')) {
+      read_buffer_line(line, sizeof(line), &loc, buffer, buffer_len);
+    }
+  }
+
+  // Find the end of the bulk data
+  long long bulk_end = file_size;
+  for (size_t pos = loc; pos < local_end;) {
+    size_t line_start = pos;
+    read_buffer_line(line, sizeof(line), &pos, buffer, buffer_len);
+    if (strncmp(line, "END BULK", 8) == 0 || strncmp(line, "ENDDATA", 7) == 0) {
+      bulk_end = read_start + line_start;
+      break;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &bulk_end, 1, MPI_LONG_LONG_INT, MPI_MIN, comm);
+  if (bulk_end < (long long)(read_start + local_end)) {
+    local_end = (bulk_end > read_start ? bulk_end - read_start : 0);
+  }
+
+  // Count the cards within the range
+  int at_eof = (read_end == file_size);
+  TacsBDFCards cards;
+  memset(&cards, 0, sizeof(cards));
+  fail = parse_bdf_cards(buffer, buffer_len, loc, local_end, at_eof, 0, &cards);
+
+  // Find the number of components and the offset for the component
+  // descriptions within this range
+  MPI_Allreduce(&cards.max_component, &num_components, 1, MPI_INT, MPI_MAX,
+                comm);
+  MPI_Exscan(&cards.num_descript, &cards.descript_offset, 1, MPI_INT, MPI_SUM,
+             comm);
+  if (rank == 0) {
+    cards.descript_offset = 0;
+  }
+
+  component_elems = new char[9 * num_components];
+  component_descript = new char[33 * num_components];
+  memset(component_elems, '\0', 9 * num_components * sizeof(char));
+  memset(component_descript, '\0', 33 * num_components * sizeof(char));
+
+  // Read in the data
+  cards.num_components = num_components;
+  cards.component_elems = component_elems;
+  cards.component_descript = component_descript;
+  allocate_bdf_cards(&cards);
+
+  if (!fail) {
+    fail = parse_bdf_cards(buffer, buffer_len, loc, local_end, at_eof, 1,
+                           &cards);
+  }
+  delete[] buffer;
+
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  if (fail) {
+    free_bdf_cards(&cards);
+    MPI_Abort(comm, fail);
+    return fail;
+  }
+
+  // The element type of each component is taken from its first
+  // element in the file, which is on the lowest rank that defines it
+  int *comp_owner = new int[num_components];
+  for (int k = 0; k < num_components; k++) {
+    comp_owner[k] = (component_elems[9 * k] != '\0' ? rank : size);
+  }
+  MPI_Allreduce(MPI_IN_PLACE, comp_owner, num_components, MPI_INT, MPI_MIN,
+                comm);
+  for (int k = 0; k < num_components; k++) {
+    if (comp_owner[k] != rank) {
+      memset(&component_elems[9 * k], '\0', 9 * sizeof(char));
+    }
+  }
+  delete[] comp_owner;
+  MPI_Allreduce(MPI_IN_PLACE, component_elems, 9 * num_components, MPI_BYTE,
+                MPI_BOR, comm);
+  MPI_Allreduce(MPI_IN_PLACE, component_descript, 33 * num_components,
+                MPI_BYTE, MPI_BOR, comm);
+
+  int *send_count = new int[size];
+  int *recv_count = new int[size];
+
+  // Send the nodes to the processor that owns their file node number
+  node_num_bound = 0;
+  for (int i = 0; i < cards.num_nodes; i++) {
+    if (cards.node_nums[i] + 1 > node_num_bound) {
+      node_num_bound = cards.node_nums[i] + 1;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &node_num_bound, 1, MPI_INT, MPI_MAX, comm);
+
+  int *dest = new int[cards.num_nodes];
+  for (int i = 0; i < cards.num_nodes; i++) {
+    dest[i] = get_bdf_owner(cards.node_nums[i], node_num_bound, size);
+  }
+  int *perm = order_by_dest(cards.num_nodes, dest, size, send_count);
+  delete[] dest;
+
+  int *send_nums = new int[cards.num_nodes];
+  double *send_Xpts = new double[3 * cards.num_nodes];
+  for (int i = 0; i < cards.num_nodes; i++) {
+    int n = perm[i];
+    send_nums[i] = cards.node_nums[n];
+    for (int j = 0; j < 3; j++) {
+      send_Xpts[3 * i + j] = cards.Xpts[3 * n + j];
+    }
+  }
+  delete[] perm;
+
+  int *recv_nums;
+  double *recv_Xpts;
+  num_nodes = exchange_bdf_data(comm, MPI_INT, 1, send_count, send_nums,
+                                recv_count, &recv_nums);
+  exchange_bdf_data(comm, MPI_DOUBLE, 3, send_count, send_Xpts, recv_count,
+                    &recv_Xpts);
+  delete[] send_nums;
+  delete[] send_Xpts;
+
+  // Sort the owned nodes by their file node number
+  int *sort_list = new int[num_nodes];
+  for (int k = 0; k < num_nodes; k++) {
+    sort_list[k] = k;
+  }
+  arg_sort_list = recv_nums;
+  qsort(sort_list, num_nodes, sizeof(int), compare_arg_sort);
+  arg_sort_list = NULL;
+
+  file_node_nums = new int[num_nodes];
+  Xpts = new TacsScalar[3 * num_nodes];
+  for (int k = 0; k < num_nodes; k++) {
+    int n = sort_list[k];
+    file_node_nums[k] = recv_nums[n];
+    for (int j = 0; j < 3; j++) {
+      Xpts[3 * k + j] = recv_Xpts[3 * n + j];
+    }
+  }
+  delete[] sort_list;
+  delete[] recv_nums;
+  delete[] recv_Xpts;
+
+  // Set the global node ranges
+  node_range = new int[size + 1];
+  node_range[0] = 0;
+  MPI_Allgather(&num_nodes, 1, MPI_INT, &node_range[1], 1, MPI_INT, comm);
+  for (int i = 0; i < size; i++) {
+    node_range[i + 1] += node_range[i];
+  }
+
+  // Send the elements to the processor that owns their file element
+  // number
+  int elem_num_bound = 0;
+  for (int i = 0; i < cards.num_elements; i++) {
+    if (cards.elem_nums[i] + 1 > elem_num_bound) {
+      elem_num_bound = cards.elem_nums[i] + 1;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &elem_num_bound, 1, MPI_INT, MPI_MAX, comm);
+
+  dest = new int[cards.num_elements];
+  for (int i = 0; i < cards.num_elements; i++) {
+    dest[i] = get_bdf_owner(cards.elem_nums[i], elem_num_bound, size);
+  }
+  perm = order_by_dest(cards.num_elements, dest, size, send_count);
+
+  // Pack the element number, component and number of nodes, followed
+  // separately by the connectivity
+  int *conn_count = new int[size];
+  memset(conn_count, 0, size * sizeof(int));
+  int *send_elems = new int[3 * cards.num_elements];
+  int *send_conn = new int[cards.conn_size];
+  for (int i = 0, c = 0; i < cards.num_elements; i++) {
+    int e = perm[i];
+    int nconn = cards.conn_ptr[e + 1] - cards.conn_ptr[e];
+    send_elems[3 * i] = cards.elem_nums[e];
+    send_elems[3 * i + 1] = cards.elem_comp[e];
+    send_elems[3 * i + 2] = nconn;
+    conn_count[dest[e]] += nconn;
+    for (int j = cards.conn_ptr[e]; j < cards.conn_ptr[e + 1]; j++, c++) {
+      send_conn[c] = cards.conn[j];
+    }
+  }
+  delete[] dest;
+  delete[] perm;
+
+  int *recv_elems, *recv_conn;
+  num_elements = exchange_bdf_data(comm, MPI_INT, 3, send_count, send_elems,
+                                   recv_count, &recv_elems);
+  exchange_bdf_data(comm, MPI_INT, 1, conn_count, send_conn, recv_count,
+                    &recv_conn);
+  delete[] conn_count;
+  delete[] send_elems;
+  delete[] send_conn;
+
+  int *recv_ptr = new int[num_elements + 1];
+  recv_ptr[0] = 0;
+  for (int i = 0; i < num_elements; i++) {
+    recv_ptr[i + 1] = recv_ptr[i] + recv_elems[3 * i + 2];
+  }
+
+  // Sort the owned elements by their file element number
+  int *recv_elem_nums = new int[num_elements];
+  sort_list = new int[num_elements];
+  for (int k = 0; k < num_elements; k++) {
+    recv_elem_nums[k] = recv_elems[3 * k];
+    sort_list[k] = k;
+  }
+  arg_sort_list = recv_elem_nums;
+  qsort(sort_list, num_elements, sizeof(int), compare_arg_sort);
+  arg_sort_list = NULL;
+
+  file_elem_nums = new int[num_elements];
+  elem_component = new int[num_elements];
+  elem_node_ptr = new int[num_elements + 1];
+  elem_node_conn = new int[recv_ptr[num_elements]];
+  elem_node_ptr[0] = 0;
+  for (int k = 0, n = 0; k < num_elements; k++) {
+    int e = sort_list[k];
+    file_elem_nums[k] = recv_elems[3 * e];
+    elem_component[k] = recv_elems[3 * e + 1];
+    for (int j = recv_ptr[e]; j < recv_ptr[e + 1]; j++, n++) {
+      elem_node_conn[n] = recv_conn[j];
+    }
+    elem_node_ptr[k + 1] = n;
+  }
+  delete[] sort_list;
+  delete[] recv_elem_nums;
+  delete[] recv_elems;
+  delete[] recv_conn;
+  delete[] recv_ptr;
+
+  // Convert the connectivity to the global node numbers
+  fail = convert_bdf_node_nums(comm, node_num_bound, num_nodes, file_node_nums,
+                               NULL, node_range[rank],
+                               elem_node_ptr[num_elements], elem_node_conn);
+
+  // Send the boundary conditions to the processor that owns the node
+  dest = new int[cards.num_bcs];
+  for (int i = 0; i < cards.num_bcs; i++) {
+    dest[i] = get_bdf_owner(cards.bc_nodes[i], node_num_bound, size);
+  }
+  perm = order_by_dest(cards.num_bcs, dest, size, send_count);
+
+  int *vars_count = new int[size];
+  memset(vars_count, 0, size * sizeof(int));
+  int *send_bcs = new int[2 * cards.num_bcs];
+  int *send_vars = new int[cards.bc_vars_size];
+  TacsScalar *send_vals = new TacsScalar[cards.bc_vars_size];
+  for (int i = 0, c = 0; i < cards.num_bcs; i++) {
+    int b = perm[i];
+    int nvars = cards.bc_ptr[b + 1] - cards.bc_ptr[b];
+    send_bcs[2 * i] = cards.bc_nodes[b];
+    send_bcs[2 * i + 1] = nvars;
+    vars_count[dest[b]] += nvars;
+    for (int j = cards.bc_ptr[b]; j < cards.bc_ptr[b + 1]; j++, c++) {
+      send_vars[c] = cards.bc_vars[j];
+      send_vals[c] = cards.bc_vals[j];
+    }
+  }
+  delete[] dest;
+  delete[] perm;
+
+  int *recv_bcs;
+  num_bcs = exchange_bdf_data(comm, MPI_INT, 2, send_count, send_bcs,
+                              recv_count, &recv_bcs);
+  exchange_bdf_data(comm, MPI_INT, 1, vars_count, send_vars, recv_count,
+                    &bc_vars);
+  exchange_bdf_data(comm, TACS_MPI_TYPE, 1, vars_count, send_vals,
+                    recv_count, &bc_vals);
+  delete[] vars_count;
+  delete[] send_bcs;
+  delete[] send_vars;
+  delete[] send_vals;
+
+  bc_nodes = new int[num_bcs];
+  bc_ptr = new int[num_bcs + 1];
+  bc_ptr[0] = 0;
+  for (int k = 0; k < num_bcs; k++) {
+    int index = find_index_sorted(recv_bcs[2 * k], num_nodes, file_node_nums);
+    if (index < 0) {
+      fail = 1;
+      bc_nodes[k] = -1;
+    } else {
+      bc_nodes[k] = node_range[rank] + index;
+    }
+    bc_ptr[k + 1] = bc_ptr[k] + recv_bcs[2 * k + 1];
+  }
+  delete[] recv_bcs;
+
+  delete[] send_count;
+  delete[] recv_count;
+  free_bdf_cards(&cards);
+
+  elements = new TACSElement *[num_components];
+  for (int k = 0; k < num_components; k++) {
+    elements[k] = NULL;
+  }
+
+  distributed = 1;
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+
+  return fail;
+}
+
+/*
+  The binary mesh cache format.
+
+  The file starts with a header of TACS_MESH_CACHE_HEADER 64-bit
+  integers:
+
+  [magic, version, size, sizeof(TacsScalar), num_components, reordered]
+
+  followed by the element type (9 chars) and the description (33
+  chars) of each component, padded to a multiple of 8 bytes. Next is
+  a table with TACS_MESH_CACHE_HEADER 64-bit integers for each
+  processor:
+
+  [offset, num_nodes, num_elements, conn_size, num_bcs, bc_vars_size]
+
+  The data for each processor is stored at its offset, which is a
+  multiple of 8 bytes, in the following order: the node locations and
+  the boundary condition values (TacsScalar), then the element
+  pointer, connectivity and components, the file node numbers, the
+  node reordering, and the boundary condition nodes, pointer and
+  variables (int). All node numbers are the global node numbers before
+  reordering, and the file node numbers are 0-based.
+*/
+static const long long TACS_MESH_CACHE_MAGIC = 0x54414353434d5348LL;
+static const long long TACS_MESH_CACHE_VERSION = 1;
+static const int TACS_MESH_CACHE_HEADER = 6;
+
+/*
+  Round up the number of bytes to a multiple of 8
+*/
+static long long pad_cache_bytes(long long bytes) {
+  return 8 * ((bytes + 7) / 8);
+}
+
+/*
+  Read or write a large block of data in pieces so that each count
+  fits within an int. This is collective on all processors in comm.
+*/
+static void access_cache_data(MPI_Comm comm, MPI_File fp, MPI_Offset offset,
+                              char *data, size_t len, int write_flag) {
+  const size_t max_piece = 1 << 30;
+  int num_pieces = (len + max_piece - 1) / max_piece;
+  MPI_Allreduce(MPI_IN_PLACE, &num_pieces, 1, MPI_INT, MPI_MAX, comm);
+  for (int i = 0; i < num_pieces; i++) {
+    size_t start = i * max_piece;
+    int count = 0;
+    if (start < len) {
+      count = (len - start < max_piece ? len - start : max_piece);
+    } else {
+      start = 0;
+    }
+    if (write_flag) {
+      MPI_File_write_at_all(fp, offset + start, &data[start], count, MPI_BYTE,
+                            MPI_STATUS_IGNORE);
+    } else {
+      MPI_File_read_at_all(fp, offset + start, &data[start], count, MPI_BYTE,
+                           MPI_STATUS_IGNORE);
+    }
+  }
+}
+
+/*
+  Write a binary snapshot of the partitioned mesh.
+
+  The snapshot stores the mesh in the partitioned form used to create
+  the TACSAssembler object, including the node locations, boundary
+  conditions, component numbers and the node reordering. Subsequent
+  runs with the same number of processors can call readMeshCache() in
+  place of scanning the BDF file. Each processor writes its own part of
+  the file with MPI-IO.
+
+  This must be called after the assembler has been created with this
+  object, and is collective on all processors.
+*/
+int TACSMeshLoader::writeMeshCache(TACSAssembler *assembler,
+                                   const char *file_name) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const int *owner_range;
+  assembler->getNodeMap()->getOwnerRange(&owner_range);
+  int vars_per_node = assembler->getVarsPerNode();
+  int nnodes = assembler->getNumOwnedNodes();
+  int nelems = assembler->getNumElements();
+  int offset = owner_range[rank];
+
+  // Get the reordering and its inverse for the owned nodes
+  int reordered = assembler->isReordered();
+  int *reordering = new int[nnodes];
+  int *inverse = new int[nnodes];
+  assembler->getReordering(reordering);
+  for (int k = 0; k < nnodes; k++) {
+    inverse[reordering[k] - offset] = offset + k;
+  }
+
+  // Get the node locations in the original order
+  TACSBVec *X = assembler->createNodeVec();
+  X->incref();
+  assembler->getNodes(X);
+  TacsScalar *X_vals;
+  X->getArray(&X_vals);
+  TacsScalar *X_orig = new TacsScalar[3 * nnodes];
+  for (int k = 0; k < nnodes; k++) {
+    int n = reordering[k] - offset;
+    for (int j = 0; j < 3; j++) {
+      X_orig[3 * k + j] = X_vals[3 * n + j];
+    }
+  }
+  X->decref();
+
+  // Convert the connectivity back to the original node numbers. The
+  // owners of the nodes convert the reordered node numbers.
+  const int *ptr, *conn;
+  assembler->getElementConnectivity(&ptr, &conn);
+  int conn_size = ptr[nelems];
+  int *conn_orig = new int[conn_size];
+  int *dest = new int[conn_size];
+  TACSNodeMap *node_map = assembler->getNodeMap();
+  for (int i = 0; i < conn_size; i++) {
+    dest[i] = (conn[i] >= 0 ? node_map->getNodeOwner(conn[i]) : rank);
+  }
+  int *send_count = new int[size];
+  int *recv_count = new int[size];
+  int *perm = order_by_dest(conn_size, dest, size, send_count);
+  for (int i = 0; i < conn_size; i++) {
+    dest[i] = conn[perm[i]];
+  }
+
+  int *recv;
+  int nrecv = exchange_bdf_data(comm, MPI_INT, 1, send_count, dest,
+                                recv_count, &recv);
+  for (int i = 0; i < nrecv; i++) {
+    if (recv[i] >= 0) {
+      recv[i] = inverse[recv[i] - offset];
+    }
+  }
+
+  int *result;
+  exchange_bdf_data(comm, MPI_INT, 1, recv_count, recv, send_count, &result);
+  for (int i = 0; i < conn_size; i++) {
+    conn_orig[perm[i]] = result[i];
+  }
+  delete[] recv;
+  delete[] result;
+  delete[] perm;
+  delete[] dest;
+  delete[] send_count;
+  delete[] recv_count;
+
+  // Get the component numbers
+  TACSElement **elems = assembler->getElements();
+  int *comp = new int[nelems];
+  for (int i = 0; i < nelems; i++) {
+    comp[i] = (elems[i] ? elems[i]->getComponentNum() : -1);
+  }
+
+  // Convert the boundary conditions, stored as binary flags for each
+  // node, back to lists of variables. The boundary condition map also
+  // contains the external nodes after initialize(), so only the owned
+  // nodes are stored.
+  const int *bc_node_nums, *bc_var_flags;
+  TacsScalar *bc_values;
+  int nbc_map = assembler->getBcMap()->getBCs(&bc_node_nums, &bc_var_flags,
+                                              &bc_values);
+  int nbcs = 0, nbc_vars = 0;
+  for (int i = 0; i < nbc_map; i++) {
+    if (bc_node_nums[i] >= offset && bc_node_nums[i] < offset + nnodes) {
+      nbcs++;
+      for (int j = 0; j < vars_per_node; j++) {
+        if (bc_var_flags[i] & (1 << j)) {
+          nbc_vars++;
+        }
+      }
+    }
+  }
+  int *bcn = new int[nbcs];
+  int *bcp = new int[nbcs + 1];
+  int *bcv = new int[nbc_vars];
+  TacsScalar *bcvals = new TacsScalar[nbc_vars];
+  bcp[0] = 0;
+  for (int i = 0, k = 0, n = 0; i < nbc_map; i++) {
+    if (bc_node_nums[i] >= offset && bc_node_nums[i] < offset + nnodes) {
+      bcn[k] = inverse[bc_node_nums[i] - offset];
+      for (int j = 0; j < vars_per_node; j++) {
+        if (bc_var_flags[i] & (1 << j)) {
+          bcv[n] = j;
+          bcvals[n] = bc_values[vars_per_node * i + j];
+          n++;
+        }
+      }
+      bcp[k + 1] = n;
+      k++;
+    }
+  }
+
+  // Find the file node numbers for the owned nodes
+  int *file_nums = new int[nnodes];
+  for (int k = 0; k < nnodes; k++) {
+    file_nums[k] = -1;
+  }
+  if (distributed && creator) {
+    // Send the file node numbers from the processors that read them to
+    // the new owners of the nodes
+    const int *new_nodes;
+    int n = creator->getNodeNums(&new_nodes);
+    int *dest = new int[n];
+    int *index = new int[n];
+    int count = 0;
+    for (int k = 0; k < n; k++) {
+      if (new_nodes[k] >= 0) {
+        dest[count] = TacsFindInterval(new_nodes[k], size + 1, owner_range);
+        index[count] = k;
+        count++;
+      }
+    }
+    int *send_count = new int[size];
+    int *recv_count = new int[size];
+    int *perm = order_by_dest(count, dest, size, send_count);
+    int *pairs = new int[2 * count];
+    for (int i = 0; i < count; i++) {
+      int k = index[perm[i]];
+      pairs[2 * i] = new_nodes[k];
+      pairs[2 * i + 1] = file_node_nums[k];
+    }
+    delete[] dest;
+    delete[] index;
+    delete[] perm;
+
+    int *recv_pairs;
+    int nrecv = exchange_bdf_data(comm, MPI_INT, 2, send_count, pairs,
+                                  recv_count, &recv_pairs);
+    for (int i = 0; i < nrecv; i++) {
+      file_nums[recv_pairs[2 * i] - offset] = recv_pairs[2 * i + 1];
+    }
+    delete[] pairs;
+    delete[] recv_pairs;
+    delete[] send_count;
+    delete[] recv_count;
+  } else if (distributed && file_node_nums) {
+    memcpy(file_nums, file_node_nums, nnodes * sizeof(int));
+  } else if (creator) {
+    // Assemble the file node numbers on the root processor and send
+    // them to the owners
+    int *all_file_nums = NULL;
+    int *counts = new int[size];
+    for (int i = 0; i < size; i++) {
+      counts[i] = owner_range[i + 1] - owner_range[i];
+    }
+    if (rank == 0) {
+      const int *new_nodes;
+      creator->getNodeNums(&new_nodes);
+      all_file_nums = new int[owner_range[size]];
+      for (int i = 0; i < num_nodes; i++) {
+        all_file_nums[new_nodes[i]] = file_node_nums[node_arg_sort_list[i]];
+      }
+    }
+    MPI_Scatterv(all_file_nums, counts, (int *)owner_range, MPI_INT,
+                 file_nums, nnodes, MPI_INT, 0, comm);
+    delete[] counts;
+    if (all_file_nums) {
+      delete[] all_file_nums;
+    }
+  }
+
+  // Compute the size of the data for this processor
+  long long scalar_size = 3 * nnodes + nbc_vars;
+  long long int_size = (nelems + 1) + conn_size + nelems + 2 * nnodes + nbcs +
+                       (nbcs + 1) + nbc_vars;
+  long long bytes = pad_cache_bytes(scalar_size * sizeof(TacsScalar) +
+                                    int_size * sizeof(int));
+
+  // Find the offset for this processor's data
+  long long header_bytes =
+      8 * TACS_MESH_CACHE_HEADER + pad_cache_bytes(42 * num_components);
+  long long table_bytes = 8 * TACS_MESH_CACHE_HEADER * size;
+  long long data_offset = 0;
+  MPI_Exscan(&bytes, &data_offset, 1, MPI_LONG_LONG_INT, MPI_SUM, comm);
+  if (rank == 0) {
+    data_offset = 0;
+  }
+  data_offset += header_bytes + table_bytes;
+
+  // Pack the data for this processor
+  char *data = new char[bytes];
+  memset(data, 0, bytes);
+  char *p = data;
+  memcpy(p, X_orig, 3 * nnodes * sizeof(TacsScalar));
+  p += 3 * nnodes * sizeof(TacsScalar);
+  memcpy(p, bcvals, nbc_vars * sizeof(TacsScalar));
+  p += nbc_vars * sizeof(TacsScalar);
+  memcpy(p, ptr, (nelems + 1) * sizeof(int));
+  p += (nelems + 1) * sizeof(int);
+  memcpy(p, conn_orig, conn_size * sizeof(int));
+  p += conn_size * sizeof(int);
+  memcpy(p, comp, nelems * sizeof(int));
+  p += nelems * sizeof(int);
+  memcpy(p, file_nums, nnodes * sizeof(int));
+  p += nnodes * sizeof(int);
+  memcpy(p, reordering, nnodes * sizeof(int));
+  p += nnodes * sizeof(int);
+  memcpy(p, bcn, nbcs * sizeof(int));
+  p += nbcs * sizeof(int);
+  memcpy(p, bcp, (nbcs + 1) * sizeof(int));
+  p += (nbcs + 1) * sizeof(int);
+  memcpy(p, bcv, nbc_vars * sizeof(int));
+
+  delete[] reordering;
+  delete[] inverse;
+  delete[] X_orig;
+  delete[] conn_orig;
+  delete[] comp;
+  delete[] bcn;
+  delete[] bcp;
+  delete[] bcv;
+  delete[] bcvals;
+  delete[] file_nums;
+
+  // Gather the table of offsets and sizes on the root processor
+  long long entry[TACS_MESH_CACHE_HEADER];
+  entry[0] = data_offset;
+  entry[1] = nnodes;
+  entry[2] = nelems;
+  entry[3] = conn_size;
+  entry[4] = nbcs;
+  entry[5] = nbc_vars;
+  long long *table = NULL;
+  if (rank == 0) {
+    table = new long long[TACS_MESH_CACHE_HEADER * size];
+  }
+  MPI_Gather(entry, TACS_MESH_CACHE_HEADER, MPI_LONG_LONG_INT, table,
+             TACS_MESH_CACHE_HEADER, MPI_LONG_LONG_INT, 0, comm);
+
+  MPI_File fp = NULL;
+  if (MPI_File_open(comm, (char *)file_name, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS) {
+    fprintf(stderr, "[%d] TACSMeshLoader: Unable to open file %s\n", rank,
+            file_name);
+    delete[] data;
+    if (table) {
+      delete[] table;
+    }
+    return 1;
+  }
+  MPI_File_set_size(fp, 0);
+
+  // Write the header, the component information and the table
+  if (rank == 0) {
+    long long header[TACS_MESH_CACHE_HEADER];
+    header[0] = TACS_MESH_CACHE_MAGIC;
+    header[1] = TACS_MESH_CACHE_VERSION;
+    header[2] = size;
+    header[3] = sizeof(TacsScalar);
+    header[4] = num_components;
+    header[5] = reordered;
+
+    char *comp_data = new char[header_bytes - 8 * TACS_MESH_CACHE_HEADER];
+    memset(comp_data, 0, header_bytes - 8 * TACS_MESH_CACHE_HEADER);
+    memcpy(comp_data, component_elems, 9 * num_components);
+    memcpy(&comp_data[9 * num_components], component_descript,
+           33 * num_components);
+
+    MPI_File_write_at(fp, 0, header, TACS_MESH_CACHE_HEADER,
+                      MPI_LONG_LONG_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8 * TACS_MESH_CACHE_HEADER, comp_data,
+                      header_bytes - 8 * TACS_MESH_CACHE_HEADER, MPI_BYTE,
+                      MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, header_bytes, table, TACS_MESH_CACHE_HEADER * size,
+                      MPI_LONG_LONG_INT, MPI_STATUS_IGNORE);
+    delete[] comp_data;
+    delete[] table;
+  }
+
+  // Write the data for each processor
+  access_cache_data(comm, fp, data_offset, data, bytes, 1);
+  MPI_File_close(&fp);
+  delete[] data;
+
+  return 0;
+}
+
+/*
+  Read a binary snapshot of the partitioned mesh written by
+  writeMeshCache().
+
+  Each processor reads its own part of the file with MPI-IO. The cache
+  must have been written with the same number of processors. After
+  this call the mesh is distributed in the same way as after
+  scanBDFFileParallel(), and createTACS() creates the TACSAssembler
+  object with the stored partition and reordering, ignoring the
+  ordering arguments.
+*/
+int TACSMeshLoader::readMeshCache(const char *file_name) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  MPI_File fp = NULL;
+  if (MPI_File_open(comm, (char *)file_name, MPI_MODE_RDONLY, MPI_INFO_NULL,
+                    &fp) != MPI_SUCCESS) {
+    fprintf(stderr, "[%d] TACSMeshLoader: Unable to open file %s\n", rank,
+            file_name);
+    return 1;
+  }
+
+  // Read and check the header
+  long long header[TACS_MESH_CACHE_HEADER];
+  MPI_File_read_at_all(fp, 0, header, TACS_MESH_CACHE_HEADER,
+                       MPI_LONG_LONG_INT, MPI_STATUS_IGNORE);
+  if (header[0] != TACS_MESH_CACHE_MAGIC ||
+      header[1] != TACS_MESH_CACHE_VERSION) {
+    fprintf(stderr, "[%d] TACSMeshLoader: %s is not a mesh cache file\n", rank,
+            file_name);
+    MPI_File_close(&fp);
+    return 1;
+  } else if (header[2] != size || header[3] != sizeof(TacsScalar)) {
+    fprintf(stderr,
+            "[%d] TACSMeshLoader: Mesh cache %s was written for %lld "
+            "processors with %lld-byte scalars\n",
+            rank, file_name, header[2], header[3]);
+    MPI_File_close(&fp);
+    return 1;
+  }
+
+  // Read the component information
+  num_components = header[4];
+  int reordered = header[5];
+  long long header_bytes =
+      8 * TACS_MESH_CACHE_HEADER + pad_cache_bytes(42 * num_components);
+  component_elems = new char[9 * num_components];
+  component_descript = new char[33 * num_components];
+  MPI_File_read_at_all(fp, 8 * TACS_MESH_CACHE_HEADER, component_elems,
+                       9 * num_components, MPI_CHAR, MPI_STATUS_IGNORE);
+  MPI_File_read_at_all(fp, 8 * TACS_MESH_CACHE_HEADER + 9 * num_components,
+                       component_descript, 33 * num_components, MPI_CHAR,
+                       MPI_STATUS_IGNORE);
+
+  // Read the table entry for this processor
+  long long entry[TACS_MESH_CACHE_HEADER];
+  MPI_File_read_at_all(fp, header_bytes + 8 * TACS_MESH_CACHE_HEADER * rank,
+                       entry, TACS_MESH_CACHE_HEADER, MPI_LONG_LONG_INT,
+                       MPI_STATUS_IGNORE);
+  num_nodes = entry[1];
+  num_elements = entry[2];
+  int conn_size = entry[3];
+  num_bcs = entry[4];
+  int nbc_vars = entry[5];
+
+  // Read the data for this processor
+  long long scalar_size = 3 * num_nodes + nbc_vars;
+  long long int_size = (num_elements + 1) + conn_size + num_elements +
+                       2 * num_nodes + num_bcs + (num_bcs + 1) + nbc_vars;
+  long long bytes = pad_cache_bytes(scalar_size * sizeof(TacsScalar) +
+                                    int_size * sizeof(int));
+  char *data = new char[bytes];
+  access_cache_data(comm, fp, entry[0], data, bytes, 0);
+  MPI_File_close(&fp);
+
+  // Unpack the data
+  Xpts = new TacsScalar[3 * num_nodes];
+  bc_vals = new TacsScalar[nbc_vars];
+  elem_node_ptr = new int[num_elements + 1];
+  elem_node_conn = new int[conn_size];
+  elem_component = new int[num_elements];
+  file_node_nums = new int[num_nodes];
+  node_reordering = new int[num_nodes];
+  bc_nodes = new int[num_bcs];
+  bc_ptr = new int[num_bcs + 1];
+  bc_vars = new int[nbc_vars];
+
+  char *p = data;
+  memcpy(Xpts, p, 3 * num_nodes * sizeof(TacsScalar));
+  p += 3 * num_nodes * sizeof(TacsScalar);
+  memcpy(bc_vals, p, nbc_vars * sizeof(TacsScalar));
+  p += nbc_vars * sizeof(TacsScalar);
+  memcpy(elem_node_ptr, p, (num_elements + 1) * sizeof(int));
+  p += (num_elements + 1) * sizeof(int);
+  memcpy(elem_node_conn, p, conn_size * sizeof(int));
+  p += conn_size * sizeof(int);
+  memcpy(elem_component, p, num_elements * sizeof(int));
+  p += num_elements * sizeof(int);
+  memcpy(file_node_nums, p, num_nodes * sizeof(int));
+  p += num_nodes * sizeof(int);
+  memcpy(node_reordering, p, num_nodes * sizeof(int));
+  p += num_nodes * sizeof(int);
+  memcpy(bc_nodes, p, num_bcs * sizeof(int));
+  p += num_bcs * sizeof(int);
+  memcpy(bc_ptr, p, (num_bcs + 1) * sizeof(int));
+  p += (num_bcs + 1) * sizeof(int);
+  memcpy(bc_vars, p, nbc_vars * sizeof(int));
+  delete[] data;
+
+  if (!reordered) {
+    delete[] node_reordering;
+    node_reordering = NULL;
+  }
+
+  // Set the global node ranges
+  node_range = new int[size + 1];
+  node_range[0] = 0;
+  MPI_Allgather(&num_nodes, 1, MPI_INT, &node_range[1], 1, MPI_INT, comm);
+  for (int i = 0; i < size; i++) {
+    node_range[i + 1] += node_range[i];
+  }
+
+  // Create the directory from the file node numbers to the global
+  // node numbers. Each entry is sent to the owner of the file number.
+  node_num_bound = 0;
+  int num_file_nodes = 0;
+  for (int k = 0; k < num_nodes; k++) {
+    if (file_node_nums[k] >= 0) {
+      num_file_nodes++;
+      if (file_node_nums[k] + 1 > node_num_bound) {
+        node_num_bound = file_node_nums[k] + 1;
+      }
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &node_num_bound, 1, MPI_INT, MPI_MAX, comm);
+
+  int *dest = new int[num_file_nodes];
+  int *pairs = new int[2 * num_file_nodes];
+  for (int k = 0, n = 0; k < num_nodes; k++) {
+    if (file_node_nums[k] >= 0) {
+      dest[n] = get_bdf_owner(file_node_nums[k], node_num_bound, size);
+      n++;
+    }
+  }
+  int *send_count = new int[size];
+  int *recv_count = new int[size];
+  int *perm = order_by_dest(num_file_nodes, dest, size, send_count);
+  int *file_index = new int[num_file_nodes];
+  for (int k = 0, n = 0; k < num_nodes; k++) {
+    if (file_node_nums[k] >= 0) {
+      file_index[n] = k;
+      n++;
+    }
+  }
+  for (int i = 0; i < num_file_nodes; i++) {
+    int k = file_index[perm[i]];
+    pairs[2 * i] = file_node_nums[k];
+    pairs[2 * i + 1] = node_range[rank] + k;
+  }
+  delete[] file_index;
+  delete[] perm;
+  delete[] dest;
+
+  int *recv_pairs;
+  num_dir_nodes = exchange_bdf_data(comm, MPI_INT, 2, send_count, pairs,
+                                    recv_count, &recv_pairs);
+  delete[] pairs;
+  delete[] send_count;
+  delete[] recv_count;
+
+  // Sort the directory by the file node number
+  int *dir_nums = new int[num_dir_nodes];
+  int *sort_list = new int[num_dir_nodes];
+  for (int k = 0; k < num_dir_nodes; k++) {
+    dir_nums[k] = recv_pairs[2 * k];
+    sort_list[k] = k;
+  }
+  arg_sort_list = dir_nums;
+  qsort(sort_list, num_dir_nodes, sizeof(int), compare_arg_sort);
+  arg_sort_list = NULL;
+
+  dir_file_nums = new int[num_dir_nodes];
+  dir_node_nums = new int[num_dir_nodes];
+  for (int k = 0; k < num_dir_nodes; k++) {
+    dir_file_nums[k] = recv_pairs[2 * sort_list[k]];
+    dir_node_nums[k] = recv_pairs[2 * sort_list[k] + 1];
+  }
+  delete[] dir_nums;
+  delete[] sort_list;
+  delete[] recv_pairs;
+
+  elements = new TACSElement *[num_components];
+  for (int k = 0; k < num_components; k++) {
+    elements[k] = NULL;
+  }
+
+  distributed = 1;
+
+  return 0;
+}
+
+/*
+  Retrieve the number of nodes in the model, or the number of nodes
+  owned by this processor when the mesh is distributed
 */
 int TACSMeshLoader::getNumNodes() { return num_nodes; }
 
@@ -1094,6 +2429,10 @@ TACSToFH5 *TACSMeshLoader::createTACSToFH5(TACSAssembler *tacs,
 TACSAssembler *TACSMeshLoader::createTACS(
     int vars_per_node, TACSAssembler::OrderingType order_type,
     TACSAssembler::MatrixOrderingType mat_type) {
+  if (distributed) {
+    return createDistributedTACS(vars_per_node, order_type, mat_type);
+  }
+
   // Set the root processor
   const int root = 0;
 
@@ -1148,7 +2487,169 @@ TACSAssembler *TACSMeshLoader::createTACS(
 }
 
 /*
-  Retrieve the number of elements owned by this processes
+  Create TACSAssembler from the mesh distributed by
+  scanBDFFileParallel() or readMeshCache().
+
+  The mesh from scanBDFFileParallel() is partitioned in parallel and
+  migrated to its new owners by the TACSCreator object. The mesh from
+  readMeshCache() is already partitioned, so TACSAssembler is created
+  directly without the TACSCreator object.
+*/
+TACSAssembler *TACSMeshLoader::createDistributedTACS(
+    int vars_per_node, TACSAssembler::OrderingType order_type,
+    TACSAssembler::MatrixOrderingType mat_type) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  if (!dir_file_nums) {
+    creator = new TACSCreator(comm, vars_per_node);
+    creator->incref();
+    creator->setReorderingType(order_type, mat_type);
+
+    // Set the distributed mesh. The nodes on each processor are
+    // numbered contiguously from node_range[rank].
+    creator->setDistributedConnectivity(num_nodes, num_elements,
+                                        elem_node_ptr, elem_node_conn,
+                                        elem_component);
+    creator->setBoundaryConditions(num_bcs, bc_nodes, bc_ptr, bc_vars,
+                                   bc_vals);
+    creator->setNodes(Xpts);
+
+    // Free things that are no longer required
+    delete[] elem_node_ptr;
+    elem_node_ptr = NULL;
+    delete[] elem_node_conn;
+    elem_node_conn = NULL;
+    delete[] elem_component;
+    elem_component = NULL;
+    delete[] bc_nodes;
+    bc_nodes = NULL;
+    delete[] bc_ptr;
+    bc_ptr = NULL;
+    delete[] bc_vars;
+    bc_vars = NULL;
+    delete[] bc_vals;
+    bc_vals = NULL;
+
+    creator->setElements(num_components, elements);
+
+    return creator->createTACS();
+  }
+
+  TACSAssembler *tacs =
+      new TACSAssembler(comm, vars_per_node, num_nodes, num_elements);
+
+  // Set the connectivity in terms of the global node numbers
+  tacs->setElementConnectivity(elem_node_ptr, elem_node_conn);
+
+  // Set the elements from their component numbers
+  TACSElement **elems = new TACSElement *[num_elements];
+  for (int k = 0; k < num_elements; k++) {
+    elems[k] = NULL;
+    if (elem_component[k] >= 0 && elem_component[k] < num_components) {
+      elems[k] = elements[elem_component[k]];
+    }
+    if (!elems[k]) {
+      fprintf(stderr,
+              "[%d] TACSMeshLoader: Element undefined for component %d\n",
+              rank, elem_component[k]);
+      MPI_Abort(comm, 1);
+      return NULL;
+    }
+  }
+  tacs->setElements(elems);
+  delete[] elems;
+
+  // Set the boundary conditions for the locally owned nodes
+  int *bvars = new int[vars_per_node];
+  TacsScalar *bvals = new TacsScalar[vars_per_node];
+  for (int k = 0; k < num_bcs; k++) {
+    if (bc_nodes[k] >= 0) {
+      int n = 0;
+      for (int j = bc_ptr[k]; j < bc_ptr[k + 1]; j++) {
+        if (bc_vars[j] < vars_per_node) {
+          bvars[n] = bc_vars[j];
+          bvals[n] = bc_vals[j];
+          n++;
+        }
+      }
+      if (n > 0) {
+        tacs->addBCs(1, &bc_nodes[k], n, bvars, bvals);
+      }
+    }
+  }
+  delete[] bvars;
+  delete[] bvals;
+
+  // Use the reordering from the cache file, if one was read
+  if (node_reordering) {
+    tacs->setReordering(node_reordering);
+  } else {
+    tacs->computeReordering(order_type, mat_type);
+  }
+  tacs->initialize();
+
+  // Set the node locations
+  TACSBVec *X = tacs->createNodeVec();
+  X->incref();
+  TacsScalar *Xpt_vals;
+  X->getArray(&Xpt_vals);
+  memcpy(Xpt_vals, Xpts, 3 * num_nodes * sizeof(TacsScalar));
+  tacs->reorderVec(X);
+  tacs->setNodes(X);
+  X->decref();
+
+  // Free things that are no longer required. The element components
+  // are retained to find the elements within each component.
+  delete[] elem_node_ptr;
+  elem_node_ptr = NULL;
+  delete[] elem_node_conn;
+  elem_node_conn = NULL;
+  delete[] bc_nodes;
+  bc_nodes = NULL;
+  delete[] bc_ptr;
+  bc_ptr = NULL;
+  delete[] bc_vars;
+  bc_vars = NULL;
+  delete[] bc_vals;
+  bc_vals = NULL;
+
+  return tacs;
+}
+
+/*
+  Get the local element numbers with the given component numbers
+*/
+int TACSMeshLoader::getElementNums(int num_comps, int comp_nums[],
+                                   int **elem_nums) {
+  if (creator) {
+    return creator->getElementIdNums(num_comps, comp_nums, elem_nums);
+  }
+
+  *elem_nums = NULL;
+  if (!distributed || !elem_component) {
+    return 0;
+  }
+
+  int num_elems = 0;
+  int *elems = new int[num_elements];
+  for (int k = 0; k < num_elements; k++) {
+    for (int j = 0; j < num_comps; j++) {
+      if (elem_component[k] == comp_nums[j]) {
+        elems[num_elems] = k;
+        num_elems++;
+        break;
+      }
+    }
+  }
+
+  *elem_nums = elems;
+  return num_elems;
+}
+
+/*
+  Retrieve the number of elements in the model, or the number of
+  elements owned by this processor when the mesh is distributed
 */
 int TACSMeshLoader::getNumElements() { return num_elements; }
 
@@ -1160,11 +2661,13 @@ int TACSMeshLoader::getNumElements() { return num_elements; }
 */
 void TACSMeshLoader::addFunctionDomain(TACSFunction *function, int num_comps,
                                        int comp_nums[]) {
-  if (creator) {
+  if (creator || distributed) {
     int *elems;
-    int num_elems = creator->getElementIdNums(num_comps, comp_nums, &elems);
+    int num_elems = getElementNums(num_comps, comp_nums, &elems);
     function->addDomain(num_elems, elems);
-    delete[] elems;
+    if (elems) {
+      delete[] elems;
+    }
   }
 }
 
@@ -1174,19 +2677,22 @@ void TACSMeshLoader::addFunctionDomain(TACSFunction *function, int num_comps,
 */
 void TACSMeshLoader::addAuxElement(TACSAuxElements *aux, int component_num,
                                    TACSElement *element) {
-  if (creator) {
+  if (creator || distributed) {
     int *elems;
-    int num_elems = creator->getElementIdNums(1, &component_num, &elems);
+    int num_elems = getElementNums(1, &component_num, &elems);
     for (int i = 0; i < num_elems; i++) {
       aux->addElement(elems[i], element);
     }
-    delete[] elems;
+    if (elems) {
+      delete[] elems;
+    }
   }
 }
 
 /**
   Given node numbers from the original file on the root processor,
   find the corresponding global node numbers in the given assembler object.
+  When the mesh is distributed, every processor may pass in node numbers.
 
   Note that the node numbers are assumed to be 1-based as is the case in the
   original file format. In addition, the node array is over-written by a
@@ -1199,7 +2705,65 @@ void TACSMeshLoader::getAssemblerNodeNums(TACSAssembler *assembler,
   *num_new_nodes = 0;
   *new_nodes = NULL;
 
-  if (creator) {
+  if (distributed) {
+    int size, rank;
+    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm, &rank);
+
+    // Convert from the BDF order to the global node numbers
+    for (int k = 0; k < num_nodes; k++) {
+      node_nums[k] -= 1;
+    }
+    if (dir_file_nums) {
+      convert_bdf_node_nums(comm, node_num_bound, num_dir_nodes,
+                            dir_file_nums, dir_node_nums, 0, num_nodes,
+                            node_nums);
+    } else {
+      convert_bdf_node_nums(comm, node_num_bound, this->num_nodes,
+                            file_node_nums, NULL, node_range[rank], num_nodes,
+                            node_nums);
+    }
+
+    int index = 0;
+    for (int k = 0; k < num_nodes; k++) {
+      if (node_nums[k] >= 0) {
+        node_nums[index] = node_nums[k];
+        index++;
+      }
+    }
+
+    // Find the nodes after the mesh was partitioned by the creator
+    if (creator) {
+      creator->getAssemblerNodeNums(assembler, index, node_nums, num_new_nodes,
+                                    new_nodes);
+      return;
+    }
+
+    // Send the nodes to the processors that own them
+    index = TacsUniqueSort(index, node_nums);
+    int *ext_ptr = new int[size + 1];
+    TacsMatchIntervals(size, node_range, index, node_nums, ext_ptr);
+
+    int *send_count = new int[size];
+    int *recv_count = new int[size];
+    for (int i = 0; i < size; i++) {
+      send_count[i] = ext_ptr[i + 1] - ext_ptr[i];
+    }
+
+    int *nodes;
+    int count = exchange_bdf_data(comm, MPI_INT, 1, send_count, node_nums,
+                                  recv_count, &nodes);
+    count = TacsUniqueSort(count, nodes);
+    delete[] ext_ptr;
+    delete[] send_count;
+    delete[] recv_count;
+
+    // Apply the reordering in TACS
+    assembler->reorderNodes(count, nodes);
+
+    *num_new_nodes = count;
+    *new_nodes = nodes;
+  } else if (creator) {
     int rank;
     MPI_Comm_rank(comm, &rank);
 
@@ -1208,8 +2772,8 @@ void TACSMeshLoader::getAssemblerNodeNums(TACSAssembler *assembler,
       // Convert from the BDF order, to the local TACSMeshLoader order
       for (int k = 0; k < num_nodes; k++) {
         int node_num = node_nums[k] - 1;
-        int node = find_index_arg_sorted(node_num, num_nodes, file_node_nums,
-                                         node_arg_sort_list);
+        int node = find_index_arg_sorted(node_num, this->num_nodes,
+                                         file_node_nums, node_arg_sort_list);
         if (node >= 0) {
           node_nums[index] = node;
           index++;
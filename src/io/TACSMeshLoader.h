@@ -53,6 +53,19 @@ const int TacsMeshLoaderElementLimits[][2] = {{2, 2},    // CBAR
   The loader does not understand the different load-case capabilities
   that can be placed within a Nastran file. The elements must be passed
   in to the object based on the component number.
+
+  INCLUDE statements are expanded in place by scanBDFFile(), with the
+  file names taken relative to the including file. scanBDFFileParallel()
+  reads byte ranges of a single file and does not expand them.
+
+  The file is either scanned on the root processor with scanBDFFile(),
+  and later partitioned with TACSCreator, or read by all processors
+  with scanBDFFileParallel(), in which case the mesh is never stored
+  on a single processor and TACSCreator partitions it in parallel.
+  Once TACSAssembler has been created, the partitioned mesh and the
+  node reordering can be saved with writeMeshCache(). Later runs on
+  the same number of processors can then call readMeshCache() in place
+  of scanning the file, which skips the partitioning and reordering.
 */
 
 #include "TACSAuxElements.h"
@@ -67,6 +80,12 @@ class TACSMeshLoader : public TACSObject {
   // Read a BDF file for input
   // -------------------------
   int scanBDFFile(const char *file_name);
+  int scanBDFFileParallel(const char *file_name);
+
+  // Write/read a binary snapshot of the partitioned mesh
+  // ----------------------------------------------------
+  int writeMeshCache(TACSAssembler *assembler, const char *file_name);
+  int readMeshCache(const char *file_name);
 
   // Get information about the mesh after scanning
   // ---------------------------------------------
@@ -121,6 +140,14 @@ class TACSMeshLoader : public TACSObject {
               const int **_bc_ptr, const TacsScalar **_bc_vals);
 
  private:
+  // Create TACS from the distributed mesh
+  TACSAssembler *createDistributedTACS(
+      int vars_per_node, TACSAssembler::OrderingType order_type,
+      TACSAssembler::MatrixOrderingType mat_type);
+
+  // Get the local elements with the given component numbers
+  int getElementNums(int num_comps, int comp_nums[], int **elem_nums);
+
   // Communicator for all processors
   MPI_Comm comm;
 
@@ -157,6 +184,20 @@ class TACSMeshLoader : public TACSObject {
   int num_bcs;
   int *bc_nodes, *bc_vars, *bc_ptr;
   TacsScalar *bc_vals;
+
+  // Data for the distributed mesh from scanBDFFileParallel(). Each
+  // processor owns a contiguous range of the sorted file node numbers
+  // and the node_range array stores the global node ranges.
+  int distributed;
+  int node_num_bound;
+  int *node_range;
+
+  // Data for a mesh read from a cache file. The directory stores the
+  // sorted file node numbers and their global node numbers, and the
+  // node reordering is applied in place of computeReordering().
+  int num_dir_nodes;
+  int *dir_file_nums, *dir_node_nums;
+  int *node_reordering;
 };
 
 #endif  // TACS_MESH_LOADER_H
@@ -0,0 +1,291 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSTimeHistory.h"
+
+/**
+  Create the time history output for the given probe nodes
+
+  @param assembler The TACSAssembler object
+  @param num_probes The number of probe nodes
+  @param probe_nodes The global node numbers of the probes
+  @param write_flag OR flag indicating the data recorded at each probe
+  @param buffer_size The number of records buffered before writing
+*/
+TACSTimeHistory::TACSTimeHistory(TACSAssembler *_assembler, int _num_probes,
+                                 const int *_probe_nodes, int _write_flag,
+                                 int _buffer_size) {
+  assembler = _assembler;
+  assembler->incref();
+
+  write_flag = _write_flag;
+  num_data = 0;
+  for (int k = 0; k < 3; k++) {
+    if (write_flag & (1 << k)) {
+      num_data++;
+    }
+  }
+  vars_per_node = assembler->getVarsPerNode();
+
+  // Find the probes that are owned by this processor
+  int rank;
+  MPI_Comm_rank(assembler->getMPIComm(), &rank);
+  const int *owner_range;
+  assembler->getNodeMap()->getOwnerRange(&owner_range);
+
+  num_probes = _num_probes;
+  probe_nodes = new int[num_probes];
+  owned_probes = new int[num_probes];
+  owned_index = new int[num_probes];
+  num_owned = 0;
+  for (int i = 0; i < num_probes; i++) {
+    probe_nodes[i] = _probe_nodes[i];
+    if (probe_nodes[i] < 0) {
+      if (rank == 0) {
+        fprintf(stderr, "TACSTimeHistory: Probe node %d is not valid\n",
+                probe_nodes[i]);
+      }
+    } else if (probe_nodes[i] >= owner_range[rank] &&
+               probe_nodes[i] < owner_range[rank + 1]) {
+      owned_probes[num_owned] = i;
+      owned_index[num_owned] = probe_nodes[i] - owner_range[rank];
+      num_owned++;
+    }
+  }
+
+  num_funcs = 0;
+  funcs = NULL;
+  fvals = NULL;
+
+  record_len = 1 + num_funcs + num_probes * num_data * vars_per_node;
+  buffer_size = (_buffer_size < 1 ? 1 : _buffer_size);
+  num_buffered = 0;
+  buffer = new double[buffer_size * record_len];
+  root_buffer = NULL;
+  if (rank == 0) {
+    root_buffer = new double[buffer_size * record_len];
+  }
+  num_records = 0;
+
+  fp = NULL;
+  file_open = 0;
+}
+
+TACSTimeHistory::~TACSTimeHistory() {
+  close();
+  assembler->decref();
+  for (int i = 0; i < num_funcs; i++) {
+    if (funcs[i]) {
+      funcs[i]->decref();
+    }
+  }
+  delete[] funcs;
+  delete[] fvals;
+  delete[] probe_nodes;
+  delete[] owned_probes;
+  delete[] owned_index;
+  delete[] buffer;
+  delete[] root_buffer;
+}
+
+/**
+  Set the functions that are evaluated at each record. This must be
+  called before the file is opened.
+
+  @param num_funcs The number of functions
+  @param funcs The functions evaluated at each record
+*/
+void TACSTimeHistory::setFunctions(int _num_funcs, TACSFunction **_funcs) {
+  if (file_open) {
+    fprintf(stderr,
+            "TACSTimeHistory: Cannot set the functions while the file is "
+            "open\n");
+    return;
+  }
+
+  for (int i = 0; i < _num_funcs; i++) {
+    if (_funcs[i]) {
+      _funcs[i]->incref();
+    }
+  }
+  for (int i = 0; i < num_funcs; i++) {
+    if (funcs[i]) {
+      funcs[i]->decref();
+    }
+  }
+  delete[] funcs;
+  delete[] fvals;
+
+  num_funcs = _num_funcs;
+  funcs = new TACSFunction *[num_funcs];
+  fvals = new TacsScalar[num_funcs];
+  for (int i = 0; i < num_funcs; i++) {
+    funcs[i] = _funcs[i];
+  }
+
+  // Re-size the buffers for the new record length
+  record_len = 1 + num_funcs + num_probes * num_data * vars_per_node;
+  delete[] buffer;
+  buffer = new double[buffer_size * record_len];
+  if (root_buffer) {
+    delete[] root_buffer;
+    root_buffer = new double[buffer_size * record_len];
+  }
+  num_buffered = 0;
+}
+
+/**
+  Open the output file and write the header. Any previously opened
+  file is closed first.
+
+  @param filename The name of the output file
+  @return Non-zero if the file could not be opened
+*/
+int TACSTimeHistory::open(const char *filename) {
+  close();
+
+  int rank;
+  MPI_Comm_rank(assembler->getMPIComm(), &rank);
+
+  int fail = 0;
+  if (rank == 0) {
+    fp = fopen(filename, "wb");
+    if (fp) {
+      int header[5];
+      header[0] = num_probes;
+      header[1] = vars_per_node;
+      header[2] = write_flag;
+      header[3] = num_funcs;
+      header[4] = record_len;
+      fwrite(header, sizeof(int), 5, fp);
+      fwrite(probe_nodes, sizeof(int), num_probes, fp);
+    } else {
+      fprintf(stderr, "TACSTimeHistory: Could not open file %s\n", filename);
+      fail = 1;
+    }
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, 0, assembler->getMPIComm());
+
+  file_open = !fail;
+  num_buffered = 0;
+  num_records = 0;
+
+  return fail;
+}
+
+/**
+  Write out any buffered records and close the file
+*/
+void TACSTimeHistory::close() {
+  if (file_open) {
+    flush();
+    if (fp) {
+      fclose(fp);
+      fp = NULL;
+    }
+    file_open = 0;
+  }
+}
+
+/*
+  Copy the values at the owned probe nodes into the record
+*/
+void TACSTimeHistory::addProbeValues(TACSBVec *vec, int offset, double *rec) {
+  TacsScalar *x;
+  vec->getArray(&x);
+  for (int j = 0; j < num_owned; j++) {
+    double *r = &rec[(owned_probes[j] * num_data + offset) * vars_per_node];
+    const TacsScalar *v = &x[owned_index[j] * vars_per_node];
+    for (int k = 0; k < vars_per_node; k++) {
+      r[k] = TacsRealPart(v[k]);
+    }
+  }
+}
+
+/**
+  Record the states at the probe nodes and the function values
+
+  This must be called on all processors. The function values are
+  evaluated at the variables currently set in TACSAssembler.
+
+  @param time The simulation time
+  @param q The state variables
+  @param qdot The first time derivatives of the states
+  @param qddot The second time derivatives of the states
+*/
+void TACSTimeHistory::record(double time, TACSBVec *q, TACSBVec *qdot,
+                             TACSBVec *qddot) {
+  if (!file_open) {
+    return;
+  }
+
+  int rank;
+  MPI_Comm_rank(assembler->getMPIComm(), &rank);
+
+  // Evaluate the functions at the current state
+  if (num_funcs > 0) {
+    assembler->evalFunctions(num_funcs, funcs, fvals);
+  }
+
+  // Only the root stores the values that are common to all processors,
+  // since the records are summed across the processors
+  double *rec = &buffer[num_buffered * record_len];
+  memset(rec, 0, record_len * sizeof(double));
+  if (rank == 0) {
+    rec[0] = time;
+    for (int i = 0; i < num_funcs; i++) {
+      rec[1 + i] = TacsRealPart(fvals[i]);
+    }
+  }
+
+  double *probe_rec = &rec[1 + num_funcs];
+  TACSBVec *vecs[3] = {q, qdot, qddot};
+  for (int k = 0, offset = 0; k < 3; k++) {
+    if (write_flag & (1 << k)) {
+      if (vecs[k]) {
+        addProbeValues(vecs[k], offset, probe_rec);
+      }
+      offset++;
+    }
+  }
+
+  num_buffered++;
+  if (num_buffered == buffer_size) {
+    flush();
+  }
+}
+
+/**
+  Reduce the buffered records to the root processor and append them
+  to the file. This must be called on all processors.
+*/
+void TACSTimeHistory::flush() {
+  if (!file_open || num_buffered == 0) {
+    return;
+  }
+
+  int rank;
+  MPI_Comm_rank(assembler->getMPIComm(), &rank);
+
+  int size = num_buffered * record_len;
+  MPI_Reduce(buffer, root_buffer, size, MPI_DOUBLE, MPI_SUM, 0,
+             assembler->getMPIComm());
+  if (rank == 0) {
+    fwrite(root_buffer, sizeof(double), size, fp);
+    fflush(fp);
+  }
+
+  num_records += num_buffered;
+  num_buffered = 0;
+}
@@ -0,0 +1,111 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_TIME_HISTORY_H
+#define TACS_TIME_HISTORY_H
+
+#include "TACSAssembler.h"
+
+/**
+  Stream the time history of probe quantities to a binary file
+
+  The states at a set of probe nodes and the values of a set of
+  functions are recorded at each time step into a buffer. When the
+  buffer is full, the records are reduced to the root processor in one
+  operation and appended to the file in one chunk. This avoids writing
+  the full field when only a few points are of interest.
+
+  The probe nodes are global node numbers in the TACSAssembler
+  ordering and must not be dependent nodes. The file contains a header
+  of 32-bit integers
+
+  num_probes, vars_per_node, write_flag, num_funcs, record_len,
+  probe_nodes[num_probes]
+
+  followed by the records as doubles. Each record has the layout
+
+  time, fvals[num_funcs], probe values
+
+  where the probe values are ordered by probe node, then by the states,
+  rates and accelerations selected by the write flag, then by the
+  variables at the node.
+*/
+class TACSTimeHistory : public TACSObject {
+ public:
+  // The data that is recorded at the probe nodes
+  enum HistoryData {
+    TACS_HISTORY_STATES = 1,
+    TACS_HISTORY_RATES = 2,
+    TACS_HISTORY_ACCELERATIONS = 4
+  };
+
+  TACSTimeHistory(TACSAssembler *_assembler, int _num_probes,
+                  const int *_probe_nodes,
+                  int _write_flag = TACS_HISTORY_STATES,
+                  int _buffer_size = 1024);
+  ~TACSTimeHistory();
+
+  // Set the functions that are evaluated at each record
+  // ---------------------------------------------------
+  void setFunctions(int _num_funcs, TACSFunction **_funcs);
+
+  // Open and close the output file
+  // ------------------------------
+  int open(const char *filename);
+  void close();
+
+  // Record the states and write out the buffered records
+  // ----------------------------------------------------
+  void record(double time, TACSBVec *q, TACSBVec *qdot = NULL,
+              TACSBVec *qddot = NULL);
+  void flush();
+
+  // Get information about the records
+  // ---------------------------------
+  int getRecordLength() { return record_len; }
+  int getNumRecords() { return num_records; }
+
+ private:
+  // Copy the values at the owned probe nodes into the record
+  void addProbeValues(TACSBVec *vec, int offset, double *rec);
+
+  // The finite-element model
+  TACSAssembler *assembler;
+
+  // The probe nodes and the local indices of the owned probes
+  int num_probes;
+  int *probe_nodes;
+  int num_owned;
+  int *owned_probes, *owned_index;
+
+  // The data recorded at each probe
+  int write_flag, num_data, vars_per_node;
+
+  // The functions evaluated at each record
+  int num_funcs;
+  TACSFunction **funcs;
+  TacsScalar *fvals;
+
+  // The buffered records
+  int record_len;
+  int buffer_size, num_buffered;
+  double *buffer, *root_buffer;
+  int num_records;
+
+  // The output file on the root processor
+  FILE *fp;
+  int file_open;
+};
+
+#endif  // TACS_TIME_HISTORY_H
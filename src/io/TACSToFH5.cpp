@@ -18,6 +18,8 @@
 
 #include "TACSToFH5.h"
 
+#include "TACSProfiler.h"
+
 /**
    Create the TACSToFH5 object.
 
@@ -69,12 +71,23 @@ TACSToFH5::TACSToFH5(TACSAssembler *_assembler, ElementType _elem_type,
     sprintf(comp_name, "Component %d", k);
     setComponentName(k, comp_name);
   }
+
+  // By default, files are completed before writeToFile() returns
+  pending_root = pending_tip = NULL;
+  async_output = 0;
+  max_pending_bytes = 0;
+
+  // By default, the data is written without compression
+  compression = TACSFH5File::FH5_NO_COMPRESSION;
+  compression_tol = 0.0;
+  float_storage = TACSFH5File::FH5_FLOAT;
 }
 
 /**
    Free the FH5 object
 */
 TACSToFH5::~TACSToFH5() {
+  flush();
   assembler->decref();
 
   // Deallocate the comma separated list of variable names
@@ -111,6 +124,127 @@ void TACSToFH5::setComponentName(int comp_num, const char *comp_name) {
   }
 }
 
+/**
+   Set whether to use asynchronous output
+
+   When asynchronous output is used, writeToFile() returns once the
+   writes have been started. The output data for the pending files is
+   retained until the writes complete. When this data exceeds
+   max_pending_bytes on any processor, the oldest files are completed
+   before writeToFile() returns, so the limit may be exceeded by at
+   most the data for a single file. A limit of zero leaves only the
+   last file pending.
+
+   @param flag Flag indicating whether to use asynchronous output
+   @param max_pending_bytes The limit on the retained data in bytes
+*/
+void TACSToFH5::setAsyncOutput(int flag, size_t _max_pending_bytes) {
+  if (!flag) {
+    flush();
+  }
+  async_output = flag;
+  max_pending_bytes = _max_pending_bytes;
+}
+
+/**
+   Set the compression and the storage type for the output data.
+
+   The connectivity is always compressed without loss when compression
+   is used. The nodal and element data is quantized with an absolute
+   error of at most tol when codec is FH5_QUANTIZE, and is otherwise
+   stored with float_type, which may be FH5_FLOAT, FH5_HALF or
+   FH5_BFLOAT16.
+
+   @param codec The type of compression
+   @param tol The absolute error tolerance for quantization
+   @param float_type The type used to store the output data
+*/
+void TACSToFH5::setCompression(TACSFH5File::FH5Compression codec, double tol,
+                               TACSFH5File::FH5DataType float_type) {
+  compression = codec;
+  compression_tol = tol;
+  float_storage = float_type;
+}
+
+/**
+   Complete the writes for all pending files and close them.
+
+   This must be called on all processors.
+*/
+void TACSToFH5::flush() {
+  while (pending_root) {
+    FH5PendingFile *pending = pending_root;
+    pending_root = pending->next;
+
+    pending->file->close();
+    pending->file->decref();
+    delete[] pending->file_name;
+    delete pending;
+  }
+  pending_tip = NULL;
+}
+
+/*
+  Complete the oldest pending files until the data retained by the
+  pending files is below the limit on all processors
+*/
+void TACSToFH5::limitPendingFiles() {
+  MPI_Comm comm = assembler->getMPIComm();
+
+  while (pending_root && pending_root != pending_tip) {
+    // Free the data from any writes that have completed
+    size_t bytes = 0;
+    for (FH5PendingFile *p = pending_root; p; p = p->next) {
+      p->file->testWrites();
+      bytes += p->file->getPendingBytes();
+    }
+
+    unsigned long long max_bytes = bytes;
+    MPI_Allreduce(MPI_IN_PLACE, &max_bytes, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX,
+                  comm);
+    if (max_bytes <= max_pending_bytes) {
+      break;
+    }
+
+    FH5PendingFile *pending = pending_root;
+    pending_root = pending->next;
+    pending->file->close();
+    pending->file->decref();
+    delete[] pending->file_name;
+    delete pending;
+  }
+}
+
+/*
+  Write the zone data to the file. The data is either freed or, with
+  asynchronous output, owned by the file until the write completes.
+*/
+void TACSToFH5::writeZone(TACSFH5File *file, char *zone_name,
+                          char *var_names, int dim1, int dim2, float *data,
+                          int *dim1_range) {
+  if (async_output) {
+    file->iwriteZoneData(zone_name, var_names, TACSFH5File::FH5_FLOAT, dim1,
+                         dim2, data, dim1_range);
+  } else {
+    file->writeZoneData(zone_name, var_names, TACSFH5File::FH5_FLOAT, dim1,
+                        dim2, data, dim1_range);
+    delete[] data;
+  }
+}
+
+void TACSToFH5::writeZone(TACSFH5File *file, char *zone_name,
+                          char *var_names, int dim1, int dim2, int *data,
+                          int *dim1_range) {
+  if (async_output) {
+    file->iwriteZoneData(zone_name, var_names, TACSFH5File::FH5_INT, dim1,
+                         dim2, data, dim1_range);
+  } else {
+    file->writeZoneData(zone_name, var_names, TACSFH5File::FH5_INT, dim1,
+                        dim2, data, dim1_range);
+    delete[] data;
+  }
+}
+
 /**
    Write the data stored in the TACSAssembler object to a file
 
@@ -124,10 +258,20 @@ void TACSToFH5::setComponentName(int comp_num, const char *comp_name) {
    @param filename The name of the file to write
 */
 int TACSToFH5::writeToFile(const char *filename) {
+  TACSProfileScope scope("TACSToFH5::writeToFile");
   int rank, size;
   MPI_Comm_rank(assembler->getMPIComm(), &rank);
   MPI_Comm_size(assembler->getMPIComm(), &size);
 
+  // Complete any pending file with the same name before it is
+  // re-created
+  for (FH5PendingFile *p = pending_root; p; p = p->next) {
+    if (strcmp(p->file_name, filename) == 0) {
+      flush();
+      break;
+    }
+  }
+
   // Create the FH5 file object for writting
   TACSFH5File *file = new TACSFH5File(assembler->getMPIComm());
   file->incref();
@@ -143,6 +287,8 @@ int TACSToFH5::writeToFile(const char *filename) {
     return 1;
   }
 
+  file->setCompression(compression, compression_tol, float_storage);
+
   if (write_flag & TACS_OUTPUT_CONNECTIVITY) {
     writeConnectivity(file);
   }
@@ -325,9 +471,7 @@ int TACSToFH5::writeToFile(const char *filename) {
     char data_name[128];
     double t = assembler->getSimulationTime();
     sprintf(data_name, "continuous data t=%.10e", t);
-    file->writeZoneData(data_name, var_names, TACSFH5File::FH5_FLOAT, dim1,
-                        dim2, float_data);
-    delete[] float_data;
+    writeZone(file, data_name, var_names, dim1, dim2, float_data);
     delete[] var_names;
     if (F) {
       F->decref();
@@ -335,30 +479,39 @@ int TACSToFH5::writeToFile(const char *filename) {
   }
 
   if (nvals > 0) {
-    // Write out the data to a file
-    TacsScalar *data;
+    // Write out the data to a file. The data is converted to single
+    // precision element-by-element by the assembler.
+    float *float_data;
     int dim1, dim2;
     assembler->getElementOutputData(elem_type, element_write_flag, &dim1, &dim2,
-                                    &data);
-
-    // Convert the data to float
-    float *float_data = new float[dim1 * dim2];
-    for (int i = 0; i < dim1 * dim2; i++) {
-      float_data[i] = TacsRealPart(data[i]);
-    }
-    delete[] data;
+                                    &float_data);
 
     // Write the data with a time stamp from the simulation in TACS
     char data_name[128];
     double t = assembler->getSimulationTime();
     sprintf(data_name, "element data t=%.10e", t);
-    file->writeZoneData(data_name, variable_names, TACSFH5File::FH5_FLOAT, dim1,
-                        dim2, float_data);
-    delete[] float_data;
+    writeZone(file, data_name, variable_names, dim1, dim2, float_data);
   }
 
-  file->close();
-  file->decref();
+  if (async_output) {
+    // Add the file to the list of pending files
+    FH5PendingFile *pending = new FH5PendingFile();
+    pending->file = file;
+    pending->file_name = new char[strlen(filename) + 1];
+    strcpy(pending->file_name, filename);
+    pending->next = NULL;
+    if (pending_tip) {
+      pending_tip->next = pending;
+    } else {
+      pending_root = pending;
+    }
+    pending_tip = pending;
+
+    limitPendingFiles();
+  } else {
+    file->close();
+    file->decref();
+  }
 
   return 0;
 }
@@ -390,15 +543,11 @@ int TACSToFH5::writeConnectivity(TACSFH5File *file) {
   int dim1 = num_elements;
   int dim2 = 1;
   char comp_name[] = "components";
-  file->writeZoneData(comp_name, comp_name, TACSFH5File::FH5_INT, dim1, dim2,
-                      comp_nums);
-  delete[] comp_nums;
+  writeZone(file, comp_name, comp_name, dim1, dim2, comp_nums);
 
   // Write the layout types to a new zone
   char layout_name[] = "ltypes";
-  file->writeZoneData(layout_name, layout_name, TACSFH5File::FH5_INT, dim1,
-                      dim2, layout_types);
-  delete[] layout_types;
+  writeZone(file, layout_name, layout_name, dim1, dim2, layout_types);
 
   // Copy over the connectivity
   const int *ptr, *conn;
@@ -431,9 +580,7 @@ int TACSToFH5::writeConnectivity(TACSFH5File *file) {
   }
 
   char ptr_name[] = "ptr";
-  file->writeZoneData(ptr_name, ptr_name, TACSFH5File::FH5_INT, dim1, dim2,
-                      ptr_copy);
-  delete[] ptr_copy;
+  writeZone(file, ptr_name, ptr_name, dim1, dim2, ptr_copy);
 
   // Get the ownership range for each group of nodes
   const int *ownerRange;
@@ -483,9 +630,7 @@ int TACSToFH5::writeConnectivity(TACSFH5File *file) {
   dim1 = conn_size;
   dim2 = 1;
   char conn_name[] = "connectivity";
-  file->writeZoneData(conn_name, conn_name, TACSFH5File::FH5_INT, dim1, dim2,
-                      conn_copy);
-  delete[] conn_copy;
+  writeZone(file, conn_name, conn_name, dim1, dim2, conn_copy);
   delete[] new_owner_range;
 
   return 0;
@@ -33,6 +33,18 @@
   This .f5 file format is specific to TACS, but is written in
   parallel.  Data recorded in the file can later be accessed and
   converted to formats for visualization.
+
+  With asynchronous output, writeToFile() computes the output data
+  and starts non-blocking writes, but returns without waiting for the
+  writes to complete. The output data is retained until the writes
+  complete, and the older files are completed whenever the retained
+  data exceeds the specified limit. All remaining files are completed
+  by flush(), which must be called on all processors.
+
+  The zone data can also be compressed, either without loss or by
+  quantizing the values to a given absolute tolerance, and the float
+  data can be stored with 16-bit half or bfloat16 types. The readers
+  decompress the data automatically.
 */
 class TACSToFH5 : public TACSObject {
  public:
@@ -45,7 +57,25 @@ class TACSToFH5 : public TACSObject {
   // Write the data to a file
   int writeToFile(const char *filename);
 
+  // Set asynchronous output and complete all pending files
+  void setAsyncOutput(int flag, size_t max_pending_bytes = 0);
+  void flush();
+
+  // Set the compression and storage type for the output data
+  void setCompression(TACSFH5File::FH5Compression codec, double tol = 0.0,
+                      TACSFH5File::FH5DataType float_type =
+                          TACSFH5File::FH5_FLOAT);
+
  private:
+  // Write a zone and free the data, or pass it to the file
+  void writeZone(TACSFH5File *file, char *zone_name, char *var_names,
+                 int dim1, int dim2, float *data, int *dim1_range = NULL);
+  void writeZone(TACSFH5File *file, char *zone_name, char *var_names,
+                 int dim1, int dim2, int *data, int *dim1_range = NULL);
+
+  // Complete the oldest files until the pending data is below the limit
+  void limitPendingFiles();
+
   // Get a character string of the variable names
   char *getElementVarNames(int flag);
 
@@ -64,6 +94,21 @@ class TACSToFH5 : public TACSObject {
   int num_components;      // The number of components in the model
   char **component_names;  // The names of each of the components
   char *variable_names;    // The names of all the variables
+
+  // Files with pending writes, from the oldest to the newest
+  class FH5PendingFile {
+   public:
+    TACSFH5File *file;
+    char *file_name;
+    FH5PendingFile *next;
+  } * pending_root, *pending_tip;
+  int async_output;          // Use asynchronous output
+  size_t max_pending_bytes;  // Limit on the data held by pending files
+
+  // Compression settings passed to each file
+  TACSFH5File::FH5Compression compression;
+  double compression_tol;
+  TACSFH5File::FH5DataType float_storage;
 };
 
 #endif  // TACS_TO_FH5
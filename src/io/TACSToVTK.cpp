@@ -0,0 +1,569 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSToVTK.h"
+
+#include <stdint.h>
+
+#include "TACSProfiler.h"
+
+// The VTK cell types for the basic element types
+static const int VTK_VERTEX = 1;
+static const int VTK_LINE = 3;
+static const int VTK_TRIANGLE = 5;
+static const int VTK_QUAD = 9;
+static const int VTK_TETRA = 10;
+static const int VTK_HEXAHEDRON = 12;
+static const int VTK_QUADRATIC_TRIANGLE = 22;
+static const int VTK_QUADRATIC_TETRA = 24;
+
+// The classes of output data in the order they are written by the
+// elements
+static const int TACS_VTK_NUM_OUTPUT_TYPES = 5;
+static const int tacs_vtk_output_types[] = {
+    TACS_OUTPUT_NODES, TACS_OUTPUT_DISPLACEMENTS, TACS_OUTPUT_STRAINS,
+    TACS_OUTPUT_STRESSES, TACS_OUTPUT_EXTRAS};
+
+/*
+  Get the byte order of this machine for the VTK header
+*/
+static const char *TacsVTKByteOrder() {
+  int one = 1;
+  if (*((char *)&one) == 1) {
+    return "LittleEndian";
+  }
+  return "BigEndian";
+}
+
+/*
+  Write a block of appended raw data with its size
+*/
+static void TacsVTKWriteBlock(FILE *fp, const void *data, uint64_t nbytes) {
+  fwrite(&nbytes, sizeof(uint64_t), 1, fp);
+  if (nbytes > 0) {
+    fwrite(data, 1, nbytes, fp);
+  }
+}
+
+/**
+   Create the TACSToVTK object.
+
+   @param assembler The TACSAssembler object
+   @param elem_type The type of element output to generate
+   @param write_flag XOR flag indicating classes of output to write
+*/
+TACSToVTK::TACSToVTK(TACSAssembler *_assembler, ElementType _elem_type,
+                     int _write_flag) {
+  assembler = _assembler;
+  assembler->incref();
+
+  // The nodes are always needed for the points, while the
+  // connectivity is always written and the loads are not available
+  // element-wise
+  elem_type = _elem_type;
+  write_flag = (_write_flag | TACS_OUTPUT_NODES) &
+               (~(TACS_OUTPUT_CONNECTIVITY | TACS_OUTPUT_LOADS));
+
+  // Retrieve the number of components
+  num_components = assembler->getNumComponents();
+
+  // Allocate space for the component names
+  component_names = new char *[num_components];
+  memset(component_names, 0, num_components * sizeof(char *));
+
+  for (int k = 0; k < num_components; k++) {
+    char comp_name[128];
+    sprintf(comp_name, "Component %d", k);
+    setComponentName(k, comp_name);
+  }
+
+  // No time series by default
+  series_file = NULL;
+  num_series = max_series = 0;
+  series_names = NULL;
+  series_times = NULL;
+}
+
+/**
+   Free the TACSToVTK object
+*/
+TACSToVTK::~TACSToVTK() {
+  assembler->decref();
+
+  for (int k = 0; k < num_components; k++) {
+    if (component_names[k]) {
+      delete[] component_names[k];
+    }
+  }
+  delete[] component_names;
+
+  if (series_file) {
+    delete[] series_file;
+  }
+  for (int k = 0; k < num_series; k++) {
+    delete[] series_names[k];
+  }
+  if (series_names) {
+    delete[] series_names;
+    delete[] series_times;
+  }
+}
+
+/**
+   Set the specified component name for a group of elements
+
+   The names are written to each piece as field data.
+
+   @param comp_num The component number to set
+   @param comp_name The component name to apply
+*/
+void TACSToVTK::setComponentName(int comp_num, const char *comp_name) {
+  if (comp_num >= 0 && comp_num < num_components) {
+    if (component_names[comp_num]) {
+      delete[] component_names[comp_num];
+    }
+
+    size_t len = strlen(comp_name) + 1;
+    component_names[comp_num] = new char[len];
+    strcpy(component_names[comp_num], comp_name);
+  }
+}
+
+/**
+   Set the .pvd collection file for a time series
+
+   Each subsequent call to writeToFile() appends the file to the
+   collection at the current simulation time. The names of the files in
+   the collection are used as given, so they should be relative to the
+   directory containing the collection.
+
+   @param filename The name of the collection file (NULL to disable)
+*/
+void TACSToVTK::setSeriesFile(const char *filename) {
+  if (series_file) {
+    delete[] series_file;
+    series_file = NULL;
+  }
+  for (int k = 0; k < num_series; k++) {
+    delete[] series_names[k];
+  }
+  num_series = 0;
+
+  if (filename) {
+    series_file = new char[strlen(filename) + 1];
+    strcpy(series_file, filename);
+  }
+}
+
+/**
+   Write the data stored in the TACSAssembler object to a file
+
+   The filename is the name of the parallel .pvtu file. The extension
+   is added when it is not present. This call is collective on the
+   communicator of the assembler.
+
+   @param filename The name of the file to write
+   @return Zero on success, non-zero if any file could not be written
+*/
+int TACSToVTK::writeToFile(const char *filename) {
+  TACSProfileScope scope("TACSToVTK::writeToFile");
+  MPI_Comm comm = assembler->getMPIComm();
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Strip the extension from the file name
+  size_t len = strlen(filename);
+  const char *ext = ".pvtu";
+  size_t ext_len = strlen(ext);
+  if (len >= ext_len && strcmp(&filename[len - ext_len], ext) == 0) {
+    len -= ext_len;
+  }
+  char *prefix = new char[len + 1];
+  memcpy(prefix, filename, len);
+  prefix[len] = '\0';
+
+  // Compute the element-wise output data
+  float *data;
+  int num_points, nvals;
+  assembler->getElementOutputData(elem_type, write_flag, &num_points, &nvals,
+                                  &data);
+
+  // Write out the piece for this processor
+  char *piece = new char[len + 32];
+  sprintf(piece, "%s_%d.vtu", prefix, rank);
+  int fail = writePiece(piece, num_points, nvals, data);
+  delete[] piece;
+  delete[] data;
+
+  if (rank == 0) {
+    // The pieces are referenced relative to the parallel file
+    const char *base = strrchr(prefix, '/');
+    base = (base ? base + 1 : prefix);
+
+    char *pfile = new char[len + ext_len + 1];
+    sprintf(pfile, "%s%s", prefix, ext);
+    fail = fail || writeParallelFile(pfile, base);
+
+    // Add the file to the time series
+    if (series_file) {
+      if (num_series >= max_series) {
+        max_series = 2 * max_series + 16;
+        char **names = new char *[max_series];
+        double *times = new double[max_series];
+        if (series_names) {
+          memcpy(names, series_names, num_series * sizeof(char *));
+          memcpy(times, series_times, num_series * sizeof(double));
+          delete[] series_names;
+          delete[] series_times;
+        }
+        series_names = names;
+        series_times = times;
+      }
+      series_names[num_series] = pfile;
+      series_times[num_series] = assembler->getSimulationTime();
+      num_series++;
+      fail = fail || writeSeriesFile();
+    } else {
+      delete[] pfile;
+    }
+  }
+  delete[] prefix;
+
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  return fail;
+}
+
+/*
+  Write the VTK XML unstructured grid for this processor
+*/
+int TACSToVTK::writePiece(const char *filename, int num_points, int nvals,
+                          const float *data) {
+  FILE *fp = fopen(filename, "wb");
+  if (!fp) {
+    int rank;
+    MPI_Comm_rank(assembler->getMPIComm(), &rank);
+    fprintf(stderr, "[%d] TACSToVTK error: Could not create file %s\n", rank,
+            filename);
+    return 1;
+  }
+
+  // Get the connectivity and the elements
+  int num_elements = assembler->getNumElements();
+  TACSElement **elements = assembler->getElements();
+  const int *ptr;
+  assembler->getElementConnectivity(&ptr, NULL);
+
+  // Each element has its own copy of its nodes, so the connectivity
+  // of element k is the range of points [ptr[k], ptr[k+1])
+  int *local_conn = new int[num_points];
+  for (int i = 0; i < num_points; i++) {
+    local_conn[i] = i;
+  }
+
+  // Count up the basic elements used for visualization
+  int num_cells = 0, cell_conn_size = 0;
+  for (int k = 0; k < num_elements; k++) {
+    int ntypes = 0, nconn = 0;
+    ElementLayout ltype = elements[k]->getLayoutType();
+    if (ltype == TACS_TRI_QUADRATIC_ELEMENT) {
+      ntypes = 1;
+      nconn = 6;
+    } else if (ltype == TACS_TETRA_QUADRATIC_ELEMENT) {
+      ntypes = 1;
+      nconn = 10;
+    } else {
+      TacsConvertVisLayoutToBasicCount(ltype, &ntypes, &nconn);
+    }
+    num_cells += ntypes;
+    cell_conn_size += nconn;
+  }
+
+  // Convert the elements to basic elements
+  int *basic_ltypes = new int[num_cells];
+  int *basic_conn = new int[cell_conn_size];
+  int *cell_comps = new int[num_cells];
+  int *btypes = basic_ltypes;
+  int *bconn = basic_conn;
+  int *bcomps = cell_comps;
+  for (int k = 0; k < num_elements; k++) {
+    int ntypes = 0, nconn = 0;
+    ElementLayout ltype = elements[k]->getLayoutType();
+    if (ltype == TACS_TRI_QUADRATIC_ELEMENT ||
+        ltype == TACS_TETRA_QUADRATIC_ELEMENT) {
+      btypes[0] = ltype;
+      ntypes = 1;
+      nconn = (ltype == TACS_TRI_QUADRATIC_ELEMENT ? 6 : 10);
+      memcpy(bconn, &local_conn[ptr[k]], nconn * sizeof(int));
+    } else {
+      TacsConvertVisLayoutToBasicCount(ltype, &ntypes, &nconn);
+      TacsConvertVisLayoutToBasic(ltype, &local_conn[ptr[k]], btypes, bconn);
+    }
+    for (int j = 0; j < ntypes; j++) {
+      bcomps[j] = elements[k]->getComponentNum();
+    }
+    btypes += ntypes;
+    bconn += nconn;
+    bcomps += ntypes;
+  }
+  delete[] local_conn;
+
+  // Convert to the VTK connectivity, offsets and cell types. The quad
+  // and hexahedral elements use a tensor-product ordering in TACS.
+  int32_t *cell_conn = new int32_t[cell_conn_size];
+  int32_t *cell_offsets = new int32_t[num_cells];
+  uint8_t *cell_types = new uint8_t[num_cells];
+  const int quad_convert[] = {0, 1, 3, 2};
+  const int hexa_convert[] = {0, 1, 3, 2, 4, 5, 7, 6};
+  int offset = 0;
+  for (int k = 0; k < num_cells; k++) {
+    ElementLayout ltype = (ElementLayout)basic_ltypes[k];
+    int nconn = TacsGetNumVisNodes(ltype);
+    if (ltype == TACS_TRI_QUADRATIC_ELEMENT) {
+      nconn = 6;
+    } else if (ltype == TACS_TETRA_QUADRATIC_ELEMENT) {
+      nconn = 10;
+    }
+    for (int j = 0; j < nconn; j++) {
+      if (ltype == TACS_QUAD_ELEMENT) {
+        cell_conn[offset + j] = basic_conn[offset + quad_convert[j]];
+      } else if (ltype == TACS_HEXA_ELEMENT) {
+        cell_conn[offset + j] = basic_conn[offset + hexa_convert[j]];
+      } else {
+        cell_conn[offset + j] = basic_conn[offset + j];
+      }
+    }
+    offset += nconn;
+    cell_offsets[k] = offset;
+
+    if (ltype == TACS_POINT_ELEMENT) {
+      cell_types[k] = VTK_VERTEX;
+    } else if (ltype == TACS_LINE_ELEMENT) {
+      cell_types[k] = VTK_LINE;
+    } else if (ltype == TACS_TRI_ELEMENT) {
+      cell_types[k] = VTK_TRIANGLE;
+    } else if (ltype == TACS_TRI_QUADRATIC_ELEMENT) {
+      cell_types[k] = VTK_QUADRATIC_TRIANGLE;
+    } else if (ltype == TACS_QUAD_ELEMENT) {
+      cell_types[k] = VTK_QUAD;
+    } else if (ltype == TACS_TETRA_ELEMENT) {
+      cell_types[k] = VTK_TETRA;
+    } else if (ltype == TACS_TETRA_QUADRATIC_ELEMENT) {
+      cell_types[k] = VTK_QUADRATIC_TETRA;
+    } else {
+      cell_types[k] = VTK_HEXAHEDRON;
+    }
+  }
+  delete[] basic_ltypes;
+  delete[] basic_conn;
+
+  // Write the header with the offsets into the appended data
+  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fprintf(fp,
+          "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+          "byte_order=\"%s\" header_type=\"UInt64\">\n",
+          TacsVTKByteOrder());
+  fprintf(fp, "  <UnstructuredGrid>\n");
+
+  // Write the component names as field data. The ASCII encoding of a
+  // string array is the character codes of each string followed by a
+  // zero.
+  fprintf(fp, "    <FieldData>\n");
+  fprintf(fp,
+          "      <Array type=\"String\" Name=\"ComponentNames\" "
+          "NumberOfTuples=\"%d\" format=\"ascii\">\n",
+          num_components);
+  for (int k = 0; k < num_components; k++) {
+    fprintf(fp, "       ");
+    for (const char *c = component_names[k]; *c; c++) {
+      fprintf(fp, " %d", (int)(*c));
+    }
+    fprintf(fp, " 0\n");
+  }
+  fprintf(fp, "      </Array>\n");
+  fprintf(fp, "    </FieldData>\n");
+
+  fprintf(fp, "    <Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n",
+          num_points, num_cells);
+
+  uint64_t appended_offset = 0;
+  uint64_t header_size = sizeof(uint64_t);
+
+  // The point data arrays after the node locations
+  fprintf(fp, "      <PointData>\n");
+  uint64_t point_data_offset = appended_offset;
+  appended_offset += 3 * num_points * sizeof(float) + header_size;
+  for (int t = 1; t < TACS_VTK_NUM_OUTPUT_TYPES; t++) {
+    int type = tacs_vtk_output_types[t];
+    if (write_flag & type) {
+      int nd = TacsGetOutputComponentCount(elem_type, type);
+      for (int i = 0; i < nd; i++) {
+        fprintf(fp,
+                "        <DataArray type=\"Float32\" Name=\"%s\" "
+                "format=\"appended\" offset=\"%llu\"/>\n",
+                TacsGetOutputComponentName(elem_type, type, i),
+                (unsigned long long)appended_offset);
+        appended_offset += num_points * sizeof(float) + header_size;
+      }
+    }
+  }
+  fprintf(fp, "      </PointData>\n");
+
+  fprintf(fp, "      <CellData>\n");
+  fprintf(fp,
+          "        <DataArray type=\"Int32\" Name=\"component\" "
+          "format=\"appended\" offset=\"%llu\"/>\n",
+          (unsigned long long)appended_offset);
+  appended_offset += num_cells * sizeof(int32_t) + header_size;
+  fprintf(fp, "      </CellData>\n");
+
+  fprintf(fp, "      <Points>\n");
+  fprintf(fp,
+          "        <DataArray type=\"Float32\" NumberOfComponents=\"3\" "
+          "format=\"appended\" offset=\"%llu\"/>\n",
+          (unsigned long long)point_data_offset);
+  fprintf(fp, "      </Points>\n");
+
+  fprintf(fp, "      <Cells>\n");
+  fprintf(fp,
+          "        <DataArray type=\"Int32\" Name=\"connectivity\" "
+          "format=\"appended\" offset=\"%llu\"/>\n",
+          (unsigned long long)appended_offset);
+  appended_offset += cell_conn_size * sizeof(int32_t) + header_size;
+  fprintf(fp,
+          "        <DataArray type=\"Int32\" Name=\"offsets\" "
+          "format=\"appended\" offset=\"%llu\"/>\n",
+          (unsigned long long)appended_offset);
+  appended_offset += num_cells * sizeof(int32_t) + header_size;
+  fprintf(fp,
+          "        <DataArray type=\"UInt8\" Name=\"types\" "
+          "format=\"appended\" offset=\"%llu\"/>\n",
+          (unsigned long long)appended_offset);
+  fprintf(fp, "      </Cells>\n");
+  fprintf(fp, "    </Piece>\n");
+  fprintf(fp, "  </UnstructuredGrid>\n");
+  fprintf(fp, "  <AppendedData encoding=\"raw\">\n   _");
+
+  // Write the node locations. The nodes are the first three values.
+  float *values = new float[3 * num_points];
+  for (int i = 0; i < num_points; i++) {
+    for (int j = 0; j < 3; j++) {
+      values[3 * i + j] = data[nvals * i + j];
+    }
+  }
+  TacsVTKWriteBlock(fp, values, 3 * num_points * sizeof(float));
+
+  // Write the remaining values one array at a time
+  for (int j = 3; j < nvals; j++) {
+    for (int i = 0; i < num_points; i++) {
+      values[i] = data[nvals * i + j];
+    }
+    TacsVTKWriteBlock(fp, values, num_points * sizeof(float));
+  }
+  delete[] values;
+
+  TacsVTKWriteBlock(fp, cell_comps, num_cells * sizeof(int32_t));
+  TacsVTKWriteBlock(fp, cell_conn, cell_conn_size * sizeof(int32_t));
+  TacsVTKWriteBlock(fp, cell_offsets, num_cells * sizeof(int32_t));
+  TacsVTKWriteBlock(fp, cell_types, num_cells * sizeof(uint8_t));
+
+  fprintf(fp, "\n  </AppendedData>\n");
+  fprintf(fp, "</VTKFile>\n");
+  int fail = ferror(fp);
+  fclose(fp);
+
+  delete[] cell_comps;
+  delete[] cell_conn;
+  delete[] cell_offsets;
+  delete[] cell_types;
+
+  return fail;
+}
+
+/*
+  Write the parallel unstructured grid file that points to the pieces
+*/
+int TACSToVTK::writeParallelFile(const char *filename,
+                                 const char *piece_prefix) {
+  FILE *fp = fopen(filename, "w");
+  if (!fp) {
+    fprintf(stderr, "[0] TACSToVTK error: Could not create file %s\n",
+            filename);
+    return 1;
+  }
+
+  int size;
+  MPI_Comm_size(assembler->getMPIComm(), &size);
+
+  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fprintf(fp,
+          "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" "
+          "byte_order=\"%s\" header_type=\"UInt64\">\n",
+          TacsVTKByteOrder());
+  fprintf(fp, "  <PUnstructuredGrid GhostLevel=\"0\">\n");
+  fprintf(fp, "    <PPointData>\n");
+  for (int t = 1; t < TACS_VTK_NUM_OUTPUT_TYPES; t++) {
+    int type = tacs_vtk_output_types[t];
+    if (write_flag & type) {
+      int nd = TacsGetOutputComponentCount(elem_type, type);
+      for (int i = 0; i < nd; i++) {
+        fprintf(fp, "      <PDataArray type=\"Float32\" Name=\"%s\"/>\n",
+                TacsGetOutputComponentName(elem_type, type, i));
+      }
+    }
+  }
+  fprintf(fp, "    </PPointData>\n");
+  fprintf(fp, "    <PCellData>\n");
+  fprintf(fp, "      <PDataArray type=\"Int32\" Name=\"component\"/>\n");
+  fprintf(fp, "    </PCellData>\n");
+  fprintf(fp, "    <PPoints>\n");
+  fprintf(fp,
+          "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n");
+  fprintf(fp, "    </PPoints>\n");
+  for (int k = 0; k < size; k++) {
+    fprintf(fp, "    <Piece Source=\"%s_%d.vtu\"/>\n", piece_prefix, k);
+  }
+  fprintf(fp, "  </PUnstructuredGrid>\n");
+  fprintf(fp, "</VTKFile>\n");
+  int fail = ferror(fp);
+  fclose(fp);
+
+  return fail;
+}
+
+/*
+  Rewrite the .pvd collection with all the files in the series
+*/
+int TACSToVTK::writeSeriesFile() {
+  FILE *fp = fopen(series_file, "w");
+  if (!fp) {
+    fprintf(stderr, "[0] TACSToVTK error: Could not create file %s\n",
+            series_file);
+    return 1;
+  }
+
+  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fprintf(fp, "<VTKFile type=\"Collection\" version=\"0.1\">\n");
+  fprintf(fp, "  <Collection>\n");
+  for (int k = 0; k < num_series; k++) {
+    fprintf(fp,
+            "    <DataSet timestep=\"%.10e\" part=\"0\" file=\"%s\"/>\n",
+            series_times[k], series_names[k]);
+  }
+  fprintf(fp, "  </Collection>\n");
+  fprintf(fp, "</VTKFile>\n");
+  int fail = ferror(fp);
+  fclose(fp);
+
+  return fail;
+}
@@ -0,0 +1,82 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_TO_VTK_H
+#define TACS_TO_VTK_H
+
+#include "TACSAssembler.h"
+
+/**
+  Write out the solution data directly to a partitioned VTK file set
+  that can be opened in ParaView without a conversion step.
+
+  This class follows the TACSToFH5 interface. Each processor writes
+  its own piece as a VTK XML unstructured grid (.vtu) with the data
+  appended in raw binary form, and the root processor writes the
+  parallel .pvtu file that points to the pieces. The piece for a
+  processor named name.pvtu is name_<rank>.vtu in the same directory.
+
+  The output is element-wise: each element has its own copy of its
+  nodes, so the strains and stresses are not averaged across the
+  elements. The nodes, displacements, strains, stresses and extras
+  selected by the write flag are written as point data and the
+  component number is written as cell data. Loads are not available
+  element-wise and are ignored.
+
+  When a series file is set, the root processor also rewrites a .pvd
+  collection after each call to writeToFile(). The collection lists
+  every file written so far with its simulation time, so that a
+  transient can be opened as a single time series.
+*/
+class TACSToVTK : public TACSObject {
+ public:
+  TACSToVTK(TACSAssembler *assembler, ElementType elem_type, int write_flag);
+  ~TACSToVTK();
+
+  // Set the group name for each zone
+  void setComponentName(int comp_num, const char *group_name);
+
+  // Set the time series collection that each file is appended to
+  void setSeriesFile(const char *filename);
+
+  // Write the data to a file
+  int writeToFile(const char *filename);
+
+ private:
+  // Write the piece for this processor
+  int writePiece(const char *filename, int num_points, int nvals,
+                 const float *data);
+
+  // Write the parallel file and the series collection
+  int writeParallelFile(const char *filename, const char *piece_prefix);
+  int writeSeriesFile();
+
+  // The Assembler object
+  TACSAssembler *assembler;
+
+  // Parameters to control how data is written to the file
+  ElementType elem_type;  // Write flag type
+  int write_flag;         // Keep track of which data to write
+
+  int num_components;      // The number of components in the model
+  char **component_names;  // The names of each of the components
+
+  // The time series collection
+  char *series_file;
+  int num_series, max_series;
+  char **series_names;
+  double *series_times;
+};
+
+#endif  // TACS_TO_VTK_H
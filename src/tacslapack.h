@@ -82,6 +82,12 @@
 #define LAPACKgetri dgetri_
 #endif
 
+// The single-precision routines are available in both builds
+#define BLASsgemv sgemv_
+#define BLASsgemm sgemm_
+#define BLASstrsm strsm_
+#define BLASstrsv strsv_
+
 extern "C" {
 // Level 1 BLAS routines
 extern TacsScalar BLASdot(int *n, TacsScalar *x, int *incx, TacsScalar *y,
@@ -261,6 +267,20 @@ extern void LAPACKzggev(const char *JOBVL, const char *JOBVR, int *N,
                         int *LDVL, LAPACK_cplx_double *VR, int *LDVR,
                         LAPACK_cplx_double *WORK, int *LWORK, double *RWORK,
                         int *INFO);
+
+// Single-precision level 2 and level 3 BLAS routines used by the
+// single-precision factorizations
+extern void BLASsgemv(const char *c, int *m, int *n, float *alpha, float *a,
+                      int *lda, float *x, int *incx, float *beta, float *y,
+                      int *incy);
+extern void BLASstrsv(const char *uplo, const char *trans, const char *diag,
+                      int *n, float *a, int *lda, float *x, int *incx);
+extern void BLASsgemm(const char *ta, const char *tb, int *m, int *n, int *k,
+                      float *alpha, float *a, int *lda, float *b, int *ldb,
+                      float *beta, float *c, int *ldc);
+extern void BLASstrsm(const char *side, const char *uplo, const char *transa,
+                      const char *diag, int *m, int *n, float *alpha,
+                      float *a, int *lda, float *b, int *ldb);
 }
 
 #endif
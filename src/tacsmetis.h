@@ -22,10 +22,16 @@
 #ifdef TACS_CPLUSPLUS_METIS
 // Use this if METIS is compiled with C++
 #include "metis.h"
+#ifdef TACS_HAS_PARMETIS
+#include "parmetis.h"
+#endif  // TACS_HAS_PARMETIS
 #else
 // Otherwise, assume metis is compiled with C
 extern "C" {
 #include "metis.h"
+#ifdef TACS_HAS_PARMETIS
+#include "parmetis.h"
+#endif  // TACS_HAS_PARMETIS
 }
 #endif  // TACS_CPLUSPLUS_METIS
 
@@ -109,6 +109,18 @@ cdef inline _init_Mg(TACSMg *ptr):
     mg.mg.incref()
     return mg
 
+cdef class Amg(Pc):
+    cdef TACSAmg *amg
+
+cdef class ChebyshevPc(Pc):
+    cdef TACSChebyshevPc *cpc
+
+cdef class GMRESPolynomialPc(Pc):
+    cdef TACSGMRESPolynomialPc *gpc
+
+cdef class BDDCPc(Pc):
+    cdef TACSBDDCPc *bpc
+
 cdef class KSM:
     cdef TACSKsm *ptr
 
@@ -165,5 +177,9 @@ cdef inline _init_Assembler(TACSAssembler *ptr):
     tacs.ptr.incref()
     return tacs
 
+cdef class RandomVibration:
+    cdef TACSRandomVibration *ptr
+    cdef object assembler
+
 cdef class JacobiDavidsonOperator:
     cdef TACSJacobiDavidsonOperator *ptr
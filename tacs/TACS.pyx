@@ -51,6 +51,24 @@ MASS_ELEMENT = TACS_MASS_ELEMENT
 SPRING_ELEMENT = TACS_SPRING_ELEMENT
 PCM_ELEMENT = TACS_PCM_ELEMENT
 
+# Import the FH5 compression and storage types
+FH5_NO_COMPRESSION = TACS_FH5_NO_COMPRESSION
+FH5_LOSSLESS = TACS_FH5_LOSSLESS
+FH5_QUANTIZE = TACS_FH5_QUANTIZE
+FH5_FLOAT = TACS_FH5_FLOAT
+FH5_HALF = TACS_FH5_HALF
+FH5_BFLOAT16 = TACS_FH5_BFLOAT16
+
+# Import the multigrid cycle types
+MG_V_CYCLE = TACS_MG_V_CYCLE
+MG_W_CYCLE = TACS_MG_W_CYCLE
+MG_F_CYCLE = TACS_MG_F_CYCLE
+MG_K_CYCLE = TACS_MG_K_CYCLE
+
+# Import the algebraic multigrid smoother types
+AMG_CHEBYSHEV_SMOOTHER = TACS_AMG_CHEBYSHEV_SMOOTHER
+AMG_GAUSS_SEIDEL_SMOOTHER = TACS_AMG_GAUSS_SEIDEL_SMOOTHER
+
 # Import the element matrix types
 STIFFNESS_MATRIX = TACS_STIFFNESS_MATRIX
 MASS_MATRIX = TACS_MASS_MATRIX
@@ -92,6 +110,11 @@ OUTPUT_STRESSES = TACS_OUTPUT_STRESSES
 OUTPUT_EXTRAS = TACS_OUTPUT_EXTRAS
 OUTPUT_LOADS = TACS_OUTPUT_LOADS
 
+# Import the time history output data types
+HISTORY_STATES = TACS_HISTORY_STATES
+HISTORY_RATES = TACS_HISTORY_RATES
+HISTORY_ACCELERATIONS = TACS_HISTORY_ACCELERATIONS
+
 LAYOUT_NONE = TACS_LAYOUT_NONE
 POINT_ELEMENT = TACS_POINT_ELEMENT
 LINE_ELEMENT = TACS_LINE_ELEMENT
@@ -126,6 +149,7 @@ SEP_SMALLEST = SMALLEST
 SEP_LARGEST = LARGEST
 SEP_SMALLEST_MAGNITUDE = SMALLEST_MAGNITUDE
 SEP_LARGEST_MAGNITUDE = LARGEST_MAGNITUDE
+SEP_NEAREST_SHIFT = NEAREST_SHIFT
 
 # Import the material types
 ISOTROPIC_MATERIAL = TACS_ISOTROPIC_MATERIAL
@@ -640,6 +664,18 @@ cdef class Vec:
         Py_INCREF(self)
         return arry
 
+    def __array__(self, dtype=None, copy=None):
+        """
+        Return a view of the local values, so that np.asarray(vec)
+        does not copy the data
+        """
+        arry = self.getArray()
+        if dtype is not None and np.dtype(dtype) != arry.dtype:
+            return arry.astype(dtype)
+        if copy:
+            return arry.copy()
+        return arry
+
     def getSize(self):
         """
         getSize(self)
@@ -915,6 +951,15 @@ cdef class AuxElements:
         self.ptr.addElement(num, elem.ptr)
         return
 
+    def addAuxElements(self, AuxElements src):
+        """
+        Add all the elements from another set of auxiliary elements.
+        The elements are shared, not copied, so a load case can be
+        built from a common set of loads plus a few extra elements.
+        """
+        self.ptr.addAuxElements(src.ptr)
+        return
+
 cdef _convertBCSRMat(BCSRMat *mat, PyObject *ptr):
     cdef int bsize = 0
     cdef int nrows = 0
@@ -928,14 +973,16 @@ cdef _convertBCSRMat(BCSRMat *mat, PyObject *ptr):
         mat.getArrays(&bsize, &nrows, &ncols, &rowp, &cols, &vals)
 
         size = rowp[nrows]
-        arowp = np.zeros(nrows + 1, dtype=int)
-        acols = np.zeros(size, dtype=int)
 
-        for i in range(nrows + 1):
-            arowp[i] = rowp[i]
-
-        for i in range(size):
-            acols[i] = cols[i]
+        # Wrap the non-zero pattern without copying it. The pattern
+        # belongs to the matrix, so these views are read-only and each
+        # holds a reference to the owner.
+        arowp = inplace_array_1d(np.NPY_INT, nrows + 1, <void*>rowp, ptr)
+        Py_INCREF(<object>ptr)
+        acols = inplace_array_1d(np.NPY_INT, size, <void*>cols, ptr)
+        Py_INCREF(<object>ptr)
+        arowp.flags.writeable = False
+        acols.flags.writeable = False
 
         avals = inplace_array_3d(TACS_NPY_SCALAR, size, bsize, bsize, vals, ptr)
 
@@ -973,6 +1020,12 @@ cdef class Mat:
         """
         self.ptr.mult(x.ptr, y.ptr)
 
+    def multTranspose(self, Vec x, Vec y):
+        """
+        Transpose matrix multiplication
+        """
+        self.ptr.multTranspose(x.ptr, y.ptr)
+
     def copyValues(self, Mat mat):
         """
         Copy the values from mat
@@ -1086,6 +1139,12 @@ cdef class Pc:
         """
         This creates a default preconditioner depending on the matrix
         type.
+
+        For Schur matrices, the 'reorder' keyword selects the ordering of
+        the global Schur complement: 0 for the natural ordering, 1 to
+        re-order fixed-size blocks (default), 2 for a minimum degree
+        nodal ordering with one block for each supernode of the factor
+        and 3 for a nested dissection nodal ordering with supernodes.
         """
         # Set the defaults for the direct factorization
         cdef int lev_fill = 1000000
@@ -1107,7 +1166,10 @@ cdef class Pc:
             p_ptr = _dynamicParallelMat(mat.ptr)
             sc_ptr = _dynamicSchurMat(mat.ptr)
 
+        # Only the base class creates the default preconditioner
         self.ptr = NULL
+        if type(self) is not Pc:
+            return
         if sc_ptr != NULL:
             self.ptr = new TACSSchurPc(sc_ptr, lev_fill, fill, reorder)
             self.ptr.incref()
@@ -1148,6 +1210,93 @@ cdef class Pc:
             pc_ptr.setMonitorBackSolveFlag(flag)
         return
 
+    def setSinglePrecisionFactor(self, int flag=1):
+        """
+        Store the factorization in single precision to reduce the
+        memory and the cost of applying the preconditioner. The
+        vectors and the arithmetic remain in double precision.
+        """
+        cdef TACSSchurPc *sc_ptr = NULL
+        cdef TACSAdditiveSchwarz *as_ptr = NULL
+        sc_ptr = _dynamicSchurPc(self.ptr)
+        as_ptr = _dynamicAdditiveSchwarz(self.ptr)
+        if sc_ptr is not NULL:
+            sc_ptr.setSinglePrecisionFactor(flag)
+        elif as_ptr is not NULL:
+            as_ptr.setSinglePrecisionFactor(flag)
+        return
+
+    def setRealPartFactor(self, int flag=1):
+        """
+        Factor only the real part of the matrix in the complex build.
+        The factorization is computed in real arithmetic and applied
+        to the real and imaginary parts of the vectors separately,
+        which is much cheaper for complex-step derivative checks. This
+        has no effect in the real build.
+        """
+        cdef TACSSchurPc *sc_ptr = NULL
+        cdef TACSAdditiveSchwarz *as_ptr = NULL
+        sc_ptr = _dynamicSchurPc(self.ptr)
+        as_ptr = _dynamicAdditiveSchwarz(self.ptr)
+        if sc_ptr is not NULL:
+            sc_ptr.setRealPartFactor(flag)
+        elif as_ptr is not NULL:
+            as_ptr.setRealPartFactor(flag)
+        return
+
+    def setDeviceFactor(self, int flag=1):
+        """
+        Factor the global Schur complement with the device backend. The
+        trailing matrix updates of the block-cyclic factorization are
+        then computed on the GPU when TACS is compiled with CUDA or HIP.
+        """
+        cdef TACSSchurPc *sc_ptr = NULL
+        sc_ptr = _dynamicSchurPc(self.ptr)
+        if sc_ptr is not NULL:
+            sc_ptr.setDeviceFactorFlag(flag)
+        return
+
+    def setOverlap(self, int overlap, int restricted=1):
+        """
+        Extend the subdomains of the additive Schwarz preconditioner by
+        the given number of layers of nodes. When restricted is true,
+        only the owned components of the subdomain solutions are kept.
+        """
+        cdef TACSAdditiveSchwarz *as_ptr = NULL
+        as_ptr = _dynamicAdditiveSchwarz(self.ptr)
+        if as_ptr is not NULL:
+            as_ptr.setOverlap(overlap, restricted)
+        return
+
+    def setCoarseSpace(self, modes=None, int coarse_ranks=-1):
+        """
+        Add a coarse-space correction to the additive Schwarz
+        preconditioner built from the list of near null-space vectors.
+        When no vectors are given, the constant vectors for each
+        component are used. The coarse problem is solved with the
+        parallel direct solver on coarse_ranks ranks.
+        """
+        cdef TACSAdditiveSchwarz *as_ptr = NULL
+        cdef int nmodes = 0
+        cdef TACSBVec **vecs = NULL
+        as_ptr = _dynamicAdditiveSchwarz(self.ptr)
+        if as_ptr is NULL:
+            return
+
+        if modes is None:
+            as_ptr.setCoarseSpace(0, NULL, coarse_ranks)
+            return
+
+        nmodes = len(modes)
+        vecs = <TACSBVec**>malloc(nmodes*sizeof(TACSBVec*))
+        for i in range(nmodes):
+            vecs[i] = (<Vec>modes[i]).getBVecPtr()
+
+        as_ptr.setCoarseSpace(nmodes, vecs, coarse_ranks)
+
+        free(vecs)
+        return
+
 cdef class Mg(Pc):
     def __cinit__(self, MPI.Comm comm=None, int num_levs=-1, double omega=0.5,
                   int num_smooth=1, int mg_symm=0):
@@ -1231,9 +1380,168 @@ cdef class Mg(Pc):
         cdef char *descript = convert_to_chars(_descript)
         self.mg.setMonitor(new KSMPrintStdout(descript, comm.rank, freq))
 
+    def setCycleType(self, MgCycleType cycle_type):
+        """
+        Set the type of cycle used for the coarse-level corrections:
+        MG_V_CYCLE (default), MG_W_CYCLE, MG_F_CYCLE or MG_K_CYCLE
+        """
+        self.mg.setCycleType(cycle_type)
+        return
+
+    def setCoarseRanks(self, int num_ranks):
+        """
+        Set the number of ranks used for the direct solve on the coarsest
+        level when it is formed with Galerkin projection
+        """
+        self.mg.setCoarseRanks(num_ranks)
+        return
+
+    def setMultiColorSmoother(self, int flag):
+        """
+        Use multicolor sweeps in the Gauss-Seidel smoothers so that the
+        rows of each color are relaxed concurrently by the threads
+        """
+        self.mg.setMultiColorSmoother(flag)
+        return
+
+cdef class Amg(Pc):
+    def __cinit__(self, Mat mat=None, Assembler assembler=None,
+                  int max_levels=10, int coarse_size=1000, double theta=0.25,
+                  AmgSmootherType smoother_type=TACS_AMG_CHEBYSHEV_SMOOTHER,
+                  int smoother_iters=3):
+        """
+        Create a smoothed aggregation algebraic multigrid preconditioner
+        for the matrix from the given assembler. The coarse levels are
+        built from the non-zero pattern of the matrix and the nodal
+        coordinates.
+        """
+        cdef TACSParallelMat *p_ptr = NULL
+
+        # Replace the default preconditioner created by Pc
+        if self.ptr:
+            self.ptr.decref()
+        self.ptr = NULL
+        self.amg = NULL
+
+        if mat is not None:
+            p_ptr = _dynamicParallelMat(mat.ptr)
+        if p_ptr != NULL and assembler is not None:
+            self.amg = new TACSAmg(assembler.ptr, p_ptr, max_levels,
+                                   coarse_size, theta, smoother_type,
+                                   smoother_iters)
+            self.amg.incref()
+        elif mat is not None:
+            raise ValueError('Amg requires a parallel matrix and an assembler')
+        self.ptr = self.amg
+
+    def getNumLevels(self):
+        """Get the number of levels in the hierarchy"""
+        return self.amg.getNumLevels()
+
+    def setMonitor(self, MPI.Comm comm,
+                   _descript='AMG', int freq=1):
+        """
+        Print the number of nodes on each level when the preconditioner
+        is factored
+        """
+        cdef char *descript = convert_to_chars(_descript)
+        self.amg.setMonitor(new KSMPrintStdout(descript, comm.rank, freq))
+
+cdef class ChebyshevPc(Pc):
+    def __cinit__(self, Mat mat=None, int max_degree=30, Pc pc=None,
+                  double rtol=1e-2, int arnoldi_size=20,
+                  double upper_factor=1.05):
+        """
+        Create a Chebyshev polynomial preconditioner for M^{-1}*A, where
+        M is the optional inner preconditioner pc. The spectral interval
+        is estimated when the preconditioner is factored, and the degree
+        is selected to reduce the residual by rtol, up to max_degree.
+        The application does not require any global reductions.
+        """
+        cdef TACSPc *pc_ptr = NULL
+
+        # Replace the default preconditioner created by Pc
+        if self.ptr:
+            self.ptr.decref()
+        self.ptr = NULL
+        self.cpc = NULL
+
+        if pc is not None:
+            pc_ptr = pc.ptr
+        if mat is not None:
+            self.cpc = new TACSChebyshevPc(mat.ptr, max_degree, pc_ptr, rtol,
+                                           arnoldi_size, upper_factor)
+            self.cpc.incref()
+        self.ptr = self.cpc
+
+    def getDegree(self):
+        """Get the degree of the polynomial selected when factored"""
+        return self.cpc.getDegree()
+
+cdef class GMRESPolynomialPc(Pc):
+    def __cinit__(self, Mat mat=None, int max_degree=30, Pc pc=None,
+                  double rtol=1e-2):
+        """
+        Create a GMRES polynomial preconditioner for M^{-1}*A, where M
+        is the optional inner preconditioner pc. The polynomial is
+        computed when the preconditioner is factored, and its degree is
+        the number of GMRES iterations required to reduce the residual
+        by rtol, up to max_degree. The application does not require any
+        global reductions.
+        """
+        cdef TACSPc *pc_ptr = NULL
+
+        # Replace the default preconditioner created by Pc
+        if self.ptr:
+            self.ptr.decref()
+        self.ptr = NULL
+        self.gpc = NULL
+
+        if pc is not None:
+            pc_ptr = pc.ptr
+        if mat is not None:
+            self.gpc = new TACSGMRESPolynomialPc(mat.ptr, max_degree, pc_ptr,
+                                                 rtol)
+            self.gpc.incref()
+        self.ptr = self.gpc
+
+    def getDegree(self):
+        """Get the degree of the polynomial selected when factored"""
+        return self.gpc.getDegree()
+
+cdef class BDDCPc(Pc):
+    def __cinit__(self, Mat mat=None, int lev_fill=1000000,
+                  double ratio_fill=10.0, int coarse_ranks=-1):
+        """
+        Create a balancing domain decomposition by constraints (BDDC)
+        preconditioner for a Schur matrix. The interior unknowns on each
+        processor are eliminated exactly, and the interface problem is
+        preconditioned with local solves and a coarse problem on the
+        primal nodes. The coarse problem is solved with the parallel
+        direct solver on coarse_ranks ranks.
+        """
+        cdef TACSSchurMat *sc_ptr = NULL
+
+        self.ptr = NULL
+        self.bpc = NULL
+        if mat is not None:
+            sc_ptr = _dynamicSchurMat(mat.ptr)
+            if sc_ptr == NULL:
+                raise ValueError('BDDCPc requires a Schur matrix')
+            self.bpc = new TACSBDDCPc(sc_ptr, lev_fill, ratio_fill,
+                                      coarse_ranks)
+            self.bpc.incref()
+        self.ptr = self.bpc
+
+    def getNumPrimalNodes(self):
+        """Get the total number of primal nodes in the coarse problem"""
+        return self.bpc.getNumPrimalNodes()
+
 cdef class KSM:
     def __cinit__(self, Mat mat, Pc pc, int m,
-                  int nrestart=1, int isFlexible=0):
+                  int nrestart=1, int isFlexible=0,
+                  method='GMRES', int sstep=4, int nrecycle=10,
+                  int block_size=8):
         """
         Create a GMRES object for solving a linear system with or
         without a preconditioner.
@@ -1247,9 +1555,32 @@ cdef class KSM:
         m:          the size of the Krylov subspace
         nrestart:   the number of restarts before we give up
         isFlexible: is the preconditioner actually flexible? If so use FGMRES
-        """
-
-        self.ptr = new GMRES(mat.ptr, pc.ptr, m, nrestart, isFlexible)
+        method:     'GMRES', 'PGMRES' for pipelined GMRES, 'SGMRES'
+                    for s-step GMRES, 'GCRODR' for GCRO-DR, which
+                    recycles a subspace between solves, or 'BGMRES' and
+                    'BPCG' for block GMRES and block PCG, which solve
+                    several right-hand-sides together in solveMulti().
+                    PGMRES and SGMRES are not flexible.
+        sstep:      the number of vectors between reductions for SGMRES
+        nrecycle:   the number of recycled vectors for GCRODR
+        block_size: the maximum number of right-hand-sides in each block
+                    for BGMRES and BPCG
+        """
+        method = method.upper()
+        if method == 'PGMRES':
+            self.ptr = new PipelinedGMRES(mat.ptr, pc.ptr, m, nrestart)
+        elif method == 'SGMRES':
+            self.ptr = new SStepGMRES(mat.ptr, pc.ptr, m, nrestart, sstep)
+        elif method == 'GMRES':
+            self.ptr = new GMRES(mat.ptr, pc.ptr, m, nrestart, isFlexible)
+        elif method == 'GCRODR':
+            self.ptr = new GCRODR(mat.ptr, pc.ptr, m, nrecycle, nrestart)
+        elif method == 'BGMRES':
+            self.ptr = new BlockGMRES(mat.ptr, pc.ptr, m, nrestart, block_size)
+        elif method == 'BPCG':
+            self.ptr = new BlockPCG(mat.ptr, pc.ptr, m*nrestart, block_size)
+        else:
+            raise ValueError('Unknown Krylov method %s' % method)
         self.ptr.incref()
         return
 
@@ -1283,6 +1614,42 @@ cdef class KSM:
         """
         return self.ptr.solve(b.ptr, x.ptr, zero_guess)
 
+    def solveMulti(self, blist, xlist, int zero_guess=1):
+        """
+        Solve the linear system for several right-hand-sides. The block
+        methods solve them together, while the other methods solve
+        each system in turn.
+
+        input:
+        blist:      the list of right-hand-sides
+        xlist:      the list of solution vectors
+        zero_guess: indicate whether to zero entries of x before solution
+
+        output:
+        solve_flag: flag for whether all the solves terminated successfully
+        """
+        cdef int nrhs = 0
+        cdef TACSVec **b = NULL
+        cdef TACSVec **x = NULL
+        cdef int flag = 0
+
+        if len(blist) != len(xlist):
+            errmsg = 'Right-hand-side and solution list lengths must be equal'
+            raise ValueError(errmsg)
+
+        nrhs = len(blist)
+        b = <TACSVec**>malloc(nrhs*sizeof(TACSVec*))
+        x = <TACSVec**>malloc(nrhs*sizeof(TACSVec*))
+        for i in range(nrhs):
+            b[i] = (<Vec>blist[i]).ptr
+            x[i] = (<Vec>xlist[i]).ptr
+
+        flag = self.ptr.solveMulti(nrhs, b, x, zero_guess)
+
+        free(b)
+        free(x)
+        return flag
+
     def setTolerances(self, double rtol, double atol):
         """
         Set the relative and absolute tolerances used for the stopping
@@ -1306,12 +1673,56 @@ cdef class KSM:
         cdef char *descript = convert_to_chars(_descript)
         self.ptr.setMonitor(new KSMPrintStdout(descript, comm.rank, freq))
 
+    def setTelemetryMonitor(self, MPI.Comm comm, fname, _descript='GMRES'):
+        """
+        Write the residual, the time spent in the preconditioner,
+        matrix-vector products and orthogonalization, and the number of
+        reductions for each iteration to a file as JSON lines
+
+        input:
+        comm:     the communicator (only the root writes the file)
+        fname:    the name of the log file
+        descript: the name of the solver recorded with each entry
+        """
+        cdef char *filename = convert_to_chars(fname)
+        cdef char *descript = convert_to_chars(_descript)
+        self.ptr.setMonitor(new KSMPrintTelemetry(filename, descript,
+                                                  comm.rank))
+
     def setTimeMonitor(self):
         cdef GMRES *gmres_ptr = NULL
         gmres_ptr = _dynamicGMRES(self.ptr)
         if gmres_ptr != NULL:
             gmres_ptr.setTimeMonitor()
 
+    def clearRecycleSpace(self):
+        """Discard the recycled subspace (GCRODR only)"""
+        cdef GCRODR *dr_ptr = _dynamicGCRODR(self.ptr)
+        if dr_ptr != NULL:
+            dr_ptr.clearRecycleSpace()
+
+    def writeRecycleSpace(self, prefix):
+        """
+        Write the recycled subspace to the files prefix_<i>.bin
+        (GCRODR only)
+        """
+        cdef GCRODR *dr_ptr = _dynamicGCRODR(self.ptr)
+        cdef char *fname = convert_to_chars(prefix)
+        if dr_ptr != NULL:
+            return dr_ptr.writeRecycleSpace(fname)
+        return 1
+
+    def readRecycleSpace(self, prefix):
+        """
+        Read the recycled subspace written by writeRecycleSpace() and
+        return the number of vectors read (GCRODR only)
+        """
+        cdef GCRODR *dr_ptr = _dynamicGCRODR(self.ptr)
+        cdef char *fname = convert_to_chars(prefix)
+        if dr_ptr != NULL:
+            return dr_ptr.readRecycleSpace(fname)
+        return 0
+
 cdef class JacobiDavidsonOperator:
     def __cinit__(self, *args, **kwargs):
         self.ptr = NULL
@@ -1626,6 +2037,27 @@ cdef class Assembler:
                                    <double*>weights.data)
         return
 
+    def setDependentNodeTransform(self,
+                                  np.ndarray[double, ndim=1, mode='c'] weights,
+                                  np.ndarray[TacsScalar, ndim=1, mode='c'] offsets=None):
+        """
+        Set a block of weights for each entry of the dependent node
+        connectivity so that the dependent node variables are a linear
+        combination of all the variables at the independent nodes. This can be
+        used to eliminate RBE2/RBE3 connections from the global system.
+
+        Args:
+            weights (numpy.ndarray[float]): A row-major varsPerNode x varsPerNode
+              block for each entry of the dependent node connectivity.
+            offsets (numpy.ndarray[TacsScalar]): Fixed offset of each dependent
+              node location from the weighted sum of the independent nodes.
+        """
+        cdef TacsScalar *offset_ptr = NULL
+        if offsets is not None:
+            offset_ptr = <TacsScalar*>offsets.data
+        self.ptr.setDependentNodeTransform(<double*>weights.data, offset_ptr)
+        return
+
     def setElements(self, elements):
         """Set the elements in to TACSAssembler"""
         if len(elements) != self.getNumElements():
@@ -1891,6 +2323,60 @@ cdef class Assembler:
         self.ptr.setAuxElements(ptr)
         return
 
+    def setBodyLoads(self, inertiaVec=None, omegaVec=None, rotCenter=None,
+                     firstOrder=False):
+        """
+        Set a uniform inertial load and/or a centrifugal load on all elements.
+
+        The loads are applied directly within the element loops, without
+        an auxiliary element for each element. Passing no vectors removes
+        the body loads.
+
+        Args:
+            inertiaVec (numpy.ndarray, optional): The acceleration vector
+            omegaVec (numpy.ndarray, optional): The angular velocity vector (rad/s)
+            rotCenter (numpy.ndarray, optional): The center of rotation. Defaults to the origin.
+            firstOrder (bool, optional): Compute the centrifugal load in the displaced position
+        """
+        cdef np.ndarray[TacsScalar, ndim=1] g
+        cdef np.ndarray[TacsScalar, ndim=1] omega
+        cdef np.ndarray[TacsScalar, ndim=1] center
+        cdef TacsScalar *gptr = NULL
+        cdef TacsScalar *omegaptr = NULL
+        cdef TacsScalar *centerptr = NULL
+        if inertiaVec is not None:
+            g = np.array(inertiaVec, dtype=dtype).flatten()
+            gptr = <TacsScalar*>g.data
+        if omegaVec is not None:
+            omega = np.array(omegaVec, dtype=dtype).flatten()
+            omegaptr = <TacsScalar*>omega.data
+        if rotCenter is not None:
+            center = np.array(rotCenter, dtype=dtype).flatten()
+            centerptr = <TacsScalar*>center.data
+        self.ptr.setBodyLoads(gptr, omegaptr, centerptr, firstOrder)
+        return
+
+    def clearBodyLoads(self):
+        """Remove the body loads"""
+        self.ptr.clearBodyLoads()
+        return
+
+    def getVersions(self):
+        """
+        Get the number of changes made to the design variables (including
+        the nodes and auxiliary elements), the nodes, the state variables
+        and the body loads.
+
+        Setting values equal to the current values does not change the
+        versions, so the returned tuple can be used to detect whether
+        data computed from the model is stale.
+
+        Returns:
+            tuple: The (design, node, state, load) versions
+        """
+        return (self.ptr.getDesignVersion(), self.ptr.getNodeVersion(),
+                self.ptr.getStateVersion(), self.ptr.getLoadVersion())
+
     def createNodeVec(self):
         """
         Create a distributed node vector
@@ -2142,6 +2628,79 @@ cdef class Assembler:
         self.ptr.assembleRes(residual.getBVecPtr(), loadScale)
         return
 
+    def assembleAuxRes(self, list loads, list residuals):
+        """
+        Assemble the residual contributions of several sets of
+        auxiliary elements in a single pass over the elements.
+
+        Only the auxiliary elements contribute, so this computes the
+        load vectors for many load cases at once. The boundary
+        condition rows of each residual are zeroed.
+
+        loads:      list of AuxElements objects (entries may be None)
+        residuals:  list of output vectors, one for each load case
+        """
+        cdef int nloads = len(loads)
+        cdef TACSAuxElements **aux = NULL
+        cdef TACSBVec **res = NULL
+        if len(residuals) != nloads:
+            raise ValueError('The number of loads and residuals must match')
+
+        aux = <TACSAuxElements**>malloc(nloads*sizeof(TACSAuxElements*))
+        res = <TACSBVec**>malloc(nloads*sizeof(TACSBVec*))
+        for i in range(nloads):
+            aux[i] = NULL
+            if loads[i] is not None:
+                aux[i] = (<AuxElements>loads[i]).ptr
+            res[i] = (<Vec>residuals[i]).getBVecPtr()
+
+        self.ptr.assembleAuxRes(nloads, aux, res)
+
+        free(aux)
+        free(res)
+        return
+
+    def assembleResMulti(self, list loads, list residuals, loadScales=None):
+        """
+        Assemble the residuals for several load cases in a single
+        pass over the elements.
+
+        The residual for each case is the element residual plus the
+        scaled contribution of the auxiliary elements for that case.
+        The auxiliary elements set in the assembler are not used. The
+        resulting right-hand-sides can be passed to KSM.solveMulti.
+
+        loads:       list of AuxElements objects (entries may be None)
+        residuals:   list of output vectors, one for each load case
+        loadScales:  optional scaling factors for each load case
+        """
+        cdef int nloads = len(loads)
+        cdef TACSAuxElements **aux = NULL
+        cdef TACSBVec **res = NULL
+        cdef np.ndarray scales = None
+        cdef TacsScalar *scale_ptr = NULL
+        if len(residuals) != nloads:
+            raise ValueError('The number of loads and residuals must match')
+        if loadScales is not None:
+            scales = np.array(loadScales, dtype=dtype)
+            if scales.shape[0] != nloads:
+                raise ValueError('The number of load scales must match')
+            scale_ptr = <TacsScalar*>scales.data
+
+        aux = <TACSAuxElements**>malloc(nloads*sizeof(TACSAuxElements*))
+        res = <TACSBVec**>malloc(nloads*sizeof(TACSBVec*))
+        for i in range(nloads):
+            aux[i] = NULL
+            if loads[i] is not None:
+                aux[i] = (<AuxElements>loads[i]).ptr
+            res[i] = (<Vec>residuals[i]).getBVecPtr()
+
+        self.ptr.assembleResMulti(nloads, aux, res, scale_ptr)
+
+        free(aux)
+        free(res)
+        return
+
     def assembleJacobian(self, double alpha, double beta, double gamma,
                          Vec residual, Mat A,
                          MatrixOrientation matOr=TACS_MAT_NORMAL,
@@ -2173,6 +2732,64 @@ cdef class Assembler:
                                   res, A.ptr, matOr, loadScale)
         return
 
+    def assembleJacobianEnsemble(self, list dvs, double alpha, double beta,
+                                 double gamma, list residuals=None,
+                                 list mats=None, list states=None,
+                                 MatrixOrientation matOr=TACS_MAT_NORMAL):
+        """
+        Assemble the residuals and Jacobians of an ensemble of models
+        that differ only in their design variables and states.
+
+        The node locations and element data are retrieved once for
+        each element and the contributions of every member are then
+        computed. The element design variables are restored afterwards.
+
+        dvs:        list of design vectors, one for each member
+        alpha:      coefficient on the variables
+        beta:       coefficient on the time-derivative terms
+        gamma:      coefficient on the second time derivative term
+        residuals:  optional list of residual vectors for each member
+        mats:       optional list of matrices for each member
+        states:     optional list of state vectors for each member
+        matOr:      the matrix orientation NORMAL or TRANSPOSE
+        """
+        cdef int n = len(dvs)
+        cdef TACSBVec **dv_ptrs = NULL
+        cdef TACSBVec **var_ptrs = NULL
+        cdef TACSBVec **res_ptrs = NULL
+        cdef TACSMat **mat_ptrs = NULL
+        for arg in (residuals, mats, states):
+            if arg is not None and len(arg) != n:
+                raise ValueError('Expected one entry for each member')
+
+        dv_ptrs = <TACSBVec**>malloc(n*sizeof(TACSBVec*))
+        for i in range(n):
+            dv_ptrs[i] = (<Vec>dvs[i]).getBVecPtr()
+        if states is not None:
+            var_ptrs = <TACSBVec**>malloc(n*sizeof(TACSBVec*))
+            for i in range(n):
+                var_ptrs[i] = (<Vec>states[i]).getBVecPtr()
+        if residuals is not None:
+            res_ptrs = <TACSBVec**>malloc(n*sizeof(TACSBVec*))
+            for i in range(n):
+                res_ptrs[i] = (<Vec>residuals[i]).getBVecPtr()
+        if mats is not None:
+            mat_ptrs = <TACSMat**>malloc(n*sizeof(TACSMat*))
+            for i in range(n):
+                mat_ptrs[i] = (<Mat>mats[i]).ptr
+
+        self.ptr.assembleJacobianEnsemble(n, dv_ptrs, var_ptrs, alpha, beta,
+                                          gamma, res_ptrs, mat_ptrs, matOr)
+
+        free(dv_ptrs)
+        if var_ptrs != NULL:
+            free(var_ptrs)
+        if res_ptrs != NULL:
+            free(res_ptrs)
+        if mat_ptrs != NULL:
+            free(mat_ptrs)
+        return
+
     def assembleMatType(self, ElementMatrixType matType,
                         Mat A, MatrixOrientation matOr=TACS_MAT_NORMAL,
                         TacsScalar loadScale=1.0):
@@ -2200,6 +2817,24 @@ cdef class Assembler:
         self.ptr.assembleMatType(matType, A.ptr, matOr, loadScale)
         return
 
+    def assembleLumpedMass(self, Vec mass):
+        """
+        Assemble the lumped (row-sum) mass matrix into a vector. The
+        boundary conditions are not applied.
+
+        mass:      the diagonal of the lumped mass matrix (output)
+        """
+        self.ptr.assembleLumpedMass(mass.getBVecPtr())
+        return
+
+    def estimateStableTimeStep(self):
+        """
+        Estimate the largest stable time step for explicit integration
+        from the element eigenvalues at the current state. Returns zero
+        if there is no bound.
+        """
+        return self.ptr.estimateStableTimeStep()
+
     def assembleMatCombo(self, ElementMatrixType matType1, double scale1,
                          ElementMatrixType matType2, double scale2, Mat A,
                          MatrixOrientation matOr=NORMAL,
@@ -2277,6 +2912,62 @@ cdef class Assembler:
 
         return
 
+    def getSparseDVSens(self, funclist, double alpha=1.0):
+        """
+        Evaluate the sparse derivative of a list of functions w.r.t. the
+        design variables owned by this processor.
+
+        The derivatives are returned in compressed sparse row format with
+        one row for each function and the global design variable indices
+        as the columns. This can be passed directly to pyOptSparse as
+        {'csr': [rowp, cols, vals], 'shape': [len(funclist), ndvs]}.
+
+        Args:
+            funclist (list): List of Function objects
+            alpha (float): Coefficient applied to the derivative
+
+        Returns:
+            rowp (np.ndarray): Pointer into each row
+            cols (np.ndarray): Global design variable indices
+            vals (np.ndarray): Derivative values
+        """
+        cdef int num_funcs = 0
+        cdef int nnz = 0
+        cdef TACSFunction **funcs = NULL
+        cdef int *_rowp = NULL
+        cdef int *_cols = NULL
+        cdef TacsScalar *_vals = NULL
+
+        # Allocate space for the functions
+        num_funcs = len(funclist)
+        funcs = <TACSFunction**>malloc(num_funcs*sizeof(TACSFunction*))
+        for i in range(num_funcs):
+            if funclist[i] is not None:
+                funcs[i] = (<Function>funclist[i]).ptr
+            else:
+                funcs[i] = NULL
+
+        # Evaluate the sparse derivative of the functions
+        nnz = self.ptr.getSparseDVSens(alpha, num_funcs, funcs,
+                                       &_rowp, &_cols, &_vals)
+        free(funcs)
+
+        rowp = np.zeros(num_funcs+1, dtype=np.intc)
+        for i in range(num_funcs+1):
+            rowp[i] = _rowp[i]
+
+        cols = np.zeros(nnz, dtype=np.intc)
+        vals = np.zeros(nnz, dtype=dtype)
+        for i in range(nnz):
+            cols[i] = _cols[i]
+            vals[i] = _vals[i]
+
+        deleteArray(_rowp)
+        deleteArray(_cols)
+        deleteArray(_vals)
+
+        return rowp, cols, vals
+
     def addSVSens(self, funclist, dfdulist, double alpha=1.0,
                   double beta=0.0, double gamma=0.0):
 
@@ -2315,6 +3006,34 @@ cdef class Assembler:
 
         return
 
+    def setXptSensNodes(self, nodes=None):
+        """
+        Restrict the derivatives w.r.t. the node locations to a subset of
+        the nodes. Only the elements that touch the subset are visited, and
+        the derivatives for all other nodes are zero. Each processor may
+        provide any part of the subset. Pass None (on all processors) to
+        restore the derivatives for all nodes.
+
+        nodes: the global node numbers in the subset
+        """
+        cdef np.ndarray[int, ndim=1, mode='c'] node_array
+        if nodes is None:
+            self.ptr.setXptSensNodes(0, NULL)
+        else:
+            node_array = np.ascontiguousarray(nodes, dtype=np.intc)
+            self.ptr.setXptSensNodes(node_array.shape[0],
+                                     <int*>node_array.data)
+        return
+
+    def createXptJacobian(self):
+        """
+        Create a matrix-free operator for the derivative of the residuals
+        w.r.t. the node locations. mult(dX, res) computes dR/dX*dX and
+        multTranspose(psi, dfdX) computes psi^T*dR/dX, restricted to the
+        node subset from setXptSensNodes().
+        """
+        return _init_Mat(new TACSXptJacobian(self.ptr))
+
     def addXptSens(self, funclist, dfdXlist, alpha=1.0):
         """
         Evaluate the derivative of a list of functions w.r.t.
@@ -2418,6 +3137,112 @@ cdef class Assembler:
 
         return
 
+    def addResDVProducts(self, dxlist, reslist, double alpha=1.0, TacsScalar loadScale=1.0):
+        """
+        This function is collective on all TACSAssembler processes. This
+        computes the product of the derivative of the residual
+        w.r.t. the design variables with several direction vectors
+        in a single pass over the elements. The boundary condition
+        entries of the output are zeroed. These are the right-hand-sides
+        for direct (forward) sensitivities.
+
+        dxlist: the list of design variable direction vectors
+        reslist: the list of products with the residual derivative
+        loadScale: Scaling factor for the aux element contributions, by default 1
+        """
+        cdef int num_dirs = 0
+        cdef TACSBVec **dx = NULL
+        cdef TACSBVec **res = NULL
+
+        if len(dxlist) != len(reslist):
+            errmsg = 'Direction and residual vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        # Allocate space for the vectors
+        num_dirs = len(dxlist)
+        dx = <TACSBVec**>malloc(num_dirs*sizeof(TACSBVec*))
+        res = <TACSBVec**>malloc(num_dirs*sizeof(TACSBVec*))
+        for i in range(num_dirs):
+            dx[i] = (<Vec>dxlist[i]).getBVecPtr()
+            res[i] = (<Vec>reslist[i]).getBVecPtr()
+
+        # Evaluate the directional derivatives of the residual
+        self.ptr.addResDVProducts(alpha, num_dirs, dx, res, loadScale)
+
+        free(dx)
+        free(res)
+
+        return
+
+    def addResXptProducts(self, dXlist, reslist, double alpha=1.0, TacsScalar loadScale=1.0):
+        """
+        This function is collective on all TACSAssembler processes. This
+        computes the product of the derivative of the residual
+        w.r.t. the node locations with several direction vectors
+        in a single pass over the elements.
+        """
+        cdef int num_dirs = 0
+        cdef TACSBVec **dX = NULL
+        cdef TACSBVec **res = NULL
+
+        if len(dXlist) != len(reslist):
+            errmsg = 'Direction and residual vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        # Allocate space for the vectors
+        num_dirs = len(dXlist)
+        dX = <TACSBVec**>malloc(num_dirs*sizeof(TACSBVec*))
+        res = <TACSBVec**>malloc(num_dirs*sizeof(TACSBVec*))
+        for i in range(num_dirs):
+            dX[i] = (<Vec>dXlist[i]).getBVecPtr()
+            res[i] = (<Vec>reslist[i]).getBVecPtr()
+
+        # Evaluate the directional derivatives of the residual
+        self.ptr.addResXptProducts(alpha, num_dirs, dX, res, loadScale)
+
+        free(dX)
+        free(res)
+
+        return
+
+    def evalHessianVecProduct(self, funclist, KSM ksm, Vec direction,
+                              hveclist, double dh=1e-6):
+        """
+        Evaluate the product of the Hessian of each function with a
+        direction in the design variables using a second-order adjoint
+        method. The solver must contain the factored Jacobian at the
+        converged states.
+
+        funclist: the list of functions
+        ksm: the linear solver for the Jacobian
+        direction: the direction in the design variables
+        hveclist: the Hessian-vector products (output)
+        dh: the finite-difference or complex-step step size
+        """
+        cdef int num_funcs = 0
+        cdef TACSFunction **funcs = NULL
+        cdef TACSBVec **hvec = NULL
+
+        if len(funclist) != len(hveclist):
+            errmsg = 'Function and Hessian-vector product list lengths must be equal'
+            raise ValueError(errmsg)
+
+        # Allocate space for the functions and vectors
+        num_funcs = len(funclist)
+        funcs = <TACSFunction**>malloc(num_funcs*sizeof(TACSFunction*))
+        hvec = <TACSBVec**>malloc(num_funcs*sizeof(TACSBVec*))
+        for i in range(num_funcs):
+            funcs[i] = (<Function>funclist[i]).ptr
+            hvec[i] = (<Vec>hveclist[i]).getBVecPtr()
+
+        self.ptr.evalHessianVecProduct(num_funcs, funcs, ksm.ptr,
+                                       direction.getBVecPtr(), hvec, dh)
+
+        free(funcs)
+        free(hvec)
+
+        return
+
     def addMatDVSensInnerProduct(self, double scale,
                                  ElementMatrixType matType,
                                  Vec psi, Vec phi, Vec dfdx):
@@ -2464,14 +3289,32 @@ cdef class Assembler:
         self.ptr.testElement(elemNum, print_level, dh, rtol, atol)
         return
 
-    def testFunction(self, Function func, double dh):
+    def testElements(self, int num_samples, int print_level=0,
+                     double dh=1e-6, double rtol=1e-8, double atol=1e-1):
         """
-        Test the implementation of the function.
+        Test a sample of the elements of each element class.
 
-        This tests the state variable sensitivities and the design
-        variable sensitivities of the function of interest. These
-        sensitivities are computed based on a random perturbation of
-        the input values.  Note that a system of equations should be
+        Up to num_samples elements of each element class are tested
+        with the same tests as testElement(). The tests run on the
+        threads and a summary of the failures and the average time of
+        each test is printed for each element class.
+
+        num_samples:  the maximum number of elements to test in each class
+        print_level:  the print level to use for the individual tests
+
+        Returns:
+            int: the number of failed tests on this processor
+        """
+        return self.ptr.testElements(num_samples, print_level, dh, rtol, atol)
+
+    def testFunction(self, Function func, double dh):
+        """
+        Test the implementation of the function.
+
+        This tests the state variable sensitivities and the design
+        variable sensitivities of the function of interest. These
+        sensitivities are computed based on a random perturbation of
+        the input values.  Note that a system of equations should be
         solved - or the variables should be set randomly before
         calling this function, otherwise this function may produce
         unrealistic function values.
@@ -2529,6 +3372,235 @@ cdef class ToFH5:
         cdef char *filename = convert_to_chars(fname)
         self.ptr.writeToFile(filename)
 
+    def setAsyncOutput(self, int flag, size_t max_pending_bytes=0):
+        """
+        Set whether writeToFile() returns before the writes complete. The
+        data for the pending files is limited to max_pending_bytes on each
+        processor, in addition to the data for the most recent file
+        """
+        self.ptr.setAsyncOutput(flag, max_pending_bytes)
+
+    def flush(self):
+        """
+        Complete the writes for all pending files
+        """
+        self.ptr.flush()
+
+    def setCompression(self, FH5Compression codec, double tol=0.0,
+                       FH5DataType float_type=TACS_FH5_FLOAT):
+        """
+        Set the compression for the output data. With FH5_QUANTIZE,
+        the nodal and element data is stored with an absolute error of
+        at most tol. Otherwise the data is stored with float_type, which
+        may be FH5_FLOAT, FH5_HALF or FH5_BFLOAT16
+        """
+        self.ptr.setCompression(codec, tol, float_type)
+
+# Wrap the TACSToVTK class
+cdef class ToVTK:
+    cdef TACSToVTK *ptr
+    def __cinit__(self, Assembler tacs, ElementType elem_type,
+                  int out_type):
+        """
+        Create the object that writes partitioned VTK files that can be
+        opened directly in ParaView
+
+        input:
+        tacs:         the instance of the TACSAssembler object
+        elem_type:    the type of element to be used
+        out_type:     the output type to write
+        """
+        self.ptr = new TACSToVTK(tacs.ptr, elem_type, out_type)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+        return
+
+    def setComponentName(self, int comp_num, _group_name):
+        """
+        Set the component name for the variable
+        """
+        cdef char *group_name = convert_to_chars(_group_name)
+        self.ptr.setComponentName(comp_num, group_name)
+
+    def setSeriesFile(self, fname):
+        """
+        Set the .pvd collection that each subsequent file is appended to
+        at the current simulation time
+        """
+        cdef char *filename = convert_to_chars(fname)
+        self.ptr.setSeriesFile(filename)
+
+    def writeToFile(self, fname):
+        """
+        Write the data stored in the TACSAssembler object to the .pvtu
+        file and one .vtu piece for each processor
+        """
+        cdef char *filename = convert_to_chars(fname)
+        if self.ptr.writeToFile(filename):
+            raise RuntimeError("Failed to write the VTK file %s" % fname)
+
+cdef class TimeHistory:
+    cdef TACSTimeHistory *ptr
+    def __cinit__(self, Assembler tacs, probe_nodes,
+                  int write_flag=TACS_HISTORY_STATES, int buffer_size=1024):
+        """
+        Create the streaming time history output for the probe nodes
+
+        input:
+        tacs:         the instance of the TACSAssembler object
+        probe_nodes:  the global node numbers of the probes
+        write_flag:   OR of HISTORY_STATES, HISTORY_RATES, HISTORY_ACCELERATIONS
+        buffer_size:  the number of records buffered before writing
+        """
+        cdef np.ndarray[int, ndim=1, mode='c'] nodes
+        nodes = np.array(probe_nodes, dtype=np.intc)
+        self.ptr = new TACSTimeHistory(tacs.ptr, len(nodes), <int*>nodes.data,
+                                       write_flag, buffer_size)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+        return
+
+    def setFunctions(self, list funcs):
+        """
+        Set the functions that are evaluated at each record
+        """
+        cdef TACSFunction **fn = NULL
+        cdef int nfuncs = len(funcs)
+        fn = <TACSFunction**>malloc(nfuncs*sizeof(TACSFunction*))
+        for i in range(nfuncs):
+            if funcs[i] is None:
+                fn[i] = NULL
+            else:
+                fn[i] = (<Function>funcs[i]).ptr
+        self.ptr.setFunctions(nfuncs, fn)
+        free(fn)
+        return
+
+    def open(self, fname):
+        """
+        Open the output file and write the header
+        """
+        cdef char *filename = convert_to_chars(fname)
+        return self.ptr.open(filename)
+
+    def close(self):
+        """
+        Write out the buffered records and close the file
+        """
+        self.ptr.close()
+
+    def record(self, double time, Vec q, Vec qdot=None, Vec qddot=None):
+        """
+        Record the states at the probe nodes and the function values
+        """
+        cdef TACSBVec *qdot_ptr = NULL
+        cdef TACSBVec *qddot_ptr = NULL
+        if qdot is not None:
+            qdot_ptr = qdot.getBVecPtr()
+        if qddot is not None:
+            qddot_ptr = qddot.getBVecPtr()
+        self.ptr.record(time, q.getBVecPtr(), qdot_ptr, qddot_ptr)
+
+    def flush(self):
+        """
+        Write out the buffered records
+        """
+        self.ptr.flush()
+
+    def getNumRecords(self):
+        """
+        Get the number of records written to the file
+        """
+        return self.ptr.getNumRecords()
+
+    @staticmethod
+    def read(fname):
+        """
+        Read a time history file
+
+        Returns a dictionary with the probe nodes, the times, the function
+        values and the probe values as an array of shape
+        (num_records, num_probes, num_data, vars_per_node)
+        """
+        with open(fname, "rb") as fp:
+            header = np.fromfile(fp, dtype=np.intc, count=5)
+            num_probes, vars_per_node, write_flag, num_funcs, record_len = header
+            nodes = np.fromfile(fp, dtype=np.intc, count=num_probes)
+            data = np.fromfile(fp, dtype=np.float64)
+        data = data.reshape(-1, record_len)
+        values = data[:, 1 + num_funcs :].reshape(
+            data.shape[0], num_probes, -1, vars_per_node
+        )
+        return {
+            "probe_nodes": nodes,
+            "write_flag": write_flag,
+            "time": data[:, 0],
+            "funcs": data[:, 1 : 1 + num_funcs],
+            "values": values,
+        }
+
+cdef class ReducedOrderModel:
+    cdef TACSReducedOrderModel *ptr
+    def __cinit__(self, Assembler tacs=None, int max_basis_size=0,
+                  int oversample=10):
+        """
+        Create a hyper-reduced POD-Galerkin model. The basis and the sampled
+        elements are usually computed with BDFIntegrator.buildReducedOrderModel
+
+        input:
+        tacs:            the instance of the TACSAssembler object
+        max_basis_size:  the maximum number of basis vectors
+        oversample:      the oversampling used in the randomized SVD
+        """
+        self.ptr = NULL
+        if tacs is not None:
+            self.ptr = new TACSReducedOrderModel(tacs.ptr, max_basis_size,
+                                                 oversample)
+            self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+        return
+
+    def getBasisSize(self):
+        """
+        Get the number of basis vectors
+        """
+        return self.ptr.getBasisSize()
+
+    def getBasisVec(self, int i):
+        """
+        Get the basis vector
+        """
+        cdef TACSBVec *vec = self.ptr.getBasisVec(i)
+        if vec == NULL:
+            return None
+        return _init_Vec(vec)
+
+    def getNumSampleElements(self):
+        """
+        Get the number of sampled elements across all processors
+        """
+        return self.ptr.getNumSampleElements()
+
+    def getSingularValues(self):
+        """
+        Get the singular values of the snapshots in descending order
+        """
+        cdef const double *sigma = NULL
+        cdef int n = self.ptr.getSingularValues(&sigma)
+        return np.array([sigma[i] for i in range(n)])
+
 cdef class FH5Loader:
     cdef TACSFH5Loader *ptr
     def __cinit__(self):
@@ -2552,6 +3624,15 @@ cdef class FH5Loader:
         self.ptr.loadData(filename, dataname)
         return
 
+    def setNumThreads(self, int num_threads):
+        """
+        setNumThreads(self, num_threads)
+
+        Set the number of threads used for the isosurface extraction
+        """
+        self.ptr.setNumThreads(num_threads)
+        return
+
     def getNumComponents(self):
         """
         getNumComponents(self)
@@ -2860,6 +3941,23 @@ cdef class Creator:
                                        <int*>id_nums.data)
         return
 
+    def setDistributedConnectivity(self, int num_owned_nodes,
+                                   np.ndarray[int, ndim=1, mode='c'] node_ptr,
+                                   np.ndarray[int, ndim=1, mode='c'] node_conn,
+                                   np.ndarray[int, ndim=1, mode='c'] id_nums):
+        """
+        Set the connectivity and element id numbers for the slice of a
+        mesh on this processor. This must be called on all processors
+        """
+        cdef int num_elements = node_ptr.shape[0]-1
+        if num_elements != id_nums.shape[0]:
+            raise ValueError('Connectivity must match number of element ids')
+        self.ptr.setDistributedConnectivity(num_owned_nodes, num_elements,
+                                            <int*>node_ptr.data,
+                                            <int*>node_conn.data,
+                                            <int*>id_nums.data)
+        return
+
     def setBoundaryConditions(self,
                               np.ndarray[int, ndim=1, mode='c'] nodes,
                               np.ndarray[int, ndim=1, mode='c'] bcptr=None,
@@ -2931,6 +4029,18 @@ cdef class Creator:
     def createTACS(self):
         return _init_Assembler(self.ptr.createTACS())
 
+    def repartition(self, Assembler assembler,
+                    np.ndarray[double, ndim=1, mode='c'] costs):
+        """
+        Repartition the mesh with the measured costs of the local
+        elements and return a new Assembler with the state, node
+        locations and design variables of the input assembler
+        """
+        if costs.shape[0] != assembler.getNumElements():
+            raise ValueError('Expected one cost for each local element')
+        return _init_Assembler(self.ptr.repartition(assembler.ptr,
+                                                    <double*>costs.data))
+
     def getElementIdNums(self, np.ndarray[int, ndim=1, mode='c'] elem_ids=None):
         cdef int num_ids = 0
         cdef int *ids = NULL
@@ -2973,6 +4083,327 @@ cdef class Creator:
         deleteArray(new_nodes)
         return array
 
+cdef class PanelLength:
+    """
+    Compute the lengths of panels from the node locations of the
+    assembler, and their derivatives w.r.t. the boundary nodes.
+
+    Each panel is the closed loop of assembler node numbers
+    panel_nodes[panel_ptr[i]:panel_ptr[i+1]] with the direction
+    directions[i], which must be the same on all processors. The
+    derivatives are returned in the order of the panel nodes, three
+    values for each node.
+    """
+    cdef TACSPanelLength *ptr
+    def __cinit__(self, Assembler assembler,
+                  np.ndarray[int, ndim=1, mode='c'] panel_ptr,
+                  np.ndarray[int, ndim=1, mode='c'] panel_nodes,
+                  np.ndarray[TacsScalar, ndim=2, mode='c'] directions):
+        cdef int num_panels = panel_ptr.shape[0] - 1
+        if directions.shape[0] != num_panels or directions.shape[1] != 3:
+            raise ValueError('Directions must be of shape (num_panels, 3)')
+        if panel_nodes.shape[0] != panel_ptr[num_panels]:
+            raise ValueError('Panel nodes must match the panel pointer')
+        self.ptr = new TACSPanelLength(assembler.ptr, num_panels,
+                                       <int*>panel_ptr.data,
+                                       <int*>panel_nodes.data,
+                                       <TacsScalar*>directions.data)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
+
+    def evalLengths(self, Vec X):
+        """Evaluate the length of each panel (collective)"""
+        cdef np.ndarray lengths = np.zeros(self.ptr.getNumPanels(), dtype=dtype)
+        self.ptr.evalLengths(X.getBVecPtr(), <TacsScalar*>lengths.data)
+        return lengths
+
+    def evalLengthSens(self, Vec X):
+        """
+        Evaluate the length of each panel and the derivatives w.r.t.
+        the panel nodes (collective)
+        """
+        cdef np.ndarray lengths = np.zeros(self.ptr.getNumPanels(), dtype=dtype)
+        cdef np.ndarray sens = np.zeros(3*self.ptr.getNumPanelNodes(),
+                                        dtype=dtype)
+        self.ptr.evalLengthSens(X.getBVecPtr(), <TacsScalar*>lengths.data,
+                                <TacsScalar*>sens.data)
+        return lengths, sens
+
+cdef class LinearConstraint:
+    """
+    Build the sparse Jacobian of linear constraints on the design
+    variables of the components of the assembler (collective).
+
+    Each processor stores the entries for the design variables that it
+    owns, numbered locally. Each row exists on all processors, so the
+    constraint values are the sum of the local products.
+    """
+    cdef TACSLinearConstraint *ptr
+    def __cinit__(self, Assembler assembler):
+        self.ptr = new TACSLinearConstraint(assembler.ptr)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
+
+    def addAdjacencyConstraints(self,
+                                np.ndarray[int, ndim=2, mode='c'] compPairs,
+                                int dvIndex):
+        """
+        Add a constraint that the design variable dvIndex of the first
+        component in each pair equals that of the second component
+        """
+        if compPairs.shape[1] != 2:
+            raise ValueError('Component pairs must be of shape (n, 2)')
+        return self.ptr.addAdjacencyConstraints(compPairs.shape[0],
+                                                <int*>compPairs.data, dvIndex)
+
+    def addDVConstraints(self, np.ndarray[int, ndim=1, mode='c'] compIDs,
+                         np.ndarray[int, ndim=1, mode='c'] dvIndices,
+                         np.ndarray[TacsScalar, ndim=1, mode='c'] dvWeights):
+        """
+        Add a constraint for each component that is the weighted sum of
+        the design variables dvIndices within the component
+        """
+        if dvIndices.shape[0] != dvWeights.shape[0]:
+            raise ValueError('The DV indices and weights must be the same length')
+        return self.ptr.addDVConstraints(compIDs.shape[0], <int*>compIDs.data,
+                                         dvIndices.shape[0],
+                                         <int*>dvIndices.data,
+                                         <TacsScalar*>dvWeights.data)
+
+    def getNumConstraints(self):
+        return self.ptr.getNumConstraints()
+
+    def getNumDesignVars(self):
+        return self.ptr.getNumDesignVars()
+
+    def getArrays(self):
+        """
+        Get read-only views of the rowp, cols and vals arrays of the
+        Jacobian in compressed sparse row format. The views are not
+        valid after more constraints are added.
+        """
+        cdef int nrows = 0
+        cdef int ncols = 0
+        cdef const int *rowp = NULL
+        cdef const int *cols = NULL
+        cdef const TacsScalar *vals = NULL
+        self.ptr.getArrays(&nrows, &ncols, &rowp, &cols, &vals)
+
+        arowp = inplace_array_1d(np.NPY_INT, nrows + 1, <void*>rowp,
+                                 <PyObject*>self)
+        Py_INCREF(self)
+        acols = inplace_array_1d(np.NPY_INT, rowp[nrows], <void*>cols,
+                                 <PyObject*>self)
+        Py_INCREF(self)
+        avals = inplace_array_1d(TACS_NPY_SCALAR, rowp[nrows], <void*>vals,
+                                 <PyObject*>self)
+        Py_INCREF(self)
+        arowp.flags.writeable = False
+        acols.flags.writeable = False
+        avals.flags.writeable = False
+        return arowp, acols, avals
+
+cdef class LoadTransfer:
+    """
+    Transfer displacements and loads between the structural surface
+    nodes and an aerodynamic point cloud (collective).
+
+    Each aerodynamic point is interpolated from its numNearest nearest
+    surface nodes with moving least-squares weights W. The displacements
+    of the points are W*u_s and the structural loads are W^T*f_a.
+
+    Parameters
+    ----------
+    assembler : Assembler
+        The assembler object
+    surfNodes : numpy.ndarray[int]
+        The assembler node numbers of the surface nodes given on this
+        processor
+    Xaero : numpy.ndarray
+        The aerodynamic points owned by this processor (3*n values)
+    numNearest : int
+        The number of surface nodes used for each point
+    """
+    cdef TACSLoadTransfer *ptr
+    def __cinit__(self, Assembler assembler,
+                  np.ndarray[int, ndim=1, mode='c'] surfNodes,
+                  np.ndarray[TacsScalar, ndim=1, mode='c'] Xaero,
+                  int numNearest=8):
+        if Xaero.shape[0] % 3 != 0:
+            raise ValueError('Aerodynamic points must have 3 values each')
+        self.ptr = new TACSLoadTransfer(assembler.ptr, surfNodes.shape[0],
+                                        <int*>surfNodes.data,
+                                        Xaero.shape[0]//3,
+                                        <TacsScalar*>Xaero.data, numNearest)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
+
+    def getNumAeroNodes(self):
+        return self.ptr.getNumAeroNodes()
+
+    def transferDisps(self, Vec us):
+        """Compute the displacements of the aerodynamic points"""
+        cdef np.ndarray ua = np.zeros(3*self.ptr.getNumAeroNodes(),
+                                      dtype=dtype)
+        self.ptr.transferDisps(us.getBVecPtr(), <TacsScalar*>ua.data)
+        return ua
+
+    def transferLoads(self, np.ndarray[TacsScalar, ndim=1, mode='c'] fa,
+                      Vec fs):
+        """Compute the structural loads from the aerodynamic loads"""
+        if fa.shape[0] != 3*self.ptr.getNumAeroNodes():
+            raise ValueError('Loads must have 3 values for each point')
+        self.ptr.transferLoads(<TacsScalar*>fa.data, fs.getBVecPtr())
+        return
+
+    def getWeights(self):
+        """
+        Get copies of the interpolation weights in CSR format, with
+        the assembler node numbers as the columns
+        """
+        cdef const int *ptr = NULL
+        cdef const int *nodes = NULL
+        cdef const TacsScalar *weights = NULL
+        cdef int n = self.ptr.getNumAeroNodes()
+        self.ptr.getWeights(&ptr, &nodes, &weights)
+
+        aptr = np.zeros(n + 1, dtype=np.intc)
+        for i in range(n + 1):
+            aptr[i] = ptr[i]
+        anodes = np.zeros(ptr[n], dtype=np.intc)
+        aweights = np.zeros(ptr[n], dtype=dtype)
+        for i in range(ptr[n]):
+            anodes[i] = nodes[i]
+            aweights[i] = weights[i]
+        return aptr, anodes, aweights
+
+cdef class DensityFilter:
+    """
+    A density filter with Heaviside projection for topology
+    optimization (collective).
+
+    The filtered design variables are the weighted average of the
+    design variables within the filter radius, with the weights
+    max(0, r - d). The location of each design variable is the average
+    of the centroids of the elements that use it.
+
+    Parameters
+    ----------
+    assembler : Assembler
+        The assembler object
+    radius : float
+        The filter radius
+    """
+    cdef TACSDensityFilter *ptr
+    def __cinit__(self, Assembler assembler, double radius):
+        self.ptr = new TACSDensityFilter(assembler.ptr, radius)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
+
+    def setProjection(self, double beta, double eta=0.5):
+        """Set the Heaviside projection parameters (beta=0 for none)"""
+        self.ptr.setProjection(beta, eta)
+        return
+
+    def applyFilter(self, Vec x, Vec xfilt):
+        """Compute the filtered and projected design variables"""
+        self.ptr.applyFilter(x.getBVecPtr(), xfilt.getBVecPtr())
+        return
+
+    def applyFilterSens(self, Vec dfdxfilt, Vec dfdx):
+        """
+        Compute the derivative w.r.t. the design variables from the
+        derivative w.r.t. the filtered design variables, using the
+        values from the last call to applyFilter
+        """
+        self.ptr.applyFilterSens(dfdxfilt.getBVecPtr(), dfdx.getBVecPtr())
+        return
+
+cdef class ThermoStructural:
+    """
+    Staggered solver for coupled thermal-structural problems.
+
+    The thermal (one variable per node), structural and coupled
+    thermoelastic assemblers must be created on the same mesh. The
+    coupled model assembles the residual, and each field is updated by
+    block Gauss-Seidel with its own factorization, which is reused
+    until resetFactorizations() is called.
+    """
+    cdef TACSThermoStructural *ptr
+    def __cinit__(self, Assembler thermal, Assembler structure,
+                  Assembler coupled):
+        self.ptr = new TACSThermoStructural(thermal.ptr, structure.ptr,
+                                            coupled.ptr)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
+
+    def setTolerances(self, double rtol, double atol):
+        self.ptr.setTolerances(rtol, atol)
+        return
+
+    def setMaxIterations(self, int max_iters):
+        self.ptr.setMaxIterations(max_iters)
+        return
+
+    def setPrintLevel(self, int print_level):
+        self.ptr.setPrintLevel(print_level)
+        return
+
+    def resetFactorizations(self):
+        """Recompute the field factorizations on the next solve"""
+        self.ptr.resetFactorizations()
+        return
+
+    def getNumFactorizations(self):
+        return self.ptr.getNumFactorizations()
+
+    def getNumIterations(self):
+        return self.ptr.getNumIterations()
+
+    def solve(self, Vec T, Vec u, Vec heat=None, Vec force=None):
+        """
+        Solve the coupled problem, starting from and overwriting T and
+        u. Returns True if the coupling iterations converged.
+        """
+        cdef TACSBVec *heat_ptr = NULL
+        cdef TACSBVec *force_ptr = NULL
+        if heat is not None:
+            heat_ptr = heat.getBVecPtr()
+        if force is not None:
+            force_ptr = force.getBVecPtr()
+        return self.ptr.solve(heat_ptr, force_ptr, T.getBVecPtr(),
+                              u.getBVecPtr()) == 0
+
+    def merge(self, Vec T, Vec u, Vec uc):
+        """Merge the field vectors into the coupled vector"""
+        self.ptr.merge(T.getBVecPtr(), u.getBVecPtr(), uc.getBVecPtr())
+        return
+
+    def split(self, Vec uc, Vec T, Vec u):
+        """Split the coupled vector into the field vectors"""
+        self.ptr.split(uc.getBVecPtr(), T.getBVecPtr(), u.getBVecPtr())
+        return
+
 # Wrap the TACSMeshLoader class
 cdef class MeshLoader:
     cdef TACSMeshLoader *ptr
@@ -2998,6 +4429,33 @@ cdef class MeshLoader:
         cdef char *filename = convert_to_chars(fname)
         self.ptr.scanBDFFile(filename)
 
+    def scanBDFFileParallel(self, fname):
+        """
+        Scan a Nastran file in parallel so that the mesh is distributed
+        across all processors and never stored on a single processor
+
+        The nodes and elements are partitioned according to their
+        numbers in the file
+        """
+        cdef char *filename = convert_to_chars(fname)
+        self.ptr.scanBDFFileParallel(filename)
+
+    def writeMeshCache(self, Assembler assembler, fname):
+        """
+        Write the partitioned mesh and node reordering to a binary cache
+        file that can be read with readMeshCache()
+        """
+        cdef char *filename = convert_to_chars(fname)
+        return self.ptr.writeMeshCache(assembler.ptr, filename)
+
+    def readMeshCache(self, fname):
+        """
+        Read a mesh cache file in place of scanning the Nastran file. The
+        cache must be read on the same number of processors that wrote it
+        """
+        cdef char *filename = convert_to_chars(fname)
+        return self.ptr.readMeshCache(filename)
+
     def getNumComponents(self):
         """
         Return the number of components
@@ -3167,6 +4625,120 @@ cdef class FrequencyAnalysis:
     def setSigma(self, TacsScalar sigma):
         self.ptr.setSigma(sigma)
 
+    def setBlockLanczos(self, int block_size, int max_restarts=25):
+        """
+        Use the thick-restart block Lanczos eigensolver.
+
+        The block of vectors is applied with multi-vector shift-invert
+        solves and orthogonalized with level-3 BLAS. The max_lanczos
+        argument then bounds the size of the basis, and at most
+        max_lanczos - 2*block_size eigenvalues can be computed.
+
+        Args:
+            block_size (int): The block size (0 uses single-vector Lanczos)
+            max_restarts (int): The maximum number of restarts
+        """
+        self.ptr.setBlockLanczos(block_size, max_restarts)
+
+    def setLOBPCG(self, int block_size, int max_iters=200):
+        """
+        Use the block LOBPCG eigensolver in place of Jacobi-Davidson.
+
+        LOBPCG uses the same preconditioner as the Jacobi-Davidson method
+        and computes all the eigenvalues within the block at once. With a
+        multigrid preconditioner, no factorization is required. This is
+        only available with the Jacobi-Davidson constructor arguments.
+
+        Args:
+            block_size (int): The block size (at least the number of eigenvalues)
+            max_iters (int): The maximum number of iterations
+        """
+        self.ptr.setLOBPCG(block_size, max_iters)
+
+    def setJDInnerSolver(self, int num_inner_recycle, double shift_rtol=-1.0):
+        """
+        Set the options for the inner FGMRES solves of Jacobi-Davidson.
+
+        The recycled vectors are selected from each FGMRES solve and used
+        to augment the next one. When shift_rtol is non-negative, the
+        coarsest level of a multigrid preconditioner is shifted to the
+        current Ritz value whenever it moves by more than shift_rtol
+        relative to the last shift.
+
+        Args:
+            num_inner_recycle (int): The number of recycled vectors (0 to disable)
+            shift_rtol (float): The relative change that updates the shift
+        """
+        self.ptr.setJDInnerSolver(num_inner_recycle, shift_rtol)
+
+    def setWarmStart(self, warm_start=True):
+        """
+        Warm-start the eigensolver with the eigenvectors from the previous
+        solve and track the modes between solves.
+
+        The new eigenvectors are matched with the saved eigenvectors using
+        the modal assurance criterion (MAC).
+
+        Args:
+            warm_start (bool): Flag to set or remove the warm start
+        """
+        self.ptr.setWarmStart(int(warm_start))
+
+    def getTrackedMode(self, int n):
+        """
+        Get the index of the current mode that matches the n-th mode from
+        the first solve after the warm start was set.
+
+        Args:
+            n (int): The index of the mode from the first solve
+
+        Returns:
+            int, float: The index of the current mode and the MAC value
+        """
+        cdef TacsScalar mac = 0.0
+        cdef int mode = self.ptr.getTrackedMode(n, &mac)
+        return mode, mac
+
+    def setReducedBasis(self, int max_basis_size, double basis_tol=1e-3):
+        """
+        Solve with a reduced basis of the cached modes and static shapes.
+
+        The stiffness and mass matrices are projected onto the basis and
+        the small dense eigenproblem is solved. The full eigensolver is
+        only used when the relative residual of any of the requested
+        eigenpairs exceeds the tolerance. The new eigenvectors then
+        replace the cached modes in the basis.
+
+        Args:
+            max_basis_size (int): The maximum size of the basis (0 removes it)
+            basis_tol (float): The tolerance on the relative residual
+        """
+        self.ptr.setReducedBasis(max_basis_size, basis_tol)
+
+    def addReducedBasisVectors(self, list vecs):
+        """
+        Add static shapes, such as the displacements due to the design
+        loads, to the reduced basis. This discards the cached modes.
+
+        Args:
+            vecs (list[Vec]): The static shapes to add to the basis
+        """
+        cdef int nvecs = len(vecs)
+        cdef TACSBVec **v = <TACSBVec**>malloc(nvecs*sizeof(TACSBVec*))
+        for i in range(nvecs):
+            v[i] = (<Vec>vecs[i]).getBVecPtr()
+        self.ptr.addReducedBasisVectors(nvecs, v)
+        free(v)
+
+    def getReducedBasisSize(self):
+        return self.ptr.getReducedBasisSize()
+
+    def isReducedSolution(self):
+        """
+        Check whether the last solution was computed with the reduced basis
+        """
+        return self.ptr.isReducedSolution() != 0
+
     def solve(self, print_flag=True, int freq=10, int print_level=0):
         """
         Solve the natural frequency problem
@@ -3248,30 +4820,273 @@ cdef class FrequencyAnalysis:
 
     def evalEigenXptSens(self, int index, Vec xptsens):
         """
-        Compute the derivative of the eigenvalues w.r.t. the nodal coordinates
+        Compute the derivative of the eigenvalues w.r.t. the nodal coordinates
+
+        The original eigenvalue problem is,
+
+        K*u = lambda*M*u
+
+        The derivative of the eigenvalue problem is given as follows,
+
+         dK/dx*u + K*du/dx =
+        d(lambda)/dx*M*u + lambda*dM/dx*u + lambda*M*du/dx
+
+        Since M = M^{T} and K = K^{T}, pre-multiplying by u^{T} gives,
+
+         u^{T}*dK/dx*u = d(lambda)/dx*(u^{T}*M*u) + lambda*u^{T}*dM/dx*u
+
+        Rearranging gives,
+
+        (u^{T}*M*u)*d(lambda)/dx = u^{T}*(dK/dx - lambda*dM/dx)*u
+
+        Args:
+            index (int): The index of the desired eigenvalue
+            xptsens (Vec): The vector in which the nodal sensitivity will be stored
+        """
+        self.ptr.evalEigenXptSens(index, xptsens.getBVecPtr())
+
+    def evalEigenDVSensMulti(self, indices, veclist):
+        """
+        Compute the derivatives of several eigenvalues w.r.t. the design
+        variables. This is equivalent to calling evalEigenDVSens for each
+        mode, but evaluates the contributions from all the modes in a single
+        pass over the elements.
+
+        Args:
+            indices (list[int]): The indices of the desired eigenvalues
+            veclist (list[Vec]): The vectors in which the sensitivities will be stored
+        """
+        cdef int num_modes = 0
+        cdef int *modes = NULL
+        cdef TACSBVec **vecs = NULL
+
+        if len(indices) != len(veclist):
+            errmsg = 'Mode index and vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        num_modes = len(indices)
+        modes = <int*>malloc(num_modes*sizeof(int))
+        vecs = <TACSBVec**>malloc(num_modes*sizeof(TACSBVec*))
+        for i in range(num_modes):
+            modes[i] = indices[i]
+            vecs[i] = (<Vec>veclist[i]).getBVecPtr()
+
+        self.ptr.evalEigenDVSensMulti(num_modes, modes, vecs)
+
+        free(modes)
+        free(vecs)
+
+        return
+
+    def evalEigenXptSensMulti(self, indices, veclist):
+        """
+        Compute the derivatives of several eigenvalues w.r.t. the nodal
+        coordinates. This is equivalent to calling evalEigenXptSens for each
+        mode, but evaluates the contributions from all the modes in a single
+        pass over the elements.
+
+        Args:
+            indices (list[int]): The indices of the desired eigenvalues
+            veclist (list[Vec]): The vectors in which the sensitivities will be stored
+        """
+        cdef int num_modes = 0
+        cdef int *modes = NULL
+        cdef TACSBVec **vecs = NULL
+
+        if len(indices) != len(veclist):
+            errmsg = 'Mode index and vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        num_modes = len(indices)
+        modes = <int*>malloc(num_modes*sizeof(int))
+        vecs = <TACSBVec**>malloc(num_modes*sizeof(TACSBVec*))
+        for i in range(num_modes):
+            modes[i] = indices[i]
+            vecs[i] = (<Vec>veclist[i]).getBVecPtr()
+
+        self.ptr.evalEigenXptSensMulti(num_modes, modes, vecs)
+
+        free(modes)
+        free(vecs)
+
+        return
+
+cdef class HarmonicAnalysis:
+    """
+    Steady-state response to a harmonic load at many frequencies.
+
+    The stiffness and mass matrices are assembled once and reused for
+    all frequencies. The response is computed by modal superposition
+    when modes are set from a frequency analysis, otherwise by a direct
+    solution at each frequency.
+
+    Args:
+        assembler (Assembler): The assembler object
+        gmres_iters (int, optional): The GMRES subspace size for the direct path
+        nrestart (int, optional): The number of GMRES restarts
+    """
+    cdef TACSHarmonicAnalysis *ptr
+    cdef object assembler
+    def __cinit__(self, Assembler assembler, int gmres_iters=20,
+                  int nrestart=2):
+        self.assembler = assembler
+        self.ptr = new TACSHarmonicAnalysis(assembler.ptr, gmres_iters,
+                                            nrestart)
+        self.ptr.incref()
+        return
+
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
+
+    def setRayleighDamping(self, double alpha, double beta):
+        """Set the damping matrix C = alpha*M + beta*K"""
+        self.ptr.setRayleighDamping(alpha, beta)
+        return
+
+    def setModalDamping(self, double zeta):
+        """Set an additional modal damping ratio for the modal path"""
+        self.ptr.setModalDamping(zeta)
+        return
+
+    def setTolerances(self, double rtol, double atol):
+        self.ptr.setTolerances(rtol, atol)
+        return
+
+    def setMonitor(self, MPI.Comm comm, _descript='Harmonic', int freq=1):
+        cdef char *descript = convert_to_chars(_descript)
+        self.ptr.setMonitor(new KSMPrintStdout(descript, comm.rank, freq))
+        return
+
+    def assembleMatrices(self):
+        """Assemble the stiffness and mass matrices at the current design"""
+        self.ptr.assembleMatrices()
+        return
+
+    def setModes(self, FrequencyAnalysis freq, int num_modes):
+        """Use the modes of a solved frequency analysis for the modal path"""
+        self.ptr.setModes(freq.ptr, num_modes)
+        return
+
+    def clearModes(self):
+        """Remove the modes so that the direct path is used"""
+        self.ptr.clearModes()
+        return
+
+    def getNumModes(self):
+        return self.ptr.getNumModes()
+
+    def getNumIterations(self):
+        return self.ptr.getNumIterations()
+
+    def solve(self, freqs, Vec force):
+        """
+        Compute the response at each angular frequency.
+
+        Returns:
+            tuple: The lists of the real and imaginary parts of the
+            response, and the number of frequencies where the direct
+            path failed to converge
+        """
+        cdef np.ndarray[double, ndim=1] omega = np.array(freqs, dtype=np.double).flatten()
+        cdef int num_freqs = omega.shape[0]
+        cdef int fail = 0
+        cdef TACSBVec **ur_ptr = NULL
+        cdef TACSBVec **ui_ptr = NULL
+        ur = [self.assembler.createVec() for i in range(num_freqs)]
+        ui = [self.assembler.createVec() for i in range(num_freqs)]
+        ur_ptr = <TACSBVec**>malloc(num_freqs*sizeof(TACSBVec*))
+        ui_ptr = <TACSBVec**>malloc(num_freqs*sizeof(TACSBVec*))
+        for i in range(num_freqs):
+            ur_ptr[i] = (<Vec>ur[i]).getBVecPtr()
+            ui_ptr[i] = (<Vec>ui[i]).getBVecPtr()
+        fail = self.ptr.solve(num_freqs, <double*>omega.data,
+                              force.getBVecPtr(), ur_ptr, ui_ptr)
+        free(ur_ptr)
+        free(ui_ptr)
+        return ur, ui, fail
+
+cdef class RandomVibration:
+    """
+    Stationary response to a random load using the modes of a frequency
+    analysis.
 
-        The original eigenvalue problem is,
+    The covariance of the modal coordinates is integrated from the power
+    spectral density of the load amplitude, so that the RMS values of
+    the response require no solutions at each frequency.
 
-        K*u = lambda*M*u
+    Args:
+        assembler (Assembler): The assembler object
+    """
+    def __cinit__(self, Assembler assembler):
+        self.assembler = assembler
+        self.ptr = new TACSRandomVibration(assembler.ptr)
+        self.ptr.incref()
+        return
 
-        The derivative of the eigenvalue problem is given as follows,
+    def __dealloc__(self):
+        self.ptr.decref()
+        return
 
-         dK/dx*u + K*du/dx =
-        d(lambda)/dx*M*u + lambda*dM/dx*u + lambda*M*du/dx
+    def setModes(self, FrequencyAnalysis freq, int num_modes):
+        """Use the mass-normalized modes of a solved frequency analysis"""
+        self.ptr.setModes(freq.ptr, num_modes)
+        return
 
-        Since M = M^{T} and K = K^{T}, pre-multiplying by u^{T} gives,
+    def setModalDamping(self, double zeta):
+        """Set the modal damping ratio applied to all modes"""
+        self.ptr.setModalDamping(zeta)
+        return
 
-         u^{T}*dK/dx*u = d(lambda)/dx*(u^{T}*M*u) + lambda*u^{T}*dM/dx*u
+    def setLoadPSD(self, Vec force, freqs, psd):
+        """
+        Set the spatial distribution of the load and the one-sided power
+        spectral density of its amplitude at increasing angular frequencies
+        """
+        cdef np.ndarray[double, ndim=1] omega = np.array(freqs, dtype=np.double).flatten()
+        cdef np.ndarray[double, ndim=1] S = np.array(psd, dtype=np.double).flatten()
+        if omega.shape[0] != S.shape[0]:
+            errmsg = 'Frequency and spectral density lengths must match'
+            raise ValueError(errmsg)
+        self.ptr.setLoadPSD(force.getBVecPtr(), omega.shape[0],
+                            <double*>omega.data, <double*>S.data)
+        return
 
-        Rearranging gives,
+    def computeCovariance(self):
+        """Compute the covariance of the modal coordinates"""
+        self.ptr.computeCovariance()
+        return
 
-        (u^{T}*M*u)*d(lambda)/dx = u^{T}*(dK/dx - lambda*dM/dx)*u
+    def getNumModes(self):
+        return self.ptr.getNumModes()
 
-        Args:
-            index (int): The index of the desired eigenvalue
-            xptsens (Vec): The vector in which the nodal sensitivity will be stored
+    def getCovariance(self):
+        """Get a copy of the covariance of the modal coordinates"""
+        cdef int n = self.ptr.getNumModes()
+        cdef const TacsScalar *cov = self.ptr.getCovariance()
+        Q = np.zeros((n, n), dtype=dtype)
+        if cov != NULL:
+            for i in range(n):
+                for j in range(n):
+                    Q[i, j] = cov[n*i + j]
+        return Q
+
+    def getRMSOutputData(self, ElementType elem_type, int write_flag):
         """
-        self.ptr.evalEigenXptSens(index, xptsens.getBVecPtr())
+        Compute the RMS values of the element output data. Only the
+        displacements, strains and stresses are computed.
+        """
+        cdef int length = 0
+        cdef int nvals = 0
+        cdef TacsScalar *data = NULL
+        self.ptr.getRMSOutputData(elem_type, write_flag, &length, &nvals, &data)
+        rms = np.zeros((length, nvals), dtype=dtype)
+        for i in range(length):
+            for j in range(nvals):
+                rms[i, j] = data[nvals*i + j]
+        if data != NULL:
+            deleteArray(data)
+        return rms
 
 cdef class BucklingAnalysis:
     cdef TACSLinearBuckling *ptr
@@ -3282,8 +5097,14 @@ cdef class BucklingAnalysis:
         cdef TACSMat *aux_mat
         solver.ptr.getOperators(&aux_mat, NULL)
 
+        # Compute the geometric stiffness products matrix-free if no
+        # matrix is provided
+        cdef TACSMat *gmat = NULL
+        if G is not None:
+            gmat = G.ptr
+
         # Create the linear buckling class
-        self.ptr = new TACSLinearBuckling(assembler.ptr, sigma, G.ptr,
+        self.ptr = new TACSLinearBuckling(assembler.ptr, sigma, gmat,
                                           K.ptr, aux_mat, solver.ptr, max_lanczos,
                                           num_eigs, eig_tol)
         self.ptr.incref()
@@ -3299,6 +5120,49 @@ cdef class BucklingAnalysis:
     def setSigma(self, TacsScalar sigma):
         self.ptr.setSigma(sigma)
 
+    def setBlockLanczos(self, int block_size, int max_restarts=25):
+        """
+        Use the thick-restart block Lanczos eigensolver.
+
+        The block of vectors is applied with multi-vector shift-invert
+        solves and orthogonalized with level-3 BLAS. The max_lanczos
+        argument then bounds the size of the basis, and at most
+        max_lanczos - 2*block_size eigenvalues can be computed.
+
+        Args:
+            block_size (int): The block size (0 uses single-vector Lanczos)
+            max_restarts (int): The maximum number of restarts
+        """
+        self.ptr.setBlockLanczos(block_size, max_restarts)
+
+    def setWarmStart(self, warm_start=True):
+        """
+        Warm-start the eigensolver with the eigenvectors from the previous
+        solve and track the modes between solves.
+
+        The new eigenvectors are matched with the saved eigenvectors using
+        the modal assurance criterion (MAC).
+
+        Args:
+            warm_start (bool): Flag to set or remove the warm start
+        """
+        self.ptr.setWarmStart(int(warm_start))
+
+    def getTrackedMode(self, int n):
+        """
+        Get the index of the current mode that matches the n-th mode from
+        the first solve after the warm start was set.
+
+        Args:
+            n (int): The index of the mode from the first solve
+
+        Returns:
+            int, float: The index of the current mode and the MAC value
+        """
+        cdef TacsScalar mac = 0.0
+        cdef int mode = self.ptr.getTrackedMode(n, &mac)
+        return mode, mac
+
     def solve(self, Vec force=None, Vec path=None, print_flag=True, int freq=10):
         cdef TACSBVec *f = NULL
         cdef TACSBVec *u0 = NULL
@@ -3453,6 +5317,140 @@ cdef class BucklingAnalysis:
         """
         self.ptr.evalEigenSVSens(index, svsens.getBVecPtr())
 
+    def evalEigenDVSensMulti(self, indices, veclist):
+        """
+        Compute the derivatives of several eigenvalues w.r.t. the design
+        variables. This is equivalent to calling evalEigenDVSens for each
+        mode, but evaluates the contributions from all the modes in a single
+        pass over the elements.
+
+        Args:
+            indices (list[int]): The indices of the desired eigenvalues
+            veclist (list[Vec]): The vectors in which the sensitivities will be stored
+        """
+        cdef int num_modes = 0
+        cdef int *modes = NULL
+        cdef TACSBVec **vecs = NULL
+
+        if len(indices) != len(veclist):
+            errmsg = 'Mode index and vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        num_modes = len(indices)
+        modes = <int*>malloc(num_modes*sizeof(int))
+        vecs = <TACSBVec**>malloc(num_modes*sizeof(TACSBVec*))
+        for i in range(num_modes):
+            modes[i] = indices[i]
+            vecs[i] = (<Vec>veclist[i]).getBVecPtr()
+
+        self.ptr.evalEigenDVSensMulti(num_modes, modes, vecs)
+
+        free(modes)
+        free(vecs)
+
+        return
+
+    def evalEigenXptSensMulti(self, indices, veclist):
+        """
+        Compute the derivatives of several eigenvalues w.r.t. the nodal
+        coordinates. This is equivalent to calling evalEigenXptSens for each
+        mode, but evaluates the contributions from all the modes in a single
+        pass over the elements.
+
+        Args:
+            indices (list[int]): The indices of the desired eigenvalues
+            veclist (list[Vec]): The vectors in which the sensitivities will be stored
+        """
+        cdef int num_modes = 0
+        cdef int *modes = NULL
+        cdef TACSBVec **vecs = NULL
+
+        if len(indices) != len(veclist):
+            errmsg = 'Mode index and vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        num_modes = len(indices)
+        modes = <int*>malloc(num_modes*sizeof(int))
+        vecs = <TACSBVec**>malloc(num_modes*sizeof(TACSBVec*))
+        for i in range(num_modes):
+            modes[i] = indices[i]
+            vecs[i] = (<Vec>veclist[i]).getBVecPtr()
+
+        self.ptr.evalEigenXptSensMulti(num_modes, modes, vecs)
+
+        free(modes)
+        free(vecs)
+
+        return
+
+    def addEigenDVSensMulti(self, TacsScalar scale, indices, veclist):
+        """
+        Add the partial derivatives of several eigenvalues w.r.t. the design
+        variables. This is equivalent to calling addEigenDVSens for each
+        mode, but evaluates the contributions from all the modes in a single
+        pass over the elements.
+
+        Args:
+            scale (float): The scalar that multiplies each derivative
+            indices (list[int]): The indices of the desired eigenvalues
+            veclist (list[Vec]): The vectors in which the sensitivities will be added
+        """
+        cdef int num_modes = 0
+        cdef int *modes = NULL
+        cdef TACSBVec **vecs = NULL
+
+        if len(indices) != len(veclist):
+            errmsg = 'Mode index and vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        num_modes = len(indices)
+        modes = <int*>malloc(num_modes*sizeof(int))
+        vecs = <TACSBVec**>malloc(num_modes*sizeof(TACSBVec*))
+        for i in range(num_modes):
+            modes[i] = indices[i]
+            vecs[i] = (<Vec>veclist[i]).getBVecPtr()
+
+        self.ptr.addEigenDVSensMulti(scale, num_modes, modes, vecs)
+
+        free(modes)
+        free(vecs)
+
+        return
+
+    def addEigenXptSensMulti(self, TacsScalar scale, indices, veclist):
+        """
+        Add the partial derivatives of several eigenvalues w.r.t. the nodal
+        coordinates. This is equivalent to calling addEigenXptSens for each
+        mode, but evaluates the contributions from all the modes in a single
+        pass over the elements.
+
+        Args:
+            scale (float): The scalar that multiplies each derivative
+            indices (list[int]): The indices of the desired eigenvalues
+            veclist (list[Vec]): The vectors in which the sensitivities will be added
+        """
+        cdef int num_modes = 0
+        cdef int *modes = NULL
+        cdef TACSBVec **vecs = NULL
+
+        if len(indices) != len(veclist):
+            errmsg = 'Mode index and vector list lengths must be equal'
+            raise ValueError(errmsg)
+
+        num_modes = len(indices)
+        modes = <int*>malloc(num_modes*sizeof(int))
+        vecs = <TACSBVec**>malloc(num_modes*sizeof(TACSBVec*))
+        for i in range(num_modes):
+            modes[i] = indices[i]
+            vecs[i] = (<Vec>veclist[i]).getBVecPtr()
+
+        self.ptr.addEigenXptSensMulti(scale, num_modes, modes, vecs)
+
+        free(modes)
+        free(vecs)
+
+        return
+
 # A generic abstract class for all integrators implemented in TACS
 cdef class Integrator:
     """
@@ -3521,6 +5519,71 @@ cdef class Integrator:
         self.ptr.setJacAssemblyFreq(freq)
         return
 
+    def setJacobianReuse(self, int reuse, double rate_tol=0.5,
+                         int max_ksm_iters=0):
+        """
+        setJacobianReuse(self, int reuse, double rate_tol=0.5,
+                         int max_ksm_iters=0)
+
+        Re-use the factored Jacobian across Newton iterations and time
+        steps. The Jacobian is refactored when the ratio of successive
+        residual norms exceeds rate_tol, or when the Krylov method takes
+        more than max_ksm_iters iterations (if positive).
+        """
+        self.ptr.setJacobianReuse(reuse, rate_tol, max_ksm_iters)
+        return
+
+    def getJacobianReuseStatistics(self):
+        """
+        getJacobianReuseStatistics(self)
+
+        Get the number of Jacobian factorizations and the number of
+        Newton iterations that re-used a factorization
+        """
+        cdef int num_factor = 0
+        cdef int num_reuse = 0
+        self.ptr.getJacobianReuseStatistics(&num_factor, &num_reuse)
+        return num_factor, num_reuse
+
+    def setAndersonAcceleration(self, int depth):
+        """
+        setAndersonAcceleration(self, int depth)
+
+        Accelerate the Newton updates computed with the same factored
+        Jacobian using the previous depth updates. Most effective with
+        setJacobianReuse(). A depth of zero turns off the acceleration.
+        """
+        self.ptr.setAndersonAcceleration(depth)
+        return
+
+    def setEisenstatWalker(self, int flag, double eta_max=0.5,
+                           double gamma=0.9, double alpha=2.0):
+        """
+        setEisenstatWalker(self, int flag, double eta_max=0.5,
+                           double gamma=0.9, double alpha=2.0)
+
+        Set the relative tolerance of the Krylov method from the
+        Eisenstat-Walker forcing term gamma*(|R_k|/|R_{k-1}|)^alpha,
+        bounded above by eta_max.
+        """
+        self.ptr.setEisenstatWalker(flag, eta_max, gamma, alpha)
+        return
+
+    def setTelemetryMonitor(self, MPI.Comm comm, fname, descript='Newton'):
+        """
+        setTelemetryMonitor(self, MPI.Comm comm, fname, descript='Newton')
+
+        Write the residual, assembly, factorization and solve times and
+        the Krylov iteration counts for each Newton iteration, and the
+        performance of each Krylov iteration, to a file as JSON lines.
+        Only the root processor writes the file.
+        """
+        cdef char *filename = convert_to_chars(fname)
+        cdef char *_descript = convert_to_chars(descript)
+        self.ptr.setNewtonMonitor(new KSMPrintTelemetry(filename, _descript,
+                                                        comm.rank))
+        return
+
     def setUseLapack(self, use_lapack):
         """
         setUseLapack(self, use_lapack)
@@ -3570,6 +5633,82 @@ cdef class Integrator:
         self.ptr.setTimeInterval(tinit, tfinal)
         return
 
+    def setCheckpoints(self, int num_checkpoints):
+        """
+        setCheckpoints(self, int num_checkpoints)
+
+        Store the states only at the given number of checkpoints and
+        recompute the remaining states during the adjoint. This must be
+        called before integrate(). Zero stores the states at all steps.
+        """
+        self.ptr.setCheckpoints(num_checkpoints)
+        return
+
+    def getNumRecomputedSteps(self):
+        """
+        getNumRecomputedSteps(self)
+
+        Get the number of time steps recomputed during the last adjoint
+        """
+        return self.ptr.getNumRecomputedSteps()
+
+    def setAdaptiveTimeStepping(self, double rtol, double atol, double h_init,
+                                double h_min=0.0, double h_max=0.0):
+        """
+        setAdaptiveTimeStepping(self, double rtol, double atol, double h_init,
+                                double h_min=0.0, double h_max=0.0)
+
+        Select the time steps adaptively so that the weighted RMS norm of
+        the local error estimate is less than one. The number of steps
+        passed to the constructor is the maximum number of steps.
+        """
+        self.ptr.setAdaptiveTimeStepping(rtol, atol, h_init, h_min, h_max)
+        return
+
+    def getNumRejectedSteps(self):
+        """
+        getNumRejectedSteps(self)
+
+        Get the number of rejected time steps during the last integration
+        """
+        return self.ptr.getNumRejectedSteps()
+
+    def setRestartOutput(self, fname, int restart_freq=1):
+        """
+        setRestartOutput(self, fname, int restart_freq=1)
+
+        Write a restart file every restart_freq time steps during
+        integrate(). The file is overwritten each time it is written.
+        """
+        cdef char *filename = convert_to_chars(fname)
+        self.ptr.setRestartOutput(filename, restart_freq)
+        return
+
+    def writeRestart(self, fname, int step_num):
+        """
+        writeRestart(self, fname, int step_num)
+
+        Write the states, design variables, node locations and solver
+        settings required to resume the integration after step_num
+        """
+        cdef char *filename = convert_to_chars(fname)
+        return self.ptr.writeRestart(filename, step_num)
+
+    def readRestart(self, fname):
+        """
+        readRestart(self, fname)
+
+        Read a restart file so that the next call to integrate() resumes
+        after the stored time step. The file must be read with the same
+        number of processors. Returns the stored time step.
+        """
+        cdef char *filename = convert_to_chars(fname)
+        cdef int step_num = 0
+        fail = self.ptr.readRestart(filename, &step_num)
+        if fail:
+            raise RuntimeError("Failed to read the restart file %s" % (fname))
+        return step_num
+
     def setFunctions(self, list funcs,
                      int start_plane=-1, int end_plane=-1):
         """
@@ -3615,6 +5754,24 @@ cdef class Integrator:
                                           <TacsScalar*>modes.data)
         return eigvals, modes
 
+    def naturalFrequencies(self, Vec q, Vec qdot, Vec qddot, int num_freqs,
+                           double sigma=0.0, int max_arnoldi=100):
+        """
+        naturalFrequencies(self, Vec q, Vec qdot, Vec qddot, int num_freqs,
+                           double sigma=0.0, int max_arnoldi=100)
+
+        Compute the natural frequencies in rad/s linearized about the
+        given state, including the gyroscopic and damping terms, using the
+        sparse shift-invert Arnoldi method
+        """
+        cdef np.ndarray freqs = np.zeros(num_freqs, dtype=dtype)
+        cdef int n = 0
+        n = self.ptr.naturalFrequencies(q.getBVecPtr(), qdot.getBVecPtr(),
+                                        qddot.getBVecPtr(), num_freqs,
+                                        <TacsScalar*>freqs.data, sigma,
+                                        max_arnoldi)
+        return freqs[:n]
+
     def iterate(self, int step_num, Vec forces=None):
         """
         iterate(self, int step_num, Vec forces=None)
@@ -3785,6 +5942,25 @@ cdef class Integrator:
         self.ptr.setFH5(f5.ptr)
         return
 
+    def setTimeHistory(self, TimeHistory history, int history_freq=1):
+        """
+        setTimeHistory(self, TimeHistory history, int history_freq=1)
+
+        Record the probe nodes and functions every history_freq time steps
+        """
+        self.ptr.setTimeHistory(history.ptr, history_freq)
+        return
+
+    def setPipelinedAdjoint(self, int flag):
+        """
+        setPipelinedAdjoint(self, int flag)
+
+        Overlap the total derivative contributions with the adjoint solves
+        on the thread pool
+        """
+        self.ptr.setPipelinedAdjoint(flag)
+        return
+
     def getNumTimeSteps(self):
         """
         getNumTimeSteps(self)
@@ -3870,6 +6046,47 @@ cdef class BDFIntegrator(Integrator):
         self.ptr.incref()
         return
 
+    def buildReducedOrderModel(self, int max_basis_size, double energy_tol=1e-6,
+                               double sample_tol=1e-3, int max_samples=0,
+                               int max_train=10):
+        """
+        Build a reduced-order model from the states of the last integration
+        and use it for the subsequent integrations
+        """
+        cdef TACSReducedOrderModel *rom = NULL
+        rom = (<TACSBDFIntegrator*>self.ptr).buildReducedOrderModel(
+            max_basis_size, energy_tol, sample_tol, max_samples, max_train)
+        if rom == NULL:
+            return None
+        model = ReducedOrderModel()
+        model.ptr = rom
+        model.ptr.incref()
+        return model
+
+    def setReducedOrderModel(self, ReducedOrderModel rom=None,
+                             double rom_tol=0.1, int rom_check_freq=1):
+        """
+        Set the reduced-order model used until the error indicator trips
+        (None to use the full model)
+        """
+        cdef TACSReducedOrderModel *rom_ptr = NULL
+        if rom is not None:
+            rom_ptr = rom.ptr
+        (<TACSBDFIntegrator*>self.ptr).setReducedOrderModel(
+            rom_ptr, rom_tol, rom_check_freq)
+        return
+
+    def getReducedOrderStatistics(self):
+        """
+        Get the number of steps taken with the reduced-order model and the
+        step where the error indicator tripped (-1 if it did not trip)
+        """
+        cdef int num_rom_steps = 0
+        cdef int rom_trip_step = -1
+        (<TACSBDFIntegrator*>self.ptr).getReducedOrderStatistics(
+            &num_rom_steps, &rom_trip_step)
+        return num_rom_steps, rom_trip_step
+
 cdef class DIRKIntegrator(Integrator):
     """
     Diagonally-Implicit-Runge-Kutta integration class. This supports
@@ -3954,6 +6171,46 @@ cdef class ESDIRKIntegrator(Integrator):
         time = esdirk.getStageStates(step_num, stage_num, &cq, &cqdot, &cqddot)
         return time, _init_Vec(cq), _init_Vec(cqdot), _init_Vec(cqddot)
 
+cdef class CentralDifferenceIntegrator(Integrator):
+    """
+    Explicit central-difference method for integration with a lumped
+    mass matrix. Each step requires only a residual assembly. The
+    intervals between the stored time steps are divided into sub-steps
+    based on the stable time step estimated from the element
+    eigenvalues. The adjoint is not implemented.
+    """
+    def __cinit__(self, Assembler tacs,
+                  double tinit, double tfinal,
+                  double num_steps):
+        self.ptr = new TACSCentralDifferenceIntegrator(tacs.ptr, tinit, tfinal,
+                                                       num_steps)
+        self.ptr.incref()
+        return
+
+    def setStableTimeStepFactor(self, double factor):
+        """
+        Set the fraction of the estimated stable time step that is used
+        """
+        cdef TACSCentralDifferenceIntegrator *cd = NULL
+        cd = <TACSCentralDifferenceIntegrator*> self.ptr
+        cd.setStableTimeStepFactor(factor)
+
+    def getStableTimeStep(self):
+        """
+        Get the stable time step used for the last time step
+        """
+        cdef TACSCentralDifferenceIntegrator *cd = NULL
+        cd = <TACSCentralDifferenceIntegrator*> self.ptr
+        return cd.getStableTimeStep()
+
+    def getNumSubSteps(self):
+        """
+        Get the total number of sub-steps taken
+        """
+        cdef TACSCentralDifferenceIntegrator *cd = NULL
+        cd = <TACSCentralDifferenceIntegrator*> self.ptr
+        return cd.getNumSubSteps()
+
 cdef class ABMIntegrator(Integrator):
     """
     Adams-Bashforth-Moulton method for integration. This currently
@@ -4061,10 +6318,24 @@ cdef class LinearSpectralMg(Pc):
         """
         self.ptr.factor()
 
+cdef class LinearSpectralDiagPc(Pc):
+    def __init__(self, LinearSpectralMat mat):
+        """
+        Create a preconditioner for linear spectral analysis based on the
+        diagonalization of the derivative operator in time. The modes are
+        solved concurrently when the time states are distributed.
+
+        Args:
+            mat (LinearSpectralMat): The matrix for the linear spectral system
+        """
+        self.ptr = new TACSLinearSpectralDiagPc(mat.mat_ptr)
+        self.ptr.incref()
+        return
+
 cdef class SpectralIntegrator:
     cdef TACSSpectralIntegrator *ptr
 
-    def __init__(self, Assembler assembler, tfinal, N):
+    def __init__(self, Assembler assembler, tfinal, N, MPI.Comm comm=None):
         """
         Create the spectral integrator class
 
@@ -4072,9 +6343,14 @@ cdef class SpectralIntegrator:
             assembler (Assembler): The TACS Assembler object
             tfinal (float): The final time
             N (int): Number of time states = number of LGL points - 1
+            comm (MPI.Comm): Communicator containing all groups of processors
+                when the time states are distributed
         """
+        cdef MPI_Comm c_comm = MPI_COMM_NULL
+        if comm is not None:
+            c_comm = comm.ob_mpi
 
-        self.ptr = new TACSSpectralIntegrator(assembler.ptr, tfinal, N)
+        self.ptr = new TACSSpectralIntegrator(assembler.ptr, tfinal, N, c_comm)
         self.ptr.incref()
 
     def __dealloc__(self):
@@ -4246,3 +6522,157 @@ cdef class SpectralIntegrator:
         """
         self.ptr.computeSolutionAndDeriv(t, NULL, u.getBVecPtr(), NULL)
         return
+
+def setProfilingEnabled(flag=True):
+    """
+    setProfilingEnabled(flag=True)
+
+    Turn the hierarchical profiler on or off. Profiling can also be
+    enabled by setting the environment variable TACS_PROFILE.
+    """
+    TACSProfilerSetEnabled(int(flag))
+    return
+
+def isProfilingEnabled():
+    """
+    isProfilingEnabled()
+
+    Return True if the hierarchical profiler is recording
+    """
+    return TACSProfilerIsEnabled() != 0
+
+def resetProfile():
+    """
+    resetProfile()
+
+    Discard the timing data recorded so far by the profiler
+    """
+    TACSProfilerReset()
+    return
+
+def writeProfile(fname, MPI.Comm comm=None):
+    """
+    writeProfile(fname, comm=None)
+
+    Write the recorded profile to a JSON file. If no communicator is
+    given, each process writes its own values. Otherwise, this call is
+    collective on comm and the root writes the minimum, maximum and
+    average values over all processes.
+    """
+    cdef char *filename = convert_to_chars(fname)
+    if comm is None:
+        return TACSProfilerWriteJSON(filename)
+    return TACSProfilerWriteSummaryJSON(comm.ob_mpi, filename)
+
+def getMemoryUsage():
+    """
+    getMemoryUsage()
+
+    Return a dictionary with the current and peak bytes held by the
+    large TACS objects on this process. The keys are the subsystem
+    names and 'total', and each value is a (current, peak) tuple.
+    """
+    cdef bytes py_string
+    usage = {}
+    for k in range(-1, TACS_MEMORY_NUM_CATEGORIES):
+        py_string = TACSMemoryGetCategoryName(k)
+        name = convert_bytes_to_str(py_string)
+        usage[name] = (TACSMemoryGetCurrentBytes(k), TACSMemoryGetPeakBytes(k))
+    return usage
+
+def resetMemoryPeak():
+    """
+    resetMemoryPeak()
+
+    Reset the high-water marks to the current memory usage
+    """
+    TACSMemoryResetPeak()
+    return
+
+def printMemorySummary(MPI.Comm comm):
+    """
+    printMemorySummary(comm)
+
+    Print the current and peak memory for each subsystem with the
+    minimum, maximum and average over the processes. This call is
+    collective on comm.
+    """
+    TACSMemoryPrintSummary(comm.ob_mpi)
+    return
+
+def setCommProfilingEnabled(flag=True):
+    """
+    setCommProfilingEnabled(flag=True)
+
+    Turn the recording of the MPI messages on or off. The recording
+    can also be enabled by setting the environment variable
+    TACS_COMM_PROFILE.
+    """
+    TACSCommProfilerSetEnabled(int(flag))
+    return
+
+def resetCommProfile():
+    """
+    resetCommProfile()
+
+    Discard the message counts and wait times recorded so far
+    """
+    TACSCommProfilerReset()
+    return
+
+def printCommSummary(MPI.Comm comm):
+    """
+    printCommSummary(comm)
+
+    Print the messages, bytes, neighbors and wait time for the halo
+    exchange, matrix assembly, reductions and dense factorization with
+    the average and maximum over the processes. This call is
+    collective on comm.
+    """
+    TACSCommProfilerPrintSummary(comm.ob_mpi)
+    return
+
+def writeCommProfile(fname, MPI.Comm comm):
+    """
+    writeCommProfile(fname, comm)
+
+    Write the communication recorded on each process and for each of
+    its neighbors to a JSON file on the root. This call is collective
+    on comm.
+    """
+    cdef char *filename = convert_to_chars(fname)
+    return TACSCommProfilerWriteJSON(comm.ob_mpi, filename)
+
+def benchmarkAssembler(Assembler assembler, int nreps=5, fname=None):
+    """
+    benchmarkAssembler(assembler, nreps=5, fname=None)
+
+    Time the residual and Jacobian assembly, the exchange of the ghost
+    values, the matrix-vector product, the Schur complement
+    factorization and a GMRES solve for the assembler with the same
+    harness used by the C++ benchmark suite. The vector output is also
+    timed when a file name is given.
+
+    Each kernel is called once to warm up and then timed nreps times.
+    The result is a dictionary keyed by the kernel name whose values
+    are dictionaries with the minimum, average and maximum over the
+    processes of the fastest time on each process and the flops per
+    call. This call is collective on the communicator of the assembler.
+    """
+    cdef char *filename = NULL
+    cdef bytes py_string
+    cdef np.ndarray values = np.zeros(4*TACS_BENCH_NUM_KERNELS, dtype=np.double)
+    if fname is not None:
+        filename = convert_to_chars(fname)
+    TACSBenchmarkRunKernels(assembler.ptr, nreps, filename,
+                            <double*>values.data)
+
+    results = {}
+    for k in range(TACS_BENCH_NUM_KERNELS):
+        if fname is None and k == TACS_BENCH_VEC_WRITE:
+            continue
+        py_string = TACSBenchmarkGetKernelName(k)
+        name = convert_bytes_to_str(py_string)
+        results[name] = {'tmin': values[4*k], 'tavg': values[4*k+1],
+                         'tmax': values[4*k+2], 'flops': values[4*k+3]}
+    return results
@@ -15,6 +15,18 @@
 #ifndef TACS_ELEMENT_TEMPLATES_H
 #define TACS_ELEMENT_TEMPLATES_H
 
+/*
+  The legacy element templates from src/elements/direct
+
+  These templates depend on constitutive classes that are no longer
+  part of TACS and are not built. Models that use them should be
+  migrated to the equivalent TACSShellElement, TACSElement2D and
+  TACSElement3D objects, which use the batched element kernels, the
+  geometry cache and the tabulated basis functions. From python, the
+  names below are mapped to the equivalent elements with
+  tacs.legacy.createLegacyElement().
+*/
+
 #include "PlaneStressQuad.h"
 #include "PlaneStressTraction.h"
 #include "TACSShellTraction.h"
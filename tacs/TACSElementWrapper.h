@@ -22,6 +22,15 @@
   the underlying TACS constitutive objects. They are designed to use
   callbacks through the python layer.
 
+  Each call to addResidual() or addJacobian() crosses into python for
+  a single element. When the batched callbacks are set, the assembler
+  passes all consecutive elements that share the wrapper object in a
+  single call instead, with the data for the elements stored one after
+  another, see TACSElement::addResidualBatch(). The python layer can
+  then view the data as arrays with one row per element and evaluate
+  the whole batch with vectorized operations. The number of elements
+  in a batch is set with TACSAssembler::setElementBatchSize().
+
   Not much error checking is performed here, so beware.
 */
 
@@ -50,7 +59,8 @@ class TACSElementWrapper : public TACSElement {
     getinitconditions = NULL;
     addresidual = NULL;
     addjacobian = NULL;
-
+    addresidualbatch = NULL;
+    addjacobianbatch = NULL;
   }
   ~TACSElementWrapper() {
     Py_DECREF(self_ptr);
@@ -121,6 +131,48 @@ class TACSElementWrapper : public TACSElement {
                   alpha, beta, gamma, num_nodes, Xpts,
                   num_vars, vars, dvars, ddvars, res, mat);
     }
+    else if (self_ptr && addresidual){
+      // Use the default complex-step/finite-difference Jacobian
+      TACSElement::addJacobian(elem_index, time, alpha, beta, gamma,
+                               Xpts, vars, dvars, ddvars, res, mat);
+    }
+  }
+
+  // Compute the residuals for a batch of elements
+  // ---------------------------------------------
+  void addResidualBatch( int num_elems, const int elem_index[], double time,
+                         const TacsScalar Xpts[], const TacsScalar vars[],
+                         const TacsScalar dvars[], const TacsScalar ddvars[],
+                         TacsScalar res[] ){
+    if (self_ptr && addresidualbatch){
+      int num_vars = num_nodes*vars_per_node;
+      addresidualbatch(self_ptr, num_elems, elem_index, time, num_nodes, Xpts,
+                       num_vars, vars, dvars, ddvars, res);
+    }
+    else {
+      TACSElement::addResidualBatch(num_elems, elem_index, time, Xpts,
+                                    vars, dvars, ddvars, res);
+    }
+  }
+
+  // Compute the residuals and Jacobians for a batch of elements
+  // -----------------------------------------------------------
+  void addJacobianBatch( int num_elems, const int elem_index[], double time,
+                         TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+                         const TacsScalar Xpts[], const TacsScalar vars[],
+                         const TacsScalar dvars[], const TacsScalar ddvars[],
+                         TacsScalar res[], TacsScalar mat[] ){
+    if (self_ptr && addjacobianbatch){
+      int num_vars = num_nodes*vars_per_node;
+      addjacobianbatch(self_ptr, num_elems, elem_index, time,
+                       alpha, beta, gamma, num_nodes, Xpts,
+                       num_vars, vars, dvars, ddvars, res, mat);
+    }
+    else {
+      TACSElement::addJacobianBatch(num_elems, elem_index, time,
+                                    alpha, beta, gamma, Xpts,
+                                    vars, dvars, ddvars, res, mat);
+    }
   }
 
   // Define the object name
@@ -142,6 +194,15 @@ class TACSElementWrapper : public TACSElement {
                       int, const TacsScalar*, int, const TacsScalar*,
                       const TacsScalar*, const TacsScalar*,
                       TacsScalar*, TacsScalar*);
+  void (*addresidualbatch)(void*, int, const int*, double, int,
+                           const TacsScalar*, int, const TacsScalar*,
+                           const TacsScalar*, const TacsScalar*,
+                           TacsScalar*);
+  void (*addjacobianbatch)(void*, int, const int*, double,
+                           TacsScalar, TacsScalar, TacsScalar,
+                           int, const TacsScalar*, int, const TacsScalar*,
+                           const TacsScalar*, const TacsScalar*,
+                           TacsScalar*, TacsScalar*);
 };
 
 #endif
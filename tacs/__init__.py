@@ -63,7 +63,8 @@ from . import caps2tacs
 from .pytacs import pyTACS
 from . import problems
 from . import constraints
+from . import legacy
 
 __all__.extend(
-    ["caps2tacs", "pytacs", "pyTACS", "problems", "constraints"]
+    ["caps2tacs", "pytacs", "pyTACS", "problems", "constraints", "legacy"]
 )
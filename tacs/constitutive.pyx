@@ -617,6 +617,32 @@ cdef class PhaseChangeMaterialConstitutive(Constitutive):
             self.cptr = NULL
             self.props = None
 
+    def setTransitionTable(self, int npts, double width=-1.0):
+        """
+        Tabulate the phase transition functions for faster evaluation.
+
+        Args:
+            npts (int): The number of table points (less than 2 removes the table).
+            width (float, optional): The half-width of the table about the melting
+                temperature. Defaults to a width based on dT.
+        """
+        if self.cptr:
+            self.cptr.setTransitionTable(npts, width)
+
+    def getPhaseFractionTempTol(self, double phase_tol):
+        """
+        Get the temperature change that changes the phase fraction by at most phase_tol.
+
+        Args:
+            phase_tol (float): The tolerance on the phase fraction.
+
+        Returns:
+            float or complex: The temperature tolerance.
+        """
+        if self.cptr:
+            return self.cptr.getPhaseFractionTempTol(phase_tol)
+        return 0.0
+
 cdef class SolidConstitutive(Constitutive):
     """
     This is the base class for the solid constitutive objects.
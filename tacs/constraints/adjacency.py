@@ -22,6 +22,7 @@ import os
 import numpy as np
 import scipy as sp
 
+import tacs.TACS
 from tacs.constraints.base import TACSConstraint, SparseLinearConstraint
 
 
@@ -201,65 +202,27 @@ class AdjacencyConstraint(TACSConstraint):
             Constraint object if successful, None otherwise.
 
         """
-        size = self.comm.size
-        rank = self.comm.rank
-        # Gather the dv mapping from each proc
-        globalToLocalDVNumsOnProc = self.comm.gather(self.globalToLocalDVNums, root=0)
-        # Assemble constraint info on root proc
-        if rank == 0:
-            # Create a list of lists that will hold the sparse data info on each proc
-            rowsOnProc = [[] for _ in range(size)]
-            colsOnProc = [[] for _ in range(size)]
-            valsOnProc = [[] for _ in range(size)]
-            conCount = 0
-            foundCompPairs = []
-            # Loop through all adjacent component pairs
-            for compPair in self.adjacentComps:
-                # Check if they are in the user provided compIDs
-                if compPair[0] in compIDs and compPair[1] in compIDs:
-                    # Add comp pair to list
-                    foundCompPairs.append(compPair)
-                    # We found a new constraint
-                    for i, comp in enumerate(compPair):
-                        # Get the TACS element object associated with this compID
-                        elemObj = self.meshLoader.getElementObject(comp, 0)
-                        elemIndex = 0
-                        # Get the dvs owned by this element
-                        globalDvNums = elemObj.getDesignVarNums(elemIndex)
-                        # Check if specified dv num is owned by each proc
-                        for proc_i in range(size):
-                            globalToLocalDVNums = globalToLocalDVNumsOnProc[proc_i]
-                            if globalDvNums[dvIndex] in globalToLocalDVNums:
-                                globalDVNum = globalDvNums[dvIndex]
-                                localDVNum = globalToLocalDVNums[globalDVNum]
-                                rowsOnProc[proc_i].append(conCount)
-                                colsOnProc[proc_i].append(localDVNum)
-                                if i == 0:
-                                    valsOnProc[proc_i].append(1.0)
-                                else:
-                                    valsOnProc[proc_i].append(-1.0)
-                                break
-                    conCount += 1
-
+        # Find the adjacent component pairs in the user provided compIDs
+        if self.comm.rank == 0:
+            compIDSet = set(compIDs)
+            foundCompPairs = [
+                compPair
+                for compPair in self.adjacentComps
+                if compPair[0] in compIDSet and compPair[1] in compIDSet
+            ]
         else:
-            rowsOnProc = None
-            colsOnProc = None
-            valsOnProc = None
-            conCount = 0
             foundCompPairs = None
-
-        # Scatter local sparse indices/values to remaining procs
-        rows = self.comm.scatter(rowsOnProc, root=0)
-        cols = self.comm.scatter(colsOnProc, root=0)
-        vals = self.comm.scatter(valsOnProc, root=0)
-
-        # Get local sparse matrix dimensions
         foundCompPairs = self.comm.bcast(foundCompPairs, root=0)
-        conCount = self.comm.bcast(conCount, root=0)
-        nLocalDVs = self.getNumDesignVars()
 
-        constrObj = SparseLinearConstraint(
-            self.comm, rows, cols, vals, conCount, nLocalDVs, lbound, ubound
+        # Build the sparse Jacobian for the local dvs in C++
+        linCon = tacs.TACS.LinearConstraint(self.assembler)
+        if len(foundCompPairs) > 0:
+            linCon.addAdjacencyConstraints(
+                np.array(foundCompPairs, dtype=np.intc), dvIndex
+            )
+
+        constrObj = SparseLinearConstraint.fromLinearConstraint(
+            self.comm, linCon, lbound, ubound
         )
         constrObj.compPairs = foundCompPairs
 
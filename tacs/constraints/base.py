@@ -270,8 +270,29 @@ class SparseLinearConstraint(object):
         self.A = sp.sparse.csr_matrix(
             (vals, (rows, cols)), shape=(nrows, ncols), dtype=self.dtype
         )
+        self._setup(comm, lb, ub)
+
+    @classmethod
+    def fromLinearConstraint(cls, comm, linCon, lb=-1e20, ub=1e20):
+        """
+        Create the constraint from the Jacobian built by a
+        TACS.LinearConstraint object, without copying its arrays.
+        """
+        obj = cls.__new__(cls)
+        rowp, cols, vals = linCon.getArrays()
+        obj.A = sp.sparse.csr_matrix(
+            (vals, cols, rowp),
+            shape=(linCon.getNumConstraints(), linCon.getNumDesignVars()),
+            copy=False,
+        )
+        # Keep the owner of the arrays
+        obj.linCon = linCon
+        obj._setup(comm, lb, ub)
+        return obj
+
+    def _setup(self, comm, lb, ub):
         # Number of constraints
-        self.nCon = nrows
+        self.nCon = self.A.shape[0]
         # MPI comm
         self.comm = comm
         # Save bound information
@@ -24,8 +24,10 @@ For applying constraints on design variables across components, see :class:`Adja
 # =============================================================================
 # Imports
 # =============================================================================
+import numpy as np
 import scipy as sp
 
+import tacs.TACS
 from tacs.constraints.base import TACSConstraint, SparseLinearConstraint
 
 
@@ -159,31 +161,17 @@ class DVConstraint(TACSConstraint):
             Constraint object if successful, None otherwise.
 
         """
-        # Assemble constraint info
-        conCount = 0
-        rows = []
-        cols = []
-        vals = []
-        for comp in compIDs:
-            # Get the TACS element object associated with this compID
-            elemObj = self.meshLoader.getElementObject(comp, 0)
-            elemIndex = 0
-            # Get the dvs owned by this element
-            globalDvNums = elemObj.getDesignVarNums(elemIndex)
-            # Check if each specified dv num is owned by this proc
-            for dvIndex, dvWeight in zip(dvIndices, dvWeights):
-                if globalDvNums[dvIndex] in self.globalToLocalDVNums:
-                    globalDVNum = globalDvNums[dvIndex]
-                    localDVNum = self.globalToLocalDVNums[globalDVNum]
-                    rows.append(conCount)
-                    cols.append(localDVNum)
-                    vals.append(dvWeight)
-            conCount += 1
-
-        nLocalDVs = self.getNumDesignVars()
-
-        return SparseLinearConstraint(
-            self.comm, rows, cols, vals, conCount, nLocalDVs, lbound, ubound
+        # Build the sparse Jacobian for the local dvs in C++
+        numDVs = min(len(dvIndices), len(dvWeights))
+        linCon = tacs.TACS.LinearConstraint(self.assembler)
+        linCon.addDVConstraints(
+            np.array(compIDs, dtype=np.intc),
+            np.array(dvIndices[:numDVs], dtype=np.intc),
+            np.array(dvWeights[:numDVs], dtype=self.dtype),
+        )
+
+        return SparseLinearConstraint.fromLinearConstraint(
+            self.comm, linCon, lbound, ubound
         )
 
     def evalConstraints(self, funcs, evalCons=None, ignoreMissing=False):
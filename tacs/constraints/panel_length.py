@@ -25,6 +25,7 @@ import scipy as sp
 # ==============================================================================
 # Extension modules
 # ==============================================================================
+import tacs.TACS
 from tacs.constraints.base import TACSConstraint
 
 
@@ -302,6 +303,13 @@ class PanelLengthConstraint(TACSConstraint):
         # Get the boundary node IDs for each component
         boundaryNodeIDs, boundaryNodeCoords = self._getComponentBoundaryNodes(compIDs)
 
+        # The boundary loops in terms of the assembler node numbers, which
+        # are used by the panel length kernel
+        ownerRange = self.assembler.getOwnerRange()
+        panelPtr = [0]
+        panelNodes = []
+        panelNodeProcs = []
+
         if self.rank == 0:
             constraintInd = 0
             for compID in compIDs:
@@ -345,6 +353,10 @@ class PanelLengthConstraint(TACSConstraint):
                 boundaryNodeGlobalInds.append(GlobalInds)
                 boundaryNodeLocalInds.append(LocalInds)
                 boundaryNodeLocalProcs.append(LocalProcs)
+                for localInd, proc in zip(LocalInds, LocalProcs):
+                    panelNodes.append(ownerRange[proc] + localInd)
+                    panelNodeProcs.append(proc)
+                panelPtr.append(len(panelNodes))
 
                 # Figure out the jacobian sparsity for each proc
                 # The DV jacobian on the proc that owns this component's DV
@@ -400,6 +412,21 @@ class PanelLengthConstraint(TACSConstraint):
             coordJacRows = None
             coordJacCols = None
 
+        # Set up the kernel that computes the panel lengths and their
+        # sensitivities from the assembler node vector
+        panelPtr, panelNodes, panelNodeProcs, refAxes = self.comm.bcast(
+            (panelPtr, panelNodes, panelNodeProcs, refAxes), root=0
+        )
+        self.constraintList[conName]["panelLength"] = tacs.TACS.PanelLength(
+            self.assembler,
+            np.array(panelPtr, dtype=np.intc),
+            np.array(panelNodes, dtype=np.intc),
+            np.array(refAxes, dtype=self.dtype).reshape(-1, 3),
+        )
+        self.constraintList[conName]["panelNodeProcs"] = np.array(
+            panelNodeProcs, dtype=np.intc
+        )
+
         # These constraints are linear w.r.t the DVs so we can just precompute
         # the DV jacobian for each proc
         dvJacRows = self.comm.scatter(dvJacRows, root=0)
@@ -517,12 +544,11 @@ class PanelLengthConstraint(TACSConstraint):
         # Otherwise, output them all
         evalCons = self._processEvalCons(evalCons, ignoreMissing)
 
-        # We will compute everything on the root proc and then broadcast the
-        # results, this is definitely not the most efficient way to do this
-        # so we may want to re-do it in future, but this works for now
+        # The panel lengths are computed in parallel from the node vector,
+        # the DV values are gathered on the root proc and the results are
+        # broadcast
 
         DVs = None
-        nodes = None
 
         # Loop through each requested constraint set
         for conName in evalCons:
@@ -532,34 +558,16 @@ class PanelLengthConstraint(TACSConstraint):
                 funcs[key] = np.copy(self.funcs[key])
             else:
                 constraintValues = np.zeros(nCon, dtype=self.dtype)
-                if nodes is None:
-                    # Get all of the DVs and nodes on the root proc
+                if DVs is None:
+                    # Get all of the DVs on the root proc
                     DVs = self.comm.gather(self.x.getArray(), root=0)
-                    nodes = self.comm.gather(self.Xpts.getArray(), root=0)
-                    if self.rank == 0:
-                        for ii in range(self.comm.size):
-                            nodes[ii] = nodes[ii].reshape(-1, 3)
+                panelLength = self.constraintList[conName]["panelLength"]
+                lengths = panelLength.evalLengths(self.Xpts)
                 if self.rank == 0:
                     for ii in range(nCon):
-                        numPoints = len(
-                            self.constraintList[conName]["boundaryNodeGlobalInds"][ii]
-                        )
-                        boundaryPoints = np.zeros((numPoints, 3), dtype=self.dtype)
-                        for jj in range(numPoints):
-                            nodeProc = self.constraintList[conName][
-                                "boundaryNodeLocalProcs"
-                            ][ii][jj]
-                            localInd = self.constraintList[conName][
-                                "boundaryNodeLocalInds"
-                            ][ii][jj]
-                            boundaryPoints[jj] = nodes[nodeProc][localInd]
-                        refAxis = self.constraintList[conName]["refAxes"][ii]
                         DVProc = self.constraintList[conName]["dvProcs"][ii]
                         DVLocalInd = self.constraintList[conName]["dvLocalInds"][ii]
-                        constraintValues[ii] = (
-                            self.computePanelLength(boundaryPoints, refAxis)
-                            - DVs[DVProc][DVLocalInd]
-                        )
+                        constraintValues[ii] = lengths[ii] - DVs[DVProc][DVLocalInd]
                 funcs[key] = self.comm.bcast(constraintValues, root=0)
                 self.funcs[key] = np.copy(funcs[key])
                 self.constraintsUpToDate[conName] = True
@@ -597,12 +605,6 @@ class PanelLengthConstraint(TACSConstraint):
         # Otherwise, output them all
         evalCons = self._processEvalCons(evalCons)
 
-        # We will compute everything on the root proc and then broadcast the results,
-        # this is definitely not the most efficient way to do this so we may want to
-        # re-do it in future, but this works for now
-
-        nodes = None
-
         # Get number of nodes coords on this proc
         nCoords = self.getNumCoordinates()
 
@@ -615,43 +617,13 @@ class PanelLengthConstraint(TACSConstraint):
             if self.constraintsSensUpToDate[conName]:
                 funcsSens[key][self.coordName] = self.funcsSens[key].copy()
             else:
-                # Get all of the nodes on the root proc
-                if nodes is None:
-                    nodes = self.comm.gather(self.Xpts.getArray(), root=0)
-                    if self.rank == 0:
-                        for ii in range(self.comm.size):
-                            nodes[ii] = nodes[ii].reshape(-1, 3)
-                funcsSens[key][self.coordName] = sp.sparse.csr_matrix(
-                    (nCon, nCoords), dtype=self.dtype
-                )
-                if self.rank == 0:
-                    coordJacVals = []
-                    for ii in range(self.comm.size):
-                        coordJacVals.append([])
-                    for ii in range(nCon):
-                        numPoints = len(
-                            self.constraintList[conName]["boundaryNodeGlobalInds"][ii]
-                        )
-                        boundaryPoints = np.zeros((numPoints, 3), dtype=self.dtype)
-
-                        for jj in range(numPoints):
-                            nodeProc = self.constraintList[conName][
-                                "boundaryNodeLocalProcs"
-                            ][ii][jj]
-                            localInd = self.constraintList[conName][
-                                "boundaryNodeLocalInds"
-                            ][ii][jj]
-                            boundaryPoints[jj] = nodes[nodeProc][localInd]
-                        refAxis = self.constraintList[conName]["refAxes"][ii]
-                        LSens = self.computePanelLengthSens(boundaryPoints, refAxis)
-                        for jj in range(numPoints):
-                            nodeProc = self.constraintList[conName][
-                                "boundaryNodeLocalProcs"
-                            ][ii][jj]
-                            coordJacVals[nodeProc] += LSens[jj].tolist()
-                else:
-                    coordJacVals = None
-                coordJacVals = self.comm.scatter(coordJacVals, root=0)
+                # Compute the sensitivities of all the panel lengths in
+                # parallel and keep the entries for the nodes on this proc,
+                # these are in the same order as the sparsity pattern
+                panelLength = self.constraintList[conName]["panelLength"]
+                _, LSens = panelLength.evalLengthSens(self.Xpts)
+                procs = self.constraintList[conName]["panelNodeProcs"]
+                coordJacVals = LSens.reshape(-1, 3)[procs == self.rank].flatten()
                 coordJacRows = self.constraintList[conName]["coordJacRows"]
                 coordJacCols = self.constraintList[conName]["coordJacCols"]
                 self.funcsSens[key] = sp.sparse.csr_matrix(
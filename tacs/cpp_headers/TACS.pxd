@@ -91,9 +91,12 @@ cdef extern from "TACSMaterialProperties.h":
 cdef extern from "":
     TACSSchurMat* _dynamicSchurMat "dynamic_cast<TACSSchurMat*>"(TACSMat*)
     TACSSchurPc* _dynamicSchurPc "dynamic_cast<TACSSchurPc*>"(TACSPc*)
+    TACSAdditiveSchwarz* _dynamicAdditiveSchwarz "dynamic_cast<TACSAdditiveSchwarz*>"(TACSPc*)
     TACSParallelMat* _dynamicParallelMat "dynamic_cast<TACSParallelMat*>"(TACSMat*)
     TACSMg* _dynamicTACSMg "dynamic_cast<TACSMg*>"(TACSPc*)
+    TACSAmg* _dynamicTACSAmg "dynamic_cast<TACSAmg*>"(TACSPc*)
     GMRES* _dynamicGMRES "dynamic_cast<GMRES*>"(TACSKsm*)
+    GCRODR* _dynamicGCRODR "dynamic_cast<GCRODR*>"(TACSKsm*)
     TACSBVec* _dynamicBVec "dynamic_cast<TACSBVec*>"(TACSVec*)
     TACSSpectralVec* _dynamicSpectralVec "dynamic_cast<TACSSpectralVec*>"(TACSVec*)
     void deleteArray "delete []"(void*)
@@ -122,6 +125,7 @@ cdef extern from "KSM.h":
         TACSVec *createVec()
         void zeroEntries()
         void mult(TACSVec *x, TACSVec *y)
+        void multTranspose(TACSVec *x, TACSVec *y)
         void copyValues(TACSMat *mat)
         void scale(TacsScalar alpha)
         void axpy(TacsScalar alpha, TACSMat *mat)
@@ -138,11 +142,15 @@ cdef extern from "KSM.h":
     cdef cppclass KSMPrintStdout(KSMPrint):
         KSMPrintStdout(char *descript, int rank, int freq)
 
+    cdef cppclass KSMPrintTelemetry(KSMPrint):
+        KSMPrintTelemetry(char *filename, char *descript, int rank)
+
     cdef cppclass TACSKsm(TACSObject):
         TACSVec *createVec()
         void setOperators(TACSMat *_mat, TACSPc *_pc)
         void getOperators(TACSMat **_mat, TACSPc **_pc)
         int solve(TACSVec *b, TACSVec *x, int zero_guess)
+        int solveMulti(int nrhs, TACSVec **b, TACSVec **x, int zero_guess)
         void setTolerances(double _rtol, double _atol)
         void setMonitor(KSMPrint *_monitor)
         int getIterCount()
@@ -153,6 +161,26 @@ cdef extern from "KSM.h":
               int _nrestart, int _isFlexible )
         void setTimeMonitor()
 
+    cdef cppclass PipelinedGMRES(TACSKsm):
+        PipelinedGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart)
+
+    cdef cppclass SStepGMRES(TACSKsm):
+        SStepGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart, int _s)
+
+    cdef cppclass BlockGMRES(TACSKsm):
+        BlockGMRES(TACSMat *_mat, TACSPc *_pc, int _m, int _nrestart,
+                   int _max_block)
+
+    cdef cppclass BlockPCG(TACSKsm):
+        BlockPCG(TACSMat *_mat, TACSPc *_pc, int _max_iters, int _max_block)
+
+    cdef cppclass GCRODR(TACSKsm):
+        GCRODR(TACSMat *_mat, TACSPc *_pc, int _msub, int _nrecycle,
+               int _nrestart)
+        void clearRecycleSpace()
+        int writeRecycleSpace(const char*)
+        int readRecycleSpace(const char*)
+
     cdef cppclass TACSBcMap(TACSObject):
         TACSBcMap(int, int)
 
@@ -215,12 +243,24 @@ cdef extern from "TACSParallelMat.h":
 
     cdef cppclass TACSAdditiveSchwarz(TACSPc):
         TACSAdditiveSchwarz(TACSParallelMat *mat, int levFill, double fill)
+        void setSinglePrecisionFactor(int)
+        void setRealPartFactor(int)
+        void setOverlap(int, int)
+        void setCoarseSpace(int, TACSBVec**, int)
 
     cdef cppclass ApproximateSchur(TACSPc):
         TACSApproximateSchur(TACSParallelMat *mat, int levFill, double fill,
                              int inner_gmres_iters, double inner_rtol,
                              double inner_atol)
 
+    cdef cppclass TACSChebyshevPc(TACSPc):
+        TACSChebyshevPc(TACSMat*, int, TACSPc*, double, int, double)
+        int getDegree()
+
+    cdef cppclass TACSGMRESPolynomialPc(TACSPc):
+        TACSGMRESPolynomialPc(TACSMat*, int, TACSPc*, double)
+        int getDegree()
+
 cdef extern from "TACSSchurMat.h":
     cdef cppclass TACSSchurMat(TACSMat):
         void getBCSRMat(BCSRMat**, BCSRMat**, BCSRMat**, BCSRMat**)
@@ -232,8 +272,22 @@ cdef extern from "TACSSchurMat.h":
                     int reorder_schur_complement)
         void setMonitorFactorFlag(int)
         void setMonitorBackSolveFlag(int)
+        void setSinglePrecisionFactor(int)
+        void setRealPartFactor(int)
+        void setDeviceFactorFlag(int)
+
+    cdef cppclass TACSBDDCPc(TACSPc):
+        TACSBDDCPc(TACSSchurMat *mat, int levFill, double fill,
+                   int coarse_ranks)
+        int getNumPrimalNodes()
 
 cdef extern from "TACSMg.h":
+    enum MgCycleType "TACSMg::MgCycleType":
+        TACS_MG_V_CYCLE "TACSMg::V_CYCLE"
+        TACS_MG_W_CYCLE "TACSMg::W_CYCLE"
+        TACS_MG_F_CYCLE "TACSMg::F_CYCLE"
+        TACS_MG_K_CYCLE "TACSMg::K_CYCLE"
+
     cdef cppclass TACSMg(TACSPc):
         TACSMg(MPI_Comm, int, double, int, int)
         void setLevel(int, TACSAssembler*, TACSBVecInterp*, int, int,
@@ -245,6 +299,20 @@ cdef extern from "TACSMg.h":
         void assembleMatCombo(ElementMatrixType*, TacsScalar*, int, MatrixOrientation)
         int assembleGalerkinMat()
         void setMonitor(KSMPrint*)
+        void setCycleType(MgCycleType)
+        void setCoarseRanks(int)
+        void setMultiColorSmoother(int)
+
+cdef extern from "TACSAmg.h":
+    enum AmgSmootherType "TACSAmg::AmgSmootherType":
+        TACS_AMG_CHEBYSHEV_SMOOTHER "TACSAmg::CHEBYSHEV_SMOOTHER"
+        TACS_AMG_GAUSS_SEIDEL_SMOOTHER "TACSAmg::GAUSS_SEIDEL_SMOOTHER"
+
+    cdef cppclass TACSAmg(TACSPc):
+        TACSAmg(TACSAssembler*, TACSParallelMat*, int, int, double,
+                AmgSmootherType, int)
+        int getNumLevels()
+        void setMonitor(KSMPrint*)
 
 cdef extern from "TACSElementBasis.h":
     cdef cppclass TACSElementBasis(TACSObject):
@@ -298,6 +366,7 @@ cdef extern from "TACSAuxElements.h":
     cdef cppclass TACSAuxElements(TACSObject):
         TACSAuxElements(int)
         void addElement(int, TACSElement*)
+        void addAuxElements(TACSAuxElements*)
 
 cdef extern from "TACSAssembler.h":
     enum OrderingType"TACSAssembler::OrderingType":
@@ -322,6 +391,8 @@ cdef extern from "TACSAssembler.h":
         int setDependentNodes(int *depNodeIndex,
                               int *depNodeToTacs,
                               double *depNodeWeights)
+        int setDependentNodeTransform(double *depNodeBlockWeights,
+                                      TacsScalar *depNodeXptOffsets)
         void setDesignNodeMap(int _designVarsPerNode,
                               TACSNodeMap *_designVarMap)
         void addBCs(int nnodes, int *nodes,
@@ -347,6 +418,13 @@ cdef extern from "TACSAssembler.h":
         MPI_Comm getMPIComm()
         void setAuxElements(TACSAuxElements*)
         TACSAuxElements *getAuxElements()
+        void setBodyLoads(const TacsScalar*, const TacsScalar*,
+                          const TacsScalar*, int)
+        void clearBodyLoads()
+        int getDesignVersion()
+        int getNodeVersion()
+        int getStateVersion()
+        int getLoadVersion()
         TACSBVec *createVec()
         TACSParallelMat *createMat()
         TACSSchurMat *createSchurMat(OrderingType)
@@ -374,6 +452,12 @@ cdef extern from "TACSAssembler.h":
         void setInitConditions(TACSBVec*, TACSBVec*, TACSBVec*)
         void evalEnergies(TacsScalar*, TacsScalar*)
         void assembleRes(TACSBVec *residual, TacsScalar loadScale)
+        void assembleAuxRes(int, TACSAuxElements**, TACSBVec**)
+        void assembleResMulti(int, TACSAuxElements**, TACSBVec**, TacsScalar*)
+        void assembleJacobianEnsemble(int, TACSBVec**, TACSBVec**,
+                                      double, double, double,
+                                      TACSBVec**, TACSMat**,
+                                      MatrixOrientation)
         void assembleJacobian(double alpha, double beta, double gamma,
                               TACSBVec *residual, TACSMat *A,
                               MatrixOrientation matOr,
@@ -384,6 +468,8 @@ cdef extern from "TACSAssembler.h":
         void assembleMatCombo(ElementMatrixType*, TacsScalar*, int,
                               TACSMat*, MatrixOrientation matOr,
                               TacsScalar loadScale)
+        void assembleLumpedMass(TACSBVec *mass)
+        double estimateStableTimeStep()
         void addJacobianVecProduct(TacsScalar scale,
                                    double alpha, double beta, double gamma,
                                    TACSBVec *x, TACSBVec *y,
@@ -393,18 +479,28 @@ cdef extern from "TACSAssembler.h":
                            TacsScalar *funcVals)
         void addDVSens(double coef, int numFuncs, TACSFunction **funcs,
                        TACSBVec **dfdx)
+        int getSparseDVSens(double coef, int numFuncs, TACSFunction **funcs,
+                            int **rowp, int **cols, TacsScalar **vals)
         void addSVSens(double alpha, double beta, double gamma,
                        int numFuncs, TACSFunction **funcs,
                        TACSBVec **fuSens)
         void addAdjointResProducts(double scale, int numAdjoints,
                                    TACSBVec **adjoint, TACSBVec **dfdx,
                                    TacsScalar loadScale)
+        void setXptSensNodes(int numNodes, const int *nodes)
         void addXptSens(double coef, int numFuncs, TACSFunction **funcs,
                         TACSBVec **fXptSens)
         void addAdjointResXptSensProducts(double scale, int numAdjoints,
                                           TACSBVec **adjoint,
                                           TACSBVec **adjXptSens,
                                           TacsScalar loadScale)
+        void addResDVProducts(double scale, int numDirs, TACSBVec **dx,
+                              TACSBVec **res, TacsScalar loadScale)
+        void addResXptProducts(double scale, int numDirs, TACSBVec **dXpts,
+                               TACSBVec **res, TacsScalar loadScale)
+        void evalHessianVecProduct(int numFuncs, TACSFunction **funcs,
+                                   TACSKsm *ksm, TACSBVec *dir,
+                                   TACSBVec **hvec, double dh)
         void addMatDVSensInnerProduct(double scale,
                                       ElementMatrixType matType,
                                       TACSBVec *psi, TACSBVec *phi,
@@ -415,11 +511,17 @@ cdef extern from "TACSAssembler.h":
 
         void testElement(int elemNum, int print_level, double dh,
                          double rtol, double atol)
+        int testElements(int num_samples, int print_level, double dh,
+                         double rtol, double atol)
         void testFunction(TACSFunction *func, double dh)
 
         # Set the number of threads
         void setNumThreads(int t)
 
+cdef extern from "TACSXptJacobian.h":
+    cdef cppclass TACSXptJacobian(TACSMat):
+        TACSXptJacobian(TACSAssembler *assembler)
+
 cdef extern from "GSEP.h":
     enum OrthoType"SEP::OrthoType":
         FULL"SEP::FULL"
@@ -430,6 +532,7 @@ cdef extern from "GSEP.h":
         LARGEST"SEP::LARGEST"
         SMALLEST_MAGNITUDE"SEP::SMALLEST_MAGNITUDE"
         LARGEST_MAGNITUDE"SEP::LARGEST_MAGNITUDE"
+        NEAREST_SHIFT"SEP::NEAREST_SHIFT"
 
     cdef cppclass EPOperator(TACSObject):
         pass
@@ -492,11 +595,22 @@ cdef extern from "TACSBuckling.h":
         TACSAssembler* getAssembler()
         TacsScalar getSigma()
         void setSigma(TacsScalar)
+        void setBlockLanczos(int, int)
+        void setLOBPCG(int, int)
+        void setJDInnerSolver(int, double)
+        void setWarmStart(int)
+        int getTrackedMode(int, TacsScalar*)
+        void setReducedBasis(int, double)
+        void addReducedBasisVectors(int, TACSBVec**)
+        int getReducedBasisSize()
+        int isReducedSolution()
         void solve(KSMPrint*, int)
         TacsScalar extractEigenvalue(int, TacsScalar*)
         TacsScalar extractEigenvector(int, TACSBVec*, TacsScalar*)
         void evalEigenDVSens(int, TACSBVec*)
         void evalEigenXptSens(int, TACSBVec*)
+        void evalEigenDVSensMulti(int, const int*, TACSBVec**)
+        void evalEigenXptSensMulti(int, const int*, TACSBVec**)
 
     cdef cppclass TACSLinearBuckling(TACSObject):
         TACSLinearBuckling( TACSAssembler *,
@@ -507,6 +621,9 @@ cdef extern from "TACSBuckling.h":
         TACSAssembler* getAssembler()
         TacsScalar getSigma()
         void setSigma(TacsScalar)
+        void setBlockLanczos(int, int)
+        void setWarmStart(int)
+        int getTrackedMode(int, TacsScalar*)
         void solve(TACSVec*, TACSVec*, KSMPrint*)
         void evalEigenDVSens(int, TacsScalar, int)
         TacsScalar extractEigenvalue(int, TacsScalar*)
@@ -516,11 +633,18 @@ cdef extern from "TACSBuckling.h":
         void addEigenDVSens(TacsScalar, int, TACSBVec*)
         void addEigenXptSens(TacsScalar, int, TACSBVec*)
         void evalEigenSVSens(int, TACSBVec*)
+        void evalEigenDVSensMulti(int, const int*, TACSBVec**)
+        void evalEigenXptSensMulti(int, const int*, TACSBVec**)
+        void addEigenDVSensMulti(TacsScalar, int, const int*, TACSBVec**)
+        void addEigenXptSensMulti(TacsScalar, int, const int*, TACSBVec**)
 
 cdef extern from "TACSMeshLoader.h":
     cdef cppclass TACSMeshLoader(TACSObject):
         TACSMeshLoader(MPI_Comm _comm)
         int scanBDFFile(char *file_name)
+        int scanBDFFileParallel(char *file_name)
+        int writeMeshCache(TACSAssembler *assembler, char *file_name)
+        int readMeshCache(char *file_name)
         int getNumComponents()
         const char *getComponentDescript(int comp_num)
         const char *getElementDescript(int comp_num)
@@ -550,6 +674,11 @@ cdef extern from "TACSCreator.h":
                                    int *_elem_node_ptr,
                                    int *_elem_node_conn,
                                    int *_elem_id_nums )
+        void setDistributedConnectivity(int _num_owned_nodes,
+                                        int _num_owned_elements,
+                                        int *_elem_node_ptr,
+                                        int *_elem_node_conn,
+                                        int *_elem_id_nums)
         void setBoundaryConditions(int _num_bcs, int *_bc_nodes,
                                    int *_bc_vars, int *_bc_ptr,
                                    TacsScalar *_bc_vals)
@@ -564,21 +693,145 @@ cdef extern from "TACSCreator.h":
         void partitionMesh(int split_size, int *part)
         int getElementPartition(const int **)
         TACSAssembler *createTACS()
+        TACSAssembler *repartition(TACSAssembler*, const double*)
         int getNodeNums(const int**)
         int getElementIdNums(int, int *, int **)
         void getAssemblerNodeNums(TACSAssembler*, int, const int*,
                                   int*, int**)
 
+cdef extern from "TACSPanelLength.h":
+    cdef cppclass TACSPanelLength(TACSObject):
+        TACSPanelLength(TACSAssembler*, int, const int*, const int*,
+                        const TacsScalar*)
+        int getNumPanels()
+        int getNumPanelNodes()
+        void evalLengths(TACSBVec*, TacsScalar*)
+        void evalLengthSens(TACSBVec*, TacsScalar*, TacsScalar*)
+
+cdef extern from "TACSLinearConstraint.h":
+    cdef cppclass TACSLinearConstraint(TACSObject):
+        TACSLinearConstraint(TACSAssembler*)
+        int addAdjacencyConstraints(int, const int*, int)
+        int addDVConstraints(int, const int*, int, const int*,
+                             const TacsScalar*)
+        int getNumConstraints()
+        int getNumDesignVars()
+        void getArrays(int*, int*, const int**, const int**,
+                       const TacsScalar**)
+
+cdef extern from "TACSLoadTransfer.h":
+    cdef cppclass TACSLoadTransfer(TACSObject):
+        TACSLoadTransfer(TACSAssembler*, int, const int*, int,
+                         const TacsScalar*, int)
+        int getNumAeroNodes()
+        void transferDisps(TACSBVec*, TacsScalar*)
+        void transferLoads(const TacsScalar*, TACSBVec*)
+        void getWeights(const int**, const int**, const TacsScalar**)
+
+cdef extern from "TACSDensityFilter.h":
+    cdef cppclass TACSDensityFilter(TACSObject):
+        TACSDensityFilter(TACSAssembler*, double)
+        void setProjection(double, double)
+        void applyFilter(TACSBVec*, TACSBVec*)
+        void applyFilterSens(TACSBVec*, TACSBVec*)
+
+cdef extern from "TACSThermoStructural.h":
+    cdef cppclass TACSThermoStructural(TACSObject):
+        TACSThermoStructural(TACSAssembler*, TACSAssembler*, TACSAssembler*)
+        void setTolerances(double, double)
+        void setMaxIterations(int)
+        void setPrintLevel(int)
+        void resetFactorizations()
+        int getNumFactorizations()
+        int solve(TACSBVec*, TACSBVec*, TACSBVec*, TACSBVec*)
+        int getNumIterations()
+        void merge(TACSBVec*, TACSBVec*, TACSBVec*)
+        void split(TACSBVec*, TACSBVec*, TACSBVec*)
+
+cdef extern from "TACSHarmonicAnalysis.h":
+    cdef cppclass TACSHarmonicAnalysis(TACSObject):
+        TACSHarmonicAnalysis(TACSAssembler*, int, int)
+        void setRayleighDamping(double, double)
+        void setModalDamping(double)
+        void setTolerances(double, double)
+        void setMonitor(KSMPrint*)
+        void assembleMatrices()
+        void setModes(TACSFrequencyAnalysis*, int)
+        void clearModes()
+        int getNumModes()
+        int solve(int, const double*, TACSBVec*, TACSBVec**, TACSBVec**)
+        int getNumIterations()
+
+cdef extern from "TACSRandomVibration.h":
+    cdef cppclass TACSRandomVibration(TACSObject):
+        TACSRandomVibration(TACSAssembler*)
+        void setModes(TACSFrequencyAnalysis*, int)
+        void setModalDamping(double)
+        void setLoadPSD(TACSBVec*, int, const double*, const double*)
+        void computeCovariance()
+        int getNumModes()
+        TACSBVec *getMode(int)
+        TacsScalar getEigenvalue(int)
+        const TacsScalar *getCovariance()
+        void getRMSOutputData(ElementType, int, int*, int*, TacsScalar**)
+
+cdef extern from "TACSFH5.h":
+    enum FH5Compression "TACSFH5File::FH5Compression":
+        TACS_FH5_NO_COMPRESSION "TACSFH5File::FH5_NO_COMPRESSION"
+        TACS_FH5_LOSSLESS "TACSFH5File::FH5_LOSSLESS"
+        TACS_FH5_QUANTIZE "TACSFH5File::FH5_QUANTIZE"
+
+    enum FH5DataType "TACSFH5File::FH5DataType":
+        TACS_FH5_FLOAT "TACSFH5File::FH5_FLOAT"
+        TACS_FH5_HALF "TACSFH5File::FH5_HALF"
+        TACS_FH5_BFLOAT16 "TACSFH5File::FH5_BFLOAT16"
+
 cdef extern from "TACSToFH5.h":
     cdef cppclass TACSToFH5(TACSObject):
         TACSToFH5(TACSAssembler *_tacs, ElementType _elem_type, int _out_type)
         void setComponentName(int comp_num, char *group_name)
         void writeToFile(char *filename)
+        void setAsyncOutput(int flag, size_t max_pending_bytes)
+        void flush()
+        void setCompression(FH5Compression codec, double tol,
+                            FH5DataType float_type)
+
+cdef extern from "TACSToVTK.h":
+    cdef cppclass TACSToVTK(TACSObject):
+        TACSToVTK(TACSAssembler *_tacs, ElementType _elem_type, int _out_type)
+        void setComponentName(int comp_num, char *group_name)
+        void setSeriesFile(char *filename)
+        int writeToFile(char *filename)
+
+cdef extern from "TACSTimeHistory.h":
+    enum:
+        TACS_HISTORY_STATES "TACSTimeHistory::TACS_HISTORY_STATES"
+        TACS_HISTORY_RATES "TACSTimeHistory::TACS_HISTORY_RATES"
+        TACS_HISTORY_ACCELERATIONS "TACSTimeHistory::TACS_HISTORY_ACCELERATIONS"
+
+    cdef cppclass TACSTimeHistory(TACSObject):
+        TACSTimeHistory(TACSAssembler*, int, const int*, int, int)
+        void setFunctions(int, TACSFunction**)
+        int open(const char*)
+        void close()
+        void record(double, TACSBVec*, TACSBVec*, TACSBVec*)
+        void flush()
+        int getRecordLength()
+        int getNumRecords()
+
+cdef extern from "TACSReducedOrderModel.h":
+    cdef cppclass TACSReducedOrderModel(TACSObject):
+        TACSReducedOrderModel(TACSAssembler*, int, int)
+        int getBasisSize()
+        TACSBVec *getBasisVec(int)
+        int getNumSampleElements()
+        int getSingularValues(const double**)
 
 cdef extern from "TACSFH5Loader.h":
     cdef cppclass TACSFH5Loader(TACSObject):
         TACSFH5Loader()
         int loadData(const char*, const char*)
+        void setNumThreads(int)
         int getNumComponents();
         char* getComponentName( int comp );
         void getConnectivity(int*, int**, int**, int**, int**)
@@ -604,15 +857,29 @@ cdef extern from "TACSIntegrator.h":
         void setMaxNewtonIters(int)
         void setPrintLevel(int level, const_char *filename)
         void setJacAssemblyFreq(int)
+        void setJacobianReuse(int, double, int)
+        void getJacobianReuseStatistics(int*, int*)
+        void setAndersonAcceleration(int)
+        void setEisenstatWalker(int, double, double, double)
+        void setNewtonMonitor(KSMPrint*)
         void setUseLapack(int)
         void setUseSchurMat(int, OrderingType)
         void setInitNewtonDeltaFraction(double)
         void setKrylovSubspaceMethod(TACSKsm *_ksm)
         void setTimeInterval(double, double)
+        void setCheckpoints(int)
+        int getNumRecomputedSteps()
+        void setAdaptiveTimeStepping(double, double, double, double, double)
+        int getNumRejectedSteps()
+        void setRestartOutput(const char*, int)
+        int writeRestart(const char*, int)
+        int readRestart(const char*, int*)
         void setFunctions(int num_funcs, TACSFunction **funcs,
                           int start_step, int end_step)
         void lapackNaturalFrequencies(int, TACSBVec*, TACSBVec*,
                                       TACSBVec*, TacsScalar*, TacsScalar*)
+        int naturalFrequencies(TACSBVec*, TACSBVec*, TACSBVec*, int,
+                               TacsScalar*, double, int)
 
         # Forward mode functions
         int iterate(int step_num,TACSBVec *forces)
@@ -634,6 +901,8 @@ cdef extern from "TACSIntegrator.h":
         void setOutputPrefix(const_char *prefix)
         void setOutputFrequency(int write_freq)
         void setFH5(TACSToFH5 *_f5)
+        void setTimeHistory(TACSTimeHistory *_history, int _history_freq)
+        void setPipelinedAdjoint(int _pipelined_adjoint)
         void writeSolution(const_char *filename, int format)
         void writeSolutionToF5();
         void writeStepToF5(int step_num);
@@ -650,6 +919,10 @@ cdef extern from "TACSIntegrator.h":
                           double tinit, double tfinal,
                           double num_steps,
                           int max_bdf_order)
+        TACSReducedOrderModel *buildReducedOrderModel(int, double, double,
+                                                      int, int)
+        void setReducedOrderModel(TACSReducedOrderModel*, double, int)
+        void getReducedOrderStatistics(int*, int*)
 
     # DIRK Implementation of the integrator
     cdef cppclass TACSDIRKIntegrator(TACSIntegrator):
@@ -673,6 +946,15 @@ cdef extern from "TACSIntegrator.h":
         double getStageStates( int step, int stage,
 		      TACSBVec **qS, TACSBVec **qdotS, TACSBVec **qddotS)
 
+    # Explicit central-difference implementation of the integrator
+    cdef cppclass TACSCentralDifferenceIntegrator(TACSIntegrator):
+        TACSCentralDifferenceIntegrator(TACSAssembler *tacs,
+                                        double tinit, double tfinal,
+                                        double num_steps)
+        void setStableTimeStepFactor(double)
+        double getStableTimeStep()
+        int getNumSubSteps()
+
     # ABM Implementation of the integrator
     cdef cppclass TACSABMIntegrator(TACSIntegrator):
         TACSABMIntegrator(TACSAssembler *tacs,
@@ -705,8 +987,11 @@ cdef extern from "TACSSpectralIntegrator.h":
                              TACSAssembler**, TACSBVecInterp**, int*)
         void factor()
 
+    cdef cppclass TACSLinearSpectralDiagPc(TACSPc):
+        TACSLinearSpectralDiagPc(TACSLinearSpectralMat*)
+
     cdef cppclass TACSSpectralIntegrator(TACSObject):
-        TACSSpectralIntegrator(TACSAssembler*, double, int)
+        TACSSpectralIntegrator(TACSAssembler*, double, int, MPI_Comm)
 
         int getNumLGLNodes()
         double getPointAtLGLNode(int)
@@ -730,3 +1015,32 @@ cdef extern from "TACSSpectralIntegrator.h":
 
         # Compute the solution at a point in the time interval
         void computeSolutionAndDeriv(double, TACSSpectralVec*, TACSBVec *u, TACSBVec*)
+
+cdef extern from "TACSProfiler.h":
+    void TACSProfilerSetEnabled "TACSProfiler::setEnabled"(int)
+    int TACSProfilerIsEnabled "TACSProfiler::isEnabled"()
+    void TACSProfilerReset "TACSProfiler::reset"()
+    int TACSProfilerWriteJSON "TACSProfiler::writeJSON"(const char*)
+    int TACSProfilerWriteSummaryJSON "TACSProfiler::writeSummaryJSON"(MPI_Comm, const char*)
+
+cdef extern from "TACSMemory.h":
+    enum:
+        TACS_MEMORY_NUM_CATEGORIES
+    size_t TACSMemoryGetCurrentBytes "TACSMemory::getCurrentBytes"(int)
+    size_t TACSMemoryGetPeakBytes "TACSMemory::getPeakBytes"(int)
+    const char* TACSMemoryGetCategoryName "TACSMemory::getCategoryName"(int)
+    void TACSMemoryResetPeak "TACSMemory::resetPeak"()
+    void TACSMemoryPrintSummary "TACSMemory::printSummary"(MPI_Comm)
+
+cdef extern from "TACSCommProfiler.h":
+    void TACSCommProfilerSetEnabled "TACSCommProfiler::setEnabled"(int)
+    void TACSCommProfilerReset "TACSCommProfiler::reset"()
+    void TACSCommProfilerPrintSummary "TACSCommProfiler::printSummary"(MPI_Comm)
+    int TACSCommProfilerWriteJSON "TACSCommProfiler::writeJSON"(MPI_Comm, const char*)
+
+cdef extern from "TACSBenchmark.h":
+    enum:
+        TACS_BENCH_VEC_WRITE
+        TACS_BENCH_NUM_KERNELS
+    void TACSBenchmarkRunKernels "TACSBenchmark::runKernels"(TACSAssembler*, int, const char*, double*)
+    const char* TACSBenchmarkGetKernelName "TACSBenchmark::getKernelName"(int)
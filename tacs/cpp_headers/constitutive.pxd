@@ -65,6 +65,8 @@ cdef extern from "TACSPhaseChangeMaterialConstitutive.h":
                                             TacsScalar, TacsScalar,
                                             TacsScalar, TacsScalar,
                                             int, TacsScalar, TacsScalar)
+        void setTransitionTable(int, double)
+        TacsScalar getPhaseFractionTempTol(double)
 
 cdef extern from "TACSSolidConstitutive.h":
     cdef cppclass TACSSolidConstitutive(TACSConstitutive):
@@ -209,6 +209,11 @@ cdef extern from "TACSShellElementDefs.h":
         void setComplexStepGmatrix(bool)
         
 
+    cdef cppclass TACSQuad4ReducedShell(TACSElement):
+        TACSQuad4ReducedShell(TACSShellTransform*,
+                              TACSShellConstitutive*)
+        void setHourglassCoefficient(double)
+
     cdef cppclass TACSQuad9Shell(TACSElement):
         TACSQuad9Shell(TACSShellTransform*,
                        TACSShellConstitutive*)
@@ -382,6 +387,12 @@ cdef extern from "TACSSpringElement.h":
         TACSSpringElement(TACSSpringTransform*,
                           TACSGeneralSpringConstitutive*)
 
+cdef extern from "TACSNodeToSurfaceContact.h":
+    cdef cppclass TACSNodeToSurfaceContact(TACSElement):
+        TACSNodeToSurfaceContact(int, int, TacsScalar, double)
+        void setPenalty(TacsScalar)
+        TacsScalar getPenalty()
+
 cdef extern from "TACSGibbsVector.h":
     cdef cppclass TACSGibbsVector(TACSObject):
         TACSGibbsVector(TacsScalar, TacsScalar, TacsScalar)
@@ -438,12 +449,16 @@ cdef extern from "TACSRBE2.h":
         TACSRBE2(int, int*)
         @staticmethod
         void setScalingParameters(double, double)
+        int getNumDependentNodes()
+        int getDependentNodeTransform(const TacsScalar*, double*)
 
 cdef extern from "TACSRBE3.h":
     cdef cppclass TACSRBE3(TACSElement):
         TACSRBE3(int, int*, double*, int*)
         @staticmethod
         void setScalingParameters(double, double)
+        int getNumIndependentNodes()
+        int getDependentNodeTransform(const TacsScalar*, double*)
 
 cdef extern from "TACSMassElement.h":
     cdef cppclass TACSMassElement(TACSElement):
@@ -470,3 +485,12 @@ cdef extern from "TACSElementWrapper.h":
                             int, const TacsScalar*, int, const TacsScalar*,
                             const TacsScalar*, const TacsScalar*,
                             TacsScalar*, TacsScalar*)
+        void (*addresidualbatch)(void*, int, const int*, double, int,
+                                 const TacsScalar*, int, const TacsScalar*,
+                                 const TacsScalar*, const TacsScalar*,
+                                 TacsScalar*)
+        void (*addjacobianbatch)(void*, int, const int*, double,
+                                 TacsScalar, TacsScalar, TacsScalar,
+                                 int, const TacsScalar*, int, const TacsScalar*,
+                                 const TacsScalar*, const TacsScalar*,
+                                 TacsScalar*, TacsScalar*)
@@ -37,6 +37,15 @@ cdef extern from "TACSMomentOfInertia.h":
     cdef cppclass TACSMomentOfInertia(TACSFunction):
         TACSMomentOfInertia(TACSAssembler*, const double*,  const double*, int)
 
+cdef extern from "TACSMassProperties.h":
+    cdef cppclass TACSMassProperties(TACSObject):
+        TACSMassProperties(TACSAssembler*)
+        void evalMassProperties(TacsScalar*)
+        void addDVSens(int, const TacsScalar*, TACSBVec**)
+        void addXptSens(int, const TacsScalar*, TACSBVec**)
+        void invalidate()
+        int getNumUpdatedElements()
+
 cdef extern from "TACSCompliance.h":
     cdef cppclass TACSCompliance(TACSFunction):
         TACSCompliance(TACSAssembler*)
@@ -60,6 +69,11 @@ cdef extern from "TACSKSTemperature.h":
         void setParameter(double)
         void setMaxFailOffset(TacsScalar)
 
+cdef extern from "TACSFailureCache.h":
+    cdef cppclass TACSFailureCache(TACSObject):
+        TACSFailureCache(TACSAssembler*)
+        void invalidate()
+
 cdef extern from "TACSKSFailure.h":
     enum KSFailureType"TACSKFailure::KSFailureType":
         KS_FAILURE_DISCRETE"TACSKSFailure::DISCRETE"
@@ -73,6 +87,22 @@ cdef extern from "TACSKSFailure.h":
         double getParameter()
         void setParameter(double)
         void setMaxFailOffset(TacsScalar)
+        void setFailureCache(TACSFailureCache*)
+
+cdef extern from "TACSRMSStress.h":
+    cdef cppclass TACSRMSStress(TACSFunction):
+        TACSRMSStress(TACSAssembler*, TACSRandomVibration*, double, double)
+        double getParameter()
+        void setParameter(double)
+        TacsScalar getMaximumRMSStress()
+
+cdef extern from "TACSFatigueDamage.h":
+    cdef cppclass TACSFatigueDamage(TACSFunction):
+        TACSFatigueDamage(TACSAssembler*, double, double, double)
+        double getParameter()
+        void setParameter(double)
+        void setStressComponent(int)
+        TacsScalar getMaximumDamage()
 
 cdef extern from "TACSKSDisplacement.h":
     enum KSDisplacementType"TACSKDisplacement::KSDisplacementType":
@@ -725,6 +725,47 @@ cdef class Quad4Shell(Element):
         if self.cptr:
             self.cptr.setComplexStepGmatrix(flag)
 
+cdef class Quad4ReducedShell(Element):
+    """
+    A 4-node quad shell element for linear elastic analysis that uses
+    one-point quadrature with hourglass control.
+
+    The residual and Jacobian are evaluated at the element center. The
+    spurious zero-energy modes of the one-point quadrature are stabilized
+    with a stiffness proportional to the hourglass coefficient.
+
+    .. note::
+        **varsPerNode**: 6
+
+        **numNodes**: 4
+
+        **outputElement**: ``TACS.BEAM_OR_SHELL_ELEMENT``
+
+    Args:
+        transform (ShellTransform or None): Shell transform object.
+          ``None`` is equivalent to :class:`~ShellNaturalTransform`.
+        con (ShellConstitutive): Shell constitutive object.
+    """
+    cdef TACSQuad4ReducedShell* cptr
+    def __cinit__(self, ShellTransform transform, ShellConstitutive con):
+        if transform is None:
+            transform = ShellNaturalTransform()
+        self.cptr = new TACSQuad4ReducedShell(transform.ptr, con.cptr)
+        self.ptr = self.cptr
+        self.ptr.incref()
+        self.con = con
+        self.transform = transform
+
+    def setHourglassCoefficient(self, double coef):
+        """
+        Set the scaling of the hourglass stiffness (default 0.1)
+
+        Args:
+            coef (float): Hourglass coefficient
+        """
+        if self.cptr:
+            self.cptr.setHourglassCoefficient(coef)
+
 cdef class Quad4NonlinearShell(Element):
     """
     A 4-node quad shell element for general geometric nonlinear elastic analysis.
@@ -1938,6 +1979,50 @@ cdef class SpringElement(Element):
         self.con = con
         self.transform = transform
 
+cdef class NodeToSurfaceContact(Element):
+    """
+    A frictionless, penalty-based node-to-surface contact element.
+
+    The first node is the contact node and the remaining nodes define a
+    triangular or quadrilateral facet of the target surface. Quadrilateral
+    facets use the same node ordering as the shell elements. The facet
+    normal, given by the right-hand rule with the node ordering, must point
+    away from the target body. A penalty force is applied when the contact
+    node penetrates the facet.
+
+    .. note::
+        **varsPerNode**: varsPerNode
+
+        **numNodes**: 1 + facetSize
+
+        **outputElement**: ``TACS.SPRING_ELEMENT``
+
+    Args:
+        varsPerNode (int): Number of variables per node (3 for solids, 6 for shells).
+        facetSize (int): Number of facet nodes (3 or 4).
+        penalty (float or complex): Penalty stiffness (force per unit length).
+        tol (float): Parametric tolerance for a projection within the facet.
+    """
+    cdef TACSNodeToSurfaceContact *cptr
+    def __cinit__(self, int varsPerNode, int facetSize, TacsScalar penalty,
+                  double tol=0.0):
+        self.cptr = new TACSNodeToSurfaceContact(varsPerNode, facetSize,
+                                                 penalty, tol)
+        self.ptr = self.cptr
+        self.ptr.incref()
+
+    def setPenalty(self, TacsScalar penalty):
+        """
+        Set the penalty stiffness.
+        """
+        self.cptr.setPenalty(penalty)
+
+    def getPenalty(self):
+        """
+        Get the penalty stiffness.
+        """
+        return self.cptr.getPenalty()
+
 cdef class GibbsVector:
     cdef TACSGibbsVector *ptr
     def __cinit__(self, x, y, z):
@@ -2032,6 +2117,27 @@ cdef class RBE2(Element):
         TACSRBE2.setScalingParameters(C1, C2)
         return
 
+    def getDependentNodeTransform(self, np.ndarray[TacsScalar, ndim=1, mode='c'] Xpts):
+        """
+        Get the weights that express the dependent node dof in terms of the
+        independent node dof. These can be passed to
+        Assembler.setDependentNodeTransform() to eliminate the dependent nodes
+        instead of adding this element.
+
+        Args:
+            Xpts (numpy.ndarray[TacsScalar]): The element node locations.
+
+        Returns:
+            numpy.ndarray[float]: A row-major 6 x 6 block for each dependent node.
+        """
+        cdef int num_dep = self.cptr.getNumDependentNodes()
+        cdef np.ndarray weights = np.zeros(36 * num_dep, dtype=np.double)
+        fail = self.cptr.getDependentNodeTransform(<TacsScalar*>Xpts.data,
+                                                   <double*>weights.data)
+        if fail:
+            raise ValueError('All dependent node dof must be constrained')
+        return weights
+
 cdef class RBE3(Element):
     """
     The RBE3 element is a powerful tool for distributing applied
@@ -2093,6 +2199,27 @@ cdef class RBE3(Element):
         TACSRBE3.setScalingParameters(C1, C2)
         return
 
+    def getDependentNodeTransform(self, np.ndarray[TacsScalar, ndim=1, mode='c'] Xpts):
+        """
+        Get the weights that express the dependent node dof in terms of the
+        independent node dof. These can be passed to
+        Assembler.setDependentNodeTransform() to eliminate the dependent node
+        instead of adding this element.
+
+        Args:
+            Xpts (numpy.ndarray[TacsScalar]): The element node locations.
+
+        Returns:
+            numpy.ndarray[float]: A row-major 6 x 6 block for each independent node.
+        """
+        cdef int num_indep = self.cptr.getNumIndependentNodes()
+        cdef np.ndarray weights = np.zeros(36 * num_indep, dtype=np.double)
+        fail = self.cptr.getDependentNodeTransform(<TacsScalar*>Xpts.data,
+                                                   <double*>weights.data)
+        if fail:
+            raise ValueError('All dependent node dof must be constrained')
+        return weights
+
 cdef class MassElement(Element):
     """
     A 6 DOF point mass element.
@@ -2308,6 +2435,45 @@ cdef class MassElement(Element):
 #                                    _vars, _dvars, _ddvars, _res, _mat)
 #     return
 
+# cdef void addResidualBatch(void *self_ptr, int num_elems,
+#                            const int *elem_index, double time,
+#                            int num_nodes, const TacsScalar *Xpts,
+#                            int num_vars, const TacsScalar *vars,
+#                            const TacsScalar *dvars, const TacsScalar *ddvars,
+#                            TacsScalar *res) with gil:
+#     # Each array has one row per element in the batch
+#     n = num_elems
+#     _index = inplace_array_1d(np.NPY_INT, n, <void*>elem_index)
+#     _Xpts = inplace_array_1d(TACS_NPY_SCALAR, 3*num_nodes*n, <void*>Xpts).reshape(n, -1)
+#     _vars = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>vars).reshape(n, -1)
+#     _dvars = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>dvars).reshape(n, -1)
+#     _ddvars = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>ddvars).reshape(n, -1)
+#     _res = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>res).reshape(n, -1)
+#     (<object>self_ptr).addResidualBatch(_index, time, _Xpts,
+#                                         _vars, _dvars, _ddvars, _res)
+#     return
+
+# cdef void addJacobianBatch(void *self_ptr, int num_elems,
+#                            const int *elem_index, double time,
+#                            TacsScalar alpha, TacsScalar beta, TacsScalar gamma,
+#                            int num_nodes, const TacsScalar *Xpts,
+#                            int num_vars, const TacsScalar *vars,
+#                            const TacsScalar *dvars, const TacsScalar *ddvars,
+#                            TacsScalar *res, TacsScalar *mat) with gil:
+#     # Each array has one row per element, the matrices are (n, nv, nv)
+#     n = num_elems
+#     _index = inplace_array_1d(np.NPY_INT, n, <void*>elem_index)
+#     _Xpts = inplace_array_1d(TACS_NPY_SCALAR, 3*num_nodes*n, <void*>Xpts).reshape(n, -1)
+#     _vars = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>vars).reshape(n, -1)
+#     _dvars = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>dvars).reshape(n, -1)
+#     _ddvars = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>ddvars).reshape(n, -1)
+#     _res = inplace_array_1d(TACS_NPY_SCALAR, num_vars*n, <void*>res).reshape(n, -1)
+#     _mat = inplace_array_1d(TACS_NPY_SCALAR, num_vars*num_vars*n,
+#                             <void*>mat).reshape(n, num_vars, num_vars)
+#     (<object>self_ptr).addJacobianBatch(_index, time, alpha, beta, gamma, _Xpts,
+#                                         _vars, _dvars, _ddvars, _res, _mat)
+#     return
+
 # cdef class pyElement(Element):
 #     def __cinit__(self, int vars_per_node, int num_nodes, *args, **kwargs):
 #         cdef TACSElementWrapper *pointer
@@ -2321,4 +2487,10 @@ cdef class MassElement(Element):
 #         pointer.addresidual = addResidual
 #         pointer.addjacobian = addJacobian
 
+#         # Use the batched callbacks when the class defines them
+#         if hasattr(self, 'addResidualBatch'):
+#             pointer.addresidualbatch = addResidualBatch
+#         if hasattr(self, 'addJacobianBatch'):
+#             pointer.addjacobianbatch = addJacobianBatch
+
 #         self.ptr = pointer
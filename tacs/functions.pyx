@@ -151,6 +151,91 @@ cdef class MomentOfInertia(Function):
         self.ptr.incref()
         return
 
+cdef class MassProperties:
+    """
+    Evaluates the mass, center of mass and inertia tensor about the
+    center of mass in a single pass over the elements. The values
+    integrated over each element are stored, and only the elements
+    whose design variables or node locations have changed are
+    re-integrated when the properties are next evaluated.
+
+    The properties are ordered as:
+
+        [m, cx, cy, cz, Ixx, Ixy, Ixz, Iyy, Iyz, Izz]
+
+    with the same sign convention as :class:`MomentOfInertia`.
+
+    Args:
+        assembler (Assembler): TACS Assembler object that will evaluating the properties.
+    """
+    cdef TACSMassProperties *ptr
+    def __cinit__(self, Assembler assembler):
+        self.ptr = new TACSMassProperties(assembler.ptr)
+        self.ptr.incref()
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+
+    def evalMassProperties(self):
+        """
+        Evaluate the mass properties. This call is collective.
+
+        Returns:
+            numpy.ndarray: The 10 mass properties
+        """
+        cdef np.ndarray props = np.zeros(10, dtype=dtype)
+        self.ptr.evalMassProperties(<TacsScalar*>props.data)
+        return props
+
+    def addDVSens(self, seeds, dfdxlist):
+        """
+        Add the derivatives of the combinations of the properties given
+        by each row of seeds w.r.t. the design variables to the vectors
+        in dfdxlist. The derivatives are computed in a single pass.
+        """
+        cdef int num_seeds = len(dfdxlist)
+        cdef np.ndarray s = np.ascontiguousarray(seeds, dtype=dtype).reshape(num_seeds, 10)
+        cdef TACSBVec **dfdx = <TACSBVec**>malloc(num_seeds*sizeof(TACSBVec*))
+        for i in range(num_seeds):
+            dfdx[i] = (<Vec>dfdxlist[i]).getBVecPtr()
+        self.ptr.addDVSens(num_seeds, <TacsScalar*>s.data, dfdx)
+        free(dfdx)
+        for i in range(num_seeds):
+            dfdxlist[i].beginSetValues()
+            dfdxlist[i].endSetValues()
+        return
+
+    def addXptSens(self, seeds, dfdXlist):
+        """
+        Add the derivatives of the combinations of the properties given
+        by each row of seeds w.r.t. the node locations to the vectors in
+        dfdXlist. The derivatives are computed in a single pass.
+        """
+        cdef int num_seeds = len(dfdXlist)
+        cdef np.ndarray s = np.ascontiguousarray(seeds, dtype=dtype).reshape(num_seeds, 10)
+        cdef TACSBVec **dfdX = <TACSBVec**>malloc(num_seeds*sizeof(TACSBVec*))
+        for i in range(num_seeds):
+            dfdX[i] = (<Vec>dfdXlist[i]).getBVecPtr()
+        self.ptr.addXptSens(num_seeds, <TacsScalar*>s.data, dfdX)
+        free(dfdX)
+        for i in range(num_seeds):
+            dfdXlist[i].beginSetValues()
+            dfdXlist[i].endSetValues()
+        return
+
+    def getNumUpdatedElements(self):
+        """
+        Get the number of elements re-integrated in the last evaluation
+        """
+        return self.ptr.getNumUpdatedElements()
+
+    def invalidate(self):
+        """
+        Force the re-integration of every element.
+        """
+        self.ptr.invalidate()
+
 cdef class EnclosedVolume(Function):
     """
     Evaluates the volume enclosed by the elements.
@@ -274,6 +359,31 @@ cdef class KSTemperature(Function):
     def setParameter(self, double ksparam):
         self.kstptr.setParameter(ksparam)
 
+cdef class FailureCache:
+    """
+    Stores the failure index at each quadrature point so that it is
+    evaluated once and shared between the failure functions that use
+    this object. The stored values are re-computed when the design
+    variables, nodes or states set in the assembler change.
+
+    Args:
+        assembler (Assembler): TACS Assembler object that the functions are evaluated on.
+    """
+    cdef TACSFailureCache *ptr
+    def __cinit__(self, Assembler assembler):
+        self.ptr = new TACSFailureCache(assembler.ptr)
+        self.ptr.incref()
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+
+    def invalidate(self):
+        """
+        Force the re-evaluation of the stored failure values.
+        """
+        self.ptr.invalidate()
+
 cdef class KSFailure(Function):
     """
     The following class implements the methods necessary to calculate
@@ -344,6 +454,103 @@ cdef class KSFailure(Function):
     def setParameter(self, double ksparam):
         self.ksptr.setParameter(ksparam)
 
+    def setFailureCache(self, FailureCache cache=None):
+        """
+        Set the object used to store the failure values. The same object
+        may be shared by several failure functions on the same assembler.
+        """
+        cdef TACSFailureCache *ptr = NULL
+        if cache is not None:
+            ptr = cache.ptr
+        self.ksptr.setFailureCache(ptr)
+
+cdef class RMSStress(Function):
+    """
+    The KS aggregation of the RMS von Mises stress under a random load,
+    computed from the modes and the modal covariance stored in a
+    RandomVibration object. The design variable sensitivity holds the
+    modes and the covariance fixed.
+
+    Args:
+        assembler (Assembler): TACS Assembler object that will evaluating this function.
+        random (RandomVibration): The random vibration analysis with the computed covariance.
+        ksWeight (float, optional): The ks weight used in the calculation (keyword argument). Defaults to 80.0.
+        sigmaRef (float, optional): The reference stress (keyword argument). Defaults to 1.0.
+    """
+    cdef TACSRMSStress *rmsptr
+    def __cinit__(self, Assembler assembler, RandomVibration random, **kwargs):
+        """
+        Wrap the function RMSStress
+        """
+        cdef double ksWeight = 80.0
+        cdef double sigmaRef = 1.0
+
+        if 'ksWeight' in kwargs:
+            ksWeight = kwargs['ksWeight']
+
+        if 'sigmaRef' in kwargs:
+            sigmaRef = kwargs['sigmaRef']
+
+        self.rmsptr = new TACSRMSStress(assembler.ptr, random.ptr, ksWeight,
+                                        sigmaRef)
+        self.ptr = self.rmsptr
+        self.ptr.incref()
+        return
+
+    def setParameter(self, double ksparam):
+        self.rmsptr.setParameter(ksparam)
+
+    def getMaximumRMSStress(self):
+        return self.rmsptr.getMaximumRMSStress()
+
+cdef class FatigueDamage(Function):
+    """
+    The KS aggregation of the fatigue damage accumulated over a transient
+    history. The stress reversals at each quadrature point are counted
+    with the rainflow method as the history is integrated, and the damage
+    of each cycle is (range/refRange)^exponent.
+
+    Args:
+        assembler (Assembler): TACS Assembler object that will evaluating this function.
+        ksWeight (float, optional): The ks weight used in the calculation (keyword argument). Defaults to 80.0.
+        exponent (float, optional): The Basquin exponent (keyword argument). Defaults to 3.0.
+        refRange (float, optional): The stress range with a life of one cycle (keyword argument). Defaults to 1.0.
+        component (int, optional): The stress component used for counting, or -1 for the
+          signed von Mises stress (keyword argument). Defaults to -1.
+    """
+    cdef TACSFatigueDamage *fptr
+    def __cinit__(self, Assembler assembler, **kwargs):
+        """
+        Wrap the function FatigueDamage
+        """
+        cdef double ksWeight = 80.0
+        cdef double exponent = 3.0
+        cdef double refRange = 1.0
+
+        if 'ksWeight' in kwargs:
+            ksWeight = kwargs['ksWeight']
+
+        if 'exponent' in kwargs:
+            exponent = kwargs['exponent']
+
+        if 'refRange' in kwargs:
+            refRange = kwargs['refRange']
+
+        self.fptr = new TACSFatigueDamage(assembler.ptr, ksWeight, exponent,
+                                          refRange)
+        self.ptr = self.fptr
+        self.ptr.incref()
+
+        if 'component' in kwargs:
+            self.fptr.setStressComponent(kwargs['component'])
+        return
+
+    def setParameter(self, double ksparam):
+        self.fptr.setParameter(ksparam)
+
+    def getMaximumDamage(self):
+        return self.fptr.getMaximumDamage()
+
 cdef class KSDisplacement(Function):
     """
     The following class implements the methods to calculate the
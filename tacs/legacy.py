@@ -0,0 +1,112 @@
+"""
+Migration of the legacy element templates to the current elements.
+
+The templates in src/elements/direct (MITCShell, PlaneStressQuad,
+Solid, PoissonQuad and the coupled thermo elements) are no longer
+built. The names from tacs/TACSElementTemplates.h are mapped here to
+the equivalent element classes, which use the batched element
+kernels, the geometry cache and the tabulated basis functions.
+"""
+
+from tacs import elements
+
+__all__ = ["createLegacyElement", "getLegacyElementNames"]
+
+# The basis for the quadrilateral and hexahedral elements of each order
+_quad_bases = {
+    2: "LinearQuadBasis",
+    3: "QuadraticQuadBasis",
+    4: "CubicQuadBasis",
+    5: "QuarticQuadBasis",
+    6: "QuinticQuadBasis",
+}
+_hexa_bases = {
+    2: "LinearHexaBasis",
+    3: "QuadraticHexaBasis",
+    4: "CubicHexaBasis",
+}
+
+# The shell element for each order, without and with the nonlinear strain
+_shells = {
+    2: ("Quad4Shell", "Quad4NonlinearShell"),
+    3: ("Quad9Shell", "Quad9NonlinearShell"),
+    4: ("Quad16Shell", "Quad16NonlinearShell"),
+}
+
+# The legacy name prefixes and the (kind, model, elements, max order)
+# of the equivalent element
+_legacy = {
+    "MITCShell": ("shell", None, _shells, 5),
+    "PlaneStressQuad": ("2d", "LinearElasticity2D", _quad_bases, 5),
+    "PoissonQuad": ("2d", "HeatConduction2D", _quad_bases, 5),
+    "PSThermoQuad": ("2d", "LinearThermoelasticity2D", _quad_bases, 6),
+    "Solid": ("3d", "LinearElasticity3D", _hexa_bases, 5),
+    "SolidThermo": ("3d", "LinearThermoelasticity3D", _hexa_bases, 6),
+}
+
+
+def _splitName(name):
+    """Split a legacy name such as 'MITCShell2' into ('MITCShell', 2)"""
+    prefix = name.rstrip("0123456789")
+    if prefix == name or prefix not in _legacy:
+        return None, None
+    return prefix, int(name[len(prefix) :])
+
+
+def getLegacyElementNames():
+    """
+    Return the names of the legacy element templates that can be
+    migrated with createLegacyElement()
+    """
+    names = []
+    for prefix, (kind, model, orders, max_order) in _legacy.items():
+        for order in sorted(orders):
+            if order <= max_order:
+                names.append("%s%d" % (prefix, order))
+    return names
+
+
+def createLegacyElement(name, con, transform=None, nonlinear=False):
+    """
+    Create the current element equivalent to a legacy element template
+
+    Parameters
+    ----------
+    name : str
+        The legacy name, for instance 'MITCShell2', 'PlaneStressQuad3'
+        or 'Solid2'.
+    con : constitutive.Constitutive
+        The constitutive object for the element. This must be a shell,
+        plane stress or solid constitutive object to match the element.
+    transform : elements.ShellTransform, optional
+        The shell transform. The natural transform is used by default.
+    nonlinear : bool, optional
+        Use the nonlinear strain for the shell elements, in place of
+        the large rotation option of MITCShell.
+
+    Returns
+    -------
+    elem : elements.Element
+        The element object
+    """
+    prefix, order = _splitName(name)
+    if prefix is None:
+        raise ValueError("Unknown legacy element type '%s'" % name)
+
+    kind, model, orders, max_order = _legacy[prefix]
+    if order not in orders or order > max_order:
+        raise ValueError(
+            "Legacy element type '%s' has no equivalent element, "
+            "supported types are %s" % (name, getLegacyElementNames())
+        )
+
+    if kind == "shell":
+        if transform is None:
+            transform = elements.ShellNaturalTransform()
+        shell = orders[order][1 if nonlinear else 0]
+        return getattr(elements, shell)(transform, con)
+
+    basis = getattr(elements, orders[order])()
+    if kind == "2d":
+        return elements.Element2D(getattr(elements, model)(con), basis)
+    return elements.Element3D(getattr(elements, model)(con), basis)
@@ -54,6 +54,38 @@ class BucklingProblem(TACSProblem):
             15,
             "Max number of resets for Krylov solver used by Eigenvalue solver.",
         ],
+        "lanczosBasisSize": [
+            int,
+            100,
+            "Maximum size of the Lanczos basis used by Eigenvalue solver.",
+        ],
+        "lanczosBlockSize": [
+            int,
+            0,
+            "Block size for the thick-restart block Lanczos Eigenvalue solver.\n"
+            "\t 0 uses the single-vector Lanczos method. With block Lanczos, at most\n"
+            "\t lanczosBasisSize - 2 * lanczosBlockSize eigenvalues can be computed.",
+        ],
+        "lanczosMaxRestarts": [
+            int,
+            25,
+            "Max number of restarts for the block Lanczos Eigenvalue solver.",
+        ],
+        "trackModes": [
+            bool,
+            False,
+            "Flag for warm-starting the Eigenvalue solver with the previous\n"
+            "\t eigenvectors and tracking the modes between solves using the\n"
+            "\t modal assurance criterion. The eigenvalue functions then refer to\n"
+            "\t the modes from the first solve.",
+        ],
+        "matrixFreeGeometricStiffness": [
+            bool,
+            False,
+            "Flag for computing the products with the geometric stiffness\n"
+            "\t matrix matrix-free rather than assembling the matrix. This\n"
+            "\t reduces the memory required by the eigenvalue solver.",
+        ],
         # Output Options
         "writeSolution": [bool, True, "Flag for suppressing all f5 file writing."],
         "numberSolutions": [
@@ -157,8 +189,11 @@ class BucklingProblem(TACSProblem):
         self.auxElems = tacs.TACS.AuxElements()
 
         self.aux = self.assembler.createSchurMat()
-        self.G = self.assembler.createSchurMat()
         self.K = self.assembler.createSchurMat()
+        if self.getOption("matrixFreeGeometricStiffness"):
+            self.G = None
+        else:
+            self.G = self.assembler.createSchurMat()
 
         self.pc = tacs.TACS.Pc(self.K)
 
@@ -171,7 +206,10 @@ class BucklingProblem(TACSProblem):
         # Assemble and factor the stiffness/Jacobian matrix. Factor the
         # Jacobian and solve the linear system for the displacements
         self.assembler.assembleMatType(tacs.TACS.STIFFNESS_MATRIX, self.K)
-        self.assembler.assembleMatType(tacs.TACS.GEOMETRIC_STIFFNESS_MATRIX, self.G)
+        if self.G is not None:
+            self.assembler.assembleMatType(
+                tacs.TACS.GEOMETRIC_STIFFNESS_MATRIX, self.G
+            )
 
         subspace = self.getOption("subSpaceSize")
         restarts = self.getOption("nRestarts")
@@ -187,10 +225,20 @@ class BucklingProblem(TACSProblem):
             self.G,
             self.K,
             self.gmres,
+            max_lanczos=self.getOption("lanczosBasisSize"),
             num_eigs=self.numEigs,
             eig_tol=rtol,
         )
 
+        blockSize = self.getOption("lanczosBlockSize")
+        if blockSize > 0:
+            self.buckleSolver.setBlockLanczos(
+                blockSize, self.getOption("lanczosMaxRestarts")
+            )
+
+        if self.getOption("trackModes"):
+            self.buckleSolver.setWarmStart(True)
+
     def _initializeFunctionList(self):
         """
         Create FunctionList dict which maps eigenvalue strings
@@ -307,7 +355,7 @@ class BucklingProblem(TACSProblem):
 
         # Loop through each requested eigenvalue
         for funcName in evalFuncs:
-            mode_i = evalFuncs[funcName]
+            mode_i, _ = self.buckleSolver.getTrackedMode(evalFuncs[funcName])
             key = f"{self.name}_{funcName}"
             funcs[key], _ = self.getVariables(mode_i)
 
@@ -351,7 +399,10 @@ class BucklingProblem(TACSProblem):
         dvSens = self.assembler.createDesignVec()
         xptSens = self.assembler.createNodeVec()
 
-        indices = [evalFuncs[funcName] for funcName in evalFuncs]
+        indices = [
+            self.buckleSolver.getTrackedMode(evalFuncs[funcName])[0]
+            for funcName in evalFuncs
+        ]
         dvSensList = [self.assembler.createDesignVec() for funcName in evalFuncs]
         xptSensList = [self.assembler.createNodeVec() for funcName in evalFuncs]
         svSensList = [self.assembler.createVec() for funcName in evalFuncs]
@@ -832,16 +883,19 @@ class BucklingProblem(TACSProblem):
         # Set problem vars to assembler
         self._updateAssemblerVars()
 
-        for index, xptSens in zip(indices, xptSensList):
+        xptSensBVecList = []
+        for xptSens in xptSensList:
             # Create a tacs BVec copy for the operation if the output is a numpy array
             if isinstance(xptSens, np.ndarray):
-                xptSensBVec = self._arrayToNodeVec(xptSens)
+                xptSensBVecList.append(self._arrayToNodeVec(xptSens))
             # Otherwise the input is already a BVec and we can do the operation in place
             else:
-                xptSensBVec = xptSens
+                xptSensBVecList.append(xptSens)
 
-            self.buckleSolver.addEigenXptSens(scale, index, xptSensBVec)
+        # Add the contributions from all the modes in a single pass
+        self.buckleSolver.addEigenXptSensMulti(scale, indices, xptSensBVecList)
 
+        for xptSens, xptSensBVec in zip(xptSensList, xptSensBVecList):
             # Finalize sensitivity arrays across all procs
             xptSensBVec.beginSetValues()
             xptSensBVec.endSetValues()
@@ -869,16 +923,19 @@ class BucklingProblem(TACSProblem):
         # Set problem vars to assembler
         self._updateAssemblerVars()
 
-        for index, dvSens in zip(indices, dvSensList):
+        dvSensBVecList = []
+        for dvSens in dvSensList:
             # Create a tacs BVec copy for the operation if the output is a numpy array
             if isinstance(dvSens, np.ndarray):
-                dvSensBVec = self._arrayToDesignVec(dvSens)
+                dvSensBVecList.append(self._arrayToDesignVec(dvSens))
             # Otherwise the input is already a BVec and we can do the operation in place
             else:
-                dvSensBVec = dvSens
+                dvSensBVecList.append(dvSens)
 
-            self.buckleSolver.addEigenDVSens(scale, index, dvSensBVec)
+        # Add the contributions from all the modes in a single pass
+        self.buckleSolver.addEigenDVSensMulti(scale, indices, dvSensBVecList)
 
+        for dvSens, dvSensBVec in zip(dvSensList, dvSensBVecList):
             # Finalize sensitivity arrays across all procs
             dvSensBVec.beginSetValues()
             dvSensBVec.endSetValues()
@@ -54,6 +54,44 @@ class ModalProblem(TACSProblem):
             15,
             "Max number of resets for Krylov solver used by Eigenvalue solver.",
         ],
+        "lanczosBasisSize": [
+            int,
+            100,
+            "Maximum size of the Lanczos basis used by Eigenvalue solver.",
+        ],
+        "lanczosBlockSize": [
+            int,
+            0,
+            "Block size for the thick-restart block Lanczos Eigenvalue solver.\n"
+            "\t 0 uses the single-vector Lanczos method. With block Lanczos, at most\n"
+            "\t lanczosBasisSize - 2 * lanczosBlockSize eigenvalues can be computed.",
+        ],
+        "lanczosMaxRestarts": [
+            int,
+            25,
+            "Max number of restarts for the block Lanczos Eigenvalue solver.",
+        ],
+        "trackModes": [
+            bool,
+            False,
+            "Flag for warm-starting the Eigenvalue solver with the previous\n"
+            "\t eigenvectors and tracking the modes between solves using the\n"
+            "\t modal assurance criterion. The eigenvalue functions then refer to\n"
+            "\t the modes from the first solve.",
+        ],
+        "reducedBasisSize": [
+            int,
+            0,
+            "Maximum size of the reduced basis of cached modes and static shapes.\n"
+            "\t When nonzero, the eigenproblem is first projected onto the basis\n"
+            "\t and the full Eigenvalue solver is only used when the residual\n"
+            "\t exceeds reducedBasisTol.",
+        ],
+        "reducedBasisTol": [
+            float,
+            1e-3,
+            "Tolerance on the relative residual of the reduced basis eigenpairs.",
+        ],
         # Output Options
         "writeSolution": [bool, True, "Flag for suppressing all f5 file writing."],
         "numberSolutions": [
@@ -177,12 +215,28 @@ class ModalProblem(TACSProblem):
             self.M,
             self.K,
             self.gmres,
+            max_lanczos=self.getOption("lanczosBasisSize"),
             num_eigs=self.numEigs,
             eig_tol=atol,
             eig_atol=atol,
             eig_rtol=rtol,
         )
 
+        blockSize = self.getOption("lanczosBlockSize")
+        if blockSize > 0:
+            self.freqSolver.setBlockLanczos(
+                blockSize, self.getOption("lanczosMaxRestarts")
+            )
+
+        if self.getOption("trackModes"):
+            self.freqSolver.setWarmStart(True)
+
+        basisSize = self.getOption("reducedBasisSize")
+        if basisSize > 0:
+            self.freqSolver.setReducedBasis(
+                basisSize, self.getOption("reducedBasisTol")
+            )
+
     def _initializeFunctionList(self):
         """
         Create FunctionList dict which maps eigenvalue strings
@@ -299,7 +353,7 @@ class ModalProblem(TACSProblem):
 
         # Loop through each requested eigenvalue
         for funcName in evalFuncs:
-            mode_i = evalFuncs[funcName]
+            mode_i, _ = self.freqSolver.getTrackedMode(evalFuncs[funcName])
             key = f"{self.name}_{funcName}"
             funcs[key], _ = self.getVariables(mode_i)
 
@@ -340,20 +394,22 @@ class ModalProblem(TACSProblem):
                 if func in self.functionList:
                     evalFuncs[func] = self.functionList[func]
 
-        dvSens = self.assembler.createDesignVec()
-        xptSens = self.assembler.createNodeVec()
+        indices = [
+            self.freqSolver.getTrackedMode(evalFuncs[funcName])[0]
+            for funcName in evalFuncs
+        ]
+        dvSensList = [self.assembler.createDesignVec() for funcName in evalFuncs]
+        xptSensList = [self.assembler.createNodeVec() for funcName in evalFuncs]
 
-        # Loop through each requested eigenvalue
-        for funcName in evalFuncs:
-            mode_i = evalFuncs[funcName]
+        # Evaluate the dv and nodal sens for all the requested eigenvalues
+        self.freqSolver.evalEigenDVSensMulti(indices, dvSensList)
+        self.freqSolver.evalEigenXptSensMulti(indices, xptSensList)
+
+        for i, funcName in enumerate(evalFuncs):
             key = f"{self.name}_{funcName}"
             funcsSens[key] = {}
-            # Evaluate dv sens
-            self.freqSolver.evalEigenDVSens(mode_i, dvSens)
-            funcsSens[key][self.varName] = dvSens.getArray().copy()
-            # Evaluate nodal sens
-            self.freqSolver.evalEigenXptSens(mode_i, xptSens)
-            funcsSens[key][self.coordName] = xptSens.getArray().copy()
+            funcsSens[key][self.varName] = dvSensList[i].getArray().copy()
+            funcsSens[key][self.coordName] = xptSensList[i].getArray().copy()
 
     ####### Modal solver methods ########
 
@@ -34,7 +34,14 @@ class StaticProblem(TACSProblem):
         "linearSolver": [
             str,
             "GMRES",
-            "Krylov subspace method to use for linear solver. Currently only supports 'GMRES'",
+            "Krylov subspace method to use for linear solver.\n"
+            "\t Acceptable values are:\n"
+            "\t\t 'GMRES': right-preconditioned or flexible GMRES\n"
+            "\t\t 'PGMRES': pipelined GMRES that overlaps the reductions with the preconditioner and matrix products\n"
+            "\t\t 'SGMRES': s-step GMRES that performs one batch of reductions every 'sStepSize' iterations\n"
+            "\t\t 'BGMRES': block GMRES that solves the adjoints for all the functions together\n"
+            "\t\t 'BPCG': block PCG that solves the adjoints for all the functions together. "
+            "Requires a symmetric matrix and preconditioner",
         ],
         "nonlinearSolver": [
             str,
@@ -52,10 +59,51 @@ class StaticProblem(TACSProblem):
             f"\t\t tacs.TACS.TACS_AMD_ORDER = {tacs.TACS.TACS_AMD_ORDER}\n"
             f"\t\t tacs.TACS.MULTICOLOR_ORDER = {tacs.TACS.MULTICOLOR_ORDER}",
         ],
+        "preconditioner": [
+            str,
+            "Direct",
+            "Preconditioner to use for linear solver.\n"
+            "\t Acceptable values are:\n"
+            "\t\t 'Direct': the incomplete or full factorization of the stiffness matrix\n"
+            "\t\t 'Chebyshev': a Chebyshev polynomial of the factorization-preconditioned matrix\n"
+            "\t\t 'GMRESPolynomial': a GMRES polynomial of the factorization-preconditioned matrix\n"
+            "\t\t 'BDDC': balancing domain decomposition by constraints, which replaces the\n"
+            "\t\t factorization of the global interface problem with a small coarse problem\n"
+            "\t The polynomial preconditioners do not require any global reductions.",
+        ],
+        "polynomialDegree": [
+            int,
+            30,
+            "Maximum degree of the 'Chebyshev' and 'GMRESPolynomial' preconditioners.",
+        ],
+        "polynomialRtol": [
+            float,
+            1e-2,
+            "Target residual reduction used to select the degree of the polynomial preconditioners.",
+        ],
         "PCFillLevel": [int, 1000, "Preconditioner fill level."],
         "PCFillRatio": [float, 20.0, "Preconditioner fill ratio."],
+        "PCSchurOrdering": [
+            int,
+            1,
+            "Ordering of the global Schur complement in the direct factorization.\n"
+            "\t Acceptable values are:\n"
+            "\t\t 0: the natural ordering\n"
+            "\t\t 1: re-order fixed-size blocks of variables\n"
+            "\t\t 2: fill-reducing nodal ordering with one block for each supernode of the factor",
+        ],
         "subSpaceSize": [int, 10, "Subspace size for Krylov solver."],
         "nRestarts": [int, 15, "Max number of restarts for Krylov solver."],
+        "sStepSize": [
+            int,
+            4,
+            "Number of Krylov vectors generated between reductions for the 'SGMRES' linear solver.",
+        ],
+        "blockSize": [
+            int,
+            8,
+            "Maximum number of right-hand-sides solved together by the 'BGMRES' and 'BPCG' linear solvers.",
+        ],
         "flexible": [
             bool,
             True,
@@ -185,6 +233,9 @@ class StaticProblem(TACSProblem):
                     self.getOption("subSpaceSize"),
                     self.getOption("nRestarts"),
                     self.getOption("flexible"),
+                    method=self.getOption("linearSolver"),
+                    sstep=self.getOption("sStepSize"),
+                    block_size=self.getOption("blockSize"),
                 )
                 newtonLinearSolver.setTolerances(
                     self.getOption("L2ConvergenceRel"), self.getOption("L2Convergence")
@@ -195,6 +246,9 @@ class StaticProblem(TACSProblem):
                     self.getOption("subSpaceSize"),
                     self.getOption("nRestarts"),
                     self.getOption("flexible"),
+                    method=self.getOption("linearSolver"),
+                    sstep=self.getOption("sStepSize"),
+                    block_size=self.getOption("blockSize"),
                 )
                 continuationLinearSolver.setTolerances(
                     self.getOption("L2ConvergenceRel"), self.getOption("L2Convergence")
@@ -243,6 +297,10 @@ class StaticProblem(TACSProblem):
         self.dvSensList = OrderedDict()
         self.xptSensList = OrderedDict()
 
+        # Sensitivities from the last call to evalFunctionsSens and the
+        # state of the model they were computed for
+        self._sensCache = {}
+
         # Temporary vector for adjoint solve
         self.phi = self.assembler.createVec()
         self.adjRHS = self.assembler.createVec()
@@ -316,22 +374,52 @@ class StaticProblem(TACSProblem):
         # to isolate  artificial stiffness terms
         self.rbeArtificialStiffness.axpy(-1.0, self.K)
 
-        reorderSchur = 1
-        self.PC = tacs.TACS.Pc(
-            self.K,
-            lev_fill=opt("PCFillLevel"),
-            ratio_fill=opt("PCFillRatio"),
-            reorder=reorderSchur,
-        )
+        reorderSchur = opt("PCSchurOrdering")
+        if opt("preconditioner").upper() == "BDDC":
+            self.PC = tacs.TACS.BDDCPc(
+                self.K,
+                lev_fill=opt("PCFillLevel"),
+                ratio_fill=opt("PCFillRatio"),
+            )
+        else:
+            self.PC = tacs.TACS.Pc(
+                self.K,
+                lev_fill=opt("PCFillLevel"),
+                ratio_fill=opt("PCFillRatio"),
+                reorder=reorderSchur,
+            )
+        if opt("preconditioner").upper() == "CHEBYSHEV":
+            self.PC = tacs.TACS.ChebyshevPc(
+                self.K,
+                max_degree=opt("polynomialDegree"),
+                pc=self.PC,
+                rtol=opt("polynomialRtol"),
+            )
+        elif opt("preconditioner").upper() == "GMRESPOLYNOMIAL":
+            self.PC = tacs.TACS.GMRESPolynomialPc(
+                self.K,
+                max_degree=opt("polynomialDegree"),
+                pc=self.PC,
+                rtol=opt("polynomialRtol"),
+            )
 
         # Operator, fill level, fill ratio, msub, rtol, ataol
-        if opt("linearSolver").upper() == "GMRES":
+        if opt("linearSolver").upper() in [
+            "GMRES",
+            "PGMRES",
+            "SGMRES",
+            "BGMRES",
+            "BPCG",
+        ]:
             self.linearSolver = tacs.TACS.KSM(
                 self.K,
                 self.PC,
                 opt("subSpaceSize"),
                 opt("nRestarts"),
                 opt("flexible"),
+                method=opt("linearSolver"),
+                sstep=opt("sStepSize"),
+                block_size=opt("blockSize"),
             )
         # TODO: Fix this
         # elif opt('linearSolver').upper() == 'GCROT':
@@ -492,6 +580,7 @@ class StaticProblem(TACSProblem):
             self.dIduList[funcName] = self.assembler.createVec()
             self.dvSensList[funcName] = self.assembler.createDesignVec()
             self.xptSensList[funcName] = self.assembler.createNodeVec()
+            self._sensCache.pop(funcName, None)
         return success
 
     def setDesignVars(self, x):
@@ -1169,64 +1258,102 @@ class StaticProblem(TACSProblem):
         else:
             evalFuncs = sorted(list(evalFuncs))
         # Check that the functions are all ok.
-        # and prepare tacs vecs for adjoint procedure
-        dvSenses = []
-        xptSenses = []
-        dIdus = []
-        adjoints = []
         for f in evalFuncs:
             if f not in self.functionList:
                 raise self._TACSError(
                     "Supplied function has not been added " "using addFunction()"
                 )
-            else:
-                # Populate the lists with the tacs bvecs
-                # we'll need for each adjoint/sens calculation
-                dvSens = self.dvSensList[f]
-                dvSens.zeroEntries()
-                dvSenses.append(dvSens)
 
-                xptSens = self.xptSensList[f]
-                xptSens.zeroEntries()
-                xptSenses.append(xptSens)
+        # The sensitivities are re-used when the design variables, nodes,
+        # states, body loads and load scale are unchanged since they were
+        # computed
+        modelKey = (
+            self.assembler.getVersions(),
+            self.assembler.getSimulationTime(),
+            self._loadScale,
+        )
+        solveFuncs = []
+        for f in evalFuncs:
+            cached = self._sensCache.get(f)
+            if (
+                cached is None
+                or cached[0] != modelKey
+                or cached[1] is not self.functionList[f]
+            ):
+                solveFuncs.append(f)
+
+        # Prepare tacs vecs for adjoint procedure
+        dvSenses = []
+        xptSenses = []
+        dIdus = []
+        adjoints = []
+        for f in solveFuncs:
+            # Populate the lists with the tacs bvecs
+            # we'll need for each adjoint/sens calculation
+            dvSens = self.dvSensList[f]
+            dvSens.zeroEntries()
+            dvSenses.append(dvSens)
 
-                dIdu = self.dIduList[f]
-                dIdu.zeroEntries()
-                dIdus.append(dIdu)
+            xptSens = self.xptSensList[f]
+            xptSens.zeroEntries()
+            xptSenses.append(xptSens)
 
-                adjoint = self.adjointList[f]
-                adjoint.zeroEntries()
-                adjoints.append(adjoint)
+            dIdu = self.dIduList[f]
+            dIdu.zeroEntries()
+            dIdus.append(dIdu)
+
+            adjoint = self.adjointList[f]
+            adjoint.zeroEntries()
+            adjoints.append(adjoint)
 
         setupProblemTime = time.time()
 
         adjointStartTime = {}
         adjointEndTime = {}
 
-        # Next we will solve all the adjoints
-        # Set adjoint rhs
-        self.addSVSens(evalFuncs, dIdus)
-        adjointRHSTime = time.time()
-        for i, f in enumerate(evalFuncs):
-            adjointStartTime[f] = time.time()
-            self.solveAdjoint(dIdus[i], adjoints[i])
-            adjointEndTime[f] = time.time()
+        adjointRHSTime = setupProblemTime
+        if len(solveFuncs) > 0:
+            # Next we will solve all the adjoints
+            # Set adjoint rhs
+            self.addSVSens(solveFuncs, dIdus)
+            adjointRHSTime = time.time()
+            if self.getOption("linearSolver").upper() in ["BGMRES", "BPCG"]:
+                # Solve all the adjoints together with the block solver
+                self.solveAdjointMulti(dIdus, adjoints)
+                for f in solveFuncs:
+                    adjointStartTime[f] = adjointRHSTime
+                    adjointEndTime[f] = time.time()
+            else:
+                for i, f in enumerate(solveFuncs):
+                    adjointStartTime[f] = time.time()
+                    self.solveAdjoint(dIdus[i], adjoints[i])
+                    adjointEndTime[f] = time.time()
 
         adjointFinishedTime = time.time()
-        # Evaluate all the adoint res prooduct at the same time for
-        # efficiency:
-        self.addDVSens(evalFuncs, dvSenses)
-        self.addAdjointResProducts(adjoints, dvSenses)
-        self.addXptSens(evalFuncs, xptSenses)
-        self.addAdjointResXptSensProducts(adjoints, xptSenses)
+        if len(solveFuncs) > 0:
+            # Evaluate all the adoint res prooduct at the same time for
+            # efficiency:
+            self.addDVSens(solveFuncs, dvSenses)
+            self.addAdjointResProducts(adjoints, dvSenses)
+            self.addXptSens(solveFuncs, xptSenses)
+            self.addAdjointResXptSensProducts(adjoints, xptSenses)
+
+        for i, f in enumerate(solveFuncs):
+            self._sensCache[f] = (
+                modelKey,
+                self.functionList[f],
+                dvSenses[i].getArray().copy(),
+                xptSenses[i].getArray().copy(),
+            )
 
         # Recast sensititivities into dict for user
-        for i, f in enumerate(evalFuncs):
+        for f in evalFuncs:
             key = self.name + "_%s" % f
+            cached = self._sensCache[f]
             # Return sensitivities as array in sens dict
             funcsSens[key] = {
-                self.varName: dvSenses[i].getArray().copy(),
-                self.coordName: xptSenses[i].getArray().copy(),
+                self.varName: cached[2].copy(),
+                self.coordName: cached[3].copy(),
             }
 
         totalSensitivityTime = time.time()
@@ -1244,7 +1371,7 @@ class StaticProblem(TACSProblem):
                 "| %-30s: %10.3f sec"
                 % ("TACS Adjoint RHS Time", adjointRHSTime - setupProblemTime)
             )
-            for f in evalFuncs:
+            for f in solveFuncs:
                 self._pp(
                     "| %-30s: %10.3f sec"
                     % (
@@ -1269,6 +1396,163 @@ class StaticProblem(TACSProblem):
             )
             self._pp("+--------------------------------------------------+")
 
+    def evalFunctionsSensDirect(self, funcsSens, evalFuncs=None, xptDirections=None):
+        """
+        Evaluate the derivatives of the functions with the direct (forward)
+        method. This requires one linear solve for each design variable and
+        each node location direction, instead of one solve for each function,
+        and reuses the factorization of the Jacobian. This is cheaper than
+        the adjoint method in :meth:`evalFunctionsSens` when there are few
+        design variables and many functions.
+
+        The derivatives w.r.t. the design variables are returned in the same
+        form as :meth:`evalFunctionsSens`. The derivatives w.r.t. the node
+        locations are only computed along the directions in xptDirections.
+
+        Parameters
+        ----------
+        funcsSens : dict
+            Dictionary into which the derivatives are saved.
+        evalFuncs : iterable object containing strings
+            The functions the user wants returned
+        xptDirections : list[tacs.TACS.Vec] or list[numpy.ndarray]
+            Optional list of node location directions. The directional
+            derivatives are saved as an array under the key
+            coordName + 'Directions'.
+
+        Examples
+        --------
+        >>> funcsSens = {}
+        >>> staticProblem.evalFunctionsSensDirect(funcsSens, ['ks_vmfailure'])
+        >>> funcsSens
+        >>> # Result will look like (if StaticProblem has name of 'c1'):
+        >>> # {'c1_ks_vmfailure':{'struct':[1.234, ..., 7.89]}}
+        """
+
+        startTime = time.time()
+
+        # Set problem vars to assembler
+        self._updateAssemblerVars()
+
+        # Make sure the Jacobian is assembled and factored
+        self._initializeSolve()
+
+        if evalFuncs is None:
+            evalFuncs = sorted(list(self.functionList))
+        else:
+            evalFuncs = sorted(list(evalFuncs))
+
+        dvSenses = []
+        dIdus = []
+        for f in evalFuncs:
+            if f not in self.functionList:
+                raise self._TACSError(
+                    "Supplied function has not been added " "using addFunction()"
+                )
+            else:
+                dvSens = self.dvSensList[f]
+                dvSens.zeroEntries()
+                dvSenses.append(dvSens)
+
+                dIdu = self.dIduList[f]
+                dIdu.zeroEntries()
+                dIdus.append(dIdu)
+
+        if xptDirections is None:
+            xptDirections = []
+
+        # Evaluate the explicit derivatives of the functions
+        self.addSVSens(evalFuncs, dIdus)
+        self.addDVSens(evalFuncs, dvSenses)
+
+        # Create a unit direction for each global design variable
+        dvVec = self.assembler.createDesignVec()
+        nLocal = dvVec.getSize()
+        offsets = np.cumsum([0] + self.comm.allgather(nLocal))
+        start = offsets[self.comm.rank]
+        dirs = []
+        for j in range(offsets[-1]):
+            dx = self.assembler.createDesignVec()
+            if start <= j < start + nLocal:
+                dx.getArray()[j - start] = 1.0
+            dirs.append(dx)
+
+        # Form the right-hand-sides in a single pass over the elements
+        dvRHS = [self.assembler.createVec() for j in range(len(dirs))]
+        if len(dirs) > 0:
+            self.assembler.addResDVProducts(dirs, dvRHS, -1.0)
+
+        xptDirs = []
+        for xptDir in xptDirections:
+            if isinstance(xptDir, np.ndarray):
+                xptDirs.append(self._arrayToNodeVec(xptDir))
+            else:
+                xptDirs.append(xptDir)
+        xptRHS = [self.assembler.createVec() for j in range(len(xptDirs))]
+        if len(xptDirs) > 0:
+            self.assembler.addResXptProducts(xptDirs, xptRHS, -1.0)
+
+        setupTime = time.time()
+
+        # Solve for the state derivative along each direction and take
+        # the product with the derivative of each function
+        du = self.assembler.createVec()
+        for j, rhs in enumerate(dvRHS):
+            self.linearSolver.solve(rhs, du)
+            self.assembler.applyBCs(du)
+            for i in range(len(evalFuncs)):
+                prod = dIdus[i].dot(du)
+                if start <= j < start + nLocal:
+                    dvSenses[i].getArray()[j - start] += prod
+
+        xptDirSens = np.zeros((len(evalFuncs), len(xptDirs)), dtype=self.dtype)
+        if len(xptDirs) > 0:
+            xptSenses = []
+            for f in evalFuncs:
+                xptSens = self.xptSensList[f]
+                xptSens.zeroEntries()
+                xptSenses.append(xptSens)
+            self.addXptSens(evalFuncs, xptSenses)
+
+            for j, rhs in enumerate(xptRHS):
+                self.linearSolver.solve(rhs, du)
+                self.assembler.applyBCs(du)
+                for i in range(len(evalFuncs)):
+                    xptDirSens[i, j] = xptSenses[i].dot(xptDirs[j]) + dIdus[i].dot(
+                        du
+                    )
+
+        solveTime = time.time()
+
+        # Recast sensititivities into dict for user
+        for i, f in enumerate(evalFuncs):
+            key = self.name + "_%s" % f
+            funcsSens[key] = {self.varName: dvSenses[i].getArray().copy()}
+            if len(xptDirs) > 0:
+                funcsSens[key][self.coordName + "Directions"] = xptDirSens[i].copy()
+
+        if self.getOption("printTiming"):
+            self._pp("+--------------------------------------------------+")
+            self._pp("|")
+            self._pp("| TACS Direct Sensitivity Times:")
+            self._pp("|")
+            self._pp(
+                "| %-30s: %10.3f sec" % ("TACS Direct RHS Time", setupTime - startTime)
+            )
+            self._pp(
+                "| %-30s: %10.3f sec"
+                % (
+                    "TACS Direct Solve Time (%d)" % (len(dvRHS) + len(xptRHS)),
+                    solveTime - setupTime,
+                )
+            )
+            self._pp("|")
+            self._pp(
+                "| %-30s: %10.3f sec"
+                % ("Complete Sensitivity Time", solveTime - startTime)
+            )
+            self._pp("+--------------------------------------------------+")
+
     def addSVSens(self, evalFuncs, svSensList):
         """
         Add the state variable partial sensitivity to the ADjoint RHS for given evalFuncs
@@ -1722,6 +2006,72 @@ class StaticProblem(TACSProblem):
         elif isinstance(phi, np.ndarray):
             phi[:] = self.phi.getArray()
 
+    def solveAdjointMulti(self, rhsList, phiList):
+        """
+        Solve the structural adjoint for several right-hand-sides. With
+        the 'BGMRES' or 'BPCG' linear solvers, the adjoints are solved
+        together, otherwise each adjoint is solved in turn.
+
+        Parameters
+        ----------
+        rhsList : list[tacs.TACS.Vec or numpy.ndarray]
+            right hand side vectors for the adjoint solves
+        phiList : list[tacs.TACS.Vec or numpy.ndarray]
+            BVecs or numpy arrays into which the adjoints are saved
+        """
+
+        if len(rhsList) != len(phiList):
+            raise self._TACSError(
+                "The number of right hand sides and adjoint vectors must be equal"
+            )
+
+        # Set problem vars to assembler
+        self._updateAssemblerVars()
+
+        # Check if we need to initialize
+        self._initializeSolve()
+
+        rhsVecs = []
+        phiVecs = []
+        bcVecs = []
+        for rhs, phi in zip(rhsList, phiList):
+            # Create copies of the adjoint/rhs guesses
+            phiVec = self.assembler.createVec()
+            if isinstance(phi, tacs.TACS.Vec):
+                phiVec.copyValues(phi)
+            elif isinstance(phi, np.ndarray):
+                phiVec.getArray()[:] = phi
+
+            rhsVec = self.assembler.createVec()
+            if isinstance(rhs, tacs.TACS.Vec):
+                rhsVec.copyValues(rhs)
+            elif isinstance(rhs, np.ndarray):
+                rhsVec.getArray()[:] = rhs
+
+            # Keep track of the RHS entries that TACS zeros out for BCs
+            bcTerms = self.assembler.createVec()
+            bcTerms.copyValues(rhsVec)
+            self.assembler.applyBCs(rhsVec)
+            bcTerms.axpy(-1.0, rhsVec)
+
+            rhsVecs.append(rhsVec)
+            phiVecs.append(phiVec)
+            bcVecs.append(bcTerms)
+
+        # Solve the linear systems together
+        self.linearSolver.solveMulti(rhsVecs, phiVecs)
+
+        for phi, phiVec, bcTerms in zip(phiList, phiVecs, bcVecs):
+            self.assembler.applyBCs(phiVec)
+            # Add bc terms back in
+            phiVec.axpy(1.0, bcTerms)
+
+            # Copy output values back to user vectors
+            if isinstance(phi, tacs.TACS.Vec):
+                phi.copyValues(phiVec)
+            elif isinstance(phi, np.ndarray):
+                phi[:] = phiVec.getArray()
+
     def getVariables(self, states=None):
         """
         Return the current state values for the
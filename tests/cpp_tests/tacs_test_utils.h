@@ -0,0 +1,274 @@
+/*
+  Helpers shared by the C++ regression tests
+
+  Each test program builds a small model, compares two code paths that
+  are expected to agree and prints one line for each comparison. The
+  program returns a non-zero exit code when any comparison fails, so
+  that the tests can be run with "make test" or through
+  test_cpp_regression.py.
+*/
+
+#ifndef TACS_TEST_UTILS_H
+#define TACS_TEST_UTILS_H
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "TACSAssembler.h"
+#include "TACSCreator.h"
+#include "TACSElement2D.h"
+#include "TACSLinearElasticity.h"
+#include "TACSQuadBasis.h"
+
+// The number of failed comparisons
+static int tacs_test_num_failures = 0;
+
+/*
+  Record a comparison that passes when err <= tol
+
+  The largest error over all processors is used, so the result is the
+  same on every processor. The call is collective on comm.
+*/
+inline int TacsTestCheck(MPI_Comm comm, const char *name, double err,
+                         double tol) {
+  double max_err = err;
+  MPI_Allreduce(&err, &max_err, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+  // The comparison is written so that a NaN fails
+  int fail = !(max_err <= tol);
+  if (fail) {
+    tacs_test_num_failures++;
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    printf("%-56s %11.4e  tol %9.2e  %s\n", name, max_err, tol,
+           fail ? "FAILED" : "passed");
+  }
+  return fail;
+}
+
+/*
+  Print the summary and return the exit code for the test program
+*/
+inline int TacsTestFinish(MPI_Comm comm) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    if (tacs_test_num_failures) {
+      printf("%d comparison(s) FAILED\n", tacs_test_num_failures);
+    } else {
+      printf("All comparisons passed\n");
+    }
+  }
+  return (tacs_test_num_failures ? 1 : 0);
+}
+
+/*
+  Compute the relative difference ||a - b||/||b|| of the real parts of
+  two vectors with the same layout. This is collective.
+*/
+inline double TacsTestRelError(TACSBVec *a, TACSBVec *b) {
+  TacsScalar *x, *y;
+  int size = a->getArray(&x);
+  b->getArray(&y);
+
+  double local[2] = {0.0, 0.0};
+  for (int i = 0; i < size; i++) {
+    double d = TacsRealPart(x[i]) - TacsRealPart(y[i]);
+    local[0] += d * d;
+    local[1] += TacsRealPart(y[i]) * TacsRealPart(y[i]);
+  }
+
+  double global[2];
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_SUM, a->getMPIComm());
+  if (global[1] == 0.0) {
+    return sqrt(global[0]);
+  }
+  return sqrt(global[0] / global[1]);
+}
+
+/*
+  Compute the relative difference between two matrices from their
+  products with the vector x, using y1 and y2 as temporary vectors
+*/
+inline double TacsTestMatRelError(TACSMat *A, TACSMat *B, TACSBVec *x,
+                                  TACSBVec *y1, TACSBVec *y2) {
+  A->mult(x, y1);
+  B->mult(x, y2);
+  return TacsTestRelError(y1, y2);
+}
+
+/*
+  Compute the relative residual ||b - A*x||/||b|| of a linear solve,
+  using r as a temporary vector
+*/
+inline double TacsTestResidual(TACSMat *A, TACSBVec *x, TACSBVec *b,
+                               TACSBVec *r) {
+  A->mult(x, r);
+  r->axpby(1.0, -1.0, b);
+  return TacsRealPart(r->norm()) / TacsRealPart(b->norm());
+}
+
+/*
+  Compute the relative difference ||a - b||/||b|| of the real parts of
+  two arrays of length n
+*/
+inline double TacsTestRelError(int n, const TacsScalar a[],
+                               const TacsScalar b[]) {
+  double diff = 0.0, norm = 0.0;
+  for (int i = 0; i < n; i++) {
+    double d = TacsRealPart(a[i]) - TacsRealPart(b[i]);
+    diff += d * d;
+    norm += TacsRealPart(b[i]) * TacsRealPart(b[i]);
+  }
+  if (norm == 0.0) {
+    return sqrt(diff);
+  }
+  return sqrt(diff / norm);
+}
+
+/*
+  Compute the relative difference between two scalars
+*/
+inline double TacsTestRelError(TacsScalar a, TacsScalar b) {
+  double d = fabs(TacsRealPart(a) - TacsRealPart(b));
+  if (TacsRealPart(b) != 0.0) {
+    return d / fabs(TacsRealPart(b));
+  }
+  return d;
+}
+
+/*
+  Create a model of nx x ny quadrilateral elements of the given order
+  on the unit square, with the nodes on the edge x = 0 fixed
+
+  The element objects are assigned in the pattern (i + j) % num_elems,
+  so neighbouring elements use different objects when num_elems > 1.
+  The plate is curved by z = zscale*x*y so that shell models couple
+  the membrane and bending response.
+
+  input:
+  comm:           the communicator
+  vars_per_node:  the number of variables at each node
+  order:          the number of nodes along each element edge
+  nx, ny:         the number of elements along each edge
+  num_elems:      the number of element objects
+  elems:          the element objects
+  zscale:         the out-of-plane curvature of the plate
+  part:           the processor of each element (on the root), or NULL
+                  to use the default partition
+
+  returns:        the assembler object
+*/
+inline TACSAssembler *TacsTestCreateQuadModel(MPI_Comm comm,
+                                              int vars_per_node, int order,
+                                              int nx, int ny, int num_elems,
+                                              TACSElement **elems,
+                                              double zscale = 0.0,
+                                              const int *part = NULL) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TACSCreator *creator = new TACSCreator(comm, vars_per_node);
+  creator->incref();
+
+  if (rank == 0) {
+    int mx = (order - 1) * nx + 1;
+    int my = (order - 1) * ny + 1;
+    int num_nodes = mx * my;
+    int num_elements = nx * ny;
+
+    int *ptr = new int[num_elements + 1];
+    int *conn = new int[order * order * num_elements];
+    int *ids = new int[num_elements];
+    ptr[0] = 0;
+    for (int j = 0; j < ny; j++) {
+      for (int i = 0; i < nx; i++) {
+        int elem = i + nx * j;
+        int *c = &conn[order * order * elem];
+        for (int jj = 0; jj < order; jj++) {
+          for (int ii = 0; ii < order; ii++) {
+            c[ii + order * jj] =
+                (order - 1) * i + ii + mx * ((order - 1) * j + jj);
+          }
+        }
+        ptr[elem + 1] = ptr[elem] + order * order;
+        ids[elem] = (i + j) % num_elems;
+      }
+    }
+    creator->setGlobalConnectivity(num_nodes, num_elements, ptr, conn, ids);
+    delete[] ptr;
+    delete[] conn;
+    delete[] ids;
+
+    int *bc_nodes = new int[my];
+    for (int j = 0; j < my; j++) {
+      bc_nodes[j] = mx * j;
+    }
+    creator->setBoundaryConditions(my, bc_nodes);
+    delete[] bc_nodes;
+
+    TacsScalar *Xpts = new TacsScalar[3 * num_nodes];
+    for (int j = 0; j < my; j++) {
+      for (int i = 0; i < mx; i++) {
+        int node = i + mx * j;
+        double x = 1.0 * i / (mx - 1);
+        double y = 1.0 * j / (my - 1);
+        Xpts[3 * node] = x;
+        Xpts[3 * node + 1] = y;
+        Xpts[3 * node + 2] = zscale * x * y;
+      }
+    }
+    creator->setNodes(Xpts);
+    delete[] Xpts;
+
+    if (part) {
+      int size;
+      MPI_Comm_size(comm, &size);
+      creator->partitionMesh(size, part);
+    }
+  }
+
+  creator->setElements(num_elems, elems);
+  TACSAssembler *assembler = creator->createTACS();
+  creator->decref();
+
+  return assembler;
+}
+
+/*
+  Create a linear plane stress model of nx x ny bilinear elements on
+  the unit square with the edge x = 0 fixed
+
+  The elastic modulus of the element objects increases by a factor of
+  stiff_ratio from one object to the next, so that the model is not
+  uniformly conditioned when num_elems > 1.
+*/
+inline TACSAssembler *TacsTestCreatePlaneStressModel(MPI_Comm comm, int nx,
+                                                     int ny,
+                                                     int num_elems = 1,
+                                                     double stiff_ratio = 1.0) {
+  TACSElement **elems = new TACSElement *[num_elems];
+  TACSElementBasis *basis = new TACSLinearQuadBasis();
+  double E = 70e3;
+  for (int k = 0; k < num_elems; k++, E *= stiff_ratio) {
+    TACSMaterialProperties *props =
+        new TACSMaterialProperties(2700.0, 921.0, E, 0.3, 270.0, 24e-6, 230.0);
+    TACSPlaneStressConstitutive *stiff =
+        new TACSPlaneStressConstitutive(props);
+    TACSLinearElasticity2D *model =
+        new TACSLinearElasticity2D(stiff, TACS_LINEAR_STRAIN);
+    elems[k] = new TACSElement2D(model, basis);
+  }
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 2, 2, nx, ny, num_elems, elems);
+  delete[] elems;
+
+  return assembler;
+}
+
+#endif  // TACS_TEST_UTILS_H
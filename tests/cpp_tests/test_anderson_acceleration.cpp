@@ -0,0 +1,227 @@
+/*
+  Check Anderson acceleration of the Newton iterations with a frozen
+  Jacobian
+
+  A nonlinear plane stress model under a body load is integrated in
+  time with BDF2 and ESDIRK with Jacobian reuse, with and without
+  Anderson acceleration. Every time step must converge, and the
+  acceleration must reduce the number of factorizations while the
+  function values remain unchanged up to the Newton tolerance. The
+  adjoint gradients are compared for BDF2, since the ESDIRK integrator
+  has no adjoint. The same model is then loaded with arc-length
+  continuation, where the acceleration must reduce the number of
+  corrector iterations and reach the same point on the load path.
+*/
+
+#include "KSM.h"
+#include "TACSContinuation.h"
+#include "TACSIntegrator.h"
+#include "TACSKSFailure.h"
+#include "TACSSchurMat.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_LOAD_STEPS = 15;
+
+/*
+  Count the corrector iterations from the lines printed by the
+  arc-length continuation
+*/
+class TestCorrectorPrint : public KSMPrint {
+ public:
+  TestCorrectorPrint() { iters = 0; }
+  void printResidual(int iter, TacsScalar res) {}
+  void print(const char *cstr) {
+    int j;
+    double t, res, lambda, unorm;
+    if (sscanf(cstr, "%d %lf %lf %lf %lf", &j, &t, &res, &lambda, &unorm) ==
+            5 &&
+        j > 0) {
+      iters++;
+    }
+  }
+  int iters;
+};
+
+/*
+  Create the nonlinear model with two thickness design variables
+*/
+static TACSAssembler *create_model(MPI_Comm comm) {
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSElementBasis *basis = new TACSLinearQuadBasis();
+  TACSElement *elems[2];
+  for (int k = 0; k < 2; k++) {
+    TACSPlaneStressConstitutive *stiff =
+        new TACSPlaneStressConstitutive(props, 1.0 - 0.2 * k, k);
+    TACSLinearElasticity2D *model =
+        new TACSLinearElasticity2D(stiff, TACS_NONLINEAR_STRAIN);
+    elems[k] = new TACSElement2D(model, basis);
+  }
+
+  return TacsTestCreateQuadModel(comm, 2, 2, 16, 16, 2, elems);
+}
+
+/*
+  Integrate in time and return the number of factorizations, the
+  function value, the gradient and the failure flag
+*/
+static int integrate(TACSAssembler *assembler, int use_esdirk, int depth,
+                     TacsScalar *fval, TACSBVec *dfdx, int *fail) {
+  TACSIntegrator *integrator;
+  if (use_esdirk) {
+    integrator = new TACSESDIRKIntegrator(assembler, 0.0, 1.0, 40.0, 4);
+  } else {
+    integrator = new TACSBDFIntegrator(assembler, 0.0, 1.0, 40.0, 2);
+  }
+  integrator->incref();
+  integrator->setUseSchurMat(1, TACSAssembler::TACS_AMD_ORDER);
+  integrator->setRelTol(1e-10);
+  integrator->setAbsTol(1e-12);
+  integrator->setMaxNewtonIters(50);
+  integrator->setJacobianReuse(1, 0.1);
+  if (depth > 0) {
+    integrator->setAndersonAcceleration(depth);
+  }
+
+  TACSFunction *func = new TACSKSFailure(assembler, 20.0);
+  integrator->setFunctions(1, &func);
+
+  *fail = integrator->integrate();
+  integrator->evalFunctions(fval);
+  if (!use_esdirk) {
+    integrator->integrateAdjoint();
+
+    TACSBVec *grad;
+    integrator->getGradient(0, &grad);
+    dfdx->copyValues(grad);
+  }
+
+  int num_factor;
+  integrator->getJacobianReuseStatistics(&num_factor, NULL);
+  integrator->decref();
+
+  return num_factor;
+}
+
+/*
+  Trace the load path with arc-length continuation and return the
+  number of corrector iterations, the number of completed load steps
+  and the final load factor
+*/
+static int continuation(TACSAssembler *assembler, TACSBVec *load, int depth,
+                        int *nsteps, TacsScalar *lambda) {
+  TACSSchurMat *mat = assembler->createSchurMat();
+  TACSSchurPc *pc = new TACSSchurPc(mat, 10000, 10.0, 1);
+  GMRES *ksm = new GMRES(mat, pc, 20, 2, 0);
+  ksm->incref();
+
+  TACSContinuation *cont = new TACSContinuation(assembler, NUM_LOAD_STEPS);
+  cont->incref();
+  if (depth > 0) {
+    cont->setAndersonAcceleration(depth);
+  }
+
+  TestCorrectorPrint *print = new TestCorrectorPrint();
+  print->incref();
+  cont->solve_tangent(mat, pc, ksm, load, 0.0, 0.2, print);
+  int iters = print->iters;
+
+  TacsScalar dlambda_ds;
+  *nsteps = cont->getNumIterations();
+  cont->getSolution(*nsteps - 1, lambda, &dlambda_ds);
+
+  print->decref();
+  cont->decref();
+  ksm->decref();
+
+  return iters;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSAssembler *assembler = create_model(comm);
+  assembler->incref();
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Time integration under a body load
+  const TacsScalar gravity[3] = {0.0, -1.5, 0.0};
+  assembler->setBodyLoads(gravity);
+
+  TACSBVec *dfdx0 = assembler->createDesignVec();
+  TACSBVec *dfdx1 = assembler->createDesignVec();
+  dfdx0->incref();
+  dfdx1->incref();
+
+  const int depth = 5;
+  for (int use_esdirk = 0; use_esdirk < 2; use_esdirk++) {
+    const char *type = (use_esdirk ? "ESDIRK" : "BDF2");
+
+    TacsScalar f0, f1;
+    int fail0, fail1;
+    int nfactor0 = integrate(assembler, use_esdirk, 0, &f0, dfdx0, &fail0);
+    int nfactor1 = integrate(assembler, use_esdirk, depth, &f1, dfdx1, &fail1);
+
+    if (rank == 0) {
+      printf("%s factorizations: %d without, %d with acceleration\n", type,
+             nfactor0, nfactor1);
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "%s integration converges", type);
+    TacsTestCheck(comm, name, fail0 || fail1, 0.0);
+    snprintf(name, sizeof(name), "%s accelerated/plain factorizations", type);
+    TacsTestCheck(comm, name, (1.0 * nfactor1) / nfactor0, 0.95);
+    snprintf(name, sizeof(name), "%s function value", type);
+    TacsTestCheck(comm, name, TacsTestRelError(f1, f0), 1e-8);
+    if (!use_esdirk) {
+      snprintf(name, sizeof(name), "%s adjoint gradient", type);
+      TacsTestCheck(comm, name, TacsTestRelError(dfdx1, dfdx0), 1e-8);
+    }
+  }
+  assembler->clearBodyLoads();
+
+  // Discard the velocities and accelerations from the time integration
+  assembler->zeroVariables();
+  assembler->zeroDotVariables();
+  assembler->zeroDDotVariables();
+
+  // Arc-length continuation under a load on all the nodes
+  TACSBVec *load = assembler->createVec();
+  load->incref();
+  TacsScalar *f;
+  int size = load->getArray(&f);
+  for (int i = 0; i < size; i += 2) {
+    f[i + 1] = -5.0;
+  }
+  assembler->applyBCs(load);
+
+  TacsScalar lambda0, lambda1;
+  int nsteps0, nsteps1;
+  int iters0 = continuation(assembler, load, 0, &nsteps0, &lambda0);
+  int iters1 = continuation(assembler, load, depth, &nsteps1, &lambda1);
+  if (rank == 0) {
+    printf("Corrector iterations: %d without, %d with acceleration\n",
+           iters0, iters1);
+  }
+
+  TacsTestCheck(comm, "continuation completes the load steps",
+                nsteps0 < NUM_LOAD_STEPS || nsteps1 < NUM_LOAD_STEPS, 0.0);
+  TacsTestCheck(comm, "continuation accelerated/plain corrector iterations",
+                (1.0 * iters1) / iters0, 0.9);
+  TacsTestCheck(comm, "continuation final load factor",
+                TacsTestRelError(lambda1, lambda0), 1e-6);
+
+  load->decref();
+  dfdx0->decref();
+  dfdx1->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,246 @@
+/*
+  Check the BCSR block kernels against a dense reference
+
+  For each block size, a block matrix with an unsymmetric non-zero
+  pattern is created and the products, the transpose product, a
+  forward SOR sweep and a solve with the complete factorization are
+  compared against the same operations on the dense matrix. Block
+  sizes 7 and 9-16 use the templated kernels, while 3, 6 and 8 use the
+  hand-written kernels.
+*/
+
+#include "BCSRMat.h"
+#include "tacs_test_utils.h"
+
+// A repeatable pseudo-random number in [0, 1)
+static double test_random(unsigned int *seed) {
+  *seed = 1103515245u * (*seed) + 12345u;
+  return ((*seed >> 8) & 0xffffff) / 16777216.0;
+}
+
+// Relative difference of two arrays
+static double array_rel_error(int n, const TacsScalar *x,
+                              const TacsScalar *y) {
+  double diff = 0.0, norm = 0.0;
+  for (int i = 0; i < n; i++) {
+    double d = TacsRealPart(x[i]) - TacsRealPart(y[i]);
+    diff += d * d;
+    norm += TacsRealPart(y[i]) * TacsRealPart(y[i]);
+  }
+  return sqrt(diff / norm);
+}
+
+// Solve D*x = b for a dense n x n row-major block with partial pivoting
+static void dense_block_solve(int n, const TacsScalar *D, const TacsScalar *b,
+                              TacsScalar *x) {
+  TacsScalar *a = new TacsScalar[n * (n + 1)];
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a[(n + 1) * i + j] = D[n * i + j];
+    }
+    a[(n + 1) * i + n] = b[i];
+  }
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    for (int i = k + 1; i < n; i++) {
+      if (fabs(TacsRealPart(a[(n + 1) * i + k])) >
+          fabs(TacsRealPart(a[(n + 1) * p + k]))) {
+        p = i;
+      }
+    }
+    for (int j = 0; j <= n; j++) {
+      TacsScalar t = a[(n + 1) * k + j];
+      a[(n + 1) * k + j] = a[(n + 1) * p + j];
+      a[(n + 1) * p + j] = t;
+    }
+    for (int i = k + 1; i < n; i++) {
+      TacsScalar f = a[(n + 1) * i + k] / a[(n + 1) * k + k];
+      for (int j = k; j <= n; j++) {
+        a[(n + 1) * i + j] -= f * a[(n + 1) * k + j];
+      }
+    }
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    TacsScalar s = a[(n + 1) * i + n];
+    for (int j = i + 1; j < n; j++) {
+      s -= a[(n + 1) * i + j] * x[j];
+    }
+    x[i] = s / a[(n + 1) * i + i];
+  }
+  delete[] a;
+}
+
+/*
+  Compare the kernels for one block size
+*/
+static void test_block_size(MPI_Comm comm, int bsize) {
+  const int nrows = 12;
+  const int b2 = bsize * bsize;
+  const int size = bsize * nrows;
+  unsigned int seed = 17 + bsize;
+
+  // Each block row couples to its neighbours and to one row further
+  // away, so the pattern is not symmetric
+  int *rowp = new int[nrows + 1];
+  int *cols = new int[4 * nrows];
+  rowp[0] = 0;
+  for (int i = 0; i < nrows; i++) {
+    int nz = rowp[i];
+    int far = (i + 5) % nrows;
+    for (int j = 0; j < nrows; j++) {
+      if (j == i - 1 || j == i || j == i + 1 || j == far) {
+        cols[nz] = j;
+        nz++;
+      }
+    }
+    rowp[i + 1] = nz;
+  }
+
+  // Diagonally dominant values
+  TacsScalar *Avals = new TacsScalar[b2 * rowp[nrows]];
+  for (int i = 0; i < nrows; i++) {
+    for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      TacsScalar *a = &Avals[b2 * jp];
+      for (int k = 0; k < b2; k++) {
+        a[k] = (test_random(&seed) - 0.5) / bsize;
+      }
+      if (cols[jp] == i) {
+        for (int k = 0; k < bsize; k++) {
+          a[(bsize + 1) * k] = 4.0 + test_random(&seed);
+        }
+      }
+    }
+  }
+
+  TACSThreadInfo *thread_info = new TACSThreadInfo(1);
+  BCSRMat *A = new BCSRMat(comm, thread_info, bsize, nrows, nrows, &rowp,
+                           &cols, &Avals);
+  A->incref();
+
+  // The dense column-major reference
+  TacsScalar *D = new TacsScalar[size * size];
+  A->getDenseColumnMajor(D);
+
+  TacsScalar *x = new TacsScalar[size];
+  TacsScalar *z = new TacsScalar[size];
+  TacsScalar *y = new TacsScalar[size];
+  TacsScalar *yref = new TacsScalar[size];
+  for (int i = 0; i < size; i++) {
+    x[i] = test_random(&seed) - 0.5;
+    z[i] = test_random(&seed) - 0.5;
+  }
+
+  char name[128];
+  const double tol = 1e-13;
+
+  // y = A*x
+  for (int i = 0; i < size; i++) {
+    yref[i] = 0.0;
+    for (int j = 0; j < size; j++) {
+      yref[i] += D[i + size * j] * x[j];
+    }
+  }
+  A->mult(x, y);
+  snprintf(name, sizeof(name), "block size %2d: mult", bsize);
+  TacsTestCheck(comm, name, array_rel_error(size, y, yref), tol);
+
+  // The threaded product
+  thread_info->setNumThreads(2);
+  A->mult(x, y);
+  snprintf(name, sizeof(name), "block size %2d: threaded mult", bsize);
+  TacsTestCheck(comm, name, array_rel_error(size, y, yref), tol);
+  thread_info->setNumThreads(1);
+
+  // y = A*x + z with distinct input and output
+  for (int i = 0; i < size; i++) {
+    yref[i] += z[i];
+  }
+  A->multAdd(x, z, y);
+  snprintf(name, sizeof(name), "block size %2d: multAdd", bsize);
+  TacsTestCheck(comm, name, array_rel_error(size, y, yref), tol);
+
+  // y = A^{T}*x
+  for (int j = 0; j < size; j++) {
+    yref[j] = 0.0;
+    for (int i = 0; i < size; i++) {
+      yref[j] += D[i + size * j] * x[i];
+    }
+  }
+  A->multTranspose(x, y);
+  snprintf(name, sizeof(name), "block size %2d: multTranspose", bsize);
+  TacsTestCheck(comm, name, array_rel_error(size, y, yref), tol);
+
+  // One forward block SOR sweep for A*y = z from the initial guess x
+  const double omega = 1.2;
+  memcpy(y, x, size * sizeof(TacsScalar));
+  memcpy(yref, x, size * sizeof(TacsScalar));
+  TacsScalar *Dii = new TacsScalar[b2];
+  TacsScalar *t = new TacsScalar[bsize];
+  TacsScalar *s = new TacsScalar[bsize];
+  for (int ib = 0; ib < nrows; ib++) {
+    for (int ii = 0; ii < bsize; ii++) {
+      int i = bsize * ib + ii;
+      t[ii] = z[i];
+      for (int j = 0; j < size; j++) {
+        if (j / bsize != ib) {
+          t[ii] -= D[i + size * j] * yref[j];
+        }
+      }
+      for (int jj = 0; jj < bsize; jj++) {
+        Dii[bsize * ii + jj] = D[i + size * (bsize * ib + jj)];
+      }
+    }
+    dense_block_solve(bsize, Dii, t, s);
+    for (int ii = 0; ii < bsize; ii++) {
+      int i = bsize * ib + ii;
+      yref[i] = (1.0 - omega) * yref[i] + omega * s[ii];
+    }
+  }
+  A->factorDiag();
+  A->applySOR(z, y, omega, 1);
+  snprintf(name, sizeof(name), "block size %2d: SOR sweep", bsize);
+  TacsTestCheck(comm, name, array_rel_error(size, y, yref), tol);
+
+  // Solve with the complete factorization and check the residual of
+  // the dense system
+  BCSRMat *lu = new BCSRMat(comm, A, 10 * nrows, 10.0);
+  lu->incref();
+  lu->copyValues(A);
+  lu->factor();
+  lu->applyFactor(z, y);
+  for (int i = 0; i < size; i++) {
+    yref[i] = 0.0;
+    for (int j = 0; j < size; j++) {
+      yref[i] += D[i + size * j] * y[j];
+    }
+  }
+  snprintf(name, sizeof(name), "block size %2d: factor and solve", bsize);
+  TacsTestCheck(comm, name, array_rel_error(size, yref, z), tol);
+
+  lu->decref();
+  A->decref();
+  delete[] D;
+  delete[] x;
+  delete[] z;
+  delete[] y;
+  delete[] yref;
+  delete[] Dii;
+  delete[] t;
+  delete[] s;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_SELF;
+
+  const int block_sizes[] = {3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  const int num_sizes = sizeof(block_sizes) / sizeof(block_sizes[0]);
+  for (int k = 0; k < num_sizes; k++) {
+    test_block_size(comm, block_sizes[k]);
+  }
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,96 @@
+/*
+  Check the BDDC preconditioner on two refinements of a plane stress
+  model
+
+  Each model is solved with GMRES and the BDDC preconditioner and with
+  the direct Schur complement factorization. The BDDC solution must
+  satisfy the residual tolerance and agree with the direct solution.
+  The number of iterations must not grow appreciably when the mesh is
+  refined by a factor of two in each direction.
+*/
+
+#include "KSM.h"
+#include "TACSSchurMat.h"
+#include "tacs_test_utils.h"
+
+/*
+  Solve the model with BDDC and return the number of iterations
+*/
+static int test_bddc(MPI_Comm comm, int nx, int ny, double rtol) {
+  TACSAssembler *assembler = TacsTestCreatePlaneStressModel(comm, nx, ny);
+  assembler->incref();
+
+  TACSSchurMat *mat = assembler->createSchurMat();
+  mat->incref();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+
+  TACSBVec *b = assembler->createVec();
+  TACSBVec *x0 = assembler->createVec();
+  TACSBVec *x = assembler->createVec();
+  TACSBVec *r = assembler->createVec();
+  b->incref();
+  x0->incref();
+  x->incref();
+  r->incref();
+  b->setRand(-1.0, 1.0);
+  assembler->setBCs(b);
+
+  // The direct solution with the complete factorization
+  TACSSchurPc *direct = new TACSSchurPc(mat, 1000, 10.0, 1);
+  direct->incref();
+  direct->factor();
+  direct->applyFactor(b, x0);
+  direct->decref();
+
+  TACSBDDCPc *pc = new TACSBDDCPc(mat, 1000, 10.0);
+  pc->incref();
+  pc->factor();
+
+  GMRES *gmres = new GMRES(mat, pc, 60, 20, 0);
+  gmres->incref();
+  gmres->setTolerances(rtol, 1e-30);
+  gmres->solve(b, x);
+  int iters = gmres->getIterCount();
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    printf("%d x %d mesh: %d primal nodes, %d iterations\n", nx, ny,
+           pc->getNumPrimalNodes(), iters);
+  }
+
+  char name[128];
+  snprintf(name, sizeof(name), "%d x %d relative residual", nx, ny);
+  TacsTestCheck(comm, name, TacsTestResidual(mat, x, b, r), 10.0 * rtol);
+  snprintf(name, sizeof(name), "%d x %d BDDC vs direct solution", nx, ny);
+  TacsTestCheck(comm, name, TacsTestRelError(x, x0), 1e-4);
+
+  gmres->decref();
+  pc->decref();
+  b->decref();
+  x0->decref();
+  x->decref();
+  r->decref();
+  mat->decref();
+  assembler->decref();
+
+  return iters;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  const double rtol = 1e-8;
+  int coarse_iters = test_bddc(comm, 80, 40, rtol);
+  int fine_iters = test_bddc(comm, 160, 80, rtol);
+
+  // Allow a small growth in the iterations with the refinement
+  TacsTestCheck(comm, "fine/coarse mesh iterations",
+                (1.0 * fine_iters) / coarse_iters, 1.25);
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
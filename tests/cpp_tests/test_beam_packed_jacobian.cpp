@@ -0,0 +1,157 @@
+/*
+  Check the packed Jacobian kernel of the linear beam elements
+
+  For TACSBeam2 and TACSBeam3, addJacobian forms the Jacobian four
+  columns at a time with the packed A2D operations. The Jacobian must
+  agree to round-off with the columns computed one at a time with the
+  unpacked matrix-free product, and with the finite-difference (or
+  complex-step) default of TACSElement that it replaced. A curved
+  element with random states and Jacobian coefficients is used. The
+  times of the three Jacobians are printed.
+*/
+
+#include "TACSElementVerification.h"
+#include "TACSIsoTubeBeamConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+static const int MAX_VARS = 8 * 3;
+
+#ifdef TACS_USE_COMPLEX
+static const double default_tol = 1e-12;
+#else
+static const double default_tol = 1e-6;
+#endif
+
+static const TacsScalar jac_alpha = 0.7, jac_beta = 0.4, jac_gamma = 0.2;
+
+/*
+  Compute the Jacobian one column at a time from the unpacked
+  matrix-free product
+*/
+static void unpacked_jacobian(TACSElement *element, const TacsScalar Xpts[],
+                              const TacsScalar vars[],
+                              const TacsScalar dvars[],
+                              const TacsScalar ddvars[], TacsScalar mat[]) {
+  const int nvars = element->getNumVariables();
+  int data_size, temp_size;
+  element->getMatVecDataSizes(TACS_JACOBIAN_MATRIX, 0, &data_size,
+                              &temp_size);
+  TacsScalar *data = new TacsScalar[data_size];
+  TacsScalar *temp = new TacsScalar[temp_size + 1];
+  element->getMatVecProductData(TACS_JACOBIAN_MATRIX, 0, 0.0, jac_alpha,
+                                jac_beta, jac_gamma, Xpts, vars, dvars, ddvars,
+                                data);
+
+  TacsScalar px[MAX_VARS], py[MAX_VARS];
+  for (int j = 0; j < nvars; j++) {
+    memset(px, 0, nvars * sizeof(TacsScalar));
+    memset(py, 0, nvars * sizeof(TacsScalar));
+    px[j] = 1.0;
+    element->addMatVecProduct(TACS_JACOBIAN_MATRIX, 0, data, temp, px, py);
+    for (int i = 0; i < nvars; i++) {
+      mat[nvars * i + j] += py[i];
+    }
+  }
+
+  delete[] data;
+  delete[] temp;
+}
+
+/*
+  Compare the Jacobians of one element and time them
+*/
+static void test_element(MPI_Comm comm, const char *type,
+                         TACSElement *element) {
+  element->incref();
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  const int num_nodes = element->getNumNodes();
+  const int nvars = element->getNumVariables();
+
+  TacsScalar Xpts[3 * 3];
+  TacsGenerateRandomArray(Xpts, 3 * num_nodes, -0.05, 0.05);
+  for (int node = 0; node < num_nodes; node++) {
+    double s = 1.0 * node / (num_nodes - 1);
+    Xpts[3 * node] += s;
+    Xpts[3 * node + 2] += 0.2 * s * s;
+  }
+
+  TacsScalar vars[MAX_VARS], dvars[MAX_VARS], ddvars[MAX_VARS];
+  TacsGenerateRandomArray(vars, nvars, -0.1, 0.1);
+  TacsGenerateRandomArray(dvars, nvars);
+  TacsGenerateRandomArray(ddvars, nvars);
+
+  TacsScalar mat0[MAX_VARS * MAX_VARS], mat1[MAX_VARS * MAX_VARS];
+  TacsScalar mat2[MAX_VARS * MAX_VARS];
+  const int num_reps = 2000;
+  double t[3];
+
+  t[0] = MPI_Wtime();
+  for (int k = 0; k < num_reps; k++) {
+    memset(mat0, 0, nvars * nvars * sizeof(TacsScalar));
+    element->addJacobian(0, 0.0, jac_alpha, jac_beta, jac_gamma, Xpts, vars,
+                         dvars, ddvars, NULL, mat0);
+  }
+  t[0] = (MPI_Wtime() - t[0]) / num_reps;
+
+  t[1] = MPI_Wtime();
+  for (int k = 0; k < num_reps; k++) {
+    memset(mat1, 0, nvars * nvars * sizeof(TacsScalar));
+    unpacked_jacobian(element, Xpts, vars, dvars, ddvars, mat1);
+  }
+  t[1] = (MPI_Wtime() - t[1]) / num_reps;
+
+  t[2] = MPI_Wtime();
+  for (int k = 0; k < num_reps; k++) {
+    memset(mat2, 0, nvars * nvars * sizeof(TacsScalar));
+    element->TACSElement::addJacobian(0, 0.0, jac_alpha, jac_beta, jac_gamma,
+                                      Xpts, vars, dvars, ddvars, NULL, mat2);
+  }
+  t[2] = (MPI_Wtime() - t[2]) / num_reps;
+
+  if (rank == 0) {
+    printf("%s Jacobian time: packed %.2f us, unpacked %.2f us, "
+           "default %.2f us\n",
+           type, 1e6 * t[0], 1e6 * t[1], 1e6 * t[2]);
+  }
+
+  char name[128];
+  snprintf(name, sizeof(name), "%s packed vs unpacked Jacobian", type);
+  TacsTestCheck(comm, name, TacsTestRelError(nvars * nvars, mat0, mat1),
+                1e-13);
+  snprintf(name, sizeof(name), "%s packed vs default Jacobian", type);
+  TacsTestCheck(comm, name, TacsTestRelError(nvars * nvars, mat0, mat2),
+                default_tol);
+
+  element->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TacsSeedRandomGenerator(0);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSBeamConstitutive *con = new TACSIsoTubeBeamConstitutive(
+      props, 0.05, 0.01, -1, -1, 0.0, 1.0, 0.0, 1.0);
+  con->incref();
+  TacsScalar axis[3] = {0.2, 1.0, 0.3};
+  TACSBeamTransform *transform = new TACSBeamRefAxisTransform(axis);
+  transform->incref();
+
+  test_element(comm, "TACSBeam2", new TACSBeam2(transform, con));
+  test_element(comm, "TACSBeam3", new TACSBeam3(transform, con));
+
+  transform->decref();
+  con->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,101 @@
+/*
+  Check the thick-restart block Lanczos method against the
+  single-vector Lanczos method
+
+  The 100 lowest natural frequencies of a 6642 degree of freedom plane
+  stress model are computed with the default single-vector Lanczos
+  method with a 400 vector subspace and with the block Lanczos method
+  with a block size of 8 and a 240 vector basis. The eigenvalues must
+  agree and the eigenvector residuals of both solves must be small.
+  The solve times and the orthogonality of the final subspaces,
+  computed with checkOrthogonality(), are printed, and the block
+  subspace must be orthogonal to round-off.
+*/
+
+#include "KSM.h"
+#include "TACSBuckling.h"
+#include "TACSSchurMat.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_MODES = 100;
+
+/*
+  Create a frequency analysis with its own matrices and solver
+*/
+static TACSFrequencyAnalysis *create_analysis(TACSAssembler *assembler,
+                                              int max_lanczos) {
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  TACSSchurMat *mmat = assembler->createSchurMat();
+  TACSSchurPc *pc = new TACSSchurPc(kmat, 10000, 10.0, 1);
+  GMRES *ksm = new GMRES(kmat, pc, 15, 0, 0);
+  ksm->setTolerances(1e-12, 1e-30);
+
+  return new TACSFrequencyAnalysis(assembler, 0.0, mmat, kmat, ksm,
+                                   max_lanczos, NUM_MODES, 1e-8);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TACSAssembler *assembler = TacsTestCreatePlaneStressModel(comm, 80, 40);
+  assembler->incref();
+
+  TACSFrequencyAnalysis *freq[2];
+  freq[0] = create_analysis(assembler, 400);
+  freq[1] = create_analysis(assembler, 240);
+  freq[1]->setBlockLanczos(8, 25);
+
+  const char *names[2] = {"single-vector", "block"};
+  double time[2], ortho[2], max_error[2];
+  for (int k = 0; k < 2; k++) {
+    freq[k]->incref();
+    time[k] = MPI_Wtime();
+    freq[k]->solve();
+    time[k] = MPI_Wtime() - time[k];
+    ortho[k] = TacsRealPart(freq[k]->checkOrthogonality());
+
+    max_error[k] = 0.0;
+    for (int i = 0; i < NUM_MODES; i++) {
+      TacsScalar error;
+      freq[k]->extractEigenvalue(i, &error);
+      if (fabs(TacsRealPart(error)) > max_error[k]) {
+        max_error[k] = fabs(TacsRealPart(error));
+      }
+    }
+    if (rank == 0) {
+      printf("%s Lanczos: %.2f s, orthogonality %.2e\n", names[k], time[k],
+             ortho[k]);
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "%s Lanczos eigenvector residuals",
+             names[k]);
+    TacsTestCheck(comm, name, max_error[k], 1e-8);
+  }
+
+  double eig_err = 0.0;
+  for (int i = 0; i < NUM_MODES; i++) {
+    TacsScalar err0, err1;
+    TacsScalar eig0 = freq[0]->extractEigenvalue(i, &err0);
+    TacsScalar eig1 = freq[1]->extractEigenvalue(i, &err1);
+    double err = TacsTestRelError(eig1, eig0);
+    if (err > eig_err) {
+      eig_err = err;
+    }
+  }
+  TacsTestCheck(comm, "block vs single-vector eigenvalues", eig_err, 1e-6);
+  TacsTestCheck(comm, "block Lanczos orthogonality", ortho[1], 1e-12);
+
+  freq[0]->decref();
+  freq[1]->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
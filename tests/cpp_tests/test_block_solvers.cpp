@@ -0,0 +1,136 @@
+/*
+  Check the block solvers for several right-hand-sides against solves
+  with one right-hand-side at a time
+
+  Sixteen right-hand-sides for a plane stress model are solved with
+  BlockGMRES and BlockPCG in blocks of eight, and one at a time with
+  GMRES and PCG. The block solutions must satisfy the residual
+  tolerance and agree with the individual solutions. The block solvers
+  must pass over the matrix fewer times than the individual solves.
+  The solution times are printed but not checked, since they depend on
+  the machine and its load.
+*/
+
+#include "KSM.h"
+#include "tacs_test_utils.h"
+
+/*
+  Solve the systems with the block solver and one at a time with the
+  reference solver and compare the results
+*/
+static void test_block_solver(MPI_Comm comm, const char *name,
+                              TACSKsm *block, TACSKsm *ref, TACSMat *mat,
+                              int nrhs, TACSBVec **b, TACSBVec **x0,
+                              TACSBVec **x1, TACSBVec *r, double rtol) {
+  double t0 = MPI_Wtime();
+  int ref_iters = 0;
+  for (int i = 0; i < nrhs; i++) {
+    ref->solve(b[i], x0[i]);
+    ref_iters += ref->getIterCount();
+  }
+  t0 = MPI_Wtime() - t0;
+
+  // The block solver counts one iteration for each block product
+  double t1 = MPI_Wtime();
+  block->solveMulti(nrhs, (TACSVec **)b, (TACSVec **)x1);
+  int block_iters = block->getIterCount();
+  t1 = MPI_Wtime() - t1;
+
+  double max_res = 0.0, max_diff = 0.0;
+  for (int i = 0; i < nrhs; i++) {
+    double res = TacsTestResidual(mat, x1[i], b[i], r);
+    double diff = TacsTestRelError(x1[i], x0[i]);
+    if (res > max_res) {
+      max_res = res;
+    }
+    if (diff > max_diff) {
+      max_diff = diff;
+    }
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    printf("%s: %d block iterations in %.3f s, %d iterations in %.3f s\n",
+           name, block_iters, t1, ref_iters, t0);
+  }
+
+  char str[128];
+  snprintf(str, sizeof(str), "%s relative residual", name);
+  TacsTestCheck(comm, str, max_res, 10.0 * rtol);
+  snprintf(str, sizeof(str), "%s solution vs individual solves", name);
+  TacsTestCheck(comm, str, max_diff, 1e-5);
+  snprintf(str, sizeof(str), "%s matrix passes ratio", name);
+  TacsTestCheck(comm, str, (1.0 * block_iters) / ref_iters, 0.5);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSAssembler *assembler =
+      TacsTestCreatePlaneStressModel(comm, 40, 40, 2, 100.0);
+  assembler->incref();
+
+  TACSParallelMat *mat = assembler->createMat();
+  mat->incref();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+
+  TACSAdditiveSchwarz *pc = new TACSAdditiveSchwarz(mat, 0, 10.0);
+  pc->incref();
+  pc->factor();
+
+  const int nrhs = 16, max_block = 8;
+  TACSBVec *b[nrhs], *x0[nrhs], *x1[nrhs];
+  for (int i = 0; i < nrhs; i++) {
+    b[i] = assembler->createVec();
+    x0[i] = assembler->createVec();
+    x1[i] = assembler->createVec();
+    b[i]->incref();
+    x0[i]->incref();
+    x1[i]->incref();
+    b[i]->setRand(-1.0, 1.0);
+    assembler->setBCs(b[i]);
+  }
+  TACSBVec *r = assembler->createVec();
+  r->incref();
+
+  const double rtol = 1e-8;
+
+  TACSKsm *block = new BlockGMRES(mat, pc, 40, 20, max_block);
+  TACSKsm *ref = new GMRES(mat, pc, 40, 20, 0);
+  block->incref();
+  ref->incref();
+  block->setTolerances(rtol, 1e-30);
+  ref->setTolerances(rtol, 1e-30);
+  test_block_solver(comm, "BlockGMRES", block, ref, mat, nrhs, b, x0, x1, r,
+                    rtol);
+  block->decref();
+  ref->decref();
+
+  block = new BlockPCG(mat, pc, 1000, max_block);
+  ref = new PCG(mat, pc, 1000, 1);
+  block->incref();
+  ref->incref();
+  block->setTolerances(rtol, 1e-30);
+  ref->setTolerances(rtol, 1e-30);
+  test_block_solver(comm, "BlockPCG", block, ref, mat, nrhs, b, x0, x1, r,
+                    rtol);
+  block->decref();
+  ref->decref();
+
+  for (int i = 0; i < nrhs; i++) {
+    b[i]->decref();
+    x0[i]->decref();
+    x1[i]->decref();
+  }
+  r->decref();
+  pc->decref();
+  mat->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
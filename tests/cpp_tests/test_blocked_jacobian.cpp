@@ -0,0 +1,222 @@
+/*
+  Check the blocked assembly of the 2D and 3D element Jacobians
+
+  The Jacobian of linear and nonlinear elasticity and heat conduction
+  elements with linear to cubic quad and hexahedral bases is computed
+  with TACSElement2D/3D::addJacobian, which adds all the quadrature
+  points with one matrix product for each pair of variables. The result
+  must match the Jacobian added one quadrature point at a time with
+  TACSElementBasis::addWeakMatrix up to round-off, and must be
+  consistent with a finite-difference (or complex-step) approximation of
+  the residual. The times for the two assembly methods are printed.
+*/
+
+#include "TACSElement3D.h"
+#include "TACSElementVerification.h"
+#include "TACSHeatConduction.h"
+#include "TACSHexaBasis.h"
+#include "tacs_test_utils.h"
+
+static const int MAX_SIZE = 4 * 64;
+static const int MAX_VARS_PER_NODE = TACSElement3D::MAX_VARS_PER_NODE;
+
+/*
+  Add the element Jacobian one quadrature point at a time
+*/
+static void add_pointwise_jacobian(TACSElementModel *model,
+                                   TACSElementBasis *basis,
+                                   const TacsScalar Xpts[],
+                                   const TacsScalar vars[],
+                                   const TacsScalar dvars[],
+                                   const TacsScalar ddvars[], TacsScalar *mat) {
+  const int nquad = basis->getNumQuadraturePoints();
+  const int vars_per_node = model->getVarsPerNode();
+  const TacsScalar alpha = 1.0, beta = 0.5, gamma = 0.25;
+
+  int Jac_nnz;
+  const int *Jac_pairs;
+  model->getWeakMatrixNonzeros(TACS_JACOBIAN_MATRIX, 0, &Jac_nnz, &Jac_pairs);
+
+  for (int n = 0; n < nquad; n++) {
+    double pt[3];
+    double weight = basis->getQuadraturePoint(n, pt);
+
+    TacsScalar X[3], Xd[9], J[9];
+    TacsScalar Ut[3 * MAX_VARS_PER_NODE];
+    TacsScalar Ud[3 * MAX_VARS_PER_NODE], Ux[3 * MAX_VARS_PER_NODE];
+    TacsScalar detXd = basis->getFieldGradient(
+        n, pt, Xpts, vars_per_node, vars, dvars, ddvars, X, Xd, J, Ut, Ud, Ux);
+    detXd *= weight;
+
+    TacsScalar DUt[3 * MAX_VARS_PER_NODE], DUx[3 * MAX_VARS_PER_NODE];
+    TacsScalar Jac[36 * MAX_VARS_PER_NODE * MAX_VARS_PER_NODE];
+    model->evalWeakMatrix(TACS_JACOBIAN_MATRIX, 0, n, 0.0, pt, X, Xd, Ut, Ux,
+                          DUt, DUx, Jac);
+
+    basis->scaleWeakMatrix(detXd, alpha, beta, gamma, Jac_nnz, Jac_pairs, Jac);
+    basis->addWeakMatrix(n, pt, J, vars_per_node, Jac_nnz, Jac_pairs, Jac, mat);
+  }
+}
+
+/*
+  Compare the blocked and the pointwise Jacobian of one element
+*/
+static void test_element(MPI_Comm comm, const char *type, TACSElement *element,
+                         TACSElementModel *model, TACSElementBasis *basis) {
+  element->incref();
+
+  const int num_params = basis->getNumParameters();
+  const int num_nodes = basis->getNumNodes();
+  const int size = element->getNumVariables();
+  const int order = (num_params == 2 ? (int)(sqrt(1.0 * num_nodes) + 0.5)
+                                     : (int)(cbrt(1.0 * num_nodes) + 0.5));
+
+  // Perturb the nodes of the element from a regular lattice
+  TacsScalar Xpts[3 * MAX_SIZE];
+  TacsGenerateRandomArray(Xpts, 3 * num_nodes, -0.1, 0.1);
+  for (int node = 0; node < num_nodes; node++) {
+    int index = node;
+    for (int k = 0; k < num_params; k++) {
+      Xpts[3 * node + k] += (1.0 * (index % order)) / (order - 1);
+      index /= order;
+    }
+    if (num_params == 2) {
+      Xpts[3 * node + 2] = 0.0;
+    }
+  }
+
+  TacsScalar vars[MAX_SIZE], dvars[MAX_SIZE], ddvars[MAX_SIZE];
+  TacsGenerateRandomArray(vars, size, -0.1, 0.1);
+  TacsGenerateRandomArray(dvars, size);
+  TacsGenerateRandomArray(ddvars, size);
+
+  TacsScalar *mat0 = new TacsScalar[size * size];
+  TacsScalar *mat1 = new TacsScalar[size * size];
+  TacsScalar *res = new TacsScalar[size];
+
+  // Time the two methods
+  const int num_reps = (size > 100 ? 5 : 200);
+  double t[2];
+  for (int k = 0; k < 2; k++) {
+    TacsScalar *mat = (k == 0 ? mat0 : mat1);
+    t[k] = MPI_Wtime();
+    for (int rep = 0; rep < num_reps; rep++) {
+      memset(mat, 0, size * size * sizeof(TacsScalar));
+      if (k == 0) {
+        add_pointwise_jacobian(model, basis, Xpts, vars, dvars, ddvars, mat);
+      } else {
+        memset(res, 0, size * sizeof(TacsScalar));
+        element->addJacobian(0, 0.0, 1.0, 0.5, 0.25, Xpts, vars, dvars, ddvars,
+                             res, mat);
+      }
+    }
+    t[k] = (MPI_Wtime() - t[k]) / num_reps;
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    printf("%s Jacobian: %.2f us pointwise, %.2f us blocked\n", type,
+           1e6 * t[0], 1e6 * t[1]);
+  }
+
+  double err = 0.0, norm = 0.0;
+  for (int i = 0; i < size * size; i++) {
+    err += TacsRealPart((mat1[i] - mat0[i]) * (mat1[i] - mat0[i]));
+    norm += TacsRealPart(mat0[i] * mat0[i]);
+  }
+
+  char name[128];
+  snprintf(name, sizeof(name), "%s blocked vs pointwise", type);
+  TacsTestCheck(comm, name, sqrt(err / norm), 1e-12);
+
+#ifdef TACS_USE_COMPLEX
+  double dh = 1e-30;
+#else
+  double dh = 1e-6;
+#endif
+  int fail = TacsTestElementJacobian(element, 0, 0.0, Xpts, vars, dvars,
+                                     ddvars, -1, dh, 0, 1e-5, 1e-5);
+  snprintf(name, sizeof(name), "%s blocked vs finite-difference", type);
+  TacsTestCheck(comm, name, fail, 0.0);
+
+  delete[] mat0;
+  delete[] mat1;
+  delete[] res;
+  element->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TacsSeedRandomGenerator(0);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  props->incref();
+  TACSPlaneStressConstitutive *ps = new TACSPlaneStressConstitutive(props);
+  TACSSolidConstitutive *solid = new TACSSolidConstitutive(props);
+  ps->incref();
+  solid->incref();
+
+  const char *orders[3] = {"linear", "quadratic", "cubic"};
+  TACSElementBasis *quads[3] = {new TACSLinearQuadBasis(),
+                                new TACSQuadraticQuadBasis(),
+                                new TACSCubicQuadBasis()};
+  TACSElementBasis *hexas[3] = {new TACSLinearHexaBasis(),
+                                new TACSQuadraticHexaBasis(),
+                                new TACSCubicHexaBasis()};
+  for (int k = 0; k < 3; k++) {
+    quads[k]->incref();
+    hexas[k]->incref();
+  }
+
+  for (int k = 0; k < 3; k++) {
+    char type[128];
+    TACSElementModel *model;
+
+    model = new TACSLinearElasticity2D(ps, TACS_LINEAR_STRAIN);
+    snprintf(type, sizeof(type), "%s quad elasticity", orders[k]);
+    test_element(comm, type, new TACSElement2D(model, quads[k]), model,
+                 quads[k]);
+
+    model = new TACSLinearElasticity2D(ps, TACS_NONLINEAR_STRAIN);
+    snprintf(type, sizeof(type), "%s quad nonlinear elasticity", orders[k]);
+    test_element(comm, type, new TACSElement2D(model, quads[k]), model,
+                 quads[k]);
+
+    model = new TACSHeatConduction2D(ps);
+    snprintf(type, sizeof(type), "%s quad heat conduction", orders[k]);
+    test_element(comm, type, new TACSElement2D(model, quads[k]), model,
+                 quads[k]);
+
+    model = new TACSLinearElasticity3D(solid, TACS_LINEAR_STRAIN);
+    snprintf(type, sizeof(type), "%s hex elasticity", orders[k]);
+    test_element(comm, type, new TACSElement3D(model, hexas[k]), model,
+                 hexas[k]);
+
+    model = new TACSLinearElasticity3D(solid, TACS_NONLINEAR_STRAIN);
+    snprintf(type, sizeof(type), "%s hex nonlinear elasticity", orders[k]);
+    test_element(comm, type, new TACSElement3D(model, hexas[k]), model,
+                 hexas[k]);
+
+    model = new TACSHeatConduction3D(solid);
+    snprintf(type, sizeof(type), "%s hex heat conduction", orders[k]);
+    test_element(comm, type, new TACSElement3D(model, hexas[k]), model,
+                 hexas[k]);
+  }
+
+  for (int k = 0; k < 3; k++) {
+    quads[k]->decref();
+    hexas[k]->decref();
+  }
+  ps->decref();
+  solid->decref();
+  props->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,105 @@
+/*
+  Check the threaded assembly with element coloring
+
+  The residual, the Jacobian and the mass matrix are assembled with one
+  thread, with several threads that lock the shared data, and with
+  several threads that assemble one color of elements at a time without
+  locking. The results must agree up to the order of the additions.
+*/
+
+#include "TACSIsoShellConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e9, 0.3, 270e6, 24e-6, 230.0);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *elems[2];
+  elems[0] = new TACSQuad4NonlinearShell(
+      transform, new TACSIsoShellConstitutive(props, 0.01));
+  elems[1] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.02));
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 16, 12, 2, elems, 0.2);
+  assembler->incref();
+
+  TACSBVec *vars = assembler->createVec();
+  vars->incref();
+  vars->setRand(-1.0, 1.0);
+  vars->scale(1e-3);
+  assembler->setBCs(vars);
+  assembler->setVariables(vars);
+
+  // Assemble with one thread as the reference
+  const int num_cases = 4;
+  int threads[num_cases] = {1, 2, 2, 4};
+  int coloring[num_cases] = {0, 0, 1, 1};
+
+  TACSBVec *res[num_cases];
+  TACSParallelMat *jac[num_cases], *mass[num_cases];
+  for (int k = 0; k < num_cases; k++) {
+    assembler->setNumThreads(threads[k]);
+    assembler->setElementColoring(coloring[k]);
+
+    res[k] = assembler->createVec();
+    res[k]->incref();
+    jac[k] = assembler->createMat();
+    jac[k]->incref();
+    mass[k] = assembler->createMat();
+    mass[k]->incref();
+
+    assembler->assembleRes(res[k]);
+    assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, jac[k]);
+    assembler->assembleMatType(TACS_MASS_MATRIX, mass[k]);
+  }
+
+  // The coloring must be computed and use more than one color
+  TacsTestCheck(comm, "number of element colors > 1",
+                assembler->getNumElementColors() <= 1, 0.0);
+
+  TACSBVec *x = assembler->createVec();
+  TACSBVec *y0 = assembler->createVec();
+  TACSBVec *y1 = assembler->createVec();
+  x->incref();
+  y0->incref();
+  y1->incref();
+  x->setRand(-1.0, 1.0);
+
+  const double tol = 1e-13;
+  for (int k = 1; k < num_cases; k++) {
+    char name[128];
+    const char *type = (coloring[k] ? "colored" : "locked");
+    snprintf(name, sizeof(name), "residual, %d threads %s vs serial",
+             threads[k], type);
+    TacsTestCheck(comm, name, TacsTestRelError(res[k], res[0]), tol);
+    snprintf(name, sizeof(name), "Jacobian, %d threads %s vs serial",
+             threads[k], type);
+    TacsTestCheck(comm, name,
+                  TacsTestMatRelError(jac[k], jac[0], x, y1, y0), tol);
+    snprintf(name, sizeof(name), "mass matrix, %d threads %s vs serial",
+             threads[k], type);
+    TacsTestCheck(comm, name,
+                  TacsTestMatRelError(mass[k], mass[0], x, y1, y0), tol);
+  }
+
+  for (int k = 0; k < num_cases; k++) {
+    res[k]->decref();
+    jac[k]->decref();
+    mass[k]->decref();
+  }
+  x->decref();
+  y0->decref();
+  y1->decref();
+  vars->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,84 @@
+import os
+import shutil
+import subprocess
+import unittest
+
+"""
+Run the C++ regression tests in this directory.
+
+The test programs compare code paths that are expected to agree, for
+instance a specialized kernel against the general implementation.
+They are built in the real or complex mode with "make" or
+"make complex", following the build of the examples. A program that
+has not been built is skipped. Each entry below gives the program and
+the number of processors to run it on.
+"""
+
+cpp_tests = [
+    ("test_pcm_transition_table", 1),
+    ("test_element_registry", 2),
+    ("test_function_cache", 2),
+    ("test_colored_assembly", 2),
+    ("test_bcsr_block_sizes", 1),
+    ("test_ks_single_pass", 2),
+    ("test_gcrodr_recycling", 2),
+    ("test_block_solvers", 2),
+    ("test_polynomial_pc", 2),
+    ("test_schwarz_overlap", 4),
+    ("test_bddc", 4),
+    ("test_eigen_sens_multi", 2),
+    ("test_lobpcg", 4),
+    ("test_anderson_acceleration", 2),
+    ("test_reduced_order_model", 3),
+    ("test_symmetric_element_matrices", 2),
+    ("test_failure_cache", 2),
+    ("test_blocked_jacobian", 1),
+    ("test_quaternion_shell_jacobian", 2),
+    ("test_jd_inner_solver", 1),
+    ("test_halo_exchange", 4),
+    ("test_reduced_frequency", 1),
+    ("test_reduced_shell", 1),
+    ("test_quad4_shell_jacobian", 1),
+    ("test_beam_packed_jacobian", 1),
+    ("test_sum_factor_interp", 1),
+    ("test_block_lanczos", 4),
+    ("test_schur_supernodes", 4),
+    ("test_parareal", 4),
+    ("test_shell_stiffness_cache", 1),
+    ("test_shell_p_refinement", 2),
+]
+
+base_dir = os.path.dirname(os.path.abspath(__file__))
+
+
+def make_test(name, nprocs):
+    def test(self):
+        exe = os.path.join(base_dir, name)
+        if not os.path.exists(exe):
+            self.skipTest("%s has not been built" % name)
+        mpirun = shutil.which("mpirun")
+        if mpirun is None:
+            self.skipTest("mpirun is not available")
+        result = subprocess.run(
+            [mpirun, "-np", str(nprocs), exe],
+            cwd=base_dir,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            universal_newlines=True,
+            timeout=600,
+        )
+        self.assertEqual(result.returncode, 0, result.stdout)
+
+    return test
+
+
+class CppRegressionTest(unittest.TestCase):
+    pass
+
+
+for name, nprocs in cpp_tests:
+    setattr(CppRegressionTest, name, make_test(name, nprocs))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,291 @@
+/*
+  Check the batched eigenvalue derivatives against the derivatives
+  computed one mode at a time
+
+  The first six natural frequencies of a 3200 element plane stress
+  model and the first six buckling loads of a shell plate are
+  computed. The derivatives of each eigenvalue w.r.t. the thickness
+  design variables and the node locations are evaluated for all the
+  modes at once and for each mode in turn. The results must agree to
+  round-off, or to the solver tolerance where the buckling derivatives
+  require the adjoint of the load path. The times for the two
+  approaches are printed.
+*/
+
+#include "KSM.h"
+#include "TACSBuckling.h"
+#include "TACSIsoShellConstitutive.h"
+#include "TACSSchurMat.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_MODES = 6;
+
+/*
+  Compare the derivatives for all the modes, stored in the vectors x0
+  and x1, and print the times when they are given
+*/
+static void compare_sens(MPI_Comm comm, const char *name, TACSBVec **x0,
+                         TACSBVec **x1, double tol, double t0 = 0.0,
+                         double t1 = 0.0) {
+  double max_err = 0.0;
+  for (int k = 0; k < NUM_MODES; k++) {
+    double err = TacsTestRelError(x1[k], x0[k]);
+    if (err > max_err) {
+      max_err = err;
+    }
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0 && t0 > 0.0) {
+    printf("%s: batched %.3f s, per mode %.3f s\n", name, t1, t0);
+  }
+
+  char str[128];
+  snprintf(str, sizeof(str), "%s batched vs per mode", name);
+  TacsTestCheck(comm, str, max_err, tol);
+}
+
+/*
+  Add the contributions to the derivatives from other processors
+*/
+static void finalize_vecs(TACSBVec **x) {
+  for (int k = 0; k < NUM_MODES; k++) {
+    x[k]->beginSetValues(TACS_ADD_VALUES);
+    x[k]->endSetValues(TACS_ADD_VALUES);
+  }
+}
+
+/*
+  Create the vectors for the derivatives of each mode
+*/
+static void create_vecs(TACSAssembler *assembler, int design, TACSBVec **x) {
+  for (int k = 0; k < NUM_MODES; k++) {
+    if (design) {
+      x[k] = assembler->createDesignVec();
+    } else {
+      x[k] = assembler->createNodeVec();
+    }
+    x[k]->incref();
+    x[k]->zeroEntries();
+  }
+}
+
+static void destroy_vecs(TACSBVec **x) {
+  for (int k = 0; k < NUM_MODES; k++) {
+    x[k]->decref();
+  }
+}
+
+/*
+  Natural frequencies of a plane stress model with two thickness
+  design variables
+*/
+static void test_frequency(MPI_Comm comm) {
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSElementBasis *basis = new TACSLinearQuadBasis();
+  TACSElement *elems[2];
+  for (int k = 0; k < 2; k++) {
+    TACSPlaneStressConstitutive *stiff =
+        new TACSPlaneStressConstitutive(props, 1.0 + 0.5 * k, k);
+    TACSLinearElasticity2D *model =
+        new TACSLinearElasticity2D(stiff, TACS_LINEAR_STRAIN);
+    elems[k] = new TACSElement2D(model, basis);
+  }
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 2, 2, 80, 40, 2, elems);
+  assembler->incref();
+
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  TACSSchurMat *mmat = assembler->createSchurMat();
+  kmat->incref();
+  mmat->incref();
+
+  TACSSchurPc *pc = new TACSSchurPc(kmat, 10000, 10.0, 1);
+  GMRES *ksm = new GMRES(kmat, pc, 15, 0, 0);
+  ksm->incref();
+  ksm->setTolerances(1e-12, 1e-30);
+
+  TACSFrequencyAnalysis *freq = new TACSFrequencyAnalysis(
+      assembler, 0.0, mmat, kmat, ksm, 60, NUM_MODES, 1e-10);
+  freq->incref();
+  freq->solve();
+
+  int modes[NUM_MODES];
+  for (int k = 0; k < NUM_MODES; k++) {
+    modes[k] = k;
+  }
+
+  TACSBVec *x0[NUM_MODES], *x1[NUM_MODES];
+  for (int design = 1; design >= 0; design--) {
+    create_vecs(assembler, design, x0);
+    create_vecs(assembler, design, x1);
+
+    double t0 = MPI_Wtime();
+    for (int k = 0; k < NUM_MODES; k++) {
+      if (design) {
+        freq->evalEigenDVSens(k, x0[k]);
+      } else {
+        freq->evalEigenXptSens(k, x0[k]);
+      }
+    }
+    t0 = MPI_Wtime() - t0;
+
+    double t1 = MPI_Wtime();
+    if (design) {
+      freq->evalEigenDVSensMulti(NUM_MODES, modes, x1);
+    } else {
+      freq->evalEigenXptSensMulti(NUM_MODES, modes, x1);
+    }
+    t1 = MPI_Wtime() - t1;
+
+    compare_sens(comm,
+                 (design ? "frequency design variables" : "frequency nodes"),
+                 x0, x1, 1e-12, t0, t1);
+    destroy_vecs(x0);
+    destroy_vecs(x1);
+  }
+
+  freq->decref();
+  ksm->decref();
+  kmat->decref();
+  mmat->decref();
+  assembler->decref();
+}
+
+/*
+  Buckling loads of a shell plate with two thickness design variables
+  under a compressive load
+*/
+static void test_buckling(MPI_Comm comm) {
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e9, 0.3, 270e6, 24e-6, 230.0);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *elems[2];
+  elems[0] = new TACSQuad4Shell(
+      transform, new TACSIsoShellConstitutive(props, 0.01, 0));
+  elems[1] = new TACSQuad4Shell(
+      transform, new TACSIsoShellConstitutive(props, 0.015, 1));
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 16, 16, 2, elems, 0.05);
+  assembler->incref();
+
+  // A uniform load in the negative x direction
+  TACSBVec *rhs = assembler->createVec();
+  rhs->incref();
+  TacsScalar *f;
+  int size = rhs->getArray(&f);
+  for (int i = 0; i < size; i += 6) {
+    f[i] = -1e3;
+  }
+  assembler->applyBCs(rhs);
+
+  TACSSchurMat *aux_mat = assembler->createSchurMat();
+  TACSSchurMat *gmat = assembler->createSchurMat();
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  aux_mat->incref();
+  gmat->incref();
+  kmat->incref();
+
+  TACSSchurPc *pc = new TACSSchurPc(aux_mat, 10000, 10.0, 1);
+  GMRES *ksm = new GMRES(aux_mat, pc, 15, 0, 0);
+  ksm->incref();
+  ksm->setTolerances(1e-12, 1e-30);
+
+  TACSLinearBuckling *buckling =
+      new TACSLinearBuckling(assembler, 10.0, gmat, kmat, aux_mat, ksm, 60,
+                             NUM_MODES, 1e-10);
+  buckling->incref();
+  buckling->solve(rhs);
+
+  int modes[NUM_MODES];
+  for (int k = 0; k < NUM_MODES; k++) {
+    modes[k] = k;
+  }
+
+  // The adjoints for the load path are solved separately for each
+  // mode and together for the batch, so they agree only to the solver
+  // tolerance
+  const double tol = 1e-10;
+
+  TACSBVec *x0[NUM_MODES], *x1[NUM_MODES];
+  for (int design = 1; design >= 0; design--) {
+    create_vecs(assembler, design, x0);
+    create_vecs(assembler, design, x1);
+
+    double t0 = MPI_Wtime();
+    for (int k = 0; k < NUM_MODES; k++) {
+      if (design) {
+        buckling->evalEigenDVSens(k, x0[k]);
+      } else {
+        buckling->evalEigenXptSens(k, x0[k]);
+      }
+    }
+    t0 = MPI_Wtime() - t0;
+
+    double t1 = MPI_Wtime();
+    if (design) {
+      buckling->evalEigenDVSensMulti(NUM_MODES, modes, x1);
+    } else {
+      buckling->evalEigenXptSensMulti(NUM_MODES, modes, x1);
+    }
+    t1 = MPI_Wtime() - t1;
+
+    compare_sens(comm,
+                 (design ? "buckling design variables" : "buckling nodes"),
+                 x0, x1, tol, t0, t1);
+    destroy_vecs(x0);
+    destroy_vecs(x1);
+  }
+
+  // The accumulated derivatives with a scaling factor
+  create_vecs(assembler, 1, x0);
+  create_vecs(assembler, 1, x1);
+  const TacsScalar coef = 2.5;
+  for (int k = 0; k < NUM_MODES; k++) {
+    buckling->addEigenDVSens(coef, k, x0[k]);
+  }
+  buckling->addEigenDVSensMulti(coef, NUM_MODES, modes, x1);
+  finalize_vecs(x0);
+  finalize_vecs(x1);
+  compare_sens(comm, "buckling added design variables", x0, x1, tol);
+  destroy_vecs(x0);
+  destroy_vecs(x1);
+
+  create_vecs(assembler, 0, x0);
+  create_vecs(assembler, 0, x1);
+  for (int k = 0; k < NUM_MODES; k++) {
+    buckling->addEigenXptSens(coef, k, x0[k]);
+  }
+  buckling->addEigenXptSensMulti(coef, NUM_MODES, modes, x1);
+  finalize_vecs(x0);
+  finalize_vecs(x1);
+  compare_sens(comm, "buckling added nodes", x0, x1, tol);
+  destroy_vecs(x0);
+  destroy_vecs(x1);
+
+  buckling->decref();
+  ksm->decref();
+  aux_mat->decref();
+  gmat->decref();
+  kmat->decref();
+  rhs->decref();
+  assembler->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  test_frequency(comm);
+  test_buckling(comm);
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
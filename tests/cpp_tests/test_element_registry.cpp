@@ -0,0 +1,126 @@
+/*
+  Check the assembly with the registry of element kernels
+
+  The model uses two shell components with different constitutive
+  objects and a third component whose element is derived from a
+  registered shell type. The residual and the Jacobian assembled with
+  the registry must match the assembly through the element objects.
+  The derived element must not match the kernel of its base class, so
+  that it falls back to the per-object path.
+*/
+
+#include "TACSIsoShellConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+/*
+  A shell element derived from a registered type. The registry only
+  matches the exact type, so this element is evaluated through its own
+  virtual functions.
+*/
+class TestDerivedShell : public TACSQuad4Shell {
+ public:
+  TestDerivedShell(TACSShellTransform *transform,
+                   TACSShellConstitutive *con)
+      : TACSQuad4Shell(transform, con) {}
+  const char *getObjectName() { return "TestDerivedShell"; }
+};
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSMaterialProperties *props =
+      new TACSMaterialProperties(2700.0, 921.0, 70e9, 0.3, 270e6, 24e-6,
+                                 230.0);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+
+  // Two components of a registered type with different constitutive
+  // objects and one component of a derived type
+  TACSElement *elems[3];
+  elems[0] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.01));
+  elems[1] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.02));
+  elems[2] = new TestDerivedShell(transform,
+                                  new TACSIsoShellConstitutive(props, 0.015));
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 10, 8, 3, elems, 0.1);
+  assembler->incref();
+
+  TACSElementRegistry *registry = new TACSElementRegistry();
+  registry->incref();
+  TacsRegisterShellElements(registry);
+
+  // The registered type matches, the derived type does not
+  TacsTestCheck(comm, "registered shell has a kernel",
+                registry->findKernel(elems[0]) < 0, 0.0);
+  TacsTestCheck(comm, "derived shell falls back to the element",
+                registry->findKernel(elems[2]) >= 0, 0.0);
+
+  // Set a non-trivial state
+  TACSBVec *vars = assembler->createVec();
+  vars->incref();
+  vars->setRand(-1.0, 1.0);
+  vars->scale(0.01);
+  assembler->setBCs(vars);
+  assembler->setVariables(vars);
+
+  TACSBVec *res0 = assembler->createVec();
+  TACSBVec *res1 = assembler->createVec();
+  TACSBVec *x = assembler->createVec();
+  TACSBVec *y0 = assembler->createVec();
+  TACSBVec *y1 = assembler->createVec();
+  res0->incref();
+  res1->incref();
+  x->incref();
+  y0->incref();
+  y1->incref();
+  x->setRand(-1.0, 1.0);
+  assembler->setBCs(x);
+
+  TACSSchurMat *mat0 = assembler->createSchurMat();
+  TACSSchurMat *mat1 = assembler->createSchurMat();
+  mat0->incref();
+  mat1->incref();
+
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    assembler->setNumThreads(num_threads);
+    char name[128];
+
+    // Assemble through the element objects
+    assembler->setElementRegistry(NULL);
+    assembler->assembleRes(res0);
+    assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat0);
+
+    // Assemble with the registered kernels
+    assembler->setElementRegistry(registry);
+    assembler->assembleRes(res1);
+    assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat1);
+
+    snprintf(name, sizeof(name), "residual with registry, %d thread(s)",
+             num_threads);
+    TacsTestCheck(comm, name, TacsTestRelError(res1, res0), 1e-14);
+    snprintf(name, sizeof(name), "Jacobian with registry, %d thread(s)",
+             num_threads);
+    TacsTestCheck(comm, name, TacsTestMatRelError(mat1, mat0, x, y1, y0),
+                  1e-14);
+  }
+
+  mat0->decref();
+  mat1->decref();
+  res0->decref();
+  res1->decref();
+  x->decref();
+  y0->decref();
+  y1->decref();
+  vars->decref();
+  registry->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,228 @@
+/*
+  Check the shared failure-value cache of the failure functions
+
+  Two KS failure functions and an induced failure function are
+  evaluated on a blade-stiffened shell model, together with their
+  derivatives w.r.t. the states, the design variables and the nodes.
+  The same functions with a shared TACSFailureCache must give
+  bit-identical results, also after the states and the design
+  variables change. The times for an evaluation with the state and
+  design derivatives are printed.
+*/
+
+#include "TACSBladeStiffenedShellConstitutive.h"
+#include "TACSFailureCache.h"
+#include "TACSInducedFailure.h"
+#include "TACSKSFailure.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_FUNCS = 3;
+
+/*
+  Create the failure functions, optionally sharing the failure cache
+*/
+static void create_funcs(TACSAssembler *assembler, TACSFailureCache *cache,
+                         TACSFunction **funcs) {
+  TACSKSFailure *ks1 = new TACSKSFailure(assembler, 50.0);
+  TACSKSFailure *ks2 = new TACSKSFailure(assembler, 100.0);
+  TACSInducedFailure *induced = new TACSInducedFailure(assembler, 20.0);
+  if (cache) {
+    ks1->setFailureCache(cache);
+    ks2->setFailureCache(cache);
+    induced->setFailureCache(cache);
+  }
+  funcs[0] = ks1;
+  funcs[1] = ks2;
+  funcs[2] = induced;
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    funcs[i]->incref();
+  }
+}
+
+/*
+  Evaluate the functions and their derivatives
+*/
+static void eval_funcs(TACSAssembler *assembler, TACSFunction **funcs,
+                       TacsScalar *fvals, TACSBVec **dfdu, TACSBVec **dfdx,
+                       TACSBVec **dfdX) {
+  assembler->evalFunctions(NUM_FUNCS, funcs, fvals);
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    dfdu[i]->zeroEntries();
+    dfdx[i]->zeroEntries();
+    if (dfdX) {
+      dfdX[i]->zeroEntries();
+    }
+  }
+  assembler->addSVSens(1.0, 0.0, 0.0, NUM_FUNCS, funcs, dfdu);
+  assembler->addDVSens(1.0, NUM_FUNCS, funcs, dfdx);
+  if (dfdX) {
+    assembler->addXptSens(1.0, NUM_FUNCS, funcs, dfdX);
+  }
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    dfdx[i]->beginSetValues(TACS_ADD_VALUES);
+    dfdx[i]->endSetValues(TACS_ADD_VALUES);
+    if (dfdX) {
+      dfdX[i]->beginSetValues(TACS_ADD_VALUES);
+      dfdX[i]->endSetValues(TACS_ADD_VALUES);
+    }
+  }
+}
+
+/*
+  Compare the results with and without the cache
+*/
+static void compare(MPI_Comm comm, const char *state, TacsScalar *f0,
+                    TacsScalar *f1, TACSBVec **x0, TACSBVec **x1,
+                    const char *type) {
+  double max_err = 0.0;
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    double err =
+        (x0 ? TacsTestRelError(x1[i], x0[i]) : TacsTestRelError(f1[i], f0[i]));
+    if (err > max_err) {
+      max_err = err;
+    }
+  }
+  char name[128];
+  snprintf(name, sizeof(name), "%s, cached vs uncached %s", state, type);
+  TacsTestCheck(comm, name, max_err, 0.0);
+}
+
+static TACSBVec **create_vecs(TACSAssembler *assembler, int type) {
+  TACSBVec **x = new TACSBVec *[NUM_FUNCS];
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    if (type == 0) {
+      x[i] = assembler->createVec();
+    } else if (type == 1) {
+      x[i] = assembler->createDesignVec();
+    } else {
+      x[i] = assembler->createNodeVec();
+    }
+    x[i]->incref();
+  }
+  return x;
+}
+
+static void destroy_vecs(TACSBVec **x) {
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    x[i]->decref();
+  }
+  delete[] x;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // A carbon-epoxy ply for the panel and the stiffener
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      1550.0, 921.0, 127.9e9, 13.3e9, 13.3e9, 0.32, 0.32, 0.43, 6.4e9, 6.4e9,
+      4.5e9, 2.2e9, 1.4e9, 60e6, 230e6, 60e6, 230e6, 90e6, 90e6, 90e6);
+  TACSOrthotropicPly *ply = new TACSOrthotropicPly(1.25e-4, props);
+
+  const int num_plies = 4;
+  TacsScalar angles[num_plies] = {0.0, -M_PI / 4.0, M_PI / 4.0, M_PI / 2.0};
+  TacsScalar fracs[num_plies] = {0.25, 0.25, 0.25, 0.25};
+  int frac_nums[num_plies] = {-1, -1, -1, -1};
+
+  // The panel and the stiffener thicknesses are the design variables
+  TACSBladeStiffenedShellConstitutive *stiff =
+      new TACSBladeStiffenedShellConstitutive(
+          ply, ply, 5.0 / 6.0, 0.5, -1, 0.15, -1, 2e-3, 0, num_plies, angles,
+          fracs, frac_nums, 0.03, -1, 1.5e-3, 1, num_plies, angles, fracs,
+          frac_nums);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *elem = new TACSQuad4Shell(transform, stiff);
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 8, 6, 1, &elem, 0.05);
+  assembler->incref();
+
+  TACSBVec *vars = assembler->createVec();
+  vars->incref();
+  vars->setRand(-1.0, 1.0);
+  vars->scale(1e-3);
+  assembler->setBCs(vars);
+  assembler->setVariables(vars);
+
+  TACSFailureCache *cache = new TACSFailureCache(assembler);
+  cache->incref();
+
+  TACSFunction *funcs0[NUM_FUNCS], *funcs1[NUM_FUNCS];
+  create_funcs(assembler, NULL, funcs0);
+  create_funcs(assembler, cache, funcs1);
+
+  TACSBVec **dfdu0 = create_vecs(assembler, 0);
+  TACSBVec **dfdu1 = create_vecs(assembler, 0);
+  TACSBVec **dfdx0 = create_vecs(assembler, 1);
+  TACSBVec **dfdx1 = create_vecs(assembler, 1);
+  TACSBVec **dfdX0 = create_vecs(assembler, 2);
+  TACSBVec **dfdX1 = create_vecs(assembler, 2);
+  TacsScalar f0[NUM_FUNCS], f1[NUM_FUNCS];
+
+  // Compare at the initial point, after changing the states and after
+  // changing the design variables
+  const char *states[3] = {"initial point", "new states", "new design"};
+  for (int k = 0; k < 3; k++) {
+    if (k == 1) {
+      vars->scale(2.0);
+      assembler->setVariables(vars);
+    } else if (k == 2) {
+      TACSBVec *x = assembler->createDesignVec();
+      x->incref();
+      assembler->getDesignVars(x);
+      x->scale(1.1);
+      assembler->setDesignVars(x);
+      x->decref();
+    }
+
+    eval_funcs(assembler, funcs0, f0, dfdu0, dfdx0, dfdX0);
+    eval_funcs(assembler, funcs1, f1, dfdu1, dfdx1, dfdX1);
+    compare(comm, states[k], f0, f1, NULL, NULL, "function values");
+    compare(comm, states[k], f0, f1, dfdu0, dfdu1, "state derivatives");
+    compare(comm, states[k], f0, f1, dfdx0, dfdx1, "design derivatives");
+    compare(comm, states[k], f0, f1, dfdX0, dfdX1, "node derivatives");
+  }
+
+  // Time an evaluation with the state and design derivatives. The time
+  // changes between the repetitions so that nothing is re-used from
+  // the previous evaluation.
+  const int num_reps = 20;
+  double t[2];
+  for (int c = 0; c < 2; c++) {
+    TACSFunction **funcs = (c == 0 ? funcs0 : funcs1);
+    MPI_Barrier(comm);
+    t[c] = MPI_Wtime();
+    for (int rep = 0; rep < num_reps; rep++) {
+      assembler->setSimulationTime(1.0 * (2 * rep + c));
+      eval_funcs(assembler, funcs, f0, dfdu0, dfdx0, NULL);
+    }
+    t[c] = (MPI_Wtime() - t[c]) / num_reps;
+  }
+  if (rank == 0) {
+    printf("Evaluation with derivatives: %.2f ms uncached, %.2f ms cached\n",
+           1e3 * t[0], 1e3 * t[1]);
+  }
+
+  for (int i = 0; i < NUM_FUNCS; i++) {
+    funcs0[i]->decref();
+    funcs1[i]->decref();
+  }
+  destroy_vecs(dfdu0);
+  destroy_vecs(dfdu1);
+  destroy_vecs(dfdx0);
+  destroy_vecs(dfdx1);
+  destroy_vecs(dfdX0);
+  destroy_vecs(dfdX1);
+  cache->decref();
+  vars->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
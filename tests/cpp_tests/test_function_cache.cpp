@@ -0,0 +1,119 @@
+/*
+  Check that the function values stored by evalFunctions() are dropped
+  when the model changes
+
+  Changing only the simulation time or only a parameter of the
+  function must discard the stored value. Setting the states to their
+  current values keeps it, while passing the assembler's own state
+  vector after modifying it in place must discard it.
+*/
+
+#include "TACSIsoShellConstitutive.h"
+#include "TACSKSFailure.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e9, 0.3, 270e6, 24e-6, 230.0);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *elems[2];
+  elems[0] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.01));
+  elems[1] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.02));
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 8, 6, 2, elems, 0.1);
+  assembler->incref();
+
+  TACSBVec *vars = assembler->createVec();
+  vars->incref();
+  vars->setRand(-1.0, 1.0);
+  vars->scale(1e-3);
+  assembler->setBCs(vars);
+  assembler->setVariables(vars);
+
+  const double ks_weight = 50.0;
+  TACSFunction *func = new TACSKSFailure(assembler, ks_weight);
+  func->incref();
+
+  TacsScalar value, cached;
+  assembler->evalFunctions(1, &func, &value);
+  TacsTestCheck(comm, "value is stored after evaluation",
+                !func->getCachedValue(&cached), 0.0);
+  TacsTestCheck(comm, "stored value matches the evaluation",
+                TacsTestRelError(cached, value), 0.0);
+
+  // Change only the simulation time
+  assembler->setSimulationTime(1.0);
+  TacsTestCheck(comm, "simulation time change drops the value",
+                func->getCachedValue(&cached), 0.0);
+  assembler->evalFunctions(1, &func, &value);
+  TacsTestCheck(comm, "value is stored at the new time",
+                !func->getCachedValue(&cached), 0.0);
+
+  // Change only the KS weight and compare against a new function
+  // object created with the new weight
+  TACSKSFailure *ks = dynamic_cast<TACSKSFailure *>(func);
+  ks->setParameter(2.0 * ks_weight);
+  TacsTestCheck(comm, "parameter change drops the value",
+                func->getCachedValue(&cached), 0.0);
+
+  TACSFunction *ref = new TACSKSFailure(assembler, 2.0 * ks_weight);
+  ref->incref();
+  TacsScalar new_value, ref_value;
+  assembler->evalFunctions(1, &func, &new_value);
+  assembler->evalFunctions(1, &ref, &ref_value);
+  TacsTestCheck(comm, "value after parameter change",
+                TacsTestRelError(new_value, ref_value), 1e-14);
+  TacsTestCheck(comm, "parameter change modifies the value",
+                TacsTestRelError(new_value, value) == 0.0, 0.0);
+
+  // Setting the states to the same values keeps the stored value
+  TACSBVec *copy = assembler->createVec();
+  copy->incref();
+  assembler->getVariables(copy);
+  int version = assembler->getStateVersion();
+  assembler->setVariables(copy);
+  TacsTestCheck(comm, "same states keep the state version",
+                assembler->getStateVersion() - version, 0.0);
+  TacsTestCheck(comm, "same states keep the value",
+                !func->getCachedValue(&cached), 0.0);
+
+  // Modify the assembler's own state vector in place
+  TACSBVec *own;
+  assembler->getVariables(&own);
+  own->scale(2.0);
+  assembler->setVariables(own);
+  TacsTestCheck(comm, "own state vector changes the state version",
+                assembler->getStateVersion() == version, 0.0);
+  TacsTestCheck(comm, "own state vector drops the value",
+                func->getCachedValue(&cached), 0.0);
+
+  // The evaluation with the modified states matches the evaluation
+  // with the same states set from a separate vector
+  assembler->evalFunctions(1, &func, &new_value);
+  copy->scale(2.0);
+  assembler->setVariables(copy);
+  ref->decref();
+  ref = new TACSKSFailure(assembler, 2.0 * ks_weight);
+  ref->incref();
+  assembler->evalFunctions(1, &ref, &ref_value);
+  TacsTestCheck(comm, "value with the modified own state vector",
+                TacsTestRelError(new_value, ref_value), 1e-14);
+
+  copy->decref();
+  ref->decref();
+  func->decref();
+  vars->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
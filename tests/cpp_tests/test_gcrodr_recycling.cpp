@@ -0,0 +1,106 @@
+/*
+  Check GCRODR on a sequence of solves with a slowly varying operator
+
+  The operators are K + gamma*M for a plane stress model with gamma
+  increasing slowly from one solve to the next, each with the same
+  incomplete factorization preconditioner. GCRODR carries the recycled
+  subspace from one solve to the next. Each solution must satisfy the
+  residual tolerance, agree with the solution from restarted GMRES,
+  and the total number of iterations must be smaller than for GMRES.
+*/
+
+#include "KSM.h"
+#include "tacs_test_utils.h"
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSAssembler *assembler =
+      TacsTestCreatePlaneStressModel(comm, 40, 40, 2, 100.0);
+  assembler->incref();
+
+  TACSParallelMat *mat = assembler->createMat();
+  TACSParallelMat *pc_mat = assembler->createMat();
+  mat->incref();
+  pc_mat->incref();
+
+  // The preconditioner is factored once from the first operator
+  TACSAdditiveSchwarz *pc = new TACSAdditiveSchwarz(pc_mat, 0, 10.0);
+  pc->incref();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, pc_mat);
+  pc->factor();
+
+  const double rtol = 1e-8;
+  const int msub = 40, nrecycle = 10;
+  GCRODR *gcrodr = new GCRODR(mat, pc, msub, nrecycle, 100);
+  gcrodr->incref();
+  gcrodr->setTolerances(rtol, 1e-30);
+
+  GMRES *gmres = new GMRES(mat, pc, msub, 100, 0);
+  gmres->incref();
+  gmres->setTolerances(rtol, 1e-30);
+
+  TACSBVec *b = assembler->createVec();
+  TACSBVec *x0 = assembler->createVec();
+  TACSBVec *x1 = assembler->createVec();
+  TACSBVec *r = assembler->createVec();
+  b->incref();
+  x0->incref();
+  x1->incref();
+  r->incref();
+
+  const int num_solves = 8;
+  int gcrodr_iters = 0, gmres_iters = 0;
+  double max_res = 0.0, max_diff = 0.0;
+  for (int k = 0; k < num_solves; k++) {
+    double gamma = 1e-3 * k;
+    assembler->assembleJacobian(1.0, 0.0, gamma, NULL, mat);
+
+    b->setRand(-1.0, 1.0);
+    assembler->setBCs(b);
+
+    gmres->solve(b, x0);
+    gmres_iters += gmres->getIterCount();
+
+    gcrodr->solve(b, x1);
+    gcrodr_iters += gcrodr->getIterCount();
+
+    double res = TacsTestResidual(mat, x1, b, r);
+    double diff = TacsTestRelError(x1, x0);
+    if (res > max_res) {
+      max_res = res;
+    }
+    if (diff > max_diff) {
+      max_diff = diff;
+    }
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    printf("Total iterations: GCRODR(%d, %d) %d, GMRES(%d) %d\n", msub,
+           nrecycle, gcrodr_iters, msub, gmres_iters);
+  }
+
+  TacsTestCheck(comm, "GCRODR relative residual", max_res, 10.0 * rtol);
+  TacsTestCheck(comm, "GCRODR solution vs GMRES", max_diff, 1e-5);
+  TacsTestCheck(comm, "GCRODR/GMRES total iteration ratio",
+                (1.0 * gcrodr_iters) / gmres_iters, 0.5);
+
+  b->decref();
+  x0->decref();
+  x1->decref();
+  r->decref();
+  gmres->decref();
+  gcrodr->decref();
+  pc->decref();
+  mat->decref();
+  pc_mat->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,150 @@
+/*
+  Check the forward and reverse transfers of TACSBVecDistribute
+
+  Every processor requests values from all the processors, including
+  itself. The owned values change between repeated forward transfers,
+  and the transferred values must be exactly the owned values. The
+  reverse transfer, with added and inserted values, must give exactly
+  the values computed by a reduction over all processors. When the
+  on-node values are exchanged through shared memory windows
+  (TACS_USE_SHARED_MEMORY_HALO), the results must be the same as with
+  messages and, with all the processors on one node, no processor may
+  exchange messages.
+*/
+
+#include "TACSBVecDistribute.h"
+#include "tacs_test_utils.h"
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Create an uneven distribution of the nodes
+  const int bsize = 3;
+  const int num_owned = 10 + rank;
+  TACSNodeMap *map = new TACSNodeMap(comm, num_owned);
+  map->incref();
+  const int *range;
+  map->getOwnerRange(&range);
+  const int num_nodes = range[size];
+
+  // Request a strided set of nodes that spans all the processors
+  const int num_local = 2 * num_nodes / 3;
+  int *indices = new int[num_local];
+  for (int i = 0; i < num_local; i++) {
+    indices[i] = (3 * i + rank) % num_nodes;
+  }
+  TACSBVecIndices *local_indices = new TACSBVecIndices(&indices, num_local);
+  TACSBVecDistribute *dist = new TACSBVecDistribute(map, local_indices);
+  dist->incref();
+  TACSBVecDistCtx *ctx = dist->createCtx(bsize);
+  ctx->incref();
+
+  const int *index;
+  local_indices->getIndices(&index);
+
+  TacsScalar *global = new TacsScalar[bsize * num_owned];
+  TacsScalar *local = new TacsScalar[bsize * num_local];
+
+  // Repeat the forward transfer with new owned values each time
+  const int num_reps = 20;
+  double fwd_err = 0.0;
+  for (int rep = 0; rep < num_reps; rep++) {
+    for (int i = 0; i < num_owned; i++) {
+      for (int k = 0; k < bsize; k++) {
+        global[bsize * i + k] = 100.0 * (range[rank] + i) + k + 1000.0 * rep;
+      }
+    }
+    dist->beginForward(ctx, global, local);
+    dist->endForward(ctx, global, local);
+    for (int i = 0; i < num_local; i++) {
+      for (int k = 0; k < bsize; k++) {
+        double value = 100.0 * index[i] + k + 1000.0 * rep;
+        fwd_err += fabs(TacsRealPart(local[bsize * i + k]) - value);
+      }
+    }
+  }
+  TacsTestCheck(comm, "repeated forward transfers", fwd_err, 0.0);
+
+  // Compute the reverse transfer of the added values with a reduction
+  // over all the processors
+  TacsScalar *sum = new TacsScalar[bsize * num_nodes];
+  memset(sum, 0, bsize * num_nodes * sizeof(TacsScalar));
+  for (int i = 0; i < num_local; i++) {
+    for (int k = 0; k < bsize; k++) {
+      TacsScalar value = 1.0 * (rank + 1) * (i + 1) + k;
+      local[bsize * i + k] = value;
+      sum[bsize * index[i] + k] += value;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, sum, bsize * num_nodes, TACS_MPI_TYPE, MPI_SUM,
+                comm);
+
+  double rev_err = 0.0;
+  for (int rep = 0; rep < num_reps; rep++) {
+    memset(global, 0, bsize * num_owned * sizeof(TacsScalar));
+    dist->beginReverse(ctx, local, global, TACS_ADD_VALUES);
+    dist->endReverse(ctx, local, global, TACS_ADD_VALUES);
+    for (int i = 0; i < bsize * num_owned; i++) {
+      rev_err += fabs(TacsRealPart(global[i] - sum[bsize * range[rank] + i]));
+    }
+  }
+  TacsTestCheck(comm, "repeated reverse transfers, added values", rev_err,
+                0.0);
+
+  // Insert the values, which are the same on all the processors
+  for (int i = 0; i < num_local; i++) {
+    for (int k = 0; k < bsize; k++) {
+      local[bsize * i + k] = 100.0 * index[i] + k;
+    }
+  }
+  memset(global, 0, bsize * num_owned * sizeof(TacsScalar));
+  dist->beginReverse(ctx, local, global, TACS_INSERT_VALUES);
+  dist->endReverse(ctx, local, global, TACS_INSERT_VALUES);
+  double ins_err = 0.0;
+  for (int i = 0; i < num_owned; i++) {
+    for (int k = 0; k < bsize; k++) {
+      double value = 100.0 * (range[rank] + i) + k;
+      ins_err += fabs(TacsRealPart(global[bsize * i + k]) - value);
+    }
+  }
+  TacsTestCheck(comm, "reverse transfer, inserted values", ins_err, 0.0);
+
+  // Count the processors that exchange messages on any processor
+  int num_msg = dist->getNumMessageProcs();
+  MPI_Allreduce(MPI_IN_PLACE, &num_msg, 1, MPI_INT, MPI_SUM, comm);
+  if (rank == 0) {
+    printf("%d processors exchange values through messages\n", num_msg);
+  }
+#ifdef TACS_USE_SHARED_MEMORY_WINDOWS
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                      &node_comm);
+  int node_size;
+  MPI_Comm_size(node_comm, &node_size);
+  MPI_Comm_free(&node_comm);
+  if (node_size == size) {
+    TacsTestCheck(comm, "processors exchanging messages on one node",
+                  num_msg, 0.0);
+  }
+#else
+  TacsTestCheck(comm, "processors exchanging messages",
+                (size > 1 && num_msg == 0), 0.0);
+#endif  // TACS_USE_SHARED_MEMORY_WINDOWS
+
+  delete[] global;
+  delete[] local;
+  delete[] sum;
+  ctx->decref();
+  dist->decref();
+  map->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
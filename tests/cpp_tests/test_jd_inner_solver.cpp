@@ -0,0 +1,200 @@
+/*
+  Check the recycled subspace and the shift update of the inner
+  Jacobi-Davidson solves
+
+  The five smallest eigenvalues of a generalized problem, a 1D Laplacian
+  with a varying diagonal mass matrix, are computed with the default
+  inner FGMRES solves, with a recycled subspace, with the shift update
+  of the preconditioner and with both. The preconditioner is an exact
+  factorization of A - 0.9*sigma*B, where sigma is the last eigenvalue
+  estimate passed to the operator. All the options
+  must give the same eigenvalues with small residuals. The shift update
+  must reduce the total number of inner iterations, counted as
+  applications of the preconditioner. The counts are printed.
+*/
+
+#include "JacobiDavidson.h"
+#include "TACSElementVerification.h"
+#include "tacs_test_utils.h"
+
+/*
+  The operators A = tridiag(-1, 2, -1) and B = diag(1 + i/n)
+*/
+class TestJDOperator : public TACSJacobiDavidsonOperator {
+ public:
+  TestJDOperator(MPI_Comm _comm, int _n) {
+    comm = _comm;
+    n = _n;
+    sigma = 0.0;
+    num_factor = 0;
+  }
+
+  MPI_Comm getMPIComm() { return comm; }
+  TACSVec *createVec() { return new TACSBVec(comm, n, 1); }
+
+  void setEigenvalueEstimate(double estimate) { sigma = estimate; }
+  int updateEigenvalueEstimate(double estimate) {
+    sigma = estimate;
+    return 1;
+  }
+
+  // Solve (A - 0.9*sigma*B)*y = x with the Thomas algorithm
+  void applyFactor(TACSVec *x, TACSVec *y) {
+    TacsScalar *xa, *ya;
+    ((TACSBVec *)x)->getArray(&xa);
+    ((TACSBVec *)y)->getArray(&ya);
+    double *c = new double[n];
+    TacsScalar *d = new TacsScalar[n];
+    for (int i = 0; i < n; i++) {
+      double diag = 2.0 - 0.9 * sigma * b(i);
+      if (i == 0) {
+        c[i] = -1.0 / diag;
+        d[i] = xa[i] / diag;
+      } else {
+        double den = diag + c[i - 1];
+        c[i] = -1.0 / den;
+        d[i] = (xa[i] + d[i - 1]) / den;
+      }
+    }
+    ya[n - 1] = d[n - 1];
+    for (int i = n - 2; i >= 0; i--) {
+      ya[i] = d[i] - c[i] * ya[i + 1];
+    }
+    delete[] c;
+    delete[] d;
+    num_factor++;
+  }
+
+  TacsScalar dot(TACSVec *x, TACSVec *y) {
+    TacsScalar *xa, *ya;
+    ((TACSBVec *)x)->getArray(&xa);
+    ((TACSBVec *)y)->getArray(&ya);
+    TacsScalar value = 0.0;
+    for (int i = 0; i < n; i++) {
+      value += xa[i] * b(i) * ya[i];
+    }
+    return value;
+  }
+
+  void multA(TACSVec *x, TACSVec *y) {
+    TacsScalar *xa, *ya;
+    ((TACSBVec *)x)->getArray(&xa);
+    ((TACSBVec *)y)->getArray(&ya);
+    for (int i = 0; i < n; i++) {
+      ya[i] = 2.0 * xa[i];
+      if (i > 0) {
+        ya[i] -= xa[i - 1];
+      }
+      if (i < n - 1) {
+        ya[i] -= xa[i + 1];
+      }
+    }
+  }
+
+  void multB(TACSVec *x, TACSVec *y) {
+    TacsScalar *xa, *ya;
+    ((TACSBVec *)x)->getArray(&xa);
+    ((TACSBVec *)y)->getArray(&ya);
+    for (int i = 0; i < n; i++) {
+      ya[i] = b(i) * xa[i];
+    }
+  }
+
+  int num_factor;
+
+ private:
+  double b(int i) { return 1.0 + (1.0 * i) / n; }
+
+  MPI_Comm comm;
+  int n;
+  double sigma;
+};
+
+static const int NUM_EIGS = 5;
+
+/*
+  Solve the eigenproblem and return the number of inner iterations
+*/
+static int solve(MPI_Comm comm, int num_inner_recycle, double shift_rtol,
+                 TacsScalar *eigs, double *max_error) {
+  TestJDOperator *oper = new TestJDOperator(comm, 100);
+  oper->incref();
+
+  TACSJacobiDavidson *jd = new TACSJacobiDavidson(oper, NUM_EIGS, 40, 30);
+  jd->incref();
+  jd->setTolerances(1e-8, 1e-30, 0.1, 1e-30);
+  jd->setInnerRecycle(num_inner_recycle);
+  jd->setShiftUpdate(shift_rtol);
+
+  TacsSeedRandomGenerator(0);
+  jd->solve();
+
+  *max_error = 0.0;
+  int nconv = jd->getNumConvergedEigenvalues();
+  for (int i = 0; i < NUM_EIGS; i++) {
+    TacsScalar error = 1.0;
+    eigs[i] = 0.0;
+    if (i < nconv) {
+      eigs[i] = jd->extractEigenvalue(i, &error);
+    }
+    if (TacsRealPart(error) > *max_error) {
+      *max_error = TacsRealPart(error);
+    }
+  }
+
+  int num_inner = oper->num_factor;
+  jd->decref();
+  oper->decref();
+  return num_inner;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  const int num_cases = 4;
+  const char *names[num_cases] = {"default", "recycled subspace",
+                                  "shift update", "recycled subspace and shift"};
+  const int num_recycle[num_cases] = {0, 5, 0, 5};
+  const double shift_rtol[num_cases] = {-1.0, -1.0, 0.01, 0.01};
+
+  TacsScalar eigs[num_cases][NUM_EIGS];
+  int num_inner[num_cases];
+  for (int k = 0; k < num_cases; k++) {
+    double max_error;
+    num_inner[k] =
+        solve(comm, num_recycle[k], shift_rtol[k], eigs[k], &max_error);
+    if (rank == 0) {
+      printf("%s: %d inner iterations\n", names[k], num_inner[k]);
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "%s eigenvector residual", names[k]);
+    TacsTestCheck(comm, name, max_error, 1e-8);
+    if (k > 0) {
+      double err = 0.0;
+      for (int i = 0; i < NUM_EIGS; i++) {
+        double e = TacsTestRelError(eigs[k][i], eigs[0][i]);
+        if (e > err) {
+          err = e;
+        }
+      }
+      snprintf(name, sizeof(name), "%s vs default eigenvalues", names[k]);
+      TacsTestCheck(comm, name, err, 1e-10);
+    }
+  }
+
+  // The shift update must cut the inner iterations by at least 4x
+  TacsTestCheck(comm, "shift update inner iteration reduction",
+                4 * num_inner[2] > num_inner[0], 0.0);
+  TacsTestCheck(comm, "recycled subspace and shift inner iteration reduction",
+                4 * num_inner[3] > num_inner[0], 0.0);
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
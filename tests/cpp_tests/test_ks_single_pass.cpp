@@ -0,0 +1,140 @@
+/*
+  Check the single-pass KS failure function against a two-pass
+  evaluation
+
+  The reference first finds the maximum failure value over all
+  quadrature points and processors and then sums the exponentials
+  scaled by that maximum, as the two-stage evaluation did. The
+  single-pass function rescales its running sum whenever a larger
+  value is found and merges the partial sums from the threads and the
+  processors. The values must agree to round-off for the discrete and
+  continuous KS functions, with one and several threads.
+*/
+
+#include "TACSIsoShellConstitutive.h"
+#include "TACSKSFailure.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+/*
+  Evaluate the KS failure function in two passes over the elements
+*/
+static TacsScalar two_pass_ks(TACSAssembler *assembler, double ks_weight,
+                              int continuous) {
+  int max_nodes = assembler->getMaxElementNodes();
+  int max_vars = assembler->getMaxElementVariables();
+  TacsScalar *Xpts = new TacsScalar[3 * max_nodes];
+  TacsScalar *vars = new TacsScalar[max_vars];
+  TacsScalar *dvars = new TacsScalar[max_vars];
+  TacsScalar *ddvars = new TacsScalar[max_vars];
+  double time = assembler->getSimulationTime();
+
+  TacsScalar max_fail = -1e20, ks_sum = 0.0;
+  for (int pass = 0; pass < 2; pass++) {
+    for (int i = 0; i < assembler->getNumElements(); i++) {
+      TACSElement *element =
+          assembler->getElement(i, Xpts, vars, dvars, ddvars);
+      for (int n = 0; n < element->getNumQuadraturePoints(); n++) {
+        double pt[3];
+        double weight = element->getQuadraturePoint(n, pt);
+        TacsScalar fail = 0.0, detXd = 0.0;
+        int count = element->evalPointQuantity(
+            i, TACS_FAILURE_INDEX, time, n, pt, Xpts, vars, dvars, ddvars,
+            &detXd, &fail);
+        if (count >= 1) {
+          if (pass == 0) {
+            if (TacsRealPart(fail) > TacsRealPart(max_fail)) {
+              max_fail = fail;
+            }
+          } else {
+            TacsScalar w = (continuous ? weight * detXd : 1.0);
+            ks_sum += w * exp(ks_weight * (fail - max_fail));
+          }
+        }
+      }
+    }
+
+    MPI_Comm comm = assembler->getMPIComm();
+    if (pass == 0) {
+      TacsScalar local = max_fail;
+      MPI_Allreduce(&local, &max_fail, 1, TACS_MPI_TYPE, TACS_MPI_MAX, comm);
+    } else {
+      TacsScalar local = ks_sum;
+      MPI_Allreduce(&local, &ks_sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
+    }
+  }
+
+  delete[] Xpts;
+  delete[] vars;
+  delete[] dvars;
+  delete[] ddvars;
+
+  return max_fail + log(ks_sum) / ks_weight;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e9, 0.3, 270e6, 24e-6, 230.0);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *elems[2];
+  elems[0] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.01));
+  elems[1] = new TACSQuad4Shell(transform,
+                                new TACSIsoShellConstitutive(props, 0.02));
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 12, 10, 2, elems, 0.1);
+  assembler->incref();
+
+  // A state for which many points contribute to the KS sum
+  TACSBVec *vars = assembler->createVec();
+  vars->incref();
+  vars->setRand(-1.0, 1.0);
+  vars->scale(2e-4);
+  assembler->setBCs(vars);
+  assembler->setVariables(vars);
+
+  const int num_weights = 2;
+  const double ks_weights[num_weights] = {10.0, 200.0};
+
+  for (int k = 0; k < num_weights; k++) {
+    for (int continuous = 0; continuous < 2; continuous++) {
+      TacsScalar ref = two_pass_ks(assembler, ks_weights[k], continuous);
+
+      TACSKSFailure *ks = new TACSKSFailure(assembler, ks_weights[k]);
+      ks->incref();
+      ks->setKSFailureType(continuous ? TACSKSFailure::CONTINUOUS
+                                      : TACSKSFailure::DISCRETE);
+
+      for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+        assembler->setNumThreads(num_threads);
+        TACSFunction *func = ks;
+        TacsScalar value;
+        assembler->evalFunctions(1, &func, &value);
+
+        char name[128];
+        snprintf(name, sizeof(name), "%s KS, weight %g, %d thread(s)",
+                 (continuous ? "continuous" : "discrete"), ks_weights[k],
+                 num_threads);
+        TacsTestCheck(comm, name, TacsTestRelError(value, ref), 1e-13);
+
+        // Drop the stored value so that the next thread count
+        // evaluates the function again
+        ks->setParameter(ks_weights[k]);
+      }
+      ks->decref();
+    }
+  }
+  assembler->setNumThreads(1);
+
+  vars->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,123 @@
+/*
+  Check the LOBPCG eigensolver against the shift-invert Lanczos method
+
+  The ten lowest natural frequencies of a plane stress model are
+  computed with Lanczos using a direct factorization, and with LOBPCG
+  using an ILU(2) additive Schwarz preconditioner and a block of 16
+  vectors. The eigenvalues must agree and LOBPCG must converge within
+  the iteration limit. A second solve is started from the previous
+  eigenvectors and must converge in a few iterations.
+*/
+
+#include "KSM.h"
+#include "TACSBuckling.h"
+#include "TACSSchurMat.h"
+#include "tacs_test_utils.h"
+
+/*
+  Record the number of iterations from the summary printed at the end
+  of the LOBPCG solve
+*/
+class TestLOBPCGPrint : public KSMPrint {
+ public:
+  TestLOBPCGPrint() { iters = -1; }
+  void printResidual(int iter, TacsScalar res) {}
+  void print(const char *cstr) {
+    int nconv, neigs, n;
+    if (sscanf(cstr, "LOBPCG: %d of %d eigenvalues converged in %d", &nconv,
+               &neigs, &n) == 3) {
+      iters = n;
+    }
+  }
+  int iters;
+};
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSAssembler *assembler = TacsTestCreatePlaneStressModel(comm, 80, 40);
+  assembler->incref();
+
+  const int num_eigvals = 10;
+  const int max_iters = 200;
+
+  // The reference eigenvalues from Lanczos
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  TACSSchurMat *mmat = assembler->createSchurMat();
+  kmat->incref();
+  mmat->incref();
+  TACSSchurPc *direct = new TACSSchurPc(kmat, 10000, 10.0, 1);
+  GMRES *ksm = new GMRES(kmat, direct, 15, 0, 0);
+  ksm->incref();
+  ksm->setTolerances(1e-12, 1e-30);
+
+  TACSFrequencyAnalysis *lanczos = new TACSFrequencyAnalysis(
+      assembler, 0.0, mmat, kmat, ksm, 60, num_eigvals, 1e-12);
+  lanczos->incref();
+  lanczos->solve();
+
+  TacsScalar ref[num_eigvals];
+  for (int k = 0; k < num_eigvals; k++) {
+    TacsScalar error;
+    ref[k] = lanczos->extractEigenvalue(k, &error);
+  }
+  lanczos->decref();
+  ksm->decref();
+  kmat->decref();
+  mmat->decref();
+
+  // LOBPCG with the additive Schwarz preconditioner
+  TACSParallelMat *pkmat = assembler->createMat();
+  TACSParallelMat *pmmat = assembler->createMat();
+  TACSParallelMat *pcmat = assembler->createMat();
+  TACSAdditiveSchwarz *pc = new TACSAdditiveSchwarz(pcmat, 2, 10.0);
+  TACSFrequencyAnalysis *freq = new TACSFrequencyAnalysis(
+      assembler, 0.0, pmmat, pkmat, pcmat, pc, 40, 20, num_eigvals, 1e-10);
+  freq->incref();
+  freq->setLOBPCG(16, max_iters);
+
+  TestLOBPCGPrint *print = new TestLOBPCGPrint();
+  print->incref();
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  for (int solve = 0; solve < 2; solve++) {
+    print->iters = -1;
+    freq->solve(print);
+
+    double max_err = 0.0;
+    for (int k = 0; k < num_eigvals; k++) {
+      TacsScalar error;
+      TacsScalar eig = freq->extractEigenvalue(k, &error);
+      double err = TacsTestRelError(eig, ref[k]);
+      if (err > max_err) {
+        max_err = err;
+      }
+    }
+
+    const char *type = (solve == 0 ? "initial" : "warm-started");
+    if (rank == 0) {
+      printf("LOBPCG %s solve: %d iterations\n", type, print->iters);
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "LOBPCG %s solve vs Lanczos", type);
+    TacsTestCheck(comm, name, max_err, 1e-10);
+    snprintf(name, sizeof(name), "LOBPCG %s solve converges", type);
+    TacsTestCheck(comm, name, print->iters < 0 || print->iters >= max_iters,
+                  0.0);
+    snprintf(name, sizeof(name), "LOBPCG %s iterations", type);
+    TacsTestCheck(comm, name, print->iters, (solve == 0 ? 80.0 : 2.0));
+  }
+
+  print->decref();
+  freq->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
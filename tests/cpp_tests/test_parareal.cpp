@@ -0,0 +1,142 @@
+/*
+  Check the Parareal integrator against the serial fine integrator
+
+  The world communicator is split into four time slabs, each with a
+  copy of a plane stress model with a non-zero initial velocity. The
+  Parareal iteration is run to completion. The states at the end of
+  each slab must agree to round-off with the serial fine propagation
+  through the slabs, computed with one TACSBDFIntegrator per slab. The
+  end state of the last slab is also compared with a single
+  TACSBDFIntegrator over the whole interval with the same total number
+  of steps. This differs by the restart of the BDF order at each slab,
+  which is a first-order error in the time step. The number of
+  iterations and the times are printed.
+*/
+
+#include "TACSIntegrator.h"
+#include "TACSPararealIntegrator.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_SLABS = 4;
+static const int NUM_COARSE_STEPS = 5;
+static const int NUM_FINE_STEPS = 50;
+
+/*
+  Integrate from the given states and copy the final states
+*/
+static void integrate(TACSAssembler *assembler, double t0, double t1,
+                      int num_steps, TACSBVec *in[], TACSBVec *out[]) {
+  TACSBDFIntegrator *integ =
+      new TACSBDFIntegrator(assembler, t0, t1, num_steps, 2);
+  integ->incref();
+  assembler->setInitConditions(in[0], in[1], in[2]);
+  integ->integrate();
+
+  TACSBVec *q, *qdot, *qddot;
+  integ->getStates(integ->getNumTimeSteps(), &q, &qdot, &qddot);
+  out[0]->copyValues(q);
+  out[1]->copyValues(qdot);
+  out[2]->copyValues(qddot);
+  integ->decref();
+}
+
+/*
+  Compute the relative error in the displacements and velocities
+*/
+static double state_error(TACSBVec *u[], TACSBVec *v[]) {
+  double e0 = TacsTestRelError(u[0], v[0]);
+  double e1 = TacsTestRelError(u[1], v[1]);
+  return (e0 > e1 ? e0 : e1);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  MPI_Comm slab_comm = TACSPararealIntegrator::createSlabComm(comm, NUM_SLABS);
+  TACSAssembler *assembler = TacsTestCreatePlaneStressModel(slab_comm, 20, 10);
+  assembler->incref();
+
+  TACSBVec *init[3], *states[3], *ref[3];
+  for (int i = 0; i < 3; i++) {
+    init[i] = assembler->createVec();
+    states[i] = assembler->createVec();
+    ref[i] = assembler->createVec();
+    init[i]->incref();
+    states[i]->incref();
+    ref[i]->incref();
+  }
+  init[1]->set(1.0);
+  assembler->applyBCs(init[1]);
+  assembler->setInitConditions(init[0], init[1], init[2]);
+
+  const double tinit = 0.0, tfinal = 1.0;
+  TACSPararealIntegrator *parareal = new TACSPararealIntegrator(
+      comm, assembler, tinit, tfinal, NUM_COARSE_STEPS, NUM_FINE_STEPS);
+  parareal->incref();
+  parareal->setTolerance(1e-14);
+  parareal->setMaxIterations(NUM_SLABS);
+
+  double t_parareal = MPI_Wtime();
+  int fail = parareal->solve();
+  t_parareal = MPI_Wtime() - t_parareal;
+
+  TACSBVec *end[3];
+  parareal->getFinalStates(&end[0], &end[1], &end[2]);
+  const int slab = parareal->getSlabIndex();
+
+  // Propagate serially through the slabs with the fine integrator
+  double t_serial = MPI_Wtime();
+  for (int i = 0; i < 3; i++) {
+    states[i]->copyValues(init[i]);
+  }
+  double slab_err = 0.0;
+  for (int n = 0; n < NUM_SLABS; n++) {
+    double t0 = tinit + (tfinal - tinit) * n / NUM_SLABS;
+    double t1 = tinit + (tfinal - tinit) * (n + 1) / NUM_SLABS;
+    integrate(assembler, t0, t1, NUM_FINE_STEPS, states, states);
+    if (n == slab) {
+      slab_err = state_error(end, states);
+    }
+  }
+  t_serial = MPI_Wtime() - t_serial;
+
+  // Integrate over the whole interval with a single integrator
+  double full_err = 0.0;
+  integrate(assembler, tinit, tfinal, NUM_SLABS * NUM_FINE_STEPS, init, ref);
+  if (slab == NUM_SLABS - 1) {
+    full_err = state_error(end, ref);
+  }
+  double err[2] = {slab_err, full_err}, max_err[2];
+  MPI_Allreduce(err, max_err, 2, MPI_DOUBLE, MPI_MAX, comm);
+
+  if (rank == 0) {
+    printf("Parareal: %d iterations on %d slabs, %.3f s; "
+           "serial fine propagation %.3f s\n",
+           parareal->getNumIterations(), NUM_SLABS, t_parareal, t_serial);
+    printf("end state error vs single fine integrator: %.3e\n", max_err[1]);
+  }
+
+  TacsTestCheck(comm, "Parareal propagator failure", fail, 0.0);
+  TacsTestCheck(comm, "Parareal vs serial fine slab end states", max_err[0],
+                1e-10);
+  TacsTestCheck(comm, "Parareal vs single fine integrator end state",
+                max_err[1], 5e-2);
+
+  parareal->decref();
+  for (int i = 0; i < 3; i++) {
+    init[i]->decref();
+    states[i]->decref();
+    ref[i]->decref();
+  }
+  assembler->decref();
+  MPI_Comm_free(&slab_comm);
+
+  int fail_flag = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail_flag;
+}
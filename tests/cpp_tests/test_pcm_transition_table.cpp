@@ -0,0 +1,149 @@
+/*
+  Check the tabulated phase change transition against the analytic
+  transition functions
+
+  The cubic Hermite table reproduces the transition coefficient, the
+  specific heat and their temperature derivatives at the table nodes,
+  and converges at fourth order at the midpoints. The
+  derivative of the tabulated specific heat is checked against a
+  complex step in the complex build and a central difference in the
+  real build.
+*/
+
+#include "TACSPhaseChangeMaterialConstitutive.h"
+#include "tacs_test_utils.h"
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSMaterialProperties *solid =
+      new TACSMaterialProperties(900.0, 1500.0, 1e9, 0.3, 1e6, 1e-5, 0.2);
+  TACSMaterialProperties *liquid =
+      new TACSMaterialProperties(800.0, 2100.0, 1e9, 0.3, 1e6, 1e-5, 0.15);
+  double lh = 2e5, Tm = 300.0, dT = 10.0;
+
+  TACSPhaseChangeMaterialConstitutive *exact =
+      new TACSPhaseChangeMaterialConstitutive(solid, liquid, lh, Tm, dT);
+  TACSPhaseChangeMaterialConstitutive *tab =
+      new TACSPhaseChangeMaterialConstitutive(solid, liquid, lh, Tm, dT);
+  exact->incref();
+  tab->incref();
+
+  // Compare the table with the exact values at the nodes and midpoints
+  // for two table spacings. The transition coefficient changes over a
+  // small fraction of dT, so the spacing must resolve that region.
+  const double width = 20.0;
+  const int num_tables = 2;
+  const int table_npts[num_tables] = {2001, 4001};
+  const char *names[4] = {"B", "dB/dT", "specific heat",
+                          "d(specific heat)/dT"};
+  double mid_errors[num_tables][4];
+
+  double pt[2] = {0.0, 0.0};
+  TacsScalar X[3] = {0.0, 0.0, 0.0};
+  for (int n = 0; n < num_tables; n++) {
+    const int npts = table_npts[n];
+    const double step = 2.0 * width / (npts - 1);
+    tab->setTransitionTable(npts, width);
+
+    double node_err[4] = {0.0, 0.0, 0.0, 0.0};
+    double mid_err[4] = {0.0, 0.0, 0.0, 0.0};
+    double scale[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int i = 0; i < 2 * (npts - 1); i++) {
+      TacsScalar T = Tm - width + 0.5 * i * step;
+
+      TacsScalar ue[1] = {T}, ut[1] = {T};
+      TacsScalar ce = exact->evalSpecificHeat(0, pt, X, ue);
+      TacsScalar ct = tab->evalSpecificHeat(0, pt, X, ut);
+      TacsScalar dce = 0.0, dct = 0.0;
+      exact->addSpecificHeatSVSens(0, pt, X, &dce, ue);
+      tab->addSpecificHeatSVSens(0, pt, X, &dct, ut);
+
+      double ref[4], val[4];
+      ref[0] = TacsRealPart(exact->evalTransitionCoef(T));
+      val[0] = TacsRealPart(tab->evalTransitionCoef(T));
+      ref[1] = TacsRealPart(exact->evalTransitionCoefSVSens(T));
+      val[1] = TacsRealPart(tab->evalTransitionCoefSVSens(T));
+      ref[2] = TacsRealPart(ce);
+      val[2] = TacsRealPart(ct);
+      ref[3] = TacsRealPart(dce);
+      val[3] = TacsRealPart(dct);
+
+      double *err = (i % 2 == 0 ? node_err : mid_err);
+      for (int k = 0; k < 4; k++) {
+        if (fabs(val[k] - ref[k]) > err[k]) {
+          err[k] = fabs(val[k] - ref[k]);
+        }
+        if (fabs(ref[k]) > scale[k]) {
+          scale[k] = fabs(ref[k]);
+        }
+      }
+    }
+
+    char descript[128];
+    for (int k = 0; k < 4; k++) {
+      snprintf(descript, sizeof(descript), "%d-point table nodes: %s", npts,
+               names[k]);
+      TacsTestCheck(comm, descript, node_err[k] / scale[k], 1e-12);
+      mid_errors[n][k] = mid_err[k] / scale[k];
+    }
+  }
+
+  // The values and derivatives converge at fourth order at the
+  // midpoints, where the third order term of the derivative error
+  // vanishes
+  char descript[128];
+  for (int k = 0; k < 4; k++) {
+    snprintf(descript, sizeof(descript), "%d-point table midpoints: %s",
+             table_npts[num_tables - 1], names[k]);
+    TacsTestCheck(comm, descript, mid_errors[num_tables - 1][k], 1e-5);
+  }
+  for (int k = 0; k < 4; k++) {
+    double order = log(mid_errors[0][k] / mid_errors[1][k]) / log(2.0);
+    snprintf(descript, sizeof(descript),
+             "midpoint convergence order deficit: %s", names[k]);
+    TacsTestCheck(comm, descript, 4.0 - order, 0.5);
+  }
+
+  // Check the derivative of the tabulated specific heat at points
+  // that are neither nodes nor midpoints
+  double deriv_err = 0.0, deriv_scale = 0.0;
+  for (int i = 0; i < 97; i++) {
+    double T = Tm - 0.9 * width + 1.8 * width * (i + 0.37) / 97;
+    TacsScalar u[1] = {T};
+    TacsScalar dc = 0.0;
+    tab->addSpecificHeatSVSens(0, pt, X, &dc, u);
+#ifdef TACS_USE_COMPLEX
+    double dh = 1e-30;
+    u[0] = TacsScalar(T, dh);
+    double fd = TacsImagPart(tab->evalSpecificHeat(0, pt, X, u)) / dh;
+#else
+    double dh = 1e-5;
+    u[0] = T + dh;
+    double fd = tab->evalSpecificHeat(0, pt, X, u);
+    u[0] = T - dh;
+    fd = 0.5 * (fd - tab->evalSpecificHeat(0, pt, X, u)) / dh;
+#endif
+    if (fabs(fd - TacsRealPart(dc)) > deriv_err) {
+      deriv_err = fabs(fd - TacsRealPart(dc));
+    }
+    if (fabs(fd) > deriv_scale) {
+      deriv_scale = fabs(fd);
+    }
+  }
+#ifdef TACS_USE_COMPLEX
+  TacsTestCheck(comm, "table derivative vs complex step",
+                deriv_err / deriv_scale, 1e-12);
+#else
+  TacsTestCheck(comm, "table derivative vs central difference",
+                deriv_err / deriv_scale, 1e-7);
+#endif
+
+  exact->decref();
+  tab->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
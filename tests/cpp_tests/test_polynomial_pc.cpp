@@ -0,0 +1,100 @@
+/*
+  Check the Chebyshev and GMRES polynomial preconditioners
+
+  A plane stress model is solved with flexible GMRES(60) without a
+  preconditioner, with the Chebyshev polynomial preconditioner and with
+  the GMRES polynomial preconditioner wrapped around a symmetric l1
+  Gauss-Seidel sweep. The unpreconditioned solve must not converge in
+  the allowed iterations, while both polynomial preconditioners must
+  converge in a small number of iterations to a solution that
+  satisfies the residual tolerance.
+*/
+
+#include "KSM.h"
+#include "tacs_test_utils.h"
+
+/*
+  Solve with FGMRES(60) and return the number of iterations, or -1 if
+  the solve did not converge
+*/
+static int solve_with_pc(MPI_Comm comm, const char *name, TACSMat *mat,
+                         TACSPc *pc, int nrestart, TACSBVec *b, TACSBVec *x,
+                         TACSBVec *r, double rtol) {
+  GMRES *gmres = new GMRES(mat, pc, 60, nrestart, 1);
+  gmres->incref();
+  gmres->setTolerances(rtol, 1e-30);
+  gmres->solve(b, x);
+  int iters = gmres->getIterCount();
+  gmres->decref();
+
+  double res = TacsTestResidual(mat, x, b, r);
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    printf("%s: %d iterations, relative residual %.3e\n", name, iters, res);
+  }
+  if (res > 10.0 * rtol) {
+    return -1;
+  }
+  return iters;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSAssembler *assembler = TacsTestCreatePlaneStressModel(comm, 80, 40);
+  assembler->incref();
+
+  TACSParallelMat *mat = assembler->createMat();
+  mat->incref();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+
+  TACSBVec *b = assembler->createVec();
+  TACSBVec *x = assembler->createVec();
+  TACSBVec *r = assembler->createVec();
+  b->incref();
+  x->incref();
+  r->incref();
+  b->setRand(-1.0, 1.0);
+  assembler->setBCs(b);
+
+  const double rtol = 1e-8;
+
+  // Without a preconditioner, 20 restarts are not enough
+  int iters = solve_with_pc(comm, "no preconditioner", mat, NULL, 20, b, x, r,
+                            rtol);
+  TacsTestCheck(comm, "no preconditioner does not converge", iters >= 0,
+                0.0);
+
+  // The Chebyshev polynomial with degree up to 30
+  TACSChebyshevPc *cheb = new TACSChebyshevPc(mat, 30);
+  cheb->incref();
+  cheb->factor();
+  iters = solve_with_pc(comm, "Chebyshev", mat, cheb, 20, b, x, r, rtol);
+  TacsTestCheck(comm, "Chebyshev converges", iters < 0, 0.0);
+  TacsTestCheck(comm, "Chebyshev iterations", iters, 40.0);
+  cheb->decref();
+
+  // The GMRES polynomial with degree up to 20 and an inner symmetric
+  // l1 Gauss-Seidel sweep
+  TACSGaussSeidel *gs = new TACSGaussSeidel(mat, 1, 1.0, 1, 1, 1);
+  TACSGMRESPolynomialPc *poly = new TACSGMRESPolynomialPc(mat, 20, gs);
+  poly->incref();
+  poly->factor();
+  iters = solve_with_pc(comm, "GMRES polynomial", mat, poly, 20, b, x, r, rtol);
+  TacsTestCheck(comm, "GMRES polynomial converges", iters < 0, 0.0);
+  TacsTestCheck(comm, "GMRES polynomial iterations", iters, 20.0);
+  poly->decref();
+
+  b->decref();
+  x->decref();
+  r->decref();
+  mat->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,162 @@
+/*
+  Check the closed-form Jacobian of the linear Quad4 shell
+
+  TACSQuad4Shell uses an addJacobian specialization that forms the
+  strain-displacement matrix directly. The same element is instantiated
+  with a model class derived from TACSShellLinearModel, which uses the
+  generic addJacobian. The residuals and matrices of the two must agree
+  to round-off for a curved element with random states and Jacobian
+  coefficients, with the natural and a reference-axis transform, and
+  with and without the element geometry cache. The addJacobian times
+  are printed.
+*/
+
+#include "TACSElementVerification.h"
+#include "TACSIsoShellConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+// The same linear model, as a distinct type so that the generic
+// addJacobian of TACSShellElement is used
+class TestShellLinearModel : public TACSShellLinearModel {};
+
+typedef TACSShellElement<TACSQuadLinearQuadrature, TACSShellQuadBasis<2>,
+                         TACSLinearizedRotation, TestShellLinearModel>
+    TestQuad4Shell;
+
+static const int NUM_VARS = 6 * 4;
+
+/*
+  Compare the residual and Jacobian of the two elements
+*/
+static void test_jacobian(MPI_Comm comm, const char *type,
+                          TACSShellTransform *transform,
+                          TACSShellConstitutive *con, int cache) {
+  TACSQuad4Shell *elem0 = new TACSQuad4Shell(transform, con);
+  TestQuad4Shell *elem1 = new TestQuad4Shell(transform, con);
+  elem0->incref();
+  elem1->incref();
+  if (cache) {
+    elem0->setGeometryCache(1);
+    elem1->setGeometryCache(1);
+  }
+
+  TacsScalar Xpts[3 * 4];
+  TacsGenerateRandomArray(Xpts, 3 * 4, -0.1, 0.1);
+  for (int node = 0; node < 4; node++) {
+    double x = 1.0 * (node % 2);
+    double y = 1.0 * (node / 2);
+    Xpts[3 * node] += x;
+    Xpts[3 * node + 1] += y;
+    Xpts[3 * node + 2] += 0.3 * x * y;
+  }
+
+  TacsScalar vars[NUM_VARS], dvars[NUM_VARS], ddvars[NUM_VARS];
+  TacsGenerateRandomArray(vars, NUM_VARS);
+  TacsGenerateRandomArray(dvars, NUM_VARS);
+  TacsGenerateRandomArray(ddvars, NUM_VARS);
+
+  const TacsScalar alpha = 0.7, beta = 0.4, gamma = 0.2;
+  TacsScalar res0[NUM_VARS], res1[NUM_VARS];
+  TacsScalar mat0[NUM_VARS * NUM_VARS], mat1[NUM_VARS * NUM_VARS];
+  memset(res0, 0, NUM_VARS * sizeof(TacsScalar));
+  memset(res1, 0, NUM_VARS * sizeof(TacsScalar));
+  memset(mat0, 0, NUM_VARS * NUM_VARS * sizeof(TacsScalar));
+  memset(mat1, 0, NUM_VARS * NUM_VARS * sizeof(TacsScalar));
+
+  // Evaluate twice so that the cached geometry is used
+  for (int k = 0; k < 1 + cache; k++) {
+    memset(res0, 0, NUM_VARS * sizeof(TacsScalar));
+    memset(mat0, 0, NUM_VARS * NUM_VARS * sizeof(TacsScalar));
+    elem0->addJacobian(0, 0.0, alpha, beta, gamma, Xpts, vars, dvars, ddvars,
+                       res0, mat0);
+  }
+  elem1->addJacobian(0, 0.0, alpha, beta, gamma, Xpts, vars, dvars, ddvars,
+                     res1, mat1);
+
+  double res_err = TacsTestRelError(NUM_VARS, res0, res1);
+  double mat_err = TacsTestRelError(NUM_VARS * NUM_VARS, mat0, mat1);
+
+  char name[128];
+  snprintf(name, sizeof(name), "%s residual", type);
+  TacsTestCheck(comm, name, res_err, 1e-13);
+  snprintf(name, sizeof(name), "%s Jacobian", type);
+  TacsTestCheck(comm, name, mat_err, 1e-13);
+
+  elem0->decref();
+  elem1->decref();
+}
+
+/*
+  Time the element Jacobian and return the time per call
+*/
+static double time_jacobian(TACSElement *element) {
+  element->incref();
+
+  TacsScalar Xpts[3 * 4];
+  TacsGenerateRandomArray(Xpts, 3 * 4, -0.1, 0.1);
+  for (int node = 0; node < 4; node++) {
+    Xpts[3 * node] += 1.0 * (node % 2);
+    Xpts[3 * node + 1] += 1.0 * (node / 2);
+  }
+  TacsScalar vars[NUM_VARS];
+  TacsGenerateRandomArray(vars, NUM_VARS);
+  TacsScalar res[NUM_VARS], mat[NUM_VARS * NUM_VARS];
+
+  const int num_reps = 10000;
+  double t = MPI_Wtime();
+  for (int k = 0; k < num_reps; k++) {
+    memset(res, 0, NUM_VARS * sizeof(TacsScalar));
+    memset(mat, 0, NUM_VARS * NUM_VARS * sizeof(TacsScalar));
+    element->addJacobian(0, 0.0, 1.0, 0.0, 1.0, Xpts, vars, vars, vars, res,
+                         mat);
+  }
+  t = (MPI_Wtime() - t) / num_reps;
+
+  element->decref();
+  return t;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TacsSeedRandomGenerator(0);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSShellConstitutive *con = new TACSIsoShellConstitutive(props, 0.01);
+  con->incref();
+
+  TacsScalar axis[3] = {0.3, 1.0, 0.2};
+  TACSShellTransform *natural = new TACSShellNaturalTransform();
+  TACSShellTransform *ref_axis = new TACSShellRefAxisTransform(axis);
+  natural->incref();
+  ref_axis->incref();
+
+  test_jacobian(comm, "natural transform", natural, con, 0);
+  test_jacobian(comm, "reference-axis transform", ref_axis, con, 0);
+  test_jacobian(comm, "natural transform, cached geometry", natural, con, 1);
+  test_jacobian(comm, "reference-axis transform, cached geometry", ref_axis,
+                con, 1);
+
+  double t0 = time_jacobian(new TestQuad4Shell(ref_axis, con));
+  double t1 = time_jacobian(new TACSQuad4Shell(ref_axis, con));
+  if (rank == 0) {
+    printf("addJacobian time: generic %.3f us, closed-form %.3f us, "
+           "speedup %.2f\n",
+           1e6 * t0, 1e6 * t1, t0 / t1);
+  }
+
+  natural->decref();
+  ref_axis->decref();
+  con->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,190 @@
+/*
+  Check the Jacobian of the quaternion shell elements
+
+  The director rate terms of the quaternion parametrization are added
+  to the Jacobian in a combined form. Every column of the element
+  Jacobian of the linear and nonlinear quaternion shells is compared
+  against a finite-difference (or complex-step) approximation of the
+  residual with random coefficients for the states and their time
+  derivatives. The Jacobian of an assembled model, where the
+  unit-norm multipliers are shared between the elements, is checked in
+  the same way with the product of a random vector.
+*/
+
+#include "TACSElementVerification.h"
+#include "TACSIsoShellConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+static const int MAX_VARS = 8 * 16;
+
+#ifdef TACS_USE_COMPLEX
+static const double dh = 1e-30;
+static const double assembled_tol = 1e-12;
+#else
+static const double dh = 1e-6;
+static const double assembled_tol = 1e-6;
+#endif
+
+/*
+  Check all the columns of the Jacobian of one element
+*/
+static void test_element(MPI_Comm comm, const char *type, TACSElement *element,
+                         int order) {
+  element->incref();
+
+  const int num_nodes = element->getNumNodes();
+  const int num_vars = element->getNumVariables();
+
+  // Perturb the nodes of a curved element, the triangle uses the first
+  // three nodes of the lattice
+  TacsScalar Xpts[3 * 16];
+  TacsGenerateRandomArray(Xpts, 3 * num_nodes, -0.05, 0.05);
+  for (int node = 0; node < num_nodes; node++) {
+    double x = 1.0 * (node % order) / (order - 1);
+    double y = 1.0 * (node / order) / (order - 1);
+    if (num_nodes == 3) {
+      x = (node == 1 ? 1.0 : 0.0);
+      y = (node == 2 ? 1.0 : 0.0);
+    }
+    Xpts[3 * node] += x;
+    Xpts[3 * node + 1] += y;
+    Xpts[3 * node + 2] += 0.2 * x * y;
+  }
+
+  TacsScalar vars[MAX_VARS], dvars[MAX_VARS], ddvars[MAX_VARS];
+  TacsGenerateRandomArray(vars, num_vars, -0.1, 0.1);
+  TacsGenerateRandomArray(dvars, num_vars);
+  TacsGenerateRandomArray(ddvars, num_vars);
+
+  int num_failed = 0;
+  for (int col = 0; col < num_vars; col++) {
+    num_failed += TacsTestElementJacobian(element, 0, 0.0, Xpts, vars, dvars,
+                                          ddvars, col, dh, 0, 1e-5, 1e-5);
+  }
+  num_failed += TacsTestElementJacobian(element, 0, 0.0, Xpts, vars, dvars,
+                                        ddvars, -1, dh, 0, 1e-5, 1e-5);
+
+  char name[128];
+  snprintf(name, sizeof(name), "%s failed Jacobian columns", type);
+  TacsTestCheck(comm, name, num_failed, 0.0);
+
+  element->decref();
+}
+
+/*
+  Check the product of the assembled Jacobian with a random vector
+*/
+static void test_assembled(MPI_Comm comm, TACSElement *element) {
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 8, 2, 8, 6, 1, &element, 0.2);
+  assembler->incref();
+
+  TACSBVec *q = assembler->createVec();
+  TACSBVec *qdot = assembler->createVec();
+  TACSBVec *qddot = assembler->createVec();
+  TACSBVec *p = assembler->createVec();
+  TACSBVec *res = assembler->createVec();
+  TACSBVec *Jp = assembler->createVec();
+  TACSBVec *fd = assembler->createVec();
+  TACSBVec *qt = assembler->createVec();
+  TACSBVec *qdott = assembler->createVec();
+  TACSBVec *qddott = assembler->createVec();
+  TACSBVec *vecs[10] = {q, qdot, qddot, p, res, Jp, fd, qt, qdott, qddott};
+  for (int k = 0; k < 10; k++) {
+    vecs[k]->incref();
+  }
+
+  q->setRand(-0.1, 0.1);
+  qdot->setRand(-1.0, 1.0);
+  qddot->setRand(-1.0, 1.0);
+  p->setRand(-1.0, 1.0);
+  assembler->setBCs(q);
+  assembler->setBCs(qdot);
+  assembler->setBCs(qddot);
+  assembler->setBCs(p);
+
+  const TacsScalar alpha = 0.7, beta = 0.4, gamma = 0.2;
+  TACSParallelMat *mat = assembler->createMat();
+  mat->incref();
+  assembler->setVariables(q, qdot, qddot);
+  assembler->assembleJacobian(alpha, beta, gamma, res, mat);
+  mat->mult(p, Jp);
+
+  // Form the finite-difference or complex-step approximation
+#ifdef TACS_USE_COMPLEX
+  const int num_evals = 1;
+  const TacsScalar steps[1] = {TacsScalar(0.0, dh)};
+#else
+  const int num_evals = 2;
+  const TacsScalar steps[2] = {dh, -dh};
+#endif
+  fd->zeroEntries();
+  for (int k = 0; k < num_evals; k++) {
+    qt->copyValues(q);
+    qdott->copyValues(qdot);
+    qddott->copyValues(qddot);
+    qt->axpy(alpha * steps[k], p);
+    qdott->axpy(beta * steps[k], p);
+    qddott->axpy(gamma * steps[k], p);
+    assembler->setVariables(qt, qdott, qddott);
+    assembler->assembleRes(res);
+#ifdef TACS_USE_COMPLEX
+    TacsScalar *r;
+    int size = res->getArray(&r);
+    for (int i = 0; i < size; i++) {
+      r[i] = TacsImagPart(r[i]) / dh;
+    }
+    fd->axpy(1.0, res);
+#else
+    fd->axpy((k == 0 ? 0.5 : -0.5) / dh, res);
+#endif
+  }
+
+  TacsTestCheck(comm, "assembled Jacobian-vector product",
+                TacsTestRelError(Jp, fd), assembled_tol);
+
+  mat->decref();
+  for (int k = 0; k < 10; k++) {
+    vecs[k]->decref();
+  }
+  assembler->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TacsSeedRandomGenerator(0);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSShellConstitutive *con = new TACSIsoShellConstitutive(props, 0.01);
+  con->incref();
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  transform->incref();
+
+  test_element(comm, "Quad4", new TACSQuad4ShellQuaternion(transform, con), 2);
+  test_element(comm, "Quad9", new TACSQuad9ShellQuaternion(transform, con), 3);
+  test_element(comm, "Quad16", new TACSQuad16ShellQuaternion(transform, con),
+               4);
+  test_element(comm, "Tri3", new TACSTri3ShellQuaternion(transform, con), 2);
+  test_element(comm, "nonlinear Quad4",
+               new TACSQuad4NonlinearShellQuaternion(transform, con), 2);
+  test_element(comm, "nonlinear Quad9",
+               new TACSQuad9NonlinearShellQuaternion(transform, con), 3);
+  test_element(comm, "nonlinear Quad16",
+               new TACSQuad16NonlinearShellQuaternion(transform, con), 4);
+  test_element(comm, "nonlinear Tri3",
+               new TACSTri3NonlinearShellQuaternion(transform, con), 2);
+
+  test_assembled(comm, new TACSQuad4NonlinearShellQuaternion(transform, con));
+
+  transform->decref();
+  con->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
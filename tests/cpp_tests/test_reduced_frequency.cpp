@@ -0,0 +1,217 @@
+/*
+  Check the reduced-basis solves of TACSFrequencyAnalysis
+
+  The first six natural frequencies of a 3200 element plane stress
+  model with two thickness design variables are computed with the
+  Lanczos solver and with a second analysis that keeps a reduced basis
+  of the cached modes and a static shape, with a residual tolerance of
+  1e-2. After a 0.02% thickness change, the reduced solve must be
+  accepted and its eigenvalues and
+  eigenvalue derivatives must match the full solve. After a large
+  thickness change, the residual check must reject the reduced solve
+  and the full solver must be used. The full solve must refresh the
+  cached modes, so that a second solve at the same design is accepted
+  and reproduces the full eigenvalues. The solve times are printed.
+*/
+
+#include "KSM.h"
+#include "TACSBuckling.h"
+#include "TACSSchurMat.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_MODES = 6;
+
+/*
+  Create a frequency analysis with its own matrices and solver
+*/
+static TACSFrequencyAnalysis *create_analysis(TACSAssembler *assembler) {
+  TACSSchurMat *kmat = assembler->createSchurMat();
+  TACSSchurMat *mmat = assembler->createSchurMat();
+  TACSSchurPc *pc = new TACSSchurPc(kmat, 10000, 10.0, 1);
+  GMRES *ksm = new GMRES(kmat, pc, 15, 0, 0);
+  ksm->setTolerances(1e-12, 1e-30);
+
+  return new TACSFrequencyAnalysis(assembler, 0.0, mmat, kmat, ksm, 60,
+                                   NUM_MODES, 1e-10);
+}
+
+/*
+  Solve and return the time for the solve
+*/
+static double solve(TACSFrequencyAnalysis *freq) {
+  double t = MPI_Wtime();
+  freq->solve();
+  return MPI_Wtime() - t;
+}
+
+/*
+  Compute the maximum relative difference between the eigenvalues
+*/
+static double eig_error(TACSFrequencyAnalysis *freq0,
+                        TACSFrequencyAnalysis *freq1) {
+  double max_err = 0.0;
+  for (int k = 0; k < NUM_MODES; k++) {
+    TacsScalar err0, err1;
+    TacsScalar eig0 = freq0->extractEigenvalue(k, &err0);
+    TacsScalar eig1 = freq1->extractEigenvalue(k, &err1);
+    double err = TacsTestRelError(eig1, eig0);
+    if (err > max_err) {
+      max_err = err;
+    }
+  }
+  return max_err;
+}
+
+/*
+  Compute the maximum relative difference between the eigenvalue
+  derivatives w.r.t. the design variables
+*/
+static double sens_error(TACSAssembler *assembler,
+                         TACSFrequencyAnalysis *freq0,
+                         TACSFrequencyAnalysis *freq1) {
+  TACSBVec *dfdx0 = assembler->createDesignVec();
+  TACSBVec *dfdx1 = assembler->createDesignVec();
+  dfdx0->incref();
+  dfdx1->incref();
+
+  double max_err = 0.0;
+  for (int k = 0; k < NUM_MODES; k++) {
+    dfdx0->zeroEntries();
+    dfdx1->zeroEntries();
+    freq0->evalEigenDVSens(k, dfdx0);
+    freq1->evalEigenDVSens(k, dfdx1);
+    double err = TacsTestRelError(dfdx1, dfdx0);
+    if (err > max_err) {
+      max_err = err;
+    }
+  }
+
+  dfdx0->decref();
+  dfdx1->decref();
+  return max_err;
+}
+
+/*
+  Scale the thickness design variables
+*/
+static void scale_design(TACSAssembler *assembler, double s0, double s1) {
+  TACSBVec *x = assembler->createDesignVec();
+  x->incref();
+  assembler->getDesignVars(x);
+  TacsScalar *xvals;
+  int size = x->getArray(&xvals);
+  const int *range;
+  assembler->getDesignNodeMap()->getOwnerRange(&range);
+  int rank;
+  MPI_Comm_rank(assembler->getMPIComm(), &rank);
+  for (int i = 0; i < size; i++) {
+    xvals[i] *= (range[rank] + i == 0 ? s0 : s1);
+  }
+  assembler->setDesignVars(x);
+  x->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSElementBasis *basis = new TACSLinearQuadBasis();
+  TACSElement *elems[2];
+  for (int k = 0; k < 2; k++) {
+    TACSPlaneStressConstitutive *stiff =
+        new TACSPlaneStressConstitutive(props, 1.0 + 0.5 * k, k);
+    TACSLinearElasticity2D *model =
+        new TACSLinearElasticity2D(stiff, TACS_LINEAR_STRAIN);
+    elems[k] = new TACSElement2D(model, basis);
+  }
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 2, 2, 80, 40, 2, elems);
+  assembler->incref();
+
+  TACSFrequencyAnalysis *freq0 = create_analysis(assembler);
+  TACSFrequencyAnalysis *freq1 = create_analysis(assembler);
+  freq0->incref();
+  freq1->incref();
+
+  // Add the static displacements under a uniform load to the basis
+  TACSSchurMat *mat = assembler->createSchurMat();
+  TACSSchurPc *pc = new TACSSchurPc(mat, 10000, 10.0, 1);
+  mat->incref();
+  pc->incref();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+  pc->factor();
+  TACSBVec *force = assembler->createVec();
+  TACSBVec *u = assembler->createVec();
+  force->incref();
+  u->incref();
+  force->set(1.0);
+  assembler->applyBCs(force);
+  pc->applyFactor(force, u);
+
+  const double basis_tol = 1e-2;
+  freq1->setReducedBasis(NUM_MODES + 4, basis_tol);
+  freq1->addReducedBasisVectors(1, &u);
+
+  // The first solve has no cached modes and uses the full solver
+  solve(freq0);
+  solve(freq1);
+  TacsTestCheck(comm, "initial solve uses the full solver",
+                freq1->isReducedSolution(), 0.0);
+  TacsTestCheck(comm, "initial eigenvalues", eig_error(freq0, freq1), 1e-12);
+
+  // A 0.02% thickness change is accepted by the reduced solve. The
+  // Ritz residuals grow linearly with the change, and a 1% change
+  // is rejected at this tolerance.
+  scale_design(assembler, 1.0002, 0.9999);
+  double t0 = solve(freq0);
+  double t1 = solve(freq1);
+  if (rank == 0) {
+    printf("Small thickness change: full %.1f ms, reduced %.1f ms\n",
+           1e3 * t0, 1e3 * t1);
+  }
+  TacsTestCheck(comm, "small change uses the reduced solve",
+                !freq1->isReducedSolution(), 0.0);
+  TacsTestCheck(comm, "small change reduced vs full eigenvalues",
+                eig_error(freq0, freq1), 1e-5);
+  TacsTestCheck(comm, "small change reduced vs full derivatives",
+                sens_error(assembler, freq0, freq1), 1e-3);
+
+  // A large thickness change fails the residual check and falls back
+  // to the full solver
+  scale_design(assembler, 0.5, 1.5);
+  solve(freq0);
+  solve(freq1);
+  TacsTestCheck(comm, "large change falls back to the full solver",
+                freq1->isReducedSolution(), 0.0);
+  TacsTestCheck(comm, "large change eigenvalues", eig_error(freq0, freq1),
+                1e-12);
+
+  // The full solve replaced the cached modes, so the reduced solve at
+  // the same design is accepted and reproduces the full solution
+  solve(freq1);
+  TacsTestCheck(comm, "refreshed modes use the reduced solve",
+                !freq1->isReducedSolution(), 0.0);
+  TacsTestCheck(comm, "refreshed modes reduced vs full eigenvalues",
+                eig_error(freq0, freq1), 1e-10);
+  TacsTestCheck(comm, "refreshed modes reduced vs full derivatives",
+                sens_error(assembler, freq0, freq1), 1e-6);
+
+  freq0->decref();
+  freq1->decref();
+  force->decref();
+  u->decref();
+  pc->decref();
+  mat->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
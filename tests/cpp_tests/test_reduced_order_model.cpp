@@ -0,0 +1,215 @@
+/*
+  Check the hyper-reduced POD-Galerkin model used by the BDF integrator
+
+  A nonlinear plane stress plate of 64 elements under gravity is
+  integrated in time with the full model. The reduced residual and
+  Jacobian assembled over all the elements must match the full
+  residual and Jacobian projected onto the basis. The reduced-order
+  model built from the stored states must sample fewer elements than
+  the model. The integration with the reduced model must converge and
+  reproduce the function value of the full model, both with the
+  default tolerance for the error indicator and with a looser
+  tolerance, which must keep the reduced model for more steps.
+*/
+
+#include "TACSIntegrator.h"
+#include "TACSKSFailure.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_STEPS = 50;
+static const int NUM_MODES = 8;
+static const int NUM_ELEMS = 64;
+
+/*
+  Compute the relative error ||a - b||/||b|| between two arrays
+*/
+static double rel_error(int n, const TacsScalar *a, const TacsScalar *b) {
+  double err = 0.0, norm = 0.0;
+  for (int i = 0; i < n; i++) {
+    err += TacsRealPart((a[i] - b[i]) * (a[i] - b[i]));
+    norm += TacsRealPart(b[i] * b[i]);
+  }
+  return sqrt(err / norm);
+}
+
+/*
+  Compare the reduced residual and Jacobian over all the elements
+  against the projection of the full operators at a perturbed state
+*/
+static void test_operators(MPI_Comm comm, TACSAssembler *assembler,
+                           TACSBDFIntegrator *integrator) {
+  TACSBVec *snapshots[NUM_STEPS];
+  TACSBVec *q0, *qdot0, *qddot0;
+  for (int i = 0; i < NUM_STEPS; i++) {
+    integrator->getStates(i + 1, &snapshots[i], NULL, NULL);
+  }
+  integrator->getStates(0, &q0, NULL, NULL);
+
+  TACSReducedOrderModel *rom = new TACSReducedOrderModel(assembler, NUM_MODES);
+  rom->incref();
+  int r = rom->computeBasis(NUM_STEPS, snapshots, q0);
+
+  // Evaluate the operators about the states at an intermediate step
+  int step = NUM_STEPS / 2;
+  double time = integrator->getStates(step, &q0, &qdot0, &qddot0);
+  rom->setBaseState(q0, qdot0, qddot0);
+
+  const TacsScalar alpha = 1.0, beta = 60.0, gamma = 1600.0;
+  TacsScalar *a = new TacsScalar[r];
+  for (int k = 0; k < r; k++) {
+    a[k] = 1e-3 * (k + 1);
+  }
+
+  TacsScalar *res = new TacsScalar[r];
+  TacsScalar *jac = new TacsScalar[r * r];
+  rom->assembleReducedJacobian(time, alpha, beta, gamma, a, res, jac);
+
+  // Form the perturbed states and assemble the full operators
+  TACSBVec *q = assembler->createVec();
+  TACSBVec *qdot = assembler->createVec();
+  TACSBVec *qddot = assembler->createVec();
+  TACSBVec *R = assembler->createVec();
+  TACSBVec *JV = assembler->createVec();
+  q->incref();
+  qdot->incref();
+  qddot->incref();
+  R->incref();
+  JV->incref();
+
+  q->copyValues(q0);
+  qdot->copyValues(qdot0);
+  qddot->copyValues(qddot0);
+  TACSBVec *Va = assembler->createVec();
+  Va->incref();
+  rom->addBasisVecs(1.0, a, Va);
+  q->axpy(1.0, Va);
+  qdot->axpy(beta, Va);
+  qddot->axpy(gamma, Va);
+  Va->decref();
+
+  TACSParallelMat *mat = assembler->createMat();
+  mat->incref();
+  assembler->setSimulationTime(time);
+  assembler->setVariables(q, qdot, qddot);
+  assembler->assembleJacobian(alpha, beta, gamma, R, mat);
+
+  TacsScalar *res_full = new TacsScalar[r];
+  TacsScalar *jac_full = new TacsScalar[r * r];
+  rom->projectVec(R, res_full);
+  for (int l = 0; l < r; l++) {
+    mat->mult(rom->getBasisVec(l), JV);
+    TacsScalar *col = new TacsScalar[r];
+    rom->projectVec(JV, col);
+    for (int k = 0; k < r; k++) {
+      jac_full[r * k + l] = col[k];
+    }
+    delete[] col;
+  }
+
+  TacsTestCheck(comm, "reduced vs projected full residual",
+                rel_error(r, res, res_full), 1e-10);
+  TacsTestCheck(comm, "reduced vs projected full Jacobian",
+                rel_error(r * r, jac, jac_full), 1e-10);
+
+  delete[] a;
+  delete[] res;
+  delete[] jac;
+  delete[] res_full;
+  delete[] jac_full;
+  mat->decref();
+  q->decref();
+  qdot->decref();
+  qddot->decref();
+  R->decref();
+  JV->decref();
+  rom->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSPlaneStressConstitutive *stiff =
+      new TACSPlaneStressConstitutive(props, 1.0, 0);
+  TACSLinearElasticity2D *model =
+      new TACSLinearElasticity2D(stiff, TACS_NONLINEAR_STRAIN);
+  TACSElement *elem = new TACSElement2D(model, new TACSLinearQuadBasis());
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 2, 2, 8, NUM_ELEMS / 8, 1, &elem);
+  assembler->incref();
+
+  const TacsScalar gravity[3] = {0.0, -1.0, 0.0};
+  assembler->setBodyLoads(gravity);
+
+  TACSBDFIntegrator *integrator =
+      new TACSBDFIntegrator(assembler, 0.0, 1.0, NUM_STEPS, 2);
+  integrator->incref();
+  integrator->setUseSchurMat(1, TACSAssembler::TACS_AMD_ORDER);
+  integrator->setRelTol(1e-10);
+  integrator->setAbsTol(1e-12);
+
+  TACSFunction *func = new TACSKSFailure(assembler, 20.0);
+  integrator->setFunctions(1, &func);
+
+  // The full model
+  TacsScalar f_full;
+  int fail = integrator->integrate();
+  integrator->evalFunctions(&f_full);
+  TacsTestCheck(comm, "full integration converges", fail, 0.0);
+
+  test_operators(comm, assembler, integrator);
+
+  // The reduced model with the sampled elements
+  TACSReducedOrderModel *rom = integrator->buildReducedOrderModel(NUM_MODES);
+  rom->incref();
+
+  int num_samples = rom->getNumSampleElements();
+  if (rank == 0) {
+    printf("%d modes, %d of %d elements sampled\n", rom->getBasisSize(),
+           num_samples, NUM_ELEMS);
+  }
+  TacsTestCheck(comm, "fewer sampled elements than the model",
+                num_samples >= NUM_ELEMS, 0.0);
+
+  const int num_tols = 2;
+  const double rom_tols[num_tols] = {0.1, 0.5};
+  const int min_rom_steps[num_tols] = {1, 10};
+  for (int k = 0; k < num_tols; k++) {
+    integrator->setReducedOrderModel(rom, rom_tols[k]);
+
+    TacsScalar f_rom;
+    fail = integrator->integrate();
+    integrator->evalFunctions(&f_rom);
+    int num_rom_steps, trip_step;
+    integrator->getReducedOrderStatistics(&num_rom_steps, &trip_step);
+    if (rank == 0) {
+      printf("Indicator tolerance %.1f: %d of %d steps reduced\n",
+             rom_tols[k], num_rom_steps, NUM_STEPS);
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "tolerance %.1f reduced integration converges",
+             rom_tols[k]);
+    TacsTestCheck(comm, name, fail, 0.0);
+    snprintf(name, sizeof(name), "tolerance %.1f reduced steps", rom_tols[k]);
+    TacsTestCheck(comm, name, num_rom_steps < min_rom_steps[k], 0.0);
+    snprintf(name, sizeof(name), "tolerance %.1f reduced vs full function",
+             rom_tols[k]);
+    TacsTestCheck(comm, name, TacsTestRelError(f_rom, f_full), 1e-3);
+  }
+
+  rom->decref();
+  integrator->decref();
+  assembler->decref();
+
+  int ret = TacsTestFinish(comm);
+  MPI_Finalize();
+  return ret;
+}
@@ -0,0 +1,192 @@
+/*
+  Check the one-point quadrature Quad4 shells with hourglass control
+
+  The residual, every column of the Jacobian, the matrix-free Jacobian
+  product and the derivative of the adjoint-residual product w.r.t. the
+  thickness design variable of TACSQuad4ReducedShell and
+  TACSQuad4NonlinearReducedShell are compared against finite-difference
+  (or complex-step) approximations. The checks are made with the
+  default hourglass coefficient and with a large coefficient, where the
+  hourglass terms dominate the element matrices. The hourglass mode of
+  the transverse displacement of a flat square must have no strain
+  energy without hourglass control and a positive energy with it. The
+  residual times of the one-point and 2x2 Quad4 shells are printed.
+*/
+
+#include "TACSElementVerification.h"
+#include "TACSIsoShellConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_VARS = 6 * 4;
+
+#ifdef TACS_USE_COMPLEX
+static const double dh = 1e-30;
+#else
+static const double dh = 1e-6;
+#endif
+
+/*
+  Check the derivatives of one element with the given hourglass
+  coefficient
+*/
+template <class ShellElement>
+static void test_element(MPI_Comm comm, const char *type,
+                         TACSShellTransform *transform,
+                         TACSShellConstitutive *con, double coef) {
+  ShellElement *element = new ShellElement(transform, con);
+  element->incref();
+  element->setHourglassCoefficient(coef);
+
+  // Perturb the nodes of a curved element
+  TacsScalar Xpts[3 * 4];
+  TacsGenerateRandomArray(Xpts, 3 * 4, -0.05, 0.05);
+  for (int node = 0; node < 4; node++) {
+    double x = 1.0 * (node % 2);
+    double y = 1.0 * (node / 2);
+    Xpts[3 * node] += x;
+    Xpts[3 * node + 1] += y;
+    Xpts[3 * node + 2] += 0.2 * x * y;
+  }
+
+  TacsScalar vars[NUM_VARS], dvars[NUM_VARS], ddvars[NUM_VARS];
+  TacsGenerateRandomArray(vars, NUM_VARS, -0.1, 0.1);
+  TacsGenerateRandomArray(dvars, NUM_VARS);
+  TacsGenerateRandomArray(ddvars, NUM_VARS);
+
+  // The residual check only supports finite differences of the energy
+  char name[128];
+  int fail = TacsTestElementResidual(element, 0, 0.0, Xpts, vars, dvars,
+                                     ddvars, 1e-5, 0, 1e-7, 1e-2);
+  snprintf(name, sizeof(name), "%s, coef %g residual", type, coef);
+  TacsTestCheck(comm, name, fail, 0.0);
+
+  int num_failed = 0;
+  for (int col = 0; col < NUM_VARS; col++) {
+    num_failed += TacsTestElementJacobian(element, 0, 0.0, Xpts, vars, dvars,
+                                          ddvars, col, dh, 0, 1e-5, 1e-5);
+  }
+  snprintf(name, sizeof(name), "%s, coef %g failed Jacobian columns", type,
+           coef);
+  TacsTestCheck(comm, name, num_failed, 0.0);
+
+  fail = TacsTestElementMatFreeJacobian(element, 0, 0.0, Xpts, vars, dvars,
+                                        ddvars, -1, dh, 0, 1e-5, 1e-5);
+  snprintf(name, sizeof(name), "%s, coef %g matrix-free Jacobian", type, coef);
+  TacsTestCheck(comm, name, fail, 0.0);
+
+  TacsScalar x[1];
+  element->getDesignVars(0, 1, x);
+  fail = TacsTestAdjResProduct(element, 0, 0.0, Xpts, vars, dvars, ddvars, 1,
+                               x, dh, 0, 1e-5, 1e-5);
+  snprintf(name, sizeof(name), "%s, coef %g adjoint-residual DV product", type,
+           coef);
+  TacsTestCheck(comm, name, fail, 0.0);
+
+  element->decref();
+}
+
+/*
+  Compute the strain energy of the transverse displacement hourglass
+  mode of a flat unit square
+*/
+static double hourglass_energy(TACSShellTransform *transform,
+                               TACSShellConstitutive *con, double coef) {
+  TACSQuad4ReducedShell *element = new TACSQuad4ReducedShell(transform, con);
+  element->incref();
+  element->setHourglassCoefficient(coef);
+
+  TacsScalar Xpts[3 * 4];
+  memset(Xpts, 0, 3 * 4 * sizeof(TacsScalar));
+  TacsScalar vars[NUM_VARS];
+  memset(vars, 0, NUM_VARS * sizeof(TacsScalar));
+  const double hg[4] = {1.0, -1.0, -1.0, 1.0};
+  for (int node = 0; node < 4; node++) {
+    Xpts[3 * node] = 1.0 * (node % 2);
+    Xpts[3 * node + 1] = 1.0 * (node / 2);
+    vars[6 * node + 2] = 0.01 * hg[node];
+  }
+
+  TacsScalar Te, Ue;
+  element->computeEnergies(0, 0.0, Xpts, vars, vars, &Te, &Ue);
+  element->decref();
+
+  return TacsRealPart(Ue);
+}
+
+/*
+  Time the element residual and return the time per call
+*/
+static double time_residual(TACSElement *element) {
+  element->incref();
+
+  TacsScalar Xpts[3 * 4];
+  TacsGenerateRandomArray(Xpts, 3 * 4, -0.05, 0.05);
+  for (int node = 0; node < 4; node++) {
+    Xpts[3 * node] += 1.0 * (node % 2);
+    Xpts[3 * node + 1] += 1.0 * (node / 2);
+  }
+  TacsScalar vars[NUM_VARS], res[NUM_VARS];
+  TacsGenerateRandomArray(vars, NUM_VARS, -0.1, 0.1);
+
+  const int num_reps = 20000;
+  double t = MPI_Wtime();
+  for (int k = 0; k < num_reps; k++) {
+    memset(res, 0, NUM_VARS * sizeof(TacsScalar));
+    element->addResidual(0, 0.0, Xpts, vars, vars, vars, res);
+  }
+  t = (MPI_Wtime() - t) / num_reps;
+
+  element->decref();
+  return t;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TacsSeedRandomGenerator(0);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSShellConstitutive *con = new TACSIsoShellConstitutive(props, 0.01, 0);
+  con->incref();
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  transform->incref();
+
+  const double coefs[2] = {0.1, 10.0};
+  for (int k = 0; k < 2; k++) {
+    test_element<TACSQuad4ReducedShell>(comm, "Quad4Reduced", transform, con,
+                                        coefs[k]);
+    test_element<TACSQuad4NonlinearReducedShell>(
+        comm, "nonlinear Quad4Reduced", transform, con, coefs[k]);
+  }
+
+  // The hourglass mode has no energy without the hourglass control
+  double U0 = hourglass_energy(transform, con, 0.0);
+  double U1 = hourglass_energy(transform, con, 0.1);
+  if (rank == 0) {
+    printf("Hourglass mode energy: coef 0 %.4e, coef 0.1 %.4e\n", U0, U1);
+  }
+  TacsTestCheck(comm, "hourglass mode energy without control", fabs(U0),
+                1e-12 * U1);
+  TacsTestCheck(comm, "hourglass mode energy with control", (U1 <= 0.0), 0.0);
+
+  double t0 = time_residual(new TACSQuad4Shell(transform, con));
+  double t1 = time_residual(new TACSQuad4ReducedShell(transform, con));
+  if (rank == 0) {
+    printf("Residual time: 2x2 %.3f us, one-point %.3f us, ratio %.2f\n",
+           1e6 * t0, 1e6 * t1, t1 / t0);
+  }
+
+  transform->decref();
+  con->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,115 @@
+/*
+  Check the supernodal ordering of the global Schur complement
+
+  The stiffness matrix of a plane stress model, partitioned into a
+  grid of rectangular blocks of elements, is factored with
+  TACSSchurPc using the default ordering of the global Schur
+  complement (reorder = 1) and the supernodal ordering (reorder = 2).
+  The solutions with both factors must satisfy the linear system and
+  agree to round-off, and the supernodal ordering must store fewer
+  entries in the Schur complement factor. The entry counts and the
+  factorization times are printed.
+*/
+
+#include "TACSSchurMat.h"
+#include "tacs_test_utils.h"
+
+#ifndef SCHUR_TEST_NX
+#define SCHUR_TEST_NX 200
+#endif
+#ifndef SCHUR_TEST_NY
+#define SCHUR_TEST_NY 100
+#endif
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  // Partition the elements into an npx x npy grid of blocks
+  const int nx = SCHUR_TEST_NX, ny = SCHUR_TEST_NY;
+  int npx = 1;
+  for (int k = 1; k * k <= size; k++) {
+    if (size % k == 0) {
+      npx = k;
+    }
+  }
+  int npy = size / npx;
+  int *part = new int[nx * ny];
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      part[i + nx * j] = (npx * i) / nx + npx * ((npy * j) / ny);
+    }
+  }
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSPlaneStressConstitutive *stiff = new TACSPlaneStressConstitutive(props);
+  TACSLinearElasticity2D *model =
+      new TACSLinearElasticity2D(stiff, TACS_LINEAR_STRAIN);
+  TACSElement *elem = new TACSElement2D(model, new TACSLinearQuadBasis());
+
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 2, 2, nx, ny, 1, &elem, 0.0, part);
+  assembler->incref();
+  delete[] part;
+
+  TACSBVec *f = assembler->createVec();
+  TACSBVec *r = assembler->createVec();
+  TACSBVec *u[2];
+  f->incref();
+  r->incref();
+  f->set(1.0);
+  assembler->applyBCs(f);
+
+  size_t num_entries[2];
+  double max_res = 0.0;
+  for (int k = 0; k < 2; k++) {
+    TACSSchurMat *mat = assembler->createSchurMat();
+    TACSSchurPc *pc = new TACSSchurPc(mat, 10000, 10.0, k + 1);
+    mat->incref();
+    pc->incref();
+    assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+
+    double t = MPI_Wtime();
+    pc->factor();
+    t = MPI_Wtime() - t;
+
+    u[k] = assembler->createVec();
+    u[k]->incref();
+    pc->applyFactor(f, u[k]);
+
+    double res = TacsTestResidual(mat, u[k], f, r);
+    max_res = (res > max_res ? res : max_res);
+    num_entries[k] = pc->getNumSchurFactorEntries();
+    if (rank == 0) {
+      printf("reorder = %d: %zu Schur factor entries, factor %.3f s\n", k + 1,
+             num_entries[k], t);
+    }
+
+    pc->decref();
+    mat->decref();
+  }
+
+  TacsTestCheck(comm, "linear system residual", max_res, 1e-10);
+  TacsTestCheck(comm, "supernodal vs default ordering solutions",
+                TacsTestRelError(u[1], u[0]), 1e-10);
+  TacsTestCheck(comm, "supernodal ordering stores fewer factor entries",
+                (num_entries[1] >= num_entries[0]), 0.0);
+
+  u[0]->decref();
+  u[1]->decref();
+  f->decref();
+  r->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,135 @@
+/*
+  Check the overlap and the coarse space of the additive Schwarz
+  preconditioner
+
+  A plane stress model is solved with GMRES and ILU(1) additive
+  Schwarz using block Jacobi subdomains, two layers of overlap with the
+  restricted and the standard variants, and two layers of overlap with
+  the rigid body modes as the coarse space. Every solve must satisfy
+  the residual tolerance and agree with the block Jacobi solution. The
+  overlap must reduce the number of iterations, and the coarse space
+  must reduce it further, to less than half of the block Jacobi
+  iterations. The solves use a tight tolerance, since a residual of
+  1e-8 still leaves errors of order 1e-3 in the low-energy modes of
+  this model.
+*/
+
+#include "KSM.h"
+#include "tacs_test_utils.h"
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSAssembler *assembler =
+      TacsTestCreatePlaneStressModel(comm, 60, 60, 2, 100.0);
+  assembler->incref();
+
+  TACSParallelMat *mat = assembler->createMat();
+  mat->incref();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, NULL, mat);
+
+  // The in-plane rigid body modes: two translations and the rotation
+  TACSBVec *X = assembler->createNodeVec();
+  X->incref();
+  assembler->getNodes(X);
+  TacsScalar *Xpts;
+  X->getArray(&Xpts);
+
+  const int num_modes = 3;
+  TACSBVec *modes[num_modes];
+  for (int k = 0; k < num_modes; k++) {
+    modes[k] = assembler->createVec();
+    modes[k]->incref();
+    TacsScalar *z;
+    int size = modes[k]->getArray(&z);
+    for (int i = 0; i < size / 2; i++) {
+      if (k < 2) {
+        z[2 * i + k] = 1.0;
+      } else {
+        z[2 * i] = -Xpts[3 * i + 1];
+        z[2 * i + 1] = Xpts[3 * i];
+      }
+    }
+  }
+
+  TACSBVec *b = assembler->createVec();
+  TACSBVec *x0 = assembler->createVec();
+  TACSBVec *x = assembler->createVec();
+  TACSBVec *r = assembler->createVec();
+  b->incref();
+  x0->incref();
+  x->incref();
+  r->incref();
+  b->setRand(-1.0, 1.0);
+  assembler->setBCs(b);
+
+  const double rtol = 1e-12;
+  const int num_cases = 4;
+  const char *names[num_cases] = {"block Jacobi", "restricted overlap 2",
+                                  "standard overlap 2",
+                                  "overlap 2 with coarse space"};
+  int overlap[num_cases] = {0, 2, 2, 2};
+  int restricted[num_cases] = {1, 1, 0, 1};
+  int coarse[num_cases] = {0, 0, 0, 1};
+  int iters[num_cases];
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  for (int k = 0; k < num_cases; k++) {
+    TACSAdditiveSchwarz *pc = new TACSAdditiveSchwarz(mat, 1, 10.0);
+    pc->incref();
+    pc->setOverlap(overlap[k], restricted[k]);
+    if (coarse[k]) {
+      pc->setCoarseSpace(num_modes, modes);
+    }
+    pc->factor();
+
+    GMRES *gmres = new GMRES(mat, pc, 60, 100, 0);
+    gmres->incref();
+    gmres->setTolerances(rtol, 1e-30);
+    gmres->solve(b, (k == 0 ? x0 : x));
+    iters[k] = gmres->getIterCount();
+    gmres->decref();
+    pc->decref();
+
+    if (rank == 0) {
+      printf("%s: %d iterations\n", names[k], iters[k]);
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "%s relative residual", names[k]);
+    TacsTestCheck(comm, name, TacsTestResidual(mat, (k == 0 ? x0 : x), b, r),
+                  10.0 * rtol);
+    if (k > 0) {
+      snprintf(name, sizeof(name), "%s vs block Jacobi solution", names[k]);
+      TacsTestCheck(comm, name, TacsTestRelError(x, x0), 1e-5);
+    }
+  }
+
+  TacsTestCheck(comm, "restricted overlap/block Jacobi iterations",
+                (1.0 * iters[1]) / iters[0], 1.0);
+  TacsTestCheck(comm, "standard overlap/block Jacobi iterations",
+                (1.0 * iters[2]) / iters[0], 1.0);
+  TacsTestCheck(comm, "coarse space/block Jacobi iterations",
+                (1.0 * iters[3]) / iters[0], 0.5);
+  TacsTestCheck(comm, "coarse space/restricted overlap iterations",
+                (1.0 * iters[3]) / iters[1], 1.0);
+
+  for (int k = 0; k < num_modes; k++) {
+    modes[k]->decref();
+  }
+  X->decref();
+  b->decref();
+  x0->decref();
+  x->decref();
+  r->decref();
+  mat->decref();
+  assembler->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,216 @@
+/*
+  Check the adaptive p-refinement of variable-order shell meshes
+
+  An L-shaped flat plate, clamped along its lower edge, is loaded by a
+  uniform in-plane traction, so that only the membrane response is
+  excited and the stress is singular at the re-entrant corner. Starting
+  from linear elements, the mesh is refined with the stress-jump
+  indicator of TACSShellPRefinement until no element is refined. The
+  compliance must increase monotonically under refinement, stay below
+  the compliance of the uniform p = 4 mesh, and come within 1% of it
+  with fewer independent nodes. The refinement must only stop once all
+  the elements have reached p = 4. The compliance and the number of nodes
+  at each step are printed.
+*/
+
+#include "TACSIsoShellConstitutive.h"
+#include "TACSSchurMat.h"
+#include "TACSShellElementDefs.h"
+#include "TACSShellPRefinement.h"
+#include "tacs_test_utils.h"
+
+static const int MAX_STEPS = 12;
+
+// The fraction of the largest error indicator to refine
+#ifndef P_REFINE_FRACTION
+#define P_REFINE_FRACTION 0.5
+#endif
+
+/*
+  Solve the problem, set the solution into the assembler and return
+  the compliance
+*/
+static double solve(TACSAssembler *assembler) {
+  // Apply the same in-plane traction to each element
+  const TacsScalar t[3] = {1.0, 0.0, 0.0};
+  int num_elems = assembler->getNumElements();
+  TACSAuxElements *aux = new TACSAuxElements(num_elems);
+  TACSElement **elements = assembler->getElements();
+  for (int i = 0; i < num_elems; i++) {
+    aux->addElement(i, elements[i]->createElementTraction(-1, t));
+  }
+  assembler->setAuxElements(aux);
+
+  TACSSchurMat *mat = assembler->createSchurMat();
+  TACSSchurPc *pc = new TACSSchurPc(mat, 10000, 10.0, 1);
+  mat->incref();
+  pc->incref();
+
+  TACSBVec *res = assembler->createVec();
+  TACSBVec *ans = assembler->createVec();
+  res->incref();
+  ans->incref();
+
+  assembler->zeroVariables();
+  assembler->assembleJacobian(1.0, 0.0, 0.0, res, mat);
+  pc->factor();
+  pc->applyFactor(res, ans);
+  double compliance = fabs(TacsRealPart(res->dot(ans)));
+
+  ans->scale(-1.0);
+  assembler->setVariables(ans);
+
+  res->decref();
+  ans->decref();
+  pc->decref();
+  mat->decref();
+
+  return compliance;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // The L-shaped domain [0, 2] x [0, 2] without [1, 2] x [1, 2], with
+  // an n x n grid of elements on the full square
+  const int n = 8;
+  int *node_nums = new int[(n + 1) * (n + 1)];
+  int num_nodes = 0, num_elements = 0;
+  TacsScalar *Xpts = new TacsScalar[3 * (n + 1) * (n + 1)];
+  int *conn = new int[4 * n * n];
+  int *bc_nodes = new int[n + 1];
+  int num_bcs = 0;
+  for (int j = 0; j <= n; j++) {
+    for (int i = 0; i <= n; i++) {
+      node_nums[i + (n + 1) * j] = -1;
+      if (2 * i <= n || 2 * j <= n) {
+        Xpts[3 * num_nodes] = 2.0 * i / n;
+        Xpts[3 * num_nodes + 1] = 2.0 * j / n;
+        Xpts[3 * num_nodes + 2] = 0.0;
+        if (j == 0) {
+          bc_nodes[num_bcs] = num_nodes;
+          num_bcs++;
+        }
+        node_nums[i + (n + 1) * j] = num_nodes;
+        num_nodes++;
+      }
+    }
+  }
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      if (2 * i < n || 2 * j < n) {
+        conn[4 * num_elements] = node_nums[i + (n + 1) * j];
+        conn[4 * num_elements + 1] = node_nums[i + 1 + (n + 1) * j];
+        conn[4 * num_elements + 2] = node_nums[i + (n + 1) * (j + 1)];
+        conn[4 * num_elements + 3] = node_nums[i + 1 + (n + 1) * (j + 1)];
+        num_elements++;
+      }
+    }
+  }
+
+  TACSShellPRefinement *pref = new TACSShellPRefinement(
+      comm, 6, num_nodes, num_elements, conn, Xpts);
+  pref->incref();
+  pref->setBoundaryConditions(num_bcs, bc_nodes);
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e3, 0.3, 270.0, 24e-6, 230.0);
+  TACSShellConstitutive *con = new TACSIsoShellConstitutive(props, 0.01);
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *elements[3];
+  elements[0] = new TACSQuad4Shell(transform, con);
+  elements[1] = new TACSQuad9Shell(transform, con);
+  elements[2] = new TACSQuad16Shell(transform, con);
+  pref->setElements(1, elements);
+
+  // Solve on the uniform p = 4 mesh for the reference compliance
+  int *orders = new int[num_elements];
+  for (int i = 0; i < num_elements; i++) {
+    orders[i] = 4;
+  }
+  int uniform_nodes, num_dep;
+  pref->setElementOrders(orders);
+  TACSAssembler *assembler = pref->createTACS();
+  assembler->incref();
+  double uniform = solve(assembler);
+  pref->getNumNodes(&uniform_nodes, &num_dep);
+  MPI_Bcast(&uniform_nodes, 1, MPI_INT, 0, comm);
+  assembler->decref();
+  if (rank == 0) {
+    printf("uniform p = 4: %6d nodes, compliance %.10e\n", uniform_nodes,
+           uniform);
+  }
+
+  // Refine adaptively, starting from the linear mesh
+  for (int i = 0; i < num_elements; i++) {
+    orders[i] = 2;
+  }
+  pref->setElementOrders(orders);
+
+  TacsScalar *err = new TacsScalar[num_elements];
+  double prev = 0.0, max_decrease = 0.0;
+  int target_nodes = -1, fail_upper = 0, nodes = 0;
+  for (int step = 0; step < MAX_STEPS; step++) {
+    assembler = pref->createTACS();
+    assembler->incref();
+    double compliance = solve(assembler);
+    pref->getNumNodes(&nodes, &num_dep);
+    MPI_Bcast(&nodes, 1, MPI_INT, 0, comm);
+    double rel = (uniform - compliance) / uniform;
+    if (rank == 0) {
+      printf("step %2d: %6d nodes (%5.1f%%), compliance %.10e, "
+             "error %.3e\n",
+             step, nodes, 100.0 * nodes / uniform_nodes, compliance, rel);
+    }
+
+    if (prev - compliance > max_decrease * prev) {
+      max_decrease = (prev - compliance) / prev;
+    }
+    if (rel < -1e-10) {
+      fail_upper = 1;
+    }
+    if (target_nodes < 0 && rel < 0.01) {
+      target_nodes = nodes;
+    }
+    prev = compliance;
+
+    pref->computeErrorEstimate(assembler, err);
+    assembler->decref();
+    if (pref->refine(err, P_REFINE_FRACTION) == 0) {
+      break;
+    }
+  }
+
+  if (rank == 0 && target_nodes > 0) {
+    printf("within 1%% of uniform p = 4 with %d nodes (%.1f%%)\n",
+           target_nodes, 100.0 * target_nodes / uniform_nodes);
+  }
+
+  TacsTestCheck(comm, "compliance decrease under refinement", max_decrease,
+                1e-10);
+  TacsTestCheck(comm, "compliance above the uniform p = 4 value", fail_upper,
+                0.0);
+  TacsTestCheck(comm, "adaptive mesh within 1% of uniform p = 4",
+                (target_nodes < 0), 0.0);
+  TacsTestCheck(comm, "adaptive mesh has fewer nodes than uniform p = 4",
+                (target_nodes >= uniform_nodes), 0.0);
+  TacsTestCheck(comm, "refinement ends with the uniform p = 4 mesh",
+                (nodes != uniform_nodes), 0.0);
+
+  delete[] err;
+  delete[] orders;
+  delete[] node_nums;
+  delete[] Xpts;
+  delete[] conn;
+  delete[] bc_nodes;
+  pref->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
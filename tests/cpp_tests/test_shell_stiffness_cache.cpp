@@ -0,0 +1,269 @@
+/*
+  Check the stored laminate stiffness of the shell constitutive classes
+
+  TACSBladeStiffenedShellConstitutive stores the stiffness matrix for
+  the current design and TACSCompositeShellConstitutive integrates the
+  laminate stiffness once at construction. After construction, after
+  setDesignVars(), after the ply fraction setters and after a change
+  of the drilling regularization, evalTangentStiffness() and
+  evalTangentStiffnessBatch() must agree to round-off with the
+  stiffness recomputed from the current design. The Quad4 shell
+  Jacobian times with the stored and the recomputed blade stiffness,
+  the fastest of five alternating runs, are printed.
+*/
+
+#include "TACSBladeStiffenedShellConstitutive.h"
+#include "TACSCompositeShellConstitutive.h"
+#include "TACSElementVerification.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+static const int NUM_ENTRIES =
+    TACSShellConstitutive::NUM_TANGENT_STIFFNESS_ENTRIES;
+static const int NUM_BATCH_PTS = 5;
+
+// The default drilling regularization of TACSShellConstitutive
+static const double DRILL_REG = 10.0;
+
+/*
+  The blade-stiffened constitutive class with access to the stiffness
+  computed from the current design
+*/
+class TestBladeConstitutive : public TACSBladeStiffenedShellConstitutive {
+ public:
+  using TACSBladeStiffenedShellConstitutive::
+      TACSBladeStiffenedShellConstitutive;
+
+  void evalReferenceStiffness(TacsScalar C[]) { computeStiffness(C); }
+};
+
+/*
+  The blade-stiffened constitutive class that recomputes the stiffness
+  at every evaluation, as before the stiffness was stored
+*/
+class UncachedBladeConstitutive : public TestBladeConstitutive {
+ public:
+  using TestBladeConstitutive::TestBladeConstitutive;
+
+  void evalStress(int elemIndex, const double pt[], const TacsScalar X[],
+                  const TacsScalar e[], TacsScalar s[]) {
+    TacsScalar C[NUM_ENTRIES];
+    computeStiffness(C);
+    computeStress(&C[0], &C[6], &C[12], &C[18], C[21], e, s);
+  }
+  void evalTangentStiffness(int elemIndex, const double pt[],
+                            const TacsScalar X[], TacsScalar C[]) {
+    computeStiffness(C);
+  }
+  void evalTangentStiffnessBatch(int npts, const int elemIndex[],
+                                 const double pt[], const TacsScalar X[],
+                                 TacsScalar C[]) {
+    TACSShellConstitutive::evalTangentStiffnessBatch(npts, elemIndex, pt, X,
+                                                     C);
+  }
+};
+
+/*
+  Integrate the laminate stiffness through the thickness
+*/
+static void laminate_stiffness(int num_plies, TACSOrthotropicPly **plies,
+                               const TacsScalar thickness[],
+                               const TacsScalar angles[], TacsScalar kcorr,
+                               double drill_reg, TacsScalar C[]) {
+  memset(C, 0, NUM_ENTRIES * sizeof(TacsScalar));
+  TacsScalar t = 0.0;
+  for (int k = 0; k < num_plies; k++) {
+    t += thickness[k];
+  }
+
+  TacsScalar t0 = -0.5 * t;
+  for (int k = 0; k < num_plies; k++) {
+    TacsScalar Qbar[6], Abar[3];
+    plies[k]->calculateQbar(angles[k], Qbar);
+    plies[k]->calculateAbar(angles[k], Abar);
+
+    TacsScalar t1 = t0 + thickness[k];
+    TacsScalar a = t1 - t0;
+    TacsScalar b = 0.5 * (t1 * t1 - t0 * t0);
+    TacsScalar d = (t1 * t1 * t1 - t0 * t0 * t0) / 3.0;
+    for (int i = 0; i < 6; i++) {
+      C[i] += a * Qbar[i];
+      C[6 + i] += b * Qbar[i];
+      C[12 + i] += d * Qbar[i];
+    }
+    for (int i = 0; i < 3; i++) {
+      C[18 + i] += kcorr * a * Abar[i];
+    }
+    t0 = t1;
+  }
+  C[21] = 0.5 * drill_reg * (C[18] + C[20]);
+}
+
+/*
+  Compare the single and batched tangent stiffness with the reference
+*/
+static void compare(MPI_Comm comm, const char *type, const char *state,
+                    TACSShellConstitutive *con, const TacsScalar Cref[]) {
+  int elems[NUM_BATCH_PTS];
+  double pts[3 * NUM_BATCH_PTS];
+  TacsScalar X[3 * NUM_BATCH_PTS];
+  for (int i = 0; i < NUM_BATCH_PTS; i++) {
+    elems[i] = 3 * i;
+  }
+  TacsGenerateRandomArray(pts, 3 * NUM_BATCH_PTS);
+  TacsGenerateRandomArray(X, 3 * NUM_BATCH_PTS);
+
+  TacsScalar C[NUM_ENTRIES], Cb[NUM_ENTRIES * NUM_BATCH_PTS];
+  con->evalTangentStiffness(elems[1], &pts[3], &X[3], C);
+  con->evalTangentStiffnessBatch(NUM_BATCH_PTS, elems, pts, X, Cb);
+
+  double batch_err = 0.0;
+  for (int i = 0; i < NUM_BATCH_PTS; i++) {
+    double err = TacsTestRelError(NUM_ENTRIES, &Cb[NUM_ENTRIES * i], Cref);
+    batch_err = (err > batch_err ? err : batch_err);
+  }
+
+  char name[256];
+  snprintf(name, sizeof(name), "%s, %s: evalTangentStiffness", type, state);
+  TacsTestCheck(comm, name, TacsTestRelError(NUM_ENTRIES, C, Cref), 1e-14);
+  snprintf(name, sizeof(name), "%s, %s: evalTangentStiffnessBatch", type,
+           state);
+  TacsTestCheck(comm, name, batch_err, 1e-14);
+}
+
+/*
+  Time the Quad4 shell Jacobian and return the time per call
+*/
+static double time_jacobian(TACSShellConstitutive *con) {
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  TACSElement *element = new TACSQuad4Shell(transform, con);
+  element->incref();
+
+  TacsScalar Xpts[3 * 4];
+  TacsGenerateRandomArray(Xpts, 3 * 4, -0.1, 0.1);
+  for (int node = 0; node < 4; node++) {
+    Xpts[3 * node] += 1.0 * (node % 2);
+    Xpts[3 * node + 1] += 1.0 * (node / 2);
+  }
+  TacsScalar vars[24], res[24], mat[24 * 24];
+  TacsGenerateRandomArray(vars, 24);
+
+  const int num_reps = 10000;
+  double t = MPI_Wtime();
+  for (int k = 0; k < num_reps; k++) {
+    memset(res, 0, 24 * sizeof(TacsScalar));
+    memset(mat, 0, 24 * 24 * sizeof(TacsScalar));
+    element->addJacobian(0, 0.0, 1.0, 0.0, 1.0, Xpts, vars, vars, vars, res,
+                         mat);
+  }
+  t = (MPI_Wtime() - t) / num_reps;
+
+  element->decref();
+  return t;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TacsSeedRandomGenerator(0);
+
+  // A carbon-epoxy ply for the panel and the stiffener
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      1550.0, 921.0, 127.9e9, 13.3e9, 13.3e9, 0.32, 0.32, 0.43, 6.4e9, 6.4e9,
+      4.5e9, 2.2e9, 1.4e9, 60e6, 230e6, 60e6, 230e6, 90e6, 90e6, 90e6);
+  TACSOrthotropicPly *ply = new TACSOrthotropicPly(1.25e-4, props);
+  ply->incref();
+
+  // All the blade geometry and ply fractions are design variables
+  const int num_plies = 4;
+  TacsScalar angles[num_plies] = {0.0, -M_PI / 4.0, M_PI / 4.0, M_PI / 2.0};
+  TacsScalar fracs[num_plies] = {0.25, 0.25, 0.25, 0.25};
+  int panel_frac_nums[num_plies] = {3, 4, 5, 6};
+  int stiff_frac_nums[num_plies] = {9, 10, 11, 12};
+  TestBladeConstitutive *blade = new TestBladeConstitutive(
+      ply, ply, 5.0 / 6.0, 0.5, 0, 0.15, 1, 2e-3, 2, num_plies, angles, fracs,
+      panel_frac_nums, 0.03, 7, 1.5e-3, 8, num_plies, angles, fracs,
+      stiff_frac_nums);
+  blade->incref();
+
+  const char *type = "TACSBladeStiffenedShellConstitutive";
+  TacsScalar Cref[NUM_ENTRIES];
+  blade->evalReferenceStiffness(Cref);
+  compare(comm, type, "constructor", blade, Cref);
+
+  const int num_dvs = 13;
+  TacsScalar dvs[num_dvs];
+  blade->getDesignVars(0, num_dvs, dvs);
+  for (int i = 0; i < num_dvs; i++) {
+    dvs[i] *= 1.0 + 0.05 * (i % 3);
+  }
+  blade->setDesignVars(0, num_dvs, dvs);
+  blade->evalReferenceStiffness(Cref);
+  compare(comm, type, "setDesignVars", blade, Cref);
+
+  TacsScalar panel_fracs[num_plies] = {0.4, 0.3, 0.2, 0.1};
+  blade->setPanelPlyFractions(panel_fracs);
+  blade->evalReferenceStiffness(Cref);
+  compare(comm, type, "setPanelPlyFractions", blade, Cref);
+
+  TacsScalar stiff_fracs[num_plies] = {0.1, 0.2, 0.3, 0.4};
+  blade->setStiffenerPlyFractions(stiff_fracs);
+  blade->evalReferenceStiffness(Cref);
+  compare(comm, type, "setStiffenerPlyFractions", blade, Cref);
+
+  TACSShellConstitutive::setDrillingRegularization(0.1 * DRILL_REG);
+  blade->evalReferenceStiffness(Cref);
+  compare(comm, type, "drilling regularization", blade, Cref);
+  TACSShellConstitutive::setDrillingRegularization(DRILL_REG);
+
+  // A four-ply laminate with unequal ply thicknesses
+  type = "TACSCompositeShellConstitutive";
+  TACSOrthotropicPly *plies[num_plies] = {ply, ply, ply, ply};
+  TacsScalar thickness[num_plies] = {1e-3, 2e-3, 1.5e-3, 0.5e-3};
+  TACSCompositeShellConstitutive *composite =
+      new TACSCompositeShellConstitutive(num_plies, plies, thickness, angles);
+  composite->incref();
+
+  laminate_stiffness(num_plies, plies, thickness, angles, 5.0 / 6.0,
+                     DRILL_REG, Cref);
+  compare(comm, type, "constructor", composite, Cref);
+
+  TACSShellConstitutive::setDrillingRegularization(0.1 * DRILL_REG);
+  laminate_stiffness(num_plies, plies, thickness, angles, 5.0 / 6.0,
+                     0.1 * DRILL_REG, Cref);
+  compare(comm, type, "drilling regularization", composite, Cref);
+  TACSShellConstitutive::setDrillingRegularization(DRILL_REG);
+
+  // Time the Jacobian with the stored and the recomputed blade stiffness
+  UncachedBladeConstitutive *uncached = new UncachedBladeConstitutive(
+      ply, ply, 5.0 / 6.0, 0.5, 0, 0.15, 1, 2e-3, 2, num_plies, angles, fracs,
+      panel_frac_nums, 0.03, 7, 1.5e-3, 8, num_plies, angles, fracs,
+      stiff_frac_nums);
+  uncached->incref();
+  double t0 = 1e20, t1 = 1e20;
+  for (int k = 0; k < 5; k++) {
+    double t = time_jacobian(uncached);
+    t0 = (t < t0 ? t : t0);
+    t = time_jacobian(blade);
+    t1 = (t < t1 ? t : t1);
+  }
+  if (rank == 0) {
+    printf("Quad4 blade-stiffened Jacobian time: recomputed %.2f us, "
+           "stored %.2f us, speedup %.2f\n",
+           1e6 * t0, 1e6 * t1, t0 / t1);
+  }
+
+  uncached->decref();
+  composite->decref();
+  blade->decref();
+  ply->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
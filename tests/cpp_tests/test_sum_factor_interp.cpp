@@ -0,0 +1,209 @@
+/*
+  Check the sum-factorized tensor-product interpolation
+
+  The quartic and quintic quad and hexa bases and the quadratic and
+  cubic Bernstein hexa bases interpolate the fields and their
+  parametric gradients at all quadrature points with sum-factorized
+  kernels. For 1, 3 and 4 variables per node, interpAllFieldsGrad and
+  addInterpAllFieldsGradTranspose must agree to round-off with the
+  per-point default of TACSElementBasis. For the quartic and quintic
+  hexa bases, they must also agree with the unrolled tensor-product
+  kernels they replaced. The times of the forward interpolation with 3
+  variables per node are printed.
+*/
+
+#include "TACSElementVerification.h"
+#include "TACSGaussQuadrature.h"
+#include "TACSHexaBasis.h"
+#include "TACSHexaBernsteinBasis.h"
+#include "TACSLagrangeInterpolation.h"
+#include "TACSQuadBasis.h"
+#include "TACSTensorProductBasisImpl.h"
+#include "tacs_test_utils.h"
+
+static const int MAX_VARS_PER_NODE = 4;
+static const int NUM_REPS = 2000;
+
+/*
+  The unrolled tensor-product kernels of the quartic and quintic hexa
+  bases, with the 1D tables evaluated at the Gauss points
+*/
+class UnrolledHexaKernel {
+ public:
+  UnrolledHexaKernel(TACSElementBasis *basis, int _p) {
+    p = _p;
+    const double *gauss_pts = (p == 5 ? TacsGaussQuadPts5 : TacsGaussQuadPts6);
+    double knots[6];
+    for (int i = 0; i < p; i++) {
+      double pt[3];
+      basis->getVisPoint(i, pt);
+      knots[i] = pt[0];
+    }
+    for (int i = 0; i < p; i++) {
+      TacsLagrangeShapeFuncDerivative(p, gauss_pts[i], knots, &N[p * i],
+                                      &Nx[p * i]);
+    }
+  }
+
+  void interp(int m, const TacsScalar values[], TacsScalar out[]) {
+    if (p == 5) {
+      TACSInterpAllTensor3DInterp5(m, N, Nx, values, out);
+    } else {
+      TACSInterpAllTensor3DInterp6(m, N, Nx, values, out);
+    }
+  }
+
+  void addTranspose(int m, const TacsScalar in[], TacsScalar values[]) {
+    if (p == 5) {
+      TacsAddAllTransTensor3DInterp5(m, N, Nx, in, values);
+    } else {
+      TacsAddAllTransTensor3DInterp6(m, N, Nx, in, values);
+    }
+  }
+
+ private:
+  int p;
+  double N[36], Nx[36];
+};
+
+/*
+  Compare the interpolation of one basis with the per-point default
+  and, if given, the unrolled kernel
+*/
+static void test_basis(MPI_Comm comm, const char *type,
+                       TACSElementBasis *basis, UnrolledHexaKernel *unrolled) {
+  basis->incref();
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  const int num_nodes = basis->getNumNodes();
+  const int nquad = basis->getNumQuadraturePoints();
+  const int nc = basis->getNumParameters() + 1;
+  const int nvals = MAX_VARS_PER_NODE * num_nodes;
+  const int nout = MAX_VARS_PER_NODE * nc * nquad;
+
+  TacsScalar *values = new TacsScalar[nvals];
+  TacsScalar *in = new TacsScalar[nout];
+  TacsScalar *out[3], *res[3];
+  for (int k = 0; k < 3; k++) {
+    out[k] = new TacsScalar[nout];
+    res[k] = new TacsScalar[nvals];
+  }
+  TacsGenerateRandomArray(values, nvals);
+  TacsGenerateRandomArray(in, nout);
+
+  const int num_m = 3;
+  const int m_values[num_m] = {1, 3, 4};
+  double max_err[2] = {0.0, 0.0};
+  double max_trans_err[2] = {0.0, 0.0};
+  for (int j = 0; j < num_m; j++) {
+    const int m = m_values[j];
+    const int nv = m * num_nodes;
+    const int no = m * nc * nquad;
+
+    basis->interpAllFieldsGrad(m, values, out[0]);
+    basis->TACSElementBasis::interpAllFieldsGrad(m, values, out[1]);
+
+    memset(res[0], 0, nv * sizeof(TacsScalar));
+    memset(res[1], 0, nv * sizeof(TacsScalar));
+    basis->addInterpAllFieldsGradTranspose(m, in, res[0]);
+    basis->TACSElementBasis::addInterpAllFieldsGradTranspose(m, in, res[1]);
+
+    double err = TacsTestRelError(no, out[0], out[1]);
+    double trans_err = TacsTestRelError(nv, res[0], res[1]);
+    max_err[0] = (err > max_err[0] ? err : max_err[0]);
+    max_trans_err[0] = (trans_err > max_trans_err[0] ? trans_err
+                                                      : max_trans_err[0]);
+
+    if (unrolled) {
+      unrolled->interp(m, values, out[2]);
+      memset(res[2], 0, nv * sizeof(TacsScalar));
+      unrolled->addTranspose(m, in, res[2]);
+
+      err = TacsTestRelError(no, out[0], out[2]);
+      trans_err = TacsTestRelError(nv, res[0], res[2]);
+      max_err[1] = (err > max_err[1] ? err : max_err[1]);
+      max_trans_err[1] = (trans_err > max_trans_err[1] ? trans_err
+                                                        : max_trans_err[1]);
+    }
+  }
+
+  char name[128];
+  snprintf(name, sizeof(name), "%s vs per-point interpolation", type);
+  TacsTestCheck(comm, name, max_err[0], 1e-13);
+  snprintf(name, sizeof(name), "%s vs per-point transpose", type);
+  TacsTestCheck(comm, name, max_trans_err[0], 1e-13);
+  if (unrolled) {
+    snprintf(name, sizeof(name), "%s vs unrolled interpolation", type);
+    TacsTestCheck(comm, name, max_err[1], 1e-13);
+    snprintf(name, sizeof(name), "%s vs unrolled transpose", type);
+    TacsTestCheck(comm, name, max_trans_err[1], 1e-13);
+  }
+
+  // Time the forward interpolation with three variables per node
+  double t[3] = {0.0, 0.0, 0.0};
+  t[0] = MPI_Wtime();
+  for (int k = 0; k < NUM_REPS; k++) {
+    basis->interpAllFieldsGrad(3, values, out[0]);
+  }
+  t[0] = (MPI_Wtime() - t[0]) / NUM_REPS;
+
+  t[1] = MPI_Wtime();
+  for (int k = 0; k < NUM_REPS; k++) {
+    basis->TACSElementBasis::interpAllFieldsGrad(3, values, out[1]);
+  }
+  t[1] = (MPI_Wtime() - t[1]) / NUM_REPS;
+
+  if (unrolled) {
+    t[2] = MPI_Wtime();
+    for (int k = 0; k < NUM_REPS; k++) {
+      unrolled->interp(3, values, out[2]);
+    }
+    t[2] = (MPI_Wtime() - t[2]) / NUM_REPS;
+  }
+
+  if (rank == 0) {
+    printf("%s: sum-factorized %.2f us, per-point %.2f us (%.1fx)", type,
+           1e6 * t[0], 1e6 * t[1], t[1] / t[0]);
+    if (unrolled) {
+      printf(", unrolled %.2f us (%.1fx)", 1e6 * t[2], t[2] / t[0]);
+    }
+    printf("\n");
+  }
+
+  delete[] values;
+  delete[] in;
+  for (int k = 0; k < 3; k++) {
+    delete[] out[k];
+    delete[] res[k];
+  }
+  basis->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TacsSeedRandomGenerator(0);
+
+  test_basis(comm, "TACSQuarticQuadBasis", new TACSQuarticQuadBasis(), NULL);
+  test_basis(comm, "TACSQuinticQuadBasis", new TACSQuinticQuadBasis(), NULL);
+
+  TACSElementBasis *quartic = new TACSQuarticHexaBasis();
+  TACSElementBasis *quintic = new TACSQuinticHexaBasis();
+  UnrolledHexaKernel quartic_kernel(quartic, 5);
+  UnrolledHexaKernel quintic_kernel(quintic, 6);
+  test_basis(comm, "TACSQuarticHexaBasis", quartic, &quartic_kernel);
+  test_basis(comm, "TACSQuinticHexaBasis", quintic, &quintic_kernel);
+
+  test_basis(comm, "TACSQuadraticHexaBernsteinBasis",
+             new TACSQuadraticHexaBernsteinBasis(), NULL);
+  test_basis(comm, "TACSCubicHexaBernsteinBasis",
+             new TACSCubicHexaBernsteinBasis(), NULL);
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,114 @@
+/*
+  Check the assembly with symmetric element matrices
+
+  The Jacobian of a linear and a nonlinear shell model is assembled in
+  the default mode and in the mode where the elements only compute the
+  upper triangle of their matrices. The assembly is performed with one
+  and with several threads, and for the linear model also with the
+  element matrix cache. The residuals and the Jacobians must agree with
+  the default mode up to the order of the additions.
+*/
+
+#include "TACSIsoShellConstitutive.h"
+#include "TACSShellElementDefs.h"
+#include "tacs_test_utils.h"
+
+/*
+  Compare the symmetric and the default assembly for one model
+*/
+static void test_symmetric(MPI_Comm comm, const char *type,
+                           TACSElement *elem, int max_cache) {
+  TACSAssembler *assembler =
+      TacsTestCreateQuadModel(comm, 6, 2, 16, 12, 1, &elem, 0.2);
+  assembler->incref();
+
+  TACSBVec *vars = assembler->createVec();
+  vars->incref();
+  vars->setRand(-1.0, 1.0);
+  vars->scale(1e-3);
+  assembler->setBCs(vars);
+  assembler->setVariables(vars);
+
+  TACSBVec *res0 = assembler->createVec();
+  TACSBVec *res1 = assembler->createVec();
+  TACSParallelMat *jac0 = assembler->createMat();
+  TACSParallelMat *jac1 = assembler->createMat();
+  TACSBVec *x = assembler->createVec();
+  TACSBVec *y0 = assembler->createVec();
+  TACSBVec *y1 = assembler->createVec();
+  res0->incref();
+  res1->incref();
+  jac0->incref();
+  jac1->incref();
+  x->incref();
+  y0->incref();
+  y1->incref();
+  x->setRand(-1.0, 1.0);
+
+  const double tol = 1e-13;
+  const int num_threads[2] = {1, 3};
+  for (int cache = 0; cache <= max_cache; cache++) {
+    for (int t = 0; t < 2; t++) {
+      assembler->setNumThreads(num_threads[t]);
+
+      // Fill the cache separately for each mode
+      assembler->setElementMatCache(cache);
+      assembler->setSymmetricElementMatrices(0);
+      assembler->assembleJacobian(1.0, 0.0, 0.0, res0, jac0);
+
+      assembler->clearElementMatCache();
+      assembler->setSymmetricElementMatrices(1);
+      assembler->assembleJacobian(1.0, 0.0, 0.0, res1, jac1);
+      assembler->setSymmetricElementMatrices(0);
+      assembler->setElementMatCache(0);
+
+      char name[128];
+      snprintf(name, sizeof(name), "%s, %d threads%s residual", type,
+               num_threads[t], (cache ? ", cached" : ""));
+      TacsTestCheck(comm, name, TacsTestRelError(res1, res0), tol);
+      snprintf(name, sizeof(name), "%s, %d threads%s Jacobian", type,
+               num_threads[t], (cache ? ", cached" : ""));
+      TacsTestCheck(comm, name, TacsTestMatRelError(jac1, jac0, x, y1, y0),
+                    tol);
+    }
+  }
+  assembler->setNumThreads(1);
+
+  res0->decref();
+  res1->decref();
+  jac0->decref();
+  jac1->decref();
+  x->decref();
+  y0->decref();
+  y1->decref();
+  vars->decref();
+  assembler->decref();
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  TacsInitialize();
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  TACSMaterialProperties *props = new TACSMaterialProperties(
+      2700.0, 921.0, 70e9, 0.3, 270e6, 24e-6, 230.0);
+  props->incref();
+  TACSShellTransform *transform = new TACSShellNaturalTransform();
+  transform->incref();
+
+  test_symmetric(
+      comm, "linear shell",
+      new TACSQuad4Shell(transform, new TACSIsoShellConstitutive(props, 0.01)),
+      1);
+  test_symmetric(comm, "nonlinear shell",
+                 new TACSQuad4NonlinearShell(
+                     transform, new TACSIsoShellConstitutive(props, 0.01)),
+                 0);
+
+  transform->decref();
+  props->decref();
+
+  int fail = TacsTestFinish(comm);
+  MPI_Finalize();
+  return fail;
+}
@@ -78,6 +78,7 @@ class ElementTest(unittest.TestCase):
         self.elements = [
             elements.Tri3Shell,
             elements.Quad4Shell,
+            elements.Quad4ReducedShell,
             elements.Quad9Shell,
             elements.Quad16Shell,
             elements.Tri3ThermalShell,
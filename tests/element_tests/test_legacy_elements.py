@@ -0,0 +1,53 @@
+import unittest
+
+from tacs import constitutive, legacy
+
+"""
+Check that each legacy element template is migrated to an element
+with the same number of nodes and variables per node
+"""
+
+
+class LegacyElementTest(unittest.TestCase):
+    def setUp(self):
+        props = constitutive.MaterialProperties(
+            rho=2700.0, specific_heat=921.096, E=70e3, nu=0.3, ys=270.0, kappa=230.0
+        )
+        self.cons = {
+            "MITCShell": constitutive.IsoShellConstitutive(props, t=1.0, tNum=0),
+            "PlaneStressQuad": constitutive.PlaneStressConstitutive(props, t=1.0),
+            "PoissonQuad": constitutive.PlaneStressConstitutive(props, t=1.0),
+            "PSThermoQuad": constitutive.PlaneStressConstitutive(props, t=1.0),
+            "Solid": constitutive.SolidConstitutive(props, t=1.0),
+            "SolidThermo": constitutive.SolidConstitutive(props, t=1.0),
+        }
+
+        # The variables per node of each legacy element
+        self.vars_per_node = {
+            "MITCShell": 6,
+            "PlaneStressQuad": 2,
+            "PoissonQuad": 1,
+            "PSThermoQuad": 3,
+            "Solid": 3,
+            "SolidThermo": 4,
+        }
+
+    def test_migration(self):
+        for name in legacy.getLegacyElementNames():
+            with self.subTest(name=name):
+                prefix = name.rstrip("0123456789")
+                order = int(name[len(prefix) :])
+                elem = legacy.createLegacyElement(name, self.cons[prefix])
+
+                dim = 3 if prefix.startswith("Solid") else 2
+                self.assertEqual(elem.getNumNodes(), order**dim)
+                self.assertEqual(elem.getVarsPerNode(), self.vars_per_node[prefix])
+
+    def test_unknown_type(self):
+        con = self.cons["Solid"]
+        with self.assertRaises(ValueError):
+            legacy.createLegacyElement("Solid5", con)
+        with self.assertRaises(ValueError):
+            legacy.createLegacyElement("MITCShell32", con)
+        with self.assertRaises(ValueError):
+            legacy.createLegacyElement("Beam2", con)
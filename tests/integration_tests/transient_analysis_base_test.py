@@ -1,3 +1,5 @@
+import os
+import tempfile
 import unittest
 
 import numpy as np
@@ -196,6 +198,50 @@ class TransientTestCase:
                         atol=self.atol,
                     )
 
+        def test_restart(self):
+            """
+            Test that a transient solve resumed from a restart file
+            reproduces the states of the uninterrupted solve
+            """
+            # Make sure vecs are initialized to zero
+            self.zero_tacs_vecs()
+
+            fname = None
+            if self.comm.rank == 0:
+                fd, fname = tempfile.mkstemp(suffix=".rst")
+                os.close(fd)
+            fname = self.comm.bcast(fname, root=0)
+
+            # Solve and write the restart file half way through
+            restart_step = self.num_steps // 2
+            self.assembler.setDesignVars(self.dv0)
+            self.assembler.setNodes(self.xpts0)
+            for i in range(self.num_steps + 1):
+                self.integrator.iterate(i, forces=self.f_list[i])
+                if i == restart_step:
+                    fail = self.integrator.writeRestart(fname, i)
+                    self.assertEqual(fail, 0)
+            _, q_ref, qdot_ref, qddot_ref = self.integrator.getStates(self.num_steps)
+
+            # Resume the solve with a new integrator
+            self.zero_tacs_vecs()
+            integrator = self.setup_integrator(self.assembler)
+            step = integrator.readRestart(fname)
+            self.assertEqual(step, restart_step)
+            for i in range(step + 1, self.num_steps + 1):
+                integrator.iterate(i, forces=self.f_list[i])
+            _, q, qdot, qddot = integrator.getStates(self.num_steps)
+
+            self.comm.barrier()
+            if self.comm.rank == 0:
+                os.remove(fname)
+
+            for vec, ref in zip([q, qdot, qddot], [q_ref, qdot_ref, qddot_ref]):
+                atol = 1e-8 * np.max(np.abs(ref.getArray()), initial=1.0)
+                np.testing.assert_allclose(
+                    vec.getArray(), ref.getArray(), rtol=1e-8, atol=atol
+                )
+
         def run_solve(self, dv=None, xpts=None):
             """
             Run a transient solve at specified design point and return functions of interest
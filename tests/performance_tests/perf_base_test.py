@@ -0,0 +1,130 @@
+import json
+import os
+import shutil
+import tempfile
+import unittest
+
+from mpi4py import MPI
+
+from tacs import TACS
+
+"""
+This is a base class for performance regression test cases.
+The kernels are timed with TACS.benchmarkAssembler(), which uses the
+same harness as the C++ benchmark suite in examples/benchmark, and the
+slowest time over the processes is compared against a stored baseline.
+When the user creates a new test based on this class one method is
+required to be defined in the child class.
+
+    1. setup_assembler
+
+The meshes should have a fixed size so that the baselines remain
+valid. Since the times depend on the machine, the tests are skipped
+unless they are requested through the following environment variables:
+
+    TACS_PERF_TESTS     Set to 1 to run the performance tests
+    TACS_PERF_BASELINE  The baseline file (default: perf_baselines.json
+                        in this directory)
+    TACS_PERF_UPDATE    Set to 1 to store the measured times as the new
+                        baselines instead of comparing against them
+    TACS_PERF_RTOL      The allowed relative increase in time (default 0.25)
+
+A test without a baseline for its case, number of processes and scalar
+type is skipped.
+
+NOTE: The child class must NOT implement its own setUp method
+for the unittest class. This is handled in the base class.
+"""
+
+BASELINE_FILE = os.path.join(os.path.dirname(__file__), "perf_baselines.json")
+
+
+class PerformanceTestCase:
+    class PerformanceTest(unittest.TestCase):
+        # Number of timed repetitions for each kernel
+        nreps = 5
+
+        # Absolute tolerance in seconds, so that very fast kernels do
+        # not fail due to timer noise
+        atol = 1e-4
+
+        def setUp(self):
+            if os.environ.get("TACS_PERF_TESTS", "0") == "0":
+                self.skipTest("Set TACS_PERF_TESTS=1 to run the performance tests")
+
+            self.dtype = TACS.dtype
+            self.rtol = float(os.environ.get("TACS_PERF_RTOL", "0.25"))
+            self.baseline_file = os.environ.get("TACS_PERF_BASELINE", BASELINE_FILE)
+            self.update = os.environ.get("TACS_PERF_UPDATE", "0") != "0"
+
+            # Set the MPI communicator
+            if not hasattr(self, "comm"):
+                self.comm = MPI.COMM_WORLD
+
+            # Setup user-specified assembler for this test
+            self.assembler = self.setup_assembler(self.comm, self.dtype)
+
+        def setup_assembler(self, comm, dtype):
+            """
+            Setup the fixed-size mesh and tacs assembler for the problem
+            to be timed. Must be defined in child class that inherits
+            from this class.
+            """
+            raise NotImplementedError(
+                "Child class %s must implement a 'setup_assembler' method"
+                % (self.__class__.__name__)
+            )
+            return
+
+        def get_baseline_key(self):
+            """
+            The key for the baselines of this case, which includes the
+            number of processes and the scalar type
+            """
+            scalar = "complex" if self.dtype == complex else "real"
+            return "%s/np%d/%s" % (self.__class__.__module__, self.comm.size, scalar)
+
+        def test_kernels(self):
+            """
+            Time the kernels and compare the slowest process time against
+            the baselines
+            """
+            # Time the output to a file in a temporary directory
+            tmpdir = None
+            if self.comm.rank == 0:
+                tmpdir = tempfile.mkdtemp()
+            tmpdir = self.comm.bcast(tmpdir, root=0)
+            fname = os.path.join(tmpdir, "perf_vec.bin")
+
+            results = TACS.benchmarkAssembler(self.assembler, self.nreps, fname)
+
+            self.comm.barrier()
+            if self.comm.rank == 0:
+                shutil.rmtree(tmpdir, ignore_errors=True)
+
+            key = self.get_baseline_key()
+            baselines = {}
+            if self.comm.rank == 0 and os.path.exists(self.baseline_file):
+                with open(self.baseline_file, "r") as fp:
+                    baselines = json.load(fp)
+            baselines = self.comm.bcast(baselines, root=0)
+
+            if self.update:
+                baselines[key] = {name: res["tmax"] for name, res in results.items()}
+                if self.comm.rank == 0:
+                    with open(self.baseline_file, "w") as fp:
+                        json.dump(baselines, fp, indent=2, sort_keys=True)
+                return
+
+            if key not in baselines:
+                self.skipTest("No baseline for %s in %s" % (key, self.baseline_file))
+
+            for name, ref in baselines[key].items():
+                with self.subTest(kernel=name):
+                    self.assertIn(name, results)
+                    tmax = results[name]["tmax"]
+                    self.assertLessEqual(
+                        tmax,
+                        (1.0 + self.rtol) * ref + self.atol,
+                        "%s took %.4e s, baseline %.4e s" % (name, tmax, ref),
+                    )
@@ -0,0 +1,80 @@
+import numpy as np
+
+from perf_base_test import PerformanceTestCase
+from tacs import TACS, elements, constitutive
+
+"""
+Time the kernels for a fixed-size plate of bilinear plane stress
+elements clamped along one edge
+"""
+
+# Length of plate in x/y direction
+Lx = 10.0
+Ly = 10.0
+
+# Number of elements in x/y direction
+nx = 100
+ny = 100
+
+
+class ProblemTest(PerformanceTestCase.PerformanceTest):
+    N_PROCS = 1  # this is how many MPI processes to use for this TestCase.
+
+    def setup_assembler(self, comm, dtype):
+        """
+        Setup mesh and tacs assembler for problem we will be timing.
+        """
+
+        # Create the stiffness object
+        props = constitutive.MaterialProperties(rho=2570.0, E=70e9, nu=0.3, ys=350e6)
+        stiff = constitutive.PlaneStressConstitutive(props, t=0.1, tNum=0)
+
+        # Set up the basis function
+        model = elements.LinearElasticity2D(stiff)
+        basis = elements.LinearQuadBasis()
+        elem = elements.Element2D(model, basis)
+
+        # Allocate the TACSCreator object
+        vars_per_node = model.getVarsPerNode()
+        creator = TACS.Creator(comm, vars_per_node)
+
+        if comm.rank == 0:
+            num_elems = nx * ny
+            num_nodes = (nx + 1) * (ny + 1)
+
+            # discretize plate
+            x = np.linspace(0, Lx, nx + 1, dtype)
+            y = np.linspace(0, Ly, ny + 1, dtype)
+            xyz = np.zeros([nx + 1, ny + 1, 3], dtype)
+            xyz[:, :, 0], xyz[:, :, 1] = np.meshgrid(x, y, indexing="ij")
+
+            node_ids = np.arange(num_nodes).reshape(nx + 1, ny + 1)
+
+            # Set connectivity for each element
+            conn = np.zeros([nx, ny, 4], dtype=np.intc)
+            conn[:, :, 0] = node_ids[:-1, :-1]
+            conn[:, :, 1] = node_ids[1:, :-1]
+            conn[:, :, 2] = node_ids[:-1, 1:]
+            conn[:, :, 3] = node_ids[1:, 1:]
+
+            conn = conn.flatten()
+            ptr = np.arange(0, 4 * num_elems + 1, 4, dtype=np.intc)
+            comp_ids = np.zeros(num_elems, dtype=np.intc)
+
+            creator.setGlobalConnectivity(num_nodes, ptr, conn, comp_ids)
+
+            # Clamp the plate along x == 0
+            bcnodes = np.array(node_ids[0, :], dtype=np.intc)
+            creator.setBoundaryConditions(bcnodes)
+
+            # Set the node locations
+            creator.setNodes(xyz.flatten())
+
+        # Set the elements for each (only one) component
+        element_list = [elem]
+        creator.setElements(element_list)
+
+        # Create the tacs assembler object
+        assembler = creator.createTACS()
+
+        return assembler